@@ -43,6 +43,8 @@
 #include <pcl/pcl_macros.h>
 #include <pcl/point_types.h>
 
+#include <vector>
+
 namespace pcl {
 
 /// Point cloud containing edge information.
@@ -101,7 +103,11 @@ public:
     BOUNDARY_OPTION_ZERO_PADDING
   };
 
-  Convolution() { boundary_options_ = BOUNDARY_OPTION_CLAMP; }
+  Convolution()
+  {
+    boundary_options_ = BOUNDARY_OPTION_CLAMP;
+    setNumberOfThreads();
+  }
 
   /** \brief Sets the kernel to be used for convolution
    * \param[in] kernel convolution kernel passed by reference
@@ -122,8 +128,17 @@ public:
     boundary_options_ = boundary_options;
   }
 
+  /** \brief Set the number of threads to use.
+   * \param[in] nr_threads the number of hardware threads to use (0 takes as many as the
+   * budget of pcl::ExecutionContext allows when filtering)
+   */
+  void
+  setNumberOfThreads(unsigned int nr_threads = 0);
+
   /** \brief Performs 2D convolution of the input point cloud with the kernel.
-   * Uses clamp as the default boundary option.
+   * Uses clamp as the default boundary option. Kernels which are the outer product of
+   * a column and a row vector, like the gaussian and sobel kernels of pcl::kernel, are
+   * applied as a horizontal followed by a vertical 1D convolution.
    * \param[out] output Output point cloud passed by reference
    */
   void
@@ -136,8 +151,25 @@ protected:
   {}
 
 private:
+  /** \brief Index of the input row or column used for a row or column coordinate
+   * outside of the image according to the boundary option, -1 for zero padding.
+   */
+  int
+  getBoundaryIndex(int coordinate, int size) const;
+
+  /** \brief Checks whether the kernel is the outer product of a column and a row
+   * vector, up to rounding errors.
+   * \param[out] horizontal the row vector, with kernel width elements
+   * \param[out] vertical the column vector, with kernel height elements
+   */
+  bool
+  isSeparable(std::vector<float>& horizontal, std::vector<float>& vertical) const;
+
   BOUNDARY_OPTIONS_ENUM boundary_options_;
   pcl::PointCloud<PointT> kernel_;
+
+  /** \brief The number of threads the scheduler should use. */
+  unsigned int threads_;
 };
 } // namespace pcl
 
@@ -34,105 +34,191 @@
  *  POSSIBILITY OF SUCH DAMAGE.
  *
  */
-
 #pragma once
 
 #include <pcl/2d/convolution.h>
+#include <pcl/common/execution_context.h>
+#include <pcl/common/simd_lanes.h>
+
+#include <algorithm>
+#include <cmath>
 
 namespace pcl {
 
+namespace detail {
+/** \brief Adds weight * src[j] to dst[j] for all j in [0, n). */
+inline void
+convolutionMultiplyAdd(float* dst, const float* src, float weight, int n)
+{
+  int j = 0;
+#ifdef PCL_SIMD_KERNELS_SSE2
+  using Lane = pcl::detail::simd::Lane4;
+  const Lane lane_weight(weight);
+  for (; j + static_cast<int>(Lane::size) <= n; j += static_cast<int>(Lane::size))
+    (Lane::load(dst + j) + lane_weight * Lane::load(src + j)).store(dst + j);
+#endif
+  for (; j < n; j++)
+    dst[j] += weight * src[j];
+}
+} // namespace detail
+
+template <typename PointT>
+void
+Convolution<PointT>::setNumberOfThreads(unsigned int nr_threads)
+{
+  // 0 is resolved against the budget of pcl::ExecutionContext at compute time
+  threads_ = nr_threads;
+}
+
+template <typename PointT>
+int
+Convolution<PointT>::getBoundaryIndex(int coordinate, int size) const
+{
+  if (coordinate >= 0 && coordinate < size)
+    return coordinate;
+
+  switch (boundary_options_) {
+  case BOUNDARY_OPTION_MIRROR:
+    coordinate = (coordinate < 0) ? -coordinate - 1 : 2 * size - 1 - coordinate;
+    // kernels larger than the image are only mirrored once
+    return std::min(std::max(coordinate, 0), size - 1);
+  case BOUNDARY_OPTION_ZERO_PADDING:
+    return -1;
+  default:
+  case BOUNDARY_OPTION_CLAMP:
+    return (coordinate < 0) ? 0 : size - 1;
+  }
+}
+
+template <typename PointT>
+bool
+Convolution<PointT>::isSeparable(std::vector<float>& horizontal,
+                                 std::vector<float>& vertical) const
+{
+  int kw = static_cast<int>(kernel_.width), kh = static_cast<int>(kernel_.height);
+
+  // the largest element is the most accurate pivot
+  int pivot_col = 0, pivot_row = 0;
+  float max_abs = 0.0f;
+  for (int k = 0; k < kh; k++)
+    for (int l = 0; l < kw; l++)
+      if (std::abs(kernel_(l, k).intensity) > max_abs) {
+        max_abs = std::abs(kernel_(l, k).intensity);
+        pivot_col = l;
+        pivot_row = k;
+      }
+  if (max_abs == 0.0f || !std::isfinite(max_abs))
+    return (false);
+
+  horizontal.resize(kw);
+  vertical.resize(kh);
+  for (int l = 0; l < kw; l++)
+    horizontal[l] = kernel_(l, pivot_row).intensity;
+  for (int k = 0; k < kh; k++)
+    vertical[k] =
+        kernel_(pivot_col, k).intensity / kernel_(pivot_col, pivot_row).intensity;
+
+  const float tolerance = 1e-5f * max_abs;
+  for (int k = 0; k < kh; k++)
+    for (int l = 0; l < kw; l++)
+      if (!(std::abs(kernel_(l, k).intensity - vertical[k] * horizontal[l]) <=
+            tolerance))
+        return (false);
+  return (true);
+}
+
 template <typename PointT>
 void
 Convolution<PointT>::filter(pcl::PointCloud<PointT>& output)
 {
-  int input_row = 0;
-  int input_col = 0;
-  // default boundary option : zero padding
   output = *input_;
 
   int iw = static_cast<int>(input_->width), ih = static_cast<int>(input_->height),
       kw = static_cast<int>(kernel_.width), kh = static_cast<int>(kernel_.height);
-  switch (boundary_options_) {
-  default:
-  case BOUNDARY_OPTION_CLAMP: {
-    for (int i = 0; i < ih; i++) {
-      for (int j = 0; j < iw; j++) {
-        float intensity = 0;
-        for (int k = 0; k < kh; k++) {
-          for (int l = 0; l < kw; l++) {
-            int ikkh = i + k - kh / 2, jlkw = j + l - kw / 2;
-            if (ikkh < 0)
-              input_row = 0;
-            else if (ikkh >= ih)
-              input_row = ih - 1;
-            else
-              input_row = ikkh;
-
-            if (jlkw < 0)
-              input_col = 0;
-            else if (jlkw >= iw)
-              input_col = iw - 1;
-            else
-              input_col = jlkw;
-
-            intensity +=
-                kernel_(l, k).intensity * (*input_)(input_col, input_row).intensity;
-          }
-        }
-        output(j, i).intensity = intensity;
-      }
-    }
-    break;
+  if (iw == 0 || ih == 0)
+    return;
+  if (kw == 0 || kh == 0) {
+    for (auto& point : output)
+      point.intensity = 0;
+    return;
   }
 
-  case BOUNDARY_OPTION_MIRROR: {
-    for (int i = 0; i < ih; i++) {
-      for (int j = 0; j < iw; j++) {
-        float intensity = 0;
-        for (int k = 0; k < kh; k++) {
-          for (int l = 0; l < kw; l++) {
-            int ikkh = i + k - kh / 2, jlkw = j + l - kw / 2;
-            if (ikkh < 0)
-              input_row = -ikkh - 1;
-            else if (ikkh >= ih)
-              input_row = 2 * ih - 1 - ikkh;
-            else
-              input_row = ikkh;
-
-            if (jlkw < 0)
-              input_col = -jlkw - 1;
-            else if (jlkw >= iw)
-              input_col = 2 * iw - 1 - jlkw;
-            else
-              input_col = jlkw;
-
-            intensity +=
-                kernel_(l, k).intensity * ((*input_)(input_col, input_row).intensity);
-          }
-        }
-        output(j, i).intensity = intensity;
+  // The rows of the input are padded with kw / 2 columns on the left and (kw - 1) / 2
+  // columns on the right according to the boundary option, so that the inner loops
+  // run over contiguous memory without any boundary checks. Rows outside of the image
+  // are looked up in row_index, which has kh - 1 additional entries.
+  int padded_width = iw + kw - 1;
+  std::vector<int> col_index(padded_width);
+  for (int x = 0; x < padded_width; x++)
+    col_index[x] = getBoundaryIndex(x - kw / 2, iw);
+  std::vector<int> row_index(ih + kh - 1);
+  for (int y = 0; y < ih + kh - 1; y++)
+    row_index[y] = getBoundaryIndex(y - kh / 2, ih);
+
+  const pcl::ThreadReservation reservation(threads_);
+  const unsigned int threads = reservation.getNumberOfThreads();
+  std::vector<float> padded(static_cast<std::size_t>(ih) * padded_width);
+#pragma omp parallel for default(none) shared(padded, col_index, ih, padded_width)     \
+    num_threads(threads)
+  for (int i = 0; i < ih; i++)
+    for (int x = 0; x < padded_width; x++)
+      padded[i * padded_width + x] =
+          (col_index[x] < 0) ? 0.0f : (*input_)(col_index[x], i).intensity;
+
+  std::vector<float> horizontal, vertical;
+  if (isSeparable(horizontal, vertical)) {
+    // horizontal pass over all rows of the input
+    std::vector<float> rows(static_cast<std::size_t>(ih) * iw, 0.0f);
+#pragma omp parallel for default(none)                                                 \
+    shared(rows, padded, horizontal, iw, ih, kw, padded_width) num_threads(threads)
+    for (int i = 0; i < ih; i++)
+      for (int l = 0; l < kw; l++)
+        detail::convolutionMultiplyAdd(
+            &rows[i * iw], &padded[i * padded_width + l], horizontal[l], iw);
+
+    // vertical pass
+#pragma omp parallel default(none)                                                     \
+    shared(output, rows, row_index, vertical, iw, ih, kh) num_threads(threads)
+    {
+      std::vector<float> sums(iw);
+#pragma omp for schedule(static)
+      for (int i = 0; i < ih; i++) {
+        std::fill(sums.begin(), sums.end(), 0.0f);
+        for (int k = 0; k < kh; k++)
+          if (row_index[i + k] >= 0)
+            detail::convolutionMultiplyAdd(
+                sums.data(), &rows[row_index[i + k] * iw], vertical[k], iw);
+        for (int j = 0; j < iw; j++)
+          output(j, i).intensity = sums[j];
       }
     }
-    break;
+    return;
   }
 
-  case BOUNDARY_OPTION_ZERO_PADDING: {
+  // general kernels, summing up the products in the same order as a direct evaluation
+  std::vector<float> weights(static_cast<std::size_t>(kw) * kh);
+  for (int k = 0; k < kh; k++)
+    for (int l = 0; l < kw; l++)
+      weights[k * kw + l] = kernel_(l, k).intensity;
+
+#pragma omp parallel default(none)                                                     \
+    shared(output, padded, row_index, weights, iw, ih, kw, kh, padded_width)           \
+    num_threads(threads)
+  {
+    std::vector<float> sums(iw);
+#pragma omp for schedule(static)
     for (int i = 0; i < ih; i++) {
-      for (int j = 0; j < iw; j++) {
-        float intensity = 0;
-        for (int k = 0; k < kh; k++) {
-          for (int l = 0; l < kw; l++) {
-            int ikkh = i + k - kh / 2, jlkw = j + l - kw / 2;
-            if (ikkh < 0 || ikkh >= ih || jlkw < 0 || jlkw >= iw)
-              continue;
-            intensity += kernel_(l, k).intensity * ((*input_)(jlkw, ikkh).intensity);
-          }
-        }
-        output(j, i).intensity = intensity;
+      std::fill(sums.begin(), sums.end(), 0.0f);
+      for (int k = 0; k < kh; k++) {
+        if (row_index[i + k] < 0)
+          continue;
+        const float* row = &padded[row_index[i + k] * padded_width];
+        for (int l = 0; l < kw; l++)
+          detail::convolutionMultiplyAdd(sums.data(), row + l, weights[k * kw + l], iw);
       }
+      for (int j = 0; j < iw; j++)
+        output(j, i).intensity = sums[j];
     }
-    break;
   }
-  } // switch
 }
 } // namespace pcl
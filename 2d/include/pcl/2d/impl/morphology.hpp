@@ -39,7 +39,120 @@
 
 #include <pcl/2d/morphology.h>
 
+#include <algorithm>
+#include <limits>
+#include <vector>
+
 namespace pcl {
+namespace detail {
+
+/** \brief Running minimum or maximum over windows of k consecutive elements, using
+ * the van Herk/Gil-Werman algorithm. The input consists of n elements of m floats
+ * each, the output element y is the elementwise op of the input elements y to
+ * y + k - 1, for y in [0, n - k]. Takes three applications of op per float,
+ * independently of k.
+ */
+template <typename Operation>
+void
+runningExtremum(const float* input,
+                int n,
+                int m,
+                int k,
+                std::vector<float>& prefix,
+                std::vector<float>& suffix,
+                float* output,
+                Operation op)
+{
+  prefix.resize(static_cast<std::size_t>(n) * m);
+  suffix.resize(static_cast<std::size_t>(n) * m);
+
+  // op over the elements from the start of the block of k elements up to i, and from
+  // i up to the end of the block
+  for (int i = 0; i < n; ++i) {
+    const float* in = input + static_cast<std::size_t>(i) * m;
+    float* g = &prefix[static_cast<std::size_t>(i) * m];
+    if (i % k == 0)
+      std::copy(in, in + m, g);
+    else
+      for (int j = 0; j < m; ++j)
+        g[j] = op(g[j - m], in[j]);
+  }
+  for (int i = n - 1; i >= 0; --i) {
+    const float* in = input + static_cast<std::size_t>(i) * m;
+    float* h = &suffix[static_cast<std::size_t>(i) * m];
+    if (i % k == k - 1 || i == n - 1)
+      std::copy(in, in + m, h);
+    else
+      for (int j = 0; j < m; ++j)
+        h[j] = op(h[j + m], in[j]);
+  }
+
+  // Every window is split by a block boundary into a suffix and a prefix of a block
+  for (int y = 0; y + k <= n; ++y) {
+    const float* h = &suffix[static_cast<std::size_t>(y) * m];
+    const float* g = &prefix[static_cast<std::size_t>(y + k - 1) * m];
+    float* out = output + static_cast<std::size_t>(y) * m;
+    for (int j = 0; j < m; ++j)
+      out[j] = op(h[j], g[j]);
+  }
+}
+
+/** \brief In place minimum or maximum of a row major image over a kernel_width x
+ * kernel_height rectangle centered like the structuring elements of Morphology, where
+ * the parts of the rectangle outside of the image are ignored.
+ * \param[in,out] image the image
+ * \param[in] identity the value that does not change the result of op
+ * \param[in] op the minimum or maximum of two values
+ */
+template <typename Operation>
+void
+rectangularExtremum(std::vector<float>& image,
+                    int width,
+                    int height,
+                    int kernel_width,
+                    int kernel_height,
+                    float identity,
+                    Operation op)
+{
+  std::vector<float> padded, prefix, suffix;
+
+  // Along the rows
+  padded.assign(width + kernel_width - 1, identity);
+  for (int i = 0; i < height; ++i) {
+    float* row = &image[static_cast<std::size_t>(i) * width];
+    std::copy(row, row + width, padded.begin() + kernel_width / 2);
+    runningExtremum(
+        padded.data(), width + kernel_width - 1, 1, kernel_width, prefix, suffix, row, op);
+  }
+
+  // Along the columns, whole rows at a time
+  padded.assign(static_cast<std::size_t>(height + kernel_height - 1) * width, identity);
+  std::copy(image.begin(),
+            image.end(),
+            padded.begin() + static_cast<std::size_t>(kernel_height / 2) * width);
+  runningExtremum(padded.data(),
+                  height + kernel_height - 1,
+                  width,
+                  kernel_height,
+                  prefix,
+                  suffix,
+                  image.data(),
+                  op);
+}
+
+} // namespace detail
+
+template <typename PointT>
+bool
+Morphology<PointT>::isRectangularElement() const
+{
+  if (structuring_element_->empty())
+    return false;
+  for (const auto& point : structuring_element_->points)
+    if (point.intensity == 0)
+      return false;
+  return true;
+}
 
 // Assumes input, kernel and output images have 0's and 1's only
 template <typename PointT>
@@ -56,6 +169,20 @@ Morphology<PointT>::erosionBinary(pcl::PointCloud<PointT>& output)
   output.height = height;
   output.resize(width * height);
 
+  // A point stays 1 iff all the points under the element are 1
+  if (isRectangularElement()) {
+    std::vector<float> image(input_->size());
+    for (std::size_t i = 0; i < image.size(); ++i)
+      image[i] = ((*input_)[i].intensity == 1) ? 1.0f : 0.0f;
+    detail::rectangularExtremum(
+        image, width, height, kernel_width, kernel_height, 1.0f, [](float a, float b) {
+          return std::min(a, b);
+        });
+    for (std::size_t i = 0; i < image.size(); ++i)
+      output[i].intensity = image[i];
+    return;
+  }
+
   for (int i = 0; i < height; i++) {
     for (int j = 0; j < width; j++) {
       // Operation done only at 1's
@@ -107,6 +234,20 @@ Morphology<PointT>::dilationBinary(pcl::PointCloud<PointT>& output)
   output.height = height;
   output.resize(width * height);
 
+  // A point becomes 1 iff any of the points under the element is 1
+  if (isRectangularElement()) {
+    std::vector<float> image(input_->size());
+    for (std::size_t i = 0; i < image.size(); ++i)
+      image[i] = ((*input_)[i].intensity == 1) ? 1.0f : 0.0f;
+    detail::rectangularExtremum(
+        image, width, height, kernel_width, kernel_height, 0.0f, [](float a, float b) {
+          return std::max(a, b);
+        });
+    for (std::size_t i = 0; i < image.size(); ++i)
+      output[i].intensity = image[i];
+    return;
+  }
+
   for (int i = 0; i < height; i++) {
     for (int j = 0; j < width; j++) {
       match_flag = false;
@@ -119,7 +260,7 @@ Morphology<PointT>::dilationBinary(pcl::PointCloud<PointT>& output)
             continue;
           if ((i + k - kernel_height / 2) < 0 ||
               (i + k - kernel_height / 2) >= height || (j + l - kernel_width / 2) < 0 ||
-              (j + l - kernel_width / 2) >= height) {
+              (j + l - kernel_width / 2) >= width) {
             continue;
           }
           // If any position where kernel is 1 and image is also one is detected,
@@ -172,6 +313,22 @@ Morphology<PointT>::erosionGray(pcl::PointCloud<PointT>& output)
   output.width = width;
   output.height = height;
 
+  if (isRectangularElement()) {
+    std::vector<float> image(input_->size());
+    for (std::size_t i = 0; i < image.size(); ++i)
+      image[i] = (*input_)[i].intensity;
+    detail::rectangularExtremum(image,
+                                width,
+                                height,
+                                kernel_width,
+                                kernel_height,
+                                std::numeric_limits<float>::infinity(),
+                                [](float a, float b) { return std::min(a, b); });
+    for (std::size_t i = 0; i < image.size(); ++i)
+      output[i].intensity = image[i];
+    return;
+  }
+
   for (int i = 0; i < height; i++) {
     for (int j = 0; j < width; j++) {
       min = -1;
@@ -215,6 +372,22 @@ Morphology<PointT>::dilationGray(pcl::PointCloud<PointT>& output)
   output.width = width;
   output.height = height;
 
+  if (isRectangularElement()) {
+    std::vector<float> image(input_->size());
+    for (std::size_t i = 0; i < image.size(); ++i)
+      image[i] = (*input_)[i].intensity;
+    detail::rectangularExtremum(image,
+                                width,
+                                height,
+                                kernel_width,
+                                kernel_height,
+                                -std::numeric_limits<float>::infinity(),
+                                [](float a, float b) { return std::max(a, b); });
+    for (std::size_t i = 0; i < image.size(); ++i)
+      output[i].intensity = image[i];
+    return;
+  }
+
   for (int i = 0; i < height; i++) {
     for (int j = 0; j < width; j++) {
       max = -1;
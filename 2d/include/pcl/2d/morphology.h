@@ -49,6 +49,13 @@ private:
 
   PointCloudInPtr structuring_element_;
 
+  /** \brief Whether all the points of the structuring element are set, in which case
+   * erosions and dilations are computed separably in constant time per point,
+   * independently of the size of the element.
+   */
+  bool
+  isRectangularElement() const;
+
 public:
   using PCLBase<PointT>::input_;
 
@@ -9,6 +9,7 @@
 
 #include <pcl/apps/3d_rec_framework/feature_wrapper/global/global_estimator.h>
 #include <pcl/apps/3d_rec_framework/pc_source/source.h>
+#include <pcl/apps/3d_rec_framework/utils/descriptor_store.h>
 
 #include <flann/flann.hpp>
 
@@ -91,12 +92,29 @@ protected:
   flann::Index<DistT>* flann_index_;
   std::vector<flann_model> flann_models_;
 
+  /** \brief Memory-mapped training descriptors, backs flann_data_ when loaded */
+  DescriptorStore descriptor_store_;
+  bool use_descriptor_store_;
+
+  /** \brief Number of threads used to match the input descriptors (0: automatic) */
+  int threads_;
+
   pcl::Indices indices_;
 
   // load features from disk and create flann structure
   void
   loadFeaturesAndCreateFLANN();
 
+  std::string
+  getDescriptorStoreFile() const
+  {
+    return training_dir_ + "/" + descr_name_ + "_descriptors.bin";
+  }
+
+  // map the descriptor store, false if missing or stale
+  bool
+  loadDescriptorStore(const std::vector<ModelT>& models);
+
   inline void
   convertToFLANN(const std::vector<flann_model>& models, flann::Matrix<float>& data)
   {
@@ -115,13 +133,6 @@ protected:
     data = flann_data;
   }
 
-  void
-  nearestKSearch(flann::Index<DistT>* index,
-                 const flann_model& model,
-                 int k,
-                 flann::Matrix<int>& indices,
-                 flann::Matrix<float>& distances);
-
   int NN_;
   std::vector<std::string> categories_;
   std::vector<float> confidences_;
@@ -129,7 +140,13 @@ protected:
   std::string first_nn_category_;
 
 public:
-  GlobalNNPipeline() { NN_ = 1; }
+  GlobalNNPipeline()
+  {
+    NN_ = 1;
+    flann_index_ = nullptr;
+    use_descriptor_store_ = true;
+    threads_ = 0;
+  }
 
   ~GlobalNNPipeline() {}
 
@@ -210,6 +227,27 @@ public:
   {
     training_dir_ = dir;
   }
+
+  /**
+   * \brief Keep all training descriptors in a single memory-mapped store in the
+   * training directory, rebuilt whenever models are (re)trained or the set of models
+   * changes. Enabled by default.
+   */
+  void
+  setUseDescriptorStore(bool u)
+  {
+    use_descriptor_store_ = u;
+  }
+
+  /**
+   * \brief Number of threads used to match the input descriptors against the training
+   * set (0: let FLANN use all available cores)
+   */
+  void
+  setNumberOfThreads(int n)
+  {
+    threads_ = n;
+  }
 };
 
 } // namespace rec_3d_framework
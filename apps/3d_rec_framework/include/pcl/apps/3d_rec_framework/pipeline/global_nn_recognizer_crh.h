@@ -80,6 +80,9 @@ protected:
     int view_id;
     int descriptor_id;
     std::vector<float> descr;
+    /** \brief CRH and centroid of the view, only loaded when use_cache_ is set */
+    pcl::Histogram<90> crh;
+    Eigen::Vector3f centroid;
   };
 
   flann::Matrix<float> flann_data_;
@@ -7,12 +7,52 @@
 
 #include <pcl/apps/3d_rec_framework/pipeline/global_nn_classifier.h>
 
+template <template <class> class Distance, typename PointInT, typename FeatureT>
+bool
+pcl::rec_3d_framework::GlobalNNPipeline<Distance, PointInT, FeatureT>::
+    loadDescriptorStore(const std::vector<ModelT>& models)
+{
+  if (!descriptor_store_.open(getDescriptorStoreFile()))
+    return false;
+
+  // the store is only valid for the very same set of models
+  const auto& model_ids = descriptor_store_.getModelIds();
+  const std::size_t size_feat = sizeof(FeatureT::histogram) / sizeof(float);
+  bool valid = (model_ids.size() == models.size()) && (descriptor_store_.rows() > 0) &&
+               (descriptor_store_.cols() == size_feat);
+  for (std::size_t i = 0; valid && i < models.size(); i++)
+    valid = (model_ids[i] == models[i].id_);
+
+  if (!valid) {
+    std::cout << "Descriptor store is stale, rebuilding..." << std::endl;
+    descriptor_store_.close();
+    return false;
+  }
+
+  flann_models_.resize(descriptor_store_.rows());
+  for (std::size_t i = 0; i < descriptor_store_.rows(); i++)
+    flann_models_[i].first = models[descriptor_store_.entry(i).model];
+
+  // the descriptors are used in place, FLANN reads them straight from the mapping
+  flann_data_ = flann::Matrix<float>(
+      descriptor_store_.data(), descriptor_store_.rows(), descriptor_store_.cols());
+  return true;
+}
+
 template <template <class> class Distance, typename PointInT, typename FeatureT>
 void
 pcl::rec_3d_framework::GlobalNNPipeline<Distance, PointInT, FeatureT>::
     loadFeaturesAndCreateFLANN()
 {
   auto models = source_->getModels();
+  if (use_descriptor_store_ && loadDescriptorStore(*models)) {
+    // a linear index has nothing to build, so it is not worth serializing
+    flann_index_ = new flann::Index<DistT>(flann_data_, flann::LinearIndexParams());
+    flann_index_->buildIndex();
+    return;
+  }
+
+  std::vector<DescriptorStore::Entry> entries;
   for (std::size_t i = 0; i < models->size(); i++) {
     std::string path =
         source_->getModelDescriptorDir(models->at(i), training_dir_, descr_name_);
@@ -25,8 +65,6 @@ pcl::rec_3d_framework::GlobalNNPipeline<Distance, PointInT, FeatureT>::
 
       if (strs[0] == "descriptor") {
         std::string full_file_name = dir_entry.path().string();
-        std::vector<std::string> strs;
-        boost::split(strs, full_file_name, boost::is_any_of("/"));
 
         typename pcl::PointCloud<FeatureT>::Ptr signature(
             new pcl::PointCloud<FeatureT>);
@@ -41,6 +79,13 @@ pcl::rec_3d_framework::GlobalNNPipeline<Distance, PointInT, FeatureT>::
                size_feat * sizeof(float));
 
         flann_models_.push_back(descr_model);
+
+        // descriptor_<view>_<index>.pcd
+        DescriptorStore::Entry entry;
+        entry.model = static_cast<int>(i);
+        entry.view_id = (strs.size() > 1) ? atoi(strs[1].c_str()) : -1;
+        entry.keypoint_id = (strs.size() > 2) ? atoi(strs[2].c_str()) : -1;
+        entries.push_back(entry);
       }
     }
   }
@@ -48,25 +93,18 @@ pcl::rec_3d_framework::GlobalNNPipeline<Distance, PointInT, FeatureT>::
   convertToFLANN(flann_models_, flann_data_);
   flann_index_ = new flann::Index<DistT>(flann_data_, flann::LinearIndexParams());
   flann_index_->buildIndex();
-}
 
-template <template <class> class Distance, typename PointInT, typename FeatureT>
-void
-pcl::rec_3d_framework::GlobalNNPipeline<Distance, PointInT, FeatureT>::nearestKSearch(
-    flann::Index<DistT>* index,
-    const flann_model& model,
-    int k,
-    flann::Matrix<int>& indices,
-    flann::Matrix<float>& distances)
-{
-  flann::Matrix<float> p =
-      flann::Matrix<float>(new float[model.second.size()], 1, model.second.size());
-  memcpy(&p.ptr()[0], &model.second[0], p.cols * p.rows * sizeof(float));
-
-  indices = flann::Matrix<int>(new int[k], 1, k);
-  distances = flann::Matrix<float>(new float[k], 1, k);
-  index->knnSearch(p, indices, distances, k, flann::SearchParams(512));
-  delete[] p.ptr();
+  if (use_descriptor_store_) {
+    std::vector<std::string> model_ids(models->size());
+    for (std::size_t i = 0; i < models->size(); i++)
+      model_ids[i] = models->at(i).id_;
+
+    DescriptorStore::write(getDescriptorStoreFile(),
+                           model_ids,
+                           entries,
+                           flann_data_.ptr(),
+                           flann_data_.cols);
+  }
 }
 
 template <template <class> class Distance, typename PointInT, typename FeatureT>
@@ -96,26 +134,34 @@ pcl::rec_3d_framework::GlobalNNPipeline<Distance, PointInT, FeatureT>::classify(
   std::vector<index_score> indices_scores;
 
   if (!signatures.empty()) {
-    for (std::size_t idx = 0; idx < signatures.size(); idx++) {
-      float* hist = signatures[idx][0].histogram;
-      int size_feat = sizeof(signatures[idx][0].histogram) / sizeof(float);
-      std::vector<float> std_hist(hist, hist + size_feat);
-      ModelT empty;
-
-      flann_model histogram(empty, std_hist);
-      flann::Matrix<int> indices;
-      flann::Matrix<float> distances;
-      nearestKSearch(flann_index_, histogram, NN_, indices, distances);
-
-      // gather NN-search results
+    // match all input descriptors at once, FLANN spreads the queries over threads_
+    // cores
+    const std::size_t size_feat = sizeof(signatures[0][0].histogram) / sizeof(float);
+    const std::size_t n_queries = signatures.size();
+    flann::Matrix<float> queries(
+        new float[n_queries * size_feat], n_queries, size_feat);
+    for (std::size_t idx = 0; idx < n_queries; idx++)
+      memcpy(queries[idx], signatures[idx][0].histogram, size_feat * sizeof(float));
+
+    flann::Matrix<int> indices(new int[n_queries * NN_], n_queries, NN_);
+    flann::Matrix<float> distances(new float[n_queries * NN_], n_queries, NN_);
+    flann::SearchParams params(512);
+    params.cores = threads_;
+    flann_index_->knnSearch(queries, indices, distances, NN_, params);
+    delete[] queries.ptr();
+
+    // gather NN-search results
+    for (std::size_t idx = 0; idx < n_queries; idx++) {
       for (int i = 0; i < NN_; ++i) {
         index_score is;
-        is.idx_models_ = indices[0][i];
+        is.idx_models_ = indices[idx][i];
         is.idx_input_ = static_cast<int>(idx);
-        is.score_ = distances[0][i];
+        is.score_ = distances[idx][i];
         indices_scores.push_back(is);
       }
     }
+    delete[] indices.ptr();
+    delete[] distances.ptr();
 
     std::sort(indices_scores.begin(), indices_scores.end(), sortIndexScoresOp);
     first_nn_category_ = flann_models_[indices_scores[0].idx_models_].first.class_;
@@ -157,6 +203,7 @@ pcl::rec_3d_framework::GlobalNNPipeline<Distance, PointInT, FeatureT>::initializ
   auto models = source_->getModels();
   std::cout << "Models size:" << models->size() << std::endl;
 
+  bool retrained = force_retrain;
   if (force_retrain) {
     for (std::size_t i = 0; i < models->size(); i++) {
       source_->removeDescDirectory(models->at(i), training_dir_, descr_name_);
@@ -165,6 +212,7 @@ pcl::rec_3d_framework::GlobalNNPipeline<Distance, PointInT, FeatureT>::initializ
 
   for (std::size_t i = 0; i < models->size(); i++) {
     if (!source_->modelAlreadyTrained(models->at(i), training_dir_, descr_name_)) {
+      retrained = true;
       for (std::size_t v = 0; v < models->at(i).views_->size(); v++) {
         PointInTPtr processed(new pcl::PointCloud<PointInT>);
         // pro view, compute signatures
@@ -212,6 +260,12 @@ pcl::rec_3d_framework::GlobalNNPipeline<Distance, PointInT, FeatureT>::initializ
     }
   }
 
+  // descriptors changed on disk, the persistent store has to be rebuilt
+  if (retrained) {
+    descriptor_store_.close();
+    bf::remove(getDescriptorStoreFile());
+  }
+
   // load features from disk
   // initialize FLANN structure
   loadFeaturesAndCreateFLANN();
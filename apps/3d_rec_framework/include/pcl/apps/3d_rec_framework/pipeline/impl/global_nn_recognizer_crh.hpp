@@ -120,8 +120,6 @@ pcl::rec_3d_framework::GlobalNNCRHRecognizer<Distance, PointInT, FeatureT>::
                &(*signature)[0].histogram[0],
                size_feat * sizeof(float));
 
-        flann_models_.push_back(descr_model);
-
         if (use_cache_) {
 
           const std::string dir_pose =
@@ -133,7 +131,15 @@ pcl::rec_3d_framework::GlobalNNCRHRecognizer<Distance, PointInT, FeatureT>::
           std::pair<std::string, int> pair_model_view =
               std::make_pair(models->at(i).id_, descr_model.view_id);
           poses_cache_[pair_model_view] = pose_matrix;
+
+          // keep the roll histogram next to the descriptor, so alignment needs no I/O
+          CRHPointCloud::Ptr crh;
+          getCRH(descr_model.model, view_id, descriptor_id, crh);
+          descr_model.crh = (*crh)[0];
+          getCentroid(descr_model.model, view_id, descriptor_id, descr_model.centroid);
         }
+
+        flann_models_.push_back(descr_model);
       }
     }
   }
@@ -233,6 +239,51 @@ pcl::rec_3d_framework::GlobalNNCRHRecognizer<Distance, PointInT, FeatureT>::reco
 
         pcl::CRHAlignment<PointInT, 90> crha;
 
+        // group the candidates by input cluster, all the views matched to a cluster
+        // are then correlated against its CRH in a single batch
+        std::map<int, std::vector<int>> candidates_per_input;
+        for (int i = 0; i < num_n; ++i)
+          candidates_per_input[indices_scores[i].idx_input_].push_back(i);
+
+        std::vector<
+            std::vector<Eigen::Matrix4f, Eigen::aligned_allocator<Eigen::Matrix4f>>>
+            roll_transforms(num_n);
+        for (const auto& input_candidates : candidates_per_input) {
+          CRHPointCloud view_crhs;
+          std::vector<Eigen::Vector3f, Eigen::aligned_allocator<Eigen::Vector3f>>
+              view_centroids;
+          for (const int i : input_candidates.second) {
+            flann_model& candidate = flann_models_[indices_scores[i].idx_models_];
+            if (use_cache_) {
+              view_crhs.push_back(candidate.crh);
+              view_centroids.push_back(candidate.centroid);
+              continue;
+            }
+
+            // get crhs
+            CRHPointCloud::Ptr view_crh;
+            getCRH(candidate.model, candidate.view_id, candidate.descriptor_id, view_crh);
+            view_crhs.push_back((*view_crh)[0]);
+
+            // get centroids
+            Eigen::Vector3f view_centroid;
+            getCentroid(
+                candidate.model, candidate.view_id, candidate.descriptor_id, view_centroid);
+            view_centroids.push_back(view_centroid);
+          }
+
+          std::vector<
+              std::vector<Eigen::Matrix4f, Eigen::aligned_allocator<Eigen::Matrix4f>>>
+              batch_transforms;
+          crha.align(view_crhs,
+                     view_centroids,
+                     *crh_histograms[input_candidates.first],
+                     centroids[input_candidates.first],
+                     batch_transforms);
+          for (std::size_t j = 0; j < input_candidates.second.size(); ++j)
+            roll_transforms[input_candidates.second[j]].swap(batch_transforms[j]);
+        }
+
         for (int i = 0; i < num_n; ++i) {
           ModelT m = flann_models_[indices_scores[i].idx_models_].model;
           int view_id = flann_models_[indices_scores[i].idx_models_].view_id;
@@ -240,29 +291,11 @@ pcl::rec_3d_framework::GlobalNNCRHRecognizer<Distance, PointInT, FeatureT>::reco
 
           std::cout << m.id_ << " " << view_id << " " << desc_id << std::endl;
 
-          // get crhs
-          CRHPointCloud::Ptr input_crh = crh_histograms[indices_scores[i].idx_input_];
-          CRHPointCloud::Ptr view_crh;
-          getCRH(m, view_id, desc_id, view_crh);
-
-          // get centroids
-          Eigen::Vector3f input_centroid = centroids[indices_scores[i].idx_input_];
-          Eigen::Vector3f view_centroid;
-          getCentroid(m, view_id, desc_id, view_centroid);
-
-          // crha.setModelAndInputView (view, processed);
-          crha.setInputAndTargetCentroids(view_centroid, input_centroid);
-          crha.align(*view_crh, *input_crh);
-
           Eigen::Matrix4f model_view_pose;
           getPose(m, view_id, model_view_pose);
 
-          std::vector<Eigen::Matrix4f, Eigen::aligned_allocator<Eigen::Matrix4f>>
-              roll_transforms;
-          crha.getTransforms(roll_transforms);
-
           // create object hypothesis
-          for (const auto& roll_transform : roll_transforms) {
+          for (const auto& roll_transform : roll_transforms[i]) {
             Eigen::Matrix4f final_roll_trans(roll_transform * model_view_pose);
             models_->push_back(m);
             transforms_->push_back(final_roll_trans);
@@ -8,6 +8,120 @@
 
 #include <flann/flann.hpp>
 
+template <template <class> class Distance, typename PointInT, typename FeatureT>
+void
+pcl::rec_3d_framework::LocalRecognitionPipeline<Distance, PointInT, FeatureT>::
+    cacheView(const ModelT& model, int view_id)
+{
+  const std::string path =
+      source_->getModelDescriptorDir(model, training_dir_, descr_name_);
+  const std::string dir_keypoints =
+      path + "/keypoint_indices_" + std::to_string(view_id) + ".pcd";
+
+  const std::string dir_pose = path + "/pose_" + std::to_string(view_id) + ".txt";
+
+  Eigen::Matrix4f pose_matrix;
+  PersistenceUtils::readMatrixFromFile(dir_pose, pose_matrix);
+
+  std::pair<std::string, int> pair_model_view = std::make_pair(model.id_, view_id);
+  poses_cache_[pair_model_view] = pose_matrix;
+
+  // load keypoints and save them to cache
+  typename pcl::PointCloud<PointInT>::Ptr keypoints(new pcl::PointCloud<PointInT>());
+  pcl::io::loadPCDFile(dir_keypoints, *keypoints);
+  keypoints_cache_[pair_model_view] = keypoints;
+}
+
+template <template <class> class Distance, typename PointInT, typename FeatureT>
+bool
+pcl::rec_3d_framework::LocalRecognitionPipeline<Distance, PointInT, FeatureT>::
+    loadDescriptorStore(const std::vector<ModelT>& models)
+{
+  if (!descriptor_store_.open(getDescriptorStoreFile()))
+    return false;
+
+  // the store is only valid for the very same set of models
+  const auto& model_ids = descriptor_store_.getModelIds();
+  const std::size_t size_feat = sizeof(FeatureT::histogram) / sizeof(float);
+  bool valid = (model_ids.size() == models.size()) && (descriptor_store_.rows() > 0) &&
+               (descriptor_store_.cols() == size_feat);
+  for (std::size_t i = 0; valid && i < models.size(); i++)
+    valid = (model_ids[i] == models[i].id_);
+
+  if (!valid) {
+    std::cout << "Descriptor store is stale, rebuilding..." << std::endl;
+    descriptor_store_.close();
+    return false;
+  }
+
+  flann_models_.resize(descriptor_store_.rows());
+  for (std::size_t i = 0; i < descriptor_store_.rows(); i++) {
+    const DescriptorStore::Entry& entry = descriptor_store_.entry(i);
+    flann_models_[i].model = models[entry.model];
+    flann_models_[i].view_id = entry.view_id;
+    flann_models_[i].keypoint_id = entry.keypoint_id;
+
+    if (use_cache_ && (i == 0 || entry.model != descriptor_store_.entry(i - 1).model ||
+                       entry.view_id != descriptor_store_.entry(i - 1).view_id)) {
+      cacheView(models[entry.model], entry.view_id);
+    }
+  }
+
+  // the descriptors are used in place, FLANN reads them straight from the mapping
+  flann_data_ = flann::Matrix<float>(
+      descriptor_store_.data(), descriptor_store_.rows(), descriptor_store_.cols());
+
+  // FLANN returns no index at all for a missing file, so check for it first
+  const std::string index_file = getFLANNIndexFile();
+  flann::Index<DistT>* index = nullptr;
+  if (bf::exists(index_file)) {
+    try {
+      index = new flann::Index<DistT>(flann_data_, flann::SavedIndexParams(index_file));
+    } catch (const flann::FLANNException& e) {
+      std::cout << "Cannot load FLANN index: " << e.what() << std::endl;
+      index = nullptr;
+    }
+  }
+
+  if (!index) {
+    index = new flann::Index<DistT>(flann_data_, flann::KDTreeIndexParams(4));
+    index->buildIndex();
+    index->save(index_file);
+  }
+  flann_index_ = index;
+
+  std::cout << "Loaded " << descriptor_store_.rows() << " descriptors from "
+            << getDescriptorStoreFile() << std::endl;
+  return true;
+}
+
+template <template <class> class Distance, typename PointInT, typename FeatureT>
+void
+pcl::rec_3d_framework::LocalRecognitionPipeline<Distance, PointInT, FeatureT>::
+    saveDescriptorStore(const std::vector<ModelT>& models)
+{
+  std::vector<std::string> model_ids(models.size());
+  std::map<std::string, int> model_index;
+  for (std::size_t i = 0; i < models.size(); i++) {
+    model_ids[i] = models[i].id_;
+    model_index[models[i].id_] = static_cast<int>(i);
+  }
+
+  std::vector<DescriptorStore::Entry> entries(flann_models_.size());
+  for (std::size_t i = 0; i < flann_models_.size(); i++) {
+    entries[i].model = model_index[flann_models_[i].model.id_];
+    entries[i].view_id = flann_models_[i].view_id;
+    entries[i].keypoint_id = flann_models_[i].keypoint_id;
+  }
+
+  if (DescriptorStore::write(getDescriptorStoreFile(),
+                             model_ids,
+                             entries,
+                             flann_data_.ptr(),
+                             flann_data_.cols))
+    flann_index_->save(getFLANNIndexFile());
+}
+
 template <template <class> class Distance, typename PointInT, typename FeatureT>
 void
 pcl::rec_3d_framework::LocalRecognitionPipeline<Distance, PointInT, FeatureT>::
@@ -16,6 +130,11 @@ pcl::rec_3d_framework::LocalRecognitionPipeline<Distance, PointInT, FeatureT>::
   auto models = source_->getModels();
   std::cout << "Models size:" << models->size() << std::endl;
 
+  // the store always covers the whole training set
+  const bool use_store = use_descriptor_store_ && search_model_.empty();
+  if (use_store && loadDescriptorStore(*models))
+    return;
+
   for (std::size_t i = 0; i < models->size(); i++) {
     std::string path =
         source_->getModelDescriptorDir(models->at(i), training_dir_, descr_name_);
@@ -37,27 +156,7 @@ pcl::rec_3d_framework::LocalRecognitionPipeline<Distance, PointInT, FeatureT>::
         descr_model.view_id = atoi(strs[1].c_str());
 
         if (use_cache_) {
-          std::string path =
-              source_->getModelDescriptorDir(models->at(i), training_dir_, descr_name_);
-          const std::string dir_keypoints = path + "/keypoint_indices_" +
-                                            std::to_string(descr_model.view_id) +
-                                            ".pcd";
-
-          const std::string dir_pose =
-              path + "/pose_" + std::to_string(descr_model.view_id) + ".txt";
-
-          Eigen::Matrix4f pose_matrix;
-          PersistenceUtils::readMatrixFromFile(dir_pose, pose_matrix);
-
-          std::pair<std::string, int> pair_model_view =
-              std::make_pair(models->at(i).id_, descr_model.view_id);
-          poses_cache_[pair_model_view] = pose_matrix;
-
-          // load keypoints and save them to cache
-          typename pcl::PointCloud<PointInT>::Ptr keypoints(
-              new pcl::PointCloud<PointInT>());
-          pcl::io::loadPCDFile(dir_keypoints, *keypoints);
-          keypoints_cache_[pair_model_view] = keypoints;
+          cacheView(models->at(i), descr_model.view_id);
         }
 
         typename pcl::PointCloud<FeatureT>::Ptr signature(
@@ -84,25 +183,9 @@ pcl::rec_3d_framework::LocalRecognitionPipeline<Distance, PointInT, FeatureT>::
 
   flann_index_ = new flann::Index<DistT>(flann_data_, flann::KDTreeIndexParams(4));
   flann_index_->buildIndex();
-}
 
-template <template <class> class Distance, typename PointInT, typename FeatureT>
-void
-pcl::rec_3d_framework::LocalRecognitionPipeline<Distance, PointInT, FeatureT>::
-    nearestKSearch(flann::Index<DistT>* index,
-                   const flann_model& model,
-                   int k,
-                   flann::Matrix<int>& indices,
-                   flann::Matrix<float>& distances)
-{
-  flann::Matrix<float> p =
-      flann::Matrix<float>(new float[model.descr.size()], 1, model.descr.size());
-  memcpy(&p.ptr()[0], &model.descr[0], p.cols * p.rows * sizeof(float));
-
-  indices = flann::Matrix<int>(new int[k], 1, k);
-  distances = flann::Matrix<float>(new float[k], 1, k);
-  index->knnSearch(p, indices, distances, k, flann::SearchParams(kdtree_splits_));
-  delete[] p.ptr();
+  if (use_store)
+    saveDescriptorStore(*models);
 }
 
 template <template <class> class Distance, typename PointInT, typename FeatureT>
@@ -119,6 +202,8 @@ pcl::rec_3d_framework::LocalRecognitionPipeline<Distance, PointInT, FeatureT>::
     models = source_->getModels(search_model_);
     // reset cache and flann structures
     delete flann_index_;
+    flann_index_ = nullptr;
+    descriptor_store_.close();
 
     flann_models_.clear();
     poses_cache_.clear();
@@ -127,6 +212,7 @@ pcl::rec_3d_framework::LocalRecognitionPipeline<Distance, PointInT, FeatureT>::
 
   std::cout << "Models size:" << models->size() << std::endl;
 
+  bool retrained = force_retrain;
   if (force_retrain) {
     for (std::size_t i = 0; i < models->size(); i++) {
       source_->removeDescDirectory(models->at(i), training_dir_, descr_name_);
@@ -137,6 +223,7 @@ pcl::rec_3d_framework::LocalRecognitionPipeline<Distance, PointInT, FeatureT>::
     std::cout << models->at(i).class_ << " " << models->at(i).id_ << std::endl;
 
     if (!source_->modelAlreadyTrained(models->at(i), training_dir_, descr_name_)) {
+      retrained = true;
       for (std::size_t v = 0; v < models->at(i).views_->size(); v++) {
         PointInTPtr processed(new pcl::PointCloud<PointInT>);
         typename pcl::PointCloud<FeatureT>::Ptr signatures(
@@ -185,6 +272,13 @@ pcl::rec_3d_framework::LocalRecognitionPipeline<Distance, PointInT, FeatureT>::
     }
   }
 
+  // descriptors changed on disk, the persistent store has to be rebuilt
+  if (retrained) {
+    descriptor_store_.close();
+    bf::remove(getDescriptorStoreFile());
+    bf::remove(getFLANNIndexFile());
+  }
+
   loadFeaturesAndCreateFLANN();
 }
 
@@ -227,48 +321,55 @@ pcl::rec_3d_framework::LocalRecognitionPipeline<Distance, PointInT, FeatureT>::
 
   int size_feat = sizeof((*signatures)[0].histogram) / sizeof(float);
 
-  // feature matching and object hypotheses
+  // feature matching: all scene descriptors are matched at once, FLANN spreads the
+  // queries over threads_ cores
+  flann::Matrix<float> queries(
+      new float[signatures->size() * size_feat], signatures->size(), size_feat);
+  for (std::size_t idx = 0; idx < signatures->size(); idx++)
+    memcpy(queries[idx], (*signatures)[idx].histogram, size_feat * sizeof(float));
+
+  const std::size_t n_queries = signatures->size();
+  flann::Matrix<int> nn_indices(new int[n_queries], n_queries, 1);
+  flann::Matrix<float> nn_distances(new float[n_queries], n_queries, 1);
+  {
+    flann::SearchParams params(kdtree_splits_);
+    params.cores = threads_;
+    flann_index_->knnSearch(queries, nn_indices, nn_distances, 1, params);
+  }
+  delete[] queries.ptr();
+
+  // object hypotheses
   std::map<std::string, ObjectHypothesis> object_hypotheses;
   {
     for (std::size_t idx = 0; idx < signatures->size(); idx++) {
-      float* hist = (*signatures)[idx].histogram;
-      std::vector<float> std_hist(hist, hist + size_feat);
-      flann_model histogram;
-      histogram.descr = std_hist;
-      flann::Matrix<int> indices;
-      flann::Matrix<float> distances;
-      nearestKSearch(flann_index_, histogram, 1, indices, distances);
+      flann_model& match = flann_models_.at(nn_indices[idx][0]);
+      const float distance = nn_distances[idx][0];
 
       // read view pose and keypoint coordinates, transform keypoint coordinates to
       // model coordinates
       Eigen::Matrix4f homMatrixPose;
-      getPose(flann_models_.at(indices[0][0]).model,
-              flann_models_.at(indices[0][0]).view_id,
-              homMatrixPose);
+      getPose(match.model, match.view_id, homMatrixPose);
 
       typename pcl::PointCloud<PointInT>::Ptr keypoints(
           new pcl::PointCloud<PointInT>());
-      getKeypoints(flann_models_.at(indices[0][0]).model,
-                   flann_models_.at(indices[0][0]).view_id,
-                   keypoints);
+      getKeypoints(match.model, match.view_id, keypoints);
 
-      PointInT view_keypoint =
-          (*keypoints)[flann_models_.at(indices[0][0]).keypoint_id];
+      PointInT view_keypoint = (*keypoints)[match.keypoint_id];
       PointInT model_keypoint;
       model_keypoint.getVector4fMap() =
           homMatrixPose.inverse() * view_keypoint.getVector4fMap();
 
       typename std::map<std::string, ObjectHypothesis>::iterator it_map;
-      if ((it_map = object_hypotheses.find(
-               flann_models_.at(indices[0][0]).model.id_)) != object_hypotheses.end()) {
+      if ((it_map = object_hypotheses.find(match.model.id_)) !=
+          object_hypotheses.end()) {
         // if the object hypothesis already exists, then add information
         ObjectHypothesis oh = (*it_map).second;
         oh.correspondences_pointcloud->points.push_back(model_keypoint);
         oh.correspondences_to_inputcloud->push_back(pcl::Correspondence(
             static_cast<int>(oh.correspondences_pointcloud->size() - 1),
             static_cast<int>(idx),
-            distances[0][0]));
-        oh.feature_distances_->push_back(distances[0][0]);
+            distance));
+        oh.feature_distances_->push_back(distance);
       }
       else {
         // create object hypothesis
@@ -278,23 +379,25 @@ pcl::rec_3d_framework::LocalRecognitionPipeline<Distance, PointInT, FeatureT>::
             new pcl::PointCloud<PointInT>());
         correspondences_pointcloud->points.push_back(model_keypoint);
 
-        oh.model_ = flann_models_.at(indices[0][0]).model;
+        oh.model_ = match.model;
         oh.correspondences_pointcloud = correspondences_pointcloud;
         // last keypoint for this model is a correspondence the current scene keypoint
 
         pcl::CorrespondencesPtr corr(new pcl::Correspondences());
         oh.correspondences_to_inputcloud = corr;
         oh.correspondences_to_inputcloud->push_back(
-            pcl::Correspondence(0, static_cast<int>(idx), distances[0][0]));
+            pcl::Correspondence(0, static_cast<int>(idx), distance));
 
         std::shared_ptr<std::vector<float>> feat_dist(new std::vector<float>);
-        feat_dist->push_back(distances[0][0]);
+        feat_dist->push_back(distance);
 
         oh.feature_distances_ = feat_dist;
         object_hypotheses[oh.model_.id_] = oh;
       }
     }
   }
+  delete[] nn_indices.ptr();
+  delete[] nn_distances.ptr();
 
   {
     for (auto it_map = object_hypotheses.cbegin(); it_map != object_hypotheses.cend();
@@ -9,6 +9,7 @@
 
 #include <pcl/apps/3d_rec_framework/feature_wrapper/local/local_estimator.h>
 #include <pcl/apps/3d_rec_framework/pc_source/source.h>
+#include <pcl/apps/3d_rec_framework/utils/descriptor_store.h>
 #include <pcl/recognition/cg/correspondence_grouping.h>
 #include <pcl/recognition/hv/hypotheses_verification.h>
 #include <pcl/visualization/pcl_visualizer.h>
@@ -80,6 +81,13 @@ class PCL_EXPORTS LocalRecognitionPipeline {
   flann::Index<DistT>* flann_index_;
   std::vector<flann_model> flann_models_;
 
+  /** \brief Memory-mapped training descriptors, backs flann_data_ when loaded */
+  DescriptorStore descriptor_store_;
+  bool use_descriptor_store_;
+
+  /** \brief Number of threads used to match the scene descriptors (0: automatic) */
+  int threads_;
+
   pcl::Indices indices_;
 
   bool use_cache_;
@@ -111,6 +119,30 @@ class PCL_EXPORTS LocalRecognitionPipeline {
   void
   loadFeaturesAndCreateFLANN();
 
+  std::string
+  getDescriptorStoreFile() const
+  {
+    return training_dir_ + "/" + descr_name_ + "_descriptors.bin";
+  }
+
+  std::string
+  getFLANNIndexFile() const
+  {
+    return training_dir_ + "/" + descr_name_ + "_flann_index.bin";
+  }
+
+  // map the descriptor store and load the serialized index, false if missing or stale
+  bool
+  loadDescriptorStore(const std::vector<ModelT>& models);
+
+  // write flann_data_ / flann_models_ and the index to the descriptor store
+  void
+  saveDescriptorStore(const std::vector<ModelT>& models);
+
+  // load the pose and keypoints of a training view into the caches
+  void
+  cacheView(const ModelT& model, int view_id);
+
   inline void
   convertToFLANN(const std::vector<flann_model>& models, flann::Matrix<float>& data)
   {
@@ -129,13 +161,6 @@ class PCL_EXPORTS LocalRecognitionPipeline {
     data = flann_data;
   }
 
-  void
-  nearestKSearch(flann::Index<DistT>* index,
-                 const flann_model& model,
-                 int k,
-                 flann::Matrix<int>& indices,
-                 flann::Matrix<float>& distances);
-
   class ObjectHypothesis {
   public:
     ModelT model_;
@@ -204,6 +229,9 @@ public:
     search_model_ = "";
     VOXEL_SIZE_ICP_ = 0.0025f;
     compute_table_plane_ = false;
+    flann_index_ = nullptr;
+    use_descriptor_store_ = true;
+    threads_ = 0;
   }
 
   void
@@ -259,6 +287,28 @@ public:
     use_cache_ = u;
   }
 
+  /**
+   * \brief Keep all training descriptors and the FLANN index in a single memory-mapped
+   * store in the training directory. The store is written the first time the
+   * pipeline is initialized and rebuilt whenever models are (re)trained or the set of
+   * models changes. Enabled by default.
+   */
+  void
+  setUseDescriptorStore(bool u)
+  {
+    use_descriptor_store_ = u;
+  }
+
+  /**
+   * \brief Number of threads used to match the scene descriptors against the training
+   * set (0: let FLANN use all available cores)
+   */
+  void
+  setNumberOfThreads(int n)
+  {
+    threads_ = n;
+  }
+
   std::shared_ptr<std::vector<ModelT>>
   getModels()
   {
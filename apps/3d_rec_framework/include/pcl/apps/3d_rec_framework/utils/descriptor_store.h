@@ -0,0 +1,246 @@
+/*
+ * descriptor_store.h
+ *
+ *  Persistent, memory-mapped storage of training descriptors.
+ */
+
+#pragma once
+
+#include <boost/filesystem.hpp>
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace pcl {
+namespace rec_3d_framework {
+
+/**
+ * \brief Single-file store of all the descriptors of a training set.
+ * The file holds a small header, the ids of the models, a 64 byte aligned row-major
+ * block of descriptors and one DescriptorStore::Entry per descriptor row telling
+ * which model, view and keypoint it belongs to. The file is memory mapped when
+ * opened, so the descriptor block can be handed to FLANN without reading or copying
+ * it; pages are faulted in lazily and shared between processes using the same store.
+ */
+class DescriptorStore {
+public:
+  struct Entry {
+    std::int32_t model;
+    std::int32_t view_id;
+    std::int32_t keypoint_id;
+  };
+
+  DescriptorStore() = default;
+  DescriptorStore(const DescriptorStore&) = delete;
+  DescriptorStore&
+  operator=(const DescriptorStore&) = delete;
+
+  /**
+   * \brief Writes a store to disk
+   * \param[in] file name of the store file
+   * \param[in] model_ids id of each model, Entry::model indexes into this
+   * \param[in] entries origin of each descriptor row
+   * \param[in] data entries.size () x cols row-major descriptors
+   * \param[in] cols length of a descriptor
+   */
+  static bool
+  write(const std::string& file,
+        const std::vector<std::string>& model_ids,
+        const std::vector<Entry>& entries,
+        const float* data,
+        std::size_t cols)
+  {
+    std::ofstream out(file.c_str(), std::ios::binary | std::ios::trunc);
+    if (!out) {
+      std::cout << "Cannot open file " << file << std::endl;
+      return false;
+    }
+
+    Header header;
+    std::memcpy(header.magic, magic(), sizeof(header.magic));
+    header.version = VERSION;
+    header.cols = static_cast<std::uint32_t>(cols);
+    header.rows = entries.size();
+    header.num_models = model_ids.size();
+
+    std::uint64_t ids_bytes = 0;
+    for (const auto& id : model_ids)
+      ids_bytes += sizeof(std::uint32_t) + id.size();
+    header.data_offset = alignUp(sizeof(Header) + ids_bytes);
+
+    out.write(reinterpret_cast<const char*>(&header), sizeof(Header));
+    for (const auto& id : model_ids) {
+      const auto length = static_cast<std::uint32_t>(id.size());
+      out.write(reinterpret_cast<const char*>(&length), sizeof(length));
+      out.write(id.data(), id.size());
+    }
+
+    const std::vector<char> padding(header.data_offset - sizeof(Header) - ids_bytes, 0);
+    out.write(padding.data(), padding.size());
+    out.write(reinterpret_cast<const char*>(data),
+              sizeof(float) * header.rows * header.cols);
+    out.write(reinterpret_cast<const char*>(entries.data()),
+              sizeof(Entry) * entries.size());
+
+    return static_cast<bool>(out);
+  }
+
+  /**
+   * \brief Maps an existing store into memory
+   * \return false if the file does not exist or is not a valid store
+   */
+  bool
+  open(const std::string& file)
+  {
+    close();
+
+    if (!boost::filesystem::exists(file))
+      return false;
+
+    try {
+      file_ = boost::interprocess::file_mapping(file.c_str(),
+                                                boost::interprocess::read_only);
+      // Private mapping: FLANN wants a mutable dataset pointer, but never writes to it
+      region_ = boost::interprocess::mapped_region(file_,
+                                                   boost::interprocess::copy_on_write);
+    } catch (const boost::interprocess::interprocess_exception& e) {
+      std::cout << "Cannot map " << file << ": " << e.what() << std::endl;
+      close();
+      return false;
+    }
+
+    const auto* base = static_cast<const char*>(region_.get_address());
+    const std::size_t size = region_.get_size();
+
+    Header header;
+    if (size < sizeof(Header)) {
+      close();
+      return false;
+    }
+    std::memcpy(&header, base, sizeof(Header));
+    if (std::memcmp(header.magic, magic(), sizeof(header.magic)) != 0 ||
+        header.version != VERSION ||
+        size < header.data_offset + sizeof(float) * header.rows * header.cols +
+                   sizeof(Entry) * header.rows) {
+      std::cout << "Invalid descriptor store " << file << std::endl;
+      close();
+      return false;
+    }
+
+    std::size_t offset = sizeof(Header);
+    model_ids_.resize(header.num_models);
+    for (auto& id : model_ids_) {
+      std::uint32_t length;
+      if (offset + sizeof(length) > header.data_offset) {
+        close();
+        return false;
+      }
+      std::memcpy(&length, base + offset, sizeof(length));
+      offset += sizeof(length);
+      if (offset + length > header.data_offset) {
+        close();
+        return false;
+      }
+      id.assign(base + offset, length);
+      offset += length;
+    }
+
+    rows_ = header.rows;
+    cols_ = header.cols;
+    data_ = reinterpret_cast<float*>(static_cast<char*>(region_.get_address()) +
+                                     header.data_offset);
+    entries_ = reinterpret_cast<const Entry*>(base + header.data_offset +
+                                              sizeof(float) * rows_ * cols_);
+    return true;
+  }
+
+  /** \brief Unmaps the store */
+  void
+  close()
+  {
+    region_ = boost::interprocess::mapped_region();
+    file_ = boost::interprocess::file_mapping();
+    model_ids_.clear();
+    rows_ = cols_ = 0;
+    data_ = nullptr;
+    entries_ = nullptr;
+  }
+
+  bool
+  isOpen() const
+  {
+    return data_ != nullptr;
+  }
+
+  std::size_t
+  rows() const
+  {
+    return rows_;
+  }
+
+  std::size_t
+  cols() const
+  {
+    return cols_;
+  }
+
+  /** \brief Mapped row-major descriptor block, valid while the store is open */
+  float*
+  data() const
+  {
+    return data_;
+  }
+
+  const Entry&
+  entry(std::size_t row) const
+  {
+    return entries_[row];
+  }
+
+  const std::vector<std::string>&
+  getModelIds() const
+  {
+    return model_ids_;
+  }
+
+private:
+  struct Header {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t cols;
+    std::uint64_t rows;
+    std::uint64_t num_models;
+    std::uint64_t data_offset;
+  };
+
+  static constexpr std::uint32_t VERSION = 1;
+
+  static const char*
+  magic()
+  {
+    return "PCLDSTOR";
+  }
+
+  static std::uint64_t
+  alignUp(std::uint64_t offset)
+  {
+    return (offset + 63) & ~std::uint64_t(63);
+  }
+
+  boost::interprocess::file_mapping file_;
+  boost::interprocess::mapped_region region_;
+  std::vector<std::string> model_ids_;
+  std::size_t rows_ = 0;
+  std::size_t cols_ = 0;
+  float* data_ = nullptr;
+  const Entry* entries_ = nullptr;
+};
+
+} // namespace rec_3d_framework
+} // namespace pcl
@@ -0,0 +1,95 @@
+#include <pcl/common/transforms.h>
+#include <pcl/point_types.h>
+
+#include <benchmark/benchmark.h>
+
+template <typename PointT>
+static pcl::PointCloud<PointT>
+makeCloud(std::size_t size)
+{
+  pcl::PointCloud<PointT> cloud;
+  cloud.resize(size);
+  for (auto& point : cloud)
+    point.getVector3fMap() = Eigen::Vector3f::Random() * 10.0f;
+  return cloud;
+}
+
+template <typename Scalar>
+static Eigen::Matrix<Scalar, 4, 4>
+makeTransform()
+{
+  Eigen::Transform<Scalar, 3, Eigen::Affine> transform;
+  pcl::getTransformation<Scalar>(0.1, -0.2, 0.3, 0.4, -0.5, 0.6, transform);
+  return transform.matrix();
+}
+
+// The point by point loop transformPointCloud used before the batched kernels
+template <typename PointT, typename Scalar>
+static void
+BM_TransformPointByPoint(benchmark::State& state)
+{
+  const auto cloud = makeCloud<PointT>(state.range(0));
+  const auto transform = makeTransform<Scalar>();
+  pcl::PointCloud<PointT> cloud_out = cloud;
+  for (auto _ : state) {
+    const pcl::detail::Transformer<Scalar> tf(transform);
+    for (std::size_t i = 0; i < cloud.size(); ++i)
+      tf.se3(cloud[i].data, cloud_out[i].data);
+    benchmark::DoNotOptimize(cloud_out.data());
+    benchmark::ClobberMemory();
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+template <typename PointT, typename Scalar>
+static void
+BM_TransformPointCloud(benchmark::State& state)
+{
+  const auto cloud = makeCloud<PointT>(state.range(0));
+  const auto transform = makeTransform<Scalar>();
+  pcl::PointCloud<PointT> cloud_out = cloud;
+  for (auto _ : state) {
+    // Transforming in place leaves out the cost of copying the other fields
+    pcl::transformPointCloud(cloud_out, cloud_out, transform, false);
+    benchmark::DoNotOptimize(cloud_out.data());
+    benchmark::ClobberMemory();
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+template <typename PointT, typename Scalar>
+static void
+BM_TransformPointCloudThreads(benchmark::State& state)
+{
+  const auto cloud = makeCloud<PointT>(1 << 21);
+  const auto transform = makeTransform<Scalar>();
+  pcl::PointCloud<PointT> cloud_out = cloud;
+  for (auto _ : state) {
+    pcl::transformPointCloud(cloud_out, cloud_out, transform, false, state.range(0));
+    benchmark::DoNotOptimize(cloud_out.data());
+    benchmark::ClobberMemory();
+  }
+  state.SetItemsProcessed(state.iterations() * cloud.size());
+}
+
+BENCHMARK_TEMPLATE(BM_TransformPointByPoint, pcl::PointXYZ, float)
+    ->RangeMultiplier(16)
+    ->Range(1 << 10, 1 << 22);
+BENCHMARK_TEMPLATE(BM_TransformPointCloud, pcl::PointXYZ, float)
+    ->RangeMultiplier(16)
+    ->Range(1 << 10, 1 << 22);
+BENCHMARK_TEMPLATE(BM_TransformPointByPoint, pcl::PointXYZ, double)
+    ->RangeMultiplier(16)
+    ->Range(1 << 10, 1 << 22);
+BENCHMARK_TEMPLATE(BM_TransformPointCloud, pcl::PointXYZ, double)
+    ->RangeMultiplier(16)
+    ->Range(1 << 10, 1 << 22);
+BENCHMARK_TEMPLATE(BM_TransformPointByPoint, pcl::PointXYZRGBNormal, float)
+    ->Arg(1 << 18);
+BENCHMARK_TEMPLATE(BM_TransformPointCloud, pcl::PointXYZRGBNormal, float)->Arg(1 << 18);
+BENCHMARK_TEMPLATE(BM_TransformPointCloudThreads, pcl::PointXYZ, float)
+    ->RangeMultiplier(2)
+    ->Range(1, 8)
+    ->UseRealTime();
+
+BENCHMARK_MAIN();
@@ -24,6 +24,27 @@ BM_VoxelGrid(benchmark::State& state, const std::string& file)
   }
 }
 
+static void
+BM_VoxelGridThreads(benchmark::State& state, const std::string& file)
+{
+  // Perform setup here
+  pcl::PointCloud<pcl::PointXYZ>::Ptr cloud(new pcl::PointCloud<pcl::PointXYZ>);
+  pcl::PCDReader reader;
+  reader.read(file, *cloud);
+
+  pcl::VoxelGrid<pcl::PointXYZ> vg;
+  vg.setLeafSize(0.01, 0.01, 0.01);
+  vg.setNumberOfThreads(state.range(0));
+  vg.setInputCloud(cloud);
+
+  pcl::PointCloud<pcl::PointXYZ>::Ptr cloud_voxelized(
+      new pcl::PointCloud<pcl::PointXYZ>);
+  for (auto _ : state) {
+    // This code gets timed
+    vg.filter(*cloud_voxelized);
+  }
+}
+
 static void
 BM_ApproxVoxelGrid(benchmark::State& state, const std::string& file)
 {
@@ -57,12 +78,22 @@ main(int argc, char** argv)
 
   benchmark::RegisterBenchmark("BM_VoxelGrid_milk", &BM_VoxelGrid, argv[2])
       ->Unit(benchmark::kMillisecond);
+  benchmark::RegisterBenchmark("BM_VoxelGridThreads_milk", &BM_VoxelGridThreads, argv[2])
+      ->RangeMultiplier(2)
+      ->Range(1, 8)
+      ->UseRealTime()
+      ->Unit(benchmark::kMillisecond);
   benchmark::RegisterBenchmark(
       "BM_ApproximateVoxelGrid_milk", &BM_ApproxVoxelGrid, argv[2])
       ->Unit(benchmark::kMillisecond);
 
   benchmark::RegisterBenchmark("BM_VoxelGrid_mug", &BM_VoxelGrid, argv[1])
       ->Unit(benchmark::kMillisecond);
+  benchmark::RegisterBenchmark("BM_VoxelGridThreads_mug", &BM_VoxelGridThreads, argv[1])
+      ->RangeMultiplier(2)
+      ->Range(1, 8)
+      ->UseRealTime()
+      ->Unit(benchmark::kMillisecond);
   benchmark::RegisterBenchmark(
       "BM_ApproximateVoxelGrid_mug", &BM_ApproxVoxelGrid, argv[1])
       ->Unit(benchmark::kMillisecond);
@@ -0,0 +1,96 @@
+#include <pcl/io/pcd_io.h> // for PCDReader, PCDWriter
+
+#include <boost/filesystem.hpp> // for unique_path, temp_directory_path
+
+#include <benchmark/benchmark.h>
+
+#include "../synthetic_clouds.h"
+
+namespace {
+enum class Format { ascii, binary, binary_compressed };
+
+std::string
+temporaryFile()
+{
+  return (boost::filesystem::temp_directory_path() /
+          boost::filesystem::unique_path("pcl_benchmark_%%%%-%%%%.pcd"))
+      .string();
+}
+
+void
+write(const std::string& file,
+      const pcl::PointCloud<pcl::PointXYZRGBNormal>& cloud,
+      Format format)
+{
+  pcl::PCDWriter writer;
+  switch (format) {
+  case Format::ascii:
+    writer.writeASCII(file, cloud);
+    break;
+  case Format::binary:
+    writer.writeBinary(file, cloud);
+    break;
+  case Format::binary_compressed:
+    writer.writeBinaryCompressed(file, cloud);
+    break;
+  }
+}
+} // namespace
+
+static void
+BM_PCDWrite(benchmark::State& state, Format format)
+{
+  const auto cloud =
+      pcl::benchmarks::makeUniformCloud<pcl::PointXYZRGBNormal>(state.range(0));
+  const std::string file = temporaryFile();
+  for (auto _ : state)
+    write(file, *cloud, format);
+  state.SetBytesProcessed(state.iterations() * cloud->size() *
+                          sizeof(pcl::PointXYZRGBNormal));
+  boost::filesystem::remove(file);
+}
+
+static void
+BM_PCDRead(benchmark::State& state, Format format)
+{
+  const auto cloud =
+      pcl::benchmarks::makeUniformCloud<pcl::PointXYZRGBNormal>(state.range(0));
+  const std::string file = temporaryFile();
+  write(file, *cloud, format);
+  pcl::PCDReader reader;
+  pcl::PointCloud<pcl::PointXYZRGBNormal> read_cloud;
+  for (auto _ : state) {
+    reader.read(file, read_cloud);
+    benchmark::DoNotOptimize(read_cloud.data());
+  }
+  state.SetBytesProcessed(state.iterations() * cloud->size() *
+                          sizeof(pcl::PointXYZRGBNormal));
+  boost::filesystem::remove(file);
+}
+
+BENCHMARK_CAPTURE(BM_PCDWrite, ascii, Format::ascii)
+    ->RangeMultiplier(8)
+    ->Range(1 << 12, 1 << 18)
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_PCDWrite, binary, Format::binary)
+    ->RangeMultiplier(8)
+    ->Range(1 << 12, 1 << 21)
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_PCDWrite, binary_compressed, Format::binary_compressed)
+    ->RangeMultiplier(8)
+    ->Range(1 << 12, 1 << 21)
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_PCDRead, ascii, Format::ascii)
+    ->RangeMultiplier(8)
+    ->Range(1 << 12, 1 << 18)
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_PCDRead, binary, Format::binary)
+    ->RangeMultiplier(8)
+    ->Range(1 << 12, 1 << 21)
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_PCDRead, binary_compressed, Format::binary_compressed)
+    ->RangeMultiplier(8)
+    ->Range(1 << 12, 1 << 21)
+    ->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,113 @@
+#include <pcl/octree/octree_search.h> // for OctreePointCloudSearch
+#include <pcl/point_types.h>
+
+#include <benchmark/benchmark.h>
+
+#include "../synthetic_clouds.h"
+
+static constexpr int num_queries = 10000;
+
+static void
+BM_OctreeBuild(benchmark::State& state)
+{
+  const auto cloud = pcl::benchmarks::makeUniformCloud<pcl::PointXYZ>(state.range(0));
+  for (auto _ : state) {
+    pcl::octree::OctreePointCloudSearch<pcl::PointXYZ> octree(0.1);
+    octree.setInputCloud(cloud);
+    octree.addPointsFromInputCloud();
+    benchmark::ClobberMemory();
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+static void
+BM_OctreeBuildThreads(benchmark::State& state)
+{
+  const auto cloud = pcl::benchmarks::makeUniformCloud<pcl::PointXYZ>(1 << 21);
+  for (auto _ : state) {
+    pcl::octree::OctreePointCloudSearch<pcl::PointXYZ> octree(0.1);
+    octree.setNumberOfThreads(static_cast<unsigned int>(state.range(0)));
+    octree.setInputCloud(cloud);
+    octree.addPointsFromInputCloud();
+    benchmark::ClobberMemory();
+  }
+  state.SetItemsProcessed(state.iterations() * cloud->size());
+}
+
+static void
+BM_OctreeNearestKSearch(benchmark::State& state)
+{
+  const auto cloud = pcl::benchmarks::makeUniformCloud<pcl::PointXYZ>(state.range(0));
+  const auto queries = pcl::benchmarks::makeUniformCloud<pcl::PointXYZ>(num_queries, 10.0f, 7);
+  pcl::octree::OctreePointCloudSearch<pcl::PointXYZ> octree(0.1);
+  octree.setInputCloud(cloud);
+  octree.addPointsFromInputCloud();
+  pcl::Indices indices;
+  std::vector<float> distances;
+  for (auto _ : state) {
+    for (const auto& query : *queries)
+      octree.nearestKSearch(query, static_cast<int>(state.range(1)), indices, distances);
+    benchmark::DoNotOptimize(indices.data());
+  }
+  state.SetItemsProcessed(state.iterations() * num_queries);
+}
+
+static void
+BM_OctreeRadiusSearch(benchmark::State& state)
+{
+  const auto cloud = pcl::benchmarks::makeUniformCloud<pcl::PointXYZ>(state.range(0));
+  const auto queries = pcl::benchmarks::makeUniformCloud<pcl::PointXYZ>(num_queries, 10.0f, 7);
+  pcl::octree::OctreePointCloudSearch<pcl::PointXYZ> octree(0.1);
+  octree.setInputCloud(cloud);
+  octree.addPointsFromInputCloud();
+  // About 30 neighbors per query, whatever the density
+  const double radius = 20.0 * std::cbrt(30.0 / (4.0 / 3.0 * M_PI * state.range(0)));
+  pcl::Indices indices;
+  std::vector<float> distances;
+  for (auto _ : state) {
+    for (const auto& query : *queries)
+      octree.radiusSearch(query, radius, indices, distances);
+    benchmark::DoNotOptimize(indices.data());
+  }
+  state.SetItemsProcessed(state.iterations() * num_queries);
+}
+
+static void
+BM_OctreeVoxelSearch(benchmark::State& state)
+{
+  const auto cloud = pcl::benchmarks::makeUniformCloud<pcl::PointXYZ>(state.range(0));
+  pcl::octree::OctreePointCloudSearch<pcl::PointXYZ> octree(0.5);
+  octree.setInputCloud(cloud);
+  octree.addPointsFromInputCloud();
+  pcl::Indices indices;
+  for (auto _ : state) {
+    for (int i = 0; i < num_queries; ++i)
+      octree.voxelSearch((*cloud)[i % cloud->size()], indices);
+    benchmark::DoNotOptimize(indices.data());
+  }
+  state.SetItemsProcessed(state.iterations() * num_queries);
+}
+
+BENCHMARK(BM_OctreeBuild)
+    ->RangeMultiplier(8)
+    ->Range(1 << 12, 1 << 21)
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_OctreeBuildThreads)
+    ->RangeMultiplier(2)
+    ->Range(1, 8)
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_OctreeNearestKSearch)
+    ->RangeMultiplier(8)
+    ->Ranges({{1 << 12, 1 << 21}, {1, 64}})
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_OctreeRadiusSearch)
+    ->RangeMultiplier(8)
+    ->Range(1 << 12, 1 << 21)
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_OctreeVoxelSearch)
+    ->RangeMultiplier(8)
+    ->Range(1 << 12, 1 << 21)
+    ->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
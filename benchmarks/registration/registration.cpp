@@ -0,0 +1,91 @@
+#include <pcl/common/transforms.h> // for transformPointCloud
+#include <pcl/registration/gicp.h>
+#include <pcl/registration/icp.h>
+#include <pcl/registration/ndt.h>
+
+#include <benchmark/benchmark.h>
+
+#include "../synthetic_clouds.h"
+
+namespace {
+// The registrations run a fixed number of iterations, so the timings compare the cost
+// per iteration instead of how quickly each method happens to converge
+constexpr int max_iterations = 10;
+
+using CloudPtr = pcl::PointCloud<pcl::PointXYZ>::Ptr;
+
+CloudPtr
+makeSource(const CloudPtr& target)
+{
+  Eigen::Affine3f transform = Eigen::Affine3f::Identity();
+  transform.translation() << 0.05f, -0.03f, 0.02f;
+  transform.rotate(Eigen::AngleAxisf(0.05f, Eigen::Vector3f::UnitZ()));
+  CloudPtr source(new pcl::PointCloud<pcl::PointXYZ>);
+  pcl::transformPointCloud(*target, *source, transform);
+  return source;
+}
+
+template <typename RegistrationT>
+void
+runRegistration(benchmark::State& state,
+                RegistrationT& registration,
+                const CloudPtr& source,
+                const CloudPtr& target)
+{
+  registration.setMaximumIterations(max_iterations);
+  registration.setTransformationEpsilon(0.0);
+  registration.setInputSource(source);
+  registration.setInputTarget(target);
+  pcl::PointCloud<pcl::PointXYZ> aligned;
+  for (auto _ : state) {
+    registration.align(aligned);
+    benchmark::DoNotOptimize(aligned.data());
+  }
+  state.SetItemsProcessed(state.iterations() * source->size());
+}
+} // namespace
+
+static void
+BM_IterativeClosestPoint(benchmark::State& state)
+{
+  const auto target = pcl::benchmarks::makeSurfaceCloud<pcl::PointXYZ>(state.range(0));
+  pcl::IterativeClosestPoint<pcl::PointXYZ, pcl::PointXYZ> icp;
+  icp.setMaxCorrespondenceDistance(0.5);
+  runRegistration(state, icp, makeSource(target), target);
+}
+
+static void
+BM_GeneralizedIterativeClosestPoint(benchmark::State& state)
+{
+  const auto target = pcl::benchmarks::makeSurfaceCloud<pcl::PointXYZ>(state.range(0));
+  pcl::GeneralizedIterativeClosestPoint<pcl::PointXYZ, pcl::PointXYZ> gicp;
+  gicp.setMaxCorrespondenceDistance(0.5);
+  gicp.setNumberOfThreads(static_cast<unsigned int>(state.range(1)));
+  runRegistration(state, gicp, makeSource(target), target);
+}
+
+static void
+BM_NormalDistributionsTransform(benchmark::State& state)
+{
+  const auto target = pcl::benchmarks::makeSurfaceCloud<pcl::PointXYZ>(state.range(0));
+  pcl::NormalDistributionsTransform<pcl::PointXYZ, pcl::PointXYZ> ndt;
+  ndt.setResolution(0.5f);
+  ndt.setStepSize(0.1);
+  ndt.setNumberOfThreads(static_cast<unsigned int>(state.range(1)));
+  runRegistration(state, ndt, makeSource(target), target);
+}
+
+BENCHMARK(BM_IterativeClosestPoint)
+    ->RangeMultiplier(4)
+    ->Range(1 << 12, 1 << 18)
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_GeneralizedIterativeClosestPoint)
+    ->ArgsProduct({{1 << 12, 1 << 15, 1 << 18}, {1, 2, 4, 8}})
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_NormalDistributionsTransform)
+    ->ArgsProduct({{1 << 12, 1 << 15, 1 << 18}, {1, 2, 4, 8}})
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,102 @@
+#include <pcl/search/kdtree.h> // for KdTree
+#include <pcl/point_types.h>
+
+#include <benchmark/benchmark.h>
+
+#include "../synthetic_clouds.h"
+
+static constexpr int num_queries = 10000;
+
+static void
+BM_KdTreeBuild(benchmark::State& state)
+{
+  const auto cloud = pcl::benchmarks::makeUniformCloud<pcl::PointXYZ>(state.range(0));
+  for (auto _ : state) {
+    pcl::search::KdTree<pcl::PointXYZ> tree;
+    tree.setInputCloud(cloud);
+    benchmark::ClobberMemory();
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+static void
+BM_KdTreeNearestKSearch(benchmark::State& state)
+{
+  const auto cloud = pcl::benchmarks::makeUniformCloud<pcl::PointXYZ>(state.range(0));
+  const auto queries = pcl::benchmarks::makeUniformCloud<pcl::PointXYZ>(num_queries, 10.0f, 7);
+  pcl::search::KdTree<pcl::PointXYZ> tree;
+  tree.setInputCloud(cloud);
+  pcl::Indices indices;
+  std::vector<float> distances;
+  for (auto _ : state) {
+    for (const auto& query : *queries)
+      tree.nearestKSearch(query, static_cast<int>(state.range(1)), indices, distances);
+    benchmark::DoNotOptimize(indices.data());
+  }
+  state.SetItemsProcessed(state.iterations() * num_queries);
+}
+
+static void
+BM_KdTreeRadiusSearch(benchmark::State& state)
+{
+  const auto cloud = pcl::benchmarks::makeUniformCloud<pcl::PointXYZ>(state.range(0));
+  const auto queries = pcl::benchmarks::makeUniformCloud<pcl::PointXYZ>(num_queries, 10.0f, 7);
+  pcl::search::KdTree<pcl::PointXYZ> tree;
+  tree.setInputCloud(cloud);
+  // About 30 neighbors per query, whatever the density
+  const double radius = 20.0 * std::cbrt(30.0 / (4.0 / 3.0 * M_PI * state.range(0)));
+  pcl::Indices indices;
+  std::vector<float> distances;
+  for (auto _ : state) {
+    for (const auto& query : *queries)
+      tree.radiusSearch(query, radius, indices, distances);
+    benchmark::DoNotOptimize(indices.data());
+  }
+  state.SetItemsProcessed(state.iterations() * num_queries);
+}
+
+#ifdef _OPENMP
+static void
+BM_KdTreeNearestKSearchThreads(benchmark::State& state)
+{
+  const auto cloud = pcl::benchmarks::makeUniformCloud<pcl::PointXYZ>(1 << 20);
+  const auto queries = pcl::benchmarks::makeUniformCloud<pcl::PointXYZ>(1 << 17, 10.0f, 7);
+  pcl::search::KdTree<pcl::PointXYZ> tree;
+  tree.setInputCloud(cloud);
+  const int nr_threads = static_cast<int>(state.range(0));
+  const int nr_queries = static_cast<int>(queries->size());
+  for (auto _ : state) {
+#pragma omp parallel num_threads(nr_threads)
+    {
+      pcl::Indices indices;
+      std::vector<float> distances;
+#pragma omp for schedule(static)
+      for (int i = 0; i < nr_queries; ++i)
+        tree.nearestKSearch((*queries)[i], 10, indices, distances);
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * nr_queries);
+}
+#endif
+
+BENCHMARK(BM_KdTreeBuild)
+    ->RangeMultiplier(8)
+    ->Range(1 << 12, 1 << 21)
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_KdTreeNearestKSearch)
+    ->RangeMultiplier(8)
+    ->Ranges({{1 << 12, 1 << 21}, {1, 64}})
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_KdTreeRadiusSearch)
+    ->RangeMultiplier(8)
+    ->Range(1 << 12, 1 << 21)
+    ->Unit(benchmark::kMillisecond);
+#ifdef _OPENMP
+BENCHMARK(BM_KdTreeNearestKSearchThreads)
+    ->RangeMultiplier(2)
+    ->Range(1, 8)
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+#endif
+
+BENCHMARK_MAIN();
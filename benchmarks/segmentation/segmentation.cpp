@@ -0,0 +1,62 @@
+#include <pcl/search/kdtree.h>
+#include <pcl/segmentation/extract_clusters.h>
+#include <pcl/segmentation/sac_segmentation.h>
+
+#include <benchmark/benchmark.h>
+
+#include "../synthetic_clouds.h"
+
+static void
+BM_EuclideanClusterExtraction(benchmark::State& state)
+{
+  // 64 blobs, far enough apart to be separated by the cluster tolerance
+  const auto cloud = pcl::benchmarks::makeClusteredCloud<pcl::PointXYZ>(
+      64, static_cast<std::size_t>(state.range(0) / 64));
+  pcl::search::KdTree<pcl::PointXYZ>::Ptr tree(new pcl::search::KdTree<pcl::PointXYZ>);
+  pcl::EuclideanClusterExtraction<pcl::PointXYZ> ec;
+  ec.setClusterTolerance(0.3);
+  ec.setMinClusterSize(10);
+  ec.setSearchMethod(tree);
+  ec.setNumberOfThreads(static_cast<unsigned int>(state.range(1)));
+  ec.setInputCloud(cloud);
+  std::vector<pcl::PointIndices> clusters;
+  for (auto _ : state) {
+    ec.extract(clusters);
+    benchmark::DoNotOptimize(clusters.data());
+  }
+  state.SetItemsProcessed(state.iterations() * cloud->size());
+  state.counters["clusters"] = static_cast<double>(clusters.size());
+}
+
+static void
+BM_SACSegmentationPlane(benchmark::State& state)
+{
+  const auto cloud =
+      pcl::benchmarks::makePlaneWithOutliers<pcl::PointXYZ>(state.range(0));
+  pcl::SACSegmentation<pcl::PointXYZ> seg;
+  seg.setModelType(pcl::SACMODEL_PLANE);
+  seg.setMethodType(pcl::SAC_RANSAC);
+  seg.setDistanceThreshold(0.05);
+  seg.setMaxIterations(200);
+  seg.setNumberOfThreads(static_cast<int>(state.range(1)));
+  seg.setInputCloud(cloud);
+  pcl::PointIndices inliers;
+  pcl::ModelCoefficients coefficients;
+  for (auto _ : state) {
+    seg.segment(inliers, coefficients);
+    benchmark::DoNotOptimize(inliers.indices.data());
+  }
+  state.SetItemsProcessed(state.iterations() * cloud->size());
+  state.counters["inliers"] = static_cast<double>(inliers.indices.size());
+}
+
+BENCHMARK(BM_EuclideanClusterExtraction)
+    ->ArgsProduct({{1 << 14, 1 << 17, 1 << 20}, {1, 2, 4, 8}})
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_SACSegmentationPlane)
+    ->ArgsProduct({{1 << 14, 1 << 17, 1 << 20}, {1, 2, 4, 8}})
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
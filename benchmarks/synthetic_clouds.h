@@ -0,0 +1,93 @@
+#pragma once
+
+#include <pcl/common/generate.h> // for CloudGenerator
+#include <pcl/common/random.h>   // for UniformGenerator, NormalGenerator
+#include <pcl/point_cloud.h>
+
+#include <cmath>
+#include <cstdint>
+
+// Reproducible synthetic clouds for the benchmarks: every generator is seeded, so each run
+// measures the same data.
+namespace pcl {
+namespace benchmarks {
+
+/** Points uniformly distributed in the cube [-extent, extent]^3. */
+template <typename PointT>
+typename pcl::PointCloud<PointT>::Ptr
+makeUniformCloud(std::size_t size, float extent = 10.0f, std::uint32_t seed = 1)
+{
+  using Parameters = pcl::common::UniformGenerator<float>::Parameters;
+  pcl::common::CloudGenerator<PointT, pcl::common::UniformGenerator<float>> generator(
+      Parameters(-extent, extent, seed));
+  typename pcl::PointCloud<PointT>::Ptr cloud(new pcl::PointCloud<PointT>);
+  generator.fill(static_cast<int>(size), 1, *cloud);
+  return cloud;
+}
+
+/** Noisy samples of the wavy surface z = sin(x) cos(y) / 2 over [-5, 5]^2, which
+ *  constrains all six degrees of freedom of a registration. */
+template <typename PointT>
+typename pcl::PointCloud<PointT>::Ptr
+makeSurfaceCloud(std::size_t size, float noise = 0.005f, std::uint32_t seed = 1)
+{
+  using Parameters = pcl::common::UniformGenerator<float>::Parameters;
+  pcl::common::CloudGenerator<PointT, pcl::common::UniformGenerator<float>> generator(
+      Parameters(-5.0f, 5.0f, seed));
+  pcl::common::NormalGenerator<float> z_noise(0.0f, noise, seed + 3);
+  typename pcl::PointCloud<PointT>::Ptr cloud(new pcl::PointCloud<PointT>);
+  generator.fill(static_cast<int>(size), 1, *cloud);
+  for (auto& point : *cloud)
+    point.z = 0.5f * std::sin(point.x) * std::cos(point.y) + z_noise.run();
+  return cloud;
+}
+
+/** Gaussian blobs of points_per_cluster points each with standard deviation sigma, on a
+ *  grid with the given spacing. */
+template <typename PointT>
+typename pcl::PointCloud<PointT>::Ptr
+makeClusteredCloud(std::size_t num_clusters,
+                   std::size_t points_per_cluster,
+                   float sigma = 0.2f,
+                   float spacing = 4.0f,
+                   std::uint32_t seed = 1)
+{
+  std::size_t side = 1;
+  while (side * side * side < num_clusters)
+    ++side;
+  typename pcl::PointCloud<PointT>::Ptr cloud(new pcl::PointCloud<PointT>);
+  for (std::size_t i = 0; i < num_clusters; ++i) {
+    using Parameters = pcl::common::NormalGenerator<float>::Parameters;
+    const auto seed_i = static_cast<std::uint32_t>(seed + 3 * i);
+    pcl::common::CloudGenerator<PointT, pcl::common::NormalGenerator<float>> generator(
+        Parameters(spacing * static_cast<float>(i % side), sigma, seed_i),
+        Parameters(spacing * static_cast<float>((i / side) % side), sigma, seed_i + 1),
+        Parameters(spacing * static_cast<float>(i / (side * side)), sigma, seed_i + 2));
+    pcl::PointCloud<PointT> cluster;
+    generator.fill(static_cast<int>(points_per_cluster), 1, cluster);
+    *cloud += cluster;
+  }
+  return cloud;
+}
+
+/** Noisy samples of the plane z = 0.1 x + 0.2 y + 1 over [-10, 10]^2, with a fraction of
+ *  the points replaced by uniform outliers. */
+template <typename PointT>
+typename pcl::PointCloud<PointT>::Ptr
+makePlaneWithOutliers(std::size_t size,
+                      float outlier_ratio = 0.3f,
+                      float noise = 0.01f,
+                      std::uint32_t seed = 1)
+{
+  const auto num_outliers = static_cast<std::size_t>(outlier_ratio * size);
+  typename pcl::PointCloud<PointT>::Ptr cloud =
+      makeUniformCloud<PointT>(size - num_outliers, 10.0f, seed);
+  pcl::common::NormalGenerator<float> z_noise(0.0f, noise, seed + 3);
+  for (auto& point : *cloud)
+    point.z = 0.1f * point.x + 0.2f * point.y + 1.0f + z_noise.run();
+  *cloud += *makeUniformCloud<PointT>(num_outliers, 10.0f, seed + 4);
+  return cloud;
+}
+
+} // namespace benchmarks
+} // namespace pcl
@@ -40,6 +40,10 @@ mark_as_advanced(PCL_ONLY_CORE_POINT_TYPES)
 option(PCL_NO_PRECOMPILE "Do not precompile PCL code for any point types at all." OFF)
 mark_as_advanced(PCL_NO_PRECOMPILE)
 
+# Record zones in the core algorithms for pcl::trace (zero cost when disabled)
+option(PCL_ENABLE_TRACING "Compile the tracing zones of pcl/common/trace.h into the PCL algorithms." OFF)
+mark_as_advanced(PCL_ENABLE_TRACING)
+
 # Enable or Disable the check for SSE optimizations
 option(PCL_ENABLE_SSE "Enable or Disable SSE optimizations." ON)
 mark_as_advanced(PCL_ENABLE_SSE)
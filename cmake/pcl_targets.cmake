@@ -450,7 +450,10 @@ function(PCL_ADD_BENCHMARK _name)
     endif()
   endif()
   
-  add_custom_target(run_benchmark_${_name} benchmark_${_name} ${PCL_ADD_BENCHMARK_ARGUMENTS})
+  # The results are also written as JSON, for comparing runs with compare.py of Google Benchmark
+  add_custom_target(run_benchmark_${_name} benchmark_${_name} ${PCL_ADD_BENCHMARK_ARGUMENTS}
+                    --benchmark_out=${CMAKE_CURRENT_BINARY_DIR}/benchmark_${_name}.json
+                    --benchmark_out_format=json)
   set_target_properties(run_benchmark_${_name} PROPERTIES FOLDER "Benchmarks")
   
   add_dependencies(run_benchmarks run_benchmark_${_name})
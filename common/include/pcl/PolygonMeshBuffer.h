@@ -0,0 +1,260 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#pragma once
+
+#include <pcl/PCLHeader.h>
+#include <pcl/PCLPointCloud2.h>
+#include <pcl/PolygonMesh.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <utility>
+#include <vector>
+
+namespace pcl
+{
+  /** \brief A polygon mesh with the polygons stored in two flat buffers, in compressed sparse row layout.
+    *
+    * The vertex indices of all polygons are concatenated in \a indices. Polygon i takes the indices
+    * [offsets[i], offsets[i + 1]), so \a offsets holds one entry more than there are polygons. Unlike
+    * pcl::PolygonMesh, which holds one pcl::Vertices vector per polygon, the whole mesh takes two allocations,
+    * and the index buffer of a triangle mesh can be uploaded to a GPU as is.
+    */
+  struct PolygonMeshBuffer
+  {
+    ::pcl::PCLHeader header;
+
+    ::pcl::PCLPointCloud2 cloud;
+
+    /** \brief The vertex indices of all polygons, concatenated. */
+    std::vector<std::uint32_t> indices;
+
+    /** \brief The position of the first index of every polygon in \a indices, followed by indices.size (). */
+    std::vector<std::uint32_t> offsets {0};
+
+    /** \brief Returns the number of polygons. */
+    inline std::size_t
+    size () const { return (offsets.empty () ? 0 : offsets.size () - 1); }
+
+    /** \brief Returns true if the mesh has no polygons. */
+    inline bool
+    empty () const { return (size () == 0); }
+
+    /** \brief Returns the number of vertices of polygon \a i. */
+    inline std::uint32_t
+    getPolygonSize (std::size_t i) const { return (offsets[i + 1] - offsets[i]); }
+
+    /** \brief Returns the first vertex index of polygon \a i. */
+    inline const std::uint32_t*
+    getPolygon (std::size_t i) const { return (indices.data () + offsets[i]); }
+
+    /** \brief Returns true if all polygons are triangles. */
+    inline bool
+    isTriangleMesh () const { return (indices.size () == 3 * size ()); }
+
+    /** \brief Remove all polygons, the cloud is kept. */
+    inline void
+    clearPolygons ()
+    {
+      indices.clear ();
+      offsets.assign (1, 0);
+    }
+
+    /** \brief Reserve space for \a nr_polygons polygons with \a nr_indices indices in total. */
+    inline void
+    reserve (std::size_t nr_polygons, std::size_t nr_indices)
+    {
+      offsets.reserve (nr_polygons + 1);
+      indices.reserve (nr_indices);
+    }
+
+    /** \brief Append a polygon.
+      * \param[in] begin the first vertex index of the polygon
+      * \param[in] end one past the last vertex index of the polygon
+      */
+    template <typename IteratorT> inline void
+    addPolygon (IteratorT begin, IteratorT end)
+    {
+      if (offsets.empty ())
+        offsets.push_back (0);
+      for (; begin != end; ++begin)
+        indices.push_back (static_cast<std::uint32_t> (*begin));
+      offsets.push_back (static_cast<std::uint32_t> (indices.size ()));
+    }
+
+    /** \brief Append a triangle. */
+    inline void
+    addTriangle (std::uint32_t v0, std::uint32_t v1, std::uint32_t v2)
+    {
+      const std::uint32_t triangle[3] = {v0, v1, v2};
+      addPolygon (triangle, triangle + 3);
+    }
+
+    /** \brief Replace the polygons by the ones of a flat index buffer in which every polygon takes
+      * \a vertices_per_polygon consecutive indices, taking over the buffer without copying it.
+      * \param[in] polygon_indices the index buffer, e.g. the output of OrganizedFastMesh
+      * \param[in] vertices_per_polygon the number of vertices of every polygon
+      */
+    inline void
+    setPolygons (std::vector<std::uint32_t> &&polygon_indices, std::uint32_t vertices_per_polygon)
+    {
+      indices = std::move (polygon_indices);
+      const std::size_t nr_polygons = indices.size () / vertices_per_polygon;
+      indices.resize (nr_polygons * vertices_per_polygon);
+      offsets.resize (nr_polygons + 1);
+      for (std::size_t i = 0; i <= nr_polygons; ++i)
+        offsets[i] = static_cast<std::uint32_t> (i * vertices_per_polygon);
+    }
+
+  public:
+    using Ptr = shared_ptr< ::pcl::PolygonMeshBuffer>;
+    using ConstPtr = shared_ptr<const ::pcl::PolygonMeshBuffer>;
+  }; // struct PolygonMeshBuffer
+
+  using PolygonMeshBufferPtr = PolygonMeshBuffer::Ptr;
+  using PolygonMeshBufferConstPtr = PolygonMeshBuffer::ConstPtr;
+
+  /** \brief Convert the polygons of a pcl::PolygonMesh to the flat layout of a pcl::PolygonMeshBuffer.
+    * \param[in] polygons the polygons
+    * \param[out] indices the concatenated vertex indices
+    * \param[out] offsets the position of the first index of every polygon, followed by indices.size ()
+    */
+  inline void
+  polygonsToBuffer (const std::vector< ::pcl::Vertices> &polygons,
+                    std::vector<std::uint32_t> &indices, std::vector<std::uint32_t> &offsets)
+  {
+    offsets.resize (polygons.size () + 1);
+    offsets[0] = 0;
+    std::size_t nr_indices = 0;
+    for (std::size_t i = 0; i < polygons.size (); ++i)
+    {
+      nr_indices += polygons[i].vertices.size ();
+      offsets[i + 1] = static_cast<std::uint32_t> (nr_indices);
+    }
+    indices.resize (nr_indices);
+    auto index = indices.begin ();
+    for (const auto &polygon : polygons)
+      for (const auto &vertex : polygon.vertices)
+        *index++ = static_cast<std::uint32_t> (vertex);
+  }
+
+  /** \brief Convert the flat polygons of a pcl::PolygonMeshBuffer to pcl::Vertices.
+    * \param[in] indices the concatenated vertex indices
+    * \param[in] offsets the position of the first index of every polygon, followed by indices.size ()
+    * \param[out] polygons the polygons
+    */
+  inline void
+  bufferToPolygons (const std::vector<std::uint32_t> &indices, const std::vector<std::uint32_t> &offsets,
+                    std::vector< ::pcl::Vertices> &polygons)
+  {
+    polygons.resize (offsets.empty () ? 0 : offsets.size () - 1);
+    for (std::size_t i = 0; i < polygons.size (); ++i)
+      polygons[i].vertices.assign (indices.begin () + offsets[i], indices.begin () + offsets[i + 1]);
+  }
+
+  /** \brief Convert a pcl::PolygonMesh to a pcl::PolygonMeshBuffer.
+    * \param[in] mesh the input mesh
+    * \param[out] buffer the output mesh
+    */
+  inline void
+  toPolygonMeshBuffer (const ::pcl::PolygonMesh &mesh, ::pcl::PolygonMeshBuffer &buffer)
+  {
+    buffer.header = mesh.header;
+    buffer.cloud = mesh.cloud;
+    polygonsToBuffer (mesh.polygons, buffer.indices, buffer.offsets);
+  }
+
+  /** \brief Convert a pcl::PolygonMesh to a pcl::PolygonMeshBuffer, taking over the cloud of the mesh
+    * without copying it.
+    * \param[in] mesh the input mesh, left with an empty cloud
+    * \param[out] buffer the output mesh
+    */
+  inline void
+  toPolygonMeshBuffer (::pcl::PolygonMesh &&mesh, ::pcl::PolygonMeshBuffer &buffer)
+  {
+    buffer.header = std::move (mesh.header);
+    buffer.cloud = std::move (mesh.cloud);
+    polygonsToBuffer (mesh.polygons, buffer.indices, buffer.offsets);
+    mesh.polygons.clear ();
+  }
+
+  /** \brief Convert a pcl::PolygonMeshBuffer to a pcl::PolygonMesh.
+    * \param[in] buffer the input mesh
+    * \param[out] mesh the output mesh
+    */
+  inline void
+  toPolygonMesh (const ::pcl::PolygonMeshBuffer &buffer, ::pcl::PolygonMesh &mesh)
+  {
+    mesh.header = buffer.header;
+    mesh.cloud = buffer.cloud;
+    bufferToPolygons (buffer.indices, buffer.offsets, mesh.polygons);
+  }
+
+  /** \brief Convert a pcl::PolygonMeshBuffer to a pcl::PolygonMesh, taking over the cloud of the buffer
+    * without copying it.
+    * \param[in] buffer the input mesh, left with an empty cloud and no polygons
+    * \param[out] mesh the output mesh
+    */
+  inline void
+  toPolygonMesh (::pcl::PolygonMeshBuffer &&buffer, ::pcl::PolygonMesh &mesh)
+  {
+    mesh.header = std::move (buffer.header);
+    mesh.cloud = std::move (buffer.cloud);
+    bufferToPolygons (buffer.indices, buffer.offsets, mesh.polygons);
+    buffer.clearPolygons ();
+  }
+
+  inline std::ostream& operator<<(std::ostream& s, const ::pcl::PolygonMeshBuffer &v)
+  {
+    s << "header: " << std::endl;
+    s << v.header;
+    s << "cloud: " << std::endl;
+    s << v.cloud;
+    s << "polygons[]" << std::endl;
+    for (std::size_t i = 0; i < v.size (); ++i)
+    {
+      s << "  polygons[" << i << "]:";
+      for (std::uint32_t j = v.offsets[i]; j < v.offsets[i + 1]; ++j)
+        s << " " << v.indices[j];
+      s << std::endl;
+    }
+    return (s);
+  }
+
+} // namespace pcl
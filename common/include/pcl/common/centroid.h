@@ -41,6 +41,7 @@
 #include <pcl/memory.h>
 #include <pcl/pcl_macros.h>
 #include <pcl/point_cloud.h>
+#include <pcl/point_cloud_soa.h>
 #include <pcl/type_traits.h>
 #include <pcl/PointIndices.h>
 #include <pcl/cloud_iterator.h>
@@ -106,6 +107,18 @@ namespace pcl
     return (compute3DCentroid <PointT, double> (cloud, centroid));
   }
 
+  /** \brief Compute the 3D (X-Y-Z) centroid of a columnar point cloud and return it as a 3D vector.
+    * \param[in] cloud the input point cloud, with FLOAT32 x, y and z fields
+    * \param[out] centroid the output centroid
+    * \return number of valid points used to determine the centroid. In case of dense point clouds, this is the same as the size of input cloud.
+    * \note if return value is 0, the centroid is not changed, thus not valid.
+    * The last component of the vector is set to 1, this allows to transform the centroid vector with 4x4 matrices.
+    * \ingroup common
+    */
+  template <typename Scalar> inline unsigned int
+  compute3DCentroid (const pcl::PointCloudSoA &cloud,
+                     Eigen::Matrix<Scalar, 4, 1> &centroid);
+
   /** \brief Compute the 3D (X-Y-Z) centroid of a set of points using their indices and
     * return it as a 3D vector.
     * \param[in] cloud the input point cloud
@@ -1033,6 +1046,14 @@ namespace pcl
       void
       add (const PointT& point);
 
+      /** Add all points accumulated by another centroid computation.
+        *
+        * The result is the same as if the points added to \a other had been
+        * added to this object, up to the rounding of the sums. This allows to
+        * accumulate parts of a cloud independently, e.g. in different threads. */
+      void
+      merge (const CentroidPoint& other);
+
       /** Retrieve the current centroid.
         *
         * Computation (division of accumulated values by the number of points
@@ -46,7 +46,7 @@
 
 #include <pcl/point_cloud.h> // for PointCloud
 #include <pcl/PointIndices.h> // for PointIndices
-namespace pcl { struct PCLPointCloud2; }
+namespace pcl { struct PCLPointCloud2; class PointCloudSoA; }
 
 /**
   * \file pcl/common/common.h
@@ -199,6 +199,16 @@ namespace pcl
   getMinMax3D (const pcl::PointCloud<PointT> &cloud, 
                Eigen::Vector4f &min_pt, Eigen::Vector4f &max_pt);
 
+  /** \brief Get the minimum and maximum values on each of the 3 (x-y-z) dimensions in a given columnar pointcloud
+    * \param[in] cloud the point cloud data, with FLOAT32 x, y and z fields
+    * \param[out] min_pt the resultant minimum bounds
+    * \param[out] max_pt the resultant maximum bounds
+    * \ingroup common
+    */
+  PCL_EXPORTS void
+  getMinMax3D (const pcl::PointCloudSoA &cloud,
+               Eigen::Vector4f &min_pt, Eigen::Vector4f &max_pt);
+
   /** \brief Get the minimum and maximum values on each of the 3 (x-y-z) dimensions in a given pointcloud
     * \param[in] cloud the point cloud data message
     * \param[in] indices the vector of point indices to use from \a cloud
@@ -0,0 +1,122 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#pragma once
+
+#include <pcl/pcl_macros.h>
+
+/**
+  * \file pcl/common/cpu_dispatch.h
+  * Runtime selection of the instruction set used by the vectorized kernels of PCL
+  * \ingroup common
+  */
+
+/*@{*/
+namespace pcl
+{
+  /** \brief Instruction set levels the runtime dispatched kernels of PCL are built for, from
+    * the most conservative to the most capable one. Every level includes the previous ones.
+    * \ingroup common
+    */
+  enum class SIMDLevel
+  {
+    NONE = 0,   ///< portable code only
+    SSE2 = 1,   ///< SSE2, the baseline of every x86-64 CPU
+    AVX = 2,    ///< AVX
+    AVX2 = 3,   ///< AVX2 and FMA
+    AVX512 = 4  ///< AVX-512 Foundation
+  };
+
+  /** \brief Get the most capable instruction set level supported by both the CPU and the
+    * operating system, as reported by CPUID. The detection runs once, on first use.
+    * \ingroup common
+    */
+  PCL_EXPORTS SIMDLevel
+  getSupportedSIMDLevel ();
+
+  /** \brief Get the instruction set level the dispatched kernels currently use.
+    *
+    * This is getSupportedSIMDLevel (), unless it was lowered with setSIMDLevel () or with the
+    * PCL_SIMD_LEVEL environment variable (one of "none", "sse2", "avx", "avx2" or "avx512").
+    * \ingroup common
+    */
+  PCL_EXPORTS SIMDLevel
+  getSIMDLevel ();
+
+  /** \brief Set the instruction set level the dispatched kernels use, e.g. to compare the
+    * results or the speed of the different code paths. Levels the CPU does not support are
+    * lowered to getSupportedSIMDLevel ().
+    * \param[in] level the requested instruction set level
+    * \ingroup common
+    */
+  PCL_EXPORTS void
+  setSIMDLevel (SIMDLevel level);
+
+  /** \brief Get the name of an instruction set level, as accepted by PCL_SIMD_LEVEL.
+    * \param[in] level the instruction set level
+    * \ingroup common
+    */
+  PCL_EXPORTS const char*
+  getSIMDLevelName (SIMDLevel level);
+}
+/*@}*/
+
+// Kernels for an instruction set are compiled when PCL_SIMD_KERNELS_<ISA> is defined. Mark them
+// with PCL_SIMD_TARGET_<ISA> and call them only if getSIMDLevel () is at least that level.
+// GCC and Clang compile them with target attributes, independently of the compiler flags;
+// other compilers only get the instruction sets enabled for the whole build.
+#if defined(__GNUC__) && defined(__SSE2__) && (defined(__x86_64__) || defined(__i386__))
+#define PCL_SIMD_KERNELS_AVX
+#define PCL_SIMD_KERNELS_AVX2
+#define PCL_SIMD_KERNELS_AVX512
+#define PCL_SIMD_TARGET_AVX __attribute__ ((target ("avx")))
+#define PCL_SIMD_TARGET_AVX2 __attribute__ ((target ("avx2,fma")))
+#define PCL_SIMD_TARGET_AVX512 __attribute__ ((target ("avx512f")))
+#else
+#if defined(__AVX__)
+#define PCL_SIMD_KERNELS_AVX
+#endif
+#if defined(__AVX2__) && defined(__FMA__)
+#define PCL_SIMD_KERNELS_AVX2
+#endif
+#if defined(__AVX512F__)
+#define PCL_SIMD_KERNELS_AVX512
+#endif
+#define PCL_SIMD_TARGET_AVX
+#define PCL_SIMD_TARGET_AVX2
+#define PCL_SIMD_TARGET_AVX512
+#endif
@@ -37,6 +37,7 @@
 
 #pragma once
 
+#include <cstddef>
 #include <limits>
 
 #include <pcl/types.h>
@@ -205,4 +206,41 @@ namespace pcl
   {
     return (std::sqrt (squaredEuclideanDistance (p1, p2)));
   }
+
+  /** \brief Calculate the squared L2 distance between two float vectors, e.g. descriptors, with
+    * the widest SIMD kernel pcl::getSIMDLevel () allows.
+    * \param[in] a the first vector
+    * \param[in] b the second vector
+    * \param[in] dim the number of elements of both vectors
+    * \note The summation order depends on the instruction set, so results of different levels
+    * may differ in the last bits.
+    * \ingroup common
+    */
+  PCL_EXPORTS float
+  squaredL2Distance (const float* a, const float* b, std::size_t dim);
+
+  /** \brief Calculate the chi-square distance sum ((a_i - b_i)^2 / (a_i + b_i)) between two
+    * histograms, skipping the bins where a_i + b_i is zero, with the widest SIMD kernel
+    * pcl::getSIMDLevel () allows. Same result as pcl::CS_Norm up to the summation order.
+    * \param[in] a the first histogram
+    * \param[in] b the second histogram
+    * \param[in] dim the number of bins of both histograms
+    * \ingroup common
+    */
+  PCL_EXPORTS float
+  chiSquareDistance (const float* a, const float* b, std::size_t dim);
+
+  /** \brief Calculate the squared L2 distances between a query vector and a block of rows,
+    * e.g. for a brute force search over a descriptor database.
+    * \param[in] query the query vector
+    * \param[in] rows the first row
+    * \param[in] nr_rows the number of rows
+    * \param[in] stride the distance between the starts of two rows, in floats
+    * \param[in] dim the number of elements of the query and every row
+    * \param[out] distances the nr_rows distances
+    * \ingroup common
+    */
+  PCL_EXPORTS void
+  squaredL2Distances (const float* query, const float* rows, std::size_t nr_rows,
+                      std::size_t stride, std::size_t dim, float* distances);
 }
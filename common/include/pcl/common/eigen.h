@@ -53,6 +53,9 @@
 #endif
 
 #include <pcl/ModelCoefficients.h>
+#include <pcl/pcl_macros.h>
+
+#include <cstddef>
 
 #include <Eigen/StdVector>
 #include <Eigen/Geometry>
@@ -129,6 +132,30 @@ namespace pcl
   template <typename Matrix, typename Vector> void
   eigen33 (const Matrix &mat, Matrix &evecs, Vector &evals);
 
+  /** \brief determines the smallest eigenvalue and its eigenvector for each matrix of a batch of symmetric positive
+    * semi definite matrices, like eigen33 (mat, eigenvalue, eigenvector) does for a single one
+    *
+    * Matrix i is [xx[i] xy[i] xz[i]; xy[i] yy[i] yz[i]; xz[i] yz[i] zz[i]]. The float version solves several
+    * matrices at once, one per SIMD lane, with the instruction set chosen by pcl::getSIMDLevel (); the results agree
+    * with eigen33 up to rounding errors. No memory is allocated.
+    * \param[in] xx, xy, xz, yy, yz, zz the upper triangles of the input matrices
+    * \param[in] count the number of matrices
+    * \param[out] eigenvalues the smallest eigenvalue of each matrix
+    * \param[out] x, y, z the components of the corresponding eigenvectors
+    * \ingroup common
+    */
+  PCL_EXPORTS void
+  eigen33Batch (const float* xx, const float* xy, const float* xz, const float* yy, const float* yz, const float* zz,
+                std::size_t count, float* eigenvalues, float* x, float* y, float* z);
+
+  /** \brief determines the smallest eigenvalue and its eigenvector for each matrix of a batch of symmetric positive
+    * semi definite matrices, see the float version
+    * \ingroup common
+    */
+  PCL_EXPORTS void
+  eigen33Batch (const double* xx, const double* xy, const double* xz, const double* yy, const double* yz, const double* zz,
+                std::size_t count, double* eigenvalues, double* x, double* y, double* z);
+
   /** \brief Calculate the inverse of a 2x2 matrix
     * \param[in] matrix matrix to be inverted
     * \param[out] inverse the resultant inverted matrix
@@ -0,0 +1,135 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2019-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <pcl/pcl_macros.h>
+
+/**
+  * \file pcl/common/execution_context.h
+  * Process wide budget of the threads used by the parallel (OpenMP) algorithms of PCL.
+  * \ingroup common
+  */
+
+/*@{*/
+namespace pcl
+{
+  /** \brief Process wide budget of the worker threads of the parallel algorithms.
+    *
+    * Every parallel region of the OMP classes (NormalEstimationOMP, FPFHEstimationOMP,
+    * RandomSampleConsensus, ...) takes its threads from this budget through a
+    * ThreadReservation, so that algorithms which run at the same time, e.g. called from
+    * the workers of an application thread pool, share the cores instead of each starting
+    * a team of the size of the machine. By default the budget is the number of processors.
+    *
+    * \code
+    * // Leave two cores to the rest of the application
+    * pcl::ExecutionContext::setThreadBudget (pcl::ExecutionContext::getHardwareConcurrency () - 2);
+    * \endcode
+    * \ingroup common
+    */
+  class PCL_EXPORTS ExecutionContext
+  {
+    public:
+      /** \brief Get the number of processors, 1 if PCL was built without OpenMP. */
+      static unsigned int
+      getHardwareConcurrency () noexcept;
+
+      /** \brief Get the maximum number of threads that all parallel regions use together. */
+      static unsigned int
+      getThreadBudget () noexcept;
+
+      /** \brief Set the maximum number of threads that all parallel regions use together.
+        * Regions that are already running keep their threads.
+        * \param[in] budget the number of threads, 0 restores getHardwareConcurrency ()
+        */
+      static void
+      setThreadBudget (unsigned int budget) noexcept;
+
+      /** \brief Get the number of threads currently reserved by running parallel regions. */
+      static unsigned int
+      getNumberOfReservedThreads () noexcept;
+  };
+
+  /** \brief Reserves threads from the ExecutionContext budget for one parallel region, and
+    * returns them when it goes out of scope.
+    *
+    * A reservation gets the requested number of threads if the budget allows it, and
+    * otherwise what is left of the budget, but always at least the calling thread.
+    * Reservations made while the calling thread already holds one, e.g. by an algorithm
+    * that is called by another, share the threads of the outer reservation instead of
+    * taking more from the budget. Inside a running parallel region the threads are
+    * already accounted for, so nested regions get a single thread.
+    *
+    * \code
+    * const pcl::ThreadReservation reservation (threads_);
+    * unsigned int threads = reservation.getNumberOfThreads ();
+    * #pragma omp parallel for num_threads(threads)
+    * for (...)
+    * \endcode
+    * \ingroup common
+    */
+  class PCL_EXPORTS ThreadReservation
+  {
+    public:
+      /** \brief Reserve threads.
+        * \param[in] nr_threads the number of threads wanted, 0 for as many as the budget allows
+        */
+      explicit ThreadReservation (unsigned int nr_threads);
+
+      ThreadReservation (const ThreadReservation&) = delete;
+      ThreadReservation&
+      operator= (const ThreadReservation&) = delete;
+
+      /** \brief Return the threads to the budget. */
+      ~ThreadReservation ();
+
+      /** \brief Get the number of threads the parallel region may use, at least 1. */
+      unsigned int
+      getNumberOfThreads () const noexcept
+      {
+        return (nr_threads_);
+      }
+
+    private:
+      /** \brief Number of threads granted to the region. */
+      unsigned int nr_threads_;
+
+      /** \brief Number of threads taken from the budget, 0 for nested regions. */
+      unsigned int reserved_;
+  };
+}
+/*@}*/
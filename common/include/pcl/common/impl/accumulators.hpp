@@ -44,6 +44,7 @@
 #include <boost/fusion/include/mpl.hpp>
 #include <boost/fusion/include/for_each.hpp>
 #include <boost/fusion/include/as_vector.hpp>
+#include <boost/fusion/include/find.hpp>
 #include <boost/fusion/include/filter_if.hpp>
 
 #include <pcl/memory.h>
@@ -80,6 +81,9 @@ namespace pcl
       template <typename PointT> void
       get (PointT& t, std::size_t n) const { t.getVector3fMap () = xyz / n; }
 
+      void
+      merge (const AccumulatorXYZ& other) { xyz += other.xyz; }
+
       PCL_MAKE_ALIGNED_OPERATOR_NEW
 
     };
@@ -98,6 +102,9 @@ namespace pcl
       template <typename PointT> void
       add (const PointT& t) { normal += t.getNormalVector4fMap (); }
 
+      void
+      merge (const AccumulatorNormal& other) { normal += other.normal; }
+
       template <typename PointT> void
       get (PointT& t, std::size_t) const
       {
@@ -130,6 +137,9 @@ namespace pcl
       template <typename PointT> void
       get (PointT& t, std::size_t n) const { t.curvature = curvature / n; }
 
+      void
+      merge (const AccumulatorCurvature& other) { curvature += other.curvature; }
+
     };
 
     struct AccumulatorRGBA
@@ -150,6 +160,15 @@ namespace pcl
         a += static_cast<float> (t.a);
       }
 
+      void
+      merge (const AccumulatorRGBA& other)
+      {
+        r += other.r;
+        g += other.g;
+        b += other.b;
+        a += other.a;
+      }
+
       template <typename PointT> void
       get (PointT& t, std::size_t n) const
       {
@@ -176,6 +195,9 @@ namespace pcl
       template <typename PointT> void
       get (PointT& t, std::size_t n) const { t.intensity = intensity / n; }
 
+      void
+      merge (const AccumulatorIntensity& other) { intensity += other.intensity; }
+
     };
 
     struct AccumulatorLabel
@@ -198,6 +220,13 @@ namespace pcl
           ++itr->second;
       }
 
+      void
+      merge (const AccumulatorLabel& other)
+      {
+        for (const auto &label : other.labels)
+          labels[label.first] += label.second;
+      }
+
       template <typename PointT> void
       get (PointT& t, std::size_t) const
       {
@@ -263,6 +292,24 @@ namespace pcl
 
     };
 
+    /* Fusion function object to merge the accumulators of another fusion
+     * sequence into the accumulators of the same type. */
+    template <typename AccumulatorsT>
+    struct MergeAccumulators
+    {
+
+      const AccumulatorsT& other;
+
+      MergeAccumulators (const AccumulatorsT& accumulators) : other (accumulators) { }
+
+      template <typename AccumulatorT> void
+      operator () (AccumulatorT& accumulator) const
+      {
+        accumulator.merge (*boost::fusion::find<AccumulatorT> (other));
+      }
+
+    };
+
     /* Fusion function object to invoke get point on every accumulator in a
      * fusion sequence. */
     template <typename PointT>
@@ -43,6 +43,7 @@
 #include <pcl/common/centroid.h>
 #include <pcl/conversions.h>
 #include <pcl/common/point_tests.h> // for pcl::isFinite
+#include <pcl/type_traits.h> // for pcl::void_t
 
 #include <boost/fusion/algorithm/transformation/filter_if.hpp> // for boost::fusion::filter_if
 #include <boost/fusion/algorithm/iteration/for_each.hpp> // for boost::fusion::for_each
@@ -52,6 +53,126 @@
 namespace pcl
 {
 
+namespace detail
+{
+/** Whether the coordinates of PointT are stored in a float[4] data member. */
+template <typename PointT, typename = void_t<>>
+struct HasPoint4D : std::false_type {};
+
+template <typename PointT>
+struct HasPoint4D<PointT, void_t<decltype (PointT::data)>>
+  : std::is_same<decltype (PointT::data), float[4]> {};
+
+/** Clouds of up to this many points are reduced serially, in point order. Larger ones are
+  * split into blocks of this size, which are reduced in parallel and then combined in block
+  * order, so that the result does not depend on the number of threads. The loops that
+  * transform clouds point by point run in parallel from this size on as well.
+  */
+constexpr std::size_t reduction_block_size = 65536;
+
+/** Add the coordinates of a point to sum, four at a time if PointT stores them in a float[4].
+  * The fourth coefficient of sum is left undefined.
+  */
+template <typename PointT, typename Scalar,
+          typename std::enable_if<HasPoint4D<PointT>::value, bool>::type = true> inline void
+addXYZ (const PointT &point, Eigen::Matrix<Scalar, 4, 1> &sum)
+{
+  sum += point.getVector4fMap ().template cast<Scalar> ();
+}
+
+template <typename PointT, typename Scalar,
+          typename std::enable_if<!HasPoint4D<PointT>::value, bool>::type = true> inline void
+addXYZ (const PointT &point, Eigen::Matrix<Scalar, 4, 1> &sum)
+{
+  sum[0] += point.x;
+  sum[1] += point.y;
+  sum[2] += point.z;
+}
+
+/** Add up the coordinates of nr_points points, given by point (i), to sum, skipping the
+  * points that are not finite with CheckFinite. Runs in blocks of reduction_block_size.
+  * \return the number of points added to sum
+  */
+template <bool CheckFinite, typename PointAccess, typename Scalar> std::size_t
+sumXYZ (const PointAccess &point, std::size_t nr_points, Eigen::Matrix<Scalar, 4, 1> &sum)
+{
+  const auto sumRange = [&point] (std::size_t begin, std::size_t end, Eigen::Matrix<Scalar, 4, 1> &range_sum)
+  {
+    std::size_t count = 0;
+    for (std::size_t i = begin; i < end; ++i)
+    {
+      // Check if the point is invalid
+      if (CheckFinite && !isFinite (point (i)))
+        continue;
+      addXYZ (point (i), range_sum);
+      ++count;
+    }
+    return (count);
+  };
+
+  if (nr_points <= reduction_block_size)
+    return (sumRange (0, nr_points, sum));
+
+  const std::ptrdiff_t nr_blocks = (nr_points + reduction_block_size - 1) / reduction_block_size;
+  std::vector<Eigen::Matrix<Scalar, 4, 1>, Eigen::aligned_allocator<Eigen::Matrix<Scalar, 4, 1>>>
+    block_sums (nr_blocks, Eigen::Matrix<Scalar, 4, 1>::Zero ());
+  std::vector<std::size_t> block_counts (nr_blocks);
+#pragma omp parallel for \
+  default(none) \
+  shared(block_counts, block_sums, nr_blocks, nr_points, sumRange) \
+  schedule(dynamic, 1)
+  for (std::ptrdiff_t block = 0; block < nr_blocks; ++block)
+  {
+    const std::size_t begin = block * reduction_block_size;
+    block_counts[block] = sumRange (begin, std::min (nr_points, begin + reduction_block_size), block_sums[block]);
+  }
+
+  std::size_t count = 0;
+  for (std::ptrdiff_t block = 0; block < nr_blocks; ++block)
+  {
+    sum += block_sums[block];
+    count += block_counts[block];
+  }
+  return (count);
+}
+
+/** Add nr_points points, given by point (i), to a CentroidPoint, skipping the points that are
+  * not finite with CheckFinite. Runs in blocks of reduction_block_size.
+  */
+template <bool CheckFinite, typename PointT, typename PointAccess> void
+addPoints (const PointAccess &point, std::size_t nr_points, pcl::CentroidPoint<PointT> &centroid)
+{
+  const auto addRange = [&point] (std::size_t begin, std::size_t end, pcl::CentroidPoint<PointT> &range_centroid)
+  {
+    for (std::size_t i = begin; i < end; ++i)
+      if (!CheckFinite || pcl::isFinite (point (i)))
+        range_centroid.add (point (i));
+  };
+
+  if (nr_points <= reduction_block_size)
+  {
+    addRange (0, nr_points, centroid);
+    return;
+  }
+
+  const std::ptrdiff_t nr_blocks = (nr_points + reduction_block_size - 1) / reduction_block_size;
+  std::vector<pcl::CentroidPoint<PointT>, Eigen::aligned_allocator<pcl::CentroidPoint<PointT>>> block_centroids (nr_blocks);
+#pragma omp parallel for \
+  default(none) \
+  shared(addRange, block_centroids, nr_blocks, nr_points) \
+  schedule(dynamic, 1)
+  for (std::ptrdiff_t block = 0; block < nr_blocks; ++block)
+  {
+    const std::size_t begin = block * reduction_block_size;
+    addRange (begin, std::min (nr_points, begin + reduction_block_size), block_centroids[block]);
+  }
+
+  for (const auto &block_centroid : block_centroids)
+    centroid.merge (block_centroid);
+}
+} // namespace detail
+
+
 template <typename PointT, typename Scalar> inline unsigned int
 compute3DCentroid (ConstCloudIterator<PointT> &cloud_iterator,
                    Eigen::Matrix<Scalar, 4, 1> &centroid)
@@ -90,16 +211,43 @@ compute3DCentroid (const pcl::PointCloud<PointT> &cloud,
 
   // Initialize to 0
   centroid.setZero ();
-  // For each point in the cloud
+  const auto point = [&cloud] (std::size_t i) -> const PointT& { return (cloud[i]); };
+  // If the data is dense, we don't need to check for NaN
+  const std::size_t cp = (cloud.is_dense ? detail::sumXYZ<false> (point, cloud.size (), centroid)
+                                         : detail::sumXYZ<true> (point, cloud.size (), centroid));
+  centroid /= static_cast<Scalar> (cp);
+  centroid[3] = 1;
+
+  return (static_cast<unsigned int> (cp));
+}
+
+
+template <typename Scalar> inline unsigned int
+compute3DCentroid (const pcl::PointCloudSoA &cloud,
+                   Eigen::Matrix<Scalar, 4, 1> &centroid)
+{
+  const float *x = cloud.getFieldData<float> ("x");
+  const float *y = cloud.getFieldData<float> ("y");
+  const float *z = cloud.getFieldData<float> ("z");
+  if (!x || !y || !z)
+  {
+    PCL_ERROR ("[pcl::compute3DCentroid] Input dataset doesn't have FLOAT32 x-y-z columns!\n");
+    return (0);
+  }
+  if (cloud.empty ())
+    return (0);
+
+  Scalar sum_x = 0, sum_y = 0, sum_z = 0;
   // If the data is dense, we don't need to check for NaN
   if (cloud.is_dense)
   {
-    for (const auto& point: cloud)
+    for (std::size_t i = 0; i < cloud.size (); ++i)
     {
-      centroid[0] += point.x;
-      centroid[1] += point.y;
-      centroid[2] += point.z;
+      sum_x += x[i];
+      sum_y += y[i];
+      sum_z += z[i];
     }
+    centroid << sum_x, sum_y, sum_z, 0;
     centroid /= static_cast<Scalar> (cloud.size ());
     centroid[3] = 1;
 
@@ -107,17 +255,18 @@ compute3DCentroid (const pcl::PointCloud<PointT> &cloud,
   }
   // NaN or Inf values could exist => check for them
   unsigned cp = 0;
-  for (const auto& point: cloud)
+  for (std::size_t i = 0; i < cloud.size (); ++i)
   {
     // Check if the point is invalid
-    if (!isFinite (point))
+    if (!std::isfinite (x[i]) || !std::isfinite (y[i]) || !std::isfinite (z[i]))
       continue;
 
-    centroid[0] += point.x;
-    centroid[1] += point.y;
-    centroid[2] += point.z;
+    sum_x += x[i];
+    sum_y += y[i];
+    sum_z += z[i];
     ++cp;
   }
+  centroid << sum_x, sum_y, sum_z, 0;
   centroid /= static_cast<Scalar> (cp);
   centroid[3] = 1;
 
@@ -135,35 +284,13 @@ compute3DCentroid (const pcl::PointCloud<PointT> &cloud,
 
   // Initialize to 0
   centroid.setZero ();
+  const auto point = [&cloud, &indices] (std::size_t i) -> const PointT& { return (cloud[indices[i]]); };
   // If the data is dense, we don't need to check for NaN
-  if (cloud.is_dense)
-  {
-    for (const auto& index : indices)
-    {
-      centroid[0] += cloud[index].x;
-      centroid[1] += cloud[index].y;
-      centroid[2] += cloud[index].z;
-    }
-    centroid /= static_cast<Scalar> (indices.size ());
-    centroid[3] = 1;
-    return (static_cast<unsigned int> (indices.size ()));
-  }
-  // NaN or Inf values could exist => check for them
-    unsigned cp = 0;
-  for (const auto& index : indices)
-  {
-    // Check if the point is invalid
-    if (!isFinite (cloud [index]))
-      continue;
-
-    centroid[0] += cloud[index].x;
-    centroid[1] += cloud[index].y;
-    centroid[2] += cloud[index].z;
-    ++cp;
-  }
+  const std::size_t cp = (cloud.is_dense ? detail::sumXYZ<false> (point, indices.size (), centroid)
+                                         : detail::sumXYZ<true> (point, indices.size (), centroid));
   centroid /= static_cast<Scalar> (cp);
   centroid[3] = 1;
-  return (cp);
+  return (static_cast<unsigned int> (cp));
 }
 
 
@@ -176,6 +303,104 @@ compute3DCentroid (const pcl::PointCloud<PointT> &cloud,
 }
 
 
+namespace detail
+{
+/** \brief Add the sums of xx, xy, xz, yy, yz, zz, x, y and z over a set of points to accu,
+  * using the fastest kernel allowed by pcl::getSIMDLevel ().
+  * \param[in] src the coordinates of the first point, which must be followed by a fourth float
+  * \param[in] stride the distance between two consecutive points, in bytes
+  * \param[in] indices the indices of the points to use, or nullptr to use the first nr_points points
+  * \param[in] nr_points the number of points
+  * \param[in] check_finite skip the points whose coordinates are not finite
+  * \param[in,out] accu the nine sums
+  * \return the number of points added to the sums
+  */
+PCL_EXPORTS std::size_t
+accumulateCovariance (const float* src, std::size_t stride, const index_t* indices,
+                      std::size_t nr_points, bool check_finite, float accu[9]);
+
+PCL_EXPORTS std::size_t
+accumulateCovariance (const float* src, std::size_t stride, const index_t* indices,
+                      std::size_t nr_points, bool check_finite, double accu[9]);
+
+/** \brief Add the sums of xx, xy, xz, yy, yz and zz over a set of points, minus centroid, to
+  * accu, using the fastest kernel allowed by pcl::getSIMDLevel ().
+  * \param[in] centroid the point subtracted from every point
+  * \see accumulateCovariance for the other parameters
+  */
+PCL_EXPORTS std::size_t
+accumulateDemeanedCovariance (const float* src, std::size_t stride, const index_t* indices,
+                              std::size_t nr_points, bool check_finite,
+                              const float centroid[3], float accu[6]);
+
+PCL_EXPORTS std::size_t
+accumulateDemeanedCovariance (const float* src, std::size_t stride, const index_t* indices,
+                              std::size_t nr_points, bool check_finite,
+                              const double centroid[3], double accu[6]);
+
+/** Whether the vectorized covariance kernels support PointT and Scalar. */
+template <typename PointT, typename Scalar>
+using HasCovarianceKernels = std::integral_constant<bool, HasPoint4D<PointT>::value &&
+    (std::is_same<Scalar, float>::value || std::is_same<Scalar, double>::value)>;
+
+/** Accumulate the sums of computeMeanAndCovarianceMatrix () with the vectorized kernels.
+  * Returns false, leaving the work to the caller, if the point type or the precision are
+  * not supported.
+  */
+template <typename PointT, typename Scalar,
+          typename std::enable_if<!HasCovarianceKernels<PointT, Scalar>::value, bool>::type = true> inline bool
+accumulateCloudCovariance (const pcl::PointCloud<PointT>&, const index_t*, std::size_t,
+                           Eigen::Matrix<Scalar, 1, 9, Eigen::RowMajor>&, std::size_t&)
+{
+  return (false);
+}
+
+template <typename PointT, typename Scalar,
+          typename std::enable_if<HasCovarianceKernels<PointT, Scalar>::value, bool>::type = true> inline bool
+accumulateCloudCovariance (const pcl::PointCloud<PointT>& cloud, const index_t* indices, std::size_t nr_points,
+                           Eigen::Matrix<Scalar, 1, 9, Eigen::RowMajor>& accu, std::size_t& point_count)
+{
+  point_count = 0;
+  if (nr_points != 0)
+    point_count = accumulateCovariance (cloud[0].data, sizeof (PointT), indices, nr_points,
+                                        !cloud.is_dense, accu.data ());
+  return (true);
+}
+
+/** Compute the covariance matrix of computeCovarianceMatrix () with the vectorized kernels.
+  * Returns false, leaving the work to the caller, if the point type or the precision are
+  * not supported.
+  */
+template <typename PointT, typename Scalar,
+          typename std::enable_if<!HasCovarianceKernels<PointT, Scalar>::value, bool>::type = true> inline bool
+accumulateCloudDemeanedCovariance (const pcl::PointCloud<PointT>&, const index_t*, std::size_t,
+                                   const Eigen::Matrix<Scalar, 4, 1>&, Eigen::Matrix<Scalar, 3, 3>&,
+                                   std::size_t&)
+{
+  return (false);
+}
+
+template <typename PointT, typename Scalar,
+          typename std::enable_if<HasCovarianceKernels<PointT, Scalar>::value, bool>::type = true> inline bool
+accumulateCloudDemeanedCovariance (const pcl::PointCloud<PointT>& cloud, const index_t* indices, std::size_t nr_points,
+                                   const Eigen::Matrix<Scalar, 4, 1>& centroid,
+                                   Eigen::Matrix<Scalar, 3, 3>& covariance_matrix, std::size_t& point_count)
+{
+  const Scalar c[3] = {centroid[0], centroid[1], centroid[2]};
+  Scalar accu[6] = {0, 0, 0, 0, 0, 0};
+  point_count = 0;
+  if (nr_points != 0)
+    point_count = accumulateDemeanedCovariance (cloud[0].data, sizeof (PointT), indices, nr_points,
+                                                !cloud.is_dense, c, accu);
+  covariance_matrix << accu[0], accu[1], accu[2],
+                       accu[1], accu[3], accu[4],
+                       accu[2], accu[4], accu[5];
+  return (true);
+}
+
+} // namespace detail
+
+
 template <typename PointT, typename Scalar> inline unsigned
 computeCovarianceMatrix (const pcl::PointCloud<PointT> &cloud,
                          const Eigen::Matrix<Scalar, 4, 1> &centroid,
@@ -184,6 +409,11 @@ computeCovarianceMatrix (const pcl::PointCloud<PointT> &cloud,
   if (cloud.empty ())
     return (0);
 
+  // Point types with a float[4] data member and float or double matrices use the vectorized kernels
+  std::size_t vectorized_count;
+  if (detail::accumulateCloudDemeanedCovariance (cloud, nullptr, cloud.size (), centroid, covariance_matrix, vectorized_count))
+    return (static_cast<unsigned int> (vectorized_count));
+
   // Initialize to 0
   covariance_matrix.setZero ();
 
@@ -268,6 +498,11 @@ computeCovarianceMatrix (const pcl::PointCloud<PointT> &cloud,
   if (indices.empty ())
     return (0);
 
+  // Point types with a float[4] data member and float or double matrices use the vectorized kernels
+  std::size_t vectorized_count;
+  if (detail::accumulateCloudDemeanedCovariance (cloud, indices.data (), indices.size (), centroid, covariance_matrix, vectorized_count))
+    return (static_cast<unsigned int> (vectorized_count));
+
   // Initialize to 0
   covariance_matrix.setZero ();
 
@@ -489,41 +724,45 @@ computeMeanAndCovarianceMatrix (const pcl::PointCloud<PointT> &cloud,
   // create the buffer on the stack which is much faster than using cloud[indices[i]] and centroid as a buffer
   Eigen::Matrix<Scalar, 1, 9, Eigen::RowMajor> accu = Eigen::Matrix<Scalar, 1, 9, Eigen::RowMajor>::Zero ();
   std::size_t point_count;
-  if (cloud.is_dense)
+  // Point types with a float[4] data member and float or double accumulators use the vectorized kernels
+  if (!detail::accumulateCloudCovariance (cloud, nullptr, cloud.size (), accu, point_count))
   {
-    point_count = cloud.size ();
-    // For each point in the cloud
-    for (const auto& point: cloud)
+    if (cloud.is_dense)
     {
-      accu [0] += point.x * point.x;
-      accu [1] += point.x * point.y;
-      accu [2] += point.x * point.z;
-      accu [3] += point.y * point.y; // 4
-      accu [4] += point.y * point.z; // 5
-      accu [5] += point.z * point.z; // 8
-      accu [6] += point.x;
-      accu [7] += point.y;
-      accu [8] += point.z;
+      point_count = cloud.size ();
+      // For each point in the cloud
+      for (const auto& point: cloud)
+      {
+        accu [0] += point.x * point.x;
+        accu [1] += point.x * point.y;
+        accu [2] += point.x * point.z;
+        accu [3] += point.y * point.y; // 4
+        accu [4] += point.y * point.z; // 5
+        accu [5] += point.z * point.z; // 8
+        accu [6] += point.x;
+        accu [7] += point.y;
+        accu [8] += point.z;
+      }
     }
-  }
-  else
-  {
-    point_count = 0;
-    for (const auto& point: cloud)
+    else
     {
-      if (!isFinite (point))
-        continue;
-
-      accu [0] += point.x * point.x;
-      accu [1] += point.x * point.y;
-      accu [2] += point.x * point.z;
-      accu [3] += point.y * point.y;
-      accu [4] += point.y * point.z;
-      accu [5] += point.z * point.z;
-      accu [6] += point.x;
-      accu [7] += point.y;
-      accu [8] += point.z;
-      ++point_count;
+      point_count = 0;
+      for (const auto& point: cloud)
+      {
+        if (!isFinite (point))
+          continue;
+
+        accu [0] += point.x * point.x;
+        accu [1] += point.x * point.y;
+        accu [2] += point.x * point.z;
+        accu [3] += point.y * point.y;
+        accu [4] += point.y * point.z;
+        accu [5] += point.z * point.z;
+        accu [6] += point.x;
+        accu [7] += point.y;
+        accu [8] += point.z;
+        ++point_count;
+      }
     }
   }
   accu /= static_cast<Scalar> (point_count);
@@ -555,41 +794,44 @@ computeMeanAndCovarianceMatrix (const pcl::PointCloud<PointT> &cloud,
   // create the buffer on the stack which is much faster than using cloud[indices[i]] and centroid as a buffer
   Eigen::Matrix<Scalar, 1, 9, Eigen::RowMajor> accu = Eigen::Matrix<Scalar, 1, 9, Eigen::RowMajor>::Zero ();
   std::size_t point_count;
-  if (cloud.is_dense)
+  if (!detail::accumulateCloudCovariance (cloud, indices.data (), indices.size (), accu, point_count))
   {
-    point_count = indices.size ();
-    for (const auto &index : indices)
+    if (cloud.is_dense)
     {
-      //const PointT& point = cloud[*iIt];
-      accu [0] += cloud[index].x * cloud[index].x;
-      accu [1] += cloud[index].x * cloud[index].y;
-      accu [2] += cloud[index].x * cloud[index].z;
-      accu [3] += cloud[index].y * cloud[index].y;
-      accu [4] += cloud[index].y * cloud[index].z;
-      accu [5] += cloud[index].z * cloud[index].z;
-      accu [6] += cloud[index].x;
-      accu [7] += cloud[index].y;
-      accu [8] += cloud[index].z;
+      point_count = indices.size ();
+      for (const auto &index : indices)
+      {
+        //const PointT& point = cloud[*iIt];
+        accu [0] += cloud[index].x * cloud[index].x;
+        accu [1] += cloud[index].x * cloud[index].y;
+        accu [2] += cloud[index].x * cloud[index].z;
+        accu [3] += cloud[index].y * cloud[index].y;
+        accu [4] += cloud[index].y * cloud[index].z;
+        accu [5] += cloud[index].z * cloud[index].z;
+        accu [6] += cloud[index].x;
+        accu [7] += cloud[index].y;
+        accu [8] += cloud[index].z;
+      }
     }
-  }
-  else
-  {
-    point_count = 0;
-    for (const auto &index : indices)
+    else
     {
-      if (!isFinite (cloud[index]))
-        continue;
-
-      ++point_count;
-      accu [0] += cloud[index].x * cloud[index].x;
-      accu [1] += cloud[index].x * cloud[index].y;
-      accu [2] += cloud[index].x * cloud[index].z;
-      accu [3] += cloud[index].y * cloud[index].y; // 4
-      accu [4] += cloud[index].y * cloud[index].z; // 5
-      accu [5] += cloud[index].z * cloud[index].z; // 8
-      accu [6] += cloud[index].x;
-      accu [7] += cloud[index].y;
-      accu [8] += cloud[index].z;
+      point_count = 0;
+      for (const auto &index : indices)
+      {
+        if (!isFinite (cloud[index]))
+          continue;
+
+        ++point_count;
+        accu [0] += cloud[index].x * cloud[index].x;
+        accu [1] += cloud[index].x * cloud[index].y;
+        accu [2] += cloud[index].x * cloud[index].z;
+        accu [3] += cloud[index].y * cloud[index].y; // 4
+        accu [4] += cloud[index].y * cloud[index].z; // 5
+        accu [5] += cloud[index].z * cloud[index].z; // 8
+        accu [6] += cloud[index].x;
+        accu [7] += cloud[index].y;
+        accu [8] += cloud[index].z;
+      }
     }
   }
 
@@ -664,11 +906,16 @@ demeanPointCloud (const pcl::PointCloud<PointT> &cloud_in,
   cloud_out = cloud_in;
 
   // Subtract the centroid from cloud_in
-  for (auto& point: cloud_out)
+  const std::ptrdiff_t npts = cloud_out.size ();
+#pragma omp parallel for \
+  default(none) \
+  shared(centroid, cloud_out, npts) \
+  if(npts >= static_cast<std::ptrdiff_t> (detail::reduction_block_size))
+  for (std::ptrdiff_t i = 0; i < npts; ++i)
   {
-    point.x -= static_cast<float> (centroid[0]);
-    point.y -= static_cast<float> (centroid[1]);
-    point.z -= static_cast<float> (centroid[2]);
+    cloud_out[i].x -= static_cast<float> (centroid[0]);
+    cloud_out[i].y -= static_cast<float> (centroid[1]);
+    cloud_out[i].z -= static_cast<float> (centroid[2]);
   }
 }
 
@@ -694,7 +941,12 @@ demeanPointCloud (const pcl::PointCloud<PointT> &cloud_in,
   cloud_out.resize (indices.size ());
 
   // Subtract the centroid from cloud_in
-  for (std::size_t i = 0; i < indices.size (); ++i)
+  const std::ptrdiff_t npts = indices.size ();
+#pragma omp parallel for \
+  default(none) \
+  shared(centroid, cloud_in, cloud_out, indices, npts) \
+  if(npts >= static_cast<std::ptrdiff_t> (detail::reduction_block_size))
+  for (std::ptrdiff_t i = 0; i < npts; ++i)
   {
     cloud_out[i].x = static_cast<float> (cloud_in[indices[i]].x - centroid[0]);
     cloud_out[i].y = static_cast<float> (cloud_in[indices[i]].y - centroid[1]);
@@ -749,11 +1001,15 @@ demeanPointCloud (const pcl::PointCloud<PointT> &cloud_in,
                   const Eigen::Matrix<Scalar, 4, 1> &centroid,
                   Eigen::Matrix<Scalar, Eigen::Dynamic, Eigen::Dynamic> &cloud_out)
 {
-  std::size_t npts = cloud_in.size ();
+  const std::ptrdiff_t npts = cloud_in.size ();
 
   cloud_out = Eigen::Matrix<Scalar, 4, Eigen::Dynamic>::Zero (4, npts);        // keep the data aligned
 
-  for (std::size_t i = 0; i < npts; ++i)
+#pragma omp parallel for \
+  default(none) \
+  shared(centroid, cloud_in, cloud_out, npts) \
+  if(npts >= static_cast<std::ptrdiff_t> (detail::reduction_block_size))
+  for (std::ptrdiff_t i = 0; i < npts; ++i)
   {
     cloud_out (0, i) = cloud_in[i].x - centroid[0];
     cloud_out (1, i) = cloud_in[i].y - centroid[1];
@@ -773,11 +1029,15 @@ demeanPointCloud (const pcl::PointCloud<PointT> &cloud_in,
                   const Eigen::Matrix<Scalar, 4, 1> &centroid,
                   Eigen::Matrix<Scalar, Eigen::Dynamic, Eigen::Dynamic> &cloud_out)
 {
-  std::size_t npts = indices.size ();
+  const std::ptrdiff_t npts = indices.size ();
 
   cloud_out = Eigen::Matrix<Scalar, 4, Eigen::Dynamic>::Zero (4, npts);        // keep the data aligned
 
-  for (std::size_t i = 0; i < npts; ++i)
+#pragma omp parallel for \
+  default(none) \
+  shared(centroid, cloud_in, cloud_out, indices, npts) \
+  if(npts >= static_cast<std::ptrdiff_t> (detail::reduction_block_size))
+  for (std::ptrdiff_t i = 0; i < npts; ++i)
   {
     cloud_out (0, i) = cloud_in[indices[i]].x - centroid[0];
     cloud_out (1, i) = cloud_in[indices[i]].y - centroid[1];
@@ -862,6 +1122,15 @@ CentroidPoint<PointT>::add (const PointT& point)
   ++num_points_;
 }
 
+template <typename PointT> void
+CentroidPoint<PointT>::merge (const CentroidPoint& other)
+{
+  // Invoke merge on each accumulator
+  using Accumulators = typename pcl::detail::Accumulators<PointT>::type;
+  boost::fusion::for_each (accumulators_, detail::MergeAccumulators<Accumulators> (other.accumulators_));
+  num_points_ += other.num_points_;
+}
+
 template <typename PointT>
 template <typename PointOutT> void
 CentroidPoint<PointT>::get (PointOutT& point) const
@@ -883,13 +1152,11 @@ computeCentroid (const pcl::PointCloud<PointInT>& cloud,
 {
   pcl::CentroidPoint<PointInT> cp;
 
+  const auto point = [&cloud] (std::size_t i) -> const PointInT& { return (cloud[i]); };
   if (cloud.is_dense)
-    for (const auto& point: cloud)
-      cp.add (point);
+    detail::addPoints<false> (point, cloud.size (), cp);
   else
-    for (const auto& point: cloud)
-      if (pcl::isFinite (point))
-        cp.add (point);
+    detail::addPoints<true> (point, cloud.size (), cp);
 
   cp.get (centroid);
   return (cp.getSize ());
@@ -903,13 +1170,11 @@ computeCentroid (const pcl::PointCloud<PointInT>& cloud,
 {
   pcl::CentroidPoint<PointInT> cp;
 
+  const auto point = [&cloud, &indices] (std::size_t i) -> const PointInT& { return (cloud[indices[i]]); };
   if (cloud.is_dense)
-    for (const auto &index : indices)
-      cp.add (cloud[index]);
+    detail::addPoints<false> (point, indices.size (), cp);
   else
-    for (const auto &index : indices)
-      if (pcl::isFinite (cloud[index]))
-        cp.add (cloud[index]);
+    detail::addPoints<true> (point, indices.size (), cp);
 
   cp.get (centroid);
   return (cp.getSize ());
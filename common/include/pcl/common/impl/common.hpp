@@ -290,6 +290,56 @@ pcl::getMaxDistance (const pcl::PointCloud<PointT> &cloud, const Indices &indice
     max_pt = Eigen::Vector4f(std::numeric_limits<float>::quiet_NaN(),std::numeric_limits<float>::quiet_NaN(),std::numeric_limits<float>::quiet_NaN(),std::numeric_limits<float>::quiet_NaN());
 }
 
+namespace pcl
+{
+namespace detail
+{
+/** \brief Smallest number of points for which getMinMax3D () runs in parallel. */
+constexpr std::size_t min_points_parallel_min_max = 65536;
+
+/** \brief Get the bounds of nr_points points, given by point (i), in parallel for large sets.
+  * \details Every thread reduces a contiguous range of points into its own bounds, four
+  * coordinates at a time, and the bounds of the threads are combined at the end. As min and
+  * max are exact, the result does not depend on the number of threads.
+  * \tparam CheckFinite skip the points whose x, y or z coordinate is not finite
+  */
+template <bool CheckFinite, typename PointAccess> inline void
+minMax3D (const PointAccess &point, std::size_t nr_points,
+          Eigen::Vector4f &min_pt, Eigen::Vector4f &max_pt)
+{
+  min_pt.setConstant (FLT_MAX);
+  max_pt.setConstant (-FLT_MAX);
+
+  const std::ptrdiff_t nr = static_cast<std::ptrdiff_t> (nr_points);
+#pragma omp parallel \
+  default(none) \
+  shared(max_pt, min_pt, nr, point) \
+  if(nr_points >= min_points_parallel_min_max)
+  {
+    Eigen::Vector4f thread_min, thread_max;
+    thread_min.setConstant (FLT_MAX);
+    thread_max.setConstant (-FLT_MAX);
+#pragma omp for schedule(static) nowait
+    for (std::ptrdiff_t i = 0; i < nr; ++i)
+    {
+      const auto &p = point (i);
+      // Check if the point is invalid
+      if (CheckFinite && (!std::isfinite (p.x) || !std::isfinite (p.y) || !std::isfinite (p.z)))
+        continue;
+      const pcl::Vector4fMapConst pt = p.getVector4fMap ();
+      thread_min = thread_min.cwiseMin (pt);
+      thread_max = thread_max.cwiseMax (pt);
+    }
+#pragma omp critical
+    {
+      min_pt = min_pt.cwiseMin (thread_min);
+      max_pt = max_pt.cwiseMax (thread_max);
+    }
+  }
+}
+} // namespace detail
+} // namespace pcl
+
 //////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointT> inline void
 pcl::getMinMax3D (const pcl::PointCloud<PointT> &cloud, PointT &min_pt, PointT &max_pt)
@@ -304,34 +354,13 @@ pcl::getMinMax3D (const pcl::PointCloud<PointT> &cloud, PointT &min_pt, PointT &
 template <typename PointT> inline void
 pcl::getMinMax3D (const pcl::PointCloud<PointT> &cloud, Eigen::Vector4f &min_pt, Eigen::Vector4f &max_pt)
 {
-  min_pt.setConstant (FLT_MAX);
-  max_pt.setConstant (-FLT_MAX);
-
+  const auto point = [&cloud] (std::size_t i) -> const PointT& { return (cloud[i]); };
   // If the data is dense, we don't need to check for NaN
   if (cloud.is_dense)
-  {
-    for (const auto& point: cloud.points)
-    {
-      const pcl::Vector4fMapConst pt = point.getVector4fMap ();
-      min_pt = min_pt.cwiseMin (pt);
-      max_pt = max_pt.cwiseMax (pt);
-    }
-  }
+    detail::minMax3D<false> (point, cloud.size (), min_pt, max_pt);
   // NaN or Inf values could exist => check for them
   else
-  {
-    for (const auto& point: cloud.points)
-    {
-      // Check if the point is invalid
-      if (!std::isfinite (point.x) ||
-          !std::isfinite (point.y) ||
-          !std::isfinite (point.z))
-        continue;
-      const pcl::Vector4fMapConst pt = point.getVector4fMap ();
-      min_pt = min_pt.cwiseMin (pt);
-      max_pt = max_pt.cwiseMax (pt);
-    }
-  }
+    detail::minMax3D<true> (point, cloud.size (), min_pt, max_pt);
 }
 
 
@@ -348,34 +377,13 @@ template <typename PointT> inline void
 pcl::getMinMax3D (const pcl::PointCloud<PointT> &cloud, const Indices &indices,
                   Eigen::Vector4f &min_pt, Eigen::Vector4f &max_pt)
 {
-  min_pt.setConstant (FLT_MAX);
-  max_pt.setConstant (-FLT_MAX);
-
+  const auto point = [&cloud, &indices] (std::size_t i) -> const PointT& { return (cloud[indices[i]]); };
   // If the data is dense, we don't need to check for NaN
   if (cloud.is_dense)
-  {
-    for (const auto &index : indices)
-    {
-      const pcl::Vector4fMapConst pt = cloud[index].getVector4fMap ();
-      min_pt = min_pt.cwiseMin (pt);
-      max_pt = max_pt.cwiseMax (pt);
-    }
-  }
+    detail::minMax3D<false> (point, indices.size (), min_pt, max_pt);
   // NaN or Inf values could exist => check for them
   else
-  {
-    for (const auto &index : indices)
-    {
-      // Check if the point is invalid
-      if (!std::isfinite (cloud[index].x) || 
-          !std::isfinite (cloud[index].y) || 
-          !std::isfinite (cloud[index].z))
-        continue;
-      const pcl::Vector4fMapConst pt = cloud[index].getVector4fMap ();
-      min_pt = min_pt.cwiseMin (pt);
-      max_pt = max_pt.cwiseMax (pt);
-    }
-  }
+    detail::minMax3D<true> (point, indices.size (), min_pt, max_pt);
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////
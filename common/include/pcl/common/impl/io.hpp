@@ -46,6 +46,10 @@
 #include <pcl/common/io.h>
 #include <pcl/point_types.h>
 
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <xmmintrin.h> // for _mm_prefetch
+#endif
+
 
 namespace pcl
 {
@@ -120,6 +124,52 @@ getFieldsList (const pcl::PointCloud<PointT> &)
 namespace detail
 {
 
+  /** \brief Clouds with at least this many points are gathered and concatenated in parallel. */
+  constexpr std::size_t min_points_parallel_copy = 32768;
+
+  /** \brief Number of points a gather fetches into the cache ahead of the one it copies. */
+  constexpr std::ptrdiff_t gather_prefetch_distance = 16;
+
+  /** \brief Hint the CPU to fetch the cache line at address. */
+  inline void
+  prefetchPoint (const void* address)
+  {
+#if defined(__GNUC__)
+    __builtin_prefetch (address);
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+    _mm_prefetch (static_cast<const char*> (address), _MM_HINT_T0);
+#else
+    (void) address;
+#endif
+  }
+
+  /** \brief Copy the points of cloud_in selected by indices to points_out[0 .. nr_points).
+    *
+    * The points are spread over the input, so they are prefetched ahead of their use and
+    * large selections are split across threads.
+    */
+  template <typename PointInT, typename PointOutT, typename IndexT> void
+  gatherPoints (const pcl::PointCloud<PointInT> &cloud_in,
+                const IndexT* indices,
+                std::size_t nr_points,
+                PointOutT* points_out)
+  {
+    const PointInT* points_in = cloud_in.data ();
+    const auto nr = static_cast<std::ptrdiff_t> (nr_points);
+    const bool parallel = nr_points >= min_points_parallel_copy;
+#pragma omp parallel for \
+  default(none) \
+  shared(indices, nr, points_in, points_out) \
+  if(parallel) \
+  schedule(static)
+    for (std::ptrdiff_t i = 0; i < nr; ++i)
+    {
+      if (i + gather_prefetch_distance < nr)
+        prefetchPoint (points_in + indices[i + gather_prefetch_distance]);
+      copyPoint (points_in[indices[i]], points_out[i]);
+    }
+  }
+
   template <typename PointInT, typename PointOutT> void
   copyPointCloudMemcpy (const pcl::PointCloud<PointInT> &cloud_in,
                         pcl::PointCloud<PointOutT> &cloud_out)
@@ -171,8 +221,7 @@ copyPointCloud (const pcl::PointCloud<PointT> &cloud_in,
   }
 
   // Allocate enough space and copy the basics
-  cloud_out.clear ();
-  cloud_out.reserve (indices.size ());
+  cloud_out.resize (indices.size ());
   cloud_out.header   = cloud_in.header;
   cloud_out.width    = indices.size ();
   cloud_out.height   = 1;
@@ -180,9 +229,8 @@ copyPointCloud (const pcl::PointCloud<PointT> &cloud_in,
   cloud_out.sensor_orientation_ = cloud_in.sensor_orientation_;
   cloud_out.sensor_origin_ = cloud_in.sensor_origin_;
 
-  // Iterate over each point
-  for (const auto& index : indices)
-    cloud_out.transient_push_back (cloud_in[index]);
+  if (!indices.empty ())
+    detail::gatherPoints (cloud_in, indices.data (), indices.size (), cloud_out.data ());
 }
 
 
@@ -200,9 +248,8 @@ copyPointCloud (const pcl::PointCloud<PointInT> &cloud_in,
   cloud_out.sensor_orientation_ = cloud_in.sensor_orientation_;
   cloud_out.sensor_origin_ = cloud_in.sensor_origin_;
 
-  // Iterate over each point
-  for (std::size_t i = 0; i < indices.size (); ++i)
-    copyPoint (cloud_in[indices[i]], cloud_out[i]);
+  if (!indices.empty ())
+    detail::gatherPoints (cloud_in, indices.data (), indices.size (), cloud_out.data ());
 }
 
 
@@ -241,8 +288,7 @@ copyPointCloud (const pcl::PointCloud<PointT> &cloud_in,
   }
 
   // Allocate enough space and copy the basics
-  cloud_out.clear ();
-  cloud_out.reserve (nr_p);
+  cloud_out.resize (nr_p);
   cloud_out.header   = cloud_in.header;
   cloud_out.width    = nr_p;
   cloud_out.height   = 1;
@@ -251,14 +297,12 @@ copyPointCloud (const pcl::PointCloud<PointT> &cloud_in,
   cloud_out.sensor_origin_ = cloud_in.sensor_origin_;
 
   // Iterate over each cluster
+  std::size_t cp = 0;
   for (const auto &cluster_index : indices)
   {
-    // Iterate over each idx
-    for (const auto &index : cluster_index.indices)
-    {
-      // Iterate over each dimension
-      cloud_out.transient_push_back (cloud_in[index]);
-    }
+    if (!cluster_index.indices.empty ())
+      detail::gatherPoints (cloud_in, cluster_index.indices.data (), cluster_index.indices.size (), cloud_out.data () + cp);
+    cp += cluster_index.indices.size ();
   }
 }
 
@@ -291,12 +335,9 @@ copyPointCloud (const pcl::PointCloud<PointInT> &cloud_in,
   std::size_t cp = 0;
   for (const auto &cluster_index : indices)
   {
-    // Iterate over each idx
-    for (const auto &index : cluster_index.indices)
-    {
-      copyPoint (cloud_in[index], cloud_out[cp]);
-      ++cp;
-    }
+    if (!cluster_index.indices.empty ())
+      detail::gatherPoints (cloud_in, cluster_index.indices.data (), cluster_index.indices.size (), cloud_out.data () + cp);
+    cp += cluster_index.indices.size ();
   }
 }
 
@@ -326,7 +367,14 @@ concatenateFields (const pcl::PointCloud<PointIn1T> &cloud1_in,
     cloud_out.is_dense = true;
 
   // Iterate over each point
-  for (std::size_t i = 0; i < cloud_out.size (); ++i)
+  const auto nr_points = static_cast<std::ptrdiff_t> (cloud_out.size ());
+  const bool parallel = cloud_out.size () >= detail::min_points_parallel_copy;
+#pragma omp parallel for \
+  default(none) \
+  shared(cloud1_in, cloud2_in, cloud_out, nr_points) \
+  if(parallel) \
+  schedule(static)
+  for (std::ptrdiff_t i = 0; i < nr_points; ++i)
   {
     // Iterate over each dimension
     pcl::for_each_type <FieldList1> (pcl::NdConcatenateFunctor <PointIn1T, PointOutT> (cloud1_in[i], cloud_out[i]));
@@ -214,6 +214,54 @@ struct Transformer<double>
 #endif // !defined(__AVX__)
 #endif // defined(__SSE2__)
 
+/** Apply an SE3 transform to an array of points, with the same result as calling
+  * Transformer::se3 on every point. The points are processed 8 (AVX) or 16 (AVX-512) at a
+  * time when the CPU supports it; clouds that are large enough are split over \a nr_threads threads.
+  * \param[in] src input points (pointer to the 4 floats x, y, z, w of the first point, 16 byte aligned)
+  * \param[in] src_stride distance in bytes between two consecutive input points
+  * \param[out] tgt output points (pointer to the 4 floats of the first point, 16 byte aligned), can be
+  * the same as src. The fourth element of every point is set to 1.
+  * \param[in] tgt_stride distance in bytes between two consecutive output points
+  * \param[in] nr_points the number of points
+  * \param[in] transform the transform matrix
+  * \param[in] nr_threads the maximum number of threads (0 sets the number of threads to the number of cores) */
+PCL_EXPORTS void
+transformPoints (const float* src, std::size_t src_stride, float* tgt, std::size_t tgt_stride,
+                 std::size_t nr_points, const Eigen::Matrix4f& transform, unsigned int nr_threads = 1);
+
+/** \copydoc transformPoints */
+PCL_EXPORTS void
+transformPoints (const float* src, std::size_t src_stride, float* tgt, std::size_t tgt_stride,
+                 std::size_t nr_points, const Eigen::Matrix4d& transform, unsigned int nr_threads = 1);
+
+/** Transform the coordinates of all the points of a dense cloud. */
+template <typename PointT, typename Scalar> inline void
+transformDensePoints (const pcl::PointCloud<PointT>& cloud_in, pcl::PointCloud<PointT>& cloud_out,
+                      const Eigen::Matrix<Scalar, 4, 4>& transform, unsigned int)
+{
+  Transformer<Scalar> tf (transform);
+  for (std::size_t i = 0; i < cloud_out.size (); ++i)
+    tf.se3 (cloud_in[i].data, cloud_out[i].data);
+}
+
+template <typename PointT> inline void
+transformDensePoints (const pcl::PointCloud<PointT>& cloud_in, pcl::PointCloud<PointT>& cloud_out,
+                      const Eigen::Matrix4f& transform, unsigned int nr_threads)
+{
+  if (!cloud_out.empty ())
+    transformPoints (cloud_in[0].data, sizeof (PointT), cloud_out[0].data, sizeof (PointT),
+                     cloud_out.size (), transform, nr_threads);
+}
+
+template <typename PointT> inline void
+transformDensePoints (const pcl::PointCloud<PointT>& cloud_in, pcl::PointCloud<PointT>& cloud_out,
+                      const Eigen::Matrix4d& transform, unsigned int nr_threads)
+{
+  if (!cloud_out.empty ())
+    transformPoints (cloud_in[0].data, sizeof (PointT), cloud_out[0].data, sizeof (PointT),
+                     cloud_out.size (), transform, nr_threads);
+}
+
 } // namespace detail
 
 
@@ -221,7 +269,8 @@ template <typename PointT, typename Scalar> void
 transformPointCloud (const pcl::PointCloud<PointT> &cloud_in,
                      pcl::PointCloud<PointT> &cloud_out,
                      const Eigen::Matrix<Scalar, 4, 4> &transform,
-                     bool copy_all_fields)
+                     bool copy_all_fields,
+                     unsigned int nr_threads)
 {
   if (&cloud_in != &cloud_out)
   {
@@ -236,15 +285,14 @@ transformPointCloud (const pcl::PointCloud<PointT> &cloud_in,
     cloud_out.sensor_origin_      = cloud_in.sensor_origin_;
   }
 
-  pcl::detail::Transformer<Scalar> tf (transform);
   if (cloud_in.is_dense)
   {
     // If the dataset is dense, simply transform it!
-    for (std::size_t i = 0; i < cloud_out.size (); ++i)
-      tf.se3 (cloud_in[i].data, cloud_out[i].data);
+    pcl::detail::transformDensePoints (cloud_in, cloud_out, transform, nr_threads);
   }
   else
   {
+    pcl::detail::Transformer<Scalar> tf (transform);
     // Dataset might contain NaNs and Infs, so check for them first,
     // otherwise we get errors during the multiplication (?)
     for (std::size_t i = 0; i < cloud_out.size (); ++i)
@@ -306,6 +354,64 @@ transformPointCloud (const pcl::PointCloud<PointT> &cloud_in,
 }
 
 
+template <typename Scalar> void
+transformPointCloud (const pcl::PointCloudSoA &cloud_in,
+                     pcl::PointCloudSoA &cloud_out,
+                     const Eigen::Matrix<Scalar, 4, 4> &transform,
+                     bool copy_all_fields)
+{
+  if (!cloud_in.getFieldData<float> ("x") || !cloud_in.getFieldData<float> ("y") || !cloud_in.getFieldData<float> ("z"))
+  {
+    PCL_ERROR ("[pcl::transformPointCloud] Input dataset doesn't have FLOAT32 x-y-z columns!\n");
+    return;
+  }
+
+  if (&cloud_in != &cloud_out)
+  {
+    if (copy_all_fields)
+      cloud_out = cloud_in;
+    else
+    {
+      cloud_out = pcl::PointCloudSoA ();
+      cloud_out.addField ("x", pcl::PCLPointField::FLOAT32);
+      cloud_out.addField ("y", pcl::PCLPointField::FLOAT32);
+      cloud_out.addField ("z", pcl::PCLPointField::FLOAT32);
+      cloud_out.resize (cloud_in.width, cloud_in.height);
+      cloud_out.header   = cloud_in.header;
+      cloud_out.is_dense = cloud_in.is_dense;
+    }
+  }
+
+  const float *x_in = cloud_in.getFieldData<float> ("x");
+  const float *y_in = cloud_in.getFieldData<float> ("y");
+  const float *z_in = cloud_in.getFieldData<float> ("z");
+  float *x_out = cloud_out.getFieldData<float> ("x");
+  float *y_out = cloud_out.getFieldData<float> ("y");
+  float *z_out = cloud_out.getFieldData<float> ("z");
+
+  const Eigen::Matrix<Scalar, 3, 4> tf = transform.template topRows<3> ();
+  const std::size_t npts = cloud_in.size ();
+  // Every coordinate is read before any is written, so cloud_in may alias cloud_out
+  for (std::size_t i = 0; i < npts; ++i)
+  {
+    const Scalar x = static_cast<Scalar> (x_in[i]);
+    const Scalar y = static_cast<Scalar> (y_in[i]);
+    const Scalar z = static_cast<Scalar> (z_in[i]);
+    // Leave NaN and Inf coordinates untouched
+    if (!cloud_in.is_dense && (!std::isfinite (x) || !std::isfinite (y) || !std::isfinite (z)))
+    {
+      x_out[i] = x_in[i];
+      y_out[i] = y_in[i];
+      z_out[i] = z_in[i];
+      continue;
+    }
+    x_out[i] = static_cast<float> (tf (0, 0) * x + tf (0, 1) * y + tf (0, 2) * z + tf (0, 3));
+    y_out[i] = static_cast<float> (tf (1, 0) * x + tf (1, 1) * y + tf (1, 2) * z + tf (1, 3));
+    z_out[i] = static_cast<float> (tf (2, 0) * x + tf (2, 1) * y + tf (2, 2) * z + tf (2, 3));
+  }
+}
+
+
 template <typename PointT, typename Scalar> void
 transformPointCloudWithNormals (const pcl::PointCloud<PointT> &cloud_in,
                                 pcl::PointCloud<PointT> &cloud_out,
@@ -0,0 +1,169 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#pragma once
+
+#include <pcl/pcl_macros.h>
+#include <pcl/point_cloud.h>
+#include <pcl/point_types.h>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+/**
+  * \file pcl/common/point_quantization.h
+  * Conversion between the float point types and their compact storage counterparts
+  * PointXYZQ16, PointXYZHalf and PointNormalHalf
+  * \ingroup common
+  */
+
+namespace pcl
+{
+  /** \brief Convert a float to the bit pattern of the nearest IEEE 754 half precision float.
+    * Values beyond the half range become infinite, NaN stays NaN.
+    * \param[in] value the value to convert
+    * \ingroup common
+    */
+  PCL_EXPORTS std::uint16_t
+  floatToHalf (float value);
+
+  /** \brief Convert the bit pattern of an IEEE 754 half precision float to a float; the
+    * conversion is exact.
+    * \param[in] value the half precision bit pattern
+    * \ingroup common
+    */
+  PCL_EXPORTS float
+  halfToFloat (std::uint16_t value);
+
+  /** \brief Convert a batch of half precision bit patterns to floats, several at once with
+    * the instruction set chosen by pcl::getSIMDLevel ().
+    * \param[in] input the half precision bit patterns
+    * \param[in] count the number of values
+    * \param[out] output the converted values
+    * \ingroup common
+    */
+  PCL_EXPORTS void
+  halfToFloat (const std::uint16_t* input, std::size_t count, float* output);
+
+  /** \brief Octahedral encode a unit normal into two 16 bit integers.
+    *
+    * The normal is projected onto the octahedron |x| + |y| + |z| = 1, whose lower half is
+    * folded over the upper one, and the resulting square [-1, 1]^2 is quantized to 1/32767.
+    * Non finite and zero normals are encoded as invalid, i.e. with a first component of
+    * std::numeric_limits<std::int16_t>::min (). The normal does not have to be normalized.
+    * \param[in] nx, ny, nz the normal
+    * \ingroup common
+    */
+  PCL_EXPORTS std::array<std::int16_t, 2>
+  encodeOctahedralNormal (float nx, float ny, float nz);
+
+  /** \brief Decode an octahedral encoded normal, see encodeOctahedralNormal (). Invalid
+    * normals decode to NaN.
+    * \param[in] oct the encoded normal
+    * \param[out] nx, ny, nz the unit normal
+    * \ingroup common
+    */
+  PCL_EXPORTS void
+  decodeOctahedralNormal (const std::int16_t oct[2], float& nx, float& ny, float& nz);
+
+  /** \brief Quantize a cloud to 16 bit integer coordinates relative to a tile origin.
+    *
+    * Every coordinate is rounded to round ((p - origin) / step). Non finite points, and the
+    * points farther than 32767 steps from the origin along any axis, are stored as invalid
+    * points. The cloud layout (width, height, sensor pose, header) is copied; is_dense is
+    * cleared if there is any invalid point.
+    * \param[in] input the input cloud
+    * \param[in] origin the tile origin
+    * \param[in] step the quantization step, i.e. the resolution of the coordinates
+    * \param[out] output the quantized cloud
+    * \return the number of finite points that were out of range
+    * \ingroup common
+    */
+  PCL_EXPORTS std::size_t
+  encodePointCloud (const PointCloud<PointXYZ>& input, const Eigen::Vector3f& origin, float step,
+                    PointCloud<PointXYZQ16>& output);
+
+  /** \brief Restore a cloud quantized with encodePointCloud (input, origin, step, output);
+    * invalid points become NaN. The conversion runs several points at once, with the
+    * instruction set chosen by pcl::getSIMDLevel ().
+    * \param[in] input the quantized cloud
+    * \param[in] origin the tile origin used for the quantization
+    * \param[in] step the quantization step used for the quantization
+    * \param[out] output the restored cloud
+    * \ingroup common
+    */
+  PCL_EXPORTS void
+  decodePointCloud (const PointCloud<PointXYZQ16>& input, const Eigen::Vector3f& origin, float step,
+                    PointCloud<PointXYZ>& output);
+
+  /** \brief Convert a cloud to half precision coordinates. The cloud layout is copied.
+    * \param[in] input the input cloud
+    * \param[out] output the half precision cloud
+    * \ingroup common
+    */
+  PCL_EXPORTS void
+  encodePointCloud (const PointCloud<PointXYZ>& input, PointCloud<PointXYZHalf>& output);
+
+  /** \brief Convert a half precision cloud back to float coordinates, several points at
+    * once with the instruction set chosen by pcl::getSIMDLevel (). The conversion is exact.
+    * \param[in] input the half precision cloud
+    * \param[out] output the float cloud
+    * \ingroup common
+    */
+  PCL_EXPORTS void
+  decodePointCloud (const PointCloud<PointXYZHalf>& input, PointCloud<PointXYZ>& output);
+
+  /** \brief Convert a cloud to half precision coordinates and curvatures and octahedral
+    * encoded normals. The cloud layout is copied.
+    * \param[in] input the input cloud
+    * \param[out] output the compact cloud
+    * \ingroup common
+    */
+  PCL_EXPORTS void
+  encodePointCloud (const PointCloud<PointNormal>& input, PointCloud<PointNormalHalf>& output);
+
+  /** \brief Convert a compact cloud back to PointNormal, several points at once with the
+    * instruction set chosen by pcl::getSIMDLevel (). The normals are unit length, or NaN if
+    * they were invalid.
+    * \param[in] input the compact cloud
+    * \param[out] output the PointNormal cloud
+    * \ingroup common
+    */
+  PCL_EXPORTS void
+  decodePointCloud (const PointCloud<PointNormalHalf>& input, PointCloud<PointNormal>& output);
+}
@@ -0,0 +1,249 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#pragma once
+
+#include <pcl/common/cpu_dispatch.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define PCL_SIMD_KERNELS_SSE2
+#endif
+#if defined(PCL_SIMD_KERNELS_AVX) || defined(PCL_SIMD_KERNELS_AVX512)
+#include <immintrin.h>
+#endif
+
+// Lane types for writing a kernel once and running it on SIMD registers of any width, for the
+// kernels of the PCL libraries; this is not a general purpose SIMD library. Lane types provide
+// the arithmetic operators, comparisons returning a Mask, and select (mask, a, b), which picks
+// a where mask is set. Branches of a kernel become per lane selections. A single Scalar is a
+// lane type too, using the standard math functions; the SIMD lane types use polynomial
+// approximations of atan2, sin and cos instead.
+//
+// Kernels are templates on the lane type marked PCL_SIMD_INLINE, called from a function
+// marked with the PCL_SIMD_TARGET_* attribute of the instruction set of the lane type, see
+// pcl/common/cpu_dispatch.h. The forced inlining makes sure vector arguments never cross a
+// function compiled for a different instruction set.
+#if defined(__GNUC__)
+#define PCL_SIMD_INLINE inline __attribute__ ((always_inline))
+#elif defined(_MSC_VER)
+#define PCL_SIMD_INLINE __forceinline
+#else
+#define PCL_SIMD_INLINE inline
+#endif
+
+namespace pcl
+{
+namespace detail
+{
+namespace simd
+{
+  /** One value at a time, using the standard math functions. */
+  template <typename T>
+  struct Lane
+  {
+    using Scalar = T;
+    using Mask = bool;
+    static constexpr std::size_t size = 1;
+    T v;
+
+    Lane () = default;
+    Lane (T x) : v (x) {}
+    static Lane load (const T* p) { return (*p); }
+    void store (T* p) const { *p = v; }
+
+    friend Lane operator+ (Lane a, Lane b) { return (a.v + b.v); }
+    friend Lane operator- (Lane a, Lane b) { return (a.v - b.v); }
+    friend Lane operator* (Lane a, Lane b) { return (a.v * b.v); }
+    friend Lane operator/ (Lane a, Lane b) { return (a.v / b.v); }
+    friend Mask operator== (Lane a, Lane b) { return (a.v == b.v); }
+    friend Mask operator< (Lane a, Lane b) { return (a.v < b.v); }
+    friend Mask operator<= (Lane a, Lane b) { return (a.v <= b.v); }
+    friend Mask operator>= (Lane a, Lane b) { return (a.v >= b.v); }
+    friend Lane sqrt (Lane a) { return (std::sqrt (a.v)); }
+    friend Lane abs (Lane a) { return (std::abs (a.v)); }
+    friend Lane min (Lane a, Lane b) { return (std::min (a.v, b.v)); }
+    friend Lane max (Lane a, Lane b) { return (std::max (a.v, b.v)); }
+    friend Lane select (Mask m, Lane a, Lane b) { return (m ? a : b); }
+    friend Lane atan2 (Lane y, Lane x) { return (std::atan2 (y.v, x.v)); }
+    friend void sincos (Lane a, Lane& s, Lane& c) { s = std::sin (a.v); c = std::cos (a.v); }
+  };
+
+  inline bool maskAnd (bool a, bool b) { return (a && b); }
+  inline bool maskOr (bool a, bool b) { return (a || b); }
+  inline bool maskNot (bool a) { return (!a); }
+
+  /** atan2 (y, x), accurate to about one float ulp (Cephes single precision atan). */
+  template <typename V> PCL_SIMD_INLINE V
+  atan2Approx (V y, V x)
+  {
+    const V ax = abs (x), ay = abs (y);
+    const V num = min (ax, ay);
+    const V den = max (ax, ay);
+    const V t = select (V (0.0f) < den, num / den, V (0.0f));
+    // Reduce t in [tan (pi/8), 1] to [-tan (pi/8), 0]
+    const auto big = V (0.4142135623730950f) < t;
+    const V u = select (big, (t - V (1.0f)) / (t + V (1.0f)), t);
+    const V z = u * u;
+    V a = (((V (8.05374449538e-2f) * z - V (1.38776856032e-1f)) * z + V (1.99777106478e-1f)) * z
+           - V (3.33329491539e-1f)) * z * u + u;
+    a = select (big, a + V (0.7853981633974483f), a);
+    a = select (ax < ay, V (1.5707963267948966f) - a, a);
+    a = select (x < V (0.0f), V (3.1415926535897932f) - a, a);
+    return (select (y < V (0.0f), V (0.0f) - a, a));
+  }
+
+  /** sin and cos on [0, pi/3], from their Taylor series. */
+  template <typename V> PCL_SIMD_INLINE void
+  sincosApprox (V a, V& s, V& c)
+  {
+    const V z = a * a;
+    s = a * (V (1.0f) + z * (V (-1.0f / 6.0f) + z * (V (1.0f / 120.0f) + z * (V (-1.0f / 5040.0f)
+           + z * (V (1.0f / 362880.0f) + z * V (-1.0f / 39916800.0f))))));
+    c = V (1.0f) + z * (V (-0.5f) + z * (V (1.0f / 24.0f) + z * (V (-1.0f / 720.0f)
+           + z * (V (1.0f / 40320.0f) + z * (V (-1.0f / 3628800.0f) + z * V (1.0f / 479001600.0f))))));
+  }
+
+#define PCL_SIMD_LANE_OPERATORS(LANE, MASK, TARGET, ADD, SUB, MUL, DIV, SQRT, MIN, MAX) \
+    friend TARGET LANE operator+ (LANE a, LANE b) { return (ADD (a.v, b.v)); } \
+    friend TARGET LANE operator- (LANE a, LANE b) { return (SUB (a.v, b.v)); } \
+    friend TARGET LANE operator* (LANE a, LANE b) { return (MUL (a.v, b.v)); } \
+    friend TARGET LANE operator/ (LANE a, LANE b) { return (DIV (a.v, b.v)); } \
+    friend TARGET LANE sqrt (LANE a) { return (SQRT (a.v)); } \
+    friend TARGET LANE min (LANE a, LANE b) { return (MIN (a.v, b.v)); } \
+    friend TARGET LANE max (LANE a, LANE b) { return (MAX (a.v, b.v)); } \
+    friend TARGET LANE atan2 (LANE y, LANE x) { return (atan2Approx (y, x)); } \
+    friend TARGET void sincos (LANE a, LANE& s, LANE& c) { sincosApprox (a, s, c); }
+
+#ifdef PCL_SIMD_KERNELS_SSE2
+  struct Mask4 { __m128 v; };
+  inline Mask4 maskAnd (Mask4 a, Mask4 b) { return {_mm_and_ps (a.v, b.v)}; }
+  inline Mask4 maskOr (Mask4 a, Mask4 b) { return {_mm_or_ps (a.v, b.v)}; }
+  inline Mask4 maskNot (Mask4 a) { return {_mm_xor_ps (a.v, _mm_castsi128_ps (_mm_set1_epi32 (-1)))}; }
+
+  /** Four floats at a time, with SSE2. */
+  struct Lane4
+  {
+    using Scalar = float;
+    using Mask = Mask4;
+    static constexpr std::size_t size = 4;
+    __m128 v;
+
+    Lane4 () = default;
+    Lane4 (__m128 x) : v (x) {}
+    Lane4 (float x) : v (_mm_set1_ps (x)) {}
+    static Lane4 load (const float* p) { return (_mm_loadu_ps (p)); }
+    void store (float* p) const { _mm_storeu_ps (p, v); }
+
+    PCL_SIMD_LANE_OPERATORS (Lane4, Mask4, , _mm_add_ps, _mm_sub_ps, _mm_mul_ps, _mm_div_ps, _mm_sqrt_ps, _mm_min_ps, _mm_max_ps)
+    friend Mask4 operator== (Lane4 a, Lane4 b) { return {_mm_cmpeq_ps (a.v, b.v)}; }
+    friend Mask4 operator< (Lane4 a, Lane4 b) { return {_mm_cmplt_ps (a.v, b.v)}; }
+    friend Mask4 operator<= (Lane4 a, Lane4 b) { return {_mm_cmple_ps (a.v, b.v)}; }
+    friend Mask4 operator>= (Lane4 a, Lane4 b) { return {_mm_cmpge_ps (a.v, b.v)}; }
+    friend Lane4 abs (Lane4 a) { return (_mm_andnot_ps (_mm_set1_ps (-0.0f), a.v)); }
+    friend Lane4 select (Mask4 m, Lane4 a, Lane4 b) { return (_mm_or_ps (_mm_and_ps (m.v, a.v), _mm_andnot_ps (m.v, b.v))); }
+  };
+#endif // PCL_SIMD_KERNELS_SSE2
+
+#ifdef PCL_SIMD_KERNELS_AVX
+  struct Mask8 { __m256 v; };
+  PCL_SIMD_TARGET_AVX inline Mask8 maskAnd (Mask8 a, Mask8 b) { return {_mm256_and_ps (a.v, b.v)}; }
+  PCL_SIMD_TARGET_AVX inline Mask8 maskOr (Mask8 a, Mask8 b) { return {_mm256_or_ps (a.v, b.v)}; }
+  PCL_SIMD_TARGET_AVX inline Mask8 maskNot (Mask8 a) { return {_mm256_xor_ps (a.v, _mm256_castsi256_ps (_mm256_set1_epi32 (-1)))}; }
+
+  /** Eight floats at a time, with AVX. */
+  struct Lane8
+  {
+    using Scalar = float;
+    using Mask = Mask8;
+    static constexpr std::size_t size = 8;
+    __m256 v;
+
+    Lane8 () = default;
+    PCL_SIMD_TARGET_AVX Lane8 (__m256 x) : v (x) {}
+    PCL_SIMD_TARGET_AVX Lane8 (float x) : v (_mm256_set1_ps (x)) {}
+    PCL_SIMD_TARGET_AVX static Lane8 load (const float* p) { return (_mm256_loadu_ps (p)); }
+    PCL_SIMD_TARGET_AVX void store (float* p) const { _mm256_storeu_ps (p, v); }
+
+    PCL_SIMD_LANE_OPERATORS (Lane8, Mask8, PCL_SIMD_TARGET_AVX, _mm256_add_ps, _mm256_sub_ps, _mm256_mul_ps, _mm256_div_ps, _mm256_sqrt_ps, _mm256_min_ps, _mm256_max_ps)
+    friend PCL_SIMD_TARGET_AVX Mask8 operator== (Lane8 a, Lane8 b) { return {_mm256_cmp_ps (a.v, b.v, _CMP_EQ_OQ)}; }
+    friend PCL_SIMD_TARGET_AVX Mask8 operator< (Lane8 a, Lane8 b) { return {_mm256_cmp_ps (a.v, b.v, _CMP_LT_OQ)}; }
+    friend PCL_SIMD_TARGET_AVX Mask8 operator<= (Lane8 a, Lane8 b) { return {_mm256_cmp_ps (a.v, b.v, _CMP_LE_OQ)}; }
+    friend PCL_SIMD_TARGET_AVX Mask8 operator>= (Lane8 a, Lane8 b) { return {_mm256_cmp_ps (a.v, b.v, _CMP_GE_OQ)}; }
+    friend PCL_SIMD_TARGET_AVX Lane8 abs (Lane8 a) { return (_mm256_andnot_ps (_mm256_set1_ps (-0.0f), a.v)); }
+    friend PCL_SIMD_TARGET_AVX Lane8 select (Mask8 m, Lane8 a, Lane8 b) { return (_mm256_or_ps (_mm256_and_ps (m.v, a.v), _mm256_andnot_ps (m.v, b.v))); }
+  };
+#endif // PCL_SIMD_KERNELS_AVX
+
+#ifdef PCL_SIMD_KERNELS_AVX512
+  struct Mask16 { __mmask16 v; };
+  inline Mask16 maskAnd (Mask16 a, Mask16 b) { return {static_cast<__mmask16> (a.v & b.v)}; }
+  inline Mask16 maskOr (Mask16 a, Mask16 b) { return {static_cast<__mmask16> (a.v | b.v)}; }
+  inline Mask16 maskNot (Mask16 a) { return {static_cast<__mmask16> (~a.v)}; }
+
+  /** Sixteen floats at a time, with AVX-512. */
+  struct Lane16
+  {
+    using Scalar = float;
+    using Mask = Mask16;
+    static constexpr std::size_t size = 16;
+    __m512 v;
+
+    Lane16 () = default;
+    PCL_SIMD_TARGET_AVX512 Lane16 (__m512 x) : v (x) {}
+    PCL_SIMD_TARGET_AVX512 Lane16 (float x) : v (_mm512_set1_ps (x)) {}
+    PCL_SIMD_TARGET_AVX512 static Lane16 load (const float* p) { return (_mm512_loadu_ps (p)); }
+    PCL_SIMD_TARGET_AVX512 void store (float* p) const { _mm512_storeu_ps (p, v); }
+
+    PCL_SIMD_LANE_OPERATORS (Lane16, Mask16, PCL_SIMD_TARGET_AVX512, _mm512_add_ps, _mm512_sub_ps, _mm512_mul_ps, _mm512_div_ps, _mm512_sqrt_ps, _mm512_min_ps, _mm512_max_ps)
+    friend PCL_SIMD_TARGET_AVX512 Mask16 operator== (Lane16 a, Lane16 b) { return {_mm512_cmp_ps_mask (a.v, b.v, _CMP_EQ_OQ)}; }
+    friend PCL_SIMD_TARGET_AVX512 Mask16 operator< (Lane16 a, Lane16 b) { return {_mm512_cmp_ps_mask (a.v, b.v, _CMP_LT_OQ)}; }
+    friend PCL_SIMD_TARGET_AVX512 Mask16 operator<= (Lane16 a, Lane16 b) { return {_mm512_cmp_ps_mask (a.v, b.v, _CMP_LE_OQ)}; }
+    friend PCL_SIMD_TARGET_AVX512 Mask16 operator>= (Lane16 a, Lane16 b) { return {_mm512_cmp_ps_mask (a.v, b.v, _CMP_GE_OQ)}; }
+    friend PCL_SIMD_TARGET_AVX512 Lane16 abs (Lane16 a) { return (_mm512_abs_ps (a.v)); }
+    friend PCL_SIMD_TARGET_AVX512 Lane16 select (Mask16 m, Lane16 a, Lane16 b) { return (_mm512_mask_blend_ps (m.v, b.v, a.v)); }
+  };
+#endif // PCL_SIMD_KERNELS_AVX512
+
+#undef PCL_SIMD_LANE_OPERATORS
+} // namespace simd
+} // namespace detail
+} // namespace pcl
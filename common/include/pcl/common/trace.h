@@ -0,0 +1,161 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2019-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <pcl/pcl_macros.h>
+
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+
+/**
+  * \file pcl/common/trace.h
+  * Hierarchical tracing of the stages of the PCL algorithms, written in the Chrome trace
+  * event format that chrome://tracing and https://ui.perfetto.dev open.
+  * \ingroup common
+  */
+
+/*@{*/
+namespace pcl
+{
+  namespace trace
+  {
+    /** \brief Start recording zones and counters, from all threads. Events recorded before
+      * are kept, see clear ().
+      * \ingroup common
+      */
+    PCL_EXPORTS void
+    start ();
+
+    /** \brief Stop recording. The events recorded so far are kept until clear ().
+      * \ingroup common
+      */
+    PCL_EXPORTS void
+    stop ();
+
+    /** \brief Whether zones and counters are being recorded.
+      * \ingroup common
+      */
+    PCL_EXPORTS bool
+    isRecording () noexcept;
+
+    /** \brief Discard all events recorded so far.
+      * \ingroup common
+      */
+    PCL_EXPORTS void
+    clear ();
+
+    /** \brief Name the calling thread in the written traces, e.g. "grabber".
+      * \param[in] name the name of the thread
+      * \ingroup common
+      */
+    PCL_EXPORTS void
+    setThreadName (const std::string &name);
+
+    /** \brief Record the value of a counter at the current time, shown as a graph over time.
+      * \param[in] name the name of the counter
+      * \param[in] value the current value of the counter
+      * \ingroup common
+      */
+    PCL_EXPORTS void
+    counter (const char *name, double value);
+
+    /** \brief Write all events recorded so far as a Chrome trace, in JSON.
+      * \param[out] os the stream to write to
+      * \ingroup common
+      */
+    PCL_EXPORTS void
+    writeChromeTrace (std::ostream &os);
+
+    /** \brief Write all events recorded so far as a Chrome trace, in JSON.
+      * \param[in] file_name the name of the file to write to
+      * \return false if the file could not be written
+      * \ingroup common
+      */
+    PCL_EXPORTS bool
+    writeChromeTrace (const std::string &file_name);
+
+    /** \brief Records the time from its construction to its destruction as a zone of the
+      * calling thread. Zones nested on the same thread form the hierarchy of the trace.
+      *
+      * Use it through PCL_TRACE_ZONE, which compiles to nothing unless PCL is configured
+      * with PCL_ENABLE_TRACING. When tracing is compiled in but not recording, a zone only
+      * costs one atomic load.
+      * \ingroup common
+      */
+    class PCL_EXPORTS Zone
+    {
+      public:
+        /** \brief Open a zone.
+          * \param[in] name the name of the zone, which has to outlive the zone
+          */
+        explicit Zone (const char *name);
+
+        /** \brief Open a zone.
+          * \param[in] name the name of the zone, copied only while recording
+          */
+        explicit Zone (const std::string &name);
+
+        Zone (const Zone&) = delete;
+        Zone&
+        operator= (const Zone&) = delete;
+
+        /** \brief Close the zone and record it. */
+        ~Zone ();
+
+      private:
+        const char *name_;
+        std::string name_copy_;
+        std::int64_t start_;
+        bool recording_;
+    };
+  }
+}
+/*@}*/
+
+#define PCL_TRACE_CONCAT_IMPL(a, b) a##b
+#define PCL_TRACE_CONCAT(a, b) PCL_TRACE_CONCAT_IMPL(a, b)
+
+#ifdef PCL_ENABLE_TRACING
+/** \brief Record the rest of the enclosing scope as a zone named name. */
+#define PCL_TRACE_ZONE(name) ::pcl::trace::Zone PCL_TRACE_CONCAT(pcl_trace_zone_, __LINE__) (name)
+/** \brief Record the current value of a counter. */
+#define PCL_TRACE_COUNTER(name, value) ::pcl::trace::counter ((name), static_cast<double> (value))
+#else
+#define PCL_TRACE_ZONE(name) static_cast<void> (0)
+#define PCL_TRACE_COUNTER(name, value) static_cast<void> (0)
+#endif
@@ -40,6 +40,7 @@
 #pragma once
 
 #include <pcl/point_cloud.h>
+#include <pcl/point_cloud_soa.h>
 #include <pcl/point_types.h>
 #include <pcl/common/centroid.h>
 #include <pcl/common/eigen.h>
@@ -53,6 +54,8 @@ namespace pcl
     * \param[in] transform an affine transformation (typically a rigid transformation)
     * \param[in] copy_all_fields flag that controls whether the contents of the fields
     * (other than x, y, z) should be copied into the new transformed cloud
+    * \param[in] nr_threads the number of threads used to transform large dense clouds
+    * (0 sets the number of threads to the number of cores)
     * \note Can be used with cloud_in equal to cloud_out
     * \ingroup common
     */
@@ -60,18 +63,20 @@ namespace pcl
   transformPointCloud (const pcl::PointCloud<PointT> &cloud_in, 
                        pcl::PointCloud<PointT> &cloud_out, 
                        const Eigen::Transform<Scalar, 3, Eigen::Affine> &transform,
-                       bool copy_all_fields = true)
+                       bool copy_all_fields = true,
+                       unsigned int nr_threads = 1)
   {
-    return (transformPointCloud<PointT, Scalar> (cloud_in, cloud_out, transform.matrix (), copy_all_fields));
+    return (transformPointCloud<PointT, Scalar> (cloud_in, cloud_out, transform.matrix (), copy_all_fields, nr_threads));
   }
 
   template <typename PointT> void 
   transformPointCloud (const pcl::PointCloud<PointT> &cloud_in, 
                        pcl::PointCloud<PointT> &cloud_out, 
                        const Eigen::Affine3f &transform,
-                       bool copy_all_fields = true)
+                       bool copy_all_fields = true,
+                       unsigned int nr_threads = 1)
   {
-    return (transformPointCloud<PointT, float> (cloud_in, cloud_out, transform.matrix (), copy_all_fields));
+    return (transformPointCloud<PointT, float> (cloud_in, cloud_out, transform.matrix (), copy_all_fields, nr_threads));
   }
 
   /** \brief Apply an affine transform defined by an Eigen Transform
@@ -132,6 +137,39 @@ namespace pcl
     return (transformPointCloud<PointT, float> (cloud_in, indices.indices, cloud_out, transform.matrix (), copy_all_fields));
   }
 
+  /** \brief Apply an affine transform defined by a 4x4 matrix to the x, y, z columns of a columnar point cloud
+    * \param[in] cloud_in the input point cloud, with FLOAT32 x, y and z fields
+    * \param[out] cloud_out the resultant output point cloud
+    * \param[in] transform an affine transformation (typically a rigid transformation)
+    * \param[in] copy_all_fields flag that controls whether the columns other than x, y, z
+    * should be copied into the new transformed cloud
+    * \note Can be used with cloud_in equal to cloud_out
+    * \ingroup common
+    */
+  template <typename Scalar> void
+  transformPointCloud (const pcl::PointCloudSoA &cloud_in,
+                       pcl::PointCloudSoA &cloud_out,
+                       const Eigen::Matrix<Scalar, 4, 4> &transform,
+                       bool copy_all_fields = true);
+
+  /** \brief Apply an affine transform defined by an Eigen Transform to the x, y, z columns of a columnar point cloud
+    * \param[in] cloud_in the input point cloud, with FLOAT32 x, y and z fields
+    * \param[out] cloud_out the resultant output point cloud
+    * \param[in] transform an affine transformation (typically a rigid transformation)
+    * \param[in] copy_all_fields flag that controls whether the columns other than x, y, z
+    * should be copied into the new transformed cloud
+    * \note Can be used with cloud_in equal to cloud_out
+    * \ingroup common
+    */
+  template <typename Scalar> void
+  transformPointCloud (const pcl::PointCloudSoA &cloud_in,
+                       pcl::PointCloudSoA &cloud_out,
+                       const Eigen::Transform<Scalar, 3, Eigen::Affine> &transform,
+                       bool copy_all_fields = true)
+  {
+    return (transformPointCloud<Scalar> (cloud_in, cloud_out, transform.matrix (), copy_all_fields));
+  }
+
   /** \brief Transform a point cloud and rotate its normals using an Eigen transform.
     * \param[in] cloud_in the input point cloud
     * \param[out] cloud_out the resultant output point cloud
@@ -224,22 +262,28 @@ namespace pcl
     * \param[in] transform a rigid transformation 
     * \param[in] copy_all_fields flag that controls whether the contents of the fields
     * (other than x, y, z) should be copied into the new transformed cloud
+    * \param[in] nr_threads the number of threads used to transform large dense clouds
+    * (0 sets the number of threads to the number of cores)
     * \note Can be used with cloud_in equal to cloud_out
+    * \note Dense clouds are transformed in batches of 8 (AVX) or 16 (AVX-512) points
+    * when the CPU supports it, independently of the flags PCL was compiled with
     * \ingroup common
     */
   template <typename PointT, typename Scalar> void 
   transformPointCloud (const pcl::PointCloud<PointT> &cloud_in, 
                        pcl::PointCloud<PointT> &cloud_out, 
                        const Eigen::Matrix<Scalar, 4, 4> &transform,
-                       bool copy_all_fields = true);
+                       bool copy_all_fields = true,
+                       unsigned int nr_threads = 1);
 
   template <typename PointT> void 
   transformPointCloud (const pcl::PointCloud<PointT> &cloud_in, 
                        pcl::PointCloud<PointT> &cloud_out, 
                        const Eigen::Matrix4f &transform,
-                       bool copy_all_fields = true)
+                       bool copy_all_fields = true,
+                       unsigned int nr_threads = 1)
   {
-    return (transformPointCloud<PointT, float> (cloud_in, cloud_out, transform, copy_all_fields));
+    return (transformPointCloud<PointT, float> (cloud_in, cloud_out, transform, copy_all_fields, nr_threads));
   }
 
   /** \brief Apply a rigid transform defined by a 4x4 matrix
@@ -53,6 +53,11 @@
 
 #include <boost/foreach.hpp>
 
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+#include <vector>
+
 namespace pcl
 {
   namespace detail
@@ -116,6 +121,59 @@ namespace pcl
       return (a.serialized_offset < b.serialized_offset);
     }
 
+    // The fields of PointT as written by toPCLPointCloud2.
+    template<typename PointT> const std::vector<pcl::PCLPointField>&
+    getFields ()
+    {
+      static const std::vector<pcl::PCLPointField> fields = []
+      {
+        std::vector<pcl::PCLPointField> point_fields;
+        pcl::for_each_type<typename pcl::traits::fieldList<PointT>::type> (FieldAdder<PointT> (point_fields));
+        return (point_fields);
+      } ();
+      return (fields);
+    }
+
+    // Point clouds with at least this many points are converted in parallel.
+    constexpr std::size_t min_points_parallel_conversion = 65536;
+
+    // Blocks of at least this many bytes are copied in parallel.
+    constexpr std::size_t min_bytes_parallel_copy = 1 << 22;
+
+    // Whether two field lists describe the same layout.
+    inline bool
+    sameFieldLayout (const std::vector<pcl::PCLPointField>& a, const std::vector<pcl::PCLPointField>& b)
+    {
+      return (a.size () == b.size () &&
+              std::equal (a.cbegin (), a.cend (), b.cbegin (),
+                          [](const pcl::PCLPointField& f1, const pcl::PCLPointField& f2)
+                          {
+                            return (f1.offset == f2.offset && f1.datatype == f2.datatype &&
+                                    f1.count == f2.count && f1.name == f2.name);
+                          }));
+    }
+
+    // memcpy that splits large blocks across threads.
+    inline void
+    copyBytes (std::uint8_t* dst, const std::uint8_t* src, std::size_t size)
+    {
+      if (size < min_bytes_parallel_copy)
+      {
+        memcpy (dst, src, size);
+        return;
+      }
+      const std::ptrdiff_t chunk_size = 1 << 20;
+      const std::ptrdiff_t nr_chunks = static_cast<std::ptrdiff_t> ((size + chunk_size - 1) / chunk_size);
+#pragma omp parallel for \
+  default(none) \
+  shared(dst, src, size, nr_chunks)
+      for (std::ptrdiff_t i = 0; i < nr_chunks; ++i)
+      {
+        const std::size_t begin = i * chunk_size;
+        memcpy (dst + begin, src + begin, std::min<std::size_t> (chunk_size, size - begin));
+      }
+    }
+
   } //namespace detail
 
   template<typename PointT> void
@@ -149,6 +207,58 @@ namespace pcl
     }
   }
 
+  /** \brief Get the field map of PointT for a message layout.
+    *
+    * The last layout seen by the calling thread is cached per point type, so converting a
+    * stream of messages with the same fields only builds the field map once.
+    * \param[in] msg_fields the fields of the PCLPointCloud2 message
+    * \return the field map, valid until the next call with a different layout from the same thread
+    */
+  template<typename PointT> const MsgFieldMap&
+  getCachedMapping (const std::vector<pcl::PCLPointField>& msg_fields)
+  {
+    struct CachedMapping
+    {
+      bool valid = false;
+      std::vector<pcl::PCLPointField> fields;
+      MsgFieldMap field_map;
+    };
+    static thread_local CachedMapping cache;
+
+    if (!cache.valid || !detail::sameFieldLayout (cache.fields, msg_fields))
+    {
+      cache.field_map.clear ();
+      createMapping<PointT> (msg_fields, cache.field_map);
+      cache.fields = msg_fields;
+      cache.valid = true;
+    }
+    return (cache.field_map);
+  }
+
+  /** \brief Get direct access to the points of a PCLPointCloud2 whose data layout matches PointT exactly.
+    *
+    * No data is copied: the returned pointer addresses msg.data, holds msg.width * msg.height
+    * points and is invalidated by any change to msg.data.
+    * \param[in] msg the PCLPointCloud2 binary blob
+    * \return the points, or nullptr if the fields, point_step, row_step or alignment of msg.data
+    * do not match PointT
+    */
+  template<typename PointT> const PointT*
+  getPointsView (const pcl::PCLPointCloud2& msg)
+  {
+    // Padding fields named "_" are allowed, everything else has to match PointT
+    std::vector<pcl::PCLPointField> msg_fields;
+    std::copy_if (msg.fields.cbegin (), msg.fields.cend (), std::back_inserter (msg_fields),
+                  [](const pcl::PCLPointField& field) { return (field.name != "_"); });
+    if (!detail::sameFieldLayout (msg_fields, detail::getFields<PointT> ()) ||
+        msg.point_step != sizeof (PointT) ||
+        msg.row_step != msg.width * sizeof (PointT) ||
+        msg.data.size () < static_cast<std::size_t> (msg.width) * msg.height * sizeof (PointT) ||
+        reinterpret_cast<std::uintptr_t> (msg.data.data ()) % alignof (PointT) != 0)
+      return (nullptr);
+    return (reinterpret_cast<const PointT*> (msg.data.data ()));
+  }
+
   /** \brief Convert a PCLPointCloud2 binary data blob into a pcl::PointCloud<T> object using a field_map.
     * \param[in] msg the PCLPointCloud2 binary blob
     * \param[out] cloud the resultant pcl::PointCloud<T>
@@ -191,7 +301,7 @@ namespace pcl
       // Should usually be able to copy all rows at once
       if (msg.row_step == cloud_row_step)
       {
-        memcpy (cloud_data, msg_data, msg.data.size ());
+        detail::copyBytes (cloud_data, msg_data, msg.data.size ());
       }
       else
       {
@@ -203,17 +313,23 @@ namespace pcl
     else
     {
       // If not, memcpy each group of contiguous fields separately
-      for (index_t row = 0; row < msg.height; ++row)
+      const std::ptrdiff_t width = msg.width;
+      const std::ptrdiff_t nr_points = num_points;
+      const std::uint8_t* msg_data = msg.data.data ();
+      const std::size_t row_step = msg.row_step;
+      const std::size_t point_step = msg.point_step;
+      const bool parallel = num_points >= detail::min_points_parallel_conversion;
+#pragma omp parallel for \
+  default(none) \
+  shared(cloud_data, field_map, msg_data, nr_points, point_step, row_step, width) \
+  if(parallel)
+      for (std::ptrdiff_t i = 0; i < nr_points; ++i)
       {
-        const std::uint8_t* row_data = &msg.data[row * msg.row_step];
-        for (index_t col = 0; col < msg.width; ++col)
+        const std::uint8_t* point_data = msg_data + (i / width) * row_step + (i % width) * point_step;
+        std::uint8_t* cloud_point = cloud_data + i * sizeof (PointT);
+        for (const detail::FieldMapping& mapping : field_map)
         {
-          const std::uint8_t* msg_data = row_data + col * msg.point_step;
-          for (const detail::FieldMapping& mapping : field_map)
-          {
-            memcpy (cloud_data + mapping.struct_offset, msg_data + mapping.serialized_offset, mapping.size);
-          }
-          cloud_data += sizeof (PointT);
+          memcpy (cloud_point + mapping.struct_offset, point_data + mapping.serialized_offset, mapping.size);
         }
       }
     }
@@ -222,13 +338,12 @@ namespace pcl
   /** \brief Convert a PCLPointCloud2 binary data blob into a pcl::PointCloud<T> object.
     * \param[in] msg the PCLPointCloud2 binary blob
     * \param[out] cloud the resultant pcl::PointCloud<T>
+    * \note The field map is cached per thread and point type, see getCachedMapping.
     */
   template<typename PointT> void
   fromPCLPointCloud2 (const pcl::PCLPointCloud2& msg, pcl::PointCloud<PointT>& cloud)
   {
-    MsgFieldMap field_map;
-    createMapping<PointT> (msg.fields, field_map);
-    fromPCLPointCloud2 (msg, cloud, field_map);
+    fromPCLPointCloud2 (msg, cloud, getCachedMapping<PointT> (msg.fields));
   }
 
   /** \brief Convert a pcl::PointCloud<T> object to a PCLPointCloud2 binary data blob.
@@ -256,12 +371,11 @@ namespace pcl
     msg.data.resize (data_size);
     if (data_size)
     {
-      memcpy(&msg.data[0], &cloud[0], data_size);
+      detail::copyBytes (&msg.data[0], reinterpret_cast<const std::uint8_t*> (&cloud[0]), data_size);
     }
 
-    // Fill fields metadata
-    msg.fields.clear ();
-    for_each_type<typename traits::fieldList<PointT>::type> (detail::FieldAdder<PointT>(msg.fields));
+    // Fill fields metadata, which only depends on PointT
+    msg.fields = detail::getFields<PointT> ();
 
     msg.header     = cloud.header;
     msg.point_step = sizeof (PointT);
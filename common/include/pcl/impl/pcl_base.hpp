@@ -38,6 +38,7 @@
 #define PCL_PCL_IMPL_BASE_HPP_
 
 #include <pcl/pcl_base.h>
+#include <pcl/common/trace.h>
 #include <pcl/console/print.h>
 #include <cstddef>
 
@@ -137,6 +138,8 @@ pcl::PCLBase<PointT>::setIndices (std::size_t row_start, std::size_t col_start,
 template <typename PointT> bool
 pcl::PCLBase<PointT>::initCompute ()
 {
+  PCL_TRACE_ZONE ("PCLBase::initCompute");
+
   // Check if input was set
   if (!input_)
   {
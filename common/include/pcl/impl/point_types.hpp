@@ -55,7 +55,7 @@
 #include <Eigen/Core>                   // for MatrixMap
 
 #include <algorithm>                    // for copy_n, fill_n
-#include <cstdint>                      // for uint8_t, uint32_t
+#include <cstdint>                      // for int16_t, uint8_t, uint16_t, uint32_t
 #include <ostream>                      // for ostream, operator<<
 #include <type_traits>                  // for enable_if_t
 
@@ -1902,6 +1902,72 @@ namespace pcl
     friend std::ostream& operator << (std::ostream& os, const PointDEM& p);
   };
 
+  PCL_EXPORTS std::ostream& operator << (std::ostream& os, const PointXYZQ16& p);
+  /** \brief A compact point structure holding the Euclidean xyz coordinates as 16 bit integers.
+    *
+    * The coordinates count quantization steps from a tile origin; both are properties of the
+    * cloud, not of the points. A coordinate of std::numeric_limits<std::int16_t>::min () marks
+    * an invalid point. See pcl::encodePointCloud () and pcl::decodePointCloud () in
+    * pcl/common/point_quantization.h for the conversion from and to PointXYZ.
+    * \ingroup common
+    */
+  struct PointXYZQ16
+  {
+    std::int16_t x = 0;
+    std::int16_t y = 0;
+    std::int16_t z = 0;
+
+    inline PointXYZQ16 () = default;
+
+    inline PointXYZQ16 (std::int16_t _x, std::int16_t _y, std::int16_t _z): x (_x), y (_y), z (_z) {}
+
+    friend std::ostream& operator << (std::ostream& os, const PointXYZQ16& p);
+  };
+
+  PCL_EXPORTS std::ostream& operator << (std::ostream& os, const PointXYZHalf& p);
+  /** \brief A compact point structure holding the Euclidean xyz coordinates as IEEE 754 half
+    * precision floats, stored as their bit patterns.
+    *
+    * Half precision keeps 11 significant bits, i.e. a relative precision of about 5e-4, up
+    * to 65504. See pcl::encodePointCloud () and pcl::decodePointCloud () in
+    * pcl/common/point_quantization.h for the conversion from and to PointXYZ.
+    * \ingroup common
+    */
+  struct PointXYZHalf
+  {
+    std::uint16_t x = 0;
+    std::uint16_t y = 0;
+    std::uint16_t z = 0;
+
+    inline PointXYZHalf () = default;
+
+    friend std::ostream& operator << (std::ostream& os, const PointXYZHalf& p);
+  };
+
+  PCL_EXPORTS std::ostream& operator << (std::ostream& os, const PointNormalHalf& p);
+  /** \brief A compact counterpart of PointNormal: the xyz coordinates and the curvature are
+    * half precision floats, and the unit normal is octahedral encoded into two 16 bit integers.
+    *
+    * The octahedral encoding maps the unit sphere onto the square [-1, 1]^2, quantized to
+    * 1/32767; the angular error stays below 0.01 degrees. A normal_oct[0] of
+    * std::numeric_limits<std::int16_t>::min () marks an invalid normal. See
+    * pcl::encodePointCloud () and pcl::decodePointCloud () in pcl/common/point_quantization.h
+    * for the conversion from and to PointNormal.
+    * \ingroup common
+    */
+  struct PointNormalHalf
+  {
+    std::uint16_t x = 0;
+    std::uint16_t y = 0;
+    std::uint16_t z = 0;
+    std::int16_t normal_oct[2] = {0, 0};
+    std::uint16_t curvature = 0;
+
+    inline PointNormalHalf () = default;
+
+    friend std::ostream& operator << (std::ostream& os, const PointNormalHalf& p);
+  };
+
   template <int N> std::ostream&
   operator << (std::ostream& os, const Histogram<N>& p)
   {
@@ -2271,6 +2337,26 @@ POINT_CLOUD_REGISTER_POINT_STRUCT (pcl::_PointDEM,
 )
 POINT_CLOUD_REGISTER_POINT_WRAPPER(pcl::PointDEM, pcl::_PointDEM)
 
+POINT_CLOUD_REGISTER_POINT_STRUCT (pcl::PointXYZQ16,
+    (std::int16_t, x, x)
+    (std::int16_t, y, y)
+    (std::int16_t, z, z)
+)
+
+POINT_CLOUD_REGISTER_POINT_STRUCT (pcl::PointXYZHalf,
+    (std::uint16_t, x, x)
+    (std::uint16_t, y, y)
+    (std::uint16_t, z, z)
+)
+
+POINT_CLOUD_REGISTER_POINT_STRUCT (pcl::PointNormalHalf,
+    (std::uint16_t, x, x)
+    (std::uint16_t, y, y)
+    (std::uint16_t, z, z)
+    (std::int16_t[2], normal_oct, normal_oct)
+    (std::uint16_t, curvature, curvature)
+)
+
 namespace pcl
 {
 
@@ -0,0 +1,415 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2019-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+/**
+ * \file pcl/memory_resource.h
+ *
+ * \brief Memory resources and the allocator used for the point storage of
+ * pcl::PointCloud, modelled after std::pmr which is not available in C++14.
+ * \ingroup common
+ */
+
+#include <pcl/pcl_exports.h>
+
+#include <Eigen/Core>  // for EIGEN_MAX_ALIGN_BYTES
+
+#include <atomic>
+#include <cstddef>  // for std::size_t, std::max_align_t
+#include <limits>  // for std::numeric_limits
+#include <new>  // for std::bad_alloc
+#include <type_traits>  // for std::true_type, std::false_type
+#include <vector>
+
+namespace pcl
+{
+/**
+ * \brief Interface of a source of raw memory, the C++14 counterpart of
+ * std::pmr::memory_resource.
+ *
+ * Derived classes implement doAllocate, doDeallocate and doIsEqual. Possible
+ * implementations are huge page backed pools, pinned (page-locked) host memory for
+ * transfers to a GPU, shared memory segments or arenas such as
+ * MonotonicBufferResource.
+ * \ingroup common
+ */
+class PCL_EXPORTS MemoryResource
+{
+public:
+  virtual ~MemoryResource () = default;
+
+  /** \brief Allocate at least bytes bytes aligned to alignment, throws on failure. */
+  void*
+  allocate (std::size_t bytes, std::size_t alignment = alignof (std::max_align_t))
+  {
+    return (doAllocate (bytes, alignment));
+  }
+
+  /** \brief Return memory obtained from allocate with the same bytes and alignment. */
+  void
+  deallocate (void* p, std::size_t bytes, std::size_t alignment = alignof (std::max_align_t))
+  {
+    doDeallocate (p, bytes, alignment);
+  }
+
+  /** \brief Whether memory allocated by this can be deallocated by other and vice versa. */
+  bool
+  isEqual (const MemoryResource& other) const noexcept
+  {
+    return (this == &other || doIsEqual (other));
+  }
+
+protected:
+  virtual void*
+  doAllocate (std::size_t bytes, std::size_t alignment) = 0;
+
+  virtual void
+  doDeallocate (void* p, std::size_t bytes, std::size_t alignment) = 0;
+
+  virtual bool
+  doIsEqual (const MemoryResource& other) const noexcept = 0;
+};
+
+/**
+ * \brief The resource used by allocators that were not given one: aligned
+ * operator new/delete, i.e. the behavior of Eigen::aligned_allocator.
+ * \ingroup common
+ */
+PCL_EXPORTS MemoryResource*
+getNewDeleteResource () noexcept;
+
+/**
+ * \brief Get the process wide default memory resource, initially getNewDeleteResource().
+ * \ingroup common
+ */
+PCL_EXPORTS MemoryResource*
+getDefaultResource () noexcept;
+
+/**
+ * \brief Set the process wide default memory resource.
+ *
+ * Only affects allocators created afterwards. The resource has to outlive all memory
+ * allocated from it.
+ * \param[in] resource the new default resource, nullptr restores getNewDeleteResource()
+ * \return the previous default resource
+ * \ingroup common
+ */
+PCL_EXPORTS MemoryResource*
+setDefaultResource (MemoryResource* resource) noexcept;
+
+/**
+ * \brief Arena that hands out memory by bumping a pointer and frees everything at
+ * once in release().
+ *
+ * Deallocation is a no-op, so short-lived intermediate clouds of a processing step
+ * cost one pointer increment each. Memory is taken from the upstream resource in
+ * blocks of growing size. Not thread safe.
+ *
+ * \code
+ * pcl::MonotonicBufferResource arena (64 << 20);
+ * for (;;)
+ * {
+ *   {
+ *     pcl::PointCloud<pcl::PointXYZ> filtered (&arena);
+ *     // ... process the frame
+ *   }
+ *   arena.release ();
+ * }
+ * \endcode
+ * \ingroup common
+ */
+class PCL_EXPORTS MonotonicBufferResource : public MemoryResource
+{
+public:
+  /** \brief Constructor.
+   * \param[in] initial_size size of the first block requested from upstream
+   * \param[in] upstream the resource the blocks are taken from
+   */
+  explicit MonotonicBufferResource (std::size_t initial_size = 1 << 20,
+                                    MemoryResource* upstream = getDefaultResource ());
+
+  MonotonicBufferResource (const MonotonicBufferResource&) = delete;
+  MonotonicBufferResource&
+  operator= (const MonotonicBufferResource&) = delete;
+
+  /** \brief Releases all blocks. */
+  ~MonotonicBufferResource () override;
+
+  /** \brief Free all memory handed out so far.
+   *
+   * The largest block is kept for reuse, so a steady state pipeline does not touch
+   * the upstream resource any more. All memory allocated from this resource must
+   * no longer be in use.
+   */
+  void
+  release ();
+
+  /** \brief Get the upstream resource. */
+  MemoryResource*
+  getUpstreamResource () const
+  {
+    return (upstream_);
+  }
+
+protected:
+  void*
+  doAllocate (std::size_t bytes, std::size_t alignment) override;
+
+  void
+  doDeallocate (void*, std::size_t, std::size_t) override
+  {}
+
+  bool
+  doIsEqual (const MemoryResource& other) const noexcept override
+  {
+    return (this == &other);
+  }
+
+private:
+  struct Block
+  {
+    void* data;
+    std::size_t size;
+  };
+
+  /** \brief Blocks taken from upstream_, the current one last. */
+  std::vector<Block> blocks_;
+
+  /** \brief Position and end of the free space in the current block. */
+  char* current_ = nullptr;
+  char* end_ = nullptr;
+
+  /** \brief Size of the next block requested from upstream_. */
+  std::size_t next_size_;
+
+  MemoryResource* upstream_;
+};
+
+/**
+ * \brief Resource that forwards to an upstream resource and keeps track of the
+ * memory in use, for budgeting the allocations of a processing pipeline.
+ *
+ * Counts the bytes currently allocated, their high water mark and the total number of
+ * allocations. An optional limit makes allocations that would exceed it throw
+ * std::bad_alloc, so running out of a memory budget can be tested on a development
+ * machine before it happens on the target. The counters are atomic, the resource can
+ * be shared between threads if the upstream resource can.
+ *
+ * \code
+ * pcl::CountingResource counting;
+ * pcl::MemoryResource* previous = pcl::setDefaultResource (&counting);
+ * // ... create the clouds of a processing step
+ * pcl::setDefaultResource (previous);
+ * PCL_INFO ("peak: %zu bytes\n", counting.getPeakBytes ());
+ * \endcode
+ * \ingroup common
+ */
+class PCL_EXPORTS CountingResource : public MemoryResource
+{
+public:
+  /** \brief Constructor.
+   * \param[in] upstream the resource the memory is taken from
+   * \param[in] limit maximum number of bytes in use at any time, 0 for no limit
+   */
+  explicit CountingResource (MemoryResource* upstream = getDefaultResource (),
+                             std::size_t limit = 0);
+
+  CountingResource (const CountingResource&) = delete;
+  CountingResource&
+  operator= (const CountingResource&) = delete;
+
+  /** \brief Get the number of bytes currently allocated. */
+  std::size_t
+  getCurrentBytes () const noexcept
+  {
+    return (current_bytes_.load ());
+  }
+
+  /** \brief Get the highest number of bytes allocated at the same time. */
+  std::size_t
+  getPeakBytes () const noexcept
+  {
+    return (peak_bytes_.load ());
+  }
+
+  /** \brief Get the number of allocations served so far. */
+  std::size_t
+  getNumberOfAllocations () const noexcept
+  {
+    return (nr_allocations_.load ());
+  }
+
+  /** \brief Set the peak to the current usage, to measure the next step on its own. */
+  void
+  resetPeak () noexcept
+  {
+    peak_bytes_.store (current_bytes_.load ());
+  }
+
+  /** \brief Set the maximum number of bytes in use at any time, 0 for no limit. */
+  void
+  setLimit (std::size_t limit) noexcept
+  {
+    limit_.store (limit);
+  }
+
+  /** \brief Get the maximum number of bytes in use at any time, 0 for no limit. */
+  std::size_t
+  getLimit () const noexcept
+  {
+    return (limit_.load ());
+  }
+
+  /** \brief Get the upstream resource. */
+  MemoryResource*
+  getUpstreamResource () const
+  {
+    return (upstream_);
+  }
+
+protected:
+  void*
+  doAllocate (std::size_t bytes, std::size_t alignment) override;
+
+  void
+  doDeallocate (void* p, std::size_t bytes, std::size_t alignment) override;
+
+  bool
+  doIsEqual (const MemoryResource& other) const noexcept override
+  {
+    return (this == &other);
+  }
+
+private:
+  std::atomic<std::size_t> current_bytes_ {0};
+  std::atomic<std::size_t> peak_bytes_ {0};
+  std::atomic<std::size_t> nr_allocations_ {0};
+  std::atomic<std::size_t> limit_;
+
+  MemoryResource* upstream_;
+};
+
+/**
+ * \brief Allocator for Eigen compatible types that takes its memory from a
+ * MemoryResource, the storage allocator of pcl::PointCloud.
+ *
+ * Memory is aligned to at least EIGEN_MAX_ALIGN_BYTES, so vectorized Eigen maps of
+ * the points stay valid. Like std::pmr::polymorphic_allocator the resource is not
+ * propagated on copy: copy constructed containers use the default resource and
+ * copy assignment keeps the resource of the target. Unlike it, the resource moves
+ * along with the memory on move assignment and swap, so these stay constant time
+ * and valid between containers on different resources.
+ * \ingroup common
+ */
+template <typename T>
+class PolymorphicAllocator
+{
+public:
+  using value_type = T;
+  using propagate_on_container_copy_assignment = std::false_type;
+  using propagate_on_container_move_assignment = std::true_type;
+  using propagate_on_container_swap = std::true_type;
+  using is_always_equal = std::false_type;
+
+  /** \brief Allocator on the default resource. */
+  PolymorphicAllocator () noexcept : resource_ (getDefaultResource ()) {}
+
+  /** \brief Allocator on the given resource. */
+  PolymorphicAllocator (MemoryResource* resource) noexcept
+  : resource_ (resource ? resource : getDefaultResource ())
+  {}
+
+  template <typename U>
+  PolymorphicAllocator (const PolymorphicAllocator<U>& other) noexcept
+  : resource_ (other.resource ())
+  {}
+
+  T*
+  allocate (std::size_t n)
+  {
+    if (n > std::numeric_limits<std::size_t>::max () / sizeof (T))
+      throw std::bad_alloc ();
+    return (static_cast<T*> (resource_->allocate (n * sizeof (T), alignment)));
+  }
+
+  void
+  deallocate (T* p, std::size_t n) noexcept
+  {
+    resource_->deallocate (p, n * sizeof (T), alignment);
+  }
+
+  /** \brief Copies of containers are made on the default resource. */
+  PolymorphicAllocator
+  select_on_container_copy_construction () const
+  {
+    return (PolymorphicAllocator ());
+  }
+
+  /** \brief Get the resource memory is taken from. */
+  MemoryResource*
+  resource () const noexcept
+  {
+    return (resource_);
+  }
+
+  /** \brief Alignment of the allocated memory. */
+  static constexpr std::size_t alignment =
+      alignof (T) > EIGEN_MAX_ALIGN_BYTES ? alignof (T)
+                                          : (EIGEN_MAX_ALIGN_BYTES > 0 ? EIGEN_MAX_ALIGN_BYTES
+                                                                       : alignof (std::max_align_t));
+
+private:
+  MemoryResource* resource_;
+};
+
+template <typename T>
+constexpr std::size_t PolymorphicAllocator<T>::alignment;
+
+template <typename T, typename U>
+bool
+operator== (const PolymorphicAllocator<T>& a, const PolymorphicAllocator<U>& b) noexcept
+{
+  return (a.resource ()->isEqual (*b.resource ()));
+}
+
+template <typename T, typename U>
+bool
+operator!= (const PolymorphicAllocator<T>& a, const PolymorphicAllocator<U>& b) noexcept
+{
+  return (!(a == b));
+}
+} // namespace pcl
@@ -47,6 +47,7 @@
 #include <pcl/PCLHeader.h>
 #include <pcl/exceptions.h>
 #include <pcl/memory.h>
+#include <pcl/memory_resource.h>
 #include <pcl/pcl_macros.h>
 #include <pcl/type_traits.h>
 #include <pcl/types.h>
@@ -178,6 +179,13 @@ namespace pcl
         */
       PointCloud () = default;
 
+      /** \brief Constructor for an empty cloud whose points are allocated from resource.
+        * \details Copies of the cloud are allocated from the default resource again,
+        * moves and swaps take the resource along. See pcl::PolymorphicAllocator.
+        * \param[in] resource the memory resource for the points, e.g. a pcl::MonotonicBufferResource
+        */
+      explicit PointCloud (MemoryResource* resource) : points (PolymorphicAllocator<PointT> (resource)) {}
+
       /** \brief Copy constructor from point cloud subset
         * \param[in] pc the cloud to copy into this
         * \param[in] indices the subset to copy
@@ -392,7 +400,7 @@ namespace pcl
       pcl::PCLHeader header;
 
       /** \brief The point data. */
-      std::vector<PointT, Eigen::aligned_allocator<PointT> > points;
+      std::vector<PointT, PolymorphicAllocator<PointT> > points;
 
       /** \brief The point cloud width (if organized as an image-structure). */
       std::uint32_t width = 0;
@@ -408,7 +416,7 @@ namespace pcl
       Eigen::Quaternionf sensor_orientation_ = Eigen::Quaternionf::Identity ();
 
       using PointType = PointT;  // Make the template class available from the outside
-      using VectorType = std::vector<PointT, Eigen::aligned_allocator<PointT> >;
+      using VectorType = std::vector<PointT, PolymorphicAllocator<PointT> >;
       using CloudVectorType = std::vector<PointCloud<PointT>, Eigen::aligned_allocator<PointCloud<PointT> > >;
       using Ptr = shared_ptr<PointCloud<PointT> >;
       using ConstPtr = shared_ptr<const PointCloud<PointT> >;
@@ -869,6 +877,10 @@ namespace pcl
         std::swap (sensor_orientation_, rhs.sensor_orientation_);
       }
 
+      /** \brief Get the memory resource the points are allocated from. */
+      inline MemoryResource*
+      getMemoryResource () const noexcept { return (points.get_allocator ().resource ()); }
+
       /** \brief Removes all points in a cloud and sets the width and height to 0. */
       inline void
       clear ()
@@ -0,0 +1,305 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#pragma once
+
+#include <pcl/memory.h>
+#include <pcl/pcl_macros.h>
+#include <pcl/point_cloud.h>
+#include <pcl/for_each_type.h>
+#include <pcl/type_traits.h>
+#include <pcl/PCLHeader.h>
+#include <pcl/PCLPointField.h>
+#include <pcl/console/print.h>
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace pcl
+{
+  struct PCLPointCloud2;
+
+  /** \brief PointCloudSoA stores a point cloud column by column ("structure of arrays"):
+    * every field (x, y, z, rgb, normal_x, ...) lives in its own contiguous, 16 byte aligned
+    * array, instead of being interleaved with the other fields of the same point as in
+    * pcl::PointCloud<PointT>.
+    *
+    * Algorithms that only touch a few fields (e.g. the coordinates) stream through exactly
+    * the data they need and the compiler is free to vectorize the loops over a column.
+    * Use toPointCloudSoA () and fromPointCloudSoA () to convert from and to
+    * pcl::PointCloud<PointT> and pcl::PCLPointCloud2.
+    *
+    * The fields are described with pcl::PCLPointField; their \a offset member is always 0,
+    * as every field is stored in its own array.
+    *
+    * \ingroup common
+    */
+  class PCL_EXPORTS PointCloudSoA
+  {
+    public:
+      using Column = std::vector<std::uint8_t, Eigen::aligned_allocator<std::uint8_t> >;
+
+      using Ptr = shared_ptr<PointCloudSoA>;
+      using ConstPtr = shared_ptr<const PointCloudSoA>;
+
+      /** \brief The point cloud header. It contains information about the acquisition time. */
+      pcl::PCLHeader header;
+
+      /** \brief The point cloud width (if organized as an image-structure). */
+      uindex_t width = 0;
+      /** \brief The point cloud height (if organized as an image-structure). */
+      uindex_t height = 0;
+
+      /** \brief True if no points are invalid (e.g., have NaN or Inf values in any of their floating point fields). */
+      bool is_dense = true;
+
+      /** \brief Return the number of points in the cloud. */
+      inline std::size_t
+      size () const { return (size_); }
+
+      /** \brief Return true if the cloud has no points. */
+      inline bool
+      empty () const { return (size_ == 0); }
+
+      /** \brief Return whether a dataset is organized (e.g., arranged in a structured grid). */
+      inline bool
+      isOrganized () const { return (height > 1); }
+
+      /** \brief Resize every column to \a count points and make the cloud unorganized.
+        * \param[in] count the new number of points
+        */
+      void
+      resize (std::size_t count);
+
+      /** \brief Resize every column to \a new_width * \a new_height points.
+        * \param[in] new_width the new width of the cloud
+        * \param[in] new_height the new height of the cloud
+        */
+      void
+      resize (uindex_t new_width, uindex_t new_height);
+
+      /** \brief Remove all points, but keep the fields. */
+      void
+      clear ();
+
+      /** \brief Add a column to the cloud, sized to the current number of points and zero filled.
+        * If a field with the same name, datatype and count already exists, its index is returned.
+        * \param[in] name the field name
+        * \param[in] datatype the field datatype (one of pcl::PCLPointField::PointFieldTypes)
+        * \param[in] count the number of elements of the field per point
+        * \return the index of the field, or -1 if a different field with the same name exists
+        */
+      int
+      addField (const std::string &name, std::uint8_t datatype, uindex_t count = 1);
+
+      /** \brief Get the index of a field, or -1 if the cloud has no such field.
+        * \param[in] name the field name
+        */
+      int
+      getFieldIndex (const std::string &name) const;
+
+      /** \brief Get the description of all the fields, ordered by field index. */
+      inline const std::vector<pcl::PCLPointField>&
+      getFields () const { return (fields_); }
+
+      /** \brief Get the number of bytes a field occupies per point.
+        * \param[in] field_index the index of the field
+        */
+      inline std::size_t
+      getElementSize (int field_index) const { return (element_sizes_[field_index]); }
+
+      /** \brief Get the raw data of a field: getElementSize () bytes per point, one point after the other.
+        * \param[in] field_index the index of the field
+        */
+      inline std::uint8_t*
+      getFieldData (int field_index) { return (columns_[field_index].data ()); }
+
+      /** \brief Get the raw data of a field: getElementSize () bytes per point, one point after the other.
+        * \param[in] field_index the index of the field
+        */
+      inline const std::uint8_t*
+      getFieldData (int field_index) const { return (columns_[field_index].data ()); }
+
+      /** \brief Get the typed data of a field with a single element per point.
+        * \param[in] name the field name
+        * \return a pointer to size () values, or nullptr if the field does not exist or is not of type T
+        */
+      template <typename T> inline T*
+      getFieldData (const std::string &name)
+      {
+        return (const_cast<T*> (static_cast<const PointCloudSoA*> (this)->getFieldData<T> (name)));
+      }
+
+      /** \brief Get the typed data of a field with a single element per point.
+        * \param[in] name the field name
+        * \return a pointer to size () values, or nullptr if the field does not exist or is not of type T
+        */
+      template <typename T> inline const T*
+      getFieldData (const std::string &name) const
+      {
+        const int idx = getFieldIndex (name);
+        if (idx == -1 || fields_[idx].datatype != pcl::traits::asEnum<T>::value || element_sizes_[idx] != sizeof (T))
+          return (nullptr);
+        return (reinterpret_cast<const T*> (columns_[idx].data ()));
+      }
+
+    private:
+      /** \brief The description of the fields. */
+      std::vector<pcl::PCLPointField> fields_;
+
+      /** \brief The number of bytes per point of each field. */
+      std::vector<std::size_t> element_sizes_;
+
+      /** \brief The data of each field. */
+      std::vector<Column> columns_;
+
+      /** \brief The number of points. */
+      std::size_t size_ = 0;
+  };
+
+  namespace detail
+  {
+    // For converting a template point cloud to columns
+    template <typename PointT>
+    struct ColumnScatter
+    {
+      ColumnScatter (const pcl::PointCloud<PointT> &cloud, PointCloudSoA &soa) : cloud_ (cloud), soa_ (soa) {}
+
+      template <typename Tag> void
+      operator () ()
+      {
+        using FieldT = typename pcl::traits::datatype<PointT, Tag>::type;
+        const int idx = soa_.addField (pcl::traits::name<PointT, Tag>::value,
+                                       pcl::traits::datatype<PointT, Tag>::value,
+                                       pcl::traits::datatype<PointT, Tag>::size);
+        if (idx == -1)
+          return;
+        std::uint8_t* column = soa_.getFieldData (idx);
+        for (std::size_t i = 0; i < cloud_.size (); ++i)
+          memcpy (column + i * sizeof (FieldT),
+                  reinterpret_cast<const std::uint8_t*> (&cloud_[i]) + pcl::traits::offset<PointT, Tag>::value,
+                  sizeof (FieldT));
+      }
+
+      const pcl::PointCloud<PointT> &cloud_;
+      PointCloudSoA &soa_;
+    };
+
+    // For converting columns to a template point cloud
+    template <typename PointT>
+    struct ColumnGather
+    {
+      ColumnGather (const PointCloudSoA &soa, pcl::PointCloud<PointT> &cloud) : soa_ (soa), cloud_ (cloud) {}
+
+      template <typename Tag> void
+      operator () ()
+      {
+        using FieldT = typename pcl::traits::datatype<PointT, Tag>::type;
+        const auto &fields = soa_.getFields ();
+        for (std::size_t d = 0; d < fields.size (); ++d)
+        {
+          if (!FieldMatches<PointT, Tag> () (fields[d]) || soa_.getElementSize (static_cast<int> (d)) != sizeof (FieldT))
+            continue;
+          const std::uint8_t* column = soa_.getFieldData (static_cast<int> (d));
+          for (std::size_t i = 0; i < cloud_.size (); ++i)
+            memcpy (reinterpret_cast<std::uint8_t*> (&cloud_[i]) + pcl::traits::offset<PointT, Tag>::value,
+                    column + i * sizeof (FieldT),
+                    sizeof (FieldT));
+          return;
+        }
+        PCL_WARN ("Failed to find match for field '%s'.\n", pcl::traits::name<PointT, Tag>::value);
+      }
+
+      const PointCloudSoA &soa_;
+      pcl::PointCloud<PointT> &cloud_;
+    };
+  } // namespace detail
+
+  /** \brief Convert a pcl::PointCloud<PointT> object to a pcl::PointCloudSoA, with one column per field of PointT.
+    * \param[in] cloud the input point cloud
+    * \param[out] soa the resultant columnar point cloud
+    */
+  template <typename PointT> void
+  toPointCloudSoA (const pcl::PointCloud<PointT> &cloud, PointCloudSoA &soa)
+  {
+    soa = PointCloudSoA ();
+    soa.header = cloud.header;
+    soa.resize (cloud.size ());
+    // Ease the user's burden on specifying width/height for unorganized datasets
+    if (cloud.width * cloud.height == cloud.size ())
+      soa.resize (cloud.width, cloud.height);
+    soa.is_dense = cloud.is_dense;
+
+    detail::ColumnScatter<PointT> scatter (cloud, soa);
+    for_each_type<typename traits::fieldList<PointT>::type> (scatter);
+  }
+
+  /** \brief Convert a pcl::PointCloudSoA to a pcl::PointCloud<PointT> object. Fields of PointT without
+    * a matching column are left default initialized, columns without a matching field of PointT are ignored.
+    * \param[in] soa the input columnar point cloud
+    * \param[out] cloud the resultant point cloud
+    */
+  template <typename PointT> void
+  fromPointCloudSoA (const PointCloudSoA &soa, pcl::PointCloud<PointT> &cloud)
+  {
+    cloud.header = soa.header;
+    cloud.resize (soa.size ());
+    cloud.width = soa.width;
+    cloud.height = soa.height;
+    cloud.is_dense = soa.is_dense;
+
+    detail::ColumnGather<PointT> gather (soa, cloud);
+    for_each_type<typename traits::fieldList<PointT>::type> (gather);
+  }
+
+  /** \brief Convert a pcl::PCLPointCloud2 binary data blob to a pcl::PointCloudSoA. Padding fields
+    * (named "_") are dropped.
+    * \param[in] msg the input blob
+    * \param[out] soa the resultant columnar point cloud
+    */
+  PCL_EXPORTS void
+  toPointCloudSoA (const pcl::PCLPointCloud2 &msg, PointCloudSoA &soa);
+
+  /** \brief Convert a pcl::PointCloudSoA to a pcl::PCLPointCloud2 binary data blob, with the fields
+    * packed in the order of their index.
+    * \param[in] soa the input columnar point cloud
+    * \param[out] msg the resultant blob
+    */
+  PCL_EXPORTS void
+  fromPointCloudSoA (const PointCloudSoA &soa, pcl::PCLPointCloud2 &msg);
+} // namespace pcl
@@ -40,9 +40,12 @@
 #pragma once
 
 #include <algorithm>
+#include <cstddef>
+#include <type_traits>
 #include <vector>
 
 #include <pcl/point_types.h>
+#include <pcl/common/distances.h>
 #include <pcl/memory.h>
 #include <pcl/pcl_macros.h>
 #include <pcl/for_each_type.h>
@@ -158,6 +161,22 @@ namespace pcl
         delete [] temp;
       }
 
+      /** \brief Convert input point into a contiguous float array, rescaling by \a alpha.
+        * Writes directly into \a out without any temporary allocation.
+        * \param[in] p the input point
+        * \param[out] out The output array, with room for at least getNumberOfDimensions () elements.
+        */
+      void
+      vectorize (const PointT &p, float *out) const
+      {
+        copyToFloatArray (p, out);
+        if (!alpha_.empty ())
+        {
+          for (int i = 0; i < nr_dimensions_; ++i)
+            out[i] *= alpha_[i];
+        }
+      }
+
       /** \brief Set the rescale values to use when vectorizing points
         * \param[in] rescale_array The array/vector of rescale values.  Can be of any type that implements the [] operator.
         */
@@ -288,6 +307,28 @@ namespace pcl
       int f_idx_;
     };
 
+    // Checks whether the fields are floats stored one after another from the start of the point
+    struct TrivialLayoutFunctor
+    {
+      TrivialLayoutFunctor (bool &trivial) : trivial_ (trivial), offset_ (0)
+      {
+        trivial_ = true;
+      }
+
+      template<typename Key> inline void operator() ()
+      {
+        using FieldT = typename pcl::traits::datatype<PointDefault, Key>::type;
+        if (!std::is_same<typename std::remove_all_extents<FieldT>::type, float>::value ||
+            pcl::traits::offset<PointDefault, Key>::value != offset_)
+          trivial_ = false;
+        offset_ += sizeof (FieldT);
+      }
+
+    private:
+      bool &trivial_;
+      std::size_t offset_;
+    };
+
     public:
       // Boost shared pointers
       using Ptr = shared_ptr<DefaultFeatureRepresentation<PointDefault>>;
@@ -298,6 +339,7 @@ namespace pcl
       {
         nr_dimensions_ = 0; // zero-out the nr_dimensions_ before it gets incremented
         pcl::for_each_type <FieldList> (IncrementFunctor (nr_dimensions_));
+        pcl::for_each_type <FieldList> (TrivialLayoutFunctor (this->trivial_));
       }
 
       inline Ptr
@@ -461,6 +503,7 @@ namespace pcl
       DefaultPointRepresentation ()
       {
         nr_dimensions_ = 1980;
+        trivial_ = true;
       }
 
       void
@@ -479,6 +522,7 @@ namespace pcl
       DefaultPointRepresentation ()
       {
         nr_dimensions_ = 1960;
+        trivial_ = true;
       }
 
       void
@@ -497,6 +541,7 @@ namespace pcl
       DefaultPointRepresentation ()
       {
         nr_dimensions_ = 352;
+        trivial_ = true;
       }
 
       void
@@ -515,6 +560,7 @@ namespace pcl
       DefaultPointRepresentation ()
       {
         nr_dimensions_ = 1344;
+        trivial_ = true;
       }
 
       void
@@ -577,4 +623,83 @@ namespace pcl
       /** \brief Use dimensions only starting with this one (i.e. the "k" in "k-D" is = dim - start_dim_) -- \note float fields are assumed */
       int start_dim_;
   };
+
+  //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+  /** \brief @b StaticPointRepresentation is the compile-time counterpart of DefaultPointRepresentation for the point
+    * types whose default representation is trivial, i.e. a run of floats at the start of the point.
+    *
+    * Code templated on the point type reads the vector of a point in place, with the number of dimensions known at
+    * compile time, instead of copying it through the virtual copyToFloatArray (). \a available is false for point
+    * types without a specialization; the specializations match DefaultPointRepresentation, without rescaling.
+    */
+  template <typename PointT>
+  struct StaticPointRepresentation
+  {
+    static constexpr bool available = false;
+  };
+
+  namespace detail
+  {
+    template <typename PointT, int Dimensions>
+    struct TrivialStaticPointRepresentation
+    {
+      static constexpr bool available = true;
+
+      /** \brief The number of dimensions of the vector of a point. */
+      static constexpr int dimensions = Dimensions;
+
+      /** \brief The vector of a point, read in place. */
+      static const float*
+      data (const PointT &p)
+      {
+        return (reinterpret_cast<const float*> (&p));
+      }
+
+      /** \brief Squared L2 distance of the vectors of two points, SIMD vectorized for descriptors. */
+      static float
+      squaredL2Distance (const PointT &p1, const PointT &p2)
+      {
+        if (dimensions <= 4)
+        {
+          float sum = 0.0f;
+          for (int i = 0; i < dimensions; ++i)
+            sum += (data (p1)[i] - data (p2)[i]) * (data (p1)[i] - data (p2)[i]);
+          return (sum);
+        }
+        return (pcl::squaredL2Distance (data (p1), data (p2), dimensions));
+      }
+
+      /** \brief Chi-square distance of the vectors of two points, for histogram descriptors. */
+      static float
+      chiSquareDistance (const PointT &p1, const PointT &p2)
+      {
+        return (pcl::chiSquareDistance (data (p1), data (p2), dimensions));
+      }
+    };
+
+    template <typename PointT, int Dimensions> constexpr bool TrivialStaticPointRepresentation<PointT, Dimensions>::available;
+    template <typename PointT, int Dimensions> constexpr int TrivialStaticPointRepresentation<PointT, Dimensions>::dimensions;
+  }
+
+#define PCL_STATIC_POINT_REPRESENTATION(PointT, Dimensions) \
+  template <> \
+  struct StaticPointRepresentation<PointT> : public detail::TrivialStaticPointRepresentation<PointT, Dimensions> {};
+
+  PCL_STATIC_POINT_REPRESENTATION (PointXYZ, 3)
+  PCL_STATIC_POINT_REPRESENTATION (PointXYZI, 3)
+  PCL_STATIC_POINT_REPRESENTATION (PointNormal, 3)
+  PCL_STATIC_POINT_REPRESENTATION (PFHSignature125, 125)
+  PCL_STATIC_POINT_REPRESENTATION (PFHRGBSignature250, 250)
+  PCL_STATIC_POINT_REPRESENTATION (FPFHSignature33, 33)
+  PCL_STATIC_POINT_REPRESENTATION (VFHSignature308, 308)
+  PCL_STATIC_POINT_REPRESENTATION (GASDSignature512, 512)
+  PCL_STATIC_POINT_REPRESENTATION (GASDSignature984, 984)
+  PCL_STATIC_POINT_REPRESENTATION (GASDSignature7992, 7992)
+  PCL_STATIC_POINT_REPRESENTATION (NormalBasedSignature12, 12)
+  PCL_STATIC_POINT_REPRESENTATION (ShapeContext1980, 1980)
+  PCL_STATIC_POINT_REPRESENTATION (UniqueShapeContext1960, 1960)
+  PCL_STATIC_POINT_REPRESENTATION (SHOT352, 352)
+  PCL_STATIC_POINT_REPRESENTATION (SHOT1344, 1344)
+
+#undef PCL_STATIC_POINT_REPRESENTATION
 }
@@ -348,6 +348,22 @@ namespace pcl
     * \ingroup common
     */
   struct PointDEM;
+
+  /** \brief Members: std::int16_t x, y, z, in quantization steps from a tile origin
+    * \ingroup common
+    */
+  struct PointXYZQ16;
+
+  /** \brief Members: std::uint16_t x, y, z, holding half precision floats
+    * \ingroup common
+    */
+  struct PointXYZHalf;
+
+  /** \brief Members: std::uint16_t x, y, z, curvature, holding half precision floats;
+    * std::int16_t normal_oct[2], an octahedral encoded normal
+    * \ingroup common
+    */
+  struct PointNormalHalf;
 } // namespace pcl
 /** @} */
 
@@ -38,6 +38,7 @@
 
 #pragma once
 
+#include <cmath> // for cbrt
 #include <limits>
 
 #include <pcl/point_cloud.h>
@@ -172,10 +173,11 @@ namespace pcl
     f[1] /= 1;
     f[2] /= 1.08883;
 
-    // CIEXYZ -> CIELAB
+    // CIEXYZ -> CIELAB (the gamma step above is already table driven, cbrt is
+    // several times cheaper than the general pow for the remaining cube root)
     for (int i = 0; i < 3; ++i) {
       if (f[i] > 0.008856) {
-        f[i] = std::pow(f[i], 1.0 / 3.0);
+        f[i] = std::cbrt(f[i]);
       }
       else {
         f[i] = 7.787 * f[i] + 16.0 / 116.0;
@@ -42,9 +42,16 @@
 
 #include <pcl/pcl_macros.h>
 #include <pcl/common/distances.h>
+#include <pcl/common/execution_context.h>
 #include <pcl/common/point_tests.h> // for pcl::isFinite
 #include <pcl/common/vector_average.h> // for VectorAverage3f
 
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring> // for memcpy
+#include <memory>
+
 namespace pcl
 {
 
@@ -232,6 +239,13 @@ RangeImage::createFromPointCloudWithViewpoints (const PointCloudTypeWithViewpoin
 template <typename PointCloudType> void 
 RangeImage::doZBuffer (const PointCloudType& point_cloud, float noise_level, float min_range, int& top, int& right, int& bottom, int& left)
 {
+  // Without a noise level the z-buffer keeps the minimum per cell, which does not depend on the order of the points
+  if (noise_level <= 0.0f && max_no_of_threads != 1)
+  {
+    doZBufferParallel (point_cloud, min_range, top, right, bottom, left);
+    return;
+  }
+
   using PointType2 = typename PointCloudType::PointType;
   const typename pcl::PointCloud<PointType2>::VectorType &points2 = point_cloud.points;
   
@@ -325,6 +339,102 @@ RangeImage::doZBuffer (const PointCloudType& point_cloud, float noise_level, flo
   delete[] counters;
 }
 
+/////////////////////////////////////////////////////////////////////////
+template <typename PointCloudType> void
+RangeImage::doZBufferParallel (const PointCloudType& point_cloud, float min_range, int& top, int& right, int& bottom, int& left)
+{
+  const pcl::ThreadReservation reservation (static_cast<unsigned int> (std::max (max_no_of_threads, 0)));
+  const unsigned int threads = reservation.getNumberOfThreads ();
+
+  // Ranges are non-negative, so their bit patterns order like the floats themselves and the cells can be updated
+  // with an integer atomic minimum. The bit pattern of a NaN marks cells without any point.
+  std::uint32_t empty_cell = 0xFFFFFFFFu;
+  auto toBits = [] (float value) { std::uint32_t bits; std::memcpy (&bits, &value, sizeof (bits)); return (bits); };
+  auto fromBits = [] (std::uint32_t bits) { float value; std::memcpy (&value, &bits, sizeof (value)); return (value); };
+  auto atomicMin = [] (std::atomic<std::uint32_t>& cell, std::uint32_t value)
+  {
+    std::uint32_t current = cell.load (std::memory_order_relaxed);
+    while (value < current && !cell.compare_exchange_weak (current, value, std::memory_order_relaxed)) {}
+  };
+
+  int size = static_cast<int> (width*height);
+  // Closest point falling into each cell, and closest point falling next to each cell (the interpolation of doZBuffer)
+  std::unique_ptr<std::atomic<std::uint32_t>[]> direct_ranges (new std::atomic<std::uint32_t>[size]),
+                                                neighbor_ranges (new std::atomic<std::uint32_t>[size]);
+  for (int i = 0; i < size; ++i)
+  {
+    direct_ranges[i].store (empty_cell, std::memory_order_relaxed);
+    neighbor_ranges[i].store (empty_cell, std::memory_order_relaxed);
+  }
+
+  top=height; right=-1; bottom=-1; left=width;
+
+  int nr_points = static_cast<int> (point_cloud.size ());
+#pragma omp parallel \
+  default(none) \
+  shared(atomicMin, direct_ranges, min_range, neighbor_ranges, nr_points, point_cloud, toBits, top, right, bottom, left) \
+  num_threads(threads)
+  {
+    int local_top=height, local_right=-1, local_bottom=-1, local_left=width;
+#pragma omp for schedule(static)
+    for (int point_idx = 0; point_idx < nr_points; ++point_idx)
+    {
+      const auto& point = point_cloud[point_idx];
+      if (!isFinite (point))  // Check for NAN etc
+        continue;
+
+      float x_real, y_real, range_of_current_point;
+      int x, y;
+      this->getImagePoint (point.getVector3fMap (), x_real, y_real, range_of_current_point);
+      this->real2DToInt2D (x_real, y_real, x, y);
+
+      if (range_of_current_point < min_range|| !isInImage (x, y))
+        continue;
+      const std::uint32_t range_bits = toBits (range_of_current_point);
+
+      // The same three closest neighbors as in doZBuffer
+      int floor_x = pcl_lrint (std::floor (x_real)), floor_y = pcl_lrint (std::floor (y_real)),
+          ceil_x  = pcl_lrint (std::ceil (x_real)),  ceil_y  = pcl_lrint (std::ceil (y_real));
+      const int neighbor_x[4] = {floor_x, floor_x, ceil_x, ceil_x},
+                neighbor_y[4] = {floor_y, ceil_y, floor_y, ceil_y};
+      for (int i=0; i<4; ++i)
+      {
+        int n_x=neighbor_x[i], n_y=neighbor_y[i];
+        if ((n_x==x && n_y==y) || !isInImage (n_x, n_y))
+          continue;
+        atomicMin (neighbor_ranges[n_y*width + n_x], range_bits);
+        local_top= (std::min) (local_top, n_y); local_right= (std::max) (local_right, n_x);
+        local_bottom= (std::max) (local_bottom, n_y); local_left= (std::min) (local_left, n_x);
+      }
+
+      atomicMin (direct_ranges[y*width + x], range_bits);
+      local_top= (std::min) (local_top, y); local_right= (std::max) (local_right, x);
+      local_bottom= (std::max) (local_bottom, y); local_left= (std::min) (local_left, x);
+    }
+#pragma omp critical
+    {
+      top= (std::min) (top, local_top); right= (std::max) (right, local_right);
+      bottom= (std::max) (bottom, local_bottom); left= (std::min) (left, local_left);
+    }
+  }
+
+  // A point falling into a cell overrides the interpolated ranges, like in doZBuffer
+#pragma omp parallel for \
+  default(none) \
+  shared(direct_ranges, empty_cell, fromBits, neighbor_ranges, size) \
+  num_threads(threads)
+  for (int i = 0; i < size; ++i)
+  {
+    const std::uint32_t direct_bits = direct_ranges[i].load (std::memory_order_relaxed);
+    const std::uint32_t neighbor_bits = neighbor_ranges[i].load (std::memory_order_relaxed);
+    float& range = points[i].range;
+    if (direct_bits != empty_cell)
+      range = fromBits (direct_bits);
+    else if (neighbor_bits != empty_cell)
+      range = (std::isinf (range) ? fromBits (neighbor_bits) : (std::min) (range, fromBits (neighbor_bits)));
+  }
+}
+
 /////////////////////////////////////////////////////////////////////////
 void 
 RangeImage::getImagePoint (float x, float y, float z, float& image_x, float& image_y, float& range) const 
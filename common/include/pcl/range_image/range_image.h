@@ -74,7 +74,7 @@ namespace pcl
       PCL_EXPORTS virtual ~RangeImage () = default;
 
       // =====STATIC VARIABLES=====
-      /** The maximum number of openmp threads that can be used in this class */
+      /** The maximum number of openmp threads that can be used in this class (0 takes as many as the budget of pcl::ExecutionContext allows) */
       static int max_no_of_threads;
 
       // =====STATIC METHODS=====
@@ -310,6 +310,20 @@ namespace pcl
       doZBuffer (const PointCloudType& point_cloud, float noise_level,
                  float min_range, int& top, int& right, int& bottom, int& left);
 
+      /** \brief Multithreaded z-buffer used by doZBuffer when the noise level is 0 and max_no_of_threads is not
+        * 1. The points are projected in parallel and each cell keeps its minimum range through atomic updates,
+        * which gives the same image as the serial z-buffer.
+        * \param point_cloud the input point cloud
+        * \param min_range the minimum visible range
+        * \param top    returns the minimum y pixel position in the image where a point was added
+        * \param right  returns the maximum x pixel position in the image where a point was added
+        * \param bottom returns the maximum y pixel position in the image where a point was added
+        * \param left   returns the minimum x pixel position in the image where a point was added
+        */
+      template <typename PointCloudType> void
+      doZBufferParallel (const PointCloudType& point_cloud, float min_range,
+                         int& top, int& right, int& bottom, int& left);
+
       /** \brief Integrates the given far range measurements into the range image */
       template <typename PointCloudType> void
       integrateFarRanges (const PointCloudType& far_ranges);
@@ -0,0 +1,757 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include <pcl/common/centroid.h>
+#include <pcl/common/cpu_dispatch.h>
+
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define PCL_CENTROID_SSE2_KERNELS
+#endif
+#if defined(PCL_SIMD_KERNELS_AVX) || defined(PCL_SIMD_KERNELS_AVX512)
+#include <immintrin.h>
+#endif
+
+// The raw kernels accumulate, for every point p = (x, y, z, w):
+//   m1 = (x, x, x, y) * (x, y, z, y) = (xx, xy, xz, yy)
+//   m2 = (y, z, ., .) * (z, z, ., .) = (yz, zz, ., .)
+//   p                                = (x, y, z, .)
+// The products are computed in single precision, like computeMeanAndCovarianceMatrix ()
+// does, and only the sums use the precision of the accumulator.
+//
+// The demeaned kernels accumulate the same six products of d = p - centroid, computed in the
+// precision of the accumulator, like computeCovarianceMatrix () does. In double precision,
+// d is held as lo = (x, y) and hi = (z, .):
+//   (x, x) * (x, y), (x, y) * (z, y), (y, z) * (z, z)
+//
+// Points that are not finite are zeroed (d after subtracting the centroid), so that they do
+// not contribute to the sums, and the kernels return the number of finite points.
+#define PCL_CENTROID_M1_LHS 0x40  // _MM_SHUFFLE (1, 0, 0, 0)
+#define PCL_CENTROID_M1_RHS 0x64  // _MM_SHUFFLE (1, 2, 1, 0)
+#define PCL_CENTROID_M2_LHS 0x09  // _MM_SHUFFLE (0, 0, 2, 1)
+#define PCL_CENTROID_M2_RHS 0x0A  // _MM_SHUFFLE (0, 0, 2, 2)
+
+namespace
+{
+  /** Number of points the indexed kernels prefetch ahead of the one they process. */
+  constexpr std::size_t prefetch_distance = 8;
+
+  /** The points of a dense cloud, in memory order. */
+  struct DenseAccess
+  {
+    const std::uint8_t* src;
+    std::size_t stride;
+
+    inline const float*
+    operator() (std::size_t i) const
+    {
+      return (reinterpret_cast<const float*> (src + i * stride));
+    }
+
+    inline void
+    prefetch (std::size_t) const {}
+
+    /** The points starting with the i-th one. */
+    inline DenseAccess
+    advance (std::size_t i) const
+    {
+      return {src + i * stride, stride};
+    }
+  };
+
+  /** The points selected by a list of indices, which are spread over the cloud and therefore
+    * fetched into the cache ahead of their use.
+    */
+  struct IndexedAccess
+  {
+    const std::uint8_t* src;
+    std::size_t stride;
+    const pcl::index_t* indices;
+    std::size_t nr_points;
+
+    inline const float*
+    operator() (std::size_t i) const
+    {
+      return (reinterpret_cast<const float*> (src + static_cast<std::size_t> (indices[i]) * stride));
+    }
+
+    inline void
+    prefetch (std::size_t i) const
+    {
+#ifdef PCL_CENTROID_SSE2_KERNELS
+      if (i + prefetch_distance < nr_points)
+        _mm_prefetch (reinterpret_cast<const char*> ((*this) (i + prefetch_distance)), _MM_HINT_T0);
+#else
+      (void) i;
+#endif
+    }
+
+    inline IndexedAccess
+    advance (std::size_t i) const
+    {
+      return {src, stride, indices + i, nr_points - i};
+    }
+  };
+
+  inline bool
+  isFinite (const float* p)
+  {
+    return (std::isfinite (p[0]) && std::isfinite (p[1]) && std::isfinite (p[2]));
+  }
+
+#ifdef PCL_CENTROID_SSE2_KERNELS
+  /** All bits set if x, y and z of the point p are finite, all bits cleared otherwise. */
+  inline __m128
+  finiteMask (__m128 p)
+  {
+    const __m128 m = _mm_cmpeq_ps (_mm_sub_ps (p, p), _mm_setzero_ps ());
+    return (_mm_and_ps (_mm_shuffle_ps (m, m, 0x00), _mm_and_ps (_mm_shuffle_ps (m, m, 0x55), _mm_shuffle_ps (m, m, 0xAA))));
+  }
+
+  /** Load a point and, with CheckFinite, compute its finite mask and count it if it is finite. */
+  template <bool CheckFinite> inline __m128
+  loadPoint (const float* src, __m128& mask, std::size_t& count)
+  {
+    const __m128 p = _mm_loadu_ps (src);
+    if (CheckFinite)
+    {
+      mask = finiteMask (p);
+      count += _mm_movemask_ps (mask) & 1;
+    }
+    return (p);
+  }
+
+  /** Compute m1 and m2 (see above) for one point. */
+  inline void
+  products (__m128 p, __m128& m1, __m128& m2)
+  {
+    m1 = _mm_mul_ps (_mm_shuffle_ps (p, p, PCL_CENTROID_M1_LHS), _mm_shuffle_ps (p, p, PCL_CENTROID_M1_RHS));
+    m2 = _mm_mul_ps (_mm_shuffle_ps (p, p, PCL_CENTROID_M2_LHS), _mm_shuffle_ps (p, p, PCL_CENTROID_M2_RHS));
+  }
+#endif // PCL_CENTROID_SSE2_KERNELS
+
+#ifdef PCL_SIMD_KERNELS_AVX
+  /** Put two points, or masks, into the two halves of a register. */
+  PCL_SIMD_TARGET_AVX inline __m256
+  combine (__m128 a, __m128 b)
+  {
+    return (_mm256_insertf128_ps (_mm256_castps128_ps256 (a), b, 1));
+  }
+
+  PCL_SIMD_TARGET_AVX inline void
+  products (__m256 p, __m256& m1, __m256& m2)
+  {
+    m1 = _mm256_mul_ps (_mm256_permute_ps (p, PCL_CENTROID_M1_LHS), _mm256_permute_ps (p, PCL_CENTROID_M1_RHS));
+    m2 = _mm256_mul_ps (_mm256_permute_ps (p, PCL_CENTROID_M2_LHS), _mm256_permute_ps (p, PCL_CENTROID_M2_RHS));
+  }
+
+  /** Add up the two 128 bit lanes of a register. */
+  PCL_SIMD_TARGET_AVX inline __m128
+  fold (__m256 s)
+  {
+    return (_mm_add_ps (_mm256_castps256_ps128 (s), _mm256_extractf128_ps (s, 1)));
+  }
+
+  PCL_SIMD_TARGET_AVX inline __m128d
+  fold (__m256d s)
+  {
+    return (_mm_add_pd (_mm256_castpd256_pd128 (s), _mm256_extractf128_pd (s, 1)));
+  }
+#endif // PCL_SIMD_KERNELS_AVX
+
+#ifdef PCL_SIMD_KERNELS_AVX512
+  /** Put four points, or masks, into the four 128 bit lanes of a register. */
+  PCL_SIMD_TARGET_AVX512 inline __m512
+  combine (__m128 a, __m128 b, __m128 c, __m128 d)
+  {
+    __m512 r = _mm512_castps128_ps512 (a);
+    r = _mm512_insertf32x4 (r, b, 1);
+    r = _mm512_insertf32x4 (r, c, 2);
+    return (_mm512_insertf32x4 (r, d, 3));
+  }
+
+  PCL_SIMD_TARGET_AVX512 inline __m512
+  bitwiseAnd (__m512 a, __m512 b)
+  {
+    return (_mm512_castsi512_ps (_mm512_and_si512 (_mm512_castps_si512 (a), _mm512_castps_si512 (b))));
+  }
+
+  PCL_SIMD_TARGET_AVX512 inline __m512d
+  bitwiseAnd (__m512d a, __m512d b)
+  {
+    return (_mm512_castsi512_pd (_mm512_and_si512 (_mm512_castpd_si512 (a), _mm512_castpd_si512 (b))));
+  }
+
+  PCL_SIMD_TARGET_AVX512 inline void
+  products (__m512 p, __m512& m1, __m512& m2)
+  {
+    m1 = _mm512_mul_ps (_mm512_permute_ps (p, PCL_CENTROID_M1_LHS), _mm512_permute_ps (p, PCL_CENTROID_M1_RHS));
+    m2 = _mm512_mul_ps (_mm512_permute_ps (p, PCL_CENTROID_M2_LHS), _mm512_permute_ps (p, PCL_CENTROID_M2_RHS));
+  }
+
+  /** Add up the four 128 bit lanes of a register. */
+  PCL_SIMD_TARGET_AVX512 inline __m128
+  fold (__m512 s)
+  {
+    return (fold (_mm256_add_ps (_mm512_castps512_ps256 (s),
+                                 _mm256_castpd_ps (_mm512_extractf64x4_pd (_mm512_castps_pd (s), 1)))));
+  }
+
+  PCL_SIMD_TARGET_AVX512 inline __m128d
+  fold (__m512d s)
+  {
+    return (fold (_mm256_add_pd (_mm512_castpd512_pd256 (s), _mm512_extractf64x4_pd (s, 1))));
+  }
+#endif // PCL_SIMD_KERNELS_AVX512
+
+  /** Kernels for the sums of xx, xy, xz, yy, yz, zz, x, y and z. */
+  struct RawSums
+  {
+    template <bool CheckFinite, typename Access, typename Scalar> static std::size_t
+    generic (const Access& point, std::size_t nr_points, const Scalar*, Scalar* accu)
+    {
+      std::size_t count = 0;
+      for (std::size_t i = 0; i < nr_points; ++i)
+      {
+        const float* p = point (i);
+        if (CheckFinite && !isFinite (p))
+          continue;
+        accu[0] += p[0] * p[0];
+        accu[1] += p[0] * p[1];
+        accu[2] += p[0] * p[2];
+        accu[3] += p[1] * p[1];
+        accu[4] += p[1] * p[2];
+        accu[5] += p[2] * p[2];
+        accu[6] += p[0];
+        accu[7] += p[1];
+        accu[8] += p[2];
+        ++count;
+      }
+      return (count);
+    }
+
+    /** Add the sums held in the lanes of s1, s2 and s3 (see above) to accu. */
+    template <typename Scalar> static void
+    store (const Scalar* s1, const Scalar* s2, const Scalar* s3, Scalar* accu)
+    {
+      accu[0] += s1[0]; accu[1] += s1[1]; accu[2] += s1[2]; accu[3] += s1[3];
+      accu[4] += s2[0]; accu[5] += s2[1];
+      accu[6] += s3[0]; accu[7] += s3[1]; accu[8] += s3[2];
+    }
+
+#ifdef PCL_CENTROID_SSE2_KERNELS
+    template <bool CheckFinite, typename Access> static std::size_t
+    sse2 (const Access& point, std::size_t nr_points, const float*, float* accu)
+    {
+      __m128 s1 = _mm_setzero_ps (), s2 = _mm_setzero_ps (), s3 = _mm_setzero_ps ();
+      std::size_t count = 0;
+      for (std::size_t i = 0; i < nr_points; ++i)
+      {
+        point.prefetch (i);
+        __m128 mask;
+        __m128 p = loadPoint<CheckFinite> (point (i), mask, count);
+        if (CheckFinite)
+          p = _mm_and_ps (p, mask);
+        __m128 m1, m2;
+        products (p, m1, m2);
+        s1 = _mm_add_ps (s1, m1);
+        s2 = _mm_add_ps (s2, m2);
+        s3 = _mm_add_ps (s3, p);
+      }
+      float r1[4], r2[4], r3[4];
+      _mm_storeu_ps (r1, s1); _mm_storeu_ps (r2, s2); _mm_storeu_ps (r3, s3);
+      store (r1, r2, r3, accu);
+      return (CheckFinite ? count : nr_points);
+    }
+
+    template <bool CheckFinite, typename Access> static std::size_t
+    sse2 (const Access& point, std::size_t nr_points, const double*, double* accu)
+    {
+      __m128d s1l = _mm_setzero_pd (), s1h = _mm_setzero_pd (), s2 = _mm_setzero_pd ();
+      __m128d s3l = _mm_setzero_pd (), s3h = _mm_setzero_pd ();
+      std::size_t count = 0;
+      for (std::size_t i = 0; i < nr_points; ++i)
+      {
+        point.prefetch (i);
+        __m128 mask;
+        __m128 p = loadPoint<CheckFinite> (point (i), mask, count);
+        if (CheckFinite)
+          p = _mm_and_ps (p, mask);
+        __m128 m1, m2;
+        products (p, m1, m2);
+        s1l = _mm_add_pd (s1l, _mm_cvtps_pd (m1));
+        s1h = _mm_add_pd (s1h, _mm_cvtps_pd (_mm_movehl_ps (m1, m1)));
+        s2 = _mm_add_pd (s2, _mm_cvtps_pd (m2));
+        s3l = _mm_add_pd (s3l, _mm_cvtps_pd (p));
+        s3h = _mm_add_pd (s3h, _mm_cvtps_pd (_mm_movehl_ps (p, p)));
+      }
+      double r1[4], r2[2], r3[4];
+      _mm_storeu_pd (r1, s1l); _mm_storeu_pd (r1 + 2, s1h);
+      _mm_storeu_pd (r2, s2);
+      _mm_storeu_pd (r3, s3l); _mm_storeu_pd (r3 + 2, s3h);
+      store (r1, r2, r3, accu);
+      return (CheckFinite ? count : nr_points);
+    }
+#endif // PCL_CENTROID_SSE2_KERNELS
+
+#ifdef PCL_SIMD_KERNELS_AVX
+    /** Two points per register. */
+    template <bool CheckFinite, typename Access> PCL_SIMD_TARGET_AVX static std::size_t
+    avx (const Access& point, std::size_t nr_points, const float* centroid, float* accu)
+    {
+      __m256 s1 = _mm256_setzero_ps (), s2 = _mm256_setzero_ps (), s3 = _mm256_setzero_ps ();
+      std::size_t count = 0, i = 0;
+      for (; i + 2 <= nr_points; i += 2)
+      {
+        point.prefetch (i);
+        point.prefetch (i + 1);
+        __m128 ma, mb;
+        __m128 pa = loadPoint<CheckFinite> (point (i), ma, count);
+        __m128 pb = loadPoint<CheckFinite> (point (i + 1), mb, count);
+        if (CheckFinite)
+        {
+          pa = _mm_and_ps (pa, ma);
+          pb = _mm_and_ps (pb, mb);
+        }
+        const __m256 p = combine (pa, pb);
+        __m256 m1, m2;
+        products (p, m1, m2);
+        s1 = _mm256_add_ps (s1, m1);
+        s2 = _mm256_add_ps (s2, m2);
+        s3 = _mm256_add_ps (s3, p);
+      }
+      float r1[4], r2[4], r3[4];
+      _mm_storeu_ps (r1, fold (s1)); _mm_storeu_ps (r2, fold (s2)); _mm_storeu_ps (r3, fold (s3));
+      store (r1, r2, r3, accu);
+      if (i < nr_points)
+        count += sse2<CheckFinite> (point.advance (i), nr_points - i, centroid, accu);
+      return (CheckFinite ? count : nr_points);
+    }
+
+    /** One point per register. */
+    template <bool CheckFinite, typename Access> PCL_SIMD_TARGET_AVX static std::size_t
+    avx (const Access& point, std::size_t nr_points, const double*, double* accu)
+    {
+      __m256d s1 = _mm256_setzero_pd (), s2 = _mm256_setzero_pd (), s3 = _mm256_setzero_pd ();
+      std::size_t count = 0;
+      for (std::size_t i = 0; i < nr_points; ++i)
+      {
+        point.prefetch (i);
+        __m128 mask;
+        __m128 p = loadPoint<CheckFinite> (point (i), mask, count);
+        if (CheckFinite)
+          p = _mm_and_ps (p, mask);
+        const __m128 m1 = _mm_mul_ps (_mm_permute_ps (p, PCL_CENTROID_M1_LHS), _mm_permute_ps (p, PCL_CENTROID_M1_RHS));
+        const __m128 m2 = _mm_mul_ps (_mm_permute_ps (p, PCL_CENTROID_M2_LHS), _mm_permute_ps (p, PCL_CENTROID_M2_RHS));
+        s1 = _mm256_add_pd (s1, _mm256_cvtps_pd (m1));
+        s2 = _mm256_add_pd (s2, _mm256_cvtps_pd (m2));
+        s3 = _mm256_add_pd (s3, _mm256_cvtps_pd (p));
+      }
+      double r1[4], r2[4], r3[4];
+      _mm256_storeu_pd (r1, s1); _mm256_storeu_pd (r2, s2); _mm256_storeu_pd (r3, s3);
+      store (r1, r2, r3, accu);
+      return (CheckFinite ? count : nr_points);
+    }
+#endif // PCL_SIMD_KERNELS_AVX
+
+#ifdef PCL_SIMD_KERNELS_AVX512
+    /** Four points per register. */
+    template <bool CheckFinite, typename Access> PCL_SIMD_TARGET_AVX512 static std::size_t
+    avx512 (const Access& point, std::size_t nr_points, const float* centroid, float* accu)
+    {
+      __m512 s1 = _mm512_setzero_ps (), s2 = _mm512_setzero_ps (), s3 = _mm512_setzero_ps ();
+      std::size_t count = 0, i = 0;
+      for (; i + 4 <= nr_points; i += 4)
+      {
+        __m128 p[4], mask[4];
+        for (std::size_t k = 0; k < 4; ++k)
+        {
+          point.prefetch (i + k);
+          p[k] = loadPoint<CheckFinite> (point (i + k), mask[k], count);
+          if (CheckFinite)
+            p[k] = _mm_and_ps (p[k], mask[k]);
+        }
+        const __m512 pp = combine (p[0], p[1], p[2], p[3]);
+        __m512 m1, m2;
+        products (pp, m1, m2);
+        s1 = _mm512_add_ps (s1, m1);
+        s2 = _mm512_add_ps (s2, m2);
+        s3 = _mm512_add_ps (s3, pp);
+      }
+      float r1[4], r2[4], r3[4];
+      _mm_storeu_ps (r1, fold (s1)); _mm_storeu_ps (r2, fold (s2)); _mm_storeu_ps (r3, fold (s3));
+      store (r1, r2, r3, accu);
+      if (i < nr_points)
+        count += avx<CheckFinite> (point.advance (i), nr_points - i, centroid, accu);
+      return (CheckFinite ? count : nr_points);
+    }
+
+    /** Two points per register. */
+    template <bool CheckFinite, typename Access> PCL_SIMD_TARGET_AVX512 static std::size_t
+    avx512 (const Access& point, std::size_t nr_points, const double* centroid, double* accu)
+    {
+      __m512d s1 = _mm512_setzero_pd (), s2 = _mm512_setzero_pd (), s3 = _mm512_setzero_pd ();
+      std::size_t count = 0, i = 0;
+      for (; i + 2 <= nr_points; i += 2)
+      {
+        point.prefetch (i);
+        point.prefetch (i + 1);
+        __m128 ma, mb;
+        __m128 pa = loadPoint<CheckFinite> (point (i), ma, count);
+        __m128 pb = loadPoint<CheckFinite> (point (i + 1), mb, count);
+        if (CheckFinite)
+        {
+          pa = _mm_and_ps (pa, ma);
+          pb = _mm_and_ps (pb, mb);
+        }
+        const __m256 p = combine (pa, pb);
+        __m256 m1, m2;
+        products (p, m1, m2);
+        s1 = _mm512_add_pd (s1, _mm512_cvtps_pd (m1));
+        s2 = _mm512_add_pd (s2, _mm512_cvtps_pd (m2));
+        s3 = _mm512_add_pd (s3, _mm512_cvtps_pd (p));
+      }
+      double r1[4], r2[4], r3[4];
+      _mm256_storeu_pd (r1, _mm256_add_pd (_mm512_castpd512_pd256 (s1), _mm512_extractf64x4_pd (s1, 1)));
+      _mm256_storeu_pd (r2, _mm256_add_pd (_mm512_castpd512_pd256 (s2), _mm512_extractf64x4_pd (s2, 1)));
+      _mm256_storeu_pd (r3, _mm256_add_pd (_mm512_castpd512_pd256 (s3), _mm512_extractf64x4_pd (s3, 1)));
+      store (r1, r2, r3, accu);
+      if (i < nr_points)
+        count += avx<CheckFinite> (point.advance (i), nr_points - i, centroid, accu);
+      return (CheckFinite ? count : nr_points);
+    }
+#endif // PCL_SIMD_KERNELS_AVX512
+  };
+
+  /** Kernels for the sums of xx, xy, xz, yy, yz and zz of the points minus a centroid. */
+  struct DemeanedSums
+  {
+    template <bool CheckFinite, typename Access, typename Scalar> static std::size_t
+    generic (const Access& point, std::size_t nr_points, const Scalar* centroid, Scalar* accu)
+    {
+      std::size_t count = 0;
+      for (std::size_t i = 0; i < nr_points; ++i)
+      {
+        const float* p = point (i);
+        if (CheckFinite && !isFinite (p))
+          continue;
+        const Scalar x = p[0] - centroid[0];
+        const Scalar y = p[1] - centroid[1];
+        const Scalar z = p[2] - centroid[2];
+        accu[0] += x * x;
+        accu[1] += x * y;
+        accu[2] += x * z;
+        accu[3] += y * y;
+        accu[4] += y * z;
+        accu[5] += z * z;
+        ++count;
+      }
+      return (count);
+    }
+
+#ifdef PCL_CENTROID_SSE2_KERNELS
+    template <bool CheckFinite, typename Access> static std::size_t
+    sse2 (const Access& point, std::size_t nr_points, const float* centroid, float* accu)
+    {
+      const __m128 c = _mm_setr_ps (centroid[0], centroid[1], centroid[2], 0.0f);
+      __m128 s1 = _mm_setzero_ps (), s2 = _mm_setzero_ps ();
+      std::size_t count = 0;
+      for (std::size_t i = 0; i < nr_points; ++i)
+      {
+        point.prefetch (i);
+        __m128 mask;
+        __m128 d = _mm_sub_ps (loadPoint<CheckFinite> (point (i), mask, count), c);
+        if (CheckFinite)
+          d = _mm_and_ps (d, mask);
+        __m128 m1, m2;
+        products (d, m1, m2);
+        s1 = _mm_add_ps (s1, m1);
+        s2 = _mm_add_ps (s2, m2);
+      }
+      float r[8];
+      _mm_storeu_ps (r, s1); _mm_storeu_ps (r + 4, s2);
+      for (int k = 0; k < 6; ++k)
+        accu[k] += r[k];
+      return (CheckFinite ? count : nr_points);
+    }
+
+    template <bool CheckFinite, typename Access> static std::size_t
+    sse2 (const Access& point, std::size_t nr_points, const double* centroid, double* accu)
+    {
+      const __m128d c_lo = _mm_setr_pd (centroid[0], centroid[1]);
+      const __m128d c_hi = _mm_setr_pd (centroid[2], 0.0);
+      __m128d s1 = _mm_setzero_pd (), s2 = _mm_setzero_pd (), s3 = _mm_setzero_pd ();
+      std::size_t count = 0;
+      for (std::size_t i = 0; i < nr_points; ++i)
+      {
+        point.prefetch (i);
+        __m128 mask;
+        const __m128 p = loadPoint<CheckFinite> (point (i), mask, count);
+        __m128d lo = _mm_sub_pd (_mm_cvtps_pd (p), c_lo);
+        __m128d hi = _mm_sub_pd (_mm_cvtps_pd (_mm_movehl_ps (p, p)), c_hi);
+        if (CheckFinite)
+        {
+          lo = _mm_and_pd (lo, _mm_castps_pd (mask));
+          hi = _mm_and_pd (hi, _mm_castps_pd (mask));
+        }
+        s1 = _mm_add_pd (s1, _mm_mul_pd (_mm_unpacklo_pd (lo, lo), lo));
+        s2 = _mm_add_pd (s2, _mm_mul_pd (lo, _mm_shuffle_pd (hi, lo, 0x2)));
+        s3 = _mm_add_pd (s3, _mm_mul_pd (_mm_shuffle_pd (lo, hi, 0x1), _mm_unpacklo_pd (hi, hi)));
+      }
+      double r[6];
+      _mm_storeu_pd (r, s1); _mm_storeu_pd (r + 2, s2); _mm_storeu_pd (r + 4, s3);
+      for (int k = 0; k < 6; ++k)
+        accu[k] += r[k];
+      return (CheckFinite ? count : nr_points);
+    }
+#endif // PCL_CENTROID_SSE2_KERNELS
+
+#ifdef PCL_SIMD_KERNELS_AVX
+    /** Two points per register. */
+    template <bool CheckFinite, typename Access> PCL_SIMD_TARGET_AVX static std::size_t
+    avx (const Access& point, std::size_t nr_points, const float* centroid, float* accu)
+    {
+      const __m128 c1 = _mm_setr_ps (centroid[0], centroid[1], centroid[2], 0.0f);
+      const __m256 c = combine (c1, c1);
+      __m256 s1 = _mm256_setzero_ps (), s2 = _mm256_setzero_ps ();
+      std::size_t count = 0, i = 0;
+      for (; i + 2 <= nr_points; i += 2)
+      {
+        point.prefetch (i);
+        point.prefetch (i + 1);
+        __m128 ma, mb;
+        const __m128 pa = loadPoint<CheckFinite> (point (i), ma, count);
+        const __m128 pb = loadPoint<CheckFinite> (point (i + 1), mb, count);
+        __m256 d = _mm256_sub_ps (combine (pa, pb), c);
+        if (CheckFinite)
+          d = _mm256_and_ps (d, combine (ma, mb));
+        __m256 m1, m2;
+        products (d, m1, m2);
+        s1 = _mm256_add_ps (s1, m1);
+        s2 = _mm256_add_ps (s2, m2);
+      }
+      float r[8];
+      _mm_storeu_ps (r, fold (s1)); _mm_storeu_ps (r + 4, fold (s2));
+      for (int k = 0; k < 6; ++k)
+        accu[k] += r[k];
+      if (i < nr_points)
+        count += sse2<CheckFinite> (point.advance (i), nr_points - i, centroid, accu);
+      return (CheckFinite ? count : nr_points);
+    }
+
+    /** Two points per register, laid out as (xa, ya, xb, yb) and (za, ., zb, .). */
+    template <bool CheckFinite, typename Access> PCL_SIMD_TARGET_AVX static std::size_t
+    avx (const Access& point, std::size_t nr_points, const double* centroid, double* accu)
+    {
+      const __m256d c_lo = _mm256_setr_pd (centroid[0], centroid[1], centroid[0], centroid[1]);
+      const __m256d c_hi = _mm256_setr_pd (centroid[2], 0.0, centroid[2], 0.0);
+      __m256d s1 = _mm256_setzero_pd (), s2 = _mm256_setzero_pd (), s3 = _mm256_setzero_pd ();
+      std::size_t count = 0, i = 0;
+      for (; i + 2 <= nr_points; i += 2)
+      {
+        point.prefetch (i);
+        point.prefetch (i + 1);
+        __m128 ma, mb;
+        const __m128 pa = loadPoint<CheckFinite> (point (i), ma, count);
+        const __m128 pb = loadPoint<CheckFinite> (point (i + 1), mb, count);
+        __m256d lo = _mm256_sub_pd (_mm256_cvtps_pd (_mm_movelh_ps (pa, pb)), c_lo);
+        __m256d hi = _mm256_sub_pd (_mm256_cvtps_pd (_mm_movehl_ps (pb, pa)), c_hi);
+        if (CheckFinite)
+        {
+          const __m256d mask = _mm256_castps_pd (combine (ma, mb));
+          lo = _mm256_and_pd (lo, mask);
+          hi = _mm256_and_pd (hi, mask);
+        }
+        s1 = _mm256_add_pd (s1, _mm256_mul_pd (_mm256_unpacklo_pd (lo, lo), lo));
+        s2 = _mm256_add_pd (s2, _mm256_mul_pd (lo, _mm256_shuffle_pd (hi, lo, 0xA)));
+        s3 = _mm256_add_pd (s3, _mm256_mul_pd (_mm256_shuffle_pd (lo, hi, 0x5), _mm256_unpacklo_pd (hi, hi)));
+      }
+      double r[6];
+      _mm_storeu_pd (r, fold (s1)); _mm_storeu_pd (r + 2, fold (s2)); _mm_storeu_pd (r + 4, fold (s3));
+      for (int k = 0; k < 6; ++k)
+        accu[k] += r[k];
+      if (i < nr_points)
+        count += sse2<CheckFinite> (point.advance (i), nr_points - i, centroid, accu);
+      return (CheckFinite ? count : nr_points);
+    }
+#endif // PCL_SIMD_KERNELS_AVX
+
+#ifdef PCL_SIMD_KERNELS_AVX512
+    /** Four points per register. */
+    template <bool CheckFinite, typename Access> PCL_SIMD_TARGET_AVX512 static std::size_t
+    avx512 (const Access& point, std::size_t nr_points, const float* centroid, float* accu)
+    {
+      const __m512 c = _mm512_broadcast_f32x4 (_mm_setr_ps (centroid[0], centroid[1], centroid[2], 0.0f));
+      __m512 s1 = _mm512_setzero_ps (), s2 = _mm512_setzero_ps ();
+      std::size_t count = 0, i = 0;
+      for (; i + 4 <= nr_points; i += 4)
+      {
+        __m128 p[4], mask[4];
+        for (std::size_t k = 0; k < 4; ++k)
+        {
+          point.prefetch (i + k);
+          p[k] = loadPoint<CheckFinite> (point (i + k), mask[k], count);
+        }
+        __m512 d = _mm512_sub_ps (combine (p[0], p[1], p[2], p[3]), c);
+        if (CheckFinite)
+          d = bitwiseAnd (d, combine (mask[0], mask[1], mask[2], mask[3]));
+        __m512 m1, m2;
+        products (d, m1, m2);
+        s1 = _mm512_add_ps (s1, m1);
+        s2 = _mm512_add_ps (s2, m2);
+      }
+      float r[8];
+      _mm_storeu_ps (r, fold (s1)); _mm_storeu_ps (r + 4, fold (s2));
+      for (int k = 0; k < 6; ++k)
+        accu[k] += r[k];
+      if (i < nr_points)
+        count += avx<CheckFinite> (point.advance (i), nr_points - i, centroid, accu);
+      return (CheckFinite ? count : nr_points);
+    }
+
+    /** Four points per register, laid out as in the AVX kernel. */
+    template <bool CheckFinite, typename Access> PCL_SIMD_TARGET_AVX512 static std::size_t
+    avx512 (const Access& point, std::size_t nr_points, const double* centroid, double* accu)
+    {
+      const __m512d c_lo = _mm512_broadcast_f64x4 (_mm256_setr_pd (centroid[0], centroid[1], centroid[0], centroid[1]));
+      const __m512d c_hi = _mm512_broadcast_f64x4 (_mm256_setr_pd (centroid[2], 0.0, centroid[2], 0.0));
+      __m512d s1 = _mm512_setzero_pd (), s2 = _mm512_setzero_pd (), s3 = _mm512_setzero_pd ();
+      std::size_t count = 0, i = 0;
+      for (; i + 4 <= nr_points; i += 4)
+      {
+        __m128 p[4], mask[4];
+        for (std::size_t k = 0; k < 4; ++k)
+        {
+          point.prefetch (i + k);
+          p[k] = loadPoint<CheckFinite> (point (i + k), mask[k], count);
+        }
+        __m512d lo = _mm512_sub_pd (_mm512_cvtps_pd (combine (_mm_movelh_ps (p[0], p[1]), _mm_movelh_ps (p[2], p[3]))), c_lo);
+        __m512d hi = _mm512_sub_pd (_mm512_cvtps_pd (combine (_mm_movehl_ps (p[1], p[0]), _mm_movehl_ps (p[3], p[2]))), c_hi);
+        if (CheckFinite)
+        {
+          const __m512d m = _mm512_castps_pd (combine (mask[0], mask[1], mask[2], mask[3]));
+          lo = bitwiseAnd (lo, m);
+          hi = bitwiseAnd (hi, m);
+        }
+        s1 = _mm512_add_pd (s1, _mm512_mul_pd (_mm512_unpacklo_pd (lo, lo), lo));
+        s2 = _mm512_add_pd (s2, _mm512_mul_pd (lo, _mm512_shuffle_pd (hi, lo, 0xAA)));
+        s3 = _mm512_add_pd (s3, _mm512_mul_pd (_mm512_shuffle_pd (lo, hi, 0x55), _mm512_unpacklo_pd (hi, hi)));
+      }
+      double r[6];
+      _mm_storeu_pd (r, fold (s1)); _mm_storeu_pd (r + 2, fold (s2)); _mm_storeu_pd (r + 4, fold (s3));
+      for (int k = 0; k < 6; ++k)
+        accu[k] += r[k];
+      if (i < nr_points)
+        count += avx<CheckFinite> (point.advance (i), nr_points - i, centroid, accu);
+      return (CheckFinite ? count : nr_points);
+    }
+#endif // PCL_SIMD_KERNELS_AVX512
+  };
+
+  /** Run the Kernels for the instruction set level given by pcl::getSIMDLevel (). */
+  template <typename Kernels, bool CheckFinite, typename Access, typename Scalar> std::size_t
+  dispatch (const Access& point, std::size_t nr_points, const Scalar* centroid, Scalar* accu)
+  {
+    const pcl::SIMDLevel level = pcl::getSIMDLevel ();
+#ifdef PCL_SIMD_KERNELS_AVX512
+    if (level >= pcl::SIMDLevel::AVX512)
+      return (Kernels::template avx512<CheckFinite> (point, nr_points, centroid, accu));
+#endif
+#ifdef PCL_SIMD_KERNELS_AVX
+    if (level >= pcl::SIMDLevel::AVX)
+      return (Kernels::template avx<CheckFinite> (point, nr_points, centroid, accu));
+#endif
+#ifdef PCL_CENTROID_SSE2_KERNELS
+    if (level >= pcl::SIMDLevel::SSE2)
+      return (Kernels::template sse2<CheckFinite> (point, nr_points, centroid, accu));
+#endif
+    (void) level;
+    return (Kernels::template generic<CheckFinite> (point, nr_points, centroid, accu));
+  }
+
+  template <typename Kernels, typename Scalar> std::size_t
+  accumulate (const float* src, std::size_t stride, const pcl::index_t* indices, std::size_t nr_points,
+              bool check_finite, const Scalar* centroid, Scalar* accu)
+  {
+    const auto* data = reinterpret_cast<const std::uint8_t*> (src);
+    if (indices)
+    {
+      const IndexedAccess point = {data, stride, indices, nr_points};
+      return (check_finite ? dispatch<Kernels, true> (point, nr_points, centroid, accu)
+                           : dispatch<Kernels, false> (point, nr_points, centroid, accu));
+    }
+    const DenseAccess point = {data, stride};
+    return (check_finite ? dispatch<Kernels, true> (point, nr_points, centroid, accu)
+                         : dispatch<Kernels, false> (point, nr_points, centroid, accu));
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+std::size_t
+pcl::detail::accumulateCovariance (const float* src, std::size_t stride, const index_t* indices,
+                                   std::size_t nr_points, bool check_finite, float accu[9])
+{
+  return (accumulate<RawSums, float> (src, stride, indices, nr_points, check_finite, nullptr, accu));
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+std::size_t
+pcl::detail::accumulateCovariance (const float* src, std::size_t stride, const index_t* indices,
+                                   std::size_t nr_points, bool check_finite, double accu[9])
+{
+  return (accumulate<RawSums, double> (src, stride, indices, nr_points, check_finite, nullptr, accu));
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+std::size_t
+pcl::detail::accumulateDemeanedCovariance (const float* src, std::size_t stride, const index_t* indices,
+                                           std::size_t nr_points, bool check_finite,
+                                           const float centroid[3], float accu[6])
+{
+  return (accumulate<DemeanedSums, float> (src, stride, indices, nr_points, check_finite, centroid, accu));
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+std::size_t
+pcl::detail::accumulateDemeanedCovariance (const float* src, std::size_t stride, const index_t* indices,
+                                           std::size_t nr_points, bool check_finite,
+                                           const double centroid[3], double accu[6])
+{
+  return (accumulate<DemeanedSums, double> (src, stride, indices, nr_points, check_finite, centroid, accu));
+}
@@ -37,9 +37,12 @@
  *
  */
 
+#include <algorithm>
+#include <cmath>
 #include <limits>
 
 #include <pcl/PCLPointCloud2.h> // for PCLPointCloud2
+#include <pcl/point_cloud_soa.h> // for PointCloudSoA
 #include <pcl/common/common.h>
 #include <pcl/console/print.h>
 
@@ -70,6 +73,51 @@ pcl::getMinMax (const pcl::PCLPointCloud2 &cloud, int,
   }
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////
+void
+pcl::getMinMax3D (const pcl::PointCloudSoA &cloud, Eigen::Vector4f &min_pt, Eigen::Vector4f &max_pt)
+{
+  min_pt.setConstant (std::numeric_limits<float>::max ());
+  max_pt.setConstant (-std::numeric_limits<float>::max ());
+
+  const float *x = cloud.getFieldData<float> ("x");
+  const float *y = cloud.getFieldData<float> ("y");
+  const float *z = cloud.getFieldData<float> ("z");
+  if (!x || !y || !z)
+  {
+    PCL_ERROR ("[pcl::getMinMax3D] Input dataset doesn't have FLOAT32 x-y-z columns!\n");
+    return;
+  }
+
+  float min_x = min_pt[0], min_y = min_pt[1], min_z = min_pt[2];
+  float max_x = max_pt[0], max_y = max_pt[1], max_z = max_pt[2];
+  // If the data is dense, we don't need to check for NaN
+  if (cloud.is_dense)
+  {
+    for (std::size_t i = 0; i < cloud.size (); ++i)
+    {
+      min_x = std::min (min_x, x[i]); max_x = std::max (max_x, x[i]);
+      min_y = std::min (min_y, y[i]); max_y = std::max (max_y, y[i]);
+      min_z = std::min (min_z, z[i]); max_z = std::max (max_z, z[i]);
+    }
+  }
+  // NaN or Inf values could exist => check for them
+  else
+  {
+    for (std::size_t i = 0; i < cloud.size (); ++i)
+    {
+      // Check if the point is invalid
+      if (!std::isfinite (x[i]) || !std::isfinite (y[i]) || !std::isfinite (z[i]))
+        continue;
+      min_x = std::min (min_x, x[i]); max_x = std::max (max_x, x[i]);
+      min_y = std::min (min_y, y[i]); max_y = std::max (max_y, y[i]);
+      min_z = std::min (min_z, z[i]); max_z = std::max (max_z, z[i]);
+    }
+  }
+  min_pt << min_x, min_y, min_z, 0.0f;
+  max_pt << max_x, max_y, max_z, 0.0f;
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////
 void
 pcl::getMeanStdDev (const std::vector<float> &values, double &mean, double &stddev)
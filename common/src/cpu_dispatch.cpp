@@ -0,0 +1,189 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include <pcl/common/cpu_dispatch.h>
+#include <pcl/console/print.h>
+
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#define PCL_CPU_DISPATCH_X86
+#elif (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#include <cpuid.h>
+#define PCL_CPU_DISPATCH_X86
+#endif
+
+namespace
+{
+#ifdef PCL_CPU_DISPATCH_X86
+  void
+  cpuid (unsigned int leaf, unsigned int subleaf, unsigned int regs[4])
+  {
+#ifdef _MSC_VER
+    int r[4];
+    __cpuidex (r, static_cast<int> (leaf), static_cast<int> (subleaf));
+    for (int i = 0; i < 4; ++i)
+      regs[i] = static_cast<unsigned int> (r[i]);
+#else
+    __cpuid_count (leaf, subleaf, regs[0], regs[1], regs[2], regs[3]);
+#endif
+  }
+
+  /** \brief Read XCR0, the register state the operating system saves on context switches. */
+  unsigned long long
+  xgetbv0 ()
+  {
+#ifdef _MSC_VER
+    return _xgetbv (0);
+#else
+    unsigned int eax, edx;
+    __asm__ volatile ("xgetbv" : "=a" (eax), "=d" (edx) : "c" (0));
+    return (static_cast<unsigned long long> (edx) << 32) | eax;
+#endif
+  }
+#endif
+
+  pcl::SIMDLevel
+  detectSIMDLevel ()
+  {
+    pcl::SIMDLevel level = pcl::SIMDLevel::NONE;
+#ifdef PCL_CPU_DISPATCH_X86
+    unsigned int regs[4];
+    cpuid (0, 0, regs);
+    const unsigned int max_leaf = regs[0];
+    if (max_leaf < 1)
+      return (level);
+
+    cpuid (1, 0, regs);
+    const bool sse2 = (regs[3] & (1u << 26)) != 0;
+    const bool fma = (regs[2] & (1u << 12)) != 0;
+    const bool osxsave = (regs[2] & (1u << 27)) != 0;
+    const bool avx = (regs[2] & (1u << 28)) != 0;
+    if (!sse2)
+      return (level);
+    level = pcl::SIMDLevel::SSE2;
+
+    // The ymm (and zmm) registers are only usable if the operating system saves them
+    const unsigned long long xcr0 = osxsave ? xgetbv0 () : 0;
+    if (!avx || (xcr0 & 0x6) != 0x6)
+      return (level);
+    level = pcl::SIMDLevel::AVX;
+
+    if (max_leaf < 7)
+      return (level);
+    cpuid (7, 0, regs);
+    const bool avx2 = (regs[1] & (1u << 5)) != 0;
+    const bool avx512f = (regs[1] & (1u << 16)) != 0;
+    if (!avx2 || !fma)
+      return (level);
+    level = pcl::SIMDLevel::AVX2;
+
+    if (avx512f && (xcr0 & 0xE6) == 0xE6)
+      level = pcl::SIMDLevel::AVX512;
+#endif
+    return (level);
+  }
+
+  /** \brief Parse the PCL_SIMD_LEVEL environment variable, which caps the detected level. */
+  pcl::SIMDLevel
+  initialSIMDLevel ()
+  {
+    const pcl::SIMDLevel supported = pcl::getSupportedSIMDLevel ();
+    const char* env = std::getenv ("PCL_SIMD_LEVEL");
+    if (!env || !*env)
+      return (supported);
+
+    for (int i = static_cast<int> (pcl::SIMDLevel::NONE); i <= static_cast<int> (pcl::SIMDLevel::AVX512); ++i)
+    {
+      const pcl::SIMDLevel level = static_cast<pcl::SIMDLevel> (i);
+      if (std::strcmp (env, pcl::getSIMDLevelName (level)) == 0)
+        return (level < supported ? level : supported);
+    }
+    PCL_WARN ("[pcl::getSIMDLevel] Unknown PCL_SIMD_LEVEL '%s', using %s.\n", env, pcl::getSIMDLevelName (supported));
+    return (supported);
+  }
+
+  std::atomic<int>&
+  currentSIMDLevel ()
+  {
+    static std::atomic<int> level (static_cast<int> (initialSIMDLevel ()));
+    return (level);
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+pcl::SIMDLevel
+pcl::getSupportedSIMDLevel ()
+{
+  static const SIMDLevel level = detectSIMDLevel ();
+  return (level);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+pcl::SIMDLevel
+pcl::getSIMDLevel ()
+{
+  return (static_cast<SIMDLevel> (currentSIMDLevel ().load (std::memory_order_relaxed)));
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+void
+pcl::setSIMDLevel (SIMDLevel level)
+{
+  const SIMDLevel supported = getSupportedSIMDLevel ();
+  if (level > supported)
+    level = supported;
+  currentSIMDLevel ().store (static_cast<int> (level), std::memory_order_relaxed);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+const char*
+pcl::getSIMDLevelName (SIMDLevel level)
+{
+  switch (level)
+  {
+    case SIMDLevel::NONE:   return ("none");
+    case SIMDLevel::SSE2:   return ("sse2");
+    case SIMDLevel::AVX:    return ("avx");
+    case SIMDLevel::AVX2:   return ("avx2");
+    case SIMDLevel::AVX512: return ("avx512");
+  }
+  return ("unknown");
+}
@@ -35,6 +35,7 @@
  *
  */
 #include <pcl/common/distances.h>
+#include <pcl/common/simd_lanes.h>
 
 void
 pcl::lineToLineSegment (const Eigen::VectorXf &line_a, const Eigen::VectorXf &line_b, 
@@ -89,3 +90,174 @@ pcl::lineToLineSegment (const Eigen::VectorXf &line_a, const Eigen::VectorXf &li
   pt2_seg = q1 + tc * v;
 }
 
+
+namespace
+{
+  using namespace pcl::detail::simd;
+
+  template <typename V> PCL_SIMD_INLINE float
+  sumLanes (V v)
+  {
+    float lanes[V::size];
+    v.store (lanes);
+    float sum = 0.0f;
+    for (const float lane : lanes)
+      sum += lane;
+    return (sum);
+  }
+
+  /** Squared L2 distance of the first elements of a and b, in steps of two registers; the
+    * remaining elements are left to the caller. */
+  template <typename V> PCL_SIMD_INLINE float
+  squaredL2Lanes (const float* a, const float* b, std::size_t dim, std::size_t& done)
+  {
+    V sum0 (0.0f), sum1 (0.0f);
+    std::size_t i = 0;
+    for (; i + 2 * V::size <= dim; i += 2 * V::size)
+    {
+      const V d0 = V::load (a + i) - V::load (b + i);
+      const V d1 = V::load (a + i + V::size) - V::load (b + i + V::size);
+      sum0 = sum0 + d0 * d0;
+      sum1 = sum1 + d1 * d1;
+    }
+    if (i + V::size <= dim)
+    {
+      const V d0 = V::load (a + i) - V::load (b + i);
+      sum0 = sum0 + d0 * d0;
+      i += V::size;
+    }
+    done = i;
+    return (sumLanes (sum0 + sum1));
+  }
+
+  /** Chi-square distance of the first elements of a and b, bins with a zero sum add nothing. */
+  template <typename V> PCL_SIMD_INLINE float
+  chiSquareLanes (const float* a, const float* b, std::size_t dim, std::size_t& done)
+  {
+    const V zero (0.0f);
+    V sum (0.0f);
+    std::size_t i = 0;
+    for (; i + V::size <= dim; i += V::size)
+    {
+      const V va = V::load (a + i), vb = V::load (b + i);
+      const V d = va - vb, s = va + vb;
+      sum = sum + select (maskNot (s == zero), d * d / s, zero);
+    }
+    done = i;
+    return (sumLanes (sum));
+  }
+
+#ifdef PCL_SIMD_KERNELS_SSE2
+  float
+  squaredL2SSE2 (const float* a, const float* b, std::size_t dim, std::size_t& done)
+  {
+    return (squaredL2Lanes<Lane4> (a, b, dim, done));
+  }
+
+  float
+  chiSquareSSE2 (const float* a, const float* b, std::size_t dim, std::size_t& done)
+  {
+    return (chiSquareLanes<Lane4> (a, b, dim, done));
+  }
+#endif
+
+#ifdef PCL_SIMD_KERNELS_AVX
+  PCL_SIMD_TARGET_AVX float
+  squaredL2AVX (const float* a, const float* b, std::size_t dim, std::size_t& done)
+  {
+    return (squaredL2Lanes<Lane8> (a, b, dim, done));
+  }
+
+  PCL_SIMD_TARGET_AVX float
+  chiSquareAVX (const float* a, const float* b, std::size_t dim, std::size_t& done)
+  {
+    return (chiSquareLanes<Lane8> (a, b, dim, done));
+  }
+#endif
+
+#ifdef PCL_SIMD_KERNELS_AVX512
+  PCL_SIMD_TARGET_AVX512 float
+  squaredL2AVX512 (const float* a, const float* b, std::size_t dim, std::size_t& done)
+  {
+    return (squaredL2Lanes<Lane16> (a, b, dim, done));
+  }
+
+  PCL_SIMD_TARGET_AVX512 float
+  chiSquareAVX512 (const float* a, const float* b, std::size_t dim, std::size_t& done)
+  {
+    return (chiSquareLanes<Lane16> (a, b, dim, done));
+  }
+#endif
+
+  using Kernel = float (*) (const float*, const float*, std::size_t, std::size_t&);
+
+  float
+  noKernel (const float*, const float*, std::size_t, std::size_t& done)
+  {
+    done = 0;
+    return (0.0f);
+  }
+
+  /** The widest kernel pcl::getSIMDLevel () allows for vectors of dim elements; short vectors
+    * that do not fill a register are left to the scalar loop. */
+  Kernel
+  selectKernel (bool chi_square, std::size_t dim)
+  {
+    const pcl::SIMDLevel level = pcl::getSIMDLevel ();
+#ifdef PCL_SIMD_KERNELS_AVX512
+    if (level >= pcl::SIMDLevel::AVX512 && dim >= 16)
+      return (chi_square ? chiSquareAVX512 : squaredL2AVX512);
+#endif
+#ifdef PCL_SIMD_KERNELS_AVX
+    if (level >= pcl::SIMDLevel::AVX && dim >= 8)
+      return (chi_square ? chiSquareAVX : squaredL2AVX);
+#endif
+#ifdef PCL_SIMD_KERNELS_SSE2
+    if (level >= pcl::SIMDLevel::SSE2 && dim >= 4)
+      return (chi_square ? chiSquareSSE2 : squaredL2SSE2);
+#endif
+    (void) level;
+    (void) chi_square;
+    (void) dim;
+    return (noKernel);
+  }
+
+  inline float
+  squaredL2 (Kernel kernel, const float* a, const float* b, std::size_t dim)
+  {
+    std::size_t done;
+    float sum = kernel (a, b, dim, done);
+    for (std::size_t i = done; i < dim; ++i)
+      sum += (a[i] - b[i]) * (a[i] - b[i]);
+    return (sum);
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+float
+pcl::squaredL2Distance (const float* a, const float* b, std::size_t dim)
+{
+  return (squaredL2 (selectKernel (false, dim), a, b, dim));
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+float
+pcl::chiSquareDistance (const float* a, const float* b, std::size_t dim)
+{
+  std::size_t done;
+  float sum = selectKernel (true, dim) (a, b, dim, done);
+  for (std::size_t i = done; i < dim; ++i)
+    if ((a[i] + b[i]) != 0)
+      sum += (a[i] - b[i]) * (a[i] - b[i]) / (a[i] + b[i]);
+  return (sum);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+void
+pcl::squaredL2Distances (const float* query, const float* rows, std::size_t nr_rows,
+                         std::size_t stride, std::size_t dim, float* distances)
+{
+  const Kernel kernel = selectKernel (false, dim);
+  for (std::size_t row = 0; row < nr_rows; ++row)
+    distances[row] = squaredL2 (kernel, query, rows + row * stride, dim);
+}
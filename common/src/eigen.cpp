@@ -0,0 +1,198 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include <pcl/common/eigen.h>
+#include <pcl/common/simd_lanes.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+// eigen33Batch runs the algorithm of eigen33 (mat, eigenvalue, eigenvector) on vectors of
+// matrices, with every branch turned into a per lane selection (see pcl/common/simd_lanes.h).
+
+namespace
+{
+  using namespace pcl::detail::simd;
+
+  template <typename T>
+  struct Batch
+  {
+    const T *xx, *xy, *xz, *yy, *yz, *zz;
+    T *eigenvalues, *x, *y, *z;
+  };
+
+  /** Solve the matrices i to i + V::size - 1, see eigen33 (mat, eigenvalue, eigenvector). */
+  template <typename V> PCL_SIMD_INLINE void
+  solve (const Batch<typename V::Scalar>& batch, std::size_t i)
+  {
+    using Scalar = typename V::Scalar;
+    V m00 = V::load (batch.xx + i), m01 = V::load (batch.xy + i), m02 = V::load (batch.xz + i);
+    V m11 = V::load (batch.yy + i), m12 = V::load (batch.yz + i), m22 = V::load (batch.zz + i);
+
+    // Scale the matrix so its entries are in [-1,1]
+    V scale = max (max (max (abs (m00), abs (m01)), max (abs (m02), abs (m11))), max (abs (m12), abs (m22)));
+    scale = select (scale <= V (std::numeric_limits<Scalar>::min ()), V (Scalar (1)), scale);
+    m00 = m00 / scale; m01 = m01 / scale; m02 = m02 / scale;
+    m11 = m11 / scale; m12 = m12 / scale; m22 = m22 / scale;
+
+    // Smallest root of the characteristic equation x^3 - c2*x^2 + c1*x - c0 = 0, see computeRoots
+    const V two (Scalar (2));
+    const V c0 = m00 * m11 * m22 + two * m01 * m02 * m12 - m00 * m12 * m12 - m11 * m02 * m02 - m22 * m01 * m01;
+    const V c1 = m00 * m11 - m01 * m01 + m00 * m22 - m02 * m02 + m11 * m22 - m12 * m12;
+    const V c2 = m00 + m11 + m22;
+
+    const V s_inv3 (Scalar (1.0 / 3.0));
+    const V s_sqrt3 (std::sqrt (Scalar (3.0)));
+    const V c2_over_3 = c2 * s_inv3;
+    const V a_over_3 = min ((c1 - c2 * c2_over_3) * s_inv3, V (Scalar (0)));
+    const V half_b = V (Scalar (0.5)) * (c0 + c2_over_3 * (two * c2_over_3 * c2_over_3 - c1));
+    const V q = min (half_b * half_b + a_over_3 * a_over_3 * a_over_3, V (Scalar (0)));
+
+    const V rho = sqrt (V (Scalar (0)) - a_over_3);
+    const V theta = atan2 (sqrt (V (Scalar (0)) - q), half_b) * s_inv3;
+    V sin_theta, cos_theta;
+    sincos (theta, sin_theta, cos_theta);
+    const V root0 = c2_over_3 + two * rho * cos_theta;
+    const V root1 = c2_over_3 - rho * (cos_theta + s_sqrt3 * sin_theta);
+    const V root2 = c2_over_3 - rho * (cos_theta - s_sqrt3 * sin_theta);
+    V eigenvalue = min (min (root0, root1), root2);
+    // One root is 0 (the equation is quadratic), or the smallest root is not positive: use 0
+    eigenvalue = select (maskOr (abs (c0) < V (Eigen::NumTraits<Scalar>::epsilon ()), eigenvalue <= V (Scalar (0))),
+                         V (Scalar (0)), eigenvalue);
+    (eigenvalue * scale).store (batch.eigenvalues + i);
+
+    // The eigenvector is the longest cross product of two rows of the shifted matrix
+    const V a = m00 - eigenvalue, d = m11 - eigenvalue, f = m22 - eigenvalue;
+    const V b = m01, c = m02, e = m12;
+    const V v1x = b * e - c * d, v1y = c * b - a * e, v1z = a * d - b * b;
+    const V v2x = b * f - c * e, v2y = c * c - a * f, v2z = a * e - b * c;
+    const V v3x = d * f - e * e, v3y = e * c - b * f, v3z = b * e - d * c;
+    const V len1 = v1x * v1x + v1y * v1y + v1z * v1z;
+    const V len2 = v2x * v2x + v2y * v2y + v2z * v2z;
+    const V len3 = v3x * v3x + v3y * v3y + v3z * v3z;
+
+    const auto use1 = maskAnd (len1 >= len2, len1 >= len3);
+    const auto use2 = maskAnd (maskNot (use1), len2 >= len3);
+    const V length = sqrt (select (use1, len1, select (use2, len2, len3)));
+    (select (use1, v1x, select (use2, v2x, v3x)) / length).store (batch.x + i);
+    (select (use1, v1y, select (use2, v2y, v3y)) / length).store (batch.y + i);
+    (select (use1, v1z, select (use2, v2z, v3z)) / length).store (batch.z + i);
+  }
+
+  /** Solve all matrices of the batch, V::size at a time, then the remaining ones through a padded copy. */
+  template <typename V> PCL_SIMD_INLINE void
+  solveAll (const Batch<typename V::Scalar>& batch, std::size_t count)
+  {
+    using Scalar = typename V::Scalar;
+    std::size_t i = 0;
+    for (; i + V::size <= count; i += V::size)
+      solve<V> (batch, i);
+    if (i == count)
+      return;
+
+    Scalar in[6][V::size], out[4][V::size];
+    const Scalar* src[6] = {batch.xx, batch.xy, batch.xz, batch.yy, batch.yz, batch.zz};
+    Scalar* tgt[4] = {batch.eigenvalues, batch.x, batch.y, batch.z};
+    for (int k = 0; k < 6; ++k)
+    {
+      // Pad with identity matrices
+      std::fill (in[k], in[k] + V::size, (k == 0 || k == 3 || k == 5) ? Scalar (1) : Scalar (0));
+      std::copy (src[k] + i, src[k] + count, in[k]);
+    }
+    const Batch<Scalar> padded = {in[0], in[1], in[2], in[3], in[4], in[5], out[0], out[1], out[2], out[3]};
+    solve<V> (padded, 0);
+    for (int k = 0; k < 4; ++k)
+      std::copy (out[k], out[k] + (count - i), tgt[k] + i);
+  }
+
+#ifdef PCL_SIMD_KERNELS_SSE2
+  void
+  solveSSE2 (const Batch<float>& batch, std::size_t count)
+  {
+    solveAll<Lane4> (batch, count);
+  }
+#endif
+
+#ifdef PCL_SIMD_KERNELS_AVX
+  PCL_SIMD_TARGET_AVX void
+  solveAVX (const Batch<float>& batch, std::size_t count)
+  {
+    solveAll<Lane8> (batch, count);
+  }
+#endif
+
+#ifdef PCL_SIMD_KERNELS_AVX512
+  PCL_SIMD_TARGET_AVX512 void
+  solveAVX512 (const Batch<float>& batch, std::size_t count)
+  {
+    solveAll<Lane16> (batch, count);
+  }
+#endif
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+void
+pcl::eigen33Batch (const float* xx, const float* xy, const float* xz, const float* yy, const float* yz, const float* zz,
+                   std::size_t count, float* eigenvalues, float* x, float* y, float* z)
+{
+  const Batch<float> batch = {xx, xy, xz, yy, yz, zz, eigenvalues, x, y, z};
+  const SIMDLevel level = getSIMDLevel ();
+#ifdef PCL_SIMD_KERNELS_AVX512
+  if (level >= SIMDLevel::AVX512)
+    return (solveAVX512 (batch, count));
+#endif
+#ifdef PCL_SIMD_KERNELS_AVX
+  if (level >= SIMDLevel::AVX)
+    return (solveAVX (batch, count));
+#endif
+#ifdef PCL_SIMD_KERNELS_SSE2
+  if (level >= SIMDLevel::SSE2)
+    return (solveSSE2 (batch, count));
+#endif
+  (void) level;
+  solveAll<Lane<float> > (batch, count);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+void
+pcl::eigen33Batch (const double* xx, const double* xy, const double* xz, const double* yy, const double* yz, const double* zz,
+                   std::size_t count, double* eigenvalues, double* x, double* y, double* z)
+{
+  const Batch<double> batch = {xx, xy, xz, yy, yz, zz, eigenvalues, x, y, z};
+  solveAll<Lane<double> > (batch, count);
+}
@@ -0,0 +1,127 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2019-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <pcl/common/execution_context.h>
+
+#include <algorithm>
+#include <atomic>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace
+{
+  /** \brief The budget, 0 for the number of processors. */
+  std::atomic<unsigned int> thread_budget (0);
+
+  std::atomic<unsigned int> reserved_threads (0);
+
+  /** \brief Number of threads of the outermost reservation of the calling thread, 0 if none. */
+  thread_local unsigned int thread_grant = 0;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+unsigned int
+pcl::ExecutionContext::getHardwareConcurrency () noexcept
+{
+#ifdef _OPENMP
+  return (static_cast<unsigned int> (std::max (omp_get_num_procs (), 1)));
+#else
+  return (1);
+#endif
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+unsigned int
+pcl::ExecutionContext::getThreadBudget () noexcept
+{
+  const unsigned int budget = thread_budget.load ();
+  return (budget == 0 ? getHardwareConcurrency () : budget);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+void
+pcl::ExecutionContext::setThreadBudget (unsigned int budget) noexcept
+{
+  thread_budget.store (budget);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+unsigned int
+pcl::ExecutionContext::getNumberOfReservedThreads () noexcept
+{
+  return (reserved_threads.load ());
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+pcl::ThreadReservation::ThreadReservation (unsigned int nr_threads)
+  : nr_threads_ (1)
+  , reserved_ (0)
+{
+#ifdef _OPENMP
+  // The threads of a nested region belong to the reservation of the enclosing one
+  if (omp_in_parallel ())
+    return;
+#endif
+  // Algorithms called by an algorithm share the threads of the outermost reservation
+  if (thread_grant > 0)
+  {
+    nr_threads_ = (nr_threads == 0 ? thread_grant : std::min (nr_threads, thread_grant));
+    return;
+  }
+  const unsigned int budget = ExecutionContext::getThreadBudget ();
+  const unsigned int wanted = (nr_threads == 0 ? budget : std::min (nr_threads, budget));
+  unsigned int reserved = reserved_threads.load ();
+  unsigned int granted;
+  do
+  {
+    // The calling thread runs in any case, even if the budget is used up
+    granted = std::max (std::min (wanted, budget > reserved ? budget - reserved : 0u), 1u);
+  }
+  while (!reserved_threads.compare_exchange_weak (reserved, reserved + granted));
+  nr_threads_ = reserved_ = thread_grant = granted;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+pcl::ThreadReservation::~ThreadReservation ()
+{
+  if (reserved_ > 0)
+  {
+    reserved_threads.fetch_sub (reserved_);
+    thread_grant = 0;
+  }
+}
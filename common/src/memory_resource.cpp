@@ -0,0 +1,212 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2019-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <pcl/memory_resource.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+
+namespace
+{
+  class NewDeleteResource : public pcl::MemoryResource
+  {
+    protected:
+      void*
+      doAllocate (std::size_t bytes, std::size_t alignment) override
+      {
+        if (alignment <= EIGEN_MAX_ALIGN_BYTES)
+        {
+          void* p = Eigen::internal::aligned_malloc (bytes);
+          if (!p && bytes)
+            throw std::bad_alloc ();
+          return (p);
+        }
+        // Over-aligned types: keep the original pointer right before the aligned block
+        void* original = ::operator new (bytes + alignment + sizeof (void*));
+        const std::uintptr_t address = reinterpret_cast<std::uintptr_t> (original) + sizeof (void*);
+        void* aligned = reinterpret_cast<void*> ((address + alignment - 1) & ~(alignment - 1));
+        *(static_cast<void**> (aligned) - 1) = original;
+        return (aligned);
+      }
+
+      void
+      doDeallocate (void* p, std::size_t, std::size_t alignment) override
+      {
+        if (alignment <= EIGEN_MAX_ALIGN_BYTES)
+          Eigen::internal::aligned_free (p);
+        else if (p)
+          ::operator delete (*(static_cast<void**> (p) - 1));
+      }
+
+      bool
+      doIsEqual (const pcl::MemoryResource& other) const noexcept override
+      {
+        return (dynamic_cast<const NewDeleteResource*> (&other) != nullptr);
+      }
+  };
+
+  std::atomic<pcl::MemoryResource*>&
+  defaultResource ()
+  {
+    static std::atomic<pcl::MemoryResource*> resource (pcl::getNewDeleteResource ());
+    return (resource);
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+pcl::MemoryResource*
+pcl::getNewDeleteResource () noexcept
+{
+  static NewDeleteResource resource;
+  return (&resource);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+pcl::MemoryResource*
+pcl::getDefaultResource () noexcept
+{
+  return (defaultResource ().load ());
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+pcl::MemoryResource*
+pcl::setDefaultResource (MemoryResource* resource) noexcept
+{
+  return (defaultResource ().exchange (resource ? resource : getNewDeleteResource ()));
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+pcl::MonotonicBufferResource::MonotonicBufferResource (std::size_t initial_size,
+                                                      MemoryResource* upstream)
+  : next_size_ (std::max<std::size_t> (initial_size, 64))
+  , upstream_ (upstream ? upstream : getDefaultResource ())
+{
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+pcl::MonotonicBufferResource::~MonotonicBufferResource ()
+{
+  for (const Block& block : blocks_)
+    upstream_->deallocate (block.data, block.size, alignof (std::max_align_t));
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+void
+pcl::MonotonicBufferResource::release ()
+{
+  if (blocks_.empty ())
+    return;
+
+  // Keep the largest block, which is the last one as the sizes grow
+  for (std::size_t i = 0; i + 1 < blocks_.size (); ++i)
+    upstream_->deallocate (blocks_[i].data, blocks_[i].size, alignof (std::max_align_t));
+  blocks_.erase (blocks_.begin (), blocks_.end () - 1);
+  current_ = static_cast<char*> (blocks_.back ().data);
+  end_ = current_ + blocks_.back ().size;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+void*
+pcl::MonotonicBufferResource::doAllocate (std::size_t bytes, std::size_t alignment)
+{
+  const auto align_up = [alignment] (char* p)
+  {
+    const std::uintptr_t address = reinterpret_cast<std::uintptr_t> (p);
+    return (reinterpret_cast<char*> ((address + alignment - 1) & ~(alignment - 1)));
+  };
+
+  char* p = current_ ? align_up (current_) : nullptr;
+  if (!p || p > end_ || static_cast<std::size_t> (end_ - p) < bytes)
+  {
+    // Start a new block that is large enough for this request
+    const std::size_t block_size = std::max (next_size_, bytes + alignment);
+    void* data = upstream_->allocate (block_size, alignof (std::max_align_t));
+    blocks_.push_back ({data, block_size});
+    next_size_ = block_size * 2;
+    current_ = static_cast<char*> (data);
+    end_ = current_ + block_size;
+    p = align_up (current_);
+  }
+  current_ = p + bytes;
+  return (p);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+pcl::CountingResource::CountingResource (MemoryResource* upstream, std::size_t limit)
+  : limit_ (limit)
+  , upstream_ (upstream ? upstream : getDefaultResource ())
+{
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+void*
+pcl::CountingResource::doAllocate (std::size_t bytes, std::size_t alignment)
+{
+  // Reserve the bytes first, so concurrent allocations cannot overshoot the limit together
+  const std::size_t current = current_bytes_.fetch_add (bytes) + bytes;
+  const std::size_t limit = limit_.load ();
+  if (limit > 0 && current > limit)
+  {
+    current_bytes_.fetch_sub (bytes);
+    throw std::bad_alloc ();
+  }
+
+  void* p;
+  try
+  {
+    p = upstream_->allocate (bytes, alignment);
+  }
+  catch (...)
+  {
+    current_bytes_.fetch_sub (bytes);
+    throw;
+  }
+
+  ++nr_allocations_;
+  std::size_t peak = peak_bytes_.load ();
+  while (current > peak && !peak_bytes_.compare_exchange_weak (peak, current))
+  {}
+  return (p);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+void
+pcl::CountingResource::doDeallocate (void* p, std::size_t bytes, std::size_t alignment)
+{
+  upstream_->deallocate (p, bytes, alignment);
+  current_bytes_.fetch_sub (bytes);
+}
@@ -40,6 +40,7 @@
 #include <numeric>
 
 #include <pcl/impl/pcl_base.hpp>
+#include <pcl/common/trace.h>
 
 ///////////////////////////////////////////////////////////////////////////////////////////
 pcl::PCLBase<pcl::PCLPointCloud2>::PCLBase ()
@@ -114,6 +115,8 @@ pcl::PCLBase<pcl::PCLPointCloud2>::deinitCompute ()
 bool
 pcl::PCLBase<pcl::PCLPointCloud2>::initCompute ()
 {
+  PCL_TRACE_ZONE ("PCLBase::initCompute");
+
   // Check if input was set
   if (!input_)
     return (false);
@@ -0,0 +1,183 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include <pcl/point_cloud_soa.h>
+#include <pcl/PCLPointCloud2.h>
+#include <pcl/common/io.h> // for getFieldSize
+
+#include <algorithm>
+
+///////////////////////////////////////////////////////////////////////////////////////////
+void
+pcl::PointCloudSoA::resize (std::size_t count)
+{
+  for (std::size_t d = 0; d < columns_.size (); ++d)
+    columns_[d].resize (count * element_sizes_[d]);
+  size_ = count;
+  width = static_cast<uindex_t> (count);
+  height = 1;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+void
+pcl::PointCloudSoA::resize (uindex_t new_width, uindex_t new_height)
+{
+  resize (static_cast<std::size_t> (new_width) * new_height);
+  width = new_width;
+  height = new_height;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+void
+pcl::PointCloudSoA::clear ()
+{
+  resize (0);
+  width = height = 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+int
+pcl::PointCloudSoA::addField (const std::string &name, std::uint8_t datatype, uindex_t count)
+{
+  const int existing = getFieldIndex (name);
+  if (existing != -1)
+  {
+    const pcl::PCLPointField &field = fields_[existing];
+    if (field.datatype == datatype && std::max<uindex_t> (field.count, 1) == std::max<uindex_t> (count, 1))
+      return (existing);
+    PCL_ERROR ("[pcl::PointCloudSoA::addField] A different field named '%s' already exists!\n", name.c_str ());
+    return (-1);
+  }
+
+  const std::size_t element_size = static_cast<std::size_t> (pcl::getFieldSize (datatype)) * std::max<uindex_t> (count, 1);
+  if (element_size == 0)
+  {
+    PCL_ERROR ("[pcl::PointCloudSoA::addField] Invalid datatype %d for field '%s'!\n", datatype, name.c_str ());
+    return (-1);
+  }
+
+  pcl::PCLPointField field;
+  field.name = name;
+  field.offset = 0;
+  field.datatype = datatype;
+  field.count = count;
+  fields_.push_back (field);
+  element_sizes_.push_back (element_size);
+  columns_.emplace_back (size_ * element_size, 0);
+  return (static_cast<int> (fields_.size ()) - 1);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+int
+pcl::PointCloudSoA::getFieldIndex (const std::string &name) const
+{
+  for (std::size_t d = 0; d < fields_.size (); ++d)
+    if (fields_[d].name == name)
+      return (static_cast<int> (d));
+  return (-1);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+void
+pcl::toPointCloudSoA (const pcl::PCLPointCloud2 &msg, PointCloudSoA &soa)
+{
+  soa = PointCloudSoA ();
+  soa.header = msg.header;
+  soa.resize (msg.width, msg.height);
+  soa.is_dense = (msg.is_dense == 1);
+
+  const std::size_t nr_points = soa.size ();
+  if (msg.data.size () < nr_points * msg.point_step)
+  {
+    PCL_ERROR ("[pcl::toPointCloudSoA] The data blob holds %zu bytes, but %zu points of %u bytes are expected!\n",
+               msg.data.size (), nr_points, msg.point_step);
+    soa.clear ();
+    return;
+  }
+
+  for (const auto &field : msg.fields)
+  {
+    if (field.name == "_")
+      continue;
+    const int idx = soa.addField (field.name, field.datatype, field.count);
+    if (idx == -1)
+      continue;
+    const std::size_t element_size = soa.getElementSize (idx);
+    if (field.offset + element_size > msg.point_step)
+    {
+      PCL_ERROR ("[pcl::toPointCloudSoA] Field '%s' does not fit in a point of %u bytes!\n",
+                 field.name.c_str (), msg.point_step);
+      continue;
+    }
+    std::uint8_t* column = soa.getFieldData (idx);
+    const std::uint8_t* src = msg.data.data () + field.offset;
+    for (std::size_t i = 0; i < nr_points; ++i, src += msg.point_step)
+      memcpy (column + i * element_size, src, element_size);
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+void
+pcl::fromPointCloudSoA (const PointCloudSoA &soa, pcl::PCLPointCloud2 &msg)
+{
+  msg.header = soa.header;
+  msg.width = soa.width;
+  msg.height = soa.height;
+  msg.is_dense = soa.is_dense;
+  msg.is_bigendian = BOOST_ENDIAN_BIG_BYTE;
+
+  msg.fields = soa.getFields ();
+  uindex_t point_step = 0;
+  for (std::size_t d = 0; d < msg.fields.size (); ++d)
+  {
+    msg.fields[d].offset = point_step;
+    point_step += static_cast<uindex_t> (soa.getElementSize (static_cast<int> (d)));
+  }
+  msg.point_step = point_step;
+  msg.row_step = point_step * msg.width;
+
+  const std::size_t nr_points = soa.size ();
+  msg.data.resize (nr_points * point_step);
+  for (std::size_t d = 0; d < msg.fields.size (); ++d)
+  {
+    const std::size_t element_size = soa.getElementSize (static_cast<int> (d));
+    const std::uint8_t* column = soa.getFieldData (static_cast<int> (d));
+    std::uint8_t* dst = msg.data.data () + msg.fields[d].offset;
+    for (std::size_t i = 0; i < nr_points; ++i, dst += point_step)
+      memcpy (dst, column + i * element_size, element_size);
+  }
+}
@@ -0,0 +1,507 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include <pcl/common/point_quantization.h>
+#include <pcl/common/point_tests.h> // for isFinite
+#include <pcl/common/simd_lanes.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+// The decoders gather blocks of points into one array per field, convert every array with a
+// SIMD kernel and scatter the results into the output points.
+//
+// Half precision values are converted with integer operations, which need no F16C: the
+// exponent and mantissa bits are shifted into place and the float is rescaled by 2^112, which
+// rebiases the exponent of normal values and normalizes the subnormal ones. Infinity and NaN
+// get the float exponent of all ones instead.
+
+namespace
+{
+  using namespace pcl::detail::simd;
+
+  constexpr std::int16_t invalid_q16 = std::numeric_limits<std::int16_t>::min ();
+  constexpr float oct_scale = 32767.0f;
+  constexpr std::size_t block_size = 256;
+  // 2^112, the difference of the float and half exponent biases
+  constexpr float rebias = 5.192296858534827628530496329220096e33f;
+
+  inline std::uint32_t
+  toBits (float value)
+  {
+    std::uint32_t bits;
+    std::memcpy (&bits, &value, sizeof (bits));
+    return (bits);
+  }
+
+  inline float
+  fromBits (std::uint32_t bits)
+  {
+    float value;
+    std::memcpy (&value, &bits, sizeof (value));
+    return (value);
+  }
+
+  /** Convert count quantized values to (value * scale + offset), invalid_q16 to NaN. */
+  inline void
+  convertQ16Scalar (const std::int16_t* input, std::size_t count, float scale, float offset, float* output)
+  {
+    for (std::size_t i = 0; i < count; ++i)
+      output[i] = (input[i] == invalid_q16) ? std::numeric_limits<float>::quiet_NaN ()
+                                            : static_cast<float> (input[i]) * scale + offset;
+  }
+
+#ifdef PCL_SIMD_KERNELS_SSE2
+  /** Convert four half precision values, zero extended to 32 bits. */
+  inline __m128
+  halfToFloat4 (__m128i h)
+  {
+    const __m128i sign = _mm_slli_epi32 (_mm_and_si128 (h, _mm_set1_epi32 (0x8000)), 16);
+    const __m128i shifted = _mm_slli_epi32 (_mm_and_si128 (h, _mm_set1_epi32 (0x7fff)), 13);
+    const __m128i scaled = _mm_castps_si128 (_mm_mul_ps (_mm_castsi128_ps (shifted), _mm_set1_ps (rebias)));
+    const __m128i inf_nan = _mm_cmpgt_epi32 (shifted, _mm_set1_epi32 (0x7bff << 13));
+    const __m128i special = _mm_or_si128 (shifted, _mm_set1_epi32 (0x7f800000));
+    const __m128i bits = _mm_or_si128 (_mm_andnot_si128 (inf_nan, scaled), _mm_and_si128 (inf_nan, special));
+    return (_mm_castsi128_ps (_mm_or_si128 (bits, sign)));
+  }
+
+  std::size_t
+  halfToFloatSSE2 (const std::uint16_t* input, std::size_t count, float* output)
+  {
+    std::size_t i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+      const __m128i h = _mm_loadl_epi64 (reinterpret_cast<const __m128i*> (input + i));
+      _mm_storeu_ps (output + i, halfToFloat4 (_mm_unpacklo_epi16 (h, _mm_setzero_si128 ())));
+    }
+    return (i);
+  }
+
+  std::size_t
+  convertQ16SSE2 (const std::int16_t* input, std::size_t count, float scale, float offset, float* output)
+  {
+    const __m128 nan = _mm_set1_ps (std::numeric_limits<float>::quiet_NaN ());
+    std::size_t i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+      const __m128i q16 = _mm_loadl_epi64 (reinterpret_cast<const __m128i*> (input + i));
+      // Sign extend to 32 bits
+      const __m128i q = _mm_srai_epi32 (_mm_unpacklo_epi16 (_mm_setzero_si128 (), q16), 16);
+      const __m128 value = _mm_add_ps (_mm_mul_ps (_mm_cvtepi32_ps (q), _mm_set1_ps (scale)), _mm_set1_ps (offset));
+      const __m128 invalid = _mm_castsi128_ps (_mm_cmpeq_epi32 (q, _mm_set1_epi32 (invalid_q16)));
+      _mm_storeu_ps (output + i, _mm_or_ps (_mm_andnot_ps (invalid, value), _mm_and_ps (invalid, nan)));
+    }
+    return (i);
+  }
+#endif // PCL_SIMD_KERNELS_SSE2
+
+#ifdef PCL_SIMD_KERNELS_AVX2
+  PCL_SIMD_TARGET_AVX2 std::size_t
+  halfToFloatAVX2 (const std::uint16_t* input, std::size_t count, float* output)
+  {
+    std::size_t i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+      const __m256i h = _mm256_cvtepu16_epi32 (_mm_loadu_si128 (reinterpret_cast<const __m128i*> (input + i)));
+      const __m256i sign = _mm256_slli_epi32 (_mm256_and_si256 (h, _mm256_set1_epi32 (0x8000)), 16);
+      const __m256i shifted = _mm256_slli_epi32 (_mm256_and_si256 (h, _mm256_set1_epi32 (0x7fff)), 13);
+      const __m256i scaled = _mm256_castps_si256 (_mm256_mul_ps (_mm256_castsi256_ps (shifted), _mm256_set1_ps (rebias)));
+      const __m256i inf_nan = _mm256_cmpgt_epi32 (shifted, _mm256_set1_epi32 (0x7bff << 13));
+      const __m256i special = _mm256_or_si256 (shifted, _mm256_set1_epi32 (0x7f800000));
+      const __m256i bits = _mm256_blendv_epi8 (scaled, special, inf_nan);
+      _mm256_storeu_ps (output + i, _mm256_castsi256_ps (_mm256_or_si256 (bits, sign)));
+    }
+    return (i);
+  }
+
+  PCL_SIMD_TARGET_AVX2 std::size_t
+  convertQ16AVX2 (const std::int16_t* input, std::size_t count, float scale, float offset, float* output)
+  {
+    const __m256 nan = _mm256_set1_ps (std::numeric_limits<float>::quiet_NaN ());
+    std::size_t i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+      const __m256i q = _mm256_cvtepi16_epi32 (_mm_loadu_si128 (reinterpret_cast<const __m128i*> (input + i)));
+      const __m256 value = _mm256_fmadd_ps (_mm256_cvtepi32_ps (q), _mm256_set1_ps (scale), _mm256_set1_ps (offset));
+      const __m256 invalid = _mm256_castsi256_ps (_mm256_cmpeq_epi32 (q, _mm256_set1_epi32 (invalid_q16)));
+      _mm256_storeu_ps (output + i, _mm256_blendv_ps (value, nan, invalid));
+    }
+    return (i);
+  }
+#endif // PCL_SIMD_KERNELS_AVX2
+
+  /** Convert count half precision values, using the widest kernel pcl::getSIMDLevel () allows. */
+  void
+  convertHalf (const std::uint16_t* input, std::size_t count, float* output)
+  {
+    std::size_t done = 0;
+    const pcl::SIMDLevel level = pcl::getSIMDLevel ();
+#ifdef PCL_SIMD_KERNELS_AVX2
+    if (level >= pcl::SIMDLevel::AVX2)
+      done = halfToFloatAVX2 (input, count, output);
+#endif
+#ifdef PCL_SIMD_KERNELS_SSE2
+    if (level >= pcl::SIMDLevel::SSE2)
+      done += halfToFloatSSE2 (input + done, count - done, output + done);
+#endif
+    (void) level;
+    for (std::size_t i = done; i < count; ++i)
+      output[i] = pcl::halfToFloat (input[i]);
+  }
+
+  /** Convert count quantized values to (value * scale + offset), invalid ones to NaN. */
+  void
+  convertQ16 (const std::int16_t* input, std::size_t count, float scale, float offset, float* output)
+  {
+    std::size_t done = 0;
+    const pcl::SIMDLevel level = pcl::getSIMDLevel ();
+#ifdef PCL_SIMD_KERNELS_AVX2
+    if (level >= pcl::SIMDLevel::AVX2)
+      done = convertQ16AVX2 (input, count, scale, offset, output);
+#endif
+#ifdef PCL_SIMD_KERNELS_SSE2
+    if (level >= pcl::SIMDLevel::SSE2)
+      done += convertQ16SSE2 (input + done, count - done, scale, offset, output + done);
+#endif
+    (void) level;
+    convertQ16Scalar (input + done, count - done, scale, offset, output + done);
+  }
+
+  /** Unfold the octahedral coordinates i to i + V::size - 1 into unit normals. */
+  template <typename V> PCL_SIMD_INLINE void
+  decodeOctahedral (const float* u, const float* v, std::size_t i, float* nx, float* ny, float* nz)
+  {
+    const V zero (0.0f);
+    const V x0 = V::load (u + i);
+    const V y0 = V::load (v + i);
+    const V z = V (1.0f) - abs (x0) - abs (y0);
+    // Points of the lower hemisphere were folded over the diagonals, move them back
+    const V t = max (zero - z, zero);
+    const V x = x0 + select (x0 >= zero, zero - t, t);
+    const V y = y0 + select (y0 >= zero, zero - t, t);
+    const V length = sqrt (x * x + y * y + z * z);
+    (x / length).store (nx + i);
+    (y / length).store (ny + i);
+    (z / length).store (nz + i);
+  }
+
+  template <typename V> PCL_SIMD_INLINE void
+  decodeOctahedralAll (const float* u, const float* v, std::size_t count, float* nx, float* ny, float* nz)
+  {
+    std::size_t i = 0;
+    for (; i + V::size <= count; i += V::size)
+      decodeOctahedral<V> (u, v, i, nx, ny, nz);
+    for (; i < count; ++i)
+      decodeOctahedral<Lane<float> > (u, v, i, nx, ny, nz);
+  }
+
+#ifdef PCL_SIMD_KERNELS_SSE2
+  void
+  decodeOctahedralSSE2 (const float* u, const float* v, std::size_t count, float* nx, float* ny, float* nz)
+  {
+    decodeOctahedralAll<Lane4> (u, v, count, nx, ny, nz);
+  }
+#endif
+
+#ifdef PCL_SIMD_KERNELS_AVX
+  PCL_SIMD_TARGET_AVX void
+  decodeOctahedralAVX (const float* u, const float* v, std::size_t count, float* nx, float* ny, float* nz)
+  {
+    decodeOctahedralAll<Lane8> (u, v, count, nx, ny, nz);
+  }
+#endif
+
+#ifdef PCL_SIMD_KERNELS_AVX512
+  PCL_SIMD_TARGET_AVX512 void
+  decodeOctahedralAVX512 (const float* u, const float* v, std::size_t count, float* nx, float* ny, float* nz)
+  {
+    decodeOctahedralAll<Lane16> (u, v, count, nx, ny, nz);
+  }
+#endif
+
+  /** Unfold count octahedral coordinates, using the widest kernel pcl::getSIMDLevel () allows. */
+  void
+  decodeOctahedralBlock (const float* u, const float* v, std::size_t count, float* nx, float* ny, float* nz)
+  {
+    const pcl::SIMDLevel level = pcl::getSIMDLevel ();
+#ifdef PCL_SIMD_KERNELS_AVX512
+    if (level >= pcl::SIMDLevel::AVX512)
+      return (decodeOctahedralAVX512 (u, v, count, nx, ny, nz));
+#endif
+#ifdef PCL_SIMD_KERNELS_AVX
+    if (level >= pcl::SIMDLevel::AVX)
+      return (decodeOctahedralAVX (u, v, count, nx, ny, nz));
+#endif
+#ifdef PCL_SIMD_KERNELS_SSE2
+    if (level >= pcl::SIMDLevel::SSE2)
+      return (decodeOctahedralSSE2 (u, v, count, nx, ny, nz));
+#endif
+    (void) level;
+    decodeOctahedralAll<Lane<float> > (u, v, count, nx, ny, nz);
+  }
+
+  /** Give the output the size and the layout of the input. */
+  template <typename PointIn, typename PointOut> void
+  copyLayout (const pcl::PointCloud<PointIn>& input, pcl::PointCloud<PointOut>& output)
+  {
+    output.resize (input.size ());
+    output.header = input.header;
+    output.width = input.width;
+    output.height = input.height;
+    output.is_dense = input.is_dense;
+    output.sensor_origin_ = input.sensor_origin_;
+    output.sensor_orientation_ = input.sensor_orientation_;
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+std::uint16_t
+pcl::floatToHalf (float value)
+{
+  std::uint32_t bits = toBits (value);
+  const auto sign = static_cast<std::uint16_t> ((bits >> 16) & 0x8000);
+  bits &= 0x7fffffff;
+
+  // Infinity, NaN (kept quiet), and the values that round beyond the largest half
+  if (bits >= 0x47800000)
+    return (static_cast<std::uint16_t> (sign | (bits > 0x7f800000 ? 0x7e00 : 0x7c00)));
+  // Subnormal halves: adding 0.5 aligns the mantissa, the addition rounds to nearest even
+  if (bits < 0x38800000)
+    return (static_cast<std::uint16_t> (sign | (toBits (fromBits (bits) + 0.5f) - 0x3f000000)));
+  // Normal halves: rebias the exponent and round the mantissa to nearest even
+  const std::uint32_t odd = (bits >> 13) & 1;
+  bits += (static_cast<std::uint32_t> (15 - 127) << 23) + 0xfff + odd;
+  return (static_cast<std::uint16_t> (sign | (bits >> 13)));
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+float
+pcl::halfToFloat (std::uint16_t value)
+{
+  const std::uint32_t sign = static_cast<std::uint32_t> (value & 0x8000) << 16;
+  const std::uint32_t shifted = static_cast<std::uint32_t> (value & 0x7fff) << 13;
+  if (shifted > (0x7bffu << 13))
+    return (fromBits (sign | shifted | 0x7f800000));
+  return (fromBits (sign | toBits (fromBits (shifted) * rebias)));
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+void
+pcl::halfToFloat (const std::uint16_t* input, std::size_t count, float* output)
+{
+  convertHalf (input, count, output);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+std::array<std::int16_t, 2>
+pcl::encodeOctahedralNormal (float nx, float ny, float nz)
+{
+  const float l1 = std::abs (nx) + std::abs (ny) + std::abs (nz);
+  if (!std::isfinite (l1) || l1 == 0.0f)
+    return {{invalid_q16, 0}};
+
+  float u = nx / l1;
+  float v = ny / l1;
+  // Fold the lower hemisphere over the diagonals of the square
+  if (nz < 0.0f)
+  {
+    const float folded_u = (1.0f - std::abs (v)) * (u >= 0.0f ? 1.0f : -1.0f);
+    v = (1.0f - std::abs (u)) * (v >= 0.0f ? 1.0f : -1.0f);
+    u = folded_u;
+  }
+  const auto quantize = [] (float value)
+  {
+    return (static_cast<std::int16_t> (std::round (std::min (1.0f, std::max (-1.0f, value)) * oct_scale)));
+  };
+  return {{quantize (u), quantize (v)}};
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+void
+pcl::decodeOctahedralNormal (const std::int16_t oct[2], float& nx, float& ny, float& nz)
+{
+  float uv[2];
+  convertQ16Scalar (oct, 2, 1.0f / oct_scale, 0.0f, uv);
+  decodeOctahedral<Lane<float> > (uv, uv + 1, 0, &nx, &ny, &nz);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+std::size_t
+pcl::encodePointCloud (const PointCloud<PointXYZ>& input, const Eigen::Vector3f& origin, float step,
+                       PointCloud<PointXYZQ16>& output)
+{
+  copyLayout (input, output);
+  const float limit = std::numeric_limits<std::int16_t>::max ();
+  const float scale = 1.0f / step;
+  std::size_t out_of_range = 0;
+  for (std::size_t i = 0; i < input.size (); ++i)
+  {
+    PointXYZQ16& q = output[i];
+    q.x = q.y = q.z = invalid_q16;
+    if (!isFinite (input[i]))
+    {
+      output.is_dense = false;
+      continue;
+    }
+    const Eigen::Vector3f r = ((input[i].getVector3fMap () - origin) * scale).array ().round ();
+    if (r.cwiseAbs ().maxCoeff () > limit)
+    {
+      output.is_dense = false;
+      ++out_of_range;
+      continue;
+    }
+    q.x = static_cast<std::int16_t> (r[0]);
+    q.y = static_cast<std::int16_t> (r[1]);
+    q.z = static_cast<std::int16_t> (r[2]);
+  }
+  return (out_of_range);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+void
+pcl::decodePointCloud (const PointCloud<PointXYZQ16>& input, const Eigen::Vector3f& origin, float step,
+                       PointCloud<PointXYZ>& output)
+{
+  copyLayout (input, output);
+  std::int16_t q[3][block_size];
+  float f[3][block_size];
+  for (std::size_t start = 0; start < input.size (); start += block_size)
+  {
+    const std::size_t count = std::min (block_size, input.size () - start);
+    for (std::size_t i = 0; i < count; ++i)
+    {
+      const PointXYZQ16& p = input[start + i];
+      q[0][i] = p.x;
+      q[1][i] = p.y;
+      q[2][i] = p.z;
+    }
+    for (int k = 0; k < 3; ++k)
+      convertQ16 (q[k], count, step, origin[k], f[k]);
+    for (std::size_t i = 0; i < count; ++i)
+      output[start + i] = PointXYZ (f[0][i], f[1][i], f[2][i]);
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+void
+pcl::encodePointCloud (const PointCloud<PointXYZ>& input, PointCloud<PointXYZHalf>& output)
+{
+  copyLayout (input, output);
+  for (std::size_t i = 0; i < input.size (); ++i)
+  {
+    output[i].x = floatToHalf (input[i].x);
+    output[i].y = floatToHalf (input[i].y);
+    output[i].z = floatToHalf (input[i].z);
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+void
+pcl::decodePointCloud (const PointCloud<PointXYZHalf>& input, PointCloud<PointXYZ>& output)
+{
+  copyLayout (input, output);
+  std::uint16_t h[3][block_size];
+  float f[3][block_size];
+  for (std::size_t start = 0; start < input.size (); start += block_size)
+  {
+    const std::size_t count = std::min (block_size, input.size () - start);
+    for (std::size_t i = 0; i < count; ++i)
+    {
+      const PointXYZHalf& p = input[start + i];
+      h[0][i] = p.x;
+      h[1][i] = p.y;
+      h[2][i] = p.z;
+    }
+    for (int k = 0; k < 3; ++k)
+      convertHalf (h[k], count, f[k]);
+    for (std::size_t i = 0; i < count; ++i)
+      output[start + i] = PointXYZ (f[0][i], f[1][i], f[2][i]);
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+void
+pcl::encodePointCloud (const PointCloud<PointNormal>& input, PointCloud<PointNormalHalf>& output)
+{
+  copyLayout (input, output);
+  for (std::size_t i = 0; i < input.size (); ++i)
+  {
+    const PointNormal& p = input[i];
+    PointNormalHalf& c = output[i];
+    c.x = floatToHalf (p.x);
+    c.y = floatToHalf (p.y);
+    c.z = floatToHalf (p.z);
+    const std::array<std::int16_t, 2> oct = encodeOctahedralNormal (p.normal_x, p.normal_y, p.normal_z);
+    c.normal_oct[0] = oct[0];
+    c.normal_oct[1] = oct[1];
+    c.curvature = floatToHalf (p.curvature);
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+void
+pcl::decodePointCloud (const PointCloud<PointNormalHalf>& input, PointCloud<PointNormal>& output)
+{
+  copyLayout (input, output);
+  // x, y, z, curvature, then the normal
+  std::uint16_t h[4][block_size];
+  std::int16_t q[2][block_size];
+  float f[4][block_size], uv[2][block_size], n[3][block_size];
+  for (std::size_t start = 0; start < input.size (); start += block_size)
+  {
+    const std::size_t count = std::min (block_size, input.size () - start);
+    for (std::size_t i = 0; i < count; ++i)
+    {
+      const PointNormalHalf& p = input[start + i];
+      h[0][i] = p.x;
+      h[1][i] = p.y;
+      h[2][i] = p.z;
+      h[3][i] = p.curvature;
+      q[0][i] = p.normal_oct[0];
+      q[1][i] = p.normal_oct[1];
+    }
+    for (int k = 0; k < 4; ++k)
+      convertHalf (h[k], count, f[k]);
+    for (int k = 0; k < 2; ++k)
+      convertQ16 (q[k], count, 1.0f / oct_scale, 0.0f, uv[k]);
+    decodeOctahedralBlock (uv[0], uv[1], count, n[0], n[1], n[2]);
+    for (std::size_t i = 0; i < count; ++i)
+      output[start + i] = PointNormal (f[0][i], f[1][i], f[2][i], n[0][i], n[1][i], n[2][i], f[3][i]);
+  }
+}
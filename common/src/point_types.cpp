@@ -474,4 +474,26 @@ namespace pcl
     return (os);
   }
 
+  std::ostream&
+  operator << (std::ostream& os, const PointXYZQ16& p)
+  {
+    os << "(" << p.x << "," << p.y << "," << p.z << ")";
+    return (os);
+  }
+
+  std::ostream&
+  operator << (std::ostream& os, const PointXYZHalf& p)
+  {
+    os << "(" << p.x << "," << p.y << "," << p.z << ")";
+    return (os);
+  }
+
+  std::ostream&
+  operator << (std::ostream& os, const PointNormalHalf& p)
+  {
+    os << "(" << p.x << "," << p.y << "," << p.z << " - "
+       << p.normal_oct[0] << "," << p.normal_oct[1] << " - " << p.curvature << ")";
+    return (os);
+  }
+
 }
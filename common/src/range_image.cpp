@@ -34,8 +34,10 @@
  *  POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include <algorithm>
 #include <cmath>
 #include <pcl/PCLPointCloud2.h> // for PCLPointCloud2
+#include <pcl/common/execution_context.h>
 #include <pcl/common/time.h> // for MEASURE_FUNCTION_TIME
 #include <pcl/range_image/range_image.h>
 
@@ -865,13 +867,15 @@ RangeImage::getOverlap (const RangeImage& other_range_image, const Eigen::Affine
   
   float max_distance_squared = max_distance*max_distance;
   
+  const pcl::ThreadReservation reservation (static_cast<unsigned int> (std::max (max_no_of_threads, 0)));
+  const unsigned int threads = reservation.getNumberOfThreads ();
 #pragma omp parallel for \
   default(none) \
   shared(max_distance_squared, other_range_image, pixel_step, relative_transformation, search_radius) \
   schedule(dynamic, 1) \
   reduction(+ : valid_points_counter) \
   reduction(+ : hits_counter) \
-  num_threads(max_no_of_threads)
+  num_threads(threads)
   for (int other_y=0; other_y<int (other_range_image.height); other_y+=pixel_step)
   {
     for (int other_x=0; other_x<int (other_range_image.width); other_x+=pixel_step)
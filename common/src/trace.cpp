@@ -0,0 +1,305 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2019-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <pcl/common/trace.h>
+#include <pcl/console/print.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <vector>
+
+namespace
+{
+  /** \brief A zone ('X'), a counter value ('C'). */
+  struct Event
+  {
+    const char *name;
+    std::string name_copy;
+    std::int64_t start;
+    std::int64_t duration;
+    double value;
+    char phase;
+  };
+
+  /** \brief The events of one thread. Only its thread appends to it, the lock is taken
+    * against writeChromeTrace and clear. The registry keeps it after the thread ended.
+    */
+  struct ThreadBuffer
+  {
+    std::mutex mutex;
+    std::vector<Event> events;
+    std::string name;
+    unsigned int id;
+  };
+
+  struct Registry
+  {
+    std::mutex mutex;
+    std::vector<std::shared_ptr<ThreadBuffer> > buffers;
+    unsigned int next_id = 1;
+    const std::chrono::steady_clock::time_point epoch = std::chrono::steady_clock::now ();
+  };
+
+  std::atomic<bool> recording (false);
+
+  Registry&
+  registry ()
+  {
+    static Registry instance;
+    return (instance);
+  }
+
+  ThreadBuffer&
+  threadBuffer ()
+  {
+    thread_local const std::shared_ptr<ThreadBuffer> buffer = []
+    {
+      auto new_buffer = std::make_shared<ThreadBuffer> ();
+      Registry &reg = registry ();
+      std::lock_guard<std::mutex> lock (reg.mutex);
+      new_buffer->id = reg.next_id++;
+      reg.buffers.push_back (new_buffer);
+      return (new_buffer);
+    } ();
+    return (*buffer);
+  }
+
+  /** \brief Nanoseconds since the first use of the registry. */
+  std::int64_t
+  now ()
+  {
+    return (std::chrono::duration_cast<std::chrono::nanoseconds> (
+              std::chrono::steady_clock::now () - registry ().epoch).count ());
+  }
+
+  void
+  record (Event &&event)
+  {
+    ThreadBuffer &buffer = threadBuffer ();
+    std::lock_guard<std::mutex> lock (buffer.mutex);
+    buffer.events.push_back (std::move (event));
+  }
+
+  void
+  writeString (std::ostream &os, const char *s)
+  {
+    os << '"';
+    for (; *s; ++s)
+    {
+      const unsigned char c = static_cast<unsigned char> (*s);
+      if (c == '"' || c == '\\')
+        os << '\\' << *s;
+      else if (c < 0x20)
+      {
+        char escaped[8];
+        std::snprintf (escaped, sizeof (escaped), "\\u%04x", c);
+        os << escaped;
+      }
+      else
+        os << *s;
+    }
+    os << '"';
+  }
+
+  /** \brief Write nanoseconds as the microseconds the trace format uses. */
+  void
+  writeMicroseconds (std::ostream &os, std::int64_t ns)
+  {
+    char buffer[32];
+    std::snprintf (buffer, sizeof (buffer), "%lld.%03lld",
+                   static_cast<long long> (ns / 1000), static_cast<long long> (ns % 1000));
+    os << buffer;
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+void
+pcl::trace::start ()
+{
+  // Fix the epoch before the first event
+  registry ();
+  recording.store (true, std::memory_order_relaxed);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+void
+pcl::trace::stop ()
+{
+  recording.store (false, std::memory_order_relaxed);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+bool
+pcl::trace::isRecording () noexcept
+{
+  return (recording.load (std::memory_order_relaxed));
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+void
+pcl::trace::clear ()
+{
+  Registry &reg = registry ();
+  std::lock_guard<std::mutex> lock (reg.mutex);
+  std::vector<std::shared_ptr<ThreadBuffer> > buffers;
+  for (const auto &buffer : reg.buffers)
+  {
+    // Forget the buffers of threads that ended
+    if (buffer.use_count () == 1)
+      continue;
+    std::lock_guard<std::mutex> buffer_lock (buffer->mutex);
+    buffer->events.clear ();
+    buffers.push_back (buffer);
+  }
+  reg.buffers.swap (buffers);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+void
+pcl::trace::setThreadName (const std::string &name)
+{
+  ThreadBuffer &buffer = threadBuffer ();
+  std::lock_guard<std::mutex> lock (buffer.mutex);
+  buffer.name = name;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+void
+pcl::trace::counter (const char *name, double value)
+{
+  if (!isRecording ())
+    return;
+  record ({name, std::string (), now (), 0, value, 'C'});
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+void
+pcl::trace::writeChromeTrace (std::ostream &os)
+{
+  Registry &reg = registry ();
+  std::lock_guard<std::mutex> lock (reg.mutex);
+
+  os << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+  bool first = true;
+  const auto separate = [&os, &first] ()
+  {
+    os << (first ? "\n" : ",\n");
+    first = false;
+  };
+
+  for (const auto &buffer : reg.buffers)
+  {
+    std::lock_guard<std::mutex> buffer_lock (buffer->mutex);
+    if (!buffer->name.empty ())
+    {
+      separate ();
+      os << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << buffer->id << ",\"args\":{\"name\":";
+      writeString (os, buffer->name.c_str ());
+      os << "}}";
+    }
+
+    for (const Event &event : buffer->events)
+    {
+      separate ();
+      os << "{\"name\":";
+      writeString (os, event.name ? event.name : event.name_copy.c_str ());
+      os << ",\"cat\":\"pcl\",\"ph\":\"" << event.phase << "\",\"ts\":";
+      writeMicroseconds (os, event.start);
+      if (event.phase == 'X')
+      {
+        os << ",\"dur\":";
+        writeMicroseconds (os, event.duration);
+      }
+      os << ",\"pid\":1,\"tid\":" << buffer->id;
+      if (event.phase == 'C')
+        os << ",\"args\":{\"value\":" << event.value << "}";
+      os << "}";
+    }
+  }
+  os << "\n]}\n";
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+bool
+pcl::trace::writeChromeTrace (const std::string &file_name)
+{
+  std::ofstream file (file_name.c_str ());
+  if (!file)
+  {
+    PCL_ERROR ("[pcl::trace::writeChromeTrace] Could not open %s for writing.\n", file_name.c_str ());
+    return (false);
+  }
+  writeChromeTrace (file);
+  return (static_cast<bool> (file));
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+pcl::trace::Zone::Zone (const char *name)
+  : name_ (name)
+  , start_ (0)
+  , recording_ (isRecording ())
+{
+  if (recording_)
+    start_ = now ();
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+pcl::trace::Zone::Zone (const std::string &name)
+  : name_ (nullptr)
+  , start_ (0)
+  , recording_ (isRecording ())
+{
+  if (recording_)
+  {
+    name_copy_ = name;
+    start_ = now ();
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+pcl::trace::Zone::~Zone ()
+{
+  if (recording_)
+  {
+    const std::int64_t end = now ();
+    record ({name_, std::move (name_copy_), start_, end - start_, 0.0, 'X'});
+  }
+}
@@ -0,0 +1,314 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include <pcl/common/transforms.h>
+#include <pcl/common/cpu_dispatch.h>
+#include <pcl/common/execution_context.h>
+
+#include <algorithm>
+#include <cstdint>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#if defined(PCL_SIMD_KERNELS_AVX) || defined(PCL_SIMD_KERNELS_AVX512)
+#include <immintrin.h>
+#endif
+
+namespace
+{
+  /** Transform nr_points points with the matrix tf (16 values, column major). */
+  template <typename Scalar>
+  using TransformKernel = void (*) (const std::uint8_t* src, std::size_t src_stride,
+                                    std::uint8_t* tgt, std::size_t tgt_stride,
+                                    std::size_t nr_points, const Scalar* tf);
+
+  template <typename Scalar> void
+  transformGeneric (const std::uint8_t* src, std::size_t src_stride,
+                    std::uint8_t* tgt, std::size_t tgt_stride,
+                    std::size_t nr_points, const Scalar* tf)
+  {
+    const Eigen::Matrix<Scalar, 4, 4> transform = Eigen::Map<const Eigen::Matrix<Scalar, 4, 4> > (tf);
+    pcl::detail::Transformer<Scalar> transformer (transform);
+    for (std::size_t i = 0; i < nr_points; ++i)
+      transformer.se3 (reinterpret_cast<const float*> (src + i * src_stride),
+                       reinterpret_cast<float*> (tgt + i * tgt_stride));
+  }
+
+#ifdef PCL_SIMD_KERNELS_AVX
+  // All kernels evaluate x * c0 + (y * c1 + (z * c2 + c3)), like Transformer::se3 does,
+  // so that every code path gives the same result
+
+  PCL_SIMD_TARGET_AVX inline __m128
+  transformPoint (const float* src, const __m128* c)
+  {
+    const __m128 p = _mm_loadu_ps (src);
+    return (_mm_add_ps (_mm_mul_ps (_mm_permute_ps (p, 0x00), c[0]),
+            _mm_add_ps (_mm_mul_ps (_mm_permute_ps (p, 0x55), c[1]),
+            _mm_add_ps (_mm_mul_ps (_mm_permute_ps (p, 0xAA), c[2]), c[3]))));
+  }
+
+  PCL_SIMD_TARGET_AVX inline __m128
+  transformPoint (const float* src, const __m256d* c)
+  {
+    const __m128 p = _mm_loadu_ps (src);
+    const __m256d r = _mm256_add_pd (_mm256_mul_pd (_mm256_cvtps_pd (_mm_permute_ps (p, 0x00)), c[0]),
+                      _mm256_add_pd (_mm256_mul_pd (_mm256_cvtps_pd (_mm_permute_ps (p, 0x55)), c[1]),
+                      _mm256_add_pd (_mm256_mul_pd (_mm256_cvtps_pd (_mm_permute_ps (p, 0xAA)), c[2]), c[3])));
+    return (_mm256_cvtpd_ps (r));
+  }
+
+  /** Single precision AVX kernel: two points per register, 8 points per iteration. */
+  PCL_SIMD_TARGET_AVX void
+  transformAVX (const std::uint8_t* src, std::size_t src_stride,
+                std::uint8_t* tgt, std::size_t tgt_stride,
+                std::size_t nr_points, const float* tf)
+  {
+    __m128 c[4];
+    __m256 cc[4];
+    for (int i = 0; i < 4; ++i)
+    {
+      c[i] = _mm_loadu_ps (tf + 4 * i);
+      cc[i] = _mm256_broadcast_ps (&c[i]);
+    }
+
+    std::size_t i = 0;
+    for (; i + 8 <= nr_points; i += 8)
+    {
+      for (std::size_t k = i; k < i + 8; k += 2)
+      {
+        const float* a = reinterpret_cast<const float*> (src + k * src_stride);
+        const float* b = reinterpret_cast<const float*> (src + (k + 1) * src_stride);
+        const __m256 p = _mm256_insertf128_ps (_mm256_castps128_ps256 (_mm_loadu_ps (a)), _mm_loadu_ps (b), 1);
+        const __m256 r = _mm256_add_ps (_mm256_mul_ps (_mm256_permute_ps (p, 0x00), cc[0]),
+                         _mm256_add_ps (_mm256_mul_ps (_mm256_permute_ps (p, 0x55), cc[1]),
+                         _mm256_add_ps (_mm256_mul_ps (_mm256_permute_ps (p, 0xAA), cc[2]), cc[3])));
+        _mm_storeu_ps (reinterpret_cast<float*> (tgt + k * tgt_stride), _mm256_castps256_ps128 (r));
+        _mm_storeu_ps (reinterpret_cast<float*> (tgt + (k + 1) * tgt_stride), _mm256_extractf128_ps (r, 1));
+      }
+    }
+    for (; i < nr_points; ++i)
+      _mm_storeu_ps (reinterpret_cast<float*> (tgt + i * tgt_stride),
+                     transformPoint (reinterpret_cast<const float*> (src + i * src_stride), c));
+  }
+
+  /** Double precision AVX kernel: one point per register, 8 points per iteration. */
+  PCL_SIMD_TARGET_AVX void
+  transformAVX (const std::uint8_t* src, std::size_t src_stride,
+                std::uint8_t* tgt, std::size_t tgt_stride,
+                std::size_t nr_points, const double* tf)
+  {
+    __m256d c[4];
+    for (int i = 0; i < 4; ++i)
+      c[i] = _mm256_loadu_pd (tf + 4 * i);
+
+    std::size_t i = 0;
+    for (; i + 8 <= nr_points; i += 8)
+      for (std::size_t k = i; k < i + 8; ++k)
+        _mm_storeu_ps (reinterpret_cast<float*> (tgt + k * tgt_stride),
+                       transformPoint (reinterpret_cast<const float*> (src + k * src_stride), c));
+    for (; i < nr_points; ++i)
+      _mm_storeu_ps (reinterpret_cast<float*> (tgt + i * tgt_stride),
+                     transformPoint (reinterpret_cast<const float*> (src + i * src_stride), c));
+  }
+#endif // PCL_SIMD_KERNELS_AVX
+
+#ifdef PCL_SIMD_KERNELS_AVX512
+  /** Single precision AVX-512 kernel: four points per register, 16 points per iteration. */
+  PCL_SIMD_TARGET_AVX512 void
+  transformAVX512 (const std::uint8_t* src, std::size_t src_stride,
+                   std::uint8_t* tgt, std::size_t tgt_stride,
+                   std::size_t nr_points, const float* tf)
+  {
+    __m128 c[4];
+    __m512 cc[4];
+    for (int i = 0; i < 4; ++i)
+    {
+      c[i] = _mm_loadu_ps (tf + 4 * i);
+      cc[i] = _mm512_broadcast_f32x4 (c[i]);
+    }
+
+    std::size_t i = 0;
+    for (; i + 16 <= nr_points; i += 16)
+    {
+      for (std::size_t k = i; k < i + 16; k += 4)
+      {
+        __m512 p;
+        // Points packed without padding (e.g. PointXYZ) are loaded at once
+        if (src_stride == 4 * sizeof (float))
+          p = _mm512_loadu_ps (src + k * src_stride);
+        else
+        {
+          p = _mm512_castps128_ps512 (_mm_loadu_ps (reinterpret_cast<const float*> (src + k * src_stride)));
+          p = _mm512_insertf32x4 (p, _mm_loadu_ps (reinterpret_cast<const float*> (src + (k + 1) * src_stride)), 1);
+          p = _mm512_insertf32x4 (p, _mm_loadu_ps (reinterpret_cast<const float*> (src + (k + 2) * src_stride)), 2);
+          p = _mm512_insertf32x4 (p, _mm_loadu_ps (reinterpret_cast<const float*> (src + (k + 3) * src_stride)), 3);
+        }
+        const __m512 r = _mm512_add_ps (_mm512_mul_ps (_mm512_permute_ps (p, 0x00), cc[0]),
+                         _mm512_add_ps (_mm512_mul_ps (_mm512_permute_ps (p, 0x55), cc[1]),
+                         _mm512_add_ps (_mm512_mul_ps (_mm512_permute_ps (p, 0xAA), cc[2]), cc[3])));
+        if (tgt_stride == 4 * sizeof (float))
+          _mm512_storeu_ps (tgt + k * tgt_stride, r);
+        else
+        {
+          _mm_storeu_ps (reinterpret_cast<float*> (tgt + k * tgt_stride), _mm512_castps512_ps128 (r));
+          _mm_storeu_ps (reinterpret_cast<float*> (tgt + (k + 1) * tgt_stride), _mm512_extractf32x4_ps (r, 1));
+          _mm_storeu_ps (reinterpret_cast<float*> (tgt + (k + 2) * tgt_stride), _mm512_extractf32x4_ps (r, 2));
+          _mm_storeu_ps (reinterpret_cast<float*> (tgt + (k + 3) * tgt_stride), _mm512_extractf32x4_ps (r, 3));
+        }
+      }
+    }
+    for (; i < nr_points; ++i)
+      _mm_storeu_ps (reinterpret_cast<float*> (tgt + i * tgt_stride),
+                     transformPoint (reinterpret_cast<const float*> (src + i * src_stride), c));
+  }
+
+  /** Double precision AVX-512 kernel: two points per register, 8 points per iteration. */
+  PCL_SIMD_TARGET_AVX512 void
+  transformAVX512 (const std::uint8_t* src, std::size_t src_stride,
+                   std::uint8_t* tgt, std::size_t tgt_stride,
+                   std::size_t nr_points, const double* tf)
+  {
+    __m256d c[4];
+    __m512d cc[4];
+    for (int i = 0; i < 4; ++i)
+    {
+      c[i] = _mm256_loadu_pd (tf + 4 * i);
+      cc[i] = _mm512_broadcast_f64x4 (c[i]);
+    }
+
+    std::size_t i = 0;
+    for (; i + 8 <= nr_points; i += 8)
+    {
+      for (std::size_t k = i; k < i + 8; k += 2)
+      {
+        const float* a = reinterpret_cast<const float*> (src + k * src_stride);
+        const float* b = reinterpret_cast<const float*> (src + (k + 1) * src_stride);
+        const __m256 p = _mm256_insertf128_ps (_mm256_castps128_ps256 (_mm_loadu_ps (a)), _mm_loadu_ps (b), 1);
+        const __m512d r = _mm512_add_pd (_mm512_mul_pd (_mm512_cvtps_pd (_mm256_permute_ps (p, 0x00)), cc[0]),
+                          _mm512_add_pd (_mm512_mul_pd (_mm512_cvtps_pd (_mm256_permute_ps (p, 0x55)), cc[1]),
+                          _mm512_add_pd (_mm512_mul_pd (_mm512_cvtps_pd (_mm256_permute_ps (p, 0xAA)), cc[2]), cc[3])));
+        const __m256 rf = _mm512_cvtpd_ps (r);
+        _mm_storeu_ps (reinterpret_cast<float*> (tgt + k * tgt_stride), _mm256_castps256_ps128 (rf));
+        _mm_storeu_ps (reinterpret_cast<float*> (tgt + (k + 1) * tgt_stride), _mm256_extractf128_ps (rf, 1));
+      }
+    }
+    for (; i < nr_points; ++i)
+      _mm_storeu_ps (reinterpret_cast<float*> (tgt + i * tgt_stride),
+                     transformPoint (reinterpret_cast<const float*> (src + i * src_stride), c));
+  }
+#endif // PCL_SIMD_KERNELS_AVX512
+
+  /** Select the kernel for the instruction set level given by pcl::getSIMDLevel (). */
+  template <typename Scalar> TransformKernel<Scalar>
+  selectKernel ()
+  {
+    const pcl::SIMDLevel level = pcl::getSIMDLevel ();
+#ifdef PCL_SIMD_KERNELS_AVX512
+    if (level >= pcl::SIMDLevel::AVX512)
+      return (static_cast<TransformKernel<Scalar> > (transformAVX512));
+#endif
+#ifdef PCL_SIMD_KERNELS_AVX
+    if (level >= pcl::SIMDLevel::AVX)
+      return (static_cast<TransformKernel<Scalar> > (transformAVX));
+#endif
+    (void) level;
+    return (transformGeneric<Scalar>);
+  }
+
+  /** Points per thread below which a cloud is not split any further. */
+  constexpr std::size_t min_points_per_thread = 32768;
+
+  template <typename Scalar> void
+  transformPointsImpl (const float* src, std::size_t src_stride, float* tgt, std::size_t tgt_stride,
+                       std::size_t nr_points, const Eigen::Matrix<Scalar, 4, 4>& transform,
+                       unsigned int nr_threads)
+  {
+    const TransformKernel<Scalar> kernel = selectKernel<Scalar> ();
+
+    // The kernels read the matrix column by column
+    Scalar tf[16];
+    Eigen::Map<Eigen::Matrix<Scalar, 4, 4> > tf_map (tf);
+    tf_map = transform;
+
+    const auto* src_data = reinterpret_cast<const std::uint8_t*> (src);
+    auto* tgt_data = reinterpret_cast<std::uint8_t*> (tgt);
+
+#ifdef _OPENMP
+    const std::size_t max_threads = std::max<std::size_t> (nr_points / min_points_per_thread, 1);
+    const pcl::ThreadReservation reservation (static_cast<unsigned int> (
+        nr_threads == 0 ? max_threads : std::min<std::size_t> (nr_threads, max_threads)));
+    const auto threads = static_cast<std::ptrdiff_t> (reservation.getNumberOfThreads ());
+    if (threads > 1)
+    {
+      const std::size_t chunk = (nr_points + threads - 1) / threads;
+#pragma omp parallel for \
+  default(none) \
+  shared(src_data, src_stride, tgt_data, tgt_stride, nr_points, tf, chunk, threads, kernel) \
+  num_threads(threads)
+      for (std::ptrdiff_t t = 0; t < threads; ++t)
+      {
+        const std::size_t begin = t * chunk;
+        const std::size_t end = std::min (nr_points, begin + chunk);
+        if (begin < end)
+          kernel (src_data + begin * src_stride, src_stride, tgt_data + begin * tgt_stride, tgt_stride, end - begin, tf);
+      }
+      return;
+    }
+#else
+    (void) nr_threads;
+#endif
+    kernel (src_data, src_stride, tgt_data, tgt_stride, nr_points, tf);
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+void
+pcl::detail::transformPoints (const float* src, std::size_t src_stride, float* tgt, std::size_t tgt_stride,
+                              std::size_t nr_points, const Eigen::Matrix4f& transform, unsigned int nr_threads)
+{
+  transformPointsImpl<float> (src, src_stride, tgt, tgt_stride, nr_points, transform, nr_threads);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+void
+pcl::detail::transformPoints (const float* src, std::size_t src_stride, float* tgt, std::size_t tgt_stride,
+                              std::size_t nr_points, const Eigen::Matrix4d& transform, unsigned int nr_threads)
+{
+  transformPointsImpl<double> (src, src_stride, tgt, tgt_stride, nr_points, transform, nr_threads);
+}
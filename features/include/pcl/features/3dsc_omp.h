@@ -0,0 +1,129 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2019-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <pcl/point_types.h>
+#include <pcl/features/feature.h>
+#include <pcl/features/3dsc.h>
+
+#include <vector>
+
+namespace pcl
+{
+  /** \brief ShapeContext3DEstimationOMP estimates the 3D shape context descriptor of a point cloud in parallel,
+    * using the OpenMP standard. See ShapeContext3DEstimation for the descriptor and its parameters.
+    *
+    * The local point density, which weighs the contribution of a neighbor, is looked up in a table computed
+    * once for every point of the search surface that is a neighbor of a query point, instead of being searched
+    * for again in each neighborhood the point belongs to. The random X axes are drawn in the order of the
+    * points before the parallel part, so the descriptors are identical to the ones of ShapeContext3DEstimation
+    * with the same seed.
+    *
+    * \ingroup features
+    */
+  template <typename PointInT, typename PointNT, typename PointOutT = pcl::ShapeContext1980>
+  class ShapeContext3DEstimationOMP : public ShapeContext3DEstimation<PointInT, PointNT, PointOutT>
+  {
+    public:
+      using Ptr = shared_ptr<ShapeContext3DEstimationOMP<PointInT, PointNT, PointOutT> >;
+      using ConstPtr = shared_ptr<const ShapeContext3DEstimationOMP<PointInT, PointNT, PointOutT> >;
+      using Feature<PointInT, PointOutT>::feature_name_;
+      using Feature<PointInT, PointOutT>::getClassName;
+      using Feature<PointInT, PointOutT>::indices_;
+      using Feature<PointInT, PointOutT>::search_radius_;
+      using Feature<PointInT, PointOutT>::surface_;
+      using Feature<PointInT, PointOutT>::input_;
+      using FeatureFromNormals<PointInT, PointNT, PointOutT>::normals_;
+      using ShapeContext3DEstimation<PointInT, PointNT, PointOutT>::radii_interval_;
+      using ShapeContext3DEstimation<PointInT, PointNT, PointOutT>::theta_divisions_;
+      using ShapeContext3DEstimation<PointInT, PointNT, PointOutT>::phi_divisions_;
+      using ShapeContext3DEstimation<PointInT, PointNT, PointOutT>::volume_lut_;
+      using ShapeContext3DEstimation<PointInT, PointNT, PointOutT>::elevation_bins_;
+      using ShapeContext3DEstimation<PointInT, PointNT, PointOutT>::radius_bins_;
+      using ShapeContext3DEstimation<PointInT, PointNT, PointOutT>::point_density_radius_;
+      using ShapeContext3DEstimation<PointInT, PointNT, PointOutT>::descriptor_length_;
+
+      using PointCloudOut = typename Feature<PointInT, PointOutT>::PointCloudOut;
+
+      /** \brief Constructor.
+        * \param[in] random If true the random seed is set to current time, else it is
+        * set to 12345 prior to computing the descriptor (used to select X axis)
+        * \param[in] nr_threads the number of hardware threads to use (0 sets the value back to automatic)
+        */
+      ShapeContext3DEstimationOMP (bool random = false, unsigned int nr_threads = 0)
+        : ShapeContext3DEstimation<PointInT, PointNT, PointOutT> (random)
+      {
+        feature_name_ = "ShapeContext3DEstimationOMP";
+
+        setNumberOfThreads (nr_threads);
+      }
+
+      /** \brief Initialize the scheduler and set the number of threads to use.
+        * \param[in] nr_threads the number of hardware threads to use (0 sets the value back to automatic)
+        */
+      void
+      setNumberOfThreads (unsigned int nr_threads = 0);
+
+    protected:
+      /** \brief Compute the descriptor of a point from its neighborhood, without touching the state of the
+        * object.
+        * \param[in] index the index of the point in indices_
+        * \param[in] nn_indices the indices of the neighbors in the search surface, not empty
+        * \param[in] nn_dists the squared distances of the neighbors
+        * \param[in] random_axis the three random numbers the X axis of the reference frame is derived from
+        * \param[in] point_density the local point density of the points of the search surface
+        * \param[out] desc the descriptor, of descriptor_length_ values, which are accumulated into
+        */
+      void
+      computePointDescriptor (std::size_t index, const pcl::Indices &nn_indices, const std::vector<float> &nn_dists,
+                              const float random_axis[3], const std::vector<float> &point_density, float *desc) const;
+
+      /** \brief Estimate the 3D shape context descriptors in parallel.
+        * \param[out] output the resultant feature
+        */
+      void
+      computeFeature (PointCloudOut &output) override;
+
+    private:
+      /** \brief The number of threads the scheduler should use. */
+      unsigned int threads_;
+  };
+}
+
+#ifdef PCL_NO_PRECOMPILE
+#include <pcl/features/impl/3dsc_omp.hpp>
+#endif
@@ -41,6 +41,7 @@
 #pragma once
 
 #include <pcl/features/feature.h>
+#include <pcl/common/fft/kiss_fftr.h>
 
 namespace pcl
 {
@@ -75,7 +76,8 @@ namespace pcl
 
       /** \brief Constructor. */
       CRHEstimation () :
-        vpx_ (0), vpy_ (0), vpz_ (0), nbins_ (90)
+        vpx_ (0), vpy_ (0), vpz_ (0), nbins_ (90),
+        fft_cfg_ (kiss_fftr_alloc (nbins_, 0, nullptr, nullptr), [] (kiss_fftr_cfg cfg) { kiss_fftr_free (cfg); })
       {
         k_ = 1;
         feature_name_ = "CRHEstimation";
@@ -126,6 +128,9 @@ namespace pcl
       /** \brief Centroid to be used */
       Eigen::Vector4f centroid_;
 
+      /** \brief Real FFT plan for nbins_, built once and reused for every view */
+      shared_ptr<kiss_fftr_state> fft_cfg_;
+
       /** \brief Estimate the CRH histogram at
        * a set of points given by <setInputCloud (), setIndices ()> using the surface in
        * setSearchSurface ()
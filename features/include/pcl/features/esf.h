@@ -43,6 +43,8 @@
 #include <pcl/features/feature.h>
 #define GRIDSIZE 64
 #define GRIDSIZE_H GRIDSIZE/2
+#include <cstdint>
+#include <random>
 #include <vector>
 
 namespace pcl
@@ -74,7 +76,7 @@ namespace pcl
       using PointCloudOut = typename Feature<PointInT, PointOutT>::PointCloudOut;
 
       /** \brief Empty constructor. */
-      ESFEstimation () : local_cloud_ ()
+      ESFEstimation () : local_cloud_ (), seed_ (5489u)
       {
         feature_name_ = "ESFEstimation";
         lut_.resize (GRIDSIZE);
@@ -95,6 +97,17 @@ namespace pcl
       void
       compute (PointCloudOut &output);
 
+      /** \brief Set the seed of the random sampling of point triplets. The generator is seeded anew for every
+        * descriptor, so that the descriptor of a cloud only depends on the cloud and the seed.
+        * \param[in] seed the seed
+        */
+      inline void
+      setSeed (std::uint32_t seed) { seed_ = seed; }
+
+      /** \brief Get the seed of the random sampling of point triplets. */
+      inline std::uint32_t
+      getSeed () const { return (seed_); }
+
     protected:
 
       /** \brief Estimate the Ensebmel of Shape Function (ESF) descriptors at a set of points given by
@@ -133,6 +146,9 @@ namespace pcl
       
       /** \brief ... */
       PointCloudIn local_cloud_;
+
+      /** \brief The seed of the random sampling of point triplets. */
+      std::uint32_t seed_;
   };
 }
 
@@ -48,6 +48,7 @@
 #include <pcl/memory.h>
 #include <pcl/pcl_base.h>
 #include <pcl/pcl_macros.h>
+#include <pcl/features/neighborhood_cache.h>
 #include <pcl/search/search.h>
 
 #include <functional>
@@ -86,6 +87,26 @@ namespace pcl
   solvePlaneParameters (const Eigen::Matrix3f &covariance_matrix,
                         float &nx, float &ny, float &nz, float &curvature);
 
+  /** \brief Estimate the least-squares plane normals and surface curvatures of a batch of 3x3 covariance matrices,
+    * several at a time (see pcl::eigen33Batch). Matrix i is given by element i of the arrays holding its upper triangle.
+    * \param xx the covariance matrix entries (0, 0)
+    * \param xy the covariance matrix entries (0, 1)
+    * \param xz the covariance matrix entries (0, 2)
+    * \param yy the covariance matrix entries (1, 1)
+    * \param yz the covariance matrix entries (1, 2)
+    * \param zz the covariance matrix entries (2, 2)
+    * \param count the number of covariance matrices
+    * \param nx the resultant X components of the plane normals
+    * \param ny the resultant Y components of the plane normals
+    * \param nz the resultant Z components of the plane normals
+    * \param curvature the estimated surface curvatures, as in solvePlaneParameters (covariance_matrix, nx, ny, nz, curvature)
+    * \ingroup features
+    */
+  inline void
+  solvePlaneParameters (const float *xx, const float *xy, const float *xz,
+                        const float *yy, const float *yz, const float *zz, std::size_t count,
+                        float *nx, float *ny, float *nz, float *curvature);
+
   ////////////////////////////////////////////////////////////////////////////////////////////
   ////////////////////////////////////////////////////////////////////////////////////////////
   ////////////////////////////////////////////////////////////////////////////////////////////
@@ -132,7 +153,7 @@ namespace pcl
         feature_name_ (), search_method_surface_ (),
         surface_(), tree_(),
         search_parameter_(0), search_radius_(0), k_(0),
-        fake_surface_(false)
+        neighborhood_cache_ (), fake_surface_(false)
       {}
 
       /** \brief Empty destructor */
@@ -210,6 +231,21 @@ namespace pcl
         return (search_radius_);
       }
 
+      /** \brief Provide a cache of nearest neighbors to share with other feature estimators working on the same
+        * input cloud and search surface. If the cache holds the neighborhoods for the current input cloud, search
+        * surface and search parameters, they are used instead of searching again; otherwise compute () fills it.
+        * \param[in] cache a pointer to the neighborhood cache, or a null pointer to search every time
+        */
+      inline void
+      setNeighborhoodCache (const NeighborhoodCache::Ptr &cache) { neighborhood_cache_ = cache; }
+
+      /** \brief Get a pointer to the neighborhood cache used. */
+      inline NeighborhoodCache::Ptr
+      getNeighborhoodCache () const
+      {
+        return (neighborhood_cache_);
+      }
+
       /** \brief Base method for feature estimation for all points given in
         * <setInputCloud (), setIndices ()> using the surface in setSearchSurface ()
         * and the spatial locator in setSearchMethod ()
@@ -242,6 +278,9 @@ namespace pcl
       /** \brief The number of K nearest neighbors to use for each point. */
       int k_;
 
+      /** \brief The neighborhoods shared with other feature estimators, if any. */
+      NeighborhoodCache::Ptr neighborhood_cache_;
+
       /** \brief Get a string representation of the name of this class. */
       inline const std::string&
       getClassName () const { return (feature_name_); }
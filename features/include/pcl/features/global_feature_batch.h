@@ -0,0 +1,98 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2019-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <pcl/PointIndices.h>
+#include <pcl/point_cloud.h>
+
+#include <Eigen/StdVector> // for aligned_allocator
+
+#include <vector>
+
+namespace pcl
+{
+  /** \brief Compute a global descriptor, e.g. with ESFEstimation, for each of many clusters of a cloud, in
+    * parallel.
+    *
+    * Every thread works on its own copy of the given estimator, with its own search method, which it reuses
+    * for all the clusters it processes. The descriptors of a cluster are computed from the points of the
+    * cluster only, as if the cluster was given to the estimator as its input cloud, so the results do not
+    * depend on the number of threads.
+    *
+    * \code
+    * pcl::ESFEstimation<pcl::PointXYZ> esf;
+    * pcl::PointCloud<pcl::ESFSignature640>::CloudVectorType descriptors;
+    * pcl::computeGlobalFeatures (esf, *cloud, cluster_indices, descriptors);
+    * \endcode
+    * \param[in] estimator the configured estimator, which is copied once per thread
+    * \param[in] cloud the cloud the clusters are taken from
+    * \param[in] clusters the indices of the points of each cluster
+    * \param[out] descriptors the descriptors of each cluster, in the order of clusters
+    * \param[in] nr_threads the number of threads to use, 0 for as many as the budget of
+    * pcl::ExecutionContext allows
+    * \ingroup features
+    */
+  template <typename FeatureT, typename PointInT, typename PointOutT> void
+  computeGlobalFeatures (const FeatureT &estimator,
+                         const pcl::PointCloud<PointInT> &cloud,
+                         const std::vector<pcl::PointIndices> &clusters,
+                         std::vector<pcl::PointCloud<PointOutT>, Eigen::aligned_allocator<pcl::PointCloud<PointOutT> > > &descriptors,
+                         unsigned int nr_threads = 0);
+
+  /** \brief Compute a global descriptor that needs normals, e.g. with VFHEstimation, CVFHEstimation or
+    * OURCVFHEstimation, for each of many clusters of a cloud, in parallel.
+    *
+    * See computeGlobalFeatures (estimator, cloud, clusters, descriptors, nr_threads).
+    * \param[in] estimator the configured estimator, which is copied once per thread
+    * \param[in] cloud the cloud the clusters are taken from
+    * \param[in] normals the normals of the points of cloud
+    * \param[in] clusters the indices of the points of each cluster
+    * \param[out] descriptors the descriptors of each cluster, in the order of clusters
+    * \param[in] nr_threads the number of threads to use, 0 for as many as the budget of
+    * pcl::ExecutionContext allows
+    * \ingroup features
+    */
+  template <typename FeatureT, typename PointInT, typename PointNT, typename PointOutT> void
+  computeGlobalFeatures (const FeatureT &estimator,
+                         const pcl::PointCloud<PointInT> &cloud,
+                         const pcl::PointCloud<PointNT> &normals,
+                         const std::vector<pcl::PointIndices> &clusters,
+                         std::vector<pcl::PointCloud<PointOutT>, Eigen::aligned_allocator<pcl::PointCloud<PointOutT> > > &descriptors,
+                         unsigned int nr_threads = 0);
+}
+
+#include <pcl/features/impl/global_feature_batch.hpp>
@@ -0,0 +1,208 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2019-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <pcl/features/3dsc_omp.h>
+#include <pcl/common/execution_context.h>
+
+#include <pcl/common/angles.h>
+#include <pcl/common/geometry.h>
+#include <pcl/common/point_tests.h> // for pcl::isFinite
+#include <pcl/common/utils.h>
+
+#include <algorithm>
+#include <limits>
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointInT, typename PointNT, typename PointOutT> void
+pcl::ShapeContext3DEstimationOMP<PointInT, PointNT, PointOutT>::setNumberOfThreads (unsigned int nr_threads)
+{
+  // 0 is resolved against the budget of pcl::ExecutionContext at compute time
+  threads_ = nr_threads;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointInT, typename PointNT, typename PointOutT> void
+pcl::ShapeContext3DEstimationOMP<PointInT, PointNT, PointOutT>::computePointDescriptor (
+    std::size_t index, const pcl::Indices &nn_indices, const std::vector<float> &nn_dists,
+    const float random_axis[3], const std::vector<float> &point_density, float *desc) const
+{
+  const auto minDistanceIt = std::min_element (nn_dists.begin (), nn_dists.end ());
+  const auto minIndex = nn_indices[std::distance (nn_dists.begin (), minDistanceIt)];
+
+  Vector3fMapConst origin = (*input_)[(*indices_)[index]].getVector3fMap ();
+  const Eigen::Vector3f normal = (*normals_)[minIndex].getNormalVector3fMap ();
+
+  // The X axis of the reference frame, as in ShapeContext3DEstimation::computePoint
+  Eigen::Vector3f x_axis (random_axis[0], random_axis[1], random_axis[2]);
+  if (!pcl::utils::equal (normal[2], 0.0f))
+    x_axis[2] = - (normal[0]*x_axis[0] + normal[1]*x_axis[1]) / normal[2];
+  else if (!pcl::utils::equal (normal[1], 0.0f))
+    x_axis[1] = - (normal[0]*x_axis[0] + normal[2]*x_axis[2]) / normal[1];
+  else if (!pcl::utils::equal (normal[0], 0.0f))
+    x_axis[0] = - (normal[1]*x_axis[1] + normal[2]*x_axis[2]) / normal[0];
+  x_axis.normalize ();
+
+  for (std::size_t ne = 0; ne < nn_indices.size (); ne++)
+  {
+    if (pcl::utils::equal (nn_dists[ne], 0.0f))
+      continue;
+    // point_density is NOT always bigger than 0 (on error, searchForNeighbors returns 0), so we must check for that
+    const float density = point_density[nn_indices[ne]];
+    if (density == 0.0f)
+      continue;
+    Eigen::Vector3f neighbour = (*surface_)[nn_indices[ne]].getVector3fMap ();
+
+    // Polar coordinates of the neighbour
+    float r = std::sqrt (nn_dists[ne]);
+
+    Eigen::Vector3f proj;
+    pcl::geometry::project (neighbour, origin, normal, proj);
+    proj -= origin;
+    proj.normalize ();
+
+    Eigen::Vector3f cross = x_axis.cross (proj);
+    float phi = pcl::rad2deg (std::atan2 (cross.norm (), x_axis.dot (proj)));
+    phi = cross.dot (normal) < 0.f ? (360.0f - phi) : phi;
+    Eigen::Vector3f no = neighbour - origin;
+    no.normalize ();
+    float theta = normal.dot (no);
+    theta = pcl::rad2deg (std::acos (std::min (1.0f, std::max (-1.0f, theta))));
+
+    // Bin (j, k, l)
+    const auto rad_min = std::lower_bound (std::next (radii_interval_.cbegin ()), radii_interval_.cend (), r);
+    const auto theta_min = std::lower_bound (std::next (theta_divisions_.cbegin ()), theta_divisions_.cend (), theta);
+    const auto phi_min = std::lower_bound (std::next (phi_divisions_.cbegin ()), phi_divisions_.cend (), phi);
+    const auto j = std::distance (radii_interval_.cbegin (), std::prev (rad_min));
+    const auto k = std::distance (theta_divisions_.cbegin (), std::prev (theta_min));
+    const auto l = std::distance (phi_divisions_.cbegin (), std::prev (phi_min));
+
+    const std::size_t bin = (l*elevation_bins_*radius_bins_) + (k*radius_bins_) + j;
+    desc[bin] += (1.0f / density) * volume_lut_[bin];
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointInT, typename PointNT, typename PointOutT> void
+pcl::ShapeContext3DEstimationOMP<PointInT, PointNT, PointOutT>::computeFeature (PointCloudOut &output)
+{
+  assert (descriptor_length_ == 1980);
+
+  const pcl::ThreadReservation reservation (threads_);
+  unsigned int threads = reservation.getNumberOfThreads ();
+
+  // Find the neighborhoods of the query points once, they tell which local point densities are needed.
+  // An empty neighborhood marks a point without a descriptor.
+  std::vector<pcl::Indices> query_nn_indices (indices_->size ());
+  std::vector<std::vector<float> > query_nn_dists (indices_->size ());
+#pragma omp parallel for \
+  default(none) \
+  shared(query_nn_indices, query_nn_dists) \
+  schedule(dynamic, 64) \
+  num_threads(threads)
+  for (std::ptrdiff_t idx = 0; idx < static_cast<std::ptrdiff_t> (indices_->size ()); ++idx)
+  {
+    if (isFinite ((*input_)[(*indices_)[idx]]))
+      this->searchForNeighbors ((*indices_)[idx], search_radius_, query_nn_indices[idx], query_nn_dists[idx]);
+  }
+
+  // Draw the random X axes in the order ShapeContext3DEstimation does
+  std::vector<float> random_axes (3 * indices_->size ());
+  for (std::size_t idx = 0; idx < indices_->size (); ++idx)
+  {
+    if (query_nn_indices[idx].empty ())
+      continue;
+    for (int d = 0; d < 3; ++d)
+      random_axes[3 * idx + d] = this->rnd ();
+  }
+
+  // Local point density = number of points in a sphere of radius "point_density_radius_" around a neighbour,
+  // computed once per point of the search surface
+  std::vector<bool> needs_density (surface_->size (), false);
+  for (std::size_t idx = 0; idx < query_nn_indices.size (); ++idx)
+    for (std::size_t ne = 0; ne < query_nn_indices[idx].size (); ++ne)
+      if (!pcl::utils::equal (query_nn_dists[idx][ne], 0.0f))
+        needs_density[query_nn_indices[idx][ne]] = true;
+  pcl::Indices density_indices;
+  for (std::size_t p_idx = 0; p_idx < needs_density.size (); ++p_idx)
+    if (needs_density[p_idx])
+      density_indices.push_back (static_cast<pcl::index_t> (p_idx));
+
+  std::vector<float> point_density (surface_->size (), 0.0f);
+  pcl::Indices nn_indices;
+  std::vector<float> nn_dists;
+#pragma omp parallel for \
+  default(none) \
+  shared(density_indices, point_density) \
+  firstprivate(nn_indices, nn_dists) \
+  schedule(dynamic, 64) \
+  num_threads(threads)
+  for (std::ptrdiff_t i = 0; i < static_cast<std::ptrdiff_t> (density_indices.size ()); ++i)
+  {
+    const pcl::index_t p_idx = density_indices[i];
+    point_density[p_idx] = static_cast<float> (this->searchForNeighbors (*surface_, p_idx, point_density_radius_, nn_indices, nn_dists));
+  }
+
+  bool is_dense = true;
+#pragma omp parallel for \
+  default(none) \
+  shared(output, query_nn_indices, query_nn_dists, random_axes, point_density) \
+  reduction(&&:is_dense) \
+  schedule(dynamic, 64) \
+  num_threads(threads)
+  for (std::ptrdiff_t point_index = 0; point_index < static_cast<std::ptrdiff_t> (indices_->size ()); ++point_index)
+  {
+    // 3DSC does not define a repeatable local RF, we set it to zero to signal it to the user
+    std::fill (output[point_index].rf, output[point_index].rf + 9, 0);
+
+    // If the point is not finite or has no neighbors, set the descriptor to NaN and continue
+    if (query_nn_indices[point_index].empty ())
+    {
+      std::fill (output[point_index].descriptor, output[point_index].descriptor + descriptor_length_,
+                 std::numeric_limits<float>::quiet_NaN ());
+      is_dense = false;
+      continue;
+    }
+
+    std::fill (output[point_index].descriptor, output[point_index].descriptor + descriptor_length_, 0.0f);
+    computePointDescriptor (point_index, query_nn_indices[point_index], query_nn_dists[point_index],
+                            &random_axes[3 * point_index], point_density, output[point_index].descriptor);
+  }
+  output.is_dense = is_dense;
+}
+
+#define PCL_INSTANTIATE_ShapeContext3DEstimationOMP(T,NT,OutT) template class PCL_EXPORTS pcl::ShapeContext3DEstimationOMP<T,NT,OutT>;
@@ -64,6 +64,18 @@ pcl::BoundaryEstimation<PointInT, PointNT, PointOutT>::isBoundaryPoint (
       const pcl::Indices &indices, 
       const Eigen::Vector4f &u, const Eigen::Vector4f &v, 
       const float angle_threshold)
+{
+  std::vector<float> angles;
+  return (isBoundaryPoint (cloud, q_point, indices, u, v, angle_threshold, angles));
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointInT, typename PointNT, typename PointOutT> bool
+pcl::BoundaryEstimation<PointInT, PointNT, PointOutT>::isBoundaryPoint (
+      const pcl::PointCloud<PointInT> &cloud, const PointInT &q_point,
+      const pcl::Indices &indices,
+      const Eigen::Vector4f &u, const Eigen::Vector4f &v,
+      const float angle_threshold, std::vector<float> &angles) const
 {
   if (indices.size () < 3)
     return (false);
@@ -72,7 +84,7 @@ pcl::BoundaryEstimation<PointInT, PointNT, PointOutT>::isBoundaryPoint (
     return (false);
 
   // Compute the angles between each neighboring point and the query point itself
-  std::vector<float> angles (indices.size ());
+  angles.resize (indices.size ());
   float max_dif = FLT_MIN, dif;
   int cp = 0;
 
@@ -121,6 +133,7 @@ pcl::BoundaryEstimation<PointInT, PointNT, PointOutT>::computeFeature (PointClou
   std::vector<float> nn_dists (k_);
 
   Eigen::Vector4f u = Eigen::Vector4f::Zero (), v = Eigen::Vector4f::Zero ();
+  std::vector<float> angles;
 
   output.is_dense = true;
   // Save a few cycles by not checking every point for NaN/Inf values if the cloud is set to dense
@@ -142,7 +155,7 @@ pcl::BoundaryEstimation<PointInT, PointNT, PointOutT>::computeFeature (PointClou
       getCoordinateSystemOnPlane ((*normals_)[(*indices_)[idx]], u, v);
 
       // Estimate whether the point is lying on a boundary surface or not
-      output[idx].boundary_point = isBoundaryPoint (*surface_, (*input_)[(*indices_)[idx]], nn_indices, u, v, angle_threshold_);
+      output[idx].boundary_point = isBoundaryPoint (*surface_, (*input_)[(*indices_)[idx]], nn_indices, u, v, angle_threshold_, angles);
     }
   }
   else
@@ -164,7 +177,7 @@ pcl::BoundaryEstimation<PointInT, PointNT, PointOutT>::computeFeature (PointClou
       getCoordinateSystemOnPlane ((*normals_)[(*indices_)[idx]], u, v);
 
       // Estimate whether the point is lying on a boundary surface or not
-      output[idx].boundary_point = isBoundaryPoint (*surface_, (*input_)[(*indices_)[idx]], nn_indices, u, v, angle_threshold_);
+      output[idx].boundary_point = isBoundaryPoint (*surface_, (*input_)[(*indices_)[idx]], nn_indices, u, v, angle_threshold_, angles);
     }
   }
 }
@@ -110,8 +110,7 @@ pcl::CRHEstimation<PointInT, PointNT, PointOutT>::computeFeature (PointCloudOut
     data /= sum_w;
 
   std::vector<kiss_fft_cpx> freq_data(nbins / 2 + 1);
-  kiss_fftr_cfg mycfg = kiss_fftr_alloc (nbins, 0, nullptr, nullptr);
-  kiss_fftr (mycfg, spatial_data.data (), freq_data.data ());
+  kiss_fftr (fft_cfg_.get (), spatial_data.data (), freq_data.data ());
 
   for (auto& data: freq_data)
   {
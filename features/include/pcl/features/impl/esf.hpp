@@ -45,7 +45,6 @@
 #include <pcl/common/distances.h>
 #include <pcl/common/transforms.h>
 #include <vector>
-#include <ctime> // for time
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointInT, typename PointOutT> void
@@ -54,9 +53,8 @@ pcl::ESFEstimation<PointInT, PointOutT>::computeESF (
 {
   const int binsize = 64;
   unsigned int sample_size = 20000;
-  // @TODO: Replace with c++ stdlib uniform_random_generator
-  srand (static_cast<unsigned int> (time (nullptr)));
-  const auto maxindex = pc.size ();
+  std::mt19937 rng (seed_);
+  std::uniform_int_distribution<int> random_index (0, static_cast<int> (pc.size ()) - 1);
 
   std::vector<float> d2v, d1v, d3v, wt_d3;
   std::vector<int> wt_d2;
@@ -88,9 +86,9 @@ pcl::ESFEstimation<PointInT, PointOutT>::computeESF (
   for (std::size_t nn_idx = 0; nn_idx < sample_size; ++nn_idx)
   {
     // get a new random point
-    int index1 = rand()%maxindex;
-    int index2 = rand()%maxindex;
-    int index3 = rand()%maxindex;
+    int index1 = random_index (rng);
+    int index2 = random_index (rng);
+    int index3 = random_index (rng);
 
     if (index1==index2 || index1 == index3 || index2 == index3)
     {
@@ -41,6 +41,8 @@
 #ifndef PCL_FEATURES_IMPL_FEATURE_H_
 #define PCL_FEATURES_IMPL_FEATURE_H_
 
+#include <pcl/common/eigen.h> // for eigen33, eigen33Batch
+#include <pcl/common/trace.h>
 #include <pcl/search/kdtree.h> // for KdTree
 #include <pcl/search/organized.h> // for OrganizedNeighbor
 
@@ -91,9 +93,30 @@ solvePlaneParameters (const Eigen::Matrix3f &covariance_matrix,
 }
 
 
+inline void
+solvePlaneParameters (const float *xx, const float *xy, const float *xz,
+                      const float *yy, const float *yz, const float *zz, std::size_t count,
+                      float *nx, float *ny, float *nz, float *curvature)
+{
+  // The smallest eigenvalues go to curvature first
+  pcl::eigen33Batch (xx, xy, xz, yy, yz, zz, count, curvature, nx, ny, nz);
+
+  for (std::size_t i = 0; i < count; ++i)
+  {
+    float eig_sum = xx[i] + yy[i] + zz[i];
+    if (eig_sum != 0)
+      curvature[i] = std::abs (curvature[i] / eig_sum);
+    else
+      curvature[i] = 0;
+  }
+}
+
+
 template <typename PointInT, typename PointOutT> bool
 Feature<PointInT, PointOutT>::initCompute ()
 {
+  PCL_TRACE_ZONE ("Feature::initCompute");
+
   if (!PCLBase<PointInT>::initCompute ())
   {
     PCL_ERROR ("[pcl::%s::initCompute] Init failed.\n", getClassName ().c_str ());
@@ -173,6 +196,22 @@ Feature<PointInT, PointOutT>::initCompute ()
       return (false);
     }
   }
+
+  if (neighborhood_cache_)
+  {
+    if (!neighborhood_cache_->matches (*input_, *surface_, search_radius_, k_))
+      neighborhood_cache_->compute (*tree_, *input_, *indices_, search_radius_, k_);
+
+    // Answer the searches around the cached points from the cache
+    search_method_surface_ = [this, search = search_method_surface_] (const PointCloudIn &cloud, std::size_t index, double parameter,
+                                                                      pcl::Indices &k_indices, std::vector<float> &k_distances)
+    {
+      if (&cloud == input_.get () && parameter == search_parameter_ &&
+          neighborhood_cache_->getNeighbors (static_cast<pcl::index_t> (index), k_indices, k_distances))
+        return (static_cast<int> (k_indices.size ()));
+      return (search (cloud, index, parameter, k_indices, k_distances));
+    };
+  }
   return (true);
 }
 
@@ -193,6 +232,8 @@ Feature<PointInT, PointOutT>::deinitCompute ()
 template <typename PointInT, typename PointOutT> void
 Feature<PointInT, PointOutT>::compute (PointCloudOut &output)
 {
+  PCL_TRACE_ZONE (feature_name_);
+
   if (!initCompute ())
   {
     output.width = output.height = 0;
@@ -222,7 +263,10 @@ Feature<PointInT, PointOutT>::compute (PointCloudOut &output)
   output.is_dense = input_->is_dense;
 
   // Perform the actual feature computation
-  computeFeature (output);
+  {
+    PCL_TRACE_ZONE ("Feature::computeFeature");
+    computeFeature (output);
+  }
 
   deinitCompute ();
 }
@@ -41,8 +41,10 @@
 #pragma once
 
 #include <pcl/features/fpfh_omp.h>
+#include <pcl/common/execution_context.h>
 
 #include <pcl/common/point_tests.h> // for pcl::isFinite
+#include <pcl/features/pfh_tools.h> // for pcl::computePairFeatures
 
 #include <numeric>
 
@@ -51,43 +53,50 @@
 template <typename PointInT, typename PointNT, typename PointOutT> void
 pcl::FPFHEstimationOMP<PointInT, PointNT, PointOutT>::setNumberOfThreads (unsigned int nr_threads)
 {
-  if (nr_threads == 0)
-#ifdef _OPENMP
-    threads_ = omp_get_num_procs();
-#else
-    threads_ = 1;
-#endif
-  else
-    threads_ = nr_threads;
+  // 0 is resolved against the budget of pcl::ExecutionContext at compute time
+  threads_ = nr_threads;
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointInT, typename PointNT, typename PointOutT> void
 pcl::FPFHEstimationOMP<PointInT, PointNT, PointOutT>::computeFeature (PointCloudOut &output)
 {
-  std::vector<int> spfh_indices_vec;
-  std::vector<int> spfh_hist_lookup (surface_->size ());
+  const pcl::ThreadReservation reservation (threads_);
+  unsigned int threads = reservation.getNumberOfThreads ();
+  // Find the neighborhoods of the query points once: they give the points which need an SPFH signature
+  // and the weights of the FPFH signatures, and double as SPFH neighborhoods when the surface is the input.
+  // An empty neighborhood marks a query point without a descriptor.
+  std::vector<pcl::Indices> query_nn_indices (indices_->size ());
+  std::vector<std::vector<float> > query_nn_dists (indices_->size ());
+
+#pragma omp parallel for \
+  default(none) \
+  shared(query_nn_indices, query_nn_dists) \
+  num_threads(threads)
+  for (std::ptrdiff_t idx = 0; idx < static_cast<std::ptrdiff_t> (indices_->size ()); ++idx)
+  {
+    if (!isFinite ((*input_)[(*indices_)[idx]]) ||
+        this->searchForNeighbors ((*indices_)[idx], search_parameter_, query_nn_indices[idx], query_nn_dists[idx]) == 0)
+    {
+      query_nn_indices[idx].clear ();
+      query_nn_dists[idx].clear ();
+    }
+  }
 
   // Build a list of (unique) indices for which we will need to compute SPFH signatures
   // (We need an SPFH signature for every point that is a neighbor of any point in input_[indices_])
+  std::vector<int> spfh_indices_vec;
+  std::vector<int> spfh_hist_lookup (surface_->size ());
   if (surface_ != input_ ||
       indices_->size () != surface_->size ())
-  { 
-    pcl::Indices nn_indices (k_); // \note These resizes are irrelevant for a radiusSearch ().
-    std::vector<float> nn_dists (k_); 
-
-    std::set<int> spfh_indices_set;
-    for (std::size_t idx = 0; idx < indices_->size (); ++idx)
-    {
-      int p_idx = (*indices_)[idx];
-      if (!isFinite ((*input_)[p_idx]) ||
-          this->searchForNeighbors (p_idx, search_parameter_, nn_indices, nn_dists) == 0)
-        continue;
-
-      spfh_indices_set.insert (nn_indices.begin (), nn_indices.end ());
-    }
-    spfh_indices_vec.resize (spfh_indices_set.size ());
-    std::copy (spfh_indices_set.cbegin (), spfh_indices_set.cend (), spfh_indices_vec.begin ());
+  {
+    std::vector<bool> needs_spfh (surface_->size (), false);
+    for (const auto &nn_indices : query_nn_indices)
+      for (const auto &nn_index : nn_indices)
+        needs_spfh[nn_index] = true;
+    for (std::size_t p_idx = 0; p_idx < needs_spfh.size (); ++p_idx)
+      if (needs_spfh[p_idx])
+        spfh_indices_vec.push_back (static_cast<int> (p_idx));
   }
   else
   {
@@ -97,56 +106,107 @@ pcl::FPFHEstimationOMP<PointInT, PointNT, PointOutT>::computeFeature (PointCloud
               static_cast<decltype(spfh_indices_vec)::value_type>(0));
   }
 
-  // Initialize the arrays that will store the SPFH signatures
-  const auto data_size = spfh_indices_vec.size ();
-  hist_f1_.setZero (data_size, nr_bins_f1_);
-  hist_f2_.setZero (data_size, nr_bins_f2_);
-  hist_f3_.setZero (data_size, nr_bins_f3_);
+  // The query point whose neighborhood is the SPFH neighborhood of a surface point, if any
+  std::vector<std::ptrdiff_t> query_of_point;
+  if (surface_ == input_)
+  {
+    query_of_point.assign (surface_->size (), -1);
+    for (std::size_t idx = 0; idx < indices_->size (); ++idx)
+      query_of_point[(*indices_)[idx]] = static_cast<std::ptrdiff_t> (idx);
+  }
+
+  // The SPFH signatures are stored row by row, followed by the sum of each of their sub-histograms
+  int nr_bins = nr_bins_f1_ + nr_bins_f2_ + nr_bins_f3_;
+  std::size_t row_size = nr_bins + 3;
+  std::vector<float> spfh_hist (spfh_indices_vec.size () * row_size, 0.0f);
 
   pcl::Indices nn_indices (k_); // \note These resizes are irrelevant for a radiusSearch ().
-  std::vector<float> nn_dists (k_); 
+  std::vector<float> nn_dists (k_);
+  std::vector<float> pair_data;
 
   // Compute SPFH signatures for every point that needs them
-
 #pragma omp parallel for \
   default(none) \
-  shared(spfh_hist_lookup, spfh_indices_vec) \
-  firstprivate(nn_indices, nn_dists) \
-  num_threads(threads_)
+  shared(spfh_hist_lookup, spfh_indices_vec, query_nn_indices, query_of_point, spfh_hist, nr_bins, row_size) \
+  firstprivate(nn_indices, nn_dists, pair_data) \
+  num_threads(threads)
   for (std::ptrdiff_t i = 0; i < static_cast<std::ptrdiff_t> (spfh_indices_vec.size ()); ++i)
   {
     // Get the next point index
     int p_idx = spfh_indices_vec[i];
 
     // Find the neighborhood around p_idx
-    if (!isFinite ((*surface_)[p_idx]) ||
-        this->searchForNeighbors (*surface_, p_idx, search_parameter_, nn_indices, nn_dists) == 0)
+    const pcl::Indices *neighbors = &nn_indices;
+    if (!query_of_point.empty () && query_of_point[p_idx] >= 0)
+    {
+      neighbors = &query_nn_indices[query_of_point[p_idx]];
+      if (neighbors->empty ())
+        continue;
+    }
+    else if (!isFinite ((*surface_)[p_idx]) ||
+             this->searchForNeighbors (*surface_, p_idx, search_parameter_, nn_indices, nn_dists) == 0)
       continue;
 
-    // Estimate the SPFH signature around p_idx
-    this->computePointSPFHSignature (*surface_, *normals_, p_idx, i, nn_indices, hist_f1_, hist_f2_, hist_f3_);
+    // Gather the neighbors, minus the point itself
+    const std::size_t nr_neighbors = neighbors->size ();
+    pair_data.resize (10 * nr_neighbors);
+    float *x = pair_data.data (), *y = x + nr_neighbors, *z = y + nr_neighbors;
+    float *nx = z + nr_neighbors, *ny = nx + nr_neighbors, *nz = ny + nr_neighbors;
+    float *f1 = nz + nr_neighbors, *f2 = f1 + nr_neighbors, *f3 = f2 + nr_neighbors, *f4 = f3 + nr_neighbors;
+    std::size_t nr_pairs = 0;
+    for (const auto &index : *neighbors)
+    {
+      if (index == p_idx)
+        continue;
+      x[nr_pairs] = (*surface_)[index].x;
+      y[nr_pairs] = (*surface_)[index].y;
+      z[nr_pairs] = (*surface_)[index].z;
+      nx[nr_pairs] = (*normals_)[index].normal_x;
+      ny[nr_pairs] = (*normals_)[index].normal_y;
+      nz[nr_pairs] = (*normals_)[index].normal_z;
+      ++nr_pairs;
+    }
+    pcl::computePairFeatures ((*surface_)[p_idx].getVector4fMap (), (*normals_)[p_idx].getNormalVector4fMap (),
+                              x, y, z, nx, ny, nz, nr_pairs, f1, f2, f3, f4);
 
-    // Populate a lookup table for converting a point index to its corresponding row in the spfh_hist_* matrices
+    // Normalize the f1, f2, f3 features and push them in the histogram
+    float *hist = &spfh_hist[i * row_size];
+    const float hist_incr = 100.0f / static_cast<float> (nr_neighbors - 1);
+    for (std::size_t j = 0; j < nr_pairs; ++j)
+    {
+      int h_index = static_cast<int> (std::floor (nr_bins_f1_ * ((f1[j] + M_PI) * this->d_pi_)));
+      if (h_index < 0)            h_index = 0;
+      if (h_index >= nr_bins_f1_) h_index = nr_bins_f1_ - 1;
+      hist[h_index] += hist_incr;
+
+      h_index = static_cast<int> (std::floor (nr_bins_f2_ * ((f2[j] + 1.0) * 0.5)));
+      if (h_index < 0)            h_index = 0;
+      if (h_index >= nr_bins_f2_) h_index = nr_bins_f2_ - 1;
+      hist[nr_bins_f1_ + h_index] += hist_incr;
+
+      h_index = static_cast<int> (std::floor (nr_bins_f3_ * ((f3[j] + 1.0) * 0.5)));
+      if (h_index < 0)            h_index = 0;
+      if (h_index >= nr_bins_f3_) h_index = nr_bins_f3_ - 1;
+      hist[nr_bins_f1_ + nr_bins_f2_ + h_index] += hist_incr;
+    }
+    hist[nr_bins] = std::accumulate (hist, hist + nr_bins_f1_, 0.0f);
+    hist[nr_bins + 1] = std::accumulate (hist + nr_bins_f1_, hist + nr_bins_f1_ + nr_bins_f2_, 0.0f);
+    hist[nr_bins + 2] = std::accumulate (hist + nr_bins_f1_ + nr_bins_f2_, hist + nr_bins, 0.0f);
+
+    // Populate a lookup table for converting a point index to its corresponding row in spfh_hist
     spfh_hist_lookup[p_idx] = i;
   }
 
-  // Initialize the array that will store the FPFH signature
-  int nr_bins = nr_bins_f1_ + nr_bins_f2_ + nr_bins_f3_;
-
-  nn_indices.clear();
-  nn_dists.clear();
-
   // Iterate over the entire index vector
 #pragma omp parallel for \
   default(none) \
-  shared(nr_bins, output, spfh_hist_lookup) \
-  firstprivate(nn_dists, nn_indices) \
-  num_threads(threads_)
+  shared(nr_bins, row_size, output, spfh_hist, spfh_hist_lookup, query_nn_indices, query_nn_dists) \
+  num_threads(threads)
   for (std::ptrdiff_t idx = 0; idx < static_cast<std::ptrdiff_t> (indices_->size ()); ++idx)
   {
-    // Find the indices of point idx's neighbors...
-    if (!isFinite ((*input_)[(*indices_)[idx]]) ||
-        this->searchForNeighbors ((*indices_)[idx], search_parameter_, nn_indices, nn_dists) == 0)
+    const pcl::Indices &neighbors = query_nn_indices[idx];
+    const std::vector<float> &dists = query_nn_dists[idx];
+    if (neighbors.empty ())
     {
       for (int d = 0; d < nr_bins; ++d)
         output[idx].histogram[d] = std::numeric_limits<float>::quiet_NaN ();
@@ -155,21 +215,40 @@ pcl::FPFHEstimationOMP<PointInT, PointNT, PointOutT>::computeFeature (PointCloud
       continue;
     }
 
+    // Compute the FPFH signature as a weighted combination of the SPFH signatures of the neighbors...
+    float *fpfh_histogram = output[idx].histogram;
+    std::fill (fpfh_histogram, fpfh_histogram + nr_bins, 0.0f);
+    double sum_f1 = 0.0, sum_f2 = 0.0, sum_f3 = 0.0;
+    for (std::size_t j = 0; j < neighbors.size (); ++j)
+    {
+      // Minus the query point itself
+      if (dists[j] == 0)
+        continue;
 
-    // ... and remap the nn_indices values so that they represent row indices in the spfh_hist_* matrices 
-    // instead of indices into surface_->points
-    for (auto &nn_index : nn_indices)
-      nn_index = spfh_hist_lookup[nn_index];
-
-    // Compute the FPFH signature (i.e. compute a weighted combination of local SPFH signatures) ...
-    Eigen::VectorXf fpfh_histogram = Eigen::VectorXf::Zero (nr_bins);
-    weightPointSPFHSignature (hist_f1_, hist_f2_, hist_f3_, nn_indices, nn_dists, fpfh_histogram);
+      // Standard weighting function used
+      const float weight = 1.0f / dists[j];
+      const float *hist = &spfh_hist[spfh_hist_lookup[neighbors[j]] * row_size];
+      for (int d = 0; d < nr_bins; ++d)
+        fpfh_histogram[d] += hist[d] * weight;
+      sum_f1 += hist[nr_bins] * weight;
+      sum_f2 += hist[nr_bins + 1] * weight;
+      sum_f3 += hist[nr_bins + 2] * weight;
+    }
 
-    // ...and copy it into the output cloud
-    for (int d = 0; d < nr_bins; ++d)
-      output[idx].histogram[d] = fpfh_histogram[d];
+    // ... so that the values of each feature sum up to 100
+    if (sum_f1 != 0)
+      sum_f1 = 100.0 / sum_f1;
+    if (sum_f2 != 0)
+      sum_f2 = 100.0 / sum_f2;
+    if (sum_f3 != 0)
+      sum_f3 = 100.0 / sum_f3;
+    for (int d = 0; d < nr_bins_f1_; ++d)
+      fpfh_histogram[d] *= static_cast<float> (sum_f1);
+    for (int d = nr_bins_f1_; d < nr_bins_f1_ + nr_bins_f2_; ++d)
+      fpfh_histogram[d] *= static_cast<float> (sum_f2);
+    for (int d = nr_bins_f1_ + nr_bins_f2_; d < nr_bins; ++d)
+      fpfh_histogram[d] *= static_cast<float> (sum_f3);
   }
-
 }
 
 #define PCL_INSTANTIATE_FPFHEstimationOMP(T,NT,OutT) template class PCL_EXPORTS pcl::FPFHEstimationOMP<T,NT,OutT>;
@@ -0,0 +1,117 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2019-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <pcl/features/global_feature_batch.h>
+#include <pcl/common/execution_context.h>
+#include <pcl/common/io.h> // for copyPointCloud
+#include <pcl/search/kdtree.h> // for KdTree
+
+namespace pcl
+{
+  namespace detail
+  {
+    template <typename FeatureT, typename PointInT, typename PointOutT, typename SetClusterT> void
+    computeGlobalFeatures (const FeatureT &estimator,
+                           const std::vector<pcl::PointIndices> &clusters,
+                           std::vector<pcl::PointCloud<PointOutT>, Eigen::aligned_allocator<pcl::PointCloud<PointOutT> > > &descriptors,
+                           unsigned int nr_threads,
+                           const SetClusterT &set_cluster)
+    {
+      descriptors.resize (clusters.size ());
+      const pcl::ThreadReservation reservation (nr_threads);
+      unsigned int threads = reservation.getNumberOfThreads ();
+      const std::ptrdiff_t nr_clusters = static_cast<std::ptrdiff_t> (clusters.size ());
+#pragma omp parallel \
+  default(none) \
+  shared(estimator, clusters, descriptors, nr_clusters, set_cluster) \
+  num_threads(threads)
+      {
+        // The estimator of this thread, with its own search method and indices, reused for its clusters
+        FeatureT thread_estimator (estimator);
+        thread_estimator.setSearchMethod (typename pcl::search::Search<PointInT>::Ptr (new pcl::search::KdTree<PointInT>));
+        thread_estimator.setIndices (pcl::IndicesPtr ());
+        thread_estimator.setSearchSurface (typename pcl::PointCloud<PointInT>::ConstPtr ());
+
+#pragma omp for schedule(dynamic)
+        for (std::ptrdiff_t i = 0; i < nr_clusters; ++i)
+        {
+          set_cluster (thread_estimator, clusters[i]);
+          thread_estimator.compute (descriptors[i]);
+        }
+      }
+    }
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename FeatureT, typename PointInT, typename PointOutT> void
+pcl::computeGlobalFeatures (const FeatureT &estimator,
+                            const pcl::PointCloud<PointInT> &cloud,
+                            const std::vector<pcl::PointIndices> &clusters,
+                            std::vector<pcl::PointCloud<PointOutT>, Eigen::aligned_allocator<pcl::PointCloud<PointOutT> > > &descriptors,
+                            unsigned int nr_threads)
+{
+  pcl::detail::computeGlobalFeatures<FeatureT, PointInT> (estimator, clusters, descriptors, nr_threads,
+    [&cloud] (FeatureT &thread_estimator, const pcl::PointIndices &cluster)
+    {
+      typename pcl::PointCloud<PointInT>::Ptr cluster_cloud (new pcl::PointCloud<PointInT>);
+      pcl::copyPointCloud (cloud, cluster, *cluster_cloud);
+      thread_estimator.setInputCloud (cluster_cloud);
+    });
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename FeatureT, typename PointInT, typename PointNT, typename PointOutT> void
+pcl::computeGlobalFeatures (const FeatureT &estimator,
+                            const pcl::PointCloud<PointInT> &cloud,
+                            const pcl::PointCloud<PointNT> &normals,
+                            const std::vector<pcl::PointIndices> &clusters,
+                            std::vector<pcl::PointCloud<PointOutT>, Eigen::aligned_allocator<pcl::PointCloud<PointOutT> > > &descriptors,
+                            unsigned int nr_threads)
+{
+  pcl::detail::computeGlobalFeatures<FeatureT, PointInT> (estimator, clusters, descriptors, nr_threads,
+    [&cloud, &normals] (FeatureT &thread_estimator, const pcl::PointIndices &cluster)
+    {
+      typename pcl::PointCloud<PointInT>::Ptr cluster_cloud (new pcl::PointCloud<PointInT>);
+      pcl::copyPointCloud (cloud, cluster, *cluster_cloud);
+      typename pcl::PointCloud<PointNT>::Ptr cluster_normals (new pcl::PointCloud<PointNT>);
+      pcl::copyPointCloud (normals, cluster, *cluster_normals);
+      thread_estimator.setInputCloud (cluster_cloud);
+      thread_estimator.setInputNormals (cluster_normals);
+    });
+}
@@ -41,6 +41,9 @@
 #ifndef PCL_INTEGRAL_IMAGE2D_IMPL_H_
 #define PCL_INTEGRAL_IMAGE2D_IMPL_H_
 
+#include <pcl/common/execution_context.h>
+
+#include <algorithm>
 
 namespace pcl
 {
@@ -52,6 +55,14 @@ IntegralImage2D<DataType, Dimension>::setSecondOrderComputation (bool compute_se
 }
 
 
+template <typename DataType, unsigned Dimension> void
+IntegralImage2D<DataType, Dimension>::setNumberOfThreads (unsigned int nr_threads)
+{
+  // 0 is resolved against the budget of pcl::ExecutionContext at compute time
+  threads_ = nr_threads;
+}
+
+
 template <typename DataType, unsigned Dimension> void
 IntegralImage2D<DataType, Dimension>::setInput (const DataType * data, unsigned width,unsigned height, unsigned element_stride, unsigned row_stride)
 {
@@ -156,27 +167,44 @@ template <typename DataType, unsigned Dimension> void
 IntegralImage2D<DataType, Dimension>::computeIntegralImages (
     const DataType *data, unsigned row_stride, unsigned element_stride)
 {
-  ElementType* previous_row = &first_order_integral_image_[0];
-  ElementType* current_row  = previous_row + (width_ + 1);
-  *previous_row = ElementType::Zero(width_ + 1);
-
-  unsigned* count_previous_row = &finite_values_integral_image_[0];
-  unsigned* count_current_row  = count_previous_row + (width_ + 1);
-  memset (count_previous_row, 0, sizeof (unsigned) * (width_ + 1));
+  const pcl::ThreadReservation reservation (threads_);
+  const unsigned int threads = reservation.getNumberOfThreads ();
+  // The integral image is built in two passes: horizontal prefix sums for every row (rows are
+  // independent), followed by a vertical accumulation over contiguous blocks of columns.
+  unsigned stride = width_ + 1;
+  ElementType* first_order = &first_order_integral_image_[0];
+  unsigned* count = &finite_values_integral_image_[0];
+  SecondOrderType* second_order = nullptr;
+  if (compute_second_order_integral_images_)
+    second_order = &second_order_integral_image_[0];
+
+  for (unsigned colIdx = 0; colIdx < stride; ++colIdx)
+  {
+    first_order [colIdx].setZero ();
+    count [colIdx] = 0;
+    if (second_order)
+      second_order [colIdx].setZero ();
+  }
 
-  if (!compute_second_order_integral_images_)
+#pragma omp parallel for \
+  default(none) \
+  shared(data, row_stride, element_stride, first_order, count, second_order, stride) \
+  num_threads(threads)
+  for (int rowIdx = 0; rowIdx < static_cast<int> (height_); ++rowIdx)
   {
-    for (unsigned rowIdx = 0; rowIdx < height_; ++rowIdx, data += row_stride,
-                                                previous_row = current_row, current_row += (width_ + 1),
-                                                count_previous_row = count_current_row, count_current_row += (width_ + 1))
+    const DataType* row_data = data + static_cast<std::size_t> (rowIdx) * row_stride;
+    ElementType* current_row = first_order + static_cast<std::size_t> (rowIdx + 1) * stride;
+    unsigned* count_current_row = count + static_cast<std::size_t> (rowIdx + 1) * stride;
+    current_row [0].setZero ();
+    count_current_row [0] = 0;
+
+    if (!second_order)
     {
-      current_row [0].setZero ();
-      count_current_row [0] = 0;
       for (unsigned colIdx = 0, valIdx = 0; colIdx < width_; ++colIdx, valIdx += element_stride)
       {
-        current_row [colIdx + 1] = previous_row [colIdx + 1] + current_row [colIdx] - previous_row [colIdx];
-        count_current_row [colIdx + 1] = count_previous_row [colIdx + 1] + count_current_row [colIdx] - count_previous_row [colIdx];
-        const InputType* element = reinterpret_cast <const InputType*> (&data [valIdx]);
+        current_row [colIdx + 1] = current_row [colIdx];
+        count_current_row [colIdx + 1] = count_current_row [colIdx];
+        const InputType* element = reinterpret_cast <const InputType*> (&row_data [valIdx]);
         if (std::isfinite (element->sum ()))
         {
           current_row [colIdx + 1] += element->template cast<typename IntegralImageTypeTraits<DataType>::IntegralType>();
@@ -184,29 +212,16 @@ IntegralImage2D<DataType, Dimension>::computeIntegralImages (
         }
       }
     }
-  }
-  else
-  {
-    SecondOrderType* so_previous_row = &second_order_integral_image_[0];
-    SecondOrderType* so_current_row  = so_previous_row + (width_ + 1);
-    *so_previous_row = SecondOrderType::Zero(width_ + 1);
-
-    SecondOrderType so_element;
-    for (unsigned rowIdx = 0; rowIdx < height_; ++rowIdx, data += row_stride,
-                                                previous_row = current_row, current_row += (width_ + 1),
-                                                count_previous_row = count_current_row, count_current_row += (width_ + 1),
-                                                so_previous_row = so_current_row, so_current_row += (width_ + 1))
+    else
     {
-      current_row [0].setZero ();
+      SecondOrderType* so_current_row = second_order + static_cast<std::size_t> (rowIdx + 1) * stride;
       so_current_row [0].setZero ();
-      count_current_row [0] = 0;
       for (unsigned colIdx = 0, valIdx = 0; colIdx < width_; ++colIdx, valIdx += element_stride)
       {
-        current_row [colIdx + 1] = previous_row [colIdx + 1] + current_row [colIdx] - previous_row [colIdx];
-        so_current_row [colIdx + 1] = so_previous_row [colIdx + 1] + so_current_row [colIdx] - so_previous_row [colIdx];
-        count_current_row [colIdx + 1] = count_previous_row [colIdx + 1] + count_current_row [colIdx] - count_previous_row [colIdx];
-
-        const InputType* element = reinterpret_cast <const InputType*> (&data [valIdx]);
+        current_row [colIdx + 1] = current_row [colIdx];
+        so_current_row [colIdx + 1] = so_current_row [colIdx];
+        count_current_row [colIdx + 1] = count_current_row [colIdx];
+        const InputType* element = reinterpret_cast <const InputType*> (&row_data [valIdx]);
         if (std::isfinite (element->sum ()))
         {
           current_row [colIdx + 1] += element->template cast<typename IntegralImageTypeTraits<DataType>::IntegralType>();
@@ -218,6 +233,45 @@ IntegralImage2D<DataType, Dimension>::computeIntegralImages (
       }
     }
   }
+
+  int blocks = static_cast<int> (std::min (threads, stride));
+  unsigned block_size = (stride + blocks - 1) / blocks;
+#pragma omp parallel for \
+  default(none) \
+  shared(first_order, count, second_order, stride, blocks, block_size) \
+  num_threads(threads)
+  for (int block = 0; block < blocks; ++block)
+  {
+    const unsigned begin = block * block_size;
+    const unsigned end = std::min (begin + block_size, stride);
+    for (unsigned rowIdx = 2; rowIdx <= height_; ++rowIdx)
+    {
+      ElementType* current_row = first_order + static_cast<std::size_t> (rowIdx) * stride;
+      const ElementType* previous_row = current_row - stride;
+      unsigned* count_current_row = count + static_cast<std::size_t> (rowIdx) * stride;
+      const unsigned* count_previous_row = count_current_row - stride;
+      for (unsigned colIdx = begin; colIdx < end; ++colIdx)
+      {
+        current_row [colIdx] += previous_row [colIdx];
+        count_current_row [colIdx] += count_previous_row [colIdx];
+      }
+      if (second_order)
+      {
+        SecondOrderType* so_current_row = second_order + static_cast<std::size_t> (rowIdx) * stride;
+        const SecondOrderType* so_previous_row = so_current_row - stride;
+        for (unsigned colIdx = begin; colIdx < end; ++colIdx)
+          so_current_row [colIdx] += so_previous_row [colIdx];
+      }
+    }
+  }
+}
+
+
+template <typename DataType> void
+IntegralImage2D<DataType, 1>::setNumberOfThreads (unsigned int nr_threads)
+{
+  // 0 is resolved against the budget of pcl::ExecutionContext at compute time
+  threads_ = nr_threads;
 }
 
 
@@ -325,62 +379,94 @@ template <typename DataType> void
 IntegralImage2D<DataType, 1>::computeIntegralImages (
     const DataType *data, unsigned row_stride, unsigned element_stride)
 {
-  ElementType* previous_row = &first_order_integral_image_[0];
-  ElementType* current_row  = previous_row + (width_ + 1);
-  memset (previous_row, 0, sizeof (ElementType) * (width_ + 1));
-
-  unsigned* count_previous_row = &finite_values_integral_image_[0];
-  unsigned* count_current_row  = count_previous_row + (width_ + 1);
-  memset (count_previous_row, 0, sizeof (unsigned) * (width_ + 1));
-
-  if (!compute_second_order_integral_images_)
+  const pcl::ThreadReservation reservation (threads_);
+  const unsigned int threads = reservation.getNumberOfThreads ();
+  unsigned stride = width_ + 1;
+  ElementType* first_order = &first_order_integral_image_[0];
+  unsigned* count = &finite_values_integral_image_[0];
+  SecondOrderType* second_order = nullptr;
+  if (compute_second_order_integral_images_)
+    second_order = &second_order_integral_image_[0];
+
+  std::fill_n (first_order, stride, ElementType (0));
+  std::fill_n (count, stride, 0u);
+  if (second_order)
+    std::fill_n (second_order, stride, SecondOrderType (0));
+
+#pragma omp parallel for \
+  default(none) \
+  shared(data, row_stride, element_stride, first_order, count, second_order, stride) \
+  num_threads(threads)
+  for (int rowIdx = 0; rowIdx < static_cast<int> (height_); ++rowIdx)
   {
-    for (unsigned rowIdx = 0; rowIdx < height_; ++rowIdx, data += row_stride,
-                                                previous_row = current_row, current_row += (width_ + 1),
-                                                count_previous_row = count_current_row, count_current_row += (width_ + 1))
+    const DataType* row_data = data + static_cast<std::size_t> (rowIdx) * row_stride;
+    ElementType* current_row = first_order + static_cast<std::size_t> (rowIdx + 1) * stride;
+    unsigned* count_current_row = count + static_cast<std::size_t> (rowIdx + 1) * stride;
+    current_row [0] = 0;
+    count_current_row [0] = 0;
+
+    if (!second_order)
     {
-      current_row [0] = 0.0;
-      count_current_row [0] = 0;
       for (unsigned colIdx = 0, valIdx = 0; colIdx < width_; ++colIdx, valIdx += element_stride)
       {
-        current_row [colIdx + 1] = previous_row [colIdx + 1] + current_row [colIdx] - previous_row [colIdx];
-        count_current_row [colIdx + 1] = count_previous_row [colIdx + 1] + count_current_row [colIdx] - count_previous_row [colIdx];
-        if (std::isfinite (data [valIdx]))
+        current_row [colIdx + 1] = current_row [colIdx];
+        count_current_row [colIdx + 1] = count_current_row [colIdx];
+        if (std::isfinite (row_data [valIdx]))
         {
-          current_row [colIdx + 1] += data [valIdx];
+          current_row [colIdx + 1] += row_data [valIdx];
           ++(count_current_row [colIdx + 1]);
         }
       }
     }
-  }
-  else
-  {
-    SecondOrderType* so_previous_row = &second_order_integral_image_[0];
-    SecondOrderType* so_current_row  = so_previous_row + (width_ + 1);
-    memset (so_previous_row, 0, sizeof (SecondOrderType) * (width_ + 1));
-
-    for (unsigned rowIdx = 0; rowIdx < height_; ++rowIdx, data += row_stride,
-                                                previous_row = current_row, current_row += (width_ + 1),
-                                                count_previous_row = count_current_row, count_current_row += (width_ + 1),
-                                                so_previous_row = so_current_row, so_current_row += (width_ + 1))
+    else
     {
-      current_row [0] = 0.0;
-      so_current_row [0] = 0.0;
-      count_current_row [0] = 0;
+      SecondOrderType* so_current_row = second_order + static_cast<std::size_t> (rowIdx + 1) * stride;
+      so_current_row [0] = 0;
       for (unsigned colIdx = 0, valIdx = 0; colIdx < width_; ++colIdx, valIdx += element_stride)
       {
-        current_row [colIdx + 1] = previous_row [colIdx + 1] + current_row [colIdx] - previous_row [colIdx];
-        so_current_row [colIdx + 1] = so_previous_row [colIdx + 1] + so_current_row [colIdx] - so_previous_row [colIdx];
-        count_current_row [colIdx + 1] = count_previous_row [colIdx + 1] + count_current_row [colIdx] - count_previous_row [colIdx];
-        if (std::isfinite (data[valIdx]))
+        current_row [colIdx + 1] = current_row [colIdx];
+        so_current_row [colIdx + 1] = so_current_row [colIdx];
+        count_current_row [colIdx + 1] = count_current_row [colIdx];
+        if (std::isfinite (row_data [valIdx]))
         {
-          current_row [colIdx + 1] += data[valIdx];
-          so_current_row [colIdx + 1] += data[valIdx] * data[valIdx];
+          current_row [colIdx + 1] += row_data [valIdx];
+          so_current_row [colIdx + 1] += row_data [valIdx] * row_data [valIdx];
           ++(count_current_row [colIdx + 1]);
         }
       }
     }
   }
+
+  int blocks = static_cast<int> (std::min (threads, stride));
+  unsigned block_size = (stride + blocks - 1) / blocks;
+#pragma omp parallel for \
+  default(none) \
+  shared(first_order, count, second_order, stride, blocks, block_size) \
+  num_threads(threads)
+  for (int block = 0; block < blocks; ++block)
+  {
+    const unsigned begin = block * block_size;
+    const unsigned end = std::min (begin + block_size, stride);
+    for (unsigned rowIdx = 2; rowIdx <= height_; ++rowIdx)
+    {
+      ElementType* current_row = first_order + static_cast<std::size_t> (rowIdx) * stride;
+      const ElementType* previous_row = current_row - stride;
+      unsigned* count_current_row = count + static_cast<std::size_t> (rowIdx) * stride;
+      const unsigned* count_previous_row = count_current_row - stride;
+      for (unsigned colIdx = begin; colIdx < end; ++colIdx)
+      {
+        current_row [colIdx] += previous_row [colIdx];
+        count_current_row [colIdx] += count_previous_row [colIdx];
+      }
+      if (second_order)
+      {
+        SecondOrderType* so_current_row = second_order + static_cast<std::size_t> (rowIdx) * stride;
+        const SecondOrderType* so_previous_row = so_current_row - stride;
+        for (unsigned colIdx = begin; colIdx < end; ++colIdx)
+          so_current_row [colIdx] += so_previous_row [colIdx];
+      }
+    }
+  }
 }
 
 } // namespace pcl
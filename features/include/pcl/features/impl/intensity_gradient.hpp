@@ -41,6 +41,7 @@
 #pragma once
 
 #include <pcl/features/intensity_gradient.h>
+#include <pcl/common/execution_context.h>
 
 #include <pcl/common/point_tests.h> // for pcl::isFinite
 
@@ -142,6 +143,8 @@ pcl::IntensityGradientEstimation <PointInT, PointNT, PointOutT, IntensitySelecto
 template <typename PointInT, typename PointNT, typename PointOutT, typename IntensitySelectorT> void
 pcl::IntensityGradientEstimation<PointInT, PointNT, PointOutT, IntensitySelectorT>::computeFeature (PointCloudOut &output)
 {
+  const pcl::ThreadReservation reservation (threads_);
+  const unsigned int threads = reservation.getNumberOfThreads ();
   // Allocate enough space to hold the results
   // \note This resize is irrelevant for a radiusSearch ().
   pcl::Indices nn_indices (k_);
@@ -155,7 +158,7 @@ pcl::IntensityGradientEstimation<PointInT, PointNT, PointOutT, IntensitySelector
   default(none) \
   shared(output) \
   firstprivate(nn_indices, nn_dists) \
-  num_threads(threads_)
+  num_threads(threads)
     // Iterating over the entire index vector
     for (std::ptrdiff_t idx = 0; idx < static_cast<std::ptrdiff_t> (indices_->size ()); ++idx)
     {
@@ -195,7 +198,7 @@ pcl::IntensityGradientEstimation<PointInT, PointNT, PointOutT, IntensitySelector
   default(none) \
   shared(output) \
   firstprivate(nn_indices, nn_dists) \
-  num_threads(threads_)
+  num_threads(threads)
     // Iterating over the entire index vector
     for (std::ptrdiff_t idx = 0; idx < static_cast<std::ptrdiff_t> (indices_->size ()); ++idx)
     {
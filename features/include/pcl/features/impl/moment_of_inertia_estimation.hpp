@@ -44,6 +44,7 @@
 
 #include <pcl/features/moment_of_inertia_estimation.h>
 #include <pcl/features/feature.h>
+#include <pcl/common/execution_context.h>
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointT>
@@ -52,6 +53,8 @@ pcl::MomentOfInertiaEstimation<PointT>::MomentOfInertiaEstimation () :
   step_ (10.0f),
   point_mass_ (0.0001f),
   normalize_ (true),
+  use_second_moments_ (false),
+  threads_ (0),
   mean_value_ (0.0f, 0.0f, 0.0f),
   major_axis_ (0.0f, 0.0f, 0.0f),
   middle_axis_ (0.0f, 0.0f, 0.0f),
@@ -129,6 +132,30 @@ pcl::MomentOfInertiaEstimation<PointT>::getPointMass () const
   return (point_mass_);
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::MomentOfInertiaEstimation<PointT>::setUseSecondMoments (bool use_second_moments)
+{
+  use_second_moments_ = use_second_moments;
+
+  is_valid_ = false;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> bool
+pcl::MomentOfInertiaEstimation<PointT>::getUseSecondMoments () const
+{
+  return (use_second_moments_);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::MomentOfInertiaEstimation<PointT>::setNumberOfThreads (unsigned int nr_threads)
+{
+  // 0 is resolved against the budget of pcl::ExecutionContext at compute time
+  threads_ = nr_threads;
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointT> void
 pcl::MomentOfInertiaEstimation<PointT>::compute ()
@@ -150,11 +177,25 @@ pcl::MomentOfInertiaEstimation<PointT>::compute ()
       point_mass_ = 1.0f;
   }
 
-  computeMeanValue ();
+  // The passes over the cloud only run in parallel in the second moments mode
+  const pcl::ThreadReservation reservation (use_second_moments_ ? threads_ : 1);
+  unsigned int threads = reservation.getNumberOfThreads ();
 
   Eigen::Matrix <float, 3, 3> covariance_matrix;
-  covariance_matrix.setZero ();
-  computeCovarianceMatrix (covariance_matrix);
+  Eigen::Matrix <float, 3, 3> scatter_matrix;
+  if (use_second_moments_)
+  {
+    computeMeanValueAndScatterMatrix (scatter_matrix, threads);
+    const std::size_t number_of_points = indices_->size ();
+    covariance_matrix = scatter_matrix / static_cast <float> (number_of_points > 1 ? number_of_points - 1 : 1);
+  }
+  else
+  {
+    computeMeanValue ();
+
+    covariance_matrix.setZero ();
+    computeCovarianceMatrix (covariance_matrix);
+  }
 
   computeEigenVectors (covariance_matrix, major_axis_, middle_axis_, minor_axis_, major_value_, middle_value_, minor_value_);
 
@@ -170,6 +211,20 @@ pcl::MomentOfInertiaEstimation<PointT>::compute ()
       rotateVector (rotated_vector, minor_axis_, phi, current_axis);
       current_axis.normalize ();
 
+      if (use_second_moments_)
+      {
+        //the squared distances to the axis sum up to trace (S) - a^T S a
+        moment_of_inertia_.push_back (point_mass_ * (scatter_matrix.trace () - current_axis.dot (scatter_matrix * current_axis)));
+
+        //the covariance matrix of the cloud projected on the plane is P C P with P = I - a a^T
+        const Eigen::Matrix <float, 3, 3> projection = Eigen::Matrix <float, 3, 3>::Identity () - current_axis * current_axis.transpose ();
+        const Eigen::Matrix <float, 3, 3> projected_covariance_matrix = projection * covariance_matrix * projection;
+        eccentricity_.push_back (computeEccentricity (projected_covariance_matrix, current_axis));
+
+        phi += step_;
+        continue;
+      }
+
       //compute moment of inertia for the current axis
       float current_moment_of_inertia = calculateMomentOfInertia (current_axis, mean_value_);
       moment_of_inertia_.push_back (current_moment_of_inertia);
@@ -189,7 +244,7 @@ pcl::MomentOfInertiaEstimation<PointT>::compute ()
     theta += step_;
   }
 
-  computeOBB ();
+  computeOBB (threads);
 
   is_valid_ = true;
 
@@ -222,38 +277,53 @@ pcl::MomentOfInertiaEstimation<PointT>::getOBB (PointT& min_point, PointT& max_p
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointT> void
-pcl::MomentOfInertiaEstimation<PointT>::computeOBB ()
+pcl::MomentOfInertiaEstimation<PointT>::computeOBB (unsigned int nr_threads)
 {
-  obb_min_point_.x = std::numeric_limits <float>::max ();
-  obb_min_point_.y = std::numeric_limits <float>::max ();
-  obb_min_point_.z = std::numeric_limits <float>::max ();
-
-  obb_max_point_.x = std::numeric_limits <float>::min ();
-  obb_max_point_.y = std::numeric_limits <float>::min ();
-  obb_max_point_.z = std::numeric_limits <float>::min ();
-
-  unsigned int number_of_points = static_cast <unsigned int> (indices_->size ());
-  for (unsigned int i_point = 0; i_point < number_of_points; i_point++)
+  float min_x = std::numeric_limits <float>::max ();
+  float min_y = std::numeric_limits <float>::max ();
+  float min_z = std::numeric_limits <float>::max ();
+
+  float max_x = std::numeric_limits <float>::min ();
+  float max_y = std::numeric_limits <float>::min ();
+  float max_z = std::numeric_limits <float>::min ();
+
+  const std::ptrdiff_t number_of_points = static_cast <std::ptrdiff_t> (indices_->size ());
+#pragma omp parallel for \
+  default(none) \
+  shared(number_of_points) \
+  reduction(min:min_x, min_y, min_z) \
+  reduction(max:max_x, max_y, max_z) \
+  num_threads(nr_threads)
+  for (std::ptrdiff_t i_point = 0; i_point < number_of_points; i_point++)
   {
-    float x = ((*input_)[(*indices_)[i_point]].x - mean_value_ (0)) * major_axis_ (0) +
-              ((*input_)[(*indices_)[i_point]].y - mean_value_ (1)) * major_axis_ (1) +
-              ((*input_)[(*indices_)[i_point]].z - mean_value_ (2)) * major_axis_ (2);
-    float y = ((*input_)[(*indices_)[i_point]].x - mean_value_ (0)) * middle_axis_ (0) +
-              ((*input_)[(*indices_)[i_point]].y - mean_value_ (1)) * middle_axis_ (1) +
-              ((*input_)[(*indices_)[i_point]].z - mean_value_ (2)) * middle_axis_ (2);
-    float z = ((*input_)[(*indices_)[i_point]].x - mean_value_ (0)) * minor_axis_ (0) +
-              ((*input_)[(*indices_)[i_point]].y - mean_value_ (1)) * minor_axis_ (1) +
-              ((*input_)[(*indices_)[i_point]].z - mean_value_ (2)) * minor_axis_ (2);
-
-    if (x <= obb_min_point_.x) obb_min_point_.x = x;
-    if (y <= obb_min_point_.y) obb_min_point_.y = y;
-    if (z <= obb_min_point_.z) obb_min_point_.z = z;
-
-    if (x >= obb_max_point_.x) obb_max_point_.x = x;
-    if (y >= obb_max_point_.y) obb_max_point_.y = y;
-    if (z >= obb_max_point_.z) obb_max_point_.z = z;
+    const PointT& point = (*input_)[(*indices_)[i_point]];
+    const float x = (point.x - mean_value_ (0)) * major_axis_ (0) +
+                    (point.y - mean_value_ (1)) * major_axis_ (1) +
+                    (point.z - mean_value_ (2)) * major_axis_ (2);
+    const float y = (point.x - mean_value_ (0)) * middle_axis_ (0) +
+                    (point.y - mean_value_ (1)) * middle_axis_ (1) +
+                    (point.z - mean_value_ (2)) * middle_axis_ (2);
+    const float z = (point.x - mean_value_ (0)) * minor_axis_ (0) +
+                    (point.y - mean_value_ (1)) * minor_axis_ (1) +
+                    (point.z - mean_value_ (2)) * minor_axis_ (2);
+
+    min_x = std::min (min_x, x);
+    min_y = std::min (min_y, y);
+    min_z = std::min (min_z, z);
+
+    max_x = std::max (max_x, x);
+    max_y = std::max (max_y, y);
+    max_z = std::max (max_z, z);
   }
 
+  obb_min_point_.x = min_x;
+  obb_min_point_.y = min_y;
+  obb_min_point_.z = min_z;
+
+  obb_max_point_.x = max_x;
+  obb_max_point_.y = max_y;
+  obb_max_point_.z = max_z;
+
   obb_rotational_matrix_ << major_axis_ (0), middle_axis_ (0), minor_axis_ (0),
                             major_axis_ (1), middle_axis_ (1), minor_axis_ (1),
                             major_axis_ (2), middle_axis_ (2), minor_axis_ (2);
@@ -356,6 +426,72 @@ pcl::MomentOfInertiaEstimation<PointT>::computeMeanValue ()
   mean_value_ (2) /= number_of_points;
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::MomentOfInertiaEstimation<PointT>::computeMeanValueAndScatterMatrix (Eigen::Matrix <float, 3, 3>& scatter_matrix, unsigned int nr_threads)
+{
+  const std::ptrdiff_t number_of_points = static_cast <std::ptrdiff_t> (indices_->size ());
+
+  // The sums are taken relative to the first point, which keeps them small for clouds far from the origin
+  Eigen::Vector3d shift (0.0, 0.0, 0.0);
+  if (number_of_points > 0)
+    shift = (*input_)[(*indices_)[0]].getVector3fMap ().template cast <double> ();
+
+  double sx = 0.0, sy = 0.0, sz = 0.0;
+  double sxx = 0.0, sxy = 0.0, sxz = 0.0, syy = 0.0, syz = 0.0, szz = 0.0;
+  float min_x = std::numeric_limits <float>::max ();
+  float min_y = std::numeric_limits <float>::max ();
+  float min_z = std::numeric_limits <float>::max ();
+  float max_x = -std::numeric_limits <float>::max ();
+  float max_y = -std::numeric_limits <float>::max ();
+  float max_z = -std::numeric_limits <float>::max ();
+
+#pragma omp parallel for \
+  default(none) \
+  shared(number_of_points, shift) \
+  reduction(+:sx, sy, sz, sxx, sxy, sxz, syy, syz, szz) \
+  reduction(min:min_x, min_y, min_z) \
+  reduction(max:max_x, max_y, max_z) \
+  num_threads(nr_threads)
+  for (std::ptrdiff_t i_point = 0; i_point < number_of_points; i_point++)
+  {
+    const PointT& point = (*input_)[(*indices_)[i_point]];
+    const double x = point.x - shift (0);
+    const double y = point.y - shift (1);
+    const double z = point.z - shift (2);
+
+    sx += x; sy += y; sz += z;
+    sxx += x * x; sxy += x * y; sxz += x * z;
+    syy += y * y; syz += y * z; szz += z * z;
+
+    min_x = std::min (min_x, point.x);
+    min_y = std::min (min_y, point.y);
+    min_z = std::min (min_z, point.z);
+    max_x = std::max (max_x, point.x);
+    max_y = std::max (max_y, point.y);
+    max_z = std::max (max_z, point.z);
+  }
+
+  aabb_min_point_.x = min_x;
+  aabb_min_point_.y = min_y;
+  aabb_min_point_.z = min_z;
+  aabb_max_point_.x = max_x;
+  aabb_max_point_.y = max_y;
+  aabb_max_point_.z = max_z;
+
+  const double count = static_cast <double> (std::max <std::ptrdiff_t> (number_of_points, 1));
+  const Eigen::Vector3d mean (sx / count, sy / count, sz / count);
+  mean_value_ = (shift + mean).template cast <float> ();
+
+  // Sum of (p - m)(p - m)^T = sum of (p - s)(p - s)^T - n (m - s)(m - s)^T
+  Eigen::Matrix3d scatter;
+  scatter << sxx, sxy, sxz,
+             sxy, syy, syz,
+             sxz, syz, szz;
+  scatter -= static_cast <double> (number_of_points) * mean * mean.transpose ();
+  scatter_matrix = scatter.template cast <float> ();
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointT> void
 pcl::MomentOfInertiaEstimation<PointT>::computeCovarianceMatrix (Eigen::Matrix <float, 3, 3>& covariance_matrix) const
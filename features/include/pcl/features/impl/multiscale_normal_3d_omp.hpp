@@ -0,0 +1,196 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2019-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <pcl/features/multiscale_normal_3d_omp.h>
+#include <pcl/features/normal_3d.h>
+#include <pcl/common/centroid.h>
+#include <pcl/common/execution_context.h>
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointInT, typename PointNT, typename PointOutT> void
+pcl::MultiscaleNormalEstimationOMP<PointInT, PointNT, PointOutT>::setNumberOfThreads (unsigned int nr_threads)
+{
+  // 0 is resolved against the budget of pcl::ExecutionContext at compute time
+  threads_ = nr_threads;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointInT, typename PointNT, typename PointOutT> bool
+pcl::MultiscaleNormalEstimationOMP<PointInT, PointNT, PointOutT>::initCompute ()
+{
+  if (!Feature<PointInT, PointOutT>::initCompute ())
+  {
+    PCL_ERROR ("[pcl::%s::initCompute] Init failed.\n", getClassName ().c_str ());
+    return (false);
+  }
+
+  if (k_ != 0)
+  {
+    PCL_ERROR ("[pcl::%s::initCompute] Both scales need a radius search, use setRadii instead of setKSearch!\n", getClassName ().c_str ());
+    Feature<PointInT, PointOutT>::deinitCompute ();
+    return (false);
+  }
+
+  if (radius_small_ <= 0 || radius_small_ >= search_radius_)
+  {
+    PCL_ERROR ("[pcl::%s::initCompute] The small radius (%g) has to be positive and smaller than the large radius (%g)!\n",
+               getClassName ().c_str (), radius_small_, search_radius_);
+    Feature<PointInT, PointOutT>::deinitCompute ();
+    return (false);
+  }
+
+  return (true);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointInT, typename PointNT, typename PointOutT> void
+pcl::MultiscaleNormalEstimationOMP<PointInT, PointNT, PointOutT>::computeFeature (PointCloudOut &output)
+{
+  const pcl::ThreadReservation reservation (threads_);
+  unsigned int threads = reservation.getNumberOfThreads ();
+
+  // Fresh clouds, the ones of a previous call may still be used by the caller
+  normals_small_.reset (new PointCloudN);
+  normals_large_.reset (new PointCloudN);
+  PointCloudN* normals[2] = {normals_small_.get (), normals_large_.get ()};
+  for (PointCloudN* cloud : normals)
+  {
+    cloud->header = output.header;
+    cloud->resize (output.size ());
+    cloud->width = output.width;
+    cloud->height = output.height;
+  }
+
+  pcl::Indices nn_indices, nn_indices_small;
+  std::vector<float> nn_dists;
+  const float sqr_radius_small = static_cast<float> (radius_small_ * radius_small_);
+
+  bool is_dense_small = true, is_dense_large = true;
+  std::ptrdiff_t nr_points = static_cast<std::ptrdiff_t> (indices_->size ());
+  std::ptrdiff_t nr_batches = (nr_points + batch_size_ - 1) / batch_size_;
+#pragma omp parallel for \
+  default(none) \
+  shared(output, normals, nr_points, nr_batches, sqr_radius_small) \
+  firstprivate(nn_indices, nn_indices_small, nn_dists) \
+  reduction(&&:is_dense_small, is_dense_large) \
+  num_threads(threads)
+  // The covariance matrices of a batch of points are collected for both scales, then solved together
+  for (std::ptrdiff_t batch = 0; batch < nr_batches; ++batch)
+  {
+    float xx[2][batch_size_], xy[2][batch_size_], xz[2][batch_size_], yy[2][batch_size_], yz[2][batch_size_], zz[2][batch_size_];
+    float nx[2][batch_size_], ny[2][batch_size_], nz[2][batch_size_], curvature[2][batch_size_];
+    std::ptrdiff_t batch_indices[2][batch_size_];
+    std::size_t count[2] = {0, 0};
+
+    const std::ptrdiff_t begin = batch * batch_size_;
+    const std::ptrdiff_t end = std::min (nr_points, begin + batch_size_);
+    for (std::ptrdiff_t idx = begin; idx < end; ++idx)
+    {
+      // Save a few cycles by not checking every point for NaN/Inf values if the cloud is set to dense
+      if ((!input_->is_dense && !isFinite ((*input_)[(*indices_)[idx]])) ||
+          this->searchForNeighbors ((*indices_)[idx], search_parameter_, nn_indices, nn_dists) == 0)
+        nn_indices.clear ();
+
+      // The neighborhood at the small radius is a subset of the one at the large radius
+      nn_indices_small.clear ();
+      for (std::size_t i = 0; i < nn_indices.size (); ++i)
+        if (nn_dists[i] <= sqr_radius_small)
+          nn_indices_small.push_back (nn_indices[i]);
+
+      const pcl::Indices* neighborhoods[2] = {&nn_indices_small, &nn_indices};
+      for (int scale = 0; scale < 2; ++scale)
+      {
+        EIGEN_ALIGN16 Eigen::Matrix3f covariance_matrix;
+        Eigen::Vector4f xyz_centroid;
+        if (neighborhoods[scale]->size () < 3 ||
+            computeMeanAndCovarianceMatrix (*surface_, *neighborhoods[scale], covariance_matrix, xyz_centroid) == 0)
+        {
+          PointNT &normal = (*normals[scale])[idx];
+          normal.normal[0] = normal.normal[1] = normal.normal[2] = normal.curvature = std::numeric_limits<float>::quiet_NaN ();
+          (scale == 0 ? is_dense_small : is_dense_large) = false;
+          continue;
+        }
+
+        const std::size_t i = count[scale]++;
+        xx[scale][i] = covariance_matrix.coeff (0, 0);
+        xy[scale][i] = covariance_matrix.coeff (0, 1);
+        xz[scale][i] = covariance_matrix.coeff (0, 2);
+        yy[scale][i] = covariance_matrix.coeff (1, 1);
+        yz[scale][i] = covariance_matrix.coeff (1, 2);
+        zz[scale][i] = covariance_matrix.coeff (2, 2);
+        batch_indices[scale][i] = idx;
+      }
+    }
+
+    for (int scale = 0; scale < 2; ++scale)
+    {
+      solvePlaneParameters (xx[scale], xy[scale], xz[scale], yy[scale], yz[scale], zz[scale], count[scale],
+                            nx[scale], ny[scale], nz[scale], curvature[scale]);
+
+      for (std::size_t i = 0; i < count[scale]; ++i)
+      {
+        const std::ptrdiff_t idx = batch_indices[scale][i];
+        PointNT &normal = (*normals[scale])[idx];
+        normal.normal_x = nx[scale][i];
+        normal.normal_y = ny[scale][i];
+        normal.normal_z = nz[scale][i];
+        normal.curvature = curvature[scale][i];
+
+        flipNormalTowardsViewpoint ((*input_)[(*indices_)[idx]], vpx_, vpy_, vpz_,
+                                    normal.normal[0], normal.normal[1], normal.normal[2]);
+      }
+    }
+
+    // DoN subtraction, as in DifferenceOfNormalsEstimation
+    for (std::ptrdiff_t idx = begin; idx < end; ++idx)
+    {
+      output[idx].getNormalVector3fMap () = ((*normals[0])[idx].getNormalVector3fMap ()
+                                             - (*normals[1])[idx].getNormalVector3fMap ()) / 2.0;
+      if (!std::isfinite (output[idx].normal_x) ||
+          !std::isfinite (output[idx].normal_y) ||
+          !std::isfinite (output[idx].normal_z))
+        output[idx].getNormalVector3fMap () = Eigen::Vector3f (0, 0, 0);
+      output[idx].curvature = output[idx].getNormalVector3fMap ().norm ();
+    }
+  }
+
+  normals_small_->is_dense = is_dense_small;
+  normals_large_->is_dense = is_dense_large;
+}
+
+#define PCL_INSTANTIATE_MultiscaleNormalEstimationOMP(T,NT,OutT) template class PCL_EXPORTS pcl::MultiscaleNormalEstimationOMP<T,NT,OutT>;
@@ -0,0 +1,105 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#pragma once
+
+#include <pcl/features/neighborhood_cache.h>
+#include <pcl/common/execution_context.h>
+
+///////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::NeighborhoodCache::compute (const pcl::search::Search<PointT> &search, const pcl::PointCloud<PointT> &cloud,
+                                 const pcl::Indices &indices, double radius, int k)
+{
+  clear ();
+  if ((radius == 0.0) == (k == 0))
+  {
+    PCL_ERROR ("[pcl::NeighborhoodCache::compute] Exactly one of radius (%f) and K (%d) must be non-zero!\n", radius, k);
+    return;
+  }
+  const auto &surface = search.getInputCloud ();
+  if (!surface)
+  {
+    PCL_ERROR ("[pcl::NeighborhoodCache::compute] The search method has no input cloud!\n");
+    return;
+  }
+
+  const pcl::ThreadReservation reservation (threads_);
+  const unsigned int threads = reservation.getNumberOfThreads ();
+  // Search the neighborhoods in parallel, then pack them into one array
+  std::vector<pcl::Indices> nn_indices (indices.size ());
+  std::vector<std::vector<float> > nn_dists (indices.size ());
+#pragma omp parallel for \
+  default(none) \
+  shared(search, cloud, indices, radius, k, nn_indices, nn_dists) \
+  num_threads(threads)
+  for (std::ptrdiff_t idx = 0; idx < static_cast<std::ptrdiff_t> (indices.size ()); ++idx)
+  {
+    if (radius != 0.0)
+      search.radiusSearch (cloud, indices[idx], radius, nn_indices[idx], nn_dists[idx], 0);
+    else
+      search.nearestKSearch (cloud, indices[idx], k, nn_indices[idx], nn_dists[idx]);
+  }
+
+  computed_.assign (cloud.size (), false);
+  std::vector<std::size_t> sizes (cloud.size (), 0);
+  for (std::size_t idx = 0; idx < indices.size (); ++idx)
+  {
+    computed_[indices[idx]] = true;
+    sizes[indices[idx]] = nn_indices[idx].size ();
+  }
+
+  offsets_.resize (cloud.size () + 1);
+  offsets_[0] = 0;
+  for (std::size_t i = 0; i < cloud.size (); ++i)
+    offsets_[i + 1] = offsets_[i] + sizes[i];
+
+  indices_.resize (offsets_.back ());
+  distances_.resize (offsets_.back ());
+  for (std::size_t idx = 0; idx < indices.size (); ++idx)
+  {
+    std::copy (nn_indices[idx].begin (), nn_indices[idx].end (), indices_.begin () + offsets_[indices[idx]]);
+    std::copy (nn_dists[idx].begin (), nn_dists[idx].end (), distances_.begin () + offsets_[indices[idx]]);
+  }
+
+  cloud_ = &cloud;
+  cloud_size_ = cloud.size ();
+  surface_ = surface.get ();
+  surface_size_ = surface->size ();
+  radius_ = radius;
+  k_ = k;
+}
@@ -42,45 +42,53 @@
 #define PCL_FEATURES_IMPL_NORMAL_3D_OMP_H_
 
 #include <pcl/features/normal_3d_omp.h>
+#include <pcl/common/execution_context.h>
 
 ///////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointInT, typename PointOutT> void
 pcl::NormalEstimationOMP<PointInT, PointOutT>::setNumberOfThreads (unsigned int nr_threads)
 {
-  if (nr_threads == 0)
-#ifdef _OPENMP
-    threads_ = omp_get_num_procs();
-#else
-    threads_ = 1;
-#endif
-  else
-    threads_ = nr_threads;
+  // 0 is resolved against the budget of pcl::ExecutionContext at compute time
+  threads_ = nr_threads;
 }
 
 ///////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointInT, typename PointOutT> void
 pcl::NormalEstimationOMP<PointInT, PointOutT>::computeFeature (PointCloudOut &output)
 {
+  const pcl::ThreadReservation reservation (threads_);
+  unsigned int threads = reservation.getNumberOfThreads ();
   // Allocate enough space to hold the results
   // \note This resize is irrelevant for a radiusSearch ().
   pcl::Indices nn_indices (k_);
   std::vector<float> nn_dists (k_);
 
   output.is_dense = true;
-  // Save a few cycles by not checking every point for NaN/Inf values if the cloud is set to dense
-  if (input_->is_dense)
-  {
+  std::ptrdiff_t nr_points = static_cast<std::ptrdiff_t> (indices_->size ());
+  std::ptrdiff_t nr_batches = (nr_points + batch_size_ - 1) / batch_size_;
 #pragma omp parallel for \
   default(none) \
-  shared(output) \
+  shared(output, nr_points, nr_batches) \
   firstprivate(nn_indices, nn_dists) \
-  num_threads(threads_)
-    // Iterating over the entire index vector
-    for (std::ptrdiff_t idx = 0; idx < static_cast<std::ptrdiff_t> (indices_->size ()); ++idx)
+  num_threads(threads)
+  // The covariance matrices of a batch of points are collected, then solved together
+  for (std::ptrdiff_t batch = 0; batch < nr_batches; ++batch)
+  {
+    float xx[batch_size_], xy[batch_size_], xz[batch_size_], yy[batch_size_], yz[batch_size_], zz[batch_size_];
+    float nx[batch_size_], ny[batch_size_], nz[batch_size_], curvature[batch_size_];
+    std::ptrdiff_t batch_indices[batch_size_];
+    std::size_t count = 0;
+
+    const std::ptrdiff_t end = std::min (nr_points, (batch + 1) * batch_size_);
+    for (std::ptrdiff_t idx = batch * batch_size_; idx < end; ++idx)
     {
-      Eigen::Vector4f n;
-      if (this->searchForNeighbors ((*indices_)[idx], search_parameter_, nn_indices, nn_dists) == 0 ||
-          !pcl::computePointNormal (*surface_, nn_indices, n, output[idx].curvature))
+      EIGEN_ALIGN16 Eigen::Matrix3f covariance_matrix;
+      Eigen::Vector4f xyz_centroid;
+      // Save a few cycles by not checking every point for NaN/Inf values if the cloud is set to dense
+      if ((!input_->is_dense && !isFinite ((*input_)[(*indices_)[idx]])) ||
+          this->searchForNeighbors ((*indices_)[idx], search_parameter_, nn_indices, nn_dists) == 0 ||
+          nn_indices.size () < 3 ||
+          computeMeanAndCovarianceMatrix (*surface_, nn_indices, covariance_matrix, xyz_centroid) == 0)
       {
         output[idx].normal[0] = output[idx].normal[1] = output[idx].normal[2] = output[idx].curvature = std::numeric_limits<float>::quiet_NaN ();
 
@@ -88,43 +96,27 @@ pcl::NormalEstimationOMP<PointInT, PointOutT>::computeFeature (PointCloudOut &ou
         continue;
       }
 
-      output[idx].normal_x = n[0];
-      output[idx].normal_y = n[1];
-      output[idx].normal_z = n[2];
-
-      flipNormalTowardsViewpoint ((*input_)[(*indices_)[idx]], vpx_, vpy_, vpz_,
-                                  output[idx].normal[0], output[idx].normal[1], output[idx].normal[2]);
-
+      xx[count] = covariance_matrix.coeff (0, 0);
+      xy[count] = covariance_matrix.coeff (0, 1);
+      xz[count] = covariance_matrix.coeff (0, 2);
+      yy[count] = covariance_matrix.coeff (1, 1);
+      yz[count] = covariance_matrix.coeff (1, 2);
+      zz[count] = covariance_matrix.coeff (2, 2);
+      batch_indices[count++] = idx;
     }
-  }
-  else
-  {
-#pragma omp parallel for \
-  default(none) \
-  shared(output) \
-  firstprivate(nn_indices, nn_dists) \
-  num_threads(threads_)
-    // Iterating over the entire index vector
-    for (std::ptrdiff_t idx = 0; idx < static_cast<std::ptrdiff_t> (indices_->size ()); ++idx)
-    {
-      Eigen::Vector4f n;
-      if (!isFinite ((*input_)[(*indices_)[idx]]) ||
-          this->searchForNeighbors ((*indices_)[idx], search_parameter_, nn_indices, nn_dists) == 0 ||
-          !pcl::computePointNormal (*surface_, nn_indices, n, output[idx].curvature))
-      {
-        output[idx].normal[0] = output[idx].normal[1] = output[idx].normal[2] = output[idx].curvature = std::numeric_limits<float>::quiet_NaN ();
 
-        output.is_dense = false;
-        continue;
-      }
+    solvePlaneParameters (xx, xy, xz, yy, yz, zz, count, nx, ny, nz, curvature);
 
-      output[idx].normal_x = n[0];
-      output[idx].normal_y = n[1];
-      output[idx].normal_z = n[2];
+    for (std::size_t i = 0; i < count; ++i)
+    {
+      const std::ptrdiff_t idx = batch_indices[i];
+      output[idx].normal_x = nx[i];
+      output[idx].normal_y = ny[i];
+      output[idx].normal_z = nz[i];
+      output[idx].curvature = curvature[i];
 
       flipNormalTowardsViewpoint ((*input_)[(*indices_)[idx]], vpx_, vpy_, vpz_,
                                   output[idx].normal[0], output[idx].normal[1], output[idx].normal[2]);
-
     }
   }
 }
@@ -40,6 +40,44 @@
 
 #include <pcl/2d/edge.h>
 #include <pcl/features/organized_edge_detection.h>
+#include <pcl/common/execution_context.h>
+#include <pcl/common/simd_lanes.h>
+
+#include <array>
+
+namespace pcl
+{
+namespace detail
+{
+  /** \brief Depth differences of V::size consecutive pixels of a row to their eight neighbors.
+    * The rows hold absolute depths with NaN for invalid points, and the pointers point at the
+    * first pixel in the row above, the row of the pixels and the row below.
+    * \param[out] dominant the difference largest in magnitude, the maximum on ties
+    * \param[out] valid 1 where all eight neighbors are valid, 0 otherwise
+    */
+  template <typename V> PCL_SIMD_INLINE void
+  organizedEdgeDepthDifferences (const float* above, const float* center, const float* below,
+                                 float* dominant, float* valid)
+  {
+    const V depth = V::load (center);
+    const V neighbors[8] = {V::load (center - 1), V::load (above - 1), V::load (above), V::load (above + 1),
+                            V::load (center + 1), V::load (below + 1), V::load (below), V::load (below - 1)};
+    V dist_min = depth - neighbors[0];
+    V dist_max = dist_min;
+    auto all_valid = neighbors[0] == neighbors[0];
+    for (int d_idx = 1; d_idx < 8; d_idx++)
+    {
+      const V dist = depth - neighbors[d_idx];
+      dist_min = min (dist_min, dist);
+      dist_max = max (dist_max, dist);
+      all_valid = simd::maskAnd (all_valid, neighbors[d_idx] == neighbors[d_idx]);
+    }
+    // abs (dist_min) > abs (dist_max) ? dist_min : dist_max
+    select (abs (dist_max) < abs (dist_min), dist_min, dist_max).store (dominant);
+    select (all_valid, V (1.0f), V (0.0f)).store (valid);
+  }
+} // namespace detail
+} // namespace pcl
 
 /**
  *  Directions: 1 2 3
@@ -53,9 +91,7 @@ pcl::OrganizedEdgeBase<PointT, PointLT>::compute (pcl::PointCloud<PointLT>& labe
 {
   pcl::Label invalid_pt;
   invalid_pt.label = unsigned (0);
-  labels.resize (input_->size (), invalid_pt);
-  labels.width = input_->width;
-  labels.height = input_->height;
+  labels.assign (input_->width, input_->height, invalid_pt);
   
   extractEdges (labels);
 
@@ -68,6 +104,8 @@ pcl::OrganizedEdgeBase<PointT, PointLT>::assignLabelIndices (pcl::PointCloud<Poi
 {
   const unsigned invalid_label = unsigned (0);
   label_indices.resize (num_of_edgetype_);
+  for (auto &indices : label_indices)
+    indices.indices.clear ();
   for (std::size_t idx = 0; idx < input_->size (); idx++)
   {
     if (labels[idx].label != invalid_label)
@@ -98,121 +136,141 @@ pcl::OrganizedEdgeBase<PointT, PointLT>::extractEdges (pcl::PointCloud<PointLT>&
       Neighbor( 0,  1,  labels.width    ),
       Neighbor(-1,  1,  labels.width - 1)};
 
-    for (int row = 1; row < int(input_->height) - 1; row++)
+    const int width = static_cast<int> (input_->width);
+    const int height = static_cast<int> (input_->height);
+
+    const pcl::ThreadReservation reservation (threads_);
+    unsigned int threads = reservation.getNumberOfThreads ();
+
+    // Absolute depths, NaN for invalid points, so that the neighbors of a row of pixels are contiguous
+    std::vector<float> depths (input_->size ());
+#pragma omp parallel for \
+  default(none) \
+  shared(depths) \
+  num_threads(threads)
+    for (std::ptrdiff_t idx = 0; idx < static_cast<std::ptrdiff_t> (depths.size ()); idx++)
+      depths[idx] = std::isfinite ((*input_)[idx].z) ? std::abs ((*input_)[idx].z) : std::numeric_limits<float>::quiet_NaN ();
+
+#pragma omp parallel for \
+  default(none) \
+  shared(depths, directions, labels, width, height) \
+  schedule(dynamic, 8) \
+  num_threads(threads)
+    for (int row = 1; row < height - 1; row++)
     {
-      for (int col = 1; col < int(input_->width) - 1; col++)
+      const float* above = &depths[(row - 1) * width];
+      const float* center = &depths[row * width];
+      const float* below = &depths[(row + 1) * width];
+
+      // Depth differences to the eight neighbors, several pixels at a time
+      std::array<float, 16> dominant, valid;
+      int col = 1;
+      while (col < width - 1)
       {
-        int curr_idx = row*int(input_->width) + col;
-        if (!std::isfinite ((*input_)[curr_idx].z))
-          continue;
-
-        float curr_depth = std::abs ((*input_)[curr_idx].z);
-
-        // Calculate depth distances between current point and neighboring points
-        std::vector<float> nghr_dist;
-        nghr_dist.resize (8);
-        bool found_invalid_neighbor = false;
-        for (int d_idx = 0; d_idx < num_of_ngbr; d_idx++)
+        std::size_t count = 0;
+#ifdef PCL_SIMD_KERNELS_SSE2
+        using Lane = pcl::detail::simd::Lane4;
+        for (; count + Lane::size <= dominant.size () && col + static_cast<int> (count + Lane::size) <= width - 1; count += Lane::size)
+          pcl::detail::organizedEdgeDepthDifferences<Lane> (above + col + count, center + col + count, below + col + count,
+                                                           &dominant[count], &valid[count]);
+#endif
+        for (; count < dominant.size () && col + static_cast<int> (count) < width - 1; count++)
+          pcl::detail::organizedEdgeDepthDifferences<pcl::detail::simd::Lane<float> > (above + col + count, center + col + count,
+                                                                                      below + col + count, &dominant[count], &valid[count]);
+
+        for (std::size_t i = 0; i < count; i++, col++)
         {
-          int nghr_idx = curr_idx + directions[d_idx].d_index;
-          assert (nghr_idx >= 0 && static_cast<std::size_t>(nghr_idx) < input_->size ());
-          if (!std::isfinite ((*input_)[nghr_idx].z))
-          {
-            found_invalid_neighbor = true;
-            break;
-          }
-          nghr_dist[d_idx] = curr_depth - std::abs ((*input_)[nghr_idx].z);
-        }
+          const int curr_idx = row * width + col;
+          const float curr_depth = center[col];
+          if (std::isnan (curr_depth))
+            continue;
 
-        if (!found_invalid_neighbor)
-        {
-          // Every neighboring points are valid
-          std::vector<float>::const_iterator min_itr, max_itr;
-          std::tie (min_itr, max_itr) = std::minmax_element (nghr_dist.cbegin (), nghr_dist.cend ());
-          float nghr_dist_min = *min_itr;
-          float nghr_dist_max = *max_itr;
-          float dist_dominant = std::abs (nghr_dist_min) > std::abs (nghr_dist_max) ? nghr_dist_min : nghr_dist_max;
-          if (std::abs (dist_dominant) > th_depth_discon_*std::abs (curr_depth))
+          if (valid[i] != 0.f)
           {
-            // Found a depth discontinuity
-            if (dist_dominant > 0.f)
+            // Every neighboring points are valid
+            const float dist_dominant = dominant[i];
+            if (std::abs (dist_dominant) > th_depth_discon_*std::abs (curr_depth))
             {
-              if (detecting_edge_types_ & EDGELABEL_OCCLUDED)
-                labels[curr_idx].label |= EDGELABEL_OCCLUDED;
-            }
-            else
-            {
-              if (detecting_edge_types_ & EDGELABEL_OCCLUDING)
-                labels[curr_idx].label |= EDGELABEL_OCCLUDING;
+              // Found a depth discontinuity
+              if (dist_dominant > 0.f)
+              {
+                if (detecting_edge_types_ & EDGELABEL_OCCLUDED)
+                  labels[curr_idx].label |= EDGELABEL_OCCLUDED;
+              }
+              else
+              {
+                if (detecting_edge_types_ & EDGELABEL_OCCLUDING)
+                  labels[curr_idx].label |= EDGELABEL_OCCLUDING;
+              }
             }
           }
-        }
-        else
-        {
-          // Some neighboring points are not valid (nan points)
-          // Search for corresponding point across invalid points
-          // Search direction is determined by nan point locations with respect to current point
-          int dx = 0;
-          int dy = 0;
-          int num_of_invalid_pt = 0;
-          for (const auto &direction : directions)
+          else
           {
-            int nghr_idx = curr_idx + direction.d_index;
-            assert (nghr_idx >= 0 && static_cast<std::size_t>(nghr_idx) < input_->size ());
-            if (!std::isfinite ((*input_)[nghr_idx].z))
+            // Some neighboring points are not valid (nan points)
+            // Search for corresponding point across invalid points
+            // Search direction is determined by nan point locations with respect to current point
+            int dx = 0;
+            int dy = 0;
+            int num_of_invalid_pt = 0;
+            for (const auto &direction : directions)
             {
-              dx += direction.d_x;
-              dy += direction.d_y;
-              num_of_invalid_pt++;
+              int nghr_idx = curr_idx + direction.d_index;
+              assert (nghr_idx >= 0 && static_cast<std::size_t>(nghr_idx) < input_->size ());
+              if (std::isnan (depths[nghr_idx]))
+              {
+                dx += direction.d_x;
+                dy += direction.d_y;
+                num_of_invalid_pt++;
+              }
             }
-          }
 
-          // Search directions
-          assert (num_of_invalid_pt > 0);
-          float f_dx = static_cast<float> (dx) / static_cast<float> (num_of_invalid_pt);
-          float f_dy = static_cast<float> (dy) / static_cast<float> (num_of_invalid_pt);
+            // Search directions
+            assert (num_of_invalid_pt > 0);
+            float f_dx = static_cast<float> (dx) / static_cast<float> (num_of_invalid_pt);
+            float f_dy = static_cast<float> (dy) / static_cast<float> (num_of_invalid_pt);
 
-          // Search for corresponding point across invalid points
-          float corr_depth = std::numeric_limits<float>::quiet_NaN ();
-          for (int s_idx = 1; s_idx < max_search_neighbors_; s_idx++)
-          {
-            int s_row = row + static_cast<int> (std::floor (f_dy*static_cast<float> (s_idx)));
-            int s_col = col + static_cast<int> (std::floor (f_dx*static_cast<float> (s_idx)));
+            // Search for corresponding point across invalid points
+            float corr_depth = std::numeric_limits<float>::quiet_NaN ();
+            for (int s_idx = 1; s_idx < max_search_neighbors_; s_idx++)
+            {
+              int s_row = row + static_cast<int> (std::floor (f_dy*static_cast<float> (s_idx)));
+              int s_col = col + static_cast<int> (std::floor (f_dx*static_cast<float> (s_idx)));
 
-            if (s_row < 0 || s_row >= int(input_->height) || s_col < 0 || s_col >= int(input_->width))
-              break;
+              if (s_row < 0 || s_row >= height || s_col < 0 || s_col >= width)
+                break;
 
-            if (std::isfinite ((*input_)[s_row*int(input_->width)+s_col].z))
-            {
-              corr_depth = std::abs ((*input_)[s_row*int(input_->width)+s_col].z);
-              break;
+              if (!std::isnan (depths[s_row*width+s_col]))
+              {
+                corr_depth = depths[s_row*width+s_col];
+                break;
+              }
             }
-          }
 
-          if (!std::isnan (corr_depth))
-          {
-            // Found a corresponding point
-            float dist = curr_depth - corr_depth;
-            if (std::abs (dist) > th_depth_discon_*std::abs (curr_depth))
+            if (!std::isnan (corr_depth))
             {
-              // Found a depth discontinuity
-              if (dist > 0.f)
+              // Found a corresponding point
+              float dist = curr_depth - corr_depth;
+              if (std::abs (dist) > th_depth_discon_*std::abs (curr_depth))
               {
-                if (detecting_edge_types_ & EDGELABEL_OCCLUDED)
-                  labels[curr_idx].label |= EDGELABEL_OCCLUDED;
-              }
-              else
-              {
-                if (detecting_edge_types_ & EDGELABEL_OCCLUDING)
-                  labels[curr_idx].label |= EDGELABEL_OCCLUDING;
+                // Found a depth discontinuity
+                if (dist > 0.f)
+                {
+                  if (detecting_edge_types_ & EDGELABEL_OCCLUDED)
+                    labels[curr_idx].label |= EDGELABEL_OCCLUDED;
+                }
+                else
+                {
+                  if (detecting_edge_types_ & EDGELABEL_OCCLUDING)
+                    labels[curr_idx].label |= EDGELABEL_OCCLUDING;
+                }
               }
             }
-          } 
-          else
-          {
-            // Not found a corresponding point, just nan boundary edge
-            if (detecting_edge_types_ & EDGELABEL_NAN_BOUNDARY)
-              labels[curr_idx].label |= EDGELABEL_NAN_BOUNDARY;
+            else
+            {
+              // Not found a corresponding point, just nan boundary edge
+              if (detecting_edge_types_ & EDGELABEL_NAN_BOUNDARY)
+                labels[curr_idx].label |= EDGELABEL_NAN_BOUNDARY;
+            }
           }
         }
       }
@@ -227,9 +285,7 @@ pcl::OrganizedEdgeFromRGB<PointT, PointLT>::compute (pcl::PointCloud<PointLT>& l
 {
   pcl::Label invalid_pt;
   invalid_pt.label = unsigned (0);
-  labels.resize (input_->size (), invalid_pt);
-  labels.width = input_->width;
-  labels.height = input_->height;
+  labels.assign (input_->width, input_->height, invalid_pt);
 
   OrganizedEdgeBase<PointT, PointLT>::extractEdges (labels);
   extractEdges (labels);
@@ -243,12 +299,19 @@ pcl::OrganizedEdgeFromRGB<PointT, PointLT>::extractEdges (pcl::PointCloud<PointL
 {
   if ((detecting_edge_types_ & EDGELABEL_RGB_CANNY))
   {
+    const pcl::ThreadReservation reservation (this->threads_);
+    unsigned int threads = reservation.getNumberOfThreads ();
+
     pcl::PointCloud<PointXYZI>::Ptr gray (new pcl::PointCloud<PointXYZI>);
     gray->width = input_->width;
     gray->height = input_->height;
     gray->resize (input_->height*input_->width);
 
-    for (std::size_t i = 0; i < input_->size (); ++i)
+#pragma omp parallel for \
+  default(none) \
+  shared(gray) \
+  num_threads(threads)
+    for (std::ptrdiff_t i = 0; i < static_cast<std::ptrdiff_t> (input_->size ()); ++i)
       (*gray)[i].intensity = float (((*input_)[i].r + (*input_)[i].g + (*input_)[i].b) / 3);
 
     pcl::PointCloud<pcl::PointXYZIEdge> img_edge_rgb;
@@ -257,8 +320,12 @@ pcl::OrganizedEdgeFromRGB<PointT, PointLT>::extractEdges (pcl::PointCloud<PointL
     edge.setHysteresisThresholdLow (th_rgb_canny_low_);
     edge.setHysteresisThresholdHigh (th_rgb_canny_high_);
     edge.detectEdgeCanny (img_edge_rgb);
-    
-    for (std::uint32_t row=0; row<labels.height; row++)
+
+#pragma omp parallel for \
+  default(none) \
+  shared(img_edge_rgb, labels) \
+  num_threads(threads)
+    for (std::ptrdiff_t row=0; row<static_cast<std::ptrdiff_t> (labels.height); row++)
     {
       for (std::uint32_t col=0; col<labels.width; col++)
       {
@@ -275,9 +342,7 @@ pcl::OrganizedEdgeFromNormals<PointT, PointNT, PointLT>::compute (pcl::PointClou
 {
   pcl::Label invalid_pt;
   invalid_pt.label = unsigned (0);
-  labels.resize (input_->size (), invalid_pt);
-  labels.width = input_->width;
-  labels.height = input_->height;
+  labels.assign (input_->width, input_->height, invalid_pt);
   
   OrganizedEdgeBase<PointT, PointLT>::extractEdges (labels);
   extractEdges (labels);
@@ -291,6 +356,8 @@ pcl::OrganizedEdgeFromNormals<PointT, PointNT, PointLT>::extractEdges (pcl::Poin
 {
   if ((detecting_edge_types_ & EDGELABEL_HIGH_CURVATURE))
   {
+    const pcl::ThreadReservation reservation (this->threads_);
+    unsigned int threads = reservation.getNumberOfThreads ();
 
     pcl::PointCloud<PointXYZI> nx, ny;
     nx.width = normals_->width;
@@ -301,7 +368,11 @@ pcl::OrganizedEdgeFromNormals<PointT, PointNT, PointLT>::extractEdges (pcl::Poin
     ny.height = normals_->height;
     ny.resize (normals_->height*normals_->width);
 
-    for (std::uint32_t row=0; row<normals_->height; row++)
+#pragma omp parallel for \
+  default(none) \
+  shared(nx, ny) \
+  num_threads(threads)
+    for (std::ptrdiff_t row=0; row<static_cast<std::ptrdiff_t> (normals_->height); row++)
     {
       for (std::uint32_t col=0; col<normals_->width; col++)
       {
@@ -316,7 +387,11 @@ pcl::OrganizedEdgeFromNormals<PointT, PointNT, PointLT>::extractEdges (pcl::Poin
     edge.setHysteresisThresholdHigh (th_hc_canny_high_);
     edge.canny (nx, ny, img_edge);
 
-    for (std::uint32_t row=0; row<labels.height; row++)
+#pragma omp parallel for \
+  default(none) \
+  shared(img_edge, labels) \
+  num_threads(threads)
+    for (std::ptrdiff_t row=0; row<static_cast<std::ptrdiff_t> (labels.height); row++)
     {
       for (std::uint32_t col=0; col<labels.width; col++)
       {
@@ -333,9 +408,7 @@ pcl::OrganizedEdgeFromRGBNormals<PointT, PointNT, PointLT>::compute (pcl::PointC
 {
   pcl::Label invalid_pt;
   invalid_pt.label = unsigned (0);
-  labels.resize (input_->size (), invalid_pt);
-  labels.width = input_->width;
-  labels.height = input_->height;
+  labels.assign (input_->width, input_->height, invalid_pt);
   
   OrganizedEdgeBase<PointT, PointLT>::extractEdges (labels);
   OrganizedEdgeFromNormals<PointT, PointNT, PointLT>::extractEdges (labels);
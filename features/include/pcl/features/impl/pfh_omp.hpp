@@ -0,0 +1,155 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2019-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <pcl/features/pfh_omp.h>
+#include <pcl/common/execution_context.h>
+
+#include <pcl/common/point_tests.h> // for pcl::isFinite
+#include <pcl/features/pfh_tools.h> // for pcl::computePairFeatures
+
+#include <algorithm>
+#include <limits>
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointInT, typename PointNT, typename PointOutT> void
+pcl::PFHEstimationOMP<PointInT, PointNT, PointOutT>::setNumberOfThreads (unsigned int nr_threads)
+{
+  // 0 is resolved against the budget of pcl::ExecutionContext at compute time
+  threads_ = nr_threads;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointInT, typename PointNT, typename PointOutT> void
+pcl::PFHEstimationOMP<PointInT, PointNT, PointOutT>::computeNeighborhoodSignature (
+    const pcl::Indices &indices, PairBuffers &buffers, float *histogram) const
+{
+  const int nr_split = nr_subdiv_;
+  std::fill (histogram, histogram + nr_split * nr_split * nr_split, 0.0f);
+
+  // Every pair counts, also the ones with invalid points that are left out below
+  const float hist_incr = 100.0f / static_cast<float> (indices.size () * (indices.size () - 1) / 2);
+
+  // Gather the finite neighbors as structure of arrays, for the batched pair features
+  buffers.x.resize (indices.size ()); buffers.y.resize (indices.size ()); buffers.z.resize (indices.size ());
+  buffers.nx.resize (indices.size ()); buffers.ny.resize (indices.size ()); buffers.nz.resize (indices.size ());
+  std::size_t nr_valid = 0;
+  for (const auto &index : indices)
+  {
+    const PointInT &point = (*surface_)[index];
+    if (!isFinite (point))
+      continue;
+    const PointNT &normal = (*normals_)[index];
+    buffers.x[nr_valid] = point.x;
+    buffers.y[nr_valid] = point.y;
+    buffers.z[nr_valid] = point.z;
+    buffers.nx[nr_valid] = normal.normal_x;
+    buffers.ny[nr_valid] = normal.normal_y;
+    buffers.nz[nr_valid] = normal.normal_z;
+    ++nr_valid;
+  }
+  buffers.f1.resize (nr_valid); buffers.f2.resize (nr_valid);
+  buffers.f3.resize (nr_valid); buffers.f4.resize (nr_valid);
+  buffers.bins.resize (nr_valid);
+
+  for (std::size_t i = 1; i < nr_valid; ++i)
+  {
+    // The pairs of neighbor i with all neighbors before it, as PFHEstimation forms them
+    const Eigen::Vector4f p1 (buffers.x[i], buffers.y[i], buffers.z[i], 0.0f);
+    const Eigen::Vector4f n1 (buffers.nx[i], buffers.ny[i], buffers.nz[i], 0.0f);
+    pcl::computePairFeatures (p1, n1,
+                              buffers.x.data (), buffers.y.data (), buffers.z.data (),
+                              buffers.nx.data (), buffers.ny.data (), buffers.nz.data (), i,
+                              buffers.f1.data (), buffers.f2.data (), buffers.f3.data (), buffers.f4.data ());
+
+    // Bin all pairs first, which vectorizes, then scatter them into the histogram
+    const float *f1 = buffers.f1.data (), *f2 = buffers.f2.data (), *f3 = buffers.f3.data ();
+    int *bins = buffers.bins.data ();
+    for (std::size_t j = 0; j < i; ++j)
+    {
+      const int b1 = std::min (std::max (static_cast<int> (std::floor (nr_split * ((f1[j] + M_PI) * d_pi_))), 0), nr_split - 1);
+      const int b2 = std::min (std::max (static_cast<int> (std::floor (nr_split * ((f2[j] + 1.0) * 0.5))), 0), nr_split - 1);
+      const int b3 = std::min (std::max (static_cast<int> (std::floor (nr_split * ((f3[j] + 1.0) * 0.5))), 0), nr_split - 1);
+      bins[j] = b1 + nr_split * (b2 + nr_split * b3);
+    }
+    for (std::size_t j = 0; j < i; ++j)
+      histogram[bins[j]] += hist_incr;
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointInT, typename PointNT, typename PointOutT> void
+pcl::PFHEstimationOMP<PointInT, PointNT, PointOutT>::computeFeature (PointCloudOut &output)
+{
+  const pcl::ThreadReservation reservation (threads_);
+  unsigned int threads = reservation.getNumberOfThreads ();
+
+  const int nr_bins = nr_subdiv_ * nr_subdiv_ * nr_subdiv_;
+  // Allocate enough space to hold the results
+  // \note This resize is irrelevant for a radiusSearch ().
+  pcl::Indices nn_indices (k_);
+  std::vector<float> nn_dists (k_);
+  PairBuffers buffers;
+
+  bool is_dense = true;
+#pragma omp parallel for \
+  default(none) \
+  shared(output, nr_bins) \
+  firstprivate(nn_indices, nn_dists, buffers) \
+  reduction(&&:is_dense) \
+  schedule(dynamic, 64) \
+  num_threads(threads)
+  for (std::ptrdiff_t idx = 0; idx < static_cast<std::ptrdiff_t> (indices_->size ()); ++idx)
+  {
+    // Save a few cycles by not checking every point for NaN/Inf values if the cloud is set to dense
+    if ((!input_->is_dense && !isFinite ((*input_)[(*indices_)[idx]])) ||
+        this->searchForNeighbors ((*indices_)[idx], search_parameter_, nn_indices, nn_dists) == 0)
+    {
+      for (int d = 0; d < nr_bins; ++d)
+        output[idx].histogram[d] = std::numeric_limits<float>::quiet_NaN ();
+
+      is_dense = false;
+      continue;
+    }
+
+    // Estimate the PFH signature at each patch, directly into the output
+    computeNeighborhoodSignature (nn_indices, buffers, output[idx].histogram);
+  }
+  output.is_dense = is_dense;
+}
+
+#define PCL_INSTANTIATE_PFHEstimationOMP(T,NT,OutT) template class PCL_EXPORTS pcl::PFHEstimationOMP<T,NT,OutT>;
@@ -168,10 +168,10 @@ void RangeImageBorderExtractor::calculateBorderDirection(int x, int y)
   const BorderTraits& border_traits = border_description.traits;
   if (!border_traits[BORDER_TRAIT__OBSTACLE_BORDER])
     return;
-  border_direction = new Eigen::Vector3f(0.0f, 0.0f, 0.0f);
+  border_direction = &border_directions_values_buffer_[index];
+  border_direction->setZero ();
   if (!get3dDirection(border_description, *border_direction, surface_structure_[index]))
   {
-    delete border_direction;
     border_direction = nullptr;
     return;
   }
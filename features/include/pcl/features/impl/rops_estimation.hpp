@@ -42,8 +42,9 @@
 
 #include <pcl/features/rops_estimation.h>
 
+#include <algorithm> // for sort, unique
 #include <array>
-#include <numeric> // for accumulate
+#include <numeric> // for accumulate, partial_sum
 #include <Eigen/Eigenvalues> // for EigenSolver
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -54,8 +55,7 @@ pcl::ROPSEstimation <PointInT, PointOutT>::ROPSEstimation () :
   support_radius_ (1.0f),
   sqr_support_radius_ (1.0f),
   step_ (22.5f),
-  triangles_ (0),
-  triangles_of_the_point_ (0)
+  triangles_ (0)
 {
 }
 
@@ -64,7 +64,8 @@ template <typename PointInT, typename PointOutT>
 pcl::ROPSEstimation <PointInT, PointOutT>::~ROPSEstimation ()
 {
   triangles_.clear ();
-  triangles_of_the_point_.clear ();
+  point_triangles_.clear ();
+  point_triangles_offsets_.clear ();
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -144,110 +145,118 @@ pcl::ROPSEstimation <PointInT, PointOutT>::computeFeature (PointCloudOut &output
 
   buildListOfPointsTriangles ();
 
-  //feature size = number_of_rotations * number_of_axis_to_rotate_around * number_of_projections * number_of_central_moments
-  unsigned int feature_size = number_of_rotations_ * 3 * 3 * 5;
   const auto number_of_points = indices_->size ();
-  output.clear ();
-  output.reserve (number_of_points);
+  output.resize (number_of_points);
+
+  Scratch scratch;
+  for (std::size_t i_point = 0; i_point < number_of_points; i_point++)
+    computePointFeature ((*input_)[(*indices_)[i_point]], scratch, output[i_point].histogram);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointInT, typename PointOutT> void
+pcl::ROPSEstimation <PointInT, PointOutT>::computePointFeature (const PointInT& point, Scratch& scratch, float* histogram) const
+{
+  //feature size = number_of_rotations * number_of_axis_to_rotate_around * number_of_projections * number_of_central_moments
+  const unsigned int feature_size = number_of_rotations_ * 3 * 3 * 5;
+
+  getLocalSurface (point, scratch.local_triangles, scratch.local_points, scratch.local_distances);
+
+  Eigen::Matrix3f lrf_matrix;
+  computeLRF (point, scratch, lrf_matrix);
 
-  for (const auto& idx: *indices_)
+  transformCloud (point, lrf_matrix, scratch.local_points, scratch.transformed_cloud);
+
+  std::array<PointInT, 3> axes;
+  axes[0].x = 1.0f; axes[0].y = 0.0f; axes[0].z = 0.0f;
+  axes[1].x = 0.0f; axes[1].y = 1.0f; axes[1].z = 0.0f;
+  axes[2].x = 0.0f; axes[2].y = 0.0f; axes[2].z = 1.0f;
+  std::vector <float>& feature = scratch.feature;
+  feature.clear ();
+  scratch.distribution_matrix.resize (number_of_bins_, number_of_bins_);
+  for (const auto &axis : axes)
   {
-    std::set <unsigned int> local_triangles;
-    pcl::Indices local_points;
-    getLocalSurface ((*input_)[idx], local_triangles, local_points);
-
-    Eigen::Matrix3f lrf_matrix;
-    computeLRF ((*input_)[idx], local_triangles, lrf_matrix);
-
-    PointCloudIn transformed_cloud;
-    transformCloud ((*input_)[idx], lrf_matrix, local_points, transformed_cloud);
-
-    std::array<PointInT, 3> axes;
-    axes[0].x = 1.0f; axes[0].y = 0.0f; axes[0].z = 0.0f;
-    axes[1].x = 0.0f; axes[1].y = 1.0f; axes[1].z = 0.0f;
-    axes[2].x = 0.0f; axes[2].y = 0.0f; axes[2].z = 1.0f;
-    std::vector <float> feature;
-    for (const auto &axis : axes)
+    float theta = step_;
+    do
     {
-      float theta = step_;
-      do
+      //rotate local surface and get bounding box
+      Eigen::Vector3f min, max;
+      rotateCloud (axis, theta, scratch.transformed_cloud, scratch.rotated_cloud, min, max);
+
+      //for each projection (XY, XZ and YZ) compute distribution matrix and central moments
+      for (unsigned int i_proj = 0; i_proj < 3; i_proj++)
       {
-        //rotate local surface and get bounding box
-        PointCloudIn rotated_cloud;
-        Eigen::Vector3f min, max;
-        rotateCloud (axis, theta, transformed_cloud, rotated_cloud, min, max);
-
-        //for each projection (XY, XZ and YZ) compute distribution matrix and central moments
-        for (unsigned int i_proj = 0; i_proj < 3; i_proj++)
-        {
-          Eigen::MatrixXf distribution_matrix;
-          distribution_matrix.resize (number_of_bins_, number_of_bins_);
-          getDistributionMatrix (i_proj, min, max, rotated_cloud, distribution_matrix);
-
-          // TODO remove this needless copy due to API design
-          std::vector <float> moments;
-          computeCentralMoments (distribution_matrix, moments);
-
-          feature.insert (feature.end (), moments.begin (), moments.end ());
-        }
-
-        theta += step_;
-      } while (theta < 90.0f);
-    }
+        getDistributionMatrix (i_proj, min, max, scratch.rotated_cloud, scratch.distribution_matrix);
+        computeCentralMoments (scratch.distribution_matrix, scratch.moments);
 
-    const float norm = std::accumulate(
-        feature.cbegin(), feature.cend(), 0.f, [](const auto& sum, const auto& val) {
-          return sum + std::abs(val);
-        });
-    float invert_norm;
-    if (norm < std::numeric_limits <float>::epsilon ())
-      invert_norm = 1.0f;
-    else
-      invert_norm = 1.0f / norm;
-
-    output.emplace_back ();
-    for (std::size_t i_dim = 0; i_dim < feature_size; i_dim++)
-      output.back().histogram[i_dim] = feature[i_dim] * invert_norm;
+        feature.insert (feature.end (), scratch.moments.begin (), scratch.moments.end ());
+      }
+
+      theta += step_;
+    } while (theta < 90.0f);
   }
+
+  const float norm = std::accumulate(
+      feature.cbegin(), feature.cend(), 0.f, [](const auto& sum, const auto& val) {
+        return sum + std::abs(val);
+      });
+  float invert_norm;
+  if (norm < std::numeric_limits <float>::epsilon ())
+    invert_norm = 1.0f;
+  else
+    invert_norm = 1.0f / norm;
+
+  for (std::size_t i_dim = 0; i_dim < feature_size; i_dim++)
+    histogram[i_dim] = feature[i_dim] * invert_norm;
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointInT, typename PointOutT> void
 pcl::ROPSEstimation <PointInT, PointOutT>::buildListOfPointsTriangles ()
 {
-  triangles_of_the_point_.clear ();
-
-  std::vector <unsigned int> dummy;
-  dummy.reserve (100);
-  triangles_of_the_point_.resize (surface_->points. size (), dummy);
-
+  // Count the triangles of every point, turn the counts into offsets and scatter the triangles.
+  // Triangles are visited in increasing order, so the list of every point ends up sorted.
+  point_triangles_offsets_.assign (surface_->size () + 1, 0);
+  for (const auto& triangle: triangles_)
+    for (const auto& vertex: triangle.vertices)
+      point_triangles_offsets_[vertex + 1]++;
+  std::partial_sum (point_triangles_offsets_.begin (), point_triangles_offsets_.end (), point_triangles_offsets_.begin ());
+
+  point_triangles_.resize (point_triangles_offsets_.back ());
+  std::vector <unsigned int> next (point_triangles_offsets_.begin (), point_triangles_offsets_.end () - 1);
   for (std::size_t i_triangle = 0; i_triangle < triangles_.size (); i_triangle++)
     for (const auto& vertex: triangles_[i_triangle].vertices)
-      triangles_of_the_point_[vertex].push_back (i_triangle);
+      point_triangles_[next[vertex]++] = static_cast<unsigned int> (i_triangle);
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointInT, typename PointOutT> void
-pcl::ROPSEstimation <PointInT, PointOutT>::getLocalSurface (const PointInT& point, std::set <unsigned int>& local_triangles, pcl::Indices& local_points) const
+pcl::ROPSEstimation <PointInT, PointOutT>::getLocalSurface (const PointInT& point, std::vector <unsigned int>& local_triangles,
+                                                            pcl::Indices& local_points, std::vector <float>& distances) const
 {
-  std::vector <float> distances;
   tree_->radiusSearch (point, support_radius_, local_points, distances);
 
+  local_triangles.clear ();
   for (const auto& pt: local_points)
-    local_triangles.insert (triangles_of_the_point_[pt].begin (),
-                            triangles_of_the_point_[pt].end ());
+    local_triangles.insert (local_triangles.end (),
+                            point_triangles_.begin () + point_triangles_offsets_[pt],
+                            point_triangles_.begin () + point_triangles_offsets_[pt + 1]);
+  std::sort (local_triangles.begin (), local_triangles.end ());
+  local_triangles.erase (std::unique (local_triangles.begin (), local_triangles.end ()), local_triangles.end ());
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointInT, typename PointOutT> void
-pcl::ROPSEstimation <PointInT, PointOutT>::computeLRF (const PointInT& point, const std::set <unsigned int>& local_triangles, Eigen::Matrix3f& lrf_matrix) const
+pcl::ROPSEstimation <PointInT, PointOutT>::computeLRF (const PointInT& point, Scratch& scratch, Eigen::Matrix3f& lrf_matrix) const
 {
+  const std::vector <unsigned int>& local_triangles = scratch.local_triangles;
   std::size_t number_of_triangles = local_triangles.size ();
 
-  std::vector<Eigen::Matrix3f, Eigen::aligned_allocator<Eigen::Matrix3f> > scatter_matrices;
-  std::vector <float> triangle_area (number_of_triangles), distance_weight (number_of_triangles);
+  auto& scatter_matrices = scratch.scatter_matrices;
+  std::vector <float>& triangle_area = scratch.triangle_area;
+  std::vector <float>& distance_weight = scratch.distance_weight;
 
-  scatter_matrices.reserve (number_of_triangles);
+  scatter_matrices.clear ();
   triangle_area.clear ();
   distance_weight.clear ();
 
@@ -293,7 +302,8 @@ pcl::ROPSEstimation <PointInT, PointOutT>::computeLRF (const PointInT& point, co
 
   Eigen::Matrix3f overall_scatter_matrix;
   overall_scatter_matrix.setZero ();
-  std::vector<float> total_weight (number_of_triangles);
+  // The total weights overwrite the distance weights, which are not needed afterwards
+  std::vector<float>& total_weight = distance_weight;
   const float denominator = 1.0f / 6.0f;
   for (std::size_t i_triangle = 0; i_triangle < number_of_triangles; i_triangle++)
   {
@@ -517,7 +527,7 @@ pcl::ROPSEstimation <PointInT, PointOutT>::computeCentralMoments (const Eigen::M
     {2.0f, 2.0f}};
 
   float entropy = 0.0f;
-  moments.resize (number_of_moments_to_compute + 1, 0.0f);
+  moments.assign (number_of_moments_to_compute + 1, 0.0f);
   for (unsigned int i = 0; i < number_of_bins_; i++)
   {
     const float i_factor = static_cast <float> (i + 1) - mean_i;
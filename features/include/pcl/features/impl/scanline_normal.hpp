@@ -0,0 +1,228 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef PCL_FEATURES_IMPL_SCANLINE_NORMAL_H_
+#define PCL_FEATURES_IMPL_SCANLINE_NORMAL_H_
+
+#include <pcl/features/scanline_normal.h>
+#include <pcl/features/normal_3d.h>
+#include <pcl/common/execution_context.h>
+#include <pcl/common/point_tests.h> // for pcl::isXYZFinite
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+///////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointInT, typename PointOutT> void
+pcl::ScanlineNormalEstimation<PointInT, PointOutT>::setNumberOfThreads (unsigned int nr_threads)
+{
+  // 0 is resolved against the budget of pcl::ExecutionContext at compute time
+  threads_ = nr_threads;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointInT, typename PointOutT> bool
+pcl::ScanlineNormalEstimation<PointInT, PointOutT>::initCompute ()
+{
+  if (!PCLBase<PointInT>::initCompute ())
+  {
+    PCL_ERROR ("[pcl::%s::initCompute] Init failed.\n", getClassName ().c_str ());
+    return (false);
+  }
+  if (!input_->isOrganized ())
+  {
+    PCL_ERROR ("[pcl::%s::initCompute] Input dataset is not organized (height = 1).\n", getClassName ().c_str ());
+    return (false);
+  }
+  if (window_rows_ < 1 || window_cols_ < 1 || window_rows_ % 2 == 0 || window_cols_ % 2 == 0)
+  {
+    PCL_ERROR ("[pcl::%s::initCompute] Invalid window size (%d x %d) given! Both dimensions must be odd and positive.\n",
+               getClassName ().c_str (), window_rows_, window_cols_);
+    return (false);
+  }
+  if (min_neighbors_ < 3 || min_neighbors_ > window_rows_ * window_cols_)
+  {
+    PCL_ERROR ("[pcl::%s::initCompute] Invalid minimum number of neighbors (%d) given! Allowed ranges are: 3 <= N <= %d.\n",
+               getClassName ().c_str (), min_neighbors_, window_rows_ * window_cols_);
+    return (false);
+  }
+  return (true);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointInT, typename PointOutT> int
+pcl::ScanlineNormalEstimation<PointInT, PointOutT>::computeWindowCovariance (
+    int u, int v, float *covariance) const
+{
+  const int width = static_cast<int> (input_->width);
+  const int height = static_cast<int> (input_->height);
+
+  const PointInT &center = (*input_)[v * width + u];
+  if (!pcl::isXYZFinite (center))
+    return (0);
+
+  const float range = std::sqrt ((center.x - vpx_) * (center.x - vpx_) +
+                                 (center.y - vpy_) * (center.y - vpy_) +
+                                 (center.z - vpz_) * (center.z - vpz_));
+  const float max_range_change = max_range_change_factor_ * range;
+
+  // Accumulate relative to the center point to keep the single precision sums well conditioned
+  float sx = 0, sy = 0, sz = 0, sxx = 0, sxy = 0, sxz = 0, syy = 0, syz = 0, szz = 0;
+  int count = 0;
+  const int half_rows = window_rows_ / 2;
+  const int half_cols = window_cols_ / 2;
+  for (int row = std::max (v - half_rows, 0); row <= std::min (v + half_rows, height - 1); ++row)
+  {
+    for (int du = -half_cols; du <= half_cols; ++du)
+    {
+      int col = u + du;
+      if (col < 0 || col >= width)
+      {
+        if (!wrap_around_)
+          continue;
+        col = ((col % width) + width) % width;
+      }
+
+      const PointInT &point = (*input_)[row * width + col];
+      if (!pcl::isXYZFinite (point))
+        continue;
+
+      const float point_range = std::sqrt ((point.x - vpx_) * (point.x - vpx_) +
+                                           (point.y - vpy_) * (point.y - vpy_) +
+                                           (point.z - vpz_) * (point.z - vpz_));
+      if (std::abs (point_range - range) > max_range_change)
+        continue;
+
+      const float dx = point.x - center.x;
+      const float dy = point.y - center.y;
+      const float dz = point.z - center.z;
+      sx += dx; sy += dy; sz += dz;
+      sxx += dx * dx; sxy += dx * dy; sxz += dx * dz;
+      syy += dy * dy; syz += dy * dz; szz += dz * dz;
+      ++count;
+    }
+  }
+
+  if (count < 3)
+    return (count);
+
+  const float inv_count = 1.0f / static_cast<float> (count);
+  const float mx = sx * inv_count;
+  const float my = sy * inv_count;
+  const float mz = sz * inv_count;
+  covariance[0] = sxx * inv_count - mx * mx;
+  covariance[1] = sxy * inv_count - mx * my;
+  covariance[2] = sxz * inv_count - mx * mz;
+  covariance[3] = syy * inv_count - my * my;
+  covariance[4] = syz * inv_count - my * mz;
+  covariance[5] = szz * inv_count - mz * mz;
+  return (count);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointInT, typename PointOutT> void
+pcl::ScanlineNormalEstimation<PointInT, PointOutT>::computeFeature (PointCloudOut &output)
+{
+  const float bad_point = std::numeric_limits<float>::quiet_NaN ();
+
+  const pcl::ThreadReservation reservation (threads_);
+  const unsigned int threads = reservation.getNumberOfThreads ();
+  // The points are processed in chunks so that the plane fits can go through the batched solver
+  const int chunk_size = 256;
+  int nr_points = static_cast<int> (indices_->size ());
+  int nr_chunks = (nr_points + chunk_size - 1) / chunk_size;
+  int width = static_cast<int> (input_->width);
+  bool is_dense = true;
+
+#pragma omp parallel \
+  default(none) \
+  shared(output, nr_points, nr_chunks, width, bad_point) \
+  reduction(&&:is_dense) \
+  num_threads(threads)
+  {
+    std::vector<float> covariance (6 * chunk_size);
+    std::vector<float> solution (4 * chunk_size);
+    std::vector<int> slots (chunk_size);
+
+#pragma omp for schedule(dynamic, 1)
+    for (int chunk = 0; chunk < nr_chunks; ++chunk)
+    {
+      const int begin = chunk * chunk_size;
+      const int end = std::min (begin + chunk_size, nr_points);
+
+      int valid = 0;
+      for (int idx = begin; idx < end; ++idx)
+      {
+        const int point_index = (*indices_)[idx];
+        float window_covariance[6];
+        if (computeWindowCovariance (point_index % width, point_index / width, window_covariance) < min_neighbors_)
+        {
+          output[idx].normal_x = output[idx].normal_y = output[idx].normal_z = output[idx].curvature = bad_point;
+          is_dense = false;
+          continue;
+        }
+        for (int k = 0; k < 6; ++k)
+          covariance[k * chunk_size + valid] = window_covariance[k];
+        slots[valid++] = idx;
+      }
+
+      solvePlaneParameters (&covariance[0], &covariance[chunk_size], &covariance[2 * chunk_size],
+                            &covariance[3 * chunk_size], &covariance[4 * chunk_size], &covariance[5 * chunk_size],
+                            valid, &solution[0], &solution[chunk_size], &solution[2 * chunk_size], &solution[3 * chunk_size]);
+
+      for (int i = 0; i < valid; ++i)
+      {
+        const int idx = slots[i];
+        float nx = solution[i];
+        float ny = solution[chunk_size + i];
+        float nz = solution[2 * chunk_size + i];
+        flipNormalTowardsViewpoint ((*input_)[(*indices_)[idx]], vpx_, vpy_, vpz_, nx, ny, nz);
+        output[idx].normal_x = nx;
+        output[idx].normal_y = ny;
+        output[idx].normal_z = nz;
+        output[idx].curvature = solution[3 * chunk_size + i];
+      }
+    }
+  }
+  output.is_dense = is_dense;
+}
+
+#define PCL_INSTANTIATE_ScanlineNormalEstimation(T,NT) template class PCL_EXPORTS pcl::ScanlineNormalEstimation<T,NT>;
+
+#endif    // PCL_FEATURES_IMPL_SCANLINE_NORMAL_H_
@@ -43,24 +43,59 @@
 #include <Eigen/Eigenvalues> // for SelfAdjointEigenSolver
 #include <utility>
 #include <pcl/features/shot_lrf.h>
+#include <pcl/common/eigen.h> // for eigen33
+
+namespace pcl
+{
+  namespace detail
+  {
+    /** \brief Eigen decomposition of a SHOT LRF covariance matrix, eigenvalues in increasing order. */
+    inline void
+    solveSHOTCovariance (const Eigen::Matrix3d &cov, Eigen::Matrix3d &evecs, Eigen::Vector3d &evals)
+    {
+      Eigen::SelfAdjointEigenSolver<Eigen::Matrix3d> solver (cov);
+      evecs = solver.eigenvectors ();
+      evals = solver.eigenvalues ();
+    }
+
+    inline void
+    solveSHOTCovariance (const Eigen::Matrix3f &cov, Eigen::Matrix3f &evecs, Eigen::Vector3f &evals)
+    {
+      pcl::eigen33 (cov, evecs, evals);
+    }
+  }
+}
 
 //////////////////////////////////////////////////////////////////////////////////////////////
 // Compute a local Reference Frame for a 3D feature; the output is stored in the "rf" matrix
 template<typename PointInT, typename PointOutT> float
 pcl::SHOTLocalReferenceFrameEstimation<PointInT, PointOutT>::getLocalRF (const int& current_point_idx, Eigen::Matrix3f &rf)
 {
+  if (fast_mode_)
+    return (computeLocalRF<float> (current_point_idx, rf));
+  return (computeLocalRF<double> (current_point_idx, rf));
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template<typename PointInT, typename PointOutT> template <typename Scalar> float
+pcl::SHOTLocalReferenceFrameEstimation<PointInT, PointOutT>::computeLocalRF (const int& current_point_idx, Eigen::Matrix3f &rf)
+{
+  using Vector3 = Eigen::Matrix<Scalar, 3, 1>;
+  using Vector4 = Eigen::Matrix<Scalar, 4, 1>;
+  using Matrix3 = Eigen::Matrix<Scalar, 3, 3>;
+
   const Eigen::Vector4f& central_point = (*input_)[current_point_idx].getVector4fMap ();
   pcl::Indices n_indices;
   std::vector<float> n_sqr_distances;
 
   this->searchForNeighbors (current_point_idx, search_parameter_, n_indices, n_sqr_distances);
 
-  Eigen::Matrix<double, Eigen::Dynamic, 4> vij (n_indices.size (), 4);
+  Eigen::Matrix<Scalar, Eigen::Dynamic, 4> vij (n_indices.size (), 4);
 
-  Eigen::Matrix3d cov_m = Eigen::Matrix3d::Zero ();
+  Matrix3 cov_m = Matrix3::Zero ();
 
-  double distance = 0.0;
-  double sum = 0.0;
+  Scalar distance = 0;
+  Scalar sum = 0;
 
   int valid_nn_points = 0;
 
@@ -71,13 +106,13 @@ pcl::SHOTLocalReferenceFrameEstimation<PointInT, PointOutT>::getLocalRF (const i
 		  continue;
 
     // Difference between current point and origin
-    vij.row (valid_nn_points).matrix () = (pt - central_point).cast<double> ();
+    vij.row (valid_nn_points).matrix () = (pt - central_point).template cast<Scalar> ();
     vij (valid_nn_points, 3) = 0;
 
-    distance = search_parameter_ - sqrt (n_sqr_distances[i_idx]);
+    distance = static_cast<Scalar> (search_parameter_ - sqrt (n_sqr_distances[i_idx]));
 
     // Multiply vij * vij'
-    cov_m += distance * (vij.row (valid_nn_points).head<3> ().transpose () * vij.row (valid_nn_points).head<3> ());
+    cov_m += distance * (vij.row (valid_nn_points).template head<3> ().transpose () * vij.row (valid_nn_points).template head<3> ());
 
     sum += distance;
     valid_nn_points++;
@@ -93,11 +128,13 @@ pcl::SHOTLocalReferenceFrameEstimation<PointInT, PointOutT>::getLocalRF (const i
 
   cov_m /= sum;
 
-  Eigen::SelfAdjointEigenSolver<Eigen::Matrix3d> solver (cov_m);
+  Matrix3 evecs;
+  Vector3 evals;
+  pcl::detail::solveSHOTCovariance (cov_m, evecs, evals);
 
-  const double& e1c = solver.eigenvalues ()[0];
-  const double& e2c = solver.eigenvalues ()[1];
-  const double& e3c = solver.eigenvalues ()[2];
+  const Scalar& e1c = evals[0];
+  const Scalar& e2c = evals[1];
+  const Scalar& e3c = evals[2];
 
   if (!std::isfinite (e1c) || !std::isfinite (e2c) || !std::isfinite (e3c))
   {
@@ -108,15 +145,15 @@ pcl::SHOTLocalReferenceFrameEstimation<PointInT, PointOutT>::getLocalRF (const i
   }
 
   // Disambiguation
-  Eigen::Vector4d v1 = Eigen::Vector4d::Zero ();
-  Eigen::Vector4d v3 = Eigen::Vector4d::Zero ();
-  v1.head<3> ().matrix () = solver.eigenvectors ().col (2);
-  v3.head<3> ().matrix () = solver.eigenvectors ().col (0);
+  Vector4 v1 = Vector4::Zero ();
+  Vector4 v3 = Vector4::Zero ();
+  v1.template head<3> ().matrix () = evecs.col (2);
+  v3.template head<3> ().matrix () = evecs.col (0);
 
   int plusNormal = 0, plusTangentDirection1=0;
   for (int ne = 0; ne < valid_nn_points; ne++)
   {
-    double dp = vij.row (ne).dot (v1);
+    Scalar dp = vij.row (ne).dot (v1);
     if (dp >= 0)
       plusTangentDirection1++;
 
@@ -158,8 +195,8 @@ pcl::SHOTLocalReferenceFrameEstimation<PointInT, PointOutT>::getLocalRF (const i
 	} else if (plusNormal < 0)
     v3 *= - 1;
 
-  rf.row (0).matrix () = v1.head<3> ().cast<float> ();
-  rf.row (2).matrix () = v3.head<3> ().cast<float> ();
+  rf.row (0).matrix () = v1.template head<3> ().template cast<float> ();
+  rf.row (2).matrix () = v3.template head<3> ().template cast<float> ();
   rf.row (1).matrix () = rf.row (2).cross (rf.row (0));
 
   return (0.0f);
@@ -40,6 +40,8 @@
 #pragma once
 
 #include <pcl/features/shot_omp.h>
+#include <pcl/common/execution_context.h>
+#include <pcl/features/impl/shot.hpp> // for PST_RAD_*
 
 #include <pcl/common/point_tests.h> // for pcl::isFinite
 #include <pcl/common/time.h>
@@ -70,6 +72,7 @@ pcl::SHOTEstimationOMP<PointInT, PointNT, PointOutT, PointRFT>::initCompute ()
   lrf_estimator->setInputCloud (input_);
   lrf_estimator->setIndices (indices_);
   lrf_estimator->setNumberOfThreads(threads_);
+  lrf_estimator->setFastMode (fast_mode_);
 
   if (!fake_surface_)
     lrf_estimator->setSearchSurface(surface_);
@@ -125,20 +128,16 @@ pcl::SHOTColorEstimationOMP<PointInT, PointNT, PointOutT, PointRFT>::initCompute
 template<typename PointInT, typename PointNT, typename PointOutT, typename PointRFT> void
 pcl::SHOTEstimationOMP<PointInT, PointNT, PointOutT, PointRFT>::setNumberOfThreads (unsigned int nr_threads)
 {
-  if (nr_threads == 0)
-#ifdef _OPENMP
-    threads_ = omp_get_num_procs();
-#else
-    threads_ = 1;
-#endif
-  else
-    threads_ = nr_threads;
+  // 0 is resolved against the budget of pcl::ExecutionContext at compute time
+  threads_ = nr_threads;
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////
 template<typename PointInT, typename PointNT, typename PointOutT, typename PointRFT> void
 pcl::SHOTEstimationOMP<PointInT, PointNT, PointOutT, PointRFT>::computeFeature (PointCloudOut &output)
 {
+  const pcl::ThreadReservation reservation (threads_);
+  unsigned int threads = reservation.getNumberOfThreads ();
   descLength_ = nr_grid_sector_ * (nr_shape_bins_ + 1);
 
   sqradius_ = search_radius_ * search_radius_;
@@ -150,16 +149,24 @@ pcl::SHOTEstimationOMP<PointInT, PointNT, PointOutT, PointRFT>::computeFeature (
 
   output.is_dense = true;
   // Iterating over the entire index vector
-#pragma omp parallel for \
+#pragma omp parallel \
   default(none) \
   shared(output) \
-  num_threads(threads_)
+  num_threads(threads)
+  {
+  // Allocate enough space to hold the results, once per thread
+  // \note This resize is irrelevant for a radiusSearch ().
+  Scratch scratch;
+  scratch.nn_indices.resize (k_);
+  scratch.nn_dists.resize (k_);
+  scratch.shot.setZero (descLength_);
+  pcl::Indices &nn_indices = scratch.nn_indices;
+  std::vector<float> &nn_dists = scratch.nn_dists;
+  Eigen::VectorXf &shot = scratch.shot;
+
+#pragma omp for
   for (std::ptrdiff_t idx = 0; idx < static_cast<std::ptrdiff_t> (indices_->size ()); ++idx)
   {
-
-    Eigen::VectorXf shot;
-    shot.setZero (descLength_);
-
     bool lrf_is_nan = false;
     const PointRFT& current_frame = (*frames_)[idx];
     if (!std::isfinite (current_frame.x_axis[0]) ||
@@ -171,11 +178,6 @@ pcl::SHOTEstimationOMP<PointInT, PointNT, PointOutT, PointRFT>::computeFeature (
       lrf_is_nan = true;
     }
 
-    // Allocate enough space to hold the results
-    // \note This resize is irrelevant for a radiusSearch ().
-    pcl::Indices nn_indices (k_);
-    std::vector<float> nn_dists (k_);
-
     if (!isFinite ((*input_)[(*indices_)[idx]]) || lrf_is_nan || this->searchForNeighbors ((*indices_)[idx], search_parameter_, nn_indices,
                                                                                            nn_dists) == 0)
     {
@@ -190,7 +192,10 @@ pcl::SHOTEstimationOMP<PointInT, PointNT, PointOutT, PointRFT>::computeFeature (
     }
 
     // Estimate the SHOT at each patch
-    this->computePointSHOT (idx, nn_indices, nn_dists, shot);
+    if (fast_mode_)
+      computePointSHOTFast (static_cast<int> (idx), scratch);
+    else
+      this->computePointSHOT (static_cast<int> (idx), nn_indices, nn_dists, shot);
 
     // Copy into the resultant cloud
     for (Eigen::Index d = 0; d < shot.size (); ++d)
@@ -202,26 +207,208 @@ pcl::SHOTEstimationOMP<PointInT, PointNT, PointOutT, PointRFT>::computeFeature (
       output[idx].rf[d + 6] = (*frames_)[idx].z_axis[d];
     }
   }
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template<typename PointInT, typename PointNT, typename PointOutT, typename PointRFT> void
+pcl::SHOTEstimationOMP<PointInT, PointNT, PointOutT, PointRFT>::computePointSHOTFast (
+    const int index, Scratch &scratch)
+{
+  const pcl::Indices &indices = scratch.nn_indices;
+  Eigen::VectorXf &shot = scratch.shot;
+
+  //Skip the current feature if the number of its neighbors is not sufficient for its description
+  if (indices.size () < 5)
+  {
+    PCL_WARN ("[pcl::%s::computePointSHOT] Warning! Neighborhood has less than 5 vertexes. Aborting description of point with index %d\n",
+                  getClassName ().c_str (), (*indices_)[index]);
+
+    shot.setConstant (descLength_, 1, std::numeric_limits<float>::quiet_NaN ());
+    return;
+  }
+
+  const std::size_t count = indices.size ();
+  for (std::vector<float>* buffer : {&scratch.dx, &scratch.dy, &scratch.dz, &scratch.x, &scratch.y, &scratch.z,
+                                     &scratch.distance, &scratch.inclination, &scratch.azimuth, &scratch.bin_distance})
+    buffer->resize (count);
+
+  const Eigen::Vector4f& central_point = (*input_)[(*indices_)[index]].getVector4fMap ();
+  const PointRFT& current_frame = (*frames_)[index];
+  const Eigen::Vector3f current_frame_z (current_frame.z_axis[0], current_frame.z_axis[1], current_frame.z_axis[2]);
+
+  // Gather the neighbors and the bins of their normals, see createBinDistanceShape
+  unsigned nan_counter = 0;
+  for (std::size_t i_idx = 0; i_idx < count; ++i_idx)
+  {
+    const Eigen::Vector4f delta = (*surface_)[indices[i_idx]].getVector4fMap () - central_point;
+    scratch.dx[i_idx] = delta[0];
+    scratch.dy[i_idx] = delta[1];
+    scratch.dz[i_idx] = delta[2];
+
+    const Eigen::Vector3f normal_vec = (*normals_)[indices[i_idx]].getNormalVector3fMap ();
+    if (!std::isfinite (normal_vec[0]) ||
+        !std::isfinite (normal_vec[1]) ||
+        !std::isfinite (normal_vec[2]))
+    {
+      scratch.bin_distance[i_idx] = std::numeric_limits<float>::quiet_NaN ();
+      ++nan_counter;
+      continue;
+    }
+    const float cosine_desc = std::max (-1.0f, std::min (normal_vec.dot (current_frame_z), 1.0f));
+    scratch.bin_distance[i_idx] = ((1.0f + cosine_desc) * static_cast<float> (nr_shape_bins_)) / 2;
+  }
+  if (nan_counter > 0)
+    PCL_WARN ("[pcl::%s::createBinDistanceShape] Point %d has %d (%f%%) NaN normals in its neighbourhood\n",
+      getClassName ().c_str (), index, nan_counter, (static_cast<float>(nan_counter)*100.f/static_cast<float>(count)));
+
+  const float frame[9] = {current_frame.x_axis[0], current_frame.x_axis[1], current_frame.x_axis[2],
+                          current_frame.y_axis[0], current_frame.y_axis[1], current_frame.y_axis[2],
+                          current_frame.z_axis[0], current_frame.z_axis[1], current_frame.z_axis[2]};
+  pcl::computeSHOTLocalCoordinates (frame, scratch.dx.data (), scratch.dy.data (), scratch.dz.data (),
+                                    scratch.nn_dists.data (), count, scratch.x.data (), scratch.y.data (),
+                                    scratch.z.data (), scratch.distance.data (), scratch.inclination.data (),
+                                    scratch.azimuth.data ());
+
+  // Interpolate, see interpolateSingleChannel
+  const int nr_bins = nr_shape_bins_;
+  const int max_angular_sectors = this->maxAngularSectors_;
+  const float radius1_2 = static_cast<float> (radius1_2_);
+  const float radius1_4 = static_cast<float> (radius1_4_);
+  const float radius3_4 = static_cast<float> (radius3_4_);
+  const float rad_45 = static_cast<float> (PST_RAD_45);
+  const float rad_90 = static_cast<float> (PST_RAD_90);
+  const float rad_135 = static_cast<float> (PST_RAD_135);
+  const float rad_pi_7_8 = static_cast<float> (PST_RAD_PI_7_8);
+  float* hist = shot.data ();
+  shot.setZero ();
+
+  for (std::size_t i_idx = 0; i_idx < count; ++i_idx)
+  {
+    float bin_distance = scratch.bin_distance[i_idx];
+    const float distance = scratch.distance[i_idx];
+    if (!std::isfinite (bin_distance) || distance == 0.0f)
+      continue;
+
+    const float x = scratch.x[i_idx], y = scratch.y[i_idx], z = scratch.z[i_idx];
+
+    const int bit4 = ((y > 0) || ((y == 0.0f) && (x < 0))) ? 1 : 0;
+    const int bit3 = ((x > 0) || ((x == 0.0f) && (y > 0))) ? !bit4 : bit4;
+    int desc_index = ((bit4 << 3) + (bit3 << 2)) << 1;
+
+    if ((x * y > 0) || (x == 0.0f))
+      desc_index += (std::abs (x) >= std::abs (y)) ? 0 : 4;
+    else
+      desc_index += (std::abs (x) > std::abs (y)) ? 4 : 0;
+
+    desc_index += z > 0 ? 1 : 0;
+
+    // 2 RADII
+    desc_index += (distance > radius1_2) ? 2 : 0;
+
+    const int step_index = static_cast<int> (std::floor (bin_distance + 0.5f));
+    const int volume_index = desc_index * (nr_bins + 1);
+
+    //Interpolation on the cosine (adjacent bins in the histogram)
+    bin_distance -= static_cast<float> (step_index);
+    float int_weight = 1 - std::abs (bin_distance);
+
+    if (bin_distance > 0)
+      hist[volume_index + ((step_index + 1) % nr_bins)] += bin_distance;
+    else
+      hist[volume_index + ((step_index - 1 + nr_bins) % nr_bins)] -= bin_distance;
+
+    //Interpolation on the distance (adjacent husks)
+    if (distance > radius1_2)   //external sphere
+    {
+      const float radius_distance = (distance - radius3_4) / radius1_2;
+      if (distance > radius3_4) //most external sector, votes only for itself
+        int_weight += 1 - radius_distance;
+      else  //3/4 of radius, votes also for the internal sphere
+      {
+        int_weight += 1 + radius_distance;
+        hist[(desc_index - 2) * (nr_bins + 1) + step_index] -= radius_distance;
+      }
+    }
+    else    //internal sphere
+    {
+      const float radius_distance = (distance - radius1_4) / radius1_2;
+      if (distance < radius1_4) //most internal sector, votes only for itself
+        int_weight += 1 + radius_distance;
+      else  //3/4 of radius, votes also for the external sphere
+      {
+        int_weight += 1 - radius_distance;
+        hist[(desc_index + 2) * (nr_bins + 1) + step_index] += radius_distance;
+      }
+    }
+
+    //Interpolation on the inclination (adjacent vertical volumes)
+    const float inclination = scratch.inclination[i_idx];
+    if (z <= 0) // i.e. inclination >= 90 degrees
+    {
+      const float inclination_distance = (inclination - rad_135) / rad_90;
+      if (inclination > rad_135)
+        int_weight += 1 - inclination_distance;
+      else
+      {
+        int_weight += 1 + inclination_distance;
+        hist[(desc_index + 1) * (nr_bins + 1) + step_index] -= inclination_distance;
+      }
+    }
+    else
+    {
+      const float inclination_distance = (inclination - rad_45) / rad_90;
+      if (inclination < rad_45)
+        int_weight += 1 + inclination_distance;
+      else
+      {
+        int_weight += 1 - inclination_distance;
+        hist[(desc_index - 1) * (nr_bins + 1) + step_index] += inclination_distance;
+      }
+    }
+
+    if (y != 0.0f || x != 0.0f)
+    {
+      //Interpolation on the azimuth (adjacent horizontal volumes)
+      const int sel = desc_index >> 2;
+      float azimuth_distance = (scratch.azimuth[i_idx] - (-rad_pi_7_8 + rad_45 * static_cast<float> (sel))) / rad_45;
+      azimuth_distance = std::max (-0.5f, std::min (azimuth_distance, 0.5f));
+
+      if (azimuth_distance > 0)
+      {
+        int_weight += 1 - azimuth_distance;
+        const int interp_index = (desc_index + 4) % max_angular_sectors;
+        hist[interp_index * (nr_bins + 1) + step_index] += azimuth_distance;
+      }
+      else
+      {
+        const int interp_index = (desc_index - 4 + max_angular_sectors) % max_angular_sectors;
+        int_weight += 1 + azimuth_distance;
+        hist[interp_index * (nr_bins + 1) + step_index] -= azimuth_distance;
+      }
+    }
+
+    hist[volume_index + step_index] += int_weight;
+  }
+
+  // Normalize the final histogram, see normalizeHistogram
+  shot /= shot.norm ();
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointInT, typename PointNT, typename PointOutT, typename PointRFT> void
 pcl::SHOTColorEstimationOMP<PointInT, PointNT, PointOutT, PointRFT>::setNumberOfThreads (unsigned int nr_threads)
 {
-  if (nr_threads == 0)
-#ifdef _OPENMP
-    threads_ = omp_get_num_procs();
-#else
-    threads_ = 1;
-#endif
-  else
-    threads_ = nr_threads;
+  // 0 is resolved against the budget of pcl::ExecutionContext at compute time
+  threads_ = nr_threads;
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointInT, typename PointNT, typename PointOutT, typename PointRFT> void
 pcl::SHOTColorEstimationOMP<PointInT, PointNT, PointOutT, PointRFT>::computeFeature (PointCloudOut &output)
 {
+  const pcl::ThreadReservation reservation (threads_);
+  unsigned int threads = reservation.getNumberOfThreads ();
   descLength_ = (b_describe_shape_) ? nr_grid_sector_ * (nr_shape_bins_ + 1) : 0;
   descLength_ += (b_describe_color_) ? nr_grid_sector_ * (nr_color_bins_ + 1) : 0;
 
@@ -237,20 +424,21 @@ pcl::SHOTColorEstimationOMP<PointInT, PointNT, PointOutT, PointRFT>::computeFeat
 
   output.is_dense = true;
   // Iterating over the entire index vector
-#pragma omp parallel for \
+#pragma omp parallel \
   default(none) \
   shared(output) \
-  num_threads(threads_)
+  num_threads(threads)
+  {
+  // Allocate enough space to hold the results, once per thread
+  // \note This resize is irrelevant for a radiusSearch ().
+  Eigen::VectorXf shot;
+  shot.setZero (descLength_);
+  pcl::Indices nn_indices (k_);
+  std::vector<float> nn_dists (k_);
+
+#pragma omp for
   for (std::ptrdiff_t idx = 0; idx < static_cast<std::ptrdiff_t> (indices_->size ()); ++idx)
   {
-    Eigen::VectorXf shot;
-    shot.setZero (descLength_);
-
-    // Allocate enough space to hold the results
-    // \note This resize is irrelevant for a radiusSearch ().
-    pcl::Indices nn_indices (k_);
-    std::vector<float> nn_dists (k_);
-
     bool lrf_is_nan = false;
     const PointRFT& current_frame = (*frames_)[idx];
     if (!std::isfinite (current_frame.x_axis[0]) ||
@@ -289,6 +477,7 @@ pcl::SHOTColorEstimationOMP<PointInT, PointNT, PointOutT, PointRFT>::computeFeat
       output[idx].rf[d + 6] = (*frames_)[idx].z_axis[d];
     }
   }
+  }
 }
 
 #define PCL_INSTANTIATE_SHOTEstimationOMP(T,NT,OutT,RFT) template class PCL_EXPORTS pcl::SHOTEstimationOMP<T,NT,OutT,RFT>;
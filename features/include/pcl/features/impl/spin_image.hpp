@@ -65,6 +65,16 @@ pcl::SpinImageEstimation<PointInT, PointNT, PointOutT>::SpinImageEstimation (
 //////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointInT, typename PointNT, typename PointOutT> Eigen::ArrayXXd 
 pcl::SpinImageEstimation<PointInT, PointNT, PointOutT>::computeSiForPoint (int index) const
+{
+  Scratch scratch;
+  computeSiForPoint (index, scratch);
+  return (scratch.matrix);
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointInT, typename PointNT, typename PointOutT> void
+pcl::SpinImageEstimation<PointInT, PointNT, PointOutT>::computeSiForPoint (int index, Scratch &scratch) const
 {
   assert (image_width_ > 0);
   assert (support_angle_cos_ <= 1.0 && support_angle_cos_ >= 0.0); // may be permit negative cosine?
@@ -83,8 +93,11 @@ pcl::SpinImageEstimation<PointInT, PointNT, PointOutT>::computeSiForPoint (int i
       (*rotation_axes_cloud_)[index].getNormalVector3fMap () :
       origin_normal;  
 
-  Eigen::ArrayXXd m_matrix (Eigen::ArrayXXd::Zero (image_width_+1, 2*image_width_+1));
-  Eigen::ArrayXXd m_averAngles (Eigen::ArrayXXd::Zero (image_width_+1, 2*image_width_+1));
+  Eigen::ArrayXXd &m_matrix = scratch.matrix;
+  Eigen::ArrayXXd &m_averAngles = scratch.aver_angles;
+  m_matrix.setZero (image_width_+1, 2*image_width_+1);
+  if (is_angular_)
+    m_averAngles.setZero (image_width_+1, 2*image_width_+1);
 
   // OK, we are interested in the points of the cylinder of height 2*r and
   // base radius r, where r = m_dBinSize * in_iImageWidth
@@ -97,8 +110,8 @@ pcl::SpinImageEstimation<PointInT, PointNT, PointOutT>::computeSiForPoint (int i
   else
     bin_size = search_radius_ / image_width_ / sqrt(2.0);
 
-  pcl::Indices nn_indices;
-  std::vector<float> nn_sqr_dists;
+  pcl::Indices &nn_indices = scratch.nn_indices;
+  std::vector<float> &nn_sqr_dists = scratch.nn_sqr_dists;
   const int neighb_cnt = this->searchForNeighbors (index, search_radius_, nn_indices, nn_sqr_dists);
   if (neighb_cnt < static_cast<int> (min_pts_neighb_))
   {
@@ -227,8 +240,6 @@ pcl::SpinImageEstimation<PointInT, PointNT, PointOutT>::computeSiForPoint (int i
     // normalization
     m_matrix /= m_matrix.sum();
   }
-
-  return m_matrix;
 }
 
 
@@ -321,9 +332,11 @@ pcl::SpinImageEstimation<PointInT, PointNT, PointOutT>::initCompute ()
 template <typename PointInT, typename PointNT, typename PointOutT> void 
 pcl::SpinImageEstimation<PointInT, PointNT, PointOutT>::computeFeature (PointCloudOut &output)
 { 
+  Scratch scratch;
   for (std::size_t i_input = 0; i_input < indices_->size (); ++i_input)
   {
-    Eigen::ArrayXXd res = computeSiForPoint (indices_->at (i_input));
+    computeSiForPoint (indices_->at (i_input), scratch);
+    const Eigen::ArrayXXd &res = scratch.matrix;
 
     // Copy into the resultant cloud
     for (Eigen::Index iRow = 0; iRow < res.rows () ; iRow++)
@@ -73,6 +73,13 @@ pcl::UniqueShapeContext<PointInT, PointOutT, PointRFT>::initCompute ()
     return (false);
   }
 
+  return (initLookupTables ());
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointInT, typename PointOutT, typename PointRFT> bool
+pcl::UniqueShapeContext<PointInT, PointOutT, PointRFT>::initLookupTables ()
+{
   if (search_radius_< min_radius_)
   {
     PCL_ERROR ("[pcl::%s::initCompute] search_radius_ must be GREATER than min_radius_.\n", getClassName ().c_str ());
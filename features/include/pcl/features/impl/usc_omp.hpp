@@ -0,0 +1,230 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2019-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <pcl/features/usc_omp.h>
+#include <pcl/common/execution_context.h>
+
+#include <pcl/common/angles.h>
+#include <pcl/common/geometry.h>
+#include <pcl/common/point_tests.h> // for pcl::isFinite
+#include <pcl/common/utils.h>
+#include <pcl/features/shot_lrf_omp.h>
+
+#include <algorithm>
+#include <limits>
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointInT, typename PointOutT, typename PointRFT> void
+pcl::UniqueShapeContextOMP<PointInT, PointOutT, PointRFT>::setNumberOfThreads (unsigned int nr_threads)
+{
+  // 0 is resolved against the budget of pcl::ExecutionContext at compute time
+  threads_ = nr_threads;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointInT, typename PointOutT, typename PointRFT> bool
+pcl::UniqueShapeContextOMP<PointInT, PointOutT, PointRFT>::initCompute ()
+{
+  if (!Feature<PointInT, PointOutT>::initCompute ())
+  {
+    PCL_ERROR ("[pcl::%s::initCompute] Init failed.\n", getClassName ().c_str ());
+    return (false);
+  }
+
+  // Default LRF estimation alg: SHOTLocalReferenceFrameEstimationOMP
+  typename SHOTLocalReferenceFrameEstimationOMP<PointInT, PointRFT>::Ptr lrf_estimator (new SHOTLocalReferenceFrameEstimationOMP<PointInT, PointRFT>);
+  lrf_estimator->setRadiusSearch (local_radius_);
+  lrf_estimator->setInputCloud (input_);
+  lrf_estimator->setIndices (indices_);
+  lrf_estimator->setNumberOfThreads (threads_);
+  if (!fake_surface_)
+    lrf_estimator->setSearchSurface (surface_);
+
+  if (!FeatureWithLocalReferenceFrames<PointInT, PointRFT>::initLocalReferenceFrames (indices_->size (), lrf_estimator))
+  {
+    PCL_ERROR ("[pcl::%s::initCompute] Init failed.\n", getClassName ().c_str ());
+    return (false);
+  }
+
+  return (this->initLookupTables ());
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointInT, typename PointOutT, typename PointRFT> void
+pcl::UniqueShapeContextOMP<PointInT, PointOutT, PointRFT>::computePointDescriptor (
+    std::size_t index, const pcl::Indices &nn_indices, const std::vector<float> &nn_dists,
+    const std::vector<float> &point_density, float *desc) const
+{
+  pcl::Vector3fMapConst origin = (*input_)[(*indices_)[index]].getVector3fMap ();
+
+  const Eigen::Vector3f x_axis ((*frames_)[index].x_axis[0],
+                                (*frames_)[index].x_axis[1],
+                                (*frames_)[index].x_axis[2]);
+  const Eigen::Vector3f normal ((*frames_)[index].z_axis[0],
+                                (*frames_)[index].z_axis[1],
+                                (*frames_)[index].z_axis[2]);
+
+  for (std::size_t ne = 0; ne < nn_indices.size (); ne++)
+  {
+    if (pcl::utils::equal (nn_dists[ne], 0.0f))
+      continue;
+    Eigen::Vector3f neighbour = (*surface_)[nn_indices[ne]].getVector3fMap ();
+
+    // Polar coordinates of the neighbour, as in UniqueShapeContext::computePointDescriptor
+    float r = std::sqrt (nn_dists[ne]);
+
+    Eigen::Vector3f proj;
+    pcl::geometry::project (neighbour, origin, normal, proj);
+    proj -= origin;
+    proj.normalize ();
+
+    Eigen::Vector3f cross = x_axis.cross (proj);
+    float phi = rad2deg (std::atan2 (cross.norm (), x_axis.dot (proj)));
+    phi = cross.dot (normal) < 0.f ? (360.0f - phi) : phi;
+    Eigen::Vector3f no = neighbour - origin;
+    no.normalize ();
+    float theta = normal.dot (no);
+    theta = pcl::rad2deg (std::acos (std::min (1.0f, std::max (-1.0f, theta))));
+
+    // Bin (j, k, l)
+    const auto rad_min = std::lower_bound (std::next (radii_interval_.cbegin ()), radii_interval_.cend (), r);
+    const auto theta_min = std::lower_bound (std::next (theta_divisions_.cbegin ()), theta_divisions_.cend (), theta);
+    const auto phi_min = std::lower_bound (std::next (phi_divisions_.cbegin ()), phi_divisions_.cend (), phi);
+    const auto j = std::distance (radii_interval_.cbegin (), std::prev (rad_min));
+    const auto k = std::distance (theta_divisions_.cbegin (), std::prev (theta_min));
+    const auto l = std::distance (phi_divisions_.cbegin (), std::prev (phi_min));
+
+    const std::size_t bin = (l*elevation_bins_*radius_bins_) + (k*radius_bins_) + j;
+    desc[bin] += (1.0f / point_density[nn_indices[ne]]) * volume_lut_[bin];
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointInT, typename PointOutT, typename PointRFT> void
+pcl::UniqueShapeContextOMP<PointInT, PointOutT, PointRFT>::computeFeature (PointCloudOut &output)
+{
+  assert (descriptor_length_ == 1960);
+
+  const pcl::ThreadReservation reservation (threads_);
+  unsigned int threads = reservation.getNumberOfThreads ();
+
+  const auto is_valid = [this] (std::size_t point_index)
+  {
+    const PointRFT& current_frame = (*frames_)[point_index];
+    return (isFinite ((*input_)[(*indices_)[point_index]]) &&
+            std::isfinite (current_frame.x_axis[0]) &&
+            std::isfinite (current_frame.y_axis[0]) &&
+            std::isfinite (current_frame.z_axis[0]));
+  };
+
+  // Find the neighborhoods of the query points once, they tell which local point densities are needed
+  std::vector<pcl::Indices> query_nn_indices (indices_->size ());
+  std::vector<std::vector<float> > query_nn_dists (indices_->size ());
+#pragma omp parallel for \
+  default(none) \
+  shared(is_valid, query_nn_indices, query_nn_dists) \
+  schedule(dynamic, 64) \
+  num_threads(threads)
+  for (std::ptrdiff_t idx = 0; idx < static_cast<std::ptrdiff_t> (indices_->size ()); ++idx)
+  {
+    if (is_valid (idx))
+      this->searchForNeighbors ((*indices_)[idx], search_radius_, query_nn_indices[idx], query_nn_dists[idx]);
+  }
+
+  // Local point density = number of points in a sphere of radius "point_density_radius_" around a neighbour,
+  // computed once per point of the search surface
+  std::vector<bool> needs_density (surface_->size (), false);
+  for (std::size_t idx = 0; idx < query_nn_indices.size (); ++idx)
+    for (std::size_t ne = 0; ne < query_nn_indices[idx].size (); ++ne)
+      if (!pcl::utils::equal (query_nn_dists[idx][ne], 0.0f))
+        needs_density[query_nn_indices[idx][ne]] = true;
+  pcl::Indices density_indices;
+  for (std::size_t p_idx = 0; p_idx < needs_density.size (); ++p_idx)
+    if (needs_density[p_idx])
+      density_indices.push_back (static_cast<pcl::index_t> (p_idx));
+
+  std::vector<float> point_density (surface_->size (), 0.0f);
+  pcl::Indices nn_indices;
+  std::vector<float> nn_dists;
+#pragma omp parallel for \
+  default(none) \
+  shared(density_indices, point_density) \
+  firstprivate(nn_indices, nn_dists) \
+  schedule(dynamic, 64) \
+  num_threads(threads)
+  for (std::ptrdiff_t i = 0; i < static_cast<std::ptrdiff_t> (density_indices.size ()); ++i)
+  {
+    const pcl::index_t p_idx = density_indices[i];
+    point_density[p_idx] = static_cast<float> (this->searchForNeighbors (*surface_, p_idx, point_density_radius_, nn_indices, nn_dists));
+  }
+
+  bool is_dense = true;
+#pragma omp parallel for \
+  default(none) \
+  shared(is_valid, output, query_nn_indices, query_nn_dists, point_density) \
+  reduction(&&:is_dense) \
+  schedule(dynamic, 64) \
+  num_threads(threads)
+  for (std::ptrdiff_t point_index = 0; point_index < static_cast<std::ptrdiff_t> (indices_->size ()); ++point_index)
+  {
+    // If the point is not finite, set the descriptor to NaN and continue
+    if (!is_valid (point_index))
+    {
+      std::fill (output[point_index].descriptor, output[point_index].descriptor + descriptor_length_,
+                 std::numeric_limits<float>::quiet_NaN ());
+      std::fill (output[point_index].rf, output[point_index].rf + 9, 0);
+      is_dense = false;
+      continue;
+    }
+
+    const PointRFT& current_frame = (*frames_)[point_index];
+    for (int d = 0; d < 3; ++d)
+    {
+      output[point_index].rf[0 + d] = current_frame.x_axis[d];
+      output[point_index].rf[3 + d] = current_frame.y_axis[d];
+      output[point_index].rf[6 + d] = current_frame.z_axis[d];
+    }
+
+    std::fill (output[point_index].descriptor, output[point_index].descriptor + descriptor_length_, 0.0f);
+    computePointDescriptor (point_index, query_nn_indices[point_index], query_nn_dists[point_index],
+                            point_density, output[point_index].descriptor);
+  }
+  output.is_dense = is_dense;
+}
+
+#define PCL_INSTANTIATE_UniqueShapeContextOMP(T,OutT,RFT) template class PCL_EXPORTS pcl::UniqueShapeContextOMP<T,OutT,RFT>;
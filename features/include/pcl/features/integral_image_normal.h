@@ -129,6 +129,7 @@ namespace pcl
         , vpy_ (0.0f)
         , vpz_ (0.0f)
         , use_sensor_origin_ (true)
+        , threads_ (1)
       {
         feature_name_ = "IntegralImagesNormalEstimation";
         tree_.reset ();
@@ -172,6 +173,13 @@ namespace pcl
       void
       computePointNormalMirror (const int pos_x, const int pos_y, const unsigned point_index, PointOutT &normal);
 
+      /** \brief Set the number of threads used to build the integral images and to compute the normals.
+        * \param[in] nr_threads the number of hardware threads to use (0 takes as many as the budget of pcl::ExecutionContext allows when estimating the normals)
+        * \note The integral images are built when the input cloud is set, so call this before setInputCloud ().
+        */
+      void
+      setNumberOfThreads (unsigned int nr_threads = 0);
+
       /** \brief The depth change threshold for computing object borders
         * \param[in] max_depth_change_factor the depth change threshold for computing object borders based on
         * depth changes
@@ -335,6 +343,33 @@ namespace pcl
       void
       computeFeaturePart (const float* distance_map, const float& bad_point, PointCloudOut& output);
 
+      /** \brief Computes the normal at the specified position for a given region size. In contrast to
+        * computePointNormal (const int, const int, const unsigned, PointOutT &) this does not touch any
+        * member state and is therefore safe to call concurrently once the integral images are initialized.
+        * \param[in] pos_x x position (pixel)
+        * \param[in] pos_y y position (pixel)
+        * \param[in] point_index the position index of the point
+        * \param[in] rect_width the width of the search rectangle
+        * \param[in] rect_height the height of the search rectangle
+        * \param[out] normal the output estimated normal
+        */
+      void
+      computePointNormal (const int pos_x, const int pos_y, const unsigned point_index,
+                          const int rect_width, const int rect_height, PointOutT &normal) const;
+
+      /** \brief Computes the normal at the specified position for a given region size with mirroring
+        * for border handling. Safe to call concurrently once the integral images are initialized.
+        * \param[in] pos_x x position (pixel)
+        * \param[in] pos_y y position (pixel)
+        * \param[in] point_index the position index of the point
+        * \param[in] rect_width the width of the search rectangle
+        * \param[in] rect_height the height of the search rectangle
+        * \param[out] normal the output estimated normal
+        */
+      void
+      computePointNormalMirror (const int pos_x, const int pos_y, const unsigned point_index,
+                                const int rect_width, const int rect_height, PointOutT &normal) const;
+
       /** \brief Initialize the data structures, based on the normal estimation method chosen. */
       void
       initData ();
@@ -354,7 +389,7 @@ namespace pcl
       inline void
       flipNormalTowardsViewpoint (const PointInT &point, 
                                   float vp_x, float vp_y, float vp_z,
-                                  float &nx, float &ny, float &nz)
+                                  float &nx, float &ny, float &nz) const
       {
         // See if we need to flip any plane normals
         vp_x -= point.x;
@@ -443,6 +478,9 @@ namespace pcl
 
       /** whether the sensor origin of the input cloud or a user given viewpoint should be used.*/
       bool use_sensor_origin_;
+
+      /** \brief The number of threads the scheduler should use. */
+      unsigned int threads_;
       
       /** \brief This method should get called before starting the actual computation. */
       bool
@@ -464,6 +502,10 @@ namespace pcl
       void
       initSimple3DGradientMethod ();
 
+      /** \brief Initializes the data of the selected estimation method if that has not happened yet. */
+      void
+      initNormalEstimationMethod ();
+
     public:
       PCL_MAKE_ALIGNED_OPERATOR_NEW
   };
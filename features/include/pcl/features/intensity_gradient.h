@@ -75,7 +75,7 @@ namespace pcl
       };
 
       /** \brief Initialize the scheduler and set the number of threads to use.
-        * \param nr_threads the number of hardware threads to use (0 sets the value back to automatic)
+        * \param nr_threads the number of hardware threads to use (0 takes as many as the budget of pcl::ExecutionContext allows when computing)
         */
       inline void
       setNumberOfThreads (unsigned int nr_threads = 0) { threads_ = nr_threads; }
@@ -107,7 +107,7 @@ namespace pcl
     protected:
       ///intensity field accessor structure
       IntensitySelectorT intensity_;
-      ///number of threads to be used, default 0 (auto)
+      ///number of threads to be used, default 0 (the budget of pcl::ExecutionContext)
       unsigned int threads_;
   };
 }
@@ -144,6 +144,26 @@ namespace pcl
       float
       getPointMass () const;
 
+      /** \brief This method allows to compute the moments of inertia and eccentricities of the axis sweep
+        * from the second moments of the cloud. The points are visited in a single parallel pass that
+        * accumulates the mean, the scatter matrix and the AABB, and the value of every axis then follows from
+        * the scatter matrix in constant time, instead of from two passes over the cloud per axis.
+        * The results only differ from the default mode by rounding. Default value is false.
+        * \param[in] use_second_moments desired value
+        */
+      void
+      setUseSecondMoments (bool use_second_moments);
+
+      /** \brief Returns whether the axis sweep is computed from the second moments of the cloud. */
+      bool
+      getUseSecondMoments () const;
+
+      /** \brief Set the number of threads used by the passes over the cloud when the second moments are used.
+        * \param[in] nr_threads the number of hardware threads to use (0 sets the value back to automatic)
+        */
+      void
+      setNumberOfThreads (unsigned int nr_threads = 0);
+
       /** \brief This method launches the computation of all features. After execution
         * it sets is_valid_ flag to true and each feature can be accessed with the
         * corresponding get method.
@@ -228,9 +248,19 @@ namespace pcl
       void
       computeMeanValue ();
 
-      /** \brief This method computes the oriented bounding box. */
+      /** \brief This method computes center of mass, axis aligned bounding box and the scatter matrix
+        * (the sum of the outer products of the centered points) in one parallel pass.
+        * \param[out] scatter_matrix stores the computed scatter matrix
+        * \param[in] nr_threads the number of threads to use
+        */
       void
-      computeOBB ();
+      computeMeanValueAndScatterMatrix (Eigen::Matrix <float, 3, 3>& scatter_matrix, unsigned int nr_threads);
+
+      /** \brief This method computes the oriented bounding box.
+        * \param[in] nr_threads the number of threads to use
+        */
+      void
+      computeOBB (unsigned int nr_threads = 1);
 
       /** \brief This method computes the covariance matrix for the input_ cloud.
         * \param[out] covariance_matrix stores the computed covariance matrix
@@ -302,6 +332,12 @@ namespace pcl
       /** \brief Stores the flag for mass normalization */
       bool normalize_;
 
+      /** \brief Stores whether the axis sweep is computed from the second moments */
+      bool use_second_moments_;
+
+      /** \brief The number of threads used in the second moments mode */
+      unsigned int threads_;
+
       /** \brief Stores the mean value (center of mass) of the cloud */
       Eigen::Vector3f mean_value_;
 
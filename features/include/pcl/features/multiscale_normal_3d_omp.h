@@ -0,0 +1,187 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2019-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <pcl/features/feature.h>
+
+namespace pcl
+{
+  /** \brief MultiscaleNormalEstimationOMP estimates the surface normals of a point cloud at a small and a large
+    * support radius and their Difference of Normals (DoN) in one pass, in parallel, using the OpenMP standard.
+    *
+    * The result is the same as running NormalEstimationOMP at both radii and feeding the normals to
+    * DifferenceOfNormalsEstimation, but only one radius search is done per point: the neighbors within the small
+    * radius are taken from the neighbors within the large radius by their distance. The output cloud holds the
+    * DoN vectors, the normals of both scales are available through getNormalsSmall () and getNormalsLarge ()
+    * after compute ().
+    *
+    * \code
+    * pcl::MultiscaleNormalEstimationOMP<pcl::PointXYZ, pcl::Normal, pcl::Normal> mne;
+    * mne.setInputCloud (cloud);
+    * mne.setSearchMethod (tree);
+    * mne.setRadii (0.02, 0.2);
+    * mne.compute (*don);
+    * auto normals_small = mne.getNormalsSmall ();
+    * \endcode
+    *
+    * \ingroup features
+    */
+  template <typename PointInT, typename PointNT, typename PointOutT>
+  class MultiscaleNormalEstimationOMP : public Feature<PointInT, PointOutT>
+  {
+    public:
+      using Ptr = shared_ptr<MultiscaleNormalEstimationOMP<PointInT, PointNT, PointOutT> >;
+      using ConstPtr = shared_ptr<const MultiscaleNormalEstimationOMP<PointInT, PointNT, PointOutT> >;
+      using Feature<PointInT, PointOutT>::feature_name_;
+      using Feature<PointInT, PointOutT>::getClassName;
+      using Feature<PointInT, PointOutT>::indices_;
+      using Feature<PointInT, PointOutT>::input_;
+      using Feature<PointInT, PointOutT>::k_;
+      using Feature<PointInT, PointOutT>::search_parameter_;
+      using Feature<PointInT, PointOutT>::search_radius_;
+      using Feature<PointInT, PointOutT>::surface_;
+
+      using PointCloudN = pcl::PointCloud<PointNT>;
+      using PointCloudNPtr = typename PointCloudN::Ptr;
+      using PointCloudOut = typename Feature<PointInT, PointOutT>::PointCloudOut;
+
+      /** \brief Empty constructor.
+        * \param[in] nr_threads the number of hardware threads to use (0 sets the value back to automatic)
+        */
+      MultiscaleNormalEstimationOMP (unsigned int nr_threads = 0)
+        : radius_small_ (0)
+        , vpx_ (0)
+        , vpy_ (0)
+        , vpz_ (0)
+      {
+        feature_name_ = "MultiscaleNormalEstimationOMP";
+
+        setNumberOfThreads (nr_threads);
+      }
+
+      /** \brief Initialize the scheduler and set the number of threads to use.
+        * \param[in] nr_threads the number of hardware threads to use (0 sets the value back to automatic)
+        */
+      void
+      setNumberOfThreads (unsigned int nr_threads = 0);
+
+      /** \brief Set the support radii of the two normals. The large radius is the radius of the neighbor search.
+        * \param[in] radius_small the radius of the small scale normals
+        * \param[in] radius_large the radius of the large scale normals, larger than radius_small
+        */
+      inline void
+      setRadii (double radius_small, double radius_large)
+      {
+        radius_small_ = radius_small;
+        this->setRadiusSearch (radius_large);
+      }
+
+      /** \brief Get the radius of the small scale normals. */
+      inline double
+      getRadiusSmall () const { return (radius_small_); }
+
+      /** \brief Get the radius of the large scale normals. */
+      inline double
+      getRadiusLarge () const { return (search_radius_); }
+
+      /** \brief Set the viewpoint the normals of both scales are flipped towards.
+        * \param[in] vpx the X coordinate of the viewpoint
+        * \param[in] vpy the Y coordinate of the viewpoint
+        * \param[in] vpz the Z coordinate of the viewpoint
+        */
+      inline void
+      setViewPoint (float vpx, float vpy, float vpz)
+      {
+        vpx_ = vpx;
+        vpy_ = vpy;
+        vpz_ = vpz;
+      }
+
+      /** \brief Get the viewpoint.
+        * \param[out] vpx the X coordinate of the viewpoint
+        * \param[out] vpy the Y coordinate of the viewpoint
+        * \param[out] vpz the Z coordinate of the viewpoint
+        */
+      inline void
+      getViewPoint (float &vpx, float &vpy, float &vpz) const
+      {
+        vpx = vpx_;
+        vpy = vpy_;
+        vpz = vpz_;
+      }
+
+      /** \brief Get the normals at the small radius computed by the last call to compute (). */
+      inline PointCloudNPtr
+      getNormalsSmall () const { return (normals_small_); }
+
+      /** \brief Get the normals at the large radius computed by the last call to compute (). */
+      inline PointCloudNPtr
+      getNormalsLarge () const { return (normals_large_); }
+
+    protected:
+      /** \brief Check the radii in addition to the checks of Feature::initCompute. */
+      bool
+      initCompute () override;
+
+      /** \brief Estimate the normals at both radii and their DoN for all points given in
+        * <setInputCloud (), setIndices ()> using the surface in setSearchSurface ()
+        * \param[out] output the resultant DoN vectors, with their norm as curvature
+        */
+      void
+      computeFeature (PointCloudOut &output) override;
+
+      /** \brief The radius of the small scale normals. */
+      double radius_small_;
+
+      /** \brief The viewpoint the normals are flipped towards. */
+      float vpx_, vpy_, vpz_;
+
+      /** \brief The normals of both scales computed by the last call to compute (). */
+      PointCloudNPtr normals_small_, normals_large_;
+
+      /** \brief The number of points whose covariance matrices are solved together, see pcl::eigen33Batch. */
+      static constexpr std::ptrdiff_t batch_size_ = 64;
+
+    private:
+      /** \brief The number of threads the scheduler should use. */
+      unsigned int threads_;
+  };
+}
+
+#ifdef PCL_NO_PRECOMPILE
+#include <pcl/features/impl/multiscale_normal_3d_omp.hpp>
+#endif
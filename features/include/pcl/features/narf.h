@@ -76,7 +76,7 @@ namespace pcl
       const Narf& operator=(const Narf& other);
 
       // =====STATIC=====
-      /** The maximum number of openmp threads that can be used in this class */
+      /** The maximum number of openmp threads that can be used in this class (0 takes as many as the budget of pcl::ExecutionContext allows) */
       static int max_no_of_threads;
 
       /** Add features extracted at the given interest point and add them to the list */
@@ -0,0 +1,214 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#pragma once
+
+#include <pcl/memory.h>
+#include <pcl/pcl_macros.h>
+#include <pcl/point_cloud.h>
+#include <pcl/types.h>
+#include <pcl/search/search.h>
+
+#include <algorithm>
+#include <vector>
+
+namespace pcl
+{
+  /** \brief NeighborhoodCache stores the nearest neighbors of the points of a cloud, so that several feature
+    * estimators working on the same cloud with the same search parameters run the spatial queries only once.
+    *
+    * The neighborhoods are kept in compressed sparse row form: the neighbors of point i of the cloud are
+    * getIndices ()[getOffsets ()[i]] to getIndices ()[getOffsets ()[i + 1] - 1], with their squared distances
+    * at the same positions in getDistances ().
+    *
+    * Give the same cache to all estimators with Feature::setNeighborhoodCache. The first one fills it, the
+    * following ones read their neighborhoods from it as long as their input cloud, search surface and search
+    * parameters are the same. Clouds are recognized by their address and size: call clear () if a cloud is
+    * modified in place.
+    *
+    * \code
+    * pcl::NeighborhoodCache::Ptr cache (new pcl::NeighborhoodCache);
+    * normal_estimation.setNeighborhoodCache (cache);
+    * normal_estimation.compute (*normals);
+    * fpfh_estimation.setNeighborhoodCache (cache);
+    * fpfh_estimation.compute (*fpfhs);
+    * \endcode
+    * \ingroup features
+    */
+  class NeighborhoodCache
+  {
+    public:
+      using Ptr = shared_ptr<NeighborhoodCache>;
+      using ConstPtr = shared_ptr<const NeighborhoodCache>;
+
+      /** \brief Constructor.
+        * \param[in] nr_threads the number of threads used to fill the cache (0 takes as many as the budget of pcl::ExecutionContext allows)
+        */
+      NeighborhoodCache (unsigned int nr_threads = 0)
+      {
+        setNumberOfThreads (nr_threads);
+      }
+
+      /** \brief Set the number of threads used to fill the cache.
+        * \param[in] nr_threads the number of hardware threads to use (0 takes as many as the budget of pcl::ExecutionContext allows when filling the cache)
+        */
+      inline void
+      setNumberOfThreads (unsigned int nr_threads = 0)
+      {
+        // 0 is resolved against the budget of pcl::ExecutionContext at compute time
+        threads_ = nr_threads;
+      }
+
+      /** \brief Search the neighborhoods of the given points of a cloud and store them, replacing the current
+        * contents of the cache. Exactly one of \a radius and \a k must be non-zero.
+        * \param[in] search the spatial locator, whose input cloud is the search surface
+        * \param[in] cloud the cloud holding the query points
+        * \param[in] indices the indices of the query points in \a cloud
+        * \param[in] radius the radius of a radiusSearch (), or 0
+        * \param[in] k the number of neighbors of a nearestKSearch (), or 0
+        */
+      template <typename PointT> void
+      compute (const pcl::search::Search<PointT> &search, const pcl::PointCloud<PointT> &cloud,
+               const pcl::Indices &indices, double radius, int k);
+
+      /** \brief Check whether the cache holds neighborhoods of \a cloud searched in \a surface with the given
+        * search parameters.
+        * \param[in] cloud the cloud holding the query points
+        * \param[in] surface the search surface
+        * \param[in] radius the radius of a radiusSearch (), or 0
+        * \param[in] k the number of neighbors of a nearestKSearch (), or 0
+        */
+      template <typename PointT> inline bool
+      matches (const pcl::PointCloud<PointT> &cloud, const pcl::PointCloud<PointT> &surface, double radius, int k) const
+      {
+        return (cloud_ == &cloud && cloud.size () == cloud_size_ &&
+                surface_ == &surface && surface.size () == surface_size_ &&
+                radius_ == radius && k_ == k);
+      }
+
+      /** \brief Check whether the neighborhood of point \a index of the cloud is stored. */
+      inline bool
+      contains (pcl::index_t index) const
+      {
+        return (index >= 0 && static_cast<std::size_t> (index) < computed_.size () && computed_[index]);
+      }
+
+      /** \brief Copy the stored neighborhood of a point.
+        * \param[in] index the index of the query point in the cloud
+        * \param[out] indices the indices of its neighbors in the search surface
+        * \param[out] distances the squared distances to its neighbors
+        * \return false if the neighborhood of the point is not stored, leaving \a indices and \a distances untouched
+        */
+      inline bool
+      getNeighbors (pcl::index_t index, pcl::Indices &indices, std::vector<float> &distances) const
+      {
+        if (!contains (index))
+          return (false);
+        const auto first = offsets_[index], last = offsets_[index + 1];
+        indices.assign (indices_.begin () + first, indices_.begin () + last);
+        distances.assign (distances_.begin () + first, distances_.begin () + last);
+        return (true);
+      }
+
+      /** \brief Remove all neighborhoods from the cache. */
+      inline void
+      clear ()
+      {
+        offsets_.clear ();
+        indices_.clear ();
+        distances_.clear ();
+        computed_.clear ();
+        cloud_ = surface_ = nullptr;
+        cloud_size_ = surface_size_ = 0;
+        radius_ = 0;
+        k_ = 0;
+      }
+
+      /** \brief Check whether the cache is empty. */
+      inline bool
+      empty () const { return (cloud_ == nullptr); }
+
+      /** \brief Get the offsets of the neighborhoods in getIndices () and getDistances (), one more than the
+        * number of points of the cloud. */
+      inline const std::vector<std::size_t>&
+      getOffsets () const { return (offsets_); }
+
+      /** \brief Get the neighbor indices of all stored neighborhoods. */
+      inline const pcl::Indices&
+      getIndices () const { return (indices_); }
+
+      /** \brief Get the squared neighbor distances of all stored neighborhoods. */
+      inline const std::vector<float>&
+      getDistances () const { return (distances_); }
+
+    protected:
+      /** \brief The start of the neighborhood of each point of the cloud, followed by the end of the last one. */
+      std::vector<std::size_t> offsets_;
+
+      /** \brief The neighbor indices of all neighborhoods. */
+      pcl::Indices indices_;
+
+      /** \brief The squared neighbor distances of all neighborhoods. */
+      std::vector<float> distances_;
+
+      /** \brief Whether the neighborhood of each point of the cloud was searched. */
+      std::vector<bool> computed_;
+
+      /** \brief The cloud holding the query points, only used to recognize it. */
+      const void *cloud_ = nullptr;
+
+      /** \brief The number of points of the cloud. */
+      std::size_t cloud_size_ = 0;
+
+      /** \brief The search surface, only used to recognize it. */
+      const void *surface_ = nullptr;
+
+      /** \brief The number of points of the search surface. */
+      std::size_t surface_size_ = 0;
+
+      /** \brief The search radius, or 0 for a k-nearest neighbors search. */
+      double radius_ = 0;
+
+      /** \brief The number of nearest neighbors, or 0 for a radius search. */
+      int k_ = 0;
+
+      /** \brief The number of threads used to fill the cache. */
+      unsigned int threads_;
+  };
+}
+
+#include <pcl/features/impl/neighborhood_cache.hpp>
@@ -90,6 +90,9 @@ namespace pcl
       /** \brief The number of threads the scheduler should use. */
       unsigned int threads_;
 
+      /** \brief The number of points whose covariance matrices are solved together, see pcl::eigen33Batch. */
+      static constexpr std::ptrdiff_t batch_size_ = 64;
+
     private:
       /** \brief Estimate normals for all points given in <setInputCloud (), setIndices ()> using the surface in
         * setSearchSurface () and the spatial locator in setSearchMethod ()
@@ -51,6 +51,10 @@ namespace pcl
     * OrganizedEdgeFromNormals accepts PCL_XYZ_POINT_TYPES with PCL_NORMAL_POINT_TYPES and returns EDGELABEL_NAN_BOUNDARY, EDGELABEL_OCCLUDING, EDGELABEL_OCCLUDED, and EDGELABEL_HIGH_CURVATURE.
     * OrganizedEdgeFromRGBNormals accepts PCL_RGB_POINT_TYPES with PCL_NORMAL_POINT_TYPES and returns EDGELABEL_NAN_BOUNDARY, EDGELABEL_OCCLUDING, EDGELABEL_OCCLUDED, EDGELABEL_HIGH_CURVATURE, and EDGELABEL_RGB_CANNY.
     *
+    * The rows of the image are processed in parallel, see setNumberOfThreads. The labels and label indices
+    * passed to compute () are overwritten, so they can be reused from one frame to the next without
+    * reallocation.
+    *
     * \author Changhyun Choi
     */
   template <typename PointT, typename PointLT>
@@ -77,6 +81,7 @@ namespace pcl
         : th_depth_discon_ (0.02f)
         , max_search_neighbors_ (50)
         , detecting_edge_types_ (EDGELABEL_NAN_BOUNDARY | EDGELABEL_OCCLUDING | EDGELABEL_OCCLUDED)
+        , threads_ (0)
       {
       }
 
@@ -109,6 +114,16 @@ namespace pcl
         return (th_depth_discon_);
       }
 
+      /** \brief Set the number of threads to use.
+        * \param[in] nr_threads the number of hardware threads to use (0 sets the value back to automatic)
+        */
+      inline void
+      setNumberOfThreads (unsigned int nr_threads = 0)
+      {
+        // 0 is resolved against the budget of pcl::ExecutionContext at compute time
+        threads_ = nr_threads;
+      }
+
       /** \brief Set the max search distance for deciding occluding and occluded edges. */
       inline void
       setMaxSearchNeighbors (const int max_dist)
@@ -177,6 +192,9 @@ namespace pcl
 
       /** \brief The bit encoded value that represents edge types to detect */
       int detecting_edge_types_;
+
+      /** \brief The number of threads the scheduler should use. */
+      unsigned int threads_;
   };
 
   template <typename PointT, typename PointLT>
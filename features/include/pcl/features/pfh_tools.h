@@ -44,6 +44,8 @@
 #include <pcl/pcl_exports.h>
 #include <Eigen/Core>
 
+#include <cstddef>
+
 namespace pcl
 {
   /** \brief Compute the 4-tuple representation containing the three angles and one distance between two points
@@ -67,6 +69,25 @@ namespace pcl
                        const Eigen::Vector4f &p2, const Eigen::Vector4f &n2, 
                        float &f1, float &f2, float &f3, float &f4);
 
+  /** \brief Compute the 4-tuple representations between one point and each of a batch of other points, like
+    * computePairFeatures (p1, n1, p2, n2, f1, f2, f3, f4) does for a single pair. Several pairs are computed
+    * at once, one per SIMD lane, with the instruction set chosen by pcl::getSIMDLevel (); the results agree
+    * with the single pair version up to rounding errors. The features of a pair that the single pair version
+    * rejects are all set to zero, as there.
+    * \param[in] p1 the first XYZ point
+    * \param[in] n1 the first surface normal
+    * \param[in] x2, y2, z2 the coordinates of the second points
+    * \param[in] nx2, ny2, nz2 the surface normals of the second points
+    * \param[in] count the number of second points
+    * \param[out] f1, f2, f3, f4 the features of each pair, see computePairFeatures
+    * \ingroup features
+    */
+  PCL_EXPORTS void
+  computePairFeatures (const Eigen::Vector4f &p1, const Eigen::Vector4f &n1,
+                       const float *x2, const float *y2, const float *z2,
+                       const float *nx2, const float *ny2, const float *nz2, std::size_t count,
+                       float *f1, float *f2, float *f3, float *f4);
+
   PCL_EXPORTS bool
   computeRGBPairFeatures (const Eigen::Vector4f &p1, const Eigen::Vector4f &n1, const Eigen::Vector4i &colors1,
                           const Eigen::Vector4f &p2, const Eigen::Vector4f &n2, const Eigen::Vector4i &colors2,
@@ -50,7 +50,7 @@ namespace pcl
     * The recommended PointOutT is pcl::PrincipalCurvatures.
     *
     * \note The code is stateful as we do not expect this class to be multicore parallelized. Please look at
-    * \ref NormalEstimationOMP for an example on how to extend this to parallel implementations.
+    * \ref PrincipalCurvaturesEstimationOMP for the parallel implementation.
     *
     * \author Radu B. Rusu, Jared Glover
     * \ingroup features
@@ -74,12 +74,7 @@ namespace pcl
       using PointCloudIn = pcl::PointCloud<PointInT>;
 
       /** \brief Empty constructor. */
-      PrincipalCurvaturesEstimation () : 
-        xyz_centroid_ (Eigen::Vector3f::Zero ()), 
-        demean_ (Eigen::Vector3f::Zero ()),
-        covariance_matrix_ (Eigen::Matrix3f::Zero ()),
-        eigenvector_ (Eigen::Vector3f::Zero ()),
-        eigenvalues_ (Eigen::Vector3f::Zero ())
+      PrincipalCurvaturesEstimation ()
       {
         feature_name_ = "PrincipalCurvaturesEstimation";
       };
@@ -102,6 +97,24 @@ namespace pcl
                                        float &pcx, float &pcy, float &pcz, float &pc1, float &pc2);
 
     protected:
+      using ProjectedNormals = std::vector<Eigen::Vector3f, Eigen::aligned_allocator<Eigen::Vector3f> >;
+
+      /** \brief Compute the principal curvatures of a surface patch like the public
+        * computePointPrincipalCurvatures, without touching the state of the object.
+        * \param[in] normals the point cloud normals
+        * \param[in] p_idx the query point at which the least-squares plane was estimated
+        * \param[in] indices the point cloud indices that need to be used
+        * \param[out] projected_normals buffer for the normals projected into the tangent plane, reused between calls
+        * \param[out] pcx the principal curvature X direction
+        * \param[out] pcy the principal curvature Y direction
+        * \param[out] pcz the principal curvature Z direction
+        * \param[out] pc1 the max eigenvalue of curvature
+        * \param[out] pc2 the min eigenvalue of curvature
+        */
+      void
+      computePointPrincipalCurvatures (const pcl::PointCloud<PointNT> &normals,
+                                       int p_idx, const pcl::Indices &indices, ProjectedNormals &projected_normals,
+                                       float &pcx, float &pcy, float &pcz, float &pc1, float &pc2) const;
 
       /** \brief Estimate the principal curvature (eigenvector of the max eigenvalue), along with both the max (pc1)
         * and min (pc2) eigenvalues for all points given in <setInputCloud (), setIndices ()> using the surface in
@@ -112,22 +125,8 @@ namespace pcl
       computeFeature (PointCloudOut &output) override;
 
     private:
-      /** \brief A pointer to the input dataset that contains the point normals of the XYZ dataset. */
-      std::vector<Eigen::Vector3f, Eigen::aligned_allocator<Eigen::Vector3f> > projected_normals_;
-
-      /** \brief SSE aligned placeholder for the XYZ centroid of a surface patch. */
-      Eigen::Vector3f xyz_centroid_;
-
-      /** \brief Temporary point placeholder. */
-      Eigen::Vector3f demean_;
-
-      /** \brief Placeholder for the 3x3 covariance matrix at each surface patch. */
-      EIGEN_ALIGN16 Eigen::Matrix3f covariance_matrix_;
-
-      /** \brief SSE aligned eigenvectors placeholder for a covariance matrix. */
-      Eigen::Vector3f eigenvector_;
-      /** \brief eigenvalues placeholder for a covariance matrix. */
-      Eigen::Vector3f eigenvalues_;
+      /** \brief The normals of a surface patch projected into its tangent plane, reused between points. */
+      ProjectedNormals projected_normals_;
   };
 }
 
@@ -88,7 +88,7 @@ namespace pcl
       {
         Parameters () : max_no_of_threads(1), pixel_radius_borders (3), pixel_radius_plane_extraction (2), pixel_radius_border_direction (2), 
                        minimum_border_probability (0.8f), pixel_radius_principal_curvature (2) {}
-        int max_no_of_threads;
+        int max_no_of_threads;  //!< 0 takes as many threads as the budget of pcl::ExecutionContext allows
         int pixel_radius_borders;
         int pixel_radius_plane_extraction;
         int pixel_radius_border_direction;
@@ -191,6 +191,20 @@ namespace pcl
       
       float* surface_change_scores_;
       Eigen::Vector3f* surface_change_directions_;
+
+      // Storage behind the pointers above. clearData () only resets the pointers, so that the memory can be reused
+      // for the next range image of the same size (e.g. when processing a stream of range images).
+      std::vector<LocalSurface> local_surfaces_buffer_;
+      std::vector<LocalSurface*> surface_structure_buffer_;
+      PointCloudOut border_descriptions_buffer_;
+      std::vector<ShadowBorderIndices> shadow_border_indices_buffer_;
+      std::vector<ShadowBorderIndices*> shadow_border_informations_buffer_;
+      std::vector<Eigen::Vector3f> border_directions_values_buffer_, average_border_directions_values_buffer_;
+      std::vector<Eigen::Vector3f*> border_directions_buffer_, average_border_directions_buffer_;
+      std::vector<float> surface_change_scores_buffer_;
+      std::vector<Eigen::Vector3f> surface_change_directions_buffer_;
+      std::vector<float> border_scores_buffer_;            //!< scratch image for the neighbor based score update
+      std::vector<unsigned char> border_maxima_buffer_;    //!< per pixel bit mask of the directions that are border maxima
       
       
       // =====PROTECTED METHODS=====
@@ -350,8 +364,9 @@ namespace pcl
       computeFeature (PointCloudOut &output) override;
 
     private:
-      std::vector<float>
-      updatedScoresAccordingToNeighborValues (const std::vector<float>& border_scores) const;
+      void
+      updatedScoresAccordingToNeighborValues (const std::vector<float>& border_scores,
+                                              std::vector<float>& new_border_scores) const;
   };
 }  // namespace end
 
@@ -43,7 +43,6 @@
 #include <pcl/pcl_macros.h>
 #include <pcl/Vertices.h> // for Vertices
 #include <pcl/features/feature.h>
-#include <set>
 
 namespace pcl
 {
@@ -51,6 +50,8 @@ namespace pcl
     * This class implements the method for extracting RoPS features presented in the article
     * "Rotational Projection Statistics for 3D Local Surface Description and Object Recognition" by
     * Yulan Guo, Ferdous Sohel, Mohammed Bennamoun, Min Lu and Jianwei Wan.
+    *
+    * See ROPSEstimationOMP for a parallel implementation.
     */
   template <typename PointInT, typename PointOutT>
   class PCL_EXPORTS ROPSEstimation : public pcl::Feature <PointInT, PointOutT>
@@ -116,7 +117,23 @@ namespace pcl
       void
       getTriangles (std::vector <pcl::Vertices>& triangles) const;
 
-    private:
+    protected:
+
+      /** \brief Working buffers of the descriptor computation of one point, reused from one point to the next. */
+      struct Scratch
+      {
+        pcl::Indices local_points;
+        std::vector<float> local_distances;
+        std::vector<unsigned int> local_triangles;
+        std::vector<Eigen::Matrix3f, Eigen::aligned_allocator<Eigen::Matrix3f> > scatter_matrices;
+        std::vector<float> triangle_area;
+        std::vector<float> distance_weight;
+        PointCloudIn transformed_cloud;
+        PointCloudIn rotated_cloud;
+        Eigen::MatrixXf distribution_matrix;
+        std::vector<float> moments;
+        std::vector<float> feature;
+      };
 
       /** \brief Abstract feature estimation method.
         * \param[out] output the resultant features
@@ -124,8 +141,17 @@ namespace pcl
       void
       computeFeature (PointCloudOut& output) override;
 
+      /** \brief This method computes the RoPS descriptor of the given point.
+        * \param[in] point point for which the descriptor is computed
+        * \param[in,out] scratch working buffers, reused between calls
+        * \param[out] histogram stores the number_of_rotations * 45 values of the descriptor
+        */
+      void
+      computePointFeature (const PointInT& point, Scratch& scratch, float* histogram) const;
+
       /** \brief This method simply builds the list of triangles for every point.
-        * The list of triangles for each point consists of indices of triangles it belongs to.
+        * The lists are stored back to back in one array (compressed sparse rows), the triangles of
+        * point i are point_triangles_[point_triangles_offsets_[i]] to point_triangles_[point_triangles_offsets_[i + 1] - 1].
         * The only purpose of this method is to improve performance of the algorithm.
         */
       void
@@ -133,19 +159,21 @@ namespace pcl
 
       /** \brief This method crops all the triangles within the given radius of the given point.
         * \param[in] point point for which the local surface is computed
-        * \param[out] local_triangles stores the indices of the triangles that belong to the local surface
+        * \param[out] local_triangles stores the sorted indices of the triangles that belong to the local surface
         * \param[out] local_points stores the indices of the points that belong to the local surface
+        * \param[out] distances stores the squared distances of local_points to the given point
         */
       void
-      getLocalSurface (const PointInT& point, std::set <unsigned int>& local_triangles, pcl::Indices& local_points) const;
+      getLocalSurface (const PointInT& point, std::vector <unsigned int>& local_triangles, pcl::Indices& local_points,
+                       std::vector <float>& distances) const;
 
       /** \brief This method computes LRF (Local Reference Frame) matrix for the given point.
         * \param[in] point point for which the LRF is computed
-        * \param[in] local_triangles list of triangles that represents the local surface of the point
+        * \param[in,out] scratch working buffers, local_triangles has to hold the triangles of the local surface
         * \paran[out] lrf_matrix stores computed LRF matrix for the given point
         */
       void
-      computeLRF (const PointInT& point, const std::set <unsigned int>& local_triangles, Eigen::Matrix3f& lrf_matrix) const;
+      computeLRF (const PointInT& point, Scratch& scratch, Eigen::Matrix3f& lrf_matrix) const;
 
       /** \brief This method calculates the eigen values and eigen vectors
         * for the given covariance matrix. Note that it returns normalized eigen
@@ -199,8 +227,6 @@ namespace pcl
       void
       computeCentralMoments (const Eigen::MatrixXf& matrix, std::vector <float>& moments) const;
 
-    private:
-
       /** \brief Stores the number of partition bins that is used for distribution matrix calculation. */
       unsigned int number_of_bins_;
 
@@ -219,8 +245,11 @@ namespace pcl
       /** \brief Stores the set of triangles representing the mesh. */
       std::vector <pcl::Vertices> triangles_;
 
-      /** \brief Stores the set of triangles for each point. Its purpose is to improve performance. */
-      std::vector <std::vector <unsigned int> > triangles_of_the_point_;
+      /** \brief Stores the triangles of all points, see buildListOfPointsTriangles. Its purpose is to improve performance. */
+      std::vector <unsigned int> point_triangles_;
+
+      /** \brief Stores where the triangles of each point start in point_triangles_, plus the total count. */
+      std::vector <unsigned int> point_triangles_offsets_;
 
     public:
       PCL_MAKE_ALIGNED_OPERATOR_NEW
@@ -0,0 +1,260 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#pragma once
+
+#include <pcl/features/feature.h>
+
+namespace pcl
+{
+  /** \brief Fast approximate surface normal estimation for organized scans, most notably lidar sweeps
+    * stored with one row per ring / scan line (as delivered by most spinning lidar drivers, or as produced
+    * by RangeImageSpherical).
+    *
+    * Instead of a k-nearest neighbor or radius search, the neighborhood of every point is a fixed window
+    * of the image grid, e.g. 3 rings by 5 columns. Neighbors whose range differs too much from the range of
+    * the center point are rejected so that normals do not bleed across depth discontinuities. The normal and
+    * curvature are then obtained from the covariance matrix of the remaining neighbors, as in
+    * NormalEstimation, so the result has the same fields and conventions.
+    *
+    * \note Points that are not finite, or that have fewer than \a min_neighbors valid neighbors in
+    * their window, get NaN normals and curvature.
+    * \ingroup features
+    */
+  template <typename PointInT, typename PointOutT>
+  class ScanlineNormalEstimation : public Feature<PointInT, PointOutT>
+  {
+    public:
+      using Ptr = shared_ptr<ScanlineNormalEstimation<PointInT, PointOutT> >;
+      using ConstPtr = shared_ptr<const ScanlineNormalEstimation<PointInT, PointOutT> >;
+      using PointCloudIn = typename Feature<PointInT, PointOutT>::PointCloudIn;
+      using PointCloudOut = typename Feature<PointInT, PointOutT>::PointCloudOut;
+      using Feature<PointInT, PointOutT>::input_;
+      using Feature<PointInT, PointOutT>::indices_;
+      using Feature<PointInT, PointOutT>::feature_name_;
+      using Feature<PointInT, PointOutT>::tree_;
+      using Feature<PointInT, PointOutT>::k_;
+      using Feature<PointInT, PointOutT>::getClassName;
+
+      /** \brief Constructor
+        * \param[in] nr_threads the number of hardware threads to use (0 takes as many as the budget of pcl::ExecutionContext allows when estimating the normals)
+        */
+      ScanlineNormalEstimation (unsigned int nr_threads = 1)
+        : window_rows_ (3)
+        , window_cols_ (5)
+        , min_neighbors_ (3)
+        , max_range_change_factor_ (0.1f)
+        , wrap_around_ (false)
+        , vpx_ (0)
+        , vpy_ (0)
+        , vpz_ (0)
+        , use_sensor_origin_ (true)
+      {
+        feature_name_ = "ScanlineNormalEstimation";
+        tree_.reset ();
+        k_ = 1;
+        setNumberOfThreads (nr_threads);
+      }
+
+      /** \brief Set the size of the neighborhood window on the image grid.
+        * \param[in] rows the number of rows (rings) of the window, must be odd
+        * \param[in] cols the number of columns of the window, must be odd
+        */
+      inline void
+      setWindowSize (int rows, int cols)
+      {
+        window_rows_ = rows;
+        window_cols_ = cols;
+      }
+
+      /** \brief Get the size of the neighborhood window on the image grid. */
+      inline void
+      getWindowSize (int &rows, int &cols) const
+      {
+        rows = window_rows_;
+        cols = window_cols_;
+      }
+
+      /** \brief Set the minimum number of valid neighbors (including the point itself) needed to estimate a normal.
+        * \param[in] min_neighbors the minimum number of neighbors, at least 3
+        */
+      inline void
+      setMinNeighbors (int min_neighbors) { min_neighbors_ = min_neighbors; }
+
+      /** \brief Get the minimum number of valid neighbors needed to estimate a normal. */
+      inline int
+      getMinNeighbors () const { return (min_neighbors_); }
+
+      /** \brief Set the maximum relative range change between a point and its neighbors. A neighbor q of p is
+        * only used if | |q - vp| - |p - vp| | <= factor * |p - vp|, with vp the viewpoint.
+        * \param[in] max_range_change_factor the relative range threshold
+        */
+      inline void
+      setMaxRangeChangeFactor (float max_range_change_factor) { max_range_change_factor_ = max_range_change_factor; }
+
+      /** \brief Get the maximum relative range change between a point and its neighbors. */
+      inline float
+      getMaxRangeChangeFactor () const { return (max_range_change_factor_); }
+
+      /** \brief Set whether the first and last column of the image are neighbors, as is the case for a full
+        * 360 degree sweep.
+        * \param[in] wrap_around true if the columns wrap around
+        */
+      inline void
+      setWrapAround (bool wrap_around) { wrap_around_ = wrap_around; }
+
+      /** \brief Get whether the first and last column of the image are neighbors. */
+      inline bool
+      getWrapAround () const { return (wrap_around_); }
+
+      /** \brief Initialize the scheduler and set the number of threads to use.
+        * \param nr_threads the number of hardware threads to use (0 takes as many as the budget of pcl::ExecutionContext allows when estimating the normals)
+        */
+      void
+      setNumberOfThreads (unsigned int nr_threads = 0);
+
+      /** \brief Provide a pointer to the input dataset
+        * \param cloud the const boost shared pointer to a PointCloud message
+        */
+      inline void
+      setInputCloud (const typename PointCloudIn::ConstPtr &cloud) override
+      {
+        input_ = cloud;
+        if (use_sensor_origin_)
+        {
+          vpx_ = input_->sensor_origin_.coeff (0);
+          vpy_ = input_->sensor_origin_.coeff (1);
+          vpz_ = input_->sensor_origin_.coeff (2);
+        }
+      }
+
+      /** \brief Set the viewpoint.
+        * \param vpx the X coordinate of the viewpoint
+        * \param vpy the Y coordinate of the viewpoint
+        * \param vpz the Z coordinate of the viewpoint
+        */
+      inline void
+      setViewPoint (float vpx, float vpy, float vpz)
+      {
+        vpx_ = vpx;
+        vpy_ = vpy;
+        vpz_ = vpz;
+        use_sensor_origin_ = false;
+      }
+
+      /** \brief Get the viewpoint.
+        * \param [out] vpx x-coordinate of the view point
+        * \param [out] vpy y-coordinate of the view point
+        * \param [out] vpz z-coordinate of the view point
+        */
+      inline void
+      getViewPoint (float &vpx, float &vpy, float &vpz)
+      {
+        vpx = vpx_;
+        vpy = vpy_;
+        vpz = vpz_;
+      }
+
+      /** \brief Use the sensor origin of the input cloud as the viewpoint (the default). */
+      inline void
+      useSensorOriginAsViewPoint ()
+      {
+        use_sensor_origin_ = true;
+        if (input_)
+        {
+          vpx_ = input_->sensor_origin_.coeff (0);
+          vpy_ = input_->sensor_origin_.coeff (1);
+          vpz_ = input_->sensor_origin_.coeff (2);
+        }
+        else
+        {
+          vpx_ = 0;
+          vpy_ = 0;
+          vpz_ = 0;
+        }
+      }
+
+    protected:
+      /** \brief This method should get called before starting the actual computation. Unlike
+        * Feature::initCompute () it does not set up a search method, since none is needed. */
+      bool
+      initCompute () override;
+
+      /** \brief Estimate normals for all points given in <setInputCloud (), setIndices ()>.
+        * \param output the resultant point cloud model dataset that contains surface normals and curvatures
+        */
+      void
+      computeFeature (PointCloudOut &output) override;
+
+      /** \brief Accumulate the covariance matrix of the window around a point.
+        * \param[in] u the column of the point
+        * \param[in] v the row of the point
+        * \param[out] covariance the upper triangle of the covariance matrix (xx, xy, xz, yy, yz, zz)
+        * \return the number of valid neighbors
+        */
+      int
+      computeWindowCovariance (int u, int v, float *covariance) const;
+
+      /** \brief The number of rows of the neighborhood window. */
+      int window_rows_;
+
+      /** \brief The number of columns of the neighborhood window. */
+      int window_cols_;
+
+      /** \brief The minimum number of valid neighbors needed to estimate a normal. */
+      int min_neighbors_;
+
+      /** \brief The maximum relative range change between a point and its neighbors. */
+      float max_range_change_factor_;
+
+      /** \brief Whether the first and last column of the image are neighbors. */
+      bool wrap_around_;
+
+      /** \brief Values describing the viewpoint. By default, the sensor origin of the input cloud is used. */
+      float vpx_, vpy_, vpz_;
+
+      /** whether the sensor origin of the input cloud or a user given viewpoint should be used.*/
+      bool use_sensor_origin_;
+
+      /** \brief The number of threads the scheduler should use. */
+      unsigned int threads_;
+  };
+}
+
+#ifdef PCL_NO_PRECOMPILE
+#include <pcl/features/impl/scanline_normal.hpp>
+#endif
@@ -43,9 +43,35 @@
 #include <pcl/features/feature.h>
 
 #include <array>  // for sRGB_LUT, sXYZ_LUT
+#include <cstddef>
 
 namespace pcl
 {
+  /** \brief Express count neighbors of a SHOT feature point in its local reference frame, and compute the
+    * quantities the spatial grid of the descriptor is interpolated on, with SIMD instructions when the CPU
+    * has them (see pcl::getSIMDLevel).
+    *
+    * Coordinates whose magnitude is below 1e-30 are set to zero, and the angles are computed from them.
+    * \param[in] frame the x, y and z axis of the local reference frame, one after the other
+    * \param[in] dx the x coordinates of the neighbors, relative to the feature point
+    * \param[in] dy the y coordinates of the neighbors, relative to the feature point
+    * \param[in] dz the z coordinates of the neighbors, relative to the feature point
+    * \param[in] sqr_dists the squared distances of the neighbors to the feature point
+    * \param[in] count the number of neighbors
+    * \param[out] x the coordinates of the neighbors along the x axis of the frame
+    * \param[out] y the coordinates of the neighbors along the y axis of the frame
+    * \param[out] z the coordinates of the neighbors along the z axis of the frame
+    * \param[out] distance the distances of the neighbors, i.e. the square roots of sqr_dists
+    * \param[out] inclination the angles, in [0, pi], between the z axis and the neighbors
+    * \param[out] azimuth the angles, in [-pi, pi], of the neighbors projected on the xy plane
+    * \ingroup features
+    */
+  PCL_EXPORTS void
+  computeSHOTLocalCoordinates (const float *frame,
+                               const float *dx, const float *dy, const float *dz, const float *sqr_dists,
+                               std::size_t count, float *x, float *y, float *z,
+                               float *distance, float *inclination, float *azimuth);
+
   /** \brief SHOTEstimation estimates the Signature of Histograms of OrienTations (SHOT) descriptor for
     * a given point cloud dataset containing points and normals.
     *
@@ -68,7 +68,7 @@ namespace pcl
       using Ptr = shared_ptr<SHOTLocalReferenceFrameEstimation<PointInT, PointOutT> >;
       using ConstPtr = shared_ptr<const SHOTLocalReferenceFrameEstimation<PointInT, PointOutT> >;
       /** \brief Constructor */
-      SHOTLocalReferenceFrameEstimation ()
+      SHOTLocalReferenceFrameEstimation () : fast_mode_ (false)
       {
         feature_name_ = "SHOTLocalReferenceFrameEstimation";
       }
@@ -76,6 +76,19 @@ namespace pcl
       /** \brief Empty destructor */
       ~SHOTLocalReferenceFrameEstimation () {}
 
+      /** \brief Set whether the local reference frames are computed in single precision, with a closed form
+        * eigen solver (see pcl::eigen33) instead of an iterative double precision one. The frames match the
+        * default ones up to rounding errors, except for neighborhoods whose covariance has (nearly) repeated
+        * eigenvalues, where the axes are not well defined anyway.
+        * \param[in] fast_mode true to use the single precision path, false (default) otherwise
+        */
+      inline void
+      setFastMode (bool fast_mode) { fast_mode_ = fast_mode; }
+
+      /** \brief Get whether the local reference frames are computed in single precision. */
+      inline bool
+      getFastMode () const { return (fast_mode_); }
+
     protected:
       using Feature<PointInT, PointOutT>::feature_name_;
       using Feature<PointInT, PointOutT>::getClassName;
@@ -96,11 +109,21 @@ namespace pcl
       float
       getLocalRF (const int &index, Eigen::Matrix3f &rf);
 
+      /** \brief Computes disambiguated local RF for a point index, with all the math done in Scalar
+        * \param[in] index the index
+        * \param[out] rf reference frame to compute
+        */
+      template <typename Scalar> float
+      computeLocalRF (const int &index, Eigen::Matrix3f &rf);
+
       /** \brief Feature estimation method.
         * \param[out] output the resultant features
         */
       void
       computeFeature (PointCloudOut &output) override;
+
+      /** \brief Whether the local reference frames are computed in single precision. */
+      bool fast_mode_;
   };
 }
 
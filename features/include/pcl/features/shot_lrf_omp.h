@@ -80,7 +80,7 @@ namespace pcl
     ~SHOTLocalReferenceFrameEstimationOMP () {}
 
     /** \brief Initialize the scheduler and set the number of threads to use.
-     * \param nr_threads the number of hardware threads to use (0 sets the value back to automatic)
+     * \param nr_threads the number of hardware threads to use (0 takes as many as the budget of pcl::ExecutionContext allows when computing)
      */
     void
     setNumberOfThreads (unsigned int nr_threads = 0);
@@ -254,6 +254,17 @@ namespace pcl
       bool
       initCompute () override;
 
+      /** \brief Buffers reused by computeSiForPoint from one point to the next. */
+      struct Scratch
+      {
+        /** \brief The spin-image of the last point. */
+        Eigen::ArrayXXd matrix;
+        /** \brief The accumulated angles of the angular spin-image. */
+        Eigen::ArrayXXd aver_angles;
+        pcl::Indices nn_indices;
+        std::vector<float> nn_sqr_dists;
+      };
+
       /** \brief Computes a spin-image for the point of the scan. 
         * \param[in] index the index of the reference point in the input cloud
         * \return estimated spin-image (or its variant) as a matrix
@@ -261,6 +272,14 @@ namespace pcl
       Eigen::ArrayXXd 
       computeSiForPoint (int index) const;
 
+      /** \brief Computes a spin-image for the point of the scan without allocating memory once the
+        * buffers have grown to their final size.
+        * \param[in] index the index of the reference point in the input cloud
+        * \param[in,out] scratch the buffers to use, the estimated spin-image is stored in scratch.matrix
+        */
+      void
+      computeSiForPoint (int index, Scratch &scratch) const;
+
     private:
       PointCloudNConstPtr input_normals_;
       PointCloudNConstPtr rotation_axes_cloud_;
@@ -148,6 +148,12 @@ namespace pcl
       bool
       initCompute () override;
 
+      /** \brief Allocate the intervals and the volume lookup table, the part of initCompute () that follows
+        * the estimation of the local reference frames.
+        */
+      bool
+      initLookupTables ();
+
       /** \brief The actual feature computation.
         * \param[out] output the resultant features
         */
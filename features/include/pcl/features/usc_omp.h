@@ -0,0 +1,133 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2019-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <pcl/point_types.h>
+#include <pcl/features/feature.h>
+#include <pcl/features/usc.h>
+
+#include <vector>
+
+namespace pcl
+{
+  /** \brief UniqueShapeContextOMP estimates the Unique Shape Context descriptor of a point cloud in parallel,
+    * using the OpenMP standard. See UniqueShapeContext for the descriptor and its parameters.
+    *
+    * The default local reference frames are estimated with SHOTLocalReferenceFrameEstimationOMP. The local
+    * point density, which weighs the contribution of a neighbor, is looked up in a table computed once for
+    * every point of the search surface that is a neighbor of a query point, instead of being searched for
+    * again in each neighborhood the point belongs to. The descriptors are identical to the ones of
+    * UniqueShapeContext.
+    *
+    * \ingroup features
+    */
+  template <typename PointInT, typename PointOutT = pcl::UniqueShapeContext1960, typename PointRFT = pcl::ReferenceFrame>
+  class UniqueShapeContextOMP : public UniqueShapeContext<PointInT, PointOutT, PointRFT>
+  {
+    public:
+      using Ptr = shared_ptr<UniqueShapeContextOMP<PointInT, PointOutT, PointRFT> >;
+      using ConstPtr = shared_ptr<const UniqueShapeContextOMP<PointInT, PointOutT, PointRFT> >;
+      using Feature<PointInT, PointOutT>::feature_name_;
+      using Feature<PointInT, PointOutT>::getClassName;
+      using Feature<PointInT, PointOutT>::indices_;
+      using Feature<PointInT, PointOutT>::search_radius_;
+      using Feature<PointInT, PointOutT>::surface_;
+      using Feature<PointInT, PointOutT>::fake_surface_;
+      using Feature<PointInT, PointOutT>::input_;
+      using FeatureWithLocalReferenceFrames<PointInT, PointRFT>::frames_;
+      using UniqueShapeContext<PointInT, PointOutT, PointRFT>::radii_interval_;
+      using UniqueShapeContext<PointInT, PointOutT, PointRFT>::theta_divisions_;
+      using UniqueShapeContext<PointInT, PointOutT, PointRFT>::phi_divisions_;
+      using UniqueShapeContext<PointInT, PointOutT, PointRFT>::volume_lut_;
+      using UniqueShapeContext<PointInT, PointOutT, PointRFT>::elevation_bins_;
+      using UniqueShapeContext<PointInT, PointOutT, PointRFT>::radius_bins_;
+      using UniqueShapeContext<PointInT, PointOutT, PointRFT>::point_density_radius_;
+      using UniqueShapeContext<PointInT, PointOutT, PointRFT>::descriptor_length_;
+      using UniqueShapeContext<PointInT, PointOutT, PointRFT>::local_radius_;
+
+      using PointCloudOut = typename Feature<PointInT, PointOutT>::PointCloudOut;
+
+      /** \brief Constructor.
+        * \param[in] nr_threads the number of hardware threads to use (0 sets the value back to automatic)
+        */
+      UniqueShapeContextOMP (unsigned int nr_threads = 0)
+      {
+        feature_name_ = "UniqueShapeContextOMP";
+
+        setNumberOfThreads (nr_threads);
+      }
+
+      /** \brief Initialize the scheduler and set the number of threads to use.
+        * \param[in] nr_threads the number of hardware threads to use (0 sets the value back to automatic)
+        */
+      void
+      setNumberOfThreads (unsigned int nr_threads = 0);
+
+    protected:
+      /** \brief Initialize computation by estimating the local reference frames in parallel and allocating
+        * all the intervals and the volume lookup table.
+        */
+      bool
+      initCompute () override;
+
+      /** \brief Compute the descriptor of a point from its neighborhood, without touching the state of the
+        * object.
+        * \param[in] index point index in indices_
+        * \param[in] nn_indices the indices of the neighbors in the search surface
+        * \param[in] nn_dists the squared distances of the neighbors
+        * \param[in] point_density the local point density of the points of the search surface
+        * \param[out] desc the descriptor, of descriptor_length_ values, which are accumulated into
+        */
+      void
+      computePointDescriptor (std::size_t index, const pcl::Indices &nn_indices, const std::vector<float> &nn_dists,
+                              const std::vector<float> &point_density, float *desc) const;
+
+      /** \brief Estimate the Unique Shape Context descriptors in parallel.
+        * \param[out] output the resultant features
+        */
+      void
+      computeFeature (PointCloudOut &output) override;
+
+    private:
+      /** \brief The number of threads the scheduler should use. */
+      unsigned int threads_;
+  };
+}
+
+#ifdef PCL_NO_PRECOMPILE
+#include <pcl/features/impl/usc_omp.hpp>
+#endif
@@ -37,6 +37,7 @@
  */
 
 #include <pcl/features/impl/3dsc.hpp>
+#include <pcl/features/impl/3dsc_omp.hpp>
 
 #ifndef PCL_NO_PRECOMPILE
 #include <pcl/point_types.h>
@@ -44,8 +45,10 @@
 // Instantiations of specific point types
 #ifdef PCL_ONLY_CORE_POINT_TYPES
   PCL_INSTANTIATE_PRODUCT(ShapeContext3DEstimation, ((pcl::PointXYZ)(pcl::PointXYZI)(pcl::PointXYZRGBA))((pcl::Normal))((pcl::ShapeContext1980)))
+  PCL_INSTANTIATE_PRODUCT(ShapeContext3DEstimationOMP, ((pcl::PointXYZ)(pcl::PointXYZI)(pcl::PointXYZRGBA))((pcl::Normal))((pcl::ShapeContext1980)))
 #else
   PCL_INSTANTIATE_PRODUCT(ShapeContext3DEstimation, (PCL_XYZ_POINT_TYPES)(PCL_NORMAL_POINT_TYPES)((pcl::ShapeContext1980)))
+  PCL_INSTANTIATE_PRODUCT(ShapeContext3DEstimationOMP, (PCL_XYZ_POINT_TYPES)(PCL_NORMAL_POINT_TYPES)((pcl::ShapeContext1980)))
 #endif
 #endif    // PCL_NO_PRECOMPILE
 
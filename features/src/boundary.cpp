@@ -37,6 +37,7 @@
  */
 
 #include <pcl/features/impl/boundary.hpp>
+#include <pcl/features/impl/boundary_omp.hpp>
 
 #ifndef PCL_NO_PRECOMPILE
 #include <pcl/point_types.h>
@@ -44,8 +45,10 @@
 // Instantiations of specific point types
 #ifdef PCL_ONLY_CORE_POINT_TYPES
   PCL_INSTANTIATE_PRODUCT(BoundaryEstimation, ((pcl::PointXYZ)(pcl::PointXYZI)(pcl::PointXYZRGBA)(pcl::PointXYZRGBNormal)(pcl::PointNormal))((pcl::PointXYZRGBNormal)(pcl::Normal)(pcl::PointNormal))((pcl::Boundary)))
+  PCL_INSTANTIATE_PRODUCT(BoundaryEstimationOMP, ((pcl::PointXYZ)(pcl::PointXYZI)(pcl::PointXYZRGBA)(pcl::PointXYZRGBNormal)(pcl::PointNormal))((pcl::PointXYZRGBNormal)(pcl::Normal)(pcl::PointNormal))((pcl::Boundary)))
 #else
   PCL_INSTANTIATE_PRODUCT(BoundaryEstimation, (PCL_XYZ_POINT_TYPES)(PCL_NORMAL_POINT_TYPES)((pcl::Boundary)))
+  PCL_INSTANTIATE_PRODUCT(BoundaryEstimationOMP, (PCL_XYZ_POINT_TYPES)(PCL_NORMAL_POINT_TYPES)((pcl::Boundary)))
 #endif
 #endif    // PCL_NO_PRECOMPILE
 
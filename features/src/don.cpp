@@ -38,14 +38,17 @@
  */
 
 #include <pcl/features/impl/don.hpp>
+#include <pcl/features/impl/multiscale_normal_3d_omp.hpp>
 
 #ifndef PCL_NO_PRECOMPILE
 #include <pcl/point_types.h>
 #include <pcl/impl/instantiate.hpp>
 #ifdef PCL_ONLY_CORE_POINT_TYPES
   PCL_INSTANTIATE_PRODUCT(DifferenceOfNormalsEstimation, ((pcl::PointXYZ)(pcl::PointXYZI)(pcl::PointXYZRGB)(pcl::PointXYZRGBA)(pcl::PointNormal))((pcl::Normal)(pcl::PointNormal))((pcl::Normal)(pcl::PointNormal)))
+  PCL_INSTANTIATE_PRODUCT(MultiscaleNormalEstimationOMP, ((pcl::PointXYZ)(pcl::PointXYZI)(pcl::PointXYZRGB)(pcl::PointXYZRGBA)(pcl::PointNormal))((pcl::Normal)(pcl::PointNormal))((pcl::Normal)(pcl::PointNormal)))
 #else
   PCL_INSTANTIATE_PRODUCT(DifferenceOfNormalsEstimation, (PCL_XYZ_POINT_TYPES)(PCL_NORMAL_POINT_TYPES)(PCL_NORMAL_POINT_TYPES))
+  PCL_INSTANTIATE_PRODUCT(MultiscaleNormalEstimationOMP, (PCL_XYZ_POINT_TYPES)(PCL_NORMAL_POINT_TYPES)(PCL_NORMAL_POINT_TYPES))
 #endif
 #endif    // PCL_NO_PRECOMPILE
 
@@ -37,7 +37,9 @@
 
 #include <pcl/features/narf.h>
 #include <pcl/features/narf_descriptor.h>
+#include <pcl/common/execution_context.h>
 
+#include <algorithm>
 #include <iostream>
 #include <fstream>
 #include <cmath>
@@ -369,11 +371,13 @@ void
 Narf::extractForInterestPoints (const RangeImage& range_image, const PointCloud<InterestPoint>& interest_points,
                                 int descriptor_size, float support_size, bool rotation_invariant, std::vector<Narf*>& feature_list)
 {
+  const pcl::ThreadReservation reservation (static_cast<unsigned int> (std::max (max_no_of_threads, 0)));
+  const unsigned int threads = reservation.getNumberOfThreads ();
 #pragma omp parallel for \
   default(none) \
   shared(descriptor_size, feature_list, interest_points, range_image, rotation_invariant, support_size) \
   schedule(dynamic, 10) \
-  num_threads(max_no_of_threads)
+  num_threads(threads)
   //!!! nizar 20110408 : for OpenMP sake on MSVC this must be kept signed
   for (std::ptrdiff_t idx = 0; idx < static_cast<std::ptrdiff_t>(interest_points.size ()); ++idx)
   {
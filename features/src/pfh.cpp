@@ -38,7 +38,9 @@
 
 #include <pcl/features/pfh_tools.h>
 #include <pcl/features/impl/pfh.hpp>
+#include <pcl/features/impl/pfh_omp.hpp>
 #include <pcl/features/impl/pfhrgb.hpp>
+#include <pcl/common/simd_lanes.h>
 
 ///////////////////////////////////////////////////////////////////////////////////////////
 bool
@@ -102,6 +104,132 @@ pcl::computePairFeatures (const Eigen::Vector4f &p1, const Eigen::Vector4f &n1,
   return (true);
 }
 
+namespace
+{
+  using namespace pcl::detail::simd;
+
+  struct PairBatch
+  {
+    float p[3], n[3];
+    const float *x, *y, *z, *nx, *ny, *nz;
+    float *f1, *f2, *f3, *f4;
+  };
+
+  /** Compute the pairs i to i + V::size - 1, see computePairFeatures (p1, n1, p2, n2, f1, f2, f3, f4). */
+  template <typename V> PCL_SIMD_INLINE void
+  computePairs (const PairBatch &batch, std::size_t i)
+  {
+    const V zero (0.0f);
+    const V n1x (batch.n[0]), n1y (batch.n[1]), n1z (batch.n[2]);
+    const V n2x = V::load (batch.nx + i), n2y = V::load (batch.ny + i), n2z = V::load (batch.nz + i);
+    const V dx = V::load (batch.x + i) - V (batch.p[0]);
+    const V dy = V::load (batch.y + i) - V (batch.p[1]);
+    const V dz = V::load (batch.z + i) - V (batch.p[2]);
+    const V f4 = sqrt (dx * dx + dy * dy + dz * dz);
+
+    const V angle1 = (n1x * dx + n1y * dy + n1z * dz) / f4;
+    const V angle2 = (n2x * dx + n2y * dy + n2z * dz) / f4;
+    // Make sure the same point is selected as 1 and 2 for each pair: acos (|angle1|) > acos (|angle2|)
+    const auto swap = abs (angle1) < abs (angle2);
+    const V ux = select (swap, n2x, n1x), uy = select (swap, n2y, n1y), uz = select (swap, n2z, n1z);
+    const V mx = select (swap, n1x, n2x), my = select (swap, n1y, n2y), mz = select (swap, n1z, n2z);
+    const V sx = select (swap, zero - dx, dx), sy = select (swap, zero - dy, dy), sz = select (swap, zero - dz, dz);
+    const V f3 = select (swap, zero - angle2, angle1);
+
+    // Darboux frame u-v-w: u = n1; v = (p_idx - q_idx) x u / || (p_idx - q_idx) x u ||; w = u x v
+    V vx = sy * uz - sz * uy, vy = sz * ux - sx * uz, vz = sx * uy - sy * ux;
+    const V v_norm = sqrt (vx * vx + vy * vy + vz * vz);
+    vx = vx / v_norm;
+    vy = vy / v_norm;
+    vz = vz / v_norm;
+    const V wx = uy * vz - uz * vy, wy = uz * vx - ux * vz, wz = ux * vy - uy * vx;
+
+    const V f2 = vx * mx + vy * my + vz * mz;
+    const V f1 = atan2 (wx * mx + wy * my + wz * mz, ux * mx + uy * my + uz * mz);
+
+    // Coincident points, or the difference is parallel to the normal
+    const auto invalid = maskOr (f4 == zero, v_norm == zero);
+    select (invalid, zero, f1).store (batch.f1 + i);
+    select (invalid, zero, f2).store (batch.f2 + i);
+    select (invalid, zero, f3).store (batch.f3 + i);
+    select (invalid, zero, f4).store (batch.f4 + i);
+  }
+
+  /** Compute all pairs of the batch, V::size at a time, then the remaining ones through a padded copy. */
+  template <typename V> PCL_SIMD_INLINE void
+  computeAllPairs (const PairBatch &batch, std::size_t count)
+  {
+    std::size_t i = 0;
+    for (; i + V::size <= count; i += V::size)
+      computePairs<V> (batch, i);
+    if (i == count)
+      return;
+
+    float in[6][V::size] = {}, out[4][V::size];
+    const float* src[6] = {batch.x, batch.y, batch.z, batch.nx, batch.ny, batch.nz};
+    float* tgt[4] = {batch.f1, batch.f2, batch.f3, batch.f4};
+    for (int k = 0; k < 6; ++k)
+      std::copy (src[k] + i, src[k] + count, in[k]);
+    PairBatch padded = batch;
+    padded.x = in[0]; padded.y = in[1]; padded.z = in[2];
+    padded.nx = in[3]; padded.ny = in[4]; padded.nz = in[5];
+    padded.f1 = out[0]; padded.f2 = out[1]; padded.f3 = out[2]; padded.f4 = out[3];
+    computePairs<V> (padded, 0);
+    for (int k = 0; k < 4; ++k)
+      std::copy (out[k], out[k] + (count - i), tgt[k] + i);
+  }
+
+#ifdef PCL_SIMD_KERNELS_SSE2
+  void
+  computePairsSSE2 (const PairBatch &batch, std::size_t count)
+  {
+    computeAllPairs<Lane4> (batch, count);
+  }
+#endif
+
+#ifdef PCL_SIMD_KERNELS_AVX
+  PCL_SIMD_TARGET_AVX void
+  computePairsAVX (const PairBatch &batch, std::size_t count)
+  {
+    computeAllPairs<Lane8> (batch, count);
+  }
+#endif
+
+#ifdef PCL_SIMD_KERNELS_AVX512
+  PCL_SIMD_TARGET_AVX512 void
+  computePairsAVX512 (const PairBatch &batch, std::size_t count)
+  {
+    computeAllPairs<Lane16> (batch, count);
+  }
+#endif
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+void
+pcl::computePairFeatures (const Eigen::Vector4f &p1, const Eigen::Vector4f &n1,
+                          const float *x2, const float *y2, const float *z2,
+                          const float *nx2, const float *ny2, const float *nz2, std::size_t count,
+                          float *f1, float *f2, float *f3, float *f4)
+{
+  const PairBatch batch = {{p1[0], p1[1], p1[2]}, {n1[0], n1[1], n1[2]},
+                           x2, y2, z2, nx2, ny2, nz2, f1, f2, f3, f4};
+  const SIMDLevel level = getSIMDLevel ();
+#ifdef PCL_SIMD_KERNELS_AVX512
+  if (level >= SIMDLevel::AVX512)
+    return (computePairsAVX512 (batch, count));
+#endif
+#ifdef PCL_SIMD_KERNELS_AVX
+  if (level >= SIMDLevel::AVX)
+    return (computePairsAVX (batch, count));
+#endif
+#ifdef PCL_SIMD_KERNELS_SSE2
+  if (level >= SIMDLevel::SSE2)
+    return (computePairsSSE2 (batch, count));
+#endif
+  (void) level;
+  computeAllPairs<Lane<float> > (batch, count);
+}
+
 ///////////////////////////////////////////////////////////////////////////////////////////
 bool
 pcl::computeRGBPairFeatures (const Eigen::Vector4f &p1, const Eigen::Vector4f &n1, const Eigen::Vector4i &colors1,
@@ -169,11 +297,13 @@ pcl::computeRGBPairFeatures (const Eigen::Vector4f &p1, const Eigen::Vector4f &n
 // Instantiations of specific point types
 #ifdef PCL_ONLY_CORE_POINT_TYPES
   PCL_INSTANTIATE_PRODUCT(PFHEstimation, ((pcl::PointXYZ)(pcl::PointXYZI)(pcl::PointXYZRGB)(pcl::PointXYZRGBA))((pcl::Normal))((pcl::PFHSignature125)))
+  PCL_INSTANTIATE_PRODUCT(PFHEstimationOMP, ((pcl::PointXYZ)(pcl::PointXYZI)(pcl::PointXYZRGB)(pcl::PointXYZRGBA))((pcl::Normal))((pcl::PFHSignature125)))
   PCL_INSTANTIATE_PRODUCT(PFHRGBEstimation, ((pcl::PointXYZRGBA)(pcl::PointXYZRGB)(pcl::PointXYZRGBNormal))
                           ((pcl::Normal)(pcl::PointXYZRGBNormal))
                           ((pcl::PFHRGBSignature250)))
 #else
   PCL_INSTANTIATE_PRODUCT(PFHEstimation, (PCL_XYZ_POINT_TYPES)(PCL_NORMAL_POINT_TYPES)((pcl::PFHSignature125)))
+  PCL_INSTANTIATE_PRODUCT(PFHEstimationOMP, (PCL_XYZ_POINT_TYPES)(PCL_NORMAL_POINT_TYPES)((pcl::PFHSignature125)))
   PCL_INSTANTIATE_PRODUCT(PFHRGBEstimation, ((pcl::PointXYZRGB)(pcl::PointXYZRGBA)(pcl::PointXYZRGBNormal))
                           (PCL_NORMAL_POINT_TYPES)
                           ((pcl::PFHRGBSignature250)))
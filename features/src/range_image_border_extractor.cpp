@@ -38,11 +38,13 @@
 #include <iostream>
 using std::cout;
 using std::cerr;
+#include <algorithm>
 #include <cmath>
 #include <pcl/pcl_macros.h>
 #include <pcl/range_image/range_image.h>
 #include <pcl/point_cloud.h>
 #include <pcl/features/range_image_border_extractor.h>
+#include <pcl/common/execution_context.h>
 #include <Eigen/Core> // for Vector3f
 
 namespace pcl
@@ -75,22 +77,16 @@ void
 RangeImageBorderExtractor::clearData ()
 {
   //std::cout << PVARC(range_image_size_during_extraction_)<<PVARN((void*)this);
-  for (int i=0; i<range_image_size_during_extraction_; ++i)
-  {
-    if (surface_structure_!=nullptr)
-      delete surface_structure_[i];
-    if (shadow_border_informations_!=nullptr)
-      delete shadow_border_informations_[i];
-    if (border_directions_!=nullptr)
-      delete border_directions_[i];
-  }
-  delete[] surface_structure_; surface_structure_ = nullptr;
-  delete[] shadow_border_informations_; shadow_border_informations_ = nullptr;
-  delete[] border_directions_; border_directions_ = nullptr;
-  delete border_descriptions_; border_descriptions_ = nullptr;
-
-  delete[] surface_change_scores_;  surface_change_scores_ = nullptr;
-  delete[] surface_change_directions_;  surface_change_directions_ = nullptr;
+  // The buffers keep their memory, only the views on them are reset
+  surface_structure_ = nullptr;
+  shadow_border_informations_ = nullptr;
+  border_directions_ = nullptr;
+  border_descriptions_ = nullptr;
+  surface_change_scores_ = nullptr;
+  surface_change_directions_ = nullptr;
+
+  border_scores_left_.clear ();  border_scores_right_.clear ();
+  border_scores_top_.clear ();   border_scores_bottom_.clear ();
 }
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -99,6 +95,9 @@ RangeImageBorderExtractor::extractLocalSurfaceStructure ()
 {
   if (surface_structure_ != nullptr)
     return;
+
+  const pcl::ThreadReservation reservation (static_cast<unsigned int> (std::max (parameters_.max_no_of_threads, 0)));
+  const unsigned int threads = reservation.getNumberOfThreads ();
   //std::cerr << __PRETTY_FUNCTION__<<" called (this="<<(void*)this<<").\n";
   //MEASURE_FUNCTION_TIME;
 
@@ -106,7 +105,9 @@ RangeImageBorderExtractor::extractLocalSurfaceStructure ()
   const auto height = range_image_->height;
   range_image_size_during_extraction_ = width*height;
   const auto array_size = range_image_size_during_extraction_;
-  surface_structure_ = new LocalSurface*[array_size];
+  local_surfaces_buffer_.resize (array_size);
+  surface_structure_buffer_.resize (array_size);
+  surface_structure_ = surface_structure_buffer_.data ();
   const auto step_size = std::max(1, parameters_.pixel_radius_plane_extraction/2);
   //std::cout << PVARN(step_size);
   const auto sqrt_neighbors = parameters_.pixel_radius_plane_extraction/step_size + 1;
@@ -120,13 +121,13 @@ RangeImageBorderExtractor::extractLocalSurfaceStructure ()
 #pragma omp parallel for \
   default(none) \
   schedule(dynamic, 10) \
-  num_threads(parameters_.max_no_of_threads)
+  num_threads(threads)
 #else
 #pragma omp parallel for \
   default(none) \
   shared(height, no_of_nearest_neighbors, step_size, width) \
   schedule(dynamic, 10) \
-  num_threads(parameters_.max_no_of_threads)
+  num_threads(threads)
 #endif
   for (iteration_type y=0; y<height; ++y)
   {
@@ -137,7 +138,7 @@ RangeImageBorderExtractor::extractLocalSurfaceStructure ()
       local_surface = nullptr;
       if (!range_image_->isValid(index))
         continue;
-      local_surface = new LocalSurface;
+      local_surface = &local_surfaces_buffer_[index];
       Eigen::Vector3f point;
       range_image_->getPoint(x, y, point);
       //std::cout << PVARN(point);
@@ -147,7 +148,6 @@ RangeImageBorderExtractor::extractLocalSurfaceStructure ()
                                   local_surface->eigen_values_no_jumps,  &local_surface->normal,
                                   &local_surface->neighborhood_mean, &local_surface->eigen_values))
       {
-        delete local_surface;
         local_surface = nullptr;
       }
 
@@ -163,6 +163,8 @@ RangeImageBorderExtractor::extractBorderScoreImages ()
   if (!border_scores_left_.empty())
     return;
 
+  const pcl::ThreadReservation reservation (static_cast<unsigned int> (std::max (parameters_.max_no_of_threads, 0)));
+  const unsigned int threads = reservation.getNumberOfThreads ();
   extractLocalSurfaceStructure();
 
   //MEASURE_FUNCTION_TIME;
@@ -179,7 +181,7 @@ RangeImageBorderExtractor::extractBorderScoreImages ()
   default(none) \
   shared(height, width) \
   schedule(dynamic, 10) \
-  num_threads(parameters_.max_no_of_threads)
+  num_threads(threads)
   for (int y=0; y<height; ++y) {
     for (int x=0; x<width; ++x) {
       int index = y*width + x;
@@ -212,15 +214,24 @@ RangeImageBorderExtractor::updatedScoresAccordingToNeighborValues (const float*
   return (new_scores);
 }
 
-std::vector<float>
-RangeImageBorderExtractor::updatedScoresAccordingToNeighborValues (const std::vector<float>& border_scores) const
+void
+RangeImageBorderExtractor::updatedScoresAccordingToNeighborValues (const std::vector<float>& border_scores,
+                                                                  std::vector<float>& new_border_scores) const
 {
-  std::vector<float> new_border_scores;
-  new_border_scores.reserve (range_image_->width*range_image_->height);
-  for (int y=0; y < static_cast<int> (range_image_->height); ++y)
-    for (int x=0; x < static_cast<int> (range_image_->width); ++x)
-      new_border_scores.push_back (updatedScoreAccordingToNeighborValues(x, y, border_scores.data ()));
-  return new_border_scores;
+  const pcl::ThreadReservation reservation (static_cast<unsigned int> (std::max (parameters_.max_no_of_threads, 0)));
+  const unsigned int threads = reservation.getNumberOfThreads ();
+  int width  = range_image_->width,
+      height = range_image_->height;
+  const float* scores = border_scores.data ();
+  new_border_scores.resize (width*height);
+#pragma omp parallel for \
+  default(none) \
+  shared(height, new_border_scores, scores, width) \
+  schedule(dynamic, 10) \
+  num_threads(threads)
+  for (int y=0; y < height; ++y)
+    for (int x=0; x < width; ++x)
+      new_border_scores[y*width + x] = updatedScoreAccordingToNeighborValues(x, y, scores);
 }
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -231,10 +242,13 @@ RangeImageBorderExtractor::updateScoresAccordingToNeighborValues ()
 
   //MEASURE_FUNCTION_TIME;
 
-  border_scores_left_ = updatedScoresAccordingToNeighborValues(border_scores_left_);
-  border_scores_right_ = updatedScoresAccordingToNeighborValues(border_scores_right_);
-  border_scores_top_ = updatedScoresAccordingToNeighborValues(border_scores_top_);
-  border_scores_bottom_ = updatedScoresAccordingToNeighborValues(border_scores_bottom_);
+  // The updated image goes to the scratch buffer, which is then swapped in, so no image is allocated once
+  // the image size is stable
+  for (std::vector<float>* border_scores : {&border_scores_left_, &border_scores_right_, &border_scores_top_, &border_scores_bottom_})
+  {
+    updatedScoresAccordingToNeighborValues(*border_scores, border_scores_buffer_);
+    border_scores->swap (border_scores_buffer_);
+  }
 }
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -244,6 +258,8 @@ RangeImageBorderExtractor::findAndEvaluateShadowBorders ()
   if (shadow_border_informations_ != nullptr)
     return;
 
+  const pcl::ThreadReservation reservation (static_cast<unsigned int> (std::max (parameters_.max_no_of_threads, 0)));
+  const unsigned int threads = reservation.getNumberOfThreads ();
   if (border_scores_left_.empty ())
   {
     std::cerr << __PRETTY_FUNCTION__<<": border score images not available!\n";
@@ -253,34 +269,63 @@ RangeImageBorderExtractor::findAndEvaluateShadowBorders ()
 
   int width  = range_image_->width,
       height = range_image_->height;
-  shadow_border_informations_ = new ShadowBorderIndices*[width*height];
-  for (int y = 0; y < static_cast<int> (height); ++y)
+  shadow_border_indices_buffer_.resize (width*height);
+  shadow_border_informations_buffer_.resize (width*height);
+  shadow_border_informations_ = shadow_border_informations_buffer_.data ();
+
+  // A pixel only rescales its own score in the searched direction and only looks at the scores of the
+  // opposite direction along the same row (left/right) or column (top/bottom). Running the horizontal
+  // pass row-wise and the vertical pass column-wise therefore keeps the order every pixel sees its
+  // neighbors in, and gives the same result as a single serial pass.
+#pragma omp parallel for \
+  default(none) \
+  shared(height, width) \
+  schedule(dynamic, 10) \
+  num_threads(threads)
+  for (int y = 0; y < height; ++y)
   {
-    for (int x = 0; x < static_cast<int> (width); ++x)
+    for (int x = 0; x < width; ++x)
     {
       int index = y*width+x;
       ShadowBorderIndices*& shadow_border_indices = shadow_border_informations_[index];
       shadow_border_indices = nullptr;
+      shadow_border_indices_buffer_[index] = ShadowBorderIndices ();
       int shadow_border_idx;
 
       if (changeScoreAccordingToShadowBorderValue(x, y, -1, 0, border_scores_left_.data (), border_scores_right_.data (), shadow_border_idx))
       {
-        shadow_border_indices = (shadow_border_indices==nullptr ? new ShadowBorderIndices : shadow_border_indices);
+        shadow_border_indices = (shadow_border_indices==nullptr ? &shadow_border_indices_buffer_[index] : shadow_border_indices);
         shadow_border_indices->left = shadow_border_idx;
       }
       if (changeScoreAccordingToShadowBorderValue(x, y, 1, 0, border_scores_right_.data (), border_scores_left_.data (), shadow_border_idx))
       {
-        shadow_border_indices = (shadow_border_indices==nullptr ? new ShadowBorderIndices : shadow_border_indices);
+        shadow_border_indices = (shadow_border_indices==nullptr ? &shadow_border_indices_buffer_[index] : shadow_border_indices);
         shadow_border_indices->right = shadow_border_idx;
       }
+    }
+  }
+
+#pragma omp parallel for \
+  default(none) \
+  shared(height, width) \
+  schedule(dynamic, 10) \
+  num_threads(threads)
+  for (int x = 0; x < width; ++x)
+  {
+    for (int y = 0; y < height; ++y)
+    {
+      int index = y*width+x;
+      ShadowBorderIndices*& shadow_border_indices = shadow_border_informations_[index];
+      int shadow_border_idx;
+
       if (changeScoreAccordingToShadowBorderValue(x, y, 0, -1, border_scores_top_.data (), border_scores_bottom_.data (), shadow_border_idx))
       {
-        shadow_border_indices = (shadow_border_indices==nullptr ? new ShadowBorderIndices : shadow_border_indices);
+        shadow_border_indices = (shadow_border_indices==nullptr ? &shadow_border_indices_buffer_[index] : shadow_border_indices);
         shadow_border_indices->top = shadow_border_idx;
       }
       if (changeScoreAccordingToShadowBorderValue(x, y, 0, 1, border_scores_bottom_.data (), border_scores_top_.data (), shadow_border_idx))
       {
-        shadow_border_indices = (shadow_border_indices==nullptr ? new ShadowBorderIndices : shadow_border_indices);
+        shadow_border_indices = (shadow_border_indices==nullptr ? &shadow_border_indices_buffer_[index] : shadow_border_indices);
         shadow_border_indices->bottom = shadow_border_idx;
       }
     }
@@ -291,6 +336,8 @@ RangeImageBorderExtractor::findAndEvaluateShadowBorders ()
 float*
 RangeImageBorderExtractor::getAnglesImageForBorderDirections ()
 {
+  const pcl::ThreadReservation reservation (static_cast<unsigned int> (std::max (parameters_.max_no_of_threads, 0)));
+  const unsigned int threads = reservation.getNumberOfThreads ();
   calculateBorderDirections();
 
   int width  = range_image_->width,
@@ -298,6 +345,11 @@ RangeImageBorderExtractor::getAnglesImageForBorderDirections ()
       array_size = width*height;
   float* angles_image = new float[array_size];
 
+#pragma omp parallel for \
+  default(none) \
+  shared(angles_image, height, width) \
+  schedule(dynamic, 10) \
+  num_threads(threads)
   for (int y=0; y<height; ++y)
   {
     for (int x=0; x<width; ++x)
@@ -326,6 +378,8 @@ RangeImageBorderExtractor::getAnglesImageForBorderDirections ()
 float*
 RangeImageBorderExtractor::getAnglesImageForSurfaceChangeDirections ()
 {
+  const pcl::ThreadReservation reservation (static_cast<unsigned int> (std::max (parameters_.max_no_of_threads, 0)));
+  const unsigned int threads = reservation.getNumberOfThreads ();
   //MEASURE_FUNCTION_TIME;
 
   calculateSurfaceChanges();
@@ -335,6 +389,11 @@ RangeImageBorderExtractor::getAnglesImageForSurfaceChangeDirections ()
       array_size = width*height;
   float* angles_image = new float[array_size];
 
+#pragma omp parallel for \
+  default(none) \
+  shared(angles_image, height, width) \
+  schedule(dynamic, 10) \
+  num_threads(threads)
   for (int y=0; y<height; ++y)
   {
     for (int x=0; x<width; ++x)
@@ -371,6 +430,8 @@ RangeImageBorderExtractor::classifyBorders ()
   if (border_descriptions_ != nullptr)
     return;
 
+  const pcl::ThreadReservation reservation (static_cast<unsigned int> (std::max (parameters_.max_no_of_threads, 0)));
+  const unsigned int threads = reservation.getNumberOfThreads ();
   // Get local plane approximations
   extractLocalSurfaceStructure();
 
@@ -389,15 +450,47 @@ RangeImageBorderExtractor::classifyBorders ()
 
   BorderDescription initial_border_description;
   initial_border_description.traits = 0;
-  border_descriptions_ = new PointCloudOut;
+  border_descriptions_ = &border_descriptions_buffer_;
   border_descriptions_->width = width;
   border_descriptions_->height = height;
   border_descriptions_->is_dense = true;
-  border_descriptions_->points.resize(size, initial_border_description);
+  border_descriptions_->points.assign(size, initial_border_description);
 
-  for (int y = 0; y < static_cast<int> (height); ++y)
+  // The maximum checks only read the score images and are done in parallel. Marking the traits writes to
+  // the shadow border and veil pixels of other rows and columns, which is left to the serial pass below.
+  enum { MAXIMUM_LEFT=1, MAXIMUM_RIGHT=2, MAXIMUM_TOP=4, MAXIMUM_BOTTOM=8 };
+  border_maxima_buffer_.resize (size);
+  unsigned char* border_maxima = border_maxima_buffer_.data ();
+#pragma omp parallel for \
+  default(none) \
+  shared(border_maxima, height, width) \
+  schedule(dynamic, 10) \
+  num_threads(threads)
+  for (int y = 0; y < height; ++y)
   {
-    for (int x = 0; x < static_cast<int> (width); ++x)
+    for (int x = 0; x < width; ++x)
+    {
+      int index = y*width+x;
+      unsigned char& maxima = border_maxima[index];
+      maxima = 0;
+      const ShadowBorderIndices* shadow_border_indices = shadow_border_informations_[index];
+      if (shadow_border_indices == nullptr)
+        continue;
+
+      if (shadow_border_indices->left >= 0 && checkIfMaximum(x, y, -1, 0, border_scores_left_.data (), shadow_border_indices->left))
+        maxima |= MAXIMUM_LEFT;
+      if (shadow_border_indices->right >= 0 && checkIfMaximum(x, y, 1, 0, border_scores_right_.data (), shadow_border_indices->right))
+        maxima |= MAXIMUM_RIGHT;
+      if (shadow_border_indices->top >= 0 && checkIfMaximum(x, y, 0, -1, border_scores_top_.data (), shadow_border_indices->top))
+        maxima |= MAXIMUM_TOP;
+      if (shadow_border_indices->bottom >= 0 && checkIfMaximum(x, y, 0, 1, border_scores_bottom_.data (), shadow_border_indices->bottom))
+        maxima |= MAXIMUM_BOTTOM;
+    }
+  }
+
+  for (int y = 0; y < height; ++y)
+  {
+    for (int x = 0; x < width; ++x)
     {
       int index = y*width+x;
       BorderDescription& border_description = (*border_descriptions_)[index];
@@ -405,13 +498,14 @@ RangeImageBorderExtractor::classifyBorders ()
       border_description.y = y;
       BorderTraits& border_traits = border_description.traits;
 
-      ShadowBorderIndices* shadow_border_indices = shadow_border_informations_[index];
-      if (shadow_border_indices == nullptr)
+      unsigned char maxima = border_maxima[index];
+      if (maxima == 0)
         continue;
+      const ShadowBorderIndices* shadow_border_indices = shadow_border_informations_[index];
 
-      int shadow_border_index = shadow_border_indices->left;
-      if (shadow_border_index >= 0 && checkIfMaximum(x, y, -1, 0, border_scores_left_.data (), shadow_border_index))
+      if (maxima & MAXIMUM_LEFT)
       {
+        int shadow_border_index = shadow_border_indices->left;
         BorderTraits& shadow_traits = (*border_descriptions_)[shadow_border_index].traits;
         border_traits[BORDER_TRAIT__OBSTACLE_BORDER] = border_traits[BORDER_TRAIT__OBSTACLE_BORDER_LEFT] = true;
         shadow_traits[BORDER_TRAIT__SHADOW_BORDER] = shadow_traits[BORDER_TRAIT__SHADOW_BORDER_RIGHT] = true;
@@ -422,9 +516,9 @@ RangeImageBorderExtractor::classifyBorders ()
         }
       }
 
-      shadow_border_index = shadow_border_indices->right;
-      if (shadow_border_index >= 0 && checkIfMaximum(x, y, 1, 0, border_scores_right_.data (), shadow_border_index))
+      if (maxima & MAXIMUM_RIGHT)
       {
+        int shadow_border_index = shadow_border_indices->right;
         BorderTraits& shadow_traits = (*border_descriptions_)[shadow_border_index].traits;
         border_traits[BORDER_TRAIT__OBSTACLE_BORDER] = border_traits[BORDER_TRAIT__OBSTACLE_BORDER_RIGHT] = true;
         shadow_traits[BORDER_TRAIT__SHADOW_BORDER] = shadow_traits[BORDER_TRAIT__SHADOW_BORDER_LEFT] = true;
@@ -435,38 +529,31 @@ RangeImageBorderExtractor::classifyBorders ()
         }
       }
 
-      shadow_border_index = shadow_border_indices->top;
-      if (shadow_border_index >= 0 && checkIfMaximum(x, y, 0, -1, border_scores_top_.data (), shadow_border_index))
+      if (maxima & MAXIMUM_TOP)
       {
+        int shadow_border_index = shadow_border_indices->top;
         BorderTraits& shadow_traits = (*border_descriptions_)[shadow_border_index].traits;
         border_traits[BORDER_TRAIT__OBSTACLE_BORDER] = border_traits[BORDER_TRAIT__OBSTACLE_BORDER_TOP] = true;
         shadow_traits[BORDER_TRAIT__SHADOW_BORDER] = shadow_traits[BORDER_TRAIT__SHADOW_BORDER_BOTTOM] = true;
         for (int index3=index-width; index3>shadow_border_index; index3-=width)
         {
-          //std::cout << "Adding veil point at "<<(index3-index)%width<<","<<(index3-index)/width<<".\n";
           BorderTraits& veil_point = (*border_descriptions_)[index3].traits;
           veil_point[BORDER_TRAIT__VEIL_POINT] = veil_point[BORDER_TRAIT__VEIL_POINT_BOTTOM] = true;
         }
       }
 
-      shadow_border_index = shadow_border_indices->bottom;
-      if (shadow_border_index >= 0 && checkIfMaximum(x, y, 0, 1, border_scores_bottom_.data (), shadow_border_index))
+      if (maxima & MAXIMUM_BOTTOM)
       {
+        int shadow_border_index = shadow_border_indices->bottom;
         BorderTraits& shadow_traits = (*border_descriptions_)[shadow_border_index].traits;
         border_traits[BORDER_TRAIT__OBSTACLE_BORDER] = border_traits[BORDER_TRAIT__OBSTACLE_BORDER_BOTTOM] = true;
         shadow_traits[BORDER_TRAIT__SHADOW_BORDER] = shadow_traits[BORDER_TRAIT__SHADOW_BORDER_TOP] = true;
         for (int index3=index+width; index3<shadow_border_index; index3+=width)
         {
-          //std::cout << "Adding veil point at "<<(index3-index)%width<<","<<(index3-index)/width<<".\n";
           BorderTraits& veil_point = (*border_descriptions_)[index3].traits;
           veil_point[BORDER_TRAIT__VEIL_POINT] = veil_point[BORDER_TRAIT__VEIL_POINT_TOP] = true;
         }
       }
-
-      //if (border_traits[BORDER_TRAIT__OBSTACLE_BORDER])
-      //{
-        //border_points.push_back(&border_description);
-      //}
     }
   }
 }
@@ -477,6 +564,9 @@ RangeImageBorderExtractor::calculateBorderDirections ()
 {
   if (border_directions_!=nullptr)
     return;
+
+  const pcl::ThreadReservation reservation (static_cast<unsigned int> (std::max (parameters_.max_no_of_threads, 0)));
+  const unsigned int threads = reservation.getNumberOfThreads ();
   classifyBorders();
 
   //MEASURE_FUNCTION_TIME;
@@ -484,7 +574,14 @@ RangeImageBorderExtractor::calculateBorderDirections ()
   int width  = range_image_->width,
       height = range_image_->height,
       size   = width*height;
-  border_directions_ = new Eigen::Vector3f*[size];
+  border_directions_values_buffer_.resize (size);
+  border_directions_buffer_.resize (size);
+  border_directions_ = border_directions_buffer_.data ();
+#pragma omp parallel for \
+  default(none) \
+  shared(height, width) \
+  schedule(dynamic, 10) \
+  num_threads(threads)
   for (int y=0; y<height; ++y)
   {
     for (int x=0; x<width; ++x)
@@ -493,10 +590,17 @@ RangeImageBorderExtractor::calculateBorderDirections ()
     }
   }
 
-  Eigen::Vector3f** average_border_directions = new Eigen::Vector3f*[size];
+  average_border_directions_values_buffer_.resize (size);
+  average_border_directions_buffer_.resize (size);
+  Eigen::Vector3f** average_border_directions = average_border_directions_buffer_.data ();
   int radius = parameters_.pixel_radius_border_direction;
   int minimum_weight = radius+1;
   float min_cos_angle=std::cos(deg2rad(120.0f));
+#pragma omp parallel for \
+  default(none) \
+  shared(average_border_directions, height, min_cos_angle, minimum_weight, radius, width) \
+  schedule(dynamic, 10) \
+  num_threads(threads)
   for (int y=0; y<height; ++y)
   {
     for (int x=0; x<width; ++x)
@@ -507,7 +611,8 @@ RangeImageBorderExtractor::calculateBorderDirections ()
       const Eigen::Vector3f* border_direction = border_directions_[index];
       if (border_direction==nullptr)
         continue;
-      average_border_direction = new Eigen::Vector3f(*border_direction);
+      average_border_direction = &average_border_directions_values_buffer_[index];
+      *average_border_direction = *border_direction;
       float weight_sum = 1.0f;
       for (int y2=(std::max)(0, y-radius); y2<=(std::min)(y+radius, height-1); ++y2)
       {
@@ -539,7 +644,6 @@ RangeImageBorderExtractor::calculateBorderDirections ()
       }
       if (pcl_lrint (weight_sum) < minimum_weight)
       {
-        delete average_border_direction;
         average_border_direction=nullptr;
       }
       else
@@ -547,9 +651,6 @@ RangeImageBorderExtractor::calculateBorderDirections ()
     }
   }
 
-  for (int i=0; i<size; ++i)
-    delete border_directions_[i];
-  delete[] border_directions_;
   border_directions_ = average_border_directions;
 }
 
@@ -560,6 +661,8 @@ RangeImageBorderExtractor::calculateSurfaceChanges ()
   if (surface_change_scores_!=nullptr)
     return;
 
+  const pcl::ThreadReservation reservation (static_cast<unsigned int> (std::max (parameters_.max_no_of_threads, 0)));
+  const unsigned int threads = reservation.getNumberOfThreads ();
   calculateBorderDirections();
 
   //MEASURE_FUNCTION_TIME;
@@ -567,13 +670,15 @@ RangeImageBorderExtractor::calculateSurfaceChanges ()
   int width  = range_image_->width,
       height = range_image_->height,
       size   = width*height;
-  surface_change_scores_ = new float[size];
-  surface_change_directions_ = new Eigen::Vector3f[size];
+  surface_change_scores_buffer_.resize (size);
+  surface_change_directions_buffer_.resize (size);
+  surface_change_scores_ = surface_change_scores_buffer_.data ();
+  surface_change_directions_ = surface_change_directions_buffer_.data ();
 #pragma omp parallel for \
   default(none) \
   shared(height, width) \
   schedule(dynamic, 10) \
-  num_threads(parameters_.max_no_of_threads)
+  num_threads(threads)
   for (int y=0; y<height; ++y)
   {
     for (int x=0; x<width; ++x)
@@ -37,6 +37,7 @@
  */
 
 #include <pcl/features/impl/rsd.hpp>
+#include <pcl/features/impl/rsd_omp.hpp>
 
 #ifndef PCL_NO_PRECOMPILE
 #include <pcl/point_types.h>
@@ -44,8 +45,10 @@
 // Instantiations of specific point types
 #ifdef PCL_ONLY_CORE_POINT_TYPES
   PCL_INSTANTIATE_PRODUCT(RSDEstimation, ((pcl::PointXYZ)(pcl::PointXYZI)(pcl::PointXYZRGBA))((pcl::Normal))((pcl::PrincipalRadiiRSD)))
+  PCL_INSTANTIATE_PRODUCT(RSDEstimationOMP, ((pcl::PointXYZ)(pcl::PointXYZI)(pcl::PointXYZRGBA))((pcl::Normal))((pcl::PrincipalRadiiRSD)))
 #else
   PCL_INSTANTIATE_PRODUCT(RSDEstimation, (PCL_XYZ_POINT_TYPES)(PCL_NORMAL_POINT_TYPES)((pcl::PrincipalRadiiRSD)))
+  PCL_INSTANTIATE_PRODUCT(RSDEstimationOMP, (PCL_XYZ_POINT_TYPES)(PCL_NORMAL_POINT_TYPES)((pcl::PrincipalRadiiRSD)))
 #endif
 #endif    // PCL_NO_PRECOMPILE
 
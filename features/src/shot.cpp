@@ -38,6 +38,121 @@
 
 #include <pcl/features/impl/shot.hpp>
 #include <pcl/features/impl/shot_omp.hpp>
+#include <pcl/common/simd_lanes.h>
+
+namespace
+{
+  using namespace pcl::detail::simd;
+
+  struct NeighborBatch
+  {
+    float frame[9];
+    const float *dx, *dy, *dz, *sqr_dists;
+    float *x, *y, *z, *distance, *inclination, *azimuth;
+  };
+
+  /** Project the neighbors i to i + V::size - 1, see pcl::computeSHOTLocalCoordinates. */
+  template <typename V> PCL_SIMD_INLINE void
+  computeCoordinates (const NeighborBatch &batch, std::size_t i)
+  {
+    const V zero (0.0f), one (1.0f), tiny (1e-30f);
+    const V dx = V::load (batch.dx + i), dy = V::load (batch.dy + i), dz = V::load (batch.dz + i);
+    const float* f = batch.frame;
+    V x = dx * V (f[0]) + dy * V (f[1]) + dz * V (f[2]);
+    V y = dx * V (f[3]) + dy * V (f[4]) + dz * V (f[5]);
+    V z = dx * V (f[6]) + dy * V (f[7]) + dz * V (f[8]);
+    // To avoid numerical problems afterwards
+    x = select (abs (x) < tiny, zero, x);
+    y = select (abs (y) < tiny, zero, y);
+    z = select (abs (z) < tiny, zero, z);
+    const V distance = sqrt (V::load (batch.sqr_dists + i));
+
+    // acos (c) = atan2 (sqrt (1 - c^2), c)
+    const V cos_inclination = max (V (-1.0f), min (z / distance, one));
+    const V sin_inclination = sqrt (max (zero, one - cos_inclination * cos_inclination));
+
+    x.store (batch.x + i);
+    y.store (batch.y + i);
+    z.store (batch.z + i);
+    distance.store (batch.distance + i);
+    atan2 (sin_inclination, cos_inclination).store (batch.inclination + i);
+    atan2 (y, x).store (batch.azimuth + i);
+  }
+
+  /** Project all the neighbors of the batch, V::size at a time, then the remaining ones through a padded copy. */
+  template <typename V> PCL_SIMD_INLINE void
+  computeAllCoordinates (const NeighborBatch &batch, std::size_t count)
+  {
+    std::size_t i = 0;
+    for (; i + V::size <= count; i += V::size)
+      computeCoordinates<V> (batch, i);
+    if (i == count)
+      return;
+
+    float in[4][V::size] = {}, out[6][V::size];
+    const float* src[4] = {batch.dx, batch.dy, batch.dz, batch.sqr_dists};
+    float* tgt[6] = {batch.x, batch.y, batch.z, batch.distance, batch.inclination, batch.azimuth};
+    for (int k = 0; k < 4; ++k)
+      std::copy (src[k] + i, src[k] + count, in[k]);
+    NeighborBatch padded = batch;
+    padded.dx = in[0]; padded.dy = in[1]; padded.dz = in[2]; padded.sqr_dists = in[3];
+    padded.x = out[0]; padded.y = out[1]; padded.z = out[2];
+    padded.distance = out[3]; padded.inclination = out[4]; padded.azimuth = out[5];
+    computeCoordinates<V> (padded, 0);
+    for (int k = 0; k < 6; ++k)
+      std::copy (out[k], out[k] + (count - i), tgt[k] + i);
+  }
+
+#ifdef PCL_SIMD_KERNELS_SSE2
+  void
+  computeCoordinatesSSE2 (const NeighborBatch &batch, std::size_t count)
+  {
+    computeAllCoordinates<Lane4> (batch, count);
+  }
+#endif
+
+#ifdef PCL_SIMD_KERNELS_AVX
+  PCL_SIMD_TARGET_AVX void
+  computeCoordinatesAVX (const NeighborBatch &batch, std::size_t count)
+  {
+    computeAllCoordinates<Lane8> (batch, count);
+  }
+#endif
+
+#ifdef PCL_SIMD_KERNELS_AVX512
+  PCL_SIMD_TARGET_AVX512 void
+  computeCoordinatesAVX512 (const NeighborBatch &batch, std::size_t count)
+  {
+    computeAllCoordinates<Lane16> (batch, count);
+  }
+#endif
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+void
+pcl::computeSHOTLocalCoordinates (const float *frame,
+                                  const float *dx, const float *dy, const float *dz, const float *sqr_dists,
+                                  std::size_t count, float *x, float *y, float *z,
+                                  float *distance, float *inclination, float *azimuth)
+{
+  NeighborBatch batch = {{}, dx, dy, dz, sqr_dists, x, y, z, distance, inclination, azimuth};
+  std::copy (frame, frame + 9, batch.frame);
+  const SIMDLevel level = getSIMDLevel ();
+#ifdef PCL_SIMD_KERNELS_AVX512
+  if (level >= SIMDLevel::AVX512)
+    return (computeCoordinatesAVX512 (batch, count));
+#endif
+#ifdef PCL_SIMD_KERNELS_AVX
+  if (level >= SIMDLevel::AVX)
+    return (computeCoordinatesAVX (batch, count));
+#endif
+#ifdef PCL_SIMD_KERNELS_SSE2
+  if (level >= SIMDLevel::SSE2)
+    return (computeCoordinatesSSE2 (batch, count));
+#endif
+  (void) level;
+  computeAllCoordinates<Lane<float> > (batch, count);
+}
 
 #ifndef PCL_NO_PRECOMPILE
 #include <pcl/point_types.h>
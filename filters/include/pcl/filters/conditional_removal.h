@@ -55,11 +55,16 @@ namespace pcl
     };
   }
 
+  template<typename PointT>
+  class ConditionalRemoval;
+
   //////////////////////////////////////////////////////////////////////////////////////////
   /** \brief A datatype that enables type-correct comparisons. */
   template<typename PointT>
   class PointDataAtOffset
   {
+    friend class ConditionalRemoval<PointT>;
+
     public:
       /** \brief Constructor. */
       PointDataAtOffset (std::uint8_t datatype, std::uint32_t offset) :
@@ -128,6 +133,8 @@ namespace pcl
   template<typename PointT>
   class FieldComparison : public ComparisonBase<PointT>
   {
+    friend class ConditionalRemoval<PointT>;
+
     using ComparisonBase<PointT>::field_name_;
     using ComparisonBase<PointT>::op_;
     using ComparisonBase<PointT>::capable_;
@@ -445,6 +452,8 @@ namespace pcl
   template<typename PointT>
   class ConditionBase
   {
+    friend class ConditionalRemoval<PointT>;
+
     public:
       using ComparisonBase = pcl::ComparisonBase<PointT>;
       using ComparisonBasePtr = typename ComparisonBase::Ptr;
@@ -613,7 +622,7 @@ namespace pcl
         */
       ConditionalRemoval (int extract_removed_indices = false) :
         Filter<PointT>::Filter (extract_removed_indices), capable_ (false), keep_organized_ (false), condition_ (),
-        user_filter_value_ (std::numeric_limits<float>::quiet_NaN ())
+        user_filter_value_ (std::numeric_limits<float>::quiet_NaN ()), threads_ (1)
       {
         filter_name_ = "ConditionalRemoval";
       }
@@ -658,13 +667,67 @@ namespace pcl
       void
       setCondition (ConditionBasePtr condition);
 
+      /** \brief Set the number of threads to use for evaluating the condition.
+        * \param[in] nr_threads the number of hardware threads to use (0 takes as many as the
+        * budget of pcl::ExecutionContext allows when filtering)
+        */
+      void
+      setNumberOfThreads (unsigned int nr_threads = 0);
+
+      /** \brief Get the number of threads used for evaluating the condition, 0 for automatic. */
+      inline unsigned int
+      getNumberOfThreads () const
+      {
+        return (threads_);
+      }
+
     protected:
+      /** \brief An instruction of the condition compiled by compileCondition. The program is
+        * in postfix order and works on a stack of results for a block of points.
+        */
+      struct ConditionInstruction
+      {
+        enum Code
+        {
+          FIELD,      // push the result of a field comparison, done on a column of values
+          COMPARISON, // push the result of any other comparison
+          CONDITION,  // push the result of a condition that is not a ConditionAnd or ConditionOr
+          AND,        // replace the top nr_operands results by their conjunction
+          OR          // replace the top nr_operands results by their disjunction
+        };
+
+        Code code;
+        std::uint8_t datatype;
+        std::uint32_t offset;
+        ComparisonOps::CompareOp op;
+        double value;
+        const ComparisonBase<PointT>* comparison;
+        const ConditionBase* condition;
+        std::size_t nr_operands;
+      };
+
       /** \brief Filter a Point Cloud.
         * \param output the resultant point cloud message
         */
       void
       applyFilter (PointCloud &output) override;
 
+      /** \brief Flatten a condition tree into postfix instructions. Field comparisons become
+        * column predicates without virtual calls, the And and Or nodes become mask operations.
+        * \param[in] condition the condition to compile
+        * \param[out] program the instructions are appended to this
+        * \return the stack depth needed by the instructions
+        */
+      std::size_t
+      compileCondition (const ConditionBase &condition, std::vector<ConditionInstruction> &program) const;
+
+      /** \brief Evaluate the condition for the given points, in blocks and in parallel.
+        * \param[in] indices the indices of the points to evaluate
+        * \param[out] passed 1 for the points that satisfy the condition, 0 otherwise
+        */
+      void
+      evaluateCondition (const Indices &indices, std::vector<unsigned char> &passed) const;
+
       /** \brief True if capable. */
       bool capable_;
 
@@ -680,6 +743,9 @@ namespace pcl
         * the correct field type. 
         */
       float user_filter_value_;
+
+      /** \brief The number of threads the scheduler should use. */
+      unsigned int threads_;
   };
 }
 
@@ -215,7 +215,7 @@ namespace pcl
         ~Convolution3D () {}
 
         /** \brief Initialize the scheduler and set the number of threads to use.
-          * \param nr_threads the number of hardware threads to use (0 sets the value back to automatic)
+          * \param nr_threads the number of hardware threads to use (0 takes as many as the budget of pcl::ExecutionContext allows when convolving)
           */
         inline void
         setNumberOfThreads (unsigned int nr_threads = 0) { threads_ = nr_threads; }
@@ -78,6 +78,7 @@ namespace pcl
  
       /** \brief Empty constructor. */
       CovarianceSampling ()
+        : threads_ (1)
       { filter_name_ = "CovarianceSampling"; }
 
       /** \brief Set number of indices to be sampled.
@@ -104,6 +105,18 @@ namespace pcl
       getNormals () const
       { return (input_normals_); }
 
+      /** \brief Set the number of threads to use for projecting the points onto the eigenvectors
+        * and for sorting the candidates. The samples do not depend on the number of threads.
+        * \param[in] nr_threads the number of hardware threads to use (0 sets the value automatically)
+        */
+      void
+      setNumberOfThreads (unsigned int nr_threads = 0);
+
+      /** \brief Get the number of threads used by the filter. */
+      inline unsigned int
+      getNumberOfThreads () const
+      { return (threads_); }
+
 
 
       /** \brief Compute the condition number of the input point cloud. The condition number is the ratio between the
@@ -139,6 +152,9 @@ namespace pcl
 
       std::vector<Eigen::Vector3f, Eigen::aligned_allocator<Eigen::Vector3f> > scaled_points_;
 
+      /** \brief The number of threads the scheduler should use. */
+      unsigned int threads_;
+
       bool
       initCompute ();
 
@@ -63,6 +63,8 @@ namespace pcl
       using Ptr = shared_ptr<CropBox<PointT> >;
       using ConstPtr = shared_ptr<const CropBox<PointT> >;
 
+      using BoxPoseVector = std::vector<Eigen::Affine3f, Eigen::aligned_allocator<Eigen::Affine3f> >;
+
       /** \brief Constructor.
         * \param[in] extract_removed_indices Set to true if you want to be able to extract the indices of points being removed (default = false).
         */
@@ -161,6 +163,21 @@ namespace pcl
         return (transform_);
       }
 
+      using FilterIndices<PointT>::filter;
+
+      /** \brief Crops the input with copies of the box placed at several poses, in a single
+        * pass over the points.
+        *
+        * Each pose replaces the translation and rotation of the box, the minimum and maximum
+        * point and the transformation applied to the cloud are shared by all boxes. The points
+        * are read in blocks and each block is tested against all boxes, so the cloud is read
+        * from memory once regardless of the number of poses. Removed indices are not extracted.
+        * \param[in] box_poses the poses of the box in the (transformed) cloud frame
+        * \param[out] indices the resultant point cloud indices for each box pose
+        */
+      void
+      filter (const BoxPoseVector &box_poses, std::vector<Indices> &indices);
+
     protected:
       using PCLBase<PointT>::input_;
       using PCLBase<PointT>::indices_;
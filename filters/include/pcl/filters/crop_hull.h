@@ -40,6 +40,8 @@
 #include <pcl/Vertices.h>
 #include <pcl/filters/filter_indices.h>
 
+#include <vector>
+
 namespace pcl
 {
   /** \brief Filter points that lie inside or outside a 3D closed surface or 2D
@@ -67,7 +69,8 @@ namespace pcl
       CropHull () :
         hull_cloud_(),
         dim_(3),
-        crop_outside_(true)
+        crop_outside_(true),
+        threads_(1)
       {
         filter_name_ = "CropHull";
       }
@@ -128,6 +131,19 @@ namespace pcl
         crop_outside_ = crop_outside;
       }
 
+      /** \brief Set the number of threads to use for testing the points against a 3D hull.
+        * \param[in] nr_threads the number of hardware threads to use (0 takes as many as the budget of pcl::ExecutionContext allows when filtering)
+        */
+      void
+      setNumberOfThreads (unsigned int nr_threads = 0);
+
+      /** \brief Get the number of threads used for testing the points against a 3D hull. */
+      inline unsigned int
+      getNumberOfThreads () const
+      {
+        return (threads_);
+      }
+
     protected:
       /** \brief Filter the input points using the 2D or 3D polygon hull.
         * \param[out] output The set of points that passed the filter
@@ -215,6 +231,40 @@ namespace pcl
                             const Vertices& verts,
                             const PointCloud& cloud);
 
+      /** \brief Node of the bounding volume hierarchy over the hull polygons. */
+      struct BVHNode
+      {
+        /** \brief Corners of the box bounding all polygons below this node. */
+        Eigen::Vector3f min_pt, max_pt;
+        /** \brief Index of the first child for inner nodes (the second one follows it),
+          * or of the first entry in bvh_polygons_ for leaves.
+          */
+        std::size_t offset;
+        /** \brief Number of polygons of a leaf, 0 for inner nodes. */
+        std::size_t count;
+      };
+
+      /** \brief Build the bounding volume hierarchy over hull_polygons_, used to
+        * cast the rays of the 3D filter in logarithmic time in the number of polygons.
+        */
+      void
+      buildBVH ();
+
+      /** \brief Count the hull polygons crossed by a ray, only visiting the
+        * polygons whose bounding boxes are hit by the ray.
+        * \param[in] point Point from which the ray is cast.
+        * \param[in] ray   Vector in direction of ray.
+        */
+      std::size_t
+      countRayCrossings (const PointT& point, const Eigen::Vector3f& ray) const;
+
+      /** \brief Test whether a point lies inside the 3D hull by a majority vote
+        * over the crossings of three rays, see applyFilter3D.
+        * \param[in] point Point to test against the hull.
+        */
+      bool
+      isPointInHull3D (const PointT& point) const;
+
 
       /** \brief The vertices of the hull used to filter points. */
       std::vector<pcl::Vertices> hull_polygons_;
@@ -229,6 +279,15 @@ namespace pcl
        * false, those inside will be removed.
        */
       bool crop_outside_;
+
+      /** \brief The number of threads the scheduler should use. */
+      unsigned int threads_;
+
+      /** \brief Nodes of the bounding volume hierarchy, the root comes first. */
+      std::vector<BVHNode> bvh_nodes_;
+
+      /** \brief Indices into hull_polygons_, ordered such that every leaf owns a contiguous range. */
+      std::vector<std::size_t> bvh_polygons_;
   };
 
 } // namespace pcl
@@ -10,10 +10,100 @@
 #pragma once
 
 #include <pcl/filters/filter_indices.h>
+#include <pcl/common/execution_context.h>
 #include <pcl/type_traits.h> // for is_invocable
 
+#include <algorithm> // for copy
+#include <cstddef>   // for ptrdiff_t
+#include <vector>
+
 namespace pcl {
 namespace experimental {
+/**
+ * \brief Execution policies selecting how the filters evaluate their function objects
+ * \details With `parallel_policy`, the function object is called concurrently from
+ * several threads and needs to be thread-safe. The output is identical to the one of
+ * `sequenced_policy`.
+ */
+namespace execution {
+struct sequenced_policy {};
+struct parallel_policy {};
+
+constexpr sequenced_policy seq{};
+constexpr parallel_policy par{};
+} // namespace execution
+
+namespace detail {
+/**
+ * \brief Split `input` into the indices selected by `is_selected` and the other ones,
+ * keeping their order
+ * \details The range is split in one contiguous chunk per thread, the chunks are
+ * compacted independently and copied to their offsets in the output, given by a
+ * prefix sum over the chunk sizes.
+ * \param[in] input the indices to test
+ * \param[in] is_selected function object called with each index of `input`
+ * \param[in] nr_threads the number of threads to reserve from pcl::ExecutionContext, 0
+ * for as many as the budget allows
+ * \param[out] indices the selected indices
+ * \param[out] removed_indices the rejected indices, not computed if nullptr
+ */
+template <typename Function>
+void
+partitionIndices(const Indices& input,
+                 Function&& is_selected,
+                 unsigned int nr_threads,
+                 Indices& indices,
+                 Indices* removed_indices)
+{
+  const pcl::ThreadReservation reservation(nr_threads);
+  const unsigned int threads = reservation.getNumberOfThreads();
+  const auto nr_points = static_cast<std::ptrdiff_t>(input.size());
+  const auto nr_chunks = static_cast<std::ptrdiff_t>(
+      std::max<std::ptrdiff_t>(1, std::min<std::ptrdiff_t>(threads, nr_points)));
+  const bool extract_removed = removed_indices != nullptr;
+
+  std::vector<Indices> chunk_selected(nr_chunks), chunk_removed(nr_chunks);
+#pragma omp parallel for default(none) shared(input, is_selected, chunk_selected, chunk_removed) \
+    firstprivate(nr_points, nr_chunks, extract_removed) num_threads(threads) schedule(static, 1)
+  for (std::ptrdiff_t chunk = 0; chunk < nr_chunks; ++chunk) {
+    const std::ptrdiff_t begin = nr_points * chunk / nr_chunks;
+    const std::ptrdiff_t end = nr_points * (chunk + 1) / nr_chunks;
+    chunk_selected[chunk].reserve(end - begin);
+    for (std::ptrdiff_t i = begin; i < end; ++i) {
+      if (is_selected(input[i])) {
+        chunk_selected[chunk].push_back(input[i]);
+      }
+      else if (extract_removed) {
+        chunk_removed[chunk].push_back(input[i]);
+      }
+    }
+  }
+
+  // exclusive prefix sums of the chunk sizes give the output offsets
+  std::vector<std::size_t> selected_offsets(nr_chunks + 1, 0),
+      removed_offsets(nr_chunks + 1, 0);
+  for (std::ptrdiff_t chunk = 0; chunk < nr_chunks; ++chunk) {
+    selected_offsets[chunk + 1] = selected_offsets[chunk] + chunk_selected[chunk].size();
+    removed_offsets[chunk + 1] = removed_offsets[chunk] + chunk_removed[chunk].size();
+  }
+  indices.resize(selected_offsets.back());
+  if (extract_removed)
+    removed_indices->resize(removed_offsets.back());
+
+#pragma omp parallel for default(none) shared(indices, removed_indices, chunk_selected, chunk_removed, selected_offsets, removed_offsets) \
+    firstprivate(nr_chunks, extract_removed) num_threads(threads) schedule(static, 1)
+  for (std::ptrdiff_t chunk = 0; chunk < nr_chunks; ++chunk) {
+    std::copy(chunk_selected[chunk].cbegin(),
+              chunk_selected[chunk].cend(),
+              indices.begin() + selected_offsets[chunk]);
+    if (extract_removed)
+      std::copy(chunk_removed[chunk].cbegin(),
+                chunk_removed[chunk].cend(),
+                removed_indices->begin() + removed_offsets[chunk]);
+  }
+}
+} // namespace detail
+
 /**
  * \brief Checks if the function object meets the usage in `FunctorFilter` class
  * \details `Function` needs to be callable with a const reference to a PointCloud
@@ -28,10 +118,14 @@ namespace advanced {
  * \brief Filter point clouds and indices based on a function object passed in the ctor
  * \details The function object can be anything (lambda, std::function, invocable class,
  * etc.) that can be moved into the class. Additionally, it must satisfy the condition
- * `is_function_object_for_filter_v`
+ * `is_function_object_for_filter_v`. With `execution::parallel_policy`, the indices are
+ * split across `getNumberOfThreads()` threads, which requires the function object to be
+ * thread-safe.
  * \ingroup filters
  */
-template <typename PointT, typename FunctionObject>
+template <typename PointT,
+          typename FunctionObject,
+          typename ExecutionPolicy = execution::sequenced_policy>
 class FunctorFilter : public FilterIndices<PointT> {
   using Base = FilterIndices<PointT>;
   using PCL_Base = PCLBase<PointT>;
@@ -54,6 +148,7 @@ protected:
 private:
   // need to hold a value because lambdas can only be copy or move constructed in C++14
   FunctionObjectT functionObject_;
+  unsigned int threads_ = 1;
 
 public:
   /** \brief Constructor.
@@ -80,6 +175,24 @@ public:
     return functionObject_;
   }
 
+  /** \brief Set the number of threads used with `execution::parallel_policy`.
+   * \param[in] nr_threads the number of hardware threads to use (0 takes as many as the
+   * budget of pcl::ExecutionContext allows when filtering)
+   */
+  void
+  setNumberOfThreads(unsigned int nr_threads = 0)
+  {
+    // 0 is resolved against the budget of pcl::ExecutionContext at compute time
+    threads_ = nr_threads;
+  }
+
+  /** \brief Get the number of threads used with `execution::parallel_policy`. */
+  unsigned int
+  getNumberOfThreads() const noexcept
+  {
+    return threads_;
+  }
+
   /**
    * \brief Filtered results are indexed by an indices array.
    * \param[out] indices The resultant indices.
@@ -87,22 +200,7 @@ public:
   void
   applyFilter(Indices& indices) override
   {
-    indices.clear();
-    indices.reserve(indices_->size());
-    if (extract_removed_indices_) {
-      removed_indices_->clear();
-      removed_indices_->reserve(indices_->size());
-    }
-
-    for (const auto index : *indices_) {
-      // function object returns true for points that should be selected
-      if (negative_ != functionObject_(*input_, index)) {
-        indices.push_back(index);
-      }
-      else if (extract_removed_indices_) {
-        removed_indices_->push_back(index);
-      }
-    }
+    applyFilter(indices, ExecutionPolicy{});
   }
 
 protected:
@@ -128,6 +226,43 @@ protected:
   {
     functionObject_ = std::move(function_object);
   }
+
+private:
+  void
+  applyFilter(Indices& indices, execution::parallel_policy)
+  {
+    const bool negative = negative_;
+    detail::partitionIndices(
+        *indices_,
+        [this, negative](index_t index) {
+          // function object returns true for points that should be selected
+          return negative != static_cast<bool>(functionObject_(*input_, index));
+        },
+        threads_,
+        indices,
+        extract_removed_indices_ ? removed_indices_.get() : nullptr);
+  }
+
+  void
+  applyFilter(Indices& indices, execution::sequenced_policy)
+  {
+    indices.clear();
+    indices.reserve(indices_->size());
+    if (extract_removed_indices_) {
+      removed_indices_->clear();
+      removed_indices_->reserve(indices_->size());
+    }
+
+    for (const auto index : *indices_) {
+      // function object returns true for points that should be selected
+      if (negative_ != functionObject_(*input_, index)) {
+        indices.push_back(index);
+      }
+      else if (extract_removed_indices_) {
+        removed_indices_->push_back(index);
+      }
+    }
+  }
 };
 } // namespace advanced
 
@@ -136,5 +271,9 @@ using FilterFunction = std::function<bool(const PointCloud<PointT>&, index_t)>;
 
 template <class PointT>
 using FunctionFilter = advanced::FunctorFilter<PointT, FilterFunction<PointT>>;
+
+template <class PointT>
+using ParallelFunctionFilter = advanced::
+    FunctorFilter<PointT, FilterFunction<PointT>, execution::parallel_policy>;
 } // namespace experimental
 } // namespace pcl
@@ -0,0 +1,367 @@
+/*
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2020-, Open Perception
+ *
+ *  All rights reserved
+ */
+
+#pragma once
+
+#include <pcl/common/eigen.h>      // for getTransformation
+#include <pcl/common/io.h>         // for getFieldIndex
+#include <pcl/common/point_tests.h> // for isXYZFinite
+#include <pcl/common/transforms.h> // for transformPoint
+#include <pcl/filters/conditional_removal.h>
+#include <pcl/filters/experimental/functor_filter.h>
+
+#include <cstring> // for memcpy
+#include <limits>
+#include <string>
+#include <tuple>
+#include <utility>
+
+namespace pcl {
+namespace experimental {
+/**
+ * \brief Per-point predicate selecting the same points as `pcl::PassThrough`
+ * \details Points with non-finite coordinates or a non-finite field value are
+ * rejected, independently of `negative`
+ * \ingroup filters
+ */
+template <typename PointT>
+class PassThroughPredicate {
+public:
+  /** \brief Constructor.
+   * \param[in] field_name the name of the float field to test, an empty name only
+   * rejects the non-finite points
+   * \param[in] limit_min the minimum allowed field value
+   * \param[in] limit_max the maximum allowed field value
+   * \param[in] negative select the points outside of the limits instead
+   */
+  PassThroughPredicate(const std::string& field_name = "",
+                       float limit_min = std::numeric_limits<float>::lowest(),
+                       float limit_max = std::numeric_limits<float>::max(),
+                       bool negative = false)
+  : limit_min_(limit_min), limit_max_(limit_max), negative_(negative)
+  {
+    if (field_name.empty())
+      return;
+
+    std::vector<pcl::PCLPointField> fields;
+    const int field_idx = pcl::getFieldIndex<PointT>(field_name, fields);
+    if (field_idx == -1) {
+      PCL_WARN("[pcl::experimental::PassThroughPredicate] Unable to find field name "
+               "%s in point type.\n",
+               field_name.c_str());
+      valid_ = false;
+      return;
+    }
+    offset_ = static_cast<int>(fields[field_idx].offset);
+  }
+
+  bool
+  operator()(const PointCloud<PointT>& cloud, index_t idx) const
+  {
+    const PointT& point = cloud[idx];
+    if (!valid_ || !isXYZFinite(point))
+      return false;
+    if (offset_ < 0)
+      return true;
+
+    float field_value = 0;
+    std::memcpy(&field_value,
+                reinterpret_cast<const std::uint8_t*>(&point) + offset_,
+                sizeof(float));
+    if (!std::isfinite(field_value))
+      return false;
+    return negative_ == (field_value < limit_min_ || field_value > limit_max_);
+  }
+
+private:
+  int offset_ = -1;
+  bool valid_ = true;
+  float limit_min_;
+  float limit_max_;
+  bool negative_;
+};
+
+/**
+ * \brief Per-point predicate selecting the same points as `pcl::CropBox`
+ * \details Points with non-finite coordinates are rejected, independently of
+ * `negative`
+ * \ingroup filters
+ */
+template <typename PointT>
+class CropBoxPredicate {
+public:
+  /** \brief Constructor.
+   * \param[in] min_pt the minimum corner of the box, in its local frame
+   * \param[in] max_pt the maximum corner of the box, in its local frame
+   * \param[in] transform the transformation applied to the points first
+   * \param[in] translation the translation of the box
+   * \param[in] rotation the rotation of the box, as euler angles in radians
+   * \param[in] negative select the points outside of the box instead
+   */
+  CropBoxPredicate(const Eigen::Vector4f& min_pt,
+                   const Eigen::Vector4f& max_pt,
+                   const Eigen::Affine3f& transform = Eigen::Affine3f::Identity(),
+                   const Eigen::Vector3f& translation = Eigen::Vector3f::Zero(),
+                   const Eigen::Vector3f& rotation = Eigen::Vector3f::Zero(),
+                   bool negative = false)
+  : min_pt_(min_pt)
+  , max_pt_(max_pt)
+  , transform_(transform)
+  , translation_(translation)
+  , inverse_rotation_(Eigen::Affine3f::Identity())
+  , negative_(negative)
+  {
+    if (rotation != Eigen::Vector3f::Zero()) {
+      Eigen::Affine3f rotation_transform;
+      pcl::getTransformation(
+          0, 0, 0, rotation(0), rotation(1), rotation(2), rotation_transform);
+      inverse_rotation_ = rotation_transform.inverse();
+    }
+    transform_is_identity_ = transform_.matrix().isIdentity();
+    translation_is_zero_ = (translation_ == Eigen::Vector3f::Zero());
+    inverse_rotation_is_identity_ = inverse_rotation_.matrix().isIdentity();
+  }
+
+  bool
+  operator()(const PointCloud<PointT>& cloud, index_t idx) const
+  {
+    // same sequence of operations as CropBox, so that both agree on the boundary
+    PointT local_pt = cloud[idx];
+    if (!isXYZFinite(local_pt))
+      return false;
+    if (!transform_is_identity_)
+      local_pt = pcl::transformPoint<PointT>(local_pt, transform_);
+    if (!translation_is_zero_) {
+      local_pt.x -= translation_(0);
+      local_pt.y -= translation_(1);
+      local_pt.z -= translation_(2);
+    }
+    if (!inverse_rotation_is_identity_)
+      local_pt = pcl::transformPoint<PointT>(local_pt, inverse_rotation_);
+
+    const bool outside = (local_pt.x < min_pt_[0] || local_pt.y < min_pt_[1] ||
+                          local_pt.z < min_pt_[2]) ||
+                         (local_pt.x > max_pt_[0] || local_pt.y > max_pt_[1] ||
+                          local_pt.z > max_pt_[2]);
+    return negative_ == outside;
+  }
+
+private:
+  Eigen::Vector4f min_pt_;
+  Eigen::Vector4f max_pt_;
+  Eigen::Affine3f transform_;
+  Eigen::Vector3f translation_;
+  Eigen::Affine3f inverse_rotation_;
+  bool transform_is_identity_;
+  bool translation_is_zero_;
+  bool inverse_rotation_is_identity_;
+  bool negative_;
+
+public:
+  PCL_MAKE_ALIGNED_OPERATOR_NEW
+};
+
+/**
+ * \brief Per-point predicate selecting the same points as `pcl::ConditionalRemoval`
+ * \details Points with non-finite coordinates are rejected
+ * \ingroup filters
+ */
+template <typename PointT>
+class ConditionPredicate {
+public:
+  /** \brief Constructor.
+   * \param[in] condition the condition the selected points satisfy
+   */
+  ConditionPredicate(typename ConditionBase<PointT>::ConstPtr condition)
+  : condition_(std::move(condition))
+  {
+    if (!condition_ || !condition_->isCapable()) {
+      PCL_WARN("[pcl::experimental::ConditionPredicate] The condition is not "
+               "capable, no point will be selected.\n");
+      condition_.reset();
+    }
+  }
+
+  bool
+  operator()(const PointCloud<PointT>& cloud, index_t idx) const
+  {
+    const PointT& point = cloud[idx];
+    return condition_ && isXYZFinite(point) && condition_->evaluate(point);
+  }
+
+private:
+  typename ConditionBase<PointT>::ConstPtr condition_;
+};
+
+namespace detail {
+template <typename PointT, typename Tuple, std::size_t I, std::size_t N>
+struct EvaluateAll {
+  static bool
+  apply(Tuple& predicates, const PointCloud<PointT>& cloud, index_t idx)
+  {
+    return std::get<I>(predicates)(cloud, idx) &&
+           EvaluateAll<PointT, Tuple, I + 1, N>::apply(predicates, cloud, idx);
+  }
+};
+
+template <typename PointT, typename Tuple, std::size_t N>
+struct EvaluateAll<PointT, Tuple, N, N> {
+  static bool
+  apply(Tuple&, const PointCloud<PointT>&, index_t)
+  {
+    return true;
+  }
+};
+
+template <typename PointT, typename... Predicates>
+struct are_function_objects_for_filter : std::true_type {};
+
+template <typename PointT, typename Predicate, typename... Predicates>
+struct are_function_objects_for_filter<PointT, Predicate, Predicates...>
+: std::integral_constant<
+      bool,
+      is_function_object_for_filter_v<PointT, Predicate> &&
+          are_function_objects_for_filter<PointT, Predicates...>::value> {};
+} // namespace detail
+
+/**
+ * \brief Filter point clouds and indices with the conjunction of several per-point
+ * predicates, evaluated in a single pass over the input
+ * \details Chaining filters such as `PassThrough`, `CropBox` and `ConditionalRemoval`
+ * materializes the intermediate indices and reads the cloud once per stage. This
+ * filter evaluates the predicates of all stages on each point in turn, stopping at the
+ * first one that rejects the point. The predicates are combined at compile time, so
+ * their calls can be inlined. Every predicate must satisfy
+ * `is_function_object_for_filter_v`, e.g. `PassThroughPredicate`, `CropBoxPredicate`,
+ * `ConditionPredicate` or the function object of a `FunctorFilter`. `setNegative`
+ * inverts the conjunction as a whole.
+ * \code
+ * auto filter = pcl::experimental::makeFusedFilter<pcl::PointXYZ>(
+ *     pcl::experimental::PassThroughPredicate<pcl::PointXYZ>("z", 0.f, 2.f),
+ *     pcl::experimental::CropBoxPredicate<pcl::PointXYZ>(min_pt, max_pt),
+ *     [](const pcl::PointCloud<pcl::PointXYZ>& cloud, pcl::index_t idx) {
+ *       return cloud[idx].x > 0.f;
+ *     });
+ * filter.setInputCloud(cloud);
+ * filter.setNumberOfThreads(4);
+ * filter.filter(indices);
+ * \endcode
+ * \ingroup filters
+ */
+template <typename PointT, typename... Predicates>
+class FusedFilter : public FilterIndices<PointT> {
+  using Base = FilterIndices<PointT>;
+  using PCL_Base = PCLBase<PointT>;
+  using PredicatesT = std::tuple<Predicates...>;
+
+  static_assert(sizeof...(Predicates) > 0, "At least one predicate is required");
+  static_assert(detail::are_function_objects_for_filter<PointT, Predicates...>::value,
+                "Predicate signatures must be similar to `bool(const "
+                "PointCloud<PointT>&, index_t)`");
+
+protected:
+  using Base::extract_removed_indices_;
+  using Base::filter_name_;
+  using Base::negative_;
+  using Base::removed_indices_;
+  using PCL_Base::indices_;
+  using PCL_Base::input_;
+
+private:
+  PredicatesT predicates_;
+  unsigned int threads_ = 1;
+
+public:
+  /** \brief Constructor.
+   * \param[in] predicates the predicates all selected points satisfy, evaluated in
+   * the given order
+   * \param[in] extract_removed_indices Set to true if you want to be able to
+   * extract the indices of points being removed (default = false).
+   */
+  FusedFilter(Predicates... predicates, bool extract_removed_indices = false)
+  : Base(extract_removed_indices), predicates_(std::move(predicates)...)
+  {
+    filter_name_ = "fused_filter";
+  }
+
+  /** \brief Set the number of threads to use.
+   * \param[in] nr_threads the number of hardware threads to use (0 takes as many as the
+   * budget of pcl::ExecutionContext allows when filtering)
+   */
+  void
+  setNumberOfThreads(unsigned int nr_threads = 0)
+  {
+    // 0 is resolved against the budget of pcl::ExecutionContext at compute time
+    threads_ = nr_threads;
+  }
+
+  /** \brief Get the number of threads to use. */
+  unsigned int
+  getNumberOfThreads() const noexcept
+  {
+    return threads_;
+  }
+
+  /** \brief Get the predicate at the given position. */
+  template <std::size_t I>
+  const typename std::tuple_element<I, PredicatesT>::type&
+  getPredicate() const noexcept
+  {
+    return std::get<I>(predicates_);
+  }
+
+  /** \brief Get the predicate at the given position. */
+  template <std::size_t I>
+  typename std::tuple_element<I, PredicatesT>::type&
+  getPredicate() noexcept
+  {
+    return std::get<I>(predicates_);
+  }
+
+  /**
+   * \brief Filtered results are indexed by an indices array.
+   * \param[out] indices The resultant indices.
+   */
+  void
+  applyFilter(Indices& indices) override
+  {
+    const bool negative = negative_;
+    detail::partitionIndices(
+        *indices_,
+        [this, negative](index_t index) { return negative != isSelected(index); },
+        threads_,
+        indices,
+        extract_removed_indices_ ? removed_indices_.get() : nullptr);
+  }
+
+private:
+  bool
+  isSelected(index_t idx)
+  {
+    return detail::EvaluateAll<PointT, PredicatesT, 0, sizeof...(Predicates)>::apply(
+        predicates_, *input_, idx);
+  }
+
+public:
+  PCL_MAKE_ALIGNED_OPERATOR_NEW
+};
+
+/**
+ * \brief Create a `FusedFilter` deducing the types of the predicates
+ * \param[in] predicates the predicates all selected points satisfy, evaluated in the
+ * given order
+ */
+template <typename PointT, typename... Predicates>
+FusedFilter<PointT, Predicates...>
+makeFusedFilter(Predicates... predicates)
+{
+  return FusedFilter<PointT, Predicates...>(std::move(predicates)...);
+}
+} // namespace experimental
+} // namespace pcl
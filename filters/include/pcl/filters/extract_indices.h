@@ -43,6 +43,19 @@
 
 namespace pcl
 {
+  namespace detail
+  {
+    /** \brief Get the indices in [0, nr_points) that do not appear in indices, in ascending order.
+      * \details The indices are marked in a bitset, which is then scanned in parallel. Indices
+      * outside of [0, nr_points) are ignored.
+      * \param[in] indices the indices to leave out, in any order and possibly repeated
+      * \param[in] nr_points the number of points of the cloud
+      * \param[out] complement the remaining indices
+      */
+    PCL_EXPORTS void
+    complementIndices (const Indices &indices, std::size_t nr_points, Indices &complement);
+  }
+
   /** \brief @b ExtractIndices extracts a set of indices from a point cloud.
     * \details Usage example:
     * \code
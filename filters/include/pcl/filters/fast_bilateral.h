@@ -143,7 +143,18 @@ namespace pcl
           Eigen::Vector2f
           trilinear_interpolation (const float x,
                                    const float y,
-                                   const float z);
+                                   const float z) const;
+
+          /** \brief Trilinear interpolation at (x_index + x_alpha, y_index + y_alpha, z) in float
+            * precision. The two depth neighbors of a grid cell are adjacent in memory, so they are
+            * blended as one Eigen::Vector4f. Falls back to the clamped version at the grid border.
+            */
+          Eigen::Vector2f
+          trilinear_interpolation (const std::size_t x_index,
+                                   const float x_alpha,
+                                   const std::size_t y_index,
+                                   const float y_alpha,
+                                   const float z) const;
 
           static inline std::size_t
           clamp (const std::size_t min_value,
@@ -183,6 +194,42 @@ namespace pcl
           std::size_t x_dim_, y_dim_, z_dim_;
       };
 
+      /** \brief Grid coordinates of the image columns and rows, shared by all pixels of a column
+        * or row when slicing the grid.
+        */
+      struct SliceCoordinates
+      {
+        std::vector<std::size_t> x_index, y_index;
+        std::vector<float> x_alpha, y_alpha;
+        float base_min;
+        float padding_z;
+      };
+
+      /** \brief Compute the grid coordinates of the image columns and rows.
+        * \param[in] base_min the minimum depth of the input
+        * \param[in] padding_xy the padding of the grid in x and y
+        * \param[in] padding_z the padding of the grid in depth
+        * \param[out] coordinates the grid coordinates
+        */
+      void
+      computeSliceCoordinates (const float base_min,
+                               const std::size_t padding_xy,
+                               const std::size_t padding_z,
+                               SliceCoordinates &coordinates) const;
+
+      /** \brief Replace the depth of the points of one image row by the value interpolated from
+        * the blurred grid. Rows are independent, so they can be sliced concurrently.
+        * \param[in] data the blurred grid
+        * \param[in] coordinates the grid coordinates from computeSliceCoordinates
+        * \param[in] y the image row
+        * \param[in,out] output the filtered cloud
+        */
+      void
+      sliceRow (const Array3D &data,
+                const SliceCoordinates &coordinates,
+                const std::size_t y,
+                PointCloud &output) const;
+
 
   };
 }
@@ -41,6 +41,7 @@
 
 #include <pcl/pcl_base.h>
 #include <pcl/common/io.h> // for copyPointCloud
+#include <pcl/common/trace.h>
 #include <pcl/PointIndices.h>
 
 namespace pcl
@@ -120,6 +121,8 @@ namespace pcl
       inline void
       filter (PointCloud &output)
       {
+        PCL_TRACE_ZONE (filter_name_);
+
         if (!initCompute ())
           return;
 
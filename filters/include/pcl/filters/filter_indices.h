@@ -100,6 +100,8 @@ namespace pcl
       void
       filter (Indices &indices)
       {
+        PCL_TRACE_ZONE (filter_name_);
+
         if (!initCompute ())
           return;
 
@@ -163,6 +165,7 @@ namespace pcl
       using Filter<PointT>::deinitCompute;
       using Filter<PointT>::input_;
       using Filter<PointT>::removed_indices_;
+      using Filter<PointT>::filter_name_;
 
       /** \brief False = normal filter behavior (default), true = inverted behavior. */
       bool negative_;
@@ -84,6 +84,7 @@ namespace pcl
       using Ptr = shared_ptr<FrustumCulling<PointT> >;
       using ConstPtr = shared_ptr<const FrustumCulling<PointT> >;
 
+      using CameraPoseVector = std::vector<Eigen::Matrix4f, Eigen::aligned_allocator<Eigen::Matrix4f> >;
 
       using Filter<PointT>::getClassName;
 
@@ -193,6 +194,22 @@ namespace pcl
         return (fp_dist_);
       }
 
+      using FilterIndices<PointT>::filter;
+
+      /** \brief Culls the input against several camera poses in a single pass over the points.
+        *
+        * All frusta share the field of view and the plane distances of this filter, the
+        * camera pose of the filter is ignored. The points are read in blocks and each block
+        * is tested against the planes of all frusta, so the cloud is read from memory once
+        * regardless of the number of poses. The result for each pose is the one of
+        * \a filter (Indices &) with that pose, up to the rounding of points lying exactly on
+        * a plane. Removed indices are not extracted.
+        * \param[in] camera_poses the camera poses, see setCameraPose
+        * \param[out] indices the resultant point cloud indices for each camera pose
+        */
+      void
+      filter (const CameraPoseVector &camera_poses, std::vector<Indices> &indices);
+
     protected:
       using PCLBase<PointT>::input_;
       using PCLBase<PointT>::indices_;
@@ -209,6 +226,14 @@ namespace pcl
       void
       applyFilter (Indices &indices) override;
 
+      /** \brief Computes the planes of the frustum of a camera pose. A point p is inside the
+        * frustum if p.homogeneous () has a non positive dot product with every column.
+        * \param[in] camera_pose the camera pose
+        * \param[out] planes the left, right, top, bottom, far and near plane
+        */
+      void
+      computeFrustumPlanes (const Eigen::Matrix4f &camera_pose, Eigen::Matrix<float, 4, 6> &planes) const;
+
     private:
 
       /** \brief The camera pose */
@@ -40,8 +40,61 @@
 
 #include <pcl/common/io.h>
 #include <pcl/common/copy_point.h>
+#include <pcl/common/execution_context.h>
 #include <pcl/filters/conditional_removal.h>
 
+#include <algorithm> // for std::fill_n
+#include <array>
+#include <cstring> // for memcpy
+#include <typeinfo>
+
+namespace pcl
+{
+  namespace detail
+  {
+    /** \brief Compares a field of a block of points to a value, with the semantics of
+      * PointDataAtOffset::compare followed by FieldComparison::evaluate.
+      */
+    template <typename FieldT, typename PointT> void
+    compareFieldColumn (const PointCloud<PointT> &cloud, const index_t *indices, std::size_t nr_points,
+                        std::uint32_t offset, ComparisonOps::CompareOp op, double value,
+                        unsigned char *result)
+    {
+      constexpr std::size_t max_block_size = 256;
+      assert (nr_points <= max_block_size);
+      // Gather the column first, so the comparisons below are simple vectorizable loops
+      std::array<FieldT, max_block_size> column;
+      for (std::size_t i = 0; i < nr_points; ++i)
+        memcpy (&column[i], reinterpret_cast<const std::uint8_t*> (&cloud[indices[i]]) + offset, sizeof (FieldT));
+
+      const FieldT val = static_cast<FieldT> (value);
+      switch (op)
+      {
+        case ComparisonOps::GT:
+          for (std::size_t i = 0; i < nr_points; ++i)
+            result[i] = (column[i] > val);
+          break;
+        case ComparisonOps::GE:
+          for (std::size_t i = 0; i < nr_points; ++i)
+            result[i] = !(column[i] < val);
+          break;
+        case ComparisonOps::LT:
+          for (std::size_t i = 0; i < nr_points; ++i)
+            result[i] = (column[i] < val);
+          break;
+        case ComparisonOps::LE:
+          for (std::size_t i = 0; i < nr_points; ++i)
+            result[i] = !(column[i] > val);
+          break;
+        case ComparisonOps::EQ:
+          for (std::size_t i = 0; i < nr_points; ++i)
+            result[i] = !(column[i] > val) && !(column[i] < val);
+          break;
+      }
+    }
+  }
+}
+
 //////////////////////////////////////////////////////////////////////////
 //////////////////////////////////////////////////////////////////////////
 //////////////////////////////////////////////////////////////////////////
@@ -647,6 +700,179 @@ pcl::ConditionalRemoval<PointT>::setCondition (ConditionBasePtr condition)
   capable_ = condition_->isCapable ();
 }
 
+//////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::ConditionalRemoval<PointT>::setNumberOfThreads (unsigned int nr_threads)
+{
+  // 0 is resolved against the budget of pcl::ExecutionContext at compute time
+  threads_ = nr_threads;
+}
+
+//////////////////////////////////////////////////////////////////////////
+template <typename PointT> std::size_t
+pcl::ConditionalRemoval<PointT>::compileCondition (
+    const ConditionBase &condition, std::vector<ConditionInstruction> &program) const
+{
+  ConditionInstruction instruction {};
+
+  // Conditions of other types may override evaluate, so they are kept as they are
+  const bool is_and = (typeid (condition) == typeid (ConditionAnd<PointT>));
+  if (!is_and && typeid (condition) != typeid (ConditionOr<PointT>))
+  {
+    instruction.code = ConditionInstruction::CONDITION;
+    instruction.condition = &condition;
+    program.push_back (instruction);
+    return (1);
+  }
+
+  // The operands are evaluated in the same order as by ConditionAnd::evaluate and
+  // ConditionOr::evaluate, their results stay on the stack until they are combined
+  std::size_t depth = 0;
+  std::size_t nr_operands = 0;
+  for (const auto &comparison : condition.comparisons_)
+  {
+    instruction = ConditionInstruction {};
+    const auto *field_comparison = dynamic_cast<const FieldComparison<PointT>*> (comparison.get ());
+    if (field_comparison && typeid (*comparison) == typeid (FieldComparison<PointT>) &&
+        field_comparison->point_data_ && field_comparison->op_ >= ComparisonOps::GT &&
+        field_comparison->op_ <= ComparisonOps::EQ &&
+        field_comparison->point_data_->datatype_ >= pcl::PCLPointField::INT8 &&
+        field_comparison->point_data_->datatype_ <= pcl::PCLPointField::FLOAT64)
+    {
+      instruction.code = ConditionInstruction::FIELD;
+      instruction.datatype = field_comparison->point_data_->datatype_;
+      instruction.offset = field_comparison->point_data_->offset_;
+      instruction.op = field_comparison->op_;
+      instruction.value = field_comparison->compare_val_;
+    }
+    else
+    {
+      instruction.code = ConditionInstruction::COMPARISON;
+      instruction.comparison = comparison.get ();
+    }
+    program.push_back (instruction);
+    depth = std::max (depth, nr_operands + 1);
+    ++nr_operands;
+  }
+  for (const auto &child : condition.conditions_)
+  {
+    depth = std::max (depth, nr_operands + compileCondition (*child, program));
+    ++nr_operands;
+  }
+
+  // An empty condition is true, and so is the combination of no operands
+  instruction = ConditionInstruction {};
+  instruction.code = (is_and ? ConditionInstruction::AND : ConditionInstruction::OR);
+  instruction.nr_operands = nr_operands;
+  program.push_back (instruction);
+  return (std::max<std::size_t> (depth, 1));
+}
+
+//////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::ConditionalRemoval<PointT>::evaluateCondition (const Indices &indices,
+                                                    std::vector<unsigned char> &passed) const
+{
+  std::vector<ConditionInstruction> program;
+  const std::size_t stack_depth = compileCondition (*condition_, program);
+
+  passed.resize (indices.size ());
+  const std::size_t block_size = 256;
+  const std::ptrdiff_t nr_blocks = (indices.size () + block_size - 1) / block_size;
+
+  const pcl::ThreadReservation reservation (threads_);
+  unsigned int threads = reservation.getNumberOfThreads ();
+#pragma omp parallel default(none) shared(indices, passed, program) \
+  firstprivate(stack_depth, block_size, nr_blocks) num_threads(threads)
+  {
+    // Results of the instructions for one block of points
+    std::vector<unsigned char> stack (stack_depth * block_size);
+#pragma omp for schedule(dynamic, 16)
+    for (std::ptrdiff_t block = 0; block < nr_blocks; ++block)
+    {
+      const std::size_t begin = block * block_size;
+      const std::size_t nr_points = std::min (block_size, indices.size () - begin);
+      const index_t *block_indices = indices.data () + begin;
+      unsigned char *top = stack.data ();
+      for (const auto &instruction : program)
+      {
+        switch (instruction.code)
+        {
+          case ConditionInstruction::FIELD:
+          {
+            switch (instruction.datatype)
+            {
+              case pcl::PCLPointField::INT8:
+                detail::compareFieldColumn<std::int8_t> (*input_, block_indices, nr_points, instruction.offset, instruction.op, instruction.value, top);
+                break;
+              case pcl::PCLPointField::UINT8:
+                detail::compareFieldColumn<std::uint8_t> (*input_, block_indices, nr_points, instruction.offset, instruction.op, instruction.value, top);
+                break;
+              case pcl::PCLPointField::INT16:
+                detail::compareFieldColumn<std::int16_t> (*input_, block_indices, nr_points, instruction.offset, instruction.op, instruction.value, top);
+                break;
+              case pcl::PCLPointField::UINT16:
+                detail::compareFieldColumn<std::uint16_t> (*input_, block_indices, nr_points, instruction.offset, instruction.op, instruction.value, top);
+                break;
+              case pcl::PCLPointField::INT32:
+                detail::compareFieldColumn<std::int32_t> (*input_, block_indices, nr_points, instruction.offset, instruction.op, instruction.value, top);
+                break;
+              case pcl::PCLPointField::UINT32:
+                detail::compareFieldColumn<std::uint32_t> (*input_, block_indices, nr_points, instruction.offset, instruction.op, instruction.value, top);
+                break;
+              case pcl::PCLPointField::FLOAT32:
+                detail::compareFieldColumn<float> (*input_, block_indices, nr_points, instruction.offset, instruction.op, instruction.value, top);
+                break;
+              case pcl::PCLPointField::FLOAT64:
+                detail::compareFieldColumn<double> (*input_, block_indices, nr_points, instruction.offset, instruction.op, instruction.value, top);
+                break;
+            }
+            top += block_size;
+            break;
+          }
+          case ConditionInstruction::COMPARISON:
+          {
+            for (std::size_t i = 0; i < nr_points; ++i)
+              top[i] = instruction.comparison->evaluate ((*input_)[block_indices[i]]);
+            top += block_size;
+            break;
+          }
+          case ConditionInstruction::CONDITION:
+          {
+            for (std::size_t i = 0; i < nr_points; ++i)
+              top[i] = instruction.condition->evaluate ((*input_)[block_indices[i]]);
+            top += block_size;
+            break;
+          }
+          case ConditionInstruction::AND:
+          case ConditionInstruction::OR:
+          {
+            if (instruction.nr_operands == 0)
+            {
+              std::fill_n (top, nr_points, 1);
+              top += block_size;
+              break;
+            }
+            unsigned char *result = top - instruction.nr_operands * block_size;
+            for (unsigned char *operand = result + block_size; operand != top; operand += block_size)
+            {
+              if (instruction.code == ConditionInstruction::AND)
+                for (std::size_t i = 0; i < nr_points; ++i)
+                  result[i] &= operand[i];
+              else
+                for (std::size_t i = 0; i < nr_points; ++i)
+                  result[i] |= operand[i];
+            }
+            top = result + block_size;
+            break;
+          }
+        }
+      }
+      std::copy (stack.data (), stack.data () + nr_points, passed.begin () + begin);
+    }
+  }
+}
+
 //////////////////////////////////////////////////////////////////////////
 template <typename PointT> void
 pcl::ConditionalRemoval<PointT>::applyFilter (PointCloud &output)
@@ -687,11 +913,15 @@ pcl::ConditionalRemoval<PointT>::applyFilter (PointCloud &output)
 
   int nr_removed_p = 0;
 
+  std::vector<unsigned char> passed;
   if (!keep_organized_)
   {
+    evaluateCondition (*Filter<PointT>::indices_, passed);
+
     int nr_p = 0;
-    for (std::size_t index: (*Filter<PointT>::indices_))
+    for (std::size_t i = 0; i < Filter<PointT>::indices_->size (); ++i)
     {
+      const auto index = (*Filter<PointT>::indices_)[i];
 
       const PointT& point = (*input_)[index];
       // Check if the point is invalid
@@ -707,7 +937,7 @@ pcl::ConditionalRemoval<PointT>::applyFilter (PointCloud &output)
         continue;
       }
 
-      if (condition_->evaluate (point))
+      if (passed[i])
       {
         copyPoint (point, output[nr_p]);
         nr_p++;
@@ -729,12 +959,14 @@ pcl::ConditionalRemoval<PointT>::applyFilter (PointCloud &output)
   {
     Indices indices = *Filter<PointT>::indices_;
     std::sort (indices.begin (), indices.end ());   //TODO: is this necessary or can we assume the indices to be sorted?
+    evaluateCondition (indices, passed);
     bool removed_p = false;
     std::size_t ci = 0;
     for (std::size_t cp = 0; cp < input_->size (); ++cp)
     {
       if (cp == static_cast<std::size_t> (indices[ci]))
       {
+        const std::size_t point_ci = ci;
         if (ci < indices.size () - 1)
         {
           ci++;
@@ -745,7 +977,7 @@ pcl::ConditionalRemoval<PointT>::applyFilter (PointCloud &output)
         // copy all the fields
         copyPoint ((*input_)[cp], output[cp]);
 
-        if (!condition_->evaluate ((*input_)[cp]))
+        if (!passed[point_ci])
         {
           output[cp].getVector4fMap ().setConstant (user_filter_value_);
           removed_p = true;
@@ -42,6 +42,7 @@
 
 #include <pcl/pcl_config.h>
 #include <pcl/common/distances.h>
+#include <pcl/common/execution_context.h>
 #include <pcl/common/point_tests.h> // for pcl::isFinite
 
 
@@ -280,6 +281,8 @@ Convolution<pcl::RGB, pcl::RGB>::makeInfinite (pcl::RGB& p)
 template <typename PointIn, typename PointOut> void
 Convolution<PointIn, PointOut>::convolve_rows (PointCloudOut& output)
 {
+  const pcl::ThreadReservation reservation (threads_);
+  const unsigned int threads = reservation.getNumberOfThreads ();
   using namespace pcl::common;
 
   int width = input_->width;
@@ -290,7 +293,7 @@ Convolution<PointIn, PointOut>::convolve_rows (PointCloudOut& output)
 #pragma omp parallel for \
   default(none) \
   shared(height, last, output, width) \
-  num_threads(threads_)
+  num_threads(threads)
     for(int j = 0; j < height; ++j)
     {
       for (int i = 0; i < half_width_; ++i)
@@ -308,7 +311,7 @@ Convolution<PointIn, PointOut>::convolve_rows (PointCloudOut& output)
 #pragma omp parallel for \
   default(none) \
   shared(height, last, output, width) \
-  num_threads(threads_)
+  num_threads(threads)
     for(int j = 0; j < height; ++j)
     {
       for (int i = 0; i < half_width_; ++i)
@@ -326,6 +329,8 @@ Convolution<PointIn, PointOut>::convolve_rows (PointCloudOut& output)
 template <typename PointIn, typename PointOut> void
 Convolution<PointIn, PointOut>::convolve_rows_duplicate (PointCloudOut& output)
 {
+  const pcl::ThreadReservation reservation (threads_);
+  const unsigned int threads = reservation.getNumberOfThreads ();
   using namespace pcl::common;
 
   int width = input_->width;
@@ -337,7 +342,7 @@ Convolution<PointIn, PointOut>::convolve_rows_duplicate (PointCloudOut& output)
 #pragma omp parallel for \
   default(none) \
   shared(height, last, output, w, width) \
-  num_threads(threads_)
+  num_threads(threads)
     for(int j = 0; j < height; ++j)
     {
       for (int i = half_width_; i < last; ++i)
@@ -355,7 +360,7 @@ Convolution<PointIn, PointOut>::convolve_rows_duplicate (PointCloudOut& output)
 #pragma omp parallel for \
   default(none) \
   shared(height, last, output, w, width) \
-  num_threads(threads_)
+  num_threads(threads)
     for(int j = 0; j < height; ++j)
     {
       for (int i = half_width_; i < last; ++i)
@@ -373,6 +378,8 @@ Convolution<PointIn, PointOut>::convolve_rows_duplicate (PointCloudOut& output)
 template <typename PointIn, typename PointOut> void
 Convolution<PointIn, PointOut>::convolve_rows_mirror (PointCloudOut& output)
 {
+  const pcl::ThreadReservation reservation (threads_);
+  const unsigned int threads = reservation.getNumberOfThreads ();
   using namespace pcl::common;
 
   int width = input_->width;
@@ -384,7 +391,7 @@ Convolution<PointIn, PointOut>::convolve_rows_mirror (PointCloudOut& output)
 #pragma omp parallel for \
   default(none) \
   shared(height, last, output, w, width) \
-  num_threads(threads_)
+  num_threads(threads)
     for(int j = 0; j < height; ++j)
     {
       for (int i = half_width_; i < last; ++i)
@@ -402,7 +409,7 @@ Convolution<PointIn, PointOut>::convolve_rows_mirror (PointCloudOut& output)
 #pragma omp parallel for \
   default(none) \
   shared(height, last, output, w, width) \
-  num_threads(threads_)
+  num_threads(threads)
     for(int j = 0; j < height; ++j)
     {
       for (int i = half_width_; i < last; ++i)
@@ -420,27 +427,31 @@ Convolution<PointIn, PointOut>::convolve_rows_mirror (PointCloudOut& output)
 template <typename PointIn, typename PointOut> void
 Convolution<PointIn, PointOut>::convolve_cols (PointCloudOut& output)
 {
+  const pcl::ThreadReservation reservation (threads_);
+  const unsigned int threads = reservation.getNumberOfThreads ();
   using namespace pcl::common;
 
   int width = input_->width;
   int height = input_->height;
   int last = input_->height - half_width_;
+  // Rows are processed as a whole so that the points are accessed in memory order
   if (input_->is_dense)
   {
 #pragma omp parallel for \
   default(none) \
   shared(height, last, output, width) \
-  num_threads(threads_)
-    for(int i = 0; i < width; ++i)
+  num_threads(threads)
+    for(int j = 0; j < height; ++j)
     {
-      for (int j = 0; j < half_width_; ++j)
-        makeInfinite (output (i,j));
-
-      for (int j = half_width_; j < last; ++j)
+      if (j < half_width_ || j >= last)
+      {
+        for (int i = 0; i < width; ++i)
+          makeInfinite (output (i,j));
+        continue;
+      }
+
+      for (int i = 0; i < width; ++i)
         output (i,j) = convolveOneColDense (i,j);
-
-      for (int j = last; j < height; ++j)
-        makeInfinite (output (i,j));
     }
   }
   else
@@ -448,17 +459,18 @@ Convolution<PointIn, PointOut>::convolve_cols (PointCloudOut& output)
 #pragma omp parallel for \
   default(none) \
   shared(height, last, output, width) \
-  num_threads(threads_)
-    for(int i = 0; i < width; ++i)
+  num_threads(threads)
+    for(int j = 0; j < height; ++j)
     {
-      for (int j = 0; j < half_width_; ++j)
-        makeInfinite (output (i,j));
-
-      for (int j = half_width_; j < last; ++j)
+      if (j < half_width_ || j >= last)
+      {
+        for (int i = 0; i < width; ++i)
+          makeInfinite (output (i,j));
+        continue;
+      }
+
+      for (int i = 0; i < width; ++i)
         output (i,j) = convolveOneColNonDense (i,j);
-
-      for (int j = last; j < height; ++j)
-        makeInfinite (output (i,j));
     }
   }
 }
@@ -466,94 +478,94 @@ Convolution<PointIn, PointOut>::convolve_cols (PointCloudOut& output)
 template <typename PointIn, typename PointOut> void
 Convolution<PointIn, PointOut>::convolve_cols_duplicate (PointCloudOut& output)
 {
+  const pcl::ThreadReservation reservation (threads_);
+  const unsigned int threads = reservation.getNumberOfThreads ();
   using namespace pcl::common;
 
   int width = input_->width;
   int height = input_->height;
   int last = input_->height - half_width_;
   int h = last -1;
+  // Rows are processed as a whole so that the points are accessed in memory order
   if (input_->is_dense)
   {
 #pragma omp parallel for \
   default(none) \
-  shared(h, height, last, output, width) \
-  num_threads(threads_)
-    for(int i = 0; i < width; ++i)
-    {
-      for (int j = half_width_; j < last; ++j)
+  shared(last, output, width) \
+  num_threads(threads)
+    for(int j = half_width_; j < last; ++j)
+      for (int i = 0; i < width; ++i)
         output (i,j) = convolveOneColDense (i,j);
-
-      for (int j = last; j < height; ++j)
-        output (i,j) = output (i,h);
-
-      for (int j = 0; j < half_width_; ++j)
-        output (i,j) = output (i, half_width_);
-    }
   }
   else
   {
 #pragma omp parallel for \
   default(none) \
-  shared(h, height, last, output, width) \
-  num_threads(threads_)
-    for(int i = 0; i < width; ++i)
-    {
-      for (int j = half_width_; j < last; ++j)
+  shared(last, output, width) \
+  num_threads(threads)
+    for(int j = half_width_; j < last; ++j)
+      for (int i = 0; i < width; ++i)
         output (i,j) = convolveOneColNonDense (i,j);
+  }
 
-      for (int j = last; j < height; ++j)
-        output (i,j) = output (i,h);
+#pragma omp parallel for \
+  default(none) \
+  shared(h, height, last, output, width) \
+  num_threads(threads)
+  for(int i = 0; i < width; ++i)
+  {
+    for (int j = last; j < height; ++j)
+      output (i,j) = output (i,h);
 
-      for (int j = 0; j < half_width_; ++j)
-        output (i,j) = output (i,half_width_);
-    }
+    for (int j = 0; j < half_width_; ++j)
+      output (i,j) = output (i,half_width_);
   }
 }
 
 template <typename PointIn, typename PointOut> void
 Convolution<PointIn, PointOut>::convolve_cols_mirror (PointCloudOut& output)
 {
+  const pcl::ThreadReservation reservation (threads_);
+  const unsigned int threads = reservation.getNumberOfThreads ();
   using namespace pcl::common;
 
   int width = input_->width;
   int height = input_->height;
   int last = input_->height - half_width_;
   int h = last -1;
+  // Rows are processed as a whole so that the points are accessed in memory order
   if (input_->is_dense)
   {
 #pragma omp parallel for \
   default(none) \
-  shared(h, height, last, output, width) \
-  num_threads(threads_)
-    for(int i = 0; i < width; ++i)
-    {
-      for (int j = half_width_; j < last; ++j)
+  shared(last, output, width) \
+  num_threads(threads)
+    for(int j = half_width_; j < last; ++j)
+      for (int i = 0; i < width; ++i)
         output (i,j) = convolveOneColDense (i,j);
-
-      for (int j = last, l = 0; j < height; ++j, ++l)
-        output (i,j) = output (i,h-l);
-
-      for (int j = 0; j < half_width_; ++j)
-        output (i,j) = output (i, half_width_+1-j);
-    }
   }
   else
   {
 #pragma omp parallel for \
   default(none) \
-  shared(h, height, last, output, width) \
-  num_threads(threads_)
-    for(int i = 0; i < width; ++i)
-    {
-      for (int j = half_width_; j < last; ++j)
+  shared(last, output, width) \
+  num_threads(threads)
+    for(int j = half_width_; j < last; ++j)
+      for (int i = 0; i < width; ++i)
         output (i,j) = convolveOneColNonDense (i,j);
+  }
 
-      for (int j = last, l = 0; j < height; ++j, ++l)
-        output (i,j) = output (i,h-l);
+#pragma omp parallel for \
+  default(none) \
+  shared(h, height, last, output, width) \
+  num_threads(threads)
+  for(int i = 0; i < width; ++i)
+  {
+    for (int j = last, l = 0; j < height; ++j, ++l)
+      output (i,j) = output (i,h-l);
 
-      for (int j = 0; j < half_width_; ++j)
-        output (i,j) = output (i,half_width_+1-j);
-    }
+    for (int j = 0; j < half_width_; ++j)
+      output (i,j) = output (i,half_width_+1-j);
   }
 }
 
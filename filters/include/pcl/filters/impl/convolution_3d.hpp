@@ -41,6 +41,7 @@
 #define PCL_FILTERS_CONVOLUTION_3D_IMPL_HPP
 
 #include <pcl/pcl_config.h>
+#include <pcl/common/execution_context.h>
 #include <pcl/point_types.h>
 
 #include <cmath>
@@ -229,6 +230,8 @@ pcl::filters::Convolution3D<PointInT, PointOutT, KernelT>::initCompute ()
 template <typename PointInT, typename PointOutT, typename KernelT> void
 pcl::filters::Convolution3D<PointInT, PointOutT, KernelT>::convolve (PointCloudOut& output)
 {
+  const pcl::ThreadReservation reservation (threads_);
+  const unsigned int threads = reservation.getNumberOfThreads ();
   if (!initCompute ())
   {
     PCL_ERROR ("[pcl::filters::Convlution3D::convolve] init failed!\n");
@@ -245,7 +248,7 @@ pcl::filters::Convolution3D<PointInT, PointOutT, KernelT>::convolve (PointCloudO
   default(none) \
   shared(output) \
   firstprivate(nn_indices, nn_distances) \
-  num_threads(threads_)
+  num_threads(threads)
   for (std::int64_t point_idx = 0; point_idx < static_cast<std::int64_t> (surface_->size ()); ++point_idx)
   {
     const PointInT& point_in = surface_->points [point_idx];
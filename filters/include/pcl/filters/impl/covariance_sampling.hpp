@@ -42,9 +42,21 @@
 #define PCL_FILTERS_IMPL_COVARIANCE_SAMPLING_H_
 
 #include <pcl/filters/covariance_sampling.h>
-#include <list>
+#include <pcl/common/execution_context.h>
 #include <Eigen/Eigenvalues> // for SelfAdjointEigenSolver
 
+#include <algorithm> // for std::stable_sort
+#include <array>
+#include <numeric> // for std::iota
+
+///////////////////////////////////////////////////////////////////////////////
+template<typename PointT, typename PointNT> void
+pcl::CovarianceSampling<PointT, PointNT>::setNumberOfThreads (unsigned int nr_threads)
+{
+  // 0 is resolved against the budget of pcl::ExecutionContext at compute time
+  threads_ = nr_threads;
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 template<typename PointT, typename PointNT> bool
 pcl::CovarianceSampling<PointT, PointNT>::initCompute ()
@@ -138,42 +150,57 @@ pcl::CovarianceSampling<PointT, PointNT>::applyFilter (Indices &sampled_indices)
   const Eigen::Matrix<double, 6, 6> x = solver.eigenvectors ();
 
   //--- Part B from the paper
-  /// TODO figure out how to fill the candidate_indices - see subsequent paper paragraphs
-  std::vector<std::size_t> candidate_indices;
-  candidate_indices.resize (indices_->size ());
-  for (std::size_t p_i = 0; p_i < candidate_indices.size (); ++p_i)
-    candidate_indices[p_i] = p_i;
+  /// TODO figure out how to fill the candidate indices - see subsequent paper paragraphs.
+  /// For now all the input points are candidates.
+  const std::size_t nr_candidates = indices_->size ();
 
-  // Compute the v 6-vectors
+  // Compute the v 6-vectors and their projections onto the eigenvectors
   using Vector6d = Eigen::Matrix<double, 6, 1>;
-  std::vector<Vector6d, Eigen::aligned_allocator<Vector6d> > v;
-  v.resize (candidate_indices.size ());
-  for (std::size_t p_i = 0; p_i < candidate_indices.size (); ++p_i)
+  std::vector<Vector6d, Eigen::aligned_allocator<Vector6d> > v (nr_candidates);
+  Eigen::Matrix<double, 6, Eigen::Dynamic> dots (6, nr_candidates);
+  const pcl::ThreadReservation reservation (threads_);
+  unsigned int threads = reservation.getNumberOfThreads ();
+#pragma omp parallel for \
+  default(none) \
+  shared(dots, v, x) \
+  firstprivate(nr_candidates) \
+  num_threads(threads)
+  for (std::ptrdiff_t p_i = 0; p_i < static_cast<std::ptrdiff_t> (nr_candidates); ++p_i)
   {
-    v[p_i].block<3, 1> (0, 0) = scaled_points_[p_i].cross (
-                                  (*input_normals_)[(*indices_)[candidate_indices[p_i]]].getNormalVector3fMap ()).template cast<double> ();
-    v[p_i].block<3, 1> (3, 0) = (*input_normals_)[(*indices_)[candidate_indices[p_i]]].getNormalVector3fMap ().template cast<double> ();
+    const auto normal = (*input_normals_)[(*indices_)[p_i]].getNormalVector3fMap ();
+    v[p_i].template block<3, 1> (0, 0) = scaled_points_[p_i].cross (normal).template cast<double> ();
+    v[p_i].template block<3, 1> (3, 0) = normal.template cast<double> ();
+    for (int i = 0; i < 6; ++i)
+      dots (i, p_i) = v[p_i].dot (x.template block<6, 1> (0, i));
   }
 
-
-  // Set up the lists to be sorted
-  std::vector<std::list<std::pair<int, double> > > L;
-  L.resize (6);
-
-  for (std::size_t i = 0; i < 6; ++i)
+  // The candidates of every dimension, sorted by decreasing |dot|. The lists are static, so
+  // a cursor that skips the already sampled points acts as the priority queue of the
+  // dimension. Stable sorting keeps the candidates with equal dots in input order.
+  std::array<std::vector<std::size_t>, 6> L;
+#pragma omp parallel for \
+  default(none) \
+  shared(dots, L) \
+  firstprivate(nr_candidates) \
+  num_threads(threads)
+  for (int i = 0; i < 6; ++i)
   {
-    for (std::size_t p_i = 0; p_i < candidate_indices.size (); ++p_i)
-      L[i].push_back (std::make_pair (p_i, std::abs (v[p_i].dot (x.block<6, 1> (0, i)))));
-
-    // Sort in decreasing order
-    L[i].sort (sort_dot_list_function);
+    L[i].resize (nr_candidates);
+    std::iota (L[i].begin (), L[i].end (), std::size_t (0));
+    std::stable_sort (L[i].begin (), L[i].end (), [&dots, i] (std::size_t a, std::size_t b)
+    {
+      return (std::abs (dots (i, a)) > std::abs (dots (i, b)));
+    });
   }
 
   // Initialize the 6 t's
-  std::vector<double> t (6, 0.0);
+  std::array<double, 6> t;
+  t.fill (0.0);
+  std::array<std::size_t, 6> next;
+  next.fill (0);
 
   sampled_indices.resize (num_samples_);
-  std::vector<bool> point_sampled (candidate_indices.size (), false);
+  std::vector<bool> point_sampled (nr_candidates, false);
   // Now select the actual points
   for (std::size_t sample_i = 0; sample_i < num_samples_; ++sample_i)
   {
@@ -186,24 +213,17 @@ pcl::CovarianceSampling<PointT, PointNT>::applyFilter (Indices &sampled_indices)
     }
 
     // Add the point from the top of the list corresponding to the dimension to the set of samples
-    while (point_sampled [L[min_t_i].front ().first])
-      L[min_t_i].pop_front ();
+    while (point_sampled[L[min_t_i][next[min_t_i]]])
+      ++next[min_t_i];
 
-    sampled_indices[sample_i] = L[min_t_i].front ().first;
-    point_sampled[L[min_t_i].front ().first] = true;
-    L[min_t_i].pop_front ();
+    const std::size_t p_i = L[min_t_i][next[min_t_i]++];
+    sampled_indices[sample_i] = (*indices_)[p_i];
+    point_sampled[p_i] = true;
 
     // Update the running totals
     for (std::size_t i = 0; i < 6; ++i)
-    {
-      double val = v[sampled_indices[sample_i]].dot (x.block<6, 1> (0, i));
-      t[i] += val * val;
-    }
+      t[i] += dots (i, p_i) * dots (i, p_i);
   }
-
-  // Remap the sampled_indices to the input_ cloud
-  for (auto &sampled_index : sampled_indices)
-    sampled_index = (*indices_)[candidate_indices[sampled_index]];
 }
 
 
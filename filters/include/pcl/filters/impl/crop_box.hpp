@@ -46,6 +46,9 @@
 #include <pcl/common/point_tests.h> // for isFinite
 #include <pcl/common/transforms.h> // for transformPoint
 
+#include <algorithm> // for std::fill_n
+#include <array>
+
 ///////////////////////////////////////////////////////////////////////////////
 template<typename PointT> void
 pcl::CropBox<PointT>::applyFilter (Indices &indices)
@@ -117,6 +120,69 @@ pcl::CropBox<PointT>::applyFilter (Indices &indices)
   removed_indices_->resize (removed_indices_count);
 }
 
+///////////////////////////////////////////////////////////////////////////////
+template<typename PointT> void
+pcl::CropBox<PointT>::filter (const BoxPoseVector &box_poses, std::vector<Indices> &indices)
+{
+  indices.resize (box_poses.size ());
+  for (auto &box_indices : indices)
+    box_indices.clear ();
+
+  if (!this->initCompute ())
+    return;
+
+  // Transformations from the cloud frame to the local frame of each box
+  std::vector<Eigen::Matrix<float, 3, 4>, Eigen::aligned_allocator<Eigen::Matrix<float, 3, 4> > >
+      local_transforms (box_poses.size ());
+  for (std::size_t i = 0; i < box_poses.size (); ++i)
+    local_transforms[i] = (box_poses[i].inverse () * transform_).matrix ().topRows<3> ();
+
+  // Structure of arrays copy of a block of points, small enough to stay in the L1 cache
+  // while it is tested against all boxes. The box tests of a block are independent and
+  // get vectorized by the compiler.
+  constexpr std::size_t block_size = 256;
+  std::array<float, block_size> x, y, z;
+  std::array<index_t, block_size> block_indices;
+  std::array<unsigned char, block_size> is_inside;
+  for (std::size_t begin = 0; begin < indices_->size ();)
+  {
+    std::size_t nr_points = 0;
+    for (; begin < indices_->size () && nr_points < block_size; ++begin)
+    {
+      const auto index = (*indices_)[begin];
+      const PointT &pt = (*input_)[index];
+      // Invalid points are neither inside nor outside
+      if (!input_->is_dense && !isFinite (pt))
+        continue;
+      x[nr_points] = pt.x;
+      y[nr_points] = pt.y;
+      z[nr_points] = pt.z;
+      block_indices[nr_points++] = index;
+    }
+
+    for (std::size_t i = 0; i < local_transforms.size (); ++i)
+    {
+      std::fill_n (is_inside.begin (), nr_points, 1);
+      for (Eigen::Index k = 0; k < 3; ++k)
+      {
+        const float a = local_transforms[i] (k, 0), b = local_transforms[i] (k, 1),
+                    c = local_transforms[i] (k, 2), d = local_transforms[i] (k, 3);
+        const float min = min_pt_[k], max = max_pt_[k];
+        for (std::size_t j = 0; j < nr_points; ++j)
+        {
+          const float local = x[j] * a + y[j] * b + z[j] * c + d;
+          is_inside[j] &= static_cast<unsigned char> ((local >= min) & (local <= max));
+        }
+      }
+      for (std::size_t j = 0; j < nr_points; ++j)
+        if (static_cast<bool> (is_inside[j]) ^ negative_)
+          indices[i].push_back (block_indices[j]);
+    }
+  }
+
+  this->deinitCompute ();
+}
+
 #define PCL_INSTANTIATE_CropBox(T) template class PCL_EXPORTS pcl::CropBox<T>;
 
 #endif    // PCL_FILTERS_IMPL_CROP_BOX_H_
@@ -39,6 +39,18 @@
 #define PCL_FILTERS_IMPL_CROP_HULL_H_
 
 #include <pcl/filters/crop_hull.h>
+#include <pcl/common/execution_context.h>
+
+#include <algorithm>
+#include <numeric>
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template<typename PointT> void
+pcl::CropHull<PointT>::setNumberOfThreads (unsigned int nr_threads)
+{
+  // 0 is resolved against the budget of pcl::ExecutionContext at compute time
+  threads_ = nr_threads;
+}
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 template<typename PointT> void
@@ -176,32 +188,28 @@ pcl::CropHull<PointT>::applyFilter2D (Indices &indices)
 template<typename PointT> void 
 pcl::CropHull<PointT>::applyFilter3D (PointCloud &output)
 {
-  // This algorithm could definitely be sped up using kdtree/octree
-  // information, if that is available!
+  buildBVH ();
 
-  for (std::size_t index = 0; index < indices_->size (); index++)
+  // The points are tested in parallel, the output keeps their order
+  const int nr_points = static_cast<int> (indices_->size ());
+  std::vector<unsigned char> inside (nr_points, 0);
+  if (crop_outside_)
   {
-    // test ray-crossings for three random rays, and take vote of crossings
-    // counts to determine if each point is inside the hull: the vote avoids
-    // tricky edge and corner cases when rays might fluke through the edge
-    // between two polygons
-    // 'random' rays are arbitrary - basically anything that is less likely to
-    // hit the edge between polygons than coordinate-axis aligned rays would
-    // be.
-    std::size_t crossings[3] = {0,0,0};
-    Eigen::Vector3f rays[3] = 
-    {
-      Eigen::Vector3f (0.264882f,  0.688399f, 0.675237f),
-      Eigen::Vector3f (0.0145419f, 0.732901f, 0.68018f),
-      Eigen::Vector3f (0.856514f,  0.508771f, 0.0868081f)
-    };
-
-    for (std::size_t poly = 0; poly < hull_polygons_.size (); poly++)
-      for (std::size_t ray = 0; ray < 3; ray++)
-        crossings[ray] += rayTriangleIntersect
-          ((*input_)[(*indices_)[index]], rays[ray], hull_polygons_[poly], *hull_cloud_);
+    const pcl::ThreadReservation reservation (threads_);
+    const unsigned int threads = reservation.getNumberOfThreads ();
+#pragma omp parallel for \
+  default(none) \
+  shared(inside) \
+  firstprivate(nr_points) \
+  schedule(dynamic, 256) \
+  num_threads(threads)
+    for (int index = 0; index < nr_points; index++)
+      inside[index] = isPointInHull3D ((*input_)[(*indices_)[index]]);
+  }
 
-    if (crop_outside_ && (crossings[0]&1) + (crossings[1]&1) + (crossings[2]&1) > 1)
+  for (int index = 0; index < nr_points; index++)
+  {
+    if (crop_outside_ && inside[index])
       output.push_back ((*input_)[(*indices_)[index]]);
     else if (!crop_outside_)
       output.push_back ((*input_)[(*indices_)[index]]);
@@ -213,28 +221,179 @@ template<typename PointT> void
 pcl::CropHull<PointT>::applyFilter3D (Indices &indices)
 {
   // see comments in applyFilter3D (PointCloud& output)
-  for (std::size_t index = 0; index < indices_->size (); index++)
-  {
-    std::size_t crossings[3] = {0,0,0};
-    Eigen::Vector3f rays[3] = 
-    {
-      Eigen::Vector3f(0.264882f,  0.688399f, 0.675237f),
-      Eigen::Vector3f(0.0145419f, 0.732901f, 0.68018f),
-      Eigen::Vector3f(0.856514f,  0.508771f, 0.0868081f)
-    };
+  buildBVH ();
 
-    for (std::size_t poly = 0; poly < hull_polygons_.size (); poly++)
-      for (std::size_t ray = 0; ray < 3; ray++)
-        crossings[ray] += rayTriangleIntersect
-          ((*input_)[(*indices_)[index]], rays[ray], hull_polygons_[poly], *hull_cloud_);
+  const int nr_points = static_cast<int> (indices_->size ());
+  std::vector<unsigned char> inside (nr_points, 0);
+  if (crop_outside_)
+  {
+    const pcl::ThreadReservation reservation (threads_);
+    const unsigned int threads = reservation.getNumberOfThreads ();
+#pragma omp parallel for \
+  default(none) \
+  shared(inside) \
+  firstprivate(nr_points) \
+  schedule(dynamic, 256) \
+  num_threads(threads)
+    for (int index = 0; index < nr_points; index++)
+      inside[index] = isPointInHull3D ((*input_)[(*indices_)[index]]);
+  }
 
-    if (crop_outside_ && (crossings[0]&1) + (crossings[1]&1) + (crossings[2]&1) > 1)
+  for (int index = 0; index < nr_points; index++)
+  {
+    if (crop_outside_ && inside[index])
       indices.push_back ((*indices_)[index]);
     else if (!crop_outside_)
       indices.push_back ((*indices_)[index]);
   }
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template<typename PointT> bool
+pcl::CropHull<PointT>::isPointInHull3D (const PointT& point) const
+{
+  // test ray-crossings for three random rays, and take vote of crossings
+  // counts to determine if each point is inside the hull: the vote avoids
+  // tricky edge and corner cases when rays might fluke through the edge
+  // between two polygons
+  // 'random' rays are arbitrary - basically anything that is less likely to
+  // hit the edge between polygons than coordinate-axis aligned rays would
+  // be.
+  static const Eigen::Vector3f rays[3] =
+  {
+    Eigen::Vector3f (0.264882f,  0.688399f, 0.675237f),
+    Eigen::Vector3f (0.0145419f, 0.732901f, 0.68018f),
+    Eigen::Vector3f (0.856514f,  0.508771f, 0.0868081f)
+  };
+
+  std::size_t votes = 0;
+  for (const auto &ray : rays)
+    votes += countRayCrossings (point, ray) & 1;
+  return (votes > 1);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template<typename PointT> void
+pcl::CropHull<PointT>::buildBVH ()
+{
+  const std::size_t nr_polygons = hull_polygons_.size ();
+  bvh_nodes_.clear ();
+  bvh_polygons_.resize (nr_polygons);
+  std::iota (bvh_polygons_.begin (), bvh_polygons_.end (), 0);
+  if (nr_polygons == 0)
+    return;
+
+  // Bounding box and center of every polygon
+  std::vector<Eigen::Vector3f> poly_min (nr_polygons), poly_max (nr_polygons), poly_center (nr_polygons);
+  Eigen::Vector3f hull_min = Eigen::Vector3f::Constant (std::numeric_limits<float>::max ());
+  Eigen::Vector3f hull_max = Eigen::Vector3f::Constant (-std::numeric_limits<float>::max ());
+  for (std::size_t poly = 0; poly < nr_polygons; ++poly)
+  {
+    poly_min[poly] = Eigen::Vector3f::Constant (std::numeric_limits<float>::max ());
+    poly_max[poly] = Eigen::Vector3f::Constant (-std::numeric_limits<float>::max ());
+    for (const auto &idx : hull_polygons_[poly].vertices)
+    {
+      const Eigen::Vector3f pt = (*hull_cloud_)[idx].getVector3fMap ();
+      poly_min[poly] = poly_min[poly].cwiseMin (pt);
+      poly_max[poly] = poly_max[poly].cwiseMax (pt);
+    }
+    poly_center[poly] = 0.5f * (poly_min[poly] + poly_max[poly]);
+    hull_min = hull_min.cwiseMin (poly_min[poly]);
+    hull_max = hull_max.cwiseMax (poly_max[poly]);
+  }
+
+  // Grow the boxes a little, so that a crossing found by rayTriangleIntersect
+  // despite rounding is never culled by the box test
+  const float padding = 1e-5f * std::max (hull_min.cwiseAbs ().maxCoeff (), hull_max.cwiseAbs ().maxCoeff ()) + 1e-6f;
+
+  // Top-down construction, splitting the polygons at the median of the longest axis of their centers
+  const std::size_t max_leaf_size = 4;
+  struct Range { std::size_t node, begin, end; };
+  std::vector<Range> stack {{0, 0, nr_polygons}};
+  bvh_nodes_.reserve (2 * nr_polygons);
+  bvh_nodes_.emplace_back ();
+  while (!stack.empty ())
+  {
+    const Range range = stack.back ();
+    stack.pop_back ();
+
+    Eigen::Vector3f min_pt = Eigen::Vector3f::Constant (std::numeric_limits<float>::max ());
+    Eigen::Vector3f max_pt = Eigen::Vector3f::Constant (-std::numeric_limits<float>::max ());
+    Eigen::Vector3f center_min = min_pt, center_max = max_pt;
+    for (std::size_t i = range.begin; i < range.end; ++i)
+    {
+      const std::size_t poly = bvh_polygons_[i];
+      min_pt = min_pt.cwiseMin (poly_min[poly]);
+      max_pt = max_pt.cwiseMax (poly_max[poly]);
+      center_min = center_min.cwiseMin (poly_center[poly]);
+      center_max = center_max.cwiseMax (poly_center[poly]);
+    }
+    bvh_nodes_[range.node].min_pt = min_pt - Eigen::Vector3f::Constant (padding);
+    bvh_nodes_[range.node].max_pt = max_pt + Eigen::Vector3f::Constant (padding);
+
+    if (range.end - range.begin <= max_leaf_size)
+    {
+      bvh_nodes_[range.node].offset = range.begin;
+      bvh_nodes_[range.node].count = range.end - range.begin;
+      continue;
+    }
+
+    int axis;
+    (center_max - center_min).maxCoeff (&axis);
+    const std::size_t middle = (range.begin + range.end) / 2;
+    std::nth_element (bvh_polygons_.begin () + range.begin, bvh_polygons_.begin () + middle, bvh_polygons_.begin () + range.end,
+                      [&poly_center, axis] (std::size_t a, std::size_t b) { return (poly_center[a][axis] < poly_center[b][axis]); });
+
+    const std::size_t first_child = bvh_nodes_.size ();
+    bvh_nodes_.emplace_back ();
+    bvh_nodes_.emplace_back ();
+    bvh_nodes_[range.node].offset = first_child;
+    bvh_nodes_[range.node].count = 0;
+    stack.push_back ({first_child + 1, middle, range.end});
+    stack.push_back ({first_child, range.begin, middle});
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template<typename PointT> std::size_t
+pcl::CropHull<PointT>::countRayCrossings (const PointT& point, const Eigen::Vector3f& ray) const
+{
+  if (bvh_nodes_.empty ())
+    return (0);
+
+  const Eigen::Vector3f origin = point.getVector3fMap ();
+  const Eigen::Vector3f inv_ray = ray.cwiseInverse ();
+
+  std::size_t crossings = 0;
+  std::size_t stack[64];
+  std::size_t stack_size = 0;
+  stack[stack_size++] = 0;
+  while (stack_size > 0)
+  {
+    const BVHNode &node = bvh_nodes_[stack[--stack_size]];
+
+    // Slab test of the ray (r >= 0) against the box of the node
+    const Eigen::Vector3f t0 = (node.min_pt - origin).cwiseProduct (inv_ray);
+    const Eigen::Vector3f t1 = (node.max_pt - origin).cwiseProduct (inv_ray);
+    const float t_enter = std::max (t0.cwiseMin (t1).maxCoeff (), 0.0f);
+    const float t_exit = t0.cwiseMax (t1).minCoeff ();
+    if (!(t_enter <= t_exit))
+      continue;
+
+    if (node.count > 0)
+    {
+      for (std::size_t i = node.offset; i < node.offset + node.count; ++i)
+        crossings += rayTriangleIntersect (point, ray, hull_polygons_[bvh_polygons_[i]], *hull_cloud_);
+    }
+    else
+    {
+      stack[stack_size++] = node.offset;
+      stack[stack_size++] = node.offset + 1;
+    }
+  }
+  return (crossings);
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 template<typename PointT> template<unsigned PlaneDim1, unsigned PlaneDim2> bool
 pcl::CropHull<PointT>::isPointIn2DPolyWithVertIndices (
@@ -41,7 +41,6 @@
 #define PCL_FILTERS_IMPL_EXTRACT_INDICES_HPP_
 
 #include <pcl/filters/extract_indices.h>
-#include <numeric> // for std::iota
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointT> void
@@ -129,34 +128,14 @@ pcl::ExtractIndices<PointT>::applyFilterIndices (Indices &indices)
   {
     indices = *indices_;
 
+    // Store the difference in removed_indices
     if (extract_removed_indices_)
-    {
-      // Set up the full indices set
-      Indices full_indices (input_->size ());
-      std::iota (full_indices.begin (), full_indices.end (), static_cast<index_t> (0));
-
-      // Set up the sorted input indices
-      Indices sorted_input_indices = *indices_;
-      std::sort (sorted_input_indices.begin (), sorted_input_indices.end ());
-
-      // Store the difference in removed_indices
-      removed_indices_->clear ();
-      set_difference (full_indices.begin (), full_indices.end (), sorted_input_indices.begin (), sorted_input_indices.end (), inserter (*removed_indices_, removed_indices_->begin ()));
-    }
+      detail::complementIndices (*indices_, input_->size (), *removed_indices_);
   }
   else  // Inverted functionality
   {
-    // Set up the full indices set
-    Indices full_indices (input_->size ());
-    std::iota (full_indices.begin (), full_indices.end (), static_cast<index_t> (0));
-
-    // Set up the sorted input indices
-    Indices sorted_input_indices = *indices_;
-    std::sort (sorted_input_indices.begin (), sorted_input_indices.end ());
-
     // Store the difference in indices
-    indices.clear ();
-    set_difference (full_indices.begin (), full_indices.end (), sorted_input_indices.begin (), sorted_input_indices.end (), inserter (indices, indices.begin ()));
+    detail::complementIndices (*indices_, input_->size (), indices);
 
     if (extract_removed_indices_)
       removed_indices_ = indices_;
@@ -131,37 +131,66 @@ FastBilateralFilter<PointT>::applyFilter (PointCloud &output)
           Eigen::Vector2f* b_ptr = &(buffer (x,y,1));
 
           for(std::size_t z = 1; z < small_depth - 1; ++z, ++d_ptr, ++b_ptr)
-            *d_ptr = (*(b_ptr - off) + *(b_ptr + off) + 2.0 * (*b_ptr)) / 4.0;
+            *d_ptr = (*(b_ptr - off) + *(b_ptr + off) + 2.0f * (*b_ptr)) * 0.25f;
         }
     }
   }
 
   if (early_division_)
   {
-    for (std::vector<Eigen::Vector2f, Eigen::aligned_allocator<Eigen::Vector2f> >::iterator d = data.begin (); d != data.end (); ++d)
+    for (auto d = data.begin (); d != data.end (); ++d)
       *d /= ((*d)[0] != 0) ? (*d)[1] : 1;
-
-    for (std::size_t x = 0; x < input_->width; x++)
-      for (std::size_t y = 0; y < input_->height; y++)
-      {
-        const float z = output (x,y).z - base_min;
-        const Eigen::Vector2f D = data.trilinear_interpolation (static_cast<float> (x) / sigma_s_ + padding_xy,
-                                                                static_cast<float> (y) / sigma_s_ + padding_xy,
-                                                                z / sigma_r_ + padding_z);
-        output(x,y).z = D[0];
-      }
   }
-  else
+
+  SliceCoordinates coordinates;
+  computeSliceCoordinates (base_min, padding_xy, padding_z, coordinates);
+  for (std::size_t y = 0; y < input_->height; ++y)
+    sliceRow (data, coordinates, y, output);
+}
+
+
+template <typename PointT> void
+FastBilateralFilter<PointT>::computeSliceCoordinates (const float base_min,
+                                                      const std::size_t padding_xy,
+                                                      const std::size_t padding_z,
+                                                      SliceCoordinates &coordinates) const
+{
+  const auto compute = [this, padding_xy] (const std::size_t size,
+                                           std::vector<std::size_t> &indices,
+                                           std::vector<float> &alphas)
   {
-    for (std::size_t x = 0; x < input_->width; ++x)
-      for (std::size_t y = 0; y < input_->height; ++y)
-      {
-        const float z = output (x,y).z - base_min;
-        const Eigen::Vector2f D = data.trilinear_interpolation (static_cast<float> (x) / sigma_s_ + padding_xy,
-                                                                static_cast<float> (y) / sigma_s_ + padding_xy,
-                                                                z / sigma_r_ + padding_z);
-        output (x,y).z = D[0] / D[1];
-      }
+    indices.resize (size);
+    alphas.resize (size);
+    for (std::size_t i = 0; i < size; ++i)
+    {
+      const float coordinate = static_cast<float> (i) / sigma_s_ + padding_xy;
+      indices[i] = static_cast<std::size_t> (coordinate);
+      alphas[i] = coordinate - static_cast<float> (indices[i]);
+    }
+  };
+  compute (input_->width, coordinates.x_index, coordinates.x_alpha);
+  compute (input_->height, coordinates.y_index, coordinates.y_alpha);
+  coordinates.base_min = base_min;
+  coordinates.padding_z = static_cast<float> (padding_z);
+}
+
+
+template <typename PointT> void
+FastBilateralFilter<PointT>::sliceRow (const Array3D &data,
+                                       const SliceCoordinates &coordinates,
+                                       const std::size_t y,
+                                       PointCloud &output) const
+{
+  const std::size_t y_index = coordinates.y_index[y];
+  const float y_alpha = coordinates.y_alpha[y];
+  for (std::size_t x = 0; x < input_->width; ++x)
+  {
+    PointT &point = output (x,y);
+    const float z = point.z - coordinates.base_min;
+    const Eigen::Vector2f D = data.trilinear_interpolation (coordinates.x_index[x], coordinates.x_alpha[x],
+                                                            y_index, y_alpha,
+                                                            z / sigma_r_ + coordinates.padding_z);
+    point.z = early_division_ ? D[0] : D[0] / D[1];
   }
 }
 
@@ -186,7 +215,7 @@ FastBilateralFilter<PointT>::Array3D::clamp (const std::size_t min_value,
 template <typename PointT> Eigen::Vector2f
 FastBilateralFilter<PointT>::Array3D::trilinear_interpolation (const float x,
                                                                const float y,
-                                                               const float z)
+                                                               const float z) const
 {
   const std::size_t x_index  = clamp (0, x_dim_ - 1, static_cast<std::size_t> (x));
   const std::size_t xx_index = clamp (0, x_dim_ - 1, x_index + 1);
@@ -212,6 +241,34 @@ FastBilateralFilter<PointT>::Array3D::trilinear_interpolation (const float x,
       x_alpha        * y_alpha        * z_alpha        * (*this)(xx_index, yy_index, zz_index);
 }
 
+
+
+template <typename PointT> Eigen::Vector2f
+FastBilateralFilter<PointT>::Array3D::trilinear_interpolation (const std::size_t x_index,
+                                                               const float x_alpha,
+                                                               const std::size_t y_index,
+                                                               const float y_alpha,
+                                                               const float z) const
+{
+  const std::size_t z_index = static_cast<std::size_t> (z);
+  if (x_index + 1 >= x_dim_ || y_index + 1 >= y_dim_ || z_index + 1 >= z_dim_)
+    return (trilinear_interpolation (static_cast<float> (x_index) + x_alpha,
+                                     static_cast<float> (y_index) + y_alpha,
+                                     z));
+
+  // (sum, weight) at z_index and z_index + 1 of the four grid columns around the point
+  using ConstMap4f = Eigen::Map<const Eigen::Vector4f>;
+  const ConstMap4f v00 ((*this)(x_index, y_index, z_index).data ());
+  const ConstMap4f v10 ((*this)(x_index + 1, y_index, z_index).data ());
+  const ConstMap4f v01 ((*this)(x_index, y_index + 1, z_index).data ());
+  const ConstMap4f v11 ((*this)(x_index + 1, y_index + 1, z_index).data ());
+
+  const Eigen::Vector4f v = (1.0f-y_alpha) * ((1.0f-x_alpha) * v00 + x_alpha * v10) +
+                            y_alpha        * ((1.0f-x_alpha) * v01 + x_alpha * v11);
+  const float z_alpha = z - static_cast<float> (z_index);
+  return ((1.0f-z_alpha) * v.head<2> () + z_alpha * v.tail<2> ());
+}
+
 } // namespace pcl
 
 #endif /* PCL_FILTERS_IMPL_FAST_BILATERAL_HPP_ */
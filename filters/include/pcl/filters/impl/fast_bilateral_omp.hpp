@@ -41,20 +41,15 @@
 #define PCL_FILTERS_IMPL_FAST_BILATERAL_OMP_HPP_
 
 #include <pcl/filters/fast_bilateral_omp.h>
+#include <pcl/common/execution_context.h>
 #include <pcl/common/io.h>
 
 //////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointT> void
 pcl::FastBilateralFilterOMP<PointT>::setNumberOfThreads (unsigned int nr_threads)
 {
-  if (nr_threads == 0)
-#ifdef _OPENMP
-    threads_ = omp_get_num_procs();
-#else
-    threads_ = 1;
-#endif
-  else
-    threads_ = nr_threads;
+  // 0 is resolved against the budget of pcl::ExecutionContext at compute time
+  threads_ = nr_threads;
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////
@@ -67,6 +62,8 @@ pcl::FastBilateralFilterOMP<PointT>::applyFilter (PointCloud &output)
     return;
   }
 
+  const pcl::ThreadReservation reservation (threads_);
+  const unsigned int threads = reservation.getNumberOfThreads ();
   copyPointCloud (*input_, output);
   float base_max = -std::numeric_limits<float>::max (),
         base_min = std::numeric_limits<float>::max ();
@@ -88,7 +85,7 @@ pcl::FastBilateralFilterOMP<PointT>::applyFilter (PointCloud &output)
 #pragma omp parallel for \
   default(none) \
   shared(base_min, base_max, output) \
-  num_threads(threads_)
+  num_threads(threads)
   for (long int i = 0; i < static_cast<long int> (output.size ()); ++i)
     if (!std::isfinite (output.at(i).z))
       output.at(i).z = base_max;
@@ -107,12 +104,12 @@ pcl::FastBilateralFilterOMP<PointT>::applyFilter (PointCloud &output)
 #pragma omp parallel for \
   default(none) \
   shared(base_min, data, output) \
-  num_threads(threads_)
+  num_threads(threads)
 #else
 #pragma omp parallel for \
   default(none) \
   shared(base_min, data, output, small_height, small_width) \
-  num_threads(threads_)	
+  num_threads(threads)	
 #endif
   for (long int i = 0; i < static_cast<long int> (small_width * small_height); ++i)
   {
@@ -156,12 +153,12 @@ pcl::FastBilateralFilterOMP<PointT>::applyFilter (PointCloud &output)
 #pragma omp parallel for \
   default(none) \
   shared(current_buffer, current_data, dim, offset) \
-  num_threads(threads_)
+  num_threads(threads)
 #else
 #pragma omp parallel for \
   default(none) \
   shared(current_buffer, current_data, dim, offset, small_depth, small_height, small_width) \
-  num_threads(threads_)
+  num_threads(threads)
 #endif
       for(long int i = 0; i < static_cast<long int> ((small_width - 2)*(small_height - 2)); ++i)
       {
@@ -172,7 +169,7 @@ pcl::FastBilateralFilterOMP<PointT>::applyFilter (PointCloud &output)
         Eigen::Vector2f* b_ptr = &(current_buffer->operator() (x,y,1));
 
         for(std::size_t z = 1; z < small_depth - 1; ++z, ++d_ptr, ++b_ptr)
-          *d_ptr = (*(b_ptr - off) + *(b_ptr + off) + 2.0 * (*b_ptr)) / 4.0;
+          *d_ptr = (*(b_ptr - off) + *(b_ptr + off) + 2.0f * (*b_ptr)) * 0.25f;
       }
     }
   }
@@ -182,41 +179,26 @@ pcl::FastBilateralFilterOMP<PointT>::applyFilter (PointCloud &output)
 
   if (early_division_)
   {
-    for (std::vector<Eigen::Vector2f, Eigen::aligned_allocator<Eigen::Vector2f> >::iterator d = data.begin (); d != data.end (); ++d)
-      *d /= ((*d)[0] != 0) ? (*d)[1] : 1;
-
 #pragma omp parallel for \
   default(none) \
-  shared(base_min, data, output) \
-  num_threads(threads_)
-    for (long int i = 0; i < static_cast<long int> (input_->size ()); ++i)
+  shared(data) \
+  num_threads(threads)
+    for (long int i = 0; i < static_cast<long int> (data.end () - data.begin ()); ++i)
     {
-      std::size_t x = static_cast<std::size_t> (i % input_->width);
-      std::size_t y = static_cast<std::size_t> (i / input_->width);
-      const float z = output (x,y).z - base_min;
-      const Eigen::Vector2f D = data.trilinear_interpolation (static_cast<float> (x) / sigma_s_ + padding_xy,
-                                                              static_cast<float> (y) / sigma_s_ + padding_xy,
-                                                              z / sigma_r_ + padding_z);
-      output(x,y).z = D[0];
+      Eigen::Vector2f& d = *(data.begin () + i);
+      d /= (d[0] != 0) ? d[1] : 1;
     }
   }
-  else
-  {
+
+  // Rows are sliced concurrently, the grid coordinates of columns and rows are shared
+  typename FastBilateralFilter<PointT>::SliceCoordinates coordinates;
+  this->computeSliceCoordinates (base_min, padding_xy, padding_z, coordinates);
 #pragma omp parallel for \
   default(none) \
-  shared(base_min, data, output) \
-  num_threads(threads_)
-    for (long i = 0; i < static_cast<long int> (input_->size ()); ++i)
-    {
-      std::size_t x = static_cast<std::size_t> (i % input_->width);
-      std::size_t y = static_cast<std::size_t> (i / input_->width);
-      const float z = output (x,y).z - base_min;
-      const Eigen::Vector2f D = data.trilinear_interpolation (static_cast<float> (x) / sigma_s_ + padding_xy,
-                                                              static_cast<float> (y) / sigma_s_ + padding_xy,
-                                                              z / sigma_r_ + padding_z);
-      output (x,y).z = D[0] / D[1];
-    }
-  }
+  shared(coordinates, data, output) \
+  num_threads(threads)
+  for (long int y = 0; y < static_cast<long int> (input_->height); ++y)
+    this->sliceRow (data, coordinates, static_cast<std::size_t> (y), output);
 }
 
 
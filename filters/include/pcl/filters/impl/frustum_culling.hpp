@@ -39,11 +39,14 @@
 #define PCL_FILTERS_IMPL_FRUSTUM_CULLING_HPP_
 
 #include <pcl/filters/frustum_culling.h>
+#include <algorithm>
+#include <array>
 #include <vector>
 
 ///////////////////////////////////////////////////////////////////////////////
 template <typename PointT> void
-pcl::FrustumCulling<PointT>::applyFilter (Indices &indices)
+pcl::FrustumCulling<PointT>::computeFrustumPlanes (const Eigen::Matrix4f &camera_pose,
+                                                   Eigen::Matrix<float, 4, 6> &planes) const
 {
   Eigen::Vector4f pl_n; // near plane 
   Eigen::Vector4f pl_f; // far plane
@@ -52,10 +55,10 @@ pcl::FrustumCulling<PointT>::applyFilter (Indices &indices)
   Eigen::Vector4f pl_r; // right plane
   Eigen::Vector4f pl_l; // left plane
 
-  Eigen::Vector3f view = camera_pose_.block<3, 1> (0, 0);    // view vector for the camera  - first column of the rotation matrix
-  Eigen::Vector3f up = camera_pose_.block<3, 1> (0, 1);      // up vector for the camera    - second column of the rotation matrix
-  Eigen::Vector3f right = camera_pose_.block<3, 1> (0, 2);   // right vector for the camera - third column of the rotation matrix
-  Eigen::Vector3f T = camera_pose_.block<3, 1> (0, 3);       // The (X, Y, Z) position of the camera w.r.t origin
+  Eigen::Vector3f view = camera_pose.block<3, 1> (0, 0);    // view vector for the camera  - first column of the rotation matrix
+  Eigen::Vector3f up = camera_pose.block<3, 1> (0, 1);      // up vector for the camera    - second column of the rotation matrix
+  Eigen::Vector3f right = camera_pose.block<3, 1> (0, 2);   // right vector for the camera - third column of the rotation matrix
+  Eigen::Vector3f T = camera_pose.block<3, 1> (0, 3);       // The (X, Y, Z) position of the camera w.r.t origin
 
 
   float vfov_rad = float (vfov_ * M_PI / 180);  // degrees to radians
@@ -113,6 +116,22 @@ pcl::FrustumCulling<PointT>::applyFilter (Indices &indices)
   pl_t (3) = -T.dot (pl_t.head<3> ());
   pl_b (3) = -T.dot (pl_b.head<3> ());
 
+  planes << pl_l, pl_r, pl_t, pl_b, pl_f, pl_n;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::FrustumCulling<PointT>::applyFilter (Indices &indices)
+{
+  Eigen::Matrix<float, 4, 6> planes;
+  computeFrustumPlanes (camera_pose_, planes);
+  const Eigen::Vector4f pl_l = planes.col (0); // left plane
+  const Eigen::Vector4f pl_r = planes.col (1); // right plane
+  const Eigen::Vector4f pl_t = planes.col (2); // top plane
+  const Eigen::Vector4f pl_b = planes.col (3); // bottom plane
+  const Eigen::Vector4f pl_f = planes.col (4); // far plane
+  const Eigen::Vector4f pl_n = planes.col (5); // near plane
+
   if (extract_removed_indices_)
   {
     removed_indices_->resize (indices_->size ());
@@ -146,6 +165,58 @@ pcl::FrustumCulling<PointT>::applyFilter (Indices &indices)
   removed_indices_->resize (removed_ctr);
 }
 
+///////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::FrustumCulling<PointT>::filter (const CameraPoseVector &camera_poses,
+                                     std::vector<Indices> &indices)
+{
+  indices.resize (camera_poses.size ());
+  for (auto &frustum_indices : indices)
+    frustum_indices.clear ();
+
+  if (!this->initCompute ())
+    return;
+
+  std::vector<Eigen::Matrix<float, 4, 6>, Eigen::aligned_allocator<Eigen::Matrix<float, 4, 6> > >
+      planes (camera_poses.size ());
+  for (std::size_t i = 0; i < camera_poses.size (); ++i)
+    computeFrustumPlanes (camera_poses[i], planes[i]);
+
+  // Structure of arrays copy of a block of points, small enough to stay in the L1 cache
+  // while it is tested against all frusta. The plane tests of a block are independent
+  // and get vectorized by the compiler.
+  constexpr std::size_t block_size = 256;
+  std::array<float, block_size> x, y, z;
+  std::array<unsigned char, block_size> is_in_fov;
+  for (std::size_t begin = 0; begin < indices_->size (); begin += block_size)
+  {
+    const std::size_t nr_points = std::min (block_size, indices_->size () - begin);
+    for (std::size_t j = 0; j < nr_points; ++j)
+    {
+      const PointT &pt = (*input_)[(*indices_)[begin + j]];
+      x[j] = pt.x;
+      y[j] = pt.y;
+      z[j] = pt.z;
+    }
+
+    for (std::size_t i = 0; i < planes.size (); ++i)
+    {
+      std::fill_n (is_in_fov.begin (), nr_points, 1);
+      for (Eigen::Index k = 0; k < 6; ++k)
+      {
+        const float a = planes[i] (0, k), b = planes[i] (1, k), c = planes[i] (2, k), d = planes[i] (3, k);
+        for (std::size_t j = 0; j < nr_points; ++j)
+          is_in_fov[j] &= static_cast<unsigned char> (x[j] * a + y[j] * b + z[j] * c + d <= 0);
+      }
+      for (std::size_t j = 0; j < nr_points; ++j)
+        if (static_cast<bool> (is_in_fov[j]) ^ negative_)
+          indices[i].push_back ((*indices_)[begin + j]);
+    }
+  }
+
+  this->deinitCompute ();
+}
+
 #define PCL_INSTANTIATE_FrustumCulling(T) template class PCL_EXPORTS pcl::FrustumCulling<T>;
 
 #endif
@@ -42,6 +42,10 @@
 #include <pcl/filters/median_filter.h>
 #include <pcl/common/point_tests.h> // for pcl::isFinite
 
+#include <algorithm>
+#include <utility>
+#include <vector>
+
 template <typename PointT> void
 pcl::MedianFilter<PointT>::applyFilter (PointCloud &output)
 {
@@ -54,37 +58,120 @@ pcl::MedianFilter<PointT>::applyFilter (PointCloud &output)
   // Copy everything from the input cloud to the output cloud (takes care of all the fields)
   copyPointCloud (*input_, output);
 
-  int height = static_cast<int> (output.height);
-  int width = static_cast<int> (output.width);
+  const int height = static_cast<int> (output.height);
+  const int width = static_cast<int> (output.width);
+  const int half_window = window_size_ / 2;
+
+  // Small windows are cheaper to sort directly
+  if (window_size_ < 5)
+  {
+    for (int y = 0; y < height; ++y)
+      for (int x = 0; x < width; ++x)
+        if (pcl::isFinite ((*input_)(x, y)))
+        {
+          std::vector<float> vals;
+          vals.reserve (window_size_ * window_size_);
+          // Fill in the vector of values with the depths around the interest point
+          for (int y_dev = -window_size_/2; y_dev <= window_size_/2; ++y_dev)
+            for (int x_dev = -window_size_/2; x_dev <= window_size_/2; ++x_dev)
+            {
+              if (x + x_dev >= 0 && x + x_dev < width &&
+                  y + y_dev >= 0 && y + y_dev < height &&
+                  pcl::isFinite ((*input_)(x+x_dev, y+y_dev)))
+                vals.push_back ((*input_)(x+x_dev, y+y_dev).z);
+            }
+
+          if (vals.empty ())
+            continue;
+
+          // The output depth will be the median of all the depths in the window
+          auto middle_it = vals.begin () + vals.size () / 2;
+          std::nth_element (vals.begin (), middle_it, vals.end ());
+          float new_depth = *middle_it;
+          // Do not allow points to move more than the set max_allowed_movement_
+          if (std::abs (new_depth - (*input_)(x, y).z) < max_allowed_movement_)
+            output (x, y).z = new_depth;
+          else
+            output (x, y).z = (*input_)(x, y).z +
+                              max_allowed_movement_ * (new_depth - (*input_)(x, y).z) / std::abs (new_depth - (*input_)(x, y).z);
+        }
+    return;
+  }
+
+  // Replace the depths by their ranks, so that the window contents can be kept in a
+  // Fenwick tree over the ranks which yields the median in O(log n)
+  std::vector<std::pair<float, int> > sorted;
+  sorted.reserve (input_->size ());
+  for (std::size_t i = 0; i < input_->size (); ++i)
+    if (pcl::isFinite ((*input_)[i]))
+      sorted.emplace_back ((*input_)[i].z, static_cast<int> (i));
+  std::sort (sorted.begin (), sorted.end ());
+  const int nr_ranks = static_cast<int> (sorted.size ());
+  std::vector<int> ranks (input_->size (), -1);
+  for (int r = 0; r < nr_ranks; ++r)
+    ranks[sorted[r].second] = r;
+
+  int top_step = 1;
+  while (2 * top_step <= nr_ranks)
+    top_step *= 2;
+  std::vector<int> tree (nr_ranks + 1, 0);
+  int count = 0;
+
+  // Add (sign = 1) or remove (sign = -1) the finite points of a column of the window
+  const auto update_column = [&] (int x, int y_begin, int y_end, int sign)
+  {
+    for (int y = y_begin; y < y_end; ++y)
+    {
+      const int rank = ranks[y * width + x];
+      if (rank < 0)
+        continue;
+      for (int i = rank + 1; i <= nr_ranks; i += i & (-i))
+        tree[i] += sign;
+      count += sign;
+    }
+  };
+
   for (int y = 0; y < height; ++y)
+  {
+    const int y_begin = std::max (y - half_window, 0);
+    const int y_end = std::min (y + half_window + 1, height);
+    for (int x = 0; x < std::min (half_window, width); ++x)
+      update_column (x, y_begin, y_end, 1);
+
+    // Slide the window along the row, one column in and one column out per point
     for (int x = 0; x < width; ++x)
-      if (pcl::isFinite ((*input_)(x, y)))
-      {
-        std::vector<float> vals;
-        vals.reserve (window_size_ * window_size_);
-        // Fill in the vector of values with the depths around the interest point
-        for (int y_dev = -window_size_/2; y_dev <= window_size_/2; ++y_dev)
-          for (int x_dev = -window_size_/2; x_dev <= window_size_/2; ++x_dev)
-          {
-            if (x + x_dev >= 0 && x + x_dev < width &&
-                y + y_dev >= 0 && y + y_dev < height &&
-                pcl::isFinite ((*input_)(x+x_dev, y+y_dev)))
-              vals.push_back ((*input_)(x+x_dev, y+y_dev).z);
-          }
-
-        if (vals.empty ())
-          continue;
-
-        // The output depth will be the median of all the depths in the window
-        auto middle_it = vals.begin () + vals.size () / 2;
-        std::nth_element (vals.begin (), middle_it, vals.end ());
-        float new_depth = *middle_it;
-        // Do not allow points to move more than the set max_allowed_movement_
-        if (std::abs (new_depth - (*input_)(x, y).z) < max_allowed_movement_)
-          output (x, y).z = new_depth;
-        else
-          output (x, y).z = (*input_)(x, y).z +
-                            max_allowed_movement_ * (new_depth - (*input_)(x, y).z) / std::abs (new_depth - (*input_)(x, y).z);
-      }
-}
+    {
+      if (x + half_window < width)
+        update_column (x + half_window, y_begin, y_end, 1);
+      if (x - half_window - 1 >= 0)
+        update_column (x - half_window - 1, y_begin, y_end, -1);
 
+      if (!pcl::isFinite ((*input_)(x, y)) || count == 0)
+        continue;
+
+      // The output depth will be the median of all the depths in the window, i.e. the
+      // element count / 2 in sorted order. Descend the tree to the smallest rank with
+      // more than count / 2 depths up to and including it.
+      int rank = 0;
+      int remaining = count / 2 + 1;
+      for (int step = top_step; step > 0; step /= 2)
+        if (rank + step <= nr_ranks && tree[rank + step] < remaining)
+        {
+          rank += step;
+          remaining -= tree[rank];
+        }
+      const float new_depth = sorted[rank].first;
+
+      // Do not allow points to move more than the set max_allowed_movement_
+      if (std::abs (new_depth - (*input_)(x, y).z) < max_allowed_movement_)
+        output (x, y).z = new_depth;
+      else
+        output (x, y).z = (*input_)(x, y).z +
+                          max_allowed_movement_ * (new_depth - (*input_)(x, y).z) / std::abs (new_depth - (*input_)(x, y).z);
+    }
+
+    // Empty the tree for the next row
+    for (int x = std::max (width - half_window - 1, 0); x < width; ++x)
+      update_column (x, y_begin, y_end, -1);
+  }
+}
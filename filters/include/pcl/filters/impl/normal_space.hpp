@@ -39,9 +39,18 @@
 #define PCL_FILTERS_IMPL_NORMAL_SPACE_SAMPLE_H_
 
 #include <pcl/filters/normal_space.h>
+#include <pcl/common/execution_context.h>
 
+#include <numeric> // for std::partial_sum
 #include <vector>
-#include <list>
+
+///////////////////////////////////////////////////////////////////////////////
+template<typename PointT, typename NormalT> void
+pcl::NormalSpaceSampling<PointT, NormalT>::setNumberOfThreads (unsigned int nr_threads)
+{
+  // 0 is resolved against the budget of pcl::ExecutionContext at compute time
+  threads_ = nr_threads;
+}
 
 ///////////////////////////////////////////////////////////////////////////////
 template<typename PointT, typename NormalT> bool
@@ -62,23 +71,9 @@ pcl::NormalSpaceSampling<PointT, NormalT>::initCompute ()
   return (true);
 }
 
-///////////////////////////////////////////////////////////////////////////////
-template<typename PointT, typename NormalT> bool 
-pcl::NormalSpaceSampling<PointT, NormalT>::isEntireBinSampled (boost::dynamic_bitset<> &array,
-                                                               unsigned int start_index,
-                                                               unsigned int length)
-{
-  bool status = true;
-  for (unsigned int i = start_index; i < start_index + length; i++)
-  {
-    status &= array.test (i);
-  }
-  return status;
-}
-
 ///////////////////////////////////////////////////////////////////////////////
 template<typename PointT, typename NormalT> unsigned int 
-pcl::NormalSpaceSampling<PointT, NormalT>::findBin (const float *normal)
+pcl::NormalSpaceSampling<PointT, NormalT>::findBin (const float *normal) const
 {
   const unsigned ix = static_cast<unsigned> (std::round (0.5f * (binsx_ - 1.f) * (normal[0] + 1.f)));
   const unsigned iy = static_cast<unsigned> (std::round (0.5f * (binsy_ - 1.f) * (normal[1] + 1.f)));
@@ -96,83 +91,67 @@ pcl::NormalSpaceSampling<PointT, NormalT>::applyFilter (Indices &indices)
     return;
   }
 
-  unsigned int max_values = (std::min) (sample_, static_cast<unsigned int> (input_normals_->size ()));
+  const unsigned int max_values = (std::min) (sample_, static_cast<unsigned int> (indices_->size ()));
   // Resize output indices to sample size
   indices.resize (max_values);
   removed_indices_->resize (max_values);
   
-  // Allocate memory for the histogram of normals. Normals will then be sampled from each bin.
-  unsigned int n_bins = binsx_ * binsy_ * binsz_;
-  // list<int> holds the indices of points in that bin. Using list to avoid repeated resizing of vectors.
-  // Helps when the point cloud is large.
-  std::vector<std::list <int> > normals_hg;
-  normals_hg.reserve (n_bins);
-  for (unsigned int i = 0; i < n_bins; i++)
-    normals_hg.emplace_back();
-
-  for (const auto index : *indices_)
+  // Bin of every point, the normals are binned concurrently
+  const unsigned int n_bins = binsx_ * binsy_ * binsz_;
+  const std::size_t nr_points = indices_->size ();
+  std::vector<unsigned int> point_bins (nr_points);
+  const pcl::ThreadReservation reservation (threads_);
+  unsigned int threads = reservation.getNumberOfThreads ();
+#pragma omp parallel for \
+  default(none) \
+  shared(point_bins) \
+  firstprivate(nr_points) \
+  num_threads(threads)
+  for (std::ptrdiff_t i = 0; i < static_cast<std::ptrdiff_t> (nr_points); ++i)
+    point_bins[i] = findBin ((*input_normals_)[(*indices_)[i]].normal);
+
+  // Histogram of normals in a flat layout: the points of bin j are
+  // bin_points[start_index[j]] to bin_points[start_index[j + 1] - 1], in input order
+  std::vector<std::size_t> start_index (n_bins + 1, 0);
+  for (const auto bin : point_bins)
+    ++start_index[bin + 1];
+  std::partial_sum (start_index.begin (), start_index.end (), start_index.begin ());
+  Indices bin_points (nr_points);
   {
-    unsigned int bin_number = findBin ((*input_normals_)[index].normal);
-    normals_hg[bin_number].push_back (index);
-  }
-
-
-  // Setting up random access for the list created above. Maintaining the iterators to individual elements of the list
-  // in a vector. Using vector now as the size of the list is known.
-  std::vector<std::vector<std::list<int>::iterator> > random_access (normals_hg.size ());
-  for (std::size_t i = 0; i < normals_hg.size (); i++)
-  {
-    random_access.emplace_back();
-    random_access[i].resize (normals_hg[i].size ());
-
-    std::size_t j = 0;
-    for (std::list<int>::iterator itr = normals_hg[i].begin (); itr != normals_hg[i].end (); ++itr, ++j)
-      random_access[i][j] = itr;
-  }
-  std::vector<std::size_t> start_index (normals_hg.size ());
-  start_index[0] = 0;
-  std::size_t prev_index = 0;
-  for (std::size_t i = 1; i < normals_hg.size (); i++)
-  {
-    start_index[i] = prev_index + normals_hg[i-1].size ();
-    prev_index = start_index[i];
+    std::vector<std::size_t> bin_end (start_index.begin (), start_index.end () - 1);
+    for (std::size_t i = 0; i < nr_points; ++i)
+      bin_points[bin_end[point_bins[i]]++] = (*indices_)[i];
   }
 
   // Maintaining flags to check if a point is sampled
-  boost::dynamic_bitset<> is_sampled_flag (input_normals_->size ());
-  // Maintaining flags to check if all points in the bin are sampled
-  boost::dynamic_bitset<> bin_empty_flag (normals_hg.size ());
+  boost::dynamic_bitset<> is_sampled_flag (nr_points);
+  // Number of sampled points of every bin, a bin is exhausted once all its points are sampled
+  std::vector<unsigned int> nr_sampled (n_bins, 0);
   unsigned int i = 0;
-  while (i < sample_)
+  while (i < max_values)
   {
     // Iterating through every bin and picking one point at random, until the required number of points are sampled.
-    for (std::size_t j = 0; j < normals_hg.size (); j++)
+    for (std::size_t j = 0; j < n_bins; j++)
     {
-      unsigned int M = static_cast<unsigned int> (normals_hg[j].size ());
-      if (M == 0 || bin_empty_flag.test (j)) // bin_empty_flag(i) is set if all points in that bin are sampled..
+      const unsigned int M = static_cast<unsigned int> (start_index[j + 1] - start_index[j]);
+      if (nr_sampled[j] == M)
         continue;
 
-      unsigned int pos = 0;
-      unsigned int random_index = 0;
+      std::size_t pos = 0;
       std::uniform_int_distribution<unsigned> rng_uniform_distribution (0u, M - 1u);
 
       // Picking up a sample at random from jth bin
       do
       {
-        random_index = rng_uniform_distribution (rng_);
-        pos = start_index[j] + random_index;
+        pos = start_index[j] + rng_uniform_distribution (rng_);
       } while (is_sampled_flag.test (pos));
 
-      is_sampled_flag.flip (start_index[j] + random_index);
-
-      // Checking if all points in bin j are sampled.
-      if (isEntireBinSampled (is_sampled_flag, start_index[j], static_cast<unsigned int> (normals_hg[j].size ()))) 
-        bin_empty_flag.flip (j);
+      is_sampled_flag.set (pos);
+      ++nr_sampled[j];
 
-      unsigned int index = *(random_access[j][random_index]);
-      indices[i] = index;
+      indices[i] = bin_points[pos];
       i++;
-      if (i == sample_)
+      if (i == max_values)
         break;
     }
   }
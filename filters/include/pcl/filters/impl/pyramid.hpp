@@ -41,6 +41,7 @@
 #ifndef PCL_FILTERS_IMPL_PYRAMID_HPP
 #define PCL_FILTERS_IMPL_PYRAMID_HPP
 
+#include <pcl/common/execution_context.h>
 
 namespace pcl
 {
@@ -97,6 +98,8 @@ Pyramid<PointT>::initCompute ()
 template <typename PointT> void
 Pyramid<PointT>::compute (std::vector<PointCloudPtr>& output)
 {
+  const pcl::ThreadReservation reservation (threads_);
+  const unsigned int threads = reservation.getNumberOfThreads ();
   std::cout << "compute" << std::endl;
   if (!initCompute ())
   {
@@ -123,7 +126,7 @@ Pyramid<PointT>::compute (std::vector<PointCloudPtr>& output)
 #pragma omp parallel for \
   default(none)          \
   shared(next)           \
-  num_threads(threads_)
+  num_threads(threads)
       for(int i=0; i < next.height; ++i)
       {
         for(int j=0; j < next.width; ++j)
@@ -159,7 +162,7 @@ Pyramid<PointT>::compute (std::vector<PointCloudPtr>& output)
 #pragma omp parallel for \
   default(none)          \
   shared(next)           \
-  num_threads(threads_)
+  num_threads(threads)
       for(int i=0; i < next.height; ++i)
       {
         for(int j=0; j < next.width; ++j)
@@ -203,6 +206,8 @@ Pyramid<PointT>::compute (std::vector<PointCloudPtr>& output)
 template <> void
 Pyramid<pcl::PointXYZRGB>::compute (std::vector<Pyramid<pcl::PointXYZRGB>::PointCloudPtr> &output)
 {
+  const pcl::ThreadReservation reservation (threads_);
+  const unsigned int threads = reservation.getNumberOfThreads ();
   std::cout << "PointXYZRGB" << std::endl;
   if (!initCompute ())
   {
@@ -229,7 +234,7 @@ Pyramid<pcl::PointXYZRGB>::compute (std::vector<Pyramid<pcl::PointXYZRGB>::Point
 #pragma omp parallel for \
   default(none)          \
   shared(next)           \
-  num_threads(threads_)
+  num_threads(threads)
       for(int i=0; i < next.height; ++i)              // rows
       {
         for(int j=0; j < next.width; ++j)          // columns
@@ -275,7 +280,7 @@ Pyramid<pcl::PointXYZRGB>::compute (std::vector<Pyramid<pcl::PointXYZRGB>::Point
 #pragma omp parallel for \
   default(none)          \
   shared(next)           \
-  num_threads(threads_)
+  num_threads(threads)
       for(int i=0; i < next.height; ++i)
       {
         for(int j=0; j < next.width; ++j)
@@ -328,6 +333,8 @@ Pyramid<pcl::PointXYZRGB>::compute (std::vector<Pyramid<pcl::PointXYZRGB>::Point
 template <> void
 Pyramid<pcl::PointXYZRGBA>::compute (std::vector<Pyramid<pcl::PointXYZRGBA>::PointCloudPtr> &output)
 {
+  const pcl::ThreadReservation reservation (threads_);
+  const unsigned int threads = reservation.getNumberOfThreads ();
   std::cout << "PointXYZRGBA" << std::endl;
   if (!initCompute ())
   {
@@ -354,7 +361,7 @@ Pyramid<pcl::PointXYZRGBA>::compute (std::vector<Pyramid<pcl::PointXYZRGBA>::Poi
 #pragma omp parallel for \
   default(none)          \
   shared(next)           \
-  num_threads(threads_)
+  num_threads(threads)
       for(int i=0; i < next.height; ++i)              // rows
       {
         for(int j=0; j < next.width; ++j)          // columns
@@ -402,7 +409,7 @@ Pyramid<pcl::PointXYZRGBA>::compute (std::vector<Pyramid<pcl::PointXYZRGBA>::Poi
 #pragma omp parallel for \
   default(none)          \
   shared(next)           \
-  num_threads(threads_)
+  num_threads(threads)
       for(int i=0; i < next.height; ++i)
       {
         for(int j=0; j < next.width; ++j)
@@ -463,6 +470,8 @@ Pyramid<pcl::RGB>::nullify (pcl::RGB& p)
 template <> void
 Pyramid<pcl::RGB>::compute (std::vector<Pyramid<pcl::RGB>::PointCloudPtr> &output)
 {
+  const pcl::ThreadReservation reservation (threads_);
+  const unsigned int threads = reservation.getNumberOfThreads ();
   std::cout << "RGB" << std::endl;
   if (!initCompute ())
   {
@@ -489,7 +498,7 @@ Pyramid<pcl::RGB>::compute (std::vector<Pyramid<pcl::RGB>::PointCloudPtr> &outpu
 #pragma omp parallel for \
   default(none)          \
   shared(next)           \
-  num_threads(threads_)
+  num_threads(threads)
       for(int i=0; i < next.height; ++i)
       {
         for(int j=0; j < next.width; ++j)
@@ -529,7 +538,7 @@ Pyramid<pcl::RGB>::compute (std::vector<Pyramid<pcl::RGB>::PointCloudPtr> &outpu
 #pragma omp parallel for \
   default(none)          \
   shared(next)           \
-  num_threads(threads_)
+  num_threads(threads)
       for(int i=0; i < next.height; ++i)
       {
         for(int j=0; j < next.width; ++j)
@@ -41,9 +41,19 @@
 #define PCL_FILTERS_IMPL_RADIUS_OUTLIER_REMOVAL_H_
 
 #include <pcl/filters/radius_outlier_removal.h>
+#include <pcl/common/execution_context.h>
+#include <pcl/common/point_tests.h> // for isXYZFinite
 #include <pcl/search/organized.h> // for OrganizedNeighbor
 #include <pcl/search/kdtree.h> // for KdTree
 
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::RadiusOutlierRemoval<PointT>::setNumberOfThreads (unsigned int nr_threads)
+{
+  // 0 is resolved against the budget of pcl::ExecutionContext at compute time
+  threads_ = nr_threads;
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointT> void
 pcl::RadiusOutlierRemoval<PointT>::applyFilterIndices (Indices &indices)
@@ -67,27 +77,42 @@ pcl::RadiusOutlierRemoval<PointT>::applyFilterIndices (Indices &indices)
   searcher_->setInputCloud (input_);
 
   // The arrays to be used
-  Indices nn_indices (indices_->size ());
-  std::vector<float> nn_dists (indices_->size ());
+  const int nr_points = static_cast<int> (indices_->size ());
+  std::vector<unsigned char> inliers (nr_points, 0);
   indices.resize (indices_->size ());
   removed_indices_->resize (indices_->size ());
   int oii = 0, rii = 0;  // oii = output indices iterator, rii = removed indices iterator
 
-  // If the data is dense => use nearest-k search
-  if (input_->is_dense)
+  // Note: k includes the query point, so is always at least 1
+  const int mean_k = min_pts_radius_ + 1;
+  const double nn_dists_max = search_radius_ * search_radius_;
+  const bool dense = input_->is_dense;
+
+  const pcl::ThreadReservation reservation (threads_);
+  const unsigned int threads = reservation.getNumberOfThreads ();
+  // The points are classified in parallel, the output keeps the input order
+#pragma omp parallel \
+  default(none) \
+  shared(inliers) \
+  firstprivate(nr_points, mean_k, nn_dists_max, dense) \
+  num_threads(threads)
   {
-    // Note: k includes the query point, so is always at least 1
-    int mean_k = min_pts_radius_ + 1;
-    double nn_dists_max = search_radius_ * search_radius_;
+  Indices nn_indices;
+  std::vector<float> nn_dists;
+#pragma omp for schedule(dynamic, 256)
+  for (int iii = 0; iii < nr_points; ++iii)  // iii = input indices iterator
+  {
+    const auto index = (*indices_)[iii];
+    bool chk_neighbors = true;
 
-    for (const auto& index : (*indices_))
+    // If the data is dense => use nearest-k search
+    if (dense)
     {
       // Perform the nearest-k search
       int k = searcher_->nearestKSearch (index, mean_k, nn_indices, nn_dists);
 
       // Check the number of neighbors
       // Note: nn_dists is sorted, so check the last item
-      bool chk_neighbors = true;
       if (k == mean_k)
       {
         if (negative_)
@@ -114,41 +139,36 @@ pcl::RadiusOutlierRemoval<PointT>::applyFilterIndices (Indices &indices)
         else
           chk_neighbors = false;
       }
-
-      // Points having too few neighbors are outliers and are passed to removed indices
-      // Unless negative was set, then it's the opposite condition
-      if (!chk_neighbors)
-      {
-        if (extract_removed_indices_)
-          (*removed_indices_)[rii++] = index;
-        continue;
-      }
-
-      // Otherwise it was a normal point for output (inlier)
-      indices[oii++] = index;
     }
+    // NaN or Inf values could exist => use radius search
+    else
+    {
+      // Perform the radius search, stopping as soon as enough neighbors have been found
+      // to decide (the query point is found as well). Invalid points have no neighbors.
+      int k = 0;
+      if (pcl::isXYZFinite ((*input_)[index]))
+        k = searcher_->radiusSearch (index, search_radius_, nn_indices, nn_dists, mean_k);
+
+      // Points having too few neighbors are outliers
+      chk_neighbors = !((!negative_ && k <= min_pts_radius_) || (negative_ && k > min_pts_radius_));
+    }
+    inliers[iii] = chk_neighbors;
   }
-  // NaN or Inf values could exist => use radius search
-  else
+  }
+
+  for (int iii = 0; iii < nr_points; ++iii)
   {
-    for (const auto& index : (*indices_))
+    // Points having too few neighbors are outliers and are passed to removed indices
+    // Unless negative was set, then it's the opposite condition
+    if (!inliers[iii])
     {
-      // Perform the radius search
-      // Note: k includes the query point, so is always at least 1
-      int k = searcher_->radiusSearch (index, search_radius_, nn_indices, nn_dists);
-
-      // Points having too few neighbors are outliers and are passed to removed indices
-      // Unless negative was set, then it's the opposite condition
-      if ((!negative_ && k <= min_pts_radius_) || (negative_ && k > min_pts_radius_))
-      {
-        if (extract_removed_indices_)
-          (*removed_indices_)[rii++] = index;
-        continue;
-      }
-
-      // Otherwise it was a normal point for output (inlier)
-      indices[oii++] = index;
+      if (extract_removed_indices_)
+        (*removed_indices_)[rii++] = (*indices_)[iii];
+      continue;
     }
+
+    // Otherwise it was a normal point for output (inlier)
+    indices[oii++] = (*indices_)[iii];
   }
 
   // Resize the output arrays
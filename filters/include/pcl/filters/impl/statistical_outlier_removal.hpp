@@ -41,9 +41,18 @@
 #define PCL_FILTERS_IMPL_STATISTICAL_OUTLIER_REMOVAL_H_
 
 #include <pcl/filters/statistical_outlier_removal.h>
+#include <pcl/common/execution_context.h>
 #include <pcl/search/organized.h> // for OrganizedNeighbor
 #include <pcl/search/kdtree.h> // for KdTree
 
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::StatisticalOutlierRemoval<PointT>::setNumberOfThreads (unsigned int nr_threads)
+{
+  // 0 is resolved against the budget of pcl::ExecutionContext at compute time
+  threads_ = nr_threads;
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointT> void
 pcl::StatisticalOutlierRemoval<PointT>::applyFilterIndices (Indices &indices)
@@ -59,16 +68,27 @@ pcl::StatisticalOutlierRemoval<PointT>::applyFilterIndices (Indices &indices)
   searcher_->setInputCloud (input_);
 
   // The arrays to be used
-  Indices nn_indices (mean_k_);
-  std::vector<float> nn_dists (mean_k_);
-  std::vector<float> distances (indices_->size ());
+  const int nr_points = static_cast<int> (indices_->size ());
+  std::vector<float> distances (nr_points);
   indices.resize (indices_->size ());
   removed_indices_->resize (indices_->size ());
   int oii = 0, rii = 0;  // oii = output indices iterator, rii = removed indices iterator
 
+  const pcl::ThreadReservation reservation (threads_);
+  const unsigned int threads = reservation.getNumberOfThreads ();
   // First pass: Compute the mean distances for all points with respect to their k nearest neighbors
   int valid_distances = 0;
-  for (int iii = 0; iii < static_cast<int> (indices_->size ()); ++iii)  // iii = input indices iterator
+#pragma omp parallel \
+  default(none) \
+  shared(distances) \
+  firstprivate(nr_points) \
+  reduction(+:valid_distances) \
+  num_threads(threads)
+  {
+  Indices nn_indices (mean_k_);
+  std::vector<float> nn_dists (mean_k_);
+#pragma omp for schedule(dynamic, 256)
+  for (int iii = 0; iii < nr_points; ++iii)  // iii = input indices iterator
   {
     if (!std::isfinite ((*input_)[(*indices_)[iii]].x) ||
         !std::isfinite ((*input_)[(*indices_)[iii]].y) ||
@@ -93,6 +113,9 @@ pcl::StatisticalOutlierRemoval<PointT>::applyFilterIndices (Indices &indices)
     distances[iii] = static_cast<float> (dist_sum / mean_k_);
     valid_distances++;
   }
+  }
+
+  // The statistics are accumulated in input order, so that the threshold does not depend on the number of threads
 
   // Estimate the mean and the standard deviation of the distance vector
   double sum = 0, sq_sum = 0;
@@ -109,7 +132,7 @@ pcl::StatisticalOutlierRemoval<PointT>::applyFilterIndices (Indices &indices)
   double distance_threshold = mean + std_mul_ * stddev;
 
   // Second pass: Classify the points on the computed distance threshold
-  for (int iii = 0; iii < static_cast<int> (indices_->size ()); ++iii)  // iii = input indices iterator
+  for (int iii = 0; iii < nr_points; ++iii)  // iii = input indices iterator
   {
     // Points having a too high average distance are outliers and are passed to removed indices
     // Unless negative was set, then it's the opposite condition
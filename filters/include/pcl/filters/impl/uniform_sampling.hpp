@@ -39,7 +39,22 @@
 #define PCL_FILTERS_UNIFORM_SAMPLING_IMPL_H_
 
 #include <pcl/common/common.h>
+#include <pcl/common/execution_context.h>
 #include <pcl/filters/uniform_sampling.h>
+#include <boost/sort/spreadsort/integer_sort.hpp>
+
+#include <algorithm> // for std::count
+#include <cstdint>
+#include <limits>
+#include <utility>
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::UniformSampling<PointT>::setNumberOfThreads (unsigned int nr_threads)
+{
+  // 0 is resolved against the budget of pcl::ExecutionContext at compute time
+  threads_ = nr_threads;
+}
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointT> void
@@ -73,68 +88,106 @@ pcl::UniformSampling<PointT>::applyFilter (PointCloud &output)
   div_b_ = max_b_ - min_b_ + Eigen::Vector4i::Ones ();
   div_b_[3] = 0;
 
-  // Clear the leaves
-  leaves_.clear ();
-
   // Set up the division multiplier
   divb_mul_ = Eigen::Vector4i (1, div_b_[0], div_b_[0] * div_b_[1], 0);
-
-  removed_indices_->clear();
-  // First pass: build a set of leaves with the point index closest to the leaf center
-  for (std::size_t cp = 0; cp < indices_->size (); ++cp)
+  // The linear voxel index is computed in 64 bits, so large grids do not overflow
+  const std::uint64_t div_0 = div_b_[0];
+  const std::uint64_t div_01 = div_0 * static_cast<std::uint64_t> (div_b_[1]);
+
+  // First pass: compute the voxel of every valid point. The voxels are sorted below
+  // instead of being collected in a node based hash map, which needs one allocation
+  // and cache miss per point.
+  const auto nr_points = static_cast<std::ptrdiff_t> (indices_->size ());
+  std::vector<std::pair<std::uint64_t, index_t> > voxel_points (indices_->size ());
+  std::vector<unsigned char> is_valid (indices_->size (), 1);
+  const pcl::ThreadReservation reservation (threads_);
+  unsigned int threads = reservation.getNumberOfThreads ();
+#pragma omp parallel for \
+  default(none) \
+  shared(voxel_points, is_valid) \
+  firstprivate(nr_points, div_0, div_01) \
+  num_threads(threads)
+  for (std::ptrdiff_t cp = 0; cp < nr_points; ++cp)
   {
-    if (!input_->is_dense)
+    const PointT& point = (*input_)[(*indices_)[cp]];
+    // Check if the point is invalid
+    if (!input_->is_dense &&
+        (!std::isfinite (point.x) || !std::isfinite (point.y) || !std::isfinite (point.z)))
     {
-      // Check if the point is invalid
-      if (!std::isfinite ((*input_)[(*indices_)[cp]].x) || 
-          !std::isfinite ((*input_)[(*indices_)[cp]].y) || 
-          !std::isfinite ((*input_)[(*indices_)[cp]].z))
-      {
-        if (extract_removed_indices_)
-          removed_indices_->push_back ((*indices_)[cp]);
-        continue;
-      }
-    }
-
-    Eigen::Vector4i ijk = Eigen::Vector4i::Zero ();
-    ijk[0] = static_cast<int> (std::floor ((*input_)[(*indices_)[cp]].x * inverse_leaf_size_[0]));
-    ijk[1] = static_cast<int> (std::floor ((*input_)[(*indices_)[cp]].y * inverse_leaf_size_[1]));
-    ijk[2] = static_cast<int> (std::floor ((*input_)[(*indices_)[cp]].z * inverse_leaf_size_[2]));
-
-    // Compute the leaf index
-    int idx = (ijk - min_b_).dot (divb_mul_);
-    Leaf& leaf = leaves_[idx];
-    // First time we initialize the index
-    if (leaf.idx == -1)
-    {
-      leaf.idx = (*indices_)[cp];
+      is_valid[cp] = 0;
+      voxel_points[cp] = std::make_pair (std::numeric_limits<std::uint64_t>::max (), static_cast<index_t> (cp));
       continue;
     }
 
-    // Check to see if this point is closer to the leaf center than the previous one we saved
-    float diff_cur   = ((*input_)[(*indices_)[cp]].getVector4fMap () - ijk.cast<float> ()).squaredNorm ();
-    float diff_prev  = ((*input_)[leaf.idx].getVector4fMap ()        - ijk.cast<float> ()).squaredNorm ();
+    const auto i = static_cast<std::uint64_t> (static_cast<int> (std::floor (point.x * inverse_leaf_size_[0])) - min_b_[0]);
+    const auto j = static_cast<std::uint64_t> (static_cast<int> (std::floor (point.y * inverse_leaf_size_[1])) - min_b_[1]);
+    const auto k = static_cast<std::uint64_t> (static_cast<int> (std::floor (point.z * inverse_leaf_size_[2])) - min_b_[2]);
+    voxel_points[cp] = std::make_pair (i + j * div_0 + k * div_01, static_cast<index_t> (cp));
+  }
 
-    // If current point is closer, copy its index instead
-    if (diff_cur < diff_prev)
+  // Second pass: sort by voxel, so the points of a voxel are next to each other. Invalid
+  // points end up last.
+  auto rightshift_func = [] (const std::pair<std::uint64_t, index_t> &x, const unsigned offset) { return x.first >> offset; };
+  boost::sort::spreadsort::integer_sort (voxel_points.begin (), voxel_points.end (), rightshift_func);
+
+  const auto nr_valid = static_cast<std::size_t> (std::count (is_valid.begin (), is_valid.end (), 1));
+  std::vector<std::size_t> voxel_begin;
+  for (std::size_t i = 0; i < nr_valid; ++i)
+    if (i == 0 || voxel_points[i].first != voxel_points[i - 1].first)
+      voxel_begin.push_back (i);
+  const auto nr_leaves = static_cast<std::ptrdiff_t> (voxel_begin.size ());
+  voxel_begin.push_back (nr_valid);
+
+  // Third pass: in every voxel keep the point closest to the leaf center. Ties go to the
+  // point that comes first in the indices, like when the points are visited in order.
+  leaves_.resize (nr_leaves);
+  std::vector<unsigned char> is_kept (indices_->size (), 0);
+#pragma omp parallel for \
+  default(none) \
+  shared(voxel_points, voxel_begin, is_kept) \
+  firstprivate(nr_leaves) \
+  schedule(dynamic, 256) \
+  num_threads(threads)
+  for (std::ptrdiff_t leaf_idx = 0; leaf_idx < nr_leaves; ++leaf_idx)
+  {
+    const auto squared_distance = [this] (const PointT& point)
     {
-      if (extract_removed_indices_)
-        removed_indices_->push_back (leaf.idx);
-      leaf.idx = (*indices_)[cp];
-    }
-    else
+      Eigen::Vector4i ijk = Eigen::Vector4i::Zero ();
+      ijk[0] = static_cast<int> (std::floor (point.x * inverse_leaf_size_[0]));
+      ijk[1] = static_cast<int> (std::floor (point.y * inverse_leaf_size_[1]));
+      ijk[2] = static_cast<int> (std::floor (point.z * inverse_leaf_size_[2]));
+      return ((point.getVector4fMap () - ijk.cast<float> ()).squaredNorm ());
+    };
+
+    index_t best_cp = voxel_points[voxel_begin[leaf_idx]].second;
+    float best_diff = squared_distance ((*input_)[(*indices_)[best_cp]]);
+    for (std::size_t i = voxel_begin[leaf_idx] + 1; i < voxel_begin[leaf_idx + 1]; ++i)
     {
-      if (extract_removed_indices_)
-        removed_indices_->push_back ((*indices_)[cp]);
+      const index_t cp = voxel_points[i].second;
+      const float diff = squared_distance ((*input_)[(*indices_)[cp]]);
+      if (diff < best_diff || (!(diff > best_diff) && cp < best_cp))
+      {
+        best_cp = cp;
+        best_diff = diff;
+      }
     }
+    is_kept[best_cp] = 1;
+    leaves_[leaf_idx].idx = (*indices_)[best_cp];
   }
 
-  // Second pass: go over all leaves and copy data
-  output.resize (leaves_.size ());
-  int cp = 0;
+  // The removed points in the order of the indices
+  removed_indices_->clear ();
+  if (extract_removed_indices_)
+  {
+    for (std::size_t cp = 0; cp < indices_->size (); ++cp)
+      if (!is_kept[cp])
+        removed_indices_->push_back ((*indices_)[cp]);
+  }
 
-  for (const auto& leaf : leaves_)
-    output[cp++] = (*input_)[leaf.second.idx];
+  // Fourth pass: go over all leaves and copy data
+  output.resize (leaves_.size ());
+  for (std::size_t cp = 0; cp < leaves_.size (); ++cp)
+    output[cp] = (*input_)[leaves_[cp].idx];
   output.width = output.size ();
 }
 
@@ -42,8 +42,11 @@
 #include <pcl/common/common.h>
 #include <pcl/common/io.h>
 #include <pcl/filters/voxel_grid.h>
+#include <pcl/common/execution_context.h>
 #include  <boost/sort/spreadsort/integer_sort.hpp>
 
+#include <unordered_map>
+
 ///////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointT> void
 pcl::getMinMax3D (const typename pcl::PointCloud<PointT>::ConstPtr &cloud,
@@ -199,16 +202,56 @@ pcl::getMinMax3D (const typename pcl::PointCloud<PointT>::ConstPtr &cloud,
   max_pt = max_p;
 }
 
-struct cloud_point_index_idx 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::VoxelGrid<PointT>::setNumberOfThreads (unsigned int nr_threads)
+{
+  // 0 is resolved against the budget of pcl::ExecutionContext at compute time
+  threads_ = nr_threads;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::VoxelGrid<PointT>::resetLeafLayout ()
 {
-  unsigned int idx;
+  try
+  { 
+    // Resizing won't reset old elements to -1.  If leaf_layout_ has been used previously, it needs to be re-initialized to -1
+    std::uint32_t new_layout_size = div_b_[0]*div_b_[1]*div_b_[2];
+    //This is the number of elements that need to be re-initialized to -1
+    std::uint32_t reinit_size = std::min (static_cast<unsigned int> (new_layout_size), static_cast<unsigned int> (leaf_layout_.size()));
+    for (std::uint32_t i = 0; i < reinit_size; i++)
+    {
+      leaf_layout_[i] = -1;
+    }        
+    leaf_layout_.resize (new_layout_size, -1);           
+  }
+  catch (std::bad_alloc&)
+  {
+    throw PCLException("VoxelGrid bin size is too low; impossible to allocate memory for layout", 
+      "voxel_grid.hpp", "applyFilter");	
+  }
+  catch (std::length_error&)
+  {
+    throw PCLException("VoxelGrid bin size is too low; impossible to allocate memory for layout", 
+      "voxel_grid.hpp", "applyFilter");	
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <typename IndexT>
+struct cloud_point_leaf_index
+{
+  IndexT idx;
   unsigned int cloud_point_index;
 
-  cloud_point_index_idx() = default;
-  cloud_point_index_idx (unsigned int idx_, unsigned int cloud_point_index_) : idx (idx_), cloud_point_index (cloud_point_index_) {}
-  bool operator < (const cloud_point_index_idx &p) const { return (idx < p.idx); }
+  cloud_point_leaf_index() = default;
+  cloud_point_leaf_index (IndexT idx_, unsigned int cloud_point_index_) : idx (idx_), cloud_point_index (cloud_point_index_) {}
+  bool operator < (const cloud_point_leaf_index &p) const { return (idx < p.idx); }
 };
 
+using cloud_point_index_idx = cloud_point_leaf_index<unsigned int>;
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointT> void
 pcl::VoxelGrid<PointT>::applyFilter (PointCloud &output)
@@ -238,12 +281,15 @@ pcl::VoxelGrid<PointT>::applyFilter (PointCloud &output)
   std::int64_t dy = static_cast<std::int64_t>((max_p[1] - min_p[1]) * inverse_leaf_size_[1])+1;
   std::int64_t dz = static_cast<std::int64_t>((max_p[2] - min_p[2]) * inverse_leaf_size_[2])+1;
 
-  if ((dx*dy*dz) > static_cast<std::int64_t>(std::numeric_limits<std::int32_t>::max()))
+  const double nr_leaves = static_cast<double> (dx) * static_cast<double> (dy) * static_cast<double> (dz);
+  if (nr_leaves > static_cast<double> (std::numeric_limits<std::uint64_t>::max ()))
   {
     PCL_WARN("[pcl::%s::applyFilter] Leaf size is too small for the input dataset. Integer indices would overflow.\n", getClassName().c_str());
     output = *input_;
     return;
   }
+  // Grids that 32 bit leaf indices can not address are processed with 64 bit leaf indices
+  const bool large_grid = nr_leaves > static_cast<double> (std::numeric_limits<std::int32_t>::max ());
 
   // Compute the minimum and maximum bounding box values
   min_b_[0] = static_cast<int> (std::floor (min_p[0] * inverse_leaf_size_[0]));
@@ -258,10 +304,39 @@ pcl::VoxelGrid<PointT>::applyFilter (PointCloud &output)
   div_b_[3] = 0;
 
   // Set up the division multiplier
-  divb_mul_ = Eigen::Vector4i (1, div_b_[0], div_b_[0] * div_b_[1], 0);
+  divb_mul_ = Eigen::Matrix<std::int64_t, 4, 1> (1, div_b_[0], static_cast<std::int64_t> (div_b_[0]) * div_b_[1], 0);
+
+  // The parallel and the sequential paths give the same output, so the path follows the
+  // threads the budget grants
+  const pcl::ThreadReservation reservation (threads_);
+  const unsigned int threads = reservation.getNumberOfThreads ();
+  if (large_grid)
+  {
+    if (save_leaf_layout_)
+    {
+      PCL_WARN ("[pcl::%s::applyFilter] The leaf layout can not be saved for grids with more than %d leaves.\n", getClassName ().c_str (), std::numeric_limits<std::int32_t>::max ());
+      leaf_layout_.clear ();
+    }
+    if (threads > 1)
+      applyFilterParallel<std::uint64_t> (output, false, threads);
+    else
+      applyFilterSequential<std::uint64_t> (output, false);
+  }
+  else
+  {
+    if (threads > 1)
+      applyFilterParallel<unsigned int> (output, save_leaf_layout_, threads);
+    else
+      applyFilterSequential<unsigned int> (output, save_leaf_layout_);
+  }
+}
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> template <typename IndexT> void
+pcl::VoxelGrid<PointT>::applyFilterSequential (PointCloud &output, bool save_leaf_layout)
+{
   // Storage for mapping leaf and pointcloud indexes
-  std::vector<cloud_point_index_idx> index_vector;
+  std::vector<cloud_point_leaf_index<IndexT> > index_vector;
   index_vector.reserve (indices_->size ());
 
   // If we don't want to process the entire cloud, but rather filter points far away from the viewpoint first...
@@ -306,8 +381,8 @@ pcl::VoxelGrid<PointT>::applyFilter (PointCloud &output)
       int ijk2 = static_cast<int> (std::floor ((*input_)[index].z * inverse_leaf_size_[2]) - static_cast<float> (min_b_[2]));
 
       // Compute the centroid leaf index
-      int idx = ijk0 * divb_mul_[0] + ijk1 * divb_mul_[1] + ijk2 * divb_mul_[2];
-      index_vector.emplace_back(static_cast<unsigned int> (idx), index);
+      const IndexT idx = static_cast<IndexT> (getLinearLeafIndex (ijk0, ijk1, ijk2));
+      index_vector.emplace_back(idx, index);
     }
   }
   // No distance filtering, process all data
@@ -328,14 +403,14 @@ pcl::VoxelGrid<PointT>::applyFilter (PointCloud &output)
       int ijk2 = static_cast<int> (std::floor ((*input_)[index].z * inverse_leaf_size_[2]) - static_cast<float> (min_b_[2]));
 
       // Compute the centroid leaf index
-      int idx = ijk0 * divb_mul_[0] + ijk1 * divb_mul_[1] + ijk2 * divb_mul_[2];
-      index_vector.emplace_back(static_cast<unsigned int> (idx), index);
+      const IndexT idx = static_cast<IndexT> (getLinearLeafIndex (ijk0, ijk1, ijk2));
+      index_vector.emplace_back(idx, index);
     }
   }
 
   // Second pass: sort the index_vector vector using value representing target cell as index
   // in effect all points belonging to the same output cell will be next to each other
-  auto rightshift_func = [](const cloud_point_index_idx &x, const unsigned offset) { return x.idx >> offset; };
+  auto rightshift_func = [](const cloud_point_leaf_index<IndexT> &x, const unsigned offset) { return x.idx >> offset; };
   boost::sort::spreadsort::integer_sort(index_vector.begin(), index_vector.end(), rightshift_func);
   
   // Third pass: count output cells
@@ -363,31 +438,8 @@ pcl::VoxelGrid<PointT>::applyFilter (PointCloud &output)
 
   // Fourth pass: compute centroids, insert them into their final position
   output.resize (total);
-  if (save_leaf_layout_)
-  {
-    try
-    { 
-      // Resizing won't reset old elements to -1.  If leaf_layout_ has been used previously, it needs to be re-initialized to -1
-      std::uint32_t new_layout_size = div_b_[0]*div_b_[1]*div_b_[2];
-      //This is the number of elements that need to be re-initialized to -1
-      std::uint32_t reinit_size = std::min (static_cast<unsigned int> (new_layout_size), static_cast<unsigned int> (leaf_layout_.size()));
-      for (std::uint32_t i = 0; i < reinit_size; i++)
-      {
-        leaf_layout_[i] = -1;
-      }        
-      leaf_layout_.resize (new_layout_size, -1);           
-    }
-    catch (std::bad_alloc&)
-    {
-      throw PCLException("VoxelGrid bin size is too low; impossible to allocate memory for layout", 
-        "voxel_grid.hpp", "applyFilter");	
-    }
-    catch (std::length_error&)
-    {
-      throw PCLException("VoxelGrid bin size is too low; impossible to allocate memory for layout", 
-        "voxel_grid.hpp", "applyFilter");	
-    }
-  }
+  if (save_leaf_layout)
+    resetLeafLayout ();
   
   index = 0;
   for (const auto &cp : first_and_last_indices_vector)
@@ -397,7 +449,7 @@ pcl::VoxelGrid<PointT>::applyFilter (PointCloud &output)
   	unsigned int last_index = cp.second;
 
     // index is centroid final position in resulting PointCloud
-    if (save_leaf_layout_)
+    if (save_leaf_layout)
       leaf_layout_[index_vector[first_index].idx] = index;
 
     //Limit downsampling to coords
@@ -427,6 +479,193 @@ pcl::VoxelGrid<PointT>::applyFilter (PointCloud &output)
   output.width = output.size ();
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> template <typename IndexT> void
+pcl::VoxelGrid<PointT>::applyFilterParallel (PointCloud &output, bool save_leaf_layout, unsigned int threads)
+{
+  IndexT invalid_leaf = std::numeric_limits<IndexT>::max ();
+  unsigned int invalid_position = std::numeric_limits<unsigned int>::max ();
+  std::ptrdiff_t nr_indices = static_cast<std::ptrdiff_t> (indices_->size ());
+  int nr_chunks = static_cast<int> (threads);
+
+  // Get the distance field index, if we want to filter points far away from the viewpoint first
+  std::vector<pcl::PCLPointField> fields;
+  int distance_idx = -1;
+  if (!filter_field_name_.empty ())
+  {
+    distance_idx = pcl::getFieldIndex<PointT> (filter_field_name_, fields);
+    if (distance_idx == -1)
+      PCL_WARN ("[pcl::%s::applyFilter] Invalid filter field name. Index is %d.\n", getClassName ().c_str (), distance_idx);
+  }
+
+  // First pass: every thread computes the leaf index of each point of its chunk of the
+  // input and counts the points falling into each leaf in its own hash table
+  std::vector<IndexT> leaf_indices (indices_->size (), invalid_leaf);
+  std::vector<std::unordered_map<IndexT, unsigned int> > chunk_tables (nr_chunks);
+#pragma omp parallel for \
+  default(none) \
+  shared(chunk_tables, distance_idx, fields, invalid_leaf, leaf_indices, nr_chunks, nr_indices) \
+  schedule(static, 1) \
+  num_threads(threads)
+  for (int chunk = 0; chunk < nr_chunks; ++chunk)
+  {
+    auto &table = chunk_tables[chunk];
+    const std::ptrdiff_t chunk_begin = nr_indices * chunk / nr_chunks;
+    const std::ptrdiff_t chunk_end = nr_indices * (chunk + 1) / nr_chunks;
+    for (std::ptrdiff_t i = chunk_begin; i < chunk_end; ++i)
+    {
+      const PointT &point = (*input_)[(*indices_)[i]];
+      if (!input_->is_dense)
+        // Check if the point is invalid
+        if (!isXYZFinite (point))
+          continue;
+
+      if (distance_idx != -1)
+      {
+        // Get the distance value
+        const std::uint8_t* pt_data = reinterpret_cast<const std::uint8_t*> (&point);
+        float distance_value = 0;
+        memcpy (&distance_value, pt_data + fields[distance_idx].offset, sizeof (float));
+
+        if (filter_limit_negative_)
+        {
+          // Use a threshold for cutting out points which inside the interval
+          if ((distance_value < filter_limit_max_) && (distance_value > filter_limit_min_))
+            continue;
+        }
+        else
+        {
+          // Use a threshold for cutting out points which are too close/far away
+          if ((distance_value > filter_limit_max_) || (distance_value < filter_limit_min_))
+            continue;
+        }
+      }
+
+      int ijk0 = static_cast<int> (std::floor (point.x * inverse_leaf_size_[0]) - static_cast<float> (min_b_[0]));
+      int ijk1 = static_cast<int> (std::floor (point.y * inverse_leaf_size_[1]) - static_cast<float> (min_b_[1]));
+      int ijk2 = static_cast<int> (std::floor (point.z * inverse_leaf_size_[2]) - static_cast<float> (min_b_[2]));
+
+      // Compute the centroid leaf index
+      const IndexT leaf = static_cast<IndexT> (getLinearLeafIndex (ijk0, ijk1, ijk2));
+      leaf_indices[i] = leaf;
+      ++table[leaf];
+    }
+  }
+
+  // Second pass: merge the per-thread tables, and sort the occupied leaves only, so that the
+  // output keeps the ordering of the sequential version
+  std::unordered_map<IndexT, unsigned int> leaf_table;
+  for (const auto &table : chunk_tables)
+    for (const auto &entry : table)
+      leaf_table[entry.first] += entry.second;
+
+  std::vector<IndexT> leaves;
+  leaves.reserve (leaf_table.size ());
+  for (auto &entry : leaf_table)
+  {
+    if (entry.second >= min_points_per_voxel_)
+      leaves.push_back (entry.first);
+    else
+      entry.second = invalid_position;
+  }
+  boost::sort::spreadsort::integer_sort (leaves.begin (), leaves.end ());
+
+  // voxel_begin[i] is the position of the first point of the i-th output voxel in
+  // voxel_indices; from now on leaf_table maps a leaf to its output point
+  std::vector<unsigned int> voxel_begin (leaves.size () + 1, 0);
+  for (std::size_t i = 0; i < leaves.size (); ++i)
+  {
+    unsigned int &entry = leaf_table[leaves[i]];
+    voxel_begin[i + 1] = voxel_begin[i] + entry;
+    entry = static_cast<unsigned int> (i);
+  }
+
+  // Turn the per-thread counts into the position of the first point of every thread in
+  // each voxel, so that the points of a voxel are stored in the order of the input
+  std::vector<unsigned int> voxel_cursor (voxel_begin.begin (), voxel_begin.end () - 1);
+  for (auto &table : chunk_tables)
+  {
+    for (auto &entry : table)
+    {
+      const unsigned int output_index = leaf_table[entry.first];
+      if (output_index == invalid_position)
+      {
+        entry.second = invalid_position;
+        continue;
+      }
+      const unsigned int count = entry.second;
+      entry.second = voxel_cursor[output_index];
+      voxel_cursor[output_index] += count;
+    }
+  }
+
+  // Third pass: scatter the point indices into voxel-contiguous order
+  pcl::Indices voxel_indices (voxel_begin.back ());
+#pragma omp parallel for \
+  default(none) \
+  shared(chunk_tables, invalid_leaf, invalid_position, leaf_indices, nr_chunks, nr_indices, voxel_indices) \
+  schedule(static, 1) \
+  num_threads(threads)
+  for (int chunk = 0; chunk < nr_chunks; ++chunk)
+  {
+    auto &table = chunk_tables[chunk];
+    const std::ptrdiff_t chunk_begin = nr_indices * chunk / nr_chunks;
+    const std::ptrdiff_t chunk_end = nr_indices * (chunk + 1) / nr_chunks;
+    for (std::ptrdiff_t i = chunk_begin; i < chunk_end; ++i)
+    {
+      if (leaf_indices[i] == invalid_leaf)
+        continue;
+      unsigned int &position = table.find (leaf_indices[i])->second;
+      if (position == invalid_position)
+        continue;
+      voxel_indices[position++] = (*indices_)[i];
+    }
+  }
+
+  // Fourth pass: compute centroids, insert them into their final position
+  output.resize (leaves.size ());
+  if (save_leaf_layout)
+  {
+    resetLeafLayout ();
+    for (std::size_t i = 0; i < leaves.size (); ++i)
+      leaf_layout_[leaves[i]] = static_cast<int> (i);
+  }
+
+  std::ptrdiff_t nr_voxels = static_cast<std::ptrdiff_t> (leaves.size ());
+#pragma omp parallel for \
+  default(none) \
+  shared(nr_voxels, output, voxel_begin, voxel_indices) \
+  num_threads(threads)
+  for (std::ptrdiff_t i = 0; i < nr_voxels; ++i)
+  {
+    const unsigned int first_index = voxel_begin[i];
+    const unsigned int last_index = voxel_begin[i + 1];
+
+    //Limit downsampling to coords
+    if (!downsample_all_data_)
+    {
+      Eigen::Vector4f centroid (Eigen::Vector4f::Zero ());
+
+      for (unsigned int li = first_index; li < last_index; ++li)
+        centroid += (*input_)[voxel_indices[li]].getVector4fMap ();
+
+      centroid /= static_cast<float> (last_index - first_index);
+      output[i].getVector4fMap () = centroid;
+    }
+    else
+    {
+      CentroidPoint<PointT> centroid;
+
+      // fill in the accumulator with leaf points
+      for (unsigned int li = first_index; li < last_index; ++li)
+        centroid.add ((*input_)[voxel_indices[li]]);
+
+      centroid.get (output[i]);
+    }
+  }
+  output.width = output.size ();
+}
+
 #define PCL_INSTANTIATE_VoxelGrid(T) template class PCL_EXPORTS pcl::VoxelGrid<T>;
 #define PCL_INSTANTIATE_getMinMax3D(T) template PCL_EXPORTS void pcl::getMinMax3D<T> (const pcl::PointCloud<T>::ConstPtr &, const std::string &, float, float, Eigen::Vector4f &, Eigen::Vector4f &, bool);
 
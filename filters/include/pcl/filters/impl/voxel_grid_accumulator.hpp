@@ -0,0 +1,132 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef PCL_FILTERS_IMPL_VOXEL_GRID_ACCUMULATOR_H_
+#define PCL_FILTERS_IMPL_VOXEL_GRID_ACCUMULATOR_H_
+
+#include <pcl/common/point_tests.h> // for isXYZFinite
+#include <pcl/filters/voxel_grid_accumulator.h>
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::VoxelGridAccumulator<PointT>::addCloud (const PointCloud &cloud)
+{
+  for (const auto &point : cloud)
+  {
+    if (!cloud.is_dense)
+      // Check if the point is invalid
+      if (!isXYZFinite (point))
+        continue;
+
+    addPoint (point);
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::VoxelGridAccumulator<PointT>::addCloud (const PointCloud &cloud, const Indices &indices)
+{
+  for (const auto &index : indices)
+  {
+    if (!cloud.is_dense)
+      // Check if the point is invalid
+      if (!isXYZFinite (cloud[index]))
+        continue;
+
+    addPoint (cloud[index]);
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::VoxelGridAccumulator<PointT>::getCentroids (PointCloud &output) const
+{
+  output.clear ();
+  output.reserve (leaves_.size ());
+  for (const auto &leaf : leaves_)
+  {
+    if (leaf.second.getSize () < min_points_per_voxel_)
+      continue;
+
+    PointT centroid;
+    leaf.second.get (centroid);
+
+    //Limit downsampling to coords
+    if (!downsample_all_data_)
+    {
+      output.push_back (PointT ());
+      output.back ().x = centroid.x;
+      output.back ().y = centroid.y;
+      output.back ().z = centroid.z;
+    }
+    else
+      output.push_back (centroid);
+  }
+  output.width = output.size ();
+  output.height = 1;                    // downsampling breaks the organized structure
+  output.is_dense = true;               // invalid points are never accumulated
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> std::size_t
+pcl::VoxelGridAccumulator<PointT>::evictOutside (const Eigen::Vector4f &min_pt, const Eigen::Vector4f &max_pt)
+{
+  const std::size_t nr_leaves = leaves_.size ();
+  for (auto it = leaves_.begin (); it != leaves_.end (); )
+  {
+    const Eigen::Array3f center = (it->first.template cast<float> ().array () + 0.5f) * leaf_size_.head<3> ().array ();
+    if ((center < min_pt.head<3> ().array ()).any () || (center > max_pt.head<3> ().array ()).any ())
+      it = leaves_.erase (it);
+    else
+      ++it;
+  }
+  return (nr_leaves - leaves_.size ());
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> std::size_t
+pcl::VoxelGridAccumulator<PointT>::getNumberOfPoints () const
+{
+  std::size_t nr_points = 0;
+  for (const auto &leaf : leaves_)
+    nr_points += leaf.second.getSize ();
+  return (nr_points);
+}
+
+#define PCL_INSTANTIATE_VoxelGridAccumulator(T) template class PCL_EXPORTS pcl::VoxelGridAccumulator<T>;
+
+#endif    // PCL_FILTERS_IMPL_VOXEL_GRID_ACCUMULATOR_H_
@@ -80,7 +80,9 @@ pcl::VoxelGridCovariance<PointT>::applyFilter (PointCloud &output)
   std::int64_t dy = static_cast<std::int64_t>((max_p[1] - min_p[1]) * inverse_leaf_size_[1])+1;
   std::int64_t dz = static_cast<std::int64_t>((max_p[2] - min_p[2]) * inverse_leaf_size_[2])+1;
 
-  if((dx*dy*dz) > std::numeric_limits<std::int32_t>::max())
+  // Leaves are stored sparsely, so only the 64 bit leaf indices have to fit
+  const double nr_leaves = static_cast<double> (dx) * static_cast<double> (dy) * static_cast<double> (dz);
+  if (nr_leaves > static_cast<double> (std::numeric_limits<std::uint64_t>::max ()))
   {
     PCL_WARN("[pcl::%s::applyFilter] Leaf size is too small for the input dataset. Integer indices would overflow.\n", getClassName().c_str());
     output.clear();
@@ -103,7 +105,7 @@ pcl::VoxelGridCovariance<PointT>::applyFilter (PointCloud &output)
   leaves_.clear ();
 
   // Set up the division multiplier
-  divb_mul_ = Eigen::Vector4i (1, div_b_[0], div_b_[0] * div_b_[1], 0);
+  divb_mul_ = Eigen::Matrix<std::int64_t, 4, 1> (1, div_b_[0], static_cast<std::int64_t> (div_b_[0]) * div_b_[1], 0);
 
   int centroid_size = 4;
 
@@ -161,8 +163,7 @@ pcl::VoxelGridCovariance<PointT>::applyFilter (PointCloud &output)
       const Eigen::Vector4i ijk =
           Eigen::floor(point.getArray4fMap() * inverse_leaf_size_.array())
               .template cast<int>();
-      // divb_mul_[3] = 0 by assignment
-      int idx = (ijk - min_b_).dot(divb_mul_);
+      const std::size_t idx = getLinearLeafIndex (ijk[0] - min_b_[0], ijk[1] - min_b_[1], ijk[2] - min_b_[2]);
 
       Leaf& leaf = leaves_[idx];
       if (leaf.nr_points == 0)
@@ -217,8 +218,7 @@ pcl::VoxelGridCovariance<PointT>::applyFilter (PointCloud &output)
       const Eigen::Vector4i ijk =
           Eigen::floor(point.getArray4fMap() * inverse_leaf_size_.array())
               .template cast<int>();
-      // divb_mul_[3] = 0 by assignment
-      int idx = (ijk - min_b_).dot(divb_mul_);
+      const std::size_t idx = getLinearLeafIndex (ijk[0] - min_b_[0], ijk[1] - min_b_[1], ijk[2] - min_b_[2]);
 
       Leaf& leaf = leaves_[idx];
       if (leaf.nr_points == 0)
@@ -264,7 +264,14 @@ pcl::VoxelGridCovariance<PointT>::applyFilter (PointCloud &output)
   if (searchable_)
     voxel_centroids_leaf_indices_.reserve (leaves_.size ());
   int cp = 0;
-  if (save_leaf_layout_)
+  bool save_leaf_layout = save_leaf_layout_;
+  if (save_leaf_layout && nr_leaves > static_cast<double> (std::numeric_limits<std::int32_t>::max ()))
+  {
+    PCL_WARN ("[pcl::%s::applyFilter] The leaf layout can not be saved for grids with more than %d leaves.\n", getClassName ().c_str (), std::numeric_limits<std::int32_t>::max ());
+    leaf_layout_.clear ();
+    save_leaf_layout = false;
+  }
+  if (save_leaf_layout)
     leaf_layout_.resize (div_b_[0] * div_b_[1] * div_b_[2], -1);
 
   // Eigen values and vectors calculated to prevent near singluar matrices
@@ -292,7 +299,7 @@ pcl::VoxelGridCovariance<PointT>::applyFilter (PointCloud &output)
     // Points with less than the minimum points will have a can not be accuratly approximated using a normal distribution.
     if (leaf.nr_points >= min_points_per_voxel_)
     {
-      if (save_leaf_layout_)
+      if (save_leaf_layout)
         leaf_layout_[it->first] = cp++;
 
       output.push_back (PointT ());
@@ -320,7 +327,7 @@ pcl::VoxelGridCovariance<PointT>::applyFilter (PointCloud &output)
 
       // Stores the voxel indice for fast access searching
       if (searchable_)
-        voxel_centroids_leaf_indices_.push_back (static_cast<int> (it->first));
+        voxel_centroids_leaf_indices_.push_back (it->first);
 
       // Single pass covariance calculation
       leaf.cov_ = (leaf.cov_ - pt_sum * leaf.mean_.transpose()) / (leaf.nr_points - 1.0);
@@ -385,7 +392,8 @@ pcl::VoxelGridCovariance<PointT>::getNeighborhoodAtPoint (const Eigen::Matrix<in
     // Checking if the specified cell is in the grid
     if ((diff2min <= displacement.array ()).all () && (diff2max >= displacement.array ()).all ())
     {
-      const auto leaf_iter = leaves_.find (((ijk + displacement - min_b_).dot (divb_mul_)));
+      const Eigen::Vector4i leaf_ijk = ijk + displacement - min_b_;
+      const auto leaf_iter = leaves_.find (getLinearLeafIndex (leaf_ijk[0], leaf_ijk[1], leaf_ijk[2]));
       if (leaf_iter != leaves_.end () && leaf_iter->second.nr_points >= min_points_per_voxel_)
       {
         LeafConstPtr leaf = &(leaf_iter->second);
@@ -40,6 +40,13 @@
 #define PCL_FILTERS_IMPL_VOXEL_GRID_OCCLUSION_ESTIMATION_H_
 
 #include <pcl/filters/voxel_grid_occlusion_estimation.h>
+#include <pcl/common/execution_context.h>
+
+#include <cstddef>  // for std::ptrdiff_t
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointT> void
@@ -127,6 +134,108 @@ pcl::VoxelGridOcclusionEstimation<PointT>::occlusionEstimation (int& out_state,
   return 0;
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> int
+pcl::VoxelGridOcclusionEstimation<PointT>::occlusionEstimation (std::vector<int>& out_states,
+                                                                const std::vector<Eigen::Vector3i, Eigen::aligned_allocator<Eigen::Vector3i> >& in_target_voxels)
+{
+  if (!initialized_)
+  {
+    PCL_ERROR ("Voxel grid not initialized; call initializeVoxelGrid () first! \n");
+    return -1;
+  }
+
+  out_states.resize (in_target_voxels.size ());
+  const pcl::ThreadReservation reservation (threads_);
+  const unsigned int threads = reservation.getNumberOfThreads ();
+#pragma omp parallel for \
+  default(none) \
+  shared(in_target_voxels, out_states) \
+  schedule(dynamic, 64) \
+  num_threads(threads)
+  for (std::ptrdiff_t i = 0; i < static_cast<std::ptrdiff_t> (in_target_voxels.size ()); ++i)
+  {
+    Eigen::Vector4f direction;
+    float tmin;
+    if (initRay (in_target_voxels[i], direction, tmin))
+      out_states[i] = rayTraversal (in_target_voxels[i], sensor_origin_, direction, tmin);
+    else
+      out_states[i] = -1;
+  }
+  return 0;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> int
+pcl::VoxelGridOcclusionEstimation<PointT>::occlusionEstimation (std::vector<int>& out_states,
+                                                                std::vector<Eigen::Vector3i, Eigen::aligned_allocator<Eigen::Vector3i> >& out_rays,
+                                                                std::vector<std::size_t>& out_ray_offsets,
+                                                                const std::vector<Eigen::Vector3i, Eigen::aligned_allocator<Eigen::Vector3i> >& in_target_voxels)
+{
+  if (!initialized_)
+  {
+    PCL_ERROR ("Voxel grid not initialized; call initializeVoxelGrid () first! \n");
+    return -1;
+  }
+
+  const std::size_t nr_rays = in_target_voxels.size ();
+  out_states.resize (nr_rays);
+  out_ray_offsets.assign (nr_rays + 1, 0);
+
+  const pcl::ThreadReservation reservation (threads_);
+  const unsigned int threads = reservation.getNumberOfThreads ();
+  // Every thread traverses a contiguous block of rays into a local buffer, the buffers
+  // are concatenated in ray order afterwards
+  std::vector<std::size_t> block_sizes (threads + 1, 0);
+#pragma omp parallel \
+  default(none) \
+  shared(block_sizes, in_target_voxels, nr_rays, out_ray_offsets, out_rays, out_states) \
+  num_threads(threads)
+  {
+#ifdef _OPENMP
+    const std::size_t thread_id = omp_get_thread_num ();
+    const std::size_t nr_blocks = omp_get_num_threads ();
+#else
+    const std::size_t thread_id = 0;
+    const std::size_t nr_blocks = 1;
+#endif
+    const std::size_t begin = thread_id * nr_rays / nr_blocks;
+    const std::size_t end = (thread_id + 1) * nr_rays / nr_blocks;
+
+    std::vector<Eigen::Vector3i, Eigen::aligned_allocator<Eigen::Vector3i> > rays, ray;
+    for (std::size_t i = begin; i < end; ++i)
+    {
+      Eigen::Vector4f direction;
+      float tmin;
+      ray.clear ();
+      if (initRay (in_target_voxels[i], direction, tmin))
+        out_states[i] = rayTraversal (ray, in_target_voxels[i], sensor_origin_, direction, tmin);
+      else
+        out_states[i] = -1;
+      rays.insert (rays.end (), ray.begin (), ray.end ());
+      out_ray_offsets[i + 1] = ray.size ();
+    }
+    block_sizes[thread_id + 1] = rays.size ();
+
+#pragma omp barrier
+#pragma omp single
+    {
+      for (std::size_t block = 0; block < nr_blocks; ++block)
+        block_sizes[block + 1] += block_sizes[block];
+      out_rays.resize (block_sizes[nr_blocks]);
+    }
+
+    std::copy (rays.begin (), rays.end (), out_rays.begin () + block_sizes[thread_id]);
+    std::size_t offset = block_sizes[thread_id];
+    for (std::size_t i = begin; i < end; ++i)
+    {
+      offset += out_ray_offsets[i + 1];
+      out_ray_offsets[i + 1] = offset;
+    }
+  }
+  return 0;
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointT> int
 pcl::VoxelGridOcclusionEstimation<PointT>::occlusionEstimationAll (std::vector<Eigen::Vector3i, Eigen::aligned_allocator<Eigen::Vector3i> >& occluded_voxels)
@@ -137,39 +246,56 @@ pcl::VoxelGridOcclusionEstimation<PointT>::occlusionEstimationAll (std::vector<E
     return -1;
   }
 
+  const pcl::ThreadReservation reservation (threads_);
+  const unsigned int threads = reservation.getNumberOfThreads ();
+  // State of every voxel of the grid, in the order of the serial sweep
+  const int nr_voxels = div_b_[0] * div_b_[1] * div_b_[2];
+  std::vector<char> occluded (nr_voxels, 0);
+#pragma omp parallel for \
+  default(none) \
+  shared(nr_voxels, occluded) \
+  schedule(dynamic, 256) \
+  num_threads(threads)
+  for (int voxel = 0; voxel < nr_voxels; ++voxel)
+  {
+    const Eigen::Vector3i ijk (min_b_.x () + voxel % div_b_[0],
+                               min_b_.y () + (voxel / div_b_[0]) % div_b_[1],
+                               min_b_.z () + voxel / (div_b_[0] * div_b_[1]));
+    // process all free voxels
+    if (this->getCentroidIndexAt (ijk) == -1)
+    {
+      Eigen::Vector4f direction;
+      float tmin;
+      if (initRay (ijk, direction, tmin))
+        occluded[voxel] = (rayTraversal (ijk, sensor_origin_, direction, tmin) == 1);
+    }
+  }
+
   // reserve space for the ray vector
-  int reserve_size = div_b_[0] * div_b_[1] * div_b_[2];
-  occluded_voxels.reserve (reserve_size);
-
-  // iterate over the entire voxel grid
-  for (int kk = min_b_.z (); kk <= max_b_.z (); ++kk)
-    for (int jj = min_b_.y (); jj <= max_b_.y (); ++jj)
-      for (int ii = min_b_.x (); ii <= max_b_.x (); ++ii)
-      {
-        Eigen::Vector3i ijk (ii, jj, kk);
-        // process all free voxels
-        int index = this->getCentroidIndexAt (ijk);
-        if (index == -1)
-        {
-          // estimate direction to target voxel
-          Eigen::Vector4f p = getCentroidCoordinate (ijk);
-          Eigen::Vector4f direction = p - sensor_origin_;
-          direction.normalize ();
-          
-          // estimate entry point into the voxel grid
-          float tmin = rayBoxIntersection (sensor_origin_, direction);
-
-          // ray traversal
-          int state = rayTraversal (ijk, sensor_origin_, direction, tmin);
-          
-          // if voxel is occluded
-          if (state == 1)
-            occluded_voxels.push_back (ijk);
-        }
-      }
+  occluded_voxels.reserve (nr_voxels);
+  for (int voxel = 0; voxel < nr_voxels; ++voxel)
+    if (occluded[voxel])
+      occluded_voxels.emplace_back (min_b_.x () + voxel % div_b_[0],
+                                    min_b_.y () + (voxel / div_b_[0]) % div_b_[1],
+                                    min_b_.z () + voxel / (div_b_[0] * div_b_[1]));
   return 0;
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> bool
+pcl::VoxelGridOcclusionEstimation<PointT>::initRay (const Eigen::Vector3i& target_voxel,
+                                                    Eigen::Vector4f& direction,
+                                                    float& t_min)
+{
+  // estimate direction to target voxel
+  direction = getCentroidCoordinate (target_voxel) - sensor_origin_;
+  direction.normalize ();
+
+  // estimate entry point into the voxel grid
+  t_min = rayBoxIntersection (sensor_origin_, direction);
+  return (t_min != -1);
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointT> float
 pcl::VoxelGridOcclusionEstimation<PointT>::rayBoxIntersection (const Eigen::Vector4f& origin, 
@@ -49,6 +49,8 @@ namespace pcl
     * in the function (as compared to filters based on averaging), and it is robust to outliers. Furthermore, it is
     * simple to implement and efficient, as it requires a single pass over the image. It consists of a moving window of
     * fixed size that replaces the pixel in the center with the median inside the window.
+    * For windows of size 5 and up, the depths are ranked once and the window slides along the rows over a Fenwick
+    * tree of the ranks, so the cost per point grows linearly rather than quadratically with the window size.
     *
     * \note This algorithm filters only the depth (z-component) of _organized_ and untransformed (i.e., in camera coordinates)
     * point clouds. An error will be outputted if an unorganized cloud is given to the class instance.
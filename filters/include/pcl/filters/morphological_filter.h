@@ -44,6 +44,8 @@
 #include <pcl/point_cloud.h> // for PointCloud
 #include <pcl/pcl_exports.h> // for PCL_EXPORTS
 
+#include <Eigen/Core> // for MatrixXf
+
 namespace pcl
 {
   enum MorphologicalOperators
@@ -68,6 +70,21 @@ namespace pcl
   applyMorphologicalOperator (const typename pcl::PointCloud<PointT>::ConstPtr &cloud_in,
                               float resolution, const int morphological_operator,
                               pcl::PointCloud<PointT> &cloud_out);
+
+  /** \brief Apply morphological operator to a grid of heights, e.g. the lowest z value of the points in each
+    * cell of a regular xy grid. The window covers (2 * half_size + 1) x (2 * half_size + 1) cells and is clipped
+    * at the border of the grid. Erosion and dilation are split into a pass along the rows and one along the columns,
+    * each using the van Herk/Gil-Werman algorithm, so that the cost does not depend on the window size.
+    * NaN cells are empty: they are ignored, and a cell without any value in its window becomes NaN.
+    * \param[in] grid_in the input grid of heights
+    * \param[in] half_size the number of cells the window extends to each side of its center
+    * \param[in] morphological_operator the morphological operator to apply (open, close, dilate, erode)
+    * \param[out] grid_out the resultant grid of heights
+    * \ingroup filters
+    */
+  PCL_EXPORTS void
+  applyMorphologicalOperator (const Eigen::MatrixXf &grid_in, int half_size,
+                              const int morphological_operator, Eigen::MatrixXf &grid_out);
 }
 
 #ifdef PCL_NO_PRECOMPILE
@@ -77,6 +77,7 @@ namespace pcl
         , binsy_ ()
         , binsz_ ()
         , input_normals_ ()
+        , threads_ (1)
       {
         filter_name_ = "NormalSpaceSampling";
       }
@@ -141,6 +142,17 @@ namespace pcl
       inline NormalsConstPtr
       getNormals () const { return (input_normals_); }
 
+      /** \brief Set the number of threads to use for binning the normals. The samples do not
+        * depend on the number of threads.
+        * \param[in] nr_threads the number of hardware threads to use (0 sets the value automatically)
+        */
+      void
+      setNumberOfThreads (unsigned int nr_threads = 0);
+
+      /** \brief Get the number of threads used by the filter. */
+      inline unsigned int
+      getNumberOfThreads () const { return (threads_); }
+
     protected:
       /** \brief Number of indices that will be returned. */
       unsigned int sample_;
@@ -157,6 +169,9 @@ namespace pcl
       /** \brief The normals computed at each point in the input cloud */
       NormalsConstPtr input_normals_;
 
+      /** \brief The number of threads the scheduler should use. */
+      unsigned int threads_;
+
       /** \brief Sample of point indices
         * \param[out] indices the resultant point cloud indices
         */
@@ -171,15 +186,7 @@ namespace pcl
         * \param[in] normal the input normal 
         */
       unsigned int 
-      findBin (const float *normal);
-
-      /** \brief Checks of the entire bin is sampled, returns true or false
-        * \param[out] array flag which says whether a point is sampled or not
-        * \param[in] start_index the index to the first point of the bin in array.
-        * \param[in] length number of points in the bin
-        */
-      bool
-      isEntireBinSampled (boost::dynamic_bitset<> &array, unsigned int start_index, unsigned int length);
+      findBin (const float *normal) const;
 
       /** \brief Random engine */
       std::mt19937 rng_;
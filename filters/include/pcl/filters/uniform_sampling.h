@@ -41,7 +41,7 @@
 
 #include <pcl/filters/filter.h>
 
-#include <unordered_map>
+#include <vector>
 
 namespace pcl
 {
@@ -81,7 +81,8 @@ namespace pcl
         max_b_ (Eigen::Vector4i::Zero ()),
         div_b_ (Eigen::Vector4i::Zero ()),
         divb_mul_ (Eigen::Vector4i::Zero ()),
-        search_radius_ (0)
+        search_radius_ (0),
+        threads_ (1)
       {
         filter_name_ = "UniformSampling";
       }
@@ -107,6 +108,21 @@ namespace pcl
         search_radius_ = radius;
       }
 
+      /** \brief Set the number of threads to use for computing the voxels of the points and
+        * for selecting the point of each voxel. The output does not depend on the number of
+        * threads: of the points closest to the voxel center the first one is kept.
+        * \param[in] nr_threads the number of hardware threads to use (0 sets the value automatically)
+        */
+      void
+      setNumberOfThreads (unsigned int nr_threads = 0);
+
+      /** \brief Get the number of threads used by the filter. */
+      inline unsigned int
+      getNumberOfThreads () const
+      {
+        return (threads_);
+      }
+
     protected:
       /** \brief Simple structure to hold an nD centroid and the number of points in a leaf. */
       struct Leaf
@@ -115,8 +131,8 @@ namespace pcl
         int idx;
       };
 
-      /** \brief The 3D grid leaves. */
-      std::unordered_map<std::size_t, Leaf> leaves_;
+      /** \brief The occupied 3D grid leaves, in the order of their voxel index. */
+      std::vector<Leaf> leaves_;
 
       /** \brief The size of a leaf. */
       Eigen::Vector4f leaf_size_;
@@ -130,6 +146,9 @@ namespace pcl
       /** \brief The nearest neighbors search radius for each point. */
       double search_radius_;
 
+      /** \brief The number of threads the scheduler should use. */
+      unsigned int threads_;
+
       /** \brief Downsample a Point Cloud using a voxelized grid approach
         * \param[out] output the resultant point cloud message
         */
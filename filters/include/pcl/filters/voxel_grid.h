@@ -41,9 +41,13 @@
 
 #include <pcl/filters/filter.h>
 #include <cfloat> // for FLT_MAX
+#include <cstdint> // for int64_t
+#include <limits> // for numeric_limits
 
 namespace pcl
 {
+  class PointCloudSoA;
+
   /** \brief Obtain the maximum and minimum points in 3D from a given point cloud.
     * \param[in] cloud the pointer to a pcl::PCLPointCloud2 dataset
     * \param[in] x_idx the index of the X channel
@@ -160,6 +164,25 @@ namespace pcl
                const std::string &distance_field_name, float min_distance, float max_distance,
                Eigen::Vector4f &min_pt, Eigen::Vector4f &max_pt, bool limit_negative = false);
 
+  /** \brief Downsample a columnar point cloud with a voxel grid, the same way VoxelGrid does for a
+    * pcl::PointCloud<PointT>: every voxel holding at least \a min_points_per_voxel valid points is
+    * replaced by the centroid of its points. The output voxels are ordered by their leaf index.
+    *
+    * When \a downsample_all_data is set, every column of the input is reduced: FLOAT32 and FLOAT64
+    * columns are averaged, "rgb" and "rgba" columns are averaged per color channel and all other
+    * columns keep the value of one of the points of the voxel.
+    * \param[in] input the input point cloud, with FLOAT32 x, y and z fields
+    * \param[out] output the resultant downsampled point cloud
+    * \param[in] leaf_size the voxel grid leaf size
+    * \param[in] min_points_per_voxel the minimum number of points required for a voxel to be used
+    * \param[in] downsample_all_data reduce all the columns of the input (true), or only x, y, z (false)
+    * \ingroup filters
+    */
+  PCL_EXPORTS void
+  voxelGridFilter (const pcl::PointCloudSoA &input, pcl::PointCloudSoA &output,
+                   const Eigen::Vector3f &leaf_size, unsigned int min_points_per_voxel = 0,
+                   bool downsample_all_data = true);
+
   /** \brief VoxelGrid assembles a local 3D grid over a given PointCloud, and downsamples + filters the data.
     *
     * The VoxelGrid class creates a *3D voxel grid* (think about a voxel
@@ -199,12 +222,13 @@ namespace pcl
         min_b_ (Eigen::Vector4i::Zero ()),
         max_b_ (Eigen::Vector4i::Zero ()),
         div_b_ (Eigen::Vector4i::Zero ()),
-        divb_mul_ (Eigen::Vector4i::Zero ()),
+        divb_mul_ (Eigen::Matrix<std::int64_t, 4, 1>::Zero ()),
         filter_field_name_ (""),
         filter_limit_min_ (-FLT_MAX),
         filter_limit_max_ (FLT_MAX),
         filter_limit_negative_ (false),
-        min_points_per_voxel_ (0)
+        min_points_per_voxel_ (0),
+        threads_ (1)
       {
         filter_name_ = "VoxelGrid";
       }
@@ -273,6 +297,7 @@ namespace pcl
 
       /** \brief Set to true if leaf layout information needs to be saved for later access.
         * \param[in] save_leaf_layout the new value (true/false)
+        * \note The leaf layout is not saved for grids with more than 2^31 leaves.
         */
       inline void
       setSaveLeafLayout (bool save_leaf_layout) { save_leaf_layout_ = save_leaf_layout; }
@@ -281,6 +306,19 @@ namespace pcl
       inline bool
       getSaveLeafLayout () const { return (save_leaf_layout_); }
 
+      /** \brief Set the number of threads to use for the centroid computation.
+        * With more than one thread the points are binned into per-thread hash tables
+        * which are merged afterwards, instead of sorting all point/voxel pairs. The
+        * output is the same as the one of the single threaded version.
+        * \param[in] nr_threads the number of hardware threads to use (0 takes as many as the budget of pcl::ExecutionContext allows when filtering)
+        */
+      void
+      setNumberOfThreads (unsigned int nr_threads = 0);
+
+      /** \brief Get the number of threads used for the centroid computation. */
+      inline unsigned int
+      getNumberOfThreads () const { return (threads_); }
+
       /** \brief Get the minimum coordinates of the bounding box (after
         * filtering is performed).
         */
@@ -301,9 +339,19 @@ namespace pcl
 
       /** \brief Get the multipliers to be applied to the grid coordinates in
         * order to find the centroid index (after filtering is performed).
+        * \note For grids with more than 2^31 leaves the Z multiplier does not fit in an int;
+        * an error is printed and -1 is returned for it.
         */
       inline Eigen::Vector3i
-      getDivisionMultiplier () const { return (divb_mul_.head<3> ()); }
+      getDivisionMultiplier () const
+      {
+        if (divb_mul_[2] > std::numeric_limits<int>::max ())
+        {
+          PCL_ERROR ("[pcl::%s::getDivisionMultiplier] The division multiplier of grids with more than 2^31 leaves does not fit in an int!\n", getClassName ().c_str ());
+          return (Eigen::Vector3i (static_cast<int> (divb_mul_[0]), static_cast<int> (divb_mul_[1]), -1));
+        }
+        return (divb_mul_.head<3> ().cast<int> ());
+      }
 
       /** \brief Returns the index in the resulting downsampled cloud of the specified point.
         *
@@ -316,9 +364,11 @@ namespace pcl
       inline int
       getCentroidIndex (const PointT &p) const
       {
-        return (leaf_layout_.at ((Eigen::Vector4i (static_cast<int> (std::floor (p.x * inverse_leaf_size_[0])),
-                                                   static_cast<int> (std::floor (p.y * inverse_leaf_size_[1])),
-                                                   static_cast<int> (std::floor (p.z * inverse_leaf_size_[2])), 0) - min_b_).dot (divb_mul_)));
+        if (!checkLeafLayout ("getCentroidIndex"))
+          return (-1);
+        return (leaf_layout_.at (getLeafLayoutIndex (Eigen::Vector4i (static_cast<int> (std::floor (p.x * inverse_leaf_size_[0])),
+                                                                      static_cast<int> (std::floor (p.y * inverse_leaf_size_[1])),
+                                                                      static_cast<int> (std::floor (p.z * inverse_leaf_size_[2])), 0))));
       }
 
       /** \brief Returns the indices in the resulting downsampled cloud of the points at the specified grid coordinates,
@@ -330,6 +380,8 @@ namespace pcl
       inline std::vector<int>
       getNeighborCentroidIndices (const PointT &reference_point, const Eigen::MatrixXi &relative_coordinates) const
       {
+        if (!checkLeafLayout ("getNeighborCentroidIndices"))
+          return (std::vector<int> (relative_coordinates.cols (), -1));
         Eigen::Vector4i ijk (static_cast<int> (std::floor (reference_point.x * inverse_leaf_size_[0])),
                              static_cast<int> (std::floor (reference_point.y * inverse_leaf_size_[1])),
                              static_cast<int> (std::floor (reference_point.z * inverse_leaf_size_[2])), 0);
@@ -341,7 +393,7 @@ namespace pcl
           Eigen::Vector4i displacement = (Eigen::Vector4i() << relative_coordinates.col(ni), 0).finished();
           // checking if the specified cell is in the grid
           if ((diff2min <= displacement.array()).all() && (diff2max >= displacement.array()).all())
-            neighbors[ni] = leaf_layout_[((ijk + displacement - min_b_).dot (divb_mul_))]; // .at() can be omitted
+            neighbors[ni] = leaf_layout_[getLeafLayoutIndex (ijk + displacement)]; // .at() can be omitted
           else
             neighbors[ni] = -1; // cell is out of bounds, consider it empty
         }
@@ -373,8 +425,8 @@ namespace pcl
       inline int
       getCentroidIndexAt (const Eigen::Vector3i &ijk) const
       {
-        int idx = ((Eigen::Vector4i() << ijk, 0).finished() - min_b_).dot (divb_mul_);
-        if (idx < 0 || idx >= static_cast<int> (leaf_layout_.size ())) // this checks also if leaf_layout_.size () == 0 i.e. everything was computed as needed
+        const std::int64_t idx = getLeafLayoutIndex ((Eigen::Vector4i() << ijk, 0).finished());
+        if (idx < 0 || idx >= static_cast<std::int64_t> (leaf_layout_.size ())) // this checks also if leaf_layout_.size () == 0 i.e. everything was computed as needed
         {
           //if (verbose)
           //  PCL_ERROR ("[pcl::%s::getCentroidIndexAt] Specified coordinate is outside grid bounds, or leaf layout is not saved, make sure to call setSaveLeafLayout(true) and filter(output) first!\n", getClassName ().c_str ());
@@ -466,8 +518,11 @@ namespace pcl
       /** \brief The leaf layout information for fast access to cells relative to current position **/
       std::vector<int> leaf_layout_;
 
-      /** \brief The minimum and maximum bin coordinates, the number of divisions, and the division multiplier. */
-      Eigen::Vector4i min_b_, max_b_, div_b_, divb_mul_;
+      /** \brief The minimum and maximum bin coordinates, and the number of divisions. */
+      Eigen::Vector4i min_b_, max_b_, div_b_;
+
+      /** \brief The division multiplier, in 64 bit so that it does not overflow for grids with more than 2^31 leaves. */
+      Eigen::Matrix<std::int64_t, 4, 1> divb_mul_;
 
       /** \brief The desired user filter field name. */
       std::string filter_field_name_;
@@ -484,6 +539,9 @@ namespace pcl
       /** \brief Minimum number of points per voxel for the centroid to be computed */
       unsigned int min_points_per_voxel_;
 
+      /** \brief The number of threads the scheduler should use. */
+      unsigned int threads_;
+
       using FieldList = typename pcl::traits::fieldList<PointT>::type;
 
       /** \brief Downsample a Point Cloud using a voxelized grid approach
@@ -491,6 +549,67 @@ namespace pcl
         */
       void
       applyFilter (PointCloud &output) override;
+
+      /** \brief Re-initialize \a leaf_layout_ to -1 for the current grid divisions. */
+      void
+      resetLeafLayout ();
+
+      /** \brief Compute the position in \a leaf_layout_ of the leaf at absolute grid coordinates \a ijk.
+        * \param[in] ijk the grid coordinates, the fourth one is ignored
+        */
+      inline std::int64_t
+      getLeafLayoutIndex (const Eigen::Vector4i &ijk) const
+      {
+        return ((ijk - min_b_).template cast<std::int64_t> ().dot (divb_mul_));
+      }
+
+      /** \brief Check that a leaf layout was saved by the last filtering, printing an error otherwise.
+        * \param[in] method the name of the calling method, for the error message
+        */
+      inline bool
+      checkLeafLayout (const char *method) const
+      {
+        if (!leaf_layout_.empty ())
+          return (true);
+        PCL_ERROR ("[pcl::%s::%s] No leaf layout is saved, make sure to call setSaveLeafLayout(true) and filter(output) first! Grids with more than 2^31 leaves have no leaf layout.\n", getClassName ().c_str (), method);
+        return (false);
+      }
+
+      /** \brief Compute the linear index of a leaf from its grid coordinates relative to \a min_b_.
+        * The index is computed with 64 bit integers, so that it does not overflow for grids
+        * with more than 2^31 leaves.
+        * \param[in] ijk0 the grid coordinate along X
+        * \param[in] ijk1 the grid coordinate along Y
+        * \param[in] ijk2 the grid coordinate along Z
+        */
+      inline std::uint64_t
+      getLinearLeafIndex (int ijk0, int ijk1, int ijk2) const
+      {
+        return (static_cast<std::uint64_t> (ijk0) +
+                static_cast<std::uint64_t> (ijk1) * static_cast<std::uint64_t> (div_b_[0]) +
+                static_cast<std::uint64_t> (ijk2) * static_cast<std::uint64_t> (div_b_[0]) * static_cast<std::uint64_t> (div_b_[1]));
+      }
+
+      /** \brief Compute the voxel centroids by sorting the points on their leaf index, once the
+        * grid bounds have been computed.
+        * \param[out] output the resultant point cloud message
+        * \param[in] save_leaf_layout whether \a leaf_layout_ should be filled
+        * \tparam IndexT the leaf index type, wide enough to address all the leaves of the grid
+        */
+      template <typename IndexT> void
+      applyFilterSequential (PointCloud &output, bool save_leaf_layout);
+
+      /** \brief Compute the voxel centroids with \a threads threads, once the grid
+        * bounds have been computed. Each thread bins its share of the points in a hash
+        * table, the tables are merged and the points are scattered into voxel-contiguous
+        * order, so that no sort over all the points is needed.
+        * \param[out] output the resultant point cloud message
+        * \param[in] save_leaf_layout whether \a leaf_layout_ should be filled
+        * \param[in] threads the number of threads reserved for the computation
+        * \tparam IndexT the leaf index type, wide enough to address all the leaves of the grid
+        */
+      template <typename IndexT> void
+      applyFilterParallel (PointCloud &output, bool save_leaf_layout, unsigned int threads);
   };
 
   /** \brief VoxelGrid assembles a local 3D grid over a given PointCloud, and downsamples + filters the data.
@@ -525,7 +644,7 @@ namespace pcl
         min_b_ (Eigen::Vector4i::Zero ()),
         max_b_ (Eigen::Vector4i::Zero ()),
         div_b_ (Eigen::Vector4i::Zero ()),
-        divb_mul_ (Eigen::Vector4i::Zero ()),
+        divb_mul_ (Eigen::Matrix<std::int64_t, 4, 1>::Zero ()),
         filter_field_name_ (""),
         filter_limit_min_ (-FLT_MAX),
         filter_limit_max_ (FLT_MAX),
@@ -627,9 +746,19 @@ namespace pcl
 
       /** \brief Get the multipliers to be applied to the grid coordinates in
         * order to find the centroid index (after filtering is performed).
+        * \note For grids with more than 2^31 leaves the Z multiplier does not fit in an int;
+        * an error is printed and -1 is returned for it.
         */
       inline Eigen::Vector3i
-      getDivisionMultiplier () const { return (divb_mul_.head<3> ()); }
+      getDivisionMultiplier () const
+      {
+        if (divb_mul_[2] > std::numeric_limits<int>::max ())
+        {
+          PCL_ERROR ("[pcl::%s::getDivisionMultiplier] The division multiplier of grids with more than 2^31 leaves does not fit in an int!\n", getClassName ().c_str ());
+          return (Eigen::Vector3i (static_cast<int> (divb_mul_[0]), static_cast<int> (divb_mul_[1]), -1));
+        }
+        return (divb_mul_.head<3> ().cast<int> ());
+      }
 
       /** \brief Returns the index in the resulting downsampled cloud of the specified point.
         * \note for efficiency, user must make sure that the saving of the leaf layout is enabled and filtering performed,
@@ -641,11 +770,12 @@ namespace pcl
       inline int
       getCentroidIndex (float x, float y, float z) const
       {
-        return (leaf_layout_.at ((Eigen::Vector4i (static_cast<int> (std::floor (x * inverse_leaf_size_[0])),
-                                                   static_cast<int> (std::floor (y * inverse_leaf_size_[1])),
-                                                   static_cast<int> (std::floor (z * inverse_leaf_size_[2])),
-                                                   0)
-                - min_b_).dot (divb_mul_)));
+        if (!checkLeafLayout ("getCentroidIndex"))
+          return (-1);
+        return (leaf_layout_.at (getLeafLayoutIndex (Eigen::Vector4i (static_cast<int> (std::floor (x * inverse_leaf_size_[0])),
+                                                                      static_cast<int> (std::floor (y * inverse_leaf_size_[1])),
+                                                                      static_cast<int> (std::floor (z * inverse_leaf_size_[2])),
+                                                                      0))));
       }
 
       /** \brief Returns the indices in the resulting downsampled cloud of the points at the specified grid coordinates,
@@ -659,6 +789,8 @@ namespace pcl
       inline std::vector<int>
       getNeighborCentroidIndices (float x, float y, float z, const Eigen::MatrixXi &relative_coordinates) const
       {
+        if (!checkLeafLayout ("getNeighborCentroidIndices"))
+          return (std::vector<int> (relative_coordinates.cols (), -1));
         Eigen::Vector4i ijk (static_cast<int> (std::floor (x * inverse_leaf_size_[0])),
                              static_cast<int> (std::floor (y * inverse_leaf_size_[1])),
                              static_cast<int> (std::floor (z * inverse_leaf_size_[2])), 0);
@@ -670,7 +802,7 @@ namespace pcl
           Eigen::Vector4i displacement = (Eigen::Vector4i() << relative_coordinates.col(ni), 0).finished();
           // checking if the specified cell is in the grid
           if ((diff2min <= displacement.array()).all() && (diff2max >= displacement.array()).all())
-            neighbors[ni] = leaf_layout_[((ijk + displacement - min_b_).dot (divb_mul_))]; // .at() can be omitted
+            neighbors[ni] = leaf_layout_[getLeafLayoutIndex (ijk + displacement)]; // .at() can be omitted
           else
             neighbors[ni] = -1; // cell is out of bounds, consider it empty
         }
@@ -688,11 +820,13 @@ namespace pcl
       inline std::vector<int>
       getNeighborCentroidIndices (float x, float y, float z, const std::vector<Eigen::Vector3i, Eigen::aligned_allocator<Eigen::Vector3i> > &relative_coordinates) const
       {
+        if (!checkLeafLayout ("getNeighborCentroidIndices"))
+          return (std::vector<int> (relative_coordinates.size (), -1));
         Eigen::Vector4i ijk (static_cast<int> (std::floor (x * inverse_leaf_size_[0])), static_cast<int> (std::floor (y * inverse_leaf_size_[1])), static_cast<int> (std::floor (z * inverse_leaf_size_[2])), 0);
         std::vector<int> neighbors;
         neighbors.reserve (relative_coordinates.size ());
         for (const auto &relative_coordinate : relative_coordinates)
-          neighbors.push_back (leaf_layout_[(ijk + (Eigen::Vector4i() << relative_coordinate, 0).finished() - min_b_).dot (divb_mul_)]);
+          neighbors.push_back (leaf_layout_[getLeafLayoutIndex (ijk + (Eigen::Vector4i() << relative_coordinate, 0).finished())]);
         return (neighbors);
       }
 
@@ -721,8 +855,8 @@ namespace pcl
       inline int
       getCentroidIndexAt (const Eigen::Vector3i &ijk) const
       {
-        int idx = ((Eigen::Vector4i() << ijk, 0).finished() - min_b_).dot (divb_mul_);
-        if (idx < 0 || idx >= static_cast<int> (leaf_layout_.size ())) // this checks also if leaf_layout_.size () == 0 i.e. everything was computed as needed
+        const std::int64_t idx = getLeafLayoutIndex ((Eigen::Vector4i() << ijk, 0).finished());
+        if (idx < 0 || idx >= static_cast<std::int64_t> (leaf_layout_.size ())) // this checks also if leaf_layout_.size () == 0 i.e. everything was computed as needed
         {
           //if (verbose)
           //  PCL_ERROR ("[pcl::%s::getCentroidIndexAt] Specified coordinate is outside grid bounds, or leaf layout is not saved, make sure to call setSaveLeafLayout(true) and filter(output) first!\n", getClassName ().c_str ());
@@ -818,10 +952,13 @@ namespace pcl
         */
       std::vector<int> leaf_layout_;
 
-      /** \brief The minimum and maximum bin coordinates, the number of
-        * divisions, and the division multiplier.
+      /** \brief The minimum and maximum bin coordinates, and the number of
+        * divisions.
         */
-      Eigen::Vector4i min_b_, max_b_, div_b_, divb_mul_;
+      Eigen::Vector4i min_b_, max_b_, div_b_;
+
+      /** \brief The division multiplier, in 64 bit so that it does not overflow for grids with more than 2^31 leaves. */
+      Eigen::Matrix<std::int64_t, 4, 1> divb_mul_;
 
       /** \brief The desired user filter field name. */
       std::string filter_field_name_;
@@ -838,6 +975,42 @@ namespace pcl
       /** \brief Minimum number of points per voxel for the centroid to be computed */
       unsigned int min_points_per_voxel_;
 
+      /** \brief Compute the linear index of a leaf from its grid coordinates relative to \a min_b_.
+        * The index is computed with 64 bit integers, so that it does not overflow for grids
+        * with more than 2^31 leaves.
+        * \param[in] ijk0 the grid coordinate along X
+        * \param[in] ijk1 the grid coordinate along Y
+        * \param[in] ijk2 the grid coordinate along Z
+        */
+      inline std::uint64_t
+      getLinearLeafIndex (int ijk0, int ijk1, int ijk2) const
+      {
+        return (static_cast<std::uint64_t> (ijk0) +
+                static_cast<std::uint64_t> (ijk1) * static_cast<std::uint64_t> (divb_mul_[1]) +
+                static_cast<std::uint64_t> (ijk2) * static_cast<std::uint64_t> (divb_mul_[2]));
+      }
+
+      /** \brief Compute the position in \a leaf_layout_ of the leaf at absolute grid coordinates \a ijk.
+        * \param[in] ijk the grid coordinates, the fourth one is ignored
+        */
+      inline std::int64_t
+      getLeafLayoutIndex (const Eigen::Vector4i &ijk) const
+      {
+        return ((ijk - min_b_).template cast<std::int64_t> ().dot (divb_mul_));
+      }
+
+      /** \brief Check that a leaf layout was saved by the last filtering, printing an error otherwise.
+        * \param[in] method the name of the calling method, for the error message
+        */
+      inline bool
+      checkLeafLayout (const char *method) const
+      {
+        if (!leaf_layout_.empty ())
+          return (true);
+        PCL_ERROR ("[pcl::%s::%s] No leaf layout is saved, make sure to call setSaveLeafLayout(true) and filter(output) first! Grids with more than 2^31 leaves have no leaf layout.\n", getClassName ().c_str (), method);
+        return (false);
+      }
+
       /** \brief Downsample a Point Cloud using a voxelized grid approach
         * \param[out] output the resultant point cloud
         */
@@ -0,0 +1,218 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#pragma once
+
+#include <pcl/common/centroid.h>
+#include <pcl/memory.h>
+#include <pcl/pcl_macros.h>
+#include <pcl/point_cloud.h>
+#include <pcl/types.h>
+
+#include <unordered_map>
+
+namespace pcl
+{
+  /** \brief VoxelGridAccumulator downsamples a stream of point clouds, which are added one after the other.
+    *
+    * The class uses the same leaf layout as \ref VoxelGrid: a point with coordinates (x, y, z) falls into the
+    * leaf (floor (x / lx), floor (y / ly), floor (z / lz)). Instead of storing the points, every occupied leaf
+    * keeps the running sums needed to compute its centroid, so that adding a cloud costs O(n) for n new points,
+    * regardless of the number of points accumulated so far. After adding several clouds, \ref getCentroids
+    * returns the same voxels and centroids as a \ref VoxelGrid run on the concatenation of all the clouds.
+    *
+    * Leaves that are no longer of interest, e.g. because the sensor moved away, can be dropped with
+    * \ref evictOutside.
+    *
+    * \ingroup filters
+    */
+  template <typename PointT>
+  class VoxelGridAccumulator
+  {
+    public:
+      using PointCloud = pcl::PointCloud<PointT>;
+
+      using Ptr = shared_ptr<VoxelGridAccumulator<PointT> >;
+      using ConstPtr = shared_ptr<const VoxelGridAccumulator<PointT> >;
+
+      /** \brief Empty constructor. */
+      VoxelGridAccumulator () :
+        leaf_size_ (Eigen::Vector4f::Ones ()),
+        inverse_leaf_size_ (Eigen::Array4f::Ones ()),
+        downsample_all_data_ (true),
+        min_points_per_voxel_ (0)
+      {
+      }
+
+      /** \brief Set the voxel grid leaf size.
+        * \note Changing the leaf size drops all the accumulated leaves.
+        * \param[in] lx the leaf size for X
+        * \param[in] ly the leaf size for Y
+        * \param[in] lz the leaf size for Z
+        */
+      inline void
+      setLeafSize (float lx, float ly, float lz)
+      {
+        leaf_size_ = Eigen::Vector4f (lx, ly, lz, 1.0f);
+        // Use multiplications instead of divisions
+        inverse_leaf_size_ = Eigen::Array4f::Ones () / leaf_size_.array ();
+        clear ();
+      }
+
+      /** \brief Get the voxel grid leaf size. */
+      inline Eigen::Vector3f
+      getLeafSize () const { return (leaf_size_.head<3> ()); }
+
+      /** \brief Set to true if all fields need to be downsampled, or false if just XYZ.
+        * \param[in] downsample the new value (true/false)
+        */
+      inline void
+      setDownsampleAllData (bool downsample) { downsample_all_data_ = downsample; }
+
+      /** \brief Get the state of the internal downsampling parameter (true if
+        * all fields need to be downsampled, false if just XYZ).
+        */
+      inline bool
+      getDownsampleAllData () const { return (downsample_all_data_); }
+
+      /** \brief Set the minimum number of points required for a voxel to be returned by \ref getCentroids.
+        * \param[in] min_points_per_voxel the minimum number of points for required for a voxel to be used
+        */
+      inline void
+      setMinimumPointsNumberPerVoxel (unsigned int min_points_per_voxel) { min_points_per_voxel_ = min_points_per_voxel; }
+
+      /** \brief Return the minimum number of points required for a voxel to be returned by \ref getCentroids. */
+      inline unsigned int
+      getMinimumPointsNumberPerVoxel () const { return (min_points_per_voxel_); }
+
+      /** \brief Add the points of a cloud to the accumulated leaves. Invalid points are skipped.
+        * \param[in] cloud the input point cloud
+        */
+      void
+      addCloud (const PointCloud &cloud);
+
+      /** \brief Add a subset of the points of a cloud to the accumulated leaves. Invalid points are skipped.
+        * \param[in] cloud the input point cloud
+        * \param[in] indices the indices of the points of \a cloud to add
+        */
+      void
+      addCloud (const PointCloud &cloud, const Indices &indices);
+
+      /** \brief Get the centroids of all the leaves containing at least \ref getMinimumPointsNumberPerVoxel points.
+        * \note The order of the centroids is unspecified.
+        * \param[out] output the resultant downsampled point cloud
+        */
+      void
+      getCentroids (PointCloud &output) const;
+
+      /** \brief Drop all the leaves whose center lies outside of an axis aligned box.
+        * \param[in] min_pt the minimum corner of the box
+        * \param[in] max_pt the maximum corner of the box
+        * \return the number of leaves that were dropped
+        */
+      std::size_t
+      evictOutside (const Eigen::Vector4f &min_pt, const Eigen::Vector4f &max_pt);
+
+      /** \brief Get the number of occupied leaves. */
+      inline std::size_t
+      getNumberOfLeaves () const { return (leaves_.size ()); }
+
+      /** \brief Get the total number of points accumulated in the occupied leaves. */
+      std::size_t
+      getNumberOfPoints () const;
+
+      /** \brief Drop all the accumulated leaves. */
+      inline void
+      clear () { leaves_.clear (); }
+
+      /** \brief Get the grid coordinates of the leaf a point falls into.
+        * \param[in] x the X point coordinate
+        * \param[in] y the Y point coordinate
+        * \param[in] z the Z point coordinate
+        */
+      inline Eigen::Vector3i
+      getGridCoordinates (float x, float y, float z) const
+      {
+        return (Eigen::Vector3i (static_cast<int> (std::floor (x * inverse_leaf_size_[0])),
+                                 static_cast<int> (std::floor (y * inverse_leaf_size_[1])),
+                                 static_cast<int> (std::floor (z * inverse_leaf_size_[2]))));
+      }
+
+    protected:
+      /** \brief Hash functor for the grid coordinates of a leaf. */
+      struct LeafHash
+      {
+        inline std::size_t
+        operator() (const Eigen::Vector3i &ijk) const
+        {
+          return (static_cast<std::size_t> (ijk[0]) * 73856093u ^
+                  static_cast<std::size_t> (ijk[1]) * 19349663u ^
+                  static_cast<std::size_t> (ijk[2]) * 83492791u);
+        }
+      };
+
+      /** \brief Add a single valid point to its leaf. */
+      inline void
+      addPoint (const PointT &point)
+      {
+        leaves_[getGridCoordinates (point.x, point.y, point.z)].add (point);
+      }
+
+      /** \brief The size of a leaf. */
+      Eigen::Vector4f leaf_size_;
+
+      /** \brief Internal leaf sizes stored as 1/leaf_size_ for efficiency reasons. */
+      Eigen::Array4f inverse_leaf_size_;
+
+      /** \brief Set to true if all fields need to be downsampled, or false if just XYZ. */
+      bool downsample_all_data_;
+
+      /** \brief Minimum number of points per voxel for the centroid to be returned */
+      unsigned int min_points_per_voxel_;
+
+      /** \brief The running centroid accumulators of the occupied leaves, indexed by their grid coordinates. */
+      std::unordered_map<Eigen::Vector3i, CentroidPoint<PointT>, LeafHash, std::equal_to<Eigen::Vector3i>,
+                         Eigen::aligned_allocator<std::pair<const Eigen::Vector3i, CentroidPoint<PointT> > > > leaves_;
+
+    public:
+      PCL_MAKE_ALIGNED_OPERATOR_NEW
+  };
+}
+
+#ifdef PCL_NO_PRECOMPILE
+#include <pcl/filters/impl/voxel_grid_accumulator.hpp>
+#endif
@@ -73,6 +73,7 @@ namespace pcl
       using VoxelGrid<PointT>::inverse_leaf_size_;
       using VoxelGrid<PointT>::div_b_;
       using VoxelGrid<PointT>::divb_mul_;
+      using VoxelGrid<PointT>::getLinearLeafIndex;
 
 
       using FieldList = typename pcl::traits::fieldList<PointT>::type;
@@ -296,7 +297,7 @@ namespace pcl
        * \return const pointer to leaf structure
        */
       inline LeafConstPtr
-      getLeaf (int index)
+      getLeaf (std::size_t index)
       {
         typename std::map<std::size_t, Leaf>::iterator leaf_iter = leaves_.find (index);
         if (leaf_iter != leaves_.end ())
@@ -320,7 +321,7 @@ namespace pcl
         int ijk2 = static_cast<int> (std::floor (p.z * inverse_leaf_size_[2]) - min_b_[2]);
 
         // Compute the centroid leaf index
-        int idx = ijk0 * divb_mul_[0] + ijk1 * divb_mul_[1] + ijk2 * divb_mul_[2];
+        const std::size_t idx = getLinearLeafIndex (ijk0, ijk1, ijk2);
 
         // Find leaf associated with index
         typename std::map<std::size_t, Leaf>::iterator leaf_iter = leaves_.find (idx);
@@ -346,7 +347,7 @@ namespace pcl
         int ijk2 = static_cast<int> (std::floor (p[2] * inverse_leaf_size_[2]) - min_b_[2]);
 
         // Compute the centroid leaf index
-        int idx = ijk0 * divb_mul_[0] + ijk1 * divb_mul_[1] + ijk2 * divb_mul_[2];
+        const std::size_t idx = getLinearLeafIndex (ijk0, ijk1, ijk2);
 
         // Find leaf associated with index
         typename std::map<std::size_t, Leaf>::iterator leaf_iter = leaves_.find (idx);
@@ -573,7 +574,7 @@ namespace pcl
       PointCloudPtr voxel_centroids_;
 
       /** \brief Indices of leaf structurs associated with each point in \ref voxel_centroids_ (used for searching). */
-      std::vector<int> voxel_centroids_leaf_indices_;
+      std::vector<std::size_t> voxel_centroids_leaf_indices_;
 
       /** \brief KdTree generated using \ref voxel_centroids_ (used for searching). */
       KdTreeFLANN<PointT> kdtree_;
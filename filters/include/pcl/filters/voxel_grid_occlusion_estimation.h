@@ -60,6 +60,7 @@ namespace pcl
       using VoxelGrid<PointT>::div_b_;
       using VoxelGrid<PointT>::leaf_size_;
       using VoxelGrid<PointT>::inverse_leaf_size_;
+      using VoxelGrid<PointT>::threads_;
 
       using PointCloud = typename Filter<PointT>::PointCloud;
       using PointCloudPtr = typename PointCloud::Ptr;
@@ -111,8 +112,38 @@ namespace pcl
                            std::vector<Eigen::Vector3i, Eigen::aligned_allocator<Eigen::Vector3i> >& out_ray,
                            const Eigen::Vector3i& in_target_voxel);
 
+      /** \brief Computes the states (free = 0, occluded = 1) of a batch of target
+        * voxels. The rays are traversed in parallel with the number of threads set by
+        * \ref setNumberOfThreads.
+        * \param[out] out_states The state of every target voxel, -1 if its ray does
+        * not intersect with the bounding box.
+        * \param[in] in_target_voxels The target voxel coordinates (i, j, k).
+        * \return 0 upon success and -1 if an error occurs
+        */
+      int
+      occlusionEstimation (std::vector<int>& out_states,
+                           const std::vector<Eigen::Vector3i, Eigen::aligned_allocator<Eigen::Vector3i> >& in_target_voxels);
+
+      /** \brief Computes the states (free = 0, occluded = 1) of a batch of target
+        * voxels and the voxels penetrated by their rays. The rays are traversed in
+        * parallel with the number of threads set by \ref setNumberOfThreads.
+        * \param[out] out_states The state of every target voxel, -1 if its ray does
+        * not intersect with the bounding box.
+        * \param[out] out_rays The voxels penetrated by all rays, one ray after the other.
+        * \param[out] out_ray_offsets The voxels of ray i are out_rays[out_ray_offsets[i]]
+        * up to out_rays[out_ray_offsets[i + 1]] (exclusive), one more element than rays.
+        * \param[in] in_target_voxels The target voxel coordinates (i, j, k).
+        * \return 0 upon success and -1 if an error occurs
+        */
+      int
+      occlusionEstimation (std::vector<int>& out_states,
+                           std::vector<Eigen::Vector3i, Eigen::aligned_allocator<Eigen::Vector3i> >& out_rays,
+                           std::vector<std::size_t>& out_ray_offsets,
+                           const std::vector<Eigen::Vector3i, Eigen::aligned_allocator<Eigen::Vector3i> >& in_target_voxels);
+
       /** \brief Computes the voxel coordinates (i, j, k) of all occluded
-        * voxels in the voxel grid.
+        * voxels in the voxel grid. The voxels are processed in parallel with the number
+        * of threads set by \ref setNumberOfThreads.
         * \param[out] occluded_voxels the coordinates (i, j, k) of all occluded voxels
         * \return 0 upon success and -1 if an error occurs
         */
@@ -167,6 +198,18 @@ namespace pcl
 
     protected:
 
+      /** \brief Computes the direction and the entry scaling value of the ray from the
+        * sensor origin to a target voxel.
+        * \param[in] target_voxel The target voxel in the voxel grid with coordinate (i, j, k).
+        * \param[out] direction The normalized ray direction.
+        * \param[out] t_min The scaling value (tmin).
+        * \return false if the ray does not intersect with the bounding box
+        */
+      bool
+      initRay (const Eigen::Vector3i& target_voxel,
+               Eigen::Vector4f& direction,
+               float& t_min);
+
       /** \brief Returns the scaling value (tmin) were the ray intersects with the
         * voxel grid bounding box. (p_entry = origin + tmin * orientation)
         * \param[in] origin The sensor origin
@@ -40,6 +40,61 @@
 
 #include <pcl/filters/impl/extract_indices.hpp>
 
+#include <bitset>
+#include <cstdint>
+
+///////////////////////////////////////////////////////////////////////////////////////////
+void
+pcl::detail::complementIndices (const Indices &indices, std::size_t nr_points, Indices &complement)
+{
+  // Mark the given indices
+  const std::ptrdiff_t nr_words = static_cast<std::ptrdiff_t> ((nr_points + 63) / 64);
+  std::vector<std::uint64_t> marked (nr_words, 0);
+  for (const auto &index : indices)
+    if (static_cast<std::size_t> (index) < nr_points)  // also rejects negative indices
+      marked[index >> 6] |= std::uint64_t (1) << (index & 63);
+  // Mark the padding bits of the last word, so that they are not reported
+  if (nr_points % 64 != 0)
+    marked.back () |= ~std::uint64_t (0) << (nr_points % 64);
+
+  // Count the unmarked bits of each block of words, then fill in the indices block by block
+  constexpr std::ptrdiff_t words_per_block = 1024;
+  const std::ptrdiff_t nr_blocks = (nr_words + words_per_block - 1) / words_per_block;
+  std::vector<std::size_t> offsets (nr_blocks + 1, 0);
+#pragma omp parallel for \
+  default(none) \
+  shared(marked, nr_blocks, nr_words, offsets, words_per_block) \
+  if(nr_blocks > 1)
+  for (std::ptrdiff_t block = 0; block < nr_blocks; ++block)
+  {
+    std::size_t count = 0;
+    const std::ptrdiff_t end = std::min (nr_words, (block + 1) * words_per_block);
+    for (std::ptrdiff_t w = block * words_per_block; w < end; ++w)
+      count += 64 - std::bitset<64> (marked[w]).count ();
+    offsets[block + 1] = count;
+  }
+  for (std::ptrdiff_t block = 0; block < nr_blocks; ++block)
+    offsets[block + 1] += offsets[block];
+
+  complement.resize (offsets.back ());
+#pragma omp parallel for \
+  default(none) \
+  shared(complement, marked, nr_blocks, nr_words, offsets, words_per_block) \
+  if(nr_blocks > 1)
+  for (std::ptrdiff_t block = 0; block < nr_blocks; ++block)
+  {
+    std::size_t out = offsets[block];
+    const std::ptrdiff_t end = std::min (nr_words, (block + 1) * words_per_block);
+    for (std::ptrdiff_t w = block * words_per_block; w < end; ++w)
+    {
+      std::uint64_t unmarked = ~marked[w];
+      for (index_t bit = 0; unmarked != 0; ++bit, unmarked >>= 1)
+        if (unmarked & 1)
+          complement[out++] = static_cast<index_t> (w * 64) + bit;
+    }
+  }
+}
+
 ///////////////////////////////////////////////////////////////////////////////////////////
 void
 pcl::ExtractIndices<pcl::PCLPointCloud2>::applyFilter (PCLPointCloud2 &output)
@@ -57,18 +112,9 @@ pcl::ExtractIndices<pcl::PCLPointCloud2>::applyFilter (PCLPointCloud2 &output)
     }
     else
     {
-      // Prepare a vector holding all indices
-      Indices all_indices (input_->width * input_->height);
-      for (index_t i = 0; i < static_cast<index_t>(all_indices.size ()); ++i)
-        all_indices[i] = i;
-
-      Indices indices = *indices_;
-      std::sort (indices.begin (), indices.end ());
-
       // Get the diference
       Indices remaining_indices;
-      set_difference (all_indices.begin (), all_indices.end (), indices.begin (), indices.end (),
-                      inserter (remaining_indices, remaining_indices.begin ()));
+      detail::complementIndices (*indices_, input_->width * input_->height, remaining_indices);
 
       // Prepare the output and copy the data
       for (const auto &remaining_index : remaining_indices)
@@ -110,35 +156,27 @@ pcl::ExtractIndices<pcl::PCLPointCloud2>::applyFilter (PCLPointCloud2 &output)
   // TODO: check the output cloud and assign is_dense based on whether the points are valid or not
   output.is_dense     = false;
 
+  Indices remaining_indices;
   if (negative_)
   {
-    // Prepare a vector holding all indices
-    Indices all_indices (input_->width * input_->height);
-    for (index_t i = 0; i < static_cast<index_t>(all_indices.size ()); ++i)
-      all_indices[i] = i;
-
-    Indices indices = *indices_;
-    std::sort (indices.begin (), indices.end ());
-
     // Get the diference
-    Indices remaining_indices;
-    set_difference (all_indices.begin (), all_indices.end (), indices.begin (), indices.end (),
-                    inserter (remaining_indices, remaining_indices.begin ()));
-
-    // Prepare the output and copy the data
-    output.width = remaining_indices.size ();
-    output.data.resize (remaining_indices.size () * output.point_step);
-    for (std::size_t i = 0; i < remaining_indices.size (); ++i)
-      memcpy (&output.data[i * output.point_step], &input_->data[remaining_indices[i] * output.point_step], output.point_step);
-  }
-  else
-  {
-    // Prepare the output and copy the data
-    output.width = indices_->size ();
-    output.data.resize (indices_->size () * output.point_step);
-    for (std::size_t i = 0; i < indices_->size (); ++i)
-      memcpy (&output.data[i * output.point_step], &input_->data[(*indices_)[i] * output.point_step], output.point_step);
+    detail::complementIndices (*indices_, input_->width * input_->height, remaining_indices);
   }
+  const Indices &selected_indices = (negative_ ? remaining_indices : *indices_);
+
+  // Prepare the output and copy the data
+  output.width = selected_indices.size ();
+  output.data.resize (selected_indices.size () * output.point_step);
+  const std::ptrdiff_t nr_selected = selected_indices.size ();
+  const std::size_t point_step = output.point_step;
+  std::uint8_t* data_out = output.data.data ();
+  const std::uint8_t* data_in = input_->data.data ();
+#pragma omp parallel for \
+  default(none) \
+  shared(data_in, data_out, nr_selected, point_step, selected_indices) \
+  if(nr_selected >= 32768)
+  for (std::ptrdiff_t i = 0; i < nr_selected; ++i)
+    memcpy (data_out + i * point_step, data_in + selected_indices[i] * point_step, point_step);
   output.row_step = output.point_step * output.width;
 }
 
@@ -158,36 +196,14 @@ pcl::ExtractIndices<pcl::PCLPointCloud2>::applyFilter (Indices &indices)
   {
     indices = *indices_;
 
+    // Store the difference in removed_indices
     if (extract_removed_indices_)
-    {
-      // Set up the full indices set
-      Indices full_indices (input_->width * input_->height);
-      for (index_t fii = 0; fii < static_cast<index_t> (full_indices.size ()); ++fii)  // fii = full indices iterator
-        full_indices[fii] = fii;
-
-      // Set up the sorted input indices
-      Indices sorted_input_indices = *indices_;
-      std::sort (sorted_input_indices.begin (), sorted_input_indices.end ());
-
-      // Store the difference in removed_indices
-      removed_indices_->clear ();
-      std::set_difference (full_indices.begin (), full_indices.end (), sorted_input_indices.begin (), sorted_input_indices.end (), std::inserter (*removed_indices_, removed_indices_->begin ()));
-    }
+      detail::complementIndices (*indices_, input_->width * input_->height, *removed_indices_);
   }
   else  // Inverted functionality
   {
-    // Set up the full indices set
-    Indices full_indices (input_->width * input_->height);
-    for (index_t fii = 0; fii < static_cast<index_t> (full_indices.size ()); ++fii)  // fii = full indices iterator
-      full_indices[fii] = fii;
-
-    // Set up the sorted input indices
-    Indices sorted_input_indices = *indices_;
-    std::sort (sorted_input_indices.begin (), sorted_input_indices.end ());
-
     // Store the difference in indices
-    indices.clear ();
-    std::set_difference (full_indices.begin (), full_indices.end (), sorted_input_indices.begin (), sorted_input_indices.end (), std::inserter (indices, indices.begin ()));
+    detail::complementIndices (*indices_, input_->width * input_->height, indices);
 
     if (extract_removed_indices_)
       removed_indices_ = indices_;
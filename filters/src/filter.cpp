@@ -49,6 +49,8 @@
 void
 pcl::Filter<pcl::PCLPointCloud2>::filter (PCLPointCloud2 &output)
 {
+  PCL_TRACE_ZONE (filter_name_);
+
   if (!initCompute ())
     return;
 
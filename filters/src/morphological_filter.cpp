@@ -40,6 +40,103 @@
  */
 
 #include <pcl/filters/impl/morphological_filter.hpp>
+#include <pcl/console/print.h> // for PCL_ERROR
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+namespace
+{
+  /** \brief Sliding minimum (erode) or maximum (dilate) over 2 * half_size + 1 values of a line with the given
+    * stride, in place. The line is padded at both ends with the identity of the operation and split into blocks
+    * of the window width, each window then is the combination of the suffix of one block and the prefix of the
+    * next one.
+    */
+  void
+  vanHerkGilWerman (float *line, int length, int stride, int half_size, bool erode,
+                    std::vector<float> &padded, std::vector<float> &prefix, std::vector<float> &suffix)
+  {
+    const int width = 2 * half_size + 1;
+    const int padded_length = ((length + 2 * half_size + width - 1) / width) * width;
+    const float identity = erode ? std::numeric_limits<float>::infinity () : -std::numeric_limits<float>::infinity ();
+    const auto combine = [erode] (float a, float b) { return (erode ? std::min (a, b) : std::max (a, b)); };
+
+    padded.assign (padded_length, identity);
+    for (int i = 0; i < length; ++i)
+      padded[i + half_size] = line[i * stride];
+
+    prefix.resize (padded_length);
+    suffix.resize (padded_length);
+    for (int block = 0; block < padded_length; block += width)
+    {
+      prefix[block] = padded[block];
+      for (int j = block + 1; j < block + width; ++j)
+        prefix[j] = combine (prefix[j - 1], padded[j]);
+      suffix[block + width - 1] = padded[block + width - 1];
+      for (int j = block + width - 2; j >= block; --j)
+        suffix[j] = combine (suffix[j + 1], padded[j]);
+    }
+
+    // The window of the i-th value starts at padded[i]
+    for (int i = 0; i < length; ++i)
+      line[i * stride] = combine (suffix[i], prefix[i + width - 1]);
+  }
+
+  /** \brief Erode or dilate a grid in place, with one pass along the rows and one along the columns. */
+  void
+  erodeOrDilate (Eigen::MatrixXf &grid, int half_size, bool erode)
+  {
+    const float identity = erode ? std::numeric_limits<float>::infinity () : -std::numeric_limits<float>::infinity ();
+    for (Eigen::Index i = 0; i < grid.size (); ++i)
+      if (std::isnan (grid.data ()[i]))
+        grid.data ()[i] = identity;
+
+    std::vector<float> padded, prefix, suffix;
+    const int rows = static_cast<int> (grid.rows ());
+    const int cols = static_cast<int> (grid.cols ());
+    // Eigen matrices are column major: a row has stride rows, a column is contiguous
+    for (int row = 0; row < rows; ++row)
+      vanHerkGilWerman (grid.data () + row, cols, rows, half_size, erode, padded, prefix, suffix);
+    for (int col = 0; col < cols; ++col)
+      vanHerkGilWerman (grid.data () + col * rows, rows, 1, half_size, erode, padded, prefix, suffix);
+
+    for (Eigen::Index i = 0; i < grid.size (); ++i)
+      if (grid.data ()[i] == identity)
+        grid.data ()[i] = std::numeric_limits<float>::quiet_NaN ();
+  }
+}
+
+void
+pcl::applyMorphologicalOperator (const Eigen::MatrixXf &grid_in, int half_size,
+                                 const int morphological_operator, Eigen::MatrixXf &grid_out)
+{
+  grid_out = grid_in;
+  if (grid_in.size () == 0 || half_size <= 0)
+    return;
+
+  switch (morphological_operator)
+  {
+    case MORPH_DILATE:
+      erodeOrDilate (grid_out, half_size, false);
+      break;
+    case MORPH_ERODE:
+      erodeOrDilate (grid_out, half_size, true);
+      break;
+    case MORPH_OPEN:
+      erodeOrDilate (grid_out, half_size, true);
+      erodeOrDilate (grid_out, half_size, false);
+      break;
+    case MORPH_CLOSE:
+      erodeOrDilate (grid_out, half_size, false);
+      erodeOrDilate (grid_out, half_size, true);
+      break;
+    default:
+      PCL_ERROR ("Morphological operator is not supported!\n");
+      break;
+  }
+}
 
 #ifndef PCL_NO_PRECOMPILE
 #include <pcl/impl/instantiate.hpp>
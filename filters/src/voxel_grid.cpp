@@ -39,7 +39,9 @@
  */
 
 #include <iostream>
+#include <pcl/common/common.h>
 #include <pcl/common/io.h>
+#include <pcl/point_cloud_soa.h>
 #include <pcl/filters/impl/voxel_grid.hpp>
 #include <boost/sort/spreadsort/integer_sort.hpp>
 #include <array>
@@ -174,6 +176,190 @@ pcl::getMinMax3D (const pcl::PCLPointCloud2ConstPtr &cloud, int x_idx, int y_idx
   max_pt = max_p;
 }
 
+///////////////////////////////////////////////////////////////////////////////////////////
+namespace
+{
+  using SoAVoxelIndices = std::vector<cloud_point_leaf_index<std::uint64_t> >;
+  using SoAVoxels = std::vector<std::pair<std::size_t, std::size_t> >;
+
+  // Average a column of floating point values over the points of every voxel
+  template <typename T, typename AccumulatorT> void
+  averageColumn (const std::uint8_t *input, std::uint8_t *output, std::size_t count,
+                 const SoAVoxelIndices &index_vector, const SoAVoxels &voxels)
+  {
+    const T *src = reinterpret_cast<const T*> (input);
+    T *dst = reinterpret_cast<T*> (output);
+    std::vector<AccumulatorT> sum (count);
+    for (std::size_t v = 0; v < voxels.size (); ++v)
+    {
+      std::fill (sum.begin (), sum.end (), AccumulatorT (0));
+      for (std::size_t li = voxels[v].first; li < voxels[v].second; ++li)
+      {
+        const T *value = src + index_vector[li].cloud_point_index * count;
+        for (std::size_t e = 0; e < count; ++e)
+          sum[e] += value[e];
+      }
+      const auto nr_points = static_cast<AccumulatorT> (voxels[v].second - voxels[v].first);
+      for (std::size_t e = 0; e < count; ++e)
+        dst[v * count + e] = static_cast<T> (sum[e] / nr_points);
+    }
+  }
+
+  // Average a packed rgb(a) column per color channel over the points of every voxel
+  void
+  averageColorColumn (const std::uint8_t *input, std::uint8_t *output,
+                      const SoAVoxelIndices &index_vector, const SoAVoxels &voxels)
+  {
+    for (std::size_t v = 0; v < voxels.size (); ++v)
+    {
+      float r = 0, g = 0, b = 0, a = 0;
+      for (std::size_t li = voxels[v].first; li < voxels[v].second; ++li)
+      {
+        std::uint32_t rgba;
+        memcpy (&rgba, input + index_vector[li].cloud_point_index * sizeof (std::uint32_t), sizeof (std::uint32_t));
+        a += static_cast<float> ((rgba >> 24) & 0xff);
+        r += static_cast<float> ((rgba >> 16) & 0xff);
+        g += static_cast<float> ((rgba >>  8) & 0xff);
+        b += static_cast<float> (rgba & 0xff);
+      }
+      const auto n = static_cast<float> (voxels[v].second - voxels[v].first);
+      const std::uint32_t rgba = static_cast<std::uint32_t> (a / n) << 24 |
+                                 static_cast<std::uint32_t> (r / n) << 16 |
+                                 static_cast<std::uint32_t> (g / n) <<  8 |
+                                 static_cast<std::uint32_t> (b / n);
+      memcpy (output + v * sizeof (std::uint32_t), &rgba, sizeof (std::uint32_t));
+    }
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+void
+pcl::voxelGridFilter (const pcl::PointCloudSoA &input, pcl::PointCloudSoA &output,
+                      const Eigen::Vector3f &leaf_size, unsigned int min_points_per_voxel,
+                      bool downsample_all_data)
+{
+  const float *x = input.getFieldData<float> ("x");
+  const float *y = input.getFieldData<float> ("y");
+  const float *z = input.getFieldData<float> ("z");
+  // If fields x/y/z are not present, we cannot downsample
+  if (!x || !y || !z)
+  {
+    PCL_ERROR ("[pcl::voxelGridFilter] Input dataset doesn't have FLOAT32 x-y-z columns!\n");
+    output = pcl::PointCloudSoA ();
+    return;
+  }
+
+  // Build the result separately, so that input and output may be the same cloud
+  pcl::PointCloudSoA result;
+  result.header = input.header;
+  const std::vector<pcl::PCLPointField> &fields = input.getFields ();
+  std::vector<int> columns;
+  if (downsample_all_data)
+    for (std::size_t d = 0; d < fields.size (); ++d)
+      columns.push_back (static_cast<int> (d));
+  else
+    columns = {input.getFieldIndex ("x"), input.getFieldIndex ("y"), input.getFieldIndex ("z")};
+  for (const int column : columns)
+    result.addField (fields[column].name, fields[column].datatype, fields[column].count);
+
+  Eigen::Vector4f min_p, max_p;
+  pcl::getMinMax3D (input, min_p, max_p);
+  // No valid points at all
+  if (input.empty () || min_p[0] > max_p[0])
+  {
+    output = std::move (result);
+    return;
+  }
+
+  const Eigen::Array3f inverse_leaf_size = leaf_size.array ().inverse ();
+
+  // Check that the leaf size is not too small, given the size of the data
+  std::int64_t dx = static_cast<std::int64_t>((max_p[0] - min_p[0]) * inverse_leaf_size[0])+1;
+  std::int64_t dy = static_cast<std::int64_t>((max_p[1] - min_p[1]) * inverse_leaf_size[1])+1;
+  std::int64_t dz = static_cast<std::int64_t>((max_p[2] - min_p[2]) * inverse_leaf_size[2])+1;
+
+  const double nr_leaves = static_cast<double> (dx) * static_cast<double> (dy) * static_cast<double> (dz);
+  if (nr_leaves > static_cast<double> (std::numeric_limits<std::uint64_t>::max ()))
+  {
+    PCL_WARN ("[pcl::voxelGridFilter] Leaf size is too small for the input dataset. Integer indices would overflow.\n");
+    output = input;
+    return;
+  }
+
+  // Compute the minimum and maximum bounding box values
+  Eigen::Array3i min_b, max_b;
+  for (int d = 0; d < 3; ++d)
+  {
+    min_b[d] = static_cast<int> (std::floor (min_p[d] * inverse_leaf_size[d]));
+    max_b[d] = static_cast<int> (std::floor (max_p[d] * inverse_leaf_size[d]));
+  }
+  // Compute the number of divisions needed along all axis
+  const Eigen::Array3i div_b = max_b - min_b + Eigen::Array3i::Ones ();
+  const std::uint64_t divb_mul1 = static_cast<std::uint64_t> (div_b[0]);
+  const std::uint64_t divb_mul2 = static_cast<std::uint64_t> (div_b[0]) * static_cast<std::uint64_t> (div_b[1]);
+
+  // First pass: compute the leaf index of every valid point, reading only the x, y, z columns
+  SoAVoxelIndices index_vector;
+  index_vector.reserve (input.size ());
+  for (std::size_t i = 0; i < input.size (); ++i)
+  {
+    if (!input.is_dense)
+      // Check if the point is invalid
+      if (!std::isfinite (x[i]) || !std::isfinite (y[i]) || !std::isfinite (z[i]))
+        continue;
+
+    int ijk0 = static_cast<int> (std::floor (x[i] * inverse_leaf_size[0]) - static_cast<float> (min_b[0]));
+    int ijk1 = static_cast<int> (std::floor (y[i] * inverse_leaf_size[1]) - static_cast<float> (min_b[1]));
+    int ijk2 = static_cast<int> (std::floor (z[i] * inverse_leaf_size[2]) - static_cast<float> (min_b[2]));
+    const std::uint64_t idx = static_cast<std::uint64_t> (ijk0) +
+                              static_cast<std::uint64_t> (ijk1) * divb_mul1 +
+                              static_cast<std::uint64_t> (ijk2) * divb_mul2;
+    index_vector.emplace_back (idx, static_cast<unsigned int> (i));
+  }
+
+  // Second pass: sort the index_vector vector using value representing target cell as index
+  // in effect all points belonging to the same output cell will be next to each other
+  auto rightshift_func = [](const cloud_point_leaf_index<std::uint64_t> &p, const unsigned offset) { return p.idx >> offset; };
+  boost::sort::spreadsort::integer_sort (index_vector.begin (), index_vector.end (), rightshift_func);
+
+  // Third pass: find the first and last index_vector entry of every output voxel
+  SoAVoxels voxels;
+  std::size_t index = 0;
+  while (index < index_vector.size ())
+  {
+    std::size_t i = index + 1;
+    while (i < index_vector.size () && index_vector[i].idx == index_vector[index].idx)
+      ++i;
+    if (i - index >= min_points_per_voxel)
+      voxels.emplace_back (index, i);
+    index = i;
+  }
+
+  // Fourth pass: reduce the voxels one column at a time
+  result.resize (voxels.size ());
+  for (std::size_t c = 0; c < columns.size (); ++c)
+  {
+    const pcl::PCLPointField &field = fields[columns[c]];
+    const std::size_t element_size = input.getElementSize (columns[c]);
+    const std::size_t count = std::max<uindex_t> (field.count, 1);
+    const std::uint8_t *src = input.getFieldData (columns[c]);
+    std::uint8_t *dst = result.getFieldData (static_cast<int> (c));
+
+    if ((field.name == "rgb" || field.name == "rgba") && element_size == sizeof (std::uint32_t))
+      averageColorColumn (src, dst, index_vector, voxels);
+    else if (field.datatype == pcl::PCLPointField::FLOAT32)
+      averageColumn<float, float> (src, dst, count, index_vector, voxels);
+    else if (field.datatype == pcl::PCLPointField::FLOAT64)
+      averageColumn<double, double> (src, dst, count, index_vector, voxels);
+    else
+      for (std::size_t v = 0; v < voxels.size (); ++v)
+        memcpy (dst + v * element_size, src + index_vector[voxels[v].first].cloud_point_index * element_size, element_size);
+  }
+  result.is_dense = true;                 // we filter out invalid points
+
+  output = std::move (result);
+}
+
 ///////////////////////////////////////////////////////////////////////////////////////////
 void
 pcl::VoxelGrid<pcl::PCLPointCloud2>::applyFilter (PCLPointCloud2 &output)
@@ -228,12 +414,21 @@ pcl::VoxelGrid<pcl::PCLPointCloud2>::applyFilter (PCLPointCloud2 &output)
   std::int64_t dy = static_cast<std::int64_t>((max_p[1] - min_p[1]) * inverse_leaf_size_[1])+1;
   std::int64_t dz = static_cast<std::int64_t>((max_p[2] - min_p[2]) * inverse_leaf_size_[2])+1;
 
-  if( (dx*dy*dz) > static_cast<std::int64_t>(std::numeric_limits<std::int32_t>::max()) )
+  const double nr_leaves = static_cast<double> (dx) * static_cast<double> (dy) * static_cast<double> (dz);
+  if (nr_leaves > static_cast<double> (std::numeric_limits<std::uint64_t>::max ()))
   {
     PCL_WARN("[pcl::%s::applyFilter] Leaf size is too small for the input dataset. Integer indices would overflow.\n", getClassName().c_str());
-    //output.width = output.height = 0;
-    //output.data.clear();
-    //return;
+    output.width = output.height = 0;
+    output.data.clear();
+    return;
+  }
+  // The leaf layout can only be saved for grids that 32 bit indices can address
+  bool save_leaf_layout = save_leaf_layout_;
+  if (save_leaf_layout && nr_leaves > static_cast<double> (std::numeric_limits<std::int32_t>::max ()))
+  {
+    PCL_WARN ("[pcl::%s::applyFilter] The leaf layout can not be saved for grids with more than %d leaves.\n", getClassName ().c_str (), std::numeric_limits<std::int32_t>::max ());
+    leaf_layout_.clear ();
+    save_leaf_layout = false;
   }
 
   // Compute the minimum and maximum bounding box values
@@ -248,7 +443,8 @@ pcl::VoxelGrid<pcl::PCLPointCloud2>::applyFilter (PCLPointCloud2 &output)
   div_b_ = max_b_ - min_b_ + Eigen::Vector4i::Ones ();
   div_b_[3] = 0;
 
-  std::vector<cloud_point_index_idx> index_vector;
+  // 64 bit leaf indices, so that grids with more than 2^31 leaves are addressed correctly
+  std::vector<cloud_point_leaf_index<std::uint64_t> > index_vector;
   index_vector.reserve (nr_points);
 
   // Create the first xyz_offset, and set up the division multiplier
@@ -256,7 +452,7 @@ pcl::VoxelGrid<pcl::PCLPointCloud2>::applyFilter (PCLPointCloud2 &output)
                            input_->fields[y_idx_].offset,
                            input_->fields[z_idx_].offset,
                            0);
-  divb_mul_ = Eigen::Vector4i (1, div_b_[0], div_b_[0] * div_b_[1], 0);
+  divb_mul_ = Eigen::Matrix<std::int64_t, 4, 1> (1, div_b_[0], static_cast<std::int64_t> (div_b_[0]) * div_b_[1], 0);
   Eigen::Vector4f pt  = Eigen::Vector4f::Zero ();
 
   int centroid_size = 4;
@@ -341,7 +537,7 @@ pcl::VoxelGrid<pcl::PCLPointCloud2>::applyFilter (PCLPointCloud2 &output)
       int ijk1 = static_cast<int> (std::floor (pt[1] * inverse_leaf_size_[1]) - min_b_[1]);
       int ijk2 = static_cast<int> (std::floor (pt[2] * inverse_leaf_size_[2]) - min_b_[2]);
       // Compute the centroid leaf index
-      int idx = ijk0 * divb_mul_[0] + ijk1 * divb_mul_[1] + ijk2 * divb_mul_[2];
+      const std::uint64_t idx = getLinearLeafIndex (ijk0, ijk1, ijk2);
       index_vector.emplace_back(idx, static_cast<unsigned int> (cp));
 
       xyz_offset += input_->point_step;
@@ -371,7 +567,7 @@ pcl::VoxelGrid<pcl::PCLPointCloud2>::applyFilter (PCLPointCloud2 &output)
       int ijk1 = static_cast<int> (std::floor (pt[1] * inverse_leaf_size_[1]) - min_b_[1]);
       int ijk2 = static_cast<int> (std::floor (pt[2] * inverse_leaf_size_[2]) - min_b_[2]);
       // Compute the centroid leaf index
-      int idx = ijk0 * divb_mul_[0] + ijk1 * divb_mul_[1] + ijk2 * divb_mul_[2];
+      const std::uint64_t idx = getLinearLeafIndex (ijk0, ijk1, ijk2);
       index_vector.emplace_back(idx, static_cast<unsigned int> (cp));
       xyz_offset += input_->point_step;
     }
@@ -379,7 +575,7 @@ pcl::VoxelGrid<pcl::PCLPointCloud2>::applyFilter (PCLPointCloud2 &output)
 
   // Second pass: sort the index_vector vector using value representing target cell as index
   // in effect all points belonging to the same output cell will be next to each other
-  auto rightshift_func = [](const cloud_point_index_idx &x, const unsigned offset) { return x.idx >> offset; };
+  auto rightshift_func = [](const cloud_point_leaf_index<std::uint64_t> &x, const unsigned offset) { return x.idx >> offset; };
   boost::sort::spreadsort::integer_sort(index_vector.begin(), index_vector.end(), rightshift_func);
 
   // Third pass: count output cells
@@ -410,7 +606,7 @@ pcl::VoxelGrid<pcl::PCLPointCloud2>::applyFilter (PCLPointCloud2 &output)
   output.row_step = output.point_step * output.width;
   output.data.resize (output.width * output.point_step);
 
-  if (save_leaf_layout_) 
+  if (save_leaf_layout) 
   {
     try
     {
@@ -457,7 +653,7 @@ pcl::VoxelGrid<pcl::PCLPointCloud2>::applyFilter (PCLPointCloud2 &output)
     index_t last_index = cp.second;
 
     // index is centroid final position in resulting PointCloud
-    if (save_leaf_layout_)
+    if (save_leaf_layout)
       leaf_layout_[index_vector[first_index].idx] = index;
 
     //Limit downsampling to coords
@@ -69,12 +69,21 @@ pcl::VoxelGridLabel::applyFilter (PointCloud &output)
   std::int64_t dy = static_cast<std::int64_t>((max_p[1] - min_p[1]) * inverse_leaf_size_[1])+1;
   std::int64_t dz = static_cast<std::int64_t>((max_p[2] - min_p[2]) * inverse_leaf_size_[2])+1;
 
-  if( (dx*dy*dz) > static_cast<std::int64_t>(std::numeric_limits<std::int32_t>::max()) )
+  const double nr_leaves = static_cast<double> (dx) * static_cast<double> (dy) * static_cast<double> (dz);
+  if (nr_leaves > static_cast<double> (std::numeric_limits<std::uint64_t>::max ()))
   {
     PCL_WARN("[pcl::%s::applyFilter] Leaf size is too small for the input dataset. Integer indices would overflow.\n", getClassName().c_str());
     output.clear();
     return;
   }
+  // The leaf layout can only be saved for grids that 32 bit indices can address
+  bool save_leaf_layout = save_leaf_layout_;
+  if (save_leaf_layout && nr_leaves > static_cast<double> (std::numeric_limits<std::int32_t>::max ()))
+  {
+    PCL_WARN ("[pcl::%s::applyFilter] The leaf layout can not be saved for grids with more than %d leaves.\n", getClassName ().c_str (), std::numeric_limits<std::int32_t>::max ());
+    leaf_layout_.clear ();
+    save_leaf_layout = false;
+  }
 
   // Compute the minimum and maximum bounding box values
   min_b_[0] = static_cast<int> (std::floor (min_p[0] * inverse_leaf_size_[0]));
@@ -89,7 +98,7 @@ pcl::VoxelGridLabel::applyFilter (PointCloud &output)
   div_b_[3] = 0;
 
   // Set up the division multiplier
-  divb_mul_ = Eigen::Vector4i (1, div_b_[0], div_b_[0] * div_b_[1], 0);
+  divb_mul_ = Eigen::Matrix<std::int64_t, 4, 1> (1, div_b_[0], static_cast<std::int64_t> (div_b_[0]) * div_b_[1], 0);
 
   int centroid_size = 4;
   if (downsample_all_data_)
@@ -111,7 +120,8 @@ pcl::VoxelGridLabel::applyFilter (PointCloud &output)
   int label_index = -1;
   label_index = pcl::getFieldIndex<PointXYZRGBL> ("label", fields);
 
-  std::vector<cloud_point_index_idx> index_vector;
+  // 64 bit leaf indices, so that grids with more than 2^31 leaves are addressed correctly
+  std::vector<cloud_point_leaf_index<std::uint64_t> > index_vector;
   index_vector.reserve(input_->size());
 
   // If we don't want to process the entire cloud, but rather filter points far away from the viewpoint first...
@@ -158,8 +168,8 @@ pcl::VoxelGridLabel::applyFilter (PointCloud &output)
       int ijk2 = static_cast<int> (std::floor ((*input_)[cp].z * inverse_leaf_size_[2]) - min_b_[2]);
 
       // Compute the centroid leaf index
-      int idx = ijk0 * divb_mul_[0] + ijk1 * divb_mul_[1] + ijk2 * divb_mul_[2];
-      index_vector.emplace_back(static_cast<unsigned int> (idx), cp);
+      const std::uint64_t idx = getLinearLeafIndex (ijk0, ijk1, ijk2);
+      index_vector.emplace_back(idx, cp);
     }
   }
   // No distance filtering, process all data
@@ -182,14 +192,14 @@ pcl::VoxelGridLabel::applyFilter (PointCloud &output)
       int ijk2 = static_cast<int> (std::floor ((*input_)[cp].z * inverse_leaf_size_[2]) - min_b_[2]);
 
       // Compute the centroid leaf index
-      int idx = ijk0 * divb_mul_[0] + ijk1 * divb_mul_[1] + ijk2 * divb_mul_[2];
-      index_vector.emplace_back(static_cast<unsigned int> (idx), cp);
+      const std::uint64_t idx = getLinearLeafIndex (ijk0, ijk1, ijk2);
+      index_vector.emplace_back(idx, cp);
     }
   }
 
   // Second pass: sort the index_vector vector using value representing target cell as index
   // in effect all points belonging to the same output cell will be next to each other
-  std::sort (index_vector.begin (), index_vector.end (), std::less<cloud_point_index_idx> ());
+  std::sort (index_vector.begin (), index_vector.end (), std::less<cloud_point_leaf_index<std::uint64_t> > ());
 
   // Third pass: count output cells
   // we need to skip all the same, adjacenent idx values
@@ -206,7 +216,7 @@ pcl::VoxelGridLabel::applyFilter (PointCloud &output)
 
   // Fourth pass: compute centroids, insert them into their final position
   output.resize (total);
-  if (save_leaf_layout_)
+  if (save_leaf_layout)
   {
     try
     { 
@@ -303,7 +313,7 @@ pcl::VoxelGridLabel::applyFilter (PointCloud &output)
     }
 
     // index is centroid final position in resulting PointCloud
-    if (save_leaf_layout_)
+    if (save_leaf_layout)
       leaf_layout_[index_vector[cp].idx] = index;
 
     centroid /= static_cast<float> (i - cp);
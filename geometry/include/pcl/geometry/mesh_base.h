@@ -48,8 +48,10 @@
 #include <pcl/pcl_macros.h>
 #include <pcl/point_cloud.h>
 
+#include <algorithm>
+#include <cstdint>
+#include <limits>
 #include <type_traits>
-
 #include <vector>
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -211,6 +213,221 @@ public:
         vertices, face_data, edge_data, half_edge_data));
   }
 
+  /**
+   * \brief Add all faces of a face-vertex mesh at once, e.g. of a
+   * pcl::PolygonMeshBuffer. The vertices have to be added before.
+   *
+   * Instead of connecting the faces one by one, the half-edges of all faces are sorted
+   * by their first vertex with a counting sort, so that each half-edge finds its
+   * opposite one among the few half-edges leaving its second vertex. The connectivity
+   * is then written in a few passes over the faces and vertices, in parallel if
+   * \a nr_threads is larger than 1. The edges are numbered in the order in which the
+   * faces reference them first, as with addFace.
+   *
+   * This requires the faces to form a manifold mesh: each directed edge is used by
+   * one face at most, opposite edges have opposite directions and the faces around
+   * each vertex form a single fan. If this is not the case, if a face has a size the
+   * mesh does not accept or if the mesh has faces already, nothing is changed and
+   * false is returned. The faces can then be added one by one with addFace, which
+   * adds the faces it can (also to non-manifold meshes).
+   * \param[in] indices        The vertex indices of all faces, concatenated.
+   * \param[in] offsets        The position of the first vertex index of every face
+   * in \a indices, followed by indices.size ().
+   * \param[in] nr_threads     The number of threads.
+   * \param[in] face_data      Data that is set for all faces.
+   * \param[in] edge_data      Data that is set for all edges.
+   * \param[in] half_edge_data Data that is set for all half-edges.
+   * \return true if the faces were added.
+   */
+  bool
+  addFaces(const std::vector<std::uint32_t>& indices,
+           const std::vector<std::uint32_t>& offsets,
+           const unsigned int nr_threads = 1,
+           const FaceData& face_data = FaceData(),
+           const EdgeData& edge_data = EdgeData(),
+           const HalfEdgeData& half_edge_data = HalfEdgeData())
+  {
+    if (!half_edges_.empty() || !faces_.empty() || offsets.empty() ||
+        offsets.front() != 0 || offsets.back() != indices.size() ||
+        indices.size() > static_cast<std::size_t>(std::numeric_limits<int>::max() / 2))
+      return (false);
+    const std::ptrdiff_t nr_faces = static_cast<std::ptrdiff_t>(offsets.size()) - 1;
+    const std::size_t nr_vertices = vertices_.size();
+
+    // Check the faces and find the next corner of each face corner
+    std::vector<std::uint32_t> corner_next(indices.size());
+    bool valid = true;
+#pragma omp parallel for default(none) shared(indices, offsets, corner_next)           \
+    firstprivate(nr_faces, nr_vertices) reduction(&& : valid) num_threads(nr_threads)
+    for (std::ptrdiff_t f = 0; f < nr_faces; ++f) {
+      const std::uint32_t begin = offsets[f];
+      const std::uint32_t end = offsets[f + 1];
+      if (end < begin || !Derived::isValidFaceSize(end - begin)) {
+        valid = false;
+        continue;
+      }
+      for (std::uint32_t c = begin; c < end; ++c) {
+        if (indices[c] >= nr_vertices || std::find(indices.begin() + begin,
+                                                   indices.begin() + c,
+                                                   indices[c]) != indices.begin() + c)
+          valid = false;
+        corner_next[c] = c + 1 < end ? c + 1 : begin;
+      }
+    }
+    if (!valid)
+      return (false);
+
+    // Sort the corners by vertex (counting sort), the half-edges leaving each vertex
+    std::vector<std::uint32_t> vertex_offsets(nr_vertices + 1, 0);
+    for (const auto& index : indices)
+      ++vertex_offsets[index + 1];
+    for (std::size_t v = 0; v < nr_vertices; ++v)
+      vertex_offsets[v + 1] += vertex_offsets[v];
+    std::vector<std::uint32_t> vertex_corners(indices.size());
+    std::vector<std::uint32_t> vertex_targets(indices.size());
+    {
+      std::vector<std::uint32_t> position(vertex_offsets.begin(), vertex_offsets.end() - 1);
+      for (std::size_t c = 0; c < indices.size(); ++c) {
+        const std::uint32_t i = position[indices[c]]++;
+        vertex_corners[i] = static_cast<std::uint32_t>(c);
+        vertex_targets[i] = indices[corner_next[c]];
+      }
+    }
+
+    // Pair each half-edge a-b with the half-edge b-a leaving vertex b. Going through
+    // the vertices in order keeps the accesses local if neighboring vertices have
+    // close indices, whatever the order of the faces.
+    const std::uint32_t invalid = std::numeric_limits<std::uint32_t>::max();
+    const std::ptrdiff_t nr_vertices_signed = static_cast<std::ptrdiff_t>(nr_vertices);
+    std::vector<std::uint32_t> twin(indices.size(), invalid);
+#pragma omp parallel for default(none)                                                 \
+    shared(vertex_offsets, vertex_corners, vertex_targets, twin)                       \
+    firstprivate(nr_vertices_signed, invalid) reduction(&& : valid)                    \
+    num_threads(nr_threads) schedule(dynamic, 4096)
+    for (std::ptrdiff_t a = 0; a < nr_vertices_signed; ++a) {
+      for (std::uint32_t i = vertex_offsets[a]; i < vertex_offsets[a + 1]; ++i) {
+        const std::uint32_t b = vertex_targets[i];
+        std::uint32_t corner_twin = invalid;
+        for (std::uint32_t j = vertex_offsets[b]; j < vertex_offsets[b + 1]; ++j) {
+          if (vertex_targets[j] != a)
+            continue;
+          // More than two faces at the edge, or faces with inconsistent orientation
+          if (corner_twin != invalid)
+            valid = false;
+          corner_twin = vertex_corners[j];
+        }
+        twin[vertex_corners[i]] = corner_twin;
+      }
+    }
+    if (!valid)
+      return (false);
+
+    // The edges are numbered in the order of their first half-edge, the half-edge of
+    // each face corner leads from the corner to the next one
+    std::vector<int> corner_he(indices.size());
+    std::vector<std::uint32_t> boundary_corners;
+    int nr_edges = 0;
+    for (std::size_t c = 0; c < indices.size(); ++c) {
+      if (twin[c] == invalid) {
+        corner_he[c] = 2 * nr_edges++;
+        boundary_corners.push_back(static_cast<std::uint32_t>(c));
+      }
+      else if (c < twin[c]) {
+        corner_he[c] = 2 * nr_edges++;
+        corner_he[twin[c]] = corner_he[c] + 1;
+      }
+    }
+
+    // The inner half-edges
+    HalfEdges half_edges(2 * static_cast<std::size_t>(nr_edges), HalfEdge());
+    Faces faces(nr_faces, Face());
+#pragma omp parallel for default(none)                                                 \
+    shared(indices, offsets, corner_he, half_edges, faces) firstprivate(nr_faces)     \
+    num_threads(nr_threads)
+    for (std::ptrdiff_t f = 0; f < nr_faces; ++f) {
+      const std::uint32_t begin = offsets[f];
+      const std::uint32_t end = offsets[f + 1];
+      for (std::uint32_t c = begin; c < end; ++c) {
+        const std::uint32_t next = c + 1 < end ? c + 1 : begin;
+        const std::uint32_t prev = c > begin ? c - 1 : end - 1;
+        half_edges[corner_he[c]] = HalfEdge(VertexIndex(static_cast<int>(indices[next])),
+                                            HalfEdgeIndex(corner_he[next]),
+                                            HalfEdgeIndex(corner_he[prev]),
+                                            FaceIndex(static_cast<int>(f)));
+      }
+      faces[f] = Face(HalfEdgeIndex(corner_he[end - 1]));
+    }
+
+    // The outgoing half-edges of the vertices, a boundary half-edge if there is one
+    std::vector<int> outgoing(nr_vertices, -1);
+    std::vector<std::uint32_t> degree(nr_vertices);
+    for (std::size_t v = 0; v < nr_vertices; ++v) {
+      degree[v] = vertex_offsets[v + 1] - vertex_offsets[v];
+      if (degree[v] > 0)
+        outgoing[v] = corner_he[vertex_corners[vertex_offsets[v]]];
+    }
+    std::vector<bool> has_boundary(nr_vertices, false);
+    for (const auto& c : boundary_corners) {
+      // The boundary half-edge starts at the end of the inner one
+      const int he = corner_he[c] + 1;
+      const std::uint32_t origin = half_edges[corner_he[c]].idx_terminating_vertex_.get();
+      if (has_boundary[origin])
+        return (false);
+      has_boundary[origin] = true;
+      outgoing[origin] = he;
+      ++degree[origin];
+    }
+
+    // The boundary half-edges, linked along the boundary
+#pragma omp parallel for default(none)                                                 \
+    shared(indices, boundary_corners, corner_he, half_edges)                           \
+    num_threads(nr_threads)
+    for (std::ptrdiff_t i = 0; i < static_cast<std::ptrdiff_t>(boundary_corners.size());
+         ++i) {
+      const std::uint32_t c = boundary_corners[i];
+      half_edges[corner_he[c] + 1] =
+          HalfEdge(VertexIndex(static_cast<int>(indices[c])));
+    }
+    for (const auto& c : boundary_corners) {
+      const int he = corner_he[c] + 1;
+      const int he_next = outgoing[indices[c]];
+      if (!half_edges[he_next].idx_face_.isValid()) {
+        half_edges[he].idx_next_half_edge_ = HalfEdgeIndex(he_next);
+        half_edges[he_next].idx_prev_half_edge_ = HalfEdgeIndex(he);
+      }
+      else
+        return (false);
+    }
+
+    // Each vertex must be surrounded by a single fan of faces
+#pragma omp parallel for default(none) shared(outgoing, degree, half_edges)             \
+    firstprivate(nr_vertices_signed) reduction(&& : valid) num_threads(nr_threads)
+    for (std::ptrdiff_t v = 0; v < nr_vertices_signed; ++v) {
+      if (outgoing[v] == -1)
+        continue;
+      std::uint32_t count = 0;
+      int he = outgoing[v];
+      do {
+        he = half_edges[he ^ 1].idx_next_half_edge_.get();
+        ++count;
+      } while (he != outgoing[v] && count <= degree[v]);
+      if (count != degree[v])
+        valid = false;
+    }
+    if (!valid)
+      return (false);
+
+    // Everything is consistent, store the mesh
+    for (std::size_t v = 0; v < nr_vertices; ++v)
+      vertices_[v].idx_outgoing_half_edge_ = HalfEdgeIndex(outgoing[v]);
+    half_edges_.swap(half_edges);
+    faces_.swap(faces);
+    this->appendData(half_edge_data_cloud_, half_edges_.size(), half_edge_data, HasHalfEdgeData());
+    this->appendData(edge_data_cloud_, nr_edges, edge_data, HasEdgeData());
+    this->appendData(face_data_cloud_, faces_.size(), face_data, HasFaceData());
+    return (true);
+  }
+
   /**
    * \brief Mark the given vertex and all connected half-edges and faces as deleted.
    * \note Call cleanUp () to finally delete all mesh-elements.
@@ -1559,6 +1776,26 @@ protected:
           std::false_type /*has_data*/)
   {}
 
+  /** \brief Add n copies of the mesh data. */
+  template <class DataT>
+  inline void
+  appendData(pcl::PointCloud<DataT>& cloud,
+             const std::size_t n,
+             const DataT& data,
+             std::true_type /*has_data*/)
+  {
+    cloud.insert(cloud.end(), n, data);
+  }
+
+  /** \brief Does nothing. */
+  template <class DataT>
+  inline void
+  appendData(pcl::PointCloud<DataT>& /*cloud*/,
+             const std::size_t /*n*/,
+             const DataT& /*data*/,
+             std::false_type /*has_data*/)
+  {}
+
   ////////////////////////////////////////////////////////////////////////
   // deleteFace
   ////////////////////////////////////////////////////////////////////////
@@ -41,6 +41,7 @@
 #pragma once
 
 #include <pcl/PolygonMesh.h>
+#include <pcl/PolygonMeshBuffer.h>
 #include <pcl/conversions.h>
 
 namespace pcl {
@@ -79,13 +80,18 @@ toFaceVertexMesh(const HalfEdgeMeshT& half_edge_mesh,
  * \param[in] face_vertex_mesh The input mesh.
  * \param[out] half_edge_mesh The output mesh. It must have data associated with the
  * vertices.
+ * \param[in] nr_threads The number of threads used to connect the faces.
  * \return The number of faces that could NOT be added to the half-edge mesh.
+ * \note The faces are added at once with MeshBase::addFaces if they form a manifold
+ * mesh, else one by one.
  * \author Martin Saelzle
  * \ingroup geometry
  */
 template <class HalfEdgeMeshT>
 int
-toHalfEdgeMesh(const pcl::PolygonMesh& face_vertex_mesh, HalfEdgeMeshT& half_edge_mesh)
+toHalfEdgeMesh(const pcl::PolygonMesh& face_vertex_mesh,
+               HalfEdgeMeshT& half_edge_mesh,
+               unsigned int nr_threads = 1)
 {
   using HalfEdgeMesh = HalfEdgeMeshT;
   using VertexDataCloud = typename HalfEdgeMesh::VertexDataCloud;
@@ -98,8 +104,6 @@ toHalfEdgeMesh(const pcl::PolygonMesh& face_vertex_mesh, HalfEdgeMeshT& half_edg
   pcl::fromPCLPointCloud2(face_vertex_mesh.cloud, vertices);
 
   half_edge_mesh.reserveVertices(vertices.size());
-  half_edge_mesh.reserveEdges(3 * face_vertex_mesh.polygons.size());
-  half_edge_mesh.reserveFaces(face_vertex_mesh.polygons.size());
 
   for (const auto& vertex : vertices) {
     half_edge_mesh.addVertex(vertex);
@@ -107,6 +111,15 @@ toHalfEdgeMesh(const pcl::PolygonMesh& face_vertex_mesh, HalfEdgeMeshT& half_edg
 
   assert(half_edge_mesh.sizeVertices() == vertices.size());
 
+  std::vector<std::uint32_t> indices, offsets;
+  pcl::polygonsToBuffer(face_vertex_mesh.polygons, indices, offsets);
+  if (half_edge_mesh.addFaces(indices, offsets, nr_threads)) {
+    return (0);
+  }
+
+  half_edge_mesh.reserveEdges(3 * face_vertex_mesh.polygons.size());
+  half_edge_mesh.reserveFaces(face_vertex_mesh.polygons.size());
+
   int count_not_added = 0;
   VertexIndices vi;
   vi.reserve(3); // Minimum number (triangle)
@@ -123,5 +136,95 @@ toHalfEdgeMesh(const pcl::PolygonMesh& face_vertex_mesh, HalfEdgeMeshT& half_edg
 
   return (count_not_added);
 }
+
+/** \brief Convert a half-edge mesh to a face-vertex mesh with flat polygon buffers.
+ * \param[in] half_edge_mesh The input mesh.
+ * \param[out] face_vertex_mesh The output mesh.
+ * \ingroup geometry
+ */
+template <class HalfEdgeMeshT>
+void
+toFaceVertexMesh(const HalfEdgeMeshT& half_edge_mesh,
+                 pcl::PolygonMeshBuffer& face_vertex_mesh)
+{
+  using HalfEdgeMesh = HalfEdgeMeshT;
+  using VAFC = typename HalfEdgeMesh::VertexAroundFaceCirculator;
+  using FaceIndex = typename HalfEdgeMesh::FaceIndex;
+
+  pcl::toPCLPointCloud2(half_edge_mesh.getVertexDataCloud(), face_vertex_mesh.cloud);
+
+  face_vertex_mesh.clearPolygons();
+  face_vertex_mesh.reserve(half_edge_mesh.sizeFaces(), 3 * half_edge_mesh.sizeFaces());
+  for (std::size_t i = 0; i < half_edge_mesh.sizeFaces(); ++i) {
+    VAFC circ = half_edge_mesh.getVertexAroundFaceCirculator(FaceIndex(i));
+    const VAFC circ_end = circ;
+    do {
+      face_vertex_mesh.indices.push_back(
+          static_cast<std::uint32_t>(circ.getTargetIndex().get()));
+    } while (++circ != circ_end);
+    face_vertex_mesh.offsets.push_back(
+        static_cast<std::uint32_t>(face_vertex_mesh.indices.size()));
+  }
+}
+
+/** \brief Convert a face-vertex mesh with flat polygon buffers to a half-edge mesh.
+ * \param[in] face_vertex_mesh The input mesh.
+ * \param[out] half_edge_mesh The output mesh. It must have data associated with the
+ * vertices.
+ * \param[in] nr_threads The number of threads used to connect the faces.
+ * \return The number of faces that could NOT be added to the half-edge mesh.
+ * \note The faces are added at once with MeshBase::addFaces if they form a manifold
+ * mesh, else one by one.
+ * \ingroup geometry
+ */
+template <class HalfEdgeMeshT>
+int
+toHalfEdgeMesh(const pcl::PolygonMeshBuffer& face_vertex_mesh,
+               HalfEdgeMeshT& half_edge_mesh,
+               unsigned int nr_threads = 1)
+{
+  using HalfEdgeMesh = HalfEdgeMeshT;
+  using VertexDataCloud = typename HalfEdgeMesh::VertexDataCloud;
+  using VertexIndices = typename HalfEdgeMesh::VertexIndices;
+
+  static_assert(HalfEdgeMesh::HasVertexData::value,
+                "Output mesh must have data associated with the vertices!");
+
+  VertexDataCloud vertices;
+  pcl::fromPCLPointCloud2(face_vertex_mesh.cloud, vertices);
+
+  half_edge_mesh.reserveVertices(vertices.size());
+
+  for (const auto& vertex : vertices) {
+    half_edge_mesh.addVertex(vertex);
+  }
+
+  assert(half_edge_mesh.sizeVertices() == vertices.size());
+
+  if (half_edge_mesh.addFaces(
+          face_vertex_mesh.indices, face_vertex_mesh.offsets, nr_threads)) {
+    return (0);
+  }
+
+  half_edge_mesh.reserveEdges(face_vertex_mesh.indices.size());
+  half_edge_mesh.reserveFaces(face_vertex_mesh.size());
+
+  int count_not_added = 0;
+  VertexIndices vi;
+  vi.reserve(3); // Minimum number (triangle)
+  for (std::size_t i = 0; i < face_vertex_mesh.size(); ++i) {
+    vi.clear();
+    const std::uint32_t* polygon = face_vertex_mesh.getPolygon(i);
+    for (std::uint32_t j = 0; j < face_vertex_mesh.getPolygonSize(i); ++j) {
+      vi.emplace_back(static_cast<int>(polygon[j]));
+    }
+
+    if (!half_edge_mesh.addFace(vi).isValid()) {
+      ++count_not_added;
+    }
+  }
+
+  return (count_not_added);
+}
 } // End namespace geometry
 } // End namespace pcl
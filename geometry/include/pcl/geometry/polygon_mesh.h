@@ -182,6 +182,13 @@ private:
   friend class pcl::geometry::
       MeshBase<PolygonMesh<MeshTraitsT>, MeshTraitsT, pcl::geometry::PolygonMeshTag>;
 
+  /** \brief Check if addFaces accepts faces with n vertices. */
+  static inline bool
+  isValidFaceSize(const std::size_t n)
+  {
+    return (n >= 3);
+  }
+
   /** \brief addFace for the polygon mesh. */
   inline FaceIndex
   addFaceImpl(const VertexIndices& vertices,
@@ -149,6 +149,13 @@ private:
   friend class pcl::geometry::
       MeshBase<QuadMesh<MeshTraitsT>, MeshTraitsT, pcl::geometry::QuadMeshTag>;
 
+  /** \brief Check if addFaces accepts faces with n vertices. */
+  static inline bool
+  isValidFaceSize(const std::size_t n)
+  {
+    return (n == 4);
+  }
+
   /** \brief addFace for the quad mesh. */
   inline FaceIndex
   addFaceImpl(const VertexIndices& vertices,
@@ -284,6 +284,13 @@ private:
   friend class pcl::geometry::
       MeshBase<TriangleMesh<MeshTraitsT>, MeshTraitsT, pcl::geometry::TriangleMeshTag>;
 
+  /** \brief Check if addFaces accepts faces with n vertices. */
+  static inline bool
+  isValidFaceSize(const std::size_t n)
+  {
+    return (n == 3);
+  }
+
   /** \brief addFace for the triangular mesh. */
   inline FaceIndex
   addFaceImpl(const VertexIndices& vertices,
@@ -0,0 +1,174 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2019-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <pcl/pcl_exports.h>
+
+#include <cstddef>
+#include <map>
+#include <mutex>
+
+namespace pcl {
+namespace gpu {
+///////////////////////////////////////////////////////////////////////////////
+/** \brief @b DeviceAllocator class
+ *
+ * \note Interface of the source of GPU memory of DeviceMemory and DeviceMemory2D, set
+ * with pcl::gpu::setAllocator. Implementations have to be thread safe.
+ */
+class PCL_EXPORTS DeviceAllocator {
+public:
+  virtual ~DeviceAllocator() = default;
+
+  /** \brief Allocates GPU memory, failures are reported by pcl::gpu::error.
+   * \param sizeBytes amount of memory to allocate
+   * */
+  virtual void*
+  allocate(std::size_t sizeBytes) = 0;
+
+  /** \brief Returns memory obtained from allocate or allocatePitched.
+   * \param ptr pointer to the memory
+   * \param sizeBytes size requested from allocate, or step * rows for allocatePitched
+   * */
+  virtual void
+  deallocate(void* ptr, std::size_t sizeBytes) = 0;
+
+  /** \brief Allocates pitched GPU memory for rows of colsBytes bytes. The default
+   * implementation aligns the rows to pitch_alignment bytes and calls allocate.
+   * \param step output stride between two consecutive rows in bytes
+   * \param colsBytes width of a row in bytes
+   * \param rows number of rows
+   * */
+  virtual void*
+  allocatePitched(std::size_t& step, std::size_t colsBytes, std::size_t rows);
+
+  /** \brief Row alignment of the default allocatePitched, enough for coalesced access
+   * and texture binding on all supported devices. */
+  static constexpr std::size_t pitch_alignment = 512;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+/** \brief @b CachingDeviceAllocator class
+ *
+ * \note Keeps freed blocks for reuse instead of returning them with cudaFree, which
+ * synchronizes the device. Requests are rounded up to size classes, powers of two
+ * from min_bin_bytes to max_bin_bytes, and served from cached blocks of the same class.
+ * Larger requests are allocated and freed directly.
+ *
+ * Freed blocks are stream ordered: an event is recorded on the default stream when a
+ * block is returned, and the block is only handed out again when all work enqueued
+ * before, on the default stream and on the blocking pcl::gpu::Stream objects, completed.
+ *
+ * \code
+ * pcl::gpu::CachingDeviceAllocator allocator;
+ * pcl::gpu::setAllocator(&allocator);
+ * // ... per frame processing with temporaries
+ * pcl::gpu::setAllocator(nullptr);
+ * \endcode
+ */
+class PCL_EXPORTS CachingDeviceAllocator : public DeviceAllocator {
+public:
+  /** \brief Constructor.
+   * \param max_cached_bytes the cache does not grow beyond this, further freed blocks
+   * are returned to the device
+   * \param min_bin_bytes smallest size class
+   * \param max_bin_bytes largest size class
+   * */
+  explicit CachingDeviceAllocator(std::size_t max_cached_bytes = std::size_t(1) << 30,
+                                  std::size_t min_bin_bytes = 512,
+                                  std::size_t max_bin_bytes = std::size_t(1) << 28);
+
+  CachingDeviceAllocator(const CachingDeviceAllocator&) = delete;
+  CachingDeviceAllocator&
+  operator=(const CachingDeviceAllocator&) = delete;
+
+  /** \brief Frees all cached blocks. Blocks still in use must not be returned after the
+   * destruction. */
+  ~CachingDeviceAllocator() override;
+
+  void*
+  allocate(std::size_t sizeBytes) override;
+
+  void
+  deallocate(void* ptr, std::size_t sizeBytes) override;
+
+  /** \brief Returns all cached blocks to the device. */
+  void
+  freeAllCached();
+
+  /** \brief Returns the number of bytes held in cached blocks. */
+  std::size_t
+  cachedBytes() const;
+
+private:
+  /** \brief Returns the size class of a request, 0 if it is not cached. */
+  std::size_t
+  binBytes(std::size_t sizeBytes) const;
+
+  struct Block {
+    void* ptr;
+    /** \brief cudaEvent_t recorded when the block was returned. */
+    void* ready_event;
+  };
+
+  std::size_t max_cached_bytes_;
+  std::size_t min_bin_bytes_;
+  std::size_t max_bin_bytes_;
+
+  /** \brief Cached blocks by size class, oldest first. */
+  std::multimap<std::size_t, Block> cached_;
+
+  std::size_t cached_bytes_ = 0;
+
+  mutable std::mutex mutex_;
+};
+
+/** \brief Returns the allocator used by DeviceMemory and DeviceMemory2D, initially one
+ * calling cudaMalloc and cudaFree directly. */
+PCL_EXPORTS DeviceAllocator*
+getAllocator();
+
+/** \brief Sets the allocator used by DeviceMemory and DeviceMemory2D from now on.
+ * Existing buffers are freed by the allocator they were allocated with, which has to
+ * outlive them.
+ * \param allocator the new allocator, nullptr restores the default one
+ * \return the previous allocator
+ */
+PCL_EXPORTS DeviceAllocator*
+setAllocator(DeviceAllocator* allocator);
+} // namespace gpu
+} // namespace pcl
@@ -150,6 +150,41 @@ public:
   void
   download(std::vector<T, A>& data) const;
 
+  /** \brief Enqueues an upload to internal buffer on a stream, see
+   * DeviceMemory::uploadAsync.
+   * \param host_ptr pointer to buffer to upload
+   * \param size elements number
+   * \param stream stream to enqueue the copy on
+   * */
+  void
+  uploadAsync(const T* host_ptr, std::size_t size, Stream& stream);
+
+  /** \brief Enqueues a download from internal buffer on a stream, see
+   * DeviceMemory::downloadAsync.
+   * \param host_ptr pointer to buffer to download
+   * \param stream stream to enqueue the copy on
+   * */
+  void
+  downloadAsync(T* host_ptr, Stream& stream) const;
+
+  /** \brief Enqueues an upload to internal buffer on a stream, see
+   * DeviceMemory::uploadAsync.
+   * \param data host vector to upload from, e.g. a PinnedVector
+   * \param stream stream to enqueue the copy on
+   * */
+  template <class A>
+  void
+  uploadAsync(const std::vector<T, A>& data, Stream& stream);
+
+  /** \brief Resizes the host vector and enqueues a download to it on a stream, see
+   * DeviceMemory::downloadAsync.
+   * \param data host vector to download to, e.g. a PinnedVector
+   * \param stream stream to enqueue the copy on
+   * */
+  template <class A>
+  void
+  downloadAsync(std::vector<T, A>& data, Stream& stream) const;
+
   /** \brief Performs swap of data pointed with another device array.
    * \param other_arg device array to swap with
    * */
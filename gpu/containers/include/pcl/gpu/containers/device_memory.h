@@ -41,6 +41,9 @@
 
 namespace pcl {
 namespace gpu {
+class DeviceAllocator;
+class Stream;
+
 ///////////////////////////////////////////////////////////////////////////////
 /** \brief @b DeviceMemory class
  *
@@ -76,9 +79,9 @@ public:
   DeviceMemory&
   operator=(const DeviceMemory& other_arg);
 
-  /** \brief Allocates internal buffer in GPU memory. If internal buffer was created
-   * before the function recreates it with new size. If new and old sizes are equal it
-   * does nothing.
+  /** \brief Allocates internal buffer in GPU memory, from the allocator set with
+   * pcl::gpu::setAllocator. If internal buffer was created before the function
+   * recreates it with new size. If new and old sizes are equal it does nothing.
    * \param sizeBytes_arg buffer size
    * */
   void
@@ -132,6 +135,25 @@ public:
            std::size_t device_begin_byte_offset,
            std::size_t num_bytes) const;
 
+  /** \brief Enqueues an upload to internal buffer on a stream and returns at once. It
+   * calls create() inside, which is synchronous. The host buffer has to stay valid until
+   * the stream completed and should be page-locked, see PinnedAllocator.
+   * \param host_ptr_arg pointer to buffer to upload
+   * \param sizeBytes_arg buffer size
+   * \param stream stream to enqueue the copy on
+   * */
+  void
+  uploadAsync(const void* host_ptr_arg, std::size_t sizeBytes_arg, Stream& stream);
+
+  /** \brief Enqueues a download from internal buffer on a stream and returns at once.
+   * The host buffer has to stay valid until the stream completed and should be
+   * page-locked, see PinnedAllocator.
+   * \param host_ptr_arg pointer to buffer to download
+   * \param stream stream to enqueue the copy on
+   * */
+  void
+  downloadAsync(void* host_ptr_arg, Stream& stream) const;
+
   /** \brief Performs swap of data pointed with another device memory.
    * \param other_arg device memory to swap with
    * */
@@ -168,6 +190,9 @@ private:
 
   /** \brief Pointer to reference counter in CPU memory. */
   int* refcount_;
+
+  /** \brief Allocator the internal buffer was allocated with. */
+  DeviceAllocator* allocator_;
 };
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -208,9 +233,9 @@ public:
   DeviceMemory2D&
   operator=(const DeviceMemory2D& other_arg);
 
-  /** \brief Allocates internal buffer in GPU memory. If internal buffer was created
-   * before the function recreates it with new size. If new and old sizes are equal it
-   * does nothing.
+  /** \brief Allocates internal buffer in GPU memory, from the allocator set with
+   * pcl::gpu::setAllocator. If internal buffer was created before the function
+   * recreates it with new size. If new and old sizes are equal it does nothing.
    * \param rows_arg number of rows to allocate
    * \param colsBytes_arg width of the buffer in bytes
    * */
@@ -309,6 +334,9 @@ private:
 
   /** \brief Pointer to reference counter in CPU memory. */
   int* refcount_;
+
+  /** \brief Allocator the internal buffer was allocated with. */
+  DeviceAllocator* allocator_;
 };
 } // namespace gpu
 
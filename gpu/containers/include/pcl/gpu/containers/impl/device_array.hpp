@@ -125,6 +125,20 @@ DeviceArray<T>::download(T* host_ptr,
   return DeviceMemory::download(host_ptr, begin_byte_offset, num_bytes);
 }
 
+template <class T>
+inline void
+DeviceArray<T>::uploadAsync(const T* host_ptr, std::size_t size, Stream& stream)
+{
+  DeviceMemory::uploadAsync(host_ptr, size * elem_size, stream);
+}
+
+template <class T>
+inline void
+DeviceArray<T>::downloadAsync(T* host_ptr, Stream& stream) const
+{
+  DeviceMemory::downloadAsync(host_ptr, stream);
+}
+
 template <class T>
 void
 DeviceArray<T>::swap(DeviceArray& other_arg)
@@ -183,6 +197,24 @@ DeviceArray<T>::download(std::vector<T, A>& data) const
     download(&data[0]);
 }
 
+template <class T>
+template <class A>
+inline void
+DeviceArray<T>::uploadAsync(const std::vector<T, A>& data, Stream& stream)
+{
+  uploadAsync(data.data(), data.size(), stream);
+}
+
+template <class T>
+template <class A>
+inline void
+DeviceArray<T>::downloadAsync(std::vector<T, A>& data, Stream& stream) const
+{
+  data.resize(size());
+  if (!data.empty())
+    downloadAsync(data.data(), stream);
+}
+
 ///////////////////  Inline implementations of DeviceArray2D //////////////////
 
 template <class T>
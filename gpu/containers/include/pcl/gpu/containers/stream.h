@@ -0,0 +1,154 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2019-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <pcl/pcl_exports.h>
+
+#include <cstddef>
+#include <vector>
+
+namespace pcl {
+namespace gpu {
+///////////////////////////////////////////////////////////////////////////////
+/** \brief @b Stream class
+ *
+ * \note Owns a CUDA stream. Work enqueued on one stream runs in order, work on
+ * different streams may overlap, e.g. the upload of the next frame with the kernels
+ * processing the current one. Streams are created blocking, so the synchronous
+ * functions, which use the default stream, still wait for them.
+ *
+ * Asynchronous transfers only overlap with kernels if the host memory is page-locked,
+ * see PinnedAllocator, and the host memory has to stay valid until the stream
+ * completed.
+ */
+class PCL_EXPORTS Stream {
+public:
+  /** \brief Creates a new CUDA stream. */
+  Stream();
+
+  /** \brief Destroys the stream, after the work enqueued on it completed. */
+  ~Stream();
+
+  Stream(const Stream&) = delete;
+  Stream&
+  operator=(const Stream&) = delete;
+
+  /** \brief Blocks until all work enqueued on the stream completed. */
+  void
+  waitForCompletion();
+
+  /** \brief Returns true if all work enqueued on the stream completed. */
+  bool
+  queryIfComplete() const;
+
+  /** \brief Returns the cudaStream_t, as void* to keep CUDA headers out of this one. */
+  void*
+  handle() const;
+
+  /** \brief Returns the default stream, on which the synchronous functions run. */
+  static Stream&
+  Null();
+
+private:
+  /** \brief Wraps an existing stream without owning it. */
+  explicit Stream(void* handle_arg);
+
+  /** \brief The cudaStream_t. */
+  void* stream_;
+
+  /** \brief Whether stream_ is destroyed with this object. */
+  bool own_;
+};
+
+/** \brief Allocates page-locked host memory, failures are reported by pcl::gpu::error. */
+PCL_EXPORTS void*
+allocatePinnedHostMemory(std::size_t sizeBytes);
+
+/** \brief Frees memory returned by allocatePinnedHostMemory. */
+PCL_EXPORTS void
+freePinnedHostMemory(void* ptr);
+
+///////////////////////////////////////////////////////////////////////////////
+/** \brief @b PinnedAllocator class
+ *
+ * \note Allocator of page-locked host memory, which the GPU can access by DMA. Copies
+ * from and to it are faster and, when enqueued on a Stream, asynchronous.
+ */
+template <typename T>
+class PinnedAllocator {
+public:
+  using value_type = T;
+
+  PinnedAllocator() = default;
+
+  template <typename U>
+  PinnedAllocator(const PinnedAllocator<U>&) noexcept
+  {}
+
+  T*
+  allocate(std::size_t n)
+  {
+    return static_cast<T*>(allocatePinnedHostMemory(n * sizeof(T)));
+  }
+
+  void
+  deallocate(T* p, std::size_t) noexcept
+  {
+    freePinnedHostMemory(p);
+  }
+};
+
+template <typename T, typename U>
+bool
+operator==(const PinnedAllocator<T>&, const PinnedAllocator<U>&) noexcept
+{
+  return true;
+}
+
+template <typename T, typename U>
+bool
+operator!=(const PinnedAllocator<T>&, const PinnedAllocator<U>&) noexcept
+{
+  return false;
+}
+
+/** \brief Host vector in page-locked memory, accepted by DeviceArray::upload and
+ * download. */
+template <typename T>
+using PinnedVector = std::vector<T, PinnedAllocator<T>>;
+} // namespace gpu
+} // namespace pcl
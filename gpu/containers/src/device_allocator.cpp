@@ -0,0 +1,216 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2019-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <pcl/gpu/containers/device_allocator.h>
+#include <pcl/gpu/utils/safe_call.hpp>
+
+#include <cuda_runtime_api.h>
+
+#include <atomic>
+
+namespace {
+class CudaDeviceAllocator : public pcl::gpu::DeviceAllocator {
+public:
+  void*
+  allocate(std::size_t sizeBytes) override
+  {
+    void* ptr = nullptr;
+    cudaSafeCall(cudaMalloc(&ptr, sizeBytes));
+    return ptr;
+  }
+
+  void
+  deallocate(void* ptr, std::size_t) override
+  {
+    cudaSafeCall(cudaFree(ptr));
+  }
+
+  void*
+  allocatePitched(std::size_t& step, std::size_t colsBytes, std::size_t rows) override
+  {
+    void* ptr = nullptr;
+    cudaSafeCall(cudaMallocPitch(&ptr, &step, colsBytes, rows));
+    return ptr;
+  }
+};
+
+pcl::gpu::DeviceAllocator*
+cudaDeviceAllocator()
+{
+  static CudaDeviceAllocator allocator;
+  return &allocator;
+}
+
+std::atomic<pcl::gpu::DeviceAllocator*>&
+currentAllocator()
+{
+  static std::atomic<pcl::gpu::DeviceAllocator*> allocator(cudaDeviceAllocator());
+  return allocator;
+}
+} // namespace
+
+constexpr std::size_t pcl::gpu::DeviceAllocator::pitch_alignment;
+
+void*
+pcl::gpu::DeviceAllocator::allocatePitched(std::size_t& step,
+                                           std::size_t colsBytes,
+                                           std::size_t rows)
+{
+  step = (colsBytes + pitch_alignment - 1) / pitch_alignment * pitch_alignment;
+  return allocate(step * rows);
+}
+
+pcl::gpu::DeviceAllocator*
+pcl::gpu::getAllocator()
+{
+  return currentAllocator().load();
+}
+
+pcl::gpu::DeviceAllocator*
+pcl::gpu::setAllocator(DeviceAllocator* allocator)
+{
+  return currentAllocator().exchange(allocator ? allocator : cudaDeviceAllocator());
+}
+
+////////////////////////    CachingDeviceAllocator    /////////////////////////////
+
+pcl::gpu::CachingDeviceAllocator::CachingDeviceAllocator(std::size_t max_cached_bytes,
+                                                         std::size_t min_bin_bytes,
+                                                         std::size_t max_bin_bytes)
+: max_cached_bytes_(max_cached_bytes)
+, min_bin_bytes_(min_bin_bytes)
+, max_bin_bytes_(max_bin_bytes)
+{}
+
+pcl::gpu::CachingDeviceAllocator::~CachingDeviceAllocator()
+{
+  // no error checks, the context may already be torn down at exit
+  for (const auto& bin_block : cached_) {
+    cudaEventDestroy(static_cast<cudaEvent_t>(bin_block.second.ready_event));
+    cudaFree(bin_block.second.ptr);
+  }
+}
+
+std::size_t
+pcl::gpu::CachingDeviceAllocator::binBytes(std::size_t sizeBytes) const
+{
+  if (sizeBytes > max_bin_bytes_)
+    return 0;
+
+  std::size_t bin = min_bin_bytes_;
+  while (bin < sizeBytes)
+    bin *= 2;
+  return bin;
+}
+
+void*
+pcl::gpu::CachingDeviceAllocator::allocate(std::size_t sizeBytes)
+{
+  const std::size_t bin = binBytes(sizeBytes);
+  if (bin) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    const auto range = cached_.equal_range(bin);
+    for (auto it = range.first; it != range.second; ++it) {
+      const cudaEvent_t ready_event = static_cast<cudaEvent_t>(it->second.ready_event);
+      const cudaError_t err = cudaEventQuery(ready_event);
+      if (err == cudaErrorNotReady)
+        continue;
+      cudaSafeCall(err);
+
+      void* ptr = it->second.ptr;
+      cudaSafeCall(cudaEventDestroy(ready_event));
+      cached_bytes_ -= bin;
+      cached_.erase(it);
+      return ptr;
+    }
+  }
+
+  void* ptr = nullptr;
+  cudaError_t err = cudaMalloc(&ptr, bin ? bin : sizeBytes);
+  if (err == cudaErrorMemoryAllocation) {
+    // the cached blocks may hold the memory we need
+    cudaGetLastError();
+    freeAllCached();
+    err = cudaMalloc(&ptr, bin ? bin : sizeBytes);
+  }
+  cudaSafeCall(err);
+  return ptr;
+}
+
+void
+pcl::gpu::CachingDeviceAllocator::deallocate(void* ptr, std::size_t sizeBytes)
+{
+  if (!ptr)
+    return;
+
+  const std::size_t bin = binBytes(sizeBytes);
+  if (bin) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    if (cached_bytes_ + bin <= max_cached_bytes_) {
+      // completes when all work enqueued so far, which may still use the block, is done
+      cudaEvent_t ready_event;
+      cudaSafeCall(cudaEventCreateWithFlags(&ready_event, cudaEventDisableTiming));
+      cudaSafeCall(cudaEventRecord(ready_event, 0));
+
+      cached_.emplace(bin, Block{ptr, ready_event});
+      cached_bytes_ += bin;
+      return;
+    }
+  }
+  cudaSafeCall(cudaFree(ptr));
+}
+
+void
+pcl::gpu::CachingDeviceAllocator::freeAllCached()
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  for (const auto& bin_block : cached_) {
+    cudaSafeCall(cudaEventDestroy(static_cast<cudaEvent_t>(bin_block.second.ready_event)));
+    cudaSafeCall(cudaFree(bin_block.second.ptr));
+  }
+  cached_.clear();
+  cached_bytes_ = 0;
+}
+
+std::size_t
+pcl::gpu::CachingDeviceAllocator::cachedBytes() const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  return cached_bytes_;
+}
@@ -34,7 +34,9 @@
  *  Author: Anatoly Baskeheev, Itseez Ltd, (myname.mysurname@mycompany.com)
  */
 
+#include <pcl/gpu/containers/device_allocator.h>
 #include <pcl/gpu/containers/device_memory.h>
+#include <pcl/gpu/containers/stream.h>
 #include <pcl/gpu/utils/safe_call.hpp>
 
 #include <cuda_runtime_api.h>
@@ -96,6 +98,18 @@ pcl::gpu::DeviceMemory::download(void*) const
   throw_nogpu();
 }
 
+void
+pcl::gpu::DeviceMemory::uploadAsync(const void*, std::size_t, Stream&)
+{
+  throw_nogpu();
+}
+
+void
+pcl::gpu::DeviceMemory::downloadAsync(void*, Stream&) const
+{
+  throw_nogpu();
+}
+
 bool
 pcl::gpu::DeviceMemory::empty() const
 {
@@ -190,15 +204,15 @@ CV_XADD(_Tp* addr, _Tp delta)
 ////////////////////////    DeviceArray    /////////////////////////////
 
 pcl::gpu::DeviceMemory::DeviceMemory()
-: data_(nullptr), sizeBytes_(0), refcount_(nullptr)
+: data_(nullptr), sizeBytes_(0), refcount_(nullptr), allocator_(nullptr)
 {}
 
 pcl::gpu::DeviceMemory::DeviceMemory(void* ptr_arg, std::size_t sizeBytes_arg)
-: data_(ptr_arg), sizeBytes_(sizeBytes_arg), refcount_(nullptr)
+: data_(ptr_arg), sizeBytes_(sizeBytes_arg), refcount_(nullptr), allocator_(nullptr)
 {}
 
 pcl::gpu::DeviceMemory::DeviceMemory(std::size_t sizeBtes_arg)
-: data_(nullptr), sizeBytes_(0), refcount_(nullptr)
+: data_(nullptr), sizeBytes_(0), refcount_(nullptr), allocator_(nullptr)
 {
   create(sizeBtes_arg);
 }
@@ -209,6 +223,7 @@ pcl::gpu::DeviceMemory::DeviceMemory(const DeviceMemory& other_arg)
 : data_(other_arg.data_)
 , sizeBytes_(other_arg.sizeBytes_)
 , refcount_(other_arg.refcount_)
+, allocator_(other_arg.allocator_)
 {
   if (refcount_)
     CV_XADD(refcount_, 1);
@@ -225,6 +240,7 @@ pcl::gpu::DeviceMemory::operator=(const pcl::gpu::DeviceMemory& other_arg)
     data_ = other_arg.data_;
     sizeBytes_ = other_arg.sizeBytes_;
     refcount_ = other_arg.refcount_;
+    allocator_ = other_arg.allocator_;
   }
   return *this;
 }
@@ -241,7 +257,8 @@ pcl::gpu::DeviceMemory::create(std::size_t sizeBytes_arg)
 
     sizeBytes_ = sizeBytes_arg;
 
-    cudaSafeCall(cudaMalloc(&data_, sizeBytes_));
+    allocator_ = getAllocator();
+    data_ = allocator_->allocate(sizeBytes_);
 
     // refcount_ = (int*)cv::fastMalloc(sizeof(*refcount_));
     refcount_ = new int;
@@ -267,11 +284,12 @@ pcl::gpu::DeviceMemory::release()
   if (refcount_ && CV_XADD(refcount_, -1) == 1) {
     // cv::fastFree(refcount);
     delete refcount_;
-    cudaSafeCall(cudaFree(data_));
+    allocator_->deallocate(data_, sizeBytes_);
   }
   data_ = nullptr;
   sizeBytes_ = 0;
   refcount_ = nullptr;
+  allocator_ = nullptr;
 }
 
 void
@@ -317,12 +335,36 @@ pcl::gpu::DeviceMemory::download(void* host_ptr_arg,
   return true;
 }
 
+void
+pcl::gpu::DeviceMemory::uploadAsync(const void* host_ptr_arg,
+                                    std::size_t sizeBytes_arg,
+                                    Stream& stream)
+{
+  create(sizeBytes_arg);
+  cudaSafeCall(cudaMemcpyAsync(data_,
+                               host_ptr_arg,
+                               sizeBytes_,
+                               cudaMemcpyHostToDevice,
+                               static_cast<cudaStream_t>(stream.handle())));
+}
+
+void
+pcl::gpu::DeviceMemory::downloadAsync(void* host_ptr_arg, Stream& stream) const
+{
+  cudaSafeCall(cudaMemcpyAsync(host_ptr_arg,
+                               data_,
+                               sizeBytes_,
+                               cudaMemcpyDeviceToHost,
+                               static_cast<cudaStream_t>(stream.handle())));
+}
+
 void
 pcl::gpu::DeviceMemory::swap(DeviceMemory& other_arg)
 {
   std::swap(data_, other_arg.data_);
   std::swap(sizeBytes_, other_arg.sizeBytes_);
   std::swap(refcount_, other_arg.refcount_);
+  std::swap(allocator_, other_arg.allocator_);
 }
 
 bool
@@ -339,11 +381,21 @@ pcl::gpu::DeviceMemory::sizeBytes() const
 ////////////////////////    DeviceArray2D    /////////////////////////////
 
 pcl::gpu::DeviceMemory2D::DeviceMemory2D()
-: data_(nullptr), step_(0), colsBytes_(0), rows_(0), refcount_(nullptr)
+: data_(nullptr)
+, step_(0)
+, colsBytes_(0)
+, rows_(0)
+, refcount_(nullptr)
+, allocator_(nullptr)
 {}
 
 pcl::gpu::DeviceMemory2D::DeviceMemory2D(int rows_arg, int colsBytes_arg)
-: data_(nullptr), step_(0), colsBytes_(0), rows_(0), refcount_(nullptr)
+: data_(nullptr)
+, step_(0)
+, colsBytes_(0)
+, rows_(0)
+, refcount_(nullptr)
+, allocator_(nullptr)
 {
   create(rows_arg, colsBytes_arg);
 }
@@ -357,6 +409,7 @@ pcl::gpu::DeviceMemory2D::DeviceMemory2D(int rows_arg,
 , colsBytes_(colsBytes_arg)
 , rows_(rows_arg)
 , refcount_(nullptr)
+, allocator_(nullptr)
 {}
 
 pcl::gpu::DeviceMemory2D::~DeviceMemory2D() { release(); }
@@ -367,6 +420,7 @@ pcl::gpu::DeviceMemory2D::DeviceMemory2D(const DeviceMemory2D& other_arg)
 , colsBytes_(other_arg.colsBytes_)
 , rows_(other_arg.rows_)
 , refcount_(other_arg.refcount_)
+, allocator_(other_arg.allocator_)
 {
   if (refcount_)
     CV_XADD(refcount_, 1);
@@ -386,6 +440,7 @@ pcl::gpu::DeviceMemory2D::operator=(const pcl::gpu::DeviceMemory2D& other_arg)
     step_ = other_arg.step_;
 
     refcount_ = other_arg.refcount_;
+    allocator_ = other_arg.allocator_;
   }
   return *this;
 }
@@ -403,7 +458,8 @@ pcl::gpu::DeviceMemory2D::create(int rows_arg, int colsBytes_arg)
     colsBytes_ = colsBytes_arg;
     rows_ = rows_arg;
 
-    cudaSafeCall(cudaMallocPitch((void**)&data_, &step_, colsBytes_, rows_));
+    allocator_ = getAllocator();
+    data_ = allocator_->allocatePitched(step_, colsBytes_, rows_);
 
     // refcount = (int*)cv::fastMalloc(sizeof(*refcount));
     refcount_ = new int;
@@ -417,7 +473,7 @@ pcl::gpu::DeviceMemory2D::release()
   if (refcount_ && CV_XADD(refcount_, -1) == 1) {
     // cv::fastFree(refcount);
     delete refcount_;
-    cudaSafeCall(cudaFree(data_));
+    allocator_->deallocate(data_, step_ * rows_);
   }
 
   colsBytes_ = 0;
@@ -425,6 +481,7 @@ pcl::gpu::DeviceMemory2D::release()
   data_ = nullptr;
   step_ = 0;
   refcount_ = nullptr;
+  allocator_ = nullptr;
 }
 
 void
@@ -484,6 +541,7 @@ pcl::gpu::DeviceMemory2D::swap(DeviceMemory2D& other_arg)
   std::swap(colsBytes_, other_arg.colsBytes_);
   std::swap(rows_, other_arg.rows_);
   std::swap(refcount_, other_arg.refcount_);
+  std::swap(allocator_, other_arg.allocator_);
 }
 
 bool
@@ -0,0 +1,101 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2019-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <pcl/gpu/containers/stream.h>
+#include <pcl/gpu/utils/safe_call.hpp>
+
+#include <cuda_runtime_api.h>
+
+pcl::gpu::Stream::Stream() : stream_(nullptr), own_(true)
+{
+  cudaStream_t stream;
+  cudaSafeCall(cudaStreamCreate(&stream));
+  stream_ = stream;
+}
+
+pcl::gpu::Stream::Stream(void* handle_arg) : stream_(handle_arg), own_(false) {}
+
+pcl::gpu::Stream::~Stream()
+{
+  // cudaStreamDestroy returns at once, the resources are freed after pending work
+  if (own_ && stream_)
+    cudaStreamDestroy(static_cast<cudaStream_t>(stream_));
+}
+
+void
+pcl::gpu::Stream::waitForCompletion()
+{
+  cudaSafeCall(cudaStreamSynchronize(static_cast<cudaStream_t>(stream_)));
+}
+
+bool
+pcl::gpu::Stream::queryIfComplete() const
+{
+  const cudaError_t err = cudaStreamQuery(static_cast<cudaStream_t>(stream_));
+  if (err == cudaErrorNotReady)
+    return false;
+
+  cudaSafeCall(err);
+  return true;
+}
+
+void*
+pcl::gpu::Stream::handle() const
+{
+  return stream_;
+}
+
+pcl::gpu::Stream&
+pcl::gpu::Stream::Null()
+{
+  static Stream null_stream(nullptr);
+  return null_stream;
+}
+
+void*
+pcl::gpu::allocatePinnedHostMemory(std::size_t sizeBytes)
+{
+  void* ptr = nullptr;
+  cudaSafeCall(cudaMallocHost(&ptr, sizeBytes));
+  return ptr;
+}
+
+void
+pcl::gpu::freePinnedHostMemory(void* ptr)
+{
+  if (ptr)
+    cudaSafeCall(cudaFreeHost(ptr));
+}
@@ -38,11 +38,14 @@
 #define _PCL_GPU_FEATURES_HPP_
 
 #include <pcl/pcl_macros.h>
+#include <pcl/point_cloud.h>
 #include <pcl/point_types.h>
 #include <pcl/gpu/containers/device_array.h>
 #include <pcl/gpu/octree/device_format.hpp>
 #include <pcl/gpu/octree/octree.hpp>
 
+#include <future>
+
 namespace pcl
 {
     namespace gpu
@@ -98,12 +101,20 @@ namespace pcl
 
             NormalEstimation();
             void compute(Normals& normals);
+            /** \brief Enqueues the octree building, the radius search and the normal estimation on a stream. The
+              * normals are valid after the stream completed, so the upload of the next cloud can overlap with them
+              * when done on another stream.
+              */
+            void compute(Normals& normals, Stream& stream);
             void setViewPoint(float  vpx, float  vpy, float  vpz);  
             void getViewPoint(float& vpx, float& vpy, float& vpz) const;
 
             static void computeNormals(const PointCloud& cloud, const NeighborIndices& nn_indices, Normals& normals);
+            static void computeNormals(const PointCloud& cloud, const NeighborIndices& nn_indices, Normals& normals, Stream& stream);
             static void flipNormalTowardsViewpoint(const PointCloud& cloud, float vp_x, float vp_y, float vp_z, Normals& normals);            
+            static void flipNormalTowardsViewpoint(const PointCloud& cloud, float vp_x, float vp_y, float vp_z, Normals& normals, Stream& stream);
             static void flipNormalTowardsViewpoint(const PointCloud& cloud, const Indices& indices, float vp_x, float vp_y, float vp_z, Normals& normals);
+            static void flipNormalTowardsViewpoint(const PointCloud& cloud, const Indices& indices, float vp_x, float vp_y, float vp_z, Normals& normals, Stream& stream);
         private:              
             float vpx_, vpy_, vpz_;
             NeighborIndices nn_indices_;
@@ -157,6 +168,95 @@ namespace pcl
             DeviceArray2D<FPFHSignature33> spfh;
         };      
 
+        ////////////////////////////////////////////////////////////////////////////////////////////  
+        /** \brief @b Class for SHOT estimation, with 352 bins (see pcl::SHOTEstimation). The local reference
+          * frames are computed on the device too, and stored in the rf field of the descriptors.
+          * \note Neighborhoods where the CPU version breaks a tie between the neighbors on both sides of an axis
+          * with the points around the median distance are oriented by the sum of their projections instead,
+          * since the octree does not sort the search results.
+          */
+        class PCL_EXPORTS SHOTEstimation : public FeatureFromNormals
+        {
+        public:
+            SHOTEstimation();
+
+            void compute(DeviceArray2D<SHOT352>& features);
+
+            /** \brief Compute the descriptors of all the points of cloud from neighborhoods found with the radius
+              * given to setRadiusSearch. */
+            void compute(const PointCloud& cloud, const Normals& normals, const NeighborIndices& neighbours, DeviceArray2D<SHOT352>& features);
+
+        private:
+            NeighborIndices nn_indices_;
+        };
+
+        ////////////////////////////////////////////////////////////////////////////////////////////  
+        /** \brief @b Computes normals, FPFH and SHOT descriptors of a cloud that is uploaded once, from a single
+          * octree and radius search shared by all of them. Results are kept on the device until the next
+          * compute; the neighborhoods and the normals are only computed again when the cloud, the search
+          * parameters or the view point change.
+          */
+        class PCL_EXPORTS FeaturePipeline
+        {
+        public:
+            using PointType = Feature::PointType;
+            using NormalType = Feature::NormalType;
+            using PointCloud = Feature::PointCloud;
+            using Normals = Feature::Normals;
+
+            /** \brief Features to compute, can be combined. Normals are always computed, the other two need them. */
+            enum
+            {
+                NORMALS = 1,
+                FPFH = 2,
+                SHOT = 4,
+                ALL = NORMALS | FPFH | SHOT
+            };
+
+            FeaturePipeline();
+
+            /** \brief Upload a host cloud to the device. */
+            void setInputCloud(const pcl::PointCloud<PointType>& cloud);
+
+            /** \brief Use a cloud already on the device. */
+            void setInputCloud(const PointCloud& cloud);
+
+            void setRadiusSearch(float radius, int max_results);
+            void setViewPoint(float  vpx, float  vpy, float  vpz);
+
+            /** \brief Compute the requested features, a combination of NORMALS, FPFH and SHOT. */
+            void compute(int features = ALL);
+
+            /** \brief Run compute (features) on another host thread, so that the calling one can work in the
+              * meantime. The pipeline must not be used until the returned future is ready.
+              */
+            std::future<void> computeAsync(int features = ALL);
+
+            const NeighborIndices& getNeighbors() const { return nn_indices_; }
+            const Normals& getNormals() const { return normals_; }
+            const DeviceArray2D<FPFHSignature33>& getFPFH() const { return fpfh_features_; }
+            const DeviceArray2D<SHOT352>& getSHOT() const { return shot_features_; }
+
+        private:
+            PointCloud cloud_;
+            float radius_;
+            int max_results_;
+            float vpx_, vpy_, vpz_;
+
+            bool neighbors_valid_;
+            bool normals_valid_;
+
+            Octree octree_;
+            NeighborIndices nn_indices_;
+            Normals normals_;
+
+            FPFHEstimation fpfh_;
+            SHOTEstimation shot_;
+
+            DeviceArray2D<FPFHSignature33> fpfh_features_;
+            DeviceArray2D<SHOT352> shot_features_;
+        };
+
         //////////////////////////////////////////////////////////////////////////////////////////////  
         ///** \brief @b Class for PPF estimation.  */
         class PCL_EXPORTS PPFEstimation : public FeatureFromNormals
@@ -63,29 +63,44 @@ void pcl::gpu::FeatureFromNormals::setInputNormals(const Normals& normals)  { no
 pcl::gpu::NormalEstimation::NormalEstimation() : vpx_(0), vpy_(0), vpz_(0) {}
 
 void pcl::gpu::NormalEstimation::computeNormals(const PointCloud& cloud, const NeighborIndices& nn_indices, Normals& normals)
+{
+    computeNormals(cloud, nn_indices, normals, Stream::Null());
+}
+
+void pcl::gpu::NormalEstimation::computeNormals(const PointCloud& cloud, const NeighborIndices& nn_indices, Normals& normals, Stream& stream)
 {       
     normals.create(nn_indices.neighboors_size());    
 
     const device::PointCloud& c = (const device::PointCloud&)cloud;
     device::Normals& n = (device::Normals&)normals;
 
-    device::computeNormals(c, nn_indices, n); 
+    device::computeNormals(c, nn_indices, n, static_cast<cudaStream_t>(stream.handle())); 
 }
 
 void pcl::gpu::NormalEstimation::flipNormalTowardsViewpoint(const PointCloud& cloud, float vp_x, float vp_y, float vp_z, Normals& normals)
+{    
+    flipNormalTowardsViewpoint(cloud, vp_x, vp_y, vp_z, normals, Stream::Null());
+}
+
+void pcl::gpu::NormalEstimation::flipNormalTowardsViewpoint(const PointCloud& cloud, float vp_x, float vp_y, float vp_z, Normals& normals, Stream& stream)
 {    
     const device::PointCloud& c = (const device::PointCloud&)cloud;
     device::Normals& n = (device::Normals&)normals;
 
-    device::flipNormalTowardsViewpoint(c, make_float3(vp_x, vp_y, vp_z), n);
+    device::flipNormalTowardsViewpoint(c, make_float3(vp_x, vp_y, vp_z), n, static_cast<cudaStream_t>(stream.handle()));
 }
 
 void pcl::gpu::NormalEstimation::flipNormalTowardsViewpoint(const PointCloud& cloud, const Indices& indices, float vp_x, float vp_y, float vp_z, Normals& normals)
+{
+    flipNormalTowardsViewpoint(cloud, indices, vp_x, vp_y, vp_z, normals, Stream::Null());
+}
+
+void pcl::gpu::NormalEstimation::flipNormalTowardsViewpoint(const PointCloud& cloud, const Indices& indices, float vp_x, float vp_y, float vp_z, Normals& normals, Stream& stream)
 {
     const device::PointCloud& c = (const device::PointCloud&)cloud;
     device::Normals& n = (device::Normals&)normals;
 
-    device::flipNormalTowardsViewpoint(c, indices, make_float3(vp_x, vp_y, vp_z), n);
+    device::flipNormalTowardsViewpoint(c, indices, make_float3(vp_x, vp_y, vp_z), n, static_cast<cudaStream_t>(stream.handle()));
 }
 
 
@@ -100,25 +115,30 @@ void pcl::gpu::NormalEstimation::getViewPoint (float &vpx, float &vpy, float &vp
 }
 
 void pcl::gpu::NormalEstimation::compute(Normals& normals)
+{
+    compute(normals, Stream::Null());
+}
+
+void pcl::gpu::NormalEstimation::compute(Normals& normals, Stream& stream)
 {
     assert(!cloud_.empty());
 
     PointCloud& surface = surface_.empty() ? cloud_ : surface_;
 
     octree_.setCloud(surface);
-    octree_.build();
+    octree_.build(stream);
 
     if (indices_.empty() || (!indices_.empty() && indices_.size() == cloud_.size()))
     {
-        octree_.radiusSearch(cloud_, radius_, max_results_, nn_indices_);        
-        computeNormals(surface, nn_indices_, normals);
-        flipNormalTowardsViewpoint(cloud_, vpx_, vpy_, vpz_, normals);
+        octree_.radiusSearch(cloud_, radius_, max_results_, nn_indices_, stream);        
+        computeNormals(surface, nn_indices_, normals, stream);
+        flipNormalTowardsViewpoint(cloud_, vpx_, vpy_, vpz_, normals, stream);
     }
     else
     {
-        octree_.radiusSearch(cloud_, indices_, radius_, max_results_, nn_indices_);
-        computeNormals(surface, nn_indices_, normals);
-        flipNormalTowardsViewpoint(cloud_, indices_, vpx_, vpy_, vpz_, normals);
+        octree_.radiusSearch(cloud_, indices_, radius_, max_results_, nn_indices_, stream);
+        computeNormals(surface, nn_indices_, normals, stream);
+        flipNormalTowardsViewpoint(cloud_, indices_, vpx_, vpy_, vpz_, normals, stream);
     }    
 }
 
@@ -275,6 +295,117 @@ void pcl::gpu::FPFHEstimation::compute(DeviceArray2D<FPFHSignature33>& features)
 }
 
 
+/////////////////////////////////////////////////////////////////////////
+/// SHOTEstimation
+
+pcl::gpu::SHOTEstimation::SHOTEstimation()
+{
+    Static<sizeof(SHOTEstimation:: PointType) == sizeof(device:: PointType)>::check();
+    Static<sizeof(SHOTEstimation::NormalType) == sizeof(device::NormalType)>::check();
+    Static<sizeof(SHOT352) == sizeof(device::SHOT352)>::check();
+}
+
+void pcl::gpu::SHOTEstimation::compute(const PointCloud& cloud, const Normals& normals, const NeighborIndices& neighbours, DeviceArray2D<SHOT352>& features)
+{
+    assert( cloud.size() == normals.size() );
+    assert( neighbours.validate(cloud.size()) );
+    assert( radius_ > 0.f );
+
+    const device::PointCloud& c = (const device::PointCloud&)cloud;
+    const device::Normals&    n = (const device::Normals&)normals;
+
+    DeviceArray2D<device::SHOT352>& f = (DeviceArray2D<device::SHOT352>&)features;
+    device::computeSHOT(c, device::Indices(), c, n, neighbours, radius_, f);
+}
+
+void pcl::gpu::SHOTEstimation::compute(DeviceArray2D<SHOT352>& features)
+{
+    assert( !cloud_.empty() && max_results_ > 0 && radius_ > 0.f );
+    assert( surface_.empty() ? normals_.size() == cloud_.size() : normals_.size() == surface_.size() );
+
+    PointCloud& surface = surface_.empty() ? cloud_ : surface_;
+
+    octree_.setCloud(surface);
+    octree_.build();
+
+    bool hasInds = !indices_.empty() && indices_.size() != cloud_.size();
+    if (hasInds)
+        octree_.radiusSearch(cloud_, indices_, radius_, max_results_, nn_indices_);
+    else
+        octree_.radiusSearch(cloud_, radius_, max_results_, nn_indices_);
+
+    const device::PointCloud& c = (const device::PointCloud&)cloud_;
+    const device::PointCloud& s = (const device::PointCloud&)surface;
+    const device::Normals&    n = (const device::Normals&)normals_;
+
+    DeviceArray2D<device::SHOT352>& f = (DeviceArray2D<device::SHOT352>&)features;
+    device::computeSHOT(c, hasInds ? indices_ : device::Indices(), s, n, nn_indices_, radius_, f);
+}
+
+/////////////////////////////////////////////////////////////////////////
+/// FeaturePipeline
+
+pcl::gpu::FeaturePipeline::FeaturePipeline()
+    : radius_(0.f), max_results_(0), vpx_(0.f), vpy_(0.f), vpz_(0.f), neighbors_valid_(false), normals_valid_(false) {}
+
+void pcl::gpu::FeaturePipeline::setInputCloud(const pcl::PointCloud<PointType>& cloud)
+{
+    cloud_.upload(cloud.points);
+    neighbors_valid_ = normals_valid_ = false;
+}
+
+void pcl::gpu::FeaturePipeline::setInputCloud(const PointCloud& cloud)
+{
+    cloud_ = cloud;
+    neighbors_valid_ = normals_valid_ = false;
+}
+
+void pcl::gpu::FeaturePipeline::setRadiusSearch(float radius, int max_results)
+{
+    radius_ = radius; max_results_ = max_results;
+    neighbors_valid_ = normals_valid_ = false;
+}
+
+void pcl::gpu::FeaturePipeline::setViewPoint(float vpx, float vpy, float vpz)
+{
+    vpx_ = vpx; vpy_ = vpy; vpz_ = vpz;
+    normals_valid_ = false;
+}
+
+void pcl::gpu::FeaturePipeline::compute(int features)
+{
+    assert( !cloud_.empty() && max_results_ > 0 && radius_ > 0.f );
+
+    if (!neighbors_valid_)
+    {
+        octree_.setCloud(cloud_);
+        octree_.build();
+        octree_.radiusSearch(cloud_, radius_, max_results_, nn_indices_);
+        neighbors_valid_ = true;
+    }
+
+    if (!normals_valid_)
+    {
+        NormalEstimation::computeNormals(cloud_, nn_indices_, normals_);
+        NormalEstimation::flipNormalTowardsViewpoint(cloud_, vpx_, vpy_, vpz_, normals_);
+        normals_valid_ = true;
+    }
+
+    if (features & FPFH)
+        fpfh_.compute(cloud_, normals_, nn_indices_, fpfh_features_);
+
+    if (features & SHOT)
+    {
+        shot_.setRadiusSearch(radius_, max_results_);
+        shot_.compute(cloud_, normals_, nn_indices_, shot_features_);
+    }
+}
+
+std::future<void> pcl::gpu::FeaturePipeline::computeAsync(int features)
+{
+    return std::async(std::launch::async, [this, features] { compute(features); });
+}
+
 /////////////////////////////////////////////////////////////////////////
 /// PPFEstimation      
 
@@ -75,6 +75,12 @@ namespace pcl
 		using FPFHSignature33 = Histogram<33>;
 		using VFHSignature308 = Histogram<308>;
 
+        struct SHOT352
+        {
+            float descriptor[352];
+            float rf[9];
+        };
+
         struct PPFSignature
         {
             float f1, f2, f3, f4;
@@ -105,9 +111,9 @@ namespace pcl
         };
 
         // normals estimation
-        void computeNormals(const PointCloud& cloud, const NeighborIndices& nn_indices, Normals& normals);
-        void flipNormalTowardsViewpoint(const PointCloud& cloud, const float3& vp, Normals& normals);        
-        void flipNormalTowardsViewpoint(const PointCloud& cloud, const Indices& indices, const float3& vp, Normals& normals);
+        void computeNormals(const PointCloud& cloud, const NeighborIndices& nn_indices, Normals& normals, cudaStream_t stream = 0);
+        void flipNormalTowardsViewpoint(const PointCloud& cloud, const float3& vp, Normals& normals, cudaStream_t stream = 0);        
+        void flipNormalTowardsViewpoint(const PointCloud& cloud, const Indices& indices, const float3& vp, Normals& normals, cudaStream_t stream = 0);
 
         // pfh estimation        
         void repackToAosForPfh(const PointCloud& cloud, const Normals& normals, const NeighborIndices& neighbours, DeviceArray2D<float>& data_rpk, int& max_elems_rpk);
@@ -126,6 +132,10 @@ namespace pcl
 
         int computeUniqueIndices(std::size_t surface_size, const NeighborIndices& neighbours, DeviceArray<int>& unique_indices, DeviceArray<int>& lookup);
 
+        // shot estimation
+        void computeSHOT(const PointCloud& cloud, const Indices& indices, const PointCloud& surface, const Normals& normals,
+            const NeighborIndices& neighbours, float radius, DeviceArray2D<SHOT352>& features);
+
         // ppf estimation         
         void computePPF(const PointCloud& input, const Normals& normals, const Indices& indices, DeviceArray<PPFSignature>& output);
         void computePPFRGB(const PointXYZRGBCloud& input, const Normals& normals, const Indices& indices, DeviceArray<PPFRGBSignature>& output);        
@@ -232,7 +232,7 @@ namespace pcl
     }
 }
 
-void pcl::device::computeNormals(const PointCloud& cloud, const NeighborIndices& nn_indices, Normals& normals)
+void pcl::device::computeNormals(const PointCloud& cloud, const NeighborIndices& nn_indices, Normals& normals, cudaStream_t stream)
 {
     NormalsEstimator est;
     est.indices = nn_indices;    
@@ -244,13 +244,14 @@ void pcl::device::computeNormals(const PointCloud& cloud, const NeighborIndices&
 
     int block = NormalsEstimator::CTA_SIZE;
     int grid = divUp((int)normals.size(), NormalsEstimator::WAPRS);
-    EstimateNormaslKernel<<<grid, block>>>(est);
+    EstimateNormaslKernel<<<grid, block, 0, stream>>>(est);
 
     cudaSafeCall( cudaGetLastError() );        
-    cudaSafeCall(cudaDeviceSynchronize());
+    if (stream == 0)
+        cudaSafeCall(cudaDeviceSynchronize());
 }
 
-void pcl::device::flipNormalTowardsViewpoint(const PointCloud& cloud, const float3& vp, Normals& normals)
+void pcl::device::flipNormalTowardsViewpoint(const PointCloud& cloud, const float3& vp, Normals& normals, cudaStream_t stream)
 {
     int block = 256;
     int grid = divUp((int)normals.size(), block);
@@ -260,12 +261,13 @@ void pcl::device::flipNormalTowardsViewpoint(const PointCloud& cloud, const floa
     flip.vp = vp;
     flip.normals = normals;
 
-    flipNormalTowardsViewpointKernel<<<grid, block>>>(flip);
+    flipNormalTowardsViewpointKernel<<<grid, block, 0, stream>>>(flip);
     cudaSafeCall( cudaGetLastError() );        
-    cudaSafeCall(cudaDeviceSynchronize());
+    if (stream == 0)
+        cudaSafeCall(cudaDeviceSynchronize());
 }
 
-void pcl::device::flipNormalTowardsViewpoint(const PointCloud& cloud, const Indices& indices, const float3& vp, Normals& normals)
+void pcl::device::flipNormalTowardsViewpoint(const PointCloud& cloud, const Indices& indices, const float3& vp, Normals& normals, cudaStream_t stream)
 {
     int block = 256;
     int grid = divUp((int)normals.size(), block);
@@ -275,7 +277,8 @@ void pcl::device::flipNormalTowardsViewpoint(const PointCloud& cloud, const Indi
     flip.vp = vp;
     flip.normals = normals;
 
-    flipNormalTowardsViewpointKernel<<<grid, block>>>(flip, indices.ptr());
+    flipNormalTowardsViewpointKernel<<<grid, block, 0, stream>>>(flip, indices.ptr());
     cudaSafeCall( cudaGetLastError() );        
-    cudaSafeCall(cudaDeviceSynchronize());
+    if (stream == 0)
+        cudaSafeCall(cudaDeviceSynchronize());
 }
\ No newline at end of file
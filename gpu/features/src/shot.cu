@@ -0,0 +1,387 @@
+/*
+* Software License Agreement (BSD License)
+*
+*  Copyright (c) 2011, Willow Garage, Inc.
+*  All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions
+*  are met:
+*
+*   * Redistributions of source code must retain the above copyright
+*     notice, this list of conditions and the following disclaimer.
+*   * Redistributions in binary form must reproduce the above
+*     copyright notice, this list of conditions and the following
+*     disclaimer in the documentation and/or other materials provided
+*     with the distribution.
+*   * Neither the name of Willow Garage, Inc. nor the names of its
+*     contributors may be used to endorse or promote products derived
+*     from this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+*  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+*  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+*  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+*  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+*  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+*  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+*  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+*  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "internal.hpp"
+#include "pcl/gpu/utils/device/warp.hpp"
+#include "pcl/gpu/utils/device/vector_math.hpp"
+#include "pcl/gpu/utils/safe_call.hpp"
+#include "pcl/gpu/features/device/eigen.hpp"
+
+namespace pcl
+{
+    namespace device
+    {
+        struct ShotImpl
+        {
+            enum
+            {
+                CTA_SIZE = 256,
+                WARPS = CTA_SIZE/Warp::WARP_SIZE,
+
+                NR_SHAPE_BINS = 10,
+                NR_GRID_SECTORS = 32,
+                FSize = NR_GRID_SECTORS * (NR_SHAPE_BINS + 1)
+            };
+
+            struct plus 
+            {              
+                __forceinline__ __device__ float operator()(const float &lhs, const volatile float& rhs) const { return lhs + rhs; }
+            }; 
+
+            const PointType *cloud;
+            const PointType *surface;
+            const NormalType *normals;
+            const int *indices;
+
+            PtrStep<int> neighbours;
+            const int *sizes;
+
+            int work_size;
+            float radius;
+
+            mutable PtrStep<float> output;
+
+            __device__ __forceinline__ void operator()() const
+            {
+                __shared__ float cov_buffer[8][CTA_SIZE + 1];
+                __shared__ float shots[WARPS * FSize];
+                __shared__ float3 frames[WARPS][2];
+
+                int warpid = Warp::id();
+                int f = blockIdx.x * WARPS + warpid;
+
+                if (f >= work_size)
+                    return;
+
+                constexpr float NaN = std::numeric_limits<float>::quiet_NaN();
+
+                int lane = Warp::laneId();
+                int tid = threadIdx.x;
+                int size = sizes[f];
+
+                float3 central_point = fetch(cloud, indices ? indices[f] : f);
+                const int* neighbs = neighbours.ptr(f);
+                float* out = output.ptr(f);
+
+                // Local reference frame: covariance of the neighbors weighted by (radius - distance)
+                for(int i = 0; i < 8; ++i)
+                    cov_buffer[i][tid] = 0.f;
+
+                for(int i = lane; i < size; i += Warp::STRIDE)
+                {
+                    float3 d = fetch(surface, neighbs[i]) - central_point;
+                    float distance = norm(d);
+                    if (distance == 0.f)
+                        continue;
+
+                    float weight = radius - distance;
+                    cov_buffer[0][tid] += weight * d.x * d.x;
+                    cov_buffer[1][tid] += weight * d.x * d.y;
+                    cov_buffer[2][tid] += weight * d.x * d.z;
+                    cov_buffer[3][tid] += weight * d.y * d.y;
+                    cov_buffer[4][tid] += weight * d.y * d.z;
+                    cov_buffer[5][tid] += weight * d.z * d.z;
+                    cov_buffer[6][tid] += weight;
+                    cov_buffer[7][tid] += 1.f;
+                }
+
+                for(int i = 0; i < 8; ++i)
+                    Warp::reduce(&cov_buffer[i][tid - lane], plus());
+
+                float weight_sum = cov_buffer[6][tid - lane];
+                float valid = cov_buffer[7][tid - lane];
+
+                if (valid < 5.f)
+                {
+                    Warp::fill(out, out + FSize + 9, NaN);
+                    return;
+                }
+
+                volatile float *cov = &cov_buffer[0][tid - lane];
+                if (lane < 6)
+                    cov[lane] = cov_buffer[lane][tid - lane] / weight_sum;
+
+                //nvcc bug work workaround.
+                __threadfence_block();
+
+                if (lane == 0)
+                {
+                    Eigen33 eigen33(cov);
+
+                    Eigen33::Mat33&     tmp = (Eigen33::Mat33&)cov_buffer[1][tid - lane];
+                    Eigen33::Mat33& vec_tmp = (Eigen33::Mat33&)cov_buffer[2][tid - lane];
+                    Eigen33::Mat33& evecs   = (Eigen33::Mat33&)cov_buffer[3][tid - lane];
+
+                    float3 evals;
+                    eigen33.compute(tmp, vec_tmp, evecs, evals);
+
+                    // x axis: largest eigenvector, z axis: smallest one
+                    frames[warpid][0] = evecs[2];
+                    frames[warpid][1] = evecs[0];
+                }
+                __threadfence_block();
+
+                float3 x_axis = frames[warpid][0];
+                float3 z_axis = frames[warpid][1];
+
+                if (!isfinite(x_axis.x) || !isfinite(z_axis.x))
+                {
+                    Warp::fill(out, out + FSize + 9, NaN);
+                    return;
+                }
+
+                // Disambiguation: orient both axes towards the majority of the neighbors
+                for(int i = 4; i < 8; ++i)
+                    cov_buffer[i][tid] = 0.f;
+
+                for(int i = lane; i < size; i += Warp::STRIDE)
+                {
+                    float3 d = fetch(surface, neighbs[i]) - central_point;
+                    if (d.x == 0.f && d.y == 0.f && d.z == 0.f)
+                        continue;
+
+                    float dp1 = dot(d, x_axis);
+                    float dp3 = dot(d, z_axis);
+                    cov_buffer[4][tid] += dp1 >= 0 ? 1.f : 0.f;
+                    cov_buffer[5][tid] += dp3 >= 0 ? 1.f : 0.f;
+                    cov_buffer[6][tid] += dp1;
+                    cov_buffer[7][tid] += dp3;
+                }
+
+                for(int i = 4; i < 8; ++i)
+                    Warp::reduce(&cov_buffer[i][tid - lane], plus());
+
+                float plus_tangent = 2.f * cov_buffer[4][tid - lane] - valid;
+                float plus_normal  = 2.f * cov_buffer[5][tid - lane] - valid;
+
+                // The CPU version breaks ties with the neighbors around the median distance, which needs sorted
+                // search results; the octree does not sort them, so ties are broken by the sum of the projections.
+                if (plus_tangent < 0 || (plus_tangent == 0 && cov_buffer[6][tid - lane] < 0))
+                    x_axis *= -1.f;
+                if (plus_normal < 0 || (plus_normal == 0 && cov_buffer[7][tid - lane] < 0))
+                    z_axis *= -1.f;
+
+                float3 y_axis = cross(z_axis, x_axis);
+
+                if (lane == 0)
+                {
+                    float *rf = out + FSize;
+                    rf[0] = x_axis.x; rf[1] = x_axis.y; rf[2] = x_axis.z;
+                    rf[3] = y_axis.x; rf[4] = y_axis.y; rf[5] = y_axis.z;
+                    rf[6] = z_axis.x; rf[7] = z_axis.y; rf[8] = z_axis.z;
+                }
+
+                // Descriptor: quadrilinear interpolation of the normal cosines on the spatial grid
+                float* shot = shots + warpid * FSize;
+                Warp::fill(shot, shot + FSize, 0.f);
+
+                for(int i = lane; i < size; i += Warp::STRIDE)
+                {
+                    int neighb_idx = neighbs[i];
+                    float3 normal = fetch(normals, neighb_idx);
+                    if (!isfinite(normal.x) || !isfinite(normal.y) || !isfinite(normal.z))
+                        continue;
+
+                    float3 d = fetch(surface, neighb_idx) - central_point;
+                    float distance = norm(d);
+                    if (distance == 0.f)
+                        continue;
+
+                    float cosine = fmaxf(-1.f, fminf(dot(normal, z_axis), 1.f));
+                    float bin_distance = ((1.f + cosine) * NR_SHAPE_BINS) / 2;
+
+                    vote(shot, dot(d, x_axis), dot(d, y_axis), dot(d, z_axis), distance, bin_distance);
+                }
+
+                // L2 normalization
+                float sqr_norm = 0.f;
+                for(int i = lane; i < FSize; i += Warp::STRIDE)
+                    sqr_norm += shot[i] * shot[i];
+
+                volatile float *buffer = &cov_buffer[0][tid - lane];
+                float inv_norm = rsqrtf(Warp::reduce(buffer, sqr_norm, plus()));
+
+                for(int i = lane; i < FSize; i += Warp::STRIDE)
+                    out[i] = shot[i] * inv_norm;
+            }
+
+            /** Add the votes of a neighbor with coordinates (x, y, z) in the local reference frame, see
+              * pcl::SHOTEstimationBase::interpolateSingleChannel */
+            __device__ __forceinline__ void vote(float* shot, float x, float y, float z, float distance, float bin_distance) const
+            {
+                const float RAD_45 = 0.78539816339744830961566084581988f;
+                const float RAD_90 = 1.5707963267948966192313216916398f;
+                const float RAD_135 = 2.3561944901923449288469825374596f;
+                const float RAD_PI_7_8 = 2.7488935718910690836548129603691f;
+
+                // To avoid numerical problems afterwards
+                if (fabsf(x) < 1e-30f) x = 0.f;
+                if (fabsf(y) < 1e-30f) y = 0.f;
+                if (fabsf(z) < 1e-30f) z = 0.f;
+
+                int bit4 = ((y > 0) || ((y == 0.f) && (x < 0))) ? 1 : 0;
+                int bit3 = ((x > 0) || ((x == 0.f) && (y > 0))) ? !bit4 : bit4;
+                int desc_index = ((bit4 << 3) + (bit3 << 2)) << 1;
+
+                if ((x * y > 0) || (x == 0.f))
+                    desc_index += (fabsf(x) >= fabsf(y)) ? 0 : 4;
+                else
+                    desc_index += (fabsf(x) > fabsf(y)) ? 4 : 0;
+
+                desc_index += z > 0 ? 1 : 0;
+
+                // 2 RADII
+                desc_index += (distance > radius * 0.5f) ? 2 : 0;
+
+                int step_index = static_cast<int>(floorf(bin_distance + 0.5f));
+                int volume_index = desc_index * (NR_SHAPE_BINS + 1);
+
+                //Interpolation on the cosine (adjacent bins in the histogram)
+                bin_distance -= step_index;
+                float weight = 1.f - fabsf(bin_distance);
+
+                if (bin_distance > 0)
+                    atomicAdd(shot + volume_index + ((step_index + 1) % NR_SHAPE_BINS), bin_distance);
+                else
+                    atomicAdd(shot + volume_index + ((step_index - 1 + NR_SHAPE_BINS) % NR_SHAPE_BINS), -bin_distance);
+
+                //Interpolation on the distance (adjacent husks)
+                float radius1_2 = radius * 0.5f, radius1_4 = radius * 0.25f, radius3_4 = radius * 0.75f;
+                if (distance > radius1_2)
+                {
+                    float radius_distance = (distance - radius3_4) / radius1_2;
+                    if (distance > radius3_4)
+                        weight += 1.f - radius_distance;
+                    else
+                    {
+                        weight += 1.f + radius_distance;
+                        atomicAdd(shot + (desc_index - 2) * (NR_SHAPE_BINS + 1) + step_index, -radius_distance);
+                    }
+                }
+                else
+                {
+                    float radius_distance = (distance - radius1_4) / radius1_2;
+                    if (distance < radius1_4)
+                        weight += 1.f + radius_distance;
+                    else
+                    {
+                        weight += 1.f - radius_distance;
+                        atomicAdd(shot + (desc_index + 2) * (NR_SHAPE_BINS + 1) + step_index, radius_distance);
+                    }
+                }
+
+                //Interpolation on the inclination (adjacent vertical volumes)
+                float inclination = acosf(fmaxf(-1.f, fminf(z / distance, 1.f)));
+                if (z <= 0)
+                {
+                    float inclination_distance = (inclination - RAD_135) / RAD_90;
+                    if (inclination > RAD_135)
+                        weight += 1.f - inclination_distance;
+                    else
+                    {
+                        weight += 1.f + inclination_distance;
+                        atomicAdd(shot + (desc_index + 1) * (NR_SHAPE_BINS + 1) + step_index, -inclination_distance);
+                    }
+                }
+                else
+                {
+                    float inclination_distance = (inclination - RAD_45) / RAD_90;
+                    if (inclination < RAD_45)
+                        weight += 1.f + inclination_distance;
+                    else
+                    {
+                        weight += 1.f - inclination_distance;
+                        atomicAdd(shot + (desc_index - 1) * (NR_SHAPE_BINS + 1) + step_index, inclination_distance);
+                    }
+                }
+
+                if (y != 0.f || x != 0.f)
+                {
+                    //Interpolation on the azimuth (adjacent horizontal volumes)
+                    int sel = desc_index >> 2;
+                    float azimuth_distance = (atan2f(y, x) - (-RAD_PI_7_8 + RAD_45 * sel)) / RAD_45;
+                    azimuth_distance = fmaxf(-0.5f, fminf(azimuth_distance, 0.5f));
+
+                    if (azimuth_distance > 0)
+                    {
+                        weight += 1.f - azimuth_distance;
+                        int interp_index = (desc_index + 4) % NR_GRID_SECTORS;
+                        atomicAdd(shot + interp_index * (NR_SHAPE_BINS + 1) + step_index, azimuth_distance);
+                    }
+                    else
+                    {
+                        weight += 1.f + azimuth_distance;
+                        int interp_index = (desc_index - 4 + NR_GRID_SECTORS) % NR_GRID_SECTORS;
+                        atomicAdd(shot + interp_index * (NR_SHAPE_BINS + 1) + step_index, -azimuth_distance);
+                    }
+                }
+
+                atomicAdd(shot + volume_index + step_index, weight);
+            }
+
+            template<class T> __forceinline__ __device__ float3 fetch(const T* data, int index) const
+            {
+                T t = data[index];
+                return make_float3(t.x, t.y, t.z);
+            }
+        };
+
+        __global__ void shotKernel(const ShotImpl impl) { impl(); }
+    }
+}
+
+void pcl::device::computeSHOT(const PointCloud& cloud, const Indices& indices, const PointCloud& surface, const Normals& normals,
+                              const NeighborIndices& neighbours, float radius, DeviceArray2D<SHOT352>& features)
+{
+    ShotImpl impl;
+    impl.cloud = cloud;
+    impl.surface = surface;
+    impl.normals = normals;
+    impl.indices = indices;
+
+    impl.neighbours = neighbours;
+    impl.sizes = neighbours.sizes;
+
+    impl.work_size = indices.empty() ? (int)cloud.size() : (int)indices.size();
+    impl.radius = radius;
+
+    features.create(impl.work_size, 1);
+    impl.output = features;
+
+    int block = ShotImpl::CTA_SIZE;
+    int grid = divUp(impl.work_size, ShotImpl::WARPS);
+    shotKernel<<<grid, block>>>(impl);
+    cudaSafeCall( cudaGetLastError() );
+    cudaSafeCall( cudaDeviceSynchronize() );
+}
@@ -0,0 +1,187 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2011, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *  Author: Anatoly Baskeheev, Itseez Ltd, (myname.mysurname@mycompany.com)
+ */
+
+#include "gtest/gtest.h"
+
+#include <pcl/point_types.h>
+#include <pcl/features/shot.h>
+#include <pcl/features/normal_3d.h>
+#include <pcl/io/pcd_io.h>
+#include <pcl/common/common.h>
+#include <pcl/gpu/features/features.hpp>
+#include "data_source.hpp"
+
+using namespace pcl;
+using namespace pcl::gpu;
+
+//TEST(PCL_FeaturesGPU, DISABLED_shot_low_level)
+TEST(PCL_FeaturesGPU, shot_low_level)
+{
+    DataSource source;
+
+    source.estimateNormals();
+    source.findRadiusNeghbors();
+    std::cout << "max_radius_nn_size: " << source.max_nn_size << std::endl;
+
+    std::vector<int> data;
+    source.getNeghborsArray(data);
+    std::vector<PointXYZ> normals_for_gpu(source.normals->size());
+    std::transform(source.normals->points.begin(), source.normals->points.end(), normals_for_gpu.begin(), DataSource::Normal2PointXYZ());
+
+    //uploading data to GPU
+    pcl::gpu::SHOTEstimation::PointCloud cloud_gpu;
+    cloud_gpu.upload(source.cloud->points);
+
+    pcl::gpu::SHOTEstimation::Normals normals_gpu;
+    normals_gpu.upload(normals_for_gpu);
+
+    pcl::gpu::NeighborIndices indices;
+    indices.upload(data, source.sizes, source.max_nn_size);
+
+    DeviceArray2D<SHOT352> shot_features;
+
+    gpu::SHOTEstimation shot_gpu;
+    shot_gpu.setRadiusSearch(source.radius, source.max_elements);
+    shot_gpu.compute(cloud_gpu, normals_gpu, indices, shot_features);
+
+    int stub;
+    std::vector<SHOT352> downloaded;
+    shot_features.download(downloaded, stub);
+
+    pcl::SHOTEstimation<PointXYZ, Normal, SHOT352> se;
+    se.setInputCloud (source.cloud);
+    se.setInputNormals (source.normals);
+    se.setSearchMethod (pcl::search::KdTree<PointXYZ>::Ptr (new pcl::search::KdTree<PointXYZ>));
+    se.setRadiusSearch (source.radius);
+
+    PointCloud<SHOT352> shots;
+    se.compute (shots);
+
+    ASSERT_EQ(downloaded.size(), shots.size());
+
+    // Frames oriented by a tie break differ from the CPU ones, so only most descriptors must match
+    std::size_t valid = 0, matching = 0;
+    for(std::size_t i = 0; i < downloaded.size(); ++i)
+    {
+        SHOT352& gpu = downloaded[i];
+        SHOT352& cpu = shots[i];
+
+        if (!std::isfinite(cpu.descriptor[0]))
+        {
+            ASSERT_FALSE(std::isfinite(gpu.descriptor[0]));
+            continue;
+        }
+        ++valid;
+
+        float norm = 0, norm_diff = 0;
+        for(std::size_t j = 0; j < 352; ++j)
+        {
+            norm_diff += (gpu.descriptor[j] - cpu.descriptor[j]) * (gpu.descriptor[j] - cpu.descriptor[j]);
+            norm += cpu.descriptor[j] * cpu.descriptor[j];
+        }
+        if (norm_diff/norm < 0.01f/352)
+            ++matching;
+    }
+    ASSERT_GE(matching, valid * 95 / 100);
+}
+
+//TEST(PCL_FeaturesGPU, DISABLED_feature_pipeline)
+TEST(PCL_FeaturesGPU, feature_pipeline)
+{
+    DataSource source;
+
+    //GPU pipeline, run while this thread does something else
+    pcl::gpu::FeaturePipeline pipeline;
+    pipeline.setInputCloud(*source.cloud);
+    pipeline.setRadiusSearch(source.radius, source.max_elements);
+
+    std::future<void> done = pipeline.computeAsync(FeaturePipeline::ALL);
+    source.estimateNormals();
+    done.get();
+
+    //Same features, with a search per feature
+    pcl::gpu::FeaturePipeline::PointCloud cloud_gpu;
+    cloud_gpu.upload(source.cloud->points);
+
+    pcl::gpu::NormalEstimation ne_gpu;
+    ne_gpu.setInputCloud(cloud_gpu);
+    ne_gpu.setRadiusSearch(source.radius, source.max_elements);
+    pcl::gpu::NormalEstimation::Normals normals_gpu;
+    ne_gpu.compute(normals_gpu);
+
+    pcl::gpu::FPFHEstimation fpfh_gpu;
+    fpfh_gpu.setInputCloud(cloud_gpu);
+    fpfh_gpu.setInputNormals(normals_gpu);
+    fpfh_gpu.setRadiusSearch(source.radius, source.max_elements);
+    DeviceArray2D<FPFHSignature33> fpfhs_gpu;
+    fpfh_gpu.compute(fpfhs_gpu);
+
+    pcl::gpu::SHOTEstimation shot_gpu;
+    shot_gpu.setInputCloud(cloud_gpu);
+    shot_gpu.setInputNormals(normals_gpu);
+    shot_gpu.setRadiusSearch(source.radius, source.max_elements);
+    DeviceArray2D<SHOT352> shots_gpu;
+    shot_gpu.compute(shots_gpu);
+
+    std::vector<PointXYZ> normals, pipeline_normals;
+    normals_gpu.download(normals);
+    pipeline.getNormals().download(pipeline_normals);
+    ASSERT_EQ(pipeline_normals.size(), normals.size());
+    for(std::size_t i = 0; i < normals.size(); ++i)
+    {
+        ASSERT_NEAR(pipeline_normals[i].x, normals[i].x, 1e-5f);
+        ASSERT_NEAR(pipeline_normals[i].y, normals[i].y, 1e-5f);
+        ASSERT_NEAR(pipeline_normals[i].z, normals[i].z, 1e-5f);
+    }
+
+    int stub;
+    std::vector<FPFHSignature33> fpfhs, pipeline_fpfhs;
+    fpfhs_gpu.download(fpfhs, stub);
+    pipeline.getFPFH().download(pipeline_fpfhs, stub);
+    ASSERT_EQ(pipeline_fpfhs.size(), fpfhs.size());
+    for(std::size_t i = 0; i < fpfhs.size(); ++i)
+        for(std::size_t j = 0; j < 33; ++j)
+            ASSERT_NEAR(pipeline_fpfhs[i].histogram[j], fpfhs[i].histogram[j], 1e-4f);
+
+    std::vector<SHOT352> shots, pipeline_shots;
+    shots_gpu.download(shots, stub);
+    pipeline.getSHOT().download(pipeline_shots, stub);
+    ASSERT_EQ(pipeline_shots.size(), shots.size());
+    for(std::size_t i = 0; i < shots.size(); ++i)
+        for(std::size_t j = 0; j < 352; ++j)
+            if (std::isfinite(shots[i].descriptor[j]))
+                ASSERT_NEAR(pipeline_shots[i].descriptor[j], shots[i].descriptor[j], 1e-4f);
+}
@@ -0,0 +1,174 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2019-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <pcl/memory.h>
+#include <pcl/pcl_macros.h>
+#include <pcl/gpu/containers/device_array.h>
+#include <Eigen/Geometry>
+
+namespace pcl
+{
+  namespace gpu
+  {
+    /** \brief HashedTsdfVolume is a sparse TSDF volume for KinfuTracker. Instead of a dense grid of fixed extent,
+      * blocks of 8x8x8 voxels are allocated where a depth image observes a surface. The blocks are found through a
+      * hash table on the GPU, so the memory depends on the observed surface area instead of the volume of the scene
+      * and the reconstruction is not bounded in space.
+      *
+      * Memory for max_blocks blocks is allocated up front. Blocks are never freed, so integration stops extending
+      * the volume once it is full.
+      */
+    class PCL_EXPORTS HashedTsdfVolume
+    {
+    public:
+      using Ptr = shared_ptr<HashedTsdfVolume>;
+      using ConstPtr = shared_ptr<const HashedTsdfVolume>;
+
+      /** \brief Constructor
+        * \param[in] voxel_size voxel edge length in meters
+        * \param[in] max_blocks maximum number of allocated voxel blocks
+        * \param[in] hash_buckets number of buckets of the hash table, rounded up to a power of two.
+        * Should be a few times max_blocks.
+        */
+      HashedTsdfVolume (float voxel_size = 0.005f, int max_blocks = 1 << 18, int hash_buckets = 1 << 21);
+
+      /** \brief Sets Tsdf truncation distance. Must be greater than 2 * voxel_size
+        * \param[in] distance TSDF truncation distance
+        */
+      void
+      setTsdfTruncDist (float distance);
+
+      /** \brief Returns tsdf truncation distance in meters */
+      float
+      getTsdfTruncDist () const { return (tranc_dist_); }
+
+      /** \brief Returns voxel size in meters */
+      float
+      getVoxelSize () const { return (voxel_size_); }
+
+      /** \brief Sets the distance up to which rays are traced in raycast
+        * \param[in] distance maximum raycasting distance in meters
+        */
+      void
+      setMaxRaycastDistance (float distance) { max_raycast_distance_ = distance; }
+
+      /** \brief Returns the distance up to which rays are traced in raycast */
+      float
+      getMaxRaycastDistance () const { return (max_raycast_distance_); }
+
+      /** \brief Returns maximum number of voxel blocks */
+      int
+      getMaxBlocks () const { return (max_blocks_); }
+
+      /** \brief Returns number of allocated voxel blocks */
+      int
+      getNumberOfBlocks () const { return (blocks_num_); }
+
+      /** \brief Frees all voxel blocks */
+      void
+      reset ();
+
+      /** \brief Allocates the voxel blocks around the surface seen in a depth image and integrates it.
+        * \param[in] depth Kinect depth image in millimeters
+        * \param[in] fx focal length x
+        * \param[in] fy focal length y
+        * \param[in] cx principal point x
+        * \param[in] cy principal point y
+        * \param[in] camera_pose camera pose in the volume coordinate system
+        */
+      void
+      integrate (const DeviceArray2D<unsigned short>& depth, float fx, float fy, float cx, float cy,
+                 const Eigen::Affine3f& camera_pose);
+
+      /** \brief Generates vertex and normal maps for a camera pose
+        * \param[in] fx focal length x
+        * \param[in] fy focal length y
+        * \param[in] cx principal point x
+        * \param[in] cy principal point y
+        * \param[in] camera_pose camera pose in the volume coordinate system
+        * \param[out] vmap vertex map, the rows of the image times 3 by its cols
+        * \param[out] nmap normal map, same layout as vmap
+        */
+      void
+      raycast (float fx, float fy, float cx, float cy, const Eigen::Affine3f& camera_pose,
+               DeviceArray2D<float>& vmap, DeviceArray2D<float>& nmap) const;
+
+      /** \brief Returns the hash table keys, the packed block coordinates per bucket */
+      const DeviceArray<unsigned long long>&
+      hashKeys () const { return (keys_); }
+
+      /** \brief Returns the block index per hash bucket, -1 for none */
+      const DeviceArray<int>&
+      hashBlocks () const { return (blocks_); }
+
+      /** \brief Returns the coordinates of the voxel blocks in units of blocks, 4 ints per block */
+      const DeviceArray<int>&
+      blockCoordinates () const { return (coords_); }
+
+      /** \brief Returns the voxels, 512 per block with x running fastest, each packed like in TsdfVolume */
+      const DeviceArray<int>&
+      data () const { return (voxels_); }
+
+      /** \brief Returns the device counter of requested blocks */
+      const DeviceArray<int>&
+      blockCounter () const { return (block_count_); }
+
+    private:
+      /** \brief voxel size in meters */
+      float voxel_size_;
+
+      /** \brief tsdf truncation distance */
+      float tranc_dist_;
+
+      /** \brief maximum raycasting distance */
+      float max_raycast_distance_;
+
+      /** \brief capacity in voxel blocks */
+      int max_blocks_;
+
+      /** \brief number of allocated voxel blocks */
+      int blocks_num_;
+
+      DeviceArray<unsigned long long> keys_;
+      DeviceArray<int> blocks_;
+      DeviceArray<int> coords_;
+      DeviceArray<int> voxels_;
+      DeviceArray<int> block_count_;
+    };
+  }
+}
@@ -42,6 +42,7 @@
 #include <pcl/gpu/containers/device_array.h>
 #include <pcl/gpu/kinfu/pixel_rgb.h>
 #include <pcl/gpu/kinfu/tsdf_volume.h>
+#include <pcl/gpu/kinfu/hashed_tsdf_volume.h>
 #include <pcl/gpu/kinfu/color_volume.h>
 #include <pcl/gpu/kinfu/raycaster.h>
 #include <pcl/point_types.h>
@@ -173,6 +174,19 @@ namespace pcl
         /** \brief Returns TSDF volume storage */
         TsdfVolume& volume();
 
+        /** \brief Makes the tracker integrate into and raycast from a hashed volume instead of the dense volume.
+          * The hashed volume is not bounded by the volume size, so the camera can move freely. The dense volume
+          * stays allocated but is not updated. Color integration is not supported with a hashed volume.
+          * Resets the tracker.
+          * \param[in] volume hashed volume, a null pointer switches back to the dense volume
+          */
+        void
+        setHashedVolume (const HashedTsdfVolume::Ptr& volume);
+
+        /** \brief Returns the hashed volume, a null pointer if the dense volume is used */
+        HashedTsdfVolume::Ptr
+        getHashedVolume () const;
+
         /** \brief Returns color volume storage */
         const ColorVolume& colorVolume() const;
 
@@ -230,6 +244,9 @@ namespace pcl
         /** \brief Tsdf volume container. */
         TsdfVolume::Ptr tsdf_volume_;
         ColorVolume::Ptr color_volume_;
+
+        /** \brief Optional hashed volume used instead of tsdf_volume_. */
+        HashedTsdfVolume::Ptr hashed_volume_;
                 
         /** \brief Initial camera rotation in volume coo space. */
         Matrix3frm init_Rcam_;
@@ -47,6 +47,7 @@ namespace pcl
   namespace gpu
   {
     class TsdfVolume;
+    class HashedTsdfVolume;
       
     /** \brief MarchingCubes implements MarchingCubes functionality for TSDF volume on GPU
       * \author Anatoly Baskeheev, Itseez Ltd, (myname.mysurname@mycompany.com)
@@ -83,6 +84,14 @@ namespace pcl
       DeviceArray<PointType> 
       run(const TsdfVolume& tsdf, DeviceArray<PointType>& triangles_buffer);
 
+      /** \brief Runs marching cubes triangulation on the allocated blocks of a hashed volume.
+          * \param[in] tsdf hashed tsdf volume
+          * \param[in] triangles_buffer Buffer for triangles. Its size determines max extracted triangles. If empty, it will be allocated with default size to be used.
+          * \return Array with triangles. Each 3 consequent points belong to a single triangle. The returned array points to 'triangles_buffer' data.
+          */
+      DeviceArray<PointType>
+      run(const HashedTsdfVolume& tsdf, DeviceArray<PointType>& triangles_buffer);
+
     private:             
       /** \brief Edge table for marching cubes  */
       DeviceArray<int> edgeTable_;
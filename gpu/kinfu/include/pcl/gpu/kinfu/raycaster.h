@@ -49,6 +49,7 @@ namespace pcl
   namespace gpu
   {
     class TsdfVolume;
+    class HashedTsdfVolume;
 
     /** \brief Class that performs raycasting for TSDF volume
       * \author Anatoly Baskeheev, Itseez Ltd, (myname.mysurname@mycompany.com)
@@ -87,6 +88,13 @@ namespace pcl
       void 
       run(const TsdfVolume& volume, const Eigen::Affine3f& camera_pose);
 
+      /** \brief Runs raycasting algorithm on a hashed volume from given camera pose. It writes results to internal files.
+        * \param[in] volume hashed tsdf volume
+        * \param[in] camera_pose camera pose
+        */
+      void
+      run(const HashedTsdfVolume& volume, const Eigen::Affine3f& camera_pose);
+
       /** \brief Generates scene view using data raycasted by run method. So call it before.
         * \param[out] view output array for RGB image        
         */
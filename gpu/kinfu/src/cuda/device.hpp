@@ -99,6 +99,54 @@ namespace pcl
       else
         return (lane > 0) ? ptr[idx - 1] : 0;
     }
+
+    ////////////////////////////////////////////////////////////////////////////////////////
+    ///// Voxel block hashing
+
+    __device__ __forceinline__ unsigned long long
+    packBlockKey (int x, int y, int z)
+    {
+      const unsigned long long mask = (1ull << 21) - 1; // 21 bits per coordinate
+      return ((x & mask) << 42) | ((y & mask) << 21) | (z & mask);
+    }
+
+    __device__ __forceinline__ unsigned int
+    hashBlockKey (int x, int y, int z, unsigned int buckets)
+    {
+      return (((unsigned int)x * 73856093u) ^ ((unsigned int)y * 19349663u) ^ ((unsigned int)z * 83492791u)) & (buckets - 1);
+    }
+
+    /** \brief Returns the index of the block at block coordinates (x, y, z), -1 if it is not allocated */
+    __device__ __forceinline__ int
+    findHashedBlock (const HashedVolume& volume, int x, int y, int z)
+    {
+      const unsigned long long key = packBlockKey (x, y, z);
+      const unsigned int mask = volume.keys.size - 1;
+      unsigned int bucket = hashBlockKey (x, y, z, volume.keys.size);
+
+      for (int i = 0; i < HASH_MAX_PROBES; ++i, bucket = (bucket + 1) & mask)
+      {
+        const unsigned long long k = volume.keys.data[bucket];
+        if (k == key)
+          return volume.blocks.data[bucket];
+        if (k == HASH_EMPTY_KEY)
+          break;
+      }
+      return -1;
+    }
+
+    /** \brief Returns the voxel at voxel coordinates (x, y, z), nullptr if its block is not allocated */
+    __device__ __forceinline__ short2*
+    findHashedVoxel (const HashedVolume& volume, int x, int y, int z)
+    {
+      // arithmetic shifts round towards negative infinity
+      const int block = findHashedBlock (volume, x >> HASH_BLOCK_SHIFT, y >> HASH_BLOCK_SHIFT, z >> HASH_BLOCK_SHIFT);
+      if (block < 0)
+        return nullptr;
+
+      const int mask = HASH_BLOCK_SIZE - 1;
+      return volume.voxels.data + block * HASH_BLOCK_VOXELS + (((z & mask) << HASH_BLOCK_SHIFT) + (y & mask)) * HASH_BLOCK_SIZE + (x & mask);
+    }
   }
 }
 
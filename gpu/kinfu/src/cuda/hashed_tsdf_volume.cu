@@ -0,0 +1,457 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2019-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "device.hpp"
+
+namespace pcl
+{
+  namespace device
+  {
+    struct HashedBlockAllocator
+    {
+      enum { CTA_SIZE_X = 32, CTA_SIZE_Y = 8 };
+
+      HashedVolume volume;
+
+      Intr intr;
+
+      Mat33 Rcurr;
+      float3 tcurr;
+
+      PtrStepSz<ushort> depth_raw; //depth in mm
+
+      float tranc_dist;
+
+      __device__ __forceinline__ void
+      allocate (int x, int y, int z) const
+      {
+        const unsigned long long key = packBlockKey (x, y, z);
+        const unsigned int mask = volume.keys.size - 1;
+        unsigned int bucket = hashBlockKey (x, y, z, volume.keys.size);
+
+        for (int i = 0; i < HASH_MAX_PROBES; ++i, bucket = (bucket + 1) & mask)
+        {
+          const unsigned long long prev = atomicCAS (volume.keys.data + bucket, HASH_EMPTY_KEY, key);
+          if (prev == HASH_EMPTY_KEY)
+          {
+            // this thread inserted the key, the bucket stays without block if the volume is full
+            const int block = atomicAdd (volume.block_count, 1);
+            if (block < (int)volume.coords.size)
+            {
+              volume.coords.data[block] = make_int4 (x, y, z, 0);
+              volume.blocks.data[bucket] = block;
+            }
+            return;
+          }
+          if (prev == key)
+            return;
+        }
+      }
+
+      __device__ __forceinline__ void
+      operator () () const
+      {
+        int x = threadIdx.x + blockIdx.x * CTA_SIZE_X;
+        int y = threadIdx.y + blockIdx.y * CTA_SIZE_Y;
+
+        if (x >= depth_raw.cols || y >= depth_raw.rows)
+          return;
+
+        int Dp = depth_raw.ptr (y)[x];
+        if (Dp == 0)
+          return;
+
+        float d = Dp * 0.001f; //meters
+        float3 v = make_float3 ((x - intr.cx) / intr.fx * d, (y - intr.cy) / intr.fy * d, d);
+        float3 v_g = Rcurr * v + tcurr;
+        float3 dir = normalized (v_g - tcurr);
+
+        // walk the truncation band along the ray, in steps of at most half a block
+        const float block_size = volume.voxel_size * HASH_BLOCK_SIZE;
+        const float step = fmin (tranc_dist, block_size) * 0.5f;
+        const int steps = __float2int_ru (2.f * tranc_dist / step);
+
+        int3 prev = make_int3 (0, 0, 0);
+        for (int i = 0; i <= steps; ++i)
+        {
+          float3 p = v_g + dir * (i * step - tranc_dist);
+          int3 b = make_int3 (__float2int_rd (p.x / block_size), __float2int_rd (p.y / block_size), __float2int_rd (p.z / block_size));
+
+          if (i > 0 && b.x == prev.x && b.y == prev.y && b.z == prev.z)
+            continue;
+
+          allocate (b.x, b.y, b.z);
+          prev = b;
+        }
+      }
+    };
+
+    __global__ void
+    allocateHashedBlocksKernel (const HashedBlockAllocator ha) {
+      ha ();
+    }
+
+    struct HashedTsdf
+    {
+      enum { CTA_SIZE = HASH_BLOCK_VOXELS };
+
+      static constexpr int MAX_WEIGHT = 1 << 7;
+
+      HashedVolume volume;
+
+      Intr intr;
+
+      Mat33 Rcurr_inv;
+      float3 tcurr;
+
+      PtrStepSz<ushort> depth_raw; //depth in mm
+
+      float tranc_dist;
+
+      __device__ __forceinline__ void
+      operator () () const
+      {
+        // one cuda block per voxel block, one thread per voxel
+        const int4 block = volume.coords.data[blockIdx.x];
+        const int mask = HASH_BLOCK_SIZE - 1;
+
+        float3 v_g;
+        v_g.x = ((block.x << HASH_BLOCK_SHIFT) + (threadIdx.x & mask) + 0.5f) * volume.voxel_size;
+        v_g.y = ((block.y << HASH_BLOCK_SHIFT) + ((threadIdx.x >> HASH_BLOCK_SHIFT) & mask) + 0.5f) * volume.voxel_size;
+        v_g.z = ((block.z << HASH_BLOCK_SHIFT) + (threadIdx.x >> (2 * HASH_BLOCK_SHIFT)) + 0.5f) * volume.voxel_size;
+
+        //transform to curr cam coo space
+        float3 v = Rcurr_inv * (v_g - tcurr);
+        if (v.z <= 0)
+          return;
+
+        int2 coo;           //project to current cam
+        coo.x = __float2int_rn (v.x * intr.fx / v.z + intr.cx);
+        coo.y = __float2int_rn (v.y * intr.fy / v.z + intr.cy);
+
+        if (coo.x < 0 || coo.y < 0 || coo.x >= depth_raw.cols || coo.y >= depth_raw.rows)
+          return;
+
+        int Dp = depth_raw.ptr (coo.y)[coo.x];
+        if (Dp == 0)
+          return;
+
+        float xl = (coo.x - intr.cx) / intr.fx;
+        float yl = (coo.y - intr.cy) / intr.fy;
+        float Dp_scaled = Dp * sqrtf (xl * xl + yl * yl + 1) * 0.001f; //meters
+
+        float sdf = Dp_scaled - norm (v_g - tcurr);
+        if (sdf < -tranc_dist)
+          return;
+
+        float tsdf = fmin (1.f, sdf / tranc_dist);
+
+        short2& pos = volume.voxels.data[blockIdx.x * HASH_BLOCK_VOXELS + threadIdx.x];
+
+        //read and unpack
+        float tsdf_prev;
+        int weight_prev;
+        unpack_tsdf (pos, tsdf_prev, weight_prev);
+
+        const int Wrk = 1;
+
+        float tsdf_new = (tsdf_prev * weight_prev + Wrk * tsdf) / (weight_prev + Wrk);
+        int weight_new = min (weight_prev + Wrk, MAX_WEIGHT);
+
+        pack_tsdf (tsdf_new, weight_new, pos);
+      }
+    };
+
+    __global__ void
+    integrateHashedKernel (const HashedTsdf tsdf) {
+      tsdf ();
+    }
+
+    struct HashedRayCaster
+    {
+      enum { CTA_SIZE_X = 32, CTA_SIZE_Y = 8 };
+
+      HashedVolume volume;
+
+      Mat33 Rcurr;
+      float3 tcurr;
+
+      float time_step;
+      float max_distance;
+
+      int cols, rows;
+
+      Intr intr;
+
+      mutable PtrStep<float> nmap;
+      mutable PtrStep<float> vmap;
+
+      __device__ __forceinline__ int3
+      getVoxel (float3 point) const
+      {
+        int vx = __float2int_rd (point.x / volume.voxel_size);        // round to negative infinity
+        int vy = __float2int_rd (point.y / volume.voxel_size);
+        int vz = __float2int_rd (point.z / volume.voxel_size);
+
+        return make_int3 (vx, vy, vz);
+      }
+
+      /** \brief Returns the tsdf value of a voxel, nan if its block is not allocated */
+      __device__ __forceinline__ float
+      readTsdf (int x, int y, int z) const
+      {
+        const short2* pos = findHashedVoxel (volume, x, y, z);
+        return (pos ? unpack_tsdf (*pos) : std::numeric_limits<float>::quiet_NaN ());
+      }
+
+      __device__ __forceinline__ float
+      interpolateTrilineary (const float3& point) const
+      {
+        int3 g = getVoxel (point);
+
+        float vx = (g.x + 0.5f) * volume.voxel_size;
+        float vy = (g.y + 0.5f) * volume.voxel_size;
+        float vz = (g.z + 0.5f) * volume.voxel_size;
+
+        g.x = (point.x < vx) ? (g.x - 1) : g.x;
+        g.y = (point.y < vy) ? (g.y - 1) : g.y;
+        g.z = (point.z < vz) ? (g.z - 1) : g.z;
+
+        float a = (point.x - (g.x + 0.5f) * volume.voxel_size) / volume.voxel_size;
+        float b = (point.y - (g.y + 0.5f) * volume.voxel_size) / volume.voxel_size;
+        float c = (point.z - (g.z + 0.5f) * volume.voxel_size) / volume.voxel_size;
+
+        float res = readTsdf (g.x + 0, g.y + 0, g.z + 0) * (1 - a) * (1 - b) * (1 - c) +
+                    readTsdf (g.x + 0, g.y + 0, g.z + 1) * (1 - a) * (1 - b) * c +
+                    readTsdf (g.x + 0, g.y + 1, g.z + 0) * (1 - a) * b * (1 - c) +
+                    readTsdf (g.x + 0, g.y + 1, g.z + 1) * (1 - a) * b * c +
+                    readTsdf (g.x + 1, g.y + 0, g.z + 0) * a * (1 - b) * (1 - c) +
+                    readTsdf (g.x + 1, g.y + 0, g.z + 1) * a * (1 - b) * c +
+                    readTsdf (g.x + 1, g.y + 1, g.z + 0) * a * b * (1 - c) +
+                    readTsdf (g.x + 1, g.y + 1, g.z + 1) * a * b * c;
+        return res;
+      }
+
+      __device__ __forceinline__ void
+      operator () () const
+      {
+        int x = threadIdx.x + blockIdx.x * CTA_SIZE_X;
+        int y = threadIdx.y + blockIdx.y * CTA_SIZE_Y;
+
+        if (x >= cols || y >= rows)
+          return;
+
+        vmap.ptr (y)[x] = std::numeric_limits<float>::quiet_NaN ();
+        nmap.ptr (y)[x] = std::numeric_limits<float>::quiet_NaN ();
+
+        float3 ray_start = tcurr;
+        float3 ray_dir = normalized (Rcurr * make_float3 ((x - intr.cx) / intr.fx, (y - intr.cy) / intr.fy, 1.f));
+
+        // unallocated space reads as nan, which never forms a zero crossing
+        float tsdf = std::numeric_limits<float>::quiet_NaN ();
+
+        for (float time_curr = time_step; time_curr < max_distance; time_curr += time_step)
+        {
+          float tsdf_prev = tsdf;
+
+          int3 g = getVoxel (ray_start + ray_dir * time_curr);
+          tsdf = readTsdf (g.x, g.y, g.z);
+
+          if (tsdf_prev < 0.f && tsdf > 0.f)
+            break;
+
+          if (tsdf_prev > 0.f && tsdf < 0.f)           //zero crossing
+          {
+            float Ftdt = interpolateTrilineary (ray_start + ray_dir * time_curr);
+            if (isnan (Ftdt))
+              break;
+
+            float Ft = interpolateTrilineary (ray_start + ray_dir * (time_curr - time_step));
+            if (isnan (Ft))
+              break;
+
+            float Ts = time_curr - time_step - time_step * Ft / (Ftdt - Ft);
+
+            float3 vetex_found = ray_start + ray_dir * Ts;
+
+            vmap.ptr (y       )[x] = vetex_found.x;
+            vmap.ptr (y + rows)[x] = vetex_found.y;
+            vmap.ptr (y + 2 * rows)[x] = vetex_found.z;
+
+            float3 t;
+            float3 n;
+
+            t = vetex_found;
+            t.x += volume.voxel_size;
+            float Fx1 = interpolateTrilineary (t);
+
+            t = vetex_found;
+            t.x -= volume.voxel_size;
+            float Fx2 = interpolateTrilineary (t);
+
+            n.x = (Fx1 - Fx2);
+
+            t = vetex_found;
+            t.y += volume.voxel_size;
+            float Fy1 = interpolateTrilineary (t);
+
+            t = vetex_found;
+            t.y -= volume.voxel_size;
+            float Fy2 = interpolateTrilineary (t);
+
+            n.y = (Fy1 - Fy2);
+
+            t = vetex_found;
+            t.z += volume.voxel_size;
+            float Fz1 = interpolateTrilineary (t);
+
+            t = vetex_found;
+            t.z -= volume.voxel_size;
+            float Fz2 = interpolateTrilineary (t);
+
+            n.z = (Fz1 - Fz2);
+
+            // no normal at the border of the allocated blocks
+            if (!isnan (n.x) && !isnan (n.y) && !isnan (n.z))
+            {
+              n = normalized (n);
+
+              nmap.ptr (y       )[x] = n.x;
+              nmap.ptr (y + rows)[x] = n.y;
+              nmap.ptr (y + 2 * rows)[x] = n.z;
+            }
+            break;
+          }
+        }          /* for(;;)  */
+      }
+    };
+
+    __global__ void
+    rayCastHashedKernel (const HashedRayCaster rc) {
+      rc ();
+    }
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+void
+pcl::device::resetHashedVolume (HashedVolume& volume)
+{
+  cudaSafeCall (cudaMemset (volume.keys.data, 0xFF, volume.keys.size * sizeof (unsigned long long)));
+  cudaSafeCall (cudaMemset (volume.blocks.data, 0xFF, volume.blocks.size * sizeof (int)));
+  // zero bytes are a tsdf of 0 with weight 0, see pack_tsdf
+  cudaSafeCall (cudaMemset (volume.voxels.data, 0, volume.voxels.size * sizeof (short2)));
+  cudaSafeCall (cudaMemset (volume.block_count, 0, sizeof (int)));
+  cudaSafeCall (cudaDeviceSynchronize ());
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+int
+pcl::device::allocateHashedBlocks (const PtrStepSz<ushort>& depth_raw, const Intr& intr, const Mat33& Rcurr, const float3& tcurr,
+                                   float tranc_dist, HashedVolume& volume)
+{
+  HashedBlockAllocator ha;
+
+  ha.volume = volume;
+  ha.intr = intr;
+  ha.Rcurr = Rcurr;
+  ha.tcurr = tcurr;
+  ha.depth_raw = depth_raw;
+  ha.tranc_dist = tranc_dist;
+
+  dim3 block (HashedBlockAllocator::CTA_SIZE_X, HashedBlockAllocator::CTA_SIZE_Y);
+  dim3 grid (divUp (depth_raw.cols, block.x), divUp (depth_raw.rows, block.y));
+
+  allocateHashedBlocksKernel<<<grid, block>>>(ha);
+  cudaSafeCall (cudaGetLastError ());
+  cudaSafeCall (cudaDeviceSynchronize ());
+
+  int blocks_num;
+  cudaSafeCall (cudaMemcpy (&blocks_num, volume.block_count, sizeof (int), cudaMemcpyDeviceToHost));
+  return blocks_num;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+void
+pcl::device::integrateHashedVolume (const PtrStepSz<ushort>& depth_raw, const Intr& intr, const Mat33& Rcurr_inv, const float3& tcurr,
+                                    float tranc_dist, int blocks_num, HashedVolume& volume)
+{
+  if (blocks_num <= 0)
+    return;
+
+  HashedTsdf tsdf;
+
+  tsdf.volume = volume;
+  tsdf.intr = intr;
+  tsdf.Rcurr_inv = Rcurr_inv;
+  tsdf.tcurr = tcurr;
+  tsdf.depth_raw = depth_raw;
+  tsdf.tranc_dist = tranc_dist;
+
+  integrateHashedKernel<<<blocks_num, HashedTsdf::CTA_SIZE>>>(tsdf);
+  cudaSafeCall (cudaGetLastError ());
+  cudaSafeCall (cudaDeviceSynchronize ());
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+void
+pcl::device::raycast (const Intr& intr, const Mat33& Rcurr, const float3& tcurr, float tranc_dist, float max_distance,
+                      const HashedVolume& volume, MapArr& vmap, MapArr& nmap)
+{
+  HashedRayCaster rc;
+
+  rc.volume = volume;
+
+  rc.Rcurr = Rcurr;
+  rc.tcurr = tcurr;
+
+  rc.time_step = tranc_dist * 0.8f;
+  rc.max_distance = max_distance;
+
+  rc.cols = vmap.cols ();
+  rc.rows = vmap.rows () / 3;
+
+  rc.intr = intr;
+
+  rc.vmap = vmap;
+  rc.nmap = nmap;
+
+  dim3 block (HashedRayCaster::CTA_SIZE_X, HashedRayCaster::CTA_SIZE_Y);
+  dim3 grid (divUp (rc.cols, block.x), divUp (rc.rows, block.y));
+
+  rayCastHashedKernel<<<grid, block>>>(rc);
+  cudaSafeCall (cudaGetLastError ());
+}
@@ -77,30 +77,76 @@ namespace pcl
     __device__ int output_count;
     __device__ unsigned int blocks_done = 0;
 
-    struct CubeIndexEstimator
+    /** \brief Access to the voxels of the dense volume, voxel ids are linear indices into the volume */
+    struct DenseVolumeReader
     {
       PtrStep<short2> volume;
 
-	  static __device__ __forceinline__ float isoValue() { return 0.f; }
-
       __device__ __forceinline__ void
       readTsdf (int x, int y, int z, float& tsdf, int& weight) const
       {
         unpack_tsdf (volume.ptr (VOLUME_Y * z + y)[x], tsdf, weight);
       }
 
+      __device__ __forceinline__ int3
+      getVoxelCoords (int voxel) const
+      {
+        int z = voxel / (VOLUME_X * VOLUME_Y);
+        int y = (voxel - z * VOLUME_X * VOLUME_Y) / VOLUME_X;
+        int x = (voxel - z * VOLUME_X * VOLUME_Y) - y * VOLUME_X;
+        return make_int3 (x, y, z);
+      }
+    };
+
+    /** \brief Access to the voxels of a hashed volume, voxel ids are block * HASH_BLOCK_VOXELS + voxel in block */
+    struct HashedVolumeReader
+    {
+      HashedVolume volume;
+
+      __device__ __forceinline__ void
+      readTsdf (int x, int y, int z, float& tsdf, int& weight) const
+      {
+        const short2* pos = findHashedVoxel (volume, x, y, z);
+        if (pos)
+          unpack_tsdf (*pos, tsdf, weight);
+        else
+        {
+          tsdf = 0.f;
+          weight = 0;
+        }
+      }
+
+      __device__ __forceinline__ int3
+      getVoxelCoords (int voxel) const
+      {
+        const int4 block = volume.coords.data[voxel / HASH_BLOCK_VOXELS];
+        const int local = voxel % HASH_BLOCK_VOXELS;
+        const int mask = HASH_BLOCK_SIZE - 1;
+
+        int x = (block.x << HASH_BLOCK_SHIFT) + (local & mask);
+        int y = (block.y << HASH_BLOCK_SHIFT) + ((local >> HASH_BLOCK_SHIFT) & mask);
+        int z = (block.z << HASH_BLOCK_SHIFT) + (local >> (2 * HASH_BLOCK_SHIFT));
+        return make_int3 (x, y, z);
+      }
+    };
+
+    template<typename VolumeReader>
+    struct CubeIndexEstimator : public VolumeReader
+    {
+	  static __device__ __forceinline__ float isoValue() { return 0.f; }
+
       __device__ __forceinline__ int
       computeCubeIndex (int x, int y, int z, float f[8]) const
       {
         int weight;
-        readTsdf (x,     y,     z,     f[0], weight); if (weight == 0) return 0;
-        readTsdf (x + 1, y,     z,     f[1], weight); if (weight == 0) return 0;
-        readTsdf (x + 1, y + 1, z,     f[2], weight); if (weight == 0) return 0;
-        readTsdf (x,     y + 1, z,     f[3], weight); if (weight == 0) return 0;
-        readTsdf (x,     y,     z + 1, f[4], weight); if (weight == 0) return 0;
-        readTsdf (x + 1, y,     z + 1, f[5], weight); if (weight == 0) return 0;
-        readTsdf (x + 1, y + 1, z + 1, f[6], weight); if (weight == 0) return 0;
-        readTsdf (x,     y + 1, z + 1, f[7], weight); if (weight == 0) return 0;
+        this->readTsdf (x,     y,     z,     f[0], weight); if (weight == 0) return 0;
+        this->readTsdf (x + 1, y,     z,     f[1], weight); if (weight == 0) return 0;
+        this->readTsdf (x + 1, y + 1, z,     f[2], weight); if (weight == 0) return 0;
+        this->readTsdf (x,     y + 1, z,     f[3], weight); if (weight == 0) return 0;
+        this->readTsdf (x,     y,     z + 1, f[4], weight); if (weight == 0) return 0;
+        this->readTsdf (x + 1, y,     z + 1, f[5], weight); if (weight == 0) return 0;
+        this->readTsdf (x + 1, y + 1, z + 1, f[6], weight); if (weight == 0) return 0;
+        this->readTsdf (x,     y + 1, z + 1, f[7], weight); if (weight == 0) return 0;
 
         // calculate flag indicating if each vertex is inside or outside isosurface
         int cubeindex;
@@ -117,7 +163,7 @@ namespace pcl
       }
     };
 
-    struct OccupiedVoxels : public CubeIndexEstimator
+    struct OccupiedVoxels : public CubeIndexEstimator<DenseVolumeReader>
     {
       enum
       {        
@@ -245,6 +291,70 @@ pcl::device::getOccupiedVoxels (const PtrStep<short2>& volume, DeviceArray2D<int
   return size;
 }
 
+namespace pcl
+{
+  namespace device
+  {
+    __device__ int hashed_voxels_count = 0;
+
+    struct HashedOccupiedVoxels : public CubeIndexEstimator<HashedVolumeReader>
+    {
+      enum { CTA_SIZE = HASH_BLOCK_VOXELS };
+
+      mutable int* voxels_indeces;
+      mutable int* vetexes_number;
+      int max_size;
+
+      __device__ __forceinline__ void
+      operator () () const
+      {
+        // one cuda block per voxel block, one thread per voxel
+        const int voxel = blockIdx.x * HASH_BLOCK_VOXELS + threadIdx.x;
+        const int3 g = getVoxelCoords (voxel);
+
+        float field[8];
+        int cubeindex = computeCubeIndex (g.x, g.y, g.z, field);
+
+        int numVerts = (cubeindex == 0 || cubeindex == 255) ? 0 : tex1Dfetch (numVertsTex, cubeindex);
+        if (numVerts == 0)
+          return;
+
+        int idx = atomicAdd (&hashed_voxels_count, 1);
+        if (idx < max_size)
+        {
+          voxels_indeces[idx] = voxel;
+          vetexes_number[idx] = numVerts;
+        }
+      }
+    };
+    __global__ void getHashedOccupiedVoxelsKernel (const HashedOccupiedVoxels ov) { ov (); }
+  }
+}
+
+int
+pcl::device::getOccupiedVoxels (const HashedVolume& volume, int blocks_num, DeviceArray2D<int>& occupied_voxels)
+{
+  if (blocks_num <= 0)
+    return 0;
+
+  HashedOccupiedVoxels ov;
+  ov.volume = volume;
+
+  ov.voxels_indeces = occupied_voxels.ptr (0);
+  ov.vetexes_number = occupied_voxels.ptr (1);
+  ov.max_size = occupied_voxels.cols ();
+
+  int size = 0;
+  cudaSafeCall ( cudaMemcpyToSymbol (hashed_voxels_count, &size, sizeof(size)) );
+
+  getHashedOccupiedVoxelsKernel<<<blocks_num, HashedOccupiedVoxels::CTA_SIZE>>>(ov);
+  cudaSafeCall ( cudaGetLastError () );
+  cudaSafeCall (cudaDeviceSynchronize ());
+
+  cudaSafeCall ( cudaMemcpyFromSymbol (&size, hashed_voxels_count, sizeof(size)) );
+  return min (size, ov.max_size);
+}
+
 int
 pcl::device::computeOffsetsAndTotalVertexes (DeviceArray2D<int>& occupied_voxels)
 {
@@ -270,7 +380,8 @@ namespace pcl
 {
   namespace device
   {
-    struct TrianglesGenerator : public CubeIndexEstimator
+    template<typename VolumeReader>
+    struct TrianglesGenerator : public CubeIndexEstimator<VolumeReader>
     {
       enum { CTA_SIZE = 256, MAX_GRID_SIZE_X = 65536 };
 
@@ -297,7 +408,7 @@ namespace pcl
       __device__ __forceinline__ float3
       vertex_interp (float3 p0, float3 p1, float f0, float f1) const
       {        
-        float t = (isoValue() - f0) / (f1 - f0 + 1e-15f);
+        float t = (this->isoValue() - f0) / (f1 - f0 + 1e-15f);
         float x = p0.x + t * (p1.x - p0.x);
         float y = p0.y + t * (p1.y - p0.y);
         float z = p0.z + t * (p1.z - p0.z);
@@ -316,12 +427,11 @@ namespace pcl
 
         int voxel = occupied_voxels[idx];
 
-        int z = voxel / (VOLUME_X * VOLUME_Y);
-        int y = (voxel - z * VOLUME_X * VOLUME_Y) / VOLUME_X;
-        int x = (voxel - z * VOLUME_X * VOLUME_Y) - y * VOLUME_X;
+        const int3 g = this->getVoxelCoords (voxel);
+        const int x = g.x, y = g.y, z = g.z;
 
         float f[8];
-        int cubeindex = computeCubeIndex (x, y, z, f);
+        int cubeindex = this->computeCubeIndex (x, y, z, f);
 
         // calculate cell vertex positions
         float3 v[8];
@@ -374,25 +484,41 @@ namespace pcl
         ptr[index] = make_float4 (point.x, point.y, point.z, 1.0f);
       }
     };
+    template<typename VolumeReader>
     __global__ void
-    trianglesGeneratorKernel (const TrianglesGenerator tg) {tg (); }
+    trianglesGeneratorKernel (const TrianglesGenerator<VolumeReader> tg) {tg (); }
+
+    template<typename VolumeReader>
+    void
+    launchTrianglesGenerator (const TrianglesGenerator<VolumeReader>& tg)
+    {
+      using Tg = TrianglesGenerator<VolumeReader>;
+
+      int device;
+      cudaSafeCall( cudaGetDevice(&device) );
+
+      cudaDeviceProp prop;
+      cudaSafeCall( cudaGetDeviceProperties(&prop, device) );
+
+      int block_size = prop.major < 2 ? 96 : 256; // please see TrianglesGenerator::CTA_SIZE
+
+      int blocks_num = divUp (tg.voxels_count, block_size);
+
+      dim3 block (block_size);
+      dim3 grid(min(blocks_num, (int)Tg::MAX_GRID_SIZE_X), divUp(blocks_num, (int)Tg::MAX_GRID_SIZE_X));
+
+      trianglesGeneratorKernel<<<grid, block>>>(tg);
+      cudaSafeCall ( cudaGetLastError () );
+      cudaSafeCall (cudaDeviceSynchronize ());
+    }
   }
 }
 
 
 void
 pcl::device::generateTriangles (const PtrStep<short2>& volume, const DeviceArray2D<int>& occupied_voxels, const float3& volume_size, DeviceArray<PointType>& output)
-{   
-  int device;
-  cudaSafeCall( cudaGetDevice(&device) );
-
-  cudaDeviceProp prop;
-  cudaSafeCall( cudaGetDeviceProperties(&prop, device) );
-  
-  int block_size = prop.major < 2 ? 96 : 256; // please see TrianglesGenerator::CTA_SIZE
-
-  using Tg = TrianglesGenerator;
-  Tg tg;
+{
+  TrianglesGenerator<DenseVolumeReader> tg;
 
   tg.volume = volume;
   tg.occupied_voxels = occupied_voxels.ptr (0);
@@ -403,12 +529,20 @@ pcl::device::generateTriangles (const PtrStep<short2>& volume, const DeviceArray
   tg.cell_size.z = volume_size.z / VOLUME_Z;
   tg.output = output;
 
-  int blocks_num = divUp (tg.voxels_count, block_size);
+  launchTrianglesGenerator (tg);
+}
+
+void
+pcl::device::generateTriangles (const HashedVolume& volume, const DeviceArray2D<int>& occupied_voxels, DeviceArray<PointType>& output)
+{
+  TrianglesGenerator<HashedVolumeReader> tg;
 
-  dim3 block (block_size);
-  dim3 grid(min(blocks_num, Tg::MAX_GRID_SIZE_X), divUp(blocks_num, Tg::MAX_GRID_SIZE_X));
+  tg.volume = volume;
+  tg.occupied_voxels = occupied_voxels.ptr (0);
+  tg.vertex_ofssets = occupied_voxels.ptr (2);
+  tg.voxels_count = occupied_voxels.cols ();
+  tg.cell_size = make_float3 (volume.voxel_size, volume.voxel_size, volume.voxel_size);
+  tg.output = output;
 
-  trianglesGeneratorKernel<<<grid, block>>>(tg);
-  cudaSafeCall ( cudaGetLastError () );
-  cudaSafeCall (cudaDeviceSynchronize ());
-}
\ No newline at end of file
+  launchTrianglesGenerator (tg);
+}
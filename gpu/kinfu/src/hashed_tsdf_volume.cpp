@@ -0,0 +1,138 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2019-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <pcl/gpu/kinfu/hashed_tsdf_volume.h>
+#include <pcl/console/print.h>
+#include "internal.h"
+#include <algorithm>
+
+using namespace pcl;
+using namespace pcl::gpu;
+using namespace Eigen;
+using pcl::device::device_cast;
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+pcl::gpu::HashedTsdfVolume::HashedTsdfVolume (float voxel_size, int max_blocks, int hash_buckets)
+  : voxel_size_ (voxel_size), tranc_dist_ (0.f), max_raycast_distance_ (4.f), max_blocks_ (max_blocks), blocks_num_ (0)
+{
+  // the hash function masks with buckets - 1
+  int buckets = 1;
+  while (buckets < hash_buckets)
+    buckets <<= 1;
+
+  keys_.create (buckets);
+  blocks_.create (buckets);
+  coords_.create (max_blocks_ * 4);
+  voxels_.create (max_blocks_ * device::HASH_BLOCK_VOXELS);
+  block_count_.create (1);
+
+  const float default_tranc_dist = 0.03f; //meters
+  setTsdfTruncDist (default_tranc_dist);
+
+  reset ();
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void
+pcl::gpu::HashedTsdfVolume::setTsdfTruncDist (float distance)
+{
+  tranc_dist_ = std::max (distance, 2.1f * voxel_size_);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void
+pcl::gpu::HashedTsdfVolume::reset ()
+{
+  device::HashedVolume volume = device::getHashedVolume (*this);
+  device::resetHashedVolume (volume);
+  blocks_num_ = 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void
+pcl::gpu::HashedTsdfVolume::integrate (const DeviceArray2D<unsigned short>& depth, float fx, float fy, float cx, float cy,
+                                       const Affine3f& camera_pose)
+{
+  device::Intr intr (fx, fy, cx, cy);
+
+  Matrix<float, 3, 3, RowMajor> R = camera_pose.linear ();
+  Matrix<float, 3, 3, RowMajor> R_inv = camera_pose.linear ().inverse ();
+  Vector3f t = camera_pose.translation ();
+
+  device::HashedVolume volume = device::getHashedVolume (*this);
+
+  int requested = device::allocateHashedBlocks (depth, intr, device_cast<device::Mat33> (R), device_cast<float3> (t), tranc_dist_, volume);
+  if (requested > max_blocks_ && blocks_num_ < max_blocks_)
+    PCL_WARN ("[pcl::gpu::HashedTsdfVolume::integrate] The volume is full, %d of %d blocks could not be allocated.\n",
+              requested - max_blocks_, requested);
+
+  blocks_num_ = std::min (requested, max_blocks_);
+  device::integrateHashedVolume (depth, intr, device_cast<device::Mat33> (R_inv), device_cast<float3> (t), tranc_dist_, blocks_num_, volume);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void
+pcl::gpu::HashedTsdfVolume::raycast (float fx, float fy, float cx, float cy, const Affine3f& camera_pose,
+                                     DeviceArray2D<float>& vmap, DeviceArray2D<float>& nmap) const
+{
+  device::Intr intr (fx, fy, cx, cy);
+
+  Matrix<float, 3, 3, RowMajor> R = camera_pose.linear ();
+  Vector3f t = camera_pose.translation ();
+
+  device::raycast (intr, device_cast<device::Mat33> (R), device_cast<float3> (t), tranc_dist_, max_raycast_distance_,
+                   device::getHashedVolume (*this), vmap, nmap);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+pcl::device::HashedVolume
+pcl::device::getHashedVolume (const pcl::gpu::HashedTsdfVolume& volume)
+{
+  HashedVolume result;
+  result.keys = volume.hashKeys ();
+  result.blocks = volume.hashBlocks ();
+  result.coords = volume.blockCoordinates ();
+  result.voxels = volume.data ();
+  result.block_count = const_cast<int*> (volume.blockCounter ().ptr ());
+  result.voxel_size = volume.getVoxelSize ();
+  return result;
+}
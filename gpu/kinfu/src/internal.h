@@ -41,6 +41,14 @@
 //#include <pcl/gpu/utils/safe_call.hpp>
 #include "safe_call.hpp"
 
+namespace pcl
+{
+  namespace gpu
+  {
+    class HashedTsdfVolume;
+  }
+}
+
 namespace pcl
 {
   namespace device
@@ -437,5 +445,111 @@ namespace pcl
       */
     void
     generateTriangles(const PtrStep<short2>& volume, const DeviceArray2D<int>& occupied_voxels, const float3& volume_size, DeviceArray<PointType>& output);
+
+    ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    // Voxel block hashing
+
+    /** \brief log2 of the edge length of a voxel block */
+    constexpr int HASH_BLOCK_SHIFT = 3;
+
+    /** \brief Edge length of a voxel block */
+    constexpr int HASH_BLOCK_SIZE = 1 << HASH_BLOCK_SHIFT;
+
+    /** \brief Number of voxels in a voxel block */
+    constexpr int HASH_BLOCK_VOXELS = HASH_BLOCK_SIZE * HASH_BLOCK_SIZE * HASH_BLOCK_SIZE;
+
+    /** \brief Key of a free hash bucket */
+    constexpr unsigned long long HASH_EMPTY_KEY = ~0ull;
+
+    /** \brief Maximum number of buckets probed for a key */
+    constexpr int HASH_MAX_PROBES = 64;
+
+    /** \brief Sparse tsdf volume: voxel blocks allocated around the observed surface, found through a hash table
+      * with linear probing. Voxels are stored like in the dense volume, block after block.
+      */
+    struct HashedVolume
+    {
+      /** \brief packed block coordinates per bucket, HASH_EMPTY_KEY if free. The size is a power of two. */
+      PtrSz<unsigned long long> keys;
+      /** \brief block index per bucket, -1 if none */
+      PtrSz<int> blocks;
+      /** \brief block coordinates per block, in units of blocks */
+      PtrSz<int4> coords;
+      /** \brief HASH_BLOCK_VOXELS voxels per block, x fastest */
+      PtrSz<short2> voxels;
+      /** \brief number of blocks requested so far, may exceed coords.size */
+      int* block_count;
+      /** \brief voxel size in meters */
+      float voxel_size;
+    };
+
+    /** \brief Returns the device view of the storage of a pcl::gpu::HashedTsdfVolume
+      * \param[in] volume hashed volume
+      */
+    HashedVolume
+    getHashedVolume (const pcl::gpu::HashedTsdfVolume& volume);
+
+    /** \brief Frees all blocks of a hashed volume
+      * \param[out] volume volume to be reset
+      */
+    void
+    resetHashedVolume (HashedVolume& volume);
+
+    /** \brief Allocates the blocks within the truncation distance of the surface seen in a depth image
+      * \param[in] depth_raw Kinect depth image
+      * \param[in] intr camera intrinsics
+      * \param[in] Rcurr rotation for current camera pose
+      * \param[in] tcurr translation for current camera pose
+      * \param[in] tranc_dist tsdf truncation distance
+      * \param[in] volume hashed volume to be updated
+      * \return number of allocated blocks, may exceed the capacity of the volume
+      */
+    int
+    allocateHashedBlocks (const PtrStepSz<ushort>& depth_raw, const Intr& intr, const Mat33& Rcurr, const float3& tcurr,
+                          float tranc_dist, HashedVolume& volume);
+
+    /** \brief Integrates a depth image into the allocated blocks of a hashed volume
+      * \param[in] depth_raw Kinect depth image
+      * \param[in] intr camera intrinsics
+      * \param[in] Rcurr_inv inverse rotation for current camera pose
+      * \param[in] tcurr translation for current camera pose
+      * \param[in] tranc_dist tsdf truncation distance
+      * \param[in] blocks_num number of allocated blocks
+      * \param[in] volume hashed volume to be updated
+      */
+    void
+    integrateHashedVolume (const PtrStepSz<ushort>& depth_raw, const Intr& intr, const Mat33& Rcurr_inv, const float3& tcurr,
+                           float tranc_dist, int blocks_num, HashedVolume& volume);
+
+    /** \brief Generation vertex and normal maps from a hashed volume for current camera pose
+      * \param[in] intr camera intrinsices
+      * \param[in] Rcurr current rotation
+      * \param[in] tcurr current translation
+      * \param[in] tranc_dist volume truncation distance
+      * \param[in] max_distance rays are traced up to this distance from the camera
+      * \param[in] volume hashed volume
+      * \param[out] vmap output vertex map
+      * \param[out] nmap output normals map
+      */
+    void
+    raycast (const Intr& intr, const Mat33& Rcurr, const float3& tcurr, float tranc_dist, float max_distance,
+             const HashedVolume& volume, MapArr& vmap, MapArr& nmap);
+
+    /** \brief Scans the allocated blocks of a hashed volume and retrieves occupied voxels
+      * \param[in] volume hashed volume
+      * \param[in] blocks_num number of allocated blocks
+      * \param[out] occupied_voxels buffer for occupied voxels. The function fulfills first row with voxel ids and second row with number of vertices.
+      * \return number of voxels in the buffer
+      */
+    int
+    getOccupiedVoxels (const HashedVolume& volume, int blocks_num, DeviceArray2D<int>& occupied_voxels);
+
+    /** \brief Generates final triangle array for a hashed volume
+      * \param[in] volume hashed volume
+      * \param[in] occupied_voxels occupied voxel ids (first row), number of vertexes(second row), offsets(third row).
+      * \param[out] output triangle array
+      */
+    void
+    generateTriangles (const HashedVolume& volume, const DeviceArray2D<int>& occupied_voxels, DeviceArray<PointType>& output);
   }
 }
@@ -181,6 +181,9 @@ pcl::gpu::KinfuTracker::reset()
   tvecs_.push_back (init_tcam_);
 
   tsdf_volume_->reset();
+
+  if (hashed_volume_)
+    hashed_volume_->reset();
     
   if (color_volume_) // color integration mode is enabled
     color_volume_->reset();    
@@ -269,7 +272,10 @@ pcl::gpu::KinfuTracker::operator() (const DepthMap& depth_raw,
         float3 device_volume_size = device_cast<const float3>(tsdf_volume_->getSize());
 
         //integrateTsdfVolume(depth_raw, intr, device_volume_size, device_Rcam_inv, device_tcam, tranc_dist, volume_);    
-        device::integrateTsdfVolume(depth_raw, intr, device_volume_size, device_Rcam_inv, device_tcam, tsdf_volume_->getTsdfTruncDist(), tsdf_volume_->data(), depthRawScaled_);
+        if (hashed_volume_)
+          hashed_volume_->integrate (depth_raw, fx_, fy_, cx_, cy_, getCameraPose (0));
+        else
+          device::integrateTsdfVolume(depth_raw, intr, device_volume_size, device_Rcam_inv, device_tcam, tsdf_volume_->getTsdfTruncDist(), tsdf_volume_->data(), depthRawScaled_);
 
         for (int i = 0; i < LEVELS; ++i)
           device::tranformMaps (vmaps_curr_[i], nmaps_curr_[i], device_Rcam, device_tcam, vmaps_g_prev_[i], nmaps_g_prev_[i]);
@@ -404,11 +410,18 @@ pcl::gpu::KinfuTracker::operator() (const DepthMap& depth_raw,
   Matrix3frm Rcurr_inv = Rcurr.inverse ();
   Mat33&  device_Rcurr_inv = device_cast<Mat33> (Rcurr_inv);
   float3& device_tcurr = device_cast<float3> (tcurr);
+
+  Eigen::Affine3f pose_curr;
+  pose_curr.linear () = Rcurr;
+  pose_curr.translation () = tcurr;
   if (integrate)
   {
     //ScopeTime time("tsdf");
     //integrateTsdfVolume(depth_raw, intr, device_volume_size, device_Rcurr_inv, device_tcurr, tranc_dist, volume_);
-    integrateTsdfVolume (depth_raw, intr, device_volume_size, device_Rcurr_inv, device_tcurr, tsdf_volume_->getTsdfTruncDist(), tsdf_volume_->data(), depthRawScaled_);
+    if (hashed_volume_)
+      hashed_volume_->integrate (depth_raw, fx_, fy_, cx_, cy_, pose_curr);
+    else
+      integrateTsdfVolume (depth_raw, intr, device_volume_size, device_Rcurr_inv, device_tcurr, tsdf_volume_->getTsdfTruncDist(), tsdf_volume_->data(), depthRawScaled_);
   }
 
   ///////////////////////////////////////////////////////////////////////////////////////////
@@ -416,7 +429,10 @@ pcl::gpu::KinfuTracker::operator() (const DepthMap& depth_raw,
   Mat33& device_Rcurr = device_cast<Mat33> (Rcurr);
   {
     //ScopeTime time("ray-cast-all");
-    raycast (intr, device_Rcurr, device_tcurr, tsdf_volume_->getTsdfTruncDist(), device_volume_size, tsdf_volume_->data(), vmaps_g_prev_[0], nmaps_g_prev_[0]);
+    if (hashed_volume_)
+      hashed_volume_->raycast (fx_, fy_, cx_, cy_, pose_curr, vmaps_g_prev_[0], nmaps_g_prev_[0]);
+    else
+      raycast (intr, device_Rcurr, device_tcurr, tsdf_volume_->getTsdfTruncDist(), device_volume_size, tsdf_volume_->data(), vmaps_g_prev_[0], nmaps_g_prev_[0]);
     for (int i = 1; i < LEVELS; ++i)
     {
       resizeVMap (vmaps_g_prev_[i-1], vmaps_g_prev_[i]);
@@ -467,6 +483,23 @@ pcl::gpu::KinfuTracker::volume()
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
+void
+pcl::gpu::KinfuTracker::setHashedVolume (const HashedTsdfVolume::Ptr& volume)
+{
+  hashed_volume_ = volume;
+  reset ();
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+HashedTsdfVolume::Ptr
+pcl::gpu::KinfuTracker::getHashedVolume () const
+{
+  return hashed_volume_;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
 const ColorVolume& 
 pcl::gpu::KinfuTracker::colorVolume() const
 {
@@ -37,6 +37,7 @@
 
 #include <pcl/gpu/kinfu/kinfu.h>
 #include <pcl/gpu/kinfu/marching_cubes.h>
+#include <pcl/gpu/kinfu/hashed_tsdf_volume.h>
 #include "internal.h"
 
 using namespace pcl;
@@ -83,6 +84,34 @@ pcl::gpu::MarchingCubes::run(const TsdfVolume& tsdf, DeviceArray<PointType>& tri
   return DeviceArray<PointType>(triangles_buffer.ptr(), total_vertexes);
 }
 
+DeviceArray<pcl::gpu::MarchingCubes::PointType>
+pcl::gpu::MarchingCubes::run(const HashedTsdfVolume& tsdf, DeviceArray<PointType>& triangles_buffer)
+{
+  if (triangles_buffer.empty())
+    triangles_buffer.create(DEFAULT_TRIANGLES_BUFFER_SIZE);
+  occupied_voxels_buffer_.create(3, static_cast<int> (triangles_buffer.size () / 3));
+
+  device::bindTextures(edgeTable_, triTable_, numVertsTable_);
+
+  device::HashedVolume volume = device::getHashedVolume(tsdf);
+
+  int active_voxels = device::getOccupiedVoxels(volume, tsdf.getNumberOfBlocks(), occupied_voxels_buffer_);
+  if(!active_voxels)
+  {
+    device::unbindTextures();
+    return DeviceArray<PointType>();
+  }
+
+  DeviceArray2D<int> occupied_voxels(3, active_voxels, occupied_voxels_buffer_.ptr(), occupied_voxels_buffer_.step());
+
+  int total_vertexes = device::computeOffsetsAndTotalVertexes(occupied_voxels);
+
+  device::generateTriangles(volume, occupied_voxels, (DeviceArray<device::PointType>&)triangles_buffer);
+
+  device::unbindTextures();
+  return DeviceArray<PointType>(triangles_buffer.ptr(), total_vertexes);
+}
+
 
 // edge table maps 8-bit flag representing which cube vertices are inside
 // the isosurface to 12-bit number indicating which edges are intersected
@@ -36,6 +36,7 @@
  */
 
 #include <pcl/gpu/kinfu/raycaster.h>
+#include <pcl/gpu/kinfu/hashed_tsdf_volume.h>
 #include <pcl/gpu/kinfu/tsdf_volume.h>
 #include "internal.h"
 
@@ -94,6 +95,21 @@ pcl::gpu::RayCaster::run(const TsdfVolume& volume, const Affine3f& camera_pose)
   device::raycast (intr, device_R, device_t, tranc_dist, device_cast<const float3>(volume_size_), volume.data(), vertex_map_, normal_map_);  
 }
 
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+void
+pcl::gpu::RayCaster::run(const HashedTsdfVolume& volume, const Affine3f& camera_pose)
+{
+  camera_pose_.linear() = camera_pose.linear();
+  camera_pose_.translation() = camera_pose.translation();
+  // the volume has no extent, the default light position is derived from the raycasting range instead
+  volume_size_ = Vector3f::Constant(volume.getMaxRaycastDistance());
+
+  vertex_map_.create(rows * 3, cols);
+  normal_map_.create(rows * 3, cols);
+
+  volume.raycast(fx_, fy_, cx_, cy_, camera_pose_, vertex_map_, normal_map_);
+}
+
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 void
 pcl::gpu::RayCaster::generateSceneView(View& view) const
@@ -46,7 +46,9 @@
 #include <pcl/gpu/kinfu_large_scale/point_intensity.h>
 
 #include <pcl/gpu/kinfu_large_scale/world_model.h>
+#include <pcl/gpu/containers/stream.h>
 
+#include <future>
 
 #include <pcl/io/pcd_io.h>
 namespace pcl
@@ -58,6 +60,8 @@ namespace pcl
         
       /** \brief CyclicalBuffer implements a cyclical TSDF buffer.
         *  The class offers a simple interface, by handling shifts and maintaining the world autonomously.
+        *  The slice leaving the volume is downloaded on a separate stream and merged into the world model
+        *  by a background task, so tracking resumes as soon as the volume itself is updated.
         * \author Raphael Favier, Francisco Heredia
         */
       class PCL_EXPORTS CyclicalBuffer
@@ -102,6 +106,12 @@ namespace pcl
             buffer_.voxels_size.z = nb_voxels_z; 
           }
 
+          /** \brief Destructor, waits for the pending world model update. */
+          ~CyclicalBuffer ()
+          {
+            finishWorldUpdate ();
+          }
+
           /** \brief Check if shifting needs to be performed, returns true if so.
               Shifting is considered needed if the target point is farther than distance_threshold_.
               The target point is located at distance_camera_point on the local Z axis of the camera.
@@ -199,13 +209,22 @@ namespace pcl
             initBuffer (tsdf_volume);
           }
           
-          /** \brief Return a pointer to the world model
+          /** \brief Return a pointer to the world model, after the pending update of the last shift completed.
             */ 
           pcl::kinfuLS::WorldModel<pcl::PointXYZI>*
           getWorldModel ()
           {
+            finishWorldUpdate ();
             return (&world_model_);
           }
+
+          /** \brief Wait until the slice of the last shift has been merged into the world model.
+            */
+          void finishWorldUpdate ()
+          {
+            if (world_update_.valid ())
+              world_update_.get ();
+          }
                 
           
         private:
@@ -216,6 +235,16 @@ namespace pcl
           /** \brief buffer used to extract Intensity values from GPU */
           DeviceArray<float> cloud_buffer_device_intensities_;
 
+          /** \brief stream on which the slices are downloaded */
+          Stream download_stream_;
+
+          /** \brief page-locked host copies of the last slice, valid until world_update_ completed */
+          PinnedVector<PointXYZ> cloud_buffer_host_xyz_;
+          PinnedVector<float> cloud_buffer_host_intensities_;
+
+          /** \brief background task merging the last slice into the world model */
+          std::future<void> world_update_;
+
           /** \brief distance threshold (cube's center to target point) to trigger shift */
           double distance_threshold_;
           
@@ -40,94 +40,130 @@
 #define PCL_WORLD_MODEL_IMPL_HPP_
 
 #include <pcl/gpu/kinfu_large_scale/world_model.h>
-#include <pcl/common/transforms.h> // for transformPointCloud
+#include <pcl/common/point_tests.h> // for isFinite
+
+#include <algorithm>
+#include <limits>
 
 template <typename PointT>
 void 
 pcl::kinfuLS::WorldModel<PointT>::addSlice ( PointCloudPtr new_cloud)
 {
-  PCL_DEBUG("Adding new cloud. Current world contains %zu points.\n",
-            static_cast<std::size_t>(world_->size()));
+  PCL_DEBUG("Adding new cloud. Current world contains %zu points.\n", world_size_);
 
   PCL_DEBUG("New slice contains %zu points.\n",
             static_cast<std::size_t>(new_cloud->size()));
 
-  *world_ += *new_cloud;
+  for (const auto &point : new_cloud->points)
+  {
+    if (!pcl::isFinite (point))
+      continue;
+    const BlockKey key = {getBlockCoordinate (point.x), getBlockCoordinate (point.y), getBlockCoordinate (point.z)};
+    blocks_[key].push_back (point);
+    ++world_size_;
+  }
+  world_dirty_ = true;
 
-  PCL_DEBUG("World now contains  %zu points.\n",
-            static_cast<std::size_t>(world_->size()));
+  PCL_DEBUG("World now contains  %zu points in %zu blocks.\n", world_size_, blocks_.size ());
 }
 
 template <typename PointT>
 void 
 pcl::kinfuLS::WorldModel<PointT>::getExistingData(const double previous_origin_x, const double previous_origin_y, const double previous_origin_z, const double offset_x, const double offset_y, const double offset_z, const double volume_x, const double volume_y, const double volume_z, pcl::PointCloud<PointT> &existing_slice)
 {
-  double newOriginX = previous_origin_x + offset_x; 
-  double newOriginY = previous_origin_y + offset_y; 
-  double newOriginZ = previous_origin_z + offset_z;
-  double newLimitX = newOriginX + volume_x; 
-  double newLimitY = newOriginY + volume_y; 
-  double newLimitZ = newOriginZ + volume_z;
-	
-  // filter points in the space of the new cube
-  PointCloudPtr newCube (new pcl::PointCloud<PointT>);
-  // condition
-  ConditionAndPtr range_condAND (new pcl::ConditionAnd<PointT> ());
-  range_condAND->addComparison (FieldComparisonConstPtr (new pcl::FieldComparison<PointT> ("x", pcl::ComparisonOps::GE, newOriginX)));
-  range_condAND->addComparison (FieldComparisonConstPtr (new pcl::FieldComparison<PointT> ("x", pcl::ComparisonOps::LT, newLimitX)));
-  range_condAND->addComparison (FieldComparisonConstPtr (new pcl::FieldComparison<PointT> ("y", pcl::ComparisonOps::GE, newOriginY)));
-  range_condAND->addComparison (FieldComparisonConstPtr (new pcl::FieldComparison<PointT> ("y", pcl::ComparisonOps::LT, newLimitY)));
-  range_condAND->addComparison (FieldComparisonConstPtr (new pcl::FieldComparison<PointT> ("z", pcl::ComparisonOps::GE, newOriginZ)));
-  range_condAND->addComparison (FieldComparisonConstPtr (new pcl::FieldComparison<PointT> ("z", pcl::ComparisonOps::LT, newLimitZ))); 
-  
-  // build the filter
-  pcl::ConditionalRemoval<PointT> condremAND (true);
-  condremAND.setCondition (range_condAND);
-  condremAND.setInputCloud (world_);
-  condremAND.setKeepOrganized (false);
-  
-  // apply filter
-  condremAND.filter (*newCube);
-	
-  // filter points that belong to the new slice
-  ConditionOrPtr range_condOR (new pcl::ConditionOr<PointT> ());
-  
-  if(offset_x >= 0)
-	range_condOR->addComparison (FieldComparisonConstPtr (new pcl::FieldComparison<PointT> ("x", pcl::ComparisonOps::GE,  previous_origin_x + volume_x - 1.0 )));
-  else
-	range_condOR->addComparison (FieldComparisonConstPtr (new pcl::FieldComparison<PointT> ("x", pcl::ComparisonOps::LT,  previous_origin_x )));
-	
-  if(offset_y >= 0)
-	range_condOR->addComparison (FieldComparisonConstPtr (new pcl::FieldComparison<PointT> ("y", pcl::ComparisonOps::GE,  previous_origin_y + volume_y - 1.0 )));
-  else
-	range_condOR->addComparison (FieldComparisonConstPtr (new pcl::FieldComparison<PointT> ("y", pcl::ComparisonOps::LT,  previous_origin_y )));
-	
-  if(offset_z >= 0)
-	range_condOR->addComparison (FieldComparisonConstPtr (new pcl::FieldComparison<PointT> ("z", pcl::ComparisonOps::GE,  previous_origin_z + volume_z - 1.0 )));
-  else
-	range_condOR->addComparison (FieldComparisonConstPtr (new pcl::FieldComparison<PointT> ("z", pcl::ComparisonOps::LT,  previous_origin_z )));
-  
-  // build the filter
-  pcl::ConditionalRemoval<PointT> condrem (true);
-  condrem.setCondition (range_condOR);
-  condrem.setInputCloud (newCube);
-  condrem.setKeepOrganized (false);
-  // apply filter
-  condrem.filter (existing_slice);  
- 
-  if(!existing_slice.empty ())
+  const Eigen::Vector3d new_origin (previous_origin_x + offset_x, previous_origin_y + offset_y, previous_origin_z + offset_z);
+  const Eigen::Vector3d new_limit = new_origin + Eigen::Vector3d (volume_x, volume_y, volume_z);
+
+  // the slice entering the cube, on each axis
+  const Eigen::Vector3d previous_origin (previous_origin_x, previous_origin_y, previous_origin_z);
+  const Eigen::Vector3d previous_limit = previous_origin + Eigen::Vector3d (volume_x, volume_y, volume_z) - Eigen::Vector3d::Ones ();
+  const Eigen::Vector3d offset (offset_x, offset_y, offset_z);
+
+  existing_slice.clear ();
+
+  // only the blocks overlapping the new cube are visited
+  for (const auto &block : blocks_)
   {
-	//transform the slice in new cube coordinates
-	Eigen::Affine3f transformation; 
-	transformation.translation ()[0] = newOriginX;
-	transformation.translation ()[1] = newOriginY;
-	transformation.translation ()[2] = newOriginZ;
-		
-	transformation.linear ().setIdentity ();
-
-	transformPointCloud (existing_slice, existing_slice, transformation.inverse ());
-	
+    if (!blockOverlaps (block.first, new_origin, new_limit))
+      continue;
+
+    for (const auto &point : block.second)
+    {
+      const Eigen::Vector3d p (point.x, point.y, point.z);
+
+      // points in the space of the new cube
+      if ((p.array () < new_origin.array ()).any () || (p.array () >= new_limit.array ()).any ())
+        continue;
+
+      // points that belong to the new slice
+      bool in_slice = false;
+      for (int d = 0; d < 3 && !in_slice; ++d)
+        in_slice = (offset[d] >= 0 ? p[d] >= previous_limit[d] : p[d] < previous_origin[d]);
+      if (!in_slice)
+        continue;
+
+      // transform the slice in new cube coordinates
+      PointT local = point;
+      local.x = static_cast<float> (p[0] - new_origin[0]);
+      local.y = static_cast<float> (p[1] - new_origin[1]);
+      local.z = static_cast<float> (p[2] - new_origin[2]);
+      existing_slice.push_back (local);
+    }
+  }
+}
+
+template <typename PointT> template <typename Predicate>
+void
+pcl::kinfuLS::WorldModel<PointT>::removeIf (const Eigen::Vector3d &min, const Eigen::Vector3d &max, const Predicate &remove)
+{
+  for (auto block = blocks_.begin (); block != blocks_.end (); )
+  {
+    if (!blockOverlaps (block->first, min, max))
+    {
+      ++block;
+      continue;
+    }
+
+    Block &points = block->second;
+    const auto end = std::remove_if (points.begin (), points.end (), remove);
+    const auto removed = static_cast<std::size_t> (points.end () - end);
+    if (removed)
+    {
+      points.erase (end, points.end ());
+      world_size_ -= removed;
+      world_dirty_ = true;
+    }
+
+    if (points.empty ())
+      block = blocks_.erase (block);
+    else
+      ++block;
+  }
+}
+
+template <typename PointT>
+void
+pcl::kinfuLS::WorldModel<PointT>::cleanWorldFromNans ()
+{
+  const double max = std::numeric_limits<double>::max ();
+  removeIf (Eigen::Vector3d::Constant (-max), Eigen::Vector3d::Constant (max),
+            [] (const PointT &point) { return (!pcl::isFinite (point)); });
+}
+
+template <typename PointT>
+typename pcl::kinfuLS::WorldModel<PointT>::PointCloudPtr
+pcl::kinfuLS::WorldModel<PointT>::getWorld ()
+{
+  if (world_dirty_)
+  {
+    world_->clear ();
+    world_->reserve (world_size_);
+    for (const auto &block : blocks_)
+      world_->insert (world_->end (), block.second.begin (), block.second.end ());
+    world_->is_dense = true;
+    world_dirty_ = false;
   }
+  return (world_);
 }
 
 
@@ -136,22 +172,23 @@ void
 pcl::kinfuLS::WorldModel<PointT>::getWorldAsCubes (const double size, std::vector<typename WorldModel<PointT>::PointCloudPtr> &cubes, std::vector<Eigen::Vector3f, Eigen::aligned_allocator<Eigen::Vector3f> > &transforms, double overlap)
 {
   
-  if(world_->points.empty ())
+  PointCloudPtr world = getWorld ();
+  if(world->points.empty ())
   {
 	PCL_INFO("The world is empty, returning nothing\n");
 	return;
   }
 
   PCL_INFO("Getting world as cubes. World contains %zu points.\n",
-           static_cast<std::size_t>(world_->size()));
+           static_cast<std::size_t>(world->size()));
 
   // remove nans from world cloud
-  world_->is_dense = false;
+  world->is_dense = false;
   pcl::Indices indices;
-  pcl::removeNaNFromPointCloud ( *world_, *world_, indices);
+  pcl::removeNaNFromPointCloud ( *world, *world, indices);
 
   PCL_INFO("World contains %zu points after nan removal.\n",
-           static_cast<std::size_t>(world_->size()));
+           static_cast<std::size_t>(world->size()));
 
   // check cube size value
   double cubeSide = size;
@@ -179,7 +216,7 @@ pcl::kinfuLS::WorldModel<PointT>::getWorldAsCubes (const double size, std::vecto
   
   // get world's bounding values on XYZ
   PointT min, max;
-  pcl::getMinMax3D(*world_, min, max);
+  pcl::getMinMax3D(*world, min, max);
 
   PCL_INFO ("Bounding box for the world: \n\t [%f - %f] \n\t [%f - %f] \n\t [%f - %f] \n", min.x, max.x, min.y, max.y, min.z, max.z);
 
@@ -217,7 +254,7 @@ pcl::kinfuLS::WorldModel<PointT>::getWorldAsCubes (const double size, std::vecto
 		// build the filter
 		pcl::ConditionalRemoval<PointT> condrem;
 		condrem.setCondition (range_cond);
-		condrem.setInputCloud (world_);
+		condrem.setInputCloud (world);
 		condrem.setKeepOrganized(false);
 		// apply filter
 		condrem.filter (*box);
@@ -253,160 +290,50 @@ pcl::kinfuLS::WorldModel<PointT>::getWorldAsCubes (const double size, std::vecto
   std::cout << "returning " << cubes.size() << " cubes" << std::endl;
 }
 
-template <typename PointT>
-inline void 
-pcl::kinfuLS::WorldModel<PointT>::setIndicesAsNans (PointCloudPtr cloud, IndicesConstPtr indices)
-{
-  std::vector<pcl::PCLPointField> fields;
-  pcl::for_each_type<FieldList> (pcl::detail::FieldAdder<PointT> (fields));
-  float my_nan = std::numeric_limits<float>::quiet_NaN ();
-  
-  for (int rii = 0; rii < static_cast<int> (indices->size ()); ++rii)  // rii = removed indices iterator
-  {
-    std::uint8_t* pt_data = reinterpret_cast<std::uint8_t*> (&(*cloud)[(*indices)[rii]]);
-    for (const auto &field : fields)
-      memcpy (pt_data + field.offset, &my_nan, sizeof (float));
-  }
-}
-
 
 template <typename PointT>
 void 
 pcl::kinfuLS::WorldModel<PointT>::setSliceAsNans (const double origin_x, const double origin_y, const double origin_z, const double offset_x, const double offset_y, const double offset_z, const int size_x, const int size_y, const int size_z)
 { 
-  // PCL_DEBUG ("IN SETSLICE AS NANS\n");
-  
-  PointCloudPtr slice (new pcl::PointCloud<PointT>);
-  
-  // prepare filter limits on all dimensions  
-  double previous_origin_x = origin_x;
-  double previous_limit_x = origin_x + size_x - 1;
-  double new_origin_x = origin_x + offset_x;
-  double new_limit_x = previous_limit_x + offset_x;
-
-  double previous_origin_y = origin_y;
-  double previous_limit_y = origin_y + size_y - 1;
-  double new_origin_y = origin_y + offset_y;
-  double new_limit_y = previous_limit_y + offset_y;  
- 
-  double previous_origin_z = origin_z;
-  double previous_limit_z = origin_z + size_z - 1;
-  double new_origin_z = origin_z + offset_z;
-  double new_limit_z = previous_limit_z + offset_z; 
-   
-  // get points of slice on X (we actually set a negative filter and set the ouliers (so, our slice points) to nan)
-  double lower_limit_x, upper_limit_x;
-  if(offset_x >=0)
-  {
-	lower_limit_x = previous_origin_x;
-	upper_limit_x = new_origin_x;
-  }
-  else
-  {
-	lower_limit_x = new_limit_x;
-	upper_limit_x = previous_limit_x;    
-  }
-  
-  // PCL_DEBUG ("Limit X: [%f - %f]\n", lower_limit_x, upper_limit_x);
-  
-  ConditionOrPtr range_cond_OR_x (new pcl::ConditionOr<PointT> ());
-  range_cond_OR_x->addComparison (FieldComparisonConstPtr (new pcl::FieldComparison<PointT> ("x", pcl::ComparisonOps::GE,  upper_limit_x ))); // filtered dimension
-  range_cond_OR_x->addComparison (FieldComparisonConstPtr (new pcl::FieldComparison<PointT> ("x", pcl::ComparisonOps::LT,  lower_limit_x ))); // filtered dimension
-	
-  range_cond_OR_x->addComparison (FieldComparisonConstPtr (new pcl::FieldComparison<PointT> ("y", pcl::ComparisonOps::GE,  previous_limit_y)));
-  range_cond_OR_x->addComparison (FieldComparisonConstPtr (new pcl::FieldComparison<PointT> ("y", pcl::ComparisonOps::LT,  previous_origin_y )));
-	
-  range_cond_OR_x->addComparison (FieldComparisonConstPtr (new pcl::FieldComparison<PointT> ("z", pcl::ComparisonOps::GE,  previous_limit_z)));
-  range_cond_OR_x->addComparison (FieldComparisonConstPtr (new pcl::FieldComparison<PointT> ("z", pcl::ComparisonOps::LT,  previous_origin_z )));
-
-  pcl::ConditionalRemoval<PointT> condrem_x (true);
-  condrem_x.setCondition (range_cond_OR_x);
-  condrem_x.setInputCloud (world_);
-  condrem_x.setKeepOrganized (false);
-  // apply filter
-  condrem_x.filter (*slice);  
-  IndicesConstPtr indices_x = condrem_x.getRemovedIndices ();
-  
-  //set outliers (so our slice points) to nan
-  setIndicesAsNans(world_, indices_x);
-  
-  // PCL_DEBUG("%d points set to nan on X\n", indices_x->size ());
-  
-  // get points of slice on Y (we actually set a negative filter and set the ouliers (so, our slice points) to nan)
-  double lower_limit_y, upper_limit_y;
-  if(offset_y >=0)
-  {
-	lower_limit_y = previous_origin_y;
-	upper_limit_y = new_origin_y;
-  }
-  else
+  // limits of the cube before the shift
+  const Eigen::Vector3d previous_origin (origin_x, origin_y, origin_z);
+  const Eigen::Vector3d previous_limit = previous_origin + Eigen::Vector3d (size_x - 1, size_y - 1, size_z - 1);
+  const Eigen::Vector3d offset (offset_x, offset_y, offset_z);
+
+  // the slice leaving the cube, on each axis
+  Eigen::Vector3d lower_limit, upper_limit;
+  for (int d = 0; d < 3; ++d)
   {
-	lower_limit_y = new_limit_y;
-	upper_limit_y = previous_limit_y;    
+    if (offset[d] >= 0)
+    {
+      lower_limit[d] = previous_origin[d];
+      upper_limit[d] = previous_origin[d] + offset[d];
+    }
+    else
+    {
+      lower_limit[d] = previous_limit[d] + offset[d];
+      upper_limit[d] = previous_limit[d];
+    }
   }
-  
-  // PCL_DEBUG ("Limit Y: [%f - %f]\n", lower_limit_y, upper_limit_y);
-  
-  ConditionOrPtr range_cond_OR_y (new pcl::ConditionOr<PointT> ());
-  range_cond_OR_y->addComparison (FieldComparisonConstPtr (new pcl::FieldComparison<PointT> ("x", pcl::ComparisonOps::GE,  previous_limit_x )));
-  range_cond_OR_y->addComparison (FieldComparisonConstPtr (new pcl::FieldComparison<PointT> ("x", pcl::ComparisonOps::LT,  previous_origin_x )));
-	
-  range_cond_OR_y->addComparison (FieldComparisonConstPtr (new pcl::FieldComparison<PointT> ("y", pcl::ComparisonOps::GE,  upper_limit_y))); // filtered dimension
-  range_cond_OR_y->addComparison (FieldComparisonConstPtr (new pcl::FieldComparison<PointT> ("y", pcl::ComparisonOps::LT,  lower_limit_y ))); // filtered dimension
-	
-  range_cond_OR_y->addComparison (FieldComparisonConstPtr (new pcl::FieldComparison<PointT> ("z", pcl::ComparisonOps::GE,  previous_limit_z)));
-  range_cond_OR_y->addComparison (FieldComparisonConstPtr (new pcl::FieldComparison<PointT> ("z", pcl::ComparisonOps::LT,  previous_origin_z )));
-
-  pcl::ConditionalRemoval<PointT> condrem_y (true);
-  condrem_y.setCondition (range_cond_OR_y);
-  condrem_y.setInputCloud (world_);
-  condrem_y.setKeepOrganized (false);
-  // apply filter
-  condrem_y.filter (*slice);  
-  IndicesConstPtr indices_y = condrem_y.getRemovedIndices ();
-  
-  //set outliers (so our slice points) to nan
-  setIndicesAsNans(world_, indices_y);
-  // PCL_DEBUG ("%d points set to nan on Y\n", indices_y->size ());
-  
-  // get points of slice on Z (we actually set a negative filter and set the ouliers (so, our slice points) to nan)
-  double lower_limit_z, upper_limit_z;
-  if(offset_z >=0)
-  {
-	lower_limit_z = previous_origin_z;
-	upper_limit_z = new_origin_z;
-  }
-  else
+
+  // a point is part of the slice on axis d if it lies between the slice limits on d
+  // and inside the previous cube on the two other axes
+  const auto in_slice = [&] (const PointT &point)
   {
-	lower_limit_z = new_limit_z;
-	upper_limit_z = previous_limit_z;    
-  }
-  
-  // PCL_DEBUG ("Limit Z: [%f - %f]\n", lower_limit_z, upper_limit_z);
-  
-  ConditionOrPtr range_cond_OR_z (new pcl::ConditionOr<PointT> ());
-  range_cond_OR_z->addComparison (FieldComparisonConstPtr (new pcl::FieldComparison<PointT> ("x", pcl::ComparisonOps::GE,  previous_limit_x )));
-  range_cond_OR_z->addComparison (FieldComparisonConstPtr (new pcl::FieldComparison<PointT> ("x", pcl::ComparisonOps::LT,  previous_origin_x )));
-	
-  range_cond_OR_z->addComparison (FieldComparisonConstPtr (new pcl::FieldComparison<PointT> ("y", pcl::ComparisonOps::GE,  previous_limit_y)));
-  range_cond_OR_z->addComparison (FieldComparisonConstPtr (new pcl::FieldComparison<PointT> ("y", pcl::ComparisonOps::LT,  previous_origin_y )));
-	
-  range_cond_OR_z->addComparison (FieldComparisonConstPtr (new pcl::FieldComparison<PointT> ("z", pcl::ComparisonOps::GE,  upper_limit_z))); // filtered dimension
-  range_cond_OR_z->addComparison (FieldComparisonConstPtr (new pcl::FieldComparison<PointT> ("z", pcl::ComparisonOps::LT,  lower_limit_z ))); // filtered dimension
-
-  pcl::ConditionalRemoval<PointT> condrem_z (true);
-  condrem_z.setCondition (range_cond_OR_z);
-  condrem_z.setInputCloud (world_);
-  condrem_z.setKeepOrganized (false);
-  // apply filter
-  condrem_z.filter (*slice);  
-  IndicesConstPtr indices_z = condrem_z.getRemovedIndices ();
-  
-  //set outliers (so our slice points) to nan
-  setIndicesAsNans(world_, indices_z);
-  // PCL_DEBUG("%d points set to nan on Z\n", indices_z->size ());
-  
-  
+    const Eigen::Vector3d p (point.x, point.y, point.z);
+    for (int d = 0; d < 3; ++d)
+    {
+      bool inside = (p[d] >= lower_limit[d] && p[d] < upper_limit[d]);
+      for (int e = 0; e < 3 && inside; ++e)
+        if (e != d)
+          inside = (p[e] >= previous_origin[e] && p[e] < previous_limit[e]);
+      if (inside)
+        return (true);
+    }
+    return (false);
+  };
+
+  removeIf (lower_limit.cwiseMin (previous_origin), upper_limit.cwiseMax (previous_limit), in_slice);
 }
 
 #define PCL_INSTANTIATE_WorldModel(T) template class PCL_EXPORTS pcl::kinfuLS::WorldModel<T>;
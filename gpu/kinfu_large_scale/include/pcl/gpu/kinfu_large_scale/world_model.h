@@ -44,6 +44,7 @@
 #include <pcl/filters/conditional_removal.h>
 #include <pcl/point_types.h>
 #include <pcl/io/pcd_io.h>
+#include <unordered_map>
 //#include <pcl/gpu/kinfu_large_scale/tsdf_buffer.h>
 //#include <boost/graph/buffer_concepts.hpp>
 
@@ -53,9 +54,11 @@ namespace pcl
   namespace kinfuLS
   {
     /** \brief WorldModel maintains a 3D point cloud that can be queried and updated via helper functions.\n
-      * The world is represented as a point cloud.\n
-      * When new points are added to the world, we replace old ones by the newest ones.
-      * This is achieved by setting old points to nan (for speed)
+      * The world is represented as a point cloud, in the global grid coordinates of the TSDF volume.\n
+      * The points are hashed into cubic blocks of block_size voxels, so that a shift only touches the
+      * blocks that overlap the slice instead of filtering the whole world. When new points are added
+      * to the world, we replace old ones by the newest ones.
+      * \note Not thread safe, pcl::gpu::kinfuLS::CyclicalBuffer serializes the accesses.
       * \author Raphael Favier
       */
     template <typename PointT>
@@ -77,8 +80,10 @@ namespace pcl
         using FieldList = typename pcl::traits::fieldList<PointT>::type;
 
         /** \brief Default constructor for the WorldModel.
+          * \param[in] block_size edge length of the hash blocks, in voxels
           */
-        WorldModel() : 
+        WorldModel (int block_size = 32) :
+          block_size_ (block_size > 0 ? block_size : 32),
           world_ (new PointCloud)
         {
           world_->is_dense = false;
@@ -88,11 +93,14 @@ namespace pcl
           */
         void reset()
         {
-          if(!world_->points.empty ())
+          if(!blocks_.empty ())
           {
             PCL_WARN("Clearing world model\n");
-            world_->points.clear ();
+            blocks_.clear ();
           }
+          world_->clear ();
+          world_size_ = 0;
+          world_dirty_ = false;
         }
 
         /** \brief Append a new point cloud (slice) to the world.
@@ -117,7 +125,7 @@ namespace pcl
                             const double offset_x, const double offset_y, const double offset_z,
                             const double volume_x, const double volume_y, const double volume_z, pcl::PointCloud<PointT> &existing_slice);
         
-        /** \brief Give nan values to the slice of the world 
+        /** \brief Remove the slice that leaves the cube from the world
           * \param[in] origin_x global origin of the cube on X axis, before the shift
           * \param[in] origin_y global origin of the cube on Y axis, before the shift
           * \param[in] origin_z global origin of the cube on Z axis, before the shift
@@ -127,6 +135,7 @@ namespace pcl
           * \param[in] size_x size of the cube, X axis, in indices
           * \param[in] size_y size of the cube, Y axis, in indices
           * \param[in] size_z size of the cube, Z axis, in indices
+          * \note The points are erased from their blocks right away, the name is kept for compatibility.
           */                    
         void setSliceAsNans (const double origin_x, const double origin_y, const double origin_z,
                             const double offset_x, const double offset_y, const double offset_z,
@@ -134,25 +143,30 @@ namespace pcl
 
         /** \brief Remove points with nan values from the world.
           */
-        void cleanWorldFromNans () 
-        { 
-          world_->is_dense = false;
-          pcl::Indices indices;
-          pcl::removeNaNFromPointCloud (*world_, *world_, indices);
-        }
+        void cleanWorldFromNans ();
 
         /** \brief Returns the world as a point cloud.
+          * \note The cloud is assembled from the blocks when the world changed since the last call.
           */
-        PointCloudPtr getWorld () 
-        { 
-          return (world_); 
-        }
+        PointCloudPtr getWorld ();
         
         /** \brief Returns the number of points contained in the world.
           */      
         std::size_t getWorldSize () 
         { 
-          return (world_->size () );
+          return (world_size_);
+        }
+
+        /** \brief Returns the number of hash blocks holding points. */
+        std::size_t getNumberOfBlocks () const
+        {
+          return (blocks_.size ());
+        }
+
+        /** \brief Returns the edge length of the hash blocks, in voxels. */
+        int getBlockSize () const
+        {
+          return (block_size_);
         }
 
         /** \brief Returns the world as two vectors of cubes of size "size" (pointclouds) and transforms
@@ -166,15 +180,61 @@ namespace pcl
         
       private:
 
-        /** \brief cloud containing our world */
+        /** \brief Integer coordinates of a hash block. */
+        struct BlockKey
+        {
+          int x, y, z;
+
+          bool operator== (const BlockKey &other) const
+          {
+            return (x == other.x && y == other.y && z == other.z);
+          }
+        };
+
+        /** \brief Spatial hash of a block, see Teschner et al., "Optimized Spatial Hashing for Collision Detection of Deformable Objects". */
+        struct BlockKeyHash
+        {
+          std::size_t operator() (const BlockKey &key) const
+          {
+            return (static_cast<std::size_t> (key.x * 73856093) ^ static_cast<std::size_t> (key.y * 19349663) ^ static_cast<std::size_t> (key.z * 83492791));
+          }
+        };
+
+        using Block = std::vector<PointT, Eigen::aligned_allocator<PointT> >;
+        using BlockMap = std::unordered_map<BlockKey, Block, BlockKeyHash>;
+
+        /** \brief Returns the block a coordinate falls into, along one axis. */
+        inline int getBlockCoordinate (double value) const
+        {
+          return (static_cast<int> (std::floor (value / block_size_)));
+        }
+
+        /** \brief Returns true if the block at key overlaps the box [min, max]. */
+        inline bool blockOverlaps (const BlockKey &key, const Eigen::Vector3d &min, const Eigen::Vector3d &max) const
+        {
+          return (key.x >= getBlockCoordinate (min[0]) && key.x <= getBlockCoordinate (max[0]) &&
+                  key.y >= getBlockCoordinate (min[1]) && key.y <= getBlockCoordinate (max[1]) &&
+                  key.z >= getBlockCoordinate (min[2]) && key.z <= getBlockCoordinate (max[2]));
+        }
+
+        /** \brief Erase the points of the blocks overlapping [min, max] for which remove returns true. */
+        template <typename Predicate> void
+        removeIf (const Eigen::Vector3d &min, const Eigen::Vector3d &max, const Predicate &remove);
+
+        /** \brief the points of the world, per block */
+        BlockMap blocks_;
+
+        /** \brief edge length of the blocks, in voxels */
+        int block_size_;
+
+        /** \brief number of points in blocks_ */
+        std::size_t world_size_ = 0;
+
+        /** \brief cloud containing our world, assembled from blocks_ by getWorld () */
         PointCloudPtr world_;
 
-        /** \brief set the points which index is in the indices vector to nan 
-          * \param[in] cloud the cloud that contains the point to be set to nan
-          * \param[in] indices the vector of indices to set to nan
-          */
-        inline void setIndicesAsNans (PointCloudPtr cloud, IndicesConstPtr indices);
-        
+        /** \brief true if blocks_ changed since world_ was assembled */
+        bool world_dirty_ = false;
     };
   }
 }
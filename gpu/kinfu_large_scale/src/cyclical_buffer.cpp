@@ -38,7 +38,7 @@
 
 #include <pcl/gpu/kinfu_large_scale/cyclical_buffer.h>
 #include <pcl/common/distances.h>
-#include <pcl/common/transforms.h> // for transformPoint, transformPointCloud
+#include <pcl/common/transforms.h> // for transformPoint
 #include "internal.h"
 
 
@@ -78,13 +78,14 @@ pcl::gpu::kinfuLS::CyclicalBuffer::checkForShift (const TsdfVolume::Ptr volume,
 void
 pcl::gpu::kinfuLS::CyclicalBuffer::performShift (const TsdfVolume::Ptr volume, const pcl::PointXYZ &target_point, const bool last_shift)
 {
+  // the world model and the slice buffers are still in use by the update of the previous shift
+  finishWorldUpdate ();
+
   // compute new origin and offsets
   int offset_x, offset_y, offset_z;
   computeAndSetNewCubeMetricOrigin (target_point, offset_x, offset_y, offset_z);
 
   // extract current slice from the TSDF volume (coordinates are in indices! (see fetchSliceAsCloud() )
-  DeviceArray<PointXYZ> points;
-  DeviceArray<float> intensities;
   int size;
   if(!last_shift)
   {
@@ -94,42 +95,17 @@ pcl::gpu::kinfuLS::CyclicalBuffer::performShift (const TsdfVolume::Ptr volume, c
   {
     size = volume->fetchSliceAsCloud (cloud_buffer_device_xyz_, cloud_buffer_device_intensities_, &buffer_, buffer_.voxels_size.x - 1, buffer_.voxels_size.y - 1, buffer_.voxels_size.z - 1);
   }
-  points = DeviceArray<PointXYZ> (cloud_buffer_device_xyz_.ptr (), size);
-  intensities = DeviceArray<float> (cloud_buffer_device_intensities_.ptr(), size);
-
-  PointCloud<PointXYZI>::Ptr current_slice (new PointCloud<PointXYZI>);
-  PointCloud<PointXYZ>::Ptr current_slice_xyz (new PointCloud<PointXYZ>);
-  PointCloud<PointIntensity>::Ptr current_slice_intensities (new PointCloud<PointIntensity>);
-
-  // Retrieving XYZ
-  points.download (current_slice_xyz->points);
-  current_slice_xyz->width = current_slice_xyz->size ();
-  current_slice_xyz->height = 1;
 
-  // Retrieving intensities
+  // download the slice on its own stream, it overlaps with the world model query below
   // TODO change this mechanism by using PointIntensity directly (in spite of float)
   // when tried, this lead to wrong intenisty values being extracted by fetchSliceAsCloud () (padding pbls?)
-  std::vector<float , Eigen::aligned_allocator<float> > intensities_vector;
-  intensities.download (intensities_vector);
-  current_slice_intensities->resize (current_slice_xyz->size ());
-  for(std::size_t i = 0 ; i < current_slice_intensities->size () ; ++i)
-    (*current_slice_intensities)[i].intensity = intensities_vector[i];
-
-  current_slice_intensities->width = current_slice_intensities->size ();
-  current_slice_intensities->height = 1;
-
-  // Concatenating XYZ and Intensities
-  pcl::concatenateFields (*current_slice_xyz, *current_slice_intensities, *current_slice);
-  current_slice->width = current_slice->size ();
-  current_slice->height = 1;
-
-  // transform the slice from local to global coordinates
-  Eigen::Affine3f global_cloud_transformation;
-  global_cloud_transformation.translation ()[0] = buffer_.origin_GRID_global.x;
-  global_cloud_transformation.translation ()[1] = buffer_.origin_GRID_global.y;
-  global_cloud_transformation.translation ()[2] = buffer_.origin_GRID_global.z;
-  global_cloud_transformation.linear () = Eigen::Matrix3f::Identity ();
-  transformPointCloud (*current_slice, *current_slice, global_cloud_transformation);
+  cloud_buffer_host_xyz_.resize (size);
+  cloud_buffer_host_intensities_.resize (size);
+  if (size > 0)
+  {
+    DeviceArray<PointXYZ> (cloud_buffer_device_xyz_.ptr (), size).downloadAsync (cloud_buffer_host_xyz_.data (), download_stream_);
+    DeviceArray<float> (cloud_buffer_device_intensities_.ptr (), size).downloadAsync (cloud_buffer_host_intensities_.data (), download_stream_);
+  }
 
   // retrieve existing data from the world model
   PointCloud<PointXYZI>::Ptr previously_existing_slice (new  PointCloud<PointXYZI>);
@@ -138,23 +114,38 @@ pcl::gpu::kinfuLS::CyclicalBuffer::performShift (const TsdfVolume::Ptr volume, c
                                 buffer_.voxels_size.x - 1, buffer_.voxels_size.y - 1, buffer_.voxels_size.z - 1,
                                 *previously_existing_slice);
 
-  //replace world model data with values extracted from the TSDF buffer slice
-  world_model_.setSliceAsNans (buffer_.origin_GRID_global.x, buffer_.origin_GRID_global.y, buffer_.origin_GRID_global.z,
-                               offset_x, offset_y, offset_z,
-                               buffer_.voxels_size.x, buffer_.voxels_size.y, buffer_.voxels_size.z);
-
-
-  PCL_INFO ("world contains %d points after update\n", world_model_.getWorldSize ());
-  world_model_.cleanWorldFromNans ();
-  PCL_INFO ("world contains %d points after cleaning\n", world_model_.getWorldSize ());
-
-  // clear buffer slice and update the world model
+  // clear buffer slice
   pcl::device::kinfuLS::clearTSDFSlice (volume->data (), &buffer_, offset_x, offset_y, offset_z);
 
-  // insert current slice in the world if it contains any points
-  if (!current_slice->points.empty ()) {
-    world_model_.addSlice(current_slice);
-  }
+  // update the world model in the background: replace world model data with values extracted from the TSDF buffer slice
+  const float3 origin_GRID_global = buffer_.origin_GRID_global;
+  const int3 voxels_size = buffer_.voxels_size;
+  world_update_ = std::async (std::launch::async, [this, origin_GRID_global, voxels_size, offset_x, offset_y, offset_z]
+  {
+    download_stream_.waitForCompletion ();
+
+    // Concatenating XYZ and Intensities, and transforming the slice from local to global coordinates
+    PointCloud<PointXYZI>::Ptr current_slice (new PointCloud<PointXYZI>);
+    current_slice->resize (cloud_buffer_host_xyz_.size ());
+    for (std::size_t i = 0; i < current_slice->size (); ++i)
+    {
+      PointXYZI &point = (*current_slice)[i];
+      point.x = cloud_buffer_host_xyz_[i].x + origin_GRID_global.x;
+      point.y = cloud_buffer_host_xyz_[i].y + origin_GRID_global.y;
+      point.z = cloud_buffer_host_xyz_[i].z + origin_GRID_global.z;
+      point.intensity = cloud_buffer_host_intensities_[i];
+    }
+
+    world_model_.setSliceAsNans (origin_GRID_global.x, origin_GRID_global.y, origin_GRID_global.z,
+                                 offset_x, offset_y, offset_z,
+                                 voxels_size.x, voxels_size.y, voxels_size.z);
+
+    // insert current slice in the world if it contains any points
+    if (!current_slice->points.empty ())
+      world_model_.addSlice (current_slice);
+
+    PCL_DEBUG ("world contains %zu points after update\n", world_model_.getWorldSize ());
+  });
 
   // shift buffer addresses
   shiftOrigin (volume, offset_x, offset_y, offset_z);
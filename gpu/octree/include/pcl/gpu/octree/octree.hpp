@@ -43,6 +43,7 @@
 #include <pcl/point_types.h>
 #include <pcl/pcl_macros.h>
 #include <pcl/gpu/containers/device_array.h>
+#include <pcl/gpu/containers/stream.h>
 #include <pcl/gpu/octree/device_format.hpp>
 
 namespace pcl
@@ -94,6 +95,28 @@ namespace pcl
             /** \brief Performs parallel octree building */
 			void build();
 
+            /** \brief Enqueues the octree building on a stream. The bounding box reduction waits for the stream, the
+              * following steps return at once. Searches enqueued on the same stream run after the building.
+              * \param[in] stream stream to enqueue the building on
+              */
+            void build(Stream& stream);
+
+            /** \brief Inserts points into the octree without sorting all points again.
+              * Afterwards the octree keeps its own copy of the points, which cloud_ points to, and the inserted points
+              * get the indices following the existing ones. If all new points are inside the bounding box of the octree,
+              * only their Morton codes are sorted and merged into the existing ones, otherwise the octree is rebuilt.
+              * \param[in] points points to insert
+              */
+            void insert(const PointCloud& points);
+
+            /** \brief Removes all points inside an axis aligned box.
+              * The remaining points keep their order, so indices of points after a removed one are shifted down.
+              * Afterwards the octree keeps its own copy of the points, which cloud_ points to.
+              * \param[in] min_pt minimum corner of the box
+              * \param[in] max_pt maximum corner of the box
+              */
+            void remove(const PointType& min_pt, const PointType& max_pt);
+
             /** \brief Returns true if tree has been built */
             bool isBuilt() const;
 
@@ -123,6 +146,15 @@ namespace pcl
               */
             void radiusSearch(const Queries& centers, float radius, int max_results, NeighborIndices& result) const;
 
+            /** \brief Enqueues batch radius search on a stream, the results are valid after the stream completed
+              * \param[in] centers array of centers 
+              * \param[in] radius radius for all queries
+              * \param[in] max_results max number of returned points for each querey
+              * \param[out] result results packed to single array
+              * \param[in] stream stream to enqueue the search on
+              */
+            void radiusSearch(const Queries& centers, float radius, int max_results, NeighborIndices& result, Stream& stream) const;
+
             /** \brief Performs batch radius search on GPU
               * \param[in] centers array of centers 
               * \param[in] radiuses array of radiuses
@@ -140,6 +172,16 @@ namespace pcl
               */
             void radiusSearch(const Queries& centers, const Indices& indices, float radius, int max_results, NeighborIndices& result) const;
 
+            /** \brief Enqueues batch radius search on a stream, the results are valid after the stream completed
+              * \param[in] centers array of centers 
+              * \param[in] indices indices for centers array (only for these points search is performed)
+              * \param[in] radius radius for all queries
+              * \param[in] max_results max number of returned points for each querey
+              * \param[out] result results packed to single array
+              * \param[in] stream stream to enqueue the search on
+              */
+            void radiusSearch(const Queries& centers, const Indices& indices, float radius, int max_results, NeighborIndices& result, Stream& stream) const;
+
             /** \brief Batch approximate nearest search on GPU
               * \param[in] queries array of centers
               * \param[out] result array of results ( one index for each query ) 
@@ -154,18 +196,22 @@ namespace pcl
               */
             void approxNearestSearch(const Queries& queries, NeighborIndices& result, ResultSqrDists& sqr_distance) const;
 
-            /** \brief Batch exact k-nearest search on GPU for k == 1 only!
+            /** \brief Batch exact k-nearest search on GPU
               * \param[in] queries array of centers
-              * \param[in] k number of neighbors (only k == 1 is supported)
-              * \param[out] results array of results
+              * \param[in] k number of neighbors, 1 <= k <= 64
+              * \param[out] results array of results, sorted by increasing distance. For k > 1, results.sizes holds
+              * the number of neighbors found for each query, which is smaller than k if the cloud has less points.
               */
             void nearestKSearchBatch(const Queries& queries, int k, NeighborIndices& results) const;
 
-            /** \brief Batch exact k-nearest search on GPU for k == 1 only!
+            /** \brief Batch exact k-nearest search on GPU
+              *
+              * Every query keeps its k closest points found so far in a bounded priority queue in shared memory.
               * \param[in] queries array of centers
-              * \param[in] k number of neighbors (only k == 1 is supported)
-              * \param[out] results array of results
-              * \param[out] sqr_distances square distances to results
+              * \param[in] k number of neighbors, 1 <= k <= 64
+              * \param[out] results array of results, sorted by increasing distance. For k > 1, results.sizes holds
+              * the number of neighbors found for each query, which is smaller than k if the cloud has less points.
+              * \param[out] sqr_distances square distances to results, k per query
               */
             void nearestKSearchBatch(const Queries& queries, int k, NeighborIndices& results, ResultSqrDists& sqr_distances) const;
 
@@ -0,0 +1,149 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2019-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <pcl/gpu/octree/octree.hpp>
+#include <pcl/search/search.h>
+
+namespace pcl
+{
+    namespace gpu
+    {
+        /** \brief @b OctreeSearch is a pcl::search::Search whose k nearest neighbor searches run on the GPU.
+          *
+          * setInputCloud uploads the finite points of the input and builds a pcl::gpu::Octree on the device. The
+          * batch k nearest neighbor searches upload all query points at once and run a single exact search on the
+          * device (see Octree::nearestKSearchBatch), so that algorithms using the batch interface of
+          * pcl::search::Search, e.g. for normal estimation or correspondence estimation, do not need a CPU tree.
+          * Single point k nearest neighbor searches run on the device as well. Radius searches use the copy of
+          * the octree that is downloaded to the host.
+          *
+          * The k nearest neighbors are always sorted by increasing distance, k is limited to 64.
+          * \note Query points that are not finite have no neighbors.
+          */
+        class PCL_EXPORTS OctreeSearch : public pcl::search::Search<pcl::PointXYZ>
+        {
+        public:
+            using PointType = pcl::PointXYZ;
+            using BaseClass = pcl::search::Search<PointType>;
+            using PointCloud = BaseClass::PointCloud;
+            using PointCloudConstPtr = BaseClass::PointCloudConstPtr;
+            using IndicesConstPtr = BaseClass::IndicesConstPtr;
+
+            using Ptr = shared_ptr<OctreeSearch>;
+            using ConstPtr = shared_ptr<const OctreeSearch>;
+
+            using BaseClass::nearestKSearch;
+            using BaseClass::radiusSearch;
+
+            /** \brief Constructor.
+              * \param[in] sorted_results whether the results of radius searches are sorted by distance
+              */
+            OctreeSearch (bool sorted_results = false);
+
+            /** \brief Upload the input cloud, or the points given by indices, and build the octree on the device.
+              * \param[in] cloud the point cloud to search in
+              * \param[in] indices the point indices subset that is to be used from the cloud
+              */
+            void
+            setInputCloud (const PointCloudConstPtr& cloud, const IndicesConstPtr& indices = IndicesConstPtr ()) override;
+
+            /** \brief Search for the k nearest neighbors of a single point on the device.
+              * \param[in] point the given query point
+              * \param[in] k the number of neighbors to search for
+              * \param[out] k_indices the resultant indices of the neighboring points
+              * \param[out] k_sqr_distances the resultant squared distances to the neighboring points
+              * \return number of neighbors found
+              */
+            int
+            nearestKSearch (const PointType& point, int k, Indices& k_indices,
+                            std::vector<float>& k_sqr_distances) const override;
+
+            /** \brief Search for the k nearest neighbors of many points with one batch search on the device.
+              * \see pcl::search::Search::nearestKSearch for the parameters
+              */
+            void
+            nearestKSearch (const PointCloud& cloud, const Indices& indices, int k,
+                            std::vector<Indices>& k_indices,
+                            std::vector< std::vector<float> >& k_sqr_distances) const override;
+
+            /** \brief Search for the k nearest neighbors of many points with one batch search on the device, the
+              * results are written into flat buffers.
+              * \see pcl::search::Search::nearestKSearch for the parameters, nr_threads is ignored
+              */
+            void
+            nearestKSearch (const PointCloud& cloud, const Indices& indices, int k,
+                            Indices& k_indices, std::vector<float>& k_sqr_distances,
+                            std::vector<std::size_t>& offsets, unsigned int nr_threads = 0) const override;
+
+            /** \brief Search for all the neighbors of a point in a given radius, on the host copy of the octree.
+              * \param[in] point the given query point
+              * \param[in] radius the radius of the sphere bounding all of point's neighbors
+              * \param[out] k_indices the resultant indices of the neighboring points
+              * \param[out] k_sqr_distances the resultant squared distances to the neighboring points
+              * \param[in] max_nn if given, bounds the maximum returned neighbors to this value. These are not
+              * necessarily the closest ones.
+              * \return number of neighbors found in radius
+              */
+            int
+            radiusSearch (const PointType& point, double radius, Indices& k_indices,
+                          std::vector<float>& k_sqr_distances, unsigned int max_nn = 0) const override;
+
+        protected:
+            /** \brief Run a batch k nearest neighbor search for finite query points on the device.
+              * \param[in] queries the query points
+              * \param[in] k the number of neighbors to search for
+              * \param[out] neighbors k positions in the uploaded points for each query
+              * \param[out] sqr_distances k squared distances for each query
+              * \param[out] sizes the number of neighbors found for each query
+              * \return false if nothing could be searched
+              */
+            bool
+            searchBatch (const std::vector<PointType>& queries, int k, std::vector<int>& neighbors,
+                         std::vector<float>& sqr_distances, std::vector<int>& sizes) const;
+
+            /** \brief The points the octree was built from, which it keeps a reference to. */
+            Octree::PointCloud points_device_;
+
+            /** \brief Index in input_ of every point of points_device_. */
+            Indices point_indices_;
+
+            /** \brief The octree of points_device_. */
+            Octree::Ptr octree_;
+        };
+    }
+}
@@ -257,6 +257,222 @@ namespace pcl { namespace device { namespace knn_search
         }
     };
     
+    struct KernelPolicyK
+    {
+        enum 
+        {
+            CTA_SIZE = 64,
+            WARP_SIZE = 32,
+        };
+    };
+
+    // Exact search of the k > 1 nearest neighbors. As in Warp_knnSearch every thread traverses the octree for its
+    // own query, and the leaves of all queries of a warp are scanned by the whole warp. Every thread keeps the k
+    // closest points found so far in a bounded max-heap in shared memory, the farthest of them bounds the search.
+    struct Warp_knnSearchK
+    {   
+    public:                        
+        using OctreeIterator = OctreeIteratorDeviceNS;
+
+        const Batch& batch;
+        const int k;
+
+        int query_index;        
+        float3 query;  
+
+        // heap of this thread, element i is at [i * CTA_SIZE] so that the heaps of a warp use different banks
+        float* heap_sqr_dists;
+        int* heap_indices;
+        int heap_size;
+
+        OctreeIterator iterator;     
+
+        __device__ __forceinline__ Warp_knnSearchK(const Batch& batch_arg, const int k_arg, const int query_index_arg, float* heap_sqr_dists_arg, int* heap_indices_arg)
+            : batch(batch_arg), k(k_arg), query_index(query_index_arg), heap_sqr_dists(heap_sqr_dists_arg), heap_indices(heap_indices_arg), heap_size(0), iterator(batch.octree) { }
+
+        __device__ __forceinline__ void launch(bool active)
+        {              
+            if (active)
+            {
+                PointType q = batch.queries[query_index];
+                query = make_float3(q.x, q.y, q.z);
+            }
+            else                
+                query_index = -1;    
+
+            while(__any_sync(0xFFFFFFFF, active))
+            {                
+                int leaf = -1;
+           
+                if (active)
+                    leaf = examineNode(iterator);             
+
+                processLeaf(leaf);      
+
+                active = active && iterator.level >= 0;
+            }
+            if (query_index != -1)
+            {
+                // sort the neighbors by popping the farthest one into the last free slot
+                const int found = heap_size;
+                const int offset = query_index * k;
+                for (int i = found - 1; i >= 0; --i)
+                {
+                    batch.output[offset + i] = batch.indices[heap_indices[0]];
+                    batch.sqr_distances[offset + i] = heap_sqr_dists[0];
+                    --heap_size;
+                    siftDown(heap_sqr_dists[heap_size * KernelPolicyK::CTA_SIZE], heap_indices[heap_size * KernelPolicyK::CTA_SIZE]);
+                }
+                batch.sizes[query_index] = found;
+            }
+        }
+    private:
+
+        __device__ __forceinline__ float worstSqrDistance() const
+        {
+            return heap_size < k ? std::numeric_limits<float>::max() : heap_sqr_dists[0];
+        }
+
+        // moves the element at position i towards the root until its parent is not closer
+        __device__ __forceinline__ void siftUp(int i, const float sqr_dist, const int index)
+        {
+            while (i > 0)
+            {
+                const int parent = (i - 1) / 2;
+                if (heap_sqr_dists[parent * KernelPolicyK::CTA_SIZE] >= sqr_dist)
+                    break;
+                heap_sqr_dists[i * KernelPolicyK::CTA_SIZE] = heap_sqr_dists[parent * KernelPolicyK::CTA_SIZE];
+                heap_indices[i * KernelPolicyK::CTA_SIZE] = heap_indices[parent * KernelPolicyK::CTA_SIZE];
+                i = parent;
+            }
+            heap_sqr_dists[i * KernelPolicyK::CTA_SIZE] = sqr_dist;
+            heap_indices[i * KernelPolicyK::CTA_SIZE] = index;
+        }
+
+        // puts an element at the root, which is free, and moves it down until no child is farther
+        __device__ __forceinline__ void siftDown(const float sqr_dist, const int index)
+        {
+            int i = 0;
+            for(;;)
+            {
+                int child = 2 * i + 1;
+                if (child >= heap_size)
+                    break;
+                if (child + 1 < heap_size && heap_sqr_dists[(child + 1) * KernelPolicyK::CTA_SIZE] > heap_sqr_dists[child * KernelPolicyK::CTA_SIZE])
+                    ++child;
+                if (heap_sqr_dists[child * KernelPolicyK::CTA_SIZE] <= sqr_dist)
+                    break;
+                heap_sqr_dists[i * KernelPolicyK::CTA_SIZE] = heap_sqr_dists[child * KernelPolicyK::CTA_SIZE];
+                heap_indices[i * KernelPolicyK::CTA_SIZE] = heap_indices[child * KernelPolicyK::CTA_SIZE];
+                i = child;
+            }
+            if (i < heap_size)
+            {
+                heap_sqr_dists[i * KernelPolicyK::CTA_SIZE] = sqr_dist;
+                heap_indices[i * KernelPolicyK::CTA_SIZE] = index;
+            }
+        }
+
+        __device__ __forceinline__ void push(const float sqr_dist, const int index)
+        {
+            if (heap_size < k)
+                siftUp(heap_size++, sqr_dist, index);
+            else if (sqr_dist < heap_sqr_dists[0])
+                siftDown(sqr_dist, index);
+        }
+
+        __device__ __forceinline__ int examineNode(OctreeIterator& iterator)
+        {                        
+            const int node_idx = *iterator;
+            const int code = batch.octree.codes[node_idx];
+
+            float3 node_minp = batch.octree.minp;
+            float3 node_maxp = batch.octree.maxp;        
+            calcBoundingBox(iterator.level, code, node_minp, node_maxp);
+
+            //if true, take nothing, and go to next
+            if (checkIfNodeOutsideSphere(node_minp, node_maxp, query, sqrt(worstSqrDistance())))
+            {     
+                ++iterator;
+                return -1;                
+            }                    
+
+            //need to go to next level
+            const int node = batch.octree.nodes[node_idx];
+            const int children_mask = node & 0xFF;            
+            const bool isLeaf = children_mask == 0;            
+
+            if (isLeaf)
+            {
+                ++iterator;
+                return node_idx;
+            }
+
+            //goto next level
+            const int first = node >> 8;
+            const int len   = __popc(children_mask);
+            iterator.gotoNextLevel(first, len);                    
+            return -1;
+        };
+
+        __device__ __forceinline__ void processLeaf(const int node_idx)
+        {   
+            constexpr unsigned FULL_MASK = 0xFFFFFFFF;
+            int mask = __ballot_sync(FULL_MASK, node_idx != -1);            
+
+            const unsigned int laneId = Warp::laneId();
+
+            while(mask)
+            {
+                const int active_lane = __ffs(mask) - 1; //[0..31]
+                mask &= ~(1 << active_lane);
+
+                //broadcast beg and end
+                int fbeg, fend;
+                if (active_lane == laneId)
+                {
+                    fbeg = batch.octree.begs[node_idx];
+                    fend = batch.octree.ends[node_idx];
+                }
+                const int beg = __shfl_sync(FULL_MASK, fbeg, active_lane);
+                const int end = __shfl_sync(FULL_MASK, fend, active_lane);
+
+                //broadcast warp_query
+                const float3 active_query = make_float3(
+                    __shfl_sync(FULL_MASK, query.x, active_lane),
+                    __shfl_sync(FULL_MASK, query.y, active_lane),
+                    __shfl_sync(FULL_MASK, query.z, active_lane)
+                );
+
+                for (int base = beg; base < end; base += Warp::STRIDE)
+                {
+                    const int idx = base + laneId;
+                    float d2 = std::numeric_limits<float>::max();
+                    if (idx < end)
+                    {
+                        const float dx = batch.points[idx] - active_query.x;
+                        const float dy = batch.points[idx + batch.points_step] - active_query.y;
+                        const float dz = batch.points[idx + batch.points_step * 2] - active_query.z;
+                        d2 = dx * dx + dy * dy + dz * dz;
+                    }
+
+                    // the points closer than the farthest neighbor of the active lane are handed over one by one
+                    const float bound = __shfl_sync(FULL_MASK, worstSqrDistance(), active_lane);
+                    unsigned int candidates = __ballot_sync(FULL_MASK, d2 < bound);
+                    while (candidates)
+                    {
+                        const int src_lane = __ffs(candidates) - 1;
+                        candidates &= candidates - 1;
+
+                        const float candidate = __shfl_sync(FULL_MASK, d2, src_lane);
+                        if (active_lane == laneId)
+                            push(candidate, base + src_lane);
+                    }
+                }
+            }
+        }
+    };
+
     __global__ void KernelKNN(const Batch batch) 
     {           
         const int query_index = blockIdx.x * blockDim.x + threadIdx.x;
@@ -270,10 +486,29 @@ namespace pcl { namespace device { namespace knn_search
         search.launch(active); 
     }
 
+    __global__ void KernelKNNK(const Batch batch, const int k) 
+    {           
+        // k distances followed by k indices for each thread of the block
+        extern __shared__ float heap_storage[];
+
+        const int query_index = blockIdx.x * blockDim.x + threadIdx.x;
+                                
+        const bool active = query_index < batch.queries_num;
+
+        if (__all_sync(0xFFFFFFFF, active == false)) 
+            return;
+
+        float* heap_sqr_dists = heap_storage + threadIdx.x;
+        int* heap_indices = reinterpret_cast<int*>(heap_storage + KernelPolicyK::CTA_SIZE * k) + threadIdx.x;
+
+        Warp_knnSearchK search(batch, k, query_index, heap_sqr_dists, heap_indices);
+        search.launch(active); 
+    }
+
 } } }
 
 
-void pcl::device::OctreeImpl::nearestKSearchBatch(const Queries& queries, int /*k*/, NeighborIndices& results, BatchResultSqrDists& sqr_distances) const
+void pcl::device::OctreeImpl::nearestKSearchBatch(const Queries& queries, int k, NeighborIndices& results, BatchResultSqrDists& sqr_distances) const
 {              
     using BatchType = pcl::device::knn_search::Batch;
 
@@ -291,12 +526,26 @@ void pcl::device::OctreeImpl::nearestKSearchBatch(const Queries& queries, int /*
     batch.points = points_sorted;
     batch.points_step = points_sorted.step()/points_sorted.elem_size;
 
-    cudaSafeCall( cudaFuncSetCacheConfig(pcl::device::knn_search::KernelKNN, cudaFuncCachePreferL1) );    
+    if (k == 1)
+    {
+        cudaSafeCall( cudaFuncSetCacheConfig(pcl::device::knn_search::KernelKNN, cudaFuncCachePreferL1) );    
 
-    int block = pcl::device::knn_search::KernelPolicy::CTA_SIZE;
-    int grid = (batch.queries_num + block - 1) / block;        
+        int block = pcl::device::knn_search::KernelPolicy::CTA_SIZE;
+        int grid = (batch.queries_num + block - 1) / block;        
 
-    pcl::device::knn_search::KernelKNN<<<grid, block>>>(batch);
+        pcl::device::knn_search::KernelKNN<<<grid, block>>>(batch);
+    }
+    else
+    {
+        // the heaps live in shared memory, which is preferred over L1
+        cudaSafeCall( cudaFuncSetCacheConfig(pcl::device::knn_search::KernelKNNK, cudaFuncCachePreferShared) );    
+
+        int block = pcl::device::knn_search::KernelPolicyK::CTA_SIZE;
+        int grid = (batch.queries_num + block - 1) / block;        
+        std::size_t smem = block * k * (sizeof(float) + sizeof(int));
+
+        pcl::device::knn_search::KernelKNNK<<<grid, block, smem>>>(batch, k);
+    }
     cudaSafeCall( cudaGetLastError() );
     cudaSafeCall( cudaDeviceSynchronize() );
 }
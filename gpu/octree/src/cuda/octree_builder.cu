@@ -49,6 +49,11 @@
 #include <thrust/sort.h>
 #include <thrust/reduce.h>
 #include <thrust/device_ptr.h>
+#include <thrust/copy.h>
+#include <thrust/merge.h>
+#include <thrust/scan.h>
+#include <thrust/scatter.h>
+#include <thrust/system/cuda/execution_policy.h>
 
 using namespace pcl::gpu;
 using namespace thrust;
@@ -286,54 +291,113 @@ namespace pcl
     }
 }
 
-void pcl::device::OctreeImpl::build()
+namespace pcl
+{
+    namespace device
+    {
+        struct OutsideBox
+        {
+            float3 minp, maxp;
+
+            __device__ __forceinline__ int operator()(const thrust::tuple<float, float, float>& p) const
+            {
+                const float x = p.get<0>(), y = p.get<1>(), z = p.get<2>();
+                return (x < minp.x || y < minp.y || z < minp.z || x > maxp.x || y > maxp.y || z > maxp.z) ? 1 : 0;
+            }
+        };
+
+        struct IsSet
+        {
+            __device__ __forceinline__ bool operator()(int flag) const { return flag != 0; }
+        };
+    }
+}
+
+void pcl::device::OctreeImpl::allocateStorage(int points_num)
+{
+    //ScopeTimer timer("new_allocs"); 
+    //+1 codes               * points_num * sizeof(int)
+    //+1 indices             * points_num * sizeof(int)
+    //+1 octreeGlobal.nodes  * points_num * sizeof(int)
+
+    //+1 octreeGlobal.codes  * points_num * sizeof(int)
+    //+1 octreeGlobal.begs   * points_num * sizeof(int)
+    //+1 octreeGlobal.ends   * points_num * sizeof(int)
+
+    //+1 octreeGlobal.parent * points_num * sizeof(int)
+
+    //+3 points_sorted       * points_num * sizeof(float)
+    //==
+    // 10 rows   
+
+    //left 
+    //octreeGlobal.nodes_num * 1 * sizeof(int)          
+    //==
+    // 3 * sizeof(int) => +1 row        
+
+    const int transaction_size = 128 / sizeof(int);
+    int cols = max<int>(points_num, transaction_size * 4);
+    int rows = 10 + 1; // = 13
+        
+    storage.create(rows, cols);
+    
+    codes   = DeviceArray<int>(storage.ptr(0), points_num);
+    indices = DeviceArray<int>(storage.ptr(1), points_num);
+    
+    octreeGlobal.nodes   = storage.ptr(2);
+    octreeGlobal.codes   = storage.ptr(3);
+    octreeGlobal.begs    = storage.ptr(4);
+    octreeGlobal.ends    = storage.ptr(5);
+    octreeGlobal.parent  = storage.ptr(6);
+
+    octreeGlobal.nodes_num = storage.ptr(7);
+
+    points_sorted = DeviceArray2D<float>(3, points_num, storage.ptr(8), storage.step());
+}
+
+void pcl::device::OctreeImpl::permuteSortedPoints(cudaStream_t stream)
+{
+    device_ptr<PointType> beg(points.ptr());
+    device_ptr<PointType> end = beg + points.size();
+
+    device_ptr<int> indices_beg(indices.ptr());
+    device_ptr<int> indices_end = indices_beg + indices.size();
+
+    device_ptr<float> xs(points_sorted.ptr(0));
+    device_ptr<float> ys(points_sorted.ptr(1));
+    device_ptr<float> zs(points_sorted.ptr(2));
+    //ScopeTimer timer("perm2"); 
+    thrust::transform(thrust::cuda::par.on(stream),
+                      make_permutation_iterator(beg, indices_beg),
+                      make_permutation_iterator(end, indices_end), 
+                      make_zip_iterator(make_tuple(xs, ys, zs)), PointType_to_tuple<PointType>());
+}
+
+void pcl::device::OctreeImpl::buildNodes(cudaStream_t stream)
+{
+    SingleStepBuild ssb;
+    ssb.octree = octreeGlobal;
+    ssb.codes  = codes;
+    ssb.points_number = (int)codes.size();
+    //printFuncAttrib(singleStepKernel);
+
+    cudaSafeCall( cudaFuncSetCacheConfig(singleStepKernel, cudaFuncCachePreferL1) );
+
+    singleStepKernel<<<GRID_SIZE, CTA_SIZE, 0, stream>>>(ssb);
+    cudaSafeCall( cudaGetLastError() );
+
+    if (stream == 0)
+        cudaSafeCall( cudaDeviceSynchronize() );
+}
+
+void pcl::device::OctreeImpl::build(cudaStream_t stream)
 {       
     using namespace pcl::device;
     host_octree.downloaded = false;
 
     int points_num = (int)points.size();
 
-    //allocatations
-    {
-        //ScopeTimer timer("new_allocs"); 
-        //+1 codes               * points_num * sizeof(int)
-        //+1 indices             * points_num * sizeof(int)
-        //+1 octreeGlobal.nodes  * points_num * sizeof(int)
-
-        //+1 octreeGlobal.codes  * points_num * sizeof(int)
-        //+1 octreeGlobal.begs   * points_num * sizeof(int)
-        //+1 octreeGlobal.ends   * points_num * sizeof(int)
-
-        //+1 octreeGlobal.parent * points_num * sizeof(int)
-
-        //+3 points_sorted       * points_num * sizeof(float)
-        //==
-        // 10 rows   
-
-        //left 
-        //octreeGlobal.nodes_num * 1 * sizeof(int)          
-        //==
-        // 3 * sizeof(int) => +1 row        
-
-        const int transaction_size = 128 / sizeof(int);
-        int cols = max<int>(points_num, transaction_size * 4);
-        int rows = 10 + 1; // = 13
-            
-        storage.create(rows, cols);
-        
-        codes   = DeviceArray<int>(storage.ptr(0), points_num);
-        indices = DeviceArray<int>(storage.ptr(1), points_num);
-        
-        octreeGlobal.nodes   = storage.ptr(2);
-        octreeGlobal.codes   = storage.ptr(3);
-        octreeGlobal.begs    = storage.ptr(4);
-        octreeGlobal.ends    = storage.ptr(5);
-        octreeGlobal.parent  = storage.ptr(6);
-
-        octreeGlobal.nodes_num = storage.ptr(7);
-
-        points_sorted = DeviceArray2D<float>(3, points_num, storage.ptr(8), storage.step());
-    }
+    allocateStorage(points_num);
     
     {
         //ScopeTimer timer("reduce-morton-sort-permutations"); 
@@ -348,8 +412,8 @@ void pcl::device::OctreeImpl::build()
             atmax.w = atmin.w = 0;
 
             //ScopeTimer timer("reduce"); 
-            PointType minp = thrust::reduce(beg, end, atmax, SelectMinPoint<PointType>());
-            PointType maxp = thrust::reduce(beg, end, atmin, SelectMaxPoint<PointType>());
+            PointType minp = thrust::reduce(thrust::cuda::par.on(stream), beg, end, atmax, SelectMinPoint<PointType>());
+            PointType maxp = thrust::reduce(thrust::cuda::par.on(stream), beg, end, atmin, SelectMaxPoint<PointType>());
 
             octreeGlobal.minp = make_float3(minp.x, minp.y, minp.z);
             octreeGlobal.maxp = make_float3(maxp.x, maxp.y, maxp.z);
@@ -359,46 +423,156 @@ void pcl::device::OctreeImpl::build()
         device_ptr<int> codes_end = codes_beg + codes.size();
         {
             //ScopeTimer timer("morton"); 
-	        thrust::transform(beg, end, codes_beg, CalcMorton(octreeGlobal.minp, octreeGlobal.maxp));
+	        thrust::transform(thrust::cuda::par.on(stream), beg, end, codes_beg, CalcMorton(octreeGlobal.minp, octreeGlobal.maxp));
         }
 
         device_ptr<int> indices_beg(indices.ptr());
         device_ptr<int> indices_end = indices_beg + indices.size();
         {
             //ScopeTimer timer("sort"); 
-            thrust::sequence(indices_beg, indices_end);
-            thrust::sort_by_key(codes_beg, codes_end, indices_beg );		
+            thrust::sequence(thrust::cuda::par.on(stream), indices_beg, indices_end);
+            thrust::sort_by_key(thrust::cuda::par.on(stream), codes_beg, codes_end, indices_beg );		
         }
-        {
-            ////ScopeTimer timer("perm"); 
-            //thrust::copy(make_permutation_iterator(beg, indices_beg),
-            //                  make_permutation_iterator(end, indices_end), device_ptr<float3>(points_sorted.ptr()));    
 
-             
-        }
+        permuteSortedPoints(stream);
+    }
+    
+    buildNodes(stream);
+}
 
-        {
-            device_ptr<float> xs(points_sorted.ptr(0));
-            device_ptr<float> ys(points_sorted.ptr(1));
-            device_ptr<float> zs(points_sorted.ptr(2));
-            //ScopeTimer timer("perm2"); 
-            thrust::transform(make_permutation_iterator(beg, indices_beg),
-                              make_permutation_iterator(end, indices_end), 
-                              make_zip_iterator(make_tuple(xs, ys, zs)), PointType_to_tuple<PointType>());
+void pcl::device::OctreeImpl::insert(const PointCloud& new_points)
+{
+    const int old_num = (int)points.size();
+    const int new_num = (int)new_points.size();
 
-        
-        }
+    if (new_num == 0)
+        return;
+
+    device_ptr<PointType> new_beg(const_cast<PointType*>(new_points.ptr()));
+    device_ptr<PointType> new_end = new_beg + new_num;
+
+    // the octree owns its points from now on, the inserted ones are appended
+    PointArray all_points(old_num + new_num);
+    device_ptr<PointType> all_beg(all_points.ptr());
+    thrust::copy(device_ptr<PointType>(points.ptr()), device_ptr<PointType>(points.ptr()) + old_num, all_beg);
+    thrust::copy(new_beg, new_end, all_beg + old_num);
+
+    bool inside_box = old_num > 0;
+    if (inside_box)
+    {
+        PointType atmax, atmin;
+        atmax.x = atmax.y = atmax.z = FLT_MAX;
+        atmin.x = atmin.y = atmin.z = -FLT_MAX;
+        atmax.w = atmin.w = 0;
+
+        PointType minp = thrust::reduce(new_beg, new_end, atmax, SelectMinPoint<PointType>());
+        PointType maxp = thrust::reduce(new_beg, new_end, atmin, SelectMaxPoint<PointType>());
+
+        inside_box = minp.x >= octreeGlobal.minp.x && minp.y >= octreeGlobal.minp.y && minp.z >= octreeGlobal.minp.z &&
+                     maxp.x <= octreeGlobal.maxp.x && maxp.y <= octreeGlobal.maxp.y && maxp.z <= octreeGlobal.maxp.z;
     }
-    
-    SingleStepBuild ssb;
-    ssb.octree = octreeGlobal;
-    ssb.codes  = codes;
-    ssb.points_number = (int)codes.size();
-    //printFuncAttrib(singleStepKernel);
 
-    cudaSafeCall( cudaFuncSetCacheConfig(singleStepKernel, cudaFuncCachePreferL1) );
+    points = all_points;
 
-    singleStepKernel<<<GRID_SIZE, CTA_SIZE>>>(ssb);
-    cudaSafeCall( cudaGetLastError() );
-    cudaSafeCall( cudaDeviceSynchronize() );
+    // Morton codes are relative to the bounding box, so growing it invalidates all of them
+    if (!inside_box)
+    {
+        build();
+        return;
+    }
+
+    host_octree.downloaded = false;
+
+    // sort only the keys of the new points
+    DeviceArray<int> new_codes(new_num);
+    DeviceArray<int> new_indices(new_num);
+
+    device_ptr<int> new_codes_beg(new_codes.ptr());
+    device_ptr<int> new_indices_beg(new_indices.ptr());
+
+    thrust::transform(new_beg, new_end, new_codes_beg, CalcMorton(octreeGlobal.minp, octreeGlobal.maxp));
+    thrust::sequence(new_indices_beg, new_indices_beg + new_num, old_num);
+    thrust::sort_by_key(new_codes_beg, new_codes_beg + new_num, new_indices_beg);
+
+    // keep the old sorted keys alive while they are merged into the new storage
+    DeviceArray2D<int> old_storage = storage;
+    device_ptr<int> old_codes_beg(codes.ptr());
+    device_ptr<int> old_indices_beg(indices.ptr());
+
+    storage = DeviceArray2D<int>();
+    allocateStorage(old_num + new_num);
+
+    thrust::merge_by_key(old_codes_beg, old_codes_beg + old_num, new_codes_beg, new_codes_beg + new_num,
+                         old_indices_beg, new_indices_beg,
+                         device_ptr<int>(codes.ptr()), device_ptr<int>(indices.ptr()));
+
+    old_storage.release();
+
+    permuteSortedPoints();
+    buildNodes();
+}
+
+void pcl::device::OctreeImpl::remove(const float3& box_min, const float3& box_max)
+{
+    const int old_num = (int)points.size();
+
+    if (old_num == 0)
+        return;
+
+    // flags of the kept entries in Morton order
+    DeviceArray<int> keep(old_num);
+    device_ptr<int> keep_beg(keep.ptr());
+
+    device_ptr<float> xs(points_sorted.ptr(0));
+    device_ptr<float> ys(points_sorted.ptr(1));
+    device_ptr<float> zs(points_sorted.ptr(2));
+
+    OutsideBox outside;
+    outside.minp = box_min;
+    outside.maxp = box_max;
+    thrust::transform(make_zip_iterator(make_tuple(xs, ys, zs)), make_zip_iterator(make_tuple(xs + old_num, ys + old_num, zs + old_num)),
+                      keep_beg, outside);
+
+    const int new_num = thrust::reduce(keep_beg, keep_beg + old_num);
+    if (new_num == old_num)
+        return;
+
+    host_octree.downloaded = false;
+
+    // flags in point order, their exclusive scan maps old point indices to compacted ones
+    DeviceArray<int> keep_point(old_num);
+    DeviceArray<int> new_index(old_num);
+    device_ptr<int> keep_point_beg(keep_point.ptr());
+    device_ptr<int> new_index_beg(new_index.ptr());
+
+    device_ptr<int> old_codes_beg(codes.ptr());
+    device_ptr<int> old_indices_beg(indices.ptr());
+
+    thrust::scatter(keep_beg, keep_beg + old_num, old_indices_beg, keep_point_beg);
+    thrust::exclusive_scan(keep_point_beg, keep_point_beg + old_num, new_index_beg);
+
+    PointArray kept_points(new_num);
+    device_ptr<PointType> points_beg(points.ptr());
+    thrust::copy_if(points_beg, points_beg + old_num, keep_point_beg, device_ptr<PointType>(kept_points.ptr()), IsSet());
+
+    // compaction keeps the codes sorted, only the point indices have to be renumbered
+    DeviceArray2D<int> old_storage = storage;
+
+    storage = DeviceArray2D<int>();
+    allocateStorage(new_num);
+
+    device_ptr<int> codes_beg(codes.ptr());
+    device_ptr<int> indices_beg(indices.ptr());
+
+    thrust::copy_if(old_codes_beg, old_codes_beg + old_num, keep_beg, codes_beg, IsSet());
+    thrust::copy_if(make_permutation_iterator(new_index_beg, old_indices_beg),
+                    make_permutation_iterator(new_index_beg, old_indices_beg + old_num),
+                    keep_beg, indices_beg, IsSet());
+
+    old_storage.release();
+
+    points = kept_points;
+
+    permuteSortedPoints();
+    buildNodes();
 }
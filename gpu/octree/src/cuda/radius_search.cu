@@ -331,7 +331,7 @@ namespace pcl
 }
 
 template<typename BatchType>
-void pcl::device::OctreeImpl::radiusSearchEx(BatchType& batch, const Queries& queries, NeighborIndices& results)
+void pcl::device::OctreeImpl::radiusSearchEx(BatchType& batch, const Queries& queries, NeighborIndices& results, cudaStream_t stream)
 {
     batch.indices = indices;
     batch.octree = octreeGlobal;
@@ -348,33 +348,35 @@ void pcl::device::OctreeImpl::radiusSearchEx(BatchType& batch, const Queries& qu
     int block = KernelPolicy::CTA_SIZE;
     int grid = divUp((int)batch.queries.size, block);
 
-    KernelRS<<<grid, block>>>(batch);
+    KernelRS<<<grid, block, 0, stream>>>(batch);
     cudaSafeCall( cudaGetLastError() );
-    cudaSafeCall( cudaDeviceSynchronize() );
+
+    if (stream == 0)
+        cudaSafeCall( cudaDeviceSynchronize() );
 }
 
 
-void pcl::device::OctreeImpl::radiusSearch(const Queries& queries, float radius, NeighborIndices& results)
+void pcl::device::OctreeImpl::radiusSearch(const Queries& queries, float radius, NeighborIndices& results, cudaStream_t stream)
 {        
     using BatchType = Batch<SharedRadius, DirectQuery>;
 
     BatchType batch;
     batch.radius = radius;
     batch.queries = queries;
-    radiusSearchEx(batch, queries, results);              
+    radiusSearchEx(batch, queries, results, stream);              
 }
 
-void pcl::device::OctreeImpl::radiusSearch(const Queries& queries, const Radiuses& radiuses, NeighborIndices& results)
+void pcl::device::OctreeImpl::radiusSearch(const Queries& queries, const Radiuses& radiuses, NeighborIndices& results, cudaStream_t stream)
 {
     using BatchType = Batch<IndividualRadius, DirectQuery>;
 
     BatchType batch;
     batch.radiuses = radiuses;
     batch.queries = queries;
-    radiusSearchEx(batch, queries, results);              
+    radiusSearchEx(batch, queries, results, stream);              
 }
 
-void pcl::device::OctreeImpl::radiusSearch(const Queries& queries, const Indices& indices, float radius, NeighborIndices& results)
+void pcl::device::OctreeImpl::radiusSearch(const Queries& queries, const Indices& indices, float radius, NeighborIndices& results, cudaStream_t stream)
 {
     using BatchType = Batch<SharedRadius, IndicesQuery>;
 
@@ -385,5 +387,5 @@ void pcl::device::OctreeImpl::radiusSearch(const Queries& queries, const Indices
     batch.queries_indices = indices;
     batch.queries.size = indices.size();
 
-    radiusSearchEx(batch, queries, results);        
+    radiusSearchEx(batch, queries, results, stream);        
 }
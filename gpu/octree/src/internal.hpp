@@ -82,20 +82,28 @@ namespace pcl
 
             using NeighborIndices = pcl::gpu::NeighborIndices;
 
+            /** \brief Largest k of nearestKSearchBatch, bounded by the shared memory of the k-NN kernel. */
+            enum { MAX_KNN = 64 };
+
             static void get_gpu_arch_compiled_for(int& bin, int& ptr);
 
             OctreeImpl() {};
             ~OctreeImpl() {};
 
             void setCloud(const PointCloud& input_points);           
-            void build();
+            void build(cudaStream_t stream = 0);
+
+            /** \brief Appends points, merging their sorted Morton codes into the existing ones. */
+            void insert(const PointCloud& new_points);
+            /** \brief Removes the points inside an axis aligned box, compacting the sorted arrays. */
+            void remove(const float3& box_min, const float3& box_max);
             void radiusSearchHost(const PointType& center, float radius, std::vector<int>& out, int max_nn) const;
             void approxNearestSearchHost(const PointType& query, int& out_index, float& sqr_dist) const;
             
-            void radiusSearch(const Queries& queries, float radius, NeighborIndices& results);
-            void radiusSearch(const Queries& queries, const Radiuses& radiuses, NeighborIndices& results);
+            void radiusSearch(const Queries& queries, float radius, NeighborIndices& results, cudaStream_t stream = 0);
+            void radiusSearch(const Queries& queries, const Radiuses& radiuses, NeighborIndices& results, cudaStream_t stream = 0);
 
-            void radiusSearch(const Queries& queries, const Indices& indices, float radius, NeighborIndices& results);
+            void radiusSearch(const Queries& queries, const Indices& indices, float radius, NeighborIndices& results, cudaStream_t stream = 0);
 
             void approxNearestSearch(const Queries& queries, NeighborIndices& results, BatchResultSqrDists& sqr_distance) const;
             
@@ -135,8 +143,12 @@ namespace pcl
                         
             void internalDownload(); 
         private:
+            void allocateStorage(int points_num);
+            void permuteSortedPoints(cudaStream_t stream = 0);
+            void buildNodes(cudaStream_t stream = 0);
+
             template<typename BatchType>
-            void radiusSearchEx(BatchType& batch, const Queries& queries, NeighborIndices& results);
+            void radiusSearchEx(BatchType& batch, const Queries& queries, NeighborIndices& results, cudaStream_t stream);
         };
 
         void bruteForceRadiusSearch(const OctreeImpl::PointCloud& cloud, const OctreeImpl::PointType& query, float radius, DeviceArray<int>& result, DeviceArray<int>& buffer);
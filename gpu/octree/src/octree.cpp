@@ -101,6 +101,27 @@ void pcl::gpu::Octree::build()
     built_ = true;
 }
 
+void pcl::gpu::Octree::build(Stream& stream)
+{
+    static_cast<OctreeImpl*>(impl)->build(static_cast<cudaStream_t>(stream.handle()));
+    built_ = true;
+}
+
+void pcl::gpu::Octree::insert(const PointCloud& points)
+{
+    OctreeImpl* octree = static_cast<OctreeImpl*>(impl);
+    octree->insert((const OctreeImpl::PointCloud&)points);
+    cloud_ = (const PointCloud*)&octree->points;
+    built_ = true;
+}
+
+void pcl::gpu::Octree::remove(const PointType& min_pt, const PointType& max_pt)
+{
+    OctreeImpl* octree = static_cast<OctreeImpl*>(impl);
+    octree->remove(make_float3(min_pt.x, min_pt.y, min_pt.z), make_float3(max_pt.x, max_pt.y, max_pt.z));
+    cloud_ = (const PointCloud*)&octree->points;
+}
+
 bool pcl::gpu::Octree::isBuilt() const
 {
     return built_;
@@ -139,13 +160,18 @@ void  pcl::gpu::Octree::approxNearestSearchHost(const PointType& query, int& out
 }
                         
 void pcl::gpu::Octree::radiusSearch(const Queries& queries, float radius, int max_results, NeighborIndices& results) const
+{
+    radiusSearch(queries, radius, max_results, results, Stream::Null());
+}
+
+void pcl::gpu::Octree::radiusSearch(const Queries& queries, float radius, int max_results, NeighborIndices& results, Stream& stream) const
 {
     assert(queries.size() > 0);
     results.create(static_cast<int> (queries.size()), max_results);
     results.sizes.create(queries.size());
     
     const OctreeImpl::Queries& q = (const OctreeImpl::Queries&)queries;
-    static_cast<OctreeImpl*>(impl)->radiusSearch(q, radius, results);
+    static_cast<OctreeImpl*>(impl)->radiusSearch(q, radius, results, static_cast<cudaStream_t>(stream.handle()));
 }
 
 void pcl::gpu::Octree::radiusSearch(const Queries& queries, const Radiuses& radiuses, int max_results, NeighborIndices& results) const
@@ -160,13 +186,18 @@ void pcl::gpu::Octree::radiusSearch(const Queries& queries, const Radiuses& radi
 }
 
 void pcl::gpu::Octree::radiusSearch(const Queries& queries, const Indices& indices, float radius, int max_results, NeighborIndices& results) const
+{
+    radiusSearch(queries, indices, radius, max_results, results, Stream::Null());
+}
+
+void pcl::gpu::Octree::radiusSearch(const Queries& queries, const Indices& indices, float radius, int max_results, NeighborIndices& results, Stream& stream) const
 {
     assert(queries.size() > 0 && indices.size() > 0);
     results.create(static_cast<int> (indices.size()), max_results);
     results.sizes.create(indices.size());
     
     const OctreeImpl::Queries& q = (const OctreeImpl::Queries&)queries;
-    static_cast<OctreeImpl*>(impl)->radiusSearch(q, indices, radius, results);
+    static_cast<OctreeImpl*>(impl)->radiusSearch(q, indices, radius, results, static_cast<cudaStream_t>(stream.handle()));
 }
 
 void pcl::gpu::Octree::approxNearestSearch(const Queries& queries, NeighborIndices& results) const
@@ -193,8 +224,8 @@ void pcl::gpu::Octree::nearestKSearchBatch(const Queries& queries, int k, Neighb
 
 void pcl::gpu::Octree::nearestKSearchBatch(const Queries& queries, int k, NeighborIndices& results, ResultSqrDists& sqr_distances) const
 {    
-    if (k != 1)
-        throw pcl::PCLException("OctreeGPU::knnSearch is supported only for k == 1", __FILE__, "", __LINE__);
+    if (k < 1 || k > OctreeImpl::MAX_KNN)
+        throw pcl::PCLException("OctreeGPU::knnSearch is supported only for 1 <= k <= 64", __FILE__, "", __LINE__);
     
     assert(queries.size() > 0);
     results.create(static_cast<int> (queries.size()), k);	    
@@ -0,0 +1,239 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2019-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <pcl/gpu/octree/octree_search.hpp>
+#include <pcl/common/point_tests.h> // for pcl::isFinite
+#include <pcl/console/print.h>
+
+#include "internal.hpp"
+
+#include <algorithm>
+#include <climits>
+#include <numeric>
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////
+pcl::gpu::OctreeSearch::OctreeSearch (bool sorted_results)
+  : BaseClass ("OctreeGPU", sorted_results)
+  , octree_ (new Octree)
+{
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////
+void
+pcl::gpu::OctreeSearch::setInputCloud (const PointCloudConstPtr& cloud, const IndicesConstPtr& indices)
+{
+  BaseClass::setInputCloud (cloud, indices);
+
+  // Only finite points can be sorted into the octree
+  std::vector<PointType> points;
+  point_indices_.clear ();
+  const std::size_t nr_points = (indices ? indices->size () : cloud->size ());
+  points.reserve (nr_points);
+  point_indices_.reserve (nr_points);
+  for (std::size_t i = 0; i < nr_points; ++i)
+  {
+    const index_t index = (indices ? (*indices)[i] : static_cast<index_t> (i));
+    if (!pcl::isFinite ((*cloud)[index]))
+      continue;
+    points.push_back ((*cloud)[index]);
+    point_indices_.push_back (index);
+  }
+  if (points.empty ())
+    return;
+
+  points_device_.upload (points);
+  octree_->setCloud (points_device_);
+  octree_->build ();
+  // Download the host copy used by radiusSearch now, so that searches do not modify the octree
+  octree_->internalDownload ();
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////
+bool
+pcl::gpu::OctreeSearch::searchBatch (const std::vector<PointType>& queries, int k, std::vector<int>& neighbors,
+                                     std::vector<float>& sqr_distances, std::vector<int>& sizes) const
+{
+  if (k < 1 || k > pcl::device::OctreeImpl::MAX_KNN)
+  {
+    PCL_ERROR ("[pcl::%s::nearestKSearch] k has to be between 1 and %d, got %d.\n",
+               getName ().c_str (), static_cast<int> (pcl::device::OctreeImpl::MAX_KNN), k);
+    return (false);
+  }
+  if (point_indices_.empty () || queries.empty ())
+    return (false);
+
+  Octree::Queries queries_device;
+  queries_device.upload (queries);
+
+  NeighborIndices results;
+  Octree::ResultSqrDists sqr_distances_device;
+  octree_->nearestKSearchBatch (queries_device, k, results, sqr_distances_device);
+
+  results.data.download (neighbors);
+  sqr_distances_device.download (sqr_distances);
+  // For k == 1 there is always a neighbor, and no sizes
+  if (k == 1)
+    sizes.assign (queries.size (), 1);
+  else
+    results.sizes.download (sizes);
+  return (true);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////
+int
+pcl::gpu::OctreeSearch::nearestKSearch (const PointType& point, int k, Indices& k_indices,
+                                        std::vector<float>& k_sqr_distances) const
+{
+  k_indices.clear ();
+  k_sqr_distances.clear ();
+  if (!pcl::isFinite (point))
+    return (0);
+
+  std::vector<int> neighbors, sizes;
+  std::vector<float> sqr_distances;
+  if (!searchBatch (std::vector<PointType> (1, point), k, neighbors, sqr_distances, sizes))
+    return (0);
+
+  const int nr_found = sizes[0];
+  k_indices.resize (nr_found);
+  k_sqr_distances.assign (sqr_distances.begin (), sqr_distances.begin () + nr_found);
+  for (int i = 0; i < nr_found; ++i)
+    k_indices[i] = point_indices_[neighbors[i]];
+  return (nr_found);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////
+void
+pcl::gpu::OctreeSearch::nearestKSearch (const PointCloud& cloud, const Indices& indices, int k,
+                                        std::vector<Indices>& k_indices,
+                                        std::vector< std::vector<float> >& k_sqr_distances) const
+{
+  Indices flat_indices;
+  std::vector<float> flat_sqr_distances;
+  std::vector<std::size_t> offsets;
+  nearestKSearch (cloud, indices, k, flat_indices, flat_sqr_distances, offsets);
+
+  const std::size_t nr_queries = offsets.size () - 1;
+  k_indices.resize (nr_queries);
+  k_sqr_distances.resize (nr_queries);
+  for (std::size_t i = 0; i < nr_queries; ++i)
+  {
+    k_indices[i].assign (flat_indices.begin () + offsets[i], flat_indices.begin () + offsets[i + 1]);
+    k_sqr_distances[i].assign (flat_sqr_distances.begin () + offsets[i], flat_sqr_distances.begin () + offsets[i + 1]);
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////
+void
+pcl::gpu::OctreeSearch::nearestKSearch (const PointCloud& cloud, const Indices& indices, int k,
+                                        Indices& k_indices, std::vector<float>& k_sqr_distances,
+                                        std::vector<std::size_t>& offsets, unsigned int) const
+{
+  const std::size_t nr_queries = (indices.empty () ? cloud.size () : indices.size ());
+  offsets.assign (nr_queries + 1, 0);
+  k_indices.clear ();
+  k_sqr_distances.clear ();
+
+  // Query points that are not finite have no neighbors and are not uploaded
+  std::vector<PointType> queries;
+  std::vector<std::size_t> query_positions;
+  queries.reserve (nr_queries);
+  query_positions.reserve (nr_queries);
+  for (std::size_t i = 0; i < nr_queries; ++i)
+  {
+    const PointType& point = cloud[indices.empty () ? static_cast<index_t> (i) : indices[i]];
+    if (!pcl::isFinite (point))
+      continue;
+    queries.push_back (point);
+    query_positions.push_back (i);
+  }
+
+  std::vector<int> neighbors, sizes;
+  std::vector<float> sqr_distances;
+  if (!searchBatch (queries, k, neighbors, sqr_distances, sizes))
+    return;
+
+  // Turn the counts into offsets
+  for (std::size_t q = 0; q < queries.size (); ++q)
+    offsets[query_positions[q] + 1] = sizes[q];
+  std::partial_sum (offsets.begin (), offsets.end (), offsets.begin ());
+
+  k_indices.resize (offsets.back ());
+  k_sqr_distances.resize (offsets.back ());
+  for (std::size_t q = 0; q < queries.size (); ++q)
+  {
+    const std::size_t begin = offsets[query_positions[q]];
+    for (int i = 0; i < sizes[q]; ++i)
+    {
+      k_indices[begin + i] = point_indices_[neighbors[q * k + i]];
+      k_sqr_distances[begin + i] = sqr_distances[q * k + i];
+    }
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////
+int
+pcl::gpu::OctreeSearch::radiusSearch (const PointType& point, double radius, Indices& k_indices,
+                                      std::vector<float>& k_sqr_distances, unsigned int max_nn) const
+{
+  k_indices.clear ();
+  k_sqr_distances.clear ();
+  if (point_indices_.empty () || !pcl::isFinite (point))
+    return (0);
+
+  std::vector<int> neighbors;
+  const int max_results = (max_nn == 0 || max_nn > INT_MAX ? INT_MAX : static_cast<int> (max_nn));
+  octree_->radiusSearchHost (point, static_cast<float> (radius), neighbors, max_results);
+
+  std::vector<float> sqr_distances (neighbors.size ());
+  for (std::size_t i = 0; i < neighbors.size (); ++i)
+    sqr_distances[i] = ((*input_)[point_indices_[neighbors[i]]].getVector3fMap () - point.getVector3fMap ()).squaredNorm ();
+
+  std::vector<std::size_t> order (neighbors.size ());
+  std::iota (order.begin (), order.end (), 0);
+  if (sorted_results_)
+    std::sort (order.begin (), order.end (),
+               [&sqr_distances] (std::size_t a, std::size_t b) { return (sqr_distances[a] < sqr_distances[b]); });
+
+  k_indices.resize (neighbors.size ());
+  k_sqr_distances.resize (neighbors.size ());
+  for (std::size_t i = 0; i < order.size (); ++i)
+  {
+    k_indices[i] = point_indices_[neighbors[order[i]]];
+    k_sqr_distances[i] = sqr_distances[order[i]];
+  }
+  return (static_cast<int> (k_indices.size ()));
+}
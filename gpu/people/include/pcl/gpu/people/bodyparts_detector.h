@@ -46,6 +46,7 @@
 #include <pcl/gpu/people/label_common.h>
 #include "pcl/gpu/people/person_attribs.h"
 
+#include <mutex>
 #include <string>
 #include <vector>
 
@@ -76,10 +77,33 @@ namespace pcl
           RDFBodyPartsDetector(const std::vector<std::string>& tree_files,
               int default_buffer_rows = 480, int default_buffer_cols = 640);
 
+          /**
+           * \brief Creates a detector that shares the trees of other but has buffers of its own, so that several
+           * frames can be processed at once. The evaluation of the shared trees is serialized.
+           */
+          RDFBodyPartsDetector(const RDFBodyPartsDetector& other, int buffer_rows, int buffer_cols);
+
           /**
            * \brief This function does the complete RDF evaluation in a discrete manner and builds the blob matrix
            */
           void process(const Depth& depth, const PointCloud<PointXYZ>& cloud, int min_pts_per_cluster);
+
+          /**
+           * \brief Same as process, but the blobs are extracted on the device from the device copy of the cloud
+           */
+          void process(const Depth& depth, const DeviceArray2D<PointXYZ>& cloud, int min_pts_per_cluster);
+
+          /**
+           * \brief Evaluates the RDF and enqueues the smoothing, the connected components and the blob extraction of
+           * a frame on the stream of this detector, then returns while these still run. The blob ids are downloaded
+           * asynchronously to page-locked memory. depth and cloud have to stay unchanged until collect() returned.
+           */
+          void enqueue(const Depth& depth, const DeviceArray2D<PointXYZ>& cloud, int min_pts_per_cluster);
+
+          /**
+           * \brief Waits for the frame given to enqueue() and builds the blob matrix from it, without the relations
+           */
+          void collect();
           // This are the different sub-parts of process()
           /**
            * \brief This function processes based on the RDF with probabilistic voting scheme
@@ -134,7 +158,13 @@ namespace pcl
           pcl::device::LabelProbability P_l_prev_2_;  // for the second iteration
 
         private:
+          struct AsyncBuffers;
+
           std::shared_ptr<device::MultiTreeLiveProc> impl_;
+          /** \brief Guards impl_, which holds the evaluation buffer of the trees **/
+          std::shared_ptr<std::mutex> impl_mutex_;
+          /** \brief Stream and buffers of the asynchronous blob extraction **/
+          std::shared_ptr<AsyncBuffers> async_;
 
           int max_cluster_size_;
           float cluster_tolerance_;
@@ -36,9 +36,12 @@
 
 #pragma once
 
+#include <deque>
 #include <iostream>
 #include <sstream>
 #include <fstream>
+#include <future>
+#include <vector>
 
 #include <pcl/point_types.h>
 #include <pcl/console/print.h>
@@ -83,8 +86,8 @@ namespace pcl
           /** \brief Class constructor. */
           PeopleDetector ();
           
-          /** \brief Class destructor. */
-          ~PeopleDetector () {}                   
+          /** \brief Class destructor, waits for the frames still in flight. */
+          ~PeopleDetector ();
 
           /** \brief User must set non standard intrinsics */
           void
@@ -99,6 +102,36 @@ namespace pcl
 
           int
           process (const Depth& depth, const Image& rgba);
+
+          /**
+           * \brief Pipelined version of process (depth, rgba). The frame is submitted and the call returns the result
+           * of the frame submitted getPipelineDepth () - 1 calls earlier, while the device already works on the new
+           * one and the host part of the frames in between runs on worker threads. When the call returns, the
+           * members holding the results, e.g. rdf_detector_, depth_device1_ and cloud_host_, belong to that earlier
+           * frame. depth and rgba are copied, the caller may reuse them at once.
+           * \return the result of process () for the earlier frame, -1 while the pipeline fills up
+           */
+          int
+          processPipelined (const Depth& depth, const Image& rgba);
+
+          /** \brief Waits for the oldest frame in flight of processPipelined and returns its result like
+            * processPipelined does, -1 if no frame is left
+            */
+          int
+          flushPipeline ();
+
+          /** \brief Set the number of frames in flight of processPipelined, between 1 and 3. Frames still in flight
+            * are waited for and their results dropped.
+            */
+          void
+          setPipelineDepth (int depth);
+
+          /** \brief Get the number of frames in flight of processPipelined, defaults to 2 */
+          inline int
+          getPipelineDepth () const
+          {
+            return (pipeline_depth_);
+          }
          
           /** \brief Set the tolerance for the delta on the Hue in Seeded Hue Segmentation step */
           inline void
@@ -144,6 +177,35 @@ namespace pcl
           Mask                        fg_mask_;
           Mask                        fg_mask_grown_;
 
+          /** \brief The buffers one frame is processed in. The members above form one as well, frames in flight
+            * of processPipelined each get their own and are swapped with the members once they are done.
+            */
+          struct PipelineFrame
+          {
+            using Ptr = shared_ptr<PipelineFrame>;
+
+            RDFBodyPartsDetector::Ptr   rdf_detector;
+            PointCloud<PointT>          cloud_host;
+            PointCloud<float>           hue_host;
+            PointCloud<unsigned char>   flowermat_host;
+            DeviceArray2D<PointT>       cloud_device;
+            Hue                         hue_device;
+            Depth                       depth_device1;
+            Depth                       depth_device2;
+            Mask                        fg_mask;
+            Mask                        fg_mask_grown;
+
+            std::future<int>            result;
+
+            PCL_MAKE_ALIGNED_OPERATOR_NEW
+          };
+
+          int                                 pipeline_depth_;
+          std::vector<PipelineFrame::Ptr>     pipeline_frames_;
+          std::size_t                         next_pipeline_frame_;
+          std::deque<PipelineFrame*>          frames_in_flight_;
+          PipelineFrame                       sync_frame_;
+
           int
           process ();
 
@@ -159,6 +221,22 @@ namespace pcl
           void 
           shs5 (const pcl::PointCloud<PointT> &cloud, const pcl::Indices& indices, unsigned char *mask);
 
+          void 
+          shs5 (const pcl::PointCloud<PointT> &cloud, const pcl::PointCloud<float> &hue, const pcl::Indices& indices, unsigned char *mask);
+
+        private:
+          /** \brief Uploads a frame and enqueues its first evaluation */
+          void
+          startFrame (PipelineFrame &frame, const Depth& depth, const Image& rgba);
+
+          /** \brief Builds the trees of a frame started before, runs the second evaluation if a neck was found */
+          int
+          detect (PipelineFrame &frame);
+
+          /** \brief Swaps the buffers of a frame with the members */
+          void
+          swapFrame (PipelineFrame &frame);
+
           //!!! only for debug purposes TODO: remove this. 
           friend class PeoplePCDApp;
       };
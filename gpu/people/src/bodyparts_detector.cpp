@@ -49,11 +49,28 @@
 #include "internal.h"
 #include "cuda_async_copy.h"
 
+#include <pcl/gpu/containers/stream.h>
+
 const int MAX_CLUST_SIZE = 25000;
 const float CLUST_TOL = 0.05f;
 
+struct pcl::gpu::people::RDFBodyPartsDetector::AsyncBuffers
+{
+  Stream stream;
+
+  DeviceArray<float4>             sums;
+  DeviceArray<int>                roots;
+  DeviceArray<device::BlobInfo>   blobs;
+  DeviceArray<int>                blobs_count;
+  DeviceArray2D<int>              blob_ids;
+
+  PinnedVector<int>               blob_ids_host;
+  PinnedVector<int>               blobs_count_host;
+  std::vector<device::BlobInfo>   blobs_host;
+};
+
 pcl::gpu::people::RDFBodyPartsDetector::RDFBodyPartsDetector( const std::vector<std::string>& tree_files, int rows, int cols)
-: max_cluster_size_(MAX_CLUST_SIZE), cluster_tolerance_(CLUST_TOL)
+: impl_mutex_(new std::mutex), async_(new AsyncBuffers), max_cluster_size_(MAX_CLUST_SIZE), cluster_tolerance_(CLUST_TOL)
 {
   PCL_DEBUG("[pcl::gpu::people::RDFBodyPartsDetector::RDFBodyPartsDetector] : (D) : Constructor called\n");
   //TODO replace all asserts with exceptions
@@ -75,6 +92,13 @@ pcl::gpu::people::RDFBodyPartsDetector::RDFBodyPartsDetector( const std::vector<
   allocate_buffers(rows, cols);
 }
 
+pcl::gpu::people::RDFBodyPartsDetector::RDFBodyPartsDetector(const RDFBodyPartsDetector& other, int rows, int cols)
+: impl_(other.impl_), impl_mutex_(other.impl_mutex_), async_(new AsyncBuffers),
+  max_cluster_size_(other.max_cluster_size_), cluster_tolerance_(other.cluster_tolerance_)
+{
+  allocate_buffers(rows, cols);
+}
+
 ////////////////////////////////////////////////////////////////////////////////////
 /// getters
 
@@ -178,7 +202,10 @@ pcl::gpu::people::RDFBodyPartsDetector::process (const pcl::device::Depth& depth
     {
       //ScopeTime time("--");
       // Process the depthimage (CUDA)
-      impl_->process(depth, labels_);
+      {
+        std::lock_guard<std::mutex> lock(*impl_mutex_);
+        impl_->process(depth, labels_);
+      }
       device::smoothLabelImage(labels_, depth, labels_smoothed_, NUM_PARTS, 5, 300);
     }
 
@@ -258,6 +285,98 @@ pcl::gpu::people::RDFBodyPartsDetector::process (const pcl::device::Depth& depth
   }
 }
 
+void
+pcl::gpu::people::RDFBodyPartsDetector::process (const pcl::device::Depth& depth, const DeviceArray2D<PointXYZ>& cloud, int min_pts_per_cluster)
+{
+  enqueue(depth, cloud, min_pts_per_cluster);
+  collect();
+  buildRelations ( blob_matrix_ );
+}
+
+void
+pcl::gpu::people::RDFBodyPartsDetector::enqueue (const pcl::device::Depth& depth, const DeviceArray2D<PointXYZ>& cloud, int min_pts_per_cluster)
+{
+  int cols = depth.cols();
+  int rows = depth.rows();
+
+  allocate_buffers(rows, cols);
+
+  // The trees are evaluated through texture references, which are global, so this part stays synchronous
+  // and runs for one detector at a time. It also waits for the work still enqueued on our stream.
+  {
+    std::lock_guard<std::mutex> lock(*impl_mutex_);
+    impl_->process(depth, labels_);
+  }
+
+  cudaStream_t stream = static_cast<cudaStream_t>(async_->stream.handle());
+
+  device::smoothLabelImage(labels_, depth, labels_smoothed_, NUM_PARTS, 5, 300, stream);
+
+  // cc = generalized floodfill = approximation of euclidian clusterisation
+  device::ConnectedComponents::computeEdges(labels_smoothed_, depth, NUM_PARTS, cluster_tolerance_ * cluster_tolerance_, edges_, stream);
+  device::ConnectedComponents::labelComponents(edges_, comps_, stream);
+
+  const device::Cloud& c = (const device::Cloud&)cloud;
+  device::extractBlobs(comps_, labels_smoothed_, c, min_pts_per_cluster, max_cluster_size_,
+                       async_->sums, async_->roots, async_->blobs, async_->blobs_count, async_->blob_ids, stream);
+
+  async_->blob_ids_host.resize(rows * cols);
+  cudaSafeCall( cudaMemcpy2DAsync(async_->blob_ids_host.data(), cols * sizeof(int), async_->blob_ids.ptr(), async_->blob_ids.step(),
+                                  async_->blob_ids.colsBytes(), rows, cudaMemcpyDeviceToHost, stream) );
+  async_->blobs_count.downloadAsync(async_->blobs_count_host, async_->stream);
+}
+
+void
+pcl::gpu::people::RDFBodyPartsDetector::collect ()
+{
+  async_->stream.waitForCompletion();
+
+  int blobs_count = async_->blobs_count_host[0];
+  async_->blobs_host.resize(blobs_count);
+  if (blobs_count > 0)
+    async_->blobs.download(async_->blobs_host.data(), 0, blobs_count);
+
+  for(auto &matrix : blob_matrix_)
+    matrix.clear();
+
+  // The blobs come in no particular order from the device, they are added to the blob matrix in the
+  // order of their first pixel, like the host version does
+  std::fill(remap_.begin(), remap_.begin() + blobs_count, -1);
+
+  const int* blob_ids = async_->blob_ids_host.data();
+  for(std::size_t k = 0; k < async_->blob_ids_host.size(); ++k)
+  {
+    int blob = blob_ids[k];
+    if (blob < 0)
+      continue;
+
+    const device::BlobInfo& info = async_->blobs_host[blob];
+    int label = info.label;
+    int ccindex = remap_[blob];
+    if (ccindex == -1)
+    {
+      ccindex = static_cast<int> (blob_matrix_[label].size ());
+      blob_matrix_[label].resize(ccindex + 1);
+      remap_[blob] = ccindex;
+
+      blob_matrix_[label][ccindex].label = static_cast<part_t> (label);
+      blob_matrix_[label][ccindex].mean.coeffRef(0) = info.mean.x;
+      blob_matrix_[label][ccindex].mean.coeffRef(1) = info.mean.y;
+      blob_matrix_[label][ccindex].mean.coeffRef(2) = info.mean.z;
+      blob_matrix_[label][ccindex].indices.indices.reserve(info.size);
+    }
+    blob_matrix_[label][ccindex].indices.indices.push_back(static_cast<int> (k));
+  }
+
+  int id = 0;
+  for(auto &matrix : blob_matrix_)
+    for(std::size_t b = 0; b < matrix.size(); ++b)
+    {
+      matrix[b].id = id++;
+      matrix[b].lid = static_cast<int> (b);
+    }
+}
+
 void
 pcl::gpu::people::RDFBodyPartsDetector::processProb (const pcl::device::Depth& depth)
 {
@@ -269,6 +388,7 @@ pcl::gpu::people::RDFBodyPartsDetector::processProb (const pcl::device::Depth& d
   // Process the depthimage into probabilities (CUDA)
   //impl_->process(depth, labels_);
   //impl_->processProb(depth, labels_, P_l_, (int) std::numeric_limits<std::int16_t>::max());
+  std::lock_guard<std::mutex> lock(*impl_mutex_);
   impl_->processProb(depth, labels_, P_l_, std::numeric_limits<int>::max());
 }
 
@@ -1,6 +1,5 @@
 #include "internal.h"
 
-#include <pcl/gpu/utils/texture_binder.hpp>
 #include <pcl/gpu/utils/device/block.hpp>
 
 #include <cassert>
@@ -61,7 +60,7 @@ namespace pcl
 }
 
 void
-pcl::device::ConnectedComponents::initEdges(int rows, int cols, DeviceArray2D<unsigned char>& edges)
+pcl::device::ConnectedComponents::initEdges(int rows, int cols, DeviceArray2D<unsigned char>& edges, cudaStream_t stream)
 {
   int ecols = divUp(cols, TILE_COLS) * TILE_COLS;
   int erows = divUp(rows, TILE_ROWS) * TILE_ROWS;
@@ -71,9 +70,10 @@ pcl::device::ConnectedComponents::initEdges(int rows, int cols, DeviceArray2D<un
   dim3 block(32, 8);
   dim3 grid(divUp(ecols, block.x), divUp(erows, block.y));
 
-  fillInvalidEdges<<<grid, block>>>(edges);
+  fillInvalidEdges<<<grid, block, 0, stream>>>(edges);
   cudaSafeCall( cudaGetLastError() );
-  cudaSafeCall( cudaDeviceSynchronize() );
+  if (stream == 0)
+    cudaSafeCall( cudaDeviceSynchronize() );
 }
 
 ///////////////////////////////////////////////////////////////////////////////////////
@@ -165,18 +165,19 @@ namespace pcl
 }
 
 void
-pcl::device::ConnectedComponents::computeEdges(const Labels& labels, const Depth& depth, int num_parts, float sq_radius, DeviceArray2D<unsigned char>& edges)
+pcl::device::ConnectedComponents::computeEdges(const Labels& labels, const Depth& depth, int num_parts, float sq_radius, DeviceArray2D<unsigned char>& edges, cudaStream_t stream)
 {
   device::Intr intr(525.f, 525.f, 319.5, 239.5);
 
-  initEdges(labels.rows(), labels.cols(), edges);
+  initEdges(labels.rows(), labels.cols(), edges, stream);
   
   dim3 block(32, 8);
   dim3 grid(divUp(labels.cols(), block.x), divUp(labels.rows(), block.y));
  
-  computeEdgesKernel<<<grid, block>>>(labels, depth, intr, num_parts, sq_radius, edges);
+  computeEdgesKernel<<<grid, block, 0, stream>>>(labels, depth, intr, num_parts, sq_radius, edges);
   cudaSafeCall( cudaGetLastError() );
-  cudaSafeCall( cudaDeviceSynchronize() );
+  if (stream == 0)
+    cudaSafeCall( cudaDeviceSynchronize() );
 }
 
 ///////////////////////////////////////////////////////////////////////////////////////
@@ -377,8 +378,8 @@ namespace pcl
         return label;
     }
 
-    texture<unsigned char, 2, cudaReadModeElementType> edgesTex;
-    
+    // The edges are read through a plain pointer rather than a texture reference, which is global
+    // state and would keep labelComponents from running on several streams at once
     struct TilesMerge
     {           
       int tileSizeX;
@@ -386,6 +387,7 @@ namespace pcl
       int tilesNumX;
       int tilesNumY;
 
+      PtrStep<unsigned char> edges;
       mutable PtrStepSz<int> comps;
 
       __device__ __forceinline__ void 
@@ -439,7 +441,7 @@ namespace pcl
               int y = ybeg + (row + 1) * tileSizeY;
               int x = xbeg + col;
 
-              int e = tex2D(edgesTex, x, y);
+              int e = edges.ptr(y)[x];
               if (e & Edges::UP)
               {
                 int lc = comps.ptr(y  )[x];
@@ -457,7 +459,7 @@ namespace pcl
               int x = xbeg + (col + 1) * tileSizeX;
               int y = ybeg + row;
               
-              int e = tex2D(edgesTex, x, y);
+              int e = edges.ptr(y)[x];
               if (e & Edges::LEFT)
               {
                 int lc = comps.ptr(y)[x  ];
@@ -497,23 +499,23 @@ namespace pcl
 }
 
     
-void pcl::device::ConnectedComponents::labelComponents(const DeviceArray2D<unsigned char>& edges, DeviceArray2D<int>& comps)
+void pcl::device::ConnectedComponents::labelComponents(const DeviceArray2D<unsigned char>& edges, DeviceArray2D<int>& comps, cudaStream_t stream)
 {             
   comps.create(edges.rows(), edges.cols());
 
   dim3 block(CTA_SIZE_X, CTA_SIZE_Y);
   dim3 grid(divUp(edges.cols(), TILE_COLS), divUp(edges.rows(), TILE_ROWS));
   
-  smemTilesKernel<<<grid, block>>>(edges, comps);
+  smemTilesKernel<<<grid, block, 0, stream>>>(edges, comps);
   cudaSafeCall( cudaGetLastError() );
-  cudaSafeCall( cudaDeviceSynchronize() );
-
-  TextureBinder binder(edges, edgesTex);
+  if (stream == 0)
+    cudaSafeCall( cudaDeviceSynchronize() );
 
   // the code below assumes such resolution
   assert(edges.cols() == 640 && edges.rows() == 480);
 
   TilesMerge tm;
+  tm.edges = edges;
   tm.comps = comps;
 
   //merge 4x3 -> 5x5 grid
@@ -525,9 +527,10 @@ void pcl::device::ConnectedComponents::labelComponents(const DeviceArray2D<unsig
   grid.x = edges.cols()/(tm.tileSizeX * tm.tilesNumX);
   grid.y = edges.rows()/(tm.tileSizeY * tm.tilesNumY);
   
-  mergeKernel<<<grid, 768>>>(tm);
+  mergeKernel<<<grid, 768, 0, stream>>>(tm);
   cudaSafeCall( cudaGetLastError() );
-  cudaSafeCall( cudaDeviceSynchronize() );
+  if (stream == 0)
+    cudaSafeCall( cudaDeviceSynchronize() );
 
   //merge 5x5 -> 1x1 grid
   tm.tileSizeX = TILE_COLS * tm.tilesNumX;
@@ -538,13 +541,117 @@ void pcl::device::ConnectedComponents::labelComponents(const DeviceArray2D<unsig
   grid.x = edges.cols()/(tm.tileSizeX * tm.tilesNumX); 
   grid.y = edges.rows()/(tm.tileSizeY * tm.tilesNumY); 
 
-  mergeKernel<<<grid, 1024>>>(tm);
+  mergeKernel<<<grid, 1024, 0, stream>>>(tm);
   cudaSafeCall( cudaGetLastError() );
-  cudaSafeCall( cudaDeviceSynchronize() );
+  if (stream == 0)
+    cudaSafeCall( cudaDeviceSynchronize() );
 
   grid.x = divUp(edges.cols(), block.x);
   grid.y = divUp(edges.rows(), block.y);
-  flattenTreesKernel<<<grid, block>>>(comps, edges);
+  flattenTreesKernel<<<grid, block, 0, stream>>>(comps, edges);
   cudaSafeCall( cudaGetLastError() );
-  cudaSafeCall( cudaDeviceSynchronize() );
+  if (stream == 0)
+    cudaSafeCall( cudaDeviceSynchronize() );
+}
+
+///////////////////////////////////////////////////////////////////////////////////////
+//////////////// Blob extraction //////////////////////////////////////////////////////
+
+namespace pcl
+{
+  namespace device
+  {
+    __global__ void accumulateComponentsKernel(const PtrStepSz<int> comps, const PtrStep<float4> cloud, float4* sums)
+    {
+      int x = threadIdx.x + blockIdx.x * blockDim.x;
+      int y = threadIdx.y + blockIdx.y * blockDim.y;
+
+      if( x < comps.cols && y < comps.rows)
+      {
+        int cc = comps.ptr(y)[x];
+        if (cc < 0)
+          return;
+
+        float4 p = cloud.ptr(y)[x];
+        atomicAdd(&sums[cc].x, p.x);
+        atomicAdd(&sums[cc].y, p.y);
+        atomicAdd(&sums[cc].z, p.z);
+        atomicAdd(&sums[cc].w, 1.f);
+      }
+    }
+
+    __global__ void selectBlobsKernel(const float4* sums, int total, int comps_cols, const PtrStep<unsigned char> labels,
+                                      int min_size, int max_size, int* roots, BlobInfo* blobs, int* blobs_count)
+    {
+      int cc = threadIdx.x + blockIdx.x * blockDim.x;
+      if (cc >= total)
+        return;
+
+      float4 sum = sums[cc];
+      int size = __float2int_rn(sum.w);
+      int blob = -1;
+
+      // a zero z sum marks components without valid points
+      if (sum.z != 0 && min_size <= size && size <= max_size)
+      {
+        blob = atomicAdd(blobs_count, 1);
+
+        int y = cc / comps_cols;
+        int x = cc - y * comps_cols;
+
+        BlobInfo info;
+        info.mean = make_float3(sum.x / sum.w, sum.y / sum.w, sum.z / sum.w);
+        info.size = size;
+        info.label = labels.ptr(y)[x];
+        blobs[blob] = info;
+      }
+      roots[cc] = blob;
+    }
+
+    __global__ void blobIdsKernel(const PtrStepSz<int> comps, const int* roots, PtrStep<int> blob_ids)
+    {
+      int x = threadIdx.x + blockIdx.x * blockDim.x;
+      int y = threadIdx.y + blockIdx.y * blockDim.y;
+
+      if( x < comps.cols && y < comps.rows)
+      {
+        int cc = comps.ptr(y)[x];
+        blob_ids.ptr(y)[x] = cc < 0 ? -1 : roots[cc];
+      }
+    }
+  }
+}
+
+void pcl::device::extractBlobs(const DeviceArray2D<int>& comps, const Labels& labels, const Cloud& cloud, int min_size, int max_size,
+                               DeviceArray<float4>& sums, DeviceArray<int>& roots, DeviceArray<BlobInfo>& blobs, DeviceArray<int>& blobs_count,
+                               DeviceArray2D<int>& blob_ids, cudaStream_t stream)
+{
+  int total = comps.rows() * comps.cols();
+
+  sums.create(total);
+  roots.create(total);
+  blobs.create(total);
+  blobs_count.create(1);
+  blob_ids.create(labels.rows(), labels.cols());
+
+  cudaSafeCall( cudaMemsetAsync(sums.ptr(), 0, sums.sizeBytes(), stream) );
+  cudaSafeCall( cudaMemsetAsync(blobs_count.ptr(), 0, blobs_count.sizeBytes(), stream) );
+
+  // the components are padded to whole tiles, only the image part holds points
+  PtrStepSz<int> comps_image(labels.rows(), labels.cols(), const_cast<int*>(comps.ptr()), comps.step());
+
+  dim3 block(32, 8);
+  dim3 grid(divUp(labels.cols(), block.x), divUp(labels.rows(), block.y));
+
+  accumulateComponentsKernel<<<grid, block, 0, stream>>>(comps_image, cloud, sums);
+  cudaSafeCall( cudaGetLastError() );
+
+  selectBlobsKernel<<<divUp(total, 256), 256, 0, stream>>>(sums, total, comps.cols(), labels, min_size, max_size, roots, blobs, blobs_count);
+  cudaSafeCall( cudaGetLastError() );
+
+  blobIdsKernel<<<grid, block, 0, stream>>>(comps_image, roots, blob_ids);
+  cudaSafeCall( cudaGetLastError() );
+
+  if (stream == 0)
+    cudaSafeCall( cudaDeviceSynchronize() );
 }
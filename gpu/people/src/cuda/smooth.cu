@@ -129,7 +129,7 @@ namespace pcl
   }
 }
 
-void pcl::device::smoothLabelImage(const Labels& src, const Depth& depth, Labels& dst, int num_parts, int  patch_size, int  depthThres)
+void pcl::device::smoothLabelImage(const Labels& src, const Depth& depth, Labels& dst, int num_parts, int  patch_size, int  depthThres, cudaStream_t stream)
 {
   dst.create(src.rows(), src.cols());
 
@@ -137,15 +137,16 @@ void pcl::device::smoothLabelImage(const Labels& src, const Depth& depth, Labels
   dim3 grid(divUp(src.cols(), block.x), divUp(src.rows(), block.y));
 
   if (num_parts <= 28)
-    pcl::device::smoothKernel<28><<<grid, block>>>(src, depth, dst, patch_size, depthThres, num_parts);
+    pcl::device::smoothKernel<28><<<grid, block, 0, stream>>>(src, depth, dst, patch_size, depthThres, num_parts);
   else
   if (num_parts <= 32)
-    pcl::device::smoothKernel<32><<<grid, block>>>(src, depth, dst, patch_size, depthThres, num_parts);
+    pcl::device::smoothKernel<32><<<grid, block, 0, stream>>>(src, depth, dst, patch_size, depthThres, num_parts);
   else
     throw std::exception(); //should instantiate another smoothKernel<N>
 
   cudaSafeCall( cudaGetLastError() );
-  cudaSafeCall( cudaDeviceSynchronize() );
+  if (stream == 0)
+    cudaSafeCall( cudaDeviceSynchronize() );
 }
 
 
@@ -73,7 +73,7 @@ namespace pcl
         }
     };
 
-    void smoothLabelImage(const Labels& src, const Depth& depth, Labels& dst, int num_parts, int  patch_size, int depthThres);
+    void smoothLabelImage(const Labels& src, const Depth& depth, Labels& dst, int num_parts, int  patch_size, int depthThres, cudaStream_t stream = 0);
     void colorLMap(const Labels& labels, const DeviceArray<uchar4>& cmap, Image& rgb);
     void mixedColorMap(const Labels& labels, const DeviceArray<uchar4>& map, const Image& rgba, Image& output);
 
@@ -81,12 +81,36 @@ namespace pcl
 
     struct ConnectedComponents
     {
-        static void initEdges(int rows, int cols, DeviceArray2D<unsigned char>& edges);
+        static void initEdges(int rows, int cols, DeviceArray2D<unsigned char>& edges, cudaStream_t stream = 0);
         //static void computeEdges(const Labels& labels, const Cloud& cloud, int num_parts, float sq_radius, DeviceArray2D<unsigned char>& edges);
-        static void computeEdges(const Labels& labels, const Depth& depth, int num_parts, float sq_radius, DeviceArray2D<unsigned char>& edges);
-        static void labelComponents(const DeviceArray2D<unsigned char>& edges, DeviceArray2D<int>& comps);
+        static void computeEdges(const Labels& labels, const Depth& depth, int num_parts, float sq_radius, DeviceArray2D<unsigned char>& edges, cudaStream_t stream = 0);
+        static void labelComponents(const DeviceArray2D<unsigned char>& edges, DeviceArray2D<int>& comps, cudaStream_t stream = 0);
     };
 
+    /** \brief A connected component large enough to become a blob **/
+    struct BlobInfo
+    {
+        float3 mean;
+        int size;
+        int label;
+    };
+
+    /** \brief Turns the connected components into blobs on the device
+      * \param[in] comps root index of the component of every pixel, -1 if invalid
+      * \param[in] labels the smoothed labels
+      * \param[in] cloud the points the blob means are computed from
+      * \param[in] min_size minimum number of points of a blob
+      * \param[in] max_size maximum number of points of a blob
+      * \param[out] sums per component sum of the points and, in w, their number
+      * \param[out] roots blob index of every component root, -1 if the component is no blob
+      * \param[out] blobs the blobs, in no particular order
+      * \param[out] blobs_count the number of blobs
+      * \param[out] blob_ids blob index of every pixel, -1 if it belongs to none
+      */
+    void extractBlobs(const DeviceArray2D<int>& comps, const Labels& labels, const Cloud& cloud, int min_size, int max_size,
+                      DeviceArray<float4>& sums, DeviceArray<int>& roots, DeviceArray<BlobInfo>& blobs, DeviceArray<int>& blobs_count,
+                      DeviceArray2D<int>& blob_ids, cudaStream_t stream = 0);
+
     void computeCloud(const Depth& depth, const Intr& intr, Cloud& cloud);
 
     void setZero(Mask& mask);
@@ -48,6 +48,8 @@
 
 #include <pcl/common/time.h>
 
+#include <algorithm>
+
 #define AREA_THRES      200 // for euclidean clusterization 1 
 #define AREA_THRES2     100 // for euclidean clusterization 2 
 #define CLUST_TOL_SHS   0.05
@@ -59,7 +61,7 @@ using namespace pcl::gpu::people;
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 pcl::gpu::people::PeopleDetector::PeopleDetector() 
-    : fx_(525.f), fy_(525.f), cx_(319.5f), cy_(239.5f), delta_hue_tolerance_(5)
+    : fx_(525.f), fy_(525.f), cx_(319.5f), cy_(239.5f), delta_hue_tolerance_(5), pipeline_depth_(2), next_pipeline_frame_(0)
 {
   PCL_DEBUG ("[pcl::gpu::people::PeopleDetector] : (D) : Constructor called\n");
 
@@ -82,6 +84,13 @@ pcl::gpu::people::PeopleDetector::PeopleDetector()
   allocate_buffers();
 }
 
+pcl::gpu::people::PeopleDetector::~PeopleDetector()
+{
+  // the worker threads still use the frames and the members
+  while (!frames_in_flight_.empty ())
+    flushPipeline ();
+}
+
 void
 pcl::gpu::people::PeopleDetector::setIntrinsics (float fx, float fy, float cx, float cy)
 {
@@ -181,9 +190,23 @@ pcl::gpu::people::PeopleDetector::process (const pcl::PointCloud<PointTC>::Const
 int
 pcl::gpu::people::PeopleDetector::process ()
 {  
-  rdf_detector_->process(depth_device1_, cloud_host_, AREA_THRES);
+  rdf_detector_->enqueue(depth_device1_, cloud_device_, AREA_THRES);
 
-  const RDFBodyPartsDetector::BlobMatrix& sorted = rdf_detector_->getBlobMatrix();
+  // detect works on the buffers of a frame, lend it the members
+  swapFrame(sync_frame_);
+  int result = detect(sync_frame_);
+  swapFrame(sync_frame_);
+  return result;
+}
+
+int
+pcl::gpu::people::PeopleDetector::detect (PipelineFrame &frame)
+{
+  RDFBodyPartsDetector& rdf = *frame.rdf_detector;
+  rdf.collect();
+  rdf.processRelations();
+
+  const RDFBodyPartsDetector::BlobMatrix& sorted = rdf.getBlobMatrix();
 
   //////////////////////////////////////////////////////////////////////////////////////////////////
   // if we found a neck display the tree, and continue with processing
@@ -191,46 +214,33 @@ pcl::gpu::people::PeopleDetector::process ()
   {
     int c = 0;
     Tree2 t;
-    buildTree(sorted, cloud_host_, Neck, c, t);
+    buildTree(sorted, frame.cloud_host, Neck, c, t);
     
     const auto& seed = t.indices.indices;
         
-    std::fill(flowermat_host_.begin(), flowermat_host_.end(), 0);
+    std::fill(frame.flowermat_host.begin(), frame.flowermat_host.end(), 0);
     {
       //ScopeTime time("shs");    
-      shs5(cloud_host_, seed, &flowermat_host_[0]);
+      shs5(frame.cloud_host, frame.hue_host, seed, &frame.flowermat_host[0]);
     }
     
-    int cols = cloud_device_.cols();
-    fg_mask_.upload(flowermat_host_.points, cols);
-    device::Dilatation::invoke(fg_mask_, kernelRect5x5_, fg_mask_grown_);
+    int cols = frame.cloud_device.cols();
+    frame.fg_mask.upload(frame.flowermat_host.points, cols);
+    device::Dilatation::invoke(frame.fg_mask, kernelRect5x5_, frame.fg_mask_grown);
 
-    device::prepareForeGroundDepth(depth_device1_, fg_mask_grown_, depth_device2_);
+    device::prepareForeGroundDepth(frame.depth_device1, frame.fg_mask_grown, frame.depth_device2);
 
     //// //////////////////////////////////////////////////////////////////////////////////////////////// //
     //// The second label evaluation    
         
-    rdf_detector_->process(depth_device2_, cloud_host_, AREA_THRES2);    
-    const RDFBodyPartsDetector::BlobMatrix& sorted2 = rdf_detector_->getBlobMatrix();
+    rdf.process(frame.depth_device2, frame.cloud_device, AREA_THRES2);
+    const RDFBodyPartsDetector::BlobMatrix& sorted2 = rdf.getBlobMatrix();
 
     //brief Test if the second tree is build up correctly
     if(!sorted2[Neck].empty ())
     {      
       Tree2 t2;
-      buildTree(sorted2, cloud_host_, Neck, c, t2);
-      /*int par = 0;
-      for(int f = 0; f < NUM_PARTS; f++)
-      {
-        if(t2.parts_lid[f] == NO_CHILD)
-        {
-          std::cerr << "1;";
-          par++;
-        }
-        else
-           std::cerr << "0;";
-      }*/
-      //static int counter = 0; // TODO move this logging to PeopleApp
-      //std::cerr << t2.nr_parts << ";" << par << ";" << t2.total_dist_error << ";" << t2.norm_dist_error << ";" << counter++ << ";" << std::endl;
+      buildTree(sorted2, frame.cloud_host, Neck, c, t2);
       return 2;
     }
     return 1;
@@ -239,6 +249,110 @@ pcl::gpu::people::PeopleDetector::process ()
   return 0;
 }
 
+void
+pcl::gpu::people::PeopleDetector::swapFrame (PipelineFrame &frame)
+{
+  rdf_detector_.swap(frame.rdf_detector);
+  cloud_host_.swap(frame.cloud_host);
+  hue_host_.swap(frame.hue_host);
+  flowermat_host_.swap(frame.flowermat_host);
+  cloud_device_.swap(frame.cloud_device);
+  hue_device_.swap(frame.hue_device);
+  depth_device1_.swap(frame.depth_device1);
+  depth_device2_.swap(frame.depth_device2);
+  fg_mask_.swap(frame.fg_mask);
+  fg_mask_grown_.swap(frame.fg_mask_grown);
+}
+
+void
+pcl::gpu::people::PeopleDetector::startFrame (PipelineFrame &frame, const Depth& depth, const Image& rgba)
+{
+  int rows = depth.rows();
+  int cols = depth.cols();
+
+  if (!frame.rdf_detector)
+    frame.rdf_detector.reset(new RDFBodyPartsDetector(*rdf_detector_, rows, cols));
+
+  frame.cloud_host.width  = frame.hue_host.width  = frame.flowermat_host.width  = cols;
+  frame.cloud_host.height = frame.hue_host.height = frame.flowermat_host.height = rows;
+  frame.cloud_host.resize(cols * rows);
+  frame.hue_host.resize(cols * rows);
+  frame.flowermat_host.resize(cols * rows);
+  frame.cloud_host.is_dense = frame.hue_host.is_dense = frame.flowermat_host.is_dense = false;
+
+  frame.cloud_device.create(rows, cols);
+  frame.hue_device.create(rows, cols);
+  frame.depth_device2.create(rows, cols);
+  frame.fg_mask.create(rows, cols);
+  frame.fg_mask_grown.create(rows, cols);
+
+  // the caller may reuse its buffers for the next frame while this one is in flight
+  depth.copyTo(frame.depth_device1);
+
+  const device::Image& i = (const device::Image&)rgba;
+  device::computeHueWithNans(i, frame.depth_device1, frame.hue_device);
+  frame.hue_device.download(frame.hue_host.points, cols);
+
+  device::Intr intr(fx_, fy_, cx_, cy_);
+  intr.setDefaultPPIfIncorrect(cols, rows);
+
+  device::Cloud& c = (device::Cloud&)frame.cloud_device;
+  device::computeCloud(frame.depth_device1, intr, c);
+  frame.cloud_device.download(frame.cloud_host.points, cols);
+
+  frame.rdf_detector->enqueue(frame.depth_device1, frame.cloud_device, AREA_THRES);
+}
+
+int
+pcl::gpu::people::PeopleDetector::processPipelined (const Depth& depth, const Image& rgba)
+{
+  if (pipeline_frames_.empty ())
+  {
+    for (int i = 0; i < pipeline_depth_; ++i)
+      pipeline_frames_.push_back(PipelineFrame::Ptr (new PipelineFrame));
+    next_pipeline_frame_ = 0;
+  }
+
+  // The frames are used round robin, the next one was the oldest in flight and is free again, as at most
+  // pipeline_depth_ - 1 frames are left in flight between calls
+  PipelineFrame& frame = *pipeline_frames_[next_pipeline_frame_];
+  next_pipeline_frame_ = (next_pipeline_frame_ + 1) % pipeline_frames_.size ();
+
+  // The device part of the new frame overlaps with the host part of the frames before
+  startFrame(frame, depth, rgba);
+  frame.result = std::async(std::launch::async, [this, &frame] { return detect(frame); });
+  frames_in_flight_.push_back(&frame);
+
+  if (static_cast<int> (frames_in_flight_.size ()) < pipeline_depth_)
+    return -1;
+  return flushPipeline();
+}
+
+int
+pcl::gpu::people::PeopleDetector::flushPipeline ()
+{
+  if (frames_in_flight_.empty ())
+    return -1;
+
+  PipelineFrame& frame = *frames_in_flight_.front ();
+  frames_in_flight_.pop_front ();
+  int result = frame.result.get ();
+
+  // hand the results to the members, their buffers are used for a later frame
+  swapFrame(frame);
+  return result;
+}
+
+void
+pcl::gpu::people::PeopleDetector::setPipelineDepth (int depth)
+{
+  while (!frames_in_flight_.empty ())
+    flushPipeline ();
+
+  pipeline_depth_ = std::min(std::max(depth, 1), 3);
+  pipeline_frames_.clear ();
+}
+
 int
 pcl::gpu::people::PeopleDetector::processProb (const pcl::PointCloud<PointTC>::ConstPtr &cloud)
 {
@@ -474,11 +588,17 @@ namespace
 
 void 
 pcl::gpu::people::PeopleDetector::shs5(const pcl::PointCloud<PointT> &cloud, const pcl::Indices& indices, unsigned char *mask)
+{
+  shs5(cloud, hue_host_, indices, mask);
+}
+
+void 
+pcl::gpu::people::PeopleDetector::shs5(const pcl::PointCloud<PointT> &cloud, const pcl::PointCloud<float> &hue_cloud, const pcl::Indices& indices, unsigned char *mask)
 {
   pcl::device::Intr intr(fx_, fy_, cx_, cy_);
   intr.setDefaultPPIfIncorrect(cloud.width, cloud.height);
   
-  const float *hue = &hue_host_[0];
+  const float *hue = &hue_cloud[0];
   double squared_radius = CLUST_TOL_SHS * CLUST_TOL_SHS;
 
   std::vector< std::vector<int> > storage(100);
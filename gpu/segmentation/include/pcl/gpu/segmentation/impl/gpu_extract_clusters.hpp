@@ -49,6 +49,15 @@ economical_download(const pcl::gpu::NeighborIndices& source_indices,
                     const pcl::Indices& buffer_indices,
                     std::size_t buffer_size,
                     pcl::Indices& downloaded_indices);
+
+//// Labels the connected components of the radius graph of the octree cloud on the
+//// device, with parallel union-find. The label of a point is the smallest point index
+//// of its component. At most max_neighbors neighbors are taken into account per point.
+PCL_EXPORTS void
+labelEuclideanClusters(const pcl::gpu::Octree& tree,
+                       float tolerance,
+                       int max_neighbors,
+                       std::vector<int>& labels);
 } // namespace detail
 } // namespace pcl
 
@@ -60,11 +69,7 @@ pcl::gpu::extractEuclideanClusters (const typename pcl::PointCloud<PointT>::Ptr
                                     unsigned int                               min_pts_per_cluster,
                                     unsigned int                               max_pts_per_cluster)
 {
-
-  // Create a bool vector of processed point indices, and initialize it to false
-  // cloud is a DeviceArray<PointType>
   PCL_DEBUG("[pcl::gpu::extractEuclideanClusters]\n");
-  std::vector<bool> processed (host_cloud_->size (), false);
 
   int max_answers;
 
@@ -74,110 +79,32 @@ pcl::gpu::extractEuclideanClusters (const typename pcl::PointCloud<PointT>::Ptr
     max_answers = max_pts_per_cluster;
   PCL_DEBUG("Max_answers: %i\n", max_answers);
 
-  // to store the current cluster
-  pcl::PointIndices r;
+  // Connected components on the device, downloaded once
+  std::vector<int> labels;
+  pcl::detail::labelEuclideanClusters (*tree, tolerance, max_answers, labels);
 
-  DeviceArray<PointXYZ> queries_device_buffer;
-  queries_device_buffer.create(max_answers);
-
-  // Host buffer for results
-  pcl::Indices sizes, data, cpu_tmp;
-  // Process all points in the cloud
-  for (std::size_t i = 0; i < host_cloud_->size (); ++i)
+  // A label is the smallest index of its cluster, so the clusters come out ordered by
+  // their first point and with sorted indices
+  std::vector<int> cluster_of_label (labels.size (), -1);
+  std::vector<PointIndices> candidates;
+  for (std::size_t i = 0; i < labels.size (); ++i)
   {
-    // if we already processed this point continue with the next one
-    if (processed[i])
-      continue;
-    // now we will process this point
-    processed[i] = true;
-
-    // Create the query queue on the device, point based not indices
-    pcl::gpu::Octree::Queries queries_device;
-    // Create the query queue on the host
-    pcl::PointCloud<pcl::PointXYZ>::VectorType queries_host;
-
-    // Buffer in a new PointXYZ type
-    PointXYZ p;
-    pcl::copyPoint((*host_cloud_)[i], p);
-
-    // Push the starting point in the vector
-    queries_host.push_back (p);
-    // Clear vector
-    r.indices.clear();
-    // Push the starting point in
-    r.indices.push_back(i);
-
-    unsigned int found_points = queries_host.size ();
-    unsigned int previous_found_points = 0;
-
-    pcl::gpu::NeighborIndices result_device;
-
-    // once the area stop growing, stop also iterating.
-    do
+    int& cluster = cluster_of_label[labels[i]];
+    if (cluster < 0)
     {
-      data.clear();
-      // if the number of queries is not high enough implement search on Host here
-      if(queries_host.size () <= 10) ///@todo: adjust this to a variable number settable with method
-      {
-        PCL_DEBUG(" CPU: ");
-        for(std::size_t p = 0; p < queries_host.size (); p++)
-        {
-          // Execute the radiusSearch on the host
-          cpu_tmp.clear();
-          tree->radiusSearchHost(queries_host[p], tolerance, cpu_tmp, max_answers);
-          std::copy(cpu_tmp.begin(), cpu_tmp.end(), std::back_inserter(data));
-        }
-      }
-      // If number of queries is high enough do it here
-      else
-      {
-        PCL_DEBUG(" GPU: ");
-        sizes.clear();
-        // Copy buffer
-        queries_device = DeviceArray<PointXYZ>(queries_device_buffer.ptr(),queries_host.size());
-        // Move queries to GPU
-        queries_device.upload(queries_host);
-        // Execute search
-        tree->radiusSearch(queries_device, tolerance, max_answers, result_device);
-        // Copy results from GPU to Host
-        result_device.sizes.download(sizes);
-        pcl::detail::economical_download(result_device, sizes, max_answers, data);
-      }
-      // Store the previously found number of points
-      previous_found_points = found_points;
-      // Clear queries list
-      queries_host.clear();
-
-      if(data.size () == 1)
-        continue;
-
-      // Process the results
-      for(auto idx : data)
-      {  
-        if(processed[idx])
-          continue;
-        processed[idx] = true;
-        PointXYZ p;
-        pcl::copyPoint((*host_cloud_)[idx], p);
-        queries_host.push_back (p);
-        found_points++;
-        r.indices.push_back(idx);
-      }
-      PCL_DEBUG(" data.size: %i, foundpoints: %i, previous: %i", data.size() ,
-              found_points, previous_found_points);
-      PCL_DEBUG(" new points: %i, next queries size: %i\n", found_points - previous_found_points,
-             queries_host.size());
+      cluster = static_cast<int> (candidates.size ());
+      candidates.emplace_back ();
     }
-    while (previous_found_points < found_points);
+    candidates[cluster].indices.push_back (static_cast<index_t> (i));
+  }
+
+  for (auto& r : candidates)
+  {
     // If this queue is satisfactory, add to the clusters
-    if (found_points >= min_pts_per_cluster && found_points <= max_pts_per_cluster)
+    if (r.indices.size () >= min_pts_per_cluster && r.indices.size () <= max_pts_per_cluster)
     {
-      std::sort (r.indices.begin (), r.indices.end ());
-      // @todo: check if the following is actually still needed
-      //r.indices.erase (std::unique (r.indices.begin (), r.indices.end ()), r.indices.end ());
-
       r.header = host_cloud_->header;
-      clusters.push_back (r);   // We could avoid a copy by working directly in the vector
+      clusters.push_back (std::move (r));
     }
   }
 }
@@ -0,0 +1,201 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2019-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "internal.hpp"
+
+#include <pcl/gpu/utils/safe_call.hpp>
+
+namespace pcl {
+namespace device {
+enum { CTA_SIZE = 256 };
+
+/** \brief Root of the tree of idx, halving the path on the way. The labels only ever
+ * decrease, so concurrent updates keep every label a valid ancestor. */
+__device__ __forceinline__ int
+representative(int idx, volatile int* labels)
+{
+  int curr = labels[idx];
+  if (curr != idx) {
+    int next, prev = idx;
+    while (curr > (next = labels[curr])) {
+      labels[prev] = next;
+      prev = curr;
+      curr = next;
+    }
+  }
+  return curr;
+}
+
+/** \brief Lock free union of the components of a and b, the larger root is hooked
+ * below the smaller one. */
+__device__ __forceinline__ void
+unite(int a, int b, int* labels)
+{
+  int root_a = representative(a, labels);
+  int root_b = representative(b, labels);
+
+  while (root_a != root_b) {
+    if (root_a < root_b) {
+      const int old = atomicCAS(&labels[root_b], root_b, root_a);
+      if (old == root_b)
+        break;
+      root_b = old;
+    }
+    else {
+      const int old = atomicCAS(&labels[root_a], root_a, root_b);
+      if (old == root_a)
+        break;
+      root_a = old;
+    }
+  }
+}
+
+__global__ void
+initLabelsKernel(PtrSz<int> labels)
+{
+  const int idx = blockIdx.x * CTA_SIZE + threadIdx.x;
+  if (idx < labels.size)
+    labels[idx] = idx;
+}
+
+struct NeighborUnion {
+  PtrStep<int> neighbors;
+  const int* sizes;
+  int queries_number;
+  const int* query_indices;
+  int query_offset;
+  int* labels;
+
+  __device__ __forceinline__ void
+  operator()() const
+  {
+    const int row = blockIdx.x * CTA_SIZE + threadIdx.x;
+    if (row >= queries_number)
+      return;
+
+    const int point = query_indices ? query_indices[row] : query_offset + row;
+    const int* neighbor = neighbors.ptr(row);
+
+    for (int i = 0, size = sizes[row]; i < size; ++i)
+      if (neighbor[i] != point)
+        unite(point, neighbor[i], labels);
+  }
+};
+
+__global__ void
+uniteNeighborsKernel(const NeighborUnion nu)
+{
+  nu();
+}
+
+__global__ void
+collectTruncatedKernel(const int* sizes,
+                       int max_elems,
+                       int queries_number,
+                       const int* query_indices,
+                       int query_offset,
+                       int* output,
+                       int* counter)
+{
+  const int row = blockIdx.x * CTA_SIZE + threadIdx.x;
+  if (row >= queries_number || sizes[row] < max_elems)
+    return;
+
+  output[atomicAdd(counter, 1)] = query_indices ? query_indices[row] : query_offset + row;
+}
+
+__global__ void
+flattenLabelsKernel(PtrSz<int> labels)
+{
+  const int idx = blockIdx.x * CTA_SIZE + threadIdx.x;
+  if (idx < labels.size)
+    labels[idx] = representative(idx, labels.data);
+}
+} // namespace device
+} // namespace pcl
+
+void
+pcl::device::initLabels(DeviceArray<int>& labels)
+{
+  initLabelsKernel<<<divUp((int)labels.size(), CTA_SIZE), CTA_SIZE>>>(labels);
+  cudaSafeCall(cudaGetLastError());
+}
+
+void
+pcl::device::uniteNeighbors(const NeighborIndices& neighbors,
+                            int queries_number,
+                            const int* query_indices,
+                            int query_offset,
+                            DeviceArray<int>& labels)
+{
+  NeighborUnion nu;
+  nu.neighbors = neighbors;
+  nu.sizes = neighbors.sizes.ptr();
+  nu.queries_number = queries_number;
+  nu.query_indices = query_indices;
+  nu.query_offset = query_offset;
+  nu.labels = labels.ptr();
+
+  uniteNeighborsKernel<<<divUp(queries_number, CTA_SIZE), CTA_SIZE>>>(nu);
+  cudaSafeCall(cudaGetLastError());
+}
+
+void
+pcl::device::collectTruncated(const NeighborIndices& neighbors,
+                              int queries_number,
+                              const int* query_indices,
+                              int query_offset,
+                              int* output,
+                              int* counter)
+{
+  collectTruncatedKernel<<<divUp(queries_number, CTA_SIZE), CTA_SIZE>>>(
+      neighbors.sizes.ptr(),
+      neighbors.max_elems,
+      queries_number,
+      query_indices,
+      query_offset,
+      output,
+      counter);
+  cudaSafeCall(cudaGetLastError());
+}
+
+void
+pcl::device::flattenLabels(DeviceArray<int>& labels)
+{
+  flattenLabelsKernel<<<divUp((int)labels.size(), CTA_SIZE), CTA_SIZE>>>(labels);
+  cudaSafeCall(cudaGetLastError());
+  cudaSafeCall(cudaDeviceSynchronize());
+}
@@ -40,6 +40,10 @@
 #include <pcl/impl/instantiate.hpp>
 #include <pcl/point_types.h>
 
+#include "internal.hpp"
+
+#include <algorithm>
+
 // Instantiations of specific point types
 PCL_INSTANTIATE(extractEuclideanClusters, PCL_XYZ_POINT_TYPES);
 PCL_INSTANTIATE(EuclideanClusterExtraction, PCL_XYZ_POINT_TYPES);
@@ -60,3 +64,77 @@ pcl::detail::economical_download(const pcl::gpu::NeighborIndices& source_indices
     downloaded_indices.insert(downloaded_indices.end(), tmp.begin(), tmp.end());
   }
 }
+
+void
+pcl::detail::labelEuclideanClusters(const pcl::gpu::Octree& tree,
+                                    float tolerance,
+                                    int max_neighbors,
+                                    std::vector<int>& labels)
+{
+  // Neighbor lists start this long and grow by factor 8 for the queries filling them
+  constexpr int initial_max_neighbors = 64;
+  // Bound of the neighbor buffer in entries, 64 MB
+  constexpr int max_neighbor_entries = 1 << 24;
+
+  const pcl::gpu::Octree::PointCloud& cloud = *tree.cloud_;
+  const int cloud_size = static_cast<int>(cloud.size());
+
+  labels.clear();
+  if (cloud_size == 0)
+    return;
+
+  // NeighborIndices keeps no sizes for a single neighbor
+  max_neighbors = std::max(2, std::min(max_neighbors, cloud_size));
+
+  pcl::gpu::DeviceArray<int> labels_device(cloud_size);
+  pcl::device::initLabels(labels_device);
+
+  // Queries whose neighbor lists were full, searched again with longer ones
+  pcl::gpu::DeviceArray<int> truncated(cloud_size), next_truncated(cloud_size);
+  pcl::gpu::DeviceArray<int> truncated_counter(1);
+  const int zero = 0;
+  int truncated_size = 0;
+
+  pcl::gpu::NeighborIndices neighbors;
+  int max_results = std::min(initial_max_neighbors, max_neighbors);
+
+  truncated_counter.upload(&zero, 1);
+  const int chunk = std::max(1, max_neighbor_entries / max_results);
+  for (int begin = 0; begin < cloud_size; begin += chunk) {
+    const int size = std::min(chunk, cloud_size - begin);
+    const pcl::gpu::Octree::Queries queries(
+        const_cast<pcl::PointXYZ*>(cloud.ptr()) + begin, size);
+
+    tree.radiusSearch(queries, tolerance, max_results, neighbors);
+    pcl::device::uniteNeighbors(neighbors, size, nullptr, begin, labels_device);
+    pcl::device::collectTruncated(
+        neighbors, size, nullptr, begin, truncated.ptr(), truncated_counter.ptr());
+  }
+  truncated_counter.download(&truncated_size);
+
+  while (truncated_size > 0 && max_results < max_neighbors) {
+    max_results = static_cast<int>(
+        std::min<long long>(static_cast<long long>(max_results) * 8, max_neighbors));
+
+    truncated_counter.upload(&zero, 1);
+    const int batch = std::max(1, max_neighbor_entries / max_results);
+    for (int begin = 0; begin < truncated_size; begin += batch) {
+      const int size = std::min(batch, truncated_size - begin);
+      const pcl::gpu::Octree::Indices indices(truncated.ptr() + begin, size);
+
+      tree.radiusSearch(cloud, indices, tolerance, max_results, neighbors);
+      pcl::device::uniteNeighbors(neighbors, size, indices.ptr(), 0, labels_device);
+      pcl::device::collectTruncated(neighbors,
+                                    size,
+                                    indices.ptr(),
+                                    0,
+                                    next_truncated.ptr(),
+                                    truncated_counter.ptr());
+    }
+    truncated_counter.download(&truncated_size);
+    truncated.swap(next_truncated);
+  }
+
+  pcl::device::flattenLabels(labels_device);
+  labels_device.download(labels);
+}
@@ -0,0 +1,81 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2019-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <pcl/gpu/containers/device_array.h>
+#include <pcl/gpu/octree/device_format.hpp>
+
+namespace pcl {
+namespace device {
+using pcl::gpu::DeviceArray;
+using pcl::gpu::NeighborIndices;
+
+/** \brief Makes every point its own component, labels[i] = i. */
+void
+initLabels(DeviceArray<int>& labels);
+
+/** \brief Merges the components of every query point with those of its neighbors.
+ * \param neighbors result of a radius search
+ * \param queries_number number of rows of neighbors
+ * \param query_indices point index of every row, or nullptr for query_offset + row
+ * \param query_offset point index of the first row if query_indices is nullptr
+ * \param labels union-find forest, labels[i] <= i
+ */
+void
+uniteNeighbors(const NeighborIndices& neighbors,
+               int queries_number,
+               const int* query_indices,
+               int query_offset,
+               DeviceArray<int>& labels);
+
+/** \brief Appends the point indices of the queries whose neighbor lists are full, and
+ * may be missing neighbors, to output at position *counter, incrementing *counter.
+ */
+void
+collectTruncated(const NeighborIndices& neighbors,
+                 int queries_number,
+                 const int* query_indices,
+                 int query_offset,
+                 int* output,
+                 int* counter);
+
+/** \brief Replaces every label by the root of its tree, the smallest point index of
+ * the component. */
+void
+flattenLabels(DeviceArray<int>& labels);
+} // namespace device
+} // namespace pcl
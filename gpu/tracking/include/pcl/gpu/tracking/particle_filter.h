@@ -1,147 +1,112 @@
 #pragma once
 
-#include <pcl/pcl_macros.h>
 #include <pcl/gpu/containers/device_array.h>
 
 #include <pcl/point_types.h>
 #include <pcl/point_cloud.h>
-#include <pcl/PointIndices.h>
 #include <pcl/pcl_macros.h>
 
-#include <pcl/gpu/kinfu/pixel_rgb.h>
+#include <pcl/tracking/distance_coherence.h>
+#include <pcl/tracking/distance_field_point_cloud_coherence.h>
 #include <pcl/tracking/particle_filter.h>
 
-#include "internal.h"
-
 namespace pcl
 {
   namespace gpu
-  {	
-    class ParticleFilterGPUTracker
+  {
+    /** \brief @b ParticleFilterGPUTracker is a ParticleFilterTracker whose weighting phase runs on the GPU.
+      *
+      * The reference cloud is uploaded once. In every frame the cropped input cloud is turned into a voxel
+      * distance field (see pcl::tracking::DistanceFieldPointCloudCoherence), which is uploaded together with the
+      * particle transformations. One CUDA block per particle transforms the reference points, pairs them through
+      * the distance field and sums up the distance coherence. Sampling, resampling and the state update are done
+      * by the CPU implementation of the base class.
+      *
+      * The weights are the ones of a DistanceFieldPointCloudCoherence with a single DistanceCoherence term.
+      * Other coherences and normals are not supported.
+      * \ingroup gpu_tracking
+      */
+    class PCL_EXPORTS ParticleFilterGPUTracker
+      : public pcl::tracking::ParticleFilterTracker<pcl::PointXYZ, pcl::tracking::ParticleXYZRPY>
     {
     public:
-    	/** \brief Point type supported */
-    	using PointType = pcl::PointXYZ;
-			//using NormalType = pcl::Normal;
-			using PixelRGB = pcl::RGB;
-			
-			using StateXYZ = pcl::PointXYZ;
-			using StateRPY = pcl::PointXYZ;
-			
-			using StateType = pcl::tracking::ParticleXYZRPY;
-
-			/** \brief Empty constructor. */
-			ParticleFilterGPUTracker ()
-			//: ParticleFilterTracker<PointInT, StateT> ()
-			{
-				tracker_name_ = "ParticleFilterGPUTracker";
-			}
-			
-			/** \brief set the number of the particles.
-			* \param particle_num the number of the particles.
-			*/
-			inline void
-				setParticleNum (const int particle_num) { particle_num_ = particle_num; }
-			
-			/** \brief get the number of the particles. */
-			inline int
-				getParticleNum () const { return particle_num_; }
-
-			 /** \brief set a pointer to a reference dataset to be tracked.
-			 * \param ref a pointer to a PointCloud message
-			 */
-			inline void
-				setReferenceCloud (const DeviceArray2D<PointType> &ref) { ref_ = ref; }
-			
-			/** \brief get a pointer to a reference dataset to be tracked. */
-			inline DeviceArray2D<PointType> const
-				getReferenceCloud () { return ref_; }
-
-			int
-				cols ();
-
-			int
-				rows ();
-
-			virtual bool 
-				operator() (const DeviceArray2D<PointType>& input, const DeviceArray2D<PixelRGB>& input_colors)
-			{
-
-			}
-
-			virtual void
-				setMotion (StateType motion)
-			{ motion_ = motion; }
-						
-			virtual StateType
-				getResult();						
+      /** \brief Point type supported */
+      using PointType = pcl::PointXYZ;
+      using StateType = pcl::tracking::ParticleXYZRPY;
+      using BaseClass = pcl::tracking::ParticleFilterTracker<PointType, StateType>;
+
+      using Ptr = shared_ptr<ParticleFilterGPUTracker>;
+      using ConstPtr = shared_ptr<const ParticleFilterGPUTracker>;
+
+      /** \brief Empty constructor. */
+      ParticleFilterGPUTracker ();
+
+      /** \brief Set the edge length of the voxels of the scene distance field.
+        * \param[in] resolution the voxel size in meters
+        */
+      inline void
+      setResolution (float resolution) { distance_field_->setResolution (resolution); }
+
+      /** \brief Get the edge length of the voxels of the scene distance field. */
+      inline float
+      getResolution () const { return (distance_field_->getResolution ()); }
+
+      /** \brief Set the maximum distance of a reference point to the scene to be taken into account.
+        * \param[in] val maximum distance
+        */
+      inline void
+      setMaximumDistance (double val)
+      {
+        maximum_distance_ = val;
+        distance_field_->setMaximumDistance (val);
+      }
+
+      /** \brief Set the weight of the distance coherence, see pcl::tracking::DistanceCoherence.
+        * \param[in] weight the weight of the squared distance
+        */
+      inline void
+      setDistanceWeight (double weight) { distance_coherence_->setWeight (weight); }
+
+      /** \brief Get the weight of the distance coherence. */
+      inline double
+      getDistanceWeight () const { return (distance_coherence_->getWeight ()); }
 
     protected:
-			std::string tracker_name_;
-
-			virtual bool 
-			initCompute()
-			{
-
-				//pcl::device::initParticles(particle_num_, particle_xyz_, particle_rpy_, particle_weight_ );
-			}
-			
-			virtual void 
-			computeTracking()
-			{
-
-			}						
-			
-			virtual void
-				allocateBuffers()
-			{
-				particles_.create( particle_num_ );				
-
-				random_number_generator_.create( particle_num_ );
-				
-			}
-			
-			// reference point cloud
-			DeviceArray2D<PointType> ref_;
-
-			DeviceArray2D<PixelRGB> ref_colors_;
-
-			//DeviceArray2D<NormalType> ref_normals_;
-
-			// input point cloud
-			DeviceArray2D<PointType> input_;
-
-			DeviceArray2D<PixelRGB> input_colors_;
+      /** \brief Weighting phase of the particle filter, computed on the GPU. */
+      void
+      weight () override;
 
-			//DeviceArray2D<NormalType> input_normals_;
-						
-			//StateCloud particles_;
-			DeviceArray<StateType> particles_;
+      /** \brief Distance field of the cropped input, also used as coherence_ of the base class. */
+      pcl::tracking::DistanceFieldPointCloudCoherence<PointType>::Ptr distance_field_;
 
-			// random number generate state
-			DeviceArray<curandState> rng_states;
-						
-			int particle_num_;
+      /** \brief The distance term evaluated for every point pair. */
+      pcl::tracking::DistanceCoherence<PointType>::Ptr distance_coherence_;
 
-			std::vector<float> step_noise_covariance_;
+      /** \brief Maximum distance of a point pair. */
+      double maximum_distance_;
 
-      std::vector<float> initial_noise_covariance_;
-        
-      std::vector<float> initial_noise_mean_;
+      /** \brief The reference cloud currently held by ref_device_. */
+      PointCloudInConstPtr uploaded_ref_;
 
-			StateType motion_;
+      /** \brief Reference cloud on the device. */
+      DeviceArray<PointType> ref_device_;
 
-			float motion_ratio_;
+      /** \brief Cropped input cloud on the device. */
+      DeviceArray<PointType> scene_device_;
 
-			bool use_colors_;
+      /** \brief Closest scene point per voxel of the distance field on the device, -1 for none. */
+      DeviceArray<int> nearest_indices_device_;
 
-			StateType representative_state_;			
+      /** \brief Row-major 3x4 transformation per particle on the device. */
+      DeviceArray<float> transforms_device_;
 
-			/** \brief Height of input depth image. */
-			int rows_;
-			/** \brief Width of input depth image. */
-			int cols_;
+      /** \brief Weight per particle on the device. */
+      DeviceArray<float> weights_device_;
 
-		};
+      /** \brief Host side staging buffers, kept to avoid reallocations. */
+      std::vector<int> nearest_indices_host_;
+      std::vector<float> transforms_host_;
+      std::vector<float> weights_host_;
+    };
   }
 }
@@ -0,0 +1,107 @@
+#include "device.hpp"
+
+namespace pcl
+{
+	namespace device
+	{
+		struct ParticleWeighting
+		{
+			enum
+			{
+				CTA_SIZE = 256
+			};
+
+			PtrSz<PointType> ref_;
+			PtrSz<PointType> scene_;
+			PtrSz<int> nearest_indices_;
+			DistanceGrid grid_;
+			float distance_weight_;
+
+			PtrSz<float> transforms_;
+			mutable PtrSz<float> weights_;
+
+			__device__ __forceinline__ int
+				getVoxelCoordinate (float value, float origin, int dim) const
+			{
+				// points outside of the grid are paired through the closest border voxel
+				int coord = __float2int_rd ((value - origin) * grid_.inv_resolution);
+				return max (0, min (coord, dim - 1));
+			}
+
+			__device__ __forceinline__ void
+				operator () () const
+			{
+				__shared__ float sums[CTA_SIZE];
+
+				const float* t = &transforms_[blockIdx.x * 12];
+
+				float sum = 0.f;
+				for (int i = threadIdx.x; i < ref_.size; i += CTA_SIZE)
+				{
+					const float4 r = ref_[i];
+					const float x = t[0] * r.x + t[1] * r.y + t[2]  * r.z + t[3];
+					const float y = t[4] * r.x + t[5] * r.y + t[6]  * r.z + t[7];
+					const float z = t[8] * r.x + t[9] * r.y + t[10] * r.z + t[11];
+
+					const int ix = getVoxelCoordinate (x, grid_.min.x, grid_.dims.x);
+					const int iy = getVoxelCoordinate (y, grid_.min.y, grid_.dims.y);
+					const int iz = getVoxelCoordinate (z, grid_.min.z, grid_.dims.z);
+
+					const int k = nearest_indices_[(iz * grid_.dims.y + iy) * grid_.dims.x + ix];
+					if (k < 0)
+						continue;
+
+					const float4 s = scene_[k];
+					const float dx = x - s.x, dy = y - s.y, dz = z - s.z;
+					const float dist_sqr = dx * dx + dy * dy + dz * dz;
+					if (dist_sqr < grid_.max_distance_sqr)
+						sum += 1.f / (1.f + dist_sqr * distance_weight_);
+				}
+
+				sums[threadIdx.x] = sum;
+				__syncthreads ();
+
+				for (int stride = CTA_SIZE / 2; stride > 0; stride >>= 1)
+				{
+					if (threadIdx.x < stride)
+						sums[threadIdx.x] += sums[threadIdx.x + stride];
+					__syncthreads ();
+				}
+
+				if (threadIdx.x == 0)
+					weights_[blockIdx.x] = -sums[0];
+			}
+		};
+
+		__global__ void
+			ParticleWeightingKernel (const ParticleWeighting pw)
+		{
+			pw ();
+		}
+	}
+}
+
+void
+	pcl::device::computeWeights ( const DeviceArray<PointType>& ref, const DeviceArray<PointType>& scene,
+		const DeviceArray<int>& nearest_indices, const DistanceGrid& grid, float distance_weight,
+		const DeviceArray<float>& transforms, DeviceArray<float>& weights )
+{
+	if (weights.empty ())
+		return;
+
+	ParticleWeighting pw;
+
+	pw.ref_ = ref;
+	pw.scene_ = scene;
+	pw.nearest_indices_ = nearest_indices;
+	pw.grid_ = grid;
+	pw.distance_weight_ = distance_weight;
+
+	pw.transforms_ = transforms;
+	pw.weights_ = weights;
+
+	ParticleWeightingKernel<<<weights.size (), ParticleWeighting::CTA_SIZE>>>(pw);
+
+	cudaSafeCall( cudaGetLastError() );
+	cudaSafeCall( cudaDeviceSynchronize() );
+}
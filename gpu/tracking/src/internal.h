@@ -31,6 +31,29 @@ namespace pcl
 			PtrSz<curandState> rng_states, const DeviceArray<float>& step_noise_covariance,
 			DeviceArray<StateType>& particles,
 			StateType& representative_state, StateType& motion, float motion_ratio );
+
+		/** \brief Voxel grid of a scene distance field. */
+		struct DistanceGrid
+		{
+			float3 min;
+			int3 dims;
+			float inv_resolution;
+			float max_distance_sqr;
+		};
+
+		/** \brief Computes the distance coherence of every particle, one block per particle.
+		  * \param[in] ref reference cloud
+		  * \param[in] scene scene cloud the distance field was built from
+		  * \param[in] nearest_indices closest scene point per voxel of grid, -1 for none
+		  * \param[in] grid layout of nearest_indices
+		  * \param[in] distance_weight weight of the squared distance in the coherence
+		  * \param[in] transforms row-major 3x4 transformation per particle
+		  * \param[out] weights negated sum of the point coherences per particle
+		  */
+		void
+			computeWeights ( const DeviceArray<PointType>& ref, const DeviceArray<PointType>& scene,
+			const DeviceArray<int>& nearest_indices, const DistanceGrid& grid, float distance_weight,
+			const DeviceArray<float>& transforms, DeviceArray<float>& weights );
 		
 		/*
 		void
@@ -0,0 +1,85 @@
+#include <pcl/gpu/tracking/particle_filter.h>
+#include <pcl/console/print.h>
+
+#include "internal.h"
+
+#include <limits>
+
+using namespace pcl::device;
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////
+pcl::gpu::ParticleFilterGPUTracker::ParticleFilterGPUTracker ()
+  : BaseClass ()
+  , distance_field_ (new pcl::tracking::DistanceFieldPointCloudCoherence<PointType>)
+  , distance_coherence_ (new pcl::tracking::DistanceCoherence<PointType>)
+  , maximum_distance_ (std::numeric_limits<double>::max ())
+{
+  tracker_name_ = "ParticleFilterGPUTracker";
+  distance_field_->addPointCoherence (distance_coherence_);
+  coherence_ = distance_field_;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////
+void
+pcl::gpu::ParticleFilterGPUTracker::weight ()
+{
+  if (use_normal_)
+    PCL_WARN ("[pcl::%s::weight] Normals are not supported and will be ignored.\n", getClassName ().c_str ());
+
+  PointCloudInPtr coherence_input (new PointCloudIn);
+  cropInputPointCloud (input_, *coherence_input);
+
+  // Builds the distance field of the scene
+  coherence_->setTargetCloud (coherence_input);
+  if (!coherence_->initCompute ())
+  {
+    PCL_ERROR ("[pcl::%s::weight] Could not build the distance field of the input.\n", getClassName ().c_str ());
+    return;
+  }
+
+  // The reference only changes with setReferenceCloud
+  if (uploaded_ref_ != ref_)
+  {
+    ref_device_.upload (ref_->points.data (), ref_->size ());
+    uploaded_ref_ = ref_;
+  }
+  scene_device_.upload (coherence_input->points.data (), coherence_input->size ());
+
+  const std::vector<index_t>& nearest_indices = distance_field_->getNearestIndices ();
+  nearest_indices_host_.resize (nearest_indices.size ());
+  for (std::size_t i = 0; i < nearest_indices.size (); ++i)
+    nearest_indices_host_[i] = (nearest_indices[i] == UNAVAILABLE ? -1 : static_cast<int> (nearest_indices[i]));
+  nearest_indices_device_.upload (nearest_indices_host_);
+
+  DistanceGrid grid;
+  const Eigen::Vector3f& grid_min = distance_field_->getGridMinimum ();
+  const Eigen::Vector3i& grid_dims = distance_field_->getGridDimensions ();
+  grid.min = make_float3 (grid_min[0], grid_min[1], grid_min[2]);
+  grid.dims = make_int3 (grid_dims[0], grid_dims[1], grid_dims[2]);
+  grid.inv_resolution = 1.f / distance_field_->getResolution ();
+  grid.max_distance_sqr = (maximum_distance_ < std::numeric_limits<float>::max () ?
+                           static_cast<float> (maximum_distance_ * maximum_distance_) :
+                           std::numeric_limits<float>::max ());
+
+  const std::size_t nr_particles = particles_->size ();
+  transforms_host_.resize (nr_particles * 12);
+  for (std::size_t i = 0; i < nr_particles; ++i)
+  {
+    const Eigen::Affine3f trans = (*particles_)[i].toEigenMatrix ();
+    for (int row = 0; row < 3; ++row)
+      for (int col = 0; col < 4; ++col)
+        transforms_host_[i * 12 + row * 4 + col] = trans (row, col);
+  }
+  transforms_device_.upload (transforms_host_);
+  weights_device_.create (nr_particles);
+
+  computeWeights ((const DeviceArray<float4>&)ref_device_, (const DeviceArray<float4>&)scene_device_,
+                  nearest_indices_device_, grid, static_cast<float> (distance_coherence_->getWeight ()),
+                  transforms_device_, weights_device_);
+
+  weights_device_.download (weights_host_);
+  for (std::size_t i = 0; i < nr_particles; ++i)
+    (*particles_)[i].weight = weights_host_[i];
+
+  normalizeWeight ();
+}
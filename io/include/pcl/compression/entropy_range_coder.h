@@ -170,6 +170,105 @@ namespace pcl
       std::vector<char> outputCharVector_;
 
   };
+
+  //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+  /** \brief @b RansCoder compression class
+   *  \note This class provides static entropy coding with four interleaved range asymmetric numeral system (rANS)
+   *  \note states. Its symbol frequency table is precomputed, normalized to a power of two and encoded to the output
+   *  \note stream, so that decoding a symbol is a single table lookup instead of a search over cumulative frequencies.
+   *  \note The interleaved states have independent dependency chains that the CPU executes concurrently.
+   *  \note Streams are not compatible with StaticRangeCoder.
+   */
+  //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+  class RansCoder
+  {
+    public:
+      /** \brief Empty constructor. */
+      RansCoder ()
+      {
+      }
+
+      /** \brief Empty deconstructor. */
+      virtual
+      ~RansCoder ()
+      {
+      }
+
+      /** \brief Encode integer vector to output stream
+        * \note Values that do not fit the coder alphabet are escaped and stored uncompressed.
+        * \param[in] inputIntVector_arg input vector
+        * \param[out] outputByterStream_arg output stream containing compressed data
+        * \return amount of bytes written to output stream
+        */
+      unsigned long
+      encodeIntVectorToStream (std::vector<unsigned int>& inputIntVector_arg, std::ostream& outputByterStream_arg);
+
+      /** \brief Decode stream to output integer vector
+       * \param inputByteStream_arg input stream of compressed data
+       * \param outputIntVector_arg decompressed output vector
+       * \return amount of bytes read from input stream
+       */
+      unsigned long
+      decodeStreamToIntVector (std::istream& inputByteStream_arg, std::vector<unsigned int>& outputIntVector_arg);
+
+      /** \brief Encode char vector to output stream
+       * \param inputByteVector_arg input vector
+       * \param outputByteStream_arg output stream containing compressed data
+       * \return amount of bytes written to output stream
+       */
+      unsigned long
+      encodeCharVectorToStream (const std::vector<char>& inputByteVector_arg, std::ostream& outputByteStream_arg);
+
+      /** \brief Decode char stream to output vector
+       * \param inputByteStream_arg input stream of compressed data
+       * \param outputByteVector_arg decompressed output vector
+       * \return amount of bytes read from input stream
+       */
+      unsigned long
+      decodeStreamToCharVector (std::istream& inputByteStream_arg, std::vector<char>& outputByteVector_arg);
+
+    protected:
+      using DWord = std::uint32_t; // 4 bytes
+
+      /** \brief Number of interleaved rANS states. */
+      static const unsigned int nr_states_ = 4;
+
+    private:
+      /** \brief Scale a symbol histogram so that its frequencies sum up to 2^scale_bits, keeping all used symbols.
+        * \param[in,out] freq symbol histogram, replaced by the normalized frequencies
+        * \param[in] scale_bits precision of the normalized frequencies
+        */
+      static void
+      normalizeFrequencies (std::vector<DWord>& freq, unsigned int scale_bits);
+
+      /** \brief Encode symbols with the interleaved states and write the states and the coded bytes to the stream
+        * \param[in] symbols input symbols, each an index into freq
+        * \param[in] freq normalized symbol frequencies
+        * \param[in] scale_bits precision of the normalized frequencies
+        * \param[out] outputByteStream_arg output stream
+        * \return amount of bytes written to output stream
+        */
+      template <typename SymbolT> unsigned long
+      encodeSymbols (const std::vector<SymbolT>& symbols, const std::vector<DWord>& freq, unsigned int scale_bits,
+                     std::ostream& outputByteStream_arg);
+
+      /** \brief Decode symbols written by encodeSymbols (), filling the whole output vector
+        * \param[in] inputByteStream_arg input stream
+        * \param[in] freq normalized symbol frequencies
+        * \param[in] scale_bits precision of the normalized frequencies
+        * \param[out] symbols decoded symbols
+        * \return amount of bytes read from input stream
+        */
+      template <typename SymbolT> unsigned long
+      decodeSymbols (std::istream& inputByteStream_arg, const std::vector<DWord>& freq, unsigned int scale_bits,
+                     std::vector<SymbolT>& symbols);
+
+      /** \brief Vector containing compressed data. */
+      std::vector<std::uint8_t> outputCharVector_;
+
+      /** \brief Vector mapping each slot of the normalized frequency range to its symbol. */
+      std::vector<std::uint16_t> symbolLookup_;
+  };
 }
 
 
@@ -43,10 +43,12 @@
 #define __PCL_IO_RANGECODING__HPP
 
 #include <pcl/compression/entropy_range_coder.h>
+#include <pcl/console/print.h>
 #include <iostream>
 #include <vector>
 #include <cstring>
 #include <algorithm>
+#include <type_traits>
 
 //////////////////////////////////////////////////////////////////////////////////////////////
 unsigned long
@@ -620,5 +622,281 @@ pcl::StaticRangeCoder::decodeStreamToCharVector (std::istream& inputByteStream_a
   return (streamByteCount);
 }
 
-#endif
+//////////////////////////////////////////////////////////////////////////////////////////////
+void
+pcl::RansCoder::normalizeFrequencies (std::vector<DWord>& freq, unsigned int scale_bits)
+{
+  const DWord scale = static_cast<DWord> (1) << scale_bits;
+
+  std::uint64_t total = 0;
+  for (const DWord f : freq)
+    total += f;
+  if (total == 0)
+    return;
+
+  // scale, keeping a frequency of at least one for every used symbol
+  std::uint64_t sum = 0;
+  for (DWord& f : freq)
+  {
+    if (f > 0)
+      f = std::max<DWord> (1, static_cast<DWord> (static_cast<std::uint64_t> (f) * scale / total));
+    sum += f;
+  }
+
+  // hand the rounding error to the most frequent symbols
+  while (sum != scale)
+  {
+    DWord& f_max = *std::max_element (freq.begin (), freq.end ());
+    if (sum < scale)
+    {
+      f_max += static_cast<DWord> (scale - sum);
+      sum = scale;
+    }
+    else
+    {
+      const DWord delta = static_cast<DWord> (std::min<std::uint64_t> (sum - scale, f_max - 1));
+      f_max -= delta;
+      sum -= delta;
+    }
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename SymbolT> unsigned long
+pcl::RansCoder::encodeSymbols (const std::vector<SymbolT>& symbols, const std::vector<DWord>& freq,
+                               unsigned int scale_bits, std::ostream& outputByteStream_arg)
+{
+  using UnsignedSymbolT = typename std::make_unsigned<SymbolT>::type;
+
+  // lower bound of the normalized state interval
+  const DWord lower = static_cast<DWord> (1) << 23;
+
+  // cumulative frequency table
+  std::vector<DWord> cFreq (freq.size () + 1, 0);
+  for (std::size_t f = 0; f < freq.size (); f++)
+    cFreq[f + 1] = cFreq[f] + freq[f];
+
+  // a symbol costs at most scale_bits bits, bytes are emitted back to front
+  outputCharVector_.resize (symbols.size () * ((scale_bits + 7) / 8) + 1);
+  std::uint8_t* const end = outputCharVector_.data () + outputCharVector_.size ();
+  std::uint8_t* ptr = end;
+
+  DWord states[nr_states_];
+  for (DWord& state : states)
+    state = lower;
+
+  // encode in reverse, so that the decoder reads forward
+  for (std::size_t i = symbols.size (); i-- > 0;)
+  {
+    const std::size_t symbol = static_cast<UnsignedSymbolT> (symbols[i]);
+    const DWord f = freq[symbol];
+    DWord& x = states[i % nr_states_];
+
+    // renormalize
+    const DWord x_max = ((lower >> scale_bits) << 8) * f;
+    while (x >= x_max)
+    {
+      *--ptr = static_cast<std::uint8_t> (x & 0xff);
+      x >>= 8;
+    }
+
+    x = ((x / f) << scale_bits) + (x % f) + cFreq[symbol];
+  }
+
+  // write final states and encoded data to stream
+  const DWord byte_count = static_cast<DWord> (end - ptr);
+  outputByteStream_arg.write (reinterpret_cast<const char*> (states), sizeof(states));
+  outputByteStream_arg.write (reinterpret_cast<const char*> (&byte_count), sizeof(byte_count));
+  outputByteStream_arg.write (reinterpret_cast<const char*> (ptr), byte_count);
+
+  return (static_cast<unsigned long> (sizeof(states) + sizeof(byte_count) + byte_count));
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename SymbolT> unsigned long
+pcl::RansCoder::decodeSymbols (std::istream& inputByteStream_arg, const std::vector<DWord>& freq,
+                               unsigned int scale_bits, std::vector<SymbolT>& symbols)
+{
+  const DWord lower = static_cast<DWord> (1) << 23;
+  const DWord mask = (static_cast<DWord> (1) << scale_bits) - 1;
+
+  // cumulative frequency table and slot to symbol lookup
+  std::vector<DWord> cFreq (freq.size () + 1, 0);
+  symbolLookup_.resize (static_cast<std::size_t> (mask) + 1);
+  for (std::size_t f = 0; f < freq.size (); f++)
+  {
+    cFreq[f + 1] = std::min<DWord> (cFreq[f] + freq[f], mask + 1);
+    std::fill (symbolLookup_.begin () + cFreq[f], symbolLookup_.begin () + cFreq[f + 1], static_cast<std::uint16_t> (f));
+  }
+
+  // read final encoder states and encoded data
+  DWord states[nr_states_];
+  DWord byte_count = 0;
+  inputByteStream_arg.read (reinterpret_cast<char*> (states), sizeof(states));
+  inputByteStream_arg.read (reinterpret_cast<char*> (&byte_count), sizeof(byte_count));
+  outputCharVector_.resize (byte_count);
+  inputByteStream_arg.read (reinterpret_cast<char*> (outputCharVector_.data ()), byte_count);
+
+  unsigned long streamByteCount = sizeof(states) + sizeof(byte_count) + byte_count;
+
+  // every slot has to map to a symbol
+  const std::size_t output_size = symbols.size ();
+  if (output_size > 0 && cFreq.back () != mask + 1)
+  {
+    PCL_ERROR ("[pcl::RansCoder::decodeSymbols] Corrupted frequency table\n");
+    return (streamByteCount);
+  }
+
+  const std::uint8_t* ptr = outputCharVector_.data ();
+  const std::uint8_t* const end = ptr + outputCharVector_.size ();
+
+  // decoding
+  for (std::size_t i = 0; i < output_size; i++)
+  {
+    DWord& x = states[i % nr_states_];
+
+    // symbol lookup
+    const DWord slot = x & mask;
+    const std::uint16_t symbol = symbolLookup_[slot];
+    symbols[i] = static_cast<SymbolT> (symbol);
+
+    x = freq[symbol] * (x >> scale_bits) + slot - cFreq[symbol];
+
+    // renormalize
+    while (x < lower && ptr < end)
+      x = (x << 8) | *ptr++;
+  }
 
+  return (streamByteCount);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+unsigned long
+pcl::RansCoder::encodeIntVectorToStream (std::vector<unsigned int>& inputIntVector_arg,
+                                         std::ostream& outputByteStream_arg)
+{
+  // values from the escape symbol on are stored uncompressed after the frequency table
+  const unsigned int scale_bits = 15;
+  const std::uint16_t escapeSymbol = 4095;
+
+  std::vector<std::uint16_t> symbols (inputIntVector_arg.size ());
+  std::vector<DWord> escapes;
+  std::vector<DWord> freq (escapeSymbol + 1, 0);
+  std::uint16_t alphabetSize = 0;
+  for (std::size_t i = 0; i < inputIntVector_arg.size (); i++)
+  {
+    const unsigned int value = inputIntVector_arg[i];
+    const std::uint16_t symbol = static_cast<std::uint16_t> (std::min<unsigned int> (value, escapeSymbol));
+    if (symbol == escapeSymbol)
+      escapes.push_back (value);
+    symbols[i] = symbol;
+    alphabetSize = std::max<std::uint16_t> (alphabetSize, static_cast<std::uint16_t> (symbol + 1));
+    freq[symbol]++;
+  }
+  freq.resize (alphabetSize);
+  normalizeFrequencies (freq, scale_bits);
+
+  // write frequency table and escaped values to output stream
+  const DWord escapeCount = static_cast<DWord> (escapes.size ());
+  outputByteStream_arg.write (reinterpret_cast<const char*> (&alphabetSize), sizeof(alphabetSize));
+  for (const DWord f : freq)
+  {
+    const std::uint16_t f16 = static_cast<std::uint16_t> (f);
+    outputByteStream_arg.write (reinterpret_cast<const char*> (&f16), sizeof(f16));
+  }
+  outputByteStream_arg.write (reinterpret_cast<const char*> (&escapeCount), sizeof(escapeCount));
+  if (escapeCount)
+    outputByteStream_arg.write (reinterpret_cast<const char*> (escapes.data ()), sizeof(DWord) * escapeCount);
+
+  unsigned long streamByteCount = sizeof(alphabetSize) + sizeof(std::uint16_t) * alphabetSize +
+                                  sizeof(escapeCount) + sizeof(DWord) * escapeCount;
+
+  streamByteCount += encodeSymbols (symbols, freq, scale_bits, outputByteStream_arg);
+
+  return (streamByteCount);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+unsigned long
+pcl::RansCoder::decodeStreamToIntVector (std::istream& inputByteStream_arg,
+                                         std::vector<unsigned int>& outputIntVector_arg)
+{
+  const unsigned int scale_bits = 15;
+  const std::uint16_t escapeSymbol = 4095;
+
+  // read frequency table and escaped values
+  std::uint16_t alphabetSize = 0;
+  inputByteStream_arg.read (reinterpret_cast<char*> (&alphabetSize), sizeof(alphabetSize));
+  std::vector<DWord> freq (alphabetSize);
+  for (DWord& f : freq)
+  {
+    std::uint16_t f16 = 0;
+    inputByteStream_arg.read (reinterpret_cast<char*> (&f16), sizeof(f16));
+    f = f16;
+  }
+  DWord escapeCount = 0;
+  inputByteStream_arg.read (reinterpret_cast<char*> (&escapeCount), sizeof(escapeCount));
+  std::vector<DWord> escapes (escapeCount);
+  if (escapeCount)
+    inputByteStream_arg.read (reinterpret_cast<char*> (escapes.data ()), sizeof(DWord) * escapeCount);
+
+  unsigned long streamByteCount = sizeof(alphabetSize) + sizeof(std::uint16_t) * alphabetSize +
+                                  sizeof(escapeCount) + sizeof(DWord) * escapeCount;
+
+  streamByteCount += decodeSymbols (inputByteStream_arg, freq, scale_bits, outputIntVector_arg);
+
+  // restore escaped values
+  std::size_t escapePos = 0;
+  for (unsigned int& value : outputIntVector_arg)
+    if (value == escapeSymbol && escapePos < escapes.size ())
+      value = escapes[escapePos++];
+
+  return (streamByteCount);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+unsigned long
+pcl::RansCoder::encodeCharVectorToStream (const std::vector<char>& inputByteVector_arg,
+                                          std::ostream& outputByteStream_arg)
+{
+  const unsigned int scale_bits = 14;
+
+  // calculate frequency table
+  std::vector<DWord> freq (256, 0);
+  for (const char ch : inputByteVector_arg)
+    freq[static_cast<std::uint8_t> (ch)]++;
+  normalizeFrequencies (freq, scale_bits);
+
+  // write frequency table to output stream
+  std::uint16_t freq16[256];
+  for (std::size_t f = 0; f < 256; f++)
+    freq16[f] = static_cast<std::uint16_t> (freq[f]);
+  outputByteStream_arg.write (reinterpret_cast<const char*> (freq16), sizeof(freq16));
+
+  unsigned long streamByteCount = sizeof(freq16);
+
+  streamByteCount += encodeSymbols (inputByteVector_arg, freq, scale_bits, outputByteStream_arg);
+
+  return (streamByteCount);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+unsigned long
+pcl::RansCoder::decodeStreamToCharVector (std::istream& inputByteStream_arg,
+                                          std::vector<char>& outputByteVector_arg)
+{
+  const unsigned int scale_bits = 14;
+
+  // read frequency table
+  std::uint16_t freq16[256];
+  inputByteStream_arg.read (reinterpret_cast<char*> (freq16), sizeof(freq16));
+  const std::vector<DWord> freq (freq16, freq16 + 256);
+
+  unsigned long streamByteCount = sizeof(freq16);
+
+  streamByteCount += decodeSymbols (inputByteStream_arg, freq, scale_bits, outputByteVector_arg);
+
+  return (streamByteCount);
+}
+
+#endif
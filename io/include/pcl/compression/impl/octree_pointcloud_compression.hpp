@@ -38,10 +38,14 @@
 #ifndef OCTREE_COMPRESSION_HPP
 #define OCTREE_COMPRESSION_HPP
 
+#include <pcl/common/execution_context.h>
 #include <pcl/common/io.h> // for getFieldIndex
 #include <pcl/compression/entropy_range_coder.h>
 
+#include <algorithm>
 #include <iostream>
+#include <sstream>
+#include <string>
 #include <vector>
 #include <cstring>
 
@@ -129,7 +133,10 @@ namespace pcl
         this->writeFrameHeader (compressed_tree_data_out_arg);
 
         // apply entropy coding to the content of all data vectors and send data to output stream
-        this->entropyEncoding (compressed_tree_data_out_arg);
+        if (threads_ != 1 || entropy_coder_type_ == RANS_CODER)
+          this->entropyEncodingIndexed (compressed_tree_data_out_arg);
+        else
+          this->entropyEncoding (compressed_tree_data_out_arg);
 
         // prepare for next frame
         this->switchBuffers ();
@@ -201,7 +208,10 @@ namespace pcl
       this->readFrameHeader (compressed_tree_data_in_arg);
 
       // decode data vectors from stream
-      this->entropyDecoding (compressed_tree_data_in_arg);
+      if (indexed_frame_)
+        this->entropyDecodingIndexed (compressed_tree_data_in_arg);
+      else
+        this->entropyDecoding (compressed_tree_data_in_arg);
 
       // initialize color and point encoding
       color_coder_.initializeDecoding ();
@@ -364,12 +374,219 @@ namespace pcl
       }
     }
 
+    //////////////////////////////////////////////////////////////////////////////////////////////
+    template<typename PointT, typename LeafT, typename BranchT, typename OctreeT> void
+    OctreePointCloudCompression<PointT, LeafT, BranchT, OctreeT>::entropyEncodingIndexed (std::ostream& compressed_tree_data_out_arg)
+    {
+      // Identifiers of the data vectors, in the order of entropyEncoding ()
+      enum { TREE, AVG_COLOR, POINT_COUNT, POINT_DIFF, COLOR_DIFF };
+
+      struct Block
+      {
+        std::uint8_t vector_id;
+        std::uint64_t begin;
+        std::uint64_t end;
+        std::string data;
+      };
+
+      // Blocks of at least 64k symbols, so that the frequency tables stay small compared to the data.
+      // The blocks are part of the stream, so they follow the requested number of threads.
+      const pcl::ThreadReservation reservation (threads_);
+      const unsigned int threads = reservation.getNumberOfThreads ();
+      const std::size_t nr_block_threads = (threads_ != 0) ? threads_ : threads;
+      const std::size_t min_block_size = 1 << 16;
+      std::vector<Block> blocks;
+      auto addBlocks = [&] (std::uint8_t vector_id, std::size_t size)
+      {
+        const std::size_t nr_blocks = std::max<std::size_t> (1, std::min<std::size_t> (nr_block_threads, size / min_block_size));
+        for (std::size_t i = 0; i < nr_blocks; i++)
+          blocks.push_back (Block {vector_id, size * i / nr_blocks, size * (i + 1) / nr_blocks, std::string ()});
+      };
+
+      addBlocks (TREE, binary_tree_data_vector_.size ());
+      if (cloud_with_color_)
+        addBlocks (AVG_COLOR, color_coder_.getAverageDataVector ().size ());
+      if (!do_voxel_grid_enDecoding_)
+      {
+        addBlocks (POINT_COUNT, point_count_data_vector_.size ());
+        addBlocks (POINT_DIFF, point_coder_.getDifferentialDataVector ().size ());
+        if (cloud_with_color_)
+          addBlocks (COLOR_DIFF, color_coder_.getDifferentialDataVector ().size ());
+      }
+
+      // Each block is coded by its own entropy coder
+      auto encodeBlock = [this] (auto &coder, Block &block)
+      {
+        std::ostringstream stream;
+        if (block.vector_id == POINT_COUNT)
+        {
+          std::vector<unsigned int> symbols (point_count_data_vector_.begin () + block.begin, point_count_data_vector_.begin () + block.end);
+          coder.encodeIntVectorToStream (symbols, stream);
+        }
+        else
+        {
+          const std::vector<char>& vector = (block.vector_id == TREE) ? binary_tree_data_vector_ :
+                                            (block.vector_id == AVG_COLOR) ? color_coder_.getAverageDataVector () :
+                                            (block.vector_id == POINT_DIFF) ? point_coder_.getDifferentialDataVector () :
+                                            color_coder_.getDifferentialDataVector ();
+          const std::vector<char> symbols (vector.begin () + block.begin, vector.begin () + block.end);
+          coder.encodeCharVectorToStream (symbols, stream);
+        }
+        block.data = stream.str ();
+      };
+
+#pragma omp parallel for \
+  default(none) \
+  shared(blocks, encodeBlock) \
+  schedule(dynamic, 1) \
+  num_threads(threads)
+      for (std::ptrdiff_t b = 0; b < static_cast<std::ptrdiff_t> (blocks.size ()); b++)
+      {
+        if (entropy_coder_type_ == RANS_CODER)
+        {
+          RansCoder coder;
+          encodeBlock (coder, blocks[b]);
+        }
+        else
+        {
+          StaticRangeCoder coder;
+          encodeBlock (coder, blocks[b]);
+        }
+      }
+
+      // Index: number of blocks, then the vector, number of symbols and compressed size of each block
+      compressed_point_data_len_ = 0;
+      compressed_color_data_len_ = 0;
+      const std::uint32_t nr_blocks = static_cast<std::uint32_t> (blocks.size ());
+      compressed_tree_data_out_arg.write (reinterpret_cast<const char*> (&nr_blocks), sizeof (nr_blocks));
+      for (const auto &block : blocks)
+      {
+        const std::uint64_t nr_symbols = block.end - block.begin;
+        const std::uint64_t nr_bytes = block.data.size ();
+        compressed_tree_data_out_arg.write (reinterpret_cast<const char*> (&block.vector_id), sizeof (block.vector_id));
+        compressed_tree_data_out_arg.write (reinterpret_cast<const char*> (&nr_symbols), sizeof (nr_symbols));
+        compressed_tree_data_out_arg.write (reinterpret_cast<const char*> (&nr_bytes), sizeof (nr_bytes));
+
+        if (block.vector_id == AVG_COLOR || block.vector_id == COLOR_DIFF)
+          compressed_color_data_len_ += nr_bytes;
+        else
+          compressed_point_data_len_ += nr_bytes;
+      }
+      for (const auto &block : blocks)
+        compressed_tree_data_out_arg.write (block.data.data (), block.data.size ());
+
+      // flush output stream
+      compressed_tree_data_out_arg.flush ();
+    }
+
+    //////////////////////////////////////////////////////////////////////////////////////////////
+    template<typename PointT, typename LeafT, typename BranchT, typename OctreeT> void
+    OctreePointCloudCompression<PointT, LeafT, BranchT, OctreeT>::entropyDecodingIndexed (std::istream& compressed_tree_data_in_arg)
+    {
+      enum { TREE, AVG_COLOR, POINT_COUNT, POINT_DIFF, COLOR_DIFF, NR_VECTORS };
+
+      struct Block
+      {
+        std::uint8_t vector_id;
+        std::uint64_t begin;
+        std::uint64_t nr_symbols;
+        std::string data;
+      };
+
+      compressed_point_data_len_ = 0;
+      compressed_color_data_len_ = 0;
+
+      // Read the index; blocks of a vector follow each other, so their offsets are the running sizes
+      std::uint32_t nr_blocks = 0;
+      compressed_tree_data_in_arg.read (reinterpret_cast<char*> (&nr_blocks), sizeof (nr_blocks));
+      std::vector<Block> blocks (nr_blocks);
+      std::vector<std::uint64_t> nr_bytes (nr_blocks);
+      std::uint64_t vector_sizes[NR_VECTORS] = {0, 0, 0, 0, 0};
+      for (std::uint32_t b = 0; b < nr_blocks; b++)
+      {
+        compressed_tree_data_in_arg.read (reinterpret_cast<char*> (&blocks[b].vector_id), sizeof (blocks[b].vector_id));
+        compressed_tree_data_in_arg.read (reinterpret_cast<char*> (&blocks[b].nr_symbols), sizeof (blocks[b].nr_symbols));
+        compressed_tree_data_in_arg.read (reinterpret_cast<char*> (&nr_bytes[b]), sizeof (nr_bytes[b]));
+        if (!compressed_tree_data_in_arg || blocks[b].vector_id >= NR_VECTORS)
+        {
+          PCL_ERROR ("[pcl::io::OctreePointCloudCompression::entropyDecodingIndexed] Corrupted block index\n");
+          return;
+        }
+
+        blocks[b].begin = vector_sizes[blocks[b].vector_id];
+        vector_sizes[blocks[b].vector_id] += blocks[b].nr_symbols;
+
+        if (blocks[b].vector_id == AVG_COLOR || blocks[b].vector_id == COLOR_DIFF)
+          compressed_color_data_len_ += nr_bytes[b];
+        else
+          compressed_point_data_len_ += nr_bytes[b];
+      }
+      for (std::uint32_t b = 0; b < nr_blocks; b++)
+      {
+        blocks[b].data.resize (static_cast<std::size_t> (nr_bytes[b]));
+        compressed_tree_data_in_arg.read (&blocks[b].data[0], nr_bytes[b]);
+      }
+
+      binary_tree_data_vector_.resize (static_cast<std::size_t> (vector_sizes[TREE]));
+      color_coder_.getAverageDataVector ().resize (static_cast<std::size_t> (vector_sizes[AVG_COLOR]));
+      point_count_data_vector_.resize (static_cast<std::size_t> (vector_sizes[POINT_COUNT]));
+      point_coder_.getDifferentialDataVector ().resize (static_cast<std::size_t> (vector_sizes[POINT_DIFF]));
+      color_coder_.getDifferentialDataVector ().resize (static_cast<std::size_t> (vector_sizes[COLOR_DIFF]));
+
+      // Each block is decoded by its own entropy coder, into its range of the data vector
+      const pcl::ThreadReservation reservation (threads_);
+      const unsigned int threads = reservation.getNumberOfThreads ();
+      auto decodeBlock = [this] (auto &coder, const Block &block)
+      {
+        std::istringstream stream (block.data);
+        if (block.vector_id == POINT_COUNT)
+        {
+          std::vector<unsigned int> symbols (static_cast<std::size_t> (block.nr_symbols));
+          coder.decodeStreamToIntVector (stream, symbols);
+          std::copy (symbols.begin (), symbols.end (), point_count_data_vector_.begin () + block.begin);
+        }
+        else
+        {
+          std::vector<char>& vector = (block.vector_id == TREE) ? binary_tree_data_vector_ :
+                                      (block.vector_id == AVG_COLOR) ? color_coder_.getAverageDataVector () :
+                                      (block.vector_id == POINT_DIFF) ? point_coder_.getDifferentialDataVector () :
+                                      color_coder_.getDifferentialDataVector ();
+          std::vector<char> symbols (static_cast<std::size_t> (block.nr_symbols));
+          coder.decodeStreamToCharVector (stream, symbols);
+          std::copy (symbols.begin (), symbols.end (), vector.begin () + block.begin);
+        }
+      };
+
+#pragma omp parallel for \
+  default(none) \
+  shared(blocks, decodeBlock) \
+  schedule(dynamic, 1) \
+  num_threads(threads)
+      for (std::ptrdiff_t b = 0; b < static_cast<std::ptrdiff_t> (blocks.size ()); b++)
+      {
+        if (frame_entropy_coder_type_ == RANS_CODER)
+        {
+          RansCoder coder;
+          decodeBlock (coder, blocks[b]);
+        }
+        else
+        {
+          StaticRangeCoder coder;
+          decodeBlock (coder, blocks[b]);
+        }
+      }
+
+      point_count_data_vector_iterator_ = point_count_data_vector_.begin ();
+    }
+
     //////////////////////////////////////////////////////////////////////////////////////////////
     template<typename PointT, typename LeafT, typename BranchT, typename OctreeT> void
     OctreePointCloudCompression<PointT, LeafT, BranchT, OctreeT>::writeFrameHeader (std::ostream& compressed_tree_data_out_arg)
     {
       // encode header identifier
-      compressed_tree_data_out_arg.write (reinterpret_cast<const char*> (frame_header_identifier_), strlen (frame_header_identifier_));
+      const char* identifier = (entropy_coder_type_ == RANS_CODER) ? rans_frame_header_identifier_ :
+                               (threads_ != 1) ? indexed_frame_header_identifier_ : frame_header_identifier_;
+      compressed_tree_data_out_arg.write (identifier, strlen (identifier));
       // encode point cloud header id
       compressed_tree_data_out_arg.write (reinterpret_cast<const char*> (&frame_ID_), sizeof (frame_ID_));
       // encode frame type (I/P-frame)
@@ -415,14 +632,24 @@ namespace pcl
     template<typename PointT, typename LeafT, typename BranchT, typename OctreeT> void
     OctreePointCloudCompression<PointT, LeafT, BranchT, OctreeT>::syncToHeader ( std::istream& compressed_tree_data_in_arg)
     {
-      // sync to frame header
-      unsigned int header_id_pos = 0;
-      while (header_id_pos < strlen (frame_header_identifier_))
+      // sync to the header of a serial or an indexed frame
+      const char* identifiers[3] = {frame_header_identifier_, indexed_frame_header_identifier_, rans_frame_header_identifier_};
+      unsigned int header_id_pos[3] = {0, 0, 0};
+      while (compressed_tree_data_in_arg.good ())
       {
         char readChar;
         compressed_tree_data_in_arg.read (static_cast<char*> (&readChar), sizeof (readChar));
-        if (readChar != frame_header_identifier_[header_id_pos++])
-          header_id_pos = (frame_header_identifier_[0]==readChar)?1:0;
+        for (int i = 0; i < 3; i++)
+        {
+          if (readChar != identifiers[i][header_id_pos[i]++])
+            header_id_pos[i] = (identifiers[i][0]==readChar)?1:0;
+          if (header_id_pos[i] == strlen (identifiers[i]))
+          {
+            indexed_frame_ = (i != 0);
+            frame_entropy_coder_type_ = (i == 2) ? RANS_CODER : STATIC_RANGE_CODER;
+            return;
+          }
+        }
       }
     }
 
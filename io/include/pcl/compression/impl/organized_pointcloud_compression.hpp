@@ -39,6 +39,7 @@
 #define ORGANIZED_COMPRESSION_HPP
 
 #include <pcl/compression/organized_pointcloud_compression.h>
+#include <pcl/common/execution_context.h>
 
 #include <pcl/pcl_macros.h>
 #include <pcl/point_cloud.h>
@@ -46,8 +47,9 @@
 #include <pcl/compression/libpng_wrapper.h>
 #include <pcl/compression/organized_pointcloud_conversion.h>
 
-#include <vector>
 #include <cassert>
+#include <future>
+#include <vector>
 
 namespace pcl
 {
@@ -62,6 +64,9 @@ namespace pcl
                                                               bool bShowStatistics_arg,
                                                               int pngLevel_arg)
     {
+      const pcl::ThreadReservation reservation (threads_);
+      const unsigned int threads = reservation.getNumberOfThreads ();
+
       std::uint32_t cloud_width = cloud_arg->width;
       std::uint32_t cloud_height = cloud_arg->height;
 
@@ -100,7 +105,25 @@ namespace pcl
       std::uint32_t compressedColorSize = 0;
 
       // Convert point cloud to disparity and rgb image
-      OrganizedConversion<PointT>::convert (*cloud_arg, focalLength, disparityShift, disparityScale, convertToMono,  disparityData, colorData);
+      OrganizedConversion<PointT>::convert (*cloud_arg, focalLength, disparityShift, disparityScale, convertToMono,  disparityData, colorData, threads);
+
+      // Compress color information, concurrently to the disparity information
+      const auto encodeColor = [&] ()
+      {
+        if (CompressionPointTraits<PointT>::hasColor && doColorEncoding)
+        {
+          if (convertToMono)
+          {
+            encodeMonoImageToPNG (colorData, cloud_width, cloud_height, compressedColor, 1 /*Z_BEST_SPEED*/);
+          } else
+          {
+            encodeRGBImageToPNG (colorData, cloud_width, cloud_height, compressedColor, 1 /*Z_BEST_SPEED*/);
+          }
+        }
+      };
+      std::future<void> colorEncoding;
+      if (threads > 1)
+        colorEncoding = std::async (std::launch::async, encodeColor);
 
       // Compress disparity information
       encodeMonoImageToPNG (disparityData, cloud_width, cloud_height, compressedDisparity, pngLevel_arg);
@@ -111,17 +134,10 @@ namespace pcl
       // Output compressed disparity to ostream
       compressedDataOut_arg.write (reinterpret_cast<const char*> (&compressedDisparity[0]), compressedDisparity.size () * sizeof(std::uint8_t));
 
-      // Compress color information
-      if (CompressionPointTraits<PointT>::hasColor && doColorEncoding)
-      {
-        if (convertToMono)
-        {
-          encodeMonoImageToPNG (colorData, cloud_width, cloud_height, compressedColor, 1 /*Z_BEST_SPEED*/);
-        } else
-        {
-          encodeRGBImageToPNG (colorData, cloud_width, cloud_height, compressedColor, 1 /*Z_BEST_SPEED*/);
-        }
-      }
+      if (colorEncoding.valid ())
+        colorEncoding.get ();
+      else
+        encodeColor ();
 
       compressedColorSize = static_cast<std::uint32_t>(compressedColor.size ());
       // Encode size of compressed Color image data
@@ -162,6 +178,9 @@ namespace pcl
                                                                                   float disparityShift_arg,
                                                                                   float disparityScale_arg)
     {
+       const pcl::ThreadReservation reservation (threads_);
+       const unsigned int threads = reservation.getNumberOfThreads ();
+
        float maxDepth = -1;
 
        std::size_t cloud_size = width_arg*height_arg;
@@ -194,15 +213,50 @@ namespace pcl
        std::uint32_t compressedColorSize = 0;
 
        // Remove color information of invalid points
-       std::uint16_t* depth_ptr = &disparityMap_arg[0];
-       std::uint8_t* color_ptr = &colorImage_arg[0];
-
-       for (std::size_t i = 0; i < cloud_size; ++i, ++depth_ptr, color_ptr += sizeof(std::uint8_t) * 3)
+       if (!colorImage_arg.empty ())
        {
-         if (!(*depth_ptr) || (*depth_ptr==0x7FF))
-           memset(color_ptr, 0, sizeof(std::uint8_t)*3);
+         const std::ptrdiff_t nr_pixels = cloud_size;
+#pragma omp parallel for \
+  default(none) \
+  shared(colorImage_arg, disparityMap_arg) \
+  firstprivate(nr_pixels) \
+  num_threads(threads)
+         for (std::ptrdiff_t i = 0; i < nr_pixels; ++i)
+         {
+           if (!disparityMap_arg[i] || (disparityMap_arg[i]==0x7FF))
+             memset(&colorImage_arg[i * 3], 0, sizeof(std::uint8_t)*3);
+         }
        }
 
+       // Compress color information, concurrently to the disparity information
+       const auto encodeColor = [&] ()
+       {
+         if (!colorImage_arg.empty () && doColorEncoding)
+         {
+           if (convertToMono)
+           {
+             const std::ptrdiff_t size = width_arg*height_arg;
+             std::vector<std::uint8_t> monoImage (size);
+
+             // grayscale conversion
+             for (std::ptrdiff_t i = 0; i < size; ++i)
+             {
+               monoImage[i] = static_cast<std::uint8_t>(0.2989 * static_cast<float>(colorImage_arg[i*3+0]) +
+                                                        0.5870 * static_cast<float>(colorImage_arg[i*3+1]) +
+                                                        0.1140 * static_cast<float>(colorImage_arg[i*3+2]));
+             }
+             encodeMonoImageToPNG (monoImage, width_arg, height_arg, compressedColor, 1 /*Z_BEST_SPEED*/);
+
+           } else
+           {
+             encodeRGBImageToPNG (colorImage_arg, width_arg, height_arg, compressedColor, 1 /*Z_BEST_SPEED*/);
+           }
+         }
+       };
+       std::future<void> colorEncoding;
+       if (threads > 1)
+         colorEncoding = std::async (std::launch::async, encodeColor);
+
        // Compress disparity information
        encodeMonoImageToPNG (disparityMap_arg, width_arg, height_arg, compressedDisparity, pngLevel_arg);
 
@@ -212,32 +266,10 @@ namespace pcl
        // Output compressed disparity to ostream
        compressedDataOut_arg.write (reinterpret_cast<const char*> (&compressedDisparity[0]), compressedDisparity.size () * sizeof(std::uint8_t));
 
-       // Compress color information
-       if (!colorImage_arg.empty () && doColorEncoding)
-       {
-         if (convertToMono)
-         {
-           std::vector<std::uint8_t> monoImage;
-           std::size_t size = width_arg*height_arg;
-
-           monoImage.reserve(size);
-
-           // grayscale conversion
-           for (std::size_t i = 0; i < size; ++i)
-           {
-             std::uint8_t grayvalue = static_cast<std::uint8_t>(0.2989 * static_cast<float>(colorImage_arg[i*3+0]) +
-                                                      0.5870 * static_cast<float>(colorImage_arg[i*3+1]) +
-                                                      0.1140 * static_cast<float>(colorImage_arg[i*3+2]));
-             monoImage.push_back(grayvalue);
-           }
-           encodeMonoImageToPNG (monoImage, width_arg, height_arg, compressedColor, 1 /*Z_BEST_SPEED*/);
-
-         } else
-         {
-           encodeRGBImageToPNG (colorImage_arg, width_arg, height_arg, compressedColor, 1 /*Z_BEST_SPEED*/);
-         }
-
-       }
+       if (colorEncoding.valid ())
+         colorEncoding.get ();
+       else
+         encodeColor ();
 
        compressedColorSize = static_cast<std::uint32_t>(compressedColor.size ());
        // Encode size of compressed Color image data
@@ -269,6 +301,9 @@ namespace pcl
                                                               PointCloudPtr &cloud_arg,
                                                               bool bShowStatistics_arg)
     {
+      const pcl::ThreadReservation reservation (threads_);
+      const unsigned int threads = reservation.getNumberOfThreads ();
+
       std::uint32_t cloud_width;
       std::uint32_t cloud_height;
       float maxDepth;
@@ -328,11 +363,31 @@ namespace pcl
         compressedColor.resize (compressedColorSize);
         compressedDataIn_arg.read (reinterpret_cast<char*> (&compressedColor[0]), compressedColorSize * sizeof(std::uint8_t));
 
+        // decode PNG compressed rgb data, concurrently to the disparity data
+        std::size_t color_width = 0;
+        std::size_t color_height = 0;
+        unsigned int color_channels = 0;
+        const auto decodeColor = [&] ()
+        {
+          decodePNGToImage (compressedColor, colorData, color_width, color_height, color_channels);
+        };
+        std::future<void> colorDecoding;
+        if (threads > 1 && !compressedColor.empty ())
+          colorDecoding = std::async (std::launch::async, decodeColor);
+
         // decode PNG compressed disparity data
         decodePNGToImage (compressedDisparity, disparityData, png_width, png_height, png_channels);
 
-        // decode PNG compressed rgb data
-        decodePNGToImage (compressedColor, colorData, png_width, png_height, png_channels);
+        if (colorDecoding.valid ())
+          colorDecoding.get ();
+        else
+          decodeColor ();
+        if (!compressedColor.empty ())
+        {
+          png_width = color_width;
+          png_height = color_height;
+          png_channels = color_channels;
+        }
       }
 
       if (disparityShift==0.0f)
@@ -346,7 +401,8 @@ namespace pcl
                                               focalLength,
                                               disparityShift,
                                               disparityScale,
-                                              *cloud_arg);
+                                              *cloud_arg,
+                                              threads);
       } else
       {
 
@@ -360,7 +416,13 @@ namespace pcl
           sd_converter_.generateLookupTable();
 
         // convert shift to depth image
-        for (std::size_t i=0; i<size; ++i)
+        const std::ptrdiff_t nr_pixels = size;
+#pragma omp parallel for \
+  default(none) \
+  shared(depthData, disparityData) \
+  firstprivate(nr_pixels) \
+  num_threads(threads)
+        for (std::ptrdiff_t i=0; i<nr_pixels; ++i)
           depthData[i] = sd_converter_.shiftToDepth(disparityData[i]);
 
         // reconstruct point cloud
@@ -370,7 +432,8 @@ namespace pcl
                                               cloud_width,
                                               cloud_height,
                                               focalLength,
-                                              *cloud_arg);
+                                              *cloud_arg,
+                                              threads);
       }
 
       if (bShowStatistics_arg)
@@ -56,6 +56,10 @@ namespace pcl
   {
     /** \brief @b Octree pointcloud compression class
      *  \note This class enables compression and decompression of point cloud data based on octree data structures.
+     *  \note With setNumberOfThreads () > 1, the data vectors of a frame are split into blocks that are entropy coded
+     *  \note concurrently, each with its own range coder, and written after an index of their sizes. Such frames
+     *  \note start with a distinct identifier and are decoded in parallel as well.
+     *  \note Profiles selecting RANS_CODER always write indexed frames, with blocks coded by RansCoder.
      *  \note
      *  \note typename: PointT: type of point used in pointcloud
      *  \author Julius Kammerl (julius@kammerl.de)
@@ -112,7 +116,8 @@ namespace pcl
           compressed_point_data_len_ (), compressed_color_data_len_ (), selected_profile_(compressionProfile_arg),
           point_resolution_(pointResolution_arg), octree_resolution_(octreeResolution_arg),
           color_bit_resolution_(colorBitResolution_arg),
-          object_count_(0)
+          object_count_(0), threads_ (1), indexed_frame_ (false),
+          entropy_coder_type_ (STATIC_RANGE_CODER), frame_entropy_coder_type_ (STATIC_RANGE_CODER)
         {
           initialization();
         }
@@ -139,6 +144,7 @@ namespace pcl
             point_coder_.setPrecision (static_cast<float> (selectedProfile.pointResolution));
             do_color_encoding_ = selectedProfile.doColorEncoding;
             color_coder_.setBitDepth (selectedProfile.colorBitResolution);
+            entropy_coder_type_ = selectedProfile.entropyCoder;
 
           }
           else 
@@ -185,6 +191,34 @@ namespace pcl
           return (output_);
         }
 
+        /** \brief Set the number of threads used to entropy code the data of a frame. Unless a single thread is set,
+          * frames are written in the indexed format, which older decoders can not read.
+          * \param[in] nr_threads the number of hardware threads to use (0 takes as many as the budget of pcl::ExecutionContext allows when coding)
+          */
+        inline void
+        setNumberOfThreads (unsigned int nr_threads = 0)
+        {
+          // 0 is resolved against the budget of pcl::ExecutionContext at compute time
+          threads_ = nr_threads;
+        }
+
+        /** \brief Set the entropy coder used for encoding, overriding the one of the compression profile.
+          * Frames written with RANS_CODER decode faster, but can not be read by older decoders.
+          * \param[in] entropy_coder the entropy coder
+          */
+        inline void
+        setEntropyCoder (entropyCoder_e entropy_coder)
+        {
+          entropy_coder_type_ = entropy_coder;
+        }
+
+        /** \brief Get the entropy coder used for encoding. */
+        inline entropyCoder_e
+        getEntropyCoder () const
+        {
+          return (entropy_coder_type_);
+        }
+
         /** \brief Encode point cloud to output stream
           * \param cloud_arg:  point cloud to be compressed
           * \param compressed_tree_data_out_arg:  binary output stream containing compressed data
@@ -231,6 +265,18 @@ namespace pcl
         void
         entropyDecoding (std::istream& compressed_tree_data_in_arg);
 
+        /** \brief Entropy encode the data vectors as independent blocks, in parallel, preceded by their index
+          * \param compressed_tree_data_out_arg: binary output stream
+          */
+        void
+        entropyEncodingIndexed (std::ostream& compressed_tree_data_out_arg);
+
+        /** \brief Entropy decoding of the blocks written by entropyEncodingIndexed (), in parallel
+          * \param compressed_tree_data_in_arg: binary input stream
+          */
+        void
+        entropyDecodingIndexed (std::istream& compressed_tree_data_in_arg);
+
         /** \brief Encode leaf node information during serialization
           * \param leaf_arg: reference to new leaf node
           * \param key_arg: octree key of new leaf node
@@ -294,11 +340,35 @@ namespace pcl
 
         std::size_t object_count_;
 
+        /** \brief Number of threads used for entropy coding; frames are indexed when it is larger than 1. */
+        unsigned int threads_;
+
+        /** \brief Whether the frame being decoded is in the indexed format. */
+        bool indexed_frame_;
+
+        /** \brief Entropy coder used for encoding. */
+        entropyCoder_e entropy_coder_type_;
+
+        /** \brief Entropy coder of the indexed frame being decoded. */
+        entropyCoder_e frame_entropy_coder_type_;
+
+        // frame header identifier of indexed frames
+        static const char* indexed_frame_header_identifier_;
+
+        // frame header identifier of indexed frames coded with RansCoder
+        static const char* rans_frame_header_identifier_;
+
       };
 
     // define frame identifier
     template<typename PointT, typename LeafT, typename BranchT, typename OctreeT>
       const char* OctreePointCloudCompression<PointT, LeafT, BranchT, OctreeT>::frame_header_identifier_ = "<PCL-OCT-COMPRESSED>";
+
+    template<typename PointT, typename LeafT, typename BranchT, typename OctreeT>
+      const char* OctreePointCloudCompression<PointT, LeafT, BranchT, OctreeT>::indexed_frame_header_identifier_ = "<PCL-OCT-COMPRESSED-MT>";
+
+    template<typename PointT, typename LeafT, typename BranchT, typename OctreeT>
+      const char* OctreePointCloudCompression<PointT, LeafT, BranchT, OctreeT>::rans_frame_header_identifier_ = "<PCL-OCT-COMPRESSED-RANS>";
   }
 
 }
@@ -60,7 +60,7 @@ namespace pcl
         using PointCloudConstPtr = typename PointCloud::ConstPtr;
 
         /** \brief Empty Constructor. */
-        OrganizedPointCloudCompression ()
+        OrganizedPointCloudCompression () : threads_ (1)
         {
         }
 
@@ -112,6 +112,25 @@ namespace pcl
                                                    float disparityShift_arg = 174.825f,
                                                    float disparityScale_arg = -0.161175f);
 
+        /** \brief Set the number of threads used to convert between point clouds and images, and to code the
+         * disparity and the color image concurrently. The compressed data does not depend on it.
+         * \param[in] nr_threads the number of threads, 0 for as many as the budget of pcl::ExecutionContext allows
+         * when coding (default: 1)
+         */
+        inline void
+        setNumberOfThreads (unsigned int nr_threads = 0)
+        {
+          // 0 is resolved against the budget of pcl::ExecutionContext at compute time
+          threads_ = nr_threads;
+        }
+
+        /** \brief Get the number of threads. */
+        inline unsigned int
+        getNumberOfThreads () const
+        {
+          return (threads_);
+        }
+
         /** \brief Decode point cloud from input stream
          * \param[in] compressedDataIn_arg: binary input stream containing compressed data
          * \param[out] cloud_arg: reference to decoded point cloud
@@ -132,6 +151,9 @@ namespace pcl
                                     float& maxDepth_arg,
                                     float& focalLength_arg) const;
 
+        /** \brief The number of threads. */
+        unsigned int threads_;
+
       private:
         // frame header identifier
         static const char* frameHeaderIdentifier_;
@@ -43,9 +43,10 @@
 #include <pcl/point_cloud.h>
 #include <pcl/common/point_tests.h> // for pcl::isFinite
 
-#include <vector>
-#include <limits>
 #include <cassert>
+#include <cstddef>
+#include <limits>
+#include <vector>
 
 namespace pcl
 {
@@ -88,6 +89,7 @@ struct OrganizedConversion<PointT, false>
     * \param[in] disparityShift_arg disparity shift
     * \param[in] disparityScale_arg disparity scaling
     * \param[out] disparityData_arg output disparity image
+    * \param[in] nr_threads the number of threads
     * \ingroup io
     */
   static void convert(const pcl::PointCloud<PointT>& cloud_arg,
@@ -96,31 +98,30 @@ struct OrganizedConversion<PointT, false>
                       float disparityScale_arg,
                       bool ,
                       typename std::vector<std::uint16_t>& disparityData_arg,
-                      typename std::vector<std::uint8_t>&)
+                      typename std::vector<std::uint8_t>&,
+                      unsigned int nr_threads = 1)
   {
-    const auto cloud_size = cloud_arg.size ();
-
-    // Clear image data
-    disparityData_arg.clear ();
+    const std::ptrdiff_t cloud_size = cloud_arg.size ();
 
-    disparityData_arg.reserve (cloud_size);
+    disparityData_arg.resize (cloud_size);
 
-    for (std::size_t i = 0; i < cloud_size; ++i)
+    // Branch free, so the compiler can vectorize the conversion
+#pragma omp parallel for \
+  default(none) \
+  shared(cloud_arg, disparityData_arg) \
+  firstprivate(cloud_size, focalLength_arg, disparityShift_arg, disparityScale_arg) \
+  num_threads(nr_threads)
+    for (std::ptrdiff_t i = 0; i < cloud_size; ++i)
     {
       // Get point from cloud
       const PointT& point = cloud_arg[i];
 
-      if (pcl::isFinite (point))
-      {
-        // Inverse depth quantization
-        std::uint16_t disparity = static_cast<std::uint16_t> ( focalLength_arg / (disparityScale_arg * point.z) + disparityShift_arg / disparityScale_arg);
-        disparityData_arg.push_back (disparity);
-      }
-      else
-      {
-        // Non-valid points are encoded with zeros
-        disparityData_arg.push_back (0);
-      }
+      // Inverse depth quantization, non-valid points are encoded with zeros
+      const bool valid = pcl::isFinite (point);
+      // Any depth of non-valid points, which are not converted anyway
+      const float z = valid ? point.z : 1.0f;
+      const std::uint16_t disparity = static_cast<std::uint16_t> ( focalLength_arg / (disparityScale_arg * z) + disparityShift_arg / disparityScale_arg);
+      disparityData_arg[i] = valid ? disparity : static_cast<std::uint16_t> (0);
     }
   }
 
@@ -132,6 +133,7 @@ struct OrganizedConversion<PointT, false>
     * \param[in] disparityShift_arg disparity shift
     * \param[in] disparityScale_arg disparity scaling
     * \param[out] cloud_arg output point cloud
+    * \param[in] nr_threads the number of threads
     * \ingroup io
     */
   static void convert(typename std::vector<std::uint16_t>& disparityData_arg,
@@ -142,55 +144,60 @@ struct OrganizedConversion<PointT, false>
                       float focalLength_arg,
                       float disparityShift_arg,
                       float disparityScale_arg,
-                      pcl::PointCloud<PointT>& cloud_arg)
+                      pcl::PointCloud<PointT>& cloud_arg,
+                      unsigned int nr_threads = 1)
   {
-    std::size_t cloud_size = width_arg * height_arg;
+    assert(disparityData_arg.size()==width_arg*height_arg);
 
-    assert(disparityData_arg.size()==cloud_size);
+    // Calculate center of disparity image
+    const std::ptrdiff_t centerX = static_cast<std::ptrdiff_t> (width_arg / 2);
+    const std::ptrdiff_t centerY = static_cast<std::ptrdiff_t> (height_arg / 2);
 
-    // Reset point cloud
+    // Reset point cloud, the pixels from -center to center - 1 are converted
+    const std::ptrdiff_t nr_columns = 2 * centerX;
+    const std::ptrdiff_t nr_points = nr_columns * 2 * centerY;
     cloud_arg.clear ();
-    cloud_arg.reserve (cloud_size);
+    cloud_arg.resize (nr_points);
 
     // Define point cloud parameters
     cloud_arg.width = static_cast<std::uint32_t> (width_arg);
     cloud_arg.height = static_cast<std::uint32_t> (height_arg);
     cloud_arg.is_dense = false;
 
-    // Calculate center of disparity image
-    int centerX = static_cast<int> (width_arg / 2);
-    int centerY = static_cast<int> (height_arg / 2);
-
     const float fl_const = 1.0f / focalLength_arg;
-    static const float bad_point = std::numeric_limits<float>::quiet_NaN ();
+    const float bad_point = std::numeric_limits<float>::quiet_NaN ();
+
+#pragma omp parallel for \
+  default(none) \
+  shared(cloud_arg, disparityData_arg) \
+  firstprivate(bad_point, centerX, centerY, disparityScale_arg, disparityShift_arg, fl_const, focalLength_arg, nr_columns, nr_points) \
+  num_threads(nr_threads)
+    for (std::ptrdiff_t i = 0; i < nr_points; ++i)
+    {
+      PointT newPoint;
+      const std::uint16_t& pixel_disparity = disparityData_arg[i];
+      const float x = static_cast<float> (i % nr_columns - centerX);
+      const float y = static_cast<float> (i / nr_columns - centerY);
 
-    std::size_t i = 0;
-    for (int y = -centerY; y < centerY; ++y )
-      for (int x = -centerX; x < centerX; ++x )
+      if (pixel_disparity)
       {
-        PointT newPoint;
-        const std::uint16_t& pixel_disparity = disparityData_arg[i];
-        ++i;
+        // Inverse depth decoding
+        float depth = focalLength_arg / (static_cast<float> (pixel_disparity) * disparityScale_arg + disparityShift_arg);
 
-        if (pixel_disparity)
-        {
-          // Inverse depth decoding
-          float depth = focalLength_arg / (static_cast<float> (pixel_disparity) * disparityScale_arg + disparityShift_arg);
-
-          // Generate new points
-          newPoint.x = static_cast<float> (x) * depth * fl_const;
-          newPoint.y = static_cast<float> (y) * depth * fl_const;
-          newPoint.z = depth;
+        // Generate new points
+        newPoint.x = x * depth * fl_const;
+        newPoint.y = y * depth * fl_const;
+        newPoint.z = depth;
 
-        }
-        else
-        {
-          // Generate bad point
-          newPoint.x = newPoint.y = newPoint.z = bad_point;
-        }
-
-        cloud_arg.push_back (newPoint);
       }
+      else
+      {
+        // Generate bad point
+        newPoint.x = newPoint.y = newPoint.z = bad_point;
+      }
+
+      cloud_arg[i] = newPoint;
+    }
   }
 
   /** \brief Convert disparity image to point cloud
@@ -199,6 +206,7 @@ struct OrganizedConversion<PointT, false>
     * \param[in] height_arg height of disparity image
     * \param[in] focalLength_arg focal length
     * \param[out] cloud_arg output point cloud
+    * \param[in] nr_threads the number of threads
     * \ingroup io
     */
   static void convert(typename std::vector<float>& depthData_arg,
@@ -207,52 +215,57 @@ struct OrganizedConversion<PointT, false>
                       std::size_t width_arg,
                       std::size_t height_arg,
                       float focalLength_arg,
-                      pcl::PointCloud<PointT>& cloud_arg)
+                      pcl::PointCloud<PointT>& cloud_arg,
+                      unsigned int nr_threads = 1)
   {
-    std::size_t cloud_size = width_arg * height_arg;
+    assert(depthData_arg.size()==width_arg*height_arg);
 
-    assert(depthData_arg.size()==cloud_size);
+    // Calculate center of disparity image
+    const std::ptrdiff_t centerX = static_cast<std::ptrdiff_t> (width_arg / 2);
+    const std::ptrdiff_t centerY = static_cast<std::ptrdiff_t> (height_arg / 2);
 
-    // Reset point cloud
+    // Reset point cloud, the pixels from -center to center - 1 are converted
+    const std::ptrdiff_t nr_columns = 2 * centerX;
+    const std::ptrdiff_t nr_points = nr_columns * 2 * centerY;
     cloud_arg.clear ();
-    cloud_arg.reserve (cloud_size);
+    cloud_arg.resize (nr_points);
 
     // Define point cloud parameters
     cloud_arg.width = static_cast<std::uint32_t> (width_arg);
     cloud_arg.height = static_cast<std::uint32_t> (height_arg);
     cloud_arg.is_dense = false;
 
-    // Calculate center of disparity image
-    int centerX = static_cast<int> (width_arg / 2);
-    int centerY = static_cast<int> (height_arg / 2);
-
     const float fl_const = 1.0f / focalLength_arg;
-    static const float bad_point = std::numeric_limits<float>::quiet_NaN ();
+    const float bad_point = std::numeric_limits<float>::quiet_NaN ();
+
+#pragma omp parallel for \
+  default(none) \
+  shared(cloud_arg, depthData_arg) \
+  firstprivate(bad_point, centerX, centerY, fl_const, nr_columns, nr_points) \
+  num_threads(nr_threads)
+    for (std::ptrdiff_t i = 0; i < nr_points; ++i)
+    {
+      PointT newPoint;
+      const float& pixel_depth = depthData_arg[i];
+      const float x = static_cast<float> (i % nr_columns - centerX);
+      const float y = static_cast<float> (i / nr_columns - centerY);
 
-    std::size_t i = 0;
-    for (int y = -centerY; y < centerY; ++y )
-      for (int x = -centerX; x < centerX; ++x )
+      if (pixel_depth)
       {
-        PointT newPoint;
-        const float& pixel_depth = depthData_arg[i];
-        ++i;
-
-        if (pixel_depth)
-        {
-          // Generate new points
-          newPoint.x = static_cast<float> (x) * pixel_depth * fl_const;
-          newPoint.y = static_cast<float> (y) * pixel_depth * fl_const;
-          newPoint.z = pixel_depth;
+        // Generate new points
+        newPoint.x = x * pixel_depth * fl_const;
+        newPoint.y = y * pixel_depth * fl_const;
+        newPoint.z = pixel_depth;
 
-        }
-        else
-        {
-          // Generate bad point
-          newPoint.x = newPoint.y = newPoint.z = bad_point;
-        }
-
-        cloud_arg.push_back (newPoint);
       }
+      else
+      {
+        // Generate bad point
+        newPoint.x = newPoint.y = newPoint.z = bad_point;
+      }
+
+      cloud_arg[i] = newPoint;
+    }
   }
 };
 
@@ -268,6 +281,7 @@ struct OrganizedConversion<PointT, true>
     * \param[in] convertToMono convert color to mono/grayscale
     * \param[out] disparityData_arg output disparity image
     * \param[out] rgbData_arg output rgb image
+    * \param[in] nr_threads the number of threads
     * \ingroup io
     */
   static void convert(const pcl::PointCloud<PointT>& cloud_arg,
@@ -276,67 +290,60 @@ struct OrganizedConversion<PointT, true>
                       float disparityScale_arg,
                       bool convertToMono,
                       typename std::vector<std::uint16_t>& disparityData_arg,
-                      typename std::vector<std::uint8_t>& rgbData_arg)
+                      typename std::vector<std::uint8_t>& rgbData_arg,
+                      unsigned int nr_threads = 1)
   {
-    const auto cloud_size = cloud_arg.size ();
-
-    // Reset output vectors
-    disparityData_arg.clear ();
-    rgbData_arg.clear ();
+    const std::ptrdiff_t cloud_size = cloud_arg.size ();
 
     // Allocate memory
-    disparityData_arg.reserve (cloud_size);
-    if (convertToMono)
-    {
-      rgbData_arg.reserve (cloud_size);
-    } else
-    {
-      rgbData_arg.reserve (cloud_size * 3);
-    }
+    disparityData_arg.resize (cloud_size);
+    rgbData_arg.resize (convertToMono ? cloud_size : cloud_size * 3);
 
-    for (std::size_t i = 0; i < cloud_size; ++i)
+    // Branch free, so the compiler can vectorize the conversion
+    if (convertToMono)
     {
-      const PointT& point = cloud_arg[i];
-
-      if (pcl::isFinite (point))
+#pragma omp parallel for \
+  default(none) \
+  shared(cloud_arg, disparityData_arg, rgbData_arg) \
+  firstprivate(cloud_size, focalLength_arg, disparityShift_arg, disparityScale_arg) \
+  num_threads(nr_threads)
+      for (std::ptrdiff_t i = 0; i < cloud_size; ++i)
       {
-        if (convertToMono)
-        {
-          // Encode point color
-          std::uint8_t grayvalue = static_cast<std::uint8_t>(0.2989 * point.r
-                                                    + 0.5870 * point.g
-                                                    + 0.1140 * point.b);
-
-          rgbData_arg.push_back (grayvalue);
-        } else
-        {
-          // Encode point color
-          rgbData_arg.push_back (point.r);
-          rgbData_arg.push_back (point.g);
-          rgbData_arg.push_back (point.b);
-        }
-
-        // Inverse depth quantization
-        std::uint16_t disparity = static_cast<std::uint16_t> (focalLength_arg / (disparityScale_arg * point.z) + disparityShift_arg / disparityScale_arg);
-
-        // Encode disparity
-        disparityData_arg.push_back (disparity);
+        const PointT& point = cloud_arg[i];
+        const bool valid = pcl::isFinite (point);
+        const float z = valid ? point.z : 1.0f;
+
+        // Encode point color, black for non-valid points
+        const std::uint8_t grayvalue = static_cast<std::uint8_t>(0.2989 * point.r
+                                                               + 0.5870 * point.g
+                                                               + 0.1140 * point.b);
+        rgbData_arg[i] = valid ? grayvalue : static_cast<std::uint8_t> (0);
+
+        // Inverse depth quantization, non-valid points are encoded with zeros
+        const std::uint16_t disparity = static_cast<std::uint16_t> (focalLength_arg / (disparityScale_arg * z) + disparityShift_arg / disparityScale_arg);
+        disparityData_arg[i] = valid ? disparity : static_cast<std::uint16_t> (0);
       }
-      else
+    } else
+    {
+#pragma omp parallel for \
+  default(none) \
+  shared(cloud_arg, disparityData_arg, rgbData_arg) \
+  firstprivate(cloud_size, focalLength_arg, disparityShift_arg, disparityScale_arg) \
+  num_threads(nr_threads)
+      for (std::ptrdiff_t i = 0; i < cloud_size; ++i)
       {
-        // Encode black point
-        if (convertToMono)
-        {
-          rgbData_arg.push_back (0);
-        } else
-        {
-          rgbData_arg.push_back (0);
-          rgbData_arg.push_back (0);
-          rgbData_arg.push_back (0);
-        }
-
-        // Encode bad point
-        disparityData_arg.push_back (0);
+        const PointT& point = cloud_arg[i];
+        const bool valid = pcl::isFinite (point);
+        const float z = valid ? point.z : 1.0f;
+
+        // Encode point color, black for non-valid points
+        rgbData_arg[i * 3 + 0] = valid ? point.r : static_cast<std::uint8_t> (0);
+        rgbData_arg[i * 3 + 1] = valid ? point.g : static_cast<std::uint8_t> (0);
+        rgbData_arg[i * 3 + 2] = valid ? point.b : static_cast<std::uint8_t> (0);
+
+        // Inverse depth quantization, non-valid points are encoded with zeros
+        const std::uint16_t disparity = static_cast<std::uint16_t> (focalLength_arg / (disparityScale_arg * z) + disparityShift_arg / disparityScale_arg);
+        disparityData_arg[i] = valid ? disparity : static_cast<std::uint16_t> (0);
       }
     }
   }
@@ -351,6 +358,7 @@ struct OrganizedConversion<PointT, true>
     * \param[in] disparityShift_arg disparity shift
     * \param[in] disparityScale_arg disparity scaling
     * \param[out] cloud_arg output point cloud
+    * \param[in] nr_threads the number of threads
     * \ingroup io
     */
   static void convert(typename std::vector<std::uint16_t>& disparityData_arg,
@@ -361,89 +369,91 @@ struct OrganizedConversion<PointT, true>
                       float focalLength_arg,
                       float disparityShift_arg,
                       float disparityScale_arg,
-                      pcl::PointCloud<PointT>& cloud_arg)
+                      pcl::PointCloud<PointT>& cloud_arg,
+                      unsigned int nr_threads = 1)
   {
-    std::size_t cloud_size = width_arg*height_arg;
-    bool hasColor = (!rgbData_arg.empty ());
+    const bool hasColor = (!rgbData_arg.empty ());
 
     // Check size of input data
-    assert (disparityData_arg.size()==cloud_size);
+    assert (disparityData_arg.size()==width_arg*height_arg);
     if (hasColor)
     {
       if (monoImage_arg)
       {
-        assert (rgbData_arg.size()==cloud_size);
+        assert (rgbData_arg.size()==width_arg*height_arg);
       } else
       {
-        assert (rgbData_arg.size()==cloud_size*3);
+        assert (rgbData_arg.size()==width_arg*height_arg*3);
       }
     }
 
-    // Reset point cloud
+    // Calculate center of disparity image
+    const std::ptrdiff_t centerX = static_cast<std::ptrdiff_t> (width_arg/2);
+    const std::ptrdiff_t centerY = static_cast<std::ptrdiff_t> (height_arg/2);
+
+    // Reset point cloud, the pixels from -center to center - 1 are converted
+    const std::ptrdiff_t nr_columns = 2 * centerX;
+    const std::ptrdiff_t nr_points = nr_columns * 2 * centerY;
     cloud_arg.clear();
-    cloud_arg.reserve(cloud_size);
+    cloud_arg.resize(nr_points);
 
     // Define point cloud parameters
     cloud_arg.width = static_cast<std::uint32_t>(width_arg);
     cloud_arg.height = static_cast<std::uint32_t>(height_arg);
     cloud_arg.is_dense = false;
 
-    // Calculate center of disparity image
-    int centerX = static_cast<int>(width_arg/2);
-    int centerY = static_cast<int>(height_arg/2);
-
     const float fl_const = 1.0f/focalLength_arg;
-    static const float bad_point = std::numeric_limits<float>::quiet_NaN ();
+    const float bad_point = std::numeric_limits<float>::quiet_NaN ();
+
+#pragma omp parallel for \
+  default(none) \
+  shared(cloud_arg, disparityData_arg, rgbData_arg) \
+  firstprivate(bad_point, centerX, centerY, disparityScale_arg, disparityShift_arg, fl_const, focalLength_arg, hasColor, monoImage_arg, nr_columns, nr_points) \
+  num_threads(nr_threads)
+    for (std::ptrdiff_t i = 0; i < nr_points; ++i)
+    {
+      PointT newPoint;
+
+      const std::uint16_t& pixel_disparity = disparityData_arg[i];
 
-    std::size_t i = 0;
-    for (int y = -centerY; y < centerY; ++y )
-      for (int x = -centerX; x < centerX; ++x )
+      if (pixel_disparity && (pixel_disparity!=0x7FF))
       {
-        PointT newPoint;
+        float depth = focalLength_arg / (static_cast<float> (pixel_disparity) * disparityScale_arg + disparityShift_arg);
 
-        const std::uint16_t& pixel_disparity = disparityData_arg[i];
+        // Define point location
+        newPoint.z = depth;
+        newPoint.x = static_cast<float> (i % nr_columns - centerX) * depth * fl_const;
+        newPoint.y = static_cast<float> (i / nr_columns - centerY) * depth * fl_const;
 
-        if (pixel_disparity && (pixel_disparity!=0x7FF))
+        if (hasColor)
         {
-          float depth = focalLength_arg / (static_cast<float> (pixel_disparity) * disparityScale_arg + disparityShift_arg);
-
-          // Define point location
-          newPoint.z = depth;
-          newPoint.x = static_cast<float> (x) * depth * fl_const;
-          newPoint.y = static_cast<float> (y) * depth * fl_const;
-
-          if (hasColor)
+          if (monoImage_arg)
           {
-            if (monoImage_arg)
-            {
-              // Define point color
-              newPoint.r = rgbData_arg[i];
-              newPoint.g = rgbData_arg[i];
-              newPoint.b = rgbData_arg[i];
-            } else
-            {
-              // Define point color
-              newPoint.r = rgbData_arg[i*3+0];
-              newPoint.g = rgbData_arg[i*3+1];
-              newPoint.b = rgbData_arg[i*3+2];
-            }
-
+            // Define point color
+            newPoint.r = rgbData_arg[i];
+            newPoint.g = rgbData_arg[i];
+            newPoint.b = rgbData_arg[i];
           } else
           {
-            // Set white point color
-            newPoint.rgba = 0xffffffffu;
+            // Define point color
+            newPoint.r = rgbData_arg[i*3+0];
+            newPoint.g = rgbData_arg[i*3+1];
+            newPoint.b = rgbData_arg[i*3+2];
           }
+
         } else
         {
-          // Define bad point
-          newPoint.x = newPoint.y = newPoint.z = bad_point;
-          newPoint.rgb = 0.0f;
+          // Set white point color
+          newPoint.rgba = 0xffffffffu;
         }
+      } else
+      {
+        // Define bad point
+        newPoint.x = newPoint.y = newPoint.z = bad_point;
+        newPoint.rgb = 0.0f;
+      }
 
-        // Add point to cloud
-        cloud_arg.push_back(newPoint);
-        // Increment point iterator
-        ++i;
+      cloud_arg[i] = newPoint;
     }
   }
 
@@ -455,6 +465,7 @@ struct OrganizedConversion<PointT, true>
     * \param[in] height_arg height of disparity image
     * \param[in] focalLength_arg focal length
     * \param[out] cloud_arg output point cloud
+    * \param[in] nr_threads the number of threads
     * \ingroup io
     */
   static void convert(typename std::vector<float>& depthData_arg,
@@ -463,87 +474,89 @@ struct OrganizedConversion<PointT, true>
                       std::size_t width_arg,
                       std::size_t height_arg,
                       float focalLength_arg,
-                      pcl::PointCloud<PointT>& cloud_arg)
+                      pcl::PointCloud<PointT>& cloud_arg,
+                      unsigned int nr_threads = 1)
   {
-    std::size_t cloud_size = width_arg*height_arg;
-    bool hasColor = (!rgbData_arg.empty ());
+    const bool hasColor = (!rgbData_arg.empty ());
 
     // Check size of input data
-    assert (depthData_arg.size()==cloud_size);
+    assert (depthData_arg.size()==width_arg*height_arg);
     if (hasColor)
     {
       if (monoImage_arg)
       {
-        assert (rgbData_arg.size()==cloud_size);
+        assert (rgbData_arg.size()==width_arg*height_arg);
       } else
       {
-        assert (rgbData_arg.size()==cloud_size*3);
+        assert (rgbData_arg.size()==width_arg*height_arg*3);
       }
     }
 
-    // Reset point cloud
+    // Calculate center of disparity image
+    const std::ptrdiff_t centerX = static_cast<std::ptrdiff_t> (width_arg/2);
+    const std::ptrdiff_t centerY = static_cast<std::ptrdiff_t> (height_arg/2);
+
+    // Reset point cloud, the pixels from -center to center - 1 are converted
+    const std::ptrdiff_t nr_columns = 2 * centerX;
+    const std::ptrdiff_t nr_points = nr_columns * 2 * centerY;
     cloud_arg.clear();
-    cloud_arg.reserve(cloud_size);
+    cloud_arg.resize(nr_points);
 
     // Define point cloud parameters
     cloud_arg.width = static_cast<std::uint32_t>(width_arg);
     cloud_arg.height = static_cast<std::uint32_t>(height_arg);
     cloud_arg.is_dense = false;
 
-    // Calculate center of disparity image
-    int centerX = static_cast<int>(width_arg/2);
-    int centerY = static_cast<int>(height_arg/2);
-
     const float fl_const = 1.0f/focalLength_arg;
-    static const float bad_point = std::numeric_limits<float>::quiet_NaN ();
+    const float bad_point = std::numeric_limits<float>::quiet_NaN ();
+
+#pragma omp parallel for \
+  default(none) \
+  shared(cloud_arg, depthData_arg, rgbData_arg) \
+  firstprivate(bad_point, centerX, centerY, fl_const, hasColor, monoImage_arg, nr_columns, nr_points) \
+  num_threads(nr_threads)
+    for (std::ptrdiff_t i = 0; i < nr_points; ++i)
+    {
+      PointT newPoint;
 
-    std::size_t i = 0;
-    for (int y = -centerY; y < centerY; ++y )
-      for (int x = -centerX; x < centerX; ++x )
-      {
-        PointT newPoint;
+      const float& pixel_depth = depthData_arg[i];
 
-        const float& pixel_depth = depthData_arg[i];
+      if (pixel_depth)
+      {
+        // Define point location
+        newPoint.z = pixel_depth;
+        newPoint.x = static_cast<float> (i % nr_columns - centerX) * pixel_depth * fl_const;
+        newPoint.y = static_cast<float> (i / nr_columns - centerY) * pixel_depth * fl_const;
 
-        if (pixel_depth)
+        if (hasColor)
         {
-          // Define point location
-          newPoint.z = pixel_depth;
-          newPoint.x = static_cast<float> (x) * pixel_depth * fl_const;
-          newPoint.y = static_cast<float> (y) * pixel_depth * fl_const;
-
-          if (hasColor)
+          if (monoImage_arg)
           {
-            if (monoImage_arg)
-            {
-              // Define point color
-              newPoint.r = rgbData_arg[i];
-              newPoint.g = rgbData_arg[i];
-              newPoint.b = rgbData_arg[i];
-            } else
-            {
-              // Define point color
-              newPoint.r = rgbData_arg[i*3+0];
-              newPoint.g = rgbData_arg[i*3+1];
-              newPoint.b = rgbData_arg[i*3+2];
-            }
-
+            // Define point color
+            newPoint.r = rgbData_arg[i];
+            newPoint.g = rgbData_arg[i];
+            newPoint.b = rgbData_arg[i];
           } else
           {
-            // Set white point color
-            newPoint.rgba = 0xffffffffu;
+            // Define point color
+            newPoint.r = rgbData_arg[i*3+0];
+            newPoint.g = rgbData_arg[i*3+1];
+            newPoint.b = rgbData_arg[i*3+2];
           }
+
         } else
         {
-          // Define bad point
-          newPoint.x = newPoint.y = newPoint.z = bad_point;
-          newPoint.rgb = 0.0f;
+          // Set white point color
+          newPoint.rgba = 0xffffffffu;
         }
+      } else
+      {
+        // Define bad point
+        newPoint.x = newPoint.y = newPoint.z = bad_point;
+        newPoint.rgb = 0.0f;
+      }
 
-        // Add point to cloud
-        cloud_arg.push_back(newPoint);
-        // Increment point iterator
-        ++i;
+      cloud_arg[i] = newPoint;
     }
   }
 };
@@ -0,0 +1,291 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#pragma once
+
+#include <pcl/pcl_macros.h>
+#include <pcl/point_cloud.h>
+#include <pcl/PCLPointCloud2.h>
+#include <pcl/io/pcd_io.h>
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace pcl
+{
+  namespace io
+  {
+    /** \brief Writes PCD files on a pool of background threads.
+      *
+      * The clouds are handed over as shared pointers or moved in, so the calling
+      * thread (e.g. a capture loop) never waits for the disk, except when the queue
+      * of pending writes is full. The files are written with PCDWriter and are
+      * byte-identical to what it produces when called directly.
+      *
+      * \code
+      * pcl::io::AsyncPCDWriter writer (2, 8);
+      * writer.setCallback ([] (const std::string &file_name, int result) { ... });
+      * writer.writeBinary ("sweep_0001.pcd", std::move (cloud));
+      * std::future<int> done = writer.writeBinary ("sweep_0002.pcd", cloud_ptr);
+      * \endcode
+      *
+      * \ingroup io
+      */
+    class PCL_EXPORTS AsyncPCDWriter
+    {
+      public:
+        /** \brief Called from a worker thread once a file is written, or from the
+          * calling thread if the write is rejected. The arguments are the file name and
+          * the result of the PCDWriter call (0 on success, < 0 on error).
+          */
+        using Callback = std::function<void (const std::string &file_name, int result)>;
+
+        /** \brief What to do when a write is requested while the queue is full. */
+        enum Backpressure
+        {
+          /** \brief Block the caller until a slot becomes free (default). */
+          BLOCK,
+          /** \brief Reject the write right away with result -2. */
+          REJECT
+        };
+
+        /** \brief Constructor, starts the worker threads.
+          * \param[in] nr_threads the number of worker threads (at least 1)
+          * \param[in] max_queue_size the maximum number of pending writes, not counting
+          * those that are being written (at least 1)
+          */
+        AsyncPCDWriter (unsigned int nr_threads = 1, std::size_t max_queue_size = 16);
+
+        /** \brief Destructor, writes all pending clouds and stops the worker threads. */
+        ~AsyncPCDWriter ();
+
+        AsyncPCDWriter (const AsyncPCDWriter&) = delete;
+        AsyncPCDWriter&
+        operator= (const AsyncPCDWriter&) = delete;
+
+        /** \brief Set the function called after every write. Must be thread safe if more
+          * than one worker thread is used.
+          */
+        void
+        setCallback (const Callback &callback);
+
+        /** \brief Set what happens when the queue is full, see Backpressure. */
+        void
+        setBackpressure (Backpressure backpressure);
+
+        /** \brief Set whether msync() is called before munmap(), see PCDWriter::setMapSynchronization(). */
+        void
+        setMapSynchronization (bool sync);
+
+        /** \brief Get the number of pending writes in the queue. */
+        std::size_t
+        getQueueSize () const;
+
+        /** \brief Block until all the writes requested so far are done. */
+        void
+        flush ();
+
+        /** \brief Save a cloud to a PCD file in BINARY format, in the background.
+          * \param[in] file_name the output file name
+          * \param[in] cloud the point cloud data message; it must not be modified until the write is done
+          * \param[in] origin the sensor acquisition origin
+          * \param[in] orientation the sensor acquisition orientation
+          * \return the future result of PCDWriter::writeBinary (-1 on error, -2 if rejected)
+          */
+        std::future<int>
+        writeBinary (const std::string &file_name, const pcl::PCLPointCloud2::ConstPtr &cloud,
+                     const Eigen::Vector4f &origin = Eigen::Vector4f::Zero (),
+                     const Eigen::Quaternionf &orientation = Eigen::Quaternionf::Identity ());
+
+        /** \brief Save a cloud to a PCD file in BINARY_COMPRESSED format, in the background.
+          * \param[in] file_name the output file name
+          * \param[in] cloud the point cloud data message; it must not be modified until the write is done
+          * \param[in] origin the sensor acquisition origin
+          * \param[in] orientation the sensor acquisition orientation
+          * \return the future result of PCDWriter::writeBinaryCompressed (-1 on error, -2 if rejected)
+          */
+        std::future<int>
+        writeBinaryCompressed (const std::string &file_name, const pcl::PCLPointCloud2::ConstPtr &cloud,
+                               const Eigen::Vector4f &origin = Eigen::Vector4f::Zero (),
+                               const Eigen::Quaternionf &orientation = Eigen::Quaternionf::Identity ());
+
+        /** \brief Save a point cloud to a PCD file in BINARY format, in the background.
+          * \param[in] file_name the output file name
+          * \param[in] cloud the point cloud; it must not be modified until the write is done
+          * \return the future result of PCDWriter::writeBinary (-1 on error, -2 if rejected)
+          */
+        template <typename PointT> std::future<int>
+        writeBinary (const std::string &file_name, const shared_ptr<const pcl::PointCloud<PointT> > &cloud)
+        {
+          const bool sync = map_synchronization_;
+          return (enqueue (file_name, [file_name, cloud, sync] ()
+          {
+            pcl::PCDWriter writer;
+            writer.setMapSynchronization (sync);
+            return (writer.writeBinary<PointT> (file_name, *cloud));
+          }));
+        }
+
+        /** \brief Save a point cloud to a PCD file in BINARY format, in the background.
+          * \param[in] file_name the output file name
+          * \param[in] cloud the point cloud; it must not be modified until the write is done
+          * \return the future result of PCDWriter::writeBinary (-1 on error, -2 if rejected)
+          */
+        template <typename PointT> std::future<int>
+        writeBinary (const std::string &file_name, const shared_ptr<pcl::PointCloud<PointT> > &cloud)
+        {
+          return (writeBinary<PointT> (file_name, shared_ptr<const pcl::PointCloud<PointT> > (cloud)));
+        }
+
+        /** \brief Save a point cloud to a PCD file in BINARY format, in the background.
+          * \param[in] file_name the output file name
+          * \param[in] cloud the point cloud, moved into the writer
+          * \return the future result of PCDWriter::writeBinary (-1 on error, -2 if rejected)
+          */
+        template <typename PointT> std::future<int>
+        writeBinary (const std::string &file_name, pcl::PointCloud<PointT> &&cloud)
+        {
+          return (writeBinary<PointT> (file_name,
+                                       shared_ptr<const pcl::PointCloud<PointT> > (
+                                         new pcl::PointCloud<PointT> (std::move (cloud)))));
+        }
+
+        /** \brief Save a point cloud to a PCD file in BINARY_COMPRESSED format, in the background.
+          * \param[in] file_name the output file name
+          * \param[in] cloud the point cloud; it must not be modified until the write is done
+          * \return the future result of PCDWriter::writeBinaryCompressed (-1 on error, -2 if rejected)
+          */
+        template <typename PointT> std::future<int>
+        writeBinaryCompressed (const std::string &file_name, const shared_ptr<const pcl::PointCloud<PointT> > &cloud)
+        {
+          const bool sync = map_synchronization_;
+          return (enqueue (file_name, [file_name, cloud, sync] ()
+          {
+            pcl::PCDWriter writer;
+            writer.setMapSynchronization (sync);
+            return (writer.writeBinaryCompressed<PointT> (file_name, *cloud));
+          }));
+        }
+
+        /** \brief Save a point cloud to a PCD file in BINARY_COMPRESSED format, in the background.
+          * \param[in] file_name the output file name
+          * \param[in] cloud the point cloud; it must not be modified until the write is done
+          * \return the future result of PCDWriter::writeBinaryCompressed (-1 on error, -2 if rejected)
+          */
+        template <typename PointT> std::future<int>
+        writeBinaryCompressed (const std::string &file_name, const shared_ptr<pcl::PointCloud<PointT> > &cloud)
+        {
+          return (writeBinaryCompressed<PointT> (file_name, shared_ptr<const pcl::PointCloud<PointT> > (cloud)));
+        }
+
+        /** \brief Save a point cloud to a PCD file in BINARY_COMPRESSED format, in the background.
+          * \param[in] file_name the output file name
+          * \param[in] cloud the point cloud, moved into the writer
+          * \return the future result of PCDWriter::writeBinaryCompressed (-1 on error, -2 if rejected)
+          */
+        template <typename PointT> std::future<int>
+        writeBinaryCompressed (const std::string &file_name, pcl::PointCloud<PointT> &&cloud)
+        {
+          return (writeBinaryCompressed<PointT> (file_name,
+                                                 shared_ptr<const pcl::PointCloud<PointT> > (
+                                                   new pcl::PointCloud<PointT> (std::move (cloud)))));
+        }
+
+      protected:
+        /** \brief A write request: the file name, the write itself and its promised result. */
+        struct Job
+        {
+          std::string file_name;
+          std::function<int ()> write;
+          std::promise<int> result;
+        };
+
+        /** \brief Queue a write, blocking or rejecting it if the queue is full.
+          * \param[in] file_name the output file name, passed to the callback
+          * \param[in] write the function that writes the file and returns the PCDWriter result
+          */
+        std::future<int>
+        enqueue (const std::string &file_name, std::function<int ()> write);
+
+        /** \brief The loop of the worker threads. */
+        void
+        run ();
+
+        /** \brief The pending writes. */
+        std::deque<Job> queue_;
+
+        /** \brief Mutex protecting the queue and the state below. */
+        mutable std::mutex mutex_;
+
+        /** \brief Signaled when a job is queued or the writer stops. */
+        std::condition_variable queue_not_empty_;
+
+        /** \brief Signaled when a job leaves the queue. */
+        std::condition_variable queue_not_full_;
+
+        /** \brief Signaled when a job is done. */
+        std::condition_variable job_done_;
+
+        /** \brief The worker threads. */
+        std::vector<std::thread> workers_;
+
+        /** \brief The maximum number of pending writes. */
+        std::size_t max_queue_size_;
+
+        /** \brief The number of jobs being written right now. */
+        std::size_t nr_active_;
+
+        /** \brief Set to true to stop the workers once the queue is empty. */
+        bool stop_;
+
+        /** \brief What to do when the queue is full. */
+        Backpressure backpressure_;
+
+        /** \brief Whether msync() is called before munmap(). */
+        bool map_synchronization_;
+
+        /** \brief The function called after every write. */
+        Callback callback_;
+    };
+  }
+}
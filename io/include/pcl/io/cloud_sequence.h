@@ -0,0 +1,286 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#pragma once
+
+#include <pcl/conversions.h>
+#include <pcl/memory.h>
+#include <pcl/pcl_macros.h>
+#include <pcl/point_cloud.h>
+#include <pcl/PCLPointCloud2.h>
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace pcl
+{
+  namespace io
+  {
+    /** \brief Entry of the index of a cloud sequence file. */
+    struct CloudSequenceIndexEntry
+    {
+      /** \brief Position of the frame in the file. */
+      std::uint64_t offset;
+      /** \brief Size of the frame in the file, header and fields included. */
+      std::uint64_t size;
+      /** \brief Timestamp of the frame, the header stamp of the cloud. */
+      std::uint64_t timestamp;
+    };
+
+    /** \brief Writer of cloud sequence files, a container of point clouds with random access.
+      *
+      * A cloud sequence file starts with a file header, followed by the frames and an index of the frames:
+      *   - file header: the magic "PCLSEQ", the format version, the position of the index and the number of frames
+      *   - per frame: a fixed size binary header (timestamp, width, height, point step, sensor pose, data sizes and
+      *     whether the data is LZF compressed), the field descriptions and the point data
+      *   - index: the position, size and timestamp of every frame
+      *
+      * All numbers are stored in the byte order of the machine, like binary PCD files. The index is written by close(),
+      * files that were not closed can not be read.
+      * \ingroup io
+      */
+    class PCL_EXPORTS CloudSequenceWriter
+    {
+      public:
+        CloudSequenceWriter () = default;
+        CloudSequenceWriter (const CloudSequenceWriter&) = delete;
+        CloudSequenceWriter&
+        operator= (const CloudSequenceWriter&) = delete;
+
+        /** \brief Closes the file. */
+        ~CloudSequenceWriter ();
+
+        /** \brief Create a cloud sequence file, replacing an existing file.
+          * \param[in] file_name the name of the file
+          * \param[in] compress whether to compress the point data of the frames with LZF
+          * \return 0 on success, -1 on error
+          */
+        int
+        open (const std::string &file_name, bool compress = false);
+
+        /** \brief Append a frame. The header stamp of the cloud is the timestamp of the frame.
+          * \param[in] cloud the point cloud
+          * \param[in] origin the sensor acquisition origin
+          * \param[in] orientation the sensor acquisition orientation
+          * \return 0 on success, -1 on error
+          */
+        int
+        write (const pcl::PCLPointCloud2 &cloud,
+               const Eigen::Vector4f &origin = Eigen::Vector4f::Zero (),
+               const Eigen::Quaternionf &orientation = Eigen::Quaternionf::Identity ());
+
+        /** \brief Append a frame, with the sensor pose of the cloud. The header stamp of the cloud is the timestamp
+          * of the frame.
+          * \param[in] cloud the point cloud
+          * \return 0 on success, -1 on error
+          */
+        template <typename PointT> int
+        write (const pcl::PointCloud<PointT> &cloud)
+        {
+          pcl::PCLPointCloud2 blob;
+          pcl::toPCLPointCloud2 (cloud, blob);
+          return (write (blob, cloud.sensor_origin_, cloud.sensor_orientation_));
+        }
+
+        /** \brief Write the index and close the file.
+          * \return 0 on success, -1 on error
+          */
+        int
+        close ();
+
+        /** \brief Returns whether a file is open. */
+        inline bool
+        isOpen () const { return (file_.is_open ()); }
+
+        /** \brief Returns the number of frames written to the open file. */
+        inline std::size_t
+        size () const { return (index_.size ()); }
+
+      private:
+        /** \brief The file being written. */
+        std::ofstream file_;
+
+        /** \brief The name of the file being written. */
+        std::string file_name_;
+
+        /** \brief Whether to compress the point data. */
+        bool compress_ = false;
+
+        /** \brief The index of the frames written so far. */
+        std::vector<CloudSequenceIndexEntry> index_;
+
+        /** \brief The position of the next frame. */
+        std::uint64_t position_ = 0;
+
+        /** \brief Buffers of the packed and the compressed point data, kept between frames. */
+        std::vector<std::uint8_t> packed_, compressed_;
+    };
+
+    /** \brief Reader of cloud sequence files, see CloudSequenceWriter for the format.
+      *
+      * The file is mapped into memory and its index is read by open(), so any frame can be read in constant time.
+      * Frames are decoded straight from the mapping, read() into a pcl::PointCloud does not create an intermediate
+      * pcl::PCLPointCloud2. The const methods can be called concurrently.
+      * \ingroup io
+      */
+    class PCL_EXPORTS CloudSequenceReader
+    {
+      public:
+        CloudSequenceReader () = default;
+        CloudSequenceReader (const CloudSequenceReader&) = delete;
+        CloudSequenceReader&
+        operator= (const CloudSequenceReader&) = delete;
+
+        /** \brief Closes the file. */
+        ~CloudSequenceReader ();
+
+        /** \brief Map a cloud sequence file into memory and read its index.
+          * \param[in] file_name the name of the file
+          * \return 0 on success, -1 on error
+          */
+        int
+        open (const std::string &file_name);
+
+        /** \brief Unmap the file. */
+        void
+        close ();
+
+        /** \brief Returns whether a file is open. */
+        inline bool
+        isOpen () const { return (map_ != nullptr); }
+
+        /** \brief Returns the number of frames. */
+        inline std::size_t
+        size () const { return (index_.size ()); }
+
+        /** \brief Returns the index of the frames. */
+        inline const std::vector<CloudSequenceIndexEntry>&
+        getIndex () const { return (index_); }
+
+        /** \brief Returns the timestamp of frame \a idx. */
+        inline std::uint64_t
+        getTimestamp (std::size_t idx) const { return (index_[idx].timestamp); }
+
+        /** \brief Find the first frame with a timestamp not before \a timestamp, by binary search. Requires the
+          * frames to be written in timestamp order.
+          * \param[in] timestamp the timestamp
+          * \return the index of the frame, size () if all frames are older
+          */
+        std::size_t
+        findFrame (std::uint64_t timestamp) const;
+
+        /** \brief Read frame \a idx.
+          * \param[in] idx the index of the frame
+          * \param[out] cloud the point cloud
+          * \param[out] origin the sensor acquisition origin
+          * \param[out] orientation the sensor acquisition orientation
+          * \return 0 on success, -1 on error
+          */
+        int
+        read (std::size_t idx, pcl::PCLPointCloud2 &cloud,
+              Eigen::Vector4f &origin, Eigen::Quaternionf &orientation) const;
+
+        /** \brief Read frame \a idx.
+          * \param[in] idx the index of the frame
+          * \param[out] cloud the point cloud
+          * \return 0 on success, -1 on error
+          */
+        inline int
+        read (std::size_t idx, pcl::PCLPointCloud2 &cloud) const
+        {
+          Eigen::Vector4f origin;
+          Eigen::Quaternionf orientation;
+          return (read (idx, cloud, origin, orientation));
+        }
+
+        /** \brief Read frame \a idx, with its sensor pose.
+          * \param[in] idx the index of the frame
+          * \param[out] cloud the point cloud
+          * \return 0 on success, -1 on error
+          */
+        template <typename PointT> int
+        read (std::size_t idx, pcl::PointCloud<PointT> &cloud) const;
+
+      private:
+        /** \brief A frame in the mapped file. */
+        struct Frame
+        {
+          std::uint64_t timestamp;
+          std::uint32_t width;
+          std::uint32_t height;
+          std::uint32_t point_step;
+          bool is_dense;
+          bool compressed;
+          Eigen::Vector4f origin;
+          Eigen::Quaternionf orientation;
+          std::vector<pcl::PCLPointField> fields;
+          /** \brief The point data, compressed or not, and its sizes. */
+          const std::uint8_t *data;
+          std::uint64_t data_size;
+          std::uint64_t stored_size;
+
+          PCL_MAKE_ALIGNED_OPERATOR_NEW
+        };
+
+        /** \brief Parse the header and fields of frame \a idx.
+          * \return 0 on success, -1 on error
+          */
+        int
+        parseFrame (std::size_t idx, Frame &frame) const;
+
+        /** \brief Get the uncompressed point data of a frame, in the mapping or decompressed into \a buffer.
+          * \return the point data, nullptr on error
+          */
+        const std::uint8_t*
+        getFrameData (const Frame &frame, std::vector<std::uint8_t> &buffer) const;
+
+        /** \brief The mapped file. */
+        const std::uint8_t *map_ = nullptr;
+        std::size_t map_size_ = 0;
+#ifdef _WIN32
+        void *map_handle_ = nullptr;
+#endif
+
+        /** \brief The index of the frames. */
+        std::vector<CloudSequenceIndexEntry> index_;
+    };
+  }
+}
+
+#include <pcl/io/impl/cloud_sequence.hpp>
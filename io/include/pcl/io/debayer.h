@@ -44,12 +44,29 @@ namespace pcl
   namespace io
   {
     /** \brief Various debayering methods.
+      *
+      * The pairs of lines of the image are converted in parallel, see setNumberOfThreads (). The bilinear method
+      * converts blocks of pixels with SSE2 or AVX2, as selected by pcl::getSIMDLevel ().
       * \author Suat Gedikli
       * \ingroup io
       */
     class PCL_EXPORTS DeBayer
     {
       public:
+        /** \brief Set the number of threads used to convert an image.
+          * \param[in] nr_threads the number of threads (0 for as many as the budget of pcl::ExecutionContext
+          * allows when converting)
+          */
+        void
+        setNumberOfThreads (unsigned int nr_threads = 0);
+
+        /** \brief Get the number of threads used to convert an image. */
+        inline unsigned int
+        getNumberOfThreads () const
+        {
+          return (threads_);
+        }
+
         // Debayering methods
         void
         debayerBilinear (
@@ -74,6 +91,26 @@ namespace pcl
             int bayer_line_step = 0,
             int bayer_line_step2 = 0,
             unsigned rgb_line_step = 0) const;
+
+      private:
+        /** \brief The number of threads used to convert an image. */
+        unsigned int threads_ = 1;
     };
+
+    /** \brief Convert a YUV422 image (u y1 v y2 per pair of pixels) of even width to RGB. Blocks of pixels are
+      * converted with SSE2 or AVX2, as selected by pcl::getSIMDLevel (), and the lines in parallel.
+      * \param[in] yuv_buffer the YUV422 image
+      * \param[out] rgb_buffer the RGB image
+      * \param[in] width the width of the image
+      * \param[in] height the height of the image
+      * \param[in] rgb_line_step the size of a line of the RGB image in bytes, 0 for 3 * width
+      * \param[in] nr_threads the number of threads (0 for as many as the budget of pcl::ExecutionContext allows)
+      * \ingroup io
+      */
+    PCL_EXPORTS void
+    convertYUV422ToRGB (const unsigned char *yuv_buffer, unsigned char *rgb_buffer,
+                        unsigned width, unsigned height,
+                        unsigned rgb_line_step = 0,
+                        unsigned int nr_threads = 1);
   }
 }
@@ -37,6 +37,7 @@
 #include <pcl/pcl_config.h>
 
 // needed for the grabber interface / observers
+#include <cstddef>
 #include <map>
 #include <memory>
 #include <iostream>
@@ -139,6 +140,18 @@ namespace pcl
       virtual float
       getFramesPerSecond () const = 0;
 
+      /** \brief Set how many released point clouds a grabber keeps for reuse per cloud type.
+        * Grabbers that lease their clouds from a pcl::io::PointCloudPool hand the same buffers out again once
+        * every callback has dropped its pointer, so steady streaming does not allocate. 0 disables the reuse.
+        * \param[in] capacity the maximum number of released clouds kept per cloud type (default 4)
+        */
+      inline void
+      setCloudPoolCapacity (std::size_t capacity) { cloud_pool_capacity_ = capacity; }
+
+      /** \brief Get how many released point clouds a grabber keeps for reuse per cloud type. */
+      inline std::size_t
+      getCloudPoolCapacity () const { return (cloud_pool_capacity_); }
+
     protected:
 
       virtual void
@@ -171,6 +184,9 @@ namespace pcl
       std::map<std::string, std::unique_ptr<boost::signals2::signal_base>> signals_;
       std::map<std::string, std::vector<boost::signals2::connection> > connections_;
       std::map<std::string, std::vector<boost::signals2::shared_connection_block> > shared_connections_;
+
+      /** \brief Maximum number of released clouds kept for reuse by grabbers that pool their clouds. */
+      std::size_t cloud_pool_capacity_ = 4;
   } ;
 
   bool
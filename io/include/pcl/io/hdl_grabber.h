@@ -42,12 +42,15 @@
 #include <pcl/pcl_macros.h>
 
 #include <pcl/io/grabber.h>
-#include <pcl/io/impl/synchronized_queue.hpp>
+#include <pcl/io/impl/spsc_ring_buffer.hpp>
+#include <pcl/io/point_cloud_pool.h>
 #include <pcl/point_types.h>
 #include <pcl/point_cloud.h>
 #include <boost/asio.hpp>
+#include <atomic>
 #include <string>
 #include <thread>
+#include <vector>
 
 #define HDL_Grabber_toRadians(x) ((x) * M_PI / 180.0)
 
@@ -194,12 +197,19 @@ namespace pcl
       virtual std::uint8_t
       getMaximumNumberOfLasers () const;
 
+      /** \brief Returns the number of packets dropped from the network because the decoder could not keep up
+       */
+      std::uint64_t
+      getNumberOfDroppedPackets () const;
+
     protected:
       static const std::uint16_t HDL_DATA_PORT = 2368;
       static const std::uint16_t HDL_NUM_ROT_ANGLES = 36001;
       static const std::uint8_t HDL_LASER_PER_FIRING = 32;
       static const std::uint8_t HDL_MAX_NUM_LASERS = 64;
       static const std::uint8_t HDL_FIRING_PER_PKT = 12;
+      static const std::uint16_t HDL_PACKET_SIZE = 1206;
+      static const std::uint16_t HDL_PACKET_RING_SIZE = 4096;
 
       enum HDLBlock
       {
@@ -240,10 +250,20 @@ namespace pcl
           double cosVertCorrection;
           double sinVertOffsetCorrection;
           double cosVertOffsetCorrection;
+          double sinAzimuthCorrection;
+          double cosAzimuthCorrection;
+      };
+
+      struct HDLPacketSlot
+      {
+          HDLDataPacket packet;
+          std::uint64_t timestamp;
       };
 
       HDLLaserCorrection laser_corrections_[HDL_MAX_NUM_LASERS];
       std::uint16_t last_azimuth_;
+      /** \brief Receive time of the packet being converted, in microseconds since the epoch (0 if unknown) */
+      std::uint64_t packet_timestamp_;
       pcl::PointCloud<pcl::PointXYZ>::Ptr current_scan_xyz_, current_sweep_xyz_;
       pcl::PointCloud<pcl::PointXYZI>::Ptr current_scan_xyzi_, current_sweep_xyzi_;
       pcl::PointCloud<pcl::PointXYZRGBA>::Ptr current_scan_xyzrgba_, current_sweep_xyzrgba_;
@@ -253,6 +273,9 @@ namespace pcl
       boost::signals2::signal<sig_cb_velodyne_hdl_scan_point_cloud_xyz>* scan_xyz_signal_;
       boost::signals2::signal<sig_cb_velodyne_hdl_scan_point_cloud_xyzrgba>* scan_xyzrgba_signal_;
       boost::signals2::signal<sig_cb_velodyne_hdl_scan_point_cloud_xyzi>* scan_xyzi_signal_;
+      pcl::io::PointCloudPool<pcl::PointXYZ> xyz_cloud_pool_;
+      pcl::io::PointCloudPool<pcl::PointXYZI> xyzi_cloud_pool_;
+      pcl::io::PointCloudPool<pcl::PointXYZRGBA> xyzrgba_cloud_pool_;
 
       void
       fireCurrentSweep ();
@@ -264,13 +287,29 @@ namespace pcl
       computeXYZI (pcl::PointXYZI& pointXYZI,
                    std::uint16_t azimuth,
                    HDLLaserReturn laserReturn,
-                   HDLLaserCorrection correction) const;
+                   const HDLLaserCorrection& correction) const;
+
+      /** \brief Returns an empty cloud leased from the pool, reusing one (and its allocated points) that every
+       *         callback released, so that sweeps and scans do not allocate at the packet rate
+       * \param[in,out] pool clouds handed out before
+       */
+      template<typename PointT> typename pcl::PointCloud<PointT>::Ptr
+      recycleCloud (pcl::io::PointCloudPool<PointT>& pool)
+      {
+        pool.setCapacity (cloud_pool_capacity_);
+        typename pcl::PointCloud<PointT>::Ptr cloud = pool.lease ();
+        cloud->clear ();
+        cloud->header = pcl::PCLHeader ();
+        cloud->is_dense = true;
+        return (cloud);
+      }
 
 
     private:
       static double *cos_lookup_table_;
       static double *sin_lookup_table_;
-      pcl::SynchronizedQueue<std::uint8_t *> hdl_data_;
+      pcl::SPSCRingBuffer<HDLPacketSlot> hdl_data_;
+      std::atomic<std::uint64_t> dropped_packets_;
       boost::asio::ip::udp::endpoint udp_listener_endpoint_;
       boost::asio::ip::address source_address_filter_;
       std::uint16_t source_port_filter_;
@@ -279,7 +318,7 @@ namespace pcl
       std::string pcap_file_name_;
       std::thread *queue_consumer_thread_;
       std::thread *hdl_read_packet_thread_;
-      bool terminate_read_packet_thread_;
+      std::atomic<bool> terminate_read_packet_thread_;
       pcl::RGB laser_rgb_mapping_[HDL_MAX_NUM_LASERS];
       float min_distance_threshold_;
       float max_distance_threshold_;
@@ -298,7 +337,8 @@ namespace pcl
 
       void
       enqueueHDLPacket (const std::uint8_t *data,
-                        std::size_t bytesReceived);
+                        std::size_t bytesReceived,
+                        std::uint64_t timestamp = 0);
 
       void
       loadCorrectionsFile (const std::string& correctionsFile);
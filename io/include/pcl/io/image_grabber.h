@@ -169,7 +169,9 @@ namespace pcl
     setDepthImageUnits (float units);
 
     /** \brief Set the number of threads, if we wish to use OpenMP for quicker cloud population.
-     *  Note that for a standard (< 4 core) machine this is unlikely to yield a drastic speedup.*/
+     *  Note that for a standard (< 4 core) machine this is unlikely to yield a drastic speedup.
+     *  \param[in] nr_threads the number of threads to use (0 takes as many as the budget of pcl::ExecutionContext allows)
+     */
     void
     setNumberOfThreads (unsigned int nr_threads = 0);
 
@@ -0,0 +1,87 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef PCL_IO_CLOUD_SEQUENCE_IMPL_H_
+#define PCL_IO_CLOUD_SEQUENCE_IMPL_H_
+
+#include <cstring>
+
+///////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> int
+pcl::io::CloudSequenceReader::read (std::size_t idx, pcl::PointCloud<PointT> &cloud) const
+{
+  Frame frame;
+  if (parseFrame (idx, frame) != 0)
+    return (-1);
+  std::vector<std::uint8_t> buffer;
+  const std::uint8_t *data = getFrameData (frame, buffer);
+  if (!data)
+    return (-1);
+
+  MsgFieldMap field_map;
+  createMapping<PointT> (frame.fields, field_map);
+
+  cloud.header.stamp = frame.timestamp;
+  cloud.header.seq = static_cast<std::uint32_t> (idx);
+  cloud.sensor_origin_ = frame.origin;
+  cloud.sensor_orientation_ = frame.orientation;
+  cloud.resize (frame.width, frame.height);
+  cloud.is_dense = frame.is_dense;
+
+  // The points are stored packed, so the whole frame is copied at once if the layouts match
+  std::uint8_t *cloud_data = reinterpret_cast<std::uint8_t*> (cloud.data ());
+  const std::size_t nr_points = cloud.size ();
+  if (field_map.size () == 1 &&
+      field_map[0].serialized_offset == 0 &&
+      field_map[0].struct_offset == 0 &&
+      field_map[0].size == frame.point_step &&
+      field_map[0].size == sizeof (PointT))
+  {
+    std::memcpy (cloud_data, data, nr_points * sizeof (PointT));
+    return (0);
+  }
+  for (std::size_t i = 0; i < nr_points; ++i)
+  {
+    const std::uint8_t *point_data = data + i * frame.point_step;
+    std::uint8_t *cloud_point = cloud_data + i * sizeof (PointT);
+    for (const pcl::detail::FieldMapping &mapping : field_map)
+      std::memcpy (cloud_point + mapping.struct_offset, point_data + mapping.serialized_offset, mapping.size);
+  }
+  return (0);
+}
+
+#endif  //#ifndef PCL_IO_CLOUD_SEQUENCE_IMPL_H_
@@ -39,6 +39,7 @@
 #define PCL_LZF_IMAGE_IO_HPP_
 
 #include <pcl/console/print.h>
+#include <pcl/common/execution_context.h>
 #include <pcl/common/utils.h> // pcl::utils::ignore
 #include <pcl/io/debayer.h>
 
@@ -157,13 +158,15 @@ LZFDepth16ImageReader::readOMP (const std::string &filename,
   cloud.resize (getWidth () * getHeight ());
   double constant_x = 1.0 / parameters_.focal_length_x,
          constant_y = 1.0 / parameters_.focal_length_y;
+  const pcl::ThreadReservation reservation (num_threads);
+  const unsigned int threads = reservation.getNumberOfThreads ();
 #ifdef _OPENMP
 #pragma omp parallel for                                   \
   default(none)                                            \
   shared(cloud, constant_x, constant_y, uncompressed_data) \
-  num_threads(num_threads)
+  num_threads(threads)
 #else
-  pcl::utils::ignore(num_threads); // suppress warning if OMP is not present
+  pcl::utils::ignore(threads); // suppress warning if OMP is not present
 #endif
   for (int i = 0; i < static_cast< int> (cloud.size ()); ++i)
   {
@@ -288,13 +291,15 @@ LZFRGB24ImageReader::readOMP (
   unsigned char *color_g = reinterpret_cast<unsigned char*> (&uncompressed_data[getWidth () * getHeight ()]);
   unsigned char *color_b = reinterpret_cast<unsigned char*> (&uncompressed_data[2 * getWidth () * getHeight ()]);
 
+  const pcl::ThreadReservation reservation (num_threads);
+  const unsigned int threads = reservation.getNumberOfThreads ();
 #ifdef _OPENMP
 #pragma omp parallel for                   \
   default(none)                            \
   shared(cloud, color_b, color_g, color_r) \
-  num_threads(num_threads)
+  num_threads(threads)
 #else
-  pcl::utils::ignore(num_threads); // suppress warning if OMP is not present
+  pcl::utils::ignore(threads); // suppress warning if OMP is not present
 #endif//_OPENMP
   for (long int i = 0; i < cloud.size (); ++i)
   {
@@ -403,13 +408,15 @@ LZFYUV422ImageReader::readOMP (
   unsigned char *color_y = reinterpret_cast<unsigned char*> (&uncompressed_data[wh2]);
   unsigned char *color_v = reinterpret_cast<unsigned char*> (&uncompressed_data[wh2 + getWidth () * getHeight ()]);
 
+  const pcl::ThreadReservation reservation (num_threads);
+  const unsigned int threads = reservation.getNumberOfThreads ();
 #ifdef _OPENMP
 #pragma omp parallel for                        \
   default(none)                                 \
   shared(cloud, color_u, color_v, color_y, wh2) \
-  num_threads(num_threads)
+  num_threads(threads)
 #else
-  pcl::utils::ignore(num_threads); //suppress warning if OMP is not present
+  pcl::utils::ignore(threads); //suppress warning if OMP is not present
 #endif//_OPENMP
   for (int i = 0; i < wh2; ++i)
   {
@@ -519,12 +526,14 @@ LZFBayer8ImageReader::readOMP (
   cloud.width  = getWidth ();
   cloud.height = getHeight ();
   cloud.resize (getWidth () * getHeight ());
+  const pcl::ThreadReservation reservation (num_threads);
+  const unsigned int threads = reservation.getNumberOfThreads ();
 #ifdef _OPENMP
 #pragma omp parallel for \
   default(none)          \
-  num_threads(num_threads)
+  num_threads(threads)
 #else
-  pcl::utils::ignore(num_threads); //suppress warning if OMP is not present
+  pcl::utils::ignore(threads); //suppress warning if OMP is not present
 #endif//_OPENMP
   for (long int i = 0; i < cloud.size (); ++i)
   {
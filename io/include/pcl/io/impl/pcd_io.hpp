@@ -247,6 +247,13 @@ pcl::PCDWriter::writeBinaryCompressed (const std::string &file_name,
     throw pcl::IOException ("[pcl::PCDWriter::writeBinaryCompressed] Input point cloud has no data!");
     return (-1);
   }
+
+  // Stream the chunks to disk while they are compressed
+  if (compression_chunk_size_ > 0)
+    return (writeBinaryCompressedChunks (file_name, generateHeader<PointT> (cloud),
+                                         reinterpret_cast<const std::uint8_t*> (cloud.data ()),
+                                         cloud.size (), sizeof (PointT), pcl::getFields<PointT> ()));
+
   int data_idx = 0;
   std::ostringstream oss;
   oss << generateHeader<PointT> (cloud) << "DATA binary_compressed\n";
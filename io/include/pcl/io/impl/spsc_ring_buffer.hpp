@@ -0,0 +1,134 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+namespace pcl
+{
+  /** \brief Fixed capacity, lock-free queue between exactly one producer and one consumer thread.
+    * The slots are allocated once; the producer fills a slot in place and publishes it, the consumer
+    * reads it in place and hands it back, so that no element is copied or allocated while streaming.
+    */
+  template<typename T>
+  class SPSCRingBuffer
+  {
+    public:
+      /** \brief Constructor.
+        * \param[in] capacity the minimum number of slots, rounded up to a power of two
+        */
+      explicit SPSCRingBuffer (std::size_t capacity)
+      {
+        std::size_t size = 1;
+        while (size < capacity)
+          size <<= 1;
+        slots_.resize (size);
+        mask_ = size - 1;
+        head_ = 0;
+        tail_ = 0;
+      }
+
+      /** \brief Producer side: get the next free slot, or nullptr if the buffer is full. */
+      T*
+      beginPush ()
+      {
+        const std::size_t head = head_.load (std::memory_order_relaxed);
+        if (head - tail_.load (std::memory_order_acquire) == slots_.size ())
+          return (nullptr);
+        return (&slots_[head & mask_]);
+      }
+
+      /** \brief Producer side: publish the slot obtained from beginPush (). */
+      void
+      endPush ()
+      {
+        head_.store (head_.load (std::memory_order_relaxed) + 1, std::memory_order_release);
+      }
+
+      /** \brief Consumer side: get the oldest published slot, or nullptr if the buffer is empty. */
+      T*
+      beginPop ()
+      {
+        const std::size_t tail = tail_.load (std::memory_order_relaxed);
+        if (tail == head_.load (std::memory_order_acquire))
+          return (nullptr);
+        return (&slots_[tail & mask_]);
+      }
+
+      /** \brief Consumer side: hand the slot obtained from beginPop () back to the producer. */
+      void
+      endPop ()
+      {
+        tail_.store (tail_.load (std::memory_order_relaxed) + 1, std::memory_order_release);
+      }
+
+      /** \brief Drop all published slots. Must not be called while either thread is running. */
+      void
+      clear ()
+      {
+        tail_.store (head_.load ());
+      }
+
+      /** \brief Whether no slot is published. */
+      bool
+      isEmpty () const
+      {
+        return (head_.load (std::memory_order_acquire) == tail_.load (std::memory_order_acquire));
+      }
+
+      /** \brief Number of slots. */
+      std::size_t
+      capacity () const
+      {
+        return (slots_.size ());
+      }
+
+    private:
+      std::vector<T> slots_;
+      std::size_t mask_;
+
+      // the producer and consumer indices live on separate cache lines
+      char pad0_[64];
+      std::atomic<std::size_t> head_;
+      char pad1_[64 - sizeof (std::atomic<std::size_t>)];
+      std::atomic<std::size_t> tail_;
+      char pad2_[64 - sizeof (std::atomic<std::size_t>)];
+  };
+}
@@ -205,7 +205,7 @@ namespace pcl
         
         /** \brief Read the data stored in a PCLZF depth file and convert it to a pcl::PointCloud type.
           * \param[in] filename the file name to read the data from
-          * \param[in] num_threads The number of threads to use. 0 indicates OpenMP is free to choose.
+          * \param[in] num_threads The number of threads to use. 0 takes as many as the budget of pcl::ExecutionContext allows.
           * \param[out] cloud the resultant output point cloud
           */
         template <typename PointT> bool
@@ -256,7 +256,7 @@ namespace pcl
         /** \brief Read the data stored in a PCLZF RGB file and convert it to a pcl::PointCloud type.
           * Note that, unless massively multithreaded, this will likely not result in a significant speedup and may even slow performance.
           * \param[in] filename the file name to read the data from
-          * \param[in] num_threads The number of threads to use
+          * \param[in] num_threads The number of threads to use. 0 takes as many as the budget of pcl::ExecutionContext allows.
           * \param[out] cloud the resultant output point cloud
           */
         template <typename PointT> bool
@@ -303,7 +303,7 @@ namespace pcl
         /** \brief Read the data stored in a PCLZF YUV422 file and convert it to a pcl::PointCloud type.
           * Note that, unless massively multithreaded, this will likely not result in a significant speedup
           * \param[in] filename the file name to read the data from
-          * \param[in] num_threads The number of threads to use
+          * \param[in] num_threads The number of threads to use. 0 takes as many as the budget of pcl::ExecutionContext allows.
           * \param[out] cloud the resultant output point cloud
           */
         template <typename PointT> bool
@@ -341,7 +341,7 @@ namespace pcl
         /** \brief Read the data stored in a PCLZF Bayer 8bit file and convert it to a pcl::PointCloud type.
           * Note that, unless massively multithreaded, this will likely not result in a significant speedup and may even slow performance.
           * \param[in] filename the file name to read the data from
-          * \param[in] num_threads The number of threads to use
+          * \param[in] num_threads The number of threads to use. 0 takes as many as the budget of pcl::ExecutionContext allows.
           * \param[out] cloud the resultant output point cloud
           */
         template <typename PointT> bool
@@ -0,0 +1,206 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#pragma once
+
+#include <cfloat>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <type_traits>
+
+namespace pcl
+{
+  namespace io
+  {
+    namespace detail
+    {
+      /** \brief Parse a decimal integer of the form [-]digits from [begin, end).
+        *
+        * Locale independent and allocation free. Only the plain form that every
+        * standard conversion agrees on is handled: the function returns false
+        * for anything else (signs on unsigned types, out of range values, extra
+        * characters, ...) so that the caller can fall back to its regular
+        * stream based conversion, which then keeps its exact semantics.
+        * \param[in] begin the first character of the token
+        * \param[in] end one past the last character of the token
+        * \param[out] value the parsed value, only set on success
+        * \return true if the token was parsed
+        */
+      template <typename Type> inline std::enable_if_t<std::is_integral<Type>::value, bool>
+      parseNumber (const char *begin, const char *end, Type &value)
+      {
+        static_assert (sizeof (Type) < sizeof (std::int64_t), "64 bit integers are not supported");
+        bool negative = false;
+        if (begin != end && *begin == '-')
+        {
+          if (!std::is_signed<Type>::value)
+            return (false);
+          negative = true;
+          ++begin;
+        }
+        // 18 digits cannot overflow the accumulator
+        if (begin == end || end - begin > 18)
+          return (false);
+
+        std::int64_t result = 0;
+        for (; begin != end; ++begin)
+        {
+          const unsigned int digit = static_cast<unsigned char> (*begin) - '0';
+          if (digit > 9)
+            return (false);
+          result = result * 10 + digit;
+        }
+        if (negative)
+          result = -result;
+        if (result < static_cast<std::int64_t> (std::numeric_limits<Type>::min ()) ||
+            result > static_cast<std::int64_t> (std::numeric_limits<Type>::max ()))
+          return (false);
+        value = static_cast<Type> (result);
+        return (true);
+      }
+
+      /** \brief Parse a decimal floating point number of the form
+        * [-]digits[.digits][(e|E)[+|-]digits] from [begin, end).
+        *
+        * Locale independent and allocation free. Numbers whose decimal
+        * mantissa fits in 53 bits and whose exponent is small enough for the
+        * power of ten to be exact (Clinger's fast path) are converted with a
+        * single correctly rounded operation, which gives the same result as
+        * strtod()/strtof(). Everything else (long mantissas, large exponents,
+        * nan, inf, hexadecimal, ...) returns false so that the caller can fall
+        * back to its regular conversion.
+        * \param[in] begin the first character of the token
+        * \param[in] end one past the last character of the token
+        * \param[out] value the parsed value, only set on success
+        * \return true if the token was parsed
+        */
+      template <typename Type> inline std::enable_if_t<std::is_floating_point<Type>::value, bool>
+      parseNumber (const char *begin, const char *end, Type &value)
+      {
+        static_assert (std::is_same<Type, float>::value || std::is_same<Type, double>::value,
+                       "only float and double are supported");
+#if !defined (FLT_EVAL_METHOD) || FLT_EVAL_METHOD != 0
+        // Extended precision intermediates (x87) would round twice
+        return (false);
+#endif
+        static const double powers_of_ten[] = {
+          1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+          1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+
+        bool negative = false;
+        if (begin != end && *begin == '-')
+        {
+          negative = true;
+          ++begin;
+        }
+
+        std::uint64_t mantissa = 0;
+        int nr_digits = 0, exponent = 0;
+        bool any_digit = false;
+        for (; begin != end && static_cast<unsigned char> (*begin - '0') <= 9; ++begin)
+        {
+          any_digit = true;
+          if (mantissa == 0 && *begin == '0')
+            continue;
+          if (++nr_digits > 19)
+            return (false);
+          mantissa = mantissa * 10 + static_cast<unsigned int> (*begin - '0');
+        }
+        if (begin != end && *begin == '.')
+        {
+          for (++begin; begin != end && static_cast<unsigned char> (*begin - '0') <= 9; ++begin)
+          {
+            any_digit = true;
+            --exponent;
+            if (mantissa == 0 && *begin == '0')
+              continue;
+            if (++nr_digits > 19)
+              return (false);
+            mantissa = mantissa * 10 + static_cast<unsigned int> (*begin - '0');
+          }
+        }
+        if (!any_digit)
+          return (false);
+        if (begin != end && (*begin == 'e' || *begin == 'E'))
+        {
+          ++begin;
+          bool negative_exponent = false;
+          if (begin != end && (*begin == '-' || *begin == '+'))
+            negative_exponent = (*begin++ == '-');
+          if (begin == end || end - begin > 4)
+            return (false);
+          int explicit_exponent = 0;
+          for (; begin != end; ++begin)
+          {
+            const unsigned int digit = static_cast<unsigned char> (*begin) - '0';
+            if (digit > 9)
+              return (false);
+            explicit_exponent = explicit_exponent * 10 + static_cast<int> (digit);
+          }
+          exponent += negative_exponent ? -explicit_exponent : explicit_exponent;
+        }
+        if (begin != end)
+          return (false);
+
+        double result = 0.0;
+        if (mantissa != 0)
+        {
+          if (mantissa > (std::uint64_t (1) << 53) || exponent < -22 || exponent > 22)
+            return (false);
+          result = static_cast<double> (mantissa);
+          result = exponent < 0 ? result / powers_of_ten[-exponent] : result * powers_of_ten[exponent];
+        }
+
+        if (std::is_same<Type, float>::value && result != 0.0)
+        {
+          // Rounding the double to float gives the correctly rounded float, unless
+          // the double is below the normal float range, overflows, or falls exactly
+          // on a midpoint between two floats (where the decimal may lie on either side)
+          if (result < FLT_MIN || result > FLT_MAX)
+            return (false);
+          std::uint64_t bits;
+          std::memcpy (&bits, &result, sizeof (bits));
+          if ((bits & 0x1FFFFFFFu) == 0x10000000u)
+            return (false);
+        }
+        value = static_cast<Type> (negative ? -result : result);
+        return (true);
+      }
+    } // namespace detail
+  } // namespace io
+} // namespace pcl
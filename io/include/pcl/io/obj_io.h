@@ -37,9 +37,13 @@
 #pragma once
 
 #include <pcl/memory.h>
+#include <pcl/PolygonMeshBuffer.h>
 #include <pcl/TextureMesh.h>
 #include <pcl/io/file_io.h>
 
+#include <cstdint>
+#include <vector>
+
 namespace pcl
 {
   struct PolygonMesh;
@@ -218,6 +222,56 @@ namespace pcl
       int
       read (const std::string &file_name, pcl::PolygonMesh &mesh, const int offset = 0);
 
+      /** \brief Read the vertices and the polygons of an OBJ file, the polygons as a flat buffer of vertex
+        * indices, e.g. for uploading them to a GPU index buffer.
+        *
+        * Polygon i has the vertices polygon_indices[polygon_offsets[i]] to
+        * polygon_indices[polygon_offsets[i + 1] - 1], so \a polygon_offsets has one entry more than there are
+        * polygons. Relative (negative) vertex indices are resolved, texture coordinate and normal indices of the
+        * faces are ignored.
+        * \param[in] file_name the name of the file containing data
+        * \param[out] cloud the vertices, with their normals if the file has vertex normals
+        * \param[out] polygon_indices the vertex indices of all the polygons
+        * \param[out] polygon_offsets the position of the first vertex index of every polygon, and the number of indices
+        * \param[in] offset the offset in the file where to expect the true header to begin.
+        *
+        * \return 0 on success.
+        */
+      int
+      read (const std::string &file_name, pcl::PCLPointCloud2 &cloud,
+            std::vector<std::uint32_t> &polygon_indices, std::vector<std::uint32_t> &polygon_offsets,
+            const int offset = 0);
+
+      /** \brief Read the vertices and the polygons of an OBJ file into a pcl::PolygonMeshBuffer, see
+        * read (const std::string &, pcl::PCLPointCloud2 &, std::vector<std::uint32_t> &, std::vector<std::uint32_t> &, const int).
+        * \param[in] file_name the name of the file containing data
+        * \param[out] mesh the resultant mesh
+        * \param[in] offset the offset in the file where to expect the true header to begin.
+        *
+        * \return 0 on success.
+        */
+      inline int
+      read (const std::string &file_name, pcl::PolygonMeshBuffer &mesh, const int offset = 0)
+      {
+        return (read (file_name, mesh.cloud, mesh.indices, mesh.offsets, offset));
+      }
+
+      /** \brief Set the number of threads used to parse the files, see read (). Files read into a
+        * pcl::PCLPointCloud2, a pcl::PolygonMesh or a flat index buffer are memory mapped and parsed in chunks
+        * of lines in parallel; TextureMesh files are read line by line.
+        * \param[in] nr_threads the number of threads (0 for as many as the budget of pcl::ExecutionContext
+        * allows when reading)
+        */
+      void
+      setNumberOfThreads (unsigned int nr_threads = 0);
+
+      /** \brief Get the number of threads used to parse the files. */
+      inline unsigned int
+      getNumberOfThreads () const
+      {
+        return (threads_);
+      }
+
       /** \brief Read a point cloud data from any FILE file, and convert it to the given
         * template format.
         * \param[in] file_name the name of the file containing the actual PointCloud data
@@ -244,8 +298,20 @@ namespace pcl
       }
 
     private:
+      /** \brief Map an OBJ file into memory and parse its vertices, vertex normals and, if \a read_polygons,
+        * its polygons, in chunks of lines in parallel.
+        * \return 0 on success
+        */
+      int
+      readMapped (const std::string &file_name, const int offset, bool read_polygons,
+                  pcl::PCLPointCloud2 &cloud, std::vector<std::uint32_t> &polygon_indices,
+                  std::vector<std::uint32_t> &polygon_offsets);
+
       /// Usually OBJ files come MTL files where texture materials are stored
       std::vector<pcl::MTLReader> companions_;
+
+      /** \brief The number of threads used to parse the files. */
+      unsigned int threads_ = 1;
   };
 
   namespace io
@@ -306,6 +372,20 @@ namespace pcl
       return (p.read (file_name, mesh));
     }
 
+    /** \brief Load any OBJ file into a PolygonMeshBuffer type.
+      * \param[in] file_name the name of the file to load
+      * \param[out] mesh the resultant mesh
+      * \return 0 on success < 0 on error
+      *
+      * \ingroup io
+      */
+    inline int
+    loadOBJFile (const std::string &file_name, pcl::PolygonMeshBuffer &mesh)
+    {
+      pcl::OBJReader p;
+      return (p.read (file_name, mesh));
+    }
+
     /** \brief Load any OBJ file into a TextureMesh type.
       * \param[in] file_name the name of the file to load
       * \param[out] mesh the resultant mesh
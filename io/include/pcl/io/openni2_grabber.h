@@ -47,8 +47,10 @@
 
 #include <pcl/point_cloud.h>
 #include <pcl/io/grabber.h>
+#include <pcl/io/point_cloud_pool.h>
 #include <pcl/io/openni2/openni2_device.h>
 #include <string>
+#include <tuple>
 #include <pcl/common/synchronizer.h>
 
 #include <pcl/io/image.h>
@@ -291,6 +293,12 @@ namespace pcl
           depth_principal_point_y = depth_parameters_.principal_point_y;
         }
 
+        /** \brief Set the number of threads converting depth images into point clouds, one image row per task (default 1).
+        * \param[in] nr_threads the number of hardware threads to use (0 takes as many as the budget of pcl::ExecutionContext allows)
+        */
+        void
+        setNumberOfThreads (unsigned int nr_threads = 0);
+
         /** \brief Set the Depth image focal length (fx = fy).
         * \param[in] depth_focal_length the Depth focal length (assumes fx = fy)
         * Setting the parameter to a non-finite value (e.g., NaN, Inf) invalidates it
@@ -421,10 +429,25 @@ namespace pcl
         convertToXYZIPointCloud (const pcl::io::openni2::IRImage::Ptr &image,
           const pcl::io::openni2::DepthImage::Ptr &depth_image);
 
+        /** \brief Fill ray_x_ / ray_y_ with the back-projection factors (u - cx) / fx and (v - cy) / fy of every
+        * depth image column and row, so that the converters only multiply each depth value by two table entries.
+        * \param[in] width the number of columns
+        * \param[in] height the number of rows
+        */
+        void
+        updateRayTables (unsigned width, unsigned height, float fx_inv, float fy_inv, float cx, float cy);
+
         std::vector<std::uint8_t> color_resize_buffer_;
         std::vector<std::uint16_t> depth_resize_buffer_;
         std::vector<std::uint16_t> ir_resize_buffer_;
 
+        /** \brief Per-column and per-row back-projection factors, see updateRayTables. */
+        std::vector<float> ray_x_;
+        std::vector<float> ray_y_;
+
+        /** \brief The number of threads converting depth images into point clouds. */
+        unsigned int threads_;
+
         // Stream callbacks /////////////////////////////////////////////////////
         void
         processColorFrame (openni::VideoStream& stream);
@@ -492,6 +515,16 @@ namespace pcl
         CameraParameters rgb_parameters_;
         CameraParameters depth_parameters_;
 
+        /** \brief Lease a cloud of the given point type from cloud_pools_. */
+        template <typename PointT> typename pcl::PointCloud<PointT>::Ptr
+        leaseCloud ();
+
+        /** \brief Clouds handed out to the point cloud callbacks, returned here once every callback released them. */
+        std::tuple<pcl::io::PointCloudPool<pcl::PointXYZ>,
+                   pcl::io::PointCloudPool<pcl::PointXYZI>,
+                   pcl::io::PointCloudPool<pcl::PointXYZRGB>,
+                   pcl::io::PointCloudPool<pcl::PointXYZRGBA> > cloud_pools_;
+
       public:
         PCL_MAKE_ALIGNED_OPERATOR_NEW
     };
@@ -106,6 +106,39 @@ namespace pcl
       virtual void
       rewind ();
 
+      /** \brief Decode the next frames in the background, so that playback at the recorded rate does not stall on
+        * slow disks. Worker threads decode up to \a nr_frames frames ahead of the one published next into a bounded
+        * queue, and trigger() only publishes the next frame of the queue. Playback restarts from the first frame.
+        * \param[in] nr_frames the maximum number of decoded frames waiting to be published, 0 disables the read-ahead
+        * and decodes every frame when it is published (default)
+        * \param[in] nr_workers the number of threads decoding frames
+        */
+      void
+      setReadAhead (std::size_t nr_frames, unsigned int nr_workers = 1);
+
+      /** \brief Returns the maximum number of frames decoded ahead, 0 if the read-ahead is disabled. */
+      std::size_t
+      getReadAhead () const;
+
+      /** \brief Map TAR archives into memory once and decode their frames from the mapping, instead of opening the
+        * archive for every frame. Used by the read-ahead, see setReadAhead().
+        * \param[in] use_memory_mapping whether to map TAR archives into memory
+        */
+      void
+      setUseMemoryMapping (bool use_memory_mapping);
+
+      /** \brief Returns whether TAR archives are mapped into memory. */
+      bool
+      getUseMemoryMapping () const;
+
+      /** \brief Continue the playback at frame \a idx, dropping the frames decoded ahead. Requires the read-ahead,
+        * see setReadAhead().
+        * \param[in] idx the index of the next frame to publish
+        * \return false if the read-ahead is disabled or \a idx is out of range
+        */
+      bool
+      seek (std::size_t idx);
+
       /** \brief Returns the frames_per_second. 0 if grabber is trigger-based */
       float
       getFramesPerSecond () const override;
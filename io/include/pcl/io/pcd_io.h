@@ -45,6 +45,8 @@
 #include <pcl/io/file_io.h>
 #include <boost/interprocess/sync/file_lock.hpp> // for file_lock
 
+#include <functional>
+
 namespace pcl
 {
   /** \brief Point Cloud Data (PCD) file format reader.
@@ -55,7 +57,7 @@ namespace pcl
   {
     public:
       /** Empty constructor */
-      PCDReader () {}
+      PCDReader () : threads_ (1) {}
       /** Empty destructor */
       ~PCDReader () {}
 
@@ -102,7 +104,8 @@ namespace pcl
         * \param[out] origin the sensor acquisition origin (only for > PCD_V7 - null if not present)
         * \param[out] orientation the sensor acquisition orientation (only for > PCD_V7 - identity if not present)
         * \param[out] pcd_version the PCD version of the file (i.e., PCD_V6, PCD_V7)
-        * \param[out] data_type the type of data (0 = ASCII, 1 = Binary, 2 = Binary compressed)
+        * \param[out] data_type the type of data (0 = ASCII, 1 = Binary, 2 = Binary compressed,
+        *             3 = Binary compressed in chunks)
         * \param[out] data_idx the offset of cloud data within the file
         *
         * \return
@@ -130,7 +133,8 @@ namespace pcl
         * \param[out] origin the sensor acquisition origin (only for > PCD_V7 - null if not present)
         * \param[out] orientation the sensor acquisition orientation (only for > PCD_V7 - identity if not present)
         * \param[out] pcd_version the PCD version of the file (i.e., PCD_V6, PCD_V7)
-        * \param[out] data_type the type of data (0 = ASCII, 1 = Binary, 2 = Binary compressed)
+        * \param[out] data_type the type of data (0 = ASCII, 1 = Binary, 2 = Binary compressed,
+        *             3 = Binary compressed in chunks)
         * \param[out] data_idx the offset of cloud data within the file
         * \param[in] offset the offset of where to expect the PCD Header in the
         * file (optional parameter). One usage example for setting the offset
@@ -195,6 +199,26 @@ namespace pcl
       int
       readBodyASCII (std::istream &stream, pcl::PCLPointCloud2 &cloud, int pcd_version);
 
+      /** \brief Read the point cloud data (body) from a block of text in memory.
+        *
+        * Reads the cloud points from the text-formatted range [begin, end), with
+        * the same results as the stream version. For use after readHeader(), when
+        * the resulting data_type == 0. Large bodies are split in blocks of lines
+        * that are parsed in parallel, see setNumberOfThreads().
+        *
+        * \param[in] begin the first character of the body.
+        * \param[in] end one past the last character of the body.
+        * \param[out] cloud the resultant point cloud dataset to be filled.
+        * \param[in] pcd_version the PCD version of the stream (from readHeader()).
+        *
+        * \return
+        *  * < 0 (-1) on error
+        *  * == 0 on success
+        */
+      int
+      readBodyASCII (const char *begin, const char *end, pcl::PCLPointCloud2 &cloud,
+                     int pcd_version);
+
       /** \brief Read the point cloud data (body) from a block of memory.
         *
         * Reads the cloud points from a binary-formatted memory block.  For use
@@ -215,6 +239,13 @@ namespace pcl
       readBodyBinary (const unsigned char *data, pcl::PCLPointCloud2 &cloud,
                        int pcd_version, bool compressed, unsigned int data_idx);
 
+      /** \brief Set the number of threads used to parse ASCII files and to decompress chunked
+        * binary_compressed files.
+        * \param[in] nr_threads the number of hardware threads to use (0 takes as many as the budget of pcl::ExecutionContext allows)
+        */
+      void
+      setNumberOfThreads (unsigned int nr_threads = 0);
+
       /** \brief Read a point cloud data from a PCD file and store it into a pcl/PCLPointCloud2.
         * \param[in] file_name the name of the file containing the actual PointCloud data
         * \param[out] cloud the resultant PointCloud message read from disk
@@ -236,6 +267,26 @@ namespace pcl
       read (const std::string &file_name, pcl::PCLPointCloud2 &cloud,
             Eigen::Vector4f &origin, Eigen::Quaternionf &orientation, int &pcd_version, const int offset = 0) override;
 
+      /** \brief Read a point cloud data from a PCD file held in memory and store it into a pcl/PCLPointCloud2.
+        *
+        * Gives the same results as reading the file from disk, e.g. for a memory mapped file or an entry of
+        * a memory mapped TAR archive, without opening the file again.
+        *
+        * \param[in] data the first byte of the PCD file
+        * \param[in] size the size of the PCD file in bytes
+        * \param[out] cloud the resultant PointCloud message
+        * \param[out] origin the sensor acquisition origin (only for > PCD_V7 - null if not present)
+        * \param[out] orientation the sensor acquisition orientation (only for > PCD_V7 - identity if not present)
+        * \param[out] pcd_version the PCD version of the file (either PCD_V6 or PCD_V7)
+        *
+        * \return
+        *  * < 0 (-1) on error
+        *  * == 0 on success
+        */
+      int
+      read (const unsigned char *data, std::size_t size, pcl::PCLPointCloud2 &cloud,
+            Eigen::Vector4f &origin, Eigen::Quaternionf &orientation, int &pcd_version);
+
       /** \brief Read a point cloud data from a PCD (PCD_V6) and store it into a pcl/PCLPointCloud2.
         *
         * \note This function is provided for backwards compatibility only and
@@ -260,6 +311,10 @@ namespace pcl
       read (const std::string &file_name, pcl::PCLPointCloud2 &cloud, const int offset = 0);
 
       /** \brief Read a point cloud data from any PCD file, and convert it to the given template format.
+        *
+        * Uncompressed binary files are streamed straight into the points of \a cloud,
+        * without an intermediate PCLPointCloud2, so the point data is copied only once.
+        *
         * \param[in] file_name the name of the file containing the actual PointCloud data
         * \param[out] cloud the resultant PointCloud message read from disk
         * \param[in] offset the offset of where to expect the PCD Header in the
@@ -278,16 +333,99 @@ namespace pcl
       {
         pcl::PCLPointCloud2 blob;
         int pcd_version;
-        int res = read (file_name, blob, cloud.sensor_origin_, cloud.sensor_orientation_,
-                        pcd_version, offset);
+        int data_type;
+        unsigned int data_idx;
+        int res = parseHeader (file_name, blob, cloud.sensor_origin_, cloud.sensor_orientation_,
+                               pcd_version, data_type, data_idx, offset, false);
+        if (res < 0)
+          return (res);
+
+        MsgFieldMap field_map;
+        createMapping<PointT> (blob.fields, field_map);
+
+        // Uncompressed binary data is copied once, from the file into the points
+        if (data_type == 1)
+        {
+          const bool same_layout = field_map.size () == 1 &&
+                                   field_map[0].serialized_offset == 0 &&
+                                   field_map[0].struct_offset == 0 &&
+                                   field_map[0].size == blob.point_step &&
+                                   field_map[0].size == sizeof (PointT);
+          cloud.header = blob.header;
+          cloud.resize (blob.width, blob.height);
+          auto *cloud_data = reinterpret_cast<std::uint8_t*> (cloud.data ());
+          bool is_dense = true;
+          res = readBodyBinary (file_name, blob, offset + data_idx, is_dense,
+                                [&] (const std::uint8_t *data, std::size_t begin, std::size_t nr_points)
+          {
+            std::uint8_t *out = cloud_data + begin * sizeof (PointT);
+            if (same_layout)
+            {
+              memcpy (out, data, nr_points * sizeof (PointT));
+              return;
+            }
+            for (std::size_t i = 0; i < nr_points; ++i, data += blob.point_step, out += sizeof (PointT))
+              for (const detail::FieldMapping& mapping : field_map)
+                memcpy (out + mapping.struct_offset, data + mapping.serialized_offset, mapping.size);
+          });
+          cloud.is_dense = is_dense;
+          return (res);
+        }
+
+        res = read (file_name, blob, cloud.sensor_origin_, cloud.sensor_orientation_,
+                    pcd_version, offset);
 
         // If no error, convert the data
         if (res == 0)
-          pcl::fromPCLPointCloud2 (blob, cloud);
+          pcl::fromPCLPointCloud2 (blob, cloud, field_map);
         return (res);
       }
 
       PCL_MAKE_ALIGNED_OPERATOR_NEW
+
+    private:
+      /** \brief Parse a PCD header from a stream, see readHeader().
+        * \param[in] allocate_data whether to resize the data of \a cloud to the size of the body
+        */
+      int
+      parseHeader (std::istream &binary_istream, pcl::PCLPointCloud2 &cloud,
+                   Eigen::Vector4f &origin, Eigen::Quaternionf &orientation, int &pcd_version,
+                   int &data_type, unsigned int &data_idx, bool allocate_data);
+
+      /** \brief Parse the header of a PCD file, see readHeader().
+        * \param[in] allocate_data whether to resize the data of \a cloud to the size of the body
+        */
+      int
+      parseHeader (const std::string &file_name, pcl::PCLPointCloud2 &cloud,
+                   Eigen::Vector4f &origin, Eigen::Quaternionf &orientation, int &pcd_version,
+                   int &data_type, unsigned int &data_idx, const int offset, bool allocate_data);
+
+      /** \brief Stream the uncompressed binary body of a PCD file in chunks of whole points.
+        * \param[in] file_name the name of the file
+        * \param[in] cloud the header of the file, as returned by parseHeader()
+        * \param[in] data_offset the offset of the body within the file
+        * \param[out] is_dense false if any floating point field holds NaN/Inf values
+        * \param[in] consume called with the serialized points, the index of the first
+        * point and the number of points of every chunk
+        * \return < 0 on error, 0 on success
+        */
+      int
+      readBodyBinary (const std::string &file_name, const pcl::PCLPointCloud2 &cloud,
+                      std::size_t data_offset, bool &is_dense,
+                      const std::function<void (const std::uint8_t*, std::size_t, std::size_t)> &consume);
+
+      /** \brief Read the body of a chunked binary_compressed file, see PCDWriter::setCompressionChunkSize().
+        * \param[in] data the memory location from which to read the body
+        * \param[out] cloud the resultant point cloud, with fields and data allocated by readHeader()
+        * \param[in] data_idx the offset of the body, as reported by readHeader()
+        * \return < 0 on error, 0 on success
+        */
+      int
+      readBodyBinaryChunked (const unsigned char *data, pcl::PCLPointCloud2 &cloud,
+                             std::size_t data_idx);
+
+      /** \brief The number of threads used for parsing and decompression. */
+      unsigned int threads_;
   };
 
   /** \brief Point Cloud Data (PCD) file format writer.
@@ -297,7 +435,7 @@ namespace pcl
   class PCL_EXPORTS PCDWriter : public FileWriter
   {
     public:
-      PCDWriter() : map_synchronization_(false) {}
+      PCDWriter() : map_synchronization_(false), compression_chunk_size_(0), threads_(1) {}
       ~PCDWriter() {}
 
       /** \brief Set whether mmap() synchornization via msync() is desired before munmap() calls.
@@ -314,6 +452,37 @@ namespace pcl
         map_synchronization_ = sync;
       }
 
+      /** \brief Set the number of points per chunk of binary_compressed files.
+        *
+        * With a chunk size, writeBinaryCompressed stores the data as a sequence of
+        * independently LZF compressed chunks, each one in the field-major layout of the
+        * binary_compressed format, preceded by an index of their sizes (DATA
+        * chunked_binary_compressed). The chunks are compressed in parallel and written as
+        * they are done, and PCDReader decompresses them in parallel as well. The chunked
+        * format also lifts the 4 GB limit of the single block format. Files written with
+        * a chunk size cannot be read by older versions of PCL.
+        * \param[in] nr_points the number of points per chunk (0, the default, writes the
+        * single block binary_compressed format)
+        */
+      void
+      setCompressionChunkSize (unsigned int nr_points)
+      {
+        compression_chunk_size_ = nr_points;
+      }
+
+      /** \brief Get the number of points per chunk of binary_compressed files (0 for a single block). */
+      unsigned int
+      getCompressionChunkSize () const
+      {
+        return (compression_chunk_size_);
+      }
+
+      /** \brief Set the number of threads used to compress chunked binary_compressed files.
+        * \param[in] nr_threads the number of hardware threads to use (0 takes as many as the budget of pcl::ExecutionContext allows)
+        */
+      void
+      setNumberOfThreads (unsigned int nr_threads = 0);
+
       /** \brief Generate the header of a PCD file format
         * \param[in] cloud the point cloud data message
         * \param[in] origin the sensor acquisition origin
@@ -602,8 +771,42 @@ namespace pcl
                                boost::interprocess::file_lock &lock);
 
     private:
+      /** \brief Write the body of a chunked binary_compressed file.
+        * \param[out] os the stream into which to write the body, must support seeking
+        * \param[in] data the points to write
+        * \param[in] nr_points the number of points
+        * \param[in] point_step the size of a point in \a data
+        * \param[in] fields the fields of the points
+        * \return (-1) for a general error, (-2) if a chunk is too large, 0 on success
+        */
+      int
+      writeBinaryCompressedChunks (std::ostream &os, const std::uint8_t *data,
+                                   std::size_t nr_points, std::size_t point_step,
+                                   const std::vector<pcl::PCLPointField> &fields);
+
+      /** \brief Write a chunked binary_compressed file, streaming the chunks to disk.
+        * \param[in] file_name the output file name
+        * \param[in] header the PCD header, without the DATA line
+        * \param[in] data the points to write
+        * \param[in] nr_points the number of points
+        * \param[in] point_step the size of a point in \a data
+        * \param[in] fields the fields of the points
+        * \return (-1) for a general error, (-2) if a chunk is too large, 0 on success
+        */
+      int
+      writeBinaryCompressedChunks (const std::string &file_name, const std::string &header,
+                                   const std::uint8_t *data, std::size_t nr_points,
+                                   std::size_t point_step,
+                                   const std::vector<pcl::PCLPointField> &fields);
+
       /** \brief Set to true if msync() should be called before munmap(). Prevents data loss on NFS systems. */
       bool map_synchronization_;
+
+      /** \brief The number of points per compressed chunk, 0 for a single block. */
+      unsigned int compression_chunk_size_;
+
+      /** \brief The number of threads used for compression. */
+      unsigned int threads_;
   };
 
   namespace io
@@ -42,6 +42,7 @@
 
 #include <pcl/io/ply/ply.h>
 #include <pcl/io/ply/io_operators.h>
+#include <pcl/io/number_parser.h>
 #include <pcl/pcl_macros.h>
 
 #include <istream>
@@ -87,6 +88,13 @@ namespace pcl
           using end_element_callback_type = std::function<void ()>;
           using element_callbacks_type = std::tuple<begin_element_callback_type, end_element_callback_type>;
           using element_definition_callback_type = std::function<element_callbacks_type (const std::string&, std::size_t)>;
+          /** Called with the element name, the element count, the size of one element and the
+            * stream, for the elements of a binary file in host byte order whose properties are
+            * all scalars. Returns true if it read the count elements from the stream itself, in
+            * which case the per-property callbacks of that element are skipped, or false without
+            * touching the stream to let the parser proceed as usual.
+            */
+          using binary_element_callback_type = std::function<bool (const std::string&, std::size_t, std::size_t, std::istream&)>;
          
           template <typename ScalarType>
           struct scalar_property_callback_type
@@ -290,6 +298,9 @@ namespace pcl
           inline void
           end_header_callback (const end_header_callback_type& end_header_callback);
 
+          inline void
+          binary_element_callback (const binary_element_callback_type& binary_element_callback);
+
           using flags_type = int;
           enum flags { };
 
@@ -376,6 +387,9 @@ namespace pcl
             begin_element_callback_type begin_element_callback;
             end_element_callback_type end_element_callback;
             std::vector<std::shared_ptr<property>> properties;
+            /** Size of one element in a binary file, 0 if it has list properties */
+            std::size_t binary_size = 0;
+            bool has_list_property = false;
           };
           
           info_callback_type info_callback_ = [](std::size_t, const std::string&){};
@@ -387,6 +401,8 @@ namespace pcl
           comment_callback_type comment_callback_ = [](const std::string&){};
           obj_info_callback_type obj_info_callback_ = [](const std::string&){};
           end_header_callback_type end_header_callback_ = [](){return true;};
+          binary_element_callback_type binary_element_callback_ =
+              [](const std::string&, std::size_t, std::size_t, std::istream&) {return false;};
 
           element_definition_callback_type element_definition_callbacks_ = 
               [](const std::string&, std::size_t)
@@ -402,6 +418,13 @@ namespace pcl
           template <typename SizeType, typename ScalarType> inline void 
           parse_list_property_definition (const std::string& property_name);
           
+          /** \brief Convert an ASCII token to ScalarType. Plain numbers take a fast
+            * locale independent path, anything else goes through boost::lexical_cast,
+            * and tokens that can not be converted give quiet_NaN.
+            */
+          template <typename ScalarType> static inline ScalarType
+          parse_ascii_value (const std::string& value_s);
+
           template <typename ScalarType> inline bool 
           parse_scalar_property (format_type format, 
                                  std::istream& istream, 
@@ -482,6 +505,11 @@ inline void pcl::io::ply::ply_parser::end_header_callback (const end_header_call
   end_header_callback_ = end_header_callback;
 }
 
+inline void pcl::io::ply::ply_parser::binary_element_callback (const binary_element_callback_type& binary_element_callback)
+{
+  binary_element_callback_ = binary_element_callback;
+}
+
 template <typename ScalarType>
 inline void pcl::io::ply::ply_parser::parse_scalar_property_definition (const std::string& property_name)
 {
@@ -503,6 +531,7 @@ inline void pcl::io::ply::ply_parser::parse_scalar_property_definition (const st
     }
   }
   current_element_->properties.emplace_back (new scalar_property<scalar_type> (property_name, scalar_property_callback));
+  current_element_->binary_size += sizeof (scalar_type);
 }
 
 template <typename SizeType, typename ScalarType>
@@ -531,6 +560,7 @@ inline void pcl::io::ply::ply_parser::parse_list_property_definition (const std:
                         current_element_->name + "' is not handled");
     }
   }
+  current_element_->has_list_property = true;
   current_element_->properties.emplace_back (new list_property<size_type, scalar_type> (
                                              property_name, 
                                              std::get<0> (list_property_callbacks), 
@@ -538,6 +568,23 @@ inline void pcl::io::ply::ply_parser::parse_list_property_definition (const std:
                                              std::get<2> (list_property_callbacks)));
 }
 
+template <typename ScalarType>
+inline ScalarType pcl::io::ply::ply_parser::parse_ascii_value (const std::string& value_s)
+{
+  using parse_type = typename pcl::io::ply::type_traits<ScalarType>::parse_type;
+  parse_type value;
+  if (pcl::io::detail::parseNumber (value_s.data (), value_s.data () + value_s.size (), value))
+    return (static_cast<ScalarType> (value));
+  try
+  {
+    return (static_cast<ScalarType> (boost::lexical_cast<parse_type> (value_s)));
+  }
+  catch (boost::bad_lexical_cast &)
+  {
+    return (std::numeric_limits<ScalarType>::quiet_NaN ());
+  }
+}
+
 template <typename ScalarType>
 inline bool pcl::io::ply::ply_parser::parse_scalar_property (format_type format, 
                                                              std::istream& istream, 
@@ -548,17 +595,9 @@ inline bool pcl::io::ply::ply_parser::parse_scalar_property (format_type format,
   if (format == ascii_format)
   {
     std::string value_s;
-    scalar_type value;
     char space = ' ';
     istream >> value_s;
-    try
-    {
-      value = static_cast<scalar_type> (boost::lexical_cast<typename pcl::io::ply::type_traits<scalar_type>::parse_type> (value_s));
-    }
-    catch (boost::bad_lexical_cast &)
-    {
-      value = std::numeric_limits<scalar_type>::quiet_NaN ();
-    }
+    scalar_type value = parse_ascii_value<scalar_type> (value_s);
 
     if (!istream.eof ())
       istream >> space >> std::ws;
@@ -621,17 +660,9 @@ inline bool pcl::io::ply::ply_parser::parse_list_property (format_type format, s
     for (std::size_t index = 0; index < size; ++index)
     {
       std::string value_s;
-      scalar_type value;
       char space = ' ';
       istream >> value_s;
-      try
-      {
-        value = static_cast<scalar_type> (boost::lexical_cast<typename pcl::io::ply::type_traits<scalar_type>::parse_type> (value_s));
-      }
-      catch (boost::bad_lexical_cast &)
-      {
-        value = std::numeric_limits<scalar_type>::quiet_NaN ();
-      }
+      scalar_type value = parse_ascii_value<scalar_type> (value_s);
 
       if (!istream.eof ())
       {
@@ -513,6 +513,19 @@ namespace pcl
       void
       faceEndCallback ();
 
+      /** Read all the vertices of a binary file in host byte order at once, see
+        * pcl::io::ply::ply_parser::binary_element_callback_type.
+        * Scalar properties are converted as the vertex callbacks would do, exotic
+        * layouts (e.g. colors not given as red, green, blue) are left to the callbacks.
+        * param[in] istream the binary stream positioned at the first vertex
+        * param[in] count the number of vertices
+        * param[in] vertex_size the size of one vertex in the file
+        * return true if the vertices were read (or the stream failed), false if the
+        * layout is not handled
+        */
+      bool
+      readBinaryVertices (std::istream &istream, std::size_t count, std::size_t vertex_size);
+
       /// origin
       Eigen::Vector4f origin_;
 
@@ -529,6 +542,14 @@ namespace pcl
       bool do_resize_;
       //face element artifact
       std::vector<pcl::Vertices> *polygons_;
+      //vertex scalar properties in file order, used by readBinaryVertices()
+      struct VertexProperty
+      {
+        enum Kind { COPY, RED, GREEN, BLUE, ALPHA, INTENSITY };
+        Kind kind;
+        std::uint8_t datatype;
+      };
+      std::vector<VertexProperty> vertex_properties_;
     public:
       PCL_MAKE_ALIGNED_OPERATOR_NEW
       
@@ -0,0 +1,162 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#pragma once
+
+#include <pcl/point_cloud.h>
+
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace pcl
+{
+  namespace io
+  {
+    /** \brief Pool of point clouds that grabbers lease to their callbacks instead of allocating a cloud per frame.
+      *
+      * A leased cloud is an ordinary PointCloud<PointT>::Ptr, so callbacks taking a ConstPtr keep working unchanged.
+      * When the last copy of the pointer is released, the cloud goes back to the pool instead of being freed, together
+      * with its allocated points, and a later lease hands it out again. Clouds come back with the size and contents
+      * they had when they were released; converters that overwrite every point of a fixed size frame therefore do not
+      * touch the allocator at all. Leases may outlive the pool.
+      * \ingroup io
+      */
+    template <typename PointT>
+    class PointCloudPool
+    {
+      public:
+        using CloudPtr = typename pcl::PointCloud<PointT>::Ptr;
+
+        /** \brief Constructor.
+          * \param[in] capacity maximum number of released clouds kept for reuse (0 disables pooling)
+          */
+        explicit PointCloudPool (std::size_t capacity = 4) :
+          state_ (std::make_shared<State> ())
+        {
+          state_->capacity = capacity;
+        }
+
+        /** \brief Lease a cloud, reusing a released one if available. */
+        CloudPtr
+        lease ()
+        {
+          pcl::PointCloud<PointT>* cloud = nullptr;
+          {
+            std::lock_guard<std::mutex> lock (state_->mutex);
+            if (!state_->free.empty ())
+            {
+              cloud = state_->free.back ();
+              state_->free.pop_back ();
+            }
+          }
+          if (cloud == nullptr)
+            cloud = new pcl::PointCloud<PointT>;
+
+          const std::shared_ptr<State> state = state_;
+          return (CloudPtr (cloud, [state] (pcl::PointCloud<PointT>* released) { state->release (released); }));
+        }
+
+        /** \brief Set the maximum number of released clouds kept for reuse; 0 disables pooling. */
+        void
+        setCapacity (std::size_t capacity)
+        {
+          std::lock_guard<std::mutex> lock (state_->mutex);
+          state_->capacity = capacity;
+          state_->shrink ();
+        }
+
+        /** \brief Get the maximum number of released clouds kept for reuse. */
+        std::size_t
+        getCapacity () const
+        {
+          std::lock_guard<std::mutex> lock (state_->mutex);
+          return (state_->capacity);
+        }
+
+        /** \brief Get the number of released clouds waiting to be leased again. */
+        std::size_t
+        getNumberOfFreeClouds () const
+        {
+          std::lock_guard<std::mutex> lock (state_->mutex);
+          return (state_->free.size ());
+        }
+
+      private:
+        /** \brief Free list, shared with the deleters of the leased clouds. */
+        struct State
+        {
+          ~State ()
+          {
+            for (auto cloud : free)
+              delete cloud;
+          }
+
+          void
+          release (pcl::PointCloud<PointT>* cloud)
+          {
+            {
+              std::lock_guard<std::mutex> lock (mutex);
+              if (free.size () < capacity)
+              {
+                free.push_back (cloud);
+                return;
+              }
+            }
+            delete cloud;
+          }
+
+          void
+          shrink ()
+          {
+            while (free.size () > capacity)
+            {
+              delete free.back ();
+              free.pop_back ();
+            }
+          }
+
+          mutable std::mutex mutex;
+          std::vector<pcl::PointCloud<PointT>*> free;
+          std::size_t capacity;
+        };
+
+        std::shared_ptr<State> state_;
+    };
+  }
+}
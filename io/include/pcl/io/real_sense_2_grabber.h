@@ -39,8 +39,10 @@
 
 #include <thread>
 #include <mutex>
+#include <tuple>
 
 #include <pcl/io/grabber.h>
+#include <pcl/io/point_cloud_pool.h>
 #include <pcl/point_cloud.h>
 #include <pcl/point_types.h>
 
@@ -102,6 +104,12 @@ namespace pcl
     std::string
     getName () const override { return std::string ( "RealSense2Grabber" ); }
 
+    /** \brief Set the number of threads converting a frame into a point cloud
+    * \param[in] nr_threads the number of hardware threads to use (0 takes as many as the budget of pcl::ExecutionContext allows)
+    */
+    void
+    setNumberOfThreads ( unsigned int nr_threads = 0 );
+
     //define callback signature typedefs
     typedef void (signal_librealsense_PointXYZ) ( const pcl::PointCloud<pcl::PointXYZ>::ConstPtr& );
     typedef void (signal_librealsense_PointXYZI) ( const pcl::PointCloud<pcl::PointXYZI>::ConstPtr& );
@@ -212,6 +220,13 @@ namespace pcl
     rs2::pointcloud pc_;
     /** \brief Declare RealSense pipeline, encapsulating the actual device and sensors */
     rs2::pipeline pipe_;
+    /** \brief The number of threads converting a frame into a point cloud */
+    unsigned int threads_;
+    /** \brief Clouds handed out to the point cloud callbacks, returned here once every callback released them */
+    std::tuple<pcl::io::PointCloudPool<pcl::PointXYZ>,
+               pcl::io::PointCloudPool<pcl::PointXYZI>,
+               pcl::io::PointCloudPool<pcl::PointXYZRGB>,
+               pcl::io::PointCloudPool<pcl::PointXYZRGBA> > cloud_pools_;
   };
 
 }
@@ -47,6 +47,7 @@
 #include <boost/asio.hpp>
 #include <boost/shared_array.hpp> // for shared_array
 
+#include <atomic>
 #include <memory>
 #include <thread>
 
@@ -122,15 +123,13 @@ namespace pcl
 
     private:
 
-      bool terminate_thread_;
+      std::atomic<bool> terminate_thread_;
       std::size_t signal_point_cloud_size_;
       unsigned short data_port_;
       enum { MAX_LENGTH = 65535 };
-      unsigned char receive_buffer_[MAX_LENGTH];
       unsigned int data_size_;
 
       boost::asio::ip::address sensor_address_;
-      boost::asio::ip::udp::endpoint sender_endpoint_;
       boost::asio::io_service io_service_;
       std::shared_ptr<boost::asio::ip::udp::socket> socket_;
       std::shared_ptr<std::thread> socket_thread_;
@@ -142,9 +141,7 @@ namespace pcl
 
       void consumerThreadLoop ();
       void socketThreadLoop ();
-      void asyncSocketReceive ();
       void resetPointCloud ();
-      void socketCallback (const boost::system::error_code& error, std::size_t number_of_bytes);
       void convertPacketData (unsigned char *data_packet, std::size_t length);
       void computeXYZI (pcl::PointXYZI& point_XYZI, unsigned char* point_data);
       void computeTimestamp (std::uint32_t& timestamp, unsigned char* point_data);
@@ -0,0 +1,107 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#pragma once
+
+#include <pcl/pcl_macros.h>
+
+#include <boost/asio.hpp>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace pcl
+{
+  /** \brief Receives UDP datagrams from a bound socket in batches.
+   *
+   * On Linux, a single recvmmsg () call fetches up to the batch size of queued datagrams, and the kernel
+   * receive time of every datagram is taken from SO_TIMESTAMPNS. Elsewhere, one datagram is received per
+   * call and its timestamp is the system time after reception.
+   * \ingroup io
+   */
+  class PCL_EXPORTS UDPBatchReceiver
+  {
+    public:
+      /** \brief A received datagram; data points into the buffers of the receiver and stays valid until the next call to receive (). */
+      struct Packet
+      {
+        const std::uint8_t *data;
+        std::size_t size;
+        boost::asio::ip::udp::endpoint sender;
+        /** \brief Receive time, in microseconds since the epoch. */
+        std::uint64_t timestamp;
+      };
+
+      /** \brief Constructor.
+       * \param[in] socket bound socket to receive from; it has to outlive the receiver
+       * \param[in] batch_size maximum number of datagrams returned by a call to receive ()
+       * \param[in] max_packet_size size of the buffer of each datagram; longer datagrams are truncated
+       */
+      UDPBatchReceiver (boost::asio::ip::udp::socket &socket,
+                        std::size_t batch_size = 64,
+                        std::size_t max_packet_size = 1500);
+
+      /** \brief Destructor. */
+      ~UDPBatchReceiver ();
+
+      /** \brief Wait up to timeout_ms milliseconds for datagrams and return the ones received.
+       * The returned vector is empty on timeout or when the socket was closed.
+       * \param[in] timeout_ms maximum time to wait for the first datagram (only honored by the batched path)
+       */
+      const std::vector<Packet>&
+      receive (int timeout_ms = 100);
+
+      /** \brief Whether datagrams are received in batches with kernel timestamps. */
+      bool
+      isBatched () const
+      {
+        return (batched_);
+      }
+
+    private:
+      /** \brief Message headers handed to recvmmsg (), set up once. */
+      struct BatchHeaders;
+
+      boost::asio::ip::udp::socket &socket_;
+      std::size_t batch_size_;
+      std::size_t max_packet_size_;
+      bool batched_;
+      std::vector<std::uint8_t> buffer_;
+      std::vector<Packet> packets_;
+      std::unique_ptr<BatchHeaders> headers_;
+  };
+}
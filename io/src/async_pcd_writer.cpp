@@ -0,0 +1,218 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include <pcl/io/async_pcd_writer.h>
+#include <pcl/console/print.h>
+
+#include <algorithm>
+#include <exception>
+
+///////////////////////////////////////////////////////////////////////////////////////////
+pcl::io::AsyncPCDWriter::AsyncPCDWriter (unsigned int nr_threads, std::size_t max_queue_size)
+  : max_queue_size_ (std::max<std::size_t> (max_queue_size, 1))
+  , nr_active_ (0)
+  , stop_ (false)
+  , backpressure_ (BLOCK)
+  , map_synchronization_ (false)
+{
+  nr_threads = std::max (nr_threads, 1u);
+  workers_.reserve (nr_threads);
+  for (unsigned int i = 0; i < nr_threads; ++i)
+    workers_.emplace_back (&AsyncPCDWriter::run, this);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+pcl::io::AsyncPCDWriter::~AsyncPCDWriter ()
+{
+  {
+    std::lock_guard<std::mutex> lock (mutex_);
+    stop_ = true;
+  }
+  queue_not_empty_.notify_all ();
+  for (auto &worker : workers_)
+    worker.join ();
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+void
+pcl::io::AsyncPCDWriter::setCallback (const Callback &callback)
+{
+  std::lock_guard<std::mutex> lock (mutex_);
+  callback_ = callback;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+void
+pcl::io::AsyncPCDWriter::setBackpressure (Backpressure backpressure)
+{
+  std::lock_guard<std::mutex> lock (mutex_);
+  backpressure_ = backpressure;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+void
+pcl::io::AsyncPCDWriter::setMapSynchronization (bool sync)
+{
+  map_synchronization_ = sync;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+std::size_t
+pcl::io::AsyncPCDWriter::getQueueSize () const
+{
+  std::lock_guard<std::mutex> lock (mutex_);
+  return (queue_.size ());
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+void
+pcl::io::AsyncPCDWriter::flush ()
+{
+  std::unique_lock<std::mutex> lock (mutex_);
+  job_done_.wait (lock, [this] { return (queue_.empty () && nr_active_ == 0); });
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+std::future<int>
+pcl::io::AsyncPCDWriter::writeBinary (const std::string &file_name,
+                                      const pcl::PCLPointCloud2::ConstPtr &cloud,
+                                      const Eigen::Vector4f &origin,
+                                      const Eigen::Quaternionf &orientation)
+{
+  const bool sync = map_synchronization_;
+  return (enqueue (file_name, [file_name, cloud, origin, orientation, sync] ()
+  {
+    pcl::PCDWriter writer;
+    writer.setMapSynchronization (sync);
+    return (writer.writeBinary (file_name, *cloud, origin, orientation));
+  }));
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+std::future<int>
+pcl::io::AsyncPCDWriter::writeBinaryCompressed (const std::string &file_name,
+                                                const pcl::PCLPointCloud2::ConstPtr &cloud,
+                                                const Eigen::Vector4f &origin,
+                                                const Eigen::Quaternionf &orientation)
+{
+  const bool sync = map_synchronization_;
+  return (enqueue (file_name, [file_name, cloud, origin, orientation, sync] ()
+  {
+    pcl::PCDWriter writer;
+    writer.setMapSynchronization (sync);
+    return (writer.writeBinaryCompressed (file_name, *cloud, origin, orientation));
+  }));
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+std::future<int>
+pcl::io::AsyncPCDWriter::enqueue (const std::string &file_name, std::function<int ()> write)
+{
+  Job job;
+  job.file_name = file_name;
+  job.write = std::move (write);
+  std::future<int> result = job.result.get_future ();
+
+  Callback callback;
+  {
+    std::unique_lock<std::mutex> lock (mutex_);
+    if (backpressure_ == BLOCK)
+      queue_not_full_.wait (lock, [this] { return (queue_.size () < max_queue_size_); });
+
+    if (queue_.size () < max_queue_size_)
+    {
+      queue_.push_back (std::move (job));
+      lock.unlock ();
+      queue_not_empty_.notify_one ();
+      return (result);
+    }
+    callback = callback_;
+  }
+
+  // The queue is full, reject the write
+  PCL_WARN ("[pcl::io::AsyncPCDWriter] Queue full, %s is not written!\n", file_name.c_str ());
+  job.result.set_value (-2);
+  if (callback)
+    callback (file_name, -2);
+  return (result);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+void
+pcl::io::AsyncPCDWriter::run ()
+{
+  while (true)
+  {
+    Job job;
+    {
+      std::unique_lock<std::mutex> lock (mutex_);
+      queue_not_empty_.wait (lock, [this] { return (stop_ || !queue_.empty ()); });
+      if (queue_.empty ())
+        return;
+      job = std::move (queue_.front ());
+      queue_.pop_front ();
+      ++nr_active_;
+    }
+    queue_not_full_.notify_one ();
+
+    int result = -1;
+    try
+    {
+      result = job.write ();
+    }
+    catch (const std::exception &e)
+    {
+      PCL_ERROR ("[pcl::io::AsyncPCDWriter] Writing %s failed: %s\n", job.file_name.c_str (), e.what ());
+    }
+    job.write = nullptr;
+
+    Callback callback;
+    {
+      std::lock_guard<std::mutex> lock (mutex_);
+      callback = callback_;
+    }
+    if (callback)
+      callback (job.file_name, result);
+    job.result.set_value (result);
+
+    {
+      std::lock_guard<std::mutex> lock (mutex_);
+      --nr_active_;
+    }
+    job_done_.notify_all ();
+  }
+}
@@ -0,0 +1,477 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include <pcl/io/cloud_sequence.h>
+#include <pcl/io/low_level_io.h>
+#include <pcl/io/lzf.h>
+#include <pcl/console/print.h>
+
+#include <algorithm>
+#include <cstring>
+#include <fcntl.h>
+#include <limits>
+
+namespace
+{
+  // File header: magic, version, reserved, index offset, number of frames
+  const char file_magic[8] = {'P', 'C', 'L', 'S', 'E', 'Q', '\0', '\0'};
+  const std::uint32_t file_version = 1;
+  const std::size_t file_header_size = 32;
+
+  // Frame header: magic, flags, timestamp, width, height, point step, number of fields, is_dense, reserved,
+  // origin, orientation (x, y, z, w), data size, stored size, reserved
+  const std::uint32_t frame_magic = 0x46534350; // "PCSF"
+  const std::uint32_t frame_flag_lzf = 1;
+  const std::size_t frame_header_size = 96;
+
+  // Field: name, offset, datatype, count, reserved
+  const std::size_t field_name_size = 32;
+  const std::size_t field_size = 48;
+
+  const std::size_t index_entry_size = 24;
+
+  template <typename T> inline void
+  put (std::uint8_t *buffer, std::size_t position, const T &value)
+  {
+    std::memcpy (buffer + position, &value, sizeof (T));
+  }
+
+  template <typename T> inline T
+  get (const std::uint8_t *buffer, std::size_t position)
+  {
+    T value;
+    std::memcpy (&value, buffer + position, sizeof (T));
+    return (value);
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+pcl::io::CloudSequenceWriter::~CloudSequenceWriter ()
+{
+  if (isOpen ())
+    close ();
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+int
+pcl::io::CloudSequenceWriter::open (const std::string &file_name, bool compress)
+{
+  if (isOpen () && close () != 0)
+    return (-1);
+
+  file_.open (file_name.c_str (), std::ios::binary | std::ios::trunc);
+  if (!file_.is_open ())
+  {
+    PCL_ERROR ("[pcl::io::CloudSequenceWriter::open] Could not open file '%s' for writing!\n", file_name.c_str ());
+    return (-1);
+  }
+  file_name_ = file_name;
+  compress_ = compress;
+  index_.clear ();
+
+  // The header is completed by close ()
+  std::uint8_t header[file_header_size] = {};
+  std::memcpy (header, file_magic, sizeof (file_magic));
+  put (header, 8, file_version);
+  file_.write (reinterpret_cast<const char*> (header), file_header_size);
+  position_ = file_header_size;
+  if (!file_)
+  {
+    PCL_ERROR ("[pcl::io::CloudSequenceWriter::open] Error writing to file '%s'!\n", file_name.c_str ());
+    file_.close ();
+    return (-1);
+  }
+  return (0);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+int
+pcl::io::CloudSequenceWriter::write (const pcl::PCLPointCloud2 &cloud,
+                                     const Eigen::Vector4f &origin, const Eigen::Quaternionf &orientation)
+{
+  if (!isOpen ())
+  {
+    PCL_ERROR ("[pcl::io::CloudSequenceWriter::write] No file is open!\n");
+    return (-1);
+  }
+
+  const std::uint64_t row_size = static_cast<std::uint64_t> (cloud.width) * cloud.point_step;
+  const std::uint64_t data_size = row_size * cloud.height;
+  if (cloud.row_step < row_size || cloud.data.size () < static_cast<std::uint64_t> (cloud.row_step) * cloud.height)
+  {
+    PCL_ERROR ("[pcl::io::CloudSequenceWriter::write] The point data does not match the dimensions of the cloud!\n");
+    return (-1);
+  }
+  for (const auto &field : cloud.fields)
+  {
+    if (field.name.size () >= field_name_size)
+    {
+      PCL_ERROR ("[pcl::io::CloudSequenceWriter::write] The name of field %s is too long!\n", field.name.c_str ());
+      return (-1);
+    }
+  }
+
+  // Points are stored packed, without padding at the end of the rows
+  const std::uint8_t *data = cloud.data.data ();
+  if (cloud.row_step != row_size)
+  {
+    packed_.resize (data_size);
+    for (std::uint32_t row = 0; row < cloud.height; ++row)
+      std::memcpy (&packed_[row * row_size], &cloud.data[static_cast<std::size_t> (row) * cloud.row_step], row_size);
+    data = packed_.data ();
+  }
+
+  // Keep the data uncompressed if compression does not save anything
+  std::uint32_t flags = 0;
+  std::uint64_t stored_size = data_size;
+  if (compress_ && data_size > 0 && data_size <= std::numeric_limits<unsigned int>::max ())
+  {
+    compressed_.resize (data_size);
+    const unsigned int compressed_size = pcl::lzfCompress (data, static_cast<unsigned int> (data_size),
+                                                           compressed_.data (), static_cast<unsigned int> (data_size - 1));
+    if (compressed_size > 0)
+    {
+      flags |= frame_flag_lzf;
+      stored_size = compressed_size;
+      data = compressed_.data ();
+    }
+  }
+
+  std::vector<std::uint8_t> header (frame_header_size + cloud.fields.size () * field_size, 0);
+  put (header.data (), 0, frame_magic);
+  put (header.data (), 4, flags);
+  put (header.data (), 8, static_cast<std::uint64_t> (cloud.header.stamp));
+  put (header.data (), 16, cloud.width);
+  put (header.data (), 20, cloud.height);
+  put (header.data (), 24, cloud.point_step);
+  put (header.data (), 28, static_cast<std::uint32_t> (cloud.fields.size ()));
+  put (header.data (), 32, static_cast<std::uint32_t> (cloud.is_dense));
+  for (int i = 0; i < 4; ++i)
+  {
+    put (header.data (), 40 + 4 * i, origin[i]);
+    put (header.data (), 56 + 4 * i, orientation.coeffs ()[i]);
+  }
+  put (header.data (), 72, data_size);
+  put (header.data (), 80, stored_size);
+  for (std::size_t f = 0; f < cloud.fields.size (); ++f)
+  {
+    const pcl::PCLPointField &field = cloud.fields[f];
+    std::uint8_t *out = &header[frame_header_size + f * field_size];
+    std::memcpy (out, field.name.c_str (), field.name.size ());
+    put (out, field_name_size, field.offset);
+    put (out, field_name_size + 4, static_cast<std::uint32_t> (field.datatype));
+    put (out, field_name_size + 8, field.count);
+  }
+
+  file_.write (reinterpret_cast<const char*> (header.data ()), header.size ());
+  file_.write (reinterpret_cast<const char*> (data), stored_size);
+  if (!file_)
+  {
+    PCL_ERROR ("[pcl::io::CloudSequenceWriter::write] Error writing to file '%s'!\n", file_name_.c_str ());
+    return (-1);
+  }
+
+  const std::uint64_t frame_size = header.size () + stored_size;
+  index_.push_back ({position_, frame_size, cloud.header.stamp});
+  position_ += frame_size;
+  return (0);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+int
+pcl::io::CloudSequenceWriter::close ()
+{
+  if (!isOpen ())
+    return (0);
+
+  std::vector<std::uint8_t> index (index_.size () * index_entry_size);
+  for (std::size_t i = 0; i < index_.size (); ++i)
+  {
+    put (index.data (), i * index_entry_size, index_[i].offset);
+    put (index.data (), i * index_entry_size + 8, index_[i].size);
+    put (index.data (), i * index_entry_size + 16, index_[i].timestamp);
+  }
+  file_.write (reinterpret_cast<const char*> (index.data ()), index.size ());
+
+  // Complete the file header, which marks the file as readable
+  std::uint8_t header_end[16];
+  put (header_end, 0, position_);
+  put (header_end, 8, static_cast<std::uint64_t> (index_.size ()));
+  file_.seekp (16);
+  file_.write (reinterpret_cast<const char*> (header_end), sizeof (header_end));
+
+  const bool ok = static_cast<bool> (file_);
+  file_.close ();
+  index_.clear ();
+  if (!ok)
+  {
+    PCL_ERROR ("[pcl::io::CloudSequenceWriter::close] Error writing to file '%s'!\n", file_name_.c_str ());
+    return (-1);
+  }
+  return (0);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+pcl::io::CloudSequenceReader::~CloudSequenceReader ()
+{
+  close ();
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+int
+pcl::io::CloudSequenceReader::open (const std::string &file_name)
+{
+  close ();
+
+  int fd = io::raw_open (file_name.c_str (), O_RDONLY);
+  if (fd == -1)
+  {
+    PCL_ERROR ("[pcl::io::CloudSequenceReader::open] Could not open file '%s'!\n", file_name.c_str ());
+    return (-1);
+  }
+  const auto file_size = io::raw_lseek (fd, 0, SEEK_END);
+  if (file_size < static_cast<long> (file_header_size))
+  {
+    io::raw_close (fd);
+    PCL_ERROR ("[pcl::io::CloudSequenceReader::open] File '%s' is not a cloud sequence!\n", file_name.c_str ());
+    return (-1);
+  }
+
+#ifdef _WIN32
+  HANDLE fm = CreateFileMapping ((HANDLE) _get_osfhandle (fd), NULL, PAGE_READONLY, 0, 0, NULL);
+  const std::uint8_t *map = nullptr;
+  if (fm != NULL)
+  {
+    map = static_cast<const std::uint8_t*> (MapViewOfFile (fm, FILE_MAP_READ, 0, 0, 0));
+    if (map == nullptr)
+      CloseHandle (fm);
+  }
+  io::raw_close (fd);
+  if (map == nullptr)
+  {
+    PCL_ERROR ("[pcl::io::CloudSequenceReader::open] Error mapping view of file, %s\n", file_name.c_str ());
+    return (-1);
+  }
+  map_handle_ = fm;
+#else
+  void *map = ::mmap (nullptr, file_size, PROT_READ, MAP_SHARED, fd, 0);
+  io::raw_close (fd);
+  if (map == MAP_FAILED)
+  {
+    PCL_ERROR ("[pcl::io::CloudSequenceReader::open] Error preparing mmap for file '%s'!\n", file_name.c_str ());
+    return (-1);
+  }
+#endif
+  map_ = static_cast<const std::uint8_t*> (map);
+  map_size_ = static_cast<std::size_t> (file_size);
+
+  // Check the header and read the index
+  const std::uint64_t index_offset = get<std::uint64_t> (map_, 16);
+  const std::uint64_t nr_frames = get<std::uint64_t> (map_, 24);
+  if (std::memcmp (map_, file_magic, sizeof (file_magic)) != 0 || get<std::uint32_t> (map_, 8) != file_version)
+  {
+    PCL_ERROR ("[pcl::io::CloudSequenceReader::open] File '%s' is not a cloud sequence of version %u!\n",
+               file_name.c_str (), file_version);
+    close ();
+    return (-1);
+  }
+  if (index_offset < file_header_size || index_offset > map_size_ ||
+      nr_frames > (map_size_ - index_offset) / index_entry_size)
+  {
+    PCL_ERROR ("[pcl::io::CloudSequenceReader::open] File '%s' has no valid index, it was not closed properly!\n",
+               file_name.c_str ());
+    close ();
+    return (-1);
+  }
+  index_.resize (nr_frames);
+  for (std::size_t i = 0; i < index_.size (); ++i)
+  {
+    const std::uint8_t *entry = map_ + index_offset + i * index_entry_size;
+    index_[i].offset = get<std::uint64_t> (entry, 0);
+    index_[i].size = get<std::uint64_t> (entry, 8);
+    index_[i].timestamp = get<std::uint64_t> (entry, 16);
+    if (index_[i].offset < file_header_size || index_[i].offset > index_offset ||
+        index_[i].size < frame_header_size || index_[i].size > index_offset - index_[i].offset)
+    {
+      PCL_ERROR ("[pcl::io::CloudSequenceReader::open] Frame %zu of file '%s' is out of bounds!\n", i, file_name.c_str ());
+      close ();
+      return (-1);
+    }
+  }
+  return (0);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+void
+pcl::io::CloudSequenceReader::close ()
+{
+  if (map_)
+  {
+#ifdef _WIN32
+    UnmapViewOfFile (map_);
+    CloseHandle (map_handle_);
+    map_handle_ = nullptr;
+#else
+    ::munmap (const_cast<std::uint8_t*> (map_), map_size_);
+#endif
+  }
+  map_ = nullptr;
+  map_size_ = 0;
+  index_.clear ();
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+std::size_t
+pcl::io::CloudSequenceReader::findFrame (std::uint64_t timestamp) const
+{
+  const auto it = std::lower_bound (index_.cbegin (), index_.cend (), timestamp,
+                                    [] (const CloudSequenceIndexEntry &entry, std::uint64_t t) { return (entry.timestamp < t); });
+  return (static_cast<std::size_t> (it - index_.cbegin ()));
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+int
+pcl::io::CloudSequenceReader::parseFrame (std::size_t idx, Frame &frame) const
+{
+  if (idx >= index_.size ())
+  {
+    PCL_ERROR ("[pcl::io::CloudSequenceReader::read] Frame %zu does not exist, the sequence has %zu frames!\n",
+               idx, index_.size ());
+    return (-1);
+  }
+  const CloudSequenceIndexEntry &entry = index_[idx];
+  const std::uint8_t *header = map_ + entry.offset;
+  if (get<std::uint32_t> (header, 0) != frame_magic)
+  {
+    PCL_ERROR ("[pcl::io::CloudSequenceReader::read] Frame %zu is corrupted!\n", idx);
+    return (-1);
+  }
+
+  const std::uint32_t flags = get<std::uint32_t> (header, 4);
+  frame.compressed = (flags & frame_flag_lzf) != 0;
+  frame.timestamp = get<std::uint64_t> (header, 8);
+  frame.width = get<std::uint32_t> (header, 16);
+  frame.height = get<std::uint32_t> (header, 20);
+  frame.point_step = get<std::uint32_t> (header, 24);
+  const std::uint32_t nr_fields = get<std::uint32_t> (header, 28);
+  frame.is_dense = get<std::uint32_t> (header, 32) != 0;
+  for (int i = 0; i < 4; ++i)
+  {
+    frame.origin[i] = get<float> (header, 40 + 4 * i);
+    frame.orientation.coeffs ()[i] = get<float> (header, 56 + 4 * i);
+  }
+  frame.data_size = get<std::uint64_t> (header, 72);
+  frame.stored_size = get<std::uint64_t> (header, 80);
+
+  // All sizes have to be consistent with the index
+  const std::uint64_t fields_size = static_cast<std::uint64_t> (nr_fields) * field_size;
+  if (fields_size > entry.size - frame_header_size ||
+      frame.stored_size != entry.size - frame_header_size - fields_size ||
+      frame.data_size != static_cast<std::uint64_t> (frame.width) * frame.height * frame.point_step ||
+      (!frame.compressed && frame.stored_size != frame.data_size))
+  {
+    PCL_ERROR ("[pcl::io::CloudSequenceReader::read] Frame %zu is corrupted!\n", idx);
+    return (-1);
+  }
+
+  frame.fields.resize (nr_fields);
+  for (std::uint32_t f = 0; f < nr_fields; ++f)
+  {
+    const std::uint8_t *in = header + frame_header_size + f * field_size;
+    const char *name = reinterpret_cast<const char*> (in);
+    pcl::PCLPointField &field = frame.fields[f];
+    field.name.assign (name, std::find (name, name + field_name_size, '\0'));
+    field.offset = get<std::uint32_t> (in, field_name_size);
+    field.datatype = static_cast<std::uint8_t> (get<std::uint32_t> (in, field_name_size + 4));
+    field.count = get<std::uint32_t> (in, field_name_size + 8);
+  }
+  frame.data = header + frame_header_size + fields_size;
+  return (0);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+const std::uint8_t*
+pcl::io::CloudSequenceReader::getFrameData (const Frame &frame, std::vector<std::uint8_t> &buffer) const
+{
+  if (!frame.compressed)
+    return (frame.data);
+
+  if (frame.data_size > std::numeric_limits<unsigned int>::max () ||
+      frame.stored_size > std::numeric_limits<unsigned int>::max ())
+    return (nullptr);
+  buffer.resize (frame.data_size);
+  const unsigned int size = pcl::lzfDecompress (frame.data, static_cast<unsigned int> (frame.stored_size),
+                                                buffer.data (), static_cast<unsigned int> (frame.data_size));
+  if (size != frame.data_size)
+  {
+    PCL_ERROR ("[pcl::io::CloudSequenceReader::read] Error decompressing a frame!\n");
+    return (nullptr);
+  }
+  return (buffer.data ());
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+int
+pcl::io::CloudSequenceReader::read (std::size_t idx, pcl::PCLPointCloud2 &cloud,
+                                    Eigen::Vector4f &origin, Eigen::Quaternionf &orientation) const
+{
+  Frame frame;
+  if (parseFrame (idx, frame) != 0)
+    return (-1);
+
+  cloud.header.stamp = frame.timestamp;
+  cloud.header.seq = static_cast<std::uint32_t> (idx);
+  cloud.width = frame.width;
+  cloud.height = frame.height;
+  cloud.point_step = frame.point_step;
+  cloud.row_step = frame.width * frame.point_step;
+  cloud.is_bigendian = false;
+  cloud.is_dense = frame.is_dense;
+  cloud.fields = frame.fields;
+  origin = frame.origin;
+  orientation = frame.orientation;
+
+  if (frame.compressed)
+  {
+    // Decompress straight into the cloud
+    if (!getFrameData (frame, cloud.data))
+      return (-1);
+  }
+  else
+    cloud.data.assign (frame.data, frame.data + frame.data_size);
+  return (0);
+}
@@ -37,146 +37,326 @@
 #include <cstdlib> // for abs
 
 #include <pcl/io/debayer.h>
+#include <pcl/common/execution_context.h>
+#include <pcl/common/simd_lanes.h>
+
+#include <algorithm>
+#include <cstddef>
 
 #define AVG(a,b) static_cast<unsigned char>((int(a) + int(b)) >> 1)
 #define AVG3(a,b,c) static_cast<unsigned char>((int(a) + int(b) + int(c)) / 3)
 #define AVG4(a,b,c,d) static_cast<unsigned char>((int(a) + int(b) + int(c) + int(d)) >> 2)
 #define WAVG4(a,b,c,d,x,y) static_cast<unsigned char>( ( (int(a) + int(b)) * int(x) + (int(c) + int(d)) * int(y) ) / ( (int(x) + (int(y))) << 1 ) )
+#define CLIP_CHAR(c) static_cast<unsigned char> ((c)>255?255:(c)<0?0:(c))
 
-//////////////////////////////////////////////////////////////////////////////
-void
-pcl::io::DeBayer::debayerBilinear (
-    const unsigned char *bayer_pixel, unsigned char *rgb_buffer,
-    unsigned width, unsigned height, 
-    int bayer_line_step,
-    int bayer_line_step2,
-    unsigned rgb_line_step) const
+namespace
 {
-  if (bayer_line_step == 0)
-    bayer_line_step = width;
-  if (bayer_line_step2 == 0)
-    bayer_line_step2 = width << 1;
-  if (rgb_line_step == 0)
-    rgb_line_step = width * 3;
+  /** Convert the middle of a pair of lines of a Bayer image, starting at pixel 2, in blocks that end before the last
+    * two pixels. Same parameters as bilinearLinePair. Returns the first pixel that was not converted. */
+  using BilinearKernel = unsigned (*) (const unsigned char *bayer_pixel, unsigned char *rgb_buffer, unsigned width,
+                                       int bayer_line_step, int bayer_line_step2, unsigned rgb_line_step);
+
+  /** Convert the pixel pairs [begin, end) of a line of a YUV422 image. Returns the first pair that was not
+    * converted. */
+  using YUV422Kernel = unsigned (*) (const unsigned char *yuv_buffer, unsigned char *rgb_buffer,
+                                     unsigned begin, unsigned end);
+
+#ifdef PCL_SIMD_KERNELS_SSE2
+  /** Even bytes of 16 bytes, as 16 bit integers. */
+  inline __m128i
+  loadEvenSSE2 (const unsigned char *p)
+  {
+    return (_mm_and_si128 (_mm_loadu_si128 (reinterpret_cast<const __m128i*> (p)), _mm_set1_epi16 (0xFF)));
+  }
 
-  // padding skip for destination image
-  unsigned rgb_line_skip = rgb_line_step - width * 3;
-  // first two pixel values for first two lines
-  // Bayer         0 1 2
-  //         0     G r g
-  // line_step     b g b
-  // line_step2    g r g
+  /** Odd bytes of 16 bytes, as 16 bit integers. */
+  inline __m128i
+  loadOddSSE2 (const unsigned char *p)
+  {
+    return (_mm_srli_epi16 (_mm_loadu_si128 (reinterpret_cast<const __m128i*> (p)), 8));
+  }
 
-  rgb_buffer[3] = rgb_buffer[0] = bayer_pixel[1]; // red pixel
-  rgb_buffer[1] = bayer_pixel[0]; // green pixel
-  rgb_buffer[rgb_line_step + 2] = rgb_buffer[2] = bayer_pixel[bayer_line_step]; // blue;
+  /** Interleave the 16 bit integers of the even and the odd pixels into 16 bytes. */
+  inline __m128i
+  interleaveSSE2 (__m128i even, __m128i odd)
+  {
+    return (_mm_or_si128 (even, _mm_slli_epi16 (odd, 8)));
+  }
 
-  // Bayer         0 1 2
-  //         0     g R g
-  // line_step     b g b
-  // line_step2    g r g
-  //rgb_pixel[3] = bayer_pixel[1];
-  rgb_buffer[4] = AVG3 (bayer_pixel[0], bayer_pixel[2], bayer_pixel[bayer_line_step + 1]);
-  rgb_buffer[rgb_line_step + 5] = rgb_buffer[5] = AVG (bayer_pixel[bayer_line_step], bayer_pixel[bayer_line_step + 2]);
+  /** Store 16 pixels, given as red, green and blue planes, as RGB. Writes 2 bytes past the last pixel. */
+  inline void
+  storeRGBSSE2 (__m128i r, __m128i g, __m128i b, unsigned char *rgb_buffer)
+  {
+    const __m128i zero = _mm_setzero_si128 ();
+    const __m128i rg_low = _mm_unpacklo_epi8 (r, g), rg_high = _mm_unpackhi_epi8 (r, g);
+    const __m128i b_low = _mm_unpacklo_epi8 (b, zero), b_high = _mm_unpackhi_epi8 (b, zero);
+    const __m128i rgb0[4] = {_mm_unpacklo_epi16 (rg_low, b_low), _mm_unpackhi_epi16 (rg_low, b_low),
+                             _mm_unpacklo_epi16 (rg_high, b_high), _mm_unpackhi_epi16 (rg_high, b_high)};
+    const __m128i first = _mm_set1_epi64x (0xFFFFFF), second = _mm_set1_epi64x (0xFFFFFF000000);
+    for (int i = 0; i < 4; ++i)
+    {
+      // Squeeze the two pixels of each 64 bit lane into its lower 6 bytes
+      const __m128i packed = _mm_or_si128 (_mm_and_si128 (rgb0[i], first),
+                                           _mm_and_si128 (_mm_srli_epi64 (rgb0[i], 8), second));
+      _mm_storel_epi64 (reinterpret_cast<__m128i*> (rgb_buffer + 12 * i), packed);
+      _mm_storel_epi64 (reinterpret_cast<__m128i*> (rgb_buffer + 12 * i + 6), _mm_srli_si128 (packed, 8));
+    }
+  }
 
-  // BGBG line
-  // Bayer         0 1 2
-  //         0     g r g
-  // line_step     B g b
-  // line_step2    g r g
-  rgb_buffer[rgb_line_step + 3] = rgb_buffer[rgb_line_step ] = AVG (bayer_pixel[1], bayer_pixel[bayer_line_step2 + 1]);
-  rgb_buffer[rgb_line_step + 1] = AVG3 (bayer_pixel[0], bayer_pixel[bayer_line_step + 1], bayer_pixel[bayer_line_step2]);
-  //rgb_pixel[rgb_line_step + 2] = bayer_pixel[line_step];
+  unsigned
+  bilinearSSE2 (const unsigned char *bayer_pixel, unsigned char *rgb_buffer, unsigned width,
+                int bayer_line_step, int bayer_line_step2, unsigned rgb_line_step)
+  {
+    unsigned xIdx = 2;
+    // 8 pixel pairs of both lines per block, see the pixel pair loop of bilinearLinePair
+    for (; xIdx + 16 <= width - 2; xIdx += 16)
+    {
+      const unsigned char *p = bayer_pixel + xIdx;
+      // GRGR line, its neighbors and the BGBG lines above and below
+      const __m128i g0 = loadEvenSSE2 (p), r0 = loadOddSSE2 (p);
+      const __m128i r0_left = loadOddSSE2 (p - 2), g0_right = loadEvenSSE2 (p + 2);
+      const __m128i b_up = loadEvenSSE2 (p - bayer_line_step), g_up = loadOddSSE2 (p - bayer_line_step);
+      const __m128i b_up_right = loadEvenSSE2 (p - bayer_line_step + 2);
+      const __m128i b1 = loadEvenSSE2 (p + bayer_line_step), g1 = loadOddSSE2 (p + bayer_line_step);
+      const __m128i g1_left = loadOddSSE2 (p + bayer_line_step - 2), b1_right = loadEvenSSE2 (p + bayer_line_step + 2);
+      const __m128i g2 = loadEvenSSE2 (p + bayer_line_step2), r2 = loadOddSSE2 (p + bayer_line_step2);
+      const __m128i r2_left = loadOddSSE2 (p + bayer_line_step2 - 2);
+
+      unsigned char *rgb = rgb_buffer + 3 * xIdx;
+      storeRGBSSE2 (
+          interleaveSSE2 (_mm_srli_epi16 (_mm_add_epi16 (r0, r0_left), 1), r0),
+          interleaveSSE2 (g0, _mm_srli_epi16 (_mm_add_epi16 (_mm_add_epi16 (g0, g0_right), _mm_add_epi16 (g1, g_up)), 2)),
+          interleaveSSE2 (_mm_srli_epi16 (_mm_add_epi16 (b1, b_up), 1),
+                          _mm_srli_epi16 (_mm_add_epi16 (_mm_add_epi16 (b_up, b_up_right), _mm_add_epi16 (b1, b1_right)), 2)),
+          rgb);
+      storeRGBSSE2 (
+          interleaveSSE2 (_mm_srli_epi16 (_mm_add_epi16 (_mm_add_epi16 (r0, r2), _mm_add_epi16 (r0_left, r2_left)), 2),
+                          _mm_srli_epi16 (_mm_add_epi16 (r0, r2), 1)),
+          interleaveSSE2 (_mm_srli_epi16 (_mm_add_epi16 (_mm_add_epi16 (g0, g2), _mm_add_epi16 (g1_left, g1)), 2), g1),
+          interleaveSSE2 (b1, _mm_srli_epi16 (_mm_add_epi16 (b1, b1_right), 1)),
+          rgb + rgb_line_step);
+    }
+    return (xIdx);
+  }
 
-  // pixel (1, 1)  0 1 2
-  //         0     g r g
-  // line_step     b G b
-  // line_step2    g r g
-  //rgb_pixel[rgb_line_step + 3] = AVG( bayer_pixel[1] , bayer_pixel[line_step2+1] );
-  rgb_buffer[rgb_line_step + 4] = bayer_pixel[bayer_line_step + 1];
-  //rgb_pixel[rgb_line_step + 5] = AVG( bayer_pixel[line_step] , bayer_pixel[line_step+2] );
+  /** The red, green and blue offsets of the pixels of 4 YUV422 pixel pairs, each offset twice as 16 bit integers. */
+  inline void
+  yuv422OffsetsSSE2 (__m128i chroma, __m128i &r, __m128i &g, __m128i &b)
+  {
+    // u * 33292 is computed as 2 * u * 16646, as the factors have to fit 16 bits
+    const __m128i dr = _mm_srai_epi32 (_mm_add_epi32 (_mm_madd_epi16 (chroma, _mm_set1_epi32 (18678 << 16)), _mm_set1_epi32 (8192)), 14);
+    const __m128i dg = _mm_srai_epi32 (_mm_add_epi32 (_mm_madd_epi16 (chroma, _mm_set1_epi32 (static_cast<int> (0xDAD1E6B8))), _mm_set1_epi32 (8192)), 14);
+    const __m128i db = _mm_srai_epi32 (_mm_add_epi32 (_mm_madd_epi16 (chroma, _mm_set1_epi32 (16646)), _mm_set1_epi32 (4096)), 13);
+    const __m128i low = _mm_set1_epi32 (0xFFFF);
+    r = _mm_or_si128 (_mm_and_si128 (dr, low), _mm_slli_epi32 (dr, 16));
+    g = _mm_or_si128 (_mm_and_si128 (dg, low), _mm_slli_epi32 (dg, 16));
+    b = _mm_or_si128 (_mm_and_si128 (db, low), _mm_slli_epi32 (db, 16));
+  }
 
-  rgb_buffer += 6;
-  bayer_pixel += 2;
-  // rest of the first two lines
-  for (unsigned xIdx = 2; xIdx < width - 2; xIdx += 2, rgb_buffer += 6, bayer_pixel += 2)
+  /** Red, green and blue of 4 YUV422 pixel pairs, as 16 bit integers. */
+  inline void
+  yuv422ToRGBSSE2 (const unsigned char *yuv_buffer, __m128i &r, __m128i &g, __m128i &b)
   {
-    // GRGR line
-    // Bayer        -1 0 1 2
-    //           0   r G r g
-    //   line_step   g b g b
-    // line_step2    r g r g
-    rgb_buffer[0] = AVG (bayer_pixel[1], bayer_pixel[-1]);
-    rgb_buffer[1] = bayer_pixel[0];
-    rgb_buffer[2] = bayer_pixel[bayer_line_step + 1];
+    const __m128i chroma = _mm_sub_epi16 (loadEvenSSE2 (yuv_buffer), _mm_set1_epi16 (128));
+    const __m128i luma = loadOddSSE2 (yuv_buffer);
+    yuv422OffsetsSSE2 (chroma, r, g, b);
+    r = _mm_add_epi16 (luma, r);
+    g = _mm_add_epi16 (luma, g);
+    b = _mm_add_epi16 (luma, b);
+  }
 
-    // Bayer        -1 0 1 2
-    //          0    r g R g
-    //  line_step    g b g b
-    // line_step2    r g r g
-    rgb_buffer[3] = bayer_pixel[1];
-    rgb_buffer[4] = AVG3 (bayer_pixel[0], bayer_pixel[2], bayer_pixel[bayer_line_step + 1]);
-    rgb_buffer[rgb_line_step + 5] = rgb_buffer[5] = AVG (bayer_pixel[bayer_line_step], bayer_pixel[bayer_line_step + 2]);
+  unsigned
+  yuv422SSE2 (const unsigned char *yuv_buffer, unsigned char *rgb_buffer, unsigned begin, unsigned end)
+  {
+    unsigned pair = begin;
+    // 8 pixel pairs per block, blocks end before the last pair as the stores write past the last pixel
+    for (; pair + 8 < end; pair += 8)
+    {
+      __m128i r[2], g[2], b[2];
+      yuv422ToRGBSSE2 (yuv_buffer + 4 * pair, r[0], g[0], b[0]);
+      yuv422ToRGBSSE2 (yuv_buffer + 4 * pair + 16, r[1], g[1], b[1]);
+      // The saturation clips the values to [0, 255] as CLIP_CHAR
+      storeRGBSSE2 (_mm_packus_epi16 (r[0], r[1]), _mm_packus_epi16 (g[0], g[1]), _mm_packus_epi16 (b[0], b[1]),
+                    rgb_buffer + 6 * pair);
+    }
+    return (pair);
+  }
+#endif // PCL_SIMD_KERNELS_SSE2
 
-    // BGBG line
-    // Bayer         -1 0 1 2
-    //         0      r g r g
-    // line_step      g B g b
-    // line_step2     r g r g
-    rgb_buffer[rgb_line_step ] = AVG4 (bayer_pixel[1], bayer_pixel[bayer_line_step2 + 1], bayer_pixel[-1], bayer_pixel[bayer_line_step2 - 1]);
-    rgb_buffer[rgb_line_step + 1] = AVG4 (bayer_pixel[0], bayer_pixel[bayer_line_step2], bayer_pixel[bayer_line_step - 1], bayer_pixel[bayer_line_step + 1]);
-    rgb_buffer[rgb_line_step + 2] = bayer_pixel[bayer_line_step];
+#if defined(PCL_SIMD_KERNELS_SSE2) && defined(PCL_SIMD_KERNELS_AVX2)
+  /** Shuffle masks of storeRGBAVX2, byte i of output vector v is channel (16 v + i) % 3 of pixel (16 v + i) / 3. */
+  struct RGBShuffleMasks
+  {
+    RGBShuffleMasks ()
+    {
+      for (int v = 0; v < 3; ++v)
+        for (int channel = 0; channel < 3; ++channel)
+          for (int i = 0; i < 16; ++i)
+            masks[v][channel][i] = static_cast<signed char> ((16 * v + i) % 3 == channel ? (16 * v + i) / 3 : -128);
+    }
 
-    // Bayer         -1 0 1 2
-    //         0      r g r g
-    // line_step      g b G b
-    // line_step2     r g r g
-    rgb_buffer[rgb_line_step + 3] = AVG (bayer_pixel[1], bayer_pixel[bayer_line_step2 + 1]);
-    rgb_buffer[rgb_line_step + 4] = bayer_pixel[bayer_line_step + 1];
-    //rgb_pixel[rgb_line_step + 5] = AVG( bayer_pixel[line_step] , bayer_pixel[line_step+2] );
+    alignas (16) signed char masks[3][3][16];
+  };
+
+  const RGBShuffleMasks rgb_shuffle_masks;
+
+  /** Store 16 pixels, given as red, green and blue planes, as RGB. */
+  PCL_SIMD_TARGET_AVX2 inline void
+  storeRGBAVX2 (__m128i r, __m128i g, __m128i b, unsigned char *rgb_buffer)
+  {
+    for (int v = 0; v < 3; ++v)
+    {
+      const auto *masks = reinterpret_cast<const __m128i*> (rgb_shuffle_masks.masks[v]);
+      const __m128i rgb = _mm_or_si128 (_mm_or_si128 (_mm_shuffle_epi8 (r, _mm_load_si128 (masks)),
+                                                      _mm_shuffle_epi8 (g, _mm_load_si128 (masks + 1))),
+                                        _mm_shuffle_epi8 (b, _mm_load_si128 (masks + 2)));
+      _mm_storeu_si128 (reinterpret_cast<__m128i*> (rgb_buffer + 16 * v), rgb);
+    }
   }
 
-  // last two pixel values for first two lines
-  // GRGR line
-  // Bayer        -1 0 1
-  //           0   r G r
-  //   line_step   g b g
-  // line_step2    r g r
-  rgb_buffer[0] = AVG (bayer_pixel[1], bayer_pixel[-1]);
-  rgb_buffer[1] = bayer_pixel[0];
-  rgb_buffer[rgb_line_step + 5] = rgb_buffer[rgb_line_step + 2] = rgb_buffer[5] = rgb_buffer[2] = bayer_pixel[bayer_line_step];
+  /** Store 32 pixels, given as red, green and blue planes, as RGB. */
+  PCL_SIMD_TARGET_AVX2 inline void
+  storeRGBAVX2 (__m256i r, __m256i g, __m256i b, unsigned char *rgb_buffer)
+  {
+    storeRGBAVX2 (_mm256_castsi256_si128 (r), _mm256_castsi256_si128 (g), _mm256_castsi256_si128 (b), rgb_buffer);
+    storeRGBAVX2 (_mm256_extracti128_si256 (r, 1), _mm256_extracti128_si256 (g, 1), _mm256_extracti128_si256 (b, 1),
+                  rgb_buffer + 48);
+  }
 
-  // Bayer        -1 0 1
-  //          0    r g R
-  //  line_step    g b g
-  // line_step2    r g r
-  rgb_buffer[3] = bayer_pixel[1];
-  rgb_buffer[4] = AVG (bayer_pixel[0], bayer_pixel[bayer_line_step + 1]);
-  //rgb_pixel[5] = bayer_pixel[line_step];
+  /** Even bytes of 32 bytes, as 16 bit integers. */
+  PCL_SIMD_TARGET_AVX2 inline __m256i
+  loadEvenAVX2 (const unsigned char *p)
+  {
+    return (_mm256_and_si256 (_mm256_loadu_si256 (reinterpret_cast<const __m256i*> (p)), _mm256_set1_epi16 (0xFF)));
+  }
 
-  // BGBG line
-  // Bayer        -1 0 1
-  //          0    r g r
-  //  line_step    g B g
-  // line_step2    r g r
-  rgb_buffer[rgb_line_step ] = AVG4 (bayer_pixel[1], bayer_pixel[bayer_line_step2 + 1], bayer_pixel[-1], bayer_pixel[bayer_line_step2 - 1]);
-  rgb_buffer[rgb_line_step + 1] = AVG4 (bayer_pixel[0], bayer_pixel[bayer_line_step2], bayer_pixel[bayer_line_step - 1], bayer_pixel[bayer_line_step + 1]);
-  //rgb_pixel[rgb_line_step + 2] = bayer_pixel[line_step];
+  /** Odd bytes of 32 bytes, as 16 bit integers. */
+  PCL_SIMD_TARGET_AVX2 inline __m256i
+  loadOddAVX2 (const unsigned char *p)
+  {
+    return (_mm256_srli_epi16 (_mm256_loadu_si256 (reinterpret_cast<const __m256i*> (p)), 8));
+  }
 
-  // Bayer         -1 0 1
-  //         0      r g r
-  // line_step      g b G
-  // line_step2     r g r
-  rgb_buffer[rgb_line_step + 3] = AVG (bayer_pixel[1], bayer_pixel[bayer_line_step2 + 1]);
-  rgb_buffer[rgb_line_step + 4] = bayer_pixel[bayer_line_step + 1];
-  //rgb_pixel[rgb_line_step + 5] = bayer_pixel[line_step];
+  /** Interleave the 16 bit integers of the even and the odd pixels into 32 bytes. */
+  PCL_SIMD_TARGET_AVX2 inline __m256i
+  interleaveAVX2 (__m256i even, __m256i odd)
+  {
+    return (_mm256_or_si256 (even, _mm256_slli_epi16 (odd, 8)));
+  }
 
-  bayer_pixel += bayer_line_step + 2;
-  rgb_buffer += rgb_line_step + 6 + rgb_line_skip;
+  PCL_SIMD_TARGET_AVX2 unsigned
+  bilinearAVX2 (const unsigned char *bayer_pixel, unsigned char *rgb_buffer, unsigned width,
+                int bayer_line_step, int bayer_line_step2, unsigned rgb_line_step)
+  {
+    unsigned xIdx = 2;
+    // 16 pixel pairs of both lines per block, as in bilinearSSE2
+    for (; xIdx + 32 <= width - 2; xIdx += 32)
+    {
+      const unsigned char *p = bayer_pixel + xIdx;
+      const __m256i g0 = loadEvenAVX2 (p), r0 = loadOddAVX2 (p);
+      const __m256i r0_left = loadOddAVX2 (p - 2), g0_right = loadEvenAVX2 (p + 2);
+      const __m256i b_up = loadEvenAVX2 (p - bayer_line_step), g_up = loadOddAVX2 (p - bayer_line_step);
+      const __m256i b_up_right = loadEvenAVX2 (p - bayer_line_step + 2);
+      const __m256i b1 = loadEvenAVX2 (p + bayer_line_step), g1 = loadOddAVX2 (p + bayer_line_step);
+      const __m256i g1_left = loadOddAVX2 (p + bayer_line_step - 2), b1_right = loadEvenAVX2 (p + bayer_line_step + 2);
+      const __m256i g2 = loadEvenAVX2 (p + bayer_line_step2), r2 = loadOddAVX2 (p + bayer_line_step2);
+      const __m256i r2_left = loadOddAVX2 (p + bayer_line_step2 - 2);
+
+      unsigned char *rgb = rgb_buffer + 3 * xIdx;
+      storeRGBAVX2 (
+          interleaveAVX2 (_mm256_srli_epi16 (_mm256_add_epi16 (r0, r0_left), 1), r0),
+          interleaveAVX2 (g0, _mm256_srli_epi16 (_mm256_add_epi16 (_mm256_add_epi16 (g0, g0_right), _mm256_add_epi16 (g1, g_up)), 2)),
+          interleaveAVX2 (_mm256_srli_epi16 (_mm256_add_epi16 (b1, b_up), 1),
+                          _mm256_srli_epi16 (_mm256_add_epi16 (_mm256_add_epi16 (b_up, b_up_right), _mm256_add_epi16 (b1, b1_right)), 2)),
+          rgb);
+      storeRGBAVX2 (
+          interleaveAVX2 (_mm256_srli_epi16 (_mm256_add_epi16 (_mm256_add_epi16 (r0, r2), _mm256_add_epi16 (r0_left, r2_left)), 2),
+                          _mm256_srli_epi16 (_mm256_add_epi16 (r0, r2), 1)),
+          interleaveAVX2 (_mm256_srli_epi16 (_mm256_add_epi16 (_mm256_add_epi16 (g0, g2), _mm256_add_epi16 (g1_left, g1)), 2), g1),
+          interleaveAVX2 (b1, _mm256_srli_epi16 (_mm256_add_epi16 (b1, b1_right), 1)),
+          rgb + rgb_line_step);
+    }
+    return (xIdx);
+  }
 
-  // main processing
+  /** Red, green and blue of 8 YUV422 pixel pairs, as 16 bit integers. */
+  PCL_SIMD_TARGET_AVX2 inline void
+  yuv422ToRGBAVX2 (const unsigned char *yuv_buffer, __m256i &r, __m256i &g, __m256i &b)
+  {
+    const __m256i chroma = _mm256_sub_epi16 (loadEvenAVX2 (yuv_buffer), _mm256_set1_epi16 (128));
+    const __m256i luma = loadOddAVX2 (yuv_buffer);
+    // See yuv422OffsetsSSE2
+    const __m256i dr = _mm256_srai_epi32 (_mm256_add_epi32 (_mm256_madd_epi16 (chroma, _mm256_set1_epi32 (18678 << 16)), _mm256_set1_epi32 (8192)), 14);
+    const __m256i dg = _mm256_srai_epi32 (_mm256_add_epi32 (_mm256_madd_epi16 (chroma, _mm256_set1_epi32 (static_cast<int> (0xDAD1E6B8))), _mm256_set1_epi32 (8192)), 14);
+    const __m256i db = _mm256_srai_epi32 (_mm256_add_epi32 (_mm256_madd_epi16 (chroma, _mm256_set1_epi32 (16646)), _mm256_set1_epi32 (4096)), 13);
+    const __m256i low = _mm256_set1_epi32 (0xFFFF);
+    r = _mm256_add_epi16 (luma, _mm256_or_si256 (_mm256_and_si256 (dr, low), _mm256_slli_epi32 (dr, 16)));
+    g = _mm256_add_epi16 (luma, _mm256_or_si256 (_mm256_and_si256 (dg, low), _mm256_slli_epi32 (dg, 16)));
+    b = _mm256_add_epi16 (luma, _mm256_or_si256 (_mm256_and_si256 (db, low), _mm256_slli_epi32 (db, 16)));
+  }
+
+  /** Saturate the 16 bit integers of a and b to bytes, in order. */
+  PCL_SIMD_TARGET_AVX2 inline __m256i
+  packAVX2 (__m256i a, __m256i b)
+  {
+    return (_mm256_permute4x64_epi64 (_mm256_packus_epi16 (a, b), 0xD8));
+  }
+
+  PCL_SIMD_TARGET_AVX2 unsigned
+  yuv422AVX2 (const unsigned char *yuv_buffer, unsigned char *rgb_buffer, unsigned begin, unsigned end)
+  {
+    unsigned pair = begin;
+    // 16 pixel pairs per block
+    for (; pair + 16 <= end; pair += 16)
+    {
+      __m256i r[2], g[2], b[2];
+      yuv422ToRGBAVX2 (yuv_buffer + 4 * pair, r[0], g[0], b[0]);
+      yuv422ToRGBAVX2 (yuv_buffer + 4 * pair + 32, r[1], g[1], b[1]);
+      storeRGBAVX2 (packAVX2 (r[0], r[1]), packAVX2 (g[0], g[1]), packAVX2 (b[0], b[1]), rgb_buffer + 6 * pair);
+    }
+    return (yuv422SSE2 (yuv_buffer, rgb_buffer, pair, end));
+  }
+#endif // PCL_SIMD_KERNELS_AVX2
+
+  BilinearKernel
+  selectBilinearKernel ()
+  {
+    const pcl::SIMDLevel level = pcl::getSIMDLevel ();
+#if defined(PCL_SIMD_KERNELS_SSE2) && defined(PCL_SIMD_KERNELS_AVX2)
+    if (level >= pcl::SIMDLevel::AVX2)
+      return (bilinearAVX2);
+#endif
+#ifdef PCL_SIMD_KERNELS_SSE2
+    if (level >= pcl::SIMDLevel::SSE2)
+      return (bilinearSSE2);
+#endif
+    (void) level;
+    return (nullptr);
+  }
+
+  YUV422Kernel
+  selectYUV422Kernel ()
+  {
+    const pcl::SIMDLevel level = pcl::getSIMDLevel ();
+#if defined(PCL_SIMD_KERNELS_SSE2) && defined(PCL_SIMD_KERNELS_AVX2)
+    if (level >= pcl::SIMDLevel::AVX2)
+      return (yuv422AVX2);
+#endif
+#ifdef PCL_SIMD_KERNELS_SSE2
+    if (level >= pcl::SIMDLevel::SSE2)
+      return (yuv422SSE2);
+#endif
+    (void) level;
+    return (nullptr);
+  }
 
-  for (unsigned yIdx = 2; yIdx < height - 2; yIdx += 2)
+  /** Bilinear debayering of the lines of a pair of lines of the Bayer image that are neither the first two nor
+    * the last two lines. The middle of the lines is converted by \a kernel, if there is one. */
+  void
+  bilinearLinePair (
+      const unsigned char *bayer_pixel, unsigned char *rgb_buffer, unsigned width,
+      int bayer_line_step, int bayer_line_step2, unsigned rgb_line_step,
+      BilinearKernel kernel)
   {
     // first two pixel values
     // Bayer         0 1 2
@@ -215,10 +395,11 @@ pcl::io::DeBayer::debayerBilinear (
     rgb_buffer[rgb_line_step + 4] = bayer_pixel[bayer_line_step + 1];
     rgb_buffer[rgb_line_step + 5] = AVG (bayer_pixel[bayer_line_step], bayer_pixel[bayer_line_step + 2]);
 
-    rgb_buffer += 6;
-    bayer_pixel += 2;
-    // continue with rest of the line
-    for (unsigned xIdx = 2; xIdx < width - 2; xIdx += 2, rgb_buffer += 6, bayer_pixel += 2)
+    // continue with rest of the line, blocks of pixels first
+    const unsigned x_begin = (kernel ? kernel (bayer_pixel, rgb_buffer, width, bayer_line_step, bayer_line_step2, rgb_line_step) : 2);
+    rgb_buffer += 3 * x_begin;
+    bayer_pixel += x_begin;
+    for (unsigned xIdx = x_begin; xIdx < width - 2; xIdx += 2, rgb_buffer += 6, bayer_pixel += 2)
     {
       // GRGR line
       // Bayer        -1 0 1 2
@@ -275,30 +456,491 @@ pcl::io::DeBayer::debayerBilinear (
     //  line_step    g b g
     // line_step2    r g r
     rgb_buffer[3] = bayer_pixel[1];
-    rgb_buffer[4] = AVG (bayer_pixel[0], bayer_pixel[bayer_line_step + 1]);
-    //rgb_pixel[5] = bayer_pixel[line_step];
+    rgb_buffer[4] = AVG (bayer_pixel[0], bayer_pixel[bayer_line_step + 1]);
+    //rgb_pixel[5] = bayer_pixel[line_step];
+
+    // BGBG line
+    // Bayer        -1 0 1
+    //          0    r g r
+    //  line_step    g B g
+    // line_step2    r g r
+    rgb_buffer[rgb_line_step ] = AVG4 (bayer_pixel[1], bayer_pixel[bayer_line_step2 + 1], bayer_pixel[-1], bayer_pixel[bayer_line_step2 - 1]);
+    rgb_buffer[rgb_line_step + 1] = AVG4 (bayer_pixel[0], bayer_pixel[bayer_line_step2], bayer_pixel[bayer_line_step - 1], bayer_pixel[bayer_line_step + 1]);
+    //rgb_pixel[rgb_line_step + 2] = bayer_pixel[line_step];
+
+    // Bayer         -1 0 1
+    //         0      r g r
+    // line_step      g b G
+    // line_step2     r g r
+    rgb_buffer[rgb_line_step + 3] = AVG (bayer_pixel[1], bayer_pixel[bayer_line_step2 + 1]);
+    rgb_buffer[rgb_line_step + 4] = bayer_pixel[bayer_line_step + 1];
+    //rgb_pixel[rgb_line_step + 5] = bayer_pixel[line_step];
+  }
+
+  /** Edge aware debayering of a pair of lines, see bilinearLinePair. */
+  void
+  edgeAwareLinePair (
+      const unsigned char *bayer_pixel, unsigned char *rgb_buffer, unsigned width,
+      int bayer_line_step, int bayer_line_step2, unsigned rgb_line_step)
+  {
+    // first two pixel values
+    // Bayer         0 1 2
+    //        -1     b g b
+    //         0     G r g
+    // line_step     b g b
+    // line_step2    g r g
+
+    rgb_buffer[3] = rgb_buffer[0] = bayer_pixel[1]; // red pixel
+    rgb_buffer[1] = bayer_pixel[0]; // green pixel
+    rgb_buffer[2] = AVG (bayer_pixel[bayer_line_step], bayer_pixel[-bayer_line_step]); // blue;
+
+    // Bayer         0 1 2
+    //        -1     b g b
+    //         0     g R g
+    // line_step     b g b
+    // line_step2    g r g
+    //rgb_pixel[3] = bayer_pixel[1];
+    rgb_buffer[4] = AVG4 (bayer_pixel[0], bayer_pixel[2], bayer_pixel[bayer_line_step + 1], bayer_pixel[1 - bayer_line_step]);
+    rgb_buffer[5] = AVG4 (bayer_pixel[bayer_line_step], bayer_pixel[bayer_line_step + 2], bayer_pixel[-bayer_line_step], bayer_pixel[2 - bayer_line_step]);
+
+    // BGBG line
+    // Bayer         0 1 2
+    //         0     g r g
+    // line_step     B g b
+    // line_step2    g r g
+    rgb_buffer[rgb_line_step + 3] = rgb_buffer[rgb_line_step ] = AVG (bayer_pixel[1], bayer_pixel[bayer_line_step2 + 1]);
+    rgb_buffer[rgb_line_step + 1] = AVG3 (bayer_pixel[0], bayer_pixel[bayer_line_step + 1], bayer_pixel[bayer_line_step2]);
+    rgb_buffer[rgb_line_step + 2] = bayer_pixel[bayer_line_step];
+
+    // pixel (1, 1)  0 1 2
+    //         0     g r g
+    // line_step     b G b
+    // line_step2    g r g
+    //rgb_pixel[rgb_line_step + 3] = AVG( bayer_pixel[1] , bayer_pixel[line_step2+1] );
+    rgb_buffer[rgb_line_step + 4] = bayer_pixel[bayer_line_step + 1];
+    rgb_buffer[rgb_line_step + 5] = AVG (bayer_pixel[bayer_line_step], bayer_pixel[bayer_line_step + 2]);
+
+    rgb_buffer += 6;
+    bayer_pixel += 2;
+    // continue with rest of the line
+    for (unsigned xIdx = 2; xIdx < width - 2; xIdx += 2, rgb_buffer += 6, bayer_pixel += 2)
+    {
+      // GRGR line
+      // Bayer        -1 0 1 2
+      //          -1   g b g b
+      //           0   r G r g
+      //   line_step   g b g b
+      // line_step2    r g r g
+      rgb_buffer[0] = AVG (bayer_pixel[1], bayer_pixel[-1]);
+      rgb_buffer[1] = bayer_pixel[0];
+      rgb_buffer[2] = AVG (bayer_pixel[bayer_line_step], bayer_pixel[-bayer_line_step]);
+
+      // Bayer        -1 0 1 2
+      //          -1   g b g b
+      //          0    r g R g
+      //  line_step    g b g b
+      // line_step2    r g r g
+
+      int dh = std::abs (bayer_pixel[0] - bayer_pixel[2]);
+      int dv = std::abs (bayer_pixel[-bayer_line_step + 1] - bayer_pixel[bayer_line_step + 1]);
+
+      if (dh > dv)
+        rgb_buffer[4] = AVG (bayer_pixel[-bayer_line_step + 1], bayer_pixel[bayer_line_step + 1]);
+      else if (dv > dh)
+        rgb_buffer[4] = AVG (bayer_pixel[0], bayer_pixel[2]);
+      else
+        rgb_buffer[4] = AVG4 (bayer_pixel[-bayer_line_step + 1], bayer_pixel[bayer_line_step + 1], bayer_pixel[0], bayer_pixel[2]);
+
+      rgb_buffer[3] = bayer_pixel[1];
+      rgb_buffer[5] = AVG4 (bayer_pixel[-bayer_line_step], bayer_pixel[2 - bayer_line_step], bayer_pixel[bayer_line_step], bayer_pixel[bayer_line_step + 2]);
+
+      // BGBG line
+      // Bayer         -1 0 1 2
+      //         -1     g b g b
+      //          0     r g r g
+      // line_step      g B g b
+      // line_step2     r g r g
+      rgb_buffer[rgb_line_step ] = AVG4 (bayer_pixel[1], bayer_pixel[bayer_line_step2 + 1], bayer_pixel[-1], bayer_pixel[bayer_line_step2 - 1]);
+      rgb_buffer[rgb_line_step + 2] = bayer_pixel[bayer_line_step];
+
+      dv = std::abs (bayer_pixel[0] - bayer_pixel[bayer_line_step2]);
+      dh = std::abs (bayer_pixel[bayer_line_step - 1] - bayer_pixel[bayer_line_step + 1]);
+
+      if (dv > dh)
+        rgb_buffer[rgb_line_step + 1] = AVG (bayer_pixel[bayer_line_step - 1], bayer_pixel[bayer_line_step + 1]);
+      else if (dh > dv)
+        rgb_buffer[rgb_line_step + 1] = AVG (bayer_pixel[0], bayer_pixel[bayer_line_step2]);
+      else
+        rgb_buffer[rgb_line_step + 1] = AVG4 (bayer_pixel[0], bayer_pixel[bayer_line_step2], bayer_pixel[bayer_line_step - 1], bayer_pixel[bayer_line_step + 1]);
+
+      // Bayer         -1 0 1 2
+      //         -1     g b g b
+      //          0     r g r g
+      // line_step      g b G b
+      // line_step2     r g r g
+      rgb_buffer[rgb_line_step + 3] = AVG (bayer_pixel[1], bayer_pixel[bayer_line_step2 + 1]);
+      rgb_buffer[rgb_line_step + 4] = bayer_pixel[bayer_line_step + 1];
+      rgb_buffer[rgb_line_step + 5] = AVG (bayer_pixel[bayer_line_step], bayer_pixel[bayer_line_step + 2]);
+    }
+
+    // last two pixels of the line
+    // last two pixel values for first two lines
+    // GRGR line
+    // Bayer        -1 0 1
+    //           0   r G r
+    //   line_step   g b g
+    // line_step2    r g r
+    rgb_buffer[0] = AVG (bayer_pixel[1], bayer_pixel[-1]);
+    rgb_buffer[1] = bayer_pixel[0];
+    rgb_buffer[rgb_line_step + 5] = rgb_buffer[rgb_line_step + 2] = rgb_buffer[5] = rgb_buffer[2] = bayer_pixel[bayer_line_step];
+
+    // Bayer        -1 0 1
+    //          0    r g R
+    //  line_step    g b g
+    // line_step2    r g r
+    rgb_buffer[3] = bayer_pixel[1];
+    rgb_buffer[4] = AVG (bayer_pixel[0], bayer_pixel[bayer_line_step + 1]);
+    //rgb_pixel[5] = bayer_pixel[line_step];
+
+    // BGBG line
+    // Bayer        -1 0 1
+    //          0    r g r
+    //  line_step    g B g
+    // line_step2    r g r
+    rgb_buffer[rgb_line_step ] = AVG4 (bayer_pixel[1], bayer_pixel[bayer_line_step2 + 1], bayer_pixel[-1], bayer_pixel[bayer_line_step2 - 1]);
+    rgb_buffer[rgb_line_step + 1] = AVG4 (bayer_pixel[0], bayer_pixel[bayer_line_step2], bayer_pixel[bayer_line_step - 1], bayer_pixel[bayer_line_step + 1]);
+    //rgb_pixel[rgb_line_step + 2] = bayer_pixel[line_step];
+
+    // Bayer         -1 0 1
+    //         0      r g r
+    // line_step      g b G
+    // line_step2     r g r
+    rgb_buffer[rgb_line_step + 3] = AVG (bayer_pixel[1], bayer_pixel[bayer_line_step2 + 1]);
+    rgb_buffer[rgb_line_step + 4] = bayer_pixel[bayer_line_step + 1];
+    //rgb_pixel[rgb_line_step + 5] = bayer_pixel[line_step];
+  }
+
+  /** Weighted edge aware debayering of a pair of lines, see bilinearLinePair. */
+  void
+  edgeAwareWeightedLinePair (
+      const unsigned char *bayer_pixel, unsigned char *rgb_buffer, unsigned width,
+      int bayer_line_step, int bayer_line_step2, unsigned rgb_line_step)
+  {
+    // first two pixel values
+    // Bayer         0 1 2
+    //        -1     b g b
+    //         0     G r g
+    // line_step     b g b
+    // line_step2    g r g
+
+    rgb_buffer[3] = rgb_buffer[0] = bayer_pixel[1]; // red pixel
+    rgb_buffer[1] = bayer_pixel[0]; // green pixel
+    rgb_buffer[2] = AVG (bayer_pixel[bayer_line_step], bayer_pixel[-bayer_line_step]); // blue;
+
+    // Bayer         0 1 2
+    //        -1     b g b
+    //         0     g R g
+    // line_step     b g b
+    // line_step2    g r g
+    //rgb_pixel[3] = bayer_pixel[1];
+    rgb_buffer[4] = AVG4 (bayer_pixel[0], bayer_pixel[2], bayer_pixel[bayer_line_step + 1], bayer_pixel[1 - bayer_line_step]);
+    rgb_buffer[5] = AVG4 (bayer_pixel[bayer_line_step], bayer_pixel[bayer_line_step + 2], bayer_pixel[-bayer_line_step], bayer_pixel[2 - bayer_line_step]);
+
+    // BGBG line
+    // Bayer         0 1 2
+    //         0     g r g
+    // line_step     B g b
+    // line_step2    g r g
+    rgb_buffer[rgb_line_step + 3] = rgb_buffer[rgb_line_step ] = AVG (bayer_pixel[1], bayer_pixel[bayer_line_step2 + 1]);
+    rgb_buffer[rgb_line_step + 1] = AVG3 (bayer_pixel[0], bayer_pixel[bayer_line_step + 1], bayer_pixel[bayer_line_step2]);
+    rgb_buffer[rgb_line_step + 2] = bayer_pixel[bayer_line_step];
+
+    // pixel (1, 1)  0 1 2
+    //         0     g r g
+    // line_step     b G b
+    // line_step2    g r g
+    //rgb_pixel[rgb_line_step + 3] = AVG( bayer_pixel[1] , bayer_pixel[line_step2+1] );
+    rgb_buffer[rgb_line_step + 4] = bayer_pixel[bayer_line_step + 1];
+    rgb_buffer[rgb_line_step + 5] = AVG (bayer_pixel[bayer_line_step], bayer_pixel[bayer_line_step + 2]);
+
+    rgb_buffer += 6;
+    bayer_pixel += 2;
+    // continue with rest of the line
+    for (unsigned xIdx = 2; xIdx < width - 2; xIdx += 2, rgb_buffer += 6, bayer_pixel += 2)
+    {
+      // GRGR line
+      // Bayer        -1 0 1 2
+      //          -1   g b g b
+      //           0   r G r g
+      //   line_step   g b g b
+      // line_step2    r g r g
+      rgb_buffer[0] = AVG (bayer_pixel[1], bayer_pixel[-1]);
+      rgb_buffer[1] = bayer_pixel[0];
+      rgb_buffer[2] = AVG (bayer_pixel[bayer_line_step], bayer_pixel[-bayer_line_step]);
+
+      // Bayer        -1 0 1 2
+      //          -1   g b g b
+      //          0    r g R g
+      //  line_step    g b g b
+      // line_step2    r g r g
+
+      int dh = std::abs (bayer_pixel[0] - bayer_pixel[2]);
+      int dv = std::abs (bayer_pixel[-bayer_line_step + 1] - bayer_pixel[bayer_line_step + 1]);
+
+      if (dv == 0 && dh == 0)
+        rgb_buffer[4] = AVG4 (bayer_pixel[1 - bayer_line_step], bayer_pixel[1 + bayer_line_step], bayer_pixel[0], bayer_pixel[2]);
+      else
+        rgb_buffer[4] = WAVG4 (bayer_pixel[1 - bayer_line_step], bayer_pixel[1 + bayer_line_step], bayer_pixel[0], bayer_pixel[2], dh, dv);
+      rgb_buffer[3] = bayer_pixel[1];
+      rgb_buffer[5] = AVG4 (bayer_pixel[-bayer_line_step], bayer_pixel[2 - bayer_line_step], bayer_pixel[bayer_line_step], bayer_pixel[bayer_line_step + 2]);
+
+      // BGBG line
+      // Bayer         -1 0 1 2
+      //         -1     g b g b
+      //          0     r g r g
+      // line_step      g B g b
+      // line_step2     r g r g
+      rgb_buffer[rgb_line_step ] = AVG4 (bayer_pixel[1], bayer_pixel[bayer_line_step2 + 1], bayer_pixel[-1], bayer_pixel[bayer_line_step2 - 1]);
+      rgb_buffer[rgb_line_step + 2] = bayer_pixel[bayer_line_step];
+
+      dv = std::abs (bayer_pixel[0] - bayer_pixel[bayer_line_step2]);
+      dh = std::abs (bayer_pixel[bayer_line_step - 1] - bayer_pixel[bayer_line_step + 1]);
+
+      if (dv == 0 && dh == 0)
+        rgb_buffer[rgb_line_step + 1] = AVG4 (bayer_pixel[0], bayer_pixel[bayer_line_step2], bayer_pixel[bayer_line_step - 1], bayer_pixel[bayer_line_step + 1]);
+      else
+        rgb_buffer[rgb_line_step + 1] = WAVG4 (bayer_pixel[0], bayer_pixel[bayer_line_step2], bayer_pixel[bayer_line_step - 1], bayer_pixel[bayer_line_step + 1], dh, dv);
+
+      // Bayer         -1 0 1 2
+      //         -1     g b g b
+      //          0     r g r g
+      // line_step      g b G b
+      // line_step2     r g r g
+      rgb_buffer[rgb_line_step + 3] = AVG (bayer_pixel[1], bayer_pixel[bayer_line_step2 + 1]);
+      rgb_buffer[rgb_line_step + 4] = bayer_pixel[bayer_line_step + 1];
+      rgb_buffer[rgb_line_step + 5] = AVG (bayer_pixel[bayer_line_step], bayer_pixel[bayer_line_step + 2]);
+    }
+
+    // last two pixels of the line
+    // last two pixel values for first two lines
+    // GRGR line
+    // Bayer        -1 0 1
+    //           0   r G r
+    //   line_step   g b g
+    // line_step2    r g r
+    rgb_buffer[0] = AVG (bayer_pixel[1], bayer_pixel[-1]);
+    rgb_buffer[1] = bayer_pixel[0];
+    rgb_buffer[rgb_line_step + 5] = rgb_buffer[rgb_line_step + 2] = rgb_buffer[5] = rgb_buffer[2] = bayer_pixel[bayer_line_step];
+
+    // Bayer        -1 0 1
+    //          0    r g R
+    //  line_step    g b g
+    // line_step2    r g r
+    rgb_buffer[3] = bayer_pixel[1];
+    rgb_buffer[4] = AVG (bayer_pixel[0], bayer_pixel[bayer_line_step + 1]);
+    //rgb_pixel[5] = bayer_pixel[line_step];
+
+    // BGBG line
+    // Bayer        -1 0 1
+    //          0    r g r
+    //  line_step    g B g
+    // line_step2    r g r
+    rgb_buffer[rgb_line_step ] = AVG4 (bayer_pixel[1], bayer_pixel[bayer_line_step2 + 1], bayer_pixel[-1], bayer_pixel[bayer_line_step2 - 1]);
+    rgb_buffer[rgb_line_step + 1] = AVG4 (bayer_pixel[0], bayer_pixel[bayer_line_step2], bayer_pixel[bayer_line_step - 1], bayer_pixel[bayer_line_step + 1]);
+    //rgb_pixel[rgb_line_step + 2] = bayer_pixel[line_step];
+
+    // Bayer         -1 0 1
+    //         0      r g r
+    // line_step      g b G
+    // line_step2     r g r
+    rgb_buffer[rgb_line_step + 3] = AVG (bayer_pixel[1], bayer_pixel[bayer_line_step2 + 1]);
+    rgb_buffer[rgb_line_step + 4] = bayer_pixel[bayer_line_step + 1];
+    //rgb_pixel[rgb_line_step + 5] = bayer_pixel[line_step];
+  }
+
+  /** Convert a line of a YUV422 image, see pcl::io::convertYUV422ToRGB. */
+  void
+  yuv422Line (const unsigned char *yuv_buffer, unsigned char *rgb_buffer, unsigned width, YUV422Kernel kernel)
+  {
+    // 0  1   2  3
+    // u  y1  v  y2
+    const unsigned nr_pairs = width / 2;
+    const unsigned pair_begin = (kernel ? kernel (yuv_buffer, rgb_buffer, 0, nr_pairs) : 0);
+    rgb_buffer += 6 * pair_begin;
+    yuv_buffer += 4 * pair_begin;
+    for (unsigned pair = pair_begin; pair < nr_pairs; ++pair, rgb_buffer += 6, yuv_buffer += 4)
+    {
+      int v = yuv_buffer[2] - 128;
+      int u = yuv_buffer[0] - 128;
+
+      rgb_buffer[0] =  CLIP_CHAR (yuv_buffer[1] + ((v * 18678 + 8192 ) >> 14));
+      rgb_buffer[1] =  CLIP_CHAR (yuv_buffer[1] + ((v * -9519 - u * 6472 + 8192 ) >> 14));
+      rgb_buffer[2] =  CLIP_CHAR (yuv_buffer[1] + ((u * 33292 + 8192 ) >> 14));
+
+      rgb_buffer[3] =  CLIP_CHAR (yuv_buffer[3] + ((v * 18678 + 8192 ) >> 14));
+      rgb_buffer[4] =  CLIP_CHAR (yuv_buffer[3] + ((v * -9519 - u * 6472 + 8192 ) >> 14));
+      rgb_buffer[5] =  CLIP_CHAR (yuv_buffer[3] + ((u * 33292 + 8192 ) >> 14));
+    }
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////
+void
+pcl::io::DeBayer::setNumberOfThreads (unsigned int nr_threads)
+{
+  // 0 is resolved against the budget of pcl::ExecutionContext at compute time
+  threads_ = nr_threads;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+void
+pcl::io::DeBayer::debayerBilinear (
+    const unsigned char *bayer_pixel, unsigned char *rgb_buffer,
+    unsigned width, unsigned height, 
+    int bayer_line_step,
+    int bayer_line_step2,
+    unsigned rgb_line_step) const
+{
+  if (bayer_line_step == 0)
+    bayer_line_step = width;
+  if (bayer_line_step2 == 0)
+    bayer_line_step2 = width << 1;
+  if (rgb_line_step == 0)
+    rgb_line_step = width * 3;
+
+  // padding skip for destination image
+  unsigned rgb_line_skip = rgb_line_step - width * 3;
+  // first two pixel values for first two lines
+  // Bayer         0 1 2
+  //         0     G r g
+  // line_step     b g b
+  // line_step2    g r g
+
+  rgb_buffer[3] = rgb_buffer[0] = bayer_pixel[1]; // red pixel
+  rgb_buffer[1] = bayer_pixel[0]; // green pixel
+  rgb_buffer[rgb_line_step + 2] = rgb_buffer[2] = bayer_pixel[bayer_line_step]; // blue;
+
+  // Bayer         0 1 2
+  //         0     g R g
+  // line_step     b g b
+  // line_step2    g r g
+  //rgb_pixel[3] = bayer_pixel[1];
+  rgb_buffer[4] = AVG3 (bayer_pixel[0], bayer_pixel[2], bayer_pixel[bayer_line_step + 1]);
+  rgb_buffer[rgb_line_step + 5] = rgb_buffer[5] = AVG (bayer_pixel[bayer_line_step], bayer_pixel[bayer_line_step + 2]);
+
+  // BGBG line
+  // Bayer         0 1 2
+  //         0     g r g
+  // line_step     B g b
+  // line_step2    g r g
+  rgb_buffer[rgb_line_step + 3] = rgb_buffer[rgb_line_step ] = AVG (bayer_pixel[1], bayer_pixel[bayer_line_step2 + 1]);
+  rgb_buffer[rgb_line_step + 1] = AVG3 (bayer_pixel[0], bayer_pixel[bayer_line_step + 1], bayer_pixel[bayer_line_step2]);
+  //rgb_pixel[rgb_line_step + 2] = bayer_pixel[line_step];
+
+  // pixel (1, 1)  0 1 2
+  //         0     g r g
+  // line_step     b G b
+  // line_step2    g r g
+  //rgb_pixel[rgb_line_step + 3] = AVG( bayer_pixel[1] , bayer_pixel[line_step2+1] );
+  rgb_buffer[rgb_line_step + 4] = bayer_pixel[bayer_line_step + 1];
+  //rgb_pixel[rgb_line_step + 5] = AVG( bayer_pixel[line_step] , bayer_pixel[line_step+2] );
+
+  rgb_buffer += 6;
+  bayer_pixel += 2;
+  // rest of the first two lines
+  for (unsigned xIdx = 2; xIdx < width - 2; xIdx += 2, rgb_buffer += 6, bayer_pixel += 2)
+  {
+    // GRGR line
+    // Bayer        -1 0 1 2
+    //           0   r G r g
+    //   line_step   g b g b
+    // line_step2    r g r g
+    rgb_buffer[0] = AVG (bayer_pixel[1], bayer_pixel[-1]);
+    rgb_buffer[1] = bayer_pixel[0];
+    rgb_buffer[2] = bayer_pixel[bayer_line_step + 1];
+
+    // Bayer        -1 0 1 2
+    //          0    r g R g
+    //  line_step    g b g b
+    // line_step2    r g r g
+    rgb_buffer[3] = bayer_pixel[1];
+    rgb_buffer[4] = AVG3 (bayer_pixel[0], bayer_pixel[2], bayer_pixel[bayer_line_step + 1]);
+    rgb_buffer[rgb_line_step + 5] = rgb_buffer[5] = AVG (bayer_pixel[bayer_line_step], bayer_pixel[bayer_line_step + 2]);
 
     // BGBG line
-    // Bayer        -1 0 1
-    //          0    r g r
-    //  line_step    g B g
-    // line_step2    r g r
+    // Bayer         -1 0 1 2
+    //         0      r g r g
+    // line_step      g B g b
+    // line_step2     r g r g
     rgb_buffer[rgb_line_step ] = AVG4 (bayer_pixel[1], bayer_pixel[bayer_line_step2 + 1], bayer_pixel[-1], bayer_pixel[bayer_line_step2 - 1]);
     rgb_buffer[rgb_line_step + 1] = AVG4 (bayer_pixel[0], bayer_pixel[bayer_line_step2], bayer_pixel[bayer_line_step - 1], bayer_pixel[bayer_line_step + 1]);
-    //rgb_pixel[rgb_line_step + 2] = bayer_pixel[line_step];
+    rgb_buffer[rgb_line_step + 2] = bayer_pixel[bayer_line_step];
 
-    // Bayer         -1 0 1
-    //         0      r g r
-    // line_step      g b G
-    // line_step2     r g r
+    // Bayer         -1 0 1 2
+    //         0      r g r g
+    // line_step      g b G b
+    // line_step2     r g r g
     rgb_buffer[rgb_line_step + 3] = AVG (bayer_pixel[1], bayer_pixel[bayer_line_step2 + 1]);
     rgb_buffer[rgb_line_step + 4] = bayer_pixel[bayer_line_step + 1];
-    //rgb_pixel[rgb_line_step + 5] = bayer_pixel[line_step];
-
-    bayer_pixel += bayer_line_step + 2;
-    rgb_buffer += rgb_line_step + 6 + rgb_line_skip;
+    //rgb_pixel[rgb_line_step + 5] = AVG( bayer_pixel[line_step] , bayer_pixel[line_step+2] );
   }
 
+  // last two pixel values for first two lines
+  // GRGR line
+  // Bayer        -1 0 1
+  //           0   r G r
+  //   line_step   g b g
+  // line_step2    r g r
+  rgb_buffer[0] = AVG (bayer_pixel[1], bayer_pixel[-1]);
+  rgb_buffer[1] = bayer_pixel[0];
+  rgb_buffer[rgb_line_step + 5] = rgb_buffer[rgb_line_step + 2] = rgb_buffer[5] = rgb_buffer[2] = bayer_pixel[bayer_line_step];
+
+  // Bayer        -1 0 1
+  //          0    r g R
+  //  line_step    g b g
+  // line_step2    r g r
+  rgb_buffer[3] = bayer_pixel[1];
+  rgb_buffer[4] = AVG (bayer_pixel[0], bayer_pixel[bayer_line_step + 1]);
+  //rgb_pixel[5] = bayer_pixel[line_step];
+
+  // BGBG line
+  // Bayer        -1 0 1
+  //          0    r g r
+  //  line_step    g B g
+  // line_step2    r g r
+  rgb_buffer[rgb_line_step ] = AVG4 (bayer_pixel[1], bayer_pixel[bayer_line_step2 + 1], bayer_pixel[-1], bayer_pixel[bayer_line_step2 - 1]);
+  rgb_buffer[rgb_line_step + 1] = AVG4 (bayer_pixel[0], bayer_pixel[bayer_line_step2], bayer_pixel[bayer_line_step - 1], bayer_pixel[bayer_line_step + 1]);
+  //rgb_pixel[rgb_line_step + 2] = bayer_pixel[line_step];
+
+  // Bayer         -1 0 1
+  //         0      r g r
+  // line_step      g b G
+  // line_step2     r g r
+  rgb_buffer[rgb_line_step + 3] = AVG (bayer_pixel[1], bayer_pixel[bayer_line_step2 + 1]);
+  rgb_buffer[rgb_line_step + 4] = bayer_pixel[bayer_line_step + 1];
+  //rgb_pixel[rgb_line_step + 5] = bayer_pixel[line_step];
+
+  bayer_pixel += bayer_line_step + 2;
+  rgb_buffer += rgb_line_step + 6 + rgb_line_skip;
+
+  // main processing, the pairs of lines are independent
+  const BilinearKernel kernel = selectBilinearKernel ();
+  const std::ptrdiff_t nr_line_pairs = (height >= 4 ? (height - 3) / 2 : 0);
+  const std::ptrdiff_t bayer_pair_step = width + bayer_line_step;
+  const std::ptrdiff_t rgb_pair_step = 2 * static_cast<std::ptrdiff_t> (rgb_line_step);
+  const pcl::ThreadReservation reservation (threads_);
+  const unsigned int threads = static_cast<unsigned int> (std::max<std::ptrdiff_t> (1, std::min<std::ptrdiff_t> (reservation.getNumberOfThreads (), nr_line_pairs)));
+#pragma omp parallel for \
+  default(none) \
+  shared(bayer_pixel, rgb_buffer, width, bayer_line_step, bayer_line_step2, rgb_line_step, kernel) \
+  firstprivate(nr_line_pairs, bayer_pair_step, rgb_pair_step) \
+  num_threads(threads)
+  for (std::ptrdiff_t line_pair = 0; line_pair < nr_line_pairs; ++line_pair)
+    bilinearLinePair (bayer_pixel + line_pair * bayer_pair_step, rgb_buffer + line_pair * rgb_pair_step,
+                      width, bayer_line_step, bayer_line_step2, rgb_line_step, kernel);
+  bayer_pixel += nr_line_pairs * bayer_pair_step;
+  rgb_buffer += nr_line_pairs * rgb_pair_step;
+
   //last two lines
   // Bayer         0 1 2
   //        -1     b g b
@@ -445,246 +1087,121 @@ pcl::io::DeBayer::debayerEdgeAware (
   // line_step     b g b
   // line_step2    g r g
   //rgb_pixel[3] = bayer_pixel[1];
-  rgb_buffer[4] = AVG3 (bayer_pixel[0], bayer_pixel[2], bayer_pixel[bayer_line_step + 1]);
-  rgb_buffer[rgb_line_step + 5] = rgb_buffer[5] = AVG (bayer_pixel[bayer_line_step], bayer_pixel[bayer_line_step + 2]);
-
-  // BGBG line
-  // Bayer         0 1 2
-  //         0     g r g
-  // line_step     B g b
-  // line_step2    g r g
-  rgb_buffer[rgb_line_step + 3] = rgb_buffer[rgb_line_step ] = AVG (bayer_pixel[1], bayer_pixel[bayer_line_step2 + 1]);
-  rgb_buffer[rgb_line_step + 1] = AVG3 (bayer_pixel[0], bayer_pixel[bayer_line_step + 1], bayer_pixel[bayer_line_step2]);
-  //rgb_pixel[rgb_line_step + 2] = bayer_pixel[line_step];
-
-  // pixel (1, 1)  0 1 2
-  //         0     g r g
-  // line_step     b G b
-  // line_step2    g r g
-  //rgb_pixel[rgb_line_step + 3] = AVG( bayer_pixel[1] , bayer_pixel[line_step2+1] );
-  rgb_buffer[rgb_line_step + 4] = bayer_pixel[bayer_line_step + 1];
-  //rgb_pixel[rgb_line_step + 5] = AVG( bayer_pixel[line_step] , bayer_pixel[line_step+2] );
-
-  rgb_buffer += 6;
-  bayer_pixel += 2;
-  // rest of the first two lines
-  for (unsigned xIdx = 2; xIdx < width - 2; xIdx += 2, rgb_buffer += 6, bayer_pixel += 2)
-  {
-    // GRGR line
-    // Bayer        -1 0 1 2
-    //           0   r G r g
-    //   line_step   g b g b
-    // line_step2    r g r g
-    rgb_buffer[0] = AVG (bayer_pixel[1], bayer_pixel[-1]);
-    rgb_buffer[1] = bayer_pixel[0];
-    rgb_buffer[2] = bayer_pixel[bayer_line_step + 1];
-
-    // Bayer        -1 0 1 2
-    //          0    r g R g
-    //  line_step    g b g b
-    // line_step2    r g r g
-    rgb_buffer[3] = bayer_pixel[1];
-    rgb_buffer[4] = AVG3 (bayer_pixel[0], bayer_pixel[2], bayer_pixel[bayer_line_step + 1]);
-    rgb_buffer[rgb_line_step + 5] = rgb_buffer[5] = AVG (bayer_pixel[bayer_line_step], bayer_pixel[bayer_line_step + 2]);
-
-    // BGBG line
-    // Bayer         -1 0 1 2
-    //         0      r g r g
-    // line_step      g B g b
-    // line_step2     r g r g
-    rgb_buffer[rgb_line_step ] = AVG4 (bayer_pixel[1], bayer_pixel[bayer_line_step2 + 1], bayer_pixel[-1], bayer_pixel[bayer_line_step2 - 1]);
-    rgb_buffer[rgb_line_step + 1] = AVG4 (bayer_pixel[0], bayer_pixel[bayer_line_step2], bayer_pixel[bayer_line_step - 1], bayer_pixel[bayer_line_step + 1]);
-    rgb_buffer[rgb_line_step + 2] = bayer_pixel[bayer_line_step];
-
-    // Bayer         -1 0 1 2
-    //         0      r g r g
-    // line_step      g b G b
-    // line_step2     r g r g
-    rgb_buffer[rgb_line_step + 3] = AVG (bayer_pixel[1], bayer_pixel[bayer_line_step2 + 1]);
-    rgb_buffer[rgb_line_step + 4] = bayer_pixel[bayer_line_step + 1];
-    //rgb_pixel[rgb_line_step + 5] = AVG( bayer_pixel[line_step] , bayer_pixel[line_step+2] );
-  }
-
-  // last two pixel values for first two lines
-  // GRGR line
-  // Bayer        -1 0 1
-  //           0   r G r
-  //   line_step   g b g
-  // line_step2    r g r
-  rgb_buffer[0] = AVG (bayer_pixel[1], bayer_pixel[-1]);
-  rgb_buffer[1] = bayer_pixel[0];
-  rgb_buffer[rgb_line_step + 5] = rgb_buffer[rgb_line_step + 2] = rgb_buffer[5] = rgb_buffer[2] = bayer_pixel[bayer_line_step];
-
-  // Bayer        -1 0 1
-  //          0    r g R
-  //  line_step    g b g
-  // line_step2    r g r
-  rgb_buffer[3] = bayer_pixel[1];
-  rgb_buffer[4] = AVG (bayer_pixel[0], bayer_pixel[bayer_line_step + 1]);
-  //rgb_pixel[5] = bayer_pixel[line_step];
-
-  // BGBG line
-  // Bayer        -1 0 1
-  //          0    r g r
-  //  line_step    g B g
-  // line_step2    r g r
-  rgb_buffer[rgb_line_step ] = AVG4 (bayer_pixel[1], bayer_pixel[bayer_line_step2 + 1], bayer_pixel[-1], bayer_pixel[bayer_line_step2 - 1]);
-  rgb_buffer[rgb_line_step + 1] = AVG4 (bayer_pixel[0], bayer_pixel[bayer_line_step2], bayer_pixel[bayer_line_step - 1], bayer_pixel[bayer_line_step + 1]);
-  //rgb_pixel[rgb_line_step + 2] = bayer_pixel[line_step];
-
-  // Bayer         -1 0 1
-  //         0      r g r
-  // line_step      g b G
-  // line_step2     r g r
-  rgb_buffer[rgb_line_step + 3] = AVG (bayer_pixel[1], bayer_pixel[bayer_line_step2 + 1]);
-  rgb_buffer[rgb_line_step + 4] = bayer_pixel[bayer_line_step + 1];
-  //rgb_pixel[rgb_line_step + 5] = bayer_pixel[line_step];
-
-  bayer_pixel += bayer_line_step + 2;
-  rgb_buffer += rgb_line_step + 6 + rgb_line_skip;
-  // main processing
-  for (unsigned yIdx = 2; yIdx < height - 2; yIdx += 2)
-  {
-    // first two pixel values
-    // Bayer         0 1 2
-    //        -1     b g b
-    //         0     G r g
-    // line_step     b g b
-    // line_step2    g r g
-
-    rgb_buffer[3] = rgb_buffer[0] = bayer_pixel[1]; // red pixel
-    rgb_buffer[1] = bayer_pixel[0]; // green pixel
-    rgb_buffer[2] = AVG (bayer_pixel[bayer_line_step], bayer_pixel[-bayer_line_step]); // blue;
-
-    // Bayer         0 1 2
-    //        -1     b g b
-    //         0     g R g
-    // line_step     b g b
-    // line_step2    g r g
-    //rgb_pixel[3] = bayer_pixel[1];
-    rgb_buffer[4] = AVG4 (bayer_pixel[0], bayer_pixel[2], bayer_pixel[bayer_line_step + 1], bayer_pixel[1 - bayer_line_step]);
-    rgb_buffer[5] = AVG4 (bayer_pixel[bayer_line_step], bayer_pixel[bayer_line_step + 2], bayer_pixel[-bayer_line_step], bayer_pixel[2 - bayer_line_step]);
-
-    // BGBG line
-    // Bayer         0 1 2
-    //         0     g r g
-    // line_step     B g b
-    // line_step2    g r g
-    rgb_buffer[rgb_line_step + 3] = rgb_buffer[rgb_line_step ] = AVG (bayer_pixel[1], bayer_pixel[bayer_line_step2 + 1]);
-    rgb_buffer[rgb_line_step + 1] = AVG3 (bayer_pixel[0], bayer_pixel[bayer_line_step + 1], bayer_pixel[bayer_line_step2]);
-    rgb_buffer[rgb_line_step + 2] = bayer_pixel[bayer_line_step];
-
-    // pixel (1, 1)  0 1 2
-    //         0     g r g
-    // line_step     b G b
-    // line_step2    g r g
-    //rgb_pixel[rgb_line_step + 3] = AVG( bayer_pixel[1] , bayer_pixel[line_step2+1] );
-    rgb_buffer[rgb_line_step + 4] = bayer_pixel[bayer_line_step + 1];
-    rgb_buffer[rgb_line_step + 5] = AVG (bayer_pixel[bayer_line_step], bayer_pixel[bayer_line_step + 2]);
-
-    rgb_buffer += 6;
-    bayer_pixel += 2;
-    // continue with rest of the line
-    for (unsigned xIdx = 2; xIdx < width - 2; xIdx += 2, rgb_buffer += 6, bayer_pixel += 2)
-    {
-      // GRGR line
-      // Bayer        -1 0 1 2
-      //          -1   g b g b
-      //           0   r G r g
-      //   line_step   g b g b
-      // line_step2    r g r g
-      rgb_buffer[0] = AVG (bayer_pixel[1], bayer_pixel[-1]);
-      rgb_buffer[1] = bayer_pixel[0];
-      rgb_buffer[2] = AVG (bayer_pixel[bayer_line_step], bayer_pixel[-bayer_line_step]);
-
-      // Bayer        -1 0 1 2
-      //          -1   g b g b
-      //          0    r g R g
-      //  line_step    g b g b
-      // line_step2    r g r g
-
-      int dh = std::abs (bayer_pixel[0] - bayer_pixel[2]);
-      int dv = std::abs (bayer_pixel[-bayer_line_step + 1] - bayer_pixel[bayer_line_step + 1]);
-
-      if (dh > dv)
-        rgb_buffer[4] = AVG (bayer_pixel[-bayer_line_step + 1], bayer_pixel[bayer_line_step + 1]);
-      else if (dv > dh)
-        rgb_buffer[4] = AVG (bayer_pixel[0], bayer_pixel[2]);
-      else
-        rgb_buffer[4] = AVG4 (bayer_pixel[-bayer_line_step + 1], bayer_pixel[bayer_line_step + 1], bayer_pixel[0], bayer_pixel[2]);
-
-      rgb_buffer[3] = bayer_pixel[1];
-      rgb_buffer[5] = AVG4 (bayer_pixel[-bayer_line_step], bayer_pixel[2 - bayer_line_step], bayer_pixel[bayer_line_step], bayer_pixel[bayer_line_step + 2]);
-
-      // BGBG line
-      // Bayer         -1 0 1 2
-      //         -1     g b g b
-      //          0     r g r g
-      // line_step      g B g b
-      // line_step2     r g r g
-      rgb_buffer[rgb_line_step ] = AVG4 (bayer_pixel[1], bayer_pixel[bayer_line_step2 + 1], bayer_pixel[-1], bayer_pixel[bayer_line_step2 - 1]);
-      rgb_buffer[rgb_line_step + 2] = bayer_pixel[bayer_line_step];
-
-      dv = std::abs (bayer_pixel[0] - bayer_pixel[bayer_line_step2]);
-      dh = std::abs (bayer_pixel[bayer_line_step - 1] - bayer_pixel[bayer_line_step + 1]);
-
-      if (dv > dh)
-        rgb_buffer[rgb_line_step + 1] = AVG (bayer_pixel[bayer_line_step - 1], bayer_pixel[bayer_line_step + 1]);
-      else if (dh > dv)
-        rgb_buffer[rgb_line_step + 1] = AVG (bayer_pixel[0], bayer_pixel[bayer_line_step2]);
-      else
-        rgb_buffer[rgb_line_step + 1] = AVG4 (bayer_pixel[0], bayer_pixel[bayer_line_step2], bayer_pixel[bayer_line_step - 1], bayer_pixel[bayer_line_step + 1]);
+  rgb_buffer[4] = AVG3 (bayer_pixel[0], bayer_pixel[2], bayer_pixel[bayer_line_step + 1]);
+  rgb_buffer[rgb_line_step + 5] = rgb_buffer[5] = AVG (bayer_pixel[bayer_line_step], bayer_pixel[bayer_line_step + 2]);
 
-      // Bayer         -1 0 1 2
-      //         -1     g b g b
-      //          0     r g r g
-      // line_step      g b G b
-      // line_step2     r g r g
-      rgb_buffer[rgb_line_step + 3] = AVG (bayer_pixel[1], bayer_pixel[bayer_line_step2 + 1]);
-      rgb_buffer[rgb_line_step + 4] = bayer_pixel[bayer_line_step + 1];
-      rgb_buffer[rgb_line_step + 5] = AVG (bayer_pixel[bayer_line_step], bayer_pixel[bayer_line_step + 2]);
-    }
+  // BGBG line
+  // Bayer         0 1 2
+  //         0     g r g
+  // line_step     B g b
+  // line_step2    g r g
+  rgb_buffer[rgb_line_step + 3] = rgb_buffer[rgb_line_step ] = AVG (bayer_pixel[1], bayer_pixel[bayer_line_step2 + 1]);
+  rgb_buffer[rgb_line_step + 1] = AVG3 (bayer_pixel[0], bayer_pixel[bayer_line_step + 1], bayer_pixel[bayer_line_step2]);
+  //rgb_pixel[rgb_line_step + 2] = bayer_pixel[line_step];
 
-    // last two pixels of the line
-    // last two pixel values for first two lines
+  // pixel (1, 1)  0 1 2
+  //         0     g r g
+  // line_step     b G b
+  // line_step2    g r g
+  //rgb_pixel[rgb_line_step + 3] = AVG( bayer_pixel[1] , bayer_pixel[line_step2+1] );
+  rgb_buffer[rgb_line_step + 4] = bayer_pixel[bayer_line_step + 1];
+  //rgb_pixel[rgb_line_step + 5] = AVG( bayer_pixel[line_step] , bayer_pixel[line_step+2] );
+
+  rgb_buffer += 6;
+  bayer_pixel += 2;
+  // rest of the first two lines
+  for (unsigned xIdx = 2; xIdx < width - 2; xIdx += 2, rgb_buffer += 6, bayer_pixel += 2)
+  {
     // GRGR line
-    // Bayer        -1 0 1
-    //           0   r G r
-    //   line_step   g b g
-    // line_step2    r g r
+    // Bayer        -1 0 1 2
+    //           0   r G r g
+    //   line_step   g b g b
+    // line_step2    r g r g
     rgb_buffer[0] = AVG (bayer_pixel[1], bayer_pixel[-1]);
     rgb_buffer[1] = bayer_pixel[0];
-    rgb_buffer[rgb_line_step + 5] = rgb_buffer[rgb_line_step + 2] = rgb_buffer[5] = rgb_buffer[2] = bayer_pixel[bayer_line_step];
+    rgb_buffer[2] = bayer_pixel[bayer_line_step + 1];
 
-    // Bayer        -1 0 1
-    //          0    r g R
-    //  line_step    g b g
-    // line_step2    r g r
+    // Bayer        -1 0 1 2
+    //          0    r g R g
+    //  line_step    g b g b
+    // line_step2    r g r g
     rgb_buffer[3] = bayer_pixel[1];
-    rgb_buffer[4] = AVG (bayer_pixel[0], bayer_pixel[bayer_line_step + 1]);
-    //rgb_pixel[5] = bayer_pixel[line_step];
+    rgb_buffer[4] = AVG3 (bayer_pixel[0], bayer_pixel[2], bayer_pixel[bayer_line_step + 1]);
+    rgb_buffer[rgb_line_step + 5] = rgb_buffer[5] = AVG (bayer_pixel[bayer_line_step], bayer_pixel[bayer_line_step + 2]);
 
     // BGBG line
-    // Bayer        -1 0 1
-    //          0    r g r
-    //  line_step    g B g
-    // line_step2    r g r
+    // Bayer         -1 0 1 2
+    //         0      r g r g
+    // line_step      g B g b
+    // line_step2     r g r g
     rgb_buffer[rgb_line_step ] = AVG4 (bayer_pixel[1], bayer_pixel[bayer_line_step2 + 1], bayer_pixel[-1], bayer_pixel[bayer_line_step2 - 1]);
     rgb_buffer[rgb_line_step + 1] = AVG4 (bayer_pixel[0], bayer_pixel[bayer_line_step2], bayer_pixel[bayer_line_step - 1], bayer_pixel[bayer_line_step + 1]);
-    //rgb_pixel[rgb_line_step + 2] = bayer_pixel[line_step];
+    rgb_buffer[rgb_line_step + 2] = bayer_pixel[bayer_line_step];
 
-    // Bayer         -1 0 1
-    //         0      r g r
-    // line_step      g b G
-    // line_step2     r g r
+    // Bayer         -1 0 1 2
+    //         0      r g r g
+    // line_step      g b G b
+    // line_step2     r g r g
     rgb_buffer[rgb_line_step + 3] = AVG (bayer_pixel[1], bayer_pixel[bayer_line_step2 + 1]);
     rgb_buffer[rgb_line_step + 4] = bayer_pixel[bayer_line_step + 1];
-    //rgb_pixel[rgb_line_step + 5] = bayer_pixel[line_step];
-
-    bayer_pixel += bayer_line_step + 2;
-    rgb_buffer += rgb_line_step + 6 + rgb_line_skip;
+    //rgb_pixel[rgb_line_step + 5] = AVG( bayer_pixel[line_step] , bayer_pixel[line_step+2] );
   }
 
+  // last two pixel values for first two lines
+  // GRGR line
+  // Bayer        -1 0 1
+  //           0   r G r
+  //   line_step   g b g
+  // line_step2    r g r
+  rgb_buffer[0] = AVG (bayer_pixel[1], bayer_pixel[-1]);
+  rgb_buffer[1] = bayer_pixel[0];
+  rgb_buffer[rgb_line_step + 5] = rgb_buffer[rgb_line_step + 2] = rgb_buffer[5] = rgb_buffer[2] = bayer_pixel[bayer_line_step];
+
+  // Bayer        -1 0 1
+  //          0    r g R
+  //  line_step    g b g
+  // line_step2    r g r
+  rgb_buffer[3] = bayer_pixel[1];
+  rgb_buffer[4] = AVG (bayer_pixel[0], bayer_pixel[bayer_line_step + 1]);
+  //rgb_pixel[5] = bayer_pixel[line_step];
+
+  // BGBG line
+  // Bayer        -1 0 1
+  //          0    r g r
+  //  line_step    g B g
+  // line_step2    r g r
+  rgb_buffer[rgb_line_step ] = AVG4 (bayer_pixel[1], bayer_pixel[bayer_line_step2 + 1], bayer_pixel[-1], bayer_pixel[bayer_line_step2 - 1]);
+  rgb_buffer[rgb_line_step + 1] = AVG4 (bayer_pixel[0], bayer_pixel[bayer_line_step2], bayer_pixel[bayer_line_step - 1], bayer_pixel[bayer_line_step + 1]);
+  //rgb_pixel[rgb_line_step + 2] = bayer_pixel[line_step];
+
+  // Bayer         -1 0 1
+  //         0      r g r
+  // line_step      g b G
+  // line_step2     r g r
+  rgb_buffer[rgb_line_step + 3] = AVG (bayer_pixel[1], bayer_pixel[bayer_line_step2 + 1]);
+  rgb_buffer[rgb_line_step + 4] = bayer_pixel[bayer_line_step + 1];
+  //rgb_pixel[rgb_line_step + 5] = bayer_pixel[line_step];
+
+  bayer_pixel += bayer_line_step + 2;
+  rgb_buffer += rgb_line_step + 6 + rgb_line_skip;
+  // main processing
+  // main processing, the pairs of lines are independent
+  const std::ptrdiff_t nr_line_pairs = (height >= 4 ? (height - 3) / 2 : 0);
+  const std::ptrdiff_t bayer_pair_step = width + bayer_line_step;
+  const std::ptrdiff_t rgb_pair_step = 2 * static_cast<std::ptrdiff_t> (rgb_line_step);
+  const pcl::ThreadReservation reservation (threads_);
+  const unsigned int threads = static_cast<unsigned int> (std::max<std::ptrdiff_t> (1, std::min<std::ptrdiff_t> (reservation.getNumberOfThreads (), nr_line_pairs)));
+#pragma omp parallel for \
+  default(none) \
+  shared(bayer_pixel, rgb_buffer, width, bayer_line_step, bayer_line_step2, rgb_line_step) \
+  firstprivate(nr_line_pairs, bayer_pair_step, rgb_pair_step) \
+  num_threads(threads)
+  for (std::ptrdiff_t line_pair = 0; line_pair < nr_line_pairs; ++line_pair)
+    edgeAwareLinePair (bayer_pixel + line_pair * bayer_pair_step, rgb_buffer + line_pair * rgb_pair_step,
+                       width, bayer_line_step, bayer_line_step2, rgb_line_step);
+  bayer_pixel += nr_line_pairs * bayer_pair_step;
+  rgb_buffer += nr_line_pairs * rgb_pair_step;
+
   //last two lines
   // Bayer         0 1 2
   //        -1     b g b
@@ -929,142 +1446,22 @@ pcl::io::DeBayer::debayerEdgeAwareWeighted (
   bayer_pixel += bayer_line_step + 2;
   rgb_buffer += rgb_line_step + 6 + rgb_line_skip;
   // main processing
-  for (unsigned yIdx = 2; yIdx < height - 2; yIdx += 2)
-  {
-    // first two pixel values
-    // Bayer         0 1 2
-    //        -1     b g b
-    //         0     G r g
-    // line_step     b g b
-    // line_step2    g r g
-
-    rgb_buffer[3] = rgb_buffer[0] = bayer_pixel[1]; // red pixel
-    rgb_buffer[1] = bayer_pixel[0]; // green pixel
-    rgb_buffer[2] = AVG (bayer_pixel[bayer_line_step], bayer_pixel[-bayer_line_step]); // blue;
-
-    // Bayer         0 1 2
-    //        -1     b g b
-    //         0     g R g
-    // line_step     b g b
-    // line_step2    g r g
-    //rgb_pixel[3] = bayer_pixel[1];
-    rgb_buffer[4] = AVG4 (bayer_pixel[0], bayer_pixel[2], bayer_pixel[bayer_line_step + 1], bayer_pixel[1 - bayer_line_step]);
-    rgb_buffer[5] = AVG4 (bayer_pixel[bayer_line_step], bayer_pixel[bayer_line_step + 2], bayer_pixel[-bayer_line_step], bayer_pixel[2 - bayer_line_step]);
-
-    // BGBG line
-    // Bayer         0 1 2
-    //         0     g r g
-    // line_step     B g b
-    // line_step2    g r g
-    rgb_buffer[rgb_line_step + 3] = rgb_buffer[rgb_line_step ] = AVG (bayer_pixel[1], bayer_pixel[bayer_line_step2 + 1]);
-    rgb_buffer[rgb_line_step + 1] = AVG3 (bayer_pixel[0], bayer_pixel[bayer_line_step + 1], bayer_pixel[bayer_line_step2]);
-    rgb_buffer[rgb_line_step + 2] = bayer_pixel[bayer_line_step];
-
-    // pixel (1, 1)  0 1 2
-    //         0     g r g
-    // line_step     b G b
-    // line_step2    g r g
-    //rgb_pixel[rgb_line_step + 3] = AVG( bayer_pixel[1] , bayer_pixel[line_step2+1] );
-    rgb_buffer[rgb_line_step + 4] = bayer_pixel[bayer_line_step + 1];
-    rgb_buffer[rgb_line_step + 5] = AVG (bayer_pixel[bayer_line_step], bayer_pixel[bayer_line_step + 2]);
-
-    rgb_buffer += 6;
-    bayer_pixel += 2;
-    // continue with rest of the line
-    for (unsigned xIdx = 2; xIdx < width - 2; xIdx += 2, rgb_buffer += 6, bayer_pixel += 2)
-    {
-      // GRGR line
-      // Bayer        -1 0 1 2
-      //          -1   g b g b
-      //           0   r G r g
-      //   line_step   g b g b
-      // line_step2    r g r g
-      rgb_buffer[0] = AVG (bayer_pixel[1], bayer_pixel[-1]);
-      rgb_buffer[1] = bayer_pixel[0];
-      rgb_buffer[2] = AVG (bayer_pixel[bayer_line_step], bayer_pixel[-bayer_line_step]);
-
-      // Bayer        -1 0 1 2
-      //          -1   g b g b
-      //          0    r g R g
-      //  line_step    g b g b
-      // line_step2    r g r g
-
-      int dh = std::abs (bayer_pixel[0] - bayer_pixel[2]);
-      int dv = std::abs (bayer_pixel[-bayer_line_step + 1] - bayer_pixel[bayer_line_step + 1]);
-
-      if (dv == 0 && dh == 0)
-        rgb_buffer[4] = AVG4 (bayer_pixel[1 - bayer_line_step], bayer_pixel[1 + bayer_line_step], bayer_pixel[0], bayer_pixel[2]);
-      else
-        rgb_buffer[4] = WAVG4 (bayer_pixel[1 - bayer_line_step], bayer_pixel[1 + bayer_line_step], bayer_pixel[0], bayer_pixel[2], dh, dv);
-      rgb_buffer[3] = bayer_pixel[1];
-      rgb_buffer[5] = AVG4 (bayer_pixel[-bayer_line_step], bayer_pixel[2 - bayer_line_step], bayer_pixel[bayer_line_step], bayer_pixel[bayer_line_step + 2]);
-
-      // BGBG line
-      // Bayer         -1 0 1 2
-      //         -1     g b g b
-      //          0     r g r g
-      // line_step      g B g b
-      // line_step2     r g r g
-      rgb_buffer[rgb_line_step ] = AVG4 (bayer_pixel[1], bayer_pixel[bayer_line_step2 + 1], bayer_pixel[-1], bayer_pixel[bayer_line_step2 - 1]);
-      rgb_buffer[rgb_line_step + 2] = bayer_pixel[bayer_line_step];
-
-      dv = std::abs (bayer_pixel[0] - bayer_pixel[bayer_line_step2]);
-      dh = std::abs (bayer_pixel[bayer_line_step - 1] - bayer_pixel[bayer_line_step + 1]);
-
-      if (dv == 0 && dh == 0)
-        rgb_buffer[rgb_line_step + 1] = AVG4 (bayer_pixel[0], bayer_pixel[bayer_line_step2], bayer_pixel[bayer_line_step - 1], bayer_pixel[bayer_line_step + 1]);
-      else
-        rgb_buffer[rgb_line_step + 1] = WAVG4 (bayer_pixel[0], bayer_pixel[bayer_line_step2], bayer_pixel[bayer_line_step - 1], bayer_pixel[bayer_line_step + 1], dh, dv);
-
-      // Bayer         -1 0 1 2
-      //         -1     g b g b
-      //          0     r g r g
-      // line_step      g b G b
-      // line_step2     r g r g
-      rgb_buffer[rgb_line_step + 3] = AVG (bayer_pixel[1], bayer_pixel[bayer_line_step2 + 1]);
-      rgb_buffer[rgb_line_step + 4] = bayer_pixel[bayer_line_step + 1];
-      rgb_buffer[rgb_line_step + 5] = AVG (bayer_pixel[bayer_line_step], bayer_pixel[bayer_line_step + 2]);
-    }
-
-    // last two pixels of the line
-    // last two pixel values for first two lines
-    // GRGR line
-    // Bayer        -1 0 1
-    //           0   r G r
-    //   line_step   g b g
-    // line_step2    r g r
-    rgb_buffer[0] = AVG (bayer_pixel[1], bayer_pixel[-1]);
-    rgb_buffer[1] = bayer_pixel[0];
-    rgb_buffer[rgb_line_step + 5] = rgb_buffer[rgb_line_step + 2] = rgb_buffer[5] = rgb_buffer[2] = bayer_pixel[bayer_line_step];
-
-    // Bayer        -1 0 1
-    //          0    r g R
-    //  line_step    g b g
-    // line_step2    r g r
-    rgb_buffer[3] = bayer_pixel[1];
-    rgb_buffer[4] = AVG (bayer_pixel[0], bayer_pixel[bayer_line_step + 1]);
-    //rgb_pixel[5] = bayer_pixel[line_step];
-
-    // BGBG line
-    // Bayer        -1 0 1
-    //          0    r g r
-    //  line_step    g B g
-    // line_step2    r g r
-    rgb_buffer[rgb_line_step ] = AVG4 (bayer_pixel[1], bayer_pixel[bayer_line_step2 + 1], bayer_pixel[-1], bayer_pixel[bayer_line_step2 - 1]);
-    rgb_buffer[rgb_line_step + 1] = AVG4 (bayer_pixel[0], bayer_pixel[bayer_line_step2], bayer_pixel[bayer_line_step - 1], bayer_pixel[bayer_line_step + 1]);
-    //rgb_pixel[rgb_line_step + 2] = bayer_pixel[line_step];
-
-    // Bayer         -1 0 1
-    //         0      r g r
-    // line_step      g b G
-    // line_step2     r g r
-    rgb_buffer[rgb_line_step + 3] = AVG (bayer_pixel[1], bayer_pixel[bayer_line_step2 + 1]);
-    rgb_buffer[rgb_line_step + 4] = bayer_pixel[bayer_line_step + 1];
-    //rgb_pixel[rgb_line_step + 5] = bayer_pixel[line_step];
-
-    bayer_pixel += bayer_line_step + 2;
-    rgb_buffer += rgb_line_step + 6 + rgb_line_skip;
-  }
+  // main processing, the pairs of lines are independent
+  const std::ptrdiff_t nr_line_pairs = (height >= 4 ? (height - 3) / 2 : 0);
+  const std::ptrdiff_t bayer_pair_step = width + bayer_line_step;
+  const std::ptrdiff_t rgb_pair_step = 2 * static_cast<std::ptrdiff_t> (rgb_line_step);
+  const pcl::ThreadReservation reservation (threads_);
+  const unsigned int threads = static_cast<unsigned int> (std::max<std::ptrdiff_t> (1, std::min<std::ptrdiff_t> (reservation.getNumberOfThreads (), nr_line_pairs)));
+#pragma omp parallel for \
+  default(none) \
+  shared(bayer_pixel, rgb_buffer, width, bayer_line_step, bayer_line_step2, rgb_line_step) \
+  firstprivate(nr_line_pairs, bayer_pair_step, rgb_pair_step) \
+  num_threads(threads)
+  for (std::ptrdiff_t line_pair = 0; line_pair < nr_line_pairs; ++line_pair)
+    edgeAwareWeightedLinePair (bayer_pixel + line_pair * bayer_pair_step, rgb_buffer + line_pair * rgb_pair_step,
+                               width, bayer_line_step, bayer_line_step2, rgb_line_step);
+  bayer_pixel += nr_line_pairs * bayer_pair_step;
+  rgb_buffer += nr_line_pairs * rgb_pair_step;
 
   //last two lines
   // Bayer         0 1 2
@@ -1178,3 +1575,27 @@ pcl::io::DeBayer::debayerEdgeAwareWeighted (
   //rgb_pixel[rgb_line_step + 5] = bayer_pixel[line_step];
 }
 
+//////////////////////////////////////////////////////////////////////////////
+void
+pcl::io::convertYUV422ToRGB (
+    const unsigned char *yuv_buffer, unsigned char *rgb_buffer,
+    unsigned width, unsigned height,
+    unsigned rgb_line_step,
+    unsigned int nr_threads)
+{
+  if (rgb_line_step == 0)
+    rgb_line_step = width * 3;
+
+  const YUV422Kernel kernel = selectYUV422Kernel ();
+  const std::ptrdiff_t nr_lines = height;
+  const std::ptrdiff_t yuv_line_step = 2 * static_cast<std::ptrdiff_t> (width);
+  const pcl::ThreadReservation reservation (nr_threads);
+  const unsigned int threads = static_cast<unsigned int> (std::max<std::ptrdiff_t> (1, std::min<std::ptrdiff_t> (reservation.getNumberOfThreads (), nr_lines)));
+#pragma omp parallel for \
+  default(none) \
+  shared(yuv_buffer, rgb_buffer, width, rgb_line_step, kernel) \
+  firstprivate(nr_lines, yuv_line_step) \
+  num_threads(threads)
+  for (std::ptrdiff_t line = 0; line < nr_lines; ++line)
+    yuv422Line (yuv_buffer + line * yuv_line_step, rgb_buffer + line * rgb_line_step, width, kernel);
+}
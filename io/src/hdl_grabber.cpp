@@ -40,12 +40,14 @@
 
 #include <pcl/console/print.h>
 #include <pcl/io/hdl_grabber.h>
+#include <pcl/io/udp_batch_receiver.h>
 #include <boost/version.hpp>
 #include <boost/foreach.hpp>
 #include <boost/property_tree/ptree.hpp>
 #include <boost/property_tree/xml_parser.hpp>
 #include <boost/array.hpp>
 #include <boost/math/special_functions.hpp>
+#include <chrono>
 #ifdef HAVE_PCAP
 #include <pcap.h>
 #endif // #ifdef HAVE_PCAP
@@ -59,6 +61,7 @@ using boost::asio::ip::udp;
 pcl::HDLGrabber::HDLGrabber (const std::string& correctionsFile,
                              const std::string& pcapFile) :
     last_azimuth_ (65000),
+    packet_timestamp_ (0),
     current_scan_xyz_ (new pcl::PointCloud<pcl::PointXYZ> ()),
     current_sweep_xyz_ (new pcl::PointCloud<pcl::PointXYZ> ()),
     current_scan_xyzi_ (new pcl::PointCloud<pcl::PointXYZI> ()),
@@ -71,6 +74,8 @@ pcl::HDLGrabber::HDLGrabber (const std::string& correctionsFile,
     scan_xyz_signal_ (),
     scan_xyzrgba_signal_ (),
     scan_xyzi_signal_ (),
+    hdl_data_ (HDL_PACKET_RING_SIZE),
+    dropped_packets_ (0),
     source_address_filter_ (),
     source_port_filter_ (443),
     hdl_read_socket_service_ (),
@@ -78,6 +83,7 @@ pcl::HDLGrabber::HDLGrabber (const std::string& correctionsFile,
     pcap_file_name_ (pcapFile),
     queue_consumer_thread_ (nullptr),
     hdl_read_packet_thread_ (nullptr),
+    terminate_read_packet_thread_ (false),
     min_distance_threshold_ (0.0),
     max_distance_threshold_ (10000.0)
 {
@@ -89,6 +95,7 @@ pcl::HDLGrabber::HDLGrabber (const boost::asio::ip::address& ipAddress,
                              const std::uint16_t port,
                              const std::string& correctionsFile) :
     last_azimuth_ (65000),
+    packet_timestamp_ (0),
     current_scan_xyz_ (new pcl::PointCloud<pcl::PointXYZ> ()),
     current_sweep_xyz_ (new pcl::PointCloud<pcl::PointXYZ> ()),
     current_scan_xyzi_ (new pcl::PointCloud<pcl::PointXYZI> ()),
@@ -101,6 +108,8 @@ pcl::HDLGrabber::HDLGrabber (const boost::asio::ip::address& ipAddress,
     scan_xyz_signal_ (),
     scan_xyzrgba_signal_ (),
     scan_xyzi_signal_ (),
+    hdl_data_ (HDL_PACKET_RING_SIZE),
+    dropped_packets_ (0),
     udp_listener_endpoint_ (ipAddress, port),
     source_address_filter_ (),
     source_port_filter_ (443),
@@ -108,6 +117,7 @@ pcl::HDLGrabber::HDLGrabber (const boost::asio::ip::address& ipAddress,
     hdl_read_socket_ (nullptr),
     queue_consumer_thread_ (nullptr),
     hdl_read_packet_thread_ (nullptr),
+    terminate_read_packet_thread_ (false),
     min_distance_threshold_ (0.0),
     max_distance_threshold_ (10000.0)
 {
@@ -150,6 +160,8 @@ pcl::HDLGrabber::initialize (const std::string& correctionsFile)
     HDLLaserCorrection correction = laser_correction;
     laser_correction.sinVertOffsetCorrection = correction.verticalOffsetCorrection * correction.sinVertCorrection;
     laser_correction.cosVertOffsetCorrection = correction.verticalOffsetCorrection * correction.cosVertCorrection;
+    laser_correction.sinAzimuthCorrection = std::sin (HDL_Grabber_toRadians(correction.azimuthCorrection));
+    laser_correction.cosAzimuthCorrection = std::cos (HDL_Grabber_toRadians(correction.azimuthCorrection));
   }
   sweep_xyz_signal_ = createSignal<sig_cb_velodyne_hdl_sweep_point_cloud_xyz> ();
   sweep_xyzrgba_signal_ = createSignal<sig_cb_velodyne_hdl_sweep_point_cloud_xyzrgba> ();
@@ -294,15 +306,19 @@ pcl::HDLGrabber::getDefaultNetworkAddress ()
 void
 pcl::HDLGrabber::processVelodynePackets ()
 {
-  while (true)
+  while (!terminate_read_packet_thread_)
   {
-    std::uint8_t *data;
-    if (!hdl_data_.dequeue (data))
-      return;
+    HDLPacketSlot *slot = hdl_data_.beginPop ();
+    if (slot == nullptr)
+    {
+      std::this_thread::sleep_for (std::chrono::microseconds (100));
+      continue;
+    }
 
-    toPointClouds (reinterpret_cast<HDLDataPacket *> (data));
+    packet_timestamp_ = slot->timestamp;
+    toPointClouds (&slot->packet);
 
-    free (data);
+    hdl_data_.endPop ();
   }
 }
 
@@ -315,12 +331,16 @@ pcl::HDLGrabber::toPointClouds (HDLDataPacket *dataPacket)
   if (sizeof(HDLLaserReturn) != 3)
     return;
 
-  current_scan_xyz_.reset (new pcl::PointCloud<pcl::PointXYZ> ());
-  current_scan_xyzrgba_.reset (new pcl::PointCloud<pcl::PointXYZRGBA> ());
-  current_scan_xyzi_.reset (new pcl::PointCloud<pcl::PointXYZI> ());
+  current_scan_xyz_ = recycleCloud (xyz_cloud_pool_);
+  current_scan_xyzrgba_ = recycleCloud (xyzrgba_cloud_pool_);
+  current_scan_xyzi_ = recycleCloud (xyzi_cloud_pool_);
 
-  time_t system_time;
-  time (&system_time);
+  // scans are only collected when someone listens to them
+  const bool collect_scan = scan_xyz_signal_->num_slots () > 0 || scan_xyzrgba_signal_->num_slots () > 0 ||
+                            scan_xyzi_signal_->num_slots () > 0;
+
+  // prefer the receive time of the packet over the time it gets decoded
+  const time_t system_time = (packet_timestamp_ != 0) ? static_cast<time_t> (packet_timestamp_ / 1000000) : time (nullptr);
   time_t velodyne_time = (system_time & 0x00000000ffffffffl) << 32 | dataPacket->gpsTimestamp;
 
   current_scan_xyz_->header.stamp = velodyne_time;
@@ -353,9 +373,9 @@ pcl::HDLGrabber::toPointClouds (HDLDataPacket *dataPacket)
 
           fireCurrentSweep ();
         }
-        current_sweep_xyz_.reset (new pcl::PointCloud<pcl::PointXYZ> ());
-        current_sweep_xyzrgba_.reset (new pcl::PointCloud<pcl::PointXYZRGBA> ());
-        current_sweep_xyzi_.reset (new pcl::PointCloud<pcl::PointXYZI> ());
+        current_sweep_xyz_ = recycleCloud (xyz_cloud_pool_);
+        current_sweep_xyzrgba_ = recycleCloud (xyzrgba_cloud_pool_);
+        current_sweep_xyzi_ = recycleCloud (xyzi_cloud_pool_);
       }
 
       PointXYZ xyz;
@@ -374,9 +394,12 @@ pcl::HDLGrabber::toPointClouds (HDLDataPacket *dataPacket)
         continue;
       }
 
-      current_scan_xyz_->push_back (xyz);
-      current_scan_xyzi_->push_back (xyzi);
-      current_scan_xyzrgba_->push_back (xyzrgba);
+      if (collect_scan)
+      {
+        current_scan_xyz_->push_back (xyz);
+        current_scan_xyzi_->push_back (xyzi);
+        current_scan_xyzrgba_->push_back (xyzrgba);
+      }
 
       current_sweep_xyz_->push_back (xyz);
       current_sweep_xyzi_->push_back (xyzi);
@@ -395,29 +418,28 @@ void
 pcl::HDLGrabber::computeXYZI (pcl::PointXYZI& point,
                               std::uint16_t azimuth,
                               HDLLaserReturn laserReturn,
-                              HDLLaserCorrection correction) const
+                              const HDLLaserCorrection& correction) const
 {
   double cos_azimuth, sin_azimuth;
 
   double distanceM = laserReturn.distance * 0.002;
 
   point.intensity = static_cast<float> (laserReturn.intensity);
-  if (distanceM < min_distance_threshold_ || distanceM > max_distance_threshold_)
+  if (distanceM < min_distance_threshold_ || distanceM > max_distance_threshold_ || azimuth >= HDL_NUM_ROT_ANGLES)
   {
     point.x = point.y = point.z = std::numeric_limits<float>::quiet_NaN ();
     return;
   }
 
-  if (correction.azimuthCorrection == 0)
+  cos_azimuth = cos_lookup_table_[azimuth];
+  sin_azimuth = sin_lookup_table_[azimuth];
+  if (correction.azimuthCorrection != 0)
   {
-    cos_azimuth = cos_lookup_table_[azimuth];
-    sin_azimuth = sin_lookup_table_[azimuth];
-  }
-  else
-  {
-    double azimuthInRadians = HDL_Grabber_toRadians( (static_cast<double> (azimuth) / 100.0) - correction.azimuthCorrection);
-    cos_azimuth = std::cos (azimuthInRadians);
-    sin_azimuth = std::sin (azimuthInRadians);
+    // rotate by the per laser correction: cos/sin (azimuth - correction)
+    const double cos_corrected = cos_azimuth * correction.cosAzimuthCorrection + sin_azimuth * correction.sinAzimuthCorrection;
+    const double sin_corrected = sin_azimuth * correction.cosAzimuthCorrection - cos_azimuth * correction.sinAzimuthCorrection;
+    cos_azimuth = cos_corrected;
+    sin_azimuth = sin_corrected;
   }
 
   distanceM += correction.distanceCorrection;
@@ -468,15 +490,29 @@ pcl::HDLGrabber::fireCurrentScan (const std::uint16_t startAngle,
 /////////////////////////////////////////////////////////////////////////////
 void
 pcl::HDLGrabber::enqueueHDLPacket (const std::uint8_t *data,
-                                   std::size_t bytesReceived)
+                                   std::size_t bytesReceived,
+                                   std::uint64_t timestamp)
 {
-  if (bytesReceived == 1206)
-  {
-    std::uint8_t *dup = static_cast<std::uint8_t *> (malloc (bytesReceived * sizeof(std::uint8_t)));
-    memcpy (dup, data, bytesReceived * sizeof (std::uint8_t));
+  if (bytesReceived != HDL_PACKET_SIZE)
+    return;
+
+  HDLPacketSlot *slot = hdl_data_.beginPush ();
 
-    hdl_data_.enqueue (dup);
+  // packets replayed from a file wait for the decoder, live packets are dropped when it falls behind
+  while (slot == nullptr && !pcap_file_name_.empty () && !terminate_read_packet_thread_)
+  {
+    std::this_thread::sleep_for (std::chrono::microseconds (100));
+    slot = hdl_data_.beginPush ();
+  }
+  if (slot == nullptr)
+  {
+    ++dropped_packets_;
+    return;
   }
+
+  memcpy (&slot->packet, data, HDL_PACKET_SIZE);
+  slot->timestamp = timestamp;
+  hdl_data_.endPush ();
 }
 
 /////////////////////////////////////////////////////////////////////////////
@@ -534,7 +570,6 @@ pcl::HDLGrabber::stop ()
 {
   // triggers the exit condition
   terminate_read_packet_thread_ = true;
-  hdl_data_.stopQueue ();
 
   if (hdl_read_packet_thread_ != nullptr)
   {
@@ -560,6 +595,13 @@ pcl::HDLGrabber::isRunning () const
   return (!hdl_data_.isEmpty () || hdl_read_packet_thread_);
 }
 
+/////////////////////////////////////////////////////////////////////////////
+std::uint64_t
+pcl::HDLGrabber::getNumberOfDroppedPackets () const
+{
+  return (dropped_packets_);
+}
+
 /////////////////////////////////////////////////////////////////////////////
 std::string
 pcl::HDLGrabber::getName () const
@@ -640,17 +682,18 @@ pcl::HDLGrabber::getMaximumNumberOfLasers () const
 void
 pcl::HDLGrabber::readPacketsFromSocket ()
 {
-  std::uint8_t data[1500];
-  udp::endpoint sender_endpoint;
+  // receives up to 64 packets per system call on Linux
+  pcl::UDPBatchReceiver receiver (*hdl_read_socket_, 64, 1500);
 
   while (!terminate_read_packet_thread_ && hdl_read_socket_->is_open ())
   {
-    std::size_t length = hdl_read_socket_->receive_from (boost::asio::buffer (data, 1500), sender_endpoint);
-
-    if (isAddressUnspecified (source_address_filter_)
-        || (source_address_filter_ == sender_endpoint.address () && source_port_filter_ == sender_endpoint.port ()))
+    for (const auto &packet : receiver.receive ())
     {
-      enqueueHDLPacket (data, length);
+      if (isAddressUnspecified (source_address_filter_)
+          || (source_address_filter_ == packet.sender.address () && source_port_filter_ == packet.sender.port ()))
+      {
+        enqueueHDLPacket (packet.data, packet.size, packet.timestamp);
+      }
     }
   }
 }
@@ -712,7 +755,8 @@ pcl::HDLGrabber::readPacketsFromPcap ()
     lasttime.tv_usec = header->ts.tv_usec;
 
     // The ETHERNET header is 42 bytes long; unnecessary
-    enqueueHDLPacket (data + 42, header->len - 42);
+    enqueueHDLPacket (data + 42, header->len - 42,
+                      static_cast<std::uint64_t> (header->ts.tv_sec) * 1000000 + header->ts.tv_usec);
 
     returnValue = pcap_next_ex (pcap, &header, &data);
   }
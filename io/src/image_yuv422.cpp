@@ -36,6 +36,7 @@
  */
 #include <pcl/pcl_config.h>
 #include <pcl/io/image_yuv422.h>
+#include <pcl/io/debayer.h>
 
 #include <pcl/io/io_exception.h>
 
@@ -91,22 +92,7 @@ pcl::io::ImageYUV422::fillRGB (unsigned width, unsigned height, unsigned char* r
 
   if (wrapper_->getWidth () == width && wrapper_->getHeight () == height)
   {
-    for (unsigned yIdx = 0; yIdx < height; ++yIdx, rgb_buffer += rgb_line_skip)
-    {
-      for (unsigned xIdx = 0; xIdx < width; xIdx += 2, rgb_buffer += 6, yuv_buffer += 4)
-      {
-        int v = yuv_buffer[2] - 128;
-        int u = yuv_buffer[0] - 128;
-
-        rgb_buffer[0] =  CLIP_CHAR (yuv_buffer[1] + ((v * 18678 + 8192 ) >> 14));
-        rgb_buffer[1] =  CLIP_CHAR (yuv_buffer[1] + ((v * -9519 - u * 6472 + 8192 ) >> 14));
-        rgb_buffer[2] =  CLIP_CHAR (yuv_buffer[1] + ((u * 33292 + 8192 ) >> 14));
-
-        rgb_buffer[3] =  CLIP_CHAR (yuv_buffer[3] + ((v * 18678 + 8192 ) >> 14));
-        rgb_buffer[4] =  CLIP_CHAR (yuv_buffer[3] + ((v * -9519 - u * 6472 + 8192 ) >> 14));
-        rgb_buffer[5] =  CLIP_CHAR (yuv_buffer[3] + ((u * 33292 + 8192 ) >> 14));
-      }
-    }
+    pcl::io::convertYUV422ToRGB (yuv_buffer, rgb_buffer, width, height, rgb_line_step);
   }
   else
   {
@@ -36,13 +36,235 @@
  *
  */
 #include <pcl/io/obj_io.h>
+#include <pcl/io/low_level_io.h>
+#include <pcl/io/number_parser.h>
 #include <fstream>
+#include <pcl/common/execution_context.h>
 #include <pcl/common/io.h>
 #include <pcl/console/time.h>
 #include <boost/lexical_cast.hpp> // for lexical_cast
 #include <boost/filesystem.hpp> // for exists
 #include <boost/algorithm/string.hpp> // for split
 
+#include <algorithm>
+#include <cstring>
+#include <fcntl.h>
+
+namespace
+{
+  /** Read only memory mapping of a file. */
+  class MappedOBJFile
+  {
+    public:
+      MappedOBJFile (const MappedOBJFile&) = delete;
+      MappedOBJFile&
+      operator= (const MappedOBJFile&) = delete;
+
+      explicit MappedOBJFile (const std::string &file_name)
+      {
+        const int fd = pcl::io::raw_open (file_name.c_str (), O_RDONLY);
+        if (fd == -1)
+          return;
+        const auto file_size = pcl::io::raw_lseek (fd, 0, SEEK_END);
+        if (file_size <= 0)
+        {
+          pcl::io::raw_close (fd);
+          valid_ = (file_size == 0);
+          return;
+        }
+#ifdef _WIN32
+        HANDLE fm = CreateFileMapping ((HANDLE) _get_osfhandle (fd), NULL, PAGE_READONLY, 0, 0, NULL);
+        pcl::io::raw_close (fd);
+        if (fm == NULL)
+          return;
+        void *map = MapViewOfFile (fm, FILE_MAP_READ, 0, 0, 0);
+        CloseHandle (fm);
+        if (map == nullptr)
+          return;
+#else
+        void *map = ::mmap (nullptr, file_size, PROT_READ, MAP_SHARED, fd, 0);
+        pcl::io::raw_close (fd);
+        if (map == MAP_FAILED)
+          return;
+#endif
+        data_ = static_cast<const char*> (map);
+        size_ = static_cast<std::size_t> (file_size);
+        valid_ = true;
+      }
+
+      ~MappedOBJFile ()
+      {
+        if (!data_)
+          return;
+#ifdef _WIN32
+        UnmapViewOfFile (data_);
+#else
+        ::munmap (const_cast<char*> (data_), size_);
+#endif
+      }
+
+      bool
+      isValid () const { return (valid_); }
+
+      const char*
+      data () const { return (data_); }
+
+      std::size_t
+      size () const { return (size_); }
+
+    private:
+      const char *data_ = nullptr;
+      std::size_t size_ = 0;
+      bool valid_ = false;
+  };
+
+  /** Vertices, vertex normals and polygons of a chunk of lines of an OBJ file. */
+  struct OBJChunk
+  {
+    /** x, y, z of the vertices and of the vertex normals. */
+    std::vector<float> vertices, normals;
+    /** Vertex indices of the polygons. Relative indices are relative to the first vertex of the chunk. */
+    std::vector<std::int64_t> indices;
+    /** Number of vertices of every polygon. */
+    std::vector<std::uint32_t> sizes;
+    /** Positions in indices of the relative indices, that need the index of the first vertex of the chunk. */
+    std::vector<std::size_t> relative;
+    /** The line that could not be parsed, and what it should have been. */
+    std::string error_line;
+    const char *error_element = nullptr;
+  };
+
+  inline bool
+  isOBJSpace (char c)
+  {
+    return (c == ' ' || c == '\t' || c == '\r');
+  }
+
+  /** Find the next token in [begin, end), separated as boost::split with "\t\r " does it. Returns false if there
+    * is none. */
+  inline bool
+  nextOBJToken (const char *&begin, const char *end, const char *&token_end)
+  {
+    while (begin != end && isOBJSpace (*begin))
+      ++begin;
+    token_end = begin;
+    while (token_end != end && !isOBJSpace (*token_end))
+      ++token_end;
+    return (begin != token_end);
+  }
+
+  /** Parse a float like boost::lexical_cast<float>. */
+  inline bool
+  parseOBJFloat (const char *begin, const char *end, float &value)
+  {
+    if (pcl::io::detail::parseNumber (begin, end, value))
+      return (true);
+    try
+    {
+      value = boost::lexical_cast<float> (std::string (begin, end));
+      return (true);
+    }
+    catch (const boost::bad_lexical_cast&)
+    {
+      return (false);
+    }
+  }
+
+  /** Parse 3 floats of a line, ignoring the rest. */
+  inline bool
+  parseOBJVector (const char *begin, const char *end, std::vector<float> &values)
+  {
+    const char *token_end;
+    for (int i = 0; i < 3; ++i, begin = token_end)
+    {
+      float value;
+      if (!nextOBJToken (begin, end, token_end) || !parseOBJFloat (begin, token_end, value))
+        return (false);
+      values.push_back (value);
+    }
+    return (true);
+  }
+
+  /** Parse the vertex index at the start of a face element (v, v/vt, v//vn or v/vt/vn), like sscanf's %d. */
+  inline bool
+  parseOBJIndex (const char *begin, const char *end, long long &value)
+  {
+    bool negative = false;
+    if (begin != end && (*begin == '-' || *begin == '+'))
+      negative = (*begin++ == '-');
+    if (begin == end || static_cast<unsigned int> (*begin - '0') > 9)
+      return (false);
+    long long result = 0;
+    for (; begin != end && static_cast<unsigned int> (*begin - '0') <= 9; ++begin)
+      if (result < (1ll << 40))
+        result = result * 10 + (*begin - '0');
+    value = (negative ? -result : result);
+    return (true);
+  }
+
+  /** Parse the lines of an OBJ file in [begin, end), which starts at the beginning of a line. */
+  void
+  parseOBJChunk (const char *begin, const char *end, bool read_polygons, OBJChunk &chunk)
+  {
+    for (const char *line = begin; line < end;)
+    {
+      const char *line_end = static_cast<const char*> (std::memchr (line, '\n', end - line));
+      if (!line_end)
+        line_end = end;
+
+      const char *token = line, *token_end;
+      if (nextOBJToken (token, line_end, token_end))
+      {
+        const std::size_t length = token_end - token;
+        // Vertex
+        if (length == 1 && token[0] == 'v')
+        {
+          if (!parseOBJVector (token_end, line_end, chunk.vertices))
+            chunk.error_element = "vertex coordinates";
+        }
+        // Vertex normal
+        else if (length == 2 && token[0] == 'v' && token[1] == 'n')
+        {
+          if (!parseOBJVector (token_end, line_end, chunk.normals))
+            chunk.error_element = "vertex normal";
+        }
+        // Face
+        else if (length == 1 && token[0] == 'f' && read_polygons)
+        {
+          std::uint32_t size = 0;
+          for (token = token_end; nextOBJToken (token, line_end, token_end); token = token_end, ++size)
+          {
+            long long index;
+            if (!parseOBJIndex (token, token_end, index))
+            {
+              chunk.error_element = "polygon vertex index";
+              break;
+            }
+            if (index < 0)
+            {
+              chunk.relative.push_back (chunk.indices.size ());
+              chunk.indices.push_back (static_cast<std::int64_t> (chunk.vertices.size () / 3) + index);
+            }
+            else
+              chunk.indices.push_back (index - 1);
+          }
+          chunk.sizes.push_back (size);
+        }
+      }
+      if (chunk.error_element)
+      {
+        chunk.error_line.assign (line, line_end);
+        return;
+      }
+      line = line_end + 1;
+    }
+  }
+
+  /** Files smaller than this are parsed as a single chunk. */
+  constexpr std::size_t min_obj_chunk_size = 1 << 20;
+}
+
+
 pcl::MTLReader::MTLReader ()
 {
   xyz_to_rgb_matrix_ << 2.3706743, -0.9000405, -0.4706338,
@@ -502,128 +724,166 @@ pcl::OBJReader::read (const std::string &file_name, pcl::PCLPointCloud2 &cloud,
   pcl::console::TicToc tt;
   tt.tic ();
 
-  int data_type;
-  unsigned int data_idx;
-  if (readHeader (file_name, cloud, origin, orientation, file_version, data_type, data_idx, offset))
+  origin = Eigen::Vector4f::Zero ();
+  orientation = Eigen::Quaternionf::Identity ();
+  file_version = 0;
+  std::vector<std::uint32_t> polygon_indices, polygon_offsets;
+  if (readMapped (file_name, offset, false, cloud, polygon_indices, polygon_offsets))
+    return (-1);
+
+  double total_time = tt.toc ();
+  PCL_DEBUG ("[pcl::OBJReader::read] Loaded %s as a dense cloud in %g ms with %d points. Available dimensions: %s.\n",
+             file_name.c_str (), total_time,
+             cloud.width * cloud.height, pcl::getFieldsList (cloud).c_str ());
+  return (0);
+}
+
+void
+pcl::OBJReader::setNumberOfThreads (unsigned int nr_threads)
+{
+  // 0 is resolved against the budget of pcl::ExecutionContext at compute time
+  threads_ = nr_threads;
+}
+
+int
+pcl::OBJReader::readMapped (const std::string &file_name, const int offset, bool read_polygons,
+                            pcl::PCLPointCloud2 &cloud, std::vector<std::uint32_t> &polygon_indices,
+                            std::vector<std::uint32_t> &polygon_offsets)
+{
+  cloud.fields.clear ();
+  cloud.width = cloud.height = cloud.point_step = cloud.row_step = 0;
+  cloud.data.clear ();
+  polygon_indices.clear ();
+  polygon_offsets.clear ();
+
+  if (file_name.empty () || !boost::filesystem::exists (file_name))
   {
-    PCL_ERROR ("[pcl::OBJReader::read] Problem reading header!\n");
+    PCL_ERROR ("[pcl::OBJReader::read] Could not find file '%s'.\n", file_name.c_str ());
     return (-1);
   }
-
-  std::ifstream fs;
-  fs.open (file_name.c_str (), std::ios::binary);
-  if (!fs.is_open () || fs.fail ())
+  const MappedOBJFile file (file_name);
+  if (!file.isValid ())
   {
-    PCL_ERROR ("[pcl::OBJReader::readHeader] Could not open file '%s'! Error : %s\n",
-               file_name.c_str (), strerror(errno));
-    fs.close ();
+    PCL_ERROR ("[pcl::OBJReader::read] Could not map file '%s'! Error : %s\n", file_name.c_str (), strerror (errno));
     return (-1);
   }
+  const char *begin = file.data () + std::min<std::size_t> (std::max (offset, 0), file.size ());
+  const char *end = file.data () + file.size ();
+
+  // Split the file into chunks of whole lines, several per thread to balance the load
+  const pcl::ThreadReservation reservation (threads_);
+  const unsigned int threads = reservation.getNumberOfThreads ();
+  const std::size_t max_chunks = threads > 1 ? 4 * threads : 1;
+  const std::size_t nr_chunks = std::max<std::size_t> (1, std::min<std::size_t> (max_chunks, (end - begin) / min_obj_chunk_size));
+  std::vector<const char*> bounds (nr_chunks + 1, end);
+  bounds[0] = begin;
+  for (std::size_t c = 1; c < nr_chunks; ++c)
+  {
+    const char *bound = std::max (bounds[c - 1], begin + c * ((end - begin) / nr_chunks));
+    const char *line_end = (bound == end ? nullptr : static_cast<const char*> (std::memchr (bound, '\n', end - bound)));
+    bounds[c] = (line_end ? line_end + 1 : end);
+  }
 
-  // Seek at the given offset
-  fs.seekg (data_idx, std::ios::beg);
-
-  // Get normal_x and rgba fields indices
-  int normal_x_field = -1;
-  // std::size_t rgba_field = 0;
-  for (std::size_t i = 0; i < cloud.fields.size (); ++i)
-    if (cloud.fields[i].name == "normal_x")
+  std::vector<OBJChunk> chunks (nr_chunks);
+#pragma omp parallel for \
+  default(none) \
+  shared(bounds, chunks, read_polygons) \
+  firstprivate(nr_chunks) \
+  num_threads(threads) \
+  schedule(dynamic, 1)
+  for (std::ptrdiff_t c = 0; c < static_cast<std::ptrdiff_t> (nr_chunks); ++c)
+    parseOBJChunk (bounds[c], bounds[c + 1], read_polygons, chunks[c]);
+
+  // Positions of the elements of every chunk in the merged buffers
+  std::vector<std::size_t> vertex_base (nr_chunks + 1, 0), normal_base (nr_chunks + 1, 0);
+  std::vector<std::size_t> index_base (nr_chunks + 1, 0), polygon_base (nr_chunks + 1, 0);
+  for (std::size_t c = 0; c < nr_chunks; ++c)
+  {
+    const OBJChunk &chunk = chunks[c];
+    if (chunk.error_element)
     {
-      normal_x_field = i;
-      break;
+      PCL_ERROR ("[pcl::OBJReader::read] Unable to convert line %s to %s!\n", chunk.error_line.c_str (), chunk.error_element);
+      return (-1);
     }
-  // else if (cloud.fields[i].name == "rgba")
-  //   rgba_field = i;
-
-  std::vector<std::string> st;
-  try
+    vertex_base[c + 1] = vertex_base[c] + chunk.vertices.size () / 3;
+    normal_base[c + 1] = normal_base[c] + chunk.normals.size () / 3;
+    index_base[c + 1] = index_base[c] + chunk.indices.size ();
+    polygon_base[c + 1] = polygon_base[c] + chunk.sizes.size ();
+  }
+  const std::size_t nr_points = vertex_base[nr_chunks];
+  const std::size_t nr_normals = normal_base[nr_chunks];
+  if (nr_points == 0)
   {
-    uindex_t point_idx = 0;
-    uindex_t normal_idx = 0;
+    PCL_ERROR ("[pcl::OBJReader::read] No vertices found!\n");
+    return (-1);
+  }
+  if (nr_normals > nr_points)
+    PCL_WARN ("[pcl:OBJReader] Too many vertex normals (expected %zu), skipping remaining normals.\n", nr_points);
 
-    while (!fs.eof ())
+  // Same fields as readHeader
+  const char *field_names[6] = {"x", "y", "z", "normal_x", "normal_y", "normal_z"};
+  for (int i = 0; i < (nr_normals > 0 ? 6 : 3); ++i)
+  {
+    cloud.fields.emplace_back ();
+    pcl::PCLPointField &field = cloud.fields.back ();
+    field.name = field_names[i];
+    field.offset = 4 * i;
+    field.datatype = pcl::PCLPointField::FLOAT32;
+    field.count = 1;
+  }
+  cloud.point_step = static_cast<std::uint32_t> (4 * cloud.fields.size ());
+  cloud.width = static_cast<std::uint32_t> (nr_points);
+  cloud.height = 1;
+  cloud.row_step = cloud.point_step * cloud.width;
+  cloud.is_dense = true;
+  cloud.data.resize (cloud.point_step * nr_points);
+  polygon_indices.resize (index_base[nr_chunks]);
+  polygon_offsets.resize (polygon_base[nr_chunks] + 1);
+  polygon_offsets.back () = static_cast<std::uint32_t> (index_base[nr_chunks]);
+
+  // Merge the chunks, resolving the relative vertex indices with the number of vertices before each chunk
+#pragma omp parallel for \
+  default(none) \
+  shared(chunks, cloud, polygon_indices, polygon_offsets, vertex_base, normal_base, index_base, polygon_base) \
+  firstprivate(nr_chunks, nr_points) \
+  num_threads(threads)
+  for (std::ptrdiff_t c = 0; c < static_cast<std::ptrdiff_t> (nr_chunks); ++c)
+  {
+    OBJChunk &chunk = chunks[c];
+    for (std::size_t i = 0; i < chunk.vertices.size () / 3; ++i)
+      std::memcpy (&cloud.data[(vertex_base[c] + i) * cloud.point_step], &chunk.vertices[3 * i], 3 * sizeof (float));
+    for (std::size_t i = 0; i < chunk.normals.size () / 3 && normal_base[c] + i < nr_points; ++i)
+      std::memcpy (&cloud.data[(normal_base[c] + i) * cloud.point_step + 12], &chunk.normals[3 * i], 3 * sizeof (float));
+
+    for (const std::size_t position : chunk.relative)
+      chunk.indices[position] += static_cast<std::int64_t> (vertex_base[c]);
+    std::transform (chunk.indices.cbegin (), chunk.indices.cend (), polygon_indices.begin () + index_base[c],
+                    [] (std::int64_t index) { return (static_cast<std::uint32_t> (index)); });
+    std::size_t position = index_base[c];
+    for (std::size_t i = 0; i < chunk.sizes.size (); ++i)
     {
-      std::string line;
-      getline (fs, line);
-      // Ignore empty lines
-      if (line.empty())
-        continue;
-
-      // Tokenize the line
-      std::stringstream sstream (line);
-      sstream.imbue (std::locale::classic ());
-      line = sstream.str ();
-      boost::trim (line);
-      boost::split (st, line, boost::is_any_of ("\t\r "), boost::token_compress_on);
-
-      // Ignore comments
-      if (st[0] == "#")
-        continue;
-
-      // Vertex
-      if (st[0] == "v")
-      {
-        try
-        {
-          for (int i = 1, f = 0; i < 4; ++i, ++f)
-          {
-            float value = boost::lexical_cast<float> (st[i]);
-            memcpy (&cloud.data[point_idx * cloud.point_step + cloud.fields[f].offset],
-                &value,
-                sizeof (float));
-          }
-          ++point_idx;
-        }
-        catch (const boost::bad_lexical_cast&)
-        {
-          PCL_ERROR ("Unable to convert %s to vertex coordinates!\n", line.c_str ());
-          return (-1);
-        }
-        continue;
-      }
-
-      // Vertex normal
-      if (st[0] == "vn")
-      {
-        if (normal_idx >= cloud.width) 
-        {
-          if (normal_idx == cloud.width)
-            PCL_WARN ("[pcl:OBJReader] Too many vertex normals (expected %d), skipping remaining normals.\n", cloud.width, normal_idx + 1);
-          ++normal_idx;
-          continue;
-        }
-        try
-        {
-          for (int i = 1, f = normal_x_field; i < 4; ++i, ++f)
-          {
-            float value = boost::lexical_cast<float> (st[i]);
-            memcpy (&cloud.data[normal_idx * cloud.point_step + cloud.fields[f].offset],
-                &value,
-                sizeof (float));
-          }
-          ++normal_idx;
-        }
-        catch (const boost::bad_lexical_cast&)
-        {
-          PCL_ERROR ("Unable to convert line %s to vertex normal!\n", line.c_str ());
-          return (-1);
-        }
-        continue;
-      }
+      polygon_offsets[polygon_base[c] + i] = static_cast<std::uint32_t> (position);
+      position += chunk.sizes[i];
     }
+    // Release the chunk early, the merged buffers are as large
+    chunk = OBJChunk ();
   }
-  catch (const char *exception)
-  {
-    PCL_ERROR ("[pcl::OBJReader::read] %s\n", exception);
-    fs.close ();
+  return (0);
+}
+
+int
+pcl::OBJReader::read (const std::string &file_name, pcl::PCLPointCloud2 &cloud,
+                      std::vector<std::uint32_t> &polygon_indices, std::vector<std::uint32_t> &polygon_offsets,
+                      const int offset)
+{
+  pcl::console::TicToc tt;
+  tt.tic ();
+  if (readMapped (file_name, offset, true, cloud, polygon_indices, polygon_offsets))
     return (-1);
-  }
 
   double total_time = tt.toc ();
-  PCL_DEBUG ("[pcl::OBJReader::read] Loaded %s as a dense cloud in %g ms with %d points. Available dimensions: %s.\n",
-             file_name.c_str (), total_time,
-             cloud.width * cloud.height, pcl::getFieldsList (cloud).c_str ());
-  fs.close ();
+  PCL_DEBUG ("[pcl::OBJReader::read] Loaded %s as a flat mesh in %g ms with %u points and %zu polygons.\n",
+             file_name.c_str (), total_time, cloud.width * cloud.height, polygon_offsets.size () - 1);
   return (0);
 }
 
@@ -836,134 +1096,30 @@ pcl::OBJReader::read (const std::string &file_name, pcl::PolygonMesh &mesh,
   pcl::console::TicToc tt;
   tt.tic ();
 
-  int data_type;
-  unsigned int data_idx;
-  if (readHeader (file_name, mesh.cloud, origin, orientation, file_version, data_type, data_idx, offset))
-  {
-    PCL_ERROR ("[pcl::OBJReader::read] Problem reading header!\n");
-    return (-1);
-  }
-
-  std::ifstream fs;
-  fs.open (file_name.c_str (), std::ios::binary);
-  if (!fs.is_open () || fs.fail ())
-  {
-    PCL_ERROR ("[pcl::OBJReader::readHeader] Could not open file '%s'! Error : %s\n",
-               file_name.c_str (), strerror(errno));
-    fs.close ();
+  origin = Eigen::Vector4f::Zero ();
+  orientation = Eigen::Quaternionf::Identity ();
+  file_version = 0;
+  std::vector<std::uint32_t> polygon_indices, polygon_offsets;
+  if (readMapped (file_name, offset, true, mesh.cloud, polygon_indices, polygon_offsets))
     return (-1);
-  }
-
-  // Seek at the given offset
-  fs.seekg (data_idx, std::ios::beg);
-
-  // Get normal_x and rgba fields indices
-  int normal_x_field = -1;
-  // std::size_t rgba_field = 0;
-  for (std::size_t i = 0; i < mesh.cloud.fields.size (); ++i)
-    if (mesh.cloud.fields[i].name == "normal_x")
-    {
-      normal_x_field = i;
-      break;
-    }
-
-  std::vector<std::string> st;
-  try
-  {
-    std::size_t v_idx = 0;
-    std::size_t vn_idx = 0;
-
-    while (!fs.eof ())
-    {
-      std::string line;
-      getline (fs, line);
-      // Ignore empty lines
-      if (line.empty())
-        continue;
 
-      // Tokenize the line
-      std::stringstream sstream (line);
-      sstream.imbue (std::locale::classic ());
-      line = sstream.str ();
-      boost::trim (line);
-      boost::split (st, line, boost::is_any_of ("\t\r "), boost::token_compress_on);
-
-      // Ignore comments
-      if (st[0] == "#")
-        continue;
-
-      // Vertex
-      if (st[0] == "v")
-      {
-        try
-        {
-          for (int i = 1, f = 0; i < 4; ++i, ++f)
-          {
-            float value = boost::lexical_cast<float> (st[i]);
-            memcpy (&mesh.cloud.data[v_idx * mesh.cloud.point_step + mesh.cloud.fields[f].offset],
-                &value,
-                sizeof (float));
-          }
-          ++v_idx;
-        }
-        catch (const boost::bad_lexical_cast&)
-        {
-          PCL_ERROR ("Unable to convert %s to vertex coordinates!\n", line.c_str ());
-          return (-1);
-        }
-        continue;
-      }
-
-      // Vertex normal
-      if (st[0] == "vn")
-      {
-        try
-        {
-          for (int i = 1, f = normal_x_field; i < 4; ++i, ++f)
-          {
-            float value = boost::lexical_cast<float> (st[i]);
-            memcpy (&mesh.cloud.data[vn_idx * mesh.cloud.point_step + mesh.cloud.fields[f].offset],
-                &value,
-                sizeof (float));
-          }
-          ++vn_idx;
-        }
-        catch (const boost::bad_lexical_cast&)
-        {
-          PCL_ERROR ("Unable to convert line %s to vertex normal!\n", line.c_str ());
-          return (-1);
-        }
-        continue;
-      }
-
-      // Face
-      if (st[0] == "f")
-      {
-        pcl::Vertices face_vertices; face_vertices.vertices.resize (st.size () - 1);
-        for (std::size_t i = 1; i < st.size (); ++i)
-        {
-          int v;
-          sscanf (st[i].c_str (), "%d", &v);
-          v = (v < 0) ? v_idx + v : v - 1;
-          face_vertices.vertices[i - 1] = v;
-        }
-        mesh.polygons.push_back (face_vertices);
-        continue;
-      }
-    }
-  }
-  catch (const char *exception)
-  {
-    PCL_ERROR ("[pcl::OBJReader::read] %s\n", exception);
-    fs.close ();
-    return (-1);
-  }
+  const std::ptrdiff_t nr_polygons = static_cast<std::ptrdiff_t> (polygon_offsets.size ()) - 1;
+  mesh.polygons.resize (nr_polygons);
+  const pcl::ThreadReservation reservation (threads_);
+  const unsigned int threads = reservation.getNumberOfThreads ();
+#pragma omp parallel for \
+  default(none) \
+  shared(mesh, polygon_indices, polygon_offsets) \
+  firstprivate(nr_polygons) \
+  num_threads(threads)
+  for (std::ptrdiff_t i = 0; i < nr_polygons; ++i)
+    mesh.polygons[i].vertices.assign (polygon_indices.cbegin () + polygon_offsets[i],
+                                      polygon_indices.cbegin () + polygon_offsets[i + 1]);
 
   double total_time = tt.toc ();
-  PCL_DEBUG ("[pcl::OBJReader::read] Loaded %s as a PolygonMesh in %g ms with %g points and %g polygons.\n",
+  PCL_DEBUG ("[pcl::OBJReader::read] Loaded %s as a PolygonMesh in %g ms with %u points and %zu polygons.\n",
              file_name.c_str (), total_time,
              mesh.cloud.width * mesh.cloud.height, mesh.polygons.size ());
-  fs.close ();
   return (0);
 }
 
@@ -46,6 +46,7 @@
 #include <pcl/io/openni2/openni2_device.h>
 #include <pcl/point_cloud.h>
 #include <pcl/point_types.h>
+#include <pcl/common/execution_context.h>
 #include <pcl/common/time.h>
 #include <pcl/console/print.h>
 #include <pcl/exceptions.h>
@@ -76,6 +77,9 @@ pcl::io::OpenNI2Grabber::OpenNI2Grabber (const std::string& device_id, const Mod
   : color_resize_buffer_(0)
   , depth_resize_buffer_(0)
   , ir_resize_buffer_(0)
+  , ray_x_ ()
+  , ray_y_ ()
+  , threads_ (1)
   , image_width_ ()
   , image_height_ ()
   , depth_width_ ()
@@ -517,11 +521,43 @@ pcl::io::OpenNI2Grabber::irDepthImageCallback (const IRImage::Ptr &ir_image,
 }
 
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+void
+pcl::io::OpenNI2Grabber::setNumberOfThreads (unsigned int nr_threads)
+{
+  // 0 is resolved against the budget of pcl::ExecutionContext at compute time
+  threads_ = nr_threads;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+void
+pcl::io::OpenNI2Grabber::updateRayTables (unsigned width, unsigned height, float fx_inv, float fy_inv, float cx, float cy)
+{
+  ray_x_.resize (width);
+  for (unsigned u = 0; u < width; ++u)
+    ray_x_[u] = (static_cast<float> (u) - cx) * fx_inv;
+
+  ray_y_.resize (height);
+  for (unsigned v = 0; v < height; ++v)
+    ray_y_[v] = (static_cast<float> (v) - cy) * fy_inv;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> typename pcl::PointCloud<PointT>::Ptr
+pcl::io::OpenNI2Grabber::leaseCloud ()
+{
+  auto& pool = std::get<pcl::io::PointCloudPool<PointT> > (cloud_pools_);
+  pool.setCapacity (cloud_pool_capacity_);
+  return (pool.lease ());
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 pcl::PointCloud<pcl::PointXYZ>::Ptr
 pcl::io::OpenNI2Grabber::convertToXYZPointCloud (const DepthImage::Ptr& depth_image)
 {
-  pcl::PointCloud<pcl::PointXYZ>::Ptr cloud (new pcl::PointCloud <pcl::PointXYZ>);
+  const pcl::ThreadReservation reservation (threads_);
+  const unsigned int threads = reservation.getNumberOfThreads ();
+  pcl::PointCloud<pcl::PointXYZ>::Ptr cloud = leaseCloud<pcl::PointXYZ> ();
 
   cloud->header.seq = depth_image->getFrameID ();
   cloud->header.stamp = depth_image->getTimestamp ();
@@ -566,24 +602,36 @@ pcl::io::OpenNI2Grabber::convertToXYZPointCloud (const DepthImage::Ptr& depth_im
     depth_map = depth_resize_buffer_.data();
   }
 
-  unsigned depth_idx = 0;
-  for (unsigned v = 0; v < depth_height_; ++v)
+  updateRayTables (depth_width_, depth_height_, constant_x, constant_y, centerX, centerY);
+  const float* ray_x = ray_x_.data ();
+  const float* ray_y = ray_y_.data ();
+  std::uint64_t no_sample_value = depth_image->getNoSampleValue ();
+  std::uint64_t shadow_value = depth_image->getShadowValue ();
+  unsigned width = depth_width_;
+  int height = static_cast<int> (depth_height_);
+
+#pragma omp parallel for \
+  default(none) \
+  shared(cloud) \
+  firstprivate(depth_map, ray_x, ray_y, no_sample_value, shadow_value, width, height, bad_point) \
+  num_threads(threads)
+  for (int v = 0; v < height; ++v)
   {
-    for (unsigned u = 0; u < depth_width_; ++u, ++depth_idx)
+    std::size_t depth_idx = static_cast<std::size_t> (v) * width;
+    for (unsigned u = 0; u < width; ++u, ++depth_idx)
     {
       pcl::PointXYZ& pt = (*cloud)[depth_idx];
+      const std::uint16_t depth = depth_map[depth_idx];
       // Check for invalid measurements
-      if (depth_map[depth_idx] == 0 ||
-        depth_map[depth_idx] == depth_image->getNoSampleValue () ||
-        depth_map[depth_idx] == depth_image->getShadowValue ())
+      if (depth == 0 || depth == no_sample_value || depth == shadow_value)
       {
         // not valid
         pt.x = pt.y = pt.z = bad_point;
         continue;
       }
-      pt.z = depth_map[depth_idx] * 0.001f;
-      pt.x = (static_cast<float> (u) - centerX) * pt.z * constant_x;
-      pt.y = (static_cast<float> (v) - centerY) * pt.z * constant_y;
+      pt.z = depth * 0.001f;
+      pt.x = ray_x[u] * pt.z;
+      pt.y = ray_y[v] * pt.z;
     }
   }
   cloud->sensor_origin_.setZero ();
@@ -599,7 +647,9 @@ pcl::io::OpenNI2Grabber::convertToXYZPointCloud (const DepthImage::Ptr& depth_im
 template <typename PointT> typename pcl::PointCloud<PointT>::Ptr
 pcl::io::OpenNI2Grabber::convertToXYZRGBPointCloud (const Image::Ptr &image, const DepthImage::Ptr &depth_image)
 {
-  typename pcl::PointCloud<PointT>::Ptr cloud (new pcl::PointCloud<PointT>);
+  const pcl::ThreadReservation reservation (threads_);
+  const unsigned int threads = reservation.getNumberOfThreads ();
+  typename pcl::PointCloud<PointT>::Ptr cloud = leaseCloud<PointT> ();
 
   cloud->header.seq = depth_image->getFrameID ();
   cloud->header.stamp = depth_image->getTimestamp ();
@@ -664,28 +714,40 @@ pcl::io::OpenNI2Grabber::convertToXYZRGBPointCloud (const Image::Ptr &image, con
     cloud->points.assign (cloud->size (), pt);
   }
 
-  // fill in XYZ values
-  unsigned step = cloud->width / depth_width_;
-  unsigned skip = cloud->width - (depth_width_ * step);
-
-  unsigned value_idx = 0;
-  unsigned point_idx = 0;
-  for (unsigned v = 0; v < depth_height_; ++v, point_idx += skip)
-  {
-    for (unsigned u = 0; u < depth_width_; ++u, ++value_idx, point_idx += step)
+  // fill in XYZ values; a depth row starts every cloud->width points, its pixels are step points apart
+  updateRayTables (depth_width_, depth_height_, fx_inv, fy_inv, cx, cy);
+  const float* ray_x = ray_x_.data ();
+  const float* ray_y = ray_y_.data ();
+  std::uint64_t no_sample_value = depth_image->getNoSampleValue ();
+  std::uint64_t shadow_value = depth_image->getShadowValue ();
+  unsigned cloud_width = cloud->width;
+  unsigned width = depth_width_;
+  int height = static_cast<int> (depth_height_);
+  unsigned step = cloud_width / width;
+
+#pragma omp parallel for \
+  default(none) \
+  shared(cloud) \
+  firstprivate(depth_map, ray_x, ray_y, no_sample_value, shadow_value, cloud_width, width, height, step, bad_point) \
+  num_threads(threads)
+  for (int v = 0; v < height; ++v)
+  {
+    std::size_t value_idx = static_cast<std::size_t> (v) * width;
+    std::size_t point_idx = static_cast<std::size_t> (v) * cloud_width;
+    for (unsigned u = 0; u < width; ++u, ++value_idx, point_idx += step)
     {
       PointT& pt = (*cloud)[point_idx];
       /// @todo Different values for these cases
       // Check for invalid measurements
 
-      OniDepthPixel pixel = depth_map[value_idx];
+      const OniDepthPixel pixel = depth_map[value_idx];
       if (pixel != 0 &&
-        pixel != depth_image->getNoSampleValue () &&
-        pixel != depth_image->getShadowValue () )
+        pixel != no_sample_value &&
+        pixel != shadow_value)
       {
-        pt.z = depth_map[value_idx] * 0.001f;  // millimeters to meters
-        pt.x = (static_cast<float> (u) - cx) * pt.z * fx_inv;
-        pt.y = (static_cast<float> (v) - cy) * pt.z * fy_inv;
+        pt.z = pixel * 0.001f;  // millimeters to meters
+        pt.x = ray_x[u] * pt.z;
+        pt.y = ray_y[v] * pt.z;
       }
       else
       {
@@ -695,17 +757,22 @@ pcl::io::OpenNI2Grabber::convertToXYZRGBPointCloud (const Image::Ptr &image, con
   }
 
   // fill in the RGB values
-  step = cloud->width / image_width_;
-  skip = cloud->width - (image_width_ * step);
-
-  value_idx = 0;
-  point_idx = 0;
-  RGBValue color;
-  color.Alpha = 0xff;
-
-  for (unsigned yIdx = 0; yIdx < image_height_; ++yIdx, point_idx += skip)
-  {
-    for (unsigned xIdx = 0; xIdx < image_width_; ++xIdx, point_idx += step, value_idx += 3)
+  width = image_width_;
+  height = static_cast<int> (image_height_);
+  step = cloud_width / width;
+
+#pragma omp parallel for \
+  default(none) \
+  shared(cloud) \
+  firstprivate(rgb_buffer, cloud_width, width, height, step) \
+  num_threads(threads)
+  for (int yIdx = 0; yIdx < height; ++yIdx)
+  {
+    std::size_t value_idx = static_cast<std::size_t> (yIdx) * width * 3;
+    std::size_t point_idx = static_cast<std::size_t> (yIdx) * cloud_width;
+    RGBValue color;
+    color.Alpha = 0xff;
+    for (unsigned xIdx = 0; xIdx < width; ++xIdx, point_idx += step, value_idx += 3)
     {
       PointT& pt = (*cloud)[point_idx];
 
@@ -726,7 +793,9 @@ pcl::io::OpenNI2Grabber::convertToXYZRGBPointCloud (const Image::Ptr &image, con
 pcl::PointCloud<pcl::PointXYZI>::Ptr
 pcl::io::OpenNI2Grabber::convertToXYZIPointCloud (const IRImage::Ptr &ir_image, const DepthImage::Ptr &depth_image)
 {
-  pcl::PointCloud<pcl::PointXYZI>::Ptr cloud (new pcl::PointCloud<pcl::PointXYZI>);
+  const pcl::ThreadReservation reservation (threads_);
+  const unsigned int threads = reservation.getNumberOfThreads ();
+  pcl::PointCloud<pcl::PointXYZI>::Ptr cloud = leaseCloud<pcl::PointXYZI> ();
 
   cloud->header.seq = depth_image->getFrameID ();
   cloud->header.stamp = depth_image->getTimestamp ();
@@ -779,27 +848,39 @@ pcl::io::OpenNI2Grabber::convertToXYZIPointCloud (const IRImage::Ptr &ir_image,
   }
 
 
-  std::size_t depth_idx = 0;
   float bad_point = std::numeric_limits<float>::quiet_NaN ();
 
-  for (unsigned v = 0; v < depth_height_; ++v)
-  {
-    for (unsigned u = 0; u < depth_width_; ++u, ++depth_idx)
+  updateRayTables (depth_width_, depth_height_, fx_inv, fy_inv, cx, cy);
+  const float* ray_x = ray_x_.data ();
+  const float* ray_y = ray_y_.data ();
+  std::uint64_t no_sample_value = depth_image->getNoSampleValue ();
+  std::uint64_t shadow_value = depth_image->getShadowValue ();
+  unsigned width = depth_width_;
+  int height = static_cast<int> (depth_height_);
+
+#pragma omp parallel for \
+  default(none) \
+  shared(cloud) \
+  firstprivate(depth_map, ir_map, ray_x, ray_y, no_sample_value, shadow_value, width, height, bad_point) \
+  num_threads(threads)
+  for (int v = 0; v < height; ++v)
+  {
+    std::size_t depth_idx = static_cast<std::size_t> (v) * width;
+    for (unsigned u = 0; u < width; ++u, ++depth_idx)
     {
       pcl::PointXYZI& pt = (*cloud)[depth_idx];
+      const std::uint16_t depth = depth_map[depth_idx];
       /// @todo Different values for these cases
       // Check for invalid measurements
-      if (depth_map[depth_idx] == 0 ||
-        depth_map[depth_idx] == depth_image->getNoSampleValue () ||
-        depth_map[depth_idx] == depth_image->getShadowValue ())
+      if (depth == 0 || depth == no_sample_value || depth == shadow_value)
       {
         pt.x = pt.y = pt.z = bad_point;
       }
       else
       {
-        pt.z = depth_map[depth_idx] * 0.001f; // millimeters to meters
-        pt.x = (static_cast<float> (u) - cx) * pt.z * fx_inv;
-        pt.y = (static_cast<float> (v) - cy) * pt.z * fy_inv;
+        pt.z = depth * 0.001f; // millimeters to meters
+        pt.x = ray_x[u] * pt.z;
+        pt.y = ray_y[v] * pt.z;
       }
 
       pt.data_c[0] = pt.data_c[1] = pt.data_c[2] = pt.data_c[3] = 0;
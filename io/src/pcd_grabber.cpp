@@ -41,15 +41,65 @@
 #include <pcl/io/tar.h>
 #include <pcl/memory.h>
 
+#include <condition_variable>
+#include <cstring>
+#include <map>
+#include <thread>
+
 ///////////////////////////////////////////////////////////////////////////////////////////
 //////////////////////// GrabberImplementation //////////////////////
 struct pcl::PCDGrabberBase::PCDGrabberImpl
 {
   PCDGrabberImpl (pcl::PCDGrabberBase& grabber, const std::string& pcd_path, float frames_per_second, bool repeat);
   PCDGrabberImpl (pcl::PCDGrabberBase& grabber, const std::vector<std::string>& pcd_files, float frames_per_second, bool repeat);
+  ~PCDGrabberImpl ();
   void trigger ();
   void readAhead ();
 
+  //! A frame decoded by the read-ahead workers
+  struct Frame
+  {
+    pcl::PCLPointCloud2 cloud;
+    Eigen::Vector4f origin;
+    Eigen::Quaternionf orientation;
+    bool valid = false;
+    bool ready = false;
+
+    PCL_MAKE_ALIGNED_OPERATOR_NEW
+  };
+
+  //! A file mapped into memory
+  struct MappedFile
+  {
+    const unsigned char* data = nullptr;
+    std::size_t size = 0;
+#ifdef _WIN32
+    HANDLE mapping = nullptr;
+#endif
+  };
+
+  // Read-ahead
+  void startReadAhead (std::size_t nr_frames, unsigned int nr_workers);
+  void stopReadAhead ();
+  void readAheadWorker ();
+  void triggerReadAhead ();
+  bool seek (std::size_t idx);
+
+  //! Whether the playback sequence number has a frame, must hold queue_mutex_
+  bool
+  hasFrame (std::size_t sequence) const
+  {
+    const std::size_t nr_frames = cloud_idx_to_file_idx_.size ();
+    return (nr_frames > 0 && (repeat_ || sequence < nr_frames));
+  }
+
+  //! Decode frame idx, from the memory mapped archive if possible
+  bool decodeFrame (std::size_t idx, Frame& frame);
+
+  //! Map file file_idx into memory, or return the existing mapping
+  const MappedFile& mapFile (std::size_t file_idx);
+  void unmapFiles ();
+
   // TAR reading I/O
   int openTARFile (const std::string &file_name);
   void closeTARFile ();
@@ -99,6 +149,25 @@ struct pcl::PCDGrabberBase::PCDGrabberImpl
   // simultaneous asynchronous read-aheads
   std::mutex read_ahead_mutex_;
 
+  // Read-ahead queue: the frames with playback sequence numbers in [next_published_, next_decoded_) are decoded
+  // or being decoded by the workers, at most read_ahead_frames_ of them
+  std::size_t read_ahead_frames_;
+  std::vector<std::thread> read_ahead_workers_;
+  std::mutex queue_mutex_;
+  std::condition_variable queue_space_;
+  std::condition_variable frame_ready_;
+  std::map<std::size_t, std::shared_ptr<Frame> > queued_frames_;
+  std::size_t next_published_;
+  std::size_t next_decoded_;
+  // Incremented on seeks, frames of an older generation are dropped
+  std::size_t generation_;
+  bool stop_workers_;
+
+  // Memory mapped TAR archives, by file index
+  bool use_memory_mapping_;
+  std::map<std::size_t, MappedFile> mapped_files_;
+  std::mutex mapping_mutex_;
+
   PCL_MAKE_ALIGNED_OPERATOR_NEW
 };
 
@@ -114,6 +183,12 @@ pcl::PCDGrabberBase::PCDGrabberImpl::PCDGrabberImpl (pcl::PCDGrabberBase& grabbe
   , tar_offset_ (0)
   , tar_header_ ()
   , scraped_ (false)
+  , read_ahead_frames_ (0)
+  , next_published_ (0)
+  , next_decoded_ (0)
+  , generation_ (0)
+  , stop_workers_ (false)
+  , use_memory_mapping_ (false)
 {
   pcd_files_.push_back (pcd_path);
   pcd_iterator_ = pcd_files_.begin ();
@@ -133,6 +208,12 @@ pcl::PCDGrabberBase::PCDGrabberImpl::PCDGrabberImpl (pcl::PCDGrabberBase& grabbe
   , tar_offset_ (0)
   , tar_header_ ()
   , scraped_ (false)
+  , read_ahead_frames_ (0)
+  , next_published_ (0)
+  , next_decoded_ (0)
+  , generation_ (0)
+  , stop_workers_ (false)
+  , use_memory_mapping_ (false)
 {
   pcd_files_ = pcd_files;
   pcd_iterator_ = pcd_files_.begin ();
@@ -140,6 +221,21 @@ pcl::PCDGrabberBase::PCDGrabberImpl::PCDGrabberImpl (pcl::PCDGrabberBase& grabbe
   readAhead ();
 }
 
+///////////////////////////////////////////////////////////////////////////////////////////
+pcl::PCDGrabberBase::PCDGrabberImpl::~PCDGrabberImpl ()
+{
+  time_trigger_.stop ();
+  {
+    // Late triggers take the synchronous path
+    std::lock_guard<std::mutex> read_ahead_lock (read_ahead_mutex_);
+    stopReadAhead ();
+    read_ahead_frames_ = 0;
+  }
+  unmapFiles ();
+  if (tar_fd_ != -1)
+    closeTARFile ();
+}
+
 ///////////////////////////////////////////////////////////////////////////////////////////
 void
 pcl::PCDGrabberBase::PCDGrabberImpl::readAhead ()
@@ -265,6 +361,11 @@ void
 pcl::PCDGrabberBase::PCDGrabberImpl::trigger ()
 {
   std::lock_guard<std::mutex> read_ahead_lock(read_ahead_mutex_);
+  if (read_ahead_frames_ > 0)
+  {
+    triggerReadAhead ();
+    return;
+  }
   if (valid_)
     grabber_.publish (next_cloud_,origin_,orientation_, next_file_name_);
 
@@ -272,6 +373,205 @@ pcl::PCDGrabberBase::PCDGrabberImpl::trigger ()
   readAhead ();
 }
 
+///////////////////////////////////////////////////////////////////////////////////////////
+void
+pcl::PCDGrabberBase::PCDGrabberImpl::startReadAhead (std::size_t nr_frames, unsigned int nr_workers)
+{
+  stopReadAhead ();
+  read_ahead_frames_ = nr_frames;
+  if (nr_frames == 0)
+    return;
+
+  // The workers decode frames by index
+  scrapeForClouds ();
+  queued_frames_.clear ();
+  next_published_ = next_decoded_ = 0;
+  ++generation_;
+  for (unsigned int i = 0; i < std::max (nr_workers, 1u); ++i)
+    read_ahead_workers_.emplace_back (&PCDGrabberImpl::readAheadWorker, this);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+void
+pcl::PCDGrabberBase::PCDGrabberImpl::stopReadAhead ()
+{
+  {
+    std::lock_guard<std::mutex> lock (queue_mutex_);
+    stop_workers_ = true;
+  }
+  queue_space_.notify_all ();
+  frame_ready_.notify_all ();
+  for (auto& worker : read_ahead_workers_)
+    worker.join ();
+  read_ahead_workers_.clear ();
+  std::lock_guard<std::mutex> lock (queue_mutex_);
+  queued_frames_.clear ();
+  stop_workers_ = false;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+void
+pcl::PCDGrabberBase::PCDGrabberImpl::readAheadWorker ()
+{
+  std::unique_lock<std::mutex> lock (queue_mutex_);
+  while (true)
+  {
+    queue_space_.wait (lock, [this]
+    {
+      return (stop_workers_ || (next_decoded_ < next_published_ + read_ahead_frames_ && hasFrame (next_decoded_)));
+    });
+    if (stop_workers_)
+      return;
+
+    // Claim the next frame, and decode it without holding the lock
+    const std::size_t sequence = next_decoded_++;
+    const std::size_t generation = generation_;
+    std::shared_ptr<Frame> frame (new Frame);
+    queued_frames_[sequence] = frame;
+    lock.unlock ();
+    const bool valid = decodeFrame (sequence % cloud_idx_to_file_idx_.size (), *frame);
+    lock.lock ();
+
+    frame->valid = valid;
+    frame->ready = true;
+    if (generation == generation_)
+      frame_ready_.notify_all ();
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+void
+pcl::PCDGrabberBase::PCDGrabberImpl::triggerReadAhead ()
+{
+  std::shared_ptr<Frame> frame;
+  std::size_t idx;
+  {
+    std::unique_lock<std::mutex> lock (queue_mutex_);
+    const std::size_t sequence = next_published_;
+    if (!hasFrame (sequence))
+      return;
+    frame_ready_.wait (lock, [this, sequence]
+    {
+      if (stop_workers_ || sequence != next_published_)
+        return (true);
+      const auto it = queued_frames_.find (sequence);
+      return (it != queued_frames_.end () && it->second->ready);
+    });
+    // Stopped, or the playback was moved by a seek in the meantime
+    if (stop_workers_ || sequence != next_published_)
+      return;
+    const auto it = queued_frames_.find (sequence);
+    frame = it->second;
+    queued_frames_.erase (it);
+    ++next_published_;
+    idx = sequence % cloud_idx_to_file_idx_.size ();
+  }
+  queue_space_.notify_all ();
+
+  if (frame->valid)
+    grabber_.publish (frame->cloud, frame->origin, frame->orientation, pcd_files_[cloud_idx_to_file_idx_[idx]]);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+bool
+pcl::PCDGrabberBase::PCDGrabberImpl::seek (std::size_t idx)
+{
+  {
+    std::lock_guard<std::mutex> lock (queue_mutex_);
+    if (read_ahead_frames_ == 0 || idx >= cloud_idx_to_file_idx_.size ())
+      return (false);
+    ++generation_;
+    queued_frames_.clear ();
+    next_published_ = next_decoded_ = idx;
+  }
+  queue_space_.notify_all ();
+  frame_ready_.notify_all ();
+  return (true);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+bool
+pcl::PCDGrabberBase::PCDGrabberImpl::decodeFrame (std::size_t idx, Frame& frame)
+{
+  const std::size_t file_idx = cloud_idx_to_file_idx_[idx];
+  const int offset = tar_offsets_[idx];
+  PCDReader reader;
+  int pcd_version;
+
+  // Frames of TAR archives are preceded by their TAR header
+  if (use_memory_mapping_ && offset >= 512)
+  {
+    const MappedFile& mapped_file = mapFile (file_idx);
+    if (mapped_file.data && static_cast<std::size_t> (offset) <= mapped_file.size)
+    {
+      pcl::io::TARHeader header;
+      std::memcpy (&header, mapped_file.data + offset - 512, 512);
+      const std::size_t size = std::min<std::size_t> (header.getFileSize (), mapped_file.size - offset);
+      return (reader.read (mapped_file.data + offset, size, frame.cloud, frame.origin, frame.orientation, pcd_version) == 0);
+    }
+  }
+  return (reader.read (pcd_files_[file_idx], frame.cloud, frame.origin, frame.orientation, pcd_version, offset) == 0);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+const pcl::PCDGrabberBase::PCDGrabberImpl::MappedFile&
+pcl::PCDGrabberBase::PCDGrabberImpl::mapFile (std::size_t file_idx)
+{
+  std::lock_guard<std::mutex> lock (mapping_mutex_);
+  const auto it = mapped_files_.find (file_idx);
+  if (it != mapped_files_.end ())
+    return (it->second);
+
+  // A failed mapping is stored as well, so that it is not retried for every frame
+  MappedFile& mapped_file = mapped_files_[file_idx];
+  const int fd = io::raw_open (pcd_files_[file_idx].c_str (), O_RDONLY);
+  if (fd == -1)
+    return (mapped_file);
+  const long file_size = io::raw_lseek (fd, 0, SEEK_END);
+  if (file_size > 0)
+  {
+#ifdef _WIN32
+    mapped_file.mapping = CreateFileMapping ((HANDLE) _get_osfhandle (fd), NULL, PAGE_READONLY, 0, 0, NULL);
+    if (mapped_file.mapping)
+    {
+      mapped_file.data = static_cast<const unsigned char*> (MapViewOfFile (mapped_file.mapping, FILE_MAP_READ, 0, 0, 0));
+      if (!mapped_file.data)
+      {
+        CloseHandle (mapped_file.mapping);
+        mapped_file.mapping = nullptr;
+      }
+    }
+#else
+    void* map = ::mmap (nullptr, static_cast<std::size_t> (file_size), PROT_READ, MAP_SHARED, fd, 0);
+    if (map != MAP_FAILED)
+      mapped_file.data = static_cast<const unsigned char*> (map);
+#endif
+    if (mapped_file.data)
+      mapped_file.size = static_cast<std::size_t> (file_size);
+  }
+  io::raw_close (fd);
+  return (mapped_file);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+void
+pcl::PCDGrabberBase::PCDGrabberImpl::unmapFiles ()
+{
+  std::lock_guard<std::mutex> lock (mapping_mutex_);
+  for (auto& mapped_file : mapped_files_)
+  {
+    if (!mapped_file.second.data)
+      continue;
+#ifdef _WIN32
+    UnmapViewOfFile (mapped_file.second.data);
+    CloseHandle (mapped_file.second.mapping);
+#else
+    ::munmap (const_cast<unsigned char*> (mapped_file.second.data), mapped_file.second.size);
+#endif
+  }
+  mapped_files_.clear ();
+}
+
 ///////////////////////////////////////////////////////////////////////////////////////////
 void
 pcl::PCDGrabberBase::PCDGrabberImpl::scrapeForClouds (bool force)
@@ -409,6 +709,11 @@ pcl::PCDGrabberBase::trigger ()
 bool
 pcl::PCDGrabberBase::isRunning () const
 {
+  if (impl_->read_ahead_frames_ > 0)
+  {
+    std::lock_guard<std::mutex> lock (impl_->queue_mutex_);
+    return (impl_->running_ && impl_->hasFrame (impl_->next_published_));
+  }
   return (impl_->running_ && (impl_->pcd_iterator_ != impl_->pcd_files_.end()));
 }
 
@@ -423,7 +728,55 @@ pcl::PCDGrabberBase::getName () const
 void
 pcl::PCDGrabberBase::rewind ()
 {
-  impl_->pcd_iterator_ = impl_->pcd_files_.begin ();
+  if (impl_->read_ahead_frames_ > 0)
+    impl_->seek (0);
+  else
+    impl_->pcd_iterator_ = impl_->pcd_files_.begin ();
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+void
+pcl::PCDGrabberBase::setReadAhead (std::size_t nr_frames, unsigned int nr_workers)
+{
+  std::lock_guard<std::mutex> read_ahead_lock (impl_->read_ahead_mutex_);
+  impl_->startReadAhead (nr_frames, nr_workers);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+std::size_t
+pcl::PCDGrabberBase::getReadAhead () const
+{
+  return (impl_->read_ahead_frames_);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+void
+pcl::PCDGrabberBase::setUseMemoryMapping (bool use_memory_mapping)
+{
+  std::lock_guard<std::mutex> read_ahead_lock (impl_->read_ahead_mutex_);
+  // The workers read the flag, so restart them
+  const std::size_t nr_frames = impl_->read_ahead_frames_;
+  const unsigned int nr_workers = static_cast<unsigned int> (impl_->read_ahead_workers_.size ());
+  impl_->stopReadAhead ();
+  impl_->use_memory_mapping_ = use_memory_mapping;
+  if (!use_memory_mapping)
+    impl_->unmapFiles ();
+  if (nr_frames > 0)
+    impl_->startReadAhead (nr_frames, nr_workers);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+bool
+pcl::PCDGrabberBase::getUseMemoryMapping () const
+{
+  return (impl_->use_memory_mapping_);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+bool
+pcl::PCDGrabberBase::seek (std::size_t idx)
+{
+  return (impl_->seek (idx));
 }
 
 ///////////////////////////////////////////////////////////////////////////////////////////
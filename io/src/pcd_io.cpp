@@ -37,14 +37,21 @@
  *
  */
 
+#include <algorithm>
+#include <cmath>
 #include <fstream>
+#include <istream>
+#include <streambuf>
 #include <fcntl.h>
+#include <numeric>
 #include <string>
 #include <cstdlib>
 #include <pcl/common/utils.h> // pcl::utils::ignore
 #include <pcl/common/io.h>
+#include <pcl/common/execution_context.h>
 #include <pcl/io/low_level_io.h>
 #include <pcl/io/lzf.h>
+#include <pcl/io/number_parser.h>
 #include <pcl/io/pcd_io.h>
 #include <pcl/console/time.h>
 
@@ -52,6 +59,7 @@
 #include <cerrno>
 #include <boost/filesystem.hpp> // for permissions
 #include <boost/algorithm/string.hpp> // for split
+#include <boost/range/iterator_range.hpp> // for make_iterator_range
 
 ///////////////////////////////////////////////////////////////////////////////////////////
 void
@@ -109,6 +117,16 @@ int
 pcl::PCDReader::readHeader (std::istream &fs, pcl::PCLPointCloud2 &cloud,
                             Eigen::Vector4f &origin, Eigen::Quaternionf &orientation, 
                             int &pcd_version, int &data_type, unsigned int &data_idx)
+{
+  return (parseHeader (fs, cloud, origin, orientation, pcd_version, data_type, data_idx, true));
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+int
+pcl::PCDReader::parseHeader (std::istream &fs, pcl::PCLPointCloud2 &cloud,
+                             Eigen::Vector4f &origin, Eigen::Quaternionf &orientation,
+                             int &pcd_version, int &data_type, unsigned int &data_idx,
+                             bool allocate_data)
 {
   // Default values
   data_idx = 0;
@@ -305,7 +323,8 @@ pcl::PCDReader::readHeader (std::istream &fs, pcl::PCLPointCloud2 &cloud,
           throw "Number of POINTS specified before COUNT in header!";
         sstream >> nr_points;
         // Need to allocate: N * point_step
-        cloud.data.resize (nr_points * cloud.point_step);
+        if (allocate_data)
+          cloud.data.resize (nr_points * cloud.point_step);
         continue;
       }
 
@@ -313,7 +332,9 @@ pcl::PCDReader::readHeader (std::istream &fs, pcl::PCLPointCloud2 &cloud,
       if (line_type.substr (0, 4) == "DATA")
       {
         data_idx = static_cast<int> (fs.tellg ());
-        if (st.at (1).substr (0, 17) == "binary_compressed")
+        if (st.at (1) == "chunked_binary_compressed")
+          data_type = 3;
+        else if (st.at (1).substr (0, 17) == "binary_compressed")
          data_type = 2;
         else
           if (st.at (1).substr (0, 6) == "binary")
@@ -376,6 +397,16 @@ int
 pcl::PCDReader::readHeader (const std::string &file_name, pcl::PCLPointCloud2 &cloud,
                             Eigen::Vector4f &origin, Eigen::Quaternionf &orientation, 
                             int &pcd_version, int &data_type, unsigned int &data_idx, const int offset)
+{
+  return (parseHeader (file_name, cloud, origin, orientation, pcd_version, data_type, data_idx, offset, true));
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+int
+pcl::PCDReader::parseHeader (const std::string &file_name, pcl::PCLPointCloud2 &cloud,
+                             Eigen::Vector4f &origin, Eigen::Quaternionf &orientation,
+                             int &pcd_version, int &data_type, unsigned int &data_idx,
+                             const int offset, bool allocate_data)
 {
   if (file_name.empty() || !boost::filesystem::exists (file_name))
   {
@@ -398,7 +429,10 @@ pcl::PCDReader::readHeader (const std::string &file_name, pcl::PCLPointCloud2 &c
   fs.seekg (offset, std::ios::beg);
 
   // Delegate parsing to the istream overload.
-  int result = readHeader (fs, cloud, origin, orientation, pcd_version, data_type, data_idx);
+  int result = parseHeader (fs, cloud, origin, orientation, pcd_version, data_type, data_idx, allocate_data);
+  // The callers expect the start of the data relative to the offset
+  if (result == 0 && data_idx >= static_cast<unsigned int> (offset))
+    data_idx -= offset;
 
   // Close file
   fs.close ();
@@ -419,53 +453,189 @@ pcl::PCDReader::readHeader (const std::string &file_name, pcl::PCLPointCloud2 &c
   return readHeader (file_name, cloud, origin, orientation, pcd_version, data_type, data_idx, offset);
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+namespace
+{
+  /** \brief Convert one token of an ASCII PCD body and copy it into the cloud.
+    *
+    * Plain numbers are converted by pcl::io::detail::parseNumber (), everything else
+    * goes through pcl::detail::copyStringValue (), so that the results are the
+    * same as those of the stream based conversion. 8 bit values are parsed as int.
+    */
+  template <typename Type, typename ParseType = Type> void
+  copyTokenValue (const char *begin, const char *end, pcl::PCLPointCloud2 &cloud,
+                  std::size_t point_index, unsigned int field_idx, unsigned int fields_count,
+                  std::istringstream &is, bool &is_dense)
+  {
+    Type value;
+    ParseType parsed_value;
+    if (pcl::io::detail::parseNumber (begin, end, parsed_value))
+    {
+      value = static_cast<Type> (parsed_value);
+    }
+    else if (std::is_same<Type, ParseType>::value &&
+             boost::iequals (boost::make_iterator_range (begin, end), "nan"))
+    {
+      value = std::numeric_limits<Type>::quiet_NaN ();
+      is_dense = false;
+    }
+    else
+    {
+      // Reset the state left by the previous conversion, or the stream
+      // would fail right away and silently defer to atof ()
+      is.clear ();
+      pcl::detail::copyStringValue<Type> (std::string (begin, end), cloud,
+                                              static_cast<pcl::index_t> (point_index),
+                                              field_idx, fields_count, is);
+      return;
+    }
+
+    memcpy (&cloud.data[point_index * cloud.point_step + cloud.fields[field_idx].offset +
+                        fields_count * sizeof (Type)],
+            reinterpret_cast<char*> (&value), sizeof (Type));
+  }
+
+  /** \brief Split a line in tokens, like boost::trim () followed by boost::split () on
+    * "\t\r " with token compression.
+    */
+  void
+  tokenizeLine (const char *begin, const char *end,
+                std::vector<std::pair<const char*, const char*> > &tokens)
+  {
+    const auto is_space = [] (char c) { return (c == ' ' || (c >= '\t' && c <= '\r')); };
+    const auto is_separator = [] (char c) { return (c == ' ' || c == '\t' || c == '\r'); };
+
+    while (begin != end && is_space (*begin))
+      ++begin;
+    while (end != begin && is_space (*(end - 1)))
+      --end;
+
+    tokens.clear ();
+    const char *token = begin;
+    for (const char *c = begin; c != end; ++c)
+    {
+      if (!is_separator (*c))
+        continue;
+      tokens.emplace_back (token, c);
+      while (c + 1 != end && is_separator (*(c + 1)))
+        ++c;
+      token = c + 1;
+    }
+    tokens.emplace_back (token, end);
+  }
+
+  /** \brief Return the end of the line starting at begin, i.e. the next '\n' or end. */
+  inline const char*
+  findLineEnd (const char *begin, const char *end)
+  {
+    const void *eol = memchr (begin, '\n', end - begin);
+    return (eol ? static_cast<const char*> (eol) : end);
+  }
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 int
-pcl::PCDReader::readBodyASCII (std::istream &fs, pcl::PCLPointCloud2 &cloud, int /*pcd_version*/)
+pcl::PCDReader::readBodyASCII (std::istream &fs, pcl::PCLPointCloud2 &cloud, int pcd_version)
 {
-  // Get the number of points the cloud should have
+  // Gather the non-empty lines of the points, and no more, so that the stream
+  // is left right after the last point like before
   unsigned int nr_points = cloud.width * cloud.height;
+  unsigned int nr_lines = 0;
+  std::string body, line;
+  while (nr_lines < nr_points && !fs.eof ())
+  {
+    getline (fs, line);
+    // Ignore empty lines
+    if (line.empty ())
+      continue;
+    body.append (line).push_back ('\n');
+    ++nr_lines;
+  }
+
+  return (readBodyASCII (body.data (), body.data () + body.size (), cloud, pcd_version));
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+int
+pcl::PCDReader::readBodyASCII (const char *begin, const char *end, pcl::PCLPointCloud2 &cloud,
+                               int /*pcd_version*/)
+{
+  // Get the number of points the cloud should have
+  std::size_t nr_points = static_cast<std::size_t> (cloud.width) * cloud.height;
   // The number of elements each line/point should have
   const unsigned int elems_per_line = std::accumulate (cloud.fields.cbegin (), cloud.fields.cend (), 0u,
                                                        [](const auto& i, const auto& field){ return (i + field.count); });
   PCL_DEBUG ("[pcl::PCDReader::readBodyASCII] Will check that each line in the PCD file has %u elements.\n", elems_per_line);
 
-  // Setting the is_dense property to true by default
-  cloud.is_dense = true;
-
-  unsigned int idx = 0;
-  std::string line;
-  std::vector<std::string> st;
-  std::istringstream is;
-  is.imbue (std::locale::classic ());
+  // Split the body in blocks of whole lines, one per thread. Small bodies are not worth it.
+  const pcl::ThreadReservation reservation (threads_);
+  const unsigned int threads = reservation.getNumberOfThreads ();
+  const std::size_t min_block_size = 1 << 16;
+  const std::size_t body_size = end - begin;
+  std::size_t nr_blocks = std::max<std::size_t> (1, std::min<std::size_t> (threads, body_size / min_block_size));
+  std::vector<const char*> block_begins (nr_blocks + 1, end);
+  block_begins[0] = begin;
+  for (std::size_t b = 1; b < nr_blocks; ++b)
+  {
+    const char *split = std::max (begin + b * (body_size / nr_blocks), block_begins[b - 1]);
+    const char *eol = findLineEnd (split, end);
+    block_begins[b] = (eol == end) ? end : eol + 1;
+  }
 
-  try
+  // Count the non-empty lines of every block, which gives the index of its first point
+  std::vector<std::size_t> block_points (nr_blocks + 1, 0);
+#pragma omp parallel for \
+  default(none) \
+  shared(block_begins, block_points, nr_blocks) \
+  num_threads(threads)
+  for (std::ptrdiff_t b = 0; b < static_cast<std::ptrdiff_t> (nr_blocks); ++b)
   {
-    while (idx < nr_points && !fs.eof ())
+    const char *block_end = block_begins[b + 1];
+    for (const char *line = block_begins[b]; line != block_end; )
     {
-      getline (fs, line);
+      const char *eol = findLineEnd (line, block_end);
+      if (eol != line)
+        ++block_points[b + 1];
+      line = (eol == block_end) ? block_end : eol + 1;
+    }
+  }
+  std::partial_sum (block_points.begin (), block_points.end (), block_points.begin ());
+
+  // Parse the blocks
+  bool is_dense = true;
+#pragma omp parallel for \
+  default(none) \
+  shared(block_begins, block_points, cloud, elems_per_line, nr_blocks, nr_points) \
+  reduction(&&:is_dense) \
+  num_threads(threads)
+  for (std::ptrdiff_t b = 0; b < static_cast<std::ptrdiff_t> (nr_blocks); ++b)
+  {
+    std::vector<std::pair<const char*, const char*> > st;
+    std::istringstream is;
+    is.imbue (std::locale::classic ());
+
+    std::size_t idx = block_points[b];
+    const char *block_end = block_begins[b + 1];
+    for (const char *line = block_begins[b]; line != block_end && idx < nr_points; )
+    {
+      const char *eol = findLineEnd (line, block_end);
+      const char *line_begin = line;
+      line = (eol == block_end) ? block_end : eol + 1;
       // Ignore empty lines
-      if (line.empty())
+      if (eol == line_begin)
         continue;
 
       // Tokenize the line
-      boost::trim (line);
-      boost::split (st, line, boost::is_any_of ("\t\r "), boost::token_compress_on);
+      tokenizeLine (line_begin, eol, st);
 
       if (st.size () != elems_per_line) // If this is not checked, an exception might occur while accessing st
       {
-        PCL_WARN ("[pcl::PCDReader::readBodyASCII] Possibly malformed PCD file: point number %u has %zu elements, but should have %u\n",
+        PCL_WARN ("[pcl::PCDReader::readBodyASCII] Possibly malformed PCD file: point number %zu has %zu elements, but should have %u\n",
                   idx+1, st.size (), elems_per_line);
         ++idx; // Skip this line/point, but read all others
         continue;
       }
 
-      if (idx >= nr_points)
-      {
-        PCL_WARN ("[pcl::PCDReader::read] input has more points (%d) than advertised (%d)!\n", idx, nr_points);
-        break;
-      }
-
       std::size_t total = 0;
       // Copy data
       for (unsigned int d = 0; d < static_cast<unsigned int> (cloud.fields.size ()); ++d)
@@ -478,54 +648,55 @@ pcl::PCDReader::readBodyASCII (std::istream &fs, pcl::PCLPointCloud2 &cloud, int
         }
         for (uindex_t c = 0; c < cloud.fields[d].count; ++c)
         {
+          const char *token_begin = st[total + c].first, *token_end = st[total + c].second;
           switch (cloud.fields[d].datatype)
           {
             case pcl::PCLPointField::INT8:
             {
-              copyStringValue<pcl::traits::asType<pcl::PCLPointField::INT8>::type> (
-                  st.at (total + c), cloud, idx, d, c, is);
+              copyTokenValue<pcl::traits::asType<pcl::PCLPointField::INT8>::type, int> (
+                  token_begin, token_end, cloud, idx, d, c, is, is_dense);
               break;
             }
             case pcl::PCLPointField::UINT8:
             {
-              copyStringValue<pcl::traits::asType<pcl::PCLPointField::UINT8>::type> (
-                  st.at (total + c), cloud, idx, d, c, is);
+              copyTokenValue<pcl::traits::asType<pcl::PCLPointField::UINT8>::type, int> (
+                  token_begin, token_end, cloud, idx, d, c, is, is_dense);
               break;
             }
             case pcl::PCLPointField::INT16:
             {
-              copyStringValue<pcl::traits::asType<pcl::PCLPointField::INT16>::type> (
-                  st.at (total + c), cloud, idx, d, c, is);
+              copyTokenValue<pcl::traits::asType<pcl::PCLPointField::INT16>::type> (
+                  token_begin, token_end, cloud, idx, d, c, is, is_dense);
               break;
             }
             case pcl::PCLPointField::UINT16:
             {
-              copyStringValue<pcl::traits::asType<pcl::PCLPointField::UINT16>::type> (
-                  st.at (total + c), cloud, idx, d, c, is);
+              copyTokenValue<pcl::traits::asType<pcl::PCLPointField::UINT16>::type> (
+                  token_begin, token_end, cloud, idx, d, c, is, is_dense);
               break;
             }
             case pcl::PCLPointField::INT32:
             {
-              copyStringValue<pcl::traits::asType<pcl::PCLPointField::INT32>::type> (
-                  st.at (total + c), cloud, idx, d, c, is);
+              copyTokenValue<pcl::traits::asType<pcl::PCLPointField::INT32>::type> (
+                  token_begin, token_end, cloud, idx, d, c, is, is_dense);
               break;
             }
             case pcl::PCLPointField::UINT32:
             {
-              copyStringValue<pcl::traits::asType<pcl::PCLPointField::UINT32>::type> (
-                  st.at (total + c), cloud, idx, d, c, is);
+              copyTokenValue<pcl::traits::asType<pcl::PCLPointField::UINT32>::type> (
+                  token_begin, token_end, cloud, idx, d, c, is, is_dense);
               break;
             }
             case pcl::PCLPointField::FLOAT32:
             {
-              copyStringValue<pcl::traits::asType<pcl::PCLPointField::FLOAT32>::type> (
-                  st.at (total + c), cloud, idx, d, c, is);
+              copyTokenValue<pcl::traits::asType<pcl::PCLPointField::FLOAT32>::type> (
+                  token_begin, token_end, cloud, idx, d, c, is, is_dense);
               break;
             }
             case pcl::PCLPointField::FLOAT64:
             {
-              copyStringValue<pcl::traits::asType<pcl::PCLPointField::FLOAT64>::type> (
-                  st.at (total + c), cloud, idx, d, c, is);
+              copyTokenValue<pcl::traits::asType<pcl::PCLPointField::FLOAT64>::type> (
+                  token_begin, token_end, cloud, idx, d, c, is, is_dense);
               break;
             }
             default:
@@ -538,21 +709,90 @@ pcl::PCDReader::readBodyASCII (std::istream &fs, pcl::PCLPointCloud2 &cloud, int
       idx++;
     }
   }
-  catch (const char *exception)
-  {
-    PCL_ERROR ("[pcl::PCDReader::read] %s\n", exception);
-    return (-1);
-  }
+  cloud.is_dense = is_dense;
 
-  if (idx != nr_points)
+  const std::size_t nr_read = std::min (block_points.back (), nr_points);
+  if (nr_read != nr_points)
   {
-    PCL_ERROR ("[pcl::PCDReader::read] Number of points read (%d) is different than expected (%d)\n", idx, nr_points);
+    PCL_ERROR ("[pcl::PCDReader::read] Number of points read (%zu) is different than expected (%zu)\n", nr_read, nr_points);
     return (-1);
   }
 
   return (0);
 }
 
+///////////////////////////////////////////////////////////////////////////////////////////
+namespace
+{
+  /** \brief Go over each field of a binary cloud and set cloud.is_dense to false if it has NaN/Inf values. */
+  void
+  checkFiniteness (pcl::PCLPointCloud2 &cloud)
+  {
+    int point_size = static_cast<int> (cloud.data.size () / (cloud.height * cloud.width));
+    // Once copied, we need to go over each field and check if it has NaN/Inf values and assign cloud.is_dense to true or false
+    for (pcl::uindex_t i = 0; i < cloud.width * cloud.height; ++i)
+    {
+      for (unsigned int d = 0; d < static_cast<unsigned int> (cloud.fields.size ()); ++d)
+      {
+        for (pcl::uindex_t c = 0; c < cloud.fields[d].count; ++c)
+        {
+          switch (cloud.fields[d].datatype)
+          {
+            case pcl::PCLPointField::INT8:
+            {
+              if (!pcl::isValueFinite<pcl::traits::asType<pcl::PCLPointField::INT8>::type> (cloud, i, point_size, d, c))
+                cloud.is_dense = false;
+              break;
+            }
+            case pcl::PCLPointField::UINT8:
+            {
+              if (!pcl::isValueFinite<pcl::traits::asType<pcl::PCLPointField::UINT8>::type> (cloud, i, point_size, d, c))
+                cloud.is_dense = false;
+              break;
+            }
+            case pcl::PCLPointField::INT16:
+            {
+              if (!pcl::isValueFinite<pcl::traits::asType<pcl::PCLPointField::INT16>::type> (cloud, i, point_size, d, c))
+                cloud.is_dense = false;
+              break;
+            }
+            case pcl::PCLPointField::UINT16:
+            {
+              if (!pcl::isValueFinite<pcl::traits::asType<pcl::PCLPointField::UINT16>::type> (cloud, i, point_size, d, c))
+                cloud.is_dense = false;
+              break;
+            }
+            case pcl::PCLPointField::INT32:
+            {
+              if (!pcl::isValueFinite<pcl::traits::asType<pcl::PCLPointField::INT32>::type> (cloud, i, point_size, d, c))
+                cloud.is_dense = false;
+              break;
+            }
+            case pcl::PCLPointField::UINT32:
+            {
+              if (!pcl::isValueFinite<pcl::traits::asType<pcl::PCLPointField::UINT32>::type> (cloud, i, point_size, d, c))
+                cloud.is_dense = false;
+              break;
+            }
+            case pcl::PCLPointField::FLOAT32:
+            {
+              if (!pcl::isValueFinite<pcl::traits::asType<pcl::PCLPointField::FLOAT32>::type> (cloud, i, point_size, d, c))
+                cloud.is_dense = false;
+              break;
+            }
+            case pcl::PCLPointField::FLOAT64:
+            {
+              if (!pcl::isValueFinite<pcl::traits::asType<pcl::PCLPointField::FLOAT64>::type> (cloud, i, point_size, d, c))
+                cloud.is_dense = false;
+              break;
+            }
+          }
+        }
+      }
+    }
+  }
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 int
 pcl::PCDReader::readBodyBinary (const unsigned char *map, pcl::PCLPointCloud2 &cloud,
@@ -628,69 +868,108 @@ pcl::PCDReader::readBodyBinary (const unsigned char *map, pcl::PCLPointCloud2 &c
     memcpy (&cloud.data[0], &map[0] + data_idx, cloud.data.size ());
 
   // Extra checks (not needed for ASCII)
-  int point_size = static_cast<int> (cloud.data.size () / (cloud.height * cloud.width));
-  // Once copied, we need to go over each field and check if it has NaN/Inf values and assign cloud.is_dense to true or false
-  for (uindex_t i = 0; i < cloud.width * cloud.height; ++i)
+  checkFiniteness (cloud);
+
+  return (0);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+void
+pcl::PCDReader::setNumberOfThreads (unsigned int nr_threads)
+{
+  // 0 is resolved against the budget of pcl::ExecutionContext at compute time
+  threads_ = nr_threads;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+int
+pcl::PCDReader::readBodyBinaryChunked (const unsigned char *map, pcl::PCLPointCloud2 &cloud,
+                                       std::size_t data_idx)
+{
+  // Setting the is_dense property to true by default
+  cloud.is_dense = true;
+
+  std::uint32_t version = 0, chunk_points = 0, nr_chunks = 0;
+  memcpy (&version, &map[data_idx + 0], 4);
+  memcpy (&chunk_points, &map[data_idx + 4], 4);
+  memcpy (&nr_chunks, &map[data_idx + 8], 4);
+
+  const std::size_t nr_points = static_cast<std::size_t> (cloud.width) * cloud.height;
+  if (version != 1 || chunk_points == 0 ||
+      nr_chunks != (nr_points + chunk_points - 1) / chunk_points)
   {
-    for (unsigned int d = 0; d < static_cast<unsigned int> (cloud.fields.size ()); ++d)
+    PCL_ERROR ("[pcl::PCDReader::read] Invalid chunk index (version %u, %u chunks of %u points)!\n",
+               version, nr_chunks, chunk_points);
+    return (-1);
+  }
+
+  // Sizes and offsets of the chunks
+  std::vector<std::uint32_t> chunk_sizes (2 * nr_chunks);
+  memcpy (chunk_sizes.data (), &map[data_idx + 12], chunk_sizes.size () * sizeof (std::uint32_t));
+  std::vector<std::size_t> chunk_offsets (nr_chunks);
+  std::size_t chunk_offset = data_idx + 12 + chunk_sizes.size () * sizeof (std::uint32_t);
+  for (std::size_t c = 0; c < nr_chunks; ++c)
+  {
+    chunk_offsets[c] = chunk_offset;
+    chunk_offset += chunk_sizes[2 * c];
+  }
+
+  // Get the fields sizes
+  std::vector<pcl::PCLPointField> fields;
+  std::vector<std::size_t> fields_sizes;
+  std::size_t fsize = 0;
+  for (const auto &field : cloud.fields)
+  {
+    if (field.name == "_")
+      continue;
+    fields_sizes.push_back (field.count * pcl::getFieldSize (field.datatype));
+    fsize += fields_sizes.back ();
+    fields.push_back (field);
+  }
+
+  const pcl::ThreadReservation reservation (threads_);
+  const unsigned int threads = reservation.getNumberOfThreads ();
+  // Decompress every chunk and unpack its xxyyzz planes into the points of the chunk
+  int nr_failed = 0;
+  std::uint8_t *cloud_data = cloud.data.data ();
+  std::size_t point_step = cloud.point_step;
+#pragma omp parallel for \
+  default(none) \
+  shared(chunk_offsets, chunk_points, chunk_sizes, cloud_data, fields, fields_sizes, fsize, map, nr_chunks, nr_failed, nr_points, point_step) \
+  schedule(dynamic) \
+  num_threads(threads)
+  for (std::ptrdiff_t c = 0; c < static_cast<std::ptrdiff_t> (nr_chunks); ++c)
+  {
+    std::size_t begin = c * static_cast<std::size_t> (chunk_points);
+    std::size_t count = std::min<std::size_t> (chunk_points, nr_points - begin);
+    std::size_t data_size = count * fsize;
+    std::vector<char> buf (data_size);
+    if (chunk_sizes[2 * c + 1] != data_size ||
+        pcl::lzfDecompress (&map[chunk_offsets[c]], chunk_sizes[2 * c], buf.data (),
+                            static_cast<unsigned int> (data_size)) != data_size)
     {
-      for (uindex_t c = 0; c < cloud.fields[d].count; ++c)
-      {
-        switch (cloud.fields[d].datatype)
-        {
-          case pcl::PCLPointField::INT8:
-          {
-            if (!isValueFinite<pcl::traits::asType<pcl::PCLPointField::INT8>::type> (cloud, i, point_size, d, c))
-              cloud.is_dense = false;
-            break;
-          }
-          case pcl::PCLPointField::UINT8:
-          {
-            if (!isValueFinite<pcl::traits::asType<pcl::PCLPointField::UINT8>::type> (cloud, i, point_size, d, c))
-              cloud.is_dense = false;
-            break;
-          }
-          case pcl::PCLPointField::INT16:
-          {
-            if (!isValueFinite<pcl::traits::asType<pcl::PCLPointField::INT16>::type> (cloud, i, point_size, d, c))
-              cloud.is_dense = false;
-            break;
-          }
-          case pcl::PCLPointField::UINT16:
-          {
-            if (!isValueFinite<pcl::traits::asType<pcl::PCLPointField::UINT16>::type> (cloud, i, point_size, d, c))
-              cloud.is_dense = false;
-            break;
-          }
-          case pcl::PCLPointField::INT32:
-          {
-            if (!isValueFinite<pcl::traits::asType<pcl::PCLPointField::INT32>::type> (cloud, i, point_size, d, c))
-              cloud.is_dense = false;
-            break;
-          }
-          case pcl::PCLPointField::UINT32:
-          {
-            if (!isValueFinite<pcl::traits::asType<pcl::PCLPointField::UINT32>::type> (cloud, i, point_size, d, c))
-              cloud.is_dense = false;
-            break;
-          }
-          case pcl::PCLPointField::FLOAT32:
-          {
-            if (!isValueFinite<pcl::traits::asType<pcl::PCLPointField::FLOAT32>::type> (cloud, i, point_size, d, c))
-              cloud.is_dense = false;
-            break;
-          }
-          case pcl::PCLPointField::FLOAT64:
-          {
-            if (!isValueFinite<pcl::traits::asType<pcl::PCLPointField::FLOAT64>::type> (cloud, i, point_size, d, c))
-              cloud.is_dense = false;
-            break;
-          }
-        }
-      }
+#pragma omp atomic
+      ++nr_failed;
+      continue;
+    }
+
+    const char *plane = buf.data ();
+    for (std::size_t j = 0; j < fields.size (); ++j)
+    {
+      std::uint8_t *out = cloud_data + begin * point_step + fields[j].offset;
+      for (std::size_t i = 0; i < count; ++i, plane += fields_sizes[j], out += point_step)
+        memcpy (out, plane, fields_sizes[j]);
     }
   }
 
+  if (nr_failed > 0)
+  {
+    PCL_ERROR ("[pcl::PCDReader::read] Decompression of %d chunks failed. Data corruption?\n", nr_failed);
+    return (-1);
+  }
+
+  checkFiniteness (cloud);
+
   return (0);
 }
 
@@ -717,29 +996,7 @@ pcl::PCDReader::read (const std::string &file_name, pcl::PCLPointCloud2 &cloud,
   if (res < 0)
     return (res);
 
-  // if ascii
-  if (data_type == 0)
-  {
-    // Re-open the file (readHeader closes it)
-    std::ifstream fs;
-    fs.open (file_name.c_str ());
-    if (!fs.is_open () || fs.fail ())
-    {
-      PCL_ERROR ("[pcl::PCDReader::read] Could not open file %s.\n", file_name.c_str ());
-      return (-1);
-    }
-
-    fs.seekg (data_idx + offset);
-
-    // Read the rest of the file
-    res = readBodyASCII (fs, cloud, pcd_version);
-
-    // Close file
-    fs.close ();
-  }
-  else
-  /// ---[ Binary mode only
-  /// We must re-open the file and read with mmap () for binary
+  /// We must re-open the file and read with mmap ()
   {
     // Open for reading
     int fd = io::raw_open (file_name.c_str (), O_RDONLY);
@@ -754,7 +1011,12 @@ pcl::PCDReader::read (const std::string &file_name, pcl::PCLPointCloud2 &cloud,
     io::raw_lseek (fd, 0, SEEK_SET);
 
     std::size_t mmap_size = offset + data_idx;   // ...because we mmap from the start of the file.
-    if (data_type == 2)
+    if (data_type == 0)
+    {
+      // The text body runs until the end of the file
+      mmap_size = file_size;
+    }
+    else if (data_type == 2)
     {
       // Seek to real start of data.
       long result = io::raw_lseek (fd, offset + data_idx, SEEK_SET);
@@ -783,6 +1045,42 @@ pcl::PCDReader::read (const std::string &file_name, pcl::PCLPointCloud2 &cloud,
       // Reset position
       io::raw_lseek (fd, 0, SEEK_SET);
     }
+    else if (data_type == 3)
+    {
+      // Read the chunk index to compute how much must be mapped
+      std::uint32_t preamble[3] = {0, 0, 0};
+      if (io::raw_lseek (fd, offset + data_idx, SEEK_SET) < 0 ||
+          io::raw_read (fd, preamble, sizeof (preamble)) != static_cast<int> (sizeof (preamble)))
+      {
+        io::raw_close (fd);
+        PCL_ERROR ("[pcl::PCDReader::read] Error reading the chunk index!\n");
+        return (-1);
+      }
+      // Validate the chunk count before the index is allocated, a corrupted count would
+      // otherwise request up to 32 GB
+      const std::size_t nr_points = static_cast<std::size_t> (cloud.width) * cloud.height;
+      const std::size_t index_size = 2 * static_cast<std::size_t> (preamble[2]) * sizeof (std::uint32_t);
+      if (preamble[1] == 0 || preamble[2] != (nr_points + preamble[1] - 1) / preamble[1] ||
+          offset + data_idx + sizeof (preamble) + index_size > file_size)
+      {
+        io::raw_close (fd);
+        PCL_ERROR ("[pcl::PCDReader::read] Invalid chunk index (%u chunks of %u points)!\n", preamble[2], preamble[1]);
+        return (-1);
+      }
+      std::vector<std::uint32_t> chunk_sizes (2 * static_cast<std::size_t> (preamble[2]));
+      if (io::raw_read (fd, chunk_sizes.data (), index_size) != static_cast<int> (index_size))
+      {
+        io::raw_close (fd);
+        PCL_ERROR ("[pcl::PCDReader::read] Error reading the chunk index!\n");
+        return (-1);
+      }
+      mmap_size += sizeof (preamble) + index_size;
+      for (std::size_t c = 0; c < chunk_sizes.size (); c += 2)
+        mmap_size += chunk_sizes[c];
+
+      // Reset position
+      io::raw_lseek (fd, 0, SEEK_SET);
+    }
     else
     {
       mmap_size += cloud.data.size ();
@@ -815,12 +1113,18 @@ pcl::PCDReader::read (const std::string &file_name, pcl::PCLPointCloud2 &cloud,
     if (map == reinterpret_cast<unsigned char*> (-1))    // MAP_FAILED
     {
       io::raw_close (fd);
-      PCL_ERROR ("[pcl::PCDReader::read] Error preparing mmap for binary PCD file.\n");
+      PCL_ERROR ("[pcl::PCDReader::read] Error preparing mmap for PCD file.\n");
       return (-1);
     }
 #endif
 
-    res = readBodyBinary (map, cloud, pcd_version, data_type == 2, offset + data_idx);
+    if (data_type == 0)
+      res = readBodyASCII (reinterpret_cast<const char*> (map) + offset + data_idx,
+                           reinterpret_cast<const char*> (map) + file_size, cloud, pcd_version);
+    else if (data_type == 3)
+      res = readBodyBinaryChunked (map, cloud, offset + data_idx);
+    else
+      res = readBodyBinary (map, cloud, pcd_version, data_type == 2, offset + data_idx);
 
     // Unmap the pages of memory
 #ifdef _WIN32
@@ -843,6 +1147,204 @@ pcl::PCDReader::read (const std::string &file_name, pcl::PCLPointCloud2 &cloud,
   return res;
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+int
+pcl::PCDReader::readBodyBinary (const std::string &file_name, const pcl::PCLPointCloud2 &cloud,
+                                std::size_t data_offset, bool &is_dense,
+                                const std::function<void (const std::uint8_t*, std::size_t, std::size_t)> &consume)
+{
+  const std::size_t nr_points = static_cast<std::size_t> (cloud.width) * cloud.height;
+  const std::size_t data_size = nr_points * cloud.point_step;
+
+  int fd = io::raw_open (file_name.c_str (), O_RDONLY);
+  if (fd == -1)
+  {
+    PCL_ERROR ("[pcl::PCDReader::read] Failure to open file %s\n", file_name.c_str () );
+    return (-1);
+  }
+
+  const std::size_t file_size = io::raw_lseek (fd, 0, SEEK_END);
+  if (data_offset + data_size > file_size)
+  {
+    io::raw_close (fd);
+    PCL_ERROR ("[pcl::PCDReader::read] Corrupted PCD file. The file is smaller than expected!\n");
+    return (-1);
+  }
+
+  if (io::raw_lseek (fd, data_offset, SEEK_SET) < 0)
+  {
+    io::raw_close (fd);
+    PCL_ERROR ("[pcl::PCDReader::read] lseek errno: %d strerror: %s\n", errno, strerror (errno));
+    PCL_ERROR ("[pcl::PCDReader::read] Error during lseek ()!\n");
+    return (-1);
+  }
+
+  // Stream the body through a small buffer of whole points, so the points are copied only
+  // once, from the buffer into their final storage
+  const std::size_t chunk_points = std::max<std::size_t> (1, (std::size_t (1) << 20) / cloud.point_step);
+  std::vector<std::uint8_t> buf (std::min (nr_points, chunk_points) * cloud.point_step);
+
+  is_dense = true;
+  for (std::size_t begin = 0; begin < nr_points; begin += chunk_points)
+  {
+    const std::size_t count = std::min (chunk_points, nr_points - begin);
+    const std::size_t size = count * cloud.point_step;
+    for (std::size_t done = 0; done < size; )
+    {
+      const auto num_read = io::raw_read (fd, &buf[done], size - done);
+      if (num_read <= 0)
+      {
+        io::raw_close (fd);
+        PCL_ERROR ("[pcl::PCDReader::read] read errno: %d strerror: %s\n", errno, strerror (errno));
+        PCL_ERROR ("[pcl::PCDReader::read] Error during read()!\n");
+        return (-1);
+      }
+      done += static_cast<std::size_t> (num_read);
+    }
+
+    // Check the floating point fields for NaN/Inf values, like readBodyBinary does
+    for (const auto &field : cloud.fields)
+    {
+      if (!is_dense)
+        break;
+      if (field.datatype != pcl::PCLPointField::FLOAT32 && field.datatype != pcl::PCLPointField::FLOAT64)
+        continue;
+      for (std::size_t i = 0; i < size && is_dense; i += cloud.point_step)
+      {
+        for (uindex_t c = 0; c < field.count && is_dense; ++c)
+        {
+          if (field.datatype == pcl::PCLPointField::FLOAT32)
+          {
+            float value;
+            memcpy (&value, &buf[i + field.offset + c * sizeof (float)], sizeof (float));
+            is_dense = std::isfinite (value);
+          }
+          else
+          {
+            double value;
+            memcpy (&value, &buf[i + field.offset + c * sizeof (double)], sizeof (double));
+            is_dense = std::isfinite (value);
+          }
+        }
+      }
+    }
+
+    consume (buf.data (), begin, count);
+  }
+
+  io::raw_close (fd);
+  return (0);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+namespace
+{
+  /** \brief Read-only stream buffer over a block of memory, so that the header of a PCD file in memory can be
+    * parsed by the stream based parser. Supports the seeking needed for tellg ().
+    */
+  class MemoryStreamBuffer : public std::streambuf
+  {
+    public:
+      MemoryStreamBuffer (const char *begin, const char *end)
+      {
+        char *b = const_cast<char*> (begin);
+        setg (b, b, const_cast<char*> (end));
+      }
+
+    protected:
+      pos_type
+      seekoff (off_type off, std::ios_base::seekdir dir, std::ios_base::openmode which) override
+      {
+        if (!(which & std::ios_base::in))
+          return (pos_type (off_type (-1)));
+        const off_type base = (dir == std::ios_base::beg ? 0 : (dir == std::ios_base::cur ? gptr () - eback () : egptr () - eback ()));
+        const off_type target = base + off;
+        if (target < 0 || target > egptr () - eback ())
+          return (pos_type (off_type (-1)));
+        setg (eback (), eback () + target, egptr ());
+        return (pos_type (target));
+      }
+
+      pos_type
+      seekpos (pos_type pos, std::ios_base::openmode which) override
+      {
+        return (seekoff (off_type (pos), std::ios_base::beg, which));
+      }
+  };
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+int
+pcl::PCDReader::read (const unsigned char *data, std::size_t size, pcl::PCLPointCloud2 &cloud,
+                      Eigen::Vector4f &origin, Eigen::Quaternionf &orientation, int &pcd_version)
+{
+  if (!data || size == 0)
+  {
+    PCL_ERROR ("[pcl::PCDReader::read] Empty PCD data.\n");
+    return (-1);
+  }
+
+  int data_type;
+  unsigned int data_idx;
+  const char *begin = reinterpret_cast<const char*> (data);
+  {
+    MemoryStreamBuffer buffer (begin, begin + size);
+    std::istream stream (&buffer);
+    const int res = readHeader (stream, cloud, origin, orientation, pcd_version, data_type, data_idx);
+    if (res < 0)
+      return (res);
+  }
+
+  // Check that the body is complete, as the file based reader does before mapping it
+  std::size_t body_size = 0;
+  if (data_type == 2)
+  {
+    if (data_idx + 8 > size)
+      body_size = size;
+    else
+    {
+      unsigned int compressed_size = 0;
+      std::memcpy (&compressed_size, data + data_idx, 4);
+      body_size = 8 + static_cast<std::size_t> (compressed_size);
+    }
+  }
+  else if (data_type == 3)
+  {
+    std::uint32_t preamble[3] = {0, 0, 0};
+    const std::size_t index_begin = data_idx + sizeof (preamble);
+    if (index_begin > size)
+      body_size = size;
+    else
+    {
+      std::memcpy (preamble, data + data_idx, sizeof (preamble));
+      const std::size_t index_size = 2 * static_cast<std::size_t> (preamble[2]) * sizeof (std::uint32_t);
+      body_size = sizeof (preamble) + index_size;
+      if (index_begin + index_size <= size)
+      {
+        for (std::size_t c = 0; c < preamble[2]; ++c)
+        {
+          std::uint32_t chunk_size;
+          std::memcpy (&chunk_size, data + index_begin + 2 * c * sizeof (std::uint32_t), sizeof (chunk_size));
+          body_size += chunk_size;
+        }
+      }
+    }
+  }
+  else if (data_type != 0)
+    body_size = cloud.data.size ();
+  if (data_idx + body_size > size)
+  {
+    PCL_ERROR ("[pcl::PCDReader::read] Corrupted PCD data. The data is smaller than expected!\n");
+    return (-1);
+  }
+
+  if (data_type == 0)
+    return (readBodyASCII (begin + data_idx, begin + size, cloud, pcd_version));
+  if (data_type == 3)
+    return (readBodyBinaryChunked (data, cloud, data_idx));
+  return (readBodyBinary (data, cloud, pcd_version, data_type == 2, data_idx));
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 int
 pcl::PCDReader::read (const std::string &file_name, pcl::PCLPointCloud2 &cloud, const int offset)
@@ -1361,6 +1863,13 @@ pcl::PCDWriter::writeBinaryCompressed (std::ostream &os, const pcl::PCLPointClou
     return (-1);
   }
 
+  if (compression_chunk_size_ > 0)
+  {
+    os << "DATA chunked_binary_compressed\n";
+    return (writeBinaryCompressedChunks (os, cloud.data.data (), cloud.width * cloud.height,
+                                         cloud.point_step, cloud.fields));
+  }
+
   std::size_t fsize = 0;
   std::size_t data_size = 0;
   std::size_t nri = 0;
@@ -1450,11 +1959,169 @@ pcl::PCDWriter::writeBinaryCompressed (std::ostream &os, const pcl::PCLPointClou
   return (os ? 0 : -1);
 }
 
+///////////////////////////////////////////////////////////////////////////////////////////
+void
+pcl::PCDWriter::setNumberOfThreads (unsigned int nr_threads)
+{
+  // 0 is resolved against the budget of pcl::ExecutionContext at compute time
+  threads_ = nr_threads;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+int
+pcl::PCDWriter::writeBinaryCompressedChunks (std::ostream &os, const std::uint8_t *data,
+                                             std::size_t nr_points, std::size_t point_step,
+                                             const std::vector<pcl::PCLPointField> &cloud_fields)
+{
+  // Compute the total size of the fields
+  std::vector<pcl::PCLPointField> fields;
+  std::vector<std::size_t> fields_sizes;
+  std::size_t fsize = 0;
+  for (const auto &field : cloud_fields)
+  {
+    if (field.name == "_")
+      continue;
+    fields_sizes.push_back (field.count * pcl::getFieldSize (field.datatype));
+    fsize += fields_sizes.back ();
+    fields.push_back (field);
+  }
+
+  // Every chunk stores its compressed and uncompressed size in 32 bit integers
+  std::size_t chunk_points = compression_chunk_size_;
+  std::size_t nr_chunks = (nr_points + chunk_points - 1) / chunk_points;
+  if (std::min (chunk_points, nr_points) * fsize * 3 / 2 + 16 > std::numeric_limits<std::uint32_t>::max () ||
+      nr_chunks > std::numeric_limits<std::uint32_t>::max ())
+  {
+    PCL_ERROR ("[pcl::PCDWriter::writeBinaryCompressed] The compression chunk size of %u points is too large for the fields of the cloud!\n",
+               compression_chunk_size_);
+    return (-2);
+  }
+
+  // Version, chunk size and number of chunks, followed by a placeholder for the chunk index
+  const std::uint32_t preamble[3] = {1, static_cast<std::uint32_t> (chunk_points), static_cast<std::uint32_t> (nr_chunks)};
+  os.write (reinterpret_cast<const char*> (preamble), sizeof (preamble));
+  const auto index_pos = os.tellp ();
+  if (index_pos < 0)
+  {
+    PCL_ERROR ("[pcl::PCDWriter::writeBinaryCompressed] Chunked compression needs a seekable output stream!\n");
+    return (-1);
+  }
+  std::vector<std::uint32_t> chunk_sizes (2 * nr_chunks, 0);
+  os.write (reinterpret_cast<const char*> (chunk_sizes.data ()), chunk_sizes.size () * sizeof (std::uint32_t));
+
+  // Compress one chunk per thread at a time, and write the chunks in order once they are done
+  const pcl::ThreadReservation reservation (threads_);
+  const unsigned int threads = reservation.getNumberOfThreads ();
+  std::size_t batch_size = threads;
+  std::vector<std::vector<char>> compressed (batch_size);
+  int nr_failed = 0;
+  for (std::size_t batch = 0; batch < nr_chunks && os; batch += batch_size)
+  {
+    std::ptrdiff_t nr_batch = static_cast<std::ptrdiff_t> (std::min (batch_size, nr_chunks - batch));
+#pragma omp parallel for \
+  default(none) \
+  shared(batch, chunk_points, chunk_sizes, compressed, data, fields, fields_sizes, fsize, nr_batch, nr_failed, nr_points, point_step) \
+  num_threads(threads)
+    for (std::ptrdiff_t k = 0; k < nr_batch; ++k)
+    {
+      // Convert the XYZRGBXYZRGB structure of the chunk to XXYYZZRGBRGB, as for the single block format
+      std::size_t c = batch + k;
+      std::size_t begin = c * chunk_points;
+      std::size_t count = std::min (chunk_points, nr_points - begin);
+      std::vector<char> planes (count * fsize);
+      char *plane = planes.data ();
+      for (std::size_t j = 0; j < fields.size (); ++j)
+      {
+        const std::uint8_t *in = data + begin * point_step + fields[j].offset;
+        for (std::size_t i = 0; i < count; ++i, plane += fields_sizes[j], in += point_step)
+          memcpy (plane, in, fields_sizes[j]);
+      }
+
+      compressed[k].resize (planes.size () * 3 / 2 + 16);
+      chunk_sizes[2 * c] = pcl::lzfCompress (planes.data (), static_cast<unsigned int> (planes.size ()),
+                                             compressed[k].data (), static_cast<unsigned int> (compressed[k].size ()));
+      chunk_sizes[2 * c + 1] = static_cast<std::uint32_t> (planes.size ());
+      if (chunk_sizes[2 * c] == 0)
+      {
+#pragma omp atomic
+        ++nr_failed;
+      }
+    }
+
+    if (nr_failed > 0)
+    {
+      PCL_ERROR ("[pcl::PCDWriter::writeBinaryCompressed] Error during compression!\n");
+      return (-1);
+    }
+    for (std::ptrdiff_t k = 0; k < nr_batch; ++k)
+      os.write (compressed[k].data (), chunk_sizes[2 * (batch + k)]);
+  }
+
+  // Fill in the chunk index
+  const auto end_pos = os.tellp ();
+  os.seekp (index_pos);
+  os.write (reinterpret_cast<const char*> (chunk_sizes.data ()), chunk_sizes.size () * sizeof (std::uint32_t));
+  os.seekp (end_pos);
+  os.flush ();
+
+  return (os ? 0 : -1);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+int
+pcl::PCDWriter::writeBinaryCompressedChunks (const std::string &file_name, const std::string &header,
+                                             const std::uint8_t *data, std::size_t nr_points,
+                                             std::size_t point_step,
+                                             const std::vector<pcl::PCLPointField> &fields)
+{
+  std::ofstream fs;
+  fs.open (file_name.c_str (), std::ios::binary | std::ios::trunc);
+  if (!fs.is_open () || fs.fail ())
+  {
+    PCL_ERROR ("[pcl::PCDWriter::writeBinaryCompressed] Error during open (%s)!\n", file_name.c_str ());
+    return (-1);
+  }
+
+  // Mandatory lock file
+  boost::interprocess::file_lock file_lock;
+  setLockingPermissions (file_name, file_lock);
+
+  fs.imbue (std::locale::classic ());
+  fs << header << "DATA chunked_binary_compressed\n";
+  int status = writeBinaryCompressedChunks (fs, data, nr_points, point_step, fields);
+
+  // Close file
+  fs.close ();
+  resetLockingPermissions (file_name, file_lock);
+
+  if (status == 0 && fs.fail ())
+  {
+    PCL_ERROR ("[pcl::PCDWriter::writeBinaryCompressed] Error during write (%s)!\n", file_name.c_str ());
+    return (-1);
+  }
+  return (status);
+}
+
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 int
 pcl::PCDWriter::writeBinaryCompressed (const std::string &file_name, const pcl::PCLPointCloud2 &cloud,
                                        const Eigen::Vector4f &origin, const Eigen::Quaternionf &orientation)
 {
+  // Stream the chunks to disk while they are compressed
+  if (compression_chunk_size_ > 0)
+  {
+    if (cloud.data.empty ())
+    {
+      PCL_ERROR ("[pcl::PCDWriter::writeBinaryCompressed] Input point cloud has no data!\n");
+      return (-1);
+    }
+    std::ostringstream oss;
+    if (generateHeaderBinaryCompressed (oss, cloud, origin, orientation))
+      return (-1);
+    return (writeBinaryCompressedChunks (file_name, oss.str (), cloud.data.data (),
+                                         cloud.width * cloud.height, cloud.point_step, cloud.fields));
+  }
+
   // Format output
   std::ostringstream oss;
   int status = writeBinaryCompressed (oss, cloud, origin, orientation);
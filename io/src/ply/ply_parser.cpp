@@ -446,6 +446,9 @@ bool pcl::io::ply::ply_parser::parse (const std::string& filename)
   // ascii
   if (format == ascii_format)
   {
+    // A single string stream is reused for all the lines, constructing one per line is costly
+    std::istringstream stringstream;
+    stringstream.unsetf (std::ios_base::skipws);
     for (const auto &element_ptr: elements)
     {
       auto& element = *(element_ptr.get ());
@@ -460,8 +463,8 @@ bool pcl::io::ply::ply_parser::parse (const std::string& filename)
         }
         istream.ignore (char_ignore_count);
         ++line_number_;
-        std::istringstream stringstream (line);
-        stringstream.unsetf (std::ios_base::skipws);
+        stringstream.clear ();
+        stringstream.str (line);
         stringstream >> std::ws;
 
         for (const auto &property_ptr: element.properties)
@@ -500,9 +503,22 @@ bool pcl::io::ply::ply_parser::parse (const std::string& filename)
   istream.open (filename.c_str (), std::ios::in | std::ios::binary);
   istream.seekg (data_start);
 
+  const bool host_format = ((format == binary_little_endian_format) && (host_byte_order == little_endian_byte_order)) ||
+                           ((format == binary_big_endian_format) && (host_byte_order == big_endian_byte_order));
   for (const auto &element_ptr: elements)
   {
     auto& element = *(element_ptr.get ());
+    // Give the user a chance to read fixed size elements in one go
+    if (host_format && !element.has_list_property &&
+        binary_element_callback_ (element.name, element.count, element.binary_size, istream))
+    {
+      if (!istream)
+      {
+        error_callback_ (line_number_, "parse error: failed to read from the binary stream");
+        return false;
+      }
+      continue;
+    }
     for (std::size_t element_index = 0; element_index < element.count; ++element_index)
     {
       if (element.begin_element_callback)
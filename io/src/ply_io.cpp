@@ -69,6 +69,7 @@ pcl::PLYReader::elementDefinitionCallback (const std::string& element_name, std:
     cloud_->point_step = 0;
     cloud_->row_step = 0;
     vertex_count_ = 0;
+    vertex_properties_.clear ();
     return (std::tuple<std::function<void ()>, std::function<void ()> > (
               [this] { vertexBeginCallback (); },
               [this] { vertexEndCallback (); }));
@@ -136,6 +137,7 @@ namespace pcl
     if (element_name == "vertex")
     {
       appendScalarProperty<pcl::io::ply::float32> (property_name, 1);
+      vertex_properties_.push_back ({VertexProperty::COPY, pcl::PCLPointField::FLOAT32});
       return ([this] (pcl::io::ply::float32 value) { vertexScalarPropertyCallback<pcl::io::ply::float32> (value); });
     }
     if (element_name == "camera")
@@ -201,20 +203,30 @@ namespace pcl
           (property_name == "diffuse_red") || (property_name == "diffuse_green") || (property_name == "diffuse_blue"))
       {
         if ((property_name == "red") || (property_name == "diffuse_red"))
+        {
           appendScalarProperty<pcl::io::ply::float32> ("rgb");
+          vertex_properties_.push_back ({VertexProperty::RED, pcl::PCLPointField::UINT8});
+        }
+        else if ((property_name == "green") || (property_name == "diffuse_green"))
+          vertex_properties_.push_back ({VertexProperty::GREEN, pcl::PCLPointField::UINT8});
+        else
+          vertex_properties_.push_back ({VertexProperty::BLUE, pcl::PCLPointField::UINT8});
         return [=] (pcl::io::ply::uint8 color) { vertexColorCallback (property_name, color); };
       }
       if (property_name == "alpha")
       {
         amendProperty ("rgb", "rgba", pcl::PCLPointField::UINT32);
+        vertex_properties_.push_back ({VertexProperty::ALPHA, pcl::PCLPointField::UINT8});
         return [this] (pcl::io::ply::uint8 alpha) { vertexAlphaCallback (alpha); };
       }
       if (property_name == "intensity")
       {
         appendScalarProperty<pcl::io::ply::float32> (property_name);
+        vertex_properties_.push_back ({VertexProperty::INTENSITY, pcl::PCLPointField::UINT8});
         return [this] (pcl::io::ply::uint8 intensity) { vertexIntensityCallback (intensity); };
       }
       appendScalarProperty<pcl::io::ply::uint8> (property_name);
+      vertex_properties_.push_back ({VertexProperty::COPY, pcl::PCLPointField::UINT8});
       return ([this] (pcl::io::ply::uint8 value) { vertexScalarPropertyCallback<pcl::io::ply::uint8> (value); });
     }
     return {};
@@ -226,6 +238,7 @@ namespace pcl
     if (element_name == "vertex")
     {
       appendScalarProperty<pcl::io::ply::int32> (property_name, 1);
+      vertex_properties_.push_back ({VertexProperty::COPY, pcl::PCLPointField::INT32});
       return ([this] (pcl::io::ply::uint32 value) { vertexScalarPropertyCallback<pcl::io::ply::uint32> (value); });
     }
     if (element_name == "camera")
@@ -249,6 +262,7 @@ namespace pcl
     if (element_name == "vertex")
     {
       appendScalarProperty<Scalar> (property_name, 1);
+      vertex_properties_.push_back ({VertexProperty::COPY, pcl::traits::asEnum<Scalar>::value});
       return ([this] (Scalar value) { vertexScalarPropertyCallback<Scalar> (value); });
     }
     return {};
@@ -517,6 +531,134 @@ pcl::PLYReader::objInfoCallback (const std::string& line)
 void
 pcl::PLYReader::vertexListPropertyEndCallback () {}
 
+bool
+pcl::PLYReader::readBinaryVertices (std::istream &istream, std::size_t count, std::size_t vertex_size)
+{
+  // Work out where every property of a vertex goes in the point, the same way the
+  // vertex callbacks do, and leave the layouts they would not handle sensibly to them
+  struct Copy
+  {
+    std::size_t src, dst, size;
+    std::uint8_t datatype;
+  };
+  std::vector<Copy> copies;
+  std::vector<std::pair<std::size_t, std::size_t> > intensities;
+  std::size_t red = 0, green = 0, blue = 0, alpha = 0, rgb = 0;
+  bool has_rgb = false, has_alpha = false;
+  VertexProperty::Kind previous = VertexProperty::COPY;
+  std::size_t src = 0, dst = 0;
+  for (const auto &property : vertex_properties_)
+  {
+    // red, green and blue must follow each other
+    if ((previous == VertexProperty::RED) != (property.kind == VertexProperty::GREEN) ||
+        (previous == VertexProperty::GREEN) != (property.kind == VertexProperty::BLUE))
+      return (false);
+    switch (property.kind)
+    {
+      case VertexProperty::COPY:
+        copies.push_back ({src, dst, static_cast<std::size_t> (pcl::getFieldSize (property.datatype)), property.datatype});
+        dst += copies.back ().size;
+        break;
+      case VertexProperty::RED:
+        if (has_rgb)
+          return (false);
+        red = src;
+        rgb = dst;
+        break;
+      case VertexProperty::GREEN:
+        green = src;
+        break;
+      case VertexProperty::BLUE:
+        blue = src;
+        has_rgb = true;
+        dst += sizeof (pcl::io::ply::float32);
+        break;
+      case VertexProperty::ALPHA:
+        if (!has_rgb || has_alpha)
+          return (false);
+        alpha = src;
+        has_alpha = true;
+        break;
+      case VertexProperty::INTENSITY:
+        intensities.emplace_back (src, dst);
+        dst += sizeof (pcl::io::ply::float32);
+        break;
+    }
+    src += pcl::getFieldSize (property.datatype);
+    previous = property.kind;
+  }
+  if (previous == VertexProperty::RED || previous == VertexProperty::GREEN ||
+      src != vertex_size || dst != cloud_->point_step || vertex_count_ != 0 ||
+      count * cloud_->point_step > cloud_->data.size ())
+    return (false);
+
+  std::uint8_t *data = cloud_->data.data ();
+  if (!has_rgb && intensities.empty ())
+  {
+    // The vertices are the points
+    istream.read (reinterpret_cast<char*> (data), count * vertex_size);
+    if (!istream)
+      return (true);
+  }
+  else
+  {
+    const std::size_t block_size = std::max<std::size_t> (1, (1 << 20) / vertex_size);
+    std::vector<std::uint8_t> block (std::min (count, block_size) * vertex_size);
+    for (std::size_t begin = 0; begin < count; begin += block_size)
+    {
+      const std::size_t nr_vertices = std::min (block_size, count - begin);
+      istream.read (reinterpret_cast<char*> (block.data ()), nr_vertices * vertex_size);
+      if (!istream)
+        return (true);
+      const std::uint8_t *vertex = block.data ();
+      std::uint8_t *point = data + begin * cloud_->point_step;
+      for (std::size_t i = 0; i < nr_vertices; ++i, vertex += vertex_size, point += cloud_->point_step)
+      {
+        for (const auto &copy : copies)
+          memcpy (point + copy.dst, vertex + copy.src, copy.size);
+        if (has_rgb)
+        {
+          std::uint32_t value = std::uint32_t (vertex[red]) << 16 | std::uint32_t (vertex[green]) << 8 | vertex[blue];
+          if (has_alpha)
+            value |= std::uint32_t (vertex[alpha]) << 24;
+          memcpy (point + rgb, &value, sizeof (std::uint32_t));
+        }
+        for (const auto &intensity : intensities)
+        {
+          pcl::io::ply::float32 value (vertex[intensity.first]);
+          memcpy (point + intensity.second, &value, sizeof (pcl::io::ply::float32));
+        }
+      }
+    }
+  }
+
+  // Same density check as vertexScalarPropertyCallback()
+  for (const auto &copy : copies)
+  {
+    if (copy.datatype != pcl::PCLPointField::FLOAT32 && copy.datatype != pcl::PCLPointField::FLOAT64)
+      continue;
+    const std::uint8_t *value = data + copy.dst;
+    for (std::size_t i = 0; i < count && cloud_->is_dense; ++i, value += cloud_->point_step)
+    {
+      if (copy.datatype == pcl::PCLPointField::FLOAT32)
+      {
+        pcl::io::ply::float32 f;
+        memcpy (&f, value, sizeof (f));
+        unsetDenseFlagIfNotFinite (f, cloud_);
+      }
+      else
+      {
+        pcl::io::ply::float64 d;
+        memcpy (&d, value, sizeof (d));
+        unsetDenseFlagIfNotFinite (d, cloud_);
+      }
+    }
+  }
+
+  vertex_count_ = count;
+  return (true);
+}
+
 bool
 pcl::PLYReader::parse (const std::string& istream_filename)
 {
@@ -529,6 +671,10 @@ pcl::PLYReader::parse (const std::string& istream_filename)
   ply_parser.obj_info_callback ([this] (const std::string& line) { objInfoCallback (line); });
   ply_parser.element_definition_callback ([this] (const std::string& element_name, std::size_t count) { return elementDefinitionCallback (element_name, count); });
   ply_parser.end_header_callback ([this] { return endHeaderCallback (); });
+  ply_parser.binary_element_callback ([this] (const std::string& element_name, std::size_t count, std::size_t element_size, std::istream& istream)
+  {
+    return (element_name == "vertex" && readBinaryVertices (istream, count, element_size));
+  });
 
   pcl::io::ply::ply_parser::scalar_property_definition_callbacks_type scalar_property_definition_callbacks;
   pcl::io::ply::ply_parser::at<pcl::io::ply::float64> (scalar_property_definition_callbacks) = [this] (const std::string& element_name, const std::string& property_name) { return scalarPropertyDefinitionCallback<pcl::io::ply::float64> (element_name, property_name); };
@@ -42,9 +42,9 @@
 
 #include <librealsense2/rs.hpp>
 #include <pcl/io/real_sense_2_grabber.h>
+#include <pcl/common/execution_context.h>
 #include <pcl/common/time.h>
 
-
 namespace pcl
 {
   using namespace io;
@@ -63,6 +63,7 @@ namespace pcl
     , device_height_ ( 240 )
     , target_fps_ ( 30 )
   {
+    setNumberOfThreads ();
   }
 
   RealSense2Grabber::~RealSense2Grabber ()
@@ -275,11 +276,20 @@ namespace pcl
     }
   }
 
+  void
+  RealSense2Grabber::setNumberOfThreads ( unsigned int nr_threads )
+  {
+    // 0 is resolved against the budget of pcl::ExecutionContext at compute time
+    threads_ = nr_threads;
+  }
+
   template <typename PointT, typename Functor>
   typename pcl::PointCloud<PointT>::Ptr
   RealSense2Grabber::convertRealsensePointsToPointCloud ( const rs2::points& points, Functor mapColorFunc )
   {
-    typename pcl::PointCloud<PointT>::Ptr cloud ( new pcl::PointCloud<PointT> () );
+    auto& pool = std::get<pcl::io::PointCloudPool<PointT> > ( cloud_pools_ );
+    pool.setCapacity ( cloud_pool_capacity_ );
+    typename pcl::PointCloud<PointT>::Ptr cloud = pool.lease ();
 
     auto sp = points.get_profile ().as<rs2::video_stream_profile> ();
     cloud->width = sp.width ();
@@ -290,14 +300,18 @@ namespace pcl
     const auto cloud_vertices_ptr = points.get_vertices ();
     const auto cloud_texture_ptr = points.get_texture_coordinates ();
 
+    const pcl::ThreadReservation reservation ( threads_ );
+    const unsigned int threads = reservation.getNumberOfThreads ();
 #if OPENMP_LEGACY_CONST_DATA_SHARING_RULE
 #pragma omp parallel for \
   default(none) \
-  shared(cloud, mapColorFunc)
+  shared(cloud, mapColorFunc) \
+  num_threads(threads)
 #else
 #pragma omp parallel for \
   default(none) \
-  shared(cloud, cloud_texture_ptr, cloud_vertices_ptr, mapColorFunc)
+  shared(cloud, cloud_texture_ptr, cloud_vertices_ptr, mapColorFunc) \
+  num_threads(threads)
 #endif
     for (std::size_t index = 0; index < cloud->size (); ++index)
     {
@@ -38,6 +38,7 @@
 #include <pcl/io/robot_eye_grabber.h>
 #include <pcl/common/point_tests.h> // for pcl::isFinite
 #include <pcl/console/print.h>
+#include <pcl/io/udp_batch_receiver.h>
 
 /////////////////////////////////////////////////////////////////////////////
 pcl::RobotEyeGrabber::RobotEyeGrabber ()
@@ -264,39 +265,23 @@ pcl::RobotEyeGrabber::computeTimestamp (std::uint32_t& timestamp, unsigned char*
 void
 pcl::RobotEyeGrabber::socketThreadLoop ()
 {
-  asyncSocketReceive();
-  io_service_.reset();
-  io_service_.run();
-}
-
-/////////////////////////////////////////////////////////////////////////////
-void
-pcl::RobotEyeGrabber::asyncSocketReceive ()
-{
-  // expecting at most max_length bytes (UDP packet).
-  socket_->async_receive_from(boost::asio::buffer(receive_buffer_, MAX_LENGTH), sender_endpoint_,
-    [this] (const boost::system::error_code& error, std::size_t number_of_bytes) {
-      socketCallback (error, number_of_bytes);
-    });
-}
-
-/////////////////////////////////////////////////////////////////////////////
-void
-pcl::RobotEyeGrabber::socketCallback (const boost::system::error_code&, std::size_t number_of_bytes)
-{
-  if (terminate_thread_)
-    return;
+  // receives up to 16 datagrams per system call on Linux
+  pcl::UDPBatchReceiver receiver (*socket_, 16, MAX_LENGTH);
 
-  if (sensor_address_ == boost::asio::ip::address_v4::any ()
-    || sensor_address_ == sender_endpoint_.address ())
+  while (!terminate_thread_)
   {
-    data_size_ = number_of_bytes;
-    unsigned char *dup = new unsigned char[number_of_bytes];
-    memcpy (dup, receive_buffer_, number_of_bytes);
-    packet_queue_.enqueue (boost::shared_array<unsigned char>(dup));
+    for (const auto &packet : receiver.receive ())
+    {
+      if (sensor_address_ == boost::asio::ip::address_v4::any ()
+        || sensor_address_ == packet.sender.address ())
+      {
+        data_size_ = static_cast<unsigned int> (packet.size);
+        unsigned char *dup = new unsigned char[packet.size];
+        memcpy (dup, packet.data, packet.size);
+        packet_queue_.enqueue (boost::shared_array<unsigned char>(dup));
+      }
+    }
   }
-
-  asyncSocketReceive ();
 }
 
 /////////////////////////////////////////////////////////////////////////////
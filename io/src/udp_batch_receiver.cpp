@@ -0,0 +1,193 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include <pcl/io/udp_batch_receiver.h>
+#include <algorithm>
+#include <chrono>
+
+#ifdef __linux__
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <cstring>
+#endif
+
+using boost::asio::ip::udp;
+
+/////////////////////////////////////////////////////////////////////////////
+struct pcl::UDPBatchReceiver::BatchHeaders
+{
+#ifdef __linux__
+  std::vector<mmsghdr> headers;
+  std::vector<iovec> buffers;
+  std::vector<sockaddr_storage> senders;
+  std::vector<char> controls;
+#endif
+};
+
+namespace
+{
+  std::uint64_t
+  systemTimeMicroseconds ()
+  {
+    return (static_cast<std::uint64_t> (std::chrono::duration_cast<std::chrono::microseconds> (
+        std::chrono::system_clock::now ().time_since_epoch ()).count ()));
+  }
+}
+
+/////////////////////////////////////////////////////////////////////////////
+pcl::UDPBatchReceiver::UDPBatchReceiver (udp::socket &socket,
+                                         std::size_t batch_size,
+                                         std::size_t max_packet_size) :
+    socket_ (socket),
+    batch_size_ (std::max<std::size_t> (batch_size, 1)),
+    max_packet_size_ (max_packet_size),
+    batched_ (false),
+    buffer_ (batch_size_ * max_packet_size),
+    headers_ (new BatchHeaders)
+{
+  packets_.reserve (batch_size_);
+#ifdef __linux__
+  int enable = 1;
+  batched_ = (setsockopt (socket_.native_handle (), SOL_SOCKET, SO_TIMESTAMPNS, &enable, sizeof (enable)) == 0);
+
+  // one header, buffer, sender address and control message per datagram
+  const std::size_t control_size = CMSG_SPACE (sizeof (timespec));
+  headers_->headers.resize (batch_size_);
+  headers_->buffers.resize (batch_size_);
+  headers_->senders.resize (batch_size_);
+  headers_->controls.resize (batch_size_ * control_size);
+  for (std::size_t i = 0; i < batch_size_; i++)
+  {
+    headers_->buffers[i].iov_base = &buffer_[i * max_packet_size_];
+    headers_->buffers[i].iov_len = max_packet_size_;
+    std::memset (&headers_->headers[i], 0, sizeof (mmsghdr));
+    headers_->headers[i].msg_hdr.msg_iov = &headers_->buffers[i];
+    headers_->headers[i].msg_hdr.msg_iovlen = 1;
+    headers_->headers[i].msg_hdr.msg_name = &headers_->senders[i];
+    headers_->headers[i].msg_hdr.msg_namelen = sizeof (sockaddr_storage);
+    headers_->headers[i].msg_hdr.msg_control = &headers_->controls[i * control_size];
+    headers_->headers[i].msg_hdr.msg_controllen = control_size;
+  }
+#endif
+}
+
+/////////////////////////////////////////////////////////////////////////////
+pcl::UDPBatchReceiver::~UDPBatchReceiver () = default;
+
+/////////////////////////////////////////////////////////////////////////////
+const std::vector<pcl::UDPBatchReceiver::Packet>&
+pcl::UDPBatchReceiver::receive (int timeout_ms)
+{
+  packets_.clear ();
+  if (!socket_.is_open ())
+    return (packets_);
+
+#ifdef __linux__
+  if (batched_)
+  {
+    const int fd = socket_.native_handle ();
+
+    pollfd poll_fd;
+    poll_fd.fd = fd;
+    poll_fd.events = POLLIN;
+    poll_fd.revents = 0;
+    if (poll (&poll_fd, 1, timeout_ms) <= 0 || !(poll_fd.revents & POLLIN))
+      return (packets_);
+
+    // the kernel overwrites the lengths on every call
+    std::vector<mmsghdr> &headers = headers_->headers;
+    const std::size_t control_size = CMSG_SPACE (sizeof (timespec));
+    for (std::size_t i = 0; i < batch_size_; i++)
+    {
+      headers[i].msg_hdr.msg_namelen = sizeof (sockaddr_storage);
+      headers[i].msg_hdr.msg_controllen = control_size;
+      headers[i].msg_len = 0;
+    }
+
+    const int received = recvmmsg (fd, headers.data (), static_cast<unsigned int> (batch_size_), MSG_DONTWAIT, nullptr);
+    for (int i = 0; i < received; i++)
+    {
+      Packet packet;
+      packet.data = &buffer_[i * max_packet_size_];
+      packet.size = headers[i].msg_len;
+      packet.timestamp = 0;
+
+      // kernel receive time
+      for (cmsghdr *cmsg = CMSG_FIRSTHDR (&headers[i].msg_hdr); cmsg != nullptr; cmsg = CMSG_NXTHDR (&headers[i].msg_hdr, cmsg))
+      {
+        if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_TIMESTAMPNS)
+        {
+          timespec stamp;
+          std::memcpy (&stamp, CMSG_DATA (cmsg), sizeof (stamp));
+          packet.timestamp = static_cast<std::uint64_t> (stamp.tv_sec) * 1000000 + static_cast<std::uint64_t> (stamp.tv_nsec) / 1000;
+        }
+      }
+      if (packet.timestamp == 0)
+        packet.timestamp = systemTimeMicroseconds ();
+
+      const sockaddr_storage &sender = headers_->senders[i];
+      if (sender.ss_family == AF_INET)
+      {
+        const sockaddr_in &address = reinterpret_cast<const sockaddr_in&> (sender);
+        packet.sender = udp::endpoint (boost::asio::ip::address_v4 (ntohl (address.sin_addr.s_addr)), ntohs (address.sin_port));
+      }
+      else if (sender.ss_family == AF_INET6)
+      {
+        const sockaddr_in6 &address = reinterpret_cast<const sockaddr_in6&> (sender);
+        boost::asio::ip::address_v6::bytes_type bytes;
+        std::memcpy (bytes.data (), address.sin6_addr.s6_addr, bytes.size ());
+        packet.sender = udp::endpoint (boost::asio::ip::address_v6 (bytes, address.sin6_scope_id), ntohs (address.sin6_port));
+      }
+
+      packets_.push_back (packet);
+    }
+    return (packets_);
+  }
+#endif
+
+  // portable path, one datagram per call
+  Packet packet;
+  boost::system::error_code error;
+  packet.size = socket_.receive_from (boost::asio::buffer (buffer_.data (), max_packet_size_), packet.sender, 0, error);
+  if (error)
+    return (packets_);
+  packet.data = buffer_.data ();
+  packet.timestamp = systemTimeMicroseconds ();
+  packets_.push_back (packet);
+  return (packets_);
+}
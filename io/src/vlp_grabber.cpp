@@ -105,8 +105,7 @@ pcl::VLPGrabber::toPointClouds (HDLDataPacket *dataPacket)
   if (sizeof(HDLLaserReturn) != 3)
     return;
 
-  time_t system_time;
-  time (&system_time);
+  const time_t system_time = (packet_timestamp_ != 0) ? static_cast<time_t> (packet_timestamp_ / 1000000) : time (nullptr);
   time_t velodyne_time = (system_time & 0x00000000ffffffffl) << 32 | dataPacket->gpsTimestamp;
 
   double interpolated_azimuth_delta;
@@ -156,9 +155,9 @@ pcl::VLPGrabber::toPointClouds (HDLDataPacket *dataPacket)
 
           HDLGrabber::fireCurrentSweep ();
         }
-        current_sweep_xyz_.reset (new pcl::PointCloud<pcl::PointXYZ> ());
-        current_sweep_xyzrgba_.reset (new pcl::PointCloud<pcl::PointXYZRGBA> ());
-        current_sweep_xyzi_.reset (new pcl::PointCloud<pcl::PointXYZI> ());
+        current_sweep_xyz_ = recycleCloud (xyz_cloud_pool_);
+        current_sweep_xyzrgba_ = recycleCloud (xyzrgba_cloud_pool_);
+        current_sweep_xyzi_ = recycleCloud (xyzi_cloud_pool_);
       }
 
       PointXYZ xyz;
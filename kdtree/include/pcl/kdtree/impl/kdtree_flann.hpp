@@ -42,15 +42,107 @@
 #include <flann/flann.hpp>
 
 #include <pcl/kdtree/kdtree_flann.h>
+#include <pcl/common/execution_context.h>
 #include <pcl/console/print.h>
 
+#include <algorithm> // for std::copy_n
+
+namespace pcl {
+namespace detail {
+/** \brief Find the points that are valid for a point representation, in parallel.
+ * \param[in] representation the point representation
+ * \param[in] cloud the point cloud
+ * \param[in] indices the positions of the points in \a cloud, nullptr for all points
+ * \param[out] mapping the position (in \a indices if given, in \a cloud otherwise) of
+ * every valid point, left empty if all points are valid
+ * \param[in] threads the number of threads to use
+ * \return the number of valid points
+ */
+template <typename PointT, typename MappingT>
+std::size_t
+findValidPoints(const PointRepresentation<PointT>& representation,
+                const PointCloud<PointT>& cloud,
+                const Indices* indices,
+                std::vector<MappingT>& mapping,
+                unsigned int threads)
+{
+  std::ptrdiff_t nr_points =
+      static_cast<std::ptrdiff_t>(indices ? indices->size() : cloud.size());
+  std::vector<unsigned char> valid(nr_points);
+  std::ptrdiff_t nr_valid = 0;
+
+#pragma omp parallel for \
+  default(none) \
+  shared(cloud, indices, nr_points, representation, valid) \
+  reduction(+:nr_valid) \
+  num_threads(threads)
+  for (std::ptrdiff_t i = 0; i < nr_points; ++i) {
+    valid[i] = representation.isValid(cloud[indices ? (*indices)[i] : i]);
+    nr_valid += valid[i];
+  }
+
+  mapping.clear();
+  if (nr_valid != nr_points) {
+    mapping.reserve(nr_valid);
+    for (std::ptrdiff_t i = 0; i < nr_points; ++i)
+      if (valid[i])
+        mapping.push_back(static_cast<MappingT>(i));
+  }
+  return (static_cast<std::size_t>(nr_valid));
+}
+
+/** \brief Vectorize points into the rows of a FLANN matrix, in parallel.
+ * \param[in] representation the point representation
+ * \param[in] cloud the point cloud
+ * \param[in] indices the positions of the points in \a cloud, nullptr for all points
+ * \param[in] mapping the position of the point of each row as found by
+ * findValidPoints, empty for the identity
+ * \param[in] nr_rows the number of rows to write
+ * \param[out] data the rows, with room for nr_rows times the number of dimensions
+ * \param[in] threads the number of threads to use
+ */
+template <typename PointT, typename MappingT>
+void
+vectorizePoints(const PointRepresentation<PointT>& representation,
+                const PointCloud<PointT>& cloud,
+                const Indices* indices,
+                const std::vector<MappingT>& mapping,
+                std::size_t nr_rows,
+                float* data,
+                unsigned int threads)
+{
+  std::ptrdiff_t nr_rows_signed = static_cast<std::ptrdiff_t>(nr_rows);
+  std::ptrdiff_t dim = static_cast<std::ptrdiff_t>(representation.getNumberOfDimensions());
+  // trivial representations are plain copies of the leading floats, without virtual calls
+  const bool trivial = representation.isTrivial();
+
+#pragma omp parallel for \
+  default(none) \
+  shared(cloud, data, dim, indices, mapping, nr_rows_signed, representation, trivial) \
+  schedule(static) \
+  num_threads(threads)
+  for (std::ptrdiff_t row = 0; row < nr_rows_signed; ++row) {
+    const std::ptrdiff_t position =
+        mapping.empty() ? row : static_cast<std::ptrdiff_t>(mapping[row]);
+    const PointT& point = cloud[indices ? (*indices)[position] : position];
+    if (trivial)
+      std::copy_n(reinterpret_cast<const float*>(&point), dim, data + row * dim);
+    else
+      representation.vectorize(point, data + row * dim);
+  }
+}
+} // namespace detail
+} // namespace pcl
+
 ///////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointT, typename Dist>
 pcl::KdTreeFLANN<PointT, Dist>::KdTreeFLANN (bool sorted)
   : pcl::KdTree<PointT> (sorted)
   , flann_index_ ()
+  , data_stride_ (0)
   , identity_mapping_ (false)
   , dim_ (0), total_nr_points_ (0)
+  , trees_ (1), checks_ (-1), threads_ (0)
   , param_k_ (::flann::SearchParams (-1 , epsilon_))
   , param_radius_ (::flann::SearchParams (-1, epsilon_, sorted))
 {
@@ -71,8 +163,10 @@ template <typename PointT, typename Dist>
 pcl::KdTreeFLANN<PointT, Dist>::KdTreeFLANN (const KdTreeFLANN<PointT, Dist> &k)
   : pcl::KdTree<PointT> (false)
   , flann_index_ ()
+  , data_stride_ (0)
   , identity_mapping_ (false)
   , dim_ (0), total_nr_points_ (0)
+  , trees_ (1), checks_ (-1), threads_ (0)
   , param_k_ (::flann::SearchParams (-1 , epsilon_))
   , param_radius_ (::flann::SearchParams (-1, epsilon_, false))
 {
@@ -84,8 +178,8 @@ template <typename PointT, typename Dist> void
 pcl::KdTreeFLANN<PointT, Dist>::setEpsilon (float eps)
 {
   epsilon_ = eps;
-  param_k_ =  ::flann::SearchParams (-1 , epsilon_);
-  param_radius_ = ::flann::SearchParams (-1 , epsilon_, sorted_);
+  param_k_ =  ::flann::SearchParams (checks_ , epsilon_);
+  param_radius_ = ::flann::SearchParams (checks_ , epsilon_, sorted_);
 }
 
 ///////////////////////////////////////////////////////////////////////////////////////////
@@ -93,8 +187,17 @@ template <typename PointT, typename Dist> void
 pcl::KdTreeFLANN<PointT, Dist>::setSortedResults (bool sorted)
 {
   sorted_ = sorted;
-  param_k_ = ::flann::SearchParams (-1, epsilon_);
-  param_radius_ = ::flann::SearchParams (-1, epsilon_, sorted_);
+  param_k_ = ::flann::SearchParams (checks_, epsilon_);
+  param_radius_ = ::flann::SearchParams (checks_, epsilon_, sorted_);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT, typename Dist> void
+pcl::KdTreeFLANN<PointT, Dist>::setMaxChecks (int checks)
+{
+  checks_ = checks;
+  param_k_ = ::flann::SearchParams (checks_, epsilon_);
+  param_radius_ = ::flann::SearchParams (checks_, epsilon_, sorted_);
 }
 
 ///////////////////////////////////////////////////////////////////////////////////////////
@@ -123,17 +226,20 @@ pcl::KdTreeFLANN<PointT, Dist>::setInputCloud (const PointCloudConstPtr &cloud,
   {
     convertCloudToArray (*input_);
   }
-  total_nr_points_ = static_cast<uindex_t> (index_mapping_.size ());
   if (total_nr_points_ == 0)
   {
     PCL_ERROR ("[pcl::KdTreeFLANN::setInputCloud] Cannot create a KDTree with an empty input cloud!\n");
     return;
   }
 
+  const ::flann::IndexParams index_params = (trees_ > 1 ?
+      ::flann::IndexParams (::flann::KDTreeIndexParams (trees_)) :
+      ::flann::IndexParams (::flann::KDTreeSingleIndexParams (15))); // max 15 points/leaf
   flann_index_.reset (new FLANNIndex (::flann::Matrix<float> (cloud_.get (),
-                                                              index_mapping_.size (),
-                                                              dim_),
-                                      ::flann::KDTreeSingleIndexParams (15))); // max 15 points/leaf
+                                                              total_nr_points_,
+                                                              dim_,
+                                                              data_stride_),
+                                      index_params));
   flann_index_->buildIndex ();
 }
 
@@ -245,14 +351,14 @@ pcl::KdTreeFLANN<PointT, Dist>::nearestKSearch (const PointT &point, unsigned in
   if (k==0)
     return 0;
 
-  std::vector<float> query (dim_);
-  point_representation_->vectorize (static_cast<PointT> (point), query);
+  std::vector<float> buffer;
+  float* query = vectorizeQuery (point, buffer);
 
   // Wrap the k_distances vector (no data copy)
   ::flann::Matrix<float> k_distances_mat (&k_distances[0], 1, k);
 
   knn_search(*flann_index_,
-             ::flann::Matrix<float>(&query[0], 1, dim_),
+             ::flann::Matrix<float>(query, 1, dim_),
              k_indices,
              k_distances_mat,
              k,
@@ -369,8 +475,8 @@ pcl::KdTreeFLANN<PointT, Dist>::radiusSearch (const PointT &point, double radius
 {
   assert (point_representation_->isValid (point) && "Invalid (NaN, Inf) point coordinates given to radiusSearch!");
 
-  std::vector<float> query (dim_);
-  point_representation_->vectorize (static_cast<PointT> (point), query);
+  std::vector<float> buffer;
+  float* query = vectorizeQuery (point, buffer);
 
   // Has max_nn been set properly?
   if (max_nn == 0 || max_nn > total_nr_points_)
@@ -384,7 +490,7 @@ pcl::KdTreeFLANN<PointT, Dist>::radiusSearch (const PointT &point, double radius
   else
     params.max_neighbors = max_nn;
 
-  auto query_mat = ::flann::Matrix<float>(&query[0], 1, dim_);
+  auto query_mat = ::flann::Matrix<float>(query, 1, dim_);
   int neighbors_in_radius = radius_search(*flann_index_,
                                           query_mat,
                                           k_indices,
@@ -407,6 +513,124 @@ pcl::KdTreeFLANN<PointT, Dist>::radiusSearch (const PointT &point, double radius
   return (neighbors_in_radius);
 }
 
+///////////////////////////////////////////////////////////////////////////////////////////
+namespace pcl {
+namespace detail {
+// Wrap a caller-owned index buffer directly if FLANN can write to it, otherwise go
+// through the (reused) scratch buffer of the query context
+template <class IndexT, CompatWithFlann<IndexT> = true>
+::flann::Matrix<std::size_t>
+wrap_index_buffer(IndexT* indices, std::vector<std::size_t>&, std::size_t cols)
+{
+  return ::flann::Matrix<std::size_t>(indices, 1, cols);
+}
+
+template <class IndexT, NotCompatWithFlann<IndexT> = true>
+::flann::Matrix<std::size_t>
+wrap_index_buffer(IndexT*, std::vector<std::size_t>& scratch, std::size_t cols)
+{
+  if (scratch.size () < cols)
+    scratch.resize (cols);
+  return ::flann::Matrix<std::size_t>(scratch.data (), 1, cols);
+}
+
+template <class IndexT, CompatWithFlann<IndexT> = true>
+void
+copy_index_buffer(IndexT*, const std::vector<std::size_t>&, std::size_t)
+{}
+
+template <class IndexT, NotCompatWithFlann<IndexT> = true>
+void
+copy_index_buffer(IndexT* indices, const std::vector<std::size_t>& scratch, std::size_t n)
+{
+  std::copy(scratch.cbegin(), scratch.cbegin() + n, indices);
+}
+} // namespace detail
+} // namespace pcl
+
+///////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT, typename Dist> int
+pcl::KdTreeFLANN<PointT, Dist>::nearestKSearch (const PointT &point, unsigned int k,
+                                                index_t *k_indices, float *k_sqr_distances,
+                                                QueryContext &context) const
+{
+  assert (point_representation_->isValid (point) && "Invalid (NaN, Inf) point coordinates given to nearestKSearch!");
+
+  if (k > total_nr_points_)
+    k = total_nr_points_;
+
+  if (k == 0)
+    return 0;
+
+  float* query = vectorizeQuery (point, context.query);
+
+  ::flann::Matrix<float> query_mat (query, 1, dim_);
+  auto k_indices_mat = detail::wrap_index_buffer (k_indices, context.indices, k);
+  ::flann::Matrix<float> k_distances_mat (k_sqr_distances, 1, k);
+  flann_index_->knnSearch (query_mat, k_indices_mat, k_distances_mat, k, param_k_);
+  detail::copy_index_buffer (k_indices, context.indices, k);
+
+  // Do mapping to original point cloud
+  if (!identity_mapping_)
+  {
+    for (unsigned int i = 0; i < k; ++i)
+      k_indices[i] = index_mapping_[k_indices[i]];
+  }
+
+  return (k);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT, typename Dist> int
+pcl::KdTreeFLANN<PointT, Dist>::radiusSearch (const PointT &point, double radius,
+                                              index_t *k_indices, float *k_sqr_distances,
+                                              unsigned int max_nn, QueryContext &context) const
+{
+  assert (point_representation_->isValid (point) && "Invalid (NaN, Inf) point coordinates given to radiusSearch!");
+
+  if (max_nn > total_nr_points_)
+    max_nn = total_nr_points_;
+
+  if (max_nn == 0)
+    return 0;
+
+  float* query = vectorizeQuery (point, context.query);
+
+  ::flann::SearchParams params (param_radius_);
+  params.max_neighbors = max_nn;
+
+  ::flann::Matrix<float> query_mat (query, 1, dim_);
+  auto k_indices_mat = detail::wrap_index_buffer (k_indices, context.indices, max_nn);
+  ::flann::Matrix<float> k_distances_mat (k_sqr_distances, 1, max_nn);
+  const int found = flann_index_->radiusSearch (query_mat, k_indices_mat, k_distances_mat,
+                                                static_cast<float> (radius * radius), params);
+  const int neighbors_in_radius = std::min (found, static_cast<int> (max_nn));
+  detail::copy_index_buffer (k_indices, context.indices, neighbors_in_radius);
+
+  // Do mapping to original point cloud
+  if (!identity_mapping_)
+  {
+    for (int i = 0; i < neighbors_in_radius; ++i)
+      k_indices[i] = index_mapping_[k_indices[i]];
+  }
+
+  return (neighbors_in_radius);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT, typename Dist> float*
+pcl::KdTreeFLANN<PointT, Dist>::vectorizeQuery (const PointT &point, std::vector<float> &buffer) const
+{
+  // FLANN only reads the query, so the point itself can be handed over
+  if (point_representation_->isTrivial ())
+    return (const_cast<float*> (reinterpret_cast<const float*> (&point)));
+
+  if (buffer.size () < static_cast<std::size_t> (dim_))
+    buffer.resize (dim_);
+  point_representation_->vectorize (point, buffer.data ());
+  return (buffer.data ());
+}
+
 ///////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointT, typename Dist> void
 pcl::KdTreeFLANN<PointT, Dist>::cleanup ()
@@ -418,6 +642,22 @@ pcl::KdTreeFLANN<PointT, Dist>::cleanup ()
     indices_.reset ();
 }
 
+///////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT, typename Dist> std::size_t
+pcl::KdTreeFLANN<PointT, Dist>::getMemoryUsage () const
+{
+  std::size_t bytes = index_mapping_.capacity () * sizeof (int);
+  if (flann_index_)
+    bytes += static_cast<std::size_t> (flann_index_->usedMemory ());
+
+  // cloud_ either aliases the input points or owns a dense copy of the vectorized points
+  const bool in_place = input_ && !input_->empty () &&
+                        cloud_.get () == reinterpret_cast<const float*> (&(*input_)[0]);
+  if (cloud_ && !in_place)
+    bytes += static_cast<std::size_t> (total_nr_points_) * dim_ * sizeof (float);
+  return (bytes);
+}
+
 ///////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointT, typename Dist> void
 pcl::KdTreeFLANN<PointT, Dist>::convertCloudToArray (const PointCloud &cloud)
@@ -426,30 +666,30 @@ pcl::KdTreeFLANN<PointT, Dist>::convertCloudToArray (const PointCloud &cloud)
   if (cloud.empty ())
   {
     cloud_.reset ();
+    total_nr_points_ = 0;
     return;
   }
 
-  const auto original_no_of_points = cloud.size ();
+  const pcl::ThreadReservation reservation (threads_);
+  const unsigned int threads = reservation.getNumberOfThreads ();
 
-  cloud_.reset (new float[original_no_of_points * dim_], std::default_delete<float[]> ());
-  float* cloud_ptr = cloud_.get ();
-  index_mapping_.reserve (original_no_of_points);
-  identity_mapping_ = true;
+  total_nr_points_ = static_cast<uindex_t> (
+      detail::findValidPoints (*point_representation_, cloud, nullptr, index_mapping_, threads));
+  identity_mapping_ = index_mapping_.empty ();
 
-  for (std::size_t cloud_index = 0; cloud_index < original_no_of_points; ++cloud_index)
+  if (identity_mapping_ && point_representation_->isTrivial () && &cloud == input_.get ())
   {
-    // Check if the point is invalid
-    if (!point_representation_->isValid (cloud[cloud_index]))
-    {
-      identity_mapping_ = false;
-      continue;
-    }
-
-    index_mapping_.push_back (cloud_index);
-
-    point_representation_->vectorize (cloud[cloud_index], cloud_ptr);
-    cloud_ptr += dim_;
+    // The vectorized points are the leading floats of the points, so FLANN can read
+    // them in place. The aliasing pointer keeps the input cloud alive with the index.
+    cloud_ = std::shared_ptr<float> (input_, const_cast<float*> (reinterpret_cast<const float*> (&cloud[0])));
+    data_stride_ = sizeof (PointT);
+    return;
   }
+
+  cloud_.reset (new float[total_nr_points_ * dim_], std::default_delete<float[]> ());
+  data_stride_ = dim_ * sizeof (float);
+  detail::vectorizePoints (*point_representation_, cloud, nullptr, index_mapping_,
+                           total_nr_points_, cloud_.get (), threads);
 }
 
 ///////////////////////////////////////////////////////////////////////////////////////////
@@ -460,14 +700,13 @@ pcl::KdTreeFLANN<PointT, Dist>::convertCloudToArray (const PointCloud &cloud, co
   if (cloud.empty ())
   {
     cloud_.reset ();
+    total_nr_points_ = 0;
     return;
   }
 
-  int original_no_of_points = static_cast<int> (indices.size ());
+  const pcl::ThreadReservation reservation (threads_);
+  const unsigned int threads = reservation.getNumberOfThreads ();
 
-  cloud_.reset (new float[original_no_of_points * dim_], std::default_delete<float[]> ());
-  float* cloud_ptr = cloud_.get ();
-  index_mapping_.reserve (original_no_of_points);
   // its a subcloud -> false
   // true only identity:
   //     - indices size equals cloud size
@@ -477,18 +716,19 @@ pcl::KdTreeFLANN<PointT, Dist>::convertCloudToArray (const PointCloud &cloud, co
   // But we can not guarantee that => identity_mapping_ = false
   identity_mapping_ = false;
 
-  for (const auto &index : indices)
-  {
-    // Check if the point is invalid
-    if (!point_representation_->isValid (cloud[index]))
-      continue;
+  std::vector<int> valid_positions;
+  total_nr_points_ = static_cast<uindex_t> (
+      detail::findValidPoints (*point_representation_, cloud, &indices, valid_positions, threads));
 
-    // map from 0 - N -> indices [0] - indices [N]
-    index_mapping_.push_back (index);  // If the returned index should be for the indices vector
+  cloud_.reset (new float[total_nr_points_ * dim_], std::default_delete<float[]> ());
+  data_stride_ = dim_ * sizeof (float);
+  detail::vectorizePoints (*point_representation_, cloud, &indices, valid_positions,
+                           total_nr_points_, cloud_.get (), threads);
 
-    point_representation_->vectorize (cloud[index], cloud_ptr);
-    cloud_ptr += dim_;
-  }
+  // map from 0 - N -> indices [0] - indices [N]
+  index_mapping_.resize (total_nr_points_);
+  for (uindex_t row = 0; row < total_nr_points_; ++row)
+    index_mapping_[row] = indices[valid_positions.empty () ? row : valid_positions[row]];
 }
 
 #define PCL_INSTANTIATE_KdTreeFLANN(T) template class PCL_EXPORTS pcl::KdTreeFLANN<T>;
@@ -43,6 +43,7 @@
 #include <pcl/kdtree/kdtree.h>
 #include <flann/util/params.h>
 
+#include <algorithm>
 #include <memory>
 
 // Forward declarations
@@ -125,6 +126,12 @@ knn_search(const FlannIndex& index,
  * The class is making use of the FLANN (Fast Library for Approximate Nearest Neighbor)
  * project by Marius Muja and David Lowe.
  *
+ * By default a single exact kd-tree is built. For large maps where approximate results
+ * are acceptable, \ref setNumberOfTrees switches to a forest of randomized kd-trees,
+ * whose searches are bounded by \ref setMaxChecks. The points are converted into the
+ * FLANN matrix in parallel; if the point representation is trivial and all points are
+ * valid, FLANN reads them in place and no copy is made.
+ *
  * \author Radu B. Rusu, Marius Muja
  * \ingroup kdtree
  */
@@ -151,6 +158,19 @@ public:
   using Ptr = shared_ptr<KdTreeFLANN<PointT, Dist>>;
   using ConstPtr = shared_ptr<const KdTreeFLANN<PointT, Dist>>;
 
+  /** \brief Scratch memory reused across queries by the buffer based \ref
+   * nearestKSearch and \ref radiusSearch overloads. A context only grows, so after a
+   * few queries no further heap allocations are made by this class. A context must
+   * not be shared between threads; use one per thread instead.
+   */
+  struct QueryContext {
+    /** \brief The vectorized query point. */
+    std::vector<float> query;
+    /** \brief Index buffer in FLANN's native index type, used when it differs from
+     * pcl::index_t. */
+    std::vector<std::size_t> indices;
+  };
+
   /** \brief Default Constructor for KdTreeFLANN.
    * \param[in] sorted set to true if the application that the tree will be used for
    * requires sorted nearest neighbor indices (default). False otherwise.
@@ -175,8 +195,12 @@ public:
     cloud_ = k.cloud_;
     index_mapping_ = k.index_mapping_;
     identity_mapping_ = k.identity_mapping_;
+    data_stride_ = k.data_stride_;
     dim_ = k.dim_;
     total_nr_points_ = k.total_nr_points_;
+    trees_ = k.trees_;
+    checks_ = k.checks_;
+    threads_ = k.threads_;
     param_k_ = k.param_k_;
     param_radius_ = k.param_radius_;
     return (*this);
@@ -191,6 +215,57 @@ public:
   void
   setSortedResults(bool sorted);
 
+  /** \brief Set the number of randomized kd-trees built by \ref setInputCloud.
+   * \param[in] trees 1 (default) builds a single exact kd-tree, more build a forest of
+   * randomized kd-trees, whose searches are approximate
+   */
+  void
+  setNumberOfTrees(int trees)
+  {
+    trees_ = std::max(trees, 1);
+  }
+
+  /** \brief Get the number of randomized kd-trees built by \ref setInputCloud. */
+  int
+  getNumberOfTrees() const
+  {
+    return (trees_);
+  }
+
+  /** \brief Set the maximum number of leaves visited by a search in the randomized
+   * kd-trees, i.e. the trade-off between speed and accuracy of the approximate search.
+   * The single kd-tree ignores it. \param[in] checks the number of checks, -1 (default)
+   * for an unbounded, exact search
+   */
+  void
+  setMaxChecks(int checks);
+
+  /** \brief Get the maximum number of leaves visited by a search in the randomized
+   * kd-trees. */
+  int
+  getMaxChecks() const
+  {
+    return (checks_);
+  }
+
+  /** \brief Set the number of threads used to convert the input cloud in
+   * \ref setInputCloud. \param[in] nr_threads the number of threads to use
+   */
+  void
+  setNumberOfThreads(unsigned int nr_threads = 0)
+  {
+    // 0 is resolved against the budget of pcl::ExecutionContext at compute time
+    threads_ = nr_threads;
+  }
+
+  /** \brief Get the memory held by the search structure built in \ref setInputCloud,
+   * i.e. the FLANN index, the copy of the vectorized points unless they are read from
+   * the input cloud in place, and the index mapping. The input cloud is not counted.
+   * \return number of bytes
+   */
+  std::size_t
+  getMemoryUsage() const;
+
   inline Ptr
   makeShared()
   {
@@ -256,19 +331,76 @@ public:
                std::vector<float>& k_sqr_distances,
                unsigned int max_nn = 0) const override;
 
+  /** \brief Search for k-nearest neighbors for the given query point, writing the
+   * results into caller-owned buffers.
+   *
+   * Unlike the std::vector based overload, the output is never resized, and all
+   * temporary memory is taken from \a context. This makes it suitable for tight
+   * loops where per-query allocations dominate.
+   *
+   * \param[in] point a given \a valid (i.e., finite) query point
+   * \param[in] k the number of neighbors to search for
+   * \param[out] k_indices the resultant indices of the neighboring points, with room
+   * for at least \a k elements
+   * \param[out] k_sqr_distances the resultant squared distances to the neighboring
+   * points, with room for at least \a k elements
+   * \param[in,out] context scratch memory reused across calls
+   * \return number of neighbors found (at most \a k)
+   */
+  int
+  nearestKSearch(const PointT& point,
+                 unsigned int k,
+                 index_t* k_indices,
+                 float* k_sqr_distances,
+                 QueryContext& context) const;
+
+  /** \brief Search for the nearest neighbors of the query point in a given radius,
+   * writing the results into caller-owned buffers.
+   *
+   * Unlike the std::vector based overload, the output is never resized, and all
+   * temporary memory is taken from \a context.
+   *
+   * \param[in] point a given \a valid (i.e., finite) query point
+   * \param[in] radius the radius of the sphere bounding all of p_q's neighbors
+   * \param[out] k_indices the resultant indices of the neighboring points, with room
+   * for at least \a max_nn elements
+   * \param[out] k_sqr_distances the resultant squared distances to the neighboring
+   * points, with room for at least \a max_nn elements
+   * \param[in] max_nn the capacity of the output buffers; at most this many neighbors
+   * are returned (the closest ones if the tree has sorted results enabled)
+   * \param[in,out] context scratch memory reused across calls
+   * \return number of neighbors written to the buffers
+   */
+  int
+  radiusSearch(const PointT& point,
+               double radius,
+               index_t* k_indices,
+               float* k_sqr_distances,
+               unsigned int max_nn,
+               QueryContext& context) const;
+
 private:
   /** \brief Internal cleanup method. */
   void
   cleanup();
 
-  /** \brief Converts a PointCloud to the internal FLANN point array representation.
-   * Returns the number of points. \param cloud the PointCloud
+  /** \brief Get the query vector of a point. Trivial point representations are read in
+   * place, without a copy or virtual call, all others are vectorized into buffer.
+   * \param[in] point the query point
+   * \param[in,out] buffer storage for the vectorized point, resized as needed
+   * \return pointer to the dim_ floats of the query
+   */
+  float*
+  vectorizeQuery(const PointT& point, std::vector<float>& buffer) const;
+
+  /** \brief Converts a PointCloud to the internal FLANN point array representation
+   * and sets total_nr_points_. \param cloud the PointCloud
    */
   void
   convertCloudToArray(const PointCloud& cloud);
 
   /** \brief Converts a PointCloud with a given set of indices to the internal FLANN
-   * point array representation. Returns the number of points. \param[in] cloud the
+   * point array representation and sets total_nr_points_. \param[in] cloud the
    * PointCloud data \param[in] indices the point cloud indices
    */
   void
@@ -289,6 +421,10 @@ private:
    * C++17*/
   std::shared_ptr<float> cloud_;
 
+  /** \brief Distance in bytes between two rows of cloud_, sizeof (PointT) if it points
+   * into the input cloud. */
+  std::size_t data_stride_;
+
   /** \brief mapping between internal and external indices. */
   std::vector<int> index_mapping_;
 
@@ -302,6 +438,16 @@ private:
    * input cloud or to the number of indices - if passed). */
   uindex_t total_nr_points_;
 
+  /** \brief Number of randomized kd-trees, 1 for a single exact kd-tree. */
+  int trees_;
+
+  /** \brief Maximum number of leaves visited in the randomized kd-trees, -1 for
+   * unbounded. */
+  int checks_;
+
+  /** \brief The number of threads the conversion of the input cloud should use. */
+  unsigned int threads_;
+
   /** \brief The KdTree search parameters for K-nearest neighbors. */
   ::flann::SearchParams param_k_;
 
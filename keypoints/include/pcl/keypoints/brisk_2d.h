@@ -277,7 +277,7 @@ namespace pcl
             * \param[out] keypoints the AGAST keypoints
             */
           void 
-          getAgastPoints (std::uint8_t threshold, std::vector<pcl::PointUV, Eigen::aligned_allocator<pcl::PointUV> > &keypoints);
+          getAgastPoints (std::uint8_t threshold, pcl::PointCloud<pcl::PointUV>::VectorType &keypoints);
 
           // get scores - attention, this is in layer coordinates, not scale=1 coordinates!
           /** \brief Get the AGAST keypoint score for a given pixel using a threshold
@@ -414,7 +414,7 @@ namespace pcl
             */
           void 
           getKeypoints (const int threshold, 
-                        std::vector<pcl::PointWithScale, Eigen::aligned_allocator<pcl::PointWithScale> >  &keypoints);
+                        pcl::PointCloud<pcl::PointWithScale>::VectorType  &keypoints);
 
         protected:
           /** Nonmax suppression. */
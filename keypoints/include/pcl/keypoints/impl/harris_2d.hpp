@@ -41,6 +41,7 @@
 #ifndef PCL_HARRIS_KEYPOINT_2D_IMPL_H_
 #define PCL_HARRIS_KEYPOINT_2D_IMPL_H_
 
+#include <pcl/common/execution_context.h>
 #include <pcl/common/point_tests.h>
 
 namespace pcl
@@ -177,6 +178,8 @@ HarrisKeypoint2D<PointInT, PointOutT, IntensityT>::initCompute ()
 template <typename PointInT, typename PointOutT, typename IntensityT> void
 HarrisKeypoint2D<PointInT, PointOutT, IntensityT>::detectKeypoints (PointCloudOut &output)
 {
+  const pcl::ThreadReservation reservation (threads_);
+  const unsigned int threads = reservation.getNumberOfThreads ();
   derivatives_cols_.resize (input_->width, input_->height);
   derivatives_rows_.resize (input_->width, input_->height);
   //Compute cloud intensities first derivatives along columns and rows
@@ -261,13 +264,13 @@ HarrisKeypoint2D<PointInT, PointOutT, IntensityT>::detectKeypoints (PointCloudOu
   default(none)                                                \
   shared(occupency_map, output)                                \
   firstprivate(width, height)                                  \
-  num_threads(threads_)
+  num_threads(threads)
 #else
 #pragma omp parallel for                                       \
   default(none)                                                \
   shared(occupency_map, occupency_map_size, output, threshold) \
   firstprivate(width, height)                                  \
-  num_threads(threads_)	
+  num_threads(threads)	
 #endif
     for (int i = 0; i < occupency_map_size; ++i)
     {
@@ -304,6 +307,8 @@ HarrisKeypoint2D<PointInT, PointOutT, IntensityT>::detectKeypoints (PointCloudOu
 template <typename PointInT, typename PointOutT, typename IntensityT> void
 HarrisKeypoint2D<PointInT, PointOutT, IntensityT>::responseHarris (PointCloudOut &output) const
 {
+  const pcl::ThreadReservation reservation (threads_);
+  const unsigned int threads = reservation.getNumberOfThreads ();
   PCL_ALIGN (16) float covar [3];
   output.clear ();
   output.resize (input_->size ());
@@ -314,13 +319,13 @@ HarrisKeypoint2D<PointInT, PointOutT, IntensityT>::responseHarris (PointCloudOut
   default(none)               \
   shared(output)              \
   firstprivate(covar)              \
-  num_threads(threads_)
+  num_threads(threads)
 #else
 #pragma omp parallel for      \
   default(none)               \
   shared(output, output_size) \
   firstprivate(covar)              \
-  num_threads(threads_)
+  num_threads(threads)
 #endif
   for (int index = 0; index < output_size; ++index)
   {
@@ -350,6 +355,8 @@ HarrisKeypoint2D<PointInT, PointOutT, IntensityT>::responseHarris (PointCloudOut
 template <typename PointInT, typename PointOutT, typename IntensityT> void
 HarrisKeypoint2D<PointInT, PointOutT, IntensityT>::responseNoble (PointCloudOut &output) const
 {
+  const pcl::ThreadReservation reservation (threads_);
+  const unsigned int threads = reservation.getNumberOfThreads ();
   PCL_ALIGN (16) float covar [3];
   output.clear ();
   output.resize (input_->size ());
@@ -360,13 +367,13 @@ HarrisKeypoint2D<PointInT, PointOutT, IntensityT>::responseNoble (PointCloudOut
   default(none)               \
   shared(output)              \
   firstprivate(covar)              \
-  num_threads(threads_)
+  num_threads(threads)
 #else
 #pragma omp parallel for      \
   default(none)               \
   shared(output, output_size) \
   firstprivate(covar)              \
-  num_threads(threads_)
+  num_threads(threads)
 #endif
   for (int index = 0; index < output_size; ++index)
   {
@@ -396,6 +403,8 @@ HarrisKeypoint2D<PointInT, PointOutT, IntensityT>::responseNoble (PointCloudOut
 template <typename PointInT, typename PointOutT, typename IntensityT> void
 HarrisKeypoint2D<PointInT, PointOutT, IntensityT>::responseLowe (PointCloudOut &output) const
 {
+  const pcl::ThreadReservation reservation (threads_);
+  const unsigned int threads = reservation.getNumberOfThreads ();
   PCL_ALIGN (16) float covar [3];
   output.clear ();
   output.resize (input_->size ());
@@ -406,13 +415,13 @@ HarrisKeypoint2D<PointInT, PointOutT, IntensityT>::responseLowe (PointCloudOut &
   default(none)               \
   shared(output)              \
   firstprivate(covar)              \
-  num_threads(threads_)
+  num_threads(threads)
 #else
 #pragma omp parallel for      \
   default(none)               \
   shared(output, output_size) \
   firstprivate(covar)              \
-  num_threads(threads_)
+  num_threads(threads)
 #endif
   for (int index = 0; index < output_size; ++index)
   {
@@ -442,6 +451,8 @@ HarrisKeypoint2D<PointInT, PointOutT, IntensityT>::responseLowe (PointCloudOut &
 template <typename PointInT, typename PointOutT, typename IntensityT> void
 HarrisKeypoint2D<PointInT, PointOutT, IntensityT>::responseTomasi (PointCloudOut &output) const
 {
+  const pcl::ThreadReservation reservation (threads_);
+  const unsigned int threads = reservation.getNumberOfThreads ();
   PCL_ALIGN (16) float covar [3];
   output.clear ();
   output.resize (input_->size ());
@@ -452,13 +463,13 @@ HarrisKeypoint2D<PointInT, PointOutT, IntensityT>::responseTomasi (PointCloudOut
   default(none)               \
   shared(output)              \
   firstprivate(covar)              \
-  num_threads(threads_)
+  num_threads(threads)
 #else
 #pragma omp parallel for      \
   default(none)               \
   shared(output, output_size) \
   firstprivate(covar)              \
-  num_threads(threads_)
+  num_threads(threads)
 #endif
   for (int index = 0; index < output_size; ++index)
   {
@@ -39,6 +39,7 @@
 #define PCL_HARRIS_KEYPOINT_3D_IMPL_H_
 
 #include <pcl/keypoints/harris_3d.h>
+#include <pcl/common/execution_context.h>
 #include <pcl/common/io.h>
 #include <pcl/features/normal_3d.h>
 #include <pcl/features/integral_image_normal.h>
@@ -237,6 +238,8 @@ pcl::HarrisKeypoint3D<PointInT, PointOutT, NormalT>::initCompute ()
 template <typename PointInT, typename PointOutT, typename NormalT> void
 pcl::HarrisKeypoint3D<PointInT, PointOutT, NormalT>::detectKeypoints (PointCloudOut &output)
 {
+  const pcl::ThreadReservation reservation (threads_);
+  const unsigned int threads = reservation.getNumberOfThreads ();
   typename pcl::PointCloud<PointOutT>::Ptr response (new pcl::PointCloud<PointOutT>);
 
   response->points.reserve (input_->size());
@@ -276,7 +279,7 @@ pcl::HarrisKeypoint3D<PointInT, PointOutT, NormalT>::detectKeypoints (PointCloud
 #pragma omp parallel for \
   default(none) \
   shared(output, response) \
-  num_threads(threads_)
+  num_threads(threads)
     for (int idx = 0; idx < static_cast<int> (response->size ()); ++idx)
     {
       if (!isFinite ((*response)[idx]) ||
@@ -317,13 +320,15 @@ pcl::HarrisKeypoint3D<PointInT, PointOutT, NormalT>::detectKeypoints (PointCloud
 template <typename PointInT, typename PointOutT, typename NormalT> void
 pcl::HarrisKeypoint3D<PointInT, PointOutT, NormalT>::responseHarris (PointCloudOut &output) const
 {
+  const pcl::ThreadReservation reservation (threads_);
+  const unsigned int threads = reservation.getNumberOfThreads ();
   PCL_ALIGN (16) float covar [8];
   output.resize (input_->size ());
 #pragma omp parallel for \
   default(none) \
   shared(output) \
   firstprivate(covar) \
-  num_threads(threads_)
+  num_threads(threads)
   for (int pIdx = 0; pIdx < static_cast<int> (input_->size ()); ++pIdx)
   {
     const PointInT& pointIn = input_->points [pIdx];
@@ -358,13 +363,15 @@ pcl::HarrisKeypoint3D<PointInT, PointOutT, NormalT>::responseHarris (PointCloudO
 template <typename PointInT, typename PointOutT, typename NormalT> void
 pcl::HarrisKeypoint3D<PointInT, PointOutT, NormalT>::responseNoble (PointCloudOut &output) const
 {
+  const pcl::ThreadReservation reservation (threads_);
+  const unsigned int threads = reservation.getNumberOfThreads ();
   PCL_ALIGN (16) float covar [8];
   output.resize (input_->size ());
 #pragma omp parallel \
   for default(none) \
   shared(output) \
   firstprivate(covar) \
-  num_threads(threads_)
+  num_threads(threads)
   for (int pIdx = 0; pIdx < static_cast<int> (input_->size ()); ++pIdx)
   {
     const PointInT& pointIn = input_->points [pIdx];
@@ -398,13 +405,15 @@ pcl::HarrisKeypoint3D<PointInT, PointOutT, NormalT>::responseNoble (PointCloudOu
 template <typename PointInT, typename PointOutT, typename NormalT> void
 pcl::HarrisKeypoint3D<PointInT, PointOutT, NormalT>::responseLowe (PointCloudOut &output) const
 {
+  const pcl::ThreadReservation reservation (threads_);
+  const unsigned int threads = reservation.getNumberOfThreads ();
   PCL_ALIGN (16) float covar [8];
   output.resize (input_->size ());
 #pragma omp parallel for \
   default(none) \
   shared(output) \
   firstprivate(covar) \
-  num_threads(threads_)
+  num_threads(threads)
   for (int pIdx = 0; pIdx < static_cast<int> (input_->size ()); ++pIdx)
   {
     const PointInT& pointIn = input_->points [pIdx];
@@ -456,6 +465,8 @@ pcl::HarrisKeypoint3D<PointInT, PointOutT, NormalT>::responseCurvature (PointClo
 template <typename PointInT, typename PointOutT, typename NormalT> void
 pcl::HarrisKeypoint3D<PointInT, PointOutT, NormalT>::responseTomasi (PointCloudOut &output) const
 {
+  const pcl::ThreadReservation reservation (threads_);
+  const unsigned int threads = reservation.getNumberOfThreads ();
   PCL_ALIGN (16) float covar [8];
   Eigen::Matrix3f covariance_matrix;
   output.resize (input_->size ());
@@ -463,7 +474,7 @@ pcl::HarrisKeypoint3D<PointInT, PointOutT, NormalT>::responseTomasi (PointCloudO
   default(none) \
   shared(output) \
   firstprivate(covar, covariance_matrix) \
-  num_threads(threads_)
+  num_threads(threads)
   for (int pIdx = 0; pIdx < static_cast<int> (input_->size ()); ++pIdx)
   {
     const PointInT& pointIn = input_->points [pIdx];
@@ -501,6 +512,8 @@ pcl::HarrisKeypoint3D<PointInT, PointOutT, NormalT>::responseTomasi (PointCloudO
 template <typename PointInT, typename PointOutT, typename NormalT> void
 pcl::HarrisKeypoint3D<PointInT, PointOutT, NormalT>::refineCorners (PointCloudOut &corners) const
 {
+  const pcl::ThreadReservation reservation (threads_);
+  const unsigned int threads = reservation.getNumberOfThreads ();
   Eigen::Matrix3f nnT;
   Eigen::Matrix3f NNT;
   Eigen::Matrix3f NNTInv;
@@ -510,7 +523,7 @@ pcl::HarrisKeypoint3D<PointInT, PointOutT, NormalT>::refineCorners (PointCloudOu
   default(none) \
   shared(corners) \
   firstprivate(nnT, NNT, NNTInv, NNTp) \
-  num_threads(threads_)
+  num_threads(threads)
   for (int cIdx = 0; cIdx < static_cast<int> (corners.size ()); ++cIdx)
   {
     unsigned iterations = 0;
@@ -40,6 +40,7 @@
 
 #include <Eigen/Eigenvalues> // for SelfAdjointEigenSolver
 #include <pcl/keypoints/harris_6d.h>
+#include <pcl/common/execution_context.h>
 #include <pcl/common/io.h>
 #include <pcl/features/normal_3d.h>
 //#include <pcl/features/fast_intensity_gradient.h>
@@ -141,6 +142,8 @@ pcl::HarrisKeypoint6D<PointInT, PointOutT, NormalT>::calculateCombinedCovar (con
 template <typename PointInT, typename PointOutT, typename NormalT> void
 pcl::HarrisKeypoint6D<PointInT, PointOutT, NormalT>::detectKeypoints (PointCloudOut &output)
 {
+  const pcl::ThreadReservation reservation (threads_);
+  const unsigned int threads = reservation.getNumberOfThreads ();
   if (normals_->empty ())
   {
     normals_->reserve (surface_->size ());
@@ -165,7 +168,7 @@ pcl::HarrisKeypoint6D<PointInT, PointOutT, NormalT>::detectKeypoints (PointCloud
   cloud->resize (surface_->size ());
 #pragma omp parallel for \
   default(none) \
-  num_threads(threads_)
+  num_threads(threads)
   for (unsigned idx = 0; idx < surface_->size (); ++idx)
   {
     cloud->points [idx].x = surface_->points [idx].x;
@@ -185,7 +188,7 @@ pcl::HarrisKeypoint6D<PointInT, PointOutT, NormalT>::detectKeypoints (PointCloud
   
 #pragma omp parallel for \
   default(none) \
-  num_threads(threads_)
+  num_threads(threads)
   for (std::size_t idx = 0; idx < intensity_gradients_->size (); ++idx)
   {
     float len = intensity_gradients_->points [idx].gradient_x * intensity_gradients_->points [idx].gradient_x +
@@ -228,7 +231,7 @@ pcl::HarrisKeypoint6D<PointInT, PointOutT, NormalT>::detectKeypoints (PointCloud
 
 #pragma omp parallel for \
   default(none) \
-  num_threads(threads_)
+  num_threads(threads)
     for (std::size_t idx = 0; idx < response->size (); ++idx)
     {
       if (!isFinite ((*response)[idx]) || (*response)[idx].intensity < threshold_)
@@ -266,6 +269,8 @@ pcl::HarrisKeypoint6D<PointInT, PointOutT, NormalT>::detectKeypoints (PointCloud
 template <typename PointInT, typename PointOutT, typename NormalT> void
 pcl::HarrisKeypoint6D<PointInT, PointOutT, NormalT>::responseTomasi (PointCloudOut &output) const
 {
+  const pcl::ThreadReservation reservation (threads_);
+  const unsigned int threads = reservation.getNumberOfThreads ();
   // get the 6x6 covar-mat
   PointOutT pointOut;
   PCL_ALIGN (16) float covar [21];
@@ -275,7 +280,7 @@ pcl::HarrisKeypoint6D<PointInT, PointOutT, NormalT>::responseTomasi (PointCloudO
 #pragma omp parallel for \
   default(none) \
   firstprivate(pointOut, covar, covariance, solver) \
-  num_threads(threads_)
+  num_threads(threads)
   for (unsigned pIdx = 0; pIdx < input_->size (); ++pIdx)
   {
     const PointInT& pointIn = input_->points [pIdx];
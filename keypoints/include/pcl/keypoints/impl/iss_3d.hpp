@@ -38,12 +38,14 @@
 #ifndef PCL_ISS_KEYPOINT3D_IMPL_H_
 #define PCL_ISS_KEYPOINT3D_IMPL_H_
 
+#include <algorithm> // for max
 #include <Eigen/Eigenvalues> // for SelfAdjointEigenSolver
 #include <pcl/features/boundary.h>
 #include <pcl/features/normal_3d.h>
 #include <pcl/features/integral_image_normal.h>
 
 #include <pcl/keypoints/iss_3d.h>
+#include <pcl/common/execution_context.h>
 
 //////////////////////////////////////////////////////////////////////////////////////////////
 template<typename PointInT, typename PointOutT, typename NormalT> void
@@ -105,6 +107,8 @@ pcl::ISSKeypoint3D<PointInT, PointOutT, NormalT>::setNormals (const PointCloudNC
 template<typename PointInT, typename PointOutT, typename NormalT> bool*
 pcl::ISSKeypoint3D<PointInT, PointOutT, NormalT>::getBoundaryPoints (PointCloudIn &input, double border_radius, float angle_threshold)
 {
+  const pcl::ThreadReservation reservation (threads_);
+  unsigned int threads = reservation.getNumberOfThreads ();
   bool* edge_points = new bool [input.size ()];
 
   Eigen::Vector4f u = Eigen::Vector4f::Zero ();
@@ -117,7 +121,7 @@ pcl::ISSKeypoint3D<PointInT, PointOutT, NormalT>::getBoundaryPoints (PointCloudI
   default(none) \
   shared(angle_threshold, boundary_estimator, border_radius, edge_points, input) \
   firstprivate(u, v) \
-  num_threads(threads_)
+  num_threads(threads)
   for (int index = 0; index < int (input.size ()); index++)
   {
     edge_points[index] = false;
@@ -196,6 +200,124 @@ pcl::ISSKeypoint3D<PointInT, PointOutT, NormalT>::getScatterMatrix (const int& c
 	   cov[6], cov[7], cov[8];
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////
+template<typename PointInT, typename PointOutT, typename NormalT> void
+pcl::ISSKeypoint3D<PointInT, PointOutT, NormalT>::detectKeypointsWithSharedNeighborhoods (const bool *borders, PointCloudOut &output)
+{
+  const pcl::ThreadReservation reservation (threads_);
+  unsigned int threads = reservation.getNumberOfThreads ();
+  int nr_points = static_cast<int> (input_->size ());
+  double search_radius = std::max (salient_radius_, non_max_radius_);
+  float salient_radius_sqr = static_cast<float> (salient_radius_ * salient_radius_);
+  float non_max_radius_sqr = static_cast<float> (non_max_radius_ * non_max_radius_);
+
+  // Neighborhoods within the non maxima radius, only kept for the candidate keypoints
+  std::vector<pcl::Indices> non_max_neighbors (input_->size ());
+
+  pcl::Indices nn_indices;
+  std::vector<float> nn_distances;
+#pragma omp parallel for \
+  default(none) \
+  shared(borders, non_max_neighbors, nr_points, search_radius, salient_radius_sqr, non_max_radius_sqr) \
+  firstprivate(nn_indices, nn_distances) \
+  schedule(dynamic, 64) \
+  num_threads(threads)
+  for (int index = 0; index < nr_points; index++)
+  {
+    const PointInT& current_point = (*input_)[index];
+    if (borders[index] || !pcl::isFinite (current_point))
+      continue;
+
+    this->searchForNeighbors (index, search_radius, nn_indices, nn_distances);
+
+    // Scatter matrix over the neighbors within the salient radius
+    double cov[9] = {0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0};
+    int n_salient = 0;
+    for (std::size_t i_neighbor = 0; i_neighbor < nn_indices.size (); ++i_neighbor)
+    {
+      if (nn_distances[i_neighbor] > salient_radius_sqr)
+        continue;
+      const PointInT& n_point = (*input_)[nn_indices[i_neighbor]];
+      const double diff[3] = {static_cast<double> (n_point.x) - current_point.x,
+                              static_cast<double> (n_point.y) - current_point.y,
+                              static_cast<double> (n_point.z) - current_point.z};
+      for (int i = 0; i < 3; i++)
+        for (int j = 0; j < 3; j++)
+          cov[i * 3 + j] += diff[i] * diff[j];
+      ++n_salient;
+    }
+    if (n_salient < min_neighbors_)
+      continue;
+
+    Eigen::Matrix3d cov_m;
+    cov_m << cov[0], cov[1], cov[2],
+             cov[3], cov[4], cov[5],
+             cov[6], cov[7], cov[8];
+    Eigen::SelfAdjointEigenSolver<Eigen::Matrix3d> solver (cov_m);
+
+    const double& e1c = solver.eigenvalues ()[2];
+    const double& e2c = solver.eigenvalues ()[1];
+    const double& e3c = solver.eigenvalues ()[0];
+
+    if (!std::isfinite (e1c) || !std::isfinite (e2c) || !std::isfinite (e3c))
+      continue;
+
+    if (e3c < 0)
+    {
+      PCL_WARN ("[pcl::%s::detectKeypoints] : The third eigenvalue is negative! Skipping the point with index %i.\n",
+                name_.c_str (), index);
+      continue;
+    }
+
+    if ((e2c / e1c < gamma_21_) && (e3c / e2c < gamma_32_))
+      third_eigen_value_[index] = e3c;
+
+    if (third_eigen_value_[index] <= 0.0)
+      continue;
+
+    // Keep the non maxima suppression neighborhood of the candidate
+    pcl::Indices& non_max_indices = non_max_neighbors[index];
+    for (std::size_t i_neighbor = 0; i_neighbor < nn_indices.size (); ++i_neighbor)
+      if (nn_distances[i_neighbor] <= non_max_radius_sqr)
+        non_max_indices.push_back (nn_indices[i_neighbor]);
+  }
+
+  std::vector<unsigned char> feat_max (input_->size (), 0);
+#pragma omp parallel for \
+  default(none) \
+  shared(feat_max, non_max_neighbors, nr_points) \
+  schedule(dynamic, 64) \
+  num_threads(threads)
+  for (int index = 0; index < nr_points; index++)
+  {
+    const pcl::Indices& non_max_indices = non_max_neighbors[index];
+    if (third_eigen_value_[index] <= 0.0 || static_cast<int> (non_max_indices.size ()) < min_neighbors_)
+      continue;
+
+    bool is_max = true;
+    for (const auto& j : non_max_indices)
+    {
+      if (third_eigen_value_[index] < third_eigen_value_[j])
+      {
+        is_max = false;
+        break;
+      }
+    }
+    feat_max[index] = is_max;
+  }
+
+  for (int index = 0; index < nr_points; index++)
+  {
+    if (feat_max[index])
+    {
+      PointOutT p;
+      p.getVector3fMap () = (*input_)[index].getVector3fMap ();
+      output.push_back (p);
+      keypoints_indices_->indices.push_back (index);
+    }
+  }
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////
 template<typename PointInT, typename PointOutT, typename NormalT> bool
 pcl::ISSKeypoint3D<PointInT, PointOutT, NormalT>::initCompute ()
@@ -292,6 +414,8 @@ pcl::ISSKeypoint3D<PointInT, PointOutT, NormalT>::initCompute ()
 template<typename PointInT, typename PointOutT, typename NormalT> void
 pcl::ISSKeypoint3D<PointInT, PointOutT, NormalT>::detectKeypoints (PointCloudOut &output)
 {
+  const pcl::ThreadReservation reservation (threads_);
+  unsigned int threads = reservation.getNumberOfThreads ();
   // Make sure the output cloud is empty
   output.clear ();
 
@@ -303,7 +427,7 @@ pcl::ISSKeypoint3D<PointInT, PointOutT, NormalT>::detectKeypoints (PointCloudOut
 #pragma omp parallel for \
   default(none) \
   shared(borders) \
-  num_threads(threads_)
+  num_threads(threads)
   for (int index = 0; index < int (input_->size ()); index++)
   {
     borders[index] = false;
@@ -327,10 +451,25 @@ pcl::ISSKeypoint3D<PointInT, PointOutT, NormalT>::detectKeypoints (PointCloudOut
     }
   }
 
+  if (reuse_neighborhoods_)
+  {
+    detectKeypointsWithSharedNeighborhoods (borders, output);
+
+    output.header = input_->header;
+    output.width = output.size ();
+    output.height = 1;
+
+    if (border_radius_ > 0.0)
+      normals_.reset (new pcl::PointCloud<NormalT>);
+
+    delete[] borders;
+    return;
+  }
+
 #ifdef _OPENMP
-  Eigen::Vector3d *omp_mem = new Eigen::Vector3d[threads_];
+  Eigen::Vector3d *omp_mem = new Eigen::Vector3d[threads];
 
-  for (std::size_t i = 0; i < threads_; i++)
+  for (std::size_t i = 0; i < threads; i++)
     omp_mem[i].setZero (3);
 #else
   Eigen::Vector3d *omp_mem = new Eigen::Vector3d[1];
@@ -347,7 +486,7 @@ pcl::ISSKeypoint3D<PointInT, PointOutT, NormalT>::detectKeypoints (PointCloudOut
 #pragma omp parallel for \
   default(none) \
   shared(borders, omp_mem, prg_mem) \
-  num_threads(threads_)
+  num_threads(threads)
   for (int index = 0; index < static_cast<int> (input_->size ()); index++)
   {
 #ifdef _OPENMP
@@ -402,7 +541,7 @@ pcl::ISSKeypoint3D<PointInT, PointOutT, NormalT>::detectKeypoints (PointCloudOut
 #pragma omp parallel for \
   default(none) \
   shared(feat_max) \
-  num_threads(threads_)
+  num_threads(threads)
   for (int index = 0; index < int (input_->size ()); index++)
   {
     feat_max [index] = false;
@@ -434,7 +573,7 @@ pcl::ISSKeypoint3D<PointInT, PointOutT, NormalT>::detectKeypoints (PointCloudOut
 #pragma omp parallel for \
   default(none) \
   shared(feat_max, output) \
-  num_threads(threads_)
+  num_threads(threads)
   for (int index = 0; index < int (input_->size ()); index++)
   {
     if (feat_max[index])
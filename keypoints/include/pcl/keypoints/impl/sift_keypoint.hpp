@@ -39,9 +39,13 @@
 #define PCL_SIFT_KEYPOINT_IMPL_H_
 
 #include <pcl/keypoints/sift_keypoint.h>
+#include <pcl/common/execution_context.h>
 #include <pcl/common/io.h>
 #include <pcl/filters/voxel_grid.h>
 
+#include <algorithm>
+#include <utility>
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointInT, typename PointOutT> void 
 pcl::SIFTKeypoint<PointInT, PointOutT>::setScales (float min_scale, int nr_octaves, int nr_scales_per_octave)
@@ -59,6 +63,14 @@ pcl::SIFTKeypoint<PointInT, PointOutT>::setMinimumContrast (float min_contrast)
   min_contrast_ = min_contrast;
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointInT, typename PointOutT> void
+pcl::SIFTKeypoint<PointInT, PointOutT>::setNumberOfThreads (unsigned int nr_threads)
+{
+  // 0 is resolved against the budget of pcl::ExecutionContext at compute time
+  threads_ = nr_threads;
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointInT, typename PointOutT> bool
 pcl::SIFTKeypoint<PointInT, PointOutT>::initCompute ()
@@ -211,36 +223,61 @@ void pcl::SIFTKeypoint<PointInT, PointOutT>::computeScaleSpace (
     const PointCloudIn &input, KdTree &tree, const std::vector<float> &scales, 
     Eigen::MatrixXf &diff_of_gauss)
 {
+  const pcl::ThreadReservation reservation (threads_);
+  const unsigned int threads = reservation.getNumberOfThreads ();
   diff_of_gauss.resize (input.size (), scales.size () - 1);
 
   // For efficiency, we will only filter over points within 3 standard deviations 
-  const float max_radius = 3.0f * scales.back ();
+  float max_radius = 3.0f * scales.back ();
 
-  for (int i_point = 0; i_point < static_cast<int> (input.size ()); ++i_point)
+  // The Gaussian of every scale is evaluated on the same neighborhood, so the variances and cut-off distances are
+  // computed once per octave
+  std::size_t nr_scales = scales.size ();
+  std::vector<float> sigma_sqr (nr_scales), max_dist_sqr (nr_scales);
+  for (std::size_t i_scale = 0; i_scale < nr_scales; ++i_scale)
+  {
+    sigma_sqr[i_scale] = powf (scales[i_scale], 2.0f);
+    max_dist_sqr[i_scale] = 9.0f * sigma_sqr[i_scale];
+  }
+
+  int nr_points = static_cast<int> (input.size ());
+  pcl::Indices nn_indices;
+  std::vector<float> nn_dist;
+  std::vector<float> nn_values;
+#pragma omp parallel for \
+  default(none) \
+  shared(input, tree, diff_of_gauss, sigma_sqr, max_dist_sqr, max_radius, nr_points, nr_scales) \
+  firstprivate(nn_indices, nn_dist, nn_values) \
+  schedule(dynamic, 64) \
+  num_threads(threads)
+  for (int i_point = 0; i_point < nr_points; ++i_point)
   {
-    pcl::Indices nn_indices;
-    std::vector<float> nn_dist;
     tree.radiusSearch (i_point, max_radius, nn_indices, nn_dist); // *
     // * note: at this stage of the algorithm, we must find all points within a radius defined by the maximum scale, 
     //   regardless of the configurable search method specified by the user, so we directly employ tree.radiusSearch 
     //   here instead of using searchForNeighbors.
 
+    // Fetch the neighbor values once for all scales
+    nn_values.resize (nn_indices.size ());
+    for (std::size_t i_neighbor = 0; i_neighbor < nn_indices.size (); ++i_neighbor)
+      nn_values[i_neighbor] = getFieldValue_ (input[nn_indices[i_neighbor]]);
+
     // For each scale, compute the Gaussian "filter response" at the current point
     float filter_response = 0.0f;
-    for (std::size_t i_scale = 0; i_scale < scales.size (); ++i_scale)
+    for (std::size_t i_scale = 0; i_scale < nr_scales; ++i_scale)
     {
-      float sigma_sqr = powf (scales[i_scale], 2.0f);
+      const float sigma_sqr_scale = sigma_sqr[i_scale];
+      const float max_dist = max_dist_sqr[i_scale];
 
       float numerator = 0.0f;
       float denominator = 0.0f;
       for (std::size_t i_neighbor = 0; i_neighbor < nn_indices.size (); ++i_neighbor)
       {
-        const float &value = getFieldValue_ (input[nn_indices[i_neighbor]]);
         const float &dist_sqr = nn_dist[i_neighbor];
-        if (dist_sqr <= 9*sigma_sqr)
+        if (dist_sqr <= max_dist)
         {
-          float w = std::exp (-0.5f * dist_sqr / sigma_sqr);
-          numerator += value * w;
+          float w = std::exp (-0.5f * dist_sqr / sigma_sqr_scale);
+          numerator += nn_values[i_neighbor] * w;
           denominator += w;
         }
         else break; // i.e. if dist > 3 standard deviations, then terminate early
@@ -261,62 +298,85 @@ pcl::SIFTKeypoint<PointInT, PointOutT>::findScaleSpaceExtrema (
     const PointCloudIn &input, KdTree &tree, const Eigen::MatrixXf &diff_of_gauss, 
     pcl::Indices &extrema_indices, std::vector<int> &extrema_scales)
 {
-  const int k = 25;
+  const pcl::ThreadReservation reservation (threads_);
+  const unsigned int threads = reservation.getNumberOfThreads ();
+  int k = 25;
   pcl::Indices nn_indices (k);
   std::vector<float> nn_dist (k);
 
-  const int nr_scales = static_cast<int> (diff_of_gauss.cols ());
+  int nr_scales = static_cast<int> (diff_of_gauss.cols ());
   std::vector<float> min_val (nr_scales), max_val (nr_scales);
 
-  for (int i_point = 0; i_point < static_cast<int> (input.size ()); ++i_point)
+  int nr_points = static_cast<int> (input.size ());
+  // (point index, scale index) of every extremum, sorted afterwards to keep the order independent of the threads
+  std::vector<std::pair<int, int> > extrema;
+#pragma omp parallel \
+  default(none) \
+  shared(tree, diff_of_gauss, extrema, k, nr_points, nr_scales) \
+  firstprivate(nn_indices, nn_dist, min_val, max_val) \
+  num_threads(threads)
   {
-    // Define the local neighborhood around the current point
-    const std::size_t nr_nn = tree.nearestKSearch (i_point, k, nn_indices, nn_dist); //*
-    // * note: the neighborhood for finding local extrema is best defined as a small fixed-k neighborhood, regardless of
-    //   the configurable search method specified by the user, so we directly employ tree.nearestKSearch here instead 
-    //   of using searchForNeighbors
-
-    // At each scale, find the extreme values of the DoG within the current neighborhood
-    for (int i_scale = 0; i_scale < nr_scales; ++i_scale)
+    std::vector<std::pair<int, int> > local_extrema;
+#pragma omp for schedule(dynamic, 64)
+    for (int i_point = 0; i_point < nr_points; ++i_point)
     {
-      min_val[i_scale] = std::numeric_limits<float>::max ();
-      max_val[i_scale] = -std::numeric_limits<float>::max ();
-
-      for (std::size_t i_neighbor = 0; i_neighbor < nr_nn; ++i_neighbor)
+      // Define the local neighborhood around the current point
+      const std::size_t nr_nn = tree.nearestKSearch (i_point, k, nn_indices, nn_dist); //*
+      // * note: the neighborhood for finding local extrema is best defined as a small fixed-k neighborhood, regardless of
+      //   the configurable search method specified by the user, so we directly employ tree.nearestKSearch here instead 
+      //   of using searchForNeighbors
+
+      // At each scale, find the extreme values of the DoG within the current neighborhood
+      for (int i_scale = 0; i_scale < nr_scales; ++i_scale)
       {
-        const float &d = diff_of_gauss (nn_indices[i_neighbor], i_scale);
+        min_val[i_scale] = std::numeric_limits<float>::max ();
+        max_val[i_scale] = -std::numeric_limits<float>::max ();
 
-        min_val[i_scale] = (std::min) (min_val[i_scale], d);
-        max_val[i_scale] = (std::max) (max_val[i_scale], d);
-      }
-    }
+        for (std::size_t i_neighbor = 0; i_neighbor < nr_nn; ++i_neighbor)
+        {
+          const float &d = diff_of_gauss (nn_indices[i_neighbor], i_scale);
 
-    // If the current point is an extreme value with high enough contrast, add it as a keypoint 
-    for (int i_scale = 1; i_scale < nr_scales - 1; ++i_scale)
-    {
-      const float &val = diff_of_gauss (i_point, i_scale);
+          min_val[i_scale] = (std::min) (min_val[i_scale], d);
+          max_val[i_scale] = (std::max) (max_val[i_scale], d);
+        }
+      }
 
-      // Does the point have sufficient contrast?
-      if (std::abs (val) >= min_contrast_)
+      // If the current point is an extreme value with high enough contrast, add it as a keypoint 
+      for (int i_scale = 1; i_scale < nr_scales - 1; ++i_scale)
       {
-        // Is it a local minimum?
-        if ((val == min_val[i_scale]) && 
-            (val <  min_val[i_scale - 1]) && 
-            (val <  min_val[i_scale + 1]))
-        {
-          extrema_indices.push_back (i_point);
-          extrema_scales.push_back (i_scale);
-        }
-        // Is it a local maximum?
-        else if ((val == max_val[i_scale]) && 
-                 (val >  max_val[i_scale - 1]) && 
-                 (val >  max_val[i_scale + 1]))
+        const float &val = diff_of_gauss (i_point, i_scale);
+
+        // Does the point have sufficient contrast?
+        if (std::abs (val) >= min_contrast_)
         {
-          extrema_indices.push_back (i_point);
-          extrema_scales.push_back (i_scale);
+          // Is it a local minimum?
+          if ((val == min_val[i_scale]) && 
+              (val <  min_val[i_scale - 1]) && 
+              (val <  min_val[i_scale + 1]))
+          {
+            local_extrema.emplace_back (i_point, i_scale);
+          }
+          // Is it a local maximum?
+          else if ((val == max_val[i_scale]) && 
+                   (val >  max_val[i_scale - 1]) && 
+                   (val >  max_val[i_scale + 1]))
+          {
+            local_extrema.emplace_back (i_point, i_scale);
+          }
         }
       }
     }
+#pragma omp critical
+    extrema.insert (extrema.end (), local_extrema.begin (), local_extrema.end ());
+  }
+
+  std::sort (extrema.begin (), extrema.end ());
+  extrema_indices.reserve (extrema_indices.size () + extrema.size ());
+  extrema_scales.reserve (extrema_scales.size () + extrema.size ());
+  for (const auto &extremum : extrema)
+  {
+    extrema_indices.push_back (extremum.first);
+    extrema_scales.push_back (extremum.second);
   }
 }
 
@@ -39,6 +39,8 @@
 #ifndef PCL_TRAJKOVIC_KEYPOINT_2D_IMPL_H_
 #define PCL_TRAJKOVIC_KEYPOINT_2D_IMPL_H_
 
+#include <pcl/common/execution_context.h>
+
 
 namespace pcl
 {
@@ -85,6 +87,8 @@ TrajkovicKeypoint2D<PointInT, PointOutT, IntensityT>::initCompute ()
 template <typename PointInT, typename PointOutT, typename IntensityT> void
 TrajkovicKeypoint2D<PointInT, PointOutT, IntensityT>::detectKeypoints (PointCloudOut &output)
 {
+  const pcl::ThreadReservation reservation (threads_);
+  const unsigned int threads = reservation.getNumberOfThreads ();
   response_.reset (new pcl::PointCloud<float> (input_->width, input_->height));
   const int w = static_cast<int> (input_->width) - half_window_size_;
   const int h = static_cast<int> (input_->height) - half_window_size_;
@@ -94,12 +98,12 @@ TrajkovicKeypoint2D<PointInT, PointOutT, IntensityT>::detectKeypoints (PointClou
 #if OPENMP_LEGACY_CONST_DATA_SHARING_RULE
 #pragma omp parallel for \
   default(none) \
-  num_threads(threads_)
+  num_threads(threads)
 #else
 #pragma omp parallel for \
   default(none) \
   shared(h, w) \
-  num_threads(threads_)
+  num_threads(threads)
 #endif
     for(int j = half_window_size_; j < h; ++j)
     {
@@ -142,12 +146,12 @@ TrajkovicKeypoint2D<PointInT, PointOutT, IntensityT>::detectKeypoints (PointClou
 #if OPENMP_LEGACY_CONST_DATA_SHARING_RULE
 #pragma omp parallel for \
   default(none) \
-  num_threads(threads_)
+  num_threads(threads)
 #else
 #pragma omp parallel for \
   default(none) \
   shared(h, w) \
-  num_threads(threads_)
+  num_threads(threads)
 #endif
     for(int j = half_window_size_; j < h; ++j)
     {
@@ -239,12 +243,12 @@ TrajkovicKeypoint2D<PointInT, PointOutT, IntensityT>::detectKeypoints (PointClou
 #pragma omp parallel for \
   default(none) \
   shared(indices, occupency_map, output) \
-  num_threads(threads_)
+  num_threads(threads)
 #else
 #pragma omp parallel for \
   default(none) \
   shared(height, indices, occupency_map, output, width) \
-  num_threads(threads_)
+  num_threads(threads)
 #endif
   for (std::size_t i = 0; i < indices.size (); ++i)
   {
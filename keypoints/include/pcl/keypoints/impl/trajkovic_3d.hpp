@@ -38,6 +38,7 @@
 #ifndef PCL_TRAJKOVIC_KEYPOINT_3D_IMPL_H_
 #define PCL_TRAJKOVIC_KEYPOINT_3D_IMPL_H_
 
+#include <pcl/common/execution_context.h>
 #include <pcl/features/integral_image_normal.h>
 
 
@@ -97,6 +98,8 @@ TrajkovicKeypoint3D<PointInT, PointOutT, NormalT>::initCompute ()
 template <typename PointInT, typename PointOutT, typename NormalT> void
 TrajkovicKeypoint3D<PointInT, PointOutT, NormalT>::detectKeypoints (PointCloudOut &output)
 {
+  const pcl::ThreadReservation reservation (threads_);
+  const unsigned int threads = reservation.getNumberOfThreads ();
   response_.reset (new pcl::PointCloud<float> (input_->width, input_->height));
   const Normals &normals = *normals_;
   const PointCloudIn &input = *input_;
@@ -110,12 +113,12 @@ TrajkovicKeypoint3D<PointInT, PointOutT, NormalT>::detectKeypoints (PointCloudOu
 #pragma omp parallel for \
   default(none) \
   shared(input, normals, response) \
-  num_threads(threads_)
+  num_threads(threads)
 #else
 #pragma omp parallel for \
   default(none) \
   shared(h, input, normals, response, w) \
-  num_threads(threads_)
+  num_threads(threads)
 #endif
     for(int j = half_window_size_; j < h; ++j)
     {
@@ -160,12 +163,12 @@ TrajkovicKeypoint3D<PointInT, PointOutT, NormalT>::detectKeypoints (PointCloudOu
 #pragma omp parallel for \
   default(none) \
   shared(input, normals, response) \
-  num_threads(threads_)
+  num_threads(threads)
 #else
 #pragma omp parallel for \
   default(none) \
   shared(h, input, normals, response, w) \
-  num_threads(threads_)
+  num_threads(threads)
 #endif
     for(int j = half_window_size_; j < h; ++j)
     {
@@ -254,12 +257,12 @@ TrajkovicKeypoint3D<PointInT, PointOutT, NormalT>::detectKeypoints (PointCloudOu
 #pragma omp parallel for \
   default(none) \
   shared(indices, occupency_map, output) \
-  num_threads(threads_)
+  num_threads(threads)
 #else
 #pragma omp parallel for \
   default(none) \
   shared(height, indices, occupency_map, output, width) \
-  num_threads(threads_)
+  num_threads(threads)
 #endif
   for (int i = 0; i < static_cast<int>(indices.size ()); ++i)
   {
@@ -122,6 +122,7 @@ namespace pcl
       , normals_ (new pcl::PointCloud<NormalT>)
       , angle_threshold_ (static_cast<float> (M_PI) / 2.0f)
       , threads_ (0)
+      , reuse_neighborhoods_ (false)
       {
         name_ = "ISSKeypoint3D";
         search_radius_ = salient_radius_;
@@ -200,6 +201,19 @@ namespace pcl
       inline void
       setNumberOfThreads (unsigned int nr_threads = 0) { threads_ = nr_threads; }
 
+      /** \brief Search the neighborhood of every point only once, at the larger of the salient and non maxima
+        * radii, and derive both the scatter matrix and the non maxima suppression neighborhoods from it.
+        * The neighborhoods of the candidate keypoints are kept for a parallel suppression pass over the flat array of
+        * third eigenvalues. Points whose eigen decomposition fails are never keypoints in this mode.
+        * \param[in] reuse_neighborhoods true to search each neighborhood only once (default false)
+        */
+      inline void
+      setReuseNeighborhoods (bool reuse_neighborhoods) { reuse_neighborhoods_ = reuse_neighborhoods; }
+
+      /** \brief Get whether each neighborhood is searched only once, see setReuseNeighborhoods. */
+      inline bool
+      getReuseNeighborhoods () const { return (reuse_neighborhoods_); }
+
     protected:
 
       /** \brief Compute the boundary points for the given input cloud.
@@ -218,6 +232,14 @@ namespace pcl
       void
       getScatterMatrix (const int &current_index, Eigen::Matrix3d &cov_m);
 
+      /** \brief Compute the third eigenvalues and apply the non maxima suppression with a single neighborhood search
+        * per point, see setReuseNeighborhoods.
+        * \param[in] borders the points that lie close to the boundary of the input cloud
+        * \param[out] output the resultant cloud of keypoints
+        */
+      void
+      detectKeypointsWithSharedNeighborhoods (const bool *borders, PointCloudOut &output);
+
       /** \brief Perform the initial checks before computing the keypoints.
        *  \return true if all the checks are passed, false otherwise
         */
@@ -267,6 +289,9 @@ namespace pcl
       /** \brief The number of threads that has to be used by the scheduler. */
       unsigned int threads_;
 
+      /** \brief Whether each neighborhood is searched only once, see setReuseNeighborhoods. */
+      bool reuse_neighborhoods_;
+
   };
 
 }
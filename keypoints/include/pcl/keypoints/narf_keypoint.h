@@ -108,7 +108,7 @@ class PCL_EXPORTS NarfKeypoint : public Keypoint<PointWithRange, int>
       bool no_of_polynomial_approximations_per_point; /**< If this is >0, the exact position of the interest point is
                                                            determined using bivariate polynomial approximations of the
                                                            interest values of the area. */
-      int max_no_of_threads;  //!< The maximum number of threads this code is allowed to use with OPNEMP
+      int max_no_of_threads;  //!< The maximum number of threads this code is allowed to use with OPNEMP, 0 takes as many as the budget of pcl::ExecutionContext allows
       bool use_recursive_scale_reduction;  /**< Try to decrease runtime by extracting interest points at lower reolution
                                              *  in areas that contain enough points, i.e., have lower range. */
       bool calculate_sparse_interest_image;  /**< Use some heuristics to decide which areas of the interest image
@@ -188,6 +188,9 @@ class PCL_EXPORTS NarfKeypoint : public Keypoint<PointWithRange, int>
     std::vector<RangeImage*> range_image_scale_space_;
     std::vector<RangeImageBorderExtractor*> border_extractor_scale_space_;
     std::vector<float*> interest_image_scale_space_;
+    //! Owned range images and border extractors for the scales > 0. Kept across clearData () to reuse their memory.
+    std::vector<RangeImage*> range_image_scale_space_storage_;
+    std::vector<RangeImageBorderExtractor*> border_extractor_scale_space_storage_;
 };
 
 /** 
@@ -110,7 +110,7 @@ namespace pcl
       /** \brief Empty constructor. */
       SIFTKeypoint () : min_scale_ (0.0), nr_octaves_ (0), nr_scales_per_octave_ (0), 
         min_contrast_ (-std::numeric_limits<float>::max ()), scale_idx_ (-1), 
-        getFieldValue_ ()
+        getFieldValue_ (), threads_ (1)
       {
         name_ = "SIFTKeypoint";
       }
@@ -129,6 +129,13 @@ namespace pcl
       void 
       setMinimumContrast (float min_contrast);
 
+      /** \brief Initialize the scheduler and set the number of threads to use for building the DoG scale space and
+        * searching its extrema. The keypoints do not depend on the number of threads.
+        * \param nr_threads the number of hardware threads to use (0 takes as many as the budget of pcl::ExecutionContext allows when detecting the keypoints)
+        */
+      void
+      setNumberOfThreads (unsigned int nr_threads = 0);
+
     protected:
       bool
       initCompute () override;
@@ -197,6 +204,9 @@ namespace pcl
       std::vector<pcl::PCLPointField> out_fields_;
 
       SIFTKeypointFieldSelector<PointInT> getFieldValue_;
+
+      /** \brief The number of threads the scheduler should use. */
+      unsigned int threads_;
   };
 }
 
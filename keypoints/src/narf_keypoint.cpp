@@ -33,9 +33,12 @@
  *
  */
 
+#include <algorithm>
 #include <iostream>
 #include <vector>
+#include <typeinfo>
 #include <pcl/keypoints/narf_keypoint.h>
+#include <pcl/common/execution_context.h>
 #include <pcl/features/range_image_border_extractor.h>
 #include <pcl/pcl_macros.h>
 #include <pcl/common/polynomial_calculations.h>
@@ -60,6 +63,10 @@ NarfKeypoint::~NarfKeypoint ()
 {
   //std::cerr << __PRETTY_FUNCTION__<<" called.\n";
   clearData ();
+  for (auto& border_extractor : border_extractor_scale_space_storage_)
+    delete border_extractor;
+  for (auto& range_image : range_image_scale_space_storage_)
+    delete range_image;
 }
 
 /////////////////////////////////////////////////////////////////////////
@@ -68,11 +75,8 @@ void
 {
   //std::cerr << __PRETTY_FUNCTION__<<" called.\n";
   
-  for (std::size_t scale_space_idx = 1; scale_space_idx<border_extractor_scale_space_.size (); ++scale_space_idx)
-    delete border_extractor_scale_space_[scale_space_idx];
+  // The range images and border extractors of the higher scales stay in the *_storage_ members for the next frame
   border_extractor_scale_space_.clear ();
-  for (std::size_t scale_space_idx = 1; scale_space_idx<range_image_scale_space_.size (); ++scale_space_idx)
-    delete range_image_scale_space_[scale_space_idx];
   range_image_scale_space_.clear ();
   for (std::size_t scale_space_idx = 1; scale_space_idx<interest_image_scale_space_.size (); ++scale_space_idx)
     delete[] interest_image_scale_space_[scale_space_idx];
@@ -115,9 +119,21 @@ NarfKeypoint::calculateScaleSpace ()
   
   while (0.5f*range_image_scale_space_.back ()->getAngularResolution () < deg2rad (2.0f))
   {
-    range_image_scale_space_.push_back (getRangeImage ().getNew ());
+    // Reuse the objects of the previous frame if possible
+    std::size_t storage_idx = range_image_scale_space_.size ()-1;
+    if (storage_idx >= range_image_scale_space_storage_.size ())
+    {
+      range_image_scale_space_storage_.push_back (getRangeImage ().getNew ());
+      border_extractor_scale_space_storage_.push_back (new RangeImageBorderExtractor);
+    }
+    else if (typeid (*range_image_scale_space_storage_[storage_idx]) != typeid (getRangeImage ()))
+    {
+      delete range_image_scale_space_storage_[storage_idx];
+      range_image_scale_space_storage_[storage_idx] = getRangeImage ().getNew ();
+    }
+    range_image_scale_space_.push_back (range_image_scale_space_storage_[storage_idx]);
     range_image_scale_space_[range_image_scale_space_.size ()-2]->getHalfImage (*range_image_scale_space_.back ());
-    border_extractor_scale_space_.push_back (new RangeImageBorderExtractor);
+    border_extractor_scale_space_.push_back (border_extractor_scale_space_storage_[storage_idx]);
     border_extractor_scale_space_.back ()->getParameters () = range_image_border_extractor_->getParameters ();
     border_extractor_scale_space_.back ()->setRangeImage (range_image_scale_space_.back ());
   }
@@ -218,6 +234,8 @@ NarfKeypoint::calculateInterestImage ()
 void 
 NarfKeypoint::calculateCompleteInterestImage ()
 {
+  const pcl::ThreadReservation reservation (static_cast<unsigned int> (std::max (parameters_.max_no_of_threads, 0)));
+  const unsigned int threads = reservation.getNumberOfThreads ();
   //std::cout << __PRETTY_FUNCTION__ << " called.\n";
   
   if (parameters_.support_size <= 0.0f)
@@ -285,7 +303,7 @@ NarfKeypoint::calculateCompleteInterestImage ()
          surface_change_directions, surface_change_scores, start_usage_range) \
   firstprivate(was_touched, neighbors_to_check, angle_histogram) \
   schedule(dynamic, 10) \
-  num_threads(parameters_.max_no_of_threads)
+  num_threads(threads)
     for (int index=0; index<array_size; ++index)
     {
       float& interest_value = interest_image[index];
@@ -423,6 +441,8 @@ NarfKeypoint::calculateCompleteInterestImage ()
 void 
 NarfKeypoint::calculateSparseInterestImage ()
 {
+  const pcl::ThreadReservation reservation (static_cast<unsigned int> (std::max (parameters_.max_no_of_threads, 0)));
+  const unsigned int threads = reservation.getNumberOfThreads ();
   if (parameters_.support_size <= 0.0f)
   {
     std::cerr << __PRETTY_FUNCTION__<<": parameters_.support_size is not set!\n";
@@ -455,6 +475,10 @@ NarfKeypoint::calculateSparseInterestImage ()
   
   interest_image_ = new float[array_size];
   
+#pragma omp parallel for \
+  default(none) \
+  shared(array_size, border_descriptions, range_image) \
+  num_threads(threads)
   for (int index=0; index<array_size; ++index)
   {
     interest_image_[index] = 0.0f;
@@ -482,7 +506,7 @@ NarfKeypoint::calculateSparseInterestImage ()
   default(none) \
   shared(array_size, border_descriptions, increased_radius_squared, radius_reciprocal, radius_overhead_squared, range_image, search_radius, \
          surface_change_directions, surface_change_scores) \
-  num_threads(parameters_.max_no_of_threads) \
+  num_threads(threads) \
   schedule(guided, 10) \
   firstprivate(was_touched, neighbors_to_check, angle_histogram, neighbors_within_radius_overhead, angle_elements, relevant_point_still_valid) 
   for (int index=0; index<array_size; ++index)
@@ -69,6 +69,15 @@ public:
   void
   setUnaryEnergy(const std::vector<float> unary);
 
+  /** Sets the number of threads used to build the lattices of the pairwise energies
+   *  and to run the inference.
+   *
+   * \param[in] nr_threads the number of hardware threads to use (0 takes as many as the
+   *            budget of pcl::ExecutionContext allows when running the inference)
+   */
+  void
+  setNumberOfThreads(unsigned int nr_threads = 0);
+
   void
   addPairwiseEnergy(const std::vector<float>& feature,
                     const int feature_dimension,
@@ -157,6 +166,9 @@ protected:
   /** Input types */
   bool xyz_, rgb_, normal_;
 
+  /** The number of threads the scheduler should use */
+  unsigned int threads_;
+
 public:
   PCL_MAKE_ALIGNED_OPERATOR_NEW
 };
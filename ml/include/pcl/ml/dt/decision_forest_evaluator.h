@@ -80,6 +80,39 @@ public:
       std::vector<ExampleIndex>& examples,
       std::vector<LabelType>& label_data);
 
+  /** Sets the number of threads used to evaluate flat trees.
+   *
+   * \param[in] nr_threads the number of hardware threads to use (0 sets the value back
+   *            to automatic)
+   */
+  void
+  setNumberOfThreads(unsigned int nr_threads = 0)
+  {
+    tree_evaluator_.setNumberOfThreads(nr_threads);
+  }
+
+  /** Evaluates the specified examples using the supplied forest of flat trees, which
+   *  is faster than evaluating the DecisionForest, see DecisionTreeEvaluator. The flat
+   *  forest is created with
+   *  std::vector<FlatDecisionTree<NodeType>> flat_forest (forest.begin (), forest.end ()).
+   *
+   * \param[in] forest the flattened trees of the decision forest
+   * \param[in] feature_handler the feature handler used to train the tree
+   * \param[in] stats_estimator the statistics estimation instance used while training
+   *            the tree
+   * \param[in] data_set the data set used for evaluation
+   * \param[in] examples the examples that have to be evaluated
+   * \param[out] label_data the destination for the resulting label data
+   */
+  void
+  evaluate(
+      std::vector<pcl::FlatDecisionTree<NodeType>>& forest,
+      pcl::FeatureHandler<FeatureType, DataSet, ExampleIndex>& feature_handler,
+      pcl::StatsEstimator<LabelType, NodeType, DataSet, ExampleIndex>& stats_estimator,
+      DataSet& data_set,
+      std::vector<ExampleIndex>& examples,
+      std::vector<LabelType>& label_data);
+
   /** Evaluates a specific patch using the supplied forest.
    *
    * \param[in] DecisionForestEvaluator the decision forest
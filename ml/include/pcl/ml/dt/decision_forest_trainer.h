@@ -202,6 +202,29 @@ public:
     decision_tree_trainer_.setRandomFeaturesAtSplitNode(b);
   }
 
+  /** Specify if the generated thresholds are placed at quantiles of the feature
+   *  responses instead of uniformly over their range.
+   *
+   * \param[in] b do it or not
+   */
+  void
+  setQuantileThresholds(bool b)
+  {
+    decision_tree_trainer_.setQuantileThresholds(b);
+  }
+
+  /** Sets the number of threads used to train the trees concurrently, or to evaluate
+   *  the candidate features of a node if the trees have to be trained one by one.
+   *
+   * \param[in] nr_threads the number of hardware threads to use (0 sets the value back
+   *            to automatic)
+   */
+  void
+  setNumberOfThreads(unsigned int nr_threads = 0)
+  {
+    decision_tree_trainer_.setNumberOfThreads(nr_threads);
+  }
+
   /** Trains a decision forest using the set training data and settings.
    *
    * \param[out] forest destination for the trained forest
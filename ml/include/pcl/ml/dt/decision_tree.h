@@ -71,6 +71,13 @@ public:
     return root_;
   }
 
+  /** Returns the root node of the tree. */
+  const NodeType&
+  getRoot() const
+  {
+    return root_;
+  }
+
   /** Serializes the decision tree.
    *
    * \param[out] stream the destination for the serialization
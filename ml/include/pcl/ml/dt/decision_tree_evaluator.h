@@ -39,6 +39,7 @@
 
 #include <pcl/common/common.h>
 #include <pcl/ml/dt/decision_tree.h>
+#include <pcl/ml/dt/flat_decision_tree.h>
 #include <pcl/ml/feature_handler.h>
 #include <pcl/ml/stats_estimator.h>
 
@@ -100,6 +101,58 @@ public:
       std::vector<ExampleIndex>& examples,
       std::vector<LabelType>& label_data);
 
+  /** Sets the number of threads used to evaluate flat trees.
+   *
+   * \param[in] nr_threads the number of hardware threads to use (0 takes as many as the
+   *            budget of pcl::ExecutionContext allows when evaluating)
+   */
+  void
+  setNumberOfThreads(unsigned int nr_threads = 0);
+
+  /** Evaluates the specified examples using the supplied flat tree.
+   *
+   * The examples are evaluated in batches, in parallel. All examples of a batch descend
+   * one level of the tree at a time, so the upper levels stay in the cache. The
+   * feature handler and the statistics estimator have to be safe to be called from
+   * several threads, otherwise set the number of threads to 1.
+   *
+   * \param[in] tree the flattened decision tree
+   * \param[in] feature_handler the feature handler used to train the tree
+   * \param[in] stats_estimator the statistics estimation instance used while training
+   *            the tree
+   * \param[in] data_set the data set used for evaluation
+   * \param[in] examples the examples that have to be evaluated
+   * \param[out] label_data the destination for the resulting label data
+   */
+  void
+  evaluate(
+      pcl::FlatDecisionTree<NodeType>& tree,
+      pcl::FeatureHandler<FeatureType, DataSet, ExampleIndex>& feature_handler,
+      pcl::StatsEstimator<LabelType, NodeType, DataSet, ExampleIndex>& stats_estimator,
+      DataSet& data_set,
+      std::vector<ExampleIndex>& examples,
+      std::vector<LabelType>& label_data);
+
+  /** Evaluates the specified examples using the supplied flat tree and adds the
+   *  results to the supplied results array, see the evaluate overload for flat trees.
+   *
+   * \param[in] tree the flattened decision tree
+   * \param[in] feature_handler the feature handler used to train the tree
+   * \param[in] stats_estimator the statistics estimation instance used while training
+   *            the tree
+   * \param[in] data_set the data set used for evaluation
+   * \param[in] examples the examples that have to be evaluated
+   * \param[out] label_data the destination where the resulting label data is added to
+   */
+  void
+  evaluateAndAdd(
+      pcl::FlatDecisionTree<NodeType>& tree,
+      pcl::FeatureHandler<FeatureType, DataSet, ExampleIndex>& feature_handler,
+      pcl::StatsEstimator<LabelType, NodeType, DataSet, ExampleIndex>& stats_estimator,
+      DataSet& data_set,
+      std::vector<ExampleIndex>& examples,
+      std::vector<LabelType>& label_data);
+
   /** Evaluates the specified examples using the supplied tree.
    *
    * \param[in] tree the decision tree
@@ -137,6 +190,24 @@ public:
       DataSet& data_set,
       std::vector<ExampleIndex>& examples,
       std::vector<NodeType*>& nodes);
+
+private:
+  /** Number of examples that descend a flat tree together. */
+  static constexpr int batch_size_ = 64;
+
+  /** Evaluates the examples on a flat tree, either storing or adding the labels. */
+  void
+  evaluateFlat(
+      pcl::FlatDecisionTree<NodeType>& tree,
+      pcl::FeatureHandler<FeatureType, DataSet, ExampleIndex>& feature_handler,
+      pcl::StatsEstimator<LabelType, NodeType, DataSet, ExampleIndex>& stats_estimator,
+      DataSet& data_set,
+      std::vector<ExampleIndex>& examples,
+      std::vector<LabelType>& label_data,
+      bool add);
+
+  /** The number of threads used to evaluate flat trees. */
+  unsigned int threads_;
 };
 
 } // namespace pcl
@@ -191,6 +191,27 @@ public:
     random_features_at_split_node_ = b;
   }
 
+  /** Specify if the generated thresholds are placed at quantiles of the feature
+   *  responses instead of uniformly over their range. Not used if thresholds are set
+   *  with setThresholds().
+   *
+   * \param[in] b do it or not
+   */
+  void
+  setQuantileThresholds(bool b)
+  {
+    quantile_thresholds_ = b;
+  }
+
+  /** Sets the number of threads used to evaluate the candidate features of a node and
+   *  to train several trees concurrently.
+   *
+   * \param[in] nr_threads the number of hardware threads to use (0 takes as many as the
+   *            budget of pcl::ExecutionContext allows when training)
+   */
+  void
+  setNumberOfThreads(unsigned int nr_threads = 0);
+
   /** Trains a decision tree using the set training data and settings.
    *
    * \param[out] tree destination for the trained tree
@@ -198,6 +219,17 @@ public:
   void
   train(DecisionTree<NodeType>& tree);
 
+  /** Trains several decision trees using the set training data and settings. The
+   *  trees are trained concurrently unless a data provider is set or the features are
+   *  generated at each split node, the feature pools of the trees are created upfront
+   *  in the same order as by consecutive calls to train().
+   *
+   * \param[in,out] trees destination for the trained trees, its size is the number of
+   *                trees to train
+   */
+  void
+  train(std::vector<DecisionTree<NodeType>>& trees);
+
 protected:
   /** Trains a decision tree node from the specified features, label data, and
    *  examples.
@@ -227,6 +259,17 @@ protected:
                           std::vector<float>& values,
                           std::vector<float>& thresholds);
 
+  /** Creates thresholds at evenly spaced quantiles of the finite supplied values.
+   *
+   * \param[in] num_of_thresholds the number of thresholds to create
+   * \param[in] values the values for estimating the quantiles
+   * \param[out] thresholds the resulting thresholds
+   */
+  static void
+  createThresholdsQuantile(const std::size_t num_of_thresholds,
+                           std::vector<float>& values,
+                           std::vector<float>& thresholds);
+
 private:
   /** Maximum depth of the learned tree. */
   std::size_t max_tree_depth_;
@@ -262,6 +305,12 @@ private:
   /** If true, random features are generated at each node, otherwise, at start of
    *  training the tree */
   bool random_features_at_split_node_;
+
+  /** If true, generated thresholds are placed at quantiles of the feature responses. */
+  bool quantile_thresholds_;
+
+  /** The number of threads the scheduler should use. */
+  unsigned int threads_;
 };
 
 } // namespace pcl
@@ -0,0 +1,147 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2019-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <pcl/ml/dt/decision_tree.h>
+
+#include <cstddef>
+#include <vector>
+
+namespace pcl {
+
+/** Read-only copy of a decision tree laid out for evaluation.
+ *
+ *  The inner nodes are stored breadth-first in a single array, so the children of a
+ *  node are consecutive and the top levels of the tree, which are visited by every
+ *  example, share a few cache lines. An inner node only holds what is needed to pick
+ *  a branch. The leaves are kept as copies of the original nodes in a separate array,
+ *  for pcl::StatsEstimator::getLabelOfNode.
+ *
+ *  The flat tree does not follow later changes of the tree it was built from.
+ */
+template <class NodeType>
+class FlatDecisionTree {
+public:
+  using FeatureType = decltype(NodeType::feature);
+  using ThresholdType = decltype(NodeType::threshold);
+
+  /** A node of the flat tree. */
+  struct Node {
+    /** The feature evaluated at the node. */
+    FeatureType feature;
+    /** The threshold applied on the feature response. */
+    ThresholdType threshold;
+    /** Index of the first child in the nodes, or of the leaf if num_of_children is 0. */
+    int first_child;
+    /** Number of children, 0 for leaves. */
+    int num_of_children;
+  };
+
+  /** Constructor. */
+  FlatDecisionTree() = default;
+
+  /** Constructor.
+   *
+   * \param[in] tree the tree to flatten
+   */
+  explicit FlatDecisionTree(const DecisionTree<NodeType>& tree) { setTree(tree); }
+
+  /** Rebuilds the flat tree from the specified tree.
+   *
+   * \param[in] tree the tree to flatten
+   */
+  void
+  setTree(const DecisionTree<NodeType>& tree)
+  {
+    nodes_.clear();
+    leaves_.clear();
+
+    // Breadth-first, the queue holds the original node of every flat node
+    std::vector<const NodeType*> queue(1, &tree.getRoot());
+    for (std::size_t node_index = 0; node_index < queue.size(); ++node_index) {
+      const NodeType& node = *queue[node_index];
+
+      Node flat_node;
+      flat_node.feature = node.feature;
+      flat_node.threshold = node.threshold;
+      flat_node.num_of_children = static_cast<int>(node.sub_nodes.size());
+      if (flat_node.num_of_children == 0) {
+        flat_node.first_child = static_cast<int>(leaves_.size());
+        leaves_.push_back(node);
+      }
+      else {
+        flat_node.first_child = static_cast<int>(queue.size());
+        for (const NodeType& sub_node : node.sub_nodes)
+          queue.push_back(&sub_node);
+      }
+      nodes_.push_back(flat_node);
+    }
+  }
+
+  /** Returns the nodes in breadth-first order, the root first. */
+  inline const std::vector<Node>&
+  getNodes() const
+  {
+    return nodes_;
+  }
+
+  /** Returns the original node of a leaf.
+   *
+   * \param[in] node a leaf of the flat tree
+   */
+  inline NodeType&
+  getLeaf(const Node& node)
+  {
+    return leaves_[node.first_child];
+  }
+
+  /** Returns whether the flat tree is empty. */
+  inline bool
+  empty() const
+  {
+    return nodes_.empty();
+  }
+
+private:
+  /** The nodes in breadth-first order. */
+  std::vector<Node> nodes_;
+
+  /** Copies of the leaves of the original tree. */
+  std::vector<NodeType> leaves_;
+};
+
+} // namespace pcl
@@ -104,4 +104,27 @@ public:
                             ::std::ostream& stream) const = 0;
 };
 
+/** Interface for generating C code that evaluates features. */
+template <class FeatureType, class DataSet, class ExampleIndex>
+class PCL_EXPORTS FeatureHandlerCodeGenerator {
+public:
+  /** Destructor. */
+  virtual ~FeatureHandlerCodeGenerator(){};
+
+  /** Generates the code of the function that evaluates a feature.
+   *
+   * \param[out] stream the destination for the code
+   */
+  virtual void
+  generateEvalFunctionCode(::std::ostream& stream) const = 0;
+
+  /** Generates the code that calls the evaluation function for a feature.
+   *
+   * \param[in] feature the feature for which code is generated
+   * \param[out] stream the destination for the code
+   */
+  virtual void
+  generateEvalCode(const FeatureType& feature, ::std::ostream& stream) const = 0;
+};
+
 } // namespace pcl
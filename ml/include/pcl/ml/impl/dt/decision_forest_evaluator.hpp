@@ -97,6 +97,39 @@ pcl::DecisionForestEvaluator<FeatureType, DataSet, LabelType, ExampleIndex, Node
   }
 }
 
+template <class FeatureType,
+          class DataSet,
+          class LabelType,
+          class ExampleIndex,
+          class NodeType>
+void
+pcl::DecisionForestEvaluator<FeatureType, DataSet, LabelType, ExampleIndex, NodeType>::
+    evaluate(std::vector<pcl::FlatDecisionTree<NodeType>>& forest,
+             pcl::FeatureHandler<FeatureType, DataSet, ExampleIndex>& feature_handler,
+             pcl::StatsEstimator<LabelType, NodeType, DataSet, ExampleIndex>&
+                 stats_estimator,
+             DataSet& data_set,
+             std::vector<ExampleIndex>& examples,
+             std::vector<LabelType>& label_data)
+{
+  const std::size_t num_of_examples = examples.size();
+  label_data.assign(num_of_examples, 0);
+
+  for (std::size_t forest_index = 0; forest_index < forest.size(); ++forest_index) {
+    tree_evaluator_.evaluateAndAdd(forest[forest_index],
+                                   feature_handler,
+                                   stats_estimator,
+                                   data_set,
+                                   examples,
+                                   label_data);
+  }
+
+  const float inv_num_of_trees = 1.0f / static_cast<float>(forest.size());
+  for (std::size_t label_index = 0; label_index < label_data.size(); ++label_index) {
+    label_data[label_index] *= inv_num_of_trees;
+  }
+}
+
 template <class FeatureType,
           class DataSet,
           class LabelType,
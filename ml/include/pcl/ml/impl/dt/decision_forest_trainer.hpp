@@ -37,6 +37,8 @@
 
 #pragma once
 
+#include <vector>
+
 namespace pcl {
 
 template <class FeatureType,
@@ -67,12 +69,10 @@ void
 DecisionForestTrainer<FeatureType, DataSet, LabelType, ExampleIndex, NodeType>::train(
     pcl::DecisionForest<NodeType>& forest)
 {
-  for (std::size_t tree_index = 0; tree_index < num_of_trees_to_train_; ++tree_index) {
-    pcl::DecisionTree<NodeType> tree;
-    decision_tree_trainer_.train(tree);
+  std::vector<pcl::DecisionTree<NodeType>> trees(num_of_trees_to_train_);
+  decision_tree_trainer_.train(trees);
 
-    forest.push_back(tree);
-  }
+  forest.insert(forest.end(), trees.begin(), trees.end());
 }
 
 } // namespace pcl
@@ -38,10 +38,13 @@
 #pragma once
 
 #include <pcl/common/common.h>
+#include <pcl/common/execution_context.h>
 #include <pcl/ml/dt/decision_tree.h>
 #include <pcl/ml/feature_handler.h>
 #include <pcl/ml/stats_estimator.h>
 
+#include <algorithm>
+#include <cstddef>
 #include <vector>
 
 namespace pcl {
@@ -53,7 +56,9 @@ template <class FeatureType,
           class NodeType>
 DecisionTreeEvaluator<FeatureType, DataSet, LabelType, ExampleIndex, NodeType>::
     DecisionTreeEvaluator()
-{}
+{
+  setNumberOfThreads();
+}
 
 template <class FeatureType,
           class DataSet,
@@ -64,6 +69,15 @@ DecisionTreeEvaluator<FeatureType, DataSet, LabelType, ExampleIndex, NodeType>::
     ~DecisionTreeEvaluator()
 {}
 
+template <class FeatureType,
+          class DataSet,
+          class LabelType,
+          class ExampleIndex,
+          class NodeType>
+constexpr int
+    DecisionTreeEvaluator<FeatureType, DataSet, LabelType, ExampleIndex, NodeType>::
+        batch_size_;
+
 template <class FeatureType,
           class DataSet,
           class LabelType,
@@ -171,6 +185,148 @@ DecisionTreeEvaluator<FeatureType, DataSet, LabelType, ExampleIndex, NodeType>::
   leave = *node;
 }
 
+template <class FeatureType,
+          class DataSet,
+          class LabelType,
+          class ExampleIndex,
+          class NodeType>
+void
+DecisionTreeEvaluator<FeatureType, DataSet, LabelType, ExampleIndex, NodeType>::
+    setNumberOfThreads(unsigned int nr_threads)
+{
+  // 0 is resolved against the budget of pcl::ExecutionContext at compute time
+  threads_ = nr_threads;
+}
+
+template <class FeatureType,
+          class DataSet,
+          class LabelType,
+          class ExampleIndex,
+          class NodeType>
+void
+DecisionTreeEvaluator<FeatureType, DataSet, LabelType, ExampleIndex, NodeType>::
+    evaluate(pcl::FlatDecisionTree<NodeType>& tree,
+             pcl::FeatureHandler<FeatureType, DataSet, ExampleIndex>& feature_handler,
+             pcl::StatsEstimator<LabelType, NodeType, DataSet, ExampleIndex>&
+                 stats_estimator,
+             DataSet& data_set,
+             std::vector<ExampleIndex>& examples,
+             std::vector<LabelType>& label_data)
+{
+  label_data.resize(examples.size());
+  evaluateFlat(
+      tree, feature_handler, stats_estimator, data_set, examples, label_data, false);
+}
+
+template <class FeatureType,
+          class DataSet,
+          class LabelType,
+          class ExampleIndex,
+          class NodeType>
+void
+DecisionTreeEvaluator<FeatureType, DataSet, LabelType, ExampleIndex, NodeType>::
+    evaluateAndAdd(
+        pcl::FlatDecisionTree<NodeType>& tree,
+        pcl::FeatureHandler<FeatureType, DataSet, ExampleIndex>& feature_handler,
+        pcl::StatsEstimator<LabelType, NodeType, DataSet, ExampleIndex>&
+            stats_estimator,
+        DataSet& data_set,
+        std::vector<ExampleIndex>& examples,
+        std::vector<LabelType>& label_data)
+{
+  evaluateFlat(
+      tree, feature_handler, stats_estimator, data_set, examples, label_data, true);
+}
+
+template <class FeatureType,
+          class DataSet,
+          class LabelType,
+          class ExampleIndex,
+          class NodeType>
+void
+DecisionTreeEvaluator<FeatureType, DataSet, LabelType, ExampleIndex, NodeType>::
+    evaluateFlat(
+        pcl::FlatDecisionTree<NodeType>& tree,
+        pcl::FeatureHandler<FeatureType, DataSet, ExampleIndex>& feature_handler,
+        pcl::StatsEstimator<LabelType, NodeType, DataSet, ExampleIndex>&
+            stats_estimator,
+        DataSet& data_set,
+        std::vector<ExampleIndex>& examples,
+        std::vector<LabelType>& label_data,
+        bool add)
+{
+  if (tree.empty())
+    return;
+
+  std::ptrdiff_t num_of_examples = static_cast<std::ptrdiff_t>(examples.size());
+  std::ptrdiff_t num_of_batches = (num_of_examples + batch_size_ - 1) / batch_size_;
+
+  const pcl::ThreadReservation reservation(threads_);
+  const unsigned int threads = reservation.getNumberOfThreads();
+#pragma omp parallel for default(none)                                                 \
+    shared(tree,                                                                       \
+           feature_handler,                                                            \
+           stats_estimator,                                                            \
+           data_set,                                                                   \
+           examples,                                                                   \
+           label_data,                                                                 \
+           add,                                                                        \
+           num_of_examples,                                                            \
+           num_of_batches) schedule(static) num_threads(threads)
+  for (std::ptrdiff_t batch_index = 0; batch_index < num_of_batches; ++batch_index) {
+    const std::vector<typename FlatDecisionTree<NodeType>::Node>& nodes =
+        tree.getNodes();
+
+    const std::ptrdiff_t batch_begin = batch_index * batch_size_;
+    const int batch_count = static_cast<int>(
+        std::min<std::ptrdiff_t>(batch_size_, num_of_examples - batch_begin));
+
+    // Current node of every example, and the examples that have not reached a leaf
+    int node_indices[batch_size_];
+    int active[batch_size_];
+    for (int example_index = 0; example_index < batch_count; ++example_index) {
+      node_indices[example_index] = 0;
+      active[example_index] = example_index;
+    }
+
+    int num_of_active = batch_count;
+    while (num_of_active > 0) {
+      int num_of_still_active = 0;
+      for (int active_index = 0; active_index < num_of_active; ++active_index) {
+        const int example_index = active[active_index];
+        const auto& node = nodes[node_indices[example_index]];
+        if (node.num_of_children == 0)
+          continue;
+
+        float feature_result = 0.0f;
+        unsigned char flag = 0;
+        unsigned char branch_index = 0;
+
+        feature_handler.evaluateFeature(node.feature,
+                                        data_set,
+                                        examples[batch_begin + example_index],
+                                        feature_result,
+                                        flag);
+        stats_estimator.computeBranchIndex(
+            feature_result, flag, node.threshold, branch_index);
+
+        node_indices[example_index] = node.first_child + branch_index;
+        active[num_of_still_active++] = example_index;
+      }
+      num_of_active = num_of_still_active;
+    }
+
+    for (int example_index = 0; example_index < batch_count; ++example_index) {
+      const LabelType label = stats_estimator.getLabelOfNode(
+          tree.getLeaf(nodes[node_indices[example_index]]));
+      if (add)
+        label_data[batch_begin + example_index] += label;
+      else
+        label_data[batch_begin + example_index] = label;
+    }
+  }
+}
+
 template <class FeatureType,
           class DataSet,
           class LabelType,
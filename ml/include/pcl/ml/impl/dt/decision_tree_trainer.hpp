@@ -37,6 +37,13 @@
 
 #pragma once
 
+#include <pcl/common/execution_context.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
 namespace pcl {
 
 template <class FeatureType,
@@ -56,7 +63,10 @@ DecisionTreeTrainer<FeatureType, DataSet, LabelType, ExampleIndex, NodeType>::
 , examples_()
 , decision_tree_trainer_data_provider_()
 , random_features_at_split_node_(false)
-{}
+, quantile_thresholds_(false)
+{
+  setNumberOfThreads();
+}
 
 template <class FeatureType,
           class DataSet,
@@ -67,6 +77,19 @@ DecisionTreeTrainer<FeatureType, DataSet, LabelType, ExampleIndex, NodeType>::
     ~DecisionTreeTrainer()
 {}
 
+template <class FeatureType,
+          class DataSet,
+          class LabelType,
+          class ExampleIndex,
+          class NodeType>
+void
+DecisionTreeTrainer<FeatureType, DataSet, LabelType, ExampleIndex, NodeType>::
+    setNumberOfThreads(unsigned int nr_threads)
+{
+  // 0 is resolved against the budget of pcl::ExecutionContext at compute time
+  threads_ = nr_threads;
+}
+
 template <class FeatureType,
           class DataSet,
           class LabelType,
@@ -103,6 +126,48 @@ DecisionTreeTrainer<FeatureType, DataSet, LabelType, ExampleIndex, NodeType>::tr
   }
 }
 
+template <class FeatureType,
+          class DataSet,
+          class LabelType,
+          class ExampleIndex,
+          class NodeType>
+void
+DecisionTreeTrainer<FeatureType, DataSet, LabelType, ExampleIndex, NodeType>::train(
+    std::vector<pcl::DecisionTree<NodeType>>& trees)
+{
+  std::ptrdiff_t num_of_trees = static_cast<std::ptrdiff_t>(trees.size());
+
+  // the data provider replaces the training data for every tree and features created
+  // at split nodes draw from the shared random generator
+  if (decision_tree_trainer_data_provider_ || random_features_at_split_node_ ||
+      threads_ == 1 || num_of_trees < 2) {
+    for (auto& tree : trees)
+      train(tree);
+    return;
+  }
+
+  std::vector<std::vector<FeatureType>> features(num_of_trees);
+  for (auto& tree_features : features)
+    feature_handler_->createRandomFeatures(num_of_features_, tree_features);
+
+  const pcl::ThreadReservation reservation(threads_);
+  const unsigned int threads = reservation.getNumberOfThreads();
+  // nested parallel regions are inactive by default, so the features of the nodes are
+  // evaluated sequentially within each tree
+#pragma omp parallel for default(none) shared(trees, features, num_of_trees)         \
+    schedule(dynamic) num_threads(threads)
+  for (std::ptrdiff_t tree_index = 0; tree_index < num_of_trees; ++tree_index) {
+    NodeType root_node;
+    trees[tree_index].setRoot(root_node);
+
+    trainDecisionTreeNode(features[tree_index],
+                          examples_,
+                          label_data_,
+                          max_tree_depth_,
+                          trees[tree_index].getRoot());
+  }
+}
+
 template <class FeatureType,
           class DataSet,
           class LabelType,
@@ -138,67 +203,76 @@ DecisionTreeTrainer<FeatureType, DataSet, LabelType, ExampleIndex, NodeType>::
     feature_handler_->createRandomFeatures(num_of_features_, features);
   }
 
-  std::vector<float> feature_results;
-  std::vector<unsigned char> flags;
-
-  feature_results.reserve(num_of_examples);
-  flags.reserve(num_of_examples);
-
-  // find best feature for split
-  int best_feature_index = -1;
-  float best_feature_threshold = 0.0f;
-  float best_feature_information_gain = 0.0f;
-
-  const std::size_t num_of_features = features.size();
-  for (std::size_t feature_index = 0; feature_index < num_of_features;
-       ++feature_index) {
-    // evaluate features
-    feature_handler_->evaluateFeature(
-        features[feature_index], data_set_, examples, feature_results, flags);
+  // find best feature for split, the best threshold of every feature is searched in
+  // parallel and the features are compared in their order afterwards
+  std::ptrdiff_t num_of_features = static_cast<std::ptrdiff_t>(features.size());
+  std::vector<float> feature_thresholds(num_of_features, 0.0f);
+  std::vector<float> feature_information_gains(num_of_features, 0.0f);
+
+  const pcl::ThreadReservation reservation(threads_);
+  const unsigned int threads = reservation.getNumberOfThreads();
+#pragma omp parallel default(none)                                                     \
+    shared(features,                                                                   \
+           examples,                                                                   \
+           label_data,                                                                 \
+           feature_thresholds,                                                         \
+           feature_information_gains,                                                  \
+           num_of_features) num_threads(threads)
+  {
+    std::vector<float> feature_results;
+    std::vector<unsigned char> flags;
+    std::vector<float> thresholds;
+    std::vector<float> information_gains;
+
+    feature_results.reserve(examples.size());
+    flags.resize(examples.size());
+
+#pragma omp for schedule(dynamic)
+    for (std::ptrdiff_t feature_index = 0; feature_index < num_of_features;
+         ++feature_index) {
+      // evaluate features
+      feature_handler_->evaluateFeature(
+          features[feature_index], data_set_, examples, feature_results, flags);
+
+      // get list of thresholds
+      if (!thresholds_.empty())
+        thresholds = thresholds_;
+      else if (quantile_thresholds_)
+        createThresholdsQuantile(num_of_thresholds_, feature_results, thresholds);
+      else
+        createThresholdsUniform(num_of_thresholds_, feature_results, thresholds);
 
-    // get list of thresholds
-    if (!thresholds_.empty()) {
       // compute information gain for each threshold and store threshold with highest
       // information gain
-      for (std::size_t threshold_index = 0; threshold_index < thresholds_.size();
+      stats_estimator_->computeInformationGains(data_set_,
+                                                examples,
+                                                label_data,
+                                                feature_results,
+                                                flags,
+                                                thresholds,
+                                                information_gains);
+
+      for (std::size_t threshold_index = 0; threshold_index < thresholds.size();
            ++threshold_index) {
-
-        const float information_gain =
-            stats_estimator_->computeInformationGain(data_set_,
-                                                     examples,
-                                                     label_data,
-                                                     feature_results,
-                                                     flags,
-                                                     thresholds_[threshold_index]);
-
-        if (information_gain > best_feature_information_gain) {
-          best_feature_information_gain = information_gain;
-          best_feature_index = static_cast<int>(feature_index);
-          best_feature_threshold = thresholds_[threshold_index];
+        if (information_gains[threshold_index] >
+            feature_information_gains[feature_index]) {
+          feature_information_gains[feature_index] = information_gains[threshold_index];
+          feature_thresholds[feature_index] = thresholds[threshold_index];
         }
       }
     }
-    else {
-      std::vector<float> thresholds;
-      thresholds.reserve(num_of_thresholds_);
-      createThresholdsUniform(num_of_thresholds_, feature_results, thresholds);
-
-      // compute information gain for each threshold and store threshold with highest
-      // information gain
-      for (std::size_t threshold_index = 0; threshold_index < num_of_thresholds_;
-           ++threshold_index) {
-        const float threshold = thresholds[threshold_index];
+  }
 
-        // compute information gain
-        const float information_gain = stats_estimator_->computeInformationGain(
-            data_set_, examples, label_data, feature_results, flags, threshold);
+  int best_feature_index = -1;
+  float best_feature_threshold = 0.0f;
+  float best_feature_information_gain = 0.0f;
 
-        if (information_gain > best_feature_information_gain) {
-          best_feature_information_gain = information_gain;
-          best_feature_index = static_cast<int>(feature_index);
-          best_feature_threshold = threshold;
-        }
-      }
+  for (std::ptrdiff_t feature_index = 0; feature_index < num_of_features;
+       ++feature_index) {
+    if (feature_information_gains[feature_index] > best_feature_information_gain) {
+      best_feature_information_gain = feature_information_gains[feature_index];
+      best_feature_index = static_cast<int>(feature_index);
+      best_feature_threshold = feature_thresholds[feature_index];
     }
   }
 
@@ -208,6 +282,8 @@ DecisionTreeTrainer<FeatureType, DataSet, LabelType, ExampleIndex, NodeType>::
   }
 
   // get branch indices for best feature and best threshold
+  std::vector<float> feature_results;
+  std::vector<unsigned char> flags(num_of_examples);
   std::vector<unsigned char> branch_indices;
   branch_indices.reserve(num_of_examples);
   {
@@ -306,4 +382,40 @@ DecisionTreeTrainer<FeatureType, DataSet, LabelType, ExampleIndex, NodeType>::
   }
 }
 
+template <class FeatureType,
+          class DataSet,
+          class LabelType,
+          class ExampleIndex,
+          class NodeType>
+void
+DecisionTreeTrainer<FeatureType, DataSet, LabelType, ExampleIndex, NodeType>::
+    createThresholdsQuantile(const std::size_t num_of_thresholds,
+                             std::vector<float>& values,
+                             std::vector<float>& thresholds)
+{
+  std::vector<float> sorted_values;
+  sorted_values.reserve(values.size());
+  for (const float value : values) {
+    if (std::isfinite(value))
+      sorted_values.push_back(value);
+  }
+
+  if (sorted_values.empty()) {
+    createThresholdsUniform(num_of_thresholds, values, thresholds);
+    return;
+  }
+
+  std::sort(sorted_values.begin(), sorted_values.end());
+
+  // compute thresholds
+  thresholds.resize(num_of_thresholds);
+
+  const std::size_t num_of_values = sorted_values.size();
+  for (std::size_t threshold_index = 0; threshold_index < num_of_thresholds;
+       ++threshold_index) {
+    thresholds[threshold_index] =
+        sorted_values[(threshold_index + 1) * num_of_values / (num_of_thresholds + 1)];
+  }
+}
+
 } // namespace pcl
@@ -48,6 +48,13 @@
 namespace pcl {
 
 /** K-means clustering.
+ *
+ * The points are stored row-major in one contiguous array. The centroids are seeded
+ * with k-means++ (or by partitioning the points among the clusters in turn) and
+ * refined with Lloyd iterations until no point changes its cluster. The assignment
+ * step runs in parallel and keeps Hamerly's bounds on the distance of every point to
+ * its centroid and to the second closest one, so that most points are not compared
+ * against all centroids once the clusters settle.
  *
  * \author Christian Potthast
  * \ingroup ML
@@ -100,6 +107,35 @@ public:
   // void
   // cluster (std::vector<PointIndices> &clusters);
 
+  /** Choose how the centroids are initialized.
+   *
+   * \param[in] use_kmeans_plus_plus if true (default), the centroids are seeded with
+   *            k-means++, i.e. each is a point drawn with a probability proportional to
+   *            its squared distance to the closest centroid chosen so far; otherwise the
+   *            points are partitioned among the clusters in turn, see
+   *            initialClusterPoints()
+   */
+  void
+  setUseKMeansPlusPlus(bool use_kmeans_plus_plus)
+  {
+    use_kmeans_plus_plus_ = use_kmeans_plus_plus;
+  }
+
+  /** Set the seed of the random number generator of the k-means++ seeding. */
+  void
+  setSeed(unsigned int seed)
+  {
+    seed_ = seed;
+  }
+
+  /** Initialize the scheduler and set the number of threads to use.
+   *
+   * \param[in] nr_threads the number of hardware threads to use (0 takes as many as the
+   *            budget of pcl::ExecutionContext allows when clustering)
+   */
+  void
+  setNumberOfThreads(unsigned int nr_threads = 0);
+
   void
   kMeans();
 
@@ -109,16 +145,32 @@ public:
     if (num_points_ != data.size())
       std::cout << "Data vector not the same" << std::endl;
 
+    data_.clear();
+    data_.reserve(data.size() * num_dimensions_);
+    for (const Point& data_point : data)
+      addDataPoint(data_point);
+  }
+
+  /** Set the input data from one contiguous row-major array of num_points rows with
+   *  num_dimensions values each, which avoids one allocation per point.
+   */
+  void
+  setInputData(const std::vector<float>& data)
+  {
+    if (static_cast<std::size_t>(num_points_) * num_dimensions_ != data.size())
+      std::cout << "Data vector not the same" << std::endl;
+
     data_ = data;
   }
 
   void
-  addDataPoint(Point& data_point)
+  addDataPoint(const Point& data_point)
   {
     if (num_dimensions_ != data_point.size())
       std::cout << "Dimensions not the same" << std::endl;
 
-    data_.push_back(data_point);
+    data_.insert(data_.end(), data_point.cbegin(), data_point.cend());
+    data_.resize(data_.size() + num_dimensions_ - data_point.size(), 0.0f);
   }
 
   // Initial partition points among available clusters
@@ -171,13 +223,40 @@ protected:
 
   // one data point
 
-  // all data points
-  std::vector<Point> data_;
+  // all data points, row-major with num_dimensions_ values per point
+  std::vector<float> data_;
 
   ClustersToPoints clusters_to_points_;
   PointsToClusters points_to_clusters_;
   Centroids centroids_;
 
+  /** Whether the centroids are seeded with k-means++. */
+  bool use_kmeans_plus_plus_;
+
+  /** The seed of the k-means++ seeding. */
+  unsigned int seed_;
+
+  /** The number of threads the scheduler should use. */
+  unsigned int threads_;
+
+private:
+  /** Computes the row-major centroids of the clusters given by points_to_clusters_. */
+  void
+  computeCentroids(std::vector<float>& centroids) const;
+
+  /** Seeds the row-major centroids with k-means++. */
+  void
+  seedCentroids(std::vector<float>& centroids) const;
+
+  /** Assigns the points to their closest centroids, skipping those whose bounds prove
+   *  that they stay in their cluster, and returns the number of points that moved.
+   */
+  std::size_t
+  assignPoints(const std::vector<float>& centroids,
+               bool bounds_valid,
+               std::vector<float>& upper_bounds,
+               std::vector<float>& lower_bounds);
+
 public:
   PCL_MAKE_ALIGNED_OPERATOR_NEW
 };
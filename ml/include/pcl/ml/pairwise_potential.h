@@ -47,11 +47,16 @@ namespace pcl {
 
 class PairwisePotential {
 public:
-  /** Constructor for PairwisePotential class. */
+  /** Constructor for PairwisePotential class.
+   *
+   * \param[in] nr_threads the number of threads used to build and apply the lattice
+   *            (0 for automatic)
+   */
   PairwisePotential(const std::vector<float>& feature,
                     const int D,
                     const int N,
-                    const float w);
+                    const float w,
+                    unsigned int nr_threads = 0);
 
   /** Deconstructor for PairwisePotential class. */
   ~PairwisePotential(){};
@@ -62,6 +67,14 @@ public:
           std::vector<float>& tmp,
           int value_size) const;
 
+  /** Sets the number of threads used to apply the potential.
+   *
+   * \param[in] nr_threads the number of hardware threads to use (0 takes as many as the
+   *            budget of pcl::ExecutionContext allows when applying)
+   */
+  void
+  setNumberOfThreads(unsigned int nr_threads = 0);
+
 protected:
   /// Permutohedral lattice
   Permutohedral lattice_;
@@ -75,6 +88,9 @@ protected:
   /// Norm
   std::vector<float> norm_;
 
+  /// The number of threads the scheduler should use
+  unsigned int threads_;
+
 public:
   std::vector<float> bary_;
   std::vector<float> features_;
@@ -77,10 +77,25 @@ public:
   /** Deconstructor for Permutohedral class. */
   ~Permutohedral(){};
 
-  /** Initialization. */
+  /** Sets the number of threads used to build the lattice and to filter with it.
+   *
+   * \param[in] nr_threads the number of hardware threads to use (0 takes as many as the
+   *            budget of pcl::ExecutionContext allows when filtering)
+   */
+  void
+  setNumberOfThreads(unsigned int nr_threads = 0);
+
+  /** Initialization. Builds the lattice once, compute() can then be called for any
+   *  number of value vectors, e.g. in every mean-field iteration.
+   */
   void
   init(const std::vector<float>& feature, const int feature_dimension, const int N);
 
+  /** Filters the values with the lattice: splatting onto the lattice vertices,
+   *  blurring along each lattice direction and slicing back to the points. All three
+   *  steps are parallel over the vertices or points and give the same results for any
+   *  number of threads.
+   */
   void
   compute(std::vector<float>& out,
           const std::vector<float>& in,
@@ -139,6 +154,17 @@ public:
   float* barycentricOLD_;
   std::vector<float> baryOLD_;
 
+protected:
+  /// Start of the splat entries of each vertex in splat_entries_, size M_ + 1
+  std::vector<int> splat_offsets_;
+
+  /// Index into offset_ and barycentric_ of the points that splat onto each vertex,
+  /// in increasing point order
+  std::vector<int> splat_entries_;
+
+  /// The number of threads the scheduler should use
+  unsigned int threads_;
+
 public:
   PCL_MAKE_ALIGNED_OPERATOR_NEW
 };
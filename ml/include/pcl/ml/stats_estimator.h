@@ -95,6 +95,36 @@ public:
                          std::vector<unsigned char>& flags,
                          const float threshold) const = 0;
 
+  /** Computes the information gains obtained by several thresholds on the same
+   *  feature evaluation results. The default implementation calls
+   *  computeInformationGain() once per threshold; estimators can override it to share
+   *  the pass over the examples between the thresholds.
+   *
+   * \param[in] data_set the data set used for extracting the supplied result values.
+   * \param[in] examples the examples used to extract the supplied result values
+   * \param[in] label_data the labels corresponding to the examples
+   * \param[in] results the results obtained from the feature evaluation
+   * \param[in] flags the flags obtained together with the results
+   * \param[in] thresholds the thresholds for which the information gains are computed
+   * \param[out] information_gains the information gain of each threshold
+   */
+  virtual void
+  computeInformationGains(DataSet& data_set,
+                          std::vector<ExampleIndex>& examples,
+                          std::vector<LabelDataType>& label_data,
+                          std::vector<float>& results,
+                          std::vector<unsigned char>& flags,
+                          const std::vector<float>& thresholds,
+                          std::vector<float>& information_gains) const
+  {
+    information_gains.resize(thresholds.size());
+    for (std::size_t threshold_index = 0; threshold_index < thresholds.size();
+         ++threshold_index) {
+      information_gains[threshold_index] = computeInformationGain(
+          data_set, examples, label_data, results, flags, thresholds[threshold_index]);
+    }
+  }
+
   /** Computes the branch indices obtained by the specified threshold on the supplied
    *  feature evaluation results.
    *
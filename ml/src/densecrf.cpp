@@ -37,6 +37,7 @@
  *
  */
 
+#include <pcl/common/execution_context.h>
 #include <pcl/ml/densecrf.h>
 
 pcl::DenseCrf::DenseCrf(int N, int m)
@@ -45,6 +46,7 @@ pcl::DenseCrf::DenseCrf(int N, int m)
   current_.resize(N_ * M_, 0.0f);
   next_.resize(N_ * M_, 0.0f);
   tmp_.resize(2 * N_ * M_, 0.0f);
+  setNumberOfThreads();
 }
 
 pcl::DenseCrf::~DenseCrf()
@@ -75,13 +77,23 @@ pcl::DenseCrf::setUnaryEnergy(const std::vector<float> unary)
   unary_ = unary;
 }
 
+void
+pcl::DenseCrf::setNumberOfThreads(unsigned int nr_threads)
+{
+  // 0 is resolved against the budget of pcl::ExecutionContext at compute time
+  threads_ = nr_threads;
+
+  for (auto& p : pairwise_potential_)
+    p->setNumberOfThreads(threads_);
+}
+
 void
 pcl::DenseCrf::addPairwiseEnergy(const std::vector<float>& feature,
                                  const int feature_dimension,
                                  const float w)
 {
   pairwise_potential_.push_back(
-      new PairwisePotential(feature, feature_dimension, N_, w));
+      new PairwisePotential(feature, feature_dimension, N_, w, threads_));
 }
 
 void
@@ -175,6 +187,9 @@ pcl::DenseCrf::addPairwiseNormals(
 void
 pcl::DenseCrf::inference(int n_iterations, std::vector<float>& result, float relax)
 {
+  // The pairwise potentials and expAndNormalize share this reservation
+  const pcl::ThreadReservation reservation(threads_);
+
   // Start inference
   // Initialize using the unary energies
   expAndNormalize(current_, unary_, -1);
@@ -191,6 +206,9 @@ pcl::DenseCrf::inference(int n_iterations, std::vector<float>& result, float rel
 void
 pcl::DenseCrf::mapInference(int n_iterations, std::vector<int>& result, float relax)
 {
+  // The pairwise potentials and expAndNormalize share this reservation
+  const pcl::ThreadReservation reservation(threads_);
+
   // Start inference
   // Initialize using the unary energies
   expAndNormalize(current_, unary_, -1);
@@ -237,29 +255,36 @@ pcl::DenseCrf::expAndNormalize(std::vector<float>& out,
                                float scale,
                                float relax) const
 {
-  std::vector<float> V(N_ + 10);
-  for (int i = 0; i < N_; i++) {
-    int b_idx = i * M_;
-    // Find the max and subtract it so that the std::exp doesn't explode
-    float mx = scale * in[b_idx];
-    for (int j = 1; j < M_; j++)
-      if (mx < scale * in[b_idx + j])
-        mx = scale * in[b_idx + j];
-    float tt = 0;
-    for (int j = 0; j < M_; j++) {
-      V[j] = std::exp(scale * in[b_idx + j] - mx);
-      tt += V[j];
+  const pcl::ThreadReservation reservation(threads_);
+  const unsigned int threads = reservation.getNumberOfThreads();
+#pragma omp parallel default(none) shared(out, in, scale, relax) num_threads(threads)
+  {
+    std::vector<float> V(M_);
+
+#pragma omp for schedule(static)
+    for (int i = 0; i < N_; i++) {
+      int b_idx = i * M_;
+      // Find the max and subtract it so that the std::exp doesn't explode
+      float mx = scale * in[b_idx];
+      for (int j = 1; j < M_; j++)
+        if (mx < scale * in[b_idx + j])
+          mx = scale * in[b_idx + j];
+      float tt = 0;
+      for (int j = 0; j < M_; j++) {
+        V[j] = std::exp(scale * in[b_idx + j] - mx);
+        tt += V[j];
+      }
+      // Make it a probability
+      for (int j = 0; j < M_; j++)
+        V[j] /= tt;
+
+      int a_idx = i * M_;
+      for (int j = 0; j < M_; j++)
+        if (relax == 1)
+          out[a_idx + j] = V[j];
+        else
+          out[a_idx + j] = (1 - relax) * out[a_idx + j] + relax * V[j];
     }
-    // Make it a probability
-    for (int j = 0; j < M_; j++)
-      V[j] /= tt;
-
-    int a_idx = i * M_;
-    for (int j = 0; j < M_; j++)
-      if (relax == 1)
-        out[a_idx + j] = V[j];
-      else
-        out[a_idx + j] = (1 - relax) * out[a_idx + j] + relax * V[j];
   }
 }
 
@@ -47,23 +47,67 @@
 PCL_INSTANTIATE(Kmeans, PCL_POINT_TYPES);
 */
 
+#include <pcl/common/execution_context.h>
 #include <pcl/ml/kmeans.h>
 
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <random>
+
+namespace {
+/** Squared Euclidean distance of two rows, with four partial sums so that the
+ *  additions do not wait for each other. */
+inline float
+squaredDistance(const float* x, const float* y, unsigned int dimensions)
+{
+  float sums[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+  unsigned int i = 0;
+  for (; i + 4 <= dimensions; i += 4)
+    for (unsigned int j = 0; j < 4; ++j) {
+      const float diff = x[i + j] - y[i + j];
+      sums[j] += diff * diff;
+    }
+  for (; i < dimensions; ++i) {
+    const float diff = x[i] - y[i];
+    sums[0] += diff * diff;
+  }
+  return (sums[0] + sums[1]) + (sums[2] + sums[3]);
+}
+} // namespace
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 pcl::Kmeans::Kmeans(unsigned int num_points, unsigned int num_dimensions)
 : num_points_(num_points)
 , num_dimensions_(num_dimensions)
+, num_clusters_(0)
 , points_to_clusters_(num_points_, 0)
+, use_kmeans_plus_plus_(true)
+, seed_(5489u)
 // data_ (num_points_, Point (num_dimensions_))
-{}
+{
+  setNumberOfThreads();
+}
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 pcl::Kmeans::~Kmeans() {}
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+void
+pcl::Kmeans::setNumberOfThreads(unsigned int nr_threads)
+{
+  // 0 is resolved against the budget of pcl::ExecutionContext at compute time
+  threads_ = nr_threads;
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 void
 pcl::Kmeans::initialClusterPoints()
 {
+  centroids_.clear();
+  clusters_to_points_.clear();
+  points_to_clusters_.assign(num_points_, 0);
+
   for (ClusterId i = 0; i < num_clusters_; i++) {
     Point point; // each centroid is a point
     for (unsigned int dim = 0; dim < num_dimensions_; dim++)
@@ -92,83 +136,253 @@ pcl::Kmeans::initialClusterPoints()
 void
 pcl::Kmeans::computeCentroids()
 {
-  ClusterId cid = 0;
-  // For each centroid
-  for (Centroids::value_type& centroid : centroids_) {
-    PointId num_points_in_cluster = 0;
-
-    // Set zero
-    for (Point::value_type& c : centroid)
-      c = 0.0;
-
-    // For each PointId in this set
-    for (const auto& pid : clusters_to_points_[cid]) {
-      Point p = data_[pid];
-      // Point p = ps__.getPoint(pid);
-      for (unsigned int i = 0; i < num_dimensions_; i++)
-        centroid[i] += p[i];
-      num_points_in_cluster++;
-    }
-    // if no point in the clusters, this goes to inf (correct!)
-    for (unsigned int i = 0; i < num_dimensions_; i++) {
-      centroid[i] /= static_cast<float>(num_points_in_cluster);
-      // std::cout << centroid[i] << " ";
-    }
-    // std::cout << std::endl;
+  std::vector<float> centroids;
+  computeCentroids(centroids);
 
-    cid++;
+  centroids_.resize(num_clusters_);
+  for (ClusterId cid = 0; cid < num_clusters_; cid++)
+    centroids_[cid].assign(centroids.cbegin() + cid * num_dimensions_,
+                           centroids.cbegin() + (cid + 1) * num_dimensions_);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+void
+pcl::Kmeans::computeCentroids(std::vector<float>& centroids) const
+{
+  const pcl::ThreadReservation reservation(threads_);
+  const unsigned int threads = reservation.getNumberOfThreads();
+  std::size_t k = num_clusters_;
+  int dimensions = static_cast<int>(num_dimensions_);
+  std::size_t num_points = std::min<std::size_t>(
+      num_points_, num_dimensions_ > 0 ? data_.size() / num_dimensions_ : 0);
+
+  std::vector<PointId> num_points_in_cluster(k, 0);
+  for (std::size_t pid = 0; pid < num_points; pid++)
+    num_points_in_cluster[points_to_clusters_[pid]]++;
+
+  // Every thread sums up its own dimensions over all points in order, so the
+  // result does not depend on the number of threads
+  std::vector<double> sums(k * num_dimensions_, 0.0);
+  centroids.resize(k * num_dimensions_);
+#pragma omp parallel for default(none)                                                 \
+    shared(centroids, dimensions, k, num_points, num_points_in_cluster, sums)          \
+    schedule(static) num_threads(threads)
+  for (int dim = 0; dim < dimensions; dim++) {
+    for (std::size_t pid = 0; pid < num_points; pid++)
+      sums[points_to_clusters_[pid] * num_dimensions_ + dim] +=
+          data_[pid * num_dimensions_ + dim];
+
+    // if no point in the clusters, this goes to inf (correct!)
+    for (std::size_t cid = 0; cid < k; cid++)
+      centroids[cid * num_dimensions_ + dim] =
+          static_cast<float>(sums[cid * num_dimensions_ + dim] /
+                             static_cast<double>(num_points_in_cluster[cid]));
   }
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 void
-pcl::Kmeans::kMeans()
+pcl::Kmeans::seedCentroids(std::vector<float>& centroids) const
+{
+  const pcl::ThreadReservation reservation(threads_);
+  const unsigned int threads = reservation.getNumberOfThreads();
+  int num_points = static_cast<int>(num_points_);
+  unsigned int dimensions = num_dimensions_;
+  std::mt19937 rng(seed_);
+
+  centroids.resize(static_cast<std::size_t>(num_clusters_) * num_dimensions_);
+  std::vector<float> min_distances(num_points_, std::numeric_limits<float>::max());
+
+  std::size_t pid = std::uniform_int_distribution<std::size_t>(0, num_points_ - 1)(rng);
+  for (ClusterId cid = 0; cid < num_clusters_; cid++) {
+    const float* center = &centroids[cid * num_dimensions_];
+    std::copy_n(&data_[pid * num_dimensions_], num_dimensions_, &centroids[cid * num_dimensions_]);
+    if (cid + 1 == num_clusters_)
+      break;
+
+    // Squared distance of every point to its closest centroid so far
+#pragma omp parallel for default(none)                                                 \
+    shared(center, dimensions, min_distances, num_points) schedule(static)             \
+    num_threads(threads)
+    for (int i = 0; i < num_points; i++)
+      min_distances[i] = std::min(
+          min_distances[i], squaredDistance(&data_[static_cast<std::size_t>(i) * dimensions], center, dimensions));
+
+    // Draw the next centroid, summing in order to stay independent of the threads
+    double total = 0.0;
+    for (const float d : min_distances)
+      total += d;
+    if (total > 0.0) {
+      double target = std::uniform_real_distribution<double>(0.0, total)(rng);
+      pid = 0;
+      while (pid + 1 < num_points_ && (target -= min_distances[pid]) >= 0.0)
+        pid++;
+      // skip points that already are centroids
+      while (min_distances[pid] == 0.0f && pid > 0)
+        pid--;
+    }
+    else
+      // All points coincide with the centroids
+      pid = std::uniform_int_distribution<std::size_t>(0, num_points_ - 1)(rng);
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+std::size_t
+pcl::Kmeans::assignPoints(const std::vector<float>& centroids,
+                          bool bounds_valid,
+                          std::vector<float>& upper_bounds,
+                          std::vector<float>& lower_bounds)
 {
-  bool not_converged = true;
-  ClusterId cid, to_cluster;
-  float d, min;
+  const pcl::ThreadReservation reservation(threads_);
+  const unsigned int threads = reservation.getNumberOfThreads();
+  int num_points = static_cast<int>(num_points_);
+  unsigned int k = num_clusters_;
+  unsigned int dimensions = num_dimensions_;
+
+  // Half the distance of every centroid to the closest other one: a point closer
+  // than that to its centroid can not be closer to any other centroid
+  std::vector<float> half_separations(k, std::numeric_limits<float>::infinity());
+  for (unsigned int c = 0; c < k; c++)
+    for (unsigned int other = c + 1; other < k; other++) {
+      const float d = 0.5f * std::sqrt(squaredDistance(
+                                 &centroids[c * dimensions], &centroids[other * dimensions], dimensions));
+      // centroids of empty clusters are NaN and do not count
+      if (std::isfinite(d)) {
+        half_separations[c] = std::min(half_separations[c], d);
+        half_separations[other] = std::min(half_separations[other], d);
+      }
+    }
 
-  // Initial partition of points
-  initialClusterPoints();
+  std::size_t num_moved = 0;
+#pragma omp parallel for default(none)                                                 \
+    shared(bounds_valid, centroids, dimensions, half_separations, k, lower_bounds,     \
+           num_points, upper_bounds) reduction(+: num_moved) schedule(static)          \
+    num_threads(threads)
+  for (int pid = 0; pid < num_points; pid++) {
+    const float* point = &data_[static_cast<std::size_t>(pid) * dimensions];
+    const ClusterId cid = points_to_clusters_[pid];
+
+    if (bounds_valid) {
+      const float bound = std::max(half_separations[cid], lower_bounds[pid]);
+      if (upper_bounds[pid] <= bound)
+        continue;
+      // Tighten the upper bound and try again
+      upper_bounds[pid] =
+          std::sqrt(squaredDistance(point, &centroids[cid * dimensions], dimensions));
+      if (upper_bounds[pid] <= bound)
+        continue;
+    }
 
-  // Until not converge
-  while (not_converged) {
+    // Compare against all centroids, staying in the current cluster on ties
+    ClusterId closest = cid;
+    float min_distance = squaredDistance(point, &centroids[cid * dimensions], dimensions);
+    float second_distance = std::numeric_limits<float>::infinity();
+    for (ClusterId other = 0; other < k; other++) {
+      if (other == cid)
+        continue;
+      const float d = squaredDistance(point, &centroids[other * dimensions], dimensions);
+      if (d < min_distance) {
+        if (min_distance < second_distance)
+          second_distance = min_distance;
+        min_distance = d;
+        closest = other;
+      }
+      else if (d < second_distance)
+        second_distance = d;
+    }
 
-    not_converged = false;
+    if (closest != cid) {
+      points_to_clusters_[pid] = closest;
+      num_moved++;
+    }
+    upper_bounds[pid] = std::sqrt(min_distance);
+    lower_bounds[pid] = std::sqrt(second_distance);
+  }
+  return num_moved;
+}
 
-    computeCentroids();
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+void
+pcl::Kmeans::kMeans()
+{
+  if (data_.size() != static_cast<std::size_t>(num_points_) * num_dimensions_) {
+    std::cout << "Data vector not the same" << std::endl;
+    return;
+  }
+  if (num_points_ == 0 || num_clusters_ == 0)
+    return;
 
-    // for each point
-    for (PointId pid = 0; pid < num_points_; pid++) {
-      // distance from current cluster
-      min = distance(centroids_[points_to_clusters_[pid]], data_[pid]);
+  // seedCentroids, assignPoints and computeCentroids share this reservation
+  const pcl::ThreadReservation reservation(threads_);
+  const unsigned int threads = reservation.getNumberOfThreads();
 
-      // foreach centroid
-      cid = 0;
-      bool move = false;
-      for (const auto& c : centroids_) {
-        d = distance(c, data_[pid]);
-        if (d < min) {
-          min = d;
-          move = true;
-          to_cluster = cid;
+  std::vector<float> centroids;
+  std::vector<float> upper_bounds(num_points_);
+  std::vector<float> lower_bounds(num_points_);
+  bool bounds_valid = false;
 
-          // remove from current cluster
-          clusters_to_points_[points_to_clusters_[pid]].erase(pid);
+  // Initial partition of points
+  if (use_kmeans_plus_plus_) {
+    points_to_clusters_.assign(num_points_, 0);
+    seedCentroids(centroids);
+    assignPoints(centroids, false, upper_bounds, lower_bounds);
+    bounds_valid = true;
+  }
+  else
+    initialClusterPoints();
 
-          not_converged = true;
+  // Until not converge
+  std::vector<float> previous_centroids;
+  std::vector<float> moves(num_clusters_);
+  for (;;) {
+    previous_centroids.swap(centroids);
+    computeCentroids(centroids);
+
+    // Keep the bounds valid for the moved centroids
+    if (bounds_valid) {
+      ClusterId farthest = 0;
+      float max_move = 0.0f, second_move = 0.0f;
+      for (ClusterId cid = 0; cid < num_clusters_; cid++) {
+        moves[cid] = std::sqrt(squaredDistance(&previous_centroids[cid * num_dimensions_],
+                                               &centroids[cid * num_dimensions_],
+                                               num_dimensions_));
+        // a cluster that became empty has no points and can not get any
+        if (!std::isfinite(moves[cid]))
+          moves[cid] = 0.0f;
+        if (moves[cid] > max_move) {
+          second_move = max_move;
+          max_move = moves[cid];
+          farthest = cid;
         }
-        cid++;
+        else if (moves[cid] > second_move)
+          second_move = moves[cid];
       }
-
-      // move towards a closer centroid
-      if (move) {
-        // insert
-        points_to_clusters_[pid] = to_cluster;
-        clusters_to_points_[to_cluster].insert(pid);
+      int num_points = static_cast<int>(num_points_);
+#pragma omp parallel for default(none)                                                 \
+    shared(farthest, lower_bounds, max_move, moves, num_points, second_move,           \
+           upper_bounds) schedule(static) num_threads(threads)
+      for (int pid = 0; pid < num_points; pid++) {
+        const ClusterId cid = points_to_clusters_[pid];
+        upper_bounds[pid] += moves[cid];
+        lower_bounds[pid] -= (cid == farthest ? second_move : max_move);
       }
     }
+
+    const std::size_t num_moved =
+        assignPoints(centroids, bounds_valid, upper_bounds, lower_bounds);
+    bounds_valid = true;
+    if (num_moved == 0)
+      break;
   } // end while
+
+  centroids_.resize(num_clusters_);
+  clusters_to_points_.assign(num_clusters_, SetPoints());
+  for (ClusterId cid = 0; cid < num_clusters_; cid++)
+    centroids_[cid].assign(centroids.cbegin() + cid * num_dimensions_,
+                           centroids.cbegin() + (cid + 1) * num_dimensions_);
+  for (PointId pid = 0; pid < num_points_; pid++)
+    clusters_to_points_[points_to_clusters_[pid]].insert(pid);
 }
 
 /*
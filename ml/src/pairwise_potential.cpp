@@ -37,14 +37,18 @@
  *
  */
 
+#include <pcl/common/execution_context.h>
 #include <pcl/ml/pairwise_potential.h>
 
 pcl::PairwisePotential::PairwisePotential(const std::vector<float>& feature,
                                           const int feature_dimension,
                                           const int N,
-                                          const float w)
+                                          const float w,
+                                          unsigned int nr_threads)
 : N_(N), w_(w)
 {
+  setNumberOfThreads(nr_threads);
+
   // lattice_.init (feature, feature_dimension, N);
   // std::cout << "0---------" << std::endl;
   lattice_.init(feature, feature_dimension, N);
@@ -116,8 +120,21 @@ pcl::PairwisePotential::compute(std::vector<float>& out,
                                 std::vector<float>& tmp,
                                 int value_size) const
 {
+  const pcl::ThreadReservation reservation(threads_);
+  const unsigned int threads = reservation.getNumberOfThreads();
   lattice_.compute(tmp, in, value_size);
-  for (int i = 0, k = 0; i < N_; i++)
-    for (int j = 0; j < value_size; j++, k++)
+#pragma omp parallel for default(none) shared(out, tmp, value_size) schedule(static)   \
+    num_threads(threads)
+  for (int i = 0; i < N_; i++)
+    for (int j = 0, k = i * value_size; j < value_size; j++, k++)
       out[k] += w_ * norm_[i] * tmp[k];
 }
+
+void
+pcl::PairwisePotential::setNumberOfThreads(unsigned int nr_threads)
+{
+  // 0 is resolved against the budget of pcl::ExecutionContext at compute time
+  threads_ = nr_threads;
+
+  lattice_.setNumberOfThreads(threads_);
+}
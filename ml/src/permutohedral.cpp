@@ -35,10 +35,85 @@
  *
  */
 
+#include <pcl/common/execution_context.h>
 #include <pcl/ml/permutohedral.h>
 #include <pcl/pcl_macros.h> // for pcl_round
 
-#include <map> // for multimap
+#include <algorithm> // for std::equal
+#include <cmath>
+
+namespace {
+/** Open addressing hash table of the lattice vertex keys, numbering the keys in the
+ *  order of their insertion. */
+class LatticeHashTable {
+public:
+  LatticeHashTable(int key_size, std::size_t max_num_of_keys) : key_size_(key_size)
+  {
+    std::size_t capacity = 1;
+    while (capacity < 2 * max_num_of_keys)
+      capacity <<= 1;
+    table_.assign(capacity, -1);
+    keys_.reserve(max_num_of_keys * key_size_);
+  }
+
+  /** Returns the index of the key, the key is added if it is new. */
+  int
+  insert(const short* key)
+  {
+    std::size_t h = hash(key);
+    for (;; h = (h + 1) & (table_.size() - 1)) {
+      const int e = table_[h];
+      if (e == -1) {
+        table_[h] = size();
+        keys_.insert(keys_.end(), key, key + key_size_);
+        return table_[h];
+      }
+      if (std::equal(key, key + key_size_, getKey(e)))
+        return e;
+    }
+  }
+
+  /** Returns the index of the key or -1, can be called concurrently. */
+  int
+  find(const short* key) const
+  {
+    std::size_t h = hash(key);
+    for (;; h = (h + 1) & (table_.size() - 1)) {
+      const int e = table_[h];
+      if (e == -1 || std::equal(key, key + key_size_, getKey(e)))
+        return e;
+    }
+  }
+
+  const short*
+  getKey(int i) const
+  {
+    return keys_.data() + static_cast<std::size_t>(i) * key_size_;
+  }
+
+  int
+  size() const
+  {
+    return static_cast<int>(keys_.size() / key_size_);
+  }
+
+private:
+  std::size_t
+  hash(const short* key) const
+  {
+    std::size_t r = 0;
+    for (int i = 0; i < key_size_; i++) {
+      r += key[i];
+      r *= 1664525;
+    }
+    return (r ^ (r >> 29)) & (table_.size() - 1);
+  }
+
+  int key_size_;
+  std::vector<int> table_;
+  std::vector<short> keys_;
+};
+} // namespace
 
 pcl::Permutohedral::Permutohedral()
 : N_(0)
@@ -47,40 +122,35 @@ pcl::Permutohedral::Permutohedral()
 , blur_neighborsOLD_(nullptr)
 , offsetOLD_(nullptr)
 , barycentricOLD_(nullptr)
-{}
+{
+  setNumberOfThreads();
+}
+
+void
+pcl::Permutohedral::setNumberOfThreads(unsigned int nr_threads)
+{
+  // 0 is resolved against the budget of pcl::ExecutionContext at compute time
+  threads_ = nr_threads;
+}
 
 void
 pcl::Permutohedral::init(const std::vector<float>& feature,
                          const int feature_dimension,
                          const int N)
 {
+  const pcl::ThreadReservation reservation(threads_);
+  const unsigned int threads = reservation.getNumberOfThreads();
   N_ = N;
   d_ = feature_dimension;
 
-  // Create hash table
-  std::vector<std::vector<short>> keys;
-  keys.reserve((d_ + 1) * N_);
-  std::multimap<std::size_t, int> hash_table;
-
   // reserve class memory
-  if (!offset_.empty())
-    offset_.clear();
-  offset_.resize((d_ + 1) * N_);
-
-  if (!barycentric_.empty())
-    barycentric_.clear();
-  barycentric_.resize((d_ + 1) * N_);
+  offset_.assign((d_ + 1) * N_, 0.0f);
+  barycentric_.assign((d_ + 1) * N_, 0.0f);
 
   // create vectors and matrices
   Eigen::VectorXf scale_factor = Eigen::VectorXf::Zero(d_);
-  Eigen::VectorXf elevated = Eigen::VectorXf::Zero(d_ + 1);
-  Eigen::VectorXf rem0 = Eigen::VectorXf::Zero(d_ + 1);
-  Eigen::VectorXf barycentric = Eigen::VectorXf::Zero(d_ + 2);
-  Eigen::VectorXi rank = Eigen::VectorXi::Zero(d_ + 1);
   Eigen::Matrix<int, Eigen::Dynamic, Eigen::Dynamic> canonical;
   canonical = Eigen::Matrix<int, Eigen::Dynamic, Eigen::Dynamic>::Zero(d_ + 1, d_ + 1);
-  // short * key = new short[d_+1];
-  std::vector<short> key(d_ + 1);
 
   // Compute the canonical simple
   for (int i = 0; i <= d_; i++) {
@@ -99,158 +169,140 @@ pcl::Permutohedral::init(const std::vector<float>& feature,
                       std::sqrt(static_cast<float>(i + 2) * static_cast<float>(i + 1)) *
                       inv_std_dev;
 
-  // Compute the simplex each feature lies in
-  for (int k = 0; k < N_; k++)
-  // for (int k = 0; k < 5; k++)
-  {
-
-    // Elevate the feature  (y = Ep, see p.5 in [Adams etal 2010])
-    int index = k * feature_dimension;
-    // sm contains the sum of 1..n of our faeture vector
-    float sm = 0;
-    for (int j = d_; j > 0; j--) {
-      float cf = feature[index + j - 1] * scale_factor(j - 1);
-      elevated(j) = sm - static_cast<float>(j) * cf;
-      sm += cf;
-    }
-    elevated(0) = sm;
+  // Keys of the d + 1 vertices of the simplex each feature lies in
+  std::vector<short> point_keys(static_cast<std::size_t>(N_) * (d_ + 1) * d_);
 
-    // Find the closest 0-colored simplex through rounding
-    float down_factor = 1.0f / static_cast<float>(d_ + 1);
-    float up_factor = static_cast<float>(d_ + 1);
-    int sum = 0;
-    for (int j = 0; j <= d_; j++) {
-      float rd = std::floor(0.5f + (down_factor * elevated(j)));
-      rem0(j) = rd * up_factor;
-      sum += static_cast<int>(rd);
-    }
-
-    // rank differential to find the permutation between this simplex and the canonical
-    // one. (See pg. 3-4 in paper.)
-    rank.setZero();
-    Eigen::VectorXf tmp = elevated - rem0;
-    for (int i = 0; i < d_; i++) {
-      for (int j = i + 1; j <= d_; j++)
-        if (tmp(i) < tmp(j))
-          rank(i)++;
-        else
-          rank(j)++;
-    }
-
-    // If the point doesn't lie on the plane (sum != 0) bring it back
-    for (int j = 0; j <= d_; j++) {
-      rank(j) += sum;
-      if (rank(j) < 0) {
-        rank(j) += d_ + 1;
-        rem0(j) += static_cast<float>(d_ + 1);
+  // Compute the simplex each feature lies in, independently for every feature
+#pragma omp parallel default(none)                                                     \
+    shared(feature, feature_dimension, scale_factor, canonical, point_keys)            \
+    num_threads(threads)
+  {
+    Eigen::VectorXf elevated = Eigen::VectorXf::Zero(d_ + 1);
+    Eigen::VectorXf rem0 = Eigen::VectorXf::Zero(d_ + 1);
+    Eigen::VectorXf barycentric = Eigen::VectorXf::Zero(d_ + 2);
+    Eigen::VectorXi rank = Eigen::VectorXi::Zero(d_ + 1);
+
+#pragma omp for schedule(static)
+    for (int k = 0; k < N_; k++) {
+      // Elevate the feature  (y = Ep, see p.5 in [Adams etal 2010])
+      int index = k * feature_dimension;
+      // sm contains the sum of 1..n of our faeture vector
+      float sm = 0;
+      for (int j = d_; j > 0; j--) {
+        float cf = feature[index + j - 1] * scale_factor(j - 1);
+        elevated(j) = sm - static_cast<float>(j) * cf;
+        sm += cf;
       }
-      else if (rank(j) > d_) {
-        rank(j) -= d_ + 1;
-        rem0(j) -= static_cast<float>(d_ + 1);
+      elevated(0) = sm;
+
+      // Find the closest 0-colored simplex through rounding
+      float down_factor = 1.0f / static_cast<float>(d_ + 1);
+      float up_factor = static_cast<float>(d_ + 1);
+      int sum = 0;
+      for (int j = 0; j <= d_; j++) {
+        float rd = std::floor(0.5f + (down_factor * elevated(j)));
+        rem0(j) = rd * up_factor;
+        sum += static_cast<int>(rd);
       }
-    }
 
-    // Compute the barycentric coordinates (p.10 in [Adams etal 2010])
-    barycentric.setZero();
-    Eigen::VectorXf v = (elevated - rem0) * down_factor;
-    for (int j = 0; j <= d_; j++) {
-      barycentric(d_ - rank(j)) += v(j);
-      barycentric(d_ + 1 - rank(j)) -= v(j);
-    }
-    // Wrap around
-    barycentric(0) += 1.0f + barycentric(d_ + 1);
+      // rank differential to find the permutation between this simplex and the
+      // canonical one. (See pg. 3-4 in paper.)
+      rank.setZero();
+      Eigen::VectorXf tmp = elevated - rem0;
+      for (int i = 0; i < d_; i++) {
+        for (int j = i + 1; j <= d_; j++)
+          if (tmp(i) < tmp(j))
+            rank(i)++;
+          else
+            rank(j)++;
+      }
 
-    // Compute all vertices and their offset
-    for (int remainder = 0; remainder <= d_; remainder++) {
-      for (int j = 0; j < d_; j++)
-        key[j] = static_cast<short>(rem0(j) +
-                                    static_cast<float>(canonical(rank(j), remainder)));
-
-      // insert key in hash table
-      std::size_t hash_key = generateHashKey(key);
-      auto it = hash_table.find(hash_key);
-      int key_index = -1;
-      if (it != hash_table.end()) {
-        // check if key is the right one
-        int tmp_key_index = -1;
-        // for (int ii = key_index; ii < keys.size (); ii++)
-        for (; it != hash_table.end(); ++it) {
-          int ii = it->second;
-          bool same = true;
-          std::vector<short> k = keys[ii];
-          for (std::size_t i_k = 0; i_k < k.size(); i_k++) {
-            if (key[i_k] != k[i_k]) {
-              same = false;
-              break;
-            }
-          }
-
-          if (same) {
-            tmp_key_index = ii;
-            break;
-          }
+      // If the point doesn't lie on the plane (sum != 0) bring it back
+      for (int j = 0; j <= d_; j++) {
+        rank(j) += sum;
+        if (rank(j) < 0) {
+          rank(j) += d_ + 1;
+          rem0(j) += static_cast<float>(d_ + 1);
         }
-
-        if (tmp_key_index == -1) {
-          key_index = static_cast<int>(keys.size());
-          keys.push_back(key);
-          hash_table.insert(std::pair<std::size_t, int>(hash_key, key_index));
+        else if (rank(j) > d_) {
+          rank(j) -= d_ + 1;
+          rem0(j) -= static_cast<float>(d_ + 1);
         }
-        else
-          key_index = tmp_key_index;
       }
 
-      else {
-        key_index = static_cast<int>(keys.size());
-        keys.push_back(key);
-        hash_table.insert(std::pair<std::size_t, int>(hash_key, key_index));
+      // Compute the barycentric coordinates (p.10 in [Adams etal 2010])
+      barycentric.setZero();
+      Eigen::VectorXf v = (elevated - rem0) * down_factor;
+      for (int j = 0; j <= d_; j++) {
+        barycentric(d_ - rank(j)) += v(j);
+        barycentric(d_ + 1 - rank(j)) -= v(j);
       }
-      offset_[k * (d_ + 1) + remainder] = static_cast<float>(key_index);
+      // Wrap around
+      barycentric(0) += 1.0f + barycentric(d_ + 1);
 
-      barycentric_[k * (d_ + 1) + remainder] = barycentric(remainder);
+      // Compute all vertices
+      for (int remainder = 0; remainder <= d_; remainder++) {
+        short* key = &point_keys[(static_cast<std::size_t>(k) * (d_ + 1) + remainder) * d_];
+        for (int j = 0; j < d_; j++)
+          key[j] = static_cast<short>(rem0(j) +
+                                      static_cast<float>(canonical(rank(j), remainder)));
+
+        barycentric_[k * (d_ + 1) + remainder] = barycentric(remainder);
+      }
     }
   }
 
-  // Find the Neighbors of each lattice point
+  // Number the vertices in the order of their first appearance
+  const std::size_t num_of_entries = static_cast<std::size_t>(N_) * (d_ + 1);
+  LatticeHashTable hash_table(d_, num_of_entries);
+  std::vector<int> vertex_indices(num_of_entries);
+  for (std::size_t i = 0; i < num_of_entries; i++) {
+    vertex_indices[i] = hash_table.insert(&point_keys[i * d_]);
+    offset_[i] = static_cast<float>(vertex_indices[i]);
+  }
 
   // Get the number of vertices in the lattice
-  M_ = static_cast<int>(hash_table.size());
+  M_ = hash_table.size();
 
-  // Create the neighborhood structure
-  if (!blur_neighbors_.empty())
-    blur_neighbors_.clear();
-  blur_neighbors_.resize((d_ + 1) * M_);
+  // Invert the point to vertex mapping, so that the splatting can gather the values of
+  // each vertex from its points
+  splat_offsets_.assign(M_ + 1, 0);
+  for (const int vertex_index : vertex_indices)
+    ++splat_offsets_[vertex_index + 1];
+  for (int i = 0; i < M_; i++)
+    splat_offsets_[i + 1] += splat_offsets_[i];
 
-  std::vector<short> n1(d_ + 1);
-  std::vector<short> n2(d_ + 1);
+  splat_entries_.resize(num_of_entries);
+  {
+    std::vector<int> fill(splat_offsets_.begin(), splat_offsets_.end() - 1);
+    for (std::size_t i = 0; i < num_of_entries; i++)
+      splat_entries_[fill[vertex_indices[i]]++] = static_cast<int>(i);
+  }
+
+  // Find the Neighbors of each lattice point
+  blur_neighbors_.resize((d_ + 1) * M_);
 
   // For each of d+1 axes,
-  for (int j = 0; j <= d_; j++) {
+#pragma omp parallel default(none) shared(hash_table) num_threads(threads)
+  {
+    std::vector<short> n1(d_ + 1);
+    std::vector<short> n2(d_ + 1);
+
+#pragma omp for schedule(static)
     for (int i = 0; i < M_; i++) {
-      std::vector<short> key = keys[i];
+      const short* key = hash_table.getKey(i);
 
-      for (int k = 0; k < d_; k++) {
-        n1[k] = static_cast<short>(key[k] - 1);
-        n2[k] = static_cast<short>(key[k] + 1);
+      for (int j = 0; j <= d_; j++) {
+        for (int k = 0; k < d_; k++) {
+          n1[k] = static_cast<short>(key[k] - 1);
+          n2[k] = static_cast<short>(key[k] + 1);
+        }
+        n1[j] = static_cast<short>(key[j] + d_);
+        n2[j] = static_cast<short>(key[j] - d_);
+
+        blur_neighbors_[j * M_ + i].n1 = hash_table.find(n1.data());
+        blur_neighbors_[j * M_ + i].n2 = hash_table.find(n2.data());
       }
-      n1[j] = static_cast<short>(key[j] + d_);
-      n2[j] = static_cast<short>(key[j] - d_);
-
-      std::multimap<std::size_t, int>::iterator it;
-      std::size_t hash_key;
-      int key_index = -1;
-      hash_key = generateHashKey(n1);
-      it = hash_table.find(hash_key);
-      if (it != hash_table.end())
-        key_index = it->second;
-      blur_neighbors_[j * M_ + i].n1 = key_index;
-
-      key_index = -1;
-      hash_key = generateHashKey(n2);
-      it = hash_table.find(hash_key);
-      if (it != hash_table.end())
-        key_index = it->second;
-      blur_neighbors_[j * M_ + i].n2 = key_index;
     }
   }
 }
@@ -264,6 +316,8 @@ pcl::Permutohedral::compute(std::vector<float>& out,
                             int in_size,
                             int out_size) const
 {
+  const pcl::ThreadReservation reservation(threads_);
+  const unsigned int threads = reservation.getNumberOfThreads();
   if (in_size == -1)
     in_size = N_ - in_offset;
   if (out_size == -1)
@@ -273,30 +327,39 @@ pcl::Permutohedral::compute(std::vector<float>& out,
   std::vector<float> values((M_ + 2) * value_size, 0.0f);
   std::vector<float> new_values((M_ + 2) * value_size, 0.0f);
 
-  // Splatting
-  for (int i = 0; i < in_size; i++) {
-    for (int j = 0; j <= d_; j++) {
-      int o = static_cast<int>(offset_[(in_offset + i) * (d_ + 1) + j]) + 1;
-      float w = barycentric_[(in_offset + i) * (d_ + 1) + j];
+  // Splatting, every vertex gathers the weighted values of its points in the order of
+  // the points
+#pragma omp parallel for default(none)                                                 \
+    shared(in, value_size, in_offset, in_size, values) schedule(static)                \
+    num_threads(threads)
+  for (int i = 0; i < M_; i++) {
+    float* value = &values[(i + 1) * value_size];
+    for (int e = splat_offsets_[i]; e < splat_offsets_[i + 1]; e++) {
+      const int entry = splat_entries_[e];
+      const int point = entry / (d_ + 1) - in_offset;
+      if (point < 0 || point >= in_size)
+        continue;
+
+      const float w = barycentric_[entry];
+      const float* in_value = &in[point * value_size];
       for (int k = 0; k < value_size; k++)
-        values[o * value_size + k] += w * in[i * value_size + k];
+        value[k] += w * in_value[k];
     }
   }
 
+  // Blurring along each lattice direction, the vertices are independent
   for (int j = 0; j <= d_; j++) {
+#pragma omp parallel for default(none)                                                 \
+    shared(j, value_size, values, new_values) schedule(static) num_threads(threads)
     for (int i = 0; i < M_; i++) {
-      int old_val_idx = (i + 1) * value_size;
-      int new_val_idx = (i + 1) * value_size;
+      const float* old_val = &values[(i + 1) * value_size];
+      float* new_val = &new_values[(i + 1) * value_size];
 
-      int n1 = blur_neighbors_[j * M_ + i].n1 + 1;
-      int n2 = blur_neighbors_[j * M_ + i].n2 + 1;
-      int n1_val_idx = n1 * value_size;
-      int n2_val_idx = n2 * value_size;
+      const float* n1_val = &values[(blur_neighbors_[j * M_ + i].n1 + 1) * value_size];
+      const float* n2_val = &values[(blur_neighbors_[j * M_ + i].n2 + 1) * value_size];
 
       for (int k = 0; k < value_size; k++)
-        new_values[new_val_idx + k] =
-            values[old_val_idx + k] +
-            0.5f * (values[n1_val_idx + k] + values[n2_val_idx + k]);
+        new_val[k] = old_val[k] + 0.5f * (n1_val[k] + n2_val[k]);
     }
     values.swap(new_values);
   }
@@ -306,6 +369,9 @@ pcl::Permutohedral::compute(std::vector<float>& out,
   float alpha = 1.0f / (1.0f + static_cast<float>(pow(2.0f, -d_)));
 
   // Slicing
+#pragma omp parallel for default(none)                                                 \
+    shared(out, value_size, out_offset, out_size, values, alpha) schedule(static)      \
+    num_threads(threads)
   for (int i = 0; i < out_size; i++) {
     for (int k = 0; k < value_size; k++)
       out[i * value_size + k] = 0;
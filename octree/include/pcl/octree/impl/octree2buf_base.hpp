@@ -42,11 +42,13 @@
 namespace pcl {
 namespace octree {
 //////////////////////////////////////////////////////////////////////////////////////////////
-template <typename LeafContainerT, typename BranchContainerT>
-Octree2BufBase<LeafContainerT, BranchContainerT>::Octree2BufBase()
+template <typename LeafContainerT,
+          typename BranchContainerT,
+          typename NodeAllocatorT>
+Octree2BufBase<LeafContainerT, BranchContainerT, NodeAllocatorT>::Octree2BufBase()
 : leaf_count_(0)
 , branch_count_(1)
-, root_node_(new BranchNode())
+, root_node_(allocateBranchNode())
 , depth_mask_(0)
 , buffer_selector_(0)
 , tree_dirty_flag_(false)
@@ -55,19 +57,23 @@ Octree2BufBase<LeafContainerT, BranchContainerT>::Octree2BufBase()
 {}
 
 //////////////////////////////////////////////////////////////////////////////////////////////
-template <typename LeafContainerT, typename BranchContainerT>
-Octree2BufBase<LeafContainerT, BranchContainerT>::~Octree2BufBase()
+template <typename LeafContainerT,
+          typename BranchContainerT,
+          typename NodeAllocatorT>
+Octree2BufBase<LeafContainerT, BranchContainerT, NodeAllocatorT>::~Octree2BufBase()
 {
   // deallocate tree structure
   deleteTree();
-  delete (root_node_);
+  node_allocator_.deallocate(root_node_);
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////
-template <typename LeafContainerT, typename BranchContainerT>
+template <typename LeafContainerT,
+          typename BranchContainerT,
+          typename NodeAllocatorT>
 void
-Octree2BufBase<LeafContainerT, BranchContainerT>::setMaxVoxelIndex(
-    uindex_t max_voxel_index_arg)
+Octree2BufBase<LeafContainerT, BranchContainerT, NodeAllocatorT>::
+    setMaxVoxelIndex(uindex_t max_voxel_index_arg)
 {
   uindex_t treeDepth;
 
@@ -84,9 +90,12 @@ Octree2BufBase<LeafContainerT, BranchContainerT>::setMaxVoxelIndex(
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////
-template <typename LeafContainerT, typename BranchContainerT>
+template <typename LeafContainerT,
+          typename BranchContainerT,
+          typename NodeAllocatorT>
 void
-Octree2BufBase<LeafContainerT, BranchContainerT>::setTreeDepth(uindex_t depth_arg)
+Octree2BufBase<LeafContainerT, BranchContainerT, NodeAllocatorT>::
+    setTreeDepth(uindex_t depth_arg)
 {
   assert(depth_arg > 0);
 
@@ -101,11 +110,12 @@ Octree2BufBase<LeafContainerT, BranchContainerT>::setTreeDepth(uindex_t depth_ar
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////
-template <typename LeafContainerT, typename BranchContainerT>
+template <typename LeafContainerT,
+          typename BranchContainerT,
+          typename NodeAllocatorT>
 LeafContainerT*
-Octree2BufBase<LeafContainerT, BranchContainerT>::findLeaf(uindex_t idx_x_arg,
-                                                           uindex_t idx_y_arg,
-                                                           uindex_t idx_z_arg)
+Octree2BufBase<LeafContainerT, BranchContainerT, NodeAllocatorT>::
+    findLeaf(uindex_t idx_x_arg, uindex_t idx_y_arg, uindex_t idx_z_arg)
 {
   // generate key
   OctreeKey key(idx_x_arg, idx_y_arg, idx_z_arg);
@@ -115,11 +125,12 @@ Octree2BufBase<LeafContainerT, BranchContainerT>::findLeaf(uindex_t idx_x_arg,
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////
-template <typename LeafContainerT, typename BranchContainerT>
+template <typename LeafContainerT,
+          typename BranchContainerT,
+          typename NodeAllocatorT>
 LeafContainerT*
-Octree2BufBase<LeafContainerT, BranchContainerT>::createLeaf(uindex_t idx_x_arg,
-                                                             uindex_t idx_y_arg,
-                                                             uindex_t idx_z_arg)
+Octree2BufBase<LeafContainerT, BranchContainerT, NodeAllocatorT>::
+    createLeaf(uindex_t idx_x_arg, uindex_t idx_y_arg, uindex_t idx_z_arg)
 {
   // generate key
   OctreeKey key(idx_x_arg, idx_y_arg, idx_z_arg);
@@ -129,11 +140,12 @@ Octree2BufBase<LeafContainerT, BranchContainerT>::createLeaf(uindex_t idx_x_arg,
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////
-template <typename LeafContainerT, typename BranchContainerT>
+template <typename LeafContainerT,
+          typename BranchContainerT,
+          typename NodeAllocatorT>
 bool
-Octree2BufBase<LeafContainerT, BranchContainerT>::existLeaf(uindex_t idx_x_arg,
-                                                            uindex_t idx_y_arg,
-                                                            uindex_t idx_z_arg) const
+Octree2BufBase<LeafContainerT, BranchContainerT, NodeAllocatorT>::
+    existLeaf(uindex_t idx_x_arg, uindex_t idx_y_arg, uindex_t idx_z_arg) const
 {
   // generate key
   OctreeKey key(idx_x_arg, idx_y_arg, idx_z_arg);
@@ -143,11 +155,12 @@ Octree2BufBase<LeafContainerT, BranchContainerT>::existLeaf(uindex_t idx_x_arg,
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////
-template <typename LeafContainerT, typename BranchContainerT>
+template <typename LeafContainerT,
+          typename BranchContainerT,
+          typename NodeAllocatorT>
 void
-Octree2BufBase<LeafContainerT, BranchContainerT>::removeLeaf(uindex_t idx_x_arg,
-                                                             uindex_t idx_y_arg,
-                                                             uindex_t idx_z_arg)
+Octree2BufBase<LeafContainerT, BranchContainerT, NodeAllocatorT>::
+    removeLeaf(uindex_t idx_x_arg, uindex_t idx_y_arg, uindex_t idx_z_arg)
 {
   // generate key
   OctreeKey key(idx_x_arg, idx_y_arg, idx_z_arg);
@@ -157,9 +170,11 @@ Octree2BufBase<LeafContainerT, BranchContainerT>::removeLeaf(uindex_t idx_x_arg,
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////
-template <typename LeafContainerT, typename BranchContainerT>
+template <typename LeafContainerT,
+          typename BranchContainerT,
+          typename NodeAllocatorT>
 void
-Octree2BufBase<LeafContainerT, BranchContainerT>::deleteTree()
+Octree2BufBase<LeafContainerT, BranchContainerT, NodeAllocatorT>::deleteTree()
 {
   if (root_node_) {
     // reset octree
@@ -174,9 +189,47 @@ Octree2BufBase<LeafContainerT, BranchContainerT>::deleteTree()
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////
-template <typename LeafContainerT, typename BranchContainerT>
+template <typename LeafContainerT,
+          typename BranchContainerT,
+          typename NodeAllocatorT>
+typename Octree2BufBase<LeafContainerT, BranchContainerT, NodeAllocatorT>::BranchNode*
+Octree2BufBase<LeafContainerT, BranchContainerT, NodeAllocatorT>::copyTree(
+    const BranchNode& source_arg)
+{
+  BranchNode* branch = allocateBranchNode();
+  branch->getContainer() = source_arg.getContainer();
+
+  for (unsigned char child_idx = 0; child_idx < 8; ++child_idx) {
+    for (unsigned char b = 0; b < 2; ++b) {
+      const OctreeNode* child = source_arg.getChildPtr(b, child_idx);
+      if (!child)
+        continue;
+
+      // children referenced by both buffers are copied only once
+      if ((b == 1) && (child == source_arg.getChildPtr(0, child_idx))) {
+        branch->setChildPtr(1, child_idx, branch->getChildPtr(0, child_idx));
+        continue;
+      }
+
+      OctreeNode* child_copy;
+      if (child->getNodeType() == BRANCH_NODE)
+        child_copy = copyTree(*static_cast<const BranchNode*>(child));
+      else
+        child_copy = node_allocator_.template allocate<LeafNode>(
+            *static_cast<const LeafNode*>(child));
+      branch->setChildPtr(b, child_idx, child_copy);
+    }
+  }
+
+  return (branch);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename LeafContainerT,
+          typename BranchContainerT,
+          typename NodeAllocatorT>
 void
-Octree2BufBase<LeafContainerT, BranchContainerT>::switchBuffers()
+Octree2BufBase<LeafContainerT, BranchContainerT, NodeAllocatorT>::switchBuffers()
 {
   if (tree_dirty_flag_) {
     // make sure that all unused branch nodes from previous buffer are deleted
@@ -198,10 +251,12 @@ Octree2BufBase<LeafContainerT, BranchContainerT>::switchBuffers()
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////
-template <typename LeafContainerT, typename BranchContainerT>
+template <typename LeafContainerT,
+          typename BranchContainerT,
+          typename NodeAllocatorT>
 void
-Octree2BufBase<LeafContainerT, BranchContainerT>::serializeTree(
-    std::vector<char>& binary_tree_out_arg, bool do_XOR_encoding_arg)
+Octree2BufBase<LeafContainerT, BranchContainerT, NodeAllocatorT>::
+    serializeTree(std::vector<char>& binary_tree_out_arg, bool do_XOR_encoding_arg)
 {
   OctreeKey new_key;
 
@@ -217,12 +272,14 @@ Octree2BufBase<LeafContainerT, BranchContainerT>::serializeTree(
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////
-template <typename LeafContainerT, typename BranchContainerT>
+template <typename LeafContainerT,
+          typename BranchContainerT,
+          typename NodeAllocatorT>
 void
-Octree2BufBase<LeafContainerT, BranchContainerT>::serializeTree(
-    std::vector<char>& binary_tree_out_arg,
-    std::vector<LeafContainerT*>& leaf_container_vector_arg,
-    bool do_XOR_encoding_arg)
+Octree2BufBase<LeafContainerT, BranchContainerT, NodeAllocatorT>::
+    serializeTree(std::vector<char>& binary_tree_out_arg,
+                  std::vector<LeafContainerT*>& leaf_container_vector_arg,
+                  bool do_XOR_encoding_arg)
 {
   OctreeKey new_key;
 
@@ -245,10 +302,12 @@ Octree2BufBase<LeafContainerT, BranchContainerT>::serializeTree(
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////
-template <typename LeafContainerT, typename BranchContainerT>
+template <typename LeafContainerT,
+          typename BranchContainerT,
+          typename NodeAllocatorT>
 void
-Octree2BufBase<LeafContainerT, BranchContainerT>::serializeLeafs(
-    std::vector<LeafContainerT*>& leaf_container_vector_arg)
+Octree2BufBase<LeafContainerT, BranchContainerT, NodeAllocatorT>::
+    serializeLeafs(std::vector<LeafContainerT*>& leaf_container_vector_arg)
 {
   OctreeKey new_key;
 
@@ -265,10 +324,12 @@ Octree2BufBase<LeafContainerT, BranchContainerT>::serializeLeafs(
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////
-template <typename LeafContainerT, typename BranchContainerT>
+template <typename LeafContainerT,
+          typename BranchContainerT,
+          typename NodeAllocatorT>
 void
-Octree2BufBase<LeafContainerT, BranchContainerT>::deserializeTree(
-    std::vector<char>& binary_tree_in_arg, bool do_XOR_decoding_arg)
+Octree2BufBase<LeafContainerT, BranchContainerT, NodeAllocatorT>::
+    deserializeTree(std::vector<char>& binary_tree_in_arg, bool do_XOR_decoding_arg)
 {
   OctreeKey new_key;
 
@@ -294,12 +355,14 @@ Octree2BufBase<LeafContainerT, BranchContainerT>::deserializeTree(
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////
-template <typename LeafContainerT, typename BranchContainerT>
+template <typename LeafContainerT,
+          typename BranchContainerT,
+          typename NodeAllocatorT>
 void
-Octree2BufBase<LeafContainerT, BranchContainerT>::deserializeTree(
-    std::vector<char>& binary_tree_in_arg,
-    std::vector<LeafContainerT*>& leaf_container_vector_arg,
-    bool do_XOR_decoding_arg)
+Octree2BufBase<LeafContainerT, BranchContainerT, NodeAllocatorT>::
+    deserializeTree(std::vector<char>& binary_tree_in_arg,
+                    std::vector<LeafContainerT*>& leaf_container_vector_arg,
+                    bool do_XOR_decoding_arg)
 {
   OctreeKey new_key;
 
@@ -333,10 +396,12 @@ Octree2BufBase<LeafContainerT, BranchContainerT>::deserializeTree(
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////
-template <typename LeafContainerT, typename BranchContainerT>
+template <typename LeafContainerT,
+          typename BranchContainerT,
+          typename NodeAllocatorT>
 void
-Octree2BufBase<LeafContainerT, BranchContainerT>::serializeNewLeafs(
-    std::vector<LeafContainerT*>& leaf_container_vector_arg)
+Octree2BufBase<LeafContainerT, BranchContainerT, NodeAllocatorT>::
+    serializeNewLeafs(std::vector<LeafContainerT*>& leaf_container_vector_arg)
 {
   OctreeKey new_key;
 
@@ -352,15 +417,17 @@ Octree2BufBase<LeafContainerT, BranchContainerT>::serializeNewLeafs(
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////
-template <typename LeafContainerT, typename BranchContainerT>
+template <typename LeafContainerT,
+          typename BranchContainerT,
+          typename NodeAllocatorT>
 uindex_t
-Octree2BufBase<LeafContainerT, BranchContainerT>::createLeafRecursive(
-    const OctreeKey& key_arg,
-    uindex_t depth_mask_arg,
-    BranchNode* branch_arg,
-    LeafNode*& return_leaf_arg,
-    BranchNode*& parent_of_leaf_arg,
-    bool branch_reset_arg)
+Octree2BufBase<LeafContainerT, BranchContainerT, NodeAllocatorT>::
+    createLeafRecursive(const OctreeKey& key_arg,
+                        uindex_t depth_mask_arg,
+                        BranchNode* branch_arg,
+                        LeafNode*& return_leaf_arg,
+                        BranchNode*& parent_of_leaf_arg,
+                        bool branch_reset_arg)
 {
   // branch reset -> this branch has been taken from previous buffer
   if (branch_reset_arg) {
@@ -375,101 +442,136 @@ Octree2BufBase<LeafContainerT, BranchContainerT>::createLeafRecursive(
 
   if (depth_mask_arg > 1) {
     // we have not reached maximum tree depth
-    BranchNode* child_branch;
-    bool doNodeReset;
-
-    doNodeReset = false;
-
-    // if required branch does not exist
-    if (!branch_arg->hasChild(buffer_selector_, child_idx)) {
-      // check if we find a branch node reference in previous buffer
-
-      if (branch_arg->hasChild(!buffer_selector_, child_idx)) {
-        OctreeNode* child_node = branch_arg->getChildPtr(!buffer_selector_, child_idx);
-
-        if (child_node->getNodeType() == BRANCH_NODE) {
-          child_branch = static_cast<BranchNode*>(child_node);
-          branch_arg->setChildPtr(buffer_selector_, child_idx, child_node);
-        }
-        else {
-          // depth has changed.. child in preceding buffer is a leaf node.
-          deleteBranchChild(*branch_arg, !buffer_selector_, child_idx);
-          child_branch = createBranchChild(*branch_arg, child_idx);
-        }
-
-        // take child branch from previous buffer
-        doNodeReset = true; // reset the branch pointer array of stolen child node
-      }
-      else {
-        // if required branch does not exist -> create it
-        child_branch = createBranchChild(*branch_arg, child_idx);
-      }
-
-      branch_count_++;
-    }
-    // required branch node already exists - use it
-    else
-      child_branch = static_cast<BranchNode*>(
-          branch_arg->getChildPtr(buffer_selector_, child_idx));
+    BranchNode* child_branch = fetchBranchChild(*branch_arg, child_idx);
 
     // recursively proceed with indexed child branch
     return createLeafRecursive(key_arg,
                                depth_mask_arg / 2,
                                child_branch,
                                return_leaf_arg,
-                               parent_of_leaf_arg,
-                               doNodeReset);
+                               parent_of_leaf_arg);
   }
 
   // branch childs are leaf nodes
-  LeafNode* child_leaf;
-  if (!branch_arg->hasChild(buffer_selector_, child_idx)) {
-    // leaf node at child_idx does not exist
+  return_leaf_arg = fetchLeafChild(*branch_arg, child_idx);
+  parent_of_leaf_arg = branch_arg;
 
-    // check if we can take copy a reference from previous buffer
-    if (branch_arg->hasChild(!buffer_selector_, child_idx)) {
+  return depth_mask_arg;
+}
 
-      OctreeNode* child_node = branch_arg->getChildPtr(!buffer_selector_, child_idx);
-      if (child_node->getNodeType() == LEAF_NODE) {
-        child_leaf = static_cast<LeafNode*>(child_node);
-        child_leaf->getContainer() = LeafContainer(); // Clear contents of leaf
-        branch_arg->setChildPtr(buffer_selector_, child_idx, child_node);
-      }
-      else {
-        // depth has changed.. child in preceding buffer is a leaf node.
-        deleteBranchChild(*branch_arg, !buffer_selector_, child_idx);
-        child_leaf = createLeafChild(*branch_arg, child_idx);
-      }
-      leaf_count_++;
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename LeafContainerT,
+          typename BranchContainerT,
+          typename NodeAllocatorT>
+typename Octree2BufBase<LeafContainerT, BranchContainerT, NodeAllocatorT>::BranchNode*
+Octree2BufBase<LeafContainerT, BranchContainerT, NodeAllocatorT>::fetchBranchChild(
+    BranchNode& branch_arg, unsigned char child_idx_arg)
+{
+  // required branch node already exists - use it
+  if (branch_arg.hasChild(buffer_selector_, child_idx_arg))
+    return static_cast<BranchNode*>(
+        branch_arg.getChildPtr(buffer_selector_, child_idx_arg));
+
+  BranchNode* child_branch;
+  // check if we find a branch node reference in previous buffer
+  if (branch_arg.hasChild(!buffer_selector_, child_idx_arg)) {
+    OctreeNode* child_node = branch_arg.getChildPtr(!buffer_selector_, child_idx_arg);
+
+    if (child_node->getNodeType() == BRANCH_NODE) {
+      // take child branch from previous buffer and reset its pointer array
+      child_branch = static_cast<BranchNode*>(child_node);
+      branch_arg.setChildPtr(buffer_selector_, child_idx_arg, child_node);
+      for (unsigned char child_idx = 0; child_idx < 8; child_idx++)
+        child_branch->setChildPtr(buffer_selector_, child_idx, nullptr);
     }
     else {
-      // if required leaf does not exist -> create it
-      child_leaf = createLeafChild(*branch_arg, child_idx);
-      leaf_count_++;
+      // depth has changed.. child in preceding buffer is a leaf node.
+      deleteBranchChild(branch_arg, !buffer_selector_, child_idx_arg);
+      child_branch = createBranchChild(branch_arg, child_idx_arg);
     }
+  }
+  else {
+    // if required branch does not exist -> create it
+    child_branch = createBranchChild(branch_arg, child_idx_arg);
+  }
 
-    // return leaf node
-    return_leaf_arg = child_leaf;
-    parent_of_leaf_arg = branch_arg;
+  branch_count_++;
+  return child_branch;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename LeafContainerT,
+          typename BranchContainerT,
+          typename NodeAllocatorT>
+typename Octree2BufBase<LeafContainerT, BranchContainerT, NodeAllocatorT>::LeafNode*
+Octree2BufBase<LeafContainerT, BranchContainerT, NodeAllocatorT>::fetchLeafChild(
+    BranchNode& branch_arg, unsigned char child_idx_arg)
+{
+  // leaf node already exist
+  if (branch_arg.hasChild(buffer_selector_, child_idx_arg))
+    return static_cast<LeafNode*>(
+        branch_arg.getChildPtr(buffer_selector_, child_idx_arg));
+
+  LeafNode* child_leaf;
+  // check if we can take copy a reference from previous buffer
+  if (branch_arg.hasChild(!buffer_selector_, child_idx_arg)) {
+    OctreeNode* child_node = branch_arg.getChildPtr(!buffer_selector_, child_idx_arg);
+
+    if (child_node->getNodeType() == LEAF_NODE) {
+      child_leaf = static_cast<LeafNode*>(child_node);
+      child_leaf->getContainer() = LeafContainer(); // Clear contents of leaf
+      branch_arg.setChildPtr(buffer_selector_, child_idx_arg, child_node);
+    }
+    else {
+      // depth has changed.. child in preceding buffer is a branch node.
+      deleteBranchChild(branch_arg, !buffer_selector_, child_idx_arg);
+      child_leaf = createLeafChild(branch_arg, child_idx_arg);
+    }
   }
   else {
-    // leaf node already exist
-    return_leaf_arg =
-        static_cast<LeafNode*>(branch_arg->getChildPtr(buffer_selector_, child_idx));
-    parent_of_leaf_arg = branch_arg;
+    // if required leaf does not exist -> create it
+    child_leaf = createLeafChild(branch_arg, child_idx_arg);
   }
 
-  return depth_mask_arg;
+  leaf_count_++;
+  return child_leaf;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename LeafContainerT,
+          typename BranchContainerT,
+          typename NodeAllocatorT>
+void
+Octree2BufBase<LeafContainerT, BranchContainerT, NodeAllocatorT>::
+    deletePreviousBufferPath(const OctreeKey& key_arg)
+{
+  BranchNode* branch = root_node_;
+  for (uindex_t depth_mask = depth_mask_; depth_mask > 0; depth_mask >>= 1) {
+    const unsigned char child_idx = key_arg.getChildIdxWithDepthMask(depth_mask);
+
+    if (!branch->hasChild(buffer_selector_, child_idx)) {
+      // first node of the path that is unused in current buffer, delete its subtree
+      deleteBranchChild(*branch, !buffer_selector_, child_idx);
+      return;
+    }
+
+    OctreeNode* child_node = branch->getChildPtr(buffer_selector_, child_idx);
+    if (child_node->getNodeType() != BRANCH_NODE)
+      return;
+    branch = static_cast<BranchNode*>(child_node);
+  }
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////
-template <typename LeafContainerT, typename BranchContainerT>
+template <typename LeafContainerT,
+          typename BranchContainerT,
+          typename NodeAllocatorT>
 void
-Octree2BufBase<LeafContainerT, BranchContainerT>::findLeafRecursive(
-    const OctreeKey& key_arg,
-    uindex_t depth_mask_arg,
-    BranchNode* branch_arg,
-    LeafContainerT*& result_arg) const
+Octree2BufBase<LeafContainerT, BranchContainerT, NodeAllocatorT>::
+    findLeafRecursive(const OctreeKey& key_arg,
+                      uindex_t depth_mask_arg,
+                      BranchNode* branch_arg,
+                      LeafContainerT*& result_arg) const
 {
   // return leaf node
   unsigned char child_idx;
@@ -499,9 +601,11 @@ Octree2BufBase<LeafContainerT, BranchContainerT>::findLeafRecursive(
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////
-template <typename LeafContainerT, typename BranchContainerT>
+template <typename LeafContainerT,
+          typename BranchContainerT,
+          typename NodeAllocatorT>
 bool
-Octree2BufBase<LeafContainerT, BranchContainerT>::deleteLeafRecursive(
+Octree2BufBase<LeafContainerT, BranchContainerT, NodeAllocatorT>::deleteLeafRecursive(
     const OctreeKey& key_arg, uindex_t depth_mask_arg, BranchNode* branch_arg)
 {
   // index to branch child
@@ -551,15 +655,18 @@ Octree2BufBase<LeafContainerT, BranchContainerT>::deleteLeafRecursive(
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////
-template <typename LeafContainerT, typename BranchContainerT>
+template <typename LeafContainerT,
+          typename BranchContainerT,
+          typename NodeAllocatorT>
 void
-Octree2BufBase<LeafContainerT, BranchContainerT>::serializeTreeRecursive(
-    BranchNode* branch_arg,
-    OctreeKey& key_arg,
-    std::vector<char>* binary_tree_out_arg,
-    typename std::vector<LeafContainerT*>* leaf_container_vector_arg,
-    bool do_XOR_encoding_arg,
-    bool new_leafs_filter_arg)
+Octree2BufBase<LeafContainerT, BranchContainerT, NodeAllocatorT>::
+    serializeTreeRecursive(
+        BranchNode* branch_arg,
+        OctreeKey& key_arg,
+        std::vector<char>* binary_tree_out_arg,
+        typename std::vector<LeafContainerT*>* leaf_container_vector_arg,
+        bool do_XOR_encoding_arg,
+        bool new_leafs_filter_arg)
 {
   if (binary_tree_out_arg) {
     // occupancy bit patterns of branch node  (current octree buffer)
@@ -636,18 +743,21 @@ Octree2BufBase<LeafContainerT, BranchContainerT>::serializeTreeRecursive(
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////
-template <typename LeafContainerT, typename BranchContainerT>
+template <typename LeafContainerT,
+          typename BranchContainerT,
+          typename NodeAllocatorT>
 void
-Octree2BufBase<LeafContainerT, BranchContainerT>::deserializeTreeRecursive(
-    BranchNode* branch_arg,
-    uindex_t depth_mask_arg,
-    OctreeKey& key_arg,
-    typename std::vector<char>::const_iterator& binaryTreeIT_arg,
-    typename std::vector<char>::const_iterator& binaryTreeIT_End_arg,
-    typename std::vector<LeafContainerT*>::const_iterator* dataVectorIterator_arg,
-    typename std::vector<LeafContainerT*>::const_iterator* dataVectorEndIterator_arg,
-    bool branch_reset_arg,
-    bool do_XOR_decoding_arg)
+Octree2BufBase<LeafContainerT, BranchContainerT, NodeAllocatorT>::
+    deserializeTreeRecursive(
+        BranchNode* branch_arg,
+        uindex_t depth_mask_arg,
+        OctreeKey& key_arg,
+        typename std::vector<char>::const_iterator& binaryTreeIT_arg,
+        typename std::vector<char>::const_iterator& binaryTreeIT_End_arg,
+        typename std::vector<LeafContainerT*>::const_iterator* dataVectorIterator_arg,
+        typename std::vector<LeafContainerT*>::const_iterator* dataVectorEndIterator_arg,
+        bool branch_reset_arg,
+        bool do_XOR_decoding_arg)
 {
 
   // branch reset -> this branch has been taken from previous buffer
@@ -784,10 +894,12 @@ Octree2BufBase<LeafContainerT, BranchContainerT>::deserializeTreeRecursive(
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////
-template <typename LeafContainerT, typename BranchContainerT>
+template <typename LeafContainerT,
+          typename BranchContainerT,
+          typename NodeAllocatorT>
 void
-Octree2BufBase<LeafContainerT, BranchContainerT>::treeCleanUpRecursive(
-    BranchNode* branch_arg)
+Octree2BufBase<LeafContainerT, BranchContainerT, NodeAllocatorT>::
+    treeCleanUpRecursive(BranchNode* branch_arg)
 {
   // occupancy bit pattern of branch node  (previous octree buffer)
   char occupied_children_bit_pattern_prev_buffer =
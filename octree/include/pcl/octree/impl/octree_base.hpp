@@ -39,35 +39,43 @@
 #ifndef PCL_OCTREE_BASE_HPP
 #define PCL_OCTREE_BASE_HPP
 
+#include <algorithm>
+#include <utility>
 #include <vector>
 
 namespace pcl {
 namespace octree {
 //////////////////////////////////////////////////////////////////////////////////////////////
-template <typename LeafContainerT, typename BranchContainerT>
-OctreeBase<LeafContainerT, BranchContainerT>::OctreeBase()
+template <typename LeafContainerT,
+          typename BranchContainerT,
+          typename NodeAllocatorT>
+OctreeBase<LeafContainerT, BranchContainerT, NodeAllocatorT>::OctreeBase()
 : leaf_count_(0)
 , branch_count_(1)
-, root_node_(new BranchNode())
+, root_node_(allocateBranchNode())
 , depth_mask_(0)
 , octree_depth_(0)
 , dynamic_depth_enabled_(false)
 {}
 
 //////////////////////////////////////////////////////////////////////////////////////////////
-template <typename LeafContainerT, typename BranchContainerT>
-OctreeBase<LeafContainerT, BranchContainerT>::~OctreeBase()
+template <typename LeafContainerT,
+          typename BranchContainerT,
+          typename NodeAllocatorT>
+OctreeBase<LeafContainerT, BranchContainerT, NodeAllocatorT>::~OctreeBase()
 {
   // deallocate tree structure
   deleteTree();
-  delete (root_node_);
+  node_allocator_.deallocate(root_node_);
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////
-template <typename LeafContainerT, typename BranchContainerT>
+template <typename LeafContainerT,
+          typename BranchContainerT,
+          typename NodeAllocatorT>
 void
-OctreeBase<LeafContainerT, BranchContainerT>::setMaxVoxelIndex(
-    uindex_t max_voxel_index_arg)
+OctreeBase<LeafContainerT, BranchContainerT, NodeAllocatorT>::
+    setMaxVoxelIndex(uindex_t max_voxel_index_arg)
 {
   uindex_t tree_depth;
 
@@ -83,9 +91,12 @@ OctreeBase<LeafContainerT, BranchContainerT>::setMaxVoxelIndex(
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////
-template <typename LeafContainerT, typename BranchContainerT>
+template <typename LeafContainerT,
+          typename BranchContainerT,
+          typename NodeAllocatorT>
 void
-OctreeBase<LeafContainerT, BranchContainerT>::setTreeDepth(uindex_t depth_arg)
+OctreeBase<LeafContainerT, BranchContainerT, NodeAllocatorT>::
+    setTreeDepth(uindex_t depth_arg)
 {
   assert(depth_arg > 0);
 
@@ -100,11 +111,12 @@ OctreeBase<LeafContainerT, BranchContainerT>::setTreeDepth(uindex_t depth_arg)
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////
-template <typename LeafContainerT, typename BranchContainerT>
+template <typename LeafContainerT,
+          typename BranchContainerT,
+          typename NodeAllocatorT>
 LeafContainerT*
-OctreeBase<LeafContainerT, BranchContainerT>::findLeaf(uindex_t idx_x_arg,
-                                                       uindex_t idx_y_arg,
-                                                       uindex_t idx_z_arg)
+OctreeBase<LeafContainerT, BranchContainerT, NodeAllocatorT>::
+    findLeaf(uindex_t idx_x_arg, uindex_t idx_y_arg, uindex_t idx_z_arg)
 {
   // generate key
   OctreeKey key(idx_x_arg, idx_y_arg, idx_z_arg);
@@ -114,11 +126,12 @@ OctreeBase<LeafContainerT, BranchContainerT>::findLeaf(uindex_t idx_x_arg,
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////
-template <typename LeafContainerT, typename BranchContainerT>
+template <typename LeafContainerT,
+          typename BranchContainerT,
+          typename NodeAllocatorT>
 LeafContainerT*
-OctreeBase<LeafContainerT, BranchContainerT>::createLeaf(uindex_t idx_x_arg,
-                                                         uindex_t idx_y_arg,
-                                                         uindex_t idx_z_arg)
+OctreeBase<LeafContainerT, BranchContainerT, NodeAllocatorT>::
+    createLeaf(uindex_t idx_x_arg, uindex_t idx_y_arg, uindex_t idx_z_arg)
 {
   // generate key
   OctreeKey key(idx_x_arg, idx_y_arg, idx_z_arg);
@@ -128,11 +141,12 @@ OctreeBase<LeafContainerT, BranchContainerT>::createLeaf(uindex_t idx_x_arg,
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////
-template <typename LeafContainerT, typename BranchContainerT>
+template <typename LeafContainerT,
+          typename BranchContainerT,
+          typename NodeAllocatorT>
 bool
-OctreeBase<LeafContainerT, BranchContainerT>::existLeaf(uindex_t idx_x_arg,
-                                                        uindex_t idx_y_arg,
-                                                        uindex_t idx_z_arg) const
+OctreeBase<LeafContainerT, BranchContainerT, NodeAllocatorT>::
+    existLeaf(uindex_t idx_x_arg, uindex_t idx_y_arg, uindex_t idx_z_arg) const
 {
   // generate key
   OctreeKey key(idx_x_arg, idx_y_arg, idx_z_arg);
@@ -142,11 +156,12 @@ OctreeBase<LeafContainerT, BranchContainerT>::existLeaf(uindex_t idx_x_arg,
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////
-template <typename LeafContainerT, typename BranchContainerT>
+template <typename LeafContainerT,
+          typename BranchContainerT,
+          typename NodeAllocatorT>
 void
-OctreeBase<LeafContainerT, BranchContainerT>::removeLeaf(uindex_t idx_x_arg,
-                                                         uindex_t idx_y_arg,
-                                                         uindex_t idx_z_arg)
+OctreeBase<LeafContainerT, BranchContainerT, NodeAllocatorT>::
+    removeLeaf(uindex_t idx_x_arg, uindex_t idx_y_arg, uindex_t idx_z_arg)
 {
   // generate key
   OctreeKey key(idx_x_arg, idx_y_arg, idx_z_arg);
@@ -156,9 +171,11 @@ OctreeBase<LeafContainerT, BranchContainerT>::removeLeaf(uindex_t idx_x_arg,
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////
-template <typename LeafContainerT, typename BranchContainerT>
+template <typename LeafContainerT,
+          typename BranchContainerT,
+          typename NodeAllocatorT>
 void
-OctreeBase<LeafContainerT, BranchContainerT>::deleteTree()
+OctreeBase<LeafContainerT, BranchContainerT, NodeAllocatorT>::deleteTree()
 {
 
   if (root_node_) {
@@ -170,10 +187,106 @@ OctreeBase<LeafContainerT, BranchContainerT>::deleteTree()
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////
-template <typename LeafContainerT, typename BranchContainerT>
+template <typename LeafContainerT,
+          typename BranchContainerT,
+          typename NodeAllocatorT>
+std::size_t
+OctreeBase<LeafContainerT, BranchContainerT, NodeAllocatorT>::getMemoryUsage() const
+{
+  // nodes allocated by an arena are accounted for by the size of its blocks
+  std::size_t bytes = std::max(branch_count_ * sizeof(BranchNode) +
+                                   leaf_count_ * sizeof(LeafNode),
+                               node_allocator_.getReservedBytes());
+
+  std::vector<const BranchNode*> branches;
+  branches.push_back(root_node_);
+  while (!branches.empty()) {
+    const BranchNode* branch = branches.back();
+    branches.pop_back();
+    bytes += getContainerMemoryUsage(branch->getContainer());
+
+    for (unsigned char child_idx = 0; child_idx < 8; ++child_idx) {
+      const OctreeNode* child = branch->getChildPtr(child_idx);
+      if (!child)
+        continue;
+
+      if (child->getNodeType() == BRANCH_NODE)
+        branches.push_back(static_cast<const BranchNode*>(child));
+      else
+        bytes += getContainerMemoryUsage(
+            static_cast<const LeafNode*>(child)->getContainer());
+    }
+  }
+
+  return (bytes);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename LeafContainerT,
+          typename BranchContainerT,
+          typename NodeAllocatorT>
+void
+OctreeBase<LeafContainerT, BranchContainerT, NodeAllocatorT>::compactNodes()
+{
+  NodeAllocatorT allocator;
+  BranchNode* new_root = copyTree(*root_node_, allocator);
+
+  // free all nodes of the old layout, deleteTree would reset the node counters
+  deleteBranch(*root_node_);
+  node_allocator_.deallocate(root_node_);
+
+  node_allocator_ = std::move(allocator);
+  root_node_ = new_root;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename LeafContainerT,
+          typename BranchContainerT,
+          typename NodeAllocatorT>
+typename OctreeBase<LeafContainerT, BranchContainerT, NodeAllocatorT>::BranchNode*
+OctreeBase<LeafContainerT, BranchContainerT, NodeAllocatorT>::copyTree(
+    const BranchNode& source_arg, NodeAllocatorT& allocator_arg) const
+{
+  BranchNode* root = allocator_arg.template allocate<BranchNode>();
+  root->getContainer() = source_arg.getContainer();
+
+  // queue of (source, copy) branch pairs, processed level by level
+  std::vector<std::pair<const BranchNode*, BranchNode*>> branches;
+  branches.emplace_back(&source_arg, root);
+
+  for (std::size_t i = 0; i < branches.size(); ++i) {
+    const BranchNode& source = *branches[i].first;
+    BranchNode& target = *branches[i].second;
+
+    for (unsigned char child_idx = 0; child_idx < 8; ++child_idx) {
+      const OctreeNode* child = source.getChildPtr(child_idx);
+      if (!child)
+        continue;
+
+      if (child->getNodeType() == BRANCH_NODE) {
+        const auto* source_branch = static_cast<const BranchNode*>(child);
+        BranchNode* branch = allocator_arg.template allocate<BranchNode>();
+        branch->getContainer() = source_branch->getContainer();
+        target[child_idx] = branch;
+        branches.emplace_back(source_branch, branch);
+      }
+      else {
+        target[child_idx] = allocator_arg.template allocate<LeafNode>(
+            *static_cast<const LeafNode*>(child));
+      }
+    }
+  }
+
+  return (root);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename LeafContainerT,
+          typename BranchContainerT,
+          typename NodeAllocatorT>
 void
-OctreeBase<LeafContainerT, BranchContainerT>::serializeTree(
-    std::vector<char>& binary_tree_out_arg)
+OctreeBase<LeafContainerT, BranchContainerT, NodeAllocatorT>::
+    serializeTree(std::vector<char>& binary_tree_out_arg)
 {
 
   OctreeKey new_key;
@@ -186,11 +299,13 @@ OctreeBase<LeafContainerT, BranchContainerT>::serializeTree(
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////
-template <typename LeafContainerT, typename BranchContainerT>
+template <typename LeafContainerT,
+          typename BranchContainerT,
+          typename NodeAllocatorT>
 void
-OctreeBase<LeafContainerT, BranchContainerT>::serializeTree(
-    std::vector<char>& binary_tree_out_arg,
-    std::vector<LeafContainerT*>& leaf_container_vector_arg)
+OctreeBase<LeafContainerT, BranchContainerT, NodeAllocatorT>::
+    serializeTree(std::vector<char>& binary_tree_out_arg,
+                  std::vector<LeafContainerT*>& leaf_container_vector_arg)
 {
 
   OctreeKey new_key;
@@ -207,10 +322,12 @@ OctreeBase<LeafContainerT, BranchContainerT>::serializeTree(
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////
-template <typename LeafContainerT, typename BranchContainerT>
+template <typename LeafContainerT,
+          typename BranchContainerT,
+          typename NodeAllocatorT>
 void
-OctreeBase<LeafContainerT, BranchContainerT>::serializeLeafs(
-    std::vector<LeafContainerT*>& leaf_container_vector_arg)
+OctreeBase<LeafContainerT, BranchContainerT, NodeAllocatorT>::
+    serializeLeafs(std::vector<LeafContainerT*>& leaf_container_vector_arg)
 {
   OctreeKey new_key;
 
@@ -223,10 +340,12 @@ OctreeBase<LeafContainerT, BranchContainerT>::serializeLeafs(
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////
-template <typename LeafContainerT, typename BranchContainerT>
+template <typename LeafContainerT,
+          typename BranchContainerT,
+          typename NodeAllocatorT>
 void
-OctreeBase<LeafContainerT, BranchContainerT>::deserializeTree(
-    std::vector<char>& binary_tree_out_arg)
+OctreeBase<LeafContainerT, BranchContainerT, NodeAllocatorT>::
+    deserializeTree(std::vector<char>& binary_tree_out_arg)
 {
   OctreeKey new_key;
 
@@ -247,11 +366,13 @@ OctreeBase<LeafContainerT, BranchContainerT>::deserializeTree(
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////
-template <typename LeafContainerT, typename BranchContainerT>
+template <typename LeafContainerT,
+          typename BranchContainerT,
+          typename NodeAllocatorT>
 void
-OctreeBase<LeafContainerT, BranchContainerT>::deserializeTree(
-    std::vector<char>& binary_tree_in_arg,
-    std::vector<LeafContainerT*>& leaf_container_vector_arg)
+OctreeBase<LeafContainerT, BranchContainerT, NodeAllocatorT>::
+    deserializeTree(std::vector<char>& binary_tree_in_arg,
+                    std::vector<LeafContainerT*>& leaf_container_vector_arg)
 {
   OctreeKey new_key;
 
@@ -280,14 +401,16 @@ OctreeBase<LeafContainerT, BranchContainerT>::deserializeTree(
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////
-template <typename LeafContainerT, typename BranchContainerT>
+template <typename LeafContainerT,
+          typename BranchContainerT,
+          typename NodeAllocatorT>
 uindex_t
-OctreeBase<LeafContainerT, BranchContainerT>::createLeafRecursive(
-    const OctreeKey& key_arg,
-    uindex_t depth_mask_arg,
-    BranchNode* branch_arg,
-    LeafNode*& return_leaf_arg,
-    BranchNode*& parent_of_leaf_arg)
+OctreeBase<LeafContainerT, BranchContainerT, NodeAllocatorT>::
+    createLeafRecursive(const OctreeKey& key_arg,
+                        uindex_t depth_mask_arg,
+                        BranchNode* branch_arg,
+                        LeafNode*& return_leaf_arg,
+                        BranchNode*& parent_of_leaf_arg)
 {
   // index to branch child
   unsigned char child_idx;
@@ -340,13 +463,15 @@ OctreeBase<LeafContainerT, BranchContainerT>::createLeafRecursive(
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////
-template <typename LeafContainerT, typename BranchContainerT>
+template <typename LeafContainerT,
+          typename BranchContainerT,
+          typename NodeAllocatorT>
 void
-OctreeBase<LeafContainerT, BranchContainerT>::findLeafRecursive(
-    const OctreeKey& key_arg,
-    uindex_t depth_mask_arg,
-    BranchNode* branch_arg,
-    LeafContainerT*& result_arg) const
+OctreeBase<LeafContainerT, BranchContainerT, NodeAllocatorT>::
+    findLeafRecursive(const OctreeKey& key_arg,
+                      uindex_t depth_mask_arg,
+                      BranchNode* branch_arg,
+                      LeafContainerT*& result_arg) const
 {
   // index to branch child
   unsigned char child_idx;
@@ -378,9 +503,11 @@ OctreeBase<LeafContainerT, BranchContainerT>::findLeafRecursive(
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////
-template <typename LeafContainerT, typename BranchContainerT>
+template <typename LeafContainerT,
+          typename BranchContainerT,
+          typename NodeAllocatorT>
 bool
-OctreeBase<LeafContainerT, BranchContainerT>::deleteLeafRecursive(
+OctreeBase<LeafContainerT, BranchContainerT, NodeAllocatorT>::deleteLeafRecursive(
     const OctreeKey& key_arg, uindex_t depth_mask_arg, BranchNode* branch_arg)
 {
   // index to branch child
@@ -430,13 +557,16 @@ OctreeBase<LeafContainerT, BranchContainerT>::deleteLeafRecursive(
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////
-template <typename LeafContainerT, typename BranchContainerT>
+template <typename LeafContainerT,
+          typename BranchContainerT,
+          typename NodeAllocatorT>
 void
-OctreeBase<LeafContainerT, BranchContainerT>::serializeTreeRecursive(
-    const BranchNode* branch_arg,
-    OctreeKey& key_arg,
-    std::vector<char>* binary_tree_out_arg,
-    typename std::vector<LeafContainerT*>* leaf_container_vector_arg) const
+OctreeBase<LeafContainerT, BranchContainerT, NodeAllocatorT>::
+    serializeTreeRecursive(
+        const BranchNode* branch_arg,
+        OctreeKey& key_arg,
+        std::vector<char>* binary_tree_out_arg,
+        typename std::vector<LeafContainerT*>* leaf_container_vector_arg) const
 {
   char node_bit_pattern;
 
@@ -487,17 +617,19 @@ OctreeBase<LeafContainerT, BranchContainerT>::serializeTreeRecursive(
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////
-template <typename LeafContainerT, typename BranchContainerT>
+template <typename LeafContainerT,
+          typename BranchContainerT,
+          typename NodeAllocatorT>
 void
-OctreeBase<LeafContainerT, BranchContainerT>::deserializeTreeRecursive(
-    BranchNode* branch_arg,
-    uindex_t depth_mask_arg,
-    OctreeKey& key_arg,
-    typename std::vector<char>::const_iterator& binary_tree_input_it_arg,
-    typename std::vector<char>::const_iterator& binary_tree_input_it_end_arg,
-    typename std::vector<LeafContainerT*>::const_iterator* leaf_container_vector_it_arg,
-    typename std::vector<LeafContainerT*>::const_iterator*
-        leaf_container_vector_it_end_arg)
+OctreeBase<LeafContainerT, BranchContainerT, NodeAllocatorT>::
+    deserializeTreeRecursive(
+        BranchNode* branch_arg,
+        uindex_t depth_mask_arg,
+        OctreeKey& key_arg,
+        typename std::vector<char>::const_iterator& binary_tree_input_it_arg,
+        typename std::vector<char>::const_iterator& binary_tree_input_it_end_arg,
+        typename std::vector<LeafContainerT*>::const_iterator* leaf_container_vector_it_arg,
+        typename std::vector<LeafContainerT*>::const_iterator* leaf_container_vector_it_end_arg)
 {
 
   if (binary_tree_input_it_arg != binary_tree_input_it_end_arg) {
@@ -39,11 +39,78 @@
 #pragma once
 
 #include <pcl/common/common.h>
+#include <pcl/common/execution_context.h>
 #include <pcl/common/point_tests.h> // for pcl::isFinite
 #include <pcl/octree/impl/octree_base.hpp>
 #include <pcl/types.h>
 
+#include <algorithm>
 #include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace pcl {
+namespace octree {
+namespace detail {
+/** \brief Stable parallel LSD radix sort of (key, value) pairs on the lowest \a nr_bits
+ * bits of the key. */
+template <typename Entry>
+void
+radixSortByKey(std::vector<Entry>& entries, unsigned int nr_bits, unsigned int nr_threads)
+{
+  constexpr std::size_t nr_buckets = 256;
+  std::size_t nr_entries = entries.size();
+  std::vector<Entry> buffer(nr_entries);
+  std::vector<std::size_t> offsets(nr_threads * nr_buckets);
+
+  for (unsigned int shift = 0; shift < nr_bits; shift += 8) {
+    std::fill(offsets.begin(), offsets.end(), 0);
+#pragma omp parallel default(none) shared(buffer, entries, nr_entries, offsets, shift)           \
+    num_threads(nr_threads)
+    {
+#ifdef _OPENMP
+      const std::size_t thread_id = omp_get_thread_num();
+      const std::size_t nr_chunks = omp_get_num_threads();
+#else
+      const std::size_t thread_id = 0;
+      const std::size_t nr_chunks = 1;
+#endif
+      const std::size_t begin = thread_id * nr_entries / nr_chunks;
+      const std::size_t end = (thread_id + 1) * nr_entries / nr_chunks;
+      std::size_t* histogram = &offsets[thread_id * nr_buckets];
+      for (std::size_t i = begin; i < end; ++i)
+        ++histogram[(entries[i].first >> shift) & (nr_buckets - 1)];
+
+#pragma omp barrier
+#pragma omp single
+      {
+        // Bucket major, then chunk order, which keeps the sort stable
+        std::size_t offset = 0;
+        for (std::size_t bucket = 0; bucket < nr_buckets; ++bucket)
+          for (std::size_t chunk = 0; chunk < nr_chunks; ++chunk) {
+            const std::size_t count = offsets[chunk * nr_buckets + bucket];
+            offsets[chunk * nr_buckets + bucket] = offset;
+            offset += count;
+          }
+      }
+
+      for (std::size_t i = begin; i < end; ++i)
+        buffer[histogram[(entries[i].first >> shift) & (nr_buckets - 1)]++] =
+            entries[i];
+    }
+    entries.swap(buffer);
+  }
+}
+} // namespace detail
+} // namespace octree
+} // namespace pcl
 
 //////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointT,
@@ -65,10 +132,24 @@ pcl::octree::OctreePointCloud<PointT, LeafContainerT, BranchContainerT, OctreeT>
 , max_z_(resolution)
 , bounding_box_defined_(false)
 , max_objs_per_leaf_(0)
+, threads_(1)
 {
   assert(resolution > 0.0f);
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT,
+          typename LeafContainerT,
+          typename BranchContainerT,
+          typename OctreeT>
+void
+pcl::octree::OctreePointCloud<PointT, LeafContainerT, BranchContainerT, OctreeT>::
+    setNumberOfThreads(unsigned int nr_threads)
+{
+  // 0 is resolved against the budget of pcl::ExecutionContext at compute time
+  threads_ = nr_threads;
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointT,
           typename LeafContainerT,
@@ -77,6 +158,27 @@ template <typename PointT,
 void
 pcl::octree::OctreePointCloud<PointT, LeafContainerT, BranchContainerT, OctreeT>::
     addPointsFromInputCloud()
+{
+  // The bulk build only knows how to fill an empty single buffer octree of fixed depth
+  if (threads_ != 1 && this->leaf_count_ == 0 && !this->dynamic_depth_enabled_ &&
+      std::is_same<OctreeT,
+                   OctreeBase<LeafContainerT,
+                              BranchContainerT,
+                              typename OctreeT::NodeAllocator>>::value) {
+    if (addPointsFromInputCloudBulk())
+      return;
+  }
+  addPointsFromInputCloudSequential();
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT,
+          typename LeafContainerT,
+          typename BranchContainerT,
+          typename OctreeT>
+void
+pcl::octree::OctreePointCloud<PointT, LeafContainerT, BranchContainerT, OctreeT>::
+    addPointsFromInputCloudSequential()
 {
   if (indices_) {
     for (const auto& index : *indices_) {
@@ -98,6 +200,145 @@ pcl::octree::OctreePointCloud<PointT, LeafContainerT, BranchContainerT, OctreeT>
   }
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT,
+          typename LeafContainerT,
+          typename BranchContainerT,
+          typename OctreeT>
+bool
+pcl::octree::OctreePointCloud<PointT, LeafContainerT, BranchContainerT, OctreeT>::
+    addPointsFromInputCloudBulk()
+{
+  const pcl::ThreadReservation reservation(threads_);
+  const unsigned int threads = reservation.getNumberOfThreads();
+  // Valid points, in the order in which the sequential path inserts them
+  Indices points;
+  if (indices_) {
+    points.reserve(indices_->size());
+    for (const auto& index : *indices_) {
+      assert((index >= 0) && (static_cast<std::size_t>(index) < input_->size()));
+      if (isFinite((*input_)[index]))
+        points.push_back(index);
+    }
+  }
+  else {
+    points.reserve(input_->size());
+    for (index_t i = 0; i < static_cast<index_t>(input_->size()); i++)
+      if (isFinite((*input_)[i]))
+        points.push_back(i);
+  }
+
+  // Grow the bounding box exactly like the sequential path. This only adds empty root
+  // levels to the (empty) tree, which are dropped again afterwards. The sequential path
+  // computes each key against the bounding box at insertion time and shifts it whenever
+  // the box grows towards the lower bounds, so remember the box of every growth step
+  // to generate bit identical keys.
+  struct BoxEpoch {
+    std::size_t begin;
+    double min_x, min_y, min_z;
+    std::int64_t offset_x, offset_y, offset_z;
+  };
+  std::vector<BoxEpoch> epochs;
+  for (std::size_t i = 0; i < points.size(); ++i) {
+    const uindex_t prev_depth = this->octree_depth_;
+    const bool was_defined = bounding_box_defined_;
+    const double prev_min_x = min_x_, prev_min_y = min_y_, prev_min_z = min_z_;
+    adoptBoundingBoxToPoint((*input_)[points[i]]);
+    if (!was_defined)
+      epochs.push_back({i, min_x_, min_y_, min_z_, 0, 0, 0});
+    else if (this->octree_depth_ != prev_depth) {
+      const BoxEpoch& prev = epochs.back();
+      epochs.push_back({i,
+                        min_x_,
+                        min_y_,
+                        min_z_,
+                        prev.offset_x + std::llround((prev_min_x - min_x_) / resolution_),
+                        prev.offset_y + std::llround((prev_min_y - min_y_) / resolution_),
+                        prev.offset_z + std::llround((prev_min_z - min_z_) / resolution_)});
+    }
+  }
+  OctreeT::deleteTree();
+
+  uindex_t depth = this->octree_depth_;
+  if (points.empty())
+    return (true);
+  if (3 * depth > 64)
+    return (false);
+
+  // Compute the Morton code of every voxel key, with the root level in the highest bits
+  std::vector<std::pair<std::uint64_t, index_t>> entries(points.size());
+#pragma omp parallel for default(none) shared(depth, entries, epochs, points)          \
+    num_threads(threads)
+  for (std::ptrdiff_t i = 0; i < static_cast<std::ptrdiff_t>(points.size()); ++i) {
+    const auto epoch = std::prev(std::upper_bound(
+        epochs.begin(),
+        epochs.end(),
+        static_cast<std::size_t>(i),
+        [](std::size_t idx, const BoxEpoch& e) { return idx < e.begin; }));
+    const BoxEpoch& last = epochs.back();
+    const PointT& point = (*input_)[points[i]];
+    OctreeKey key;
+    key.x = static_cast<uindex_t>((point.x - epoch->min_x) / resolution_) +
+            static_cast<uindex_t>(last.offset_x - epoch->offset_x);
+    key.y = static_cast<uindex_t>((point.y - epoch->min_y) / resolution_) +
+            static_cast<uindex_t>(last.offset_y - epoch->offset_y);
+    key.z = static_cast<uindex_t>((point.z - epoch->min_z) / resolution_) +
+            static_cast<uindex_t>(last.offset_z - epoch->offset_z);
+    std::uint64_t code = 0;
+    for (uindex_t depth_mask = 1u << (depth - 1); depth_mask; depth_mask >>= 1)
+      code = (code << 3) | key.getChildIdxWithDepthMask(depth_mask);
+    entries[i] = std::make_pair(code, points[i]);
+  }
+
+  // Stable, so the points of a voxel keep their insertion order
+  detail::radixSortByKey(entries, 3 * depth, threads);
+
+  // Create the voxels in Morton order, reusing the branches shared with the previous one
+  std::vector<BranchNode*> path(depth);
+  path[0] = this->root_node_;
+  std::vector<LeafNode*> leaves;
+  std::vector<std::size_t> leaf_offsets;
+  for (std::size_t begin = 0; begin < entries.size();) {
+    const std::uint64_t code = entries[begin].first;
+    std::size_t end = begin + 1;
+    while (end < entries.size() && entries[end].first == code)
+      ++end;
+
+    uindex_t level = 0;
+    if (begin > 0) {
+      // The first level at which the path differs from the one of the previous voxel
+      const std::uint64_t diff = code ^ entries[begin - 1].first;
+      int highest_bit = 63;
+      while (!((diff >> highest_bit) & 1))
+        --highest_bit;
+      level = depth - 1 - highest_bit / 3;
+    }
+    for (; level + 1 < depth; ++level) {
+      const auto child_idx =
+          static_cast<unsigned char>((code >> (3 * (depth - 1 - level))) & 7);
+      path[level + 1] = this->createBranchChild(*path[level], child_idx);
+      this->branch_count_++;
+    }
+    leaves.push_back(this->createLeafChild(*path[depth - 1],
+                                           static_cast<unsigned char>(code & 7)));
+    this->leaf_count_++;
+    leaf_offsets.push_back(begin);
+    begin = end;
+  }
+  leaf_offsets.push_back(entries.size());
+
+  // Leaves are independent, so they can be filled concurrently
+#pragma omp parallel for default(none) shared(entries, leaf_offsets, leaves)           \
+    num_threads(threads) schedule(dynamic, 256)
+  for (std::ptrdiff_t leaf_idx = 0; leaf_idx < static_cast<std::ptrdiff_t>(leaves.size());
+       ++leaf_idx) {
+    LeafContainerT& container = leaves[leaf_idx]->getContainer();
+    for (std::size_t i = leaf_offsets[leaf_idx]; i < leaf_offsets[leaf_idx + 1]; ++i)
+      addPointIdxToLeaf(container, entries[i].second);
+  }
+  return (true);
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointT,
           typename LeafContainerT,
@@ -542,7 +783,7 @@ pcl::octree::OctreePointCloud<PointT, LeafContainerT, BranchContainerT, OctreeT>
 
         BranchNode* newRootBranch;
 
-        newRootBranch = new BranchNode();
+        newRootBranch = this->allocateBranchNode();
         this->branch_count_++;
 
         this->setBranchChildPtr(*newRootBranch, child_idx, this->root_node_);
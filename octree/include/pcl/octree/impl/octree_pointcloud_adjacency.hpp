@@ -37,6 +37,7 @@
 
 #pragma once
 
+#include <pcl/common/execution_context.h>
 #include <pcl/common/point_tests.h> // for pcl::isFinite
 #include <pcl/console/print.h>
 
@@ -65,7 +66,8 @@ void
 pcl::octree::OctreePointCloudAdjacency<PointT, LeafContainerT, BranchContainerT>::
     addPointsFromInputCloud()
 {
-  // double t1,t2;
+  const pcl::ThreadReservation reservation(this->threads_);
+  const unsigned int threads = reservation.getNumberOfThreads();
   float minX = std::numeric_limits<float>::max(),
         minY = std::numeric_limits<float>::max(),
         minZ = std::numeric_limits<float>::max();
@@ -73,7 +75,9 @@ pcl::octree::OctreePointCloudAdjacency<PointT, LeafContainerT, BranchContainerT>
         maxY = -std::numeric_limits<float>::max(),
         maxZ = -std::numeric_limits<float>::max();
 
-  for (std::size_t i = 0; i < input_->size(); ++i) {
+#pragma omp parallel for default(none) reduction(min : minX, minY, minZ)               \
+    reduction(max : maxX, maxY, maxZ) num_threads(threads)
+  for (std::ptrdiff_t i = 0; i < static_cast<std::ptrdiff_t>(input_->size()); ++i) {
     PointT temp((*input_)[i]);
     if (transform_func_) // Search for point with
       transform_func_(temp);
@@ -95,20 +99,32 @@ pcl::octree::OctreePointCloudAdjacency<PointT, LeafContainerT, BranchContainerT>
   }
   this->defineBoundingBox(minX, minY, minZ, maxX, maxY, maxZ);
 
-  OctreePointCloud<PointT, LeafContainerT, BranchContainerT>::addPointsFromInputCloud();
+  // Keys are generated by this class, so the points are always inserted one at a time
+  OctreePointCloud<PointT, LeafContainerT, BranchContainerT>::
+      addPointsFromInputCloudSequential();
 
+  leaf_vector_.clear();
   leaf_vector_.reserve(this->getLeafCount());
+  std::vector<OctreeKey> leaf_keys;
+  leaf_keys.reserve(this->getLeafCount());
+  LeafKeyMapT leaf_map(this->getLeafCount());
   for (auto leaf_itr = this->leaf_depth_begin(); leaf_itr != this->leaf_depth_end();
        ++leaf_itr) {
-    OctreeKey leaf_key = leaf_itr.getCurrentOctreeKey();
     LeafContainerT* leaf_container = &(leaf_itr.getLeafContainer());
+    leaf_keys.push_back(leaf_itr.getCurrentOctreeKey());
+    leaf_map.emplace(leaf_keys.back(), leaf_container);
+    leaf_vector_.push_back(leaf_container);
+  }
 
+  // Every leaf only writes to its own container
+#pragma omp parallel for default(none) shared(leaf_keys, leaf_map)                     \
+    num_threads(threads) schedule(dynamic, 256)
+  for (std::ptrdiff_t i = 0; i < static_cast<std::ptrdiff_t>(leaf_vector_.size());
+       ++i) {
     // Run the leaf's compute function
-    leaf_container->computeData();
-
-    computeNeighbors(leaf_key, leaf_container);
+    leaf_vector_[i]->computeData();
 
-    leaf_vector_.push_back(leaf_container);
+    computeNeighbors(leaf_keys[i], leaf_vector_[i], leaf_map);
   }
   // Make sure our leaf vector is correctly sized
   assert(leaf_vector_.size() == this->getLeafCount());
@@ -201,6 +217,38 @@ pcl::octree::OctreePointCloudAdjacency<PointT, LeafContainerT, BranchContainerT>
   }
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT, typename LeafContainerT, typename BranchContainerT>
+void
+pcl::octree::OctreePointCloudAdjacency<PointT, LeafContainerT, BranchContainerT>::
+    computeNeighbors(const OctreeKey& key_arg,
+                     LeafContainerT* leaf_container,
+                     const LeafKeyMapT& leaf_map) const
+{
+  // Same visiting order as the tree based version, so the neighbors are identical
+  OctreeKey neighbor_key;
+  const int dx_min = (key_arg.x > 0) ? -1 : 0;
+  const int dy_min = (key_arg.y > 0) ? -1 : 0;
+  const int dz_min = (key_arg.z > 0) ? -1 : 0;
+  const int dx_max = (key_arg.x == this->max_key_.x) ? 0 : 1;
+  const int dy_max = (key_arg.y == this->max_key_.y) ? 0 : 1;
+  const int dz_max = (key_arg.z == this->max_key_.z) ? 0 : 1;
+
+  for (int dx = dx_min; dx <= dx_max; ++dx) {
+    for (int dy = dy_min; dy <= dy_max; ++dy) {
+      for (int dz = dz_min; dz <= dz_max; ++dz) {
+        neighbor_key.x = static_cast<std::uint32_t>(key_arg.x + dx);
+        neighbor_key.y = static_cast<std::uint32_t>(key_arg.y + dy);
+        neighbor_key.z = static_cast<std::uint32_t>(key_arg.z + dz);
+        const auto neighbor = leaf_map.find(neighbor_key);
+        if (neighbor != leaf_map.end()) {
+          leaf_container->addNeighbor(neighbor->second);
+        }
+      }
+    }
+  }
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointT, typename LeafContainerT, typename BranchContainerT>
 LeafContainerT*
@@ -226,8 +274,11 @@ pcl::octree::OctreePointCloudAdjacency<PointT, LeafContainerT, BranchContainerT>
   // TODO Change this to use leaf centers, not centroids!
 
   voxel_adjacency_graph.clear();
-  // Add a vertex for each voxel, store ids in map
-  std::map<LeafContainerT*, VoxelID> leaf_vertex_id_map;
+  // Add a vertex for each voxel, in the order of leaf_vector_
+  std::vector<VoxelID> vertex_ids;
+  vertex_ids.reserve(leaf_vector_.size());
+  std::unordered_map<const LeafContainerT*, std::size_t> leaf_index_map(
+      leaf_vector_.size());
   for (typename OctreeAdjacencyT::LeafNodeDepthFirstIterator leaf_itr =
            this->leaf_depth_begin();
        leaf_itr != this->leaf_depth_end();
@@ -238,24 +289,24 @@ pcl::octree::OctreePointCloudAdjacency<PointT, LeafContainerT, BranchContainerT>
     VoxelID node_id = add_vertex(voxel_adjacency_graph);
 
     voxel_adjacency_graph[node_id] = centroid_point;
-    LeafContainerT* leaf_container = &(leaf_itr.getLeafContainer());
-    leaf_vertex_id_map[leaf_container] = node_id;
+    leaf_index_map.emplace(&(leaf_itr.getLeafContainer()), vertex_ids.size());
+    vertex_ids.push_back(node_id);
   }
 
-  // Iterate through and add edges to adjacency graph
-  for (typename std::vector<LeafContainerT*>::iterator leaf_itr = leaf_vector_.begin();
-       leaf_itr != leaf_vector_.end();
-       ++leaf_itr) {
-    VoxelID u = (leaf_vertex_id_map.find(*leaf_itr))->second;
+  // Iterate through the neighbor arrays and add edges to adjacency graph
+  for (const LeafContainerT* leaf_container : leaf_vector_) {
+    VoxelID u = vertex_ids[leaf_index_map.find(leaf_container)->second];
     PointT p_u = voxel_adjacency_graph[u];
-    for (auto neighbor_itr = (*leaf_itr)->cbegin(), neighbor_end = (*leaf_itr)->cend();
+    for (auto neighbor_itr = leaf_container->cbegin(),
+              neighbor_end = leaf_container->cend();
          neighbor_itr != neighbor_end;
          ++neighbor_itr) {
-      LeafContainerT* neighbor_container = *neighbor_itr;
       EdgeID edge;
       bool edge_added;
-      VoxelID v = (leaf_vertex_id_map.find(neighbor_container))->second;
+      VoxelID v = vertex_ids[leaf_index_map.find(*neighbor_itr)->second];
       boost::tie(edge, edge_added) = add_edge(u, v, voxel_adjacency_graph);
+      if (!edge_added)
+        continue;
 
       PointT p_v = voxel_adjacency_graph[v];
       float dist = (p_v.getVector3fMap() - p_u.getVector3fMap()).norm();
@@ -0,0 +1,190 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2010-2011, Willow Garage, Inc.
+ *  Copyright (c) 2012-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef PCL_OCTREE_CHANGEDETECTOR_HPP
+#define PCL_OCTREE_CHANGEDETECTOR_HPP
+
+/*
+ * OctreePointCloudChangeDetector is not precompiled, see the note in
+ * octree_pointcloud_voxelcentroid.hpp. The streaming path needs the bulk helpers of
+ * octree_pointcloud.hpp and the node helpers of octree2buf_base.hpp.
+ */
+#include <pcl/common/execution_context.h>
+#include <pcl/common/point_tests.h> // for pcl::isFinite
+#include <pcl/octree/impl/octree2buf_base.hpp>
+#include <pcl/octree/impl/octree_pointcloud.hpp>
+
+#include <cassert>
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT, typename LeafContainerT, typename BranchContainerT>
+bool
+pcl::octree::OctreePointCloudChangeDetector<PointT, LeafContainerT, BranchContainerT>::
+    addFrameFromInputCloud()
+{
+  const uindex_t depth = this->octree_depth_;
+  if (!this->bounding_box_defined_ || 3 * depth > 64)
+    return (false);
+
+  const pcl::ThreadReservation reservation(this->threads_);
+  const unsigned int threads = reservation.getNumberOfThreads();
+
+  // Valid points within the bounding box, in the order in which the sequential path
+  // inserts them
+  Indices points;
+  if (this->indices_) {
+    points.reserve(this->indices_->size());
+    for (const auto& index : *this->indices_) {
+      assert((index >= 0) && (static_cast<std::size_t>(index) < this->input_->size()));
+      const PointT& point = (*this->input_)[index];
+      if (isFinite(point) && this->isPointWithinBoundingBox(point))
+        points.push_back(index);
+    }
+  }
+  else {
+    points.reserve(this->input_->size());
+    for (index_t i = 0; i < static_cast<index_t>(this->input_->size()); i++) {
+      const PointT& point = (*this->input_)[i];
+      if (isFinite(point) && this->isPointWithinBoundingBox(point))
+        points.push_back(i);
+    }
+  }
+
+  // Compute the Morton code of every voxel key, with the root level in the highest bits
+  entries_.resize(points.size());
+#pragma omp parallel for default(none) shared(points) num_threads(threads)
+  for (std::ptrdiff_t i = 0; i < static_cast<std::ptrdiff_t>(points.size()); ++i) {
+    OctreeKey key;
+    this->genOctreeKeyforPoint((*this->input_)[points[i]], key);
+    entries_[i] = std::make_pair(getMortonCode(key), points[i]);
+  }
+
+  // Stable, so the points of a voxel keep their insertion order
+  detail::radixSortByKey(entries_, 3 * depth, threads);
+
+  if (isFrameCurrent()) {
+    // Release the nodes of the voxels that vanished with the last frame. These are
+    // all the nodes the full clean up in switchBuffers would release.
+    for (const OctreeKey& key : vanished_voxel_keys_)
+      this->deletePreviousBufferPath(key);
+    this->tree_dirty_flag_ = false;
+  }
+  else {
+    // The octree was modified in another way, gather the voxels of the current buffer.
+    // The depth-first traversal visits them in ascending Morton order.
+    frame_codes_.clear();
+    for (auto it = this->leaf_depth_begin(), it_end = this->leaf_depth_end(); it != it_end;
+         ++it)
+      frame_codes_.push_back(getMortonCode(it.getCurrentOctreeKey()));
+  }
+
+  this->switchBuffers();
+
+  // Create the voxels in Morton order, reusing the branches shared with the previous
+  // voxel, and compare them to the sorted voxels of the previous frame
+  std::vector<std::uint64_t> codes;
+  codes.reserve(frame_codes_.size());
+  std::vector<BranchNode*> path(depth);
+  path[0] = this->root_node_;
+  std::vector<LeafNode*> leaves;
+  std::vector<std::size_t> leaf_offsets;
+  new_voxel_keys_.clear();
+  vanished_voxel_keys_.clear();
+  new_leaves_.clear();
+  auto previous = frame_codes_.cbegin();
+  for (std::size_t begin = 0; begin < entries_.size();) {
+    const std::uint64_t code = entries_[begin].first;
+    std::size_t end = begin + 1;
+    while (end < entries_.size() && entries_[end].first == code)
+      ++end;
+
+    uindex_t level = 0;
+    if (begin > 0) {
+      // The first level at which the path differs from the one of the previous voxel
+      const std::uint64_t diff = code ^ entries_[begin - 1].first;
+      int highest_bit = 63;
+      while (!((diff >> highest_bit) & 1))
+        --highest_bit;
+      level = depth - 1 - highest_bit / 3;
+    }
+    for (; level + 1 < depth; ++level) {
+      const auto child_idx =
+          static_cast<unsigned char>((code >> (3 * (depth - 1 - level))) & 7);
+      path[level + 1] = this->fetchBranchChild(*path[level], child_idx);
+    }
+    LeafNode* leaf =
+        this->fetchLeafChild(*path[depth - 1], static_cast<unsigned char>(code & 7));
+
+    for (; previous != frame_codes_.cend() && *previous < code; ++previous)
+      vanished_voxel_keys_.push_back(getKeyFromMortonCode(*previous));
+    if (previous != frame_codes_.cend() && *previous == code)
+      ++previous;
+    else {
+      new_voxel_keys_.push_back(getKeyFromMortonCode(code));
+      new_leaves_.push_back(leaf);
+    }
+
+    codes.push_back(code);
+    leaves.push_back(leaf);
+    leaf_offsets.push_back(begin);
+    begin = end;
+  }
+  leaf_offsets.push_back(entries_.size());
+  for (; previous != frame_codes_.cend(); ++previous)
+    vanished_voxel_keys_.push_back(getKeyFromMortonCode(*previous));
+
+  // Leaves are independent, so they can be filled concurrently
+#pragma omp parallel for default(none) shared(leaf_offsets, leaves)                    \
+    num_threads(threads) schedule(dynamic, 256)
+  for (std::ptrdiff_t leaf_idx = 0; leaf_idx < static_cast<std::ptrdiff_t>(leaves.size());
+       ++leaf_idx) {
+    LeafContainerT& container = leaves[leaf_idx]->getContainer();
+    for (std::size_t i = leaf_offsets[leaf_idx]; i < leaf_offsets[leaf_idx + 1]; ++i)
+      this->addPointIdxToLeaf(container, entries_[i].second);
+  }
+
+  frame_codes_.swap(codes);
+  frame_valid_ = true;
+  frame_buffer_ = this->buffer_selector_;
+  frame_depth_ = depth;
+  return (true);
+}
+
+#define PCL_INSTANTIATE_OctreePointCloudChangeDetector(T)                              \
+  template class PCL_EXPORTS pcl::octree::OctreePointCloudChangeDetector<T>;
+
+#endif
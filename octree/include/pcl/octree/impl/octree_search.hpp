@@ -39,16 +39,27 @@
 #ifndef PCL_OCTREE_SEARCH_IMPL_H_
 #define PCL_OCTREE_SEARCH_IMPL_H_
 
+#include <pcl/common/execution_context.h>
+#include <pcl/octree/impl/octree_snapshot.hpp>
+
+#include <algorithm>
 #include <cassert>
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 namespace pcl {
 
 namespace octree {
 
-template <typename PointT, typename LeafContainerT, typename BranchContainerT>
+template <typename PointT,
+          typename LeafContainerT,
+          typename BranchContainerT,
+          typename NodeAllocatorT>
 bool
-OctreePointCloudSearch<PointT, LeafContainerT, BranchContainerT>::voxelSearch(
-    const PointT& point, Indices& point_idx_data)
+OctreePointCloudSearch<PointT, LeafContainerT, BranchContainerT, NodeAllocatorT>::
+    voxelSearch(const PointT& point, Indices& point_idx_data)
 {
   assert(isFinite(point) &&
          "Invalid (NaN, Inf) point coordinates given to nearestKSearch!");
@@ -68,22 +79,28 @@ OctreePointCloudSearch<PointT, LeafContainerT, BranchContainerT>::voxelSearch(
   return (b_success);
 }
 
-template <typename PointT, typename LeafContainerT, typename BranchContainerT>
+template <typename PointT,
+          typename LeafContainerT,
+          typename BranchContainerT,
+          typename NodeAllocatorT>
 bool
-OctreePointCloudSearch<PointT, LeafContainerT, BranchContainerT>::voxelSearch(
-    const uindex_t index, Indices& point_idx_data)
+OctreePointCloudSearch<PointT, LeafContainerT, BranchContainerT, NodeAllocatorT>::
+    voxelSearch(const uindex_t index, Indices& point_idx_data)
 {
   const PointT search_point = this->getPointByIndex(index);
   return (this->voxelSearch(search_point, point_idx_data));
 }
 
-template <typename PointT, typename LeafContainerT, typename BranchContainerT>
+template <typename PointT,
+          typename LeafContainerT,
+          typename BranchContainerT,
+          typename NodeAllocatorT>
 uindex_t
-OctreePointCloudSearch<PointT, LeafContainerT, BranchContainerT>::nearestKSearch(
-    const PointT& p_q,
-    uindex_t k,
-    Indices& k_indices,
-    std::vector<float>& k_sqr_distances)
+OctreePointCloudSearch<PointT, LeafContainerT, BranchContainerT, NodeAllocatorT>::
+    nearestKSearch(const PointT& p_q,
+                   uindex_t k,
+                   Indices& k_indices,
+                   std::vector<float>& k_sqr_distances)
 {
   assert(this->leaf_count_ > 0);
   assert(isFinite(p_q) &&
@@ -120,19 +137,28 @@ OctreePointCloudSearch<PointT, LeafContainerT, BranchContainerT>::nearestKSearch
   return k_indices.size();
 }
 
-template <typename PointT, typename LeafContainerT, typename BranchContainerT>
+template <typename PointT,
+          typename LeafContainerT,
+          typename BranchContainerT,
+          typename NodeAllocatorT>
 uindex_t
-OctreePointCloudSearch<PointT, LeafContainerT, BranchContainerT>::nearestKSearch(
-    uindex_t index, uindex_t k, Indices& k_indices, std::vector<float>& k_sqr_distances)
+OctreePointCloudSearch<PointT, LeafContainerT, BranchContainerT, NodeAllocatorT>::
+    nearestKSearch(uindex_t index,
+                   uindex_t k,
+                   Indices& k_indices,
+                   std::vector<float>& k_sqr_distances)
 {
   const PointT search_point = this->getPointByIndex(index);
   return (nearestKSearch(search_point, k, k_indices, k_sqr_distances));
 }
 
-template <typename PointT, typename LeafContainerT, typename BranchContainerT>
+template <typename PointT,
+          typename LeafContainerT,
+          typename BranchContainerT,
+          typename NodeAllocatorT>
 void
-OctreePointCloudSearch<PointT, LeafContainerT, BranchContainerT>::approxNearestSearch(
-    const PointT& p_q, index_t& result_index, float& sqr_distance)
+OctreePointCloudSearch<PointT, LeafContainerT, BranchContainerT, NodeAllocatorT>::
+    approxNearestSearch(const PointT& p_q, index_t& result_index, float& sqr_distance)
 {
   assert(this->leaf_count_ > 0);
   assert(isFinite(p_q) &&
@@ -147,24 +173,32 @@ OctreePointCloudSearch<PointT, LeafContainerT, BranchContainerT>::approxNearestS
   return;
 }
 
-template <typename PointT, typename LeafContainerT, typename BranchContainerT>
+template <typename PointT,
+          typename LeafContainerT,
+          typename BranchContainerT,
+          typename NodeAllocatorT>
 void
-OctreePointCloudSearch<PointT, LeafContainerT, BranchContainerT>::approxNearestSearch(
-    uindex_t query_index, index_t& result_index, float& sqr_distance)
+OctreePointCloudSearch<PointT, LeafContainerT, BranchContainerT, NodeAllocatorT>::
+    approxNearestSearch(uindex_t query_index,
+                        index_t& result_index,
+                        float& sqr_distance)
 {
   const PointT search_point = this->getPointByIndex(query_index);
 
   return (approxNearestSearch(search_point, result_index, sqr_distance));
 }
 
-template <typename PointT, typename LeafContainerT, typename BranchContainerT>
+template <typename PointT,
+          typename LeafContainerT,
+          typename BranchContainerT,
+          typename NodeAllocatorT>
 uindex_t
-OctreePointCloudSearch<PointT, LeafContainerT, BranchContainerT>::radiusSearch(
-    const PointT& p_q,
-    const double radius,
-    Indices& k_indices,
-    std::vector<float>& k_sqr_distances,
-    uindex_t max_nn) const
+OctreePointCloudSearch<PointT, LeafContainerT, BranchContainerT, NodeAllocatorT>::
+    radiusSearch(const PointT& p_q,
+                 const double radius,
+                 Indices& k_indices,
+                 std::vector<float>& k_sqr_distances,
+                 uindex_t max_nn) const
 {
   assert(isFinite(p_q) &&
          "Invalid (NaN, Inf) point coordinates given to nearestKSearch!");
@@ -186,26 +220,32 @@ OctreePointCloudSearch<PointT, LeafContainerT, BranchContainerT>::radiusSearch(
   return k_indices.size();
 }
 
-template <typename PointT, typename LeafContainerT, typename BranchContainerT>
+template <typename PointT,
+          typename LeafContainerT,
+          typename BranchContainerT,
+          typename NodeAllocatorT>
 uindex_t
-OctreePointCloudSearch<PointT, LeafContainerT, BranchContainerT>::radiusSearch(
-    uindex_t index,
-    const double radius,
-    Indices& k_indices,
-    std::vector<float>& k_sqr_distances,
-    uindex_t max_nn) const
+OctreePointCloudSearch<PointT, LeafContainerT, BranchContainerT, NodeAllocatorT>::
+    radiusSearch(uindex_t index,
+                 const double radius,
+                 Indices& k_indices,
+                 std::vector<float>& k_sqr_distances,
+                 uindex_t max_nn) const
 {
   const PointT search_point = this->getPointByIndex(index);
 
   return (radiusSearch(search_point, radius, k_indices, k_sqr_distances, max_nn));
 }
 
-template <typename PointT, typename LeafContainerT, typename BranchContainerT>
+template <typename PointT,
+          typename LeafContainerT,
+          typename BranchContainerT,
+          typename NodeAllocatorT>
 uindex_t
-OctreePointCloudSearch<PointT, LeafContainerT, BranchContainerT>::boxSearch(
-    const Eigen::Vector3f& min_pt,
-    const Eigen::Vector3f& max_pt,
-    Indices& k_indices) const
+OctreePointCloudSearch<PointT, LeafContainerT, BranchContainerT, NodeAllocatorT>::
+    boxSearch(const Eigen::Vector3f& min_pt,
+              const Eigen::Vector3f& max_pt,
+              Indices& k_indices) const
 {
 
   OctreeKey key;
@@ -218,9 +258,12 @@ OctreePointCloudSearch<PointT, LeafContainerT, BranchContainerT>::boxSearch(
   return k_indices.size();
 }
 
-template <typename PointT, typename LeafContainerT, typename BranchContainerT>
+template <typename PointT,
+          typename LeafContainerT,
+          typename BranchContainerT,
+          typename NodeAllocatorT>
 double
-OctreePointCloudSearch<PointT, LeafContainerT, BranchContainerT>::
+OctreePointCloudSearch<PointT, LeafContainerT, BranchContainerT, NodeAllocatorT>::
     getKNearestNeighborRecursive(
         const PointT& point,
         uindex_t K,
@@ -330,9 +373,12 @@ OctreePointCloudSearch<PointT, LeafContainerT, BranchContainerT>::
   return (smallest_squared_dist);
 }
 
-template <typename PointT, typename LeafContainerT, typename BranchContainerT>
+template <typename PointT,
+          typename LeafContainerT,
+          typename BranchContainerT,
+          typename NodeAllocatorT>
 void
-OctreePointCloudSearch<PointT, LeafContainerT, BranchContainerT>::
+OctreePointCloudSearch<PointT, LeafContainerT, BranchContainerT, NodeAllocatorT>::
     getNeighborsWithinRadiusRecursive(const PointT& point,
                                       const double radiusSquared,
                                       const BranchNode* node,
@@ -417,9 +463,12 @@ OctreePointCloudSearch<PointT, LeafContainerT, BranchContainerT>::
   }
 }
 
-template <typename PointT, typename LeafContainerT, typename BranchContainerT>
+template <typename PointT,
+          typename LeafContainerT,
+          typename BranchContainerT,
+          typename NodeAllocatorT>
 void
-OctreePointCloudSearch<PointT, LeafContainerT, BranchContainerT>::
+OctreePointCloudSearch<PointT, LeafContainerT, BranchContainerT, NodeAllocatorT>::
     approxNearestSearchRecursive(const PointT& point,
                                  const BranchNode* node,
                                  const OctreeKey& key,
@@ -506,23 +555,29 @@ OctreePointCloudSearch<PointT, LeafContainerT, BranchContainerT>::
   }
 }
 
-template <typename PointT, typename LeafContainerT, typename BranchContainerT>
+template <typename PointT,
+          typename LeafContainerT,
+          typename BranchContainerT,
+          typename NodeAllocatorT>
 float
-OctreePointCloudSearch<PointT, LeafContainerT, BranchContainerT>::pointSquaredDist(
-    const PointT& point_a, const PointT& point_b) const
+OctreePointCloudSearch<PointT, LeafContainerT, BranchContainerT, NodeAllocatorT>::
+    pointSquaredDist(const PointT& point_a, const PointT& point_b) const
 {
   return (point_a.getVector3fMap() - point_b.getVector3fMap()).squaredNorm();
 }
 
-template <typename PointT, typename LeafContainerT, typename BranchContainerT>
+template <typename PointT,
+          typename LeafContainerT,
+          typename BranchContainerT,
+          typename NodeAllocatorT>
 void
-OctreePointCloudSearch<PointT, LeafContainerT, BranchContainerT>::boxSearchRecursive(
-    const Eigen::Vector3f& min_pt,
-    const Eigen::Vector3f& max_pt,
-    const BranchNode* node,
-    const OctreeKey& key,
-    uindex_t tree_depth,
-    Indices& k_indices) const
+OctreePointCloudSearch<PointT, LeafContainerT, BranchContainerT, NodeAllocatorT>::
+    boxSearchRecursive(const Eigen::Vector3f& min_pt,
+                       const Eigen::Vector3f& max_pt,
+                       const BranchNode* node,
+                       const OctreeKey& key,
+                       uindex_t tree_depth,
+                       Indices& k_indices) const
 {
   // iterate over all children
   for (unsigned char child_idx = 0; child_idx < 8; child_idx++) {
@@ -589,9 +644,12 @@ OctreePointCloudSearch<PointT, LeafContainerT, BranchContainerT>::boxSearchRecur
   }
 }
 
-template <typename PointT, typename LeafContainerT, typename BranchContainerT>
+template <typename PointT,
+          typename LeafContainerT,
+          typename BranchContainerT,
+          typename NodeAllocatorT>
 uindex_t
-OctreePointCloudSearch<PointT, LeafContainerT, BranchContainerT>::
+OctreePointCloudSearch<PointT, LeafContainerT, BranchContainerT, NodeAllocatorT>::
     getIntersectedVoxelCenters(Eigen::Vector3f origin,
                                Eigen::Vector3f direction,
                                AlignedPointTVector& voxel_center_list,
@@ -625,9 +683,12 @@ OctreePointCloudSearch<PointT, LeafContainerT, BranchContainerT>::
   return (0);
 }
 
-template <typename PointT, typename LeafContainerT, typename BranchContainerT>
+template <typename PointT,
+          typename LeafContainerT,
+          typename BranchContainerT,
+          typename NodeAllocatorT>
 uindex_t
-OctreePointCloudSearch<PointT, LeafContainerT, BranchContainerT>::
+OctreePointCloudSearch<PointT, LeafContainerT, BranchContainerT, NodeAllocatorT>::
     getIntersectedVoxelIndices(Eigen::Vector3f origin,
                                Eigen::Vector3f direction,
                                Indices& k_indices,
@@ -659,9 +720,118 @@ OctreePointCloudSearch<PointT, LeafContainerT, BranchContainerT>::
   return (0);
 }
 
-template <typename PointT, typename LeafContainerT, typename BranchContainerT>
+template <typename PointT,
+          typename LeafContainerT,
+          typename BranchContainerT,
+          typename NodeAllocatorT>
+std::size_t
+OctreePointCloudSearch<PointT, LeafContainerT, BranchContainerT, NodeAllocatorT>::
+    getIntersectedVoxelCenters(const AlignedVector3fVector& origins,
+                               const AlignedVector3fVector& directions,
+                               AlignedPointTVector& voxel_center_list,
+                               std::vector<std::size_t>& ray_offsets,
+                               uindex_t max_voxel_count) const
+{
+  assert(origins.size() == directions.size());
+  return castRays(origins.size(),
+                  voxel_center_list,
+                  ray_offsets,
+                  [&](std::size_t ray, AlignedPointTVector& voxel_centers) {
+                    return getIntersectedVoxelCenters(
+                        origins[ray], directions[ray], voxel_centers, max_voxel_count);
+                  });
+}
+
+template <typename PointT,
+          typename LeafContainerT,
+          typename BranchContainerT,
+          typename NodeAllocatorT>
+std::size_t
+OctreePointCloudSearch<PointT, LeafContainerT, BranchContainerT, NodeAllocatorT>::
+    getIntersectedVoxelIndices(const AlignedVector3fVector& origins,
+                               const AlignedVector3fVector& directions,
+                               Indices& k_indices,
+                               std::vector<std::size_t>& ray_offsets,
+                               uindex_t max_voxel_count) const
+{
+  assert(origins.size() == directions.size());
+  return castRays(origins.size(),
+                  k_indices,
+                  ray_offsets,
+                  [&](std::size_t ray, Indices& indices) {
+                    return getIntersectedVoxelIndices(
+                        origins[ray], directions[ray], indices, max_voxel_count);
+                  });
+}
+
+template <typename PointT,
+          typename LeafContainerT,
+          typename BranchContainerT,
+          typename NodeAllocatorT>
+template <typename ContainerT, typename RayCasterT>
+std::size_t
+OctreePointCloudSearch<PointT, LeafContainerT, BranchContainerT, NodeAllocatorT>::
+    castRays(std::size_t nr_rays,
+             ContainerT& results,
+             std::vector<std::size_t>& ray_offsets,
+             const RayCasterT& cast_ray) const
+{
+  ray_offsets.assign(nr_rays + 1, 0);
+  std::size_t voxel_count = 0;
+
+  // Every thread casts a contiguous block of rays into a local buffer, the buffers are
+  // concatenated in ray order afterwards
+  const pcl::ThreadReservation reservation(this->threads_);
+  const unsigned int threads = reservation.getNumberOfThreads();
+  std::vector<std::size_t> block_sizes(threads + 1, 0);
+#pragma omp parallel default(none)                                                     \
+    shared(block_sizes, cast_ray, nr_rays, ray_offsets, results)                         \
+    reduction(+ : voxel_count) num_threads(threads)
+  {
+#ifdef _OPENMP
+    const std::size_t thread_id = omp_get_thread_num();
+    const std::size_t nr_blocks = omp_get_num_threads();
+#else
+    const std::size_t thread_id = 0;
+    const std::size_t nr_blocks = 1;
+#endif
+    const std::size_t begin = thread_id * nr_rays / nr_blocks;
+    const std::size_t end = (thread_id + 1) * nr_rays / nr_blocks;
+
+    ContainerT block_results, ray_results;
+    for (std::size_t ray = begin; ray < end; ++ray) {
+      voxel_count += cast_ray(ray, ray_results);
+      block_results.insert(block_results.end(), ray_results.begin(), ray_results.end());
+      ray_offsets[ray + 1] = ray_results.size();
+    }
+    block_sizes[thread_id + 1] = block_results.size();
+
+#pragma omp barrier
+#pragma omp single
+    {
+      for (std::size_t block = 0; block < nr_blocks; ++block)
+        block_sizes[block + 1] += block_sizes[block];
+      results.resize(block_sizes[nr_blocks]);
+    }
+
+    std::copy(block_results.begin(),
+              block_results.end(),
+              results.begin() + block_sizes[thread_id]);
+    std::size_t offset = block_sizes[thread_id];
+    for (std::size_t ray = begin; ray < end; ++ray) {
+      offset += ray_offsets[ray + 1];
+      ray_offsets[ray + 1] = offset;
+    }
+  }
+  return (voxel_count);
+}
+
+template <typename PointT,
+          typename LeafContainerT,
+          typename BranchContainerT,
+          typename NodeAllocatorT>
 uindex_t
-OctreePointCloudSearch<PointT, LeafContainerT, BranchContainerT>::
+OctreePointCloudSearch<PointT, LeafContainerT, BranchContainerT, NodeAllocatorT>::
     getIntersectedVoxelCentersRecursive(double min_x,
                                         double min_y,
                                         double min_z,
@@ -855,9 +1025,12 @@ OctreePointCloudSearch<PointT, LeafContainerT, BranchContainerT>::
   return (voxel_count);
 }
 
-template <typename PointT, typename LeafContainerT, typename BranchContainerT>
+template <typename PointT,
+          typename LeafContainerT,
+          typename BranchContainerT,
+          typename NodeAllocatorT>
 uindex_t
-OctreePointCloudSearch<PointT, LeafContainerT, BranchContainerT>::
+OctreePointCloudSearch<PointT, LeafContainerT, BranchContainerT, NodeAllocatorT>::
     getIntersectedVoxelIndicesRecursive(double min_x,
                                         double min_y,
                                         double min_z,
@@ -1048,6 +1221,28 @@ OctreePointCloudSearch<PointT, LeafContainerT, BranchContainerT>::
   return (voxel_count);
 }
 
+template <typename PointT,
+          typename LeafContainerT,
+          typename BranchContainerT,
+          typename NodeAllocatorT>
+OctreeSnapshot<PointT>
+OctreePointCloudSearch<PointT, LeafContainerT, BranchContainerT, NodeAllocatorT>::
+    freeze() const
+{
+  OctreeSnapshot<PointT> snapshot;
+  if (!this->input_ || this->getLeafCount() == 0)
+    return (snapshot);
+
+  snapshot.template build<BranchNode, LeafNode>(
+      *this->root_node_,
+      this->octree_depth_,
+      this->resolution_,
+      Eigen::Vector3d(this->min_x_, this->min_y_, this->min_z_),
+      Eigen::Vector3d(this->max_x_, this->max_y_, this->max_z_),
+      *this->input_);
+  return (snapshot);
+}
+
 } // namespace octree
 } // namespace pcl
 
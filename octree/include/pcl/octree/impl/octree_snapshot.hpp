@@ -0,0 +1,634 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef PCL_OCTREE_SNAPSHOT_HPP_
+#define PCL_OCTREE_SNAPSHOT_HPP_
+
+#include <pcl/common/point_tests.h> // for pcl::isFinite
+#include <pcl/console/print.h>
+#include <pcl/octree/octree_snapshot.h>
+
+#include <array>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <limits>
+#include <queue>
+#include <utility>
+
+namespace pcl {
+namespace octree {
+
+namespace detail {
+/** \brief Identifies snapshot buffers, "PCOS" in little-endian byte order */
+constexpr std::uint32_t octree_snapshot_magic = 0x534F4350;
+constexpr std::uint32_t octree_snapshot_version = 1;
+
+inline std::size_t
+alignSnapshotOffset(std::size_t offset)
+{
+  return ((offset + 15) / 16) * 16;
+}
+} // namespace detail
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT>
+OctreeSnapshot<PointT>&
+OctreeSnapshot<PointT>::operator=(const OctreeSnapshot& source)
+{
+  if (this == &source)
+    return (*this);
+
+  storage_ = source.storage_;
+  header_ = nullptr;
+  data_ = nullptr;
+  size_ = 0;
+  if (!storage_.empty())
+    attach(storage_.data(), storage_.size());
+  else if (source.data_)
+    attach(source.data_, source.size_);
+  return (*this);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT>
+typename OctreeSnapshot<PointT>::Layout
+OctreeSnapshot<PointT>::computeLayout(std::size_t nr_nodes, std::size_t nr_points)
+{
+  Layout layout;
+  layout.nodes = detail::alignSnapshotOffset(sizeof(Header));
+  layout.x = detail::alignSnapshotOffset(layout.nodes + nr_nodes * sizeof(Node));
+  layout.y = detail::alignSnapshotOffset(layout.x + nr_points * sizeof(float));
+  layout.z = detail::alignSnapshotOffset(layout.y + nr_points * sizeof(float));
+  layout.indices = detail::alignSnapshotOffset(layout.z + nr_points * sizeof(float));
+  layout.size = layout.indices + nr_points * sizeof(index_t);
+  return (layout);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT>
+template <typename BranchNodeT, typename LeafNodeT>
+bool
+OctreeSnapshot<PointT>::build(const BranchNodeT& root,
+                              uindex_t depth,
+                              double resolution,
+                              const Eigen::Vector3d& min_pt,
+                              const Eigen::Vector3d& max_pt,
+                              const PointCloud& cloud)
+{
+  // Nodes in breadth-first order, which keeps the children of every branch together
+  std::vector<const OctreeNode*> octree_nodes(1, &root);
+  std::vector<Node> nodes(1);
+  for (std::size_t i = 0; i < octree_nodes.size(); ++i) {
+    std::memset(&nodes[i], 0, sizeof(Node));
+    if (octree_nodes[i]->getNodeType() == LEAF_NODE) {
+      nodes[i].leaf = 1;
+      continue;
+    }
+
+    const auto& branch = static_cast<const BranchNodeT&>(*octree_nodes[i]);
+    nodes[i].child_begin = static_cast<std::uint32_t>(octree_nodes.size());
+    for (unsigned char child_idx = 0; child_idx < 8; ++child_idx) {
+      const OctreeNode* child = branch.getChildPtr(child_idx);
+      if (!child)
+        continue;
+      nodes[i].child_mask |= static_cast<std::uint8_t>(1 << child_idx);
+      octree_nodes.push_back(child);
+      nodes.emplace_back();
+    }
+
+    if (octree_nodes.size() > std::numeric_limits<std::uint32_t>::max()) {
+      PCL_ERROR("[pcl::octree::OctreeSnapshot::build] Too many octree nodes!\n");
+      return (false);
+    }
+  }
+
+  // Points in depth-first order, so that every subtree covers a contiguous range
+  Indices indices;
+  linearizePoints<LeafNodeT>(0, octree_nodes, cloud, nodes, indices);
+  if (indices.size() > std::numeric_limits<std::uint32_t>::max()) {
+    PCL_ERROR("[pcl::octree::OctreeSnapshot::build] Too many points!\n");
+    return (false);
+  }
+
+  const Layout layout = computeLayout(nodes.size(), indices.size());
+  std::vector<std::uint8_t> storage(layout.size, 0);
+
+  Header header;
+  std::memset(&header, 0, sizeof(Header));
+  header.magic = detail::octree_snapshot_magic;
+  header.version = detail::octree_snapshot_version;
+  header.index_size = sizeof(index_t);
+  header.depth = depth;
+  header.nr_nodes = static_cast<std::uint32_t>(nodes.size());
+  header.nr_points = indices.size();
+  header.resolution = resolution;
+  for (int d = 0; d < 3; ++d) {
+    header.min_pt[d] = min_pt[d];
+    header.max_pt[d] = max_pt[d];
+  }
+  std::memcpy(storage.data(), &header, sizeof(Header));
+  std::memcpy(storage.data() + layout.nodes, nodes.data(), nodes.size() * sizeof(Node));
+
+  auto* x = reinterpret_cast<float*>(storage.data() + layout.x);
+  auto* y = reinterpret_cast<float*>(storage.data() + layout.y);
+  auto* z = reinterpret_cast<float*>(storage.data() + layout.z);
+  for (std::size_t i = 0; i < indices.size(); ++i) {
+    const PointT& point = cloud[indices[i]];
+    x[i] = point.x;
+    y[i] = point.y;
+    z[i] = point.z;
+  }
+  std::memcpy(storage.data() + layout.indices,
+              indices.data(),
+              indices.size() * sizeof(index_t));
+
+  storage_.swap(storage);
+  return (attach(storage_.data(), storage_.size()));
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT>
+template <typename LeafNodeT>
+void
+OctreeSnapshot<PointT>::linearizePoints(
+    std::uint32_t node_idx,
+    const std::vector<const OctreeNode*>& octree_nodes,
+    const PointCloud& cloud,
+    std::vector<Node>& nodes,
+    Indices& indices) const
+{
+  Node& node = nodes[node_idx];
+  for (int d = 0; d < 3; ++d) {
+    node.min_pt[d] = std::numeric_limits<float>::max();
+    node.max_pt[d] = std::numeric_limits<float>::lowest();
+  }
+  node.point_begin = static_cast<std::uint32_t>(indices.size());
+
+  if (node.leaf) {
+    static_cast<const LeafNodeT&>(*octree_nodes[node_idx])
+        .getContainer()
+        .getPointIndices(indices);
+    for (std::size_t i = node.point_begin; i < indices.size(); ++i) {
+      const PointT& point = cloud[indices[i]];
+      node.min_pt[0] = std::min(node.min_pt[0], point.x);
+      node.min_pt[1] = std::min(node.min_pt[1], point.y);
+      node.min_pt[2] = std::min(node.min_pt[2], point.z);
+      node.max_pt[0] = std::max(node.max_pt[0], point.x);
+      node.max_pt[1] = std::max(node.max_pt[1], point.y);
+      node.max_pt[2] = std::max(node.max_pt[2], point.z);
+    }
+  }
+  else {
+    std::uint32_t child_idx = node.child_begin;
+    for (std::uint8_t mask = node.child_mask; mask; mask &= mask - 1, ++child_idx) {
+      linearizePoints<LeafNodeT>(child_idx, octree_nodes, cloud, nodes, indices);
+      const Node& child = nodes[child_idx];
+      for (int d = 0; d < 3; ++d) {
+        node.min_pt[d] = std::min(node.min_pt[d], child.min_pt[d]);
+        node.max_pt[d] = std::max(node.max_pt[d], child.max_pt[d]);
+      }
+    }
+  }
+
+  node.point_end = static_cast<std::uint32_t>(indices.size());
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT>
+bool
+OctreeSnapshot<PointT>::attach(const void* data, std::size_t size)
+{
+  const auto* bytes = static_cast<const std::uint8_t*>(data);
+  header_ = nullptr;
+  data_ = nullptr;
+  size_ = 0;
+  if (bytes != storage_.data())
+    storage_.clear();
+
+  if (!bytes || size < sizeof(Header)) {
+    PCL_ERROR("[pcl::octree::OctreeSnapshot::attach] Buffer too small!\n");
+    return (false);
+  }
+  if (reinterpret_cast<std::uintptr_t>(bytes) % alignof(Header) != 0) {
+    PCL_ERROR("[pcl::octree::OctreeSnapshot::attach] Buffer is not aligned!\n");
+    return (false);
+  }
+
+  const auto* header = reinterpret_cast<const Header*>(bytes);
+  if (header->magic != detail::octree_snapshot_magic ||
+      header->version != detail::octree_snapshot_version ||
+      header->index_size != sizeof(index_t)) {
+    PCL_ERROR("[pcl::octree::OctreeSnapshot::attach] Incompatible snapshot buffer!\n");
+    return (false);
+  }
+
+  const Layout layout =
+      computeLayout(header->nr_nodes, static_cast<std::size_t>(header->nr_points));
+  if (header->nr_nodes == 0 || size < layout.size) {
+    PCL_ERROR("[pcl::octree::OctreeSnapshot::attach] Truncated snapshot buffer!\n");
+    return (false);
+  }
+
+  header_ = header;
+  nodes_ = reinterpret_cast<const Node*>(bytes + layout.nodes);
+  x_ = reinterpret_cast<const float*>(bytes + layout.x);
+  y_ = reinterpret_cast<const float*>(bytes + layout.y);
+  z_ = reinterpret_cast<const float*>(bytes + layout.z);
+  indices_ = reinterpret_cast<const index_t*>(bytes + layout.indices);
+  data_ = bytes;
+  size_ = layout.size;
+  return (true);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT>
+bool
+OctreeSnapshot<PointT>::save(const std::string& file_name) const
+{
+  if (!data_) {
+    PCL_ERROR("[pcl::octree::OctreeSnapshot::save] Snapshot is empty!\n");
+    return (false);
+  }
+
+  std::ofstream file(file_name.c_str(), std::ios::out | std::ios::binary);
+  file.write(reinterpret_cast<const char*>(data_), static_cast<std::streamsize>(size_));
+  if (!file) {
+    PCL_ERROR("[pcl::octree::OctreeSnapshot::save] Could not write file %s!\n",
+              file_name.c_str());
+    return (false);
+  }
+  return (true);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT>
+bool
+OctreeSnapshot<PointT>::load(const std::string& file_name)
+{
+  std::ifstream file(file_name.c_str(), std::ios::in | std::ios::binary | std::ios::ate);
+  if (!file) {
+    PCL_ERROR("[pcl::octree::OctreeSnapshot::load] Could not open file %s!\n",
+              file_name.c_str());
+    return (false);
+  }
+
+  std::vector<std::uint8_t> storage(static_cast<std::size_t>(file.tellg()));
+  file.seekg(0);
+  file.read(reinterpret_cast<char*>(storage.data()),
+            static_cast<std::streamsize>(storage.size()));
+  if (!file) {
+    PCL_ERROR("[pcl::octree::OctreeSnapshot::load] Could not read file %s!\n",
+              file_name.c_str());
+    return (false);
+  }
+
+  storage_.swap(storage);
+  return (attach(storage_.data(), storage_.size()));
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT>
+bool
+OctreeSnapshot<PointT>::voxelSearch(const PointT& point, Indices& point_idx_data) const
+{
+  assert(isFinite(point) &&
+         "Invalid (NaN, Inf) point coordinates given to voxelSearch!");
+  if (!header_)
+    return (false);
+
+  const float coordinates[3] = {point.x, point.y, point.z};
+  uindex_t key[3];
+  for (int d = 0; d < 3; ++d) {
+    if (coordinates[d] < header_->min_pt[d] || coordinates[d] >= header_->max_pt[d])
+      return (false);
+    key[d] = static_cast<uindex_t>((coordinates[d] - header_->min_pt[d]) /
+                                   header_->resolution);
+  }
+  const OctreeKey octree_key(key[0], key[1], key[2]);
+
+  std::uint32_t node_idx = 0;
+  for (uindex_t depth_mask = 1u << (header_->depth - 1); depth_mask; depth_mask >>= 1) {
+    const Node& node = nodes_[node_idx];
+    if (node.leaf)
+      break;
+
+    const unsigned char child_idx = octree_key.getChildIdxWithDepthMask(depth_mask);
+    if (!(node.child_mask & (1 << child_idx)))
+      return (false);
+    node_idx = getChildNode(node, child_idx);
+  }
+
+  const Node& leaf = nodes_[node_idx];
+  if (!leaf.leaf)
+    return (false);
+
+  point_idx_data.insert(
+      point_idx_data.end(), indices_ + leaf.point_begin, indices_ + leaf.point_end);
+  return (true);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT>
+uindex_t
+OctreeSnapshot<PointT>::nearestKSearch(const PointT& p_q,
+                                       uindex_t k,
+                                       Indices& k_indices,
+                                       std::vector<float>& k_sqr_distances) const
+{
+  assert(isFinite(p_q) &&
+         "Invalid (NaN, Inf) point coordinates given to nearestKSearch!");
+  k_indices.clear();
+  k_sqr_distances.clear();
+  if (!header_ || k == 0 || header_->nr_points == 0)
+    return (0);
+
+  const float point[3] = {p_q.x, p_q.y, p_q.z};
+
+  // max-heap of the k best candidates
+  std::vector<std::pair<float, index_t>> results;
+  results.reserve(k);
+
+  // nodes ordered by the distance of their bounding box
+  using NodeEntry = std::pair<float, std::uint32_t>;
+  std::priority_queue<NodeEntry, std::vector<NodeEntry>, std::greater<NodeEntry>>
+      queue;
+  queue.emplace(getSqrDistanceToBox(nodes_[0], point), 0);
+
+  while (!queue.empty()) {
+    const NodeEntry entry = queue.top();
+    queue.pop();
+    if (results.size() == k && entry.first > results.front().first)
+      break;
+
+    const Node& node = nodes_[entry.second];
+    if (node.leaf) {
+      for (std::uint32_t i = node.point_begin; i < node.point_end; ++i) {
+        const float sqr_distance = getSqrDistance(i, point);
+        if (results.size() < k) {
+          results.emplace_back(sqr_distance, indices_[i]);
+          std::push_heap(results.begin(), results.end());
+        }
+        else if (sqr_distance < results.front().first) {
+          std::pop_heap(results.begin(), results.end());
+          results.back() = std::make_pair(sqr_distance, indices_[i]);
+          std::push_heap(results.begin(), results.end());
+        }
+      }
+      continue;
+    }
+
+    std::uint32_t child_idx = node.child_begin;
+    for (std::uint8_t mask = node.child_mask; mask; mask &= mask - 1, ++child_idx) {
+      const Node& child = nodes_[child_idx];
+      if (child.point_begin == child.point_end)
+        continue;
+      const float sqr_distance = getSqrDistanceToBox(child, point);
+      if (results.size() < k || sqr_distance <= results.front().first)
+        queue.emplace(sqr_distance, child_idx);
+    }
+  }
+
+  std::sort_heap(results.begin(), results.end());
+  k_indices.resize(results.size());
+  k_sqr_distances.resize(results.size());
+  for (std::size_t i = 0; i < results.size(); ++i) {
+    k_sqr_distances[i] = results[i].first;
+    k_indices[i] = results[i].second;
+  }
+  return (static_cast<uindex_t>(k_indices.size()));
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT>
+uindex_t
+OctreeSnapshot<PointT>::radiusSearch(const PointT& p_q,
+                                     const double radius,
+                                     Indices& k_indices,
+                                     std::vector<float>& k_sqr_distances,
+                                     uindex_t max_nn) const
+{
+  assert(isFinite(p_q) &&
+         "Invalid (NaN, Inf) point coordinates given to radiusSearch!");
+  k_indices.clear();
+  k_sqr_distances.clear();
+  if (!header_ || header_->nr_points == 0)
+    return (0);
+
+  const float point[3] = {p_q.x, p_q.y, p_q.z};
+  const double sqr_radius = radius * radius;
+  const std::size_t max_results =
+      max_nn > 0 ? max_nn : std::numeric_limits<std::size_t>::max();
+
+  // every level adds at most seven nodes to the stack
+  std::array<std::uint32_t, 7 * 33 + 1> stack;
+  std::size_t stack_size = 0;
+  stack[stack_size++] = 0;
+
+  while (stack_size > 0) {
+    const Node& node = nodes_[stack[--stack_size]];
+    if (node.point_begin == node.point_end ||
+        getSqrDistanceToBox(node, point) > sqr_radius)
+      continue;
+
+    if (node.leaf || getMaxSqrDistanceToBox(node, point) <= sqr_radius) {
+      // leaf, or subtree completely inside of the sphere
+      const bool check = node.leaf;
+      for (std::uint32_t i = node.point_begin; i < node.point_end; ++i) {
+        const float sqr_distance = getSqrDistance(i, point);
+        if (check && sqr_distance > sqr_radius)
+          continue;
+        k_indices.push_back(indices_[i]);
+        k_sqr_distances.push_back(sqr_distance);
+        if (k_indices.size() >= max_results)
+          return (static_cast<uindex_t>(k_indices.size()));
+      }
+      continue;
+    }
+
+    std::uint32_t child_idx = node.child_begin;
+    for (std::uint8_t mask = node.child_mask; mask; mask &= mask - 1, ++child_idx)
+      stack[stack_size++] = child_idx;
+  }
+
+  return (static_cast<uindex_t>(k_indices.size()));
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT>
+uindex_t
+OctreeSnapshot<PointT>::getIntersectedVoxelIndices(Eigen::Vector3f origin,
+                                                   Eigen::Vector3f direction,
+                                                   Indices& k_indices,
+                                                   uindex_t max_voxel_count) const
+{
+  k_indices.clear();
+  if (!header_)
+    return (0);
+
+  const double* min_pt = header_->min_pt;
+  const double* max_pt = header_->max_pt;
+
+  // Account for division by zero when direction vector is 0.0
+  const float epsilon = 1e-10f;
+  for (int d = 0; d < 3; ++d)
+    if (direction[d] == 0.0)
+      direction[d] = epsilon;
+
+  // Voxel child_idx remapping, handle negative axis direction vector
+  unsigned char a = 0;
+  for (int d = 0; d < 3; ++d) {
+    if (direction[d] < 0.0) {
+      origin[d] =
+          static_cast<float>(min_pt[d]) + static_cast<float>(max_pt[d]) - origin[d];
+      direction[d] = -direction[d];
+      a |= static_cast<unsigned char>(4 >> d);
+    }
+  }
+
+  const double min_x = (min_pt[0] - origin.x()) / direction.x();
+  const double max_x = (max_pt[0] - origin.x()) / direction.x();
+  const double min_y = (min_pt[1] - origin.y()) / direction.y();
+  const double max_y = (max_pt[1] - origin.y()) / direction.y();
+  const double min_z = (min_pt[2] - origin.z()) / direction.z();
+  const double max_z = (max_pt[2] - origin.z()) / direction.z();
+
+  if (std::max(std::max(min_x, min_y), min_z) < std::min(std::min(max_x, max_y), max_z))
+    return getIntersectedVoxelIndicesRecursive(
+        min_x, min_y, min_z, max_x, max_y, max_z, a, 0, k_indices, max_voxel_count);
+  return (0);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT>
+uindex_t
+OctreeSnapshot<PointT>::getIntersectedVoxelIndicesRecursive(
+    double min_x,
+    double min_y,
+    double min_z,
+    double max_x,
+    double max_y,
+    double max_z,
+    unsigned char a,
+    std::uint32_t node_idx,
+    Indices& k_indices,
+    uindex_t max_voxel_count) const
+{
+  if (max_x < 0.0 || max_y < 0.0 || max_z < 0.0)
+    return (0);
+
+  const Node& node = nodes_[node_idx];
+  if (node.leaf) {
+    k_indices.insert(
+        k_indices.end(), indices_ + node.point_begin, indices_ + node.point_end);
+    return (1);
+  }
+
+  uindex_t voxel_count = 0;
+
+  // Voxel mid lines
+  const double mid_x = 0.5 * (min_x + max_x);
+  const double mid_y = 0.5 * (min_y + max_y);
+  const double mid_z = 0.5 * (min_z + max_z);
+
+  // First child node the ray enters, same as OctreePointCloudSearch
+  int curr_node = 0;
+  if (min_x > min_y && min_x > min_z) {
+    // Entry plane is YZ
+    if (mid_y < min_x)
+      curr_node |= 2;
+    if (mid_z < min_x)
+      curr_node |= 1;
+  }
+  else if (min_x <= min_y && min_y > min_z) {
+    // Entry plane is XZ
+    if (mid_x < min_y)
+      curr_node |= 4;
+    if (mid_z < min_y)
+      curr_node |= 1;
+  }
+  else {
+    // Entry plane is XY
+    if (mid_x < min_z)
+      curr_node |= 4;
+    if (mid_y < min_z)
+      curr_node |= 2;
+  }
+
+  do {
+    const auto child_idx = static_cast<unsigned char>(curr_node ^ a);
+
+    // Parametric bounds of the current child
+    const double child_min_x = (curr_node & 4) ? mid_x : min_x;
+    const double child_max_x = (curr_node & 4) ? max_x : mid_x;
+    const double child_min_y = (curr_node & 2) ? mid_y : min_y;
+    const double child_max_y = (curr_node & 2) ? max_y : mid_y;
+    const double child_min_z = (curr_node & 1) ? mid_z : min_z;
+    const double child_max_z = (curr_node & 1) ? max_z : mid_z;
+
+    if (node.child_mask & (1 << child_idx))
+      voxel_count += getIntersectedVoxelIndicesRecursive(child_min_x,
+                                                         child_min_y,
+                                                         child_min_z,
+                                                         child_max_x,
+                                                         child_max_y,
+                                                         child_max_z,
+                                                         a,
+                                                         getChildNode(node, child_idx),
+                                                         k_indices,
+                                                         max_voxel_count);
+
+    // Next child node, selected by the exit plane of the current child
+    const int next_x = (curr_node & 4) ? 8 : (curr_node | 4);
+    const int next_y = (curr_node & 2) ? 8 : (curr_node | 2);
+    const int next_z = (curr_node & 1) ? 8 : (curr_node | 1);
+    if (child_max_x < child_max_y)
+      curr_node = (child_max_x < child_max_z) ? next_x : next_z;
+    else
+      curr_node = (child_max_y < child_max_z) ? next_y : next_z;
+  } while ((curr_node < 8) && (max_voxel_count <= 0 || voxel_count < max_voxel_count));
+
+  return (voxel_count);
+}
+
+} // namespace octree
+} // namespace pcl
+
+#define PCL_INSTANTIATE_OctreeSnapshot(T)                                              \
+  template class PCL_EXPORTS pcl::octree::OctreeSnapshot<T>;
+
+#endif // PCL_OCTREE_SNAPSHOT_HPP_
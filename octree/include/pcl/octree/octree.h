@@ -50,3 +50,4 @@
 #include <pcl/octree/octree_pointcloud_singlepoint.h>
 #include <pcl/octree/octree_pointcloud_voxelcentroid.h>
 #include <pcl/octree/octree_search.h>
+#include <pcl/octree/octree_snapshot.h>
@@ -41,6 +41,7 @@
 #include <pcl/octree/octree_container.h>
 #include <pcl/octree/octree_iterator.h>
 #include <pcl/octree/octree_key.h>
+#include <pcl/octree/octree_node_pool.h>
 #include <pcl/octree/octree_nodes.h>
 #include <pcl/pcl_macros.h>
 
@@ -209,15 +210,18 @@ protected:
  * be initially defined).
  * \note All leaf nodes are addressed by integer indices.
  * \note The tree depth equates to the bit length of the voxel indices.
+ * \note NodeAllocatorT defines how nodes are allocated. Use OctreeNodeArena to keep the
+ * nodes in contiguous memory blocks.
  * \ingroup octree
  * \author Julius Kammerl (julius@kammerl.de)
  */
 template <typename LeafContainerT = index_t,
-          typename BranchContainerT = OctreeContainerEmpty>
+          typename BranchContainerT = OctreeContainerEmpty,
+          typename NodeAllocatorT = OctreeHeapNodeAllocator>
 class Octree2BufBase {
 
 public:
-  using OctreeT = Octree2BufBase<LeafContainerT, BranchContainerT>;
+  using OctreeT = Octree2BufBase<LeafContainerT, BranchContainerT, NodeAllocatorT>;
 
   // iterators are friends
   friend class OctreeIteratorBase<OctreeT>;
@@ -231,6 +235,7 @@ public:
 
   using BranchContainer = BranchContainerT;
   using LeafContainer = LeafContainerT;
+  using NodeAllocator = NodeAllocatorT;
 
   // Octree default iterators
   using Iterator = OctreeDepthFirstIterator<OctreeT>;
@@ -243,7 +248,7 @@ public:
   const Iterator
   end()
   {
-    return Iterator();
+    return Iterator(this, 0, nullptr);
   };
 
   // Octree leaf node iterators
@@ -266,7 +271,7 @@ public:
   const LeafNodeDepthFirstIterator
   leaf_depth_end()
   {
-    return LeafNodeDepthFirstIterator();
+    return LeafNodeDepthFirstIterator(this, 0, nullptr);
   };
 
   // Octree depth-first iterators
@@ -280,7 +285,7 @@ public:
   const DepthFirstIterator
   depth_end()
   {
-    return DepthFirstIterator();
+    return DepthFirstIterator(this, 0, nullptr);
   };
 
   // Octree breadth-first iterators
@@ -294,7 +299,7 @@ public:
   const BreadthFirstIterator
   breadth_end()
   {
-    return BreadthFirstIterator();
+    return BreadthFirstIterator(this, 0, nullptr);
   };
 
   // Octree leaf node iterators
@@ -325,7 +330,7 @@ public:
   Octree2BufBase(const Octree2BufBase& source)
   : leaf_count_(source.leaf_count_)
   , branch_count_(source.branch_count_)
-  , root_node_(new (BranchNode)(*(source.root_node_)))
+  , root_node_(copyTree(*(source.root_node_)))
   , depth_mask_(source.depth_mask_)
   , max_key_(source.max_key_)
   , buffer_selector_(source.buffer_selector_)
@@ -338,9 +343,15 @@ public:
   inline Octree2BufBase&
   operator=(const Octree2BufBase& source)
   {
+    if (this == &source)
+      return (*this);
+
+    deleteBranch(*root_node_);
+    node_allocator_.deallocate(root_node_);
+
     leaf_count_ = source.leaf_count_;
     branch_count_ = source.branch_count_;
-    root_node_ = new (BranchNode)(*(source.root_node_));
+    root_node_ = copyTree(*(source.root_node_));
     depth_mask_ = source.depth_mask_;
     max_key_ = source.max_key_;
     buffer_selector_ = source.buffer_selector_;
@@ -725,13 +736,13 @@ protected:
         deleteBranch(*static_cast<BranchNode*>(branchChild));
 
         // delete unused branch
-        delete (branchChild);
+        node_allocator_.deallocate(static_cast<BranchNode*>(branchChild));
         break;
       }
 
       case LEAF_NODE: {
         // push unused leaf to branch pool
-        delete (branchChild);
+        node_allocator_.deallocate(static_cast<LeafNode*>(branchChild));
         break;
       }
       default:
@@ -785,7 +796,7 @@ protected:
   inline BranchNode*
   createBranchChild(BranchNode& branch_arg, unsigned char child_idx_arg)
   {
-    BranchNode* new_branch_child = new BranchNode();
+    BranchNode* new_branch_child = allocateBranchNode();
 
     branch_arg.setChildPtr(
         buffer_selector_, child_idx_arg, static_cast<OctreeNode*>(new_branch_child));
@@ -801,13 +812,56 @@ protected:
   inline LeafNode*
   createLeafChild(BranchNode& branch_arg, unsigned char child_idx_arg)
   {
-    LeafNode* new_leaf_child = new LeafNode();
+    LeafNode* new_leaf_child = node_allocator_.template allocate<LeafNode>();
 
     branch_arg.setChildPtr(buffer_selector_, child_idx_arg, new_leaf_child);
 
     return new_leaf_child;
   }
 
+  /** \brief Get a branch child of a branch class in current buffer. A missing child
+   * is taken over from the previous buffer if possible, otherwise it is created.
+   *  \param branch_arg: reference to octree branch class
+   *  \param child_idx_arg: index to child node
+   *  \return pointer to the branch child
+   */
+  BranchNode*
+  fetchBranchChild(BranchNode& branch_arg, unsigned char child_idx_arg);
+
+  /** \brief Get a leaf child of a branch class in current buffer. A missing child is
+   * taken over from the previous buffer with its container cleared if possible,
+   * otherwise it is created.
+   *  \param branch_arg: reference to octree branch class
+   *  \param child_idx_arg: index to child node
+   *  \return pointer to the leaf child
+   */
+  LeafNode*
+  fetchLeafChild(BranchNode& branch_arg, unsigned char child_idx_arg);
+
+  /** \brief Delete the nodes of the previous buffer along the path to a voxel that is
+   * not part of the current buffer. Cleaning up the paths of all vanished voxels
+   * is equivalent to the full tree walk in \ref switchBuffers.
+   *  \param key_arg: key of a leaf node of the previous buffer at maximum depth
+   */
+  void
+  deletePreviousBufferPath(const OctreeKey& key_arg);
+
+  /** \brief Allocate a new branch node that is not attached to the tree yet
+   *  \return pointer of new branch node
+   */
+  inline BranchNode*
+  allocateBranchNode()
+  {
+    return node_allocator_.template allocate<BranchNode>();
+  }
+
+  /** \brief Create a deep copy of a subtree including both buffers
+   *  \param source_arg: root branch of the subtree to be copied
+   *  \return pointer to the root branch of the copy
+   */
+  BranchNode*
+  copyTree(const BranchNode& source_arg);
+
   //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
   // Recursive octree methods
   //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -972,6 +1026,9 @@ protected:
   /** \brief Amount of branch nodes   **/
   std::size_t branch_count_;
 
+  /** \brief Allocator of all octree nodes   **/
+  NodeAllocatorT node_allocator_;
+
   /** \brief Pointer to root branch node of octree   **/
   BranchNode* root_node_;
 
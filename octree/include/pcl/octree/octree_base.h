@@ -41,6 +41,7 @@
 #include <pcl/octree/octree_container.h>
 #include <pcl/octree/octree_iterator.h>
 #include <pcl/octree/octree_key.h>
+#include <pcl/octree/octree_node_pool.h>
 #include <pcl/octree/octree_nodes.h>
 #include <pcl/pcl_macros.h>
 
@@ -54,20 +55,24 @@ namespace octree {
  * be initially defined).
  * \note All leaf nodes are addressed by integer indices.
  * \note The tree depth equates to the bit length of the voxel indices.
+ * \note NodeAllocatorT defines how nodes are allocated. Use OctreeNodeArena to keep the
+ * nodes in contiguous memory blocks.
  * \ingroup octree
  * \author Julius Kammerl (julius@kammerl.de)
  */
 template <typename LeafContainerT = index_t,
-          typename BranchContainerT = OctreeContainerEmpty>
+          typename BranchContainerT = OctreeContainerEmpty,
+          typename NodeAllocatorT = OctreeHeapNodeAllocator>
 class OctreeBase {
 public:
-  using OctreeT = OctreeBase<LeafContainerT, BranchContainerT>;
+  using OctreeT = OctreeBase<LeafContainerT, BranchContainerT, NodeAllocatorT>;
 
   using BranchNode = OctreeBranchNode<BranchContainerT>;
   using LeafNode = OctreeLeafNode<LeafContainerT>;
 
   using BranchContainer = BranchContainerT;
   using LeafContainer = LeafContainerT;
+  using NodeAllocator = NodeAllocatorT;
 
 protected:
   ///////////////////////////////////////////////////////////////////////
@@ -80,6 +85,9 @@ protected:
   /** \brief Amount of branch nodes   **/
   std::size_t branch_count_;
 
+  /** \brief Allocator of all octree nodes   **/
+  NodeAllocatorT node_allocator_;
+
   /** \brief Pointer to root branch node of octree   **/
   BranchNode* root_node_;
 
@@ -223,7 +231,7 @@ public:
   OctreeBase(const OctreeBase& source)
   : leaf_count_(source.leaf_count_)
   , branch_count_(source.branch_count_)
-  , root_node_(new (BranchNode)(*(source.root_node_)))
+  , root_node_(copyTree(*(source.root_node_), node_allocator_))
   , depth_mask_(source.depth_mask_)
   , octree_depth_(source.octree_depth_)
   , dynamic_depth_enabled_(source.dynamic_depth_enabled_)
@@ -234,11 +242,15 @@ public:
   OctreeBase&
   operator=(const OctreeBase& source)
   {
+    if (this == &source)
+      return (*this);
+
+    deleteTree();
+    node_allocator_.deallocate(root_node_);
+
     leaf_count_ = source.leaf_count_;
     branch_count_ = source.branch_count_;
-    delete root_node_;
-
-    root_node_ = new (BranchNode)(*(source.root_node_));
+    root_node_ = copyTree(*(source.root_node_), node_allocator_);
     depth_mask_ = source.depth_mask_;
     max_key_ = source.max_key_;
     octree_depth_ = source.octree_depth_;
@@ -322,11 +334,27 @@ public:
     return branch_count_;
   }
 
+  /** \brief Get the memory used by the octree, i.e. its nodes, the dynamic memory of
+   * the leaf and branch containers and memory reserved by the node allocator. Walks
+   * the whole tree, so the cost is linear in the number of nodes.
+   *  \return number of bytes, not counting sizeof(OctreeBase)
+   */
+  std::size_t
+  getMemoryUsage() const;
+
   /** \brief Delete the octree structure and its leaf nodes.
    */
   void
   deleteTree();
 
+  /** \brief Re-allocate all nodes in breadth-first order.
+   * \note With OctreeNodeArena as node allocator, the children of a branch and the
+   * nodes of every tree level are stored next to each other afterwards, which speeds up
+   * traversals. Pointers to nodes and leaf containers are invalidated.
+   */
+  void
+  compactNodes();
+
   /** \brief Serialize octree into a binary output vector describing its branch node
    * structure.
    * \param binary_tree_out_arg: reference to output vector for writing binary tree
@@ -508,12 +536,12 @@ protected:
         // free child branch recursively
         deleteBranch(*static_cast<BranchNode*>(branch_child));
         // delete branch node
-        delete branch_child;
+        node_allocator_.deallocate(static_cast<BranchNode*>(branch_child));
       } break;
 
       case LEAF_NODE: {
         // delete leaf node
-        delete branch_child;
+        node_allocator_.deallocate(static_cast<LeafNode*>(branch_child));
         break;
       }
       default:
@@ -544,7 +572,7 @@ protected:
   BranchNode*
   createBranchChild(BranchNode& branch_arg, unsigned char child_idx_arg)
   {
-    BranchNode* new_branch_child = new BranchNode();
+    BranchNode* new_branch_child = allocateBranchNode();
     branch_arg[child_idx_arg] = static_cast<OctreeNode*>(new_branch_child);
 
     return new_branch_child;
@@ -558,12 +586,29 @@ protected:
   LeafNode*
   createLeafChild(BranchNode& branch_arg, unsigned char child_idx_arg)
   {
-    LeafNode* new_leaf_child = new LeafNode();
+    LeafNode* new_leaf_child = node_allocator_.template allocate<LeafNode>();
     branch_arg[child_idx_arg] = static_cast<OctreeNode*>(new_leaf_child);
 
     return new_leaf_child;
   }
 
+  /** \brief Allocate a new branch node that is not attached to the tree yet
+   *  \return pointer of new branch node
+   */
+  BranchNode*
+  allocateBranchNode()
+  {
+    return node_allocator_.template allocate<BranchNode>();
+  }
+
+  /** \brief Create a deep copy of a subtree in breadth-first order
+   *  \param source_arg: root branch of the subtree to be copied
+   *  \param allocator_arg: allocator of the copied nodes
+   *  \return pointer to the root branch of the copy
+   */
+  BranchNode*
+  copyTree(const BranchNode& source_arg, NodeAllocatorT& allocator_arg) const;
+
   //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
   // Recursive octree methods
   //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
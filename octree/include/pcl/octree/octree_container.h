@@ -42,6 +42,7 @@
 
 #include <cassert>
 #include <cstddef>
+#include <type_traits>
 #include <vector>
 
 namespace pcl {
@@ -82,6 +83,16 @@ public:
     return 0u;
   }
 
+  /** \brief Get the memory allocated by the container on the heap, i.e. not counting
+   * sizeof the container itself.
+   * \return number of bytes
+   */
+  virtual std::size_t
+  getMemoryUsage() const
+  {
+    return 0;
+  }
+
   /** \brief Pure abstract reset leaf node implementation. */
   virtual void
   reset() = 0;
@@ -320,6 +331,15 @@ public:
     return static_cast<uindex_t>(leafDataTVector_.size());
   }
 
+  /** \brief Get the memory allocated for the point indices.
+   * \return number of bytes
+   */
+  std::size_t
+  getMemoryUsage() const override
+  {
+    return leafDataTVector_.capacity() * sizeof(index_t);
+  }
+
   /** \brief Reset leaf node. Clear DataT vector.*/
   void
   reset() override
@@ -332,5 +352,22 @@ protected:
   Indices leafDataTVector_;
 };
 
+/** \brief Get the heap memory held by a leaf or branch container, 0 for containers
+ * that are not derived from OctreeContainerBase such as plain indices.
+ */
+template <typename ContainerT>
+std::enable_if_t<std::is_base_of<OctreeContainerBase, ContainerT>::value, std::size_t>
+getContainerMemoryUsage(const ContainerT& container)
+{
+  return container.getMemoryUsage();
+}
+
+template <typename ContainerT>
+std::enable_if_t<!std::is_base_of<OctreeContainerBase, ContainerT>::value, std::size_t>
+getContainerMemoryUsage(const ContainerT&)
+{
+  return 0;
+}
+
 } // namespace octree
 } // namespace pcl
@@ -37,8 +37,13 @@
 
 #pragma once
 
+#include <pcl/memory.h>
 #include <pcl/pcl_macros.h>
 
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <utility>
 #include <vector>
 
 namespace pcl {
@@ -108,5 +113,196 @@ protected:
   std::vector<NodeT*> nodePool_;
 };
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/** \brief @b Octree node allocator allocating every node individually on the heap
+ * \note This is the default node allocation policy of OctreeBase and Octree2BufBase.
+ */
+class OctreeHeapNodeAllocator {
+public:
+  /** \brief Allocate and construct a node
+   *  \param args: arguments forwarded to the constructor of the node
+   *  \return Pointer to octree node
+   */
+  template <typename NodeT, typename... Args>
+  inline NodeT*
+  allocate(Args&&... args)
+  {
+    return new NodeT(std::forward<Args>(args)...);
+  }
+
+  /** \brief Destroy and free a node obtained from allocate
+   *  \param node_arg: node to be freed
+   */
+  template <typename NodeT>
+  inline void
+  deallocate(NodeT* node_arg)
+  {
+    delete node_arg;
+  }
+
+  /** \brief Get the memory reserved by the allocator beyond the nodes in use
+   *  \return 0, every node is allocated on its own
+   */
+  std::size_t
+  getReservedBytes() const
+  {
+    return 0;
+  }
+};
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/** \brief @b Octree node allocator keeping the nodes in contiguous memory blocks
+ * \note Nodes are carved sequentially out of blocks holding a fixed number of nodes of
+ * the same size, so nodes created one after another are adjacent in memory. Freed nodes
+ * are recycled by later allocations of the same size and memory is only returned to the
+ * system when the allocator is destroyed.
+ * \note Use as the NodeAllocatorT template parameter of OctreeBase or Octree2BufBase.
+ */
+class OctreeNodeArena {
+public:
+  /** \brief Constructor.
+   *  \param nodes_per_block: number of nodes stored in every memory block
+   */
+  explicit OctreeNodeArena(std::size_t nodes_per_block = 4096)
+  : nodes_per_block_(nodes_per_block > 0 ? nodes_per_block : 1)
+  {}
+
+  OctreeNodeArena(const OctreeNodeArena&) = delete;
+
+  OctreeNodeArena&
+  operator=(const OctreeNodeArena&) = delete;
+
+  /** \brief Move constructor. */
+  OctreeNodeArena(OctreeNodeArena&& source) noexcept
+  : pools_(std::move(source.pools_))
+  , blocks_(std::move(source.blocks_))
+  , nodes_per_block_(source.nodes_per_block_)
+  {
+    source.pools_.clear();
+    source.blocks_.clear();
+  }
+
+  /** \brief Move operator. All nodes of this arena have to be freed beforehand. */
+  OctreeNodeArena&
+  operator=(OctreeNodeArena&& source) noexcept
+  {
+    if (this != &source) {
+      releaseBlocks();
+      pools_ = std::move(source.pools_);
+      blocks_ = std::move(source.blocks_);
+      nodes_per_block_ = source.nodes_per_block_;
+      source.pools_.clear();
+      source.blocks_.clear();
+    }
+    return (*this);
+  }
+
+  /** \brief Destructor. Releases all memory blocks, nodes are not destroyed. */
+  ~OctreeNodeArena() { releaseBlocks(); }
+
+  /** \brief Allocate and construct a node
+   *  \param args: arguments forwarded to the constructor of the node
+   *  \return Pointer to octree node
+   */
+  template <typename NodeT, typename... Args>
+  inline NodeT*
+  allocate(Args&&... args)
+  {
+    static_assert(alignof(NodeT) <= alignment, "Node alignment is not supported");
+    return new (acquireSlot(getStride(sizeof(NodeT))))
+        NodeT(std::forward<Args>(args)...);
+  }
+
+  /** \brief Destroy a node obtained from allocate and recycle its memory
+   *  \param node_arg: node to be freed
+   */
+  template <typename NodeT>
+  inline void
+  deallocate(NodeT* node_arg)
+  {
+    if (!node_arg)
+      return;
+    node_arg->~NodeT();
+    getPool(getStride(sizeof(NodeT))).free_slots.push_back(node_arg);
+  }
+
+  /** \brief Get the memory reserved by the allocator, including free node slots
+   *  \return size of all memory blocks in bytes
+   */
+  std::size_t
+  getReservedBytes() const
+  {
+    std::size_t bytes = 0;
+    for (const auto& block : blocks_)
+      bytes += block.second;
+    for (const auto& pool : pools_)
+      bytes += pool.free_slots.capacity() * sizeof(void*);
+    return bytes;
+  }
+
+protected:
+  /** \brief Alignment of every node slot */
+  static constexpr std::size_t alignment =
+      (EIGEN_MAX_ALIGN_BYTES > alignof(std::max_align_t)) ? EIGEN_MAX_ALIGN_BYTES
+                                                          : alignof(std::max_align_t);
+
+  /** \brief Slots of a single node size */
+  struct Pool {
+    std::size_t stride;
+    std::uint8_t* next;
+    std::uint8_t* end;
+    std::vector<void*> free_slots;
+  };
+
+  static constexpr std::size_t
+  getStride(std::size_t size)
+  {
+    return ((size + alignment - 1) / alignment) * alignment;
+  }
+
+  Pool&
+  getPool(std::size_t stride)
+  {
+    for (auto& pool : pools_)
+      if (pool.stride == stride)
+        return pool;
+    pools_.push_back({stride, nullptr, nullptr, {}});
+    return pools_.back();
+  }
+
+  void*
+  acquireSlot(std::size_t stride)
+  {
+    Pool& pool = getPool(stride);
+    if (!pool.free_slots.empty()) {
+      void* slot = pool.free_slots.back();
+      pool.free_slots.pop_back();
+      return slot;
+    }
+    if (pool.next == pool.end) {
+      const std::size_t block_size = stride * nodes_per_block_;
+      pool.next = Eigen::aligned_allocator<std::uint8_t>().allocate(block_size);
+      pool.end = pool.next + block_size;
+      blocks_.emplace_back(pool.next, block_size);
+    }
+    void* slot = pool.next;
+    pool.next += stride;
+    return slot;
+  }
+
+  void
+  releaseBlocks()
+  {
+    for (const auto& block : blocks_)
+      Eigen::aligned_allocator<std::uint8_t>().deallocate(block.first, block.second);
+    blocks_.clear();
+    pools_.clear();
+  }
+
+  std::vector<Pool> pools_;
+  std::vector<std::pair<std::uint8_t*, std::size_t>> blocks_;
+  std::size_t nodes_per_block_;
+};
+
 } // namespace octree
 } // namespace pcl
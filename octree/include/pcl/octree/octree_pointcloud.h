@@ -104,7 +104,7 @@ public:
       const OctreePointCloud<PointT, LeafContainerT, BranchContainerT, OctreeT>>;
 
   // Eigen aligned allocator
-  using AlignedPointTVector = std::vector<PointT, Eigen::aligned_allocator<PointT>>;
+  using AlignedPointTVector = typename pcl::PointCloud<PointT>::VectorType;
   using AlignedPointXYZVector =
       std::vector<PointXYZ, Eigen::aligned_allocator<PointXYZ>>;
 
@@ -189,6 +189,28 @@ public:
     return this->octree_depth_;
   }
 
+  /** \brief Set the number of threads used by \ref addPointsFromInputCloud.
+   *
+   * Unless a single thread is set, an empty octree of fixed depth is built in bulk: the
+   * keys of all points are computed in parallel, sorted in Morton order with a radix
+   * sort, and the branch and leaf nodes are then created in a single pass over the
+   * sorted keys. The resulting octree is identical to the one built by inserting the
+   * points one at a time. Otherwise (one thread, non-empty octree, dynamic depth or
+   * double buffering) the points are inserted one at a time. OctreePointCloudSearch
+   * also casts batches of rays with this number of threads.
+   * \param[in] nr_threads the number of hardware threads to use (0 takes as many as the
+   * budget of pcl::ExecutionContext allows when adding the points)
+   */
+  void
+  setNumberOfThreads(unsigned int nr_threads = 0);
+
+  /** \brief Get the number of threads used by \ref addPointsFromInputCloud. */
+  inline unsigned int
+  getNumberOfThreads() const
+  {
+    return (threads_);
+  }
+
   /** \brief Add points from input point cloud to octree. */
   void
   addPointsFromInputCloud();
@@ -430,6 +452,29 @@ protected:
   virtual void
   addPointIdx(uindex_t point_idx_arg);
 
+  /** \brief Store a point in a leaf container. Used by the bulk build, this must match
+   * what \ref addPointIdx stores in the leaf of the point.
+   * \param[in] leaf_container the leaf container of the voxel holding the point
+   * \param[in] point_idx_arg the index of the point in the dataset given by \a
+   * setInputCloud
+   */
+  virtual void
+  addPointIdxToLeaf(LeafContainerT& leaf_container, uindex_t point_idx_arg)
+  {
+    leaf_container.addPointIndex(point_idx_arg);
+  }
+
+  /** \brief Insert the points of the input cloud one at a time. */
+  void
+  addPointsFromInputCloudSequential();
+
+  /** \brief Build an empty octree of fixed depth from the input cloud in bulk.
+   * \return false if the octree is too deep for 64 bit Morton codes, in which case
+   * nothing was inserted
+   */
+  bool
+  addPointsFromInputCloudBulk();
+
   /** \brief Add point at index from input pointcloud dataset to octree
    * \param[in] leaf_node to be expanded
    * \param[in] parent_branch parent of leaf node to be expanded
@@ -597,6 +642,9 @@ protected:
    *  \note zero indicates a fixed/maximum depth octree structure
    * **/
   std::size_t max_objs_per_leaf_;
+
+  /** \brief The number of threads used by \ref addPointsFromInputCloud. */
+  unsigned int threads_;
 };
 
 } // namespace octree
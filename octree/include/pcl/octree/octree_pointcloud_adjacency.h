@@ -44,6 +44,8 @@
 
 #include <boost/graph/adjacency_list.hpp> // for adjacency_list
 
+#include <unordered_map> // for std::unordered_map
+
 namespace pcl {
 
 namespace octree {
@@ -131,12 +133,27 @@ public:
     return leaf_vector_.size();
   }
 
+  /** \brief Get the memory used by the octree, the neighbor lists of the leaves and
+   * the leaf vector.
+   *  \return number of bytes
+   */
+  std::size_t
+  getMemoryUsage() const
+  {
+    return OctreeBaseT::getMemoryUsage() +
+           leaf_vector_.capacity() * sizeof(LeafContainerT*);
+  }
+
   /** \brief Constructor.
    *
    * \param[in] resolution_arg Octree resolution at lowest octree level (voxel size) */
   OctreePointCloudAdjacency(const double resolution_arg);
 
   /** \brief Adds points from cloud to the octree.
+   *
+   * The leaves are looked up in a hash map of their keys while their neighbors are
+   * computed, so no tree descents are needed. The leaf data and the neighbors are
+   * computed in parallel with the number of threads set by setNumberOfThreads().
    *
    * \note This overrides addPointsFromInputCloud() from the OctreePointCloud class. */
   void
@@ -151,6 +168,8 @@ public:
   getLeafContainerAtPoint(const PointT& point_arg) const;
 
   /** \brief Computes an adjacency graph of voxel relations.
+   *
+   * The graph is filled directly from the neighbor arrays of the leaves.
    *
    * \warning This slows down rapidly as cloud size increases due to the number of
    * edges.
@@ -205,6 +224,31 @@ protected:
   void
   computeNeighbors(OctreeKey& key_arg, LeafContainerT* leaf_container);
 
+  /** \brief Hash of an octree key, for the lookup of leaves by key. */
+  struct OctreeKeyHash {
+    std::size_t
+    operator()(const OctreeKey& key) const
+    {
+      return std::hash<std::uint64_t>()(
+          ((static_cast<std::uint64_t>(key.x) << 32) | key.y) ^
+          (static_cast<std::uint64_t>(key.z) * 0x9E3779B97F4A7C15ull));
+    }
+  };
+
+  using LeafKeyMapT = std::unordered_map<OctreeKey, LeafContainerT*, OctreeKeyHash>;
+
+  /** \brief Fills in the neighbors fields for new voxels, looking them up in a map of
+   * all leaves instead of the tree.
+   *
+   * \param[in] key_arg Key of the voxel to check neighbors for
+   * \param[in] leaf_container Pointer to container of the leaf to check neighbors for
+   * \param[in] leaf_map Leaf containers of the octree by key
+   */
+  void
+  computeNeighbors(const OctreeKey& key_arg,
+                   LeafContainerT* leaf_container,
+                   const LeafKeyMapT& leaf_map) const;
+
   /** \brief Generates octree key for specified point (uses transform if provided).
    *
    * \param[in] point_arg Point to generate key for
@@ -39,12 +39,12 @@
 
 #pragma once
 
-#include <list> // for std::list
+#include <vector> // for std::vector
 
 namespace pcl {
 
 namespace octree {
-/** \brief @b Octree adjacency leaf container class- stores a list of pointers to
+/** \brief @b Octree adjacency leaf container class- stores an array of pointers to
  * neighbors, number of points added, and a DataT value \note This class implements a
  * leaf node that stores pointers to neighboring leaves \note This class also has a
  * virtual computeData function, which is called by
@@ -58,7 +58,7 @@ class OctreePointCloudAdjacencyContainer : public OctreeContainerBase {
   friend class OctreePointCloudAdjacency;
 
 public:
-  using NeighborListT = std::list<OctreePointCloudAdjacencyContainer<PointInT, DataT>*>;
+  using NeighborListT = std::vector<OctreePointCloudAdjacencyContainer<PointInT, DataT>*>;
   using const_iterator = typename NeighborListT::const_iterator;
   // const iterators to neighbors
   inline const_iterator
@@ -125,6 +125,15 @@ public:
     return num_points_;
   }
 
+  /** \brief Get the memory allocated for the neighbor list.
+   * \return number of bytes
+   */
+  std::size_t
+  getMemoryUsage() const override
+  {
+    return neighbors_.capacity() * sizeof(typename NeighborListT::value_type);
+  }
+
 protected:
   // iterators to neighbors
   using iterator = typename NeighborListT::iterator;
@@ -42,6 +42,10 @@
 #include <pcl/octree/octree_pointcloud.h>
 #include <pcl/memory.h>
 
+#include <cstdint>
+#include <utility>
+#include <vector>
+
 namespace pcl {
 namespace octree {
 
@@ -51,6 +55,9 @@ namespace octree {
  * (zero-copy). It allows to detect new leaf nodes and serialize their point indices
  *  \note The octree pointcloud is initialized with its voxel resolution. Its bounding
  * box is automatically adjusted or can be predefined.
+ *  \note For streams of frames, \ref addFrameFromInputCloud replaces the buffer
+ * switch and the point insertion. It reuses the nodes of the previous frame and
+ * reports new and vanished voxels without traversing the whole octree.
  * \tparam PointT type of point used in pointcloud
  * \ingroup octree
  * \author Julius Kammerl (julius@kammerl.de)
@@ -84,7 +91,46 @@ public:
                      Octree2BufBase<LeafContainerT, BranchContainerT>>(resolution_arg)
   {}
 
+  using OctreeT = Octree2BufBase<LeafContainerT, BranchContainerT>;
+  using LeafNode = typename OctreeT::LeafNode;
+  using BranchNode = typename OctreeT::BranchNode;
+
+  /** \brief Switch buffers and insert the input cloud as a new frame.
+   *
+   * The points are sorted along a Morton curve in parallel and their voxels are
+   * created in that order, taking over the nodes and leaf containers of the previous
+   * frame. Voxels that appeared or vanished compared to the previous frame are found
+   * by merging the sorted voxels of both frames, and only the nodes along the paths
+   * of vanished voxels are released. As long as the octree is only filled by this
+   * method, no step traverses the whole octree.
+   * \note The bounding box has to be defined beforehand (\ref defineBoundingBox)
+   * and stays fixed, points outside of it are ignored.
+   * \return false if the bounding box is not defined or the octree is too deep for 64
+   * bit Morton codes, in which case nothing was changed
+   */
+  bool
+  addFrameFromInputCloud();
+
+  /** \brief Get the keys of the voxels of the last frame added by \ref
+   * addFrameFromInputCloud that did not exist in the previous frame, in depth-first
+   * order. */
+  const std::vector<OctreeKey>&
+  getNewVoxelKeys() const
+  {
+    return (new_voxel_keys_);
+  }
+
+  /** \brief Get the keys of the voxels of the previous frame that do not exist in the
+   * last frame added by \ref addFrameFromInputCloud, in depth-first order. */
+  const std::vector<OctreeKey>&
+  getVanishedVoxelKeys() const
+  {
+    return (vanished_voxel_keys_);
+  }
+
   /** \brief Get a indices from all leaf nodes that did not exist in previous buffer.
+   * \note Right after \ref addFrameFromInputCloud the new leaf nodes are already
+   * known and the octree is not traversed.
    * \param indicesVector_arg: results are written to this vector of int indices
    * \param minPointsPerLeaf_arg: minimum amount of points required within leaf node to
    * become serialized.
@@ -94,9 +140,14 @@ public:
   getPointIndicesFromNewVoxels(Indices& indicesVector_arg,
                                const uindex_t minPointsPerLeaf_arg = 0)
   {
-
     std::vector<OctreeContainerPointIndices*> leaf_containers;
-    this->serializeNewLeafs(leaf_containers);
+    if (isFrameCurrent()) {
+      leaf_containers.reserve(new_leaves_.size());
+      for (LeafNode* leaf : new_leaves_)
+        leaf_containers.push_back(&leaf->getContainer());
+    }
+    else
+      this->serializeNewLeafs(leaf_containers);
 
     for (const auto& leaf_container : leaf_containers) {
       if (static_cast<uindex_t>(leaf_container->getSize()) >= minPointsPerLeaf_arg)
@@ -105,9 +156,58 @@ public:
 
     return (indicesVector_arg.size());
   }
+
+protected:
+  /** \brief Test if the octree is unchanged since the last \ref
+   * addFrameFromInputCloud, i.e. the voxels of that frame are still known. */
+  bool
+  isFrameCurrent() const
+  {
+    return (frame_valid_ && frame_buffer_ == this->buffer_selector_ &&
+            frame_depth_ == this->octree_depth_ &&
+            frame_codes_.size() == this->leaf_count_);
+  }
+
+  /** \brief Morton code of a voxel key, with the root level in the highest bits. */
+  std::uint64_t
+  getMortonCode(const OctreeKey& key_arg) const
+  {
+    std::uint64_t code = 0;
+    for (uindex_t depth_mask = this->depth_mask_; depth_mask; depth_mask >>= 1)
+      code = (code << 3) | key_arg.getChildIdxWithDepthMask(depth_mask);
+    return (code);
+  }
+
+  /** \brief Voxel key of a Morton code generated by \ref getMortonCode. */
+  OctreeKey
+  getKeyFromMortonCode(std::uint64_t code_arg) const
+  {
+    OctreeKey key;
+    for (uindex_t level = this->octree_depth_; level > 0; --level)
+      key.pushBranch(static_cast<unsigned char>((code_arg >> (3 * (level - 1))) & 7));
+    return (key);
+  }
+
+  /** \brief Whether \ref frame_codes_ describes the current buffer. */
+  bool frame_valid_{false};
+
+  /** \brief Buffer selector and depth of the octree after the last frame. */
+  unsigned char frame_buffer_{0};
+  uindex_t frame_depth_{0};
+
+  /** \brief Sorted Morton codes of the voxels of the last frame. */
+  std::vector<std::uint64_t> frame_codes_;
+
+  /** \brief Morton code and index of every point of the frame, kept to reuse memory. */
+  std::vector<std::pair<std::uint64_t, index_t>> entries_;
+
+  /** \brief Voxels that appeared or vanished with the last frame. */
+  std::vector<OctreeKey> new_voxel_keys_;
+  std::vector<OctreeKey> vanished_voxel_keys_;
+  std::vector<LeafNode*> new_leaves_;
 };
 } // namespace octree
 } // namespace pcl
 
-#define PCL_INSTANTIATE_OctreePointCloudChangeDetector(T)                              \
-  template class PCL_EXPORTS pcl::octree::OctreePointCloudChangeDetector<T>;
+// Note: Like OctreePointCloudVoxelCentroid, this octree type is not precompiled.
+#include <pcl/octree/impl/octree_pointcloud_changedetector.hpp>
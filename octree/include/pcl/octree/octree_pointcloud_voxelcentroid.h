@@ -175,6 +175,16 @@ public:
     container->addPoint(point);
   }
 
+  /** \brief Add the point at index \a pointIdx_arg to the centroid of a leaf.
+   * \param leaf_container
+   * \param pointIdx_arg
+   */
+  void
+  addPointIdxToLeaf(LeafContainerT& leaf_container, const uindex_t pointIdx_arg) override
+  {
+    leaf_container.addPoint((*this->input_)[pointIdx_arg]);
+  }
+
   /** \brief Get centroid for a single voxel addressed by a PointT point.
    * \param[in] point_arg point addressing a voxel in octree
    * \param[out] voxel_centroid_arg centroid is written to this PointT reference
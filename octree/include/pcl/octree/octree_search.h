@@ -39,6 +39,7 @@
 #pragma once
 
 #include <pcl/octree/octree_pointcloud.h>
+#include <pcl/octree/octree_snapshot.h>
 #include <pcl/point_cloud.h>
 
 namespace pcl {
@@ -48,14 +49,20 @@ namespace octree {
  * \note This class provides several methods for spatial neighbor search based on octree
  * structure
  * \tparam PointT type of point used in pointcloud
+ * \tparam NodeAllocatorT allocation policy of the octree nodes, e.g. OctreeNodeArena
  * \ingroup octree
  * \author Julius Kammerl (julius@kammerl.de)
  */
 template <typename PointT,
           typename LeafContainerT = OctreeContainerPointIndices,
-          typename BranchContainerT = OctreeContainerEmpty>
+          typename BranchContainerT = OctreeContainerEmpty,
+          typename NodeAllocatorT = OctreeHeapNodeAllocator>
 class OctreePointCloudSearch
-: public OctreePointCloud<PointT, LeafContainerT, BranchContainerT> {
+: public OctreePointCloud<
+      PointT,
+      LeafContainerT,
+      BranchContainerT,
+      OctreeBase<LeafContainerT, BranchContainerT, NodeAllocatorT>> {
 public:
   // public typedefs
   using IndicesPtr = shared_ptr<Indices>;
@@ -66,15 +73,23 @@ public:
   using PointCloudConstPtr = typename PointCloud::ConstPtr;
 
   // Boost shared pointers
-  using Ptr =
-      shared_ptr<OctreePointCloudSearch<PointT, LeafContainerT, BranchContainerT>>;
-  using ConstPtr = shared_ptr<
-      const OctreePointCloudSearch<PointT, LeafContainerT, BranchContainerT>>;
+  using Ptr = shared_ptr<
+      OctreePointCloudSearch<PointT, LeafContainerT, BranchContainerT, NodeAllocatorT>>;
+  using ConstPtr = shared_ptr<const OctreePointCloudSearch<PointT,
+                                                           LeafContainerT,
+                                                           BranchContainerT,
+                                                           NodeAllocatorT>>;
 
   // Eigen aligned allocator
-  using AlignedPointTVector = std::vector<PointT, Eigen::aligned_allocator<PointT>>;
-
-  using OctreeT = OctreePointCloud<PointT, LeafContainerT, BranchContainerT>;
+  using AlignedPointTVector = typename pcl::PointCloud<PointT>::VectorType;
+  using AlignedVector3fVector =
+      std::vector<Eigen::Vector3f, Eigen::aligned_allocator<Eigen::Vector3f>>;
+
+  using OctreeT =
+      OctreePointCloud<PointT,
+                       LeafContainerT,
+                       BranchContainerT,
+                       OctreeBase<LeafContainerT, BranchContainerT, NodeAllocatorT>>;
   using LeafNode = typename OctreeT::LeafNode;
   using BranchNode = typename OctreeT::BranchNode;
 
@@ -82,7 +97,7 @@ public:
    * \param[in] resolution octree resolution at lowest octree level
    */
   OctreePointCloudSearch(const double resolution)
-  : OctreePointCloud<PointT, LeafContainerT, BranchContainerT>(resolution)
+  : OctreeT(resolution)
   {}
 
   /** \brief Search for neighbors within a voxel at given point
@@ -273,6 +288,43 @@ public:
                              Indices& k_indices,
                              uindex_t max_voxel_count = 0) const;
 
+  /** \brief Get the centers of all voxels intersected by each ray of a batch. The rays
+   * are cast in parallel with the number of threads set by \ref setNumberOfThreads.
+   * \param[in] origins ray origins
+   * \param[in] directions ray direction vectors, one per origin
+   * \param[out] voxel_center_list the voxel centers of all rays, one ray after the other
+   * \param[out] ray_offsets the voxels of ray i are the elements ray_offsets[i] up to
+   * ray_offsets[i + 1] (exclusive) of \a voxel_center_list
+   * \param[in] max_voxel_count stop raycasting when this many voxels intersected (0:
+   * disable), per ray
+   * \return number of intersected voxels of all rays
+   */
+  std::size_t
+  getIntersectedVoxelCenters(const AlignedVector3fVector& origins,
+                             const AlignedVector3fVector& directions,
+                             AlignedPointTVector& voxel_center_list,
+                             std::vector<std::size_t>& ray_offsets,
+                             uindex_t max_voxel_count = 0) const;
+
+  /** \brief Get the point indices of all voxels intersected by each ray of a batch. The
+   * rays are cast in parallel with the number of threads set by \ref
+   * setNumberOfThreads.
+   * \param[in] origins ray origins
+   * \param[in] directions ray direction vectors, one per origin
+   * \param[out] k_indices the point indices of all rays, one ray after the other
+   * \param[out] ray_offsets the point indices of ray i are the elements ray_offsets[i]
+   * up to ray_offsets[i + 1] (exclusive) of \a k_indices
+   * \param[in] max_voxel_count stop raycasting when this many voxels intersected (0:
+   * disable), per ray
+   * \return number of intersected voxels of all rays
+   */
+  std::size_t
+  getIntersectedVoxelIndices(const AlignedVector3fVector& origins,
+                             const AlignedVector3fVector& directions,
+                             Indices& k_indices,
+                             std::vector<std::size_t>& ray_offsets,
+                             uindex_t max_voxel_count = 0) const;
+
   /** \brief Search for points within rectangular search area
    * Points exactly on the edges of the search rectangle are included.
    * \param[in] min_pt lower corner of search area
@@ -285,6 +337,16 @@ public:
             const Eigen::Vector3f& max_pt,
             Indices& k_indices) const;
 
+  /** \brief Convert the octree into a linearized, read-only snapshot.
+   * The snapshot stores nodes in a flat array and the points of every leaf as
+   * contiguous coordinate arrays. It answers the same queries as this class without
+   * pointer chasing and can be saved and attached again in a single I/O operation.
+   * \note The snapshot does not track later changes of the octree.
+   * \return the snapshot, empty if the octree has no points
+   */
+  OctreeSnapshot<PointT>
+  freeze() const;
+
 protected:
   //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
   // Octree-based search routines & helpers
@@ -509,6 +571,22 @@ protected:
                                       Indices& k_indices,
                                       uindex_t max_voxel_count) const;
 
+  /** \brief Cast a batch of rays in parallel and concatenate their results.
+   * \param[in] nr_rays number of rays
+   * \param[out] results the results of all rays, one ray after the other
+   * \param[out] ray_offsets the results of ray i are the elements ray_offsets[i] up to
+   * ray_offsets[i + 1] (exclusive) of \a results
+   * \param[in] cast_ray function (ray index, result container) casting a single ray,
+   * which replaces the content of the container and returns the number of voxels
+   * \return number of intersected voxels of all rays
+   */
+  template <typename ContainerT, typename RayCasterT>
+  std::size_t
+  castRays(std::size_t nr_rays,
+           ContainerT& results,
+           std::vector<std::size_t>& ray_offsets,
+           const RayCasterT& cast_ray) const;
+
   /** \brief Initialize raytracing algorithm
    * \param origin
    * \param direction
@@ -0,0 +1,369 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#pragma once
+
+#include <pcl/octree/octree_key.h>
+#include <pcl/octree/octree_nodes.h>
+#include <pcl/memory.h>
+#include <pcl/pcl_macros.h>
+#include <pcl/point_cloud.h>
+#include <pcl/types.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace pcl {
+namespace octree {
+
+/** \brief @b Linearized, read-only copy of an octree for fast point queries.
+ * \note The nodes are stored breadth-first in a single array without pointers, the
+ * children of a branch being contiguous. The points are stored depth-first as separate
+ * x, y, z and index arrays, so the points of every subtree form a contiguous range.
+ * Every node keeps the bounding box of its points for tight culling.
+ * \note The whole snapshot lives in one contiguous buffer that can be written to disk
+ * with a single write and used in place, e.g. from a memory-mapped file, see attach ().
+ * The buffer uses the native byte order.
+ * \note Create snapshots with OctreePointCloudSearch::freeze ().
+ * \tparam PointT type of the query points
+ * \ingroup octree
+ */
+template <typename PointT>
+class OctreeSnapshot {
+public:
+  using PointCloud = pcl::PointCloud<PointT>;
+
+  using Ptr = shared_ptr<OctreeSnapshot<PointT>>;
+  using ConstPtr = shared_ptr<const OctreeSnapshot<PointT>>;
+
+  /** \brief Node of the linearized octree */
+  struct Node {
+    /** \brief Bounding box of all points in the subtree */
+    float min_pt[3];
+    float max_pt[3];
+    /** \brief Index of the first child node, children are stored in child index order */
+    std::uint32_t child_begin;
+    /** \brief Range of the subtree points in the point arrays */
+    std::uint32_t point_begin;
+    std::uint32_t point_end;
+    /** \brief Bit i is set if the branch has a child with child index i */
+    std::uint8_t child_mask;
+    /** \brief Non-zero for leaf nodes */
+    std::uint8_t leaf;
+    std::uint8_t reserved[2];
+  };
+
+  /** \brief Empty constructor. */
+  OctreeSnapshot() = default;
+
+  /** \brief Copy constructor. A snapshot attached to an external buffer keeps using
+   * that buffer. */
+  OctreeSnapshot(const OctreeSnapshot& source) { *this = source; }
+
+  /** \brief Copy operator. */
+  OctreeSnapshot&
+  operator=(const OctreeSnapshot& source);
+
+  /** \brief Build the snapshot from the root branch of an octree.
+   * \note Prefer OctreePointCloudSearch::freeze (), which calls this method.
+   * \param[in] root root branch node of the octree
+   * \param[in] depth depth of the octree
+   * \param[in] resolution resolution of the octree leaf voxels
+   * \param[in] min_pt lower corner of the octree bounding box
+   * \param[in] max_pt upper corner of the octree bounding box
+   * \param[in] cloud the point cloud the leaf indices refer to
+   * \return "true" on success; "false" if the octree is too large for the snapshot
+   */
+  template <typename BranchNodeT, typename LeafNodeT>
+  bool
+  build(const BranchNodeT& root,
+        uindex_t depth,
+        double resolution,
+        const Eigen::Vector3d& min_pt,
+        const Eigen::Vector3d& max_pt,
+        const PointCloud& cloud);
+
+  /** \brief Use an existing snapshot buffer in place without copying it.
+   * \note The buffer has to stay valid and unchanged while it is attached and must be
+   * aligned to 8 bytes, which memory-mapped files always are.
+   * \param[in] data pointer to a buffer previously obtained with getData ()
+   * \param[in] size size of the buffer in bytes
+   * \return "true" if the buffer holds a valid snapshot; "false" otherwise
+   */
+  bool
+  attach(const void* data, std::size_t size);
+
+  /** \brief Write the snapshot buffer to a file.
+   * \param[in] file_name the output file name
+   * \return "true" on success; "false" otherwise
+   */
+  bool
+  save(const std::string& file_name) const;
+
+  /** \brief Read a snapshot written with save () into an owned buffer.
+   * \param[in] file_name the input file name
+   * \return "true" on success; "false" otherwise
+   */
+  bool
+  load(const std::string& file_name);
+
+  /** \brief Get a pointer to the snapshot buffer. */
+  inline const void*
+  getData() const
+  {
+    return (data_);
+  }
+
+  /** \brief Get the size of the snapshot buffer in bytes. */
+  inline std::size_t
+  getDataSize() const
+  {
+    return (size_);
+  }
+
+  /** \brief Check if the snapshot holds no octree. */
+  inline bool
+  empty() const
+  {
+    return (header_ == nullptr);
+  }
+
+  /** \brief Get the number of (branch and leaf) nodes. */
+  inline std::size_t
+  getNodeCount() const
+  {
+    return (header_ ? header_->nr_nodes : 0);
+  }
+
+  /** \brief Get the number of points stored in the leaf nodes. */
+  inline std::size_t
+  getPointCount() const
+  {
+    return (header_ ? static_cast<std::size_t>(header_->nr_points) : 0);
+  }
+
+  /** \brief Get the depth of the octree. */
+  inline uindex_t
+  getTreeDepth() const
+  {
+    return (header_ ? header_->depth : 0);
+  }
+
+  /** \brief Get the resolution of the octree leaf voxels. */
+  inline double
+  getResolution() const
+  {
+    return (header_ ? header_->resolution : 0.0);
+  }
+
+  /** \brief Search for neighbors within a voxel at given point
+   * \param[in] point point addressing a leaf node voxel
+   * \param[out] point_idx_data the resultant indices of the neighboring voxel points
+   * \return "true" if leaf node exist; "false" otherwise
+   */
+  bool
+  voxelSearch(const PointT& point, Indices& point_idx_data) const;
+
+  /** \brief Search for k-nearest neighbors at the query point.
+   * \param[in] p_q the given query point
+   * \param[in] k the number of neighbors to search for
+   * \param[out] k_indices the resultant indices of the neighboring points
+   * \param[out] k_sqr_distances the resultant squared distances to the neighboring
+   * points, in ascending order
+   * \return number of neighbors found
+   */
+  uindex_t
+  nearestKSearch(const PointT& p_q,
+                 uindex_t k,
+                 Indices& k_indices,
+                 std::vector<float>& k_sqr_distances) const;
+
+  /** \brief Search for all neighbors of query point that are within a given radius.
+   * \param[in] p_q the given query point
+   * \param[in] radius the radius of the sphere bounding all of p_q's neighbors
+   * \param[out] k_indices the resultant indices of the neighboring points
+   * \param[out] k_sqr_distances the resultant squared distances to the neighboring
+   * points
+   * \param[in] max_nn if given, bounds the maximum returned neighbors to this value
+   * \return number of neighbors found in radius
+   */
+  uindex_t
+  radiusSearch(const PointT& p_q,
+               const double radius,
+               Indices& k_indices,
+               std::vector<float>& k_sqr_distances,
+               uindex_t max_nn = 0) const;
+
+  /** \brief Get indices of all voxels that are intersected by a ray (origin,
+   * direction), in the order of OctreePointCloudSearch::getIntersectedVoxelIndices ().
+   * \param[in] origin ray origin
+   * \param[in] direction ray direction vector
+   * \param[out] k_indices resulting point indices from intersected voxels
+   * \param[in] max_voxel_count stop raycasting when this many voxels intersected (0:
+   * disable)
+   * \return number of intersected voxels
+   */
+  uindex_t
+  getIntersectedVoxelIndices(Eigen::Vector3f origin,
+                             Eigen::Vector3f direction,
+                             Indices& k_indices,
+                             uindex_t max_voxel_count = 0) const;
+
+protected:
+  /** \brief Leading block of the snapshot buffer */
+  struct Header {
+    std::uint32_t magic;
+    std::uint32_t version;
+    std::uint32_t index_size;
+    std::uint32_t depth;
+    std::uint32_t nr_nodes;
+    std::uint32_t reserved;
+    std::uint64_t nr_points;
+    double resolution;
+    double min_pt[3];
+    double max_pt[3];
+  };
+
+  /** \brief Byte offsets of the arrays in the snapshot buffer */
+  struct Layout {
+    std::size_t nodes;
+    std::size_t x;
+    std::size_t y;
+    std::size_t z;
+    std::size_t indices;
+    std::size_t size;
+  };
+
+  static Layout
+  computeLayout(std::size_t nr_nodes, std::size_t nr_points);
+
+  /** \brief Get the index of an existing child of a branch node */
+  static inline std::uint32_t
+  getChildNode(const Node& node, unsigned char child_idx)
+  {
+    std::uint32_t preceding = node.child_mask & ((1u << child_idx) - 1u);
+    preceding = preceding - ((preceding >> 1) & 0x55u);
+    preceding = (preceding & 0x33u) + ((preceding >> 2) & 0x33u);
+    return (node.child_begin + ((preceding + (preceding >> 4)) & 0x0Fu));
+  }
+
+  /** \brief Squared distance of the query point to the bounding box of a node */
+  static inline float
+  getSqrDistanceToBox(const Node& node, const float* point)
+  {
+    float sqr_distance = 0.0f;
+    for (int d = 0; d < 3; ++d) {
+      float diff = 0.0f;
+      if (point[d] < node.min_pt[d])
+        diff = node.min_pt[d] - point[d];
+      else if (point[d] > node.max_pt[d])
+        diff = point[d] - node.max_pt[d];
+      sqr_distance += diff * diff;
+    }
+    return (sqr_distance);
+  }
+
+  /** \brief Squared distance of the query point to the farthest corner of the bounding
+   * box of a node */
+  static inline float
+  getMaxSqrDistanceToBox(const Node& node, const float* point)
+  {
+    float sqr_distance = 0.0f;
+    for (int d = 0; d < 3; ++d) {
+      const float diff =
+          std::max(point[d] - node.min_pt[d], node.max_pt[d] - point[d]);
+      sqr_distance += diff * diff;
+    }
+    return (sqr_distance);
+  }
+
+  /** \brief Squared distance of the query point to a stored point */
+  inline float
+  getSqrDistance(std::size_t point_idx, const float* point) const
+  {
+    const float dx = x_[point_idx] - point[0];
+    const float dy = y_[point_idx] - point[1];
+    const float dz = z_[point_idx] - point[2];
+    return (dx * dx + dy * dy + dz * dz);
+  }
+
+  /** \brief Assign the points of a subtree and compute the node bounding boxes */
+  template <typename LeafNodeT>
+  void
+  linearizePoints(std::uint32_t node_idx,
+                  const std::vector<const OctreeNode*>& octree_nodes,
+                  const PointCloud& cloud,
+                  std::vector<Node>& nodes,
+                  Indices& indices) const;
+
+  /** \brief Recursive ray traversal, see
+   * OctreePointCloudSearch::getIntersectedVoxelIndicesRecursive () */
+  uindex_t
+  getIntersectedVoxelIndicesRecursive(double min_x,
+                                      double min_y,
+                                      double min_z,
+                                      double max_x,
+                                      double max_y,
+                                      double max_z,
+                                      unsigned char a,
+                                      std::uint32_t node_idx,
+                                      Indices& k_indices,
+                                      uindex_t max_voxel_count) const;
+
+  /** \brief Owned snapshot buffer, empty if attached to an external buffer */
+  std::vector<std::uint8_t> storage_;
+
+  const std::uint8_t* data_{nullptr};
+  std::size_t size_{0};
+
+  const Header* header_{nullptr};
+  const Node* nodes_{nullptr};
+  const float* x_{nullptr};
+  const float* y_{nullptr};
+  const float* z_{nullptr};
+  const index_t* indices_{nullptr};
+};
+
+} // namespace octree
+} // namespace pcl
+
+#ifdef PCL_NO_PRECOMPILE
+#include <pcl/octree/impl/octree_snapshot.hpp>
+#endif
@@ -53,6 +53,16 @@ template class PCL_EXPORTS
 template class PCL_EXPORTS pcl::octree::OctreeBase<pcl::octree::OctreeContainerEmpty,
                                                    pcl::octree::OctreeContainerEmpty>;
 
+template class PCL_EXPORTS
+    pcl::octree::OctreeBase<pcl::octree::OctreeContainerPointIndices,
+                            pcl::octree::OctreeContainerEmpty,
+                            pcl::octree::OctreeNodeArena>;
+
+template class PCL_EXPORTS
+    pcl::octree::Octree2BufBase<pcl::octree::OctreeContainerPointIndices,
+                                pcl::octree::OctreeContainerEmpty,
+                                pcl::octree::OctreeNodeArena>;
+
 #ifndef PCL_NO_PRECOMPILE
 #include <pcl/impl/instantiate.hpp>
 #include <pcl/point_types.h>
@@ -61,6 +71,7 @@ PCL_INSTANTIATE(OctreePointCloudSingleBufferWithLeafDataTVector, PCL_XYZ_POINT_T
 PCL_INSTANTIATE(OctreePointCloudDoubleBufferWithLeafDataTVector, PCL_XYZ_POINT_TYPES)
 
 PCL_INSTANTIATE(OctreePointCloudSearch, PCL_XYZ_POINT_TYPES)
+PCL_INSTANTIATE(OctreeSnapshot, PCL_XYZ_POINT_TYPES)
 
 // PCL_INSTANTIATE(OctreePointCloudSingleBufferWithLeafDataT, PCL_XYZ_POINT_TYPES)
 PCL_INSTANTIATE(OctreePointCloudSingleBufferWithEmptyLeaf, PCL_XYZ_POINT_TYPES)
@@ -46,12 +46,16 @@
 // JSON
 #include <pcl/outofcore/cJSON.h>
 
+#include <pcl/common/execution_context.h>
 #include <pcl/filters/random_sample.h>
 #include <pcl/filters/extract_indices.h>
+#include <pcl/io/pcd_io.h>
 
 // C++
+#include <algorithm>
 #include <iostream>
 #include <fstream>
+#include <random>
 #include <sstream>
 #include <string>
 #include <exception>
@@ -80,6 +84,8 @@ namespace pcl
       , metadata_ (new OutofcoreOctreeBaseMetadata ())
       , sample_percent_ (0.125)
       , lod_filter_ptr_ (new pcl::RandomSample<pcl::PCLPointCloud2> ())
+      , threads_ (1)
+      , bulk_memory_limit_ (static_cast<std::uint64_t> (1) << 30)
     {
       //validate the root filename
       if (!this->checkExtension (root_name))
@@ -108,6 +114,8 @@ namespace pcl
       , metadata_ (new OutofcoreOctreeBaseMetadata ())
       , sample_percent_ (0.125)
       , lod_filter_ptr_ (new pcl::RandomSample<pcl::PCLPointCloud2> ())
+      , threads_ (1)
+      , bulk_memory_limit_ (static_cast<std::uint64_t> (1) << 30)
     {
       //Enlarge the bounding box to a cube so our voxels will be cubes
       Eigen::Vector3d tmp_min = min;
@@ -130,6 +138,8 @@ namespace pcl
       , metadata_ (new OutofcoreOctreeBaseMetadata ())
       , sample_percent_ (0.125)
       , lod_filter_ptr_ (new pcl::RandomSample<pcl::PCLPointCloud2> ())
+      , threads_ (1)
+      , bulk_memory_limit_ (static_cast<std::uint64_t> (1) << 30)
     {
       //Create a new outofcore tree
       this->init (max_depth, min, max, root_node_name, coord_sys);
@@ -223,7 +233,7 @@ namespace pcl
     template<typename ContainerT, typename PointT> std::uint64_t
     OutofcoreOctreeBase<ContainerT, PointT>::addPointCloud (PointCloudConstPtr point_cloud)
     {
-      return (addDataToLeaf (point_cloud->points));
+      return (addDataToLeaf (AlignedPointTVector (point_cloud->begin (), point_cloud->end ())));
     }
     
     ////////////////////////////////////////////////////////////////////////////////
@@ -244,7 +254,7 @@ namespace pcl
     {
       // Lock the tree while writing
       std::unique_lock < std::shared_timed_mutex > lock (read_write_mutex_);
-      std::uint64_t pt_added = root_node_->addDataToLeaf_and_genLOD (point_cloud->points, false);
+      std::uint64_t pt_added = root_node_->addDataToLeaf_and_genLOD (AlignedPointTVector (point_cloud->begin (), point_cloud->end ()), false);
       return (pt_added);
     }
 
@@ -277,6 +287,276 @@ namespace pcl
 
     ////////////////////////////////////////////////////////////////////////////////
 
+    template<typename ContainerT, typename PointT> std::uint64_t
+    OutofcoreOctreeBase<ContainerT, PointT>::addPointCloudBulk (const pcl::PCLPointCloud2::Ptr &input_cloud)
+    {
+      if (!input_cloud || input_cloud->width*input_cloud->height == 0)
+        return (0);
+
+      // Lock the tree while writing
+      std::unique_lock < std::shared_timed_mutex > lock (read_write_mutex_);
+      return (this->bulkInsertLeaves (*input_cloud));
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+
+    template<typename ContainerT, typename PointT> std::uint64_t
+    OutofcoreOctreeBase<ContainerT, PointT>::addPointCloudBulk (const std::vector<boost::filesystem::path> &pcd_paths)
+    {
+      pcl::PCDReader reader;
+      auto same_fields = [] (const pcl::PCLPointCloud2 &a, const pcl::PCLPointCloud2 &b)
+      {
+        if (a.point_step != b.point_step || a.fields.size () != b.fields.size ())
+          return (false);
+        for (std::size_t i = 0; i < a.fields.size (); i++)
+        {
+          if (a.fields[i].name != b.fields[i].name || a.fields[i].offset != b.fields[i].offset ||
+              a.fields[i].datatype != b.fields[i].datatype || a.fields[i].count != b.fields[i].count)
+            return (false);
+        }
+        return (true);
+      };
+
+      // The fields of the first readable file are the reference for all the others
+      pcl::PCLPointCloud2 reference;
+      std::vector<boost::filesystem::path> inputs;
+      std::uint64_t total_bytes = 0;
+      for (const auto &path : pcd_paths)
+      {
+        pcl::PCLPointCloud2 header;
+        Eigen::Vector4f origin;
+        Eigen::Quaternionf orientation;
+        int pcd_version, data_type;
+        unsigned int data_idx;
+        if (reader.readHeader (path.string (), header, origin, orientation, pcd_version, data_type, data_idx) != 0)
+        {
+          PCL_ERROR ("[pcl::outofcore::OutofcoreOctreeBase::%s] Could not read the header of %s; skipping it\n", __FUNCTION__, path.string ().c_str ());
+          continue;
+        }
+
+        if (inputs.empty ())
+        {
+          reference = header;
+        }
+        else if (!same_fields (header, reference))
+        {
+          PCL_ERROR ("[pcl::outofcore::OutofcoreOctreeBase::%s] The fields of %s do not match the ones of %s; skipping it\n", __FUNCTION__, path.string ().c_str (), inputs.front ().string ().c_str ());
+          continue;
+        }
+
+        inputs.push_back (path);
+        total_bytes += static_cast<std::uint64_t> (header.width) * header.height * header.point_step;
+      }
+
+      if (inputs.empty ())
+        return (0);
+
+      // Lock the tree while writing
+      std::unique_lock < std::shared_timed_mutex > lock (read_write_mutex_);
+
+      // Shallowest depth at which the buckets of a uniform distribution would fit in memory
+      const std::uint64_t max_partition_depth = std::min<std::uint64_t> (this->getDepth (), 3);
+      std::uint64_t partition_depth = 0;
+      while (partition_depth < max_partition_depth && (total_bytes >> (3 * partition_depth)) > bulk_memory_limit_)
+        partition_depth++;
+
+      std::uint64_t pt_added = 0;
+
+      if (partition_depth == 0)
+      {
+        pcl::PCLPointCloud2 cloud;
+        for (const auto &path : inputs)
+        {
+          pcl::PCLPointCloud2 file_cloud;
+          if (reader.read (path.string (), file_cloud) != 0)
+          {
+            PCL_ERROR ("[pcl::outofcore::OutofcoreOctreeBase::%s] Could not read %s; skipping it\n", __FUNCTION__, path.string ().c_str ());
+            continue;
+          }
+          if (cloud.data.empty ())
+            cloud = std::move (file_cloud);
+          else
+            pcl::concatenate (cloud, file_cloud, cloud);
+        }
+        return (this->bulkInsertLeaves (cloud));
+      }
+
+      // Distribute the raw points by their node at partition_depth into temporary files
+      const boost::filesystem::path tmp_dir = root_node_->node_metadata_->getDirectoryPathname () / "bulk_insert.tmp";
+      boost::filesystem::remove_all (tmp_dir);
+      boost::filesystem::create_directories (tmp_dir);
+
+      const std::size_t nr_buckets = static_cast<std::size_t> (1) << (3 * partition_depth);
+      const std::size_t flush_size = std::max<std::size_t> (static_cast<std::size_t> (bulk_memory_limit_ / nr_buckets / 4), reference.point_step);
+      std::vector<std::vector<std::uint8_t> > buckets (nr_buckets);
+      auto flush = [&] (std::size_t bucket)
+      {
+        if (buckets[bucket].empty ())
+          return;
+        std::ofstream out ((tmp_dir / std::to_string (bucket)).string (), std::ios::binary | std::ios::app);
+        out.write (reinterpret_cast<const char*> (buckets[bucket].data ()), static_cast<std::streamsize> (buckets[bucket].size ()));
+        buckets[bucket].clear ();
+      };
+
+      const int x_idx = pcl::getFieldIndex (reference, "x");
+      const int y_idx = pcl::getFieldIndex (reference, "y");
+      const int z_idx = pcl::getFieldIndex (reference, "z");
+      if (x_idx == -1 || y_idx == -1 || z_idx == -1)
+      {
+        PCL_ERROR ("[pcl::outofcore::OutofcoreOctreeBase::%s] Input clouds have no x, y and z fields\n", __FUNCTION__);
+        boost::filesystem::remove_all (tmp_dir);
+        return (0);
+      }
+
+      for (const auto &path : inputs)
+      {
+        pcl::PCLPointCloud2 file_cloud;
+        if (reader.read (path.string (), file_cloud) != 0)
+        {
+          PCL_ERROR ("[pcl::outofcore::OutofcoreOctreeBase::%s] Could not read %s; skipping it\n", __FUNCTION__, path.string ().c_str ());
+          continue;
+        }
+
+        for (std::size_t offset = 0; offset + file_cloud.point_step <= file_cloud.data.size (); offset += file_cloud.point_step)
+        {
+          const std::uint8_t* row = &file_cloud.data[offset];
+          float x, y, z;
+          memcpy (&x, row + reference.fields[x_idx].offset, sizeof (float));
+          memcpy (&y, row + reference.fields[y_idx].offset, sizeof (float));
+          memcpy (&z, row + reference.fields[z_idx].offset, sizeof (float));
+          if (!std::isfinite (x) || !std::isfinite (y) || !std::isfinite (z))
+            continue;
+
+          const std::size_t bucket = static_cast<std::size_t> (this->computeNodeKey (Eigen::Vector3d (x, y, z), partition_depth));
+          buckets[bucket].insert (buckets[bucket].end (), row, row + file_cloud.point_step);
+          if (buckets[bucket].size () >= flush_size)
+            flush (bucket);
+        }
+      }
+      for (std::size_t bucket = 0; bucket < nr_buckets; bucket++)
+        flush (bucket);
+      buckets.clear ();
+
+      // Each bucket holds whole subtrees, so each leaf is written by exactly one of them
+      for (std::size_t bucket = 0; bucket < nr_buckets; bucket++)
+      {
+        const boost::filesystem::path bucket_path = tmp_dir / std::to_string (bucket);
+        if (!boost::filesystem::exists (bucket_path))
+          continue;
+
+        pcl::PCLPointCloud2 cloud;
+        cloud.fields = reference.fields;
+        cloud.point_step = reference.point_step;
+        cloud.is_bigendian = reference.is_bigendian;
+        cloud.is_dense = true;
+        cloud.data.resize (static_cast<std::size_t> (boost::filesystem::file_size (bucket_path)));
+        {
+          std::ifstream in (bucket_path.string (), std::ios::binary);
+          in.read (reinterpret_cast<char*> (cloud.data.data ()), static_cast<std::streamsize> (cloud.data.size ()));
+        }
+        cloud.width = static_cast<std::uint32_t> (cloud.data.size () / cloud.point_step);
+        cloud.height = 1;
+        cloud.row_step = cloud.width * cloud.point_step;
+
+        pt_added += this->bulkInsertLeaves (cloud);
+        boost::filesystem::remove (bucket_path);
+      }
+      boost::filesystem::remove_all (tmp_dir);
+
+      return (pt_added);
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+
+    template<typename ContainerT, typename PointT> std::uint64_t
+    OutofcoreOctreeBase<ContainerT, PointT>::bulkInsertLeaves (const pcl::PCLPointCloud2 &cloud)
+    {
+      const std::uint64_t depth = this->getDepth ();
+      const std::size_t nr_points = static_cast<std::size_t> (cloud.width) * cloud.height;
+      if (nr_points == 0)
+        return (0);
+
+      // The octant path of a leaf must fit in the 63 low bits of the key
+      if (depth > 21)
+      {
+        PCL_WARN ("[pcl::outofcore::OutofcoreOctreeBase::%s] Depth %lu is too deep for the bulk insertion; falling back to addPointCloud\n", __FUNCTION__, depth);
+        pcl::PCLPointCloud2::Ptr input_cloud (new pcl::PCLPointCloud2 (cloud));
+        return (root_node_->addPointCloud (input_cloud, false));
+      }
+
+      const int x_idx = pcl::getFieldIndex (cloud, "x");
+      const int y_idx = pcl::getFieldIndex (cloud, "y");
+      const int z_idx = pcl::getFieldIndex (cloud, "z");
+      if (x_idx == -1 || y_idx == -1 || z_idx == -1)
+      {
+        PCL_ERROR ("[pcl::outofcore::OutofcoreOctreeBase::%s] Input cloud has no x, y and z fields\n", __FUNCTION__);
+        return (0);
+      }
+      const std::uint32_t x_offset = cloud.fields[x_idx].offset;
+      const std::uint32_t y_offset = cloud.fields[y_idx].offset;
+      const std::uint32_t z_offset = cloud.fields[z_idx].offset;
+      const std::uint64_t invalid_key = std::numeric_limits<std::uint64_t>::max ();
+
+      const pcl::ThreadReservation reservation (threads_);
+      const unsigned int threads = reservation.getNumberOfThreads ();
+      // Leaf key of every point; sorting by (key, index) keeps the input order within each leaf
+      std::vector<std::pair<std::uint64_t, index_t> > keys (nr_points);
+#pragma omp parallel for \
+  default(none) \
+  shared(cloud, keys) \
+  firstprivate(depth, invalid_key, nr_points, x_offset, y_offset, z_offset) \
+  num_threads(threads)
+      for (std::ptrdiff_t i = 0; i < static_cast<std::ptrdiff_t> (nr_points); i++)
+      {
+        const std::uint8_t* row = &cloud.data[static_cast<std::size_t> (i) * cloud.point_step];
+        float x, y, z;
+        memcpy (&x, row + x_offset, sizeof (float));
+        memcpy (&y, row + y_offset, sizeof (float));
+        memcpy (&z, row + z_offset, sizeof (float));
+        if (!std::isfinite (x) || !std::isfinite (y) || !std::isfinite (z))
+          keys[i] = std::make_pair (invalid_key, static_cast<index_t> (i));
+        else
+          keys[i] = std::make_pair (this->computeNodeKey (Eigen::Vector3d (x, y, z), depth), static_cast<index_t> (i));
+      }
+      std::sort (keys.begin (), keys.end ());
+
+      // Create the missing leaves serially; only the writes below run in parallel
+      std::vector<OutofcoreNodeType*> leaves;
+      std::vector<pcl::Indices> leaf_indices;
+      for (std::size_t begin = 0; begin < keys.size () && keys[begin].first != invalid_key; )
+      {
+        std::size_t end = begin;
+        pcl::Indices indices;
+        for (; end < keys.size () && keys[end].first == keys[begin].first; end++)
+          indices.push_back (keys[end].second);
+
+        leaves.push_back (this->getOrCreateNode (keys[begin].first, depth));
+        leaf_indices.push_back (std::move (indices));
+        begin = end;
+      }
+      std::vector<std::pair<std::uint64_t, index_t> > ().swap (keys);
+
+      std::uint64_t pt_added = 0;
+#pragma omp parallel for \
+  default(none) \
+  shared(cloud, leaf_indices, leaves) \
+  reduction(+:pt_added) \
+  schedule(dynamic, 1) \
+  num_threads(threads)
+      for (std::ptrdiff_t i = 0; i < static_cast<std::ptrdiff_t> (leaves.size ()); i++)
+      {
+        pcl::PCLPointCloud2::Ptr leaf_cloud (new pcl::PCLPointCloud2 ());
+        pcl::copyPointCloud (cloud, leaf_indices[i], *leaf_cloud);
+        leaves[i]->payload_->insertRange (leaf_cloud);
+        pt_added += leaf_indices[i].size ();
+      }
+
+      this->incrementPointsInLOD (depth, pt_added);
+      return (pt_added);
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+
     template<typename Container, typename PointT> void
     OutofcoreOctreeBase<Container, PointT>::queryFrustum (const double planes[24], std::list<std::string>& file_names) const
     {
@@ -523,6 +803,31 @@ namespace pcl
 
     ////////////////////////////////////////////////////////////////////////////////
 
+    template<typename ContainerT, typename PointT> OutofcoreOctreeNodeMetadata::NodeCodec
+    OutofcoreOctreeBase<ContainerT, PointT>::getNodeCodec () const
+    {
+      std::shared_lock < std::shared_timed_mutex > lock (read_write_mutex_);
+      return (root_node_->getNodeCodec ());
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+
+    template<typename ContainerT, typename PointT> bool
+    OutofcoreOctreeBase<ContainerT, PointT>::setNodeCodec (const OutofcoreOctreeNodeMetadata::NodeCodec codec)
+    {
+      std::unique_lock < std::shared_timed_mutex > lock (read_write_mutex_);
+      if (root_node_->getNumChildren () > 0 || root_node_->size () > 0)
+      {
+        PCL_ERROR ("[pcl::outofcore::OutofcoreOctreeBase::%s] The codec must be set before adding points to the tree\n", __FUNCTION__);
+        return (false);
+      }
+
+      root_node_->setNodeCodec (codec);
+      return (true);
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+
     template<typename ContainerT, typename PointT> bool
     OutofcoreOctreeBase<ContainerT, PointT>::getBinDimension (double& x, double& y) const
     {
@@ -579,6 +884,116 @@ namespace pcl
 
     ////////////////////////////////////////////////////////////////////////////////
 
+    template<typename ContainerT, typename PointT> void
+    OutofcoreOctreeBase<ContainerT, PointT>::buildLODBulk ()
+    {
+      if (root_node_== nullptr)
+      {
+        PCL_ERROR ("Root node is null; aborting buildLODBulk.\n");
+        return;
+      }
+
+      std::unique_lock < std::shared_timed_mutex > lock (read_write_mutex_);
+
+      const std::uint64_t depth = this->getDepth ();
+
+      // Gather the nodes of every depth
+      std::vector<std::vector<BranchNode*> > levels (depth + 1);
+      levels[0].push_back (root_node_);
+      for (std::uint64_t d = 0; d < depth; d++)
+      {
+        for (BranchNode* node : levels[d])
+        {
+          if (node->hasUnloadedChildren ())
+            node->loadChildren (false);
+          for (std::size_t i = 0; i < 8; i++)
+          {
+            if (node->children_[i] != nullptr)
+              levels[d + 1].push_back (node->children_[i]);
+          }
+        }
+      }
+
+      const pcl::ThreadReservation reservation (threads_);
+      const unsigned int threads = reservation.getNumberOfThreads ();
+      std::mt19937 seed_generator (lod_filter_ptr_->getSeed ());
+
+      // Bottom-up, so that the children of a node already hold their LOD
+      for (std::int64_t d = static_cast<std::int64_t> (depth) - 1; d >= 0; d--)
+      {
+        const std::vector<BranchNode*> &nodes = levels[d];
+
+        // A leaf contributes the fraction buildLOD would take from it; a branch node, the fraction of its own LOD
+        const double leaf_sample_percent = pow (sample_percent_, static_cast<double> (depth + 1 - d));
+        const double branch_sample_percent = sample_percent_;
+
+        std::vector<unsigned int> seeds (nodes.size () * 8);
+        for (auto &seed : seeds)
+          seed = static_cast<unsigned int> (seed_generator ());
+
+        std::vector<std::uint64_t> lod_points (nodes.size (), 0);
+#pragma omp parallel for \
+  default(none) \
+  shared(lod_points, nodes, seeds) \
+  firstprivate(branch_sample_percent, depth, leaf_sample_percent) \
+  schedule(dynamic, 1) \
+  num_threads(threads)
+        for (std::ptrdiff_t i = 0; i < static_cast<std::ptrdiff_t> (nodes.size ()); i++)
+        {
+          BranchNode* node = nodes[i];
+
+          //clear this node in case we are updating the LOD
+          node->clearData ();
+
+          pcl::PCLPointCloud2::Ptr lod_cloud;
+          for (std::size_t c = 0; c < 8; c++)
+          {
+            BranchNode* child = node->children_[c];
+            if (child == nullptr)
+              continue;
+
+            pcl::PCLPointCloud2::Ptr child_cloud;
+            if (child->read (child_cloud) != 0 || !child_cloud)
+              continue;
+            const std::uint64_t nr_points = static_cast<std::uint64_t> (child_cloud->width) * child_cloud->height;
+            if (nr_points == 0)
+              continue;
+
+            const double percent = (child->getDepth () == depth) ? leaf_sample_percent : branch_sample_percent;
+            std::uint64_t sample_size = static_cast<std::uint64_t> (static_cast<double> (nr_points) * percent);
+            if (sample_size == 0)
+              sample_size = 1;
+
+            pcl::RandomSample<pcl::PCLPointCloud2> sampler;
+            sampler.setInputCloud (child_cloud);
+            sampler.setSample (static_cast<unsigned int> (sample_size));
+            sampler.setSeed (seeds[i * 8 + c]);
+            pcl::Indices sample_indices;
+            sampler.filter (sample_indices);
+
+            pcl::PCLPointCloud2 sample;
+            pcl::copyPointCloud (*child_cloud, sample_indices, sample);
+            if (!lod_cloud)
+              lod_cloud.reset (new pcl::PCLPointCloud2 (std::move (sample)));
+            else
+              pcl::concatenate (*lod_cloud, sample, *lod_cloud);
+          }
+
+          if (lod_cloud && lod_cloud->width*lod_cloud->height > 0)
+          {
+            node->payload_->insertRange (lod_cloud);
+            lod_points[i] = static_cast<std::uint64_t> (lod_cloud->width) * lod_cloud->height;
+          }
+        }
+
+        metadata_->setLODPoints (static_cast<std::uint64_t> (d), 0, false);
+        for (const auto &nr_points : lod_points)
+          this->incrementPointsInLOD (static_cast<std::uint64_t> (d), nr_points);
+      }
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+
     template<typename ContainerT, typename PointT> void
     OutofcoreOctreeBase<ContainerT, PointT>::printBoundingBox (OutofcoreOctreeBaseNode<ContainerT, PointT>& node) const
     {
@@ -696,6 +1111,61 @@ namespace pcl
 
     ////////////////////////////////////////////////////////////////////////////////
 
+    template<typename ContainerT, typename PointT> void
+    OutofcoreOctreeBase<ContainerT, PointT>::setNumberOfThreads (unsigned int nr_threads)
+    {
+      // 0 is resolved against the budget of pcl::ExecutionContext at compute time
+      threads_ = nr_threads;
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+
+    template<typename ContainerT, typename PointT> std::uint64_t
+    OutofcoreOctreeBase<ContainerT, PointT>::computeNodeKey (const Eigen::Vector3d &point, std::uint64_t depth) const
+    {
+      Eigen::Vector3d min_bb = root_node_->node_metadata_->getBoundingBoxMin ();
+      Eigen::Vector3d max_bb = root_node_->node_metadata_->getBoundingBoxMax ();
+
+      std::uint64_t key = 0;
+      for (std::uint64_t level = 0; level < depth; level++)
+      {
+        const Eigen::Vector3d mid = (max_bb + min_bb) / static_cast<double> (2.0);
+        const Eigen::Vector3d step = (max_bb - min_bb) / static_cast<double> (2.0);
+
+        const int x = (point[0] >= mid[0]) ? 1 : 0;
+        const int y = (point[1] >= mid[1]) ? 1 : 0;
+        const int z = (point[2] >= mid[2]) ? 1 : 0;
+        key = (key << 3) | static_cast<std::uint64_t> ((z << 2) | (y << 1) | x);
+
+        const Eigen::Vector3d start = min_bb;
+        min_bb = start + Eigen::Vector3d (static_cast<double> (x), static_cast<double> (y), static_cast<double> (z)).cwiseProduct (step);
+        max_bb = start + Eigen::Vector3d (static_cast<double> (x + 1), static_cast<double> (y + 1), static_cast<double> (z + 1)).cwiseProduct (step);
+      }
+      return (key);
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+
+    template<typename ContainerT, typename PointT> typename OutofcoreOctreeBase<ContainerT, PointT>::OutofcoreNodeType*
+    OutofcoreOctreeBase<ContainerT, PointT>::getOrCreateNode (std::uint64_t key, std::uint64_t depth)
+    {
+      OutofcoreNodeType* node = root_node_;
+      for (std::uint64_t level = depth; level > 0; level--)
+      {
+        const std::size_t octant = static_cast<std::size_t> ((key >> (3 * (level - 1))) & 7);
+
+        if (node->hasUnloadedChildren ())
+          node->loadChildren (false);
+        if (node->children_[octant] == nullptr)
+          node->createChild (octant);
+
+        node = node->children_[octant];
+      }
+      return (node);
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+
     template<typename ContainerT, typename PointT> bool
     OutofcoreOctreeBase<ContainerT, PointT>::checkExtension (const boost::filesystem::path& path_name)
     {
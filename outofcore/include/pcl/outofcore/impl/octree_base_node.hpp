@@ -250,7 +250,33 @@ namespace pcl
       node_metadata_->serializeMetadataToDisk ();
 
       // Create data container, ie octree_disk_container, octree_ram_container
+      resetPayload ();
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+
+    template<typename ContainerT, typename PointT> void
+    OutofcoreOctreeBaseNode<ContainerT, PointT>::resetPayload ()
+    {
       payload_.reset (new ContainerT (node_metadata_->getPCDFilename ()));
+      if (node_metadata_->getNodeCodec () == OutofcoreOctreeNodeMetadata::QUANTIZED)
+        payload_->setQuantization (node_metadata_->getBoundingBoxMin (), node_metadata_->getBoundingBoxMax ());
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+
+    template<typename ContainerT, typename PointT> void
+    OutofcoreOctreeBaseNode<ContainerT, PointT>::setNodeCodec (const OutofcoreOctreeNodeMetadata::NodeCodec codec)
+    {
+      if (!payload_->empty ())
+      {
+        PCL_ERROR ("[pcl::outofcore::OutofcoreOctreeBaseNode::%s] Can not change the codec of %s, which holds points\n", __FUNCTION__, node_metadata_->getPCDFilename ().c_str ());
+        return;
+      }
+
+      node_metadata_->setNodeCodec (codec);
+      resetPayload ();
+      this->saveIdx (false);
     }
 
     ////////////////////////////////////////////////////////////////////////////////
@@ -1725,6 +1751,7 @@ namespace pcl
       num_children_ = 0;
 
       node_metadata_->setBoundingBox (bb_min, bb_max);
+      node_metadata_->setNodeCodec (super->node_metadata_->getNodeCodec ());
 
       std::string uuid_idx;
       std::string uuid_cont;
@@ -1742,7 +1769,7 @@ namespace pcl
 
       boost::filesystem::create_directory (node_metadata_->getDirectoryPathname ());
 
-      payload_.reset (new ContainerT (node_metadata_->getPCDFilename ()));
+      resetPayload ();
       this->saveIdx (false);
     }
 
@@ -1934,7 +1961,7 @@ namespace pcl
         recFreeChildren ();      
 
       this->num_children_ = 0;
-      this->payload_.reset (new ContainerT (node_metadata_->getPCDFilename ()));
+      this->resetPayload ();
     }
 
     ////////////////////////////////////////////////////////////////////////////////
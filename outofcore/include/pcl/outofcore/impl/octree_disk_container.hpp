@@ -41,6 +41,7 @@
 #define PCL_OUTOFCORE_OCTREE_DISK_CONTAINER_IMPL_H_
 
 // C++
+#include <algorithm>
 #include <sstream>
 #include <cassert>
 #include <ctime>
@@ -85,6 +86,15 @@ namespace pcl
     template<typename PointT>
     const std::uint64_t OutofcoreOctreeDiskContainer<PointT>::WRITE_BUFF_MAX_ = static_cast<std::uint64_t> (2e12);
 
+    template<typename PointT>
+    std::mutex OutofcoreOctreeDiskContainer<PointT>::cache_mutex_;
+    template<typename PointT>
+    std::list<typename OutofcoreOctreeDiskContainer<PointT>::CachedFile> OutofcoreOctreeDiskContainer<PointT>::cache_;
+    template<typename PointT>
+    std::uint64_t OutofcoreOctreeDiskContainer<PointT>::cache_bytes_ = 0;
+    template<typename PointT>
+    std::uint64_t OutofcoreOctreeDiskContainer<PointT>::cache_capacity_ = static_cast<std::uint64_t> (256) << 20;
+
     template<typename PointT> void
     OutofcoreOctreeDiskContainer<PointT>::getRandomUUIDString (std::string& s)
     {
@@ -100,10 +110,293 @@ namespace pcl
     }
     ////////////////////////////////////////////////////////////////////////////////
 
+    template<typename PointT> void
+    OutofcoreOctreeDiskContainer<PointT>::setReadCacheSize (std::uint64_t bytes)
+    {
+      std::lock_guard<std::mutex> lock (cache_mutex_);
+      cache_capacity_ = bytes;
+      trimReadCache ();
+    }
+    ////////////////////////////////////////////////////////////////////////////////
+
+    template<typename PointT> std::uint64_t
+    OutofcoreOctreeDiskContainer<PointT>::getReadCacheSize ()
+    {
+      std::lock_guard<std::mutex> lock (cache_mutex_);
+      return (cache_capacity_);
+    }
+    ////////////////////////////////////////////////////////////////////////////////
+
+    template<typename PointT> void
+    OutofcoreOctreeDiskContainer<PointT>::trimReadCache ()
+    {
+      while (cache_bytes_ > cache_capacity_ && !cache_.empty ())
+      {
+        cache_bytes_ -= cache_.back ().points->size () * sizeof (PointT);
+        cache_.pop_back ();
+      }
+    }
+    ////////////////////////////////////////////////////////////////////////////////
+
+    template<typename PointT> void
+    OutofcoreOctreeDiskContainer<PointT>::invalidateReadCache () const
+    {
+      std::lock_guard<std::mutex> lock (cache_mutex_);
+      for (auto it = cache_.begin (); it != cache_.end (); ++it)
+      {
+        if (it->filename == disk_storage_filename_)
+        {
+          cache_bytes_ -= it->points->size () * sizeof (PointT);
+          cache_.erase (it);
+          return;
+        }
+      }
+    }
+    ////////////////////////////////////////////////////////////////////////////////
+
+    template<typename PointT> void
+    OutofcoreOctreeDiskContainer<PointT>::setQuantization (const Eigen::Vector3d& min_bb, const Eigen::Vector3d& max_bb)
+    {
+      quantize_ = true;
+      quantize_min_ = min_bb;
+      quantize_max_ = max_bb;
+      invalidateReadCache ();
+    }
+    ////////////////////////////////////////////////////////////////////////////////
+
+    template<typename PointT> void
+    OutofcoreOctreeDiskContainer<PointT>::quantize (const pcl::PCLPointCloud2 &input, pcl::PCLPointCloud2 &output) const
+    {
+      output.header = input.header;
+      output.width = input.width;
+      output.height = input.height;
+      output.is_bigendian = input.is_bigendian;
+      output.is_dense = input.is_dense;
+      output.fields.clear ();
+
+      // For each field, the coordinate it holds (or -1) and its offset in the input
+      std::vector<int> axes;
+      std::vector<std::uint32_t> input_offsets;
+      std::uint32_t offset = 0;
+      for (const auto &field : input.fields)
+      {
+        pcl::PCLPointField quantized_field = field;
+        int axis = -1;
+        if (field.datatype == pcl::PCLPointField::FLOAT32 && field.count == 1 && field.name.size () == 1 &&
+            field.name[0] >= 'x' && field.name[0] <= 'z')
+        {
+          axis = field.name[0] - 'x';
+          quantized_field.datatype = pcl::PCLPointField::UINT16;
+        }
+        quantized_field.offset = offset;
+        offset += quantized_field.count * pcl::getFieldSize (quantized_field.datatype);
+
+        axes.push_back (axis);
+        input_offsets.push_back (field.offset);
+        output.fields.push_back (quantized_field);
+      }
+
+      const Eigen::Vector3d extent = quantize_max_ - quantize_min_;
+      double scale[3];
+      for (int i = 0; i < 3; i++)
+        scale[i] = (extent[i] > 0.0) ? (65535.0 / extent[i]) : 0.0;
+
+      const std::size_t nr_points = static_cast<std::size_t> (input.width) * input.height;
+      output.point_step = offset;
+      output.row_step = output.point_step * output.width;
+      output.data.resize (nr_points * output.point_step);
+
+      for (std::size_t i = 0; i < nr_points; i++)
+      {
+        const std::uint8_t *src = &input.data[i * input.point_step];
+        std::uint8_t *dst = &output.data[i * output.point_step];
+        for (std::size_t f = 0; f < output.fields.size (); f++)
+        {
+          if (axes[f] < 0)
+          {
+            memcpy (dst + output.fields[f].offset, src + input_offsets[f], output.fields[f].count * pcl::getFieldSize (output.fields[f].datatype));
+            continue;
+          }
+          float value;
+          memcpy (&value, src + input_offsets[f], sizeof (float));
+          const double q = std::min (std::max ((value - quantize_min_[axes[f]]) * scale[axes[f]], 0.0), 65535.0);
+          const auto quantized = static_cast<std::uint16_t> (q + 0.5);
+          memcpy (dst + output.fields[f].offset, &quantized, sizeof (std::uint16_t));
+        }
+      }
+    }
+    ////////////////////////////////////////////////////////////////////////////////
+
+    template<typename PointT> void
+    OutofcoreOctreeDiskContainer<PointT>::dequantize (const pcl::PCLPointCloud2 &input, pcl::PCLPointCloud2 &output) const
+    {
+      output.header = input.header;
+      output.width = input.width;
+      output.height = input.height;
+      output.is_bigendian = input.is_bigendian;
+      output.is_dense = input.is_dense;
+      output.fields.clear ();
+
+      std::vector<int> axes;
+      std::vector<std::uint32_t> input_offsets;
+      std::uint32_t offset = 0;
+      for (const auto &field : input.fields)
+      {
+        pcl::PCLPointField float_field = field;
+        int axis = -1;
+        if (field.datatype == pcl::PCLPointField::UINT16 && field.count == 1 && field.name.size () == 1 &&
+            field.name[0] >= 'x' && field.name[0] <= 'z')
+        {
+          axis = field.name[0] - 'x';
+          float_field.datatype = pcl::PCLPointField::FLOAT32;
+        }
+        float_field.offset = offset;
+        offset += float_field.count * pcl::getFieldSize (float_field.datatype);
+
+        axes.push_back (axis);
+        input_offsets.push_back (field.offset);
+        output.fields.push_back (float_field);
+      }
+
+      const Eigen::Vector3d step = (quantize_max_ - quantize_min_) / 65535.0;
+
+      const std::size_t nr_points = static_cast<std::size_t> (input.width) * input.height;
+      output.point_step = offset;
+      output.row_step = output.point_step * output.width;
+      output.data.resize (nr_points * output.point_step);
+
+      for (std::size_t i = 0; i < nr_points; i++)
+      {
+        const std::uint8_t *src = &input.data[i * input.point_step];
+        std::uint8_t *dst = &output.data[i * output.point_step];
+        for (std::size_t f = 0; f < output.fields.size (); f++)
+        {
+          if (axes[f] < 0)
+          {
+            memcpy (dst + output.fields[f].offset, src + input_offsets[f], output.fields[f].count * pcl::getFieldSize (output.fields[f].datatype));
+            continue;
+          }
+          std::uint16_t quantized;
+          memcpy (&quantized, src + input_offsets[f], sizeof (std::uint16_t));
+          const auto value = static_cast<float> (quantize_min_[axes[f]] + quantized * step[axes[f]]);
+          memcpy (dst + output.fields[f].offset, &value, sizeof (float));
+        }
+      }
+    }
+    ////////////////////////////////////////////////////////////////////////////////
+
+    template<typename PointT> int
+    OutofcoreOctreeDiskContainer<PointT>::readCloud (pcl::PCLPointCloud2 &cloud) const
+    {
+      pcl::PCDReader reader;
+      if (!quantize_)
+        return (reader.read (disk_storage_filename_, cloud));
+
+      pcl::PCLPointCloud2 quantized;
+      const int res = reader.read (disk_storage_filename_, quantized);
+      if (res == 0)
+        dequantize (quantized, cloud);
+      return (res);
+    }
+    ////////////////////////////////////////////////////////////////////////////////
+
+    template<typename PointT> int
+    OutofcoreOctreeDiskContainer<PointT>::readCloud (pcl::PointCloud<PointT> &cloud) const
+    {
+      if (!quantize_)
+      {
+        pcl::PCDReader reader;
+        return (reader.read (disk_storage_filename_, cloud));
+      }
+
+      pcl::PCLPointCloud2 blob;
+      const int res = readCloud (blob);
+      if (res == 0)
+        pcl::fromPCLPointCloud2 (blob, cloud);
+      return (res);
+    }
+    ////////////////////////////////////////////////////////////////////////////////
+
+    template<typename PointT> int
+    OutofcoreOctreeDiskContainer<PointT>::writeCloud (const pcl::PCLPointCloud2 &cloud) const
+    {
+      pcl::PCDWriter writer;
+      if (!quantize_)
+        return (writer.writeBinaryCompressed (disk_storage_filename_, cloud));
+
+      pcl::PCLPointCloud2 quantized;
+      quantize (cloud, quantized);
+      return (writer.writeBinaryCompressed (disk_storage_filename_, quantized));
+    }
+    ////////////////////////////////////////////////////////////////////////////////
+
+    template<typename PointT> int
+    OutofcoreOctreeDiskContainer<PointT>::writeCloud (const pcl::PointCloud<PointT> &cloud) const
+    {
+      if (!quantize_)
+      {
+        pcl::PCDWriter writer;
+        return (writer.writeBinaryCompressed (disk_storage_filename_, cloud));
+      }
+
+      pcl::PCLPointCloud2 blob;
+      pcl::toPCLPointCloud2 (cloud, blob);
+      return (writeCloud (blob));
+    }
+    ////////////////////////////////////////////////////////////////////////////////
+
+    template<typename PointT> shared_ptr<const typename OutofcoreOctreeDiskContainer<PointT>::AlignedPointTVector>
+    OutofcoreOctreeDiskContainer<PointT>::readFile ()
+    {
+      {
+        std::lock_guard<std::mutex> lock (cache_mutex_);
+        for (auto it = cache_.begin (); it != cache_.end (); ++it)
+        {
+          if (it->filename == disk_storage_filename_)
+          {
+            cache_.splice (cache_.begin (), cache_, it);
+            filelen_ = it->points->size ();
+            return (it->points);
+          }
+        }
+      }
+
+      // Decode the whole file once, outside of the lock so that other nodes can be read concurrently
+      pcl::PointCloud<PointT> cloud;
+      if (boost::filesystem::exists (disk_storage_filename_))
+      {
+        int res = readCloud (cloud);
+        pcl::utils::ignore(res);
+        assert (res == 0);
+      }
+      shared_ptr<AlignedPointTVector> points (new AlignedPointTVector);
+      points->assign (cloud.begin (), cloud.end ());
+      filelen_ = points->size ();
+
+      std::lock_guard<std::mutex> lock (cache_mutex_);
+      for (auto it = cache_.begin (); it != cache_.end (); ++it)
+      {
+        if (it->filename == disk_storage_filename_)
+        {
+          cache_bytes_ -= it->points->size () * sizeof (PointT);
+          cache_.erase (it);
+          break;
+        }
+      }
+      cache_.push_front (CachedFile {disk_storage_filename_, points});
+      cache_bytes_ += points->size () * sizeof (PointT);
+      trimReadCache ();
+      return (points);
+    }
+    ////////////////////////////////////////////////////////////////////////////////
+
     template<typename PointT>
     OutofcoreOctreeDiskContainer<PointT>::OutofcoreOctreeDiskContainer () 
       : filelen_ (0)
       , writebuff_ (0)
+      , quantize_ (false)
+      , quantize_min_ (Eigen::Vector3d::Zero ())
+      , quantize_max_ (Eigen::Vector3d::Zero ())
     {
       getRandomUUIDString (disk_storage_filename_);
       filelen_ = 0;
@@ -114,6 +407,9 @@ namespace pcl
     OutofcoreOctreeDiskContainer<PointT>::OutofcoreOctreeDiskContainer (const boost::filesystem::path& path)
       : filelen_ (0)
       , writebuff_ (0)
+      , quantize_ (false)
+      , quantize_min_ (Eigen::Vector3d::Zero ())
+      , quantize_max_ (Eigen::Vector3d::Zero ())
     {
       if (boost::filesystem::exists (path))
       {
@@ -174,18 +470,14 @@ namespace pcl
         cloud->width = writebuff_.size ();
         cloud->height = 1;
 
-        cloud->points = writebuff_;
-
-        //write data to a pcd file
-        pcl::PCDWriter writer;
-
+        cloud->points.assign (writebuff_.begin (), writebuff_.end ());
 
         PCL_WARN ("[pcl::outofcore::OutofcoreOctreeDiskContainer::%s] Flushing writebuffer in a dangerous way to file %s. This might overwrite data in destination file\n", __FUNCTION__, disk_storage_filename_.c_str ());
         
-        // Write ascii for now to debug
-        int res = writer.writeBinaryCompressed (disk_storage_filename_, *cloud);
+        int res = writeCloud (*cloud);
         pcl::utils::ignore(res);
         assert (res == 0);
+        invalidateReadCache ();
         if (force_cache_dealloc)
         {
           writebuff_.resize (0);
@@ -249,15 +541,20 @@ namespace pcl
         PCL_THROW_EXCEPTION (PCLException, "[pcl::outofcore::OutofcoreOctreeDiskContainer] Outofcore Octree Exception: Read indices exceed range");
       }
 
-      pcl::PCDReader reader;
-      typename pcl::PointCloud<PointT>::Ptr cloud (new pcl::PointCloud<PointT> ());
-      
-      int res = reader.read (disk_storage_filename_, *cloud);
-      pcl::utils::ignore(res);
-      assert (res == 0);
-      
-      dst.insert(dst.end(), cloud->cbegin(), cloud->cend());
-      
+      // Points [start, start + count) span the file, then the write buffer
+      const shared_ptr<const AlignedPointTVector> points = readFile ();
+      const std::uint64_t filelen = points->size ();
+      const std::uint64_t end = start + count;
+      if (start < filelen)
+      {
+        dst.insert (dst.end (), points->cbegin () + start, points->cbegin () + std::min (end, filelen));
+      }
+      if (end > filelen)
+      {
+        const std::uint64_t buffstart = (start > filelen) ? (start - filelen) : 0;
+        const std::uint64_t buffend = std::min (end - filelen, static_cast<std::uint64_t> (writebuff_.size ()));
+        dst.insert (dst.end (), writebuff_.cbegin () + buffstart, writebuff_.cbegin () + buffend);
+      }
     }
     ////////////////////////////////////////////////////////////////////////////////
 
@@ -271,6 +568,9 @@ namespace pcl
 
       dst.clear ();
 
+      // Decode the file (or get it from the cache) first, this also brings filelen_ up to date
+      const shared_ptr<const AlignedPointTVector> points = readFile ();
+
       std::uint64_t filestart = 0;
       std::uint64_t filecount = 0;
 
@@ -330,25 +630,11 @@ namespace pcl
         }
         std::sort (offsets.begin (), offsets.end ());
 
-        FILE* f = fopen (disk_storage_filename_.c_str (), "rbe");
-        assert (f != NULL);
-        PointT p;
-        char* loc = reinterpret_cast<char*> (&p);
-        
-        std::uint64_t filesamp = offsets.size ();
-        for (std::uint64_t i = 0; i < filesamp; i++)
+        dst.reserve (dst.size () + offsets.size ());
+        for (const auto &offset : offsets)
         {
-          int seekret = _fseeki64 (f, offsets[i] * static_cast<std::uint64_t> (sizeof(PointT)), SEEK_SET);
-          pcl::utils::ignore(seekret);
-          assert (seekret == 0);
-          std::size_t readlen = fread (loc, sizeof(PointT), 1, f);
-          pcl::utils::ignore(readlen);
-          assert (readlen == 1);
-
-          dst.push_back (p);
+          dst.push_back ((*points)[offset]);
         }
-
-        fclose (f);
       }
     }
     ////////////////////////////////////////////////////////////////////////////////
@@ -364,6 +650,9 @@ namespace pcl
 
       dst.clear ();
 
+      // Decode the file (or get it from the cache) first, this also brings filelen_ up to date
+      const shared_ptr<const AlignedPointTVector> points = readFile ();
+
       std::uint64_t filestart = 0;
       std::uint64_t filecount = 0;
 
@@ -429,24 +718,11 @@ namespace pcl
         }
         std::sort (offsets.begin (), offsets.end ());
 
-        FILE* f = fopen (disk_storage_filename_.c_str (), "rbe");
-        assert (f != NULL);
-        PointT p;
-        char* loc = reinterpret_cast<char*> (&p);
-        for (std::uint64_t i = 0; i < filesamp; i++)
+        dst.reserve (dst.size () + filesamp);
+        for (const auto &offset : offsets)
         {
-          int seekret = _fseeki64 (f, offsets[i] * static_cast<std::uint64_t> (sizeof(PointT)), SEEK_SET);
-          pcl::utils::ignore(seekret);
-          assert (seekret == 0);
-          std::size_t readlen = fread (loc, sizeof(PointT), 1, f);
-          pcl::utils::ignore(readlen);
-          assert (readlen == 1);
-
-          dst.push_back (p);
+          dst.push_back ((*points)[offset]);
         }
-        int res = fclose (f);
-        pcl::utils::ignore(res);
-        assert (res == 0);
       }
     }
     ////////////////////////////////////////////////////////////////////////////////
@@ -473,8 +749,7 @@ namespace pcl
       if (boost::filesystem::exists (disk_storage_filename_))
       {
         // Open the existing file
-        pcl::PCDReader reader;
-        int res = reader.read (disk_storage_filename_, *tmp_cloud);
+        int res = readCloud (*tmp_cloud);
         pcl::utils::ignore(res);
         assert (res == 0);
       }
@@ -498,11 +773,11 @@ namespace pcl
       tmp_cloud->width = tmp_cloud->size ();
             
       //save and close
-      PCDWriter writer;
-      
-      int res = writer.writeBinaryCompressed (disk_storage_filename_, *tmp_cloud);
+      int res = writeCloud (*tmp_cloud);
       pcl::utils::ignore(res);
       assert (res == 0);
+      invalidateReadCache ();
+      filelen_ = tmp_cloud->size ();
     }
   
     ////////////////////////////////////////////////////////////////////////////////
@@ -516,11 +791,9 @@ namespace pcl
       if (boost::filesystem::exists (disk_storage_filename_))
       {
         //open the existing file
-        pcl::PCDReader reader;
-        int res = reader.read (disk_storage_filename_, *tmp_cloud);
+        int res = readCloud (*tmp_cloud);
         pcl::utils::ignore(res);
         assert (res == 0);
-        pcl::PCDWriter writer;
         PCL_DEBUG ("[pcl::outofcore::OutofcoreOctreeDiskContainer::%s] Concatenating point cloud from %s to new cloud\n", __FUNCTION__, disk_storage_filename_.c_str ());
         
         std::size_t previous_num_pts = tmp_cloud->width*tmp_cloud->height + input_cloud->width*input_cloud->height;
@@ -533,17 +806,18 @@ namespace pcl
         
         assert (previous_num_pts == res_pts);
         
-        writer.writeBinaryCompressed (disk_storage_filename_, *tmp_cloud);
+        writeCloud (*tmp_cloud);
+        filelen_ = res_pts;
             
       }
       else //otherwise create the point cloud which will be saved to the pcd file for the first time
       {
-        pcl::PCDWriter writer;
-        int res = writer.writeBinaryCompressed (disk_storage_filename_, *input_cloud);
+        int res = writeCloud (*input_cloud);
         pcl::utils::ignore(res);
         assert (res == 0);
+        filelen_ = input_cloud->width * input_cloud->height;
       }            
-
+      invalidateReadCache ();
     }
 
     ////////////////////////////////////////////////////////////////////////////////
@@ -551,16 +825,10 @@ namespace pcl
     template<typename PointT> void
     OutofcoreOctreeDiskContainer<PointT>::readRange (const std::uint64_t, const std::uint64_t, pcl::PCLPointCloud2::Ptr& dst)
     {
-      pcl::PCDReader reader;
-
-      Eigen::Vector4f  origin;
-      Eigen::Quaternionf  orientation;
-
       if (boost::filesystem::exists (disk_storage_filename_))
       {
 //            PCL_INFO ("[pcl::outofcore::OutofcoreOctreeDiskContainer::%s] Reading points from disk from %s.\n", __FUNCTION__ , disk_storage_filename_->c_str ());
-        int  pcd_version;
-        int res = reader.read (disk_storage_filename_, *dst, origin, orientation, pcd_version);
+        int res = readCloud (*dst);
         pcl::utils::ignore(res);
         assert (res != -1);
       }
@@ -580,7 +848,7 @@ namespace pcl
       if (boost::filesystem::exists (disk_storage_filename_))
       {
 //            PCL_INFO ("[pcl::outofcore::OutofcoreOctreeDiskContainer::%s] Reading points from disk from %s.\n", __FUNCTION__ , disk_storage_filename_->c_str ());
-        int res = pcl::io::loadPCDFile (disk_storage_filename_, *temp_output_cloud);
+        int res = readCloud (*temp_output_cloud);
         pcl::utils::ignore(res);
         assert (res != -1);
         if(res == -1)
@@ -632,9 +900,8 @@ namespace pcl
       // If there's a pcd file with data, read it in from disk for appending
       if (boost::filesystem::exists (disk_storage_filename_))
       {
-        pcl::PCDReader reader;
         // Open it
-        int res = reader.read (disk_storage_filename_, *tmp_cloud);
+        int res = readCloud (*tmp_cloud);
         pcl::utils::ignore(res); 
         assert (res == 0);
       }
@@ -660,11 +927,11 @@ namespace pcl
       tmp_cloud->height = 1;
             
       //save and close
-      PCDWriter writer;
-
-      int res = writer.writeBinaryCompressed (disk_storage_filename_, *tmp_cloud);
+      int res = writeCloud (*tmp_cloud);
       pcl::utils::ignore(res);
       assert (res == 0);
+      invalidateReadCache ();
+      filelen_ = tmp_cloud->size ();
     }
     ////////////////////////////////////////////////////////////////////////////////
 
@@ -0,0 +1,366 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef PCL_OUTOFCORE_QUERY_SERVICE_IMPL_H_
+#define PCL_OUTOFCORE_QUERY_SERVICE_IMPL_H_
+
+#include <pcl/outofcore/outofcore_query_service.h>
+#include <pcl/common/execution_context.h>
+#include <pcl/outofcore/outofcore_breadth_first_iterator.h>
+#include <pcl/visualization/common/common.h>
+
+#include <algorithm>
+#include <iterator>
+
+namespace pcl
+{
+  namespace outofcore
+  {
+
+    ////////////////////////////////////////////////////////////////////////////////
+
+    template<typename ContainerT, typename PointT>
+    OutofcoreQueryService<ContainerT, PointT>::OutofcoreQueryService (const OctreeDiskPtr &octree, unsigned int nr_threads)
+      : octree_ (octree)
+      , point_budget_ (10000000)
+      , pixel_threshold_ (10000.0f)
+      , generation_ (0)
+      , cache_ (static_cast<std::size_t> (512) << 20)
+      , stop_ (false)
+    {
+      // The loaders are started up front, so 0 is resolved against the budget right away
+      if (nr_threads == 0)
+        nr_threads = pcl::ExecutionContext::getThreadBudget ();
+
+      for (unsigned int i = 0; i < nr_threads; i++)
+        threads_.emplace_back (&OutofcoreQueryService<ContainerT, PointT>::loadThread, this);
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+
+    template<typename ContainerT, typename PointT>
+    OutofcoreQueryService<ContainerT, PointT>::~OutofcoreQueryService ()
+    {
+      {
+        std::lock_guard<std::mutex> lock (mutex_);
+        stop_ = true;
+        requests_.clear ();
+      }
+      requests_ready_.notify_all ();
+
+      for (auto &thread : threads_)
+        thread.join ();
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+
+    template<typename ContainerT, typename PointT> void
+    OutofcoreQueryService<ContainerT, PointT>::setPointBudget (std::uint64_t point_budget)
+    {
+      std::lock_guard<std::mutex> lock (mutex_);
+      point_budget_ = point_budget;
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+
+    template<typename ContainerT, typename PointT> std::uint64_t
+    OutofcoreQueryService<ContainerT, PointT>::getPointBudget () const
+    {
+      std::lock_guard<std::mutex> lock (mutex_);
+      return (point_budget_);
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+
+    template<typename ContainerT, typename PointT> void
+    OutofcoreQueryService<ContainerT, PointT>::setPixelThreshold (float pixel_threshold)
+    {
+      std::lock_guard<std::mutex> lock (mutex_);
+      pixel_threshold_ = pixel_threshold;
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+
+    template<typename ContainerT, typename PointT> float
+    OutofcoreQueryService<ContainerT, PointT>::getPixelThreshold () const
+    {
+      std::lock_guard<std::mutex> lock (mutex_);
+      return (pixel_threshold_);
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+
+    template<typename ContainerT, typename PointT> void
+    OutofcoreQueryService<ContainerT, PointT>::setCacheCapacity (std::size_t capacity)
+    {
+      if (capacity == 0)
+      {
+        PCL_ERROR ("[pcl::outofcore::OutofcoreQueryService::setCacheCapacity] The capacity of the cache must be positive\n");
+        return;
+      }
+
+      std::lock_guard<std::mutex> lock (mutex_);
+      cache_.setCapacity (capacity);
+      // Shrink right away; the nodes which are still selected keep their cloud in the selection
+      while (cache_.size_ > capacity && cache_.evict ())
+        ;
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+
+    template<typename ContainerT, typename PointT> std::size_t
+    OutofcoreQueryService<ContainerT, PointT>::getCacheCapacity () const
+    {
+      std::lock_guard<std::mutex> lock (mutex_);
+      return (cache_.capacity_);
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+
+    template<typename ContainerT, typename PointT> std::uint64_t
+    OutofcoreQueryService<ContainerT, PointT>::update (const double planes[24], const Eigen::Vector3d &eye, const Eigen::Matrix4d &view_projection_matrix, int width, int height)
+    {
+      double frustum[24];
+      std::copy (planes, planes + 24, frustum);
+
+      float pixel_threshold;
+      std::uint64_t point_budget;
+      {
+        std::lock_guard<std::mutex> lock (mutex_);
+        pixel_threshold = pixel_threshold_;
+        point_budget = point_budget_;
+      }
+
+      // Visible nodes, refined while their projected area is above the threshold
+      std::vector<SelectedNode> candidates;
+      OutofcoreBreadthFirstIterator<PointT, ContainerT> it (*octree_);
+      it.setMaxDepth (static_cast<unsigned int> (octree_->getDepth ()));
+      while (*it != nullptr)
+      {
+        OctreeDiskNode *node = *it;
+        Eigen::Vector3d min_bb, max_bb;
+        node->getBoundingBox (min_bb, max_bb);
+
+        if (pcl::visualization::cullFrustum (frustum, min_bb, max_bb) == pcl::visualization::PCL_OUTSIDE_FRUSTUM)
+        {
+          it.skipChildVoxels ();
+          it++;
+          continue;
+        }
+
+        const float screen_area = pcl::visualization::viewScreenArea (eye, min_bb, max_bb, view_projection_matrix, width, height);
+        if (screen_area <= pixel_threshold)
+          it.skipChildVoxels ();
+
+        const std::uint64_t num_points = this->getNumPoints (node);
+        if (num_points > 0)
+        {
+          SelectedNode candidate;
+          candidate.node = node;
+          candidate.pcd_file = node->getPCDFilename ().string ();
+          candidate.depth = node->getDepth ();
+          candidate.num_points = num_points;
+          candidate.screen_area = screen_area;
+          candidates.push_back (std::move (candidate));
+        }
+        it++;
+      }
+
+      // Largest error first; a parent projects to at least the area of its children, so it comes before them
+      std::stable_sort (candidates.begin (), candidates.end (), [] (const SelectedNode &a, const SelectedNode &b)
+      {
+        return (a.screen_area > b.screen_area);
+      });
+
+      std::uint64_t selected_points = 0;
+      std::size_t nr_selected = 0;
+      for (; nr_selected < candidates.size (); nr_selected++)
+      {
+        if (selected_points + candidates[nr_selected].num_points > point_budget)
+          break;
+        selected_points += candidates[nr_selected].num_points;
+      }
+      candidates.resize (nr_selected);
+
+      {
+        std::lock_guard<std::mutex> lock (mutex_);
+        generation_++;
+
+        // Requests of the previous view which are still needed are queued again below, the others are cancelled
+        requests_.clear ();
+        selected_.clear ();
+        selection_ = std::move (candidates);
+
+        for (std::size_t i = 0; i < selection_.size (); i++)
+        {
+          SelectedNode &selected = selection_[i];
+          selected_[selected.pcd_file] = i;
+
+          if (cache_.hasKey (selected.pcd_file))
+          {
+            CacheItem &cached = cache_.get (selected.pcd_file);
+            cached.timestamp = generation_;
+            selected.cloud = cached.item;
+          }
+          else if (in_flight_.find (selected.pcd_file) == in_flight_.end ())
+          {
+            LoadRequest request;
+            request.node = selected.node;
+            request.pcd_file = selected.pcd_file;
+            request.screen_area = selected.screen_area;
+            requests_.push_back (request);
+          }
+        }
+        std::make_heap (requests_.begin (), requests_.end ());
+      }
+      requests_ready_.notify_all ();
+
+      return (selected_points);
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+
+    template<typename ContainerT, typename PointT> void
+    OutofcoreQueryService<ContainerT, PointT>::getSelectedNodes (std::vector<SelectedNode> &nodes) const
+    {
+      std::lock_guard<std::mutex> lock (mutex_);
+      nodes = selection_;
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+
+    template<typename ContainerT, typename PointT> std::size_t
+    OutofcoreQueryService<ContainerT, PointT>::getNumPendingRequests () const
+    {
+      std::lock_guard<std::mutex> lock (mutex_);
+      return (requests_.size ());
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+
+    template<typename ContainerT, typename PointT> bool
+    OutofcoreQueryService<ContainerT, PointT>::isComplete () const
+    {
+      std::lock_guard<std::mutex> lock (mutex_);
+      return (std::all_of (selection_.begin (), selection_.end (), [] (const SelectedNode &node) { return (node.cloud != nullptr); }));
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+
+    template<typename ContainerT, typename PointT> void
+    OutofcoreQueryService<ContainerT, PointT>::waitForLoads () const
+    {
+      std::unique_lock<std::mutex> lock (mutex_);
+      loads_done_.wait (lock, [this] { return (requests_.empty () && in_flight_.empty ()); });
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+
+    template<typename ContainerT, typename PointT> void
+    OutofcoreQueryService<ContainerT, PointT>::loadThread ()
+    {
+      std::unique_lock<std::mutex> lock (mutex_);
+      while (true)
+      {
+        requests_ready_.wait (lock, [this] { return (stop_ || !requests_.empty ()); });
+        if (stop_)
+          return;
+
+        std::pop_heap (requests_.begin (), requests_.end ());
+        const LoadRequest request = requests_.back ();
+        requests_.pop_back ();
+        in_flight_.insert (request.pcd_file);
+
+        lock.unlock ();
+        pcl::PCLPointCloud2::Ptr cloud;
+        bool loaded;
+        {
+          // Every load takes one thread of the budget while it runs
+          const pcl::ThreadReservation reservation (1);
+          // Read through the node, which decodes the file with the codec of its metadata
+          loaded = (request.node->read (cloud) == 0);
+        }
+        lock.lock ();
+
+        in_flight_.erase (request.pcd_file);
+
+        // Drop the result if the node was deselected while it was loading
+        const auto selected = selected_.find (request.pcd_file);
+        if (!loaded)
+        {
+          PCL_ERROR ("[pcl::outofcore::OutofcoreQueryService] Could not load %s\n", request.pcd_file.c_str ());
+        }
+        else if (selected != selected_.end ())
+        {
+          const CacheItem cached (cloud, generation_);
+          if (cached.sizeOf () < cache_.capacity_ && cache_.insert (request.pcd_file, cached))
+          {
+            selection_[selected->second].cloud = cloud;
+          }
+          else
+          {
+            // Every cached node belongs to the current view: it does not fit, so stop loading it
+            PCL_DEBUG ("[pcl::outofcore::OutofcoreQueryService] Cache full; dropping %zu requests\n", requests_.size ());
+            requests_.clear ();
+          }
+        }
+
+        loads_done_.notify_all ();
+      }
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+
+    template<typename ContainerT, typename PointT> std::uint64_t
+    OutofcoreQueryService<ContainerT, PointT>::getNumPoints (OctreeDiskNode* node)
+    {
+      const std::string pcd_file = node->getPCDFilename ().string ();
+      const auto it = num_points_.find (pcd_file);
+      if (it != num_points_.end ())
+        return (it->second);
+
+      const std::uint64_t num_points = boost::filesystem::exists (pcd_file) ? node->getDataSize () : 0;
+      num_points_[pcd_file] = num_points;
+      return (num_points);
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+
+  }//namespace outofcore
+}//namespace pcl
+
+#endif //PCL_OUTOFCORE_QUERY_SERVICE_IMPL_H_
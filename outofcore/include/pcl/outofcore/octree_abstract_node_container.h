@@ -43,6 +43,8 @@
 
 #include <pcl/outofcore/boost.h>
 
+#include <Eigen/Core>
+
 namespace pcl
 {
   namespace outofcore
@@ -90,6 +92,12 @@ namespace pcl
         virtual PointT
         operator[] (std::uint64_t idx) const=0;
 
+        /** \brief Store the coordinates of the points quantized relative to a bounding box. Containers which do not
+         *  serialize their points ignore it.
+         */
+        virtual void
+        setQuantization (const Eigen::Vector3d& /*min_bb*/, const Eigen::Vector3d& /*max_bb*/) {}
+
       protected:
         OutofcoreAbstractNodeContainer (const OutofcoreAbstractNodeContainer& rval);
 
@@ -295,6 +295,31 @@ namespace pcl
         std::uint64_t
         addDataToLeaf_and_genLOD (AlignedPointTVector &p);
 
+        /** \brief Bulk insertion of a cloud into the leaves of the tree; produces the same tree as addPointCloud ().
+         *
+         * The points are sorted by the key of their leaf, the missing nodes are created, and then every leaf
+         * file is written once, in parallel (see setNumberOfThreads ()). This is much faster than the recursive
+         * insertion for large clouds, but the whole cloud is in memory at once.
+         *
+         * \param[in] input_cloud The cloud of points to be inserted, with at least the x, y and z fields
+         * \return Number of points copied to the tree; points with a non finite coordinate are skipped
+         */
+        std::uint64_t
+        addPointCloudBulk (const pcl::PCLPointCloud2::Ptr &input_cloud);
+
+        /** \brief Bulk insertion of PCD files into the leaves of the tree, with an external-memory sort.
+         *
+         * If the files are larger than the memory limit (see setBulkMemoryLimit ()), their points are first
+         * distributed by the key of their node at a shallow depth into temporary files next to the tree, so that
+         * each one fits in memory; each temporary file is then inserted with addPointCloudBulk (). Every leaf file
+         * is thus written only once, whatever the number and the order of the input files.
+         *
+         * \param[in] pcd_paths The PCD files to insert, which must all have the same fields
+         * \return Number of points copied to the tree
+         */
+        std::uint64_t
+        addPointCloudBulk (const std::vector<boost::filesystem::path> &pcd_paths);
+
         // Frustrum/Box/Region REQUESTS/QUERIES: DB Accessors
         // -----------------------------------------------------------------------
         void
@@ -480,6 +505,43 @@ namespace pcl
         void
         buildLOD ();
 
+        /** \brief Generate the LODs bottom-up, in parallel over the nodes of each depth (see setNumberOfThreads ()).
+         *
+         * Each branch node gets a uniform random sample of the points of its children; the fraction is chosen so
+         * that the expected number of points per LOD is the same as the one of buildLOD (), and so is the format
+         * on disk. Each file is read and written only once.
+         */
+        void
+        buildLODBulk ();
+
+        /** \brief Set the number of threads used by addPointCloudBulk () and buildLODBulk ().
+         * \param[in] nr_threads the number of hardware threads to use (0 takes as many as the budget of
+         *            pcl::ExecutionContext allows when inserting and building the LOD)
+         */
+        void
+        setNumberOfThreads (unsigned int nr_threads = 0);
+
+        /** \brief Get the number of threads used by addPointCloudBulk () and buildLODBulk (). */
+        inline unsigned int
+        getNumberOfThreads () const
+        {
+          return (threads_);
+        }
+
+        /** \brief Set the amount of point data, in bytes, addPointCloudBulk () may hold in memory at once. The default is 1 GB. */
+        inline void
+        setBulkMemoryLimit (std::uint64_t bytes)
+        {
+          bulk_memory_limit_ = bytes;
+        }
+
+        /** \brief Get the amount of point data, in bytes, addPointCloudBulk () may hold in memory at once. */
+        inline std::uint64_t
+        getBulkMemoryLimit () const
+        {
+          return (bulk_memory_limit_);
+        }
+
         /** \brief Prints size of BBox to stdout
          */ 
         void
@@ -566,6 +628,19 @@ namespace pcl
         {
           this->sample_percent_ = std::fabs (sample_percent_arg) > 1.0 ? 1.0 : std::fabs (sample_percent_arg);
         }
+
+        /** \brief Returns the encoding of the point data files of the nodes created from now on. */
+        OutofcoreOctreeNodeMetadata::NodeCodec
+        getNodeCodec () const;
+
+        /** \brief Sets the encoding of the point data files, stored in the metadata of each node. The codec is
+         * inherited from the parent when a node is created, so it must be set before any point is added.
+         * \param[in] codec OutofcoreOctreeNodeMetadata::QUANTIZED stores the coordinates as 16 bit integers relative
+         * to the bounding box of each node
+         * \return false if the tree already holds points
+         */
+        bool
+        setNodeCodec (const OutofcoreOctreeNodeMetadata::NodeCodec codec);
 	
       protected:
         void
@@ -599,6 +674,20 @@ namespace pcl
         void
         buildLODRecursive (const std::vector<BranchNode*>& current_branch);
 
+        /** \brief Octant path from the root to the node of \c depth containing \c point, 3 bits per level with the
+         * octant of the root in the highest bits; uses the same arithmetic as OutofcoreOctreeBaseNode::createChild ()
+         */
+        std::uint64_t
+        computeNodeKey (const Eigen::Vector3d &point, std::uint64_t depth) const;
+
+        /** \brief Write the points of \c cloud to their leaves, each leaf file once and in parallel; the caller holds the lock */
+        std::uint64_t
+        bulkInsertLeaves (const pcl::PCLPointCloud2 &cloud);
+
+        /** \brief Get the node of \c depth at the end of the octant path \c key, creating the missing nodes */
+        OutofcoreNodeType*
+        getOrCreateNode (std::uint64_t key, std::uint64_t depth);
+
         /** \brief Increment current depths (LOD for branch nodes) point count; called by addDataAtMaxDepth in OutofcoreOctreeBaseNode
          */
         inline void
@@ -652,6 +741,12 @@ namespace pcl
         double sample_percent_;
 
         pcl::RandomSample<pcl::PCLPointCloud2>::Ptr lod_filter_ptr_;
+
+        /** \brief Number of threads of the bulk insertion and LOD generation. */
+        unsigned int threads_;
+
+        /** \brief Amount of point data, in bytes, the bulk insertion may hold in memory at once. */
+        std::uint64_t bulk_memory_limit_;
         
     };
   }
@@ -305,6 +305,19 @@ namespace pcl
           this->payload_->clear ();
         }
 
+        /** \brief Get the encoding of the point data file of this node */
+        OutofcoreOctreeNodeMetadata::NodeCodec
+        getNodeCodec () const
+        {
+          return (node_metadata_->getNodeCodec ());
+        }
+
+        /** \brief Set the encoding of the point data file of this node, which is inherited by the children created
+         * afterwards. The node must not hold any points yet.
+         */
+        void
+        setNodeCodec (const OutofcoreOctreeNodeMetadata::NodeCodec codec);
+
       ///////////////////////////////////////////////////////////////////////////////
       // PROTECTED METHODS
       ////////////////////////////////////////////////////////////////////////////////
@@ -353,6 +366,10 @@ namespace pcl
         virtual std::size_t
         countNumLoadedChildren () const;
         
+        /** \brief Create the container of the point data file, with the codec of the metadata */
+        void
+        resetPayload ();
+
         /** \brief Save node's metadata to file
          * \param[in] recursive if false, save only this node's metadata to file; if true, recursively
          * save all children's metadata to files as well
@@ -40,6 +40,7 @@
 #pragma once
 
 // C++
+#include <list>
 #include <mutex>
 #include <string>
 
@@ -47,6 +48,7 @@
 #include <boost/uuid/random_generator.hpp>
 
 #include <pcl/common/utils.h> // pcl::utils::ignore
+#include <pcl/memory.h>
 #include <pcl/outofcore/boost.h>
 #include <pcl/outofcore/octree_abstract_node_container.h>
 #include <pcl/io/pcd_io.h>
@@ -69,6 +71,15 @@ namespace pcl
    *  http://www.urbanrobotics.net/
    *
    *  \brief Class responsible for serialization and deserialization of out of core point data
+   *
+   *  The node files are compressed PCD files, so reads decode a whole file at once. The decoded
+   *  points are kept in a cache shared by all the containers of a point type, bounded by
+   *  setReadCacheSize (), and range and subsample reads are served from memory. Repeated queries
+   *  over the same nodes, as in LOD streaming, thus read each file only once.
+   *
+   *  With setQuantization (), the x, y and z fields are stored as 16 bit integers relative to the bounding box
+   *  of the node, which the node selects with the "codec" field of its metadata. A PointXYZRGB then takes 10
+   *  bytes per point before compression instead of 16, and the quantized coordinates compress better.
    *  \ingroup outofcore
    *  \author Jacob Schloss (jacob.schloss@urbanrobotics.net)
    */
@@ -212,6 +223,7 @@ namespace pcl
           //remove the binary data in the directory
           PCL_DEBUG ("[Octree Disk Container] Removing the point data from disk, in file %s\n", disk_storage_filename_.c_str ());
           boost::filesystem::remove (boost::filesystem::path (disk_storage_filename_.c_str ()));
+          invalidateReadCache ();
           //reset the size-of-file counter
           filelen_ = 0;
         }
@@ -227,22 +239,9 @@ namespace pcl
           {
             FILE* fxyz = fopen (path.string ().c_str (), "we");
 
-            FILE* f = fopen (disk_storage_filename_.c_str (), "rbe");
-            assert (f != NULL);
-
-            std::uint64_t num = size ();
-            PointT p;
-            char* loc = reinterpret_cast<char*> ( &p );
-
-            for (std::uint64_t i = 0; i < num; i++)
+            const shared_ptr<const AlignedPointTVector> points = readFile ();
+            for (const auto &p : *points)
             {
-              int seekret = _fseeki64 (f, i * sizeof (PointT), SEEK_SET);
-              pcl::utils::ignore(seekret);
-              assert (seekret == 0);
-              std::size_t readlen = fread (loc, sizeof (PointT), 1, f);
-              pcl::utils::ignore(readlen);
-              assert (readlen == 1);
-
               //of << p.x << "\t" << p.y << "\t" << p.z << "\n";
               std::stringstream ss;
               ss << std::fixed;
@@ -251,11 +250,9 @@ namespace pcl
 
               fwrite (ss.str ().c_str (), 1, ss.str ().size (), fxyz);
             }
-            int res = fclose (f);
+            int res = fclose (fxyz);
             pcl::utils::ignore(res);
             assert (res == 0);
-            res = fclose (fxyz);
-            assert (res == 0);
           }
         }
 
@@ -270,6 +267,24 @@ namespace pcl
         /** \brief Returns the number of points in the PCD file by reading the PCD header. */
         std::uint64_t
         getDataSize () const;
+
+        /** \brief Set the maximum size, in bytes, of the decoded node files kept in memory by all the containers of
+         * this point type. 0 disables the cache. The default is 256 MB.
+         */
+        static void
+        setReadCacheSize (std::uint64_t bytes);
+
+        /** \brief Get the maximum size, in bytes, of the decoded node files kept in memory. */
+        static std::uint64_t
+        getReadCacheSize ();
+
+        /** \brief Store the coordinates quantized to 16 bits relative to a bounding box, which must enclose the
+         * points. The file on disk must already be quantized with the same bounding box, or not exist.
+         * \param[in] min_bb the lower corner of the bounding box
+         * \param[in] max_bb the upper corner of the bounding box
+         */
+        void
+        setQuantization (const Eigen::Vector3d& min_bb, const Eigen::Vector3d& max_bb) override;
         
       private:
         //no copy construction
@@ -281,6 +296,44 @@ namespace pcl
 
         void
         flushWritebuff (const bool force_cache_dealloc);
+
+        /** \brief Read the file on disk into \c cloud, dequantizing the coordinates if needed. */
+        int
+        readCloud (pcl::PointCloud<PointT> &cloud) const;
+
+        /** \brief Read the file on disk into \c cloud, dequantizing the coordinates if needed. */
+        int
+        readCloud (pcl::PCLPointCloud2 &cloud) const;
+
+        /** \brief Write \c cloud to the file on disk as binary compressed PCD, quantizing the coordinates if needed. */
+        int
+        writeCloud (const pcl::PointCloud<PointT> &cloud) const;
+
+        /** \brief Write \c cloud to the file on disk as binary compressed PCD, quantizing the coordinates if needed. */
+        int
+        writeCloud (const pcl::PCLPointCloud2 &cloud) const;
+
+        /** \brief Convert the float x, y and z fields of \c input to 16 bit offsets in the bounding box; the other
+         * fields are copied, without padding.
+         */
+        void
+        quantize (const pcl::PCLPointCloud2 &input, pcl::PCLPointCloud2 &output) const;
+
+        /** \brief Inverse of quantize (). */
+        void
+        dequantize (const pcl::PCLPointCloud2 &input, pcl::PCLPointCloud2 &output) const;
+
+        /** \brief Points of the file on disk, decoded once and shared through the read cache. Also updates \c filelen_. */
+        shared_ptr<const AlignedPointTVector>
+        readFile ();
+
+        /** \brief Drop the decoded points of this file from the read cache, after it was written to or removed. */
+        void
+        invalidateReadCache () const;
+
+        /** \brief Remove the least recently used entries until the cache fits its capacity; requires \c cache_mutex_. */
+        static void
+        trimReadCache ();
     
         /** \brief Name of the storage file on disk (i.e., the PCD file) */
         std::string disk_storage_filename_;
@@ -293,6 +346,11 @@ namespace pcl
         /** \brief elements [0,...,size()-1] map to [filelen, ..., filelen + size()-1] */
         AlignedPointTVector writebuff_;
 
+        /** \brief Whether the coordinates are stored quantized, and the bounding box they are relative to */
+        bool quantize_;
+        Eigen::Vector3d quantize_min_;
+        Eigen::Vector3d quantize_max_;
+
         const static std::uint64_t READ_BLOCK_SIZE_;
 
         static const std::uint64_t WRITE_BUFF_MAX_;
@@ -301,6 +359,19 @@ namespace pcl
         static boost::mt19937 rand_gen_;
         static boost::uuids::basic_random_generator<boost::mt19937> uuid_gen_;
 
+        /** \brief The decoded points of a node file. */
+        struct CachedFile
+        {
+          std::string filename;
+          shared_ptr<const AlignedPointTVector> points;
+        };
+
+        /** \brief Decoded node files, most recently used first, their total size in bytes and the capacity. */
+        static std::mutex cache_mutex_;
+        static std::list<CachedFile> cache_;
+        static std::uint64_t cache_bytes_;
+        static std::uint64_t cache_capacity_;
+
     };
   } //namespace outofcore
 } //namespace pcl
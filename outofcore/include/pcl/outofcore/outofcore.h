@@ -53,3 +53,5 @@
 #include <pcl/outofcore/outofcore_iterator_base.h>
 #include <pcl/outofcore/outofcore_breadth_first_iterator.h>
 #include <pcl/outofcore/outofcore_depth_first_iterator.h>
+
+#include <pcl/outofcore/outofcore_query_service.h>
@@ -48,3 +48,5 @@
 
 #include <pcl/outofcore/impl/octree_disk_container.hpp>
 #include <pcl/outofcore/impl/octree_ram_container.hpp>
+
+#include <pcl/outofcore/impl/outofcore_query_service.hpp>
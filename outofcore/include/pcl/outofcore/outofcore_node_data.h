@@ -68,10 +68,16 @@ namespace pcl
        "version": 3,
        "bb_min":  [xxx,yyy,zzz],
        "bb_max":  [xxx,yyy,zzz],
-       "bin":     "path_to_data.pcd"
+       "bin":     "path_to_data.pcd",
+       "codec":   "binary_compressed"
      }
      \endverbatim
      *
+     *  The "codec" field is optional and defaults to "binary_compressed".
+     *  With "quantized", the coordinates of the points are stored as
+     *  16 bit integers relative to the bounding box of the node (see
+     *  \ref NodeCodec).
+     *
      *  Any properties not stored in the metadata file are computed
      *  when the file is loaded (e.g. \ref midpoint_xyz_). By
      *  convention, the JSON files are stored on disk with .oct_idx
@@ -87,6 +93,17 @@ namespace pcl
         //public typedefs
         using Ptr = shared_ptr<OutofcoreOctreeNodeMetadata>;
         using ConstPtr = shared_ptr<const OutofcoreOctreeNodeMetadata>;
+
+        /** \brief Encoding of the point data file of a node */
+        enum NodeCodec
+        {
+          /** \brief Binary compressed PCD file with the fields of the point type */
+          BINARY_COMPRESSED,
+          /** \brief Binary compressed PCD file where x, y and z are 16 bit integers relative to the bounding box of
+           *  the node; the other fields are stored as is. The position error is at most 1/131070 of the node size.
+           */
+          QUANTIZED
+        };
   
         /** \brief Empty constructor */
         OutofcoreOctreeNodeMetadata ();
@@ -136,6 +153,13 @@ namespace pcl
         void 
         setOutofcoreVersion (const int version);
 
+        /** \brief Get the encoding of the point data file, read from the "codec" field of the JSON object */
+        NodeCodec
+        getNodeCodec () const;
+        /** \brief Set the encoding of the point data file, stored in the "codec" field of the JSON object */
+        void
+        setNodeCodec (const NodeCodec codec);
+
         /** \brief Sets the name of the JSON file */
         const boost::filesystem::path&
         getMetadataFilename () const;
@@ -176,6 +200,8 @@ namespace pcl
         boost::filesystem::path metadata_filename_;
         /** \brief Outofcore library version identifier */
         int outofcore_version_;
+        /** \brief Encoding of the point data file */
+        NodeCodec codec_;
 
         /** \brief Computes the midpoint; used when bounding box is changed */
         inline void 
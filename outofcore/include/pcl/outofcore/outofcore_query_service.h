@@ -0,0 +1,259 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#pragma once
+
+#include <pcl/memory.h>
+#include <pcl/pcl_macros.h>
+#include <pcl/PCLPointCloud2.h>
+
+#include <pcl/outofcore/octree_base.h>
+#include <pcl/outofcore/impl/lru_cache.hpp>
+
+#include <condition_variable>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace pcl
+{
+  namespace outofcore
+  {
+    /** \class OutofcoreQueryService
+     *
+     * \brief Asynchronous, prioritized loading of the nodes of an outofcore octree seen by a camera.
+     *
+     * Each call to update () selects the nodes to display for a view: the tree is traversed breadth first, nodes outside
+     * of the frustum are culled, and nodes whose projected area is below the pixel threshold are not refined further.
+     * The visible nodes are then taken by decreasing screen area, which is the screen-space error of drawing their parent
+     * instead, until the point budget is spent. The selected nodes which are not cached yet are loaded by background
+     * threads, the ones with the largest error first; requests of a previous view which are not selected anymore are
+     * cancelled. Decoded nodes are kept in an LRU cache whose memory is bounded.
+     *
+     * The tree is read through its public interface only, so it should be opened with \c load_all, as the viewer does.
+     *
+     * \ingroup outofcore
+     */
+    template<typename ContainerT = OutofcoreOctreeDiskContainer<pcl::PointXYZ>, typename PointT = pcl::PointXYZ>
+    class OutofcoreQueryService
+    {
+      public:
+        using OctreeDisk = OutofcoreOctreeBase<ContainerT, PointT>;
+        using OctreeDiskNode = OutofcoreOctreeBaseNode<ContainerT, PointT>;
+        using OctreeDiskPtr = typename OctreeDisk::Ptr;
+
+        using Ptr = shared_ptr<OutofcoreQueryService<ContainerT, PointT> >;
+        using ConstPtr = shared_ptr<const OutofcoreQueryService<ContainerT, PointT> >;
+
+        /** \brief A node selected by the last update (), with its data if it has been loaded. */
+        struct SelectedNode
+        {
+          /** \brief The node in the tree. */
+          OctreeDiskNode *node;
+          /** \brief Point data file of the node, which identifies it. */
+          std::string pcd_file;
+          /** \brief Depth of the node in the tree. */
+          std::uint64_t depth;
+          /** \brief Number of points of the node. */
+          std::uint64_t num_points;
+          /** \brief Projected area of the bounding box of the node, in pixels. */
+          float screen_area;
+          /** \brief Decoded points of the node; null while the node is not loaded. */
+          pcl::PCLPointCloud2::ConstPtr cloud;
+        };
+
+        /** \brief Constructor.
+         * \param[in] octree the tree to query, opened with \c load_all
+         * \param[in] nr_threads the number of loading threads (0 starts as many as the budget of
+         *            pcl::ExecutionContext allows; every load takes one thread of the budget while it runs)
+         */
+        OutofcoreQueryService (const OctreeDiskPtr &octree, unsigned int nr_threads = 1);
+
+        /** \brief Destructor; cancels the pending requests and joins the loading threads. */
+        ~OutofcoreQueryService ();
+
+        OutofcoreQueryService (const OutofcoreQueryService&) = delete;
+        OutofcoreQueryService&
+        operator= (const OutofcoreQueryService&) = delete;
+
+        /** \brief Set the maximum number of points selected by update (). The default is 10 million. */
+        void
+        setPointBudget (std::uint64_t point_budget);
+
+        /** \brief Get the maximum number of points selected by update (). */
+        std::uint64_t
+        getPointBudget () const;
+
+        /** \brief Set the projected area, in pixels, below which the children of a node are not selected. The default is 10000, as in the viewer. */
+        void
+        setPixelThreshold (float pixel_threshold);
+
+        /** \brief Get the projected area, in pixels, below which the children of a node are not selected. */
+        float
+        getPixelThreshold () const;
+
+        /** \brief Set the memory, in bytes, of the cache of decoded nodes. Nodes of the current view are never evicted,
+         * so for a view which does not fit the loading stops. The default is 512 MB.
+         */
+        void
+        setCacheCapacity (std::size_t capacity);
+
+        /** \brief Get the memory, in bytes, of the cache of decoded nodes. */
+        std::size_t
+        getCacheCapacity () const;
+
+        /** \brief Select the nodes to display for a view and schedule the loading of the ones which are not cached.
+         * Requests of the previous view which are not needed anymore are cancelled.
+         * \param[in] planes the 6 planes of the view frustum, as returned by pcl::visualization::getViewFrustum ()
+         * \param[in] eye the position of the camera
+         * \param[in] view_projection_matrix the view projection matrix of the camera
+         * \param[in] width the width of the viewport, in pixels
+         * \param[in] height the height of the viewport, in pixels
+         * \return the number of points selected
+         */
+        std::uint64_t
+        update (const double planes[24], const Eigen::Vector3d &eye, const Eigen::Matrix4d &view_projection_matrix, int width, int height);
+
+        /** \brief Get the nodes selected by the last update (); the ones that are loaded have their cloud set. */
+        void
+        getSelectedNodes (std::vector<SelectedNode> &nodes) const;
+
+        /** \brief Get the number of load requests that are waiting for a thread. */
+        std::size_t
+        getNumPendingRequests () const;
+
+        /** \brief Return true if all the nodes selected by the last update () are loaded. */
+        bool
+        isComplete () const;
+
+        /** \brief Block until no request is pending or being loaded. */
+        void
+        waitForLoads () const;
+
+      protected:
+        /** \brief A node to load, with the screen-space error that orders the requests. */
+        struct LoadRequest
+        {
+          OctreeDiskNode *node;
+          std::string pcd_file;
+          float screen_area;
+
+          bool
+          operator< (const LoadRequest &rhs) const
+          {
+            return (screen_area < rhs.screen_area);
+          }
+        };
+
+        /** \brief A decoded node in the cache; its timestamp is the last update () which selected it. */
+        class CacheItem : public LRUCacheItem<pcl::PCLPointCloud2::ConstPtr>
+        {
+          public:
+            CacheItem (const pcl::PCLPointCloud2::ConstPtr &cloud, std::size_t generation)
+            {
+              this->item = cloud;
+              this->timestamp = generation;
+            }
+
+            std::size_t
+            sizeOf () const override
+            {
+              return (sizeof (pcl::PCLPointCloud2) + this->item->data.size ());
+            }
+        };
+
+        using Cache = LRUCache<std::string, CacheItem>;
+
+        /** \brief Body of the loading threads. */
+        void
+        loadThread ();
+
+        /** \brief Number of points of a node, from the header of its file; memoized, since update () runs every frame. */
+        std::uint64_t
+        getNumPoints (OctreeDiskNode* node);
+
+        /** \brief The tree to query. */
+        OctreeDiskPtr octree_;
+
+        /** \brief Maximum number of points selected by update (). */
+        std::uint64_t point_budget_;
+
+        /** \brief Projected area below which the children of a node are not selected. */
+        float pixel_threshold_;
+
+        /** \brief Nodes selected by the last update (), by decreasing screen area. */
+        std::vector<SelectedNode> selection_;
+
+        /** \brief Load requests, as a max-heap on the screen area. */
+        std::vector<LoadRequest> requests_;
+
+        /** \brief Index in selection_ of each selected file. */
+        std::map<std::string, std::size_t> selected_;
+
+        /** \brief Files being loaded by a thread. */
+        std::set<std::string> in_flight_;
+
+        /** \brief Number of calls to update (); stamps the cached nodes they select. */
+        std::size_t generation_;
+
+        /** \brief Decoded nodes. */
+        Cache cache_;
+
+        /** \brief Set by the destructor to stop the loading threads. */
+        bool stop_;
+
+        /** \brief Protects all the members above. */
+        mutable std::mutex mutex_;
+
+        /** \brief Signaled when requests are added or the service stops. */
+        std::condition_variable requests_ready_;
+
+        /** \brief Signaled when a load finishes. */
+        mutable std::condition_variable loads_done_;
+
+        /** \brief Loading threads. */
+        std::vector<std::thread> threads_;
+
+        /** \brief Number of points of the nodes seen so far, by file; only used by update (). */
+        std::map<std::string, std::uint64_t> num_points_;
+    };
+  }
+}
@@ -59,10 +59,11 @@ class OutofcoreCloud : public Object
 
     struct PcdQueueItem
     {
-      PcdQueueItem (std::string pcd_file, float coverage)
+      PcdQueueItem (std::string pcd_file, float coverage, OctreeDiskNode *node = nullptr)
       {
        this->pcd_file = pcd_file;
        this->coverage = coverage;
+       this->node = node;
       }
 
       bool operator< (const PcdQueueItem& rhs) const
@@ -72,6 +73,7 @@ class OutofcoreCloud : public Object
 
       std::string pcd_file;
       float coverage;
+      OctreeDiskNode *node;
     };
 
     using PcdQueue = std::priority_queue<PcdQueueItem>;
@@ -99,6 +101,7 @@ class OutofcoreCloud : public Object
 
       std::string pcd_file;
       float coverage;
+      OctreeDiskNode *node;
     };
 
 
@@ -55,6 +55,7 @@ namespace pcl
     
     OutofcoreOctreeNodeMetadata::OutofcoreOctreeNodeMetadata () 
       : outofcore_version_ ()
+      , codec_ (BINARY_COMPRESSED)
     {
     }
 
@@ -75,6 +76,7 @@ namespace pcl
       this->directory_ = orig.directory_;
       this->metadata_filename_ = orig.metadata_filename_;
       this->outofcore_version_ = orig.outofcore_version_;
+      this->codec_ = orig.codec_;
 
       this->updateVoxelCenter ();
     }
@@ -182,6 +184,22 @@ namespace pcl
 
     ////////////////////////////////////////////////////////////////////////////////
 
+    OutofcoreOctreeNodeMetadata::NodeCodec
+    OutofcoreOctreeNodeMetadata::getNodeCodec () const
+    {
+      return (codec_);
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+
+    void
+    OutofcoreOctreeNodeMetadata::setNodeCodec (const NodeCodec codec)
+    {
+      codec_ = codec;
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+
     const boost::filesystem::path&
     OutofcoreOctreeNodeMetadata::getMetadataFilename () const
     {
@@ -228,11 +246,13 @@ namespace pcl
 
       std::string binary_point_filename_string = binary_point_filename_.filename ().generic_string ();
       cJSON* cjson_bin_point_filename = cJSON_CreateString (binary_point_filename_string.c_str ());
+      cJSON* cjson_codec = cJSON_CreateString ((codec_ == QUANTIZED) ? "quantized" : "binary_compressed");
 
       cJSON_AddItemToObject (idx.get (), "version", cjson_outofcore_version);
       cJSON_AddItemToObject (idx.get (), "bb_min", cjson_bb_min);
       cJSON_AddItemToObject (idx.get (), "bb_max", cjson_bb_max);
       cJSON_AddItemToObject (idx.get (), "bin", cjson_bin_point_filename);
+      cJSON_AddItemToObject (idx.get (), "codec", cjson_codec);
 
       char* idx_txt = cJSON_Print (idx.get ());
 
@@ -281,6 +301,7 @@ namespace pcl
       cJSON* cjson_bb_min = cJSON_GetObjectItem (idx.get (), "bb_min");
       cJSON* cjson_bb_max = cJSON_GetObjectItem (idx.get (), "bb_max");
       cJSON* cjson_bin_point_filename = cJSON_GetObjectItem (idx.get (), "bin");
+      cJSON* cjson_codec = cJSON_GetObjectItem (idx.get (), "codec");
 
       bool parse_failure = false;
       
@@ -319,6 +340,16 @@ namespace pcl
       outofcore_version_ = cjson_outofcore_version->valueint;
 
       binary_point_filename_= directory_ / cjson_bin_point_filename->valuestring;
+
+      // Trees written before the codec field was introduced are binary compressed
+      codec_ = BINARY_COMPRESSED;
+      if (cjson_codec && cjson_codec->valuestring)
+      {
+        if (std::string (cjson_codec->valuestring) == "quantized")
+          codec_ = QUANTIZED;
+        else if (std::string (cjson_codec->valuestring) != "binary_compressed")
+          PCL_WARN ("[pcl::outofcore::OutofcoreOctreeNodeMetadata::%s] Unknown codec %s in node metadata %s; assuming binary_compressed\n", __FUNCTION__, cjson_codec->valuestring, metadata_filename_.c_str ());
+      }
       midpoint_xyz_ = (max_bb_+min_bb_)/static_cast<double>(2.0);
       
       //return success
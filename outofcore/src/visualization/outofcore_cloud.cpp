@@ -75,7 +75,11 @@ OutofcoreCloud::pcdReaderThread ()
 
         pcl::PCLPointCloud2Ptr cloud (new pcl::PCLPointCloud2);
 
-        pcl::io::loadPCDFile (pcd_queue_item->pcd_file, *cloud);
+        // Nodes decode their file with the codec of their metadata
+        if (pcd_queue_item->node)
+          pcd_queue_item->node->read (cloud);
+        else
+          pcl::io::loadPCDFile (pcd_queue_item->pcd_file, *cloud);
         pcl::io::pointCloudTovtkPolyData (cloud, cloud_data);
 
         CloudDataCacheItem cloud_data_cache_item(pcd_queue_item->pcd_file, pcd_queue_item->coverage, cloud_data, timestamp);
@@ -217,7 +221,7 @@ OutofcoreCloud::render (vtkRenderer* renderer)
 
       cloud_data_cache_mutex.lock();
 
-      PcdQueueItem pcd_queue_item(pcd_file, coverage);
+      PcdQueueItem pcd_queue_item(pcd_file, coverage, node);
 
       // If we can lock the queue add another item
       if (pcd_queue_mutex.try_lock())
@@ -178,6 +178,14 @@ namespace pcl
       void
       setMinimumDistanceBetweenHeads (float heads_minimum_distance);
 
+      /**
+       * \brief Set the number of threads used to evaluate the person classifier on the clusters.
+       *
+       * \param[in] nr_threads The number of hardware threads to use (0 takes as many as the budget of pcl::ExecutionContext allows when computing).
+       */
+      void
+      setNumberOfThreads (unsigned int nr_threads = 0);
+
       /**
        * \brief Get the minimum and maximum allowed height and width for a person cluster.
        *
@@ -364,6 +372,9 @@ namespace pcl
       
       /** \brief flag stating if the classifier has been set or not */
       bool person_classifier_set_flag_;
+
+      /** \brief number of threads used to evaluate the person classifier */
+      unsigned int threads_;
     };
   } /* namespace people */
 } /* namespace pcl */
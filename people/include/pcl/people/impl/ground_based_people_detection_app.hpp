@@ -42,6 +42,7 @@
 #define PCL_PEOPLE_GROUND_BASED_PEOPLE_DETECTION_APP_HPP_
 
 #include <pcl/people/ground_based_people_detection_app.h>
+#include <pcl/common/execution_context.h>
 #include <pcl/filters/extract_indices.h> // for ExtractIndices
 #include <pcl/segmentation/extract_clusters.h> // for EuclideanClusterExtraction
 #include <pcl/filters/voxel_grid.h> // for VoxelGrid
@@ -64,6 +65,7 @@ pcl::people::GroundBasedPeopleDetectionApp<PointT>::GroundBasedPeopleDetectionAp
   max_width_ = 8.0;
   updateMinMaxPoints ();
   heads_minimum_distance_ = 0.3;
+  setNumberOfThreads ();
 
   // set flag values for mandatory parameters:
   sqrt_ground_coeffs_ = std::numeric_limits<float>::quiet_NaN();
@@ -174,6 +176,13 @@ pcl::people::GroundBasedPeopleDetectionApp<PointT>::setHeadCentroid (bool head_c
   head_centroid_ = head_centroid;
 }
 
+template <typename PointT> void
+pcl::people::GroundBasedPeopleDetectionApp<PointT>::setNumberOfThreads (unsigned int nr_threads)
+{
+  // 0 is resolved against the budget of pcl::ExecutionContext at compute time
+  threads_ = nr_threads;
+}
+
 template <typename PointT> void
 pcl::people::GroundBasedPeopleDetectionApp<PointT>::getPersonClusterLimits (float& min_height, float& max_height, float& min_width, float& max_width)
 {
@@ -400,16 +409,27 @@ pcl::people::GroundBasedPeopleDetectionApp<PointT>::compute (std::vector<pcl::pe
   {
     swapDimensions(rgb_image_);
   }
-  for(typename std::vector<pcl::people::PersonCluster<PointT> >::iterator it = clusters.begin(); it != clusters.end(); ++it)
+  // The clusters are evaluated independently, each on its own resized image patch
+  std::ptrdiff_t nr_clusters = static_cast<std::ptrdiff_t> (clusters.size ());
+  const pcl::ThreadReservation reservation (threads_);
+  const unsigned int threads = reservation.getNumberOfThreads ();
+#pragma omp parallel for \
+  default(none) \
+  shared(clusters, nr_clusters) \
+  schedule(dynamic) \
+  num_threads(threads)
+  for (std::ptrdiff_t i = 0; i < nr_clusters; ++i)
   {
+    pcl::people::PersonCluster<PointT>& cluster = clusters[i];
+
     //Evaluate confidence for the current PersonCluster:
-    Eigen::Vector3f centroid = intrinsics_matrix_transformed_ * (it->getTCenter());
+    Eigen::Vector3f centroid = intrinsics_matrix_transformed_ * (cluster.getTCenter());
     centroid /= centroid(2);
-    Eigen::Vector3f top = intrinsics_matrix_transformed_ * (it->getTTop());
+    Eigen::Vector3f top = intrinsics_matrix_transformed_ * (cluster.getTTop());
     top /= top(2);
-    Eigen::Vector3f bottom = intrinsics_matrix_transformed_ * (it->getTBottom());
+    Eigen::Vector3f bottom = intrinsics_matrix_transformed_ * (cluster.getTBottom());
     bottom /= bottom(2);
-    it->setPersonConfidence(person_classifier_.evaluate(rgb_image_, bottom, top, centroid, vertical_));
+    cluster.setPersonConfidence(person_classifier_.evaluate(rgb_image_, bottom, top, centroid, vertical_));
   }
  
   return (true);
@@ -59,7 +59,7 @@ namespace pcl
       using SceneCloudConstPtr = typename SceneCloud::ConstPtr;
 
       /** \brief Empty constructor. */
-      CorrespondenceGrouping () : scene_ () {}
+      CorrespondenceGrouping () : scene_ () { setNumberOfThreads (); }
 
       /** \brief destructor. */
       ~CorrespondenceGrouping() 
@@ -128,6 +128,17 @@ namespace pcl
       void
       cluster (std::vector<Correspondences> &clustered_corrs);
 
+      /** \brief Set the number of threads used by the grouping algorithms that support it.
+        * The results do not depend on the number of threads.
+        * \param[in] nr_threads the number of hardware threads to use (0 takes as many as the budget of pcl::ExecutionContext allows when clustering)
+        */
+      inline void
+      setNumberOfThreads (unsigned int nr_threads = 0)
+      {
+        // 0 is resolved against the budget of pcl::ExecutionContext at compute time
+        threads_ = nr_threads;
+      }
+
     protected:
       /** \brief The scene cloud. */
       SceneCloudConstPtr scene_;
@@ -141,6 +152,9 @@ namespace pcl
 		* if the cg algorithm can not handle scale invariance, the size of the vector will be 0. */
 	  std::vector <double> corr_group_scale_;
 
+      /** \brief The number of threads the scheduler should use. */
+      unsigned int threads_;
+
       /** \brief The actual clustering method, should be implemented by each subclass.
         *
         * \param[out] clustered_corrs a vector containing the correspondences for each instance of the model found within the input data.
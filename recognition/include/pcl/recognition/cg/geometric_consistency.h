@@ -129,6 +129,7 @@ namespace pcl
       using CorrespondenceGrouping<PointModelT, PointSceneT>::input_;
       using CorrespondenceGrouping<PointModelT, PointSceneT>::scene_;
       using CorrespondenceGrouping<PointModelT, PointSceneT>::model_scene_corrs_;
+      using CorrespondenceGrouping<PointModelT, PointSceneT>::threads_;
 
       /** \brief Minimum cluster size. It shouldn't be less than 3, since at least 3 correspondences are needed to compute the 6DOF pose */
       int gc_threshold_;
@@ -95,6 +95,21 @@ namespace pcl
         int
         voteInt (const Eigen::Vector3d &single_vote_coord, double weight, int voter_id);
 
+        /** \brief Cast a set of votes using several threads. The result is the same as calling vote() (or voteInt() if
+          * interpolate is true) for each vote in order, using the index of the vote as voter id.
+          *
+          * The bins each vote falls into are computed in parallel. The accumulator is then split into one contiguous
+          * range of bins per thread, so every bin is only updated by a single thread, in the order of the votes.
+          *
+          * \param[in] votes_coords coordinates of the votes being cast.
+          * \param[in] weights weight associated with each vote.
+          * \param[in] interpolate whether the weights are interpolated between neighboring bins, as in voteInt().
+          * \param[in] nr_threads the number of threads to use.
+          */
+        void
+        castVotes (const std::vector<Eigen::Vector3d, Eigen::aligned_allocator<Eigen::Vector3d> > &votes_coords,
+                   const std::vector<double> &weights, bool interpolate, unsigned int nr_threads);
+
         /** \brief Find the bins with most votes.
           *
           * \param[in] min_threshold the minimum number of votes to be included in a bin in order to have its value returned.
@@ -108,6 +123,20 @@ namespace pcl
 
       protected:
 
+        /** \brief Compute the bins a vote is cast into, together with the part of the weight each bin receives.
+          *
+          * \param[in] single_vote_coord coordinates of the vote.
+          * \param[in] weight weight associated with the vote.
+          * \param[in] interpolate whether the weight is interpolated between the central bin and its neighbors.
+          * \param[out] bins the indices of the bins (at most 8).
+          * \param[out] bin_weights the weight cast into each bin.
+          * \param[out] n_bins the number of bins the vote is cast into, 0 if the vote is out of bounds.
+          * \return the index of the central bin, -1 if the vote is out of bounds.
+          */
+        int
+        computeVoteBins (const Eigen::Vector3d &single_vote_coord, double weight, bool interpolate,
+                         int bins[8], double bin_weights[8], int &n_bins) const;
+
         /** \brief Minimum coordinate in the Hough Space. */
         Eigen::Vector3d min_coord_;
 
@@ -437,6 +466,7 @@ namespace pcl
       using CorrespondenceGrouping<PointModelT, PointSceneT>::input_;
       using CorrespondenceGrouping<PointModelT, PointSceneT>::scene_;
       using CorrespondenceGrouping<PointModelT, PointSceneT>::model_scene_corrs_;
+      using CorrespondenceGrouping<PointModelT, PointSceneT>::threads_;
 
       /** \brief The input Rf cloud. */
       ModelRfCloudConstPtr input_rf_;
@@ -12,6 +12,8 @@
 #include <pcl/common/fft/kiss_fftr.h>
 #include <pcl/common/transforms.h>
 
+#include <vector>
+
 namespace pcl
 {
 
@@ -43,6 +45,9 @@ namespace pcl
 
       using PointTPtr = typename pcl::PointCloud<PointT>::Ptr;
 
+      /** \brief Number of bins of the zero padded cross-correlation */
+      static constexpr int nr_bins_after_padding_ = 180;
+
       /** \brief View of the model to be aligned to input_view_ */
       PointTPtr target_view_;
       /** \brief View of the input */
@@ -61,6 +66,21 @@ namespace pcl
        * If peak_i >= (max_peak * accept_threhsold_) => peak is accepted
        */
       float accept_threshold_;
+      /** \brief Cross-power spectrum of one input/target pair, reused across calls */
+      std::vector<kiss_fft_cpx> cross_power_;
+      /** \brief Cross-correlation of one input/target pair, reused across calls */
+      std::vector<kiss_fft_cpx> correlation_;
+
+      /** \brief Returns the inverse FFT plan used for the cross-correlation. The plan is read-only
+        * once created, so it is built once and shared by all the instances and threads.
+        */
+      static kiss_fft_cfg
+      inversePlan ()
+      {
+        static const std::shared_ptr<kiss_fft_state> plan (
+            kiss_fft_alloc (nr_bins_after_padding_, 1, nullptr, nullptr), [] (kiss_fft_cfg cfg) { kiss_fft_free (cfg); });
+        return (plan.get ());
+      }
 
       /** \brief computes the transformation to the z-axis
         * \param[in] centroid
@@ -103,7 +123,9 @@ namespace pcl
     public:
 
       /** \brief Constructor. */
-      CRHAlignment() {
+      CRHAlignment() :
+        cross_power_ (nr_bins_after_padding_), correlation_ (nr_bins_after_padding_)
+      {
         max_peaks_ = 5;
         quantile_ = 0.2f;
         accept_threshold_ = 0.8f;
@@ -152,27 +174,34 @@ namespace pcl
         computeRollAngle (input_ftt, target_ftt, peaks);
 
         //if the number of peaks is too big, we should try to reduce using siluette matching
+        computeTransforms (centroid_input_, centroid_target_, peaks, transforms_);
+      }
 
-        for (const float &peak : peaks)
-        {
-          Eigen::Affine3f rollToRot;
-          computeRollTransform (centroid_input_, centroid_target_, peak, rollToRot);
-
-          Eigen::Matrix4f rollHomMatrix = Eigen::Matrix4f ();
-          rollHomMatrix.setIdentity (4, 4);
-          rollHomMatrix = rollToRot.matrix ();
-
-          Eigen::Matrix4f translation2;
-          translation2.setIdentity (4, 4);
-          Eigen::Vector3f centr = rollToRot * centroid_target_;
-          translation2 (0, 3) = centroid_input_[0] - centr[0];
-          translation2 (1, 3) = centroid_input_[1] - centr[1];
-          translation2 (2, 3) = centroid_input_[2] - centr[2];
+      /** \brief Computes the transformations aligning several model views to the same input.
+       * The FFT plan and buffers are shared by all the views, and the conjugated spectrum of
+       * the target is only computed once.
+       * \param[in] input_ffts CRH histograms of the views, one per point
+       * \param[in] input_centroids centroids of the views
+       * \param[in] target_ftt CRH histogram of the target cloud
+       * \param[in] target_centroid centroid of the target cloud
+       * \param[out] transforms transformations of every view, in the order of input_ffts
+       */
+      void
+      align (const pcl::PointCloud<pcl::Histogram<nbins_> > & input_ffts,
+             const std::vector<Eigen::Vector3f, Eigen::aligned_allocator<Eigen::Vector3f> > & input_centroids,
+             const pcl::PointCloud<pcl::Histogram<nbins_> > & target_ftt,
+             const Eigen::Vector3f & target_centroid,
+             std::vector<std::vector<Eigen::Matrix4f, Eigen::aligned_allocator<Eigen::Matrix4f> > > & transforms)
+      {
+        std::vector<std::vector<float> > peaks;
+        computeRollAngles (input_ffts, target_ftt, peaks);
 
-          Eigen::Matrix4f resultHom (translation2 * rollHomMatrix);
-          transforms_.push_back(resultHom.inverse());
+        transforms.resize (input_ffts.size ());
+        for (std::size_t i = 0; i < input_ffts.size (); ++i)
+        {
+          transforms[i].clear ();
+          computeTransforms (input_centroids[i], target_centroid, peaks[i], transforms[i]);
         }
-
       }
 
       /** \brief Computes the roll angle that aligns input to model.
@@ -184,49 +213,93 @@ namespace pcl
       computeRollAngle (pcl::PointCloud<pcl::Histogram<nbins_> > & input_ftt, pcl::PointCloud<pcl::Histogram<nbins_> > & target_ftt,
                         std::vector<float> & peaks)
       {
+        std::vector<kiss_fft_cpx> target_spectrum;
+        unpackSpectrum (target_ftt[0], target_spectrum);
+        correlate (input_ftt[0], target_spectrum, peaks);
+      }
+
+      /** \brief Computes the roll angles that align several inputs to the same model.
+       * \param[in] input_ffts CRH histograms of the input clouds, one per point
+       * \param[in] target_ftt CRH histogram of the target cloud
+       * \param[out] peaks angles where each input correlates with the target, in the order of input_ffts
+       */
+      void
+      computeRollAngles (const pcl::PointCloud<pcl::Histogram<nbins_> > & input_ffts, const pcl::PointCloud<pcl::Histogram<nbins_> > & target_ftt,
+                         std::vector<std::vector<float> > & peaks)
+      {
+        std::vector<kiss_fft_cpx> target_spectrum;
+        unpackSpectrum (target_ftt[0], target_spectrum);
 
-        pcl::PointCloud<pcl::Histogram<nbins_> > input_ftt_negate (input_ftt);
+        peaks.resize (input_ffts.size ());
+        for (std::size_t i = 0; i < input_ffts.size (); ++i)
+        {
+          peaks[i].clear ();
+          correlate (input_ffts[i], target_spectrum, peaks[i]);
+        }
+      }
 
-        for (int i = 2; i < (nbins_); i += 2)
-          input_ftt_negate[0].histogram[i] = -input_ftt_negate[0].histogram[i];
+    protected:
 
-        int nr_bins_after_padding = 180;
-        int peak_distance = 5;
-        int cutoff = nbins_ - 1;
+      /** \brief Unpacks a CRH histogram (dc, re_1, im_1, ..., nyquist) into complex bins */
+      static void
+      unpackSpectrum (const pcl::Histogram<nbins_> & ftt, std::vector<kiss_fft_cpx> & spectrum)
+      {
+        spectrum.resize (nbins_ / 2 + 1);
+        spectrum[0].r = ftt.histogram[0];
+        spectrum[0].i = 0.f;
+        for (int i = 1, k = 1; i < nbins_ - 1; i += 2, k++)
+        {
+          spectrum[k].r = ftt.histogram[i];
+          spectrum[k].i = ftt.histogram[i + 1];
+        }
+        spectrum[nbins_ / 2].r = ftt.histogram[nbins_ - 1];
+        spectrum[nbins_ / 2].i = 0.f;
+      }
 
-        kiss_fft_cpx * multAB = new kiss_fft_cpx[nr_bins_after_padding];
-        for (int i = 0; i < nr_bins_after_padding; i++)
-          multAB[i].r = multAB[i].i = 0.f;
+      /** \brief Cross-correlates one input histogram with an unpacked target spectrum and extracts the peaks
+       * \param[in] input_ftt CRH histogram of the input cloud
+       * \param[in] target_spectrum spectrum of the target cloud, as returned by unpackSpectrum
+       * \param[out] peaks angles where the histograms correlate
+       */
+      void
+      correlate (const pcl::Histogram<nbins_> & input_ftt, const std::vector<kiss_fft_cpx> & target_spectrum,
+                 std::vector<float> & peaks)
+      {
+        const int nr_bins_after_padding = nr_bins_after_padding_;
+        const int peak_distance = 5;
+        const int cutoff = nbins_ - 1;
 
+        for (auto &bin : cross_power_)
+          bin.r = bin.i = 0.f;
+
+        // the conjugate of the input times the target, normalized to unit magnitude
         int k = 0;
-        multAB[k].r = input_ftt_negate[0].histogram[0] * target_ftt[0].histogram[0];
+        cross_power_[k].r = input_ftt.histogram[0] * target_spectrum[0].r;
         k++;
 
         float a, b, c, d;
         for (int i = 1; i < cutoff; i += 2, k++)
         {
-          a = input_ftt_negate[0].histogram[i];
-          b = input_ftt_negate[0].histogram[i + 1];
-          c = target_ftt[0].histogram[i];
-          d = target_ftt[0].histogram[i + 1];
-          multAB[k].r = a * c - b * d;
-          multAB[k].i = b * c + a * d;
+          a = input_ftt.histogram[i];
+          b = -input_ftt.histogram[i + 1];
+          c = target_spectrum[k].r;
+          d = target_spectrum[k].i;
+          cross_power_[k].r = a * c - b * d;
+          cross_power_[k].i = b * c + a * d;
 
-          float tmp = std::sqrt (multAB[k].r * multAB[k].r + multAB[k].i * multAB[k].i);
+          float tmp = std::sqrt (cross_power_[k].r * cross_power_[k].r + cross_power_[k].i * cross_power_[k].i);
 
-          multAB[k].r /= tmp;
-          multAB[k].i /= tmp;
+          cross_power_[k].r /= tmp;
+          cross_power_[k].i /= tmp;
         }
 
-        multAB[nbins_ - 1].r = input_ftt_negate[0].histogram[nbins_ - 1] * target_ftt[0].histogram[nbins_ - 1];
+        cross_power_[nbins_ - 1].r = input_ftt.histogram[nbins_ - 1] * target_spectrum[nbins_ / 2].r;
 
-        kiss_fft_cfg mycfg = kiss_fft_alloc (nr_bins_after_padding, 1, nullptr, nullptr);
-        kiss_fft_cpx * invAB = new kiss_fft_cpx[nr_bins_after_padding];
-        kiss_fft (mycfg, multAB, invAB);
+        kiss_fft (inversePlan (), cross_power_.data (), correlation_.data ());
 
         std::vector < std::pair<float, int> > scored_peaks (nr_bins_after_padding);
         for (int i = 0; i < nr_bins_after_padding; i++)
-          scored_peaks[i] = std::make_pair (invAB[i].r, i);
+          scored_peaks[i] = std::make_pair (correlation_[i].r, i);
 
         std::sort (scored_peaks.begin (), scored_peaks.end (), peaks_ordering ());
 
@@ -267,5 +340,36 @@ namespace pcl
           }
         }
       }
+
+      /** \brief Turns roll angles into transformations from the model view to the input view
+       * \param[in] centroid_input centroid of the model view
+       * \param[in] centroid_target centroid of the input view
+       * \param[in] peaks roll angles
+       * \param[out] transforms one transformation per roll angle is appended
+       */
+      void
+      computeTransforms (Eigen::Vector3f centroid_input, Eigen::Vector3f centroid_target, const std::vector<float> & peaks,
+                         std::vector<Eigen::Matrix4f, Eigen::aligned_allocator<Eigen::Matrix4f> > & transforms)
+      {
+        for (const float &peak : peaks)
+        {
+          Eigen::Affine3f rollToRot;
+          computeRollTransform (centroid_input, centroid_target, peak, rollToRot);
+
+          Eigen::Matrix4f rollHomMatrix = Eigen::Matrix4f ();
+          rollHomMatrix.setIdentity (4, 4);
+          rollHomMatrix = rollToRot.matrix ();
+
+          Eigen::Matrix4f translation2;
+          translation2.setIdentity (4, 4);
+          Eigen::Vector3f centr = rollToRot * centroid_target;
+          translation2 (0, 3) = centroid_input[0] - centr[0];
+          translation2 (1, 3) = centroid_input[1] - centr[1];
+          translation2 (2, 3) = centroid_input[2] - centr[2];
+
+          Eigen::Matrix4f resultHom (translation2 * rollHomMatrix);
+          transforms.push_back(resultHom.inverse());
+        }
+      }
     };
 }
@@ -221,8 +221,11 @@ namespace pcl
       int previous_duplicity_complete_models_;
       float previous_bad_info_;
       float previous_unexplained_;
+      int n_active_hyp_; //number of active hypotheses in the current solution
 
       int max_iterations_; //max iterations without improvement
+      int n_restarts_; //number of independent annealing runs, the best solution is kept
+      unsigned int threads_;
       SAModel best_seen_;
       float initial_temp_;
 
@@ -439,6 +442,10 @@ namespace pcl
       void
       SAOptimize(std::vector<int> & cc_indices, std::vector<bool> & sub_solution);
 
+      //Runs one simulated annealing search on the evaluation state of this object and returns the best solution seen
+      SAModel
+      annealSolution(const std::vector<bool> & initial_solution, mets::gol_type initial_cost);
+
     public:
       GlobalHypothesesVerification() : HypothesisVerification<ModelT, SceneT>()
       {
@@ -452,6 +459,8 @@ namespace pcl
         clutter_regularizer_ = 5.f;
         res_occupancy_grid_ = 0.01f;
         w_occupied_multiple_cm_ = 4.f;
+        n_restarts_ = 1;
+        setNumberOfThreads ();
       }
 
       void
@@ -496,6 +505,21 @@ namespace pcl
       {
         detect_clutter_ = d;
       }
+
+      /** \brief Set the number of independent simulated annealing runs. The runs are executed concurrently and
+        * the solution with the lowest cost is kept.
+        * \param[in] n the number of runs (at least 1)
+        */
+      void setNumberOfRestarts(int n)
+      {
+        n_restarts_ = std::max (1, n);
+      }
+
+      /** \brief Set the number of threads used to compute the hypotheses cues and for the annealing runs.
+        * \param[in] nr_threads the number of hardware threads to use (0 takes as many as the budget of pcl::ExecutionContext allows when verifying)
+        */
+      void
+      setNumberOfThreads (unsigned int nr_threads = 0);
   };
 }
 
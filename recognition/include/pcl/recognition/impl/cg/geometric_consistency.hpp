@@ -44,6 +44,7 @@
 #include <pcl/registration/correspondence_types.h>
 #include <pcl/registration/correspondence_rejection_sample_consensus.h>
 #include <pcl/common/io.h>
+#include <pcl/common/execution_context.h>
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 inline bool
@@ -74,8 +75,7 @@ pcl::GeometricConsistencyGrouping<PointModelT, PointSceneT>::clusterCorresponden
 
   std::vector<int> consensus_set;
   std::vector<bool> taken_corresps (model_scene_corrs_->size (), false);
-
-  Eigen::Vector3f dist_ref, dist_trg;
+  std::vector<char> seed_consistent (model_scene_corrs_->size ());
 
   //temp copy of scene cloud with the type cast to ModelT in order to use Ransac
   PointCloudPtr temp_scene_cloud_ptr (new PointCloud ());
@@ -87,47 +87,65 @@ pcl::GeometricConsistencyGrouping<PointModelT, PointSceneT>::clusterCorresponden
   corr_rejector.setInputSource(input_);
   corr_rejector.setInputTarget (temp_scene_cloud_ptr);
 
-  for (std::size_t i = 0; i < model_scene_corrs_->size (); ++i)
+  //Checks if the distance between the scene points of two correspondences matches the one between their model points
+  const auto is_consistent = [this] (int k, int j)
+  {
+    int scene_index_k = model_scene_corrs_->at (k).index_match;
+    int model_index_k = model_scene_corrs_->at (k).index_query;
+    int scene_index_j = model_scene_corrs_->at (j).index_match;
+    int model_index_j = model_scene_corrs_->at (j).index_query;
+
+    const Eigen::Vector3f& scene_point_k = scene_->at (scene_index_k).getVector3fMap ();
+    const Eigen::Vector3f& model_point_k = input_->at (model_index_k).getVector3fMap ();
+    const Eigen::Vector3f& scene_point_j = scene_->at (scene_index_j).getVector3fMap ();
+    const Eigen::Vector3f& model_point_j = input_->at (model_index_j).getVector3fMap ();
+
+    Eigen::Vector3f dist_ref = scene_point_k - scene_point_j;
+    Eigen::Vector3f dist_trg = model_point_k - model_point_j;
+
+    double distance = std::abs (dist_ref.norm () - dist_trg.norm ());
+
+    return (!(distance > gc_size_));
+  };
+
+  const pcl::ThreadReservation reservation (threads_);
+  const unsigned int threads = reservation.getNumberOfThreads ();
+  const int n_corrs = static_cast<int> (model_scene_corrs_->size ());
+  for (int i = 0; i < n_corrs; ++i)
   {
     if (taken_corresps[i])
       continue;
 
     consensus_set.clear ();
-    consensus_set.push_back (static_cast<int> (i));
-    
-    for (std::size_t j = 0; j < model_scene_corrs_->size (); ++j)
+    consensus_set.push_back (i);
+
+    //The seed is the first element of the consensus set, so every candidate is checked against it first. This check
+    //does not depend on the growing consensus set and is done for all the candidates in parallel.
+#pragma omp parallel for \
+  default(none) \
+  shared(n_corrs, i, taken_corresps, seed_consistent, is_consistent) \
+  num_threads(threads)
+    for (int j = 0; j < n_corrs; ++j)
+      seed_consistent[j] = (j != i && !taken_corresps[j] && is_consistent (i, j));
+
+    for (int j = 0; j < n_corrs; ++j)
     {
-      if ( j != i &&  !taken_corresps[j])
+      if (!seed_consistent[j])
+        continue;
+
+      //Let's check if j fits into the rest of the current consensus set
+      bool is_a_good_candidate = true;
+      for (std::size_t k = 1; k < consensus_set.size (); ++k)
       {
-        //Let's check if j fits into the current consensus set
-        bool is_a_good_candidate = true;
-        for (const int &k : consensus_set)
+        if (!is_consistent (consensus_set[k], j))
         {
-          int scene_index_k = model_scene_corrs_->at (k).index_match;
-          int model_index_k = model_scene_corrs_->at (k).index_query;
-          int scene_index_j = model_scene_corrs_->at (j).index_match;
-          int model_index_j = model_scene_corrs_->at (j).index_query;
-          
-          const Eigen::Vector3f& scene_point_k = scene_->at (scene_index_k).getVector3fMap ();
-          const Eigen::Vector3f& model_point_k = input_->at (model_index_k).getVector3fMap ();
-          const Eigen::Vector3f& scene_point_j = scene_->at (scene_index_j).getVector3fMap ();
-          const Eigen::Vector3f& model_point_j = input_->at (model_index_j).getVector3fMap ();
-
-          dist_ref = scene_point_k - scene_point_j;
-          dist_trg = model_point_k - model_point_j;
-
-          double distance = std::abs (dist_ref.norm () - dist_trg.norm ());
-
-          if (distance > gc_size_)
-          {
-            is_a_good_candidate = false;
-            break;
-          }
+          is_a_good_candidate = false;
+          break;
         }
-
-        if (is_a_good_candidate)
-          consensus_set.push_back (static_cast<int> (j));
       }
+
+      if (is_a_good_candidate)
+        consensus_set.push_back (j);
     }
     
     if (static_cast<int> (consensus_set.size ()) > gc_threshold_)
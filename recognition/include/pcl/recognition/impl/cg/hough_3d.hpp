@@ -41,12 +41,13 @@
 #define PCL_RECOGNITION_HOUGH_3D_IMPL_H_
 
 #include <pcl/common/io.h> // for copyPointCloud
+#include <pcl/common/execution_context.h>
 #include <pcl/recognition/cg/hough_3d.h>
 #include <pcl/registration/correspondence_types.h>
 #include <pcl/registration/correspondence_rejection_sample_consensus.h>
 //#include <pcl/sample_consensus/ransac.h>
 //#include <pcl/sample_consensus/sac_model_registration.h>
-#include <pcl/features/normal_3d.h>
+#include <pcl/features/normal_3d_omp.h>
 #include <pcl/features/board.h>
 
 
@@ -60,7 +61,8 @@ pcl::Hough3DGrouping<PointModelT, PointSceneT, PointModelRfT, PointSceneRfT>::co
     local_rf_search_radius_ = static_cast<float> (hough_bin_size_);
   }
   pcl::PointCloud<Normal>::Ptr normal_cloud (new pcl::PointCloud<Normal> ());
-  NormalEstimation<PointType, Normal> norm_est;
+  NormalEstimationOMP<PointType, Normal> norm_est;
+  norm_est.setNumberOfThreads (threads_);
   norm_est.setInputCloud (input);
   if (local_rf_normals_search_radius_ <= 0.0f)
   {
@@ -187,7 +189,13 @@ pcl::Hough3DGrouping<PointModelT, PointSceneT, PointModelRfT, PointSceneRfT>::ho
 
   float max_distance = -std::numeric_limits<float>::max ();
 
-  // Calculating 3D Hough space dimensions and vote position for each match
+  const pcl::ThreadReservation reservation (threads_);
+  const unsigned int threads = reservation.getNumberOfThreads ();
+  // Calculating the vote position for each match
+#pragma omp parallel for \
+  default(none) \
+  shared(n_matches, scene_votes) \
+  num_threads(threads)
   for (int i=0; i< n_matches; ++i)
   {
     int scene_index = model_scene_corrs_->at (i).index_match;
@@ -206,21 +214,13 @@ pcl::Hough3DGrouping<PointModelT, PointSceneT, PointModelRfT, PointSceneRfT>::ho
     scene_votes[i].x () = scene_point_rf_x[0] * model_point_vote.x () + scene_point_rf_y[0] * model_point_vote.y () + scene_point_rf_z[0] * model_point_vote.z () + scene_point.x ();
     scene_votes[i].y () = scene_point_rf_x[1] * model_point_vote.x () + scene_point_rf_y[1] * model_point_vote.y () + scene_point_rf_z[1] * model_point_vote.z () + scene_point.y ();
     scene_votes[i].z () = scene_point_rf_x[2] * model_point_vote.x () + scene_point_rf_y[2] * model_point_vote.y () + scene_point_rf_z[2] * model_point_vote.z () + scene_point.z ();
+  }
 
-    if (scene_votes[i].x () < d_min.x ()) 
-      d_min.x () = scene_votes[i].x (); 
-    if (scene_votes[i].x () > d_max.x ()) 
-      d_max.x () = scene_votes[i].x (); 
-
-    if (scene_votes[i].y () < d_min.y ()) 
-      d_min.y () = scene_votes[i].y (); 
-    if (scene_votes[i].y () > d_max.y ()) 
-      d_max.y () = scene_votes[i].y (); 
-
-    if (scene_votes[i].z () < d_min.z ()) 
-      d_min.z () = scene_votes[i].z (); 
-    if (scene_votes[i].z () > d_max.z ()) 
-      d_max.z () = scene_votes[i].z ();
+  // Calculating 3D Hough space dimensions
+  for (int i=0; i< n_matches; ++i)
+  {
+    d_min = d_min.cwiseMin (scene_votes[i]);
+    d_max = d_max.cwiseMax (scene_votes[i]);
 
     // Calculate max distance for interpolated votes
     if (use_interpolation_ && max_distance < model_scene_corrs_->at (i).distance)
@@ -229,26 +229,17 @@ pcl::Hough3DGrouping<PointModelT, PointSceneT, PointModelRfT, PointSceneRfT>::ho
     }
   }
 
-  // Hough Voting
-  hough_space_.reset (new pcl::recognition::HoughSpace3D (d_min, bin_size, d_max));
-
-  for (int i = 0; i < n_matches; ++i)
+  std::vector<double> weights (n_matches, 1.0);
+  if (use_distance_weight_ && max_distance != 0)
   {
-    double weight = 1.0;
-    if (use_distance_weight_ && max_distance != 0)
-    {
-      weight = 1.0 - (model_scene_corrs_->at (i).distance / max_distance);
-    }
-    if (use_interpolation_)
-    {
-      hough_space_->voteInt (scene_votes[i], weight, i);
-    } 
-    else
-    {
-      hough_space_->vote (scene_votes[i], weight, i);
-    }
+    for (int i = 0; i < n_matches; ++i)
+      weights[i] = 1.0 - (model_scene_corrs_->at (i).distance / max_distance);
   }
 
+  // Hough Voting
+  hough_space_.reset (new pcl::recognition::HoughSpace3D (d_min, bin_size, d_max));
+  hough_space_->castVotes (scene_votes, weights, use_interpolation_, threads);
+
   hough_space_initialized_ = true;
 
   return (true);
@@ -39,6 +39,7 @@
 
 #include <pcl/recognition/hv/hv_go.h>
 #include <pcl/common/common.h> // for getMinMax3D
+#include <pcl/common/execution_context.h>
 #include <pcl/common/time.h>
 #include <pcl/point_types.h>
 
@@ -140,6 +141,14 @@ inline void extractEuclideanClustersSmooth(const typename pcl::PointCloud<PointT
   }
 }
 
+template<typename ModelT, typename SceneT>
+void pcl::GlobalHypothesesVerification<ModelT, SceneT>::setNumberOfThreads (unsigned int nr_threads)
+{
+  // 0 is resolved against the budget of pcl::ExecutionContext at compute time
+  threads_ = nr_threads;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
 template<typename ModelT, typename SceneT>
 mets::gol_type pcl::GlobalHypothesesVerification<ModelT, SceneT>::evaluateSolution(const std::vector<bool> & active, int changed)
 {
@@ -173,11 +182,9 @@ mets::gol_type pcl::GlobalHypothesesVerification<ModelT, SceneT>::evaluateSoluti
 
   setPreviousBadInfo (bad_info);
 
-  int n_active_hyp = 0;
-  for(const bool i : active) {
-    if(i)
-      n_active_hyp++;
-  }
+  //only the changed hypothesis can alter the number of active ones
+  n_active_hyp_ += active[changed] ? 1 : -1;
+  const int n_active_hyp = n_active_hyp_;
 
   float duplicity_cm = static_cast<float> (getDuplicityCM ()) * w_occupied_multiple_cm_;
   return static_cast<mets::gol_type> ((good_info - bad_info - static_cast<float> (duplicity) - unexplained_info - duplicity_cm - static_cast<float> (n_active_hyp)) * -1.f); //return the dual to our max problem
@@ -187,6 +194,8 @@ mets::gol_type pcl::GlobalHypothesesVerification<ModelT, SceneT>::evaluateSoluti
 template<typename ModelT, typename SceneT>
 void pcl::GlobalHypothesesVerification<ModelT, SceneT>::initialize()
 {
+  const pcl::ThreadReservation reservation (threads_);
+  const unsigned int threads = reservation.getNumberOfThreads ();
   //clear stuff
   recognition_models_.clear ();
   unexplained_by_RM_neighboorhods.clear ();
@@ -284,20 +293,31 @@ void pcl::GlobalHypothesesVerification<ModelT, SceneT>::initialize()
   //compute cues
   {
     pcl::ScopeTime tcues ("Computing cues");
-    recognition_models_.resize (complete_models_.size ());
-    int valid = 0;
-    for (int i = 0; i < static_cast<int> (complete_models_.size ()); i++)
+    //the hypotheses are independent of each other, the valid ones are compacted afterwards keeping their order
+    int n_models = static_cast<int> (complete_models_.size ());
+    std::vector<RecognitionModelPtr> models (n_models);
+    std::vector<char> added (n_models, 0);
+#pragma omp parallel for \
+  default(none) \
+  shared(n_models, models, added) \
+  schedule(dynamic) \
+  num_threads(threads)
+    for (int i = 0; i < n_models; i++)
     {
       //create recognition model
-      recognition_models_[valid].reset (new RecognitionModel ());
-      if(addModel (visible_models_[i], complete_models_[i], recognition_models_[valid])) {
-        indices_[valid] = i;
-        valid++;
-      }
+      models[i].reset (new RecognitionModel ());
+      added[i] = addModel (visible_models_[i], complete_models_[i], models[i]);
     }
 
-    recognition_models_.resize(valid);
-    indices_.resize(valid);
+    recognition_models_.clear ();
+    indices_.clear ();
+    for (int i = 0; i < n_models; i++)
+    {
+      if (added[i]) {
+        recognition_models_.push_back (models[i]);
+        indices_.push_back (i);
+      }
+    }
   }
 
   //compute the bounding boxes for the models
@@ -335,11 +355,18 @@ void pcl::GlobalHypothesesVerification<ModelT, SceneT>::initialize()
 
   complete_cloud_occupancy_by_RM_.resize (size_x * size_y * size_z, 0);
 
-  for (std::size_t i = 0; i < recognition_models_.size (); i++)
+  //collect the distinct occupied cells of each hypothesis in parallel and count the occupancy afterwards
+  int n_recog_models = static_cast<int> (recognition_models_.size ());
+#pragma omp parallel for \
+  default(none) \
+  shared(n_recog_models, min_pt_all, size_x, size_y) \
+  schedule(dynamic) \
+  num_threads(threads)
+  for (int i = 0; i < n_recog_models; i++)
   {
-
-    std::map<int, bool> banned;
-    std::map<int, bool>::iterator banned_it;
+    std::vector<int> & occupancy_indices = recognition_models_[i]->complete_cloud_occupancy_indices_;
+    occupancy_indices.clear ();
+    occupancy_indices.reserve (complete_models_[indices_[i]]->size ());
 
     for (const auto& point: *complete_models_[indices_[i]])
     {
@@ -347,24 +374,25 @@ void pcl::GlobalHypothesesVerification<ModelT, SceneT>::initialize()
       const int pos_y = static_cast<int> (std::floor ((point.y - min_pt_all.y) / res_occupancy_grid_));
       const int pos_z = static_cast<int> (std::floor ((point.z - min_pt_all.z) / res_occupancy_grid_));
 
-      const int idx = pos_z * size_x * size_y + pos_y * size_x + pos_x;
-      banned_it = banned.find (idx);
-      if (banned_it == banned.end ())
-      {
-        complete_cloud_occupancy_by_RM_[idx]++;
-        recognition_models_[i]->complete_cloud_occupancy_indices_.push_back (idx);
-        banned[idx] = true;
-      }
+      occupancy_indices.push_back (pos_z * size_x * size_y + pos_y * size_x + pos_x);
     }
+
+    std::sort (occupancy_indices.begin (), occupancy_indices.end ());
+    occupancy_indices.erase (std::unique (occupancy_indices.begin (), occupancy_indices.end ()), occupancy_indices.end ());
   }
 
+  for (const auto &recog_model : recognition_models_)
+    for (const int &idx : recog_model->complete_cloud_occupancy_indices_)
+      complete_cloud_occupancy_by_RM_[idx]++;
+
   {
     pcl::ScopeTime tcues ("Computing clutter cues");
 #pragma omp parallel for \
   default(none) \
+  shared(n_recog_models) \
   schedule(dynamic, 4) \
-  num_threads(omp_get_num_procs())
-    for (int j = 0; j < static_cast<int> (recognition_models_.size ()); j++)
+  num_threads(threads)
+    for (int j = 0; j < n_recog_models; j++)
       computeClutterCue (recognition_models_[j]);
   }
 
@@ -435,32 +463,49 @@ void pcl::GlobalHypothesesVerification<ModelT, SceneT>::SAOptimize(std::vector<i
   setPreviousDuplicity (duplicity);
   setPreviousBadInfo (bad_information_);
   setPreviousUnexplainedValue (unexplained_in_neighboorhod);
+  n_active_hyp_ = static_cast<int> (std::count (initial_solution.begin (), initial_solution.end (), true));
 
-  SAModel model;
-  model.cost_ = static_cast<mets::gol_type> ((good_information_ - bad_information_
+  mets::gol_type initial_cost = static_cast<mets::gol_type> ((good_information_ - bad_information_
                                                - static_cast<float> (duplicity)
                                                - static_cast<float> (occupied_multiple) * w_occupied_multiple_cm_
                                                - static_cast<float> (recognition_models_.size ())
                                                - unexplained_in_neighboorhod) * -1.f);
 
-  model.setSolution (initial_solution);
-  model.setOptimizer (this);
-  SAModel best (model);
-
-  move_manager neigh (static_cast<int> (cc_indices.size ()));
-
-  mets::best_ever_solution best_recorder (best);
-  mets::noimprove_termination_criteria noimprove (max_iterations_);
-  mets::linear_cooling linear_cooling;
-  mets::simulated_annealing<move_manager> sa (model, best_recorder, neigh, noimprove, linear_cooling, initial_temp_, 1e-7, 2);
-  sa.setApplyAndEvaluate(true);
-
   {
     pcl::ScopeTime t ("SA search...");
-    sa.search ();
+    if (n_restarts_ <= 1)
+    {
+      best_seen_ = annealSolution (initial_solution, initial_cost);
+    }
+    else
+    {
+      //every run anneals a copy of the evaluation state, the recognition models are only read
+      std::vector<SAModel> runs_best (n_restarts_);
+      const pcl::ThreadReservation reservation (threads_);
+      const unsigned int threads = reservation.getNumberOfThreads ();
+#pragma omp parallel for \
+  default(none) \
+  shared(runs_best, initial_solution, initial_cost) \
+  schedule(dynamic) \
+  num_threads(threads)
+      for (int r = 0; r < n_restarts_; r++)
+      {
+        GlobalHypothesesVerification<ModelT, SceneT> run_state (*this);
+        runs_best[r] = run_state.annealSolution (initial_solution, initial_cost);
+      }
+
+      std::size_t best_run = 0;
+      for (std::size_t r = 1; r < runs_best.size (); r++)
+      {
+        if (runs_best[r].cost_ < runs_best[best_run].cost_)
+          best_run = r;
+      }
+
+      best_seen_ = runs_best[best_run];
+      best_seen_.setOptimizer (this);
+    }
   }
 
-  best_seen_ = static_cast<const SAModel&> (best_recorder.best_seen ());
   for (std::size_t i = 0; i < best_seen_.solution_.size (); i++)
   {
     initial_solution[i] = best_seen_.solution_[i];
@@ -470,6 +515,30 @@ void pcl::GlobalHypothesesVerification<ModelT, SceneT>::SAOptimize(std::vector<i
 
 }
 
+template<typename ModelT, typename SceneT>
+typename pcl::GlobalHypothesesVerification<ModelT, SceneT>::SAModel
+pcl::GlobalHypothesesVerification<ModelT, SceneT>::annealSolution(const std::vector<bool> & initial_solution, mets::gol_type initial_cost)
+{
+  //Define model SAModel, the state of this object has to correspond to initial_solution
+  std::vector<bool> solution (initial_solution);
+  SAModel model;
+  model.cost_ = initial_cost;
+  model.setSolution (solution);
+  model.setOptimizer (this);
+  SAModel best (model);
+
+  move_manager neigh (static_cast<int> (initial_solution.size ()));
+
+  mets::best_ever_solution best_recorder (best);
+  mets::noimprove_termination_criteria noimprove (max_iterations_);
+  mets::linear_cooling linear_cooling;
+  mets::simulated_annealing<move_manager> sa (model, best_recorder, neigh, noimprove, linear_cooling, initial_temp_, 1e-7, 2);
+  sa.setApplyAndEvaluate(true);
+  sa.search ();
+
+  return static_cast<const SAModel&> (best_recorder.best_seen ());
+}
+
 ///////////////////////////////////////////////////////////////////////////////////////////////////
 template<typename ModelT, typename SceneT>
 void pcl::GlobalHypothesesVerification<ModelT, SceneT>::verify()
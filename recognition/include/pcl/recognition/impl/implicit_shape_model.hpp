@@ -42,8 +42,10 @@
 #define PCL_IMPLICIT_SHAPE_MODEL_HPP_
 
 #include "../implicit_shape_model.h"
+#include <pcl/common/execution_context.h>
 #include <pcl/filters/voxel_grid.h> // for VoxelGrid
 #include <pcl/filters/extract_indices.h> // for ExtractIndices
+#include <pcl/search/kdtree.h> // for KdTree
 
 #include <pcl/memory.h>  // for dynamic_pointer_cast
 
@@ -51,11 +53,11 @@
 template <typename PointT>
 pcl::features::ISMVoteList<PointT>::ISMVoteList () :
   votes_ (new pcl::PointCloud<pcl::InterestPoint> ()),
-  tree_is_valid_ (false),
+  grid_is_valid_ (false),
   votes_origins_ (new pcl::PointCloud<PointT> ()),
   votes_class_ (0),
-  k_ind_ (0),
-  k_sqr_dist_ (0)
+  grid_cell_size_ (0.0f),
+  threads_ (1)
 {
 }
 
@@ -66,9 +68,8 @@ pcl::features::ISMVoteList<PointT>::~ISMVoteList ()
   votes_class_.clear ();
   votes_origins_.reset ();
   votes_.reset ();
-  k_ind_.clear ();
-  k_sqr_dist_.clear ();
-  tree_.reset ();
+  grid_cells_.clear ();
+  grid_votes_.clear ();
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////
@@ -76,7 +77,7 @@ template <typename PointT> void
 pcl::features::ISMVoteList<PointT>::addVote (
     pcl::InterestPoint& vote, const PointT &vote_origin, int votes_class)
 {
-  tree_is_valid_ = false;
+  grid_is_valid_ = false;
   votes_->points.insert (votes_->points.end (), vote);// TODO: adjust height and width
 
   votes_origins_->points.push_back (vote_origin);
@@ -130,8 +131,6 @@ pcl::features::ISMVoteList<PointT>::findStrongestPeaks (
   double in_non_maxima_radius,
   double in_sigma)
 {
-  validateTree ();
-
   const std::size_t n_vote_classes = votes_class_.size ();
   if (n_vote_classes == 0)
     return;
@@ -142,11 +141,20 @@ pcl::features::ISMVoteList<PointT>::findStrongestPeaks (
   // on the votes. Intuitively, it is likely to get a good location in dense regions.
   const int NUM_INIT_PTS = 100;
   double SIGMA_DIST = in_sigma;// rule of thumb: 10% of the object radius
-  const double FINAL_EPS = SIGMA_DIST / 100;// another heuristic
+  double FINAL_EPS = SIGMA_DIST / 100;// another heuristic
 
   std::vector<Eigen::Vector3f, Eigen::aligned_allocator<Eigen::Vector3f> > peaks (NUM_INIT_PTS);
   std::vector<double> peak_densities (NUM_INIT_PTS);
-  double max_density = -1.0;
+
+  // the grid is built once, after that the mean shift runs only read it
+  validateGrid (3 * SIGMA_DIST);
+
+  const pcl::ThreadReservation reservation (threads_);
+  const unsigned int threads = reservation.getNumberOfThreads ();
+#pragma omp parallel for \
+  default(none) \
+  shared(peaks, peak_densities, SIGMA_DIST, FINAL_EPS) \
+  num_threads(threads)
   for (int i = 0; i < NUM_INIT_PTS; i++)
   {
     Eigen::Vector3f old_center;
@@ -159,7 +167,7 @@ pcl::features::ISMVoteList<PointT>::findStrongestPeaks (
       curr_center = shiftMean (old_center, SIGMA_DIST);
     } while ((old_center - curr_center).norm () > FINAL_EPS);
 
-    pcl::PointXYZ point;
+    PointT point;
     point.x = curr_center (0);
     point.y = curr_center (1);
     point.z = curr_center (2);
@@ -168,9 +176,6 @@ pcl::features::ISMVoteList<PointT>::findStrongestPeaks (
 
     peaks[i] = curr_center;
     peak_densities[i] = curr_density;
-
-    if ( max_density < curr_density )
-      max_density = curr_density;
   }
 
   //extract peaks
@@ -222,43 +227,102 @@ pcl::features::ISMVoteList<PointT>::findStrongestPeaks (
   }
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> std::uint64_t
+pcl::features::ISMVoteList<PointT>::cellKey (int x, int y, int z)
+{
+  // 21 bits per coordinate; cells that wrap onto the same key only cost extra distance checks
+  const std::uint64_t mask = (std::uint64_t (1) << 21) - 1;
+  return (((static_cast<std::uint64_t> (x) & mask) << 42) |
+          ((static_cast<std::uint64_t> (y) & mask) << 21) |
+           (static_cast<std::uint64_t> (z) & mask));
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointT> void
-pcl::features::ISMVoteList<PointT>::validateTree ()
+pcl::features::ISMVoteList<PointT>::validateGrid (double radius)
 {
-  if (!tree_is_valid_)
+  const float cell_size = static_cast<float> (radius);
+  if (grid_is_valid_ && grid_cell_size_ == cell_size)
+    return;
+
+  // cells as large as the search radius: every neighbourhood lies in the 3x3x3 cells around it
+  grid_cell_size_ = cell_size;
+  grid_cells_.clear ();
+
+  const std::size_t n_votes = votes_->size ();
+  std::vector<std::uint64_t> keys (n_votes);
+  for (std::size_t i_vote = 0; i_vote < n_votes; i_vote++)
   {
-    if (tree_ == nullptr)
-      tree_.reset (new pcl::KdTreeFLANN<pcl::InterestPoint>);
-    tree_->setInputCloud (votes_);
-    k_ind_.resize ( votes_->size (), -1 );
-    k_sqr_dist_.resize ( votes_->size (), 0.0f );
-    tree_is_valid_ = true;
+    const pcl::InterestPoint& vote = (*votes_)[i_vote];
+    keys[i_vote] = cellKey (static_cast<int> (std::floor (vote.x / cell_size)),
+                            static_cast<int> (std::floor (vote.y / cell_size)),
+                            static_cast<int> (std::floor (vote.z / cell_size)));
+    grid_cells_[keys[i_vote]].second++;
   }
+
+  // turn the counts into ranges, second is then used as the insertion cursor
+  std::uint32_t offset = 0;
+  for (auto& cell : grid_cells_)
+  {
+    const std::uint32_t count = cell.second.second;
+    cell.second.first = cell.second.second = offset;
+    offset += count;
+  }
+
+  grid_votes_.resize (n_votes);
+  for (std::size_t i_vote = 0; i_vote < n_votes; i_vote++)
+  {
+    const pcl::InterestPoint& vote = (*votes_)[i_vote];
+    grid_votes_[grid_cells_[keys[i_vote]].second++] = Eigen::Vector4f (vote.x, vote.y, vote.z, vote.strength);
+  }
+
+  grid_is_valid_ = true;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> template <typename Visitor> void
+pcl::features::ISMVoteList<PointT>::visitNeighbours (
+    const Eigen::Vector3f& center, double radius, Visitor visitor) const
+{
+  const float sqr_radius = static_cast<float> (radius * radius);
+  const int cell_x = static_cast<int> (std::floor (center[0] / grid_cell_size_));
+  const int cell_y = static_cast<int> (std::floor (center[1] / grid_cell_size_));
+  const int cell_z = static_cast<int> (std::floor (center[2] / grid_cell_size_));
+
+  for (int dx = -1; dx <= 1; dx++)
+    for (int dy = -1; dy <= 1; dy++)
+      for (int dz = -1; dz <= 1; dz++)
+      {
+        const auto cell = grid_cells_.find (cellKey (cell_x + dx, cell_y + dy, cell_z + dz));
+        if (cell == grid_cells_.end ())
+          continue;
+
+        for (std::uint32_t i_vote = cell->second.first; i_vote < cell->second.second; i_vote++)
+        {
+          const Eigen::Vector4f& vote = grid_votes_[i_vote];
+          const float sqr_dist = (vote.head<3> () - center).squaredNorm ();
+          if (sqr_dist <= sqr_radius)
+            visitor (vote, sqr_dist);
+        }
+      }
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointT> Eigen::Vector3f
 pcl::features::ISMVoteList<PointT>::shiftMean (const Eigen::Vector3f& snap_pt, const double in_sigma_dist)
 {
-  validateTree ();
+  validateGrid (3 * in_sigma_dist);
 
   Eigen::Vector3f wgh_sum (0.0, 0.0, 0.0);
   double denom = 0.0;
 
-  pcl::InterestPoint pt;
-  pt.x = snap_pt[0];
-  pt.y = snap_pt[1];
-  pt.z = snap_pt[2];
-  std::size_t n_pts = tree_->radiusSearch (pt, 3*in_sigma_dist, k_ind_, k_sqr_dist_);
-
-  for (std::size_t j = 0; j < n_pts; j++)
+  visitNeighbours (snap_pt, 3 * in_sigma_dist, [&] (const Eigen::Vector4f& vote, float sqr_dist)
   {
-    double kernel = (*votes_)[k_ind_[j]].strength * std::exp (-k_sqr_dist_[j] / (in_sigma_dist * in_sigma_dist));
-    Eigen::Vector3f vote_vec ((*votes_)[k_ind_[j]].x, (*votes_)[k_ind_[j]].y, (*votes_)[k_ind_[j]].z);
-    wgh_sum += vote_vec * static_cast<float> (kernel);
+    double kernel = vote[3] * std::exp (-sqr_dist / (in_sigma_dist * in_sigma_dist));
+    wgh_sum += vote.head<3> () * static_cast<float> (kernel);
     denom += kernel;
-  }
+  });
   assert (denom > 0.0); // at least one point is close. In fact, this case should be handled too
 
   return (wgh_sum / static_cast<float> (denom));
@@ -269,22 +333,17 @@ template <typename PointT> double
 pcl::features::ISMVoteList<PointT>::getDensityAtPoint (
     const PointT &point, double sigma_dist)
 {
-  validateTree ();
-
   const std::size_t n_vote_classes = votes_class_.size ();
   if (n_vote_classes == 0)
     return (0.0);
 
-  double sum_vote = 0.0;
+  validateGrid (3 * sigma_dist);
 
-  pcl::InterestPoint pt;
-  pt.x = point.x;
-  pt.y = point.y;
-  pt.z = point.z;
-  std::size_t num_of_pts = tree_->radiusSearch (pt, 3 * sigma_dist, k_ind_, k_sqr_dist_);
-
-  for (std::size_t j = 0; j < num_of_pts; j++)
-    sum_vote += (*votes_)[k_ind_[j]].strength * std::exp (-k_sqr_dist_[j] / (sigma_dist * sigma_dist));
+  double sum_vote = 0.0;
+  visitNeighbours (point.getVector3fMap (), 3 * sigma_dist, [&] (const Eigen::Vector4f& vote, float sqr_dist)
+  {
+    sum_vote += vote[3] * std::exp (-sqr_dist / (sigma_dist * sigma_dist));
+  });
 
   return (sum_vote);
 }
@@ -296,6 +355,14 @@ pcl::features::ISMVoteList<PointT>::getNumberOfVotes ()
   return (static_cast<unsigned int> (votes_->size ()));
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::features::ISMVoteList<PointT>::setNumberOfThreads (unsigned int nr_threads)
+{
+  // 0 is resolved against the budget of pcl::ExecutionContext at compute time
+  threads_ = nr_threads;
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////
 pcl::features::ISMModel::ISMModel () :
   statistical_weights_ (0),
@@ -554,7 +621,8 @@ pcl::ism::ImplicitShapeModelEstimation<FeatureSize, PointT, NormalT>::ImplicitSh
   sampling_size_ (0.1f),
   feature_estimator_ (),
   number_of_clusters_ (184),
-  n_vot_ON_ (true)
+  n_vot_ON_ (true),
+  threads_ (1)
 {
 }
 
@@ -679,6 +747,14 @@ pcl::ism::ImplicitShapeModelEstimation<FeatureSize, PointT, NormalT>::setSigmaDi
   training_sigmas_.swap (sigmas);
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <int FeatureSize, typename PointT, typename NormalT> void
+pcl::ism::ImplicitShapeModelEstimation<FeatureSize, PointT, NormalT>::setNumberOfThreads (unsigned int nr_threads)
+{
+  // 0 is resolved against the budget of pcl::ExecutionContext at compute time
+  threads_ = nr_threads;
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////
 template <int FeatureSize, typename PointT, typename NormalT> bool
 pcl::ism::ImplicitShapeModelEstimation<FeatureSize, PointT, NormalT>::getNVotState ()
@@ -756,6 +832,7 @@ pcl::ism::ImplicitShapeModelEstimation<FeatureSize, PointT, NormalT>::findObject
   int in_class_of_interest)
 {
   typename pcl::features::ISMVoteList<PointT>::Ptr out_votes (new pcl::features::ISMVoteList<PointT> ());
+  out_votes->setNumberOfThreads (threads_);
 
   if (in_cloud->points.empty ())
     return (out_votes);
@@ -771,40 +848,19 @@ pcl::ism::ImplicitShapeModelEstimation<FeatureSize, PointT, NormalT>::findObject
 
   //find nearest cluster
   const unsigned int n_key_points = static_cast<unsigned int> (sampled_point_cloud->size ());
-  std::vector<int> min_dist_inds (n_key_points, -1);
+  Eigen::MatrixXf descriptors (n_key_points, FeatureSize);
   for (unsigned int i_point = 0; i_point < n_key_points; i_point++)
-  {
-    Eigen::VectorXf curr_descriptor (FeatureSize);
-    for (int i_dim = 0; i_dim < FeatureSize; i_dim++)
-      curr_descriptor (i_dim) = (*feature_cloud)[i_point].histogram[i_dim];
+    descriptors.row (i_point) = Eigen::VectorXf::Map ((*feature_cloud)[i_point].histogram, FeatureSize);
 
-    float descriptor_sum = curr_descriptor.sum ();
-    if (descriptor_sum < std::numeric_limits<float>::epsilon ())
-      continue;
-
-    unsigned int min_dist_idx = 0;
-    Eigen::VectorXf clusters_center (FeatureSize);
-    for (int i_dim = 0; i_dim < FeatureSize; i_dim++)
-      clusters_center (i_dim) = model->clusters_centers_ (min_dist_idx, i_dim);
-
-    float best_dist = computeDistance (curr_descriptor, clusters_center);
-    for (unsigned int i_clust_cent = 0; i_clust_cent < number_of_clusters_; i_clust_cent++)
-    {
-      for (int i_dim = 0; i_dim < FeatureSize; i_dim++)
-        clusters_center (i_dim) = model->clusters_centers_ (i_clust_cent, i_dim);
-      float curr_dist = computeDistance (clusters_center, curr_descriptor);
-      if (curr_dist < best_dist)
-      {
-        min_dist_idx = i_clust_cent;
-        best_dist = curr_dist;
-      }
-    }
-    min_dist_inds[i_point] = min_dist_idx;
-  }//next keypoint
+  Eigen::MatrixXi min_dist_inds (n_key_points, 1);
+  assignToNearestCenters (descriptors, model->clusters_centers_, min_dist_inds);
+  for (unsigned int i_point = 0; i_point < n_key_points; i_point++)
+    if (descriptors.row (i_point).sum () < std::numeric_limits<float>::epsilon ())
+      min_dist_inds (i_point, 0) = -1;
 
   for (std::size_t i_point = 0; i_point < n_key_points; i_point++)
   {
-    int min_dist_idx = min_dist_inds[i_point];
+    int min_dist_idx = min_dist_inds (i_point, 0);
     if (min_dist_idx == -1)
       continue;
 
@@ -1385,29 +1441,7 @@ pcl::ism::ImplicitShapeModelEstimation<FeatureSize, PointT, NormalT>::computeKMe
           }
         }
       }
-      compactness = 0.0f;
-      for (std::size_t i_point = 0; i_point < number_of_points; i_point++)
-      {
-        Eigen::VectorXf sample (feature_dimension);
-        sample = points_to_cluster.row (i_point);
-
-        int k_best = 0;
-        float min_dist = std::numeric_limits<float>::max ();
-
-        for (int i_cluster = 0; i_cluster < number_of_clusters; i_cluster++)
-        {
-          Eigen::VectorXf center (feature_dimension);
-          center = centers.row (i_cluster);
-          float dist = computeDistance (sample, center);
-          if (min_dist > dist)
-          {
-            min_dist = dist;
-            k_best = i_cluster;
-          }
-        }
-        compactness += min_dist;
-        labels (i_point, 0) = k_best;
-      }
+      compactness = assignToNearestCenters (points_to_cluster, centers, labels);
     }//next iteration
 
     if (compactness < best_compactness)
@@ -1441,13 +1475,16 @@ pcl::ism::ImplicitShapeModelEstimation<FeatureSize, PointT, NormalT>::generateCe
   unsigned int random_unsigned = rand ();
   centers[0] = random_unsigned % number_of_points;
 
-  for (unsigned int i_point = 0; i_point < number_of_points; i_point++)
+  const pcl::ThreadReservation reservation (threads_);
+  const unsigned int threads = reservation.getNumberOfThreads ();
+#pragma omp parallel for \
+  default(none) \
+  shared(data, dist, centers, number_of_points) \
+  reduction(+:sum0) \
+  num_threads(threads)
+  for (std::ptrdiff_t i_point = 0; i_point < static_cast<std::ptrdiff_t> (number_of_points); i_point++)
   {
-    Eigen::VectorXf first (dimension);
-    Eigen::VectorXf second (dimension);
-    first = data.row (i_point);
-    second = data.row (centers[0]);
-    dist[i_point] = computeDistance (first, second);
+    dist[i_point] = (data.row (i_point) - data.row (centers[0])).squaredNorm ();
     sum0 += dist[i_point];
   }
 
@@ -1469,13 +1506,14 @@ pcl::ism::ImplicitShapeModelEstimation<FeatureSize, PointT, NormalT>::generateCe
       int ci = i_point;
 
       double s = 0.0;
-      for (unsigned int i_point = 0; i_point < number_of_points; i_point++)
+#pragma omp parallel for \
+  default(none) \
+  shared(data, dist, tdist2, ci, number_of_points) \
+  reduction(+:s) \
+  num_threads(threads)
+      for (std::ptrdiff_t i_point = 0; i_point < static_cast<std::ptrdiff_t> (number_of_points); i_point++)
       {
-        Eigen::VectorXf first (dimension);
-        Eigen::VectorXf second (dimension);
-        first = data.row (i_point);
-        second = data.row (ci);
-        tdist2[i_point] = std::min (static_cast<double> (computeDistance (first, second)), dist[i_point]);
+        tdist2[i_point] = std::min (static_cast<double> ((data.row (i_point) - data.row (ci)).squaredNorm ()), dist[i_point]);
         s += tdist2[i_point];
       }
 
@@ -1513,6 +1551,40 @@ pcl::ism::ImplicitShapeModelEstimation<FeatureSize, PointT, NormalT>::generateRa
   }
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <int FeatureSize, typename PointT, typename NormalT> double
+pcl::ism::ImplicitShapeModelEstimation<FeatureSize, PointT, NormalT>::assignToNearestCenters (
+  const Eigen::MatrixXf& points,
+  const Eigen::MatrixXf& centers,
+  Eigen::MatrixXi& labels)
+{
+  // column-major copies keep every descriptor contiguous, so a whole center block
+  // is compared against one point in a single vectorized expression
+  const Eigen::MatrixXf points_t = points.transpose ();
+  const Eigen::MatrixXf centers_t = centers.transpose ();
+  const std::ptrdiff_t number_of_points = points_t.cols ();
+
+  labels.resize (number_of_points, 1);
+  double compactness = 0.0;
+
+  const pcl::ThreadReservation reservation (threads_);
+  const unsigned int threads = reservation.getNumberOfThreads ();
+#pragma omp parallel for \
+  default(none) \
+  shared(points_t, centers_t, labels, number_of_points) \
+  reduction(+:compactness) \
+  num_threads(threads)
+  for (std::ptrdiff_t i_point = 0; i_point < number_of_points; i_point++)
+  {
+    Eigen::Index k_best = 0;
+    const float min_dist = (centers_t.colwise () - points_t.col (i_point)).colwise ().squaredNorm ().minCoeff (&k_best);
+    compactness += min_dist;
+    labels (i_point, 0) = static_cast<int> (k_best);
+  }
+
+  return (compactness);
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////
 template <int FeatureSize, typename PointT, typename NormalT> float
 pcl::ism::ImplicitShapeModelEstimation<FeatureSize, PointT, NormalT>::computeDistance (Eigen::VectorXf& vec_1, Eigen::VectorXf& vec_2)
@@ -44,7 +44,9 @@
 #include <pcl/point_representation.h>
 #include <pcl/features/feature.h>
 #include <pcl/features/spin_image.h>
-#include <pcl/kdtree/kdtree_flann.h> // for KdTreeFLANN
+
+#include <cstdint>
+#include <unordered_map>
 
 namespace pcl
 {
@@ -117,11 +119,31 @@ namespace pcl
         unsigned int
         getNumberOfVotes ();
 
+        /** \brief Sets the number of threads used to run the mean shift searches of findStrongestPeaks.
+          * \param[in] nr_threads the number of hardware threads to use (0 takes as many as the budget of
+          * pcl::ExecutionContext allows when searching)
+          */
+        void
+        setNumberOfThreads (unsigned int nr_threads = 0);
+
       protected:
 
-        /** \brief this method is simply setting up the search tree. */
+        /** \brief This method builds the spatial hash of the votes for the given neighbourhood radius,
+          * if it is not already valid for that radius.
+          * \param[in] radius radius of the neighbourhoods that will be queried
+          */
         void
-        validateTree ();
+        validateGrid (double radius);
+
+        /** \brief Calls visitor (vote, sqr_distance) for every vote closer than radius to center, where
+          * vote holds (x, y, z, strength). validateGrid (radius) must have been called before.
+          */
+        template <typename Visitor> void
+        visitNeighbours (const Eigen::Vector3f& center, double radius, Visitor visitor) const;
+
+        /** \brief Returns the key of the grid cell with the given integer coordinates. */
+        static std::uint64_t
+        cellKey (int x, int y, int z);
 
         Eigen::Vector3f
         shiftMean (const Eigen::Vector3f& snapPt, const double in_dSigmaDist);
@@ -131,8 +153,8 @@ namespace pcl
         /** \brief Stores all votes. */
         pcl::PointCloud<pcl::InterestPoint>::Ptr votes_;
 
-        /** \brief Signalizes if the tree is valid. */
-        bool tree_is_valid_;
+        /** \brief Signalizes if the vote grid is valid. */
+        bool grid_is_valid_;
 
         /** \brief Stores the origins of the votes. */
         typename pcl::PointCloud<PointT>::Ptr votes_origins_;
@@ -140,14 +162,18 @@ namespace pcl
         /** \brief Stores classes for which every single vote was cast. */
         std::vector<int> votes_class_;
 
-        /** \brief Stores the search tree. */
-        pcl::KdTreeFLANN<pcl::InterestPoint>::Ptr tree_;
+        /** \brief Edge length of the cells of the vote grid. */
+        float grid_cell_size_;
 
-        /** \brief Stores neighbours indices. */
-        pcl::Indices k_ind_;
+        /** \brief Spatial hash of the votes: maps a cell key to the range [first, second) of
+          * grid_votes_ holding the votes that fall into that cell. */
+        std::unordered_map<std::uint64_t, std::pair<std::uint32_t, std::uint32_t> > grid_cells_;
 
-        /** \brief Stores square distances to the corresponding neighbours. */
-        std::vector<float> k_sqr_dist_;
+        /** \brief Flat copy of the votes grouped by cell, as (x, y, z, strength). */
+        std::vector<Eigen::Vector4f, Eigen::aligned_allocator<Eigen::Vector4f> > grid_votes_;
+
+        /** \brief The number of threads the scheduler should use. */
+        unsigned int threads_;
     };
 
     /** \brief The assignment of this structure is to store the statistical/learned weights and other information
@@ -413,6 +439,14 @@ namespace pcl
         void
         setSigmaDists (const std::vector<float>& training_sigmas);
 
+        /** \brief Sets the number of threads used for clustering the descriptors during the training
+          * and for matching the descriptors against the codebook in findObjects.
+          * \param[in] nr_threads the number of hardware threads to use (0 takes as many as the budget of
+          * pcl::ExecutionContext allows when training or matching)
+          */
+        void
+        setNumberOfThreads (unsigned int nr_threads = 0);
+
         /** \brief Returns the state of Nvot coeff from [Knopp et al., 2010, (4)],
           * if set to false then coeff is taken as 1.0. It is just a kind of heuristic.
           * The default behavior is as in the article. So you can ignore this if you want.
@@ -569,6 +603,17 @@ namespace pcl
         void
         generateRandomCenter (const std::vector<Eigen::Vector2f, Eigen::aligned_allocator<Eigen::Vector2f> >& boxes, Eigen::VectorXf& center);
 
+        /** \brief Assigns every point to its closest (square distance) center, in parallel.
+          * \param[in] points points to assign, one per row
+          * \param[in] centers centers, one per row
+          * \param[out] labels index of the closest center for every point
+          * \return the sum of the square distances of the points to their centers
+          */
+        double
+        assignToNearestCenters (const Eigen::MatrixXf& points,
+                                const Eigen::MatrixXf& centers,
+                                Eigen::MatrixXi& labels);
+
         /** \brief Computes the square distance between two vectors.
           * \param[in] vec_1 first vector
           * \param[in] vec_2 second vector
@@ -608,6 +653,9 @@ namespace pcl
         /** \brief If set to false then Nvot coeff from [Knopp et al., 2010, (4)] is equal 1.0. */
         bool n_vot_ON_;
 
+        /** \brief The number of threads the scheduler should use. */
+        unsigned int threads_;
+
         /** \brief This const value is used for indicating that for k-means clustering centers must
           * be generated as described in
           * Arthur, David and Sergei Vassilvitski (2007) k-means++: The Advantages of Careful Seeding. */
@@ -414,6 +414,12 @@ namespace pcl
         average_detections_ = average_detections;
       }
 
+      /** \brief Set the number of threads used to evaluate the templates in parallel.
+        * \param[in] nr_threads the number of hardware threads to use (0 takes as many as the budget of pcl::ExecutionContext allows when matching).
+        */
+      void
+      setNumberOfThreads (unsigned int nr_threads = 0);
+
       /** \brief Returns the template with the specified ID.
         * \param[in] template_id the ID of the template to return.
         */
@@ -469,6 +475,8 @@ namespace pcl
       bool use_non_max_suppression_;
       /** states whether to return an averaged detection */
       bool average_detections_;
+      /** number of threads used to evaluate the templates */
+      unsigned int threads_;
       /** template storage */
       std::vector<SparseQuantizedMultiModTemplate> templates_;
   };
@@ -212,6 +212,14 @@ namespace pcl
           do_icp_hypotheses_refinement_ = false;
         }
 
+        /** \brief Set the number of threads used for hypotheses generation and verification and for building the
+          * conflict graph. The oriented point pairs are still sampled sequentially, so the results do not depend on
+          * the number of threads.
+          * \param[in] nr_threads the number of hardware threads to use (0 takes as many as the budget of pcl::ExecutionContext allows when recognizing)
+          */
+        void
+        setNumberOfThreads (unsigned int nr_threads = 0);
+
         /** \brief Add an object model to be recognized.
           *
           * \param[in] points are the object points.
@@ -474,6 +482,9 @@ namespace pcl
         std::list<OrientedPointPair> sampled_oriented_point_pairs_;
         std::vector<Hypothesis> accepted_hypotheses_;
         Recognition_Mode rec_mode_;
+
+        /** \brief The number of threads the scheduler should use. */
+        unsigned int threads_;
     };
   } // namespace recognition
 } // namespace pcl
@@ -284,6 +284,22 @@ namespace pcl
           return (true);
         }
 
+        /** \brief Adds the rotation part of the given 3x4 rigid transform (the first 9 entries are the rotation matrix
+          * and the last 3 the translation) to the rotation space. Different RotationSpace objects do not share any
+          * data, so transforms can be added to different rotation spaces concurrently. */
+        inline bool
+        addRigidTransform (const ModelLibrary::Model* model, const float rigid_transform[12])
+        {
+          float rot_angle, axis_angle[3];
+          // Extract the axis-angle representation from the rotation matrix
+          aux::rotationMatrixToAxisAngle (rigid_transform, axis_angle, rot_angle);
+          // Multiply the axis by the angle to get the final representation
+          aux::mult3 (axis_angle, rot_angle);
+
+          // Now, add the rigid transform to the rotation space
+          return (this->addRigidTransform (model, axis_angle, rigid_transform + 9));
+        }
+
       protected:
         CellOctree octree_;
         RotationSpaceCellCreator cell_creator_;
@@ -378,8 +394,10 @@ namespace pcl
           return (rotation_space_creator_.getNumberOfRotationSpaces ());
         }
 
-        inline bool
-        addRigidTransform (const ModelLibrary::Model* model, const float position[3], const float rigid_transform[12])
+        /** \brief Returns the rotation space 'position' ends up in. The rotation space is created if it does not exist yet,
+          * so this method is not thread-safe. Returns nullptr if 'position' is out of bounds. */
+        inline RotationSpace*
+        getRotationSpace (const float position[3])
         {
           // Get the leaf 'position' ends up in
           RotationSpaceOctree::Node* leaf = pos_octree_.createLeaf (position[0], position[1], position[2]);
@@ -388,17 +406,21 @@ namespace pcl
           {
             printf ("WARNING in 'RigidTransformSpace::%s()': the input position (%f, %f, %f) is out of bounds.\n",
                     __func__, position[0], position[1], position[2]);
-            return (false);
+            return (nullptr);
           }
 
-          float rot_angle, axis_angle[3];
-          // Extract the axis-angle representation from the rotation matrix
-          aux::rotationMatrixToAxisAngle (rigid_transform, axis_angle, rot_angle);
-          // Multiply the axis by the angle to get the final representation
-          aux::mult3 (axis_angle, rot_angle);
+          return (&leaf->getData ());
+        }
 
-          // Now, add the rigid transform to the rotation space
-          leaf->getData ().addRigidTransform (model, axis_angle, rigid_transform + 9);
+        inline bool
+        addRigidTransform (const ModelLibrary::Model* model, const float position[3], const float rigid_transform[12])
+        {
+          RotationSpace* rotation_space = this->getRotationSpace (position);
+
+          if ( !rotation_space )
+            return (false);
+
+          rotation_space->addRigidTransform (model, rigid_transform);
 
           return (true);
         }
@@ -79,33 +79,35 @@ pcl::recognition::HoughSpace3D::reset ()
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 int
-pcl::recognition::HoughSpace3D::vote (const Eigen::Vector3d &single_vote_coord, double weight, int voter_id)
+pcl::recognition::HoughSpace3D::computeVoteBins (const Eigen::Vector3d &single_vote_coord, double weight, bool interpolate,
+                                                 int bins[8], double bin_weights[8], int &n_bins) const
 {
-  int index = 0;
+  n_bins = 0;
 
-  for (int i=0; i<3; ++i)
+  if (!interpolate)
   {
-    int currentBin = static_cast<int> (std::floor ((single_vote_coord[i] - min_coord_[i])/bin_size_[i]));
-    if (currentBin < 0 || currentBin >= bin_count_[i])
+    int index = 0;
+
+    for (int i=0; i<3; ++i)
     {
-      //PCL_ERROR("Current Vote goes out of bounds in the Hough Table!\nDimension: %d, Value inserted: %f, Min value: %f, Max value: %f\n", i, 
-      //  single_vote_coord[i], min_coord_[i], min_coord_[i] + bin_size_[i]*bin_count_[i]);
-      return -1;
-    }
+      int currentBin = static_cast<int> (std::floor ((single_vote_coord[i] - min_coord_[i])/bin_size_[i]));
+      if (currentBin < 0 || currentBin >= bin_count_[i])
+      {
+        //PCL_ERROR("Current Vote goes out of bounds in the Hough Table!\nDimension: %d, Value inserted: %f, Min value: %f, Max value: %f\n", i, 
+        //  single_vote_coord[i], min_coord_[i], min_coord_[i] + bin_size_[i]*bin_count_[i]);
+        return -1;
+      }
 
-    index += partial_bin_products_[i] * currentBin;
-  }
+      index += partial_bin_products_[i] * currentBin;
+    }
 
-  hough_space_[index] += weight;
-  voter_ids_[index].push_back (voter_id);
+    bins[0] = index;
+    bin_weights[0] = weight;
+    n_bins = 1;
 
-  return (index);
-}
+    return (index);
+  }
 
-////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-int
-pcl::recognition::HoughSpace3D::voteInt (const Eigen::Vector3d &single_vote_coord, double weight, int voter_id)
-{
   int central_bin_index = 0;
 
   const int n_neigh = 27; // total number of neighbours = 3^nDim = 27
@@ -114,10 +116,6 @@ pcl::recognition::HoughSpace3D::voteInt (const Eigen::Vector3d &single_vote_coor
   Eigen::Vector3f bin_centroid;
   Eigen::Vector3f central_bin_weight;
   Eigen::Vector3i interp_bin;
-  std::vector<float> interp_weight (n_neigh);
-
-  for (int n = 0; n < n_neigh; ++n)
-    interp_weight[n] = 1.0;
 
   for (int d = 0; d < 3; ++d)
   {
@@ -153,13 +151,14 @@ pcl::recognition::HoughSpace3D::voteInt (const Eigen::Vector3d &single_vote_coor
     }
   }
 
-  // For each neighbor of the central point
-  //int counterRealVotes = 0;
+  // For each neighbor of the central point. Along each dimension only the central and the interpolated bin are valid,
+  // so at most 8 neighbors receive a part of the vote.
   for (int n = 0; n < n_neigh; ++n)
   {
     int final_bin_index = 0;
     int exp = 1;
     bool invalid = false;
+    float interp_weight = 1.0f;
 
     for (int d = 0; d < 3; ++d)
     {
@@ -169,11 +168,11 @@ pcl::recognition::HoughSpace3D::voteInt (const Eigen::Vector3d &single_vote_coor
         // Each coordinate of the neighbor has to be equal either to one of the central bin or to one of the interpolated bins
         if(curr_neigh_index == interp_bin[d])
         {
-          interp_weight[n] *= 1-central_bin_weight[d];
+          interp_weight *= 1-central_bin_weight[d];
         }
         else if(curr_neigh_index == central_bin_coord[d])
         {
-          interp_weight[n] *= central_bin_weight[d];
+          interp_weight *= central_bin_weight[d];
         }
         else
         {
@@ -193,14 +192,112 @@ pcl::recognition::HoughSpace3D::voteInt (const Eigen::Vector3d &single_vote_coor
 
     if (!invalid)
     {
-      hough_space_[final_bin_index] += weight * interp_weight[n];
-      voter_ids_[final_bin_index].push_back (voter_id);
+      bins[n_bins] = final_bin_index;
+      bin_weights[n_bins] = weight * interp_weight;
+      ++n_bins;
     }
   }
 
   return (central_bin_index);
 }
 
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+int
+pcl::recognition::HoughSpace3D::vote (const Eigen::Vector3d &single_vote_coord, double weight, int voter_id)
+{
+  int bins[8];
+  double bin_weights[8];
+  int n_bins;
+
+  int index = computeVoteBins (single_vote_coord, weight, false, bins, bin_weights, n_bins);
+  if (index < 0)
+    return -1;
+
+  hough_space_[index] += weight;
+  voter_ids_[index].push_back (voter_id);
+
+  return (index);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+int
+pcl::recognition::HoughSpace3D::voteInt (const Eigen::Vector3d &single_vote_coord, double weight, int voter_id)
+{
+  int bins[8];
+  double bin_weights[8];
+  int n_bins;
+
+  int central_bin_index = computeVoteBins (single_vote_coord, weight, true, bins, bin_weights, n_bins);
+  if (central_bin_index < 0)
+    return -1;
+
+  for (int b = 0; b < n_bins; ++b)
+  {
+    hough_space_[bins[b]] += bin_weights[b];
+    voter_ids_[bins[b]].push_back (voter_id);
+  }
+
+  return (central_bin_index);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+void
+pcl::recognition::HoughSpace3D::castVotes (const std::vector<Eigen::Vector3d, Eigen::aligned_allocator<Eigen::Vector3d> > &votes_coords,
+                                           const std::vector<double> &weights, bool interpolate, unsigned int nr_threads)
+{
+  const int n_votes = static_cast<int> (votes_coords.size ());
+  std::vector<int> vote_bins (8 * votes_coords.size ());
+  std::vector<double> vote_bin_weights (8 * votes_coords.size ());
+  std::vector<int> vote_n_bins (votes_coords.size ());
+
+  // Compute the bins of each vote
+#pragma omp parallel for \
+  default(none) \
+  shared(votes_coords, weights, interpolate, n_votes, vote_bins, vote_bin_weights, vote_n_bins) \
+  num_threads(nr_threads)
+  for (int i = 0; i < n_votes; ++i)
+    computeVoteBins (votes_coords[i], weights[i], interpolate, &vote_bins[8 * i], &vote_bin_weights[8 * i], vote_n_bins[i]);
+
+  // Accumulate the votes, each thread owns a contiguous range of bins
+  const int n_shards = std::max (1, static_cast<int> (nr_threads));
+  std::vector<std::unordered_map<int, std::vector<int> > > shard_voter_ids (n_shards);
+
+#pragma omp parallel for \
+  default(none) \
+  shared(n_votes, n_shards, vote_bins, vote_bin_weights, vote_n_bins, shard_voter_ids) \
+  schedule(static, 1) \
+  num_threads(nr_threads)
+  for (int shard = 0; shard < n_shards; ++shard)
+  {
+    const int first_bin = static_cast<int> (static_cast<long long> (total_bins_count_) * shard / n_shards);
+    const int last_bin = static_cast<int> (static_cast<long long> (total_bins_count_) * (shard + 1) / n_shards);
+
+    for (int i = 0; i < n_votes; ++i)
+    {
+      for (int b = 8 * i; b < 8 * i + vote_n_bins[i]; ++b)
+      {
+        if (vote_bins[b] < first_bin || vote_bins[b] >= last_bin)
+          continue;
+
+        hough_space_[vote_bins[b]] += vote_bin_weights[b];
+        shard_voter_ids[shard][vote_bins[b]].push_back (i);
+      }
+    }
+  }
+
+  for (auto &shard_ids : shard_voter_ids)
+  {
+    for (auto &bin_ids : shard_ids)
+    {
+      std::vector<int> &ids = voter_ids_[bin_ids.first];
+      if (ids.empty ())
+        ids.swap (bin_ids.second);
+      else
+        ids.insert (ids.end (), bin_ids.second.begin (), bin_ids.second.end ());
+    }
+  }
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 double
 pcl::recognition::HoughSpace3D::findMaxima (double min_threshold, std::vector<double> &maxima_values, std::vector<std::vector<int> > &maxima_voter_ids)
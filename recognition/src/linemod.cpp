@@ -38,6 +38,7 @@
 //#define __SSE2__
 
 #include <pcl/recognition/linemod.h>
+#include <pcl/common/execution_context.h>
 
 #ifdef __SSE2__
 #include <emmintrin.h>
@@ -47,12 +48,101 @@
 
 //#define LINEMOD_USE_SEPARATE_ENERGY_MAPS
 
+#ifdef __SSE2__
+namespace
+{
+  /** \brief Adds the 8 bit partial sums to the 16 bit score sums and resets the partial sums. */
+  void
+  flushScoreSums (unsigned char * tmp_score_sums, unsigned short * score_sums, const std::size_t mem_size)
+  {
+    const __m128i zero = _mm_setzero_si128 ();
+    std::size_t mem_index = 0;
+    for (; mem_index + 16 <= mem_size; mem_index += 16)
+    {
+      const __m128i tmp = _mm_loadu_si128 (reinterpret_cast<const __m128i*> (tmp_score_sums + mem_index));
+      __m128i * sums = reinterpret_cast<__m128i*> (score_sums + mem_index);
+      _mm_storeu_si128 (sums, _mm_add_epi16 (_mm_loadu_si128 (sums), _mm_unpacklo_epi8 (tmp, zero)));
+      _mm_storeu_si128 (sums + 1, _mm_add_epi16 (_mm_loadu_si128 (sums + 1), _mm_unpackhi_epi8 (tmp, zero)));
+    }
+    for (; mem_index < mem_size; ++mem_index)
+      score_sums[mem_index] = static_cast<unsigned short> (score_sums[mem_index] + tmp_score_sums[mem_index]);
+
+    memset (tmp_score_sums, 0, mem_size*sizeof (tmp_score_sums[0]));
+  }
+
+  /** \brief Sums up the linearized responses of all features of a template for every position of the
+    * linearized memory. The responses are accumulated with 8 bit saturating additions, 16 positions at a
+    * time, and flushed into the 16 bit sums before they can overflow.
+    * \param[in] linemod_template the template to evaluate.
+    * \param[in] modality_linearized_maps the linearized response maps per modality and bin.
+    * \param[in] scale the scale applied to the feature positions.
+    * \param[in] mem_size the number of positions of a linearized map.
+    * \param[out] tmp_score_sums buffer for the 8 bit partial sums (mem_size elements).
+    * \param[out] score_sums the resulting scores (mem_size elements).
+    * \return the maximum score the template can reach.
+    */
+  int
+  accumulateScores (const pcl::SparseQuantizedMultiModTemplate & linemod_template,
+                    std::vector<std::vector<pcl::LinearizedMaps> > & modality_linearized_maps,
+                    const float scale,
+                    const std::size_t mem_size,
+                    unsigned char * tmp_score_sums,
+                    unsigned short * score_sums)
+  {
+    memset (score_sums, 0, mem_size*sizeof (score_sums[0]));
+    memset (tmp_score_sums, 0, mem_size*sizeof (tmp_score_sums[0]));
+
+    const std::size_t mem_size_16 = mem_size / 16;
+    const std::size_t mem_size_mod_16_base = mem_size_16 * 16;
+
+    // every bin adds at most 4 to a position
+    const int max_response = 4;
+    int max_score = 0;
+    int max_tmp_score = 0;
+    for (const auto &feature : linemod_template.features)
+    {
+      for (std::size_t bin_index = 0; bin_index < 8; ++bin_index)
+      {
+        if ((feature.quantized_value & (0x1<<bin_index)) == 0)
+          continue;
+
+        if (max_tmp_score + max_response > 255)
+        {
+          flushScoreSums (tmp_score_sums, score_sums, mem_size);
+          max_tmp_score = 0;
+        }
+        max_score += max_response;
+        max_tmp_score += max_response;
+
+        const unsigned char * data = modality_linearized_maps[feature.modality_index][bin_index].getOffsetMap (
+            static_cast<std::size_t> (float (feature.x) * scale), static_cast<std::size_t> (float (feature.y) * scale));
+
+        for (std::size_t mem_index = 0; mem_index < mem_size_mod_16_base; mem_index += 16)
+        {
+          __m128i * tmp = reinterpret_cast<__m128i*> (tmp_score_sums + mem_index);
+          const __m128i values = _mm_loadu_si128 (reinterpret_cast<const __m128i*> (data + mem_index));
+          _mm_storeu_si128 (tmp, _mm_adds_epu8 (_mm_loadu_si128 (tmp), values));
+        }
+        for (std::size_t mem_index = mem_size_mod_16_base; mem_index < mem_size; ++mem_index)
+        {
+          tmp_score_sums[mem_index] = static_cast<unsigned char> (tmp_score_sums[mem_index] + data[mem_index]);
+        }
+      }
+    }
+    flushScoreSums (tmp_score_sums, score_sums, mem_size);
+
+    return (max_score);
+  }
+}
+#endif
+
 //////////////////////////////////////////////////////////////////////////////////////////////
 pcl::LINEMOD::LINEMOD () 
   : template_threshold_ (0.75f)
   , use_non_max_suppression_ (false)
   , average_detections_ (false)
 {
+  setNumberOfThreads ();
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////
@@ -60,6 +150,14 @@ pcl::LINEMOD::~LINEMOD()
 {
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////
+void
+pcl::LINEMOD::setNumberOfThreads (unsigned int nr_threads)
+{
+  // 0 is resolved against the budget of pcl::ExecutionContext at compute time
+  threads_ = nr_threads;
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////
 int 
 pcl::LINEMOD::createAndAddTemplate (const std::vector<pcl::QuantizableModality*> & modalities,
@@ -123,6 +221,8 @@ pcl::LINEMOD::addTemplate (const SparseQuantizedMultiModTemplate & linemod_templ
 void
 pcl::LINEMOD::matchTemplates (const std::vector<QuantizableModality*> & modalities, std::vector<LINEMODDetection> & detections) const
 {
+  const pcl::ThreadReservation reservation (threads_);
+  const unsigned int threads = reservation.getNumberOfThreads ();
   // create energy maps
   std::vector<EnergyMaps> modality_energy_maps;
   const std::size_t nr_modalities = modalities.size();
@@ -212,7 +312,13 @@ pcl::LINEMOD::matchTemplates (const std::vector<QuantizableModality*> & modaliti
   // compute scores for templates
   const std::size_t width = modality_energy_maps[0].getWidth ();
   const std::size_t height = modality_energy_maps[0].getHeight ();
-  for (std::size_t template_index = 0; template_index < templates_.size (); ++template_index)
+  const int nr_templates = static_cast<int> (templates_.size ());
+  std::vector<LINEMODDetection> template_matches (nr_templates);
+#pragma omp parallel for \
+  shared(height, modality_linearized_maps, nr_templates, step_size, template_matches, width) \
+  schedule(dynamic) \
+  num_threads(threads)
+  for (int template_index = 0; template_index < nr_templates; ++template_index)
   {
     const std::size_t mem_width = width / step_size;
     const std::size_t mem_height = height / step_size;
@@ -221,85 +327,9 @@ pcl::LINEMOD::matchTemplates (const std::vector<QuantizableModality*> & modaliti
 #ifdef __SSE2__
     unsigned short * score_sums = reinterpret_cast<unsigned short*> (aligned_malloc (mem_size*sizeof(unsigned short)));
     unsigned char * tmp_score_sums = reinterpret_cast<unsigned char*> (aligned_malloc (mem_size*sizeof(unsigned char)));
-    memset (score_sums, 0, mem_size*sizeof (score_sums[0]));
-    memset (tmp_score_sums, 0, mem_size*sizeof (tmp_score_sums[0]));
-
-    //__m128i * score_sums_m128i = reinterpret_cast<__m128i*> (score_sums);
-    __m128i * tmp_score_sums_m128i = reinterpret_cast<__m128i*> (tmp_score_sums);
 
-    const std::size_t mem_size_16 = mem_size / 16;
-    //const std::size_t mem_size_mod_16 = mem_size & 15;
-    const std::size_t mem_size_mod_16_base = mem_size_16 * 16;
-
-    std::size_t max_score = 0;
-    std::size_t copy_back_counter = 0;
-    for (const auto &feature : templates_[template_index].features)
-    {
-      for (std::size_t bin_index = 0; bin_index < 8; ++bin_index)
-      {
-        if ((feature.quantized_value & (0x1<<bin_index)) != 0)
-        {
-          max_score += 4;
-
-          unsigned char * data = modality_linearized_maps[feature.modality_index][bin_index].getOffsetMap (feature.x, feature.y);
-          __m128i * data_m128i = reinterpret_cast<__m128i*> (data);
-
-          for (std::size_t mem_index = 0; mem_index < mem_size_16; ++mem_index)
-          {
-            __m128i aligned_data_m128i = _mm_loadu_si128 (reinterpret_cast<const __m128i*> (data_m128i + mem_index)); // SSE2
-            //__m128i aligned_data_m128i = _mm_lddqu_si128 (reinterpret_cast<const __m128i*> (data_m128i + mem_index)); // SSE3
-            tmp_score_sums_m128i[mem_index] = _mm_add_epi8 (tmp_score_sums_m128i[mem_index], aligned_data_m128i);
-          }
-          for (std::size_t mem_index = mem_size_mod_16_base; mem_index < mem_size; ++mem_index)
-          {
-            tmp_score_sums[mem_index] = static_cast<unsigned char> (tmp_score_sums[mem_index] + data[mem_index]);
-          }
-        }
-      }
-
-      ++copy_back_counter;
-
-      //if ((feature_index & 7) == 7)
-      //if ((feature_index & 63) == 63)
-      if (copy_back_counter > 63) // only valid if each feature has only one bit set..
-      {
-        copy_back_counter = 0;
-
-        for (std::size_t mem_index = 0; mem_index < mem_size_mod_16_base; mem_index += 16)
-        {
-          score_sums[mem_index+0]  = static_cast<unsigned short> (score_sums[mem_index+0]  + tmp_score_sums[mem_index+0]);
-          score_sums[mem_index+1]  = static_cast<unsigned short> (score_sums[mem_index+1]  + tmp_score_sums[mem_index+1]);
-          score_sums[mem_index+2]  = static_cast<unsigned short> (score_sums[mem_index+2]  + tmp_score_sums[mem_index+2]);
-          score_sums[mem_index+3]  = static_cast<unsigned short> (score_sums[mem_index+3]  + tmp_score_sums[mem_index+3]);
-          score_sums[mem_index+4]  = static_cast<unsigned short> (score_sums[mem_index+4]  + tmp_score_sums[mem_index+4]);
-          score_sums[mem_index+5]  = static_cast<unsigned short> (score_sums[mem_index+5]  + tmp_score_sums[mem_index+5]);
-          score_sums[mem_index+6]  = static_cast<unsigned short> (score_sums[mem_index+6]  + tmp_score_sums[mem_index+6]);
-          score_sums[mem_index+7]  = static_cast<unsigned short> (score_sums[mem_index+7]  + tmp_score_sums[mem_index+7]);
-          score_sums[mem_index+8]  = static_cast<unsigned short> (score_sums[mem_index+8]  + tmp_score_sums[mem_index+8]);
-          score_sums[mem_index+9]  = static_cast<unsigned short> (score_sums[mem_index+9]  + tmp_score_sums[mem_index+9]);
-          score_sums[mem_index+10] = static_cast<unsigned short> (score_sums[mem_index+10] + tmp_score_sums[mem_index+10]);
-          score_sums[mem_index+11] = static_cast<unsigned short> (score_sums[mem_index+11] + tmp_score_sums[mem_index+11]);
-          score_sums[mem_index+12] = static_cast<unsigned short> (score_sums[mem_index+12] + tmp_score_sums[mem_index+12]);
-          score_sums[mem_index+13] = static_cast<unsigned short> (score_sums[mem_index+13] + tmp_score_sums[mem_index+13]);
-          score_sums[mem_index+14] = static_cast<unsigned short> (score_sums[mem_index+14] + tmp_score_sums[mem_index+14]);
-          score_sums[mem_index+15] = static_cast<unsigned short> (score_sums[mem_index+15] + tmp_score_sums[mem_index+15]);
-        }
-        for (std::size_t mem_index = mem_size_mod_16_base; mem_index < mem_size; ++mem_index)
-        {
-          score_sums[mem_index] = static_cast<unsigned short> (score_sums[mem_index] + tmp_score_sums[mem_index]);
-        }
-
-        memset (tmp_score_sums, 0, mem_size*sizeof (tmp_score_sums[0]));
-      }
-    }
-    {
-      for (std::size_t mem_index = 0; mem_index < mem_size; ++mem_index)
-      {
-        score_sums[mem_index] = static_cast<unsigned short> (score_sums[mem_index] + tmp_score_sums[mem_index]);
-      }
-        
-      memset (tmp_score_sums, 0, mem_size*sizeof (tmp_score_sums[0]));
-    }
+    const std::size_t max_score = accumulateScores (templates_[template_index], modality_linearized_maps, 1.0f,
+                                                    mem_size, tmp_score_sums, score_sums);
 #else
     unsigned short * score_sums = new unsigned short[mem_size];
     //unsigned char * score_sums = new unsigned char[mem_size];
@@ -349,7 +379,7 @@ pcl::LINEMOD::matchTemplates (const std::vector<QuantizableModality*> & modaliti
     detection.template_id = static_cast<int> (template_index);
     detection.score = static_cast<float> (max_value) * inv_max_score;
 
-    detections.push_back (detection);
+    template_matches[template_index] = detection;
 
 #ifdef __SSE2__
     aligned_free (score_sums);
@@ -359,6 +389,8 @@ pcl::LINEMOD::matchTemplates (const std::vector<QuantizableModality*> & modaliti
 #endif
   }
 
+  detections.insert (detections.end (), template_matches.begin (), template_matches.end ());
+
   // release data
   for (std::size_t modality_index = 0; modality_index < modality_linearized_maps.size (); ++modality_index)
   {
@@ -372,6 +404,8 @@ pcl::LINEMOD::matchTemplates (const std::vector<QuantizableModality*> & modaliti
 void
 pcl::LINEMOD::detectTemplates (const std::vector<QuantizableModality*> & modalities, std::vector<LINEMODDetection> & detections) const
 {
+  const pcl::ThreadReservation reservation (threads_);
+  const unsigned int threads = reservation.getNumberOfThreads ();
   // create energy maps
   std::vector<EnergyMaps> modality_energy_maps;
 #ifdef LINEMOD_USE_SEPARATE_ENERGY_MAPS
@@ -531,7 +565,13 @@ pcl::LINEMOD::detectTemplates (const std::vector<QuantizableModality*> & modalit
   // compute scores for templates
   const std::size_t width = modality_energy_maps[0].getWidth ();
   const std::size_t height = modality_energy_maps[0].getHeight ();
-  for (std::size_t template_index = 0; template_index < templates_.size (); ++template_index)
+  const int nr_templates = static_cast<int> (templates_.size ());
+  std::vector<std::vector<LINEMODDetection> > template_detections (nr_templates);
+#pragma omp parallel for \
+  shared(height, modality_linearized_maps, nr_templates, step_size, template_detections, width) \
+  schedule(dynamic) \
+  num_threads(threads)
+  for (int template_index = 0; template_index < nr_templates; ++template_index)
   {
     const std::size_t mem_width = width / step_size;
     const std::size_t mem_height = height / step_size;
@@ -540,85 +580,9 @@ pcl::LINEMOD::detectTemplates (const std::vector<QuantizableModality*> & modalit
 #ifdef __SSE2__
     unsigned short * score_sums = reinterpret_cast<unsigned short*> (aligned_malloc (mem_size*sizeof(unsigned short)));
     unsigned char * tmp_score_sums = reinterpret_cast<unsigned char*> (aligned_malloc (mem_size*sizeof(unsigned char)));
-    memset (score_sums, 0, mem_size*sizeof (score_sums[0]));
-    memset (tmp_score_sums, 0, mem_size*sizeof (tmp_score_sums[0]));
-
-    //__m128i * score_sums_m128i = reinterpret_cast<__m128i*> (score_sums);
-    __m128i * tmp_score_sums_m128i = reinterpret_cast<__m128i*> (tmp_score_sums);
-
-    const std::size_t mem_size_16 = mem_size / 16;
-    //const std::size_t mem_size_mod_16 = mem_size & 15;
-    const std::size_t mem_size_mod_16_base = mem_size_16 * 16;
-
-    int max_score = 0;
-    std::size_t copy_back_counter = 0;
-    for (const auto &feature : templates_[template_index].features)
-    {
-      for (std::size_t bin_index = 0; bin_index < 8; ++bin_index)
-      {
-        if ((feature.quantized_value & (0x1<<bin_index)) != 0)
-        {
-          max_score += 4;
-
-          unsigned char * data = modality_linearized_maps[feature.modality_index][bin_index].getOffsetMap (feature.x, feature.y);
-          __m128i * data_m128i = reinterpret_cast<__m128i*> (data);
 
-          for (std::size_t mem_index = 0; mem_index < mem_size_16; ++mem_index)
-          {
-            __m128i aligned_data_m128i = _mm_loadu_si128 (reinterpret_cast<const __m128i*> (data_m128i + mem_index)); // SSE2
-            //__m128i aligned_data_m128i = _mm_lddqu_si128 (reinterpret_cast<const __m128i*> (data_m128i + mem_index)); // SSE3
-            tmp_score_sums_m128i[mem_index] = _mm_add_epi8 (tmp_score_sums_m128i[mem_index], aligned_data_m128i);
-          }
-          for (std::size_t mem_index = mem_size_mod_16_base; mem_index < mem_size; ++mem_index)
-          {
-            tmp_score_sums[mem_index] = static_cast<unsigned char> (tmp_score_sums[mem_index] + data[mem_index]);
-          }
-        }
-      }
-
-      ++copy_back_counter;
-
-      //if ((feature_index & 7) == 7)
-      //if ((feature_index & 63) == 63)
-      if (copy_back_counter > 63) // only valid if each feature has only one bit set..
-      {
-        copy_back_counter = 0;
-
-        for (std::size_t mem_index = 0; mem_index < mem_size_mod_16_base; mem_index += 16)
-        {
-          score_sums[mem_index+0]  = static_cast<unsigned short> (score_sums[mem_index+0]  + tmp_score_sums[mem_index+0]);
-          score_sums[mem_index+1]  = static_cast<unsigned short> (score_sums[mem_index+1]  + tmp_score_sums[mem_index+1]);
-          score_sums[mem_index+2]  = static_cast<unsigned short> (score_sums[mem_index+2]  + tmp_score_sums[mem_index+2]);
-          score_sums[mem_index+3]  = static_cast<unsigned short> (score_sums[mem_index+3]  + tmp_score_sums[mem_index+3]);
-          score_sums[mem_index+4]  = static_cast<unsigned short> (score_sums[mem_index+4]  + tmp_score_sums[mem_index+4]);
-          score_sums[mem_index+5]  = static_cast<unsigned short> (score_sums[mem_index+5]  + tmp_score_sums[mem_index+5]);
-          score_sums[mem_index+6]  = static_cast<unsigned short> (score_sums[mem_index+6]  + tmp_score_sums[mem_index+6]);
-          score_sums[mem_index+7]  = static_cast<unsigned short> (score_sums[mem_index+7]  + tmp_score_sums[mem_index+7]);
-          score_sums[mem_index+8]  = static_cast<unsigned short> (score_sums[mem_index+8]  + tmp_score_sums[mem_index+8]);
-          score_sums[mem_index+9]  = static_cast<unsigned short> (score_sums[mem_index+9]  + tmp_score_sums[mem_index+9]);
-          score_sums[mem_index+10] = static_cast<unsigned short> (score_sums[mem_index+10] + tmp_score_sums[mem_index+10]);
-          score_sums[mem_index+11] = static_cast<unsigned short> (score_sums[mem_index+11] + tmp_score_sums[mem_index+11]);
-          score_sums[mem_index+12] = static_cast<unsigned short> (score_sums[mem_index+12] + tmp_score_sums[mem_index+12]);
-          score_sums[mem_index+13] = static_cast<unsigned short> (score_sums[mem_index+13] + tmp_score_sums[mem_index+13]);
-          score_sums[mem_index+14] = static_cast<unsigned short> (score_sums[mem_index+14] + tmp_score_sums[mem_index+14]);
-          score_sums[mem_index+15] = static_cast<unsigned short> (score_sums[mem_index+15] + tmp_score_sums[mem_index+15]);
-        }
-        for (std::size_t mem_index = mem_size_mod_16_base; mem_index < mem_size; ++mem_index)
-        {
-          score_sums[mem_index] = static_cast<unsigned short> (score_sums[mem_index] + tmp_score_sums[mem_index]);
-        }
-
-        memset (tmp_score_sums, 0, mem_size*sizeof (tmp_score_sums[0]));
-      }
-    }
-    {
-      for (std::size_t mem_index = 0; mem_index < mem_size; ++mem_index)
-      {
-        score_sums[mem_index] = static_cast<unsigned short> (score_sums[mem_index] + tmp_score_sums[mem_index]);
-      }
-        
-      memset (tmp_score_sums, 0, mem_size*sizeof (tmp_score_sums[0]));
-    }
+    const int max_score = accumulateScores (templates_[template_index], modality_linearized_maps, 1.0f,
+                                            mem_size, tmp_score_sums, score_sums);
 #else
     unsigned short * score_sums = new unsigned short[mem_size];
     //unsigned char * score_sums = new unsigned char[mem_size];
@@ -793,7 +757,7 @@ pcl::LINEMOD::detectTemplates (const std::vector<QuantizableModality*> & modalit
 #endif
 
 
-        detections.push_back (detection);
+        template_detections[template_index].push_back (detection);
       }
     }
 
@@ -811,6 +775,9 @@ pcl::LINEMOD::detectTemplates (const std::vector<QuantizableModality*> & modalit
 #endif
   }
 
+  for (const auto &detections_of_template : template_detections)
+    detections.insert (detections.end (), detections_of_template.begin (), detections_of_template.end ());
+
   // release data
   for (std::size_t modality_index = 0; modality_index < modality_linearized_maps.size (); ++modality_index)
   {
@@ -841,6 +808,8 @@ pcl::LINEMOD::detectTemplatesSemiScaleInvariant (
     const float max_scale,
     const float scale_multiplier) const
 {
+  const pcl::ThreadReservation reservation (threads_);
+  const unsigned int threads = reservation.getNumberOfThreads ();
   // create energy maps
   std::vector<EnergyMaps> modality_energy_maps;
 #ifdef LINEMOD_USE_SEPARATE_ENERGY_MAPS
@@ -1000,7 +969,13 @@ pcl::LINEMOD::detectTemplatesSemiScaleInvariant (
   // compute scores for templates
   const std::size_t width = modality_energy_maps[0].getWidth ();
   const std::size_t height = modality_energy_maps[0].getHeight ();
-  for (std::size_t template_index = 0; template_index < templates_.size (); ++template_index)
+  const int nr_templates = static_cast<int> (templates_.size ());
+  std::vector<std::vector<LINEMODDetection> > template_detections (nr_templates);
+#pragma omp parallel for \
+  shared(height, modality_linearized_maps, nr_templates, step_size, template_detections, width) \
+  schedule(dynamic) \
+  num_threads(threads)
+  for (int template_index = 0; template_index < nr_templates; ++template_index)
   {
     const std::size_t mem_width = width / step_size;
     const std::size_t mem_height = height / step_size;
@@ -1011,86 +986,9 @@ pcl::LINEMOD::detectTemplatesSemiScaleInvariant (
 #ifdef __SSE2__
       unsigned short * score_sums = reinterpret_cast<unsigned short*> (aligned_malloc (mem_size*sizeof(unsigned short)));
       unsigned char * tmp_score_sums = reinterpret_cast<unsigned char*> (aligned_malloc (mem_size*sizeof(unsigned char)));
-      memset (score_sums, 0, mem_size*sizeof (score_sums[0]));
-      memset (tmp_score_sums, 0, mem_size*sizeof (tmp_score_sums[0]));
-
-      //__m128i * score_sums_m128i = reinterpret_cast<__m128i*> (score_sums);
-      __m128i * tmp_score_sums_m128i = reinterpret_cast<__m128i*> (tmp_score_sums);
 
-      const std::size_t mem_size_16 = mem_size / 16;
-      //const std::size_t mem_size_mod_16 = mem_size & 15;
-      const std::size_t mem_size_mod_16_base = mem_size_16 * 16;
-
-      int max_score = 0;
-      std::size_t copy_back_counter = 0;
-      for (const auto &feature : templates_[template_index].features)
-      {
-        for (std::size_t bin_index = 0; bin_index < 8; ++bin_index)
-        {
-          if ((feature.quantized_value & (0x1<<bin_index)) != 0)
-          {
-            max_score += 4;
-
-            unsigned char *data = modality_linearized_maps[feature.modality_index][bin_index].getOffsetMap (
-                std::size_t (float (feature.x) * scale), std::size_t (float (feature.y) * scale));
-            __m128i * data_m128i = reinterpret_cast<__m128i*> (data);
-
-            for (std::size_t mem_index = 0; mem_index < mem_size_16; ++mem_index)
-            {
-              __m128i aligned_data_m128i = _mm_loadu_si128 (reinterpret_cast<const __m128i*> (data_m128i + mem_index)); // SSE2
-              //__m128i aligned_data_m128i = _mm_lddqu_si128 (reinterpret_cast<const __m128i*> (data_m128i + mem_index)); // SSE3
-              tmp_score_sums_m128i[mem_index] = _mm_add_epi8 (tmp_score_sums_m128i[mem_index], aligned_data_m128i);
-            }
-            for (std::size_t mem_index = mem_size_mod_16_base; mem_index < mem_size; ++mem_index)
-            {
-              tmp_score_sums[mem_index] = static_cast<unsigned char> (tmp_score_sums[mem_index] + data[mem_index]);
-            }
-          }
-        }
-
-        ++copy_back_counter;
-
-        //if ((feature_index & 7) == 7)
-        //if ((feature_index & 63) == 63)
-        if (copy_back_counter > 63) // only valid if each feature has only one bit set..
-        {
-          copy_back_counter = 0;
-
-          for (std::size_t mem_index = 0; mem_index < mem_size_mod_16_base; mem_index += 16)
-          {
-            score_sums[mem_index+0]  = static_cast<unsigned short> (score_sums[mem_index+0]  + tmp_score_sums[mem_index+0]);
-            score_sums[mem_index+1]  = static_cast<unsigned short> (score_sums[mem_index+1]  + tmp_score_sums[mem_index+1]);
-            score_sums[mem_index+2]  = static_cast<unsigned short> (score_sums[mem_index+2]  + tmp_score_sums[mem_index+2]);
-            score_sums[mem_index+3]  = static_cast<unsigned short> (score_sums[mem_index+3]  + tmp_score_sums[mem_index+3]);
-            score_sums[mem_index+4]  = static_cast<unsigned short> (score_sums[mem_index+4]  + tmp_score_sums[mem_index+4]);
-            score_sums[mem_index+5]  = static_cast<unsigned short> (score_sums[mem_index+5]  + tmp_score_sums[mem_index+5]);
-            score_sums[mem_index+6]  = static_cast<unsigned short> (score_sums[mem_index+6]  + tmp_score_sums[mem_index+6]);
-            score_sums[mem_index+7]  = static_cast<unsigned short> (score_sums[mem_index+7]  + tmp_score_sums[mem_index+7]);
-            score_sums[mem_index+8]  = static_cast<unsigned short> (score_sums[mem_index+8]  + tmp_score_sums[mem_index+8]);
-            score_sums[mem_index+9]  = static_cast<unsigned short> (score_sums[mem_index+9]  + tmp_score_sums[mem_index+9]);
-            score_sums[mem_index+10] = static_cast<unsigned short> (score_sums[mem_index+10] + tmp_score_sums[mem_index+10]);
-            score_sums[mem_index+11] = static_cast<unsigned short> (score_sums[mem_index+11] + tmp_score_sums[mem_index+11]);
-            score_sums[mem_index+12] = static_cast<unsigned short> (score_sums[mem_index+12] + tmp_score_sums[mem_index+12]);
-            score_sums[mem_index+13] = static_cast<unsigned short> (score_sums[mem_index+13] + tmp_score_sums[mem_index+13]);
-            score_sums[mem_index+14] = static_cast<unsigned short> (score_sums[mem_index+14] + tmp_score_sums[mem_index+14]);
-            score_sums[mem_index+15] = static_cast<unsigned short> (score_sums[mem_index+15] + tmp_score_sums[mem_index+15]);
-          }
-          for (std::size_t mem_index = mem_size_mod_16_base; mem_index < mem_size; ++mem_index)
-          {
-            score_sums[mem_index] = static_cast<unsigned short> (score_sums[mem_index] + tmp_score_sums[mem_index]);
-          }
-
-          memset (tmp_score_sums, 0, mem_size*sizeof (tmp_score_sums[0]));
-        }
-      }
-      {
-        for (std::size_t mem_index = 0; mem_index < mem_size; ++mem_index)
-        {
-          score_sums[mem_index] = static_cast<unsigned short> (score_sums[mem_index] + tmp_score_sums[mem_index]);
-        }
-        
-        memset (tmp_score_sums, 0, mem_size*sizeof (tmp_score_sums[0]));
-      }
+      const int max_score = accumulateScores (templates_[template_index], modality_linearized_maps, scale,
+                                              mem_size, tmp_score_sums, score_sums);
 #else
       unsigned short * score_sums = new unsigned short[mem_size];
       //unsigned char * score_sums = new unsigned char[mem_size];
@@ -1266,7 +1164,7 @@ pcl::LINEMOD::detectTemplatesSemiScaleInvariant (
 #endif
 
 
-          detections.push_back (detection);
+          template_detections[template_index].push_back (detection);
         }
       }
 
@@ -1285,6 +1183,9 @@ pcl::LINEMOD::detectTemplatesSemiScaleInvariant (
     }
   }
 
+  for (const auto &detections_of_template : template_detections)
+    detections.insert (detections.end (), detections_of_template.begin (), detections_of_template.end ());
+
   // release data
   for (std::size_t modality_index = 0; modality_index < modality_linearized_maps.size (); ++modality_index)
   {
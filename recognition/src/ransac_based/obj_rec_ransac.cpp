@@ -37,6 +37,7 @@
  *
  */
 
+#include <pcl/common/execution_context.h>
 #include <pcl/common/random.h>
 #include <pcl/recognition/ransac_based/obj_rec_ransac.h>
 
@@ -60,6 +61,16 @@ pcl::recognition::ObjRecRANSAC::ObjRecRANSAC (float pair_width, float voxel_size
   model_library_ (pair_width, voxel_size, max_coplanarity_angle_),
   rec_mode_ (ObjRecRANSAC::FULL_RECOGNITION)
 {
+  setNumberOfThreads ();
+}
+
+//===============================================================================================================================================
+
+void
+pcl::recognition::ObjRecRANSAC::setNumberOfThreads (unsigned int nr_threads)
+{
+  // 0 is resolved against the budget of pcl::ExecutionContext at compute time
+  threads_ = nr_threads;
 }
 
 //===============================================================================================================================================
@@ -237,18 +248,38 @@ pcl::recognition::ObjRecRANSAC::sampleOrientedPointPairs (int num_iterations, co
 int
 pcl::recognition::ObjRecRANSAC::generateHypotheses (const std::list<OrientedPointPair>& pairs, std::list<HypothesisBase>& out) const
 {
+  const pcl::ThreadReservation reservation (threads_);
+  const unsigned int threads = reservation.getNumberOfThreads ();
 #ifdef OBJ_REC_RANSAC_VERBOSE
   printf("ObjRecRANSAC::%s(): generating hypotheses ... ", __func__); fflush (stdout);
 #endif
 
-  // Only for 3D hash tables: this is the max number of neighbors a 3D hash table cell can have!
-  ModelLibrary::HashTableCell *neigh_cells[27];
-  float hash_table_key[3];
-  int num_hypotheses = 0;
-
-  for (const auto &pair : pairs)
+  // The pairs are processed in parallel, each one into its own hypotheses list. The lists are concatenated in the
+  // order of the pairs afterwards, such that the output does not depend on the number of threads.
+  const std::vector<const OrientedPointPair*> pairs_vec = [&pairs]
+  {
+    std::vector<const OrientedPointPair*> vec;
+    vec.reserve (pairs.size ());
+    for (const auto &pair : pairs)
+      vec.push_back (&pair);
+    return (vec);
+  } ();
+  const int num_pairs = static_cast<int> (pairs_vec.size ());
+  std::vector<std::vector<HypothesisBase> > pair_hypotheses (num_pairs);
+
+#pragma omp parallel for \
+  default(none) \
+  shared(num_pairs, pair_hypotheses, pairs_vec) \
+  schedule(dynamic, 64) \
+  num_threads(threads)
+  for (int pair_id = 0 ; pair_id < num_pairs ; ++pair_id)
   {
+    // Only for 3D hash tables: this is the max number of neighbors a 3D hash table cell can have!
+    ModelLibrary::HashTableCell *neigh_cells[27];
+    float hash_table_key[3];
+
     // Just to make the code more readable
+    const OrientedPointPair& pair = *pairs_vec[pair_id];
     const float *scene_p1 = pair.p1_;
     const float *scene_n1 = pair.n1_;
     const float *scene_p2 = pair.p2_;
@@ -281,12 +312,19 @@ pcl::recognition::ObjRecRANSAC::generateHypotheses (const std::list<OrientedPoin
           // Get the rigid transform from model to scene
           this->computeRigidTransform(model_p1, model_n1, model_p2, model_n2, scene_p1, scene_n1, scene_p2, scene_n2, hypothesis.rigid_transform_);
           // Save the current object hypothesis
-          out.push_back(hypothesis);
-          ++num_hypotheses;
+          pair_hypotheses[pair_id].push_back(hypothesis);
         }
       }
     }
   }
+
+  int num_hypotheses = 0;
+  for (const auto &hypotheses : pair_hypotheses)
+  {
+    out.insert (out.end (), hypotheses.begin (), hypotheses.end ());
+    num_hypotheses += static_cast<int> (hypotheses.size ());
+  }
+
 #ifdef OBJ_REC_RANSAC_VERBOSE
   printf("%i hypotheses\n", num_hypotheses);
 #endif
@@ -300,6 +338,8 @@ int
 pcl::recognition::ObjRecRANSAC::groupHypotheses(std::list<HypothesisBase>& hypotheses, int num_hypotheses,
     RigidTransformSpace& transform_space, HypothesisOctree& grouped_hypotheses) const
 {
+  const pcl::ThreadReservation reservation (threads_);
+  const unsigned int threads = reservation.getNumberOfThreads ();
 #ifdef OBJ_REC_RANSAC_VERBOSE
   printf("ObjRecRANSAC::%s():\n  grouping %i hypotheses ... ", __func__, num_hypotheses); fflush (stdout);
 #endif
@@ -317,19 +357,63 @@ pcl::recognition::ObjRecRANSAC::groupHypotheses(std::list<HypothesisBase>& hypot
 
   // Build the rigid transform space
   transform_space.build (b, position_discretization_, rotation_discretization_);
-  float transformed_point[3];
 
-  // Add all rigid transforms to the discrete rigid transform space
-  for (const auto &hypothesis : hypotheses)
+  const std::vector<const HypothesisBase*> hypotheses_vec = [&hypotheses]
   {
-    // Transform the center of mass of the model
-    aux::transform (hypothesis.rigid_transform_, hypothesis.obj_model_->getOctreeCenterOfMass (), transformed_point);
+    std::vector<const HypothesisBase*> vec;
+    vec.reserve (hypotheses.size ());
+    for (const auto &hypothesis : hypotheses)
+      vec.push_back (&hypothesis);
+    return (vec);
+  } ();
+  const int num_hypos = static_cast<int> (hypotheses_vec.size ());
+  std::vector<float> transformed_points (3*hypotheses_vec.size ());
+
+  // Transform the center of mass of the model of each hypothesis
+#pragma omp parallel for \
+  default(none) \
+  shared(num_hypos, hypotheses_vec, transformed_points) \
+  num_threads(threads)
+  for (int i = 0 ; i < num_hypos ; ++i)
+    aux::transform (hypotheses_vec[i]->rigid_transform_, hypotheses_vec[i]->obj_model_->getOctreeCenterOfMass (), &transformed_points[3*i]);
+
+  // Sort the hypotheses into the rotation spaces they belong to. This creates the rotation spaces and is done sequentially.
+  std::vector<RotationSpace*> occupied_spaces;
+  std::vector<std::vector<const HypothesisBase*> > space_hypotheses;
+  std::map<RotationSpace*, std::size_t> space_ids;
+
+  for (int i = 0 ; i < num_hypos ; ++i)
+  {
+    RotationSpace* rotation_space = transform_space.getRotationSpace (&transformed_points[3*i]);
+    if ( !rotation_space )
+      continue;
 
-    // Now add the rigid transform at the right place
-    transform_space.addRigidTransform (hypothesis.obj_model_, transformed_point, hypothesis.rigid_transform_);
+    auto res = space_ids.insert (std::make_pair (rotation_space, occupied_spaces.size ()));
+    if ( res.second )
+    {
+      occupied_spaces.push_back (rotation_space);
+      space_hypotheses.emplace_back ();
+    }
+    space_hypotheses[res.first->second].push_back (hypotheses_vec[i]);
   }
 
+  // Add all rigid transforms to the discrete rigid transform space. The rotation spaces do not share any data, so they
+  // are filled in parallel; within a rotation space the transforms are added in the original order.
+  const int num_occupied_spaces = static_cast<int> (occupied_spaces.size ());
+
+#pragma omp parallel for \
+  default(none) \
+  shared(num_occupied_spaces, occupied_spaces, space_hypotheses) \
+  schedule(dynamic) \
+  num_threads(threads)
+  for (int i = 0 ; i < num_occupied_spaces ; ++i)
+    for (const auto &hypothesis : space_hypotheses[i])
+      occupied_spaces[i]->addRigidTransform (hypothesis->obj_model_, hypothesis->rigid_transform_);
+
   std::list<RotationSpace*>& rotation_spaces = transform_space.getRotationSpaces ();
+  const std::vector<RotationSpace*> rotation_spaces_vec (rotation_spaces.begin (), rotation_spaces.end ());
+  const int num_rotation_spaces = static_cast<int> (rotation_spaces_vec.size ());
+  std::vector<Hypothesis> best_hypotheses (num_rotation_spaces);
   int num_accepted = 0;
 
 #ifdef OBJ_REC_RANSAC_VERBOSE
@@ -339,11 +423,16 @@ pcl::recognition::ObjRecRANSAC::groupHypotheses(std::list<HypothesisBase>& hypot
   int num_done = 0;
 #endif
 
-  // Now take the best hypothesis from each rotation space
-  for (const auto &rotation_space : rotation_spaces)
+  // Now take the best hypothesis from each rotation space. The rotation spaces are tested in parallel.
+#pragma omp parallel for \
+  shared(num_rotation_spaces, rotation_spaces_vec, best_hypotheses) \
+  schedule(dynamic) \
+  num_threads(threads)
+  for (int space_id = 0 ; space_id < num_rotation_spaces ; ++space_id)
   {
+    const RotationSpace* rotation_space = rotation_spaces_vec[space_id];
     const std::map<std::string, ModelLibrary::Model*>& models = model_library_.getModels ();
-    Hypothesis best_hypothesis;
+    Hypothesis& best_hypothesis = best_hypotheses[space_id];
     best_hypothesis.match_confidence_ = 0.0f;
 
     // For each model in the library
@@ -387,19 +476,26 @@ pcl::recognition::ObjRecRANSAC::groupHypotheses(std::list<HypothesisBase>& hypot
       }
     }
 
-    if ( best_hypothesis.match_confidence_ > 0.0f )
+#ifdef OBJ_REC_RANSAC_VERBOSE
+    // Update the progress
+    int done;
+#pragma omp atomic capture
+    done = ++num_done;
+    printf ("\r  %.1f%% ", (static_cast<float> (done))*progress_factor); fflush (stdout);
+#endif
+  }
+
+  // Insert the accepted hypotheses into the output octree in the order of the rotation spaces
+  for ( int space_id = 0 ; space_id < num_rotation_spaces ; ++space_id )
+  {
+    if ( best_hypotheses[space_id].match_confidence_ > 0.0f )
     {
-      const float *c = rotation_space->getCenter ();
+      const float *c = rotation_spaces_vec[space_id]->getCenter ();
       HypothesisOctree::Node* node = grouped_hypotheses.createLeaf (c[0], c[1], c[2]);
 
-      node->setData (best_hypothesis);
+      node->setData (best_hypotheses[space_id]);
       ++num_accepted;
     }
-
-#ifdef OBJ_REC_RANSAC_VERBOSE
-    // Update the progress
-    printf ("\r  %.1f%% ", (static_cast<float> (++num_done))*progress_factor); fflush (stdout);
-#endif
   }
 
 #ifdef OBJ_REC_RANSAC_VERBOSE
@@ -473,6 +569,8 @@ pcl::recognition::ObjRecRANSAC::filterGraphOfCloseHypotheses (ORRGraph<Hypothesi
 void
 pcl::recognition::ObjRecRANSAC::buildGraphOfConflictingHypotheses (const BVHH& bvh, ORRGraph<Hypothesis*>& graph) const
 {
+  const pcl::ThreadReservation reservation (threads_);
+  const unsigned int threads = reservation.getNumberOfThreads ();
 #ifdef OBJ_REC_RANSAC_VERBOSE
   printf ("ObjRecRANSAC::%s(): building the conflict graph ... ", __func__); fflush (stdout);
 #endif
@@ -499,15 +597,21 @@ pcl::recognition::ObjRecRANSAC::buildGraphOfConflictingHypotheses (const BVHH& b
     graph.getNodes ()[lin_id]->setData ((*obj)->getData ());
   }
 
-  using ordered_int_pair = std::pair<int,int>;
-  // This is one is to make sure that we do not compute the same set intersection twice
-  std::set<ordered_int_pair, bool(*)(const ordered_int_pair&, const ordered_int_pair&)> ordered_hypotheses_ids (aux::compareOrderedPairs<int>);
-
-  // Project the hypotheses onto the "range image" and store in each pixel the corresponding hypothesis id
-  for (const auto &bounded_object : *bounded_objects)
+  const int num_objects = static_cast<int> (bounded_objects->size ());
+  // The ids of the hypotheses each hypothesis is in conflict with
+  std::vector<std::vector<int> > conflicts (num_objects);
+
+  // Project the hypotheses onto the "range image" and store in each pixel the corresponding hypothesis id. The hypotheses
+  // are processed in parallel and the edges are inserted afterwards.
+#pragma omp parallel for \
+  default(none) \
+  shared(num_objects, bounded_objects, bvh, conflicts) \
+  schedule(dynamic) \
+  num_threads(threads)
+  for (int obj_id = 0 ; obj_id < num_objects ; ++obj_id)
   {
     // For better code readability
-    Hypothesis *hypo1 = bounded_object->getData ();
+    Hypothesis *hypo1 = (*bounded_objects)[obj_id]->getData ();
 
     // Get the bounds of the current hypothesis
     float bounds[6];
@@ -522,24 +626,10 @@ pcl::recognition::ObjRecRANSAC::buildGraphOfConflictingHypotheses (const BVHH& b
       // For better code readability
       Hypothesis *hypo2 = intersected_object->getData ();
 
-      // Build an ordered int pair out of the hypotheses ids
-      std::pair<int,int> id_pair;
-      if ( hypo1->getLinearId () < hypo2->getLinearId () )
-      {
-        id_pair.first  = hypo1->getLinearId ();
-        id_pair.second = hypo2->getLinearId ();
-      }
-      else
-      {
-        id_pair.first  = hypo2->getLinearId ();
-        id_pair.second = hypo1->getLinearId ();
-      }
-
-      // Make sure that we do not compute the same set intersection twice
-      std::pair<std::set<ordered_int_pair, bool(*)(const ordered_int_pair&, const ordered_int_pair&)>::iterator, bool> res = ordered_hypotheses_ids.insert (id_pair);
-
-      if ( !res.second )
-        continue; // We've already computed that std::set intersection -> check the next pair
+      // Make sure that we do not compute the same set intersection twice: the bounds intersection is symmetric, so the
+      // pair is also found when processing 'hypo2' and is tested by the hypothesis with the smaller id only
+      if ( hypo2->getLinearId () < hypo1->getLinearId () )
+        continue;
 
       // Do the more involved intersection test based on a set intersection of the range image pixels which explained by the hypotheses
       std::set<int> id_intersection;
@@ -557,10 +647,14 @@ pcl::recognition::ObjRecRANSAC::buildGraphOfConflictingHypotheses (const BVHH& b
 
       // Check if the intersection set is large enough, i.e., if there is a conflict
       if ( frac_1 > intersection_fraction_ || frac_2 > intersection_fraction_ )
-        graph.insertUndirectedEdge (hypo1->getLinearId (), hypo2->getLinearId ());
+        conflicts[obj_id].push_back (hypo2->getLinearId ());
     }
   }
 
+  for ( int obj_id = 0 ; obj_id < num_objects ; ++obj_id )
+    for (const auto &conflicting_id : conflicts[obj_id])
+      graph.insertUndirectedEdge (obj_id, conflicting_id);
+
 #ifdef OBJ_REC_RANSAC_VERBOSE
 	printf("done\n");
 #endif
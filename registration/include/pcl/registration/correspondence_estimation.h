@@ -98,6 +98,7 @@ public:
   , source_cloud_updated_(true)
   , force_no_recompute_(false)
   , force_no_recompute_reciprocal_(false)
+  , threads_(1)
   {}
 
   /** \brief Empty destructor */
@@ -285,6 +286,16 @@ public:
     point_representation_ = point_representation;
   }
 
+  /** \brief Initialize the scheduler and set the number of threads to use for the
+   * nearest neighbor searches in determineCorrespondences and
+   * determineReciprocalCorrespondences. The search objects must support concurrent
+   * queries, which is the case for pcl::search::KdTree.
+   * \param nr_threads the number of hardware threads to use (0 takes as many as the
+   * budget of pcl::ExecutionContext allows when searching)
+   */
+  void
+  setNumberOfThreads(unsigned int nr_threads = 0);
+
   /** \brief Clone and cast to CorrespondenceEstimationBase */
   virtual typename CorrespondenceEstimationBase<PointSource, PointTarget, Scalar>::Ptr
   clone() const = 0;
@@ -344,6 +355,23 @@ protected:
   /** \brief A flag which, if set, means the tree operating on the source cloud
    * will never be recomputed*/
   bool force_no_recompute_reciprocal_;
+
+  /** \brief The number of threads the scheduler should use. */
+  unsigned int threads_;
+
+  /** \brief Split the source indices into contiguous blocks, determine the
+   * correspondences of each block in parallel and concatenate them in the order of
+   * the source indices, so the result does not depend on the number of threads.
+   * \param[out] correspondences the found correspondences
+   * \param[in] determine_block callable with the signature
+   * std::size_t (std::size_t begin, std::size_t end, pcl::Correspondence* block),
+   * which writes the correspondences found for (*indices_)[begin] to
+   * (*indices_)[end - 1] consecutively to block and returns their number
+   */
+  template <typename BlockFunctor>
+  void
+  determineCorrespondencesInBlocks(pcl::Correspondences& correspondences,
+                                   const BlockFunctor& determine_block);
 };
 
 /** \brief @b CorrespondenceEstimation represents the base class for
@@ -392,6 +420,8 @@ public:
   using CorrespondenceEstimationBase<PointSource, PointTarget, Scalar>::input_;
   using CorrespondenceEstimationBase<PointSource, PointTarget, Scalar>::indices_;
   using CorrespondenceEstimationBase<PointSource, PointTarget, Scalar>::input_fields_;
+  using CorrespondenceEstimationBase<PointSource, PointTarget, Scalar>::
+      determineCorrespondencesInBlocks;
   using PCLBase<PointSource>::deinitCompute;
 
   using KdTree = pcl::search::KdTree<PointTarget>;
@@ -70,6 +70,8 @@ public:
       initComputeReciprocal;
   using CorrespondenceEstimationBase<PointSource, PointTarget, Scalar>::
       input_transformed_;
+  using CorrespondenceEstimationBase<PointSource, PointTarget, Scalar>::
+      determineCorrespondencesInBlocks;
   using PCLBase<PointSource>::deinitCompute;
   using PCLBase<PointSource>::input_;
   using PCLBase<PointSource>::indices_;
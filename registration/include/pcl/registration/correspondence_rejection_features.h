@@ -40,6 +40,7 @@
 
 #pragma once
 
+#include <pcl/common/distances.h>
 #include <pcl/registration/correspondence_rejection.h>
 #include <pcl/point_cloud.h>
 #include <pcl/point_representation.h>
@@ -275,6 +276,14 @@ protected:
         return (std::numeric_limits<double>::max());
       }
 
+      // Trivial representations are compared in place
+      if (feature_representation_->isTrivial())
+        return (pcl::squaredL2Distance(
+            reinterpret_cast<const float*>(&feat_src),
+            reinterpret_cast<const float*>(&feat_tgt),
+            static_cast<std::size_t>(
+                feature_representation_->getNumberOfDimensions())));
+
       // Set the internal feature point representation of choice
       Eigen::VectorXf feat_src_ptr =
           Eigen::VectorXf::Zero(feature_representation_->getNumberOfDimensions());
@@ -0,0 +1,249 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#pragma once
+
+#include <pcl/registration/correspondence_rejection.h>
+#include <pcl/point_cloud.h>
+
+#include <functional>
+#include <vector>
+
+namespace pcl {
+namespace registration {
+/** \brief CorrespondenceRejectorFused runs a chain of correspondence rejection
+ * stages on a single vector of correspondences, compacting it in place instead of
+ * copying it once per rejector.
+ *
+ * The stages are applied in the order they are added. Consecutive element-wise
+ * stages (predicates, maximum distance, surface normal) are fused and evaluated in
+ * one parallel pass. The median distance is computed with a partial sort over the
+ * correspondences remaining at that stage, and the resulting threshold is fused
+ * with the element-wise stages that follow it. Any other CorrespondenceRejector can
+ * be added as a stage and is applied as is.
+ *
+ * Unlike CorrespondenceRejectorOneToOne, the one-to-one stage keeps the remaining
+ * correspondences in their input order.
+ * \ingroup registration
+ */
+class PCL_EXPORTS CorrespondenceRejectorFused : public CorrespondenceRejector {
+  using CorrespondenceRejector::getClassName;
+  using CorrespondenceRejector::input_correspondences_;
+  using CorrespondenceRejector::rejection_name_;
+
+public:
+  using Ptr = shared_ptr<CorrespondenceRejectorFused>;
+  using ConstPtr = shared_ptr<const CorrespondenceRejectorFused>;
+
+  /** \brief An element-wise rejection criterion, returning true to keep the
+   * correspondence. It is evaluated concurrently and must be thread safe.
+   */
+  using Predicate = std::function<bool(const pcl::Correspondence&)>;
+
+  /** \brief Empty constructor. */
+  CorrespondenceRejectorFused() : median_distance_(0), threads_(1)
+  {
+    rejection_name_ = "CorrespondenceRejectorFused";
+  }
+
+  /** \brief Get a list of valid correspondences after rejection from the original set
+   * of correspondences. \param[in] original_correspondences the set of initial
+   * correspondences given \param[out] remaining_correspondences the resultant filtered
+   * set of remaining correspondences
+   */
+  void
+  getRemainingCorrespondences(const pcl::Correspondences& original_correspondences,
+                              pcl::Correspondences& remaining_correspondences) override;
+
+  /** \brief Apply all stages to a set of correspondences, compacting it in place.
+   * \param[in,out] correspondences the correspondences to filter
+   */
+  void
+  rejectInPlace(pcl::Correspondences& correspondences);
+
+  /** \brief Add an element-wise stage keeping the correspondences for which
+   * \a predicate returns true.
+   */
+  inline void
+  addPredicate(const Predicate& predicate)
+  {
+    stages_.push_back({StageType::PREDICATE, predicate, 0.0, nullptr});
+  }
+
+  /** \brief Add an element-wise stage rejecting correspondences with a distance
+   * equal to or larger than \a distance, as CorrespondenceRejectorDistance does
+   * without input clouds (i.e. comparing against Correspondence::distance, which
+   * holds squared distances).
+   */
+  inline void
+  addMaximumDistance(float distance)
+  {
+    const float max_distance = distance * distance;
+    addPredicate([max_distance](const pcl::Correspondence& corr) {
+      return (corr.distance < max_distance);
+    });
+  }
+
+  /** \brief Add an element-wise stage rejecting correspondences whose normals
+   * enclose an angle with a cosine not larger than \a threshold, as
+   * CorrespondenceRejectorSurfaceNormal does.
+   * \param[in] source_normals the normals of the source (query) cloud
+   * \param[in] target_normals the normals of the target (match) cloud
+   * \param[in] threshold the minimum cosine of the angle between the normals
+   */
+  template <typename NormalT>
+  inline void
+  addSurfaceNormal(const typename pcl::PointCloud<NormalT>::ConstPtr& source_normals,
+                   const typename pcl::PointCloud<NormalT>::ConstPtr& target_normals,
+                   double threshold)
+  {
+    addPredicate([source_normals, target_normals, threshold](
+                     const pcl::Correspondence& corr) {
+      const NormalT& src = (*source_normals)[corr.index_query];
+      const NormalT& tgt = (*target_normals)[corr.index_match];
+      return (double((src.normal[0] * tgt.normal[0]) + (src.normal[1] * tgt.normal[1]) +
+                     (src.normal[2] * tgt.normal[2])) > threshold);
+    });
+  }
+
+  /** \brief Add a stage rejecting the correspondences with a distance larger than
+   * \a factor times the median distance of the correspondences remaining at this
+   * stage, as CorrespondenceRejectorMedianDistance does without input clouds.
+   */
+  inline void
+  addMedianDistance(double factor)
+  {
+    stages_.push_back({StageType::MEDIAN_DISTANCE, nullptr, factor, nullptr});
+  }
+
+  /** \brief Add a stage keeping, for each match index, only the correspondence with
+   * the smallest distance, as CorrespondenceRejectorOneToOne does. Correspondences
+   * without a valid match index are rejected.
+   */
+  inline void
+  addOneToOne()
+  {
+    stages_.push_back({StageType::ONE_TO_ONE, nullptr, 0.0, nullptr});
+  }
+
+  /** \brief Add an arbitrary rejector as a stage. It is applied through
+   * getRemainingCorrespondences and has to be set up (e.g. its input clouds) by the
+   * caller.
+   */
+  inline void
+  addRejector(const CorrespondenceRejector::Ptr& rejector)
+  {
+    stages_.push_back({StageType::REJECTOR, nullptr, 0.0, rejector});
+  }
+
+  /** \brief Remove all stages. */
+  inline void
+  clearStages()
+  {
+    stages_.clear();
+  }
+
+  /** \brief Get the number of stages. */
+  inline std::size_t
+  getNumberOfStages() const
+  {
+    return (stages_.size());
+  }
+
+  /** \brief Get the median distance computed by the last median distance stage. */
+  inline double
+  getMedianDistance() const
+  {
+    return (median_distance_);
+  }
+
+  /** \brief Initialize the scheduler and set the number of threads to use for the
+   * element-wise stages.
+   * \param[in] nr_threads the number of hardware threads to use (0 takes as many as
+   * the budget of pcl::ExecutionContext allows when rejecting)
+   */
+  void
+  setNumberOfThreads(unsigned int nr_threads = 0);
+
+  /** \brief Get the number of threads used for the element-wise stages. */
+  inline unsigned int
+  getNumberOfThreads() const
+  {
+    return (threads_);
+  }
+
+protected:
+  /** \brief Apply the rejection algorithm.
+   * \param[out] correspondences the set of resultant correspondences.
+   */
+  inline void
+  applyRejection(pcl::Correspondences& correspondences) override
+  {
+    getRemainingCorrespondences(*input_correspondences_, correspondences);
+  }
+
+  /** \brief Evaluate the pending element-wise stages in one pass and compact the
+   * correspondences accordingly.
+   */
+  void
+  applyPredicates(std::vector<Predicate>& predicates,
+                  pcl::Correspondences& correspondences);
+
+  /** \brief Keep the correspondence with the smallest distance per match index. */
+  void
+  applyOneToOne(pcl::Correspondences& correspondences);
+
+  enum class StageType { PREDICATE, MEDIAN_DISTANCE, ONE_TO_ONE, REJECTOR };
+
+  struct Stage {
+    StageType type;
+    Predicate predicate;
+    double factor;
+    CorrespondenceRejector::Ptr rejector;
+  };
+
+  /** \brief The rejection stages, in the order they are applied. */
+  std::vector<Stage> stages_;
+
+  /** \brief The median distance computed by the last median distance stage. */
+  double median_distance_;
+
+  /** \brief The number of threads the scheduler should use. */
+  unsigned int threads_;
+};
+} // namespace registration
+} // namespace pcl
@@ -0,0 +1,274 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#pragma once
+
+#include <pcl/correspondence.h>
+#include <pcl/point_cloud.h>
+#include <pcl/point_representation.h>
+
+#include <limits>
+#include <string>
+#include <vector>
+
+namespace pcl {
+namespace registration {
+/** \brief DescriptorMatcher finds the nearest neighbors of all the descriptors of a
+ * source cloud among the descriptors of a target cloud by exhaustive search.
+ *
+ * Trees like search::KdTree degrade to linear search on high-dimensional descriptors
+ * (e.g. SHOT352 or FPFHSignature33) and answer one query at a time. This class
+ * matches whole clouds at once instead: the descriptors are packed into row-major
+ * matrices and the squared distances between a block of source and a block of target
+ * descriptors are computed as \f$ \|q\|^2 + \|t\|^2 - 2 q \cdot t \f$, with the dot
+ * products of the block given by one matrix product. The blocks of source descriptors
+ * are processed in parallel, each keeping its k best matches. The distances of the
+ * selected matches are recomputed exactly at the end, so the rounding of the
+ * expansion affects the selection of near ties only.
+ *
+ * The matches can be filtered with Lowe's ratio test (\ref setRatio) and a mutual
+ * nearest neighbor check (\ref setCrossCheck), and are returned as
+ * pcl::Correspondences holding squared distances, like
+ * CorrespondenceEstimation::determineCorrespondences does. The packed target
+ * descriptors are kept until the target changes, so matching several source clouds
+ * against the same target packs it once.
+ *
+ * Descriptors whose representation is not valid (e.g. NaN) are never matched.
+ * \ingroup registration
+ */
+template <typename FeatureT>
+class DescriptorMatcher {
+public:
+  using Ptr = shared_ptr<DescriptorMatcher<FeatureT>>;
+  using ConstPtr = shared_ptr<const DescriptorMatcher<FeatureT>>;
+
+  using PointCloudFeature = pcl::PointCloud<FeatureT>;
+  using PointCloudFeatureConstPtr = typename PointCloudFeature::ConstPtr;
+
+  using PointRepresentationConstPtr = typename PointRepresentation<FeatureT>::ConstPtr;
+
+  /** \brief Empty constructor. */
+  DescriptorMatcher()
+  : point_representation_(new DefaultPointRepresentation<FeatureT>)
+  , ratio_(1.0f)
+  , cross_check_(false)
+  , threads_(1)
+  , target_packed_(false)
+  {}
+
+  /** \brief Provide a pointer to the source (query) descriptors. */
+  inline void
+  setInputSource(const PointCloudFeatureConstPtr& source)
+  {
+    source_ = source;
+  }
+
+  /** \brief Get a pointer to the source (query) descriptors. */
+  inline PointCloudFeatureConstPtr const
+  getInputSource()
+  {
+    return (source_);
+  }
+
+  /** \brief Provide a pointer to the target descriptors, searched for the matches. */
+  inline void
+  setInputTarget(const PointCloudFeatureConstPtr& target)
+  {
+    target_ = target;
+    target_packed_ = false;
+  }
+
+  /** \brief Get a pointer to the target descriptors. */
+  inline PointCloudFeatureConstPtr const
+  getInputTarget()
+  {
+    return (target_);
+  }
+
+  /** \brief Provide the representation used to convert the descriptors into vectors
+   * of floats. The default is DefaultPointRepresentation<FeatureT>.
+   */
+  inline void
+  setPointRepresentation(const PointRepresentationConstPtr& point_representation)
+  {
+    point_representation_ = point_representation;
+    target_packed_ = false;
+  }
+
+  /** \brief Set the ratio of Lowe's ratio test: a match is kept only if its distance is
+   * smaller than \a ratio times the distance of the second nearest target descriptor.
+   * \param[in] ratio the maximum ratio, 1 (the default) disables the test
+   */
+  inline void
+  setRatio(float ratio)
+  {
+    ratio_ = ratio;
+  }
+
+  /** \brief Get the ratio of the ratio test. */
+  inline float
+  getRatio() const
+  {
+    return (ratio_);
+  }
+
+  /** \brief Keep only the matches whose target descriptor has the source descriptor as
+   * its own nearest neighbor. This searches the source descriptors for all the target
+   * descriptors, doubling the cost of the matching.
+   */
+  inline void
+  setCrossCheck(bool cross_check)
+  {
+    cross_check_ = cross_check;
+  }
+
+  /** \brief Get whether matches have to be mutual nearest neighbors. */
+  inline bool
+  getCrossCheck() const
+  {
+    return (cross_check_);
+  }
+
+  /** \brief Set the number of threads to use.
+   * \param[in] nr_threads the number of hardware threads to use (0 takes as many as the
+   * budget of pcl::ExecutionContext allows when matching)
+   */
+  void
+  setNumberOfThreads(unsigned int nr_threads = 0);
+
+  /** \brief Get the number of threads to use. */
+  inline unsigned int
+  getNumberOfThreads() const
+  {
+    return (threads_);
+  }
+
+  /** \brief Match every source descriptor to its nearest target descriptor.
+   * \param[out] correspondences the matches passing the ratio test and cross check,
+   * ordered by source index, with index_query in the source and index_match in the
+   * target cloud
+   * \param[in] max_distance maximum allowed distance between matched descriptors
+   */
+  void
+  determineCorrespondences(
+      pcl::Correspondences& correspondences,
+      double max_distance = std::numeric_limits<double>::max());
+
+  /** \brief Find the k nearest target descriptors of every source descriptor. The
+   * ratio test and cross check do not apply.
+   * \param[in] k the number of neighbors to find
+   * \param[out] matches for each source descriptor its up to k matches, sorted by
+   * increasing distance (empty for invalid source descriptors)
+   * \param[in] max_distance maximum allowed distance between matched descriptors
+   */
+  void
+  nearestKSearch(unsigned int k,
+                 std::vector<pcl::Correspondences>& matches,
+                 double max_distance = std::numeric_limits<double>::max());
+
+protected:
+  using Matrix = Eigen::Matrix<float, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>;
+
+  /** \brief The valid descriptors of a cloud, packed for the search. */
+  struct PackedDescriptors {
+    /** \brief One vectorized descriptor per row. */
+    Matrix rows;
+    /** \brief Squared norm of every row. */
+    Eigen::VectorXf squared_norms;
+    /** \brief Index in the cloud of every row. */
+    pcl::Indices indices;
+  };
+
+  /** \brief Abstract class get name method. */
+  inline const std::string&
+  getClassName() const
+  {
+    return (matcher_name_);
+  }
+
+  /** \brief Vectorize the valid descriptors of a cloud. */
+  void
+  pack(const PointCloudFeature& cloud, PackedDescriptors& packed) const;
+
+  /** \brief Find the k nearest targets of all queries, by blocks of queries in
+   * parallel.
+   * \param[in] queries the query descriptors
+   * \param[in] targets the searched descriptors
+   * \param[in] k the number of neighbors
+   * \param[out] distances the squared distances of the neighbors, k per query, sorted
+   * \param[out] indices the rows in targets of the neighbors, k per query, -1 where
+   * there are fewer than k targets
+   */
+  void
+  searchKNearest(const PackedDescriptors& queries,
+                 const PackedDescriptors& targets,
+                 unsigned int k,
+                 std::vector<float>& distances,
+                 pcl::Indices& indices) const;
+
+  /** \brief Pack the source descriptors, and the target ones if they changed.
+   * \return false if source or target are missing
+   */
+  bool
+  initCompute(PackedDescriptors& source);
+
+  /** \brief Number of query rows processed by a thread at a time. */
+  static constexpr Eigen::Index query_block_size_ = 128;
+  /** \brief Number of target rows multiplied with a block of queries at a time. */
+  static constexpr Eigen::Index target_block_size_ = 512;
+
+  std::string matcher_name_ = "DescriptorMatcher";
+
+  PointCloudFeatureConstPtr source_;
+  PointCloudFeatureConstPtr target_;
+  PointRepresentationConstPtr point_representation_;
+
+  float ratio_;
+  bool cross_check_;
+  unsigned int threads_;
+
+  /** \brief The packed target descriptors, valid while target_packed_ is set. */
+  PackedDescriptors target_descriptors_;
+  bool target_packed_;
+
+public:
+  PCL_MAKE_ALIGNED_OPERATOR_NEW
+};
+} // namespace registration
+} // namespace pcl
+
+#include <pcl/registration/impl/descriptor_matcher.hpp>
@@ -91,7 +91,10 @@ public:
   , loop_end_(0)
   , reg_(new pcl::IterativeClosestPoint<PointT, PointT>)
   , compute_loop_(true)
-  , vd_(){};
+  , vd_()
+  {
+    setNumberOfThreads();
+  };
 
   /** \brief Empty destructor */
   ~ELCH() {}
@@ -193,6 +196,14 @@ public:
     compute_loop_ = false;
   }
 
+  /** \brief Set the number of threads used to distribute the loop closing error and
+   * to transform the point clouds.
+   * \param[in] nr_threads the number of hardware threads to use (0 takes as many as the
+   * budget of pcl::ExecutionContext allows when balancing the loop)
+   */
+  void
+  setNumberOfThreads(unsigned int nr_threads = 0);
+
   /** \brief Computes new poses for all point clouds by closing the loop
    * between start and end point cloud. This will transform all given point
    * clouds for now!
@@ -244,6 +255,9 @@ private:
   /** \brief previously added node in the loop_graph_. */
   typename boost::graph_traits<LoopGraph>::vertex_descriptor vd_;
 
+  /** \brief The number of threads the scheduler should use. */
+  unsigned int threads_;
+
 public:
   PCL_MAKE_ALIGNED_OPERATOR_NEW
 };
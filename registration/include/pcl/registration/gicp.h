@@ -111,6 +111,7 @@ public:
   , max_inner_iterations_(20)
   , translation_gradient_tolerance_(1e-2)
   , rotation_gradient_tolerance_(1e-2)
+  , threads_(1)
   {
     min_number_correspondences_ = 4;
     reg_name_ = "GeneralizedIterativeClosestPoint";
@@ -163,6 +164,9 @@ public:
 
   /** \brief Provide a pointer to the input target (e.g., the point cloud that we want
    * to align the input source to) \param[in] target the input point cloud target
+   * \note The target covariances are computed on the first call to align () and kept
+   * for all following calls until a new target is set, so when aligning a sequence of
+   * sources against the same map, set the target only once.
    */
   inline void
   setInputTarget(const PointCloudTargetConstPtr& target) override
@@ -310,6 +314,15 @@ public:
     return rotation_gradient_tolerance_;
   }
 
+  /** \brief Initialize the scheduler and set the number of threads to use for the
+   * covariance estimation, the correspondence search and the evaluation of the
+   * objective function and its gradient.
+   * \param nr_threads the number of hardware threads to use (0 takes as many as the
+   * budget of pcl::ExecutionContext allows when registering)
+   */
+  void
+  setNumberOfThreads(unsigned int nr_threads = 0);
+
 protected:
   /** \brief The number of neighbors used for covariances computation.
    * default: 20
@@ -361,6 +374,9 @@ protected:
   /** \brief minimal rotation gradient for early optimization stop */
   double rotation_gradient_tolerance_;
 
+  /** \brief The number of threads the scheduler should use. */
+  unsigned int threads_;
+
   /** \brief compute points covariances matrices according to the K nearest
    * neighbors. K is set via setCorrespondenceRandomness() method.
    * \param cloud pointer to point cloud
@@ -432,6 +448,14 @@ protected:
     BFGSSpace::Status
     checkGradient(const Vector6d& g) override;
 
+    /** \brief Evaluate the objective and/or its gradient at \a x.
+     * \param[in] x the state at which to evaluate
+     * \param[out] f the objective, not computed if nullptr
+     * \param[out] g the gradient, not computed if nullptr
+     */
+    void
+    evaluate(const Vector6d& x, double* f, Vector6d* g) const;
+
     const GeneralizedIterativeClosestPoint* gicp_;
   };
 
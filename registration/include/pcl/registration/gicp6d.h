@@ -108,7 +108,16 @@ protected:
   inline bool
   searchForNeighbors(const PointXYZLAB& query,
                      pcl::Indices& index,
-                     std::vector<float>& distance);
+                     std::vector<float>& distance) const;
+
+  /** \brief Convert the colors of a cloud to CIELAB, with the threads reserved for
+   * threads_ from the budget of pcl::ExecutionContext.
+   * \param cloud the XYZRGBA input cloud
+   * \param lab the output cloud, already resized to the size of the input
+   */
+  void
+  convertToLab(const PointCloudSource& cloud,
+               pcl::PointCloud<PointXYZLAB>& lab) const;
 
 protected:
   /** \brief Holds the converted (LAB) data cloud. */
@@ -46,7 +46,8 @@ namespace pcl {
  * \param[in] cloud pointer to the input point cloud
  * \param[in] max_dist maximum distance of a point to be considered as a neighbor
  * \param[in] nr_threads number of threads to use (default = 1, only used if OpenMP flag
- * is set) \return the mean point density of a given point cloud
+ * is set, 0 takes as many as the budget of pcl::ExecutionContext allows)
+ * \return the mean point density of a given point cloud
  */
 template <typename PointT>
 inline float
@@ -59,7 +60,8 @@ getMeanPointDensity(const typename pcl::PointCloud<PointT>::ConstPtr& cloud,
  * \param[in] indices the vector of point indices to use from \a cloud
  * \param[in] max_dist maximum distance of a point to be considered as a neighbor
  * \param[in] nr_threads number of threads to use (default = 1, only used if OpenMP flag
- * is set) \return the mean point density of a given point cloud
+ * is set, 0 takes as many as the budget of pcl::ExecutionContext allows)
+ * \return the mean point density of a given point cloud
  */
 template <typename PointT>
 inline float
@@ -160,7 +162,8 @@ public:
   };
 
   /** \brief Set the number of used threads if OpenMP is activated.
-   * \param[in] nr_threads the number of used threads
+   * \param[in] nr_threads the number of used threads (0 takes as many as the budget of
+   * pcl::ExecutionContext allows when aligning)
    */
   inline void
   setNumberOfThreads(int nr_threads)
@@ -351,6 +354,11 @@ protected:
   /** \brief Search for corresponding point pairs given the distance between two base
    * points.
    *
+   * The pairs are extracted with a simultaneous traversal of the source pair tree (see
+   * buildSourcePairTree()), which only visits the pairs of nodes whose distance range
+   * intersects the shell of radius ref_dist +/- max_pair_diff_, instead of testing all
+   * point pairs.
+   *
    * \param[in] idx1 first index of current base segment (in source cloud)
    * \param[in] idx2 second index of current base segment (in source cloud)
    * \param[out] pairs resulting point pairs with point-to-point distance close to
@@ -361,6 +369,28 @@ protected:
   virtual int
   bruteForceCorrespondences(int idx1, int idx2, pcl::Correspondences& pairs);
 
+  /** \brief Build the bounding box tree over source_indices_ that is used to extract
+   * the point pairs with a given distance in bruteForceCorrespondences().
+   */
+  void
+  buildSourcePairTree();
+
+  /** \brief Collect all point pairs between two nodes of the source pair tree whose
+   * distance lies within the given range and whose normals match the reference pair.
+   *
+   * \param[in] node_a index of the first node
+   * \param[in] node_b index of the second node, may be node_a
+   * \param[in] ref_dist distance between the two base points
+   * \param[in] ref_norm_angle normal difference of the two base points
+   * \param[out] pairs resulting point pairs, both orientations are added
+   */
+  void
+  collectPairs(int node_a,
+               int node_b,
+               float ref_dist,
+               float ref_norm_angle,
+               pcl::Correspondences& pairs) const;
+
   /** \brief Determine base matches by combining the point pair candidate and search for
    * coinciding intersection points using the diagonal segment ratios of base B. The
    * coincidation threshold is calculated during initialization (coincidation_limit_).
@@ -523,6 +553,24 @@ protected:
   /** \brief A pointer to the vector of source point indices to use after sampling. */
   pcl::IndicesPtr source_indices_;
 
+  /** \brief Node of the bounding box tree over the sampled source points. */
+  struct SourcePairNode {
+    /** \brief Bounding box of the points of the node. */
+    Eigen::Vector3f min_pt, max_pt;
+
+    /** \brief The points of the node are source_pair_indices_[begin, end). */
+    int begin, end;
+
+    /** \brief Child nodes, -1 for leaves. */
+    int left, right;
+  };
+
+  /** \brief Bounding box tree over source_indices_, the root is the first node. */
+  std::vector<SourcePairNode> source_pair_nodes_;
+
+  /** \brief The sampled source indices, ordered by the nodes of the pair tree. */
+  pcl::Indices source_pair_indices_;
+
   /** \brief A pointer to the vector of target point indices to use after sampling. */
   pcl::IndicesPtr target_indices_;
 
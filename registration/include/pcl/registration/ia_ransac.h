@@ -147,6 +147,7 @@ public:
   , k_correspondences_(10)
   , feature_tree_(new pcl::KdTreeFLANN<FeatureT>)
   , error_functor_()
+  , threads_(1)
   {
     reg_name_ = "SampleConsensusInitialAlignment";
     max_iterations_ = 1000;
@@ -257,6 +258,16 @@ public:
     return (error_functor_);
   }
 
+  /** \brief Set the number of threads used to generate and score pose hypotheses.
+   * With more than one thread every thread draws its samples from its own random
+   * stream, seeded from std::rand (), so results are reproducible for a given seed and
+   * thread count. A single thread keeps the sequential std::rand () sampling.
+   * \param[in] nr_threads the number of hardware threads to use (0 takes as many as the
+   * budget of pcl::ExecutionContext allows when sampling)
+   */
+  void
+  setNumberOfThreads(unsigned int nr_threads = 0);
+
 protected:
   /** \brief Choose a random index between 0 and n-1
    * \param n the number of possible indices to choose from
@@ -291,6 +302,38 @@ protected:
                       const pcl::Indices& sample_indices,
                       pcl::Indices& corresponding_indices);
 
+  /** \brief Select \a nr_samples sample points from cloud, drawing random indices from
+   * \a random_index. Does not modify any member.
+   * \param[in] cloud the input point cloud
+   * \param[in] nr_samples the number of samples to select
+   * \param[in,out] min_sample_distance the minimum distance between any two samples,
+   * halved whenever no valid sample can be found
+   * \param[out] sample_indices the resulting sample indices
+   * \param[in] random_index callable returning a random index in [0, n) for a given n
+   */
+  template <typename RandomIndexFunctor>
+  void
+  selectSamples(const PointCloudSource& cloud,
+                unsigned int nr_samples,
+                float& min_sample_distance,
+                pcl::Indices& sample_indices,
+                const RandomIndexFunctor& random_index) const;
+
+  /** \brief Find the target correspondences of the sample points, drawing random
+   * indices from \a random_index. Does not modify any member.
+   * \param[in] input_features a cloud of feature descriptors
+   * \param[in] sample_indices the indices of each sample point
+   * \param[out] corresponding_indices the resulting indices of each sample's
+   * corresponding point in the target cloud
+   * \param[in] random_index callable returning a random index in [0, n) for a given n
+   */
+  template <typename RandomIndexFunctor>
+  void
+  findSimilarFeatures(const FeatureCloud& input_features,
+                      const pcl::Indices& sample_indices,
+                      pcl::Indices& corresponding_indices,
+                      const RandomIndexFunctor& random_index) const;
+
   /** \brief An error metric for that computes the quality of the alignment between the
    * given cloud and the target. \param cloud the input cloud \param threshold distances
    * greater than this value are capped
@@ -298,6 +341,22 @@ protected:
   float
   computeErrorMetric(const PointCloudSource& cloud, float threshold);
 
+  /** \brief Compute the error metric of a pose hypothesis without transforming the
+   * whole input cloud first, giving up as soon as the error can no longer get below
+   * \a max_error. The error functor must be nonnegative for this to be exact.
+   * \param[in] transformation the pose hypothesis
+   * \param[in] evaluation_order the order in which the input points are scored; a
+   * random order lets bad hypotheses exceed the bound after only a few points
+   * \param[in] max_error the error bound
+   * \param[out] error the accumulated error, only complete if true is returned
+   * \return false if the evaluation stopped because the error exceeded \a max_error
+   */
+  bool
+  computeErrorMetric(const Eigen::Matrix4f& transformation,
+                     const pcl::Indices& evaluation_order,
+                     float max_error,
+                     float& error) const;
+
   /** \brief Rigid transformation computation method.
    * \param output the transformed input point cloud dataset using the rigid
    * transformation found \param guess The computed transforamtion
@@ -327,6 +386,9 @@ protected:
 
   ErrorFunctorPtr error_functor_;
 
+  /** \brief The number of threads the scheduler should use. */
+  unsigned int threads_;
+
 public:
   PCL_MAKE_ALIGNED_OPERATOR_NEW
 };
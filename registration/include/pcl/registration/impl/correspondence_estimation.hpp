@@ -42,8 +42,11 @@
 #define PCL_REGISTRATION_IMPL_CORRESPONDENCE_ESTIMATION_H_
 
 #include <pcl/common/copy_point.h>
+#include <pcl/common/execution_context.h>
 #include <pcl/common/io.h>
 
+#include <algorithm>
+
 namespace pcl {
 
 namespace registration {
@@ -112,6 +115,58 @@ CorrespondenceEstimationBase<PointSource, PointTarget, Scalar>::initComputeRecip
   return (true);
 }
 
+template <typename PointSource, typename PointTarget, typename Scalar>
+void
+CorrespondenceEstimationBase<PointSource, PointTarget, Scalar>::setNumberOfThreads(
+    unsigned int nr_threads)
+{
+  // 0 is resolved against the budget of pcl::ExecutionContext at compute time
+  threads_ = nr_threads;
+}
+
+template <typename PointSource, typename PointTarget, typename Scalar>
+template <typename BlockFunctor>
+void
+CorrespondenceEstimationBase<PointSource, PointTarget, Scalar>::
+    determineCorrespondencesInBlocks(pcl::Correspondences& correspondences,
+                                     const BlockFunctor& determine_block)
+{
+  const std::size_t nr_indices = indices_->size();
+  correspondences.resize(nr_indices);
+
+  const pcl::ThreadReservation reservation(threads_);
+  const unsigned int threads = reservation.getNumberOfThreads();
+  // A few blocks per thread balance the varying search costs, every block writes to
+  // its own preallocated slice of the output
+  std::size_t nr_blocks = threads > 1 ? 8 * static_cast<std::size_t>(threads) : 1;
+  nr_blocks = std::max<std::size_t>(1, std::min(nr_blocks, nr_indices));
+  std::vector<std::size_t> block_begin(nr_blocks + 1);
+  for (std::size_t block = 0; block <= nr_blocks; ++block)
+    block_begin[block] = block * nr_indices / nr_blocks;
+  std::vector<std::size_t> block_size(nr_blocks, 0);
+
+#pragma omp parallel for default(none)                                                 \
+    shared(correspondences, determine_block, nr_blocks, block_begin, block_size)      \
+    schedule(dynamic, 1) num_threads(threads)
+  for (std::ptrdiff_t block = 0; block < static_cast<std::ptrdiff_t>(nr_blocks);
+       ++block) {
+    block_size[block] = determine_block(block_begin[block],
+                                        block_begin[block + 1],
+                                        correspondences.data() + block_begin[block]);
+  }
+
+  // Concatenate the valid correspondences of the blocks in order
+  std::size_t nr_valid_correspondences = block_size[0];
+  for (std::size_t block = 1; block < nr_blocks; ++block) {
+    const auto first = correspondences.begin() + block_begin[block];
+    std::move(first,
+              first + block_size[block],
+              correspondences.begin() + nr_valid_correspondences);
+    nr_valid_correspondences += block_size[block];
+  }
+  correspondences.resize(nr_valid_correspondences);
+}
+
 template <typename PointSource, typename PointTarget, typename Scalar>
 void
 CorrespondenceEstimation<PointSource, PointTarget, Scalar>::determineCorrespondences(
@@ -122,49 +177,42 @@ CorrespondenceEstimation<PointSource, PointTarget, Scalar>::determineCorresponde
 
   double max_dist_sqr = max_distance * max_distance;
 
-  correspondences.resize(indices_->size());
-
-  pcl::Indices index(1);
-  std::vector<float> distance(1);
-  pcl::Correspondence corr;
-  unsigned int nr_valid_correspondences = 0;
-
   // Check if the template types are the same. If true, avoid a copy.
   // Both point types MUST be registered using the POINT_CLOUD_REGISTER_POINT_STRUCT
   // macro!
-  if (isSamePointType<PointSource, PointTarget>()) {
-    // Iterate over the input set of source indices
-    for (const auto& idx : (*indices_)) {
-      tree_->nearestKSearch((*input_)[idx], 1, index, distance);
-      if (distance[0] > max_dist_sqr)
-        continue;
-
-      corr.index_query = idx;
-      corr.index_match = index[0];
-      corr.distance = distance[0];
-      correspondences[nr_valid_correspondences++] = corr;
-    }
-  }
-  else {
-    PointTarget pt;
-
-    // Iterate over the input set of source indices
-    for (const auto& idx : (*indices_)) {
-      // Copy the source data to a target PointTarget format so we can search in the
-      // tree
-      copyPoint((*input_)[idx], pt);
-
-      tree_->nearestKSearch(pt, 1, index, distance);
-      if (distance[0] > max_dist_sqr)
-        continue;
-
-      corr.index_query = idx;
-      corr.index_match = index[0];
-      corr.distance = distance[0];
-      correspondences[nr_valid_correspondences++] = corr;
-    }
-  }
-  correspondences.resize(nr_valid_correspondences);
+  const bool same_point_type = isSamePointType<PointSource, PointTarget>();
+
+  determineCorrespondencesInBlocks(
+      correspondences,
+      [&](std::size_t begin, std::size_t end, pcl::Correspondence* block) {
+        pcl::Indices index(1);
+        std::vector<float> distance(1);
+        pcl::Correspondence corr;
+        PointTarget pt;
+        std::size_t nr_valid_correspondences = 0;
+
+        // Iterate over the input set of source indices
+        for (std::size_t i = begin; i < end; ++i) {
+          const auto& idx = (*indices_)[i];
+          if (same_point_type) {
+            tree_->nearestKSearch((*input_)[idx], 1, index, distance);
+          }
+          else {
+            // Copy the source data to a target PointTarget format so we can search in
+            // the tree
+            copyPoint((*input_)[idx], pt);
+            tree_->nearestKSearch(pt, 1, index, distance);
+          }
+          if (distance[0] > max_dist_sqr)
+            continue;
+
+          corr.index_query = idx;
+          corr.index_match = index[0];
+          corr.distance = distance[0];
+          block[nr_valid_correspondences++] = corr;
+        }
+        return nr_valid_correspondences;
+      });
   deinitCompute();
 }
 
@@ -183,70 +231,61 @@ CorrespondenceEstimation<PointSource, PointTarget, Scalar>::
     return;
   double max_dist_sqr = max_distance * max_distance;
 
-  correspondences.resize(indices_->size());
-  pcl::Indices index(1);
-  std::vector<float> distance(1);
-  pcl::Indices index_reciprocal(1);
-  std::vector<float> distance_reciprocal(1);
-  pcl::Correspondence corr;
-  unsigned int nr_valid_correspondences = 0;
-  int target_idx = 0;
-
   // Check if the template types are the same. If true, avoid a copy.
   // Both point types MUST be registered using the POINT_CLOUD_REGISTER_POINT_STRUCT
   // macro!
-  if (isSamePointType<PointSource, PointTarget>()) {
-    // Iterate over the input set of source indices
-    for (const auto& idx : (*indices_)) {
-      tree_->nearestKSearch((*input_)[idx], 1, index, distance);
-      if (distance[0] > max_dist_sqr)
-        continue;
-
-      target_idx = index[0];
-
-      tree_reciprocal_->nearestKSearch(
-          (*target_)[target_idx], 1, index_reciprocal, distance_reciprocal);
-      if (distance_reciprocal[0] > max_dist_sqr || idx != index_reciprocal[0])
-        continue;
-
-      corr.index_query = idx;
-      corr.index_match = index[0];
-      corr.distance = distance[0];
-      correspondences[nr_valid_correspondences++] = corr;
-    }
-  }
-  else {
-    PointTarget pt_src;
-    PointSource pt_tgt;
-
-    // Iterate over the input set of source indices
-    for (const auto& idx : (*indices_)) {
-      // Copy the source data to a target PointTarget format so we can search in the
-      // tree
-      copyPoint((*input_)[idx], pt_src);
-
-      tree_->nearestKSearch(pt_src, 1, index, distance);
-      if (distance[0] > max_dist_sqr)
-        continue;
-
-      target_idx = index[0];
-
-      // Copy the target data to a target PointSource format so we can search in the
-      // tree_reciprocal
-      copyPoint((*target_)[target_idx], pt_tgt);
-
-      tree_reciprocal_->nearestKSearch(
-          pt_tgt, 1, index_reciprocal, distance_reciprocal);
-      if (distance_reciprocal[0] > max_dist_sqr || idx != index_reciprocal[0])
-        continue;
-
-      corr.index_query = idx;
-      corr.index_match = index[0];
-      corr.distance = distance[0];
-      correspondences[nr_valid_correspondences++] = corr;
-    }
-  }
-  correspondences.resize(nr_valid_correspondences);
+  const bool same_point_type = isSamePointType<PointSource, PointTarget>();
+
+  determineCorrespondencesInBlocks(
+      correspondences,
+      [&](std::size_t begin, std::size_t end, pcl::Correspondence* block) {
+        pcl::Indices index(1);
+        std::vector<float> distance(1);
+        pcl::Indices index_reciprocal(1);
+        std::vector<float> distance_reciprocal(1);
+        pcl::Correspondence corr;
+        PointTarget pt_src;
+        PointSource pt_tgt;
+        std::size_t nr_valid_correspondences = 0;
+
+        // Iterate over the input set of source indices
+        for (std::size_t i = begin; i < end; ++i) {
+          const auto& idx = (*indices_)[i];
+          if (same_point_type) {
+            tree_->nearestKSearch((*input_)[idx], 1, index, distance);
+          }
+          else {
+            // Copy the source data to a target PointTarget format so we can search in
+            // the tree
+            copyPoint((*input_)[idx], pt_src);
+            tree_->nearestKSearch(pt_src, 1, index, distance);
+          }
+          if (distance[0] > max_dist_sqr)
+            continue;
+
+          const auto target_idx = index[0];
+
+          if (same_point_type) {
+            tree_reciprocal_->nearestKSearch(
+                (*target_)[target_idx], 1, index_reciprocal, distance_reciprocal);
+          }
+          else {
+            // Copy the target data to a target PointSource format so we can search in
+            // the tree_reciprocal
+            copyPoint((*target_)[target_idx], pt_tgt);
+            tree_reciprocal_->nearestKSearch(
+                pt_tgt, 1, index_reciprocal, distance_reciprocal);
+          }
+          if (distance_reciprocal[0] > max_dist_sqr || idx != index_reciprocal[0])
+            continue;
+
+          corr.index_query = idx;
+          corr.index_match = index[0];
+          corr.distance = distance[0];
+          block[nr_valid_correspondences++] = corr;
+        }
+        return nr_valid_correspondences;
+      });
   deinitCompute();
 }
 
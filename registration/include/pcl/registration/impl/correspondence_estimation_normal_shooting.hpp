@@ -71,104 +71,54 @@ CorrespondenceEstimationNormalShooting<PointSource, PointTarget, NormalT, Scalar
   if (!initCompute())
     return;
 
-  correspondences.resize(indices_->size());
-
-  pcl::Indices nn_indices(k_);
-  std::vector<float> nn_dists(k_);
-
-  int min_index = 0;
-
-  pcl::Correspondence corr;
-  unsigned int nr_valid_correspondences = 0;
-
-  // Check if the template types are the same. If true, avoid a copy.
-  // Both point types MUST be registered using the POINT_CLOUD_REGISTER_POINT_STRUCT
-  // macro!
-  if (isSamePointType<PointSource, PointTarget>()) {
-    PointTarget pt;
-    // Iterate over the input set of source indices
-    for (const auto& idx_i : (*indices_)) {
-      tree_->nearestKSearch((*input_)[idx_i], k_, nn_indices, nn_dists);
-
-      // Among the K nearest neighbours find the one with minimum perpendicular distance
-      // to the normal
-      double min_dist = std::numeric_limits<double>::max();
-
-      // Find the best correspondence
-      for (std::size_t j = 0; j < nn_indices.size(); j++) {
-        // computing the distance between a point and a line in 3d.
-        // Reference - http://mathworld.wolfram.com/Point-LineDistance3-Dimensional.html
-        pt.x = (*target_)[nn_indices[j]].x - (*input_)[idx_i].x;
-        pt.y = (*target_)[nn_indices[j]].y - (*input_)[idx_i].y;
-        pt.z = (*target_)[nn_indices[j]].z - (*input_)[idx_i].z;
-
-        const NormalT& normal = (*source_normals_)[idx_i];
-        Eigen::Vector3d N(normal.normal_x, normal.normal_y, normal.normal_z);
-        Eigen::Vector3d V(pt.x, pt.y, pt.z);
-        Eigen::Vector3d C = N.cross(V);
-
-        // Check if we have a better correspondence
-        double dist = C.dot(C);
-        if (dist < min_dist) {
-          min_dist = dist;
-          min_index = static_cast<int>(j);
+  determineCorrespondencesInBlocks(
+      correspondences,
+      [&](std::size_t begin, std::size_t end, pcl::Correspondence* block) {
+        pcl::Indices nn_indices(k_);
+        std::vector<float> nn_dists(k_);
+        pcl::Correspondence corr;
+        std::size_t nr_valid_correspondences = 0;
+
+        // Iterate over the input set of source indices
+        for (std::size_t i = begin; i < end; ++i) {
+          const auto& idx_i = (*indices_)[i];
+          tree_->nearestKSearch((*input_)[idx_i], k_, nn_indices, nn_dists);
+
+          // Among the K nearest neighbours find the one with minimum perpendicular
+          // distance to the normal
+          double min_dist = std::numeric_limits<double>::max();
+          int min_index = 0;
+
+          const NormalT& normal = (*source_normals_)[idx_i];
+          const Eigen::Vector3d N(normal.normal_x, normal.normal_y, normal.normal_z);
+
+          // Find the best correspondence
+          for (std::size_t j = 0; j < nn_indices.size(); j++) {
+            // computing the distance between a point and a line in 3d.
+            // Reference -
+            // http://mathworld.wolfram.com/Point-LineDistance3-Dimensional.html
+            const Eigen::Vector3d V((*target_)[nn_indices[j]].x - (*input_)[idx_i].x,
+                                    (*target_)[nn_indices[j]].y - (*input_)[idx_i].y,
+                                    (*target_)[nn_indices[j]].z - (*input_)[idx_i].z);
+            const Eigen::Vector3d C = N.cross(V);
+
+            // Check if we have a better correspondence
+            double dist = C.dot(C);
+            if (dist < min_dist) {
+              min_dist = dist;
+              min_index = static_cast<int>(j);
+            }
+          }
+          if (min_dist > max_distance)
+            continue;
+
+          corr.index_query = idx_i;
+          corr.index_match = nn_indices[min_index];
+          corr.distance = nn_dists[min_index]; // min_dist;
+          block[nr_valid_correspondences++] = corr;
         }
-      }
-      if (min_dist > max_distance)
-        continue;
-
-      corr.index_query = idx_i;
-      corr.index_match = nn_indices[min_index];
-      corr.distance = nn_dists[min_index]; // min_dist;
-      correspondences[nr_valid_correspondences++] = corr;
-    }
-  }
-  else {
-    PointTarget pt;
-
-    // Iterate over the input set of source indices
-    for (const auto& idx_i : (*indices_)) {
-      tree_->nearestKSearch((*input_)[idx_i], k_, nn_indices, nn_dists);
-
-      // Among the K nearest neighbours find the one with minimum perpendicular distance
-      // to the normal
-      double min_dist = std::numeric_limits<double>::max();
-
-      // Find the best correspondence
-      for (std::size_t j = 0; j < nn_indices.size(); j++) {
-        PointSource pt_src;
-        // Copy the source data to a target PointTarget format so we can search in the
-        // tree
-        copyPoint((*input_)[idx_i], pt_src);
-
-        // computing the distance between a point and a line in 3d.
-        // Reference - http://mathworld.wolfram.com/Point-LineDistance3-Dimensional.html
-        pt.x = (*target_)[nn_indices[j]].x - pt_src.x;
-        pt.y = (*target_)[nn_indices[j]].y - pt_src.y;
-        pt.z = (*target_)[nn_indices[j]].z - pt_src.z;
-
-        const NormalT& normal = (*source_normals_)[idx_i];
-        Eigen::Vector3d N(normal.normal_x, normal.normal_y, normal.normal_z);
-        Eigen::Vector3d V(pt.x, pt.y, pt.z);
-        Eigen::Vector3d C = N.cross(V);
-
-        // Check if we have a better correspondence
-        double dist = C.dot(C);
-        if (dist < min_dist) {
-          min_dist = dist;
-          min_index = static_cast<int>(j);
-        }
-      }
-      if (min_dist > max_distance)
-        continue;
-
-      corr.index_query = idx_i;
-      corr.index_match = nn_indices[min_index];
-      corr.distance = nn_dists[min_index]; // min_dist;
-      correspondences[nr_valid_correspondences++] = corr;
-    }
-  }
-  correspondences.resize(nr_valid_correspondences);
+        return nr_valid_correspondences;
+      });
   deinitCompute();
 }
 
@@ -186,125 +136,65 @@ CorrespondenceEstimationNormalShooting<PointSource, PointTarget, NormalT, Scalar
   if (!initComputeReciprocal())
     return;
 
-  correspondences.resize(indices_->size());
-
-  pcl::Indices nn_indices(k_);
-  std::vector<float> nn_dists(k_);
-  pcl::Indices index_reciprocal(1);
-  std::vector<float> distance_reciprocal(1);
-
-  int min_index = 0;
-
-  pcl::Correspondence corr;
-  unsigned int nr_valid_correspondences = 0;
-  int target_idx = 0;
-
-  // Check if the template types are the same. If true, avoid a copy.
-  // Both point types MUST be registered using the POINT_CLOUD_REGISTER_POINT_STRUCT
-  // macro!
-  if (isSamePointType<PointSource, PointTarget>()) {
-    PointTarget pt;
-    // Iterate over the input set of source indices
-    for (const auto& idx_i : (*indices_)) {
-      tree_->nearestKSearch((*input_)[idx_i], k_, nn_indices, nn_dists);
-
-      // Among the K nearest neighbours find the one with minimum perpendicular distance
-      // to the normal
-      double min_dist = std::numeric_limits<double>::max();
-
-      // Find the best correspondence
-      for (std::size_t j = 0; j < nn_indices.size(); j++) {
-        // computing the distance between a point and a line in 3d.
-        // Reference - http://mathworld.wolfram.com/Point-LineDistance3-Dimensional.html
-        pt.x = (*target_)[nn_indices[j]].x - (*input_)[idx_i].x;
-        pt.y = (*target_)[nn_indices[j]].y - (*input_)[idx_i].y;
-        pt.z = (*target_)[nn_indices[j]].z - (*input_)[idx_i].z;
-
-        const NormalT& normal = (*source_normals_)[idx_i];
-        Eigen::Vector3d N(normal.normal_x, normal.normal_y, normal.normal_z);
-        Eigen::Vector3d V(pt.x, pt.y, pt.z);
-        Eigen::Vector3d C = N.cross(V);
-
-        // Check if we have a better correspondence
-        double dist = C.dot(C);
-        if (dist < min_dist) {
-          min_dist = dist;
-          min_index = static_cast<int>(j);
+  determineCorrespondencesInBlocks(
+      correspondences,
+      [&](std::size_t begin, std::size_t end, pcl::Correspondence* block) {
+        pcl::Indices nn_indices(k_);
+        std::vector<float> nn_dists(k_);
+        pcl::Indices index_reciprocal(1);
+        std::vector<float> distance_reciprocal(1);
+        pcl::Correspondence corr;
+        std::size_t nr_valid_correspondences = 0;
+
+        // Iterate over the input set of source indices
+        for (std::size_t i = begin; i < end; ++i) {
+          const auto& idx_i = (*indices_)[i];
+          tree_->nearestKSearch((*input_)[idx_i], k_, nn_indices, nn_dists);
+
+          // Among the K nearest neighbours find the one with minimum perpendicular
+          // distance to the normal
+          double min_dist = std::numeric_limits<double>::max();
+          int min_index = 0;
+
+          const NormalT& normal = (*source_normals_)[idx_i];
+          const Eigen::Vector3d N(normal.normal_x, normal.normal_y, normal.normal_z);
+
+          // Find the best correspondence
+          for (std::size_t j = 0; j < nn_indices.size(); j++) {
+            // computing the distance between a point and a line in 3d.
+            // Reference -
+            // http://mathworld.wolfram.com/Point-LineDistance3-Dimensional.html
+            const Eigen::Vector3d V((*target_)[nn_indices[j]].x - (*input_)[idx_i].x,
+                                    (*target_)[nn_indices[j]].y - (*input_)[idx_i].y,
+                                    (*target_)[nn_indices[j]].z - (*input_)[idx_i].z);
+            const Eigen::Vector3d C = N.cross(V);
+
+            // Check if we have a better correspondence
+            double dist = C.dot(C);
+            if (dist < min_dist) {
+              min_dist = dist;
+              min_index = static_cast<int>(j);
+            }
+          }
+          if (min_dist > max_distance)
+            continue;
+
+          // Check if the correspondence is reciprocal
+          const auto target_idx = nn_indices[min_index];
+          tree_reciprocal_->nearestKSearch(
+              (*target_)[target_idx], 1, index_reciprocal, distance_reciprocal);
+
+          if (idx_i != index_reciprocal[0])
+            continue;
+
+          // Correspondence IS reciprocal, save it and continue
+          corr.index_query = idx_i;
+          corr.index_match = nn_indices[min_index];
+          corr.distance = nn_dists[min_index]; // min_dist;
+          block[nr_valid_correspondences++] = corr;
         }
-      }
-      if (min_dist > max_distance)
-        continue;
-
-      // Check if the correspondence is reciprocal
-      target_idx = nn_indices[min_index];
-      tree_reciprocal_->nearestKSearch(
-          (*target_)[target_idx], 1, index_reciprocal, distance_reciprocal);
-
-      if (idx_i != index_reciprocal[0])
-        continue;
-
-      // Correspondence IS reciprocal, save it and continue
-      corr.index_query = idx_i;
-      corr.index_match = nn_indices[min_index];
-      corr.distance = nn_dists[min_index]; // min_dist;
-      correspondences[nr_valid_correspondences++] = corr;
-    }
-  }
-  else {
-    PointTarget pt;
-
-    // Iterate over the input set of source indices
-    for (const auto& idx_i : (*indices_)) {
-      tree_->nearestKSearch((*input_)[idx_i], k_, nn_indices, nn_dists);
-
-      // Among the K nearest neighbours find the one with minimum perpendicular distance
-      // to the normal
-      double min_dist = std::numeric_limits<double>::max();
-
-      // Find the best correspondence
-      for (std::size_t j = 0; j < nn_indices.size(); j++) {
-        PointSource pt_src;
-        // Copy the source data to a target PointTarget format so we can search in the
-        // tree
-        copyPoint((*input_)[idx_i], pt_src);
-
-        // computing the distance between a point and a line in 3d.
-        // Reference - http://mathworld.wolfram.com/Point-LineDistance3-Dimensional.html
-        pt.x = (*target_)[nn_indices[j]].x - pt_src.x;
-        pt.y = (*target_)[nn_indices[j]].y - pt_src.y;
-        pt.z = (*target_)[nn_indices[j]].z - pt_src.z;
-
-        const NormalT& normal = (*source_normals_)[idx_i];
-        Eigen::Vector3d N(normal.normal_x, normal.normal_y, normal.normal_z);
-        Eigen::Vector3d V(pt.x, pt.y, pt.z);
-        Eigen::Vector3d C = N.cross(V);
-
-        // Check if we have a better correspondence
-        double dist = C.dot(C);
-        if (dist < min_dist) {
-          min_dist = dist;
-          min_index = static_cast<int>(j);
-        }
-      }
-      if (min_dist > max_distance)
-        continue;
-
-      // Check if the correspondence is reciprocal
-      target_idx = nn_indices[min_index];
-      tree_reciprocal_->nearestKSearch(
-          (*target_)[target_idx], 1, index_reciprocal, distance_reciprocal);
-
-      if (idx_i != index_reciprocal[0])
-        continue;
-
-      // Correspondence IS reciprocal, save it and continue
-      corr.index_query = idx_i;
-      corr.index_match = nn_indices[min_index];
-      corr.distance = nn_dists[min_index]; // min_dist;
-      correspondences[nr_valid_correspondences++] = corr;
-    }
-  }
-  correspondences.resize(nr_valid_correspondences);
+        return nr_valid_correspondences;
+      });
   deinitCompute();
 }
 
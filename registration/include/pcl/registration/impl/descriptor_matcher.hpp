@@ -0,0 +1,281 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef PCL_REGISTRATION_IMPL_DESCRIPTOR_MATCHER_HPP_
+#define PCL_REGISTRATION_IMPL_DESCRIPTOR_MATCHER_HPP_
+
+#include <pcl/common/distances.h>
+#include <pcl/common/execution_context.h>
+#include <pcl/console/print.h>
+
+#include <algorithm>
+
+namespace pcl {
+
+namespace registration {
+
+template <typename FeatureT>
+constexpr Eigen::Index DescriptorMatcher<FeatureT>::query_block_size_;
+
+template <typename FeatureT>
+constexpr Eigen::Index DescriptorMatcher<FeatureT>::target_block_size_;
+
+template <typename FeatureT>
+void
+DescriptorMatcher<FeatureT>::setNumberOfThreads(unsigned int nr_threads)
+{
+  // 0 is resolved against the budget of pcl::ExecutionContext at compute time
+  threads_ = nr_threads;
+}
+
+template <typename FeatureT>
+bool
+DescriptorMatcher<FeatureT>::initCompute(PackedDescriptors& source)
+{
+  if (!source_ || !target_) {
+    PCL_ERROR("[pcl::registration::%s::initCompute] No input source or target "
+              "descriptors given!\n",
+              getClassName().c_str());
+    return (false);
+  }
+
+  if (!target_packed_) {
+    pack(*target_, target_descriptors_);
+    target_packed_ = true;
+  }
+  pack(*source_, source);
+  return (true);
+}
+
+template <typename FeatureT>
+void
+DescriptorMatcher<FeatureT>::pack(const PointCloudFeature& cloud,
+                                  PackedDescriptors& packed) const
+{
+  const std::ptrdiff_t nr_points = static_cast<std::ptrdiff_t>(cloud.size());
+  const PointRepresentation<FeatureT>& representation = *point_representation_;
+
+  const pcl::ThreadReservation reservation(threads_);
+  const unsigned int threads = reservation.getNumberOfThreads();
+  std::vector<char> valid(cloud.size());
+#pragma omp parallel for default(none) shared(cloud, nr_points, representation, valid) \
+    num_threads(threads)
+  for (std::ptrdiff_t i = 0; i < nr_points; ++i)
+    valid[i] = representation.isValid(cloud[i]);
+
+  packed.indices.clear();
+  for (std::ptrdiff_t i = 0; i < nr_points; ++i)
+    if (valid[i])
+      packed.indices.push_back(static_cast<pcl::index_t>(i));
+
+  const std::ptrdiff_t nr_rows = static_cast<std::ptrdiff_t>(packed.indices.size());
+  const std::ptrdiff_t dim = representation.getNumberOfDimensions();
+  const bool trivial = representation.isTrivial();
+  packed.rows.resize(nr_rows, dim);
+  packed.squared_norms.resize(nr_rows);
+
+#pragma omp parallel for default(none)                                                 \
+    shared(cloud, dim, nr_rows, packed, representation, trivial) num_threads(threads)
+  for (std::ptrdiff_t row = 0; row < nr_rows; ++row) {
+    const FeatureT& descriptor = cloud[packed.indices[row]];
+    float* data = packed.rows.data() + row * dim;
+    if (trivial)
+      std::copy_n(reinterpret_cast<const float*>(&descriptor), dim, data);
+    else
+      representation.vectorize(descriptor, data);
+    packed.squared_norms[row] = packed.rows.row(row).squaredNorm();
+  }
+}
+
+template <typename FeatureT>
+void
+DescriptorMatcher<FeatureT>::searchKNearest(const PackedDescriptors& queries,
+                                            const PackedDescriptors& targets,
+                                            unsigned int k,
+                                            std::vector<float>& distances,
+                                            pcl::Indices& indices) const
+{
+  const Eigen::Index nr_queries = queries.rows.rows();
+  const Eigen::Index nr_targets = targets.rows.rows();
+  const std::size_t dim = static_cast<std::size_t>(queries.rows.cols());
+  distances.assign(nr_queries * k, std::numeric_limits<float>::max());
+  indices.assign(nr_queries * k, -1);
+
+  const Eigen::Index nr_blocks = (nr_queries + query_block_size_ - 1) / query_block_size_;
+  const pcl::ThreadReservation reservation(threads_);
+  const unsigned int threads = reservation.getNumberOfThreads();
+#pragma omp parallel for default(none)                                                 \
+    shared(dim, distances, indices, k, nr_blocks, nr_queries, nr_targets, queries,     \
+           targets) schedule(dynamic) num_threads(threads)
+  for (Eigen::Index block = 0; block < nr_blocks; ++block) {
+    const Eigen::Index query_begin = block * query_block_size_;
+    const Eigen::Index query_size =
+        std::min(query_block_size_, nr_queries - query_begin);
+
+    // Dot products of the block of queries with a block of targets, in one product
+    Matrix products;
+    for (Eigen::Index target_begin = 0; target_begin < nr_targets;
+         target_begin += target_block_size_) {
+      const Eigen::Index target_size =
+          std::min(target_block_size_, nr_targets - target_begin);
+      products.noalias() =
+          queries.rows.middleRows(query_begin, query_size) *
+          targets.rows.middleRows(target_begin, target_size).transpose();
+
+      for (Eigen::Index row = 0; row < query_size; ++row) {
+        const Eigen::Index query = query_begin + row;
+        const float query_norm = queries.squared_norms[query];
+        float* best_distances = &distances[query * k];
+        pcl::index_t* best_indices = &indices[query * k];
+        for (Eigen::Index col = 0; col < target_size; ++col) {
+          const float distance =
+              std::max(query_norm + targets.squared_norms[target_begin + col] -
+                           2.0f * products(row, col),
+                       0.0f);
+          if (distance >= best_distances[k - 1])
+            continue;
+          // insert into the sorted k best
+          unsigned int j = k - 1;
+          for (; j > 0 && best_distances[j - 1] > distance; --j) {
+            best_distances[j] = best_distances[j - 1];
+            best_indices[j] = best_indices[j - 1];
+          }
+          best_distances[j] = distance;
+          best_indices[j] = static_cast<pcl::index_t>(target_begin + col);
+        }
+      }
+    }
+
+    // Recompute the distances of the selected targets exactly, and sort them again
+    for (Eigen::Index query = query_begin; query < query_begin + query_size; ++query) {
+      float* best_distances = &distances[query * k];
+      pcl::index_t* best_indices = &indices[query * k];
+      for (unsigned int i = 0; i < k && best_indices[i] >= 0; ++i) {
+        const float distance =
+            pcl::squaredL2Distance(queries.rows.data() + query * dim,
+                                   targets.rows.data() + best_indices[i] * dim,
+                                   dim);
+        const pcl::index_t index = best_indices[i];
+        unsigned int j = i;
+        for (; j > 0 && best_distances[j - 1] > distance; --j) {
+          best_distances[j] = best_distances[j - 1];
+          best_indices[j] = best_indices[j - 1];
+        }
+        best_distances[j] = distance;
+        best_indices[j] = index;
+      }
+    }
+  }
+}
+
+template <typename FeatureT>
+void
+DescriptorMatcher<FeatureT>::determineCorrespondences(
+    pcl::Correspondences& correspondences, double max_distance)
+{
+  correspondences.clear();
+  PackedDescriptors source;
+  if (!initCompute(source))
+    return;
+
+  // the ratio test needs the second nearest neighbor
+  const bool ratio_test = ratio_ < 1.0f;
+  const unsigned int k = ratio_test ? 2 : 1;
+  std::vector<float> distances;
+  pcl::Indices rows;
+  searchKNearest(source, target_descriptors_, k, distances, rows);
+
+  std::vector<float> back_distances;
+  pcl::Indices back_rows;
+  if (cross_check_)
+    searchKNearest(target_descriptors_, source, 1, back_distances, back_rows);
+
+  const double max_dist_sqr = max_distance * max_distance;
+  const float ratio_sqr = ratio_ * ratio_;
+  const Eigen::Index nr_queries = source.rows.rows();
+  correspondences.reserve(nr_queries);
+  for (Eigen::Index query = 0; query < nr_queries; ++query) {
+    const pcl::index_t row = rows[query * k];
+    const float distance = distances[query * k];
+    if (row < 0 || distance > max_dist_sqr)
+      continue;
+    // without a second neighbor, the match is kept
+    if (ratio_test && rows[query * k + 1] >= 0 &&
+        !(distance < ratio_sqr * distances[query * k + 1]))
+      continue;
+    if (cross_check_ && back_rows[row] != static_cast<pcl::index_t>(query))
+      continue;
+    correspondences.emplace_back(
+        source.indices[query], target_descriptors_.indices[row], distance);
+  }
+}
+
+template <typename FeatureT>
+void
+DescriptorMatcher<FeatureT>::nearestKSearch(unsigned int k,
+                                            std::vector<pcl::Correspondences>& matches,
+                                            double max_distance)
+{
+  matches.clear();
+  PackedDescriptors source;
+  if (!initCompute(source) || k == 0)
+    return;
+  matches.resize(source_->size());
+
+  std::vector<float> distances;
+  pcl::Indices rows;
+  searchKNearest(source, target_descriptors_, k, distances, rows);
+
+  const double max_dist_sqr = max_distance * max_distance;
+  const Eigen::Index nr_queries = source.rows.rows();
+  for (Eigen::Index query = 0; query < nr_queries; ++query) {
+    pcl::Correspondences& query_matches = matches[source.indices[query]];
+    for (unsigned int i = 0; i < k; ++i) {
+      const pcl::index_t row = rows[query * k + i];
+      if (row < 0 || distances[query * k + i] > max_dist_sqr)
+        break;
+      query_matches.emplace_back(source.indices[query],
+                                 target_descriptors_.indices[row],
+                                 distances[query * k + i]);
+    }
+  }
+}
+
+} // namespace registration
+} // namespace pcl
+
+#endif /*PCL_REGISTRATION_IMPL_DESCRIPTOR_MATCHER_HPP_*/
@@ -41,6 +41,7 @@
 #ifndef PCL_REGISTRATION_IMPL_ELCH_H_
 #define PCL_REGISTRATION_IMPL_ELCH_H_
 
+#include <pcl/common/execution_context.h>
 #include <pcl/common/transforms.h>
 #include <pcl/registration/registration.h>
 
@@ -50,6 +51,15 @@
 #include <list>
 #include <tuple>
 
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT>
+void
+pcl::registration::ELCH<PointT>::setNumberOfThreads(unsigned int nr_threads)
+{
+  // 0 is resolved against the budget of pcl::ExecutionContext at compute time
+  threads_ = nr_threads;
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointT>
 void
@@ -231,10 +241,18 @@ pcl::registration::ELCH<PointT>::compute()
                j); // TODO add variance
   }
 
-  double* weights[4];
+  const pcl::ThreadReservation reservation(threads_);
+  const unsigned int threads = reservation.getNumberOfThreads();
+  // The four graphs (x, y, z and rotation) are balanced independently
+  int nr_vertices = static_cast<int>(num_vertices(*loop_graph_));
+  std::vector<double> weights[4];
+#pragma omp parallel for \
+  default(none) \
+  shared(grb, nr_vertices, weights) \
+  num_threads(std::min(threads, 4u))
   for (int i = 0; i < 4; i++) {
-    weights[i] = new double[num_vertices(*loop_graph_)];
-    loopOptimizerAlgorithm(grb[i], weights[i]);
+    weights[i].resize(nr_vertices);
+    loopOptimizerAlgorithm(grb[i], weights[i].data());
   }
 
   // TODO use pose
@@ -248,7 +266,12 @@ pcl::registration::ELCH<PointT>::compute()
   // typename boost::graph_traits<LoopGraph>::vertex_iterator vertex_it, vertex_it_end;
   // for (std::tie (vertex_it, vertex_it_end) = vertices (*loop_graph_); vertex_it !=
   // vertex_it_end; vertex_it++)
-  for (std::size_t i = 0; i < num_vertices(*loop_graph_); i++) {
+#pragma omp parallel for \
+  default(none) \
+  shared(nr_vertices, weights) \
+  schedule(dynamic) \
+  num_threads(threads)
+  for (int i = 0; i < nr_vertices; i++) {
     Eigen::Vector3f t2;
     t2[0] = loop_transform_(0, 3) * static_cast<float>(weights[0][i]);
     t2[1] = loop_transform_(1, 3) * static_cast<float>(weights[1][i]);
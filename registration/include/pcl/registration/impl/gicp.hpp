@@ -41,10 +41,20 @@
 #ifndef PCL_REGISTRATION_IMPL_GICP_HPP_
 #define PCL_REGISTRATION_IMPL_GICP_HPP_
 
+#include <pcl/common/execution_context.h>
 #include <pcl/registration/exceptions.h>
 
 namespace pcl {
 
+template <typename PointSource, typename PointTarget>
+void
+GeneralizedIterativeClosestPoint<PointSource, PointTarget>::setNumberOfThreads(
+    unsigned int nr_threads)
+{
+  // 0 is resolved against the budget of pcl::ExecutionContext at compute time
+  threads_ = nr_threads;
+}
+
 template <typename PointSource, typename PointTarget>
 template <typename PointT>
 void
@@ -61,7 +71,8 @@ GeneralizedIterativeClosestPoint<PointSource, PointTarget>::computeCovariances(
     return;
   }
 
-  Eigen::Vector3d mean;
+  const pcl::ThreadReservation reservation(threads_);
+  const unsigned int threads = reservation.getNumberOfThreads();
   pcl::Indices nn_indecies;
   nn_indecies.reserve(k_correspondences_);
   std::vector<float> nn_dist_sq;
@@ -71,14 +82,14 @@ GeneralizedIterativeClosestPoint<PointSource, PointTarget>::computeCovariances(
   if (cloud_covariances.size() < cloud->size())
     cloud_covariances.resize(cloud->size());
 
-  MatricesVector::iterator matrices_iterator = cloud_covariances.begin();
-  for (auto points_iterator = cloud->begin(); points_iterator != cloud->end();
-       ++points_iterator, ++matrices_iterator) {
-    const PointT& query_point = *points_iterator;
-    Eigen::Matrix3d& cov = *matrices_iterator;
+#pragma omp parallel for default(none) shared(cloud, kdtree, cloud_covariances)       \
+    firstprivate(nn_indecies, nn_dist_sq) num_threads(threads)
+  for (std::ptrdiff_t i = 0; i < static_cast<std::ptrdiff_t>(cloud->size()); ++i) {
+    const PointT& query_point = (*cloud)[i];
+    Eigen::Matrix3d& cov = cloud_covariances[i];
     // Zero out the cov and mean
     cov.setZero();
-    mean.setZero();
+    Eigen::Vector3d mean = Eigen::Vector3d::Zero();
 
     // Search for the K nearest neighbours
     kdtree->nearestKSearch(query_point, k_correspondences_, nn_indecies, nn_dist_sq);
@@ -256,31 +267,91 @@ GeneralizedIterativeClosestPoint<PointSource, PointTarget>::
 }
 
 template <typename PointSource, typename PointTarget>
-inline double
+void
 GeneralizedIterativeClosestPoint<PointSource, PointTarget>::
-    OptimizationFunctorWithIndices::operator()(const Vector6d& x)
+    OptimizationFunctorWithIndices::evaluate(const Vector6d& x,
+                                             double* f,
+                                             Vector6d* g) const
 {
   Eigen::Matrix4f transformation_matrix = gicp_->base_transformation_;
   gicp_->applyState(transformation_matrix, x);
-  double f = 0;
-  int m = static_cast<int>(gicp_->tmp_idx_src_->size());
-  for (int i = 0; i < m; ++i) {
-    // The last coordinate, p_src[3] is guaranteed to be set to 1.0 in registration.hpp
-    Vector4fMapConst p_src =
-        (*gicp_->tmp_src_)[(*gicp_->tmp_idx_src_)[i]].getVector4fMap();
-    // The last coordinate, p_tgt[3] is guaranteed to be set to 1.0 in registration.hpp
-    Vector4fMapConst p_tgt =
-        (*gicp_->tmp_tgt_)[(*gicp_->tmp_idx_tgt_)[i]].getVector4fMap();
-    Eigen::Vector4f pp(transformation_matrix * p_src);
-    // Estimate the distance (cost function)
-    // The last coordinate is still guaranteed to be set to 1.0
-    Eigen::Vector3d res(pp[0] - p_tgt[0], pp[1] - p_tgt[1], pp[2] - p_tgt[2]);
-    Eigen::Vector3d temp(gicp_->mahalanobis((*gicp_->tmp_idx_src_)[i]) * res);
-    // increment= res'*temp/num_matches = temp'*M*temp/num_matches (we postpone
-    // 1/num_matches after the loop closes)
-    f += double(res.transpose() * temp);
+  const int m = static_cast<int>(gicp_->tmp_idx_src_->size());
+
+  // The correspondences are reduced in blocks of fixed size, so the summation order
+  // and therefore the result do not depend on the number of threads
+  int block_size = 256;
+  int nr_blocks = (m + block_size - 1) / block_size;
+  bool compute_f = (f != nullptr);
+  bool compute_g = (g != nullptr);
+  std::vector<double> block_f(nr_blocks, 0.);
+  std::vector<Eigen::Vector3d> block_g(nr_blocks, Eigen::Vector3d::Zero());
+  std::vector<Eigen::Matrix3d> block_R(nr_blocks, Eigen::Matrix3d::Zero());
+
+  const pcl::ThreadReservation reservation(gicp_->threads_);
+  const unsigned int threads = reservation.getNumberOfThreads();
+#pragma omp parallel for default(none)                                                 \
+    shared(transformation_matrix, m, block_size, nr_blocks, compute_f, compute_g,      \
+           block_f, block_g, block_R) num_threads(threads)
+  for (int block = 0; block < nr_blocks; ++block) {
+    const int end = std::min(m, (block + 1) * block_size);
+    for (int i = block * block_size; i < end; ++i) {
+      // The last coordinate, p_src[3] is guaranteed to be set to 1.0 in
+      // registration.hpp
+      Vector4fMapConst p_src =
+          (*gicp_->tmp_src_)[(*gicp_->tmp_idx_src_)[i]].getVector4fMap();
+      // The last coordinate, p_tgt[3] is guaranteed to be set to 1.0 in
+      // registration.hpp
+      Vector4fMapConst p_tgt =
+          (*gicp_->tmp_tgt_)[(*gicp_->tmp_idx_tgt_)[i]].getVector4fMap();
+      Eigen::Vector4f pp(transformation_matrix * p_src);
+      // The last coordinate is still guaranteed to be set to 1.0
+      Eigen::Vector3d res(pp[0] - p_tgt[0], pp[1] - p_tgt[1], pp[2] - p_tgt[2]);
+      // temp = M*res
+      Eigen::Vector3d temp(gicp_->mahalanobis((*gicp_->tmp_idx_src_)[i]) * res);
+      // Increment total error: res'*temp/num_matches = temp'*M*temp/num_matches (we
+      // postpone 1/num_matches after the loop closes)
+      if (compute_f)
+        block_f[block] += double(res.transpose() * temp);
+      if (compute_g) {
+        // Increment translation gradient
+        // g.head<3> ()+= 2*M*res/num_matches (we postpone 2/num_matches after the
+        // loop closes)
+        block_g[block] += temp;
+        // Increment rotation gradient
+        pp = gicp_->base_transformation_ * p_src;
+        Eigen::Vector3d p_src3(pp[0], pp[1], pp[2]);
+        block_R[block] += p_src3 * temp.transpose();
+      }
+    }
+  }
+
+  if (compute_f) {
+    *f = 0;
+    for (const double& partial : block_f)
+      *f += partial;
+    *f /= double(m);
+  }
+  if (compute_g) {
+    g->setZero();
+    Eigen::Matrix3d R = Eigen::Matrix3d::Zero();
+    for (int block = 0; block < nr_blocks; ++block) {
+      g->head<3>() += block_g[block];
+      R += block_R[block];
+    }
+    g->head<3>() *= double(2.0 / m);
+    R *= 2.0 / m;
+    gicp_->computeRDerivative(x, R, *g);
   }
-  return f / m;
+}
+
+template <typename PointSource, typename PointTarget>
+inline double
+GeneralizedIterativeClosestPoint<PointSource, PointTarget>::
+    OptimizationFunctorWithIndices::operator()(const Vector6d& x)
+{
+  double f = 0;
+  evaluate(x, &f, nullptr);
+  return f;
 }
 
 template <typename PointSource, typename PointTarget>
@@ -288,38 +359,7 @@ inline void
 GeneralizedIterativeClosestPoint<PointSource, PointTarget>::
     OptimizationFunctorWithIndices::df(const Vector6d& x, Vector6d& g)
 {
-  Eigen::Matrix4f transformation_matrix = gicp_->base_transformation_;
-  gicp_->applyState(transformation_matrix, x);
-  // Zero out g
-  g.setZero();
-  // Eigen::Vector3d g_t = g.head<3> ();
-  Eigen::Matrix3d R = Eigen::Matrix3d::Zero();
-  int m = static_cast<int>(gicp_->tmp_idx_src_->size());
-  for (int i = 0; i < m; ++i) {
-    // The last coordinate, p_src[3] is guaranteed to be set to 1.0 in registration.hpp
-    Vector4fMapConst p_src =
-        (*gicp_->tmp_src_)[(*gicp_->tmp_idx_src_)[i]].getVector4fMap();
-    // The last coordinate, p_tgt[3] is guaranteed to be set to 1.0 in registration.hpp
-    Vector4fMapConst p_tgt =
-        (*gicp_->tmp_tgt_)[(*gicp_->tmp_idx_tgt_)[i]].getVector4fMap();
-
-    Eigen::Vector4f pp(transformation_matrix * p_src);
-    // The last coordinate is still guaranteed to be set to 1.0
-    Eigen::Vector3d res(pp[0] - p_tgt[0], pp[1] - p_tgt[1], pp[2] - p_tgt[2]);
-    // temp = M*res
-    Eigen::Vector3d temp(gicp_->mahalanobis((*gicp_->tmp_idx_src_)[i]) * res);
-    // Increment translation gradient
-    // g.head<3> ()+= 2*M*res/num_matches (we postpone 2/num_matches after the loop
-    // closes)
-    g.head<3>() += temp;
-    // Increment rotation gradient
-    pp = gicp_->base_transformation_ * p_src;
-    Eigen::Vector3d p_src3(pp[0], pp[1], pp[2]);
-    R += p_src3 * temp.transpose();
-  }
-  g.head<3>() *= 2.0 / m;
-  R *= 2.0 / m;
-  gicp_->computeRDerivative(x, R, g);
+  evaluate(x, nullptr, &g);
 }
 
 template <typename PointSource, typename PointTarget>
@@ -327,39 +367,7 @@ inline void
 GeneralizedIterativeClosestPoint<PointSource, PointTarget>::
     OptimizationFunctorWithIndices::fdf(const Vector6d& x, double& f, Vector6d& g)
 {
-  Eigen::Matrix4f transformation_matrix = gicp_->base_transformation_;
-  gicp_->applyState(transformation_matrix, x);
-  f = 0;
-  g.setZero();
-  Eigen::Matrix3d R = Eigen::Matrix3d::Zero();
-  const int m = static_cast<int>(gicp_->tmp_idx_src_->size());
-  for (int i = 0; i < m; ++i) {
-    // The last coordinate, p_src[3] is guaranteed to be set to 1.0 in registration.hpp
-    Vector4fMapConst p_src =
-        (*gicp_->tmp_src_)[(*gicp_->tmp_idx_src_)[i]].getVector4fMap();
-    // The last coordinate, p_tgt[3] is guaranteed to be set to 1.0 in registration.hpp
-    Vector4fMapConst p_tgt =
-        (*gicp_->tmp_tgt_)[(*gicp_->tmp_idx_tgt_)[i]].getVector4fMap();
-    Eigen::Vector4f pp(transformation_matrix * p_src);
-    // The last coordinate is still guaranteed to be set to 1.0
-    Eigen::Vector3d res(pp[0] - p_tgt[0], pp[1] - p_tgt[1], pp[2] - p_tgt[2]);
-    // temp = M*res
-    Eigen::Vector3d temp(gicp_->mahalanobis((*gicp_->tmp_idx_src_)[i]) * res);
-    // Increment total error
-    f += double(res.transpose() * temp);
-    // Increment translation gradient
-    // g.head<3> ()+= 2*M*res/num_matches (we postpone 2/num_matches after the loop
-    // closes)
-    g.head<3>() += temp;
-    pp = gicp_->base_transformation_ * p_src;
-    Eigen::Vector3d p_src3(pp[0], pp[1], pp[2]);
-    // Increment rotation gradient
-    R += p_src3 * temp.transpose();
-  }
-  f /= double(m);
-  g.head<3>() *= double(2.0 / m);
-  R *= 2.0 / m;
-  gicp_->computeRDerivative(x, R, g);
+  evaluate(x, &f, &g);
 }
 
 template <typename PointSource, typename PointTarget>
@@ -391,10 +399,13 @@ GeneralizedIterativeClosestPoint<PointSource, PointTarget>::computeTransformatio
     PointCloudSource& output, const Eigen::Matrix4f& guess)
 {
   pcl::IterativeClosestPoint<PointSource, PointTarget>::initComputeReciprocal();
+  // The covariances and the optimizer share this reservation
+  const pcl::ThreadReservation reservation(threads_);
+  const unsigned int threads = reservation.getNumberOfThreads();
   // Difference between consecutive transforms
   double delta = 0;
   // Get the size of the target
-  const std::size_t N = indices_->size();
+  std::size_t N = indices_->size();
   // Set the mahalanobis matrices to identity
   mahalanobis_.resize(N, Eigen::Matrix3d::Identity());
   // Compute target cloud covariance matrices
@@ -414,6 +425,7 @@ GeneralizedIterativeClosestPoint<PointSource, PointTarget>::computeTransformatio
   double dist_threshold = corr_dist_threshold_ * corr_dist_threshold_;
   pcl::Indices nn_indices(1);
   std::vector<float> nn_dists(1);
+  std::vector<index_t> target_match;
 
   pcl::transformPointCloud(output, output, guess);
 
@@ -431,16 +443,21 @@ GeneralizedIterativeClosestPoint<PointSource, PointTarget>::computeTransformatio
 
     Eigen::Matrix3d R = transform_R.topLeftCorner<3, 3>();
 
-    for (std::size_t i = 0; i < N; i++) {
+    // Search the correspondences and update the Mahalanobis matrices in parallel, then
+    // gather the valid ones in index order
+    target_match.assign(N, -1);
+    int failed_index = -1;
+#pragma omp parallel for default(none)                                                 \
+    shared(output, R, dist_threshold, target_match, failed_index, N)                   \
+    firstprivate(nn_indices, nn_dists) num_threads(threads)
+    for (std::ptrdiff_t i = 0; i < static_cast<std::ptrdiff_t>(N); i++) {
       PointSource query = output[i];
       query.getVector4fMap() = transformation_ * query.getVector4fMap();
 
       if (!searchForNeighbors(query, nn_indices, nn_dists)) {
-        PCL_ERROR("[pcl::%s::computeTransformation] Unable to find a nearest neighbor "
-                  "in the target dataset for point %d in the source!\n",
-                  getClassName().c_str(),
-                  (*indices_)[i]);
-        return;
+#pragma omp critical(gicp_failed_index)
+        failed_index = (*indices_)[i];
+        continue;
       }
 
       // Check if the distance to the nearest neighbor is smaller than the user imposed
@@ -456,11 +473,23 @@ GeneralizedIterativeClosestPoint<PointSource, PointTarget>::computeTransformatio
         temp += C2;
         // M = temp^-1
         M = temp.inverse();
-        source_indices[cnt] = static_cast<int>(i);
-        target_indices[cnt] = nn_indices[0];
-        cnt++;
+        target_match[i] = nn_indices[0];
       }
     }
+    if (failed_index >= 0) {
+      PCL_ERROR("[pcl::%s::computeTransformation] Unable to find a nearest neighbor "
+                "in the target dataset for point %d in the source!\n",
+                getClassName().c_str(),
+                failed_index);
+      return;
+    }
+    for (std::size_t i = 0; i < N; i++) {
+      if (target_match[i] < 0)
+        continue;
+      source_indices[cnt] = static_cast<int>(i);
+      target_indices[cnt] = target_match[i];
+      cnt++;
+    }
     // Resize to the actual number of valid correspondences
     source_indices.resize(cnt);
     target_indices.resize(cnt);
@@ -39,12 +39,16 @@
 #define PCL_REGISTRATION_IMPL_IA_FPCS_H_
 
 #include <pcl/common/distances.h>
+#include <pcl/common/execution_context.h>
 #include <pcl/common/time.h>
 #include <pcl/common/utils.h>
 #include <pcl/registration/ia_fpcs.h>
 #include <pcl/registration/transformation_estimation_3point.h>
 #include <pcl/sample_consensus/sac_model_plane.h>
 
+#include <algorithm>
+#include <limits>
+
 ///////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointT>
 inline float
@@ -63,14 +67,17 @@ pcl::getMeanPointDensity(const typename pcl::PointCloud<PointT>::ConstPtr& cloud
   pcl::Indices ids(2);
   std::vector<float> dists_sqr(2);
 
-  pcl::utils::ignore(nr_threads);
+  const pcl::ThreadReservation reservation(
+      static_cast<unsigned int>(std::max(nr_threads, 0)));
+  const unsigned int threads = reservation.getNumberOfThreads();
+  pcl::utils::ignore(threads);
 #pragma omp parallel for \
   default(none) \
   shared(tree, cloud) \
   firstprivate(ids, dists_sqr) \
   reduction(+:mean_dist, num) \
   firstprivate(s, max_dist_sqr) \
-  num_threads(nr_threads)
+  num_threads(threads)
   for (int i = 0; i < 1000; i++) {
     tree.nearestKSearch((*cloud)[rand() % s], 2, ids, dists_sqr);
     if (dists_sqr[1] < max_dist_sqr) {
@@ -101,21 +108,24 @@ pcl::getMeanPointDensity(const typename pcl::PointCloud<PointT>::ConstPtr& cloud
   pcl::Indices ids(2);
   std::vector<float> dists_sqr(2);
 
-  pcl::utils::ignore(nr_threads);
+  const pcl::ThreadReservation reservation(
+      static_cast<unsigned int>(std::max(nr_threads, 0)));
+  const unsigned int threads = reservation.getNumberOfThreads();
+  pcl::utils::ignore(threads);
 #if OPENMP_LEGACY_CONST_DATA_SHARING_RULE
 #pragma omp parallel for \
   default(none) \
   shared(tree, cloud, indices) \
   firstprivate(ids, dists_sqr) \
   reduction(+:mean_dist, num) \
-  num_threads(nr_threads)
+  num_threads(threads)
 #else
 #pragma omp parallel for \
   default(none) \
   shared(tree, cloud, indices, s, max_dist_sqr) \
   firstprivate(ids, dists_sqr) \
   reduction(+:mean_dist, num) \
-  num_threads(nr_threads)
+  num_threads(threads)
 #endif
   for (int i = 0; i < 1000; i++) {
     tree.nearestKSearch((*cloud)[indices[rand() % s]], 2, ids, dists_sqr);
@@ -166,6 +176,10 @@ void
 pcl::registration::FPCSInitialAlignment<PointSource, PointTarget, NormalT, Scalar>::
     computeTransformation(PointCloudSource& output, const Eigen::Matrix4f& guess)
 {
+  // The mean point density in initCompute shares this reservation
+  const pcl::ThreadReservation reservation(
+      static_cast<unsigned int>(std::max(nr_threads_, 0)));
+  const unsigned int threads = reservation.getNumberOfThreads();
   if (!initCompute())
     return;
 
@@ -175,7 +189,7 @@ pcl::registration::FPCSInitialAlignment<PointSource, PointTarget, NormalT, Scala
   pcl::StopWatch timer;
 
 #pragma omp parallel default(none) shared(abort, all_candidates, timer)                \
-    num_threads(nr_threads_)
+    num_threads(threads)
   {
 #ifdef _OPENMP
     const unsigned int seed =
@@ -286,6 +300,7 @@ pcl::registration::FPCSInitialAlignment<PointSource, PointTarget, NormalT, Scala
     tree_->setInputCloud(target_, target_indices_);
     target_cloud_updated_ = false;
   }
+  buildSourcePairTree();
 
   // set predefined variables
   const int min_iterations = 4;
@@ -578,8 +593,6 @@ int
 pcl::registration::FPCSInitialAlignment<PointSource, PointTarget, NormalT, Scalar>::
     bruteForceCorrespondences(int idx1, int idx2, pcl::Correspondences& pairs)
 {
-  const float max_norm_diff = 0.5f * max_norm_diff_ * M_PI / 180.f;
-
   // calculate reference segment distance and normal angle
   float ref_dist = pcl::euclideanDistance((*target_)[idx1], (*target_)[idx2]);
   float ref_norm_angle =
@@ -588,22 +601,129 @@ pcl::registration::FPCSInitialAlignment<PointSource, PointTarget, NormalT, Scala
                           .norm()
                     : 0.f);
 
-  // loop over all pairs of points in source point cloud
-  auto it_out = source_indices_->begin(), it_out_e = source_indices_->end() - 1;
-  auto it_in_e = source_indices_->end();
-  for (; it_out != it_out_e; it_out++) {
-    auto it_in = it_out + 1;
-    const PointSource* pt1 = &(*input_)[*it_out];
-    for (; it_in != it_in_e; it_in++) {
-      const PointSource* pt2 = &(*input_)[*it_in];
+  // traverse all pairs of nodes of the source pair tree, starting at the root
+  if (!source_pair_nodes_.empty())
+    collectPairs(0, 0, ref_dist, ref_norm_angle, pairs);
+
+  // return success if at least one correspondence was found
+  return (pairs.empty() ? -1 : 0);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointSource, typename PointTarget, typename NormalT, typename Scalar>
+void
+pcl::registration::FPCSInitialAlignment<PointSource, PointTarget, NormalT, Scalar>::
+    buildSourcePairTree()
+{
+  const int max_leaf_size = 16;
+
+  source_pair_nodes_.clear();
+  source_pair_indices_.assign(source_indices_->begin(), source_indices_->end());
+  if (source_pair_indices_.empty())
+    return;
+
+  // split the nodes at the median of their largest extent until they are small enough
+  std::vector<int> stack(1, 0);
+  source_pair_nodes_.push_back(
+      {Eigen::Vector3f::Zero(),
+       Eigen::Vector3f::Zero(),
+       0,
+       static_cast<int>(source_pair_indices_.size()),
+       -1,
+       -1});
+  while (!stack.empty()) {
+    const int node_index = stack.back();
+    stack.pop_back();
+
+    SourcePairNode node = source_pair_nodes_[node_index];
+    node.min_pt.setConstant(std::numeric_limits<float>::max());
+    node.max_pt.setConstant(std::numeric_limits<float>::lowest());
+    for (int i = node.begin; i < node.end; ++i) {
+      const Eigen::Vector3f pt = (*input_)[source_pair_indices_[i]].getVector3fMap();
+      node.min_pt = node.min_pt.cwiseMin(pt);
+      node.max_pt = node.max_pt.cwiseMax(pt);
+    }
+
+    if (node.end - node.begin > max_leaf_size) {
+      int axis;
+      (node.max_pt - node.min_pt).maxCoeff(&axis);
+      const int middle = (node.begin + node.end) / 2;
+      std::nth_element(source_pair_indices_.begin() + node.begin,
+                       source_pair_indices_.begin() + middle,
+                       source_pair_indices_.begin() + node.end,
+                       [this, axis](index_t a, index_t b) {
+                         return ((*input_)[a].data[axis] < (*input_)[b].data[axis]);
+                       });
+
+      node.left = static_cast<int>(source_pair_nodes_.size());
+      node.right = node.left + 1;
+      source_pair_nodes_.push_back({node.min_pt, node.max_pt, node.begin, middle, -1, -1});
+      source_pair_nodes_.push_back({node.min_pt, node.max_pt, middle, node.end, -1, -1});
+      stack.push_back(node.left);
+      stack.push_back(node.right);
+    }
+    source_pair_nodes_[node_index] = node;
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointSource, typename PointTarget, typename NormalT, typename Scalar>
+void
+pcl::registration::FPCSInitialAlignment<PointSource, PointTarget, NormalT, Scalar>::
+    collectPairs(int node_a,
+                 int node_b,
+                 float ref_dist,
+                 float ref_norm_angle,
+                 pcl::Correspondences& pairs) const
+{
+  const SourcePairNode& a = source_pair_nodes_[node_a];
+  const SourcePairNode& b = source_pair_nodes_[node_b];
+
+  // skip the node pair if the range of distances between its bounding boxes does not
+  // reach the shell around ref_dist (with a small slack for rounding errors)
+  const Eigen::Vector3f gap =
+      (a.min_pt - b.max_pt).cwiseMax(b.min_pt - a.max_pt).cwiseMax(0.f);
+  const Eigen::Vector3f span =
+      (a.max_pt - b.min_pt).cwiseAbs().cwiseMax((b.max_pt - a.min_pt).cwiseAbs());
+  const float slack = 1e-5f * (ref_dist + max_pair_diff_);
+  if (gap.norm() > ref_dist + max_pair_diff_ + slack ||
+      span.norm() < ref_dist - max_pair_diff_ - slack)
+    return;
+
+  const bool a_leaf = (a.left < 0), b_leaf = (b.left < 0);
+  if (node_a == node_b && !a_leaf) {
+    collectPairs(a.left, a.left, ref_dist, ref_norm_angle, pairs);
+    collectPairs(a.left, a.right, ref_dist, ref_norm_angle, pairs);
+    collectPairs(a.right, a.right, ref_dist, ref_norm_angle, pairs);
+    return;
+  }
+  if (!a_leaf && (b_leaf || a.end - a.begin >= b.end - b.begin)) {
+    collectPairs(a.left, node_b, ref_dist, ref_norm_angle, pairs);
+    collectPairs(a.right, node_b, ref_dist, ref_norm_angle, pairs);
+    return;
+  }
+  if (!b_leaf) {
+    collectPairs(node_a, b.left, ref_dist, ref_norm_angle, pairs);
+    collectPairs(node_a, b.right, ref_dist, ref_norm_angle, pairs);
+    return;
+  }
+
+  // both nodes are leaves, test their point pairs
+  const float max_norm_diff = 0.5f * max_norm_diff_ * M_PI / 180.f;
+  for (int i = a.begin; i < a.end; ++i) {
+    const index_t index_1 = source_pair_indices_[i];
+    const PointSource* pt1 = &(*input_)[index_1];
+    for (int j = (node_a == node_b ? i + 1 : b.begin); j < b.end; ++j) {
+      const index_t index_2 = source_pair_indices_[j];
+      const PointSource* pt2 = &(*input_)[index_2];
 
       // check point distance compared to reference dist (from base)
       float dist = pcl::euclideanDistance(*pt1, *pt2);
       if (std::abs(dist - ref_dist) < max_pair_diff_) {
         // add here normal evaluation if normals are given
         if (use_normals_) {
-          const NormalT* pt1_n = &((*source_normals_)[*it_out]);
-          const NormalT* pt2_n = &((*source_normals_)[*it_in]);
+          const NormalT* pt1_n = &((*source_normals_)[index_1]);
+          const NormalT* pt2_n = &((*source_normals_)[index_2]);
 
           float norm_angle_1 =
               (pt1_n->getNormalVector3fMap() - pt2_n->getNormalVector3fMap()).norm();
@@ -616,14 +736,11 @@ pcl::registration::FPCSInitialAlignment<PointSource, PointTarget, NormalT, Scala
             continue;
         }
 
-        pairs.push_back(pcl::Correspondence(*it_in, *it_out, dist));
-        pairs.push_back(pcl::Correspondence(*it_out, *it_in, dist));
+        pairs.push_back(pcl::Correspondence(index_2, index_1, dist));
+        pairs.push_back(pcl::Correspondence(index_1, index_2, dist));
       }
     }
   }
-
-  // return success if at least one correspondence was found
-  return (pairs.empty() ? -1 : 0);
 }
 
 ///////////////////////////////////////////////////////////////////////////////////////////
@@ -42,6 +42,17 @@
 #define IA_RANSAC_HPP_
 
 #include <pcl/common/distances.h>
+#include <pcl/common/execution_context.h>
+#include <pcl/common/transforms.h>
+
+#include <algorithm>
+#include <atomic>
+#include <numeric>
+#include <random>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 namespace pcl {
 
@@ -74,6 +85,26 @@ SampleConsensusInitialAlignment<PointSource, PointTarget, FeatureT>::setTargetFe
   feature_tree_->setInputCloud(target_features_);
 }
 
+template <typename PointSource, typename PointTarget, typename FeatureT>
+void
+SampleConsensusInitialAlignment<PointSource, PointTarget, FeatureT>::setNumberOfThreads(
+    unsigned int nr_threads)
+{
+#ifdef _OPENMP
+  // 0 is resolved against the budget of pcl::ExecutionContext at compute time
+  threads_ = nr_threads;
+  PCL_DEBUG("[pcl::%s::setNumberOfThreads] Setting number of threads to %u.\n",
+            getClassName().c_str(),
+            threads_);
+#else
+  threads_ = 1;
+  if (nr_threads != 1)
+    PCL_WARN("[pcl::%s::setNumberOfThreads] Parallelization is requested, but OpenMP "
+             "is not available! Continuing without parallelization.\n",
+             getClassName().c_str());
+#endif // _OPENMP
+}
+
 template <typename PointSource, typename PointTarget, typename FeatureT>
 void
 SampleConsensusInitialAlignment<PointSource, PointTarget, FeatureT>::selectSamples(
@@ -81,6 +112,24 @@ SampleConsensusInitialAlignment<PointSource, PointTarget, FeatureT>::selectSampl
     unsigned int nr_samples,
     float min_sample_distance,
     pcl::Indices& sample_indices)
+{
+  const auto random_index = [this](int n) { return getRandomIndex(n); };
+  float relaxed_sample_distance = min_sample_distance;
+  selectSamples(
+      cloud, nr_samples, relaxed_sample_distance, sample_indices, random_index);
+  if (relaxed_sample_distance < min_sample_distance)
+    min_sample_distance_ = relaxed_sample_distance;
+}
+
+template <typename PointSource, typename PointTarget, typename FeatureT>
+template <typename RandomIndexFunctor>
+void
+SampleConsensusInitialAlignment<PointSource, PointTarget, FeatureT>::selectSamples(
+    const PointCloudSource& cloud,
+    unsigned int nr_samples,
+    float& min_sample_distance,
+    pcl::Indices& sample_indices,
+    const RandomIndexFunctor& random_index) const
 {
   if (nr_samples > cloud.size()) {
     PCL_ERROR("[pcl::%s::selectSamples] ", getClassName().c_str());
@@ -97,7 +146,7 @@ SampleConsensusInitialAlignment<PointSource, PointTarget, FeatureT>::selectSampl
   sample_indices.clear();
   while (sample_indices.size() < nr_samples) {
     // Choose a sample at random
-    const auto sample_index = getRandomIndex(cloud.size());
+    const pcl::index_t sample_index = random_index(static_cast<int>(cloud.size()));
 
     // Check to see if the sample is 1) unique and 2) far away from the other samples
     bool valid_sample = true;
@@ -129,8 +178,7 @@ SampleConsensusInitialAlignment<PointSource, PointTarget, FeatureT>::selectSampl
                static_cast<std::size_t>(iterations_without_a_sample),
                0.5 * min_sample_distance);
 
-      min_sample_distance_ *= 0.5f;
-      min_sample_distance = min_sample_distance_;
+      min_sample_distance *= 0.5f;
       iterations_without_a_sample = 0;
     }
   }
@@ -142,6 +190,20 @@ SampleConsensusInitialAlignment<PointSource, PointTarget, FeatureT>::
     findSimilarFeatures(const FeatureCloud& input_features,
                         const pcl::Indices& sample_indices,
                         pcl::Indices& corresponding_indices)
+{
+  const auto random_index = [this](int n) { return getRandomIndex(n); };
+  findSimilarFeatures(
+      input_features, sample_indices, corresponding_indices, random_index);
+}
+
+template <typename PointSource, typename PointTarget, typename FeatureT>
+template <typename RandomIndexFunctor>
+void
+SampleConsensusInitialAlignment<PointSource, PointTarget, FeatureT>::
+    findSimilarFeatures(const FeatureCloud& input_features,
+                        const pcl::Indices& sample_indices,
+                        pcl::Indices& corresponding_indices,
+                        const RandomIndexFunctor& random_index) const
 {
   pcl::Indices nn_indices(k_correspondences_);
   std::vector<float> nn_distances(k_correspondences_);
@@ -156,7 +218,7 @@ SampleConsensusInitialAlignment<PointSource, PointTarget, FeatureT>::
                                   nn_distances);
 
     // Select one at random and add it to corresponding_indices
-    const auto random_correspondence = getRandomIndex(k_correspondences_);
+    const pcl::index_t random_correspondence = random_index(k_correspondences_);
     corresponding_indices[i] = nn_indices[random_correspondence];
   }
 }
@@ -183,6 +245,35 @@ SampleConsensusInitialAlignment<PointSource, PointTarget, FeatureT>::computeErro
   return (error);
 }
 
+template <typename PointSource, typename PointTarget, typename FeatureT>
+bool
+SampleConsensusInitialAlignment<PointSource, PointTarget, FeatureT>::computeErrorMetric(
+    const Eigen::Matrix4f& transformation,
+    const pcl::Indices& evaluation_order,
+    float max_error,
+    float& error) const
+{
+  pcl::Indices nn_index(1);
+  std::vector<float> nn_distance(1);
+
+  const ErrorFunctor& compute_error = *error_functor_;
+  const Eigen::Affine3f transform(transformation);
+  error = 0;
+
+  for (const auto& idx : evaluation_order) {
+    // Find the distance between the transformed point and its nearest neighbor in the
+    // target point cloud
+    tree_->nearestKSearch(
+        pcl::transformPoint((*input_)[idx], transform), 1, nn_index, nn_distance);
+
+    // Compute the error, the partial sum only grows so stop once it exceeds the bound
+    error += compute_error(nn_distance[0]);
+    if (error > max_error)
+      return (false);
+  }
+  return (true);
+}
+
 template <typename PointSource, typename PointTarget, typename FeatureT>
 void
 SampleConsensusInitialAlignment<PointSource, PointTarget, FeatureT>::
@@ -223,10 +314,8 @@ SampleConsensusInitialAlignment<PointSource, PointTarget, FeatureT>::
   if (!error_functor_)
     error_functor_.reset(new TruncatedError(static_cast<float>(corr_dist_threshold_)));
 
-  pcl::Indices sample_indices(nr_samples_);
-  pcl::Indices corresponding_indices(nr_samples_);
   PointCloudSource input_transformed;
-  float lowest_error(0);
+  float lowest_error = std::numeric_limits<float>::max();
 
   final_transformation_ = guess;
   int i_iter = 0;
@@ -239,30 +328,112 @@ SampleConsensusInitialAlignment<PointSource, PointTarget, FeatureT>::
     i_iter = 1;
   }
 
-  for (; i_iter < max_iterations_; ++i_iter) {
-    // Draw nr_samples_ random samples
-    selectSamples(*input_, nr_samples_, min_sample_distance_, sample_indices);
-
-    // Find corresponding features in the target cloud
-    findSimilarFeatures(*input_features_, sample_indices, corresponding_indices);
-
-    // Estimate the transform from the samples to their corresponding points
-    transformation_estimation_->estimateRigidTransformation(
-        *input_, sample_indices, *target_, corresponding_indices, transformation_);
-
-    // Transform the data and compute the error
-    transformPointCloud(*input_, input_transformed, transformation_);
-    float error =
-        computeErrorMetric(input_transformed, static_cast<float>(corr_dist_threshold_));
+  // Score the input points in a fixed random order, so that a bad hypothesis exceeds
+  // the error bound after only a few points
+  pcl::Indices evaluation_order(input_->size());
+  std::iota(evaluation_order.begin(), evaluation_order.end(), 0);
+  std::shuffle(evaluation_order.begin(), evaluation_order.end(), std::mt19937());
+
+  // With several threads every thread draws from its own random stream. The seeds come
+  // from std::rand, a single thread keeps drawing from std::rand directly.
+  const pcl::ThreadReservation reservation(threads_);
+  const int nr_threads = static_cast<int>(reservation.getNumberOfThreads());
+  std::vector<unsigned int> seeds(nr_threads);
+  if (nr_threads > 1)
+    for (auto& seed : seeds)
+      seed = static_cast<unsigned int>(std::rand());
+
+  // The lowest error found so far is shared by all threads as the early exit bound,
+  // the best hypothesis of each thread is kept apart and reduced afterwards
+  std::atomic<float> error_bound(lowest_error);
+  std::vector<float> thread_error(nr_threads, lowest_error);
+  std::vector<int> thread_iteration(nr_threads, -1);
+  std::vector<Eigen::Matrix4f, Eigen::aligned_allocator<Eigen::Matrix4f>>
+      thread_transformation(nr_threads, final_transformation_);
+  std::vector<float> thread_min_sample_distance(nr_threads, min_sample_distance_);
+
+#pragma omp parallel default(none)                                                     \
+    shared(i_iter,                                                                     \
+           nr_threads,                                                                 \
+           evaluation_order,                                                           \
+           seeds,                                                                      \
+           error_bound,                                                                \
+           thread_error,                                                               \
+           thread_iteration,                                                           \
+           thread_transformation,                                                      \
+           thread_min_sample_distance) num_threads(nr_threads)
+  {
+#ifdef _OPENMP
+    const int thread_id = omp_get_thread_num();
+#else
+    const int thread_id = 0;
+#endif
+    std::mt19937 rng(seeds[thread_id]);
+    const auto random_index = [&](int n) -> pcl::index_t {
+      if (nr_threads == 1)
+        return getRandomIndex(n);
+      return std::uniform_int_distribution<pcl::index_t>(0, n - 1)(rng);
+    };
+
+    pcl::Indices sample_indices(nr_samples_);
+    pcl::Indices corresponding_indices(nr_samples_);
+    Eigen::Matrix4f transformation;
+
+#pragma omp for schedule(static)
+    for (int iteration = i_iter; iteration < max_iterations_; ++iteration) {
+      // Draw nr_samples_ random samples
+      selectSamples(*input_,
+                    nr_samples_,
+                    thread_min_sample_distance[thread_id],
+                    sample_indices,
+                    random_index);
+
+      // Find corresponding features in the target cloud
+      findSimilarFeatures(
+          *input_features_, sample_indices, corresponding_indices, random_index);
+
+      // Estimate the transform from the samples to their corresponding points
+      transformation_estimation_->estimateRigidTransformation(
+          *input_, sample_indices, *target_, corresponding_indices, transformation);
+
+      // Compute the error, giving up once it exceeds the lowest error found so far
+      float error;
+      if (!computeErrorMetric(
+              transformation, evaluation_order, error_bound.load(), error))
+        continue;
+
+      // If the new error is lower, update the best hypothesis of this thread
+      if (error < thread_error[thread_id]) {
+        thread_error[thread_id] = error;
+        thread_iteration[thread_id] = iteration;
+        thread_transformation[thread_id] = transformation;
+      }
 
-    // If the new error is lower, update the final transformation
-    if (i_iter == 0 || error < lowest_error) {
-      lowest_error = error;
-      final_transformation_ = transformation_;
-      converged_ = true;
+      // Lower the shared bound without locking
+      float bound = error_bound.load();
+      while (error < bound && !error_bound.compare_exchange_weak(bound, error)) {
+      }
     }
   }
 
+  // Pick the lowest error, ties go to the earliest iteration as in a sequential run
+  int best_thread = -1;
+  for (int t = 0; t < nr_threads; ++t) {
+    if (thread_iteration[t] < 0)
+      continue;
+    if (best_thread < 0 || thread_error[t] < thread_error[best_thread] ||
+        (thread_error[t] == thread_error[best_thread] &&
+         thread_iteration[t] < thread_iteration[best_thread]))
+      best_thread = t;
+  }
+  if (best_thread >= 0) {
+    final_transformation_ = thread_transformation[best_thread];
+    transformation_ = final_transformation_;
+    converged_ = true;
+  }
+  min_sample_distance_ = *std::min_element(thread_min_sample_distance.begin(),
+                                           thread_min_sample_distance.end());
+
   // Apply the final transformation
   transformPointCloud(*input_, output, final_transformation_);
 }
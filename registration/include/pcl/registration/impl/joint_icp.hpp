@@ -39,11 +39,21 @@
 #ifndef PCL_REGISTRATION_IMPL_JOINT_ICP_HPP_
 #define PCL_REGISTRATION_IMPL_JOINT_ICP_HPP_
 
+#include <pcl/common/execution_context.h>
 #include <pcl/console/print.h>
 #include <pcl/correspondence.h>
 
 namespace pcl {
 
+template <typename PointSource, typename PointTarget, typename Scalar>
+void
+JointIterativeClosestPoint<PointSource, PointTarget, Scalar>::setNumberOfThreads(
+    unsigned int nr_threads)
+{
+  // 0 is resolved against the budget of pcl::ExecutionContext at compute time
+  threads_ = nr_threads;
+}
+
 template <typename PointSource, typename PointTarget, typename Scalar>
 void
 JointIterativeClosestPoint<PointSource, PointTarget, Scalar>::computeTransformation(
@@ -147,13 +157,19 @@ JointIterativeClosestPoint<PointSource, PointTarget, Scalar>::computeTransformat
     partial_correspondences_[i].reset(new pcl::Correspondences);
   }
 
+  const pcl::ThreadReservation reservation(threads_);
+  const unsigned int threads = reservation.getNumberOfThreads();
   do {
     // Save the previously estimated transformation
     previous_transformation_ = transformation_;
 
-    // Set the source each iteration, to ensure the dirty flag is updated
-    correspondences_->clear();
-    for (std::size_t i = 0; i < correspondence_estimations_.size(); i++) {
+    // Set the source each iteration, to ensure the dirty flag is updated. Every pair
+    // owns its estimator, trees and output, so the pairs are processed concurrently
+    auto nr_pairs = static_cast<std::ptrdiff_t>(correspondence_estimations_.size());
+#pragma omp parallel for default(none)                                                 \
+    shared(inputs_transformed, partial_correspondences_, nr_pairs)                     \
+    schedule(dynamic, 1) num_threads(threads)
+    for (std::ptrdiff_t i = 0; i < nr_pairs; i++) {
       correspondence_estimations_[i]->setInputSource(inputs_transformed[i]);
       // Get blob data if needed
       if (correspondence_estimations_[i]->requiresSourceNormals()) {
@@ -171,6 +187,11 @@ JointIterativeClosestPoint<PointSource, PointTarget, Scalar>::computeTransformat
         correspondence_estimations_[i]->determineCorrespondences(
             *partial_correspondences_[i], corr_dist_threshold_);
       }
+    }
+
+    // Gather the partial correspondences in pair order
+    correspondences_->clear();
+    for (std::size_t i = 0; i < correspondence_estimations_.size(); i++) {
       PCL_DEBUG("[pcl::%s::computeTransformation] Found %d partial correspondences for "
                 "cloud [%d]\n",
                 getClassName().c_str(),
@@ -235,7 +256,10 @@ JointIterativeClosestPoint<PointSource, PointTarget, Scalar>::computeTransformat
     this->transformCloud(
         *inputs_transformed_combined, *inputs_transformed_combined, transformation_);
     // And all its components
-    for (std::size_t i = 0; i < sources_.size(); i++) {
+    auto nr_sources = static_cast<std::ptrdiff_t>(sources_.size());
+#pragma omp parallel for default(none) shared(inputs_transformed, nr_sources)          \
+    schedule(dynamic, 1) num_threads(threads)
+    for (std::ptrdiff_t i = 0; i < nr_sources; i++) {
       this->transformCloud(
           *inputs_transformed[i], *inputs_transformed[i], transformation_);
     }
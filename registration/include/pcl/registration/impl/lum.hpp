@@ -41,6 +41,13 @@
 #ifndef PCL_REGISTRATION_IMPL_LUM_HPP_
 #define PCL_REGISTRATION_IMPL_LUM_HPP_
 
+#include <pcl/common/execution_context.h>
+
+#include <Eigen/OrderingMethods>
+#include <Eigen/SparseCholesky>
+#include <Eigen/SparseCore>
+#include <Eigen/SparseQR>
+
 #include <tuple>
 
 namespace pcl {
@@ -89,6 +96,14 @@ LUM<PointT>::setConvergenceThreshold(float convergence_threshold)
   convergence_threshold_ = convergence_threshold;
 }
 
+template <typename PointT>
+void
+LUM<PointT>::setNumberOfThreads(unsigned int nr_threads)
+{
+  // 0 is resolved against the budget of pcl::ExecutionContext at compute time
+  threads_ = nr_threads;
+}
+
 template <typename PointT>
 inline float
 LUM<PointT>::getConvergenceThreshold() const
@@ -226,44 +241,82 @@ LUM<PointT>::compute()
               "vertices.\n");
     return;
   }
+  std::vector<Edge> edge_list;
+  typename SLAMGraph::edge_iterator e_it, e_end;
+  for (std::tie(e_it, e_end) = edges(*slam_graph_); e_it != e_end; ++e_it)
+    edge_list.push_back(*e_it);
+  int nr_edges = static_cast<int>(edge_list.size());
+
+  // The linearization of an edge only changes when one of its vertices moved
+  std::vector<char> vertex_changed(n, 1);
+
+  const pcl::ThreadReservation reservation(threads_);
+  const unsigned int threads = reservation.getNumberOfThreads();
   for (int i = 0; i < max_iterations_; ++i) {
     // Linearized computation of C^-1 and C^-1*D and convergence checking for all edges
     // in the graph (results stored in slam_graph_)
-    typename SLAMGraph::edge_iterator e, e_end;
-    for (std::tie(e, e_end) = edges(*slam_graph_); e != e_end; ++e)
-      computeEdge(*e);
+#pragma omp parallel for \
+  default(none) \
+  shared(edge_list, nr_edges, vertex_changed) \
+  schedule(dynamic) \
+  num_threads(threads)
+    for (int ei = 0; ei < nr_edges; ++ei) {
+      const Edge& e = edge_list[ei];
+      if (vertex_changed[source(e, *slam_graph_)] ||
+          vertex_changed[target(e, *slam_graph_)])
+        computeEdge(e);
+    }
 
-    // Declare matrices G and B
-    Eigen::MatrixXf G = Eigen::MatrixXf::Zero(6 * (n - 1), 6 * (n - 1));
+    // Declare matrices G and B, G is sparse since every edge only couples two poses
+    std::vector<Eigen::Triplet<float>> triplets;
+    triplets.reserve(4 * 36 * edge_list.size());
     Eigen::VectorXf B = Eigen::VectorXf::Zero(6 * (n - 1));
-
-    // Start at 1 because 0 is the reference pose
-    for (int vi = 1; vi != n; ++vi) {
-      for (int vj = 0; vj != n; ++vj) {
-        // Attempt to use the forward edge, otherwise use backward edge, otherwise there
-        // was no edge
-        Edge e;
-        bool present1;
-        std::tie(e, present1) = edge(vi, vj, *slam_graph_);
-        if (!present1) {
-          bool present2;
-          std::tie(e, present2) = edge(vj, vi, *slam_graph_);
-          if (!present2)
-            continue;
+    bool symmetric = true;
+
+    // Fill in the elements of G and B of the row of vi using the edge e between vi and
+    // vj, skipping the row of 0 because 0 is the reference pose
+    const auto add_edge_to_row = [&](int vi, int vj, const Edge& e, float sign) {
+      if (vi == 0)
+        return;
+      const Eigen::Matrix6f& cinv = (*slam_graph_)[e].cinv_;
+      for (int r = 0; r < 6; ++r)
+        for (int c = 0; c < 6; ++c) {
+          if (vj > 0)
+            triplets.emplace_back(6 * (vi - 1) + r, 6 * (vj - 1) + c, -cinv(r, c));
+          triplets.emplace_back(6 * (vi - 1) + r, 6 * (vi - 1) + c, cinv(r, c));
         }
-
-        // Fill in elements of G and B
-        if (vj > 0)
-          G.block(6 * (vi - 1), 6 * (vj - 1), 6, 6) = -(*slam_graph_)[e].cinv_;
-        G.block(6 * (vi - 1), 6 * (vi - 1), 6, 6) += (*slam_graph_)[e].cinv_;
-        B.segment(6 * (vi - 1), 6) += (present1 ? 1 : -1) * (*slam_graph_)[e].cinvd_;
-      }
+      B.segment(6 * (vi - 1), 6) += sign * (*slam_graph_)[e].cinvd_;
+    };
+
+    for (const Edge& e : edge_list) {
+      const int vs = static_cast<int>(source(e, *slam_graph_));
+      const int vt = static_cast<int>(target(e, *slam_graph_));
+      // The forward edge is used for the row of its source, the backward edge for the
+      // row of its target unless there is a forward edge for that row as well
+      add_edge_to_row(vs, vt, e, 1.0f);
+      if (edge(vt, vs, *slam_graph_).second)
+        symmetric = false;
+      else
+        add_edge_to_row(vt, vs, e, -1.0f);
     }
 
+    Eigen::SparseMatrix<float> G(6 * (n - 1), 6 * (n - 1));
+    G.setFromTriplets(triplets.begin(), triplets.end());
+
     // Computation of the linear equation system: GX = B
-    // TODO investigate accuracy vs. speed tradeoff and find the best solving method for
-    // our type of linear equation (sparse)
-    Eigen::VectorXf X = G.colPivHouseholderQr().solve(B);
+    // G is symmetric positive semi-definite unless both directions of an edge are in
+    // the graph. Fall back to a rank revealing QR decomposition if it is not symmetric
+    // or the Cholesky factorization hits a zero pivot.
+    Eigen::VectorXf X;
+    if (symmetric) {
+      Eigen::SimplicialLDLT<Eigen::SparseMatrix<float>> ldlt(G);
+      if (ldlt.info() == Eigen::Success)
+        X = ldlt.solve(B);
+    }
+    if (X.size() == 0) {
+      Eigen::SparseQR<Eigen::SparseMatrix<float>, Eigen::COLAMDOrdering<int>> qr(G);
+      X = qr.solve(B);
+    }
 
     // Update the poses
     float sum = 0.0;
@@ -272,7 +325,9 @@ LUM<PointT>::compute()
           -incidenceCorrection(getPose(vi)).inverse() * X.segment(6 * (vi - 1), 6));
       sum += difference_pose.norm();
       setPose(vi, getPose(vi) + difference_pose);
+      vertex_changed[vi] = !difference_pose.isZero(0.0f);
     }
+    vertex_changed[0] = 0;
 
     // Convergence check
     if (sum <= convergence_threshold_ * static_cast<float>(n - 1))
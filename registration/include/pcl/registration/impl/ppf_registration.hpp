@@ -42,11 +42,23 @@
 #ifndef PCL_REGISTRATION_IMPL_PPF_REGISTRATION_H_
 #define PCL_REGISTRATION_IMPL_PPF_REGISTRATION_H_
 
+#include <pcl/common/execution_context.h>
 #include <pcl/common/transforms.h>
 #include <pcl/features/pfh.h>
 #include <pcl/features/pfh_tools.h> // for computePairFeatures
 #include <pcl/features/ppf.h>
 #include <pcl/registration/ppf_registration.h>
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointSource, typename PointTarget>
+void
+pcl::PPFRegistration<PointSource, PointTarget>::setNumberOfThreads(
+    unsigned int nr_threads)
+{
+  // 0 is resolved against the budget of pcl::ExecutionContext at compute time
+  threads_ = nr_threads;
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointSource, typename PointTarget>
 void
@@ -77,138 +89,183 @@ pcl::PPFRegistration<PointSource, PointTarget>::computeTransformation(
               "(guess) not implemented!\n");
   }
 
-  const auto aux_size = static_cast<std::size_t>(
+  std::size_t aux_size = static_cast<std::size_t>(
       std::floor(2 * M_PI / search_method_->getAngleDiscretizationStep()));
+  std::size_t model_size = input_->size();
 
-  const std::vector<unsigned int> tmp_vec(aux_size, 0);
-  std::vector<std::vector<unsigned int>> accumulator_array(input_->size(), tmp_vec);
+  PCL_INFO("Accumulator array size: %zu x %zu.\n", model_size, aux_size);
 
-  PCL_INFO("Accumulator array size: %u x %u.\n",
-           accumulator_array.size(),
-           accumulator_array.back().size());
-
-  PoseWithVotesList voted_poses;
   // Consider every <scene_reference_point_sampling_rate>-th point as the reference
-  // point => fix s_r
-  float f1, f2, f3, f4;
-  for (index_t scene_reference_index = 0;
-       scene_reference_index < static_cast<index_t>(target_->size());
-       scene_reference_index += scene_reference_point_sampling_rate_) {
-    Eigen::Vector3f scene_reference_point =
-                        (*target_)[scene_reference_index].getVector3fMap(),
-                    scene_reference_normal =
-                        (*target_)[scene_reference_index].getNormalVector3fMap();
-
-    float rotation_angle_sg =
-        std::acos(scene_reference_normal.dot(Eigen::Vector3f::UnitX()));
-    bool parallel_to_x_sg =
-        (scene_reference_normal.y() == 0.0f && scene_reference_normal.z() == 0.0f);
-    Eigen::Vector3f rotation_axis_sg =
-        (parallel_to_x_sg)
-            ? (Eigen::Vector3f::UnitY())
-            : (scene_reference_normal.cross(Eigen::Vector3f::UnitX()).normalized());
-    Eigen::AngleAxisf rotation_sg(rotation_angle_sg, rotation_axis_sg);
-    Eigen::Affine3f transform_sg(
-        Eigen::Translation3f(rotation_sg * ((-1) * scene_reference_point)) *
-        rotation_sg);
-
-    // For every other point in the scene => now have pair (s_r, s_i) fixed
+  // point => fix s_r. The reference points vote independently of each other, each
+  // thread uses its own accumulator array.
+  int nr_reference_points = static_cast<int>(
+      (target_->size() + scene_reference_point_sampling_rate_ - 1) /
+      scene_reference_point_sampling_rate_);
+  std::vector<Eigen::Affine3f, Eigen::aligned_allocator<Eigen::Affine3f>>
+      reference_poses(nr_reference_points);
+  std::vector<unsigned int> reference_votes(nr_reference_points);
+
+  const pcl::ThreadReservation reservation(threads_);
+  const unsigned int threads = reservation.getNumberOfThreads();
+#pragma omp parallel \
+  default(none) \
+  shared(aux_size, model_size, nr_reference_points, reference_poses, reference_votes) \
+  num_threads(threads)
+  {
+    // Accumulator of model reference point i and discretized angle j at i * aux_size + j
+    std::vector<unsigned int> accumulator_array(model_size * aux_size, 0);
     pcl::Indices indices;
     std::vector<float> distances;
-    scene_search_tree_->radiusSearch((*target_)[scene_reference_index],
-                                     search_method_->getModelDiameter() / 2,
-                                     indices,
-                                     distances);
-    for (const auto& scene_point_index : indices)
-    //    for(std::size_t i = 0; i < target_->size (); ++i)
-    {
-      // size_t scene_point_index = i;
-      if (scene_reference_index != scene_point_index) {
-        if (/*pcl::computePPFPairFeature*/ pcl::computePairFeatures(
-            (*target_)[scene_reference_index].getVector4fMap(),
-            (*target_)[scene_reference_index].getNormalVector4fMap(),
-            (*target_)[scene_point_index].getVector4fMap(),
-            (*target_)[scene_point_index].getNormalVector4fMap(),
-            f1,
-            f2,
-            f3,
-            f4)) {
-          std::vector<std::pair<std::size_t, std::size_t>> nearest_indices;
-          search_method_->nearestNeighborSearch(f1, f2, f3, f4, nearest_indices);
-
-          // Compute alpha_s angle
-          Eigen::Vector3f scene_point = (*target_)[scene_point_index].getVector3fMap();
-
-          Eigen::Vector3f scene_point_transformed = transform_sg * scene_point;
-          float alpha_s =
-              std::atan2(-scene_point_transformed(2), scene_point_transformed(1));
-          if (std::sin(alpha_s) * scene_point_transformed(2) < 0.0f)
-            alpha_s *= (-1);
-          alpha_s *= (-1);
+    std::vector<std::pair<std::size_t, std::size_t>> nearest_indices;
+    // Scene points paired with the reference point, as a structure of arrays
+    std::vector<index_t> pair_indices;
+    std::vector<float> x, y, z, nx, ny, nz, f1, f2, f3, f4;
+
+#pragma omp for schedule(dynamic)
+    for (int reference_i = 0; reference_i < nr_reference_points; ++reference_i) {
+      const index_t scene_reference_index =
+          static_cast<index_t>(reference_i * scene_reference_point_sampling_rate_);
+      Eigen::Vector3f scene_reference_point =
+                          (*target_)[scene_reference_index].getVector3fMap(),
+                      scene_reference_normal =
+                          (*target_)[scene_reference_index].getNormalVector3fMap();
+
+      float rotation_angle_sg =
+          std::acos(scene_reference_normal.dot(Eigen::Vector3f::UnitX()));
+      bool parallel_to_x_sg =
+          (scene_reference_normal.y() == 0.0f && scene_reference_normal.z() == 0.0f);
+      Eigen::Vector3f rotation_axis_sg =
+          (parallel_to_x_sg)
+              ? (Eigen::Vector3f::UnitY())
+              : (scene_reference_normal.cross(Eigen::Vector3f::UnitX()).normalized());
+      Eigen::AngleAxisf rotation_sg(rotation_angle_sg, rotation_axis_sg);
+      Eigen::Affine3f transform_sg(
+          Eigen::Translation3f(rotation_sg * ((-1) * scene_reference_point)) *
+          rotation_sg);
+
+      // For every other point in the scene => now have pair (s_r, s_i) fixed
+      scene_search_tree_->radiusSearch((*target_)[scene_reference_index],
+                                       search_method_->getModelDiameter() / 2,
+                                       indices,
+                                       distances);
+
+      pair_indices.clear();
+      x.clear(), y.clear(), z.clear(), nx.clear(), ny.clear(), nz.clear();
+      for (const auto& scene_point_index : indices) {
+        if (scene_reference_index == scene_point_index)
+          continue;
+        const PointTarget& scene_point = (*target_)[scene_point_index];
+        pair_indices.push_back(scene_point_index);
+        x.push_back(scene_point.x), y.push_back(scene_point.y),
+            z.push_back(scene_point.z);
+        nx.push_back(scene_point.normal_x), ny.push_back(scene_point.normal_y),
+            nz.push_back(scene_point.normal_z);
+      }
 
-          // Go through point pairs in the model with the same discretized feature
-          for (const auto& nearest_index : nearest_indices) {
-            std::size_t model_reference_index = nearest_index.first;
-            std::size_t model_point_index = nearest_index.second;
-            // Calculate angle alpha = alpha_m - alpha_s
-            float alpha =
-                search_method_->alpha_m_[model_reference_index][model_point_index] -
-                alpha_s;
-            unsigned int alpha_discretized = static_cast<unsigned int>(
-                std::floor(alpha) +
-                std::floor(M_PI / search_method_->getAngleDiscretizationStep()));
-            accumulator_array[model_reference_index][alpha_discretized]++;
-          }
-        }
-        else
+      // Compute the pair features of all the pairs of the reference point at once
+      const std::size_t nr_pairs = pair_indices.size();
+      f1.resize(nr_pairs), f2.resize(nr_pairs), f3.resize(nr_pairs),
+          f4.resize(nr_pairs);
+      pcl::computePairFeatures((*target_)[scene_reference_index].getVector4fMap(),
+                               (*target_)[scene_reference_index].getNormalVector4fMap(),
+                               x.data(),
+                               y.data(),
+                               z.data(),
+                               nx.data(),
+                               ny.data(),
+                               nz.data(),
+                               nr_pairs,
+                               f1.data(),
+                               f2.data(),
+                               f3.data(),
+                               f4.data());
+
+      for (std::size_t pair_i = 0; pair_i < nr_pairs; ++pair_i) {
+        const index_t scene_point_index = pair_indices[pair_i];
+        // The features of the pairs the feature computation rejects are all zero
+        if (f4[pair_i] == 0.0f) {
           PCL_ERROR("[pcl::PPFRegistration::computeTransformation] Computing pair "
                     "feature vector between points %u and %u went wrong.\n",
                     scene_reference_index,
                     scene_point_index);
-      }
-    }
+          continue;
+        }
 
-    std::size_t max_votes_i = 0, max_votes_j = 0;
-    unsigned int max_votes = 0;
+        search_method_->nearestNeighborSearch(
+            f1[pair_i], f2[pair_i], f3[pair_i], f4[pair_i], nearest_indices);
 
-    for (std::size_t i = 0; i < accumulator_array.size(); ++i)
-      for (std::size_t j = 0; j < accumulator_array.back().size(); ++j) {
-        if (accumulator_array[i][j] > max_votes) {
-          max_votes = accumulator_array[i][j];
-          max_votes_i = i;
-          max_votes_j = j;
+        // Compute alpha_s angle
+        Eigen::Vector3f scene_point = (*target_)[scene_point_index].getVector3fMap();
+
+        Eigen::Vector3f scene_point_transformed = transform_sg * scene_point;
+        float alpha_s =
+            std::atan2(-scene_point_transformed(2), scene_point_transformed(1));
+        if (std::sin(alpha_s) * scene_point_transformed(2) < 0.0f)
+          alpha_s *= (-1);
+        alpha_s *= (-1);
+
+        // Go through point pairs in the model with the same discretized feature
+        for (const auto& nearest_index : nearest_indices) {
+          std::size_t model_reference_index = nearest_index.first;
+          std::size_t model_point_index = nearest_index.second;
+          // Calculate angle alpha = alpha_m - alpha_s
+          float alpha =
+              search_method_->alpha_m_[model_reference_index][model_point_index] -
+              alpha_s;
+          unsigned int alpha_discretized = static_cast<unsigned int>(
+              std::floor(alpha) +
+              std::floor(M_PI / search_method_->getAngleDiscretizationStep()));
+          accumulator_array[model_reference_index * aux_size + alpha_discretized]++;
         }
-        // Reset accumulator_array for the next set of iterations with a new scene
-        // reference point
-        accumulator_array[i][j] = 0;
       }
 
-    Eigen::Vector3f model_reference_point = (*input_)[max_votes_i].getVector3fMap(),
-                    model_reference_normal =
-                        (*input_)[max_votes_i].getNormalVector3fMap();
-    float rotation_angle_mg =
-        std::acos(model_reference_normal.dot(Eigen::Vector3f::UnitX()));
-    bool parallel_to_x_mg =
-        (model_reference_normal.y() == 0.0f && model_reference_normal.z() == 0.0f);
-    Eigen::Vector3f rotation_axis_mg =
-        (parallel_to_x_mg)
-            ? (Eigen::Vector3f::UnitY())
-            : (model_reference_normal.cross(Eigen::Vector3f::UnitX()).normalized());
-    Eigen::AngleAxisf rotation_mg(rotation_angle_mg, rotation_axis_mg);
-    Eigen::Affine3f transform_mg(
-        Eigen::Translation3f(rotation_mg * ((-1) * model_reference_point)) *
-        rotation_mg);
-    Eigen::Affine3f max_transform =
-        transform_sg.inverse() *
-        Eigen::AngleAxisf((static_cast<float>(max_votes_j) -
-                           std::floor(static_cast<float>(M_PI) /
-                                      search_method_->getAngleDiscretizationStep())) *
-                              search_method_->getAngleDiscretizationStep(),
-                          Eigen::Vector3f::UnitX()) *
-        transform_mg;
-
-    voted_poses.push_back(PoseWithVotes(max_transform, max_votes));
+      std::size_t max_votes_i = 0, max_votes_j = 0;
+      unsigned int max_votes = 0;
+
+      for (std::size_t i = 0; i < model_size; ++i)
+        for (std::size_t j = 0; j < aux_size; ++j) {
+          unsigned int& votes = accumulator_array[i * aux_size + j];
+          if (votes > max_votes) {
+            max_votes = votes;
+            max_votes_i = i;
+            max_votes_j = j;
+          }
+          // Reset accumulator_array for the next set of iterations with a new scene
+          // reference point
+          votes = 0;
+        }
+
+      Eigen::Vector3f model_reference_point = (*input_)[max_votes_i].getVector3fMap(),
+                      model_reference_normal =
+                          (*input_)[max_votes_i].getNormalVector3fMap();
+      float rotation_angle_mg =
+          std::acos(model_reference_normal.dot(Eigen::Vector3f::UnitX()));
+      bool parallel_to_x_mg =
+          (model_reference_normal.y() == 0.0f && model_reference_normal.z() == 0.0f);
+      Eigen::Vector3f rotation_axis_mg =
+          (parallel_to_x_mg)
+              ? (Eigen::Vector3f::UnitY())
+              : (model_reference_normal.cross(Eigen::Vector3f::UnitX()).normalized());
+      Eigen::AngleAxisf rotation_mg(rotation_angle_mg, rotation_axis_mg);
+      Eigen::Affine3f transform_mg(
+          Eigen::Translation3f(rotation_mg * ((-1) * model_reference_point)) *
+          rotation_mg);
+      reference_poses[reference_i] =
+          transform_sg.inverse() *
+          Eigen::AngleAxisf((static_cast<float>(max_votes_j) -
+                             std::floor(static_cast<float>(M_PI) /
+                                        search_method_->getAngleDiscretizationStep())) *
+                                search_method_->getAngleDiscretizationStep(),
+                            Eigen::Vector3f::UnitX()) *
+          transform_mg;
+      reference_votes[reference_i] = max_votes;
+    }
   }
+
+  PoseWithVotesList voted_poses;
+  for (int reference_i = 0; reference_i < nr_reference_points; ++reference_i)
+    voted_poses.push_back(
+        PoseWithVotes(reference_poses[reference_i], reference_votes[reference_i]));
   PCL_DEBUG("Done with the Hough Transform ...\n");
 
   // Cluster poses for filtering out outliers and obtaining more precise results
@@ -0,0 +1,137 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef PCL_REGISTRATION_IMPL_PYRAMID_ICP_HPP_
+#define PCL_REGISTRATION_IMPL_PYRAMID_ICP_HPP_
+
+#include <pcl/common/transforms.h>
+#include <pcl/filters/voxel_grid.h>
+
+namespace pcl {
+
+namespace registration {
+
+template <typename PointSource, typename PointTarget, typename Scalar>
+void
+PyramidICP<PointSource, PointTarget, Scalar>::addLevel(
+    float leaf_size, int max_iterations, double max_correspondence_distance)
+{
+  Level level;
+  level.leaf_size = leaf_size;
+  level.registration.reset(new LevelRegistration);
+  level.registration->setMaximumIterations(max_iterations);
+  level.registration->setMaxCorrespondenceDistance(max_correspondence_distance);
+  levels_.push_back(level);
+  pyramid_updated_ = false;
+}
+
+template <typename PointSource, typename PointTarget, typename Scalar>
+void
+PyramidICP<PointSource, PointTarget, Scalar>::buildTargetPyramid()
+{
+  for (auto& level : levels_) {
+    if (level.leaf_size > 0) {
+      PointCloudTargetPtr target(new PointCloudTarget);
+      pcl::VoxelGrid<PointTarget> grid;
+      grid.setLeafSize(level.leaf_size, level.leaf_size, level.leaf_size);
+      grid.setInputCloud(target_);
+      grid.filter(*target);
+      level.target = target;
+
+      KdTreePtr tree(new KdTree);
+      tree->setInputCloud(target);
+      level.registration->setInputTarget(target);
+      // The tree is complete, prevent the level from rebuilding it on every alignment
+      level.registration->setSearchMethodTarget(tree, true);
+    }
+    else {
+      // Full resolution, share the tree built on the target by initCompute
+      level.target = target_;
+      level.registration->setInputTarget(target_);
+      level.registration->setSearchMethodTarget(tree_, true);
+    }
+  }
+  pyramid_updated_ = true;
+}
+
+template <typename PointSource, typename PointTarget, typename Scalar>
+void
+PyramidICP<PointSource, PointTarget, Scalar>::computeTransformation(
+    PointCloudSource& output, const Matrix4& guess)
+{
+  if (levels_.empty()) {
+    PCL_ERROR("[pcl::registration::%s::computeTransformation] No pyramid levels "
+              "given!\n",
+              getClassName().c_str());
+    return;
+  }
+
+  if (!pyramid_updated_)
+    buildTargetPyramid();
+
+  // The output holds the source points selected by the indices
+  PointCloudSourcePtr source(new PointCloudSource(output));
+  PointCloudSource level_output;
+  Matrix4 transform = guess;
+
+  for (auto& level : levels_) {
+    PointCloudSourcePtr level_source = source;
+    if (level.leaf_size > 0) {
+      level_source.reset(new PointCloudSource);
+      pcl::VoxelGrid<PointSource> grid;
+      grid.setLeafSize(level.leaf_size, level.leaf_size, level.leaf_size);
+      grid.setInputCloud(source);
+      grid.filter(*level_source);
+    }
+
+    level.registration->setInputSource(level_source);
+    level.registration->align(level_output, transform);
+
+    // Carry the transformation over to the next, finer level
+    if (level.registration->hasConverged())
+      transform = level.registration->getFinalTransformation();
+  }
+
+  converged_ = levels_.back().registration->hasConverged();
+  final_transformation_ = transform;
+  transformPointCloud(output, output, final_transformation_);
+}
+
+} // namespace registration
+} // namespace pcl
+
+#endif // PCL_REGISTRATION_IMPL_PYRAMID_ICP_HPP_
@@ -74,6 +74,8 @@ template <typename PointSource, typename PointTarget, typename Scalar>
 bool
 Registration<PointSource, PointTarget, Scalar>::initCompute()
 {
+  PCL_TRACE_ZONE("Registration::initCompute");
+
   if (!target_) {
     PCL_ERROR("[pcl::registration::%s::compute] No input target dataset was given!\n",
               getClassName().c_str());
@@ -173,6 +175,8 @@ inline void
 Registration<PointSource, PointTarget, Scalar>::align(PointCloudSource& output,
                                                       const Matrix4& guess)
 {
+  PCL_TRACE_ZONE(reg_name_);
+
   if (!initCompute())
     return;
 
@@ -209,7 +213,11 @@ Registration<PointSource, PointTarget, Scalar>::align(PointCloudSource& output,
   for (std::size_t i = 0; i < indices_->size(); ++i)
     output[i].data[3] = 1.0;
 
-  computeTransformation(output, guess);
+  {
+    PCL_TRACE_ZONE("Registration::computeTransformation");
+    computeTransformation(output, guess);
+  }
+  PCL_TRACE_COUNTER("Registration::iterations", nr_iterations_);
 
   deinitCompute();
 }
@@ -41,6 +41,17 @@
 #ifndef PCL_REGISTRATION_SAMPLE_CONSENSUS_PREREJECTIVE_HPP_
 #define PCL_REGISTRATION_SAMPLE_CONSENSUS_PREREJECTIVE_HPP_
 
+#include <pcl/common/execution_context.h>
+#include <pcl/common/transforms.h>
+
+#include <algorithm>
+#include <numeric>
+#include <random>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 namespace pcl {
 
 template <typename PointSource, typename PointTarget, typename FeatureT>
@@ -72,10 +83,43 @@ SampleConsensusPrerejective<PointSource, PointTarget, FeatureT>::setTargetFeatur
   feature_tree_->setInputCloud(target_features_);
 }
 
+template <typename PointSource, typename PointTarget, typename FeatureT>
+void
+SampleConsensusPrerejective<PointSource, PointTarget, FeatureT>::setNumberOfThreads(
+    unsigned int nr_threads)
+{
+#ifdef _OPENMP
+  // 0 is resolved against the budget of pcl::ExecutionContext at compute time
+  threads_ = nr_threads;
+  PCL_DEBUG("[pcl::%s::setNumberOfThreads] Setting number of threads to %u.\n",
+            getClassName().c_str(),
+            threads_);
+#else
+  threads_ = 1;
+  if (nr_threads != 1)
+    PCL_WARN("[pcl::%s::setNumberOfThreads] Parallelization is requested, but OpenMP "
+             "is not available! Continuing without parallelization.\n",
+             getClassName().c_str());
+#endif // _OPENMP
+}
+
 template <typename PointSource, typename PointTarget, typename FeatureT>
 void
 SampleConsensusPrerejective<PointSource, PointTarget, FeatureT>::selectSamples(
     const PointCloudSource& cloud, int nr_samples, pcl::Indices& sample_indices)
+{
+  const auto random_index = [this](int n) { return getRandomIndex(n); };
+  selectSamples(cloud, nr_samples, sample_indices, random_index);
+}
+
+template <typename PointSource, typename PointTarget, typename FeatureT>
+template <typename RandomIndexFunctor>
+void
+SampleConsensusPrerejective<PointSource, PointTarget, FeatureT>::selectSamples(
+    const PointCloudSource& cloud,
+    int nr_samples,
+    pcl::Indices& sample_indices,
+    const RandomIndexFunctor& random_index) const
 {
   if (nr_samples > static_cast<int>(cloud.size())) {
     PCL_ERROR("[pcl::%s::selectSamples] ", getClassName().c_str());
@@ -92,7 +136,7 @@ SampleConsensusPrerejective<PointSource, PointTarget, FeatureT>::selectSamples(
   // Draw random samples until n samples is reached
   for (int i = 0; i < nr_samples; i++) {
     // Select a random number
-    sample_indices[i] = getRandomIndex(static_cast<int>(cloud.size()) - i);
+    sample_indices[i] = random_index(static_cast<int>(cloud.size()) - i);
 
     // Run trough list of numbers, starting at the lowest, to avoid duplicates
     for (int j = 0; j < i; j++) {
@@ -121,6 +165,20 @@ SampleConsensusPrerejective<PointSource, PointTarget, FeatureT>::findSimilarFeat
     const pcl::Indices& sample_indices,
     std::vector<pcl::Indices>& similar_features,
     pcl::Indices& corresponding_indices)
+{
+  const auto random_index = [this](int n) { return getRandomIndex(n); };
+  findSimilarFeatures(
+      sample_indices, similar_features, corresponding_indices, random_index);
+}
+
+template <typename PointSource, typename PointTarget, typename FeatureT>
+template <typename RandomIndexFunctor>
+void
+SampleConsensusPrerejective<PointSource, PointTarget, FeatureT>::findSimilarFeatures(
+    const pcl::Indices& sample_indices,
+    std::vector<pcl::Indices>& similar_features,
+    pcl::Indices& corresponding_indices,
+    const RandomIndexFunctor& random_index) const
 {
   // Allocate results
   corresponding_indices.resize(sample_indices.size());
@@ -145,7 +203,7 @@ SampleConsensusPrerejective<PointSource, PointTarget, FeatureT>::findSimilarFeat
       corresponding_indices[i] = similar_features[idx][0];
     else
       corresponding_indices[i] =
-          similar_features[idx][getRandomIndex(k_correspondences_)];
+          similar_features[idx][random_index(k_correspondences_)];
   }
 }
 
@@ -239,55 +297,167 @@ SampleConsensusPrerejective<PointSource, PointTarget, FeatureT>::computeTransfor
     }
   }
 
-  // Feature correspondence cache
+  // Feature correspondence cache. With several threads it is filled up front, so that
+  // the threads only read from it.
   std::vector<pcl::Indices> similar_features(input_->size());
+  const pcl::ThreadReservation reservation(threads_);
+  const int nr_threads = static_cast<int>(reservation.getNumberOfThreads());
+  if (nr_threads > 1) {
+    const int nr_features = static_cast<int>(input_features_->size());
+#pragma omp parallel for default(none) shared(similar_features, nr_features)          \
+    num_threads(nr_threads)
+    for (int idx = 0; idx < nr_features; ++idx) {
+      std::vector<float> nn_distances(k_correspondences_);
+      feature_tree_->nearestKSearch(*input_features_,
+                                    idx,
+                                    k_correspondences_,
+                                    similar_features[idx],
+                                    nn_distances);
+    }
+  }
+
+  // Score the input points in a fixed random order, so that a bad hypothesis exceeds
+  // the outlier bound after only a few points
+  pcl::Indices evaluation_order(input_->size());
+  std::iota(evaluation_order.begin(), evaluation_order.end(), 0);
+  std::shuffle(evaluation_order.begin(), evaluation_order.end(), std::mt19937());
+
+  // The largest number of outliers that still reaches the required inlier fraction
+  std::size_t nr_points = input_->size();
+  std::size_t max_outliers = nr_points;
+  while (max_outliers > 0 && static_cast<float>(nr_points - max_outliers) /
+                                     static_cast<float>(nr_points) <
+                                 inlier_fraction_)
+    --max_outliers;
+
+  // With several threads every thread draws from its own random stream. The seeds come
+  // from std::rand, a single thread keeps drawing from std::rand directly.
+  std::vector<unsigned int> seeds(nr_threads);
+  if (nr_threads > 1)
+    for (auto& seed : seeds)
+      seed = static_cast<unsigned int>(std::rand());
+
+  // The best hypothesis of each thread is kept apart and reduced afterwards
+  std::vector<float> thread_error(nr_threads, lowest_error);
+  std::vector<int> thread_iteration(nr_threads, -1);
+  std::vector<Matrix4, Eigen::aligned_allocator<Matrix4>> thread_transformation(
+      nr_threads, final_transformation_);
+
+#pragma omp parallel default(none)                                                     \
+    shared(similar_features,                                                           \
+           evaluation_order,                                                           \
+           max_outliers,                                                               \
+           nr_points,                                                                  \
+           nr_threads,                                                                 \
+           seeds,                                                                      \
+           thread_error,                                                               \
+           thread_iteration,                                                           \
+           thread_transformation) reduction(+ : num_rejections) num_threads(nr_threads)
+  {
+#ifdef _OPENMP
+    const int thread_id = omp_get_thread_num();
+#else
+    const int thread_id = 0;
+#endif
+    std::mt19937 rng(seeds[thread_id]);
+    const auto random_index = [&](int n) -> int {
+      if (nr_threads == 1)
+        return getRandomIndex(n);
+      return std::uniform_int_distribution<int>(0, n - 1)(rng);
+    };
 
-  // Start
-  for (int i = 0; i < max_iterations_; ++i) {
     // Temporary containers
     pcl::Indices sample_indices;
     pcl::Indices corresponding_indices;
 
-    // Draw nr_samples_ random samples
-    selectSamples(*input_, nr_samples_, sample_indices);
-
-    // Find corresponding features in the target cloud
-    findSimilarFeatures(sample_indices, similar_features, corresponding_indices);
-
-    // Apply prerejection
-    if (!correspondence_rejector_poly_->thresholdPolygon(sample_indices,
-                                                         corresponding_indices)) {
-      ++num_rejections;
-      continue;
+    // The hypotheses are generated in blocks, the transformations of the hypotheses of
+    // a block that pass the prerejection are estimated at once
+    const int block_size = 16;
+    pcl::Indices block_sample_indices;
+    pcl::Indices block_corresponding_indices;
+    std::vector<int> block_iterations;
+    std::vector<Matrix4, Eigen::aligned_allocator<Matrix4>> block_transformations;
+
+#pragma omp for schedule(static)
+    for (int block_begin = 0; block_begin < max_iterations_;
+         block_begin += block_size) {
+      block_sample_indices.clear();
+      block_corresponding_indices.clear();
+      block_iterations.clear();
+
+      const int block_end = std::min(block_begin + block_size, max_iterations_);
+      for (int i = block_begin; i < block_end; ++i) {
+        // Draw nr_samples_ random samples
+        selectSamples(*input_, nr_samples_, sample_indices, random_index);
+
+        // Find corresponding features in the target cloud
+        findSimilarFeatures(
+            sample_indices, similar_features, corresponding_indices, random_index);
+
+        // Apply prerejection
+        if (!correspondence_rejector_poly_->thresholdPolygon(sample_indices,
+                                                             corresponding_indices)) {
+          ++num_rejections;
+          continue;
+        }
+
+        block_sample_indices.insert(
+            block_sample_indices.end(), sample_indices.begin(), sample_indices.end());
+        block_corresponding_indices.insert(block_corresponding_indices.end(),
+                                           corresponding_indices.begin(),
+                                           corresponding_indices.end());
+        block_iterations.push_back(i);
+      }
+      if (block_iterations.empty())
+        continue;
+
+      // Estimate the transforms from the correspondences
+      transformation_estimation_->estimateRigidTransformations(
+          *input_,
+          block_sample_indices,
+          *target_,
+          block_corresponding_indices,
+          nr_samples_,
+          block_transformations);
+
+      for (std::size_t b = 0; b < block_transformations.size(); ++b) {
+        // Compute the error, giving up once there are too many outliers
+        std::size_t nr_inliers;
+        float error;
+        if (!getFitness(block_transformations[b],
+                        evaluation_order,
+                        max_outliers,
+                        nr_inliers,
+                        error))
+          continue;
+
+        // Update the best hypothesis of this thread if the new fit is better
+        const float inlier_fraction =
+            static_cast<float>(nr_inliers) / static_cast<float>(nr_points);
+        if (inlier_fraction >= inlier_fraction_ && error < thread_error[thread_id]) {
+          thread_error[thread_id] = error;
+          thread_iteration[thread_id] = block_iterations[b];
+          thread_transformation[thread_id] = block_transformations[b];
+        }
+      }
     }
+  }
 
-    // Estimate the transform from the correspondences, write to transformation_
-    transformation_estimation_->estimateRigidTransformation(
-        *input_, sample_indices, *target_, corresponding_indices, transformation_);
-
-    // Take a backup of previous result
-    const Matrix4 final_transformation_prev = final_transformation_;
-
-    // Set final result to current transformation
+  // Pick the lowest error, ties go to the earliest iteration as in a sequential run
+  int best_thread = -1;
+  for (int t = 0; t < nr_threads; ++t) {
+    if (thread_iteration[t] < 0)
+      continue;
+    if (best_thread < 0 || thread_error[t] < thread_error[best_thread] ||
+        (thread_error[t] == thread_error[best_thread] &&
+         thread_iteration[t] < thread_iteration[best_thread]))
+      best_thread = t;
+  }
+  if (best_thread >= 0) {
+    transformation_ = thread_transformation[best_thread];
     final_transformation_ = transformation_;
-
-    // Transform the input and compute the error (uses input_ and final_transformation_)
-    getFitness(inliers, error);
-
-    // Restore previous result
-    final_transformation_ = final_transformation_prev;
-
-    // If the new fit is better, update results
-    inlier_fraction =
-        static_cast<float>(inliers.size()) / static_cast<float>(input_->size());
-
-    // Update result if pose hypothesis is better
-    if (inlier_fraction >= inlier_fraction_ && error < lowest_error) {
-      inliers_ = inliers;
-      lowest_error = error;
-      converged_ = true;
-      final_transformation_ = transformation_;
-    }
+    converged_ = true;
+    getFitness(inliers_, error);
   }
 
   // Apply the final transformation
@@ -344,6 +514,47 @@ SampleConsensusPrerejective<PointSource, PointTarget, FeatureT>::getFitness(
     fitness_score = std::numeric_limits<float>::max();
 }
 
+template <typename PointSource, typename PointTarget, typename FeatureT>
+bool
+SampleConsensusPrerejective<PointSource, PointTarget, FeatureT>::getFitness(
+    const Matrix4& transformation,
+    const pcl::Indices& evaluation_order,
+    std::size_t max_outliers,
+    std::size_t& nr_inliers,
+    float& fitness_score) const
+{
+  nr_inliers = 0;
+  fitness_score = 0.0f;
+  std::size_t nr_outliers = 0;
+
+  // Use squared distance for comparison with NN search results
+  const float max_range = corr_dist_threshold_ * corr_dist_threshold_;
+  const Eigen::Affine3f transform(transformation);
+
+  pcl::Indices nn_indices(1);
+  std::vector<float> nn_dists(1);
+  for (const auto& idx : evaluation_order) {
+    // Find the nearest neighbor of the transformed point in the target
+    tree_->nearestKSearch(
+        pcl::transformPoint((*input_)[idx], transform), 1, nn_indices, nn_dists);
+
+    // Check if point is an inlier, stop once the inlier fraction can not be reached
+    if (nn_dists[0] < max_range) {
+      ++nr_inliers;
+      fitness_score += nn_dists[0];
+    }
+    else if (++nr_outliers > max_outliers)
+      return (false);
+  }
+
+  // Calculate MSE
+  if (nr_inliers > 0)
+    fitness_score /= static_cast<float>(nr_inliers);
+  else
+    fitness_score = std::numeric_limits<float>::max();
+  return (true);
+}
+
 } // namespace pcl
 
 #endif
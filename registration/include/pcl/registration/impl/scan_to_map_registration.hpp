@@ -0,0 +1,161 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef PCL_REGISTRATION_IMPL_SCAN_TO_MAP_REGISTRATION_HPP_
+#define PCL_REGISTRATION_IMPL_SCAN_TO_MAP_REGISTRATION_HPP_
+
+#include <pcl/common/transforms.h>
+
+#include <limits>
+
+namespace pcl {
+
+namespace registration {
+
+template <typename PointT, typename Scalar>
+ScanToMapRegistration<PointT, Scalar>::ScanToMapRegistration()
+: registration_initialized_(false)
+, map_(new MapSearch)
+, local_map_size_(0.0f)
+, delta_transform_(Matrix4::Identity())
+, abs_transform_(Matrix4::Identity())
+{
+  map_search_.reset(new MapSearchAdapter(map_));
+}
+
+template <typename PointT, typename Scalar>
+bool
+ScanToMapRegistration<PointT, Scalar>::registerCloud(const PointCloudConstPtr& cloud,
+                                                     const Matrix4& delta_estimate)
+{
+  assert(registration_);
+
+  // nothing to register against yet
+  if (map_->size() == 0) {
+    delta_transform_ = delta_estimate;
+    abs_transform_ = abs_transform_ * delta_estimate;
+  }
+  else {
+    // The map storage is updated in place, so the target only has to be set once
+    if (!registration_initialized_) {
+      registration_->setSearchMethodTarget(map_search_, true);
+      registration_->setInputTarget(map_->getInputCloud());
+      registration_initialized_ = true;
+    }
+
+    registration_->setInputSource(cloud);
+    {
+      pcl::PointCloud<PointT> p;
+      registration_->align(p, abs_transform_ * delta_estimate);
+    }
+
+    if (!registration_->hasConverged())
+      return (false);
+
+    const Matrix4 abs_transform = registration_->getFinalTransformation();
+    delta_transform_ = abs_transform_.inverse() * abs_transform;
+    abs_transform_ = abs_transform;
+  }
+
+  PointCloud cloud_map;
+  pcl::transformPointCloud(*cloud, cloud_map, abs_transform_);
+  map_->addPoints(cloud_map);
+
+  if (local_map_size_ > 0.0f)
+    trimMap(abs_transform_.template block<3, 1>(0, 3).template cast<float>());
+
+  return (true);
+}
+
+template <typename PointT, typename Scalar>
+void
+ScanToMapRegistration<PointT, Scalar>::trimMap(const Eigen::Vector3f& center)
+{
+  const float half_size = 0.5f * local_map_size_;
+  const Eigen::Vector3f lowest =
+      Eigen::Vector3f::Constant(std::numeric_limits<float>::lowest());
+  const Eigen::Vector3f highest =
+      Eigen::Vector3f::Constant(std::numeric_limits<float>::max());
+
+  // delete the slabs below and above the cube along each axis
+  for (int d = 0; d < 3; ++d) {
+    Eigen::Vector3f max_pt = highest;
+    max_pt[d] = center[d] - half_size;
+    map_->deletePointsInBox(lowest, max_pt);
+
+    Eigen::Vector3f min_pt = lowest;
+    min_pt[d] = center[d] + half_size;
+    map_->deletePointsInBox(min_pt, highest);
+  }
+}
+
+template <typename PointT, typename Scalar>
+inline typename pcl::registration::ScanToMapRegistration<PointT, Scalar>::Matrix4
+ScanToMapRegistration<PointT, Scalar>::getDeltaTransform() const
+{
+  return (delta_transform_);
+}
+
+template <typename PointT, typename Scalar>
+inline typename pcl::registration::ScanToMapRegistration<PointT, Scalar>::Matrix4
+ScanToMapRegistration<PointT, Scalar>::getAbsoluteTransform() const
+{
+  return (abs_transform_);
+}
+
+template <typename PointT, typename Scalar>
+inline void
+ScanToMapRegistration<PointT, Scalar>::reset()
+{
+  // a new (empty) storage; the registration has to be pointed to it again
+  map_->setInputCloud(PointCloudConstPtr(new PointCloud));
+  registration_initialized_ = false;
+  delta_transform_ = abs_transform_ = Matrix4::Identity();
+}
+
+template <typename PointT, typename Scalar>
+inline void
+ScanToMapRegistration<PointT, Scalar>::setRegistration(RegistrationPtr registration)
+{
+  registration_ = registration;
+  registration_initialized_ = false;
+}
+
+} // namespace registration
+} // namespace pcl
+
+#endif /*PCL_REGISTRATION_IMPL_SCAN_TO_MAP_REGISTRATION_HPP_*/
@@ -42,11 +42,25 @@
 #define PCL_REGISTRATION_TRANSFORMATION_ESTIMATION_POINT_TO_PLANE_LLS_HPP_
 
 #include <pcl/cloud_iterator.h>
+#include <pcl/common/execution_context.h>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 namespace pcl {
 
 namespace registration {
 
+template <typename PointSource, typename PointTarget, typename Scalar>
+void
+TransformationEstimationPointToPlaneLLS<PointSource, PointTarget, Scalar>::setNumberOfThreads(
+    unsigned int nr_threads)
+{
+  // 0 is resolved against the budget of pcl::ExecutionContext at compute time
+  threads_ = nr_threads;
+}
+
 template <typename PointSource, typename PointTarget, typename Scalar>
 inline void
 TransformationEstimationPointToPlaneLLS<PointSource, PointTarget, Scalar>::
@@ -172,76 +186,114 @@ TransformationEstimationPointToPlaneLLS<PointSource, PointTarget, Scalar>::
   using Vector6d = Eigen::Matrix<double, 6, 1>;
   using Matrix6d = Eigen::Matrix<double, 6, 6>;
 
-  Matrix6d ATA;
-  Vector6d ATb;
-  ATA.setZero();
-  ATb.setZero();
-
-  // Approximate as a linear least squares problem
+  // Gather the valid correspondences as structure of arrays
+  std::vector<float> src[3], tgt[3], normal[3];
   while (source_it.isValid() && target_it.isValid()) {
-    if (!std::isfinite(source_it->x) || !std::isfinite(source_it->y) ||
-        !std::isfinite(source_it->z) || !std::isfinite(target_it->x) ||
-        !std::isfinite(target_it->y) || !std::isfinite(target_it->z) ||
-        !std::isfinite(target_it->normal_x) || !std::isfinite(target_it->normal_y) ||
-        !std::isfinite(target_it->normal_z)) {
-      ++target_it;
-      ++source_it;
-      continue;
+    if (std::isfinite(source_it->x) && std::isfinite(source_it->y) &&
+        std::isfinite(source_it->z) && std::isfinite(target_it->x) &&
+        std::isfinite(target_it->y) && std::isfinite(target_it->z) &&
+        std::isfinite(target_it->normal_x) && std::isfinite(target_it->normal_y) &&
+        std::isfinite(target_it->normal_z)) {
+      src[0].push_back(source_it->x);
+      src[1].push_back(source_it->y);
+      src[2].push_back(source_it->z);
+      tgt[0].push_back(target_it->x);
+      tgt[1].push_back(target_it->y);
+      tgt[2].push_back(target_it->z);
+      normal[0].push_back(target_it->normal[0]);
+      normal[1].push_back(target_it->normal[1]);
+      normal[2].push_back(target_it->normal[2]);
     }
+    ++target_it;
+    ++source_it;
+  }
 
-    const float& sx = source_it->x;
-    const float& sy = source_it->y;
-    const float& sz = source_it->z;
-    const float& dx = target_it->x;
-    const float& dy = target_it->y;
-    const float& dz = target_it->z;
-    const float& nx = target_it->normal[0];
-    const float& ny = target_it->normal[1];
-    const float& nz = target_it->normal[2];
+  // Approximate as a linear least squares problem. Every thread sums up its own part of
+  // the normal equations, small problems are not worth starting the threads.
+  int nr_points = static_cast<int>(src[0].size());
+  const pcl::ThreadReservation reservation(nr_points < 4096 ? 1u : threads_);
+  const int nr_threads = static_cast<int>(reservation.getNumberOfThreads());
+  std::vector<Matrix6d, Eigen::aligned_allocator<Matrix6d>> thread_ATA(
+      nr_threads, Matrix6d::Zero());
+  std::vector<Vector6d, Eigen::aligned_allocator<Vector6d>> thread_ATb(
+      nr_threads, Vector6d::Zero());
 
-    double a = nz * sy - ny * sz;
-    double b = nx * sz - nz * sx;
-    double c = ny * sx - nx * sy;
+#pragma omp parallel \
+  default(none) \
+  shared(src, tgt, normal, nr_points, thread_ATA, thread_ATb) \
+  num_threads(nr_threads)
+  {
+#ifdef _OPENMP
+    const int thread_id = omp_get_thread_num();
+#else
+    const int thread_id = 0;
+#endif
+    Matrix6d ATA;
+    Vector6d ATb;
+    ATA.setZero();
+    ATb.setZero();
 
-    //    0  1  2  3  4  5
-    //    6  7  8  9 10 11
-    //   12 13 14 15 16 17
-    //   18 19 20 21 22 23
-    //   24 25 26 27 28 29
-    //   30 31 32 33 34 35
+#pragma omp for schedule(static)
+    for (int i = 0; i < nr_points; ++i) {
+      const float& sx = src[0][i];
+      const float& sy = src[1][i];
+      const float& sz = src[2][i];
+      const float& dx = tgt[0][i];
+      const float& dy = tgt[1][i];
+      const float& dz = tgt[2][i];
+      const float& nx = normal[0][i];
+      const float& ny = normal[1][i];
+      const float& nz = normal[2][i];
+      double a = nz * sy - ny * sz;
+      double b = nx * sz - nz * sx;
+      double c = ny * sx - nx * sy;
 
-    ATA.coeffRef(0) += a * a;
-    ATA.coeffRef(1) += a * b;
-    ATA.coeffRef(2) += a * c;
-    ATA.coeffRef(3) += a * nx;
-    ATA.coeffRef(4) += a * ny;
-    ATA.coeffRef(5) += a * nz;
-    ATA.coeffRef(7) += b * b;
-    ATA.coeffRef(8) += b * c;
-    ATA.coeffRef(9) += b * nx;
-    ATA.coeffRef(10) += b * ny;
-    ATA.coeffRef(11) += b * nz;
-    ATA.coeffRef(14) += c * c;
-    ATA.coeffRef(15) += c * nx;
-    ATA.coeffRef(16) += c * ny;
-    ATA.coeffRef(17) += c * nz;
-    ATA.coeffRef(21) += nx * nx;
-    ATA.coeffRef(22) += nx * ny;
-    ATA.coeffRef(23) += nx * nz;
-    ATA.coeffRef(28) += ny * ny;
-    ATA.coeffRef(29) += ny * nz;
-    ATA.coeffRef(35) += nz * nz;
+      //    0  1  2  3  4  5
+      //    6  7  8  9 10 11
+      //   12 13 14 15 16 17
+      //   18 19 20 21 22 23
+      //   24 25 26 27 28 29
+      //   30 31 32 33 34 35
 
-    double d = nx * dx + ny * dy + nz * dz - nx * sx - ny * sy - nz * sz;
-    ATb.coeffRef(0) += a * d;
-    ATb.coeffRef(1) += b * d;
-    ATb.coeffRef(2) += c * d;
-    ATb.coeffRef(3) += nx * d;
-    ATb.coeffRef(4) += ny * d;
-    ATb.coeffRef(5) += nz * d;
+      ATA.coeffRef(0) += a * a;
+      ATA.coeffRef(1) += a * b;
+      ATA.coeffRef(2) += a * c;
+      ATA.coeffRef(3) += a * nx;
+      ATA.coeffRef(4) += a * ny;
+      ATA.coeffRef(5) += a * nz;
+      ATA.coeffRef(7) += b * b;
+      ATA.coeffRef(8) += b * c;
+      ATA.coeffRef(9) += b * nx;
+      ATA.coeffRef(10) += b * ny;
+      ATA.coeffRef(11) += b * nz;
+      ATA.coeffRef(14) += c * c;
+      ATA.coeffRef(15) += c * nx;
+      ATA.coeffRef(16) += c * ny;
+      ATA.coeffRef(17) += c * nz;
+      ATA.coeffRef(21) += nx * nx;
+      ATA.coeffRef(22) += nx * ny;
+      ATA.coeffRef(23) += nx * nz;
+      ATA.coeffRef(28) += ny * ny;
+      ATA.coeffRef(29) += ny * nz;
+      ATA.coeffRef(35) += nz * nz;
 
-    ++target_it;
-    ++source_it;
+      double d = nx * dx + ny * dy + nz * dz - nx * sx - ny * sy - nz * sz;
+      ATb.coeffRef(0) += a * d;
+      ATb.coeffRef(1) += b * d;
+      ATb.coeffRef(2) += c * d;
+      ATb.coeffRef(3) += nx * d;
+      ATb.coeffRef(4) += ny * d;
+      ATb.coeffRef(5) += nz * d;
+    }
+    thread_ATA[thread_id] = ATA;
+    thread_ATb[thread_id] = ATb;
+  }
+
+  Matrix6d ATA = thread_ATA[0];
+  Vector6d ATb = thread_ATb[0];
+  for (int t = 1; t < nr_threads; ++t) {
+    ATA += thread_ATA[t];
+    ATb += thread_ATb[t];
   }
 
   ATA.coeffRef(6) = ATA.coeff(1);
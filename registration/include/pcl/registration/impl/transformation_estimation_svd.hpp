@@ -43,6 +43,8 @@
 
 #include <pcl/common/eigen.h>
 
+#include <algorithm>
+
 namespace pcl {
 
 namespace registration {
@@ -135,23 +137,44 @@ TransformationEstimationSVD<PointSource, PointTarget, Scalar>::
   const int npts = static_cast<int>(source_it.size());
 
   if (use_umeyama_) {
-    Eigen::Matrix<Scalar, 3, Eigen::Dynamic> cloud_src(3, npts);
-    Eigen::Matrix<Scalar, 3, Eigen::Dynamic> cloud_tgt(3, npts);
-
-    for (int i = 0; i < npts; ++i) {
-      cloud_src(0, i) = source_it->x;
-      cloud_src(1, i) = source_it->y;
-      cloud_src(2, i) = source_it->z;
-      ++source_it;
-
-      cloud_tgt(0, i) = target_it->x;
-      cloud_tgt(1, i) = target_it->y;
-      cloud_tgt(2, i) = target_it->z;
-      ++target_it;
+    // Umeyama's method with two passes over the points, one for the centroids and one
+    // for the cross-covariance, which needs no dynamically sized temporaries
+    Scalar centroid[6] = {0, 0, 0, 0, 0, 0};
+    for (int i = 0; i < npts; ++i, ++source_it, ++target_it) {
+      centroid[0] += source_it->x;
+      centroid[1] += source_it->y;
+      centroid[2] += source_it->z;
+      centroid[3] += target_it->x;
+      centroid[4] += target_it->y;
+      centroid[5] += target_it->z;
+    }
+    const Scalar one_over_n = Scalar(1) / static_cast<Scalar>(npts);
+    for (auto& c : centroid)
+      c *= one_over_n;
+
+    source_it.reset();
+    target_it.reset();
+    Scalar covariance[9] = {0, 0, 0, 0, 0, 0, 0, 0, 0};
+    for (int i = 0; i < npts; ++i, ++source_it, ++target_it) {
+      const Scalar src[3] = {source_it->x - centroid[0],
+                             source_it->y - centroid[1],
+                             source_it->z - centroid[2]};
+      const Scalar tgt[3] = {target_it->x - centroid[3],
+                             target_it->y - centroid[4],
+                             target_it->z - centroid[5]};
+      for (int r = 0; r < 3; ++r)
+        for (int c = 0; c < 3; ++c)
+          covariance[r * 3 + c] += tgt[r] * src[c];
     }
 
-    // Call Umeyama directly from Eigen (PCL patched version until Eigen is released)
-    transformation_matrix = pcl::umeyama(cloud_src, cloud_tgt, false);
+    Eigen::Matrix<Scalar, 3, 3> sigma;
+    for (int r = 0; r < 3; ++r)
+      for (int c = 0; c < 3; ++c)
+        sigma(r, c) = covariance[r * 3 + c] * one_over_n;
+    getTransformationFromCovariance(sigma,
+                                    Eigen::Matrix<Scalar, 3, 1>(centroid),
+                                    Eigen::Matrix<Scalar, 3, 1>(centroid + 3),
+                                    transformation_matrix);
   }
   else {
     source_it.reset();
@@ -216,6 +239,112 @@ TransformationEstimationSVD<PointSource, PointTarget, Scalar>::
   transformation_matrix.block(0, 3, 3, 1) = centroid_tgt.head(3) - Rc;
 }
 
+template <typename PointSource, typename PointTarget, typename Scalar>
+void
+TransformationEstimationSVD<PointSource, PointTarget, Scalar>::
+    estimateRigidTransformations(
+        const pcl::PointCloud<PointSource>& cloud_src,
+        const pcl::Indices& indices_src,
+        const pcl::PointCloud<PointTarget>& cloud_tgt,
+        const pcl::Indices& indices_tgt,
+        std::size_t set_size,
+        std::vector<Matrix4, Eigen::aligned_allocator<Matrix4>>& transformation_matrices)
+        const
+{
+  if (!use_umeyama_ || set_size == 0 || indices_src.size() != indices_tgt.size() ||
+      indices_src.size() % set_size != 0) {
+    TransformationEstimation<PointSource, PointTarget, Scalar>::
+        estimateRigidTransformations(cloud_src,
+                                     indices_src,
+                                     cloud_tgt,
+                                     indices_tgt,
+                                     set_size,
+                                     transformation_matrices);
+    return;
+  }
+
+  const std::size_t nr_sets = indices_src.size() / set_size;
+  transformation_matrices.resize(nr_sets);
+  const Scalar one_over_n = Scalar(1) / static_cast<Scalar>(set_size);
+
+  // The sets are processed in blocks. The sums of the sets of a block are stored as
+  // structure of arrays and the inner loops run across the sets, the same operations
+  // as in estimateRigidTransformation are done for every set.
+  constexpr std::size_t block_size = 16;
+  for (std::size_t block_begin = 0; block_begin < nr_sets; block_begin += block_size) {
+    const std::size_t nr_block_sets = std::min(block_size, nr_sets - block_begin);
+    const std::size_t offset = block_begin * set_size;
+
+    Scalar centroid[6][block_size] = {};
+    for (std::size_t i = 0; i < set_size; ++i)
+      for (std::size_t s = 0; s < nr_block_sets; ++s) {
+        const PointSource& src = cloud_src[indices_src[offset + s * set_size + i]];
+        const PointTarget& tgt = cloud_tgt[indices_tgt[offset + s * set_size + i]];
+        centroid[0][s] += src.x;
+        centroid[1][s] += src.y;
+        centroid[2][s] += src.z;
+        centroid[3][s] += tgt.x;
+        centroid[4][s] += tgt.y;
+        centroid[5][s] += tgt.z;
+      }
+    for (auto& c : centroid)
+      for (std::size_t s = 0; s < nr_block_sets; ++s)
+        c[s] *= one_over_n;
+
+    Scalar covariance[9][block_size] = {};
+    for (std::size_t i = 0; i < set_size; ++i)
+      for (std::size_t s = 0; s < nr_block_sets; ++s) {
+        const PointSource& src_pt = cloud_src[indices_src[offset + s * set_size + i]];
+        const PointTarget& tgt_pt = cloud_tgt[indices_tgt[offset + s * set_size + i]];
+        const Scalar src[3] = {src_pt.x - centroid[0][s],
+                               src_pt.y - centroid[1][s],
+                               src_pt.z - centroid[2][s]};
+        const Scalar tgt[3] = {tgt_pt.x - centroid[3][s],
+                               tgt_pt.y - centroid[4][s],
+                               tgt_pt.z - centroid[5][s]};
+        for (int r = 0; r < 3; ++r)
+          for (int c = 0; c < 3; ++c)
+            covariance[r * 3 + c][s] += tgt[r] * src[c];
+      }
+
+    for (std::size_t s = 0; s < nr_block_sets; ++s) {
+      Eigen::Matrix<Scalar, 3, 3> sigma;
+      for (int r = 0; r < 3; ++r)
+        for (int c = 0; c < 3; ++c)
+          sigma(r, c) = covariance[r * 3 + c][s] * one_over_n;
+      getTransformationFromCovariance(
+          sigma,
+          Eigen::Matrix<Scalar, 3, 1>(centroid[0][s], centroid[1][s], centroid[2][s]),
+          Eigen::Matrix<Scalar, 3, 1>(centroid[3][s], centroid[4][s], centroid[5][s]),
+          transformation_matrices[block_begin + s]);
+    }
+  }
+}
+
+template <typename PointSource, typename PointTarget, typename Scalar>
+void
+TransformationEstimationSVD<PointSource, PointTarget, Scalar>::
+    getTransformationFromCovariance(const Eigen::Matrix<Scalar, 3, 3>& covariance,
+                                    const Eigen::Matrix<Scalar, 3, 1>& centroid_src,
+                                    const Eigen::Matrix<Scalar, 3, 1>& centroid_tgt,
+                                    Matrix4& transformation_matrix)
+{
+  Eigen::JacobiSVD<Eigen::Matrix<Scalar, 3, 3>> svd(
+      covariance, Eigen::ComputeFullU | Eigen::ComputeFullV);
+
+  // Reflection correction as in Umeyama's method
+  Eigen::Matrix<Scalar, 3, 1> S = Eigen::Matrix<Scalar, 3, 1>::Ones();
+  if (svd.matrixU().determinant() * svd.matrixV().determinant() < 0)
+    S(2) = -1;
+
+  transformation_matrix.setIdentity();
+  transformation_matrix.template topLeftCorner<3, 3>() =
+      svd.matrixU() * S.asDiagonal() * svd.matrixV().transpose();
+  transformation_matrix.template block<3, 1>(0, 3) =
+      centroid_tgt -
+      transformation_matrix.template topLeftCorner<3, 3>() * centroid_src;
+}
+
 } // namespace registration
 } // namespace pcl
 
@@ -38,11 +38,25 @@
 #pragma once
 
 #include <pcl/cloud_iterator.h>
+#include <pcl/common/execution_context.h>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 namespace pcl {
 
 namespace registration {
 
+template <typename PointSource, typename PointTarget, typename Scalar>
+void
+TransformationEstimationSymmetricPointToPlaneLLS<PointSource, PointTarget, Scalar>::
+    setNumberOfThreads(unsigned int nr_threads)
+{
+  // 0 is resolved against the budget of pcl::ExecutionContext at compute time
+  threads_ = nr_threads;
+}
+
 template <typename PointSource, typename PointTarget, typename Scalar>
 inline void
 TransformationEstimationSymmetricPointToPlaneLLS<PointSource, PointTarget, Scalar>::
@@ -156,16 +170,13 @@ TransformationEstimationSymmetricPointToPlaneLLS<PointSource, PointTarget, Scala
   using Matrix6 = Eigen::Matrix<Scalar, 6, 6>;
   using Vector3 = Eigen::Matrix<Scalar, 3, 1>;
 
-  Matrix6 ATA;
-  Vector6 ATb;
-  ATA.setZero();
-  ATb.setZero();
-  auto M = ATA.template selfadjointView<Eigen::Upper>();
-
-  // Approximate as a linear least squares problem
+  // Gather the valid correspondences as structure of arrays
+  std::vector<Scalar> src[3], tgt[3], normal[3], weights;
+  std::size_t nr_correspondences = 0;
   source_it.reset();
   target_it.reset();
-  for (; source_it.isValid() && target_it.isValid(); ++source_it, ++target_it) {
+  for (; source_it.isValid() && target_it.isValid();
+       ++source_it, ++target_it, ++nr_correspondences) {
     const Vector3 p(source_it->x, source_it->y, source_it->z);
     const Vector3 q(target_it->x, target_it->y, target_it->z);
     const Vector3 n1(source_it->getNormalVector3fMap().template cast<Scalar>());
@@ -186,13 +197,74 @@ TransformationEstimationSymmetricPointToPlaneLLS<PointSource, PointTarget, Scala
       continue;
     }
 
-    Vector6 v;
-    v << (p + q).cross(n), n;
-    M.rankUpdate(v);
+    for (int d = 0; d < 3; ++d) {
+      src[d].push_back(p[d]);
+      tgt[d].push_back(q[d]);
+      normal[d].push_back(n[d]);
+    }
+    weights.push_back(nr_correspondences < weights_.size() ? weights_[nr_correspondences]
+                                                           : Scalar(1));
+  }
 
-    ATb += v * (q - p).dot(n);
+  if (!weights_.empty() && weights_.size() != nr_correspondences) {
+    PCL_ERROR("[pcl::TransformationEstimationSymmetricPointToPlaneLLS::"
+              "estimateRigidTransformation] Number of weights (%zu) differs from "
+              "number of correspondences (%zu)!\n",
+              weights_.size(),
+              nr_correspondences);
+    return;
   }
 
+  // Approximate as a linear least squares problem. Every thread sums up its own part of
+  // the normal equations, small problems are not worth starting the threads.
+  int nr_points = static_cast<int>(src[0].size());
+  const pcl::ThreadReservation reservation(nr_points < 4096 ? 1u : threads_);
+  const int nr_threads = static_cast<int>(reservation.getNumberOfThreads());
+  std::vector<Matrix6, Eigen::aligned_allocator<Matrix6>> thread_ATA(nr_threads,
+                                                                     Matrix6::Zero());
+  std::vector<Vector6, Eigen::aligned_allocator<Vector6>> thread_ATb(nr_threads,
+                                                                     Vector6::Zero());
+
+#pragma omp parallel \
+  default(none) \
+  shared(src, tgt, normal, weights, nr_points, thread_ATA, thread_ATb) \
+  num_threads(nr_threads)
+  {
+#ifdef _OPENMP
+    const int thread_id = omp_get_thread_num();
+#else
+    const int thread_id = 0;
+#endif
+    Matrix6 ATA;
+    Vector6 ATb;
+    ATA.setZero();
+    ATb.setZero();
+    auto M = ATA.template selfadjointView<Eigen::Upper>();
+
+#pragma omp for schedule(static)
+    for (int i = 0; i < nr_points; ++i) {
+      const Vector3 p(src[0][i], src[1][i], src[2][i]);
+      const Vector3 q(tgt[0][i], tgt[1][i], tgt[2][i]);
+      const Vector3 n(normal[0][i], normal[1][i], normal[2][i]);
+
+      Vector6 v;
+      v << (p + q).cross(n), n;
+      M.rankUpdate(v, weights[i]);
+
+      ATb += v * ((q - p).dot(n) * weights[i]);
+    }
+    thread_ATA[thread_id] = ATA;
+    thread_ATb[thread_id] = ATb;
+  }
+
+  Matrix6 ATA = thread_ATA[0];
+  Vector6 ATb = thread_ATb[0];
+  for (int t = 1; t < nr_threads; ++t) {
+    ATA += thread_ATA[t];
+    ATb += thread_ATb[t];
+  }
+  auto M = ATA.template selfadjointView<Eigen::Upper>();
+
   // Solve A*x = b
   const Vector6 x = M.ldlt().solve(ATb);
 
@@ -130,6 +130,7 @@ public:
   {
     IterativeClosestPoint<PointSource, PointTarget, Scalar>();
     reg_name_ = "JointIterativeClosestPoint";
+    threads_ = 1;
   };
 
   /** \brief Empty destructor */
@@ -224,6 +225,22 @@ public:
     correspondence_estimations_.clear();
   }
 
+  /** \brief Set the number of threads used to process the source/target pairs. The
+   * correspondences of each pair are estimated concurrently, then merged in pair order,
+   * so the result does not depend on the number of threads.
+   * \param[in] nr_threads the number of hardware threads to use (0 takes as many as
+   * the budget of pcl::ExecutionContext allows when aligning)
+   */
+  void
+  setNumberOfThreads(unsigned int nr_threads = 0);
+
+  /** \brief Get the number of threads used to process the source/target pairs. */
+  inline unsigned int
+  getNumberOfThreads() const
+  {
+    return (threads_);
+  }
+
 protected:
   /** \brief Rigid transformation computation method  with initial guess.
    * \param output the transformed input point cloud dataset using the rigid
@@ -241,6 +258,9 @@ protected:
   std::vector<PointCloudSourceConstPtr> sources_;
   std::vector<PointCloudTargetConstPtr> targets_;
   std::vector<CorrespondenceEstimationPtr> correspondence_estimations_;
+
+  /** \brief The number of threads used to process the source/target pairs. */
+  unsigned int threads_;
 };
 
 } // namespace pcl
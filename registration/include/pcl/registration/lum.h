@@ -139,7 +139,10 @@ public:
 
   /** \brief Empty constructor.
    */
-  LUM() : slam_graph_(new SLAMGraph), max_iterations_(5), convergence_threshold_(0.0) {}
+  LUM() : slam_graph_(new SLAMGraph), max_iterations_(5), convergence_threshold_(0.0)
+  {
+    setNumberOfThreads();
+  }
 
   /** \brief Set the internal SLAM graph structure.
    * \details All data used and produced by LUM is stored in this boost::adjacency_list.
@@ -201,6 +204,13 @@ public:
   inline float
   getConvergenceThreshold() const;
 
+  /** \brief Set the number of threads used to linearize the edges of the SLAM graph.
+   * \param[in] nr_threads the number of hardware threads to use (0 takes as many as the
+   * budget of pcl::ExecutionContext allows when linearizing the edges)
+   */
+  void
+  setNumberOfThreads(unsigned int nr_threads = 0);
+
   /** \brief Add a new point cloud to the SLAM graph.
    * \details This method will add a new vertex to the SLAM graph and attach a point
    * cloud to that vertex. Optionally you can specify a pose estimate for this point
@@ -347,6 +357,9 @@ private:
 
   /** \brief The convergence threshold for the summed vector lengths of all poses. */
   float convergence_threshold_;
+
+  /** \brief The number of threads the scheduler should use. */
+  unsigned int threads_;
 };
 } // namespace registration
 } // namespace pcl
@@ -89,6 +89,16 @@ public:
   using ConstPtr =
       shared_ptr<const NormalDistributionsTransform<PointSource, PointTarget>>;
 
+  /** \brief The method used to find the target voxels contributing to the score of a
+   * transformed source point.
+   *
+   * KDTREE performs a radius search of resolution_ over the voxel centroids. The
+   * DIRECT methods look up the voxel containing the point in the voxel structure and,
+   * for DIRECT26 and DIRECT7, its 26 surrounding respectively 6 face neighbors. They do
+   * not require a kd-tree over the voxel centroids.
+   */
+  enum class NeighborSearchMethod { KDTREE, DIRECT26, DIRECT7, DIRECT1 };
+
   /** \brief Constructor.
    * Sets \ref outlier_ratio_ to 0.35, \ref step_size_ to 0.05 and \ref resolution_
    * to 1.0
@@ -168,6 +178,41 @@ public:
     outlier_ratio_ = outlier_ratio;
   }
 
+  /** \brief Set the method used to find the target voxels around a transformed
+   * source point.
+   * \param[in] method the neighbor search method (default: KDTREE)
+   */
+  inline void
+  setNeighborhoodSearchMethod(NeighborSearchMethod method)
+  {
+    if (search_method_ != method) {
+      search_method_ = method;
+      updateRelativeCoordinates();
+      // The kd-tree over the voxel centroids is only built when it is needed
+      if (target_) {
+        init();
+      }
+    }
+  }
+
+  /** \brief Get the method used to find the target voxels around a transformed
+   * source point.
+   * \return the neighbor search method
+   */
+  inline NeighborSearchMethod
+  getNeighborhoodSearchMethod() const
+  {
+    return search_method_;
+  }
+
+  /** \brief Initialize the scheduler and set the number of threads to use for the
+   * computation of the score, its gradient and its hessian.
+   * \param nr_threads the number of hardware threads to use (0 takes as many as the
+   * budget of pcl::ExecutionContext allows when registering)
+   */
+  void
+  setNumberOfThreads(unsigned int nr_threads = 0);
+
   /** \brief Get the registration alignment probability.
    * \return transformation probability
    */
@@ -253,10 +298,26 @@ protected:
   {
     target_cells_.setLeafSize(resolution_, resolution_, resolution_);
     target_cells_.setInputCloud(target_);
-    // Initiate voxel structure.
-    target_cells_.filter(true);
+    // Initiate voxel structure, the kd-tree is only needed for radius searches.
+    target_cells_.filter(search_method_ == NeighborSearchMethod::KDTREE);
   }
 
+  /** \brief Update the voxel offsets searched by the DIRECT neighbor search methods. */
+  void
+  updateRelativeCoordinates();
+
+  /** \brief Find the target voxels contributing to the score of a transformed point,
+   * according to the neighbor search method.
+   * \param[in] x_trans_pt the transformed source point
+   * \param[out] neighborhood the voxels found
+   * \param[out] distances squared distances to the voxel centroids, only filled by the
+   * KDTREE method
+   */
+  void
+  getNeighborhood(const PointSource& x_trans_pt,
+                  std::vector<TargetGridLeafConstPtr>& neighborhood,
+                  std::vector<float>& distances) const;
+
   /** \brief Compute derivatives of probability function w.r.t. the transformation
    * vector. \note Equation 6.10, 6.12 and 6.13 [Magnusson 2009]. \param[out]
    * score_gradient the gradient vector of the probability function w.r.t. the
@@ -287,6 +348,36 @@ protected:
                     Eigen::Matrix<double, 6, 6>& hessian,
                     const Eigen::Vector3d& x_trans,
                     const Eigen::Matrix3d& c_inv,
+                    bool compute_hessian = true) const
+  {
+    return updateDerivatives(score_gradient,
+                             hessian,
+                             point_jacobian_,
+                             point_hessian_,
+                             x_trans,
+                             c_inv,
+                             compute_hessian);
+  }
+
+  /** \brief Compute individual point contirbutions to derivatives of probability
+   * function w.r.t. the transformation vector, using the given point derivatives.
+   * \param[in,out] score_gradient the gradient vector of the probability function
+   * w.r.t. the transformation vector \param[in,out] hessian the hessian matrix of the
+   * probability function w.r.t. the transformation vector \param[in] point_jacobian
+   * the first order derivative of the point transformation, \f$ J_E \f$ \param[in]
+   * point_hessian the second order derivative of the point transformation, \f$ H_E
+   * \f$ \param[in] x_trans transformed point minus mean of occupied covariance voxel
+   * \param[in] c_inv covariance of occupied covariance voxel
+   * \param[in] compute_hessian flag to calculate hessian, unnessissary for step
+   * calculation.
+   */
+  double
+  updateDerivatives(Eigen::Matrix<double, 6, 1>& score_gradient,
+                    Eigen::Matrix<double, 6, 6>& hessian,
+                    const Eigen::Matrix<double, 3, 6>& point_jacobian,
+                    const Eigen::Matrix<double, 18, 6>& point_hessian,
+                    const Eigen::Vector3d& x_trans,
+                    const Eigen::Matrix3d& c_inv,
                     bool compute_hessian = true) const;
 
   /** \brief Precompute anglular components of derivatives.
@@ -306,7 +397,26 @@ protected:
    * calculation.
    */
   void
-  computePointDerivatives(const Eigen::Vector3d& x, bool compute_hessian = true);
+  computePointDerivatives(const Eigen::Vector3d& x, bool compute_hessian = true)
+  {
+    computePointDerivatives(x, point_jacobian_, point_hessian_, compute_hessian);
+  }
+
+  /** \brief Compute point derivatives into the given matrices.
+   * \note Equation 6.18-21 [Magnusson 2009].
+   * \param[in] x point from the input cloud
+   * \param[in,out] point_jacobian the first order derivative of the point
+   * transformation, only the angular columns are written
+   * \param[in,out] point_hessian the second order derivative of the point
+   * transformation, only the angular blocks are written
+   * \param[in] compute_hessian flag to calculate hessian, unnessissary for step
+   * calculation.
+   */
+  void
+  computePointDerivatives(const Eigen::Vector3d& x,
+                          Eigen::Matrix<double, 3, 6>& point_jacobian,
+                          Eigen::Matrix<double, 18, 6>& point_hessian,
+                          bool compute_hessian = true) const;
 
   /** \brief Compute hessian of probability function w.r.t. the transformation vector.
    * \note Equation 6.13 [Magnusson 2009].
@@ -341,6 +451,26 @@ protected:
    */
   void
   updateHessian(Eigen::Matrix<double, 6, 6>& hessian,
+                const Eigen::Vector3d& x_trans,
+                const Eigen::Matrix3d& c_inv) const
+  {
+    updateHessian(hessian, point_jacobian_, point_hessian_, x_trans, c_inv);
+  }
+
+  /** \brief Compute individual point contirbutions to hessian of probability function
+   * w.r.t. the transformation vector, using the given point derivatives.
+   * \note Equation 6.13 [Magnusson 2009].
+   * \param[in,out] hessian the hessian matrix of the probability function w.r.t. the
+   * transformation vector \param[in] point_jacobian the first order derivative of the
+   * point transformation, \f$ J_E \f$ \param[in] point_hessian the second order
+   * derivative of the point transformation, \f$ H_E \f$ \param[in] x_trans
+   * transformed point minus mean of occupied covariance voxel \param[in] c_inv
+   * covariance of occupied covariance voxel
+   */
+  void
+  updateHessian(Eigen::Matrix<double, 6, 6>& hessian,
+                const Eigen::Matrix<double, 3, 6>& point_jacobian,
+                const Eigen::Matrix<double, 18, 6>& point_hessian,
                 const Eigen::Vector3d& x_trans,
                 const Eigen::Matrix3d& c_inv) const;
 
@@ -509,6 +639,15 @@ protected:
    * transform vector, \f$ H_E \f$ in Equation 6.20 [Magnusson 2009]. */
   Eigen::Matrix<double, 18, 6> point_hessian_;
 
+  /** \brief The method used to find the target voxels around a transformed point. */
+  NeighborSearchMethod search_method_;
+
+  /** \brief The voxel offsets searched by the DIRECT neighbor search methods. */
+  Eigen::Matrix<int, 3, Eigen::Dynamic> relative_coordinates_;
+
+  /** \brief The number of threads the scheduler should use. */
+  unsigned int threads_;
+
 public:
   PCL_MAKE_ALIGNED_OPERATOR_NEW
 };
@@ -91,14 +91,16 @@ public:
   PPFHashMapSearch(float angle_discretization_step = 12.0f / 180.0f *
                                                      static_cast<float>(M_PI),
                    float distance_discretization_step = 0.01f)
-  : feature_hash_map_(new FeatureHashMapType)
-  , internals_initialized_(false)
+  : internals_initialized_(false)
   , angle_discretization_step_(angle_discretization_step)
   , distance_discretization_step_(distance_discretization_step)
   , max_dist_(-1.0f)
   {}
 
   /** \brief Method that sets the feature cloud to be inserted in the hash map
+   * \note The discretized features are stored in a sorted table (compressed sparse
+   * row layout): the distinct keys in one array and the model pairs of each key
+   * contiguously in another one, which is much more compact than a node based hash map.
    * \param feature_cloud a const smart pointer to the PPFSignature feature cloud
    */
   void
@@ -111,13 +113,14 @@ public:
    * describing the query PPFSignature feature \param indices a vector of pair indices
    * representing the feature pairs that have been found in the bin corresponding to the
    * query feature
+   * \note The search does not modify the data structure and can be called concurrently.
    */
   void
   nearestNeighborSearch(float& f1,
                         float& f2,
                         float& f3,
                         float& f4,
-                        std::vector<std::pair<std::size_t, std::size_t>>& indices);
+                        std::vector<std::pair<std::size_t, std::size_t>>& indices) const;
 
   /** \brief Convenience method for returning a copy of the class instance as a
    * shared_ptr */
@@ -154,7 +157,19 @@ public:
   std::vector<std::vector<float>> alpha_m_;
 
 private:
-  FeatureHashMapTypePtr feature_hash_map_;
+  /** \brief Distinct discretized features of the model pairs, sorted. */
+  std::vector<HashKeyStruct> keys_;
+
+  /** \brief The pairs with the feature keys_[k] are stored in pair_indices_ from
+   * key_offsets_[k] to key_offsets_[k + 1] (excluded). */
+  std::vector<std::size_t> key_offsets_;
+
+  /** \brief Model pairs (i, j), stored as i * nr_model_points_ + j and grouped by key. */
+  std::vector<std::size_t> pair_indices_;
+
+  /** \brief Number of model points the feature cloud was computed for. */
+  std::size_t nr_model_points_{0};
+
   bool internals_initialized_;
 
   float angle_discretization_step_, distance_discretization_step_;
@@ -214,7 +229,9 @@ public:
   , scene_reference_point_sampling_rate_(5)
   , clustering_position_diff_threshold_(0.01f)
   , clustering_rotation_diff_threshold_(20.0f / 180.0f * static_cast<float>(M_PI))
-  {}
+  {
+    setNumberOfThreads();
+  }
 
   /** \brief Method for setting the position difference clustering parameter
    * \param clustering_position_diff_threshold distance threshold below which two poses
@@ -292,6 +309,13 @@ public:
     return search_method_;
   }
 
+  /** \brief Set the number of threads used to vote for the scene reference points.
+   * \param[in] nr_threads the number of hardware threads to use (0 takes as many as the
+   * budget of pcl::ExecutionContext allows when voting)
+   */
+  void
+  setNumberOfThreads(unsigned int nr_threads = 0);
+
   /** \brief Provide a pointer to the input target (e.g., the point cloud that we want
    * to align the input source to) \param cloud the input point cloud target
    */
@@ -317,6 +341,9 @@ private:
    * algorithm) */
   float clustering_position_diff_threshold_, clustering_rotation_diff_threshold_;
 
+  /** \brief The number of threads the scheduler should use. */
+  unsigned int threads_;
+
   /** \brief use a kd-tree with range searches of range max_dist to skip an O(N) pass
    * through the point cloud */
   typename pcl::KdTreeFLANN<PointTarget>::Ptr scene_search_tree_;
@@ -0,0 +1,205 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#pragma once
+
+#include <pcl/registration/icp.h>
+#include <pcl/registration/registration.h>
+#include <pcl/point_cloud.h>
+
+#include <vector>
+
+namespace pcl {
+namespace registration {
+
+/** \brief Coarse to fine @ref IterativeClosestPoint on a cached target pyramid.
+ *
+ * Each level of the pyramid aligns a voxel grid downsampled copy of the source to a
+ * voxel grid downsampled copy of the target, starting from the transformation found
+ * by the previous (coarser) level. A level with a leaf size of 0 uses the clouds at
+ * full resolution. The downsampled targets and their search trees are built once,
+ * when the target or the levels change, so aligning many source clouds against a
+ * static target only pays for the pyramid construction on the first call.
+ *
+ * \code
+ * PyramidICP<PointXYZ, PointXYZ> picp;
+ * picp.addLevel (0.2f, 10, 1.0);  // coarsest level
+ * picp.addLevel (0.05f, 10, 0.25);
+ * picp.addLevel (0.0f, 20, 0.1);  // full resolution
+ * picp.setInputTarget (map);
+ *
+ * while (true){
+ *   picp.setInputSource (scan);
+ *   picp.align (aligned, guess);
+ *   guess = picp.getFinalTransformation ();
+ * }
+ * \endcode
+ *
+ * \note The iteration limit and correspondence distance of the PyramidICP object
+ * itself are not used, they are given per level.
+ * \ingroup registration
+ */
+template <typename PointSource, typename PointTarget, typename Scalar = float>
+class PyramidICP : public Registration<PointSource, PointTarget, Scalar> {
+public:
+  using PointCloudSource =
+      typename Registration<PointSource, PointTarget, Scalar>::PointCloudSource;
+  using PointCloudSourcePtr = typename PointCloudSource::Ptr;
+  using PointCloudSourceConstPtr = typename PointCloudSource::ConstPtr;
+
+  using PointCloudTarget =
+      typename Registration<PointSource, PointTarget, Scalar>::PointCloudTarget;
+  using PointCloudTargetPtr = typename PointCloudTarget::Ptr;
+  using PointCloudTargetConstPtr = typename PointCloudTarget::ConstPtr;
+
+  using KdTree = typename Registration<PointSource, PointTarget, Scalar>::KdTree;
+  using KdTreePtr = typename Registration<PointSource, PointTarget, Scalar>::KdTreePtr;
+
+  using LevelRegistration = IterativeClosestPoint<PointSource, PointTarget, Scalar>;
+  using LevelRegistrationPtr = typename LevelRegistration::Ptr;
+
+  using Matrix4 = typename Registration<PointSource, PointTarget, Scalar>::Matrix4;
+
+  using Ptr = shared_ptr<PyramidICP<PointSource, PointTarget, Scalar>>;
+  using ConstPtr = shared_ptr<const PyramidICP<PointSource, PointTarget, Scalar>>;
+
+  /** \brief Empty constructor. */
+  PyramidICP() : pyramid_updated_(false) { reg_name_ = "PyramidICP"; }
+
+  /** \brief Empty destructor */
+  ~PyramidICP() {}
+
+  /** \brief Provide a pointer to the input target (e.g., the point cloud that we want
+   * to align the input source to). The target pyramid is rebuilt on the next call to
+   * align. \param[in] cloud the input point cloud target
+   */
+  void
+  setInputTarget(const PointCloudTargetConstPtr& cloud) override
+  {
+    Registration<PointSource, PointTarget, Scalar>::setInputTarget(cloud);
+    pyramid_updated_ = false;
+  }
+
+  /** \brief Append a level to the pyramid. Levels are processed in the order they are
+   * added, so they should be added from coarse to fine.
+   * \param[in] leaf_size the voxel grid leaf size of the level, 0 to use the clouds at
+   * full resolution
+   * \param[in] max_iterations the maximum number of ICP iterations of the level
+   * \param[in] max_correspondence_distance the maximum distance between two
+   * correspondences of the level
+   */
+  void
+  addLevel(float leaf_size, int max_iterations, double max_correspondence_distance);
+
+  /** \brief Remove all levels. */
+  inline void
+  clearLevels()
+  {
+    levels_.clear();
+    pyramid_updated_ = false;
+  }
+
+  /** \brief Get the number of levels of the pyramid. */
+  inline std::size_t
+  getNumberOfLevels() const
+  {
+    return (levels_.size());
+  }
+
+  /** \brief Get the ICP object of a level, e.g. to set its convergence thresholds,
+   * correspondence rejectors or the number of threads of its correspondence
+   * estimation. \param[in] level the index of the level, 0 being the coarsest
+   */
+  inline LevelRegistrationPtr
+  getLevelRegistration(std::size_t level) const
+  {
+    return (levels_[level].registration);
+  }
+
+  /** \brief Get the target cloud of a level, or a null pointer if the pyramid has not
+   * been built yet. \param[in] level the index of the level, 0 being the coarsest
+   */
+  inline PointCloudTargetConstPtr
+  getLevelTarget(std::size_t level) const
+  {
+    return (levels_[level].target);
+  }
+
+protected:
+  using Registration<PointSource, PointTarget, Scalar>::reg_name_;
+  using Registration<PointSource, PointTarget, Scalar>::getClassName;
+  using Registration<PointSource, PointTarget, Scalar>::input_;
+  using Registration<PointSource, PointTarget, Scalar>::indices_;
+  using Registration<PointSource, PointTarget, Scalar>::target_;
+  using Registration<PointSource, PointTarget, Scalar>::tree_;
+  using Registration<PointSource, PointTarget, Scalar>::nr_iterations_;
+  using Registration<PointSource, PointTarget, Scalar>::final_transformation_;
+  using Registration<PointSource, PointTarget, Scalar>::transformation_;
+  using Registration<PointSource, PointTarget, Scalar>::converged_;
+
+  /** \brief A level of the pyramid. */
+  struct Level {
+    /** \brief The voxel grid leaf size, 0 for full resolution. */
+    float leaf_size;
+    /** \brief The ICP object aligning the source to the target of this level. */
+    LevelRegistrationPtr registration;
+    /** \brief The (downsampled) target of this level. */
+    PointCloudTargetConstPtr target;
+  };
+
+  /** \brief Build the (downsampled) targets and search trees of all levels. */
+  void
+  buildTargetPyramid();
+
+  /** \brief Align the source level by level.
+   * \param[out] output the resultant input transformed point cloud dataset
+   * \param[in] guess the initial gross estimation of the transformation
+   */
+  void
+  computeTransformation(PointCloudSource& output, const Matrix4& guess) override;
+
+  /** \brief The levels of the pyramid, from coarse to fine. */
+  std::vector<Level> levels_;
+
+  /** \brief Whether the targets of the levels are up to date. */
+  bool pyramid_updated_;
+};
+
+} // namespace registration
+} // namespace pcl
+
+#include <pcl/registration/impl/pyramid_icp.hpp>
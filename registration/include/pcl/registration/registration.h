@@ -44,6 +44,7 @@
 #include <pcl/registration/correspondence_estimation.h>
 #include <pcl/registration/correspondence_rejection.h>
 #include <pcl/registration/transformation_estimation.h>
+#include <pcl/common/trace.h>
 #include <pcl/search/kdtree.h>
 #include <pcl/memory.h>
 #include <pcl/pcl_base.h>
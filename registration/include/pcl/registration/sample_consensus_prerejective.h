@@ -126,6 +126,7 @@ public:
   , feature_tree_(new pcl::KdTreeFLANN<FeatureT>)
   , correspondence_rejector_poly_(new CorrespondenceRejectorPoly)
   , inlier_fraction_(0.0f)
+  , threads_(1)
   {
     reg_name_ = "SampleConsensusPrerejective";
     correspondence_rejector_poly_->setSimilarityThreshold(0.6f);
@@ -246,6 +247,16 @@ public:
     return inliers_;
   }
 
+  /** \brief Set the number of threads used to generate and score pose hypotheses.
+   * With more than one thread every thread draws its samples from its own random
+   * stream, seeded from std::rand (), so results are reproducible for a given seed and
+   * thread count. A single thread keeps the sequential std::rand () sampling.
+   * \param[in] nr_threads the number of hardware threads to use (0 takes as many as the
+   * budget of pcl::ExecutionContext allows when sampling)
+   */
+  void
+  setNumberOfThreads(unsigned int nr_threads = 0);
+
 protected:
   /** \brief Choose a random index between 0 and n-1
    * \param n the number of possible indices to choose from
@@ -279,6 +290,36 @@ protected:
                       std::vector<pcl::Indices>& similar_features,
                       pcl::Indices& corresponding_indices);
 
+  /** \brief Select \a nr_samples sample points from cloud, drawing random indices from
+   * \a random_index.
+   * \param[in] cloud the input point cloud
+   * \param[in] nr_samples the number of samples to select
+   * \param[out] sample_indices the resulting sample indices
+   * \param[in] random_index callable returning a random index in [0, n) for a given n
+   */
+  template <typename RandomIndexFunctor>
+  void
+  selectSamples(const PointCloudSource& cloud,
+                int nr_samples,
+                pcl::Indices& sample_indices,
+                const RandomIndexFunctor& random_index) const;
+
+  /** \brief Find the target correspondences of the sample points, drawing random
+   * indices from \a random_index. The cache is only written for entries that are
+   * still empty, so it can be shared between threads once it is filled.
+   * \param[in] sample_indices the indices of each sample point
+   * \param[in,out] similar_features correspondence cache
+   * \param[out] corresponding_indices the resulting indices of each sample's
+   * corresponding point in the target cloud
+   * \param[in] random_index callable returning a random index in [0, n) for a given n
+   */
+  template <typename RandomIndexFunctor>
+  void
+  findSimilarFeatures(const pcl::Indices& sample_indices,
+                      std::vector<pcl::Indices>& similar_features,
+                      pcl::Indices& corresponding_indices,
+                      const RandomIndexFunctor& random_index) const;
+
   /** \brief Rigid transformation computation method.
    * \param output the transformed input point cloud dataset using the rigid
    * transformation found \param guess The computed transformation
@@ -298,6 +339,26 @@ protected:
   void
   getFitness(pcl::Indices& inliers, float& fitness_score);
 
+  /** \brief Obtain the fitness of a pose hypothesis without transforming the whole
+   * input cloud first, giving up as soon as the number of outliers shows that the
+   * required inlier fraction can no longer be reached.
+   * \param[in] transformation the pose hypothesis
+   * \param[in] evaluation_order the order in which the input points are scored; a
+   * random order lets bad hypotheses exceed the bound after only a few points
+   * \param[in] max_outliers the largest number of outliers an accepted hypothesis can
+   * have
+   * \param[out] nr_inliers the number of inliers
+   * \param[out] fitness_score the MSE of the inliers
+   * \return false if the evaluation stopped because there are more than
+   * \a max_outliers outliers
+   */
+  bool
+  getFitness(const Matrix4& transformation,
+             const pcl::Indices& evaluation_order,
+             std::size_t max_outliers,
+             std::size_t& nr_inliers,
+             float& fitness_score) const;
+
   /** \brief The source point cloud's feature descriptors. */
   FeatureCloudConstPtr input_features_;
 
@@ -323,6 +384,9 @@ protected:
 
   /** \brief Inlier points of final transformation as indices into source */
   pcl::Indices inliers_;
+
+  /** \brief The number of threads the scheduler should use. */
+  unsigned int threads_;
 };
 } // namespace pcl
 
@@ -0,0 +1,253 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#pragma once
+
+#include <pcl/registration/registration.h>
+#include <pcl/search/incremental_kdtree.h>
+#include <pcl/search/kdtree.h>
+#include <pcl/point_cloud.h>
+
+namespace pcl {
+namespace registration {
+
+/** \brief Scan-to-map registration of a stream of clouds.
+ *
+ * Unlike @ref IncrementalRegistration, which aligns each cloud to the previous one,
+ * this class aligns each cloud to a local map built from all the clouds registered
+ * so far. The map is kept in a search::IncrementalKdTree: registered clouds are
+ * inserted into it (optionally downsampled to one point per voxel of
+ * \ref setMapLeafSize), and the points farther than half of \ref setLocalMapSize
+ * from the current position are deleted, so the map slides along with the sensor.
+ *
+ * The map is given to the registration object once, as its target search method
+ * with force_no_recompute, and updated in place afterwards. No search structure over
+ * the target is rebuilt when a cloud is registered.
+ *
+ * \code
+ * IterativeClosestPoint<PointXYZ,PointXYZ>::Ptr icp
+ *   (new IterativeClosestPoint<PointXYZ,PointXYZ>);
+ * icp->setMaxCorrespondenceDistance (0.5);
+ * icp->setMaximumIterations (30);
+ *
+ * ScanToMapRegistration<PointXYZ> s2m;
+ * s2m.setRegistration (icp);
+ * s2m.setMapLeafSize (0.2f);
+ * s2m.setLocalMapSize (100.0f);
+ *
+ * while (true){
+ *   PointCloud<PointXYZ>::Ptr cloud (new PointCloud<PointXYZ>);
+ *   read_cloud (*cloud);
+ *   s2m.registerCloud (cloud);
+ *   write_pose (s2m.getAbsoluteTransform ());
+ * }
+ * \endcode
+ *
+ * \note The registration object must only access the target through its search
+ * method and the correspondences it returns (e.g. IterativeClosestPoint and its
+ * point-to-plane variants). Registration methods that preprocess the whole target,
+ * such as GeneralizedIterativeClosestPoint, are not supported.
+ * \ingroup registration
+ */
+template <typename PointT, typename Scalar = float>
+class ScanToMapRegistration {
+public:
+  using PointCloud = pcl::PointCloud<PointT>;
+  using PointCloudPtr = typename PointCloud::Ptr;
+  using PointCloudConstPtr = typename PointCloud::ConstPtr;
+
+  using RegistrationPtr = typename pcl::Registration<PointT, PointT, Scalar>::Ptr;
+  using Matrix4 = typename pcl::Registration<PointT, PointT, Scalar>::Matrix4;
+
+  using MapSearch = pcl::search::IncrementalKdTree<PointT>;
+  using MapSearchPtr = typename MapSearch::Ptr;
+
+  ScanToMapRegistration();
+
+  /** \brief Empty destructor */
+  virtual ~ScanToMapRegistration() {}
+
+  /** \brief Register a new point cloud against the local map and insert it into the
+   * map.
+   * \note You have to set a valid registration object with @ref setRegistration
+   * before using this.
+   * \param[in] cloud point cloud to register
+   * \param[in] delta_estimate estimated transform between the last registered cloud
+   * and this one
+   * \return true if registration converged; a cloud registered while the map is empty
+   * (e.g. the first one) is placed at the estimate and always converges
+   */
+  bool
+  registerCloud(const PointCloudConstPtr& cloud,
+                const Matrix4& delta_estimate = Matrix4::Identity());
+
+  /** \brief Get estimated transform between the last two registered clouds */
+  inline Matrix4
+  getDeltaTransform() const;
+
+  /** \brief Get estimated overall transform */
+  inline Matrix4
+  getAbsoluteTransform() const;
+
+  /** \brief Clear the map and the transforms without resetting registration_ */
+  inline void
+  reset();
+
+  /** \brief Set registration instance used to align clouds to the map */
+  inline void setRegistration(RegistrationPtr);
+
+  /** \brief Set the edge length of the cube centered at the current position that
+   * bounds the local map (0, the default, keeps the whole map).
+   */
+  inline void
+  setLocalMapSize(float size)
+  {
+    local_map_size_ = size;
+  }
+
+  /** \brief Get the edge length of the cube bounding the local map. */
+  inline float
+  getLocalMapSize() const
+  {
+    return (local_map_size_);
+  }
+
+  /** \brief Set the voxel size the map is downsampled to on insertion (0, the
+   * default, keeps all points).
+   */
+  inline void
+  setMapLeafSize(float leaf_size)
+  {
+    map_->setDownsampleOnInsert(leaf_size > 0.0f);
+    map_->setDownsampleLeafSize(leaf_size);
+  }
+
+  /** \brief Get the voxel size the map is downsampled to on insertion. */
+  inline float
+  getMapLeafSize() const
+  {
+    return (map_->getDownsampleOnInsert() ? map_->getDownsampleLeafSize() : 0.0f);
+  }
+
+  /** \brief Get the local map. Its input cloud also holds the storage of deleted
+   * points; use its search methods or \ref getMapSize to access the current map.
+   */
+  inline MapSearchPtr
+  getMap() const
+  {
+    return (map_);
+  }
+
+  /** \brief Get the number of points in the local map. */
+  inline std::size_t
+  getMapSize() const
+  {
+    return (map_->size());
+  }
+
+protected:
+  /** \brief Adapter exposing the local map through the search::KdTree interface
+   * expected by pcl::Registration. The map indexes itself, so setting the input
+   * cloud does not build anything.
+   */
+  class MapSearchAdapter : public pcl::search::KdTree<PointT> {
+  public:
+    using pcl::search::KdTree<PointT>::nearestKSearch;
+    using pcl::search::KdTree<PointT>::radiusSearch;
+
+    MapSearchAdapter(const MapSearchPtr& map) : map_(map) {}
+
+    void
+    setInputCloud(const PointCloudConstPtr& cloud,
+                  const IndicesConstPtr& indices = IndicesConstPtr()) override
+    {
+      pcl::search::Search<PointT>::setInputCloud(cloud, indices);
+    }
+
+    int
+    nearestKSearch(const PointT& point,
+                   int k,
+                   Indices& k_indices,
+                   std::vector<float>& k_sqr_distances) const override
+    {
+      return (map_->nearestKSearch(point, k, k_indices, k_sqr_distances));
+    }
+
+    int
+    radiusSearch(const PointT& point,
+                 double radius,
+                 Indices& k_indices,
+                 std::vector<float>& k_sqr_distances,
+                 unsigned int max_nn = 0) const override
+    {
+      return (map_->radiusSearch(point, radius, k_indices, k_sqr_distances, max_nn));
+    }
+
+  private:
+    MapSearchPtr map_;
+  };
+
+  /** \brief Delete the map points outside the cube of \a local_map_size_ around
+   * \a center.
+   */
+  void
+  trimMap(const Eigen::Vector3f& center);
+
+  /** \brief registration instance to align clouds */
+  RegistrationPtr registration_;
+
+  /** \brief whether registration_ uses the map as its target */
+  bool registration_initialized_;
+
+  /** \brief the local map */
+  MapSearchPtr map_;
+
+  /** \brief the local map as the target search method of registration_ */
+  typename pcl::search::KdTree<PointT>::Ptr map_search_;
+
+  /** \brief edge length of the cube bounding the local map */
+  float local_map_size_;
+
+  /** \brief estimated transforms */
+  Matrix4 delta_transform_;
+  Matrix4 abs_transform_;
+};
+
+} // namespace registration
+} // namespace pcl
+
+#include <pcl/registration/impl/scan_to_map_registration.hpp>
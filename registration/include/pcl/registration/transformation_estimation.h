@@ -44,6 +44,9 @@
 #include <pcl/registration/correspondence_types.h>
 #include <pcl/correspondence.h>
 
+#include <algorithm>
+#include <vector>
+
 namespace pcl {
 namespace registration {
 /** \brief TransformationEstimation represents the base class for methods for
@@ -115,6 +118,51 @@ public:
                               const pcl::Correspondences& correspondences,
                               Matrix4& transformation_matrix) const = 0;
 
+  /** \brief Estimate the rigid transformations of several small correspondence sets at
+   * once, e.g. the hypotheses of a RANSAC loop.
+   * \details The sets are stored one after the other in \a indices_src and \a
+   * indices_tgt, every set consists of \a set_size correspondences. The default
+   * implementation calls estimateRigidTransformation for every set, estimators can
+   * override it with a batched computation.
+   * \param[in] cloud_src the source point cloud dataset
+   * \param[in] indices_src the source indices of all sets
+   * \param[in] cloud_tgt the target point cloud dataset
+   * \param[in] indices_tgt the target indices of all sets
+   * \param[in] set_size the number of correspondences per set
+   * \param[out] transformation_matrices the resultant transformation matrix per set
+   */
+  virtual void
+  estimateRigidTransformations(
+      const pcl::PointCloud<PointSource>& cloud_src,
+      const pcl::Indices& indices_src,
+      const pcl::PointCloud<PointTarget>& cloud_tgt,
+      const pcl::Indices& indices_tgt,
+      std::size_t set_size,
+      std::vector<Matrix4, Eigen::aligned_allocator<Matrix4>>& transformation_matrices)
+      const
+  {
+    transformation_matrices.clear();
+    if (set_size == 0 || indices_src.size() != indices_tgt.size() ||
+        indices_src.size() % set_size != 0) {
+      PCL_ERROR("[pcl::TransformationEstimation::estimateRigidTransformations] The "
+                "number of source (%zu) and target (%zu) indices has to be the same "
+                "multiple of the set size (%zu)!\n",
+                indices_src.size(),
+                indices_tgt.size(),
+                set_size);
+      return;
+    }
+
+    transformation_matrices.resize(indices_src.size() / set_size);
+    pcl::Indices set_src(set_size), set_tgt(set_size);
+    for (std::size_t s = 0; s < transformation_matrices.size(); ++s) {
+      std::copy_n(indices_src.begin() + s * set_size, set_size, set_src.begin());
+      std::copy_n(indices_tgt.begin() + s * set_size, set_size, set_tgt.begin());
+      estimateRigidTransformation(
+          cloud_src, set_src, cloud_tgt, set_tgt, transformation_matrices[s]);
+    }
+  }
+
   using Ptr = shared_ptr<TransformationEstimation<PointSource, PointTarget, Scalar>>;
   using ConstPtr =
       shared_ptr<const TransformationEstimation<PointSource, PointTarget, Scalar>>;
@@ -71,7 +71,7 @@ public:
   using Matrix4 =
       typename TransformationEstimation<PointSource, PointTarget, Scalar>::Matrix4;
 
-  TransformationEstimationPointToPlaneLLS(){};
+  TransformationEstimationPointToPlaneLLS() { setNumberOfThreads(); };
   ~TransformationEstimationPointToPlaneLLS(){};
 
   /** \brief Estimate a rigid rotation transformation between a source and a target
@@ -125,6 +125,13 @@ public:
                               const pcl::Correspondences& correspondences,
                               Matrix4& transformation_matrix) const override;
 
+  /** \brief Set the number of threads used to build the normal equations.
+   * \param[in] nr_threads the number of hardware threads to use (0 takes as many as the
+   * budget of pcl::ExecutionContext allows when building the normal equations)
+   */
+  void
+  setNumberOfThreads(unsigned int nr_threads = 0);
+
 protected:
   /** \brief Estimate a rigid rotation transformation between a source and a target
    * \param[in] source_it an iterator over the source point cloud dataset
@@ -150,6 +157,9 @@ protected:
                                 const double& ty,
                                 const double& tz,
                                 Matrix4& transformation_matrix) const;
+
+  /** \brief The number of threads the scheduler should use. */
+  unsigned int threads_;
 };
 } // namespace registration
 } // namespace pcl
@@ -121,6 +121,31 @@ public:
                               const pcl::Correspondences& correspondences,
                               Matrix4& transformation_matrix) const override;
 
+  /** \brief Estimate the rigid transformations of several small correspondence sets at
+   * once, e.g. the hypotheses of a RANSAC loop.
+   * \details The sets are stored one after the other in \a indices_src and \a
+   * indices_tgt, every set consists of \a set_size correspondences. With Umeyama the
+   * sets are processed in blocks whose centroids and covariance matrices are stored as
+   * structure of arrays, so that the loops over the sets of a block can be vectorized.
+   * Only fixed-size temporaries are used. Without Umeyama every set is estimated on its
+   * own.
+   * \param[in] cloud_src the source point cloud dataset
+   * \param[in] indices_src the source indices of all sets
+   * \param[in] cloud_tgt the target point cloud dataset
+   * \param[in] indices_tgt the target indices of all sets
+   * \param[in] set_size the number of correspondences per set
+   * \param[out] transformation_matrices the resultant transformation matrix per set
+   */
+  void
+  estimateRigidTransformations(
+      const pcl::PointCloud<PointSource>& cloud_src,
+      const pcl::Indices& indices_src,
+      const pcl::PointCloud<PointTarget>& cloud_tgt,
+      const pcl::Indices& indices_tgt,
+      std::size_t set_size,
+      std::vector<Matrix4, Eigen::aligned_allocator<Matrix4>>& transformation_matrices)
+      const override;
+
 protected:
   /** \brief Estimate a rigid rotation transformation between a source and a target
    * \param[in] source_it an iterator over the source point cloud dataset
@@ -147,6 +172,19 @@ protected:
       const Eigen::Matrix<Scalar, 4, 1>& centroid_tgt,
       Matrix4& transformation_matrix) const;
 
+  /** \brief Obtain a 4x4 rigid transformation matrix from the cross-covariance matrix of
+   * the demeaned target and source points as in Umeyama's method.
+   * \param[in] covariance the cross-covariance matrix, sum of tgt * src' over n
+   * \param[in] centroid_src the source centroid
+   * \param[in] centroid_tgt the target centroid
+   * \param[out] transformation_matrix the resultant 4x4 rigid transformation matrix
+   */
+  static void
+  getTransformationFromCovariance(const Eigen::Matrix<Scalar, 3, 3>& covariance,
+                                  const Eigen::Matrix<Scalar, 3, 1>& centroid_src,
+                                  const Eigen::Matrix<Scalar, 3, 1>& centroid_tgt,
+                                  Matrix4& transformation_matrix);
+
   bool use_umeyama_;
 };
 
@@ -72,7 +72,10 @@ public:
   using Vector6 = Eigen::Matrix<Scalar, 6, 1>;
 
   TransformationEstimationSymmetricPointToPlaneLLS()
-  : enforce_same_direction_normals_(true){};
+  : enforce_same_direction_normals_(true)
+  {
+    setNumberOfThreads();
+  };
   ~TransformationEstimationSymmetricPointToPlaneLLS(){};
 
   /** \brief Estimate a rigid rotation transformation between a source and a target
@@ -139,6 +142,24 @@ public:
   inline bool
   getEnforceSameDirectionNormals();
 
+  /** \brief Set the weights of the squared residuals of the correspondences.
+   * \details The weights are used in the order of the correspondences, an empty vector
+   * weighs all correspondences equally.
+   * \param[in] weights the weight of each correspondence
+   */
+  inline void
+  setCorrespondenceWeights(const std::vector<Scalar>& weights)
+  {
+    weights_ = weights;
+  }
+
+  /** \brief Set the number of threads used to build the normal equations.
+   * \param[in] nr_threads the number of hardware threads to use (0 takes as many as the
+   * budget of pcl::ExecutionContext allows when building the normal equations)
+   */
+  void
+  setNumberOfThreads(unsigned int nr_threads = 0);
+
 protected:
   /** \brief Estimate a rigid rotation transformation between a source and a target
    * \param[in] source_it an iterator over the source point cloud dataset
@@ -162,6 +183,12 @@ protected:
   /** \brief Whether or not to negate source and/or target normals such that they point
    * in the same direction */
   bool enforce_same_direction_normals_;
+
+  /** \brief The weights of the correspondences, empty for equal weights. */
+  std::vector<Scalar> weights_;
+
+  /** \brief The number of threads the scheduler should use. */
+  unsigned int threads_;
 };
 } // namespace registration
 } // namespace pcl
@@ -0,0 +1,188 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include <pcl/registration/correspondence_rejection_fused.h>
+#include <pcl/common/execution_context.h>
+#include <pcl/pcl_base.h> // for UNAVAILABLE
+
+#include <algorithm>
+#include <cstdint>
+
+namespace {
+/** \brief Stable in-place removal of the correspondences not marked in \a keep. */
+void
+compactCorrespondences(pcl::Correspondences& correspondences,
+                       const std::vector<std::uint8_t>& keep)
+{
+  std::size_t number_valid_correspondences = 0;
+  for (std::size_t i = 0; i < correspondences.size(); ++i) {
+    if (!keep[i])
+      continue;
+    if (number_valid_correspondences != i)
+      correspondences[number_valid_correspondences] = correspondences[i];
+    ++number_valid_correspondences;
+  }
+  correspondences.resize(number_valid_correspondences);
+}
+} // namespace
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+void
+pcl::registration::CorrespondenceRejectorFused::setNumberOfThreads(
+    unsigned int nr_threads)
+{
+  // 0 is resolved against the budget of pcl::ExecutionContext at compute time
+  threads_ = nr_threads;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+void
+pcl::registration::CorrespondenceRejectorFused::getRemainingCorrespondences(
+    const pcl::Correspondences& original_correspondences,
+    pcl::Correspondences& remaining_correspondences)
+{
+  remaining_correspondences = original_correspondences;
+  rejectInPlace(remaining_correspondences);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+void
+pcl::registration::CorrespondenceRejectorFused::rejectInPlace(
+    pcl::Correspondences& correspondences)
+{
+  std::vector<Predicate> pending;
+  for (const auto& stage : stages_) {
+    switch (stage.type) {
+    case StageType::PREDICATE:
+      pending.push_back(stage.predicate);
+      break;
+    case StageType::MEDIAN_DISTANCE: {
+      applyPredicates(pending, correspondences);
+      if (correspondences.empty())
+        break;
+      std::vector<double> dists(correspondences.size());
+      for (std::size_t i = 0; i < correspondences.size(); ++i)
+        dists[i] = correspondences[i].distance;
+      std::nth_element(dists.begin(), dists.begin() + (dists.size() / 2), dists.end());
+      median_distance_ = dists[dists.size() / 2];
+      const double max_distance = median_distance_ * stage.factor;
+      pending.push_back([max_distance](const pcl::Correspondence& corr) {
+        return (corr.distance <= max_distance);
+      });
+      break;
+    }
+    case StageType::ONE_TO_ONE:
+      applyPredicates(pending, correspondences);
+      applyOneToOne(correspondences);
+      break;
+    case StageType::REJECTOR: {
+      applyPredicates(pending, correspondences);
+      pcl::Correspondences remaining;
+      stage.rejector->getRemainingCorrespondences(correspondences, remaining);
+      correspondences.swap(remaining);
+      break;
+    }
+    }
+  }
+  applyPredicates(pending, correspondences);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+void
+pcl::registration::CorrespondenceRejectorFused::applyPredicates(
+    std::vector<Predicate>& predicates, pcl::Correspondences& correspondences)
+{
+  if (predicates.empty())
+    return;
+
+  std::vector<std::uint8_t> keep(correspondences.size());
+  std::ptrdiff_t nr_correspondences =
+      static_cast<std::ptrdiff_t>(correspondences.size());
+  const pcl::ThreadReservation reservation(threads_);
+  const unsigned int threads = reservation.getNumberOfThreads();
+#pragma omp parallel for \
+  default(none) \
+  shared(predicates, correspondences, keep, nr_correspondences) \
+  schedule(static) \
+  num_threads(threads)
+  for (std::ptrdiff_t i = 0; i < nr_correspondences; ++i) {
+    bool valid = true;
+    for (const auto& predicate : predicates) {
+      if (!predicate(correspondences[i])) {
+        valid = false;
+        break;
+      }
+    }
+    keep[i] = valid;
+  }
+
+  compactCorrespondences(correspondences, keep);
+  predicates.clear();
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+void
+pcl::registration::CorrespondenceRejectorFused::applyOneToOne(
+    pcl::Correspondences& correspondences)
+{
+  const auto is_valid = [](pcl::index_t match) {
+    return (match >= 0 && match != UNAVAILABLE);
+  };
+
+  pcl::index_t max_match = 0;
+  for (const auto& corr : correspondences)
+    if (is_valid(corr.index_match))
+      max_match = std::max(max_match, corr.index_match);
+
+  // index of the closest correspondence per match index
+  std::vector<pcl::index_t> best(max_match + 1, UNAVAILABLE);
+  for (std::size_t i = 0; i < correspondences.size(); ++i) {
+    const pcl::index_t match = correspondences[i].index_match;
+    if (!is_valid(match))
+      continue;
+    if (best[match] == UNAVAILABLE ||
+        correspondences[i].distance < correspondences[best[match]].distance)
+      best[match] = static_cast<pcl::index_t>(i);
+  }
+
+  std::vector<std::uint8_t> keep(correspondences.size());
+  for (std::size_t i = 0; i < correspondences.size(); ++i) {
+    const pcl::index_t match = correspondences[i].index_match;
+    keep[i] = is_valid(match) && best[match] == static_cast<pcl::index_t>(i);
+  }
+  compactCorrespondences(correspondences, keep);
+}
@@ -37,6 +37,7 @@
  */
 
 #include <pcl/registration/gicp6d.h>
+#include <pcl/common/execution_context.h>
 #include <pcl/memory.h>                 // for pcl::make_shared
 #include <pcl/point_types_conversion.h> // for PointXYZRGBtoXYZLAB
 
@@ -61,9 +62,7 @@ GeneralizedIterativeClosestPoint6D::setInputSource(
 
   // in addition, convert colors of the cloud to CIELAB
   cloud_lab_->resize(cloud->size());
-  for (std::size_t point_idx = 0; point_idx < cloud->size(); ++point_idx) {
-    PointXYZRGBtoXYZLAB((*cloud)[point_idx], (*cloud_lab_)[point_idx]);
-  }
+  convertToLab(*cloud, *cloud_lab_);
 }
 
 void
@@ -75,9 +74,7 @@ GeneralizedIterativeClosestPoint6D::setInputTarget(
 
   // in addition, convert colors of the cloud to CIELAB...
   target_lab_->resize(target->size());
-  for (std::size_t point_idx = 0; point_idx < target->size(); ++point_idx) {
-    PointXYZRGBtoXYZLAB((*target)[point_idx], (*target_lab_)[point_idx]);
-  }
+  convertToLab(*target, *target_lab_);
 
   // ...and build 6d-tree
   target_tree_lab_.setInputCloud(target_lab_);
@@ -85,10 +82,25 @@ GeneralizedIterativeClosestPoint6D::setInputTarget(
       pcl::make_shared<MyPointRepresentation>(point_rep_));
 }
 
+void
+GeneralizedIterativeClosestPoint6D::convertToLab(
+    const PointCloudSource& cloud, pcl::PointCloud<PointXYZLAB>& lab) const
+{
+  // the conversion is independent per point and dominated by the cube roots, so it
+  // scales with the number of threads
+  auto size = static_cast<std::ptrdiff_t>(cloud.size());
+  const pcl::ThreadReservation reservation(threads_);
+  const unsigned int threads = reservation.getNumberOfThreads();
+#pragma omp parallel for default(none) shared(cloud, lab, size) schedule(static)       \
+    num_threads(threads)
+  for (std::ptrdiff_t point_idx = 0; point_idx < size; ++point_idx) {
+    PointXYZRGBtoXYZLAB(cloud[point_idx], lab[point_idx]);
+  }
+}
+
 bool
-GeneralizedIterativeClosestPoint6D::searchForNeighbors(const PointXYZLAB& query,
-                                                       pcl::Indices& index,
-                                                       std::vector<float>& distance)
+GeneralizedIterativeClosestPoint6D::searchForNeighbors(
+    const PointXYZLAB& query, pcl::Indices& index, std::vector<float>& distance) const
 {
   int k = target_tree_lab_.nearestKSearch(query, 1, index, distance);
 
@@ -130,7 +142,10 @@ GeneralizedIterativeClosestPoint6D::computeTransformation(PointCloudSource& outp
   double dist_threshold = corr_dist_threshold_ * corr_dist_threshold_;
   pcl::Indices nn_indices(1);
   std::vector<float> nn_dists(1);
+  std::vector<index_t> target_match;
 
+  const pcl::ThreadReservation reservation(threads_);
+  const unsigned int threads = reservation.getNumberOfThreads();
   while (!converged_) {
     std::size_t cnt = 0;
     pcl::Indices source_indices(indices_->size());
@@ -145,18 +160,23 @@ GeneralizedIterativeClosestPoint6D::computeTransformation(PointCloudSource& outp
 
     Eigen::Matrix3d R = transform_R.topLeftCorner<3, 3>();
 
-    for (std::size_t i = 0; i < N; i++) {
+    // Search the 6D correspondences and update the Mahalanobis matrices in parallel,
+    // then gather the valid ones in index order
+    target_match.assign(N, -1);
+    int failed_index = -1;
+#pragma omp parallel for default(none)                                                 \
+    shared(guess, R, dist_threshold, target_match, failed_index, N)                    \
+    firstprivate(nn_indices, nn_dists) num_threads(threads)
+    for (std::ptrdiff_t i = 0; i < static_cast<std::ptrdiff_t>(N); i++) {
       // MODIFICATION: take point from the CIELAB cloud instead
       PointXYZLAB query = (*cloud_lab_)[i];
       query.getVector4fMap() = guess * query.getVector4fMap();
       query.getVector4fMap() = transformation_ * query.getVector4fMap();
 
       if (!searchForNeighbors(query, nn_indices, nn_dists)) {
-        PCL_ERROR("[pcl::%s::computeTransformation] Unable to find a nearest neighbor "
-                  "in the target dataset for point %d in the source!\n",
-                  getClassName().c_str(),
-                  (*indices_)[i]);
-        return;
+#pragma omp critical(gicp6d_failed_index)
+        failed_index = (*indices_)[i];
+        continue;
       }
 
       // Check if the distance to the nearest neighbor is smaller than the user imposed
@@ -172,11 +192,23 @@ GeneralizedIterativeClosestPoint6D::computeTransformation(PointCloudSource& outp
         temp += C2;
         // M = temp^-1
         M = temp.inverse();
-        source_indices[cnt] = static_cast<int>(i);
-        target_indices[cnt] = nn_indices[0];
-        cnt++;
+        target_match[i] = nn_indices[0];
       }
     }
+    if (failed_index >= 0) {
+      PCL_ERROR("[pcl::%s::computeTransformation] Unable to find a nearest neighbor "
+                "in the target dataset for point %d in the source!\n",
+                getClassName().c_str(),
+                failed_index);
+      return;
+    }
+    for (std::size_t i = 0; i < N; i++) {
+      if (target_match[i] < 0)
+        continue;
+      source_indices[cnt] = static_cast<int>(i);
+      target_indices[cnt] = target_match[i];
+      cnt++;
+    }
     // Resize to the actual number of valid correspondences
     source_indices.resize(cnt);
     target_indices.resize(cnt);
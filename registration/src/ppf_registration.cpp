@@ -38,6 +38,8 @@
 
 #include <pcl/registration/ppf_registration.h>
 
+#include <algorithm>
+
 //#ifndef PCL_NO_PRECOMPILE
 //#include <pcl/point_types.h>
 //#include <pcl/impl/instantiate.hpp>
@@ -50,36 +52,46 @@ void
 pcl::PPFHashMapSearch::setInputFeatureCloud(
     PointCloud<PPFSignature>::ConstPtr feature_cloud)
 {
-  // Discretize the feature cloud and insert it in the hash map
-  feature_hash_map_->clear();
+  // Discretize the feature cloud
   unsigned int n =
       static_cast<unsigned int>(std::sqrt(static_cast<float>(feature_cloud->size())));
-  int d1, d2, d3, d4;
   max_dist_ = -1.0;
   alpha_m_.resize(n);
+  std::vector<std::pair<HashKeyStruct, std::size_t>> entries(std::size_t(n) * n);
   for (std::size_t i = 0; i < n; ++i) {
     std::vector<float> alpha_m_row(n);
     for (std::size_t j = 0; j < n; ++j) {
-      d1 = static_cast<int>(
-          std::floor((*feature_cloud)[i * n + j].f1 / angle_discretization_step_));
-      d2 = static_cast<int>(
-          std::floor((*feature_cloud)[i * n + j].f2 / angle_discretization_step_));
-      d3 = static_cast<int>(
-          std::floor((*feature_cloud)[i * n + j].f3 / angle_discretization_step_));
-      d4 = static_cast<int>(
-          std::floor((*feature_cloud)[i * n + j].f4 / distance_discretization_step_));
-      feature_hash_map_->insert(
-          std::pair<HashKeyStruct, std::pair<std::size_t, std::size_t>>(
-              HashKeyStruct(d1, d2, d3, d4),
-              std::pair<std::size_t, std::size_t>(i, j)));
-      alpha_m_row[j] = (*feature_cloud)[i * n + j].alpha_m;
+      const PPFSignature& feature = (*feature_cloud)[i * n + j];
+      const int d1 = static_cast<int>(std::floor(feature.f1 / angle_discretization_step_));
+      const int d2 = static_cast<int>(std::floor(feature.f2 / angle_discretization_step_));
+      const int d3 = static_cast<int>(std::floor(feature.f3 / angle_discretization_step_));
+      const int d4 =
+          static_cast<int>(std::floor(feature.f4 / distance_discretization_step_));
+      entries[i * n + j] = {HashKeyStruct(d1, d2, d3, d4), i * n + j};
+      alpha_m_row[j] = feature.alpha_m;
 
-      if (max_dist_ < (*feature_cloud)[i * n + j].f4)
-        max_dist_ = (*feature_cloud)[i * n + j].f4;
+      if (max_dist_ < feature.f4)
+        max_dist_ = feature.f4;
     }
     alpha_m_[i] = alpha_m_row;
   }
 
+  // Group the pairs by key
+  std::sort(entries.begin(), entries.end());
+
+  nr_model_points_ = n;
+  keys_.clear();
+  key_offsets_.clear();
+  pair_indices_.resize(entries.size());
+  for (std::size_t e = 0; e < entries.size(); ++e) {
+    if (keys_.empty() || keys_.back() != entries[e].first) {
+      keys_.push_back(entries[e].first);
+      key_offsets_.push_back(e);
+    }
+    pair_indices_[e] = entries[e].second;
+  }
+  key_offsets_.push_back(entries.size());
+
   internals_initialized_ = true;
 }
 
@@ -90,7 +102,7 @@ pcl::PPFHashMapSearch::nearestNeighborSearch(
     float& f2,
     float& f3,
     float& f4,
-    std::vector<std::pair<std::size_t, std::size_t>>& indices)
+    std::vector<std::pair<std::size_t, std::size_t>>& indices) const
 {
   if (!internals_initialized_) {
     PCL_ERROR("[pcl::PPFRegistration::nearestNeighborSearch]: input feature cloud has "
@@ -104,9 +116,13 @@ pcl::PPFHashMapSearch::nearestNeighborSearch(
       d4 = static_cast<int>(std::floor(f4 / distance_discretization_step_));
 
   indices.clear();
-  HashKeyStruct key = HashKeyStruct(d1, d2, d3, d4);
-  auto map_iterator_pair = feature_hash_map_->equal_range(key);
-  for (; map_iterator_pair.first != map_iterator_pair.second; ++map_iterator_pair.first)
-    indices.emplace_back(map_iterator_pair.first->second.first,
-                         map_iterator_pair.first->second.second);
+  const HashKeyStruct key = HashKeyStruct(d1, d2, d3, d4);
+  const auto key_it = std::lower_bound(keys_.begin(), keys_.end(), key);
+  if (key_it == keys_.end() || *key_it != key)
+    return;
+
+  const std::size_t k = key_it - keys_.begin();
+  for (std::size_t p = key_offsets_[k]; p < key_offsets_[k + 1]; ++p)
+    indices.emplace_back(pair_indices_[p] / nr_model_points_,
+                         pair_indices_[p] % nr_model_points_);
 }
@@ -43,6 +43,7 @@
 
 #include <pcl/sample_consensus/lmeds.h>
 #include <pcl/common/common.h> // for computeMedian
+#include <pcl/common/execution_context.h>
 
 //////////////////////////////////////////////////////////////////////////
 template <typename PointT> bool
@@ -58,76 +59,89 @@ pcl::LeastMedianSquares<PointT>::computeModel (int debug_verbosity_level)
   iterations_ = 0;
   double d_best_penalty = std::numeric_limits<double>::max();
 
-  Indices selection;
-  Eigen::VectorXf model_coefficients (sac_model_->getModelSize ());
   std::vector<double> distances;
 
   unsigned skipped_count = 0;
   // suppress infinite loops by just allowing 10 x maximum allowed iterations for invalid model parameters!
   const unsigned max_skip = max_iterations_ * 10;
-  
+
+  // Hypotheses are drawn serially, in batches of one per thread, then scored concurrently and
+  // processed in the order they were drawn. This gives the same model for any number of threads.
+  // The threads are taken from the budget of pcl::ExecutionContext. Every thread reuses its
+  // distance buffer, the median is found with nth_element in computeMedian.
+  const pcl::ThreadReservation reservation (threads_ >= 0 ? static_cast<unsigned int> (threads_) : 1u);
+  const std::size_t batch_size = reservation.getNumberOfThreads ();
+  std::vector<Indices> samples;
+  std::vector<Eigen::VectorXf> hypotheses;
+  std::vector<std::vector<double> > batch_distances (batch_size);
+  std::vector<double> penalties (batch_size);
+  const bool is_dense = sac_model_->getInputCloud ()->is_dense;
+
   // Iterate
-  while ((iterations_ < max_iterations_) && (skipped_count < max_skip))
+  bool done = false;
+  while (!done && (iterations_ < max_iterations_) && (skipped_count < max_skip))
   {
     // Get X samples which satisfy the model criteria
-    sac_model_->getSamples (iterations_, selection);
-
-    if (selection.empty ())
+    bool no_samples;
+    const std::size_t nr_hypotheses = this->drawHypotheses (batch_size, max_skip, skipped_count, samples, hypotheses, no_samples);
+    if (no_samples)
     {
       PCL_ERROR ("[pcl::LeastMedianSquares::computeModel] No samples could be selected!\n");
-      break;
-    }
-
-    // Search for inliers in the point cloud for the current plane model M
-    if (!sac_model_->computeModelCoefficients (selection, model_coefficients))
-    {
-      //iterations_++;
-      ++skipped_count;
-      PCL_DEBUG ("[pcl::LeastMedianSquares::computeModel] The function computeModelCoefficients failed, so continue with next iteration.\n");
-      continue;
-    }
-
-    double d_cur_penalty;
-    // d_cur_penalty = sum (min (dist, threshold))
-
-    // Iterate through the 3d points and calculate the distances from them to the model
-    sac_model_->getDistancesToModel (model_coefficients, distances);
-    
-    // No distances? The model must not respect the user given constraints
-    if (distances.empty ())
-    {
-      //iterations_++;
-      ++skipped_count;
-      continue;
+      done = true;
     }
-    // Move all NaNs in distances to the end
-    const auto new_end = (sac_model_->getInputCloud()->is_dense ? distances.end() : std::partition (distances.begin(), distances.end(), [](double d){return !std::isnan (d);}));
-    const auto nr_valid_dists = std::distance (distances.begin (), new_end);
 
-    // d_cur_penalty = median (distances)
-    PCL_DEBUG ("[pcl::LeastMedianSquares::computeModel] There are %lu valid distances remaining after removing NaN values.\n", nr_valid_dists);
-    if (nr_valid_dists == 0)
+#pragma omp parallel for \
+  default(none) \
+  shared(batch_distances, hypotheses, penalties) \
+  firstprivate(is_dense, nr_hypotheses) \
+  num_threads(batch_size)
+    for (std::ptrdiff_t h = 0; h < static_cast<std::ptrdiff_t> (nr_hypotheses); ++h)
     {
-      //iterations_++;
-      ++skipped_count;
-      continue;
-    }
-    d_cur_penalty = pcl::computeMedian (distances.begin (), new_end, static_cast<double(*)(double)>(std::sqrt));
-
-    // Better match ?
-    if (d_cur_penalty < d_best_penalty)
-    {
-      d_best_penalty = d_cur_penalty;
-
-      // Save the current model/coefficients selection as being the best so far
-      model_              = selection;
-      model_coefficients_ = model_coefficients;
+      // Iterate through the 3d points and calculate the distances from them to the model
+      std::vector<double> &cur_distances = batch_distances[h];
+      sac_model_->getDistancesToModel (hypotheses[h], cur_distances);
+
+      // Move all NaNs in distances to the end
+      const auto new_end = (is_dense ? cur_distances.end() : std::partition (cur_distances.begin(), cur_distances.end(), [](double d){return !std::isnan (d);}));
+      // No valid distances? The model must not respect the user given constraints
+      if (new_end == cur_distances.begin ())
+      {
+        penalties[h] = std::numeric_limits<double>::quiet_NaN ();
+        continue;
+      }
+
+      // d_cur_penalty = median (distances)
+      penalties[h] = pcl::computeMedian (cur_distances.begin (), new_end, static_cast<double(*)(double)>(std::sqrt));
     }
 
-    ++iterations_;
-    if (debug_verbosity_level > 1)
+    for (std::size_t h = 0; h < nr_hypotheses; ++h)
     {
-      PCL_DEBUG ("[pcl::LeastMedianSquares::computeModel] Trial %d out of %d. Best penalty is %f.\n", iterations_, max_iterations_, d_best_penalty);
+      if (std::isnan (penalties[h]))
+      {
+        //iterations_++;
+        ++skipped_count;
+        PCL_DEBUG ("[pcl::LeastMedianSquares::computeModel] No valid distances to the model, so continue with next iteration.\n");
+        continue;
+      }
+
+      // Better match ?
+      if (penalties[h] < d_best_penalty)
+      {
+        d_best_penalty = penalties[h];
+
+        // Save the current model/coefficients selection as being the best so far
+        model_              = samples[h];
+        model_coefficients_ = hypotheses[h];
+      }
+
+      ++iterations_;
+      if (debug_verbosity_level > 1)
+      {
+        PCL_DEBUG ("[pcl::LeastMedianSquares::computeModel] Trial %d out of %d. Best penalty is %f.\n", iterations_, max_iterations_, d_best_penalty);
+      }
+      // The remaining hypotheses of the batch would not have been drawn
+      if (iterations_ >= max_iterations_)
+        break;
     }
   }
 
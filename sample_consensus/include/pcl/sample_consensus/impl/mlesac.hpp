@@ -42,6 +42,7 @@
 #define PCL_SAMPLE_CONSENSUS_IMPL_MLESAC_H_
 
 #include <pcl/sample_consensus/mlesac.h>
+#include <pcl/common/execution_context.h>
 #include <cfloat> // for FLT_MAX
 #include <pcl/common/common.h> // for computeMedian
 
@@ -60,8 +61,6 @@ pcl::MaximumLikelihoodSampleConsensus<PointT>::computeModel (int debug_verbosity
   double d_best_penalty = std::numeric_limits<double>::max();
   double k = 1.0;
 
-  Indices selection;
-  Eigen::VectorXf model_coefficients (sac_model_->getModelSize ());
   std::vector<double> distances;
 
   // Compute sigma - remember to set threshold_ correctly !
@@ -75,100 +74,125 @@ pcl::MaximumLikelihoodSampleConsensus<PointT>::computeModel (int debug_verbosity
   Eigen::Vector4f min_pt, max_pt;
   getMinMax (sac_model_->getInputCloud (), sac_model_->getIndices (), min_pt, max_pt);
   max_pt -= min_pt;
-  double v = sqrt (max_pt.dot (max_pt));
+  const double v = sqrt (max_pt.dot (max_pt));
 
   int n_inliers_count = 0;
-  std::size_t indices_size;
+  const std::size_t indices_size = sac_model_->getIndices ()->size ();
   unsigned skipped_count = 0;
   // suppress infinite loops by just allowing 10 x maximum allowed iterations for invalid model parameters!
   const unsigned max_skip = max_iterations_ * 10;
-  
+
+  // Hypotheses are drawn serially, in batches of one per thread, then scored concurrently and
+  // processed in the order they were drawn. This gives the same model for any number of threads.
+  // The threads are taken from the budget of pcl::ExecutionContext.
+  const pcl::ThreadReservation reservation (threads_ >= 0 ? static_cast<unsigned int> (threads_) : 1u);
+  const std::size_t batch_size = reservation.getNumberOfThreads ();
+  std::vector<Indices> samples;
+  std::vector<Eigen::VectorXf> hypotheses;
+  std::vector<std::vector<double> > batch_distances (batch_size);
+  std::vector<std::vector<double> > batch_p_inlier_prob (batch_size);
+  std::vector<double> penalties (batch_size);
+  std::vector<int> inlier_counts (batch_size);
+
   // Iterate
-  while (iterations_ < k && skipped_count < max_skip)
+  bool done = false;
+  while (!done && iterations_ < k && skipped_count < max_skip)
   {
     // Get X samples which satisfy the model criteria
-    sac_model_->getSamples (iterations_, selection);
-
-    if (selection.empty ()) break;
-
-    // Search for inliers in the point cloud for the current plane model M
-    if (!sac_model_->computeModelCoefficients (selection, model_coefficients))
-    {
-      //iterations_++;
-      ++ skipped_count;
-      continue;
-    }
-
-    // Iterate through the 3d points and calculate the distances from them to the model
-    sac_model_->getDistancesToModel (model_coefficients, distances);
-
-    if (distances.empty ())
-    {
-      //iterations_++;
-      ++skipped_count;
-      continue;
-    }
-    
-    // Use Expectation-Maximization to find out the right value for d_cur_penalty
-    // ---[ Initial estimate for the gamma mixing parameter = 1/2
-    double gamma = 0.5;
-    double p_outlier_prob = 0;
-
-    indices_size = sac_model_->getIndices ()->size ();
-    std::vector<double> p_inlier_prob (indices_size);
-    for (int j = 0; j < iterations_EM_; ++j)
+    bool no_samples;
+    const std::size_t nr_hypotheses = this->drawHypotheses (batch_size, max_skip, skipped_count, samples, hypotheses, no_samples);
+    done = no_samples;
+
+#pragma omp parallel for \
+  default(none) \
+  shared(batch_distances, batch_p_inlier_prob, hypotheses, inlier_counts, penalties) \
+  firstprivate(dist_scaling_factor, indices_size, normalization_factor, nr_hypotheses, v) \
+  num_threads(batch_size)
+    for (std::ptrdiff_t h = 0; h < static_cast<std::ptrdiff_t> (nr_hypotheses); ++h)
     {
-      const double weighted_normalization_factor = gamma * normalization_factor;
-      // Likelihood of a datum given that it is an inlier
+      // Iterate through the 3d points and calculate the distances from them to the model
+      std::vector<double> &cur_distances = batch_distances[h];
+      sac_model_->getDistancesToModel (hypotheses[h], cur_distances);
+      if (cur_distances.empty ())
+        continue;
+
+      // Use Expectation-Maximization to find out the right value for d_cur_penalty
+      // ---[ Initial estimate for the gamma mixing parameter = 1/2
+      double gamma = 0.5;
+      double p_outlier_prob = 0;
+
+      std::vector<double> &p_inlier_prob = batch_p_inlier_prob[h];
+      p_inlier_prob.resize (indices_size);
+      for (int j = 0; j < iterations_EM_; ++j)
+      {
+        const double weighted_normalization_factor = gamma * normalization_factor;
+        // Likelihood of a datum given that it is an inlier
+        for (std::size_t i = 0; i < indices_size; ++i)
+          p_inlier_prob[i] = weighted_normalization_factor * std::exp ( dist_scaling_factor * cur_distances[i] * cur_distances[i] );
+
+        // Likelihood of a datum given that it is an outlier
+        p_outlier_prob = (1 - gamma) / v;
+
+        gamma = 0;
+        for (std::size_t i = 0; i < indices_size; ++i)
+          gamma += p_inlier_prob [i] / (p_inlier_prob[i] + p_outlier_prob);
+        gamma /= static_cast<double>(indices_size);
+      }
+
+      // Find the std::log likelihood of the model -L = -sum [std::log (pInlierProb + pOutlierProb)]
+      double d_cur_penalty = 0;
       for (std::size_t i = 0; i < indices_size; ++i)
-        p_inlier_prob[i] = weighted_normalization_factor * std::exp ( dist_scaling_factor * distances[i] * distances[i] );
-
-      // Likelihood of a datum given that it is an outlier
-      p_outlier_prob = (1 - gamma) / v;
-
-      gamma = 0;
-      for (std::size_t i = 0; i < indices_size; ++i)
-        gamma += p_inlier_prob [i] / (p_inlier_prob[i] + p_outlier_prob);
-      gamma /= static_cast<double>(sac_model_->getIndices ()->size ());
-    }
-
-    // Find the std::log likelihood of the model -L = -sum [std::log (pInlierProb + pOutlierProb)]
-    double d_cur_penalty = 0;
-    for (std::size_t i = 0; i < indices_size; ++i)
-      d_cur_penalty += std::log (p_inlier_prob[i] + p_outlier_prob);
-    d_cur_penalty = - d_cur_penalty;
-
-    // Better match ?
-    if (d_cur_penalty < d_best_penalty)
-    {
-      d_best_penalty = d_cur_penalty;
-
-      // Save the current model/coefficients selection as being the best so far
-      model_              = selection;
-      model_coefficients_ = model_coefficients;
+        d_cur_penalty += std::log (p_inlier_prob[i] + p_outlier_prob);
+      penalties[h] = - d_cur_penalty;
 
-      n_inliers_count = 0;
       // Need to compute the number of inliers for this model to adapt k
-      for (const double &distance : distances)
+      int n_cur_inliers_count = 0;
+      for (const double &distance : cur_distances)
         if (distance <= 2 * sigma_)
-          n_inliers_count++;
-
-      // Compute the k parameter (k=std::log(z)/std::log(1-w^n))
-      double w = static_cast<double> (n_inliers_count) / static_cast<double> (sac_model_->getIndices ()->size ());
-      double p_no_outliers = 1 - std::pow (w, static_cast<double> (selection.size ()));
-      p_no_outliers = (std::max) (std::numeric_limits<double>::epsilon (), p_no_outliers);       // Avoid division by -Inf
-      p_no_outliers = (std::min) (1 - std::numeric_limits<double>::epsilon (), p_no_outliers);   // Avoid division by 0.
-      k = std::log (1 - probability_) / std::log (p_no_outliers);
+          n_cur_inliers_count++;
+      inlier_counts[h] = n_cur_inliers_count;
     }
 
-    ++iterations_;
-    if (debug_verbosity_level > 1)
-      PCL_DEBUG ("[pcl::MaximumLikelihoodSampleConsensus::computeModel] Trial %d out of %d. Best penalty is %f.\n", iterations_, static_cast<int> (std::ceil (k)), d_best_penalty);
-    if (iterations_ > max_iterations_)
+    for (std::size_t h = 0; h < nr_hypotheses; ++h)
     {
-      if (debug_verbosity_level > 0)
-        PCL_DEBUG ("[pcl::MaximumLikelihoodSampleConsensus::computeModel] MLESAC reached the maximum number of trials.\n");
-      break;
+      if (batch_distances[h].empty ())
+      {
+        //iterations_++;
+        ++skipped_count;
+        continue;
+      }
+
+      // Better match ?
+      if (penalties[h] < d_best_penalty)
+      {
+        d_best_penalty = penalties[h];
+
+        // Save the current model/coefficients selection as being the best so far
+        model_              = samples[h];
+        model_coefficients_ = hypotheses[h];
+        n_inliers_count = inlier_counts[h];
+
+        // Compute the k parameter (k=std::log(z)/std::log(1-w^n))
+        double w = static_cast<double> (n_inliers_count) / static_cast<double> (indices_size);
+        double p_no_outliers = 1 - std::pow (w, static_cast<double> (samples[h].size ()));
+        p_no_outliers = (std::max) (std::numeric_limits<double>::epsilon (), p_no_outliers);       // Avoid division by -Inf
+        p_no_outliers = (std::min) (1 - std::numeric_limits<double>::epsilon (), p_no_outliers);   // Avoid division by 0.
+        k = std::log (1 - probability_) / std::log (p_no_outliers);
+      }
+
+      ++iterations_;
+      if (debug_verbosity_level > 1)
+        PCL_DEBUG ("[pcl::MaximumLikelihoodSampleConsensus::computeModel] Trial %d out of %d. Best penalty is %f.\n", iterations_, static_cast<int> (std::ceil (k)), d_best_penalty);
+      if (iterations_ > max_iterations_)
+      {
+        if (debug_verbosity_level > 0)
+          PCL_DEBUG ("[pcl::MaximumLikelihoodSampleConsensus::computeModel] MLESAC reached the maximum number of trials.\n");
+        done = true;
+        break;
+      }
+      // The remaining hypotheses of the batch would not have been drawn
+      if (iterations_ >= k)
+        break;
     }
   }
 
@@ -42,6 +42,7 @@
 #define PCL_SAMPLE_CONSENSUS_IMPL_MSAC_H_
 
 #include <pcl/sample_consensus/msac.h>
+#include <pcl/common/execution_context.h>
 
 //////////////////////////////////////////////////////////////////////////
 template <typename PointT> bool
@@ -58,72 +59,91 @@ pcl::MEstimatorSampleConsensus<PointT>::computeModel (int debug_verbosity_level)
   double d_best_penalty = std::numeric_limits<double>::max();
   double k = 1.0;
 
-  Indices selection;
-  Eigen::VectorXf model_coefficients (sac_model_->getModelSize ());
   std::vector<double> distances;
 
   int n_inliers_count = 0;
   unsigned skipped_count = 0;
   // suppress infinite loops by just allowing 10 x maximum allowed iterations for invalid model parameters!
   const unsigned max_skip = max_iterations_ * 10;
-  
+
+  // Hypotheses are drawn serially, in batches of one per thread, then scored concurrently and
+  // processed in the order they were drawn. This gives the same model for any number of threads.
+  // The threads are taken from the budget of pcl::ExecutionContext.
+  const pcl::ThreadReservation reservation (threads_ >= 0 ? static_cast<unsigned int> (threads_) : 1u);
+  const std::size_t batch_size = reservation.getNumberOfThreads ();
+  std::vector<Indices> samples;
+  std::vector<Eigen::VectorXf> hypotheses;
+  std::vector<std::vector<double> > batch_distances (batch_size);
+  std::vector<double> penalties (batch_size);
+  std::vector<int> inlier_counts (batch_size);
+
   // Iterate
-  while (iterations_ < k && skipped_count < max_skip)
+  bool done = false;
+  while (!done && iterations_ < k && skipped_count < max_skip)
   {
     // Get X samples which satisfy the model criteria
-    sac_model_->getSamples (iterations_, selection);
-
-    if (selection.empty ()) break;
-
-    // Search for inliers in the point cloud for the current plane model M
-    if (!sac_model_->computeModelCoefficients (selection, model_coefficients))
+    bool no_samples;
+    const std::size_t nr_hypotheses = this->drawHypotheses (batch_size, max_skip, skipped_count, samples, hypotheses, no_samples);
+    done = no_samples;
+
+    // Iterate through the 3d points and calculate the distances from them to the model, and
+    // the number of inliers needed to adapt k
+#pragma omp parallel for \
+  default(none) \
+  shared(batch_distances, hypotheses, inlier_counts, penalties) \
+  firstprivate(nr_hypotheses) \
+  num_threads(batch_size)
+    for (std::ptrdiff_t h = 0; h < static_cast<std::ptrdiff_t> (nr_hypotheses); ++h)
     {
-      //iterations_++;
-      ++ skipped_count;
-      continue;
-     }
-
-    double d_cur_penalty = 0;
-    // Iterate through the 3d points and calculate the distances from them to the model
-    sac_model_->getDistancesToModel (model_coefficients, distances);
-    
-    if (distances.empty () && k > 1.0)
-      continue;
-
-    for (const double &distance : distances)
-      d_cur_penalty += (std::min) (distance, threshold_);
-
-    // Better match ?
-    if (d_cur_penalty < d_best_penalty)
-    {
-      d_best_penalty = d_cur_penalty;
-
-      // Save the current model/coefficients selection as being the best so far
-      model_              = selection;
-      model_coefficients_ = model_coefficients;
-
-      n_inliers_count = 0;
-      // Need to compute the number of inliers for this model to adapt k
-      for (const double &distance : distances)
+      sac_model_->getDistancesToModel (hypotheses[h], batch_distances[h]);
+      double d_cur_penalty = 0;
+      int n_cur_inliers_count = 0;
+      for (const double &distance : batch_distances[h])
+      {
+        d_cur_penalty += (std::min) (distance, threshold_);
         if (distance <= threshold_)
-          ++n_inliers_count;
-
-      // Compute the k parameter (k=std::log(z)/std::log(1-w^n))
-      double w = static_cast<double> (n_inliers_count) / static_cast<double> (sac_model_->getIndices ()->size ());
-      double p_no_outliers = 1.0 - std::pow (w, static_cast<double> (selection.size ()));
-      p_no_outliers = (std::max) (std::numeric_limits<double>::epsilon (), p_no_outliers);       // Avoid division by -Inf
-      p_no_outliers = (std::min) (1.0 - std::numeric_limits<double>::epsilon (), p_no_outliers);   // Avoid division by 0.
-      k = std::log (1.0 - probability_) / std::log (p_no_outliers);
+          ++n_cur_inliers_count;
+      }
+      penalties[h] = d_cur_penalty;
+      inlier_counts[h] = n_cur_inliers_count;
     }
 
-    ++iterations_;
-    if (debug_verbosity_level > 1)
-      PCL_DEBUG ("[pcl::MEstimatorSampleConsensus::computeModel] Trial %d out of %d. Best penalty is %f.\n", iterations_, static_cast<int> (std::ceil (k)), d_best_penalty);
-    if (iterations_ > max_iterations_)
+    for (std::size_t h = 0; h < nr_hypotheses; ++h)
     {
-      if (debug_verbosity_level > 0)
-        PCL_DEBUG ("[pcl::MEstimatorSampleConsensus::computeModel] MSAC reached the maximum number of trials.\n");
-      break;
+      if (batch_distances[h].empty () && k > 1.0)
+        continue;
+
+      // Better match ?
+      if (penalties[h] < d_best_penalty)
+      {
+        d_best_penalty = penalties[h];
+
+        // Save the current model/coefficients selection as being the best so far
+        model_              = samples[h];
+        model_coefficients_ = hypotheses[h];
+        n_inliers_count = inlier_counts[h];
+
+        // Compute the k parameter (k=std::log(z)/std::log(1-w^n))
+        double w = static_cast<double> (n_inliers_count) / static_cast<double> (sac_model_->getIndices ()->size ());
+        double p_no_outliers = 1.0 - std::pow (w, static_cast<double> (samples[h].size ()));
+        p_no_outliers = (std::max) (std::numeric_limits<double>::epsilon (), p_no_outliers);       // Avoid division by -Inf
+        p_no_outliers = (std::min) (1.0 - std::numeric_limits<double>::epsilon (), p_no_outliers);   // Avoid division by 0.
+        k = std::log (1.0 - probability_) / std::log (p_no_outliers);
+      }
+
+      ++iterations_;
+      if (debug_verbosity_level > 1)
+        PCL_DEBUG ("[pcl::MEstimatorSampleConsensus::computeModel] Trial %d out of %d. Best penalty is %f.\n", iterations_, static_cast<int> (std::ceil (k)), d_best_penalty);
+      if (iterations_ > max_iterations_)
+      {
+        if (debug_verbosity_level > 0)
+          PCL_DEBUG ("[pcl::MEstimatorSampleConsensus::computeModel] MSAC reached the maximum number of trials.\n");
+        done = true;
+        break;
+      }
+      // The remaining hypotheses of the batch would not have been drawn
+      if (iterations_ >= k)
+        break;
     }
   }
 
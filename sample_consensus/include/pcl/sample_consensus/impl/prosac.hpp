@@ -47,6 +47,7 @@
 
 #include <boost/math/distributions/binomial.hpp>
 #include <pcl/sample_consensus/prosac.h>
+#include <pcl/common/execution_context.h>
 
 //////////////////////////////////////////////////////////////////////////
 // Variable naming uses capital letters to make the comparison with the original paper easier
@@ -83,7 +84,6 @@ pcl::ProgressiveSampleConsensus<PointT>::computeModel (int debug_verbosity_level
   iterations_ = 0;
 
   Indices inliers;
-  Indices selection;
   Eigen::VectorXf model_coefficients (sac_model_->getModelSize ());
 
   // We will increase the pool so the indices_ vector can only contain m elements at first
@@ -92,132 +92,181 @@ pcl::ProgressiveSampleConsensus<PointT>::computeModel (int debug_verbosity_level
   for (unsigned int i = 0; i < n; ++i)
     index_pool.push_back (sac_model_->indices_->operator[](i));
 
+  // The samples only depend on the iteration, so they are drawn serially, in batches of one per
+  // thread, then the hypotheses are scored concurrently and processed in the order they were drawn.
+  // This gives the same model for any number of threads. The threads are taken from the budget of
+  // pcl::ExecutionContext.
+  const pcl::ThreadReservation reservation (threads_ >= 0 ? static_cast<unsigned int> (threads_) : 1u);
+  const std::size_t batch_size = reservation.getNumberOfThreads ();
+  std::vector<Indices> samples (batch_size);
+  std::vector<Eigen::VectorXf> hypotheses (batch_size, model_coefficients);
+  std::vector<unsigned char> valid (batch_size);
+  std::vector<std::size_t> counts (batch_size);
+
   // Iterate
-  while (static_cast<unsigned int> (iterations_) < k_n_star)
+  bool done = false;
+  while (!done && static_cast<unsigned int> (iterations_) < k_n_star)
   {
-    // Choose the samples
-
-    // Step 1
-    // According to Equation 5 in the text text, not the algorithm
-    if ((iterations_ == T_prime_n) && (n < n_star))
+    std::size_t nr_hypotheses = 0;
+    for (; nr_hypotheses < batch_size; ++nr_hypotheses)
     {
-      // Increase the pool
-      ++n;
-      if (n >= N)
-        break;
-      index_pool.push_back (sac_model_->indices_->at(static_cast<unsigned int> (n - 1)));
-      // Update other variables
-      float T_n_minus_1 = T_n;
-      T_n *= (static_cast<float>(n) + 1.0f) / (static_cast<float>(n) + 1.0f - static_cast<float>(m));
-      T_prime_n += std::ceil (T_n - T_n_minus_1);
-    }
+      // The iteration this hypothesis is processed in
+      int iteration = iterations_ + static_cast<int> (nr_hypotheses);
 
-    // Step 2
-    sac_model_->indices_->swap (index_pool);
-    selection.clear ();
-    sac_model_->getSamples (iterations_, selection);
-    if (T_prime_n < iterations_)
-    {
-      selection.pop_back ();
-      selection.push_back (sac_model_->indices_->at(static_cast<unsigned int> (n - 1)));
-    }
+      // Choose the samples
 
-    // Make sure we use the right indices for testing
-    sac_model_->indices_->swap (index_pool);
+      // Step 1
+      // According to Equation 5 in the text text, not the algorithm
+      if ((iteration == T_prime_n) && (n < n_star))
+      {
+        // Increase the pool
+        ++n;
+        if (n >= N)
+        {
+          done = true;
+          break;
+        }
+        index_pool.push_back (sac_model_->indices_->at(static_cast<unsigned int> (n - 1)));
+        // Update other variables
+        float T_n_minus_1 = T_n;
+        T_n *= (static_cast<float>(n) + 1.0f) / (static_cast<float>(n) + 1.0f - static_cast<float>(m));
+        T_prime_n += std::ceil (T_n - T_n_minus_1);
+      }
 
-    if (selection.empty ())
-    {
-      PCL_ERROR ("[pcl::ProgressiveSampleConsensus::computeModel] No samples could be selected!\n");
-      break;
-    }
+      // Step 2
+      Indices &selection = samples[nr_hypotheses];
+      sac_model_->indices_->swap (index_pool);
+      selection.clear ();
+      sac_model_->getSamples (iteration, selection);
+      if (T_prime_n < iteration)
+      {
+        selection.pop_back ();
+        selection.push_back (sac_model_->indices_->at(static_cast<unsigned int> (n - 1)));
+      }
 
-    // Search for inliers in the point cloud for the current model
-    if (!sac_model_->computeModelCoefficients (selection, model_coefficients))
-    {
-      ++iterations_;
-      continue;
-    }
+      // Make sure we use the right indices for testing
+      sac_model_->indices_->swap (index_pool);
 
-    // Select the inliers that are within threshold_ from the model
-    inliers.clear ();
-    sac_model_->selectWithinDistance (model_coefficients, threshold_, inliers);
+      if (selection.empty ())
+      {
+        PCL_ERROR ("[pcl::ProgressiveSampleConsensus::computeModel] No samples could be selected!\n");
+        done = true;
+        break;
+      }
 
-    std::size_t I_N = inliers.size ();
+      // Search for inliers in the point cloud for the current model
+      valid[nr_hypotheses] = sac_model_->computeModelCoefficients (selection, hypotheses[nr_hypotheses]);
+    }
 
-    // If we find more inliers than before
-    if (I_N > I_N_best)
+    // Count the inliers that are within threshold_ from the models
+#pragma omp parallel for \
+  default(none) \
+  shared(counts, hypotheses, valid) \
+  firstprivate(nr_hypotheses) \
+  num_threads(batch_size)
+    for (std::ptrdiff_t h = 0; h < static_cast<std::ptrdiff_t> (nr_hypotheses); ++h)
+      if (valid[h])
+        counts[h] = sac_model_->countWithinDistance (hypotheses[h], threshold_);
+
+    for (std::size_t h = 0; h < nr_hypotheses; ++h)
     {
-      I_N_best = I_N;
-
-      // Save the current model/inlier/coefficients selection as being the best so far
-      inliers_ = inliers;
-      model_ = selection;
-      model_coefficients_ = model_coefficients;
-
-      // We estimate I_n_star for different possible values of n_star by using the inliers
-      std::sort (inliers.begin (), inliers.end ());
-
-      // Try to find a better n_star
-      // We minimize k_n_star and therefore maximize epsilon_n_star = I_n_star / n_star
-      std::size_t possible_n_star_best = N, I_possible_n_star_best = I_N;
-      float epsilon_possible_n_star_best = static_cast<float>(I_possible_n_star_best) / static_cast<float>(possible_n_star_best);
-
-      // We only need to compute possible better epsilon_n_star for when _n is just about to be removed an inlier
-      std::size_t I_possible_n_star = I_N;
-      for (auto last_inlier = inliers.crbegin (), inliers_end = inliers.crend ();
-           last_inlier != inliers_end; 
-           ++last_inlier, --I_possible_n_star)
+      if (!valid[h])
       {
-        // The best possible_n_star for a given I_possible_n_star is the index of the last inlier
-        unsigned int possible_n_star = (*last_inlier) + 1;
-        if (possible_n_star <= m)
+        ++iterations_;
+        if (static_cast<unsigned int> (iterations_) >= k_n_star)
           break;
+        continue;
+      }
+
+      std::size_t I_N = counts[h];
 
-        // If we find a better epsilon_n_star
-        float epsilon_possible_n_star = static_cast<float>(I_possible_n_star) / static_cast<float>(possible_n_star);
-        // Make sure we have a better epsilon_possible_n_star
-        if ((epsilon_possible_n_star > epsilon_n_star) && (epsilon_possible_n_star > epsilon_possible_n_star_best))
+      // If we find more inliers than before
+      if (I_N > I_N_best)
+      {
+        // Select the inliers that are within threshold_ from the model
+        inliers.clear ();
+        sac_model_->selectWithinDistance (hypotheses[h], threshold_, inliers);
+        I_N = inliers.size ();
+      }
+
+      if (I_N > I_N_best)
+      {
+        I_N_best = I_N;
+
+        // Save the current model/inlier/coefficients selection as being the best so far
+        inliers_ = inliers;
+        model_ = samples[h];
+        model_coefficients_ = hypotheses[h];
+
+        // We estimate I_n_star for different possible values of n_star by using the inliers
+        std::sort (inliers.begin (), inliers.end ());
+
+        // Try to find a better n_star
+        // We minimize k_n_star and therefore maximize epsilon_n_star = I_n_star / n_star
+        std::size_t possible_n_star_best = N, I_possible_n_star_best = I_N;
+        float epsilon_possible_n_star_best = static_cast<float>(I_possible_n_star_best) / static_cast<float>(possible_n_star_best);
+
+        // We only need to compute possible better epsilon_n_star for when _n is just about to be removed an inlier
+        std::size_t I_possible_n_star = I_N;
+        for (auto last_inlier = inliers.crbegin (), inliers_end = inliers.crend ();
+             last_inlier != inliers_end; 
+             ++last_inlier, --I_possible_n_star)
         {
-          // Typo in Equation 7, not (n-m choose i-m) but (n choose i-m)
-          std::size_t I_possible_n_star_min = m
-                           + static_cast<std::size_t> (std::ceil (boost::math::quantile (boost::math::complement (boost::math::binomial_distribution<float>(static_cast<float> (possible_n_star), 0.1f), 0.05))));
-          // If Equation 9 is not verified, exit
-          if (I_possible_n_star < I_possible_n_star_min)
+          // The best possible_n_star for a given I_possible_n_star is the index of the last inlier
+          unsigned int possible_n_star = (*last_inlier) + 1;
+          if (possible_n_star <= m)
             break;
 
-          possible_n_star_best = possible_n_star;
-          I_possible_n_star_best = I_possible_n_star;
-          epsilon_possible_n_star_best = epsilon_possible_n_star;
+          // If we find a better epsilon_n_star
+          float epsilon_possible_n_star = static_cast<float>(I_possible_n_star) / static_cast<float>(possible_n_star);
+          // Make sure we have a better epsilon_possible_n_star
+          if ((epsilon_possible_n_star > epsilon_n_star) && (epsilon_possible_n_star > epsilon_possible_n_star_best))
+          {
+            // Typo in Equation 7, not (n-m choose i-m) but (n choose i-m)
+            std::size_t I_possible_n_star_min = m
+                             + static_cast<std::size_t> (std::ceil (boost::math::quantile (boost::math::complement (boost::math::binomial_distribution<float>(static_cast<float> (possible_n_star), 0.1f), 0.05))));
+            // If Equation 9 is not verified, exit
+            if (I_possible_n_star < I_possible_n_star_min)
+              break;
+
+            possible_n_star_best = possible_n_star;
+            I_possible_n_star_best = I_possible_n_star;
+            epsilon_possible_n_star_best = epsilon_possible_n_star;
+          }
+        }
+
+        // Check if we get a better epsilon
+        if (epsilon_possible_n_star_best > epsilon_n_star)
+        {
+          // update the best value
+          epsilon_n_star = epsilon_possible_n_star_best;
+
+          // Compute the new k_n_star
+          float bottom_log = 1 - std::pow (epsilon_n_star, static_cast<float>(m));
+          if (bottom_log == 0)
+            k_n_star = 1;
+          else if (bottom_log == 1)
+            k_n_star = T_N;
+          else
+            k_n_star = static_cast<int> (std::ceil (std::log (0.05) / std::log (bottom_log)));
+          // It seems weird to have very few iterations, so do have a few (totally empirical)
+          k_n_star = (std::max)(k_n_star, 2 * m);
         }
       }
 
-      // Check if we get a better epsilon
-      if (epsilon_possible_n_star_best > epsilon_n_star)
+      ++iterations_;
+      if (debug_verbosity_level > 1)
+        PCL_DEBUG ("[pcl::ProgressiveSampleConsensus::computeModel] Trial %d out of %d: %d inliers (best is: %d so far).\n", iterations_, k_n_star, I_N, I_N_best);
+      if (iterations_ > max_iterations_)
       {
-        // update the best value
-        epsilon_n_star = epsilon_possible_n_star_best;
-
-        // Compute the new k_n_star
-        float bottom_log = 1 - std::pow (epsilon_n_star, static_cast<float>(m));
-        if (bottom_log == 0)
-          k_n_star = 1;
-        else if (bottom_log == 1)
-          k_n_star = T_N;
-        else
-          k_n_star = static_cast<int> (std::ceil (std::log (0.05) / std::log (bottom_log)));
-        // It seems weird to have very few iterations, so do have a few (totally empirical)
-        k_n_star = (std::max)(k_n_star, 2 * m);
+        if (debug_verbosity_level > 0)
+          PCL_DEBUG ("[pcl::ProgressiveSampleConsensus::computeModel] RANSAC reached the maximum number of trials.\n");
+        done = true;
+        break;
       }
-    }
-
-    ++iterations_;
-    if (debug_verbosity_level > 1)
-      PCL_DEBUG ("[pcl::ProgressiveSampleConsensus::computeModel] Trial %d out of %d: %d inliers (best is: %d so far).\n", iterations_, k_n_star, I_N, I_N_best);
-    if (iterations_ > max_iterations_)
-    {
-      if (debug_verbosity_level > 0)
-        PCL_DEBUG ("[pcl::ProgressiveSampleConsensus::computeModel] RANSAC reached the maximum number of trials.\n");
-      break;
+      // The remaining hypotheses of the batch would not have been drawn
+      if (static_cast<unsigned int> (iterations_) >= k_n_star)
+        break;
     }
   }
 
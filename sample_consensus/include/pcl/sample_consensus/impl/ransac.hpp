@@ -42,6 +42,7 @@
 #define PCL_SAMPLE_CONSENSUS_IMPL_RANSAC_H_
 
 #include <pcl/sample_consensus/ransac.h>
+#include <pcl/common/execution_context.h>
 #ifdef _OPENMP
 #include <omp.h>
 #endif
@@ -78,15 +79,25 @@ pcl::RandomSampleConsensus<PointT>::computeModel (int)
   // suppress infinite loops by just allowing 10 x maximum allowed iterations for invalid model parameters!
   const unsigned max_skip = max_iterations_ * 10;
 
+  // Compute the k parameter (k=std::log(z)/std::log(1-w^n))
+  const auto compute_k = [&] (std::size_t n_inliers, std::size_t sample_size)
+  {
+    const double w = static_cast<double> (n_inliers) * one_over_indices;
+    double p_no_outliers = 1.0 - std::pow (w, static_cast<double> (sample_size));
+    p_no_outliers = (std::max) (std::numeric_limits<double>::epsilon (), p_no_outliers);       // Avoid division by -Inf
+    p_no_outliers = (std::min) (1.0 - std::numeric_limits<double>::epsilon (), p_no_outliers);   // Avoid division by 0.
+    return (log_probability / std::log (p_no_outliers));
+  };
+
+  // The threads are taken from the budget of pcl::ExecutionContext, the serial version uses the calling thread
+  const pcl::ThreadReservation reservation (threads_ >= 0 ? static_cast<unsigned int> (threads_) : 1u);
   int threads = threads_;
   if (threads >= 0)
   {
 #if OPENMP_AVAILABLE_RANSAC
-    if (threads == 0)
-    {
-      threads = omp_get_num_procs();
+    threads = static_cast<int> (reservation.getNumberOfThreads ());
+    if (threads_ == 0)
       PCL_DEBUG ("[pcl::RandomSampleConsensus::computeModel] Automatic number of threads requested, choosing %i threads.\n", threads);
-    }
 #else
     // Parallelization desired, but not available
     PCL_WARN ("[pcl::RandomSampleConsensus::computeModel] Parallelization is requested, but OpenMP 3.1 is not available! Continuing without parallelization.\n");
@@ -94,113 +105,178 @@ pcl::RandomSampleConsensus<PointT>::computeModel (int)
 #endif
   }
 
+  if (hypotheses_batch_size_ > 1 && threads < 0)
+  {
+    PCL_DEBUG ("[pcl::RandomSampleConsensus::computeModel] Scoring hypotheses in batches of %lu.\n", hypotheses_batch_size_);
+
+    std::vector<Indices> samples;
+    std::vector<Eigen::VectorXf> hypotheses;
+    std::vector<std::size_t> counts;
+    bool done = false;
+    while (!done)
+    {
+      // Do not draw more hypotheses than the current k and max_iterations_ can still accept
+      double remaining = static_cast<double> (max_iterations_ - iterations_) + 1.0;
+      if (k < std::numeric_limits<double>::max ())
+        remaining = (std::min) (remaining, std::floor (k) - iterations_ + 1.0);
+      const std::size_t batch_size = (std::min) (hypotheses_batch_size_, static_cast<std::size_t> ((std::max) (remaining, 1.0)));
+
+      // Draw the next batch of hypotheses, in the same way as the loop below
+      samples.clear ();
+      hypotheses.clear ();
+      while (hypotheses.size () < batch_size)
+      {
+        sac_model_->getSamples (iterations_, selection);
+        if (selection.empty ())
+        {
+          PCL_ERROR ("[pcl::RandomSampleConsensus::computeModel] No samples could be selected!\n");
+          done = true;
+          break;
+        }
+        if (!sac_model_->computeModelCoefficients (selection, model_coefficients))
+        {
+          if (++skipped_count < max_skip)
+            continue;
+          done = true;
+          break;
+        }
+        samples.push_back (selection);
+        hypotheses.push_back (model_coefficients);
+      }
+
+      // Score the whole batch, then process the results in the order the hypotheses were drawn
+      sac_model_->countWithinDistanceBatch (hypotheses, threshold_, counts);
+      for (std::size_t h = 0; h < hypotheses.size (); ++h)
+      {
+        if (counts[h] > n_best_inliers_count)
+        {
+          n_best_inliers_count = counts[h];
+          model_              = samples[h];
+          model_coefficients_ = hypotheses[h];
+          k = compute_k (n_best_inliers_count, samples[h].size ());
+        }
+
+        ++iterations_;
+        PCL_DEBUG ("[pcl::RandomSampleConsensus::computeModel] Trial %d out of %f: %u inliers (best is: %u so far).\n", iterations_, k, counts[h], n_best_inliers_count);
+        if (iterations_ > k)
+        {
+          done = true;
+          break;
+        }
+        if (iterations_ > max_iterations_)
+        {
+          PCL_DEBUG ("[pcl::RandomSampleConsensus::computeModel] RANSAC reached the maximum number of trials.\n");
+          done = true;
+          break;
+        }
+      }
+    }
+  }
+  else
+  {
 #if OPENMP_AVAILABLE_RANSAC
 #pragma omp parallel if(threads > 0) num_threads(threads) shared(k, skipped_count, n_best_inliers_count) firstprivate(selection, model_coefficients) // would be nice to have a default(none)-clause here, but then some compilers complain about the shared const variables
 #endif
-  {
+    {
 #if OPENMP_AVAILABLE_RANSAC
-    if (omp_in_parallel())
+      if (omp_in_parallel())
 #pragma omp master
-      PCL_DEBUG ("[pcl::RandomSampleConsensus::computeModel] Computing in parallel with up to %i threads.\n", omp_get_num_threads());
-    else
+        PCL_DEBUG ("[pcl::RandomSampleConsensus::computeModel] Computing in parallel with up to %i threads.\n", omp_get_num_threads());
+      else
 #endif
-      PCL_DEBUG ("[pcl::RandomSampleConsensus::computeModel] Computing not parallel.\n");
+        PCL_DEBUG ("[pcl::RandomSampleConsensus::computeModel] Computing not parallel.\n");
 
-    // Iterate
-    while (true) // infinite loop with four possible breaks
-    {
-      // Get X samples which satisfy the model criteria
+      // Iterate
+      while (true) // infinite loop with four possible breaks
+      {
+        // Get X samples which satisfy the model criteria
 #if OPENMP_AVAILABLE_RANSAC
 #pragma omp critical(samples)
 #endif
-      {
-        sac_model_->getSamples (iterations_, selection); // The random number generator used when choosing the samples should not be called in parallel
-      }
+        {
+          sac_model_->getSamples (iterations_, selection); // The random number generator used when choosing the samples should not be called in parallel
+        }
 
-      if (selection.empty ())
-      {
-        PCL_ERROR ("[pcl::RandomSampleConsensus::computeModel] No samples could be selected!\n");
-        break;
-      }
+        if (selection.empty ())
+        {
+          PCL_ERROR ("[pcl::RandomSampleConsensus::computeModel] No samples could be selected!\n");
+          break;
+        }
 
-      // Search for inliers in the point cloud for the current plane model M
-      if (!sac_model_->computeModelCoefficients (selection, model_coefficients)) // This function has to be thread-safe
-      {
-        //++iterations_;
-        unsigned skipped_count_tmp;
+        // Search for inliers in the point cloud for the current plane model M
+        if (!sac_model_->computeModelCoefficients (selection, model_coefficients)) // This function has to be thread-safe
+        {
+          //++iterations_;
+          unsigned skipped_count_tmp;
 #if OPENMP_AVAILABLE_RANSAC
 #pragma omp atomic capture
 #endif
-        skipped_count_tmp = ++skipped_count;
-        if (skipped_count_tmp < max_skip)
-          continue;
-        else
-          break;
-      }
+          skipped_count_tmp = ++skipped_count;
+          if (skipped_count_tmp < max_skip)
+            continue;
+          else
+            break;
+        }
 
-      // Select the inliers that are within threshold_ from the model
-      //sac_model_->selectWithinDistance (model_coefficients, threshold_, inliers);
-      //if (inliers.empty () && k > 1.0)
-      //  continue;
+        // Select the inliers that are within threshold_ from the model
+        //sac_model_->selectWithinDistance (model_coefficients, threshold_, inliers);
+        //if (inliers.empty () && k > 1.0)
+        //  continue;
 
-      std::size_t n_inliers_count = sac_model_->countWithinDistance (model_coefficients, threshold_); // This functions has to be thread-safe. Most work is done here
+        std::size_t n_inliers_count = sac_model_->countWithinDistance (model_coefficients, threshold_); // This functions has to be thread-safe. Most work is done here
 
-      std::size_t n_best_inliers_count_tmp;
+        std::size_t n_best_inliers_count_tmp;
 #if OPENMP_AVAILABLE_RANSAC
 #pragma omp atomic read
 #endif
-      n_best_inliers_count_tmp = n_best_inliers_count;
+        n_best_inliers_count_tmp = n_best_inliers_count;
 
-      if (n_inliers_count > n_best_inliers_count_tmp) // This condition is false most of the time, and the critical region is not entered, hopefully leading to more efficient concurrency
-      {
+        if (n_inliers_count > n_best_inliers_count_tmp) // This condition is false most of the time, and the critical region is not entered, hopefully leading to more efficient concurrency
+        {
 #if OPENMP_AVAILABLE_RANSAC
 #pragma omp critical(update) // n_best_inliers_count, model_, model_coefficients_, k are shared and read/write must be protected
 #endif
-        {
-          // Better match ?
-          if (n_inliers_count > n_best_inliers_count)
           {
-            n_best_inliers_count = n_inliers_count; // This write and the previous read of n_best_inliers_count must be consecutive and must not be interrupted!
-            n_best_inliers_count_tmp = n_best_inliers_count;
-
-            // Save the current model/inlier/coefficients selection as being the best so far
-            model_              = selection;
-            model_coefficients_ = model_coefficients;
-
-            // Compute the k parameter (k=std::log(z)/std::log(1-w^n))
-            const double w = static_cast<double> (n_best_inliers_count) * one_over_indices;
-            double p_no_outliers = 1.0 - std::pow (w, static_cast<double> (selection.size ()));
-            p_no_outliers = (std::max) (std::numeric_limits<double>::epsilon (), p_no_outliers);       // Avoid division by -Inf
-            p_no_outliers = (std::min) (1.0 - std::numeric_limits<double>::epsilon (), p_no_outliers);   // Avoid division by 0.
-            k = log_probability / std::log (p_no_outliers);
-          }
-        } // omp critical
-      }
+            // Better match ?
+            if (n_inliers_count > n_best_inliers_count)
+            {
+              n_best_inliers_count = n_inliers_count; // This write and the previous read of n_best_inliers_count must be consecutive and must not be interrupted!
+              n_best_inliers_count_tmp = n_best_inliers_count;
+
+              // Save the current model/inlier/coefficients selection as being the best so far
+              model_              = selection;
+              model_coefficients_ = model_coefficients;
+
+              k = compute_k (n_best_inliers_count, selection.size ());
+            }
+          } // omp critical
+        }
 
-      int iterations_tmp;
-      double k_tmp;
+        int iterations_tmp;
+        double k_tmp;
 #if OPENMP_AVAILABLE_RANSAC
 #pragma omp atomic capture
 #endif
-      iterations_tmp = ++iterations_;
+        iterations_tmp = ++iterations_;
 #if OPENMP_AVAILABLE_RANSAC
 #pragma omp atomic read
 #endif
-      k_tmp = k;
+        k_tmp = k;
 #if OPENMP_AVAILABLE_RANSAC
-      PCL_DEBUG ("[pcl::RandomSampleConsensus::computeModel] Trial %d out of %f: %u inliers (best is: %u so far) (thread %d).\n", iterations_tmp, k_tmp, n_inliers_count, n_best_inliers_count_tmp, omp_get_thread_num());
+        PCL_DEBUG ("[pcl::RandomSampleConsensus::computeModel] Trial %d out of %f: %u inliers (best is: %u so far) (thread %d).\n", iterations_tmp, k_tmp, n_inliers_count, n_best_inliers_count_tmp, omp_get_thread_num());
 #else
-      PCL_DEBUG ("[pcl::RandomSampleConsensus::computeModel] Trial %d out of %f: %u inliers (best is: %u so far).\n", iterations_tmp, k_tmp, n_inliers_count, n_best_inliers_count_tmp);
+        PCL_DEBUG ("[pcl::RandomSampleConsensus::computeModel] Trial %d out of %f: %u inliers (best is: %u so far).\n", iterations_tmp, k_tmp, n_inliers_count, n_best_inliers_count_tmp);
 #endif
-      if (iterations_tmp > k_tmp)
-        break;
-      if (iterations_tmp > max_iterations_)
-      {
-        PCL_DEBUG ("[pcl::RandomSampleConsensus::computeModel] RANSAC reached the maximum number of trials.\n");
-        break;
-      }
-    } // while
-  } // omp parallel
+        if (iterations_tmp > k_tmp)
+          break;
+        if (iterations_tmp > max_iterations_)
+        {
+          PCL_DEBUG ("[pcl::RandomSampleConsensus::computeModel] RANSAC reached the maximum number of trials.\n");
+          break;
+        }
+      } // while
+    } // omp parallel
+  }
 
   PCL_DEBUG ("[pcl::RandomSampleConsensus::computeModel] Model: %lu size, %u inliers.\n", model_.size (), n_best_inliers_count);
 
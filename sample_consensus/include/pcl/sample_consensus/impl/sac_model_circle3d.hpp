@@ -41,8 +41,8 @@
 
 #include <cfloat> // for DBL_MAX
 
-#include <unsupported/Eigen/NonLinearOptimization> // for LevenbergMarquardt
 #include <pcl/sample_consensus/sac_model_circle3d.h>
+#include <pcl/sample_consensus/sac_levenberg_marquardt.h>
 #include <pcl/common/concatenate.h>
 
 //////////////////////////////////////////////////////////////////////////
@@ -132,39 +132,9 @@ pcl::SampleConsensusModelCircle3D<PointT>::getDistancesToModel (const Eigen::Vec
   }
   distances.resize (indices_->size ());
 
-  // Iterate through the 3d points and calculate the distances from them to the sphere
-  for (std::size_t i = 0; i < indices_->size (); ++i)
-  // Calculate the distance from the point to the circle:
-  // 1.   calculate intersection point of the plane in which the circle lies and the
-  //      line from the sample point with the direction of the plane normal (projected point)
-  // 2.   calculate the intersection point of the line from the circle center to the projected point
-  //      with the circle
-  // 3.   calculate distance from corresponding point on the circle to the sample point
-  {
-    // what i have:
-    // P : Sample Point
-    Eigen::Vector3d P ((*input_)[(*indices_)[i]].x, (*input_)[(*indices_)[i]].y, (*input_)[(*indices_)[i]].z);
-    // C : Circle Center
-    Eigen::Vector3d C (model_coefficients[0], model_coefficients[1], model_coefficients[2]);
-    // N : Circle (Plane) Normal
-    Eigen::Vector3d N (model_coefficients[4], model_coefficients[5], model_coefficients[6]);
-    // r : Radius
-    double r = model_coefficients[3];
-
-    Eigen::Vector3d helper_vectorPC = P - C;
-    // 1.1. get line parameter
-    double lambda = (helper_vectorPC.dot (N)) / N.squaredNorm ();
-
-    // Projected Point on plane
-    Eigen::Vector3d P_proj = P + lambda * N;
-    Eigen::Vector3d helper_vectorP_projC = P_proj - C;
-
-    // K : Point on Circle
-    Eigen::Vector3d K = C + r * helper_vectorP_projC.normalized ();
-    Eigen::Vector3d distanceVector =  P - K;
-
-    distances[i] = distanceVector.norm ();
-  }
+  forEachDistance ([&] (std::size_t begin, std::size_t count, float *chunk)
+                   { computeDistances (model_coefficients, begin, count, chunk); },
+                   [&] (std::size_t i, float distance) { distances[i] = distance; });
 }
 
 //////////////////////////////////////////////////////////////////////////
@@ -182,37 +152,14 @@ pcl::SampleConsensusModelCircle3D<PointT>::selectWithinDistance (
   inliers.clear ();
   inliers.reserve (indices_->size ());
 
-  const auto squared_threshold = threshold * threshold;
-  // Iterate through the 3d points and calculate the distances from them to the sphere
-  for (std::size_t i = 0; i < indices_->size (); ++i)
-  {
-    // what i have:
-    // P : Sample Point
-    Eigen::Vector3d P ((*input_)[(*indices_)[i]].x, (*input_)[(*indices_)[i]].y, (*input_)[(*indices_)[i]].z);
-    // C : Circle Center
-    Eigen::Vector3d C (model_coefficients[0], model_coefficients[1], model_coefficients[2]);
-    // N : Circle (Plane) Normal
-    Eigen::Vector3d N (model_coefficients[4], model_coefficients[5], model_coefficients[6]);
-    // r : Radius
-    double r = model_coefficients[3];
-
-    Eigen::Vector3d helper_vectorPC = P - C;
-    // 1.1. get line parameter
-    double lambda = (-(helper_vectorPC.dot (N))) / N.dot (N);
-    // Projected Point on plane
-    Eigen::Vector3d P_proj = P + lambda * N;
-    Eigen::Vector3d helper_vectorP_projC = P_proj - C;
-
-    // K : Point on Circle
-    Eigen::Vector3d K = C + r * helper_vectorP_projC.normalized ();
-    Eigen::Vector3d distanceVector =  P - K;
-
-    if (distanceVector.squaredNorm () < squared_threshold)
-    {
-      // Returns the indices of the points whose distances are smaller than the threshold
-      inliers.push_back ((*indices_)[i]);
-    }
-  }
+  forEachDistance ([&] (std::size_t begin, std::size_t count, float *chunk)
+                   { computeDistances (model_coefficients, begin, count, chunk); },
+                   [&] (std::size_t i, float distance)
+                   {
+                     // Returns the indices of the points whose distances are smaller than the threshold
+                     if (distance < threshold)
+                       inliers.push_back ((*indices_)[i]);
+                   });
 }
 
 //////////////////////////////////////////////////////////////////////////
@@ -223,37 +170,11 @@ pcl::SampleConsensusModelCircle3D<PointT>::countWithinDistance (
   // Check if the model is valid given the user constraints
   if (!isModelValid (model_coefficients))
     return (0);
-  std::size_t nr_p = 0;
-
-  const auto squared_threshold = threshold * threshold;
-  // Iterate through the 3d points and calculate the distances from them to the sphere
-  for (std::size_t i = 0; i < indices_->size (); ++i)
-  {
-    // what i have:
-    // P : Sample Point
-    Eigen::Vector3d P ((*input_)[(*indices_)[i]].x, (*input_)[(*indices_)[i]].y, (*input_)[(*indices_)[i]].z);
-    // C : Circle Center
-    Eigen::Vector3d C (model_coefficients[0], model_coefficients[1], model_coefficients[2]);
-    // N : Circle (Plane) Normal
-    Eigen::Vector3d N (model_coefficients[4], model_coefficients[5], model_coefficients[6]);
-    // r : Radius
-    double r = model_coefficients[3];
-
-    Eigen::Vector3d helper_vectorPC = P - C;
-    // 1.1. get line parameter
-    double lambda = (-(helper_vectorPC.dot (N))) / N.dot (N);
 
-    // Projected Point on plane
-    Eigen::Vector3d P_proj = P + lambda * N;
-    Eigen::Vector3d helper_vectorP_projC = P_proj - C;
-
-    // K : Point on Circle
-    Eigen::Vector3d K = C + r * helper_vectorP_projC.normalized ();
-    Eigen::Vector3d distanceVector =  P - K;
-
-    if (distanceVector.squaredNorm () < squared_threshold)
-      nr_p++;
-  }
+  std::size_t nr_p = 0;
+  forEachDistance ([&] (std::size_t begin, std::size_t count, float *chunk)
+                   { computeDistances (model_coefficients, begin, count, chunk); },
+                   [&] (std::size_t, float distance) { nr_p += (distance < threshold); });
   return (nr_p);
 }
 
@@ -280,17 +201,47 @@ pcl::SampleConsensusModelCircle3D<PointT>::optimizeModelCoefficients (
     return;
   }
 
-  OptimizationFunctor functor (this, inliers);
-  Eigen::NumericalDiff<OptimizationFunctor> num_diff (functor);
-  Eigen::LevenbergMarquardt<Eigen::NumericalDiff<OptimizationFunctor>, double> lm (num_diff);
-  Eigen::VectorXd coeff;
-  int info = lm.minimize (coeff);
-  for (Eigen::Index i = 0; i < coeff.size (); ++i)
-    optimized_coefficients[i] = static_cast<float> (coeff[i]);
+  // Residual ||p - k||, with k the point of the circle closest to p. With n the unit normal, h the height of
+  // p above the circle plane and u the unit direction from the center to the projection of p on the plane,
+  // at distance m, p - k = h n + (m - r) u. Its gradient is -(p - k) / ||p - k|| for the center,
+  // -(m - r) / ||p - k|| for the radius and h r / (||N|| ||p - k||) u for the unnormalized normal N.
+  using Vector7d = Eigen::Matrix<double, 7, 1>;
+  const auto make_residual = [this, &inliers] (const Vector7d &x)
+  {
+    const Eigen::Vector3d center = x.head<3> ();
+    const double radius = x[3];
+    const double normal_norm = x.segment<3> (4).norm ();
+    const Eigen::Vector3d normal = x.segment<3> (4) / normal_norm;
+    return [this, &inliers, center, radius, normal_norm, normal] (std::size_t i, Vector7d &gradient)
+    {
+      const Eigen::Vector3d v = (*input_)[inliers[i]].getVector3fMap ().template cast<double> () - center;
+      const double h = v.dot (normal);
+      const Eigen::Vector3d in_plane = v - h * normal;
+      const double m = in_plane.norm ();
+      const Eigen::Vector3d u = (m > 0.0 ? Eigen::Vector3d (in_plane / m) : Eigen::Vector3d::Zero ());
+      const Eigen::Vector3d distance_vector = h * normal + (m - radius) * u;
+      const double distance = distance_vector.norm ();
+      if (distance > 0.0)
+      {
+        gradient.head<3> () = -distance_vector / distance;
+        gradient[3] = -(m - radius) / distance;
+        gradient.segment<3> (4) = (h * radius / (normal_norm * distance)) * u;
+      }
+      else
+        gradient.setZero ();
+      return (distance);
+    };
+  };
+
+  Vector7d x = model_coefficients.head<7> ().template cast<double> ();
+  double residual_norm;
+  const int info = pcl::detail::sacLevenbergMarquardt<7> (make_residual, inliers.size (), x, residual_norm, threads_);
+  optimized_coefficients = x.cast<float> ();
+  optimized_coefficients.tail<3> ().normalize ();
 
   // Compute the L2 norm of the residuals
   PCL_DEBUG ("[pcl::SampleConsensusModelCircle3D::optimizeModelCoefficients] LM solver finished with exit code %i, having a residual norm of %g. \nInitial solution: %g %g %g %g %g %g %g \nFinal solution: %g %g %g %g %g %g %g\n",
-             info, lm.fvec.norm (), model_coefficients[0], model_coefficients[1], model_coefficients[2], model_coefficients[3], model_coefficients[4], model_coefficients[5], model_coefficients[6], optimized_coefficients[0], optimized_coefficients[1], optimized_coefficients[2], optimized_coefficients[3], optimized_coefficients[4], optimized_coefficients[5], optimized_coefficients[6]);
+             info, residual_norm, model_coefficients[0], model_coefficients[1], model_coefficients[2], model_coefficients[3], model_coefficients[4], model_coefficients[5], model_coefficients[6], optimized_coefficients[0], optimized_coefficients[1], optimized_coefficients[2], optimized_coefficients[3], optimized_coefficients[4], optimized_coefficients[5], optimized_coefficients[6]);
 }
 
 //////////////////////////////////////////////////////////////////////////
@@ -464,6 +415,22 @@ pcl::SampleConsensusModelCircle3D<PointT>::isModelValid (const Eigen::VectorXf &
   return (true);
 }
 
+//////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::SampleConsensusModelCircle3D<PointT>::computeDistances (
+      const Eigen::VectorXf &model_coefficients, std::size_t begin, std::size_t count, float *distances) const
+{
+  // Calculate the distance from the point to the circle:
+  // 1.   calculate intersection point of the plane in which the circle lies and the
+  //      line from the sample point with the direction of the plane normal (projected point)
+  // 2.   calculate the intersection point of the line from the circle center to the projected point
+  //      with the circle
+  // 3.   calculate distance from corresponding point on the circle to the sample point
+  pcl::detail::computeCircle3DDistances (
+      pcl::detail::makeSACFieldView (*input_, (*input_)[0].x, indices_->data () + begin), count,
+      model_coefficients, distances);
+}
+
 #define PCL_INSTANTIATE_SampleConsensusModelCircle3D(T) template class PCL_EXPORTS pcl::SampleConsensusModelCircle3D<T>;
 
 #endif    // PCL_SAMPLE_CONSENSUS_IMPL_SAC_MODEL_CIRCLE3D_HPP_
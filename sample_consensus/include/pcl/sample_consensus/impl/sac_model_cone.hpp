@@ -39,8 +39,8 @@
 #ifndef PCL_SAMPLE_CONSENSUS_IMPL_SAC_MODEL_CONE_H_
 #define PCL_SAMPLE_CONSENSUS_IMPL_SAC_MODEL_CONE_H_
 
-#include <unsupported/Eigen/NonLinearOptimization> // for LevenbergMarquardt
 #include <pcl/sample_consensus/sac_model_cone.h>
+#include <pcl/sample_consensus/sac_levenberg_marquardt.h>
 #include <pcl/common/common.h> // for getAngle3D
 #include <pcl/common/concatenate.h>
 
@@ -338,14 +338,38 @@ pcl::SampleConsensusModelCone<PointT, PointNT>::optimizeModelCoefficients (
     return;
   }
 
-  OptimizationFunctor functor (this, inliers);
-  Eigen::NumericalDiff<OptimizationFunctor > num_diff (functor);
-  Eigen::LevenbergMarquardt<Eigen::NumericalDiff<OptimizationFunctor>, float> lm (num_diff);
-  int info = lm.minimize (optimized_coefficients);
+  // Residual d^2 - (tan (angle) h)^2, with d the distance of the point to the axis and h its height above
+  // the apex. With v = p - apex, s = a.a, w = v.a and c = 1 + tan^2 (angle), this is v.v - c w^2 / s, whose
+  // gradient is -2 (v - c w / s a) for the apex, -2 c w / s (v - w / s a) for a and -2 tan (angle) c w^2 / s
+  // for the angle.
+  using Vector7d = Eigen::Matrix<double, 7, 1>;
+  const auto make_residual = [this, &inliers] (const Vector7d &x)
+  {
+    const Eigen::Vector3d apex = x.head<3> ();
+    const Eigen::Vector3d axis_dir = x.segment<3> (3);
+    const double inv_sqr_dir_norm = 1.0 / axis_dir.squaredNorm ();
+    const double tan_angle = std::tan (x[6]);
+    const double c = 1.0 + tan_angle * tan_angle;
+    return [this, &inliers, apex, axis_dir, inv_sqr_dir_norm, tan_angle, c] (std::size_t i, Vector7d &gradient)
+    {
+      const Eigen::Vector3d v = (*input_)[inliers[i]].getVector3fMap ().template cast<double> () - apex;
+      const double w = v.dot (axis_dir);
+      const double t = w * inv_sqr_dir_norm;
+      gradient.head<3> () = -2.0 * (v - c * t * axis_dir);
+      gradient.segment<3> (3) = -2.0 * c * t * (v - t * axis_dir);
+      gradient[6] = -2.0 * tan_angle * c * w * t;
+      return (v.squaredNorm () - c * w * t);
+    };
+  };
+
+  Vector7d x = model_coefficients.head<7> ().template cast<double> ();
+  double residual_norm;
+  const int info = pcl::detail::sacLevenbergMarquardt<7> (make_residual, inliers.size (), x, residual_norm, threads_);
+  optimized_coefficients = x.cast<float> ();
 
   // Compute the L2 norm of the residuals
   PCL_DEBUG ("[pcl::SampleConsensusModelCone::optimizeModelCoefficients] LM solver finished with exit code %i, having a residual norm of %g. \nInitial solution: %g %g %g %g %g %g %g \nFinal solution: %g %g %g %g %g %g %g\n",
-             info, lm.fvec.norm (), model_coefficients[0], model_coefficients[1], model_coefficients[2], model_coefficients[3],
+             info, residual_norm, model_coefficients[0], model_coefficients[1], model_coefficients[2], model_coefficients[3],
              model_coefficients[4], model_coefficients[5], model_coefficients[6], optimized_coefficients[0], optimized_coefficients[1], optimized_coefficients[2], optimized_coefficients[3], optimized_coefficients[4], optimized_coefficients[5], optimized_coefficients[6]);
 
   Eigen::Vector3f line_dir (optimized_coefficients[3], optimized_coefficients[4], optimized_coefficients[5]);
@@ -41,8 +41,8 @@
 #ifndef PCL_SAMPLE_CONSENSUS_IMPL_SAC_MODEL_CYLINDER_H_
 #define PCL_SAMPLE_CONSENSUS_IMPL_SAC_MODEL_CYLINDER_H_
 
-#include <unsupported/Eigen/NonLinearOptimization> // for LevenbergMarquardt
 #include <pcl/sample_consensus/sac_model_cylinder.h>
+#include <pcl/sample_consensus/sac_levenberg_marquardt.h>
 #include <pcl/common/common.h> // for getAngle3D
 #include <pcl/common/concatenate.h>
 
@@ -149,33 +149,9 @@ pcl::SampleConsensusModelCylinder<PointT, PointNT>::getDistancesToModel (
 
   distances.resize (indices_->size ());
 
-  Eigen::Vector4f line_pt  (model_coefficients[0], model_coefficients[1], model_coefficients[2], 0.0f);
-  Eigen::Vector4f line_dir (model_coefficients[3], model_coefficients[4], model_coefficients[5], 0.0f);
-  float ptdotdir = line_pt.dot (line_dir);
-  float dirdotdir = 1.0f / line_dir.dot (line_dir);
-  // Iterate through the 3d points and calculate the distances from them to the sphere
-  for (std::size_t i = 0; i < indices_->size (); ++i)
-  {
-    // Approximate the distance from the point to the cylinder as the difference between
-    // dist(point,cylinder_axis) and cylinder radius
-    // @note need to revise this.
-    Eigen::Vector4f pt ((*input_)[(*indices_)[i]].x, (*input_)[(*indices_)[i]].y, (*input_)[(*indices_)[i]].z, 0.0f);
-
-    const double weighted_euclid_dist = (1.0 - normal_distance_weight_) * std::abs (pointToLineDistance (pt, model_coefficients) - model_coefficients[6]);
-
-    // Calculate the point's projection on the cylinder axis
-    float k = (pt.dot (line_dir) - ptdotdir) * dirdotdir;
-    Eigen::Vector4f pt_proj = line_pt + k * line_dir;
-    Eigen::Vector4f dir = pt - pt_proj;
-    dir.normalize ();
-
-    // Calculate the angular distance between the point normal and the (dir=pt_proj->pt) vector
-    Eigen::Vector4f n  ((*normals_)[(*indices_)[i]].normal[0], (*normals_)[(*indices_)[i]].normal[1], (*normals_)[(*indices_)[i]].normal[2], 0.0f);
-    double d_normal = std::abs (getAngle3D (n, dir));
-    d_normal = (std::min) (d_normal, M_PI - d_normal);
-
-    distances[i] = std::abs (normal_distance_weight_ * d_normal + weighted_euclid_dist);
-  }
+  forEachDistance ([&] (std::size_t begin, std::size_t count, float *chunk)
+                   { computeDistances (model_coefficients, begin, count, chunk); },
+                   [&] (std::size_t i, float distance) { distances[i] = distance; });
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -195,39 +171,17 @@ pcl::SampleConsensusModelCylinder<PointT, PointNT>::selectWithinDistance (
   inliers.reserve (indices_->size ());
   error_sqr_dists_.reserve (indices_->size ());
 
-  Eigen::Vector4f line_pt  (model_coefficients[0], model_coefficients[1], model_coefficients[2], 0.0f);
-  Eigen::Vector4f line_dir (model_coefficients[3], model_coefficients[4], model_coefficients[5], 0.0f);
-  float ptdotdir = line_pt.dot (line_dir);
-  float dirdotdir = 1.0f / line_dir.dot (line_dir);
-  // Iterate through the 3d points and calculate the distances from them to the sphere
-  for (std::size_t i = 0; i < indices_->size (); ++i)
-  {
-    // Approximate the distance from the point to the cylinder as the difference between
-    // dist(point,cylinder_axis) and cylinder radius
-    Eigen::Vector4f pt ((*input_)[(*indices_)[i]].x, (*input_)[(*indices_)[i]].y, (*input_)[(*indices_)[i]].z, 0.0f);
-    const double weighted_euclid_dist = (1.0 - normal_distance_weight_) * std::abs (pointToLineDistance (pt, model_coefficients) - model_coefficients[6]);
-    if (weighted_euclid_dist > threshold) // Early termination: cannot be an inlier
-      continue;
-
-    // Calculate the point's projection on the cylinder axis
-    float k = (pt.dot (line_dir) - ptdotdir) * dirdotdir;
-    Eigen::Vector4f pt_proj = line_pt + k * line_dir;
-    Eigen::Vector4f dir = pt - pt_proj;
-    dir.normalize ();
-
-    // Calculate the angular distance between the point normal and the (dir=pt_proj->pt) vector
-    Eigen::Vector4f n  ((*normals_)[(*indices_)[i]].normal[0], (*normals_)[(*indices_)[i]].normal[1], (*normals_)[(*indices_)[i]].normal[2], 0.0f);
-    double d_normal = std::abs (getAngle3D (n, dir));
-    d_normal = (std::min) (d_normal, M_PI - d_normal);
-
-    double distance = std::abs (normal_distance_weight_ * d_normal + weighted_euclid_dist);
-    if (distance < threshold)
-    {
-      // Returns the indices of the points whose distances are smaller than the threshold
-      inliers.push_back ((*indices_)[i]);
-      error_sqr_dists_.push_back (distance);
-    }
-  }
+  forEachDistance ([&] (std::size_t begin, std::size_t count, float *chunk)
+                   { computeDistances (model_coefficients, begin, count, chunk); },
+                   [&] (std::size_t i, float distance)
+                   {
+                     if (distance < threshold)
+                     {
+                       // Returns the indices of the points whose distances are smaller than the threshold
+                       inliers.push_back ((*indices_)[i]);
+                       error_sqr_dists_.push_back (static_cast<double> (distance));
+                     }
+                   });
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -240,35 +194,9 @@ pcl::SampleConsensusModelCylinder<PointT, PointNT>::countWithinDistance (
     return (0);
 
   std::size_t nr_p = 0;
-
-  Eigen::Vector4f line_pt  (model_coefficients[0], model_coefficients[1], model_coefficients[2], 0);
-  Eigen::Vector4f line_dir (model_coefficients[3], model_coefficients[4], model_coefficients[5], 0);
-  float ptdotdir = line_pt.dot (line_dir);
-  float dirdotdir = 1.0f / line_dir.dot (line_dir);
-  // Iterate through the 3d points and calculate the distances from them to the sphere
-  for (std::size_t i = 0; i < indices_->size (); ++i)
-  {
-    // Approximate the distance from the point to the cylinder as the difference between
-    // dist(point,cylinder_axis) and cylinder radius
-    Eigen::Vector4f pt ((*input_)[(*indices_)[i]].x, (*input_)[(*indices_)[i]].y, (*input_)[(*indices_)[i]].z, 0.0f);
-    const double weighted_euclid_dist = (1.0 - normal_distance_weight_) * std::abs (pointToLineDistance (pt, model_coefficients) - model_coefficients[6]);
-    if (weighted_euclid_dist > threshold) // Early termination: cannot be an inlier
-      continue;
-
-    // Calculate the point's projection on the cylinder axis
-    float k = (pt.dot (line_dir) - ptdotdir) * dirdotdir;
-    Eigen::Vector4f pt_proj = line_pt + k * line_dir;
-    Eigen::Vector4f dir = pt - pt_proj;
-    dir.normalize ();
-
-    // Calculate the angular distance between the point normal and the (dir=pt_proj->pt) vector
-    Eigen::Vector4f n  ((*normals_)[(*indices_)[i]].normal[0], (*normals_)[(*indices_)[i]].normal[1], (*normals_)[(*indices_)[i]].normal[2], 0.0f);
-    double d_normal = std::abs (getAngle3D (n, dir));
-    d_normal = (std::min) (d_normal, M_PI - d_normal);
-
-    if (std::abs (normal_distance_weight_ * d_normal + weighted_euclid_dist) < threshold)
-      nr_p++;
-  }
+  forEachDistance ([&] (std::size_t begin, std::size_t count, float *chunk)
+                   { computeDistances (model_coefficients, begin, count, chunk); },
+                   [&] (std::size_t, float distance) { nr_p += (distance < threshold); });
   return (nr_p);
 }
 
@@ -293,14 +221,35 @@ pcl::SampleConsensusModelCylinder<PointT, PointNT>::optimizeModelCoefficients (
     return;
   }
 
-  OptimizationFunctor functor (this, inliers);
-  Eigen::NumericalDiff<OptimizationFunctor > num_diff (functor);
-  Eigen::LevenbergMarquardt<Eigen::NumericalDiff<OptimizationFunctor>, float> lm (num_diff);
-  int info = lm.minimize (optimized_coefficients);
-  
+  // Residual d^2 - r^2, with d the distance of the point to the axis. With v = p - l, s = a.a and
+  // t = v.a / s, d^2 = v.v - t (v.a), whose gradient is -2 (v - t a) for l and -2 t (v - t a) for a.
+  using Vector7d = Eigen::Matrix<double, 7, 1>;
+  const auto make_residual = [this, &inliers] (const Vector7d &x)
+  {
+    const Eigen::Vector3d line_pt = x.head<3> ();
+    const Eigen::Vector3d line_dir = x.segment<3> (3);
+    const double inv_sqr_dir_norm = 1.0 / line_dir.squaredNorm ();
+    const double radius = x[6];
+    return [this, &inliers, line_pt, line_dir, inv_sqr_dir_norm, radius] (std::size_t i, Vector7d &gradient)
+    {
+      const Eigen::Vector3d v = (*input_)[inliers[i]].getVector3fMap ().template cast<double> () - line_pt;
+      const double t = v.dot (line_dir) * inv_sqr_dir_norm;
+      const Eigen::Vector3d orthogonal = v - t * line_dir;
+      gradient.head<3> () = -2.0 * orthogonal;
+      gradient.segment<3> (3) = -2.0 * t * orthogonal;
+      gradient[6] = -2.0 * radius;
+      return (orthogonal.dot (v) - radius * radius);
+    };
+  };
+
+  Vector7d x = model_coefficients.head<7> ().template cast<double> ();
+  double residual_norm;
+  const int info = pcl::detail::sacLevenbergMarquardt<7> (make_residual, inliers.size (), x, residual_norm, threads_);
+  optimized_coefficients = x.cast<float> ();
+
   // Compute the L2 norm of the residuals
   PCL_DEBUG ("[pcl::SampleConsensusModelCylinder::optimizeModelCoefficients] LM solver finished with exit code %i, having a residual norm of %g. \nInitial solution: %g %g %g %g %g %g %g \nFinal solution: %g %g %g %g %g %g %g\n",
-             info, lm.fvec.norm (), model_coefficients[0], model_coefficients[1], model_coefficients[2], model_coefficients[3],
+             info, residual_norm, model_coefficients[0], model_coefficients[1], model_coefficients[2], model_coefficients[3],
              model_coefficients[4], model_coefficients[5], model_coefficients[6], optimized_coefficients[0], optimized_coefficients[1], optimized_coefficients[2], optimized_coefficients[3], optimized_coefficients[4], optimized_coefficients[5], optimized_coefficients[6]);
     
   Eigen::Vector3f line_dir (optimized_coefficients[3], optimized_coefficients[4], optimized_coefficients[5]);
@@ -421,6 +370,21 @@ pcl::SampleConsensusModelCylinder<PointT, PointNT>::doSamplesVerifyModel (
   return (true);
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT, typename PointNT> void
+pcl::SampleConsensusModelCylinder<PointT, PointNT>::computeDistances (
+      const Eigen::VectorXf &model_coefficients, std::size_t begin, std::size_t count, float *distances) const
+{
+  // Approximate the distance from the point to the cylinder as the difference between
+  // dist(point,cylinder_axis) and cylinder radius, weighted with the angular distance between the
+  // point normal and the direction from the axis to the point
+  const index_t *indices = indices_->data () + begin;
+  pcl::detail::computeCylinderDistances (
+      pcl::detail::makeSACFieldView (*input_, (*input_)[0].x, indices),
+      pcl::detail::makeSACFieldView (*normals_, (*normals_)[0].normal_x, indices), count,
+      model_coefficients, static_cast<float> (normal_distance_weight_), distances);
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointT, typename PointNT> double
 pcl::SampleConsensusModelCylinder<PointT, PointNT>::pointToLineDistance (
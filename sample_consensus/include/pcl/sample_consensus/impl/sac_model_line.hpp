@@ -117,19 +117,12 @@ pcl::SampleConsensusModelLine<PointT>::getDistancesToModel (
 
   distances.resize (indices_->size ());
 
-  // Obtain the line point and direction
-  Eigen::Vector4f line_pt  (model_coefficients[0], model_coefficients[1], model_coefficients[2], 0);
-  Eigen::Vector4f line_dir (model_coefficients[3], model_coefficients[4], model_coefficients[5], 0);
-  line_dir.normalize ();
-
-  // Iterate through the 3d points and calculate the distances from them to the line
-  for (std::size_t i = 0; i < indices_->size (); ++i)
-  {
-    // Calculate the distance from the point to the line
-    // D = ||(P2-P1) x (P1-P0)|| / ||P2-P1|| = norm (cross (p2-p1, p2-p0)) / norm(p2-p1)
-    // Need to estimate sqrt here to keep MSAC and friends general
-    distances[i] = sqrt ((line_pt - (*input_)[(*indices_)[i]].getVector4fMap ()).cross3 (line_dir).squaredNorm ());
-  }
+  // Calculate the distance from the point to the line
+  // D = ||(P2-P1) x (P1-P0)|| / ||P2-P1|| = norm (cross (p2-p1, p2-p0)) / norm(p2-p1)
+  // Need to estimate sqrt here to keep MSAC and friends general
+  forEachDistance ([&] (std::size_t begin, std::size_t count, float *chunk)
+                   { computeDistances (model_coefficients, begin, count, chunk); },
+                   [&] (std::size_t i, float distance) { distances[i] = distance; });
 }
 
 //////////////////////////////////////////////////////////////////////////
@@ -141,32 +134,22 @@ pcl::SampleConsensusModelLine<PointT>::selectWithinDistance (
   if (!isModelValid (model_coefficients))
     return;
 
-  double sqr_threshold = threshold * threshold;
-
   inliers.clear ();
   error_sqr_dists_.clear ();
   inliers.reserve (indices_->size ());
   error_sqr_dists_.reserve (indices_->size ());
 
-  // Obtain the line point and direction
-  Eigen::Vector4f line_pt  (model_coefficients[0], model_coefficients[1], model_coefficients[2], 0);
-  Eigen::Vector4f line_dir (model_coefficients[3], model_coefficients[4], model_coefficients[5], 0);
-  line_dir.normalize ();
-
-  // Iterate through the 3d points and calculate the distances from them to the line
-  for (std::size_t i = 0; i < indices_->size (); ++i)
-  {
-    // Calculate the distance from the point to the line
-    // D = ||(P2-P1) x (P1-P0)|| / ||P2-P1|| = norm (cross (p2-p1, p2-p0)) / norm(p2-p1)
-    double sqr_distance = (line_pt - (*input_)[(*indices_)[i]].getVector4fMap ()).cross3 (line_dir).squaredNorm ();
-
-    if (sqr_distance < sqr_threshold)
-    {
-      // Returns the indices of the points whose squared distances are smaller than the threshold
-      inliers.push_back ((*indices_)[i]);
-      error_sqr_dists_.push_back (sqr_distance);
-    }
-  }
+  forEachDistance ([&] (std::size_t begin, std::size_t count, float *chunk)
+                   { computeDistances (model_coefficients, begin, count, chunk); },
+                   [&] (std::size_t i, float distance)
+                   {
+                     if (distance < threshold)
+                     {
+                       // Returns the indices of the points whose squared distances are smaller than the threshold
+                       inliers.push_back ((*indices_)[i]);
+                       error_sqr_dists_.push_back (static_cast<double> (distance) * distance);
+                     }
+                   });
 }
 
 //////////////////////////////////////////////////////////////////////////
@@ -178,25 +161,10 @@ pcl::SampleConsensusModelLine<PointT>::countWithinDistance (
   if (!isModelValid (model_coefficients))
     return (0);
 
-  double sqr_threshold = threshold * threshold;
-
   std::size_t nr_p = 0;
-
-  // Obtain the line point and direction
-  Eigen::Vector4f line_pt  (model_coefficients[0], model_coefficients[1], model_coefficients[2], 0.0f);
-  Eigen::Vector4f line_dir (model_coefficients[3], model_coefficients[4], model_coefficients[5], 0.0f);
-  line_dir.normalize ();
-
-  // Iterate through the 3d points and calculate the distances from them to the line
-  for (std::size_t i = 0; i < indices_->size (); ++i)
-  {
-    // Calculate the distance from the point to the line
-    // D = ||(P2-P1) x (P1-P0)|| / ||P2-P1|| = norm (cross (p2-p1, p2-p0)) / norm(p2-p1)
-    double sqr_distance = (line_pt - (*input_)[(*indices_)[i]].getVector4fMap ()).cross3 (line_dir).squaredNorm ();
-
-    if (sqr_distance < sqr_threshold)
-      nr_p++;
-  }
+  forEachDistance ([&] (std::size_t begin, std::size_t count, float *chunk)
+                   { computeDistances (model_coefficients, begin, count, chunk); },
+                   [&] (std::size_t, float distance) { nr_p += (distance < threshold); });
   return (nr_p);
 }
 
@@ -346,6 +314,20 @@ pcl::SampleConsensusModelLine<PointT>::doSamplesVerifyModel (
   return (true);
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::SampleConsensusModelLine<PointT>::computeDistances (
+      const Eigen::VectorXf &model_coefficients, std::size_t begin, std::size_t count, float *distances) const
+{
+  // Obtain the line point and direction
+  const Eigen::Vector3f line_pt (model_coefficients[0], model_coefficients[1], model_coefficients[2]);
+  const Eigen::Vector3f line_dir = Eigen::Vector3f (model_coefficients[3], model_coefficients[4], model_coefficients[5]).normalized ();
+
+  pcl::detail::computeLineDistances (
+      pcl::detail::makeSACFieldView (*input_, (*input_)[0].x, indices_->data () + begin), count,
+      line_pt, line_dir, distances);
+}
+
 #define PCL_INSTANTIATE_SampleConsensusModelLine(T) template class PCL_EXPORTS pcl::SampleConsensusModelLine<T>;
 
 #endif    // PCL_SAMPLE_CONSENSUS_IMPL_SAC_MODEL_LINE_H_
@@ -64,41 +64,22 @@ pcl::SampleConsensusModelNormalPlane<PointT, PointNT>::selectWithinDistance (
     return;
   }
 
-  // Obtain the plane normal
-  Eigen::Vector4f coeff = model_coefficients;
-  coeff[3] = 0.0f;
-
   inliers.clear ();
   error_sqr_dists_.clear ();
   inliers.reserve (indices_->size ());
   error_sqr_dists_.reserve (indices_->size ());
 
-  // Iterate through the 3d points and calculate the distances from them to the plane
-  for (std::size_t i = 0; i < indices_->size (); ++i)
-  {
-    const PointT  &pt = (*input_)[(*indices_)[i]];
-    const PointNT &nt = (*normals_)[(*indices_)[i]];
-    // Calculate the distance from the point to the plane normal as the dot product
-    // D = (P-A).N/|N|
-    Eigen::Vector4f p (pt.x, pt.y, pt.z, 0.0f);
-    Eigen::Vector4f n (nt.normal_x, nt.normal_y, nt.normal_z, 0.0f);
-    double d_euclid = std::abs (coeff.dot (p) + model_coefficients[3]);
-
-    // Calculate the angular distance between the point normal and the plane normal
-    double d_normal = std::abs (getAngle3D (n, coeff));
-    d_normal = (std::min) (d_normal, M_PI - d_normal);
-
-    // Weight with the point curvature. On flat surfaces, curvature -> 0, which means the normal will have a higher influence
-    double weight = normal_distance_weight_ * (1.0 - nt.curvature);
-
-    double distance = std::abs (weight * d_normal + (1.0 - weight) * d_euclid); 
-    if (distance < threshold)
-    {
-      // Returns the indices of the points whose distances are smaller than the threshold
-      inliers.push_back ((*indices_)[i]);
-      error_sqr_dists_.push_back (distance);
-    }
-  }
+  forEachDistance ([&] (std::size_t begin, std::size_t count, float *chunk)
+                   { computeDistances (model_coefficients, begin, count, chunk); },
+                   [&] (std::size_t i, float distance)
+                   {
+                     if (distance < threshold)
+                     {
+                       // Returns the indices of the points whose distances are smaller than the threshold
+                       inliers.push_back ((*indices_)[i]);
+                       error_sqr_dists_.push_back (static_cast<double> (distance));
+                     }
+                   });
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -116,13 +97,11 @@ pcl::SampleConsensusModelNormalPlane<PointT, PointNT>::countWithinDistance (
   if (!isModelValid (model_coefficients))
     return (0);
 
-#if defined (__AVX__) && defined (__AVX2__)
-  return countWithinDistanceAVX (model_coefficients, threshold);
-#elif defined (__SSE__) && defined (__SSE2__) && defined (__SSE4_1__)
-  return countWithinDistanceSSE (model_coefficients, threshold);
-#else
-  return countWithinDistanceStandard (model_coefficients, threshold);
-#endif
+  std::size_t nr_p = 0;
+  forEachDistance ([&] (std::size_t begin, std::size_t count, float *chunk)
+                   { computeDistances (model_coefficients, begin, count, chunk); },
+                   [&] (std::size_t, float distance) { nr_p += (distance < threshold); });
+  return (nr_p);
 }
 
 //////////////////////////////////////////////////////////////////////////
@@ -306,32 +285,26 @@ pcl::SampleConsensusModelNormalPlane<PointT, PointNT>::getDistancesToModel (
     return;
   }
 
-  // Obtain the plane normal
-  Eigen::Vector4f coeff = model_coefficients;
-  coeff[3] = 0.0f;
-
   distances.resize (indices_->size ());
 
-  // Iterate through the 3d points and calculate the distances from them to the plane
-  for (std::size_t i = 0; i < indices_->size (); ++i)
-  {
-    const PointT  &pt = (*input_)[(*indices_)[i]];
-    const PointNT &nt = (*normals_)[(*indices_)[i]];
-    // Calculate the distance from the point to the plane normal as the dot product
-    // D = (P-A).N/|N|
-    Eigen::Vector4f p (pt.x, pt.y, pt.z, 0.0f);
-    Eigen::Vector4f n (nt.normal_x, nt.normal_y, nt.normal_z, 0.0f);
-    double d_euclid = std::abs (coeff.dot (p) + model_coefficients[3]);
-
-    // Calculate the angular distance between the point normal and the plane normal
-    double d_normal = std::abs (getAngle3D (n, coeff));
-    d_normal = (std::min) (d_normal, M_PI - d_normal);
-
-    // Weight with the point curvature. On flat surfaces, curvature -> 0, which means the normal will have a higher influence
-    double weight = normal_distance_weight_ * (1.0 - nt.curvature);
+  forEachDistance ([&] (std::size_t begin, std::size_t count, float *chunk)
+                   { computeDistances (model_coefficients, begin, count, chunk); },
+                   [&] (std::size_t i, float distance) { distances[i] = distance; });
+}
 
-    distances[i] = std::abs (weight * d_normal + (1.0 - weight) * d_euclid);
-  }
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT, typename PointNT> void
+pcl::SampleConsensusModelNormalPlane<PointT, PointNT>::computeDistances (
+      const Eigen::VectorXf &model_coefficients, std::size_t begin, std::size_t count, float *distances) const
+{
+  // Combine the distance from the point to the plane with the angular distance between the point
+  // normal and the plane normal, weighted with the point curvature
+  const index_t *indices = indices_->data () + begin;
+  pcl::detail::computeNormalPlaneDistances (
+      pcl::detail::makeSACFieldView (*input_, (*input_)[0].x, indices),
+      pcl::detail::makeSACFieldView (*normals_, (*normals_)[0].normal_x, indices),
+      pcl::detail::makeSACFieldView (*normals_, (*normals_)[0].curvature, indices), count,
+      model_coefficients.head<4> (), static_cast<float> (normal_distance_weight_), distances);
 }
 
 #define PCL_INSTANTIATE_SampleConsensusModelNormalPlane(PointT, PointNT) template class PCL_EXPORTS pcl::SampleConsensusModelNormalPlane<PointT, PointNT>;
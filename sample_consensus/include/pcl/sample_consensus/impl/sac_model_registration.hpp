@@ -120,26 +120,11 @@ pcl::SampleConsensusModelRegistration<PointT>::getDistancesToModel (const Eigen:
   distances.resize (indices_->size ());
 
   // Get the 4x4 transformation
-  Eigen::Matrix4f transform;
-  transform.row (0).matrix () = model_coefficients.segment<4>(0);
-  transform.row (1).matrix () = model_coefficients.segment<4>(4);
-  transform.row (2).matrix () = model_coefficients.segment<4>(8);
-  transform.row (3).matrix () = model_coefficients.segment<4>(12);
-
-  for (std::size_t i = 0; i < indices_->size (); ++i)
-  {
-    Eigen::Vector4f pt_src ((*input_)[(*indices_)[i]].x, 
-                            (*input_)[(*indices_)[i]].y, 
-                            (*input_)[(*indices_)[i]].z, 1.0f);
-    Eigen::Vector4f pt_tgt ((*target_)[(*indices_tgt_)[i]].x, 
-                            (*target_)[(*indices_tgt_)[i]].y, 
-                            (*target_)[(*indices_tgt_)[i]].z, 1.0f);
-
-    Eigen::Vector4f p_tr (transform * pt_src);
-    // Calculate the distance from the transformed point to its correspondence
-    // need to compute the real norm here to keep MSAC and friends general
-    distances[i] = (p_tr - pt_tgt).norm ();
-  }
+  // Calculate the distance from the transformed point to its correspondence
+  // need to compute the real norm here to keep MSAC and friends general
+  forEachDistance ([&] (std::size_t begin, std::size_t count, float *chunk)
+                   { computeDistances (model_coefficients, begin, count, chunk); },
+                   [&] (std::size_t i, float distance) { distances[i] = distance; });
 }
 
 //////////////////////////////////////////////////////////////////////////
@@ -158,8 +143,6 @@ pcl::SampleConsensusModelRegistration<PointT>::selectWithinDistance (const Eigen
     return;
   }
 
-  double thresh = threshold * threshold;
-
   // Check if the model is valid given the user constraints
   if (!isModelValid (model_coefficients))
   {
@@ -172,31 +155,17 @@ pcl::SampleConsensusModelRegistration<PointT>::selectWithinDistance (const Eigen
   inliers.reserve (indices_->size ());
   error_sqr_dists_.reserve (indices_->size ());
 
-  Eigen::Matrix4f transform;
-  transform.row (0).matrix () = model_coefficients.segment<4>(0);
-  transform.row (1).matrix () = model_coefficients.segment<4>(4);
-  transform.row (2).matrix () = model_coefficients.segment<4>(8);
-  transform.row (3).matrix () = model_coefficients.segment<4>(12);
-
-  for (std::size_t i = 0; i < indices_->size (); ++i)
-  {
-    Eigen::Vector4f pt_src ((*input_)[(*indices_)[i]].x, 
-                            (*input_)[(*indices_)[i]].y, 
-                            (*input_)[(*indices_)[i]].z, 1); 
-    Eigen::Vector4f pt_tgt ((*target_)[(*indices_tgt_)[i]].x, 
-                            (*target_)[(*indices_tgt_)[i]].y, 
-                            (*target_)[(*indices_tgt_)[i]].z, 1); 
-
-    Eigen::Vector4f p_tr (transform * pt_src);
-  
-    float distance = (p_tr - pt_tgt).squaredNorm (); 
-    // Calculate the distance from the transformed point to its correspondence
-    if (distance < thresh)
-    {
-      inliers.push_back ((*indices_)[i]);
-      error_sqr_dists_.push_back (static_cast<double> (distance));
-    }
-  }
+  forEachDistance ([&] (std::size_t begin, std::size_t count, float *chunk)
+                   { computeDistances (model_coefficients, begin, count, chunk); },
+                   [&] (std::size_t i, float distance)
+                   {
+                     // Calculate the distance from the transformed point to its correspondence
+                     if (distance < threshold)
+                     {
+                       inliers.push_back ((*indices_)[i]);
+                       error_sqr_dists_.push_back (static_cast<double> (distance) * distance);
+                     }
+                   });
 } 
 
 //////////////////////////////////////////////////////////////////////////
@@ -215,35 +184,16 @@ pcl::SampleConsensusModelRegistration<PointT>::countWithinDistance (
     return (0);
   }
 
-  double thresh = threshold * threshold;
-
   // Check if the model is valid given the user constraints
   if (!isModelValid (model_coefficients))
   {
     return (0);
   }
   
-  Eigen::Matrix4f transform;
-  transform.row (0).matrix () = model_coefficients.segment<4>(0);
-  transform.row (1).matrix () = model_coefficients.segment<4>(4);
-  transform.row (2).matrix () = model_coefficients.segment<4>(8);
-  transform.row (3).matrix () = model_coefficients.segment<4>(12);
-
   std::size_t nr_p = 0;
-  for (std::size_t i = 0; i < indices_->size (); ++i)
-  {
-    Eigen::Vector4f pt_src ((*input_)[(*indices_)[i]].x, 
-                            (*input_)[(*indices_)[i]].y, 
-                            (*input_)[(*indices_)[i]].z, 1); 
-    Eigen::Vector4f pt_tgt ((*target_)[(*indices_tgt_)[i]].x, 
-                            (*target_)[(*indices_tgt_)[i]].y, 
-                            (*target_)[(*indices_tgt_)[i]].z, 1); 
-
-    Eigen::Vector4f p_tr (transform * pt_src);
-    // Calculate the distance from the transformed point to its correspondence
-    if ((p_tr - pt_tgt).squaredNorm () < thresh)
-      nr_p++;
-  }
+  forEachDistance ([&] (std::size_t begin, std::size_t count, float *chunk)
+                   { computeDistances (model_coefficients, begin, count, chunk); },
+                   [&] (std::size_t, float distance) { nr_p += (distance < threshold); });
   return (nr_p);
 } 
 
@@ -295,22 +245,36 @@ pcl::SampleConsensusModelRegistration<PointT>::estimateRigidTransformationSVD (
 {
   transform.resize (16);
 
-  Eigen::Matrix<double, 3, Eigen::Dynamic> src (3, indices_src.size ());
-  Eigen::Matrix<double, 3, Eigen::Dynamic> tgt (3, indices_tgt.size ());
-
-  for (std::size_t i = 0; i < indices_src.size (); ++i)
+  const auto fill = [&] (auto &src, auto &tgt)
   {
-    src (0, i) = cloud_src[indices_src[i]].x;
-    src (1, i) = cloud_src[indices_src[i]].y;
-    src (2, i) = cloud_src[indices_src[i]].z;
+    for (std::size_t i = 0; i < indices_src.size (); ++i)
+    {
+      src (0, i) = cloud_src[indices_src[i]].x;
+      src (1, i) = cloud_src[indices_src[i]].y;
+      src (2, i) = cloud_src[indices_src[i]].z;
 
-    tgt (0, i) = cloud_tgt[indices_tgt[i]].x;
-    tgt (1, i) = cloud_tgt[indices_tgt[i]].y;
-    tgt (2, i) = cloud_tgt[indices_tgt[i]].z;
-  }
+      tgt (0, i) = cloud_tgt[indices_tgt[i]].x;
+      tgt (1, i) = cloud_tgt[indices_tgt[i]].y;
+      tgt (2, i) = cloud_tgt[indices_tgt[i]].z;
+    }
+  };
 
-  // Call Umeyama directly from Eigen
-  Eigen::Matrix4d transformation_matrix = pcl::umeyama (src, tgt, false);
+  // Call Umeyama directly from Eigen. The minimal samples of computeModelCoefficients
+  // use fixed-size matrices, which keeps the hypothesis generation free of allocations.
+  Eigen::Matrix4d transformation_matrix;
+  if (indices_src.size () == 3)
+  {
+    Eigen::Matrix3d src, tgt;
+    fill (src, tgt);
+    transformation_matrix = pcl::umeyama (src, tgt, false);
+  }
+  else
+  {
+    Eigen::Matrix<double, 3, Eigen::Dynamic> src (3, indices_src.size ());
+    Eigen::Matrix<double, 3, Eigen::Dynamic> tgt (3, indices_tgt.size ());
+    fill (src, tgt);
+    transformation_matrix = pcl::umeyama (src, tgt, false);
+  }
 
   // Return the correct transformation
   transform.segment<4> (0).matrix () = transformation_matrix.cast<float> ().row (0); 
@@ -319,6 +283,24 @@ pcl::SampleConsensusModelRegistration<PointT>::estimateRigidTransformationSVD (
   transform.segment<4> (12).matrix () = transformation_matrix.cast<float> ().row (3);
 }
 
+//////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::SampleConsensusModelRegistration<PointT>::computeDistances (
+      const Eigen::VectorXf &model_coefficients, std::size_t begin, std::size_t count, float *distances) const
+{
+  // Get the 4x4 transformation
+  Eigen::Matrix4f transform;
+  transform.row (0).matrix () = model_coefficients.segment<4>(0);
+  transform.row (1).matrix () = model_coefficients.segment<4>(4);
+  transform.row (2).matrix () = model_coefficients.segment<4>(8);
+  transform.row (3).matrix () = model_coefficients.segment<4>(12);
+
+  pcl::detail::computeRegistrationDistances (
+      pcl::detail::makeSACFieldView (*input_, (*input_)[0].x, indices_->data () + begin),
+      pcl::detail::makeSACFieldView (*target_, (*target_)[0].x, indices_tgt_->data () + begin), count,
+      transform, distances);
+}
+
 #define PCL_INSTANTIATE_SampleConsensusModelRegistration(T) template class PCL_EXPORTS pcl::SampleConsensusModelRegistration<T>;
 
 #endif    // PCL_SAMPLE_CONSENSUS_IMPL_SAC_MODEL_REGISTRATION_H_
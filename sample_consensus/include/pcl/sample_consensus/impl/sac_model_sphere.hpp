@@ -41,8 +41,8 @@
 #ifndef PCL_SAMPLE_CONSENSUS_IMPL_SAC_MODEL_SPHERE_H_
 #define PCL_SAMPLE_CONSENSUS_IMPL_SAC_MODEL_SPHERE_H_
 
-#include <unsupported/Eigen/NonLinearOptimization> // for LevenbergMarquardt
 #include <pcl/sample_consensus/sac_model_sphere.h>
+#include <pcl/sample_consensus/sac_levenberg_marquardt.h>
 
 //////////////////////////////////////////////////////////////////////////
 template <typename PointT> bool
@@ -128,32 +128,6 @@ pcl::SampleConsensusModelSphere<PointT>::computeModelCoefficients (
   return (true);
 }
 
-#define AT(POS) ((*input_)[(*indices_)[(POS)]])
-
-#ifdef __AVX__
-// This function computes the squared distances (i.e. the distances without the square root) of 8 points to the center of the sphere
-template <typename PointT> inline __m256 pcl::SampleConsensusModelSphere<PointT>::sqr_dist8 (const std::size_t i, const __m256 a_vec, const __m256 b_vec, const __m256 c_vec) const
-{
-  const __m256 tmp1 = _mm256_sub_ps (_mm256_set_ps (AT(i  ).x, AT(i+1).x, AT(i+2).x, AT(i+3).x, AT(i+4).x, AT(i+5).x, AT(i+6).x, AT(i+7).x), a_vec);
-  const __m256 tmp2 = _mm256_sub_ps (_mm256_set_ps (AT(i  ).y, AT(i+1).y, AT(i+2).y, AT(i+3).y, AT(i+4).y, AT(i+5).y, AT(i+6).y, AT(i+7).y), b_vec);
-  const __m256 tmp3 = _mm256_sub_ps (_mm256_set_ps (AT(i  ).z, AT(i+1).z, AT(i+2).z, AT(i+3).z, AT(i+4).z, AT(i+5).z, AT(i+6).z, AT(i+7).z), c_vec);
-  return _mm256_add_ps (_mm256_add_ps (_mm256_mul_ps (tmp1, tmp1), _mm256_mul_ps (tmp2, tmp2)), _mm256_mul_ps(tmp3, tmp3));
-}
-#endif // ifdef __AVX__
-
-#ifdef __SSE__
-// This function computes the squared distances (i.e. the distances without the square root) of 4 points to the center of the sphere
-template <typename PointT> inline __m128 pcl::SampleConsensusModelSphere<PointT>::sqr_dist4 (const std::size_t i, const __m128 a_vec, const __m128 b_vec, const __m128 c_vec) const
-{
-  const __m128 tmp1 = _mm_sub_ps (_mm_set_ps (AT(i  ).x, AT(i+1).x, AT(i+2).x, AT(i+3).x), a_vec);
-  const __m128 tmp2 = _mm_sub_ps (_mm_set_ps (AT(i  ).y, AT(i+1).y, AT(i+2).y, AT(i+3).y), b_vec);
-  const __m128 tmp3 = _mm_sub_ps (_mm_set_ps (AT(i  ).z, AT(i+1).z, AT(i+2).z, AT(i+3).z), c_vec);
-  return _mm_add_ps (_mm_add_ps (_mm_mul_ps (tmp1, tmp1), _mm_mul_ps (tmp2, tmp2)), _mm_mul_ps(tmp3, tmp3));
-}
-#endif // ifdef __SSE__
-
-#undef AT
-
 //////////////////////////////////////////////////////////////////////////
 template <typename PointT> void
 pcl::SampleConsensusModelSphere<PointT>::getDistancesToModel (
@@ -167,14 +141,11 @@ pcl::SampleConsensusModelSphere<PointT>::getDistancesToModel (
   }
   distances.resize (indices_->size ());
 
-  const Eigen::Vector3f center (model_coefficients[0], model_coefficients[1], model_coefficients[2]);
-  // Iterate through the 3d points and calculate the distances from them to the sphere
-  for (std::size_t i = 0; i < indices_->size (); ++i)
-  {
-    // Calculate the distance from the point to the sphere as the difference between
-    //dist(point,sphere_origin) and sphere_radius
-    distances[i] = std::abs (((*input_)[(*indices_)[i]].getVector3fMap () - center).norm () - model_coefficients[3]);
-  }
+  // Calculate the distance from the point to the sphere as the difference between
+  // dist(point,sphere_origin) and sphere_radius
+  forEachDistance ([&] (std::size_t begin, std::size_t count, float *chunk)
+                   { computeDistances (model_coefficients, begin, count, chunk); },
+                   [&] (std::size_t i, float distance) { distances[i] = distance; });
 }
 
 //////////////////////////////////////////////////////////////////////////
@@ -194,23 +165,18 @@ pcl::SampleConsensusModelSphere<PointT>::selectWithinDistance (
   inliers.reserve (indices_->size ());
   error_sqr_dists_.reserve (indices_->size ());
 
-  const float sqr_inner_radius = (model_coefficients[3] <= threshold ? 0.0f : (model_coefficients[3] - threshold) * (model_coefficients[3] - threshold));
-  const float sqr_outer_radius = (model_coefficients[3] + threshold) * (model_coefficients[3] + threshold);
-  const Eigen::Vector3f center (model_coefficients[0], model_coefficients[1], model_coefficients[2]);
-  // Iterate through the 3d points and calculate the distances from them to the sphere
-  for (std::size_t i = 0; i < indices_->size (); ++i)
-  {
-    // To avoid sqrt computation: consider one larger sphere (radius + threshold) and one smaller sphere (radius - threshold).
-    // Valid if point is in larger sphere, but not in smaller sphere.
-    const float sqr_dist = ((*input_)[(*indices_)[i]].getVector3fMap () - center).squaredNorm ();
-    if ((sqr_dist <= sqr_outer_radius) && (sqr_dist >= sqr_inner_radius))
-    {
-      // Returns the indices of the points whose distances are smaller than the threshold
-      inliers.push_back ((*indices_)[i]);
-      // Only compute exact distance if necessary (if point is inlier)
-      error_sqr_dists_.push_back (static_cast<double> (std::abs (std::sqrt (sqr_dist) - model_coefficients[3])));
-    }
-  }
+  // A point is an inlier if it lies in the shell between radius - threshold and radius + threshold
+  forEachDistance ([&] (std::size_t begin, std::size_t count, float *chunk)
+                   { computeDistances (model_coefficients, begin, count, chunk); },
+                   [&] (std::size_t i, float distance)
+                   {
+                     if (distance <= threshold)
+                     {
+                       // Returns the indices of the points whose distances are smaller than the threshold
+                       inliers.push_back ((*indices_)[i]);
+                       error_sqr_dists_.push_back (static_cast<double> (distance));
+                     }
+                   });
 }
 
 //////////////////////////////////////////////////////////////////////////
@@ -222,69 +188,46 @@ pcl::SampleConsensusModelSphere<PointT>::countWithinDistance (
   if (!isModelValid (model_coefficients))
     return (0);
 
-#if defined (__AVX__) && defined (__AVX2__)
-  return countWithinDistanceAVX (model_coefficients, threshold);
-#elif defined (__SSE__) && defined (__SSE2__) && defined (__SSE4_1__)
-  return countWithinDistanceSSE (model_coefficients, threshold);
-#else
-  return countWithinDistanceStandard (model_coefficients, threshold);
-#endif
+  std::size_t nr_p = 0;
+  forEachDistance ([&] (std::size_t begin, std::size_t count, float *chunk)
+                   { computeDistances (model_coefficients, begin, count, chunk); },
+                   [&] (std::size_t, float distance) { nr_p += (distance <= threshold); });
+  return (nr_p);
 }
 
 //////////////////////////////////////////////////////////////////////////
 template <typename PointT> std::size_t
-pcl::SampleConsensusModelSphere<PointT>::countWithinDistanceStandard (
+pcl::SampleConsensusModelSphere<PointT>::countWithinDistanceFrom (
       const Eigen::VectorXf &model_coefficients, const double threshold, std::size_t i) const
 {
+  constexpr std::size_t chunk_size = 1024;
+  float distances[chunk_size];
   std::size_t nr_p = 0;
-  const float sqr_inner_radius = (model_coefficients[3] <= threshold ? 0.0f : (model_coefficients[3] - threshold) * (model_coefficients[3] - threshold));
-  const float sqr_outer_radius = (model_coefficients[3] + threshold) * (model_coefficients[3] + threshold);
-  const Eigen::Vector3f center (model_coefficients[0], model_coefficients[1], model_coefficients[2]);
-  // Iterate through the 3d points and calculate the distances from them to the sphere
-  for (; i < indices_->size (); ++i)
+  for (; i < indices_->size (); i += chunk_size)
   {
-    // To avoid sqrt computation: consider one larger sphere (radius + threshold) and one smaller sphere (radius - threshold).
-    // Valid if point is in larger sphere, but not in smaller sphere.
-    const float sqr_dist = ((*input_)[(*indices_)[i]].getVector3fMap () - center).squaredNorm ();
-    if ((sqr_dist <= sqr_outer_radius) && (sqr_dist >= sqr_inner_radius))
-      nr_p++;
+    const std::size_t count = (std::min) (chunk_size, indices_->size () - i);
+    computeDistances (model_coefficients, i, count, distances);
+    for (std::size_t k = 0; k < count; ++k)
+      nr_p += (distances[k] <= threshold);
   }
   return (nr_p);
 }
 
+//////////////////////////////////////////////////////////////////////////
+template <typename PointT> std::size_t
+pcl::SampleConsensusModelSphere<PointT>::countWithinDistanceStandard (
+      const Eigen::VectorXf &model_coefficients, const double threshold, std::size_t i) const
+{
+  return (countWithinDistanceFrom (model_coefficients, threshold, i));
+}
+
 //////////////////////////////////////////////////////////////////////////
 #if defined (__SSE__) && defined (__SSE2__) && defined (__SSE4_1__)
 template <typename PointT> std::size_t
 pcl::SampleConsensusModelSphere<PointT>::countWithinDistanceSSE (
       const Eigen::VectorXf &model_coefficients, const double threshold, std::size_t i) const
 {
-  std::size_t nr_p = 0;
-  const __m128 a_vec = _mm_set1_ps (model_coefficients[0]);
-  const __m128 b_vec = _mm_set1_ps (model_coefficients[1]);
-  const __m128 c_vec = _mm_set1_ps (model_coefficients[2]);
-  // To avoid sqrt computation: consider one larger sphere (radius + threshold) and one smaller sphere (radius - threshold). Valid if point is in larger sphere, but not in smaller sphere.
-  const __m128 sqr_inner_radius = _mm_set1_ps ((model_coefficients[3] <= threshold ? 0.0 : (model_coefficients[3]-threshold)*(model_coefficients[3]-threshold)));
-  const __m128 sqr_outer_radius = _mm_set1_ps ((model_coefficients[3]+threshold)*(model_coefficients[3]+threshold));
-  __m128i res = _mm_set1_epi32(0); // This corresponds to nr_p: 4 32bit integers that, summed together, hold the number of inliers
-  for (; (i + 4) <= indices_->size (); i += 4)
-  {
-    const __m128 sqr_dist = sqr_dist4 (i, a_vec, b_vec, c_vec);
-    const __m128 mask = _mm_and_ps (_mm_cmplt_ps (sqr_inner_radius, sqr_dist), _mm_cmplt_ps (sqr_dist, sqr_outer_radius)); // The mask contains 1 bits if the corresponding points are inliers, else 0 bits
-    res = _mm_add_epi32 (res, _mm_and_si128 (_mm_set1_epi32 (1), _mm_castps_si128 (mask))); // The latter part creates a vector with ones (as 32bit integers) where the points are inliers
-    //const int res = _mm_movemask_ps (mask);
-    //if (res & 1) nr_p++;
-    //if (res & 2) nr_p++;
-    //if (res & 4) nr_p++;
-    //if (res & 8) nr_p++;
-  }
-  nr_p += _mm_extract_epi32 (res, 0);
-  nr_p += _mm_extract_epi32 (res, 1);
-  nr_p += _mm_extract_epi32 (res, 2);
-  nr_p += _mm_extract_epi32 (res, 3);
-
-  // Process the remaining points (at most 3)
-  nr_p += countWithinDistanceStandard (model_coefficients, threshold, i);
-  return (nr_p);
+  return (countWithinDistanceFrom (model_coefficients, threshold, i));
 }
 #endif
 
@@ -294,44 +237,20 @@ template <typename PointT> std::size_t
 pcl::SampleConsensusModelSphere<PointT>::countWithinDistanceAVX (
       const Eigen::VectorXf &model_coefficients, const double threshold, std::size_t i) const
 {
-  std::size_t nr_p = 0;
-  const __m256 a_vec = _mm256_set1_ps (model_coefficients[0]);
-  const __m256 b_vec = _mm256_set1_ps (model_coefficients[1]);
-  const __m256 c_vec = _mm256_set1_ps (model_coefficients[2]);
-  // To avoid sqrt computation: consider one larger sphere (radius + threshold) and one smaller sphere (radius - threshold). Valid if point is in larger sphere, but not in smaller sphere.
-  const __m256 sqr_inner_radius = _mm256_set1_ps ((model_coefficients[3] <= threshold ? 0.0 : (model_coefficients[3]-threshold)*(model_coefficients[3]-threshold)));
-  const __m256 sqr_outer_radius = _mm256_set1_ps ((model_coefficients[3]+threshold)*(model_coefficients[3]+threshold));
-  __m256i res = _mm256_set1_epi32(0); // This corresponds to nr_p: 8 32bit integers that, summed together, hold the number of inliers
-  for (; (i + 8) <= indices_->size (); i += 8)
-  {
-    const __m256 sqr_dist = sqr_dist8 (i, a_vec, b_vec, c_vec);
-    const __m256 mask = _mm256_and_ps (_mm256_cmp_ps (sqr_inner_radius, sqr_dist, _CMP_LT_OQ), _mm256_cmp_ps (sqr_dist, sqr_outer_radius, _CMP_LT_OQ)); // The mask contains 1 bits if the corresponding points are inliers, else 0 bits
-    res = _mm256_add_epi32 (res, _mm256_and_si256 (_mm256_set1_epi32 (1), _mm256_castps_si256 (mask))); // The latter part creates a vector with ones (as 32bit integers) where the points are inliers
-    //const int res = _mm256_movemask_ps (mask);
-    //if (res &   1) nr_p++;
-    //if (res &   2) nr_p++;
-    //if (res &   4) nr_p++;
-    //if (res &   8) nr_p++;
-    //if (res &  16) nr_p++;
-    //if (res &  32) nr_p++;
-    //if (res &  64) nr_p++;
-    //if (res & 128) nr_p++;
-  }
-  nr_p += _mm256_extract_epi32 (res, 0);
-  nr_p += _mm256_extract_epi32 (res, 1);
-  nr_p += _mm256_extract_epi32 (res, 2);
-  nr_p += _mm256_extract_epi32 (res, 3);
-  nr_p += _mm256_extract_epi32 (res, 4);
-  nr_p += _mm256_extract_epi32 (res, 5);
-  nr_p += _mm256_extract_epi32 (res, 6);
-  nr_p += _mm256_extract_epi32 (res, 7);
-
-  // Process the remaining points (at most 7)
-  nr_p += countWithinDistanceStandard (model_coefficients, threshold, i);
-  return (nr_p);
+  return (countWithinDistanceFrom (model_coefficients, threshold, i));
 }
 #endif
 
+//////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::SampleConsensusModelSphere<PointT>::computeDistances (
+      const Eigen::VectorXf &model_coefficients, std::size_t begin, std::size_t count, float *distances) const
+{
+  pcl::detail::computeSphereDistances (
+      pcl::detail::makeSACFieldView (*input_, (*input_)[0].x, indices_->data () + begin), count,
+      model_coefficients.head<4> (), distances);
+}
+
 //////////////////////////////////////////////////////////////////////////
 template <typename PointT> void
 pcl::SampleConsensusModelSphere<PointT>::optimizeModelCoefficients (
@@ -353,14 +272,29 @@ pcl::SampleConsensusModelSphere<PointT>::optimizeModelCoefficients (
     return;
   }
 
-  OptimizationFunctor functor (this, inliers);
-  Eigen::NumericalDiff<OptimizationFunctor> num_diff (functor);
-  Eigen::LevenbergMarquardt<Eigen::NumericalDiff<OptimizationFunctor>, float> lm (num_diff);
-  int info = lm.minimize (optimized_coefficients);
+  // Residual ||p - c|| - r, with the gradient -(p - c) / ||p - c|| for the center and -1 for the radius
+  const auto make_residual = [this, &inliers] (const Eigen::Vector4d &x)
+  {
+    const Eigen::Vector3d center = x.head<3> ();
+    const double radius = x[3];
+    return [this, &inliers, center, radius] (std::size_t i, Eigen::Vector4d &gradient)
+    {
+      const Eigen::Vector3d diff = (*input_)[inliers[i]].getVector3fMap ().template cast<double> () - center;
+      const double norm = diff.norm ();
+      gradient.head<3> () = (norm > 0.0 ? Eigen::Vector3d (-diff / norm) : Eigen::Vector3d::Zero ());
+      gradient[3] = -1.0;
+      return (norm - radius);
+    };
+  };
+
+  Eigen::Vector4d x = model_coefficients.head<4> ().template cast<double> ();
+  double residual_norm;
+  const int info = pcl::detail::sacLevenbergMarquardt<4> (make_residual, inliers.size (), x, residual_norm, threads_);
+  optimized_coefficients = x.cast<float> ();
 
   // Compute the L2 norm of the residuals
   PCL_DEBUG ("[pcl::SampleConsensusModelSphere::optimizeModelCoefficients] LM solver finished with exit code %i, having a residual norm of %g. \nInitial solution: %g %g %g %g \nFinal solution: %g %g %g %g\n",
-             info, lm.fvec.norm (), model_coefficients[0], model_coefficients[1], model_coefficients[2], model_coefficients[3], optimized_coefficients[0], optimized_coefficients[1], optimized_coefficients[2], optimized_coefficients[3]);
+             info, residual_norm, model_coefficients[0], model_coefficients[1], model_coefficients[2], model_coefficients[3], optimized_coefficients[0], optimized_coefficients[1], optimized_coefficients[2], optimized_coefficients[3]);
 }
 
 //////////////////////////////////////////////////////////////////////////
@@ -52,6 +52,7 @@ namespace pcl
     * In contrast to RANSAC, LMedS does not divide the points into inliers and outliers when finding the model. Instead,
     * it uses the median of all point-model distances as the measure of how good a model is. A threshold is only needed
     * at the end, when it is determined which points belong to the found model.
+    * A parallel variant is available, enable with setNumberOfThreads. Default is non-parallel.
     * \author Radu B. Rusu
     * \ingroup sample_consensus
     */
@@ -71,6 +72,7 @@ namespace pcl
       using SampleConsensus<PointT>::model_;
       using SampleConsensus<PointT>::model_coefficients_;
       using SampleConsensus<PointT>::inliers_;
+      using SampleConsensus<PointT>::threads_;
 
       /** \brief LMedS (Least Median of Squares) main constructor
         * \param[in] model a Sample Consensus model
@@ -50,6 +50,7 @@ namespace pcl
     * Estimator SAmple Consensus) algorithm, as described in: "MLESAC: A new robust estimator with application to 
     * estimating image geometry", P.H.S. Torr and A. Zisserman, Computer Vision and Image Understanding, vol 78, 2000.
     * \note MLESAC is useful in situations where most of the data samples belong to the model, and a fast outlier rejection algorithm is needed.
+    * A parallel variant is available, enable with setNumberOfThreads. Default is non-parallel.
     * \author Radu B. Rusu
     * \ingroup sample_consensus
     */
@@ -71,6 +72,7 @@ namespace pcl
       using SampleConsensus<PointT>::model_coefficients_;
       using SampleConsensus<PointT>::inliers_;
       using SampleConsensus<PointT>::probability_;
+      using SampleConsensus<PointT>::threads_;
 
       /** \brief MLESAC (Maximum Likelihood Estimator SAmple Consensus) main constructor
         * \param[in] model a Sample Consensus model
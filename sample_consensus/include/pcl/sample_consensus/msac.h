@@ -53,6 +53,7 @@ namespace pcl
     * the model, as long as they are within the threshold. MSAC changes this by using the sum of all point-model distances
     * as the quality measure, however outliers only add the threshold instead of their true distance. This method can lead
     * to better results compared to RANSAC.
+    * A parallel variant is available, enable with setNumberOfThreads. Default is non-parallel.
     * \author Radu B. Rusu
     * \ingroup sample_consensus
     */
@@ -73,6 +74,7 @@ namespace pcl
       using SampleConsensus<PointT>::model_coefficients_;
       using SampleConsensus<PointT>::inliers_;
       using SampleConsensus<PointT>::probability_;
+      using SampleConsensus<PointT>::threads_;
 
       /** \brief MSAC (M-estimator SAmple Consensus) main constructor
         * \param[in] model a Sample Consensus model
@@ -48,6 +48,7 @@ namespace pcl
   /** \brief @b ProgressiveSampleConsensus represents an implementation of the PROSAC (PROgressive SAmple Consensus) algorithm, as
     * described in: "Matching with PROSAC – Progressive Sample Consensus", Chum, O. and Matas, J.G., CVPR, I: 220-226
     * 2005.
+    * A parallel variant is available, enable with setNumberOfThreads. Default is non-parallel.
     * \author Vincent Rabaud
     * \ingroup sample_consensus
     */
@@ -68,6 +69,7 @@ namespace pcl
       using SampleConsensus<PointT>::model_coefficients_;
       using SampleConsensus<PointT>::inliers_;
       using SampleConsensus<PointT>::probability_;
+      using SampleConsensus<PointT>::threads_;
 
       /** \brief PROSAC (Progressive SAmple Consensus) main constructor
         * \param[in] model a Sample Consensus model
@@ -49,6 +49,8 @@ namespace pcl
     * described in: "Random Sample Consensus: A Paradigm for Model Fitting with Applications to Image Analysis and 
     * Automated Cartography", Martin A. Fischler and Robert C. Bolles, Comm. Of the ACM 24: 381–395, June 1981.
     * A parallel variant is available, enable with setNumberOfThreads. Default is non-parallel.
+    * Alternatively, the hypotheses can be scored in batches through SampleConsensusModel::countWithinDistanceBatch,
+    * enable with setHypothesesBatchSize.
     * 
     * The algorithm works as follows:
     * <ol>
@@ -85,6 +87,7 @@ namespace pcl
         */
       RandomSampleConsensus (const SampleConsensusModelPtr &model) 
         : SampleConsensus<PointT> (model)
+        , hypotheses_batch_size_ (1)
       {
         // Maximum number of trials before we give up.
         max_iterations_ = 10000;
@@ -96,6 +99,7 @@ namespace pcl
         */
       RandomSampleConsensus (const SampleConsensusModelPtr &model, double threshold) 
         : SampleConsensus<PointT> (model, threshold)
+        , hypotheses_batch_size_ (1)
       {
         // Maximum number of trials before we give up.
         max_iterations_ = 10000;
@@ -106,6 +110,23 @@ namespace pcl
         */
       bool 
       computeModel (int debug_verbosity_level = 0) override;
+
+      /** \brief Set the number of hypotheses that are generated before they are scored together.
+        * With a batch size larger than 1, and no parallelization requested, the hypotheses are handed to
+        * SampleConsensusModel::countWithinDistanceBatch in groups. They are drawn and evaluated in the same
+        * order as without batching, so the result does not depend on the batch size.
+        * \param[in] batch_size the number of hypotheses per batch (default: 1, no batching)
+        */
+      inline void
+      setHypothesesBatchSize (std::size_t batch_size) { hypotheses_batch_size_ = (std::max) (batch_size, std::size_t (1)); }
+
+      /** \brief Get the number of hypotheses that are scored together. */
+      inline std::size_t
+      getHypothesesBatchSize () const { return (hypotheses_batch_size_); }
+
+    protected:
+      /** \brief The number of hypotheses that are scored together. */
+      std::size_t hypotheses_batch_size_;
   };
 }
 
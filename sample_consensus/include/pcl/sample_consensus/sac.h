@@ -49,6 +49,7 @@
 #include <ctime>
 #include <memory>
 #include <set>
+#include <vector>
 
 namespace pcl
 {
@@ -355,5 +356,49 @@ namespace pcl
       {
         return ((*rng_) ());
       }
+
+      /** \brief Draw the next batch of hypotheses, for the estimators that score the hypotheses
+        * of a batch concurrently. The samples are drawn serially, in the same sequence as one
+        * at a time. Samples for which no model coefficients can be computed are skipped.
+        * \param[in] batch_size the maximum number of hypotheses to draw
+        * \param[in] max_skip the number of skipped samples after which drawing stops
+        * \param[in,out] skipped_count the number of samples skipped so far
+        * \param[out] samples the samples of the hypotheses, the first ones are valid
+        * \param[out] hypotheses the model coefficients of the hypotheses, the first ones are valid
+        * \param[out] no_samples true if drawing stopped because no samples could be selected
+        * \return the number of hypotheses drawn
+        */
+      std::size_t
+      drawHypotheses (const std::size_t batch_size,
+                      const unsigned max_skip,
+                      unsigned &skipped_count,
+                      std::vector<Indices> &samples,
+                      std::vector<Eigen::VectorXf> &hypotheses,
+                      bool &no_samples)
+      {
+        if (samples.size () < batch_size)
+          samples.resize (batch_size);
+        if (hypotheses.size () < batch_size)
+          hypotheses.resize (batch_size, Eigen::VectorXf (sac_model_->getModelSize ()));
+
+        no_samples = false;
+        std::size_t nr_hypotheses = 0;
+        while (nr_hypotheses < batch_size && skipped_count < max_skip)
+        {
+          sac_model_->getSamples (iterations_, samples[nr_hypotheses]);
+          if (samples[nr_hypotheses].empty ())
+          {
+            no_samples = true;
+            break;
+          }
+          if (!sac_model_->computeModelCoefficients (samples[nr_hypotheses], hypotheses[nr_hypotheses]))
+          {
+            ++skipped_count;
+            continue;
+          }
+          ++nr_hypotheses;
+        }
+        return (nr_hypotheses);
+      }
    };
 }
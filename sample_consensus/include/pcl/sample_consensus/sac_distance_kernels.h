@@ -0,0 +1,161 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#pragma once
+
+#include <pcl/pcl_exports.h>
+#include <pcl/point_cloud.h>
+#include <pcl/types.h> // for index_t
+#include <Eigen/Core>
+
+#include <cstddef>
+#include <cstdint>
+
+namespace pcl
+{
+  namespace detail
+  {
+    /** \brief Up to three consecutive float fields (x, y, z or normal_x, normal_y, normal_z, or a single
+      * one like curvature) of the points of a cloud, picked through a list of indices. Lets the distance
+      * kernels of the sample consensus models read any point type without being templates.
+      */
+    struct SACFieldView
+    {
+      /** \brief The first field of the point at index 0 of the cloud. */
+      const std::uint8_t *first;
+      /** \brief The size of a point in bytes. */
+      std::size_t step;
+      /** \brief The indices of the points to read. */
+      const index_t *indices;
+
+      /** \brief Get the fields of the i-th indexed point. */
+      inline const float*
+      operator[] (std::size_t i) const
+      {
+        return (reinterpret_cast<const float*> (first + step * indices[i]));
+      }
+    };
+
+    /** \brief Make a view on a field of the points of \a cloud.
+      * \param[in] cloud the point cloud, which must not be empty
+      * \param[in] field the first field of the view, in the first point of \a cloud
+      * \param[in] indices the indices of the points to read
+      */
+    template <typename PointT> inline SACFieldView
+    makeSACFieldView (const pcl::PointCloud<PointT> &cloud, const float &field, const index_t *indices)
+    {
+      (void) cloud;
+      return {reinterpret_cast<const std::uint8_t*> (&field), sizeof (PointT), indices};
+    }
+
+    /** \brief Compute the distances of \a count points to a sphere, | ||p - c|| - r |.
+      * \param[in] points the point coordinates
+      * \param[in] count the number of points
+      * \param[in] sphere the center and the radius of the sphere
+      * \param[out] distances the \a count distances
+      */
+    PCL_EXPORTS void
+    computeSphereDistances (const SACFieldView &points, std::size_t count,
+                            const Eigen::Vector4f &sphere, float *distances);
+
+    /** \brief Compute the distances of \a count points to a line, ||(l - p) x d||.
+      * \param[in] points the point coordinates
+      * \param[in] count the number of points
+      * \param[in] line_pt a point on the line
+      * \param[in] line_dir the unit direction of the line
+      * \param[out] distances the \a count distances
+      */
+    PCL_EXPORTS void
+    computeLineDistances (const SACFieldView &points, std::size_t count,
+                          const Eigen::Vector3f &line_pt, const Eigen::Vector3f &line_dir, float *distances);
+
+    /** \brief Compute the distances of \a count points with normals to a cylinder, as
+      * SampleConsensusModelCylinder defines them: the absolute value of w times the acute angle between the
+      * normal and the direction from the axis to the point, plus (1 - w) times the absolute difference of
+      * the distance to the axis and the radius.
+      * \param[in] points the point coordinates
+      * \param[in] normals the point normals
+      * \param[in] count the number of points
+      * \param[in] cylinder the 7 cylinder coefficients: a point on the axis, the axis direction and the radius
+      * \param[in] normal_distance_weight the weight w of the angular distance
+      * \param[out] distances the \a count distances
+      */
+    PCL_EXPORTS void
+    computeCylinderDistances (const SACFieldView &points, const SACFieldView &normals, std::size_t count,
+                              const Eigen::VectorXf &cylinder, float normal_distance_weight, float *distances);
+
+    /** \brief Compute the distances of \a count points with normals to a plane, as
+      * SampleConsensusModelNormalPlane defines them: the absolute value of w' times the acute angle between
+      * the normal and the plane normal plus (1 - w') times the distance to the plane, where w' is w times
+      * one minus the curvature of the point.
+      * \param[in] points the point coordinates
+      * \param[in] normals the point normals
+      * \param[in] curvatures the point curvatures
+      * \param[in] count the number of points
+      * \param[in] plane the plane coefficients
+      * \param[in] normal_distance_weight the weight w of the angular distance
+      * \param[out] distances the \a count distances
+      */
+    PCL_EXPORTS void
+    computeNormalPlaneDistances (const SACFieldView &points, const SACFieldView &normals,
+                                 const SACFieldView &curvatures, std::size_t count,
+                                 const Eigen::Vector4f &plane, float normal_distance_weight, float *distances);
+
+    /** \brief Compute the distances of \a count points to a circle in 3D, from each point to the point of
+      * the circle closest to its projection on the circle plane.
+      * \param[in] points the point coordinates
+      * \param[in] count the number of points
+      * \param[in] circle the 7 circle coefficients: the center, the radius and the plane normal
+      * \param[out] distances the \a count distances
+      */
+    PCL_EXPORTS void
+    computeCircle3DDistances (const SACFieldView &points, std::size_t count,
+                              const Eigen::VectorXf &circle, float *distances);
+
+    /** \brief Compute the distances between \a count transformed source points and their target points,
+      * ||T s - t||.
+      * \param[in] source the source point coordinates
+      * \param[in] target the target point coordinates
+      * \param[in] count the number of point pairs
+      * \param[in] transform the rigid transformation T
+      * \param[out] distances the \a count distances
+      */
+    PCL_EXPORTS void
+    computeRegistrationDistances (const SACFieldView &source, const SACFieldView &target, std::size_t count,
+                                  const Eigen::Matrix4f &transform, float *distances);
+  }
+}
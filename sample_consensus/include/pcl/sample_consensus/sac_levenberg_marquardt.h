@@ -0,0 +1,242 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#pragma once
+
+#include <pcl/common/execution_context.h>
+
+#include <Eigen/Core>
+#include <Eigen/Cholesky> // for LDLT
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+namespace pcl
+{
+  namespace detail
+  {
+    /** \brief Exit codes of sacLevenbergMarquardt. */
+    enum SACLevenbergMarquardtStatus
+    {
+      /** \brief The damped normal equations could not be solved, the parameters are unchanged. */
+      SAC_LM_NUMERICAL_FAILURE = 0,
+      /** \brief The gradient of the cost vanished. */
+      SAC_LM_GRADIENT_TOLERANCE = 1,
+      /** \brief The step became negligible relative to the parameters. */
+      SAC_LM_STEP_TOLERANCE = 2,
+      /** \brief The cost decreased by a negligible relative amount. */
+      SAC_LM_COST_TOLERANCE = 3,
+      /** \brief The maximum number of iterations was reached. */
+      SAC_LM_MAX_ITERATIONS = 4
+    };
+
+    /** \brief The Gauss-Newton normal equations J^T J, J^T r and r^T r of a set of residuals. */
+    template <int N>
+    struct SACNormalEquations
+    {
+      Eigen::Matrix<double, N, N> jtj;
+      Eigen::Matrix<double, N, 1> jtr;
+      double sqr_norm;
+
+      inline void
+      setZero ()
+      {
+        jtj.setZero ();
+        jtr.setZero ();
+        sqr_norm = 0.0;
+      }
+
+      inline SACNormalEquations&
+      operator+= (const SACNormalEquations &other)
+      {
+        jtj += other.jtj;
+        jtr += other.jtr;
+        sqr_norm += other.sqr_norm;
+        return (*this);
+      }
+
+      EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+    };
+
+    /** \brief Accumulate the normal equations of the residuals [begin, end).
+      * \param[in] residual evaluates residual i and writes its gradient
+      * \param[in] begin the first residual
+      * \param[in] end one past the last residual
+      * \param[out] equations the normal equations
+      */
+    template <int N, typename Residual> inline void
+    accumulateSACNormalEquations (const Residual &residual, std::size_t begin, std::size_t end,
+                                  SACNormalEquations<N> &equations)
+    {
+      equations.setZero ();
+      Eigen::Matrix<double, N, 1> gradient;
+      for (std::size_t i = begin; i < end; ++i)
+      {
+        const double r = residual (i, gradient);
+        equations.jtj.template selfadjointView<Eigen::Lower> ().rankUpdate (gradient);
+        equations.jtr += r * gradient;
+        equations.sqr_norm += r * r;
+      }
+      equations.jtj.template triangularView<Eigen::StrictlyUpper> () = equations.jtj.transpose ();
+    }
+
+    /** \brief The number of residuals accumulated together by sacLevenbergMarquardt. */
+    constexpr std::size_t sac_lm_block_size = 512;
+
+    /** \brief Accumulate the normal equations of \a count residuals in blocks of sac_lm_block_size, summed
+      * in order so that the result does not depend on the number of threads.
+      * \param[in] residual evaluates residual i and writes its gradient
+      * \param[in] count the number of residuals
+      * \param[in] blocks storage for the equations of each block, empty if there is a single block
+      * \param[in] nr_threads the number of threads
+      * \param[out] equations the normal equations
+      */
+    template <int N, typename Residual> void
+    evaluateSACNormalEquations (const Residual &residual, std::size_t count,
+                                std::vector<SACNormalEquations<N>, Eigen::aligned_allocator<SACNormalEquations<N> > > &blocks,
+                                unsigned int nr_threads, SACNormalEquations<N> &equations)
+    {
+      if (blocks.empty ())
+      {
+        accumulateSACNormalEquations<N> (residual, 0, count, equations);
+        return;
+      }
+      const std::size_t block_size = sac_lm_block_size;
+#pragma omp parallel for \
+  default(none) \
+  shared(blocks, residual) \
+  firstprivate(count, block_size) \
+  num_threads(nr_threads)
+      for (std::ptrdiff_t b = 0; b < static_cast<std::ptrdiff_t> (blocks.size ()); ++b)
+        accumulateSACNormalEquations<N> (residual, b * block_size, std::min (count, (b + 1) * block_size), blocks[b]);
+      equations = blocks[0];
+      for (std::size_t b = 1; b < blocks.size (); ++b)
+        equations += blocks[b];
+    }
+
+    /** \brief Minimize the sum of the squared residuals of a model with N parameters with the
+      * Levenberg-Marquardt algorithm, using analytic gradients and fixed-size N x N normal equations.
+      *
+      * \a make_residual is called with the current parameters and returns a callable
+      * double (std::size_t i, Eigen::Matrix<double, N, 1> &gradient), that returns residual i and writes its
+      * gradient with respect to the parameters. Quantities that only depend on the parameters can so be
+      * computed once per evaluation instead of once per residual.
+      *
+      * The residuals are accumulated in fixed blocks which are summed in order, so the result does not depend
+      * on the number of threads. Sets with more than one block are evaluated in parallel, with threads taken
+      * from the budget of pcl::ExecutionContext. Nothing is allocated for sets of a single block.
+      *
+      * \param[in] make_residual creates the residual evaluator for a set of parameters
+      * \param[in] count the number of residuals
+      * \param[in,out] x the initial parameters, replaced by the optimized ones
+      * \param[out] residual_norm the L2 norm of the residuals at the optimized parameters
+      * \param[in] nr_threads the number of threads for the residual evaluation, 0 for as many as the budget allows
+      * \param[in] max_iterations the maximum number of iterations
+      * \return a SACLevenbergMarquardtStatus
+      */
+    template <int N, typename ResidualFactory> int
+    sacLevenbergMarquardt (const ResidualFactory &make_residual, std::size_t count,
+                           Eigen::Matrix<double, N, 1> &x, double &residual_norm,
+                           unsigned int nr_threads = 1, int max_iterations = 100)
+    {
+      std::vector<SACNormalEquations<N>, Eigen::aligned_allocator<SACNormalEquations<N> > > blocks;
+      if (count > sac_lm_block_size)
+        blocks.resize ((count + sac_lm_block_size - 1) / sac_lm_block_size);
+      // Sets of a single block are evaluated by the calling thread
+      const pcl::ThreadReservation reservation (blocks.empty () ? 1u : nr_threads);
+      const unsigned int threads = reservation.getNumberOfThreads ();
+      const auto evaluate = [&] (const Eigen::Matrix<double, N, 1> &parameters, SACNormalEquations<N> &equations)
+      {
+        evaluateSACNormalEquations<N> (make_residual (parameters), count, blocks, threads, equations);
+      };
+
+      SACNormalEquations<N> current, candidate;
+      evaluate (x, current);
+      residual_norm = std::sqrt (current.sqr_norm);
+      if (!std::isfinite (current.sqr_norm))
+        return (SAC_LM_NUMERICAL_FAILURE);
+
+      // Damping as proposed by Nielsen, starting relative to the largest curvature
+      double mu = 1e-3 * std::max (current.jtj.diagonal ().maxCoeff (), 1e-12);
+      double nu = 2.0;
+      const double tolerance = std::sqrt (Eigen::NumTraits<double>::epsilon ());
+      for (int iteration = 0; iteration < max_iterations; ++iteration)
+      {
+        if (current.jtr.template lpNorm<Eigen::Infinity> () <= 1e-12 * std::max (1.0, current.sqr_norm))
+          return (SAC_LM_GRADIENT_TOLERANCE);
+
+        Eigen::Matrix<double, N, N> damped = current.jtj;
+        damped.diagonal ().array () += mu;
+        const Eigen::LDLT<Eigen::Matrix<double, N, N> > ldlt (damped);
+        if (ldlt.info () != Eigen::Success)
+          return (SAC_LM_NUMERICAL_FAILURE);
+        const Eigen::Matrix<double, N, 1> step = ldlt.solve (-current.jtr);
+        if (!step.allFinite ())
+          return (SAC_LM_NUMERICAL_FAILURE);
+        if (step.norm () <= tolerance * (x.norm () + tolerance))
+          return (SAC_LM_STEP_TOLERANCE);
+
+        const Eigen::Matrix<double, N, 1> x_new = x + step;
+        evaluate (x_new, candidate);
+
+        // Ratio of the actual to the predicted decrease of the cost 0.5 r^T r
+        const double actual = 0.5 * (current.sqr_norm - candidate.sqr_norm);
+        const double predicted = 0.5 * step.dot (mu * step - current.jtr);
+        const double rho = (predicted > 0.0 ? actual / predicted : -1.0);
+        if (std::isfinite (candidate.sqr_norm) && rho > 0.0)
+        {
+          x = x_new;
+          const double previous_sqr_norm = current.sqr_norm;
+          current = candidate;
+          residual_norm = std::sqrt (current.sqr_norm);
+          mu *= std::max (1.0 / 3.0, 1.0 - std::pow (2.0 * rho - 1.0, 3));
+          nu = 2.0;
+          if (previous_sqr_norm - current.sqr_norm <= tolerance * tolerance * previous_sqr_norm)
+            return (SAC_LM_COST_TOLERANCE);
+        }
+        else
+        {
+          mu *= nu;
+          nu *= 2.0;
+        }
+      }
+      return (SAC_LM_MAX_ITERATIONS);
+    }
+  }
+}
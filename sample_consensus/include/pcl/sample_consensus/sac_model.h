@@ -40,6 +40,7 @@
 
 #pragma once
 
+#include <algorithm>
 #include <ctime>
 #include <climits>
 #include <memory>
@@ -266,6 +267,25 @@ namespace pcl
       countWithinDistance (const Eigen::VectorXf &model_coefficients,
                            const double threshold) const = 0;
 
+      /** \brief Count the inliers of a whole batch of model hypotheses at once.
+        * The default implementation calls countWithinDistance for every hypothesis. Models that keep the data on
+        * an accelerator, or that can share work between hypotheses, override this to score the batch in one go.
+        * Implementations of this function must be thread-safe.
+        * \param[in] hypotheses the coefficients of the models that we need to compute distances to
+        * \param[in] threshold a maximum admissible distance threshold for
+        * determining the inliers from the outliers
+        * \param[out] counts the resultant number of inliers of every hypothesis
+        */
+      virtual void
+      countWithinDistanceBatch (const std::vector<Eigen::VectorXf> &hypotheses,
+                                const double threshold,
+                                std::vector<std::size_t> &counts) const
+      {
+        counts.resize (hypotheses.size ());
+        for (std::size_t i = 0; i < hypotheses.size (); ++i)
+          counts[i] = countWithinDistance (hypotheses[i], threshold);
+      }
+
       /** \brief Create a new point cloud with inliers projected onto the model. Pure virtual.
         * \param[in] inliers the data inliers that we want to project on the model
         * \param[in] model_coefficients the coefficients of a model
@@ -427,6 +447,18 @@ namespace pcl
         radius = samples_radius_;
       }
 
+      /** \brief Set the number of threads used by optimizeModelCoefficients to evaluate the residuals of
+        * large inlier sets. The optimized coefficients do not depend on the number of threads.
+        * \param[in] nr_threads the number of hardware threads to use (0 takes as many as the budget of
+        * pcl::ExecutionContext allows when optimizing)
+        */
+      inline void
+      setNumberOfThreads (unsigned int nr_threads = 0) { threads_ = nr_threads; }
+
+      /** \brief Get the number of threads used by optimizeModelCoefficients. */
+      inline unsigned int
+      getNumberOfThreads () const { return (threads_); }
+
       friend class ProgressiveSampleConsensus<PointT>;
 
       /** \brief Compute the variance of the errors to the model.
@@ -546,6 +578,27 @@ namespace pcl
       virtual bool
       isSampleGood (const Indices &samples) const = 0;
 
+      /** \brief Compute the distances of the points in indices_ to a model in chunks small enough for the
+        * stack, and hand them to \a consume in the order of indices_. Used with the vectorized distance
+        * kernels of pcl/sample_consensus/sac_distance_kernels.h.
+        * \param[in] compute_distances called as compute_distances (begin, count, distances) to fill in the
+        * distances of the \a count points starting at indices_[begin]
+        * \param[in] consume called as consume (i, distance) for the i-th point of indices_
+        */
+      template <typename ComputeDistances, typename Consume> inline void
+      forEachDistance (const ComputeDistances &compute_distances, const Consume &consume) const
+      {
+        constexpr std::size_t chunk_size = 1024;
+        float distances[chunk_size];
+        for (std::size_t begin = 0; begin < indices_->size (); begin += chunk_size)
+        {
+          const std::size_t count = (std::min) (chunk_size, indices_->size () - begin);
+          compute_distances (begin, count, distances);
+          for (std::size_t k = 0; k < count; ++k)
+            consume (begin + k, distances[k]);
+        }
+      }
+
       /** \brief The model name. */
       std::string model_name_;
 
@@ -590,6 +643,9 @@ namespace pcl
       /** \brief The number of coefficients in the model. Every subclass should initialize this appropriately. */
       unsigned int model_size_;
 
+      /** \brief The number of threads used by optimizeModelCoefficients. */
+      unsigned int threads_ = 1;
+
       /** \brief Boost-based random number generator. */
       inline int
       rnd ()
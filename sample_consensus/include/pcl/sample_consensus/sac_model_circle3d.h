@@ -38,6 +38,7 @@
 #pragma once
 
 #include <pcl/sample_consensus/sac_model.h>
+#include <pcl/sample_consensus/sac_distance_kernels.h>
 #include <pcl/sample_consensus/model_types.h>
 
 namespace pcl
@@ -201,6 +202,19 @@ namespace pcl
     protected:
       using SampleConsensusModel<PointT>::sample_size_;
       using SampleConsensusModel<PointT>::model_size_;
+      using SampleConsensusModel<PointT>::threads_;
+      using SampleConsensusModel<PointT>::forEachDistance;
+
+      /** \brief Compute the distances of \a count points, starting at indices_[begin], to the circle,
+        * with the vectorized kernels of pcl/sample_consensus/sac_distance_kernels.h.
+        * \param[in] model_coefficients the model coefficients
+        * \param[in] begin the position of the first point in indices_
+        * \param[in] count the number of points
+        * \param[out] distances the \a count distances
+        */
+      void
+      computeDistances (const Eigen::VectorXf &model_coefficients, std::size_t begin, std::size_t count,
+                        float *distances) const;
 
       /** \brief Check whether a model is valid given the user constraints.
         * \param[in] model_coefficients the set of model coefficients
@@ -213,58 +227,6 @@ namespace pcl
         */
       bool
       isSampleGood(const Indices &samples) const override;
-
-    private:
-      /** \brief Functor for the optimization function */
-      struct OptimizationFunctor : pcl::Functor<double>
-      {
-        /** Functor constructor
-          * \param[in] indices the indices of data points to evaluate
-          * \param[in] estimator pointer to the estimator object
-          */
-        OptimizationFunctor (const pcl::SampleConsensusModelCircle3D<PointT> *model, const Indices& indices) :
-          pcl::Functor<double> (indices.size ()), model_ (model), indices_ (indices) {}
-
-       /** Cost function to be minimized
-         * \param[in] x the variables array
-         * \param[out] fvec the resultant functions evaluations
-         * \return 0
-         */
-        int operator() (const Eigen::VectorXd &x, Eigen::VectorXd &fvec) const
-        {
-          for (int i = 0; i < values (); ++i)
-          {
-            // what i have:
-            // P : Sample Point
-            Eigen::Vector3d P =
-                (*model_->input_)[indices_[i]].getVector3fMap().template cast<double>();
-            // C : Circle Center
-            Eigen::Vector3d C (x[0], x[1], x[2]);
-            // N : Circle (Plane) Normal
-            Eigen::Vector3d N (x[4], x[5], x[6]);
-            // r : Radius
-            double r = x[3];
-
-            Eigen::Vector3d helperVectorPC = P - C;
-            // 1.1. get line parameter
-            //float lambda = (helperVectorPC.dot(N)) / N.squaredNorm() ;
-            double lambda = (-(helperVectorPC.dot (N))) / N.dot (N);
-            // Projected Point on plane
-            Eigen::Vector3d P_proj = P + lambda * N;
-            Eigen::Vector3d helperVectorP_projC = P_proj - C;
-
-            // K : Point on Circle
-            Eigen::Vector3d K = C + r * helperVectorP_projC.normalized ();
-            Eigen::Vector3d distanceVector =  P - K;
-
-            fvec[i] = distanceVector.norm ();
-          }
-          return (0);
-        }
-
-        const pcl::SampleConsensusModelCircle3D<PointT> *model_;
-        const Indices &indices_;
-      };
   };
 }
 
@@ -41,6 +41,7 @@
 #pragma once
 
 #include <pcl/sample_consensus/sac_model.h>
+#include <pcl/sample_consensus/sac_distance_kernels.h>
 #include <pcl/sample_consensus/model_types.h>
 #include <pcl/common/distances.h>
 
@@ -240,6 +241,19 @@ namespace pcl
     protected:
       using SampleConsensusModel<PointT>::sample_size_;
       using SampleConsensusModel<PointT>::model_size_;
+      using SampleConsensusModel<PointT>::threads_;
+      using SampleConsensusModel<PointT>::forEachDistance;
+
+      /** \brief Compute the distances of \a count points, starting at indices_[begin], to the cylinder,
+        * with the vectorized kernels of pcl/sample_consensus/sac_distance_kernels.h.
+        * \param[in] model_coefficients the model coefficients
+        * \param[in] begin the position of the first point in indices_
+        * \param[in] count the number of points
+        * \param[out] distances the \a count distances
+        */
+      void
+      computeDistances (const Eigen::VectorXf &model_coefficients, std::size_t begin, std::size_t count,
+                        float *distances) const;
 
       /** \brief Get the distance from a point to a line (represented by a point and a direction)
         * \param[in] pt a point
@@ -295,42 +309,6 @@ namespace pcl
     
       /** \brief The maximum allowed difference between the cylinder direction and the given axis. */
       double eps_angle_;
-
-      /** \brief Functor for the optimization function */
-      struct OptimizationFunctor : pcl::Functor<float>
-      {
-        /** Functor constructor
-          * \param[in] indices the indices of data points to evaluate
-          * \param[in] estimator pointer to the estimator object
-          */
-        OptimizationFunctor (const pcl::SampleConsensusModelCylinder<PointT, PointNT> *model, const Indices& indices) :
-          pcl::Functor<float> (indices.size ()), model_ (model), indices_ (indices) {}
-
-        /** Cost function to be minimized
-          * \param[in] x variables array
-          * \param[out] fvec resultant functions evaluations
-          * \return 0
-          */
-        int 
-        operator() (const Eigen::VectorXf &x, Eigen::VectorXf &fvec) const
-        {
-          Eigen::Vector4f line_pt  (x[0], x[1], x[2], 0);
-          Eigen::Vector4f line_dir (x[3], x[4], x[5], 0);
-          
-          for (int i = 0; i < values (); ++i)
-          {
-            // dist = f - r
-            Eigen::Vector4f pt = (*model_->input_)[indices_[i]].getVector4fMap();
-            pt[3] = 0;
-
-            fvec[i] = static_cast<float> (pcl::sqrPointToLineDistance (pt, line_pt, line_dir) - x[6]*x[6]);
-          }
-          return (0);
-        }
-
-        const pcl::SampleConsensusModelCylinder<PointT, PointNT> *model_;
-        const Indices &indices_;
-      };
   };
 }
 
@@ -41,6 +41,7 @@
 #pragma once
 
 #include <pcl/sample_consensus/sac_model.h>
+#include <pcl/sample_consensus/sac_distance_kernels.h>
 #include <pcl/sample_consensus/model_types.h>
 
 namespace pcl
@@ -182,6 +183,18 @@ namespace pcl
     protected:
       using SampleConsensusModel<PointT>::sample_size_;
       using SampleConsensusModel<PointT>::model_size_;
+      using SampleConsensusModel<PointT>::forEachDistance;
+
+      /** \brief Compute the distances of \a count points, starting at indices_[begin], to the line,
+        * with the vectorized kernels of pcl/sample_consensus/sac_distance_kernels.h.
+        * \param[in] model_coefficients the model coefficients
+        * \param[in] begin the position of the first point in indices_
+        * \param[in] count the number of points
+        * \param[out] distances the \a count distances
+        */
+      void
+      computeDistances (const Eigen::VectorXf &model_coefficients, std::size_t begin, std::size_t count,
+                        float *distances) const;
 
       /** \brief Check if a sample of indices results in a good sample of points
         * indices.
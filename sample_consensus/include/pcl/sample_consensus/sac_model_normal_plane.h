@@ -43,6 +43,7 @@
 #include <pcl/memory.h>
 #include <pcl/pcl_macros.h>
 #include <pcl/sample_consensus/sac_model.h>
+#include <pcl/sample_consensus/sac_distance_kernels.h>
 #include <pcl/sample_consensus/sac_model_plane.h>
 #include <pcl/sample_consensus/model_types.h>
 
@@ -164,6 +165,18 @@ namespace pcl
     protected:
       using SampleConsensusModel<PointT>::sample_size_;
       using SampleConsensusModel<PointT>::model_size_;
+      using SampleConsensusModel<PointT>::forEachDistance;
+
+      /** \brief Compute the distances of \a count points, starting at indices_[begin], to the plane, weighted by the normals as in getDistancesToModel,
+        * with the vectorized kernels of pcl/sample_consensus/sac_distance_kernels.h.
+        * \param[in] model_coefficients the model coefficients
+        * \param[in] begin the position of the first point in indices_
+        * \param[in] count the number of points
+        * \param[out] distances the \a count distances
+        */
+      void
+      computeDistances (const Eigen::VectorXf &model_coefficients, std::size_t begin, std::size_t count,
+                        float *distances) const;
 
       /** This implementation uses no SIMD instructions. It is not intended for normal use.
         * See countWithinDistance which automatically uses the fastest implementation.
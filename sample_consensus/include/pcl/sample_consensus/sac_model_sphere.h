@@ -40,14 +40,8 @@
 
 #pragma once
 
-#ifdef __SSE__
-#include <xmmintrin.h> // for __m128
-#endif // ifdef __SSE__
-#ifdef __AVX__
-#include <immintrin.h> // for __m256
-#endif // ifdef __AVX__
-
 #include <pcl/sample_consensus/sac_model.h>
+#include <pcl/sample_consensus/sac_distance_kernels.h>
 #include <pcl/sample_consensus/model_types.h>
 
 namespace pcl
@@ -160,7 +154,8 @@ namespace pcl
                             Indices &inliers) override;
 
       /** \brief Count all the points which respect the given model coefficients as inliers. 
-        * 
+        * The distances come from the same runtime dispatched kernel as getDistancesToModel, see
+        * pcl::setSIMDLevel to force a specific instruction set.
         * \param[in] model_coefficients the coefficients of a model that we need to compute distances to
         * \param[in] threshold maximum admissible distance threshold for determining the inliers from the outliers
         * \return the resultant number of inliers
@@ -209,6 +204,19 @@ namespace pcl
     protected:
       using SampleConsensusModel<PointT>::sample_size_;
       using SampleConsensusModel<PointT>::model_size_;
+      using SampleConsensusModel<PointT>::threads_;
+      using SampleConsensusModel<PointT>::forEachDistance;
+
+      /** \brief Compute the distances of \a count points, starting at indices_[begin], to the sphere,
+        * with the vectorized kernels of pcl/sample_consensus/sac_distance_kernels.h.
+        * \param[in] model_coefficients the model coefficients
+        * \param[in] begin the position of the first point in indices_
+        * \param[in] count the number of points
+        * \param[out] distances the \a count distances
+        */
+      void
+      computeDistances (const Eigen::VectorXf &model_coefficients, std::size_t begin, std::size_t count,
+                        float *distances) const;
 
       /** \brief Check whether a model is valid given the user constraints.
         * \param[in] model_coefficients the set of model coefficients
@@ -237,6 +245,7 @@ namespace pcl
       /** This implementation uses no SIMD instructions. It is not intended for normal use.
         * See countWithinDistance which automatically uses the fastest implementation.
         */
+      PCL_DEPRECATED(1, 14, "use countWithinDistance, which dispatches to the fastest kernel at runtime")
       std::size_t
       countWithinDistanceStandard (const Eigen::VectorXf &model_coefficients,
                                    const double threshold,
@@ -246,6 +255,7 @@ namespace pcl
       /** This implementation uses SSE, SSE2, and SSE4.1 instructions. It is not intended for normal use.
         * See countWithinDistance which automatically uses the fastest implementation.
         */
+      PCL_DEPRECATED(1, 14, "use countWithinDistance, which dispatches to the fastest kernel at runtime")
       std::size_t
       countWithinDistanceSSE (const Eigen::VectorXf &model_coefficients,
                               const double threshold,
@@ -256,6 +266,7 @@ namespace pcl
       /** This implementation uses AVX and AVX2 instructions. It is not intended for normal use.
         * See countWithinDistance which automatically uses the fastest implementation.
         */
+      PCL_DEPRECATED(1, 14, "use countWithinDistance, which dispatches to the fastest kernel at runtime")
       std::size_t
       countWithinDistanceAVX (const Eigen::VectorXf &model_coefficients,
                               const double threshold,
@@ -263,47 +274,13 @@ namespace pcl
 #endif
 
     private:
-      struct OptimizationFunctor : pcl::Functor<float>
-      {
-        /** Functor constructor
-          * \param[in] indices the indices of data points to evaluate
-          * \param[in] estimator pointer to the estimator object
-          */
-        OptimizationFunctor (const pcl::SampleConsensusModelSphere<PointT> *model, const Indices& indices) :
-          pcl::Functor<float> (indices.size ()), model_ (model), indices_ (indices) {}
-
-        /** Cost function to be minimized
-          * \param[in] x the variables array
-          * \param[out] fvec the resultant functions evaluations
-          * \return 0
-          */
-        int 
-        operator() (const Eigen::VectorXf &x, Eigen::VectorXf &fvec) const
-        {
-          Eigen::Vector4f cen_t;
-          cen_t[3] = 0;
-          for (int i = 0; i < values (); ++i)
-          {
-            // Compute the difference between the center of the sphere and the datapoint X_i
-            cen_t.head<3>() = (*model_->input_)[indices_[i]].getVector3fMap() - x.head<3>();
-
-            // g = sqrt ((x-a)^2 + (y-b)^2 + (z-c)^2) - R
-            fvec[i] = std::sqrt (cen_t.dot (cen_t)) - x[3];
-          }
-          return (0);
-        }
-
-        const pcl::SampleConsensusModelSphere<PointT> *model_;
-        const Indices &indices_;
-      };
-
-#ifdef __AVX__
-      inline __m256 sqr_dist8 (const std::size_t i, const __m256 a_vec, const __m256 b_vec, const __m256 c_vec) const;
-#endif
-
-#ifdef __SSE__
-      inline __m128 sqr_dist4 (const std::size_t i, const __m128 a_vec, const __m128 b_vec, const __m128 c_vec) const;
-#endif
+      /** \brief Count the inliers among indices_[i], indices_[i + 1], ... with the runtime dispatched
+        * kernel. Backs the deprecated countWithinDistanceStandard, SSE and AVX.
+        */
+      std::size_t
+      countWithinDistanceFrom (const Eigen::VectorXf &model_coefficients,
+                               const double threshold,
+                               std::size_t i) const;
    };
 }
 
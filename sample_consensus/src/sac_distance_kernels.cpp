@@ -0,0 +1,328 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include <pcl/sample_consensus/sac_distance_kernels.h>
+#include <pcl/common/simd_lanes.h>
+
+#include <algorithm>
+
+namespace
+{
+  using namespace pcl::detail::simd;
+  using pcl::detail::SACFieldView;
+
+  /** Load \a fields consecutive fields of the points i to i + n - 1 of a view, n <= V::size. Lanes past n
+    * are zero. */
+  template <typename V, int fields> PCL_SIMD_INLINE void
+  gather (const SACFieldView &view, std::size_t i, std::size_t n, V (&out)[fields])
+  {
+    float buffer[fields][V::size] = {};
+    for (std::size_t k = 0; k < n; ++k)
+    {
+      const float *p = view[i + k];
+      for (int f = 0; f < fields; ++f)
+        buffer[f][k] = p[f];
+    }
+    for (int f = 0; f < fields; ++f)
+      out[f] = V::load (buffer[f]);
+  }
+
+  /** The angle between two vectors, folded to [0, pi/2] as min (angle, pi - angle). Like
+    * pcl::getAngle3D, the angle to a zero vector is pi/2. */
+  template <typename V> PCL_SIMD_INLINE V
+  acuteAngle (const V (&a)[3], const V (&b)[3])
+  {
+    const V cx = a[1] * b[2] - a[2] * b[1];
+    const V cy = a[2] * b[0] - a[0] * b[2];
+    const V cz = a[0] * b[1] - a[1] * b[0];
+    const V sin_part = sqrt (cx * cx + cy * cy + cz * cz);
+    const V cos_part = abs (a[0] * b[0] + a[1] * b[1] + a[2] * b[2]);
+    const V zero (0.0f);
+    return (select (maskAnd (sin_part == zero, cos_part == zero), V (1.5707963267948966f),
+                    atan2 (sin_part, cos_part)));
+  }
+
+  struct SphereKernel
+  {
+    SACFieldView points;
+    float cx, cy, cz, r;
+
+    template <typename V> PCL_SIMD_INLINE V
+    compute (std::size_t i, std::size_t n) const
+    {
+      V p[3];
+      gather (points, i, n, p);
+      const V dx = p[0] - V (cx), dy = p[1] - V (cy), dz = p[2] - V (cz);
+      return (abs (sqrt (dx * dx + dy * dy + dz * dz) - V (r)));
+    }
+  };
+
+  struct LineKernel
+  {
+    SACFieldView points;
+    float px, py, pz, dx, dy, dz;
+
+    template <typename V> PCL_SIMD_INLINE V
+    compute (std::size_t i, std::size_t n) const
+    {
+      V p[3];
+      gather (points, i, n, p);
+      const V vx = V (px) - p[0], vy = V (py) - p[1], vz = V (pz) - p[2];
+      const V cx = vy * V (dz) - vz * V (dy);
+      const V cy = vz * V (dx) - vx * V (dz);
+      const V cz = vx * V (dy) - vy * V (dx);
+      return (sqrt (cx * cx + cy * cy + cz * cz));
+    }
+  };
+
+  struct CylinderKernel
+  {
+    SACFieldView points, normals;
+    float px, py, pz, dx, dy, dz, r;
+    float inv_sqr_dir, pt_dot_dir, weight;
+
+    template <typename V> PCL_SIMD_INLINE V
+    compute (std::size_t i, std::size_t n) const
+    {
+      V p[3], nrm[3];
+      gather (points, i, n, p);
+      gather (normals, i, n, nrm);
+
+      // Distance to the axis minus the radius
+      const V vx = V (px) - p[0], vy = V (py) - p[1], vz = V (pz) - p[2];
+      const V cx = V (dy) * vz - V (dz) * vy;
+      const V cy = V (dz) * vx - V (dx) * vz;
+      const V cz = V (dx) * vy - V (dy) * vx;
+      const V axis_distance = sqrt ((cx * cx + cy * cy + cz * cz) * V (inv_sqr_dir));
+      const V weighted_euclid_dist = V (1.0f - weight) * abs (axis_distance - V (r));
+
+      // Angle between the normal and the direction from the projection on the axis to the point
+      const V k = (p[0] * V (dx) + p[1] * V (dy) + p[2] * V (dz) - V (pt_dot_dir)) * V (inv_sqr_dir);
+      const V u[3] = {p[0] - (V (px) + k * V (dx)), p[1] - (V (py) + k * V (dy)), p[2] - (V (pz) + k * V (dz))};
+      return (abs (V (weight) * acuteAngle (nrm, u) + weighted_euclid_dist));
+    }
+  };
+
+  struct NormalPlaneKernel
+  {
+    SACFieldView points, normals, curvatures;
+    float a, b, c, d, weight;
+
+    template <typename V> PCL_SIMD_INLINE V
+    compute (std::size_t i, std::size_t n) const
+    {
+      V p[3], nrm[3], curvature[1];
+      gather (points, i, n, p);
+      gather (normals, i, n, nrm);
+      gather (curvatures, i, n, curvature);
+
+      const V d_euclid = abs (V (a) * p[0] + V (b) * p[1] + V (c) * p[2] + V (d));
+      const V plane_normal[3] = {V (a), V (b), V (c)};
+      // Weight with the point curvature, the normal has more influence on flat surfaces
+      const V w = V (weight) * (V (1.0f) - curvature[0]);
+      return (abs (w * acuteAngle (nrm, plane_normal) + (V (1.0f) - w) * d_euclid));
+    }
+  };
+
+  struct Circle3DKernel
+  {
+    SACFieldView points;
+    float cx, cy, cz, r, nx, ny, nz, inv_sqr_normal;
+
+    template <typename V> PCL_SIMD_INLINE V
+    compute (std::size_t i, std::size_t n) const
+    {
+      V p[3];
+      gather (points, i, n, p);
+
+      // Project the point on the circle plane, then move to the circle along the ray from the center
+      const V pcx = p[0] - V (cx), pcy = p[1] - V (cy), pcz = p[2] - V (cz);
+      const V lambda = V (0.0f) - (pcx * V (nx) + pcy * V (ny) + pcz * V (nz)) * V (inv_sqr_normal);
+      const V vx = pcx + lambda * V (nx), vy = pcy + lambda * V (ny), vz = pcz + lambda * V (nz);
+      const V v_norm = sqrt (vx * vx + vy * vy + vz * vz);
+      const V scale = select (V (0.0f) < v_norm, V (r) / v_norm, V (0.0f));
+      const V ex = pcx - scale * vx, ey = pcy - scale * vy, ez = pcz - scale * vz;
+      return (sqrt (ex * ex + ey * ey + ez * ez));
+    }
+  };
+
+  struct RegistrationKernel
+  {
+    SACFieldView source, target;
+    float m[12];
+
+    template <typename V> PCL_SIMD_INLINE V
+    compute (std::size_t i, std::size_t n) const
+    {
+      V s[3], t[3];
+      gather (source, i, n, s);
+      gather (target, i, n, t);
+      const V ex = V (m[0]) * s[0] + V (m[1]) * s[1] + V (m[2]) * s[2] + V (m[3]) - t[0];
+      const V ey = V (m[4]) * s[0] + V (m[5]) * s[1] + V (m[6]) * s[2] + V (m[7]) - t[1];
+      const V ez = V (m[8]) * s[0] + V (m[9]) * s[1] + V (m[10]) * s[2] + V (m[11]) - t[2];
+      return (sqrt (ex * ex + ey * ey + ez * ez));
+    }
+  };
+
+  /** Compute all distances, V::size at a time, the remaining ones through a padded batch. */
+  template <typename V, typename Kernel> PCL_SIMD_INLINE void
+  computeDistances (const Kernel &kernel, std::size_t count, float *distances)
+  {
+    std::size_t i = 0;
+    for (; i + V::size <= count; i += V::size)
+      kernel.template compute<V> (i, V::size).store (distances + i);
+    if (i == count)
+      return;
+
+    float tail[V::size];
+    kernel.template compute<V> (i, count - i).store (tail);
+    std::copy (tail, tail + (count - i), distances + i);
+  }
+
+#ifdef PCL_SIMD_KERNELS_SSE2
+  template <typename Kernel> void
+  computeDistancesSSE2 (const Kernel &kernel, std::size_t count, float *distances)
+  {
+    computeDistances<Lane4> (kernel, count, distances);
+  }
+#endif
+
+#ifdef PCL_SIMD_KERNELS_AVX
+  template <typename Kernel> PCL_SIMD_TARGET_AVX void
+  computeDistancesAVX (const Kernel &kernel, std::size_t count, float *distances)
+  {
+    computeDistances<Lane8> (kernel, count, distances);
+  }
+#endif
+
+#ifdef PCL_SIMD_KERNELS_AVX512
+  template <typename Kernel> PCL_SIMD_TARGET_AVX512 void
+  computeDistancesAVX512 (const Kernel &kernel, std::size_t count, float *distances)
+  {
+    computeDistances<Lane16> (kernel, count, distances);
+  }
+#endif
+
+  /** Run a kernel with the fastest lane type allowed by pcl::getSIMDLevel (). */
+  template <typename Kernel> void
+  dispatch (const Kernel &kernel, std::size_t count, float *distances)
+  {
+    const pcl::SIMDLevel level = pcl::getSIMDLevel ();
+#ifdef PCL_SIMD_KERNELS_AVX512
+    if (level >= pcl::SIMDLevel::AVX512)
+      return (computeDistancesAVX512 (kernel, count, distances));
+#endif
+#ifdef PCL_SIMD_KERNELS_AVX
+    if (level >= pcl::SIMDLevel::AVX)
+      return (computeDistancesAVX (kernel, count, distances));
+#endif
+#ifdef PCL_SIMD_KERNELS_SSE2
+    if (level >= pcl::SIMDLevel::SSE2)
+      return (computeDistancesSSE2 (kernel, count, distances));
+#endif
+    (void) level;
+    computeDistances<Lane<float> > (kernel, count, distances);
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+void
+pcl::detail::computeSphereDistances (const SACFieldView &points, std::size_t count,
+                                     const Eigen::Vector4f &sphere, float *distances)
+{
+  const SphereKernel kernel = {points, sphere[0], sphere[1], sphere[2], sphere[3]};
+  dispatch (kernel, count, distances);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+void
+pcl::detail::computeLineDistances (const SACFieldView &points, std::size_t count,
+                                   const Eigen::Vector3f &line_pt, const Eigen::Vector3f &line_dir,
+                                   float *distances)
+{
+  const LineKernel kernel = {points, line_pt[0], line_pt[1], line_pt[2], line_dir[0], line_dir[1], line_dir[2]};
+  dispatch (kernel, count, distances);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+void
+pcl::detail::computeCylinderDistances (const SACFieldView &points, const SACFieldView &normals, std::size_t count,
+                                       const Eigen::VectorXf &cylinder, float normal_distance_weight,
+                                       float *distances)
+{
+  const Eigen::Vector3f line_pt = cylinder.head<3> ();
+  const Eigen::Vector3f line_dir = cylinder.segment<3> (3);
+  const CylinderKernel kernel = {points, normals,
+                                 line_pt[0], line_pt[1], line_pt[2], line_dir[0], line_dir[1], line_dir[2], cylinder[6],
+                                 1.0f / line_dir.squaredNorm (), line_pt.dot (line_dir), normal_distance_weight};
+  dispatch (kernel, count, distances);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+void
+pcl::detail::computeNormalPlaneDistances (const SACFieldView &points, const SACFieldView &normals,
+                                          const SACFieldView &curvatures, std::size_t count,
+                                          const Eigen::Vector4f &plane, float normal_distance_weight,
+                                          float *distances)
+{
+  const NormalPlaneKernel kernel = {points, normals, curvatures,
+                                    plane[0], plane[1], plane[2], plane[3], normal_distance_weight};
+  dispatch (kernel, count, distances);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+void
+pcl::detail::computeCircle3DDistances (const SACFieldView &points, std::size_t count,
+                                       const Eigen::VectorXf &circle, float *distances)
+{
+  const Eigen::Vector3f normal = circle.segment<3> (4);
+  const Circle3DKernel kernel = {points, circle[0], circle[1], circle[2], circle[3],
+                                 normal[0], normal[1], normal[2], 1.0f / normal.squaredNorm ()};
+  dispatch (kernel, count, distances);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+void
+pcl::detail::computeRegistrationDistances (const SACFieldView &source, const SACFieldView &target, std::size_t count,
+                                           const Eigen::Matrix4f &transform, float *distances)
+{
+  RegistrationKernel kernel = {source, target, {}};
+  for (int row = 0; row < 3; ++row)
+    for (int col = 0; col < 4; ++col)
+      kernel.m[row * 4 + col] = transform (row, col);
+  dispatch (kernel, count, distances);
+}
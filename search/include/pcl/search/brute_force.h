@@ -44,6 +44,8 @@ namespace pcl
   namespace search
   {
     /** \brief Implementation of a simple brute force search algorithm.
+      * \note Point types with a pcl::StaticPointRepresentation, e.g. FPFHSignature33 or SHOT352, are compared on
+      * their whole vector with SIMD vectorized kernels, the other types on their xyz coordinates.
       * \author Suat Gedikli
       * \ingroup search
       */
@@ -84,6 +86,9 @@ namespace pcl
       // replace by some metric functor
       float getDistSqr (const PointT& point1, const PointT& point2) const;
       public:
+        using pcl::search::Search<PointT>::nearestKSearch;
+        using pcl::search::Search<PointT>::radiusSearch;
+
         BruteForce (bool sorted_results = false)
         : Search<PointT> ("BruteForce", sorted_results)
         {
@@ -59,6 +59,9 @@ namespace pcl
       * It is able to wrap any FLANN index type, e.g. the kd tree as well as indices for high-dimensional
       * searches and intended as a more powerful and cleaner successor to KdTreeFlann.
       * 
+      * The input cloud is converted into the FLANN matrix in parallel, see \ref setNumberOfThreads. If the point
+      * representation is trivial and all points are valid, FLANN reads the points in place instead.
+      *
       * By default, this class creates a single kd tree for indexing the input data. However, for high dimensions
       * (> 10), it is often better to use the multiple randomized kd tree index provided by FLANN in combination with
       * the \ref flann::L2 distance functor. During search in this type of index, the number of checks to perform before
@@ -250,6 +253,16 @@ namespace pcl
           return (checks_);
         }
 
+        /** \brief Set the number of threads used to convert the input cloud into the FLANN matrix.
+          * \param[in] nr_threads the number of threads to use
+          */
+        inline void
+        setNumberOfThreads (unsigned int nr_threads = 0)
+        {
+          // 0 is resolved against the budget of pcl::ExecutionContext at compute time
+          threads_ = nr_threads;
+        }
+
         /** \brief Provide a pointer to the input dataset.
           * \param[in] cloud the const boost shared pointer to a PointCloud message
           * \param[in] indices the point indices subset that is to be used from \a cloud
@@ -363,6 +376,10 @@ namespace pcl
         Indices index_mapping_;
         bool identity_mapping_;
 
+        /** The number of threads the conversion of the input cloud should use.
+          */
+        unsigned int threads_;
+
     };
   }
 }
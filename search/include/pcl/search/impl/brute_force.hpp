@@ -37,16 +37,56 @@
 
 #pragma once
 
-#include <pcl/common/point_tests.h> // for pcl::isFinite
+#include <pcl/point_types.h> // for pcl::traits::HasXYZ
+#include <pcl/point_representation.h> // for pcl::StaticPointRepresentation
 #include <pcl/search/brute_force.h>
+#include <algorithm>
 #include <queue>
 
+namespace pcl
+{
+  namespace search
+  {
+    namespace detail
+    {
+      // Point types with a StaticPointRepresentation, e.g. descriptors, are compared on their whole vector,
+      // read in place; all others on their coordinates
+      template <typename PointT> inline std::enable_if_t<StaticPointRepresentation<PointT>::available, float>
+      bruteForceDistSqr (const PointT& point1, const PointT& point2)
+      {
+        return (StaticPointRepresentation<PointT>::squaredL2Distance (point1, point2));
+      }
+
+      template <typename PointT> inline std::enable_if_t<!StaticPointRepresentation<PointT>::available, float>
+      bruteForceDistSqr (const PointT& point1, const PointT& point2)
+      {
+        return (point1.getVector3fMap () - point2.getVector3fMap ()).squaredNorm ();
+      }
+
+      // Points are checked on x as before, descriptors on all dimensions of their vector
+      template <typename PointT, traits::HasXYZ<PointT> = true> inline bool
+      bruteForceIsFinite (const PointT& point)
+      {
+        return (std::isfinite (point.x));
+      }
+
+      template <typename PointT, traits::HasNoXYZ<PointT> = true> inline bool
+      bruteForceIsFinite (const PointT& point)
+      {
+        const float* data = StaticPointRepresentation<PointT>::data (point);
+        return (std::all_of (data, data + StaticPointRepresentation<PointT>::dimensions,
+                             [] (float value) { return (std::isfinite (value)); }));
+      }
+    }
+  }
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointT> float
 pcl::search::BruteForce<PointT>::getDistSqr (
     const PointT& point1, const PointT& point2) const
 {
-  return (point1.getVector3fMap () - point2.getVector3fMap ()).squaredNorm ();
+  return (detail::bruteForceDistSqr (point1, point2));
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////
@@ -54,7 +94,7 @@ template <typename PointT> int
 pcl::search::BruteForce<PointT>::nearestKSearch (
     const PointT& point, int k, Indices& k_indices, std::vector<float>& k_distances) const
 {
-  assert (isFinite (point) && "Invalid (NaN, Inf) point coordinates given to nearestKSearch!");
+  assert (detail::bruteForceIsFinite (point) && "Invalid (NaN, Inf) point coordinates given to nearestKSearch!");
   
   k_indices.clear ();
   k_distances.clear ();
@@ -149,7 +189,7 @@ pcl::search::BruteForce<PointT>::sparseKSearch (
     auto iIt =indices_->cbegin ();
     for (; iIt != indices_->cend () && result.size () < static_cast<unsigned> (k); ++iIt)
     {
-      if (std::isfinite ((*input_)[*iIt].x))
+      if (detail::bruteForceIsFinite ((*input_)[*iIt]))
         result.push_back (Entry (*iIt, getDistSqr ((*input_)[*iIt], point)));
     }
     
@@ -160,7 +200,7 @@ pcl::search::BruteForce<PointT>::sparseKSearch (
     Entry entry;
     for (; iIt != indices_->cend (); ++iIt)
     {
-      if (!std::isfinite ((*input_)[*iIt].x))
+      if (!detail::bruteForceIsFinite ((*input_)[*iIt]))
         continue;
 
       entry.distance = getDistSqr ((*input_)[*iIt], point);
@@ -177,7 +217,7 @@ pcl::search::BruteForce<PointT>::sparseKSearch (
     Entry entry;
     for (entry.index = 0; (entry.index < static_cast<pcl::index_t>(input_->size ())) && (result.size () < static_cast<std::size_t> (k)); ++entry.index)
     {
-      if (std::isfinite ((*input_)[entry.index].x))
+      if (detail::bruteForceIsFinite ((*input_)[entry.index]))
       {
         entry.distance = getDistSqr ((*input_)[entry.index], point);
         result.push_back (entry);
@@ -188,7 +228,7 @@ pcl::search::BruteForce<PointT>::sparseKSearch (
     // add the rest
     for (; entry.index < static_cast<pcl::index_t>(input_->size ()); ++entry.index)
     {
-      if (!std::isfinite ((*input_)[entry.index].x))
+      if (!detail::bruteForceIsFinite ((*input_)[entry.index]))
         continue;
 
       entry.distance = getDistSqr ((*input_)[entry.index], point);
@@ -293,7 +333,7 @@ pcl::search::BruteForce<PointT>::sparseRadiusSearch (
   {
     for (const auto& idx : *indices_)
     {
-      if (!std::isfinite ((*input_)[idx].x))
+      if (!detail::bruteForceIsFinite ((*input_)[idx]))
         continue;
 
       distance = getDistSqr ((*input_)[idx], point);
@@ -310,7 +350,7 @@ pcl::search::BruteForce<PointT>::sparseRadiusSearch (
   {
     for (std::size_t index = 0; index < input_->size (); ++index)
     {
-      if (!std::isfinite ((*input_)[index].x))
+      if (!detail::bruteForceIsFinite ((*input_)[index]))
         continue;
       distance = getDistSqr ((*input_)[index], point);
       if (distance <= radius)
@@ -335,7 +375,7 @@ pcl::search::BruteForce<PointT>::radiusSearch (
     const PointT& point, double radius, Indices &k_indices,
     std::vector<float> &k_sqr_distances, unsigned int max_nn) const
 {
-  assert (isFinite (point) && "Invalid (NaN, Inf) point coordinates given to nearestKSearch!");
+  assert (detail::bruteForceIsFinite (point) && "Invalid (NaN, Inf) point coordinates given to nearestKSearch!");
   
   k_indices.clear ();
   k_sqr_distances.clear ();
@@ -45,6 +45,7 @@
 #include <flann/algorithms/kmeans_index.h>
 
 #include <pcl/search/flann_search.h>
+#include <pcl/common/execution_context.h>
 #include <pcl/kdtree/kdtree_flann.h> // for radius_search, knn_search
 // @TODO: remove once constexpr makes it easy to have the function in the header only
 #include <pcl/kdtree/impl/kdtree_flann.hpp>
@@ -77,7 +78,7 @@ pcl::search::FlannSearch<PointT, FlannDistance>::KdTreeMultiIndexCreator::create
 template <typename PointT, typename FlannDistance>
 pcl::search::FlannSearch<PointT, FlannDistance>::FlannSearch(bool sorted, FlannIndexCreatorPtr creator) : pcl::search::Search<PointT> ("FlannSearch",sorted),
   index_(), creator_ (creator), eps_ (0), checks_ (32), input_copied_for_flann_ (false), point_representation_ (new DefaultPointRepresentation<PointT>),
-  dim_ (0), identity_mapping_()
+  dim_ (0), identity_mapping_(), threads_ (0)
 {
   dim_ = point_representation_->getNumberOfDimensions ();
 }
@@ -365,72 +366,28 @@ pcl::search::FlannSearch<PointT, FlannDistance>::radiusSearch (
 template <typename PointT, typename FlannDistance> void
 pcl::search::FlannSearch<PointT, FlannDistance>::convertInputToFlannMatrix ()
 {
-  std::size_t original_no_of_points = indices_ && !indices_->empty () ? indices_->size () : input_->size ();
+  const pcl::ThreadReservation reservation (threads_);
+  const unsigned int threads = reservation.getNumberOfThreads ();
 
   if (input_copied_for_flann_)
-    delete input_flann_->ptr();
-  input_copied_for_flann_ = true;
-  index_mapping_.clear();
-  identity_mapping_ = true;
+    delete [] input_flann_->ptr();
+  input_copied_for_flann_ = false;
 
-  //cloud_ = (float*)malloc (original_no_of_points * dim_ * sizeof (float));
-  //index_mapping_.reserve(original_no_of_points);
-  //identity_mapping_ = true;
+  const Indices* indices = (indices_ && !indices_->empty () ? indices_.get () : nullptr);
+  const std::size_t nr_valid = pcl::detail::findValidPoints (*point_representation_, *input_, indices, index_mapping_, threads);
+  identity_mapping_ = index_mapping_.empty ();
 
-  if (!indices_ || indices_->empty ())
+  // best case: all points can be passed to flann without any conversions
+  if (!indices && identity_mapping_ && point_representation_->isTrivial () && nr_valid > 0)
   {
-    // best case: all points can be passed to flann without any conversions
-    if (input_->is_dense && point_representation_->isTrivial ())
-    {
-      // const cast is evil, but flann won't change the data
-      input_flann_ = MatrixPtr (new flann::Matrix<float> (const_cast<float*>(reinterpret_cast<const float*>(&(*input_) [0])), original_no_of_points, point_representation_->getNumberOfDimensions (),sizeof (PointT)));
-      input_copied_for_flann_ = false;
-    }
-    else
-    {
-      input_flann_ = MatrixPtr (new flann::Matrix<float> (new float[original_no_of_points*point_representation_->getNumberOfDimensions ()], original_no_of_points, point_representation_->getNumberOfDimensions ()));
-      float* cloud_ptr = input_flann_->ptr();
-      for (std::size_t i = 0; i < original_no_of_points; ++i)
-      {
-        const PointT& point = (*input_)[i];
-        // Check if the point is invalid
-        if (!point_representation_->isValid (point))
-        {
-          identity_mapping_ = false;
-          continue;
-        }
-
-        index_mapping_.push_back (static_cast<index_t> (i));  // If the returned index should be for the indices vector
-
-        point_representation_->vectorize (point, cloud_ptr);
-        cloud_ptr += dim_;
-      }
-    }
-
+    // const cast is evil, but flann won't change the data
+    input_flann_ = MatrixPtr (new flann::Matrix<float> (const_cast<float*>(reinterpret_cast<const float*>(&(*input_) [0])), nr_valid, point_representation_->getNumberOfDimensions (),sizeof (PointT)));
+    return;
   }
-  else
-  {
-    input_flann_ = MatrixPtr (new flann::Matrix<float> (new float[original_no_of_points*point_representation_->getNumberOfDimensions ()], original_no_of_points, point_representation_->getNumberOfDimensions ()));
-    float* cloud_ptr = input_flann_->ptr();
-    for (std::size_t indices_index = 0; indices_index < original_no_of_points; ++indices_index)
-    {
-      index_t cloud_index = (*indices_)[indices_index];
-      const PointT&  point = (*input_)[cloud_index];
-      // Check if the point is invalid
-      if (!point_representation_->isValid (point))
-      {
-        identity_mapping_ = false;
-        continue;
-      }
-
-      index_mapping_.push_back (static_cast<index_t> (indices_index));  // If the returned index should be for the indices vector
 
-      point_representation_->vectorize (point, cloud_ptr);
-      cloud_ptr += dim_;
-    }
-  }
-  if (input_copied_for_flann_)
-    input_flann_->rows = index_mapping_.size ();
+  input_flann_ = MatrixPtr (new flann::Matrix<float> (new float[nr_valid*point_representation_->getNumberOfDimensions ()], nr_valid, point_representation_->getNumberOfDimensions ()));
+  input_copied_for_flann_ = true;
+  pcl::detail::vectorizePoints (*point_representation_, *input_, indices, index_mapping_, nr_valid, input_flann_->ptr (), threads);
 }
 
 #define PCL_INSTANTIATE_FlannSearch(T) template class PCL_EXPORTS pcl::search::FlannSearch<T>;
@@ -0,0 +1,671 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#pragma once
+
+#include <pcl/common/point_tests.h> // for pcl::isXYZFinite
+#include <pcl/search/incremental_kdtree.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT>
+struct pcl::search::IncrementalKdTree<PointT>::KnnResultSet
+{
+  KnnResultSet (index_t *indices, float *distances, std::size_t capacity, float radius_sqr)
+  : indices_ (indices), distances_ (distances), capacity_ (capacity), radius_sqr_ (radius_sqr)
+  {
+  }
+
+  inline float
+  worstDistance () const
+  {
+    return (count_ < capacity_ ? radius_sqr_ : distances_[capacity_ - 1]);
+  }
+
+  inline void
+  addPoint (float distance, index_t index)
+  {
+    if (distance > radius_sqr_ || (count_ == capacity_ && distance >= distances_[capacity_ - 1]))
+      return;
+
+    std::size_t i = (count_ < capacity_) ? count_++ : capacity_ - 1;
+    for (; i > 0 && distances_[i - 1] > distance; --i)
+    {
+      distances_[i] = distances_[i - 1];
+      indices_[i] = indices_[i - 1];
+    }
+    distances_[i] = distance;
+    indices_[i] = index;
+  }
+
+  index_t *indices_;
+  float *distances_;
+  std::size_t capacity_;
+  std::size_t count_ = 0;
+  float radius_sqr_;
+};
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT>
+pcl::search::IncrementalKdTree<PointT>::IncrementalKdTree (bool sorted)
+  : Search<PointT> ("IncrementalKdTree", sorted)
+  , points_ (new PointCloud)
+{
+  input_ = points_;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::search::IncrementalKdTree<PointT>::setInputCloud (
+    const PointCloudConstPtr& cloud, const IndicesConstPtr& indices)
+{
+  nodes_.clear ();
+  free_nodes_.clear ();
+  free_points_.clear ();
+  root_ = -1;
+  indices_ = indices;
+
+  if (!cloud)
+  {
+    PCL_ERROR ("[pcl::search::IncrementalKdTree::setInputCloud] Invalid input!\n");
+    points_.reset (new PointCloud);
+    input_ = points_;
+    return;
+  }
+
+  // Keep the indices of the input cloud, so that the results refer to it until the first modification
+  points_.reset (new PointCloud (*cloud));
+  input_ = points_;
+
+  Indices points;
+  if (indices_)
+  {
+    points.reserve (indices_->size ());
+    for (const auto &index : *indices_)
+      if (isXYZFinite ((*points_)[index]))
+        points.push_back (index);
+  }
+  else
+  {
+    points.reserve (points_->size ());
+    for (index_t index = 0; index < static_cast<index_t> (points_->size ()); ++index)
+      if (isXYZFinite ((*points_)[index]))
+        points.push_back (index);
+  }
+
+  nodes_.resize (points.size ());
+  free_nodes_.resize (points.size ());
+  std::iota (free_nodes_.rbegin (), free_nodes_.rend (), 0);
+  root_ = build (points, 0, points.size ());
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> std::size_t
+pcl::search::IncrementalKdTree<PointT>::addPoints (const PointCloud &cloud)
+{
+  // The tree no longer matches the indices given with the input cloud
+  indices_.reset ();
+
+  std::size_t nr_inserted = 0;
+  Indices box_indices;
+  for (const auto &point : cloud)
+  {
+    if (!isXYZFinite (point))
+      continue;
+
+    if (downsample_on_insert_ && downsample_leaf_size_ > 0.0f)
+    {
+      const Eigen::Vector3f min_pt = (point.getVector3fMap () / downsample_leaf_size_).array ().floor ().matrix () * downsample_leaf_size_;
+      const Eigen::Vector3f max_pt = min_pt + Eigen::Vector3f::Constant (downsample_leaf_size_);
+      const Eigen::Vector3f center = min_pt + Eigen::Vector3f::Constant (0.5f * downsample_leaf_size_);
+
+      // Keep the point of the voxel that is closest to its center
+      boxSearch (min_pt, max_pt, box_indices);
+      const float dist_sqr = (point.getVector3fMap () - center).squaredNorm ();
+      bool closer_exists = false;
+      for (const auto &index : box_indices)
+      {
+        if (((*points_)[index].getVector3fMap () - center).squaredNorm () <= dist_sqr)
+        {
+          closer_exists = true;
+          break;
+        }
+      }
+      if (closer_exists)
+        continue;
+      if (!box_indices.empty ())
+        deletePointsInBox (min_pt, max_pt);
+    }
+
+    insertPoint (point);
+    ++nr_inserted;
+  }
+  return (nr_inserted);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> std::size_t
+pcl::search::IncrementalKdTree<PointT>::deletePointsInBox (
+    const Eigen::Vector3f &min_pt, const Eigen::Vector3f &max_pt)
+{
+  indices_.reset ();
+  return (deleteBox (root_, min_pt.data (), max_pt.data ()));
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> int
+pcl::search::IncrementalKdTree<PointT>::boxSearch (
+    const Eigen::Vector3f &min_pt, const Eigen::Vector3f &max_pt, Indices &k_indices) const
+{
+  k_indices.clear ();
+  searchBox (root_, min_pt.data (), max_pt.data (), k_indices);
+  return (static_cast<int> (k_indices.size ()));
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> int
+pcl::search::IncrementalKdTree<PointT>::allocateNode (index_t point)
+{
+  int node_idx;
+  if (free_nodes_.empty ())
+  {
+    node_idx = static_cast<int> (nodes_.size ());
+    nodes_.emplace_back ();
+  }
+  else
+  {
+    node_idx = free_nodes_.back ();
+    free_nodes_.pop_back ();
+  }
+
+  Node &node = nodes_[node_idx];
+  node.point = point;
+  node.left = node.right = -1;
+  node.dim = 0;
+  node.deleted = node.tree_deleted = false;
+  pushUp (node_idx);
+  return (node_idx);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> pcl::index_t
+pcl::search::IncrementalKdTree<PointT>::allocatePoint (const PointT &point)
+{
+  if (free_points_.empty ())
+  {
+    points_->push_back (point);
+    return (static_cast<index_t> (points_->size () - 1));
+  }
+  const index_t index = free_points_.back ();
+  free_points_.pop_back ();
+  (*points_)[index] = point;
+  return (index);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::search::IncrementalKdTree<PointT>::insertPoint (const PointT &point)
+{
+  // Allocate first: nodes_ must not grow while references into it are held below
+  const int new_node = allocateNode (allocatePoint (point));
+  insertNode (root_, new_node);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::search::IncrementalKdTree<PointT>::insertNode (int &node_idx, int new_node)
+{
+  if (node_idx < 0)
+  {
+    node_idx = new_node;
+    return;
+  }
+
+  pushDown (node_idx);
+  Node &node = nodes_[node_idx];
+  const float *point = (*points_)[nodes_[new_node].point].data;
+  if (point[node.dim] < (*points_)[node.point].data[node.dim])
+    insertNode (node.left, new_node);
+  else
+    insertNode (node.right, new_node);
+  pushUp (node_idx);
+  rebalance (node_idx);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> std::size_t
+pcl::search::IncrementalKdTree<PointT>::deleteBox (int &node_idx, const float *min_pt, const float *max_pt)
+{
+  if (node_idx < 0)
+    return (0);
+  Node &node = nodes_[node_idx];
+  if (node.invalid == node.size)
+    return (0);
+
+  bool inside = true;
+  for (int d = 0; d < 3; ++d)
+  {
+    if (node.max_pt[d] < min_pt[d] || node.min_pt[d] > max_pt[d])
+      return (0);
+    inside = inside && node.min_pt[d] >= min_pt[d] && node.max_pt[d] <= max_pt[d];
+  }
+
+  std::size_t nr_deleted = 0;
+  if (inside)
+  {
+    nr_deleted = node.size - node.invalid;
+    markTreeDeleted (node_idx);
+  }
+  else
+  {
+    pushDown (node_idx);
+    if (!node.deleted)
+    {
+      const float *point = (*points_)[node.point].data;
+      if (point[0] >= min_pt[0] && point[0] <= max_pt[0] &&
+          point[1] >= min_pt[1] && point[1] <= max_pt[1] &&
+          point[2] >= min_pt[2] && point[2] <= max_pt[2])
+      {
+        node.deleted = true;
+        ++nr_deleted;
+      }
+    }
+    nr_deleted += deleteBox (node.left, min_pt, max_pt);
+    nr_deleted += deleteBox (node.right, min_pt, max_pt);
+    pushUp (node_idx);
+  }
+  rebalance (node_idx);
+  return (nr_deleted);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::search::IncrementalKdTree<PointT>::pushUp (int node_idx)
+{
+  Node &node = nodes_[node_idx];
+  node.size = 1;
+  node.invalid = node.deleted ? 1 : 0;
+  if (node.deleted)
+  {
+    for (int d = 0; d < 3; ++d)
+    {
+      node.min_pt[d] = std::numeric_limits<float>::max ();
+      node.max_pt[d] = std::numeric_limits<float>::lowest ();
+    }
+  }
+  else
+  {
+    const float *point = (*points_)[node.point].data;
+    for (int d = 0; d < 3; ++d)
+      node.min_pt[d] = node.max_pt[d] = point[d];
+  }
+
+  for (const int child : {node.left, node.right})
+  {
+    if (child < 0)
+      continue;
+    const Node &child_node = nodes_[child];
+    node.size += child_node.size;
+    node.invalid += child_node.invalid;
+    for (int d = 0; d < 3; ++d)
+    {
+      node.min_pt[d] = std::min (node.min_pt[d], child_node.min_pt[d]);
+      node.max_pt[d] = std::max (node.max_pt[d], child_node.max_pt[d]);
+    }
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::search::IncrementalKdTree<PointT>::pushDown (int node_idx)
+{
+  Node &node = nodes_[node_idx];
+  if (!node.tree_deleted)
+    return;
+  if (node.left >= 0)
+    markTreeDeleted (node.left);
+  if (node.right >= 0)
+    markTreeDeleted (node.right);
+  node.tree_deleted = false;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::search::IncrementalKdTree<PointT>::markTreeDeleted (int node_idx)
+{
+  Node &node = nodes_[node_idx];
+  node.deleted = true;
+  node.tree_deleted = true;
+  node.invalid = node.size;
+  for (int d = 0; d < 3; ++d)
+  {
+    node.min_pt[d] = std::numeric_limits<float>::max ();
+    node.max_pt[d] = std::numeric_limits<float>::lowest ();
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::search::IncrementalKdTree<PointT>::rebalance (int &node_idx)
+{
+  const Node &node = nodes_[node_idx];
+  if (node.size < min_rebuild_size_)
+    return;
+
+  const int left_size = node.left < 0 ? 0 : nodes_[node.left].size;
+  const int right_size = node.right < 0 ? 0 : nodes_[node.right].size;
+  const float balance_limit = alpha_balance_ * static_cast<float> (node.size - 1);
+  if (static_cast<float> (left_size) <= balance_limit &&
+      static_cast<float> (right_size) <= balance_limit &&
+      static_cast<float> (node.invalid) <= alpha_delete_ * static_cast<float> (node.size))
+    return;
+
+  Indices points;
+  points.reserve (node.size - node.invalid);
+  flatten (node_idx, points);
+  node_idx = build (points, 0, points.size ());
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::search::IncrementalKdTree<PointT>::flatten (int node_idx, Indices &points)
+{
+  if (node_idx < 0)
+    return;
+  // A pending subtree deletion applies to all the nodes below
+  pushDown (node_idx);
+  const Node &node = nodes_[node_idx];
+  if (node.deleted)
+    free_points_.push_back (node.point);
+  else
+    points.push_back (node.point);
+  flatten (node.left, points);
+  flatten (node.right, points);
+  free_nodes_.push_back (node_idx);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> int
+pcl::search::IncrementalKdTree<PointT>::build (Indices &points, std::size_t begin, std::size_t end)
+{
+  if (begin >= end)
+    return (-1);
+
+  // Split at the median of the axis with the largest extent
+  float min_pt[3], max_pt[3];
+  for (int d = 0; d < 3; ++d)
+  {
+    min_pt[d] = std::numeric_limits<float>::max ();
+    max_pt[d] = std::numeric_limits<float>::lowest ();
+  }
+  for (std::size_t i = begin; i < end; ++i)
+  {
+    const float *point = (*points_)[points[i]].data;
+    for (int d = 0; d < 3; ++d)
+    {
+      min_pt[d] = std::min (min_pt[d], point[d]);
+      max_pt[d] = std::max (max_pt[d], point[d]);
+    }
+  }
+  int dim = 0;
+  for (int d = 1; d < 3; ++d)
+    if (max_pt[d] - min_pt[d] > max_pt[dim] - min_pt[dim])
+      dim = d;
+
+  const std::size_t mid = begin + (end - begin) / 2;
+  std::nth_element (points.begin () + begin, points.begin () + mid, points.begin () + end,
+                    [this, dim] (index_t a, index_t b) { return ((*points_)[a].data[dim] < (*points_)[b].data[dim]); });
+
+  // Only reuses the nodes freed by the caller, so nodes_ does not grow here
+  const int node_idx = allocateNode (points[mid]);
+  const int left = build (points, begin, mid);
+  const int right = build (points, mid + 1, end);
+  Node &node = nodes_[node_idx];
+  node.dim = dim;
+  node.left = left;
+  node.right = right;
+  pushUp (node_idx);
+  return (node_idx);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> float
+pcl::search::IncrementalKdTree<PointT>::getBoxDistance (int node_idx, const float *query) const
+{
+  const Node &node = nodes_[node_idx];
+  float dist_sqr = 0.0f;
+  for (int d = 0; d < 3; ++d)
+  {
+    if (query[d] < node.min_pt[d])
+      dist_sqr += (node.min_pt[d] - query[d]) * (node.min_pt[d] - query[d]);
+    else if (query[d] > node.max_pt[d])
+      dist_sqr += (query[d] - node.max_pt[d]) * (query[d] - node.max_pt[d]);
+  }
+  return (dist_sqr);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> template <typename ResultSet> void
+pcl::search::IncrementalKdTree<PointT>::searchKnn (int node_idx, const float *query, ResultSet &result) const
+{
+  const Node &node = nodes_[node_idx];
+  if (node.invalid == node.size || getBoxDistance (node_idx, query) > result.worstDistance ())
+    return;
+
+  if (!node.deleted)
+  {
+    const float *point = (*points_)[node.point].data;
+    const float dx = point[0] - query[0];
+    const float dy = point[1] - query[1];
+    const float dz = point[2] - query[2];
+    result.addPoint (dx * dx + dy * dy + dz * dz, node.point);
+  }
+
+  // Visit the closer child first
+  const float left_dist = node.left < 0 ? std::numeric_limits<float>::infinity () : getBoxDistance (node.left, query);
+  const float right_dist = node.right < 0 ? std::numeric_limits<float>::infinity () : getBoxDistance (node.right, query);
+  const int first = left_dist <= right_dist ? node.left : node.right;
+  const int second = left_dist <= right_dist ? node.right : node.left;
+  if (first >= 0)
+    searchKnn (first, query, result);
+  if (second >= 0)
+    searchKnn (second, query, result);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::search::IncrementalKdTree<PointT>::searchRadius (
+    int node_idx, const float *query, float radius_sqr,
+    Indices &k_indices, std::vector<float> &k_sqr_distances) const
+{
+  if (node_idx < 0)
+    return;
+  const Node &node = nodes_[node_idx];
+  if (node.invalid == node.size || getBoxDistance (node_idx, query) > radius_sqr)
+    return;
+
+  // If the farthest corner of the box is inside the sphere, take the whole subtree
+  if (node.invalid == 0)
+  {
+    float max_dist_sqr = 0.0f;
+    for (int d = 0; d < 3; ++d)
+    {
+      const float dist = std::max (std::abs (query[d] - node.min_pt[d]), std::abs (query[d] - node.max_pt[d]));
+      max_dist_sqr += dist * dist;
+    }
+    if (max_dist_sqr <= radius_sqr)
+    {
+      collectSubtree (node_idx, query, k_indices, k_sqr_distances);
+      return;
+    }
+  }
+
+  if (!node.deleted)
+  {
+    const float *point = (*points_)[node.point].data;
+    const float dx = point[0] - query[0];
+    const float dy = point[1] - query[1];
+    const float dz = point[2] - query[2];
+    const float dist_sqr = dx * dx + dy * dy + dz * dz;
+    if (dist_sqr <= radius_sqr)
+    {
+      k_indices.push_back (node.point);
+      k_sqr_distances.push_back (dist_sqr);
+    }
+  }
+  searchRadius (node.left, query, radius_sqr, k_indices, k_sqr_distances);
+  searchRadius (node.right, query, radius_sqr, k_indices, k_sqr_distances);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::search::IncrementalKdTree<PointT>::collectSubtree (
+    int node_idx, const float *query, Indices &k_indices, std::vector<float> &k_sqr_distances) const
+{
+  if (node_idx < 0)
+    return;
+  const Node &node = nodes_[node_idx];
+  const float *point = (*points_)[node.point].data;
+  const float dx = point[0] - query[0];
+  const float dy = point[1] - query[1];
+  const float dz = point[2] - query[2];
+  k_indices.push_back (node.point);
+  k_sqr_distances.push_back (dx * dx + dy * dy + dz * dz);
+  collectSubtree (node.left, query, k_indices, k_sqr_distances);
+  collectSubtree (node.right, query, k_indices, k_sqr_distances);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::search::IncrementalKdTree<PointT>::searchBox (
+    int node_idx, const float *min_pt, const float *max_pt, Indices &k_indices) const
+{
+  if (node_idx < 0)
+    return;
+  const Node &node = nodes_[node_idx];
+  if (node.invalid == node.size)
+    return;
+  for (int d = 0; d < 3; ++d)
+    if (node.max_pt[d] < min_pt[d] || node.min_pt[d] > max_pt[d])
+      return;
+
+  if (!node.deleted)
+  {
+    const float *point = (*points_)[node.point].data;
+    if (point[0] >= min_pt[0] && point[0] <= max_pt[0] &&
+        point[1] >= min_pt[1] && point[1] <= max_pt[1] &&
+        point[2] >= min_pt[2] && point[2] <= max_pt[2])
+      k_indices.push_back (node.point);
+  }
+  searchBox (node.left, min_pt, max_pt, k_indices);
+  searchBox (node.right, min_pt, max_pt, k_indices);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> int
+pcl::search::IncrementalKdTree<PointT>::nearestKSearch (
+    const PointT &point, int k, Indices &k_indices, std::vector<float> &k_sqr_distances) const
+{
+  assert (isXYZFinite (point) && "Invalid (NaN, Inf) point coordinates given to nearestKSearch!");
+
+  if (k > static_cast<int> (size ()))
+    k = static_cast<int> (size ());
+  if (k < 1)
+  {
+    k_indices.clear ();
+    k_sqr_distances.clear ();
+    return (0);
+  }
+
+  k_indices.resize (k);
+  k_sqr_distances.resize (k);
+  const float query[3] = {point.x, point.y, point.z};
+  KnnResultSet result (k_indices.data (), k_sqr_distances.data (), k, std::numeric_limits<float>::infinity ());
+  searchKnn (root_, query, result);
+  return (k);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> int
+pcl::search::IncrementalKdTree<PointT>::radiusSearch (
+    const PointT& point, double radius, Indices &k_indices, std::vector<float> &k_sqr_distances,
+    unsigned int max_nn) const
+{
+  assert (isXYZFinite (point) && "Invalid (NaN, Inf) point coordinates given to radiusSearch!");
+
+  k_indices.clear ();
+  k_sqr_distances.clear ();
+  if (root_ < 0)
+    return (0);
+
+  const float query[3] = {point.x, point.y, point.z};
+  const auto radius_sqr = static_cast<float> (radius * radius);
+
+  // With a bound on the number of neighbors, keep the closest ones
+  if (max_nn > 0 && max_nn < size ())
+  {
+    k_indices.resize (max_nn);
+    k_sqr_distances.resize (max_nn);
+    KnnResultSet result (k_indices.data (), k_sqr_distances.data (), max_nn, radius_sqr);
+    searchKnn (root_, query, result);
+    k_indices.resize (result.count_);
+    k_sqr_distances.resize (result.count_);
+    return (static_cast<int> (result.count_));
+  }
+
+  searchRadius (root_, query, radius_sqr, k_indices, k_sqr_distances);
+
+  if (sorted_results_ && k_indices.size () > 1)
+  {
+    std::vector<std::pair<float, index_t> > neighbors (k_indices.size ());
+    for (std::size_t i = 0; i < k_indices.size (); ++i)
+      neighbors[i] = std::make_pair (k_sqr_distances[i], k_indices[i]);
+    std::sort (neighbors.begin (), neighbors.end ());
+    for (std::size_t i = 0; i < k_indices.size (); ++i)
+    {
+      k_sqr_distances[i] = neighbors[i].first;
+      k_indices[i] = neighbors[i].second;
+    }
+  }
+  return (static_cast<int> (k_indices.size ()));
+}
+
+#define PCL_INSTANTIATE_IncrementalKdTree(T) template class PCL_EXPORTS pcl::search::IncrementalKdTree<T>;
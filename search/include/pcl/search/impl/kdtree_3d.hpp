@@ -0,0 +1,431 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#pragma once
+
+#include <pcl/common/point_tests.h> // for pcl::isXYZFinite
+#include <pcl/search/kdtree_3d.h>
+
+#include <algorithm>
+#include <limits>
+
+#ifdef __SSE__
+#include <xmmintrin.h> // for __m128
+#endif // ifdef __SSE__
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT>
+struct pcl::search::KdTree3D<PointT>::KnnResultSet
+{
+  KnnResultSet (index_t *indices, float *distances, std::size_t capacity, float radius_sqr)
+  : indices_ (indices), distances_ (distances), capacity_ (capacity), radius_sqr_ (radius_sqr)
+  {
+  }
+
+  inline float
+  worstDistance () const
+  {
+    return (count_ < capacity_ ? radius_sqr_ : distances_[capacity_ - 1]);
+  }
+
+  inline void
+  addPoint (float distance, index_t index)
+  {
+    if (distance > radius_sqr_ || (count_ == capacity_ && distance >= distances_[capacity_ - 1]))
+      return;
+
+    // insertion sort, dropping the current worst neighbor if full
+    std::size_t i = (count_ < capacity_) ? count_++ : capacity_ - 1;
+    for (; i > 0 && distances_[i - 1] > distance; --i)
+    {
+      distances_[i] = distances_[i - 1];
+      indices_[i] = indices_[i - 1];
+    }
+    distances_[i] = distance;
+    indices_[i] = index;
+  }
+
+  index_t *indices_;
+  float *distances_;
+  std::size_t capacity_;
+  std::size_t count_ = 0;
+  float radius_sqr_;
+};
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT>
+struct pcl::search::KdTree3D<PointT>::RadiusResultSet
+{
+  RadiusResultSet (Indices &indices, std::vector<float> &distances, float radius_sqr)
+  : indices_ (indices), distances_ (distances), radius_sqr_ (radius_sqr)
+  {
+  }
+
+  inline float
+  worstDistance () const
+  {
+    return (radius_sqr_);
+  }
+
+  inline void
+  addPoint (float distance, index_t index)
+  {
+    if (distance > radius_sqr_)
+      return;
+    indices_.push_back (index);
+    distances_.push_back (distance);
+  }
+
+  Indices &indices_;
+  std::vector<float> &distances_;
+  float radius_sqr_;
+};
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::search::KdTree3D<PointT>::setInputCloud (
+    const PointCloudConstPtr& cloud, const IndicesConstPtr& indices)
+{
+  input_ = cloud;
+  indices_ = indices;
+
+  nodes_.clear ();
+  x_.clear ();
+  y_.clear ();
+  z_.clear ();
+  bucket_indices_.clear ();
+  nr_points_ = 0;
+
+  if (!input_)
+  {
+    PCL_ERROR ("[pcl::search::KdTree3D::setInputCloud] Invalid input!\n");
+    return;
+  }
+
+  // Collect the valid points, in the order in which the tree will partition them
+  Indices build_indices;
+  if (indices_)
+  {
+    build_indices.reserve (indices_->size ());
+    for (const auto &index : *indices_)
+      if (isXYZFinite ((*input_)[index]))
+        build_indices.push_back (index);
+  }
+  else
+  {
+    build_indices.reserve (input_->size ());
+    for (index_t index = 0; index < static_cast<index_t> (input_->size ()); ++index)
+      if (isXYZFinite ((*input_)[index]))
+        build_indices.push_back (index);
+  }
+
+  nr_points_ = build_indices.size ();
+  if (nr_points_ == 0)
+    return;
+
+  for (int d = 0; d < 3; ++d)
+  {
+    min_pt_[d] = std::numeric_limits<float>::max ();
+    max_pt_[d] = std::numeric_limits<float>::lowest ();
+  }
+  for (const auto &index : build_indices)
+  {
+    const PointT &point = (*input_)[index];
+    for (int d = 0; d < 3; ++d)
+    {
+      min_pt_[d] = std::min (min_pt_[d], point.data[d]);
+      max_pt_[d] = std::max (max_pt_[d], point.data[d]);
+    }
+  }
+
+  // Leaves hold between max_leaf_size_ / 2 and max_leaf_size_ points
+  const std::size_t max_nr_leaves = 2 * nr_points_ / max_leaf_size_ + 1;
+  nodes_.reserve (2 * max_nr_leaves);
+  const std::size_t bucket_size = nr_points_ + 3 * max_nr_leaves;
+  x_.reserve (bucket_size);
+  y_.reserve (bucket_size);
+  z_.reserve (bucket_size);
+  bucket_indices_.reserve (bucket_size);
+
+  buildNode (build_indices, 0, nr_points_);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> pcl::uindex_t
+pcl::search::KdTree3D<PointT>::buildNode (Indices &build_indices, std::size_t begin, std::size_t end)
+{
+  const auto node_idx = static_cast<uindex_t> (nodes_.size ());
+  nodes_.emplace_back ();
+
+  if (end - begin <= static_cast<std::size_t> (max_leaf_size_))
+  {
+    Node &node = nodes_.back ();
+    node.dim = -1;
+    node.begin = static_cast<uindex_t> (x_.size ());
+    node.end = static_cast<uindex_t> (x_.size () + (end - begin));
+    for (std::size_t i = begin; i < end; ++i)
+    {
+      const PointT &point = (*input_)[build_indices[i]];
+      x_.push_back (point.x);
+      y_.push_back (point.y);
+      z_.push_back (point.z);
+      bucket_indices_.push_back (build_indices[i]);
+    }
+    // Pad the bucket, so that the leaf can be processed 4 points at a time
+    while (x_.size () % 4 != 0)
+    {
+      x_.push_back (std::numeric_limits<float>::infinity ());
+      y_.push_back (std::numeric_limits<float>::infinity ());
+      z_.push_back (std::numeric_limits<float>::infinity ());
+      bucket_indices_.push_back (-1);
+    }
+    return (node_idx);
+  }
+
+  // Split at the median of the axis with the largest extent
+  float min_pt[3], max_pt[3];
+  for (int d = 0; d < 3; ++d)
+  {
+    min_pt[d] = std::numeric_limits<float>::max ();
+    max_pt[d] = std::numeric_limits<float>::lowest ();
+  }
+  for (std::size_t i = begin; i < end; ++i)
+  {
+    const PointT &point = (*input_)[build_indices[i]];
+    for (int d = 0; d < 3; ++d)
+    {
+      min_pt[d] = std::min (min_pt[d], point.data[d]);
+      max_pt[d] = std::max (max_pt[d], point.data[d]);
+    }
+  }
+  int dim = 0;
+  for (int d = 1; d < 3; ++d)
+    if (max_pt[d] - min_pt[d] > max_pt[dim] - min_pt[dim])
+      dim = d;
+
+  const std::size_t mid = begin + (end - begin) / 2;
+  std::nth_element (build_indices.begin () + begin, build_indices.begin () + mid, build_indices.begin () + end,
+                    [this, dim] (index_t a, index_t b) { return ((*input_)[a].data[dim] < (*input_)[b].data[dim]); });
+
+  float low = std::numeric_limits<float>::lowest ();
+  for (std::size_t i = begin; i < mid; ++i)
+    low = std::max (low, (*input_)[build_indices[i]].data[dim]);
+  const float high = (*input_)[build_indices[mid]].data[dim];
+
+  buildNode (build_indices, begin, mid);
+  const uindex_t right = buildNode (build_indices, mid, end);
+
+  // The recursion may have reallocated nodes_, so only take the reference now
+  Node &node = nodes_[node_idx];
+  node.dim = dim;
+  node.low = low;
+  node.high = high;
+  node.right = right;
+  return (node_idx);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> float
+pcl::search::KdTree3D<PointT>::getInitialDistances (const float *query, float *dists) const
+{
+  float dist_sqr = 0.0f;
+  for (int d = 0; d < 3; ++d)
+  {
+    dists[d] = 0.0f;
+    if (query[d] < min_pt_[d])
+      dists[d] = (min_pt_[d] - query[d]) * (min_pt_[d] - query[d]);
+    else if (query[d] > max_pt_[d])
+      dists[d] = (query[d] - max_pt_[d]) * (query[d] - max_pt_[d]);
+    dist_sqr += dists[d];
+  }
+  return (dist_sqr);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> template <typename ResultSet> void
+pcl::search::KdTree3D<PointT>::searchLeaf (const Node &node, const float *query, ResultSet &result) const
+{
+#ifdef __SSE__
+  const __m128 qx = _mm_set1_ps (query[0]);
+  const __m128 qy = _mm_set1_ps (query[1]);
+  const __m128 qz = _mm_set1_ps (query[2]);
+  alignas (16) float dist[4];
+  for (uindex_t i = node.begin; i < node.end; i += 4)
+  {
+    const __m128 dx = _mm_sub_ps (_mm_loadu_ps (&x_[i]), qx);
+    const __m128 dy = _mm_sub_ps (_mm_loadu_ps (&y_[i]), qy);
+    const __m128 dz = _mm_sub_ps (_mm_loadu_ps (&z_[i]), qz);
+    const __m128 dist_sqr = _mm_add_ps (_mm_add_ps (_mm_mul_ps (dx, dx), _mm_mul_ps (dy, dy)), _mm_mul_ps (dz, dz));
+    // Skip the whole block if none of the points can enter the result set
+    const int mask = _mm_movemask_ps (_mm_cmple_ps (dist_sqr, _mm_set1_ps (result.worstDistance ())));
+    if (mask == 0)
+      continue;
+    _mm_store_ps (dist, dist_sqr);
+    const uindex_t nr_valid = std::min<uindex_t> (4, node.end - i);
+    for (uindex_t j = 0; j < nr_valid; ++j)
+      if (mask & (1 << j))
+        result.addPoint (dist[j], bucket_indices_[i + j]);
+  }
+#else
+  for (uindex_t i = node.begin; i < node.end; ++i)
+  {
+    const float dx = x_[i] - query[0];
+    const float dy = y_[i] - query[1];
+    const float dz = z_[i] - query[2];
+    result.addPoint (dx * dx + dy * dy + dz * dz, bucket_indices_[i]);
+  }
+#endif // ifdef __SSE__
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> template <typename ResultSet> void
+pcl::search::KdTree3D<PointT>::searchLevel (
+    uindex_t node_idx, const float *query, float min_dist_sqr, float *dists, ResultSet &result) const
+{
+  const Node &node = nodes_[node_idx];
+  if (node.dim < 0)
+  {
+    searchLeaf (node, query, result);
+    return;
+  }
+
+  // Visit the child on the query's side of the split first
+  const float diff_low = query[node.dim] - node.low;
+  const float diff_high = query[node.dim] - node.high;
+  uindex_t best_child, other_child;
+  float cut_dist;
+  if (diff_low + diff_high < 0)
+  {
+    best_child = node_idx + 1;
+    other_child = node.right;
+    cut_dist = diff_high * diff_high;
+  }
+  else
+  {
+    best_child = node.right;
+    other_child = node_idx + 1;
+    cut_dist = diff_low * diff_low;
+  }
+  searchLevel (best_child, query, min_dist_sqr, dists, result);
+
+  // Only the contribution of the split axis changes for the other child
+  const float dist = dists[node.dim];
+  min_dist_sqr += cut_dist - dist;
+  if (min_dist_sqr <= result.worstDistance ())
+  {
+    dists[node.dim] = cut_dist;
+    searchLevel (other_child, query, min_dist_sqr, dists, result);
+    dists[node.dim] = dist;
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> int
+pcl::search::KdTree3D<PointT>::nearestKSearch (
+    const PointT &point, int k, Indices &k_indices, std::vector<float> &k_sqr_distances) const
+{
+  assert (isXYZFinite (point) && "Invalid (NaN, Inf) point coordinates given to nearestKSearch!");
+
+  if (k > static_cast<int> (nr_points_))
+    k = static_cast<int> (nr_points_);
+  if (k < 1)
+  {
+    k_indices.clear ();
+    k_sqr_distances.clear ();
+    return (0);
+  }
+
+  k_indices.resize (k);
+  k_sqr_distances.resize (k);
+
+  const float query[3] = {point.x, point.y, point.z};
+  float dists[3];
+  const float min_dist_sqr = getInitialDistances (query, dists);
+  KnnResultSet result (k_indices.data (), k_sqr_distances.data (), k, std::numeric_limits<float>::infinity ());
+  searchLevel (0, query, min_dist_sqr, dists, result);
+  return (k);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> int
+pcl::search::KdTree3D<PointT>::radiusSearch (
+    const PointT& point, double radius, Indices &k_indices, std::vector<float> &k_sqr_distances,
+    unsigned int max_nn) const
+{
+  assert (isXYZFinite (point) && "Invalid (NaN, Inf) point coordinates given to radiusSearch!");
+
+  k_indices.clear ();
+  k_sqr_distances.clear ();
+  if (nr_points_ == 0)
+    return (0);
+
+  const float query[3] = {point.x, point.y, point.z};
+  float dists[3];
+  const float min_dist_sqr = getInitialDistances (query, dists);
+  const auto radius_sqr = static_cast<float> (radius * radius);
+
+  // With a bound on the number of neighbors, keep the closest ones
+  if (max_nn > 0 && max_nn < nr_points_)
+  {
+    k_indices.resize (max_nn);
+    k_sqr_distances.resize (max_nn);
+    KnnResultSet result (k_indices.data (), k_sqr_distances.data (), max_nn, radius_sqr);
+    searchLevel (0, query, min_dist_sqr, dists, result);
+    k_indices.resize (result.count_);
+    k_sqr_distances.resize (result.count_);
+    return (static_cast<int> (result.count_));
+  }
+
+  RadiusResultSet result (k_indices, k_sqr_distances, radius_sqr);
+  searchLevel (0, query, min_dist_sqr, dists, result);
+
+  if (sorted_results_ && k_indices.size () > 1)
+  {
+    std::vector<std::pair<float, index_t> > neighbors (k_indices.size ());
+    for (std::size_t i = 0; i < k_indices.size (); ++i)
+      neighbors[i] = std::make_pair (k_sqr_distances[i], k_indices[i]);
+    std::sort (neighbors.begin (), neighbors.end ());
+    for (std::size_t i = 0; i < k_indices.size (); ++i)
+    {
+      k_sqr_distances[i] = neighbors[i].first;
+      k_indices[i] = neighbors[i].second;
+    }
+  }
+  return (static_cast<int> (k_indices.size ()));
+}
+
+#define PCL_INSTANTIATE_KdTree3D(T) template class PCL_EXPORTS pcl::search::KdTree3D<T>;
@@ -128,8 +128,61 @@ pcl::search::OrganizedNeighbor<PointT>::nearestKSearch (const PointT &query,
   // project query point on the image plane
   //Eigen::Vector3f q = KR_ * query.getVector3fMap () + projection_matrix_.block <3, 1> (0, 3);
   Eigen::Vector3f q (KR_ * queryvec + projection_matrix_.block <3, 1> (0, 3));
-  int xBegin = int(q [0] / q [2] + 0.5f);
-  int yBegin = int(q [1] / q [2] + 0.5f);
+  return (nearestKSearchFromPixel (query, int(q [0] / q [2] + 0.5f), int(q [1] / q [2] + 0.5f), k, k_indices, k_sqr_distances));
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template<typename PointT> int
+pcl::search::OrganizedNeighbor<PointT>::nearestKSearch (const PointCloud &cloud,
+                                                        index_t index,
+                                                        int k,
+                                                        Indices &k_indices,
+                                                        std::vector<float> &k_sqr_distances) const
+{
+  if (&cloud != input_.get ())
+    return (nearestKSearch (cloud[index], k, k_indices, k_sqr_distances));
+
+  assert (isFinite (cloud[index]) && "Invalid (NaN, Inf) point coordinates given to nearestKSearch!");
+  if (k < 1)
+  {
+    k_indices.clear ();
+    k_sqr_distances.clear ();
+    return (0);
+  }
+  // the query is a point of the input, so its pixel is known without projecting it
+  return (nearestKSearchFromPixel (cloud[index], static_cast<int> (index % input_->width),
+                                   static_cast<int> (index / input_->width), k, k_indices, k_sqr_distances));
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template<typename PointT> int
+pcl::search::OrganizedNeighbor<PointT>::nearestKSearch (index_t index,
+                                                        int k,
+                                                        Indices &k_indices,
+                                                        std::vector<float> &k_sqr_distances) const
+{
+  if (!indices_)
+  {
+    assert (index >= 0 && index < static_cast<index_t> (input_->size ()) && "Out-of-bounds error in nearestKSearch!");
+    return (nearestKSearch (*input_, index, k, k_indices, k_sqr_distances));
+  }
+  assert (index >= 0 && index < static_cast<index_t> (indices_->size ()) && "Out-of-bounds error in nearestKSearch!");
+  if (index >= static_cast<index_t> (indices_->size ()) || index < 0)
+    return (0);
+  return (nearestKSearch (*input_, (*indices_)[index], k, k_indices, k_sqr_distances));
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template<typename PointT> int
+pcl::search::OrganizedNeighbor<PointT>::nearestKSearchFromPixel (const PointT &query,
+                                                                 int x,
+                                                                 int y,
+                                                                 int k,
+                                                                 Indices &k_indices,
+                                                                 std::vector<float> &k_sqr_distances) const
+{
+  int xBegin = x;
+  int yBegin = y;
   int xEnd   = xBegin + 1; // end is the pixel that is not used anymore, like in iterators
   int yEnd   = yBegin + 1;
 
@@ -139,14 +192,19 @@ pcl::search::OrganizedNeighbor<PointT>::nearestKSearch (const PointT &query,
   unsigned top = 0;
   unsigned bottom = input_->height - 1;
 
-  std::vector <Entry> results; // sorted from smallest to largest distance
-  results.reserve (k);
+  // the results are kept sorted from smallest to largest distance in the output vectors, which only
+  // allocate if they had less than k entries before
+  k_indices.resize (k);
+  k_sqr_distances.resize (k);
+  index_t* indices = k_indices.data ();
+  float* sqr_distances = k_sqr_distances.data ();
+  unsigned nr_found = 0;
   // add point laying on the projection of the query point.
   if (xBegin >= 0 && 
       xBegin < static_cast<int> (input_->width) && 
       yBegin >= 0 && 
       yBegin < static_cast<int> (input_->height))
-    testPoint (query, k, results, yBegin * input_->width + xBegin);
+    testPoint (query, k, indices, sqr_distances, nr_found, yBegin * input_->width + xBegin);
   else // point lys
   {
     // find the box that touches the image border -> don't waste time evaluating boxes that are completely outside the image!
@@ -194,7 +252,7 @@ pcl::search::OrganizedNeighbor<PointT>::nearestKSearch (const PointT &query,
         index_t idx   = yBegin * input_->width + xFrom;
         index_t idxTo = idx + xTo - xFrom;
         for (; idx < idxTo; ++idx)
-          stop = testPoint (query, k, results, idx) || stop;
+          stop = testPoint (query, k, indices, sqr_distances, nr_found, idx) || stop;
       }
       
 
@@ -206,7 +264,7 @@ pcl::search::OrganizedNeighbor<PointT>::nearestKSearch (const PointT &query,
         index_t idxTo = idx + xTo - xFrom;
 
         for (; idx < idxTo; ++idx)
-          stop = testPoint (query, k, results, idx) || stop;
+          stop = testPoint (query, k, indices, sqr_distances, nr_found, idx) || stop;
       }
       
       // skip first row and last row (already handled above)
@@ -223,7 +281,7 @@ pcl::search::OrganizedNeighbor<PointT>::nearestKSearch (const PointT &query,
           index_t idxTo = yTo * input_->width + xBegin;
 
           for (; idx < idxTo; idx += input_->width)
-            stop = testPoint (query, k, results, idx) || stop;
+            stop = testPoint (query, k, indices, sqr_distances, nr_found, idx) || stop;
         }
         
         if (xEnd > 0 && xEnd <= static_cast<int> (input_->width))
@@ -232,13 +290,13 @@ pcl::search::OrganizedNeighbor<PointT>::nearestKSearch (const PointT &query,
           index_t idxTo = yTo * input_->width + xEnd - 1;
 
           for (; idx < idxTo; idx += input_->width)
-            stop = testPoint (query, k, results, idx) || stop;
+            stop = testPoint (query, k, indices, sqr_distances, nr_found, idx) || stop;
         }
         
       }
       // stop here means that the k-nearest neighbor changed -> recalculate bounding box of ellipse.
       if (stop)
-        getProjectedRadiusSearchBox (query, results.back ().distance, left, right, top, bottom);
+        getProjectedRadiusSearchBox (query, sqr_distances [nr_found - 1], left, right, top, bottom);
       
     }
     // now we use it as stop flag -> if bounding box is completely within the already examined search box were done!
@@ -250,18 +308,9 @@ pcl::search::OrganizedNeighbor<PointT>::nearestKSearch (const PointT &query,
   } while (!stop);
 
   
-  const auto results_size = results.size ();
-  k_indices.resize (results_size);
-  k_sqr_distances.resize (results_size);
-  std::size_t idx = 0;
-  for(const auto& result : results)
-  {
-    k_indices [idx] = result.index;
-    k_sqr_distances [idx] = result.distance;
-    ++idx;
-  }
-  
-  return (static_cast<int> (results_size));
+  k_indices.resize (nr_found);
+  k_sqr_distances.resize (nr_found);
+  return (static_cast<int> (nr_found));
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////
@@ -39,6 +39,9 @@
 #define PCL_SEARCH_SEARCH_IMPL_HPP_
 
 #include <pcl/search/search.h>
+#include <pcl/common/execution_context.h>
+
+#include <algorithm> // for copy_n
 
 ///////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointT>
@@ -183,6 +186,135 @@ pcl::search::Search<PointT>::radiusSearch (
   }
 }
 
+///////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::search::Search<PointT>::nearestKSearch (
+    const PointCloud& cloud, const Indices& indices, int k,
+    Indices& k_indices, std::vector<float>& k_sqr_distances,
+    std::vector<std::size_t>& offsets, unsigned int nr_threads) const
+{
+  const pcl::ThreadReservation reservation (nr_threads);
+  const unsigned int threads = reservation.getNumberOfThreads ();
+
+  std::ptrdiff_t nr_queries = static_cast<std::ptrdiff_t> (indices.empty () ? cloud.size () : indices.size ());
+  std::size_t stride = static_cast<std::size_t> (std::max (k, 0));
+
+  // Every query gets a slot of k neighbors, the slots are compacted afterwards
+  k_indices.resize (nr_queries * stride);
+  k_sqr_distances.resize (nr_queries * stride);
+  offsets.assign (nr_queries + 1, 0);
+
+#pragma omp parallel \
+  default(none) \
+  shared(cloud, indices, k, k_indices, k_sqr_distances, nr_queries, offsets, stride) \
+  num_threads(threads)
+  {
+    // Scratch buffers, reused for all the queries of a thread
+    Indices nn_indices (stride);
+    std::vector<float> nn_sqr_distances (stride);
+
+#pragma omp for schedule(dynamic, 64)
+    for (std::ptrdiff_t i = 0; i < nr_queries; ++i)
+    {
+      const index_t query = indices.empty () ? static_cast<index_t> (i) : indices[i];
+      const int nr_found = std::min (nearestKSearch (cloud, query, k, nn_indices, nn_sqr_distances), k);
+      if (nr_found <= 0)
+        continue;
+      std::copy_n (nn_indices.begin (), nr_found, k_indices.begin () + i * stride);
+      std::copy_n (nn_sqr_distances.begin (), nr_found, k_sqr_distances.begin () + i * stride);
+      offsets[i + 1] = static_cast<std::size_t> (nr_found);
+    }
+  }
+
+  // Turn the counts into offsets and compact the slots. A query is never moved
+  // to the right, so this can be done in place.
+  for (std::ptrdiff_t i = 0; i < nr_queries; ++i)
+  {
+    const std::size_t nr_found = offsets[i + 1];
+    const std::size_t begin = offsets[i];
+    if (begin != i * stride)
+    {
+      std::copy_n (k_indices.begin () + i * stride, nr_found, k_indices.begin () + begin);
+      std::copy_n (k_sqr_distances.begin () + i * stride, nr_found, k_sqr_distances.begin () + begin);
+    }
+    offsets[i + 1] = begin + nr_found;
+  }
+  k_indices.resize (offsets.back ());
+  k_sqr_distances.resize (offsets.back ());
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::search::Search<PointT>::radiusSearch (
+    const PointCloud& cloud,
+    const Indices& indices,
+    double radius,
+    Indices& k_indices,
+    std::vector<float>& k_sqr_distances,
+    std::vector<std::size_t>& offsets,
+    unsigned int max_nn,
+    unsigned int nr_threads) const
+{
+  const pcl::ThreadReservation reservation (nr_threads);
+  const unsigned int threads = reservation.getNumberOfThreads ();
+
+  // The number of neighbors is not known in advance: the queries are processed in
+  // blocks, and each block collects the neighbors of its queries in its own buffers
+  std::ptrdiff_t nr_queries = static_cast<std::ptrdiff_t> (indices.empty () ? cloud.size () : indices.size ());
+  std::ptrdiff_t block_size = 256;
+  std::ptrdiff_t nr_blocks = (nr_queries + block_size - 1) / block_size;
+  std::vector<Indices> block_indices (nr_blocks);
+  std::vector<std::vector<float> > block_sqr_distances (nr_blocks);
+  offsets.assign (nr_queries + 1, 0);
+
+#pragma omp parallel \
+  default(none) \
+  shared(block_indices, block_size, block_sqr_distances, cloud, indices, max_nn, nr_blocks, nr_queries, offsets, radius) \
+  num_threads(threads)
+  {
+    // Scratch buffers, reused for all the queries of a thread
+    Indices nn_indices;
+    std::vector<float> nn_sqr_distances;
+
+#pragma omp for schedule(dynamic)
+    for (std::ptrdiff_t block = 0; block < nr_blocks; ++block)
+    {
+      const std::ptrdiff_t block_end = std::min ((block + 1) * block_size, nr_queries);
+      for (std::ptrdiff_t i = block * block_size; i < block_end; ++i)
+      {
+        const index_t query = indices.empty () ? static_cast<index_t> (i) : indices[i];
+        const int nr_found = radiusSearch (cloud, query, radius, nn_indices, nn_sqr_distances, max_nn);
+        if (nr_found <= 0)
+          continue;
+        block_indices[block].insert (block_indices[block].end (), nn_indices.begin (), nn_indices.begin () + nr_found);
+        block_sqr_distances[block].insert (block_sqr_distances[block].end (), nn_sqr_distances.begin (), nn_sqr_distances.begin () + nr_found);
+        offsets[i + 1] = static_cast<std::size_t> (nr_found);
+      }
+    }
+  }
+
+  // Turn the counts into offsets, then gather the blocks
+  std::vector<std::size_t> block_begin (nr_blocks, 0);
+  for (std::ptrdiff_t i = 0; i < nr_queries; ++i)
+  {
+    if (i % block_size == 0)
+      block_begin[i / block_size] = offsets[i];
+    offsets[i + 1] += offsets[i];
+  }
+  k_indices.resize (offsets.back ());
+  k_sqr_distances.resize (offsets.back ());
+
+#pragma omp parallel for \
+  default(none) \
+  shared(block_begin, block_indices, block_sqr_distances, k_indices, k_sqr_distances, nr_blocks) \
+  num_threads(threads)
+  for (std::ptrdiff_t block = 0; block < nr_blocks; ++block)
+  {
+    std::copy (block_indices[block].begin (), block_indices[block].end (), k_indices.begin () + block_begin[block]);
+    std::copy (block_sqr_distances[block].begin (), block_sqr_distances[block].end (), k_sqr_distances.begin () + block_begin[block]);
+  }
+}
+
 ///////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointT> void
 pcl::search::Search<PointT>::sortResults (
@@ -0,0 +1,352 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#pragma once
+
+#include <pcl/search/search.h>
+
+#include <Eigen/Core>
+
+namespace pcl
+{
+  namespace search
+  {
+    /** \brief @b search::IncrementalKdTree is a dynamic k-d tree (in the spirit of ikd-Tree)
+      * that supports inserting and deleting points without rebuilding the whole tree.
+      *
+      * Every node holds one point and the bounding box of the valid points of its
+      * subtree. Deletions are lazy: points are only marked as removed, and whole
+      * subtrees contained in a deletion box are flagged in O(1). A subtree is rebuilt
+      * into a balanced one as soon as one of its children holds more than a fraction
+      * \a alpha_balance of its nodes, or more than a fraction \a alpha_delete of its
+      * nodes are deleted. This keeps the cost of the updates proportional to the
+      * points that change, instead of the size of the map.
+      *
+      * The points are stored inside the tree: the returned indices refer to the cloud
+      * given by \ref getInputCloud, which initially is a copy of the cloud passed to
+      * \ref setInputCloud. The storage of deleted points is reused by later
+      * insertions, so indices are only valid until the next modification of the tree.
+      *
+      * \note Points with non-finite x, y or z coordinates are never inserted, and query
+      * points are assumed to be finite.
+      * \ingroup search
+      */
+    template<typename PointT>
+    class IncrementalKdTree: public Search<PointT>
+    {
+      public:
+        using PointCloud = typename Search<PointT>::PointCloud;
+        using PointCloudPtr = typename PointCloud::Ptr;
+        using PointCloudConstPtr = typename Search<PointT>::PointCloudConstPtr;
+
+        using pcl::search::Search<PointT>::indices_;
+        using pcl::search::Search<PointT>::input_;
+        using pcl::search::Search<PointT>::nearestKSearch;
+        using pcl::search::Search<PointT>::radiusSearch;
+        using pcl::search::Search<PointT>::sorted_results_;
+
+        using Ptr = shared_ptr<IncrementalKdTree<PointT> >;
+        using ConstPtr = shared_ptr<const IncrementalKdTree<PointT> >;
+
+        /** \brief Constructor for IncrementalKdTree.
+          * \param[in] sorted set to true if the radius search results need to be sorted in
+          * ascending order based on their distance to the query point
+          */
+        IncrementalKdTree (bool sorted = true);
+
+        /** \brief Destructor for IncrementalKdTree. */
+        ~IncrementalKdTree () override = default;
+
+        /** \brief Set the fraction of the nodes of a subtree that one of its children may hold
+          * before the subtree is rebuilt (default 0.7).
+          * \param[in] alpha_balance the balance criterion, in (0.5, 1)
+          */
+        inline void
+        setBalanceCriterion (float alpha_balance)
+        {
+          alpha_balance_ = alpha_balance;
+        }
+
+        /** \brief Get the balance criterion. */
+        inline float
+        getBalanceCriterion () const
+        {
+          return (alpha_balance_);
+        }
+
+        /** \brief Set the fraction of deleted nodes that a subtree may hold before it is
+          * rebuilt (default 0.5).
+          * \param[in] alpha_delete the deletion criterion, in (0, 1)
+          */
+        inline void
+        setDeleteCriterion (float alpha_delete)
+        {
+          alpha_delete_ = alpha_delete;
+        }
+
+        /** \brief Get the deletion criterion. */
+        inline float
+        getDeleteCriterion () const
+        {
+          return (alpha_delete_);
+        }
+
+        /** \brief Enable or disable downsampling of the points given to \ref addPoints.
+          *
+          * If enabled, space is divided in voxels of \ref setDownsampleLeafSize, and each
+          * voxel keeps at most one point: a new point is only inserted if it is closer to
+          * the voxel center than the points already in the tree, which are then deleted.
+          * \param[in] downsample_on_insert true to downsample on insertion
+          */
+        inline void
+        setDownsampleOnInsert (bool downsample_on_insert)
+        {
+          downsample_on_insert_ = downsample_on_insert;
+        }
+
+        /** \brief Get whether the points given to \ref addPoints are downsampled. */
+        inline bool
+        getDownsampleOnInsert () const
+        {
+          return (downsample_on_insert_);
+        }
+
+        /** \brief Set the voxel size used when downsampling on insertion.
+          * \param[in] leaf_size the voxel edge length
+          */
+        inline void
+        setDownsampleLeafSize (float leaf_size)
+        {
+          downsample_leaf_size_ = leaf_size;
+        }
+
+        /** \brief Get the voxel size used when downsampling on insertion. */
+        inline float
+        getDownsampleLeafSize () const
+        {
+          return (downsample_leaf_size_);
+        }
+
+        /** \brief Provide a pointer to the input dataset and build a balanced tree from it.
+          * \param[in] cloud the const boost shared pointer to a PointCloud message
+          * \param[in] indices the point indices subset that is to be used from \a cloud
+          */
+        void
+        setInputCloud (const PointCloudConstPtr& cloud,
+                       const IndicesConstPtr& indices = IndicesConstPtr ()) override;
+
+        /** \brief Insert points into the tree, downsampling them if enabled with
+          * \ref setDownsampleOnInsert.
+          * \param[in] cloud the points to insert
+          * \return the number of points inserted
+          */
+        std::size_t
+        addPoints (const PointCloud &cloud);
+
+        /** \brief Delete all the points inside an axis-aligned box.
+          * \param[in] min_pt the minimum corner of the box
+          * \param[in] max_pt the maximum corner of the box
+          * \return the number of points deleted
+          */
+        std::size_t
+        deletePointsInBox (const Eigen::Vector3f &min_pt, const Eigen::Vector3f &max_pt);
+
+        /** \brief Search for all the points inside an axis-aligned box.
+          * \param[in] min_pt the minimum corner of the box
+          * \param[in] max_pt the maximum corner of the box
+          * \param[out] k_indices the indices of the points inside the box
+          * \return the number of points found
+          */
+        int
+        boxSearch (const Eigen::Vector3f &min_pt, const Eigen::Vector3f &max_pt, Indices &k_indices) const;
+
+        /** \brief Get the number of (non deleted) points in the tree. */
+        inline std::size_t
+        size () const
+        {
+          return (root_ < 0 ? 0 : nodes_[root_].size - nodes_[root_].invalid);
+        }
+
+        /** \brief Search for the k-nearest neighbors for the given query point.
+          * \param[in] point the given query point
+          * \param[in] k the number of neighbors to search for
+          * \param[out] k_indices the resultant indices of the neighboring points
+          * \param[out] k_sqr_distances the resultant squared distances to the neighboring points
+          * \return number of neighbors found
+          */
+        int
+        nearestKSearch (const PointT &point, int k, Indices &k_indices,
+                        std::vector<float> &k_sqr_distances) const override;
+
+        /** \brief Search for all the nearest neighbors of the query point in a given radius.
+          * \param[in] point the given query point
+          * \param[in] radius the radius of the sphere bounding all of p_q's neighbors
+          * \param[out] k_indices the resultant indices of the neighboring points
+          * \param[out] k_sqr_distances the resultant squared distances to the neighboring points
+          * \param[in] max_nn if given, bounds the maximum returned neighbors to this value. If \a max_nn is set to
+          * 0 or to a number higher than the number of points in the tree, all neighbors in \a radius will be
+          * returned.
+          * \return number of neighbors found in radius
+          */
+        int
+        radiusSearch (const PointT& point, double radius, Indices &k_indices,
+                      std::vector<float> &k_sqr_distances,
+                      unsigned int max_nn = 0) const override;
+
+      protected:
+        /** \brief A node of the tree, holding one point. */
+        struct Node
+        {
+          /** \brief Index of the point in \a points_. */
+          index_t point;
+          int left;
+          int right;
+          /** \brief The axis used to split the subtree. */
+          int dim;
+          /** \brief Number of nodes in the subtree, including deleted ones. */
+          int size;
+          /** \brief Number of deleted nodes in the subtree. */
+          int invalid;
+          /** \brief Whether the point of this node is deleted. */
+          bool deleted;
+          /** \brief Whether the whole subtree is deleted; not yet propagated to the children. */
+          bool tree_deleted;
+          /** \brief Bounding box of the non deleted points of the subtree. */
+          float min_pt[3];
+          float max_pt[3];
+        };
+
+        /** \brief Result set keeping the closest neighbors within a radius, sorted by distance. */
+        struct KnnResultSet;
+
+        /** \brief Get a free node holding the point at index \a point. */
+        int
+        allocateNode (index_t point);
+
+        /** \brief Store a point, reusing the storage of a deleted one if possible. */
+        index_t
+        allocatePoint (const PointT &point);
+
+        /** \brief Insert a single point, rebuilding unbalanced subtrees on the way back. */
+        void
+        insertPoint (const PointT &point);
+
+        /** \brief Insert the node \a new_node into the subtree rooted at \a node_idx. */
+        void
+        insertNode (int &node_idx, int new_node);
+
+        /** \brief Delete the points of the subtree rooted at \a node_idx that are inside a box.
+          * \return the number of deleted points
+          */
+        std::size_t
+        deleteBox (int &node_idx, const float *min_pt, const float *max_pt);
+
+        /** \brief Recompute size, deletion count and bounding box of a node from its children. */
+        void
+        pushUp (int node_idx);
+
+        /** \brief Propagate a pending subtree deletion to the children of a node. */
+        void
+        pushDown (int node_idx);
+
+        /** \brief Mark a whole subtree as deleted. */
+        void
+        markTreeDeleted (int node_idx);
+
+        /** \brief Rebuild the subtree rooted at \a node_idx if it is unbalanced or has too many deleted nodes. */
+        void
+        rebalance (int &node_idx);
+
+        /** \brief Free all the nodes of a subtree, collecting the points that are not deleted. */
+        void
+        flatten (int node_idx, Indices &points);
+
+        /** \brief Build a balanced subtree from the points in [begin, end) of \a points.
+          * \return the root of the subtree, or -1 if empty
+          */
+        int
+        build (Indices &points, std::size_t begin, std::size_t end);
+
+        /** \brief Squared distance from a query to the bounding box of a node. */
+        float
+        getBoxDistance (int node_idx, const float *query) const;
+
+        template <typename ResultSet> void
+        searchKnn (int node_idx, const float *query, ResultSet &result) const;
+
+        void
+        searchRadius (int node_idx, const float *query, float radius_sqr,
+                      Indices &k_indices, std::vector<float> &k_sqr_distances) const;
+
+        void
+        searchBox (int node_idx, const float *min_pt, const float *max_pt, Indices &k_indices) const;
+
+        /** \brief Add all the points of a subtree without any deleted node. */
+        void
+        collectSubtree (int node_idx, const float *query, Indices &k_indices,
+                        std::vector<float> &k_sqr_distances) const;
+
+        /** \brief The point storage, shared as the input cloud of the search. */
+        PointCloudPtr points_;
+
+        /** \brief Slots of \a points_ that can be reused by new points. */
+        Indices free_points_;
+
+        /** \brief The node pool. */
+        std::vector<Node> nodes_;
+
+        /** \brief Nodes of \a nodes_ that can be reused. */
+        std::vector<int> free_nodes_;
+
+        /** \brief The root of the tree, or -1 if empty. */
+        int root_ = -1;
+
+        float alpha_balance_ = 0.7f;
+        float alpha_delete_ = 0.5f;
+
+        /** \brief Subtrees smaller than this are never rebuilt. */
+        int min_rebuild_size_ = 16;
+
+        bool downsample_on_insert_ = false;
+        float downsample_leaf_size_ = 0.1f;
+    };
+  }
+}
+
+#ifdef PCL_NO_PRECOMPILE
+#include <pcl/search/impl/incremental_kdtree.hpp>
+#endif
@@ -126,6 +126,13 @@ namespace pcl
           return (tree_->getEpsilon ());
         }
 
+        /** \brief Get the memory held by the underlying kd-tree, see KdTreeFLANN::getMemoryUsage. */
+        inline std::size_t
+        getMemoryUsage () const
+        {
+          return (tree_->getMemoryUsage ());
+        }
+
         /** \brief Provide a pointer to the input dataset.
           * \param[in] cloud the const boost shared pointer to a PointCloud message
           * \param[in] indices the point indices subset that is to be used from \a cloud 
@@ -0,0 +1,217 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#pragma once
+
+#include <pcl/search/search.h>
+
+#include <algorithm>
+
+namespace pcl
+{
+  namespace search
+  {
+    /** \brief @b search::KdTree3D is a k-d tree specialized at compile time for 3D
+      * Euclidean search on the x, y and z coordinates of a point type.
+      *
+      * Unlike search::KdTree, which goes through FLANN's runtime-dimension index and a
+      * PointRepresentation, the tree stores the coordinates of every leaf in contiguous
+      * structure-of-arrays buckets, so that leaf distances can be computed several points
+      * at a time (with SSE if available). Inner nodes keep the extent of both children
+      * along the split axis, which allows tight incremental distance bounds during the
+      * descent. The tree is static: it is rebuilt on every call to \ref setInputCloud.
+      *
+      * \note Points with non-finite x, y or z coordinates are skipped when building the
+      * tree, and query points are assumed to be finite.
+      * \ingroup search
+      */
+    template<typename PointT>
+    class KdTree3D: public Search<PointT>
+    {
+      public:
+        using PointCloud = typename Search<PointT>::PointCloud;
+        using PointCloudConstPtr = typename Search<PointT>::PointCloudConstPtr;
+
+        using pcl::search::Search<PointT>::indices_;
+        using pcl::search::Search<PointT>::input_;
+        using pcl::search::Search<PointT>::nearestKSearch;
+        using pcl::search::Search<PointT>::radiusSearch;
+        using pcl::search::Search<PointT>::sorted_results_;
+
+        using Ptr = shared_ptr<KdTree3D<PointT> >;
+        using ConstPtr = shared_ptr<const KdTree3D<PointT> >;
+
+        /** \brief Constructor for KdTree3D.
+          * \param[in] sorted set to true if the radius search results need to be sorted in
+          * ascending order based on their distance to the query point
+          * \param[in] max_leaf_size the maximum number of points stored in a leaf
+          */
+        KdTree3D (bool sorted = true, int max_leaf_size = 16)
+        : Search<PointT> ("KdTree3D", sorted)
+        , max_leaf_size_ (std::max (max_leaf_size, 1))
+        {
+        }
+
+        /** \brief Destructor for KdTree3D. */
+        ~KdTree3D () override = default;
+
+        /** \brief Set the maximum number of points stored in a leaf. Takes effect on the
+          * next call to \ref setInputCloud.
+          * \param[in] max_leaf_size the maximum number of points per leaf
+          */
+        inline void
+        setMaxLeafSize (int max_leaf_size)
+        {
+          max_leaf_size_ = std::max (max_leaf_size, 1);
+        }
+
+        /** \brief Get the maximum number of points stored in a leaf. */
+        inline int
+        getMaxLeafSize () const
+        {
+          return (max_leaf_size_);
+        }
+
+        /** \brief Provide a pointer to the input dataset and build the tree.
+          * \param[in] cloud the const boost shared pointer to a PointCloud message
+          * \param[in] indices the point indices subset that is to be used from \a cloud
+          */
+        void
+        setInputCloud (const PointCloudConstPtr& cloud,
+                       const IndicesConstPtr& indices = IndicesConstPtr ()) override;
+
+        /** \brief Search for the k-nearest neighbors for the given query point.
+          * \param[in] point the given query point
+          * \param[in] k the number of neighbors to search for
+          * \param[out] k_indices the resultant indices of the neighboring points
+          * \param[out] k_sqr_distances the resultant squared distances to the neighboring points
+          * \return number of neighbors found
+          */
+        int
+        nearestKSearch (const PointT &point, int k, Indices &k_indices,
+                        std::vector<float> &k_sqr_distances) const override;
+
+        /** \brief Search for all the nearest neighbors of the query point in a given radius.
+          * \param[in] point the given query point
+          * \param[in] radius the radius of the sphere bounding all of p_q's neighbors
+          * \param[out] k_indices the resultant indices of the neighboring points
+          * \param[out] k_sqr_distances the resultant squared distances to the neighboring points
+          * \param[in] max_nn if given, bounds the maximum returned neighbors to this value. If \a max_nn is set to
+          * 0 or to a number higher than the number of points in the input cloud, all neighbors in \a radius will be
+          * returned.
+          * \return number of neighbors found in radius
+          */
+        int
+        radiusSearch (const PointT& point, double radius, Indices &k_indices,
+                      std::vector<float> &k_sqr_distances,
+                      unsigned int max_nn = 0) const override;
+
+      protected:
+        /** \brief A node of the tree. Leaves have \a dim set to -1 and refer to the
+          * range [begin, end) of the leaf buckets; inner nodes store their left child
+          * right after themselves and the right child at \a right.
+          */
+        struct Node
+        {
+          int dim;
+          /** \brief Largest coordinate of the left child along \a dim. */
+          float low;
+          /** \brief Smallest coordinate of the right child along \a dim. */
+          float high;
+          uindex_t begin;
+          uindex_t end;
+          uindex_t right;
+        };
+
+        /** \brief Fixed capacity result set keeping the closest neighbors, sorted by distance. */
+        struct KnnResultSet;
+
+        /** \brief Unbounded result set collecting all neighbors within a radius. */
+        struct RadiusResultSet;
+
+        /** \brief Recursively build the subtree for the points in [begin, end) of \a build_indices.
+          * \return the index of the subtree root in \a nodes_
+          */
+        uindex_t
+        buildNode (Indices &build_indices, std::size_t begin, std::size_t end);
+
+        /** \brief Test all points of a leaf against the query and add them to the result set. */
+        template <typename ResultSet> void
+        searchLeaf (const Node &node, const float *query, ResultSet &result) const;
+
+        /** \brief Recursively descend the tree, visiting the closer child first.
+          * \param[in] node_idx the node to search
+          * \param[in] query the query coordinates
+          * \param[in] min_dist_sqr a lower bound on the squared distance from the query to the node
+          * \param[in,out] dists the per-axis contributions to \a min_dist_sqr
+          * \param[in,out] result the result set
+          */
+        template <typename ResultSet> void
+        searchLevel (uindex_t node_idx, const float *query, float min_dist_sqr, float *dists,
+                     ResultSet &result) const;
+
+        /** \brief Squared distance from the query to the bounding box of the whole tree,
+          * with its per-axis contributions written to \a dists.
+          */
+        float
+        getInitialDistances (const float *query, float *dists) const;
+
+        /** \brief The maximum number of points per leaf. */
+        int max_leaf_size_;
+
+        /** \brief The tree nodes, the root being the first one. */
+        std::vector<Node> nodes_;
+
+        /** \brief Leaf bucket coordinates, each leaf padded to a multiple of 4 points. */
+        std::vector<float> x_, y_, z_;
+
+        /** \brief Point indices corresponding to the leaf bucket entries. */
+        Indices bucket_indices_;
+
+        /** \brief Bounding box of the indexed points. */
+        float min_pt_[3];
+        float max_pt_[3];
+
+        /** \brief The number of points in the tree. */
+        std::size_t nr_points_ = 0;
+    };
+  }
+}
+
+#ifdef PCL_NO_PRECOMPILE
+#include <pcl/search/impl/kdtree_3d.hpp>
+#endif
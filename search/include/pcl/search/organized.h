@@ -53,6 +53,12 @@ namespace pcl
   namespace search
   {
     /** \brief OrganizedNeighbor is a class for optimized nearest neigbhor search in organized point clouds.
+      *
+      * The projection matrix of the sensor is estimated from every input cloud, unless it was given with
+      * \ref setProjectionMatrix or \ref setCameraIntrinsics. k-nearest neighbor queries walk rings of pixels
+      * around the query pixel and keep the candidates sorted in the output vectors, so no memory is allocated
+      * when these are reused. Queries by index into the input cloud start at the pixel of the query point,
+      * which makes the batched nearestKSearch of pcl::search::Search over all pixels of a frame cheap.
       * \author Radu B. Rusu, Julius Kammerl, Suat Gedikli, Koen Buys
       * \ingroup search
       */
@@ -72,6 +78,8 @@ namespace pcl
 
         using pcl::search::Search<PointT>::indices_;
         using pcl::search::Search<PointT>::sorted_results_;
+        using pcl::search::Search<PointT>::nearestKSearch;
+        using pcl::search::Search<PointT>::radiusSearch;
         using pcl::search::Search<PointT>::input_;
 
         /** \brief Constructor
@@ -89,6 +97,7 @@ namespace pcl
           , KR_KRT_ (Eigen::Matrix<float, 3, 3, Eigen::RowMajor>::Zero ())
           , eps_ (eps)
           , pyramid_level_ (pyramid_level)
+          , fixed_projection_ (false)
         {
         }
 
@@ -139,7 +148,55 @@ namespace pcl
           else
             mask_.assign (input_->size (), 1);
 
-          estimateProjectionMatrix ();
+          if (!fixed_projection_)
+            estimateProjectionMatrix ();
+        }
+
+        /** \brief Set the projection matrix of the sensor, which is then used for all input clouds instead of
+          * estimating it in \ref setInputCloud.
+          * \param[in] projection_matrix the projection matrix K * [R | t] from the frame of the input clouds to pixels
+          */
+        void
+        setProjectionMatrix (const Eigen::Matrix<float, 3, 4, Eigen::RowMajor>& projection_matrix)
+        {
+          projection_matrix_ = projection_matrix;
+          KR_ = projection_matrix_.topLeftCorner <3, 3> ();
+          KR_KRT_ = KR_ * KR_.transpose ();
+          fixed_projection_ = true;
+        }
+
+        /** \brief Set the intrinsics of the camera the input clouds are given in, which is then used for all input
+          * clouds instead of estimating the projection matrix in \ref setInputCloud.
+          * \param[in] focal_length_x the horizontal focal length in pixels
+          * \param[in] focal_length_y the vertical focal length in pixels
+          * \param[in] principal_point_x the column of the principal point
+          * \param[in] principal_point_y the row of the principal point
+          */
+        void
+        setCameraIntrinsics (float focal_length_x, float focal_length_y,
+                             float principal_point_x, float principal_point_y)
+        {
+          Eigen::Matrix<float, 3, 4, Eigen::RowMajor> projection_matrix;
+          projection_matrix << focal_length_x, 0.f, principal_point_x, 0.f,
+                               0.f, focal_length_y, principal_point_y, 0.f,
+                               0.f, 0.f, 1.f, 0.f;
+          setProjectionMatrix (projection_matrix);
+        }
+
+        /** \brief Estimate the projection matrix from each input cloud again, after it was given with
+          * \ref setProjectionMatrix or \ref setCameraIntrinsics.
+          */
+        void
+        resetProjectionMatrix ()
+        {
+          fixed_projection_ = false;
+        }
+
+        /** \brief Get the projection matrix, either given by the user or estimated from the last input cloud. */
+        inline const Eigen::Matrix<float, 3, 4, Eigen::RowMajor>&
+        getProjectionMatrix () const
+        {
+          return (projection_matrix_);
         }
 
         /** \brief Search for all neighbors of query point that are within a given radius.
@@ -178,6 +235,33 @@ namespace pcl
                         Indices &k_indices,
                         std::vector<float> &k_sqr_distances) const override;
 
+        /** \brief Search for the k-nearest neighbors of a point of a cloud. If \a cloud is the input cloud, the
+          * search starts at the pixel of the query point instead of its projection.
+          * \param[in] cloud the point cloud data
+          * \param[in] index a \a valid index in \a cloud representing a \a valid (i.e., finite) query point
+          * \param[in] k the number of neighbors to search for
+          * \param[out] k_indices the resultant point indices
+          * \param[out] k_sqr_distances the resultant squared distances to the neighboring points
+          * \return number of neighbors found
+          */
+        int
+        nearestKSearch (const PointCloud &cloud, index_t index, int k,
+                        Indices &k_indices,
+                        std::vector<float> &k_sqr_distances) const override;
+
+        /** \brief Search for the k-nearest neighbors of a point of the input cloud, starting at its pixel.
+          * \param[in] index a \a valid index representing a \a valid query point in the input cloud. If indices
+          * were given in setInputCloud, index will be the position in the indices vector.
+          * \param[in] k the number of neighbors to search for
+          * \param[out] k_indices the resultant point indices
+          * \param[out] k_sqr_distances the resultant squared distances to the neighboring points
+          * \return number of neighbors found
+          */
+        int
+        nearestKSearch (index_t index, int k,
+                        Indices &k_indices,
+                        std::vector<float> &k_sqr_distances) const override;
+
         /** \brief projects a point into the image
           * \param[in] p point in 3D World Coordinate Frame to be projected onto the image plane
           * \param[out] q the 2D projected point in pixel coordinates (u,v)
@@ -239,6 +323,56 @@ namespace pcl
           return false;
         }
 
+        /** \brief test if point given by index is among the k NN to the query point. The nr_found first entries of
+          * indices and sqr_distances are the NN found so far, sorted by distance.
+          * \param[in] query query point
+          * \param[in] k number of maximum nn interested in
+          * \param[in,out] indices the indices of the k NN, with room for k entries
+          * \param[in,out] sqr_distances the squared distances of the k NN, with room for k entries
+          * \param[in,out] nr_found the number of NN found so far
+          * \param[in] index index on point to be tested
+          * \return whether the top element changed or not.
+          */
+        inline bool
+        testPoint (const PointT& query, unsigned k, index_t* indices, float* sqr_distances,
+                   unsigned& nr_found, index_t index) const
+        {
+          const PointT& point = input_->points [index];
+          if (!mask_ [index] || !std::isfinite (point.x))
+            return false;
+
+          float dist_x = point.x - query.x;
+          float dist_y = point.y - query.y;
+          float dist_z = point.z - query.z;
+          float squared_distance = dist_x * dist_x + dist_y * dist_y + dist_z * dist_z;
+          if (nr_found == k && !(sqr_distances [k - 1] > squared_distance))
+            return false;
+
+          // shift the farther entries by one, dropping the last one if all k are taken
+          const unsigned end = (nr_found < k ? nr_found++ : k - 1);
+          const unsigned pos = static_cast<unsigned> (
+              std::upper_bound (sqr_distances, sqr_distances + end, squared_distance) - sqr_distances);
+          std::copy_backward (indices + pos, indices + end, indices + end + 1);
+          std::copy_backward (sqr_distances + pos, sqr_distances + end, sqr_distances + end + 1);
+          indices [pos] = index;
+          sqr_distances [pos] = squared_distance;
+          return (nr_found == k);
+        }
+
+        /** \brief Search for the k-nearest neighbors in growing rings of pixels around a start pixel.
+          * \param[in] query the query point
+          * \param[in] x the column of the start pixel, may lie outside of the image
+          * \param[in] y the row of the start pixel, may lie outside of the image
+          * \param[in] k the number of neighbors to search for
+          * \param[out] k_indices the resultant point indices
+          * \param[out] k_sqr_distances the resultant squared distances to the neighboring points
+          * \return number of neighbors found
+          */
+        int
+        nearestKSearchFromPixel (const PointT &query, int x, int y, int k,
+                                 Indices &k_indices,
+                                 std::vector<float> &k_sqr_distances) const;
+
         inline void
         clipRange (int& begin, int &end, int min, int max) const
         {
@@ -276,6 +410,9 @@ namespace pcl
         
         /** \brief mask, indicating whether the point was in the indices list or not.*/
         std::vector<unsigned char> mask_;
+
+        /** \brief whether projection_matrix_ was given by the user and is not estimated from the input clouds.*/
+        bool fixed_projection_;
       public:
         PCL_MAKE_ALIGNED_OPERATOR_NEW
     };
@@ -219,6 +219,27 @@ namespace pcl
                         int k, std::vector<Indices>& k_indices,
                         std::vector< std::vector<float> >& k_sqr_distances) const;
 
+        /** \brief Search for the k-nearest neighbors of many query points in parallel.
+          *
+          * The results are written into flat buffers (CSR layout), so that no container is allocated per query:
+          * the neighbors of the query point i are stored in k_indices and k_sqr_distances in the range
+          * [offsets[i]; offsets[i+1]).
+          *
+          * \attention The single point \a nearestKSearch of the search method is called concurrently from several threads.
+          *
+          * \param[in] cloud the point cloud data
+          * \param[in] indices a vector of point cloud indices to query for nearest neighbors. If indices is empty, neighbors will be searched for all points.
+          * \param[in] k the number of neighbors to search for
+          * \param[out] k_indices the resultant indices of the neighboring points of all the query points
+          * \param[out] k_sqr_distances the resultant squared distances to the neighboring points of all the query points
+          * \param[out] offsets the position of the first neighbor of each query point in \a k_indices, followed by the total number of neighbors
+          * \param[in] nr_threads the number of threads to use (0 takes as many as the budget of pcl::ExecutionContext allows)
+          */
+        virtual void
+        nearestKSearch (const PointCloud& cloud, const Indices& indices, int k,
+                        Indices& k_indices, std::vector<float>& k_sqr_distances,
+                        std::vector<std::size_t>& offsets, unsigned int nr_threads = 0) const;
+
         /** \brief Search for the k-nearest neighbors for the given query point. Use this method if the query points are of a different type than the points in the data set (e.g. PointXYZRGBA instead of PointXYZ).
           * \param[in] cloud the point cloud data
           * \param[in] indices a vector of point cloud indices to query for nearest neighbors
@@ -355,6 +376,35 @@ namespace pcl
                       std::vector< std::vector<float> > &k_sqr_distances,
                       unsigned int max_nn = 0) const;
 
+        /** \brief Search for all the nearest neighbors of many query points in a given radius, in parallel.
+          *
+          * The results are written into flat buffers (CSR layout), so that no container is allocated per query:
+          * the neighbors of the query point i are stored in k_indices and k_sqr_distances in the range
+          * [offsets[i]; offsets[i+1]).
+          *
+          * \attention The single point \a radiusSearch of the search method is called concurrently from several threads.
+          *
+          * \param[in] cloud the point cloud data
+          * \param[in] indices the indices in \a cloud. If indices is empty, neighbors will be searched for all points.
+          * \param[in] radius the radius of the sphere bounding all of p_q's neighbors
+          * \param[out] k_indices the resultant indices of the neighboring points of all the query points
+          * \param[out] k_sqr_distances the resultant squared distances to the neighboring points of all the query points
+          * \param[out] offsets the position of the first neighbor of each query point in \a k_indices, followed by the total number of neighbors
+          * \param[in] max_nn if given, bounds the maximum returned neighbors per query point to this value. If \a max_nn is set to
+          * 0 or to a number higher than the number of points in the input cloud, all neighbors in \a radius will be
+          * returned.
+          * \param[in] nr_threads the number of threads to use (0 takes as many as the budget of pcl::ExecutionContext allows)
+          */
+        virtual void
+        radiusSearch (const PointCloud& cloud,
+                      const Indices& indices,
+                      double radius,
+                      Indices& k_indices,
+                      std::vector<float>& k_sqr_distances,
+                      std::vector<std::size_t>& offsets,
+                      unsigned int max_nn = 0,
+                      unsigned int nr_threads = 0) const;
+
         /** \brief Search for all the nearest neighbors of the query points in a given radius.
           * \param[in] cloud the point cloud data
           * \param[in] indices a vector of point cloud indices to query for nearest neighbors
@@ -40,3 +40,5 @@
 
 // Instantiations of specific point types
 PCL_INSTANTIATE (BruteForce, PCL_XYZ_POINT_TYPES)
+// Descriptors are matched on their whole vector, see pcl::StaticPointRepresentation
+PCL_INSTANTIATE (BruteForce, (pcl::FPFHSignature33)(pcl::PFHSignature125)(pcl::VFHSignature308)(pcl::SHOT352)(pcl::SHOT1344))
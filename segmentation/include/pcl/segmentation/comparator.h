@@ -101,4 +101,32 @@ namespace pcl
     public:
       PCL_MAKE_ALIGNED_OPERATOR_NEW
   };
+
+  /** \brief ComparatorFunctor calls the compare method of a concrete comparator type without going through
+    * the virtual function table, so that the comparison can be inlined into the labeling loop of
+    * OrganizedConnectedComponentSegmentation::segment.
+    * \note The comparator has to be an instance of ComparatorT itself, the implementation of a class derived
+    * from ComparatorT would not be called.
+    */
+  template <typename ComparatorT>
+  class ComparatorFunctor
+  {
+    public:
+      /** \brief Constructor for ComparatorFunctor.
+        * \param[in] comparator the comparator to call, it has to outlive the functor
+        */
+      explicit ComparatorFunctor (const ComparatorT& comparator) : comparator_ (comparator)
+      {
+      }
+
+      /** \brief Compares the two points designated by these two indices with ComparatorT::compare. */
+      inline bool
+      operator () (int idx1, int idx2) const
+      {
+        return (comparator_.ComparatorT::compare (idx1, idx2));
+      }
+
+    private:
+      const ComparatorT& comparator_;
+  };
 }
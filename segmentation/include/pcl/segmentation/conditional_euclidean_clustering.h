@@ -104,7 +104,8 @@ namespace pcl
           max_cluster_size_ (std::numeric_limits<int>::max ()),
           extract_removed_clusters_ (extract_removed_clusters),
           small_clusters_ (new pcl::IndicesClusters),
-          large_clusters_ (new pcl::IndicesClusters)
+          large_clusters_ (new pcl::IndicesClusters),
+          threads_ (1)
       {
       }
 
@@ -206,6 +207,24 @@ namespace pcl
         return (max_cluster_size_);
       }
 
+      /** \brief Set the number of threads to use for the segmentation. With any other value than 1 the clusters
+        * are found with concurrent radius searches and a union-find, which merges two neighboring points
+        * whenever the condition holds for them. The condition function then has to be safe to call
+        * concurrently, and it has to be symmetric, i.e. give the same result for (a, b) and (b, a), for the
+        * clusters to be identical to the ones of the serial version. The indices of each cluster are sorted.
+        * \param[in] nr_threads the number of hardware threads to use (0 takes as many as the budget of
+        * pcl::ExecutionContext allows when segmenting)
+        */
+      void
+      setNumberOfThreads (unsigned int nr_threads = 0);
+
+      /** \brief Get the number of threads used for the segmentation. */
+      inline unsigned int
+      getNumberOfThreads () const
+      {
+        return (threads_);
+      }
+
       /** \brief Segment the input into separate clusters.
         * \details The input can be set using setInputCloud() and setIndices().
         * <br>
@@ -236,6 +255,13 @@ namespace pcl
       }
 
     private:
+      /** \brief Find the clusters with concurrent radius searches and a union-find, see setNumberOfThreads().
+        * \param[out] clusters the clusters within the size limits
+        * \param[in] threads the number of threads reserved for the searches
+        */
+      void
+      segmentConcurrently (IndicesClusters &clusters, unsigned int threads);
+
       /** \brief A pointer to the spatial search object */
       SearcherPtr searcher_;
 
@@ -260,6 +286,9 @@ namespace pcl
       /** \brief The resultant clusters that contain more than max_cluster_size points */
       pcl::IndicesClustersPtr large_clusters_;
 
+      /** \brief The number of threads the scheduler should use (default = 1) */
+      unsigned int threads_;
+
     public:
       PCL_MAKE_ALIGNED_OPERATOR_NEW
   };
@@ -84,6 +84,7 @@ namespace pcl
       using LCCP::concavity_tolerance_threshold_;
       using LCCP::seed_resolution_;
       using LCCP::supervoxels_set_;
+      using LCCP::threads_;
 
     public:
       CPCSegmentation ();
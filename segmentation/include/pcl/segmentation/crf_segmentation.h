@@ -91,6 +91,12 @@ namespace pcl
       void
       setNumberOfIterations (unsigned int n_iterations = 10) {n_iterations_ = n_iterations;};
 
+      /** \brief Set the number of threads used by the dense CRF.
+        * \param[in] nr_threads the number of hardware threads to use (0 sets the value back to automatic)
+        */
+      void
+      setNumberOfThreads (unsigned int nr_threads = 0) { threads_ = nr_threads; }
+
       /** \brief This method simply launches the segmentation algorithm */
       void
       segmentPoints (pcl::PointCloud<pcl::PointXYZRGBL> &output);
@@ -195,6 +201,9 @@ namespace pcl
       
       
       unsigned int n_iterations_;
+
+      /** \brief The number of threads used by the dense CRF, 0 for automatic. */
+      unsigned int threads_ = 0;
       
 
       /** \brief Contains normals of the points that will be segmented. */
@@ -37,7 +37,9 @@
 
 #pragma once
 
+#include <algorithm> // for std::min
 #include <cfloat> // for FLT_MAX
+#include <vector>
 
 #include <pcl/pcl_base.h>
 
@@ -67,6 +69,59 @@ namespace pcl
   template <typename PointT> bool 
   isXYPointIn2DXYPolygon (const PointT &point, const pcl::PointCloud<PointT> &polygon);
 
+  /** \brief Polygon in the XY plane, preprocessed for testing many points against it.
+    *
+    * The edges are sorted into a row of bins along X, each bin listing the edges whose X
+    * range overlaps it. A point is then only tested against the edges of its bin, instead
+    * of against every edge as in isXYPointIn2DXYPolygon(), with the same result. Const
+    * member functions can be called concurrently.
+    * \ingroup segmentation
+    */
+  template <typename PointT>
+  class XYPolygonEdgeGrid
+  {
+    public:
+      /** \brief Constructor, preprocesses the polygon.
+        * \param[in] polygon a polygon, only the X and Y coordinates are considered
+        */
+      explicit XYPolygonEdgeGrid (const pcl::PointCloud<PointT> &polygon);
+
+      /** \brief Check if a 2D point is inside the polygon, same as isXYPointIn2DXYPolygon().
+        * \param[in] x the X coordinate of the point
+        * \param[in] y the Y coordinate of the point
+        */
+      bool
+      isInside (double x, double y) const;
+
+      /** \brief Check if a 2D point (X and Y coordinates considered only!) is inside the polygon. */
+      inline bool
+      isInside (const PointT &point) const { return (isInside (point.x, point.y)); }
+
+    private:
+      /** \brief An edge, with the end point of smaller X first as in the crossing test. */
+      struct Edge
+      {
+        double x1, y1, x2, y2;
+      };
+
+      /** \brief Get the bin of an X coordinate within [min_x_, max_x_]. */
+      inline std::size_t
+      getBin (double x) const
+      {
+        return (std::min (static_cast<std::size_t> ((x - min_x_) * bin_scale_), bin_offsets_.size () - 2));
+      }
+
+      /** \brief The X extent of the polygon. */
+      double min_x_, max_x_;
+
+      /** \brief The number of bins per unit along X. */
+      double bin_scale_;
+
+      /** \brief The edges of bin i are bin_edges_[bin_offsets_[i]] to bin_edges_[bin_offsets_[i + 1] - 1]. */
+      std::vector<std::size_t> bin_offsets_;
+      std::vector<Edge> bin_edges_;
+  };
+
   ////////////////////////////////////////////////////////////////////////////////////////////
   /** \brief @b ExtractPolygonalPrismData uses a set of point indices that
     * represent a planar model, and together with a given height, generates a 3D
@@ -117,7 +172,7 @@ namespace pcl
       /** \brief Empty constructor. */
       ExtractPolygonalPrismData () : planar_hull_ (), min_pts_hull_ (3), 
                                      height_limit_min_ (0), height_limit_max_ (FLT_MAX),
-                                     vpx_ (0), vpy_ (0), vpz_ (0)
+                                     vpx_ (0), vpy_ (0), vpz_ (0), threads_ (1)
       {};
 
       /** \brief Provide a pointer to the input planar hull dataset.
@@ -178,6 +233,16 @@ namespace pcl
         vpz = vpz_;
       }
 
+      /** \brief Set the number of threads used to test the points against the prism.
+        * \param[in] nr_threads the number of hardware threads to use (0 sets the value automatically)
+        */
+      void
+      setNumberOfThreads (unsigned int nr_threads = 0);
+
+      /** \brief Get the number of threads used to test the points against the prism. */
+      unsigned int
+      getNumberOfThreads () const { return (threads_); }
+
       /** \brief Cluster extraction in a PointCloud given by <setInputCloud (), setIndices ()>
         * \param[out] output the resultant point indices that support the model found (inliers)
         */
@@ -204,6 +269,9 @@ namespace pcl
       /** \brief Values describing the data acquisition viewpoint. Default: 0,0,0. */
       float vpx_, vpy_, vpz_;
 
+      /** \brief The number of threads the scheduler should use. */
+      unsigned int threads_;
+
       /** \brief Class getName method. */
       virtual std::string 
       getClassName () const { return ("ExtractPolygonalPrismData"); }
@@ -40,6 +40,7 @@
 #define PCL_SEGMENTATION_APPROXIMATE_PROGRESSIVE_MORPHOLOGICAL_FILTER_HPP_
 
 #include <pcl/common/common.h>
+#include <pcl/common/execution_context.h>
 #include <pcl/common/io.h>
 #include <pcl/filters/morphological_filter.h>
 #include <pcl/filters/extract_indices.h>
@@ -119,16 +120,15 @@ pcl::ApproximateProgressiveMorphologicalFilter<PointT>::extract (Indices& ground
   Eigen::MatrixXf A (rows, cols);
   A.setConstant (std::numeric_limits<float>::quiet_NaN ());
 
-  Eigen::MatrixXf Z (rows, cols);
-  Z.setConstant (std::numeric_limits<float>::quiet_NaN ());
-
   Eigen::MatrixXf Zf (rows, cols);
   Zf.setConstant (std::numeric_limits<float>::quiet_NaN ());
 
+  const pcl::ThreadReservation reservation (threads_);
+  const unsigned int threads = reservation.getNumberOfThreads ();
 #pragma omp parallel for \
   default(none) \
   shared(A, global_min) \
-  num_threads(threads_)
+  num_threads(threads)
   for (int i = 0; i < (int)input_->size (); ++i)
   {
     // ...then test for lower points within the cell
@@ -157,75 +157,7 @@ pcl::ApproximateProgressiveMorphologicalFilter<PointT>::extract (Indices& ground
     pcl::copyPointCloud<PointT> (*input_, ground, *cloud);
 
     // Apply the morphological opening operation at the current window size.
-#pragma omp parallel for \
-  default(none) \
-  shared(A, cols, half_sizes, i, rows, Z) \
-  num_threads(threads_)
-    for (int row = 0; row < rows; ++row)
-    {
-      int rs, re;
-      rs = ((row - half_sizes[i]) < 0) ? 0 : row - half_sizes[i];
-      re = ((row + half_sizes[i]) > (rows-1)) ? (rows-1) : row + half_sizes[i];
-
-      for (int col = 0; col < cols; ++col)
-      {
-        int cs, ce;
-        cs = ((col - half_sizes[i]) < 0) ? 0 : col - half_sizes[i];
-        ce = ((col + half_sizes[i]) > (cols-1)) ? (cols-1) : col + half_sizes[i];
-
-        float min_coeff = std::numeric_limits<float>::max ();
-
-        for (int j = rs; j < (re + 1); ++j)
-        {
-          for (int k = cs; k < (ce + 1); ++k)
-          {
-            if (A (j, k) != std::numeric_limits<float>::quiet_NaN ())
-            {
-              if (A (j, k) < min_coeff)
-                min_coeff = A (j, k);
-            }
-          }
-        }
-
-        if (min_coeff != std::numeric_limits<float>::max ())
-          Z(row, col) = min_coeff;
-      }
-    }
-
-#pragma omp parallel for \
-  default(none) \
-  shared(cols, half_sizes, i, rows, Z, Zf) \
-  num_threads(threads_)
-    for (int row = 0; row < rows; ++row)
-    {
-      int rs, re;
-      rs = ((row - half_sizes[i]) < 0) ? 0 : row - half_sizes[i];
-      re = ((row + half_sizes[i]) > (rows-1)) ? (rows-1) : row + half_sizes[i];
-
-      for (int col = 0; col < cols; ++col)
-      {
-        int cs, ce;
-        cs = ((col - half_sizes[i]) < 0) ? 0 : col - half_sizes[i];
-        ce = ((col + half_sizes[i]) > (cols-1)) ? (cols-1) : col + half_sizes[i];
-
-        float max_coeff = -std::numeric_limits<float>::max ();
-
-        for (int j = rs; j < (re + 1); ++j)
-        {
-          for (int k = cs; k < (ce + 1); ++k)
-          {
-            if (Z (j, k) != std::numeric_limits<float>::quiet_NaN ())
-            {
-              if (Z (j, k) > max_coeff)
-                max_coeff = Z (j, k);
-            }
-          }
-        }
-
-        if (max_coeff != -std::numeric_limits<float>::max ())
-          Zf (row, col) = max_coeff;
-      }
-    }
+    pcl::applyMorphologicalOperator (A, half_sizes[i], MORPH_OPEN, Zf);
 
     // Find indices of the points whose difference between the source and
     // filtered point clouds is less than the current height threshold.
@@ -38,9 +38,20 @@
 #define PCL_SEGMENTATION_IMPL_CONDITIONAL_EUCLIDEAN_CLUSTERING_HPP_
 
 #include <pcl/segmentation/conditional_euclidean_clustering.h>
+#include <pcl/common/execution_context.h>
 #include <pcl/search/organized.h> // for OrganizedNeighbor
 #include <pcl/search/kdtree.h> // for KdTree
 
+#include <algorithm>
+#include <atomic>
+
+template<typename PointT> void
+pcl::ConditionalEuclideanClustering<PointT>::setNumberOfThreads (unsigned int nr_threads)
+{
+  // 0 is resolved against the budget of pcl::ExecutionContext at compute time
+  threads_ = nr_threads;
+}
+
 template<typename PointT> void
 pcl::ConditionalEuclideanClustering<PointT>::segment (pcl::IndicesClusters &clusters)
 {
@@ -66,6 +77,16 @@ pcl::ConditionalEuclideanClustering<PointT>::segment (pcl::IndicesClusters &clus
   }
   searcher_->setInputCloud (input_, indices_);
 
+  // The union-find is chosen by the requested number of threads, not by the reserved one, so that the output
+  // does not depend on the load of the budget
+  if (threads_ != 1)
+  {
+    const pcl::ThreadReservation reservation (threads_);
+    segmentConcurrently (clusters, reservation.getNumberOfThreads ());
+    deinitCompute ();
+    return;
+  }
+
   // Temp variables used by search class
   Indices nn_indices;
   std::vector<float> nn_distances;
@@ -140,6 +161,115 @@ pcl::ConditionalEuclideanClustering<PointT>::segment (pcl::IndicesClusters &clus
   deinitCompute ();
 }
 
+template<typename PointT> void
+pcl::ConditionalEuclideanClustering<PointT>::segmentConcurrently (pcl::IndicesClusters &clusters, unsigned int threads)
+{
+  // Disjoint set forest over the cloud indices, as in extractEuclideanClusters. Every root is the smallest index
+  // of its set, so linking a root only ever lowers parent values, and concurrent unions need a single
+  // compare-and-swap.
+  std::vector<std::atomic<index_t>> parent (input_->size ());
+  for (std::size_t i = 0; i < parent.size (); ++i)
+    parent[i].store (static_cast<index_t> (i), std::memory_order_relaxed);
+
+  const auto find_root = [&parent] (index_t x)
+  {
+    index_t p = parent[x].load (std::memory_order_relaxed);
+    while (p != x)
+    {
+      // Path halving: point x to its grandparent on the way up
+      const index_t gp = parent[p].load (std::memory_order_relaxed);
+      if (gp != p)
+        parent[x].compare_exchange_weak (p, gp, std::memory_order_relaxed);
+      x = gp;
+      p = parent[x].load (std::memory_order_relaxed);
+    }
+    return (x);
+  };
+
+  const auto unite = [&parent, &find_root] (index_t a, index_t b)
+  {
+    while (true)
+    {
+      a = find_root (a);
+      b = find_root (b);
+      if (a == b)
+        return;
+      if (a < b)
+        std::swap (a, b);
+      // Link the larger root below the smaller one, unless another thread changed it in the meantime
+      index_t expected = a;
+      if (parent[a].compare_exchange_strong (expected, b, std::memory_order_relaxed))
+        return;
+    }
+  };
+
+  // Concurrent radius searches, neighbors for which the condition holds are merged into the same set. Pairs that
+  // are already in the same set are skipped, which saves most of the condition evaluations.
+  const auto &cloud = *input_;
+  const auto &indices = *indices_;
+  const auto &searcher = searcher_;
+  const auto &condition = condition_function_;
+  const float tolerance = cluster_tolerance_;
+  const std::ptrdiff_t nr_indices = static_cast<std::ptrdiff_t> (indices.size ());
+  Indices nn_indices;
+  std::vector<float> nn_distances;
+#pragma omp parallel for \
+  default(none) \
+  shared(cloud, indices, searcher, condition, find_root, unite) \
+  firstprivate(nr_indices, tolerance, nn_indices, nn_distances) \
+  num_threads(threads) \
+  schedule(dynamic, 256)
+  for (std::ptrdiff_t i = 0; i < nr_indices; ++i)
+  {
+    const index_t index = indices[i];
+    if (index == UNAVAILABLE ||
+        searcher->radiusSearch (cloud[index], tolerance, nn_indices, nn_distances) < 1)
+      continue;
+    for (std::size_t nii = 0; nii < nn_indices.size (); ++nii)  // nii = neighbor indices iterator
+    {
+      const index_t nn_index = nn_indices[nii];
+      if (nn_index == UNAVAILABLE || nn_index == index || find_root (index) == find_root (nn_index))
+        continue;
+      if (condition (cloud[index], cloud[nn_index], nn_distances[nii]))
+        unite (index, nn_index);
+    }
+  }
+
+  // Compaction: number the sets in the order in which the serial version would find their first point
+  std::vector<int> labels (input_->size (), -1);
+  pcl::IndicesClusters candidates;
+  for (const auto &index : indices)
+  {
+    if (index == UNAVAILABLE)
+      continue;
+    int &label = labels[find_root (index)];
+    if (label == -1)
+    {
+      label = static_cast<int> (candidates.size ());
+      candidates.emplace_back ();
+    }
+    candidates[label].indices.push_back (index);
+  }
+
+  for (auto &candidate : candidates)
+  {
+    std::sort (candidate.indices.begin (), candidate.indices.end ());
+    candidate.indices.erase (std::unique (candidate.indices.begin (), candidate.indices.end ()), candidate.indices.end ());
+    const int cluster_size = static_cast<int> (candidate.indices.size ());
+
+    // If extracting removed clusters, all clusters need to be saved, otherwise only the ones within the given cluster size range
+    if (!extract_removed_clusters_ && (cluster_size < min_cluster_size_ || cluster_size > max_cluster_size_))
+      continue;
+    candidate.header = input_->header;
+    if (extract_removed_clusters_ && cluster_size < min_cluster_size_)
+      small_clusters_->push_back (std::move (candidate));
+    else if (extract_removed_clusters_ && cluster_size > max_cluster_size_)
+      large_clusters_->push_back (std::move (candidate));
+    else
+      clusters.push_back (std::move (candidate));
+  }
+}
+
 #define PCL_INSTANTIATE_ConditionalEuclideanClustering(T) template class PCL_EXPORTS pcl::ConditionalEuclideanClustering<T>;
 
 #endif  // PCL_SEGMENTATION_IMPL_CONDITIONAL_EUCLIDEAN_CLUSTERING_HPP_
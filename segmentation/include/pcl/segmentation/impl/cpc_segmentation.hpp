@@ -40,6 +40,7 @@
 
 #include <pcl/sample_consensus/sac_model_plane.h> // for SampleConsensusModelPlane
 #include <pcl/segmentation/cpc_segmentation.h>
+#include <pcl/common/execution_context.h>
 
 template <typename PointT>
 pcl::CPCSegmentation<PointT>::CPCSegmentation () :
@@ -93,7 +94,6 @@ pcl::CPCSegmentation<PointT>::applyCuttingPlane (std::uint32_t depth_levels_left
   if (depth_levels_left <= 0)
     return;
 
-  pcl::IndicesPtr support_indices (new pcl::Indices);
   SegLabel2ClusterMap seg_to_edge_points_map;
   std::map<std::uint32_t, std::vector<EdgeID> > seg_to_edgeIDs_map;
   EdgeIterator edge_itr, edge_itr_end, next_edge;
@@ -136,26 +136,40 @@ pcl::CPCSegmentation<PointT>::applyCuttingPlane (std::uint32_t depth_levels_left
     seg_to_edge_points_map[source_segment_label]->push_back (edge_centroid);
     seg_to_edgeIDs_map[source_segment_label].push_back (*edge_itr);
   }
-  bool cut_found = false;
-  // do the following processing for each segment separately
+  // Segments which are large enough to be cut. Every segment has its own edges, model and random number generator,
+  // so they can be processed concurrently.
+  std::vector<std::pair<pcl::PointCloud<WeightSACPointType>::Ptr, const std::vector<EdgeID>*> > segments;
   for (const auto &seg_to_edge_points : seg_to_edge_points_map)
   {
     // if too small do not process
-    if (seg_to_edge_points.second->size () < min_segment_size_for_cutting_)
-    {
-      continue;
-    }
+    if (seg_to_edge_points.second->size () >= min_segment_size_for_cutting_)
+      segments.emplace_back (seg_to_edge_points.second, &seg_to_edgeIDs_map.at (seg_to_edge_points.first));
+  }
+
+  bool cut_found = false;
+  // do the following processing for each segment separately
+  const pcl::ThreadReservation reservation (threads_);
+  unsigned int threads = reservation.getNumberOfThreads ();
+#pragma omp parallel for \
+  default(none) \
+  shared(segments) \
+  reduction(||:cut_found) \
+  num_threads(threads) \
+  schedule(dynamic, 1)
+  for (std::ptrdiff_t segment_idx = 0; segment_idx < static_cast<std::ptrdiff_t> (segments.size ()); ++segment_idx)
+  {
+    const pcl::PointCloud<WeightSACPointType>::Ptr &edge_cloud_cluster = segments[segment_idx].first;
+    const std::vector<EdgeID> &segment_edge_ids = *segments[segment_idx].second;
 
     std::vector<double> weights;
-    weights.resize (seg_to_edge_points.second->size ());
-    for (std::size_t cp = 0; cp < seg_to_edge_points.second->size (); ++cp)
+    weights.resize (edge_cloud_cluster->size ());
+    for (std::size_t cp = 0; cp < edge_cloud_cluster->size (); ++cp)
     {
-      float& cur_weight = (*seg_to_edge_points.second)[cp].intensity;
+      float& cur_weight = (*edge_cloud_cluster)[cp].intensity;
       cur_weight = cur_weight < concavity_tolerance_threshold_ ? 0 : 1;
       weights[cp] = cur_weight;
     }
 
-    pcl::PointCloud<WeightSACPointType>::Ptr edge_cloud_cluster  = seg_to_edge_points.second;
     pcl::SampleConsensusModelPlane<WeightSACPointType>::Ptr model_p (new pcl::SampleConsensusModelPlane<WeightSACPointType> (edge_cloud_cluster));
 
     WeightedRandomSampleConsensus weight_sac (model_p, seed_resolution_, true);
@@ -174,6 +188,7 @@ pcl::CPCSegmentation<PointT>::applyCuttingPlane (std::uint32_t depth_levels_left
 
     model_coefficients[3] += std::numeric_limits<float>::epsilon ();    
 
+    pcl::IndicesPtr support_indices (new pcl::Indices);
     weight_sac.getInliers (*support_indices);
 
     // the support_indices which are actually cut (if not locally constrain:  cut_support_indices = support_indices
@@ -242,25 +257,27 @@ pcl::CPCSegmentation<PointT>::applyCuttingPlane (std::uint32_t depth_levels_left
     int number_connections_cut = 0;
     for (const auto &point_index : cut_support_indices)
     {
+      const EdgeID &edge_id = segment_edge_ids[point_index];
       if (use_clean_cutting_)
       {
         // skip edges where both centroids are on one side of the cutting plane
-        std::uint32_t source_sv_label = sv_adjacency_list_[boost::source (seg_to_edgeIDs_map[seg_to_edge_points.first][point_index], sv_adjacency_list_)];
-        std::uint32_t target_sv_label = sv_adjacency_list_[boost::target (seg_to_edgeIDs_map[seg_to_edge_points.first][point_index], sv_adjacency_list_)];
+        std::uint32_t source_sv_label = sv_adjacency_list_[boost::source (edge_id, sv_adjacency_list_)];
+        std::uint32_t target_sv_label = sv_adjacency_list_[boost::target (edge_id, sv_adjacency_list_)];
         // get centroids of vertices
-        const pcl::PointXYZRGBA source_centroid = sv_label_to_supervoxel_map_[source_sv_label]->centroid_;
-        const pcl::PointXYZRGBA target_centroid = sv_label_to_supervoxel_map_[target_sv_label]->centroid_;
+        const pcl::PointXYZRGBA source_centroid = sv_label_to_supervoxel_map_.at (source_sv_label)->centroid_;
+        const pcl::PointXYZRGBA target_centroid = sv_label_to_supervoxel_map_.at (target_sv_label)->centroid_;
         // this makes a clean cut
         if (pcl::pointToPlaneDistanceSigned (source_centroid, model_coefficients) * pcl::pointToPlaneDistanceSigned (target_centroid, model_coefficients) > 0)
         {
           continue;
         }
       }
-      sv_adjacency_list_[seg_to_edgeIDs_map[seg_to_edge_points.first][point_index]].used_for_cutting = true;
-      if (sv_adjacency_list_[seg_to_edgeIDs_map[seg_to_edge_points.first][point_index]].is_valid) 
+      // The edges of a segment connect supervoxels of this segment only, so no other thread writes them
+      sv_adjacency_list_[edge_id].used_for_cutting = true;
+      if (sv_adjacency_list_[edge_id].is_valid) 
       {
         ++number_connections_cut;
-        sv_adjacency_list_[seg_to_edgeIDs_map[seg_to_edge_points.first][point_index]].is_valid = false;
+        sv_adjacency_list_[edge_id].is_valid = false;
       }
     }
 //     std::cout << "We cut " << number_connections_cut << " connections" << std::endl;
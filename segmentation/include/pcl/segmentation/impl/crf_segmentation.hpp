@@ -482,6 +482,7 @@ pcl::CrfSegmentation<PointT>::segmentPoints (pcl::PointCloud<pcl::PointXYZRGBL>
 
   // create dense CRF
   DenseCrf crf (N, n_labels);
+  crf.setNumberOfThreads (threads_);
 
   // set the unary potentials
   crf.setUnaryEnergy (unary);
@@ -39,8 +39,11 @@
 #define PCL_SEGMENTATION_IMPL_EXTRACT_CLUSTERS_H_
 
 #include <pcl/segmentation/extract_clusters.h>
+#include <pcl/common/execution_context.h>
 #include <pcl/search/organized.h> // for OrganizedNeighbor
 
+#include <atomic>
+
 //////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointT> void
 pcl::extractEuclideanClusters (const PointCloud<PointT> &cloud,
@@ -220,10 +223,145 @@ pcl::extractEuclideanClusters (const PointCloud<PointT> &cloud,
   }
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::extractEuclideanClusters (const PointCloud<PointT> &cloud,
+                               const Indices &indices,
+                               const typename search::Search<PointT>::Ptr &tree,
+                               float tolerance, std::vector<PointIndices> &clusters,
+                               unsigned int min_pts_per_cluster,
+                               unsigned int max_pts_per_cluster,
+                               unsigned int nr_threads)
+{
+  if (tree->getInputCloud()->size() != cloud.size()) {
+    PCL_ERROR("[pcl::extractEuclideanClusters] Tree built for a different point cloud "
+              "dataset (%zu) than the input cloud (%zu)!\n",
+              static_cast<std::size_t>(tree->getInputCloud()->size()),
+              static_cast<std::size_t>(cloud.size()));
+    return;
+  }
+  if (tree->getIndices()->size() != indices.size()) {
+    PCL_ERROR("[pcl::extractEuclideanClusters] Tree built for a different set of "
+              "indices (%zu) than the input set (%zu)!\n",
+              static_cast<std::size_t>(tree->getIndices()->size()),
+              indices.size());
+    return;
+  }
+  const pcl::ThreadReservation reservation (nr_threads);
+  const unsigned int threads = reservation.getNumberOfThreads ();
+
+  // Disjoint set forest over the cloud indices. Every root is the smallest index of its set, so linking a root
+  // only ever lowers parent values, and concurrent unions can be done with a single compare-and-swap.
+  std::vector<std::atomic<index_t>> parent (cloud.size ());
+  for (std::size_t i = 0; i < parent.size (); ++i)
+    parent[i].store (static_cast<index_t> (i), std::memory_order_relaxed);
+
+  const auto find_root = [&parent] (index_t x)
+  {
+    index_t p = parent[x].load (std::memory_order_relaxed);
+    while (p != x)
+    {
+      // Path halving: point x to its grandparent on the way up
+      const index_t gp = parent[p].load (std::memory_order_relaxed);
+      if (gp != p)
+        parent[x].compare_exchange_weak (p, gp, std::memory_order_relaxed);
+      x = gp;
+      p = parent[x].load (std::memory_order_relaxed);
+    }
+    return (x);
+  };
+
+  const auto unite = [&parent, &find_root] (index_t a, index_t b)
+  {
+    while (true)
+    {
+      a = find_root (a);
+      b = find_root (b);
+      if (a == b)
+        return;
+      if (a < b)
+        std::swap (a, b);
+      // Link the larger root below the smaller one, unless another thread changed it in the meantime
+      index_t expected = a;
+      if (parent[a].compare_exchange_strong (expected, b, std::memory_order_relaxed))
+        return;
+    }
+  };
+
+  // Concurrent radius searches, every neighbor pair is merged into the same set
+  std::atomic<bool> search_failed (false);
+  Indices nn_indices;
+  std::vector<float> nn_distances;
+  std::ptrdiff_t nr_indices = static_cast<std::ptrdiff_t> (indices.size ());
+#pragma omp parallel for \
+  default(none) \
+  shared(cloud, indices, nr_indices, tolerance, tree, unite, search_failed) \
+  firstprivate(nn_indices, nn_distances) \
+  num_threads(threads) \
+  schedule(dynamic, 256)
+  for (std::ptrdiff_t i = 0; i < nr_indices; ++i)
+  {
+    const index_t index = indices[i];
+    if (tree->radiusSearch (cloud[index], tolerance, nn_indices, nn_distances) == -1)
+    {
+      search_failed = true;
+      continue;
+    }
+    for (const auto &nn_index : nn_indices)
+      if (nn_index != UNAVAILABLE && nn_index != index)
+        unite (index, nn_index);
+  }
+  if (search_failed)
+  {
+    PCL_ERROR("[pcl::extractEuclideanClusters] Received error code -1 from radiusSearch\n");
+    return;
+  }
+
+  // Compaction: number the sets in the order in which the serial version would find their first point
+  std::vector<int> labels (cloud.size (), -1);
+  std::vector<PointIndices> candidates;
+  for (const auto &index : indices)
+  {
+    int &label = labels[find_root (index)];
+    if (label == -1)
+    {
+      label = static_cast<int> (candidates.size ());
+      candidates.emplace_back ();
+    }
+    candidates[label].indices.push_back (index);
+  }
+
+  for (auto &candidate : candidates)
+  {
+    std::sort (candidate.indices.begin (), candidate.indices.end ());
+    candidate.indices.erase (std::unique (candidate.indices.begin (), candidate.indices.end ()), candidate.indices.end ());
+
+    // If this cluster is satisfactory, add to the clusters
+    if (candidate.indices.size () >= min_pts_per_cluster && candidate.indices.size () <= max_pts_per_cluster)
+    {
+      candidate.header = cloud.header;
+      clusters.push_back (std::move (candidate));
+    }
+    else
+    {
+      PCL_DEBUG("[pcl::extractEuclideanClusters] This cluster has %zu points, which is not between %u and %u points, so it is not a final cluster\n",
+                candidate.indices.size (), min_pts_per_cluster, max_pts_per_cluster);
+    }
+  }
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////
 //////////////////////////////////////////////////////////////////////////////////////////////
 //////////////////////////////////////////////////////////////////////////////////////////////
 
+template <typename PointT> void
+pcl::EuclideanClusterExtraction<PointT>::setNumberOfThreads (unsigned int nr_threads)
+{
+  // 0 is resolved against the budget of pcl::ExecutionContext at compute time
+  threads_ = nr_threads;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointT> void 
 pcl::EuclideanClusterExtraction<PointT>::extract (std::vector<PointIndices> &clusters)
 {
@@ -246,7 +384,10 @@ pcl::EuclideanClusterExtraction<PointT>::extract (std::vector<PointIndices> &clu
 
   // Send the input dataset to the spatial locator
   tree_->setInputCloud (input_, indices_);
-  extractEuclideanClusters (*input_, *indices_, tree_, static_cast<float> (cluster_tolerance_), clusters, min_pts_per_cluster_, max_pts_per_cluster_);
+  if (threads_ != 1)
+    extractEuclideanClusters (*input_, *indices_, tree_, static_cast<float> (cluster_tolerance_), clusters, min_pts_per_cluster_, max_pts_per_cluster_, threads_);
+  else
+    extractEuclideanClusters (*input_, *indices_, tree_, static_cast<float> (cluster_tolerance_), clusters, min_pts_per_cluster_, max_pts_per_cluster_);
 
   //tree_->setInputCloud (input_);
   //extractEuclideanClusters (*input_, tree_, cluster_tolerance_, clusters, min_pts_per_cluster_, max_pts_per_cluster_);
@@ -259,6 +400,7 @@ pcl::EuclideanClusterExtraction<PointT>::extract (std::vector<PointIndices> &clu
 
 #define PCL_INSTANTIATE_EuclideanClusterExtraction(T) template class PCL_EXPORTS pcl::EuclideanClusterExtraction<T>;
 #define PCL_INSTANTIATE_extractEuclideanClusters(T) template void PCL_EXPORTS pcl::extractEuclideanClusters<T>(const pcl::PointCloud<T> &, const typename pcl::search::Search<T>::Ptr &, float , std::vector<pcl::PointIndices> &, unsigned int, unsigned int);
-#define PCL_INSTANTIATE_extractEuclideanClusters_indices(T) template void PCL_EXPORTS pcl::extractEuclideanClusters<T>(const pcl::PointCloud<T> &, const pcl::Indices &, const typename pcl::search::Search<T>::Ptr &, float , std::vector<pcl::PointIndices> &, unsigned int, unsigned int);
+#define PCL_INSTANTIATE_extractEuclideanClusters_indices(T) template void PCL_EXPORTS pcl::extractEuclideanClusters<T>(const pcl::PointCloud<T> &, const pcl::Indices &, const typename pcl::search::Search<T>::Ptr &, float , std::vector<pcl::PointIndices> &, unsigned int, unsigned int); \
+  template void PCL_EXPORTS pcl::extractEuclideanClusters<T>(const pcl::PointCloud<T> &, const pcl::Indices &, const typename pcl::search::Search<T>::Ptr &, float , std::vector<pcl::PointIndices> &, unsigned int, unsigned int, unsigned int);
 
 #endif        // PCL_EXTRACT_CLUSTERS_IMPL_H_
@@ -42,6 +42,9 @@
 #include <pcl/sample_consensus/sac_model_plane.h> // for SampleConsensusModelPlane
 #include <pcl/common/centroid.h>
 #include <pcl/common/eigen.h>
+#include <pcl/common/execution_context.h>
+
+#include <limits>
 
 //////////////////////////////////////////////////////////////////////////
 template <typename PointT> bool
@@ -144,6 +147,80 @@ pcl::isXYPointIn2DXYPolygon (const PointT &point, const pcl::PointCloud<PointT>
   return (in_poly);
 }
 
+//////////////////////////////////////////////////////////////////////////
+template <typename PointT>
+pcl::XYPolygonEdgeGrid<PointT>::XYPolygonEdgeGrid (const pcl::PointCloud<PointT> &polygon)
+  : min_x_ (std::numeric_limits<double>::max ())
+  , max_x_ (std::numeric_limits<double>::lowest ())
+  , bin_scale_ (0)
+{
+  // The edges in the order of the crossing test of isXYPointIn2DXYPolygon
+  const auto nr_poly_points = polygon.size ();
+  std::vector<Edge> edges;
+  edges.reserve (nr_poly_points);
+  for (std::size_t i = 0; i < nr_poly_points; ++i)
+  {
+    const PointT &p_old = polygon[i == 0 ? nr_poly_points - 1 : i - 1];
+    const PointT &p_new = polygon[i];
+    // Edges parallel to Y are never crossed
+    if (p_new.x == p_old.x)
+      continue;
+    if (p_new.x > p_old.x)
+      edges.push_back ({p_old.x, p_old.y, p_new.x, p_new.y});
+    else
+      edges.push_back ({p_new.x, p_new.y, p_old.x, p_old.y});
+    min_x_ = std::min (min_x_, edges.back ().x1);
+    max_x_ = std::max (max_x_, edges.back ().x2);
+  }
+
+  // One bin per edge, a convex polygon then has about 3 edges per bin
+  const std::size_t nr_bins = std::max<std::size_t> (edges.size (), 1);
+  bin_offsets_.assign (nr_bins + 1, 0);
+  if (edges.empty ())
+    return;
+  bin_scale_ = static_cast<double> (nr_bins) / (max_x_ - min_x_);
+
+  // Counting sort of the edges into all the bins they overlap. Since getBin is
+  // monotonic, every point within the X range of an edge lands in one of them.
+  for (const Edge &edge : edges)
+    for (std::size_t bin = getBin (edge.x1), last = getBin (edge.x2); bin <= last; ++bin)
+      ++bin_offsets_[bin + 1];
+  for (std::size_t bin = 0; bin < nr_bins; ++bin)
+    bin_offsets_[bin + 1] += bin_offsets_[bin];
+  bin_edges_.resize (bin_offsets_.back ());
+  std::vector<std::size_t> next (bin_offsets_.begin (), bin_offsets_.end () - 1);
+  for (const Edge &edge : edges)
+    for (std::size_t bin = getBin (edge.x1), last = getBin (edge.x2); bin <= last; ++bin)
+      bin_edges_[next[bin]++] = edge;
+}
+
+//////////////////////////////////////////////////////////////////////////
+template <typename PointT> bool
+pcl::XYPolygonEdgeGrid<PointT>::isInside (double x, double y) const
+{
+  // Only edges with x1 < x <= x2 can be crossed, which also rejects NaN
+  if (!(x > min_x_ && x <= max_x_))
+    return (false);
+
+  bool in_poly = false;
+  const std::size_t bin = getBin (x);
+  for (std::size_t i = bin_offsets_[bin]; i < bin_offsets_[bin + 1]; ++i)
+  {
+    const Edge &edge = bin_edges_[i];
+    if (edge.x1 < x && x <= edge.x2 && (y - edge.y1) * (edge.x2 - edge.x1) < (edge.y2 - edge.y1) * (x - edge.x1))
+      in_poly = !in_poly;
+  }
+  return (in_poly);
+}
+
+//////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::ExtractPolygonalPrismData<PointT>::setNumberOfThreads (unsigned int nr_threads)
+{
+  // 0 is resolved against the budget of pcl::ExecutionContext at compute time
+  threads_ = nr_threads;
+}
+
 //////////////////////////////////////////////////////////////////////////
 template <typename PointT> void
 pcl::ExtractPolygonalPrismData<PointT>::segment (pcl::PointIndices &output)
@@ -201,10 +278,10 @@ pcl::ExtractPolygonalPrismData<PointT>::segment (pcl::PointIndices &output)
     model_coefficients[3] = -1 * (model_coefficients.dot ((*planar_hull_)[0].getVector4fMap ()));
   }
 
-  // Project all points
-  PointCloud projected_points;
-  SampleConsensusModelPlane<PointT> sacmodel (input_);
-  sacmodel.projectPoints (*indices_, model_coefficients, projected_points, false);
+  // Normalized normal as used to project the points onto the plane
+  Eigen::Vector4f normal (model_coefficients[0], model_coefficients[1], model_coefficients[2], 0.0f);
+  normal.normalize ();
+  Eigen::Vector4f plane (normal[0], normal[1], normal[2], model_coefficients[3]);
 
   // Create a X-Y projected representation for within bounds polygonal checking
   int k0, k1, k2;
@@ -223,31 +300,42 @@ pcl::ExtractPolygonalPrismData<PointT>::segment (pcl::PointIndices &output)
     polygon[i].y = pt[k2];
     polygon[i].z = 0;
   }
-
-  PointT pt_xy;
-  pt_xy.z = 0;
-
-  output.indices.resize (indices_->size ());
-  int l = 0;
-  for (std::size_t i = 0; i < projected_points.size (); ++i)
+  const XYPolygonEdgeGrid<PointT> polygon_grid (polygon);
+
+  // Check the height limits and the polygon in a single pass, the points are projected
+  // onto the plane on the fly
+  const auto nr_points = static_cast<std::ptrdiff_t> (indices_->size ());
+  std::vector<unsigned char> inside (nr_points);
+  const pcl::ThreadReservation reservation (threads_);
+  unsigned int threads = reservation.getNumberOfThreads ();
+#pragma omp parallel for \
+  default(none) \
+  shared(inside, k1, k2, model_coefficients, normal, plane, polygon_grid) \
+  firstprivate(nr_points) \
+  num_threads(threads)
+  for (std::ptrdiff_t i = 0; i < nr_points; ++i)
   {
+    const PointT &point = (*input_)[(*indices_)[i]];
     // Check the distance to the user imposed limits from the table planar model
-    double distance = pointToPlaneDistanceSigned ((*input_)[(*indices_)[i]], model_coefficients);
+    double distance = pointToPlaneDistanceSigned (point, model_coefficients);
     if (distance < height_limit_min_ || distance > height_limit_max_)
+    {
+      inside[i] = 0;
       continue;
+    }
 
-    // Check what points are inside the hull
-    Eigen::Vector4f pt (projected_points[i].x,
-                         projected_points[i].y,
-                         projected_points[i].z, 0);
-    pt_xy.x = pt[k1];
-    pt_xy.y = pt[k2];
-
-    if (!pcl::isXYPointIn2DXYPolygon (pt_xy, polygon))
-      continue;
-
-    output.indices[l++] = (*indices_)[i];
+    // Check if the projection of the point is inside the hull
+    Eigen::Vector4f pt (point.x, point.y, point.z, 1.0f);
+    const float distance_to_plane = plane.dot (pt);
+    pt -= normal * distance_to_plane;
+    inside[i] = polygon_grid.isInside (pt[k1], pt[k2]);
   }
+
+  output.indices.resize (indices_->size ());
+  int l = 0;
+  for (std::ptrdiff_t i = 0; i < nr_points; ++i)
+    if (inside[i])
+      output.indices[l++] = (*indices_)[i];
   output.indices.resize (l);
 
   deinitCompute ();
@@ -256,6 +344,7 @@ pcl::ExtractPolygonalPrismData<PointT>::segment (pcl::PointIndices &output)
 #define PCL_INSTANTIATE_ExtractPolygonalPrismData(T) template class PCL_EXPORTS pcl::ExtractPolygonalPrismData<T>;
 #define PCL_INSTANTIATE_isPointIn2DPolygon(T) template bool PCL_EXPORTS pcl::isPointIn2DPolygon<T>(const T&, const pcl::PointCloud<T> &);
 #define PCL_INSTANTIATE_isXYPointIn2DXYPolygon(T) template bool PCL_EXPORTS pcl::isXYPointIn2DXYPolygon<T>(const T &, const pcl::PointCloud<T> &);
+#define PCL_INSTANTIATE_XYPolygonEdgeGrid(T) template class PCL_EXPORTS pcl::XYPolygonEdgeGrid<T>;
 
 #endif    // PCL_SEGMENTATION_IMPL_EXTRACT_POLYGONAL_PRISM_DATA_H_
 
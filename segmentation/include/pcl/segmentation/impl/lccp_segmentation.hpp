@@ -40,6 +40,9 @@
 
 #include <pcl/segmentation/lccp_segmentation.h>
 #include <pcl/common/common.h>
+#include <pcl/common/execution_context.h>
+
+#include <vector>
 
 
 //////////////////////////////////////////////////////////
@@ -61,7 +64,8 @@ pcl::LCCPSegmentation<PointT>::LCCPSegmentation () :
   seed_resolution_ (0),
   voxel_resolution_ (0),
   k_factor_ (0),
-  min_segment_size_ (0)
+  min_segment_size_ (0),
+  threads_ (1)
 {
 }
 
@@ -83,6 +87,13 @@ pcl::LCCPSegmentation<PointT>::reset ()
   supervoxels_set_ = false;
 }
 
+template <typename PointT> void
+pcl::LCCPSegmentation<PointT>::setNumberOfThreads (unsigned int nr_threads)
+{
+  // 0 is resolved against the budget of pcl::ExecutionContext at compute time
+  threads_ = nr_threads;
+}
+
 template <typename PointT> void
 pcl::LCCPSegmentation<PointT>::segment ()
 {
@@ -357,74 +368,95 @@ pcl::LCCPSegmentation<PointT>::applyKconvexity (const unsigned int k_arg)
   if (k_arg == 0)
     return;
 
-  EdgeIterator edge_itr, edge_itr_end, next_edge;
-  // Check all edges in the graph for k-convexity
-  for (std::tie (edge_itr, edge_itr_end) = boost::edges (sv_adjacency_list_), next_edge = edge_itr; edge_itr != edge_itr_end; edge_itr = next_edge)
+  // Gather the convex edges, so they can be checked concurrently. The check of an edge only reads is_convex
+  // and writes is_valid of the edge itself.
+  std::vector<EdgeID> convex_edges;
+  EdgeIterator edge_itr, edge_itr_end;
+  for (std::tie (edge_itr, edge_itr_end) = boost::edges (sv_adjacency_list_); edge_itr != edge_itr_end; ++edge_itr)
+    if (sv_adjacency_list_[*edge_itr].is_convex)
+      convex_edges.push_back (*edge_itr);
+
+  // Check all convex edges in the graph for k-convexity
+  SupervoxelAdjacencyList &adjacency_list = sv_adjacency_list_;
+  const pcl::ThreadReservation reservation (threads_);
+  unsigned int threads = reservation.getNumberOfThreads ();
+#pragma omp parallel for \
+  default(none) \
+  shared(adjacency_list, convex_edges) \
+  firstprivate(k_arg) \
+  num_threads(threads) \
+  schedule(dynamic, 64)
+  for (std::ptrdiff_t edge_idx = 0; edge_idx < static_cast<std::ptrdiff_t> (convex_edges.size ()); ++edge_idx)
   {
-    ++next_edge;  // next_edge iterator is necessary, because removing an edge invalidates the iterator to the current edge
+    const EdgeID &edge = convex_edges[edge_idx];
+    unsigned int kcount = 0;
 
-    bool is_convex = sv_adjacency_list_[*edge_itr].is_convex;
+    const VertexID source = boost::source (edge, adjacency_list);
+    const VertexID target = boost::target (edge, adjacency_list);
 
-    if (is_convex)  // If edge is (0-)convex
+    OutEdgeIterator source_neighbors_itr, source_neighbors_itr_end;
+    // Find common neighbors, check their connection
+    for (std::tie(source_neighbors_itr, source_neighbors_itr_end) = boost::out_edges (source, adjacency_list); source_neighbors_itr != source_neighbors_itr_end; ++source_neighbors_itr)  // For all supervoxels
     {
-      unsigned int kcount = 0;
-
-      const VertexID source = boost::source (*edge_itr, sv_adjacency_list_);
-      const VertexID target = boost::target (*edge_itr, sv_adjacency_list_);
+      VertexID source_neighbor_ID = boost::target (*source_neighbors_itr, adjacency_list);
 
-      OutEdgeIterator source_neighbors_itr, source_neighbors_itr_end;
-      // Find common neighbors, check their connection
-      for (std::tie(source_neighbors_itr, source_neighbors_itr_end) = boost::out_edges (source, sv_adjacency_list_); source_neighbors_itr != source_neighbors_itr_end; ++source_neighbors_itr)  // For all supervoxels
+      OutEdgeIterator target_neighbors_itr, target_neighbors_itr_end;
+      for (std::tie(target_neighbors_itr, target_neighbors_itr_end) = boost::out_edges (target, adjacency_list); target_neighbors_itr != target_neighbors_itr_end; ++target_neighbors_itr)  // For all supervoxels
       {
-        VertexID source_neighbor_ID = boost::target (*source_neighbors_itr, sv_adjacency_list_);
-
-        OutEdgeIterator target_neighbors_itr, target_neighbors_itr_end;
-        for (std::tie(target_neighbors_itr, target_neighbors_itr_end) = boost::out_edges (target, sv_adjacency_list_); target_neighbors_itr != target_neighbors_itr_end; ++target_neighbors_itr)  // For all supervoxels
+        VertexID target_neighbor_ID = boost::target (*target_neighbors_itr, adjacency_list);
+        if (source_neighbor_ID == target_neighbor_ID)  // Common neighbor
         {
-          VertexID target_neighbor_ID = boost::target (*target_neighbors_itr, sv_adjacency_list_);
-          if (source_neighbor_ID == target_neighbor_ID)  // Common neighbor
-          {
-            EdgeID src_edge = boost::edge (source, source_neighbor_ID, sv_adjacency_list_).first;
-            EdgeID tar_edge = boost::edge (target, source_neighbor_ID, sv_adjacency_list_).first;
+          EdgeID src_edge = boost::edge (source, source_neighbor_ID, adjacency_list).first;
+          EdgeID tar_edge = boost::edge (target, source_neighbor_ID, adjacency_list).first;
 
-            bool src_is_convex = (sv_adjacency_list_)[src_edge].is_convex;
-            bool tar_is_convex = (sv_adjacency_list_)[tar_edge].is_convex;
+          bool src_is_convex = adjacency_list[src_edge].is_convex;
+          bool tar_is_convex = adjacency_list[tar_edge].is_convex;
 
-            if (src_is_convex && tar_is_convex)
-              ++kcount;
+          if (src_is_convex && tar_is_convex)
+            ++kcount;
 
-            break;
-          }
-        }
-
-        if (kcount >= k_arg)  // Connection is k-convex, stop search
           break;
+        }
       }
 
-      // Check k convexity
-      if (kcount < k_arg)
-        (sv_adjacency_list_)[*edge_itr].is_valid = false;
+      if (kcount >= k_arg)  // Connection is k-convex, stop search
+        break;
     }
+
+    // Check k convexity
+    if (kcount < k_arg)
+      adjacency_list[edge].is_valid = false;
   }
 }
 
 template <typename PointT> void
 pcl::LCCPSegmentation<PointT>::calculateConvexConnections (SupervoxelAdjacencyList& adjacency_list_arg)
 {
-
-  EdgeIterator edge_itr, edge_itr_end, next_edge;
-  for (std::tie(edge_itr, edge_itr_end) = boost::edges (adjacency_list_arg), next_edge = edge_itr; edge_itr != edge_itr_end; edge_itr = next_edge)
+  // Gather the edges, so their convexity can be evaluated concurrently
+  std::vector<EdgeID> edges;
+  edges.reserve (boost::num_edges (adjacency_list_arg));
+  EdgeIterator edge_itr, edge_itr_end;
+  for (std::tie(edge_itr, edge_itr_end) = boost::edges (adjacency_list_arg); edge_itr != edge_itr_end; ++edge_itr)
+    edges.push_back (*edge_itr);
+
+  const pcl::ThreadReservation reservation (threads_);
+  unsigned int threads = reservation.getNumberOfThreads ();
+#pragma omp parallel for \
+  default(none) \
+  shared(adjacency_list_arg, edges) \
+  num_threads(threads) \
+  schedule(dynamic, 64)
+  for (std::ptrdiff_t edge_idx = 0; edge_idx < static_cast<std::ptrdiff_t> (edges.size ()); ++edge_idx)
   {
-    ++next_edge;  // next_edge iterator is necessary, because removing an edge invalidates the iterator to the current edge
-
-    std::uint32_t source_sv_label = adjacency_list_arg[boost::source (*edge_itr, adjacency_list_arg)];
-    std::uint32_t target_sv_label = adjacency_list_arg[boost::target (*edge_itr, adjacency_list_arg)];
+    const EdgeID &edge = edges[edge_idx];
+    std::uint32_t source_sv_label = adjacency_list_arg[boost::source (edge, adjacency_list_arg)];
+    std::uint32_t target_sv_label = adjacency_list_arg[boost::target (edge, adjacency_list_arg)];
 
     float normal_difference;
     bool is_convex = connIsConvex (source_sv_label, target_sv_label, normal_difference);
-    adjacency_list_arg[*edge_itr].is_convex = is_convex;
-    adjacency_list_arg[*edge_itr].is_valid = is_convex;
-    adjacency_list_arg[*edge_itr].normal_difference = normal_difference;
+    adjacency_list_arg[edge].is_convex = is_convex;
+    adjacency_list_arg[edge].is_valid = is_convex;
+    adjacency_list_arg[edge].normal_difference = normal_difference;
   }
 }
 
@@ -433,8 +465,9 @@ pcl::LCCPSegmentation<PointT>::connIsConvex (const std::uint32_t source_label_ar
                                              const std::uint32_t target_label_arg,
                                              float &normal_angle)
 {
-  typename pcl::Supervoxel<PointT>::Ptr& sv_source = sv_label_to_supervoxel_map_[source_label_arg];
-  typename pcl::Supervoxel<PointT>::Ptr& sv_target = sv_label_to_supervoxel_map_[target_label_arg];
+  // at () instead of operator[], which may insert, as the edges are evaluated concurrently
+  const typename pcl::Supervoxel<PointT>::Ptr& sv_source = sv_label_to_supervoxel_map_.at (source_label_arg);
+  const typename pcl::Supervoxel<PointT>::Ptr& sv_target = sv_label_to_supervoxel_map_.at (target_label_arg);
 
   const Eigen::Vector3f& source_centroid = sv_source->centroid_.getVector3fMap ();
   const Eigen::Vector3f& target_centroid = sv_target->centroid_.getVector3fMap ();
@@ -41,9 +41,12 @@
 
 #include <boost/graph/boykov_kolmogorov_max_flow.hpp> // for boykov_kolmogorov_max_flow
 #include <pcl/segmentation/min_cut_segmentation.h>
+#include <pcl/common/execution_context.h>
 #include <pcl/search/search.h>
 #include <pcl/search/kdtree.h>
+#include <algorithm>
 #include <cmath>
+#include <numeric>
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointT>
@@ -60,11 +63,10 @@ pcl::MinCutSegmentation<PointT>::MinCutSegmentation () :
   foreground_points_ (0),
   background_points_ (0),
   clusters_ (0),
-  vertices_ (0),
-  edge_marker_ (0),
   source_ (),/////////////////////////////////
   sink_ (),///////////////////////////////////
-  max_flow_ (0.0)
+  max_flow_ (0.0),
+  threads_ (1)
 {
 }
 
@@ -75,8 +77,6 @@ pcl::MinCutSegmentation<PointT>::~MinCutSegmentation ()
   foreground_points_.clear ();
   background_points_.clear ();
   clusters_.clear ();
-  vertices_.clear ();
-  edge_marker_.clear ();
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -177,6 +177,14 @@ pcl::MinCutSegmentation<PointT>::setNumberOfNeighbours (unsigned int neighbour_n
   }
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::MinCutSegmentation<PointT>::setNumberOfThreads (unsigned int nr_threads)
+{
+  // 0 is resolved against the budget of pcl::ExecutionContext at compute time
+  threads_ = nr_threads;
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointT> std::vector<PointT, Eigen::aligned_allocator<PointT> >
 pcl::MinCutSegmentation<PointT>::getForegroundPoints () const
@@ -271,12 +279,24 @@ pcl::MinCutSegmentation<PointT>::extract (std::vector <pcl::PointIndices>& clust
     binary_potentials_are_valid_ = true;
   }
 
-  //IndexMap index_map = boost::get (boost::vertex_index, *graph_);
-  ResidualCapacityMap residual_capacity = boost::get (boost::edge_residual_capacity, *graph_);
-
-  max_flow_ = boost::boykov_kolmogorov_max_flow (*graph_, source_, sink_);
-
-  assembleLabels (residual_capacity);
+  const auto edge_index = boost::get (boost::edge_index, graph_);
+  const auto vertex_index = boost::get (boost::vertex_index, graph_);
+  const std::size_t number_of_vertices = boost::num_vertices (graph_);
+  std::vector<CompactEdgeDescriptor> predecessors (number_of_vertices);
+  std::vector<boost::default_color_type> colors (number_of_vertices);
+  std::vector<std::size_t> distances (number_of_vertices);
+  residual_capacity_.resize (capacity_.size ());
+
+  max_flow_ = boost::boykov_kolmogorov_max_flow (graph_,
+                                                 boost::make_iterator_property_map (capacity_.begin (), edge_index),
+                                                 boost::make_iterator_property_map (residual_capacity_.begin (), edge_index),
+                                                 boost::make_iterator_property_map (reverse_edges_.begin (), edge_index),
+                                                 boost::make_iterator_property_map (predecessors.begin (), vertex_index),
+                                                 boost::make_iterator_property_map (colors.begin (), vertex_index),
+                                                 boost::make_iterator_property_map (distances.begin (), vertex_index),
+                                                 vertex_index, source_, sink_);
+
+  assembleLabels ();
 
   clusters.reserve (clusters_.size ());
   std::copy (clusters_.begin (), clusters_.end (), std::back_inserter (clusters));
@@ -295,7 +315,35 @@ pcl::MinCutSegmentation<PointT>::getMaxFlow () const
 template <typename PointT> typename pcl::MinCutSegmentation<PointT>::mGraphPtr
 pcl::MinCutSegmentation<PointT>::getGraph () const
 {
-  return (graph_);
+  if (capacity_.empty ())
+    return (mGraphPtr ());
+
+  const std::size_t number_of_vertices = boost::num_vertices (graph_);
+  mGraphPtr graph (new mGraph (number_of_vertices));
+  CapacityMap capacity = boost::get (boost::edge_capacity, *graph);
+  ResidualCapacityMap residual_capacity = boost::get (boost::edge_residual_capacity, *graph);
+  ReverseEdgeMap reverse_edges = boost::get (boost::edge_reverse, *graph);
+  for (std::size_t vertex = 0; vertex < number_of_vertices; ++vertex)
+  {
+    for (const auto& edge : boost::make_iterator_range (boost::out_edges (vertex, graph_)))
+    {
+      // Add every pair of reverse edges once
+      const std::size_t index = boost::get (boost::edge_index, graph_, edge);
+      const std::size_t reverse_index = boost::get (boost::edge_index, graph_, reverse_edges_[index]);
+      if (reverse_index < index)
+        continue;
+      const VertexDescriptor target = boost::target (edge, graph_);
+      const EdgeDescriptor forward = boost::add_edge (vertex, target, *graph).first;
+      const EdgeDescriptor backward = boost::add_edge (target, vertex, *graph).first;
+      capacity[forward] = capacity_[index];
+      capacity[backward] = capacity_[reverse_index];
+      residual_capacity[forward] = (residual_capacity_.empty () ? capacity_[index] : residual_capacity_[index]);
+      residual_capacity[backward] = (residual_capacity_.empty () ? capacity_[reverse_index] : residual_capacity_[reverse_index]);
+      reverse_edges[forward] = backward;
+      reverse_edges[backward] = forward;
+    }
+  }
+  return (graph);
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -311,52 +359,156 @@ pcl::MinCutSegmentation<PointT>::buildGraph ()
   if (!search_)
     search_.reset (new pcl::search::KdTree<PointT>);
 
-  graph_.reset (new mGraph);
-
-  capacity_.reset (new CapacityMap);
-  *capacity_ = boost::get (boost::edge_capacity, *graph_);
-
-  reverse_edges_.reset (new ReverseEdgeMap);
-  *reverse_edges_ = boost::get (boost::edge_reverse, *graph_);
-
-  VertexDescriptor vertex_descriptor(0);
-  vertices_.clear ();
-  vertices_.resize (number_of_points + 2, vertex_descriptor);
-
-  std::set<int> out_edges_marker;
-  edge_marker_.clear ();
-  edge_marker_.resize (number_of_points + 2, out_edges_marker);
+  // The points of the graph, without duplicated indices
+  graph_points_.clear ();
+  graph_points_.reserve (number_of_indices);
+  {
+    std::vector<bool> is_graph_point (number_of_points, false);
+    for (const auto& point_index : (*indices_))
+    {
+      if (!is_graph_point[point_index])
+      {
+        is_graph_point[point_index] = true;
+        graph_points_.push_back (point_index);
+      }
+    }
+  }
 
-  for (std::size_t i_point = 0; i_point < number_of_points + 2; i_point++)
-    vertices_[i_point] = boost::add_vertex (*graph_);
+  // K nearest neighbours of all the indices, the first one is the point itself
+  const std::size_t k = number_of_neighbours_;
+  Indices knn (number_of_indices * k, UNAVAILABLE);
+  search_->setInputCloud (input_, indices_);
+  const pcl::ThreadReservation reservation (threads_);
+  unsigned int threads = reservation.getNumberOfThreads ();
+#pragma omp parallel default(none) shared(knn) firstprivate(number_of_indices, k) num_threads(threads)
+  {
+    pcl::Indices neighbours;
+    std::vector<float> distances;
+#pragma omp for schedule(dynamic, 256)
+    for (std::ptrdiff_t i_point = 0; i_point < static_cast<std::ptrdiff_t> (number_of_indices); ++i_point)
+    {
+      search_->nearestKSearch (static_cast<index_t> (i_point), static_cast<int> (k), neighbours, distances);
+      std::copy_n (neighbours.begin (), std::min (k, neighbours.size ()), knn.begin () + i_point * k);
+    }
+  }
 
-  source_ = vertices_[number_of_points];
-  sink_ = vertices_[number_of_points + 1];
+  // Neighbourhoods are made symmetric: bucket both directions of every pair by the point, then sort
+  // and deduplicate each bucket
+  std::vector<std::size_t> neighbour_offsets (number_of_points + 1, 0);
+  for (std::size_t i_point = 0; i_point < number_of_indices; ++i_point)
+  {
+    const index_t point_index = (*indices_)[i_point];
+    for (std::size_t i_nghbr = 1; i_nghbr < k; ++i_nghbr)
+    {
+      const index_t neighbour = knn[i_point * k + i_nghbr];
+      if (neighbour == UNAVAILABLE || neighbour == point_index)
+        continue;
+      ++neighbour_offsets[point_index + 1];
+      ++neighbour_offsets[neighbour + 1];
+    }
+  }
+  std::partial_sum (neighbour_offsets.begin (), neighbour_offsets.end (), neighbour_offsets.begin ());
+  Indices neighbours (neighbour_offsets.back ());
+  {
+    std::vector<std::size_t> fill (neighbour_offsets.begin (), neighbour_offsets.end () - 1);
+    for (std::size_t i_point = 0; i_point < number_of_indices; ++i_point)
+    {
+      const index_t point_index = (*indices_)[i_point];
+      for (std::size_t i_nghbr = 1; i_nghbr < k; ++i_nghbr)
+      {
+        const index_t neighbour = knn[i_point * k + i_nghbr];
+        if (neighbour == UNAVAILABLE || neighbour == point_index)
+          continue;
+        neighbours[fill[point_index]++] = neighbour;
+        neighbours[fill[neighbour]++] = point_index;
+      }
+    }
+  }
+  knn.clear ();
+  knn.shrink_to_fit ();
+
+  // Row of a point: its unique neighbours, then the edges to the sink and to the source
+  const std::size_t number_of_graph_points = graph_points_.size ();
+  std::vector<std::size_t> unique_neighbours (number_of_graph_points);
+#pragma omp parallel for default(none) shared(neighbour_offsets, neighbours, unique_neighbours) firstprivate(number_of_graph_points) num_threads(threads) schedule(dynamic, 256)
+  for (std::ptrdiff_t i_point = 0; i_point < static_cast<std::ptrdiff_t> (number_of_graph_points); ++i_point)
+  {
+    const index_t point_index = graph_points_[i_point];
+    const auto begin = neighbours.begin () + neighbour_offsets[point_index];
+    const auto end = neighbours.begin () + neighbour_offsets[point_index + 1];
+    std::sort (begin, end);
+    unique_neighbours[i_point] = std::unique (begin, end) - begin;
+  }
 
-  for (const auto& point_index : (*indices_))
+  const std::size_t number_of_vertices = number_of_points + 2;
+  source_ = number_of_points;
+  sink_ = number_of_points + 1;
+  std::vector<std::size_t> row_offsets (number_of_vertices + 1, 0);
+  std::vector<std::size_t> point_slot (number_of_points, 0);
+  for (std::size_t i_point = 0; i_point < number_of_graph_points; ++i_point)
+  {
+    row_offsets[graph_points_[i_point] + 1] = unique_neighbours[i_point] + 2;
+    point_slot[graph_points_[i_point]] = i_point;
+  }
+  row_offsets[source_ + 1] = number_of_graph_points;
+  row_offsets[sink_ + 1] = number_of_graph_points;
+  std::partial_sum (row_offsets.begin (), row_offsets.end (), row_offsets.begin ());
+  const std::size_t number_of_edges = row_offsets.back ();
+
+  // Edges, capacities and reverse edge indices in row order
+  std::vector<std::pair<std::size_t, std::size_t> > edges (number_of_edges);
+  std::vector<std::size_t> reverse_indices (number_of_edges);
+  capacity_.assign (number_of_edges, 0.0);
+  residual_capacity_.clear ();
+  source_edges_.resize (number_of_graph_points);
+  sink_edges_.resize (number_of_graph_points);
+  const std::size_t source = source_;
+  const std::size_t sink = sink_;
+#pragma omp parallel for default(none) shared(neighbour_offsets, neighbours, unique_neighbours, row_offsets, point_slot, edges, reverse_indices) firstprivate(number_of_graph_points, source, sink) num_threads(threads) schedule(dynamic, 256)
+  for (std::ptrdiff_t i_point = 0; i_point < static_cast<std::ptrdiff_t> (number_of_graph_points); ++i_point)
   {
+    const index_t point_index = graph_points_[i_point];
+    std::size_t edge = row_offsets[point_index];
+    for (std::size_t i_nghbr = 0; i_nghbr < unique_neighbours[i_point]; ++i_nghbr, ++edge)
+    {
+      const index_t neighbour = neighbours[neighbour_offsets[point_index] + i_nghbr];
+      // The reverse edge is at the position of the point among the neighbours of the neighbour
+      const auto neighbour_begin = neighbours.begin () + neighbour_offsets[neighbour];
+      const auto neighbour_end = neighbour_begin + unique_neighbours[point_slot[neighbour]];
+      edges[edge] = std::make_pair (static_cast<std::size_t> (point_index), static_cast<std::size_t> (neighbour));
+      reverse_indices[edge] = row_offsets[neighbour] + (std::lower_bound (neighbour_begin, neighbour_end, point_index) - neighbour_begin);
+      capacity_[edge] = calculateBinaryPotential (point_index, neighbour);
+    }
+
     double source_weight = 0.0;
     double sink_weight = 0.0;
     calculateUnaryPotential (point_index, source_weight, sink_weight);
-    addEdge (static_cast<int> (source_), point_index, source_weight);
-    addEdge (point_index, static_cast<int> (sink_), sink_weight);
+    const std::size_t to_sink = edge;
+    const std::size_t to_source = edge + 1;
+    const std::size_t from_source = row_offsets[source] + i_point;
+    const std::size_t from_sink = row_offsets[sink] + i_point;
+    edges[to_sink] = std::make_pair (static_cast<std::size_t> (point_index), sink);
+    edges[to_source] = std::make_pair (static_cast<std::size_t> (point_index), source);
+    edges[from_source] = std::make_pair (source, static_cast<std::size_t> (point_index));
+    edges[from_sink] = std::make_pair (sink, static_cast<std::size_t> (point_index));
+    reverse_indices[to_sink] = from_sink;
+    reverse_indices[from_sink] = to_sink;
+    reverse_indices[to_source] = from_source;
+    reverse_indices[from_source] = to_source;
+    capacity_[to_sink] = sink_weight;
+    capacity_[from_source] = source_weight;
+    source_edges_[i_point] = from_source;
+    sink_edges_[i_point] = to_sink;
   }
 
-  pcl::Indices neighbours;
-  std::vector<float> distances;
-  search_->setInputCloud (input_, indices_);
-  for (std::size_t i_point = 0; i_point < number_of_indices; i_point++)
+  graph_ = CompactGraph (boost::edges_are_sorted, edges.begin (), edges.end (), number_of_vertices, number_of_edges);
+
+  reverse_edges_.resize (number_of_edges);
+#pragma omp parallel for default(none) shared(edges, reverse_indices) firstprivate(number_of_edges) num_threads(threads)
+  for (std::ptrdiff_t edge = 0; edge < static_cast<std::ptrdiff_t> (number_of_edges); ++edge)
   {
-    index_t point_index = (*indices_)[i_point];
-    search_->nearestKSearch (i_point, number_of_neighbours_, neighbours, distances);
-    for (std::size_t i_nghbr = 1; i_nghbr < neighbours.size (); i_nghbr++)
-    {
-      double weight = calculateBinaryPotential (point_index, neighbours[i_nghbr]);
-      addEdge (point_index, neighbours[i_nghbr], weight);
-      addEdge (neighbours[i_nghbr], point_index, weight);
-    }
-    neighbours.clear ();
-    distances.clear ();
+    const std::size_t reverse_index = reverse_indices[edge];
+    reverse_edges_[edge] = CompactEdgeDescriptor (edges[reverse_index].first, reverse_index);
   }
 
   return (true);
@@ -418,32 +570,6 @@ pcl::MinCutSegmentation<PointT>::calculateUnaryPotential (int point, double& sou
 */
 }
 
-//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-template <typename PointT> bool
-pcl::MinCutSegmentation<PointT>::addEdge (int source, int target, double weight)
-{
-  std::set<int>::iterator iter_out = edge_marker_[source].find (target);
-  if ( iter_out != edge_marker_[source].end () )
-    return (false);
-
-  EdgeDescriptor edge;
-  EdgeDescriptor reverse_edge;
-  bool edge_was_added, reverse_edge_was_added;
-
-  boost::tie (edge, edge_was_added) = boost::add_edge ( vertices_[source], vertices_[target], *graph_ );
-  boost::tie (reverse_edge, reverse_edge_was_added) = boost::add_edge ( vertices_[target], vertices_[source], *graph_ );
-  if ( !edge_was_added || !reverse_edge_was_added )
-    return (false);
-
-  (*capacity_)[edge] = weight;
-  (*capacity_)[reverse_edge] = 0.0;
-  (*reverse_edges_)[edge] = reverse_edge;
-  (*reverse_edges_)[reverse_edge] = edge;
-  edge_marker_[source].insert (target);
-
-  return (true);
-}
-
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointT> double
 pcl::MinCutSegmentation<PointT>::calculateBinaryPotential (int source, int target) const
@@ -463,22 +589,17 @@ pcl::MinCutSegmentation<PointT>::calculateBinaryPotential (int source, int targe
 template <typename PointT> bool
 pcl::MinCutSegmentation<PointT>::recalculateUnaryPotentials ()
 {
-  OutEdgeIterator src_edge_iter;
-  OutEdgeIterator src_edge_end;
-  std::pair<EdgeDescriptor, bool> sink_edge;
-
-  for (boost::tie (src_edge_iter, src_edge_end) = boost::out_edges (source_, *graph_); src_edge_iter != src_edge_end; src_edge_iter++)
+  const std::size_t number_of_graph_points = graph_points_.size ();
+  const pcl::ThreadReservation reservation (threads_);
+  unsigned int threads = reservation.getNumberOfThreads ();
+#pragma omp parallel for default(none) firstprivate(number_of_graph_points) num_threads(threads) schedule(dynamic, 256)
+  for (std::ptrdiff_t i_point = 0; i_point < static_cast<std::ptrdiff_t> (number_of_graph_points); ++i_point)
   {
     double source_weight = 0.0;
     double sink_weight = 0.0;
-    sink_edge.second = false;
-    calculateUnaryPotential (static_cast<int> (boost::target (*src_edge_iter, *graph_)), source_weight, sink_weight);
-    sink_edge = boost::lookup_edge (boost::target (*src_edge_iter, *graph_), sink_, *graph_);
-    if (!sink_edge.second)
-      return (false);
-
-    (*capacity_)[*src_edge_iter] = source_weight;
-    (*capacity_)[sink_edge.first] = sink_weight;
+    calculateUnaryPotential (graph_points_[i_point], source_weight, sink_weight);
+    capacity_[source_edges_[i_point]] = source_weight;
+    capacity_[sink_edges_[i_point]] = sink_weight;
   }
 
   return (true);
@@ -488,41 +609,18 @@ pcl::MinCutSegmentation<PointT>::recalculateUnaryPotentials ()
 template <typename PointT> bool
 pcl::MinCutSegmentation<PointT>::recalculateBinaryPotentials ()
 {
-  VertexIterator vertex_iter;
-  VertexIterator vertex_end;
-  OutEdgeIterator edge_iter;
-  OutEdgeIterator edge_end;
-
-  std::vector< std::set<VertexDescriptor> > edge_marker;
-  std::set<VertexDescriptor> out_edges_marker;
-  edge_marker.clear ();
-  edge_marker.resize (indices_->size () + 2, out_edges_marker);
-
-  for (boost::tie (vertex_iter, vertex_end) = boost::vertices (*graph_); vertex_iter != vertex_end; vertex_iter++)
+  const std::size_t number_of_graph_points = graph_points_.size ();
+  const pcl::ThreadReservation reservation (threads_);
+  unsigned int threads = reservation.getNumberOfThreads ();
+#pragma omp parallel for default(none) firstprivate(number_of_graph_points) num_threads(threads) schedule(dynamic, 256)
+  for (std::ptrdiff_t i_point = 0; i_point < static_cast<std::ptrdiff_t> (number_of_graph_points); ++i_point)
   {
-    VertexDescriptor source_vertex = *vertex_iter;
-    if (source_vertex == source_ || source_vertex == sink_)
-      continue;
-    for (boost::tie (edge_iter, edge_end) = boost::out_edges (source_vertex, *graph_); edge_iter != edge_end; edge_iter++)
+    const index_t point_index = graph_points_[i_point];
+    for (const auto& edge : boost::make_iterator_range (boost::out_edges (static_cast<VertexDescriptor> (point_index), graph_)))
     {
-      //If this is not the edge of the graph, but the reverse fictitious edge that is needed for the algorithm then continue
-      EdgeDescriptor reverse_edge = (*reverse_edges_)[*edge_iter];
-      if ((*capacity_)[reverse_edge] != 0.0)
-        continue;
-
-      //If we already changed weight for this edge then continue
-      VertexDescriptor target_vertex = boost::target (*edge_iter, *graph_);
-      std::set<VertexDescriptor>::iterator iter_out = edge_marker[static_cast<int> (source_vertex)].find (target_vertex);
-      if ( iter_out != edge_marker[static_cast<int> (source_vertex)].end () )
-        continue;
-
-      if (target_vertex != source_ && target_vertex != sink_)
-      {
-        //Change weight and remember that this edges were updated
-        double weight = calculateBinaryPotential (static_cast<int> (target_vertex), static_cast<int> (source_vertex));
-        (*capacity_)[*edge_iter] = weight;
-        edge_marker[static_cast<int> (source_vertex)].insert (target_vertex);
-      }
+      const VertexDescriptor target = boost::target (edge, graph_);
+      if (target != source_ && target != sink_)
+        capacity_[boost::get (boost::edge_index, graph_, edge)] = calculateBinaryPotential (static_cast<int> (target), point_index);
     }
   }
 
@@ -531,28 +629,19 @@ pcl::MinCutSegmentation<PointT>::recalculateBinaryPotentials ()
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointT> void
-pcl::MinCutSegmentation<PointT>::assembleLabels (ResidualCapacityMap& residual_capacity)
+pcl::MinCutSegmentation<PointT>::assembleLabels ()
 {
-  std::vector<int> labels;
-  labels.resize (input_->size (), 0);
-  for (const auto& i_point : (*indices_))
-    labels[i_point] = 1;
-
   clusters_.clear ();
 
   pcl::PointIndices segment;
   clusters_.resize (2, segment);
 
-  OutEdgeIterator edge_iter, edge_end;
-  for ( boost::tie (edge_iter, edge_end) = boost::out_edges (source_, *graph_); edge_iter != edge_end; edge_iter++ )
+  for (std::size_t i_point = 0; i_point < graph_points_.size (); ++i_point)
   {
-    if (labels[edge_iter->m_target] == 1)
-    {
-      if (residual_capacity[*edge_iter] > epsilon_)
-        clusters_[1].indices.push_back (static_cast<int> (edge_iter->m_target));
-      else
-        clusters_[0].indices.push_back (static_cast<int> (edge_iter->m_target));
-    }
+    if (residual_capacity_[source_edges_[i_point]] > epsilon_)
+      clusters_[1].indices.push_back (graph_points_[i_point]);
+    else
+      clusters_[0].indices.push_back (graph_points_[i_point]);
   }
 }
 
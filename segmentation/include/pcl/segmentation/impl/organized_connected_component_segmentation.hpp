@@ -41,6 +41,9 @@
 #define PCL_SEGMENTATION_IMPL_ORGANIZED_CONNECTED_COMPONENT_SEGMENTATION_H_
 
 #include <pcl/segmentation/organized_connected_component_segmentation.h>
+#include <pcl/common/execution_context.h>
+
+#include <algorithm>
 
 /**
  *  Directions: 1 2 3
@@ -113,10 +116,32 @@ pcl::OrganizedConnectedComponentSegmentation<PointT, PointLT>::findLabeledRegion
   } while ( curr_idx != start_idx);
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template<typename PointT, typename PointLT> void
+pcl::OrganizedConnectedComponentSegmentation<PointT, PointLT>::setNumberOfThreads (unsigned int nr_threads)
+{
+  // 0 is resolved against the budget of pcl::ExecutionContext at compute time
+  threads_ = nr_threads;
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 template<typename PointT, typename PointLT> void
 pcl::OrganizedConnectedComponentSegmentation<PointT, PointLT>::segment (pcl::PointCloud<PointLT>& labels, std::vector<pcl::PointIndices>& label_indices) const
 {
+  const Comparator& comparator = *compare_;
+  segment ([&comparator] (int idx1, int idx2) { return (comparator.compare (idx1, idx2)); }, labels, label_indices);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template<typename PointT, typename PointLT> template <typename CompareFunctor> void
+pcl::OrganizedConnectedComponentSegmentation<PointT, PointLT>::segment (const CompareFunctor& compare, pcl::PointCloud<PointLT>& labels, std::vector<pcl::PointIndices>& label_indices) const
+{
+  if (threads_ != 1 && input_->height > 1)
+  {
+    segmentBlocks (compare, labels, label_indices);
+    return;
+  }
+
   std::vector<unsigned> run_ids;
 
   unsigned invalid_label = std::numeric_limits<unsigned>::max ();
@@ -139,7 +164,7 @@ pcl::OrganizedConnectedComponentSegmentation<PointT, PointLT>::segment (pcl::Poi
   {
     if (!std::isfinite ((*input_)[colIdx].x))
       continue;
-    if (compare_->compare (colIdx, colIdx - 1 ))
+    if (compare (colIdx, colIdx - 1 ))
     {
       labels[colIdx].label = labels[colIdx - 1].label;
     }
@@ -158,7 +183,7 @@ pcl::OrganizedConnectedComponentSegmentation<PointT, PointLT>::segment (pcl::Poi
     // First pixel
     if (std::isfinite ((*input_)[current_row].x))
     {
-      if (compare_->compare (current_row, previous_row))
+      if (compare (current_row, previous_row))
       {
         labels[current_row].label = labels[previous_row].label;
       }
@@ -174,11 +199,11 @@ pcl::OrganizedConnectedComponentSegmentation<PointT, PointLT>::segment (pcl::Poi
     {
       if (std::isfinite ((*input_)[current_row + colIdx].x))
       {
-        if (compare_->compare (current_row + colIdx, current_row + colIdx - 1))
+        if (compare (current_row + colIdx, current_row + colIdx - 1))
         {
           labels[current_row + colIdx].label = labels[current_row + colIdx - 1].label;
         }
-        if (compare_->compare (current_row + colIdx, previous_row + colIdx) )
+        if (compare (current_row + colIdx, previous_row + colIdx) )
         {
           if (labels[current_row + colIdx].label == invalid_label)
             labels[current_row + colIdx].label = labels[previous_row + colIdx].label;
@@ -226,6 +251,95 @@ pcl::OrganizedConnectedComponentSegmentation<PointT, PointLT>::segment (pcl::Poi
   }
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template<typename PointT, typename PointLT> template <typename CompareFunctor> void
+pcl::OrganizedConnectedComponentSegmentation<PointT, PointLT>::segmentBlocks (const CompareFunctor& compare, pcl::PointCloud<PointLT>& labels, std::vector<pcl::PointIndices>& label_indices) const
+{
+  const pcl::ThreadReservation reservation (threads_);
+  const unsigned int threads = reservation.getNumberOfThreads ();
+  const unsigned invalid_label = std::numeric_limits<unsigned>::max ();
+  PointLT invalid_pt;
+  invalid_pt.label = invalid_label;
+  labels.resize (input_->size (), invalid_pt);
+  labels.width = input_->width;
+  labels.height = input_->height;
+
+  const int width = static_cast<int> (input_->width);
+  const int height = static_cast<int> (input_->height);
+  const int num_pixels = width * height;
+
+  // Union-find forest over the pixels, unlabeled pixels are marked as invalid. Every tree is rooted at its
+  // first pixel in row-major order, which gives the components the same ordering as the sequential scan.
+  std::vector<unsigned> parent (num_pixels);
+#pragma omp parallel for \
+  default(none) \
+  shared(parent) \
+  firstprivate(num_pixels, invalid_label) \
+  num_threads(threads)
+  for (int idx = 0; idx < num_pixels; ++idx)
+    parent[idx] = std::isfinite ((*input_)[idx].x) ? static_cast<unsigned> (idx) : invalid_label;
+
+  // The sequential scan copies the label of a matching neighbour, so a pixel of the first row or column that
+  // matches an unlabeled left resp. upper neighbour stays unlabeled itself
+  for (int col = 1; col < width; ++col)
+    if (parent[col] != invalid_label && parent[col - 1] == invalid_label && compare (col, col - 1))
+      parent[col] = invalid_label;
+  for (int idx = width; idx < num_pixels; idx += width)
+    if (parent[idx] != invalid_label && parent[idx - width] == invalid_label && compare (idx, idx - width))
+      parent[idx] = invalid_label;
+
+  // First pass: every block of rows is labeled independently, the trees do not leave the block
+  const int num_blocks = std::min (height, 4 * static_cast<int> (threads));
+#pragma omp parallel for \
+  default(none) \
+  shared(compare, parent) \
+  firstprivate(width, height, num_blocks, invalid_label) \
+  schedule(dynamic, 1) \
+  num_threads(threads)
+  for (int block = 0; block < num_blocks; ++block)
+  {
+    const int row_begin = block * height / num_blocks;
+    const int row_end = (block + 1) * height / num_blocks;
+    for (int row = row_begin; row < row_end; ++row)
+    {
+      for (int col = 0; col < width; ++col)
+      {
+        const int idx = row * width + col;
+        if (parent[idx] == invalid_label)
+          continue;
+        if (col > 0 && parent[idx - 1] != invalid_label && compare (idx, idx - 1))
+          uniteRoots (parent, idx, idx - 1);
+        if (row > row_begin && parent[idx - width] != invalid_label && compare (idx, idx - width))
+          uniteRoots (parent, idx, idx - width);
+      }
+    }
+  }
+
+  // Second pass: merge the first row of every block with the last row of the block above it
+  for (int block = 1; block < num_blocks; ++block)
+  {
+    const int row_begin = block * height / num_blocks;
+    for (int idx = row_begin * width; idx < (row_begin + 1) * width; ++idx)
+      if (parent[idx] != invalid_label && parent[idx - width] != invalid_label && compare (idx, idx - width))
+        uniteRoots (parent, idx, idx - width);
+  }
+
+  // Number the components in the order of their roots, a root always precedes the rest of its tree
+  unsigned max_id = 0;
+  for (int idx = 0; idx < num_pixels; ++idx)
+  {
+    if (parent[idx] == invalid_label)
+      continue;
+    const unsigned root = findRootHalving (parent, idx);
+    labels[idx].label = (root == static_cast<unsigned> (idx)) ? max_id++ : labels[root].label;
+  }
+
+  label_indices.resize (max_id + 1);
+  for (int idx = 0; idx < num_pixels; ++idx)
+    if (labels[idx].label != invalid_label)
+      label_indices[labels[idx].label].indices.push_back (idx);
+}
+
 #define PCL_INSTANTIATE_OrganizedConnectedComponentSegmentation(T,LT) template class PCL_EXPORTS pcl::OrganizedConnectedComponentSegmentation<T,LT>;
 
 #endif //#ifndef PCL_SEGMENTATION_IMPL_ORGANIZED_CONNECTED_COMPONENT_SEGMENTATION_H_
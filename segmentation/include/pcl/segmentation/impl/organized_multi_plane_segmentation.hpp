@@ -42,8 +42,12 @@
 
 #include <pcl/segmentation/organized_connected_component_segmentation.h>
 #include <pcl/segmentation/organized_multi_plane_segmentation.h>
+#include <pcl/segmentation/impl/organized_connected_component_segmentation.hpp> // for the templated segment
 #include <pcl/common/centroid.h>
 #include <pcl/common/eigen.h>
+#include <pcl/common/execution_context.h>
+
+#include <typeinfo>
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointT> pcl::PointCloud<PointT>
@@ -66,6 +70,14 @@ projectToPlaneFromViewpoint (pcl::PointCloud<PointT>& cloud, Eigen::Vector4f& no
   return (projected_cloud);
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template<typename PointT, typename PointNT, typename PointLT> void
+pcl::OrganizedMultiPlaneSegmentation<PointT, PointNT, PointLT>::setNumberOfThreads (unsigned int nr_threads)
+{
+  // 0 is resolved against the budget of pcl::ExecutionContext at compute time
+  threads_ = nr_threads;
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 template<typename PointT, typename PointNT, typename PointLT> void
 pcl::OrganizedMultiPlaneSegmentation<PointT, PointNT, PointLT>::segment (std::vector<ModelCoefficients>& model_coefficients, 
@@ -130,32 +142,65 @@ pcl::OrganizedMultiPlaneSegmentation<PointT, PointNT, PointLT>::segment (std::ve
   compare_->setAngularThreshold (static_cast<float> (angular_threshold_));
   compare_->setDistanceThreshold (static_cast<float> (distance_threshold_), true);
 
+  // The connected component segmentation shares this reservation
+  const pcl::ThreadReservation reservation (threads_);
+  const unsigned int threads = reservation.getNumberOfThreads ();
+
   // Set up the output
   OrganizedConnectedComponentSegmentation<PointT,PointLT> connected_component (compare_);
   connected_component.setInputCloud (input_);
-  connected_component.segment (labels, label_indices);
+  connected_component.setNumberOfThreads (threads_);
+  // Unless the comparator was replaced by a derived one, avoid the virtual call per pixel
+  if (typeid (*compare_) == typeid (PlaneComparator))
+    connected_component.segment (ComparatorFunctor<PlaneComparator> (*compare_), labels, label_indices);
+  else
+    connected_component.segment (labels, label_indices);
+
+  // Compute the moments and the plane fit of all large enough clusters at once
+  const int num_labels = static_cast<int> (label_indices.size ());
+  std::vector<Eigen::Vector4f, Eigen::aligned_allocator<Eigen::Vector4f> > clust_centroids (num_labels, Eigen::Vector4f::Zero ());
+  std::vector<Eigen::Matrix3f, Eigen::aligned_allocator<Eigen::Matrix3f> > clust_covs (num_labels);
+  std::vector<Eigen::Vector4f, Eigen::aligned_allocator<Eigen::Vector4f> > clust_planes (num_labels);
+  std::vector<float> clust_curvatures (num_labels);
+  const unsigned min_inliers = min_inliers_;
+#pragma omp parallel for \
+  default(none) \
+  shared(label_indices, clust_centroids, clust_covs, clust_planes, clust_curvatures) \
+  firstprivate(num_labels, min_inliers) \
+  schedule(dynamic, 1) \
+  num_threads(threads)
+  for (int i = 0; i < num_labels; ++i)
+  {
+    if (static_cast<unsigned> (label_indices[i].indices.size ()) <= min_inliers)
+      continue;
+    pcl::computeMeanAndCovarianceMatrix (*input_, label_indices[i].indices, clust_covs[i], clust_centroids[i]);
+
+    EIGEN_ALIGN16 Eigen::Vector3f::Scalar eigen_value;
+    EIGEN_ALIGN16 Eigen::Vector3f eigen_vector;
+    pcl::eigen33 (clust_covs[i], eigen_value, eigen_vector);
+    clust_planes[i] << eigen_vector[0], eigen_vector[1], eigen_vector[2], 0.0f;
+
+    // Compute the curvature surface change
+    float eig_sum = clust_covs[i].coeff (0) + clust_covs[i].coeff (4) + clust_covs[i].coeff (8);
+    if (eig_sum != 0)
+      clust_curvatures[i] = std::abs (eigen_value / eig_sum);
+    else
+      clust_curvatures[i] = 0;
+  }
 
-  Eigen::Vector4f clust_centroid = Eigen::Vector4f::Zero ();
   Eigen::Vector4f vp = Eigen::Vector4f::Zero ();
-  Eigen::Matrix3f clust_cov;
   pcl::ModelCoefficients model;
   model.values.resize (4);
 
   // Fit Planes to each cluster
-  for (const auto &label_index : label_indices)
+  for (int i = 0; i < num_labels; ++i)
   {
+    const auto &label_index = label_indices[i];
     if (static_cast<unsigned> (label_index.indices.size ()) > min_inliers_)
     {
-      pcl::computeMeanAndCovarianceMatrix (*input_, label_index.indices, clust_cov, clust_centroid);
-      Eigen::Vector4f plane_params;
-      
-      EIGEN_ALIGN16 Eigen::Vector3f::Scalar eigen_value;
-      EIGEN_ALIGN16 Eigen::Vector3f eigen_vector;
-      pcl::eigen33 (clust_cov, eigen_value, eigen_vector);
-      plane_params[0] = eigen_vector[0];
-      plane_params[1] = eigen_vector[1];
-      plane_params[2] = eigen_vector[2];
-      plane_params[3] = 0;
+      const Eigen::Vector4f &clust_centroid = clust_centroids[i];
+      const Eigen::Matrix3f &clust_cov = clust_covs[i];
+      Eigen::Vector4f plane_params = clust_planes[i];
       plane_params[3] = -1 * plane_params.dot (clust_centroid);
 
       vp -= clust_centroid;
@@ -166,16 +211,8 @@ pcl::OrganizedMultiPlaneSegmentation<PointT, PointNT, PointLT>::segment (std::ve
         plane_params[3] = 0;
         plane_params[3] = -1 * plane_params.dot (clust_centroid);
       }
-      
-      // Compute the curvature surface change
-      float curvature;
-      float eig_sum = clust_cov.coeff (0) + clust_cov.coeff (4) + clust_cov.coeff (8);
-      if (eig_sum != 0)
-        curvature = std::abs (eigen_value / eig_sum);
-      else
-        curvature = 0;
-
-      if (curvature < maximum_curvature_)
+
+      if (clust_curvatures[i] < maximum_curvature_)
       {
         model.values[0] = plane_params[0];
         model.values[1] = plane_params[1];
@@ -55,7 +55,8 @@ pcl::ProgressiveMorphologicalFilter<PointT>::ProgressiveMorphologicalFilter () :
   initial_distance_ (0.15f),
   cell_size_ (1.0f),
   base_ (2.0f),
-  exponential_ (true)
+  exponential_ (true),
+  use_grid_ (false)
 {
 }
 
@@ -111,6 +112,16 @@ pcl::ProgressiveMorphologicalFilter<PointT>::extract (Indices& ground)
   // wish to process
   ground = *indices_;
 
+  // In grid mode the points are binned into a fixed grid covering the input
+  Eigen::Vector4f global_min, global_max;
+  int rows = 0, cols = 0;
+  if (use_grid_)
+  {
+    pcl::getMinMax3D<PointT> (*input_, ground, global_min, global_max);
+    rows = static_cast<int> (std::floor ((global_max.y () - global_min.y ()) / cell_size_) + 1);
+    cols = static_cast<int> (std::floor ((global_max.x () - global_min.x ()) / cell_size_) + 1);
+  }
+
   // Progressively filter ground returns using morphological open
   for (std::size_t i = 0; i < window_sizes.size (); ++i)
   {
@@ -124,7 +135,34 @@ pcl::ProgressiveMorphologicalFilter<PointT>::extract (Indices& ground)
     // Create new cloud to hold the filtered results. Apply the morphological
     // opening operation at the current window size.
     typename pcl::PointCloud<PointT>::Ptr cloud_f (new pcl::PointCloud<PointT>);
-    pcl::applyMorphologicalOperator<PointT> (cloud, window_sizes[i], MORPH_OPEN, *cloud_f);
+    if (use_grid_)
+    {
+      // Lowest height of the ground points in each cell
+      Eigen::MatrixXf grid (rows, cols);
+      grid.setConstant (std::numeric_limits<float>::quiet_NaN ());
+      std::vector<Eigen::Index> cells (cloud->size ());
+      for (std::size_t p_idx = 0; p_idx < cloud->size (); ++p_idx)
+      {
+        const PointT &p = (*cloud)[p_idx];
+        const int row = static_cast<int> (std::floor ((p.y - global_min.y ()) / cell_size_));
+        const int col = static_cast<int> (std::floor ((p.x - global_min.x ()) / cell_size_));
+        cells[p_idx] = static_cast<Eigen::Index> (col) * rows + row;
+        float &cell = grid.data ()[cells[p_idx]];
+        if (p.z < cell || std::isnan (cell))
+          cell = p.z;
+      }
+
+      // The window of window_size centered on a point covers half_size cells to each side
+      const int half_size = static_cast<int> (std::floor (0.5f * (window_sizes[i] / cell_size_ - 1.0f) + 0.5f));
+      Eigen::MatrixXf grid_f;
+      pcl::applyMorphologicalOperator (grid, half_size, MORPH_OPEN, grid_f);
+
+      *cloud_f = *cloud;
+      for (std::size_t p_idx = 0; p_idx < cloud->size (); ++p_idx)
+        (*cloud_f)[p_idx].z = grid_f.data ()[cells[p_idx]];
+    }
+    else
+      pcl::applyMorphologicalOperator<PointT> (cloud, window_sizes[i], MORPH_OPEN, *cloud_f);
 
     // Find indices of the points whose difference between the source and
     // filtered point clouds is less than the current height threshold.
@@ -38,9 +38,18 @@
 #ifndef PCL_SEGMENTATION_IMPL_RANDOM_WALKER_HPP
 #define PCL_SEGMENTATION_IMPL_RANDOM_WALKER_HPP
 
+#include <pcl/common/execution_context.h>
+
 #include <boost/bimap.hpp>
 
 #include <Eigen/Sparse>
+#if EIGEN_VERSION_AT_LEAST (3, 3, 0)
+#include <Eigen/IterativeLinearSolvers> // for IncompleteCholesky
+#endif
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
 
 namespace pcl
 {
@@ -80,17 +89,33 @@ namespace pcl
           using SparseMatrix = Eigen::SparseMatrix<Weight>;
           using Matrix = Eigen::Matrix<Weight, Eigen::Dynamic, Eigen::Dynamic>;
           using Vector = Eigen::Matrix<Weight, Eigen::Dynamic, 1>;
+          // The conjugate gradient solver works in double precision on row major
+          // storage, so that each vertex is a contiguous row
+          using SolverSparseMatrix = Eigen::SparseMatrix<double, Eigen::RowMajor>;
+          using SolverMatrix = Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>;
 
-          RandomWalker (Graph& g, EdgeWeightMap weights, VertexColorMap colors)
+          RandomWalker (Graph& g, EdgeWeightMap weights, VertexColorMap colors,
+                        const RandomWalkerParameters& parameters = RandomWalkerParameters ())
           : g_ (g)
           , weight_map_ (weights)
           , color_map_ (colors)
           , index_map_ (boost::get (boost::vertex_index, g_))
+          , parameters_ (parameters)
           , degree_storage_ (boost::num_vertices (g_), 0)
           , degree_map_ (boost::make_iterator_property_map (degree_storage_.begin (), index_map_))
           {
           }
 
+          /** \brief Use potentials as returned by getPotentials() as the initial guess of
+            * the conjugate gradient solver. Both have to stay valid until segment() returns.
+            */
+          void
+          setInitialPotentials (const Matrix& potentials, const std::map<Color, std::size_t>& color_to_column_map)
+          {
+            initial_potentials_ = &potentials;
+            initial_color_to_column_map_ = &color_to_column_map;
+          }
+
           bool
           segment ()
           {
@@ -185,11 +210,25 @@ namespace pcl
           bool solveLinearSystem()
           {
             X.resize (L.rows (), B.cols ());
+            num_iterations_ = 0;
 
             // Nothing to solve
             if (L.rows () == 0 || B.cols () == 0)
               return true;
 
+            bool succeeded;
+            if (parameters_.solver == RANDOM_WALKER_CONJUGATE_GRADIENT)
+              succeeded = solveConjugateGradient ();
+            else
+              succeeded = solveCholesky ();
+
+            assignColors ();
+            return succeeded;
+          }
+
+          bool
+          solveCholesky ()
+          {
             Eigen::SimplicialCholesky<SparseMatrix, Eigen::Lower> cg;
             cg.compute (L);
             bool succeeded = true;
@@ -200,11 +239,288 @@ namespace pcl
               if (cg.info () != Eigen::Success)
                 succeeded = false;
             }
+            return succeeded;
+          }
 
-            assignColors ();
+          /** \brief Solve L X = B with a preconditioned conjugate gradient per column of B.
+            *
+            * The columns are iterated together, so that each iteration is a single pass of
+            * the Laplacian over all colors. Dot products are summed over fixed blocks of
+            * rows in order, the result does not depend on the number of threads.
+            */
+          bool
+          solveConjugateGradient ()
+          {
+            const Eigen::Index rows = L.rows ();
+            const Eigen::Index cols = B.cols ();
+            // 0 is resolved against the budget of pcl::ExecutionContext
+            const pcl::ThreadReservation reservation (parameters_.nr_threads);
+            const unsigned int threads = reservation.getNumberOfThreads ();
+
+            // L only holds the lower triangle
+            const SparseMatrix full = L.template selfadjointView<Eigen::Lower> ();
+            const SolverSparseMatrix A = full.template cast<double> ();
+            const SolverMatrix rhs = SolverMatrix (B.template cast<double> ());
+            const Eigen::VectorXd inverse_diagonal = A.diagonal ().cwiseInverse ();
+
+#if EIGEN_VERSION_AT_LEAST (3, 3, 0)
+            // Falls back to Jacobi if the factorization fails
+            IncompleteCholesky ichol;
+            bool incomplete_cholesky = false;
+            if (parameters_.preconditioner == RANDOM_WALKER_INCOMPLETE_CHOLESKY)
+            {
+              ichol.compute (Eigen::SparseMatrix<double> (A));
+              incomplete_cholesky = (ichol.info () == Eigen::Success);
+            }
+#endif
+
+            const Eigen::Index block_size = rows_per_block;
+            const Eigen::Index num_blocks = (rows + block_size - 1) / block_size;
+            SolverMatrix partial (num_blocks, cols);
+
+            SolverMatrix x = SolverMatrix::Zero (rows, cols);
+            if (initial_potentials_)
+              copyInitialGuess (x);
+
+            SolverMatrix r (rows, cols);
+            multiply (A, x, r, partial, threads);
+            r = rhs - r;
+
+            Eigen::RowVectorXd thresholds (cols);
+            for (Eigen::Index j = 0; j < cols; ++j)
+              thresholds[j] = parameters_.tolerance * parameters_.tolerance * rhs.col (j).squaredNorm ();
+            std::vector<bool> converged (cols, false);
+            const auto update_convergence = [&] (const Eigen::RowVectorXd& squared_norms)
+            {
+              bool all = true;
+              for (Eigen::Index j = 0; j < cols; ++j)
+              {
+                converged[j] = converged[j] || squared_norms[j] <= thresholds[j];
+                all = all && converged[j];
+              }
+              return all;
+            };
+
+            SolverMatrix z (rows, cols);
+            SolverMatrix q (rows, cols);
+            const auto precondition = [&] ()
+            {
+#if EIGEN_VERSION_AT_LEAST (3, 3, 0)
+              if (incomplete_cholesky)
+                return (applyIncompleteCholesky (ichol, r, z, partial, threads));
+#endif
+              return (applyJacobi (inverse_diagonal, r, z, partial, threads));
+            };
+            Eigen::RowVectorXd rz = precondition ();
+            SolverMatrix p = z;
+
+            bool succeeded = update_convergence (squaredNorms (r, partial, threads));
+            Eigen::RowVectorXd alpha (cols);
+            Eigen::RowVectorXd beta (cols);
+            while (!succeeded && num_iterations_ < parameters_.max_iterations)
+            {
+              const Eigen::RowVectorXd pq = multiply (A, p, q, partial, threads);
+              for (Eigen::Index j = 0; j < cols; ++j)
+              {
+                // A vanishing curvature means that the residual of the column vanished
+                if (pq[j] <= 0.0)
+                  converged[j] = true;
+                alpha[j] = (converged[j] ? 0.0 : rz[j] / pq[j]);
+              }
+
+#pragma omp parallel for \
+  default(none) \
+  shared(alpha, p, partial, q, r, x) \
+  firstprivate(rows, cols, num_blocks, block_size) \
+  num_threads(threads)
+              for (std::ptrdiff_t b = 0; b < num_blocks; ++b)
+              {
+                partial.row (b).setZero ();
+                const Eigen::Index end = std::min<Eigen::Index> ((b + 1) * block_size, rows);
+                for (Eigen::Index i = b * block_size; i < end; ++i)
+                  for (Eigen::Index j = 0; j < cols; ++j)
+                  {
+                    x (i, j) += alpha[j] * p (i, j);
+                    r (i, j) -= alpha[j] * q (i, j);
+                    partial (b, j) += r (i, j) * r (i, j);
+                  }
+              }
+              ++num_iterations_;
+              if (update_convergence (partial.colwise ().sum ()))
+              {
+                succeeded = true;
+                break;
+              }
+
+              const Eigen::RowVectorXd rz_new = precondition ();
+              for (Eigen::Index j = 0; j < cols; ++j)
+                beta[j] = (converged[j] || rz[j] == 0.0 ? 0.0 : rz_new[j] / rz[j]);
+              rz = rz_new;
+
+#pragma omp parallel for \
+  default(none) \
+  shared(beta, p, z) \
+  firstprivate(rows, cols, num_blocks, block_size) \
+  num_threads(threads)
+              for (std::ptrdiff_t b = 0; b < num_blocks; ++b)
+              {
+                const Eigen::Index end = std::min<Eigen::Index> ((b + 1) * block_size, rows);
+                for (Eigen::Index i = b * block_size; i < end; ++i)
+                  for (Eigen::Index j = 0; j < cols; ++j)
+                    p (i, j) = z (i, j) + beta[j] * p (i, j);
+              }
+            }
+
+            X = x.template cast<Weight> ();
             return succeeded;
           }
 
+          /** \brief Fill the initial guess of the conjugate gradient solver from the
+            * potentials set with setInitialPotentials(). Vertices and colors that are not
+            * part of them start from zero.
+            */
+          void
+          copyInitialGuess (SolverMatrix& x) const
+          {
+            for (Eigen::Index j = 0; j < x.cols (); ++j)
+            {
+              const auto column = initial_color_to_column_map_->find (B_color_bimap.left.at (j));
+              if (column == initial_color_to_column_map_->end () ||
+                  static_cast<Eigen::Index> (column->second) >= initial_potentials_->cols ())
+                continue;
+              for (Eigen::Index i = 0; i < x.rows (); ++i)
+              {
+                const auto vertex = static_cast<Eigen::Index> (index_map_[L_vertex_bimap.left.at (i)]);
+                if (vertex < initial_potentials_->rows ())
+                  x (i, j) = (*initial_potentials_) (vertex, column->second);
+              }
+            }
+          }
+
+          // The helpers below loop over the dense rows by hand, they have one entry per
+          // color and are too short for Eigen block expressions to pay off
+
+          /** \brief Compute q = A p in parallel, returns the dot products of the columns of p and q. */
+          static Eigen::RowVectorXd
+          multiply (const SolverSparseMatrix& A, const SolverMatrix& p, SolverMatrix& q,
+                    SolverMatrix& partial, unsigned int threads)
+          {
+            const Eigen::Index rows = p.rows ();
+            const Eigen::Index cols = p.cols ();
+            const Eigen::Index num_blocks = partial.rows ();
+            const Eigen::Index block_size = rows_per_block;
+#pragma omp parallel for \
+  default(none) \
+  shared(A, p, partial, q) \
+  firstprivate(rows, cols, num_blocks, block_size) \
+  num_threads(threads)
+            for (std::ptrdiff_t b = 0; b < num_blocks; ++b)
+            {
+              const Eigen::Index begin = b * block_size;
+              const Eigen::Index size = std::min<Eigen::Index> (block_size, rows - begin);
+              q.middleRows (begin, size).noalias () = A.middleRows (begin, size) * p;
+              partial.row (b).setZero ();
+              for (Eigen::Index i = begin; i < begin + size; ++i)
+                for (Eigen::Index j = 0; j < cols; ++j)
+                  partial (b, j) += p (i, j) * q (i, j);
+            }
+            return (partial.colwise ().sum ());
+          }
+
+          /** \brief Compute the squared norms of the columns of r. */
+          static Eigen::RowVectorXd
+          squaredNorms (const SolverMatrix& r, SolverMatrix& partial, unsigned int threads)
+          {
+            const Eigen::Index rows = r.rows ();
+            const Eigen::Index cols = r.cols ();
+            const Eigen::Index num_blocks = partial.rows ();
+            const Eigen::Index block_size = rows_per_block;
+#pragma omp parallel for \
+  default(none) \
+  shared(partial, r) \
+  firstprivate(rows, cols, num_blocks, block_size) \
+  num_threads(threads)
+            for (std::ptrdiff_t b = 0; b < num_blocks; ++b)
+            {
+              partial.row (b).setZero ();
+              const Eigen::Index end = std::min<Eigen::Index> ((b + 1) * block_size, rows);
+              for (Eigen::Index i = b * block_size; i < end; ++i)
+                for (Eigen::Index j = 0; j < cols; ++j)
+                  partial (b, j) += r (i, j) * r (i, j);
+            }
+            return (partial.colwise ().sum ());
+          }
+
+          /** \brief Compute z = M^-1 r with the Jacobi preconditioner M, returns the dot
+            * products of the columns of r and z.
+            */
+          static Eigen::RowVectorXd
+          applyJacobi (const Eigen::VectorXd& inverse_diagonal, const SolverMatrix& r, SolverMatrix& z,
+                       SolverMatrix& partial, unsigned int threads)
+          {
+            const Eigen::Index rows = r.rows ();
+            const Eigen::Index cols = r.cols ();
+            const Eigen::Index num_blocks = partial.rows ();
+            const Eigen::Index block_size = rows_per_block;
+#pragma omp parallel for \
+  default(none) \
+  shared(inverse_diagonal, partial, r, z) \
+  firstprivate(rows, cols, num_blocks, block_size) \
+  num_threads(threads)
+            for (std::ptrdiff_t b = 0; b < num_blocks; ++b)
+            {
+              partial.row (b).setZero ();
+              const Eigen::Index end = std::min<Eigen::Index> ((b + 1) * block_size, rows);
+              for (Eigen::Index i = b * block_size; i < end; ++i)
+                for (Eigen::Index j = 0; j < cols; ++j)
+                {
+                  z (i, j) = inverse_diagonal[i] * r (i, j);
+                  partial (b, j) += r (i, j) * z (i, j);
+                }
+            }
+            return (partial.colwise ().sum ());
+          }
+
+#if EIGEN_VERSION_AT_LEAST (3, 3, 0)
+          using IncompleteCholesky = Eigen::IncompleteCholesky<double, Eigen::Lower, Eigen::AMDOrdering<int> >;
+
+          /** \brief Compute z = M^-1 r with the incomplete Cholesky factorization M,
+            * returns the dot products of the columns of r and z. The triangular solves are
+            * sequential, so the colors are distributed over the threads.
+            */
+          static Eigen::RowVectorXd
+          applyIncompleteCholesky (const IncompleteCholesky& ichol, const SolverMatrix& r, SolverMatrix& z,
+                                   SolverMatrix& partial, unsigned int threads)
+          {
+            const Eigen::Index rows = r.rows ();
+            const Eigen::Index cols = r.cols ();
+#pragma omp parallel for \
+  default(none) \
+  shared(ichol, r, z) \
+  firstprivate(cols) \
+  num_threads(threads)
+            for (std::ptrdiff_t j = 0; j < cols; ++j)
+              z.col (j) = ichol.solve (Eigen::VectorXd (r.col (j)));
+
+            const Eigen::Index num_blocks = partial.rows ();
+            const Eigen::Index block_size = rows_per_block;
+#pragma omp parallel for \
+  default(none) \
+  shared(partial, r, z) \
+  firstprivate(rows, cols, num_blocks, block_size) \
+  num_threads(threads)
+            for (std::ptrdiff_t b = 0; b < num_blocks; ++b)
+            {
+              partial.row (b).setZero ();
+              const Eigen::Index end = std::min<Eigen::Index> ((b + 1) * block_size, rows);
+              for (Eigen::Index i = b * block_size; i < end; ++i)
+                for (Eigen::Index j = 0; j < cols; ++j)
+                  partial (b, j) += r (i, j) * z (i, j);
+            }
+            return (partial.colwise ().sum ());
+          }
+#endif
+
           void
           assignColors ()
           {
@@ -253,10 +569,20 @@ namespace pcl
             return s;
           }
 
+          /** \brief The number of rows over which the conjugate gradient solver sums dot products. */
+          static constexpr Eigen::Index rows_per_block = 1024;
+
           Graph& g_;
           EdgeWeightMap weight_map_;
           VertexColorMap color_map_;
           VertexIndexMap index_map_;
+          RandomWalkerParameters parameters_;
+
+          // Initial guess of the conjugate gradient solver, see setInitialPotentials()
+          const Matrix* initial_potentials_ = nullptr;
+          const std::map<Color, std::size_t>* initial_color_to_column_map_ = nullptr;
+          // Number of iterations of the last conjugate gradient solve
+          unsigned int num_iterations_ = 0;
 
           std::vector<VertexDescriptor> seeds_;
           std::set<Color> colors_;
@@ -340,6 +666,66 @@ namespace pcl
       return result;
     }
 
+    template <class Graph, class EdgeWeightMap, class VertexColorMap> bool
+    randomWalker (Graph& graph,
+                  EdgeWeightMap weights,
+                  VertexColorMap colors,
+                  const RandomWalkerParameters& parameters)
+    {
+      using namespace boost;
+
+      using EdgeDescriptor = typename graph_traits<Graph>::edge_descriptor;
+      using VertexDescriptor = typename graph_traits<Graph>::vertex_descriptor;
+
+      BOOST_CONCEPT_ASSERT ((VertexListGraphConcept<Graph>));                                 // to have vertices(), num_vertices()
+      BOOST_CONCEPT_ASSERT ((EdgeListGraphConcept<Graph>));                                   // to have edges()
+      BOOST_CONCEPT_ASSERT ((IncidenceGraphConcept<Graph>));                                  // to have source(), target() and out_edges()
+      BOOST_CONCEPT_ASSERT ((ReadablePropertyMapConcept<EdgeWeightMap, EdgeDescriptor>));     // read weight-values from edges
+      BOOST_CONCEPT_ASSERT ((ReadWritePropertyMapConcept<VertexColorMap, VertexDescriptor>)); // read and write color-values from vertices
+
+      ::pcl::segmentation::detail::RandomWalker
+      <
+        Graph,
+        EdgeWeightMap,
+        VertexColorMap
+      >
+      rw (graph, weights, colors, parameters);
+      return rw.segment ();
+    }
+
+    template <class Graph, class EdgeWeightMap, class VertexColorMap> bool
+    randomWalker (Graph& graph,
+                  EdgeWeightMap weights,
+                  VertexColorMap colors,
+                  Eigen::Matrix<typename boost::property_traits<EdgeWeightMap>::value_type, Eigen::Dynamic, Eigen::Dynamic>& potentials,
+                  std::map<typename boost::property_traits<VertexColorMap>::value_type, std::size_t>& colors_to_columns_map,
+                  const RandomWalkerParameters& parameters)
+    {
+      using namespace boost;
+
+      using EdgeDescriptor = typename graph_traits<Graph>::edge_descriptor;
+      using VertexDescriptor = typename graph_traits<Graph>::vertex_descriptor;
+
+      BOOST_CONCEPT_ASSERT ((VertexListGraphConcept<Graph>));                                 // to have vertices(), num_vertices()
+      BOOST_CONCEPT_ASSERT ((EdgeListGraphConcept<Graph>));                                   // to have edges()
+      BOOST_CONCEPT_ASSERT ((IncidenceGraphConcept<Graph>));                                  // to have source(), target() and out_edges()
+      BOOST_CONCEPT_ASSERT ((ReadablePropertyMapConcept<EdgeWeightMap, EdgeDescriptor>));     // read weight-values from edges
+      BOOST_CONCEPT_ASSERT ((ReadWritePropertyMapConcept<VertexColorMap, VertexDescriptor>)); // read and write color-values from vertices
+
+      ::pcl::segmentation::detail::RandomWalker
+      <
+        Graph,
+        EdgeWeightMap,
+        VertexColorMap
+      >
+      rw (graph, weights, colors, parameters);
+      if (parameters.warm_start)
+        rw.setInitialPotentials (potentials, colors_to_columns_map);
+      bool result = rw.segment ();
+      rw.getPotentials (potentials, colors_to_columns_map);
+      return result;
+    }
+
   }
 
 }
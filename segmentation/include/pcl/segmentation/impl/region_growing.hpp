@@ -43,11 +43,13 @@
 
 #include <pcl/point_cloud.h>
 #include <pcl/point_types.h>
+#include <pcl/common/execution_context.h>
 #include <pcl/common/point_tests.h> // for pcl::isFinite
 #include <pcl/console/print.h> // for PCL_ERROR
 #include <pcl/search/search.h>
 #include <pcl/search/kdtree.h>
 
+#include <algorithm>
 #include <queue>
 #include <cmath>
 #include <ctime>
@@ -66,12 +68,13 @@ pcl::RegionGrowing<PointT, NormalT>::RegionGrowing () :
   neighbour_number_ (30),
   search_ (),
   normals_ (),
-  point_neighbours_ (0),
+  point_neighbours_ (),
   point_labels_ (0),
   normal_flag_ (true),
   num_pts_in_segment_ (0),
   clusters_ (0),
-  number_of_segments_ (0)
+  number_of_segments_ (0),
+  threads_ (1)
 {
 }
 
@@ -231,6 +234,45 @@ pcl::RegionGrowing<PointT, NormalT>::setSearchMethod (const KdTreePtr& tree)
   search_ = tree;
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT, typename NormalT> void
+pcl::RegionGrowing<PointT, NormalT>::setNumberOfThreads (unsigned int nr_threads)
+{
+  // 0 is resolved against the budget of pcl::ExecutionContext at compute time
+  threads_ = nr_threads;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT, typename NormalT> unsigned int
+pcl::RegionGrowing<PointT, NormalT>::getNumberOfThreads () const
+{
+  return (threads_);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT, typename NormalT> std::size_t
+pcl::RegionGrowing<PointT, NormalT>::getMemoryUsage () const
+{
+  std::size_t bytes = point_neighbours_.getMemoryUsage ();
+  bytes += point_labels_.capacity () * sizeof (int);
+  bytes += num_pts_in_segment_.capacity () * sizeof (pcl::uindex_t);
+  bytes += clusters_.capacity () * sizeof (pcl::PointIndices);
+  for (const auto& cluster : clusters_)
+    bytes += cluster.indices.capacity () * sizeof (pcl::index_t);
+  return (bytes);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT, typename NormalT> std::size_t
+pcl::RegionGrowing<PointT, NormalT>::estimateMemoryUsage (std::size_t nr_points, unsigned int neighbour_number)
+{
+  // the neighbour lists are allocated at full size before the search and only shrunk afterwards
+  const std::size_t neighbours = (nr_points + 1) * sizeof (std::size_t) + nr_points * neighbour_number * sizeof (pcl::index_t);
+  const std::size_t labels = nr_points * sizeof (int);
+  const std::size_t clusters = nr_points * (sizeof (pcl::index_t) + sizeof (pcl::uindex_t) + sizeof (pcl::PointIndices));
+  return (neighbours + labels + clusters);
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointT, typename NormalT> typename pcl::RegionGrowing<PointT, NormalT>::NormalPtr
 pcl::RegionGrowing<PointT, NormalT>::getInputNormals () const
@@ -342,33 +384,36 @@ pcl::RegionGrowing<PointT, NormalT>::prepareForSegmentation ()
 template <typename PointT, typename NormalT> void
 pcl::RegionGrowing<PointT, NormalT>::findPointNeighbours ()
 {
-  int point_number = static_cast<int> (indices_->size ());
-  pcl::Indices neighbours;
-  std::vector<float> distances;
-
-  point_neighbours_.resize (input_->size (), neighbours);
-  if (input_->is_dense)
+  const int point_number = static_cast<int> (indices_->size ());
+
+  // Every point gets room for neighbour_number_ neighbours, the lists are filled concurrently
+  // and compacted afterwards in case the search returned fewer neighbours
+  std::vector<std::size_t> sizes (input_->size (), 0);
+  for (const auto& point_index : *indices_)
+    if (input_->is_dense || pcl::isFinite ((*input_)[point_index]))
+      sizes[point_index] = neighbour_number_;
+  point_neighbours_.allocate (sizes);
+
+  const pcl::ThreadReservation reservation (threads_);
+  const unsigned int threads = reservation.getNumberOfThreads ();
+#pragma omp parallel for \
+  default(none) \
+  shared(sizes) \
+  firstprivate(point_number) \
+  schedule(dynamic, 256) \
+  num_threads(threads)
+  for (int i_point = 0; i_point < point_number; i_point++)
   {
-    for (int i_point = 0; i_point < point_number; i_point++)
-    {
-      int point_index = (*indices_)[i_point];
-      neighbours.clear ();
-      search_->nearestKSearch (i_point, neighbour_number_, neighbours, distances);
-      point_neighbours_[point_index].swap (neighbours);
-    }
-  }
-  else
-  {
-    for (int i_point = 0; i_point < point_number; i_point++)
-    {
-      neighbours.clear ();
-      int point_index = (*indices_)[i_point];
-      if (!pcl::isFinite ((*input_)[point_index]))
-        continue;
-      search_->nearestKSearch (i_point, neighbour_number_, neighbours, distances);
-      point_neighbours_[point_index].swap (neighbours);
-    }
+    const auto point_index = (*indices_)[i_point];
+    if (sizes[point_index] == 0)
+      continue;
+    pcl::Indices neighbours;
+    std::vector<float> distances;
+    search_->nearestKSearch (i_point, neighbour_number_, neighbours, distances);
+    sizes[point_index] = std::min<std::size_t> (neighbours.size (), neighbour_number_);
+    std::copy (neighbours.begin (), neighbours.begin () + sizes[point_index], point_neighbours_.data (point_index));
   }
+  point_neighbours_.shrink (sizes);
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -40,11 +40,13 @@
 #ifndef PCL_SEGMENTATION_REGION_GROWING_RGB_HPP_
 #define PCL_SEGMENTATION_REGION_GROWING_RGB_HPP_
 
+#include <pcl/common/execution_context.h>
 #include <pcl/console/print.h> // for PCL_ERROR
 #include <pcl/segmentation/region_growing_rgb.h>
 #include <pcl/search/search.h>
 #include <pcl/search/kdtree.h>
 
+#include <algorithm>
 #include <queue>
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -54,7 +56,7 @@ pcl::RegionGrowingRGB<PointT, NormalT>::RegionGrowingRGB () :
   color_r2r_threshold_ (10.0f),
   distance_threshold_ (0.05f),
   region_neighbour_number_ (100),
-  point_distances_ (0),
+  point_distances_ (),
   segment_neighbours_ (0),
   segment_distances_ (0),
   segment_labels_ (0)
@@ -159,6 +161,22 @@ pcl::RegionGrowingRGB<PointT, NormalT>::setResidualTestFlag (bool value)
   residual_flag_ = value;
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT, typename NormalT> std::size_t
+pcl::RegionGrowingRGB<PointT, NormalT>::getMemoryUsage () const
+{
+  std::size_t bytes = RegionGrowing<PointT, NormalT>::getMemoryUsage ();
+  bytes += point_distances_.getMemoryUsage ();
+  bytes += segment_labels_.capacity () * sizeof (int);
+  bytes += segment_neighbours_.capacity () * sizeof (pcl::Indices);
+  for (const auto& neighbours : segment_neighbours_)
+    bytes += neighbours.capacity () * sizeof (pcl::index_t);
+  bytes += segment_distances_.capacity () * sizeof (std::vector<float>);
+  for (const auto& distances : segment_distances_)
+    bytes += distances.capacity () * sizeof (float);
+  return (bytes);
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointT, typename NormalT> void
 pcl::RegionGrowingRGB<PointT, NormalT>::extract (std::vector <pcl::PointIndices>& clusters)
@@ -272,22 +290,36 @@ pcl::RegionGrowingRGB<PointT, NormalT>::prepareForSegmentation ()
 template <typename PointT, typename NormalT> void
 pcl::RegionGrowingRGB<PointT, NormalT>::findPointNeighbours ()
 {
-  int point_number = static_cast<int> (indices_->size ());
-  pcl::Indices neighbours;
-  std::vector<float> distances;
-
-  point_neighbours_.resize (input_->size (), neighbours);
-  point_distances_.resize (input_->size (), distances);
-
+  const int point_number = static_cast<int> (indices_->size ());
+
+  // Every point gets room for region_neighbour_number_ neighbours, the lists are filled
+  // concurrently and compacted afterwards in case the search returned fewer neighbours
+  std::vector<std::size_t> sizes (input_->size (), 0);
+  for (const auto& point_index : *indices_)
+    sizes[point_index] = region_neighbour_number_;
+  point_neighbours_.allocate (sizes);
+  point_distances_.allocate (sizes);
+
+  const pcl::ThreadReservation reservation (threads_);
+  const unsigned int threads = reservation.getNumberOfThreads ();
+#pragma omp parallel for \
+  default(none) \
+  shared(sizes) \
+  firstprivate(point_number) \
+  schedule(dynamic, 256) \
+  num_threads(threads)
   for (int i_point = 0; i_point < point_number; i_point++)
   {
-    int point_index = (*indices_)[i_point];
-    neighbours.clear ();
-    distances.clear ();
+    const auto point_index = (*indices_)[i_point];
+    pcl::Indices neighbours;
+    std::vector<float> distances;
     search_->nearestKSearch (i_point, region_neighbour_number_, neighbours, distances);
-    point_neighbours_[point_index].swap (neighbours);
-    point_distances_[point_index].swap (distances);
+    sizes[point_index] = std::min<std::size_t> (neighbours.size (), region_neighbour_number_);
+    std::copy (neighbours.begin (), neighbours.begin () + sizes[point_index], point_neighbours_.data (point_index));
+    std::copy (distances.begin (), distances.begin () + sizes[point_index], point_distances_.data (point_index));
   }
+  point_neighbours_.shrink (sizes);
+  point_distances_.shrink (sizes);
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
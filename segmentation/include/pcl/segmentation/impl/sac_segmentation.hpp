@@ -42,6 +42,7 @@
 #define PCL_SEGMENTATION_IMPL_SAC_SEGMENTATION_H_
 
 #include <pcl/segmentation/sac_segmentation.h>
+#include <pcl/common/trace.h>
 
 // Sample Consensus methods
 #include <pcl/sample_consensus/sac.h>
@@ -72,10 +73,14 @@
 
 #include <pcl/memory.h>  // for static_pointer_cast
 
+#include <algorithm> // for std::max, std::remove_if
+
 //////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointT> void
 pcl::SACSegmentation<PointT>::segment (PointIndices &inliers, ModelCoefficients &model_coefficients)
 {
+  PCL_TRACE_ZONE (getClassName ());
+
   // Copy the header information
   inliers.header = model_coefficients.header = input_->header;
 
@@ -96,7 +101,12 @@ pcl::SACSegmentation<PointT>::segment (PointIndices &inliers, ModelCoefficients
   // Initialize the Sample Consensus method and set its parameters
   initSAC (method_type_);
 
-  if (!sac_->computeModel (0))
+  bool found;
+  {
+    PCL_TRACE_ZONE ("SampleConsensus::computeModel");
+    found = sac_->computeModel (0);
+  }
+  if (!found)
   {
     PCL_ERROR ("[pcl::%s::segment] Error segmenting the model! No solution found.\n", getClassName ().c_str ());
     deinitCompute ();
@@ -114,6 +124,7 @@ pcl::SACSegmentation<PointT>::segment (PointIndices &inliers, ModelCoefficients
   // If the user needs optimized coefficients
   if (optimize_coefficients_)
   {
+    PCL_TRACE_ZONE ("SACSegmentation::optimizeModelCoefficients");
     Eigen::VectorXf coeff_refined (model_->getModelSize ());
     model_->optimizeModelCoefficients (inliers.indices, coeff, coeff_refined);
     model_coefficients.values.resize (coeff_refined.size ());
@@ -126,6 +137,78 @@ pcl::SACSegmentation<PointT>::segment (PointIndices &inliers, ModelCoefficients
     model_coefficients.values.resize (coeff.size ());
     memcpy (&model_coefficients.values[0], &coeff[0], coeff.size () * sizeof (float));
   }
+  PCL_TRACE_COUNTER ("SACSegmentation::inliers", inliers.indices.size ());
+
+  deinitCompute ();
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::SACSegmentation<PointT>::segmentModels (std::vector<PointIndices> &inliers,
+                                             std::vector<ModelCoefficients> &model_coefficients,
+                                             std::size_t max_models, std::size_t min_inliers)
+{
+  inliers.clear (); model_coefficients.clear ();
+
+  if (!initCompute ())
+    return;
+
+  // Initialize the Sample Consensus model and method once, they are re-targeted for every model
+  if (!initSACModel (model_type_))
+  {
+    PCL_ERROR ("[pcl::%s::segmentModels] Error initializing the SAC model!\n", getClassName ().c_str ());
+    deinitCompute ();
+    return;
+  }
+  initSAC (method_type_);
+
+  // The indices that do not belong to any model yet. They are compacted in place after each model.
+  IndicesPtr remaining (new Indices (*indices_));
+  std::vector<bool> extracted (input_->size (), false);
+  const std::size_t min_remaining = std::max<std::size_t> (min_inliers, model_->getSampleSize ());
+
+  while (inliers.size () < max_models && remaining->size () >= min_remaining)
+  {
+    model_->setIndices (remaining);
+    if (!sac_->computeModel (0))
+    {
+      PCL_DEBUG ("[pcl::%s::segmentModels] No solution found for model %lu, stopping.\n", getClassName ().c_str (), inliers.size ());
+      break;
+    }
+
+    PointIndices model_inliers;
+    ModelCoefficients coefficients;
+    model_inliers.header = coefficients.header = input_->header;
+    sac_->getInliers (model_inliers.indices);
+
+    Eigen::VectorXf coeff (model_->getModelSize ());
+    sac_->getModelCoefficients (coeff);
+
+    // If the user needs optimized coefficients
+    if (optimize_coefficients_)
+    {
+      Eigen::VectorXf coeff_refined (model_->getModelSize ());
+      model_->optimizeModelCoefficients (model_inliers.indices, coeff, coeff_refined);
+      coeff = coeff_refined;
+      // Refine inliers
+      model_->selectWithinDistance (coeff, threshold_, model_inliers.indices);
+    }
+
+    if (model_inliers.indices.empty () || model_inliers.indices.size () < min_inliers)
+      break;
+
+    coefficients.values.assign (coeff.data (), coeff.data () + coeff.size ());
+
+    // Drop the inliers from the remaining indices
+    for (const auto &index : model_inliers.indices)
+      extracted[index] = true;
+    remaining->erase (std::remove_if (remaining->begin (), remaining->end (),
+                                      [&extracted] (const index_t index) { return (extracted[index]); }),
+                      remaining->end ());
+
+    inliers.push_back (std::move (model_inliers));
+    model_coefficients.push_back (std::move (coefficients));
+  }
 
   deinitCompute ();
 }
@@ -280,7 +363,9 @@ pcl::SACSegmentation<PointT>::initSAC (const int method_type)
     default:
     {
       PCL_DEBUG ("[pcl::%s::initSAC] Using a method of type: SAC_RANSAC with a model threshold of %f\n", getClassName ().c_str (), threshold_);
-      sac_.reset (new RandomSampleConsensus<PointT> (model_, threshold_));
+      typename RandomSampleConsensus<PointT>::Ptr ransac (new RandomSampleConsensus<PointT> (model_, threshold_));
+      ransac->setHypothesesBatchSize (hypotheses_batch_size_);
+      sac_ = ransac;
       break;
     }
     case SAC_LMEDS:
@@ -38,12 +38,17 @@
 #pragma once
 
 #include <pcl/segmentation/segment_differences.h>
+#include <pcl/common/execution_context.h>
 
 #include <pcl/common/io.h>
 #include <pcl/common/point_tests.h> // for pcl::isFinite
 #include <pcl/search/organized.h> // for OrganizedNeighbor
 #include <pcl/search/kdtree.h> // for KdTree
 
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <utility>
 
 //////////////////////////////////////////////////////////////////////////
 template <typename PointT> void
@@ -51,17 +56,27 @@ pcl::getPointCloudDifference (
     const pcl::PointCloud<PointT> &src,
     double threshold,
     const typename pcl::search::Search<PointT>::Ptr &tree,
-    pcl::PointCloud<PointT> &output)
+    pcl::PointCloud<PointT> &output,
+    unsigned int nr_threads)
 {
+  const pcl::ThreadReservation reservation (nr_threads);
+  const unsigned int threads = reservation.getNumberOfThreads ();
+
+  // Whether each point of the input cloud has no neighbor in the target cloud
+  std::vector<std::uint8_t> is_difference (src.size (), 0);
+
   // We're interested in a single nearest neighbor only
   Indices nn_indices (1);
   std::vector<float> nn_distances (1);
 
-  // The input cloud indices that do not have a neighbor in the target cloud
-  Indices src_indices;
-
   // Iterate through the source data set
-  for (index_t i = 0; i < static_cast<index_t> (src.size ()); ++i)
+#pragma omp parallel for \
+  default(none) \
+  shared(src, tree, is_difference) \
+  firstprivate(threshold, nn_indices, nn_distances) \
+  num_threads(threads) \
+  schedule(dynamic, 256)
+  for (std::ptrdiff_t i = 0; i < static_cast<std::ptrdiff_t> (src.size ()); ++i)
   {
     // Ignore invalid points in the inpout cloud
     if (!isFinite (src[i]))
@@ -69,14 +84,20 @@ pcl::getPointCloudDifference (
     // Search for the closest point in the target data set (number of neighbors to find = 1)
     if (!tree->nearestKSearch (src[i], 1, nn_indices, nn_distances))
     {
-      PCL_WARN ("No neighbor found for point %lu (%f %f %f)!\n", i, src[i].x, src[i].y, src[i].z);
+      PCL_WARN ("No neighbor found for point %ld (%f %f %f)!\n", static_cast<long> (i), src[i].x, src[i].y, src[i].z);
       continue;
     }
     // Add points without a corresponding point in the target cloud to the output cloud
     if (nn_distances[0] > threshold)
-      src_indices.push_back (i);
+      is_difference[i] = 1;
   }
 
+  // The input cloud indices that do not have a neighbor in the target cloud
+  Indices src_indices;
+  for (index_t i = 0; i < static_cast<index_t> (src.size ()); ++i)
+    if (is_difference[i])
+      src_indices.push_back (i);
+
   // Copy all the data fields from the input cloud to the output one
   copyPointCloud (src, src_indices, output);
 
@@ -86,6 +107,117 @@ pcl::getPointCloudDifference (
 
 //////////////////////////////////////////////////////////////////////////
 //////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::SegmentDifferences<PointT>::setNumberOfThreads (unsigned int nr_threads)
+{
+  // 0 is resolved against the budget of pcl::ExecutionContext at compute time
+  threads_ = nr_threads;
+}
+
+//////////////////////////////////////////////////////////////////////////
+template <typename PointT> bool
+pcl::SegmentDifferences<PointT>::buildVoxelHash ()
+{
+  voxel_points_.clear ();
+  voxel_begin_.clear ();
+  voxel_lookup_.clear ();
+  voxel_inverse_size_ = 0.0f;
+  if (distance_threshold_ <= 0.0)
+    return (false);
+
+  // Voxels as large as the distance threshold, so all points within the threshold are in the 27 voxels around
+  const float inverse_size = static_cast<float> (1.0 / std::sqrt (distance_threshold_));
+  Eigen::Array3f min_p = Eigen::Array3f::Constant (std::numeric_limits<float>::max ());
+  Eigen::Array3f max_p = Eigen::Array3f::Constant (std::numeric_limits<float>::lowest ());
+  for (const auto &point : *target_)
+  {
+    if (!isFinite (point))
+      continue;
+    min_p = min_p.min (point.getArray3fMap ());
+    max_p = max_p.max (point.getArray3fMap ());
+  }
+  if ((min_p > max_p).any ())
+    return (false);
+  // Voxel coordinates beyond the range of int cannot be represented
+  const Eigen::Array3f min_v = (min_p * inverse_size).floor (), max_v = (max_p * inverse_size).floor ();
+  if ((min_v.abs () >= 1e9f).any () || (max_v.abs () >= 1e9f).any ())
+    return (false);
+  const Eigen::Array3i min_b = min_v.template cast<int> ();
+  const Eigen::Array3i dims = max_v.template cast<int> () - min_b + 1;
+  if (static_cast<double> (dims[0]) * static_cast<double> (dims[1]) * static_cast<double> (dims[2]) >
+      static_cast<double> (std::numeric_limits<std::int64_t>::max ()))
+    return (false);
+  const std::int64_t stride_y = dims[0], stride_z = static_cast<std::int64_t> (dims[0]) * dims[1];
+
+  // Bin the points: sort them by the key of the voxel they fall into
+  std::vector<std::pair<std::int64_t, index_t> > entries;
+  entries.reserve (target_->size ());
+  for (index_t i = 0; i < static_cast<index_t> (target_->size ()); ++i)
+  {
+    const PointT &point = (*target_)[i];
+    if (!isFinite (point))
+      continue;
+    const Eigen::Array3i ijk = (point.getArray3fMap () * inverse_size).floor ().template cast<int> () - min_b;
+    entries.emplace_back (ijk[0] + ijk[1] * stride_y + ijk[2] * stride_z, i);
+  }
+  std::sort (entries.begin (), entries.end ());
+
+  voxel_points_.resize (entries.size ());
+  for (std::size_t i = 0; i < entries.size (); ++i)
+  {
+    voxel_points_[i] = (*target_)[entries[i].second].getVector3fMap ();
+    if (i == 0 || entries[i].first != entries[i - 1].first)
+    {
+      voxel_lookup_.emplace (entries[i].first, voxel_begin_.size ());
+      voxel_begin_.push_back (i);
+    }
+  }
+  voxel_begin_.push_back (entries.size ());
+
+  voxel_inverse_size_ = inverse_size;
+  voxel_min_ = min_b;
+  voxel_dims_ = dims;
+  voxel_stride_y_ = stride_y;
+  voxel_stride_z_ = stride_z;
+  return (true);
+}
+
+//////////////////////////////////////////////////////////////////////////
+template <typename PointT> bool
+pcl::SegmentDifferences<PointT>::isVoxelHashDifference (const PointT &point) const
+{
+  const Eigen::Vector3f p = point.getVector3fMap ();
+  const Eigen::Array3f ijk_f = (p.array () * voxel_inverse_size_).floor () - voxel_min_.template cast<float> ();
+  // Points more than a voxel outside of the target bounds have no correspondence
+  if ((ijk_f < -1.0f).any () || (ijk_f > voxel_dims_.template cast<float> ()).any ())
+    return (true);
+  const Eigen::Array3i ijk = ijk_f.template cast<int> ();
+
+  const auto voxel_has_correspondence = [this, &p] (const Eigen::Array3i &voxel)
+  {
+    if ((voxel < 0).any () || (voxel >= voxel_dims_).any ())
+      return (false);
+    const auto it = voxel_lookup_.find (voxel[0] + voxel[1] * voxel_stride_y_ + voxel[2] * voxel_stride_z_);
+    if (it == voxel_lookup_.end ())
+      return (false);
+    for (std::size_t i = voxel_begin_[it->second]; i < voxel_begin_[it->second + 1]; ++i)
+      if (static_cast<double> ((voxel_points_[i] - p).squaredNorm ()) <= distance_threshold_)
+        return (true);
+    return (false);
+  };
+
+  // Unchanged points usually have a correspondence in their own voxel
+  if (voxel_has_correspondence (ijk))
+    return (false);
+  for (int dk = -1; dk <= 1; ++dk)
+    for (int dj = -1; dj <= 1; ++dj)
+      for (int di = -1; di <= 1; ++di)
+        if ((di != 0 || dj != 0 || dk != 0) && voxel_has_correspondence (ijk + Eigen::Array3i (di, dj, dk)))
+          return (false);
+  return (true);
+}
+
 //////////////////////////////////////////////////////////////////////////
 template <typename PointT> void 
 pcl::SegmentDifferences<PointT>::segment (PointCloud &output)
@@ -106,22 +238,60 @@ pcl::SegmentDifferences<PointT>::segment (PointCloud &output)
     return;
   }
 
-  // Initialize the spatial locator
-  if (!tree_)
+  // Build the index over the target, unless the one of the previous call is still valid
+  if (!target_index_valid_)
   {
-    if (target_->isOrganized ())
-      tree_.reset (new pcl::search::OrganizedNeighbor<PointT> ());
-    else
-      tree_.reset (new pcl::search::KdTree<PointT> (false));
+    if (!use_voxel_hash_ || !buildVoxelHash ())
+    {
+      voxel_inverse_size_ = 0.0f;
+      // Initialize the spatial locator
+      if (!tree_)
+      {
+        if (target_->isOrganized ())
+          tree_.reset (new pcl::search::OrganizedNeighbor<PointT> ());
+        else
+          tree_.reset (new pcl::search::KdTree<PointT> (false));
+      }
+      // Send the input dataset to the spatial locator
+      tree_->setInputCloud (target_);
+    }
+    target_index_valid_ = true;
   }
-  // Send the input dataset to the spatial locator
-  tree_->setInputCloud (target_);
 
-  getPointCloudDifference (*input_, distance_threshold_, tree_, output);
+  if (voxel_inverse_size_ == 0.0f)
+  {
+    getPointCloudDifference (*input_, distance_threshold_, tree_, output, threads_);
+    deinitCompute ();
+    return;
+  }
+
+  const pcl::ThreadReservation reservation (threads_);
+  const unsigned int threads = reservation.getNumberOfThreads ();
+  std::vector<std::uint8_t> is_difference (input_->size (), 0);
+#pragma omp parallel for \
+  default(none) \
+  shared(is_difference) \
+  num_threads(threads) \
+  schedule(dynamic, 256)
+  for (std::ptrdiff_t i = 0; i < static_cast<std::ptrdiff_t> (input_->size ()); ++i)
+  {
+    // Ignore invalid points in the input cloud
+    const PointT &point = (*input_)[i];
+    if (isFinite (point) && isVoxelHashDifference (point))
+      is_difference[i] = 1;
+  }
+
+  Indices src_indices;
+  for (index_t i = 0; i < static_cast<index_t> (input_->size ()); ++i)
+    if (is_difference[i])
+      src_indices.push_back (i);
+  copyPointCloud (*input_, src_indices, output);
+  // Output is always dense, as invalid points in the input cloud are ignored
+  output.is_dense = true;
 
   deinitCompute ();
 }
 
 #define PCL_INSTANTIATE_SegmentDifferences(T) template class PCL_EXPORTS pcl::SegmentDifferences<T>;
-#define PCL_INSTANTIATE_getPointCloudDifference(T) template PCL_EXPORTS void pcl::getPointCloudDifference<T>(const pcl::PointCloud<T> &, double, const typename pcl::search::Search<T>::Ptr &, pcl::PointCloud<T> &);
+#define PCL_INSTANTIATE_getPointCloudDifference(T) template PCL_EXPORTS void pcl::getPointCloudDifference<T>(const pcl::PointCloud<T> &, double, const typename pcl::search::Search<T>::Ptr &, pcl::PointCloud<T> &, unsigned int);
 
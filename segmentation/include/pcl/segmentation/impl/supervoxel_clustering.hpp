@@ -41,6 +41,7 @@
 #define PCL_SEGMENTATION_SUPERVOXEL_CLUSTERING_HPP_
 
 #include <pcl/segmentation/supervoxel_clustering.h>
+#include <pcl/common/execution_context.h>
 #include <pcl/common/io.h> // for copyPointCloud
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -53,7 +54,8 @@ pcl::SupervoxelClustering<PointT>::SupervoxelClustering (float voxel_resolution,
   color_importance_ (0.1f),
   spatial_importance_ (0.4f),
   normal_importance_ (1.0f),
-  use_default_transform_behaviour_ (true)
+  use_default_transform_behaviour_ (true),
+  threads_ (1)
 {
   adjacency_octree_.reset (new OctreeAdjacencyT (resolution_));
 }
@@ -154,12 +156,24 @@ pcl::SupervoxelClustering<PointT>::refineSupervoxels (int num_itr, std::map<std:
     return;
   }
 
+  // expandSupervoxels shares this reservation
+  const pcl::ThreadReservation reservation (threads_);
+  const unsigned int threads = reservation.getNumberOfThreads ();
   int max_depth = static_cast<int> (1.8f*seed_resolution_/resolution_);
   for (int i = 0; i < num_itr; ++i)
   {
-    for (typename HelperListT::iterator sv_itr = supervoxel_helpers_.begin (); sv_itr != supervoxel_helpers_.end (); ++sv_itr)
+    //Every supervoxel only writes the normals of its own voxels
+    std::vector<SupervoxelHelper*> helpers;
+    getHelperPointers (helpers);
+    const int num_helpers = static_cast<int> (helpers.size ());
+#pragma omp parallel for \
+  default(none) \
+  shared(helpers) \
+  firstprivate(num_helpers) \
+  num_threads(threads)
+    for (int h = 0; h < num_helpers; ++h)
     {
-      sv_itr->refineNormals ();
+      helpers[h]->refineNormals ();
     }
     
     reseedSupervoxels ();
@@ -208,6 +222,8 @@ pcl::SupervoxelClustering<PointT>::prepareForSegmentation ()
 template <typename PointT> void
 pcl::SupervoxelClustering<PointT>::computeVoxelData ()
 {
+  const pcl::ThreadReservation reservation (threads_);
+  const unsigned int threads = reservation.getNumberOfThreads ();
   voxel_centroid_cloud_.reset (new PointCloudT);
   voxel_centroid_cloud_->resize (adjacency_octree_->getLeafCount ());
   typename LeafVectorT::iterator leaf_itr = adjacency_octree_->begin ();
@@ -256,15 +272,24 @@ pcl::SupervoxelClustering<PointT>::computeVoxelData ()
   }
   else //Otherwise just compute the normals
   {
-    for (leaf_itr = adjacency_octree_->begin (); leaf_itr != adjacency_octree_->end (); ++leaf_itr)
+    //The leaves are independent, each one only writes its own data
+    const auto leaf_begin = adjacency_octree_->begin ();
+    const int num_leaves = static_cast<int> (adjacency_octree_->getLeafCount ());
+#pragma omp parallel for \
+  default(none) \
+  firstprivate(leaf_begin, num_leaves) \
+  schedule(dynamic, 64) \
+  num_threads(threads)
+    for (int i_leaf = 0; i_leaf < num_leaves; ++i_leaf)
     {
-      VoxelData& new_voxel_data = (*leaf_itr)->getData ();
+      LeafContainerT* leaf = leaf_begin[i_leaf];
+      VoxelData& new_voxel_data = leaf->getData ();
       //For every point, get its neighbors, build an index vector, compute normal
       Indices indices;
       indices.reserve (81); 
       //Push this point
       indices.push_back (new_voxel_data.idx_);
-      for (typename LeafContainerT::const_iterator neighb_itr=(*leaf_itr)->cbegin (); neighb_itr!=(*leaf_itr)->cend (); ++neighb_itr)
+      for (typename LeafContainerT::const_iterator neighb_itr=leaf->cbegin (); neighb_itr!=leaf->cend (); ++neighb_itr)
       {
         VoxelData& neighb_voxel_data = (*neighb_itr)->getData ();
         //Push neighbor index
@@ -293,8 +318,9 @@ pcl::SupervoxelClustering<PointT>::computeVoxelData ()
 template <typename PointT> void
 pcl::SupervoxelClustering<PointT>::expandSupervoxels ( int depth )
 {
-  
-  
+  const pcl::ThreadReservation reservation (threads_);
+  const unsigned int threads = reservation.getNumberOfThreads ();
+
   for (int i = 1; i < depth; ++i)
   {
       //Expand the the supervoxels by one iteration
@@ -303,18 +329,27 @@ pcl::SupervoxelClustering<PointT>::expandSupervoxels ( int depth )
         sv_itr->expand ();
       }
       
-      //Update the centers to reflect new centers
+      //Remove the supervoxels which lost all of their voxels
       for (typename HelperListT::iterator sv_itr = supervoxel_helpers_.begin (); sv_itr != supervoxel_helpers_.end (); )
       {
         if (sv_itr->size () == 0)
-        {
           sv_itr = supervoxel_helpers_.erase (sv_itr);
-        }
         else
-        {
-          sv_itr->updateCentroid ();
           ++sv_itr;
-        } 
+      }
+
+      //Update the centers to reflect new centers
+      std::vector<SupervoxelHelper*> helpers;
+      getHelperPointers (helpers);
+      const int num_helpers = static_cast<int> (helpers.size ());
+#pragma omp parallel for \
+  default(none) \
+  shared(helpers) \
+  firstprivate(num_helpers) \
+  num_threads(threads)
+      for (int h = 0; h < num_helpers; ++h)
+      {
+        helpers[h]->updateCentroid ();
       }
 
   }
@@ -325,19 +360,48 @@ pcl::SupervoxelClustering<PointT>::expandSupervoxels ( int depth )
 template <typename PointT> void
 pcl::SupervoxelClustering<PointT>::makeSupervoxels (std::map<std::uint32_t,typename Supervoxel<PointT>::Ptr > &supervoxel_clusters)
 {
+  const pcl::ThreadReservation reservation (threads_);
+  const unsigned int threads = reservation.getNumberOfThreads ();
   supervoxel_clusters.clear ();
-  for (typename HelperListT::iterator sv_itr = supervoxel_helpers_.begin (); sv_itr != supervoxel_helpers_.end (); ++sv_itr)
+  //Create the map entries first, the supervoxels are then filled independently
+  std::vector<SupervoxelHelper*> helpers;
+  getHelperPointers (helpers);
+  std::vector<Supervoxel<PointT>*> supervoxels (helpers.size ());
+  for (std::size_t h = 0; h < helpers.size (); ++h)
   {
-    std::uint32_t label = sv_itr->getLabel ();
-    supervoxel_clusters[label].reset (new Supervoxel<PointT>);
-    sv_itr->getXYZ (supervoxel_clusters[label]->centroid_.x,supervoxel_clusters[label]->centroid_.y,supervoxel_clusters[label]->centroid_.z);
-    sv_itr->getRGB (supervoxel_clusters[label]->centroid_.rgba);
-    sv_itr->getNormal (supervoxel_clusters[label]->normal_);
-    sv_itr->getVoxels (supervoxel_clusters[label]->voxels_);
-    sv_itr->getNormals (supervoxel_clusters[label]->normals_);
+    auto &supervoxel = supervoxel_clusters[helpers[h]->getLabel ()];
+    supervoxel.reset (new Supervoxel<PointT>);
+    supervoxels[h] = supervoxel.get ();
+  }
+
+  const int num_helpers = static_cast<int> (helpers.size ());
+#pragma omp parallel for \
+  default(none) \
+  shared(helpers, supervoxels) \
+  firstprivate(num_helpers) \
+  num_threads(threads)
+  for (int h = 0; h < num_helpers; ++h)
+  {
+    const SupervoxelHelper* helper = helpers[h];
+    Supervoxel<PointT>* supervoxel = supervoxels[h];
+    helper->getXYZ (supervoxel->centroid_.x,supervoxel->centroid_.y,supervoxel->centroid_.z);
+    helper->getRGB (supervoxel->centroid_.rgba);
+    helper->getNormal (supervoxel->normal_);
+    helper->getVoxels (supervoxel->voxels_);
+    helper->getNormals (supervoxel->normals_);
   }
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::SupervoxelClustering<PointT>::getHelperPointers (std::vector<SupervoxelHelper*> &helpers)
+{
+  helpers.clear ();
+  helpers.reserve (supervoxel_helpers_.size ());
+  for (auto &helper : supervoxel_helpers_)
+    helpers.push_back (&helper);
+}
+
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointT> void
@@ -374,7 +438,7 @@ pcl::SupervoxelClustering<PointT>::selectInitialSupervoxelSeeds (Indices &seed_i
   seed_octree.setInputCloud (voxel_centroid_cloud_);
   seed_octree.addPointsFromInputCloud ();
  // std::cout << "Size of octree ="<<seed_octree.getLeafCount ()<<"\n";
-  std::vector<PointT, Eigen::aligned_allocator<PointT> > voxel_centers; 
+  typename pcl::octree::OctreePointCloudSearch<PointT>::AlignedPointTVector voxel_centers;
   int num_seeds = seed_octree.getOccupiedVoxelCenters(voxel_centers); 
   //std::cout << "Number of seed points before filtering="<<voxel_centers.size ()<<std::endl;
   
@@ -678,6 +742,21 @@ pcl::SupervoxelClustering<PointT>::setUseSingleCameraTransform (bool val)
   use_single_camera_transform_ = val;
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::SupervoxelClustering<PointT>::setNumberOfThreads (unsigned int nr_threads)
+{
+  // 0 is resolved against the budget of pcl::ExecutionContext at compute time
+  threads_ = nr_threads;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> unsigned int
+pcl::SupervoxelClustering<PointT>::getNumberOfThreads () const
+{
+  return (threads_);
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointT> int
 pcl::SupervoxelClustering<PointT>::getMaxLabel () const
@@ -692,6 +771,26 @@ pcl::SupervoxelClustering<PointT>::getMaxLabel () const
   return max_label;
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> std::size_t
+pcl::SupervoxelClustering<PointT>::getMemoryUsage () const
+{
+  std::size_t bytes = 0;
+  if (adjacency_octree_)
+    bytes += adjacency_octree_->getMemoryUsage ();
+  if (voxel_centroid_cloud_)
+    bytes += voxel_centroid_cloud_->points.capacity () * sizeof (PointT);
+  if (voxel_kdtree_)
+    bytes += voxel_kdtree_->getMemoryUsage ();
+
+  // every supervoxel is a list node, every voxel it owns a node of the red-black tree of its leaf set
+  const std::size_t list_node_bytes = sizeof (SupervoxelHelper) + 2 * sizeof (void*);
+  const std::size_t set_node_bytes = sizeof (LeafContainerT*) + 4 * sizeof (void*);
+  for (typename HelperListT::const_iterator sv_itr = supervoxel_helpers_.cbegin (); sv_itr != supervoxel_helpers_.cend (); ++sv_itr)
+    bytes += list_node_bytes + sv_itr->size () * set_node_bytes;
+  return (bytes);
+}
+
 namespace pcl
 { 
   namespace octree
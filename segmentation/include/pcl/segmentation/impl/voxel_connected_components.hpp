@@ -0,0 +1,203 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef PCL_SEGMENTATION_IMPL_VOXEL_CONNECTED_COMPONENTS_H_
+#define PCL_SEGMENTATION_IMPL_VOXEL_CONNECTED_COMPONENTS_H_
+
+#include <pcl/segmentation/voxel_connected_components.h>
+#include <pcl/common/common.h> // for getMinMax3D
+#include <pcl/common/point_tests.h> // for isFinite
+
+#include <algorithm>
+#include <cstdint>
+#include <unordered_map>
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> bool
+pcl::VoxelConnectedComponents<PointT>::voxelsTouch (const index_t *first, std::size_t first_size,
+                                                   const index_t *second, std::size_t second_size) const
+{
+  const float sqr_leaf_size = leaf_size_ * leaf_size_;
+  for (std::size_t i = 0; i < first_size; ++i)
+  {
+    const Eigen::Vector3f p = (*input_)[first[i]].getVector3fMap ();
+    for (std::size_t j = 0; j < second_size; ++j)
+      if ((p - (*input_)[second[j]].getVector3fMap ()).squaredNorm () <= sqr_leaf_size)
+        return (true);
+  }
+  return (false);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::VoxelConnectedComponents<PointT>::extract (std::vector<PointIndices> &clusters)
+{
+  clusters.clear ();
+  if (!initCompute () ||
+      (input_   && input_->points.empty ()) ||
+      (indices_ && indices_->empty ()))
+    return;
+
+  if (leaf_size_ <= 0.0f)
+  {
+    PCL_ERROR ("[pcl::%s::extract] Invalid leaf size %f!\n", getClassName ().c_str (), leaf_size_);
+    deinitCompute ();
+    return;
+  }
+
+  // Compute the voxel grid bounds
+  Eigen::Vector4f min_p, max_p;
+  getMinMax3D (*input_, *indices_, min_p, max_p);
+  const float inverse_leaf_size = 1.0f / leaf_size_;
+  const Eigen::Array3i min_b ((min_p.head<3> () * inverse_leaf_size).array ().floor ().template cast<int> ());
+  const Eigen::Array3i max_b ((max_p.head<3> () * inverse_leaf_size).array ().floor ().template cast<int> ());
+  const Eigen::Array<std::int64_t, 3, 1> dims = (max_b - min_b).template cast<std::int64_t> () + 1;
+  if (static_cast<double> (dims[0]) * static_cast<double> (dims[1]) * static_cast<double> (dims[2]) >
+      static_cast<double> (std::numeric_limits<std::int64_t>::max ()))
+  {
+    PCL_WARN ("[pcl::%s::extract] Leaf size is too small for the input dataset. Integer indices would overflow.\n", getClassName ().c_str ());
+    deinitCompute ();
+    return;
+  }
+  const std::int64_t stride_y = dims[0], stride_z = dims[0] * dims[1];
+
+  // Bin the points: sort them by the index of the voxel they fall into
+  std::vector<std::pair<std::int64_t, index_t> > entries;
+  entries.reserve (indices_->size ());
+  for (const auto &index : *indices_)
+  {
+    const PointT &point = (*input_)[index];
+    if (!input_->is_dense && !isFinite (point))
+      continue;
+    const Eigen::Array3i ijk = (point.getVector3fMap () * inverse_leaf_size).array ().floor ().template cast<int> () - min_b;
+    entries.emplace_back (ijk[0] + ijk[1] * stride_y + ijk[2] * stride_z, index);
+  }
+  std::sort (entries.begin (), entries.end ());
+
+  // Every occupied voxel owns the range [voxel_begin[v], voxel_begin[v + 1]) of point_order
+  Indices point_order (entries.size ());
+  std::vector<std::size_t> voxel_begin;
+  std::vector<std::int64_t> voxel_keys;
+  std::unordered_map<std::int64_t, std::size_t> voxel_lookup;
+  for (std::size_t i = 0; i < entries.size (); ++i)
+  {
+    point_order[i] = entries[i].second;
+    if (i == 0 || entries[i].first != entries[i - 1].first)
+    {
+      voxel_lookup.emplace (entries[i].first, voxel_keys.size ());
+      voxel_keys.push_back (entries[i].first);
+      voxel_begin.push_back (i);
+    }
+  }
+  voxel_begin.push_back (entries.size ());
+  const std::size_t nr_voxels = voxel_keys.size ();
+
+  // Union-find over the voxels, the root of every set is its smallest voxel
+  std::vector<std::size_t> parent (nr_voxels);
+  for (std::size_t v = 0; v < nr_voxels; ++v)
+    parent[v] = v;
+  const auto find_root = [&parent] (std::size_t v)
+  {
+    while (parent[v] != v)
+      v = parent[v] = parent[parent[v]];
+    return (v);
+  };
+
+  // Connect every voxel to the 13 neighbors that come after it, which covers the whole 26-neighborhood
+  for (std::size_t v = 0; v < nr_voxels; ++v)
+  {
+    const std::int64_t key = voxel_keys[v];
+    const std::int64_t i = key % stride_y, j = (key / stride_y) % dims[1], k = key / stride_z;
+    for (int dk = 0; dk <= 1; ++dk)
+      for (int dj = -1; dj <= 1; ++dj)
+        for (int di = -1; di <= 1; ++di)
+        {
+          if (dk == 0 && (dj < 0 || (dj == 0 && di <= 0)))
+            continue;
+          if (i + di < 0 || i + di >= dims[0] || j + dj < 0 || j + dj >= dims[1] || k + dk >= dims[2])
+            continue;
+          const auto neighbor = voxel_lookup.find (key + di + dj * stride_y + dk * stride_z);
+          if (neighbor == voxel_lookup.end ())
+            continue;
+          const std::size_t w = neighbor->second;
+          std::size_t root_v = find_root (v), root_w = find_root (w);
+          if (root_v == root_w)
+            continue;
+          if (refine_boundaries_ &&
+              !voxelsTouch (&point_order[voxel_begin[v]], voxel_begin[v + 1] - voxel_begin[v],
+                            &point_order[voxel_begin[w]], voxel_begin[w + 1] - voxel_begin[w]))
+            continue;
+          if (root_v < root_w)
+            std::swap (root_v, root_w);
+          parent[root_v] = root_w;
+        }
+  }
+
+  // Map the voxel sets back to the points
+  std::vector<int> labels (nr_voxels, -1);
+  std::vector<PointIndices> candidates;
+  for (std::size_t v = 0; v < nr_voxels; ++v)
+  {
+    int &label = labels[find_root (v)];
+    if (label == -1)
+    {
+      label = static_cast<int> (candidates.size ());
+      candidates.emplace_back ();
+    }
+    candidates[label].indices.insert (candidates[label].indices.end (),
+                                      point_order.begin () + voxel_begin[v], point_order.begin () + voxel_begin[v + 1]);
+  }
+
+  for (auto &candidate : candidates)
+  {
+    if (candidate.indices.size () < min_pts_per_cluster_ || candidate.indices.size () > max_pts_per_cluster_)
+      continue;
+    std::sort (candidate.indices.begin (), candidate.indices.end ());
+    candidate.header = input_->header;
+    clusters.push_back (std::move (candidate));
+  }
+
+  // Sort the clusters based on their size (largest one first)
+  std::stable_sort (clusters.begin (), clusters.end (),
+                    [] (const PointIndices &a, const PointIndices &b) { return (a.indices.size () > b.indices.size ()); });
+
+  deinitCompute ();
+}
+
+#define PCL_INSTANTIATE_VoxelConnectedComponents(T) template class PCL_EXPORTS pcl::VoxelConnectedComponents<T>;
+
+#endif        // PCL_SEGMENTATION_IMPL_VOXEL_CONNECTED_COMPONENTS_H_
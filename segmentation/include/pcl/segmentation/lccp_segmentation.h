@@ -244,6 +244,21 @@ namespace pcl
         min_segment_size_ = min_segment_size_arg;
       }
 
+      /** \brief Set the number of threads used to evaluate the convexity of the supervoxel adjacency edges, and by
+       *  CPCSegmentation to search the cutting planes of the segments. Edges and segments are processed independently, so
+       *  the convexity does not depend on the number of threads.
+       *  \param[in] nr_threads the number of hardware threads to use (0 takes as many as the budget of
+       *  pcl::ExecutionContext allows when segmenting) */
+      void
+      setNumberOfThreads (unsigned int nr_threads = 0);
+
+      /** \brief Get the number of threads used to evaluate the convexity of the edges. */
+      inline unsigned int
+      getNumberOfThreads () const
+      {
+        return (threads_);
+      }
+
     protected:
 
       /** \brief Segments smaller than \ref min_segment_size_ are merged to the label of largest neighbor */
@@ -274,12 +289,14 @@ namespace pcl
       recursiveSegmentGrowing (const VertexID  &queryPointID,
                                const unsigned int group_label);
 
-      /** \brief Calculates convexity of edges and saves this to the adjacency graph.
+      /** \brief Calculates convexity of edges and saves this to the adjacency graph. The edges are evaluated concurrently
+       *  with \ref threads_ threads.
        *  \param[in,out] adjacency_list_arg The supervoxel adjacency list*/
       void
       calculateConvexConnections (SupervoxelAdjacencyList& adjacency_list_arg);
 
       /** \brief Connections are only convex if this is true for at least k_arg common neighbors of the two patches. Call \ref setKFactor before \ref segment to use this.
+       *  The edges are checked concurrently with \ref threads_ threads, each one only invalidates itself.
        *  \param[in] k_arg Factor used for extended convexity check */
       void
       applyKconvexity (const unsigned int k_arg);
@@ -326,6 +343,9 @@ namespace pcl
       /** \brief Minimum segment size */
       std::uint32_t min_segment_size_;
 
+      /** \brief The number of threads the scheduler should use */
+      unsigned int threads_;
+
       /** \brief Stores which supervoxel labels were already visited during recursive grouping.
        *  \note processed_[sv_Label] = false (default)/true (already processed) */
       std::map<std::uint32_t, bool> processed_;
@@ -45,8 +45,9 @@
 #include <pcl/point_types.h>
 #include <pcl/search/search.h>
 #include <string>
-#include <set>
+#include <vector>
 #include <boost/graph/adjacency_list.hpp> // for adjacency_list
+#include <boost/graph/compressed_sparse_row_graph.hpp> // for compressed_sparse_row_graph
 
 namespace pcl
 {
@@ -104,6 +105,13 @@ namespace pcl
 
       using mGraphPtr = shared_ptr<mGraph>;
 
+      /** \brief The graph on which the maximum flow is computed. Vertex i is the point i of the input cloud,
+        * the two last vertices are the source and the sink. Every edge has a reverse edge.
+        */
+      using CompactGraph = boost::compressed_sparse_row_graph<boost::directedS>;
+
+      using CompactEdgeDescriptor = boost::graph_traits<CompactGraph>::edge_descriptor;
+
     public:
 
       /** \brief Constructor that sets default values for member variables. */
@@ -204,17 +212,33 @@ namespace pcl
       double
       getMaxFlow () const;
 
-      /** \brief Returns the graph that was build for finding the minimum cut. */
+      /** \brief Returns the graph that was build for finding the minimum cut, with the residual capacities of
+        * the last segmentation. The graph is converted from the internal compressed graph on every call.
+        */
       mGraphPtr
       getGraph () const;
 
+      /** \brief Set the number of threads used to build the graph and to compute the potentials. The
+        * segmentation does not depend on the number of threads.
+        * \param[in] nr_threads the number of hardware threads to use (0 sets the value automatically)
+        */
+      void
+      setNumberOfThreads (unsigned int nr_threads = 0);
+
+      /** \brief Get the number of threads used to build the graph. */
+      unsigned int
+      getNumberOfThreads () const { return (threads_); }
+
       /** \brief Returns the colored cloud. Points that belong to the object have the same color. */
       pcl::PointCloud<pcl::PointXYZRGB>::Ptr
       getColoredCloud ();
 
     protected:
 
-      /** \brief This method simply builds the graph that will be used during the segmentation. */
+      /** \brief This method simply builds the graph that will be used during the segmentation.
+        * The K nearest neighbours of all the points are searched in parallel and the graph is
+        * assembled in compressed sparse row form, with one edge in each direction between neighbours.
+        */
       bool
       buildGraph ();
 
@@ -227,14 +251,6 @@ namespace pcl
       void
       calculateUnaryPotential (int point, double& source_weight, double& sink_weight) const;
 
-      /** \brief This method simply adds the edge from the source point to the target point with a given weight.
-        * \param[in] source index of the source point of the edge
-        * \param[in] target index of the target point of the edge
-        * \param[in] weight weight that will be assigned to the (source, target) edge
-        */
-      bool
-      addEdge (int source, int target, double weight);
-
       /** \brief Returns the binary potential(smooth cost) for the given indices of points.
         * In other words it returns weight that must be assigned to the edge from source to target point.
         * \param[in] source index of the source point of the edge
@@ -243,7 +259,9 @@ namespace pcl
       double
       calculateBinaryPotential (int source, int target) const;
 
-      /** \brief This method recalculates unary potentials(data cost) if some changes were made, instead of creating new graph. */
+      /** \brief This method recalculates unary potentials(data cost) if some changes were made, instead of creating new graph.
+        * Only the capacities of the source and sink edges change, so new foreground points do not rebuild the graph.
+        */
       bool
       recalculateUnaryPotentials ();
 
@@ -251,11 +269,9 @@ namespace pcl
       bool
       recalculateBinaryPotentials ();
 
-      /** \brief This method analyzes the residual network and assigns a label to every point in the cloud.
-        * \param[in] residual_capacity residual network that was obtained during the segmentation
-        */
+      /** \brief This method analyzes the residual network and assigns a label to every point in the cloud. */
       void
-      assembleLabels (ResidualCapacityMap& residual_capacity);
+      assembleLabels ();
 
     protected:
 
@@ -296,19 +312,25 @@ namespace pcl
       std::vector <pcl::PointIndices> clusters_;
 
       /** \brief Stores the graph for finding the maximum flow. */
-      mGraphPtr graph_;
+      CompactGraph graph_;
+
+      /** \brief Stores the capacity of every edge in the graph, by edge index. */
+      std::vector<double> capacity_;
 
-      /** \brief Stores the capacity of every edge in the graph. */
-      std::shared_ptr<CapacityMap> capacity_;
+      /** \brief Stores the residual capacity of every edge after the segmentation, by edge index. */
+      std::vector<double> residual_capacity_;
 
-      /** \brief Stores reverse edges for every edge in the graph. */
-      std::shared_ptr<ReverseEdgeMap> reverse_edges_;
+      /** \brief Stores the reverse edge of every edge in the graph, by edge index. */
+      std::vector<CompactEdgeDescriptor> reverse_edges_;
 
-      /** \brief Stores the vertices of the graph. */
-      std::vector< VertexDescriptor > vertices_;
+      /** \brief Stores the points of the graph, the indices without duplicates. */
+      Indices graph_points_;
 
-      /** \brief Stores the information about the edges that were added to the graph. It is used to avoid the duplicate edges. */
-      std::vector< std::set<int> > edge_marker_;
+      /** \brief Stores the index of the (source, point) edge of every point in graph_points_. */
+      std::vector<std::size_t> source_edges_;
+
+      /** \brief Stores the index of the (point, sink) edge of every point in graph_points_. */
+      std::vector<std::size_t> sink_edges_;
 
       /** \brief Stores the vertex that serves as source. */
       VertexDescriptor source_;
@@ -319,6 +341,9 @@ namespace pcl
       /** \brief Stores the maximum flow value that was calculated during the segmentation. */
       double max_flow_;
 
+      /** \brief The number of threads used to build the graph. */
+      unsigned int threads_;
+
     public:
       PCL_MAKE_ALIGNED_OPERATOR_NEW
   };
@@ -80,6 +80,7 @@ namespace pcl
         */
       OrganizedConnectedComponentSegmentation (const ComparatorConstPtr& compare)
         : compare_ (compare)
+        , threads_ (1)
       {
       }
 
@@ -108,6 +109,28 @@ namespace pcl
         */
       void
       segment (pcl::PointCloud<PointLT>& labels, std::vector<pcl::PointIndices>& label_indices) const;
+
+      /** \brief Perform the connected component segmentation with a comparison known at compile time, e.g. a
+        * ComparatorFunctor, instead of the virtual Comparator::compare. The comparator given to the constructor
+        * is not used.
+        * \param[in] compare functor called as compare (idx1, idx2), returning true if the two points belong together
+        * \param[out] labels a PointCloud of labels: each connected component will have a unique id.
+        * \param[out] label_indices a vector of PointIndices corresponding to each label / component id.
+        */
+      template <typename CompareFunctor> void
+      segment (const CompareFunctor& compare, pcl::PointCloud<PointLT>& labels, std::vector<pcl::PointIndices>& label_indices) const;
+
+      /** \brief Set the number of threads to use for the labeling. With more than one thread the image is
+        * labeled in independent blocks of rows which are merged afterwards. The labels are identical to the ones
+        * of the sequential version.
+        * \param[in] nr_threads the number of hardware threads to use (0 takes as many as the budget of pcl::ExecutionContext allows when labeling)
+        */
+      void
+      setNumberOfThreads (unsigned int nr_threads = 0);
+
+      /** \brief Get the number of threads used for the labeling. */
+      unsigned int
+      getNumberOfThreads () const { return (threads_); }
       
       /** \brief Find the boundary points / contour of a connected component
         * \param[in] start_idx the first (lowest) index of the connected component for which a boundary should be returned
@@ -120,6 +143,9 @@ namespace pcl
 
     protected:
       ComparatorConstPtr compare_;
+
+      /** \brief The number of threads the scheduler should use. */
+      unsigned int threads_;
       
       inline unsigned
       findRoot (const std::vector<unsigned>& runs, unsigned index) const
@@ -131,6 +157,33 @@ namespace pcl
         return (idx);
       }
 
+      /** \brief Labels the image in blocks of rows in parallel, then merges the blocks. Used by segment
+        * if more than one thread is requested.
+        */
+      template <typename CompareFunctor> void
+      segmentBlocks (const CompareFunctor& compare, pcl::PointCloud<PointLT>& labels, std::vector<pcl::PointIndices>& label_indices) const;
+
+      /** \brief Finds the root of a pixel in the union-find forest, halving the path on the way. */
+      static inline unsigned
+      findRootHalving (std::vector<unsigned>& parent, unsigned index)
+      {
+        while (parent[index] != index)
+          index = parent[index] = parent[parent[index]];
+        return (index);
+      }
+
+      /** \brief Merges the trees of two pixels, the smaller root becomes the root of both. */
+      static inline void
+      uniteRoots (std::vector<unsigned>& parent, unsigned idx1, unsigned idx2)
+      {
+        const unsigned root1 = findRootHalving (parent, idx1);
+        const unsigned root2 = findRootHalving (parent, idx2);
+        if (root1 < root2)
+          parent[root2] = root1;
+        else if (root2 < root1)
+          parent[root1] = root2;
+      }
+
     private:
       struct Neighbor
       {
@@ -127,6 +127,18 @@ namespace pcl
       inline void
       setExponential (bool exponential) { exponential_ = exponential; }
 
+      /** \brief Get flag indicating whether the opening is computed on a grid of the lowest heights. */
+      inline bool
+      getUseGrid () const { return (use_grid_); }
+
+      /** \brief Set flag indicating whether the opening is computed on a grid of the lowest heights.
+        * If set, the ground points are binned into cells of cell size and the grid is opened with the van Herk/Gil-Werman
+        * algorithm, whose cost does not depend on the window size. Otherwise every point is opened with a box search
+        * around it (default). The grid mode is much faster for large windows, its result is quantized to the cells.
+        */
+      inline void
+      setUseGrid (bool use_grid) { use_grid_ = use_grid; }
+
       /** \brief This method launches the segmentation algorithm and returns indices of
         * points determined to be ground returns.
         * \param[out] ground indices of points determined to be ground returns.
@@ -156,6 +168,9 @@ namespace pcl
 
       /** \brief Exponentially grow window sizes? */
       bool exponential_;
+
+      /** \brief Open a grid of the lowest heights instead of the point cloud? */
+      bool use_grid_;
   };
 }
 
@@ -43,12 +43,61 @@
 
 #include <Eigen/Core> // for Matrix
 
+#include <map>
+
 namespace pcl
 {
 
   namespace segmentation
   {
 
+    /** \brief Linear solvers available to randomWalker(). */
+    enum RandomWalkerSolver
+    {
+      /** \brief Sparse Cholesky factorization, exact but memory hungry on large graphs. */
+      RANDOM_WALKER_CHOLESKY,
+      /** \brief Preconditioned conjugate gradient on all colors at once, only needs
+        * the Laplacian and a few dense vectors per color. */
+      RANDOM_WALKER_CONJUGATE_GRADIENT
+    };
+
+    /** \brief Preconditioners of the RANDOM_WALKER_CONJUGATE_GRADIENT solver. */
+    enum RandomWalkerPreconditioner
+    {
+      /** \brief Diagonal of the Laplacian, cheap and applied in parallel. */
+      RANDOM_WALKER_JACOBI,
+      /** \brief Incomplete Cholesky factorization without fill-in, fewer iterations
+        * than RANDOM_WALKER_JACOBI but applied one color per thread. Falls back to
+        * RANDOM_WALKER_JACOBI with Eigen versions older than 3.3. */
+      RANDOM_WALKER_INCOMPLETE_CHOLESKY
+    };
+
+    /** \brief Parameters of randomWalker().
+      *
+      * The defaults reproduce the behavior of the overloads without parameters.
+      *
+      * \ingroup segmentation
+      */
+    struct RandomWalkerParameters
+    {
+      /** \brief The linear solver. */
+      RandomWalkerSolver solver = RANDOM_WALKER_CHOLESKY;
+      /** \brief The preconditioner of the conjugate gradient solver. */
+      RandomWalkerPreconditioner preconditioner = RANDOM_WALKER_JACOBI;
+      /** \brief The conjugate gradient solver stops once the residual of every color
+        * is below this fraction of its right hand side. */
+      double tolerance = 1e-6;
+      /** \brief The maximum number of conjugate gradient iterations. */
+      unsigned int max_iterations = 1000;
+      /** \brief The number of threads of the conjugate gradient solver, 0 uses as
+        * many threads as the budget of pcl::ExecutionContext allows. */
+      unsigned int nr_threads = 1;
+      /** \brief Start the conjugate gradient solver from the potentials passed to
+        * randomWalker() instead of from zero, e.g. the result of the previous call
+        * when seeds were added or moved in an interactive segmentation. */
+      bool warm_start = false;
+    };
+
     /** \brief Multilabel graph segmentation using random walks.
       *
       * This is an implementation of the algorithm described in "Random Walks
@@ -133,6 +182,51 @@ namespace pcl
                   Eigen::Matrix<typename boost::property_traits<EdgeWeightMap>::value_type, Eigen::Dynamic, Eigen::Dynamic>& potentials,
                   std::map<typename boost::property_traits<VertexColorMap>::value_type, std::size_t>& colors_to_columns_map);
 
+    /** \brief Multilabel graph segmentation using random walks.
+      *
+      * This is an overloaded function that allows to choose the linear solver.
+      * See the documentation for randomWalker().
+      *
+      * \param[in]      graph an undirected graph
+      * \param[in]      weights an external edge weight property map
+      * \param[in,out]  colors an external vertex color property map
+      * \param[in]      parameters the solver parameters
+      *
+      * \ingroup segmentation
+      */
+    template <class Graph, class EdgeWeightMap, class VertexColorMap> bool
+    randomWalker (Graph& graph,
+                  EdgeWeightMap weights,
+                  VertexColorMap colors,
+                  const RandomWalkerParameters& parameters);
+
+    /** \brief Multilabel graph segmentation using random walks.
+      *
+      * This is an overloaded function that allows to choose the linear solver.
+      * See the documentation for randomWalker().
+      *
+      * \param[in]      graph an undirected graph
+      * \param[in]      weights an external edge weight property map
+      * \param[in,out]  colors an external vertex color property map
+      * \param[in,out]  potentials a matrix with calculated probabilities,
+      *                 where rows correspond to vertices, and columns
+      *                 correspond to colors. With RandomWalkerParameters::warm_start
+      *                 the potentials of a previous call are used as the initial
+      *                 guess of the conjugate gradient solver.
+      * \param[in,out]  colors_to_columns_map a mapping between colors and
+      *                 columns in \a potentials matrix
+      * \param[in]      parameters the solver parameters
+      *
+      * \ingroup segmentation
+      */
+    template <class Graph, class EdgeWeightMap, class VertexColorMap> bool
+    randomWalker (Graph& graph,
+                  EdgeWeightMap weights,
+                  VertexColorMap colors,
+                  Eigen::Matrix<typename boost::property_traits<EdgeWeightMap>::value_type, Eigen::Dynamic, Eigen::Dynamic>& potentials,
+                  std::map<typename boost::property_traits<VertexColorMap>::value_type, std::size_t>& colors_to_columns_map,
+                  const RandomWalkerParameters& parameters);
+
   }
 
 }
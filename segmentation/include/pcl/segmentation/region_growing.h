@@ -46,8 +46,128 @@
 #include <pcl/point_cloud.h>
 #include <pcl/point_types.h>
 
+#include <vector>
+
 namespace pcl
 {
+  namespace detail
+  {
+    /** \brief Variable length lists (e.g. the neighbours of every point) stored one after the other
+      * in a single array and addressed through a table of offsets (compressed sparse row layout).
+      * Compared to a vector of vectors this needs one allocation instead of one per list.
+      */
+    template <typename T>
+    class CompactLists
+    {
+      public:
+
+        /** \brief Read-only view of one of the lists. */
+        class List
+        {
+          public:
+            List (const T* first, const T* last) : first_ (first), last_ (last) {}
+
+            std::size_t
+            size () const { return (static_cast<std::size_t> (last_ - first_)); }
+
+            bool
+            empty () const { return (first_ == last_); }
+
+            const T&
+            operator[] (std::size_t i) const { return (first_[i]); }
+
+            const T*
+            begin () const { return (first_); }
+
+            const T*
+            end () const { return (last_); }
+
+          private:
+            const T* first_;
+            const T* last_;
+        };
+
+        /** \brief Returns the number of lists. */
+        std::size_t
+        size () const { return (offsets_.empty () ? 0 : offsets_.size () - 1); }
+
+        bool
+        empty () const { return (size () == 0); }
+
+        /** \brief Removes all lists and frees the memory. */
+        void
+        clear ()
+        {
+          std::vector<std::size_t> ().swap (offsets_);
+          std::vector<T> ().swap (values_);
+        }
+
+        /** \brief Makes room for capacities[i] values in the i-th list. The lists can afterwards be
+          * filled independently (e.g. from several threads) through data ().
+          * \param[in] capacities the maximum number of values of every list
+          */
+        void
+        allocate (const std::vector<std::size_t>& capacities)
+        {
+          offsets_.resize (capacities.size () + 1);
+          offsets_[0] = 0;
+          for (std::size_t i = 0; i < capacities.size (); ++i)
+            offsets_[i + 1] = offsets_[i] + capacities[i];
+          values_.resize (offsets_.back ());
+        }
+
+        /** \brief Returns a pointer to the storage of the i-th list. */
+        T*
+        data (std::size_t i) { return (values_.data () + offsets_[i]); }
+
+        /** \brief Truncates the i-th list to its first sizes[i] values and closes the gaps.
+          * \param[in] sizes the number of values actually stored in every list, must not exceed
+          * the capacity passed to allocate ()
+          */
+        void
+        shrink (const std::vector<std::size_t>& sizes)
+        {
+          std::size_t write = 0;
+          for (std::size_t i = 0; i < sizes.size (); ++i)
+          {
+            const std::size_t read = offsets_[i];
+            offsets_[i] = write;
+            if (write != read)
+              std::move (values_.begin () + read, values_.begin () + read + sizes[i], values_.begin () + write);
+            write += sizes[i];
+          }
+          offsets_.back () = write;
+          if (write < values_.size ())
+          {
+            values_.resize (write);
+            values_.shrink_to_fit ();
+          }
+        }
+
+        /** \brief Returns the i-th list. */
+        List
+        operator[] (std::size_t i) const
+        {
+          return (List (values_.data () + offsets_[i], values_.data () + offsets_[i + 1]));
+        }
+
+        /** \brief Returns the number of bytes allocated for the lists. */
+        std::size_t
+        getMemoryUsage () const
+        {
+          return (offsets_.capacity () * sizeof (std::size_t) + values_.capacity () * sizeof (T));
+        }
+
+      private:
+
+        /** \brief Position of the first value of every list in values_, followed by the total size. */
+        std::vector<std::size_t> offsets_;
+
+        /** \brief Values of all the lists. */
+        std::vector<T> values_;
+    };
+  }
+
   /** \brief
     * Implements the well known Region Growing algorithm used for segmentation.
     * Description can be found in the article
@@ -189,6 +309,33 @@ namespace pcl
       void
       setSearchMethod (const KdTreePtr& tree);
 
+      /** \brief Set the number of threads used to find the neighbours of the points. The region growing
+        * itself stays sequential, so the segmentation does not depend on this value.
+        * \param[in] nr_threads the number of hardware threads to use (0 takes as many as the budget of pcl::ExecutionContext allows when searching the neighbours)
+        */
+      void
+      setNumberOfThreads (unsigned int nr_threads = 0);
+
+      /** \brief Returns the number of threads used to find the neighbours of the points. */
+      unsigned int
+      getNumberOfThreads () const;
+
+      /** \brief Returns the number of bytes held by the neighbour table, the point labels and the
+        * clusters of the last segmentation. The input cloud, the normals and the search method are
+        * not counted.
+        */
+      virtual std::size_t
+      getMemoryUsage () const;
+
+      /** \brief Returns an upper bound of the memory the neighbour table, the point labels and the
+        * clusters take when segmenting nr_points points, e.g. to pick the number of neighbours that
+        * fits a memory budget before running the segmentation.
+        * \param[in] nr_points the number of points to be segmented
+        * \param[in] neighbour_number the number of neighbours searched for every point
+        */
+      static std::size_t
+      estimateMemoryUsage (std::size_t nr_points, unsigned int neighbour_number);
+
       /** \brief Returns normals. */
       NormalPtr
       getInputNormals () const;
@@ -312,7 +459,7 @@ namespace pcl
       NormalPtr normals_;
 
       /** \brief Contains neighbours of each point. */
-      std::vector<pcl::Indices> point_neighbours_;
+      detail::CompactLists<pcl::index_t> point_neighbours_;
 
       /** \brief Point labels that tells to which segment each point belongs. */
       std::vector<int> point_labels_;
@@ -331,6 +478,9 @@ namespace pcl
       /** \brief Stores the number of segments. */
       int number_of_segments_;
 
+      /** \brief The number of threads used to find the neighbours. */
+      unsigned int threads_;
+
     public:
       PCL_MAKE_ALIGNED_OPERATOR_NEW
   };
@@ -78,6 +78,7 @@ namespace pcl
       using RegionGrowing<PointT, NormalT>::num_pts_in_segment_;
       using RegionGrowing<PointT, NormalT>::clusters_;
       using RegionGrowing<PointT, NormalT>::number_of_segments_;
+      using RegionGrowing<PointT, NormalT>::threads_;
       using RegionGrowing<PointT, NormalT>::applySmoothRegionGrowingAlgorithm;
       using RegionGrowing<PointT, NormalT>::assembleRegions;
 
@@ -178,6 +179,12 @@ namespace pcl
       void
       getSegmentFromPoint (index_t index, pcl::PointIndices& cluster) override;
 
+      /** \brief Returns the number of bytes held by the point and segment neighbourhoods, the labels and
+        * the clusters of the last segmentation.
+        */
+      std::size_t
+      getMemoryUsage () const override;
+
     protected:
 
       /** \brief This method simply checks if it is possible to execute the segmentation algorithm with
@@ -264,7 +271,7 @@ namespace pcl
       unsigned int region_neighbour_number_;
 
       /** \brief Stores distances for the point neighbours from point_neighbours_ */
-      std::vector< std::vector<float> > point_distances_;
+      detail::CompactLists<float> point_distances_;
 
       /** \brief Stores the neighboures for the corresponding segments. */
       std::vector< pcl::Indices > segment_neighbours_;
@@ -97,6 +97,7 @@ namespace pcl
         , max_iterations_ (50)
         , threads_ (-1)
         , probability_ (0.99)
+        , hypotheses_batch_size_ (1)
         , random_ (random)
       {
       }
@@ -169,6 +170,19 @@ namespace pcl
       inline void
       setNumberOfThreads (const int nr_threads = -1) { threads_ = nr_threads; }
 
+      /** \brief Set the number of RANSAC hypotheses that are scored together, see
+        * RandomSampleConsensus::setHypothesesBatchSize. Models that can score a batch at once, e.g. on an
+        * accelerator, override SampleConsensusModel::countWithinDistanceBatch.
+        * \param[in] batch_size the number of hypotheses per batch (default: 1, no batching)
+        * \note Only used by SAC_RANSAC.
+        */
+      inline void
+      setHypothesesBatchSize (std::size_t batch_size) { hypotheses_batch_size_ = batch_size; }
+
+      /** \brief Get the number of RANSAC hypotheses that are scored together. */
+      inline std::size_t
+      getHypothesesBatchSize () const { return (hypotheses_batch_size_); }
+
       /** \brief Set to true if a coefficient refinement is required.
         * \param[in] optimize true for enabling model coefficient refinement, false otherwise
         */
@@ -250,6 +264,20 @@ namespace pcl
       virtual void 
       segment (PointIndices &inliers, ModelCoefficients &model_coefficients);
 
+      /** \brief Segment several models one after the other (sequential RANSAC): the inliers of each model found
+        * are removed from the remaining points before the next model is fitted.
+        *
+        * The SAC model and method are set up only once and re-targeted at the shrinking set of remaining indices,
+        * so no intermediate point clouds are created and no ExtractIndices pass is needed between the models.
+        * \param[out] inliers the inliers of every model found, in the order in which the models were extracted
+        * \param[out] model_coefficients the coefficients of every model found
+        * \param[in] max_models the maximum number of models to extract
+        * \param[in] min_inliers stop as soon as the best remaining model has fewer inliers than this (default: 1)
+        */
+      void
+      segmentModels (std::vector<PointIndices> &inliers, std::vector<ModelCoefficients> &model_coefficients,
+                     std::size_t max_models, std::size_t min_inliers = 1);
+
     protected:
       /** \brief Initialize the Sample Consensus model and set its parameters.
         * \param[in] model_type the type of SAC model that is to be used
@@ -305,6 +333,9 @@ namespace pcl
       /** \brief Desired probability of choosing at least one sample free from outliers (user given parameter). */
       double probability_;
 
+      /** \brief The number of hypotheses RANSAC scores together (user given parameter). */
+      std::size_t hypotheses_batch_size_;
+
       /** \brief Set to true if we need a random seed. */
       bool random_;
 
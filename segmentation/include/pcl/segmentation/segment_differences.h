@@ -41,6 +41,10 @@
 #include <pcl/pcl_macros.h>
 #include <pcl/search/search.h> // for Search
 
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
 namespace pcl
 {
   ////////////////////////////////////////////////////////////////////////////////////////////
@@ -50,6 +54,8 @@ namespace pcl
     * src has a correspondence > threshold than a point p2 from tgt)
     * \param tree the spatial locator (e.g., kd-tree) used for nearest neighbors searching built over the target cloud
     * \param output the resultant output point cloud difference
+    * \param nr_threads the number of threads used for the nearest neighbor searches (0 takes as many as the budget
+    * of pcl::ExecutionContext allows), the order of the output points does not depend on it
     * \ingroup segmentation
     */
   template <typename PointT> 
@@ -57,7 +63,8 @@ namespace pcl
       const pcl::PointCloud<PointT> &src,
       double threshold,
       const typename pcl::search::Search<PointT>::Ptr &tree,
-      pcl::PointCloud<PointT> &output);
+      pcl::PointCloud<PointT> &output,
+      unsigned int nr_threads = 1);
 
   ////////////////////////////////////////////////////////////////////////////////////////////
   ////////////////////////////////////////////////////////////////////////////////////////////
@@ -65,6 +72,11 @@ namespace pcl
   /** \brief @b SegmentDifferences obtains the difference between two spatially
     * aligned point clouds and returns the difference between them for a maximum
     * given distance threshold.
+    *
+    * The search structure built over the target is kept between calls to segment, so comparing a stream of
+    * input clouds against a fixed reference only pays for the queries. It is rebuilt when setTargetCloud,
+    * setSearchMethod, setDistanceThreshold or setUseVoxelHash is called, so call setTargetCloud again after
+    * modifying the target in place.
     * \author Radu Bogdan Rusu
     * \ingroup segmentation
     */
@@ -86,7 +98,8 @@ namespace pcl
 
       /** \brief Empty constructor. */
       SegmentDifferences () : 
-        tree_ (), target_ (), distance_threshold_ (0)
+        tree_ (), target_ (), distance_threshold_ (0), use_voxel_hash_ (false), threads_ (1),
+        target_index_valid_ (false), voxel_inverse_size_ (0.0f), voxel_stride_y_ (0), voxel_stride_z_ (0)
       {};
 
       /** \brief Provide a pointer to the target dataset against which we
@@ -95,7 +108,7 @@ namespace pcl
         * \param cloud the target PointCloud dataset
         */
       inline void 
-      setTargetCloud (const PointCloudConstPtr &cloud) { target_ = cloud; }
+      setTargetCloud (const PointCloudConstPtr &cloud) { target_ = cloud; target_index_valid_ = false; }
 
       /** \brief Get a pointer to the input target point cloud dataset. */
       inline PointCloudConstPtr const 
@@ -105,7 +118,7 @@ namespace pcl
         * \param tree a pointer to the spatial search object.
         */
       inline void 
-      setSearchMethod (const KdTreePtr &tree) { tree_ = tree; }
+      setSearchMethod (const KdTreePtr &tree) { tree_ = tree; target_index_valid_ = false; }
 
       /** \brief Get a pointer to the search method used. */
       inline KdTreePtr 
@@ -117,7 +130,7 @@ namespace pcl
         * \param sqr_threshold the squared distance tolerance as a measure in L2 Euclidean space
         */
       inline void 
-      setDistanceThreshold (double sqr_threshold) { distance_threshold_ = sqr_threshold; }
+      setDistanceThreshold (double sqr_threshold) { distance_threshold_ = sqr_threshold; target_index_valid_ = false; }
 
       /** \brief Get the squared distance tolerance between corresponding points as a
         * measure in the L2 Euclidean space.
@@ -125,6 +138,32 @@ namespace pcl
       inline double 
       getDistanceThreshold () { return (distance_threshold_); }
 
+      /** \brief Set whether to find the differences with a voxel hash of the target instead of the search object.
+        * \details The target points are binned into voxels with the size of the distance threshold, so all
+        * correspondences of a point lie in the 27 voxels around it, which are looked up in a hash map. Unchanged
+        * points usually find a correspondence in their own voxel. The result is the same as the one of the
+        * search object. Falls back to the search object if the threshold is 0 or too small for the extent of
+        * the target.
+        * \param use_voxel_hash true to use the voxel hash (default: false)
+        */
+      inline void
+      setUseVoxelHash (bool use_voxel_hash) { use_voxel_hash_ = use_voxel_hash; target_index_valid_ = false; }
+
+      /** \brief Get whether the differences are found with a voxel hash of the target. */
+      inline bool
+      getUseVoxelHash () const { return (use_voxel_hash_); }
+
+      /** \brief Set the number of threads used to compare the input points to the target.
+        * \param nr_threads the number of hardware threads to use (0 takes as many as the budget of
+        * pcl::ExecutionContext allows when segmenting)
+        */
+      void
+      setNumberOfThreads (unsigned int nr_threads = 0);
+
+      /** \brief Get the number of threads used to compare the input points to the target. */
+      inline unsigned int
+      getNumberOfThreads () const { return (threads_); }
+
       /** \brief Segment differences between two input point clouds.
         * \param output the resultant difference between the two point clouds as a PointCloud
         */
@@ -149,6 +188,44 @@ namespace pcl
         */
       double distance_threshold_;
 
+      /** \brief Whether the differences are found with the voxel hash of the target. */
+      bool use_voxel_hash_;
+
+      /** \brief The number of threads the scheduler should use. */
+      unsigned int threads_;
+
+      /** \brief Whether the search object or the voxel hash is built over the current target. */
+      bool target_index_valid_;
+
+      /** \brief Inverse of the voxel size of the voxel hash, 0 if the search object is used. */
+      float voxel_inverse_size_;
+
+      /** \brief Smallest voxel coordinates and number of voxels along each axis of the target bounds. */
+      Eigen::Array3i voxel_min_;
+      Eigen::Array3i voxel_dims_;
+
+      /** \brief Strides of the y and z voxel coordinates in the voxel keys. */
+      std::int64_t voxel_stride_y_, voxel_stride_z_;
+
+      /** \brief The target points sorted by voxel, the voxel with index v owns the range
+        * [voxel_begin_[v], voxel_begin_[v + 1]).
+        */
+      std::vector<Eigen::Vector3f> voxel_points_;
+      std::vector<std::size_t> voxel_begin_;
+
+      /** \brief Map from the voxel keys to the voxel indices. */
+      std::unordered_map<std::int64_t, std::size_t> voxel_lookup_;
+
+      /** \brief Build the voxel hash over the target.
+        * \return false if no voxel hash can be built and the search object has to be used instead
+        */
+      bool
+      buildVoxelHash ();
+
+      /** \brief Whether the voxel hash has no target point within the distance threshold of point. */
+      bool
+      isVoxelHashDifference (const PointT &point) const;
+
       /** \brief Class getName method. */
       virtual std::string 
       getClassName () const { return ("SegmentDifferences"); }
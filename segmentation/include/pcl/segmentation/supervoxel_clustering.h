@@ -242,6 +242,17 @@ namespace pcl
       void
       setUseSingleCameraTransform (bool val);
 
+      /** \brief Set the number of threads used for the voxel normals, the supervoxel centroid updates and the
+        * normal refinement. The expansion of the supervoxels is sequential, so the result does not depend on this value.
+        * \param[in] nr_threads the number of hardware threads to use (0 takes as many as the budget of pcl::ExecutionContext allows when clustering)
+        */
+      void
+      setNumberOfThreads (unsigned int nr_threads = 0);
+
+      /** \brief Get the number of threads used by the supervoxel clustering */
+      unsigned int
+      getNumberOfThreads () const;
+
       /** \brief This method launches the segmentation algorithm and returns the supervoxels that were
        * obtained during the segmentation.
        * \param[out] supervoxel_clusters A map of labels to pointers to supervoxel structures
@@ -311,6 +322,14 @@ namespace pcl
       int
       getMaxLabel () const;
 
+      /** \brief Returns an approximation of the number of bytes held by the voxel octree, the voxel centroid
+        * cloud, the voxel kd-tree and the supervoxels of the last run. The input cloud and normals are not counted.
+        * The voxel resolution mainly drives the size, as the octree and the voxel cloud grow with the number of
+        * occupied voxels.
+        */
+      std::size_t
+      getMemoryUsage () const;
+
     private:
       /** \brief This method simply checks if it is possible to execute the segmentation algorithm with
         * the current settings. If it is possible then it returns true.
@@ -387,6 +406,13 @@ namespace pcl
       /** \brief Whether to use default transform behavior or not */
       bool use_default_transform_behaviour_;
 
+      /** \brief The number of threads the scheduler should use */
+      unsigned int threads_;
+
+      /** \brief Collects pointers to the supervoxel helpers, so that they can be processed in a parallel loop */
+      void
+      getHelperPointers (std::vector<SupervoxelHelper*> &helpers);
+
       /** \brief Internal storage class for supervoxels
        * \note Stores pointers to leaves of clustering internal octree,
        * \note so should not be used outside of clustering class
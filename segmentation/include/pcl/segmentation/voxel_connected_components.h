@@ -0,0 +1,183 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#pragma once
+
+#include <pcl/pcl_base.h>
+#include <pcl/PointIndices.h>
+
+namespace pcl
+{
+  /** \brief @b VoxelConnectedComponents clusters a point cloud by the connected components of its occupied voxels.
+    *
+    * The points are binned into a grid of cubic voxels with edge length \a leaf_size, and two occupied voxels belong
+    * to the same cluster if they touch, i.e. if they are neighbors in the 26-neighborhood. This approximates
+    * EuclideanClusterExtraction with a cluster tolerance of about the leaf size, but needs neither a search tree nor a
+    * radius search per point.
+    *
+    * With setRefineBoundaries (true) two neighboring voxels are only connected if they contain a pair of points that
+    * are at most \a leaf_size apart, which removes most of the merges caused by the coarse voxel boundaries. The points
+    * inside one voxel always belong to the same cluster.
+    *
+    * The clusters are sorted by size, the largest one first, and the indices of every cluster are sorted.
+    * \ingroup segmentation
+    */
+  template <typename PointT>
+  class VoxelConnectedComponents : public PCLBase<PointT>
+  {
+    using BasePCLBase = PCLBase<PointT>;
+
+    public:
+      using PointCloud = pcl::PointCloud<PointT>;
+      using PointCloudPtr = typename PointCloud::Ptr;
+      using PointCloudConstPtr = typename PointCloud::ConstPtr;
+
+      /** \brief Empty constructor. */
+      VoxelConnectedComponents () : leaf_size_ (0.0f),
+                                    refine_boundaries_ (false),
+                                    min_pts_per_cluster_ (1),
+                                    max_pts_per_cluster_ (std::numeric_limits<pcl::uindex_t>::max ())
+      {};
+
+      /** \brief Set the edge length of the voxels, which is also the distance at which points are connected.
+        * \param[in] leaf_size the voxel edge length
+        */
+      inline void
+      setLeafSize (float leaf_size)
+      {
+        leaf_size_ = leaf_size;
+      }
+
+      /** \brief Get the edge length of the voxels. */
+      inline float
+      getLeafSize () const
+      {
+        return (leaf_size_);
+      }
+
+      /** \brief Set whether neighboring voxels are only connected if they contain points that are at most
+        * the leaf size apart.
+        * \param[in] refine_boundaries true to check the points at the voxel boundaries (default: false)
+        */
+      inline void
+      setRefineBoundaries (bool refine_boundaries)
+      {
+        refine_boundaries_ = refine_boundaries;
+      }
+
+      /** \brief Get whether the points at the voxel boundaries are checked. */
+      inline bool
+      getRefineBoundaries () const
+      {
+        return (refine_boundaries_);
+      }
+
+      /** \brief Set the minimum number of points that a cluster needs to contain in order to be considered valid.
+        * \param[in] min_cluster_size the minimum cluster size
+        */
+      inline void
+      setMinClusterSize (pcl::uindex_t min_cluster_size)
+      {
+        min_pts_per_cluster_ = min_cluster_size;
+      }
+
+      /** \brief Get the minimum number of points that a cluster needs to contain in order to be considered valid. */
+      inline pcl::uindex_t
+      getMinClusterSize () const
+      {
+        return (min_pts_per_cluster_);
+      }
+
+      /** \brief Set the maximum number of points that a cluster needs to contain in order to be considered valid.
+        * \param[in] max_cluster_size the maximum cluster size
+        */
+      inline void
+      setMaxClusterSize (pcl::uindex_t max_cluster_size)
+      {
+        max_pts_per_cluster_ = max_cluster_size;
+      }
+
+      /** \brief Get the maximum number of points that a cluster needs to contain in order to be considered valid. */
+      inline pcl::uindex_t
+      getMaxClusterSize () const
+      {
+        return (max_pts_per_cluster_);
+      }
+
+      /** \brief Cluster extraction in a PointCloud given by <setInputCloud (), setIndices ()>
+        * \param[out] clusters the resultant point clusters
+        */
+      void
+      extract (std::vector<PointIndices> &clusters);
+
+    protected:
+      // Members derived from the base class
+      using BasePCLBase::input_;
+      using BasePCLBase::indices_;
+      using BasePCLBase::initCompute;
+      using BasePCLBase::deinitCompute;
+
+      /** \brief Check whether two voxels contain a pair of points that are at most the leaf size apart.
+        * \param[in] first the point indices of the first voxel
+        * \param[in] first_size the number of points in the first voxel
+        * \param[in] second the point indices of the second voxel
+        * \param[in] second_size the number of points in the second voxel
+        */
+      bool
+      voxelsTouch (const index_t *first, std::size_t first_size,
+                   const index_t *second, std::size_t second_size) const;
+
+      /** \brief The edge length of the voxels. */
+      float leaf_size_;
+
+      /** \brief Whether neighboring voxels are only connected if their points are close enough. */
+      bool refine_boundaries_;
+
+      /** \brief The minimum number of points that a cluster needs to contain in order to be considered valid (default = 1). */
+      pcl::uindex_t min_pts_per_cluster_;
+
+      /** \brief The maximum number of points that a cluster needs to contain in order to be considered valid (default = MAXINT). */
+      pcl::uindex_t max_pts_per_cluster_;
+
+      /** \brief Class getName method. */
+      virtual std::string getClassName () const { return ("VoxelConnectedComponents"); }
+  };
+}
+
+#ifdef PCL_NO_PRECOMPILE
+#include <pcl/segmentation/impl/voxel_connected_components.hpp>
+#endif
@@ -59,6 +59,26 @@ public:
       std::vector<Eigen::Isometry3d, Eigen::aligned_allocator<Eigen::Isometry3d>> poses,
       std::vector<float>& scores);
 
+  /** Computes the likelihood of reference for an arbitrary number of poses.
+   *
+   *  The poses are rendered in batches of getRows() * getCols() particles, the last
+   *  batch being padded with its final pose. Results are read back asynchronously
+   *  through a pair of pixel buffer objects: while the GPU renders and scores batch
+   *  n, the CPU consumes the readback of batch n-1. Unless setComputeOnCPU() or
+   *  setSumOnCPU() are enabled, scoring and summation stay on the GPU and only the
+   *  reduced per-particle sums are transferred.
+   *
+   * \param[in] reference is a depth image
+   * \param[in] poses is a vector of the poses to test
+   * \param[out] scores the resulting log likelihoods, one per pose
+   */
+  void
+  computeLikelihoodsBatched(
+      const float* reference,
+      const std::vector<Eigen::Isometry3d,
+                        Eigen::aligned_allocator<Eigen::Isometry3d>>& poses,
+      std::vector<float>& scores);
+
   /** Set the basic camera intrinsic parameters. */
   void
   setCameraIntrinsicsParameters(int camera_width_in,
@@ -232,8 +252,24 @@ private:
   void
   computeScores(float* reference, std::vector<float>& scores);
 
+  /** Evaluate the likelihood/score of a tiled depth buffer.
+   *
+   * \param[in] depth tiled depth buffer of size getWidth() x getHeight()
+   * \param[in] reference input measurement depth image (raw data)
+   * \param[out] scores output score, one per tile, accumulated into
+   */
+  void
+  computeScores(const float* depth, const float* reference, float* scores);
+
+  void
+  computeScoresShader(const float* reference);
+
+  /** Wait for the asynchronous readback of a batch into pbo and accumulate the
+   *  scores of its first count particles into scores.
+   */
   void
-  computeScoresShader(float* reference);
+  collectBatch(
+      GLuint pbo, GLsync fence, const float* reference, int count, float* scores);
 
   void
   render(const std::vector<Eigen::Isometry3d,
@@ -295,6 +331,7 @@ private:
   GLuint score_summarized_texture_;
   GLuint sensor_texture_;
   GLuint likelihood_texture_;
+  GLuint readback_pbo_[2];
 
   bool compute_likelihood_on_cpu_;
   bool aggregate_on_cpu_;
@@ -49,6 +49,23 @@ public:
   void
   sum(GLuint input_array, float* output_array);
 
+  /** Run the reduction passes without reading back the result.
+   *
+   * The result stays on the GPU in the texture returned by getResultTexture(), so
+   * that it can be read back asynchronously, e.g. into a pixel buffer object.
+   *
+   * \param[in] input_array name of the input texture
+   */
+  void
+  reduce(GLuint input_array);
+
+  /** Name of the texture holding the result of the last reduction. */
+  GLuint
+  getResultTexture() const
+  {
+    return arrays_[levels_ - 1];
+  }
+
 private:
   GLuint fbo_;
   GLuint* arrays_;
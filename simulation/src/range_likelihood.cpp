@@ -14,6 +14,7 @@
 #include <GL/glu.h>
 #endif
 
+#include <algorithm>
 #include <random>
 
 // For adding noise:
@@ -244,6 +245,23 @@ max_level(int a, int b)
   }
 }
 
+// Accumulates a tiled image of per-pixel scores into one score per tile
+void
+accumulateTileScores(const float* buffer,
+                     int width,
+                     int height,
+                     int tile_width,
+                     int tile_height,
+                     int cols,
+                     float* scores)
+{
+  for (int n = 0, row = 0; row < height; ++row) {
+    for (int col = 0; col < width; ++col, ++n) {
+      scores[row / tile_height * cols + col / tile_width] += buffer[n];
+    }
+  }
+}
+
 // display_tic_toc: a helper function which accepts a set of
 // timestamps and displays the elapsed time between them as
 // a fraction and time used [for profiling]
@@ -476,6 +494,18 @@ pcl::simulation::RangeLikelihood::RangeLikelihood(
 
   gllib::getGLError();
 
+  // Pixel buffer objects for asynchronous readback, large enough for a full depth
+  // or score image
+  glGenBuffers(2, readback_pbo_);
+  for (const auto& pbo : readback_pbo_) {
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, pbo);
+    glBufferData(
+        GL_PIXEL_PACK_BUFFER, sizeof(float) * width_ * height_, nullptr, GL_STREAM_READ);
+  }
+  glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+  gllib::getGLError();
+
   // Go back to the default pipeline
   glUseProgram(0);
 
@@ -485,6 +515,7 @@ pcl::simulation::RangeLikelihood::RangeLikelihood(
 pcl::simulation::RangeLikelihood::~RangeLikelihood()
 {
   glDeleteBuffers(1, &quad_vbo_);
+  glDeleteBuffers(2, readback_pbo_);
   glDeleteTextures(1, &depth_texture_);
   glDeleteTextures(1, &color_texture_);
   glDeleteTextures(1, &score_texture_);
@@ -749,7 +780,14 @@ void
 pcl::simulation::RangeLikelihood::computeScores(float* reference,
                                                 std::vector<float>& scores)
 {
-  const float* depth = getDepthBuffer();
+  computeScores(getDepthBuffer(), reference, scores.data());
+}
+
+void
+pcl::simulation::RangeLikelihood::computeScores(const float* depth,
+                                                const float* reference,
+                                                float* scores)
+{
   // Mapping between disparity and range:
   // range or depth = 1/disparity
   //
@@ -768,7 +806,7 @@ pcl::simulation::RangeLikelihood::computeScores(float* reference,
 
   // for row across each image in a row of model images
   for (int row = 0; row < rows_ * row_height_; row++) {
-    float* ref = reference + col_width_ * (row % row_height_);
+    const float* ref = reference + col_width_ * (row % row_height_);
     // for each column: across each image in a column of model images
     for (int col = 0; col < cols_ * col_width_; col++) {
       float depth_val =
@@ -1008,13 +1046,13 @@ RangeLikelihood::computeLikelihoods(
 
     // Aggregate results (we do not use GPU to sum cpu scores)
     if (aggregate_on_cpu_) {
-      const float* score_buffer = getScoreBuffer();
-
-      for (int n = 0, row = 0; row < height_; ++row) {
-        for (int col = 0; col < width_; ++col, ++n) {
-          scores[row / row_height_ * cols_ + col / col_width_] += score_buffer[n];
-        }
-      }
+      accumulateTileScores(getScoreBuffer(),
+                           width_,
+                           height_,
+                           col_width_,
+                           row_height_,
+                           cols_,
+                           scores.data());
     }
     else {
       int levels = max_level(row_height_, col_width_);
@@ -1025,12 +1063,13 @@ RangeLikelihood::computeLikelihoods(
 
       float* score_sum = new float[reduced_width * reduced_height];
       sum_reduce_.sum(score_texture_, score_sum);
-      for (int n = 0, row = 0; row < reduced_height; ++row) {
-        for (int col = 0; col < reduced_width; ++col, ++n) {
-          scores[row / reduced_row_height * cols_ + col / reduced_col_width] +=
-              score_sum[n];
-        }
-      }
+      accumulateTileScores(score_sum,
+                           reduced_width,
+                           reduced_height,
+                           reduced_col_width,
+                           reduced_row_height,
+                           cols_,
+                           scores.data());
       delete[] score_sum;
     }
   }
@@ -1041,9 +1080,161 @@ RangeLikelihood::computeLikelihoods(
 #endif
 }
 
+void
+RangeLikelihood::computeLikelihoodsBatched(
+    const float* reference,
+    const std::vector<Eigen::Isometry3d, Eigen::aligned_allocator<Eigen::Isometry3d>>&
+        poses,
+    std::vector<float>& scores)
+{
+#if DO_TIMING_PROFILE
+  std::vector<double> tic_toc;
+  tic_toc.push_back(getTime());
+#endif
+
+  scores.assign(poses.size(), 0.0f);
+  if (poses.empty())
+    return;
+
+  const std::size_t tiles = static_cast<std::size_t>(rows_) * cols_;
+  const std::size_t num_batches = (poses.size() + tiles - 1) / tiles;
+
+  // Readbacks in flight, indexed by the pixel buffer object they target
+  GLsync fences[2] = {nullptr, nullptr};
+  std::size_t offsets[2] = {0, 0};
+  int counts[2] = {0, 0};
+
+  std::vector<Eigen::Isometry3d, Eigen::aligned_allocator<Eigen::Isometry3d>> batch(
+      tiles);
+  for (std::size_t b = 0; b < num_batches; ++b) {
+    const int slot = static_cast<int>(b % 2);
+    const std::size_t offset = b * tiles;
+    const std::size_t count = std::min(tiles, poses.size() - offset);
+
+    // drawParticles always fills every tile, pad with the last pose of the batch
+    for (std::size_t i = 0; i < tiles; ++i)
+      batch[i] = poses[offset + std::min(i, count - 1)];
+
+    render(batch);
+
+    // Queue the readback of this batch into its pixel buffer object. With a pack
+    // buffer bound the read calls return immediately, the copy happens on the GPU.
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, readback_pbo_[slot]);
+    if (compute_likelihood_on_cpu_) {
+      glBindFramebuffer(GL_FRAMEBUFFER, fbo_);
+      glReadPixels(0, 0, width_, height_, GL_DEPTH_COMPONENT, GL_FLOAT, nullptr);
+      glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    }
+    else {
+      computeScoresShader(reference);
+
+      GLuint result_texture = score_texture_;
+      if (!aggregate_on_cpu_) {
+        sum_reduce_.reduce(score_texture_);
+        result_texture = sum_reduce_.getResultTexture();
+      }
+      glActiveTexture(GL_TEXTURE0);
+      glBindTexture(GL_TEXTURE_2D, result_texture);
+      glGetTexImage(GL_TEXTURE_2D, 0, GL_RED, GL_FLOAT, nullptr);
+      glBindTexture(GL_TEXTURE_2D, 0);
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    if (gllib::getGLError() != GL_NO_ERROR) {
+      std::cerr << "GL Error: RangeLikelihood::computeLikelihoodsBatched - readback"
+                << std::endl;
+    }
+
+    fences[slot] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    offsets[slot] = offset;
+    counts[slot] = static_cast<int>(count);
+
+    // Consume the previous batch while the GPU works on this one
+    if (b > 0) {
+      const int prev = 1 - slot;
+      collectBatch(readback_pbo_[prev],
+                   fences[prev],
+                   reference,
+                   counts[prev],
+                   &scores[offsets[prev]]);
+      fences[prev] = nullptr;
+    }
+  }
+
+  const int last = static_cast<int>((num_batches - 1) % 2);
+  collectBatch(readback_pbo_[last],
+               fences[last],
+               reference,
+               counts[last],
+               &scores[offsets[last]]);
+
+#if DO_TIMING_PROFILE
+  tic_toc.push_back(getTime());
+  display_tic_toc(tic_toc, "range_likelihood_batched");
+#endif
+}
+
+void
+RangeLikelihood::collectBatch(
+    GLuint pbo, GLsync fence, const float* reference, int count, float* scores)
+{
+  // Flush once, then keep waiting until the readback has landed
+  GLenum wait = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000);
+  while (wait == GL_TIMEOUT_EXPIRED)
+    wait = glClientWaitSync(fence, 0, 1000000);
+  glDeleteSync(fence);
+  if (wait == GL_WAIT_FAILED) {
+    std::cerr << "GL Error: RangeLikelihood::collectBatch - wait failed" << std::endl;
+    return;
+  }
+
+  int read_width = width_;
+  int read_height = height_;
+  int tile_width = col_width_;
+  int tile_height = row_height_;
+  if (!compute_likelihood_on_cpu_ && !aggregate_on_cpu_) {
+    int levels = max_level(row_height_, col_width_);
+    read_width >>= levels;
+    read_height >>= levels;
+    tile_width >>= levels;
+    tile_height >>= levels;
+  }
+
+  glBindBuffer(GL_PIXEL_PACK_BUFFER, pbo);
+  const auto* buffer = static_cast<const float*>(
+      glMapBufferRange(GL_PIXEL_PACK_BUFFER,
+                       0,
+                       sizeof(float) * read_width * read_height,
+                       GL_MAP_READ_BIT));
+  if (!buffer) {
+    std::cerr << "GL Error: RangeLikelihood::collectBatch - map failed" << std::endl;
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    return;
+  }
+
+  std::vector<float> tile_scores(rows_ * cols_, 0.0f);
+  if (compute_likelihood_on_cpu_) {
+    computeScores(buffer, reference, tile_scores.data());
+  }
+  else {
+    accumulateTileScores(buffer,
+                         read_width,
+                         read_height,
+                         tile_width,
+                         tile_height,
+                         cols_,
+                         tile_scores.data());
+  }
+  glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+  glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+  for (int i = 0; i < count; ++i)
+    scores[i] += tile_scores[i];
+}
+
 // Computes the likelihood scores using a shader
 void
-pcl::simulation::RangeLikelihood::computeScoresShader(float* reference)
+pcl::simulation::RangeLikelihood::computeScoresShader(const float* reference)
 {
   if (gllib::getGLError() != GL_NO_ERROR) {
     std::cout << "GL error: RangeLikelihood::compute_scores_shader - enter"
@@ -65,8 +65,24 @@ pcl::simulation::SumReduce::~SumReduce()
 void
 pcl::simulation::SumReduce::sum(GLuint input_array, float* output_array)
 {
+  reduce(input_array);
+
+  // Final results is in arrays_[levels_-1]
+  glActiveTexture(GL_TEXTURE0);
+  glBindTexture(GL_TEXTURE_2D, arrays_[levels_ - 1]);
+  glGetTexImage(GL_TEXTURE_2D, 0, GL_RED, GL_FLOAT, output_array);
+  glBindTexture(GL_TEXTURE_2D, 0);
+
   if (gllib::getGLError() != GL_NO_ERROR) {
-    std::cout << "SumReduce::sum enter" << std::endl;
+    std::cout << "Error: SumReduce exit" << std::endl;
+  }
+}
+
+void
+pcl::simulation::SumReduce::reduce(GLuint input_array)
+{
+  if (gllib::getGLError() != GL_NO_ERROR) {
+    std::cout << "SumReduce::reduce enter" << std::endl;
   }
 
   glDisable(GL_DEPTH_TEST);
@@ -83,7 +99,7 @@ pcl::simulation::SumReduce::sum(GLuint input_array, float* output_array)
   glUniform1i(sum_program_->getUniformLocation("ArraySampler"), 0);
 
   if (gllib::getGLError() != GL_NO_ERROR) {
-    std::cout << "SumReduce::sum  set sampler" << std::endl;
+    std::cout << "SumReduce::reduce set sampler" << std::endl;
   }
 
   for (int i = 0; i < levels_; ++i) {
@@ -103,7 +119,7 @@ pcl::simulation::SumReduce::sum(GLuint input_array, float* output_array)
     quad_.render();
 
     if (gllib::getGLError() != GL_NO_ERROR) {
-      std::cout << "SumReduce::sum  render" << std::endl;
+      std::cout << "SumReduce::reduce render" << std::endl;
     }
 
     width /= 2;
@@ -120,13 +136,7 @@ pcl::simulation::SumReduce::sum(GLuint input_array, float* output_array)
 
   glUseProgram(0);
 
-  // Final results is in arrays_[levels_-1]
-  glActiveTexture(GL_TEXTURE0);
-  glBindTexture(GL_TEXTURE_2D, arrays_[levels_ - 1]);
-  glGetTexImage(GL_TEXTURE_2D, 0, GL_RED, GL_FLOAT, output_array);
-  glBindTexture(GL_TEXTURE_2D, 0);
-
   if (gllib::getGLError() != GL_NO_ERROR) {
-    std::cout << "Error: SumReduce exit" << std::endl;
+    std::cout << "Error: SumReduce::reduce exit" << std::endl;
   }
 }
@@ -52,10 +52,21 @@ doStereoRatioFilter(const T* const acc,
                     int maxdisp,
                     int precision = 100)
 {
-  const auto sad_min_1st_part_it = std::min_element(acc, acc + dbest - 1);
-  const auto sad_min_2nd_part_it = std::min_element(acc + dbest + 2, acc + maxdisp);
-
-  const auto sad_second_min = std::min(*sad_min_1st_part_it, *sad_min_2nd_part_it);
+  // the second minimum is searched outside of [dbest - 1, dbest + 1]; either part may
+  // be empty if dbest is close to the borders of the disparity range
+  const T* const first_part_end = acc + std::max(dbest - 1, 0);
+  const T* const second_part_begin = acc + std::min(dbest + 2, maxdisp);
+  if (first_part_end == acc && second_part_begin == acc + maxdisp)
+    return dbest;
+
+  T sad_second_min;
+  if (first_part_end == acc)
+    sad_second_min = *std::min_element(second_part_begin, acc + maxdisp);
+  else if (second_part_begin == acc + maxdisp)
+    sad_second_min = *std::min_element(acc, first_part_end);
+  else
+    sad_second_min = std::min(*std::min_element(acc, first_part_end),
+                              *std::min_element(second_part_begin, acc + maxdisp));
 
   if ((sad_min * precision) > ((precision - ratio_filter) * sad_second_min)) {
     return -2;
@@ -67,6 +78,10 @@ template <class T>
 inline short int
 doStereoPeakFilter(const T* const acc, short int dbest, int peak_filter, int maxdisp)
 {
+  // the disparity has already been rejected by another filter
+  if (dbest < 0)
+    return dbest;
+
   // da and db = acc[index] - acc[dbest],
   // where index = (dbest + 2) or (dbest - 2)
   //   =>  index = dbest + 2 - (0 or 4)           = dbest - 2 + (0 or 4)
@@ -194,6 +209,15 @@ public:
     lr_check_th_ = lr_check_th;
   };
 
+  /** \brief setter for the number of threads used for stereo processing and for the
+   * computation of the point cloud
+   *
+   * \param[in] nr_threads number of threads; 0 takes as many as the budget of
+   *            pcl::ExecutionContext allows when matching
+   */
+  void
+  setNumberOfThreads(unsigned int nr_threads = 0);
+
   /** \brief stereo processing, it computes a disparity map stored internally by the
    * class
    *
@@ -328,6 +352,9 @@ protected:
   /** \brief Threshold for the left-right consistency check, typically either 0 or 1 */
   int lr_check_th_;
 
+  /** \brief The number of threads the scheduler should use. */
+  unsigned int threads_;
+
   virtual void
   preProcessing(unsigned char* img, unsigned char* pp_img) = 0;
 
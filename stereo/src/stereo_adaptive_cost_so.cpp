@@ -38,6 +38,10 @@
 
 #include "pcl/stereo/stereo_matching.h"
 
+#include <pcl/common/execution_context.h>
+
+#include <vector>
+
 //////////////////////////////////////////////////////////////////////////////
 pcl::AdaptiveCostSOStereoMatching::AdaptiveCostSOStereoMatching()
 {
@@ -58,35 +62,31 @@ pcl::AdaptiveCostSOStereoMatching::compute_impl(unsigned char* ref_img,
   // int n = radius_ * 2 + 1;
   // int sad_max = std::numeric_limits<int>::max ();
 
-  float** acc = new float*[width_];
-  for (int d = 0; d < width_; d++) {
-    acc[d] = new float[max_disp_];
-    memset(acc[d], 0, sizeof(float) * max_disp_);
-  }
+  // Every row is processed independently, with per thread buffers of size width_ x
+  // max_disp_ (element [x * max_disp_ + d]). Entries which are never written hold 0.
+  std::vector<float> acc(static_cast<std::size_t>(width_) * max_disp_, 0.0f);
 
   // data structures for Scanline Optimization
-  float** fwd = new float*[width_];
-  float** bck = new float*[width_];
-  for (int d = 0; d < width_; d++) {
-    fwd[d] = new float[max_disp_];
-    memset(fwd[d], 0, sizeof(float) * max_disp_);
-    bck[d] = new float[max_disp_];
-    memset(bck[d], 0, sizeof(float) * max_disp_);
-  }
+  std::vector<float> fwd(static_cast<std::size_t>(width_) * max_disp_, 0.0f);
+  std::vector<float> bck(static_cast<std::size_t>(width_) * max_disp_, 0.0f);
 
   // spatial distance init
-  float* ds = new float[2 * radius_ + 1];
+  std::vector<float> ds(2 * radius_ + 1);
   for (int j = -radius_; j <= radius_; j++)
     ds[j + radius_] = static_cast<float>(std::exp(-std::abs(j) / gamma_s_));
 
   // LUT for color distance weight computation
-  float lut[256];
+  std::vector<float> lut(256);
   for (int j = 0; j < 256; j++)
     lut[j] = float(std::exp(-j / gamma_c_));
 
   // left weight array alloc
-  float* wl = new float[2 * radius_ + 1];
+  std::vector<float> wl(2 * radius_ + 1);
 
+  const pcl::ThreadReservation reservation(threads_);
+  const unsigned int threads = reservation.getNumberOfThreads();
+#pragma omp parallel for default(none) shared(ref_img, trg_img, ds, lut)               \
+    firstprivate(acc, fwd, bck, wl) schedule(static) num_threads(threads)
   for (int y = radius_ + 1; y < height_ - radius_; y++) {
     for (int x = x_off_ + max_disp_ + 1; x < width_; x++) {
       for (int j = -radius_; j <= radius_; j++)
@@ -94,6 +94,7 @@ pcl::AdaptiveCostSOStereoMatching::compute_impl(unsigned char* ref_img,
             lut[std::abs(ref_img[(y + j) * width_ + x] - ref_img[y * width_ + x])] *
             ds[j + radius_];
 
+      float* acc_x = &acc[x * max_disp_];
       for (int d = 0; d < max_disp_; d++) {
         float sumw = 0.0;
         float num = 0.0;
@@ -108,109 +109,99 @@ pcl::AdaptiveCostSOStereoMatching::compute_impl(unsigned char* ref_img,
           sumw += wl[j + radius_] * weight_r;
         }
 
-        acc[x][d] = num / sumw;
+        acc_x[d] = num / sumw;
 
       } // d
     }   // x
 
     // Forward
     for (int d = 0; d < max_disp_; d++)
-      fwd[max_disp_ + 1][d] = acc[max_disp_ + 1][d];
+      fwd[(max_disp_ + 1) * max_disp_ + d] = acc[(max_disp_ + 1) * max_disp_ + d];
 
     for (int x = x_off_ + max_disp_ + 2; x < width_; x++) {
-      float c_min = fwd[x - 1][0];
+      const float* acc_x = &acc[x * max_disp_];
+      const float* prev = &fwd[(x - 1) * max_disp_];
+      float* cur = &fwd[x * max_disp_];
+
+      float c_min = prev[0];
       for (int d = 1; d < max_disp_; d++)
-        if (fwd[x - 1][d] < c_min)
-          c_min = fwd[x - 1][d];
+        if (prev[d] < c_min)
+          c_min = prev[d];
 
-      fwd[x][0] =
-          acc[x][0] - c_min +
-          std::min(fwd[x - 1][0],
-                   std::min(fwd[x - 1][1] + static_cast<float>(smoothness_weak_),
-                            c_min + static_cast<float>(smoothness_strong_)));
+      cur[0] = acc_x[0] - c_min +
+               std::min(prev[0],
+                        std::min(prev[1] + static_cast<float>(smoothness_weak_),
+                                 c_min + static_cast<float>(smoothness_strong_)));
       for (int d = 1; d < max_disp_ - 1; d++) {
-        fwd[x][d] =
-            acc[x][d] - c_min +
-            std::min(std::min(fwd[x - 1][d],
-                              fwd[x - 1][d - 1] + static_cast<float>(smoothness_weak_)),
-                     std::min(fwd[x - 1][d + 1] + static_cast<float>(smoothness_weak_),
-                              c_min + static_cast<float>(smoothness_strong_)));
+        cur[d] = acc_x[d] - c_min +
+                 std::min(std::min(prev[d],
+                                   prev[d - 1] + static_cast<float>(smoothness_weak_)),
+                          std::min(prev[d + 1] + static_cast<float>(smoothness_weak_),
+                                   c_min + static_cast<float>(smoothness_strong_)));
       }
-      fwd[x][max_disp_ - 1] =
-          acc[x][max_disp_ - 1] - c_min +
-          std::min(
-              fwd[x - 1][max_disp_ - 1],
-              std::min(fwd[x - 1][max_disp_ - 2] + static_cast<float>(smoothness_weak_),
-                       c_min + static_cast<float>(smoothness_strong_)));
+      cur[max_disp_ - 1] =
+          acc_x[max_disp_ - 1] - c_min +
+          std::min(prev[max_disp_ - 1],
+                   std::min(prev[max_disp_ - 2] + static_cast<float>(smoothness_weak_),
+                            c_min + static_cast<float>(smoothness_strong_)));
     } // x
 
     // Backward
     for (int d = 0; d < max_disp_; d++)
-      bck[width_ - 1][d] = acc[width_ - 1][d];
+      bck[(width_ - 1) * max_disp_ + d] = acc[(width_ - 1) * max_disp_ + d];
 
     for (int x = width_ - 2; x > max_disp_ + x_off_; x--) {
+      const float* acc_x = &acc[x * max_disp_];
+      const float* prev = &bck[(x + 1) * max_disp_];
+      float* cur = &bck[x * max_disp_];
 
-      float c_min = bck[x + 1][0];
+      float c_min = prev[0];
       for (int d = 1; d < max_disp_; d++)
-        if (bck[x + 1][d] < c_min)
-          c_min = bck[x + 1][d];
+        if (prev[d] < c_min)
+          c_min = prev[d];
 
-      bck[x][0] =
-          acc[x][0] - c_min +
-          std::min(bck[x + 1][0],
-                   std::min(bck[x + 1][1] + static_cast<float>(smoothness_weak_),
-                            c_min + static_cast<float>(smoothness_strong_)));
+      cur[0] = acc_x[0] - c_min +
+               std::min(prev[0],
+                        std::min(prev[1] + static_cast<float>(smoothness_weak_),
+                                 c_min + static_cast<float>(smoothness_strong_)));
       for (int d = 1; d < max_disp_ - 1; d++)
-        bck[x][d] =
-            acc[x][d] - c_min +
-            std::min(std::min(bck[x + 1][d],
-                              bck[x + 1][d - 1] + static_cast<float>(smoothness_weak_)),
-                     std::min(bck[x + 1][d + 1] + static_cast<float>(smoothness_weak_),
-                              c_min + static_cast<float>(smoothness_strong_)));
-      bck[x][max_disp_ - 1] =
-          acc[x][max_disp_ - 1] - c_min +
-          std::min(
-              bck[x + 1][max_disp_ - 1],
-              std::min(bck[x + 1][max_disp_ - 2] + static_cast<float>(smoothness_weak_),
-                       c_min + static_cast<float>(smoothness_strong_)));
+        cur[d] = acc_x[d] - c_min +
+                 std::min(std::min(prev[d],
+                                   prev[d - 1] + static_cast<float>(smoothness_weak_)),
+                          std::min(prev[d + 1] + static_cast<float>(smoothness_weak_),
+                                   c_min + static_cast<float>(smoothness_strong_)));
+      cur[max_disp_ - 1] =
+          acc_x[max_disp_ - 1] - c_min +
+          std::min(prev[max_disp_ - 1],
+                   std::min(prev[max_disp_ - 2] + static_cast<float>(smoothness_weak_),
+                            c_min + static_cast<float>(smoothness_strong_)));
     } // x
 
     // last scan
     for (int x = x_off_ + max_disp_ + 1; x < width_; x++) {
+      float* acc_x = &acc[x * max_disp_];
       float c_min = std::numeric_limits<float>::max();
       short int dbest = 0;
 
       for (int d = 0; d < max_disp_; d++) {
-        acc[x][d] = fwd[x][d] + bck[x][d];
-        if (acc[x][d] < c_min) {
-          c_min = acc[x][d];
+        acc_x[d] = fwd[x * max_disp_ + d] + bck[x * max_disp_ + d];
+        if (acc_x[d] < c_min) {
+          c_min = acc_x[d];
           dbest = static_cast<short int>(d);
         }
       }
 
       if (ratio_filter_ > 0)
-        dbest = doStereoRatioFilter(acc[x], dbest, c_min, ratio_filter_, max_disp_);
+        dbest = doStereoRatioFilter(acc_x, dbest, c_min, ratio_filter_, max_disp_);
       if (peak_filter_ > 0)
-        dbest = doStereoPeakFilter(acc[x], dbest, peak_filter_, max_disp_);
+        dbest = doStereoPeakFilter(acc_x, dbest, peak_filter_, max_disp_);
 
       disp_map_[y * width_ + x] = static_cast<short int>(dbest * 16);
 
       // subpixel refinement
       if (dbest > 0 && dbest < max_disp_ - 1)
         disp_map_[y * width_ + x] = computeStereoSubpixel(
-            dbest, acc[x][dbest - 1], acc[x][dbest], acc[x][dbest + 1]);
+            dbest, acc_x[dbest - 1], acc_x[dbest], acc_x[dbest + 1]);
     } // x
   }   // y
-
-  for (int x = 0; x < width_; x++) {
-    delete[] fwd[x];
-    delete[] bck[x];
-    delete[] acc[x];
-  }
-  delete[] fwd;
-  delete[] bck;
-  delete[] acc;
-
-  delete[] wl;
-  delete[] ds;
 }
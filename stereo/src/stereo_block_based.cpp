@@ -38,6 +38,92 @@
 
 #include "pcl/stereo/stereo_matching.h"
 
+#include <pcl/common/execution_context.h>
+
+#include <algorithm>
+#include <vector>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace {
+/** Adds |ref - trg[d]| to sums[d] for all d in [0, n). */
+inline void
+addAbsDiff(int* sums, unsigned char ref, const unsigned char* trg, int n)
+{
+  int d = 0;
+#if defined(__SSE2__)
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i a = _mm_set1_epi8(static_cast<char>(ref));
+  for (; d + 16 <= n; d += 16) {
+    const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(trg + d));
+    const __m128i ad = _mm_or_si128(_mm_subs_epu8(a, b), _mm_subs_epu8(b, a));
+    const __m128i lo = _mm_unpacklo_epi8(ad, zero);
+    const __m128i hi = _mm_unpackhi_epi8(ad, zero);
+    __m128i* s = reinterpret_cast<__m128i*>(sums + d);
+    _mm_storeu_si128(
+        s, _mm_add_epi32(_mm_loadu_si128(s), _mm_unpacklo_epi16(lo, zero)));
+    _mm_storeu_si128(
+        s + 1, _mm_add_epi32(_mm_loadu_si128(s + 1), _mm_unpackhi_epi16(lo, zero)));
+    _mm_storeu_si128(
+        s + 2, _mm_add_epi32(_mm_loadu_si128(s + 2), _mm_unpacklo_epi16(hi, zero)));
+    _mm_storeu_si128(
+        s + 3, _mm_add_epi32(_mm_loadu_si128(s + 3), _mm_unpackhi_epi16(hi, zero)));
+  }
+#endif
+  for (; d < n; d++)
+    sums[d] += std::abs(ref - trg[d]);
+}
+
+/** Adds |ref_in - trg_in[d]| - |ref_out - trg_out[d]| to sums[d] for all d in [0, n),
+ * i.e. moves the column sums down by one row. */
+inline void
+updateAbsDiff(int* sums,
+              unsigned char ref_in,
+              const unsigned char* trg_in,
+              unsigned char ref_out,
+              const unsigned char* trg_out,
+              int n)
+{
+  int d = 0;
+#if defined(__SSE2__)
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i a_in = _mm_set1_epi8(static_cast<char>(ref_in));
+  const __m128i a_out = _mm_set1_epi8(static_cast<char>(ref_out));
+  for (; d + 16 <= n; d += 16) {
+    const __m128i b_in = _mm_loadu_si128(reinterpret_cast<const __m128i*>(trg_in + d));
+    const __m128i b_out =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(trg_out + d));
+    const __m128i ad_in =
+        _mm_or_si128(_mm_subs_epu8(a_in, b_in), _mm_subs_epu8(b_in, a_in));
+    const __m128i ad_out =
+        _mm_or_si128(_mm_subs_epu8(a_out, b_out), _mm_subs_epu8(b_out, a_out));
+    // 16 bit differences, sign extended to 32 bit by unpacking them with themselves
+    const __m128i lo = _mm_sub_epi16(_mm_unpacklo_epi8(ad_in, zero),
+                                     _mm_unpacklo_epi8(ad_out, zero));
+    const __m128i hi = _mm_sub_epi16(_mm_unpackhi_epi8(ad_in, zero),
+                                     _mm_unpackhi_epi8(ad_out, zero));
+    __m128i* s = reinterpret_cast<__m128i*>(sums + d);
+    _mm_storeu_si128(s,
+                     _mm_add_epi32(_mm_loadu_si128(s),
+                                   _mm_srai_epi32(_mm_unpacklo_epi16(lo, lo), 16)));
+    _mm_storeu_si128(s + 1,
+                     _mm_add_epi32(_mm_loadu_si128(s + 1),
+                                   _mm_srai_epi32(_mm_unpackhi_epi16(lo, lo), 16)));
+    _mm_storeu_si128(s + 2,
+                     _mm_add_epi32(_mm_loadu_si128(s + 2),
+                                   _mm_srai_epi32(_mm_unpacklo_epi16(hi, hi), 16)));
+    _mm_storeu_si128(s + 3,
+                     _mm_add_epi32(_mm_loadu_si128(s + 3),
+                                   _mm_srai_epi32(_mm_unpackhi_epi16(hi, hi), 16)));
+  }
+#endif
+  for (; d < n; d++)
+    sums[d] += std::abs(ref_in - trg_in[d]) - std::abs(ref_out - trg_out[d]);
+}
+} // namespace
+
 //////////////////////////////////////////////////////////////////////////////
 pcl::BlockBasedStereoMatching::BlockBasedStereoMatching()
 {
@@ -49,110 +135,98 @@ void
 pcl::BlockBasedStereoMatching::compute_impl(unsigned char* ref_img,
                                             unsigned char* trg_img)
 {
-  int n = radius_ * 2 + 1;
-  int sad_min;
-  short int dbest = 0;
-
-  int sad_max = std::numeric_limits<int>::max();
-
-  int* acc = new int[max_disp_];
-  memset(acc, 0, sizeof(int) * max_disp_);
-
-  int** v = new int*[width_];
-  for (int d = 0; d < width_; d++) {
-    v[d] = new int[max_disp_];
-    memset(v[d], 0, sizeof(int) * max_disp_);
-  }
-
-  // First row
-  for (int x = max_disp_ + x_off_; x < max_disp_ + x_off_ + n; x++) {
-    for (int d = 0; d < max_disp_; d++) {
-      for (int y = 0; y < n; y++)
-        v[x][d] +=
-            std::abs(ref_img[y * width_ + x] - trg_img[y * width_ + x - d - x_off_]);
-      // acc[d] += V[x][d];
-    }
-  }
-
-  // STAGE 2: other positions
-  for (int x = max_disp_ + x_off_ + radius_ + 1; x < width_ - radius_; x++) {
-    for (int d = 0; d < max_disp_; d++) {
-      for (int y = 0; y < n; y++) {
-        v[x + radius_][d] += std::abs(ref_img[y * width_ + x + radius_] -
-                                      trg_img[y * width_ + x + radius_ - d - x_off_]);
-      }
-      acc[d] += v[x + radius_][d] - v[x - radius_ - 1][d];
-    } // d
-  }   // x
-
-  // 2
-  const int ind1 = radius_ + radius_ + max_disp_ + x_off_;
-
-  for (int y = radius_ + 1; y < height_ - radius_; y++) {
-    // first position
-    for (int d = 0; d < max_disp_; d++) {
-      acc[d] = 0;
-      for (int x = max_disp_ + x_off_; x < max_disp_ + x_off_ + n; x++) {
-        v[x][d] += std::abs(ref_img[(y + radius_) * width_ + x] -
-                            trg_img[(y + radius_) * width_ + x - d - x_off_]) -
-                   std::abs(ref_img[(y - radius_ - 1) * width_ + x] -
-                            trg_img[(y - radius_ - 1) * width_ + x - d - x_off_]);
-
-        acc[d] += v[x][d];
+  int y_begin = radius_ + 1;
+  int y_end = height_ - radius_;
+  int x_begin = max_disp_ + x_off_;
+  if (y_end <= y_begin || x_begin >= width_)
+    return;
+
+  // The target image with mirrored rows, so that the pixels matched against a
+  // reference pixel at increasing disparities are contiguous in memory:
+  // trg_img[y * width_ + x - d - x_off_] == trg_rev[y * width_ + width_ - 1 - x +
+  // x_off_ + d]
+  std::vector<unsigned char> trg_rev(static_cast<std::size_t>(width_) * height_);
+  for (int y = 0; y < height_; y++)
+    std::reverse_copy(trg_img + y * width_,
+                      trg_img + (y + 1) * width_,
+                      trg_rev.begin() + y * width_);
+
+  // The rows are split in one band per thread. Each band starts with a full
+  // evaluation of the column sums and then moves them down row by row.
+  const pcl::ThreadReservation reservation(threads_);
+  const unsigned int threads = reservation.getNumberOfThreads();
+  int nr_bands = std::min(static_cast<int>(threads), y_end - y_begin);
+
+  // v[x * max_disp_ + d]: SAD of column x over the rows of the window at disparity d
+  std::vector<int> v(static_cast<std::size_t>(width_) * max_disp_);
+  // acc[d]: SAD of the whole window at disparity d
+  std::vector<int> acc(max_disp_);
+
+#pragma omp parallel for default(none)                                                 \
+    shared(ref_img, trg_rev, nr_bands, y_begin, y_end, x_begin) firstprivate(v, acc)    \
+    schedule(static, 1) num_threads(threads)
+  for (int band = 0; band < nr_bands; band++) {
+    const int band_begin = y_begin + (y_end - y_begin) * band / nr_bands;
+    const int band_end = y_begin + (y_end - y_begin) * (band + 1) / nr_bands;
+
+    for (int y = band_begin; y < band_end; y++) {
+      // column sums of the window centered at row y
+      if (y == band_begin) {
+        std::fill(v.begin(), v.end(), 0);
+        for (int yy = y - radius_; yy <= y + radius_; yy++)
+          for (int x = x_begin; x < width_; x++)
+            addAbsDiff(&v[x * max_disp_],
+                       ref_img[yy * width_ + x],
+                       &trg_rev[yy * width_ + width_ - 1 - x + x_off_],
+                       max_disp_);
       }
-    }
-
-    // all other positions
-    unsigned char* lp =
-        static_cast<unsigned char*>(ref_img) + (y + radius_) * width_ + ind1;
-    unsigned char* rp =
-        static_cast<unsigned char*>(trg_img) + (y + radius_) * width_ + ind1 - x_off_;
-    unsigned char* lpp =
-        static_cast<unsigned char*>(ref_img) + (y - radius_ - 1) * width_ + ind1;
-    unsigned char* rpp = static_cast<unsigned char*>(trg_img) +
-                         (y - radius_ - 1) * width_ + ind1 - x_off_;
-
-    for (int x = max_disp_ + x_off_ + radius_ + 1; x < width_ - radius_; x++) {
-      sad_min = sad_max;
-
-      lp++;
-      rp++;
-      lpp++;
-      rpp++;
-
-      for (int d = 0; d < max_disp_; d++) {
-        v[x + radius_][d] += std::abs(*lp - *rp) - std::abs(*lpp - *rpp);
-        rp--;
-        rpp--;
-
-        acc[d] += v[x + radius_][d] - v[x - radius_ - 1][d];
-
-        if (acc[d] < sad_min) {
-          sad_min = acc[d];
-          dbest = static_cast<short int>(d);
-        }
+      else {
+        const int y_in = y + radius_;
+        const int y_out = y - radius_ - 1;
+        for (int x = x_begin; x < width_; x++)
+          updateAbsDiff(&v[x * max_disp_],
+                        ref_img[y_in * width_ + x],
+                        &trg_rev[y_in * width_ + width_ - 1 - x + x_off_],
+                        ref_img[y_out * width_ + x],
+                        &trg_rev[y_out * width_ + width_ - 1 - x + x_off_],
+                        max_disp_);
       }
 
-      rp += max_disp_;
-      rpp += max_disp_;
-
-      if (ratio_filter_ > 0)
-        dbest = doStereoRatioFilter(acc, dbest, sad_min, ratio_filter_, max_disp_);
-      if (peak_filter_ > 0)
-        dbest = doStereoPeakFilter(acc, dbest, peak_filter_, max_disp_);
-
-      disp_map_[y * width_ + x] = static_cast<short int>(dbest * 16);
-
-      // subpixel refinement
-      if (dbest > 0 && dbest < max_disp_ - 1)
-        disp_map_[y * width_ + x] =
-            computeStereoSubpixel(dbest, acc[dbest - 1], acc[dbest], acc[dbest + 1]);
-
-    } // x
-  }   // y
+      // first position
+      std::fill(acc.begin(), acc.end(), 0);
+      for (int x = x_begin; x < x_begin + 2 * radius_ + 1 && x < width_; x++)
+        for (int d = 0; d < max_disp_; d++)
+          acc[d] += v[x * max_disp_ + d];
+
+      // all other positions
+      for (int x = x_begin + radius_ + 1; x < width_ - radius_; x++) {
+        const int* v_in = &v[(x + radius_) * max_disp_];
+        const int* v_out = &v[(x - radius_ - 1) * max_disp_];
+        for (int d = 0; d < max_disp_; d++)
+          acc[d] += v_in[d] - v_out[d];
+
+        int sad_min = std::numeric_limits<int>::max();
+        short int dbest = 0;
+        for (int d = 0; d < max_disp_; d++) {
+          if (acc[d] < sad_min) {
+            sad_min = acc[d];
+            dbest = static_cast<short int>(d);
+          }
+        }
 
-  for (int d = 0; d < width_; d++)
-    delete[] v[d];
-  delete[] v;
-  delete[] acc;
+        if (ratio_filter_ > 0)
+          dbest =
+              doStereoRatioFilter(acc.data(), dbest, sad_min, ratio_filter_, max_disp_);
+        if (peak_filter_ > 0)
+          dbest = doStereoPeakFilter(acc.data(), dbest, peak_filter_, max_disp_);
+
+        disp_map_[y * width_ + x] = static_cast<short int>(dbest * 16);
+
+        // subpixel refinement
+        if (dbest > 0 && dbest < max_disp_ - 1)
+          disp_map_[y * width_ + x] =
+              computeStereoSubpixel(dbest, acc[dbest - 1], acc[dbest], acc[dbest + 1]);
+      } // x
+    }   // y
+  }     // band
 }
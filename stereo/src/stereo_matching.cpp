@@ -38,6 +38,7 @@
 
 #include "pcl/stereo/stereo_matching.h"
 
+#include <pcl/common/execution_context.h>
 #include <pcl/console/print.h> // for PCL_ERROR
 
 //////////////////////////////////////////////////////////////////////////////
@@ -64,6 +65,16 @@ pcl::StereoMatching::StereoMatching()
   is_pre_proc_ = false;
   is_lr_check_ = false;
   lr_check_th_ = 1;
+
+  setNumberOfThreads();
+}
+
+//////////////////////////////////////////////////////////////////////////////
+void
+pcl::StereoMatching::setNumberOfThreads(unsigned int nr_threads)
+{
+  // 0 is resolved against the budget of pcl::ExecutionContext at compute time
+  threads_ = nr_threads;
 }
 
 //////////////////////////////////////////////////////////////////////////////
@@ -218,8 +229,6 @@ pcl::StereoMatching::getPointCloud(float u_c,
     cloud->is_dense = false;
   }
 
-  // Loop
-  pcl::PointXYZRGB temp_point;
   /*pcl::PointXYZRGB nan_point;
   nan_point.x = std::numeric_limits<float>::quiet_NaN();
   nan_point.y = std::numeric_limits<float>::quiet_NaN();
@@ -232,7 +241,13 @@ pcl::StereoMatching::getPointCloud(float u_c,
   // this must be taken into account when computing z values
   float depth_scale = baseline * focal * 16.0f;
 
+  // Loop
+  const pcl::ThreadReservation reservation(threads_);
+  const unsigned int threads = reservation.getNumberOfThreads();
+#pragma omp parallel for default(none)                                                 \
+    shared(cloud, texture, u_c, v_c, focal, depth_scale) num_threads(threads)
   for (int j = 0; j < height_; j++) {
+    pcl::PointXYZRGB temp_point;
     for (int i = 0; i < width_; i++) {
       if (disp_map_[j * width_ + i] > 0) {
         temp_point.z = (depth_scale) / (disp_map_[j * width_ + i]);
@@ -295,8 +310,6 @@ pcl::StereoMatching::getPointCloud(float u_c,
   if (cloud->is_dense)
     cloud->is_dense = false;
 
-  // Loop
-  pcl::PointXYZ temp_point;
   pcl::PointXYZ nan_point;
   nan_point.x = std::numeric_limits<float>::quiet_NaN();
   nan_point.y = std::numeric_limits<float>::quiet_NaN();
@@ -307,7 +320,13 @@ pcl::StereoMatching::getPointCloud(float u_c,
   // this must be taken into account when computing z values
   float depth_scale = baseline * focal * 16.0f;
 
+  // Loop
+  const pcl::ThreadReservation reservation(threads_);
+  const unsigned int threads = reservation.getNumberOfThreads();
+#pragma omp parallel for default(none)                                                 \
+    shared(cloud, nan_point, u_c, v_c, focal, depth_scale) num_threads(threads)
   for (int j = 0; j < height_; j++) {
+    pcl::PointXYZ temp_point;
     for (int i = 0; i < width_; i++) {
       if (disp_map_[j * width_ + i] > 0) {
 
@@ -522,6 +541,9 @@ pcl::GrayStereoMatching::compute(unsigned char* ref_img,
     preProcessing(trg_img, pp_trg_img_);
   }
 
+  // Both passes of compute_impl share this reservation
+  const pcl::ThreadReservation reservation(threads_);
+
   if (is_lr_check_) {
 
     if (is_pre_proc_) {
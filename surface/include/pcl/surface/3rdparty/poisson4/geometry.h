@@ -284,7 +284,8 @@ namespace pcl
         int outOfCorePointCount( void );
         int polygonCount( void );
     };
-    class CoredFileMeshData : public CoredMeshData
+    // Stores the out-of-core points and the polygons in temporary files
+    class PCL_EXPORTS CoredFileMeshData : public CoredMeshData
     {
         FILE *oocPointFile , *polygonFile;
         int oocPoints , polygons;
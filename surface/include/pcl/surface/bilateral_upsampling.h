@@ -81,6 +81,7 @@ namespace pcl
         : window_size_ (5)
         , sigma_color_ (15.0f)
         , sigma_depth_ (0.5f)
+        , threads_ (1)
       {
         KinectVGAProjectionMatrix << 525.0f, 0.0f, 320.0f,
                                      0.0f, 525.0f, 240.0f,
@@ -120,6 +121,17 @@ namespace pcl
       inline float
       getSigmaDepth () const { return (sigma_depth_); }
 
+      /** \brief Set the number of threads used to process the rows of the output cloud.
+        * \param[in] nr_threads the number of hardware threads to use (0 takes as many as the budget of
+        * pcl::ExecutionContext allows when upsampling)
+        */
+      void
+      setNumberOfThreads (unsigned int nr_threads = 0);
+
+      /** \brief Returns the number of threads used to process the rows of the output cloud */
+      inline unsigned int
+      getNumberOfThreads () const { return (threads_); }
+
       /** \brief Method that sets the projection matrix to be used when unprojecting the points in the depth image
         * back to (x,y,z) positions.
         * \note There are 2 matrices already set in the class, used for the 2 modes available for the Kinect. They
@@ -150,6 +162,7 @@ namespace pcl
     private:
       int window_size_;
       float sigma_color_, sigma_depth_;
+      unsigned int threads_;
       Eigen::Matrix3f projection_matrix_, unprojection_matrix_;
 
     public:
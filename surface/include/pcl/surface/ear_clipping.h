@@ -58,14 +58,38 @@ namespace pcl
       using MeshProcessing::input_mesh_;
       using MeshProcessing::initCompute;
       /** \brief Empty constructor */
-      EarClipping ()
+      EarClipping () : use_spatial_index_ (false)
       { 
       };
 
+      /** \brief Set whether ears are searched with a spatial index.
+        * \details If enabled, each polygon is projected onto its plane and ears are clipped from a linked list of
+        * its vertices. An ear is only tested against the reflex vertices inside its bounding box, which are found
+        * along a z-order curve over the polygon (as in the earcut library). Large polygons are then triangulated
+        * in about O(n log n) instead of O(n^3), and the triangles keep the winding of the input polygon.
+        * The polygons should be simple, self-intersecting ones are triangulated as far as possible.
+        * \param[in] use_spatial_index true to use the spatial index (default: false)
+        */
+      inline void
+      setUseSpatialIndex (bool use_spatial_index)
+      {
+        use_spatial_index_ = use_spatial_index;
+      }
+
+      /** \brief Get whether ears are searched with a spatial index. */
+      inline bool
+      getUseSpatialIndex () const
+      {
+        return (use_spatial_index_);
+      }
+
     protected:
       /** \brief a Pointer to the point cloud data. */
       pcl::PointCloud<pcl::PointXYZ>::Ptr points_;
 
+      /** \brief Whether ears are searched with a spatial index. */
+      bool use_spatial_index_;
+
       /** \brief This method should get called before starting the actual computation. */
       bool
       initCompute () override;
@@ -83,6 +107,13 @@ namespace pcl
       void
       triangulate (const Vertices& vertices, PolygonMesh& output);
 
+      /** \brief Triangulate one polygon in its plane, searching the ears with a z-order index.
+        * \param[in] vertices the set of vertices
+        * \param[out] output the resultant polygonal mesh
+        */
+      void
+      triangulateIndexed (const Vertices& vertices, PolygonMesh& output);
+
       /** \brief Compute the signed area of a polygon. 
         * \param[in] vertices the vertices representing the polygon 
         */
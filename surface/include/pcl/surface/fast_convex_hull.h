@@ -0,0 +1,278 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#pragma once
+
+#include <pcl/memory.h>
+#include <pcl/pcl_macros.h>
+#include <pcl/PointIndices.h>
+#include <pcl/PolygonMesh.h>
+#include <pcl/surface/reconstruction.h>
+
+#include <array>
+
+namespace pcl
+{
+  /** \brief @b FastConvexHull computes the convex hull of a point cloud without qhull.
+    *
+    * 2D hulls (points lying on a plane) are computed with Andrew's monotone chain on the projection of the points onto
+    * their plane, and 3D hulls with quickhull. The output follows ConvexHull: in the 2D case \a polygons holds a single
+    * polygon with the hull points in counter-clockwise order around the plane normal, in the 3D case one triangle per
+    * facet, with vertices in counter-clockwise order seen from outside the hull.
+    *
+    * All the state, including the quickhull workspace, lives in the instance and is reused between calls, so computing
+    * many small hulls in a row does not allocate once the workspace has grown, and separate instances can run in
+    * parallel, e.g. one per thread over a set of clusters.
+    * \ingroup surface
+    */
+  template<typename PointInT>
+  class FastConvexHull : public MeshConstruction<PointInT>
+  {
+    protected:
+      using PCLBase<PointInT>::input_;
+      using PCLBase<PointInT>::indices_;
+      using PCLBase<PointInT>::initCompute;
+      using PCLBase<PointInT>::deinitCompute;
+      using MeshConstruction<PointInT>::check_tree_;
+
+    public:
+      using Ptr = shared_ptr<FastConvexHull<PointInT> >;
+      using ConstPtr = shared_ptr<const FastConvexHull<PointInT> >;
+
+      using MeshConstruction<PointInT>::reconstruct;
+
+      using PointCloud = pcl::PointCloud<PointInT>;
+      using PointCloudPtr = typename PointCloud::Ptr;
+      using PointCloudConstPtr = typename PointCloud::ConstPtr;
+
+      /** \brief Empty constructor. */
+      FastConvexHull () : compute_area_ (false), total_area_ (0), total_volume_ (0), dimension_ (0), hull_dimension_ (0)
+      {
+        check_tree_ = false;
+      }
+
+      /** \brief Compute a convex hull for all points given.
+        * \param[out] points the resultant points lying on the convex hull.
+        * \param[out] polygons the resultant convex hull polygons, as a set of
+        * vertices. The Vertices structure contains an array of point indices.
+        */
+      void
+      reconstruct (PointCloud &points,
+                   std::vector<pcl::Vertices> &polygons);
+
+      /** \brief Compute a convex hull for all points given.
+        * \param[out] points the resultant points lying on the convex hull.
+        */
+      void
+      reconstruct (PointCloud &points);
+
+      /** \brief Set whether the total area and volume of the hull are computed.
+        * \param[in] value whether to compute the area and the volume, default is false
+        */
+      inline void
+      setComputeAreaVolume (bool value) { compute_area_ = value; }
+
+      /** \brief Returns the total area of the convex hull (the area of the polygon for 2D sets). */
+      inline double
+      getTotalArea () const { return (total_area_); }
+
+      /** \brief Returns the total volume of the convex hull. Only valid for 3-dimensional sets, zero for 2D sets. */
+      inline double
+      getTotalVolume () const { return (total_volume_); }
+
+      /** \brief Sets the dimension on the input data, 2D or 3D.
+        * \param[in] dimension The dimension of the input data.  If not set, this will be determined automatically.
+        */
+      void
+      setDimension (int dimension)
+      {
+        if ((dimension == 2) || (dimension == 3))
+          dimension_ = dimension;
+        else
+          PCL_ERROR ("[pcl::%s::setDimension] Invalid input dimension specified!\n", getClassName ().c_str ());
+      }
+
+      /** \brief Returns the dimensionality (2 or 3) of the calculated hull, or the one set if none was calculated yet.
+        * \note Unlike ConvexHull, a dimension determined automatically is not kept for the next input.
+        */
+      inline int
+      getDimension () const { return (hull_dimension_ != 0 ? hull_dimension_ : dimension_); }
+
+      /** \brief Retrieve the indices of the input point cloud that form the convex hull.
+        * \note Should only be called after reconstruction was performed.
+        * \param[out] hull_point_indices The indices of the points forming the point cloud
+        */
+      inline void
+      getHullPointIndices (pcl::PointIndices &hull_point_indices) const { hull_point_indices = hull_indices_; }
+
+    protected:
+      /** \brief The actual reconstruction method, dispatching on the dimension.
+        * \param[out] points the resultant points lying on the convex hull
+        * \param[out] polygons the resultant convex hull polygons
+        * \param[in] fill_polygon_data true if polygons should be filled, false otherwise
+        * \return false if the hull could not be computed
+        */
+      bool
+      performReconstruction (PointCloud &points,
+                             std::vector<pcl::Vertices> &polygons,
+                             bool fill_polygon_data);
+
+      /** \brief Monotone chain on the projection of the input onto its best fitting plane.
+        * \param[out] points the resultant points lying on the convex hull
+        * \param[out] polygons the resultant convex hull polygon
+        * \param[in] fill_polygon_data true if polygons should be filled, false otherwise
+        * \return false if the input is degenerate (all points on a line)
+        */
+      bool
+      performReconstruction2D (PointCloud &points,
+                               std::vector<pcl::Vertices> &polygons,
+                               bool fill_polygon_data);
+
+      /** \brief Quickhull on the input.
+        * \param[out] points the resultant points lying on the convex hull
+        * \param[out] polygons the resultant convex hull facets
+        * \param[in] fill_polygon_data true if polygons should be filled, false otherwise
+        * \return false if the input is degenerate; planar input falls back to performReconstruction2D ()
+        */
+      bool
+      performReconstruction3D (PointCloud &points,
+                               std::vector<pcl::Vertices> &polygons,
+                               bool fill_polygon_data);
+
+      /** \brief A reconstruction method that returns a polygonmesh.
+        * \param[out] output a PolygonMesh representing the convex hull of the input data.
+        */
+      void
+      performReconstruction (PolygonMesh &output) override;
+
+      /** \brief A reconstruction method that returns the polygon of the convex hull.
+        * \param[out] polygons the polygon(s) representing the convex hull of the input data.
+        */
+      void
+      performReconstruction (std::vector<pcl::Vertices> &polygons) override;
+
+      /** \brief Automatically determines the dimension of input data - 2D or 3D. */
+      int
+      calculateInputDimension () const;
+
+      /** \brief Copy the hull points, given by their position in \a indices_, to the output. */
+      void
+      copyHull (const std::vector<int> &hull, PointCloud &points);
+
+      /** \brief Class get name method. */
+      std::string
+      getClassName () const override { return ("FastConvexHull"); }
+
+      /** \brief A triangle of the quickhull workspace. */
+      struct Face
+      {
+        /** \brief Vertices, as positions in \a indices_, counter-clockwise seen from outside. */
+        int vertices[3];
+        /** \brief The face across the edge from vertices[k] to vertices[(k + 1) % 3]. */
+        int neighbors[3];
+        /** \brief Outward unit normal. */
+        Eigen::Vector3d normal;
+        /** \brief Distance of the plane from the origin along the normal. */
+        double offset;
+        /** \brief The points above the face, as positions in \a indices_. */
+        std::vector<int> outside;
+        /** \brief Last iteration in which the face was visited. */
+        int visited;
+        bool visible;
+        bool alive;
+
+        inline double
+        distance (const Eigen::Vector3d &p) const { return (normal.dot (p) - offset); }
+      };
+
+      /** \brief Allocate a face of the workspace, reusing a dead one if possible. */
+      int
+      addFace (int a, int b, int c);
+
+      /* \brief True if we should compute the area and volume of the convex hull. */
+      bool compute_area_;
+
+      /* \brief The area of the convex hull. */
+      double total_area_;
+
+      /* \brief The volume of the convex hull (only for 3D hulls, zero for 2D). */
+      double total_volume_;
+
+      /** \brief The dimensionality of the input set by the user (2D or 3D), 0 to determine it automatically. */
+      int dimension_;
+
+      /** \brief The dimensionality of the last calculated hull. */
+      int hull_dimension_;
+
+      /* \brief vector containing the point cloud indices of the convex hull points. */
+      pcl::PointIndices hull_indices_;
+
+      /** \brief Workspace: the input coordinates, in double precision. */
+      std::vector<Eigen::Vector3d, Eigen::aligned_allocator<Eigen::Vector3d> > coords_;
+      /** \brief Workspace: the faces, alive and dead. */
+      std::vector<Face> faces_;
+      /** \brief Workspace: the dead faces available for reuse. */
+      std::vector<int> free_faces_;
+      /** \brief Workspace: faces whose outside set is still to be processed. */
+      std::vector<int> pending_;
+      /** \brief Workspace: the visible faces, the horizon edges (from, to, face beyond) and the new faces of the
+        * current iteration.
+        */
+      std::vector<int> visible_;
+      std::vector<std::array<int, 3> > horizon_;
+      std::vector<int> new_faces_;
+      /** \brief Workspace: the orphaned outside points of the current iteration. */
+      std::vector<int> orphans_;
+      /** \brief Workspace: per point, the new faces starting and ending at it, the last iteration it was on the
+        * horizon, and its output vertex index.
+        */
+      std::vector<int> start_face_;
+      std::vector<int> end_face_;
+      std::vector<int> vertex_stamp_;
+      std::vector<int> vertex_map_;
+      /** \brief Workspace: the 2D coordinates and the chain of the monotone chain algorithm. */
+      std::vector<std::pair<Eigen::Vector2d, int>, Eigen::aligned_allocator<std::pair<Eigen::Vector2d, int> > > projected_;
+      std::vector<int> chain_;
+
+    public:
+      PCL_MAKE_ALIGNED_OPERATOR_NEW
+  };
+}
+
+#ifdef PCL_NO_PRECOMPILE
+#include <pcl/surface/impl/fast_convex_hull.hpp>
+#endif
@@ -44,7 +44,9 @@
 
 #include <pcl/kdtree/kdtree.h>
 
+#include <cstdint>
 #include <fstream>
+#include <functional>
 
 #include <Eigen/Geometry> // for cross
 
@@ -136,6 +138,7 @@ namespace pcl
       using MeshConstruction<PointInT>::tree_;
       using MeshConstruction<PointInT>::input_;
       using MeshConstruction<PointInT>::indices_;
+      using MeshConstruction<PointInT>::check_tree_;
 
       using KdTree = pcl::KdTree<PointInT>;
       using KdTreePtr = typename KdTree::Ptr;
@@ -144,6 +147,9 @@ namespace pcl
       using PointCloudInPtr = typename PointCloudIn::Ptr;
       using PointCloudInConstPtr = typename PointCloudIn::ConstPtr;
 
+      /** \brief Function receiving the triangles of one tile, see setTileCallback (). */
+      using TileCallback = std::function<void (const std::vector<pcl::Vertices> &)>;
+
       enum GP3Type
       { 
         NONE = -1,    // not-defined
@@ -174,7 +180,10 @@ namespace pcl
         changed_1st_fn_ (false),
         changed_2nd_fn_ (false),
         new2boundary_ (),
-        already_connected_ (false)
+        already_connected_ (false),
+        tile_size_ (0),
+        tile_overlap_ (0),
+        threads_ (1)
       {};
 
       /** \brief Set the multiplier of the nearest neighbor distance to obtain the final search radius for each point
@@ -277,6 +286,53 @@ namespace pcl
       getPartIDs () const { return (part_); }
 
 
+      /** \brief Triangulate the cloud in cubic tiles of the given edge length instead of all at once.
+        * \details Each tile is triangulated on its own together with the points within the tile overlap
+        * around it, and keeps the triangles whose centroid lies inside it. Triangles near the tile faces are
+        * stitched by dropping those that would give an edge more than two triangles. The memory needed
+        * is then bounded by the size of the tiles processed at the same time instead of the size of the cloud,
+        * and the tiles are processed in parallel, see setNumberOfThreads ().
+        * \param[in] tile_size the edge length of the tiles, 0 to disable tiling (default)
+        * \note The tiles should be much larger than the search radius. In tiled mode, getPointStates (),
+        * getPartIDs (), getSFN () and getFFN () are empty.
+        */
+      inline void
+      setTileSize (double tile_size) { tile_size_ = tile_size; check_tree_ = !(tile_size > 0); }
+
+      /** \brief Get the edge length of the tiles (0 if tiling is disabled). */
+      inline double
+      getTileSize () const { return (tile_size_); }
+
+      /** \brief Set the width of the border around each tile whose points are triangulated with the tile.
+        * \param[in] tile_overlap the overlap between adjacent tiles, 0 to use twice the search radius (default)
+        */
+      inline void
+      setTileOverlap (double tile_overlap) { tile_overlap_ = tile_overlap; }
+
+      /** \brief Get the overlap between adjacent tiles. */
+      inline double
+      getTileOverlap () const { return (tile_overlap_); }
+
+      /** \brief Set a function receiving the stitched triangles of each tile as soon as they are available.
+        * \details The function is called from the calling thread, in tile order, with triangles indexing the
+        * input as the regular output does. When it is set, the triangles are not accumulated in the output,
+        * so arbitrarily large meshes can be written out chunk by chunk.
+        * \param[in] callback the function to call, or an empty function to accumulate the output (default)
+        * \note Only used in tiled mode, see setTileSize ().
+        */
+      inline void
+      setTileCallback (const TileCallback &callback) { tile_callback_ = callback; }
+
+      /** \brief Set the number of threads used to triangulate the tiles.
+        * \param[in] nr_threads the number of hardware threads to use (0 takes as many as the budget of pcl::ExecutionContext allows when triangulating)
+        */
+      void
+      setNumberOfThreads (unsigned int nr_threads = 0);
+
+      /** \brief Get the number of threads used to triangulate the tiles. */
+      inline unsigned int
+      getNumberOfThreads () const { return (threads_); }
+
       /** \brief Get the sfn list. */
       inline pcl::Indices
       getSFN () const { return (sfn_); }
@@ -395,6 +451,15 @@ namespace pcl
       /** \brief Temporary variable to store 3 coordinates **/
       Eigen::Vector3f tmp_;
 
+      /** \brief Edge length of the tiles, 0 if tiling is disabled **/
+      double tile_size_;
+      /** \brief Overlap between adjacent tiles, 0 for twice the search radius **/
+      double tile_overlap_;
+      /** \brief The number of threads the scheduler should use **/
+      unsigned int threads_;
+      /** \brief Function receiving the triangles of each tile **/
+      TileCallback tile_callback_;
+
       /** \brief The actual surface reconstruction method.
         * \param[out] output the resultant polygonal mesh
         */
@@ -413,6 +478,12 @@ namespace pcl
       bool
       reconstructPolygons (std::vector<pcl::Vertices> &polygons);
 
+      /** \brief Triangulate the cloud tile by tile and stitch the tiles, see setTileSize ().
+        * \param[out] polygons the resultant polygons, empty if a tile callback is set
+        */
+      bool
+      reconstructTiled (std::vector<pcl::Vertices> &polygons);
+
       /** \brief Class get name method. */
       std::string 
       getClassName () const override { return ("GreedyProjectionTriangulation"); }
@@ -89,7 +89,7 @@ namespace pcl
       /** \brief Data leaf. */
       struct Leaf
       {
-        Leaf () {}
+        Leaf () : pt_on_surface (Eigen::Vector4f::Zero ()), vect_at_grid_pt (Eigen::Vector3f::Zero ()) {}
 
         pcl::Indices data_indices;
         Eigen::Vector4f pt_on_surface; 
@@ -174,6 +174,21 @@ namespace pcl
         return (max_binary_search_level_);
       }
 
+      /** \brief Set the number of threads used to compute the vectors and projections of the cells and to
+        * extract the surface.
+        * \param[in] nr_threads the number of hardware threads to use (0 takes as many as the budget of
+        * pcl::ExecutionContext allows when reconstructing)
+        */
+      void
+      setNumberOfThreads (unsigned int nr_threads = 0);
+
+      /** \brief Get the number of threads used to process the cells. */
+      inline unsigned int
+      getNumberOfThreads () const
+      {
+        return (threads_);
+      }
+
       ///////////////////////////////////////////////////////////
       inline const HashMap& 
       getCellHashMap () const
@@ -324,7 +339,20 @@ namespace pcl
         * \param pt_union_indices the union of input data points within the cell and padding cells
         */
       void 
-      createSurfaceForCell (const Eigen::Vector3i &index, pcl::Indices &pt_union_indices);
+      createSurfaceForCell (const Eigen::Vector3i &index, pcl::Indices &pt_union_indices)
+      {
+        createSurfaceForCell (index, pt_union_indices, surface_);
+      }
+
+      /** \brief Given the index of a cell, exam it's up, left, front edges, and add
+        * the vectices to the given list of surface points.
+        * \param index the input index
+        * \param pt_union_indices the union of input data points within the cell and padding cells
+        * \param surface the list the vertices of the polygons are appended to
+        */
+      void 
+      createSurfaceForCell (const Eigen::Vector3i &index, pcl::Indices &pt_union_indices,
+                            std::vector<Eigen::Vector4f, Eigen::aligned_allocator<Eigen::Vector4f> > &surface);
 
 
       /** \brief Given the coordinates of one point, project it onto the surface, 
@@ -497,6 +525,9 @@ namespace pcl
       /** \brief Bit map which tells if there is any input data point in the cell. */
       boost::dynamic_bitset<> occupied_cell_list_;
 
+      /** \brief The number of threads used to process the cells. */
+      unsigned int threads_;
+
       /** \brief Class get name method. */
       std::string getClassName () const override { return ("GridProjection"); }
 
@@ -40,11 +40,20 @@
 #define PCL_SURFACE_IMPL_BILATERAL_UPSAMPLING_H_
 
 #include <pcl/surface/bilateral_upsampling.h>
+#include <pcl/common/execution_context.h>
 #include <algorithm>
 #include <pcl/console/print.h>
 
 #include <Eigen/LU> // for inverse
 
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointInT, typename PointOutT> void
+pcl::BilateralUpsampling<PointInT, PointOutT>::setNumberOfThreads (unsigned int nr_threads)
+{
+  // 0 is resolved against the budget of pcl::ExecutionContext at compute time
+  threads_ = nr_threads;
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointInT, typename PointOutT> void
 pcl::BilateralUpsampling<PointInT, PointOutT>::process (pcl::PointCloud<PointOutT> &output)
@@ -94,55 +103,70 @@ pcl::BilateralUpsampling<PointInT, PointOutT>::performProcessing (PointCloudOut
     Eigen::VectorXf val_exp_rgb_vector;
     computeDistances (val_exp_depth_matrix, val_exp_rgb_vector);
 
-    for (int x = 0; x < static_cast<int> (input_->width); ++x)
-      for (int y = 0; y < static_cast<int> (input_->height); ++y)
+    int width = static_cast<int> (input_->width);
+    int height = static_cast<int> (input_->height);
+
+    // the rows are independent, each one is traversed in memory order
+    const pcl::ThreadReservation reservation (threads_);
+    const unsigned int threads = reservation.getNumberOfThreads ();
+#pragma omp parallel for \
+  default(none) \
+  shared(height, nan, output, val_exp_depth_matrix, val_exp_rgb_vector, width) \
+  schedule(dynamic, 4) \
+  num_threads(threads)
+    for (int y = 0; y < height; ++y)
+      for (int x = 0; x < width; ++x)
       {
+        const PointInT &center = (*input_)[y * width + x];
         int start_window_x = std::max (x - window_size_, 0),
             start_window_y = std::max (y - window_size_, 0),
-            end_window_x = std::min (x + window_size_, static_cast<int> (input_->width)),
-            end_window_y = std::min (y + window_size_, static_cast<int> (input_->height));
+            end_window_x = std::min (x + window_size_, width),
+            end_window_y = std::min (y + window_size_, height);
 
         float sum = 0.0f,
             norm_sum = 0.0f;
 
-        for (int x_w = start_window_x; x_w < end_window_x; ++ x_w)
-          for (int y_w = start_window_y; y_w < end_window_y; ++ y_w)
+        for (int y_w = start_window_y; y_w < end_window_y; ++ y_w)
+          for (int x_w = start_window_x; x_w < end_window_x; ++ x_w)
           {
+            const PointInT &neighbor = (*input_)[y_w * width + x_w];
+            if (!std::isfinite (neighbor.z))
+              continue;
+
+            // both weights are looked up in the tables of computeDistances
             float val_exp_depth = val_exp_depth_matrix (static_cast<Eigen::MatrixXf::Index> (x - x_w + window_size_),
                                                         static_cast<Eigen::MatrixXf::Index> (y - y_w + window_size_));
 
             Eigen::VectorXf::Index d_color = static_cast<Eigen::VectorXf::Index> (
-                std::abs ((*input_)[y_w * input_->width + x_w].r - (*input_)[y * input_->width + x].r) +
-                std::abs ((*input_)[y_w * input_->width + x_w].g - (*input_)[y * input_->width + x].g) +
-                std::abs ((*input_)[y_w * input_->width + x_w].b - (*input_)[y * input_->width + x].b));
+                std::abs (neighbor.r - center.r) +
+                std::abs (neighbor.g - center.g) +
+                std::abs (neighbor.b - center.b));
 
             float val_exp_rgb = val_exp_rgb_vector (d_color);
 
-            if (std::isfinite ((*input_)[y_w*input_->width + x_w].z))
-            {
-              sum += val_exp_depth * val_exp_rgb * (*input_)[y_w*input_->width + x_w].z;
-              norm_sum += val_exp_depth * val_exp_rgb;
-            }
+            sum += val_exp_depth * val_exp_rgb * neighbor.z;
+            norm_sum += val_exp_depth * val_exp_rgb;
           }
 
-        output[y*input_->width + x].r = (*input_)[y*input_->width + x].r;
-        output[y*input_->width + x].g = (*input_)[y*input_->width + x].g;
-        output[y*input_->width + x].b = (*input_)[y*input_->width + x].b;
+        PointOutT &out = output[y * width + x];
+        out.r = center.r;
+        out.g = center.g;
+        out.b = center.b;
 
         if (norm_sum != 0.0f)
         {
           float depth = sum / norm_sum;
           Eigen::Vector3f pc (static_cast<float> (x) * depth, static_cast<float> (y) * depth, depth);
           Eigen::Vector3f pw (unprojection_matrix_ * pc);
-          output[y*input_->width + x].x = pw[0];
-          output[y*input_->width + x].y = pw[1];
-          output[y*input_->width + x].z = pw[2];
+          out.x = pw[0];
+          out.y = pw[1];
+          out.z = pw[2];
         }
         else
         {
-          output[y*input_->width + x].x = nan;
-          output[y*input_->width + x].y = nan;
-          output[y*input_->width + x].z = nan;
+          out.x = nan;
+          out.y = nan;
+          out.z = nan;
         }
       }
 
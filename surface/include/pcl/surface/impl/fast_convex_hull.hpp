@@ -0,0 +1,546 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef PCL_SURFACE_IMPL_FAST_CONVEX_HULL_H_
+#define PCL_SURFACE_IMPL_FAST_CONVEX_HULL_H_
+
+#include <pcl/surface/fast_convex_hull.h>
+#include <pcl/common/centroid.h>
+#include <pcl/common/eigen.h>
+#include <pcl/common/io.h> // for toPCLPointCloud2
+
+#include <Eigen/Eigenvalues> // for SelfAdjointEigenSolver
+
+#include <algorithm>
+#include <limits>
+
+//////////////////////////////////////////////////////////////////////////
+template <typename PointInT> int
+pcl::FastConvexHull<PointInT>::calculateInputDimension () const
+{
+  Eigen::Vector4d xyz_centroid;
+  compute3DCentroid (*input_, *indices_, xyz_centroid);
+  EIGEN_ALIGN16 Eigen::Matrix3d covariance_matrix = Eigen::Matrix3d::Zero ();
+  computeCovarianceMatrixNormalized (*input_, *indices_, xyz_centroid, covariance_matrix);
+
+  EIGEN_ALIGN16 Eigen::Vector3d eigen_values;
+  pcl::eigen33 (covariance_matrix, eigen_values);
+
+  if (std::abs (eigen_values[0]) < std::numeric_limits<double>::epsilon () || std::abs (eigen_values[0] / eigen_values[2]) < 1.0e-3)
+    return (2);
+  return (3);
+}
+
+//////////////////////////////////////////////////////////////////////////
+template <typename PointInT> void
+pcl::FastConvexHull<PointInT>::copyHull (const std::vector<int> &hull, PointCloud &points)
+{
+  points.resize (hull.size ());
+  hull_indices_.indices.resize (hull.size ());
+  for (std::size_t i = 0; i < hull.size (); ++i)
+  {
+    hull_indices_.indices[i] = (*indices_)[hull[i]];
+    points[i] = (*input_)[hull_indices_.indices[i]];
+  }
+  points.width = points.size ();
+  points.height = 1;
+  points.is_dense = false;
+}
+
+//////////////////////////////////////////////////////////////////////////
+template <typename PointInT> bool
+pcl::FastConvexHull<PointInT>::performReconstruction2D (PointCloud &points, std::vector<pcl::Vertices> &polygons,
+                                                        bool)
+{
+  hull_dimension_ = 2;
+
+  // Project the points onto their best fitting plane, the basis (u, v, normal) is right-handed
+  Eigen::Vector3d centroid = Eigen::Vector3d::Zero ();
+  std::size_t nr_valid = 0;
+  for (const auto &p : coords_)
+    if (std::isfinite (p.sum ()))
+    {
+      centroid += p;
+      ++nr_valid;
+    }
+  if (nr_valid < 3)
+    return (false);
+  centroid /= static_cast<double> (nr_valid);
+  Eigen::Matrix3d covariance = Eigen::Matrix3d::Zero ();
+  for (const auto &p : coords_)
+    if (std::isfinite (p.sum ()))
+      covariance += (p - centroid) * (p - centroid).transpose ();
+  const Eigen::SelfAdjointEigenSolver<Eigen::Matrix3d> solver (covariance);
+  const Eigen::Vector3d normal = solver.eigenvectors ().col (0);
+  const Eigen::Vector3d u = solver.eigenvectors ().col (2);
+  const Eigen::Vector3d v = normal.cross (u);
+
+  projected_.clear ();
+  for (int i = 0; i < static_cast<int> (coords_.size ()); ++i)
+    if (std::isfinite (coords_[i].sum ()))
+      projected_.emplace_back (Eigen::Vector2d (u.dot (coords_[i] - centroid), v.dot (coords_[i] - centroid)), i);
+  std::sort (projected_.begin (), projected_.end (), [] (const std::pair<Eigen::Vector2d, int> &a, const std::pair<Eigen::Vector2d, int> &b)
+  {
+    return (a.first[0] < b.first[0] || (a.first[0] == b.first[0] && a.first[1] < b.first[1]));
+  });
+
+  // Monotone chain: the lower hull from left to right, then the upper hull back, counter-clockwise in (u, v)
+  const auto cross = [this] (int o, int a, int b)
+  {
+    const Eigen::Vector2d oa = projected_[a].first - projected_[o].first;
+    const Eigen::Vector2d ob = projected_[b].first - projected_[o].first;
+    return (oa[0] * ob[1] - oa[1] * ob[0]);
+  };
+  const int n = static_cast<int> (projected_.size ());
+  chain_.resize (2 * n);
+  int k = 0;
+  for (int i = 0; i < n; ++i)
+  {
+    while (k >= 2 && cross (chain_[k - 2], chain_[k - 1], i) <= 0)
+      --k;
+    chain_[k++] = i;
+  }
+  for (int i = n - 2, lower = k + 1; i >= 0; --i)
+  {
+    while (k >= lower && cross (chain_[k - 2], chain_[k - 1], i) <= 0)
+      --k;
+    chain_[k++] = i;
+  }
+  // The last point is the first one again
+  chain_.resize (k - 1);
+  if (chain_.size () < 3)
+    return (false);
+
+  if (compute_area_)
+  {
+    double area = 0;
+    for (std::size_t i = 0; i < chain_.size (); ++i)
+    {
+      const Eigen::Vector2d &a = projected_[chain_[i]].first;
+      const Eigen::Vector2d &b = projected_[chain_[(i + 1) % chain_.size ()]].first;
+      area += a[0] * b[1] - a[1] * b[0];
+    }
+    total_area_ = 0.5 * area;
+    total_volume_ = 0;
+  }
+
+  for (auto &position : chain_)
+    position = projected_[position].second;
+  copyHull (chain_, points);
+
+  polygons.resize (1);
+  polygons[0].vertices.resize (chain_.size ());
+  for (std::size_t i = 0; i < chain_.size (); ++i)
+    polygons[0].vertices[i] = static_cast<pcl::index_t> (i);
+  return (true);
+}
+
+//////////////////////////////////////////////////////////////////////////
+template <typename PointInT> int
+pcl::FastConvexHull<PointInT>::addFace (int a, int b, int c)
+{
+  int idx;
+  if (!free_faces_.empty ())
+  {
+    idx = free_faces_.back ();
+    free_faces_.pop_back ();
+  }
+  else
+  {
+    idx = static_cast<int> (faces_.size ());
+    faces_.emplace_back ();
+  }
+
+  Face &face = faces_[idx];
+  face.vertices[0] = a;
+  face.vertices[1] = b;
+  face.vertices[2] = c;
+  face.neighbors[0] = face.neighbors[1] = face.neighbors[2] = -1;
+  face.normal = (coords_[b] - coords_[a]).cross (coords_[c] - coords_[a]);
+  const double norm = face.normal.norm ();
+  if (norm > 0)
+    face.normal /= norm;
+  else
+    face.normal.setZero ();
+  face.offset = face.normal.dot (coords_[a]);
+  face.outside.clear ();
+  face.visited = -1;
+  face.visible = false;
+  face.alive = true;
+  return (idx);
+}
+
+//////////////////////////////////////////////////////////////////////////
+template <typename PointInT> bool
+pcl::FastConvexHull<PointInT>::performReconstruction3D (PointCloud &points, std::vector<pcl::Vertices> &polygons,
+                                                        bool fill_polygon_data)
+{
+  hull_dimension_ = 3;
+  const int n = static_cast<int> (coords_.size ());
+
+  // Tolerance of the plane distances, relative to the extent of the coordinates
+  Eigen::Array3d max_abs = Eigen::Array3d::Zero ();
+  int extremes[6] = {-1, -1, -1, -1, -1, -1};
+  for (int i = 0; i < n; ++i)
+  {
+    const Eigen::Vector3d &p = coords_[i];
+    if (!std::isfinite (p.sum ()))
+      continue;
+    max_abs = max_abs.max (p.array ().abs ());
+    for (int d = 0; d < 3; ++d)
+    {
+      if (extremes[2 * d] < 0 || p[d] < coords_[extremes[2 * d]][d])
+        extremes[2 * d] = i;
+      if (extremes[2 * d + 1] < 0 || p[d] > coords_[extremes[2 * d + 1]][d])
+        extremes[2 * d + 1] = i;
+    }
+  }
+  if (extremes[0] < 0)
+    return (false);
+  const double eps = 3 * std::numeric_limits<double>::epsilon () * max_abs.sum ();
+
+  // Initial simplex: the farthest pair of extreme points, the point farthest from their line and the point farthest
+  // from the plane of the three
+  int i0 = extremes[0], i1 = extremes[1];
+  for (int d = 1; d < 3; ++d)
+    if ((coords_[extremes[2 * d + 1]] - coords_[extremes[2 * d]]).squaredNorm () > (coords_[i1] - coords_[i0]).squaredNorm ())
+    {
+      i0 = extremes[2 * d];
+      i1 = extremes[2 * d + 1];
+    }
+  const Eigen::Vector3d dir = (coords_[i1] - coords_[i0]).normalized ();
+  int i2 = -1, i3 = -1;
+  double max_dist = eps;
+  for (int i = 0; i < n; ++i)
+  {
+    if (!std::isfinite (coords_[i].sum ()))
+      continue;
+    const double dist = (coords_[i] - coords_[i0]).cross (dir).norm ();
+    if (dist > max_dist)
+    {
+      max_dist = dist;
+      i2 = i;
+    }
+  }
+  if (i2 < 0)
+    return (false);
+  const Eigen::Vector3d plane_normal = (coords_[i1] - coords_[i0]).cross (coords_[i2] - coords_[i0]).normalized ();
+  max_dist = eps;
+  for (int i = 0; i < n; ++i)
+  {
+    if (!std::isfinite (coords_[i].sum ()))
+      continue;
+    const double dist = std::abs (plane_normal.dot (coords_[i] - coords_[i0]));
+    if (dist > max_dist)
+    {
+      max_dist = dist;
+      i3 = i;
+    }
+  }
+  if (i3 < 0)
+    return (performReconstruction2D (points, polygons, fill_polygon_data));
+  const Eigen::Vector3d interior = (coords_[i0] + coords_[i1] + coords_[i2] + coords_[i3]) / 4;
+
+  // Recycle the faces of the previous call
+  free_faces_.clear ();
+  for (int f = static_cast<int> (faces_.size ()) - 1; f >= 0; --f)
+  {
+    faces_[f].alive = false;
+    free_faces_.push_back (f);
+  }
+  new_faces_.clear ();
+  const int simplex[4][3] = {{i0, i1, i2}, {i1, i0, i3}, {i2, i1, i3}, {i0, i2, i3}};
+  for (const auto &v : simplex)
+  {
+    int f = addFace (v[0], v[1], v[2]);
+    if (faces_[f].distance (interior) > 0)
+    {
+      faces_[f].alive = false;
+      free_faces_.push_back (f);
+      f = addFace (v[0], v[2], v[1]);
+    }
+    new_faces_.push_back (f);
+  }
+  for (const auto &f : new_faces_)
+    for (int k = 0; k < 3; ++k)
+      for (const auto &g : new_faces_)
+        for (int l = 0; l < 3; ++l)
+          if (faces_[g].vertices[l] == faces_[f].vertices[(k + 1) % 3] && faces_[g].vertices[(l + 1) % 3] == faces_[f].vertices[k])
+            faces_[f].neighbors[k] = g;
+
+  // Assign every point to the first face it is above
+  for (int i = 0; i < n; ++i)
+  {
+    if (i == i0 || i == i1 || i == i2 || i == i3 || !std::isfinite (coords_[i].sum ()))
+      continue;
+    for (const auto &f : new_faces_)
+      if (faces_[f].distance (coords_[i]) > eps)
+      {
+        faces_[f].outside.push_back (i);
+        break;
+      }
+  }
+  pending_ = new_faces_;
+
+  start_face_.resize (n);
+  end_face_.resize (n);
+  vertex_stamp_.assign (n, -1);
+  for (int iteration = 0; !pending_.empty (); ++iteration)
+  {
+    const int f = pending_.back ();
+    if (!faces_[f].alive || faces_[f].outside.empty ())
+    {
+      pending_.pop_back ();
+      continue;
+    }
+
+    // The farthest point above the face is the next hull vertex
+    std::vector<int> &outside = faces_[f].outside;
+    std::size_t farthest = 0;
+    for (std::size_t i = 1; i < outside.size (); ++i)
+      if (faces_[f].distance (coords_[outside[i]]) > faces_[f].distance (coords_[outside[farthest]]))
+        farthest = i;
+    const int eye = outside[farthest];
+    const Eigen::Vector3d &eye_point = coords_[eye];
+
+    // Flood the faces visible from the eye point and collect the edges of the horizon
+    visible_.assign (1, f);
+    horizon_.clear ();
+    faces_[f].visited = iteration;
+    faces_[f].visible = true;
+    for (std::size_t v = 0; v < visible_.size (); ++v)
+    {
+      const int vf = visible_[v];
+      for (int k = 0; k < 3; ++k)
+      {
+        const int g = faces_[vf].neighbors[k];
+        if (faces_[g].visited != iteration)
+        {
+          faces_[g].visited = iteration;
+          faces_[g].visible = (faces_[g].distance (eye_point) > eps);
+          if (faces_[g].visible)
+            visible_.push_back (g);
+        }
+        if (!faces_[g].visible)
+          horizon_.push_back ({faces_[vf].vertices[k], faces_[vf].vertices[(k + 1) % 3], g});
+      }
+    }
+
+    // A horizon which is not a simple loop can only come from rounding, skip such a point
+    bool simple = true;
+    for (const auto &edge : horizon_)
+    {
+      simple = simple && (vertex_stamp_[edge[0]] != iteration);
+      vertex_stamp_[edge[0]] = iteration;
+    }
+    if (!simple)
+    {
+      outside[farthest] = outside.back ();
+      outside.pop_back ();
+      continue;
+    }
+
+    // Remove the visible faces and keep their points for the new faces
+    orphans_.clear ();
+    for (const auto &vf : visible_)
+    {
+      for (const auto &p : faces_[vf].outside)
+        if (p != eye)
+          orphans_.push_back (p);
+      faces_[vf].outside.clear ();
+      faces_[vf].alive = false;
+      free_faces_.push_back (vf);
+    }
+
+    // Connect the horizon to the eye point
+    new_faces_.clear ();
+    for (const auto &edge : horizon_)
+    {
+      const int nf = addFace (edge[0], edge[1], eye);
+      faces_[nf].neighbors[0] = edge[2];
+      Face &beyond = faces_[edge[2]];
+      for (int k = 0; k < 3; ++k)
+        if (beyond.vertices[k] == edge[1] && beyond.vertices[(k + 1) % 3] == edge[0])
+          beyond.neighbors[k] = nf;
+      start_face_[edge[0]] = nf;
+      end_face_[edge[1]] = nf;
+      new_faces_.push_back (nf);
+    }
+    for (const auto &nf : new_faces_)
+    {
+      faces_[nf].neighbors[1] = start_face_[faces_[nf].vertices[1]];
+      faces_[nf].neighbors[2] = end_face_[faces_[nf].vertices[0]];
+    }
+
+    for (const auto &p : orphans_)
+      for (const auto &nf : new_faces_)
+        if (faces_[nf].distance (coords_[p]) > eps)
+        {
+          faces_[nf].outside.push_back (p);
+          break;
+        }
+    for (const auto &nf : new_faces_)
+      if (!faces_[nf].outside.empty ())
+        pending_.push_back (nf);
+  }
+
+  // Number the hull vertices in the order they first appear in the faces
+  vertex_map_.assign (n, -1);
+  chain_.clear ();
+  if (fill_polygon_data)
+    polygons.clear ();
+  total_area_ = total_volume_ = 0;
+  for (const auto &face : faces_)
+  {
+    if (!face.alive)
+      continue;
+    for (const auto &v : face.vertices)
+      if (vertex_map_[v] < 0)
+      {
+        vertex_map_[v] = static_cast<int> (chain_.size ());
+        chain_.push_back (v);
+      }
+    if (fill_polygon_data)
+    {
+      pcl::Vertices triangle;
+      triangle.vertices = {vertex_map_[face.vertices[0]], vertex_map_[face.vertices[1]], vertex_map_[face.vertices[2]]};
+      polygons.push_back (triangle);
+    }
+    if (compute_area_)
+    {
+      const Eigen::Vector3d &a = coords_[face.vertices[0]];
+      const Eigen::Vector3d cross = (coords_[face.vertices[1]] - a).cross (coords_[face.vertices[2]] - a);
+      total_area_ += 0.5 * cross.norm ();
+      total_volume_ += cross.dot (a - interior) / 6;
+    }
+  }
+  copyHull (chain_, points);
+  return (true);
+}
+
+//////////////////////////////////////////////////////////////////////////
+template <typename PointInT> bool
+pcl::FastConvexHull<PointInT>::performReconstruction (PointCloud &points, std::vector<pcl::Vertices> &polygons,
+                                                      bool fill_polygon_data)
+{
+  total_area_ = total_volume_ = 0;
+  hull_indices_.header = input_->header;
+  hull_indices_.indices.clear ();
+
+  coords_.resize (indices_->size ());
+  for (std::size_t i = 0; i < indices_->size (); ++i)
+    coords_[i] = (*input_)[(*indices_)[i]].getVector3fMap ().template cast<double> ();
+
+  const int dimension = (dimension_ != 0 ? dimension_ : calculateInputDimension ());
+  bool success = false;
+  if (dimension == 2)
+    success = performReconstruction2D (points, polygons, fill_polygon_data);
+  else if (dimension == 3)
+    success = performReconstruction3D (points, polygons, fill_polygon_data);
+
+  if (!success)
+  {
+    PCL_ERROR ("[pcl::%s::performReconstruction] Unable to compute a convex hull for the given point cloud (%zu)!\n",
+               getClassName ().c_str (), static_cast<std::size_t> (indices_->size ()));
+    points.clear ();
+    points.width = points.height = 0;
+    polygons.clear ();
+    hull_indices_.indices.clear ();
+  }
+  return (success);
+}
+
+//////////////////////////////////////////////////////////////////////////
+template <typename PointInT> void
+pcl::FastConvexHull<PointInT>::reconstruct (PointCloud &points)
+{
+  points.header = input_->header;
+  if (!initCompute () || input_->points.empty () || indices_->empty ())
+  {
+    points.clear ();
+    return;
+  }
+
+  // Perform the actual surface reconstruction
+  std::vector<pcl::Vertices> polygons;
+  if (performReconstruction (points, polygons, false))
+    points.is_dense = true;
+
+  deinitCompute ();
+}
+
+//////////////////////////////////////////////////////////////////////////
+template <typename PointInT> void
+pcl::FastConvexHull<PointInT>::performReconstruction (PolygonMesh &output)
+{
+  // Perform reconstruction
+  pcl::PointCloud<PointInT> hull_points;
+  performReconstruction (hull_points, output.polygons, true);
+
+  // Convert the PointCloud into a PCLPointCloud2
+  pcl::toPCLPointCloud2 (hull_points, output.cloud);
+}
+
+//////////////////////////////////////////////////////////////////////////
+template <typename PointInT> void
+pcl::FastConvexHull<PointInT>::performReconstruction (std::vector<pcl::Vertices> &polygons)
+{
+  pcl::PointCloud<PointInT> hull_points;
+  performReconstruction (hull_points, polygons, true);
+}
+
+//////////////////////////////////////////////////////////////////////////
+template <typename PointInT> void
+pcl::FastConvexHull<PointInT>::reconstruct (PointCloud &points, std::vector<pcl::Vertices> &polygons)
+{
+  points.header = input_->header;
+  if (!initCompute () || input_->points.empty () || indices_->empty ())
+  {
+    points.clear ();
+    return;
+  }
+
+  // Perform the actual surface reconstruction
+  if (performReconstruction (points, polygons, true))
+    points.is_dense = true;
+
+  deinitCompute ();
+}
+
+#define PCL_INSTANTIATE_FastConvexHull(T) template class PCL_EXPORTS pcl::FastConvexHull<T>;
+
+#endif    // PCL_SURFACE_IMPL_FAST_CONVEX_HULL_H_
@@ -39,14 +39,29 @@
 #define PCL_SURFACE_IMPL_GP3_H_
 
 #include <pcl/surface/gp3.h>
+#include <pcl/common/execution_context.h>
+#include <pcl/common/point_tests.h> // for isXYZFinite
+
+#include <algorithm>
+#include <iterator>
+#include <limits>
+#include <unordered_map>
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointInT> void
+pcl::GreedyProjectionTriangulation<PointInT>::setNumberOfThreads (unsigned int nr_threads)
+{
+  // 0 is resolved against the budget of pcl::ExecutionContext at compute time
+  threads_ = nr_threads;
+}
 
 /////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointInT> void
 pcl::GreedyProjectionTriangulation<PointInT>::performReconstruction (pcl::PolygonMesh &output)
 {
   output.polygons.clear ();
-  output.polygons.reserve (2 * indices_->size ()); /// NOTE: usually the number of triangles is around twice the number of vertices
- if (!reconstructPolygons (output.polygons))
+  output.polygons.reserve (tile_callback_ ? 0 : 2 * indices_->size ()); /// NOTE: usually the number of triangles is around twice the number of vertices
+  if (!(tile_size_ > 0 ? reconstructTiled (output.polygons) : reconstructPolygons (output.polygons)))
   {
     PCL_ERROR ("[pcl::%s::performReconstruction] Reconstruction failed. Check parameters: search radius (%f) or mu (%f) before continuing.\n", getClassName ().c_str (), search_radius_, mu_);
     output.cloud.width = output.cloud.height = 0;
@@ -60,14 +75,201 @@ template <typename PointInT> void
 pcl::GreedyProjectionTriangulation<PointInT>::performReconstruction (std::vector<pcl::Vertices> &polygons)
 {
   polygons.clear ();
-  polygons.reserve (2 * indices_->size ()); /// NOTE: usually the number of triangles is around twice the number of vertices
-  if (!reconstructPolygons (polygons))
+  polygons.reserve (tile_callback_ ? 0 : 2 * indices_->size ()); /// NOTE: usually the number of triangles is around twice the number of vertices
+  if (!(tile_size_ > 0 ? reconstructTiled (polygons) : reconstructPolygons (polygons)))
   {
     PCL_ERROR ("[pcl::%s::performReconstruction] Reconstruction failed. Check parameters: search radius (%f) or mu (%f) before continuing.\n", getClassName ().c_str (), search_radius_, mu_);
     return;
   }
 }
 
+/////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointInT> bool
+pcl::GreedyProjectionTriangulation<PointInT>::reconstructTiled (std::vector<pcl::Vertices> &polygons)
+{
+  polygons.clear ();
+  part_.clear ();
+  state_.clear ();
+  source_.clear ();
+  ffn_.clear ();
+  sfn_.clear ();
+  if (search_radius_ <= 0 || mu_ <= 0)
+    return (false);
+
+  const float overlap = static_cast<float> (std::min (tile_overlap_ > 0 ? tile_overlap_ : 2 * search_radius_, tile_size_));
+  const float tile_size = static_cast<float> (tile_size_);
+  const float radius = static_cast<float> (search_radius_);
+
+  // Bounding box of the valid points
+  Eigen::Array3f min_pt = Eigen::Array3f::Constant (std::numeric_limits<float>::max ());
+  for (const auto &idx : *indices_)
+    if (pcl::isXYZFinite ((*input_)[idx]))
+      min_pt = min_pt.min ((*input_)[idx].getArray3fMap ());
+
+  // Assign each point to the tile containing it, tiles are keyed by their packed 21 bit coordinates
+  const auto tileOf = [&] (const Eigen::Array3f &p) -> Eigen::Array3i
+  {
+    return (((p - min_pt) / tile_size).floor ().template cast<int> ());
+  };
+  const auto tileKey = [] (const Eigen::Array3i &t) -> std::uint64_t
+  {
+    return ((static_cast<std::uint64_t> (t[0]) << 42) | (static_cast<std::uint64_t> (t[1]) << 21) | static_cast<std::uint64_t> (t[2]));
+  };
+  std::unordered_map<std::uint64_t, pcl::Indices> tiles;
+  for (const auto &idx : *indices_)
+  {
+    if (!pcl::isXYZFinite ((*input_)[idx]))
+      continue;
+    const Eigen::Array3i t = tileOf ((*input_)[idx].getArray3fMap ());
+    if ((t >= (1 << 21)).any ())
+    {
+      PCL_ERROR ("[pcl::%s::reconstructTiled] Too many tiles, increase the tile size (%f).\n", getClassName ().c_str (), tile_size_);
+      return (false);
+    }
+    tiles[tileKey (t)].push_back (idx);
+  }
+
+  // A deterministic order of the tiles makes the output independent of the hash map
+  std::vector<std::uint64_t> keys;
+  keys.reserve (tiles.size ());
+  for (const auto &tile : tiles)
+    keys.push_back (tile.first);
+  std::sort (keys.begin (), keys.end ());
+
+  // Number of triangles adjacent to each edge close to the tile faces, used to stitch the seams
+  std::unordered_map<std::uint64_t, int> seam_edges;
+  const auto edgeKey = [] (pcl::index_t a, pcl::index_t b) -> std::uint64_t
+  {
+    if (a > b)
+      std::swap (a, b);
+    return ((static_cast<std::uint64_t> (a) << 32) | static_cast<std::uint32_t> (b));
+  };
+
+  const pcl::ThreadReservation reservation (threads_);
+  const unsigned int threads = reservation.getNumberOfThreads ();
+  // The tiles are triangulated in batches of one tile per thread, so only these are in memory at the same time
+  const int nr_tiles = static_cast<int> (keys.size ());
+  const int batch_size = static_cast<int> (threads);
+  std::vector<std::vector<pcl::Vertices> > batch (batch_size);
+  std::vector<std::vector<bool> > on_seam (batch_size);
+  for (int first = 0; first < nr_tiles; first += batch_size)
+  {
+    const int nr_batch = std::min (batch_size, nr_tiles - first);
+#pragma omp parallel for \
+  default(none) \
+  shared(batch, on_seam, first, keys, min_pt, tiles) \
+  firstprivate(nr_batch, overlap, radius, tile_size, tileKey) \
+  schedule(dynamic, 1) \
+  num_threads(threads)
+    for (int b = 0; b < nr_batch; ++b)
+    {
+      const std::uint64_t key = keys[first + b];
+      const Eigen::Array3i tile (static_cast<int> (key >> 42), static_cast<int> ((key >> 21) & 0x1FFFFF), static_cast<int> (key & 0x1FFFFF));
+      const Eigen::Array3f lower = min_pt + tile.template cast<float> () * tile_size;
+      const Eigen::Array3f upper = lower + tile_size;
+
+      // Gather the points of the tile and of its border from the neighboring tiles
+      typename PointCloudIn::Ptr cloud (new PointCloudIn);
+      pcl::Indices local2global;
+      for (int dx = -1; dx <= 1; ++dx)
+        for (int dy = -1; dy <= 1; ++dy)
+          for (int dz = -1; dz <= 1; ++dz)
+          {
+            const Eigen::Array3i neighbor = tile + Eigen::Array3i (dx, dy, dz);
+            if ((neighbor < 0).any ())
+              continue;
+            const auto it = tiles.find (tileKey (neighbor));
+            if (it == tiles.end ())
+              continue;
+            for (const auto &idx : it->second)
+            {
+              const Eigen::Array3f p = (*input_)[idx].getArray3fMap ();
+              if ((p >= lower - overlap).all () && (p < upper + overlap).all ())
+              {
+                cloud->push_back ((*input_)[idx]);
+                local2global.push_back (idx);
+              }
+            }
+          }
+
+      std::vector<pcl::Vertices> &triangles = batch[b];
+      triangles.clear ();
+      on_seam[b].clear ();
+      if (cloud->size () < 3)
+        continue;
+
+      pcl::GreedyProjectionTriangulation<PointInT> gp3;
+      gp3.setMu (mu_);
+      gp3.setSearchRadius (search_radius_);
+      gp3.setMaximumNearestNeighbors (nnn_);
+      gp3.setMinimumAngle (minimum_angle_);
+      gp3.setMaximumAngle (maximum_angle_);
+      gp3.setMaximumSurfaceAngle (eps_angle_);
+      gp3.setNormalConsistency (consistent_);
+      gp3.setConsistentVertexOrdering (consistent_ordering_);
+      gp3.setInputCloud (cloud);
+      std::vector<pcl::Vertices> local;
+      gp3.reconstruct (local);
+
+      // Keep the triangles whose centroid lies in the tile, and flag those which may share an edge with another tile
+      for (auto &triangle : local)
+      {
+        Eigen::Array3f centroid = Eigen::Array3f::Zero ();
+        for (const auto &v : triangle.vertices)
+          centroid += (*cloud)[v].getArray3fMap ();
+        centroid /= static_cast<float> (triangle.vertices.size ());
+        if (!((centroid >= lower).all () && (centroid < upper).all ()))
+          continue;
+        bool seam = false;
+        for (auto &v : triangle.vertices)
+        {
+          const Eigen::Array3f p = (*cloud)[v].getArray3fMap ();
+          seam = seam || ((p - lower).minCoeff () < radius) || ((upper - p).minCoeff () < radius);
+          v = local2global[v];
+        }
+        triangles.push_back (std::move (triangle));
+        on_seam[b].push_back (seam);
+      }
+    }
+
+    // Stitch the seams in tile order: a triangle that would give an edge more than two triangles is dropped
+    for (int b = 0; b < nr_batch; ++b)
+    {
+      std::vector<pcl::Vertices> &triangles = batch[b];
+      std::size_t nr_kept = 0;
+      for (std::size_t t = 0; t < triangles.size (); ++t)
+      {
+        if (on_seam[b][t])
+        {
+          const auto &v = triangles[t].vertices;
+          const std::uint64_t edges[3] = {edgeKey (v[0], v[1]), edgeKey (v[1], v[2]), edgeKey (v[2], v[0])};
+          bool manifold = true;
+          for (const auto &edge : edges)
+          {
+            const auto it = seam_edges.find (edge);
+            manifold = manifold && (it == seam_edges.end () || it->second < 2);
+          }
+          if (!manifold)
+            continue;
+          for (const auto &edge : edges)
+            ++seam_edges[edge];
+        }
+        if (nr_kept != t)
+          triangles[nr_kept] = std::move (triangles[t]);
+        ++nr_kept;
+      }
+      triangles.resize (nr_kept);
+
+      if (tile_callback_)
+        tile_callback_ (triangles);
+      else
+        polygons.insert (polygons.end (), std::make_move_iterator (triangles.begin ()), std::make_move_iterator (triangles.end ()));
+      std::vector<pcl::Vertices> ().swap (triangles);
+    }
+  }
+  return (true);
+}
+
 /////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointInT> bool
 pcl::GreedyProjectionTriangulation<PointInT>::reconstructPolygons (std::vector<pcl::Vertices> &polygons)
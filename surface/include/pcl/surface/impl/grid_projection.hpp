@@ -39,23 +39,27 @@
 #define PCL_SURFACE_IMPL_GRID_PROJECTION_H_
 
 #include <pcl/surface/grid_projection.h>
+#include <pcl/common/execution_context.h>
 #include <pcl/common/common.h>
 #include <pcl/common/centroid.h>
 #include <pcl/common/vector_average.h>
 #include <pcl/Vertices.h>
 
+#include <algorithm>
+#include <cstdint>
+
 //////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointNT>
 pcl::GridProjection<PointNT>::GridProjection () :
   cell_hash_map_ (), leaf_size_ (0.001), gaussian_scale_ (),
-  data_size_ (0), max_binary_search_level_ (10), k_ (50), padding_size_ (3), data_ () 
+  data_size_ (0), max_binary_search_level_ (10), k_ (50), padding_size_ (3), data_ (), threads_ (1)
 {}
 
 //////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointNT>
 pcl::GridProjection<PointNT>::GridProjection (double resolution) :
   cell_hash_map_ (), leaf_size_ (resolution), gaussian_scale_ (),
-  data_size_ (0), max_binary_search_level_ (10), k_ (50), padding_size_ (3), data_ () 
+  data_size_ (0), max_binary_search_level_ (10), k_ (50), padding_size_ (3), data_ (), threads_ (1)
 {}
 
 //////////////////////////////////////////////////////////////////////////////////////////////
@@ -69,6 +73,14 @@ pcl::GridProjection<PointNT>::~GridProjection ()
   data_.reset ();
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointNT> void
+pcl::GridProjection<PointNT>::setNumberOfThreads (unsigned int nr_threads)
+{
+  // 0 is resolved against the budget of pcl::ExecutionContext at compute time
+  threads_ = nr_threads;
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointNT> void
 pcl::GridProjection<PointNT>::scaleInputDataPoint (double scale_factor)
@@ -170,7 +182,8 @@ pcl::GridProjection<PointNT>::getDataPtsUnion (const Eigen::Vector3i &index,
 //////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointNT> void
 pcl::GridProjection<PointNT>::createSurfaceForCell (const Eigen::Vector3i &index,
-                                                    pcl::Indices &pt_union_indices)
+                                                    pcl::Indices &pt_union_indices,
+                                                    std::vector<Eigen::Vector4f, Eigen::aligned_allocator<Eigen::Vector4f> > &surface)
 {
   // 8 vertices of the cell
   std::vector<Eigen::Vector4f, Eigen::aligned_allocator<Eigen::Vector4f> > vertices (8);
@@ -259,7 +272,7 @@ pcl::GridProjection<PointNT>::createSurfaceForCell (const Eigen::Vector3i &index
         for (std::size_t k = 0; k < 4; k++)
         {
           polygon_pts[k] = cell_hash_map_.at (polygon_indices_1d[k]).pt_on_surface;
-          surface_.push_back (polygon_pts[k]);
+          surface.push_back (polygon_pts[k]);
         }
       }
     }
@@ -583,8 +596,10 @@ pcl::GridProjection<PointNT>::storeVectAndSurfacePoint (int index_1d,
       cell_data.pt_on_surface.z () + static_cast<float> (leaf_size_) / 2.0f, 0.0f);
 
   // Save the vector and the point on the surface
-  getVectorAtPoint (grid_pt, pt_union_indices, cell_hash_map_[index_1d].vect_at_grid_pt);
-  getProjection (cell_data.pt_on_surface, pt_union_indices, cell_hash_map_[index_1d].pt_on_surface);
+  // at () does not modify the map, the cells can be processed concurrently
+  Leaf &cell = cell_hash_map_.at (index_1d);
+  getVectorAtPoint (grid_pt, pt_union_indices, cell.vect_at_grid_pt);
+  getProjection (cell_data.pt_on_surface, pt_union_indices, cell.pt_on_surface);
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////
@@ -606,8 +621,9 @@ pcl::GridProjection<PointNT>::storeVectAndSurfacePointKNN (int index_1d, const E
   PointNT pt; pt.x = grid_pt.x (); pt.y = grid_pt.y (); pt.z = grid_pt.z ();
   tree_->nearestKSearch (pt, k_, k_indices, k_squared_distances);
 
-  getVectorAtPointKNN (grid_pt, k_indices, k_squared_distances, cell_hash_map_[index_1d].vect_at_grid_pt);
-  getProjectionWithPlaneFit (cell_center, k_indices, cell_hash_map_[index_1d].pt_on_surface);
+  Leaf &cell = cell_hash_map_.at (index_1d);
+  getVectorAtPointKNN (grid_pt, k_indices, k_squared_distances, cell.vect_at_grid_pt);
+  getProjectionWithPlaneFit (cell_center, k_indices, cell.pt_on_surface);
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////
@@ -634,20 +650,13 @@ pcl::GridProjection<PointNT>::reconstructPolygons (std::vector<pcl::Vertices> &p
     Eigen::Vector3i index_3d;
     getCellIndex ((*data_)[cp].getVector4fMap (), index_3d);
     int index_1d = getIndexIn1D (index_3d);
-    if (cell_hash_map_.find (index_1d) == cell_hash_map_.end ())
+    Leaf &cell_data = cell_hash_map_[index_1d];
+    if (cell_data.data_indices.empty ())
     {
-      Leaf cell_data;
-      cell_data.data_indices.push_back (cp);
       getCellCenterFromIndex (index_3d, cell_data.pt_on_surface);
-      cell_hash_map_[index_1d] = cell_data;
       occupied_cell_list_[index_1d] = 1;
     }
-    else
-    {
-      Leaf cell_data = cell_hash_map_.at (index_1d);
-      cell_data.data_indices.push_back (cp);
-      cell_hash_map_[index_1d] = cell_data;
-    }
+    cell_data.data_indices.push_back (cp);
   }
 
   Eigen::Vector3i index;
@@ -671,35 +680,68 @@ pcl::GridProjection<PointNT>::reconstructPolygons (std::vector<pcl::Vertices> &p
     }
   }
 
-  // Update the hashtable and store the vector and point
+  // The hash map does not change any more, so the cells can be processed in parallel
+  std::vector<const typename HashMap::value_type*> cells;
+  cells.reserve (cell_hash_map_.size ());
   for (const auto &entry : cell_hash_map_)
+    cells.push_back (&entry);
+  auto nr_cells = static_cast<std::ptrdiff_t> (cells.size ());
+
+  // Update the hashtable and store the vector and point
+  const pcl::ThreadReservation reservation (threads_);
+  const unsigned int threads = reservation.getNumberOfThreads ();
+  std::vector<std::uint8_t> has_enough_points (cells.size (), 0);
+#pragma omp parallel for \
+  default(none) \
+  shared(cells, has_enough_points, nr_cells) \
+  schedule(dynamic, 64) \
+  num_threads(threads)
+  for (std::ptrdiff_t i = 0; i < nr_cells; ++i)
   {
-    getIndexIn3D (entry.first, index);
+    Eigen::Vector3i index_3d;
+    getIndexIn3D (cells[i]->first, index_3d);
     pcl::Indices pt_union_indices;
-    getDataPtsUnion (index, pt_union_indices);
+    getDataPtsUnion (index_3d, pt_union_indices);
 
     // Needs at least 10 points (?)
     // NOTE: set as parameter later
     if (pt_union_indices.size () > 10)
     {
-      storeVectAndSurfacePoint (entry.first, index, pt_union_indices, entry.second);
-      //storeVectAndSurfacePointKNN(entry.first, index, entry.second);
-      occupied_cell_list_[entry.first] = 1;
+      storeVectAndSurfacePoint (cells[i]->first, index_3d, pt_union_indices, cells[i]->second);
+      //storeVectAndSurfacePointKNN(cells[i]->first, index_3d, cells[i]->second);
+      has_enough_points[i] = 1;
     }
   }
-
-  // Go through the hash table another time to extract surface
-  for (const auto &entry : cell_hash_map_)
+  // The bit map can not be written concurrently
+  for (std::ptrdiff_t i = 0; i < nr_cells; ++i)
+    if (has_enough_points[i])
+      occupied_cell_list_[cells[i]->first] = 1;
+
+  // Go through the hash table another time to extract surface. The cells are split into
+  // consecutive blocks, concatenating the blocks keeps the order of the serial version
+  std::ptrdiff_t nr_blocks = std::min<std::ptrdiff_t> (nr_cells, 4 * static_cast<std::ptrdiff_t> (threads));
+  std::vector<std::vector<Eigen::Vector4f, Eigen::aligned_allocator<Eigen::Vector4f> > > block_surfaces (nr_blocks);
+#pragma omp parallel for \
+  default(none) \
+  shared(block_surfaces, cells, has_enough_points, nr_blocks, nr_cells) \
+  schedule(dynamic, 1) \
+  num_threads(threads)
+  for (std::ptrdiff_t block = 0; block < nr_blocks; ++block)
   {
-    getIndexIn3D (entry.first, index);
-    pcl::Indices pt_union_indices;
-    getDataPtsUnion (index, pt_union_indices);
-
-    // Needs at least 10 points (?)
-    // NOTE: set as parameter later
-    if (pt_union_indices.size () > 10)
-      createSurfaceForCell (index, pt_union_indices);
+    // the surface is extracted from the same cells as above
+    for (std::ptrdiff_t i = nr_cells * block / nr_blocks; i < nr_cells * (block + 1) / nr_blocks; ++i)
+    {
+      if (!has_enough_points[i])
+        continue;
+      Eigen::Vector3i index_3d;
+      getIndexIn3D (cells[i]->first, index_3d);
+      pcl::Indices pt_union_indices;
+      getDataPtsUnion (index_3d, pt_union_indices);
+      createSurfaceForCell (index_3d, pt_union_indices, block_surfaces[block]);
+    }
   }
+  for (const auto &block_surface : block_surfaces)
+    surface_.insert (surface_.end (), block_surface.begin (), block_surface.end ());
 
   polygons.resize (surface_.size () / 4);
   // Copy the data from surface_ to polygons
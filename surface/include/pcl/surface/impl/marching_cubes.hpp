@@ -38,9 +38,21 @@
 
 #include <pcl/surface/marching_cubes.h>
 #include <pcl/common/common.h>
+#include <pcl/common/execution_context.h>
 #include <pcl/common/vector_average.h>
 #include <pcl/Vertices.h>
 
+#include <algorithm>
+#include <unordered_set>
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointNT> void
+pcl::MarchingCubes<PointNT>::setNumberOfThreads (unsigned int nr_threads)
+{
+  // 0 is resolved against the budget of pcl::ExecutionContext at compute time
+  threads_ = nr_threads;
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointNT>
 pcl::MarchingCubes<PointNT>::~MarchingCubes ()
@@ -199,10 +211,270 @@ pcl::MarchingCubes<PointNT>::getGridValue (Eigen::Vector3i pos)
   if (pos[2] < 0 || pos[2] >= res_z_)
     return -1.0f;
 
+  if (sparse_grid_)
+  {
+    const Eigen::Vector3i block = pos / block_size_;
+    const auto it = block_lookup_.find (getBlockKey (block));
+    if (it == block_lookup_.end ())
+      return std::numeric_limits<float>::quiet_NaN ();
+    const Eigen::Vector3i local = pos - block * block_size_;
+    return grid_[(it->second * block_size_ + local[0]) * block_size_ * block_size_ + local[1] * block_size_ + local[2]];
+  }
+
   return grid_[pos[0]*res_y_*res_z_ + pos[1]*res_z_ + pos[2]];
 }
 
 
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointNT> template <typename Function> void
+pcl::MarchingCubes<PointNT>::evaluateGrid (const Function &function)
+{
+  const pcl::ThreadReservation reservation (threads_);
+  const unsigned int threads = reservation.getNumberOfThreads ();
+  if (!sparse_grid_)
+  {
+#pragma omp parallel for \
+  default(none) \
+  shared(function) \
+  schedule(dynamic, 1) \
+  num_threads(threads)
+    for (int x = 0; x < res_x_; ++x)
+      for (int y = 0; y < res_y_; ++y)
+        for (int z = 0; z < res_z_; ++z)
+        {
+          const Eigen::Vector3f point = (lower_boundary_ + size_voxel_ * Eigen::Array3f (x, y, z)).matrix ();
+          grid_[x * res_y_ * res_z_ + y * res_z_ + z] = function (point);
+        }
+    return;
+  }
+
+  const int nr_blocks = static_cast<int> (blocks_.size ());
+#pragma omp parallel for \
+  default(none) \
+  shared(function) \
+  firstprivate(nr_blocks) \
+  schedule(dynamic, 1) \
+  num_threads(threads)
+  for (int b = 0; b < nr_blocks; ++b)
+  {
+    const Eigen::Vector3i origin = blocks_[b] * block_size_;
+    float *values = &grid_[static_cast<std::size_t> (b) * block_size_ * block_size_ * block_size_];
+    for (int x = 0; x < block_size_; ++x)
+      for (int y = 0; y < block_size_; ++y)
+        for (int z = 0; z < block_size_; ++z, ++values)
+        {
+          const Eigen::Vector3i pos = origin + Eigen::Vector3i (x, y, z);
+          if (pos[0] >= res_x_ || pos[1] >= res_y_ || pos[2] >= res_z_)
+            continue;
+          const Eigen::Vector3f point = (lower_boundary_ + size_voxel_ * pos.cast<float> ().array ()).matrix ();
+          *values = function (point);
+        }
+  }
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointNT> void
+pcl::MarchingCubes<PointNT>::activateBlocks ()
+{
+  const Eigen::Vector3i max_block ((res_x_ - 1) / block_size_, (res_y_ - 1) / block_size_, (res_z_ - 1) / block_size_);
+  std::unordered_set<std::uint64_t> keys;
+  blocks_.clear ();
+  for (const auto &point : *input_)
+  {
+    if (!pcl::isXYZFinite (point))
+      continue;
+    const Eigen::Array3f voxel = (point.getArray3fMap () - lower_boundary_) / size_voxel_;
+    const Eigen::Vector3i first = ((voxel - sparse_margin_).floor ().template cast<int> ().max (0) / block_size_).matrix ().cwiseMin (max_block);
+    const Eigen::Vector3i last = ((voxel + sparse_margin_).floor ().template cast<int> ().max (0) / block_size_).matrix ().cwiseMin (max_block);
+    for (int x = first[0]; x <= last[0]; ++x)
+      for (int y = first[1]; y <= last[1]; ++y)
+        for (int z = first[2]; z <= last[2]; ++z)
+        {
+          const Eigen::Vector3i block (x, y, z);
+          if (keys.insert (getBlockKey (block)).second)
+            blocks_.push_back (block);
+        }
+  }
+
+  // A deterministic order of the blocks makes the output independent of the hash map
+  std::sort (blocks_.begin (), blocks_.end (), [this] (const Eigen::Vector3i &a, const Eigen::Vector3i &b)
+  {
+    return (getBlockKey (a) < getBlockKey (b));
+  });
+  block_lookup_.clear ();
+  block_lookup_.reserve (blocks_.size ());
+  for (std::size_t b = 0; b < blocks_.size (); ++b)
+    block_lookup_[getBlockKey (blocks_[b])] = static_cast<int> (b);
+
+  grid_.assign (blocks_.size () * block_size_ * block_size_ * block_size_, std::numeric_limits<float>::quiet_NaN ());
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointNT> void
+pcl::MarchingCubes<PointNT>::extractDense (pcl::PointCloud<PointNT> &points)
+{
+  const pcl::ThreadReservation reservation (threads_);
+  const unsigned int threads = reservation.getNumberOfThreads ();
+  // Every x slab is extracted separately, the slabs are then concatenated in order
+  const int nr_slabs = std::max (res_x_ - 2, 0);
+  std::vector<pcl::PointCloud<PointNT>> slabs (nr_slabs);
+#pragma omp parallel for \
+  default(none) \
+  shared(slabs) \
+  firstprivate(nr_slabs) \
+  schedule(dynamic, 1) \
+  num_threads(threads)
+  for (int slab = 0; slab < nr_slabs; ++slab)
+  {
+    const int x = slab + 1;
+    for (int y = 1; y < res_y_-1; ++y)
+      for (int z = 1; z < res_z_-1; ++z)
+      {
+        Eigen::Vector3i index_3d (x, y, z);
+        std::vector<float> leaf_node;
+        getNeighborList1D (leaf_node, index_3d);
+        if (!leaf_node.empty ())
+          createSurface (leaf_node, index_3d, slabs[slab]);
+      }
+  }
+
+  std::size_t nr_points = 0;
+  for (const auto &slab : slabs)
+    nr_points += slab.size ();
+  points.clear ();
+  points.reserve (nr_points);
+  for (const auto &slab : slabs)
+    points.insert (points.end (), slab.begin (), slab.end ());
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointNT> void
+pcl::MarchingCubes<PointNT>::extractSparse (pcl::PointCloud<PointNT> &points,
+                                            std::vector<pcl::Vertices> &polygons)
+{
+  const pcl::ThreadReservation reservation (threads_);
+  const unsigned int threads = reservation.getNumberOfThreads ();
+  // Offsets of the cube corners, and the corners joined by each cube edge, see the tables above
+  static const int corners[8][3] = {{0, 0, 0}, {1, 0, 0}, {1, 0, 1}, {0, 0, 1},
+                                    {0, 1, 0}, {1, 1, 0}, {1, 1, 1}, {0, 1, 1}};
+  static const int edges[12][2] = {{0, 1}, {1, 2}, {2, 3}, {3, 0}, {4, 5}, {5, 6},
+                                   {6, 7}, {7, 4}, {0, 4}, {1, 5}, {2, 6}, {3, 7}};
+
+  // The vertices of each block, identified by the edge they lie on, and its triangles
+  struct BlockMesh
+  {
+    std::vector<std::uint64_t> edge_keys;
+    std::vector<Eigen::Vector3f, Eigen::aligned_allocator<Eigen::Vector3f> > vertices;
+    std::vector<int> triangles;
+  };
+  const int nr_blocks = static_cast<int> (blocks_.size ());
+  std::vector<BlockMesh> meshes (nr_blocks);
+
+#pragma omp parallel for \
+  shared(meshes) \
+  firstprivate(nr_blocks) \
+  schedule(dynamic, 1) \
+  num_threads(threads)
+  for (int b = 0; b < nr_blocks; ++b)
+  {
+    BlockMesh &mesh = meshes[b];
+    std::unordered_map<std::uint64_t, int> local_vertices;
+    const Eigen::Vector3i origin = blocks_[b] * block_size_;
+    for (int x = 0; x < block_size_; ++x)
+      for (int y = 0; y < block_size_; ++y)
+        for (int z = 0; z < block_size_; ++z)
+        {
+          // Same cubes as the dense grid
+          Eigen::Vector3i index_3d = origin + Eigen::Vector3i (x, y, z);
+          if (index_3d[0] < 1 || index_3d[0] >= res_x_-1 ||
+              index_3d[1] < 1 || index_3d[1] >= res_y_-1 ||
+              index_3d[2] < 1 || index_3d[2] >= res_z_-1)
+            continue;
+
+          std::vector<float> leaf_node;
+          getNeighborList1D (leaf_node, index_3d);
+          if (leaf_node.empty ())
+            continue;
+
+          int cubeindex = 0;
+          for (int i = 0; i < 8; ++i)
+            if (leaf_node[i] < iso_level_)
+              cubeindex |= 1 << i;
+          if (edgeTable[cubeindex] == 0)
+            continue;
+
+          // Vertices on the intersected edges, computed from the lower to the upper end of the edge
+          // so that both cubes sharing an edge agree on its vertex
+          int vertex_ids[12];
+          for (int e = 0; e < 12; ++e)
+          {
+            if (!(edgeTable[cubeindex] & (1 << e)))
+              continue;
+            int c1 = edges[e][0], c2 = edges[e][1];
+            Eigen::Vector3i p1 = index_3d + Eigen::Vector3i (corners[c1][0], corners[c1][1], corners[c1][2]);
+            Eigen::Vector3i p2 = index_3d + Eigen::Vector3i (corners[c2][0], corners[c2][1], corners[c2][2]);
+            if ((p2 - p1).sum () < 0)
+            {
+              std::swap (c1, c2);
+              std::swap (p1, p2);
+            }
+            int axis = 0;
+            (p2 - p1).maxCoeff (&axis);
+            const std::uint64_t key = ((static_cast<std::uint64_t> (p1[0]) * res_y_ + p1[1]) * res_z_ + p1[2]) * 3 + axis;
+
+            const auto inserted = local_vertices.emplace (key, static_cast<int> (mesh.vertices.size ()));
+            if (inserted.second)
+            {
+              Eigen::Vector3f v1 = (lower_boundary_ + size_voxel_ * p1.cast<float> ().array ()).matrix ();
+              Eigen::Vector3f v2 = (lower_boundary_ + size_voxel_ * p2.cast<float> ().array ()).matrix ();
+              Eigen::Vector3f vertex;
+              interpolateEdge (v1, v2, leaf_node[c1], leaf_node[c2], vertex);
+              mesh.edge_keys.push_back (key);
+              mesh.vertices.push_back (vertex);
+            }
+            vertex_ids[e] = inserted.first->second;
+          }
+
+          for (int i = 0; triTable[cubeindex][i] != -1; ++i)
+            mesh.triangles.push_back (vertex_ids[triTable[cubeindex][i]]);
+        }
+  }
+
+  // Merge the blocks in order, the vertices on the block faces are shared with the neighbor blocks
+  std::unordered_map<std::uint64_t, pcl::index_t> global_vertices;
+  points.clear ();
+  polygons.clear ();
+  std::vector<pcl::index_t> local_to_global;
+  for (const auto &mesh : meshes)
+  {
+    local_to_global.resize (mesh.vertices.size ());
+    for (std::size_t v = 0; v < mesh.vertices.size (); ++v)
+    {
+      const auto inserted = global_vertices.emplace (mesh.edge_keys[v], static_cast<pcl::index_t> (points.size ()));
+      if (inserted.second)
+      {
+        PointNT point;
+        point.getVector3fMap () = mesh.vertices[v];
+        points.push_back (point);
+      }
+      local_to_global[v] = inserted.first->second;
+    }
+
+    for (std::size_t t = 0; t < mesh.triangles.size (); t += 3)
+    {
+      pcl::Vertices polygon;
+      polygon.vertices = {local_to_global[mesh.triangles[t]],
+                          local_to_global[mesh.triangles[t + 1]],
+                          local_to_global[mesh.triangles[t + 2]]};
+      polygons.push_back (polygon);
+    }
+  }
+}
+
+
 //////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointNT> void
 pcl::MarchingCubes<PointNT>::performReconstruction (pcl::PolygonMesh &output)
@@ -232,33 +504,28 @@ pcl::MarchingCubes<PointNT>::performReconstruction (pcl::PointCloud<PointNT> &po
   // the point cloud really generated from Marching Cubes, prev intermediate_cloud_
   pcl::PointCloud<PointNT> intermediate_cloud;
 
-  // Create grid
-  grid_ = std::vector<float> (res_x_*res_y_*res_z_, NAN);
-
   // Compute bounding box and voxel size
   getBoundingBox ();
   size_voxel_ = (upper_boundary_ - lower_boundary_) 
     * Eigen::Array3f (res_x_, res_y_, res_z_).inverse ();
 
+  // Create grid
+  if (sparse_grid_)
+    activateBlocks ();
+  else
+    grid_ = std::vector<float> (res_x_*res_y_*res_z_, NAN);
+
   // Transform the point cloud into a voxel grid
   // This needs to be implemented in a child class
   voxelizeData ();
 
-  // preallocate memory assuming a hull. suppose 6 point per voxel
-  double size_reserve = std::min((double) intermediate_cloud.points.max_size (),
-      2.0 * 6.0 * (double) (res_y_*res_z_ + res_x_*res_z_ + res_x_*res_y_));
-  intermediate_cloud.reserve ((std::size_t) size_reserve);
+  if (sparse_grid_)
+  {
+    extractSparse (points, polygons);
+    return;
+  }
 
-  for (int x = 1; x < res_x_-1; ++x)
-    for (int y = 1; y < res_y_-1; ++y)
-      for (int z = 1; z < res_z_-1; ++z)
-      {
-        Eigen::Vector3i index_3d (x, y, z);
-        std::vector<float> leaf_node;
-        getNeighborList1D (leaf_node, index_3d);
-        if (!leaf_node.empty ())
-          createSurface (leaf_node, index_3d, intermediate_cloud);
-      }
+  extractDense (intermediate_cloud);
 
   points.swap (intermediate_cloud);
 
@@ -38,6 +38,8 @@
 
 #include <pcl/surface/marching_cubes_hoppe.h>
 
+#include <limits>
+
 //////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointNT>
 pcl::MarchingCubesHoppe<PointNT>::~MarchingCubesHoppe ()
@@ -51,36 +53,26 @@ pcl::MarchingCubesHoppe<PointNT>::voxelizeData ()
 {
   const bool is_far_ignored = dist_ignore_ > 0.0f;
 
-  for (int x = 0; x < res_x_; ++x)
+  // The grid is evaluated in parallel by the base class, voxels left at NaN are not meshed
+  this->evaluateGrid ([this, is_far_ignored] (const Eigen::Vector3f &point)
   {
-    const int y_start = x * res_y_ * res_z_;
-
-    for (int y = 0; y < res_y_; ++y)
-    {
-      const int z_start = y_start + y * res_z_;
+    pcl::Indices nn_indices (1, 0);
+    std::vector<float> nn_sqr_dists (1, 0.0f);
+    PointNT p;
 
-      for (int z = 0; z < res_z_; ++z)
-      {
-        pcl::Indices nn_indices (1, 0);
-        std::vector<float> nn_sqr_dists (1, 0.0f);
-        const Eigen::Vector3f point = (lower_boundary_ + size_voxel_ * Eigen::Array3f (x, y, z)).matrix ();
-        PointNT p;
+    p.getVector3fMap () = point;
 
-        p.getVector3fMap () = point;
+    tree_->nearestKSearch (p, 1, nn_indices, nn_sqr_dists);
 
-        tree_->nearestKSearch (p, 1, nn_indices, nn_sqr_dists);
-
-        if (!is_far_ignored || nn_sqr_dists[0] < dist_ignore_)
-        {
-          const Eigen::Vector3f normal = (*input_)[nn_indices[0]].getNormalVector3fMap ();
+    if (!is_far_ignored || nn_sqr_dists[0] < dist_ignore_)
+    {
+      const Eigen::Vector3f normal = (*input_)[nn_indices[0]].getNormalVector3fMap ();
 
-          if (!std::isnan (normal (0)) && normal.norm () > 0.5f)
-            grid_[z_start + z] = normal.dot (
-                point - (*input_)[nn_indices[0]].getVector3fMap ());
-        }
-      }
+      if (!std::isnan (normal (0)) && normal.norm () > 0.5f)
+        return normal.dot (point - (*input_)[nn_indices[0]].getVector3fMap ());
     }
-  }
+    return std::numeric_limits<float>::quiet_NaN ();
+  });
 }
 
 
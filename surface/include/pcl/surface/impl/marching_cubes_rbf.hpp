@@ -87,22 +87,19 @@ pcl::MarchingCubesRBF<PointNT>::voxelizeData ()
     weights[i + N] = w (i + N, 0);
   }
 
-  for (int x = 0; x < res_x_; ++x)
-    for (int y = 0; y < res_y_; ++y)
-      for (int z = 0; z < res_z_; ++z)
-      {
-        const Eigen::Vector3f point_f = (size_voxel_ * Eigen::Array3f (x, y, z) 
-            + lower_boundary_).matrix ();
-        const Eigen::Vector3d point = point_f.cast<double> ();
-
-        double f = 0.0;
-        std::vector<double>::const_iterator w_it (weights.begin());
-        for (std::vector<Eigen::Vector3d, Eigen::aligned_allocator<Eigen::Vector3d> >::const_iterator c_it = centers.begin ();
-             c_it != centers.end (); ++c_it, ++w_it)
-          f += *w_it * kernel (*c_it, point);
-
-        grid_[x * res_y_*res_z_ + y * res_z_ + z] = float (f);
-      }
+  // The grid is evaluated in parallel by the base class
+  this->evaluateGrid ([this, &weights, &centers] (const Eigen::Vector3f &point_f)
+  {
+    const Eigen::Vector3d point = point_f.cast<double> ();
+
+    double f = 0.0;
+    std::vector<double>::const_iterator w_it (weights.begin());
+    for (std::vector<Eigen::Vector3d, Eigen::aligned_allocator<Eigen::Vector3d> >::const_iterator c_it = centers.begin ();
+         c_it != centers.end (); ++c_it, ++w_it)
+      f += *w_it * kernel (*c_it, point);
+
+    return float (f);
+  });
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////
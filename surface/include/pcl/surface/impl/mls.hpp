@@ -46,6 +46,7 @@
 #include <pcl/common/copy_point.h>
 #include <pcl/common/centroid.h>
 #include <pcl/common/eigen.h>
+#include <pcl/common/execution_context.h>
 #include <pcl/search/kdtree.h> // for KdTree
 #include <pcl/search/organized.h> // for OrganizedNeighbor
 
@@ -286,9 +287,13 @@ pcl::MovingLeastSquares<PointInT, PointOutT>::performProcessing (PointCloudOut &
   // Compute the number of coefficients
   nr_coeff_ = (order_ + 1) * (order_ + 2) / 2;
 
+  if (neighborhood_cache_)
+    neighborhood_cache_->prepare (input_.get (), input_->size (), search_radius_);
+
 #ifdef _OPENMP
-  // (Maximum) number of threads
-  const unsigned int threads = threads_ == 0 ? 1 : threads_;
+  // (Maximum) number of threads, taken from the budget of pcl::ExecutionContext
+  const pcl::ThreadReservation reservation (threads_ == 0 ? 1 : threads_);
+  const unsigned int threads = reservation.getNumberOfThreads ();
   // Create temporaries for each thread in order to avoid synchronization
   typename PointCloudOut::CloudVectorType projected_points (threads);
   typename NormalCloud::CloudVectorType projected_points_normals (threads);
@@ -309,10 +314,29 @@ pcl::MovingLeastSquares<PointInT, PointOutT>::performProcessing (PointCloudOut &
     std::vector<float> nn_sqr_dists;
 
     // Get the initial estimates of point positions and their neighborhoods
-    if (searchForNeighbors ((*indices_)[cp], nn_indices, nn_sqr_dists))
+    bool found_neighbors = false;
+    const pcl::Indices *neighbors = &nn_indices;
+    if (neighborhood_cache_)
+    {
+      // Every index is only processed by one thread
+      MLSNeighborhoodCache &cache = *neighborhood_cache_;
+      const auto index = (*indices_)[cp];
+      if (!cache.computed_[index])
+      {
+        if (!searchForNeighbors (index, cache.neighbors_[index], nn_sqr_dists))
+          cache.neighbors_[index].clear ();
+        cache.computed_[index] = 1;
+      }
+      neighbors = &cache.neighbors_[index];
+      found_neighbors = !neighbors->empty ();
+    }
+    else
+      found_neighbors = searchForNeighbors ((*indices_)[cp], nn_indices, nn_sqr_dists);
+
+    if (found_neighbors)
     {
       // Check the number of nearest neighbors for normal estimation (and later for polynomial fit as well)
-      if (nn_indices.size () >= 3)
+      if (neighbors->size () >= 3)
       {
         // This thread's ID (range 0 to threads-1)
 #ifdef _OPENMP
@@ -332,13 +356,13 @@ pcl::MovingLeastSquares<PointInT, PointOutT>::performProcessing (PointCloudOut &
           mls_result_index = index; // otherwise we give it a dummy location.
 
 #ifdef _OPENMP
-        computeMLSPointNormal (index, nn_indices, projected_points[tn], projected_points_normals[tn], corresponding_input_indices[tn], mls_results_[mls_result_index]);
+        computeMLSPointNormal (index, *neighbors, projected_points[tn], projected_points_normals[tn], corresponding_input_indices[tn], mls_results_[mls_result_index]);
 
         // Copy all information from the input cloud to the output points (not doing any interpolation)
         for (std::size_t pp = pp_size; pp < projected_points[tn].size (); ++pp)
           copyMissingFields ((*input_)[(*indices_)[cp]], projected_points[tn][pp]);
 #else
-        computeMLSPointNormal (index, nn_indices, projected_points, projected_points_normals, *corresponding_input_indices_, mls_results_[mls_result_index]);
+        computeMLSPointNormal (index, *neighbors, projected_points, projected_points_normals, *corresponding_input_indices_, mls_results_[mls_result_index]);
 
         // Append projected points to output
         output.insert (output.end (), projected_points.begin (), projected_points.end ());
@@ -369,44 +393,30 @@ pcl::MovingLeastSquares<PointInT, PointOutT>::performProcessing (PointCloudOut &
 template <typename PointInT, typename PointOutT> void
 pcl::MovingLeastSquares<PointInT, PointOutT>::performUpsampling (PointCloudOut &output)
 {
+  if (upsample_method_ != DISTINCT_CLOUD && upsample_method_ != VOXEL_GRID_DILATION)
+    return;
 
+  // The positions to project to the MLS surface
+  typename PointCloudIn::VectorType samples;
   if (upsample_method_ == DISTINCT_CLOUD)
   {
-    corresponding_input_indices_.reset (new PointIndices);
-    for (std::size_t dp_i = 0; dp_i < distinct_cloud_->size (); ++dp_i) // dp_i = distinct_point_i
+    samples.reserve (distinct_cloud_->size ());
+    for (const auto &point : *distinct_cloud_)
     {
       // Distinct cloud may have nan points, skip them
-      if (!std::isfinite ((*distinct_cloud_)[dp_i].x))
-        continue;
-
-      // Get 3D position of point
-      //Eigen::Vector3f pos = (*distinct_cloud_)[dp_i].getVector3fMap ();
-      pcl::Indices nn_indices;
-      std::vector<float> nn_dists;
-      tree_->nearestKSearch ((*distinct_cloud_)[dp_i], 1, nn_indices, nn_dists);
-      const auto input_index = nn_indices.front ();
-
-      // If the closest point did not have a valid MLS fitting result
-      // OR if it is too far away from the sampled point
-      if (mls_results_[input_index].valid == false)
-        continue;
-
-      Eigen::Vector3d add_point = (*distinct_cloud_)[dp_i].getVector3fMap ().template cast<double> ();
-      MLSResult::MLSProjectionResults proj =  mls_results_[input_index].projectPoint (add_point, projection_method_,  5 * nr_coeff_);
-      addProjectedPointNormal (input_index, proj.point, proj.normal, mls_results_[input_index].curvature, output, *normals_, *corresponding_input_indices_);
+      if (std::isfinite (point.x))
+        samples.push_back (point);
     }
   }
-
   // For the voxel grid upsampling method, generate the voxel grid and dilate it
   // Then, project the newly obtained points to the MLS surface
-  if (upsample_method_ == VOXEL_GRID_DILATION)
+  else
   {
-    corresponding_input_indices_.reset (new PointIndices);
-
     MLSVoxelGrid voxel_grid (input_, indices_, voxel_size_);
     for (int iteration = 0; iteration < dilation_iteration_num_; ++iteration)
       voxel_grid.dilate ();
 
+    samples.reserve (voxel_grid.voxel_grid_.size ());
     for (typename MLSVoxelGrid::HashMap::iterator m_it = voxel_grid.voxel_grid_.begin (); m_it != voxel_grid.voxel_grid_.end (); ++m_it)
     {
       // Get 3D position of point
@@ -417,21 +427,45 @@ pcl::MovingLeastSquares<PointInT, PointOutT>::performUpsampling (PointCloudOut &
       p.x = pos[0];
       p.y = pos[1];
       p.z = pos[2];
+      samples.push_back (p);
+    }
+  }
 
-      pcl::Indices nn_indices;
-      std::vector<float> nn_dists;
-      tree_->nearestKSearch (p, 1, nn_indices, nn_dists);
-      const auto input_index = nn_indices.front ();
-
-      // If the closest point did not have a valid MLS fitting result
-      // OR if it is too far away from the sampled point
-      if (mls_results_[input_index].valid == false)
-        continue;
+  // The samples are projected in parallel, and added to the output in their order
+  const int nr_samples = static_cast<int> (samples.size ());
+  std::vector<pcl::index_t> sample_input_indices (nr_samples, UNAVAILABLE);
+  std::vector<MLSResult::MLSProjectionResults> projections (nr_samples);
+  const pcl::ThreadReservation reservation (threads_ == 0 ? 1 : threads_);
+  const unsigned int threads = reservation.getNumberOfThreads ();
+#pragma omp parallel for \
+  default(none) \
+  shared(samples, sample_input_indices, projections) \
+  firstprivate(nr_samples) \
+  schedule(dynamic,1000) \
+  num_threads(threads)
+  for (int si = 0; si < nr_samples; ++si)
+  {
+    pcl::Indices nn_indices;
+    std::vector<float> nn_dists;
+    tree_->nearestKSearch (samples[si], 1, nn_indices, nn_dists);
+    const auto input_index = nn_indices.front ();
+
+    // If the closest point did not have a valid MLS fitting result
+    // OR if it is too far away from the sampled point
+    if (mls_results_[input_index].valid == false)
+      continue;
+
+    Eigen::Vector3d add_point = samples[si].getVector3fMap ().template cast<double> ();
+    projections[si] = mls_results_[input_index].projectPoint (add_point, projection_method_,  5 * nr_coeff_);
+    sample_input_indices[si] = input_index;
+  }
 
-      Eigen::Vector3d add_point = p.getVector3fMap ().template cast<double> ();
-      MLSResult::MLSProjectionResults proj = mls_results_[input_index].projectPoint (add_point, projection_method_,  5 * nr_coeff_);
-      addProjectedPointNormal (input_index, proj.point, proj.normal, mls_results_[input_index].curvature, output, *normals_, *corresponding_input_indices_);
-    }
+  corresponding_input_indices_.reset (new PointIndices);
+  for (int si = 0; si < nr_samples; ++si)
+  {
+    const auto input_index = sample_input_indices[si];
+    if (input_index != UNAVAILABLE)
+      addProjectedPointNormal (input_index, projections[si].point, projections[si].normal, mls_results_[input_index].curvature, output, *normals_, *corresponding_input_indices_);
   }
 }
 
@@ -780,57 +814,84 @@ pcl::MLSResult::computeMLSSurface (const pcl::PointCloud<PointT> &cloud,
 
     if (num_neighbors >= nr_coeff)
     {
-      if (!weight_func)
-        weight_func = [=] (const double sq_dist) { return this->computeMLSWeight (sq_dist, search_radius * search_radius); };
-
-      // Allocate matrices and vectors to hold the data used for the polynomial fit
-      Eigen::VectorXd weight_vec (num_neighbors);
-      Eigen::MatrixXd P (nr_coeff, num_neighbors);
-      Eigen::VectorXd f_vec (num_neighbors);
-      Eigen::MatrixXd P_weight_Pt (nr_coeff, nr_coeff);
-
-      // Update neighborhood, since point was projected, and computing relative
-      // positions. Note updating only distances for the weights for speed
-      std::vector<Eigen::Vector3d, Eigen::aligned_allocator<Eigen::Vector3d> > de_meaned (num_neighbors);
-      for (std::size_t ni = 0; ni < static_cast<std::size_t>(num_neighbors); ++ni)
+      // Orders 2 and 3 use fixed-size matrices, the default weight is inlined
+      const double sq_search_radius = search_radius * search_radius;
+      const auto default_weight = [this, sq_search_radius] (const double sq_dist) { return (this->computeMLSWeight (sq_dist, sq_search_radius)); };
+      if (order == 2)
       {
-        de_meaned[ni][0] = cloud[nn_indices[ni]].x - mean[0];
-        de_meaned[ni][1] = cloud[nn_indices[ni]].y - mean[1];
-        de_meaned[ni][2] = cloud[nn_indices[ni]].z - mean[2];
-        weight_vec (ni) = weight_func (de_meaned[ni].dot (de_meaned[ni]));
+        if (weight_func)
+          fitPolynomial<6> (cloud, nn_indices, weight_func);
+        else
+          fitPolynomial<6> (cloud, nn_indices, default_weight);
       }
-
-      // Go through neighbors, transform them in the local coordinate system,
-      // save height and the evaluation of the polynomial's terms
-      for (std::size_t ni = 0; ni < static_cast<std::size_t>(num_neighbors); ++ni)
+      else if (order == 3)
       {
-        // Transforming coordinates
-        const double u_coord = de_meaned[ni].dot(u_axis);
-        const double v_coord = de_meaned[ni].dot(v_axis);
-        f_vec (ni) = de_meaned[ni].dot (plane_normal);
-
-        // Compute the polynomial's terms at the current point
-        int j = 0;
-        double u_pow = 1;
-        for (int ui = 0; ui <= order; ++ui)
-        {
-          double v_pow = 1;
-          for (int vi = 0; vi <= order - ui; ++vi)
-          {
-            P (j++, ni) = u_pow * v_pow;
-            v_pow *= v_coord;
-          }
-          u_pow *= u_coord;
-        }
+        if (weight_func)
+          fitPolynomial<10> (cloud, nn_indices, weight_func);
+        else
+          fitPolynomial<10> (cloud, nn_indices, default_weight);
+      }
+      else
+      {
+        if (weight_func)
+          fitPolynomial<Eigen::Dynamic> (cloud, nn_indices, weight_func);
+        else
+          fitPolynomial<Eigen::Dynamic> (cloud, nn_indices, default_weight);
       }
+    }
+  }
+}
 
-      // Computing coefficients
-      const Eigen::MatrixXd P_weight = P * weight_vec.asDiagonal(); // size will be (nr_coeff_, nn_indices.size ());
-      P_weight_Pt = P_weight * P.transpose ();
-      c_vec = P_weight * f_vec;
-      P_weight_Pt.llt ().solveInPlace (c_vec);
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <int NrCoeff, typename PointT, typename WeightFunc> void
+pcl::MLSResult::fitPolynomial (const pcl::PointCloud<PointT> &cloud,
+                               const pcl::Indices &nn_indices,
+                               const WeightFunc &weight_func)
+{
+  const int nr_coeff = (order + 1) * (order + 2) / 2;
+  using Vector = Eigen::Matrix<double, NrCoeff, 1>;
+  using Matrix = Eigen::Matrix<double, NrCoeff, NrCoeff>;
+
+  // Normal equations of the weighted fit: (P W P^T) c = P W f
+  Matrix P_weight_Pt = Matrix::Zero (nr_coeff, nr_coeff);
+  Vector P_weight_f = Vector::Zero (nr_coeff);
+  Vector p (nr_coeff);
+
+  // Update neighborhood, since point was projected, and computing relative
+  // positions, transform them in the local coordinate system, and
+  // accumulate the polynomial's terms weighted by distance
+  for (const auto &nn_index : nn_indices)
+  {
+    const Eigen::Vector3d de_meaned (cloud[nn_index].x - mean[0],
+                                     cloud[nn_index].y - mean[1],
+                                     cloud[nn_index].z - mean[2]);
+    const double weight = weight_func (de_meaned.dot (de_meaned));
+
+    // Transforming coordinates
+    const double u_coord = de_meaned.dot (u_axis);
+    const double v_coord = de_meaned.dot (v_axis);
+    const double f = de_meaned.dot (plane_normal);
+
+    // Compute the polynomial's terms at the current point
+    int j = 0;
+    double u_pow = 1;
+    for (int ui = 0; ui <= order; ++ui)
+    {
+      double v_pow = 1;
+      for (int vi = 0; vi <= order - ui; ++vi)
+      {
+        p (j++) = u_pow * v_pow;
+        v_pow *= v_coord;
+      }
+      u_pow *= u_coord;
     }
+
+    P_weight_Pt.template selfadjointView<Eigen::Lower> ().rankUpdate (p, weight);
+    P_weight_f += (weight * f) * p;
   }
+
+  // Computing coefficients
+  c_vec = P_weight_Pt.template selfadjointView<Eigen::Lower> ().llt ().solve (P_weight_f);
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////
@@ -42,8 +42,12 @@
 #define PCL_SURFACE_ORGANIZED_FAST_MESH_HPP_
 
 #include <pcl/surface/organized_fast_mesh.h>
+#include <pcl/common/execution_context.h>
 #include <pcl/common/io.h> // for getFieldIndex
 
+#include <algorithm>
+#include <utility>
+
 /////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointInT> void
 pcl::OrganizedFastMesh<PointInT>::performReconstruction (pcl::PolygonMesh &output)
@@ -88,56 +92,117 @@ pcl::OrganizedFastMesh<PointInT>::reconstructPolygons (std::vector<pcl::Vertices
 
 /////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointInT> void
-pcl::OrganizedFastMesh<PointInT>::makeQuadMesh (std::vector<pcl::Vertices>& polygons)
+pcl::OrganizedFastMesh<PointInT>::setNumberOfThreads (unsigned int nr_threads)
 {
-  int last_column = input_->width - triangle_pixel_size_columns_;
-  int last_row = input_->height - triangle_pixel_size_rows_;
+  // 0 is resolved against the budget of pcl::ExecutionContext at compute time
+  threads_ = nr_threads;
+}
 
-  int i = 0, index_down = 0, index_right = 0, index_down_right = 0, idx = 0;
-  int y_big_incr = triangle_pixel_size_rows_ * input_->width,
-      x_big_incr = y_big_incr + triangle_pixel_size_columns_;
-  // Reserve enough space
-  polygons.resize (input_->width * input_->height);
+/////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointInT> void
+pcl::OrganizedFastMesh<PointInT>::reconstruct (std::vector<std::uint32_t> &indices)
+{
+  indices.clear ();
+  if (!initCompute ())
+    return;
 
-  // Go over the rows first
-  for (int y = 0; y < last_row; y += triangle_pixel_size_rows_)
+  const int last_row = input_->height - triangle_pixel_size_rows_;
+  const int nr_rows = last_row > 0 ? (last_row + triangle_pixel_size_rows_ - 1) / triangle_pixel_size_rows_ : 0;
+  const pcl::ThreadReservation reservation (threads_);
+  const unsigned int threads = reservation.getNumberOfThreads ();
+  const int nr_bands = std::max (1, std::min (static_cast<int> (threads), nr_rows));
+  band_indices_.resize (nr_bands);
+
+  // Mesh the bands of rows in parallel, each into its own buffer
+  std::vector<std::size_t> offsets (nr_bands + 1, 0);
+#pragma omp parallel for \
+  default(none) \
+  shared(offsets) \
+  firstprivate(last_row, nr_bands, nr_rows) \
+  schedule(static, 1) \
+  num_threads(threads)
+  for (int band = 0; band < nr_bands; ++band)
   {
-    // Initialize a new row
-    i = y * input_->width;
-    index_right = i + triangle_pixel_size_columns_;
-    index_down = i + y_big_incr;
-    index_down_right = i + x_big_incr;
+    std::vector<std::uint32_t> &band_indices = band_indices_[band];
+    band_indices.clear ();
+    IndexSink sink {band_indices};
+    const int first_row = (nr_rows * band / nr_bands) * triangle_pixel_size_rows_;
+    const int end_row = std::min (last_row, (nr_rows * (band + 1) / nr_bands) * triangle_pixel_size_rows_);
+    makeMeshRows (triangulation_type_, first_row, end_row, sink);
+    offsets[band + 1] = band_indices.size ();
+  }
 
-    // Go over the columns
-    for (int x = 0; x < last_column; x += triangle_pixel_size_columns_,
-                                     i += triangle_pixel_size_columns_,
-                                     index_right += triangle_pixel_size_columns_,
-                                     index_down += triangle_pixel_size_columns_,
-                                     index_down_right += triangle_pixel_size_columns_)
-    {
-      if (isValidQuad (i, index_right, index_down_right, index_down))
-        if (store_shadowed_faces_ || !isShadowedQuad (i, index_right, index_down_right, index_down))
-          addQuad (i, index_right, index_down_right, index_down, idx++, polygons);
-    }
+  // Concatenate the bands in order
+  for (int band = 0; band < nr_bands; ++band)
+    offsets[band + 1] += offsets[band];
+  indices.resize (offsets[nr_bands]);
+#pragma omp parallel for \
+  default(none) \
+  shared(indices, offsets) \
+  firstprivate(nr_bands) \
+  schedule(static, 1) \
+  num_threads(threads)
+  for (int band = 0; band < nr_bands; ++band)
+    std::copy (band_indices_[band].begin (), band_indices_[band].end (), indices.begin () + offsets[band]);
+
+  deinitCompute ();
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointInT> void
+pcl::OrganizedFastMesh<PointInT>::reconstruct (pcl::PolygonMeshBuffer &output)
+{
+  // Reuse the index buffer of the output
+  std::vector<std::uint32_t> indices;
+  indices.swap (output.indices);
+  reconstruct (indices);
+  output.setPolygons (std::move (indices), getVerticesPerPolygon ());
+  if (!input_)
+  {
+    output.cloud.width = output.cloud.height = 1;
+    output.cloud.data.clear ();
+    return;
   }
-  polygons.resize (idx);
+  output.header = input_->header;
+  pcl::toPCLPointCloud2 (*input_, output.cloud);
+
+  const int x_idx = pcl::getFieldIndex (output.cloud, "x");
+  const int y_idx = pcl::getFieldIndex (output.cloud, "y");
+  const int z_idx = pcl::getFieldIndex (output.cloud, "z");
+  if (x_idx == -1 || y_idx == -1 || z_idx == -1)
+    return;
+  for (std::size_t i = 0; i < input_->size (); ++i)
+    if (!isFinite ((*input_)[i]))
+      resetPointData (static_cast<int> (i), output.cloud, 0.0f, x_idx, y_idx, z_idx);
 }
 
 /////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointInT> void
-pcl::OrganizedFastMesh<PointInT>::makeRightCutMesh (std::vector<pcl::Vertices>& polygons)
+pcl::OrganizedFastMesh<PointInT>::indicesToPolygons (const std::vector<std::uint32_t> &indices,
+                                                     unsigned int vertices_per_polygon,
+                                                     std::vector<pcl::Vertices> &polygons)
+{
+  polygons.resize (indices.size () / vertices_per_polygon);
+  auto index = indices.cbegin ();
+  for (auto &polygon : polygons)
+  {
+    polygon.vertices.assign (index, index + vertices_per_polygon);
+    index += vertices_per_polygon;
+  }
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointInT> template <typename Sink> void
+pcl::OrganizedFastMesh<PointInT>::makeMeshRows (TriangulationType type, int first_row, int end_row, Sink &sink)
 {
   int last_column = input_->width - triangle_pixel_size_columns_;
-  int last_row = input_->height - triangle_pixel_size_rows_;
 
-  int i = 0, index_down = 0, index_right = 0, index_down_right = 0, idx = 0;
+  int i = 0, index_down = 0, index_right = 0, index_down_right = 0;
   int y_big_incr = triangle_pixel_size_rows_ * input_->width,
       x_big_incr = y_big_incr + triangle_pixel_size_columns_;
-  // Reserve enough space
-  polygons.resize (input_->width * input_->height * 2);
 
   // Go over the rows first
-  for (int y = 0; y < last_row; y += triangle_pixel_size_rows_)
+  for (int y = first_row; y < end_row; y += triangle_pixel_size_rows_)
   {
     // Initialize a new row
     i = y * input_->width;
@@ -152,130 +217,131 @@ pcl::OrganizedFastMesh<PointInT>::makeRightCutMesh (std::vector<pcl::Vertices>&
                                      index_down += triangle_pixel_size_columns_,
                                      index_down_right += triangle_pixel_size_columns_)
     {
-      if (isValidTriangle (i, index_down_right, index_right))
-        if (store_shadowed_faces_ || !isShadowedTriangle (i, index_down_right, index_right))
-          addTriangle (i, index_down_right, index_right, idx++, polygons);
+      switch (type)
+      {
+        case QUAD_MESH:
+        {
+          if (isValidQuad (i, index_right, index_down_right, index_down))
+            if (store_shadowed_faces_ || !isShadowedQuad (i, index_right, index_down_right, index_down))
+              sink.quad (i, index_right, index_down_right, index_down);
+          break;
+        }
+        case TRIANGLE_RIGHT_CUT:
+        {
+          if (isValidTriangle (i, index_down_right, index_right))
+            if (store_shadowed_faces_ || !isShadowedTriangle (i, index_down_right, index_right))
+              sink.triangle (i, index_down_right, index_right);
+
+          if (isValidTriangle (i, index_down, index_down_right))
+            if (store_shadowed_faces_ || !isShadowedTriangle (i, index_down, index_down_right))
+              sink.triangle (i, index_down, index_down_right);
+          break;
+        }
+        case TRIANGLE_LEFT_CUT:
+        {
+          if (isValidTriangle (i, index_down, index_right))
+            if (store_shadowed_faces_ || !isShadowedTriangle (i, index_down, index_right))
+              sink.triangle (i, index_down, index_right);
+
+          if (isValidTriangle (index_right, index_down, index_down_right))
+            if (store_shadowed_faces_ || !isShadowedTriangle (index_right, index_down, index_down_right))
+              sink.triangle (index_right, index_down, index_down_right);
+          break;
+        }
+        case TRIANGLE_ADAPTIVE_CUT:
+        {
+          const bool right_cut_upper = isValidTriangle (i, index_down_right, index_right);
+          const bool right_cut_lower = isValidTriangle (i, index_down, index_down_right);
+          const bool left_cut_upper = isValidTriangle (i, index_down, index_right);
+          const bool left_cut_lower = isValidTriangle (index_right, index_down, index_down_right);
 
-      if (isValidTriangle (i, index_down, index_down_right))
-        if (store_shadowed_faces_ || !isShadowedTriangle (i, index_down, index_down_right))
-          addTriangle (i, index_down, index_down_right, idx++, polygons);
+          if (right_cut_upper && right_cut_lower && left_cut_upper && left_cut_lower)
+          {
+            float dist_right_cut = std::abs ((*input_)[index_down].z - (*input_)[index_right].z);
+            float dist_left_cut = std::abs ((*input_)[i].z - (*input_)[index_down_right].z);
+            if (dist_right_cut >= dist_left_cut)
+            {
+              if (store_shadowed_faces_ || !isShadowedTriangle (i, index_down_right, index_right))
+                sink.triangle (i, index_down_right, index_right);
+              if (store_shadowed_faces_ || !isShadowedTriangle (i, index_down, index_down_right))
+                sink.triangle (i, index_down, index_down_right);
+            }
+            else
+            {
+              if (store_shadowed_faces_ || !isShadowedTriangle (i, index_down, index_right))
+                sink.triangle (i, index_down, index_right);
+              if (store_shadowed_faces_ || !isShadowedTriangle (index_right, index_down, index_down_right))
+                sink.triangle (index_right, index_down, index_down_right);
+            }
+          }
+          else
+          {
+            if (right_cut_upper)
+              if (store_shadowed_faces_ || !isShadowedTriangle (i, index_down_right, index_right))
+                sink.triangle (i, index_down_right, index_right);
+            if (right_cut_lower)
+              if (store_shadowed_faces_ || !isShadowedTriangle (i, index_down, index_down_right))
+                sink.triangle (i, index_down, index_down_right);
+            if (left_cut_upper)
+              if (store_shadowed_faces_ || !isShadowedTriangle (i, index_down, index_right))
+                sink.triangle (i, index_down, index_right);
+            if (left_cut_lower)
+              if (store_shadowed_faces_ || !isShadowedTriangle (index_right, index_down, index_down_right))
+                sink.triangle (index_right, index_down, index_down_right);
+          }
+          break;
+        }
+      }
     }
   }
-  polygons.resize (idx);
 }
 
 /////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointInT> void
-pcl::OrganizedFastMesh<PointInT>::makeLeftCutMesh (std::vector<pcl::Vertices>& polygons)
+pcl::OrganizedFastMesh<PointInT>::makeQuadMesh (std::vector<pcl::Vertices>& polygons)
 {
-  int last_column = input_->width - triangle_pixel_size_columns_;
-  int last_row = input_->height - triangle_pixel_size_rows_;
+  // Reserve enough space
+  polygons.resize (input_->width * input_->height);
 
-  int i = 0, index_down = 0, index_right = 0, index_down_right = 0, idx = 0;
-  int y_big_incr = triangle_pixel_size_rows_ * input_->width,
-      x_big_incr = y_big_incr + triangle_pixel_size_columns_;
+  PolygonSink sink {*this, polygons, 0};
+  makeMeshRows (QUAD_MESH, 0, input_->height - triangle_pixel_size_rows_, sink);
+  polygons.resize (sink.idx);
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointInT> void
+pcl::OrganizedFastMesh<PointInT>::makeRightCutMesh (std::vector<pcl::Vertices>& polygons)
+{
   // Reserve enough space
   polygons.resize (input_->width * input_->height * 2);
 
-  // Go over the rows first
-  for (int y = 0; y < last_row; y += triangle_pixel_size_rows_)
-  {
-    // Initialize a new row
-    i = y * input_->width;
-    index_right = i + triangle_pixel_size_columns_;
-    index_down = i + y_big_incr;
-    index_down_right = i + x_big_incr;
+  PolygonSink sink {*this, polygons, 0};
+  makeMeshRows (TRIANGLE_RIGHT_CUT, 0, input_->height - triangle_pixel_size_rows_, sink);
+  polygons.resize (sink.idx);
+}
 
-    // Go over the columns
-    for (int x = 0; x < last_column; x += triangle_pixel_size_columns_,
-                                     i += triangle_pixel_size_columns_,
-                                     index_right += triangle_pixel_size_columns_,
-                                     index_down += triangle_pixel_size_columns_,
-                                     index_down_right += triangle_pixel_size_columns_)
-    {
-      if (isValidTriangle (i, index_down, index_right))
-        if (store_shadowed_faces_ || !isShadowedTriangle (i, index_down, index_right))
-          addTriangle (i, index_down, index_right, idx++, polygons);
+/////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointInT> void
+pcl::OrganizedFastMesh<PointInT>::makeLeftCutMesh (std::vector<pcl::Vertices>& polygons)
+{
+  // Reserve enough space
+  polygons.resize (input_->width * input_->height * 2);
 
-      if (isValidTriangle (index_right, index_down, index_down_right))
-        if (store_shadowed_faces_ || !isShadowedTriangle (index_right, index_down, index_down_right))
-          addTriangle (index_right, index_down, index_down_right, idx++, polygons);
-    }
-  }
-  polygons.resize (idx);
+  PolygonSink sink {*this, polygons, 0};
+  makeMeshRows (TRIANGLE_LEFT_CUT, 0, input_->height - triangle_pixel_size_rows_, sink);
+  polygons.resize (sink.idx);
 }
 
 /////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointInT> void
 pcl::OrganizedFastMesh<PointInT>::makeAdaptiveCutMesh (std::vector<pcl::Vertices>& polygons)
 {
-  int last_column = input_->width - triangle_pixel_size_columns_;
-  int last_row = input_->height - triangle_pixel_size_rows_;
-
-  int i = 0, index_down = 0, index_right = 0, index_down_right = 0, idx = 0;
-  int y_big_incr = triangle_pixel_size_rows_ * input_->width,
-      x_big_incr = y_big_incr + triangle_pixel_size_columns_;
   // Reserve enough space
   polygons.resize (input_->width * input_->height * 2);
 
-  // Go over the rows first
-  for (int y = 0; y < last_row; y += triangle_pixel_size_rows_)
-  {
-    // Initialize a new row
-    i = y * input_->width;
-    index_right = i + triangle_pixel_size_columns_;
-    index_down = i + y_big_incr;
-    index_down_right = i + x_big_incr;
-
-    // Go over the columns
-    for (int x = 0; x < last_column; x += triangle_pixel_size_columns_,
-                                     i += triangle_pixel_size_columns_,
-                                     index_right += triangle_pixel_size_columns_,
-                                     index_down += triangle_pixel_size_columns_,
-                                     index_down_right += triangle_pixel_size_columns_)
-    {
-      const bool right_cut_upper = isValidTriangle (i, index_down_right, index_right);
-      const bool right_cut_lower = isValidTriangle (i, index_down, index_down_right);
-      const bool left_cut_upper = isValidTriangle (i, index_down, index_right);
-      const bool left_cut_lower = isValidTriangle (index_right, index_down, index_down_right);
-
-      if (right_cut_upper && right_cut_lower && left_cut_upper && left_cut_lower)
-      {
-        float dist_right_cut = std::abs ((*input_)[index_down].z - (*input_)[index_right].z);
-        float dist_left_cut = std::abs ((*input_)[i].z - (*input_)[index_down_right].z);
-        if (dist_right_cut >= dist_left_cut)
-        {
-          if (store_shadowed_faces_ || !isShadowedTriangle (i, index_down_right, index_right))
-            addTriangle (i, index_down_right, index_right, idx++, polygons);
-          if (store_shadowed_faces_ || !isShadowedTriangle (i, index_down, index_down_right))
-            addTriangle (i, index_down, index_down_right, idx++, polygons);
-        }
-        else
-        {
-          if (store_shadowed_faces_ || !isShadowedTriangle (i, index_down, index_right))
-            addTriangle (i, index_down, index_right, idx++, polygons);
-          if (store_shadowed_faces_ || !isShadowedTriangle (index_right, index_down, index_down_right))
-            addTriangle (index_right, index_down, index_down_right, idx++, polygons);
-        }
-      }
-      else
-      {
-        if (right_cut_upper)
-          if (store_shadowed_faces_ || !isShadowedTriangle (i, index_down_right, index_right))
-            addTriangle (i, index_down_right, index_right, idx++, polygons);
-        if (right_cut_lower)
-          if (store_shadowed_faces_ || !isShadowedTriangle (i, index_down, index_down_right))
-            addTriangle (i, index_down, index_down_right, idx++, polygons);
-        if (left_cut_upper)
-          if (store_shadowed_faces_ || !isShadowedTriangle (i, index_down, index_right))
-            addTriangle (i, index_down, index_right, idx++, polygons);
-        if (left_cut_lower)
-          if (store_shadowed_faces_ || !isShadowedTriangle (index_right, index_down, index_down_right))
-            addTriangle (index_right, index_down, index_down_right, idx++, polygons);
-      }
-    }
-  }
-  polygons.resize (idx);
+  PolygonSink sink {*this, polygons, 0};
+  makeMeshRows (TRIANGLE_ADAPTIVE_CUT, 0, input_->height - triangle_pixel_size_rows_, sink);
+  polygons.resize (sink.idx);
 }
 
 #define PCL_INSTANTIATE_OrganizedFastMesh(T)                \
@@ -42,6 +42,7 @@
 
 #include <pcl/surface/poisson.h>
 #include <pcl/common/common.h>
+#include <pcl/common/execution_context.h>
 #include <pcl/common/vector_average.h>
 #include <pcl/Vertices.h>
 
@@ -54,7 +55,10 @@
 
 #define MEMORY_ALLOCATOR_BLOCK_SIZE 1<<12
 
+#include <algorithm>
 #include <cstdarg>
+#include <cstdint>
+#include <cstdio>
 #include <string>
 
 using namespace pcl;
@@ -82,6 +86,7 @@ pcl::Poisson<PointNT>::Poisson ()
   , min_iterations_ (8)
   , solver_accuracy_ (1e-3f)
   , threads_(1)
+  , max_memory_ (0)
 {
 }
 
@@ -95,29 +100,18 @@ pcl::Poisson<PointNT>::~Poisson ()
 template <typename PointNT> void
 pcl::Poisson<PointNT>::setThreads (int threads)
 {
-  if (threads == 0)
-#ifdef _OPENMP
-    threads_ = omp_get_num_procs();
-#else
-    threads_ = 1;
-#endif
-  else
-    threads_ = threads;
+  // 0 is resolved against the budget of pcl::ExecutionContext at compute time
+  threads_ = threads;
 }
       
 //////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointNT> template <int Degree> void
-pcl::Poisson<PointNT>::execute (poisson::CoredVectorMeshData &mesh,
+pcl::Poisson<PointNT>::execute (poisson::CoredMeshData &mesh,
                                 poisson::Point3D<float> &center,
                                 float &scale)
 {
   pcl::poisson::Real iso_value = 0;
   poisson::TreeNodeData::UseIndex = 1;
-  poisson::Octree<Degree> tree;
-
-  
-  tree.threads = threads_;
-  center.coords[0] = center.coords[1] = center.coords[2] = 0;
 
 
   if (solver_divide_ < min_depth_)
@@ -131,45 +125,65 @@ pcl::Poisson<PointNT>::execute (poisson::CoredVectorMeshData &mesh,
     iso_divide_ = min_depth_;
   }
 
-  pcl::poisson::TreeOctNode::SetAllocator (MEMORY_ALLOCATOR_BLOCK_SIZE);
+  // Rough memory needed per octree node: the node itself, the constraint and solution vectors, the corner and
+  // edge tables of the iso-surface extractor, and a row of the symmetric Laplacian with (2 * Degree + 1)^3 entries
+  const std::size_t node_memory = sizeof (pcl::poisson::TreeOctNode) + 2 * sizeof (pcl::poisson::Real) + 20 * sizeof (int) +
+    ((2 * Degree + 1) * (2 * Degree + 1) * (2 * Degree + 1) + 1) / 2 * sizeof (pcl::poisson::MatrixEntry<float>);
 
-  kernel_depth_ = depth_ - 2;
+  const pcl::ThreadReservation reservation (static_cast<unsigned int> (std::max (threads_, 0)));
+  const int threads = static_cast<int> (reservation.getNumberOfThreads ());
+  for (int depth = depth_; ; --depth)
+  {
+    poisson::Octree<Degree> tree;
+    tree.threads = threads;
+    center.coords[0] = center.coords[1] = center.coords[2] = 0;
 
-  tree.setBSplineData (depth_, pcl::poisson::Real (1.0 / (1 << depth_)), true);
+    pcl::poisson::TreeOctNode::SetAllocator (MEMORY_ALLOCATOR_BLOCK_SIZE);
 
-  tree.maxMemoryUsage = 0;
+    kernel_depth_ = depth - 2;
 
+    tree.setBSplineData (depth, pcl::poisson::Real (1.0 / (1 << depth)), true);
 
-  int point_count = tree.template setTree<PointNT> (input_, depth_, min_depth_, kernel_depth_, samples_per_node_,
-                                                    scale_, center, scale, confidence_, point_weight_, !non_adaptive_weights_);
+    tree.maxMemoryUsage = 0;
 
-  tree.ClipTree ();
-  tree.finalize ();
-  tree.RefineBoundary (iso_divide_);
 
-  PCL_DEBUG ("Input Points: %d\n" , point_count );
-  PCL_DEBUG ("Leaves/Nodes: %d/%d\n" , tree.tree.leaves() , tree.tree.nodes() );
+    int point_count = tree.template setTree<PointNT> (input_, depth, min_depth_, kernel_depth_, samples_per_node_,
+                                                      scale_, center, scale, confidence_, point_weight_, !non_adaptive_weights_);
 
-  tree.maxMemoryUsage = 0;
-  tree.SetLaplacianConstraints ();
+    tree.ClipTree ();
+    tree.finalize ();
+    tree.RefineBoundary (iso_divide_);
 
-  tree.maxMemoryUsage = 0;
-  tree.LaplacianMatrixIteration (solver_divide_, show_residual_, min_iterations_, solver_accuracy_);
+    PCL_DEBUG ("Input Points: %d\n" , point_count );
+    PCL_DEBUG ("Leaves/Nodes: %d/%d\n" , tree.tree.leaves() , tree.tree.nodes() );
 
-  iso_value = tree.GetIsoValue ();
+    const std::size_t memory = static_cast<std::size_t> (tree.tree.nodes ()) * node_memory;
+    if (max_memory_ > 0 && memory > max_memory_ && depth > min_depth_)
+    {
+      PCL_WARN ("[pcl::Poisson] Depth %d needs about %zu MB, more than the limit of %zu MB, reducing the depth to %d\n",
+                depth, memory >> 20, max_memory_ >> 20, depth - 1);
+      continue;
+    }
 
-  tree.GetMCIsoTriangles (iso_value, iso_divide_, &mesh, 0, 1, manifold_, output_polygons_);
-}
+    tree.maxMemoryUsage = 0;
+    tree.SetLaplacianConstraints ();
 
+    tree.maxMemoryUsage = 0;
+    tree.LaplacianMatrixIteration (solver_divide_, show_residual_, min_iterations_, solver_accuracy_);
+
+    iso_value = tree.GetIsoValue ();
+
+    tree.GetMCIsoTriangles (iso_value, iso_divide_, &mesh, 0, 1, manifold_, output_polygons_);
+    break;
+  }
+}
 
 //////////////////////////////////////////////////////////////////////////////////////////////
-template <typename PointNT> void
-pcl::Poisson<PointNT>::performReconstruction (PolygonMesh &output)
+template <typename PointNT> bool
+pcl::Poisson<PointNT>::computeMesh (poisson::CoredMeshData &mesh,
+                                    poisson::Point3D<float> &center,
+                                    float &scale)
 {
-  poisson::CoredVectorMeshData mesh;
-  poisson::Point3D<float> center;
-  float scale = 1.0f;
-
   switch (degree_)
   {
   case 1:
@@ -199,9 +213,23 @@ pcl::Poisson<PointNT>::performReconstruction (PolygonMesh &output)
   }
   default:
   {
-    PCL_ERROR (stderr, "Degree %d not supported\n", degree_);
+    PCL_ERROR ("[pcl::Poisson] Degree %d not supported\n", degree_);
+    return (false);
   }
   }
+  return (true);
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointNT> void
+pcl::Poisson<PointNT>::performReconstruction (PolygonMesh &output)
+{
+  poisson::CoredVectorMeshData mesh;
+  poisson::Point3D<float> center;
+  float scale = 1.0f;
+
+  computeMesh (mesh, center, scale);
 
   // Write output PolygonMesh
   pcl::PointCloud<pcl::PointXYZ> cloud;
@@ -251,38 +279,7 @@ pcl::Poisson<PointNT>::performReconstruction (pcl::PointCloud<PointNT> &points,
   poisson::Point3D<float> center;
   float scale = 1.0f;
 
-  switch (degree_)
-  {
-  case 1:
-  {
-    execute<1> (mesh, center, scale);
-    break;
-  }
-  case 2:
-  {
-    execute<2> (mesh, center, scale);
-    break;
-  }
-  case 3:
-  {
-    execute<3> (mesh, center, scale);
-    break;
-  }
-  case 4:
-  {
-    execute<4> (mesh, center, scale);
-    break;
-  }
-  case 5:
-  {
-    execute<5> (mesh, center, scale);
-    break;
-  }
-  default:
-  {
-    PCL_ERROR (stderr, "Degree %d not supported\n", degree_);
-  }
-  }
+  computeMesh (mesh, center, scale);
 
   // Write output PolygonMesh
   // Write vertices
@@ -323,6 +320,79 @@ pcl::Poisson<PointNT>::performReconstruction (pcl::PointCloud<PointNT> &points,
   }
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointNT> bool
+pcl::Poisson<PointNT>::reconstruct (const std::string &file_name)
+{
+  if (!initCompute ())
+    return (false);
+
+  poisson::CoredFileMeshData mesh;
+  poisson::Point3D<float> center;
+  float scale = 1.0f;
+
+  if (!computeMesh (mesh, center, scale))
+  {
+    deinitCompute ();
+    return (false);
+  }
+  mesh.resetIterator ();
+
+  std::FILE *file = std::fopen (file_name.c_str (), "wb");
+  if (!file)
+  {
+    PCL_ERROR ("[pcl::%s::reconstruct] Could not open %s for writing\n", getClassName ().c_str (), file_name.c_str ());
+    deinitCompute ();
+    return (false);
+  }
+
+  const int nr_in_core = static_cast<int> (mesh.inCorePoints.size ());
+  const std::uint16_t endianness_test = 1;
+  const bool little_endian = (*reinterpret_cast<const std::uint8_t*> (&endianness_test) == 1);
+  std::fprintf (file, "ply\nformat %s 1.0\n", little_endian ? "binary_little_endian" : "binary_big_endian");
+  std::fprintf (file, "element vertex %d\nproperty float x\nproperty float y\nproperty float z\n", nr_in_core + mesh.outOfCorePointCount ());
+  std::fprintf (file, "element face %d\nproperty list uchar int vertex_indices\nend_header\n", mesh.polygonCount ());
+
+  // Write vertices, the in-core ones first as in the PolygonMesh output
+  bool success = true;
+  poisson::Point3D<float> p;
+  const auto writeVertex = [&] (const poisson::Point3D<float> &vertex)
+  {
+    float xyz[3];
+    for (int k = 0; k < 3; ++k)
+      xyz[k] = vertex.coords[k]*scale+center.coords[k];
+    success = success && (std::fwrite (xyz, sizeof (float), 3, file) == 3);
+  };
+  for (int i = 0; i < nr_in_core; i++)
+    writeVertex (mesh.inCorePoints[i]);
+  for (int i = 0; i < mesh.outOfCorePointCount (); i++)
+  {
+    success = success && mesh.nextOutOfCorePoint (p);
+    writeVertex (p);
+  }
+
+  // Write faces
+  std::vector<poisson::CoredVertexIndex> polygon;
+  std::vector<int> vertices;
+  for (int p_i = 0; p_i < mesh.polygonCount () && success; p_i++)
+  {
+    success = mesh.nextPolygon (polygon) && polygon.size () < 256;
+    vertices.resize (polygon.size ());
+    for (std::size_t i = 0; i < polygon.size (); ++i)
+      vertices[i] = polygon[i].inCore ? polygon[i].idx : polygon[i].idx + nr_in_core;
+    const std::uint8_t size = static_cast<std::uint8_t> (vertices.size ());
+    success = success && std::fwrite (&size, sizeof (size), 1, file) == 1 &&
+              std::fwrite (vertices.data (), sizeof (int), vertices.size (), file) == vertices.size ();
+  }
+
+  success = (std::fclose (file) == 0) && success;
+  if (!success)
+    PCL_ERROR ("[pcl::%s::reconstruct] Failed writing the mesh to %s\n", getClassName ().c_str (), file_name.c_str ());
+
+  deinitCompute ();
+  return (success);
+}
+
 
 #define PCL_INSTANTIATE_Poisson(T) template class PCL_EXPORTS pcl::Poisson<T>;
 
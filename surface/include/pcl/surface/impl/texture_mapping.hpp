@@ -40,6 +40,7 @@
 
 #include <pcl/common/distances.h>
 #include <pcl/surface/texture_mapping.h>
+#include <pcl/common/execution_context.h>
 #include <unordered_set>
 
 ///////////////////////////////////////////////////////////////////////////////////////////////
@@ -701,219 +702,187 @@ pcl::TextureMapping<PointInT>::showOcclusions (pcl::TextureMesh &tex_mesh, pcl::
 
 ///////////////////////////////////////////////////////////////////////////////////////////////
 template<typename PointInT> void
-pcl::TextureMapping<PointInT>::textureMeshwithMultipleCameras (pcl::TextureMesh &mesh, const pcl::texture_mapping::CameraVector &cameras)
+pcl::TextureMapping<PointInT>::setNumberOfThreads (unsigned int nr_threads)
 {
+  // 0 is resolved against the budget of pcl::ExecutionContext at compute time
+  threads_ = nr_threads;
+}
 
-  if (mesh.tex_polygons.size () != 1)
+///////////////////////////////////////////////////////////////////////////////////////////////
+template<typename PointInT> void
+pcl::TextureMapping<PointInT>::computeFaceVisibility (const PointCloud &cloud, const std::vector<pcl::Vertices> &faces,
+                                                      const Camera &camera, std::vector<std::uint8_t> &visible) const
+{
+  visible.assign (faces.size (), 0);
+
+  // image center and focal lengths, as in getPointUVCoordinates
+  const double size_x = camera.width;
+  const double size_y = camera.height;
+  const double cx = (camera.center_w > 0) ? camera.center_w : size_x / 2.0;
+  const double cy = (camera.center_h > 0) ? camera.center_h : size_y / 2.0;
+  const double focal_x = (camera.focal_length_w > 0) ? camera.focal_length_w : camera.focal_length;
+  const double focal_y = (camera.focal_length_h > 0) ? camera.focal_length_h : camera.focal_length;
+
+  const int width = static_cast<int> (std::ceil (size_x));
+  const int height = static_cast<int> (std::ceil (size_y));
+  if (width <= 0 || height <= 0)
     return;
 
-  typename pcl::PointCloud<PointInT>::Ptr mesh_cloud (new pcl::PointCloud<PointInT>);
-
-  pcl::fromPCLPointCloud2 (mesh.cloud, *mesh_cloud);
-
-  std::vector<pcl::Vertices> faces;
+  // project the vertices to pixel coordinates, the depth is NaN for points behind the camera
+  const Eigen::Affine3f pose_inverse = camera.pose.inverse ();
+  std::vector<Eigen::Vector3f, Eigen::aligned_allocator<Eigen::Vector3f> > projections (cloud.size ());
+  for (std::size_t i = 0; i < cloud.size (); ++i)
+  {
+    const Eigen::Vector3f pt = pose_inverse * cloud[i].getVector3fMap ();
+    if (pt.z () > 0)
+      projections[i] = Eigen::Vector3f (static_cast<float> (focal_x * (pt.x () / pt.z ()) + cx),
+                                        static_cast<float> (focal_y * (pt.y () / pt.z ()) + cy),
+                                        pt.z ());
+    else
+      projections[i].setConstant (std::numeric_limits<float>::quiet_NaN ());
+  }
 
-  for (int current_cam = 0; current_cam < static_cast<int> (cameras.size ()); ++current_cam)
+  // render the faces, each with the depth of its farthest vertex. A face then never occludes its own
+  // vertices, and a vertex is occluded only if a face lies entirely in front of it.
+  std::vector<float> depth_buffer (static_cast<std::size_t> (width) * height, std::numeric_limits<float>::max ());
+  for (const auto &face : faces)
   {
-    PCL_INFO ("Processing camera %d of %d.\n", current_cam+1, cameras.size ());
-    
-    // transform mesh into camera's frame
-    typename pcl::PointCloud<PointInT>::Ptr camera_cloud (new pcl::PointCloud<PointInT>);
-    pcl::transformPointCloud (*mesh_cloud, *camera_cloud, cameras[current_cam].pose.inverse ());
-
-    // CREATE UV MAP FOR CURRENT FACES
-    pcl::PointCloud<pcl::PointXY>::Ptr projections (new pcl::PointCloud<pcl::PointXY>);
-    std::vector<bool> visibility;
-    visibility.resize (mesh.tex_polygons[current_cam].size ());
-    std::vector<UvIndex> indexes_uv_to_points;
-    // for each current face
-
-    //TODO change this
-    pcl::PointXY nan_point;
-    nan_point.x = std::numeric_limits<float>::quiet_NaN ();
-    nan_point.y = std::numeric_limits<float>::quiet_NaN ();
-    UvIndex u_null;
-    u_null.idx_cloud = -1;
-    u_null.idx_face = -1;
-
-    int cpt_invisible=0;
-    for (int idx_face = 0; idx_face <  static_cast<int> (mesh.tex_polygons[current_cam].size ()); ++idx_face)
+    if (face.vertices.size () < 3)
+      continue;
+    const Eigen::Vector3f &p1 = projections[face.vertices[0]];
+    const Eigen::Vector3f &p2 = projections[face.vertices[1]];
+    const Eigen::Vector3f &p3 = projections[face.vertices[2]];
+    if (!(p1.z () > 0 && p2.z () > 0 && p3.z () > 0))
+      continue;
+
+    const float area = (p2.x () - p1.x ()) * (p3.y () - p1.y ()) - (p2.y () - p1.y ()) * (p3.x () - p1.x ());
+    if (!(area != 0.0f))
+      continue;
+    const float sign = (area > 0.0f) ? 1.0f : -1.0f;
+    const float depth = std::max (p1.z (), std::max (p2.z (), p3.z ()));
+
+    // pixels whose center lies in the bounding box of the triangle, clipped to the image
+    const float min_x = std::max (std::min (p1.x (), std::min (p2.x (), p3.x ())) - 0.5f, -1.0f);
+    const float max_x = std::min (std::max (p1.x (), std::max (p2.x (), p3.x ())) - 0.5f, static_cast<float> (width));
+    const float min_y = std::max (std::min (p1.y (), std::min (p2.y (), p3.y ())) - 0.5f, -1.0f);
+    const float max_y = std::min (std::max (p1.y (), std::max (p2.y (), p3.y ())) - 0.5f, static_cast<float> (height));
+    const int u_begin = std::max (static_cast<int> (std::ceil (min_x)), 0);
+    const int u_end = std::min (static_cast<int> (std::floor (max_x)), width - 1);
+    const int v_begin = std::max (static_cast<int> (std::ceil (min_y)), 0);
+    const int v_end = std::min (static_cast<int> (std::floor (max_y)), height - 1);
+
+    for (int v = v_begin; v <= v_end; ++v)
     {
-      //project each vertice, if one is out of view, stop
-      pcl::PointXY uv_coord1;
-      pcl::PointXY uv_coord2;
-      pcl::PointXY uv_coord3;
-
-      if (isFaceProjected (cameras[current_cam],
-                           (*camera_cloud)[mesh.tex_polygons[current_cam][idx_face].vertices[0]],
-                           (*camera_cloud)[mesh.tex_polygons[current_cam][idx_face].vertices[1]],
-                           (*camera_cloud)[mesh.tex_polygons[current_cam][idx_face].vertices[2]],
-                           uv_coord1,
-                           uv_coord2,
-                           uv_coord3))
-       {
-        // face is in the camera's FOV
-
-        // add UV coordinates
-        projections->points.push_back (uv_coord1);
-        projections->points.push_back (uv_coord2);
-        projections->points.push_back (uv_coord3);
-
-        // remember corresponding face
-        UvIndex u1, u2, u3;
-        u1.idx_cloud = mesh.tex_polygons[current_cam][idx_face].vertices[0];
-        u2.idx_cloud = mesh.tex_polygons[current_cam][idx_face].vertices[1];
-        u3.idx_cloud = mesh.tex_polygons[current_cam][idx_face].vertices[2];
-        u1.idx_face = idx_face; u2.idx_face = idx_face; u3.idx_face = idx_face;
-        indexes_uv_to_points.push_back (u1);
-        indexes_uv_to_points.push_back (u2);
-        indexes_uv_to_points.push_back (u3);
-
-        //keep track of visibility
-        visibility[idx_face] = true;
-      }
-      else
+      const float y = static_cast<float> (v) + 0.5f;
+      float *row = &depth_buffer[static_cast<std::size_t> (v) * width];
+      for (int u = u_begin; u <= u_end; ++u)
       {
-        projections->points.push_back (nan_point);
-        projections->points.push_back (nan_point);
-        projections->points.push_back (nan_point);
-        indexes_uv_to_points.push_back (u_null);
-        indexes_uv_to_points.push_back (u_null);
-        indexes_uv_to_points.push_back (u_null);
-        //keep track of visibility
-        visibility[idx_face] = false;
-        cpt_invisible++;
+        const float x = static_cast<float> (u) + 0.5f;
+        // edge functions, all of them have the sign of the area inside the triangle
+        const float e1 = sign * ((p2.x () - p1.x ()) * (y - p1.y ()) - (p2.y () - p1.y ()) * (x - p1.x ()));
+        const float e2 = sign * ((p3.x () - p2.x ()) * (y - p2.y ()) - (p3.y () - p2.y ()) * (x - p2.x ()));
+        const float e3 = sign * ((p1.x () - p3.x ()) * (y - p3.y ()) - (p1.y () - p3.y ()) * (x - p3.x ()));
+        if (e1 >= 0.0f && e2 >= 0.0f && e3 >= 0.0f && depth < row[u])
+          row[u] = depth;
       }
     }
+  }
 
-    // projections contains all UV points of the current faces
-    // indexes_uv_to_points links a uv point to its point in the camera cloud
-    // visibility contains tells if a face was in the camera FOV (false = skip)
-
-    // TODO handle case were no face could be projected
-    if (visibility.size () - cpt_invisible !=0)
+  // a face is visible if its vertices project onto the image and are not occluded
+  const float tolerance = 1.0f - occlusion_tolerance_;
+  for (std::size_t idx_face = 0; idx_face < faces.size (); ++idx_face)
+  {
+    if (faces[idx_face].vertices.size () < 3)
+      continue;
+    bool is_visible = true;
+    for (std::size_t k = 0; k < 3 && is_visible; ++k)
     {
-        //create kdtree
-        pcl::KdTreeFLANN<pcl::PointXY> kdtree;
-        kdtree.setInputCloud (projections);
-
-        pcl::Indices idxNeighbors;
-        std::vector<float> neighborsSquaredDistance;
-        // af first (idx_pcan < current_cam), check if some of the faces attached to previous cameras occlude the current faces
-        // then (idx_pcam == current_cam), check for self occlusions. At this stage, we skip faces that were already marked as occluded
-        cpt_invisible = 0;
-        for (int idx_pcam = 0 ; idx_pcam <= current_cam ; ++idx_pcam)
-        {
-          // project all faces
-          for (int idx_face = 0; idx_face <  static_cast<int> (mesh.tex_polygons[idx_pcam].size ()); ++idx_face)
-          {
-
-            if (idx_pcam == current_cam && !visibility[idx_face])
-            {
-              // we are now checking for self occlusions within the current faces
-              // the current face was already declared as occluded.
-              // therefore, it cannot occlude another face anymore => we skip it
-              continue;
-            }
-
-            // project each vertice, if one is out of view, stop
-            pcl::PointXY uv_coord1;
-            pcl::PointXY uv_coord2;
-            pcl::PointXY uv_coord3;
-
-            if (isFaceProjected (cameras[current_cam],
-                                 (*camera_cloud)[mesh.tex_polygons[idx_pcam][idx_face].vertices[0]],
-                                 (*camera_cloud)[mesh.tex_polygons[idx_pcam][idx_face].vertices[1]],
-                                 (*camera_cloud)[mesh.tex_polygons[idx_pcam][idx_face].vertices[2]],
-                                 uv_coord1,
-                                 uv_coord2,
-                                 uv_coord3))
-             {
-              // face is in the camera's FOV
-              //get its circumsribed circle
-              double radius;
-              pcl::PointXY center;
-              // getTriangleCircumcenterAndSize (uv_coord1, uv_coord2, uv_coord3, center, radius);
-              getTriangleCircumcscribedCircleCentroid(uv_coord1, uv_coord2, uv_coord3, center, radius); // this function yields faster results than getTriangleCircumcenterAndSize
-
-              // get points inside circ.circle
-              if (kdtree.radiusSearch (center, radius, idxNeighbors, neighborsSquaredDistance) > 0 )
-              {
-                // for each neighbor
-                for (const auto &idxNeighbor : idxNeighbors)
-                {
-                  if (std::max ((*camera_cloud)[mesh.tex_polygons[idx_pcam][idx_face].vertices[0]].z,
-                                std::max ((*camera_cloud)[mesh.tex_polygons[idx_pcam][idx_face].vertices[1]].z, 
-                                          (*camera_cloud)[mesh.tex_polygons[idx_pcam][idx_face].vertices[2]].z))
-                     < (*camera_cloud)[indexes_uv_to_points[idxNeighbor].idx_cloud].z)
-                  {
-                    // neighbor is farther than all the face's points. Check if it falls into the triangle
-                    if (checkPointInsideTriangle(uv_coord1, uv_coord2, uv_coord3, (*projections)[idxNeighbor]))
-                    {
-                      // current neighbor is inside triangle and is closer => the corresponding face
-                      visibility[indexes_uv_to_points[idxNeighbor].idx_face] = false;
-                      cpt_invisible++;
-                      //TODO we could remove the projections of this face from the kd-tree cloud, but I fond it slower, and I need the point to keep ordered to querry UV coordinates later
-                    }
-                  }
-                }
-              }
-             }
-          }
-        }
+      const Eigen::Vector3f &p = projections[faces[idx_face].vertices[k]];
+      if (!(p.z () > 0 && p.x () >= 0 && p.x () <= size_x && p.y () >= 0 && p.y () <= size_y))
+      {
+        is_visible = false;
+        break;
+      }
+      const int u = std::min (static_cast<int> (p.x ()), width - 1);
+      const int v = std::min (static_cast<int> (p.y ()), height - 1);
+      is_visible = (depth_buffer[static_cast<std::size_t> (v) * width + u] >= tolerance * p.z ());
     }
+    visible[idx_face] = is_visible;
+  }
+}
 
-    // now, visibility is true for each face that belongs to the current camera
-    // if a face is not visible, we push it into the next one.
+///////////////////////////////////////////////////////////////////////////////////////////////
+template<typename PointInT> void
+pcl::TextureMapping<PointInT>::textureMeshwithMultipleCameras (pcl::TextureMesh &mesh, const pcl::texture_mapping::CameraVector &cameras)
+{
+
+  if (mesh.tex_polygons.size () != 1)
+    return;
+
+  typename pcl::PointCloud<PointInT>::Ptr mesh_cloud (new pcl::PointCloud<PointInT>);
+
+  pcl::fromPCLPointCloud2 (mesh.cloud, *mesh_cloud);
+
+  // every face of the mesh can occlude the faces seen by a camera, regardless of the camera it is
+  // attached to. The visibility of the faces is therefore computed independently for each camera.
+  std::vector<pcl::Vertices> faces = mesh.tex_polygons[0];
+  std::vector<std::vector<std::uint8_t> > visibility (cameras.size ());
+
+  const pcl::ThreadReservation reservation (threads_);
+  const unsigned int threads = reservation.getNumberOfThreads ();
+#pragma omp parallel for \
+  default(none) \
+  shared(cameras, faces, mesh_cloud, visibility) \
+  num_threads(threads)
+  for (std::ptrdiff_t current_cam = 0; current_cam < static_cast<std::ptrdiff_t> (cameras.size ()); ++current_cam)
+    computeFaceVisibility (*mesh_cloud, faces, cameras[current_cam], visibility[current_cam]);
+
+  // each camera takes the visible faces which were not taken by a previous camera
+  std::vector<std::size_t> remaining_faces (faces.size ());
+  for (std::size_t idx_face = 0; idx_face < faces.size (); ++idx_face)
+    remaining_faces[idx_face] = idx_face;
+
+  for (std::size_t current_cam = 0; current_cam < cameras.size (); ++current_cam)
+  {
+    PCL_INFO ("Processing camera %d of %d.\n", current_cam+1, cameras.size ());
 
-    if (static_cast<int> (mesh.tex_coordinates.size ()) <= current_cam)
+    if (mesh.tex_coordinates.size () <= current_cam)
     {
       std::vector<Eigen::Vector2f, Eigen::aligned_allocator<Eigen::Vector2f> > dummy_container;
       mesh.tex_coordinates.push_back (dummy_container);
     }
-    mesh.tex_coordinates[current_cam].resize (3 * visibility.size ());
+    auto &tex_coordinates = mesh.tex_coordinates[current_cam];
+    tex_coordinates.clear ();
 
-    std::vector<pcl::Vertices> occluded_faces;
-    occluded_faces.resize (visibility.size ());
+    const Eigen::Affine3f pose_inverse = cameras[current_cam].pose.inverse ();
     std::vector<pcl::Vertices> visible_faces;
-    visible_faces.resize (visibility.size ());
-
-    int cpt_occluded_faces = 0;
-    int cpt_visible_faces = 0;
-
-    for (std::size_t idx_face = 0 ; idx_face < visibility.size () ; ++idx_face)
+    std::vector<pcl::Vertices> occluded_faces;
+    std::vector<std::size_t> occluded_indices;
+    for (const auto &idx_face : remaining_faces)
     {
-      if (visibility[idx_face])
+      if (visibility[current_cam][idx_face])
       {
-        // face is visible by the current camera copy UV coordinates
-        mesh.tex_coordinates[current_cam][cpt_visible_faces * 3](0) = (*projections)[idx_face*3].x;
-        mesh.tex_coordinates[current_cam][cpt_visible_faces * 3](1) = (*projections)[idx_face*3].y;
-
-        mesh.tex_coordinates[current_cam][cpt_visible_faces * 3 + 1](0) = (*projections)[idx_face*3 + 1].x;
-        mesh.tex_coordinates[current_cam][cpt_visible_faces * 3 + 1](1) = (*projections)[idx_face*3 + 1].y;
-
-        mesh.tex_coordinates[current_cam][cpt_visible_faces * 3 + 2](0) = (*projections)[idx_face*3 + 2].x;
-        mesh.tex_coordinates[current_cam][cpt_visible_faces * 3 + 2](1) = (*projections)[idx_face*3 + 2].y;
-
-        visible_faces[cpt_visible_faces] = mesh.tex_polygons[current_cam][idx_face];
-
-        cpt_visible_faces++;
+        // face is visible by the current camera, add the UV coordinates of its vertices
+        for (std::size_t k = 0; k < 3; ++k)
+        {
+          PointInT pt = (*mesh_cloud)[faces[idx_face].vertices[k]];
+          pt.getVector3fMap () = pose_inverse * pt.getVector3fMap ();
+          pcl::PointXY uv_coord;
+          getPointUVCoordinates (pt, cameras[current_cam], uv_coord);
+          tex_coordinates.emplace_back (uv_coord.x, uv_coord.y);
+        }
+        visible_faces.push_back (faces[idx_face]);
       }
       else
       {
-        // face is occluded copy face into temp vector
-        occluded_faces[cpt_occluded_faces] = mesh.tex_polygons[current_cam][idx_face];
-        cpt_occluded_faces++;
+        occluded_faces.push_back (faces[idx_face]);
+        occluded_indices.push_back (idx_face);
       }
     }
-    mesh.tex_coordinates[current_cam].resize (cpt_visible_faces*3);
 
-    occluded_faces.resize (cpt_occluded_faces);
-    mesh.tex_polygons.push_back (occluded_faces);
-
-    visible_faces.resize (cpt_visible_faces);
-    mesh.tex_polygons[current_cam].clear ();
     mesh.tex_polygons[current_cam] = visible_faces;
+    mesh.tex_polygons.push_back (occluded_faces);
+    remaining_faces.swap (occluded_indices);
   }
 
   // we have been through all the cameras.
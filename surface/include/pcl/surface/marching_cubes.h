@@ -39,6 +39,10 @@
 #include <pcl/pcl_macros.h>
 #include <pcl/surface/reconstruction.h>
 
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
 namespace pcl
 {
   /*
@@ -356,6 +360,11 @@ namespace pcl
     * Lorensen W.E., Cline H.E., "Marching cubes: A high resolution 3d surface construction algorithm",
     * SIGGRAPH '87
     *
+    * By default the scalar field is evaluated on a dense res_x * res_y * res_z grid and the output is a
+    * triangle soup (three distinct points per triangle). With setSparseGrid (), only blocks of
+    * 8^3 voxels near the input points are stored and evaluated, and the triangles share
+    * their vertices along the voxel edges. Both modes use setNumberOfThreads () threads.
+    *
     * \author Alexandru E. Ichim
     * \ingroup surface
     */
@@ -433,7 +442,39 @@ namespace pcl
       getPercentageExtendGrid ()
       { return percentage_extend_grid_; }
 
+      /** \brief Set whether only the grid blocks near the input points should be stored and evaluated.
+        * \details A block of 8^3 voxels is active if it lies within the given margin of the voxel
+        * of an input point, the other voxels have no value and produce no triangles. This bounds the memory
+        * by the size of the surface instead of the volume of the grid, and produces an indexed mesh with
+        * the vertices shared by adjacent triangles.
+        * \param[in] sparse_grid true to use the sparse grid (default false)
+        * \param[in] margin the distance, in voxels, around the input points where the field is evaluated
+        * \note The sparse grid requires voxelizeData () to fill the grid through evaluateGrid ().
+        */
+      inline void
+      setSparseGrid (bool sparse_grid, int margin = 2)
+      { sparse_grid_ = sparse_grid; sparse_margin_ = margin; }
+
+      /** \brief Get whether only the grid blocks near the input points are stored and evaluated. */
+      inline bool
+      getSparseGrid () const
+      { return sparse_grid_; }
+
+      /** \brief Set the number of threads used to evaluate the grid and extract the triangles.
+        * \param[in] nr_threads the number of hardware threads to use (0 takes as many as the budget of pcl::ExecutionContext allows when reconstructing)
+        */
+      void
+      setNumberOfThreads (unsigned int nr_threads = 0);
+
+      /** \brief Get the number of threads used to evaluate the grid and extract the triangles. */
+      inline unsigned int
+      getNumberOfThreads () const
+      { return threads_; }
+
     protected:
+      /** \brief Edge length, in voxels, of the blocks of the sparse grid. */
+      static const int block_size_ = 8;
+
       /** \brief The data structure storing the 3D grid */
       std::vector<float> grid_;
 
@@ -454,6 +495,53 @@ namespace pcl
       /** \brief The iso level to be extracted. */
       float iso_level_;
 
+      /** \brief Whether only the blocks near the input points are stored, see setSparseGrid (). */
+      bool sparse_grid_ = false;
+
+      /** \brief Margin, in voxels, around the input points where the sparse grid is evaluated. */
+      int sparse_margin_ = 2;
+
+      /** \brief The number of threads the scheduler should use. */
+      unsigned int threads_ = 1;
+
+      /** \brief Block coordinates of the active blocks of the sparse grid, sorted by key. The values of
+        * block i are stored in grid_ from i * block_size_^3, with z varying fastest.
+        */
+      std::vector<Eigen::Vector3i> blocks_;
+
+      /** \brief Position of each active block in blocks_, indexed by getBlockKey (). */
+      std::unordered_map<std::uint64_t, int> block_lookup_;
+
+      /** \brief Evaluate the scalar field on all the voxels of the grid (or of its active blocks), in parallel.
+        * \param[in] function called with the position of a voxel, returns its value or NaN if unknown. It is
+        * called concurrently from several threads.
+        */
+      template <typename Function> void
+      evaluateGrid (const Function &function);
+
+      /** \brief Get the key of a block of the sparse grid from its block coordinates. */
+      inline std::uint64_t
+      getBlockKey (const Eigen::Vector3i &block) const
+      {
+        const std::uint64_t nr_blocks_y = (res_y_ + block_size_ - 1) / block_size_;
+        const std::uint64_t nr_blocks_z = (res_z_ + block_size_ - 1) / block_size_;
+        return ((static_cast<std::uint64_t> (block[0]) * nr_blocks_y + block[1]) * nr_blocks_z + block[2]);
+      }
+
+      /** \brief Activate the blocks of the sparse grid near the input points and allocate their values. */
+      void
+      activateBlocks ();
+
+      /** \brief Extract the triangles of the dense grid, in parallel over x slabs. */
+      void
+      extractDense (pcl::PointCloud<PointNT> &points);
+
+      /** \brief Extract the triangles of the sparse grid in parallel over the blocks, sharing the
+        * vertices on the voxel edges.
+        */
+      void
+      extractSparse (pcl::PointCloud<PointNT> &points, std::vector<pcl::Vertices> &polygons);
+
       /** \brief Convert the point cloud into voxel data. 
         */
       virtual void
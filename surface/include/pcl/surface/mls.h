@@ -39,9 +39,11 @@
 
 #pragma once
 
+#include <algorithm>
 #include <functional>
 #include <map>
 #include <random>
+#include <vector>
 #include <Eigen/Core> // for Vector3i, Vector3d, ...
 
 // PCL includes
@@ -242,6 +244,75 @@ namespace pcl
       inline
       double computeMLSWeight (const double sq_dist, const double sq_mls_radius) { return (std::exp (-sq_dist / sq_mls_radius)); }
 
+      /** \brief Fit the polynomial to the neighborhood by accumulating the normal equations of the weighted
+        * least-squares problem point by point, without temporary allocations for fixed sizes.
+        * \param[in] cloud the input cloud
+        * \param[in] nn_indices the neighbors of the query point
+        * \param[in] weight_func the weight of a neighbor given its squared distance to mean
+        * \tparam NrCoeff the number of polynomial coefficients, or Eigen::Dynamic
+        */
+      template <int NrCoeff, typename PointT, typename WeightFunc> void
+      fitPolynomial (const pcl::PointCloud<PointT> &cloud,
+                     const pcl::Indices &nn_indices,
+                     const WeightFunc &weight_func);
+  };
+
+  /** \brief Radius search results of the points of a cloud, which can be shared between several
+    * MovingLeastSquares runs on the same input cloud and search radius (e.g. with different
+    * polynomial orders or upsampling methods) to search each neighborhood only once.
+    * \note The cache is tied to the address of the input cloud and the search radius, and is
+    * rebuilt when either changes. Call clear () if the points of the cloud are modified in place.
+    * \ingroup surface
+    */
+  class MLSNeighborhoodCache
+  {
+    public:
+      using Ptr = shared_ptr<MLSNeighborhoodCache>;
+      using ConstPtr = shared_ptr<const MLSNeighborhoodCache>;
+
+      /** \brief Drop all the cached neighborhoods. */
+      inline void
+      clear ()
+      {
+        cloud_ = nullptr;
+        search_radius_ = 0.0;
+        neighbors_.clear ();
+        computed_.clear ();
+      }
+
+      /** \brief Get the number of cached neighborhoods. */
+      inline std::size_t
+      size () const
+      {
+        return (static_cast<std::size_t> (std::count (computed_.begin (), computed_.end (), 1)));
+      }
+
+    private:
+      template <typename PointInT, typename PointOutT> friend class MovingLeastSquares;
+
+      /** \brief Make the cache valid for the given cloud and radius, dropping its content if it was built for other ones. */
+      inline void
+      prepare (const void *cloud, std::size_t cloud_size, double search_radius)
+      {
+        if (cloud_ == cloud && search_radius_ == search_radius && neighbors_.size () == cloud_size)
+          return;
+        cloud_ = cloud;
+        search_radius_ = search_radius;
+        neighbors_.assign (cloud_size, pcl::Indices ());
+        computed_.assign (cloud_size, 0);
+      }
+
+      /** \brief The cloud the neighborhoods were computed for, only used for identification. */
+      const void *cloud_ = nullptr;
+
+      /** \brief The search radius the neighborhoods were computed with. */
+      double search_radius_ = 0.0;
+
+      /** \brief The neighbors of each point of the cloud. */
+      std::vector<pcl::Indices> neighbors_;
+
+      /** \brief Whether the neighbors of each point have been computed, search failures included. */
+      std::vector<unsigned char> computed_;
   };
 
   /** \brief MovingLeastSquares represent an implementation of the MLS (Moving Least Squares) algorithm
@@ -252,8 +323,8 @@ namespace pcl
     * www.sci.utah.edu/~shachar/Publications/crpss.pdf
     * \note There is a parallelized version of the processing step, using the OpenMP standard.
     * Compared to the standard version, an overhead is incurred in terms of runtime and memory usage.
-    * The upsampling methods DISTINCT_CLOUD and VOXEL_GRID_DILATION are not parallelized completely,
-    * i.e. parts of the algorithm run on a single thread only.
+    * The upsampling methods DISTINCT_CLOUD and VOXEL_GRID_DILATION project their samples in parallel,
+    * the voxel grid dilation itself runs on a single thread only.
     * \author Zoltan Csaba Marton, Radu B. Rusu, Alexandru E. Ichim, Suat Gedikli, Robert Huitl
     * \ingroup surface
     */
@@ -499,6 +570,19 @@ namespace pcl
       inline const std::vector<MLSResult>&
       getMLSResults () const { return (mls_results_); }
 
+      /** \brief Set a cache storing the neighborhood of every processed point, reused by the following
+        * calls to process () with the same input cloud and search radius, possibly from other instances.
+        * \param[in] cache the cache to use, or nullptr (default) to search the neighborhoods on every call
+        * \note The cache holds all the neighbor indices, i.e. about 4 bytes per neighbor and point.
+        * \note The indices given with setIndices () must be unique.
+        */
+      inline void
+      setNeighborhoodCache (const MLSNeighborhoodCache::Ptr &cache) { neighborhood_cache_ = cache; }
+
+      /** \brief Get the cache storing the neighborhoods of the processed points. */
+      inline MLSNeighborhoodCache::Ptr
+      getNeighborhoodCache () const { return (neighborhood_cache_); }
+
       /** \brief Set the maximum number of threads to use
       * \param threads the maximum number of hardware threads to use (0 sets the value to 1)
       */
@@ -579,6 +663,9 @@ namespace pcl
       /** \brief The maximum number of threads the scheduler should use. */
       unsigned int threads_;
 
+      /** \brief Optional cache of the neighborhoods of the input points. */
+      MLSNeighborhoodCache::Ptr neighborhood_cache_;
+
 
       /** \brief A minimalistic implementation of a voxel grid, necessary for the point cloud upsampling
         * \note Used only in the case of VOXEL_GRID_DILATION upsampling
@@ -235,6 +235,26 @@ namespace pcl
         m_solver.setQuiet (val);
       }
 
+      /** \brief Set the number of threads used to assemble and solve the system of equations.
+       * The point-to-surface constraints of the interior points are assembled concurrently
+       * unless a single thread is set.
+       * \param[in] nr_threads the number of hardware threads to use (0 takes as many as the budget of
+       * pcl::ExecutionContext allows when assembling and solving)
+       */
+      inline void
+      setNumberOfThreads (unsigned nr_threads = 0)
+      {
+        m_solver.setNumberOfThreads (nr_threads);
+        m_threads = m_solver.getNumberOfThreads ();
+      }
+
+      /** \brief Get the number of threads used to assemble and solve the system of equations. */
+      inline unsigned
+      getNumberOfThreads () const
+      {
+        return m_threads;
+      }
+
     protected:
 
       /** \brief Initialisation of member variables */
@@ -245,6 +265,11 @@ namespace pcl
       virtual void
       assembleInterior (double wInt, unsigned &row);
 
+      /** \brief Assemble point-to-surface constraints for interior points concurrently,
+       * used by assembleInterior unless a single thread is set. */
+      void
+      assembleInteriorParallel (double wInt, unsigned &row);
+
       /** \brief Assemble point-to-surface constraints for boundary points. */
       virtual void
       assembleBoundary (double wBnd, unsigned &row);
@@ -277,6 +302,7 @@ namespace pcl
       NurbsSolve m_solver;
 
       bool m_quiet;
+      unsigned m_threads;
 
       std::vector<double> m_elementsU;
       std::vector<double> m_elementsV;
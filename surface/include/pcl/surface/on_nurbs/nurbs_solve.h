@@ -42,6 +42,10 @@
 #include <pcl/pcl_macros.h>
 #include <pcl/surface/on_nurbs/sparse_mat.h>
 
+#include <Eigen/SparseCore>
+
+#include <vector>
+
 namespace pcl
 {
   namespace on_nurbs
@@ -54,7 +58,7 @@ namespace pcl
     public:
       /** \brief Empty constructor */
       NurbsSolve () :
-        m_quiet (true)
+        m_quiet (true), m_threads (1)
       {
       }
 
@@ -72,6 +76,11 @@ namespace pcl
       void
       f (unsigned i, unsigned j, double v);
 
+      /** \brief Set a batch of values for system matrix K (e.g. assembled concurrently).
+       *  Entries are applied in order, i.e. a later entry overwrites an earlier one at the same (i,j). */
+      void
+      K (const std::vector<Eigen::Triplet<double> > &entries);
+
       /** \brief Get value for system matrix K (stiffness matrix, basis functions) */
       double
       K (unsigned i, unsigned j);
@@ -97,7 +106,9 @@ namespace pcl
       printF ();
 
       /** \brief Solves the system of equations with respect to x.
-       *  - Using UmfPack incredibly speeds up this function.      */
+       *  - Using UmfPack incredibly speeds up this function.
+       *  - The Eigen backend solves the sparse normal equations (K^T K) x = K^T f, assembling them
+       *    with the number of threads given by setNumberOfThreads.      */
       bool
       solve ();
 
@@ -112,6 +123,24 @@ namespace pcl
         m_quiet = val;
       }
 
+      /** \brief Set the number of threads used for solving the system of equations.
+       * \param[in] nr_threads the number of hardware threads to use (0 takes as many as the budget of
+       * pcl::ExecutionContext allows when solving)
+       */
+      inline void
+      setNumberOfThreads (unsigned nr_threads = 0)
+      {
+        // 0 is resolved against the budget of pcl::ExecutionContext at compute time
+        m_threads = nr_threads;
+      }
+
+      /** \brief Get the number of threads used for solving the system of equations. */
+      inline unsigned
+      getNumberOfThreads () const
+      {
+        return m_threads;
+      }
+
       /** \brief get size of system */
       inline void
       getSize (unsigned &rows, unsigned &cols, unsigned &dims)
@@ -123,8 +152,9 @@ namespace pcl
 
     private:
       bool m_quiet;
+      unsigned m_threads;
       SparseMat m_Ksparse;
-      Eigen::MatrixXd m_Keig;
+      std::vector<Eigen::Triplet<double> > m_Ktriplets;
       Eigen::MatrixXd m_xeig;
       Eigen::MatrixXd m_feig;
 
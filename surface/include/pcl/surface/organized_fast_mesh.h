@@ -43,6 +43,9 @@
 #include <pcl/common/angles.h>
 #include <pcl/common/point_tests.h> // for pcl::isFinite
 #include <pcl/surface/reconstruction.h>
+#include <pcl/PolygonMeshBuffer.h>
+
+#include <cstdint>
 
 
 namespace pcl
@@ -71,6 +74,7 @@ namespace pcl
 
       using MeshConstruction<PointInT>::input_;
       using MeshConstruction<PointInT>::check_tree_;
+      using MeshConstruction<PointInT>::reconstruct;
 
       using PointCloudPtr = typename pcl::PointCloud<PointInT>::Ptr;
 
@@ -100,6 +104,7 @@ namespace pcl
       , distance_tolerance_ (-1.0f)
       , distance_dependent_ (false)
       , use_depth_as_distance_(false)
+      , threads_ (1)
       {
         check_tree_ = false;
       };
@@ -229,7 +234,50 @@ namespace pcl
         use_depth_as_distance_ = enable;
       }
 
+      /** \brief Set the number of threads used by reconstruct (std::vector<std::uint32_t> &).
+        * \param[in] nr_threads the number of hardware threads to use (0 takes as many as the budget of pcl::ExecutionContext allows when meshing)
+        */
+      void
+      setNumberOfThreads (unsigned int nr_threads = 0);
+
+      /** \brief Get the number of threads used by reconstruct (std::vector<std::uint32_t> &). */
+      inline unsigned int
+      getNumberOfThreads () const { return (threads_); }
+
+      /** \brief Get the number of vertices of each polygon: 4 for \a QUAD_MESH, 3 for the triangle meshes. */
+      inline unsigned int
+      getVerticesPerPolygon () const { return (triangulation_type_ == QUAD_MESH ? 4 : 3); }
+
+      /** \brief Create the mesh as a flat buffer of point indices, e.g. for uploading it to a GPU index buffer.
+        * \details Each polygon takes getVerticesPerPolygon () consecutive indices into the input cloud. The image is
+        * split into bands of rows which are meshed in parallel, see setNumberOfThreads (), and the polygons are in
+        * the same order as in the other outputs. Use indicesToPolygons () to convert the buffer when needed.
+        * \param[out] indices the point indices of the polygons
+        */
+      void
+      reconstruct (std::vector<std::uint32_t> &indices);
+
+      /** \brief Convert a flat index buffer, as created by reconstruct (std::vector<std::uint32_t> &), to polygons.
+        * \param[in] indices the point indices of the polygons
+        * \param[in] vertices_per_polygon the number of indices of each polygon, see getVerticesPerPolygon ()
+        * \param[out] polygons the resultant polygons
+        */
+      /** \brief Create the mesh as a pcl::PolygonMeshBuffer, with the polygons of
+        * reconstruct (std::vector<std::uint32_t> &), which are moved into the buffer without copying them.
+        * \details As for the pcl::PolygonMesh output, the coordinates of the invalid points of the cloud are set to 0.
+        * \param[out] output the resultant mesh
+        */
+      void
+      reconstruct (pcl::PolygonMeshBuffer &output);
+
+      static void
+      indicesToPolygons (const std::vector<std::uint32_t> &indices, unsigned int vertices_per_polygon,
+                         std::vector<pcl::Vertices> &polygons);
+
     protected:
+      using MeshConstruction<PointInT>::initCompute;
+      using MeshConstruction<PointInT>::deinitCompute;
+
       /** \brief max length of edge, scalar component */
       float max_edge_length_a_;
       /** \brief max length of edge, scalar component */
@@ -270,6 +318,58 @@ namespace pcl
           This flag may be set using useDepthAsDistance(true) for (RGB-)Depth cameras to skip computations and gain additional speed up. */
       bool use_depth_as_distance_;
 
+      /** \brief The number of threads the scheduler should use. */
+      unsigned int threads_;
+
+      /** \brief Index buffers of the row bands, kept between calls to avoid reallocating them for every frame. */
+      std::vector<std::vector<std::uint32_t> > band_indices_;
+
+      /** \brief Appends the polygons to a list of pcl::Vertices, see addTriangle () and addQuad (). */
+      struct PolygonSink
+      {
+        OrganizedFastMesh &mesh;
+        std::vector<pcl::Vertices> &polygons;
+        int idx;
+
+        inline void
+        triangle (int a, int b, int c) { mesh.addTriangle (a, b, c, idx++, polygons); }
+
+        inline void
+        quad (int a, int b, int c, int d) { mesh.addQuad (a, b, c, d, idx++, polygons); }
+      };
+
+      /** \brief Appends the polygons to a flat index buffer. */
+      struct IndexSink
+      {
+        std::vector<std::uint32_t> &indices;
+
+        inline void
+        triangle (int a, int b, int c)
+        {
+          indices.push_back (a);
+          indices.push_back (b);
+          indices.push_back (c);
+        }
+
+        inline void
+        quad (int a, int b, int c, int d)
+        {
+          indices.push_back (a);
+          indices.push_back (b);
+          indices.push_back (c);
+          indices.push_back (d);
+        }
+      };
+
+      /** \brief Mesh the cells whose upper left corner lies in the rows [first_row, end_row).
+        * \param[in] type the triangulation scheme
+        * \param[in] first_row the first row, a multiple of the row step
+        * \param[in] end_row one past the last row
+        * \param[in,out] sink receives the polygons, see PolygonSink and IndexSink
+        */
+      template <typename Sink> void
+      makeMeshRows (TriangulationType type, int first_row, int end_row, Sink &sink);
+
 
       /** \brief Perform the actual polygonal reconstruction.
         * \param[out] polygons the resultant polygons
@@ -340,11 +440,26 @@ namespace pcl
       inline void
       resetPointData (const int &point_index, pcl::PolygonMesh &mesh, const float &value = 0.0f,
                       int field_x_idx = 0, int field_y_idx = 1, int field_z_idx = 2)
+      {
+        resetPointData (point_index, mesh.cloud, value, field_x_idx, field_y_idx, field_z_idx);
+      }
+
+      /** \brief Set (all) coordinates of a particular point to the specified value
+        * \param[in] point_index index of point
+        * \param[out] cloud the cloud to modify
+        * \param[in] value value to use when re-setting
+        * \param[in] field_x_idx the X coordinate of the point
+        * \param[in] field_y_idx the Y coordinate of the point
+        * \param[in] field_z_idx the Z coordinate of the point
+        */
+      inline void
+      resetPointData (const int &point_index, pcl::PCLPointCloud2 &cloud, const float &value = 0.0f,
+                      int field_x_idx = 0, int field_y_idx = 1, int field_z_idx = 2)
       {
         float new_value = value;
-        memcpy (&mesh.cloud.data[point_index * mesh.cloud.point_step + mesh.cloud.fields[field_x_idx].offset], &new_value, sizeof (float));
-        memcpy (&mesh.cloud.data[point_index * mesh.cloud.point_step + mesh.cloud.fields[field_y_idx].offset], &new_value, sizeof (float));
-        memcpy (&mesh.cloud.data[point_index * mesh.cloud.point_step + mesh.cloud.fields[field_z_idx].offset], &new_value, sizeof (float));
+        memcpy (&cloud.data[point_index * cloud.point_step + cloud.fields[field_x_idx].offset], &new_value, sizeof (float));
+        memcpy (&cloud.data[point_index * cloud.point_step + cloud.fields[field_y_idx].offset], &new_value, sizeof (float));
+        memcpy (&cloud.data[point_index * cloud.point_step + cloud.fields[field_z_idx].offset], &new_value, sizeof (float));
       }
 
       /** \brief Check if a point is shadowed by another point
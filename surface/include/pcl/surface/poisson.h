@@ -45,7 +45,7 @@ namespace pcl
 {
   namespace poisson
   {
-    class CoredVectorMeshData;
+    class CoredMeshData;
     template <class Real> struct Point3D;
   }
 
@@ -66,6 +66,7 @@ namespace pcl
 
       using SurfaceReconstruction<PointNT>::input_;
       using SurfaceReconstruction<PointNT>::tree_;
+      using SurfaceReconstruction<PointNT>::reconstruct;
 
       using PointCloudPtr = typename pcl::PointCloud<PointNT>::Ptr;
 
@@ -92,6 +93,16 @@ namespace pcl
       performReconstruction (pcl::PointCloud<PointNT> &points,
                              std::vector<pcl::Vertices> &polygons) override;
 
+      /** \brief Create the surface and write it to a binary PLY file instead of a PolygonMesh.
+        * \details While the iso-surface is extracted, the polygons and the vertices which are not shared between
+        * the blocks of the extractor (see setIsoDivide ()) are streamed to temporary files. The PLY file is then
+        * written from these, so the mesh is never held in memory as a whole.
+        * \param[in] file_name the name of the PLY file to write
+        * \return true if the file was written successfully
+        */
+      bool
+      reconstruct (const std::string &file_name);
+
       /** \brief Set the maximum depth of the tree that will be used for surface reconstruction.
         * \note Running at depth d corresponds to solving on a voxel grid whose resolution is no larger than
         * 2^d x 2^d x 2^d. Note that since the reconstructor adapts the octree to the sampling density, the specified
@@ -217,7 +228,8 @@ namespace pcl
       getManifold () { return manifold_; }
 
       /** \brief Set the number of threads to use.
-       * \param[in] threads the number of threads
+       * \param[in] threads the number of threads (0 takes as many as the budget of pcl::ExecutionContext allows
+       * when reconstructing)
        */
       void
       setThreads(int threads);
@@ -230,7 +242,24 @@ namespace pcl
         return threads_;
       }
 
+      /** \brief Set an upper bound on the memory used by the solver and the iso-surface extractor.
+        * \details The memory needed at the requested depth is estimated from the size of the octree once it is
+        * built. While the estimate is over the limit, the octree is rebuilt one level shallower, down to the minimum
+        * depth (see setMinDepth ()).
+        * \param[in] max_memory the memory limit in bytes, 0 for no limit (default)
+        * \note The octree itself is built before it can be measured, and temporarily needs memory above the limit.
+        */
+      inline void
+      setMaxMemory (std::size_t max_memory) { max_memory_ = max_memory; }
+
+      /** \brief Get the memory limit in bytes (0 if there is none). */
+      inline std::size_t
+      getMaxMemory () const { return max_memory_; }
+
     protected:
+      using SurfaceReconstruction<PointNT>::initCompute;
+      using SurfaceReconstruction<PointNT>::deinitCompute;
+
       /** \brief Class get name method. */
       std::string
       getClassName () const override { return ("Poisson"); }
@@ -258,9 +287,18 @@ namespace pcl
       int min_iterations_;
       float solver_accuracy_;
       int threads_;
+      std::size_t max_memory_;
+
+      /** \brief Run the reconstruction with the configured degree, see setDegree ().
+        * \return false if the degree is not supported
+        */
+      bool
+      computeMesh (poisson::CoredMeshData &mesh,
+                   poisson::Point3D<float> &translate,
+                   float &scale);
 
       template<int Degree> void
-      execute (poisson::CoredVectorMeshData &mesh,
+      execute (poisson::CoredMeshData &mesh,
                poisson::Point3D<float> &translate,
                float &scale);
 
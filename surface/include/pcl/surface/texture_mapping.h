@@ -46,6 +46,9 @@
 #include <pcl/TextureMesh.h>
 #include <pcl/octree/octree_search.h> // for OctreePointCloudSearch
 
+#include <cstdint>
+#include <vector>
+
 
 namespace pcl
 {
@@ -117,7 +120,7 @@ namespace pcl
 
       /** \brief Constructor. */
       TextureMapping () :
-        f_ ()
+        f_ (), occlusion_tolerance_ (0.01f), threads_ (1)
       {
       }
 
@@ -166,6 +169,38 @@ namespace pcl
         tex_material_ = tex_material;
       }
 
+      /** \brief Set the relative depth tolerance of the occlusion tests of textureMeshwithMultipleCameras ().
+        * \details A vertex is considered occluded only if a face lies in front of it by more than
+        * tolerance * depth of the vertex. Default: 0.01
+        * \param[in] tolerance the relative depth tolerance
+        */
+      inline void
+      setOcclusionTolerance (float tolerance)
+      {
+        occlusion_tolerance_ = tolerance;
+      }
+
+      /** \brief Get the relative depth tolerance of the occlusion tests. */
+      inline float
+      getOcclusionTolerance () const
+      {
+        return (occlusion_tolerance_);
+      }
+
+      /** \brief Set the number of threads used to render the cameras in textureMeshwithMultipleCameras ().
+        * \param[in] nr_threads the number of hardware threads to use (0 takes as many as the budget of
+        * pcl::ExecutionContext allows when texturing)
+        */
+      void
+      setNumberOfThreads (unsigned int nr_threads = 0);
+
+      /** \brief Get the number of threads used to render the cameras. */
+      inline unsigned int
+      getNumberOfThreads () const
+      {
+        return (threads_);
+      }
+
       /** \brief Map texture to a mesh synthesis algorithm
         * \param[in] tex_mesh texture mesh
         */
@@ -327,7 +362,9 @@ namespace pcl
 
       /** \brief Segment and texture faces by camera visibility. Face-based segmentation.
         * \details With N camera, faces will be arranged into N+1 groups: 1 for each camera, plus 1 for faces not visible from any camera.
-        * The mesh will also contain uv coordinates for each face
+        * The mesh will also contain uv coordinates for each face.
+        * The occlusions are found by rendering the whole mesh into a depth buffer of each camera, see
+        * setOcclusionTolerance (). The cameras are rendered in parallel, see setNumberOfThreads ().
         * \param mesh input mesh that needs sorting. Should contain only 1 sub-mesh.
         * \param[in] cameras vector containing the cameras used for texture mapping.
         */
@@ -348,6 +385,12 @@ namespace pcl
       /** \brief list of texture materials */
       TexMaterial tex_material_;
 
+      /** \brief relative depth tolerance of the occlusion tests */
+      float occlusion_tolerance_;
+
+      /** \brief number of threads used to render the cameras */
+      unsigned int threads_;
+
       /** \brief Map texture to a face
         * \param[in] p1 the first point
         * \param[in] p2 the second point
@@ -403,6 +446,18 @@ namespace pcl
                        const PointInT &p1, const PointInT &p2, const PointInT &p3, 
                        pcl::PointXY &proj1, pcl::PointXY &proj2, pcl::PointXY &proj3);
 
+      /** \brief Computes which faces of a mesh are visible by one particular camera.
+        * \details All the faces are rendered into a depth buffer of the camera, each with the depth of its farthest
+        * vertex. A face is visible if its first three vertices project onto the image and no face lies in front of them.
+        * \param[in] cloud the vertices of the mesh, in world coordinates.
+        * \param[in] faces the faces of the mesh (triangles).
+        * \param[in] camera the camera.
+        * \param[out] visible resulting visibility, one entry per face (1 = visible).
+        */
+      void
+      computeFaceVisibility (const PointCloud &cloud, const std::vector<pcl::Vertices> &faces,
+                             const Camera &camera, std::vector<std::uint8_t> &visible) const;
+
       /** \brief Returns True if a point lays within a triangle
         * \details see http://www.blackpawn.com/texts/pointinpoly/default.html
         * \param[in] p1 first point of the triangle.
@@ -27,6 +27,8 @@ DAMAGE.
 */
 #include <pcl/surface/3rdparty/poisson4/geometry.h>
 
+#include <cstdio>
+
 ///////////////////
 // CoredMeshData //
 ///////////////////
@@ -123,5 +125,53 @@ namespace pcl
     int CoredVectorMeshData2::outOfCorePointCount(void){return int(oocPoints.size());}
     int CoredVectorMeshData2::polygonCount( void ) { return int( polygons.size() ); }
 
+    ///////////////////////
+    // CoredFileMeshData //
+    ///////////////////////
+    CoredFileMeshData::CoredFileMeshData( void )
+    {
+      oocPoints = polygons = 0;
+      oocPointFile = std::tmpfile();
+      polygonFile = std::tmpfile();
+    }
+    CoredFileMeshData::~CoredFileMeshData( void )
+    {
+      if( oocPointFile ) std::fclose( oocPointFile );
+      if( polygonFile ) std::fclose( polygonFile );
+    }
+    void CoredFileMeshData::resetIterator( void )
+    {
+      if( oocPointFile ) std::rewind( oocPointFile );
+      if( polygonFile ) std::rewind( polygonFile );
+    }
+    int CoredFileMeshData::addOutOfCorePoint( const Point3D<float>& p )
+    {
+      if( !oocPointFile || std::fwrite( &p , sizeof( Point3D<float> ) , 1 , oocPointFile )!=1 ) return -1;
+      return oocPoints++;
+    }
+    int CoredFileMeshData::addPolygon( const std::vector< CoredVertexIndex >& vertices )
+    {
+      int vSize = int( vertices.size() );
+      if( !polygonFile ||
+          std::fwrite( &vSize , sizeof( int ) , 1 , polygonFile )!=1 ||
+          std::fwrite( vertices.data() , sizeof( CoredVertexIndex ) , vSize , polygonFile )!=std::size_t( vSize ) ) return -1;
+      return polygons++;
+    }
+    int CoredFileMeshData::nextOutOfCorePoint( Point3D<float>& p )
+    {
+      if( oocPointFile && std::fread( &p , sizeof( Point3D<float> ) , 1 , oocPointFile )==1 ) return 1;
+      else return 0;
+    }
+    int CoredFileMeshData::nextPolygon( std::vector< CoredVertexIndex >& vertices )
+    {
+      int vSize;
+      if( !polygonFile || std::fread( &vSize , sizeof( int ) , 1 , polygonFile )!=1 ) return 0;
+      vertices.resize( vSize );
+      if( std::fread( vertices.data() , sizeof( CoredVertexIndex ) , vSize , polygonFile )!=std::size_t( vSize ) ) return 0;
+      return 1;
+    }
+    int CoredFileMeshData::outOfCorePointCount( void ) { return oocPoints; }
+    int CoredFileMeshData::polygonCount( void ) { return polygons; }
+
   }
 }
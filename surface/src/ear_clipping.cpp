@@ -39,6 +39,461 @@
 #include <pcl/conversions.h>
 #include <pcl/pcl_config.h>
 
+#include <algorithm>
+#include <cstdint>
+
+namespace
+{
+  /** \brief Ear clipping of a simple polygon in 2D, following the earcut algorithm: the vertices form a
+    * doubly linked list, and for polygons with many vertices an ear is only tested against the vertices
+    * close to it along a z-order curve. Polygons which can not be clipped are cured of small self-intersections
+    * and split along valid diagonals.
+    */
+  class EarCutter
+  {
+    public:
+      /** \brief Constructor.
+        * \param[out] triangles the list the triangles are appended to
+        * \param[in] reversed emit the triangles in the reverse order of the ring, to keep the input winding
+        */
+      EarCutter (std::vector<pcl::Vertices> &triangles, bool reversed)
+        : triangles_ (triangles), reversed_ (reversed)
+      {
+      }
+
+      /** \brief Triangulate a ring of points, which must be counter-clockwise.
+        * \param[in] points the 2D coordinates of the ring
+        * \param[in] ids the vertex indices written into the triangles
+        */
+      void
+      triangulate (const std::vector<Eigen::Vector2f, Eigen::aligned_allocator<Eigen::Vector2f> > &points,
+                   const pcl::Indices &ids)
+      {
+        nodes_.clear ();
+        nodes_.reserve (points.size () + points.size () / 2);
+        int last = -1;
+        for (std::size_t i = 0; i < points.size (); ++i)
+          last = insertNode (static_cast<std::uint32_t> (ids[i]), points[i].x (), points[i].y (), last);
+        if (equals (last, nodes_[last].next))
+        {
+          const int next = nodes_[last].next;
+          removeNode (last);
+          last = next;
+        }
+        if (nodes_[last].next == nodes_[last].prev)
+          return;
+
+        // a spatial index only pays off for larger polygons
+        hashed_ = false;
+        if (points.size () > 80)
+        {
+          float max_x = min_x_ = points[0].x ();
+          float max_y = min_y_ = points[0].y ();
+          for (const auto &point : points)
+          {
+            min_x_ = std::min (min_x_, point.x ());
+            min_y_ = std::min (min_y_, point.y ());
+            max_x = std::max (max_x, point.x ());
+            max_y = std::max (max_y, point.y ());
+          }
+          const float size = std::max (max_x - min_x_, max_y - min_y_);
+          hashed_ = (size > 0);
+          inv_size_ = hashed_ ? 32767.0f / size : 0.0f;
+        }
+
+        earcutLinked (last, 0);
+      }
+
+    private:
+      struct Node
+      {
+        std::uint32_t id;
+        float x, y;
+        int prev, next;
+        std::uint32_t z;
+        int prev_z, next_z;
+      };
+
+      inline int
+      next (int p) const { return (nodes_[p].next); }
+
+      inline int
+      prev (int p) const { return (nodes_[p].prev); }
+
+      /** \brief Create a node and insert it after last, or start a new ring if last is negative. */
+      int
+      insertNode (std::uint32_t id, float x, float y, int last)
+      {
+        const int index = static_cast<int> (nodes_.size ());
+        Node node;
+        node.id = id;
+        node.x = x;
+        node.y = y;
+        node.z = 0;
+        node.prev_z = node.next_z = -1;
+        if (last < 0)
+          node.prev = node.next = index;
+        else
+        {
+          node.prev = last;
+          node.next = nodes_[last].next;
+          nodes_[nodes_[last].next].prev = index;
+          nodes_[last].next = index;
+        }
+        nodes_.push_back (node);
+        return (index);
+      }
+
+      /** \brief Unlink a node from the ring and the z-order list. The node keeps its own links. */
+      void
+      removeNode (int p)
+      {
+        const Node &node = nodes_[p];
+        nodes_[node.next].prev = node.prev;
+        nodes_[node.prev].next = node.next;
+        if (node.prev_z >= 0)
+          nodes_[node.prev_z].next_z = node.next_z;
+        if (node.next_z >= 0)
+          nodes_[node.next_z].prev_z = node.prev_z;
+      }
+
+      void
+      addTriangle (int a, int b, int c)
+      {
+        pcl::Vertices triangle;
+        triangle.vertices.resize (3);
+        triangle.vertices[0] = nodes_[reversed_ ? c : a].id;
+        triangle.vertices[1] = nodes_[b].id;
+        triangle.vertices[2] = nodes_[reversed_ ? a : c].id;
+        triangles_.push_back (triangle);
+      }
+
+      /** \brief Twice the signed area of the triangle, negative for a convex corner of a counter-clockwise ring. */
+      inline float
+      area (int p, int q, int r) const
+      {
+        const Node &a = nodes_[p], &b = nodes_[q], &c = nodes_[r];
+        return ((b.y - a.y) * (c.x - b.x) - (b.x - a.x) * (c.y - b.y));
+      }
+
+      inline bool
+      equals (int p, int q) const
+      {
+        return (nodes_[p].x == nodes_[q].x && nodes_[p].y == nodes_[q].y);
+      }
+
+      /** \brief Check if point p lies in the triangle (a, b, c), boundary included. */
+      inline bool
+      pointInTriangle (const Node &a, const Node &b, const Node &c, const Node &p) const
+      {
+        return ((c.x - p.x) * (a.y - p.y) >= (a.x - p.x) * (c.y - p.y) &&
+                (a.x - p.x) * (b.y - p.y) >= (b.x - p.x) * (a.y - p.y) &&
+                (b.x - p.x) * (c.y - p.y) >= (c.x - p.x) * (b.y - p.y));
+      }
+
+      /** \brief Position of a point along the z-order curve over the bounding box of the polygon. */
+      std::uint32_t
+      zOrder (float x, float y) const
+      {
+        std::uint32_t ix = static_cast<std::uint32_t> ((x - min_x_) * inv_size_);
+        std::uint32_t iy = static_cast<std::uint32_t> ((y - min_y_) * inv_size_);
+        ix = (ix | (ix << 8)) & 0x00FF00FF;
+        ix = (ix | (ix << 4)) & 0x0F0F0F0F;
+        ix = (ix | (ix << 2)) & 0x33333333;
+        ix = (ix | (ix << 1)) & 0x55555555;
+        iy = (iy | (iy << 8)) & 0x00FF00FF;
+        iy = (iy | (iy << 4)) & 0x0F0F0F0F;
+        iy = (iy | (iy << 2)) & 0x33333333;
+        iy = (iy | (iy << 1)) & 0x55555555;
+        return (ix | (iy << 1));
+      }
+
+      /** \brief Link the nodes of a ring in z-order. */
+      void
+      indexCurve (int start)
+      {
+        std::vector<int> ring;
+        int p = start;
+        do
+        {
+          nodes_[p].z = zOrder (nodes_[p].x, nodes_[p].y);
+          ring.push_back (p);
+          p = next (p);
+        } while (p != start);
+
+        std::sort (ring.begin (), ring.end (), [this] (int a, int b)
+        {
+          return (nodes_[a].z < nodes_[b].z || (nodes_[a].z == nodes_[b].z && a < b));
+        });
+        for (std::size_t i = 0; i < ring.size (); ++i)
+        {
+          nodes_[ring[i]].prev_z = (i > 0) ? ring[i - 1] : -1;
+          nodes_[ring[i]].next_z = (i + 1 < ring.size ()) ? ring[i + 1] : -1;
+        }
+      }
+
+      /** \brief Check if a reflex or flat vertex other than the corners blocks the ear (prev, ear, next). */
+      inline bool
+      blocksEar (int p, int ear) const
+      {
+        const int a = prev (ear), c = next (ear);
+        return (p != a && p != c &&
+                pointInTriangle (nodes_[a], nodes_[ear], nodes_[c], nodes_[p]) &&
+                area (prev (p), p, next (p)) >= 0);
+      }
+
+      bool
+      isEar (int ear) const
+      {
+        const int a = prev (ear), c = next (ear);
+        if (area (a, ear, c) >= 0)
+          return (false);
+
+        // only reflex vertices can lie inside a convex corner
+        for (int p = next (c); p != a; p = next (p))
+          if (blocksEar (p, ear))
+            return (false);
+        return (true);
+      }
+
+      bool
+      isEarHashed (int ear) const
+      {
+        const Node &a = nodes_[prev (ear)], &b = nodes_[ear], &c = nodes_[next (ear)];
+        if (area (prev (ear), ear, next (ear)) >= 0)
+          return (false);
+
+        // z-order range of the bounding box of the triangle
+        const std::uint32_t min_z = zOrder (std::min (a.x, std::min (b.x, c.x)), std::min (a.y, std::min (b.y, c.y)));
+        const std::uint32_t max_z = zOrder (std::max (a.x, std::max (b.x, c.x)), std::max (a.y, std::max (b.y, c.y)));
+
+        // look for points inside the triangle in both directions
+        int p = b.prev_z, n = b.next_z;
+        while (p >= 0 && nodes_[p].z >= min_z && n >= 0 && nodes_[n].z <= max_z)
+        {
+          if (blocksEar (p, ear))
+            return (false);
+          p = nodes_[p].prev_z;
+          if (blocksEar (n, ear))
+            return (false);
+          n = nodes_[n].next_z;
+        }
+        for (; p >= 0 && nodes_[p].z >= min_z; p = nodes_[p].prev_z)
+          if (blocksEar (p, ear))
+            return (false);
+        for (; n >= 0 && nodes_[n].z <= max_z; n = nodes_[n].next_z)
+          if (blocksEar (n, ear))
+            return (false);
+        return (true);
+      }
+
+      /** \brief Remove duplicate and collinear vertices between start and end. */
+      int
+      filterPoints (int start, int end)
+      {
+        int p = start;
+        bool again;
+        do
+        {
+          again = false;
+          if (equals (p, next (p)) || area (prev (p), p, next (p)) == 0)
+          {
+            removeNode (p);
+            p = end = prev (p);
+            if (p == next (p))
+              break;
+            again = true;
+          }
+          else
+            p = next (p);
+        } while (again || p != end);
+        return (end);
+      }
+
+      static inline int
+      sign (float value)
+      {
+        return ((value > 0) - (value < 0));
+      }
+
+      /** \brief Check if q lies on the segment (p, r), given that the three points are collinear. */
+      inline bool
+      onSegment (int p, int q, int r) const
+      {
+        return (nodes_[q].x <= std::max (nodes_[p].x, nodes_[r].x) && nodes_[q].x >= std::min (nodes_[p].x, nodes_[r].x) &&
+                nodes_[q].y <= std::max (nodes_[p].y, nodes_[r].y) && nodes_[q].y >= std::min (nodes_[p].y, nodes_[r].y));
+      }
+
+      /** \brief Check if the segments (p1, q1) and (p2, q2) intersect. */
+      bool
+      intersects (int p1, int q1, int p2, int q2) const
+      {
+        const int o1 = sign (area (p1, q1, p2));
+        const int o2 = sign (area (p1, q1, q2));
+        const int o3 = sign (area (p2, q2, p1));
+        const int o4 = sign (area (p2, q2, q1));
+        return ((o1 != o2 && o3 != o4) ||
+                (o1 == 0 && onSegment (p1, p2, q1)) || (o2 == 0 && onSegment (p1, q2, q1)) ||
+                (o3 == 0 && onSegment (p2, p1, q2)) || (o4 == 0 && onSegment (p2, q1, q2)));
+      }
+
+      /** \brief Check if the diagonal (a, b) starts into the polygon at a. */
+      bool
+      locallyInside (int a, int b) const
+      {
+        if (area (prev (a), a, next (a)) < 0)
+          return (area (a, b, next (a)) >= 0 && area (a, prev (a), b) >= 0);
+        return (area (a, b, prev (a)) < 0 || area (a, next (a), b) < 0);
+      }
+
+      /** \brief Check if the middle of the diagonal (a, b) lies inside the polygon. */
+      bool
+      middleInside (int a, int b) const
+      {
+        const float px = (nodes_[a].x + nodes_[b].x) / 2.0f;
+        const float py = (nodes_[a].y + nodes_[b].y) / 2.0f;
+        bool inside = false;
+        int p = a;
+        do
+        {
+          const Node &n1 = nodes_[p], &n2 = nodes_[next (p)];
+          if (((n1.y > py) != (n2.y > py)) && n2.y != n1.y &&
+              (px < (n2.x - n1.x) * (py - n1.y) / (n2.y - n1.y) + n1.x))
+            inside = !inside;
+          p = next (p);
+        } while (p != a);
+        return (inside);
+      }
+
+      /** \brief Check if the diagonal (a, b) crosses an edge of the polygon. */
+      bool
+      intersectsPolygon (int a, int b) const
+      {
+        const std::uint32_t id_a = nodes_[a].id, id_b = nodes_[b].id;
+        int p = a;
+        do
+        {
+          const std::uint32_t id_p = nodes_[p].id, id_n = nodes_[next (p)].id;
+          if (id_p != id_a && id_n != id_a && id_p != id_b && id_n != id_b && intersects (p, next (p), a, b))
+            return (true);
+          p = next (p);
+        } while (p != a);
+        return (false);
+      }
+
+      bool
+      isValidDiagonal (int a, int b) const
+      {
+        return (nodes_[next (a)].id != nodes_[b].id && nodes_[prev (a)].id != nodes_[b].id && !intersectsPolygon (a, b) &&
+                ((locallyInside (a, b) && locallyInside (b, a) && middleInside (a, b) &&
+                  (area (prev (a), a, prev (b)) != 0 || area (a, prev (b), b) != 0)) ||
+                 (equals (a, b) && area (prev (a), a, next (a)) > 0 && area (prev (b), b, next (b)) > 0)));
+      }
+
+      /** \brief Clip the triangles of small self-intersections (two consecutive crossing edges). */
+      int
+      cureLocalIntersections (int start)
+      {
+        int p = start;
+        do
+        {
+          const int a = prev (p), b = next (next (p));
+          if (!equals (a, b) && intersects (a, p, next (p), b) && locallyInside (a, b) && locallyInside (b, a))
+          {
+            addTriangle (a, p, b);
+            removeNode (p);
+            removeNode (next (p));
+            p = start = b;
+          }
+          p = next (p);
+        } while (p != start);
+        return (filterPoints (p, p));
+      }
+
+      /** \brief Split the ring along the diagonal (a, b) into two rings, returns the node of b in the second one. */
+      int
+      splitPolygon (int a, int b)
+      {
+        const int a2 = insertNode (nodes_[a].id, nodes_[a].x, nodes_[a].y, -1);
+        const int b2 = insertNode (nodes_[b].id, nodes_[b].x, nodes_[b].y, -1);
+        const int an = next (a), bp = prev (b);
+        nodes_[a].next = b;
+        nodes_[b].prev = a;
+        nodes_[a2].next = an;
+        nodes_[an].prev = a2;
+        nodes_[b2].next = a2;
+        nodes_[a2].prev = b2;
+        nodes_[bp].next = b2;
+        nodes_[b2].prev = bp;
+        return (b2);
+      }
+
+      /** \brief Split the polygon along a valid diagonal and triangulate both halves. */
+      void
+      splitEarcut (int start)
+      {
+        int a = start;
+        do
+        {
+          for (int b = next (next (a)); b != prev (a); b = next (b))
+          {
+            if (nodes_[a].id != nodes_[b].id && isValidDiagonal (a, b))
+            {
+              int c = splitPolygon (a, b);
+              a = filterPoints (a, next (a));
+              c = filterPoints (c, next (c));
+              earcutLinked (a, 0);
+              earcutLinked (c, 0);
+              return;
+            }
+          }
+          a = next (a);
+        } while (a != start);
+      }
+
+      /** \brief Main ear clipping loop. Pass 0 clips the ears, pass 1 retries without duplicate and collinear
+        * vertices, pass 2 after curing local self-intersections, then the polygon is split.
+        */
+      void
+      earcutLinked (int ear, int pass)
+      {
+        if (pass == 0 && hashed_)
+          indexCurve (ear);
+
+        int stop = ear;
+        while (prev (ear) != next (ear))
+        {
+          const int a = prev (ear), c = next (ear);
+          if (hashed_ ? isEarHashed (ear) : isEar (ear))
+          {
+            addTriangle (a, ear, c);
+            removeNode (ear);
+            // skipping the next vertex leads to less sliver triangles
+            ear = stop = next (c);
+            continue;
+          }
+          ear = c;
+          if (ear == stop)
+          {
+            if (pass == 0)
+              earcutLinked (filterPoints (ear, ear), 1);
+            else if (pass == 1)
+              earcutLinked (cureLocalIntersections (filterPoints (ear, ear)), 2);
+            else
+              splitEarcut (ear);
+            break;
+          }
+        }
+      }
+
+      std::vector<pcl::Vertices> &triangles_;
+      bool reversed_;
+      std::vector<Node> nodes_;
+      bool hashed_ = false;
+      float min_x_ = 0.0f, min_y_ = 0.0f, inv_size_ = 0.0f;
+  };
+}
+
 /////////////////////////////////////////////////////////////////////////////////////////////
 bool
 pcl::EarClipping::initCompute ()
@@ -59,7 +514,12 @@ pcl::EarClipping::performProcessing (PolygonMesh& output)
   output.polygons.clear ();
   output.cloud = input_mesh_->cloud;
   for (const auto &polygon : input_mesh_->polygons)
-    triangulate (polygon, output);
+  {
+    if (use_spatial_index_)
+      triangulateIndexed (polygon, output);
+    else
+      triangulate (polygon, output);
+  }
 }
 
 /////////////////////////////////////////////////////////////////////////////////////////////
@@ -109,6 +569,47 @@ pcl::EarClipping::triangulate (const Vertices& vertices, PolygonMesh& output)
   }
 }
 
+/////////////////////////////////////////////////////////////////////////////////////////////
+void
+pcl::EarClipping::triangulateIndexed (const Vertices& vertices, PolygonMesh& output)
+{
+  if (vertices.vertices.size () < 3)
+    return;
+  if (vertices.vertices.size () == 3)
+  {
+    output.polygons.push_back (vertices);
+    return;
+  }
+
+  Indices ids (vertices.vertices.cbegin (), vertices.vertices.cend ());
+  // Avoid closed loops.
+  if (ids.front () == ids.back ())
+    ids.pop_back ();
+  const std::size_t n_vertices = ids.size ();
+  if (n_vertices < 3)
+    return;
+
+  // Normal of the polygon (Newell's method), it is projected along its dominant axis
+  Eigen::Vector3f normal (0.0f, 0.0f, 0.0f);
+  for (std::size_t prev = n_vertices - 1, cur = 0; cur < n_vertices; prev = cur++)
+    normal += (*points_)[ids[prev]].getVector3fMap ().cross ((*points_)[ids[cur]].getVector3fMap ());
+  int axis;
+  normal.cwiseAbs ().maxCoeff (&axis);
+  const int u_axis = (axis + 1) % 3, v_axis = (axis + 2) % 3;
+
+  // The projection is counter-clockwise if the normal points along the axis, otherwise the ring is reversed
+  const bool reversed = (normal[axis] < 0);
+  if (reversed)
+    std::reverse (ids.begin (), ids.end ());
+  std::vector<Eigen::Vector2f, Eigen::aligned_allocator<Eigen::Vector2f> > points (n_vertices);
+  for (std::size_t i = 0; i < n_vertices; ++i)
+  {
+    const Eigen::Vector3f p = (*points_)[ids[i]].getVector3fMap ();
+    points[i] = Eigen::Vector2f (p[u_axis], p[v_axis]);
+  }
+
+  EarCutter (output.polygons, reversed).triangulate (points, ids);
+}
 
 /////////////////////////////////////////////////////////////////////////////////////////////
 float
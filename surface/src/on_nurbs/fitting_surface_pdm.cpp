@@ -36,6 +36,7 @@
  */
 
 #include <pcl/surface/on_nurbs/fitting_surface_pdm.h>
+#include <pcl/common/execution_context.h>
 #include <pcl/pcl_macros.h>
 
 #include <Eigen/Cholesky> // for ldlt
@@ -204,6 +205,7 @@ FittingSurface::init ()
   in_accuracy = 1e-4;
 
   m_quiet = true;
+  m_threads = m_solver.getNumberOfThreads ();
 }
 
 void
@@ -282,6 +284,13 @@ FittingSurface::assembleInterior (double wInt, unsigned &row)
   m_data->interior_error.clear ();
   m_data->interior_normals.clear ();
   unsigned nInt = static_cast<unsigned> (m_data->interior.size ());
+
+  if (m_threads != 1)
+  {
+    assembleInteriorParallel (wInt, row);
+    return;
+  }
+
   for (unsigned p = 0; p < nInt; p++)
   {
     Vector3d &pcp = m_data->interior[p];
@@ -318,6 +327,89 @@ FittingSurface::assembleInterior (double wInt, unsigned &row)
   }
 }
 
+void
+FittingSurface::assembleInteriorParallel (double wInt, unsigned &row)
+{
+  std::ptrdiff_t nInt = static_cast<std::ptrdiff_t> (m_data->interior.size ());
+  std::ptrdiff_t nParam = static_cast<std::ptrdiff_t> (m_data->interior_param.size ());
+  if (nParam < nInt)
+    m_data->interior_param.resize (nInt);
+  m_data->interior_error.resize (nInt);
+  m_data->interior_normals.resize (nInt);
+  m_data->interior_line_start.resize (nInt);
+  m_data->interior_line_end.resize (nInt);
+
+  // each point owns a fixed row and a fixed slice of the triplet list
+  int order0 = m_nurbs.Order (0);
+  int order1 = m_nurbs.Order (1);
+  std::ptrdiff_t nEntries = order0 * order1;
+  std::vector<Eigen::Triplet<double> > triplets (nInt * nEntries);
+  std::ptrdiff_t row0 = row;
+
+  const pcl::ThreadReservation reservation (m_threads);
+  const unsigned int threads = reservation.getNumberOfThreads ();
+#pragma omp parallel \
+  default(none) \
+  shared(wInt, nInt, nParam, order0, order1, nEntries, triplets, row0) \
+  num_threads(threads)
+  {
+    // basis function buffers are reused for all points of a thread
+    std::vector<double> N0 (order0 * order0);
+    std::vector<double> N1 (order1 * order1);
+
+#pragma omp for schedule(dynamic, 256)
+    for (std::ptrdiff_t p = 0; p < nInt; p++)
+    {
+      const Vector3d &pcp = m_data->interior[p];
+
+      // inverse mapping, starting at the parameters of the last assembly if available
+      Vector2d params;
+      Vector3d pt, tu, tv, n;
+      double error;
+      if (p < nParam)
+        params = inverseMapping (m_nurbs, pcp, m_data->interior_param[p], error, pt, tu, tv, in_max_steps, in_accuracy);
+      else
+      {
+        params = findClosestElementMidPoint (m_nurbs, pcp);
+        params = inverseMapping (m_nurbs, pcp, params, error, pt, tu, tv, in_max_steps, in_accuracy);
+      }
+      m_data->interior_param[p] = params;
+      m_data->interior_error[p] = error;
+
+      n = tu.cross (tv);
+      n.normalize ();
+
+      m_data->interior_normals[p] = n;
+      m_data->interior_line_start[p] = pcp;
+      m_data->interior_line_end[p] = pt;
+
+      double w (wInt);
+      if (p < static_cast<std::ptrdiff_t> (m_data->interior_weight.size ()))
+        w = m_data->interior_weight[p];
+
+      // point constraint, see addPointConstraint
+      int E = ON_NurbsSpanIndex (m_nurbs.m_order[0], m_nurbs.m_cv_count[0], m_nurbs.m_knot[0], params (0), 0, 0);
+      int F = ON_NurbsSpanIndex (m_nurbs.m_order[1], m_nurbs.m_cv_count[1], m_nurbs.m_knot[1], params (1), 0, 0);
+
+      ON_EvaluateNurbsBasis (order0, m_nurbs.m_knot[0] + E, params (0), N0.data ());
+      ON_EvaluateNurbsBasis (order1, m_nurbs.m_knot[1] + F, params (1), N1.data ());
+
+      unsigned r = static_cast<unsigned> (row0 + p);
+      m_solver.f (r, 0, pcp (0) * w);
+      m_solver.f (r, 1, pcp (1) * w);
+      m_solver.f (r, 2, pcp (2) * w);
+
+      Eigen::Triplet<double> *entry = &triplets[p * nEntries];
+      for (int i = 0; i < order0; i++)
+        for (int j = 0; j < order1; j++)
+          *entry++ = Eigen::Triplet<double> (r, lrc2gl (E, F, i, j), w * N0[i] * N1[j]);
+    }
+  }
+
+  m_solver.K (triplets);
+  row += static_cast<unsigned> (nInt);
+}
+
 void
 FittingSurface::assembleBoundary (double wBnd, unsigned &row)
 {
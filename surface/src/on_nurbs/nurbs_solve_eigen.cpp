@@ -35,20 +35,38 @@
  *
  */
 
+#include <algorithm>
+#include <cstdio>
 #include <iostream>
 #include <stdexcept>
 
+#include <Eigen/SparseCholesky> // for SimplicialLDLT
 #include <Eigen/SVD> // for jacobiSvd
 
 #include <pcl/surface/on_nurbs/nurbs_solve.h>
+#include <pcl/common/execution_context.h>
 
 using namespace pcl;
 using namespace on_nurbs;
 
+namespace
+{
+  using SparseMatrixRM = Eigen::SparseMatrix<double, Eigen::RowMajor>;
+
+  /** \brief Build the system matrix from its triplets, a later entry overwriting an earlier one. */
+  SparseMatrixRM
+  buildMatrix (const std::vector<Eigen::Triplet<double> > &triplets, Eigen::Index rows, Eigen::Index cols)
+  {
+    SparseMatrixRM K (rows, cols);
+    K.setFromTriplets (triplets.begin (), triplets.end (), [] (const double &, const double &b) { return b; });
+    return K;
+  }
+}
+
 void
 NurbsSolve::assign (unsigned rows, unsigned cols, unsigned dims)
 {
-  m_Keig = Eigen::MatrixXd::Zero (rows, cols);
+  m_Ktriplets.clear ();
   m_xeig = Eigen::MatrixXd::Zero (cols, dims);
   m_feig = Eigen::MatrixXd::Zero (rows, dims);
 }
@@ -56,7 +74,12 @@ NurbsSolve::assign (unsigned rows, unsigned cols, unsigned dims)
 void
 NurbsSolve::K (unsigned i, unsigned j, double v)
 {
-  m_Keig (i, j) = v;
+  m_Ktriplets.emplace_back (i, j, v);
+}
+void
+NurbsSolve::K (const std::vector<Eigen::Triplet<double> > &entries)
+{
+  m_Ktriplets.insert (m_Ktriplets.end (), entries.begin (), entries.end ());
 }
 void
 NurbsSolve::x (unsigned i, unsigned j, double v)
@@ -72,7 +95,11 @@ NurbsSolve::f (unsigned i, unsigned j, double v)
 double
 NurbsSolve::K (unsigned i, unsigned j)
 {
-  return m_Keig (i, j);
+  // the last entry written at (i,j) is the valid one
+  for (auto it = m_Ktriplets.rbegin (); it != m_Ktriplets.rend (); ++it)
+    if (it->row () == static_cast<Eigen::Index> (i) && it->col () == static_cast<Eigen::Index> (j))
+      return it->value ();
+  return 0.0;
 }
 double
 NurbsSolve::x (unsigned i, unsigned j)
@@ -89,22 +116,25 @@ void
 NurbsSolve::resize (unsigned rows)
 {
   m_feig.conservativeResize (rows, m_feig.cols ());
-  m_Keig.conservativeResize (rows, m_Keig.cols ());
+  m_Ktriplets.erase (std::remove_if (m_Ktriplets.begin (), m_Ktriplets.end (),
+                                     [rows] (const Eigen::Triplet<double> &t)
+                                     { return t.row () >= static_cast<Eigen::Index> (rows); }),
+                     m_Ktriplets.end ());
 }
 
 void
 NurbsSolve::printK ()
 {
-  for (Eigen::Index r = 0; r < m_Keig.rows (); r++)
+  Eigen::MatrixXd K (buildMatrix (m_Ktriplets, m_feig.rows (), m_xeig.rows ()));
+  for (Eigen::Index r = 0; r < K.rows (); r++)
   {
-    for (Eigen::Index c = 0; c < m_Keig.cols (); c++)
+    for (Eigen::Index c = 0; c < K.cols (); c++)
     {
-      printf (" %f", m_Keig (r, c));
+      printf (" %f", K (r, c));
     }
     printf ("\n");
   }
 }
-
 void
 NurbsSolve::printX ()
 {
@@ -134,9 +164,58 @@ NurbsSolve::printF ()
 bool
 NurbsSolve::solve ()
 {
-  //  m_xeig = m_Keig.colPivHouseholderQr().solve(m_feig);
-  //  Eigen::MatrixXd x = A.householderQr().solve(b);
-  m_xeig = m_Keig.jacobiSvd (Eigen::ComputeThinU | Eigen::ComputeThinV).solve (m_feig);
+  Eigen::Index n_rows = m_feig.rows ();
+  Eigen::Index n_cols = m_xeig.rows ();
+  SparseMatrixRM K = buildMatrix (m_Ktriplets, n_rows, n_cols);
+
+  // Assemble the normal equations (K^T K) x = K^T f from independent row blocks of K,
+  // one per thread, and sum the partial products in block order. A set number of threads
+  // fixes the blocks rather than the reserved one, so that the sums do not depend on the
+  // load of the budget.
+  const pcl::ThreadReservation reservation (m_threads);
+  const unsigned int threads = reservation.getNumberOfThreads ();
+  const unsigned int nr_requested = m_threads != 0 ? m_threads : threads;
+  int nr_blocks = static_cast<int> (std::max<Eigen::Index> (1, std::min<Eigen::Index> (nr_requested, n_rows)));
+  std::vector<Eigen::SparseMatrix<double> > KtK_blocks (nr_blocks);
+  std::vector<Eigen::MatrixXd> Ktf_blocks (nr_blocks);
+
+#pragma omp parallel for \
+  default(none) \
+  shared(K, KtK_blocks, Ktf_blocks, nr_blocks, n_rows) \
+  schedule(static, 1) \
+  num_threads(threads)
+  for (int b = 0; b < nr_blocks; b++)
+  {
+    Eigen::Index begin = n_rows * b / nr_blocks;
+    Eigen::Index end = n_rows * (b + 1) / nr_blocks;
+    Eigen::SparseMatrix<double> Kb (K.middleRows (begin, end - begin));
+    KtK_blocks[b] = Kb.transpose () * Kb;
+    Ktf_blocks[b] = Kb.transpose () * m_feig.middleRows (begin, end - begin);
+  }
+
+  Eigen::SparseMatrix<double> KtK = KtK_blocks[0];
+  Eigen::MatrixXd Ktf = Ktf_blocks[0];
+  for (int b = 1; b < nr_blocks; b++)
+  {
+    KtK += KtK_blocks[b];
+    Ktf += Ktf_blocks[b];
+  }
+
+  Eigen::SimplicialLDLT<Eigen::SparseMatrix<double> > ldlt (KtK);
+  if (ldlt.info () == Eigen::Success)
+  {
+    Eigen::MatrixXd x = ldlt.solve (Ktf);
+    if (ldlt.info () == Eigen::Success && x.allFinite ())
+    {
+      m_xeig = x;
+      return true;
+    }
+  }
+
+  // rank deficient system: fall back to the minimum norm solution
+  if (!m_quiet)
+    printf ("[NurbsSolve[Eigen]::solve] Warning: sparse factorization failed, using SVD.\n");
+  m_xeig = Eigen::MatrixXd (KtK).jacobiSvd (Eigen::ComputeThinU | Eigen::ComputeThinV).solve (Ktf);
 
   return true;
 }
@@ -144,7 +223,7 @@ NurbsSolve::solve ()
 Eigen::MatrixXd
 NurbsSolve::diff ()
 {
-  Eigen::MatrixXd f (m_Keig * m_xeig);
+  SparseMatrixRM K = buildMatrix (m_Ktriplets, m_feig.rows (), m_xeig.rows ());
+  Eigen::MatrixXd f (K * m_xeig);
   return (f - m_feig);
 }
-
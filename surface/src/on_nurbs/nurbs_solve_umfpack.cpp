@@ -61,6 +61,12 @@ NurbsSolve::K (unsigned i, unsigned j, double v)
   m_Ksparse.set (i, j, v);
 }
 void
+NurbsSolve::K (const std::vector<Eigen::Triplet<double> > &entries)
+{
+  for (const auto &e : entries)
+    m_Ksparse.set (static_cast<int> (e.row ()), static_cast<int> (e.col ()), e.value ());
+}
+void
 NurbsSolve::x (unsigned i, unsigned j, double v)
 {
   m_xeig (i, j) = v;
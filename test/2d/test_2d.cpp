@@ -47,6 +47,7 @@
 #include <fstream>
 
 #include <pcl/point_types.h>
+#include <pcl/common/execution_context.h>
 #include <pcl/io/pcd_io.h>
 
 char *lena;
@@ -154,6 +155,92 @@ TEST (Convolution, gaussianSmooth)
       EXPECT_NEAR ((*output_cloud)(j,i).intensity, (*gt_output_cloud)(j,i).intensity, 1);
 }
 
+/** Direct evaluation of the convolution as a reference. */
+void
+convolveReference (const pcl::PointCloud<pcl::PointXYZI>& input, const pcl::PointCloud<pcl::PointXYZI>& kernel,
+                   Convolution<pcl::PointXYZI>::BOUNDARY_OPTIONS_ENUM boundary_option, std::vector<float>& output)
+{
+  const int iw = input.width, ih = input.height, kw = kernel.width, kh = kernel.height;
+  const auto index = [boundary_option] (int c, int size)
+  {
+    if (c >= 0 && c < size)
+      return c;
+    if (boundary_option == Convolution<pcl::PointXYZI>::BOUNDARY_OPTION_MIRROR)
+      return (c < 0 ? -c - 1 : 2 * size - 1 - c);
+    if (boundary_option == Convolution<pcl::PointXYZI>::BOUNDARY_OPTION_CLAMP)
+      return (c < 0 ? 0 : size - 1);
+    return (-1);
+  };
+  output.assign (iw * ih, 0.0f);
+  for (int i = 0; i < ih; i++)
+    for (int j = 0; j < iw; j++)
+      for (int k = 0; k < kh; k++)
+        for (int l = 0; l < kw; l++)
+        {
+          const int row = index (i + k - kh / 2, ih), col = index (j + l - kw / 2, iw);
+          if (row >= 0 && col >= 0)
+            output[i * iw + j] += kernel (l, k).intensity * input (col, row).intensity;
+        }
+}
+
+TEST (Convolution, separableAndGeneralKernels)
+{
+  pcl::PointCloud<pcl::PointXYZI>::Ptr input_cloud (new pcl::PointCloud<pcl::PointXYZI>);
+  pcl::io::loadPCDFile(lena, *input_cloud);
+
+  kernel<pcl::PointXYZI> k;
+  k.setKernelSize (5);
+  k.setKernelSigma (1.5f);
+  std::vector<pcl::PointCloud<pcl::PointXYZI>> kernels (4);
+  k.setKernelType (kernel<pcl::PointXYZI>::GAUSSIAN);
+  k.fetchKernel (kernels[0]);
+  k.setKernelType (kernel<pcl::PointXYZI>::SOBEL_X);
+  k.fetchKernel (kernels[1]);
+  k.setKernelType (kernel<pcl::PointXYZI>::LOG);
+  k.fetchKernel (kernels[2]);
+  // non square, separable
+  kernels[3] = pcl::PointCloud<pcl::PointXYZI> (3, 2);
+  for (int l = 0; l < 3; l++)
+    for (int m = 0; m < 2; m++)
+      kernels[3] (l, m).intensity = static_cast<float> ((l + 1) * (m + 2));
+
+  const Convolution<pcl::PointXYZI>::BOUNDARY_OPTIONS_ENUM options[] = {
+    Convolution<pcl::PointXYZI>::BOUNDARY_OPTION_CLAMP,
+    Convolution<pcl::PointXYZI>::BOUNDARY_OPTION_MIRROR,
+    Convolution<pcl::PointXYZI>::BOUNDARY_OPTION_ZERO_PADDING};
+
+  Convolution<pcl::PointXYZI> conv;
+  conv.setInputCloud (input_cloud);
+  std::vector<float> reference;
+  pcl::PointCloud<pcl::PointXYZI> output, output_single_thread, output_budget;
+  // 0 threads takes what the budget allows
+  const unsigned int budget = pcl::ExecutionContext::getThreadBudget ();
+  pcl::ExecutionContext::setThreadBudget (4);
+  for (const auto& kernel_cloud : kernels)
+  {
+    for (const auto option : options)
+    {
+      convolveReference (*input_cloud, kernel_cloud, option, reference);
+      conv.setKernel (kernel_cloud);
+      conv.setBoundaryOptions (option);
+      conv.setNumberOfThreads (4);
+      conv.filter (output);
+      conv.setNumberOfThreads (1);
+      conv.filter (output_single_thread);
+      conv.setNumberOfThreads (0);
+      conv.filter (output_budget);
+      ASSERT_EQ (input_cloud->size (), output.size ());
+      for (std::size_t i = 0; i < output.size (); i++)
+      {
+        EXPECT_NEAR (reference[i], output[i].intensity, 1e-3);
+        EXPECT_EQ (output_single_thread[i].intensity, output[i].intensity);
+        EXPECT_EQ (output_single_thread[i].intensity, output_budget[i].intensity);
+      }
+    }
+  }
+  pcl::ExecutionContext::setThreadBudget (budget);
+}
+
 TEST(Edge, sobel)
 {
   Edge<pcl::PointXYZI, PointXYZIEdge>::Ptr edge_ (new Edge<pcl::PointXYZI, PointXYZIEdge> ());
@@ -391,6 +478,55 @@ TEST(Morphology, closing)
       EXPECT_NEAR ((*output_cloud)(j,i).intensity, (*gt_output_cloud)(j,i).intensity/255.0, 1);
 }
 
+TEST(Morphology, rectangularElement)
+{
+  pcl::PointCloud<pcl::PointXYZI>::Ptr input_cloud (new pcl::PointCloud<pcl::PointXYZI>);
+  pcl::PointCloud<pcl::PointXYZI>::Ptr binary_cloud (new pcl::PointCloud<pcl::PointXYZI>);
+  pcl::io::loadPCDFile(lena, *input_cloud);
+  *binary_cloud = *input_cloud;
+  threshold(binary_cloud, 100);
+
+  const int sizes[][2] = {{3, 3}, {5, 2}, {1, 7}, {6, 4}};
+  for (const auto& size : sizes)
+  {
+    // The same rectangle, surrounded by unset points so it takes the generic path
+    pcl::PointCloud<pcl::PointXYZI>::Ptr rectangle (new pcl::PointCloud<pcl::PointXYZI>);
+    pcl::PointCloud<pcl::PointXYZI>::Ptr framed (new pcl::PointCloud<pcl::PointXYZI> (size[0] + 2, size[1] + 2));
+    Morphology<pcl::PointXYZI> morph;
+    morph.structuringElementRectangle(*rectangle, size[1], size[0]);
+    for (auto& point : framed->points)
+      point.intensity = 0;
+    for (int i = 0; i < size[1]; i++)
+      for (int j = 0; j < size[0]; j++)
+        (*framed)(j + 1, i + 1).intensity = 1;
+
+    pcl::PointCloud<pcl::PointXYZI> output, reference;
+    for (const auto& cloud : {input_cloud, binary_cloud})
+    {
+      for (int operation = 0; operation < 4; operation++)
+      {
+        for (const auto& element : {framed, rectangle})
+        {
+          morph.setInputCloud(cloud);
+          morph.setStructuringElement(element);
+          auto& result = (element == framed) ? reference : output;
+          if (operation == 0)
+            morph.erosionGray(result);
+          else if (operation == 1)
+            morph.dilationGray(result);
+          else if (operation == 2)
+            morph.erosionBinary(result);
+          else
+            morph.dilationBinary(result);
+        }
+        ASSERT_EQ (reference.size (), output.size ());
+        for (std::size_t i = 0; i < output.size (); i++)
+          EXPECT_EQ (reference[i].intensity, output[i].intensity);
+      }
+    }
+  }
+}
+
 /** --[ */
 int
 main (int argc, char** argv)
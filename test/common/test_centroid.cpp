@@ -43,6 +43,8 @@
 #include <pcl/pcl_tests.h>
 
 #include <pcl/common/centroid.h>
+#include <pcl/common/common.h>
+#include <pcl/common/cpu_dispatch.h>
 
 using namespace pcl;
 using pcl::test::EXPECT_EQ_VECTORS;
@@ -794,6 +796,107 @@ TEST (PCL, computeMeanAndCovariance)
   EXPECT_EQ (covariance_matrix (2, 2), 1);
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT, typename Scalar> void
+checkMeanAndCovarianceSIMDLevels (const PointCloud<PointT>& cloud, const Indices& indices, bool all)
+{
+  // Reference computed in double precision, directly from the definition
+  std::size_t finite = 0;
+  Eigen::Vector3d mean = Eigen::Vector3d::Zero ();
+  for (const auto& index : indices)
+  {
+    if (!isFinite (cloud[index]))
+      continue;
+    mean += cloud[index].getVector3fMap ().template cast<double> ();
+    ++finite;
+  }
+  mean /= static_cast<double> (finite);
+  Eigen::Matrix3d covariance = Eigen::Matrix3d::Zero ();
+  for (const auto& index : indices)
+  {
+    if (!isFinite (cloud[index]))
+      continue;
+    const Eigen::Vector3d d = cloud[index].getVector3fMap ().template cast<double> () - mean;
+    covariance += d * d.transpose ();
+  }
+  covariance /= static_cast<double> (finite);
+
+  for (int level = 0; level <= static_cast<int> (getSupportedSIMDLevel ()); ++level)
+  {
+    setSIMDLevel (static_cast<SIMDLevel> (level));
+    const char* name = getSIMDLevelName (getSIMDLevel ());
+    Eigen::Matrix<Scalar, 3, 3> covariance_matrix;
+    Eigen::Matrix<Scalar, 4, 1> centroid;
+    unsigned int count = all ? computeMeanAndCovarianceMatrix (cloud, covariance_matrix, centroid)
+                             : computeMeanAndCovarianceMatrix (cloud, indices, covariance_matrix, centroid);
+    EXPECT_EQ (count, finite) << name;
+    EXPECT_EQ (centroid[3], 1);
+    for (int i = 0; i < 3; ++i)
+    {
+      EXPECT_NEAR (centroid[i], mean[i], 1e-4) << name;
+      for (int j = 0; j < 3; ++j)
+        EXPECT_NEAR (covariance_matrix (i, j), covariance (i, j), 1e-3) << name;
+    }
+
+    // Around the reference centroid
+    centroid.template head<3> () = mean.template cast<Scalar> ();
+    covariance_matrix.setConstant (-1);
+    count = all ? computeCovarianceMatrixNormalized (cloud, centroid, covariance_matrix)
+                : computeCovarianceMatrixNormalized (cloud, indices, centroid, covariance_matrix);
+    EXPECT_EQ (count, finite) << name;
+    for (int i = 0; i < 3; ++i)
+      for (int j = 0; j < 3; ++j)
+        EXPECT_NEAR (covariance_matrix (i, j), covariance (i, j), 1e-4) << name;
+  }
+  setSIMDLevel (getSupportedSIMDLevel ());
+}
+
+TEST (PCL, computeMeanAndCovarianceSIMDLevels)
+{
+  // Sizes around the batch sizes of the vectorized kernels
+  for (const std::size_t size : {1, 2, 3, 4, 5, 7, 9, 17, 1000})
+  {
+    for (const bool is_dense : {true, false})
+    {
+      PointCloud<PointXYZ> cloud;
+      PointCloud<PointXYZRGBNormal> cloud_normal;
+      for (std::size_t i = 0; i < size; ++i)
+      {
+        PointXYZRGBNormal point;
+        point.getVector3fMap () = Eigen::Vector3f::Random () * 2.0f + Eigen::Vector3f (1.0f, -2.0f, 3.0f);
+        // Invalid points, keeping the first one valid
+        if (!is_dense && i % 3 == 1)
+          point.y = std::numeric_limits<float>::quiet_NaN ();
+        if (!is_dense && i % 7 == 5)
+          point.z = -std::numeric_limits<float>::infinity ();
+        cloud_normal.push_back (point);
+        cloud.emplace_back (point.x, point.y, point.z);
+      }
+      cloud.is_dense = cloud_normal.is_dense = is_dense;
+
+      Indices all (size), odd;
+      for (std::size_t i = 0; i < size; ++i)
+      {
+        all[i] = static_cast<index_t> (i);
+        if (i % 2 == 1 || size == 1)
+          odd.push_back (static_cast<index_t> (size - 1 - i));
+      }
+      if (!is_dense)
+        odd.push_back (0);
+
+      // The whole cloud, then a subset through indices
+      for (const bool use_all : {true, false})
+      {
+        const Indices& indices = use_all ? all : odd;
+        checkMeanAndCovarianceSIMDLevels<PointXYZ, float> (cloud, indices, use_all);
+        checkMeanAndCovarianceSIMDLevels<PointXYZ, double> (cloud, indices, use_all);
+        checkMeanAndCovarianceSIMDLevels<PointXYZRGBNormal, float> (cloud_normal, indices, use_all);
+        checkMeanAndCovarianceSIMDLevels<PointXYZRGBNormal, double> (cloud_normal, indices, use_all);
+      }
+    }
+  }
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 TEST (PCL, CentroidPoint)
 {
@@ -1093,6 +1196,68 @@ TEST (PCL, demeanPointCloud)
   EXPECT_NEAR (mat_demean (2, cloud_demean.size () - 1), -0.071702, 1e-4);
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, centroidLargeCloud)
+{
+  // Large enough to be reduced in several blocks
+  PointCloud<PointXYZL> cloud;
+  cloud.resize (200003);
+  cloud.is_dense = false;
+  double sum[3] = {0, 0, 0};
+  std::size_t nr_finite = 0;
+  for (std::size_t i = 0; i < cloud.size (); ++i)
+  {
+    cloud[i].x = static_cast<float> (i % 101) * 0.25f;
+    cloud[i].y = static_cast<float> (i % 37) - 18.0f;
+    cloud[i].z = static_cast<float> (i % 13) * 2.0f;
+    cloud[i].label = (i % 3 == 0 ? 7 : static_cast<std::uint32_t> (i % 5));
+    if (i % 11 == 0)
+      cloud[i].z = std::numeric_limits<float>::quiet_NaN ();
+    else
+    {
+      sum[0] += cloud[i].x; sum[1] += cloud[i].y; sum[2] += cloud[i].z;
+      ++nr_finite;
+    }
+  }
+
+  Eigen::Vector4d centroid;
+  EXPECT_EQ (nr_finite, compute3DCentroid (cloud, centroid));
+  EXPECT_NEAR (sum[0] / nr_finite, centroid[0], 1e-9);
+  EXPECT_NEAR (sum[1] / nr_finite, centroid[1], 1e-9);
+  EXPECT_NEAR (sum[2] / nr_finite, centroid[2], 1e-9);
+  EXPECT_EQ (1, centroid[3]);
+
+  PointXYZL point;
+  EXPECT_EQ (nr_finite, computeCentroid (cloud, point));
+  EXPECT_NEAR (sum[0] / nr_finite, point.x, 1e-3);
+  EXPECT_NEAR (sum[1] / nr_finite, point.y, 1e-3);
+  EXPECT_NEAR (sum[2] / nr_finite, point.z, 1e-3);
+  EXPECT_EQ (7, point.label);
+
+  // Merging the centroids of two halves gives the centroid of the whole
+  CentroidPoint<PointXYZL> first, second;
+  Indices indices;
+  for (index_t i = 0; i < 1000; ++i)
+    if (isFinite (cloud[i]))
+    {
+      (i < 400 ? first : second).add (cloud[i]);
+      indices.push_back (i);
+    }
+  first.merge (second);
+  EXPECT_EQ (indices.size (), first.getSize ());
+  PointXYZL merged, reference;
+  first.get (merged);
+  computeCentroid (cloud, indices, reference);
+  EXPECT_XYZ_NEAR (reference, merged, 1e-4);
+  EXPECT_EQ (reference.label, merged.label);
+
+  Eigen::Vector4f min_pt, max_pt;
+  getMinMax3D (cloud, min_pt, max_pt);
+  EXPECT_EQ (0.0f, min_pt[0]); EXPECT_EQ (25.0f, max_pt[0]);
+  EXPECT_EQ (-18.0f, min_pt[1]); EXPECT_EQ (18.0f, max_pt[1]);
+  EXPECT_EQ (0.0f, min_pt[2]); EXPECT_EQ (24.0f, max_pt[2]);
+}
+
 int
 main (int argc, char** argv)
 {
@@ -0,0 +1,96 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include <pcl/test/gtest.h>
+#include <pcl/common/cpu_dispatch.h>
+
+#include <string>
+
+using namespace pcl;
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+TEST (CPUDispatch, Detection)
+{
+  const SIMDLevel supported = getSupportedSIMDLevel ();
+  EXPECT_EQ (supported, getSupportedSIMDLevel ());
+  EXPECT_LE (getSIMDLevel (), supported);
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+  // The compiler builtins check the same CPUID and XCR0 bits
+  EXPECT_EQ (supported >= SIMDLevel::SSE2, __builtin_cpu_supports ("sse2") != 0);
+  EXPECT_EQ (supported >= SIMDLevel::AVX, __builtin_cpu_supports ("avx") != 0);
+  EXPECT_EQ (supported >= SIMDLevel::AVX2,
+             __builtin_cpu_supports ("avx2") != 0 && __builtin_cpu_supports ("fma") != 0);
+  EXPECT_EQ (supported >= SIMDLevel::AVX512, __builtin_cpu_supports ("avx512f") != 0);
+#elif defined(__SSE2__)
+  EXPECT_GE (supported, SIMDLevel::SSE2);
+#endif
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+TEST (CPUDispatch, SetLevel)
+{
+  const SIMDLevel supported = getSupportedSIMDLevel ();
+  for (int i = static_cast<int> (SIMDLevel::NONE); i <= static_cast<int> (SIMDLevel::AVX512); ++i)
+  {
+    const SIMDLevel level = static_cast<SIMDLevel> (i);
+    setSIMDLevel (level);
+    // Levels the CPU does not support are lowered
+    EXPECT_EQ (getSIMDLevel (), level < supported ? level : supported);
+  }
+  setSIMDLevel (supported);
+  EXPECT_EQ (getSIMDLevel (), supported);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+TEST (CPUDispatch, LevelNames)
+{
+  EXPECT_EQ (std::string (getSIMDLevelName (SIMDLevel::NONE)), "none");
+  EXPECT_EQ (std::string (getSIMDLevelName (SIMDLevel::SSE2)), "sse2");
+  EXPECT_EQ (std::string (getSIMDLevelName (SIMDLevel::AVX)), "avx");
+  EXPECT_EQ (std::string (getSIMDLevelName (SIMDLevel::AVX2)), "avx2");
+  EXPECT_EQ (std::string (getSIMDLevelName (SIMDLevel::AVX512)), "avx512");
+}
+
+/* ---[ */
+int
+main (int argc, char** argv)
+{
+  testing::InitGoogleTest (&argc, argv);
+  return (RUN_ALL_TESTS ());
+}
+/* ]--- */
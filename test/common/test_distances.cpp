@@ -0,0 +1,180 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include <pcl/test/gtest.h>
+#include <pcl/common/cpu_dispatch.h>
+#include <pcl/common/distances.h>
+#include <pcl/common/norms.h>
+#include <pcl/point_representation.h>
+#include <pcl/point_types.h>
+
+#include <cmath>
+#include <random>
+#include <vector>
+
+using namespace pcl;
+
+// Reference implementations, accumulated in double
+float
+referenceSquaredL2 (const float* a, const float* b, std::size_t dim)
+{
+  double sum = 0.0;
+  for (std::size_t i = 0; i < dim; ++i)
+    sum += (a[i] - b[i]) * (a[i] - b[i]);
+  return (static_cast<float> (sum));
+}
+
+float
+referenceChiSquare (const float* a, const float* b, std::size_t dim)
+{
+  double sum = 0.0;
+  for (std::size_t i = 0; i < dim; ++i)
+    if ((a[i] + b[i]) != 0.f)
+      sum += (a[i] - b[i]) * (a[i] - b[i]) / (a[i] + b[i]);
+  return (static_cast<float> (sum));
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+TEST (Distances, KernelsMatchReferenceAtAllLevels)
+{
+  std::mt19937 rng (42);
+  std::uniform_real_distribution<float> dist (0.f, 10.f);
+  const SIMDLevel supported = getSupportedSIMDLevel ();
+
+  for (const std::size_t dim : {1, 3, 4, 7, 8, 15, 16, 17, 33, 125, 308, 352})
+  {
+    std::vector<float> a (dim), b (dim);
+    for (std::size_t i = 0; i < dim; ++i)
+    {
+      a[i] = dist (rng);
+      // leave some empty bins to exercise the chi square guard
+      b[i] = (i % 5 == 0) ? 0.f : dist (rng);
+      if (i % 10 == 0)
+        a[i] = 0.f;
+    }
+    const float l2 = referenceSquaredL2 (a.data (), b.data (), dim);
+    const float chi = referenceChiSquare (a.data (), b.data (), dim);
+
+    for (int i = static_cast<int> (SIMDLevel::NONE); i <= static_cast<int> (supported); ++i)
+    {
+      setSIMDLevel (static_cast<SIMDLevel> (i));
+      EXPECT_NEAR (squaredL2Distance (a.data (), b.data (), dim), l2, 1e-5f * l2 + 1e-6f);
+      EXPECT_NEAR (chiSquareDistance (a.data (), b.data (), dim), chi, 1e-5f * chi + 1e-6f);
+      EXPECT_NEAR (squaredL2Distance (a.data (), b.data (), dim), L2_Norm_SQR (a.data (), b.data (), static_cast<int> (dim)), 1e-4f * l2);
+      EXPECT_NEAR (chiSquareDistance (a.data (), b.data (), dim), CS_Norm (a.data (), b.data (), static_cast<int> (dim)), 1e-4f * chi);
+    }
+  }
+  setSIMDLevel (supported);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+TEST (Distances, RowDistances)
+{
+  const std::size_t dim = 33, stride = 36, nr_rows = 9;
+  std::vector<float> query (dim), rows (nr_rows * stride, -1.f);
+  for (std::size_t i = 0; i < dim; ++i)
+    query[i] = static_cast<float> (i);
+  for (std::size_t r = 0; r < nr_rows; ++r)
+    for (std::size_t i = 0; i < dim; ++i)
+      rows[r * stride + i] = static_cast<float> (i + r);
+
+  std::vector<float> distances (nr_rows);
+  squaredL2Distances (query.data (), rows.data (), nr_rows, stride, dim, distances.data ());
+  for (std::size_t r = 0; r < nr_rows; ++r)
+    EXPECT_FLOAT_EQ (distances[r], static_cast<float> (r * r * dim));
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+checkStaticRepresentation (const PointT &p, const PointT &q)
+{
+  using Static = StaticPointRepresentation<PointT>;
+  ASSERT_TRUE (Static::available);
+
+  const DefaultPointRepresentation<PointT> representation;
+  EXPECT_TRUE (representation.isTrivial ());
+  ASSERT_EQ (representation.getNumberOfDimensions (), Static::dimensions);
+
+  std::vector<float> vp (Static::dimensions), vq (Static::dimensions);
+  representation.vectorize (p, vp);
+  representation.vectorize (q, vq);
+  for (int i = 0; i < Static::dimensions; ++i)
+    EXPECT_EQ (Static::data (p)[i], vp[i]);
+  EXPECT_NEAR (Static::squaredL2Distance (p, q),
+               referenceSquaredL2 (vp.data (), vq.data (), vp.size ()), 1e-3f);
+  EXPECT_NEAR (Static::chiSquareDistance (p, q),
+               referenceChiSquare (vp.data (), vq.data (), vp.size ()), 1e-3f);
+}
+
+TEST (StaticPointRepresentation, MatchesDefaultRepresentation)
+{
+  checkStaticRepresentation (PointXYZ (1.f, 2.f, 3.f), PointXYZ (-1.f, 0.5f, 2.f));
+
+  FPFHSignature33 f1, f2;
+  SHOT352 s1, s2;
+  for (int i = 0; i < 33; ++i)
+  {
+    f1.histogram[i] = static_cast<float> (i);
+    f2.histogram[i] = static_cast<float> (33 - i);
+  }
+  for (int i = 0; i < 352; ++i)
+  {
+    s1.descriptor[i] = static_cast<float> (i % 7) * 0.1f;
+    s2.descriptor[i] = static_cast<float> (i % 11) * 0.1f;
+  }
+  checkStaticRepresentation (f1, f2);
+  checkStaticRepresentation (s1, s2);
+
+  EXPECT_FALSE (StaticPointRepresentation<PointXYZRGB>::available);
+}
+
+TEST (StaticPointRepresentation, FeatureTriviality)
+{
+  EXPECT_TRUE (DefaultFeatureRepresentation<FPFHSignature33> ().isTrivial ());
+  EXPECT_TRUE (DefaultFeatureRepresentation<PFHSignature125> ().isTrivial ());
+  // the representation of a type with non float fields copies field by field
+  EXPECT_FALSE (DefaultFeatureRepresentation<PointXYZRGB> ().isTrivial ());
+}
+
+/* ---[ */
+int
+main (int argc, char** argv)
+{
+  testing::InitGoogleTest (&argc, argv);
+  return (RUN_ALL_TESTS ());
+}
+/* ]--- */
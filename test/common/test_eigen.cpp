@@ -41,8 +41,11 @@
 
 #include <random>
 
+#include <Eigen/Eigenvalues>
+
 #include <pcl/point_types.h>
 #include <pcl/common/eigen.h>
+#include <pcl/common/cpu_dispatch.h>
 
 using namespace pcl;
 
@@ -797,6 +800,81 @@ TEST (PCL, eigen33f)
   EXPECT_LE (float(r_fail_count) / float(iterations), 0.01);
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template<typename Scalar> void
+checkEigen33Batch (Scalar epsilon)
+{
+  using Matrix = Eigen::Matrix<Scalar, 3, 3>;
+  using Vector = Eigen::Matrix<Scalar, 3, 1>;
+  // Not a multiple of any SIMD width, to exercise the remainder handling
+  const std::size_t count = 1003;
+  std::vector<Matrix, Eigen::aligned_allocator<Matrix> > matrices (count);
+  for (std::size_t i = 0; i < count; ++i)
+  {
+    generateSymPosMatrix3x3 (matrices[i]);
+    // Also a few diagonal matrices and a wide range of scales
+    if (i % 50 == 0)
+      matrices[i] = Vector (Scalar (rand_double (rng)), Scalar (rand_double (rng)), 0).asDiagonal ();
+    if (i % 7 == 0)
+      matrices[i] *= Scalar (1e3);
+    if (i % 11 == 0)
+      matrices[i] *= Scalar (1e-3);
+  }
+
+  std::vector<Scalar> coefficients[6];
+  for (std::size_t i = 0; i < count; ++i)
+  {
+    coefficients[0].push_back (matrices[i] (0, 0));
+    coefficients[1].push_back (matrices[i] (0, 1));
+    coefficients[2].push_back (matrices[i] (0, 2));
+    coefficients[3].push_back (matrices[i] (1, 1));
+    coefficients[4].push_back (matrices[i] (1, 2));
+    coefficients[5].push_back (matrices[i] (2, 2));
+  }
+
+  const SIMDLevel original = getSIMDLevel ();
+  for (int level = 0; level <= static_cast<int> (getSupportedSIMDLevel ()); ++level)
+  {
+    setSIMDLevel (static_cast<SIMDLevel> (level));
+    SCOPED_TRACE (getSIMDLevelName (getSIMDLevel ()));
+    std::vector<Scalar> eigenvalues (count), x (count), y (count), z (count);
+    eigen33Batch (coefficients[0].data (), coefficients[1].data (), coefficients[2].data (),
+                  coefficients[3].data (), coefficients[4].data (), coefficients[5].data (),
+                  count, eigenvalues.data (), x.data (), y.data (), z.data ());
+
+    for (std::size_t i = 0; i < count; ++i)
+    {
+      Scalar eigenvalue;
+      Vector eigenvector;
+      eigen33 (matrices[i], eigenvalue, eigenvector);
+      const Scalar scale = std::max (matrices[i].cwiseAbs ().maxCoeff (), std::numeric_limits<Scalar>::min ());
+      EXPECT_NEAR (eigenvalues[i] / scale, eigenvalue / scale, epsilon) << "matrix " << i;
+
+      const Vector v (x[i], y[i], z[i]);
+      EXPECT_NEAR (v.norm (), 1, epsilon) << "matrix " << i;
+
+      // The eigenvector of a repeated or badly separated eigenvalue is not unique. Otherwise it is the same
+      // up to sign
+      Eigen::SelfAdjointEigenSolver<Matrix> solver (matrices[i], Eigen::EigenvaluesOnly);
+      if ((solver.eigenvalues () (1) - solver.eigenvalues () (0)) / scale > Scalar (0.01))
+      {
+        EXPECT_NEAR (std::abs (v.dot (eigenvector)), 1, epsilon * 10) << "matrix " << i;
+      }
+    }
+  }
+  setSIMDLevel (original);
+}
+
+TEST (PCL, eigen33Batchf)
+{
+  checkEigen33Batch<float> (1e-4f);
+}
+
+TEST (PCL, eigen33Batchd)
+{
+  checkEigen33Batch<double> (1e-10);
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 TEST (PCL, transformLine)
 {
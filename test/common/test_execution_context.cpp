@@ -0,0 +1,143 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2019-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <pcl/test/gtest.h>
+#include <pcl/common/execution_context.h>
+
+#include <thread>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+TEST (ExecutionContext, Budget)
+{
+  EXPECT_GE (pcl::ExecutionContext::getHardwareConcurrency (), 1u);
+  EXPECT_EQ (pcl::ExecutionContext::getHardwareConcurrency (), pcl::ExecutionContext::getThreadBudget ());
+
+  pcl::ExecutionContext::setThreadBudget (3);
+  EXPECT_EQ (3u, pcl::ExecutionContext::getThreadBudget ());
+  pcl::ExecutionContext::setThreadBudget (0);
+  EXPECT_EQ (pcl::ExecutionContext::getHardwareConcurrency (), pcl::ExecutionContext::getThreadBudget ());
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+TEST (ExecutionContext, Reservation)
+{
+  pcl::ExecutionContext::setThreadBudget (4);
+  {
+    const pcl::ThreadReservation automatic (0);
+    EXPECT_EQ (4u, automatic.getNumberOfThreads ());
+    EXPECT_EQ (4u, pcl::ExecutionContext::getNumberOfReservedThreads ());
+  }
+  EXPECT_EQ (0u, pcl::ExecutionContext::getNumberOfReservedThreads ());
+
+  {
+    const pcl::ThreadReservation capped (16);
+    EXPECT_EQ (4u, capped.getNumberOfThreads ());
+  }
+  {
+    const pcl::ThreadReservation fixed (2);
+    EXPECT_EQ (2u, fixed.getNumberOfThreads ());
+    EXPECT_EQ (2u, pcl::ExecutionContext::getNumberOfReservedThreads ());
+  }
+  pcl::ExecutionContext::setThreadBudget (0);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+TEST (ExecutionContext, ConcurrentReservations)
+{
+  pcl::ExecutionContext::setThreadBudget (4);
+  const pcl::ThreadReservation first (3);
+  EXPECT_EQ (3u, first.getNumberOfThreads ());
+
+  // Other threads share what is left of the budget, but always get their own thread
+  unsigned int second_threads = 0, third_threads = 0;
+  std::thread ([&]
+  {
+    const pcl::ThreadReservation second (0);
+    second_threads = second.getNumberOfThreads ();
+    std::thread ([&]
+    {
+      const pcl::ThreadReservation third (0);
+      third_threads = third.getNumberOfThreads ();
+    }).join ();
+  }).join ();
+  EXPECT_EQ (1u, second_threads);
+  EXPECT_EQ (1u, third_threads);
+  EXPECT_EQ (3u, pcl::ExecutionContext::getNumberOfReservedThreads ());
+  pcl::ExecutionContext::setThreadBudget (0);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+TEST (ExecutionContext, NestedReservations)
+{
+  pcl::ExecutionContext::setThreadBudget (4);
+  {
+    const pcl::ThreadReservation outer (3);
+    // An algorithm called by another one shares its threads
+    const pcl::ThreadReservation inner (0);
+    EXPECT_EQ (3u, inner.getNumberOfThreads ());
+    const pcl::ThreadReservation smaller (2);
+    EXPECT_EQ (2u, smaller.getNumberOfThreads ());
+    EXPECT_EQ (3u, pcl::ExecutionContext::getNumberOfReservedThreads ());
+  }
+  EXPECT_EQ (0u, pcl::ExecutionContext::getNumberOfReservedThreads ());
+
+#ifdef _OPENMP
+  // Parallel regions inside parallel regions run on the thread that starts them
+  unsigned int nested_threads = 0;
+#pragma omp parallel num_threads(2)
+  {
+    const pcl::ThreadReservation nested (0);
+#pragma omp single
+    nested_threads = nested.getNumberOfThreads ();
+  }
+  EXPECT_EQ (1u, nested_threads);
+  EXPECT_EQ (0u, pcl::ExecutionContext::getNumberOfReservedThreads ());
+#endif
+  pcl::ExecutionContext::setThreadBudget (0);
+}
+
+/* ---[ */
+int
+main (int argc, char** argv)
+{
+  testing::InitGoogleTest (&argc, argv);
+  return (RUN_ALL_TESTS ());
+}
+/* ]--- */
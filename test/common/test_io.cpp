@@ -39,6 +39,7 @@
 #include <pcl/pcl_tests.h>
 #include <pcl/point_types.h>
 #include <pcl/common/io.h>
+#include <pcl/conversions.h>
 
 using namespace pcl;
 
@@ -273,6 +274,44 @@ TEST (PCL, CopyPointCloudWithSameTypes)
   ASSERT_EQ (0, cloud_out.size ());
 }
 
+TEST (PCL, PointCloud2Conversions)
+{
+  CloudXYZRGBA cloud_in (5, 2, pt_xyz_rgba);
+  cloud_in[3] = pt_xyz_rgba2;
+  pcl::PCLPointCloud2 msg;
+  pcl::toPCLPointCloud2 (cloud_in, msg);
+
+  // The layout matches exactly, so the points can be used in place
+  const PointXYZRGBA* view = pcl::getPointsView<PointXYZRGBA> (msg);
+  ASSERT_NE (nullptr, view);
+  for (std::size_t i = 0; i < cloud_in.size (); ++i)
+  {
+    EXPECT_XYZ_EQ (cloud_in[i], view[i]);
+    EXPECT_EQ (cloud_in[i].rgba, view[i].rgba);
+  }
+  EXPECT_EQ (nullptr, pcl::getPointsView<PointXYZ> (msg));
+
+  // Converting twice reuses the cached field map
+  for (int k = 0; k < 2; ++k)
+  {
+    CloudXYZ cloud_out;
+    pcl::fromPCLPointCloud2 (msg, cloud_out);
+    EXPECT_EQ (cloud_in.width, cloud_out.width);
+    EXPECT_EQ (cloud_in.height, cloud_out.height);
+    ASSERT_EQ (cloud_in.size (), cloud_out.size ());
+    for (std::size_t i = 0; i < cloud_out.size (); ++i)
+      EXPECT_XYZ_EQ (cloud_in[i], cloud_out[i]);
+  }
+
+  // A different layout for the same point type
+  pcl::PCLPointCloud2 msg_xyz;
+  pcl::toPCLPointCloud2 (CloudXYZ (3, 1, pt_xyz), msg_xyz);
+  CloudXYZRGBA cloud_out;
+  pcl::fromPCLPointCloud2 (msg_xyz, cloud_out);
+  ASSERT_EQ (3, cloud_out.size ());
+  EXPECT_XYZ_EQ (pt_xyz, cloud_out[2]);
+}
+
 /* ---[ */
 int
 main (int argc, char** argv)
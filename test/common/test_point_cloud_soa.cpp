@@ -0,0 +1,301 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include <pcl/test/gtest.h>
+#include <pcl/pcl_tests.h>
+#include <pcl/point_types.h>
+#include <pcl/point_cloud.h>
+#include <pcl/point_cloud_soa.h>
+#include <pcl/conversions.h>
+#include <pcl/common/centroid.h>
+#include <pcl/common/common.h>
+#include <pcl/common/transforms.h>
+
+#include <limits>
+#include <random>
+
+using namespace pcl;
+
+PointCloud<PointXYZRGBNormal>
+makeCloud (std::size_t size, bool with_nans)
+{
+  std::mt19937 rng (42);
+  std::uniform_real_distribution<float> coordinate (-10.0f, 10.0f);
+  std::uniform_int_distribution<int> color (0, 255);
+  PointCloud<PointXYZRGBNormal> cloud;
+  for (std::size_t i = 0; i < size; ++i)
+  {
+    PointXYZRGBNormal p;
+    p.x = coordinate (rng); p.y = coordinate (rng); p.z = coordinate (rng);
+    p.r = static_cast<std::uint8_t> (color (rng));
+    p.g = static_cast<std::uint8_t> (color (rng));
+    p.b = static_cast<std::uint8_t> (color (rng));
+    p.a = 255;
+    p.normal_x = coordinate (rng); p.normal_y = coordinate (rng); p.normal_z = coordinate (rng);
+    p.curvature = coordinate (rng);
+    if (with_nans && i % 7 == 3)
+      p.y = std::numeric_limits<float>::quiet_NaN ();
+    cloud.push_back (p);
+  }
+  cloud.is_dense = !with_nans;
+  return (cloud);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PointCloudSoA, Fields)
+{
+  PointCloudSoA soa;
+  EXPECT_TRUE (soa.empty ());
+  EXPECT_EQ (soa.addField ("x", PCLPointField::FLOAT32), 0);
+  EXPECT_EQ (soa.addField ("label", PCLPointField::UINT32), 1);
+  soa.resize (10);
+  EXPECT_EQ (soa.size (), 10);
+  EXPECT_EQ (soa.width, 10);
+  EXPECT_EQ (soa.height, 1);
+
+  // Adding the same field again returns the existing index, a conflicting one fails
+  EXPECT_EQ (soa.addField ("x", PCLPointField::FLOAT32), 0);
+  EXPECT_EQ (soa.addField ("x", PCLPointField::FLOAT64), -1);
+
+  // New fields are sized to the cloud and zero filled
+  EXPECT_EQ (soa.addField ("histogram", PCLPointField::FLOAT32, 3), 2);
+  EXPECT_EQ (soa.getElementSize (2), 3 * sizeof (float));
+  for (std::size_t i = 0; i < 3 * soa.size (); ++i)
+    EXPECT_EQ (reinterpret_cast<const float*> (soa.getFieldData (2))[i], 0.0f);
+
+  EXPECT_NE (soa.getFieldData<float> ("x"), nullptr);
+  EXPECT_NE (soa.getFieldData<std::uint32_t> ("label"), nullptr);
+  EXPECT_EQ (soa.getFieldData<float> ("label"), nullptr);
+  EXPECT_EQ (soa.getFieldData<float> ("histogram"), nullptr);
+  EXPECT_EQ (soa.getFieldData<float> ("y"), nullptr);
+  EXPECT_EQ (soa.getFieldIndex ("histogram"), 2);
+  EXPECT_EQ (soa.getFieldIndex ("y"), -1);
+
+  soa.resize (4, 3);
+  EXPECT_EQ (soa.size (), 12);
+  EXPECT_TRUE (soa.isOrganized ());
+  soa.clear ();
+  EXPECT_TRUE (soa.empty ());
+  EXPECT_EQ (soa.getFields ().size (), 3);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PointCloudSoA, ConvertPointCloud)
+{
+  PointCloud<PointXYZRGBNormal> cloud = makeCloud (100, true);
+  cloud.width = 20;
+  cloud.height = 5;
+  cloud.header.frame_id = "frame";
+
+  PointCloudSoA soa;
+  toPointCloudSoA (cloud, soa);
+  EXPECT_EQ (soa.size (), cloud.size ());
+  EXPECT_EQ (soa.width, 20);
+  EXPECT_EQ (soa.height, 5);
+  EXPECT_FALSE (soa.is_dense);
+  EXPECT_EQ (soa.header.frame_id, "frame");
+
+  const float *x = soa.getFieldData<float> ("x");
+  const float *curvature = soa.getFieldData<float> ("curvature");
+  ASSERT_NE (x, nullptr);
+  ASSERT_NE (curvature, nullptr);
+  for (std::size_t i = 0; i < cloud.size (); ++i)
+  {
+    EXPECT_EQ (x[i], cloud[i].x);
+    EXPECT_EQ (curvature[i], cloud[i].curvature);
+  }
+
+  PointCloud<PointXYZRGBNormal> back;
+  fromPointCloudSoA (soa, back);
+  ASSERT_EQ (back.size (), cloud.size ());
+  EXPECT_EQ (back.width, cloud.width);
+  EXPECT_EQ (back.height, cloud.height);
+  EXPECT_EQ (back.is_dense, cloud.is_dense);
+  for (std::size_t i = 0; i < cloud.size (); ++i)
+  {
+    EXPECT_EQ (back[i].x, cloud[i].x);
+    if (std::isfinite (cloud[i].y))
+      EXPECT_EQ (back[i].y, cloud[i].y);
+    else
+      EXPECT_FALSE (std::isfinite (back[i].y));
+    EXPECT_EQ (back[i].z, cloud[i].z);
+    EXPECT_EQ (back[i].rgba, cloud[i].rgba);
+    EXPECT_EQ (back[i].normal_x, cloud[i].normal_x);
+    EXPECT_EQ (back[i].normal_z, cloud[i].normal_z);
+    EXPECT_EQ (back[i].curvature, cloud[i].curvature);
+  }
+
+  // Converting to a point type with fewer fields picks the matching columns
+  PointCloud<PointXYZRGBA> colored;
+  fromPointCloudSoA (soa, colored);
+  ASSERT_EQ (colored.size (), cloud.size ());
+  for (std::size_t i = 0; i < cloud.size (); ++i)
+  {
+    EXPECT_EQ (colored[i].x, cloud[i].x);
+    EXPECT_EQ (colored[i].rgba, cloud[i].rgba);
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PointCloudSoA, ConvertPCLPointCloud2)
+{
+  const PointCloud<PointXYZRGBNormal> cloud = makeCloud (50, false);
+  PCLPointCloud2 msg;
+  toPCLPointCloud2 (cloud, msg);
+
+  PointCloudSoA soa;
+  toPointCloudSoA (msg, soa);
+  EXPECT_EQ (soa.size (), cloud.size ());
+  EXPECT_EQ (soa.getFields ().size (), msg.fields.size ());
+  EXPECT_EQ (soa.getFieldIndex ("_"), -1);
+
+  PCLPointCloud2 packed;
+  fromPointCloudSoA (soa, packed);
+  EXPECT_EQ (packed.width, msg.width);
+  EXPECT_EQ (packed.height, msg.height);
+  EXPECT_EQ (packed.fields.size (), msg.fields.size ());
+  EXPECT_EQ (packed.point_step, 8 * sizeof (float));
+  EXPECT_EQ (packed.data.size (), cloud.size () * packed.point_step);
+
+  PointCloud<PointXYZRGBNormal> back;
+  fromPCLPointCloud2 (packed, back);
+  ASSERT_EQ (back.size (), cloud.size ());
+  for (std::size_t i = 0; i < cloud.size (); ++i)
+  {
+    EXPECT_XYZ_EQ (back[i], cloud[i]);
+    EXPECT_RGBA_EQ (back[i], cloud[i]);
+    EXPECT_NORMAL_EQ (back[i], cloud[i]);
+    EXPECT_EQ (back[i].curvature, cloud[i].curvature);
+  }
+
+  // A blob too small for its points is rejected
+  msg.data.resize (msg.data.size () / 2);
+  toPointCloudSoA (msg, soa);
+  EXPECT_TRUE (soa.empty ());
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PointCloudSoA, Transform)
+{
+  for (const bool with_nans : {false, true})
+  {
+    const PointCloud<PointXYZRGBNormal> cloud = makeCloud (200, with_nans);
+    PointCloudSoA soa;
+    toPointCloudSoA (cloud, soa);
+
+    Eigen::Affine3f transform = Eigen::Affine3f::Identity ();
+    transform.translate (Eigen::Vector3f (1.0f, -2.0f, 0.5f));
+    transform.rotate (Eigen::AngleAxisf (0.3f, Eigen::Vector3f (1.0f, 2.0f, 3.0f).normalized ()));
+
+    PointCloud<PointXYZRGBNormal> cloud_transformed;
+    transformPointCloud (cloud, cloud_transformed, transform);
+
+    PointCloudSoA soa_transformed;
+    transformPointCloud (soa, soa_transformed, transform);
+    PointCloudSoA soa_xyz;
+    transformPointCloud (soa, soa_xyz, transform.matrix (), false);
+    EXPECT_EQ (soa_xyz.getFields ().size (), 3);
+    // In place
+    transformPointCloud (soa, soa, transform);
+
+    const float *x = soa_transformed.getFieldData<float> ("x");
+    const float *y = soa_transformed.getFieldData<float> ("y");
+    const float *z = soa_transformed.getFieldData<float> ("z");
+    const float *normal_x = soa_transformed.getFieldData<float> ("normal_x");
+    for (std::size_t i = 0; i < cloud.size (); ++i)
+    {
+      EXPECT_EQ (normal_x[i], cloud[i].normal_x);
+      if (!isFinite (cloud[i]))
+      {
+        EXPECT_EQ (x[i], cloud[i].x);
+        EXPECT_FALSE (std::isfinite (y[i]));
+        EXPECT_EQ (z[i], cloud[i].z);
+        continue;
+      }
+      EXPECT_NEAR (x[i], cloud_transformed[i].x, 1e-4);
+      EXPECT_NEAR (y[i], cloud_transformed[i].y, 1e-4);
+      EXPECT_NEAR (z[i], cloud_transformed[i].z, 1e-4);
+      EXPECT_EQ (soa_xyz.getFieldData<float> ("x")[i], x[i]);
+      EXPECT_EQ (soa.getFieldData<float> ("x")[i], x[i]);
+      EXPECT_EQ (soa.getFieldData<float> ("z")[i], z[i]);
+    }
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PointCloudSoA, CentroidAndMinMax)
+{
+  for (const bool with_nans : {false, true})
+  {
+    const PointCloud<PointXYZRGBNormal> cloud = makeCloud (500, with_nans);
+    PointCloudSoA soa;
+    toPointCloudSoA (cloud, soa);
+
+    Eigen::Vector4f centroid, centroid_soa;
+    EXPECT_EQ (compute3DCentroid (soa, centroid_soa), compute3DCentroid (cloud, centroid));
+    EXPECT_NEAR (centroid_soa[0], centroid[0], 1e-4);
+    EXPECT_NEAR (centroid_soa[1], centroid[1], 1e-4);
+    EXPECT_NEAR (centroid_soa[2], centroid[2], 1e-4);
+    EXPECT_EQ (centroid_soa[3], 1.0f);
+
+    Eigen::Vector4d centroid_d;
+    EXPECT_EQ (compute3DCentroid (soa, centroid_d), compute3DCentroid (cloud, centroid));
+    EXPECT_NEAR (centroid_d[0], centroid[0], 1e-4);
+
+    Eigen::Vector4f min_pt, max_pt, min_soa, max_soa;
+    getMinMax3D (cloud, min_pt, max_pt);
+    getMinMax3D (soa, min_soa, max_soa);
+    EXPECT_EQ (min_soa.head<3> (), min_pt.head<3> ());
+    EXPECT_EQ (max_soa.head<3> (), max_pt.head<3> ());
+  }
+
+  // Clouds without coordinates are rejected
+  PointCloudSoA soa;
+  soa.addField ("intensity", PCLPointField::FLOAT32);
+  soa.resize (3);
+  Eigen::Vector4f centroid;
+  EXPECT_EQ (compute3DCentroid (soa, centroid), 0);
+}
+
+/* ---[ */
+int
+main (int argc, char** argv)
+{
+  testing::InitGoogleTest (&argc, argv);
+  return (RUN_ALL_TESTS ());
+}
+/* ]--- */
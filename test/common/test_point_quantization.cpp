@@ -0,0 +1,287 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include <pcl/test/gtest.h>
+#include <pcl/common/cpu_dispatch.h>
+#include <pcl/common/io.h>
+#include <pcl/common/point_quantization.h>
+#include <pcl/common/point_tests.h> // for isFinite
+#include <pcl/conversions.h>
+
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <random>
+#include <vector>
+
+using namespace pcl;
+
+/** Run a check at every instruction set level the CPU supports. */
+template <typename Check> void
+forEachSIMDLevel (Check check)
+{
+  const SIMDLevel original = getSIMDLevel ();
+  for (int level = 0; level <= static_cast<int> (getSupportedSIMDLevel ()); ++level)
+  {
+    setSIMDLevel (static_cast<SIMDLevel> (level));
+    SCOPED_TRACE (getSIMDLevelName (getSIMDLevel ()));
+    check ();
+  }
+  setSIMDLevel (original);
+}
+
+std::uint32_t
+bitsOf (float value)
+{
+  std::uint32_t bits;
+  std::memcpy (&bits, &value, sizeof (bits));
+  return (bits);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PointQuantization, Layout)
+{
+  EXPECT_EQ (sizeof (PointXYZQ16), 6u);
+  EXPECT_EQ (sizeof (PointXYZHalf), 6u);
+  EXPECT_EQ (sizeof (PointNormalHalf), 12u);
+
+  // The registered fields are what PCD and PLY files store
+  PointCloud<PointNormalHalf> cloud (3, 2);
+  PCLPointCloud2 blob;
+  toPCLPointCloud2 (cloud, blob);
+  ASSERT_EQ (blob.fields.size (), 5u);
+  EXPECT_EQ (blob.point_step, 12u);
+  EXPECT_EQ (blob.fields[0].name, "x");
+  EXPECT_EQ (blob.fields[0].datatype, PCLPointField::UINT16);
+  EXPECT_EQ (blob.fields[3].name, "normal_oct");
+  EXPECT_EQ (blob.fields[3].datatype, PCLPointField::INT16);
+  EXPECT_EQ (blob.fields[3].count, 2u);
+  EXPECT_EQ (blob.fields[4].offset, 10u);
+  EXPECT_EQ (getFieldsList (PointCloud<PointXYZQ16> ()), "x y z");
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PointQuantization, Half)
+{
+  EXPECT_EQ (floatToHalf (1.0f), 0x3c00);
+  EXPECT_EQ (floatToHalf (-2.0f), 0xc000);
+  EXPECT_EQ (floatToHalf (65504.0f), 0x7bff);
+  EXPECT_EQ (floatToHalf (65519.0f), 0x7bff);
+  EXPECT_EQ (floatToHalf (65520.0f), 0x7c00);
+  EXPECT_EQ (floatToHalf (std::numeric_limits<float>::infinity ()), 0x7c00);
+  EXPECT_EQ (floatToHalf (std::ldexp (1.0f, -24)), 0x0001);
+  EXPECT_EQ (floatToHalf (std::ldexp (1.0f, -26)), 0x0000);
+  // Ties round to even
+  EXPECT_EQ (floatToHalf (1.0f + std::ldexp (1.0f, -11)), 0x3c00);
+  EXPECT_EQ (floatToHalf (1.0f + 3 * std::ldexp (1.0f, -11)), 0x3c02);
+  EXPECT_TRUE (std::isnan (halfToFloat (floatToHalf (std::numeric_limits<float>::quiet_NaN ()))));
+
+  // Every half survives the round trip, and the batch conversion agrees bit by bit
+  std::vector<std::uint16_t> all (65536 + 3);
+  for (std::size_t i = 0; i < all.size (); ++i)
+    all[i] = static_cast<std::uint16_t> (i);
+  for (std::uint32_t h = 0; h < 65536; ++h)
+  {
+    const float value = halfToFloat (static_cast<std::uint16_t> (h));
+    if (std::isnan (value))
+      continue;
+    EXPECT_EQ (floatToHalf (value), h);
+  }
+  forEachSIMDLevel ([&] ()
+  {
+    std::vector<float> batch (all.size ());
+    halfToFloat (all.data (), all.size (), batch.data ());
+    for (std::size_t i = 0; i < all.size (); ++i)
+      EXPECT_EQ (bitsOf (batch[i]), bitsOf (halfToFloat (all[i]))) << "half " << all[i];
+  });
+
+  // Rounding to nearest keeps half an ulp, i.e. 2^-11 relative
+  std::mt19937 rng (42);
+  std::uniform_real_distribution<float> dist (-1000.0f, 1000.0f);
+  for (int i = 0; i < 10000; ++i)
+  {
+    const float value = dist (rng);
+    EXPECT_LE (std::abs (halfToFloat (floatToHalf (value)) - value), std::abs (value) * std::ldexp (1.0f, -11));
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PointQuantization, OctahedralNormal)
+{
+  std::mt19937 rng (42);
+  std::normal_distribution<float> dist;
+  double max_angle = 0.0;
+  for (int i = 0; i < 100000; ++i)
+  {
+    const Eigen::Vector3f normal = Eigen::Vector3f (dist (rng), dist (rng), dist (rng)).normalized ();
+    const std::array<std::int16_t, 2> oct = encodeOctahedralNormal (normal[0], normal[1], normal[2]);
+    Eigen::Vector3f decoded;
+    decodeOctahedralNormal (oct.data (), decoded[0], decoded[1], decoded[2]);
+    EXPECT_NEAR (decoded.norm (), 1.0f, 1e-6f);
+    const Eigen::Vector3d a = normal.cast<double> (), b = decoded.cast<double> ();
+    max_angle = std::max (max_angle, std::atan2 (a.cross (b).norm (), a.dot (b)));
+  }
+  EXPECT_LT (max_angle * 180.0 / M_PI, 0.01);
+
+  // The poles and the folded edges
+  const float axes[6][3] = {{1, 0, 0}, {-1, 0, 0}, {0, 1, 0}, {0, -1, 0}, {0, 0, 1}, {0, 0, -1}};
+  for (const auto& axis : axes)
+  {
+    const std::array<std::int16_t, 2> oct = encodeOctahedralNormal (axis[0], axis[1], axis[2]);
+    float nx, ny, nz;
+    decodeOctahedralNormal (oct.data (), nx, ny, nz);
+    EXPECT_FLOAT_EQ (nx, axis[0]);
+    EXPECT_FLOAT_EQ (ny, axis[1]);
+    EXPECT_FLOAT_EQ (nz, axis[2]);
+  }
+
+  const std::array<std::int16_t, 2> invalid = encodeOctahedralNormal (std::numeric_limits<float>::quiet_NaN (), 0, 1);
+  EXPECT_EQ (invalid[0], std::numeric_limits<std::int16_t>::min ());
+  EXPECT_EQ (encodeOctahedralNormal (0, 0, 0)[0], std::numeric_limits<std::int16_t>::min ());
+  float nx, ny, nz;
+  decodeOctahedralNormal (invalid.data (), nx, ny, nz);
+  EXPECT_TRUE (std::isnan (nx) && std::isnan (ny) && std::isnan (nz));
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PointQuantization, PointXYZQ16)
+{
+  const Eigen::Vector3f origin (100.0f, -50.0f, 3.0f);
+  const float step = 0.001f;
+  std::mt19937 rng (42);
+  std::uniform_real_distribution<float> dist (-30.0f, 30.0f);
+
+  PointCloud<PointXYZ> cloud (1001, 1);
+  for (auto& p : cloud)
+    p.getVector3fMap () = origin + Eigen::Vector3f (dist (rng), dist (rng), dist (rng));
+  cloud[7].y = std::numeric_limits<float>::quiet_NaN ();
+  cloud[8].getVector3fMap () = origin + Eigen::Vector3f (0.0f, 40.0f, 0.0f);
+  cloud.is_dense = true;
+  cloud.sensor_origin_ << 1, 2, 3, 0;
+
+  PointCloud<PointXYZQ16> quantized;
+  EXPECT_EQ (encodePointCloud (cloud, origin, step, quantized), 1u);
+  EXPECT_EQ (quantized.size (), cloud.size ());
+  EXPECT_FALSE (quantized.is_dense);
+  EXPECT_EQ (quantized.sensor_origin_, cloud.sensor_origin_);
+
+  forEachSIMDLevel ([&] ()
+  {
+    PointCloud<PointXYZ> decoded;
+    decodePointCloud (quantized, origin, step, decoded);
+    ASSERT_EQ (decoded.size (), cloud.size ());
+    EXPECT_EQ (decoded.width, cloud.width);
+    for (std::size_t i = 0; i < cloud.size (); ++i)
+    {
+      if (i == 7 || i == 8)
+      {
+        EXPECT_FALSE (isFinite (decoded[i])) << "point " << i;
+        continue;
+      }
+      // Half a step, plus the float rounding at 100 m
+      EXPECT_LE ((decoded[i].getVector3fMap () - cloud[i].getVector3fMap ()).cwiseAbs ().maxCoeff (), step * 0.5f + 2e-5f)
+        << "point " << i;
+      EXPECT_EQ (decoded[i].data[3], 1.0f);
+    }
+  });
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PointQuantization, PointNormalHalf)
+{
+  std::mt19937 rng (42);
+  std::uniform_real_distribution<float> dist (-10.0f, 10.0f);
+  std::normal_distribution<float> normal_dist;
+
+  PointCloud<PointNormal> cloud (37, 27);
+  for (auto& p : cloud)
+  {
+    p.getVector3fMap () = Eigen::Vector3f (dist (rng), dist (rng), dist (rng));
+    p.getNormalVector3fMap () = Eigen::Vector3f (normal_dist (rng), normal_dist (rng), normal_dist (rng)).normalized ();
+    p.curvature = std::abs (dist (rng)) * 0.01f;
+  }
+  cloud[5].normal_x = std::numeric_limits<float>::quiet_NaN ();
+
+  PointCloud<PointNormalHalf> compact;
+  encodePointCloud (cloud, compact);
+  EXPECT_EQ (compact.width, cloud.width);
+  EXPECT_EQ (compact.height, cloud.height);
+
+  PointCloud<PointXYZHalf> positions;
+  encodePointCloud (PointCloud<PointXYZ> (), positions);
+  EXPECT_TRUE (positions.empty ());
+
+  forEachSIMDLevel ([&] ()
+  {
+    PointCloud<PointNormal> decoded;
+    decodePointCloud (compact, decoded);
+    ASSERT_EQ (decoded.size (), cloud.size ());
+    for (std::size_t i = 0; i < cloud.size (); ++i)
+    {
+      for (int k = 0; k < 3; ++k)
+        EXPECT_EQ (decoded[i].data[k], halfToFloat (floatToHalf (cloud[i].data[k]))) << "point " << i;
+      EXPECT_EQ (decoded[i].curvature, halfToFloat (floatToHalf (cloud[i].curvature))) << "point " << i;
+      if (i == 5)
+      {
+        EXPECT_TRUE (std::isnan (decoded[i].normal_x));
+        continue;
+      }
+      EXPECT_GT (decoded[i].getNormalVector3fMap ().dot (cloud[i].getNormalVector3fMap ()), 0.99999f) << "point " << i;
+    }
+
+    // The position only type decodes to the same coordinates
+    PointCloud<PointXYZ> xyz;
+    copyPointCloud (cloud, xyz);
+    PointCloud<PointXYZHalf> half;
+    encodePointCloud (xyz, half);
+    PointCloud<PointXYZ> xyz_decoded;
+    decodePointCloud (half, xyz_decoded);
+    ASSERT_EQ (xyz_decoded.size (), cloud.size ());
+    EXPECT_EQ (xyz_decoded.height, cloud.height);
+    for (std::size_t i = 0; i < cloud.size (); ++i)
+      EXPECT_EQ (xyz_decoded[i].getVector3fMap (), decoded[i].getVector3fMap ()) << "point " << i;
+  });
+}
+
+/* ---[ */
+int
+main (int argc, char** argv)
+{
+  testing::InitGoogleTest (&argc, argv);
+  return (RUN_ALL_TESTS ());
+}
+/* ]--- */
@@ -395,6 +395,71 @@ TEST_F (organizedPointCloudTest, organized_concatenate)
   EXPECT_EQ (organized_cloud_out.width, total_size);
 }
 
+TEST (PointCloud, memory_resource)
+{
+  pcl::MonotonicBufferResource arena (1024);
+  {
+    pcl::PointCloud<pcl::PointXYZ> cloud (&arena);
+    EXPECT_EQ (&arena, cloud.getMemoryResource ());
+    for (int i = 0; i < 1000; ++i)
+      cloud.emplace_back (i, 2 * i, 3 * i);
+    EXPECT_EQ (0, reinterpret_cast<std::uintptr_t> (cloud.data ()) % pcl::PolymorphicAllocator<pcl::PointXYZ>::alignment);
+
+    // Copies go to the default resource, moves take the arena along
+    pcl::PointCloud<pcl::PointXYZ> copy (cloud);
+    EXPECT_EQ (pcl::getDefaultResource (), copy.getMemoryResource ());
+    pcl::PointCloud<pcl::PointXYZ> moved (std::move (cloud));
+    EXPECT_EQ (&arena, moved.getMemoryResource ());
+    ASSERT_EQ (1000, moved.size ());
+    EXPECT_EQ (999 * 3, moved[999].z);
+
+    // Swapping clouds on different resources keeps both valid
+    copy.swap (moved);
+    EXPECT_EQ (&arena, copy.getMemoryResource ());
+    EXPECT_EQ (999 * 2, moved[999].y);
+  }
+  arena.release ();
+
+  pcl::PointCloud<pcl::PointXYZ> reused (&arena);
+  reused.resize (10);
+  EXPECT_EQ (10, reused.size ());
+}
+
+TEST (PointCloud, counting_resource)
+{
+  pcl::CountingResource counting;
+  {
+    pcl::PointCloud<pcl::PointXYZ> cloud (&counting);
+    cloud.resize (1000);
+    EXPECT_EQ (1000 * sizeof (pcl::PointXYZ), counting.getCurrentBytes ());
+    EXPECT_EQ (1, counting.getNumberOfAllocations ());
+
+    cloud.clear ();
+    cloud.points.shrink_to_fit ();
+    EXPECT_EQ (0, counting.getCurrentBytes ());
+    EXPECT_EQ (1000 * sizeof (pcl::PointXYZ), counting.getPeakBytes ());
+  }
+  counting.resetPeak ();
+  EXPECT_EQ (0, counting.getPeakBytes ());
+
+  // Allocations beyond the limit fail without being counted
+  counting.setLimit (100 * sizeof (pcl::PointXYZ));
+  pcl::PointCloud<pcl::PointXYZ> small (&counting);
+  small.resize (100);
+  EXPECT_THROW (pcl::PointCloud<pcl::PointXYZ> (&counting).resize (101), std::bad_alloc);
+  EXPECT_EQ (100 * sizeof (pcl::PointXYZ), counting.getCurrentBytes ());
+
+  // As the default resource every new cloud is counted
+  counting.setLimit (0);
+  pcl::MemoryResource* previous = pcl::setDefaultResource (&counting);
+  {
+    pcl::PointCloud<pcl::PointXYZ> cloud;
+    cloud.resize (10);
+    EXPECT_EQ (110 * sizeof (pcl::PointXYZ), counting.getCurrentBytes ());
+  }
+  pcl::setDefaultResource (previous);
+}
+
 /* ---[ */
 int
 main (int argc, char** argv)
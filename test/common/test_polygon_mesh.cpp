@@ -39,6 +39,7 @@
 
 #include <pcl/pcl_tests.h>
 #include <pcl/PolygonMesh.h>
+#include <pcl/PolygonMeshBuffer.h>
 
 #include <pcl/point_types.h>
 #include <pcl/conversions.h>
@@ -126,6 +127,82 @@ TEST(PolygonMesh, concatenate_vertices)
     }
 }
 
+TEST(PolygonMeshBuffer, polygons)
+{
+    PolygonMeshBuffer buffer;
+    EXPECT_TRUE(buffer.empty());
+
+    const std::uint32_t quad[4] = {0, 1, 2, 3};
+    buffer.addTriangle(4, 5, 6);
+    buffer.addPolygon(quad, quad + 4);
+    ASSERT_EQ(2, buffer.size());
+    EXPECT_FALSE(buffer.isTriangleMesh());
+    EXPECT_EQ(3, buffer.getPolygonSize(0));
+    EXPECT_EQ(4, buffer.getPolygonSize(1));
+    EXPECT_EQ(5, buffer.getPolygon(0)[1]);
+    EXPECT_EQ(3, buffer.getPolygon(1)[3]);
+
+    std::vector<std::uint32_t> triangles = {0, 1, 2, 2, 1, 3, 7};
+    const std::uint32_t* data = triangles.data();
+    buffer.setPolygons(std::move(triangles), 3);
+    ASSERT_EQ(2, buffer.size());
+    EXPECT_TRUE(buffer.isTriangleMesh());
+    EXPECT_EQ(data, buffer.indices.data());
+    EXPECT_EQ(6, buffer.offsets.back());
+
+    buffer.clearPolygons();
+    EXPECT_TRUE(buffer.empty());
+    EXPECT_TRUE(buffer.indices.empty());
+}
+
+TEST(PolygonMeshBuffer, conversions)
+{
+    pcl::PointCloud<pcl::PointXYZ> points(6, 1);
+    PolygonMesh mesh;
+    pcl::toPCLPointCloud2(points, mesh.cloud);
+    mesh.header.seq = 7;
+    for (std::size_t i = 0; i < 4; ++i)
+    {
+        mesh.polygons.emplace_back();
+        for (std::size_t j = 0; j < 3 + i % 2; ++j)
+            mesh.polygons.back().vertices.emplace_back((i + j) % 6);
+    }
+
+    PolygonMeshBuffer buffer;
+    toPolygonMeshBuffer(mesh, buffer);
+    EXPECT_EQ(7, buffer.header.seq);
+    EXPECT_EQ(mesh.cloud.data, buffer.cloud.data);
+    ASSERT_EQ(mesh.polygons.size(), buffer.size());
+    EXPECT_EQ(14, buffer.indices.size());
+    for (std::size_t i = 0; i < mesh.polygons.size(); ++i)
+    {
+        ASSERT_EQ(mesh.polygons[i].vertices.size(), buffer.getPolygonSize(i));
+        for (std::size_t j = 0; j < mesh.polygons[i].vertices.size(); ++j)
+            EXPECT_EQ(mesh.polygons[i].vertices[j], buffer.getPolygon(i)[j]);
+    }
+
+    PolygonMesh converted;
+    toPolygonMesh(buffer, converted);
+    EXPECT_EQ(mesh.cloud.data, converted.cloud.data);
+    ASSERT_EQ(mesh.polygons.size(), converted.polygons.size());
+    for (std::size_t i = 0; i < mesh.polygons.size(); ++i)
+        EXPECT_EQ_VECTORS(mesh.polygons[i].vertices, converted.polygons[i].vertices);
+
+    // The rvalue conversions take over the point data
+    const std::uint8_t* data = buffer.cloud.data.data();
+    PolygonMesh moved;
+    toPolygonMesh(std::move(buffer), moved);
+    EXPECT_EQ(data, moved.cloud.data.data());
+    EXPECT_TRUE(buffer.empty());
+    ASSERT_EQ(mesh.polygons.size(), moved.polygons.size());
+
+    PolygonMeshBuffer moved_buffer;
+    toPolygonMeshBuffer(std::move(moved), moved_buffer);
+    EXPECT_EQ(data, moved_buffer.cloud.data.data());
+    EXPECT_EQ(14, moved_buffer.indices.size());
+    EXPECT_TRUE(moved.polygons.empty());
+}
+
 int
 main(int argc, char** argv)
 {
@@ -0,0 +1,129 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2019-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <pcl/test/gtest.h>
+#include <pcl/common/trace.h>
+
+#include <sstream>
+#include <string>
+#include <thread>
+
+namespace
+{
+  std::size_t
+  countOccurrences (const std::string &text, const std::string &pattern)
+  {
+    std::size_t count = 0;
+    for (std::size_t pos = text.find (pattern); pos != std::string::npos; pos = text.find (pattern, pos + 1))
+      ++count;
+    return (count);
+  }
+
+  std::string
+  chromeTrace ()
+  {
+    std::ostringstream os;
+    pcl::trace::writeChromeTrace (os);
+    return (os.str ());
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, TraceNotRecording)
+{
+  pcl::trace::clear ();
+  ASSERT_FALSE (pcl::trace::isRecording ());
+  {
+    pcl::trace::Zone zone ("ignored");
+    pcl::trace::counter ("ignored counter", 1.0);
+  }
+  EXPECT_EQ (0, countOccurrences (chromeTrace (), "ignored"));
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, TraceZonesAndCounters)
+{
+  pcl::trace::clear ();
+  pcl::trace::start ();
+  EXPECT_TRUE (pcl::trace::isRecording ());
+  pcl::trace::setThreadName ("main \"thread\"");
+  {
+    pcl::trace::Zone outer ("outer");
+    pcl::trace::Zone inner (std::string ("inner"));
+    pcl::trace::counter ("points", 42);
+  }
+  std::thread worker ([] ()
+  {
+    pcl::trace::setThreadName ("worker");
+    pcl::trace::Zone zone ("work");
+  });
+  worker.join ();
+  pcl::trace::stop ();
+  {
+    pcl::trace::Zone zone ("after stop");
+  }
+
+  const std::string trace = chromeTrace ();
+  EXPECT_EQ (0, trace.find ("{\"displayTimeUnit\":\"ms\",\"traceEvents\":["));
+  EXPECT_EQ (3, countOccurrences (trace, "\"ph\":\"X\""));
+  EXPECT_EQ (1, countOccurrences (trace, "\"name\":\"outer\""));
+  EXPECT_EQ (1, countOccurrences (trace, "\"name\":\"inner\""));
+  EXPECT_EQ (1, countOccurrences (trace, "\"name\":\"work\""));
+  EXPECT_EQ (0, countOccurrences (trace, "after stop"));
+  EXPECT_EQ (1, countOccurrences (trace, "\"ph\":\"C\""));
+  EXPECT_EQ (1, countOccurrences (trace, "\"args\":{\"value\":42}"));
+  EXPECT_EQ (1, countOccurrences (trace, "\"args\":{\"name\":\"main \\\"thread\\\"\"}"));
+  EXPECT_EQ (1, countOccurrences (trace, "\"args\":{\"name\":\"worker\"}"));
+
+  // The zones of the worker are on their own thread
+  const std::size_t work = trace.find ("\"name\":\"work\"");
+  const std::size_t outer = trace.find ("\"name\":\"outer\"");
+  const std::string work_tid = trace.substr (trace.find ("\"tid\":", work), 8);
+  const std::string outer_tid = trace.substr (trace.find ("\"tid\":", outer), 8);
+  EXPECT_NE (work_tid, outer_tid);
+
+  pcl::trace::clear ();
+  EXPECT_EQ (0, countOccurrences (chromeTrace (), "\"ph\":\"X\""));
+}
+
+/* ---[ */
+int
+main (int argc, char** argv)
+{
+  testing::InitGoogleTest (&argc, argv);
+  return (RUN_ALL_TESTS ());
+}
+/* ]--- */
@@ -44,6 +44,7 @@
 #include <pcl/point_types.h>
 #include <pcl/point_cloud.h>
 #include <pcl/common/transforms.h>
+#include <pcl/common/cpu_dispatch.h>
 #include <pcl/common/io.h>
 
 #include <pcl/pcl_tests.h>
@@ -211,6 +212,59 @@ TYPED_TEST (Transforms, PointCloudXYZRGBNormalDenseIndexed)
   }
 }
 
+TYPED_TEST (Transforms, PointCloudBatched)
+{
+  using Scalar = typename TestFixture::Scalar;
+  const Eigen::Matrix<Scalar, 4, 4> matrix = this->tf.matrix ();
+  const pcl::detail::Transformer<Scalar> transformer (matrix);
+
+  // Sizes around the batch sizes of the vectorized kernels, and one large enough to be split over threads
+  for (const std::size_t size : std::vector<std::size_t> {1, 7, 8, 9, 15, 16, 17, 33, 100000})
+  {
+    pcl::PointCloud<pcl::PointXYZ> p_xyz, p_xyz_expected;
+    pcl::PointCloud<pcl::PointXYZRGBNormal> p_xyz_normal, p_xyz_normal_expected;
+    for (std::size_t i = 0; i < size; ++i)
+    {
+      pcl::PointXYZRGBNormal point;
+      point.getVector3fMap () = Eigen::Vector3f::Random () * 10.0f;
+      point.rgba = static_cast<std::uint32_t> (i);
+      p_xyz_normal.push_back (point);
+      p_xyz.emplace_back (point.x, point.y, point.z);
+      transformer.se3 (point.data, point.data);
+      p_xyz_normal_expected.push_back (point);
+      p_xyz_expected.emplace_back (point.x, point.y, point.z);
+    }
+
+    // Every kernel the CPU supports
+    for (int level = 0; level <= static_cast<int> (pcl::getSupportedSIMDLevel ()); ++level)
+    {
+      pcl::setSIMDLevel (static_cast<pcl::SIMDLevel> (level));
+      for (const unsigned int nr_threads : {1, 4})
+      {
+        pcl::PointCloud<pcl::PointXYZ> p;
+        pcl::transformPointCloud (p_xyz, p, this->tf, true, nr_threads);
+        ASSERT_EQ (p.size (), size);
+        for (std::size_t i = 0; i < size; ++i)
+        {
+          ASSERT_XYZ_NEAR (p[i], p_xyz_expected[i], 1e-6);
+          ASSERT_EQ (p[i].data[3], 1.0f);
+        }
+
+        // Padded points, in place
+        pcl::PointCloud<pcl::PointXYZRGBNormal> p_normal = p_xyz_normal;
+        pcl::transformPointCloud (p_normal, p_normal, this->tf, true, nr_threads);
+        ASSERT_EQ (p_normal.size (), size);
+        for (std::size_t i = 0; i < size; ++i)
+        {
+          ASSERT_XYZ_NEAR (p_normal[i], p_xyz_normal_expected[i], 1e-6);
+          ASSERT_EQ (p_normal[i].rgba, p_xyz_normal[i].rgba);
+        }
+      }
+    }
+    pcl::setSIMDLevel (pcl::getSupportedSIMDLevel ());
+  }
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////
 TEST (PCL, Matrix4Affine3Transform)
 {
@@ -41,6 +41,7 @@
 #include <pcl/point_cloud.h>
 #include <pcl/features/normal_3d.h>
 #include <pcl/features/boundary.h>
+#include <pcl/features/boundary_omp.h>
 #include <pcl/io/pcd_io.h>
 
 using namespace pcl;
@@ -128,6 +129,41 @@ TEST (PCL, BoundaryEstimation)
   EXPECT_TRUE (pt);
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, BoundaryEstimationOMP)
+{
+  NormalEstimation<PointXYZ, Normal> n;
+  PointCloud<Normal>::Ptr normals (new PointCloud<Normal> ());
+  n.setInputCloud (cloud.makeShared ());
+  n.setSearchMethod (tree);
+  n.setKSearch (10);
+  n.compute (*normals);
+
+  BoundaryEstimation<PointXYZ, Normal, Boundary> b;
+  BoundaryEstimationOMP<PointXYZ, Normal, Boundary> b_omp (4);
+  for (auto* est : {&b, static_cast<BoundaryEstimation<PointXYZ, Normal, Boundary>*> (&b_omp)})
+  {
+    est->setInputCloud (cloud.makeShared ());
+    est->setInputNormals (normals);
+    est->setSearchMethod (tree);
+    est->setKSearch (20);
+  }
+
+  PointCloud<Boundary> bps, bps_omp;
+  b.compute (bps);
+  b_omp.compute (bps_omp);
+
+  ASSERT_EQ (bps_omp.size (), bps.size ());
+  EXPECT_EQ (bps_omp.is_dense, bps.is_dense);
+  std::size_t nr_boundary_points = 0;
+  for (std::size_t i = 0; i < bps.size (); ++i)
+  {
+    EXPECT_EQ (bps_omp[i].boundary_point, bps[i].boundary_point);
+    nr_boundary_points += bps[i].boundary_point;
+  }
+  EXPECT_GT (nr_boundary_points, 0u);
+}
+
 /* ---[ */
 int
 main (int argc, char** argv)
@@ -41,6 +41,7 @@
 #include <pcl/point_cloud.h>
 #include <pcl/features/normal_3d.h>
 #include <pcl/features/principal_curvatures.h>
+#include <pcl/features/principal_curvatures_omp.h>
 #include <pcl/io/pcd_io.h>
 
 using namespace pcl;
@@ -142,6 +143,41 @@ TEST (PCL, PrincipalCurvaturesEstimation)
   EXPECT_NEAR ((*pcs)[indices.size () - 1].pc2, 0.17906941473484039, 1e-4);
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, PrincipalCurvaturesEstimationOMP)
+{
+  NormalEstimation<PointXYZ, Normal> n;
+  PointCloud<Normal>::Ptr normals (new PointCloud<Normal> ());
+  n.setInputCloud (cloud.makeShared ());
+  n.setSearchMethod (tree);
+  n.setKSearch (10);
+  n.compute (*normals);
+
+  PrincipalCurvaturesEstimation<PointXYZ, Normal, PrincipalCurvatures> pc;
+  PrincipalCurvaturesEstimationOMP<PointXYZ, Normal, PrincipalCurvatures> pc_omp (4);
+  for (auto* est : {&pc, static_cast<PrincipalCurvaturesEstimation<PointXYZ, Normal, PrincipalCurvatures>*> (&pc_omp)})
+  {
+    est->setInputCloud (cloud.makeShared ());
+    est->setInputNormals (normals);
+    est->setSearchMethod (tree);
+    est->setKSearch (20);
+  }
+
+  PointCloud<PrincipalCurvatures> pcs, pcs_omp;
+  pc.compute (pcs);
+  pc_omp.compute (pcs_omp);
+
+  ASSERT_EQ (pcs_omp.size (), pcs.size ());
+  EXPECT_EQ (pcs_omp.is_dense, pcs.is_dense);
+  for (std::size_t i = 0; i < pcs.size (); ++i)
+  {
+    for (int d = 0; d < 3; ++d)
+      EXPECT_EQ (pcs_omp[i].principal_curvature[d], pcs[i].principal_curvature[d]);
+    EXPECT_EQ (pcs_omp[i].pc1, pcs[i].pc1);
+    EXPECT_EQ (pcs_omp[i].pc2, pcs[i].pc2);
+  }
+}
+
 /* ---[ */
 int
 main (int argc, char** argv)
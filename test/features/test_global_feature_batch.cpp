@@ -0,0 +1,187 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2019-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <pcl/test/gtest.h>
+#include <pcl/point_cloud.h>
+#include <pcl/common/io.h>
+#include <pcl/features/esf.h>
+#include <pcl/features/global_feature_batch.h>
+#include <pcl/features/normal_3d.h>
+#include <pcl/features/our_cvfh.h>
+#include <pcl/features/vfh.h>
+#include <pcl/io/pcd_io.h>
+
+#include <algorithm>
+#include <numeric>
+
+using namespace pcl;
+
+PointCloud<PointXYZ>::Ptr cloud (new PointCloud<PointXYZ>);
+PointCloud<Normal>::Ptr normals (new PointCloud<Normal>);
+std::vector<PointIndices> clusters;
+
+// Compute the descriptor of one cluster on its own, as a recognition pipeline would without the batch API
+template <typename FeatureT, typename DescriptorT> void
+computeSerially (FeatureT &estimator, const PointIndices &cluster, PointCloud<DescriptorT> &descriptor)
+{
+  PointCloud<PointXYZ>::Ptr cluster_cloud (new PointCloud<PointXYZ>);
+  copyPointCloud (*cloud, cluster, *cluster_cloud);
+  estimator.setInputCloud (cluster_cloud);
+  estimator.setSearchMethod (search::KdTree<PointXYZ>::Ptr (new search::KdTree<PointXYZ>));
+  estimator.compute (descriptor);
+}
+
+template <typename DescriptorT> void
+expectEqualDescriptors (const PointCloud<DescriptorT> &a, const PointCloud<DescriptorT> &b)
+{
+  ASSERT_EQ (a.size (), b.size ());
+  for (std::size_t i = 0; i < a.size (); ++i)
+    for (int d = 0; d < DescriptorT::descriptorSize (); ++d)
+      EXPECT_EQ (a[i].histogram[d], b[i].histogram[d]);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, ESFEstimationBatch)
+{
+  ESFEstimation<PointXYZ, ESFSignature640> esf;
+  esf.setSeed (42);
+
+  PointCloud<ESFSignature640>::CloudVectorType descriptors, descriptors_single_thread;
+  computeGlobalFeatures (esf, *cloud, clusters, descriptors, 4);
+  computeGlobalFeatures (esf, *cloud, clusters, descriptors_single_thread, 1);
+  ASSERT_EQ (clusters.size (), descriptors.size ());
+
+  for (std::size_t i = 0; i < clusters.size (); ++i)
+  {
+    ASSERT_EQ (1, descriptors[i].size ());
+    // The sampling only depends on the seed, so the results are reproducible
+    expectEqualDescriptors (descriptors[i], descriptors_single_thread[i]);
+    PointCloud<ESFSignature640> descriptor;
+    computeSerially (esf, clusters[i], descriptor);
+    expectEqualDescriptors (descriptors[i], descriptor);
+  }
+
+  // Another seed samples other point triplets
+  esf.setSeed (43);
+  PointCloud<ESFSignature640> descriptor;
+  computeSerially (esf, clusters[0], descriptor);
+  EXPECT_FALSE (std::equal (descriptor[0].histogram, descriptor[0].histogram + 640, descriptors[0][0].histogram));
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, VFHEstimationBatch)
+{
+  VFHEstimation<PointXYZ, Normal, VFHSignature308> vfh;
+
+  PointCloud<VFHSignature308>::CloudVectorType descriptors;
+  computeGlobalFeatures (vfh, *cloud, *normals, clusters, descriptors, 4);
+  ASSERT_EQ (clusters.size (), descriptors.size ());
+
+  for (std::size_t i = 0; i < clusters.size (); ++i)
+  {
+    ASSERT_EQ (1, descriptors[i].size ());
+    PointCloud<Normal>::Ptr cluster_normals (new PointCloud<Normal>);
+    copyPointCloud (*normals, clusters[i], *cluster_normals);
+    vfh.setInputNormals (cluster_normals);
+    PointCloud<VFHSignature308> descriptor;
+    computeSerially (vfh, clusters[i], descriptor);
+    expectEqualDescriptors (descriptors[i], descriptor);
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, OURCVFHEstimationBatch)
+{
+  OURCVFHEstimation<PointXYZ, Normal, VFHSignature308> cvfh;
+  cvfh.setEPSAngleThreshold (0.13f);
+  cvfh.setCurvatureThreshold (0.025f);
+  cvfh.setClusterTolerance (0.015f);
+  cvfh.setNormalizeBins (false);
+  cvfh.setMinPoints (10);
+
+  PointCloud<VFHSignature308>::CloudVectorType descriptors;
+  computeGlobalFeatures (cvfh, *cloud, *normals, clusters, descriptors, 4);
+  ASSERT_EQ (clusters.size (), descriptors.size ());
+
+  for (std::size_t i = 0; i < clusters.size (); ++i)
+  {
+    PointCloud<Normal>::Ptr cluster_normals (new PointCloud<Normal>);
+    copyPointCloud (*normals, clusters[i], *cluster_normals);
+    cvfh.setInputNormals (cluster_normals);
+    PointCloud<VFHSignature308> descriptor;
+    computeSerially (cvfh, clusters[i], descriptor);
+    expectEqualDescriptors (descriptors[i], descriptor);
+  }
+}
+
+/* ---[ */
+int
+main (int argc, char** argv)
+{
+  if (argc < 2)
+  {
+    std::cerr << "No test file given. Please download `bun0.pcd` and pass its path to the test." << std::endl;
+    return (-1);
+  }
+
+  if (io::loadPCDFile<PointXYZ> (argv[1], *cloud) < 0)
+  {
+    std::cerr << "Failed to read test file. Please download `bun0.pcd` and pass its path to the test." << std::endl;
+    return (-1);
+  }
+
+  NormalEstimation<PointXYZ, Normal> n;
+  n.setInputCloud (cloud);
+  n.setSearchMethod (search::KdTree<PointXYZ>::Ptr (new search::KdTree<PointXYZ>));
+  n.setKSearch (10);
+  n.compute (*normals);
+
+  // Slice the bunny along x into clusters of different sizes
+  Indices order (cloud->size ());
+  std::iota (order.begin (), order.end (), 0);
+  std::sort (order.begin (), order.end (), [] (index_t a, index_t b) { return ((*cloud)[a].x < (*cloud)[b].x); });
+  const std::size_t bounds[] = {0, 60, 150, 280, cloud->size ()};
+  for (std::size_t c = 0; c + 1 < sizeof (bounds) / sizeof (bounds[0]); ++c)
+  {
+    PointIndices cluster;
+    cluster.indices.assign (order.begin () + bounds[c], order.begin () + bounds[c + 1]);
+    clusters.push_back (cluster);
+  }
+
+  testing::InitGoogleTest (&argc, argv);
+  return (RUN_ALL_TESTS ());
+}
+/* ]--- */
@@ -41,7 +41,10 @@
 #include <pcl/features/normal_3d.h>
 #include <pcl/features/integral_image_normal.h>
 
+#include <cmath>
 #include <iostream>
+#include <limits>
+#include <vector>
 
 using namespace pcl;
 
@@ -489,6 +492,124 @@ TEST (PCL, IINormalEstimationSimple3DGradient)
   }
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, IntegralImage3DMultiThreaded)
+{
+  const unsigned width = 317;
+  const unsigned height = 211;
+  const unsigned element_stride = 4;
+  const unsigned row_stride = width * element_stride;
+  std::vector<float> data (row_stride * height);
+  for (unsigned yIdx = 0; yIdx < height; ++yIdx)
+  {
+    for (unsigned xIdx = 0; xIdx < width; ++xIdx)
+    {
+      float* element = &data[row_stride * yIdx + xIdx * element_stride];
+      element[0] = static_cast<float> ((xIdx * 7 + yIdx * 3) % 13);
+      element[1] = static_cast<float> ((xIdx * yIdx) % 11);
+      element[2] = ((xIdx + yIdx) % 17 == 0) ? std::numeric_limits<float>::quiet_NaN () : static_cast<float> (yIdx % 5);
+      element[3] = 1.0f;
+    }
+  }
+
+  IntegralImage2D<float, 3> single_threaded (true);
+  IntegralImage2D<float, 3> multi_threaded (true);
+  multi_threaded.setNumberOfThreads (4);
+  single_threaded.setInput (&data[0], width, height, element_stride, row_stride);
+  multi_threaded.setInput (&data[0], width, height, element_stride, row_stride);
+
+  for (unsigned yIdx = 0; yIdx < height; yIdx += 7)
+  {
+    for (unsigned xIdx = 0; xIdx < width; xIdx += 5)
+    {
+      const unsigned window_width = std::min (9u, width - xIdx);
+      const unsigned window_height = std::min (9u, height - yIdx);
+      EXPECT_EQ (single_threaded.getFiniteElementsCount (xIdx, yIdx, window_width, window_height),
+                 multi_threaded.getFiniteElementsCount (xIdx, yIdx, window_width, window_height));
+      EXPECT_EQ (single_threaded.getFirstOrderSum (xIdx, yIdx, window_width, window_height),
+                 multi_threaded.getFirstOrderSum (xIdx, yIdx, window_width, window_height));
+      EXPECT_EQ (single_threaded.getSecondOrderSum (xIdx, yIdx, window_width, window_height),
+                 multi_threaded.getSecondOrderSum (xIdx, yIdx, window_width, window_height));
+    }
+  }
+
+  // the full image
+  IntegralImage2D<float, 3>::ElementType sum = multi_threaded.getFirstOrderSum (0, 0, width, height);
+  unsigned count = multi_threaded.getFiniteElementsCount (0, 0, width, height);
+  double expected_sum = 0;
+  unsigned expected_count = 0;
+  for (unsigned idx = 0; idx < width * height; ++idx)
+  {
+    const float* element = &data[idx * element_stride];
+    if (!std::isfinite (element[0] + element[1] + element[2]))
+      continue;
+    expected_sum += element[0];
+    ++expected_count;
+  }
+  EXPECT_EQ (expected_count, count);
+  EXPECT_DOUBLE_EQ (expected_sum, sum[0]);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, IINormalEstimationMultiThreaded)
+{
+  PointCloud<PointXYZ>::Ptr wavy (new PointCloud<PointXYZ> (160, 120));
+  for (std::size_t v = 0; v < wavy->height; ++v)
+  {
+    for (std::size_t u = 0; u < wavy->width; ++u)
+    {
+      PointXYZ &point = (*wavy) (u, v);
+      point.x = static_cast<float> (u) * 0.01f;
+      point.y = static_cast<float> (v) * 0.01f;
+      point.z = 1.0f + 0.05f * std::sin (point.x * 20.0f) * std::cos (point.y * 15.0f);
+      if ((u * 31 + v * 17) % 97 == 0)
+        point.z = std::numeric_limits<float>::quiet_NaN ();
+    }
+  }
+  wavy->is_dense = false;
+
+  const IntegralImageNormalEstimation<PointXYZ, Normal>::NormalEstimationMethod methods[] =
+    {ne.COVARIANCE_MATRIX, ne.AVERAGE_3D_GRADIENT, ne.AVERAGE_DEPTH_CHANGE};
+  const IntegralImageNormalEstimation<PointXYZ, Normal>::BorderPolicy policies[] =
+    {ne.BORDER_POLICY_IGNORE, ne.BORDER_POLICY_MIRROR};
+
+  for (const auto &method : methods)
+  {
+    for (const auto &policy : policies)
+    {
+      for (const bool depth_dependent : {false, true})
+      {
+        PointCloud<Normal> output_single, output_multi;
+        IntegralImageNormalEstimation<PointXYZ, Normal> single_threaded, multi_threaded;
+        multi_threaded.setNumberOfThreads (4);
+        for (auto *estimator : {&single_threaded, &multi_threaded})
+        {
+          estimator->setNormalEstimationMethod (method);
+          estimator->setBorderPolicy (policy);
+          estimator->setDepthDependentSmoothing (depth_dependent);
+          estimator->setNormalSmoothingSize (5.0f);
+          estimator->setInputCloud (wavy);
+        }
+        single_threaded.compute (output_single);
+        multi_threaded.compute (output_multi);
+
+        ASSERT_EQ (output_single.size (), output_multi.size ());
+        for (std::size_t idx = 0; idx < output_single.size (); ++idx)
+        {
+          const Normal &a = output_single[idx];
+          const Normal &b = output_multi[idx];
+          ASSERT_EQ (std::isfinite (a.normal_x), std::isfinite (b.normal_x));
+          if (!std::isfinite (a.normal_x))
+            continue;
+          EXPECT_FLOAT_EQ (a.normal_x, b.normal_x);
+          EXPECT_FLOAT_EQ (a.normal_y, b.normal_y);
+          EXPECT_FLOAT_EQ (a.normal_z, b.normal_z);
+        }
+      }
+    }
+  }
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 TEST (PCL, IINormalEstimationSimple3DGradientUnorganized)
 {
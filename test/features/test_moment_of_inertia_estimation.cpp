@@ -106,6 +106,64 @@ TEST (MomentOfInertia, InvalidParameters)
   EXPECT_LT (0.0f, point_mass);
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (MomentOfInertia, SecondMoments)
+{
+  pcl::MomentOfInertiaEstimation <pcl::PointXYZ> feature_extractor;
+  feature_extractor.setInputCloud (cloud);
+  feature_extractor.setAngleStep (5.0f);
+  feature_extractor.compute ();
+
+  pcl::MomentOfInertiaEstimation <pcl::PointXYZ> feature_extractor_moments;
+  feature_extractor_moments.setInputCloud (cloud);
+  feature_extractor_moments.setAngleStep (5.0f);
+  feature_extractor_moments.setUseSecondMoments (true);
+  feature_extractor_moments.setNumberOfThreads (4);
+  EXPECT_TRUE (feature_extractor_moments.getUseSecondMoments ());
+  feature_extractor_moments.compute ();
+
+  Eigen::Vector3f mass_center, mass_center_moments;
+  EXPECT_TRUE (feature_extractor.getMassCenter (mass_center));
+  EXPECT_TRUE (feature_extractor_moments.getMassCenter (mass_center_moments));
+  for (int i = 0; i < 3; ++i)
+    EXPECT_NEAR (mass_center (i), mass_center_moments (i), 1e-4);
+
+  pcl::PointXYZ min_point, max_point, min_point_moments, max_point_moments;
+  feature_extractor.getAABB (min_point, max_point);
+  feature_extractor_moments.getAABB (min_point_moments, max_point_moments);
+  EXPECT_EQ (min_point.getVector3fMap (), min_point_moments.getVector3fMap ());
+  EXPECT_EQ (max_point.getVector3fMap (), max_point_moments.getVector3fMap ());
+
+  float major, middle, minor, major_moments, middle_moments, minor_moments;
+  feature_extractor.getEigenValues (major, middle, minor);
+  feature_extractor_moments.getEigenValues (major_moments, middle_moments, minor_moments);
+  EXPECT_NEAR (major, major_moments, 1e-4 * major);
+  EXPECT_NEAR (middle, middle_moments, 1e-4 * major);
+  EXPECT_NEAR (minor, minor_moments, 1e-4 * major);
+
+  pcl::PointXYZ position, position_moments;
+  Eigen::Matrix3f rotation, rotation_moments;
+  feature_extractor.getOBB (min_point, max_point, position, rotation);
+  feature_extractor_moments.getOBB (min_point_moments, max_point_moments, position_moments, rotation_moments);
+  EXPECT_TRUE (min_point.getVector3fMap ().isApprox (min_point_moments.getVector3fMap (), 1e-3f));
+  EXPECT_TRUE (max_point.getVector3fMap ().isApprox (max_point_moments.getVector3fMap (), 1e-3f));
+  EXPECT_TRUE (rotation.isApprox (rotation_moments, 1e-3f));
+
+  std::vector <float> moment_of_inertia, moment_of_inertia_moments;
+  std::vector <float> eccentricity, eccentricity_moments;
+  feature_extractor.getMomentOfInertia (moment_of_inertia);
+  feature_extractor_moments.getMomentOfInertia (moment_of_inertia_moments);
+  feature_extractor.getEccentricity (eccentricity);
+  feature_extractor_moments.getEccentricity (eccentricity_moments);
+  ASSERT_EQ (moment_of_inertia.size (), moment_of_inertia_moments.size ());
+  ASSERT_EQ (eccentricity.size (), eccentricity_moments.size ());
+  for (std::size_t i = 0; i < moment_of_inertia.size (); ++i)
+  {
+    EXPECT_NEAR (moment_of_inertia[i], moment_of_inertia_moments[i], 1e-3 * moment_of_inertia[i]);
+    EXPECT_NEAR (eccentricity[i], eccentricity_moments[i], 1e-3);
+  }
+}
+
 /* ---[ */
 int
 main (int argc, char** argv)
@@ -0,0 +1,219 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include <pcl/test/gtest.h>
+#include <pcl/point_cloud.h>
+#include <pcl/features/neighborhood_cache.h>
+#include <pcl/features/normal_3d_omp.h>
+#include <pcl/features/fpfh_omp.h>
+#include <pcl/features/boundary.h>
+#include <pcl/io/pcd_io.h>
+#include <pcl/search/kdtree.h>
+
+using namespace pcl;
+using namespace pcl::io;
+
+using KdTreePtr = search::KdTree<PointXYZ>::Ptr;
+
+PointCloud<PointXYZ>::Ptr cloud;
+KdTreePtr tree;
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, NeighborhoodCacheCompute)
+{
+  pcl::Indices indices;
+  for (std::size_t i = 0; i < cloud->size (); i += 2)
+    indices.push_back (static_cast<index_t> (i));
+
+  NeighborhoodCache cache;
+  cache.compute (*tree, *cloud, indices, 0, 10);
+  EXPECT_FALSE (cache.empty ());
+  EXPECT_TRUE (cache.matches (*cloud, *cloud, 0, 10));
+  EXPECT_FALSE (cache.matches (*cloud, *cloud, 0, 11));
+  EXPECT_FALSE (cache.matches (*cloud, *cloud, 0.01, 0));
+  ASSERT_EQ (cache.getOffsets ().size (), cloud->size () + 1);
+  EXPECT_EQ (cache.getIndices ().size (), indices.size () * 10);
+
+  pcl::Indices nn_indices, cached_indices;
+  std::vector<float> nn_dists, cached_dists;
+  for (std::size_t i = 0; i < cloud->size (); ++i)
+  {
+    if (i % 2 == 1)
+    {
+      EXPECT_FALSE (cache.contains (static_cast<index_t> (i)));
+      EXPECT_FALSE (cache.getNeighbors (static_cast<index_t> (i), cached_indices, cached_dists));
+      continue;
+    }
+    ASSERT_TRUE (cache.getNeighbors (static_cast<index_t> (i), cached_indices, cached_dists));
+    tree->nearestKSearch (*cloud, static_cast<index_t> (i), 10, nn_indices, nn_dists);
+    EXPECT_EQ (cached_indices, nn_indices);
+    EXPECT_EQ (cached_dists, nn_dists);
+  }
+  EXPECT_FALSE (cache.contains (-1));
+  EXPECT_FALSE (cache.contains (static_cast<index_t> (cloud->size ())));
+
+  cache.clear ();
+  EXPECT_TRUE (cache.empty ());
+  EXPECT_FALSE (cache.matches (*cloud, *cloud, 0, 10));
+
+  // Exactly one search parameter must be given
+  cache.compute (*tree, *cloud, indices, 0.01, 10);
+  EXPECT_TRUE (cache.empty ());
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, NeighborhoodCacheChainedFeatures)
+{
+  // Reference results, searching every time
+  PointCloud<Normal>::Ptr normals (new PointCloud<Normal>);
+  NormalEstimationOMP<PointXYZ, Normal> ne;
+  ne.setInputCloud (cloud);
+  ne.setSearchMethod (tree);
+  ne.setKSearch (10);
+  ne.compute (*normals);
+
+  PointCloud<FPFHSignature33> fpfhs;
+  FPFHEstimationOMP<PointXYZ, Normal, FPFHSignature33> fpfh;
+  fpfh.setInputCloud (cloud);
+  fpfh.setInputNormals (normals);
+  fpfh.setSearchMethod (tree);
+  fpfh.setKSearch (10);
+  fpfh.compute (fpfhs);
+
+  PointCloud<Boundary> boundaries;
+  BoundaryEstimation<PointXYZ, Normal, Boundary> be;
+  be.setInputCloud (cloud);
+  be.setInputNormals (normals);
+  be.setSearchMethod (tree);
+  be.setKSearch (10);
+  be.compute (boundaries);
+
+  // The same chain sharing one cache
+  NeighborhoodCache::Ptr cache (new NeighborhoodCache);
+  PointCloud<Normal>::Ptr cached_normals (new PointCloud<Normal>);
+  ne.setNeighborhoodCache (cache);
+  EXPECT_EQ (ne.getNeighborhoodCache (), cache);
+  ne.compute (*cached_normals);
+  EXPECT_TRUE (cache->matches (*cloud, *cloud, 0, 10));
+  const std::vector<std::size_t> offsets = cache->getOffsets ();
+
+  PointCloud<FPFHSignature33> cached_fpfhs;
+  fpfh.setInputNormals (cached_normals);
+  fpfh.setNeighborhoodCache (cache);
+  fpfh.compute (cached_fpfhs);
+
+  PointCloud<Boundary> cached_boundaries;
+  be.setInputNormals (cached_normals);
+  be.setNeighborhoodCache (cache);
+  be.compute (cached_boundaries);
+
+  // The cache was filled once and reused
+  EXPECT_EQ (cache->getOffsets (), offsets);
+
+  ASSERT_EQ (cached_normals->size (), normals->size ());
+  for (std::size_t i = 0; i < normals->size (); ++i)
+  {
+    EXPECT_EQ ((*cached_normals)[i].getNormalVector3fMap (), (*normals)[i].getNormalVector3fMap ());
+    EXPECT_EQ ((*cached_normals)[i].curvature, (*normals)[i].curvature);
+  }
+  ASSERT_EQ (cached_fpfhs.size (), fpfhs.size ());
+  for (std::size_t i = 0; i < fpfhs.size (); ++i)
+    for (int j = 0; j < 33; ++j)
+      EXPECT_EQ (cached_fpfhs[i].histogram[j], fpfhs[i].histogram[j]);
+  ASSERT_EQ (cached_boundaries.size (), boundaries.size ());
+  for (std::size_t i = 0; i < boundaries.size (); ++i)
+    EXPECT_EQ (cached_boundaries[i].boundary_point, boundaries[i].boundary_point);
+
+  // Other search parameters refill the cache
+  be.setKSearch (0);
+  be.setRadiusSearch (0.01);
+  be.compute (cached_boundaries);
+  EXPECT_TRUE (cache->matches (*cloud, *cloud, 0.01, 0));
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, NeighborhoodCachePartial)
+{
+  // Points missing from the cache are searched as usual
+  pcl::IndicesPtr half (new pcl::Indices);
+  for (std::size_t i = 0; i < cloud->size (); i += 2)
+    half->push_back (static_cast<index_t> (i));
+
+  NeighborhoodCache::Ptr cache (new NeighborhoodCache);
+  PointCloud<Normal> normals, half_normals, cached_normals;
+  NormalEstimationOMP<PointXYZ, Normal> ne;
+  ne.setInputCloud (cloud);
+  ne.setSearchMethod (tree);
+  ne.setKSearch (10);
+  ne.compute (normals);
+
+  ne.setIndices (half);
+  ne.setNeighborhoodCache (cache);
+  ne.compute (half_normals);
+  EXPECT_EQ (half_normals.size (), half->size ());
+
+  ne.setIndices (pcl::IndicesPtr ());
+  ne.compute (cached_normals);
+  ASSERT_EQ (cached_normals.size (), normals.size ());
+  for (std::size_t i = 0; i < normals.size (); ++i)
+    EXPECT_EQ (cached_normals[i].getNormalVector3fMap (), normals[i].getNormalVector3fMap ());
+}
+
+/* ---[ */
+int
+main (int argc, char** argv)
+{
+  if (argc < 2)
+  {
+    std::cerr << "No test file given. Please download `bun0.pcd` and pass its path to the test." << std::endl;
+    return (-1);
+  }
+
+  cloud.reset (new PointCloud<PointXYZ>);
+  if (loadPCDFile<PointXYZ> (argv[1], *cloud) < 0)
+  {
+    std::cerr << "Failed to read test file. Please download `bun0.pcd` and pass its path to the test." << std::endl;
+    return (-1);
+  }
+
+  tree.reset (new search::KdTree<PointXYZ> (false));
+  tree->setInputCloud (cloud);
+
+  testing::InitGoogleTest (&argc, argv);
+  return (RUN_ALL_TESTS ());
+}
+/* ]--- */
@@ -42,6 +42,8 @@
 #include <pcl/common/utils.h> // pcl::utils::ignore
 #include <pcl/features/normal_3d.h>
 #include <pcl/features/normal_3d_omp.h>
+#include <pcl/features/multiscale_normal_3d_omp.h>
+#include <pcl/features/don.h>
 #include <pcl/features/integral_image_normal.h>
 #include <pcl/io/pcd_io.h>
 
@@ -271,6 +273,63 @@ TEST (PCL, NormalEstimationOpenMP)
   }
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, MultiscaleNormalEstimationOMP)
+{
+  const double radius_small = 0.01, radius_large = 0.04;
+  PointCloud<PointXYZ>::Ptr cloudptr = cloud.makeShared ();
+
+  // Reference: two separate normal estimations and the DoN of their results
+  PointCloud<Normal>::Ptr normals_small (new PointCloud<Normal> ()), normals_large (new PointCloud<Normal> ());
+  NormalEstimation<PointXYZ, Normal> n;
+  n.setInputCloud (cloudptr);
+  n.setSearchMethod (tree);
+  n.setRadiusSearch (radius_small);
+  n.compute (*normals_small);
+  n.setRadiusSearch (radius_large);
+  n.compute (*normals_large);
+
+  PointCloud<Normal> don;
+  DifferenceOfNormalsEstimation<PointXYZ, Normal, Normal> don_estimation;
+  don_estimation.setInputCloud (cloudptr);
+  don_estimation.setNormalScaleSmall (normals_small);
+  don_estimation.setNormalScaleLarge (normals_large);
+  ASSERT_TRUE (don_estimation.initCompute ());
+  don = *normals_small;
+  don_estimation.computeFeature (don);
+
+  MultiscaleNormalEstimationOMP<PointXYZ, Normal, Normal> mne (4);
+  mne.setInputCloud (cloudptr);
+  mne.setSearchMethod (tree);
+  mne.setRadii (radius_small, radius_large);
+  PointCloud<Normal> don_omp;
+  mne.compute (don_omp);
+
+  ASSERT_EQ (don_omp.size (), cloud.size ());
+  ASSERT_EQ (mne.getNormalsSmall ()->size (), cloud.size ());
+  ASSERT_EQ (mne.getNormalsLarge ()->size (), cloud.size ());
+  const auto expectNormalsNear = [] (const Normal &a, const Normal &b)
+  {
+    ASSERT_EQ (std::isfinite (a.curvature), std::isfinite (b.curvature));
+    if (!std::isfinite (a.curvature))
+      return;
+    for (int d = 0; d < 3; ++d)
+      EXPECT_NEAR (a.normal[d], b.normal[d], 1e-4);
+    EXPECT_NEAR (a.curvature, b.curvature, 1e-4);
+  };
+  for (std::size_t i = 0; i < cloud.size (); ++i)
+  {
+    expectNormalsNear ((*mne.getNormalsSmall ())[i], (*normals_small)[i]);
+    expectNormalsNear ((*mne.getNormalsLarge ())[i], (*normals_large)[i]);
+    expectNormalsNear (don_omp[i], don[i]);
+  }
+
+  // The small radius has to be below the large one
+  mne.setRadii (radius_large, radius_small);
+  mne.compute (don_omp);
+  EXPECT_TRUE (don_omp.empty ());
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // This tests the indexing issue from #3573
 // In certain cases when you used a subset of the indices
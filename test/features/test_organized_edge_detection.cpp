@@ -137,6 +137,46 @@ TEST_F(OrganizedPlaneDetectionTestFixture, OccludedAndOccludingEdges)
   EXPECT_EQ(occluded_indices, inner_perimeter_);
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST_F(OrganizedPlaneDetectionTestFixture, ThreadsAndReusedLabels)
+{
+  // Punch a hole into the inner square, so that its border gets NaN boundary edges
+  auto cloud = pcl::make_shared<pcl::PointCloud<pcl::PointXYZ>>(*cloud_);
+  for (auto row = 45; row < 55; ++row)
+    for (auto col = 45; col < 55; ++col)
+      cloud->at(col, row).z = std::numeric_limits<float>::quiet_NaN();
+
+  auto oed = pcl::OrganizedEdgeBase<pcl::PointXYZ, pcl::Label>();
+  oed.setInputCloud(cloud);
+  oed.setDepthDisconThreshold(SYNTHETIC_CLOUD_DEPTH_DISCONTINUITY /
+                              (SYNTHETIC_CLOUD_BASE_DEPTH * 1.1f));
+  oed.setMaxSearchNeighbors(8);
+
+  auto labels = pcl::PointCloud<pcl::Label>();
+  auto label_indices = std::vector<pcl::PointIndices>();
+  oed.setNumberOfThreads(1);
+  oed.compute(labels, label_indices);
+  EXPECT_EQ(labels.width, cloud->width);
+  EXPECT_EQ(labels.height, cloud->height);
+  // The hole is wider than the search distance, so its whole 12x12 ring is NaN boundary
+  EXPECT_EQ(label_indices[0].indices.size(), 44u);
+
+  // Labels and indices of a previous frame are overwritten, whatever the thread count
+  auto labels_reused = labels;
+  auto label_indices_reused = label_indices;
+  for (auto& label : labels_reused)
+    label.label = 31;
+  oed.setNumberOfThreads(4);
+  oed.compute(labels_reused, label_indices_reused);
+
+  ASSERT_EQ(labels_reused.size(), labels.size());
+  for (std::size_t i = 0; i < labels.size(); ++i)
+    EXPECT_EQ(labels_reused[i].label, labels[i].label);
+  ASSERT_EQ(label_indices_reused.size(), label_indices.size());
+  for (std::size_t i = 0; i < label_indices.size(); ++i)
+    EXPECT_EQ(label_indices_reused[i].indices, label_indices[i].indices);
+}
+
 /* ---[ */
 int
 main(int argc, char** argv)
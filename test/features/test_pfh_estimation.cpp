@@ -45,10 +45,13 @@
 #include <pcl/test/gtest.h>
 #include <pcl/point_cloud.h>
 #include <pcl/features/pfh.h>
+#include <pcl/features/pfh_omp.h>
 #include <pcl/features/fpfh.h>
 #include <pcl/features/fpfh_omp.h>
 #include <pcl/features/vfh.h>
 #include <pcl/features/gfpfh.h>
+#include <pcl/features/pfh_tools.h>
+#include <pcl/common/cpu_dispatch.h>
 #include <pcl/io/pcd_io.h>
 
 using PointT = pcl::PointNormal;
@@ -148,6 +151,44 @@ testIndicesAndSearchSurface (const typename PointCloud<PointT>::Ptr & points,
   }
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, computePairFeaturesBatch)
+{
+  // Pairs between a few points and the whole cloud, including the point itself and a copy of it
+  std::vector<float> x, y, z, nx, ny, nz;
+  for (const auto &point : *cloud)
+  {
+    x.push_back (point.x); y.push_back (point.y); z.push_back (point.z);
+    nx.push_back (point.normal_x); ny.push_back (point.normal_y); nz.push_back (point.normal_z);
+  }
+  const std::size_t count = x.size ();
+  std::vector<float> f1 (count), f2 (count), f3 (count), f4 (count);
+
+  const pcl::SIMDLevel original = pcl::getSIMDLevel ();
+  for (int level = 0; level <= static_cast<int> (pcl::getSupportedSIMDLevel ()); ++level)
+  {
+    pcl::setSIMDLevel (static_cast<pcl::SIMDLevel> (level));
+    SCOPED_TRACE (pcl::getSIMDLevelName (pcl::getSIMDLevel ()));
+    for (std::size_t p = 0; p < count; p += 97)
+    {
+      const Eigen::Vector4f p1 = (*cloud)[p].getVector4fMap (), n1 = (*cloud)[p].getNormalVector4fMap ();
+      pcl::computePairFeatures (p1, n1, x.data (), y.data (), z.data (), nx.data (), ny.data (), nz.data (), count,
+                                f1.data (), f2.data (), f3.data (), f4.data ());
+      for (std::size_t q = 0; q < count; ++q)
+      {
+        float g1, g2, g3, g4;
+        pcl::computePairFeatures (p1, n1, (*cloud)[q].getVector4fMap (), (*cloud)[q].getNormalVector4fMap (), g1, g2, g3, g4);
+        EXPECT_NEAR (f1[q], g1, 1e-4) << p << " " << q;
+        EXPECT_NEAR (f2[q], g2, 1e-4) << p << " " << q;
+        EXPECT_NEAR (f3[q], g3, 1e-4) << p << " " << q;
+        EXPECT_NEAR (f4[q], g4, 1e-6) << p << " " << q;
+      }
+      EXPECT_EQ (f4[p], 0.0f);
+    }
+  }
+  pcl::setSIMDLevel (original);
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 TEST (PCL, PFHEstimation)
 {
@@ -259,6 +300,53 @@ TEST (PCL, PFHEstimation)
   (cloud, cloud, test_indices, 125);
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, PFHEstimationOMP)
+{
+  using pcl::PFHSignature125;
+  const int k = 10;
+
+  pcl::PFHEstimation<PointT, PointT, PFHSignature125> pfh;
+  pfh.setInputCloud (cloud);
+  pfh.setInputNormals (cloud);
+  pfh.setSearchMethod (tree);
+  pfh.setKSearch (k);
+  PointCloud<PFHSignature125> reference;
+  pfh.compute (reference);
+
+  pcl::PFHEstimationOMP<PointT, PointT, PFHSignature125> pfh_omp (4);
+  pfh_omp.setInputCloud (cloud);
+  pfh_omp.setInputNormals (cloud);
+  pfh_omp.setSearchMethod (tree);
+  pfh_omp.setKSearch (k);
+  PointCloud<PFHSignature125> pfhs;
+  pfh_omp.compute (pfhs);
+
+  ASSERT_EQ (reference.size (), pfhs.size ());
+  EXPECT_EQ (reference.is_dense, pfhs.is_dense);
+  // A pair on the border between two bins may fall into the other bin due to rounding
+  const float pair_weight = 100.0f / (k * (k - 1) / 2);
+  for (std::size_t i = 0; i < pfhs.size (); ++i)
+  {
+    float difference = 0.0f, sum = 0.0f;
+    for (int d = 0; d < 125; ++d)
+    {
+      difference += std::abs (pfhs[i].histogram[d] - reference[i].histogram[d]);
+      sum += pfhs[i].histogram[d];
+    }
+    EXPECT_LE (difference, 2.0f * pair_weight + 1e-3f);
+    EXPECT_NEAR (sum, 100.0f, 1e-2f);
+  }
+
+  // Test results when setIndices and/or setSearchSurface are used
+  pcl::IndicesPtr test_indices (new pcl::Indices (0));
+  for (std::size_t i = 0; i < cloud->size (); i+=3)
+    test_indices->push_back (static_cast<int> (i));
+
+  testIndicesAndSearchSurface<pcl::PFHEstimationOMP, PointT, PointT, PFHSignature125>
+  (cloud, cloud, test_indices, 125);
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 using pcl::FPFHEstimation;
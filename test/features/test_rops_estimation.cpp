@@ -40,6 +40,7 @@
 #include <pcl/test/gtest.h>
 #include <pcl/point_cloud.h>
 #include <pcl/features/rops_estimation.h>
+#include <pcl/features/rops_estimation_omp.h>
 #include <pcl/io/pcd_io.h>
 
 pcl::PointCloud <pcl::PointXYZ>::Ptr cloud;
@@ -117,6 +118,40 @@ TEST (ROPSFeature, InvalidParameters)
   EXPECT_EQ (0, histograms->size ());
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (ROPSFeature, FeatureExtractionOMP)
+{
+  float support_radius = 0.0285f;
+
+  pcl::search::KdTree<pcl::PointXYZ>::Ptr search_method (new pcl::search::KdTree<pcl::PointXYZ>);
+  search_method->setInputCloud (cloud);
+
+  pcl::ROPSEstimation <pcl::PointXYZ, pcl::Histogram <135> > feature_estimator;
+  pcl::ROPSEstimationOMP <pcl::PointXYZ, pcl::Histogram <135> > feature_estimator_omp (4);
+  for (auto* estimator : {&feature_estimator, static_cast<pcl::ROPSEstimation <pcl::PointXYZ, pcl::Histogram <135> >*> (&feature_estimator_omp)})
+  {
+    estimator->setSearchMethod (search_method);
+    estimator->setSearchSurface (cloud);
+    estimator->setInputCloud (cloud);
+    estimator->setIndices (indices);
+    estimator->setTriangles (triangles);
+    estimator->setRadiusSearch (support_radius);
+    estimator->setNumberOfPartitionBins (5);
+    estimator->setNumberOfRotations (3);
+    estimator->setSupportRadius (support_radius);
+  }
+
+  pcl::PointCloud<pcl::Histogram <135> > histograms, histograms_omp;
+  feature_estimator.compute (histograms);
+  feature_estimator_omp.compute (histograms_omp);
+
+  ASSERT_EQ (indices->indices.size (), histograms.size ());
+  ASSERT_EQ (histograms.size (), histograms_omp.size ());
+  for (std::size_t i = 0; i < histograms.size (); ++i)
+    for (int j = 0; j < 135; ++j)
+      EXPECT_EQ (histograms[i].histogram[j], histograms_omp[i].histogram[j]);
+}
+
 /* ---[ */
 int
 main (int argc, char** argv)
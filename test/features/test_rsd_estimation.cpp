@@ -41,6 +41,7 @@
 #include <pcl/test/gtest.h>
 #include <pcl/point_cloud.h>
 #include <pcl/features/rsd.h>
+#include <pcl/features/rsd_omp.h>
 #include <pcl/features/normal_3d.h>
 #include <pcl/io/pcd_io.h>
 
@@ -116,6 +117,46 @@ TEST (PCL, RSDEstimation)
   
 }
 
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, RSDEstimationOMP)
+{
+  NormalEstimation<PointXYZ, Normal> n;
+  PointCloud<Normal>::Ptr normals (new PointCloud<Normal> ());
+  n.setInputCloud (cloud);
+  n.setSearchMethod (tree);
+  n.setRadiusSearch (0.02);
+  n.compute (*normals);
+
+  RSDEstimation<PointXYZ, Normal, PrincipalRadiiRSD> rsd;
+  RSDEstimationOMP<PointXYZ, Normal, PrincipalRadiiRSD> rsd_omp (4);
+  for (auto* est : {&rsd, static_cast<RSDEstimation<PointXYZ, Normal, PrincipalRadiiRSD>*> (&rsd_omp)})
+  {
+    est->setInputCloud (cloud);
+    est->setInputNormals (normals);
+    est->setPlaneRadius (0.1);
+    est->setSearchMethod (tree);
+    est->setRadiusSearch (0.03);
+    est->setSaveHistograms (true);
+  }
+
+  PointCloud<PrincipalRadiiRSD> rsds, rsds_omp;
+  rsd.compute (rsds);
+  rsd_omp.compute (rsds_omp);
+
+  ASSERT_EQ (rsds_omp.size (), rsds.size ());
+  for (std::size_t i = 0; i < rsds.size (); ++i)
+  {
+    EXPECT_EQ (rsds_omp[i].r_min, rsds[i].r_min);
+    EXPECT_EQ (rsds_omp[i].r_max, rsds[i].r_max);
+  }
+
+  auto mat = rsd.getHistograms ();
+  auto mat_omp = rsd_omp.getHistograms ();
+  ASSERT_EQ (mat_omp->size (), mat->size ());
+  for (std::size_t i = 0; i < mat->size (); ++i)
+    EXPECT_EQ ((*mat_omp)[i], (*mat)[i]);
+}
+
 /* ---[ */
 int
 main (int argc, char** argv)
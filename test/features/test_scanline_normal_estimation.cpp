@@ -0,0 +1,269 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include <pcl/test/gtest.h>
+#include <pcl/point_cloud.h>
+#include <pcl/point_types.h>
+#include <pcl/features/scanline_normal.h>
+
+#include <cmath>
+#include <limits>
+#include <vector>
+
+using namespace pcl;
+
+PointCloud<PointXYZ>::Ptr sweep (new PointCloud<PointXYZ>);
+// 0: no return, 1: ground plane, 2: cylindrical wall
+std::vector<int> surface;
+
+const float ground_height = -2.0f;
+const float wall_radius = 10.0f;
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+bool
+sameSurfaceWindow (int u, int v, int half_rows, int half_cols)
+{
+  const int label = surface[v * sweep->width + u];
+  for (int row = v - half_rows; row <= v + half_rows; ++row)
+    for (int col = u - half_cols; col <= u + half_cols; ++col)
+    {
+      if (row < 0 || row >= static_cast<int> (sweep->height) || col < 0 || col >= static_cast<int> (sweep->width))
+        return (false);
+      if (surface[row * sweep->width + col] != label)
+        return (false);
+    }
+  return (true);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, ScanlineNormalEstimation)
+{
+  ScanlineNormalEstimation<PointXYZ, Normal> ne;
+  ne.setInputCloud (sweep);
+  ne.setWrapAround (true);
+  PointCloud<Normal> normals;
+  ne.compute (normals);
+
+  ASSERT_EQ (normals.size (), sweep->size ());
+  EXPECT_EQ (normals.width, sweep->width);
+  EXPECT_EQ (normals.height, sweep->height);
+  EXPECT_FALSE (normals.is_dense);
+
+  int checked_ground = 0, checked_wall = 0;
+  for (int v = 0; v < static_cast<int> (sweep->height); ++v)
+  {
+    for (int u = 0; u < static_cast<int> (sweep->width); ++u)
+    {
+      const Normal &normal = normals (u, v);
+      const int label = surface[v * sweep->width + u];
+      if (label == 0)
+      {
+        EXPECT_TRUE (std::isnan (normal.normal_x));
+        EXPECT_TRUE (std::isnan (normal.curvature));
+        continue;
+      }
+      if (u < 2 || u >= static_cast<int> (sweep->width) - 2 || !sameSurfaceWindow (u, v, 1, 2))
+        continue;
+
+      ASSERT_TRUE (std::isfinite (normal.normal_x));
+      const PointXYZ &point = (*sweep) (u, v);
+      if (label == 1)
+      {
+        EXPECT_NEAR (normal.normal_x, 0.0f, 1e-3);
+        EXPECT_NEAR (normal.normal_y, 0.0f, 1e-3);
+        EXPECT_NEAR (normal.normal_z, 1.0f, 1e-3);
+        ++checked_ground;
+      }
+      else
+      {
+        // the wall normal points back towards the sensor
+        const float radius = std::sqrt (point.x * point.x + point.y * point.y);
+        EXPECT_NEAR (normal.normal_x, -point.x / radius, 1e-2);
+        EXPECT_NEAR (normal.normal_y, -point.y / radius, 1e-2);
+        EXPECT_NEAR (normal.normal_z, 0.0f, 1e-2);
+        ++checked_wall;
+      }
+      EXPECT_LT (normal.curvature, 1e-2);
+    }
+  }
+  EXPECT_GT (checked_ground, 0);
+  EXPECT_GT (checked_wall, 0);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, ScanlineNormalEstimationWrapAround)
+{
+  ScanlineNormalEstimation<PointXYZ, Normal> ne;
+  ne.setInputCloud (sweep);
+  PointCloud<Normal> normals_clamped, normals_wrapped;
+  ne.compute (normals_clamped);
+  ne.setWrapAround (true);
+  ne.compute (normals_wrapped);
+
+  // The wall is rotationally symmetric, so every column of a wall ring sees the same curvature as long as its
+  // window is complete. The first and last columns of a full sweep are neighbors, so only with wrap around
+  // do their windows match the ones in the middle of the ring.
+  const int v = 20;
+  const float reference = normals_wrapped (sweep->width / 2, v).curvature;
+  ASSERT_GT (reference, 0.0f);
+  EXPECT_NEAR (normals_wrapped (0, v).curvature, reference, 2e-2 * reference);
+  EXPECT_NEAR (normals_wrapped (sweep->width - 1, v).curvature, reference, 2e-2 * reference);
+  EXPECT_GT (std::abs (normals_clamped (0, v).curvature - reference), 0.2f * reference);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, ScanlineNormalEstimationIndicesAndThreads)
+{
+  ScanlineNormalEstimation<PointXYZ, Normal> ne;
+  ne.setInputCloud (sweep);
+  PointCloud<Normal> normals;
+  ne.compute (normals);
+
+  ScanlineNormalEstimation<PointXYZ, Normal> ne_omp (4);
+  ne_omp.setInputCloud (sweep);
+  PointCloud<Normal> normals_omp;
+  ne_omp.compute (normals_omp);
+  ASSERT_EQ (normals.size (), normals_omp.size ());
+  for (std::size_t i = 0; i < normals.size (); ++i)
+  {
+    if (std::isnan (normals[i].normal_x))
+    {
+      EXPECT_TRUE (std::isnan (normals_omp[i].normal_x));
+      continue;
+    }
+    EXPECT_EQ (normals[i].normal_x, normals_omp[i].normal_x);
+    EXPECT_EQ (normals[i].normal_y, normals_omp[i].normal_y);
+    EXPECT_EQ (normals[i].normal_z, normals_omp[i].normal_z);
+    EXPECT_EQ (normals[i].curvature, normals_omp[i].curvature);
+  }
+
+  pcl::IndicesPtr indices (new pcl::Indices);
+  for (std::size_t i = 0; i < sweep->size (); i += 7)
+    indices->push_back (static_cast<int> (i));
+  ne_omp.setIndices (indices);
+  PointCloud<Normal> normals_subset;
+  ne_omp.compute (normals_subset);
+  ASSERT_EQ (normals_subset.size (), indices->size ());
+  EXPECT_EQ (normals_subset.height, 1);
+  for (std::size_t i = 0; i < indices->size (); ++i)
+  {
+    const Normal &expected = normals[(*indices)[i]];
+    if (std::isnan (expected.normal_x))
+    {
+      EXPECT_TRUE (std::isnan (normals_subset[i].normal_x));
+      continue;
+    }
+    EXPECT_EQ (expected.normal_x, normals_subset[i].normal_x);
+    EXPECT_EQ (expected.normal_y, normals_subset[i].normal_y);
+    EXPECT_EQ (expected.normal_z, normals_subset[i].normal_z);
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, ScanlineNormalEstimationInvalidInput)
+{
+  ScanlineNormalEstimation<PointXYZ, Normal> ne;
+  PointCloud<Normal> normals;
+
+  PointCloud<PointXYZ>::Ptr unorganized (new PointCloud<PointXYZ> (*sweep));
+  unorganized->width = unorganized->size ();
+  unorganized->height = 1;
+  ne.setInputCloud (unorganized);
+  ne.compute (normals);
+  EXPECT_EQ (normals.size (), 0);
+
+  ne.setInputCloud (sweep);
+  ne.setWindowSize (3, 4);
+  ne.compute (normals);
+  EXPECT_EQ (normals.size (), 0);
+
+  ne.setWindowSize (3, 5);
+  ne.setMinNeighbors (2);
+  ne.compute (normals);
+  EXPECT_EQ (normals.size (), 0);
+}
+
+/* ---[ */
+int
+main (int argc, char** argv)
+{
+  // A synthetic 32 beam sweep: the lower rings hit the ground plane, the upper rings a cylindrical wall
+  // around the sensor and the top rings see nothing.
+  const int rings = 32;
+  const int columns = 720;
+  sweep->width = columns;
+  sweep->height = rings;
+  sweep->resize (rings * columns);
+  sweep->is_dense = false;
+  surface.resize (sweep->size ());
+  for (int v = 0; v < rings; ++v)
+  {
+    const float elevation = static_cast<float> (v - 15) * static_cast<float> (M_PI) / 180.0f;
+    for (int u = 0; u < columns; ++u)
+    {
+      const float azimuth = static_cast<float> (u) * 2.0f * static_cast<float> (M_PI) / static_cast<float> (columns);
+      const float dx = std::cos (elevation) * std::cos (azimuth);
+      const float dy = std::cos (elevation) * std::sin (azimuth);
+      const float dz = std::sin (elevation);
+
+      float range = wall_radius / std::cos (elevation);
+      int label = 2;
+      if (dz < 0 && ground_height / dz < range)
+      {
+        range = ground_height / dz;
+        label = 1;
+      }
+      if (v >= rings - 2)
+        label = 0;
+
+      PointXYZ &point = (*sweep) (u, v);
+      if (label == 0)
+        point.x = point.y = point.z = std::numeric_limits<float>::quiet_NaN ();
+      else
+      {
+        point.x = range * dx;
+        point.y = range * dy;
+        point.z = range * dz;
+      }
+      surface[v * columns + u] = label;
+    }
+  }
+
+  testing::InitGoogleTest (&argc, argv);
+  return (RUN_ALL_TESTS ());
+}
+/* ]--- */
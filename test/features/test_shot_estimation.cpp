@@ -45,7 +45,9 @@
 #include <pcl/features/shot_omp.h>
 #include "pcl/features/shot_lrf.h"
 #include <pcl/features/3dsc.h>
+#include <pcl/features/3dsc_omp.h>
 #include <pcl/features/usc.h>
+#include <pcl/features/usc_omp.h>
 
 using namespace pcl;
 using namespace pcl::io;
@@ -472,6 +474,59 @@ TYPED_TEST (SHOTShapeTest, Estimation)
   testSHOTLocalReferenceFrame<TypeParam, PointXYZ, Normal, SHOT352> (cloud.makeShared (), normals, test_indices);
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, SHOTEstimationOMPFastMode)
+{
+  // Estimate normals first
+  double mr = 0.002;
+  NormalEstimation<PointXYZ, Normal> n;
+  PointCloud<Normal>::Ptr normals (new PointCloud<Normal> ());
+  n.setInputCloud (cloud.makeShared ());
+  pcl::IndicesPtr indicesptr (new pcl::Indices (indices));
+  n.setIndices (indicesptr);
+  n.setSearchMethod (tree);
+  n.setRadiusSearch (20 * mr);
+  n.compute (*normals);
+
+  SHOTEstimationOMP<PointXYZ, Normal, SHOT352> shot;
+  shot.setInputNormals (normals);
+  shot.setRadiusSearch (20 * mr);
+  shot.setInputCloud (cloud.makeShared ());
+  shot.setIndices (indicesptr);
+  shot.setSearchMethod (tree);
+  EXPECT_FALSE (shot.getFastMode ());
+
+  PointCloud<SHOT352> shots_default, shots_fast;
+  shot.compute (shots_default);
+  shot.setFastMode (true);
+  EXPECT_TRUE (shot.getFastMode ());
+  shot.compute (shots_fast);
+  ASSERT_EQ (shots_fast.size (), shots_default.size ());
+
+  EXPECT_NEAR (shots_fast[103].descriptor[9 ], 0.0072018504, 1e-4);
+  EXPECT_NEAR (shots_fast[103].descriptor[20], 0.17439659, 1e-4);
+  EXPECT_NEAR (shots_fast[103].descriptor[21], 0.06542316, 1e-4);
+  EXPECT_NEAR (shots_fast[103].descriptor[55], 0.0050609680, 1e-4);
+
+  // Apart from the points whose local reference frame is ambiguous, the descriptors only differ by rounding
+  std::size_t nr_equal = 0;
+  for (std::size_t i = 0; i < shots_default.size (); ++i)
+  {
+    float max_difference = 0.0f;
+    for (int d = 0; d < 352; ++d)
+    {
+      const float a = shots_default[i].descriptor[d], b = shots_fast[i].descriptor[d];
+      if (std::isfinite (a) != std::isfinite (b))
+        max_difference = std::numeric_limits<float>::max ();
+      else if (std::isfinite (a))
+        max_difference = std::max (max_difference, std::abs (a - b));
+    }
+    if (max_difference < 1e-3f)
+      ++nr_equal;
+  }
+  EXPECT_GE (nr_equal, shots_default.size () * 98 / 100);
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 /*
 TEST (PCL, GenericSHOTShapeEstimation)
@@ -822,6 +877,100 @@ TEST (PCL, USCEstimation)
   testSHOTLocalReferenceFrame<UniqueShapeContext<PointXYZ, UniqueShapeContext1960>, PointXYZ, Normal, UniqueShapeContext1960> (cloud.makeShared (), normals, test_indices);
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, 3DSCEstimationOMP)
+{
+  float meshRes = 0.002f;
+  float radius = 20.0f * meshRes;
+
+  PointCloud<PointXYZ>::Ptr cloudptr = cloud.makeShared ();
+  NormalEstimation<PointXYZ, Normal> ne;
+  PointCloud<Normal>::Ptr normals (new PointCloud<Normal> ());
+  ne.setInputCloud (cloudptr);
+  ne.setSearchMethod (tree);
+  ne.setRadiusSearch (radius);
+  ne.compute (*normals);
+
+  // A subset of the points, so that only some of the surface points need a local point density
+  pcl::IndicesPtr test_indices (new pcl::Indices);
+  for (std::size_t i = 0; i < cloud.size (); i += 3)
+    test_indices->push_back (static_cast<int> (i));
+
+  ShapeContext3DEstimation<PointXYZ, Normal, ShapeContext1980> sc3d;
+  ShapeContext3DEstimationOMP<PointXYZ, Normal, ShapeContext1980> sc3d_omp (false, 4);
+  for (auto* est : {&sc3d, static_cast<ShapeContext3DEstimation<PointXYZ, Normal, ShapeContext1980>*> (&sc3d_omp)})
+  {
+    est->setInputCloud (cloudptr);
+    est->setInputNormals (normals);
+    est->setSearchMethod (tree);
+    est->setRadiusSearch (radius);
+    est->setMinimalRadius (radius / 10.0f);
+    est->setPointDensityRadius (radius / 5.0f);
+  }
+
+  // Twice, the random X axes of the second run continue the sequence of the first one
+  for (const auto &indices_to_use : {pcl::IndicesPtr (), test_indices})
+  {
+    sc3d.setIndices (indices_to_use);
+    sc3d_omp.setIndices (indices_to_use);
+    PointCloud<ShapeContext1980> sc3ds, sc3ds_omp;
+    sc3d.compute (sc3ds);
+    sc3d_omp.compute (sc3ds_omp);
+
+    ASSERT_EQ (sc3ds_omp.size (), sc3ds.size ());
+    EXPECT_EQ (sc3ds_omp.is_dense, sc3ds.is_dense);
+    for (std::size_t i = 0; i < sc3ds.size (); ++i)
+    {
+      for (int j = 0; j < 9; ++j)
+        EXPECT_EQ (sc3ds_omp[i].rf[j], sc3ds[i].rf[j]);
+      for (int j = 0; j < ShapeContext1980::descriptorSize (); ++j)
+        ASSERT_NEAR (sc3ds_omp[i].descriptor[j], sc3ds[i].descriptor[j], 1e-4f * std::max (1.0f, sc3ds[i].descriptor[j]));
+    }
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, USCEstimationOMP)
+{
+  float meshRes = 0.002f;
+  float radius = 20.0f * meshRes;
+
+  pcl::IndicesPtr test_indices (new pcl::Indices);
+  for (std::size_t i = 0; i < cloud.size (); i += 3)
+    test_indices->push_back (static_cast<int> (i));
+
+  UniqueShapeContext<PointXYZ, UniqueShapeContext1960> uscd;
+  UniqueShapeContextOMP<PointXYZ, UniqueShapeContext1960> uscd_omp (4);
+  for (auto* est : {&uscd, static_cast<UniqueShapeContext<PointXYZ, UniqueShapeContext1960>*> (&uscd_omp)})
+  {
+    est->setInputCloud (cloud.makeShared ());
+    est->setSearchMethod (tree);
+    est->setRadiusSearch (radius);
+    est->setMinimalRadius (radius / 10.0f);
+    est->setPointDensityRadius (radius / 5.0f);
+    est->setLocalRadius (radius);
+  }
+
+  for (const auto &indices_to_use : {pcl::IndicesPtr (), test_indices})
+  {
+    uscd.setIndices (indices_to_use);
+    uscd_omp.setIndices (indices_to_use);
+    PointCloud<UniqueShapeContext1960> uscds, uscds_omp;
+    uscd.compute (uscds);
+    uscd_omp.compute (uscds_omp);
+
+    ASSERT_EQ (uscds_omp.size (), uscds.size ());
+    EXPECT_EQ (uscds_omp.is_dense, uscds.is_dense);
+    for (std::size_t i = 0; i < uscds.size (); ++i)
+    {
+      for (int j = 0; j < 9; ++j)
+        EXPECT_NEAR (uscds_omp[i].rf[j], uscds[i].rf[j], 1e-5f);
+      for (int j = 0; j < UniqueShapeContext1960::descriptorSize (); ++j)
+        ASSERT_NEAR (uscds_omp[i].descriptor[j], uscds[i].descriptor[j], 1e-4f * std::max (1.0f, uscds[i].descriptor[j]));
+    }
+  }
+}
+
 /* ---[ */
 int
 main (int argc, char** argv)
@@ -42,6 +42,7 @@
 #include <pcl/features/normal_3d.h>
 #include <pcl/io/pcd_io.h>
 #include <pcl/features/spin_image.h>
+#include <pcl/features/spin_image_omp.h>
 #include <pcl/features/intensity_spin.h>
 
 using namespace pcl;
@@ -231,6 +232,54 @@ TEST (PCL, SpinImageEstimation)
   EXPECT_NEAR ((*spin_images)[300].histogram[144], 0.272542, 1e-4);
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, SpinImageEstimationOMP)
+{
+  double mr = 0.002;
+  NormalEstimation<PointXYZ, Normal> n;
+  PointCloud<Normal>::Ptr normals (new PointCloud<Normal> ());
+  n.setInputCloud (cloud.makeShared ());
+  n.setSearchMethod (tree);
+  n.setRadiusSearch (20 * mr);
+  n.compute (*normals);
+
+  using SpinImage = Histogram<153>;
+  SpinImageEstimation<PointXYZ, Normal, SpinImage> spin_est (8, 0.5, 16);
+  SpinImageEstimationOMP<PointXYZ, Normal, SpinImage> spin_est_omp (8, 0.5, 16, 4);
+  for (const bool is_radial : {true, false})
+  {
+    for (const bool is_angular : {false, true})
+    {
+      PointCloud<SpinImage> spin_images, spin_images_omp;
+      for (auto* est : {&spin_est, static_cast<SpinImageEstimation<PointXYZ, Normal, SpinImage>*> (&spin_est_omp)})
+      {
+        est->setInputCloud (cloud.makeShared ());
+        est->setInputNormals (normals);
+        est->setSearchMethod (tree);
+        est->setRadiusSearch (40 * mr);
+        est->setRadialStructure (is_radial);
+        est->setAngularDomain (is_angular);
+      }
+      spin_est.compute (spin_images);
+      spin_est_omp.compute (spin_images_omp);
+
+      ASSERT_EQ (spin_images_omp.size (), spin_images.size ());
+      for (std::size_t i = 0; i < spin_images.size (); ++i)
+        for (int j = 0; j < SpinImage::descriptorSize (); ++j)
+          ASSERT_EQ (spin_images_omp[i].histogram[j], spin_images[i].histogram[j]);
+    }
+  }
+
+  // Too few points in the support: the exception is rethrown out of the parallel region
+  SpinImageEstimationOMP<PointXYZ, Normal, SpinImage> spin_est_few (8, 0.5, static_cast<unsigned int> (cloud.size ()) + 1, 4);
+  spin_est_few.setInputCloud (cloud.makeShared ());
+  spin_est_few.setInputNormals (normals);
+  spin_est_few.setSearchMethod (tree);
+  spin_est_few.setRadiusSearch (40 * mr);
+  PointCloud<SpinImage> spin_images;
+  EXPECT_THROW (spin_est_few.compute (spin_images), PCLException);
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 TEST (PCL, IntensitySpinEstimation)
 {
@@ -49,6 +49,8 @@
 
 #include <pcl/common/eigen.h>
 
+#include <limits>
+
 using namespace pcl;
 using namespace Eigen;
 
@@ -769,6 +771,58 @@ TEST (CropBox, Filters)
 
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////
+TEST (CropBoxBatch, Filters)
+{
+  PointCloud<PointXYZ>::Ptr input (new PointCloud<PointXYZ> ());
+  srand (0);
+  for (int i = 0; i < 1000; i++)
+    input->push_back (PointXYZ (6.0f * rand () / RAND_MAX - 3.0f,
+                                6.0f * rand () / RAND_MAX - 3.0f,
+                                6.0f * rand () / RAND_MAX - 3.0f));
+  input->push_back (PointXYZ (std::numeric_limits<float>::quiet_NaN (), 0.0f, 0.0f));
+  input->is_dense = false;
+
+  CropBox<PointXYZ> cropBoxFilter;
+  cropBoxFilter.setInputCloud (input);
+  cropBoxFilter.setMin (Eigen::Vector4f (-0.5f, -1.0f, -0.3f, 1.0f));
+  cropBoxFilter.setMax (Eigen::Vector4f (0.5f, 0.7f, 0.3f, 1.0f));
+  Eigen::Affine3f transform;
+  pcl::getTransformation (0.1f, -0.2f, 0.3f, 0.2f, 0.1f, -0.3f, transform);
+  cropBoxFilter.setTransform (transform);
+
+  CropBox<PointXYZ>::BoxPoseVector box_poses;
+  std::vector<Eigen::Vector3f> translations, rotations;
+  for (int i = 0; i < 20; i++)
+  {
+    translations.emplace_back (0.1f * i - 1.0f, 0.05f * i, -0.07f * i);
+    rotations.emplace_back (0.1f * i, -0.2f * i, 0.05f * i);
+    Eigen::Affine3f rotation;
+    pcl::getTransformation (0, 0, 0, rotations.back () (0), rotations.back () (1), rotations.back () (2), rotation);
+    box_poses.push_back (Eigen::Translation3f (translations.back ()) * rotation);
+  }
+
+  for (const bool negative : {false, true})
+  {
+    cropBoxFilter.setNegative (negative);
+    std::vector<pcl::Indices> batch_indices;
+    cropBoxFilter.filter (box_poses, batch_indices);
+    ASSERT_EQ (box_poses.size (), batch_indices.size ());
+
+    std::size_t nr_inside = 0;
+    for (std::size_t i = 0; i < box_poses.size (); i++)
+    {
+      pcl::Indices indices;
+      cropBoxFilter.setTranslation (translations[i]);
+      cropBoxFilter.setRotation (rotations[i]);
+      cropBoxFilter.filter (indices);
+      EXPECT_EQ (indices, batch_indices[i]);
+      nr_inside += indices.size ();
+    }
+    EXPECT_GT (nr_inside, 0);
+  }
+}
+
 /* ---[ */
 int
 main (int argc, char** argv)
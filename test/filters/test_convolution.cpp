@@ -405,6 +405,53 @@ TEST (Convolution, convolveRowsXYZRGB)
   }
 }
 
+TEST (Convolution, convolveColsMatchesTransposedRows)
+{
+  Eigen::ArrayXf filter(5);
+  filter << 0.0545f, 0.2442f, 0.4026f, 0.2442f, 0.0545f;
+
+  auto input = pcl::make_shared<PointCloud<PointXYZI>>(37, 29);
+  auto transposed = pcl::make_shared<PointCloud<PointXYZI>>(29, 37);
+  for (std::uint32_t r = 0; r < input->height; r++)
+    for (std::uint32_t c = 0; c < input->width; c++)
+    {
+      PointXYZI& p = (*input) (c,r);
+      p.x = static_cast<float>(c) * 0.1f;
+      p.y = static_cast<float>(r) * 0.1f;
+      p.z = 2.0f + 0.05f * static_cast<float>((r * 7 + c * 3) % 11);
+      p.intensity = static_cast<float>((r * 13 + c * 5) % 17);
+      (*transposed) (r,c) = p;
+    }
+
+  pcl::filters::Convolution<PointXYZI, PointXYZI> convolve;
+  convolve.setKernel(filter);
+  convolve.setNumberOfThreads(2);
+  for (const bool dense : {true, false})
+  {
+    input->is_dense = transposed->is_dense = dense;
+    for (const int policy : {static_cast<int> (decltype(convolve)::BORDERS_POLICY_IGNORE),
+                             static_cast<int> (decltype(convolve)::BORDERS_POLICY_MIRROR),
+                             static_cast<int> (decltype(convolve)::BORDERS_POLICY_DUPLICATE)})
+    {
+      PointCloud<PointXYZI> cols, rows;
+      convolve.setBordersPolicy(policy);
+      convolve.setInputCloud(input);
+      convolve.convolveCols(cols);
+      convolve.setInputCloud(transposed);
+      convolve.convolveRows(rows);
+      for (std::uint32_t r = 0; r < input->height; r++)
+        for (std::uint32_t c = 0; c < input->width; c++)
+        {
+          EXPECT_EQ (cols (c,r).intensity, rows (r,c).intensity);
+          if (std::isfinite (cols (c,r).z) || std::isfinite (rows (r,c).z))
+          {
+            EXPECT_EQ (cols (c,r).z, rows (r,c).z);
+          }
+        }
+    }
+  }
+}
+
 int
 main (int argc, char** argv)
 {
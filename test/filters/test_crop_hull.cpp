@@ -385,6 +385,84 @@ TYPED_TEST (PCLCropHullTestFixture2dCrutch, test_crop_inside)
 }
 
 
+// a finely tessellated sphere exercises the bounding volume hierarchy over the hull
+TEST (PCLCropHull, tessellated_sphere)
+{
+  const float radius = 1.0f;
+  const int rings = 24, segments = 48;
+  pcl::PointCloud<pcl::PointXYZ>::Ptr hull_cloud (new pcl::PointCloud<pcl::PointXYZ>);
+  hull_cloud->push_back (pcl::PointXYZ (0.0f, 0.0f, radius));
+  for (int r = 1; r < rings; ++r)
+  {
+    const float theta = static_cast<float> (M_PI) * r / rings;
+    for (int s = 0; s < segments; ++s)
+    {
+      const float phi = 2.0f * static_cast<float> (M_PI) * s / segments;
+      hull_cloud->push_back (pcl::PointXYZ (radius * std::sin (theta) * std::cos (phi),
+                                            radius * std::sin (theta) * std::sin (phi),
+                                            radius * std::cos (theta)));
+    }
+  }
+  hull_cloud->push_back (pcl::PointXYZ (0.0f, 0.0f, -radius));
+  const auto south = static_cast<pcl::index_t> (hull_cloud->size () - 1);
+  auto ring_vertex = [segments] (int r, int s) { return static_cast<pcl::index_t> (1 + (r - 1) * segments + s % segments); };
+
+  std::vector<pcl::Vertices> polygons;
+  auto add_triangle = [&polygons] (pcl::index_t a, pcl::index_t b, pcl::index_t c)
+  {
+    pcl::Vertices v;
+    v.vertices = {a, b, c};
+    polygons.push_back (v);
+  };
+  for (int s = 0; s < segments; ++s)
+  {
+    add_triangle (0, ring_vertex (1, s), ring_vertex (1, s + 1));
+    for (int r = 1; r < rings - 1; ++r)
+    {
+      add_triangle (ring_vertex (r, s), ring_vertex (r + 1, s), ring_vertex (r + 1, s + 1));
+      add_triangle (ring_vertex (r, s), ring_vertex (r + 1, s + 1), ring_vertex (r, s + 1));
+    }
+    add_triangle (ring_vertex (rings - 1, s), south, ring_vertex (rings - 1, s + 1));
+  }
+
+  // points clearly inside or outside of the tessellation
+  pcl::PointCloud<pcl::PointXYZ>::Ptr input_cloud (new pcl::PointCloud<pcl::PointXYZ>);
+  pcl::Indices expected;
+  std::mt19937 gen (1234);
+  std::uniform_real_distribution<float> dist (-1.5f, 1.5f);
+  while (input_cloud->size () < 5000)
+  {
+    const pcl::PointXYZ p (dist (gen), dist (gen), dist (gen));
+    const float norm = p.getVector3fMap ().norm ();
+    if (norm > 0.95f && norm < 1.05f)
+      continue;
+    if (norm < 0.95f)
+      expected.push_back (static_cast<pcl::index_t> (input_cloud->size ()));
+    input_cloud->push_back (p);
+  }
+
+  pcl::CropHull<pcl::PointXYZ> crop_hull;
+  crop_hull.setHullCloud (hull_cloud);
+  crop_hull.setHullIndices (polygons);
+  crop_hull.setDim (3);
+  crop_hull.setInputCloud (input_cloud);
+
+  pcl::Indices serial_indices;
+  crop_hull.filter (serial_indices);
+  pcl::test::EXPECT_EQ_VECTORS (expected, serial_indices);
+
+  crop_hull.setNumberOfThreads (4);
+  EXPECT_EQ (4, crop_hull.getNumberOfThreads ());
+  pcl::Indices parallel_indices;
+  crop_hull.filter (parallel_indices);
+  pcl::test::EXPECT_EQ_VECTORS (serial_indices, parallel_indices);
+
+  pcl::PointCloud<pcl::PointXYZ> parallel_cloud;
+  crop_hull.filter (parallel_cloud);
+  ASSERT_EQ (expected.size (), parallel_cloud.size ());
+  for (std::size_t i = 0; i < expected.size (); ++i)
+    EXPECT_XYZ_EQ ((*input_cloud)[expected[i]], parallel_cloud[i]);
+}
 
 /* ---[ */
 int
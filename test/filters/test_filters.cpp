@@ -39,7 +39,9 @@
  */
 
 #include <pcl/test/gtest.h>
+#include <pcl/pcl_tests.h>
 #include <pcl/point_types.h>
+#include <pcl/point_cloud_soa.h>
 #include <pcl/io/pcd_io.h>
 #include <pcl/features/normal_3d.h>
 #include <pcl/filters/filter.h>
@@ -49,6 +51,9 @@
 #include <pcl/filters/sampling_surface_normal.h>
 #include <pcl/filters/voxel_grid.h>
 #include <pcl/filters/voxel_grid_covariance.h>
+#include <pcl/filters/voxel_grid_label.h>
+#include <pcl/filters/voxel_grid_occlusion_estimation.h>
+#include <pcl/filters/voxel_grid_accumulator.h>
 #include <pcl/filters/extract_indices.h>
 #include <pcl/filters/project_inliers.h>
 #include <pcl/filters/radius_outlier_removal.h>
@@ -57,6 +62,8 @@
 #include <pcl/filters/median_filter.h>
 #include <pcl/filters/normal_refinement.h>
 
+#include <pcl/common/common.h>
+#include <pcl/common/execution_context.h>
 #include <pcl/common/transforms.h>
 #include <pcl/common/eigen.h>
 
@@ -1426,6 +1433,343 @@ TEST (VoxelGridMinPoints, Filters)
   EXPECT_NEAR (out_pc->at(0).y, outputMin6[0].y, 1e-4);
   EXPECT_NEAR (out_pc->at(0).z, outputMin6[0].z, 1e-4);
 }
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (VoxelGridParallel, Filters)
+{
+  // Unorganized, dense input with only XYZ
+  VoxelGrid<PointXYZ> grid;
+  grid.setLeafSize (0.02f, 0.02f, 0.02f);
+  grid.setInputCloud (cloud);
+  grid.setSaveLeafLayout (true);
+  PointCloud<PointXYZ> output_serial;
+  grid.filter (output_serial);
+  const std::vector<int> layout_serial = grid.getLeafLayout ();
+
+  // The parallel path is only taken if the budget grants more than one thread
+  const unsigned int budget = pcl::ExecutionContext::getThreadBudget ();
+  pcl::ExecutionContext::setThreadBudget (4);
+  grid.setNumberOfThreads (4);
+  EXPECT_EQ (grid.getNumberOfThreads (), 4);
+  PointCloud<PointXYZ> output_parallel;
+  grid.filter (output_parallel);
+
+  ASSERT_EQ (output_parallel.size (), output_serial.size ());
+  EXPECT_EQ (output_parallel.width, output_serial.width);
+  EXPECT_EQ (grid.getLeafLayout (), layout_serial);
+  for (std::size_t i = 0; i < output_serial.size (); ++i)
+  {
+    EXPECT_NEAR (output_parallel[i].x, output_serial[i].x, 1e-6);
+    EXPECT_NEAR (output_parallel[i].y, output_serial[i].y, 1e-6);
+    EXPECT_NEAR (output_parallel[i].z, output_serial[i].z, 1e-6);
+  }
+
+  // Organized input with NaNs, colors, a distance filter and a minimum number of points
+  VoxelGrid<PointXYZRGB> grid_rgb;
+  grid_rgb.setLeafSize (0.01f, 0.01f, 0.01f);
+  grid_rgb.setInputCloud (cloud_organized);
+  grid_rgb.setFilterFieldName ("z");
+  grid_rgb.setFilterLimits (0.0f, 1.0f);
+  grid_rgb.setMinimumPointsNumberPerVoxel (3);
+  PointCloud<PointXYZRGB> output_rgb_serial;
+  grid_rgb.filter (output_rgb_serial);
+
+  grid_rgb.setNumberOfThreads (3);
+  PointCloud<PointXYZRGB> output_rgb_parallel;
+  grid_rgb.filter (output_rgb_parallel);
+
+  ASSERT_EQ (output_rgb_parallel.size (), output_rgb_serial.size ());
+  for (std::size_t i = 0; i < output_rgb_serial.size (); ++i)
+  {
+    EXPECT_NEAR (output_rgb_parallel[i].x, output_rgb_serial[i].x, 1e-6);
+    EXPECT_NEAR (output_rgb_parallel[i].y, output_rgb_serial[i].y, 1e-6);
+    EXPECT_NEAR (output_rgb_parallel[i].z, output_rgb_serial[i].z, 1e-6);
+    EXPECT_NEAR (output_rgb_parallel[i].r, output_rgb_serial[i].r, 1);
+    EXPECT_NEAR (output_rgb_parallel[i].g, output_rgb_serial[i].g, 1);
+    EXPECT_NEAR (output_rgb_parallel[i].b, output_rgb_serial[i].b, 1);
+  }
+
+  grid_rgb.setNumberOfThreads (0);
+  PointCloud<PointXYZRGB> output_rgb_budget;
+  grid_rgb.filter (output_rgb_budget);
+  ASSERT_EQ (output_rgb_budget.size (), output_rgb_serial.size ());
+  for (std::size_t i = 0; i < output_rgb_serial.size (); ++i)
+    EXPECT_NEAR (output_rgb_budget[i].z, output_rgb_serial[i].z, 1e-6);
+  pcl::ExecutionContext::setThreadBudget (budget);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (VoxelGridOcclusionEstimationBatch, Filters)
+{
+  using VoxelVector = std::vector<Eigen::Vector3i, Eigen::aligned_allocator<Eigen::Vector3i> >;
+
+  VoxelGridOcclusionEstimation<PointXYZ> grid;
+  grid.setLeafSize (0.01f, 0.01f, 0.01f);
+  grid.setInputCloud (cloud);
+  grid.initializeVoxelGrid ();
+
+  VoxelVector occluded_serial;
+  EXPECT_EQ (grid.occlusionEstimationAll (occluded_serial), 0);
+  EXPECT_FALSE (occluded_serial.empty ());
+
+  grid.setNumberOfThreads (4);
+  VoxelVector occluded_parallel;
+  EXPECT_EQ (grid.occlusionEstimationAll (occluded_parallel), 0);
+  EXPECT_EQ (occluded_parallel, occluded_serial);
+
+  // 0 threads takes what the budget grants
+  const unsigned int budget = pcl::ExecutionContext::getThreadBudget ();
+  pcl::ExecutionContext::setThreadBudget (4);
+  grid.setNumberOfThreads (0);
+  VoxelVector occluded_budget;
+  EXPECT_EQ (grid.occlusionEstimationAll (occluded_budget), 0);
+  EXPECT_EQ (occluded_budget, occluded_serial);
+
+  // the batch gives the same states and rays as the target voxels one at a time
+  VoxelVector targets;
+  const Eigen::Vector3i min_b = grid.getMinBoxCoordinates ();
+  const Eigen::Vector3i max_b = grid.getMaxBoxCoordinates ();
+  for (int k = min_b[2]; k <= max_b[2]; k += 2)
+    for (int j = min_b[1]; j <= max_b[1]; j += 2)
+      for (int i = min_b[0]; i <= max_b[0]; i += 2)
+        targets.emplace_back (i, j, k);
+
+  std::vector<int> states, states_rays;
+  VoxelVector rays;
+  std::vector<std::size_t> ray_offsets;
+  EXPECT_EQ (grid.occlusionEstimation (states, targets), 0);
+  EXPECT_EQ (grid.occlusionEstimation (states_rays, rays, ray_offsets, targets), 0);
+  ASSERT_EQ (states.size (), targets.size ());
+  ASSERT_EQ (states_rays.size (), targets.size ());
+  ASSERT_EQ (ray_offsets.size (), targets.size () + 1);
+  EXPECT_EQ (ray_offsets.back (), rays.size ());
+  for (std::size_t t = 0; t < targets.size (); ++t)
+  {
+    int state;
+    EXPECT_EQ (grid.occlusionEstimation (state, targets[t]), 0);
+    EXPECT_EQ (states[t], state);
+
+    VoxelVector ray;
+    EXPECT_EQ (grid.occlusionEstimation (state, ray, targets[t]), 0);
+    EXPECT_EQ (states_rays[t], state);
+    ASSERT_EQ (ray_offsets[t + 1] - ray_offsets[t], ray.size ());
+    EXPECT_TRUE (std::equal (ray.begin (), ray.end (), rays.begin () + ray_offsets[t]));
+  }
+  pcl::ExecutionContext::setThreadBudget (budget);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (VoxelGridLargeExtent, Filters)
+{
+  // Two small clusters 1km apart: with a 1cm leaf size the grid has ~10^15 leaves
+  PointCloud<PointXYZ>::Ptr input (new PointCloud<PointXYZ>);
+  const std::vector<Eigen::Vector3f> offsets {{0.001f, 0.002f, 0.003f}, {0.004f, 0.001f, 0.002f},
+                                              {0.002f, 0.004f, 0.001f}, {0.003f, 0.003f, 0.004f}};
+  for (const auto &offset : offsets)
+  {
+    input->emplace_back (0.0f + offset[0], 0.0f + offset[1], 0.0f + offset[2]);
+    input->emplace_back (1000.0f + offset[0], 1000.0f + offset[1], 1000.0f + offset[2]);
+    input->emplace_back (1000.0f + offset[0], 0.05f + offset[1], 1000.0f - offset[2]);
+  }
+
+  VoxelGrid<PointXYZ> grid;
+  grid.setLeafSize (0.01f, 0.01f, 0.01f);
+  grid.setInputCloud (input);
+  PointCloud<PointXYZ> output;
+  grid.filter (output);
+
+  // Voxels are ordered by their leaf index, i.e. by x, then y, then z
+  ASSERT_EQ (output.size (), 3);
+  EXPECT_NEAR (output[0].x, 0.0025f, 1e-4);
+  EXPECT_NEAR (output[0].y, 0.0025f, 1e-4);
+  EXPECT_NEAR (output[0].z, 0.0025f, 1e-4);
+  EXPECT_NEAR (output[1].x, 1000.0025f, 1e-3);
+  EXPECT_NEAR (output[1].y, 0.0525f, 1e-4);
+  EXPECT_NEAR (output[1].z, 999.9975f, 1e-3);
+  EXPECT_NEAR (output[2].x, 1000.0025f, 1e-3);
+  EXPECT_NEAR (output[2].y, 1000.0025f, 1e-3);
+  EXPECT_NEAR (output[2].z, 1000.0025f, 1e-3);
+
+  grid.setNumberOfThreads (2);
+  PointCloud<PointXYZ> output_parallel;
+  grid.filter (output_parallel);
+  ASSERT_EQ (output_parallel.size (), output.size ());
+  for (std::size_t i = 0; i < output.size (); ++i)
+    EXPECT_XYZ_NEAR (output_parallel[i], output[i], 1e-4);
+
+  // No leaf layout can be saved for such grids, the layout accessors report it
+  grid.setSaveLeafLayout (true);
+  grid.filter (output_parallel);
+  EXPECT_TRUE (grid.getLeafLayout ().empty ());
+  EXPECT_EQ (grid.getCentroidIndex ((*input)[0]), -1);
+  EXPECT_EQ (grid.getCentroidIndexAt (grid.getGridCoordinates (0.0f, 0.0f, 0.0f)), -1);
+  EXPECT_EQ (grid.getNeighborCentroidIndices ((*input)[0], Eigen::MatrixXi::Zero (3, 2)), std::vector<int> (2, -1));
+  EXPECT_EQ (grid.getDivisionMultiplier ()[2], -1);
+
+  // The same grid for PCLPointCloud2 and labeled input
+  PCLPointCloud2::Ptr input_blob (new PCLPointCloud2);
+  toPCLPointCloud2 (*input, *input_blob);
+  VoxelGrid<PCLPointCloud2> grid_blob;
+  grid_blob.setLeafSize (0.01f, 0.01f, 0.01f);
+  grid_blob.setSaveLeafLayout (true);
+  grid_blob.setInputCloud (input_blob);
+  PCLPointCloud2 output_blob;
+  grid_blob.filter (output_blob);
+  PointCloud<PointXYZ> output_blob_xyz;
+  fromPCLPointCloud2 (output_blob, output_blob_xyz);
+  ASSERT_EQ (output_blob_xyz.size (), output.size ());
+  for (std::size_t i = 0; i < output.size (); ++i)
+    EXPECT_XYZ_NEAR (output_blob_xyz[i], output[i], 1e-4);
+  EXPECT_EQ (grid_blob.getCentroidIndex (0.0f, 0.0f, 0.0f), -1);
+
+  PointCloud<PointXYZRGBL>::Ptr input_label (new PointCloud<PointXYZRGBL>);
+  copyPointCloud (*input, *input_label);
+  VoxelGridLabel grid_label;
+  grid_label.setLeafSize (0.01f, 0.01f, 0.01f);
+  grid_label.setInputCloud (input_label);
+  PointCloud<PointXYZRGBL> output_label;
+  grid_label.filter (output_label);
+  ASSERT_EQ (output_label.size (), output.size ());
+  for (std::size_t i = 0; i < output.size (); ++i)
+    EXPECT_XYZ_NEAR (output_label[i], output[i], 1e-4);
+
+  VoxelGridCovariance<PointXYZ> grid_covariance;
+  grid_covariance.setLeafSize (0.01f, 0.01f, 0.01f);
+  grid_covariance.setMinPointPerVoxel (4);
+  grid_covariance.setInputCloud (input);
+  PointCloud<PointXYZ> output_covariance;
+  grid_covariance.filter (output_covariance);
+  EXPECT_EQ (grid_covariance.getLeaves ().size (), 3);
+  EXPECT_EQ (output_covariance.size (), 3);
+  const auto leaf = grid_covariance.getLeaf (input->at (1));
+  ASSERT_NE (leaf, nullptr);
+  EXPECT_EQ (leaf->getPointCount (), 4);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (VoxelGridSoA, Filters)
+{
+  // Unorganized, dense input with only XYZ
+  VoxelGrid<PointXYZ> grid;
+  grid.setLeafSize (0.02f, 0.02f, 0.02f);
+  grid.setInputCloud (cloud);
+  PointCloud<PointXYZ> output;
+  grid.filter (output);
+
+  PointCloudSoA soa, soa_output;
+  toPointCloudSoA (*cloud, soa);
+  voxelGridFilter (soa, soa_output, Eigen::Vector3f::Constant (0.02f));
+  EXPECT_TRUE (soa_output.is_dense);
+  PointCloud<PointXYZ> output_soa;
+  fromPointCloudSoA (soa_output, output_soa);
+  ASSERT_EQ (output_soa.size (), output.size ());
+  for (std::size_t i = 0; i < output.size (); ++i)
+    EXPECT_XYZ_NEAR (output_soa[i], output[i], 1e-6);
+
+  // Organized input with NaNs, colors and a minimum number of points
+  VoxelGrid<PointXYZRGB> grid_rgb;
+  grid_rgb.setLeafSize (0.01f, 0.01f, 0.01f);
+  grid_rgb.setInputCloud (cloud_organized);
+  grid_rgb.setMinimumPointsNumberPerVoxel (3);
+  PointCloud<PointXYZRGB> output_rgb;
+  grid_rgb.filter (output_rgb);
+
+  PointCloudSoA soa_rgb, soa_rgb_output;
+  toPointCloudSoA (*cloud_organized, soa_rgb);
+  voxelGridFilter (soa_rgb, soa_rgb_output, Eigen::Vector3f::Constant (0.01f), 3);
+  PointCloud<PointXYZRGB> output_rgb_soa;
+  fromPointCloudSoA (soa_rgb_output, output_rgb_soa);
+  ASSERT_EQ (output_rgb_soa.size (), output_rgb.size ());
+  for (std::size_t i = 0; i < output_rgb.size (); ++i)
+  {
+    EXPECT_XYZ_NEAR (output_rgb_soa[i], output_rgb[i], 1e-6);
+    EXPECT_NEAR (output_rgb_soa[i].r, output_rgb[i].r, 1);
+    EXPECT_NEAR (output_rgb_soa[i].g, output_rgb[i].g, 1);
+    EXPECT_NEAR (output_rgb_soa[i].b, output_rgb[i].b, 1);
+  }
+
+  // Only the coordinates, in place
+  voxelGridFilter (soa_rgb, soa_rgb, Eigen::Vector3f::Constant (0.01f), 3, false);
+  EXPECT_EQ (soa_rgb.getFields ().size (), 3);
+  ASSERT_EQ (soa_rgb.size (), output_rgb.size ());
+  for (std::size_t i = 0; i < output_rgb.size (); ++i)
+    EXPECT_NEAR (soa_rgb.getFieldData<float> ("z")[i], output_rgb[i].z, 1e-6);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (VoxelGridAccumulator, Filters)
+{
+  VoxelGridAccumulator<PointXYZ> accumulator;
+  accumulator.setLeafSize (0.02f, 0.02f, 0.02f);
+
+  // Add the cloud in three chunks
+  const std::size_t chunk_size = cloud->size () / 3 + 1;
+  for (std::size_t begin = 0; begin < cloud->size (); begin += chunk_size)
+  {
+    Indices chunk;
+    for (std::size_t i = begin; i < std::min (begin + chunk_size, cloud->size ()); ++i)
+      chunk.push_back (static_cast<index_t> (i));
+    accumulator.addCloud (*cloud, chunk);
+  }
+  EXPECT_EQ (accumulator.getNumberOfPoints (), cloud->size ());
+
+  PointCloud<PointXYZ> output;
+  accumulator.getCentroids (output);
+  EXPECT_EQ (output.size (), accumulator.getNumberOfLeaves ());
+  EXPECT_EQ (output.width, output.size ());
+  EXPECT_EQ (output.height, 1);
+
+  // The accumulated centroids match the ones of a VoxelGrid over the whole cloud
+  VoxelGrid<PointXYZ> grid;
+  grid.setLeafSize (0.02f, 0.02f, 0.02f);
+  grid.setInputCloud (cloud);
+  PointCloud<PointXYZ> output_grid;
+  grid.filter (output_grid);
+
+  const auto by_leaf = [&accumulator] (const PointXYZ &p1, const PointXYZ &p2)
+  {
+    const Eigen::Vector3i ijk1 = accumulator.getGridCoordinates (p1.x, p1.y, p1.z);
+    const Eigen::Vector3i ijk2 = accumulator.getGridCoordinates (p2.x, p2.y, p2.z);
+    return (std::lexicographical_compare (ijk1.data (), ijk1.data () + 3, ijk2.data (), ijk2.data () + 3));
+  };
+  std::sort (output.begin (), output.end (), by_leaf);
+  std::sort (output_grid.begin (), output_grid.end (), by_leaf);
+  ASSERT_EQ (output.size (), output_grid.size ());
+  for (std::size_t i = 0; i < output.size (); ++i)
+    EXPECT_XYZ_NEAR (output[i], output_grid[i], 1e-5);
+
+  // Evict everything outside of a box around the center of the cloud
+  Eigen::Vector4f min_pt, max_pt;
+  getMinMax3D (*cloud, min_pt, max_pt);
+  const Eigen::Vector4f center = (min_pt + max_pt) / 2.0f;
+  const std::size_t nr_leaves = accumulator.getNumberOfLeaves ();
+  const std::size_t nr_evicted = accumulator.evictOutside (min_pt, center);
+  EXPECT_GT (nr_evicted, 0);
+  EXPECT_EQ (accumulator.getNumberOfLeaves (), nr_leaves - nr_evicted);
+
+  const std::size_t nr_kept_points = accumulator.getNumberOfPoints ();
+  accumulator.getCentroids (output);
+  EXPECT_EQ (output.size (), nr_leaves - nr_evicted);
+  for (const auto &point : output)
+  {
+    EXPECT_LE (point.x, center[0] + 0.01f);
+    EXPECT_LE (point.y, center[1] + 0.01f);
+    EXPECT_LE (point.z, center[2] + 0.01f);
+  }
+
+  // Points added again to evicted leaves start new running sums, while the
+  // leaves which were kept now hold at least two points
+  accumulator.addCloud (*cloud);
+  accumulator.setMinimumPointsNumberPerVoxel (2);
+  accumulator.getCentroids (output);
+  EXPECT_EQ (accumulator.getNumberOfLeaves (), nr_leaves);
+  EXPECT_EQ (accumulator.getNumberOfPoints (), nr_kept_points + cloud->size ());
+  EXPECT_GE (output.size (), nr_leaves - nr_evicted);
+
+  accumulator.clear ();
+  accumulator.getCentroids (output);
+  EXPECT_EQ (output.size (), 0);
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 TEST (ProjectInliers, Filters)
 {
@@ -1532,6 +1876,59 @@ TEST (RadiusOutlierRemoval, Filters)
   EXPECT_NEAR (cloud_out[cloud_out.size () - 1].z, -0.021299, 1e-4);
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (RadiusOutlierRemoval, MultiThreaded)
+{
+  // A non-dense copy of the input takes the radius search path
+  PointCloud<PointXYZ>::Ptr cloud_nan (new PointCloud<PointXYZ> (*cloud));
+  (*cloud_nan)[10].x = std::numeric_limits<float>::quiet_NaN ();
+  cloud_nan->is_dense = false;
+
+  for (const auto &input : {cloud, cloud_nan})
+  {
+    for (const bool negative : {false, true})
+    {
+      RadiusOutlierRemoval<PointXYZ> outrem (true);
+      outrem.setInputCloud (input);
+      outrem.setRadiusSearch (0.02);
+      outrem.setMinNeighborsInRadius (14);
+      outrem.setNegative (negative);
+
+      Indices serial_indices;
+      outrem.filter (serial_indices);
+      const Indices serial_removed = *outrem.getRemovedIndices ();
+      if (!negative && input->is_dense)
+      {
+        EXPECT_EQ (307, serial_indices.size ());
+      }
+      if (!negative && !input->is_dense)
+      {
+        // The radius search stops early, compare with the full neighbor count
+        Indices expected;
+        for (index_t i = 0; i < static_cast<index_t> (input->size ()); ++i)
+        {
+          if (!isXYZFinite ((*input)[i]))
+            continue;
+          int nr_neighbors = 0;
+          for (const auto &p : *input)
+            if (((*input)[i].getVector3fMap () - p.getVector3fMap ()).squaredNorm () <= 0.02f * 0.02f)
+              ++nr_neighbors;
+          if (nr_neighbors > 14)
+            expected.push_back (i);
+        }
+        EXPECT_EQ (expected, serial_indices);
+      }
+
+      outrem.setNumberOfThreads (4);
+      EXPECT_EQ (4, outrem.getNumberOfThreads ());
+      Indices parallel_indices;
+      outrem.filter (parallel_indices);
+      EXPECT_EQ (serial_indices, parallel_indices);
+      EXPECT_EQ (serial_removed, *outrem.getRemovedIndices ());
+    }
+  }
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 TEST (StatisticalOutlierRemoval, Filters)
 {
@@ -1647,6 +2044,27 @@ TEST (StatisticalOutlierRemoval, Filters)
   EXPECT_NEAR (output[output.size () - 1].z, -0.0444, 1e-4);
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (StatisticalOutlierRemoval, MultiThreaded)
+{
+  StatisticalOutlierRemoval<PointXYZ> outrem (true);
+  outrem.setInputCloud (cloud);
+  outrem.setMeanK (50);
+  outrem.setStddevMulThresh (1.0);
+
+  Indices serial_indices;
+  outrem.filter (serial_indices);
+  const Indices serial_removed = *outrem.getRemovedIndices ();
+  EXPECT_EQ (352, serial_indices.size ());
+
+  outrem.setNumberOfThreads (4);
+  EXPECT_EQ (4, outrem.getNumberOfThreads ());
+  Indices parallel_indices;
+  outrem.filter (parallel_indices);
+  EXPECT_EQ (serial_indices, parallel_indices);
+  EXPECT_EQ (serial_removed, *outrem.getRemovedIndices ());
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////
 TEST (ConditionalRemoval, Filters)
 {
@@ -1860,6 +2278,76 @@ TEST (ConditionalRemovalSetIndices, Filters)
   EXPECT_EQ (num_not_nan, indices->size () - condrem2_.getRemovedIndices ()->size ());
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////
+TEST (ConditionalRemovalCompiled, Filters)
+{
+  PointCloud<PointXYZRGB>::Ptr input (new PointCloud<PointXYZRGB>);
+  srand (0);
+  for (int i = 0; i < 2000; i++)
+  {
+    PointXYZRGB point (static_cast<std::uint8_t> (rand () % 256),
+                       static_cast<std::uint8_t> (rand () % 256),
+                       static_cast<std::uint8_t> (rand () % 256));
+    point.x = 2.0f * rand () / RAND_MAX - 1.0f;
+    point.y = 2.0f * rand () / RAND_MAX - 1.0f;
+    point.z = static_cast<float> (rand () % 5); // exact values for EQ
+    input->push_back (point);
+  }
+
+  // (x > -0.5 and x <= 0.5 and (z == 2 or r > 200 or (y < 0 and empty or))) or (y >= 0.8)
+  ConditionOr<PointXYZRGB>::Ptr inner_or (new ConditionOr<PointXYZRGB>);
+  inner_or->addComparison (FieldComparison<PointXYZRGB>::ConstPtr (new FieldComparison<PointXYZRGB> ("z", ComparisonOps::EQ, 2.0)));
+  inner_or->addComparison (PackedRGBComparison<PointXYZRGB>::ConstPtr (new PackedRGBComparison<PointXYZRGB> ("r", ComparisonOps::GT, 200)));
+  ConditionAnd<PointXYZRGB>::Ptr innermost_and (new ConditionAnd<PointXYZRGB>);
+  innermost_and->addComparison (FieldComparison<PointXYZRGB>::ConstPtr (new FieldComparison<PointXYZRGB> ("y", ComparisonOps::LT, 0.0)));
+  innermost_and->addCondition (ConditionOr<PointXYZRGB>::Ptr (new ConditionOr<PointXYZRGB>));
+  inner_or->addCondition (innermost_and);
+
+  ConditionAnd<PointXYZRGB>::Ptr box_and (new ConditionAnd<PointXYZRGB>);
+  box_and->addComparison (FieldComparison<PointXYZRGB>::ConstPtr (new FieldComparison<PointXYZRGB> ("x", ComparisonOps::GT, -0.5)));
+  box_and->addComparison (FieldComparison<PointXYZRGB>::ConstPtr (new FieldComparison<PointXYZRGB> ("x", ComparisonOps::LE, 0.5)));
+  box_and->addCondition (inner_or);
+
+  ConditionOr<PointXYZRGB>::Ptr condition (new ConditionOr<PointXYZRGB>);
+  condition->addCondition (box_and);
+  condition->addComparison (FieldComparison<PointXYZRGB>::ConstPtr (new FieldComparison<PointXYZRGB> ("y", ComparisonOps::GE, 0.8)));
+
+  pcl::Indices expected;
+  for (index_t i = 0; i < static_cast<index_t> (input->size ()); i++)
+    if (condition->evaluate ((*input)[i]))
+      expected.push_back (i);
+  ASSERT_GT (expected.size (), 0);
+  ASSERT_LT (expected.size (), input->size ());
+
+  for (const unsigned int nr_threads : {0u, 1u, 4u})
+  {
+    ConditionalRemoval<PointXYZRGB> condrem (true);
+    condrem.setNumberOfThreads (nr_threads);
+    condrem.setCondition (condition);
+    condrem.setInputCloud (input);
+    PointCloud<PointXYZRGB> output;
+    condrem.filter (output);
+
+    ASSERT_EQ (expected.size (), output.size ());
+    for (std::size_t i = 0; i < expected.size (); i++)
+    {
+      EXPECT_EQ ((*input)[expected[i]].x, output[i].x);
+      EXPECT_EQ ((*input)[expected[i]].y, output[i].y);
+      EXPECT_EQ ((*input)[expected[i]].rgba, output[i].rgba);
+    }
+    EXPECT_EQ (input->size () - expected.size (), condrem.getRemovedIndices ()->size ());
+
+    condrem.setKeepOrganized (true);
+    condrem.filter (output);
+    ASSERT_EQ (input->size (), output.size ());
+    std::size_t nr_finite = 0;
+    for (const auto &point : output)
+      if (std::isfinite (point.x))
+        nr_finite++;
+    EXPECT_EQ (expected.size (), nr_finite);
+  }
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////
 TEST (SamplingSurfaceNormal, Filters)
 {
@@ -2036,6 +2524,70 @@ TEST (FrustumCulling, Filters)
 
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////
+TEST (FrustumCullingBatch, Filters)
+{
+  PointCloud<PointXYZ>::Ptr input (new PointCloud<PointXYZ> ());
+  srand (0);
+  for (int i = 0; i < 1000; i++)
+    input->push_back (PointXYZ (20.0f * rand () / RAND_MAX - 10.0f,
+                                20.0f * rand () / RAND_MAX - 10.0f,
+                                20.0f * rand () / RAND_MAX - 10.0f));
+
+  pcl::FrustumCulling<pcl::PointXYZ> fc;
+  fc.setInputCloud (input);
+  fc.setVerticalFOV (50);
+  fc.setHorizontalFOV (70);
+  fc.setNearPlaneDistance (0.5);
+  fc.setFarPlaneDistance (8);
+
+  // Cameras on a circle, looking at the origin
+  pcl::FrustumCulling<pcl::PointXYZ>::CameraPoseVector camera_poses;
+  for (int i = 0; i < 40; i++)
+  {
+    const float angle = static_cast<float> (2 * M_PI * i / 40);
+    Eigen::Matrix4f camera_pose = Eigen::Matrix4f::Identity ();
+    camera_pose.block<3, 3> (0, 0) = Eigen::AngleAxisf (angle + static_cast<float> (M_PI), Eigen::Vector3f::UnitY ()).toRotationMatrix ();
+    camera_pose.block<3, 1> (0, 3) = Eigen::Vector3f (5 * std::cos (angle), 0, -5 * std::sin (angle));
+    camera_poses.push_back (camera_pose);
+  }
+
+  for (const bool negative : {false, true})
+  {
+    fc.setNegative (negative);
+    std::vector<pcl::Indices> batch_indices;
+    fc.filter (camera_poses, batch_indices);
+    ASSERT_EQ (camera_poses.size (), batch_indices.size ());
+
+    std::size_t nr_visible = 0;
+    for (std::size_t i = 0; i < camera_poses.size (); i++)
+    {
+      pcl::Indices indices;
+      fc.setCameraPose (camera_poses[i]);
+      fc.filter (indices);
+      EXPECT_EQ (indices, batch_indices[i]);
+      nr_visible += indices.size ();
+    }
+    EXPECT_GT (nr_visible, 0);
+  }
+
+  // Indices of the input are respected
+  pcl::IndicesPtr subset (new pcl::Indices);
+  for (index_t i = 0; i < static_cast<index_t> (input->size ()); i += 3)
+    subset->push_back (i);
+  fc.setNegative (false);
+  fc.setIndices (subset);
+  std::vector<pcl::Indices> batch_indices;
+  fc.filter (camera_poses, batch_indices);
+  for (std::size_t i = 0; i < camera_poses.size (); i++)
+  {
+    pcl::Indices indices;
+    fc.setCameraPose (camera_poses[i]);
+    fc.filter (indices);
+    EXPECT_EQ (indices, batch_indices[i]);
+  }
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////
 TEST (ConditionalRemovalTfQuadraticXYZComparison, Filters)
 {
@@ -2239,6 +2791,39 @@ TEST (MedianFilter, Filters)
   EXPECT_NEAR (1.177000045f, out_3(128, 128).z, 1e-5);
   EXPECT_NEAR (0.778999984f, out_3(256, 256).z, 1e-5);
   EXPECT_NEAR (0.703000009f, out_3(428, 300).z, 1e-5);
+
+  // Larger windows against a direct computation of the medians, with invalid points
+  PointCloud<PointXYZ>::Ptr cloud_random (new PointCloud<PointXYZ> (23, 17));
+  for (std::size_t i = 0; i < cloud_random->size (); ++i)
+  {
+    (*cloud_random)[i].x = (*cloud_random)[i].y = 0.f;
+    (*cloud_random)[i].z = (i % 7 == 3) ? std::numeric_limits<float>::quiet_NaN ()
+                                        : static_cast<float> ((i * 37) % 11);
+  }
+  median_filter.setInputCloud (cloud_random);
+  median_filter.setMaxAllowedMovement (std::numeric_limits<float>::max ());
+  for (const int window_size : {5, 6, 9})
+  {
+    median_filter.setWindowSize (window_size);
+    PointCloud<PointXYZ> out_4;
+    median_filter.filter (out_4);
+    for (int y = 0; y < 17; ++y)
+      for (int x = 0; x < 23; ++x)
+      {
+        if (!std::isfinite ((*cloud_random)(x, y).z))
+        {
+          EXPECT_FALSE (std::isfinite (out_4(x, y).z));
+          continue;
+        }
+        std::vector<float> vals;
+        for (int v = std::max (y - window_size / 2, 0); v <= std::min (y + window_size / 2, 16); ++v)
+          for (int u = std::max (x - window_size / 2, 0); u <= std::min (x + window_size / 2, 22); ++u)
+            if (std::isfinite ((*cloud_random)(u, v).z))
+              vals.push_back ((*cloud_random)(u, v).z);
+        std::sort (vals.begin (), vals.end ());
+        EXPECT_EQ (vals[vals.size () / 2], out_4(x, y).z);
+      }
+  }
 }
 
 
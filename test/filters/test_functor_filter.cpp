@@ -91,6 +91,52 @@ TEST_P(FunctorFilterRandom, functioning)
   }
 }
 
+TEST_P(FunctorFilterRandom, parallel_policy)
+{
+  const auto lambda = [](const PointCloud<PointXYZ>& cloud, index_t idx) {
+    const auto& pt = cloud[idx];
+    return pt.x + pt.y < pt.z;
+  };
+
+  for (const auto& negative : {false, true}) {
+    advanced::FunctorFilter<PointXYZ, decltype(lambda)> sequenced{lambda, true};
+    sequenced.setInputCloud(cloud);
+    sequenced.setNegative(negative);
+    Indices expected;
+    sequenced.filter(expected);
+    const Indices expected_removed = *sequenced.getRemovedIndices();
+
+    for (const auto& nr_threads : {1u, 3u, 8u, 1000u}) {
+      advanced::FunctorFilter<PointXYZ, decltype(lambda), execution::parallel_policy>
+          parallel{lambda, true};
+      parallel.setInputCloud(cloud);
+      parallel.setNegative(negative);
+      parallel.setNumberOfThreads(nr_threads);
+      EXPECT_EQ(parallel.getNumberOfThreads(), nr_threads);
+
+      Indices indices;
+      parallel.filter(indices);
+      EXPECT_EQ(indices, expected);
+      EXPECT_EQ(*parallel.getRemovedIndices(), expected_removed);
+
+      parallel.filter(out_cloud);
+      ASSERT_EQ(out_cloud.size(), expected.size());
+      for (std::size_t i = 0; i < expected.size(); ++i)
+        EXPECT_EQ(out_cloud[i].getVector3fMap(), (*cloud)[expected[i]].getVector3fMap());
+    }
+  }
+
+  // fewer indices than threads
+  ParallelFunctionFilter<PointXYZ> parallel{FilterFunction<PointXYZ>{lambda}};
+  parallel.setInputCloud(cloud);
+  parallel.setIndices(pcl::make_shared<Indices>(Indices{0, 1}));
+  parallel.setNumberOfThreads(4);
+  Indices indices;
+  parallel.filter(indices);
+  for (const auto idx : indices)
+    EXPECT_TRUE(lambda(*cloud, idx));
+}
+
 INSTANTIATE_TEST_SUITE_P(RandomSeed,
                          FunctorFilterRandom,
                          testing::Values(123, 456, 789));
@@ -0,0 +1,163 @@
+/*
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ * Point CLoud Library (PCL) - www.pointclouds.org
+ * Copyright (c) 2020-, Open Perception
+ *
+ * All rights reserved
+ */
+
+#include <pcl/common/generate.h>
+#include <pcl/filters/conditional_removal.h>
+#include <pcl/filters/crop_box.h>
+#include <pcl/filters/experimental/fused_filter.h>
+#include <pcl/filters/passthrough.h>
+#include <pcl/test/gtest.h>
+#include <pcl/point_types.h>
+
+#include <limits>
+
+using namespace pcl;
+using namespace pcl::experimental;
+
+struct FusedFilterRandom : public testing::TestWithParam<std::uint32_t> {
+  void
+  SetUp() override
+  {
+    cloud = make_shared<PointCloud<PointXYZ>>();
+
+    std::uint32_t seed = GetParam();
+    common::CloudGenerator<PointXYZ, common::UniformGenerator<float>> generator{
+        {-2., 2., seed}};
+    generator.fill(100, 100, *cloud);
+    for (std::size_t i = 0; i < cloud->size(); i += 97)
+      (*cloud)[i].y = std::numeric_limits<float>::quiet_NaN();
+    cloud->is_dense = false;
+
+    condition.reset(new ConditionAnd<PointXYZ>);
+    condition->addComparison(FieldComparison<PointXYZ>::ConstPtr(
+        new FieldComparison<PointXYZ>("y", ComparisonOps::GT, -1.5)));
+  }
+
+  // Reference result of the chained filters
+  Indices
+  chained(bool negative_box) const
+  {
+    PassThrough<PointXYZ> pass;
+    pass.setInputCloud(cloud);
+    pass.setFilterFieldName("z");
+    pass.setFilterLimits(-1.f, 1.5f);
+    Indices pass_indices;
+    pass.filter(pass_indices);
+
+    CropBox<PointXYZ> crop_box;
+    crop_box.setInputCloud(cloud);
+    crop_box.setIndices(pcl::make_shared<Indices>(pass_indices));
+    crop_box.setMin(min_pt);
+    crop_box.setMax(max_pt);
+    crop_box.setRotation(rotation);
+    crop_box.setNegative(negative_box);
+    Indices crop_indices;
+    crop_box.filter(crop_indices);
+
+    // ConditionalRemoval only outputs clouds, apply the condition by hand
+    Indices indices;
+    for (const auto idx : crop_indices)
+      if (condition->evaluate((*cloud)[idx]) && (*cloud)[idx].x < 1.f)
+        indices.push_back(idx);
+    return indices;
+  }
+
+  shared_ptr<PointCloud<PointXYZ>> cloud;
+  ConditionAnd<PointXYZ>::Ptr condition;
+  const Eigen::Vector4f min_pt{-1.f, -1.f, -1.f, 1.f};
+  const Eigen::Vector4f max_pt{1.f, 1.f, 1.f, 1.f};
+  const Eigen::Vector3f rotation{0.f, 0.f, 0.5f};
+};
+
+TEST_P(FusedFilterRandom, matches_chained_filters)
+{
+  const auto x_limit = [](const PointCloud<PointXYZ>& cloud, index_t idx) {
+    return cloud[idx].x < 1.f;
+  };
+
+  for (const auto& negative_box : {false, true}) {
+    const Indices expected = chained(negative_box);
+    ASSERT_FALSE(expected.empty());
+
+    auto filter = makeFusedFilter<PointXYZ>(
+        PassThroughPredicate<PointXYZ>("z", -1.f, 1.5f),
+        CropBoxPredicate<PointXYZ>(min_pt,
+                                   max_pt,
+                                   Eigen::Affine3f::Identity(),
+                                   Eigen::Vector3f::Zero(),
+                                   rotation,
+                                   negative_box),
+        ConditionPredicate<PointXYZ>(condition),
+        x_limit);
+    filter.setInputCloud(cloud);
+
+    Indices indices;
+    filter.filter(indices);
+    EXPECT_EQ(expected, indices);
+
+    filter.setNumberOfThreads(4);
+    EXPECT_EQ(filter.getNumberOfThreads(), 4);
+    Indices parallel_indices;
+    filter.filter(parallel_indices);
+    EXPECT_EQ(expected, parallel_indices);
+
+    PointCloud<PointXYZ> out_cloud;
+    filter.filter(out_cloud);
+    ASSERT_EQ(out_cloud.size(), expected.size());
+    for (std::size_t i = 0; i < expected.size(); ++i)
+      EXPECT_EQ(out_cloud[i].getVector3fMap(), (*cloud)[expected[i]].getVector3fMap());
+  }
+}
+
+TEST_P(FusedFilterRandom, negative_and_removed_indices)
+{
+  const auto positive_x = [](const PointCloud<PointXYZ>& cloud, index_t idx) {
+    return cloud[idx].x > 0.f;
+  };
+  FusedFilter<PointXYZ, PassThroughPredicate<PointXYZ>, decltype(positive_x)> filter{
+      PassThroughPredicate<PointXYZ>(), positive_x, true};
+  filter.setInputCloud(cloud);
+  filter.setNumberOfThreads(2);
+
+  Indices indices;
+  filter.filter(indices);
+  const Indices removed = *filter.getRemovedIndices();
+  EXPECT_EQ(indices.size() + removed.size(), cloud->size());
+  for (const auto idx : indices) {
+    EXPECT_TRUE(isXYZFinite((*cloud)[idx]));
+    EXPECT_GT((*cloud)[idx].x, 0.f);
+  }
+
+  filter.setNegative(true);
+  Indices negative_indices;
+  filter.filter(negative_indices);
+  EXPECT_EQ(negative_indices, removed);
+  EXPECT_EQ(*filter.getRemovedIndices(), indices);
+}
+
+INSTANTIATE_TEST_SUITE_P(RandomSeed, FusedFilterRandom, testing::Values(123, 456, 789));
+
+TEST(FusedFilter, invalid_field)
+{
+  auto cloud = make_shared<PointCloud<PointXYZ>>();
+  cloud->resize(10);
+
+  auto filter = makeFusedFilter<PointXYZ>(PassThroughPredicate<PointXYZ>("rgb"));
+  filter.setInputCloud(cloud);
+  Indices indices;
+  filter.filter(indices);
+  EXPECT_TRUE(indices.empty());
+}
+
+int
+main(int argc, char** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
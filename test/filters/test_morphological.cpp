@@ -43,6 +43,10 @@
 #include <pcl/filters/morphological_filter.h>
 #include <pcl/point_types.h>
 
+#include <cmath>
+#include <cstdlib>
+#include <limits>
+
 using namespace pcl;
 
 PointCloud<PointXYZ> cloud;
@@ -157,6 +161,67 @@ TEST (Morphological, Unsupported)
   EXPECT_EQ (cloud_in.size (), cloud_out.size ());
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Minimum or maximum over the clipped window of every cell, ignoring NaN cells
+Eigen::MatrixXf
+bruteForceErodeOrDilate (const Eigen::MatrixXf &grid, int half_size, bool erode)
+{
+  Eigen::MatrixXf result (grid.rows (), grid.cols ());
+  for (int row = 0; row < grid.rows (); ++row)
+  {
+    for (int col = 0; col < grid.cols (); ++col)
+    {
+      float value = std::numeric_limits<float>::quiet_NaN ();
+      for (int j = std::max (0, row - half_size); j <= std::min (static_cast<int> (grid.rows ()) - 1, row + half_size); ++j)
+        for (int k = std::max (0, col - half_size); k <= std::min (static_cast<int> (grid.cols ()) - 1, col + half_size); ++k)
+          if (!std::isnan (grid (j, k)) && (std::isnan (value) || (erode ? grid (j, k) < value : grid (j, k) > value)))
+            value = grid (j, k);
+      result (row, col) = value;
+    }
+  }
+  return (result);
+}
+
+void
+expectEqualGrids (const Eigen::MatrixXf &expected, const Eigen::MatrixXf &grid)
+{
+  ASSERT_EQ (expected.rows (), grid.rows ());
+  ASSERT_EQ (expected.cols (), grid.cols ());
+  for (int i = 0; i < expected.size (); ++i)
+  {
+    if (std::isnan (expected.data ()[i]))
+      EXPECT_TRUE (std::isnan (grid.data ()[i]));
+    else
+      EXPECT_EQ (expected.data ()[i], grid.data ()[i]);
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (Morphological, Grid)
+{
+  srand (12345);
+  Eigen::MatrixXf grid (23, 17);
+  for (int i = 0; i < grid.size (); ++i)
+    grid.data ()[i] = (rand () % 4 == 0) ? std::numeric_limits<float>::quiet_NaN () : static_cast<float> (rand () % 1000) * 0.01f;
+  // A corner far away from any value
+  grid.block (15, 9, 8, 8).setConstant (std::numeric_limits<float>::quiet_NaN ());
+
+  for (int half_size = 0; half_size < 12; ++half_size)
+  {
+    Eigen::MatrixXf grid_out;
+    applyMorphologicalOperator (grid, half_size, MORPH_ERODE, grid_out);
+    expectEqualGrids (bruteForceErodeOrDilate (grid, half_size, true), grid_out);
+
+    applyMorphologicalOperator (grid, half_size, MORPH_DILATE, grid_out);
+    expectEqualGrids (bruteForceErodeOrDilate (grid, half_size, false), grid_out);
+
+    applyMorphologicalOperator (grid, half_size, MORPH_OPEN, grid_out);
+    expectEqualGrids (bruteForceErodeOrDilate (bruteForceErodeOrDilate (grid, half_size, true), half_size, false), grid_out);
+
+    applyMorphologicalOperator (grid, half_size, MORPH_CLOSE, grid_out);
+    expectEqualGrids (bruteForceErodeOrDilate (bruteForceErodeOrDilate (grid, half_size, false), half_size, true), grid_out);
+  }
+}
 
 /* ---[ */
 int
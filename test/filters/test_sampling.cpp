@@ -144,6 +144,60 @@ TEST (NormalSpaceSampling, Filters)
     EXPECT_EQ (1u, bucket.size ());
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (CovarianceSampling, Parallel)
+{
+  CovarianceSampling<PointNormal, PointNormal> covariance_sampling;
+  covariance_sampling.setInputCloud (cloud_turtle_normals);
+  covariance_sampling.setNormals (cloud_turtle_normals);
+  covariance_sampling.setNumberOfSamples (static_cast<unsigned int> (cloud_turtle_normals->size ()) / 8);
+
+  Indices indices_serial;
+  covariance_sampling.filter (indices_serial);
+
+  covariance_sampling.setNumberOfThreads (4);
+  EXPECT_EQ (4u, covariance_sampling.getNumberOfThreads ());
+  Indices indices_parallel;
+  covariance_sampling.filter (indices_parallel);
+
+  EXPECT_EQ (indices_serial, indices_parallel);
+  std::set<index_t> unique_indices (indices_parallel.begin (), indices_parallel.end ());
+  EXPECT_EQ (indices_parallel.size (), unique_indices.size ());
+
+  // 0 takes the threads the budget allows
+  covariance_sampling.setNumberOfThreads (0);
+  covariance_sampling.filter (indices_parallel);
+  EXPECT_EQ (indices_serial, indices_parallel);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (NormalSpaceSampling, Parallel)
+{
+  NormalSpaceSampling<PointNormal, PointNormal> normal_space_sampling;
+  normal_space_sampling.setInputCloud (cloud_walls_normals);
+  normal_space_sampling.setNormals (cloud_walls_normals);
+  normal_space_sampling.setBins (4, 4, 4);
+  normal_space_sampling.setSeed (42);
+  normal_space_sampling.setSample (static_cast<unsigned int> (cloud_walls_normals->size ()) / 2);
+
+  Indices indices_serial;
+  normal_space_sampling.filter (indices_serial);
+
+  normal_space_sampling.setNumberOfThreads (4);
+  EXPECT_EQ (4u, normal_space_sampling.getNumberOfThreads ());
+  Indices indices_parallel;
+  normal_space_sampling.filter (indices_parallel);
+
+  EXPECT_EQ (indices_serial, indices_parallel);
+  EXPECT_EQ (cloud_walls_normals->size () / 2, indices_parallel.size ());
+  std::set<index_t> unique_indices (indices_parallel.begin (), indices_parallel.end ());
+  EXPECT_EQ (indices_parallel.size (), unique_indices.size ());
+
+  normal_space_sampling.setNumberOfThreads (0);
+  normal_space_sampling.filter (indices_parallel);
+  EXPECT_EQ (indices_serial, indices_parallel);
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 TEST (RandomSample, Filters)
 {
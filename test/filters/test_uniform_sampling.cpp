@@ -41,6 +41,13 @@
 #include <pcl/filters/uniform_sampling.h>
 #include <pcl/point_types.h>
 
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <map>
+#include <set>
+#include <tuple>
+
 TEST(UniformSampling, extractRemovedIndices)
 {
   using namespace pcl::common;
@@ -74,6 +81,66 @@ TEST(UniformSampling, extractRemovedIndices)
   ASSERT_EQ(removed_indices_set.size(), removed_indices->size());
 }
 
+TEST(UniformSampling, parallelMatchesSerial)
+{
+  using namespace pcl::common;
+  CloudGenerator<pcl::PointXYZ, UniformGenerator<float>> generator;
+  UniformGenerator<float>::Parameters params(-1, 1, 4321);
+  generator.setParameters(params);
+  pcl::PointCloud<pcl::PointXYZ>::Ptr xyz(new pcl::PointCloud<pcl::PointXYZ>);
+  generator.fill(100, 100, *xyz);
+  // Duplicated points have the same distance to the leaf center, the first one is kept
+  for (std::size_t i = 0; i < 100; ++i)
+    xyz->push_back((*xyz)[i]);
+  (*xyz)[5].x = std::numeric_limits<float>::quiet_NaN();
+  xyz->is_dense = false;
+
+  // Reference: visit the points in order, keep the first of the closest points
+  const float leaf_size = 0.15f;
+  const float inverse_leaf_size = 1.0f / leaf_size;
+  std::map<std::tuple<int, int, int>, int> leaves;
+  for (int i = 0; i < static_cast<int>(xyz->size()); ++i) {
+    const auto& point = (*xyz)[i];
+    if (!std::isfinite(point.x))
+      continue;
+    const Eigen::Vector4i ijk(static_cast<int>(std::floor(point.x * inverse_leaf_size)),
+                              static_cast<int>(std::floor(point.y * inverse_leaf_size)),
+                              static_cast<int>(std::floor(point.z * inverse_leaf_size)),
+                              0);
+    const auto key = std::make_tuple(ijk[0], ijk[1], ijk[2]);
+    const float diff = (point.getVector4fMap() - ijk.cast<float>()).squaredNorm();
+    auto leaf = leaves.find(key);
+    if (leaf == leaves.end())
+      leaves[key] = i;
+    else if (diff <
+             ((*xyz)[leaf->second].getVector4fMap() - ijk.cast<float>()).squaredNorm())
+      leaf->second = i;
+  }
+  std::set<int> expected;
+  for (const auto& leaf : leaves)
+    expected.insert(leaf.second);
+
+  for (const unsigned int nr_threads : {0u, 1u, 4u}) {
+    pcl::UniformSampling<pcl::PointXYZ> us(true);
+    us.setNumberOfThreads(nr_threads);
+    us.setInputCloud(xyz);
+    us.setRadiusSearch(leaf_size);
+    pcl::PointCloud<pcl::PointXYZ> output;
+    us.filter(output);
+
+    auto removed_indices = us.getRemovedIndices();
+    ASSERT_EQ(expected.size(), output.size());
+    EXPECT_EQ(xyz->size() - expected.size(), removed_indices->size());
+    std::set<int> kept;
+    for (int i = 0; i < static_cast<int>(xyz->size()); ++i)
+      kept.insert(i);
+    for (const auto& index : *removed_indices)
+      kept.erase(index);
+    EXPECT_EQ(expected, kept);
+    EXPECT_TRUE(std::is_sorted(removed_indices->begin(), removed_indices->end()));
+  }
+}
+
 int
 main(int argc, char** argv)
 {
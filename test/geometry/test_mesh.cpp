@@ -38,6 +38,7 @@
  *
  */
 
+#include <cstdint>
 #include <vector>
 
 #include <pcl/test/gtest.h>
@@ -643,6 +644,90 @@ TEST (TestMesh, IsBoundaryIsManifold)
 
 ////////////////////////////////////////////////////////////////////////////////
 
+TEST (TestMesh, AddFaces)
+{
+  // Triangulated grid of 5 x 4 vertices without the cell 1-2, 6-7
+  const int width = 5, height = 4;
+  std::vector <std::uint32_t> indices, offsets (1, 0);
+  std::vector <VertexIndices> faces;
+  for (int y = 0; y + 1 < height; ++y)
+  {
+    for (int x = 0; x + 1 < width; ++x)
+    {
+      if (y == 0 && x == 1) continue;
+      const int a = y * width + x, b = a + 1, c = a + width, d = c + 1;
+      for (const auto &face : {std::vector <int> {a, b, d}, std::vector <int> {a, d, c}})
+      {
+        faces.emplace_back ();
+        for (const int v : face)
+        {
+          indices.push_back (v);
+          faces.back ().push_back (VertexIndex (v));
+        }
+        offsets.push_back (static_cast <std::uint32_t> (indices.size ()));
+      }
+    }
+  }
+
+  // Reference, added one by one
+  NonManifoldTriangleMesh reference;
+  for (int i = 0; i < width * height; ++i) reference.addVertex (i);
+  for (const auto &face : faces)
+  {
+    ASSERT_TRUE (reference.addFace (face).isValid ());
+  }
+
+  for (const unsigned int threads : {1u, 3u})
+  {
+    ManifoldTriangleMesh mesh;
+    for (int i = 0; i < width * height; ++i) mesh.addVertex (i);
+    ASSERT_TRUE (mesh.addFaces (indices, offsets, threads));
+    EXPECT_TRUE (hasFaces (mesh, faces));
+    EXPECT_TRUE (mesh.isManifold ());
+    ASSERT_EQ (reference.sizeEdges (), mesh.sizeEdges ());
+
+    // The edges are numbered as with addFace
+    for (std::size_t i = 0; i < mesh.sizeHalfEdges (); ++i)
+    {
+      const HalfEdgeIndex idx_he (static_cast <int> (i));
+      EXPECT_EQ (reference.getTerminatingVertexIndex (idx_he), mesh.getTerminatingVertexIndex (idx_he));
+      EXPECT_EQ (reference.getFaceIndex (idx_he), mesh.getFaceIndex (idx_he));
+      EXPECT_EQ (idx_he, mesh.getPrevHalfEdgeIndex (mesh.getNextHalfEdgeIndex (idx_he)));
+    }
+    for (int i = 0; i < width * height; ++i)
+    {
+      EXPECT_EQ (reference.isBoundary (VertexIndex (i)), mesh.isBoundary (VertexIndex (i)));
+    }
+    EXPECT_EQ (getBoundaryVertices (reference, VertexIndex (0)), getBoundaryVertices (mesh, VertexIndex (0)));
+    EXPECT_EQ (getBoundaryVertices (reference, VertexIndex (6)), getBoundaryVertices (mesh, VertexIndex (6)));
+
+    // Only meshes without faces
+    EXPECT_FALSE (mesh.addFaces (indices, offsets, threads));
+  }
+
+  // Non-manifold vertex 0, the mesh is left unchanged
+  NonManifoldTriangleMesh mesh;
+  for (unsigned int i=0; i<6; ++i) mesh.addVertex (i);
+  EXPECT_FALSE (mesh.addFaces ({0, 3, 1, 2, 1, 4, 0, 2, 5}, {0, 3, 6, 9}));
+  EXPECT_EQ (0, mesh.sizeHalfEdges ());
+  EXPECT_EQ (0, mesh.sizeFaces ());
+  EXPECT_TRUE (mesh.isIsolated (VertexIndex (0)));
+
+  // Three faces at an edge, inconsistent orientation, wrong face size, invalid vertex
+  EXPECT_FALSE (mesh.addFaces ({0, 1, 2, 1, 0, 3, 0, 1, 4}, {0, 3, 6, 9}));
+  EXPECT_FALSE (mesh.addFaces ({0, 1, 2, 0, 1, 3}, {0, 3, 6}));
+  EXPECT_FALSE (mesh.addFaces ({0, 1, 2, 3}, {0, 4}));
+  EXPECT_FALSE (mesh.addFaces ({0, 1, 6}, {0, 3}));
+
+  // Closed surface
+  EXPECT_TRUE (mesh.addFaces ({0, 1, 2, 0, 3, 1, 1, 3, 2, 2, 3, 0}, {0, 3, 6, 9, 12}));
+  EXPECT_EQ (6, mesh.sizeEdges ());
+  for (unsigned int i=0; i<4; ++i) EXPECT_FALSE (mesh.isBoundary (VertexIndex (i)));
+  EXPECT_TRUE (mesh.isIsolated (VertexIndex (4)));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
 int
 main (int argc, char** argv)
 {
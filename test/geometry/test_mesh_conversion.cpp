@@ -294,6 +294,59 @@ TYPED_TEST (TestMeshConversion, FaceVertexMeshToHalfEdgeMesh)
 
 ////////////////////////////////////////////////////////////////////////////////
 
+TYPED_TEST (TestMeshConversion, PolygonMeshBuffer)
+{
+  using Traits = typename TestFixture::MeshTraits;
+  using Mesh = pcl::geometry::PolygonMesh<Traits>;
+  using FaceIndex = typename Mesh::FaceIndex;
+  using VAFC = typename Mesh::VertexAroundFaceCirculator;
+
+  // Generate the mesh
+  pcl::PolygonMeshBuffer face_vertex_mesh;
+  pcl::toPCLPointCloud2 (this->vertices_, face_vertex_mesh.cloud);
+  for (const auto &face : this->non_manifold_faces_)
+    face_vertex_mesh.addPolygon (face.begin (), face.end ());
+
+  // Convert
+  Mesh half_edge_mesh;
+  const int n_not_added = pcl::geometry::toHalfEdgeMesh (face_vertex_mesh, half_edge_mesh);
+  if (Mesh::IsManifold::value) ASSERT_EQ (2, n_not_added);
+  else                         ASSERT_EQ (0, n_not_added);
+  ASSERT_EQ (this->vertices_.size (), half_edge_mesh.getVertexDataCloud ().size ());
+
+  const std::vector <Indices> expected_faces =
+      Mesh::IsManifold::value ? this->manifold_faces_ :
+                                this->non_manifold_faces_;
+  ASSERT_EQ (expected_faces.size (), half_edge_mesh.sizeFaces ());
+
+  Indices converted_face;
+  for (std::size_t i=0; i<half_edge_mesh.sizeFaces (); ++i)
+  {
+    VAFC       circ     = half_edge_mesh.getVertexAroundFaceCirculator (FaceIndex (i));
+    const VAFC circ_end = circ;
+    converted_face.clear ();
+    do
+    {
+      converted_face.push_back (static_cast <index_t> (circ.getTargetIndex ().get ()));
+    } while (++circ != circ_end);
+
+    EXPECT_TRUE (isCircularPermutation (expected_faces [i], converted_face)) << "Face number " << i;
+  }
+
+  // And back
+  pcl::PolygonMeshBuffer converted;
+  pcl::geometry::toFaceVertexMesh (half_edge_mesh, converted);
+  ASSERT_EQ (expected_faces.size (), converted.size ());
+  EXPECT_EQ (this->vertices_.size (), converted.cloud.width * converted.cloud.height);
+  for (std::size_t i=0; i<converted.size (); ++i)
+  {
+    const Indices face (converted.getPolygon (i), converted.getPolygon (i) + converted.getPolygonSize (i));
+    EXPECT_TRUE (isCircularPermutation (expected_faces [i], face)) << "Face number " << i;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
 // This test should not compile (mesh has no vertex data).
 
 //TEST (TestFaceVertexMeshToHalfEdgeMesh, NoVertexData)
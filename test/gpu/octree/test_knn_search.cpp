@@ -54,6 +54,7 @@
 #endif
 
 #include <pcl/gpu/octree/octree.hpp>
+#include <pcl/gpu/octree/octree_search.hpp>
 #include <pcl/gpu/containers/device_array.h>
 #include <pcl/common/time.h>
 #include "data_source.hpp"
@@ -70,8 +71,7 @@ struct PriorityPair
     bool operator==(const PriorityPair& other) const { return dist2 == other.dist2 && index == other.index; }
 };
 
-//TEST(PCL_OctreeGPU, DISABLED_exactNeighbourSearch)
-TEST(PCL_OctreeGPU, exactNeighbourSearch)
+void exactNeighbourSearch(const int k)
 {       
     DataGenerator data;
     data.data_size = 871000;
@@ -82,7 +82,6 @@ TEST(PCL_OctreeGPU, exactNeighbourSearch)
     data.printParams();
 
     const float host_octree_resolution = 25.f;
-    const int k = 1; // only this is supported
 
     //generate
     data();
@@ -127,7 +126,7 @@ TEST(PCL_OctreeGPU, exactNeighbourSearch)
 
     //search GPU shared
     {
-        pcl::ScopeTime time("1nn-gpu");
+        pcl::ScopeTime time("knn-gpu");
         octree_device.nearestKSearchBatch(queries_device, k, result_device, result_sqr_distances);
     }
 
@@ -138,7 +137,7 @@ TEST(PCL_OctreeGPU, exactNeighbourSearch)
     result_sqr_distances.download(downloaded_sqr_dists);
 
     {
-        pcl::ScopeTime time("1nn-cpu");
+        pcl::ScopeTime time("knn-cpu");
         for(std::size_t i = 0; i < data.tests_num; ++i)
             octree_host.nearestKSearch(data.queries[i], k, result_host[i], dists_host[i]);
     }
@@ -188,6 +187,68 @@ TEST(PCL_OctreeGPU, exactNeighbourSearch)
     }     
 }
 
+//TEST(PCL_OctreeGPU, DISABLED_exactNeighbourSearch)
+TEST(PCL_OctreeGPU, exactNeighbourSearch)
+{
+    exactNeighbourSearch(1);
+}
+
+TEST(PCL_OctreeGPU, exactKNeighbourSearch)
+{
+    exactNeighbourSearch(20);
+}
+
+TEST(PCL_OctreeGPU, octreeSearch)
+{
+    DataGenerator data;
+    data.data_size = 100000;
+    data.tests_num = 1000;
+    data.cube_size = 1024.f;
+    data.max_radius    = data.cube_size/30.f;
+    data.shared_radius = data.cube_size/30.f;
+    data();
+
+    const int k = 10;
+
+    pcl::PointCloud<pcl::PointXYZ>::Ptr cloud(new pcl::PointCloud<pcl::PointXYZ>);
+    cloud->resize(data.points.size());
+    std::transform(data.points.cbegin(), data.points.cend(), cloud->begin(), DataGenerator::ConvPoint<pcl::PointXYZ>());
+
+    pcl::PointCloud<pcl::PointXYZ> queries;
+    queries.resize(data.queries.size());
+    std::transform(data.queries.cbegin(), data.queries.cend(), queries.begin(), DataGenerator::ConvPoint<pcl::PointXYZ>());
+
+    pcl::gpu::OctreeSearch search;
+    search.setInputCloud(cloud);
+
+    pcl::octree::OctreePointCloudSearch<pcl::PointXYZ> octree_host(25.f);
+    octree_host.setInputCloud (cloud);
+    octree_host.addPointsFromInputCloud();
+
+    std::vector<pcl::Indices> result_gpu;
+    std::vector<std::vector<float> > dists_gpu;
+    search.nearestKSearch(queries, pcl::Indices(), k, result_gpu, dists_gpu);
+    ASSERT_EQ(queries.size(), result_gpu.size());
+
+    pcl::Indices result_host;
+    std::vector<float> dists_host;
+    for(std::size_t i = 0; i < queries.size(); ++i)
+    {
+        octree_host.nearestKSearch(queries[i], k, result_host, dists_host);
+        ASSERT_EQ(result_host.size(), result_gpu[i].size());
+        for(std::size_t n = 0; n < result_host.size(); ++n)
+            EXPECT_NEAR(dists_host[n], dists_gpu[i][n], 1e-2);
+
+        pcl::Indices single;
+        std::vector<float> single_dists;
+        if (i < 10)
+        {
+            ASSERT_EQ(k, search.nearestKSearch(queries[i], k, single, single_dists));
+            EXPECT_EQ(result_gpu[i], single);
+        }
+    }
+}
+
 /* ---[ */
 int
 main (int argc, char** argv)
@@ -39,6 +39,7 @@
 #include <iostream>
 #include <fstream>
 #include <numeric>
+#include <algorithm>
 
 #if defined _MSC_VER
     #pragma warning (disable: 4521)
@@ -225,6 +226,75 @@ TEST(PCL_OctreeGPU, batchRadiusSearch)
     ASSERT_GT(avg_size3, 5);
 }
 
+TEST(PCL_OctreeGPU, insertRemove)
+{
+    DataGenerator data;
+    data.data_size = 100000;
+    data.tests_num = 1000;
+    data.cube_size = 1024.f;
+    data.max_radius    = data.cube_size/30.f;
+    data.shared_radius = data.cube_size/30.f;
+
+    const int max_answers = 333;
+
+    //generate
+    data();
+
+    //the corners fix the bounding box, so the inserted points are merged instead of rebuilding
+    data.points[0].x = data.points[0].y = data.points[0].z = 0.f;
+    data.points[1].x = data.points[1].y = data.points[1].z = data.cube_size;
+
+    const std::size_t half = data.points.size() / 2;
+    pcl::gpu::Octree::PointCloud first_half, second_half;
+    first_half.upload(&data.points[0], half);
+    second_half.upload(&data.points[half], data.points.size() - half);
+
+    //gpu build, insert and remove
+    pcl::gpu::Octree octree_device;
+    octree_device.setCloud(first_half);
+    octree_device.build();
+    octree_device.insert(second_half);
+
+    pcl::gpu::Octree::PointType min_pt, max_pt;
+    min_pt.x = min_pt.y = min_pt.z = data.cube_size/4;
+    max_pt.x = max_pt.y = max_pt.z = data.cube_size/2;
+    octree_device.remove(min_pt, max_pt);
+
+    //the remaining points keep their order
+    const auto inside = [&] (const pcl::gpu::Octree::PointType& p)
+    {
+        return p.x >= min_pt.x && p.y >= min_pt.y && p.z >= min_pt.z && p.x <= max_pt.x && p.y <= max_pt.y && p.z <= max_pt.z;
+    };
+    data.points.erase(std::remove_if(data.points.begin(), data.points.end(), inside), data.points.end());
+    ASSERT_EQ(octree_device.cloud_->size(), data.points.size());
+
+    data.bruteForceSearch(false, data.shared_radius);
+
+    pcl::gpu::Octree::Queries queries_device;
+    queries_device.upload(data.queries);
+
+    pcl::gpu::NeighborIndices result_device(queries_device.size(), max_answers);
+    octree_device.radiusSearch(queries_device, data.shared_radius, max_answers, result_device);
+
+    std::vector<int> sizes, downloaded_buffer, results_batch, results_host;
+    result_device.sizes.download(sizes);
+    result_device.data.download(downloaded_buffer);
+
+    //verify results
+    for(std::size_t i = 0; i < data.tests_num; ++i)
+    {
+        ASSERT_LT(sizes[i], max_answers);
+
+        results_batch.assign(downloaded_buffer.begin() + i * max_answers, downloaded_buffer.begin() + i * max_answers + sizes[i]);
+        std::sort(results_batch.begin(), results_batch.end());
+        ASSERT_EQ ( ( results_batch == data.bfresutls[i] ), true );
+
+        octree_device.radiusSearchHost(data.queries[i], data.shared_radius, results_host);
+        std::sort(results_host.begin(), results_host.end());
+        ASSERT_EQ ( ( results_host == data.bfresutls[i] ), true );
+    }
+}
+
 /* ---[ */
 int
 main (int argc, char** argv)
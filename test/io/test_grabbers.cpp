@@ -101,6 +101,56 @@ TEST (PCL, PCDGrabber)
 
 }
 
+TEST (PCL, PCDGrabberReadAhead)
+{
+  pcl::PCDGrabber<PointT> grabber (pcd_files_, 10, false);
+  grabber.setReadAhead (2, 2);
+  grabber.setUseMemoryMapping (true);
+  EXPECT_EQ (grabber.getReadAhead (), 2);
+  EXPECT_TRUE (grabber.getUseMemoryMapping ());
+  EXPECT_FALSE (grabber.seek (pcds_.size ()));
+  std::vector<CloudT::ConstPtr> grabbed_clouds;
+  std::function<void (const pcl::PointCloud<pcl::PointXYZRGBA>::ConstPtr&)>
+    fxn = [&] (const pcl::PointCloud<pcl::PointXYZRGBA>::ConstPtr& input_cloud) { grabbed_clouds.push_back (input_cloud); };
+  grabber.registerCallback (fxn);
+
+  const auto expect_frames = [&] (std::size_t first)
+  {
+    ASSERT_EQ (pcds_.size () - first, grabbed_clouds.size ());
+    for (std::size_t i = 0; i < grabbed_clouds.size (); i++)
+    {
+      const CloudT& pcd = *pcds_[first + i];
+      const CloudT& grabbed = *grabbed_clouds[i];
+      ASSERT_EQ (grabbed.size (), pcd.size ());
+      for (std::size_t j = 0; j < pcd.size (); j++)
+      {
+        if (std::isnan (pcd[j].x))
+          EXPECT_TRUE (std::isnan (grabbed[j].x));
+        else
+        {
+          EXPECT_FLOAT_EQ (pcd[j].x, grabbed[j].x);
+          EXPECT_FLOAT_EQ (pcd[j].y, grabbed[j].y);
+          EXPECT_FLOAT_EQ (pcd[j].z, grabbed[j].z);
+        }
+        EXPECT_EQ (pcd[j].rgba, grabbed[j].rgba);
+      }
+    }
+  };
+
+  grabber.start ();
+  std::this_thread::sleep_for(1s);
+  grabber.stop ();
+  expect_frames (0);
+
+  // Seeking drops the decoded frames and continues from the given one
+  ASSERT_TRUE (grabber.seek (1));
+  grabbed_clouds.clear ();
+  grabber.start ();
+  std::this_thread::sleep_for(1s);
+  grabber.stop ();
+  expect_frames (1);
+}
+
 TEST (PCL, ImageGrabberTIFF)
 {
   // Get all clouds from the grabber
@@ -273,7 +323,7 @@ TEST (PCL, ImageGrabberOMP)
   std::function<void (const pcl::PointCloud<pcl::PointXYZRGBA>::ConstPtr&)>
     fxn = [&] (const CloudT::ConstPtr& input_cloud) { cloud_callback (signal_received, cloud_buffer, input_cloud); };
   grabber.registerCallback (fxn);
-  grabber.setNumberOfThreads (0); // Let OMP select
+  grabber.setNumberOfThreads (0); // Take what the budget of pcl::ExecutionContext grants
   grabber.start ();
   for (std::size_t i = 0; i < grabber.size (); i++)
   {
@@ -39,17 +39,27 @@
 
 #include <pcl/test/gtest.h>
 #include <pcl/PCLPointCloud2.h>
+#include <pcl/PolygonMesh.h>
 #include <pcl/type_traits.h>
 #include <pcl/point_types.h>
 #include <pcl/common/io.h>
 #include <pcl/console/print.h>
+#include <pcl/common/cpu_dispatch.h>
 #include <pcl/io/auto_io.h>
 #include <pcl/io/pcd_io.h>
+#include <pcl/io/async_pcd_writer.h>
+#include <pcl/io/cloud_sequence.h>
+#include <pcl/io/debayer.h>
 #include <pcl/io/ply_io.h>
 #include <pcl/io/ascii_io.h>
 #include <pcl/io/obj_io.h>
+#include <algorithm>
+#include <cstring>
 #include <fstream>
+#include <iterator>
 #include <locale>
+#include <mutex>
+#include <random>
 #include <stdexcept>
 
 using namespace pcl;
@@ -732,6 +742,423 @@ TEST (PCL, PCDReaderWriter)
   remove ("test_pcl_io.pcd");
 }
 
+TEST (PCL, PCDReaderBinaryTyped)
+{
+  PointCloud<PointXYZRGBA> cloud (321, 123);
+  cloud.sensor_origin_ = Eigen::Vector4f (1.0f, 2.0f, 3.0f, 0.0f);
+  srand (static_cast<unsigned int> (time (nullptr)));
+  for (auto &point : cloud)
+  {
+    point.x = static_cast<float> (1024 * rand () / (RAND_MAX + 1.0));
+    point.y = static_cast<float> (1024 * rand () / (RAND_MAX + 1.0));
+    point.z = static_cast<float> (1024 * rand () / (RAND_MAX + 1.0));
+    point.rgba = static_cast<std::uint32_t> (rand ());
+  }
+  cloud[4711].z = std::numeric_limits<float>::quiet_NaN ();
+  cloud.is_dense = false;
+
+  PCDWriter writer;
+  PCDReader reader;
+  const std::string file_name = "test_pcl_io_typed.pcd";
+  for (const bool packed : {true, false})
+  {
+    // Packed files are written per point type, the blob keeps the padding of the struct
+    if (packed)
+      writer.writeBinary (file_name, cloud);
+    else
+    {
+      pcl::PCLPointCloud2 blob;
+      toPCLPointCloud2 (cloud, blob);
+      writer.writeBinary (file_name, blob, cloud.sensor_origin_, cloud.sensor_orientation_);
+    }
+
+    // Same point type, and a subset of the fields
+    pcl::PCLPointCloud2 blob;
+    ASSERT_EQ (reader.read (file_name, blob), 0);
+    PointCloud<PointXYZRGBA> expected;
+    PointCloud<PointXYZ> expected_xyz;
+    fromPCLPointCloud2 (blob, expected);
+    fromPCLPointCloud2 (blob, expected_xyz);
+
+    PointCloud<PointXYZRGBA> typed;
+    PointCloud<PointXYZ> typed_xyz;
+    ASSERT_EQ (reader.read (file_name, typed), 0);
+    ASSERT_EQ (reader.read (file_name, typed_xyz), 0);
+
+    EXPECT_EQ (typed.width, cloud.width);
+    EXPECT_EQ (typed.height, cloud.height);
+    EXPECT_FALSE (typed.is_dense);
+    EXPECT_FALSE (typed_xyz.is_dense);
+    EXPECT_EQ (typed.sensor_origin_, cloud.sensor_origin_);
+    ASSERT_EQ (typed.size (), expected.size ());
+    ASSERT_EQ (typed_xyz.size (), expected_xyz.size ());
+    for (std::size_t i = 0; i < typed.size (); ++i)
+    {
+      // Compare the fields, the padding of the points is not initialized
+      EXPECT_EQ (std::memcmp (typed[i].data, expected[i].data, 3 * sizeof (float)), 0);
+      EXPECT_EQ (typed[i].rgba, expected[i].rgba);
+      EXPECT_EQ (std::memcmp (typed_xyz[i].data, expected_xyz[i].data, 3 * sizeof (float)), 0);
+    }
+  }
+
+  // Without padding, the file layout matches the point type exactly
+  PointCloud<PointXY> cloud_xy;
+  copyPointCloud (cloud, cloud_xy);
+  writer.writeBinary (file_name, cloud_xy);
+  PointCloud<PointXY> typed_xy;
+  ASSERT_EQ (reader.read (file_name, typed_xy), 0);
+  ASSERT_EQ (typed_xy.size (), cloud_xy.size ());
+  EXPECT_EQ (typed_xy.width, cloud_xy.width);
+  EXPECT_EQ (std::memcmp (typed_xy.data (), cloud_xy.data (), cloud_xy.size () * sizeof (PointXY)), 0);
+
+  remove (file_name.c_str ());
+}
+
+TEST (PCL, PCDChunkedBinaryCompressed)
+{
+  PointCloud<PointXYZRGBNormal> cloud (640, 48);
+  srand (static_cast<unsigned int> (time (nullptr)));
+  for (auto &point : cloud)
+  {
+    point.x = static_cast<float> (1024 * rand () / (RAND_MAX + 1.0));
+    point.y = static_cast<float> (1024 * rand () / (RAND_MAX + 1.0));
+    point.z = static_cast<float> (1024 * rand () / (RAND_MAX + 1.0));
+    point.rgba = static_cast<std::uint32_t> (rand ());
+    point.normal_x = static_cast<float> (rand () / (RAND_MAX + 1.0));
+    point.curvature = static_cast<float> (rand () / (RAND_MAX + 1.0));
+  }
+  cloud[1234].normal_z = std::numeric_limits<float>::quiet_NaN ();
+  cloud.is_dense = false;
+
+  PCDWriter writer;
+  PCDReader reader;
+  writer.writeBinaryCompressed ("test_pcl_io_single.pcd", cloud);
+  pcl::PCLPointCloud2 expected;
+  ASSERT_EQ (reader.read ("test_pcl_io_single.pcd", expected), 0);
+
+  writer.setCompressionChunkSize (1000);
+  writer.setNumberOfThreads (4);
+  reader.setNumberOfThreads (4);
+  for (const bool typed : {true, false})
+  {
+    if (typed)
+      ASSERT_EQ (writer.writeBinaryCompressed ("test_pcl_io_chunked.pcd", cloud), 0);
+    else
+      ASSERT_EQ (writer.writeBinaryCompressed ("test_pcl_io_chunked.pcd", expected), 0);
+
+    pcl::PCLPointCloud2 blob;
+    int pcd_version, data_type;
+    unsigned int data_idx;
+    Eigen::Vector4f origin;
+    Eigen::Quaternionf orientation;
+    ASSERT_EQ (reader.readHeader ("test_pcl_io_chunked.pcd", blob, origin, orientation,
+                                  pcd_version, data_type, data_idx), 0);
+    EXPECT_EQ (data_type, 3);
+
+    ASSERT_EQ (reader.read ("test_pcl_io_chunked.pcd", blob), 0);
+    EXPECT_EQ (blob.width, expected.width);
+    EXPECT_EQ (blob.height, expected.height);
+    EXPECT_EQ (blob.point_step, expected.point_step);
+    EXPECT_FALSE (blob.is_dense);
+    EXPECT_EQ (blob.data, expected.data);
+
+    PointCloud<PointXYZRGBNormal> cloud_in;
+    ASSERT_EQ (reader.read ("test_pcl_io_chunked.pcd", cloud_in), 0);
+    ASSERT_EQ (cloud_in.size (), cloud.size ());
+    for (std::size_t i = 0; i < cloud.size (); ++i)
+    {
+      EXPECT_EQ (cloud_in[i].rgba, cloud[i].rgba);
+      EXPECT_EQ (cloud_in[i].curvature, cloud[i].curvature);
+    }
+  }
+
+  // A corrupted chunk count must be rejected before the chunk index is allocated
+  {
+    pcl::PCLPointCloud2 blob;
+    int pcd_version, data_type;
+    unsigned int data_idx;
+    Eigen::Vector4f origin;
+    Eigen::Quaternionf orientation;
+    ASSERT_EQ (reader.readHeader ("test_pcl_io_chunked.pcd", blob, origin, orientation,
+                                  pcd_version, data_type, data_idx), 0);
+    for (const std::uint32_t nr_chunks : {0xffffffffu, 32u})
+    {
+      std::fstream fs ("test_pcl_io_chunked.pcd", std::ios::in | std::ios::out | std::ios::binary);
+      fs.seekp (data_idx + 8);
+      fs.write (reinterpret_cast<const char*> (&nr_chunks), sizeof (nr_chunks));
+      fs.close ();
+      EXPECT_LT (reader.read ("test_pcl_io_chunked.pcd", blob), 0);
+    }
+  }
+
+  remove ("test_pcl_io_single.pcd");
+  remove ("test_pcl_io_chunked.pcd");
+}
+
+TEST (PCL, AsyncPCDWriter)
+{
+  PointCloud<PointXYZI>::Ptr cloud (new PointCloud<PointXYZI> (320, 24));
+  srand (static_cast<unsigned int> (time (nullptr)));
+  for (auto &point : *cloud)
+  {
+    point.x = static_cast<float> (1024 * rand () / (RAND_MAX + 1.0));
+    point.y = static_cast<float> (1024 * rand () / (RAND_MAX + 1.0));
+    point.z = static_cast<float> (1024 * rand () / (RAND_MAX + 1.0));
+    point.intensity = static_cast<float> (rand ());
+  }
+  pcl::PCLPointCloud2::Ptr blob (new pcl::PCLPointCloud2);
+  toPCLPointCloud2 (*cloud, *blob);
+
+  PCDWriter writer;
+  writer.writeBinary ("test_pcl_io_sync.pcd", *cloud);
+  writer.writeBinary ("test_pcl_io_sync_blob.pcd", *blob);
+  writer.writeBinaryCompressed ("test_pcl_io_sync_compressed.pcd", *cloud);
+
+  const auto readFile = [] (const std::string &file_name)
+  {
+    std::ifstream fs (file_name.c_str (), std::ios::binary);
+    return (std::string ((std::istreambuf_iterator<char> (fs)), std::istreambuf_iterator<char> ()));
+  };
+
+  std::mutex mutex;
+  std::vector<std::string> written;
+  {
+    pcl::io::AsyncPCDWriter async_writer (2, 2);
+    async_writer.setCallback ([&] (const std::string &file_name, int result)
+    {
+      std::lock_guard<std::mutex> lock (mutex);
+      if (result == 0)
+        written.push_back (file_name);
+    });
+
+    std::future<int> result = async_writer.writeBinary ("test_pcl_io_async.pcd", cloud);
+    async_writer.writeBinary ("test_pcl_io_async_blob.pcd", blob);
+    async_writer.writeBinaryCompressed ("test_pcl_io_async_compressed.pcd", cloud);
+    async_writer.writeBinary ("test_pcl_io_async_moved.pcd", PointCloud<PointXYZI> (*cloud));
+    EXPECT_EQ (result.get (), 0);
+
+    async_writer.flush ();
+    EXPECT_EQ (async_writer.getQueueSize (), 0u);
+    EXPECT_EQ (written.size (), 4u);
+
+    // Writes queued before destruction are still done
+    async_writer.writeBinary ("test_pcl_io_async_last.pcd", cloud);
+  }
+  EXPECT_EQ (written.size (), 5u);
+
+  const std::string expected = readFile ("test_pcl_io_sync.pcd");
+  EXPECT_FALSE (expected.empty ());
+  EXPECT_EQ (readFile ("test_pcl_io_async.pcd"), expected);
+  EXPECT_EQ (readFile ("test_pcl_io_async_moved.pcd"), expected);
+  EXPECT_EQ (readFile ("test_pcl_io_async_last.pcd"), expected);
+  EXPECT_EQ (readFile ("test_pcl_io_async_blob.pcd"), readFile ("test_pcl_io_sync_blob.pcd"));
+  EXPECT_EQ (readFile ("test_pcl_io_async_compressed.pcd"), readFile ("test_pcl_io_sync_compressed.pcd"));
+
+  for (const auto &file_name : {"test_pcl_io_sync.pcd", "test_pcl_io_sync_blob.pcd",
+                                "test_pcl_io_sync_compressed.pcd", "test_pcl_io_async.pcd",
+                                "test_pcl_io_async_blob.pcd", "test_pcl_io_async_compressed.pcd",
+                                "test_pcl_io_async_moved.pcd", "test_pcl_io_async_last.pcd"})
+    remove (file_name);
+}
+
+TEST (PCL, CloudSequence)
+{
+  std::mt19937 rng (42);
+  std::uniform_real_distribution<float> dist (-10.0f, 10.0f);
+  std::vector<PointCloud<PointXYZRGBNormal>, Eigen::aligned_allocator<PointCloud<PointXYZRGBNormal> > > clouds (5);
+  for (std::size_t i = 0; i < clouds.size (); ++i)
+  {
+    clouds[i].resize (40 + 10 * i, 3);
+    for (auto &point : clouds[i])
+    {
+      point.getVector3fMap () = Eigen::Vector3f (dist (rng), dist (rng), dist (rng));
+      point.getNormalVector3fMap () = Eigen::Vector3f (dist (rng), dist (rng), dist (rng));
+      point.rgba = rng ();
+    }
+    // Runs of equal points, which LZF compresses
+    for (std::size_t j = 1; j < clouds[i].size (); j += 2)
+      clouds[i][j] = clouds[i][j - 1];
+    clouds[i].header.stamp = 1000 * (i + 1);
+    clouds[i].sensor_origin_ = Eigen::Vector4f (static_cast<float> (i), 1.0f, 2.0f, 0.0f);
+    clouds[i].sensor_orientation_ = Eigen::Quaternionf (Eigen::AngleAxisf (0.1f * i, Eigen::Vector3f::UnitZ ()));
+  }
+
+  for (const bool compress : {false, true})
+  {
+    pcl::io::CloudSequenceWriter writer;
+    ASSERT_EQ (writer.open ("test_pcl_io_sequence.pcs", compress), 0);
+    for (const auto &cloud : clouds)
+      ASSERT_EQ (writer.write (cloud), 0);
+    EXPECT_EQ (writer.size (), clouds.size ());
+    ASSERT_EQ (writer.close (), 0);
+
+    pcl::io::CloudSequenceReader reader;
+    ASSERT_EQ (reader.open ("test_pcl_io_sequence.pcs"), 0);
+    ASSERT_EQ (reader.size (), clouds.size ());
+    EXPECT_EQ (reader.findFrame (0), 0u);
+    EXPECT_EQ (reader.findFrame (2000), 1u);
+    EXPECT_EQ (reader.findFrame (2001), 2u);
+    EXPECT_EQ (reader.findFrame (100000), clouds.size ());
+
+    // Random access, in reverse order
+    for (std::size_t i = clouds.size (); i-- > 0; )
+    {
+      EXPECT_EQ (reader.getTimestamp (i), clouds[i].header.stamp);
+
+      PointCloud<PointXYZRGBNormal> cloud;
+      ASSERT_EQ (reader.read (i, cloud), 0);
+      EXPECT_EQ (cloud.header.stamp, clouds[i].header.stamp);
+      EXPECT_EQ (cloud.width, clouds[i].width);
+      EXPECT_EQ (cloud.height, clouds[i].height);
+      EXPECT_TRUE (cloud.sensor_origin_.isApprox (clouds[i].sensor_origin_));
+      EXPECT_TRUE (cloud.sensor_orientation_.isApprox (clouds[i].sensor_orientation_));
+      ASSERT_EQ (cloud.size (), clouds[i].size ());
+      for (std::size_t j = 0; j < cloud.size (); ++j)
+      {
+        EXPECT_EQ (cloud[j].getVector3fMap (), clouds[i][j].getVector3fMap ());
+        EXPECT_EQ (cloud[j].getNormalVector3fMap (), clouds[i][j].getNormalVector3fMap ());
+        EXPECT_EQ (cloud[j].rgba, clouds[i][j].rgba);
+      }
+
+      // Into a point type with a subset of the fields
+      PointCloud<PointXYZ> xyz;
+      ASSERT_EQ (reader.read (i, xyz), 0);
+      ASSERT_EQ (xyz.size (), clouds[i].size ());
+      for (std::size_t j = 0; j < xyz.size (); ++j)
+        EXPECT_EQ (xyz[j].getVector3fMap (), clouds[i][j].getVector3fMap ());
+
+      pcl::PCLPointCloud2 blob, expected;
+      toPCLPointCloud2 (clouds[i], expected);
+      ASSERT_EQ (reader.read (i, blob), 0);
+      EXPECT_EQ (blob.data, expected.data);
+      EXPECT_EQ (blob.fields.size (), expected.fields.size ());
+    }
+    PointCloud<PointXYZ> xyz;
+    EXPECT_NE (reader.read (clouds.size (), xyz), 0);
+  }
+
+  // A file without index can not be opened
+  {
+    std::ofstream truncated ("test_pcl_io_sequence.pcs", std::ios::binary);
+    truncated << "PCLSEQ";
+  }
+  pcl::io::CloudSequenceReader reader;
+  EXPECT_NE (reader.open ("test_pcl_io_sequence.pcs"), 0);
+  remove ("test_pcl_io_sequence.pcs");
+}
+
+TEST (PCL, PCDReaderASCIIParallel)
+{
+  // Tokens that are parsed by the fast path and tokens that must fall back to the stream conversion
+  const std::vector<std::string> special_floats = {"nan", "NaN", "-0", "1.", ".5", "+3", "1e-40", "-1E+39",
+                                                   "3.4028235e38", "16777217", "0.1234567890123456789",
+                                                   "1.0000000596046448", "7e22", "1e-4", "inf", "12abc"};
+  const std::vector<std::string> special_ints = {"0", "-0", "+7", "200", "-1", "70000", "12.7", "nan",
+                                                 "4294967295", "-2147483648", "x"};
+  std::mt19937 gen (42);
+  std::uniform_real_distribution<double> real (-1000.0, 1000.0);
+  std::uniform_int_distribution<int> choice (0, 31);
+
+  const std::size_t nr_points = 20000;
+  std::vector<std::vector<std::string> > lines (nr_points);
+  char buf[64];
+  for (auto &tokens : lines)
+  {
+    for (int t = 0; t < 2; ++t)
+    {
+      const int c = choice (gen);
+      if (c < static_cast<int> (special_floats.size ()))
+        tokens.emplace_back (special_floats[choice (gen) % special_floats.size ()]);
+      else
+      {
+        sprintf (buf, c % 2 ? "%.*g" : "%.*e", 1 + c % 17, real (gen));
+        tokens.emplace_back (buf);
+      }
+    }
+    for (int t = 0; t < 7; ++t)
+    {
+      const int c = choice (gen);
+      if (c < static_cast<int> (special_ints.size ()))
+        tokens.emplace_back (special_ints[c]);
+      else
+        tokens.emplace_back (std::to_string (static_cast<int> (real (gen) * (t + 1) / 8)));
+    }
+  }
+  lines[7].pop_back (); // malformed point
+
+  std::ofstream fs;
+  fs.open ("test_pcl_io_ascii_parallel.pcd", std::ios::binary);
+  fs << "# .PCD v0.7 - Point Cloud Data file format\n"
+        "VERSION 0.7\n"
+        "FIELDS x d c u s w i n\n"
+        "SIZE 4 8 1 1 2 2 4 4\n"
+        "TYPE F F I U I U I U\n"
+        "COUNT 1 1 1 1 1 1 1 2\n"
+        "WIDTH " << nr_points << "\n"
+        "HEIGHT 1\n"
+        "VIEWPOINT 0 0 0 1 0 0 0\n"
+        "POINTS " << nr_points << "\n"
+        "DATA ascii\n";
+  for (std::size_t i = 0; i < lines.size (); ++i)
+  {
+    if (i % 1000 == 0)
+      fs << "\n";
+    fs << (i % 3 ? " " : "");
+    for (const auto &token : lines[i])
+      fs << token << (i % 5 ? " " : " \t ");
+    fs << (i % 2 ? "\n" : "\r\n");
+  }
+  fs << "1 2 3 4 5 6 7 8 9\n"; // more points than advertised
+  fs.close ();
+
+  // Reference conversion with the stream based copyStringValue ()
+  PCDReader reader;
+  pcl::PCLPointCloud2 expected;
+  ASSERT_EQ (reader.readHeader ("test_pcl_io_ascii_parallel.pcd", expected), 0);
+  expected.is_dense = true;
+  for (std::size_t i = 0; i < lines.size (); ++i)
+  {
+    if (lines[i].size () != 9)
+      continue;
+    const auto index = static_cast<pcl::index_t> (i);
+    copyStringValue<float> (lines[i][0], expected, index, 0, 0);
+    copyStringValue<double> (lines[i][1], expected, index, 1, 0);
+    copyStringValue<std::int8_t> (lines[i][2], expected, index, 2, 0);
+    copyStringValue<std::uint8_t> (lines[i][3], expected, index, 3, 0);
+    copyStringValue<std::int16_t> (lines[i][4], expected, index, 4, 0);
+    copyStringValue<std::uint16_t> (lines[i][5], expected, index, 5, 0);
+    copyStringValue<std::int32_t> (lines[i][6], expected, index, 6, 0);
+    copyStringValue<std::uint32_t> (lines[i][7], expected, index, 7, 0);
+    copyStringValue<std::uint32_t> (lines[i][8], expected, index, 7, 1);
+  }
+  EXPECT_FALSE (expected.is_dense);
+
+  for (const unsigned int nr_threads : {1u, 4u, 0u})
+  {
+    reader.setNumberOfThreads (nr_threads);
+    pcl::PCLPointCloud2 blob;
+    ASSERT_EQ (reader.read ("test_pcl_io_ascii_parallel.pcd", blob), 0);
+    EXPECT_EQ (blob.width, nr_points);
+    EXPECT_FALSE (blob.is_dense);
+    EXPECT_EQ (blob.data, expected.data);
+    // The stream version reads the same points
+    std::ifstream is ("test_pcl_io_ascii_parallel.pcd", std::ios::binary);
+    pcl::PCLPointCloud2 stream_blob;
+    Eigen::Vector4f origin;
+    Eigen::Quaternionf orientation;
+    int pcd_version, data_type;
+    unsigned int data_idx;
+    ASSERT_EQ (reader.readHeader ("test_pcl_io_ascii_parallel.pcd", stream_blob, origin, orientation,
+                                  pcd_version, data_type, data_idx), 0);
+    is.seekg (data_idx);
+    ASSERT_EQ (reader.readBodyASCII (is, stream_blob, pcd_version), 0);
+    EXPECT_EQ (stream_blob.data, expected.data);
+  }
+
+  remove ("test_pcl_io_ascii_parallel.pcd");
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 TEST (PCL, PCDReaderWriterASCIIColorPrecision)
 {
   PointCloud<PointXYZRGB> cloud;
@@ -913,6 +1340,68 @@ TEST(PCL, OBJRead)
   remove ("test_obj.mtl");
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, OBJReadParallel)
+{
+  // Large enough to be split into several chunks, with relative and absolute face indices
+  const int nr_blocks = 20000;
+  std::ofstream fs;
+  fs.open ("test_obj_parallel.obj");
+  fs << "o Strip\n";
+  for (int b = 0; b < nr_blocks; ++b)
+  {
+    for (int i = 0; i < 4; ++i)
+      fs << "v " << b << " " << i << " " << 0.5 * i << "\n"
+            "vn 0 0 1\n"
+            "vt 0.5 0.5\n";
+    fs << "f -4 -3 -2\n"
+          "f " << 4 * b + 2 << "/1/2 " << 4 * b + 4 << "//4 " << 4 * b + 3 << "\r\n";
+  }
+  fs.close ();
+
+  for (const unsigned int threads : {0u, 1u, 4u})
+  {
+    pcl::OBJReader reader;
+    reader.setNumberOfThreads (threads);
+
+    pcl::PolygonMesh mesh;
+    ASSERT_EQ (reader.read ("test_obj_parallel.obj", mesh), 0);
+    ASSERT_EQ (mesh.cloud.width, 4 * nr_blocks);
+    ASSERT_EQ (mesh.cloud.fields.size (), 6);
+    ASSERT_EQ (mesh.polygons.size (), 2 * nr_blocks);
+
+    std::vector<std::uint32_t> indices, offsets;
+    pcl::PCLPointCloud2 cloud;
+    ASSERT_EQ (reader.read ("test_obj_parallel.obj", cloud, indices, offsets), 0);
+    EXPECT_EQ (cloud.data, mesh.cloud.data);
+    ASSERT_EQ (offsets.size (), 2 * nr_blocks + 1);
+    ASSERT_EQ (indices.size (), offsets.back ());
+
+    for (int b = 0; b < nr_blocks; ++b)
+    {
+      const std::vector<std::uint32_t> first {4u * b, 4u * b + 1, 4u * b + 2};
+      const std::vector<std::uint32_t> second {4u * b + 1, 4u * b + 3, 4u * b + 2};
+      ASSERT_EQ (mesh.polygons[2 * b].vertices.size (), first.size ());
+      ASSERT_EQ (mesh.polygons[2 * b + 1].vertices.size (), second.size ());
+      EXPECT_TRUE (std::equal (first.begin (), first.end (), mesh.polygons[2 * b].vertices.begin ()));
+      EXPECT_TRUE (std::equal (second.begin (), second.end (), mesh.polygons[2 * b + 1].vertices.begin ()));
+      EXPECT_TRUE (std::equal (first.begin (), first.end (), indices.begin () + offsets[2 * b]));
+      EXPECT_TRUE (std::equal (second.begin (), second.end (), indices.begin () + offsets[2 * b + 1]));
+    }
+
+    float x, y, z;
+    const std::size_t last = 4 * nr_blocks - 1;
+    std::memcpy (&x, &mesh.cloud.data[last * mesh.cloud.point_step], sizeof (float));
+    std::memcpy (&y, &mesh.cloud.data[last * mesh.cloud.point_step + 4], sizeof (float));
+    std::memcpy (&z, &mesh.cloud.data[last * mesh.cloud.point_step + 8], sizeof (float));
+    EXPECT_EQ (x, nr_blocks - 1);
+    EXPECT_EQ (y, 3.0f);
+    EXPECT_EQ (z, 1.5f);
+  }
+
+  remove ("test_obj_parallel.obj");
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 struct PointXYZFPFH33
@@ -1236,6 +1725,73 @@ TEST (PCL, LZFInMem)
   }
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, DeBayerAndYUV422Kernels)
+{
+  std::mt19937 rng (42);
+  std::uniform_int_distribution<int> byte (0, 255);
+  // Widths with and without a remainder after the blocks of the kernels, padded RGB lines
+  for (const unsigned width : {6u, 38u, 70u, 118u})
+  {
+    const unsigned height = 12;
+    const unsigned rgb_line_step = width * 3 + 5;
+    std::vector<unsigned char> bayer (width * height), yuv (width * height * 2);
+    for (auto &value : bayer)
+      value = static_cast<unsigned char> (byte (rng));
+    for (auto &value : yuv)
+      value = static_cast<unsigned char> (byte (rng));
+
+    // The portable code on a single thread is the reference
+    pcl::setSIMDLevel (pcl::SIMDLevel::NONE);
+    std::vector<unsigned char> bilinear (rgb_line_step * height), edge_aware (rgb_line_step * height);
+    std::vector<unsigned char> edge_aware_weighted (rgb_line_step * height);
+    pcl::io::DeBayer debayer;
+    debayer.debayerBilinear (bayer.data (), bilinear.data (), width, height, 0, 0, rgb_line_step);
+    debayer.debayerEdgeAware (bayer.data (), edge_aware.data (), width, height, 0, 0, rgb_line_step);
+    debayer.debayerEdgeAwareWeighted (bayer.data (), edge_aware_weighted.data (), width, height, 0, 0, rgb_line_step);
+
+    // The green of the red pixel in the middle of the image is the average of its four neighbors
+    const unsigned x = 3, y = 4;
+    EXPECT_EQ (bilinear[y * rgb_line_step + 3 * x + 1],
+               (bayer[y * width + x - 1] + bayer[y * width + x + 1] +
+                bayer[(y - 1) * width + x] + bayer[(y + 1) * width + x]) / 4);
+
+    std::vector<unsigned char> yuv_rgb (rgb_line_step * height);
+    for (unsigned line = 0; line < height; ++line)
+      for (unsigned pixel = 0; pixel < width; ++pixel)
+      {
+        const unsigned char *uyvy = &yuv[line * width * 2 + (pixel / 2) * 4];
+        const int u = uyvy[0] - 128, v = uyvy[2] - 128, luma = uyvy[1 + 2 * (pixel % 2)];
+        unsigned char *rgb = &yuv_rgb[line * rgb_line_step + 3 * pixel];
+        rgb[0] = static_cast<unsigned char> (std::min (255, std::max (0, luma + ((v * 18678 + 8192) >> 14))));
+        rgb[1] = static_cast<unsigned char> (std::min (255, std::max (0, luma + ((v * -9519 - u * 6472 + 8192) >> 14))));
+        rgb[2] = static_cast<unsigned char> (std::min (255, std::max (0, luma + ((u * 33292 + 8192) >> 14))));
+      }
+
+    // Every kernel the CPU supports
+    for (int level = 0; level <= static_cast<int> (pcl::getSupportedSIMDLevel ()); ++level)
+    {
+      pcl::setSIMDLevel (static_cast<pcl::SIMDLevel> (level));
+      for (const unsigned int nr_threads : {0, 1, 4})
+      {
+        debayer.setNumberOfThreads (nr_threads);
+        std::vector<unsigned char> rgb (rgb_line_step * height);
+        debayer.debayerBilinear (bayer.data (), rgb.data (), width, height, 0, 0, rgb_line_step);
+        EXPECT_EQ (rgb, bilinear) << "width " << width << " level " << level;
+        debayer.debayerEdgeAware (bayer.data (), rgb.data (), width, height, 0, 0, rgb_line_step);
+        EXPECT_EQ (rgb, edge_aware) << "width " << width << " level " << level;
+        debayer.debayerEdgeAwareWeighted (bayer.data (), rgb.data (), width, height, 0, 0, rgb_line_step);
+        EXPECT_EQ (rgb, edge_aware_weighted) << "width " << width << " level " << level;
+
+        std::fill (rgb.begin (), rgb.end (), 0);
+        pcl::io::convertYUV422ToRGB (yuv.data (), rgb.data (), width, height, rgb_line_step, nr_threads);
+        EXPECT_EQ (rgb, yuv_rgb) << "width " << width << " level " << level;
+      }
+    }
+  }
+  pcl::setSIMDLevel (pcl::getSupportedSIMDLevel ());
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 TEST (PCL, Locale)
 {
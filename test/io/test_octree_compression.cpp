@@ -40,6 +40,11 @@
 #include <pcl/io/pcd_io.h>
 #include <pcl/compression/octree_pointcloud_compression.h>
 #include <pcl/compression/compression_profiles.h>
+#include <pcl/common/point_tests.h> // for pcl::isFinite
+#include <pcl/pcl_config.h>
+#ifdef HAVE_OPENNI
+#include <pcl/compression/organized_pointcloud_compression.h>
+#endif
 
 #include <exception>
 
@@ -157,6 +162,45 @@ TEST (PCL, OctreeDeCompressionRandomPointXYZRGBASameCloud)
   } // compression profiles
 } // TEST
 
+TEST (PCL, OctreeDeCompressionIndexedFrames)
+{
+  // Frames encoded in parallel decode to the same clouds as serial ones, I-frames and P-frames alike
+  srand(static_cast<unsigned int> (time(NULL)));
+  pcl::PointCloud<pcl::PointXYZRGBA>::Ptr cloud(new pcl::PointCloud<pcl::PointXYZRGBA>());
+  for (unsigned int point = 0; point < 100000; point++)
+    cloud->push_back(generateRandomPoint<pcl::PointXYZRGBA>(10.0f));
+
+  for (const auto compression_profile : {pcl::io::LOW_RES_ONLINE_COMPRESSION_WITH_COLOR, pcl::io::HIGH_RES_OFFLINE_COMPRESSION_WITH_COLOR}) {
+    pcl::io::OctreePointCloudCompression<pcl::PointXYZRGBA> serial_encoder(compression_profile, false);
+    pcl::io::OctreePointCloudCompression<pcl::PointXYZRGBA> parallel_encoder(compression_profile, false);
+    parallel_encoder.setNumberOfThreads(4);
+    pcl::io::OctreePointCloudCompression<pcl::PointXYZRGBA> serial_decoder;
+    pcl::io::OctreePointCloudCompression<pcl::PointXYZRGBA> parallel_decoder;
+    parallel_decoder.setNumberOfThreads(4);
+
+    for (int test_idx = 0; test_idx < NUMBER_OF_TEST_RUNS; test_idx++, total_runs++)
+    {
+      std::stringstream serial_data, parallel_data;
+      serial_encoder.encodePointCloud(cloud, serial_data);
+      parallel_encoder.encodePointCloud(cloud, parallel_data);
+      EXPECT_NE(serial_data.str(), parallel_data.str());
+
+      pcl::PointCloud<pcl::PointXYZRGBA>::Ptr serial_out(new pcl::PointCloud<pcl::PointXYZRGBA>());
+      pcl::PointCloud<pcl::PointXYZRGBA>::Ptr parallel_out(new pcl::PointCloud<pcl::PointXYZRGBA>());
+      serial_decoder.decodePointCloud(serial_data, serial_out);
+      parallel_decoder.decodePointCloud(parallel_data, parallel_out);
+
+      ASSERT_EQ(serial_out->size(), parallel_out->size()) << "Profile: " << compression_profile;
+      for (std::size_t i = 0; i < serial_out->size(); i++) {
+        EXPECT_EQ((*serial_out)[i].x, (*parallel_out)[i].x);
+        EXPECT_EQ((*serial_out)[i].y, (*parallel_out)[i].y);
+        EXPECT_EQ((*serial_out)[i].z, (*parallel_out)[i].z);
+        EXPECT_EQ((*serial_out)[i].rgba, (*parallel_out)[i].rgba);
+      }
+    } // runs
+  } // compression profiles
+} // TEST
+
 TEST(PCL, OctreeDeCompressionFile)
 {
   pcl::PointCloud<pcl::PointXYZRGB>::Ptr input_cloud_ptr (new pcl::PointCloud<pcl::PointXYZRGB>);
@@ -194,6 +238,77 @@ TEST(PCL, OctreeDeCompressionFile)
   }
 }
 
+#ifdef HAVE_OPENNI
+TEST (PCL, OrganizedDeCompressionThreads)
+{
+  // Organized cloud of a tilted plane seen by a camera with a focal length of 500
+  const int width = 64, height = 48;
+  const float focal_length = 500.0f;
+  pcl::PointCloud<pcl::PointXYZRGBA>::Ptr cloud (new pcl::PointCloud<pcl::PointXYZRGBA> (width, height));
+  for (int v = 0; v < height; ++v)
+    for (int u = 0; u < width; ++u)
+    {
+      pcl::PointXYZRGBA& point = (*cloud)(u, v);
+      const float x = static_cast<float> (u - width / 2), y = static_cast<float> (v - height / 2);
+      const float z = 1.0f + 0.01f * static_cast<float> (u + v);
+      point.x = x * z / focal_length;
+      point.y = y * z / focal_length;
+      point.z = z;
+      point.r = static_cast<std::uint8_t> (4 * u);
+      point.g = static_cast<std::uint8_t> (4 * v);
+      point.b = 128;
+      if ((u + 3 * v) % 17 == 0)
+        point.x = point.y = point.z = std::numeric_limits<float>::quiet_NaN ();
+    }
+
+  for (const bool mono : {false, true})
+  {
+    std::vector<std::string> compressed;
+    std::vector<pcl::PointCloud<pcl::PointXYZRGBA>::Ptr> decoded;
+    for (const unsigned int nr_threads : {1u, 4u, 0u})
+    {
+      pcl::io::OrganizedPointCloudCompression<pcl::PointXYZRGBA> coder;
+      coder.setNumberOfThreads (nr_threads);
+      EXPECT_EQ (coder.getNumberOfThreads (), nr_threads);
+      std::stringstream data;
+      coder.encodePointCloud (cloud, data, true, mono, false);
+      compressed.push_back (data.str ());
+
+      pcl::PointCloud<pcl::PointXYZRGBA>::Ptr cloud_out (new pcl::PointCloud<pcl::PointXYZRGBA>);
+      EXPECT_TRUE (coder.decodePointCloud (data, cloud_out, false));
+      decoded.push_back (cloud_out);
+    }
+
+    // The threads do not change the result
+    EXPECT_EQ (compressed[0], compressed[1]);
+    EXPECT_EQ (compressed[0], compressed[2]);
+    ASSERT_EQ (decoded[0]->size (), cloud->size ());
+    ASSERT_EQ (decoded[1]->size (), cloud->size ());
+    ASSERT_EQ (decoded[2]->size (), cloud->size ());
+    for (std::size_t i = 0; i < cloud->size (); ++i)
+    {
+      const pcl::PointXYZRGBA& point = (*cloud)[i];
+      const pcl::PointXYZRGBA& point_out = (*decoded[1])[i];
+      EXPECT_EQ ((*decoded[0])[i].rgba, point_out.rgba);
+      EXPECT_EQ ((*decoded[2])[i].rgba, point_out.rgba);
+      if (!pcl::isFinite (point))
+      {
+        EXPECT_FALSE (pcl::isFinite (point_out));
+        continue;
+      }
+      EXPECT_EQ ((*decoded[0])[i].getVector3fMap (), point_out.getVector3fMap ());
+      EXPECT_EQ ((*decoded[2])[i].getVector3fMap (), point_out.getVector3fMap ());
+      // Disparity quantization
+      EXPECT_NEAR (point_out.z, point.z, 0.01f * point.z * point.z);
+      if (!mono)
+      {
+        EXPECT_EQ (point_out.r, point.r);
+      }
+    }
+  }
+}
+#endif
+
 /* ---[ */
 int
 main (int argc, char** argv)
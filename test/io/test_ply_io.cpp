@@ -42,7 +42,9 @@
 #include <pcl/point_cloud.h>
 #include <pcl/point_types.h>
 #include <pcl/test/gtest.h>
+#include <algorithm> // for reverse
 #include <fstream> // for ofstream
+#include <boost/filesystem.hpp> // for resize_file
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 TEST (PCL, PLYReaderWriter)
@@ -611,6 +613,89 @@ TEST_F (PLYTest, Float64Cloud)
   }
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST_F (PLYTest, BinaryVerticesInBulk)
+{
+  // Binary files in host byte order are read in bulk, the others through the property callbacks
+  const bool host_is_little = (pcl::io::ply::host_byte_order == pcl::io::ply::little_endian_byte_order);
+  const auto write_ply = [this, host_is_little] (bool little_endian, const std::vector<std::pair<std::string, std::string> > &properties,
+                                 std::size_t nr_vertices)
+  {
+    std::ofstream fs (mesh_file_ply_.c_str (), std::ios::binary);
+    fs << "ply\n"
+          "format " << (little_endian ? "binary_little_endian" : "binary_big_endian") << " 1.0\n"
+          "element vertex " << nr_vertices << "\n";
+    for (const auto &property : properties)
+      fs << "property " << property.first << " " << property.second << "\n";
+    fs << "element face 1\n"
+          "property list uchar int vertex_indices\n"
+          "end_header\n";
+    const bool swap = (little_endian != host_is_little);
+    const auto write = [&] (auto value)
+    {
+      char bytes[sizeof (value)];
+      memcpy (bytes, &value, sizeof (value));
+      if (swap)
+        std::reverse (bytes, bytes + sizeof (value));
+      fs.write (bytes, sizeof (value));
+    };
+    for (std::size_t i = 0; i < nr_vertices; ++i)
+    {
+      for (std::size_t j = 0; j < properties.size (); ++j)
+      {
+        if (properties[j].first == "float")
+          write (i == 3 && j == 0 ? std::numeric_limits<float>::quiet_NaN () : 0.5f * i + j);
+        else if (properties[j].first == "double")
+          write (0.25 * i - j);
+        else if (properties[j].first == "int")
+          write (static_cast<std::int32_t> (1000 * i - j));
+        else
+          write (static_cast<std::uint8_t> (7 * i + j));
+      }
+    }
+    fs << static_cast<std::uint8_t> (3);
+    for (const std::int32_t index : {0, 1, 2})
+      write (index);
+  };
+
+  const std::vector<std::vector<std::pair<std::string, std::string> > > layouts = {
+    {{"float", "x"}, {"float", "y"}, {"float", "z"}, {"double", "d"}, {"int", "i"}, {"uchar", "flags"}},
+    {{"float", "x"}, {"float", "y"}, {"float", "z"}, {"uchar", "red"}, {"uchar", "green"}, {"uchar", "blue"},
+     {"uchar", "alpha"}, {"uchar", "intensity"}, {"float", "nx"}},
+    {{"double", "y"}, {"uchar", "diffuse_red"}, {"uchar", "diffuse_green"}, {"uchar", "diffuse_blue"}, {"float", "x"}},
+    {{"float", "x"}, {"uchar", "blue"}, {"uchar", "green"}, {"uchar", "red"}}};
+  for (const auto &layout : layouts)
+  {
+    pcl::PCLPointCloud2 bulk, callbacks;
+    pcl::PolygonMesh mesh;
+    write_ply (host_is_little, layout, 1000);
+    ASSERT_EQ (pcl::io::loadPLYFile (mesh_file_ply_, bulk), 0);
+    ASSERT_EQ (pcl::io::loadPLYFile (mesh_file_ply_, mesh), 0);
+    ASSERT_EQ (mesh.polygons.size (), 1);
+    EXPECT_EQ (mesh.polygons[0].vertices.size (), 3);
+    write_ply (!host_is_little, layout, 1000);
+    ASSERT_EQ (pcl::io::loadPLYFile (mesh_file_ply_, callbacks), 0);
+
+    EXPECT_EQ (bulk.width, 1000);
+    EXPECT_EQ (bulk.point_step, callbacks.point_step);
+    ASSERT_EQ (bulk.fields.size (), callbacks.fields.size ());
+    for (std::size_t f = 0; f < bulk.fields.size (); ++f)
+    {
+      EXPECT_EQ (bulk.fields[f].name, callbacks.fields[f].name);
+      EXPECT_EQ (bulk.fields[f].offset, callbacks.fields[f].offset);
+      EXPECT_EQ (bulk.fields[f].datatype, callbacks.fields[f].datatype);
+    }
+    EXPECT_EQ (bulk.is_dense, callbacks.is_dense);
+    EXPECT_EQ (bulk.data, callbacks.data);
+  }
+
+  // Truncated files are reported
+  write_ply (host_is_little, layouts[0], 1000);
+  pcl::PCLPointCloud2 truncated;
+  boost::filesystem::resize_file (mesh_file_ply_, boost::filesystem::file_size (mesh_file_ply_) - 1000);
+  EXPECT_LT (pcl::io::loadPLYFile (mesh_file_ply_, truncated), 0);
+}
+
 /* ---[ */
 int
 main (int argc, char** argv)
@@ -167,6 +167,43 @@ TEST (PCL, Static_Range_Coder_Test)
 }
 
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, Rans_Coder_Test)
+{
+  // Run test for different vector sizes, including an empty one
+  for (unsigned int vectorSize: { 0, 3, 253, 100000 })
+  {
+    std::stringstream sstream;
+    std::vector<char> inputCharData (vectorSize);
+    std::vector<char> outputCharData (vectorSize);
+
+    std::vector<unsigned int> inputIntData (vectorSize);
+    std::vector<unsigned int> outputIntData (vectorSize);
+
+    // fill vectors with skewed random data; some integers exceed the coder alphabet and are escaped
+    for (std::size_t i=0; i<vectorSize; i++)
+    {
+      inputCharData[i] = static_cast<char> ((rand () & 0xFF) * (rand () & 0xFF) >> 8);
+      inputIntData[i] = (i % 97 == 0) ? static_cast<unsigned int> (rand ()) : static_cast<unsigned int> (rand () & 0x3F);
+    }
+
+    pcl::RansCoder ransCoder;
+
+    unsigned long writeByteLen = ransCoder.encodeCharVectorToStream(inputCharData, sstream);
+    unsigned long readByteLen = ransCoder.decodeStreamToCharVector(sstream, outputCharData);
+
+    EXPECT_EQ (writeByteLen, readByteLen);
+    EXPECT_EQ (writeByteLen, sstream.str().length());
+    EXPECT_EQ (inputCharData, outputCharData);
+
+    writeByteLen = ransCoder.encodeIntVectorToStream(inputIntData, sstream);
+    readByteLen = ransCoder.decodeStreamToIntVector(sstream, outputIntData);
+
+    EXPECT_EQ (writeByteLen, readByteLen);
+    EXPECT_EQ (inputIntData, outputIntData);
+  }
+}
+
 
 /* ---[ */
 int
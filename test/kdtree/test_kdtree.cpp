@@ -51,6 +51,7 @@
 
 #include <algorithm>
 #include <iostream>  // For debug
+#include <limits>
 #include <map>
 
 using namespace pcl;
@@ -207,6 +208,112 @@ TEST (PCL, KdTreeFLANN_nearestKSearch)
   }
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, KdTreeFLANN_bufferSearch)
+{
+  // Use every other point, so that results have to be mapped back to the input cloud
+  KdTreeFLANN<MyPoint>::IndicesPtr indices (new pcl::Indices);
+  for (index_t i = 0; i < static_cast<index_t> (cloud.size ()); i += 2)
+    indices->push_back (i);
+
+  KdTreeFLANN<MyPoint> kdtree;
+  kdtree.setInputCloud (cloud.makeShared (), indices);
+
+  const unsigned int no_of_neighbors = 10;
+  const double radius = 0.25;
+  KdTreeFLANN<MyPoint>::QueryContext context;
+  pcl::Indices k_indices, buffer_indices (no_of_neighbors);
+  std::vector<float> k_distances, buffer_distances (no_of_neighbors);
+  for (const auto &point : cloud.points)
+  {
+    kdtree.nearestKSearch (point, no_of_neighbors, k_indices, k_distances);
+    const int nr_found = kdtree.nearestKSearch (point, no_of_neighbors, buffer_indices.data (), buffer_distances.data (), context);
+    ASSERT_EQ (static_cast<int> (k_indices.size ()), nr_found);
+    for (int i = 0; i < nr_found; ++i)
+    {
+      EXPECT_EQ (k_indices[i], buffer_indices[i]);
+      EXPECT_EQ (k_distances[i], buffer_distances[i]);
+    }
+
+    // A buffer of no_of_neighbors elements truncates the radius search to the closest neighbors
+    kdtree.radiusSearch (point, radius, k_indices, k_distances, no_of_neighbors);
+    const int nr_in_radius = kdtree.radiusSearch (point, radius, buffer_indices.data (), buffer_distances.data (), no_of_neighbors, context);
+    ASSERT_EQ (static_cast<int> (k_indices.size ()), nr_in_radius);
+    EXPECT_LE (nr_in_radius, static_cast<int> (no_of_neighbors));
+    for (int i = 0; i < nr_in_radius; ++i)
+    {
+      EXPECT_EQ (k_indices[i], buffer_indices[i]);
+      EXPECT_EQ (k_distances[i], buffer_distances[i]);
+    }
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, KdTreeFLANN_randomizedTrees)
+{
+  // Invalid points have to be skipped and mapped in the parallel conversion
+  PointCloud<MyPoint>::Ptr input (new PointCloud<MyPoint> (cloud_big));
+  for (std::size_t i = 0; i < input->size (); i += 13)
+    (*input)[i].x = std::numeric_limits<float>::quiet_NaN ();
+
+  KdTreeFLANN<MyPoint> single;
+  single.setNumberOfThreads (4);
+  single.setInputCloud (input);
+
+  // Without a bound on the checks the forest searches exactly
+  KdTreeFLANN<MyPoint> forest;
+  forest.setNumberOfTrees (4);
+  forest.setNumberOfThreads (4);
+  forest.setInputCloud (input);
+  EXPECT_EQ (forest.getNumberOfTrees (), 4);
+  EXPECT_EQ (forest.getMaxChecks (), -1);
+
+  const unsigned int no_of_neighbors = 8;
+  pcl::Indices k_indices, forest_indices;
+  std::vector<float> k_distances, forest_distances;
+  for (std::size_t i = 1; i < input->size (); i += 97)
+  {
+    if (!isFinite ((*input)[i]))
+      continue;
+    single.nearestKSearch ((*input)[i], no_of_neighbors, k_indices, k_distances);
+    forest.nearestKSearch ((*input)[i], no_of_neighbors, forest_indices, forest_distances);
+    EXPECT_EQ (k_distances, forest_distances);
+    for (const auto &index : forest_indices)
+      EXPECT_TRUE (isFinite ((*input)[index]));
+  }
+
+  // A check budget makes the search approximate, but it still returns valid neighbors
+  forest.setMaxChecks (64);
+  for (std::size_t i = 1; i < input->size (); i += 97)
+  {
+    if (!isFinite ((*input)[i]))
+      continue;
+    single.nearestKSearch ((*input)[i], no_of_neighbors, k_indices, k_distances);
+    ASSERT_EQ (forest.nearestKSearch ((*input)[i], no_of_neighbors, forest_indices, forest_distances), static_cast<int> (no_of_neighbors));
+    EXPECT_TRUE (std::is_sorted (forest_distances.begin (), forest_distances.end ()));
+    EXPECT_EQ (forest_distances[0], 0.0f);
+    EXPECT_GE (forest_distances.back (), k_distances.back ());
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, KdTreeFLANN_getMemoryUsage)
+{
+  KdTreeFLANN<MyPoint> kdtree;
+  EXPECT_EQ (kdtree.getMemoryUsage (), 0);
+
+  // The points of a dense cloud are read in place, a subset is copied
+  kdtree.setInputCloud (cloud_big.makeShared ());
+  const std::size_t in_place = kdtree.getMemoryUsage ();
+  EXPECT_GT (in_place, 0);
+
+  pcl::IndicesPtr indices (new pcl::Indices);
+  for (std::size_t i = 0; i < cloud_big.size (); i += 2)
+    indices->push_back (static_cast<int> (i));
+  kdtree.setInputCloud (cloud_big.makeShared (), indices);
+  EXPECT_GE (kdtree.getMemoryUsage (), indices->size () * (3 * sizeof (float) + sizeof (int)));
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 class MyPointRepresentationXY : public PointRepresentation<MyPoint>
 {
@@ -99,6 +99,52 @@ TEST (PCL, ISSKeypoint3D_WBE)
   tree.reset (new search::KdTree<PointXYZ> ());
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, ISSKeypoint3D_WBE_ReuseNeighborhoods)
+{
+  PointCloud<PointXYZ> keypoints;
+
+  //
+  // Compute the ISS 3D keypoints - Without Boundary Estimation, one neighborhood search per point
+  //
+  ISSKeypoint3D<PointXYZ, PointXYZ> iss_detector;
+  iss_detector.setSearchMethod (search::KdTree<PointXYZ>::Ptr (new search::KdTree<PointXYZ> ()));
+  iss_detector.setSalientRadius (6 * cloud_resolution);
+  iss_detector.setNonMaxRadius (4 * cloud_resolution);
+
+  iss_detector.setThreshold21 (0.975);
+  iss_detector.setThreshold32 (0.975);
+  iss_detector.setMinNeighbors (5);
+  iss_detector.setNumberOfThreads (2);
+  iss_detector.setReuseNeighborhoods (true);
+  iss_detector.setInputCloud (cloud);
+  iss_detector.compute (keypoints);
+
+  //
+  // Compare to the output validated for the default mode
+  //
+  const std::size_t correct_nr_keypoints = 6;
+  const float correct_keypoints[correct_nr_keypoints][3] =
+    {
+      // { x,  y,  z}
+      {-0.071112f,  0.137670f,  0.047518f},
+      {-0.041733f,  0.127960f,  0.016650f},
+      {-0.011943f,  0.086771f,  0.057009f},
+      { 0.031733f,  0.099372f,  0.038505f},
+      {-0.062116f,  0.045145f,  0.037802f},
+      {-0.048250f,  0.167480f, -0.000152f}
+    };
+
+  ASSERT_EQ (keypoints.size (), correct_nr_keypoints);
+
+  for (std::size_t i = 0; i < correct_nr_keypoints; ++i)
+  {
+    EXPECT_NEAR (keypoints[i].x, correct_keypoints[i][0], 1e-6);
+    EXPECT_NEAR (keypoints[i].y, correct_keypoints[i][1], 1e-6);
+    EXPECT_NEAR (keypoints[i].z, correct_keypoints[i][2], 1e-6);
+  }
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 TEST (PCL, ISSKeypoint3D_BE)
 {
@@ -121,6 +121,33 @@ TEST (PCL, SIFTKeypoint)
 
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, SIFTKeypoint_threads)
+{
+  // The keypoints must not depend on the number of threads
+  PointCloud<KeypointT> keypoints_serial, keypoints_parallel;
+
+  SIFTKeypoint<PointXYZI, KeypointT> sift_detector;
+  sift_detector.setScales (0.02f, 5, 3);
+  sift_detector.setMinimumContrast (0.03f);
+  sift_detector.setInputCloud (cloud_xyzi);
+
+  sift_detector.setNumberOfThreads (1);
+  sift_detector.compute (keypoints_serial);
+  sift_detector.setNumberOfThreads (4);
+  sift_detector.compute (keypoints_parallel);
+
+  EXPECT_EQ (keypoints_serial.size (), static_cast<std::size_t> (169));
+  ASSERT_EQ (keypoints_parallel.size (), keypoints_serial.size ());
+  for (std::size_t i = 0; i < keypoints_serial.size (); ++i)
+  {
+    EXPECT_EQ (keypoints_parallel[i].x, keypoints_serial[i].x);
+    EXPECT_EQ (keypoints_parallel[i].y, keypoints_serial[i].y);
+    EXPECT_EQ (keypoints_parallel[i].z, keypoints_serial[i].z);
+    EXPECT_EQ (keypoints_parallel[i].scale, keypoints_serial[i].scale);
+  }
+}
+
 TEST (PCL, SIFTKeypoint_radiusSearch)
 {
   const int nr_scales_per_octave = 3;
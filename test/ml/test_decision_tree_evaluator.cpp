@@ -0,0 +1,225 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2019-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <pcl/test/gtest.h>
+#include <pcl/common/execution_context.h>
+#include <pcl/ml/branch_estimator.h>
+#include <pcl/ml/dt/decision_forest_evaluator.h>
+#include <pcl/ml/dt/decision_tree_evaluator.h>
+#include <pcl/ml/dt/flat_decision_tree.h>
+#include <pcl/ml/multi_channel_2d_comparison_feature_handler.h>
+#include <pcl/ml/regression_variance_stats_estimator.h>
+
+#include <limits>
+#include <random>
+
+using FeatureType = pcl::MultiChannel2DComparisonFeature<pcl::PointXY32i>;
+using DataSet = pcl::MultiChannel2DDataSet<float, 2>;
+using ExampleIndex = pcl::MultipleData2DExampleIndex;
+using NodeType = pcl::RegressionVarianceNode<FeatureType, float>;
+using FeatureHandler = pcl::MultiChannel2DComparisonFeatureHandler<float, 2>;
+using StatsEstimator = pcl::RegressionVarianceStatsEstimator<float, NodeType, DataSet, ExampleIndex>;
+using TreeEvaluator = pcl::DecisionTreeEvaluator<FeatureType, DataSet, float, ExampleIndex, NodeType>;
+using ForestEvaluator = pcl::DecisionForestEvaluator<FeatureType, DataSet, float, ExampleIndex, NodeType>;
+
+constexpr int width = 40;
+constexpr int height = 30;
+constexpr int window = 5;
+
+std::mt19937 rng (42);
+
+/** Random binary tree of the given depth, with features inside a window of +-window. */
+NodeType
+createRandomNode (int depth)
+{
+  std::uniform_int_distribution<int> offset (-window, window);
+  std::uniform_real_distribution<float> value (-1.0f, 1.0f);
+
+  NodeType node;
+  node.feature.p1.x = offset (rng);
+  node.feature.p1.y = offset (rng);
+  node.feature.p2.x = offset (rng);
+  node.feature.p2.y = offset (rng);
+  node.feature.channel = static_cast<unsigned char> (rng () % 2);
+  node.threshold = value (rng) * 0.5f;
+  node.value = value (rng);
+  // Leaves at varying depths
+  if (depth > 0 && (depth > 2 || rng () % 4 != 0))
+  {
+    node.sub_nodes.push_back (createRandomNode (depth - 1));
+    node.sub_nodes.push_back (createRandomNode (depth - 1));
+  }
+  return (node);
+}
+
+class DecisionTreeEvaluatorTest : public testing::Test
+{
+  protected:
+    void
+    SetUp () override
+    {
+      std::uniform_real_distribution<float> value (-1.0f, 1.0f);
+      data_set_.addData (width, height);
+      data_set_.addData (width, height);
+      for (std::size_t id = 0; id < 2; ++id)
+        for (std::size_t row = 0; row < height; ++row)
+          for (std::size_t col = 0; col < width; ++col)
+            for (std::size_t channel = 0; channel < 2; ++channel)
+              data_set_ (id, col, row)[channel] = (rng () % 10 == 0 ? std::numeric_limits<float>::quiet_NaN () : value (rng));
+
+      // All pixels whose feature window lies inside the image, row by row
+      for (int id = 0; id < 2; ++id)
+        for (int row = window; row < height - window; ++row)
+          for (int col = window; col < width - window; ++col)
+          {
+            ExampleIndex example;
+            example.data_set_id = id;
+            example.x = col;
+            example.y = row;
+            examples_.push_back (example);
+          }
+
+      for (int tree_index = 0; tree_index < 3; ++tree_index)
+      {
+        pcl::DecisionTree<NodeType> tree;
+        tree.setRoot (createRandomNode (8));
+        forest_.push_back (tree);
+      }
+    }
+
+    void
+    TearDown () override
+    {
+      data_set_.clear ();
+    }
+
+    DataSet data_set_;
+    std::vector<ExampleIndex> examples_;
+    pcl::DecisionForest<NodeType> forest_;
+};
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST_F (DecisionTreeEvaluatorTest, FeatureBatch)
+{
+  FeatureHandler feature_handler (2 * window, 2 * window);
+
+  // Skip some examples, so that the batch has runs of different lengths
+  std::vector<ExampleIndex> examples;
+  for (std::size_t i = 0; i < examples_.size (); ++i)
+    if (i % 7 != 3)
+      examples.push_back (examples_[i]);
+
+  for (const auto& tree : forest_)
+  {
+    const FeatureType& feature = tree.getRoot ().feature;
+
+    std::vector<float> results;
+    std::vector<unsigned char> flags;
+    feature_handler.evaluateFeature (feature, data_set_, examples, results, flags);
+    ASSERT_EQ (examples.size (), results.size ());
+    ASSERT_EQ (examples.size (), flags.size ());
+
+    for (std::size_t i = 0; i < examples.size (); ++i)
+    {
+      float result;
+      unsigned char flag;
+      feature_handler.evaluateFeature (feature, data_set_, examples[i], result, flag);
+      EXPECT_EQ (flag, flags[i]);
+      if (flag == 0)
+      {
+        EXPECT_EQ (result, results[i]);
+      }
+    }
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST_F (DecisionTreeEvaluatorTest, FlatTree)
+{
+  FeatureHandler feature_handler (2 * window, 2 * window);
+  pcl::BinaryTreeThresholdBasedBranchEstimator branch_estimator;
+  StatsEstimator stats_estimator (&branch_estimator);
+
+  TreeEvaluator evaluator;
+  for (auto& tree : forest_)
+  {
+    std::vector<float> expected;
+    evaluator.evaluate (tree, feature_handler, stats_estimator, data_set_, examples_, expected);
+
+    pcl::FlatDecisionTree<NodeType> flat_tree (tree);
+    // The children of the root follow it
+    EXPECT_EQ (2, flat_tree.getNodes ().front ().num_of_children);
+    EXPECT_EQ (1, flat_tree.getNodes ().front ().first_child);
+
+    // 0 threads takes what the budget allows
+    const unsigned int budget = pcl::ExecutionContext::getThreadBudget ();
+    pcl::ExecutionContext::setThreadBudget (4);
+    for (unsigned int threads : {1u, 4u, 0u})
+    {
+      evaluator.setNumberOfThreads (threads);
+      std::vector<float> labels;
+      evaluator.evaluate (flat_tree, feature_handler, stats_estimator, data_set_, examples_, labels);
+      EXPECT_EQ (expected, labels);
+    }
+    pcl::ExecutionContext::setThreadBudget (budget);
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST_F (DecisionTreeEvaluatorTest, FlatForest)
+{
+  FeatureHandler feature_handler (2 * window, 2 * window);
+  pcl::BinaryTreeThresholdBasedBranchEstimator branch_estimator;
+  StatsEstimator stats_estimator (&branch_estimator);
+
+  ForestEvaluator evaluator;
+  std::vector<float> expected;
+  evaluator.evaluate (forest_, feature_handler, stats_estimator, data_set_, examples_, expected);
+
+  std::vector<pcl::FlatDecisionTree<NodeType>> flat_forest (forest_.begin (), forest_.end ());
+  std::vector<float> labels;
+  evaluator.evaluate (flat_forest, feature_handler, stats_estimator, data_set_, examples_, labels);
+  EXPECT_EQ (expected, labels);
+}
+
+/* ---[ */
+int
+main (int argc, char** argv)
+{
+  testing::InitGoogleTest (&argc, argv);
+  return (RUN_ALL_TESTS ());
+}
+/* ]--- */
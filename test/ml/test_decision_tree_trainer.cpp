@@ -0,0 +1,209 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2019-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <pcl/test/gtest.h>
+#include <pcl/common/execution_context.h>
+#include <pcl/ml/branch_estimator.h>
+#include <pcl/ml/dt/decision_forest_evaluator.h>
+#include <pcl/ml/dt/decision_forest_trainer.h>
+#include <pcl/ml/multi_channel_2d_comparison_feature_handler.h>
+#include <pcl/ml/regression_variance_stats_estimator.h>
+
+#include <cmath>
+#include <cstdlib>
+#include <limits>
+#include <random>
+
+using FeatureType = pcl::MultiChannel2DComparisonFeature<pcl::PointXY32i>;
+using DataSet = pcl::MultiChannel2DDataSet<float, 2>;
+using ExampleIndex = pcl::MultipleData2DExampleIndex;
+using NodeType = pcl::RegressionVarianceNode<FeatureType, float>;
+using FeatureHandler = pcl::MultiChannel2DComparisonFeatureHandler<float, 2>;
+using StatsEstimator = pcl::RegressionVarianceStatsEstimator<float, NodeType, DataSet, ExampleIndex>;
+using ForestTrainer = pcl::DecisionForestTrainer<FeatureType, DataSet, float, ExampleIndex, NodeType>;
+using ForestEvaluator = pcl::DecisionForestEvaluator<FeatureType, DataSet, float, ExampleIndex, NodeType>;
+
+constexpr int width = 40;
+constexpr int height = 30;
+constexpr int window = 5;
+
+std::mt19937 rng (42);
+
+class DecisionTreeTrainerTest : public testing::Test
+{
+  protected:
+    void
+    SetUp () override
+    {
+      std::uniform_real_distribution<float> value (-1.0f, 1.0f);
+      data_set_.addData (width, height);
+      data_set_.addData (width, height);
+      for (std::size_t id = 0; id < 2; ++id)
+        for (std::size_t row = 0; row < height; ++row)
+          for (std::size_t col = 0; col < width; ++col)
+            for (std::size_t channel = 0; channel < 2; ++channel)
+              data_set_ (id, col, row)[channel] = (rng () % 10 == 0 ? std::numeric_limits<float>::quiet_NaN () : value (rng));
+
+      // Regress the first channel, which the features can pick up
+      for (int id = 0; id < 2; ++id)
+        for (int row = window; row < height - window; ++row)
+          for (int col = window; col < width - window; ++col)
+          {
+            ExampleIndex example;
+            example.data_set_id = id;
+            example.x = col;
+            example.y = row;
+            examples_.push_back (example);
+
+            const float label = data_set_ (id, col, row)[0];
+            labels_.push_back (std::isfinite (label) ? label : 0.0f);
+          }
+    }
+
+    void
+    TearDown () override
+    {
+      data_set_.clear ();
+    }
+
+    DataSet data_set_;
+    std::vector<ExampleIndex> examples_;
+    std::vector<float> labels_;
+};
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST_F (DecisionTreeTrainerTest, HistogramInformationGains)
+{
+  FeatureHandler feature_handler (2 * window, 2 * window);
+  pcl::BinaryTreeThresholdBasedBranchEstimator binary_estimator;
+  pcl::TernaryTreeMissingDataBranchEstimator ternary_estimator;
+
+  std::srand (0);
+  std::vector<FeatureType> features;
+  feature_handler.createRandomFeatures (20, features);
+
+  for (pcl::BranchEstimator* branch_estimator : {static_cast<pcl::BranchEstimator*> (&binary_estimator),
+                                                 static_cast<pcl::BranchEstimator*> (&ternary_estimator)})
+  {
+    StatsEstimator stats_estimator (branch_estimator);
+    for (const auto& feature : features)
+    {
+      std::vector<float> results;
+      std::vector<unsigned char> flags;
+      feature_handler.evaluateFeature (feature, data_set_, examples_, results, flags);
+
+      // Unsorted, with duplicates and one threshold equal to a result
+      std::vector<float> thresholds = {0.3f, -0.5f, 0.0f, 0.3f, -2.0f, 1.5f, results[17]};
+
+      std::vector<float> gains;
+      stats_estimator.computeInformationGains (data_set_, examples_, labels_, results, flags, thresholds, gains);
+      ASSERT_EQ (thresholds.size (), gains.size ());
+
+      for (std::size_t i = 0; i < thresholds.size (); ++i)
+        EXPECT_NEAR (stats_estimator.computeInformationGain (data_set_, examples_, labels_, results, flags, thresholds[i]),
+                     gains[i], 1e-5f);
+    }
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST_F (DecisionTreeTrainerTest, ParallelTraining)
+{
+  FeatureHandler feature_handler (2 * window, 2 * window);
+  pcl::BinaryTreeThresholdBasedBranchEstimator branch_estimator;
+  StatsEstimator stats_estimator (&branch_estimator);
+
+  // 0 threads takes what the budget allows
+  const unsigned int budget = pcl::ExecutionContext::getThreadBudget ();
+  pcl::ExecutionContext::setThreadBudget (4);
+  for (bool quantile_thresholds : {false, true})
+  {
+    std::vector<float> expected;
+    for (unsigned int threads : {1u, 4u, 0u})
+    {
+      ForestTrainer trainer;
+      trainer.setFeatureHandler (feature_handler);
+      trainer.setStatsEstimator (stats_estimator);
+      trainer.setMaxTreeDepth (6);
+      trainer.setNumOfFeatures (50);
+      trainer.setNumOfThresholds (10);
+      trainer.setMinExamplesForSplit (10);
+      trainer.setNumberOfTreesToTrain (3);
+      trainer.setQuantileThresholds (quantile_thresholds);
+      trainer.setTrainingDataSet (data_set_);
+      trainer.setExamples (examples_);
+      trainer.setLabelData (labels_);
+      trainer.setNumberOfThreads (threads);
+
+      std::srand (0);
+      pcl::DecisionForest<NodeType> forest;
+      trainer.train (forest);
+      ASSERT_EQ (3, forest.size ());
+
+      ForestEvaluator evaluator;
+      std::vector<float> labels;
+      evaluator.evaluate (forest, feature_handler, stats_estimator, data_set_, examples_, labels);
+
+      if (expected.empty ())
+      {
+        // The trees have to fit the labels better than their mean
+        double error = 0.0, variance = 0.0, mean = 0.0;
+        for (const float label : labels_)
+          mean += label;
+        mean /= static_cast<double> (labels_.size ());
+        for (std::size_t i = 0; i < labels_.size (); ++i)
+        {
+          error += (labels[i] - labels_[i]) * (labels[i] - labels_[i]);
+          variance += (labels_[i] - mean) * (labels_[i] - mean);
+        }
+        EXPECT_LT (error, 0.5 * variance);
+        expected = labels;
+      }
+      else
+        EXPECT_EQ (expected, labels);
+    }
+  }
+  pcl::ExecutionContext::setThreadBudget (budget);
+}
+
+/* ---[ */
+int
+main (int argc, char** argv)
+{
+  testing::InitGoogleTest (&argc, argv);
+  return (RUN_ALL_TESTS ());
+}
+/* ]--- */
@@ -10,6 +10,8 @@
 #include <pcl/common/random.h>
 #include <pcl/ml/kmeans.h>
 
+#include <limits>
+
 using namespace pcl;
 using namespace pcl::common;
 
@@ -97,6 +99,104 @@ TEST (ComputeCentroids, Case2)
   EXPECT_EQ (sdc.answer_centroids_, k_means.get_centroids ());
 }
 
+// Nearest centroid of a point, by brute force
+std::size_t
+nearestCentroid (const Point& point, const Kmeans::Centroids& centroids)
+{
+  std::size_t nearest = 0;
+  float min_distance = std::numeric_limits<float>::max ();
+  for (std::size_t cid = 0; cid < centroids.size (); ++cid)
+  {
+    float distance = 0.0f;
+    for (std::size_t dim = 0; dim < point.size (); ++dim)
+      distance += (point[dim] - centroids[cid][dim]) * (point[dim] - centroids[cid][dim]);
+    if (distance < min_distance)
+    {
+      min_distance = distance;
+      nearest = cid;
+    }
+  }
+  return (nearest);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (KMeans, Convergence)
+{
+  // Points around a few well separated centers
+  const int num_blobs = 6, points_per_blob = 500, dim = 8;
+  UniformGenerator<float> blob_engine (-1.0, 1.0, 7);
+  std::vector<Point> data;
+  std::vector<float> flat_data;
+  for (int blob = 0; blob < num_blobs; ++blob)
+    for (int i = 0; i < points_per_blob; ++i)
+    {
+      Point point (dim);
+      for (int dim_i = 0; dim_i < dim; ++dim_i)
+        point[dim_i] = 100.0f * static_cast<float> ((blob >> (dim_i % 3)) & 1) + 10.0f * static_cast<float> (blob) + blob_engine.run ();
+      data.push_back (point);
+      flat_data.insert (flat_data.end (), point.begin (), point.end ());
+    }
+
+  Kmeans k_means (static_cast<unsigned int> (data.size ()), dim);
+  k_means.setClusterSize (num_blobs);
+  k_means.setInputData (data);
+  k_means.kMeans ();
+  const Kmeans::Centroids centroids = k_means.get_centroids ();
+  ASSERT_EQ (num_blobs, centroids.size ());
+
+  // k-means++ finds every blob, and each centroid is the mean of the points closest to it
+  std::vector<Point> means (num_blobs, Point (dim, 0.0f));
+  std::vector<int> counts (num_blobs, 0);
+  for (std::size_t pid = 0; pid < data.size (); ++pid)
+  {
+    const std::size_t cid = nearestCentroid (data[pid], centroids);
+    EXPECT_EQ (nearestCentroid (data[(pid / points_per_blob) * points_per_blob], centroids), cid);
+    for (int dim_i = 0; dim_i < dim; ++dim_i)
+      means[cid][dim_i] += data[pid][dim_i];
+    ++counts[cid];
+  }
+  for (int cid = 0; cid < num_blobs; ++cid)
+  {
+    EXPECT_EQ (points_per_blob, counts[cid]);
+    for (int dim_i = 0; dim_i < dim; ++dim_i)
+      EXPECT_NEAR (means[cid][dim_i] / static_cast<float> (counts[cid]), centroids[cid][dim_i], 1e-3);
+  }
+
+  // The flat input and the number of threads do not change the result
+  Kmeans flat_k_means (static_cast<unsigned int> (data.size ()), dim);
+  flat_k_means.setClusterSize (num_blobs);
+  flat_k_means.setInputData (flat_data);
+  flat_k_means.setNumberOfThreads (3);
+  flat_k_means.kMeans ();
+  EXPECT_EQ (centroids, flat_k_means.get_centroids ());
+
+  // Starting from the partition of the points in turn converges as well, though
+  // clusters can run empty there
+  Kmeans partition_k_means (static_cast<unsigned int> (data.size ()), dim);
+  partition_k_means.setClusterSize (num_blobs);
+  partition_k_means.setInputData (flat_data);
+  partition_k_means.setUseKMeansPlusPlus (false);
+  partition_k_means.kMeans ();
+  const Kmeans::Centroids partition_centroids = partition_k_means.get_centroids ();
+  ASSERT_EQ (num_blobs, partition_centroids.size ());
+  std::fill (means.begin (), means.end (), Point (dim, 0.0f));
+  std::fill (counts.begin (), counts.end (), 0);
+  for (const Point& point : data)
+  {
+    const std::size_t cid = nearestCentroid (point, partition_centroids);
+    for (int dim_i = 0; dim_i < dim; ++dim_i)
+      means[cid][dim_i] += point[dim_i];
+    ++counts[cid];
+  }
+  for (int cid = 0; cid < num_blobs; ++cid)
+  {
+    if (counts[cid] == 0)
+      continue;
+    for (int dim_i = 0; dim_i < dim; ++dim_i)
+      EXPECT_NEAR (means[cid][dim_i] / static_cast<float> (counts[cid]), partition_centroids[cid][dim_i], 1e-3);
+  }
+}
+
 /* ---[ */
 int
 main (int argc, char** argv)
@@ -38,8 +38,15 @@
  */
 #include <pcl/test/gtest.h>
 
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <set>
+#include <tuple>
 #include <vector>
 
+#include <pcl/common/execution_context.h>
 #include <pcl/common/time.h>
 #include <pcl/point_cloud.h>
 #include <pcl/point_types.h>
@@ -1022,6 +1029,90 @@ TEST (PCL, Octree_Pointcloud_Change_Detector_Test)
   }
 }
 
+TEST (PCL, Octree_Pointcloud_Change_Detector_Streaming_Test)
+{
+  const double resolution = 0.1;
+  OctreePointCloudChangeDetector<PointXYZ> octree_stream (resolution);
+  octree_stream.defineBoundingBox (0.0, 0.0, 0.0, 10.0, 10.0, 10.0);
+
+  // nothing happens without a bounding box
+  OctreePointCloudChangeDetector<PointXYZ> octree_undefined (resolution);
+  PointCloud<PointXYZ>::Ptr empty_cloud (new PointCloud<PointXYZ> ());
+  octree_undefined.setInputCloud (empty_cloud);
+  EXPECT_FALSE (octree_undefined.addFrameFromInputCloud ());
+
+  srand (static_cast<unsigned int> (time (nullptr)));
+
+  PointCloud<PointXYZ>::Ptr previous_cloud;
+  std::set<std::tuple<uindex_t, uindex_t, uindex_t>> previous_voxels;
+  for (int frame = 0; frame < 5; ++frame)
+  {
+    // a moving block of points with some points outside of the bounding box
+    PointCloud<PointXYZ>::Ptr cloud (new PointCloud<PointXYZ> ());
+    for (std::size_t i = 0; i < 2000; i++)
+    {
+      cloud->push_back (PointXYZ (static_cast<float> (frame * 0.5 + 3.0 * rand () / RAND_MAX),
+                                  static_cast<float> (3.0 * rand () / RAND_MAX),
+                                  static_cast<float> (3.0 * rand () / RAND_MAX)));
+    }
+    cloud->push_back (PointXYZ (-100.0f, 1.0f, 1.0f));
+    cloud->push_back (PointXYZ (std::numeric_limits<float>::quiet_NaN (), 1.0f, 1.0f));
+
+    // alternate between a fixed number of threads and the budget of pcl::ExecutionContext
+    octree_stream.setNumberOfThreads (frame % 2 == 0 ? 4 : 0);
+    octree_stream.setInputCloud (cloud);
+    ASSERT_TRUE (octree_stream.addFrameFromInputCloud ());
+
+    // reference: the classic buffer switch and point insertion, without the points
+    // outside of the bounding box
+    OctreePointCloudChangeDetector<PointXYZ> octree_reference (resolution);
+    octree_reference.defineBoundingBox (0.0, 0.0, 0.0, 10.0, 10.0, 10.0);
+    PointCloud<PointXYZ>::Ptr reference_cloud (new PointCloud<PointXYZ> ());
+    if (previous_cloud)
+    {
+      octree_reference.setInputCloud (previous_cloud);
+      octree_reference.addPointsFromInputCloud ();
+      octree_reference.switchBuffers ();
+    }
+    for (std::size_t i = 0; i < cloud->size () - 2; i++)
+      reference_cloud->push_back ((*cloud)[i]);
+    octree_reference.setInputCloud (reference_cloud);
+    octree_reference.addPointsFromInputCloud ();
+
+    EXPECT_EQ (octree_reference.getLeafCount (), octree_stream.getLeafCount ());
+    EXPECT_EQ (octree_reference.getBranchCount (), octree_stream.getBranchCount ());
+
+    Indices stream_indices, reference_indices;
+    octree_stream.getPointIndicesFromNewVoxels (stream_indices, 2);
+    octree_reference.getPointIndicesFromNewVoxels (reference_indices, 2);
+    EXPECT_EQ (reference_indices, stream_indices);
+
+    // vanished and new voxels are consistent with the voxels of both frames
+    std::set<std::tuple<uindex_t, uindex_t, uindex_t>> current_voxels;
+    for (auto it = octree_reference.leaf_depth_begin (); it != octree_reference.leaf_depth_end (); ++it)
+      current_voxels.emplace (it.getCurrentOctreeKey ().x,
+                              it.getCurrentOctreeKey ().y,
+                              it.getCurrentOctreeKey ().z);
+    std::size_t nr_new = 0, nr_vanished = 0;
+    for (const auto& voxel : current_voxels)
+      nr_new += (previous_voxels.count (voxel) == 0);
+    for (const auto& voxel : previous_voxels)
+      nr_vanished += (current_voxels.count (voxel) == 0);
+    EXPECT_EQ (nr_new, octree_stream.getNewVoxelKeys ().size ());
+    EXPECT_EQ (nr_vanished, octree_stream.getVanishedVoxelKeys ().size ());
+    for (const OctreeKey& key : octree_stream.getNewVoxelKeys ())
+      EXPECT_EQ (0u, previous_voxels.count (std::make_tuple (key.x, key.y, key.z)));
+    for (const OctreeKey& key : octree_stream.getVanishedVoxelKeys ())
+    {
+      EXPECT_EQ (0u, current_voxels.count (std::make_tuple (key.x, key.y, key.z)));
+      EXPECT_FALSE (octree_stream.existLeaf (key.x, key.y, key.z));
+    }
+
+    previous_cloud = reference_cloud;
+    previous_voxels.swap (current_voxels);
+  }
+}
+
 TEST (PCL, Octree_Pointcloud_Voxel_Centroid_Test)
 {
 
@@ -1543,6 +1634,74 @@ TEST (PCL, Octree_Pointcloud_Ray_Traversal)
   }
 }
 
+TEST (PCL, Octree_Pointcloud_Ray_Traversal_Batch)
+{
+  srand (static_cast<unsigned int> (time (nullptr)));
+
+  PointCloud<PointXYZ>::Ptr cloudIn (new PointCloud<PointXYZ> ());
+  for (std::size_t i = 0; i < 2000; i++)
+    cloudIn->push_back (PointXYZ (static_cast<float> (10.0 * rand () / RAND_MAX),
+                                  static_cast<float> (10.0 * rand () / RAND_MAX),
+                                  static_cast<float> (10.0 * rand () / RAND_MAX)));
+
+  OctreePointCloudSearch<PointXYZ> octree_search (0.5);
+  octree_search.setInputCloud (cloudIn);
+  octree_search.addPointsFromInputCloud ();
+  const unsigned int budget = pcl::ExecutionContext::getThreadBudget ();
+  pcl::ExecutionContext::setThreadBudget (4);
+
+  // rays from outside of the cloud through random points of it
+  OctreePointCloudSearch<PointXYZ>::AlignedVector3fVector origins, directions;
+  for (std::size_t i = 0; i < 500; i++)
+  {
+    const Eigen::Vector3f origin (static_cast<float> (-2.0 + 14.0 * rand () / RAND_MAX),
+                                  static_cast<float> (-2.0 + 14.0 * rand () / RAND_MAX),
+                                  -2.0f);
+    origins.push_back (origin);
+    directions.push_back ((*cloudIn)[rand () % cloudIn->size ()].getVector3fMap () - origin);
+  }
+  // a ray that misses the octree
+  origins.emplace_back (-5.0f, -5.0f, -5.0f);
+  directions.emplace_back (-1.0f, 0.0f, 0.0f);
+
+  for (const uindex_t max_voxel_count : {0u, 3u})
+  {
+    // 4 threads and as many as the budget grants
+    octree_search.setNumberOfThreads (max_voxel_count == 0 ? 4 : 0);
+    OctreePointCloudSearch<PointXYZ>::AlignedPointTVector centers;
+    Indices indices;
+    std::vector<std::size_t> center_offsets, index_offsets;
+    const std::size_t nr_centers = octree_search.getIntersectedVoxelCenters (origins, directions, centers, center_offsets, max_voxel_count);
+    const std::size_t nr_voxels = octree_search.getIntersectedVoxelIndices (origins, directions, indices, index_offsets, max_voxel_count);
+
+    ASSERT_EQ (origins.size () + 1, center_offsets.size ());
+    ASSERT_EQ (origins.size () + 1, index_offsets.size ());
+    EXPECT_EQ (centers.size (), center_offsets.back ());
+    EXPECT_EQ (indices.size (), index_offsets.back ());
+    EXPECT_EQ (nr_centers, centers.size ());
+
+    // every ray gives the same results as casting it alone
+    std::size_t total_voxels = 0;
+    for (std::size_t ray = 0; ray < origins.size (); ++ray)
+    {
+      OctreePointCloudSearch<PointXYZ>::AlignedPointTVector ray_centers;
+      Indices ray_indices;
+      octree_search.getIntersectedVoxelCenters (origins[ray], directions[ray], ray_centers, max_voxel_count);
+      total_voxels += octree_search.getIntersectedVoxelIndices (origins[ray], directions[ray], ray_indices, max_voxel_count);
+
+      ASSERT_EQ (ray_centers.size (), center_offsets[ray + 1] - center_offsets[ray]);
+      for (std::size_t i = 0; i < ray_centers.size (); ++i)
+        EXPECT_EQ (ray_centers[i].getVector3fMap (), centers[center_offsets[ray] + i].getVector3fMap ());
+      ASSERT_EQ (ray_indices.size (), index_offsets[ray + 1] - index_offsets[ray]);
+      for (std::size_t i = 0; i < ray_indices.size (); ++i)
+        EXPECT_EQ (ray_indices[i], indices[index_offsets[ray] + i]);
+    }
+    EXPECT_EQ (total_voxels, nr_voxels);
+    EXPECT_EQ (index_offsets[origins.size () - 1], index_offsets[origins.size ()]);
+  }
+  pcl::ExecutionContext::setThreadBudget (budget);
+}
+
 TEST (PCL, Octree_Pointcloud_Adjacency)
 {
   constexpr unsigned int test_runs = 100;
@@ -1614,6 +1773,78 @@ TEST (PCL, Octree_Pointcloud_Adjacency)
   }
 }
 
+TEST (PCL, Octree_Pointcloud_Adjacency_Parallel)
+{
+  PointCloud<PointXYZ>::Ptr cloudIn (new PointCloud<PointXYZ> ());
+  srand (static_cast<unsigned int> (time (nullptr)));
+  for (int i = 0; i < 5000; ++i)
+    cloudIn->push_back (PointXYZ (static_cast<float> (1.0 * rand () / RAND_MAX),
+                                  static_cast<float> (1.0 * rand () / RAND_MAX),
+                                  static_cast<float> (1.0 * rand () / RAND_MAX)));
+
+  const double resolution = 0.05;
+  OctreePointCloudAdjacency<PointXYZ> octree_serial (resolution);
+  octree_serial.setNumberOfThreads (1);
+  octree_serial.setInputCloud (cloudIn);
+  octree_serial.addPointsFromInputCloud ();
+
+  OctreePointCloudAdjacency<PointXYZ> octree_parallel (resolution);
+  octree_parallel.setNumberOfThreads (4);
+  octree_parallel.setInputCloud (cloudIn);
+  octree_parallel.addPointsFromInputCloud ();
+
+  // 0 threads takes what the budget grants
+  const unsigned int budget = pcl::ExecutionContext::getThreadBudget ();
+  pcl::ExecutionContext::setThreadBudget (4);
+  OctreePointCloudAdjacency<PointXYZ> octree_budget (resolution);
+  octree_budget.setNumberOfThreads (0);
+  octree_budget.setInputCloud (cloudIn);
+  octree_budget.addPointsFromInputCloud ();
+  pcl::ExecutionContext::setThreadBudget (budget);
+
+  ASSERT_EQ (octree_serial.size (), octree_parallel.size ());
+  ASSERT_EQ (octree_serial.size (), octree_budget.size ());
+
+  // Keys of all leaves, to count the touching voxels by brute force
+  std::vector<Eigen::Vector3i> leaf_keys;
+  for (auto it = octree_serial.leaf_depth_begin (); it != octree_serial.leaf_depth_end (); ++it)
+  {
+    const OctreeKey& key = it.getCurrentOctreeKey ();
+    leaf_keys.emplace_back (key.x, key.y, key.z);
+  }
+  ASSERT_EQ (leaf_keys.size (), octree_serial.size ());
+
+  std::size_t nr_neighbors = 0;
+  for (std::size_t i = 0; i < octree_serial.size (); ++i)
+  {
+    std::size_t expected_neighbors = 0;
+    for (const auto& key : leaf_keys)
+      if ((key - leaf_keys[i]).cwiseAbs ().maxCoeff () <= 1)
+        ++expected_neighbors;
+
+    // Both builds store the same neighbors in the same order
+    const auto* leaf_serial = octree_serial.at (i);
+    const auto* leaf_parallel = octree_parallel.at (i);
+    ASSERT_EQ (expected_neighbors, leaf_serial->size ());
+    ASSERT_EQ (expected_neighbors, leaf_parallel->size ());
+    ASSERT_EQ (expected_neighbors, octree_budget.at (i)->size ());
+    auto it_parallel = leaf_parallel->cbegin ();
+    for (auto it_serial = leaf_serial->cbegin (); it_serial != leaf_serial->cend (); ++it_serial, ++it_parallel)
+    {
+      const auto index_serial = std::find (octree_serial.begin (), octree_serial.end (), *it_serial) - octree_serial.begin ();
+      const auto index_parallel = std::find (octree_parallel.begin (), octree_parallel.end (), *it_parallel) - octree_parallel.begin ();
+      ASSERT_EQ (index_serial, index_parallel);
+    }
+    nr_neighbors += expected_neighbors;
+  }
+
+  // Every leaf is a neighbor of itself, which gives a self loop in the graph
+  OctreePointCloudAdjacency<PointXYZ>::VoxelAdjacencyList graph;
+  octree_parallel.computeVoxelAdjacencyGraph (graph);
+  EXPECT_EQ (octree_parallel.size (), boost::num_vertices (graph));
+  EXPECT_EQ ((nr_neighbors + octree_parallel.size ()) / 2, boost::num_edges (graph));
+}
+
 TEST (PCL, Octree_Pointcloud_Bounds)
 {
     const double SOME_RESOLUTION (10 + 1/3.0);
@@ -1645,6 +1876,324 @@ TEST (PCL, Octree_Pointcloud_Bounds)
     ASSERT_DOUBLE_EQ (min_x2, min_x);
     ASSERT_DOUBLE_EQ (max_x2, max_x);
 }
+
+TEST (PCL, Octree_Pointcloud_Bulk_Build)
+{
+  constexpr unsigned int test_runs = 5;
+  constexpr std::size_t nr_points = 20000;
+
+  srand (static_cast<unsigned int> (time (nullptr)));
+
+  for (unsigned int run = 0; run < test_runs; ++run)
+  {
+    PointCloud<PointXYZ>::Ptr cloudIn (new PointCloud<PointXYZ> (nr_points, 1));
+    for (auto& point : *cloudIn)
+    {
+      if (rand () % 50 == 0)
+        point.x = point.y = point.z = std::numeric_limits<float>::quiet_NaN ();
+      else
+        point = PointXYZ (static_cast<float> (20.0 * rand () / RAND_MAX) - 10.0f,
+                          static_cast<float> (20.0 * rand () / RAND_MAX) - 10.0f,
+                          static_cast<float> (20.0 * rand () / RAND_MAX) - 10.0f);
+    }
+
+    OctreePointCloudSearch<PointXYZ>::IndicesPtr indices (new Indices);
+    for (std::size_t i = 0; i < nr_points; i += 3)
+      indices->push_back (static_cast<index_t> (i));
+
+    const double resolution = 0.1 + 0.5 * rand () / RAND_MAX;
+
+    for (const bool use_indices : {false, true})
+    {
+      OctreePointCloudSearch<PointXYZ> octreeSeq (resolution);
+      OctreePointCloudSearch<PointXYZ> octreeBulk (resolution);
+      octreeBulk.setNumberOfThreads (4);
+
+      octreeSeq.setInputCloud (cloudIn, use_indices ? indices : OctreePointCloudSearch<PointXYZ>::IndicesPtr ());
+      octreeBulk.setInputCloud (cloudIn, use_indices ? indices : OctreePointCloudSearch<PointXYZ>::IndicesPtr ());
+      octreeSeq.addPointsFromInputCloud ();
+      octreeBulk.addPointsFromInputCloud ();
+
+      ASSERT_EQ (octreeSeq.getLeafCount (), octreeBulk.getLeafCount ());
+      ASSERT_EQ (octreeSeq.getBranchCount (), octreeBulk.getBranchCount ());
+      ASSERT_EQ (octreeSeq.getTreeDepth (), octreeBulk.getTreeDepth ());
+
+      double seq_bb[6], bulk_bb[6];
+      octreeSeq.getBoundingBox (seq_bb[0], seq_bb[1], seq_bb[2], seq_bb[3], seq_bb[4], seq_bb[5]);
+      octreeBulk.getBoundingBox (bulk_bb[0], bulk_bb[1], bulk_bb[2], bulk_bb[3], bulk_bb[4], bulk_bb[5]);
+      for (int i = 0; i < 6; ++i)
+        ASSERT_DOUBLE_EQ (seq_bb[i], bulk_bb[i]);
+
+      auto it_bulk = octreeBulk.leaf_depth_begin ();
+      for (auto it_seq = octreeSeq.leaf_depth_begin (), it_seq_end = octreeSeq.leaf_depth_end (); it_seq != it_seq_end; ++it_seq, ++it_bulk)
+      {
+        ASSERT_TRUE (it_bulk != octreeBulk.leaf_depth_end ());
+        ASSERT_EQ (it_seq.getCurrentOctreeDepth (), it_bulk.getCurrentOctreeDepth ());
+        ASSERT_TRUE (it_seq.getCurrentOctreeKey () == it_bulk.getCurrentOctreeKey ());
+        // points are stored in input order in both trees
+        Indices seq_indices, bulk_indices;
+        it_seq.getLeafContainer ().getPointIndices (seq_indices);
+        it_bulk.getLeafContainer ().getPointIndices (bulk_indices);
+        ASSERT_EQ (seq_indices, bulk_indices);
+      }
+      ASSERT_TRUE (it_bulk == octreeBulk.leaf_depth_end ());
+    }
+
+    OctreePointCloudVoxelCentroid<PointXYZ> centroidSeq (resolution);
+    OctreePointCloudVoxelCentroid<PointXYZ> centroidBulk (resolution);
+    centroidBulk.setNumberOfThreads (4);
+    centroidSeq.setInputCloud (cloudIn);
+    centroidBulk.setInputCloud (cloudIn);
+    centroidSeq.addPointsFromInputCloud ();
+    centroidBulk.addPointsFromInputCloud ();
+
+    pcl::PointCloud<PointXYZ>::VectorType seqCentroids, bulkCentroids;
+    centroidSeq.getVoxelCentroids (seqCentroids);
+    centroidBulk.getVoxelCentroids (bulkCentroids);
+    ASSERT_EQ (seqCentroids.size (), bulkCentroids.size ());
+    for (std::size_t i = 0; i < seqCentroids.size (); ++i)
+    {
+      EXPECT_FLOAT_EQ (seqCentroids[i].x, bulkCentroids[i].x);
+      EXPECT_FLOAT_EQ (seqCentroids[i].y, bulkCentroids[i].y);
+      EXPECT_FLOAT_EQ (seqCentroids[i].z, bulkCentroids[i].z);
+    }
+  }
+}
+
+TEST (PCL, Octree_Base_Node_Arena)
+{
+  using ArenaOctree = OctreeBase<int, OctreeContainerEmpty, OctreeNodeArena>;
+
+  OctreeBase<int> octreeHeap;
+  ArenaOctree octreeArena;
+  octreeHeap.setTreeDepth (8);
+  octreeArena.setTreeDepth (8);
+
+  srand (static_cast<unsigned int> (time (nullptr)));
+
+  std::vector<OctreeKey> keys (1000);
+  for (std::size_t i = 0; i < keys.size (); ++i)
+  {
+    keys[i] = OctreeKey (rand () % 256, rand () % 256, rand () % 256);
+    *octreeHeap.createLeaf (keys[i].x, keys[i].y, keys[i].z) = static_cast<int> (i);
+    *octreeArena.createLeaf (keys[i].x, keys[i].y, keys[i].z) = static_cast<int> (i);
+  }
+
+  // remove some leafs so that freed slots get recycled
+  for (std::size_t i = 0; i < keys.size (); i += 4)
+  {
+    octreeHeap.removeLeaf (keys[i].x, keys[i].y, keys[i].z);
+    octreeArena.removeLeaf (keys[i].x, keys[i].y, keys[i].z);
+  }
+  for (std::size_t i = 0; i < keys.size (); i += 8)
+  {
+    *octreeHeap.createLeaf (keys[i].x, keys[i].y, keys[i].z) = -static_cast<int> (i);
+    *octreeArena.createLeaf (keys[i].x, keys[i].y, keys[i].z) = -static_cast<int> (i);
+  }
+
+  ASSERT_EQ (octreeHeap.getLeafCount (), octreeArena.getLeafCount ());
+  ASSERT_EQ (octreeHeap.getBranchCount (), octreeArena.getBranchCount ());
+
+  std::vector<char> binaryHeap, binaryArena;
+  std::vector<int*> leafsHeap, leafsArena;
+  octreeHeap.serializeTree (binaryHeap, leafsHeap);
+  octreeArena.serializeTree (binaryArena, leafsArena);
+  ASSERT_EQ (binaryHeap, binaryArena);
+  ASSERT_EQ (leafsHeap.size (), leafsArena.size ());
+  for (std::size_t i = 0; i < leafsHeap.size (); ++i)
+    ASSERT_EQ (*leafsHeap[i], *leafsArena[i]);
+
+  // copies and compacted trees keep the structure and the leaf data
+  ArenaOctree octreeCopy (octreeArena);
+  octreeArena.compactNodes ();
+  for (ArenaOctree* octree : {&octreeArena, &octreeCopy})
+  {
+    ASSERT_EQ (octreeHeap.getLeafCount (), octree->getLeafCount ());
+    ASSERT_EQ (octreeHeap.getBranchCount (), octree->getBranchCount ());
+
+    std::vector<char> binary;
+    std::vector<int*> leafs;
+    octree->serializeTree (binary, leafs);
+    ASSERT_EQ (binaryHeap, binary);
+    ASSERT_EQ (leafsHeap.size (), leafs.size ());
+    for (std::size_t i = 0; i < leafsHeap.size (); ++i)
+      ASSERT_EQ (*leafsHeap[i], *leafs[i]);
+  }
+
+  // after compaction the nodes of the first levels are allocated in breadth-first order
+  std::vector<const OctreeNode*> nodes;
+  for (auto it = octreeArena.breadth_begin (), it_end = octreeArena.breadth_end (); it != it_end; ++it)
+    if (it.isBranchNode () && it.getCurrentOctreeDepth () < 3)
+      nodes.push_back (it.getCurrentOctreeNode ());
+  for (std::size_t i = 1; i < nodes.size (); ++i)
+    ASSERT_LT (nodes[i - 1], nodes[i]);
+
+  octreeArena.deleteTree ();
+  ASSERT_EQ (0u, octreeArena.getLeafCount ());
+  ASSERT_EQ (1u, octreeArena.getBranchCount ());
+}
+
+TEST (PCL, Octree2Buf_Base_Node_Arena)
+{
+  Octree2BufBase<int> octreeHeap;
+  Octree2BufBase<int, OctreeContainerEmpty, OctreeNodeArena> octreeArena;
+  octreeHeap.setTreeDepth (6);
+  octreeArena.setTreeDepth (6);
+
+  srand (static_cast<unsigned int> (time (nullptr)));
+
+  for (unsigned int frame = 0; frame < 5; ++frame)
+  {
+    for (unsigned int i = 0; i < 300; ++i)
+    {
+      const OctreeKey key (rand () % 64, rand () % 64, rand () % 64);
+      *octreeHeap.createLeaf (key.x, key.y, key.z) = static_cast<int> (i);
+      *octreeArena.createLeaf (key.x, key.y, key.z) = static_cast<int> (i);
+    }
+
+    std::vector<char> binaryHeap, binaryArena;
+    octreeHeap.serializeTree (binaryHeap, true);
+    octreeArena.serializeTree (binaryArena, true);
+    ASSERT_EQ (binaryHeap, binaryArena);
+    ASSERT_EQ (octreeHeap.getLeafCount (), octreeArena.getLeafCount ());
+
+    octreeHeap.switchBuffers ();
+    octreeArena.switchBuffers ();
+  }
+}
+
+TEST (PCL, Octree_Pointcloud_Search_Node_Arena)
+{
+  PointCloud<PointXYZ>::Ptr cloudIn (new PointCloud<PointXYZ> (5000, 1));
+
+  srand (static_cast<unsigned int> (time (nullptr)));
+  for (auto& point : *cloudIn)
+    point = PointXYZ (static_cast<float> (10.0 * rand () / RAND_MAX),
+                      static_cast<float> (10.0 * rand () / RAND_MAX),
+                      static_cast<float> (10.0 * rand () / RAND_MAX));
+
+  OctreePointCloudSearch<PointXYZ> octreeHeap (0.1);
+  OctreePointCloudSearch<PointXYZ,
+                         OctreeContainerPointIndices,
+                         OctreeContainerEmpty,
+                         OctreeNodeArena> octreeArena (0.1);
+  octreeHeap.setInputCloud (cloudIn);
+  octreeArena.setInputCloud (cloudIn);
+  octreeHeap.addPointsFromInputCloud ();
+  octreeArena.addPointsFromInputCloud ();
+  octreeArena.compactNodes ();
+
+  ASSERT_EQ (octreeHeap.getLeafCount (), octreeArena.getLeafCount ());
+
+  for (unsigned int test_id = 0; test_id < 20; ++test_id)
+  {
+    const PointXYZ searchPoint (static_cast<float> (10.0 * rand () / RAND_MAX),
+                                static_cast<float> (10.0 * rand () / RAND_MAX),
+                                static_cast<float> (10.0 * rand () / RAND_MAX));
+    const double radius = 2.0 * rand () / RAND_MAX;
+
+    Indices indicesHeap, indicesArena;
+    std::vector<float> distancesHeap, distancesArena;
+    octreeHeap.radiusSearch (searchPoint, radius, indicesHeap, distancesHeap);
+    octreeArena.radiusSearch (searchPoint, radius, indicesArena, distancesArena);
+    ASSERT_EQ (indicesHeap, indicesArena);
+
+    octreeHeap.nearestKSearch (searchPoint, 5, indicesHeap, distancesHeap);
+    octreeArena.nearestKSearch (searchPoint, 5, indicesArena, distancesArena);
+    ASSERT_EQ (indicesHeap, indicesArena);
+  }
+
+  // every point index is stored once, the arena reserves at least the nodes in use
+  using LeafNode = OctreePointCloudSearch<PointXYZ>::LeafNode;
+  using BranchNode = OctreePointCloudSearch<PointXYZ>::BranchNode;
+  const std::size_t nodeBytes = octreeHeap.getLeafCount () * sizeof (LeafNode) +
+                                octreeHeap.getBranchCount () * sizeof (BranchNode);
+  const std::size_t indexBytes = cloudIn->size () * sizeof (index_t);
+  EXPECT_GE (octreeHeap.getMemoryUsage (), nodeBytes + indexBytes);
+  EXPECT_GE (octreeArena.getMemoryUsage (), nodeBytes + indexBytes);
+
+  OctreeBase<int> octreeEmpty;
+  EXPECT_EQ (sizeof (OctreeBase<int>::BranchNode), octreeEmpty.getMemoryUsage ());
+}
+
+TEST (PCL, Octree_Pointcloud_Snapshot)
+{
+  PointCloud<PointXYZ>::Ptr cloudIn (new PointCloud<PointXYZ> (5000, 1));
+
+  srand (static_cast<unsigned int> (time (nullptr)));
+  for (auto& point : *cloudIn)
+    point = PointXYZ (static_cast<float> (10.0 * rand () / RAND_MAX),
+                      static_cast<float> (10.0 * rand () / RAND_MAX),
+                      static_cast<float> (10.0 * rand () / RAND_MAX));
+
+  OctreePointCloudSearch<PointXYZ> octree (0.25);
+  octree.setInputCloud (cloudIn);
+  octree.addPointsFromInputCloud ();
+
+  const OctreeSnapshot<PointXYZ> snapshot = octree.freeze ();
+  ASSERT_FALSE (snapshot.empty ());
+  ASSERT_EQ (cloudIn->size (), snapshot.getPointCount ());
+  ASSERT_EQ (octree.getTreeDepth (), snapshot.getTreeDepth ());
+
+  // save and load again
+  const std::string fileName = "octree_snapshot_test.bin";
+  ASSERT_TRUE (snapshot.save (fileName));
+  OctreeSnapshot<PointXYZ> loaded;
+  ASSERT_TRUE (loaded.load (fileName));
+  std::remove (fileName.c_str ());
+  ASSERT_EQ (snapshot.getDataSize (), loaded.getDataSize ());
+
+  // attach to an external buffer without copying
+  std::vector<std::uint64_t> buffer (snapshot.getDataSize () / sizeof (std::uint64_t) + 1);
+  std::memcpy (buffer.data (), snapshot.getData (), snapshot.getDataSize ());
+  OctreeSnapshot<PointXYZ> attached;
+  ASSERT_TRUE (attached.attach (buffer.data (), snapshot.getDataSize ()));
+  ASSERT_FALSE (attached.attach (buffer.data (), snapshot.getDataSize () / 2));
+  ASSERT_TRUE (attached.attach (buffer.data (), snapshot.getDataSize ()));
+
+  for (unsigned int test_id = 0; test_id < 20; ++test_id)
+  {
+    const PointXYZ searchPoint (static_cast<float> (10.0 * rand () / RAND_MAX),
+                                static_cast<float> (10.0 * rand () / RAND_MAX),
+                                static_cast<float> (10.0 * rand () / RAND_MAX));
+    const double radius = 2.0 * rand () / RAND_MAX;
+
+    const OctreeSnapshot<PointXYZ>* snapshots[] = {&snapshot, &loaded, &attached};
+    for (const auto* frozen : snapshots)
+    {
+      Indices indicesOctree, indicesSnapshot;
+      std::vector<float> distancesOctree, distancesSnapshot;
+
+      octree.voxelSearch (searchPoint, indicesOctree);
+      frozen->voxelSearch (searchPoint, indicesSnapshot);
+      ASSERT_EQ (indicesOctree, indicesSnapshot);
+
+      octree.nearestKSearch (searchPoint, 10, indicesOctree, distancesOctree);
+      frozen->nearestKSearch (searchPoint, 10, indicesSnapshot, distancesSnapshot);
+      ASSERT_EQ (distancesOctree.size (), distancesSnapshot.size ());
+      for (std::size_t i = 0; i < distancesOctree.size (); ++i)
+        EXPECT_NEAR (distancesOctree[i], distancesSnapshot[i], 1e-5);
+
+      octree.radiusSearch (searchPoint, radius, indicesOctree, distancesOctree);
+      frozen->radiusSearch (searchPoint, radius, indicesSnapshot, distancesSnapshot);
+      std::sort (indicesOctree.begin (), indicesOctree.end ());
+      std::sort (indicesSnapshot.begin (), indicesSnapshot.end ());
+      ASSERT_EQ (indicesOctree, indicesSnapshot);
+
+      const Eigen::Vector3f origin (-1.0f, searchPoint.y, searchPoint.z);
+      const Eigen::Vector3f direction (searchPoint.x + 1.0f,
+                                       static_cast<float> (rand ()) / RAND_MAX - 0.5f,
+                                       static_cast<float> (rand ()) / RAND_MAX - 0.5f);
+      const auto voxelCountOctree =
+          octree.getIntersectedVoxelIndices (origin, direction, indicesOctree);
+      const auto voxelCountSnapshot =
+          frozen->getIntersectedVoxelIndices (origin, direction, indicesSnapshot);
+      ASSERT_EQ (voxelCountOctree, voxelCountSnapshot);
+      ASSERT_EQ (indicesOctree, indicesSnapshot);
+    }
+  }
+}
+
 /* ---[ */
 int
 main (int argc, char** argv)
@@ -44,9 +44,11 @@
 
 #include <pcl/test/gtest.h>
 
+#include <algorithm>
 #include <vector>
 #include <iostream>
 #include <random>
+#include <tuple>
 
 #include <pcl/common/time.h>
 
@@ -57,6 +59,8 @@
 #include <pcl/outofcore/outofcore_impl.h>
 
 #include <pcl/PCLPointCloud2.h>
+#include <pcl/io/pcd_io.h>
+#include <pcl/visualization/common/common.h>
 
 using namespace pcl::outofcore;
 
@@ -940,6 +944,311 @@ TEST_F (OutofcoreTest, PointCloud2_Query)
   cleanUpFilesystem ();
 }
 
+TEST_F (OutofcoreTest, DiskContainer_RangeReads)
+{
+  cleanUpFilesystem ();
+  boost::filesystem::create_directory (outofcore_path.parent_path ());
+  const boost::filesystem::path node_file = outofcore_path.parent_path () / "node.pcd";
+
+  AlignedPointTVector some_points;
+  for (unsigned int i = 0; i < 1000; i++)
+    some_points.push_back (PointT (static_cast<float> (i), 0.0f, 0.0f));
+
+  OutofcoreOctreeDiskContainer<PointT> container (node_file);
+  container.insertRange (some_points.data (), some_points.size ());
+  ASSERT_EQ (some_points.size (), container.size ());
+
+  // Ranges are served from the decoded file
+  AlignedPointTVector range;
+  container.readRange (10, 5, range);
+  ASSERT_EQ (5, range.size ());
+  for (std::size_t i = 0; i < range.size (); i++)
+    EXPECT_TRUE (compPt (some_points[10 + i], range[i]));
+
+  // Subsamples only hold points of the sampled range
+  AlignedPointTVector subsample;
+  container.readRangeSubSample (100, 200, 0.1, subsample);
+  EXPECT_EQ (20, subsample.size ());
+  for (const auto &p : subsample)
+    EXPECT_TRUE (p.x >= 100.0f && p.x < 300.0f);
+  container.readRangeSubSample_bernoulli (0, container.size (), 0.5, subsample);
+  EXPECT_LT (subsample.size (), container.size ());
+
+  // Writes invalidate the cached points
+  container.insertRange (some_points.data (), some_points.size ());
+  range.clear ();
+  container.readRange (0, container.size (), range);
+  EXPECT_EQ (2 * some_points.size (), range.size ());
+
+  // Without a cache, reads go to the file every time
+  const std::uint64_t cache_size = OutofcoreOctreeDiskContainer<PointT>::getReadCacheSize ();
+  OutofcoreOctreeDiskContainer<PointT>::setReadCacheSize (0);
+  OutofcoreOctreeDiskContainer<PointT> reloaded (node_file);
+  range.clear ();
+  reloaded.readRange (0, reloaded.size (), range);
+  EXPECT_EQ (2 * some_points.size (), range.size ());
+  OutofcoreOctreeDiskContainer<PointT>::setReadCacheSize (cache_size);
+
+  cleanUpFilesystem ();
+}
+
+TEST_F (OutofcoreTest, Outofcore_QuantizedCodec)
+{
+  cleanUpFilesystem ();
+
+  const Eigen::Vector3d min (-100.0, -100.0, -100.0);
+  const Eigen::Vector3d max (100.0, 100.0, 100.0);
+
+  AlignedPointTVector some_points;
+  std::mt19937 rng (rngseed);
+  std::uniform_real_distribution<float> dist (-100.0f, 100.0f);
+  for (std::size_t i = 0; i < numPts; i++)
+    some_points.push_back (PointT (dist (rng), dist (rng), dist (rng)));
+
+  {
+    octree_disk octree (2, min, max, filename_otreeA, "ECEF");
+    EXPECT_EQ (OutofcoreOctreeNodeMetadata::BINARY_COMPRESSED, octree.getNodeCodec ());
+    ASSERT_TRUE (octree.setNodeCodec (OutofcoreOctreeNodeMetadata::QUANTIZED));
+    EXPECT_EQ (some_points.size (), octree.addDataToLeaf (some_points));
+
+    // The codec can not change once the tree holds points
+    EXPECT_FALSE (octree.setNodeCodec (OutofcoreOctreeNodeMetadata::BINARY_COMPRESSED));
+  }
+
+  // The codec is read back from the node metadata, and the points are within the quantization error of their leaf
+  octree_disk octree (filename_otreeA, true);
+  EXPECT_EQ (OutofcoreOctreeNodeMetadata::QUANTIZED, octree.getNodeCodec ());
+
+  AlignedPointTVector query_result;
+  octree.queryBBIncludes (min, max, octree.getDepth (), query_result);
+  ASSERT_EQ (some_points.size (), query_result.size ());
+
+  const float tolerance = static_cast<float> ((max[0] - min[0]) / 4.0 / 65535.0);
+  auto less = [] (const PointT &a, const PointT &b) { return (a.x < b.x); };
+  std::sort (some_points.begin (), some_points.end (), less);
+  std::sort (query_result.begin (), query_result.end (), less);
+  for (std::size_t i = 0; i < some_points.size (); i++)
+    EXPECT_NEAR (some_points[i].x, query_result[i].x, tolerance);
+
+  // PCLPointCloud2 reads are dequantized as well
+  pcl::PCLPointCloud2::Ptr blob (new pcl::PCLPointCloud2 ());
+  octree.queryBBIncludes (min, max, octree.getDepth (), blob);
+  EXPECT_EQ (some_points.size (), blob->width*blob->height);
+  for (const auto &field : blob->fields)
+    EXPECT_EQ (pcl::PCLPointField::FLOAT32, field.datatype);
+
+  cleanUpFilesystem ();
+}
+
+TEST_F (OutofcoreTest, PointCloud2_BulkInsertion)
+{
+  cleanUpFilesystem ();
+
+  const Eigen::Vector3d min (-100.1, -100.1, -100.1);
+  const Eigen::Vector3d max (100.1, 100.1, 100.1);
+  const std::uint64_t depth = 3;
+
+  pcl::PointCloud<PointT> test_cloud;
+  srand (rngseed);
+  for (std::size_t i = 0; i < numPts; i++)
+  {
+    test_cloud.push_back (PointT (static_cast<float> (rand () % 200) - 100.0f,
+                                  static_cast<float> (rand () % 200) - 100.0f,
+                                  static_cast<float> (rand () % 200) - 100.0f));
+  }
+  pcl::PCLPointCloud2::Ptr input_cloud (new pcl::PCLPointCloud2 ());
+  pcl::toPCLPointCloud2 (test_cloud, *input_cloud);
+
+  octree_disk octreeA (depth, min, max, filename_otreeA, "ECEF");
+  octree_disk octreeB (depth, min, max, filename_otreeB, "ECEF");
+  octree_disk octreeC (depth, min, max, outofcore_path, "ECEF");
+
+  ASSERT_EQ (numPts, octreeA.addPointCloud (input_cloud, false));
+
+  octreeB.setNumberOfThreads (4);
+  ASSERT_EQ (numPts, octreeB.addPointCloudBulk (input_cloud));
+
+  // Spill to the temporary buckets, from two files
+  const boost::filesystem::path first_file = outofcore_path.parent_path () / "first.pcd";
+  const boost::filesystem::path second_file = outofcore_path.parent_path () / "second.pcd";
+  pcl::PCLPointCloud2 first_half, second_half;
+  pcl::Indices first_indices, second_indices;
+  for (std::size_t i = 0; i < numPts; i++)
+    (i < numPts / 2 ? first_indices : second_indices).push_back (static_cast<pcl::index_t> (i));
+  pcl::copyPointCloud (*input_cloud, first_indices, first_half);
+  pcl::copyPointCloud (*input_cloud, second_indices, second_half);
+  pcl::PCDWriter writer;
+  writer.writeBinaryCompressed (first_file.string (), first_half);
+  writer.writeBinaryCompressed (second_file.string (), second_half);
+
+  octreeC.setBulkMemoryLimit (1);
+  ASSERT_EQ (numPts, octreeC.addPointCloudBulk (std::vector<boost::filesystem::path> {first_file, second_file}));
+  EXPECT_FALSE (boost::filesystem::exists (outofcore_path.parent_path () / "bulk_insert.tmp"));
+
+  // Same leaves, with the same points
+  AlignedPointTVector centers_a, centers_b, centers_c;
+  octreeA.getOccupiedVoxelCenters (centers_a);
+  octreeB.getOccupiedVoxelCenters (centers_b);
+  octreeC.getOccupiedVoxelCenters (centers_c);
+  auto less = [] (const PointT &p1, const PointT &p2) { return (std::tie (p1.x, p1.y, p1.z) < std::tie (p2.x, p2.y, p2.z)); };
+  std::sort (centers_a.begin (), centers_a.end (), less);
+  std::sort (centers_b.begin (), centers_b.end (), less);
+  std::sort (centers_c.begin (), centers_c.end (), less);
+  ASSERT_EQ (centers_a.size (), centers_b.size ());
+  ASSERT_EQ (centers_a.size (), centers_c.size ());
+  for (std::size_t i = 0; i < centers_a.size (); i++)
+  {
+    EXPECT_TRUE (compPt (centers_a[i], centers_b[i]));
+    EXPECT_TRUE (compPt (centers_a[i], centers_c[i]));
+  }
+
+  const double leaf_side = octreeA.getVoxelSideLength (depth);
+  for (const auto &center : centers_a)
+  {
+    const Eigen::Vector3d half (leaf_side / 4.0, leaf_side / 4.0, leaf_side / 4.0);
+    const Eigen::Vector3d c (center.x, center.y, center.z);
+    AlignedPointTVector result_a, result_b, result_c;
+    octreeA.queryBBIncludes (c - half, c + half, depth, result_a);
+    octreeB.queryBBIncludes (c - half, c + half, depth, result_b);
+    octreeC.queryBBIncludes (c - half, c + half, depth, result_c);
+    EXPECT_EQ (result_a.size (), result_b.size ());
+    EXPECT_EQ (result_a.size (), result_c.size ());
+  }
+  EXPECT_EQ (octreeA.getNumPointsAtDepth (depth), octreeB.getNumPointsAtDepth (depth));
+  EXPECT_EQ (octreeA.getNumPointsAtDepth (depth), octreeC.getNumPointsAtDepth (depth));
+
+  // Every branch node gets a sample of its children
+  octreeB.buildLODBulk ();
+  for (std::uint64_t d = 0; d < depth; d++)
+  {
+    const std::uint64_t lod_points = octreeB.getNumPointsAtDepth (d);
+    EXPECT_GT (lod_points, 0);
+    EXPECT_LT (lod_points, octreeB.getNumPointsAtDepth (d + 1));
+
+    pcl::PCLPointCloud2::Ptr query_result (new pcl::PCLPointCloud2 ());
+    octreeB.queryBBIncludes (min, max, d, query_result);
+    EXPECT_EQ (lod_points, query_result->width*query_result->height);
+  }
+
+  // Rebuilding replaces the LOD instead of adding to it
+  const std::uint64_t root_points = octreeB.getNumPointsAtDepth (0);
+  octreeB.buildLODBulk ();
+  EXPECT_EQ (root_points, octreeB.getNumPointsAtDepth (0));
+
+  cleanUpFilesystem ();
+}
+
+/** \brief View projection matrix of a camera at \c eye looking at \c target, with a 60 degrees field of view */
+Eigen::Matrix4d
+getViewProjection (const Eigen::Vector3d &eye, const Eigen::Vector3d &target)
+{
+  const Eigen::Vector3d forward = (target - eye).normalized ();
+  const Eigen::Vector3d right = forward.cross (Eigen::Vector3d::UnitY ()).normalized ();
+  const Eigen::Vector3d up = right.cross (forward);
+
+  Eigen::Matrix4d view = Eigen::Matrix4d::Identity ();
+  view.block<1, 3> (0, 0) = right.transpose ();
+  view.block<1, 3> (1, 0) = up.transpose ();
+  view.block<1, 3> (2, 0) = -forward.transpose ();
+  view (0, 3) = -right.dot (eye);
+  view (1, 3) = -up.dot (eye);
+  view (2, 3) = forward.dot (eye);
+
+  const double near_plane = 1.0, far_plane = 1000.0;
+  const double f = 1.0 / std::tan (M_PI / 6.0);
+  Eigen::Matrix4d projection = Eigen::Matrix4d::Zero ();
+  projection (0, 0) = f;
+  projection (1, 1) = f;
+  projection (2, 2) = (far_plane + near_plane) / (near_plane - far_plane);
+  projection (2, 3) = 2.0 * far_plane * near_plane / (near_plane - far_plane);
+  projection (3, 2) = -1.0;
+
+  return (projection * view);
+}
+
+TEST_F (OutofcoreTest, QueryService_Prefetch)
+{
+  cleanUpFilesystem ();
+
+  const Eigen::Vector3d min (-100.1, -100.1, -100.1);
+  const Eigen::Vector3d max (100.1, 100.1, 100.1);
+
+  pcl::PointCloud<PointT> test_cloud;
+  srand (rngseed);
+  for (std::size_t i = 0; i < numPts; i++)
+  {
+    test_cloud.push_back (PointT (static_cast<float> (rand () % 200) - 100.0f,
+                                  static_cast<float> (rand () % 200) - 100.0f,
+                                  static_cast<float> (rand () % 200) - 100.0f));
+  }
+  pcl::PCLPointCloud2::Ptr input_cloud (new pcl::PCLPointCloud2 ());
+  pcl::toPCLPointCloud2 (test_cloud, *input_cloud);
+
+  octree_disk::Ptr octree (new octree_disk (2, min, max, filename_otreeA, "ECEF"));
+  octree->addPointCloud_and_genLOD (input_cloud);
+  std::uint64_t total_points = 0;
+  for (std::uint64_t d = 0; d <= octree->getDepth (); d++)
+    total_points += octree->getNumPointsAtDepth (d);
+
+  const int size = 1000;
+  const Eigen::Vector3d eye (0.0, 0.0, 400.0);
+  const Eigen::Matrix4d view_projection = getViewProjection (eye, Eigen::Vector3d::Zero ());
+  double planes[24];
+  pcl::visualization::getViewFrustum (view_projection, planes);
+
+  OutofcoreQueryService<> service (octree, 2);
+
+  // Everything is refined and fits in the budget
+  service.setPixelThreshold (1.0f);
+  EXPECT_EQ (total_points, service.update (planes, eye, view_projection, size, size));
+  service.waitForLoads ();
+  EXPECT_TRUE (service.isComplete ());
+
+  std::vector<OutofcoreQueryService<>::SelectedNode> nodes;
+  service.getSelectedNodes (nodes);
+  ASSERT_FALSE (nodes.empty ());
+  EXPECT_EQ (0, nodes.front ().depth);
+  std::uint64_t loaded_points = 0;
+  for (std::size_t i = 0; i < nodes.size (); i++)
+  {
+    ASSERT_TRUE (nodes[i].cloud != nullptr);
+    EXPECT_EQ (nodes[i].num_points, nodes[i].cloud->width*nodes[i].cloud->height);
+    loaded_points += nodes[i].num_points;
+    if (i > 0)
+    {
+      EXPECT_LE (nodes[i].screen_area, nodes[i - 1].screen_area);
+    }
+  }
+  EXPECT_EQ (total_points, loaded_points);
+
+  // The budget keeps the coarsest nodes; they are already cached
+  service.setPointBudget (octree->getNumPointsAtDepth (0) + octree->getNumPointsAtDepth (1));
+  const std::uint64_t budget_points = service.update (planes, eye, view_projection, size, size);
+  EXPECT_LE (budget_points, service.getPointBudget ());
+  EXPECT_GE (budget_points, octree->getNumPointsAtDepth (0));
+  EXPECT_EQ (0, service.getNumPendingRequests ());
+  EXPECT_TRUE (service.isComplete ());
+
+  // Looking away selects nothing and cancels everything
+  const Eigen::Matrix4d away = getViewProjection (eye, Eigen::Vector3d (0.0, 0.0, 800.0));
+  pcl::visualization::getViewFrustum (away, planes);
+  EXPECT_EQ (0, service.update (planes, eye, away, size, size));
+  EXPECT_EQ (0, service.getNumPendingRequests ());
+  service.getSelectedNodes (nodes);
+  EXPECT_TRUE (nodes.empty ());
+
+  // A view which does not fit in the cache is only partially loaded
+  OutofcoreQueryService<> small_service (octree, 1);
+  small_service.setPixelThreshold (1.0f);
+  small_service.setCacheCapacity (input_cloud->data.size () / 4);
+  pcl::visualization::getViewFrustum (view_projection, planes);
+  small_service.update (planes, eye, view_projection, size, size);
+  small_service.waitForLoads ();
+  EXPECT_FALSE (small_service.isComplete ());
+
+  cleanUpFilesystem ();
+}
+
 /* [--- */
 int
 main (int argc, char** argv)
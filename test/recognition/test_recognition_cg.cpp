@@ -39,6 +39,7 @@
 #include <pcl/test/gtest.h>
 #include <pcl/io/pcd_io.h>
 #include <pcl/point_cloud.h>
+#include <pcl/common/execution_context.h>
 #include <pcl/common/transforms.h>
 #include <pcl/correspondence.h>
 #include <pcl/features/normal_3d_omp.h>
@@ -49,6 +50,8 @@
 #include <pcl/recognition/cg/geometric_consistency.h>
 #include <pcl/common/eigen.h>
 
+#include <random>
+
 using namespace pcl;
 using namespace pcl::io;
 
@@ -156,8 +159,63 @@ TEST (PCL, GeometricConsistencyGrouping)
   //Assertions
   EXPECT_EQ (rototranslations.size (), 1);
   EXPECT_LT (computeRmsE (model_, scene_, rototranslations[0]), 1E-4);
+
+  // 0 threads takes what the budget allows, which must not change the groups
+  const unsigned int budget = pcl::ExecutionContext::getThreadBudget ();
+  pcl::ExecutionContext::setThreadBudget (4);
+  std::vector<Eigen::Matrix4f, Eigen::aligned_allocator<Eigen::Matrix4f> > rototranslations_mt;
+  GeometricConsistencyGrouping<PointType, PointType> clusterer_mt;
+  clusterer_mt.setInputCloud (model_downsampled_);
+  clusterer_mt.setSceneCloud (scene_downsampled_);
+  clusterer_mt.setModelSceneCorrespondences (model_scene_corrs_);
+  clusterer_mt.setGCSize (0.015);
+  clusterer_mt.setGCThreshold (25);
+  clusterer_mt.setNumberOfThreads (0);
+  EXPECT_TRUE (clusterer_mt.recognize (rototranslations_mt));
+  pcl::ExecutionContext::setThreadBudget (budget);
+
+  ASSERT_EQ (rototranslations_mt.size (), rototranslations.size ());
+  for (std::size_t i = 0; i < rototranslations.size (); ++i)
+    EXPECT_TRUE (rototranslations_mt[i] == rototranslations[i]);
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, HoughSpace3DCastVotes)
+{
+  std::mt19937 rng (42);
+  std::normal_distribution<double> distribution (0.0, 1.0);
+  std::vector<Eigen::Vector3d, Eigen::aligned_allocator<Eigen::Vector3d> > votes (5000);
+  std::vector<double> weights (votes.size ());
+  for (std::size_t i = 0; i < votes.size (); ++i)
+  {
+    votes[i] = Eigen::Vector3d (distribution (rng), distribution (rng), distribution (rng));
+    weights[i] = 1.0 + 0.1 * distribution (rng);
+  }
+
+  const Eigen::Vector3d min_coord (-2.0, -2.0, -2.0), bin_size (0.25, 0.25, 0.25), max_coord (2.0, 2.0, 2.0);
+  for (const bool interpolate : {false, true})
+  {
+    pcl::recognition::HoughSpace3D serial_space (min_coord, bin_size, max_coord);
+    pcl::recognition::HoughSpace3D parallel_space (min_coord, bin_size, max_coord);
+    for (int i = 0; i < static_cast<int> (votes.size ()); ++i)
+    {
+      if (interpolate)
+        serial_space.voteInt (votes[i], weights[i], i);
+      else
+        serial_space.vote (votes[i], weights[i], i);
+    }
+    parallel_space.castVotes (votes, weights, interpolate, 4);
+
+    std::vector<double> serial_values, parallel_values;
+    std::vector<std::vector<int> > serial_ids, parallel_ids;
+    serial_space.findMaxima (-0.1, serial_values, serial_ids);
+    parallel_space.findMaxima (-0.1, parallel_values, parallel_ids);
+
+    ASSERT_FALSE (serial_values.empty ());
+    EXPECT_EQ (serial_values, parallel_values);
+    EXPECT_EQ (serial_ids, parallel_ids);
+  }
+}
 
 /* ---[ */
 int
@@ -0,0 +1,156 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2010-2012, Willow Garage, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include <pcl/test/gtest.h>
+#include <pcl/point_types.h>
+#include <pcl/point_cloud.h>
+#include <pcl/recognition/crh_alignment.h>
+
+using CRH = pcl::Histogram<90>;
+
+// Packs the spectrum of a 90 bin roll histogram the way CRHEstimation does
+CRH
+makeCRH (const std::vector<float>& roll_histogram)
+{
+  std::vector<kiss_fft_scalar> spatial_data (roll_histogram.begin (), roll_histogram.end ());
+  std::vector<kiss_fft_cpx> freq_data (46);
+  kiss_fftr_cfg cfg = kiss_fftr_alloc (90, 0, nullptr, nullptr);
+  kiss_fftr (cfg, spatial_data.data (), freq_data.data ());
+  kiss_fftr_free (cfg);
+
+  const float dc = freq_data[0].r;
+  CRH crh;
+  crh.histogram[0] = 1.f;
+  for (int i = 1, k = 1; i < 45; i++, k += 2)
+  {
+    crh.histogram[k] = freq_data[i].r / dc;
+    crh.histogram[k + 1] = freq_data[i].i / dc;
+  }
+  crh.histogram[89] = freq_data[45].r / dc;
+  return (crh);
+}
+
+// An asymmetric roll histogram, circularly shifted by shift bins
+std::vector<float>
+rollHistogram (int shift)
+{
+  std::vector<float> histogram (90);
+  for (int i = 0; i < 90; i++)
+  {
+    const float x = static_cast<float> (i) / 90.f;
+    histogram[(i + shift) % 90] = 1.f + std::exp (-100.f * (x - 0.2f) * (x - 0.2f)) + 0.5f * std::exp (-200.f * (x - 0.6f) * (x - 0.6f));
+  }
+  return (histogram);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (CRHAlignment, BatchMatchesSingle)
+{
+  pcl::PointCloud<CRH> target;
+  target.push_back (makeCRH (rollHistogram (0)));
+
+  pcl::PointCloud<CRH> inputs;
+  for (int shift = 0; shift < 90; shift += 7)
+    inputs.push_back (makeCRH (rollHistogram (shift)));
+
+  pcl::CRHAlignment<pcl::PointXYZ, 90> crha;
+  std::vector<std::vector<float> > batch_peaks;
+  crha.computeRollAngles (inputs, target, batch_peaks);
+  ASSERT_EQ (batch_peaks.size (), inputs.size ());
+
+  for (std::size_t i = 0; i < inputs.size (); i++)
+  {
+    pcl::PointCloud<CRH> input;
+    input.push_back (inputs[i]);
+    std::vector<float> peaks;
+    crha.computeRollAngle (input, target, peaks);
+
+    ASSERT_EQ (peaks.size (), batch_peaks[i].size ());
+    for (std::size_t j = 0; j < peaks.size (); j++)
+      EXPECT_EQ (peaks[j], batch_peaks[i][j]);
+  }
+
+  // identical histograms need no roll
+  ASSERT_FALSE (batch_peaks[0].empty ());
+  EXPECT_EQ (batch_peaks[0][0], 0.f);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (CRHAlignment, BatchAlign)
+{
+  pcl::PointCloud<CRH> target;
+  target.push_back (makeCRH (rollHistogram (0)));
+  const Eigen::Vector3f target_centroid (0.1f, -0.05f, 1.f);
+
+  pcl::PointCloud<CRH> inputs;
+  std::vector<Eigen::Vector3f, Eigen::aligned_allocator<Eigen::Vector3f> > centroids;
+  for (int shift = 0; shift < 90; shift += 11)
+  {
+    inputs.push_back (makeCRH (rollHistogram (shift)));
+    centroids.emplace_back (0.02f * static_cast<float> (shift) / 90.f, 0.03f, 0.9f);
+  }
+
+  pcl::CRHAlignment<pcl::PointXYZ, 90> crha;
+  std::vector<std::vector<Eigen::Matrix4f, Eigen::aligned_allocator<Eigen::Matrix4f> > > batch_transforms;
+  crha.align (inputs, centroids, target, target_centroid, batch_transforms);
+  ASSERT_EQ (batch_transforms.size (), inputs.size ());
+
+  for (std::size_t i = 0; i < inputs.size (); i++)
+  {
+    pcl::PointCloud<CRH> input;
+    input.push_back (inputs[i]);
+    Eigen::Vector3f input_centroid = centroids[i];
+    Eigen::Vector3f target_centroid_copy = target_centroid;
+    crha.setInputAndTargetCentroids (input_centroid, target_centroid_copy);
+    crha.align (input, target);
+
+    std::vector<Eigen::Matrix4f, Eigen::aligned_allocator<Eigen::Matrix4f> > transforms;
+    crha.getTransforms (transforms);
+    ASSERT_EQ (transforms.size (), batch_transforms[i].size ());
+    for (std::size_t j = 0; j < transforms.size (); j++)
+      EXPECT_TRUE (transforms[j].isApprox (batch_transforms[i][j]));
+  }
+}
+
+/* ---[ */
+int
+main (int argc, char** argv)
+{
+  testing::InitGoogleTest (&argc, argv);
+  return (RUN_ALL_TESTS ());
+}
+/* ]--- */
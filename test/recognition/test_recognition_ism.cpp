@@ -89,6 +89,53 @@ TEST (ISM, TrainRecognize)
   vote_list->findStrongestPeaks (strongest_peaks, _class, radius, sigma);
 
   EXPECT_NE (strongest_peaks.size (), 0);
+
+  // codebook matching and mean shift must not depend on the number of threads
+  for (const unsigned int nr_threads : {4u, 0u})
+  {
+    SCOPED_TRACE (nr_threads);
+    ism.setNumberOfThreads (nr_threads);
+    auto parallel_vote_list = ism.findObjects (model, testing_cloud, testing_normals, _class);
+    EXPECT_EQ (parallel_vote_list->getNumberOfVotes (), vote_list->getNumberOfVotes ());
+    std::vector<pcl::ISMPeak, Eigen::aligned_allocator<pcl::ISMPeak> > parallel_peaks;
+    parallel_vote_list->findStrongestPeaks (parallel_peaks, _class, radius, sigma);
+    ASSERT_EQ (parallel_peaks.size (), strongest_peaks.size ());
+    for (std::size_t i_peak = 0; i_peak < parallel_peaks.size (); i_peak++)
+      EXPECT_NEAR (parallel_peaks[i_peak].density, strongest_peaks[i_peak].density, 1e-6 * strongest_peaks[i_peak].density);
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (ISM, VoteDensity)
+{
+  pcl::features::ISMVoteList<pcl::PointXYZ> vote_list;
+  pcl::PointCloud<pcl::InterestPoint> votes;
+  pcl::PointXYZ origin (0.0f, 0.0f, 0.0f);
+  for (int i_vote = 0; i_vote < 1000; i_vote++)
+  {
+    // deterministic spread around and across cell borders, negative coordinates included
+    pcl::InterestPoint vote;
+    vote.x = static_cast<float> ((i_vote * 37) % 101) * 0.1f - 5.0f;
+    vote.y = static_cast<float> ((i_vote * 53) % 97) * 0.1f - 4.8f;
+    vote.z = static_cast<float> ((i_vote * 71) % 89) * 0.1f - 4.4f;
+    vote.strength = 0.5f + static_cast<float> (i_vote % 7) * 0.1f;
+    vote_list.addVote (vote, origin, 0);
+    votes.push_back (vote);
+  }
+
+  const double sigma = 0.7;
+  for (float x = -5.0f; x <= 5.0f; x += 1.3f)
+  {
+    pcl::PointXYZ point (x, 0.4f * x, -0.3f * x);
+    double expected = 0.0;
+    for (const auto& vote : votes)
+    {
+      const double sqr_dist = (vote.getVector3fMap () - point.getVector3fMap ()).squaredNorm ();
+      if (sqr_dist <= 9.0 * sigma * sigma)
+        expected += vote.strength * std::exp (-sqr_dist / (sigma * sigma));
+    }
+    EXPECT_NEAR (vote_list.getDensityAtPoint (point, sigma), expected, 1e-4);
+  }
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
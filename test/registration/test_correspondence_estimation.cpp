@@ -37,10 +37,14 @@
 
 #include <pcl/test/gtest.h>
 #include <pcl/io/pcd_io.h>
+#include <pcl/registration/correspondence_estimation_backprojection.h>
 #include <pcl/registration/correspondence_estimation_normal_shooting.h>
+#include <pcl/registration/descriptor_matcher.h>
 #include <pcl/features/normal_3d.h>
 #include <pcl/kdtree/kdtree.h>
 
+#include <algorithm> // for std::all_of, std::sort
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 TEST (CorrespondenceEstimation, CorrespondenceEstimationNormalShooting)
 {
@@ -119,6 +123,176 @@ TEST (CorrespondenceEstimation, CorrespondenceEstimationSetSearchMethod)
   
 }
 
+//////////////////////////////////////////////////////////////////////////////////////
+template <typename CorrespondenceEstimationT> void
+checkMultiThreadedCorrespondences (CorrespondenceEstimationT &ce, double max_distance)
+{
+  for (const bool reciprocal : {false, true})
+  {
+    pcl::Correspondences corr_single, corr_multi;
+    ce.setNumberOfThreads (1);
+    if (reciprocal)
+      ce.determineReciprocalCorrespondences (corr_single, max_distance);
+    else
+      ce.determineCorrespondences (corr_single, max_distance);
+    EXPECT_FALSE (corr_single.empty ());
+
+    // The blocks of the threads are concatenated in the order of the source indices
+    ce.setNumberOfThreads (4);
+    if (reciprocal)
+      ce.determineReciprocalCorrespondences (corr_multi, max_distance);
+    else
+      ce.determineCorrespondences (corr_multi, max_distance);
+    ASSERT_EQ (corr_single.size (), corr_multi.size ());
+    for (std::size_t i = 0; i < corr_single.size (); i++)
+    {
+      EXPECT_EQ (corr_single[i].index_query, corr_multi[i].index_query);
+      EXPECT_EQ (corr_single[i].index_match, corr_multi[i].index_match);
+      EXPECT_EQ (corr_single[i].distance, corr_multi[i].distance);
+    }
+  }
+}
+
+TEST (CorrespondenceEstimation, CorrespondenceEstimationMultiThreaded)
+{
+  pcl::PointCloud<pcl::PointXYZ>::Ptr cloud1 (new pcl::PointCloud<pcl::PointXYZ> ());
+  pcl::PointCloud<pcl::PointXYZ>::Ptr cloud2 (new pcl::PointCloud<pcl::PointXYZ> ());
+  pcl::PointCloud<pcl::Normal>::Ptr normals1 (new pcl::PointCloud<pcl::Normal> ());
+  pcl::PointCloud<pcl::Normal>::Ptr normals2 (new pcl::PointCloud<pcl::Normal> ());
+  srand (7);
+  for (std::size_t i = 0; i < 2000; i++)
+  {
+    cloud1->points.emplace_back (float (rand ()) / RAND_MAX, float (rand ()) / RAND_MAX, float (rand ()) / RAND_MAX);
+    cloud2->points.emplace_back (float (rand ()) / RAND_MAX, float (rand ()) / RAND_MAX, float (rand ()) / RAND_MAX);
+    normals1->points.emplace_back (0.f, 0.f, 1.f);
+    normals2->points.emplace_back (0.f, 1.f, 0.f);
+  }
+
+  pcl::registration::CorrespondenceEstimation<pcl::PointXYZ, pcl::PointXYZ> ce;
+  ce.setInputSource (cloud1);
+  ce.setInputTarget (cloud2);
+  checkMultiThreadedCorrespondences (ce, 0.05);
+
+  pcl::registration::CorrespondenceEstimationNormalShooting<pcl::PointXYZ, pcl::PointXYZ, pcl::Normal> ce_ns;
+  ce_ns.setInputSource (cloud1);
+  ce_ns.setSourceNormals (normals1);
+  ce_ns.setInputTarget (cloud2);
+  checkMultiThreadedCorrespondences (ce_ns, 0.001);
+
+  pcl::registration::CorrespondenceEstimationBackProjection<pcl::PointXYZ, pcl::PointXYZ, pcl::Normal> ce_bp;
+  ce_bp.setInputSource (cloud1);
+  ce_bp.setSourceNormals (normals1);
+  ce_bp.setInputTarget (cloud2);
+  ce_bp.setTargetNormals (normals2);
+  checkMultiThreadedCorrespondences (ce_bp, 0.01);
+}
+
+// Sorted squared distances from a descriptor to all the descriptors of a cloud
+std::vector<std::pair<float, int> >
+sortedDescriptorDistances (const pcl::FPFHSignature33 &query, const pcl::PointCloud<pcl::FPFHSignature33> &cloud)
+{
+  std::vector<std::pair<float, int> > distances;
+  for (std::size_t i = 0; i < cloud.size (); i++)
+  {
+    if (!std::all_of (cloud[i].histogram, cloud[i].histogram + 33, [] (float bin) { return (std::isfinite (bin)); }))
+      continue;
+    float distance = 0.f;
+    for (int j = 0; j < 33; j++)
+      distance += (query.histogram[j] - cloud[i].histogram[j]) * (query.histogram[j] - cloud[i].histogram[j]);
+    distances.emplace_back (distance, static_cast<int> (i));
+  }
+  std::sort (distances.begin (), distances.end ());
+  return (distances);
+}
+
+TEST (CorrespondenceEstimation, DescriptorMatcher)
+{
+  // more descriptors than fit in one block of queries and of targets
+  pcl::PointCloud<pcl::FPFHSignature33>::Ptr source (new pcl::PointCloud<pcl::FPFHSignature33> (300, 1));
+  pcl::PointCloud<pcl::FPFHSignature33>::Ptr target (new pcl::PointCloud<pcl::FPFHSignature33> (1100, 1));
+  srand (11);
+  for (auto &descriptor : target->points)
+    for (float &bin : descriptor.histogram)
+      bin = 100.f * float (rand ()) / RAND_MAX;
+  // sources are noisy copies of targets, every third one unrelated
+  for (std::size_t i = 0; i < source->size (); i++)
+    for (int j = 0; j < 33; j++)
+      (*source)[i].histogram[j] = (i % 3 == 0) ? 100.f * float (rand ()) / RAND_MAX
+                                               : (*target)[3 * i].histogram[j] + float (rand ()) / RAND_MAX;
+  // invalid descriptors are never matched
+  (*source)[1].histogram[0] = std::numeric_limits<float>::quiet_NaN ();
+  (*target)[7].histogram[5] = std::numeric_limits<float>::quiet_NaN ();
+
+  pcl::registration::DescriptorMatcher<pcl::FPFHSignature33> matcher;
+  matcher.setInputSource (source);
+  matcher.setInputTarget (target);
+  matcher.setNumberOfThreads (4);
+
+  pcl::Correspondences correspondences;
+  matcher.determineCorrespondences (correspondences);
+  ASSERT_EQ (correspondences.size (), source->size () - 1);
+  for (const auto &corr : correspondences)
+  {
+    EXPECT_NE (corr.index_query, 1);
+    const auto expected = sortedDescriptorDistances ((*source)[corr.index_query], *target);
+    EXPECT_EQ (corr.index_match, expected[0].second);
+    EXPECT_NEAR (corr.distance, expected[0].first, 1e-3f * expected[0].first);
+  }
+
+  // ratio test: only the noisy copies have a distinctive nearest neighbor
+  matcher.setRatio (0.5f);
+  matcher.determineCorrespondences (correspondences);
+  EXPECT_FALSE (correspondences.empty ());
+  for (const auto &corr : correspondences)
+  {
+    const auto expected = sortedDescriptorDistances ((*source)[corr.index_query], *target);
+    EXPECT_LT (std::sqrt (expected[0].first), 0.5f * std::sqrt (expected[1].first));
+    EXPECT_EQ (corr.index_match, 3 * corr.index_query);
+  }
+
+  // cross check and maximum distance
+  matcher.setRatio (1.f);
+  matcher.setCrossCheck (true);
+  matcher.determineCorrespondences (correspondences, 5.0);
+  EXPECT_FALSE (correspondences.empty ());
+  for (const auto &corr : correspondences)
+  {
+    EXPECT_LE (corr.distance, 25.f);
+    const auto back = sortedDescriptorDistances ((*target)[corr.index_match], *source);
+    EXPECT_EQ (back[0].second, corr.index_query);
+  }
+
+  // k nearest neighbors, the same with one thread and with as many as the budget allows
+  std::vector<pcl::Correspondences> matches, matches_single, matches_budget;
+  matcher.nearestKSearch (3, matches);
+  matcher.setNumberOfThreads (1);
+  matcher.nearestKSearch (3, matches_single);
+  matcher.setNumberOfThreads (0);
+  EXPECT_EQ (matcher.getNumberOfThreads (), 0u);
+  matcher.nearestKSearch (3, matches_budget);
+  ASSERT_EQ (matches.size (), source->size ());
+  ASSERT_EQ (matches_single.size (), source->size ());
+  ASSERT_EQ (matches_budget.size (), source->size ());
+  EXPECT_TRUE (matches[1].empty ());
+  for (std::size_t i = 0; i < source->size (); i++)
+  {
+    if (i == 1)
+      continue;
+    const auto expected = sortedDescriptorDistances ((*source)[i], *target);
+    ASSERT_EQ (matches[i].size (), 3u);
+    ASSERT_EQ (matches_single[i].size (), 3u);
+    ASSERT_EQ (matches_budget[i].size (), 3u);
+    for (std::size_t j = 0; j < 3; j++)
+    {
+      EXPECT_EQ (matches[i][j].index_match, expected[j].second);
+      EXPECT_EQ (matches_single[i][j].index_match, matches[i][j].index_match);
+      EXPECT_EQ (matches_single[i][j].distance, matches[i][j].distance);
+      EXPECT_EQ (matches_budget[i][j].index_match, matches[i][j].index_match);
+      EXPECT_EQ (matches_budget[i][j].distance, matches[i][j].distance);
+    }
+  }
+}
+
 /* ---[ */
 int
   main (int argc, char** argv)
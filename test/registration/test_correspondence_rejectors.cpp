@@ -40,11 +40,15 @@
 #include <pcl/test/gtest.h>
 #include <pcl/point_types.h>
 #include <pcl/point_cloud.h>
+#include <pcl/common/angles.h> // for deg2rad
 #include <pcl/common/eigen.h>
 #include <pcl/common/random.h> // NormalGenerator
 #include <pcl/common/transforms.h>
 #include <pcl/io/pcd_io.h>
+#include <pcl/registration/correspondence_rejection_distance.h>
+#include <pcl/registration/correspondence_rejection_fused.h>
 #include <pcl/registration/correspondence_rejection_median_distance.h>
+#include <pcl/registration/correspondence_rejection_one_to_one.h>
 #include <pcl/registration/correspondence_rejection_poly.h>
 
 pcl::PointCloud<pcl::PointXYZ> cloud;
@@ -148,6 +152,109 @@ TEST (CorrespondenceRejectors, CorrespondenceRejectionPoly)
   EXPECT_NEAR(recall, 1.0, 0.2);
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (CorrespondenceRejectors, CorrespondenceRejectionFused)
+{
+  // Random correspondences with duplicate match indices and unique distances
+  pcl::CorrespondencesPtr corresps (new pcl::Correspondences ());
+  std::srand (42);
+  for (int i = 0; i < 5000; ++i)
+  {
+    pcl::Correspondence c;
+    c.index_query = i;
+    c.index_match = std::rand () % 2000;
+    c.distance = static_cast<float> ((i * 7919) % 5000) / 100.0f; // unique distances
+    corresps->push_back (c);
+  }
+
+  // Chain of separate rejectors
+  pcl::Correspondences expected;
+  pcl::registration::CorrespondenceRejectorDistance rej_distance;
+  rej_distance.setMaximumDistance (9.0f);
+  rej_distance.getRemainingCorrespondences (*corresps, expected);
+  pcl::registration::CorrespondenceRejectorMedianDistance rej_median;
+  rej_median.setMedianFactor (1.5);
+  pcl::Correspondences tmp;
+  rej_median.getRemainingCorrespondences (expected, tmp);
+  pcl::registration::CorrespondenceRejectorOneToOne rej_one_to_one;
+  rej_one_to_one.getRemainingCorrespondences (tmp, expected);
+
+  pcl::registration::CorrespondenceRejectorFused rejector;
+  rejector.addMaximumDistance (9.0f);
+  rejector.addMedianDistance (1.5);
+  rejector.addOneToOne ();
+  rejector.setNumberOfThreads (4);
+  EXPECT_EQ (rejector.getNumberOfStages (), 3);
+  rejector.setInputCorrespondences (corresps);
+  pcl::Correspondences result;
+  rejector.getCorrespondences (result);
+  EXPECT_NEAR (rejector.getMedianDistance (), rej_median.getMedianDistance (), 1e-6);
+
+  // The fused rejector keeps the input order
+  for (std::size_t i = 1; i < result.size (); ++i)
+    EXPECT_LT (result[i - 1].index_query, result[i].index_query);
+
+  auto by_query = [] (const pcl::Correspondence& a, const pcl::Correspondence& b)
+  { return a.index_query < b.index_query; };
+  std::sort (expected.begin (), expected.end (), by_query);
+  ASSERT_EQ (result.size (), expected.size ());
+  for (std::size_t i = 0; i < result.size (); ++i)
+  {
+    EXPECT_EQ (result[i].index_query, expected[i].index_query);
+    EXPECT_EQ (result[i].index_match, expected[i].index_match);
+  }
+
+  // Custom predicates and wrapped rejectors, compacting in place
+  rejector.clearStages ();
+  rejector.addPredicate ([] (const pcl::Correspondence& c) { return c.index_query % 2 == 0; });
+  pcl::registration::CorrespondenceRejectorDistance::Ptr rej_wrapped (new pcl::registration::CorrespondenceRejectorDistance);
+  rej_wrapped->setMaximumDistance (5.0f);
+  rejector.addRejector (rej_wrapped);
+  pcl::Correspondences in_place (*corresps);
+  rejector.rejectInPlace (in_place);
+  std::size_t nr_expected = 0;
+  for (const auto& c : *corresps)
+    if (c.index_query % 2 == 0 && c.distance < 25.0f)
+      ++nr_expected;
+  EXPECT_EQ (in_place.size (), nr_expected);
+  for (const auto& c : in_place)
+  {
+    EXPECT_EQ (c.index_query % 2, 0);
+    EXPECT_LT (c.distance, 25.0f);
+  }
+
+  // As many threads as the budget allows give the same result
+  rejector.setNumberOfThreads (0);
+  EXPECT_EQ (rejector.getNumberOfThreads (), 0);
+  pcl::Correspondences in_place_budget (*corresps);
+  rejector.rejectInPlace (in_place_budget);
+  ASSERT_EQ (in_place_budget.size (), in_place.size ());
+  for (std::size_t i = 0; i < in_place.size (); ++i)
+    EXPECT_EQ (in_place_budget[i].index_query, in_place[i].index_query);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (CorrespondenceRejectors, CorrespondenceRejectionFusedSurfaceNormal)
+{
+  pcl::PointCloud<pcl::PointNormal>::Ptr source (new pcl::PointCloud<pcl::PointNormal> (3, 1));
+  pcl::PointCloud<pcl::PointNormal>::Ptr target (new pcl::PointCloud<pcl::PointNormal> (3, 1));
+  for (auto& p : *source)
+    p.getNormalVector3fMap () = Eigen::Vector3f::UnitZ ();
+  (*target)[0].getNormalVector3fMap () = Eigen::Vector3f::UnitZ ();
+  (*target)[1].getNormalVector3fMap () = Eigen::Vector3f::UnitX ();
+  (*target)[2].getNormalVector3fMap () = Eigen::Vector3f (0.0f, 0.6f, 0.8f);
+
+  pcl::Correspondences corresps;
+  for (int i = 0; i < 3; ++i)
+    corresps.emplace_back (i, i, 0.0f);
+
+  pcl::registration::CorrespondenceRejectorFused rejector;
+  rejector.addSurfaceNormal<pcl::PointNormal> (source, target, std::cos (pcl::deg2rad (45.0)));
+  rejector.rejectInPlace (corresps);
+  ASSERT_EQ (corresps.size (), 2);
+  EXPECT_EQ (corresps[0].index_query, 0);
+  EXPECT_EQ (corresps[1].index_query, 2);
+}
 
 /* ---[ */
 int
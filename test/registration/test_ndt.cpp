@@ -41,6 +41,7 @@
 #include <pcl/test/gtest.h>
 
 #include <pcl/point_types.h>
+#include <pcl/common/execution_context.h>
 #include <pcl/io/pcd_io.h>
 #include <pcl/registration/ndt.h>
 
@@ -94,6 +95,55 @@ TEST (PCL, NormalDistributionsTransform)
   }
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, NormalDistributionsTransformMultiThreaded)
+{
+  using PointT = PointXYZ;
+  PointCloud<PointT>::Ptr src (new PointCloud<PointT> (cloud_source));
+  PointCloud<PointT>::Ptr tgt (new PointCloud<PointT> (cloud_target));
+  PointCloud<PointT> output;
+
+  using NDT = NormalDistributionsTransform<PointT, PointT>;
+  for (const auto method : {NDT::NeighborSearchMethod::KDTREE,
+                            NDT::NeighborSearchMethod::DIRECT26,
+                            NDT::NeighborSearchMethod::DIRECT7,
+                            NDT::NeighborSearchMethod::DIRECT1})
+  {
+    NDT reg;
+    reg.setStepSize (0.05);
+    reg.setResolution (0.025f);
+    reg.setNeighborhoodSearchMethod (method);
+    reg.setInputSource (src);
+    reg.setInputTarget (tgt);
+    reg.setMaximumIterations (50);
+    reg.setTransformationEpsilon (1e-8);
+    EXPECT_EQ (reg.getNeighborhoodSearchMethod (), method);
+
+    reg.setNumberOfThreads (1);
+    reg.align (output);
+    EXPECT_EQ (output.size (), cloud_source.size ());
+    EXPECT_LT (reg.getFitnessScore (), 0.001);
+    const Eigen::Matrix4f single_threaded = reg.getFinalTransformation ();
+    const double single_threaded_probability = reg.getTransformationProbability ();
+
+    // The accumulation order does not depend on the number of threads
+    reg.setNumberOfThreads (4);
+    reg.align (output);
+    EXPECT_EQ (output.size (), cloud_source.size ());
+    EXPECT_EQ (reg.getFinalTransformation (), single_threaded);
+    EXPECT_EQ (reg.getTransformationProbability (), single_threaded_probability);
+
+    // 0 takes the threads from the budget of the execution context
+    const unsigned int budget = pcl::ExecutionContext::getThreadBudget ();
+    pcl::ExecutionContext::setThreadBudget (4);
+    reg.setNumberOfThreads (0);
+    reg.align (output);
+    pcl::ExecutionContext::setThreadBudget (budget);
+    EXPECT_EQ (reg.getFinalTransformation (), single_threaded);
+    EXPECT_EQ (reg.getTransformationProbability (), single_threaded_probability);
+  }
+}
+
 int
 main (int argc, char** argv)
 {
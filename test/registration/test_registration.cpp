@@ -40,6 +40,7 @@
 #include <pcl/test/gtest.h>
 
 #include <pcl/point_types.h>
+#include <pcl/common/angles.h> // for deg2rad
 #include <pcl/io/pcd_io.h>
 #include <pcl/features/normal_3d.h>
 #include <pcl/registration/registration.h>
@@ -55,6 +56,8 @@
 #include <pcl/registration/correspondence_rejection_surface_normal.h>
 #include <pcl/registration/correspondence_estimation_normal_shooting.h>
 #include <pcl/registration/pyramid_feature_matching.h>
+#include <pcl/registration/pyramid_icp.h>
+#include <pcl/registration/scan_to_map_registration.h>
 #include <pcl/features/ppf.h>
 #include <pcl/registration/ppf_registration.h>
 #include <pcl/filters/voxel_grid.h>
@@ -232,6 +235,118 @@ TEST (PCL, IterativeClosestPoint)
   EXPECT_EQ (transformation (3, 3), 1);
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, PyramidICP)
+{
+  pcl::registration::PyramidICP<PointXYZ, PointXYZ> reg;
+  reg.addLevel (0.01f, 20, 0.1);
+  reg.addLevel (0.005f, 20, 0.05);
+  reg.addLevel (0.0f, 50, 0.05);
+  ASSERT_EQ (reg.getNumberOfLevels (), 3);
+  reg.getLevelRegistration (2)->setTransformationEpsilon (1e-8);
+
+  PointCloud<PointXYZ>::ConstPtr source (cloud_source.makeShared ());
+  PointCloud<PointXYZ>::ConstPtr target (cloud_target.makeShared ());
+  reg.setInputSource (source);
+  reg.setInputTarget (target);
+  EXPECT_FALSE (reg.getLevelTarget (0));
+
+  // Register
+  reg.align (cloud_reg);
+  EXPECT_TRUE (reg.hasConverged ());
+  EXPECT_EQ (cloud_reg.size (), cloud_source.size ());
+
+  // The coarser levels work on downsampled targets, the finest one on the target itself
+  const PointCloud<PointXYZ>::ConstPtr coarse_target = reg.getLevelTarget (0);
+  ASSERT_TRUE (coarse_target);
+  EXPECT_LT (coarse_target->size (), reg.getLevelTarget (1)->size ());
+  EXPECT_LT (reg.getLevelTarget (1)->size (), cloud_target.size ());
+  EXPECT_EQ (reg.getLevelTarget (2), target);
+
+  // Same result as IterativeClosestPoint at full resolution
+  const Eigen::Matrix4f transformation = reg.getFinalTransformation ();
+  EXPECT_NEAR (transformation (0, 0), 0.8806,  1e-2);
+  EXPECT_NEAR (transformation (0, 2), -0.4724, 1e-2);
+  EXPECT_NEAR (transformation (0, 3), 0.03453, 1e-2);
+  EXPECT_NEAR (transformation (1, 1), 0.9992,  1e-2);
+  EXPECT_NEAR (transformation (2, 0), 0.4732,  1e-2);
+  EXPECT_NEAR (transformation (2, 2), 0.8808,  1e-2);
+  EXPECT_NEAR (transformation (2, 3), 0.04116, 1e-2);
+  EXPECT_LT (reg.getFitnessScore (), 0.0005);
+
+  // A new source reuses the pyramid
+  reg.setInputSource (source);
+  reg.align (cloud_reg);
+  EXPECT_EQ (reg.getLevelTarget (0), coarse_target);
+  EXPECT_EQ (reg.getFinalTransformation (), transformation);
+
+  // A new target rebuilds it
+  reg.setInputTarget (target);
+  reg.align (cloud_reg);
+  EXPECT_NE (reg.getLevelTarget (0), coarse_target);
+  EXPECT_EQ (reg.getFinalTransformation (), transformation);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, ScanToMapRegistration)
+{
+  IterativeClosestPoint<PointXYZ, PointXYZ>::Ptr icp (new IterativeClosestPoint<PointXYZ, PointXYZ>);
+  icp->setMaxCorrespondenceDistance (0.05);
+  icp->setMaximumIterations (50);
+  icp->setTransformationEpsilon (1e-8);
+
+  pcl::registration::ScanToMapRegistration<PointXYZ> s2m;
+  s2m.setRegistration (icp);
+  s2m.setMapLeafSize (0.002f);
+  EXPECT_FLOAT_EQ (s2m.getMapLeafSize (), 0.002f);
+
+  // The sensor moves along x while turning around z; each frame sees the static scene from its pose
+  Eigen::Matrix4f pose = Eigen::Matrix4f::Identity ();
+  Eigen::Matrix4f step = Eigen::Matrix4f::Identity ();
+  step.block<3, 3> (0, 0) = Eigen::AngleAxisf (pcl::deg2rad (2.0f), Eigen::Vector3f::UnitZ ()).toRotationMatrix ();
+  step (0, 3) = 0.01f;
+
+  search::KdTree<PointXYZ>::Ptr map_search;
+  for (int i = 0; i < 6; ++i)
+  {
+    PointCloud<PointXYZ>::Ptr frame (new PointCloud<PointXYZ>);
+    transformPointCloud (cloud_source, *frame, Eigen::Matrix4f (pose.inverse ()));
+    EXPECT_TRUE (s2m.registerCloud (frame));
+
+    const Eigen::Matrix4f error = s2m.getAbsoluteTransform ().inverse () * pose;
+    EXPECT_LT ((error.block<3, 3> (0, 0) - Eigen::Matrix3f::Identity ()).norm (), 1e-2);
+    EXPECT_LT ((error.block<3, 1> (0, 3).norm ()), 1e-3);
+    if (i > 0)
+    {
+      EXPECT_LT ((s2m.getDeltaTransform () - step).norm (), 2e-2);
+
+      // The map is the target search method of the registration, and is never replaced
+      if (!map_search)
+        map_search = icp->getSearchMethodTarget ();
+      EXPECT_EQ (icp->getSearchMethodTarget (), map_search);
+      EXPECT_EQ (icp->getInputTarget (), s2m.getMap ()->getInputCloud ());
+    }
+    pose = pose * step;
+  }
+
+  // Downsampling keeps the map from growing with each frame of the same scene
+  EXPECT_LT (s2m.getMapSize (), 2 * cloud_source.size ());
+
+  // A local map smaller than the scene drops the points away from the sensor
+  const std::size_t full_map_size = s2m.getMapSize ();
+  s2m.setLocalMapSize (0.1f);
+  PointCloud<PointXYZ>::Ptr frame (new PointCloud<PointXYZ>);
+  transformPointCloud (cloud_source, *frame, Eigen::Matrix4f (pose.inverse ()));
+  EXPECT_TRUE (s2m.registerCloud (frame));
+  EXPECT_LT (s2m.getMapSize (), full_map_size);
+
+  // Reset starts a new map
+  s2m.reset ();
+  EXPECT_EQ (s2m.getMapSize (), 0);
+  EXPECT_TRUE (s2m.registerCloud (frame));
+  EXPECT_EQ (s2m.getAbsoluteTransform (), Eigen::Matrix4f::Identity ());
+}
+
 TEST (PCL, IterativeClosestPointWithNormals)
 {
   IterativeClosestPointWithNormals<PointNormal, PointNormal, float> reg_float;
@@ -364,6 +479,48 @@ TEST (PCL, JointIterativeClosestPoint)
   }
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, JointIterativeClosestPointParallel)
+{
+  JointIterativeClosestPoint<PointXYZ, PointXYZ> reg;
+  reg.setMaximumIterations (50);
+  reg.setTransformationEpsilon (1e-8);
+  reg.setMaxCorrespondenceDistance (0.25);
+  EXPECT_EQ (reg.getNumberOfThreads (), 1u);
+
+  Eigen::Affine3f delta_transform;
+  sampleRandomTransform (delta_transform, 0., 0.10);
+  for (std::size_t i = 0; i < 6; i++)
+  {
+    Eigen::Affine3f net_transform;
+    sampleRandomTransform (net_transform, 2*M_PI, 10.);
+    PointCloud<PointXYZ>::Ptr source_trans (new PointCloud<PointXYZ>);
+    PointCloud<PointXYZ>::Ptr target_trans (new PointCloud<PointXYZ>);
+    pcl::transformPointCloud (cloud_source, *source_trans, delta_transform.inverse () * net_transform);
+    pcl::transformPointCloud (cloud_source, *target_trans, net_transform);
+    reg.addInputSource (source_trans);
+    reg.addInputTarget (target_trans);
+  }
+
+  // The pairs are gathered in order, so the result must not depend on the threads
+  reg.align (cloud_reg);
+  const Eigen::Matrix4f serial = reg.getFinalTransformation ();
+  for (const unsigned int nr_threads : {4u, 0u})
+  {
+    SCOPED_TRACE (nr_threads);
+    reg.setNumberOfThreads (nr_threads);
+    EXPECT_EQ (reg.getNumberOfThreads (), nr_threads);
+    reg.align (cloud_reg);
+    const Eigen::Matrix4f parallel = reg.getFinalTransformation ();
+    for (int y = 0; y < 4; y++)
+      for (int x = 0; x < 4; x++)
+      {
+        EXPECT_FLOAT_EQ (parallel (y, x), serial (y, x));
+        EXPECT_NEAR (parallel (y, x), delta_transform (y, x), 1E-2);
+      }
+  }
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 TEST (PCL, IterativeClosestPointNonLinear)
 {
@@ -585,6 +742,42 @@ TEST (PCL, GeneralizedIterativeClosestPoint)
   EXPECT_LT (reg.getFitnessScore (), 0.0001);
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, GeneralizedIterativeClosestPointMultiThreaded)
+{
+  using PointT = PointXYZ;
+  PointCloud<PointT>::Ptr src (new PointCloud<PointT>);
+  copyPointCloud (cloud_source, *src);
+  PointCloud<PointT>::Ptr tgt (new PointCloud<PointT>);
+  copyPointCloud (cloud_target, *tgt);
+  PointCloud<PointT> output, output_omp;
+
+  GeneralizedIterativeClosestPoint<PointT, PointT> reg;
+  reg.setInputSource (src);
+  reg.setInputTarget (tgt);
+  reg.setMaximumIterations (50);
+  reg.setTransformationEpsilon (1e-8);
+  reg.align (output);
+
+  GeneralizedIterativeClosestPoint<PointT, PointT> reg_omp;
+  reg_omp.setNumberOfThreads (4);
+  reg_omp.setInputSource (src);
+  reg_omp.setInputTarget (tgt);
+  reg_omp.setMaximumIterations (50);
+  reg_omp.setTransformationEpsilon (1e-8);
+  reg_omp.align (output_omp);
+
+  // The reductions have a fixed order, so the result must not depend on the number of threads
+  EXPECT_EQ (reg.getFinalTransformation (), reg_omp.getFinalTransformation ());
+  EXPECT_EQ (output.size (), output_omp.size ());
+  EXPECT_LT (reg_omp.getFitnessScore (), 0.0001);
+
+  // Aligning again against the same target reuses the target covariances
+  reg_omp.setInputSource (src);
+  reg_omp.align (output_omp);
+  EXPECT_EQ (reg.getFinalTransformation (), reg_omp.getFinalTransformation ());
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 TEST (PCL, GeneralizedIterativeClosestPoint6D)
 {
@@ -639,6 +832,18 @@ TEST (PCL, GeneralizedIterativeClosestPoint6D)
     EXPECT_EQ (output.size (), src->size ());
     EXPECT_LT (reg.getFitnessScore (), 0.003);
   }
+
+  // The 6D correspondences are gathered in index order, so the threaded search must
+  // reproduce the serial result
+  const Eigen::Matrix4f serial = reg.getFinalTransformation ();
+  reg.setNumberOfThreads (4);
+  reg.setInputSource (src);
+  reg.align (output);
+  EXPECT_EQ (output.size (), src->size ());
+  EXPECT_LT (reg.getFitnessScore (), 0.003);
+  for (int y = 0; y < 4; y++)
+    for (int x = 0; x < 4; x++)
+      EXPECT_NEAR (reg.getFinalTransformation () (y, x), serial (y, x), 1e-5);
 }
 
 
@@ -235,6 +235,107 @@ TEST (PCL, SampleConsensusPrerejective)
   }
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+void
+computeAlignmentInput (PointCloud<PointXYZ>::Ptr& cloud_source_ptr, PointCloud<PointXYZ>::Ptr& cloud_target_ptr,
+                       PointCloud<FPFHSignature33>::Ptr& features_source, PointCloud<FPFHSignature33>::Ptr& features_target,
+                       double normal_radius)
+{
+  // Transform the source cloud by a large amount
+  Eigen::Vector3f initial_offset (100, 0, 0);
+  float angle = static_cast<float> (M_PI) / 2.0f;
+  Eigen::Quaternionf initial_rotation (std::cos (angle / 2), 0, 0, sin (angle / 2));
+  cloud_source_ptr.reset (new PointCloud<PointXYZ>);
+  transformPointCloud (cloud_source, *cloud_source_ptr, initial_offset, initial_rotation);
+  cloud_target_ptr = cloud_target.makeShared ();
+
+  search::KdTree<PointXYZ>::Ptr tree (new search::KdTree<PointXYZ>);
+  NormalEstimation<PointXYZ, Normal> norm_est;
+  norm_est.setSearchMethod (tree);
+  norm_est.setRadiusSearch (normal_radius);
+  PointCloud<Normal> normals;
+
+  FPFHEstimation<PointXYZ, Normal, FPFHSignature33> fpfh_est;
+  fpfh_est.setSearchMethod (tree);
+  fpfh_est.setRadiusSearch (0.05);
+  features_source.reset (new PointCloud<FPFHSignature33>);
+  features_target.reset (new PointCloud<FPFHSignature33>);
+
+  norm_est.setInputCloud (cloud_source_ptr);
+  norm_est.compute (normals);
+  fpfh_est.setInputCloud (cloud_source_ptr);
+  fpfh_est.setInputNormals (normals.makeShared ());
+  fpfh_est.compute (*features_source);
+
+  norm_est.setInputCloud (cloud_target_ptr);
+  norm_est.compute (normals);
+  fpfh_est.setInputCloud (cloud_target_ptr);
+  fpfh_est.setInputNormals (normals.makeShared ());
+  fpfh_est.compute (*features_target);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, SampleConsensusInitialAlignmentMultiThreaded)
+{
+  PointCloud<PointXYZ>::Ptr cloud_source_ptr, cloud_target_ptr;
+  PointCloud<FPFHSignature33>::Ptr features_source, features_target;
+  computeAlignmentInput (cloud_source_ptr, cloud_target_ptr, features_source, features_target, 0.05);
+
+  SampleConsensusInitialAlignment<PointXYZ, PointXYZ, FPFHSignature33> reg;
+  reg.setMinSampleDistance (0.05f);
+  reg.setMaxCorrespondenceDistance (0.1);
+  reg.setMaximumIterations (1000);
+  reg.setNumberOfThreads (4);
+  reg.setInputSource (cloud_source_ptr);
+  reg.setInputTarget (cloud_target_ptr);
+  reg.setSourceFeatures (features_source);
+  reg.setTargetFeatures (features_target);
+
+  srand (12345);
+  reg.align (cloud_reg);
+  EXPECT_EQ (cloud_reg.size (), cloud_source.size ());
+  EXPECT_LT (reg.getFitnessScore (), 0.0005);
+  const Eigen::Matrix4f transformation = reg.getFinalTransformation ();
+
+  // The per-thread random streams are seeded from rand, so the same seed gives the same result
+  srand (12345);
+  reg.align (cloud_reg);
+  EXPECT_EQ (transformation, reg.getFinalTransformation ());
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, SampleConsensusPrerejectiveMultiThreaded)
+{
+  PointCloud<PointXYZ>::Ptr cloud_source_ptr, cloud_target_ptr;
+  PointCloud<FPFHSignature33>::Ptr features_source, features_target;
+  computeAlignmentInput (cloud_source_ptr, cloud_target_ptr, features_source, features_target, 0.005);
+
+  SampleConsensusPrerejective<PointXYZ, PointXYZ, FPFHSignature33> reg;
+  reg.setMaxCorrespondenceDistance (0.1);
+  reg.setMaximumIterations (5000);
+  reg.setSimilarityThreshold (0.6f);
+  reg.setCorrespondenceRandomness (2);
+  reg.setInlierFraction (0.25f);
+  reg.setNumberOfThreads (4);
+  reg.setInputSource (cloud_source_ptr);
+  reg.setInputTarget (cloud_target_ptr);
+  reg.setSourceFeatures (features_source);
+  reg.setTargetFeatures (features_target);
+
+  srand (12345);
+  reg.align (cloud_reg);
+  EXPECT_TRUE (reg.hasConverged ());
+  EXPECT_EQ (cloud_reg.size (), cloud_source.size ());
+  float inlier_fraction = static_cast<float> (reg.getInliers ().size ()) / static_cast<float> (cloud_source.size ());
+  EXPECT_GT (inlier_fraction, 0.95f);
+  const Eigen::Matrix4f transformation = reg.getFinalTransformation ();
+
+  srand (12345);
+  reg.align (cloud_reg);
+  EXPECT_EQ (transformation, reg.getFinalTransformation ());
+  EXPECT_EQ (inlier_fraction, static_cast<float> (reg.getInliers ().size ()) / static_cast<float> (cloud_source.size ()));
+}
+
 int
 main (int argc, char** argv)
 {
@@ -40,15 +40,18 @@
 
 #include <pcl/sample_consensus/msac.h>
 #include <pcl/sample_consensus/lmeds.h>
+#include <pcl/sample_consensus/prosac.h>
 #include <pcl/sample_consensus/rmsac.h>
 #include <pcl/sample_consensus/mlesac.h>
 #include <pcl/sample_consensus/ransac.h>
 #include <pcl/sample_consensus/rransac.h>
+#include <pcl/sample_consensus/sac_model_plane.h>
 #include <pcl/sample_consensus/sac_model_sphere.h>
 
 #include <chrono>
 #include <condition_variable>
 #include <mutex>
+#include <random>
 #include <thread>
 
 using namespace pcl;
@@ -149,6 +152,56 @@ TYPED_TEST(SacTest, InfiniteLoop)
   pcl::console::setVerbosityLevel(previous_verbosity_level); // reset verbosity level
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Test if the estimators that score hypotheses concurrently find the same model as the serial ones.
+template <typename SacT>
+class SacParallelTest : public ::testing::Test {};
+
+using sacParallelTypes = ::testing::Types<
+  LeastMedianSquares<PointXYZ>,
+  MEstimatorSampleConsensus<PointXYZ>,
+  MaximumLikelihoodSampleConsensus<PointXYZ>,
+  ProgressiveSampleConsensus<PointXYZ>
+>;
+TYPED_TEST_SUITE(SacParallelTest, sacParallelTypes);
+
+TYPED_TEST(SacParallelTest, ParallelMatchesSerial)
+{
+  // A noisy plane z = 0.1 x - 0.2 y + 1 with 30% outliers
+  PointCloud<PointXYZ>::Ptr cloud (new PointCloud<PointXYZ>);
+  std::mt19937 rng (42);
+  std::uniform_real_distribution<float> coordinate (-1.f, 1.f);
+  std::normal_distribution<float> noise (0.f, 0.005f);
+  for (int i = 0; i < 2000; ++i)
+  {
+    const float x = coordinate (rng), y = coordinate (rng);
+    if (i % 10 < 3)
+      cloud->emplace_back (x, y, 1.f + coordinate (rng));
+    else
+      cloud->emplace_back (x, y, 0.1f * x - 0.2f * y + 1.f + noise (rng));
+  }
+
+  const auto compute = [&cloud] (int nr_threads, Eigen::VectorXf &coefficients, Indices &inliers)
+  {
+    SampleConsensusModelPlane<PointXYZ>::Ptr model (new SampleConsensusModelPlane<PointXYZ> (cloud));
+    TypeParam sac (model, 0.02);
+    sac.setMaxIterations (200);
+    sac.setNumberOfThreads (nr_threads);
+    ASSERT_TRUE (sac.computeModel ());
+    sac.getModelCoefficients (coefficients);
+    sac.getInliers (inliers);
+  };
+
+  Eigen::VectorXf coefficients_serial, coefficients_parallel;
+  Indices inliers_serial, inliers_parallel;
+  compute (-1, coefficients_serial, inliers_serial);
+  compute (4, coefficients_parallel, inliers_parallel);
+
+  EXPECT_EQ (coefficients_serial, coefficients_parallel);
+  EXPECT_EQ (inliers_serial, inliers_parallel);
+  EXPECT_LT (1200u, inliers_parallel.size ());
+}
+
 int
 main (int argc, char** argv)
 {
@@ -148,6 +148,56 @@ TEST (SampleConsensusModelPlane, RANSAC)
   verifyPlaneSac (model, sac);
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Plane model that records how the hypotheses are handed to it
+class SampleConsensusModelPlaneBatchCounter : public SampleConsensusModelPlane<PointXYZ>
+{
+  public:
+    using SampleConsensusModelPlane<PointXYZ>::SampleConsensusModelPlane;
+
+    void
+    countWithinDistanceBatch (const std::vector<Eigen::VectorXf> &hypotheses, const double threshold,
+                              std::vector<std::size_t> &counts) const override
+    {
+      ++nr_batches;
+      max_batch = std::max (max_batch, hypotheses.size ());
+      SampleConsensusModelPlane<PointXYZ>::countWithinDistanceBatch (hypotheses, threshold, counts);
+    }
+
+    mutable std::size_t nr_batches = 0;
+    mutable std::size_t max_batch = 0;
+};
+
+TEST (SampleConsensusModelPlane, RANSACBatched)
+{
+  srand (0);
+
+  // Reference run without batching
+  SampleConsensusModelPlanePtr reference_model (new SampleConsensusModelPlane<PointXYZ> (cloud_));
+  RandomSampleConsensus<PointXYZ> reference_sac (reference_model, 0.03);
+  ASSERT_TRUE (reference_sac.computeModel ());
+
+  shared_ptr<SampleConsensusModelPlaneBatchCounter> model (new SampleConsensusModelPlaneBatchCounter (cloud_));
+  RandomSampleConsensus<PointXYZ> sac (model, 0.03);
+  sac.setHypothesesBatchSize (16);
+  EXPECT_EQ (16, sac.getHypothesesBatchSize ());
+
+  verifyPlaneSac (model, sac);
+  EXPECT_LT (0, model->nr_batches);
+  EXPECT_GE (16, model->max_batch);
+
+  // The same hypotheses are drawn and evaluated in the same order
+  pcl::Indices sample, reference_sample;
+  sac.getModel (sample);
+  reference_sac.getModel (reference_sample);
+  EXPECT_EQ (reference_sample, sample);
+
+  pcl::Indices inliers, reference_inliers;
+  sac.getInliers (inliers);
+  reference_sac.getInliers (reference_inliers);
+  EXPECT_EQ (reference_inliers, inliers);
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 TEST (SampleConsensusModelPlane, LMedS)
 {
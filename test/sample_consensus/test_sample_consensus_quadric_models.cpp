@@ -38,6 +38,8 @@
 
 #include <pcl/test/gtest.h>
 
+#include <pcl/common/cpu_dispatch.h>
+
 #include <pcl/sample_consensus/ransac.h>
 #include <pcl/sample_consensus/sac_model_sphere.h>
 #include <pcl/sample_consensus/sac_model_cone.h>
@@ -168,6 +170,70 @@ TEST (SampleConsensusModelSphere, SIMD_countWithinDistance) // Test if all count
   }
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (SampleConsensusModelSphere, SIMD_countWithinDistanceLevels) // Test if all SIMD levels count the same inliers
+{
+  const auto seed = static_cast<unsigned> (std::time (nullptr));
+  srand (seed);
+  const pcl::SIMDLevel original = pcl::getSIMDLevel ();
+  for (size_t i=0; i<100; i++) // Run as often as you like
+  {
+    // Generate a cloud with 1000 random points
+    PointCloud<PointXYZ> cloud;
+    pcl::Indices indices;
+    cloud.resize (1000);
+    for (std::size_t idx = 0; idx < cloud.size (); ++idx)
+    {
+      cloud[idx].x = 2.0 * static_cast<float> (rand ()) / RAND_MAX - 1.0;
+      cloud[idx].y = 2.0 * static_cast<float> (rand ()) / RAND_MAX - 1.0;
+      cloud[idx].z = 2.0 * static_cast<float> (rand ()) / RAND_MAX - 1.0;
+      if (rand () % 3 != 0)
+      {
+        indices.push_back (static_cast<int> (idx));
+      }
+    }
+    SampleConsensusModelSphere<PointXYZ> model (cloud.makeShared (), indices, true);
+
+    // Generate random sphere model parameters
+    Eigen::VectorXf model_coefficients(4);
+    model_coefficients << 2.0 * static_cast<float> (rand ()) / RAND_MAX - 1.0,
+                          2.0 * static_cast<float> (rand ()) / RAND_MAX - 1.0,
+                          2.0 * static_cast<float> (rand ()) / RAND_MAX - 1.0,
+                          0.15 * static_cast<float> (rand ()) / RAND_MAX; // center and radius
+
+    const double threshold = 0.15 * static_cast<double> (rand ()) / RAND_MAX; // threshold in [0; 0.15]
+
+    // Scalar reference, skipping points within float rounding of the shell boundaries
+    const Eigen::Vector3d center = model_coefficients.head<3> ().cast<double> ();
+    std::size_t expected = 0, ambiguous = 0;
+    for (const auto &idx : indices)
+    {
+      const double distance = std::abs ((cloud[idx].getVector3fMap ().cast<double> () - center).norm () - model_coefficients[3]);
+      if (std::abs (distance - threshold) < 1e-5)
+        ++ambiguous;
+      else if (distance < threshold)
+        ++expected;
+    }
+    PCL_DEBUG ("seed=%lu, i=%lu, model=(%f, %f, %f, %f), threshold=%f, expected=%lu\n", seed, i,
+               model_coefficients(0), model_coefficients(1), model_coefficients(2), model_coefficients(3), threshold, expected);
+
+    for (int level = 0; level <= static_cast<int> (pcl::getSupportedSIMDLevel ()); ++level)
+    {
+      pcl::setSIMDLevel (static_cast<pcl::SIMDLevel> (level));
+      SCOPED_TRACE (pcl::getSIMDLevelName (pcl::getSIMDLevel ()));
+
+      const auto count = model.countWithinDistance (model_coefficients, threshold);
+      EXPECT_LE (expected, count);
+      EXPECT_GE (expected + ambiguous, count);
+
+      pcl::Indices inliers;
+      model.selectWithinDistance (model_coefficients, threshold, inliers);
+      EXPECT_EQ (inliers.size (), count);
+    }
+  }
+  pcl::setSIMDLevel (original);
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 TEST (SampleConsensusModelNormalSphere, RANSAC)
 {
@@ -458,6 +524,57 @@ TEST (SampleConsensusModelCylinder, RANSAC)
   EXPECT_NEAR (0.5, coeff_refined[6], 1e-3);
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (SampleConsensusModelCylinder, SIMD_getDistancesToModel) // Test if all SIMD levels return the same distances
+{
+  srand (0);
+
+  // 1001 points, so that every lane width has to handle a partial tail
+  PointCloud<PointXYZ> cloud;
+  PointCloud<Normal> normals;
+  cloud.resize (1001); normals.resize (1001);
+  for (std::size_t idx = 0; idx < cloud.size (); ++idx)
+  {
+    cloud[idx].x = 2.0f * static_cast<float> (rand ()) / RAND_MAX - 1.0f;
+    cloud[idx].y = 2.0f * static_cast<float> (rand ()) / RAND_MAX - 1.0f;
+    cloud[idx].z = 2.0f * static_cast<float> (rand ()) / RAND_MAX - 1.0f;
+    normals[idx].normal_x = 2.0f * static_cast<float> (rand ()) / RAND_MAX - 1.0f;
+    normals[idx].normal_y = 2.0f * static_cast<float> (rand ()) / RAND_MAX - 1.0f;
+    normals[idx].normal_z = 2.0f * static_cast<float> (rand ()) / RAND_MAX - 1.0f;
+  }
+
+  SampleConsensusModelCylinder<PointXYZ, Normal> model (cloud.makeShared ());
+  model.setInputNormals (normals.makeShared ());
+  model.setNormalDistanceWeight (0.1);
+
+  Eigen::VectorXf model_coefficients (7);
+  model_coefficients << 0.1f, -0.2f, 0.3f, 0.3f, 0.4f, 0.5f, 0.5f;
+  const double threshold = 0.05;
+
+  const pcl::SIMDLevel original = pcl::getSIMDLevel ();
+  pcl::setSIMDLevel (pcl::SIMDLevel::NONE);
+  std::vector<double> reference;
+  model.getDistancesToModel (model_coefficients, reference);
+  ASSERT_EQ (cloud.size (), reference.size ());
+
+  for (int level = 0; level <= static_cast<int> (pcl::getSupportedSIMDLevel ()); ++level)
+  {
+    pcl::setSIMDLevel (static_cast<pcl::SIMDLevel> (level));
+    SCOPED_TRACE (pcl::getSIMDLevelName (pcl::getSIMDLevel ()));
+
+    std::vector<double> distances;
+    model.getDistancesToModel (model_coefficients, distances);
+    ASSERT_EQ (reference.size (), distances.size ());
+    for (std::size_t i = 0; i < distances.size (); ++i)
+      EXPECT_NEAR (reference[i], distances[i], 1e-5);
+
+    pcl::Indices inliers;
+    model.selectWithinDistance (model_coefficients, threshold, inliers);
+    EXPECT_EQ (inliers.size (), model.countWithinDistance (model_coefficients, threshold));
+  }
+  pcl::setSIMDLevel (original);
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 TEST (SampleConsensusModelCircle2D, RANSAC)
 {
@@ -650,6 +767,197 @@ TEST (SampleConsensusModelCircle3D, RANSAC)
   EXPECT_NEAR ( 0.0, coeff_refined[6], 1e-3);
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (SampleConsensusModelCircle3D, SIMD_getDistancesToModel) // Test if all SIMD levels return the same distances
+{
+  srand (0);
+
+  PointCloud<PointXYZ> cloud;
+  cloud.resize (1001);
+  for (std::size_t idx = 0; idx < cloud.size (); ++idx)
+  {
+    cloud[idx].x = 2.0f * static_cast<float> (rand ()) / RAND_MAX - 1.0f;
+    cloud[idx].y = 2.0f * static_cast<float> (rand ()) / RAND_MAX - 1.0f;
+    cloud[idx].z = 2.0f * static_cast<float> (rand ()) / RAND_MAX - 1.0f;
+  }
+
+  SampleConsensusModelCircle3D<PointXYZ> model (cloud.makeShared ());
+
+  // Circle of radius 0.5 around (0.1, -0.1, 0.2), tilted normal
+  Eigen::VectorXf model_coefficients (7);
+  model_coefficients << 0.1f, -0.1f, 0.2f, 0.5f, 0.0f, 0.6f, 0.8f;
+  const double threshold = 0.1;
+
+  // Scalar reference: distance to the closest point on the circle
+  const Eigen::Vector3d C = model_coefficients.head<3> ().cast<double> ();
+  const Eigen::Vector3d N = model_coefficients.tail<3> ().cast<double> ();
+  const double r = model_coefficients[3];
+  std::size_t expected_inliers = 0;
+
+  const pcl::SIMDLevel original = pcl::getSIMDLevel ();
+  for (int level = 0; level <= static_cast<int> (pcl::getSupportedSIMDLevel ()); ++level)
+  {
+    pcl::setSIMDLevel (static_cast<pcl::SIMDLevel> (level));
+    SCOPED_TRACE (pcl::getSIMDLevelName (pcl::getSIMDLevel ()));
+
+    std::vector<double> distances;
+    model.getDistancesToModel (model_coefficients, distances);
+    ASSERT_EQ (cloud.size (), distances.size ());
+    expected_inliers = 0;
+    for (std::size_t i = 0; i < distances.size (); ++i)
+    {
+      const Eigen::Vector3d P = cloud[i].getVector3fMap ().cast<double> ();
+      const Eigen::Vector3d projected = P - N * (N.dot (P - C) / N.dot (N));
+      const Eigen::Vector3d K = C + r * (projected - C).normalized ();
+      const double expected = (P - K).norm ();
+      EXPECT_NEAR (expected, distances[i], 1e-5);
+      if (expected < threshold)
+        ++expected_inliers;
+    }
+
+    pcl::Indices inliers;
+    model.selectWithinDistance (model_coefficients, threshold, inliers);
+    EXPECT_EQ (expected_inliers, inliers.size ());
+    EXPECT_EQ (expected_inliers, model.countWithinDistance (model_coefficients, threshold));
+  }
+  pcl::setSIMDLevel (original);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Refines a perturbed model on points of the true one, with a single and with several threads. The inlier sets
+// span several blocks of the solver, so the residuals are evaluated in parallel.
+template <typename ModelT> void
+optimizeWithThreads (ModelT &model, const Eigen::VectorXf &initial, Eigen::VectorXf &refined)
+{
+  pcl::Indices inliers (model.getInputCloud ()->size ());
+  for (std::size_t i = 0; i < inliers.size (); ++i)
+    inliers[i] = static_cast<index_t> (i);
+
+  model.setNumberOfThreads (1);
+  model.optimizeModelCoefficients (inliers, initial, refined);
+
+  Eigen::VectorXf refined_parallel;
+  model.setNumberOfThreads (4);
+  model.optimizeModelCoefficients (inliers, initial, refined_parallel);
+  ASSERT_EQ (refined.size (), refined_parallel.size ());
+  for (Eigen::Index i = 0; i < refined.size (); ++i)
+    EXPECT_EQ (refined[i], refined_parallel[i]);
+
+  // 0 takes the threads the budget allows
+  model.setNumberOfThreads (0);
+  model.optimizeModelCoefficients (inliers, initial, refined_parallel);
+  ASSERT_EQ (refined.size (), refined_parallel.size ());
+  for (Eigen::Index i = 0; i < refined.size (); ++i)
+    EXPECT_EQ (refined[i], refined_parallel[i]);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (SampleConsensusModelSphere, OptimizeModelCoefficients)
+{
+  srand (0);
+  PointCloud<PointXYZ> cloud;
+  cloud.resize (2000);
+  for (auto &point : cloud)
+  {
+    const Eigen::Vector3f dir = Eigen::Vector3f::Random ().normalized ();
+    point.getVector3fMap () = Eigen::Vector3f (1.0f, -2.0f, 0.5f) + 0.75f * dir;
+  }
+  SampleConsensusModelSphere<PointXYZ> model (cloud.makeShared ());
+
+  Eigen::VectorXf initial (4), refined;
+  initial << 1.05f, -1.97f, 0.46f, 0.8f;
+  optimizeWithThreads (model, initial, refined);
+  ASSERT_EQ (4, refined.size ());
+  EXPECT_NEAR ( 1.0f, refined[0], 1e-4);
+  EXPECT_NEAR (-2.0f, refined[1], 1e-4);
+  EXPECT_NEAR ( 0.5f, refined[2], 1e-4);
+  EXPECT_NEAR (0.75f, refined[3], 1e-4);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (SampleConsensusModelCylinder, OptimizeModelCoefficients)
+{
+  srand (0);
+  PointCloud<PointXYZ> cloud;
+  cloud.resize (2000);
+  for (auto &point : cloud)
+  {
+    const float angle = static_cast<float> (M_PI) * Eigen::internal::random<float> (-1.0f, 1.0f);
+    point.getVector3fMap () << 1.0f + 0.5f * std::cos (angle), 2.0f + 0.5f * std::sin (angle),
+                               Eigen::internal::random<float> (-1.0f, 1.0f);
+  }
+  SampleConsensusModelCylinder<PointXYZ, Normal> model (cloud.makeShared ());
+
+  Eigen::VectorXf initial (7), refined;
+  initial << 1.03f, 1.98f, 0.0f, 0.05f, -0.03f, 1.0f, 0.45f;
+  optimizeWithThreads (model, initial, refined);
+  ASSERT_EQ (7, refined.size ());
+  // The axis point can move along the axis
+  const Eigen::Vector3f line_pt = refined.head<3> ();
+  const Eigen::Vector3f line_dir = refined.segment<3> (3);
+  EXPECT_NEAR (1.0f, line_pt[0] - line_pt[2] * line_dir[0] / line_dir[2], 1e-4);
+  EXPECT_NEAR (2.0f, line_pt[1] - line_pt[2] * line_dir[1] / line_dir[2], 1e-4);
+  EXPECT_NEAR (1.0f, std::abs (line_dir[2]), 1e-4);
+  EXPECT_NEAR (0.5f, std::abs (refined[6]), 1e-4);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (SampleConsensusModelCone, OptimizeModelCoefficients)
+{
+  srand (0);
+  const float opening_angle = 0.3f;
+  PointCloud<PointXYZ> cloud;
+  cloud.resize (2000);
+  for (auto &point : cloud)
+  {
+    const float angle = static_cast<float> (M_PI) * Eigen::internal::random<float> (-1.0f, 1.0f);
+    const float height = Eigen::internal::random<float> (0.5f, 2.0f);
+    const float radius = height * std::tan (opening_angle);
+    point.getVector3fMap () << radius * std::cos (angle), radius * std::sin (angle), height;
+  }
+  SampleConsensusModelCone<PointXYZ, Normal> model (cloud.makeShared ());
+
+  Eigen::VectorXf initial (7), refined;
+  initial << 0.03f, -0.02f, 0.05f, 0.02f, 0.03f, 1.0f, 0.33f;
+  optimizeWithThreads (model, initial, refined);
+  ASSERT_EQ (7, refined.size ());
+  EXPECT_NEAR (0.0f, refined[0], 1e-4);
+  EXPECT_NEAR (0.0f, refined[1], 1e-4);
+  EXPECT_NEAR (0.0f, refined[2], 1e-4);
+  EXPECT_NEAR (1.0f, std::abs (refined[5]), 1e-4);
+  EXPECT_NEAR (opening_angle, std::abs (refined[6]), 1e-4);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (SampleConsensusModelCircle3D, OptimizeModelCoefficients)
+{
+  srand (0);
+  const Eigen::Vector3f center (1.0f, 5.0f, -3.0f);
+  const Eigen::Vector3f normal (0.0f, 0.6f, 0.8f);
+  const Eigen::Vector3f u = normal.unitOrthogonal ();
+  const Eigen::Vector3f v = normal.cross (u);
+  PointCloud<PointXYZ> cloud;
+  cloud.resize (2000);
+  for (auto &point : cloud)
+  {
+    const float angle = static_cast<float> (M_PI) * Eigen::internal::random<float> (-1.0f, 1.0f);
+    point.getVector3fMap () = center + 0.5f * (std::cos (angle) * u + std::sin (angle) * v);
+  }
+  SampleConsensusModelCircle3D<PointXYZ> model (cloud.makeShared ());
+
+  Eigen::VectorXf initial (7), refined;
+  initial << 1.02f, 4.97f, -2.98f, 0.55f, 0.05f, 0.55f, 0.85f;
+  optimizeWithThreads (model, initial, refined);
+  ASSERT_EQ (7, refined.size ());
+  EXPECT_NEAR ( 1.0f, refined[0], 1e-4);
+  EXPECT_NEAR ( 5.0f, refined[1], 1e-4);
+  EXPECT_NEAR (-3.0f, refined[2], 1e-4);
+  EXPECT_NEAR ( 0.5f, refined[3], 1e-4);
+  EXPECT_NEAR ( 0.0f, refined[4], 1e-4);
+  EXPECT_NEAR ( 0.6f, refined[5], 1e-4);
+  EXPECT_NEAR ( 0.8f, refined[6], 1e-4);
+}
+
 int
 main (int argc, char** argv)
 {
@@ -0,0 +1,164 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ */
+#include <pcl/test/gtest.h>
+#include <pcl/point_cloud.h>
+#include <pcl/point_types.h>
+#include <pcl/search/brute_force.h>
+#include <pcl/search/incremental_kdtree.h> // for pcl::search::IncrementalKdTree
+
+#include <algorithm>
+#include <random>
+#include <set>
+#include <tuple>
+
+using namespace pcl;
+
+std::mt19937 rng (42);
+std::uniform_real_distribution<float> rand_float (0.0f, 1.0f);
+
+PointCloud<PointXYZ>::Ptr
+createRandomCloud (std::size_t size)
+{
+  PointCloud<PointXYZ>::Ptr cloud (new PointCloud<PointXYZ>);
+  for (std::size_t i = 0; i < size; ++i)
+    cloud->emplace_back (rand_float (rng), rand_float (rng), rand_float (rng));
+  return (cloud);
+}
+
+// Compare the tree against a brute force search over the points it currently holds
+void
+compareWithBruteForce (const search::IncrementalKdTree<PointXYZ> &tree, std::size_t nr_queries)
+{
+  IndicesPtr valid (new Indices);
+  tree.boxSearch (Eigen::Vector3f::Constant (-10.0f), Eigen::Vector3f::Constant (10.0f), *valid);
+  ASSERT_EQ (tree.size (), valid->size ());
+
+  search::BruteForce<PointXYZ> brute_force (true);
+  brute_force.setInputCloud (tree.getInputCloud (), valid);
+
+  Indices tree_indices, brute_force_indices;
+  std::vector<float> tree_distances, brute_force_distances;
+  for (std::size_t i = 0; i < nr_queries; ++i)
+  {
+    const PointXYZ query (rand_float (rng), rand_float (rng), rand_float (rng));
+
+    tree.nearestKSearch (query, 10, tree_indices, tree_distances);
+    brute_force.nearestKSearch (query, 10, brute_force_indices, brute_force_distances);
+    ASSERT_EQ (brute_force_distances.size (), tree_distances.size ());
+    for (std::size_t j = 0; j < tree_distances.size (); ++j)
+      EXPECT_FLOAT_EQ (brute_force_distances[j], tree_distances[j]);
+
+    tree.radiusSearch (query, 0.1, tree_indices, tree_distances);
+    brute_force.radiusSearch (query, 0.1, brute_force_indices, brute_force_distances);
+    std::sort (tree_indices.begin (), tree_indices.end ());
+    std::sort (brute_force_indices.begin (), brute_force_indices.end ());
+    EXPECT_EQ (brute_force_indices, tree_indices);
+  }
+}
+
+TEST (PCL, IncrementalKdTree_AddDelete)
+{
+  search::IncrementalKdTree<PointXYZ> tree;
+  tree.setInputCloud (createRandomCloud (2000));
+  EXPECT_EQ (2000, tree.size ());
+  compareWithBruteForce (tree, 100);
+
+  for (int iteration = 0; iteration < 5; ++iteration)
+  {
+    EXPECT_EQ (500, tree.addPoints (*createRandomCloud (500)));
+
+    const Eigen::Vector3f min_pt (0.1f * iteration, 0.2f, 0.0f);
+    const Eigen::Vector3f max_pt (0.1f * iteration + 0.3f, 0.6f, 1.0f);
+    Indices in_box;
+    tree.boxSearch (min_pt, max_pt, in_box);
+    const std::size_t size_before = tree.size ();
+    EXPECT_EQ (in_box.size (), tree.deletePointsInBox (min_pt, max_pt));
+    EXPECT_EQ (size_before - in_box.size (), tree.size ());
+    EXPECT_EQ (0, tree.boxSearch (min_pt, max_pt, in_box));
+
+    compareWithBruteForce (tree, 100);
+  }
+
+  // Deleting everything leaves an empty, but usable tree
+  tree.deletePointsInBox (Eigen::Vector3f::Constant (-1.0f), Eigen::Vector3f::Constant (2.0f));
+  EXPECT_EQ (0, tree.size ());
+  Indices indices;
+  std::vector<float> distances;
+  EXPECT_EQ (0, tree.nearestKSearch (PointXYZ (0.5f, 0.5f, 0.5f), 5, indices, distances));
+  tree.addPoints (*createRandomCloud (100));
+  EXPECT_EQ (100, tree.size ());
+  compareWithBruteForce (tree, 20);
+}
+
+TEST (PCL, IncrementalKdTree_DownsampleOnInsert)
+{
+  const float leaf_size = 0.1f;
+  search::IncrementalKdTree<PointXYZ> tree;
+  tree.setDownsampleOnInsert (true);
+  tree.setDownsampleLeafSize (leaf_size);
+  tree.setInputCloud (PointCloud<PointXYZ>::Ptr (new PointCloud<PointXYZ>));
+
+  for (int iteration = 0; iteration < 3; ++iteration)
+    tree.addPoints (*createRandomCloud (5000));
+
+  // Every voxel holds at most one point
+  Indices valid;
+  tree.boxSearch (Eigen::Vector3f::Constant (-1.0f), Eigen::Vector3f::Constant (2.0f), valid);
+  ASSERT_EQ (tree.size (), valid.size ());
+  EXPECT_LE (tree.size (), 1000);
+  std::set<std::tuple<int, int, int> > voxels;
+  for (const auto &index : valid)
+  {
+    const PointXYZ &point = (*tree.getInputCloud ())[index];
+    const auto voxel = std::make_tuple (static_cast<int> (std::floor (point.x / leaf_size)),
+                                        static_cast<int> (std::floor (point.y / leaf_size)),
+                                        static_cast<int> (std::floor (point.z / leaf_size)));
+    EXPECT_TRUE (voxels.insert (voxel).second);
+  }
+
+  compareWithBruteForce (tree, 50);
+}
+
+/* ---[ */
+int
+main (int argc, char** argv)
+{
+  testing::InitGoogleTest (&argc, argv);
+  return (RUN_ALL_TESTS ());
+}
+/* ]--- */
@@ -42,6 +42,8 @@
 #include <pcl/point_cloud.h>
 #include <pcl/point_types.h>
 #include <pcl/common/distances.h>
+#include <pcl/common/norms.h> // for L2_Norm_SQR
+#include <pcl/search/brute_force.h> // for BruteForce
 #include <pcl/search/kdtree.h> // for KdTree
 
 using namespace pcl;
@@ -195,6 +197,44 @@ TEST (PCL, KdTree_multipointKnnSearch)
   }
 }
 
+/* Test that descriptors are searched on their whole vector, by the tree and by brute force */
+TEST (PCL, KdTree_descriptorSearch)
+{
+  PointCloud<FPFHSignature33>::Ptr descriptors (new PointCloud<FPFHSignature33>);
+  for (std::size_t i = 0; i < 500; ++i)
+  {
+    FPFHSignature33 descriptor;
+    for (float &bin : descriptor.histogram)
+      bin = static_cast<float> (100 * rand () / (RAND_MAX + 1.0));
+    descriptors->push_back (descriptor);
+  }
+
+  const unsigned int no_of_neighbors = 5;
+  pcl::search::KdTree<FPFHSignature33> kdtree;
+  kdtree.setInputCloud (descriptors);
+  pcl::search::BruteForce<FPFHSignature33> brute_force;
+  brute_force.setInputCloud (descriptors);
+
+  pcl::Indices k_indices, bf_indices;
+  std::vector<float> k_distances, bf_distances;
+  for (std::size_t i = 0; i < 20; ++i)
+  {
+    const FPFHSignature33 &query = (*descriptors)[i];
+    kdtree.nearestKSearch (query, no_of_neighbors, k_indices, k_distances);
+    brute_force.nearestKSearch (query, no_of_neighbors, bf_indices, bf_distances);
+    ASSERT_EQ (k_indices.size (), no_of_neighbors);
+    ASSERT_EQ (bf_indices.size (), no_of_neighbors);
+    // the query itself is its own nearest neighbor
+    EXPECT_EQ (bf_indices[0], static_cast<pcl::index_t> (i));
+    EXPECT_EQ (bf_distances[0], 0.0f);
+    for (std::size_t j = 0; j < no_of_neighbors; ++j)
+    {
+      EXPECT_NEAR (k_distances[j], bf_distances[j], 1e-2f);
+      EXPECT_NEAR (bf_distances[j], L2_Norm_SQR<const float*> (query.histogram, (*descriptors)[bf_indices[j]].histogram, 33), 1e-2f);
+    }
+  }
+}
+
 int
 main (int argc, char** argv)
 {
@@ -37,6 +37,9 @@
 
 #include <pcl/test/gtest.h>
 
+#include <algorithm>
+#include <limits>
+#include <utility>
 #include <vector>
 
 
@@ -178,6 +181,85 @@ TEST (PCL, Organized_Neighbor_Pointcloud_Nearest_K_Neighbour_Search)
 
 }
 
+TEST (PCL, Organized_Neighbor_Camera_Intrinsics_Batch_Nearest_K_Search)
+{
+  const unsigned int seed = time (nullptr);
+  srand (seed);
+  SCOPED_TRACE("seed=" + std::to_string(seed));
+
+  // typical focal length from kinect
+  constexpr double oneOverFocalLength = 0.0018;
+  constexpr int K = 8;
+
+  PointCloud<PointXYZ>::Ptr cloudIn (new PointCloud<PointXYZ> (64, 48));
+  const int centerX = cloudIn->width >> 1;
+  const int centerY = cloudIn->height >> 1;
+  for (int ypos = -centerY; ypos < centerY; ypos++)
+    for (int xpos = -centerX; xpos < centerX; xpos++)
+    {
+      PointXYZ& point = cloudIn->at (xpos + centerX, ypos + centerY);
+      if (rand () % 10 == 0)
+      {
+        point.x = point.y = point.z = std::numeric_limits<float>::quiet_NaN ();
+        continue;
+      }
+      const double z = 5.0 * (double (rand ()) / double (RAND_MAX)) + 5;
+      point = PointXYZ (float (xpos * oneOverFocalLength * z), float (ypos * oneOverFocalLength * z), float (z));
+    }
+
+  Indices queries;
+  for (index_t i = 0; i < static_cast<index_t> (cloudIn->size ()); ++i)
+    if (std::isfinite ((*cloudIn)[i].x))
+      queries.push_back (i);
+
+  search::OrganizedNeighbor<PointXYZ> estimated;
+  estimated.setInputCloud (cloudIn);
+  ASSERT_TRUE (estimated.isValid ());
+
+  search::OrganizedNeighbor<PointXYZ> intrinsics;
+  intrinsics.setCameraIntrinsics (float (1.0 / oneOverFocalLength), float (1.0 / oneOverFocalLength),
+                                  float (centerX), float (centerY));
+  intrinsics.setInputCloud (cloudIn);
+  ASSERT_TRUE (intrinsics.isValid ());
+  EXPECT_FLOAT_EQ (intrinsics.getProjectionMatrix () (0, 2), float (centerX));
+
+  Indices k_indices, k_indices_estimated;
+  std::vector<float> k_sqr_distances, k_sqr_distances_estimated;
+  std::vector<std::size_t> offsets, offsets_estimated;
+  intrinsics.nearestKSearch (*cloudIn, queries, K, k_indices, k_sqr_distances, offsets, 4);
+  estimated.nearestKSearch (*cloudIn, queries, K, k_indices_estimated, k_sqr_distances_estimated, offsets_estimated, 4);
+  EXPECT_EQ (offsets, offsets_estimated);
+  EXPECT_EQ (k_indices, k_indices_estimated);
+  ASSERT_EQ (offsets.size (), queries.size () + 1);
+
+  // compare with brute force
+  for (std::size_t q = 0; q < queries.size (); q += 7)
+  {
+    const PointXYZ& searchPoint = (*cloudIn)[queries[q]];
+    std::vector<std::pair<float, index_t> > bruteforce;
+    for (const auto& i : queries)
+      bruteforce.emplace_back (((*cloudIn)[i].getVector3fMap () - searchPoint.getVector3fMap ()).squaredNorm (), i);
+    std::sort (bruteforce.begin (), bruteforce.end ());
+
+    ASSERT_EQ (offsets[q + 1] - offsets[q], std::size_t (K));
+    for (std::size_t j = 0; j < std::size_t (K); ++j)
+    {
+      EXPECT_EQ (k_indices[offsets[q] + j], bruteforce[j].second);
+      EXPECT_NEAR (k_sqr_distances[offsets[q] + j], bruteforce[j].first, 1e-4);
+    }
+  }
+
+  // the intrinsics are kept for the next frame, the single point search reuses the output vectors
+  intrinsics.setInputCloud (cloudIn);
+  EXPECT_FLOAT_EQ (intrinsics.getProjectionMatrix () (1, 2), float (centerY));
+  Indices nn_indices (K);
+  std::vector<float> nn_sqr_distances (K);
+  const index_t* data = nn_indices.data ();
+  EXPECT_EQ (intrinsics.nearestKSearch (queries[0], K, nn_indices, nn_sqr_distances), K);
+  EXPECT_EQ (nn_indices.data (), data);
+  EXPECT_TRUE (std::equal (nn_indices.begin (), nn_indices.end (), k_indices.begin ()));
+}
+
 TEST (PCL, Organized_Neighbor_Pointcloud_Neighbours_Within_Radius_Search)
 {
   constexpr unsigned int test_runs = 10;
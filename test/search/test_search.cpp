@@ -37,10 +37,13 @@
 
 #include <pcl/test/gtest.h>
 
+#include <algorithm>
 #include <random>
 
 #include <pcl/search/brute_force.h>
 #include <pcl/search/kdtree.h>
+#include <pcl/search/kdtree_3d.h>
+#include <pcl/search/incremental_kdtree.h>
 #include <pcl/search/organized.h>
 #include <pcl/search/octree.h>
 #include <pcl/io/pcd_io.h>
@@ -114,6 +117,12 @@ pcl::search::BruteForce<pcl::PointXYZ> brute_force;
 /** \brief instance of KDTree search method to be tested*/
 pcl::search::KdTree<pcl::PointXYZ> KDTree;
 
+/** \brief instance of compile-time 3D KDTree search method to be tested*/
+pcl::search::KdTree3D<pcl::PointXYZ> KDTree3D;
+
+/** \brief instance of incremental KDTree search method to be tested*/
+pcl::search::IncrementalKdTree<pcl::PointXYZ> incremental_KDTree;
+
 /** \brief instance of Octree search method to be tested*/
 pcl::search::Octree<pcl::PointXYZ> octree_search (0.1);
 
@@ -432,6 +441,52 @@ testRadiusSearch (typename PointCloud<PointT>::ConstPtr point_cloud, std::vector
   }
 }
 
+/** \brief test batched k-nearest neighbor and radius search against the single query variants
+  * \param point_cloud point cloud to be used for the search
+  * \param search_methods vector of all search methods to be tested
+  * \param query_indices indices of query points in the point cloud
+  */
+template<typename PointT> void
+testBatchSearch (typename PointCloud<PointT>::ConstPtr point_cloud, std::vector<search::Search<PointT>*> search_methods,
+                 const pcl::Indices& query_indices)
+{
+  for (auto &search_method : search_methods)
+  {
+    search_method->setInputCloud (point_cloud);
+
+    pcl::Indices batch_indices, indices;
+    std::vector<float> batch_distances, distances;
+    std::vector<std::size_t> offsets;
+
+    const int k = 8;
+    search_method->nearestKSearch (*point_cloud, query_indices, k, batch_indices, batch_distances, offsets, 4);
+    ASSERT_EQ (query_indices.size () + 1, offsets.size ()) << search_method->getName ();
+    EXPECT_EQ (batch_indices.size (), offsets.back ());
+    EXPECT_EQ (batch_distances.size (), offsets.back ());
+    for (std::size_t qIdx = 0; qIdx < query_indices.size (); ++qIdx)
+    {
+      const int count = search_method->nearestKSearch (*point_cloud, query_indices [qIdx], k, indices, distances);
+      ASSERT_EQ (static_cast<std::size_t> (count), offsets [qIdx + 1] - offsets [qIdx]) << search_method->getName ();
+      for (int nIdx = 0; nIdx < count; ++nIdx)
+        EXPECT_FLOAT_EQ (distances [nIdx], batch_distances [offsets [qIdx] + nIdx]) << search_method->getName ();
+    }
+
+    const double radius = 0.05;
+    search_method->radiusSearch (*point_cloud, query_indices, radius, batch_indices, batch_distances, offsets, 0, 4);
+    ASSERT_EQ (query_indices.size () + 1, offsets.size ()) << search_method->getName ();
+    EXPECT_EQ (batch_indices.size (), offsets.back ());
+    for (std::size_t qIdx = 0; qIdx < query_indices.size (); ++qIdx)
+    {
+      const int count = search_method->radiusSearch (*point_cloud, query_indices [qIdx], radius, indices, distances);
+      ASSERT_EQ (static_cast<std::size_t> (count), offsets [qIdx + 1] - offsets [qIdx]) << search_method->getName ();
+      pcl::Indices batch_neighbors (batch_indices.begin () + offsets [qIdx], batch_indices.begin () + offsets [qIdx + 1]);
+      std::sort (indices.begin (), indices.end ());
+      std::sort (batch_neighbors.begin (), batch_neighbors.end ());
+      EXPECT_EQ (indices, batch_neighbors) << search_method->getName ();
+    }
+  }
+}
+
 #if TEST_unorganized_dense_cloud_COMPLETE_KNN
 // Test search on unorganized point clouds
 TEST (PCL, unorganized_dense_cloud_Complete_KNN)
@@ -538,6 +593,16 @@ TEST (PCL, Organized_Sparse_View_Radius)
 }
 #endif
 
+TEST (PCL, unorganized_dense_cloud_Batch)
+{
+  testBatchSearch (unorganized_dense_cloud, unorganized_search_methods, unorganized_dense_cloud_query_indices);
+}
+
+TEST (PCL, Organized_Sparse_Batch)
+{
+  testBatchSearch (organized_sparse_cloud, organized_search_methods, organized_sparse_query_indices);
+}
+
 /** \brief create subset of point in cloud to use as query points
   * \param[out] query_indices resulting query indices - not guaranteed to have size of query_count but guaranteed not to exceed that value
   * \param cloud input cloud required to check for nans and to get number of points
@@ -639,15 +704,21 @@ main (int argc, char** argv)
   
   brute_force.setSortedResults (true);
   KDTree.setSortedResults (true);
+  KDTree3D.setSortedResults (true);
+  incremental_KDTree.setSortedResults (true);
   octree_search.setSortedResults (true);
   organized.setSortedResults (true);
   
   unorganized_search_methods.push_back (&brute_force);
   unorganized_search_methods.push_back (&KDTree);
+  unorganized_search_methods.push_back (&KDTree3D);
+  unorganized_search_methods.push_back (&incremental_KDTree);
   unorganized_search_methods.push_back (&octree_search);
   
   organized_search_methods.push_back (&brute_force);
   organized_search_methods.push_back (&KDTree);
+  organized_search_methods.push_back (&KDTree3D);
+  organized_search_methods.push_back (&incremental_KDTree);
   organized_search_methods.push_back (&octree_search);
   organized_search_methods.push_back (&organized);
   
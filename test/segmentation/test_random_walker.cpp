@@ -234,6 +234,76 @@ TEST_P (RandomWalkerTest, GetPotentials)
       }
 }
 
+TEST_P (RandomWalkerTest, ConjugateGradient)
+{
+  for (const auto preconditioner : {pcl::segmentation::RANDOM_WALKER_JACOBI,
+                                    pcl::segmentation::RANDOM_WALKER_INCOMPLETE_CHOLESKY})
+  for (const unsigned int nr_threads : {0u, 2u})
+  {
+    GraphInfo graph_info (TEST_DATA_DIR + "/" + GetParam ());
+    pcl::segmentation::RandomWalkerParameters parameters;
+    parameters.solver = pcl::segmentation::RANDOM_WALKER_CONJUGATE_GRADIENT;
+    parameters.preconditioner = preconditioner;
+    parameters.nr_threads = nr_threads;
+
+    Matrix p;
+    std::map<Color, std::size_t> map;
+    bool result = pcl::segmentation::randomWalker (graph_info.graph,
+                                                   boost::get (boost::edge_weight, graph_info.graph),
+                                                   boost::get (boost::vertex_color, graph_info.graph),
+                                                   p,
+                                                   map,
+                                                   parameters);
+    ASSERT_TRUE (result);
+    ASSERT_EQ (graph_info.size, p.rows ());
+    ASSERT_EQ (graph_info.colors.size (), p.cols ());
+
+    VertexIterator vi, v_end;
+    for (boost::tie (vi, v_end) = boost::vertices (graph_info.graph); vi != v_end; ++vi)
+      EXPECT_EQ (graph_info.segmentation[*vi], graph_info.color_map[*vi]);
+    for (const unsigned int &color : graph_info.colors)
+      for (std::size_t i = 0; i < graph_info.size; ++i)
+        if (graph_info.potentials.count (color))
+        {
+          EXPECT_NEAR (graph_info.potentials[color] (i), p (i, map[color]), 0.01);
+        }
+  }
+}
+
+TEST_P (RandomWalkerTest, ConjugateGradientWarmStart)
+{
+  pcl::segmentation::RandomWalkerParameters parameters;
+  parameters.solver = pcl::segmentation::RANDOM_WALKER_CONJUGATE_GRADIENT;
+
+  // Solve once from zero, keeping the seeds of the graph intact
+  GraphInfo cold_info (TEST_DATA_DIR + "/" + GetParam ());
+  RandomWalker cold (cold_info.graph,
+                     boost::get (boost::edge_weight, cold_info.graph),
+                     boost::get (boost::vertex_color, cold_info.graph),
+                     parameters);
+  ASSERT_TRUE (cold.segment ());
+  Matrix p;
+  std::map<Color, std::size_t> map;
+  cold.getPotentials (p, map);
+
+  // Solving again from the previous solution takes fewer iterations
+  RandomWalker warm (g.graph,
+                     boost::get (boost::edge_weight, g.graph),
+                     boost::get (boost::vertex_color, g.graph),
+                     parameters);
+  warm.setInitialPotentials (p, map);
+  ASSERT_TRUE (warm.segment ());
+  EXPECT_LE (warm.num_iterations_, cold.num_iterations_);
+  if (cold.num_iterations_ > 0)
+  {
+    EXPECT_LT (warm.num_iterations_, cold.num_iterations_);
+  }
+
+  VertexIterator vi, v_end;
+  for (boost::tie (vi, v_end) = boost::vertices (g.graph); vi != v_end; ++vi)
+    EXPECT_EQ (g.segmentation[*vi], g.color_map[*vi]);
+}
+
 INSTANTIATE_TEST_SUITE_P (VariousGraphs,
                          RandomWalkerTest,
                          ::testing::Values ("graph0.info",
@@ -40,15 +40,29 @@
 #include <pcl/test/gtest.h>
 #include <pcl/point_types.h>
 #include <pcl/point_cloud.h>
+#include <pcl/common/execution_context.h>
 #include <pcl/io/pcd_io.h>
 #include <pcl/search/search.h>
 #include <pcl/features/normal_3d.h>
 
+#include <pcl/segmentation/conditional_euclidean_clustering.h>
+#include <pcl/segmentation/extract_clusters.h>
 #include <pcl/segmentation/extract_polygonal_prism_data.h>
 #include <pcl/segmentation/segment_differences.h>
 #include <pcl/segmentation/region_growing.h>
 #include <pcl/segmentation/region_growing_rgb.h>
 #include <pcl/segmentation/min_cut_segmentation.h>
+#include <pcl/segmentation/euclidean_cluster_comparator.h>
+#include <pcl/segmentation/organized_multi_plane_segmentation.h>
+#include <pcl/segmentation/progressive_morphological_filter.h>
+#include <pcl/segmentation/approximate_progressive_morphological_filter.h>
+#include <pcl/segmentation/supervoxel_clustering.h>
+#include <pcl/segmentation/voxel_connected_components.h>
+#include <pcl/segmentation/sac_segmentation.h>
+
+#include <cmath>
+#include <limits>
+#include <random>
 
 using namespace pcl;
 using namespace pcl::io;
@@ -79,6 +93,217 @@ TEST (RegionGrowingRGBTest, Segment)
   EXPECT_NE (0, num_of_segments);
 }
 
+////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (RegionGrowingRGBTest, MultiThreaded)
+{
+  RegionGrowingRGB<pcl::PointXYZRGB> rg;
+  rg.setInputCloud (colored_cloud);
+  rg.setDistanceThreshold (10);
+  rg.setRegionColorThreshold (5);
+  rg.setPointColorThreshold (6);
+  rg.setMinClusterSize (20);
+
+  std::vector <pcl::PointIndices> clusters;
+  rg.extract (clusters);
+  ASSERT_NE (0, clusters.size ());
+
+  rg.setNumberOfThreads (4);
+  EXPECT_EQ (4, rg.getNumberOfThreads ());
+  std::vector <pcl::PointIndices> clusters_mt;
+  rg.extract (clusters_mt);
+  ASSERT_EQ (clusters.size (), clusters_mt.size ());
+  for (std::size_t i = 0; i < clusters.size (); ++i)
+    EXPECT_EQ (clusters[i].indices, clusters_mt[i].indices);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (SupervoxelClustering, MultiThreaded)
+{
+  pcl::SupervoxelClustering<pcl::PointXYZRGB> super (0.02f, 0.1f);
+  super.setInputCloud (colored_cloud);
+  std::map<std::uint32_t, pcl::Supervoxel<pcl::PointXYZRGB>::Ptr> supervoxels;
+  super.extract (supervoxels);
+  super.refineSupervoxels (2, supervoxels);
+  ASSERT_FALSE (supervoxels.empty ());
+  const auto labels = super.getLabeledVoxelCloud ();
+
+  pcl::SupervoxelClustering<pcl::PointXYZRGB> super_mt (0.02f, 0.1f);
+  super_mt.setNumberOfThreads (4);
+  EXPECT_EQ (4, super_mt.getNumberOfThreads ());
+  super_mt.setInputCloud (colored_cloud);
+  std::map<std::uint32_t, pcl::Supervoxel<pcl::PointXYZRGB>::Ptr> supervoxels_mt;
+  super_mt.extract (supervoxels_mt);
+  super_mt.refineSupervoxels (2, supervoxels_mt);
+  const auto labels_mt = super_mt.getLabeledVoxelCloud ();
+
+  ASSERT_EQ (supervoxels.size (), supervoxels_mt.size ());
+  ASSERT_EQ (labels->size (), labels_mt->size ());
+  for (std::size_t i = 0; i < labels->size (); ++i)
+    EXPECT_EQ ((*labels)[i].label, (*labels_mt)[i].label);
+  for (const auto &supervoxel : supervoxels)
+  {
+    ASSERT_EQ (1, supervoxels_mt.count (supervoxel.first));
+    EXPECT_EQ (supervoxel.second->voxels_->size (), supervoxels_mt[supervoxel.first]->voxels_->size ());
+    EXPECT_NEAR (supervoxel.second->normal_.normal_x, supervoxels_mt[supervoxel.first]->normal_.normal_x, 1e-5);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (SupervoxelClustering, MemoryUsage)
+{
+  pcl::SupervoxelClustering<pcl::PointXYZRGB> fine (0.01f, 0.1f);
+  fine.setInputCloud (colored_cloud);
+  std::map<std::uint32_t, pcl::Supervoxel<pcl::PointXYZRGB>::Ptr> supervoxels;
+  fine.extract (supervoxels);
+  ASSERT_FALSE (supervoxels.empty ());
+  EXPECT_GE (fine.getMemoryUsage (), fine.getVoxelCentroidCloud ()->size () * sizeof (pcl::PointXYZRGB));
+
+  // Coarser voxels need less memory
+  pcl::SupervoxelClustering<pcl::PointXYZRGB> coarse (0.04f, 0.1f);
+  coarse.setInputCloud (colored_cloud);
+  coarse.extract (supervoxels);
+  EXPECT_LT (coarse.getMemoryUsage (), fine.getMemoryUsage ());
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (OrganizedMultiPlaneSegmentation, MultiThreaded)
+{
+  // Organized cloud with three planar patches and invalid pixels, also in the first row and column
+  const int width = 160, height = 120;
+  pcl::PointCloud<pcl::PointXYZ>::Ptr cloud (new pcl::PointCloud<pcl::PointXYZ> (width, height));
+  pcl::PointCloud<pcl::Normal>::Ptr normals (new pcl::PointCloud<pcl::Normal> (width, height));
+  srand (5);
+  for (int row = 0; row < height; ++row)
+  {
+    for (int col = 0; col < width; ++col)
+    {
+      pcl::PointXYZ &p = (*cloud) (col, row);
+      pcl::Normal &n = (*normals) (col, row);
+      p.x = static_cast<float> (col - width / 2) * 0.01f;
+      p.y = static_cast<float> (row - height / 2) * 0.01f;
+      Eigen::Vector3f normal;
+      if (col < width / 2)
+      {
+        p.z = 1.0f;
+        normal << 0.0f, 0.0f, -1.0f;
+      }
+      else if (row < height / 2)
+      {
+        p.z = 1.0f + p.x;
+        normal << 1.0f, 0.0f, -1.0f;
+      }
+      else
+      {
+        p.z = 1.5f;
+        normal << 0.0f, 0.0f, -1.0f;
+      }
+      p.z += 0.0005f * (static_cast<float> (rand ()) / static_cast<float> (RAND_MAX) - 0.5f);
+      normal.normalize ();
+      n.getNormalVector3fMap () = normal;
+      n.curvature = 0.0f;
+      if (rand () % 20 == 0 || (row == 0 && col % 7 == 3) || (col == 0 && row % 5 == 2))
+        p.x = p.y = p.z = std::numeric_limits<float>::quiet_NaN ();
+    }
+  }
+
+  pcl::OrganizedMultiPlaneSegmentation<pcl::PointXYZ, pcl::Normal, pcl::Label> mps;
+  mps.setInputCloud (cloud);
+  mps.setInputNormals (normals);
+  mps.setMinInliers (500);
+  std::vector<pcl::ModelCoefficients> coefficients, coefficients_mt;
+  std::vector<pcl::PointIndices> inliers, inliers_mt;
+  mps.segment (coefficients, inliers);
+  EXPECT_EQ (3, coefficients.size ());
+
+  mps.setNumberOfThreads (4);
+  EXPECT_EQ (4, mps.getNumberOfThreads ());
+  mps.segment (coefficients_mt, inliers_mt);
+  ASSERT_EQ (coefficients.size (), coefficients_mt.size ());
+  for (std::size_t i = 0; i < coefficients.size (); ++i)
+  {
+    EXPECT_EQ (inliers[i].indices, inliers_mt[i].indices);
+    EXPECT_EQ (coefficients[i].values, coefficients_mt[i].values);
+  }
+
+  // 0 takes the threads from the budget of the execution context, shared with the labeling
+  const unsigned int budget = pcl::ExecutionContext::getThreadBudget ();
+  pcl::ExecutionContext::setThreadBudget (4);
+  mps.setNumberOfThreads (0);
+  coefficients_mt.clear ();
+  inliers_mt.clear ();
+  mps.segment (coefficients_mt, inliers_mt);
+  pcl::ExecutionContext::setThreadBudget (budget);
+  ASSERT_EQ (coefficients.size (), coefficients_mt.size ());
+  for (std::size_t i = 0; i < coefficients.size (); ++i)
+  {
+    EXPECT_EQ (inliers[i].indices, inliers_mt[i].indices);
+    EXPECT_EQ (coefficients[i].values, coefficients_mt[i].values);
+  }
+
+  // The blockwise labeling matches the sequential one, also through the virtual comparator
+  pcl::EuclideanClusterComparator<pcl::PointXYZ, pcl::Label>::Ptr comparator (new pcl::EuclideanClusterComparator<pcl::PointXYZ, pcl::Label> ());
+  comparator->setInputCloud (cloud);
+  comparator->setDistanceThreshold (0.012f, false);
+  pcl::OrganizedConnectedComponentSegmentation<pcl::PointXYZ, pcl::Label> occs (comparator);
+  occs.setInputCloud (cloud);
+  pcl::PointCloud<pcl::Label> labels, labels_mt;
+  std::vector<pcl::PointIndices> label_indices, label_indices_mt;
+  occs.segment (labels, label_indices);
+  occs.setNumberOfThreads (3);
+  occs.segment (labels_mt, label_indices_mt);
+  ASSERT_EQ (label_indices.size (), label_indices_mt.size ());
+  EXPECT_LT (10, label_indices.size ());
+  for (std::size_t i = 0; i < labels.size (); ++i)
+    EXPECT_EQ (labels[i].label, labels_mt[i].label);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (ProgressiveMorphologicalFilter, Grid)
+{
+  // Gently sloped terrain with a 6 x 6 building of height 5 on it
+  pcl::PointCloud<pcl::PointXYZ>::Ptr cloud (new pcl::PointCloud<pcl::PointXYZ>);
+  Indices expected_ground;
+  srand (7);
+  for (int i = 0; i < 40; ++i)
+  {
+    for (int j = 0; j < 40; ++j)
+    {
+      pcl::PointXYZ p;
+      p.x = static_cast<float> (i) + 0.1f * static_cast<float> (rand () % 9);
+      p.y = static_cast<float> (j) + 0.1f * static_cast<float> (rand () % 9);
+      p.z = 0.02f * p.x;
+      if (i >= 15 && i < 21 && j >= 15 && j < 21)
+        p.z += 5.0f;
+      else
+        expected_ground.push_back (static_cast<index_t> (cloud->size ()));
+      cloud->push_back (p);
+    }
+  }
+
+  pcl::ProgressiveMorphologicalFilter<pcl::PointXYZ> pmf;
+  pmf.setInputCloud (cloud);
+  pmf.setMaxWindowSize (20);
+  pmf.setSlope (0.5f);
+  pmf.setInitialDistance (0.3f);
+  pmf.setMaxDistance (3.0f);
+  EXPECT_FALSE (pmf.getUseGrid ());
+  pmf.setUseGrid (true);
+  Indices ground;
+  pmf.extract (ground);
+  EXPECT_EQ (expected_ground, ground);
+
+  pcl::ApproximateProgressiveMorphologicalFilter<pcl::PointXYZ> apmf;
+  apmf.setInputCloud (cloud);
+  apmf.setMaxWindowSize (20);
+  apmf.setSlope (0.5f);
+  apmf.setInitialDistance (0.3f);
+  apmf.setMaxDistance (3.0f);
+  apmf.setNumberOfThreads (1);
+  Indices ground_approximate;
+  apmf.extract (ground_approximate);
+  EXPECT_EQ (expected_ground, ground_approximate);
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////////////
 TEST (RegionGrowingTest, Segment)
 {
@@ -92,6 +317,53 @@ TEST (RegionGrowingTest, Segment)
   EXPECT_NE (0, num_of_segments);
 }
 
+////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (RegionGrowingTest, MemoryUsage)
+{
+  pcl::RegionGrowing<pcl::PointXYZ, pcl::Normal> rg;
+  rg.setInputCloud (cloud_);
+  rg.setInputNormals (normals_);
+  EXPECT_EQ (0, rg.getMemoryUsage ());
+
+  std::vector <pcl::PointIndices> clusters;
+  rg.extract (clusters);
+  const std::size_t bytes = rg.getMemoryUsage ();
+  EXPECT_GE (bytes, cloud_->size () * sizeof (int));
+  EXPECT_LE (bytes, (pcl::RegionGrowing<pcl::PointXYZ, pcl::Normal>::estimateMemoryUsage (cloud_->size (), rg.getNumberOfNeighbours ())));
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (RegionGrowingTest, MultiThreaded)
+{
+  pcl::RegionGrowing<pcl::PointXYZ, pcl::Normal> rg;
+  rg.setInputCloud (cloud_);
+  rg.setInputNormals (normals_);
+
+  std::vector <pcl::PointIndices> clusters;
+  rg.extract (clusters);
+  ASSERT_NE (0, clusters.size ());
+
+  rg.setNumberOfThreads (4);
+  std::vector <pcl::PointIndices> clusters_mt;
+  rg.extract (clusters_mt);
+  ASSERT_EQ (clusters.size (), clusters_mt.size ());
+  for (std::size_t i = 0; i < clusters.size (); ++i)
+    EXPECT_EQ (clusters[i].indices, clusters_mt[i].indices);
+
+  // The segment grown from a single point has to match as well
+  pcl::PointIndices segment, segment_mt;
+  pcl::RegionGrowing<pcl::PointXYZ, pcl::Normal> rg_seed, rg_seed_mt;
+  rg_seed.setInputCloud (cloud_);
+  rg_seed.setInputNormals (normals_);
+  rg_seed.getSegmentFromPoint (0, segment);
+  rg_seed_mt.setInputCloud (cloud_);
+  rg_seed_mt.setInputNormals (normals_);
+  rg_seed_mt.setNumberOfThreads (4);
+  rg_seed_mt.getSegmentFromPoint (0, segment_mt);
+  EXPECT_EQ (segment.indices, segment_mt.indices);
+  EXPECT_FALSE (segment.indices.empty ());
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////////////
 TEST (RegionGrowingTest, SegmentWithoutCloud)
 {
@@ -236,6 +508,48 @@ TEST (MinCutSegmentationTest, Segment)
   EXPECT_EQ (2, num_of_segments);
 }
 
+////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (MinCutSegmentationTest, ChangeForegroundPoints)
+{
+  pcl::PointCloud<pcl::PointXYZ>::Ptr foreground_points (new pcl::PointCloud<pcl::PointXYZ> ());
+  foreground_points->push_back (pcl::PointXYZ (-36.01f, -64.73f, -6.18f));
+
+  pcl::MinCutSegmentation<pcl::PointXYZ> mcSeg;
+  mcSeg.setForegroundPoints (foreground_points);
+  mcSeg.setInputCloud (another_cloud_);
+  mcSeg.setRadius (3.8003856);
+  mcSeg.setSigma (0.25);
+  mcSeg.setNumberOfThreads (4);
+  EXPECT_EQ (4, mcSeg.getNumberOfThreads ());
+
+  std::vector <pcl::PointIndices> clusters;
+  mcSeg.extract (clusters);
+  ASSERT_EQ (2, clusters.size ());
+  EXPECT_EQ (another_cloud_->size (), clusters[0].indices.size () + clusters[1].indices.size ());
+  const double first_flow = mcSeg.getMaxFlow ();
+
+  // A second foreground point only changes the source and sink capacities, the graph is kept
+  foreground_points->push_back (pcl::PointXYZ (-35.5f, -64.0f, -6.0f));
+  mcSeg.setForegroundPoints (foreground_points);
+  std::vector <pcl::PointIndices> updated_clusters;
+  mcSeg.extract (updated_clusters);
+  ASSERT_EQ (2, updated_clusters.size ());
+  EXPECT_GT (first_flow, mcSeg.getMaxFlow ());
+
+  // Same result as a new segmentation with both foreground points on a single thread
+  pcl::MinCutSegmentation<pcl::PointXYZ> reference;
+  reference.setForegroundPoints (foreground_points);
+  reference.setInputCloud (another_cloud_);
+  reference.setRadius (3.8003856);
+  reference.setSigma (0.25);
+  std::vector <pcl::PointIndices> reference_clusters;
+  reference.extract (reference_clusters);
+  ASSERT_EQ (2, reference_clusters.size ());
+  EXPECT_NEAR (reference.getMaxFlow (), mcSeg.getMaxFlow (), 1e-6);
+  EXPECT_EQ (reference_clusters[0].indices, updated_clusters[0].indices);
+  EXPECT_EQ (reference_clusters[1].indices, updated_clusters[1].indices);
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////////////
 TEST (MinCutSegmentationTest, SegmentWithoutForegroundPoints)
 {
@@ -334,6 +648,218 @@ TEST (MinCutSegmentationTest, SegmentWithWrongParameters)
   EXPECT_EQ (2, num_of_segments);
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////
+TEST (EuclideanClusterExtraction, MultiThreaded)
+{
+  // Every other point of bun0, so that the cloud falls apart into many clusters of different sizes
+  pcl::IndicesPtr indices (new pcl::Indices);
+  for (std::size_t i = 0; i < cloud_->size (); i += 2)
+    indices->push_back (static_cast<pcl::index_t> (i));
+
+  EuclideanClusterExtraction<PointXYZ> ec;
+  ec.setInputCloud (cloud_);
+  ec.setIndices (indices);
+  ec.setClusterTolerance (0.012);
+  ec.setMinClusterSize (3);
+  ec.setMaxClusterSize (100);
+  EXPECT_EQ (1, ec.getNumberOfThreads ());
+
+  std::vector<PointIndices> serial_clusters;
+  ec.extract (serial_clusters);
+  ASSERT_LT (1, serial_clusters.size ());
+
+  for (const unsigned int nr_threads : {2u, 4u, 0u})
+  {
+    SCOPED_TRACE (nr_threads);
+    ec.setNumberOfThreads (nr_threads);
+    EXPECT_EQ (nr_threads, ec.getNumberOfThreads ());
+
+    std::vector<PointIndices> parallel_clusters;
+    ec.extract (parallel_clusters);
+    ASSERT_EQ (serial_clusters.size (), parallel_clusters.size ());
+    for (std::size_t i = 0; i < serial_clusters.size (); ++i)
+      EXPECT_EQ (serial_clusters[i].indices, parallel_clusters[i].indices);
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+TEST (ConditionalEuclideanClustering, MultiThreaded)
+{
+  // A symmetric condition, so that the concurrent union-find finds the same clusters
+  const std::function<bool (const PointXYZ&, const PointXYZ&, float)> similar_height =
+    [] (const PointXYZ &a, const PointXYZ &b, float) { return (std::abs (a.y - b.y) < 0.004f); };
+
+  ConditionalEuclideanClustering<PointXYZ> cec (true);
+  cec.setInputCloud (cloud_);
+  cec.setConditionFunction (similar_height);
+  cec.setClusterTolerance (0.01f);
+  cec.setMinClusterSize (5);
+  cec.setMaxClusterSize (200);
+  EXPECT_EQ (1, cec.getNumberOfThreads ());
+
+  IndicesClusters serial_clusters;
+  cec.segment (serial_clusters);
+  IndicesClustersPtr serial_small, serial_large;
+  cec.getRemovedClusters (serial_small, serial_large);
+  ASSERT_LT (1, serial_clusters.size ());
+  ASSERT_FALSE (serial_small->empty ());
+  // The indices of the parallel clusters are sorted
+  const auto sorted = [] (IndicesClusters clusters)
+  {
+    for (auto &cluster : clusters)
+      std::sort (cluster.indices.begin (), cluster.indices.end ());
+    return (clusters);
+  };
+  const IndicesClusters expected_clusters = sorted (serial_clusters);
+  const IndicesClusters expected_small = sorted (*serial_small);
+  const IndicesClusters expected_large = sorted (*serial_large);
+
+  for (const unsigned int nr_threads : {0u, 2u, 4u})
+  {
+    SCOPED_TRACE (nr_threads);
+    cec.setNumberOfThreads (nr_threads);
+    EXPECT_EQ (nr_threads, cec.getNumberOfThreads ());
+
+    IndicesClusters parallel_clusters;
+    cec.segment (parallel_clusters);
+    IndicesClustersPtr parallel_small, parallel_large;
+    cec.getRemovedClusters (parallel_small, parallel_large);
+    ASSERT_EQ (expected_clusters.size (), parallel_clusters.size ());
+    for (std::size_t i = 0; i < expected_clusters.size (); ++i)
+      EXPECT_EQ (expected_clusters[i].indices, parallel_clusters[i].indices);
+    ASSERT_EQ (expected_small.size (), parallel_small->size ());
+    for (std::size_t i = 0; i < expected_small.size (); ++i)
+      EXPECT_EQ (expected_small[i].indices, (*parallel_small)[i].indices);
+    ASSERT_EQ (expected_large.size (), parallel_large->size ());
+    for (std::size_t i = 0; i < expected_large.size (); ++i)
+      EXPECT_EQ (expected_large[i].indices, (*parallel_large)[i].indices);
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+TEST (VoxelConnectedComponents, Blobs)
+{
+  // Three cubes of 5x5x5, 4x4x4 and 2x2x2 points with a spacing of 1 cm, far away from each other
+  PointCloud<PointXYZ>::Ptr blobs (new PointCloud<PointXYZ>);
+  const int sizes[] = {5, 4, 2};
+  for (int b = 0; b < 3; ++b)
+    for (int i = 0; i < sizes[b]; ++i)
+      for (int j = 0; j < sizes[b]; ++j)
+        for (int k = 0; k < sizes[b]; ++k)
+          blobs->push_back (PointXYZ (0.5f * static_cast<float> (b) + 0.01f * static_cast<float> (i),
+                                      0.01f * static_cast<float> (j), 0.01f * static_cast<float> (k)));
+
+  VoxelConnectedComponents<PointXYZ> vcc;
+  vcc.setInputCloud (blobs);
+  vcc.setLeafSize (0.015f);
+  vcc.setMinClusterSize (10);
+
+  std::vector<PointIndices> clusters;
+  vcc.extract (clusters);
+  ASSERT_EQ (2, clusters.size ());
+  EXPECT_EQ (125, clusters[0].indices.size ());
+  EXPECT_EQ (64, clusters[1].indices.size ());
+  for (std::size_t i = 0; i < clusters[0].indices.size (); ++i)
+    EXPECT_EQ (static_cast<index_t> (i), clusters[0].indices[i]);
+
+  // Without a valid leaf size nothing is extracted
+  vcc.setLeafSize (0.0f);
+  vcc.extract (clusters);
+  EXPECT_TRUE (clusters.empty ());
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+TEST (VoxelConnectedComponents, CoarsensEuclideanClusters)
+{
+  const float tolerance = 0.006f;
+
+  EuclideanClusterExtraction<PointXYZ> ec;
+  ec.setInputCloud (cloud_);
+  ec.setClusterTolerance (tolerance);
+  std::vector<PointIndices> euclidean_clusters;
+  ec.extract (euclidean_clusters);
+
+  VoxelConnectedComponents<PointXYZ> vcc;
+  vcc.setInputCloud (cloud_);
+  vcc.setLeafSize (tolerance);
+  std::vector<PointIndices> coarse_clusters, refined_clusters;
+  vcc.extract (coarse_clusters);
+  vcc.setRefineBoundaries (true);
+  EXPECT_TRUE (vcc.getRefineBoundaries ());
+  vcc.extract (refined_clusters);
+
+  // Points closer than the leaf size are always in neighboring voxels, so every Euclidean cluster lies within a
+  // single voxel cluster, and checking the voxel boundaries can only split voxel clusters
+  EXPECT_LE (coarse_clusters.size (), refined_clusters.size ());
+  EXPECT_LE (refined_clusters.size (), euclidean_clusters.size ());
+  for (const auto &voxel_clusters : {coarse_clusters, refined_clusters})
+  {
+    std::vector<int> labels (cloud_->size (), -1);
+    std::size_t nr_points = 0;
+    for (std::size_t c = 0; c < voxel_clusters.size (); ++c)
+    {
+      nr_points += voxel_clusters[c].indices.size ();
+      for (const auto &index : voxel_clusters[c].indices)
+        labels[index] = static_cast<int> (c);
+    }
+    EXPECT_EQ (cloud_->size (), nr_points);
+    for (const auto &cluster : euclidean_clusters)
+      for (const auto &index : cluster.indices)
+        EXPECT_EQ (labels[cluster.indices[0]], labels[index]);
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+TEST (SACSegmentation, SegmentModels)
+{
+  // Three orthogonal planes of a box corner, 20x20 points each
+  PointCloud<PointXYZ>::Ptr corner (new PointCloud<PointXYZ>);
+  for (int i = 1; i <= 20; ++i)
+    for (int j = 1; j <= 20; ++j)
+    {
+      const float u = 0.05f * static_cast<float> (i), v = 0.05f * static_cast<float> (j);
+      corner->push_back (PointXYZ (u, v, 0.0f));
+      corner->push_back (PointXYZ (0.0f, u, v));
+      corner->push_back (PointXYZ (u, 0.0f, v));
+    }
+
+  SACSegmentation<PointXYZ> seg;
+  seg.setInputCloud (corner);
+  seg.setModelType (SACMODEL_PLANE);
+  seg.setMethodType (SAC_RANSAC);
+  seg.setDistanceThreshold (0.01);
+  seg.setMaxIterations (200);
+
+  std::vector<PointIndices> inliers;
+  std::vector<ModelCoefficients> coefficients;
+  seg.segmentModels (inliers, coefficients, 5, 100);
+  ASSERT_EQ (3, inliers.size ());
+  ASSERT_EQ (3, coefficients.size ());
+
+  std::vector<int> used (corner->size (), 0);
+  Eigen::Vector3f axes = Eigen::Vector3f::Zero ();
+  for (std::size_t m = 0; m < inliers.size (); ++m)
+  {
+    EXPECT_EQ (400, inliers[m].indices.size ());
+    for (const auto &index : inliers[m].indices)
+      ++used[index];
+
+    ASSERT_EQ (4, coefficients[m].values.size ());
+    const Eigen::Vector3f normal (coefficients[m].values[0], coefficients[m].values[1], coefficients[m].values[2]);
+    EXPECT_NEAR (1.0f, normal.cwiseAbs ().maxCoeff (), 1e-3);
+    EXPECT_NEAR (0.0f, coefficients[m].values[3], 1e-3);
+    axes += normal.cwiseAbs ();
+  }
+  // Every point is assigned to exactly one plane, and all three planes are different
+  EXPECT_EQ (corner->size (), std::count (used.begin (), used.end (), 1));
+  EXPECT_NEAR (1.0f, axes.minCoeff (), 1e-3);
+
+  // Asking for fewer models stops early
+  seg.segmentModels (inliers, coefficients, 2);
+  EXPECT_EQ (2, inliers.size ());
+  EXPECT_EQ (2, coefficients.size ());
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////
 TEST (SegmentDifferences, Segmentation)
 {
@@ -363,6 +889,60 @@ TEST (SegmentDifferences, Segmentation)
   //savePCDFile ("./test/t-0.pcd", output);
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////
+TEST (SegmentDifferences, VoxelHashAndThreads)
+{
+  SegmentDifferences<PointXYZ> sd;
+  sd.setDistanceThreshold (0.00005);
+  sd.setTargetCloud (cloud_);
+  EXPECT_FALSE (sd.getUseVoxelHash ());
+  EXPECT_EQ (1, sd.getNumberOfThreads ());
+
+  // Reference differences of both directions with the kd-tree
+  PointCloud<PointXYZ> expected_t, expected_0;
+  sd.setInputCloud (cloud_t_);
+  sd.segment (expected_t);
+  sd.setInputCloud (cloud_);
+  sd.setTargetCloud (cloud_t_);
+  sd.segment (expected_0);
+  ASSERT_EQ (127, expected_t.size ());
+  ASSERT_EQ (126, expected_0.size ());
+
+  for (const bool use_voxel_hash : {false, true})
+  {
+    for (const unsigned int nr_threads : {0u, 1u, 3u})
+    {
+      SCOPED_TRACE (use_voxel_hash);
+      SCOPED_TRACE (nr_threads);
+      sd.setUseVoxelHash (use_voxel_hash);
+      sd.setNumberOfThreads (nr_threads);
+      sd.setTargetCloud (cloud_);
+
+      // The index over the target is reused for a stream of input clouds
+      PointCloud<PointXYZ> output;
+      for (int frame = 0; frame < 2; ++frame)
+      {
+        sd.setInputCloud (cloud_);
+        sd.segment (output);
+        EXPECT_EQ (0, output.size ());
+
+        sd.setInputCloud (cloud_t_);
+        sd.segment (output);
+        ASSERT_EQ (expected_t.size (), output.size ());
+        for (std::size_t i = 0; i < output.size (); ++i)
+          EXPECT_EQ (expected_t[i].getVector3fMap (), output[i].getVector3fMap ());
+      }
+
+      sd.setInputCloud (cloud_);
+      sd.setTargetCloud (cloud_t_);
+      sd.segment (output);
+      ASSERT_EQ (expected_0.size (), output.size ());
+      for (std::size_t i = 0; i < output.size (); ++i)
+        EXPECT_EQ (expected_0[i].getVector3fMap (), output[i].getVector3fMap ());
+    }
+  }
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////
 TEST (ExtractPolygonalPrism, Segmentation)
 {
@@ -385,6 +965,74 @@ TEST (ExtractPolygonalPrism, Segmentation)
   EXPECT_EQ (output.indices.size (), 0);
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////
+TEST (ExtractPolygonalPrism, XYPolygonEdgeGrid)
+{
+  // A concave star with a vertical edge
+  PointCloud<PointXYZ> polygon;
+  for (int i = 0; i < 24; ++i)
+  {
+    const float angle = static_cast<float> (i) * 2.0f * static_cast<float> (M_PI) / 24.0f;
+    const float radius = (i % 2) ? 0.4f : 1.0f;
+    polygon.push_back (PointXYZ (radius * std::cos (angle), radius * std::sin (angle), 0.0f));
+  }
+  polygon.push_back (PointXYZ (polygon[0].x, -0.5f, 0.0f));
+
+  const XYPolygonEdgeGrid<PointXYZ> grid (polygon);
+  std::mt19937 rng (42);
+  std::uniform_real_distribution<float> coordinate (-1.2f, 1.2f);
+  for (int i = 0; i < 10000; ++i)
+  {
+    const PointXYZ point (coordinate (rng), coordinate (rng), 0.0f);
+    EXPECT_EQ (isXYPointIn2DXYPolygon (point, polygon), grid.isInside (point));
+  }
+  // Points on the vertices and their X coordinates
+  for (const auto &vertex : polygon)
+  {
+    EXPECT_EQ (isXYPointIn2DXYPolygon (vertex, polygon), grid.isInside (vertex));
+    const PointXYZ below (vertex.x, vertex.y - 0.1f, 0.0f);
+    EXPECT_EQ (isXYPointIn2DXYPolygon (below, polygon), grid.isInside (below));
+  }
+  EXPECT_FALSE (grid.isInside (std::numeric_limits<float>::quiet_NaN (), 0.0f));
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+TEST (ExtractPolygonalPrism, SegmentationThreads)
+{
+  // A unit square table at z = 0, seen from above
+  PointCloud<PointXYZ>::Ptr hull (new PointCloud<PointXYZ>);
+  hull->push_back (PointXYZ (0.0f, 0.0f, 0.0f));
+  hull->push_back (PointXYZ (1.0f, 0.0f, 0.0f));
+  hull->push_back (PointXYZ (1.0f, 1.0f, 0.0f));
+  hull->push_back (PointXYZ (0.0f, 1.0f, 0.0f));
+
+  PointCloud<PointXYZ>::Ptr cloud (new PointCloud<PointXYZ>);
+  std::mt19937 rng (7);
+  std::uniform_real_distribution<float> xy (-0.5f, 1.5f);
+  std::uniform_real_distribution<float> z (-0.5f, 1.0f);
+  Indices expected;
+  for (int i = 0; i < 20000; ++i)
+  {
+    const PointXYZ point (xy (rng), xy (rng), z (rng));
+    if (point.x > 0.0f && point.x < 1.0f && point.y > 0.0f && point.y < 1.0f && point.z >= 0.0f && point.z <= 0.5f)
+      expected.push_back (i);
+    cloud->push_back (point);
+  }
+
+  ExtractPolygonalPrismData<PointXYZ> ex;
+  ex.setInputCloud (cloud);
+  ex.setInputPlanarHull (hull);
+  ex.setHeightLimits (0.0, 0.5);
+  ex.setViewPoint (0.0f, 0.0f, 10.0f);
+  for (const unsigned int threads : {1u, 2u, 0u})
+  {
+    ex.setNumberOfThreads (threads);
+    PointIndices output;
+    ex.segment (output);
+    EXPECT_EQ (expected, output.indices);
+  }
+}
+
 /* ---[ */
 int
 main (int argc, char** argv)
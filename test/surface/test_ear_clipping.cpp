@@ -178,6 +178,72 @@ TEST (PCL, EarClippingCubeTest)
   }
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, EarClippingSpatialIndex)
+{
+  // Comb shaped polygon in a tilted plane, with many reflex vertices
+  const int nr_teeth = 300;
+  const Eigen::Vector3f origin (0.5f, -1.f, 2.f);
+  const Eigen::Vector3f axis_u = Eigen::Vector3f (1.f, 0.f, 1.f).normalized ();
+  const Eigen::Vector3f axis_v = Eigen::Vector3f (0.f, 1.f, 0.f);
+  std::vector<Eigen::Vector2f, Eigen::aligned_allocator<Eigen::Vector2f> > outline;
+  for (int i = 0; i < nr_teeth; ++i)
+  {
+    outline.emplace_back (0.02f * i, 1.f);
+    outline.emplace_back (0.02f * i + 0.01f, 0.1f + 0.5f * (i % 3));
+  }
+  outline.emplace_back (0.02f * nr_teeth, 1.f);
+  outline.emplace_back (0.02f * nr_teeth, 0.f);
+  outline.emplace_back (0.f, 0.f);
+
+  PointCloud<PointXYZ> cloud;
+  for (const auto &p : outline)
+  {
+    const Eigen::Vector3f point = origin + p.x () * axis_u + p.y () * axis_v;
+    cloud.emplace_back (point.x (), point.y (), point.z ());
+  }
+
+  // Area of the outline, it is clockwise in the (u, v) plane
+  float outline_area = 0.f;
+  for (std::size_t prev = outline.size () - 1, cur = 0; cur < outline.size (); prev = cur++)
+    outline_area += outline[prev].x () * outline[cur].y () - outline[cur].x () * outline[prev].y ();
+  outline_area = -0.5f * outline_area;
+  const Eigen::Vector3f normal = -axis_u.cross (axis_v);
+
+  for (const bool reverse : {false, true})
+  {
+    Vertices vertices;
+    for (std::size_t i = 0; i < cloud.size (); ++i)
+      vertices.vertices.push_back (static_cast<std::uint32_t> (reverse ? cloud.size () - 1 - i : i));
+
+    PolygonMesh::Ptr mesh (new PolygonMesh);
+    toPCLPointCloud2 (cloud, mesh->cloud);
+    mesh->polygons.push_back (vertices);
+
+    EarClipping clipper;
+    clipper.setUseSpatialIndex (true);
+    EXPECT_TRUE (clipper.getUseSpatialIndex ());
+    clipper.setInputMesh (mesh);
+    PolygonMesh triangulated_mesh;
+    clipper.process (triangulated_mesh);
+
+    // The triangles cover the polygon exactly once, with the winding of the input
+    ASSERT_EQ (cloud.size () - 2, triangulated_mesh.polygons.size ());
+    float total_area = 0.f;
+    for (const auto &triangle : triangulated_mesh.polygons)
+    {
+      ASSERT_EQ (3, triangle.vertices.size ());
+      const Eigen::Vector3f p0 = cloud[triangle.vertices[0]].getVector3fMap ();
+      const Eigen::Vector3f p1 = cloud[triangle.vertices[1]].getVector3fMap ();
+      const Eigen::Vector3f p2 = cloud[triangle.vertices[2]].getVector3fMap ();
+      const float triangle_area = 0.5f * (p1 - p0).cross (p2 - p0).dot (reverse ? -normal : normal);
+      EXPECT_GT (triangle_area, 0.f);
+      total_area += triangle_area;
+    }
+    EXPECT_NEAR (outline_area, total_area, 1e-3f);
+  }
+}
+
 /* ---[ */
 int
 main (int argc, char** argv)
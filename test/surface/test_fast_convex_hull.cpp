@@ -0,0 +1,262 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include <pcl/test/gtest.h>
+
+#include <map>
+#include <random>
+
+#include <pcl/point_types.h>
+#include <pcl/io/pcd_io.h>
+#include <pcl/surface/fast_convex_hull.h>
+
+using namespace pcl;
+using namespace pcl::io;
+
+PointCloud<PointXYZ>::Ptr cloud (new PointCloud<PointXYZ>);
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/** \brief Number of points of \a input farther than \a eps above one of the \a polygons (triangles) of \a hull. */
+std::size_t
+countOutside (const PointCloud<PointXYZ> &input, const PointCloud<PointXYZ> &hull, const std::vector<Vertices> &polygons,
+              double eps)
+{
+  std::size_t nr_outside = 0;
+  for (const auto &triangle : polygons)
+  {
+    const Eigen::Vector3d a = hull[triangle.vertices[0]].getVector3fMap ().cast<double> ();
+    const Eigen::Vector3d b = hull[triangle.vertices[1]].getVector3fMap ().cast<double> ();
+    const Eigen::Vector3d c = hull[triangle.vertices[2]].getVector3fMap ().cast<double> ();
+    const Eigen::Vector3d normal = (b - a).cross (c - a).normalized ();
+    for (const auto &point : input)
+      if (normal.dot (point.getVector3fMap ().cast<double> () - a) > eps)
+        ++nr_outside;
+  }
+  return (nr_outside);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, FastConvexHull_bunny)
+{
+  PointCloud<PointXYZ> hull;
+  std::vector<Vertices> polygons;
+
+  FastConvexHull<PointXYZ> chull;
+  chull.setInputCloud (cloud);
+  chull.reconstruct (hull, polygons);
+
+  EXPECT_EQ (chull.getDimension (), 3);
+  ASSERT_GT (hull.size (), 3);
+  EXPECT_EQ (polygons.size (), 2 * hull.size () - 4);
+  EXPECT_EQ (countOutside (*cloud, hull, polygons, 1e-6), 0);
+
+  // Every directed edge has exactly one opposite, i.e. the hull is closed and consistently oriented
+  std::map<std::pair<index_t, index_t>, int> edges;
+  for (const auto &triangle : polygons)
+    for (std::size_t k = 0; k < 3; ++k)
+      ++edges[std::make_pair (triangle.vertices[k], triangle.vertices[(k + 1) % 3])];
+  for (const auto &edge : edges)
+  {
+    EXPECT_EQ (edge.second, 1);
+    EXPECT_EQ (edges.count (std::make_pair (edge.first.second, edge.first.first)), 1);
+  }
+
+  PointIndices hull_indices;
+  chull.getHullPointIndices (hull_indices);
+  ASSERT_EQ (hull_indices.indices.size (), hull.size ());
+  for (std::size_t i = 0; i < hull.size (); ++i)
+  {
+    EXPECT_EQ ((*cloud)[hull_indices.indices[i]].x, hull[i].x);
+    EXPECT_EQ ((*cloud)[hull_indices.indices[i]].y, hull[i].y);
+    EXPECT_EQ ((*cloud)[hull_indices.indices[i]].z, hull[i].z);
+  }
+
+  // The PolygonMesh output holds the same hull
+  PolygonMesh mesh;
+  chull.reconstruct (mesh);
+  EXPECT_EQ (mesh.polygons.size (), polygons.size ());
+  EXPECT_EQ (mesh.cloud.width, hull.size ());
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, FastConvexHull_cube)
+{
+  PointCloud<PointXYZ>::Ptr input (new PointCloud<PointXYZ>);
+  for (int i = 0; i < 8; ++i)
+    input->push_back (PointXYZ (static_cast<float> (i & 1), static_cast<float> ((i >> 1) & 1), static_cast<float> ((i >> 2) & 1)));
+  std::mt19937 rng (12345u);
+  std::uniform_real_distribution<float> rand (0.01f, 0.99f);
+  for (int i = 0; i < 1000; ++i)
+    input->push_back (PointXYZ (rand (rng), rand (rng), rand (rng)));
+
+  PointCloud<PointXYZ> hull;
+  std::vector<Vertices> polygons;
+  FastConvexHull<PointXYZ> chull;
+  chull.setInputCloud (input);
+  chull.setComputeAreaVolume (true);
+  chull.reconstruct (hull, polygons);
+
+  EXPECT_EQ (hull.size (), 8);
+  EXPECT_EQ (polygons.size (), 12);
+  EXPECT_NEAR (chull.getTotalArea (), 6.0, 1e-6);
+  EXPECT_NEAR (chull.getTotalVolume (), 1.0, 1e-6);
+  for (const auto &point : hull)
+  {
+    EXPECT_TRUE (point.x == 0.0f || point.x == 1.0f);
+    EXPECT_TRUE (point.y == 0.0f || point.y == 1.0f);
+    EXPECT_TRUE (point.z == 0.0f || point.z == 1.0f);
+  }
+
+  // The same instance reuses its workspace for a smaller input, the corners and every other interior point
+  Indices indices;
+  for (std::size_t i = 0; i < input->size (); ++i)
+    if (i < 8 || i % 2 == 0)
+      indices.push_back (static_cast<index_t> (i));
+  chull.setIndices (pcl::make_shared<Indices> (indices));
+  chull.reconstruct (hull, polygons);
+  EXPECT_EQ (hull.size (), 8);
+  EXPECT_EQ (polygons.size (), 12);
+  EXPECT_NEAR (chull.getTotalVolume (), 1.0, 1e-6);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, FastConvexHull_planar)
+{
+  PointCloud<PointXYZ>::Ptr input (new PointCloud<PointXYZ>);
+  for (int i = 0; i < 4; ++i)
+    input->push_back (PointXYZ (static_cast<float> (i & 1), static_cast<float> ((i >> 1) & 1), 0.5f));
+  std::mt19937 rng (12345u);
+  std::uniform_real_distribution<float> rand (0.01f, 0.99f);
+  for (int i = 0; i < 100; ++i)
+    input->push_back (PointXYZ (rand (rng), rand (rng), 0.5f));
+
+  PointCloud<PointXYZ> hull;
+  std::vector<Vertices> polygons;
+  FastConvexHull<PointXYZ> chull;
+  chull.setInputCloud (input);
+  chull.setComputeAreaVolume (true);
+  chull.reconstruct (hull, polygons);
+
+  EXPECT_EQ (chull.getDimension (), 2);
+  EXPECT_EQ (hull.size (), 4);
+  ASSERT_EQ (polygons.size (), 1);
+  EXPECT_EQ (polygons[0].vertices.size (), 4);
+  EXPECT_NEAR (chull.getTotalArea (), 1.0, 1e-6);
+  EXPECT_EQ (chull.getTotalVolume (), 0.0);
+
+  // Forcing a 3D hull on planar data falls back to the 2D one
+  chull.setDimension (3);
+  chull.reconstruct (hull, polygons);
+  EXPECT_EQ (chull.getDimension (), 2);
+  EXPECT_EQ (hull.size (), 4);
+  EXPECT_NEAR (chull.getTotalArea (), 1.0, 1e-6);
+
+  // Collinear points have no hull
+  PointCloud<PointXYZ>::Ptr line (new PointCloud<PointXYZ>);
+  for (int i = 0; i < 10; ++i)
+    line->push_back (PointXYZ (static_cast<float> (i), 0.0f, 0.0f));
+  chull.setInputCloud (line);
+  chull.reconstruct (hull, polygons);
+  EXPECT_TRUE (hull.empty ());
+  EXPECT_TRUE (polygons.empty ());
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, FastConvexHull_parallel)
+{
+  // Hulls of the clusters computed with one instance per thread match the serial ones
+  const int nr_clusters = 64;
+  std::vector<PointCloud<PointXYZ>::Ptr> clusters (nr_clusters);
+  std::mt19937 rng (12345u);
+  std::normal_distribution<float> rand;
+  for (auto &cluster : clusters)
+  {
+    cluster.reset (new PointCloud<PointXYZ>);
+    for (int i = 0; i < 500; ++i)
+      cluster->push_back (PointXYZ (rand (rng), rand (rng), rand (rng)));
+  }
+
+  std::vector<std::size_t> serial (nr_clusters), parallel (nr_clusters);
+  FastConvexHull<PointXYZ> chull;
+  for (int i = 0; i < nr_clusters; ++i)
+  {
+    PointCloud<PointXYZ> hull;
+    chull.setInputCloud (clusters[i]);
+    chull.reconstruct (hull);
+    serial[i] = hull.size ();
+  }
+
+#pragma omp parallel default(none) shared(clusters, parallel) firstprivate(nr_clusters)
+  {
+    FastConvexHull<PointXYZ> local_hull;
+#pragma omp for schedule(dynamic)
+    for (int i = 0; i < nr_clusters; ++i)
+    {
+      PointCloud<PointXYZ> hull;
+      local_hull.setInputCloud (clusters[i]);
+      local_hull.reconstruct (hull);
+      parallel[i] = hull.size ();
+    }
+  }
+
+  for (int i = 0; i < nr_clusters; ++i)
+  {
+    EXPECT_GT (serial[i], 3);
+    EXPECT_EQ (serial[i], parallel[i]);
+  }
+}
+
+/* ---[ */
+int
+main (int argc, char** argv)
+{
+  if (argc < 2)
+  {
+    std::cerr << "No test file given. Please download `bun0.pcd` and pass its path to the test." << std::endl;
+    return (-1);
+  }
+
+  // Load file
+  pcl::PCLPointCloud2 cloud_blob;
+  loadPCDFile (argv[1], cloud_blob);
+  fromPCLPointCloud2 (cloud_blob, *cloud);
+
+  // Testing
+  testing::InitGoogleTest (&argc, argv);
+  return (RUN_ALL_TESTS ());
+}
+/* ]--- */
@@ -49,6 +49,8 @@
 #include <pcl/io/obj_io.h>
 #include <pcl/TextureMesh.h>
 #include <pcl/surface/texture_mapping.h>
+
+#include <map>
 using namespace pcl;
 using namespace pcl::io;
 
@@ -238,6 +240,57 @@ TEST (PCL, UpdateMesh_With_TextureMapping)
   }
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, GreedyProjectionTriangulation_Tiled)
+{
+  GreedyProjectionTriangulation<PointNormal> gp3;
+  gp3.setInputCloud (cloud_with_normals);
+  gp3.setSearchRadius (0.025);
+  gp3.setMu (2.5);
+  gp3.setMaximumNearestNeighbors (100);
+  gp3.setMaximumSurfaceAngle(M_PI/4); // 45 degrees
+  gp3.setMinimumAngle(M_PI/18); // 10 degrees
+  gp3.setMaximumAngle(2*M_PI/3); // 120 degrees
+  gp3.setNormalConsistency(false);
+
+  // Reference, triangulated all at once
+  std::vector<Vertices> reference;
+  gp3.reconstruct (reference);
+
+  gp3.setTileSize (0.05);
+  gp3.setNumberOfThreads (4);
+  PolygonMesh triangles;
+  gp3.reconstruct (triangles);
+  EXPECT_EQ (triangles.cloud.width, cloud_with_normals->width);
+  EXPECT_NEAR (double (triangles.polygons.size ()), double (reference.size ()), 0.2 * reference.size ());
+
+  // The seams are stitched: no edge has more than two triangles
+  std::map<std::pair<index_t, index_t>, int> edges;
+  for (const auto &triangle : triangles.polygons)
+  {
+    ASSERT_EQ (triangle.vertices.size (), 3u);
+    for (std::size_t i = 0; i < 3; ++i)
+    {
+      const index_t a = triangle.vertices[i], b = triangle.vertices[(i + 1) % 3];
+      EXPECT_LT (a, index_t (cloud_with_normals->size ()));
+      EXPECT_LE (++edges[std::make_pair (std::min (a, b), std::max (a, b))], 2);
+    }
+  }
+
+  // Streaming the tiles gives the same triangles, and nothing in the output
+  std::vector<Vertices> streamed;
+  gp3.setTileCallback ([&streamed] (const std::vector<Vertices> &tile)
+  {
+    streamed.insert (streamed.end (), tile.begin (), tile.end ());
+  });
+  std::vector<Vertices> polygons;
+  gp3.reconstruct (polygons);
+  EXPECT_TRUE (polygons.empty ());
+  ASSERT_EQ (streamed.size (), triangles.polygons.size ());
+  for (std::size_t i = 0; i < streamed.size (); ++i)
+    EXPECT_EQ (streamed[i].vertices, triangles.polygons[i].vertices);
+}
+
 /* ---[ */
 int
 main (int argc, char** argv)
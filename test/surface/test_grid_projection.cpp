@@ -81,6 +81,37 @@ TEST (PCL, GridProjection)
   EXPECT_EQ (int (grid.polygons.at (0).vertices.at (0)), 0);
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, GridProjectionParallel)
+{
+  PolygonMesh grid;
+  GridProjection<PointNormal> gp;
+  gp.setInputCloud (cloud_with_normals);
+  gp.setSearchMethod (tree2);
+  gp.setResolution (0.005);
+  gp.setPaddingSize (3);
+  gp.reconstruct (grid);
+
+  // The cells are processed in parallel, the surface is the same as with one thread
+  for (const unsigned int nr_threads : {0u, 4u})
+  {
+    SCOPED_TRACE (nr_threads);
+    PolygonMesh grid_parallel;
+    GridProjection<PointNormal> gp_parallel;
+    gp_parallel.setInputCloud (cloud_with_normals);
+    gp_parallel.setSearchMethod (tree2);
+    gp_parallel.setResolution (0.005);
+    gp_parallel.setPaddingSize (3);
+    gp_parallel.setNumberOfThreads (nr_threads);
+    EXPECT_EQ (nr_threads, gp_parallel.getNumberOfThreads ());
+    gp_parallel.reconstruct (grid_parallel);
+
+    ASSERT_EQ (grid.polygons.size (), grid_parallel.polygons.size ());
+    ASSERT_EQ (grid.cloud.data.size (), grid_parallel.cloud.data.size ());
+    EXPECT_TRUE (grid.cloud.data == grid_parallel.cloud.data);
+  }
+}
+
 /* ---[ */
 int
 main (int argc, char** argv)
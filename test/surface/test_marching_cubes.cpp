@@ -48,6 +48,7 @@
 #include <pcl/surface/marching_cubes_hoppe.h>
 #include <pcl/surface/marching_cubes_rbf.h>
 #include <pcl/common/common.h>
+#include <pcl/common/execution_context.h>
 
 using namespace pcl;
 using namespace pcl::io;
@@ -99,6 +100,102 @@ TEST (PCL, MarchingCubesTest)
   EXPECT_EQ (vertices[vertices.size ()/2].vertices[2], 4277);
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, MarchingCubesMultiThreaded)
+{
+  MarchingCubesHoppe<PointNormal> hoppe;
+  hoppe.setIsoLevel (0);
+  hoppe.setGridResolution (30, 30, 30);
+  hoppe.setPercentageExtendGrid (0.3f);
+  hoppe.setInputCloud (cloud_with_normals);
+  PointCloud<PointNormal> points;
+  std::vector<Vertices> vertices;
+  hoppe.reconstruct (points, vertices);
+
+  // 0 takes the threads from the budget of the execution context
+  const unsigned int budget = pcl::ExecutionContext::getThreadBudget ();
+  pcl::ExecutionContext::setThreadBudget (4);
+  for (const unsigned int nr_threads : {4u, 0u})
+  {
+    SCOPED_TRACE (nr_threads);
+    hoppe.setNumberOfThreads (nr_threads);
+    EXPECT_EQ (hoppe.getNumberOfThreads (), nr_threads);
+    PointCloud<PointNormal> points_mt;
+    std::vector<Vertices> vertices_mt;
+    hoppe.reconstruct (points_mt, vertices_mt);
+
+    ASSERT_EQ (points.size (), points_mt.size ());
+    ASSERT_EQ (vertices.size (), vertices_mt.size ());
+    for (std::size_t i = 0; i < points.size (); ++i)
+      EXPECT_EQ (points[i].getVector3fMap (), points_mt[i].getVector3fMap ());
+    for (std::size_t i = 0; i < vertices.size (); ++i)
+      EXPECT_EQ (vertices[i].vertices, vertices_mt[i].vertices);
+  }
+  pcl::ExecutionContext::setThreadBudget (budget);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, MarchingCubesSparseGrid)
+{
+  MarchingCubesHoppe<PointNormal> hoppe;
+  hoppe.setIsoLevel (0);
+  hoppe.setGridResolution (30, 30, 30);
+  hoppe.setPercentageExtendGrid (0.3f);
+  hoppe.setInputCloud (cloud_with_normals);
+  PointCloud<PointNormal> dense_points;
+  std::vector<Vertices> dense_vertices;
+  hoppe.reconstruct (dense_points, dense_vertices);
+
+  // With a margin covering the whole grid the same triangles are extracted, but the vertices are shared
+  hoppe.setSparseGrid (true, 30);
+  hoppe.setNumberOfThreads (4);
+  EXPECT_TRUE (hoppe.getSparseGrid ());
+  PointCloud<PointNormal> points;
+  std::vector<Vertices> vertices;
+  hoppe.reconstruct (points, vertices);
+  EXPECT_EQ (vertices.size (), dense_vertices.size ());
+  EXPECT_LT (points.size (), dense_points.size () / 3);
+
+  // Only the blocks close to the input points are evaluated
+  hoppe.setSparseGrid (true);
+  hoppe.reconstruct (points, vertices);
+  ASSERT_FALSE (vertices.empty ());
+  EXPECT_LT (points.size (), 3 * vertices.size ());
+  EXPECT_LE (vertices.size (), dense_vertices.size ());
+  EXPECT_GT (vertices.size (), dense_vertices.size () / 2);
+  for (const auto &polygon : vertices)
+  {
+    ASSERT_EQ (polygon.vertices.size (), 3u);
+    for (const auto &index : polygon.vertices)
+      ASSERT_LT (index, points.size ());
+  }
+
+  // The evaluated voxels hold the same values, so each vertex is also a vertex of the dense reconstruction
+  search::KdTree<PointNormal> dense_tree;
+  dense_tree.setInputCloud (dense_points.makeShared ());
+  const float max_distance = 1e-5f;
+  pcl::Indices nn_indices;
+  std::vector<float> nn_sqr_dists;
+  for (const auto &point : points)
+  {
+    dense_tree.nearestKSearch (point, 1, nn_indices, nn_sqr_dists);
+    EXPECT_LT (nn_sqr_dists[0], max_distance * max_distance);
+  }
+
+  // RBF evaluates its grid through the same code path
+  MarchingCubesRBF<PointNormal> rbf;
+  rbf.setIsoLevel (0);
+  rbf.setGridResolution (20, 20, 20);
+  rbf.setPercentageExtendGrid (0.1f);
+  rbf.setInputCloud (cloud_with_normals);
+  rbf.setOffSurfaceDisplacement (0.02f);
+  rbf.setSparseGrid (true);
+  rbf.setNumberOfThreads (4);
+  rbf.reconstruct (points, vertices);
+  ASSERT_FALSE (vertices.empty ());
+  EXPECT_LT (points.size (), 3 * vertices.size ());
+}
+
 
 /* ---[ */
 int
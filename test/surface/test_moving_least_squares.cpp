@@ -45,6 +45,9 @@
 #include <pcl/features/normal_3d.h>
 #include <pcl/surface/mls.h>
 
+#include <limits>
+#include <numeric>
+
 using namespace pcl;
 using namespace pcl::io;
 
@@ -140,7 +143,108 @@ TEST (PCL, MovingLeastSquares)
   EXPECT_NEAR (double (mls_normals->size ()), 29394, 2);
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, MovingLeastSquaresNeighborhoodCache)
+{
+  MLSNeighborhoodCache::Ptr cache (new MLSNeighborhoodCache);
+  for (const int order : {2, 3})
+  {
+    PointCloud<PointNormal> reference, cached;
+    MovingLeastSquares<PointXYZ, PointNormal> mls;
+    mls.setInputCloud (cloud);
+    mls.setComputeNormals (true);
+    mls.setPolynomialOrder (order);
+    mls.setSearchMethod (tree);
+    mls.setSearchRadius (0.03);
+    mls.process (reference);
+
+    // The second order reuses the neighborhoods searched for the first one
+    MovingLeastSquares<PointXYZ, PointNormal> mls_cached;
+    mls_cached.setInputCloud (cloud);
+    mls_cached.setComputeNormals (true);
+    mls_cached.setPolynomialOrder (order);
+    mls_cached.setSearchMethod (tree);
+    mls_cached.setSearchRadius (0.03);
+    mls_cached.setNeighborhoodCache (cache);
+    mls_cached.process (cached);
+    EXPECT_EQ (cache->size (), cloud->size ());
+
+    ASSERT_EQ (reference.size (), cached.size ());
+    for (std::size_t i = 0; i < reference.size (); ++i)
+    {
+      EXPECT_EQ (reference[i].getVector3fMap (), cached[i].getVector3fMap ());
+      EXPECT_EQ (reference[i].getNormalVector3fMap (), cached[i].getNormalVector3fMap ());
+    }
+  }
+
+  cache->clear ();
+  EXPECT_EQ (cache->size (), 0);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, MLSResultCubicFit)
+{
+  // Points sampled on a cubic surface are fitted exactly by a third order polynomial.
+  // The heights are uncorrelated with x and y on the grid, so that z is the normal of the MLS plane.
+  const double mean_sq = 0.011 / 3.0; // mean of x * x over the grid
+  const auto height = [mean_sq] (double x, double y) { return (0.5 * x * x - 0.3 * y * y + 0.4 * x * y + 2.0 * (x * x - mean_sq) * y); };
+  PointCloud<PointXYZ> surface;
+  for (int i = -10; i <= 10; ++i)
+    for (int j = -10; j <= 10; ++j)
+    {
+      const double x = 0.01 * i, y = 0.01 * j;
+      surface.push_back (PointXYZ (static_cast<float> (x), static_cast<float> (y), static_cast<float> (height (x, y))));
+    }
+  pcl::Indices nn_indices (surface.size ());
+  std::iota (nn_indices.begin (), nn_indices.end (), 0);
+
+  MLSResult result;
+  result.computeMLSSurface<PointXYZ> (surface, 220, nn_indices, 0.1, 3);
+  ASSERT_TRUE (result.valid);
+  ASSERT_EQ (result.c_vec.size (), 10);
+  for (const auto &point : surface)
+  {
+    double u, v, w;
+    result.getMLSCoordinates (point.getVector3fMap ().cast<double> (), u, v, w);
+    EXPECT_NEAR (w, result.getPolynomialValue (u, v), 1e-6);
+  }
+}
+
 #ifdef _OPENMP
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, MovingLeastSquaresParallelUpsampling)
+{
+  // Distinct cloud shifted from the input, with an invalid point
+  PointCloud<PointXYZ>::Ptr distinct_cloud (new PointCloud<PointXYZ> (*cloud));
+  for (auto &point : *distinct_cloud)
+    point.x += 0.002f;
+  (*distinct_cloud)[3].x = std::numeric_limits<float>::quiet_NaN ();
+
+  PointCloud<PointNormal> serial, parallel;
+  for (const unsigned int threads : {1u, 4u})
+  {
+    MovingLeastSquares<PointXYZ, PointNormal> mls;
+    mls.setInputCloud (cloud);
+    mls.setComputeNormals (true);
+    mls.setPolynomialOrder (2);
+    mls.setSearchMethod (tree);
+    mls.setSearchRadius (0.03);
+    mls.setUpsamplingMethod (MovingLeastSquares<PointXYZ, PointNormal>::DISTINCT_CLOUD);
+    mls.setDistinctCloud (distinct_cloud);
+    mls.setNumberOfThreads (threads);
+    mls.process (threads == 1 ? serial : parallel);
+  }
+
+  EXPECT_EQ (serial.size (), distinct_cloud->size () - 1);
+  ASSERT_EQ (serial.size (), parallel.size ());
+  for (std::size_t i = 0; i < serial.size (); ++i)
+  {
+    EXPECT_EQ (serial[i].getVector3fMap (), parallel[i].getVector3fMap ());
+    EXPECT_EQ (serial[i].getNormalVector3fMap (), parallel[i].getNormalVector3fMap ());
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 TEST (PCL, MovingLeastSquaresOMP)
 {
   // Init objects
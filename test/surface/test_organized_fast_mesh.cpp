@@ -108,6 +108,54 @@ TEST (PCL, Organized)
   EXPECT_EQ (int (triangles.polygons.at (0).vertices.at (2)), 1);
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, OrganizedIndexBuffer)
+{
+  //construct dataset
+  pcl::PointCloud<pcl::PointXYZ>::Ptr cloud_organized (new pcl::PointCloud<pcl::PointXYZ> (32, 24));
+  for (std::size_t i = 0; i < cloud_organized->height; i++)
+  {
+    for (std::size_t j = 0; j < cloud_organized->width; j++)
+    {
+      (*cloud_organized) (j, i).x = static_cast<float> (i);
+      (*cloud_organized) (j, i).y = static_cast<float> (j);
+      (*cloud_organized) (j, i).z = static_cast<float> (cloud_organized->size () + (i * 7 + j * 3) % 5);
+    }
+  }
+  for (std::size_t i = 3; i < cloud_organized->size (); i += 17)
+    (*cloud_organized)[i].x = (*cloud_organized)[i].y = (*cloud_organized)[i].z = std::numeric_limits<float>::quiet_NaN ();
+
+  const OrganizedFastMesh<PointXYZ>::TriangulationType types[] = {OrganizedFastMesh<PointXYZ>::TRIANGLE_RIGHT_CUT,
+                                                                  OrganizedFastMesh<PointXYZ>::TRIANGLE_LEFT_CUT,
+                                                                  OrganizedFastMesh<PointXYZ>::TRIANGLE_ADAPTIVE_CUT,
+                                                                  OrganizedFastMesh<PointXYZ>::QUAD_MESH};
+  for (const auto &type : types)
+  {
+    OrganizedFastMesh<PointXYZ> ofm;
+    ofm.setInputCloud (cloud_organized);
+    ofm.setMaxEdgeLength (2.5);
+    ofm.setTrianglePixelSize (2);
+    ofm.setTriangulationType (type);
+    ofm.setNumberOfThreads (3);
+
+    std::vector<Vertices> polygons;
+    ofm.reconstruct (polygons);
+    std::vector<std::uint32_t> indices;
+    ofm.reconstruct (indices);
+
+    // The flat buffer holds the same polygons, in the same order
+    const unsigned int vertices_per_polygon = (type == OrganizedFastMesh<PointXYZ>::QUAD_MESH ? 4 : 3);
+    EXPECT_EQ (ofm.getVerticesPerPolygon (), vertices_per_polygon);
+    ASSERT_EQ (indices.size (), polygons.size () * vertices_per_polygon);
+    EXPECT_GT (polygons.size (), 0);
+    std::vector<Vertices> converted;
+    OrganizedFastMesh<PointXYZ>::indicesToPolygons (indices, vertices_per_polygon, converted);
+    ASSERT_EQ (converted.size (), polygons.size ());
+    for (std::size_t i = 0; i < polygons.size (); ++i)
+      EXPECT_EQ (converted[i].vertices, polygons[i].vertices);
+  }
+}
+
 /* ---[ */
 int
 main (int argc, char** argv)
@@ -42,6 +42,7 @@
 #include <pcl/point_types.h>
 #include <pcl/io/pcd_io.h>
 #include <pcl/io/vtk_io.h>
+#include <pcl/io/ply_io.h>
 #include <pcl/features/normal_3d.h>
 #include <pcl/surface/poisson.h>
 #include <pcl/common/common.h>
@@ -91,6 +92,40 @@ TEST (PCL, Poisson)
   EXPECT_EQ (mesh.polygons[1000].vertices[2], 715);
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, PoissonStreamToPLY)
+{
+  Poisson<PointNormal> poisson;
+  poisson.setInputCloud (cloud_with_normals);
+  PolygonMesh mesh;
+  poisson.reconstruct (mesh);
+
+  // The streamed file holds the same mesh
+  ASSERT_TRUE (poisson.reconstruct ("poisson_stream.ply"));
+  PolygonMesh streamed;
+  ASSERT_EQ (loadPLYFile ("poisson_stream.ply", streamed), 0);
+  EXPECT_EQ (streamed.cloud.width * streamed.cloud.height, mesh.cloud.width * mesh.cloud.height);
+  ASSERT_EQ (streamed.polygons.size (), mesh.polygons.size ());
+  for (std::size_t i = 0; i < mesh.polygons.size (); ++i)
+    EXPECT_EQ (streamed.polygons[i].vertices, mesh.polygons[i].vertices);
+  remove ("poisson_stream.ply");
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, PoissonMaxMemory)
+{
+  Poisson<PointNormal> poisson;
+  poisson.setInputCloud (cloud_with_normals);
+  poisson.setDepth (10);
+  poisson.setMinDepth (5);
+  // Far too little memory for any depth, so the reconstruction falls back to the minimum depth
+  poisson.setMaxMemory (1);
+  PolygonMesh mesh;
+  poisson.reconstruct (mesh);
+  EXPECT_GT (mesh.polygons.size (), 0);
+  EXPECT_LT (mesh.polygons.size (), 4828);
+}
+
 /* ---[ */
 int
 main (int argc, char** argv)
@@ -0,0 +1,182 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include <pcl/test/gtest.h>
+
+#include <pcl/point_types.h>
+#include <pcl/conversions.h>
+#include <pcl/surface/texture_mapping.h>
+
+#include <cmath>
+
+using namespace pcl;
+
+// A square at z = 1 in front of a grid at z = 2, two cameras looking at them from both sides
+class TextureMappingTest : public ::testing::Test
+{
+  protected:
+    void
+    SetUp () override
+    {
+      PointCloud<PointXYZ> cloud;
+      cloud.push_back (PointXYZ (-0.15f, -0.15f, 1.0f));
+      cloud.push_back (PointXYZ ( 0.15f, -0.15f, 1.0f));
+      cloud.push_back (PointXYZ ( 0.15f,  0.15f, 1.0f));
+      cloud.push_back (PointXYZ (-0.15f,  0.15f, 1.0f));
+      faces_.push_back (makeFace (0, 1, 2));
+      faces_.push_back (makeFace (0, 2, 3));
+
+      for (int y = 0; y < 7; ++y)
+        for (int x = 0; x < 7; ++x)
+          cloud.push_back (PointXYZ (-0.6f + 0.2f * x, -0.6f + 0.2f * y, 2.0f));
+      for (int y = 0; y < 6; ++y)
+      {
+        for (int x = 0; x < 6; ++x)
+        {
+          const std::uint32_t a = 4 + y * 7 + x, b = a + 1, c = a + 7, d = c + 1;
+          faces_.push_back (makeFace (a, b, d));
+          faces_.push_back (makeFace (a, d, c));
+        }
+      }
+
+      // the vertices of the grid projecting inside the square are hidden from the first camera
+      for (const auto &face : faces_)
+      {
+        bool hidden = false;
+        for (const auto &vertex : face.vertices)
+          hidden |= (cloud[vertex].z > 1.5f && std::abs (cloud[vertex].x / cloud[vertex].z) < 0.15f &&
+                                                 std::abs (cloud[vertex].y / cloud[vertex].z) < 0.15f);
+        hidden_.push_back (hidden);
+      }
+      toPCLPointCloud2 (cloud, mesh_.cloud);
+      mesh_.tex_polygons.push_back (faces_);
+
+      texture_mapping::Camera front, back;
+      front.pose = Eigen::Affine3f::Identity ();
+      front.focal_length = 100.0;
+      front.width = 200.0;
+      front.height = 200.0;
+      back = front;
+      back.pose = Eigen::Translation3f (0.0f, 0.0f, 3.0f) * Eigen::AngleAxisf (static_cast<float> (M_PI), Eigen::Vector3f::UnitY ());
+      cameras_.push_back (front);
+      cameras_.push_back (back);
+    }
+
+    static Vertices
+    makeFace (std::uint32_t v1, std::uint32_t v2, std::uint32_t v3)
+    {
+      Vertices face;
+      face.vertices = {v1, v2, v3};
+      return (face);
+    }
+
+    TextureMesh mesh_;
+    std::vector<Vertices> faces_;
+    std::vector<bool> hidden_;
+    texture_mapping::CameraVector cameras_;
+};
+
+TEST_F (TextureMappingTest, MultipleCameras)
+{
+  for (const unsigned int threads : {0u, 1u, 2u})
+  {
+    TextureMesh mesh = mesh_;
+    TextureMapping<PointXYZ> tm;
+    tm.setNumberOfThreads (threads);
+    tm.textureMeshwithMultipleCameras (mesh, cameras_);
+
+    // the front camera takes the square and the visible part of the grid, the back camera the rest
+    ASSERT_EQ (3, mesh.tex_polygons.size ());
+    ASSERT_EQ (3, mesh.tex_coordinates.size ());
+    std::vector<Vertices> front_faces, back_faces;
+    for (std::size_t i = 0; i < faces_.size (); ++i)
+      (hidden_[i] ? back_faces : front_faces).push_back (faces_[i]);
+    ASSERT_EQ (front_faces.size (), mesh.tex_polygons[0].size ());
+    ASSERT_EQ (back_faces.size (), mesh.tex_polygons[1].size ());
+    EXPECT_TRUE (mesh.tex_polygons[2].empty ());
+    for (std::size_t i = 0; i < front_faces.size (); ++i)
+      EXPECT_EQ (front_faces[i].vertices, mesh.tex_polygons[0][i].vertices);
+    for (std::size_t i = 0; i < back_faces.size (); ++i)
+      EXPECT_EQ (back_faces[i].vertices, mesh.tex_polygons[1][i].vertices);
+
+    ASSERT_EQ (3 * front_faces.size (), mesh.tex_coordinates[0].size ());
+    ASSERT_EQ (3 * back_faces.size (), mesh.tex_coordinates[1].size ());
+    EXPECT_NEAR (0.425f, mesh.tex_coordinates[0][0] (0), 1e-5f);
+    EXPECT_NEAR (0.575f, mesh.tex_coordinates[0][0] (1), 1e-5f);
+    EXPECT_NEAR (0.575f, mesh.tex_coordinates[0][1] (0), 1e-5f);
+    EXPECT_NEAR (0.575f, mesh.tex_coordinates[0][1] (1), 1e-5f);
+  }
+}
+
+TEST_F (TextureMappingTest, NotVisible)
+{
+  // without the back camera, the hidden part of the grid is not textured
+  cameras_.pop_back ();
+  TextureMapping<PointXYZ> tm;
+  tm.textureMeshwithMultipleCameras (mesh_, cameras_);
+
+  ASSERT_EQ (2, mesh_.tex_polygons.size ());
+  ASSERT_EQ (2, mesh_.tex_coordinates.size ());
+  std::size_t nr_hidden = 0;
+  for (const bool hidden : hidden_)
+    nr_hidden += hidden;
+  EXPECT_LT (0, nr_hidden);
+  EXPECT_EQ (faces_.size () - nr_hidden, mesh_.tex_polygons[0].size ());
+  EXPECT_EQ (nr_hidden, mesh_.tex_polygons[1].size ());
+  ASSERT_EQ (3 * nr_hidden, mesh_.tex_coordinates[1].size ());
+  for (const auto &uv : mesh_.tex_coordinates[1])
+    EXPECT_EQ (-1.0f, uv (0));
+
+  // a camera looking away from the mesh does not see anything
+  TextureMesh mesh;
+  mesh.cloud = mesh_.cloud;
+  mesh.tex_polygons.push_back (faces_);
+  cameras_[0].pose = Eigen::AngleAxisf (static_cast<float> (M_PI), Eigen::Vector3f::UnitY ());
+  tm.textureMeshwithMultipleCameras (mesh, cameras_);
+  ASSERT_EQ (2, mesh.tex_polygons.size ());
+  EXPECT_TRUE (mesh.tex_polygons[0].empty ());
+  EXPECT_EQ (faces_.size (), mesh.tex_polygons[1].size ());
+}
+
+/* ---[ */
+int
+main (int argc, char** argv)
+{
+  testing::InitGoogleTest (&argc, argv);
+  return (RUN_ALL_TESTS ());
+}
+/* ]--- */
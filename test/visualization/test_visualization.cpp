@@ -101,6 +101,71 @@ TEST(PCL, PCLVisualizer_updatePointCloudRemovePoint)
     viewer->spinOnce(100);
   }
 }
+////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, LODPointCloud_selectPoints)
+{
+  pcl::common::CloudGenerator<pcl::PointXYZ, pcl::common::UniformGenerator<float> > generator;
+  pcl::PointCloud<pcl::PointXYZ>::Ptr large_cloud (new pcl::PointCloud<pcl::PointXYZ>);
+  generator.fill (20000, 1, *large_cloud);
+
+  LODPointCloud<PointXYZ> lod (256);
+  lod.setInputCloud (large_cloud);
+  lod.setPointBudget (5000);
+  EXPECT_GT (lod.getNumberOfNodes (), 1u);
+
+  // Without a camera, the coarsest levels that fit in the budget
+  pcl::Indices indices;
+  lod.selectPoints (indices);
+  EXPECT_LE (indices.size (), 5000u);
+  EXPECT_GE (indices.size (), 256u);
+
+  // Looking at the whole cloud with an unlimited budget and no error gives every point
+  Camera camera;
+  camera.pos[0] = 0.5; camera.pos[1] = 0.5; camera.pos[2] = 3.0;
+  camera.focal[0] = 0.5; camera.focal[1] = 0.5; camera.focal[2] = 0.5;
+  camera.view[0] = 0.0; camera.view[1] = 1.0; camera.view[2] = 0.0;
+  camera.clip[0] = 0.01; camera.clip[1] = 100.0;
+  camera.fovy = 60.0 * M_PI / 180.0;
+  camera.window_size[0] = 640; camera.window_size[1] = 480;
+  Eigen::Matrix4d view, projection;
+  camera.computeViewMatrix (view);
+  camera.computeProjectionMatrix (projection);
+  const Eigen::Vector3d eye (camera.pos[0], camera.pos[1], camera.pos[2]);
+
+  lod.setPointBudget (large_cloud->size ());
+  lod.setMaxScreenSpaceError (0.f);
+  lod.selectPoints (projection * view, eye, 640, 480, indices);
+  std::sort (indices.begin (), indices.end ());
+  EXPECT_EQ (std::unique (indices.begin (), indices.end ()) - indices.begin (), static_cast<std::ptrdiff_t> (large_cloud->size ()));
+
+  // The budget holds for any view
+  lod.setPointBudget (3000);
+  lod.selectPoints (projection * view, eye, 640, 480, indices);
+  EXPECT_LE (indices.size (), 3000u);
+
+  // Nothing is selected behind the camera
+  camera.focal[2] = 4.0;
+  camera.computeViewMatrix (view);
+  lod.selectPoints (projection * view, eye, 640, 480, indices);
+  EXPECT_TRUE (indices.empty ());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, PCLVisualizer_addLODPointCloud)
+{
+  pcl::common::CloudGenerator<pcl::PointXYZRGB, pcl::common::UniformGenerator<float> > generator;
+  pcl::PointCloud<pcl::PointXYZRGB>::Ptr large_cloud (new pcl::PointCloud<pcl::PointXYZRGB>);
+  generator.fill (20000, 1, *large_cloud);
+
+  PCLVisualizer visualizer;
+  EXPECT_TRUE (visualizer.addLODPointCloud<PointXYZRGB> (large_cloud, 5000, "lod cloud"));
+  EXPECT_FALSE (visualizer.addLODPointCloud<PointXYZRGB> (large_cloud, 5000, "lod cloud"));
+  visualizer.resetCamera ();
+  visualizer.spinOnce (100);
+  EXPECT_TRUE (visualizer.removePointCloud ("lod cloud"));
+  visualizer.spinOnce (100);
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 TEST (PCL, PCLVisualizer_camera)
 {
@@ -0,0 +1,256 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2010-2011, Willow Garage, Inc.
+ *  Copyright (c) 2012-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#pragma once
+
+#include <pcl/common/execution_context.h>
+#include <pcl/console/parse.h>
+#include <pcl/console/print.h>
+#include <boost/filesystem.hpp> // for path, exists, ...
+#include <boost/algorithm/string/case_conv.hpp> // for to_upper_copy
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <future>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace pcl
+{
+  namespace tools
+  {
+    /** \brief Settings of the directory processing mode shared by the command line tools. */
+    struct BatchOptions
+    {
+      /** \brief Directory holding the input PCD files. */
+      std::string input_dir;
+      /** \brief Directory the processed files are written to, under their input file name. */
+      std::string output_dir;
+      /** \brief Number of files processed concurrently, 0 for as many as the budget of pcl::ExecutionContext allows. */
+      unsigned int threads = 1;
+      /** \brief Leave files whose output already exists and is newer than the input untouched. */
+      bool skip_existing = false;
+    };
+
+    /** \brief Prints the help of the options parsed by parseBatchOptions.
+      * \param[in] default_threads the default of -batch_threads of the tool, 0 for as many as the thread budget allows
+      */
+    inline void
+    printBatchHelp (unsigned int default_threads = 1)
+    {
+      pcl::console::print_info ("                     -input_dir X  = batch process all PCD files found in input_dir\n");
+      pcl::console::print_info ("                     -output_dir X = save the processed files from input_dir in this directory\n");
+      pcl::console::print_info ("                     -batch_threads X = number of files processed in parallel in batch mode, 0 for as many as the thread budget allows (default: ");
+      pcl::console::print_value ("%u", default_threads); pcl::console::print_info (")\n");
+      pcl::console::print_info ("                     -skip_existing = in batch mode, skip the files whose output is already up to date\n");
+    }
+
+    /** \brief Parses -input_dir, -output_dir, -batch_threads and -skip_existing. Fields of
+      * options whose argument is not given keep their value, a thread count of 0 is resolved against the budget of
+      * pcl::ExecutionContext when the batch is run.
+      * \return 1 if batch mode was requested, 0 if not and -1 on error
+      */
+    inline int
+    parseBatchOptions (int argc, char** argv, BatchOptions &options)
+    {
+      if (pcl::console::parse_argument (argc, argv, "-input_dir", options.input_dir) == -1)
+        return (0);
+
+      PCL_INFO ("Input directory given as %s. Batch process mode on.\n", options.input_dir.c_str ());
+      if (pcl::console::parse_argument (argc, argv, "-output_dir", options.output_dir) == -1)
+      {
+        PCL_ERROR ("Need an output directory! Please use -output_dir to continue.\n");
+        return (-1);
+      }
+
+      pcl::console::parse_argument (argc, argv, "-batch_threads", options.threads);
+      options.skip_existing = pcl::console::find_switch (argc, argv, "-skip_existing");
+      return (1);
+    }
+
+    /** \brief Collects the PCD files of a directory, sorted by name.
+      * \return false if the directory does not exist
+      */
+    inline bool
+    listPCDFiles (const std::string &input_dir, std::vector<std::string> &pcd_files)
+    {
+      pcd_files.clear ();
+      if (input_dir.empty () || !boost::filesystem::exists (input_dir))
+      {
+        PCL_ERROR ("Batch processing mode enabled, but invalid input directory (%s) given!\n", input_dir.c_str ());
+        return (false);
+      }
+
+      boost::filesystem::directory_iterator end_itr;
+      for (boost::filesystem::directory_iterator itr (input_dir); itr != end_itr; ++itr)
+      {
+        // Only add PCD files
+        if (!is_directory (itr->status ()) && boost::algorithm::to_upper_copy (itr->path ().extension ().string ()) == ".PCD")
+          pcd_files.push_back (itr->path ().string ());
+      }
+      std::sort (pcd_files.begin (), pcd_files.end ());
+      PCL_INFO ("[Batch processing mode] Found %lu PCD files in %s.\n", pcd_files.size (), input_dir.c_str ());
+      return (true);
+    }
+
+    /** \brief Processes a list of files with a pool of workers.
+      *
+      * Every worker takes the next file from a shared queue and, while it runs process on the
+      * current file, already loads its next file in the background, so reading and decompressing
+      * overlap with the computation. The output of every file is output_dir/<input file name>.
+      * Throughput statistics are printed once all the files are done.
+      *
+      * The workers are reserved from pcl::ExecutionContext for the whole batch. A single worker
+      * runs on the calling thread and shares the reservation with the algorithms it calls, several
+      * workers run on their own threads and leave the algorithms only what remains of the budget.
+      *
+      * \param[in] pcd_files the files to process
+      * \param[in] options output directory, number of workers and skip policy
+      * \param[in] load bool (const std::string &input_file, Data &data), reads a file
+      * \param[in] process bool (Data &data, const std::string &output_file), computes and saves the result
+      * \return the number of files that failed
+      */
+    template <typename Data, typename Load, typename Process> std::size_t
+    runBatch (const std::vector<std::string> &pcd_files, const BatchOptions &options, Load load, Process process)
+    {
+      namespace fs = boost::filesystem;
+      if (!fs::exists (options.output_dir))
+        fs::create_directories (options.output_dir);
+
+      const auto outputFile = [&options] (const std::string &input_file)
+      {
+        return (options.output_dir + '/' + fs::path (input_file).filename ().string ());
+      };
+
+      std::atomic<std::size_t> next_file (0);
+      std::atomic<std::size_t> nr_processed (0), nr_skipped (0), nr_failed (0);
+      std::atomic<std::uintmax_t> bytes_read (0);
+
+      // Hands out the next file that still has to be processed, or pcd_files.size () when done
+      const auto takeFile = [&] ()
+      {
+        for (std::size_t i = next_file++; i < pcd_files.size (); i = next_file++)
+        {
+          if (options.skip_existing)
+          {
+            const std::string output_file = outputFile (pcd_files[i]);
+            boost::system::error_code ec;
+            if (fs::exists (output_file, ec) &&
+                fs::last_write_time (output_file, ec) >= fs::last_write_time (pcd_files[i], ec) && !ec)
+            {
+              ++nr_skipped;
+              continue;
+            }
+          }
+          return (i);
+        }
+        return (pcd_files.size ());
+      };
+
+      const auto loadFile = [&] (std::size_t i, Data &data)
+      {
+        if (!load (pcd_files[i], data))
+          return (false);
+        boost::system::error_code ec;
+        const std::uintmax_t size = fs::file_size (pcd_files[i], ec);
+        if (!ec)
+          bytes_read += size;
+        return (true);
+      };
+
+      const auto worker = [&] ()
+      {
+        std::size_t current = takeFile ();
+        Data current_data;
+        bool current_loaded = current < pcd_files.size () && loadFile (current, current_data);
+        while (current < pcd_files.size ())
+        {
+          // Prefetch the next file while the current one is processed
+          const std::size_t next = takeFile ();
+          Data next_data;
+          std::future<bool> next_loaded;
+          if (next < pcd_files.size ())
+            next_loaded = std::async (std::launch::async, loadFile, next, std::ref (next_data));
+
+          if (current_loaded && process (current_data, outputFile (pcd_files[current])))
+            ++nr_processed;
+          else
+          {
+            PCL_ERROR ("[Batch processing mode] Failed to process %s.\n", pcd_files[current].c_str ());
+            ++nr_failed;
+          }
+
+          current_loaded = next_loaded.valid () && next_loaded.get ();
+          current = next;
+          current_data = std::move (next_data);
+        }
+      };
+
+      const auto start = std::chrono::steady_clock::now ();
+      const pcl::ThreadReservation reservation (options.threads);
+      const unsigned int nr_workers = static_cast<unsigned int> (std::min<std::size_t> (reservation.getNumberOfThreads (), std::max<std::size_t> (pcd_files.size (), 1)));
+      if (nr_workers == 1)
+        worker ();
+      else
+      {
+        std::vector<std::thread> workers;
+        for (unsigned int i = 0; i < nr_workers; ++i)
+          workers.emplace_back (worker);
+        for (auto &thread : workers)
+          thread.join ();
+      }
+      const double seconds = std::chrono::duration<double> (std::chrono::steady_clock::now () - start).count ();
+
+      pcl::console::print_highlight ("[Batch processing mode] ");
+      pcl::console::print_info ("Processed "); pcl::console::print_value ("%lu", nr_processed.load ());
+      pcl::console::print_info (" files ("); pcl::console::print_value ("%lu", nr_skipped.load ());
+      pcl::console::print_info (" skipped, "); pcl::console::print_value ("%lu", nr_failed.load ());
+      pcl::console::print_info (" failed) in "); pcl::console::print_value ("%g", seconds);
+      pcl::console::print_info (" s with %u workers: ", nr_workers);
+      pcl::console::print_value ("%g", seconds > 0 ? static_cast<double> (nr_processed.load ()) / seconds : 0.0);
+      pcl::console::print_info (" files/s, ");
+      pcl::console::print_value ("%g", seconds > 0 ? static_cast<double> (bytes_read.load ()) / (1024.0 * 1024.0) / seconds : 0.0);
+      pcl::console::print_info (" MB/s read\n");
+
+      return (nr_failed);
+    }
+  }
+}
@@ -45,8 +45,8 @@
 #include <pcl/console/print.h>
 #include <pcl/console/parse.h>
 #include <pcl/console/time.h>
-#include <boost/filesystem.hpp> // for path, exists, ...
-#include <boost/algorithm/string/case_conv.hpp> // for to_upper_copy
+
+#include "batch_processing.h"
 
 using namespace pcl;
 using namespace pcl::io;
@@ -66,8 +66,7 @@ printHelp (int, char **argv)
   print_value ("%f", default_k); print_info (")\n");
   print_info (" For organized datasets, an IntegralImageNormalEstimation approach will be used, with the RADIUS given value as SMOOTHING SIZE.\n");
   print_info ("\nOptional arguments are:\n");
-  print_info ("                     -input_dir X  = batch process all PCD files found in input_dir\n");
-  print_info ("                     -output_dir X = save the processed files from input_dir in this directory\n");
+  tools::printBatchHelp (0);
 }
 
 bool
@@ -129,33 +128,32 @@ saveCloud (const std::string &filename, const pcl::PCLPointCloud2 &output,
   w.writeBinaryCompressed (filename, output, translation, orientation);
 }
 
-int
-batchProcess (const std::vector<std::string> &pcd_files, std::string &output_dir, int k, double radius)
+struct InputCloud
 {
-#pragma omp parallel for \
-  default(none) \
-  shared(k, output_dir, pcd_files, radius)
-  for (int i = 0; i < int (pcd_files.size ()); ++i)
-  {
-    // Load the first file
-    Eigen::Vector4f translation;
-    Eigen::Quaternionf rotation;
-    pcl::PCLPointCloud2::Ptr cloud (new pcl::PCLPointCloud2);
-    if (!loadCloud (pcd_files[i], *cloud, translation, rotation)) 
-      continue;
+  pcl::PCLPointCloud2::Ptr cloud;
+  Eigen::Vector4f translation;
+  Eigen::Quaternionf rotation;
+};
 
-    // Perform the feature estimation
-    pcl::PCLPointCloud2 output;
-    compute (cloud, output, k, radius);
-
-    // Prepare output file name
-    std::string filename = boost::filesystem::path(pcd_files[i]).filename().string();
-    
-    // Save into the second file
-    const std::string filepath = output_dir + '/' + filename;
-    saveCloud (filepath, output, translation, rotation);
-  }
-  return (0);
+std::size_t
+batchProcess (const std::vector<std::string> &pcd_files, const tools::BatchOptions &options, int k, double radius)
+{
+  return (tools::runBatch<InputCloud> (pcd_files, options,
+    [] (const std::string &filename, InputCloud &input)
+    {
+      input.cloud.reset (new pcl::PCLPointCloud2);
+      return (loadCloud (filename, *input.cloud, input.translation, input.rotation));
+    },
+    [k, radius] (InputCloud &input, const std::string &filepath)
+    {
+      // Perform the feature estimation
+      pcl::PCLPointCloud2 output;
+      compute (input.cloud, output, k, radius);
+
+      // Save into the output directory
+      saveCloud (filepath, output, input.translation, input.rotation);
+      return (true);
+    }));
 }
 
 /* ---[ */
@@ -170,26 +168,17 @@ main (int argc, char** argv)
     return (-1);
   }
 
-  bool batch_mode = false;
-
   // Command line parsing
   int k = default_k;
   double radius = default_radius;
   parse_argument (argc, argv, "-k", k);
   parse_argument (argc, argv, "-radius", radius);
-  std::string input_dir, output_dir;
-  if (parse_argument (argc, argv, "-input_dir", input_dir) != -1)
-  {
-    PCL_INFO ("Input directory given as %s. Batch process mode on.\n", input_dir.c_str ());
-    if (parse_argument (argc, argv, "-output_dir", output_dir) == -1)
-    {
-      PCL_ERROR ("Need an output directory! Please use -output_dir to continue.\n");
-      return (-1);
-    }
-
-    // Both input dir and output dir given, switch into batch processing mode
-    batch_mode = true;
-  }
+  tools::BatchOptions batch_options;
+  batch_options.threads = 0; // as many files as the thread budget allows by default
+  const int batch_state = tools::parseBatchOptions (argc, argv, batch_options);
+  if (batch_state == -1)
+    return (-1);
+  const bool batch_mode = (batch_state == 1);
 
   if (!batch_mode)
   {
@@ -221,26 +210,11 @@ main (int argc, char** argv)
   }
   else
   {
-    if (!input_dir.empty() && boost::filesystem::exists (input_dir))
-    {
-      std::vector<std::string> pcd_files;
-      boost::filesystem::directory_iterator end_itr;
-      for (boost::filesystem::directory_iterator itr (input_dir); itr != end_itr; ++itr)
-      {
-        // Only add PCD files
-        if (!is_directory (itr->status ()) && boost::algorithm::to_upper_copy (boost::filesystem::extension (itr->path ())) == ".PCD" )
-        {
-          pcd_files.push_back (itr->path ().string ());
-          PCL_INFO ("[Batch processing mode] Added %s for processing.\n", itr->path ().string ().c_str ());
-        }
-      }
-      batchProcess (pcd_files, output_dir, k, radius);
-    }
-    else
-    {
-      PCL_ERROR ("Batch processing mode enabled, but invalid input directory (%s) given!\n", input_dir.c_str ());
+    std::vector<std::string> pcd_files;
+    if (!tools::listPCDFiles (batch_options.input_dir, pcd_files))
+      return (-1);
+    if (batchProcess (pcd_files, batch_options, k, radius) != 0)
       return (-1);
-    }
   }
 }
 
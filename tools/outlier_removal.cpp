@@ -45,6 +45,8 @@
 #include <pcl/filters/statistical_outlier_removal.h>
 #include <pcl/filters/extract_indices.h>
 
+#include "batch_processing.h"
+
 using namespace pcl;
 using namespace pcl::io;
 using namespace pcl::console;
@@ -76,6 +78,8 @@ printHelp (int, char **argv)
   print_info ("                     -negative X = decides whether the inliers should be returned (1), or the outliers (0). (default: ");
   print_value ("%d", default_negative); print_info (")\n");
   print_info ("                     -keep_organized = keep the filtered points in organized format.\n");
+  print_info ("\nOptional arguments are:\n");
+  tools::printBatchHelp ();
 }
 
 bool
@@ -190,6 +194,42 @@ saveCloud (const std::string &filename, const pcl::PCLPointCloud2 &output,
   print_info ("[done, "); print_value ("%g", tt.toc ()); print_info (" ms : "); print_value ("%d", output.width * output.height); print_info (" points]\n");
 }
 
+struct InputCloud
+{
+  pcl::PCLPointCloud2::Ptr cloud;
+  Eigen::Vector4f translation;
+  Eigen::Quaternionf rotation;
+};
+
+std::size_t
+batchProcess (const std::vector<std::string> &pcd_files, const tools::BatchOptions &options,
+              const std::string &method, int min_pts, double radius,
+              int mean_k, double std_dev_mul, bool negative, bool keep_organized)
+{
+  return (tools::runBatch<InputCloud> (pcd_files, options,
+    [] (const std::string &filename, InputCloud &input)
+    {
+      input.cloud.reset (new pcl::PCLPointCloud2);
+      return (loadCloud (filename, *input.cloud, input.translation, input.rotation));
+    },
+    [&] (InputCloud &input, const std::string &filepath)
+    {
+      if (keep_organized && input.cloud->height == 1)
+      {
+        print_error ("Point cloud dataset is not organized (height = %d), but -keep_organized requested!\n", input.cloud->height);
+        return (false);
+      }
+
+      // Do the filtering
+      pcl::PCLPointCloud2 output;
+      compute (input.cloud, output, method, min_pts, radius, mean_k, std_dev_mul, negative, keep_organized);
+
+      // Save into the output directory
+      saveCloud (filepath, output, input.translation, input.rotation);
+      return (true);
+    }));
+}
+
 /* ---[ */
 int
 main (int argc, char** argv)
@@ -202,10 +242,16 @@ main (int argc, char** argv)
     return (-1);
   }
 
+  tools::BatchOptions batch_options;
+  const int batch_state = tools::parseBatchOptions (argc, argv, batch_options);
+  if (batch_state == -1)
+    return (-1);
+  const bool batch_mode = (batch_state == 1);
+
   // Parse the command line arguments for .pcd files
   std::vector<int> p_file_indices;
   p_file_indices = parse_file_extension_argument (argc, argv, ".pcd");
-  if (p_file_indices.size () != 2)
+  if (!batch_mode && p_file_indices.size () != 2)
   {
     print_error ("Need one input PCD file and one output PCD file to continue.\n");
     return (-1);
@@ -228,6 +274,14 @@ main (int argc, char** argv)
   parse_argument (argc, argv, "-negative", negative);
   bool keep_organized = find_switch (argc, argv, "-keep_organized");
 
+  if (batch_mode)
+  {
+    std::vector<std::string> pcd_files;
+    if (!tools::listPCDFiles (batch_options.input_dir, pcd_files))
+      return (-1);
+    return (batchProcess (pcd_files, batch_options, method, min_pts, radius, mean_k, std_dev_mul, negative, keep_organized) != 0 ? -1 : 0);
+  }
+
   // Load the first file
   Eigen::Vector4f translation;
   Eigen::Quaternionf rotation;
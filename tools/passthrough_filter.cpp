@@ -42,8 +42,8 @@
 #include <pcl/console/parse.h>
 #include <pcl/console/time.h>
 #include <pcl/filters/passthrough.h>
-#include <boost/filesystem.hpp> // for path, exists, ...
-#include <boost/algorithm/string/case_conv.hpp> // for to_upper_copy
+
+#include "batch_processing.h"
 
 using namespace pcl;
 using namespace pcl::io;
@@ -70,6 +70,8 @@ printHelp (int, char **argv)
   print_value ("%d", default_inside); print_info (")\n");
   print_info ("                     -keep 0/1 = keep the points organized (1) or not (default: ");
   print_value ("%d", default_keep_organized); print_info (")\n");
+  print_info ("\nOptional arguments are:\n");
+  tools::printBatchHelp ();
 }
 
 bool
@@ -122,33 +124,28 @@ saveCloud (const std::string &filename, const pcl::PCLPointCloud2 &output)
   print_info ("[done, "); print_value ("%g", tt.toc ()); print_info (" ms : "); print_value ("%d", output.width * output.height); print_info (" points]\n");
 }
 
-int
-batchProcess (const std::vector<std::string> &pcd_files, std::string &output_dir,
+std::size_t
+batchProcess (const std::vector<std::string> &pcd_files, const tools::BatchOptions &options,
               const std::string &field_name, float min, float max, bool inside, bool keep_organized)
 {
-  std::vector<std::string> st;
-  for (const auto &pcd_file : pcd_files)
-  {
-    // Load the first file
-    pcl::PCLPointCloud2::Ptr cloud (new pcl::PCLPointCloud2);
-    if (!loadCloud (pcd_file, *cloud)) 
-      return (-1);
-
-    // Perform the feature estimation
-    pcl::PCLPointCloud2 output;
-    compute (cloud, output, field_name, min, max, inside, keep_organized);
-
-    // Prepare output file name
-    std::string filename = boost::filesystem::path(pcd_file).filename().string();
-    
-    // Save into the second file
-    const std::string filepath = output_dir + '/' + filename;
-    saveCloud (filepath, output);
-  }
-  return (0);
+  return (tools::runBatch<pcl::PCLPointCloud2::Ptr> (pcd_files, options,
+    [] (const std::string &filename, pcl::PCLPointCloud2::Ptr &cloud)
+    {
+      cloud.reset (new pcl::PCLPointCloud2);
+      return (loadCloud (filename, *cloud));
+    },
+    [&] (pcl::PCLPointCloud2::Ptr &cloud, const std::string &filepath)
+    {
+      // Perform the filtering
+      pcl::PCLPointCloud2 output;
+      compute (cloud, output, field_name, min, max, inside, keep_organized);
+
+      // Save into the output directory
+      saveCloud (filepath, output);
+      return (true);
+    }));
 }
 
-
 /* ---[ */
 int
 main (int argc, char** argv)
@@ -161,8 +158,6 @@ main (int argc, char** argv)
     return (-1);
   }
 
-  bool batch_mode = false;
-
   // Command line parsing
   float min = default_min, max = default_max;
   bool inside = default_inside;
@@ -173,19 +168,11 @@ main (int argc, char** argv)
   parse_argument (argc, argv, "-inside", inside);
   parse_argument (argc, argv, "-field", field_name);
   parse_argument (argc, argv, "-keep", keep_organized);
-  std::string input_dir, output_dir;
-  if (parse_argument (argc, argv, "-input_dir", input_dir) != -1)
-  {
-    PCL_INFO ("Input directory given as %s. Batch process mode on.\n", input_dir.c_str ());
-    if (parse_argument (argc, argv, "-output_dir", output_dir) == -1)
-    {
-      PCL_ERROR ("Need an output directory! Please use -output_dir to continue.\n");
-      return (-1);
-    }
-
-    // Both input dir and output dir given, switch into batch processing mode
-    batch_mode = true;
-  }
+  tools::BatchOptions batch_options;
+  const int batch_state = tools::parseBatchOptions (argc, argv, batch_options);
+  if (batch_state == -1)
+    return (-1);
+  const bool batch_mode = (batch_state == 1);
 
   if (!batch_mode)
   {
@@ -212,25 +199,10 @@ main (int argc, char** argv)
   }
   else
   {
-    if (!input_dir.empty() && boost::filesystem::exists (input_dir))
-    {
-      std::vector<std::string> pcd_files;
-      boost::filesystem::directory_iterator end_itr;
-      for (boost::filesystem::directory_iterator itr (input_dir); itr != end_itr; ++itr)
-      {
-        // Only add PCD files
-        if (!is_directory (itr->status ()) && boost::algorithm::to_upper_copy (boost::filesystem::extension (itr->path ())) == ".PCD" )
-        {
-          pcd_files.push_back (itr->path ().string ());
-          PCL_INFO ("[Batch processing mode] Added %s for processing.\n", itr->path ().string ().c_str ());
-        }
-      }
-      batchProcess (pcd_files, output_dir, field_name, min, max, inside, keep_organized);
-    }
-    else
-    {
-      PCL_ERROR ("Batch processing mode enabled, but invalid input directory (%s) given!\n", input_dir.c_str ());
+    std::vector<std::string> pcd_files;
+    if (!tools::listPCDFiles (batch_options.input_dir, pcd_files))
+      return (-1);
+    if (batchProcess (pcd_files, batch_options, field_name, min, max, inside, keep_organized) != 0)
       return (-1);
-    }
   }
 }
@@ -42,6 +42,7 @@
 
 // PCL
 #include <pcl/common/common.h>
+#include <pcl/common/transforms.h>
 #include <pcl/io/pcd_io.h>
 #include <cfloat>
 #include <pcl/visualization/pcl_visualizer.h>
@@ -69,6 +70,20 @@ using GeometryHandlerConstPtr = GeometryHandler::ConstPtr;
 #define NORMALS_SCALE 0.01f
 #define PC_SCALE 0.001f
 
+template <typename PointT> bool
+addLODCloud (pcl::visualization::PCLVisualizer &p, const pcl::PCLPointCloud2 &blob,
+             const Eigen::Vector4f &origin, const Eigen::Quaternionf &orientation,
+             int point_budget, const std::string &id, int viewport)
+{
+  typename pcl::PointCloud<PointT>::Ptr cloud (new pcl::PointCloud<PointT>);
+  pcl::fromPCLPointCloud2 (blob, *cloud);
+  // The hierarchy is selected in world coordinates, so apply the sensor pose to the points
+  Eigen::Affine3f pose (Eigen::Translation3f (origin.head<3> ()) * orientation);
+  if (!pose.matrix ().isIdentity ())
+    pcl::transformPointCloud (*cloud, *cloud, pose);
+  return (p.addLODPointCloud<PointT> (cloud, point_budget, id, viewport));
+}
+
 bool
 isValidFieldName (const std::string &field)
 {
@@ -136,6 +151,9 @@ printHelp (int, char **argv)
   print_info ("                                                Note: the use of VBOs will enable the visualization of larger datasets at the expense of extra RAM.\n");
   print_info ("                                                See http://en.wikipedia.org/wiki/Vertex_Buffer_Object for more information.\n");
   print_info ("\n");
+  print_info ("                     -lod X                   = draw at most X points of each cloud, chosen for the current view from a level of detail octree (default "); print_value ("disabled"); print_info (")\n");
+  print_info ("                                                Note: use it to browse clouds that are too large to be drawn at once. The clouds are colored by their rgb field and the color and normal options are ignored.\n");
+  print_info ("\n");
   print_info ("                     -use_point_picking       = enable the usage of picking points on screen (default "); print_value ("disabled"); print_info (")\n");
   print_info ("\n");
   print_info ("                     -optimal_label_colors    = maps existing labels to the optimal sequential glasbey colors, label_ids will not be mapped to fixed colors (default "); print_value ("disabled"); print_info (")\n");
@@ -275,6 +293,11 @@ main (int argc, char** argv)
   if (use_vbos) 
     print_highlight ("Vertex Buffer Object (VBO) visualization enabled.\n");
 
+  int lod_budget = 0;
+  pcl::console::parse_argument (argc, argv, "-lod", lod_budget);
+  if (lod_budget > 0)
+    print_highlight ("Level of detail rendering enabled with a budget of %d points.\n", lod_budget);
+
   bool use_pp   = pcl::console::find_switch (argc, argv, "-use_point_picking");
   if (use_pp) 
     print_highlight ("Point picking enabled.\n");
@@ -511,6 +534,20 @@ main (int argc, char** argv)
       return (-1);
     }
 
+    if (lod_budget > 0)
+    {
+      if (pcl::getFieldIndex (*cloud, "rgb") != -1 || pcl::getFieldIndex (*cloud, "rgba") != -1)
+        addLODCloud<pcl::PointXYZRGB> (*p, *cloud, origin, orientation, lod_budget, cloud_name, viewport);
+      else
+        addLODCloud<pcl::PointXYZ> (*p, *cloud, origin, orientation, lod_budget, cloud_name, viewport);
+
+      if (mview)
+        p->addText (argv[p_file_indices.at (i)], 5, 5, 10, 1.0, 1.0, 1.0, "text_" + std::string (argv[p_file_indices.at (i)]), viewport);
+
+      print_info ("[done, "); print_value ("%g", tt.toc ()); print_info (" ms : "); print_value ("%u", cloud->width * cloud->height); print_info (" points]\n");
+      continue;
+    }
+
     // If no color was given, get random colors
     if (fcolorparam)
     {
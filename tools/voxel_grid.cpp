@@ -43,6 +43,8 @@
 #include <pcl/console/parse.h>
 #include <pcl/console/time.h>
 
+#include "batch_processing.h"
+
 using namespace pcl;
 using namespace pcl::io;
 using namespace pcl::console;
@@ -65,6 +67,8 @@ printHelp (int, char **argv)
   print_value ("-inf"); print_info (")\n");
   print_info ("                     -fmax  X      = filter all data with values along the specified field larger than this value (default: "); 
   print_value ("inf"); print_info (")\n");
+  print_info ("\nOptional arguments are:\n");
+  tools::printBatchHelp ();
 }
 
 bool
@@ -115,6 +119,28 @@ saveCloud (const std::string &filename, const pcl::PCLPointCloud2 &output)
   print_info ("[done, "); print_value ("%g", tt.toc ()); print_info (" ms : "); print_value ("%d", output.width * output.height); print_info (" points]\n");
 }
 
+std::size_t
+batchProcess (const std::vector<std::string> &pcd_files, const tools::BatchOptions &options,
+              float leaf_x, float leaf_y, float leaf_z, const std::string &field, double fmin, double fmax)
+{
+  return (tools::runBatch<pcl::PCLPointCloud2::Ptr> (pcd_files, options,
+    [] (const std::string &filename, pcl::PCLPointCloud2::Ptr &cloud)
+    {
+      cloud.reset (new pcl::PCLPointCloud2);
+      return (loadCloud (filename, *cloud));
+    },
+    [&] (pcl::PCLPointCloud2::Ptr &cloud, const std::string &filepath)
+    {
+      // Apply the voxel grid
+      pcl::PCLPointCloud2 output;
+      compute (cloud, output, leaf_x, leaf_y, leaf_z, field, fmin, fmax);
+
+      // Save into the output directory
+      saveCloud (filepath, output);
+      return (true);
+    }));
+}
+
 /* ---[ */
 int
 main (int argc, char** argv)
@@ -127,10 +153,16 @@ main (int argc, char** argv)
     return (-1);
   }
 
+  tools::BatchOptions batch_options;
+  const int batch_state = tools::parseBatchOptions (argc, argv, batch_options);
+  if (batch_state == -1)
+    return (-1);
+  const bool batch_mode = (batch_state == 1);
+
   // Parse the command line arguments for .pcd files
   std::vector<int> p_file_indices;
   p_file_indices = parse_file_extension_argument (argc, argv, ".pcd");
-  if (p_file_indices.size () != 2)
+  if (!batch_mode && p_file_indices.size () != 2)
   {
     print_error ("Need one input PCD file and one output PCD file to continue.\n");
     return (-1);
@@ -177,6 +209,14 @@ main (int argc, char** argv)
   else
     print_value ("%f\n", fmax);
 
+  if (batch_mode)
+  {
+    std::vector<std::string> pcd_files;
+    if (!tools::listPCDFiles (batch_options.input_dir, pcd_files))
+      return (-1);
+    return (batchProcess (pcd_files, batch_options, leaf_x, leaf_y, leaf_z, field, fmin, fmax) != 0 ? -1 : 0);
+  }
+
   // Load the first file
   pcl::PCLPointCloud2::Ptr cloud (new pcl::PCLPointCloud2);
   if (!loadCloud (argv[p_file_indices[0]], *cloud)) 
@@ -0,0 +1,126 @@
+#pragma once
+
+#include <pcl/tracking/nearest_pair_point_cloud_coherence.h>
+
+#include <Eigen/Core>
+
+namespace pcl {
+namespace tracking {
+/** \brief @b DistanceFieldPointCloudCoherence computes coherence between
+ * two pointclouds using nearest point pairs that are looked up in a voxel
+ * distance field of the target cloud.
+ *
+ * The field is built once per target cloud in initCompute(): every voxel of a
+ * regular grid around the target stores the index of the target point closest
+ * to its center. The pairing of a source point then costs one voxel lookup
+ * instead of a search, which makes the evaluation of many particles against
+ * the same target cloud much cheaper. The pairs are approximate up to the
+ * resolution of the grid; the maximum distance is still checked against the
+ * exact distance of the pair.
+ * \ingroup tracking
+ */
+template <typename PointInT>
+class DistanceFieldPointCloudCoherence
+: public NearestPairPointCloudCoherence<PointInT> {
+public:
+  using PointCoherencePtr =
+      typename NearestPairPointCloudCoherence<PointInT>::PointCoherencePtr;
+  using PointCloudInConstPtr =
+      typename NearestPairPointCloudCoherence<PointInT>::PointCloudInConstPtr;
+  using NearestPairPointCloudCoherence<PointInT>::maximum_distance_;
+  using NearestPairPointCloudCoherence<PointInT>::target_input_;
+  using NearestPairPointCloudCoherence<PointInT>::point_coherences_;
+  using NearestPairPointCloudCoherence<PointInT>::coherence_name_;
+  using NearestPairPointCloudCoherence<PointInT>::new_target_;
+  using NearestPairPointCloudCoherence<PointInT>::getClassName;
+
+  using Ptr = shared_ptr<DistanceFieldPointCloudCoherence<PointInT>>;
+  using ConstPtr = shared_ptr<const DistanceFieldPointCloudCoherence<PointInT>>;
+
+  /** \brief empty constructor */
+  DistanceFieldPointCloudCoherence()
+  : NearestPairPointCloudCoherence<PointInT>()
+  , resolution_(0.01f)
+  , min_p_(Eigen::Vector3f::Zero())
+  , dims_(Eigen::Vector3i::Zero())
+  {
+    coherence_name_ = "DistanceFieldPointCloudCoherence";
+  }
+
+  /** \brief set the edge length of the voxels of the distance field.
+   * \param[in] resolution the voxel size in meters.
+   */
+  inline void
+  setResolution(float resolution)
+  {
+    resolution_ = resolution;
+    new_target_ = true;
+  }
+
+  /** \brief get the edge length of the voxels of the distance field. */
+  inline float
+  getResolution() const
+  {
+    return (resolution_);
+  }
+
+  /** \brief get the minimum corner of the distance field. */
+  inline const Eigen::Vector3f&
+  getGridMinimum() const
+  {
+    return (min_p_);
+  }
+
+  /** \brief get the number of voxels of the distance field in x, y and z. */
+  inline const Eigen::Vector3i&
+  getGridDimensions() const
+  {
+    return (dims_);
+  }
+
+  /** \brief get the index of the closest target point per voxel (x varies fastest),
+   * UNAVAILABLE if there is none within the maximum distance. */
+  inline const std::vector<index_t>&
+  getNearestIndices() const
+  {
+    return (nearest_indices_);
+  }
+
+protected:
+  /** \brief This method should get called before starting the actual
+   * computation. Builds the distance field if the target cloud changed.
+   */
+  bool
+  initCompute() override;
+
+  /** \brief compute the nearest pairs using the distance field and compute
+   * coherence using point_coherences_
+   */
+  void
+  computeCoherence(const PointCloudInConstPtr& cloud,
+                   const IndicesConstPtr& indices,
+                   float& w_j) override;
+
+  /** \brief build the distance field for target_input_. */
+  bool
+  computeDistanceField();
+
+  /** \brief edge length of a voxel. */
+  float resolution_;
+
+  /** \brief minimum corner of the grid. */
+  Eigen::Vector3f min_p_;
+
+  /** \brief number of voxels of the grid in x, y and z. */
+  Eigen::Vector3i dims_;
+
+  /** \brief index of the closest target point per voxel, UNAVAILABLE if there is no target
+   * point within the maximum distance. */
+  std::vector<index_t> nearest_indices_;
+};
+} // namespace tracking
+} // namespace pcl
+
+#ifdef PCL_NO_PRECOMPILE
+#include <pcl/tracking/impl/distance_field_point_cloud_coherence.hpp>
+#endif
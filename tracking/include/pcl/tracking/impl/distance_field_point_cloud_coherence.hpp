@@ -0,0 +1,181 @@
+#ifndef PCL_TRACKING_IMPL_DISTANCE_FIELD_POINT_CLOUD_COHERENCE_H_
+#define PCL_TRACKING_IMPL_DISTANCE_FIELD_POINT_CLOUD_COHERENCE_H_
+
+#include <pcl/common/common.h>
+#include <pcl/common/point_tests.h> // for pcl::isXYZFinite
+#include <pcl/tracking/distance_field_point_cloud_coherence.h>
+
+#include <deque>
+
+namespace pcl {
+namespace tracking {
+template <typename PointInT>
+void
+DistanceFieldPointCloudCoherence<PointInT>::computeCoherence(
+    const PointCloudInConstPtr& cloud, const IndicesConstPtr&, float& w)
+{
+  const float inverse_resolution = 1.0f / resolution_;
+  const double maximum_distance_sqr = maximum_distance_ * maximum_distance_;
+  double val = 0.0;
+  for (const auto& point : *cloud) {
+    if (!pcl::isXYZFinite(point))
+      continue;
+    // points outside of the grid are paired through the closest border voxel
+    const Eigen::Vector3i ijk =
+        ((point.getVector3fMap() - min_p_) * inverse_resolution)
+            .array()
+            .floor()
+            .template cast<int>()
+            .max(0)
+            .min(dims_.array() - 1);
+    const index_t k_index =
+        nearest_indices_[(ijk[2] * dims_[1] + ijk[1]) * dims_[0] + ijk[0]];
+    if (k_index == UNAVAILABLE)
+      continue;
+    PointInT input_point = point;
+    PointInT target_point = (*target_input_)[k_index];
+    const float k_distance =
+        (input_point.getVector3fMap() - target_point.getVector3fMap()).squaredNorm();
+    if (k_distance < maximum_distance_sqr) {
+      double coherence_val = 1.0;
+      for (std::size_t i = 0; i < point_coherences_.size(); i++) {
+        PointCoherencePtr coherence = point_coherences_[i];
+        double w = coherence->compute(input_point, target_point);
+        coherence_val *= w;
+      }
+      val += coherence_val;
+    }
+  }
+  w = -static_cast<float>(val);
+}
+
+template <typename PointInT>
+bool
+DistanceFieldPointCloudCoherence<PointInT>::computeDistanceField()
+{
+  nearest_indices_.clear();
+  dims_.setZero();
+  if (!target_input_ || target_input_->empty()) {
+    PCL_ERROR("[pcl::%s::computeDistanceField] No target cloud given.\n",
+              getClassName().c_str());
+    return (false);
+  }
+  if (resolution_ <= 0.0f) {
+    PCL_ERROR("[pcl::%s::computeDistanceField] Invalid resolution %f.\n",
+              getClassName().c_str(),
+              resolution_);
+    return (false);
+  }
+
+  // Voxels farther than the maximum distance from the target never pair, so the
+  // grid only needs to cover that margin around the target.
+  const bool bounded = maximum_distance_ < std::numeric_limits<float>::max();
+  const float margin = bounded ? static_cast<float>(maximum_distance_) : 0.0f;
+
+  Eigen::Vector4f min_pt, max_pt;
+  pcl::getMinMax3D(*target_input_, min_pt, max_pt);
+  min_p_ = min_pt.head<3>() - Eigen::Vector3f::Constant(margin);
+  const Eigen::Vector3f extent =
+      max_pt.head<3>() + Eigen::Vector3f::Constant(margin) - min_p_;
+  const Eigen::Array3f dims_f = (extent / resolution_).array().floor() + 1.0f;
+  if (static_cast<double>(dims_f[0]) * dims_f[1] * dims_f[2] >
+      static_cast<double>(std::numeric_limits<int>::max())) {
+    PCL_ERROR("[pcl::%s::computeDistanceField] Resolution is too small for the "
+              "target cloud. Integer indices would overflow.\n",
+              getClassName().c_str());
+    return (false);
+  }
+  dims_ = dims_f.cast<int>();
+
+  const int nr_voxels = dims_[0] * dims_[1] * dims_[2];
+  nearest_indices_.assign(nr_voxels, UNAVAILABLE);
+  std::vector<float> distances_sqr(nr_voxels, std::numeric_limits<float>::max());
+
+  const auto voxel_center = [this](int idx) -> Eigen::Vector3f {
+    const int x = idx % dims_[0], y = (idx / dims_[0]) % dims_[1],
+              z = idx / (dims_[0] * dims_[1]);
+    return min_p_ + resolution_ * (Eigen::Vector3f(x, y, z) +
+                                   Eigen::Vector3f::Constant(0.5f));
+  };
+
+  // Seed the voxels occupied by the target
+  std::deque<int> queue;
+  for (index_t i = 0; i < static_cast<index_t>(target_input_->size()); ++i) {
+    const PointInT& point = (*target_input_)[i];
+    if (!pcl::isXYZFinite(point))
+      continue;
+    const Eigen::Vector3i ijk =
+        ((point.getVector3fMap() - min_p_) / resolution_)
+            .array()
+            .floor()
+            .template cast<int>()
+            .max(0)
+            .min(dims_.array() - 1);
+    const int idx = (ijk[2] * dims_[1] + ijk[1]) * dims_[0] + ijk[0];
+    const float dist_sqr = (point.getVector3fMap() - voxel_center(idx)).squaredNorm();
+    if (nearest_indices_[idx] == UNAVAILABLE)
+      queue.push_back(idx);
+    if (dist_sqr < distances_sqr[idx]) {
+      distances_sqr[idx] = dist_sqr;
+      nearest_indices_[idx] = i;
+    }
+  }
+
+  // Propagate the closest target points to the face neighbors until no voxel
+  // improves any more. A voxel center may be up to half a voxel diagonal away
+  // from a source point that still pairs, so keep a bit more than the margin.
+  const float cutoff = margin + resolution_ * 0.8660254f;
+  const float cutoff_sqr = bounded ? cutoff * cutoff : std::numeric_limits<float>::max();
+  const int strides[3] = {1, dims_[0], dims_[0] * dims_[1]};
+  while (!queue.empty()) {
+    const int idx = queue.front();
+    queue.pop_front();
+    const index_t nearest = nearest_indices_[idx];
+    const Eigen::Vector3f nearest_point = (*target_input_)[nearest].getVector3fMap();
+    const int coords[3] = {idx % dims_[0],
+                           (idx / dims_[0]) % dims_[1],
+                           idx / (dims_[0] * dims_[1])};
+    for (int d = 0; d < 3; ++d) {
+      for (int step = -1; step <= 1; step += 2) {
+        const int coord = coords[d] + step;
+        if (coord < 0 || coord >= dims_[d])
+          continue;
+        const int neighbor = idx + step * strides[d];
+        const float dist_sqr = (nearest_point - voxel_center(neighbor)).squaredNorm();
+        if (dist_sqr >= distances_sqr[neighbor] || dist_sqr > cutoff_sqr)
+          continue;
+        distances_sqr[neighbor] = dist_sqr;
+        nearest_indices_[neighbor] = nearest;
+        queue.push_back(neighbor);
+      }
+    }
+  }
+  return (true);
+}
+
+template <typename PointInT>
+bool
+DistanceFieldPointCloudCoherence<PointInT>::initCompute()
+{
+  if (!PointCloudCoherence<PointInT>::initCompute()) {
+    PCL_ERROR("[pcl::%s::initCompute] PointCloudCoherence::Init failed.\n",
+              getClassName().c_str());
+    return (false);
+  }
+
+  if (new_target_ && target_input_) {
+    if (!computeDistanceField())
+      return (false);
+    new_target_ = false;
+  }
+
+  return (!nearest_indices_.empty());
+}
+
+} // namespace tracking
+} // namespace pcl
+
+#define PCL_INSTANTIATE_DistanceFieldPointCloudCoherence(T)                            \
+  template class PCL_EXPORTS pcl::tracking::DistanceFieldPointCloudCoherence<T>;
+
+#endif
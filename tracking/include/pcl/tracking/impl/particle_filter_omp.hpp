@@ -2,6 +2,7 @@
 #define PCL_TRACKING_IMPL_PARTICLE_OMP_FILTER_H_
 
 #include <pcl/tracking/particle_filter_omp.h>
+#include <pcl/common/execution_context.h>
 
 namespace pcl {
 namespace tracking {
@@ -10,14 +11,8 @@ template <typename PointInT, typename StateT>
 void
 ParticleFilterOMPTracker<PointInT, StateT>::setNumberOfThreads(unsigned int nr_threads)
 {
-  if (nr_threads == 0)
-#ifdef _OPENMP
-    threads_ = omp_get_num_procs();
-#else
-    threads_ = 1;
-#endif
-  else
-    threads_ = nr_threads;
+  // 0 is resolved against the budget of pcl::ExecutionContext at compute time
+  threads_ = nr_threads;
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////
@@ -25,11 +20,13 @@ template <typename PointInT, typename StateT>
 void
 ParticleFilterOMPTracker<PointInT, StateT>::weight()
 {
+  const pcl::ThreadReservation reservation(threads_);
+  unsigned int threads = reservation.getNumberOfThreads();
   if (!use_normal_) {
     // clang-format off
 #pragma omp parallel for \
   default(none) \
-  num_threads(threads_)
+  num_threads(threads)
     // clang-format on
     for (int i = 0; i < particle_num_; i++)
       this->computeTransformedPointCloudWithoutNormal((*particles_)[i],
@@ -47,7 +44,7 @@ ParticleFilterOMPTracker<PointInT, StateT>::weight()
         // clang-format off
 #pragma omp parallel for \
   default(none) \
-  num_threads(threads_)
+  num_threads(threads)
         // clang-format on
         for (int i = 0; i < particle_num_; i++) {
           IndicesPtr indices; // dummy
@@ -65,7 +62,7 @@ ParticleFilterOMPTracker<PointInT, StateT>::weight()
       // clang-format off
 #pragma omp parallel for \
   default(none) \
-  num_threads(threads_)
+  num_threads(threads)
       // clang-format on
       for (int i = 0; i < particle_num_; i++) {
         IndicesPtr indices; // dummy
@@ -83,7 +80,7 @@ ParticleFilterOMPTracker<PointInT, StateT>::weight()
 #pragma omp parallel for \
   default(none) \
   shared(indices_list) \
-  num_threads(threads_)
+  num_threads(threads)
     // clang-format on	
     for (int i = 0; i < particle_num_; i++) {
       this->computeTransformedPointCloudWithNormal(
@@ -99,7 +96,7 @@ ParticleFilterOMPTracker<PointInT, StateT>::weight()
 #pragma omp parallel for \
   default(none) \
   shared(indices_list) \
-  num_threads(threads_)
+  num_threads(threads)
     // clang-format on	
     for (int i = 0; i < particle_num_; i++) {
       coherence_->compute(
@@ -38,9 +38,11 @@
 #ifndef PCL_TRACKING_IMPL_PYRAMIDAL_KLT_HPP
 #define PCL_TRACKING_IMPL_PYRAMIDAL_KLT_HPP
 
+#include <pcl/common/execution_context.h>
 #include <pcl/common/io.h>
 #include <pcl/common/time.h>
 #include <pcl/common/utils.h>
+#include <pcl/tracking/pyramidal_klt_kernels.h>
 
 namespace pcl {
 namespace tracking {
@@ -172,6 +174,8 @@ PyramidalKLTTracker<PointInT, IntensityT>::derivatives(const FloatImage& src,
                                                        FloatImage& grad_x,
                                                        FloatImage& grad_y) const
 {
+  const pcl::ThreadReservation reservation(threads_);
+  const unsigned int threads = reservation.getNumberOfThreads();
   // std::cout << ">>> derivatives" << std::endl;
   ////////////////////////////////////////////////////////
   // Use Shcarr operator to compute derivatives.        //
@@ -189,40 +193,30 @@ PyramidalKLTTracker<PointInT, IntensityT>::derivatives(const FloatImage& src,
       grad_y.height != src.height)
     grad_y = FloatImage(src.width, src.height);
 
-  int height = src.height, width = src.width;
-  float* row0 = new float[src.width + 2];
-  float* row1 = new float[src.width + 2];
-  float* trow0 = row0;
-  ++trow0;
-  float* trow1 = row1;
-  ++trow1;
+  const int height = src.height, width = src.width;
   const float* src_ptr = &(src[0]);
 
-  for (int y = 0; y < height; y++) {
-    const float* srow0 = src_ptr + (y > 0 ? y - 1 : height > 1 ? 1 : 0) * width;
-    const float* srow1 = src_ptr + y * width;
-    const float* srow2 =
-        src_ptr + (y < height - 1 ? y + 1 : height > 1 ? height - 2 : 0) * width;
-    float* grad_x_row = &(grad_x[y * width]);
-    float* grad_y_row = &(grad_y[y * width]);
-
-    // do vertical convolution
-    for (int x = 0; x < width; x++) {
-      trow0[x] = (srow0[x] + srow2[x]) * 3 + srow1[x] * 10;
-      trow1[x] = srow2[x] - srow0[x];
-    }
-
-    // make border
-    int x0 = width > 1 ? 1 : 0, x1 = width > 1 ? width - 2 : 0;
-    trow0[-1] = trow0[x0];
-    trow0[width] = trow0[x1];
-    trow1[-1] = trow1[x0];
-    trow1[width] = trow1[x1];
-
-    // do horizontal convolution and store results
-    for (int x = 0; x < width; x++) {
-      grad_x_row[x] = trow0[x + 1] - trow0[x - 1];
-      grad_y_row[x] = (trow1[x + 1] + trow1[x - 1]) * 3 + trow1[x] * 10;
+  // clang-format off
+#pragma omp parallel \
+  default(none) \
+  shared(grad_x, grad_y, height, src_ptr, width) \
+  num_threads(threads)
+  // clang-format on
+  {
+    std::vector<float> buffer(2 * (width + 2));
+#pragma omp for
+    for (int y = 0; y < height; y++) {
+      const float* srow0 = src_ptr + (y > 0 ? y - 1 : height > 1 ? 1 : 0) * width;
+      const float* srow1 = src_ptr + y * width;
+      const float* srow2 =
+          src_ptr + (y < height - 1 ? y + 1 : height > 1 ? height - 2 : 0) * width;
+      detail::computeScharrRow(srow0,
+                               srow1,
+                               srow2,
+                               width,
+                               buffer.data(),
+                               &(grad_x[y * width]),
+                               &(grad_y[y * width]));
     }
   }
 }
@@ -233,27 +227,46 @@ void
 PyramidalKLTTracker<PointInT, IntensityT>::downsample(const FloatImageConstPtr& input,
                                                       FloatImageConstPtr& output) const
 {
-  FloatImage smoothed(input->width, input->height);
-  convolve(input, smoothed);
-
-  int width = (smoothed.width + 1) / 2;
-  int height = (smoothed.height + 1) / 2;
-  std::vector<int> ii(width);
-  for (int i = 0; i < width; ++i)
-    ii[i] = 2 * i;
-
+  const pcl::ThreadReservation reservation(threads_);
+  const unsigned int threads = reservation.getNumberOfThreads();
+  // The image is smoothed with kernel_ and every other row and column is kept.
+  // Only the kept columns are filtered along the rows, and only the kept rows along
+  // the columns. Borders repeat the closest complete response, as in convolve.
+  const int input_width = input->width, input_height = input->height;
+  const int width = (input_width + 1) / 2;
+  const int height = (input_height + 1) / 2;
+  const float* kernel = kernel_.data();
+
+  FloatImage decimated(width, input_height);
   FloatImagePtr down(new FloatImage(width, height));
   // clang-format off
-#pragma omp parallel for \
+#pragma omp parallel \
   default(none) \
-  shared(down, height, output, smoothed, width) \
-  firstprivate(ii) \
-  num_threads(threads_)
-  // clang-format on	
-  for (int j = 0; j < height; ++j) {
-    int jj = 2 * j;
-    for (int i = 0; i < width; ++i)
-      (*down)(i, j) = smoothed(ii[i], jj);
+  shared(decimated, down, height, input, input_height, input_width, kernel, width) \
+  num_threads(threads)
+  // clang-format on
+  {
+    std::vector<float> buffer(input_width + 2);
+#pragma omp for
+    for (int j = 0; j < input_height; ++j)
+      detail::smoothAndDecimateRow(&((*input)[j * input_width]),
+                                   input_width,
+                                   kernel,
+                                   buffer.data(),
+                                   &(decimated[j * width]));
+
+#pragma omp for
+    for (int j = 0; j < height; ++j) {
+      const int center =
+          std::max(kernel_size_2_, std::min(2 * j, input_height - kernel_size_2_ - 1));
+      const float* rows[5];
+      for (int k = 0; k < 5; ++k) {
+        const int row = std::max(
+            0, std::min(center - kernel_size_2_ + k, input_height - 1));
+        rows[k] = &(decimated[row * width]);
+      }
+      detail::smoothColumns(rows, width, kernel, &((*down)[j * width]));
+    }
   }
 
   output = down;
@@ -269,8 +282,8 @@ PyramidalKLTTracker<PointInT, IntensityT>::downsample(
     FloatImageConstPtr& output_grad_y) const
 {
   downsample(input, output);
-  FloatImagePtr grad_x(new FloatImage(input->width, input->height));
-  FloatImagePtr grad_y(new FloatImage(input->width, input->height));
+  FloatImagePtr grad_x(new FloatImage(output->width, output->height));
+  FloatImagePtr grad_y(new FloatImage(output->width, output->height));
   derivatives(*output, *grad_x, *grad_y);
   output_grad_x = grad_x;
   output_grad_y = grad_y;
@@ -293,6 +306,8 @@ void
 PyramidalKLTTracker<PointInT, IntensityT>::convolveRows(
     const FloatImageConstPtr& input, FloatImage& output) const
 {
+  const pcl::ThreadReservation reservation(threads_);
+  const unsigned int threads = reservation.getNumberOfThreads();
   int width = input->width;
   int height = input->height;
   int last = input->width - kernel_size_2_;
@@ -302,7 +317,7 @@ PyramidalKLTTracker<PointInT, IntensityT>::convolveRows(
 #pragma omp parallel for \
   default(none) \
   shared(input, height, last, output, w, width) \
-  num_threads(threads_)
+  num_threads(threads)
   // clang-format on
   for (int j = 0; j < height; ++j) {
     for (int i = kernel_size_2_; i < last; ++i) {
@@ -327,6 +342,8 @@ void
 PyramidalKLTTracker<PointInT, IntensityT>::convolveCols(const FloatImageConstPtr& input,
                                                         FloatImage& output) const
 {
+  const pcl::ThreadReservation reservation(threads_);
+  const unsigned int threads = reservation.getNumberOfThreads();
   output = FloatImage(input->width, input->height);
 
   int width = input->width;
@@ -338,7 +355,7 @@ PyramidalKLTTracker<PointInT, IntensityT>::convolveCols(const FloatImageConstPtr
 #pragma omp parallel for \
   default(none) \
   shared(input, h, height, last, output, width) \
-  num_threads(threads_)
+  num_threads(threads)
   // clang-format on
   for (int i = 0; i < width; ++i) {
     for (int j = kernel_size_2_; j < last; ++j) {
@@ -364,6 +381,8 @@ PyramidalKLTTracker<PointInT, IntensityT>::computePyramids(
     std::vector<FloatImageConstPtr>& pyramid,
     pcl::InterpolationType border_type) const
 {
+  const pcl::ThreadReservation reservation(threads_);
+  const unsigned int threads = reservation.getNumberOfThreads();
   int step = 3;
   pyramid.resize(step * nb_levels_);
 
@@ -373,7 +392,7 @@ PyramidalKLTTracker<PointInT, IntensityT>::computePyramids(
 #pragma omp parallel for \
   default(none) \
   shared(input, tmp) \
-  num_threads(threads_)
+  num_threads(threads)
   // clang-format on
   for (int i = 0; i < static_cast<int>(input->size()); ++i)
     (*tmp)[i] = intensity_((*input)[i]);
@@ -553,6 +572,8 @@ PyramidalKLTTracker<PointInT, IntensityT>::track(
     std::vector<int>& status,
     Eigen::Affine3f& motion) const
 {
+  const pcl::ThreadReservation reservation(threads_);
+  const unsigned int threads = reservation.getNumberOfThreads();
   std::vector<Eigen::Array2f, Eigen::aligned_allocator<Eigen::Array2f>> next_pts(
       prev_keypoints->size());
   Eigen::Array2f half_win((track_width_ - 1) * 0.5f, (track_height_ - 1) * 0.5f);
@@ -568,6 +589,13 @@ PyramidalKLTTracker<PointInT, IntensityT>::track(
     Eigen::ArrayXXf grad_x_win(track_height_, track_width_);
     Eigen::ArrayXXf grad_y_win(track_height_, track_width_);
     float ratio(1. / (1 << level));
+    // clang-format off
+#pragma omp parallel for \
+  default(none) \
+  shared(grad_x, grad_y, half_win, level, nb_points, next, next_pts, prev, prev_keypoints, ratio, status) \
+  firstprivate(prev_win, grad_x_win, grad_y_win) \
+  num_threads(threads)
+    // clang-format on
     for (int ptidx = 0; ptidx < nb_points; ptidx++) {
       Eigen::Array2f prev_pt((*prev_keypoints)[ptidx].u * ratio,
                              (*prev_keypoints)[ptidx].v * ratio);
@@ -667,40 +695,42 @@ PyramidalKLTTracker<PointInT, IntensityT>::track(
         // update delta
         prev_delta = delta;
       }
+    }
+  }
 
-      // update tracked points
-      if (level == 0 && !status[ptidx]) {
-        Eigen::Array2f next_point = next_pts[ptidx] - half_win;
-        Eigen::Array2i inext_point;
+  // update tracked points, in order of the previous keypoints
+  const FloatImage& next = *(pyramid[0]);
+  for (int ptidx = 0; ptidx < nb_points; ptidx++) {
+    if (status[ptidx])
+      continue;
 
-        inext_point[0] = std::floor(next_point[0]);
-        inext_point[1] = std::floor(next_point[1]);
+    Eigen::Array2f next_point = next_pts[ptidx] - half_win;
+    Eigen::Array2i inext_point;
 
-        if (inext_point[0] < -track_width_ ||
-            (std::uint32_t)inext_point[0] >= next.width ||
-            inext_point[1] < -track_height_ ||
-            (std::uint32_t)inext_point[1] >= next.height) {
-          status[ptidx] = -1;
-          continue;
-        }
-        // insert valid keypoint
-        pcl::PointUV n;
-        n.u = next_pts[ptidx][0];
-        n.v = next_pts[ptidx][1];
-        keypoints->push_back(n);
-        // add points pair to compute transformation
-        inext_point[0] = std::floor(next_pts[ptidx][0]);
-        inext_point[1] = std::floor(next_pts[ptidx][1]);
-        iprev_point[0] = std::floor((*prev_keypoints)[ptidx].u);
-        iprev_point[1] = std::floor((*prev_keypoints)[ptidx].v);
-        const PointInT& prev_pt =
-            (*prev_input)[iprev_point[1] * prev_input->width + iprev_point[0]];
-        const PointInT& next_pt =
-            (*input)[inext_point[1] * input->width + inext_point[0]];
-        transformation_computer.add(
-            prev_pt.getVector3fMap(), next_pt.getVector3fMap(), 1.0);
-      }
+    inext_point[0] = std::floor(next_point[0]);
+    inext_point[1] = std::floor(next_point[1]);
+
+    if (inext_point[0] < -track_width_ || (std::uint32_t)inext_point[0] >= next.width ||
+        inext_point[1] < -track_height_ ||
+        (std::uint32_t)inext_point[1] >= next.height) {
+      status[ptidx] = -1;
+      continue;
     }
+    // insert valid keypoint
+    pcl::PointUV n;
+    n.u = next_pts[ptidx][0];
+    n.v = next_pts[ptidx][1];
+    keypoints->push_back(n);
+    // add points pair to compute transformation
+    Eigen::Array2i iprev_point;
+    inext_point[0] = std::floor(next_pts[ptidx][0]);
+    inext_point[1] = std::floor(next_pts[ptidx][1]);
+    iprev_point[0] = std::floor((*prev_keypoints)[ptidx].u);
+    iprev_point[1] = std::floor((*prev_keypoints)[ptidx].v);
+    const PointInT& prev_pt =
+        (*prev_input)[iprev_point[1] * prev_input->width + iprev_point[0]];
+    const PointInT& next_pt = (*input)[inext_point[1] * input->width + inext_point[0]];
+    transformation_computer.add(prev_pt.getVector3fMap(), next_pt.getVector3fMap(), 1.0);
   }
   motion = transformation_computer.getTransformation();
 }
@@ -713,6 +743,9 @@ PyramidalKLTTracker<PointInT, IntensityT>::computeTracking()
   if (!initialized_)
     return;
 
+  // computePyramids and track share this reservation
+  const pcl::ThreadReservation reservation(threads_);
+
   std::vector<FloatImageConstPtr> pyramid;
   computePyramids(input_, pyramid, pcl::BORDER_REFLECT_101);
   pcl::PointCloud<pcl::PointUV>::Ptr keypoints(new pcl::PointCloud<pcl::PointUV>);
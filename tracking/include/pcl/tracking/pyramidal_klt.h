@@ -203,12 +203,13 @@ public:
   }
 
   /** \brief Initialize the scheduler and set the number of threads to use.
-   * \param nr_threads the number of hardware threads to use (0 sets the value
-   * back to automatic).
+   * \param nr_threads the number of hardware threads to use (0 takes as many as
+   * the budget of pcl::ExecutionContext allows when tracking).
    */
   inline void
   setNumberOfThreads(unsigned int nr_threads = 0)
   {
+    // 0 is resolved against the budget of pcl::ExecutionContext at compute time
     threads_ = nr_threads;
   }
 
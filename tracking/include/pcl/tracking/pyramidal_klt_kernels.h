@@ -0,0 +1,91 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2014-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#pragma once
+
+#include <pcl/pcl_exports.h>
+
+namespace pcl {
+namespace tracking {
+namespace detail {
+/** \brief Compute one row of the Scharr derivatives used by PyramidalKLTTracker.
+ * The vertical pass runs over the three source rows, the horizontal one over its
+ * result, with the first and last columns reflected (101). Runs with the
+ * instruction set selected by pcl::getSIMDLevel (); all of them give the same
+ * result.
+ * \param[in] src_prev the row above, reflected at the image border
+ * \param[in] src the row
+ * \param[in] src_next the row below, reflected at the image border
+ * \param[in] width the number of pixels of a row
+ * \param[out] buffer scratch memory of 2 * (width + 2) floats
+ * \param[out] grad_x the horizontal derivative of the row
+ * \param[out] grad_y the vertical derivative of the row
+ */
+PCL_EXPORTS void
+computeScharrRow(const float* src_prev,
+                 const float* src,
+                 const float* src_next,
+                 int width,
+                 float* buffer,
+                 float* grad_x,
+                 float* grad_y);
+
+/** \brief Filter a row with a symmetric 5 tap kernel and keep every other pixel.
+ * Output pixel i is the filter response at column 2 * i. Responses that would
+ * need pixels outside of the row are replaced by the closest complete one.
+ * \param[in] src the row
+ * \param[in] width the number of pixels of the row, at least 5
+ * \param[in] kernel the 5 filter weights
+ * \param[out] buffer scratch memory of width + 2 floats
+ * \param[out] dst the (width + 1) / 2 output pixels
+ */
+PCL_EXPORTS void
+smoothAndDecimateRow(
+    const float* src, int width, const float* kernel, float* buffer, float* dst);
+
+/** \brief Filter 5 consecutive rows with a symmetric 5 tap kernel along the
+ * columns, dst[i] = sum_k kernel[4 - k] * rows[k][i].
+ * \param[in] rows the 5 rows, from top to bottom
+ * \param[in] width the number of pixels of a row
+ * \param[in] kernel the 5 filter weights
+ * \param[out] dst the filtered row
+ */
+PCL_EXPORTS void
+smoothColumns(const float* const* rows, int width, const float* kernel, float* dst);
+} // namespace detail
+} // namespace tracking
+} // namespace pcl
@@ -36,6 +36,7 @@
  */
 #include <pcl/tracking/impl/approx_nearest_pair_point_cloud_coherence.hpp>
 #include <pcl/tracking/impl/distance_coherence.hpp>
+#include <pcl/tracking/impl/distance_field_point_cloud_coherence.hpp>
 #include <pcl/tracking/impl/hsv_color_coherence.hpp>
 #include <pcl/tracking/impl/nearest_pair_point_cloud_coherence.hpp>
 #include <pcl/tracking/impl/normal_coherence.hpp>
@@ -47,6 +48,7 @@
 // clang-format off
 PCL_INSTANTIATE(ApproxNearestPairPointCloudCoherence, PCL_XYZ_POINT_TYPES)
 PCL_INSTANTIATE(DistanceCoherence, PCL_XYZ_POINT_TYPES)
+PCL_INSTANTIATE(DistanceFieldPointCloudCoherence, PCL_XYZ_POINT_TYPES)
 PCL_INSTANTIATE(HSVColorCoherence,
                 (pcl::PointXYZRGB)
                 (pcl::PointXYZRGBNormal)
@@ -0,0 +1,259 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2014-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include <pcl/tracking/pyramidal_klt_kernels.h>
+#include <pcl/common/simd_lanes.h>
+
+#include <algorithm>
+
+namespace {
+using namespace pcl::detail::simd;
+
+/** Vertical and horizontal pass of the Scharr operator over one row, V::size
+ * pixels at a time, the rest one by one. */
+template <typename V>
+PCL_SIMD_INLINE void
+scharrRow(const float* srow0,
+          const float* srow1,
+          const float* srow2,
+          int width,
+          float* trow0,
+          float* trow1,
+          float* grad_x,
+          float* grad_y)
+{
+  const int n = static_cast<int>(V::size);
+  int x = 0;
+  for (; x + n <= width; x += n) {
+    const V s0 = V::load(srow0 + x), s1 = V::load(srow1 + x), s2 = V::load(srow2 + x);
+    ((s0 + s2) * V(3.f) + s1 * V(10.f)).store(trow0 + x);
+    (s2 - s0).store(trow1 + x);
+  }
+  for (; x < width; ++x) {
+    trow0[x] = (srow0[x] + srow2[x]) * 3.f + srow1[x] * 10.f;
+    trow1[x] = srow2[x] - srow0[x];
+  }
+
+  // make border
+  const int x0 = width > 1 ? 1 : 0, x1 = width > 1 ? width - 2 : 0;
+  trow0[-1] = trow0[x0];
+  trow0[width] = trow0[x1];
+  trow1[-1] = trow1[x0];
+  trow1[width] = trow1[x1];
+
+  x = 0;
+  for (; x + n <= width; x += n) {
+    (V::load(trow0 + x + 1) - V::load(trow0 + x - 1)).store(grad_x + x);
+    ((V::load(trow1 + x + 1) + V::load(trow1 + x - 1)) * V(3.f) +
+     V::load(trow1 + x) * V(10.f))
+        .store(grad_y + x);
+  }
+  for (; x < width; ++x) {
+    grad_x[x] = trow0[x + 1] - trow0[x - 1];
+    grad_y[x] = (trow1[x + 1] + trow1[x - 1]) * 3.f + trow1[x] * 10.f;
+  }
+}
+
+/** Response of the 5 tap filter centered at column c of a row. */
+inline float
+filterAt(const float* src, int c, const float* kernel)
+{
+  return kernel[4] * src[c - 2] + kernel[3] * src[c - 1] + kernel[2] * src[c] +
+         kernel[1] * src[c + 1] + kernel[0] * src[c + 2];
+}
+
+/** Filter a row and keep the even columns. The row is split into its even and odd
+ * pixels first, so that the taps of consecutive outputs are consecutive. */
+template <typename V>
+PCL_SIMD_INLINE void
+smoothAndDecimate(
+    const float* src, int width, const float* kernel, float* buffer, float* dst)
+{
+  const int half_width = (width + 1) / 2;
+  float* even = buffer;
+  float* odd = buffer + half_width;
+  for (int i = 0; i < width / 2; ++i) {
+    even[i] = src[2 * i];
+    odd[i] = src[2 * i + 1];
+  }
+  if (width % 2)
+    even[half_width - 1] = src[width - 1];
+
+  // outputs whose taps 2 * i - 2 ... 2 * i + 2 are all inside of the row
+  const int begin = 1, end = (width - 3) / 2 + 1;
+  const V k0(kernel[0]), k1(kernel[1]), k2(kernel[2]), k3(kernel[3]), k4(kernel[4]);
+  const int n = static_cast<int>(V::size);
+  int i = begin;
+  for (; i + n <= end; i += n)
+    (k4 * V::load(even + i - 1) + k3 * V::load(odd + i - 1) + k2 * V::load(even + i) +
+     k1 * V::load(odd + i) + k0 * V::load(even + i + 1))
+        .store(dst + i);
+  for (; i < end; ++i)
+    dst[i] = filterAt(src, 2 * i, kernel);
+
+  // the borders repeat the closest complete response
+  dst[0] = filterAt(src, 2, kernel);
+  if (end < half_width) {
+    const float last = filterAt(src, width - 3, kernel);
+    for (i = end; i < half_width; ++i)
+      dst[i] = last;
+  }
+}
+
+template <typename V>
+PCL_SIMD_INLINE void
+smoothCols(const float* const* rows, int width, const float* kernel, float* dst)
+{
+  const V k0(kernel[0]), k1(kernel[1]), k2(kernel[2]), k3(kernel[3]), k4(kernel[4]);
+  const int n = static_cast<int>(V::size);
+  int i = 0;
+  for (; i + n <= width; i += n)
+    (k4 * V::load(rows[0] + i) + k3 * V::load(rows[1] + i) + k2 * V::load(rows[2] + i) +
+     k1 * V::load(rows[3] + i) + k0 * V::load(rows[4] + i))
+        .store(dst + i);
+  for (; i < width; ++i)
+    dst[i] = kernel[4] * rows[0][i] + kernel[3] * rows[1][i] + kernel[2] * rows[2][i] +
+             kernel[1] * rows[3][i] + kernel[0] * rows[4][i];
+}
+
+#ifdef PCL_SIMD_KERNELS_SSE2
+void
+scharrRowSSE2(const float* s0, const float* s1, const float* s2, int width,
+              float* t0, float* t1, float* gx, float* gy)
+{
+  scharrRow<Lane4>(s0, s1, s2, width, t0, t1, gx, gy);
+}
+
+void
+smoothAndDecimateSSE2(
+    const float* src, int width, const float* kernel, float* buffer, float* dst)
+{
+  smoothAndDecimate<Lane4>(src, width, kernel, buffer, dst);
+}
+
+void
+smoothColsSSE2(const float* const* rows, int width, const float* kernel, float* dst)
+{
+  smoothCols<Lane4>(rows, width, kernel, dst);
+}
+#endif
+
+#ifdef PCL_SIMD_KERNELS_AVX
+PCL_SIMD_TARGET_AVX void
+scharrRowAVX(const float* s0, const float* s1, const float* s2, int width,
+             float* t0, float* t1, float* gx, float* gy)
+{
+  scharrRow<Lane8>(s0, s1, s2, width, t0, t1, gx, gy);
+}
+
+PCL_SIMD_TARGET_AVX void
+smoothAndDecimateAVX(
+    const float* src, int width, const float* kernel, float* buffer, float* dst)
+{
+  smoothAndDecimate<Lane8>(src, width, kernel, buffer, dst);
+}
+
+PCL_SIMD_TARGET_AVX void
+smoothColsAVX(const float* const* rows, int width, const float* kernel, float* dst)
+{
+  smoothCols<Lane8>(rows, width, kernel, dst);
+}
+#endif
+} // namespace
+
+///////////////////////////////////////////////////////////////////////////////////////////////
+void
+pcl::tracking::detail::computeScharrRow(const float* src_prev,
+                                        const float* src,
+                                        const float* src_next,
+                                        int width,
+                                        float* buffer,
+                                        float* grad_x,
+                                        float* grad_y)
+{
+  float* trow0 = buffer + 1;
+  float* trow1 = buffer + width + 3;
+  const pcl::SIMDLevel level = pcl::getSIMDLevel();
+#ifdef PCL_SIMD_KERNELS_AVX
+  if (level >= pcl::SIMDLevel::AVX)
+    return (scharrRowAVX(src_prev, src, src_next, width, trow0, trow1, grad_x, grad_y));
+#endif
+#ifdef PCL_SIMD_KERNELS_SSE2
+  if (level >= pcl::SIMDLevel::SSE2)
+    return (scharrRowSSE2(src_prev, src, src_next, width, trow0, trow1, grad_x, grad_y));
+#endif
+  (void)level;
+  scharrRow<Lane<float>>(src_prev, src, src_next, width, trow0, trow1, grad_x, grad_y);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////
+void
+pcl::tracking::detail::smoothAndDecimateRow(
+    const float* src, int width, const float* kernel, float* buffer, float* dst)
+{
+  const pcl::SIMDLevel level = pcl::getSIMDLevel();
+#ifdef PCL_SIMD_KERNELS_AVX
+  if (level >= pcl::SIMDLevel::AVX)
+    return (smoothAndDecimateAVX(src, width, kernel, buffer, dst));
+#endif
+#ifdef PCL_SIMD_KERNELS_SSE2
+  if (level >= pcl::SIMDLevel::SSE2)
+    return (smoothAndDecimateSSE2(src, width, kernel, buffer, dst));
+#endif
+  (void)level;
+  smoothAndDecimate<Lane<float>>(src, width, kernel, buffer, dst);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////
+void
+pcl::tracking::detail::smoothColumns(const float* const* rows,
+                                     int width,
+                                     const float* kernel,
+                                     float* dst)
+{
+  const pcl::SIMDLevel level = pcl::getSIMDLevel();
+#ifdef PCL_SIMD_KERNELS_AVX
+  if (level >= pcl::SIMDLevel::AVX)
+    return (smoothColsAVX(rows, width, kernel, dst));
+#endif
+#ifdef PCL_SIMD_KERNELS_SSE2
+  if (level >= pcl::SIMDLevel::SSE2)
+    return (smoothColsSSE2(rows, width, kernel, dst));
+#endif
+  (void)level;
+  smoothCols<Lane<float>>(rows, width, kernel, dst);
+}
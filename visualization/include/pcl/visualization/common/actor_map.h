@@ -41,6 +41,7 @@
 #include <pcl/visualization/point_cloud_color_handlers.h> // for PointCloudColorHandler
 #include <pcl/PCLPointCloud2.h>
 
+#include <vtkCommand.h>
 #include <vtkLODActor.h>
 #include <vtkSmartPointer.h>
 #include <vtkIdTypeArray.h>
@@ -67,7 +68,7 @@ namespace pcl
       using ColorHandlerConstPtr = ColorHandler::ConstPtr;
 
       public:
-        CloudActor () : color_handler_index_ (0), geometry_handler_index_ (0) {}
+        CloudActor () : color_handler_index_ (0), geometry_handler_index_ (0), capacity (0) {}
 
         virtual ~CloudActor ()
         {
@@ -95,6 +96,12 @@ namespace pcl
 
         /** \brief Internal cell array. Used for optimizing updatePointCloud. */
         vtkSmartPointer<vtkIdTypeArray> cells;
+
+        /** \brief Number of points the buffers of a streaming cloud are allocated for, 0 for other clouds. */
+        vtkIdType capacity;
+
+        /** \brief The renderer observer that selects the points of a level of detail cloud. */
+        vtkSmartPointer<vtkCommand> lod_callback;
     };
 
     using CloudActorMap = std::unordered_map<std::string, CloudActor>;
@@ -0,0 +1,265 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2019-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <pcl/visualization/lod_point_cloud.h>
+#include <pcl/visualization/common/common.h>
+#include <pcl/common/point_tests.h> // for pcl::isXYZFinite
+#include <pcl/pcl_base.h> // for pcl::IndicesPtr
+#include <pcl/octree/octree_pointcloud.h>
+
+#include <algorithm>
+#include <cmath>
+#include <deque>
+#include <queue>
+#include <utility>
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::visualization::LODPointCloud<PointT>::setInputCloud (const PointCloudConstPtr &cloud)
+{
+  cloud_ = cloud;
+  nodes_.clear ();
+
+  pcl::IndicesPtr finite (new pcl::Indices);
+  finite->reserve (cloud->size ());
+  Eigen::Vector3f min_pt = Eigen::Vector3f::Constant (std::numeric_limits<float>::max ());
+  Eigen::Vector3f max_pt = Eigen::Vector3f::Constant (std::numeric_limits<float>::lowest ());
+  for (std::size_t i = 0; i < cloud->size (); ++i)
+  {
+    if (!pcl::isXYZFinite ((*cloud)[i]))
+      continue;
+    finite->push_back (static_cast<pcl::index_t> (i));
+    min_pt = min_pt.cwiseMin ((*cloud)[i].getVector3fMap ());
+    max_pt = max_pt.cwiseMax ((*cloud)[i].getVector3fMap ());
+  }
+  if (finite->empty ())
+    return;
+
+  // Choose the depth at which a surface sampled by the cloud has about node_size_ points
+  // per leaf, the leaves keep all of their points
+  const double extent = (max_pt - min_pt).maxCoeff ();
+  int depth = 0;
+  while (depth < 20 && static_cast<double> (finite->size ()) > static_cast<double> (node_size_) * std::pow (4.0, depth))
+    ++depth;
+  const double resolution = (extent > 0.0) ? extent / static_cast<double> (1 << depth) : 1.0;
+
+  pcl::octree::OctreePointCloud<PointT> octree (resolution);
+  octree.setInputCloud (cloud, finite);
+  octree.addPointsFromInputCloud ();
+
+  // Mirror the octree, the depth first traversal visits every node right after its parent
+  std::vector<std::size_t> path;
+  for (auto it = octree.depth_begin (), it_end = octree.depth_end (); it != it_end; ++it)
+  {
+    path.resize (it.getCurrentOctreeDepth ());
+    const std::size_t node = nodes_.size ();
+    nodes_.emplace_back ();
+    if (!path.empty ())
+      nodes_[path.back ()].children.push_back (node);
+
+    if (it.isBranchNode ())
+      path.push_back (node);
+    else
+      it.getLeafContainer ().getPointIndices (nodes_[node].points);
+  }
+
+  // Children come after their parents, so going backwards the subsamples and bounding boxes
+  // of all the children of a branch are known when the branch is reached
+  for (std::size_t node = nodes_.size (); node-- > 0; )
+  {
+    Node &current = nodes_[node];
+    if (current.children.empty ())
+    {
+      current.min_pt = Eigen::Vector3d::Constant (std::numeric_limits<double>::max ());
+      current.max_pt = Eigen::Vector3d::Constant (std::numeric_limits<double>::lowest ());
+      for (const auto &index : current.points)
+      {
+        const Eigen::Vector3d p = (*cloud)[index].getVector3fMap ().template cast<double> ();
+        current.min_pt = current.min_pt.cwiseMin (p);
+        current.max_pt = current.max_pt.cwiseMax (p);
+      }
+      continue;
+    }
+
+    std::size_t nr_points = 0;
+    current.min_pt = nodes_[current.children.front ()].min_pt;
+    current.max_pt = nodes_[current.children.front ()].max_pt;
+    for (const auto &child : current.children)
+    {
+      nr_points += nodes_[child].points.size ();
+      current.min_pt = current.min_pt.cwiseMin (nodes_[child].min_pt);
+      current.max_pt = current.max_pt.cwiseMax (nodes_[child].max_pt);
+    }
+
+    // Every k-th point of the children in turn, which spreads the subsample like the points
+    const double step = std::max (1.0, static_cast<double> (nr_points) / static_cast<double> (node_size_));
+    current.points.reserve (std::min (nr_points, node_size_));
+    double next = 0.0;
+    std::size_t position = 0;
+    for (const auto &child : current.children)
+    {
+      const pcl::Indices &child_points = nodes_[child].points;
+      for (const auto &index : child_points)
+      {
+        if (static_cast<double> (position++) >= next)
+        {
+          current.points.push_back (index);
+          next += step;
+        }
+      }
+    }
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::visualization::LODPointCloud<PointT>::selectPoints (
+    const Eigen::Matrix4d &view_projection_matrix, const Eigen::Vector3d &eye,
+    int width, int height, pcl::Indices &indices) const
+{
+  indices.clear ();
+  if (nodes_.empty ())
+    return;
+
+  // Cull against the side planes only: the near and far planes follow the bounds of what is
+  // drawn, so culling against them would never bring back nodes that are not drawn yet
+  double planes[24];
+  pcl::visualization::getViewFrustum (view_projection_matrix, planes);
+  for (int i = 16; i < 24; ++i)
+    planes[i] = (i % 4 == 3) ? 1.0 : 0.0;
+
+  const auto is_visible = [&] (std::size_t node)
+  {
+    return (pcl::visualization::cullFrustum (planes, nodes_[node].min_pt, nodes_[node].max_pt) != PCL_OUTSIDE_FRUSTUM);
+  };
+  // Distance in pixels between the points of a node if they were spread over its projection
+  const auto screen_space_error = [&] (std::size_t node)
+  {
+    const float area = pcl::visualization::viewScreenArea (eye, nodes_[node].min_pt, nodes_[node].max_pt,
+                                                           view_projection_matrix, width, height);
+    return (std::sqrt (std::max (area, 0.0f) / static_cast<float> (nodes_[node].points.size ())));
+  };
+
+  if (!is_visible (0))
+    return;
+
+  // Refine the node with the largest error first
+  std::priority_queue<std::pair<float, std::size_t> > queue;
+  queue.emplace (screen_space_error (0), 0);
+  std::size_t nr_points = nodes_[0].points.size ();
+  std::vector<std::size_t> selection, visible_children;
+  while (!queue.empty ())
+  {
+    const std::pair<float, std::size_t> top = queue.top ();
+    queue.pop ();
+    const Node &node = nodes_[top.second];
+    if (top.first <= max_screen_space_error_ || node.children.empty ())
+    {
+      selection.push_back (top.second);
+      continue;
+    }
+
+    visible_children.clear ();
+    std::size_t nr_children_points = 0;
+    for (const auto &child : node.children)
+    {
+      if (!is_visible (child))
+        continue;
+      visible_children.push_back (child);
+      nr_children_points += nodes_[child].points.size ();
+    }
+    if (nr_points - node.points.size () + nr_children_points > point_budget_)
+    {
+      selection.push_back (top.second);
+      continue;
+    }
+
+    nr_points = nr_points - node.points.size () + nr_children_points;
+    for (const auto &child : visible_children)
+      queue.emplace (screen_space_error (child), child);
+  }
+
+  getPoints (selection, indices);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::visualization::LODPointCloud<PointT>::selectPoints (pcl::Indices &indices) const
+{
+  indices.clear ();
+  if (nodes_.empty ())
+    return;
+
+  // Refine level by level while the budget allows
+  std::deque<std::size_t> queue (1, 0);
+  std::size_t nr_points = nodes_[0].points.size ();
+  std::vector<std::size_t> selection;
+  while (!queue.empty ())
+  {
+    const std::size_t node = queue.front ();
+    queue.pop_front ();
+
+    std::size_t nr_children_points = 0;
+    for (const auto &child : nodes_[node].children)
+      nr_children_points += nodes_[child].points.size ();
+    if (nodes_[node].children.empty () ||
+        nr_points - nodes_[node].points.size () + nr_children_points > point_budget_)
+    {
+      selection.push_back (node);
+      continue;
+    }
+
+    nr_points = nr_points - nodes_[node].points.size () + nr_children_points;
+    queue.insert (queue.end (), nodes_[node].children.begin (), nodes_[node].children.end ());
+  }
+
+  getPoints (selection, indices);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::visualization::LODPointCloud<PointT>::getPoints (
+    const std::vector<std::size_t> &selection, pcl::Indices &indices) const
+{
+  std::size_t nr_points = 0;
+  for (const auto &node : selection)
+    nr_points += nodes_[node].points.size ();
+  indices.reserve (nr_points);
+  for (const auto &node : selection)
+    indices.insert (indices.end (), nodes_[node].points.begin (), nodes_[node].points.end ());
+}
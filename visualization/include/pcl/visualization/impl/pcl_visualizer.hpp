@@ -40,6 +40,7 @@
 
 #include <vtkVersion.h>
 #include <vtkSmartPointer.h>
+#include <vtkCamera.h>
 #include <vtkCellArray.h>
 #include <vtkLeaderActor2D.h>
 #include <vtkVectorText.h>
@@ -62,6 +63,7 @@
 #include <vtkLODActor.h>
 #include <vtkLineSource.h>
 
+#include <pcl/common/io.h> // for copyPointCloud
 #include <pcl/common/utils.h> // pcl::utils::ignore
 #include <pcl/visualization/common/shapes.h>
 
@@ -1631,6 +1633,284 @@ pcl::visualization::PCLVisualizer::updatePointCloud (const typename pcl::PointCl
   return (true);
 }
 
+/////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> bool
+pcl::visualization::PCLVisualizer::addStreamingPointCloud (std::size_t capacity,
+                                                           const std::string &id,
+                                                           int viewport)
+{
+  if (contains (id))
+  {
+    PCL_WARN ("[addStreamingPointCloud] The id <%s> already exists! Please choose a different id and retry.\n", id.c_str ());
+    return (false);
+  }
+  if (capacity == 0)
+  {
+    PCL_WARN ("[addStreamingPointCloud] PointCloud <%s> requested with a capacity of 0!\n", id.c_str ());
+    return (false);
+  }
+  const vtkIdType nr_points = static_cast<vtkIdType> (capacity);
+
+  // All the buffers are allocated for the full capacity, then emptied with Reset which
+  // keeps the memory, so that updates only move the number of values in use
+  vtkSmartPointer<vtkPolyData> polydata;
+  allocVtkPolyData (polydata);
+
+  vtkSmartPointer<vtkPoints> points = vtkSmartPointer<vtkPoints>::New ();
+  points->SetDataTypeToFloat ();
+  points->SetNumberOfPoints (nr_points);
+  points->GetData ()->Reset ();
+  polydata->SetPoints (points);
+
+  std::vector<pcl::PCLPointField> fields;
+  if (pcl::getFieldIndex<PointT> ("rgb", fields) != -1 || pcl::getFieldIndex<PointT> ("rgba", fields) != -1)
+  {
+    vtkSmartPointer<vtkUnsignedCharArray> colors = vtkSmartPointer<vtkUnsignedCharArray>::New ();
+    colors->SetNumberOfComponents (3);
+    colors->SetName ("Colors");
+    colors->SetNumberOfTuples (nr_points);
+    colors->Reset ();
+    polydata->GetPointData ()->SetScalars (colors);
+  }
+
+  // Vertex i is the point i, so the cells are written once and never change
+  vtkSmartPointer<vtkCellArray> vertices = vtkSmartPointer<vtkCellArray>::New ();
+#ifdef VTK_CELL_ARRAY_V2
+  vtkSmartPointer<vtkIdTypeArray> offsets = vtkSmartPointer<vtkIdTypeArray>::New ();
+  vtkSmartPointer<vtkIdTypeArray> connectivity = vtkSmartPointer<vtkIdTypeArray>::New ();
+  offsets->SetNumberOfValues (nr_points + 1);
+  connectivity->SetNumberOfValues (nr_points);
+  for (vtkIdType i = 0; i < nr_points; ++i)
+  {
+    offsets->SetValue (i, i);
+    connectivity->SetValue (i, i);
+  }
+  offsets->SetValue (nr_points, nr_points);
+  vertices->SetData (offsets, connectivity);
+  vertices->GetOffsetsArray ()->Reset ();
+  vertices->GetOffsetsArray ()->WriteVoidPointer (0, 1);
+  vertices->GetConnectivityArray ()->Reset ();
+#else
+  vtkSmartPointer<vtkIdTypeArray> cells = vtkSmartPointer<vtkIdTypeArray>::New ();
+  cells->SetNumberOfValues (2 * nr_points);
+  for (vtkIdType i = 0; i < nr_points; ++i)
+  {
+    cells->SetValue (2 * i, 1);
+    cells->SetValue (2 * i + 1, i);
+  }
+  cells->Reset ();
+  vertices->SetCells (0, cells);
+#endif
+  polydata->SetVerts (vertices);
+
+  // Create an Actor
+  vtkSmartPointer<vtkLODActor> actor;
+  createActorFromVTKDataSet (polydata, actor);
+  if (polydata->GetPointData ()->GetScalars ())
+  {
+    double minmax[2] = {0.0, 255.0};
+    actor->GetMapper ()->SetScalarRange (minmax);
+  }
+
+  // Add it to all renderers
+  addActorToRenderer (actor, viewport);
+
+  // Save the pointer/ID pair to the global actor map
+  CloudActor& cloud_actor = (*cloud_actor_map_)[id];
+  cloud_actor.actor = actor;
+  cloud_actor.capacity = nr_points;
+#ifndef VTK_CELL_ARRAY_V2
+  cloud_actor.cells = cells;
+#endif
+
+  vtkSmartPointer<vtkMatrix4x4> transformation = vtkSmartPointer<vtkMatrix4x4>::New ();
+  convertToVtkMatrix (Eigen::Vector4f::Zero (), Eigen::Quaternion<float>::Identity (), transformation);
+  cloud_actor.viewpoint_transformation_ = transformation;
+  cloud_actor.actor->SetUserMatrix (transformation);
+  cloud_actor.actor->Modified ();
+
+  return (true);
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> bool
+pcl::visualization::PCLVisualizer::updateStreamingPointCloud (const typename pcl::PointCloud<PointT>::ConstPtr &cloud,
+                                                              const std::string &id)
+{
+  CloudActorMap::iterator am_it = cloud_actor_map_->find (id);
+  if (am_it == cloud_actor_map_->end () || am_it->second.capacity == 0)
+    return (false);
+
+  vtkPolyData *polydata = vtkPolyData::SafeDownCast (am_it->second.actor->GetMapper ()->GetInput ());
+  if (!polydata)
+    return (false);
+  vtkPoints *points = polydata->GetPoints ();
+  vtkFloatArray *coordinates = vtkFloatArray::SafeDownCast (points->GetData ());
+  vtkUnsignedCharArray *colors = vtkUnsignedCharArray::SafeDownCast (polydata->GetPointData ()->GetScalars ());
+  vtkCellArray *vertices = polydata->GetVerts ();
+
+  std::uint32_t rgb_offset = 0;
+  if (colors)
+  {
+    std::vector<pcl::PCLPointField> fields;
+    int rgb_idx = pcl::getFieldIndex<PointT> ("rgb", fields);
+    if (rgb_idx == -1)
+      rgb_idx = pcl::getFieldIndex<PointT> ("rgba", fields);
+    if (rgb_idx == -1)
+      colors = nullptr;
+    else
+      rgb_offset = fields[rgb_idx].offset;
+  }
+
+  // Reset and WritePointer only move the number of values in use, the memory for the
+  // full capacity stays allocated
+  const vtkIdType max_points = std::min (static_cast<vtkIdType> (cloud->size ()), am_it->second.capacity);
+  coordinates->Reset ();
+  float *xyz = coordinates->WritePointer (0, 3 * max_points);
+  unsigned char *rgb = nullptr;
+  if (colors)
+  {
+    colors->Reset ();
+    rgb = colors->WritePointer (0, 3 * max_points);
+  }
+
+  vtkIdType nr_points = 0;
+  for (vtkIdType i = 0; i < max_points; ++i)
+  {
+    const PointT &point = (*cloud)[i];
+    if (!cloud->is_dense && !isXYZFinite (point))
+      continue;
+    std::copy (&point.x, &point.x + 3, &xyz[3 * nr_points]);
+    if (rgb)
+    {
+      const pcl::RGB* const rgb_data = reinterpret_cast<const pcl::RGB*> (reinterpret_cast<const char*> (&point) + rgb_offset);
+      rgb[3 * nr_points] = rgb_data->r;
+      rgb[3 * nr_points + 1] = rgb_data->g;
+      rgb[3 * nr_points + 2] = rgb_data->b;
+    }
+    ++nr_points;
+  }
+
+  coordinates->Reset ();
+  coordinates->WritePointer (0, 3 * nr_points);
+  coordinates->Modified ();
+  points->Modified ();
+  if (colors)
+  {
+    colors->Reset ();
+    colors->WritePointer (0, 3 * nr_points);
+    colors->Modified ();
+  }
+
+  // The vertices only change with the number of points
+  if (vertices->GetNumberOfCells () != nr_points)
+  {
+#ifdef VTK_CELL_ARRAY_V2
+    vertices->GetOffsetsArray ()->Reset ();
+    vertices->GetOffsetsArray ()->WriteVoidPointer (0, nr_points + 1);
+    vertices->GetConnectivityArray ()->Reset ();
+    vertices->GetConnectivityArray ()->WriteVoidPointer (0, nr_points);
+#else
+    vtkIdTypeArray *cells = am_it->second.cells;
+    cells->Reset ();
+    cells->WritePointer (0, 2 * nr_points);
+    vertices->SetCells (nr_points, cells);
+    // See #4001 and #3452
+    vertices->SetNumberOfCells (nr_points);
+#endif
+    vertices->Modified ();
+  }
+
+  polydata->Modified ();
+  return (true);
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> bool
+pcl::visualization::PCLVisualizer::addLODPointCloud (const typename pcl::PointCloud<PointT>::ConstPtr &cloud,
+                                                     std::size_t point_budget,
+                                                     const std::string &id, int viewport)
+{
+  typename LODPointCloud<PointT>::Ptr lod (new LODPointCloud<PointT>);
+  lod->setPointBudget (point_budget);
+  lod->setInputCloud (cloud);
+  return (addLODPointCloud<PointT> (lod, id, viewport));
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> bool
+pcl::visualization::PCLVisualizer::addLODPointCloud (const typename LODPointCloud<PointT>::ConstPtr &lod,
+                                                     const std::string &id, int viewport)
+{
+  if (!lod || !lod->getInputCloud ())
+  {
+    PCL_WARN ("[addLODPointCloud] No input cloud given for PointCloud <%s>!\n", id.c_str ());
+    return (false);
+  }
+
+  if (!addStreamingPointCloud<PointT> (std::max<std::size_t> (lod->getPointBudget (), 1), id, viewport))
+    return (false);
+
+  // Show the coarse levels until the first frame is rendered
+  typename pcl::PointCloud<PointT>::Ptr points (new pcl::PointCloud<PointT>);
+  pcl::Indices indices;
+  lod->selectPoints (indices);
+  pcl::copyPointCloud (*lod->getInputCloud (), indices, *points);
+  updateStreamingPointCloud<PointT> (points, id);
+
+  // Select the points again whenever the camera of the first renderer showing the cloud moved
+  vtkSmartPointer<LODCallback<PointT> > callback = vtkSmartPointer<LODCallback<PointT> >::New ();
+  callback->lod = lod;
+  callback->id = id;
+  callback->pcl_visualizer = this;
+  callback->points = points;
+
+  rens_->InitTraversal ();
+  vtkRenderer* renderer = nullptr;
+  int i = 0;
+  while ((renderer = rens_->GetNextItem ()))
+  {
+    if (viewport == 0 || viewport == i)
+    {
+      renderer->AddObserver (vtkCommand::StartEvent, callback);
+      break;
+    }
+    ++i;
+  }
+  (*cloud_actor_map_)[id].lod_callback = callback;
+  return (true);
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::visualization::PCLVisualizer::LODCallback<PointT>::Execute (vtkObject *caller, unsigned long, void*)
+{
+  vtkRenderer *renderer = vtkRenderer::SafeDownCast (caller);
+  if (!renderer)
+    return;
+  vtkCamera *camera = renderer->GetActiveCamera ();
+  const int *renderer_size = renderer->GetSize ();
+
+  const Eigen::Matrix4d current_view = vtkToEigen (camera->GetViewTransformMatrix ());
+  if (current_view == view && camera->GetViewAngle () == view_angle &&
+      renderer_size[0] == size[0] && renderer_size[1] == size[1])
+    return;
+  view = current_view;
+  view_angle = camera->GetViewAngle ();
+  size[0] = renderer_size[0];
+  size[1] = renderer_size[1];
+
+  const Eigen::Matrix4d view_projection =
+      vtkToEigen (camera->GetCompositeProjectionTransformMatrix (renderer->GetTiledAspectRatio (), -1, 1));
+  double position[3];
+  camera->GetPosition (position);
+
+  pcl::Indices indices;
+  lod->selectPoints (view_projection, Eigen::Vector3d (position[0], position[1], position[2]), size[0], size[1], indices);
+  pcl::copyPointCloud (*lod->getInputCloud (), indices, *points);
+  pcl_visualizer->updateStreamingPointCloud<PointT> (points, id);
+}
+
 /////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointT> bool
 pcl::visualization::PCLVisualizer::addPolygonMesh (
@@ -0,0 +1,171 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2019-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <pcl/memory.h>
+#include <pcl/pcl_macros.h>
+#include <pcl/point_cloud.h>
+#include <pcl/types.h>
+
+#include <Eigen/Core>
+
+#include <vector>
+
+namespace pcl
+{
+  namespace visualization
+  {
+    /** \brief Level of detail hierarchy for rendering point clouds that are too large to be
+      * drawn at once.
+      *
+      * The cloud is sorted into a pcl::octree::OctreePointCloud. Every node of the octree keeps a
+      * subsample of at most node_size of the points below it: the leaves all of their points,
+      * the branches a uniform subsample of the subsamples of their children. For a given camera,
+      * selectPoints starts at the root and keeps replacing the nodes with their children that are
+      * in the view frustum, coarsest on screen first, as long as the distance between the
+      * projected points of a node exceeds the screen space error and the number of selected
+      * points stays within the point budget.
+      *
+      * PCLVisualizer::addLODPointCloud renders a cloud this way, with the points of the selected
+      * nodes refilled into fixed size buffers whenever the camera moves.
+      * \ingroup visualization
+      */
+    template <typename PointT>
+    class LODPointCloud
+    {
+      public:
+        using PointCloud = pcl::PointCloud<PointT>;
+        using PointCloudConstPtr = typename PointCloud::ConstPtr;
+
+        using Ptr = shared_ptr<LODPointCloud<PointT> >;
+        using ConstPtr = shared_ptr<const LODPointCloud<PointT> >;
+
+        /** \brief Constructor.
+          * \param[in] node_size the largest number of points kept in a branch node
+          */
+        LODPointCloud (std::size_t node_size = 4096) :
+          node_size_ (node_size), point_budget_ (1000000), max_screen_space_error_ (1.5f)
+        {}
+
+        /** \brief Build the hierarchy for a cloud. Points with non finite coordinates are skipped.
+          * \param[in] cloud the input point cloud dataset
+          */
+        void
+        setInputCloud (const PointCloudConstPtr &cloud);
+
+        /** \brief Get the input point cloud dataset. */
+        inline PointCloudConstPtr
+        getInputCloud () const { return (cloud_); }
+
+        /** \brief Set the largest number of points returned by selectPoints. The selection can only
+          * exceed it if the root node alone has more points.
+          */
+        inline void
+        setPointBudget (std::size_t point_budget) { point_budget_ = point_budget; }
+
+        /** \brief Get the largest number of points returned by selectPoints. */
+        inline std::size_t
+        getPointBudget () const { return (point_budget_); }
+
+        /** \brief Set the distance in pixels between the projected points of a node below which the
+          * node is not refined any further (default: 1.5).
+          */
+        inline void
+        setMaxScreenSpaceError (float pixels) { max_screen_space_error_ = pixels; }
+
+        /** \brief Get the distance in pixels between projected points below which nodes are not refined. */
+        inline float
+        getMaxScreenSpaceError () const { return (max_screen_space_error_); }
+
+        /** \brief Get the number of nodes of the hierarchy. */
+        inline std::size_t
+        getNumberOfNodes () const { return (nodes_.size ()); }
+
+        /** \brief Select the points to draw for a camera.
+          * \param[in] view_projection_matrix the product of the projection and the view matrix of the camera
+          * \param[in] eye the position of the camera
+          * \param[in] width the width of the viewport in pixels
+          * \param[in] height the height of the viewport in pixels
+          * \param[out] indices the indices of the selected points in the input cloud
+          */
+        void
+        selectPoints (const Eigen::Matrix4d &view_projection_matrix, const Eigen::Vector3d &eye,
+                      int width, int height, pcl::Indices &indices) const;
+
+        /** \brief Select the points of the coarsest levels of the whole cloud that fit in the point
+          * budget, e.g. to show the cloud before a camera is set up.
+          * \param[out] indices the indices of the selected points in the input cloud
+          */
+        void
+        selectPoints (pcl::Indices &indices) const;
+
+      protected:
+        struct Node
+        {
+          /** \brief Bounding box of the node. */
+          Eigen::Vector3d min_pt, max_pt;
+
+          /** \brief Indices of the children in nodes_. */
+          std::vector<std::size_t> children;
+
+          /** \brief Indices of the points kept in the node. */
+          pcl::Indices points;
+        };
+
+        /** \brief Gather the points of the selected nodes into indices. */
+        void
+        getPoints (const std::vector<std::size_t> &selection, pcl::Indices &indices) const;
+
+        /** \brief The input point cloud dataset. */
+        PointCloudConstPtr cloud_;
+
+        /** \brief The nodes of the hierarchy, the root first. */
+        std::vector<Node> nodes_;
+
+        /** \brief The largest number of points kept in a branch node. */
+        std::size_t node_size_;
+
+        /** \brief The largest number of selected points. */
+        std::size_t point_budget_;
+
+        /** \brief The projected distance between points below which nodes are not refined. */
+        float max_screen_space_error_;
+    };
+  }
+}
+
+#include <pcl/visualization/impl/lod_point_cloud.hpp>
@@ -52,6 +52,7 @@
 #include <pcl/visualization/point_picking_event.h>
 #include <pcl/visualization/area_picking_event.h>
 #include <pcl/visualization/interactor_style.h>
+#include <pcl/visualization/lod_point_cloud.h>
 
 #include <vtkOrientationMarkerWidget.h>
 #include <vtkRenderWindowInteractor.h>
@@ -687,6 +688,53 @@ namespace pcl
         updatePointCloud (const typename pcl::PointCloud<PointT>::ConstPtr &cloud,
                           const std::string &id = "cloud");
 
+        /** \brief Add a Point Cloud (templated) to screen that is meant to be replaced often, e.g. every frame of a
+          * live stream, through updateStreamingPointCloud. The point, color and vertex buffers are allocated once for
+          * capacity points and refilled in place on every update, instead of being rebuilt like in updatePointCloud.
+          * Colors are taken from the rgb/rgba field if PointT has one.
+          * \param[in] capacity the maximum number of points shown, larger clouds are truncated
+          * \param[in] id the point cloud object id (default: cloud)
+          * \param[in] viewport the view port where the Point Cloud should be added (default: all)
+          */
+        template <typename PointT> bool
+        addStreamingPointCloud (std::size_t capacity,
+                                const std::string &id = "cloud", int viewport = 0);
+
+        /** \brief Replace the data of a cloud object added with addStreamingPointCloud. The XYZ coordinates (and
+          * colors) of the finite points are written into the buffers allocated by addStreamingPointCloud, and the
+          * vertex cells are only touched if the number of points changed.
+          * \param[in] cloud the input point cloud dataset
+          * \param[in] id the point cloud object id to update (default: cloud)
+          * \return false if no cloud with the specified ID was added with addStreamingPointCloud
+          */
+        template <typename PointT> bool
+        updateStreamingPointCloud (const typename pcl::PointCloud<PointT>::ConstPtr &cloud,
+                                   const std::string &id = "cloud");
+
+        /** \brief Add a Point Cloud (templated) to screen that is too large to be drawn at once. Whenever the
+          * camera of the first renderer showing the cloud moves, the nodes of the level of detail hierarchy are
+          * selected again for it and their points copied into the buffers of a streaming cloud (see
+          * addStreamingPointCloud) sized for the point budget of the hierarchy.
+          * \param[in] lod the level of detail hierarchy of the point cloud dataset
+          * \param[in] id the point cloud object id (default: cloud)
+          * \param[in] viewport the view port where the Point Cloud should be added (default: all)
+          */
+        template <typename PointT> bool
+        addLODPointCloud (const typename LODPointCloud<PointT>::ConstPtr &lod,
+                          const std::string &id = "cloud", int viewport = 0);
+
+        /** \brief Add a Point Cloud (templated) to screen that is too large to be drawn at once, drawing at most
+          * point_budget points of it chosen by a LODPointCloud with the default settings.
+          * \param[in] cloud the input point cloud dataset
+          * \param[in] point_budget the largest number of points drawn
+          * \param[in] id the point cloud object id (default: cloud)
+          * \param[in] viewport the view port where the Point Cloud should be added (default: all)
+          */
+        template <typename PointT> bool
+        addLODPointCloud (const typename pcl::PointCloud<PointT>::ConstPtr &cloud,
+                          std::size_t point_budget = 1000000,
+                          const std::string &id = "cloud", int viewport = 0);
+
          /** \brief Updates the XYZ data for an existing cloud object id on screen.
            * \param[in] cloud the input point cloud dataset
            * \param[in] geometry_handler the geometry handler to use
@@ -2074,6 +2122,32 @@ namespace pcl
         /** \brief The FPSCallback object for the current visualizer. */
         vtkSmartPointer<FPSCallback> update_fps_;
 
+        /** \brief Selects the points of a cloud added with addLODPointCloud for the camera of the renderer
+          * it observes, at the start of the rendering after the camera or the viewport changed.
+          */
+        template <typename PointT>
+        struct LODCallback : public vtkCommand
+        {
+          static LODCallback *New () { return (new LODCallback); }
+
+          void
+          Execute (vtkObject *caller, unsigned long event_id, void*) override;
+
+          typename LODPointCloud<PointT>::ConstPtr lod;
+          std::string id;
+          PCLVisualizer* pcl_visualizer = nullptr;
+
+          /** \brief The camera and viewport size of the last selection. */
+          Eigen::Matrix4d view = Eigen::Matrix4d::Zero ();
+          double view_angle = 0.0;
+          int size[2] = {0, 0};
+
+          /** \brief The selected points. */
+          typename pcl::PointCloud<PointT>::Ptr points;
+
+          PCL_MAKE_ALIGNED_OPERATOR_NEW
+        };
+
         /** \brief Set to false if the interaction loop is running. */
         bool stopped_;
 
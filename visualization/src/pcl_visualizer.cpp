@@ -845,6 +845,14 @@ pcl::visualization::PCLVisualizer::removePointCloud (const std::string &id, int
   // Remove it from all renderers
   if (removeActorFromRenderer (am_it->second.actor, viewport))
   {
+    // Stop selecting the points of a level of detail cloud
+    if (am_it->second.lod_callback)
+    {
+      rens_->InitTraversal ();
+      vtkRenderer* renderer = nullptr;
+      while ((renderer = rens_->GetNextItem ()))
+        renderer->RemoveObserver (am_it->second.lod_callback);
+    }
     // Remove the pointer/ID pair to the global actor map
     cloud_actor_map_->erase (am_it);
     return (true);